@@ -2,8 +2,40 @@
 #include <ATen/MatrixRef.h>
 #include <ATen/VmapTransforms.h>
 
+#include <mutex>
+
 namespace at {
 
+namespace {
+
+std::mutex vmap_fallback_counts_mutex;
+
+std::unordered_map<c10::OperatorName, int64_t>& vmapFallbackCounts() {
+  static std::unordered_map<c10::OperatorName, int64_t> counts;
+  return counts;
+}
+
+void countVmapFallback(const c10::OperatorName& name) {
+  std::lock_guard<std::mutex> guard(vmap_fallback_counts_mutex);
+  vmapFallbackCounts()[name]++;
+}
+
+} // namespace
+
+std::unordered_map<std::string, int64_t> getVmapFallbackCounts() {
+  std::lock_guard<std::mutex> guard(vmap_fallback_counts_mutex);
+  std::unordered_map<std::string, int64_t> result;
+  for (const auto& entry : vmapFallbackCounts()) {
+    result.emplace(toString(entry.first), entry.second);
+  }
+  return result;
+}
+
+void resetVmapFallbackCounts() {
+  std::lock_guard<std::mutex> guard(vmap_fallback_counts_mutex);
+  vmapFallbackCounts().clear();
+}
+
 // Given a linear index, return the actual index.
 // Example: Given linear_idx = 3, sizes = [5, 2], we would return [1, 0]
 static SmallVector<indexing::TensorIndex,kVmapStaticDimVecSize>
@@ -50,6 +82,7 @@ static bool areAnyArgumentsTensorList(const FunctionSchema& schema) {
 void batchedTensorForLoopFallback(const c10::OperatorHandle& op, torch::jit::Stack* stack) {
   const auto& schema = op.schema();
   const auto num_returns = schema.returns().size();
+  countVmapFallback(op.operator_name());
   TORCH_CHECK(!schema.is_mutable() && !schema.hasAnyAliasInfo(),
               "Batching rule not implemented for ", schema, "; ",
               "the fallback path doesn't work on in-place or view ops.");
@@ -115,6 +148,9 @@ void batchedTensorForLoopFallback(const c10::OperatorHandle& op, torch::jit::Sta
   // more easily in the next step.
   std::vector<Tensor> output_shards(num_batches * num_returns);
 
+  // The arguments of every batch are pushed on top of those of the op, and
+  // replaced by its returns.
+  stack->reserve(stack->size() + std::max(num_arguments, num_returns));
   for (int64_t linear_idx = 0; linear_idx < num_batches; ++linear_idx) {
     auto index = computeIndex(linear_idx, batch_sizes);
     auto batched_tensor_inputs_pos_iter = batched_tensor_inputs_position.begin();
@@ -139,9 +175,10 @@ void batchedTensorForLoopFallback(const c10::OperatorHandle& op, torch::jit::Sta
 
     // Store the result into `output_shards`. See NOTE: [Output shards layout]
     // to learn about the details of how we store the shards.
-    const auto returns = torch::jit::last(stack, num_returns);
-    for (int64_t return_idx = 0; return_idx < returns.size(); ++return_idx) {
-      output_shards[num_batches * return_idx + linear_idx] = returns[return_idx].toTensor();
+    const auto returns_begin = stack->size() - num_returns;
+    for (int64_t return_idx = 0; return_idx < num_returns; ++return_idx) {
+      output_shards[num_batches * return_idx + linear_idx] =
+          std::move((*stack)[returns_begin + return_idx]).toTensor();
     }
     torch::jit::drop(stack, num_returns);
   }
@@ -20,4 +20,10 @@ namespace at {
 // write batching rules for operators whenever possible.
 void batchedTensorForLoopFallback(const c10::OperatorHandle& op, torch::jit::Stack* stack);
 
+// The number of times each operator went through the fallback (or tried to)
+// since the last reset, by operator name (e.g. "aten::atan2" or
+// "aten::var_mean.dim"). This tells which operators are worth a batching rule.
+TORCH_API std::unordered_map<std::string, int64_t> getVmapFallbackCounts();
+TORCH_API void resetVmapFallbackCounts();
+
 } // namespace at
@@ -19,7 +19,9 @@ namespace at {
 // NOTE: [When should I add a batching rule?]
 // When you are adding a new operator, you'll need to add a batching rule so
 // that vmap can work efficiently with said operator. If you do not, we'll attempt
-// to generate a slow fallback for the batching rule (this is not yet implemented).
+// to generate a slow fallback for the batching rule (see BatchedFallback.h).
+// torch._C._vmap_fallback_counts() tells which operators went through the
+// fallback of a workload, and how often.
 
 // NOTE: [How to write batching rules?]
 // The signature of a batching rule should look like exactly like the C++ signature
@@ -48,19 +50,279 @@ namespace at {
 // if not use the same mechanism. In order to accomplish that we might have to
 // do some refactoring.
 
-Tensor sum_batching_rule(const Tensor& self, IntArrayRef dims, bool keepdim, optional<ScalarType> dtype) {
+// Reduces the physical view of `self` over the physical dims of `dims` with
+// `reduce(physical, physical_dims, keepdim)`; an empty `dims` means all of the
+// logical dims, as for at::sum. NB: `reduce` must never be given an empty list
+// of dims, with which it would reduce over the batch dims too.
+template <typename Reduce>
+Tensor reduction_batching_rule(const Tensor& self, IntArrayRef dims, bool keepdim, Reduce reduce) {
   auto self_physical = MultiBatchVmapTransform::logicalToPhysical(self);
-  auto dims_physical = self_physical.getPhysicalDims(dims);
-  auto result = at::sum(self_physical.tensor(), dims_physical, keepdim, dtype);
+  if (!dims.empty()) {
+    auto dims_physical = self_physical.getPhysicalDims(dims);
+    return self_physical.newLogicalFromPhysical(
+        reduce(self_physical.tensor(), dims_physical, keepdim));
+  }
+  const auto& physical = self_physical.tensor();
+  const int64_t num_batch_dims = self_physical.numBatchDims();
+  if (physical.dim() == num_batch_dims) {
+    // A logical 0-dim tensor is reduced over a size-one dim standing for it.
+    return self_physical.newLogicalFromPhysical(
+        reduce(physical.unsqueeze(-1), {num_batch_dims}, /*keepdim=*/false));
+  }
+  VmapDimVector dims_physical;
+  for (int64_t dim = num_batch_dims; dim < physical.dim(); dim++) {
+    dims_physical.push_back(dim);
+  }
+  return self_physical.newLogicalFromPhysical(reduce(physical, dims_physical, keepdim));
+}
+
+Tensor sum_batching_rule(const Tensor& self, optional<ScalarType> dtype) {
+  return reduction_batching_rule(self, {}, /*keepdim=*/false,
+      [&](const Tensor& physical, IntArrayRef physical_dims, bool physical_keepdim) {
+        return at::sum(physical, physical_dims, physical_keepdim, dtype);
+      });
+}
+
+Tensor sum_dim_batching_rule(const Tensor& self, IntArrayRef dims, bool keepdim, optional<ScalarType> dtype) {
+  return reduction_batching_rule(self, dims, keepdim,
+      [&](const Tensor& physical, IntArrayRef physical_dims, bool physical_keepdim) {
+        return at::sum(physical, physical_dims, physical_keepdim, dtype);
+      });
+}
+
+Tensor mean_batching_rule(const Tensor& self, optional<ScalarType> dtype) {
+  return reduction_batching_rule(self, {}, /*keepdim=*/false,
+      [&](const Tensor& physical, IntArrayRef physical_dims, bool physical_keepdim) {
+        return at::mean(physical, physical_dims, physical_keepdim, dtype);
+      });
+}
+
+Tensor mean_dim_batching_rule(const Tensor& self, IntArrayRef dims, bool keepdim, optional<ScalarType> dtype) {
+  return reduction_batching_rule(self, dims, keepdim,
+      [&](const Tensor& physical, IntArrayRef physical_dims, bool physical_keepdim) {
+        return at::mean(physical, physical_dims, physical_keepdim, dtype);
+      });
+}
+
+Tensor logsumexp_batching_rule(const Tensor& self, IntArrayRef dims, bool keepdim) {
+  return reduction_batching_rule(self, dims, keepdim,
+      [](const Tensor& physical, IntArrayRef physical_dims, bool physical_keepdim) {
+        return at::logsumexp(physical, physical_dims, physical_keepdim);
+      });
+}
+
+template <Tensor (*Op)(const Tensor&, int64_t, bool)>
+Tensor softmax_batching_rule(const Tensor& self, int64_t dim, bool half_to_float) {
+  auto self_physical = MultiBatchVmapTransform::logicalToPhysical(self);
+  auto dim_physical = self_physical.getPhysicalDim(dim);
+  auto result = Op(self_physical.tensor(), dim_physical, half_to_float);
   return self_physical.newLogicalFromPhysical(result);
 }
 
-Tensor mul_batching_rule(const Tensor& self, const Tensor& other) {
+template <Tensor (*Op)(const Tensor&, const Tensor&, int64_t, const Tensor&)>
+Tensor softmax_backward_batching_rule(
+    const Tensor& grad_output, const Tensor& output, int64_t dim, const Tensor& self) {
+  // The kernels want grad_output and output of the same size, so they are
+  // expanded to the batch sizes of both rather than broadcast.
+  auto physical_args = MultiBatchVmapTransform::logicalToPhysical({grad_output, output, self});
+  auto dim_physical = physical_args[0].getPhysicalDim(dim);
+  auto result = Op(
+      physical_args[0].tensor(), physical_args[1].tensor(), dim_physical, physical_args[2].tensor());
+  return physical_args[0].newLogicalFromPhysical(result);
+}
+
+// The (logical) argument of a binary pointwise op that isn't batched and is a
+// 0-dim tensor, e.g. the wrapped number of `tensor * 2`, is passed as is to the
+// physical op: aligning it would turn it into a 1-dim tensor that takes part
+// in type promotion like one.
+static bool isUnbatchedScalarTensor(const Tensor& tensor) {
+  return tensor.dim() == 0 && !isBatchedTensor(tensor);
+}
+
+template <typename F, F Func, typename... ExtraArgs>
+Tensor binary_pointwise_batching_rule(
+    const Tensor& self, const Tensor& other, ExtraArgs... extra_args) {
+  if (isUnbatchedScalarTensor(other)) {
+    auto self_physical = MultiBatchVmapTransform::logicalToPhysical(self);
+    auto result = Func(self_physical.tensor(), other, extra_args...);
+    return self_physical.newLogicalFromPhysical(result);
+  }
+  if (isUnbatchedScalarTensor(self)) {
+    auto other_physical = MultiBatchVmapTransform::logicalToPhysical(other);
+    auto result = Func(self, other_physical.tensor(), extra_args...);
+    return other_physical.newLogicalFromPhysical(result);
+  }
   auto physical_args = BroadcastingVmapTransform::logicalToPhysical({self, other});
-  auto result = at::mul(physical_args[0].tensor(), physical_args[1].tensor());
+  auto result = Func(physical_args[0].tensor(), physical_args[1].tensor(), extra_args...);
   return physical_args[0].newLogicalFromPhysical(result);
 }
 
+// In-place variant of binary_pointwise_batching_rule. The batch dims of `self`
+// can't grow, so `other` can only have batch dims (levels) that `self` has.
+template <typename F, F Method, typename... ExtraArgs>
+Tensor& binary_pointwise_inplace_batching_rule(
+    Tensor& self, const Tensor& other, ExtraArgs... extra_args) {
+  if (isUnbatchedScalarTensor(other)) {
+    auto self_physical = MultiBatchVmapTransform::logicalToPhysical(self);
+    (self_physical.tensor().*Method)(other, extra_args...);
+    return self;
+  }
+  auto physical_args = BroadcastingVmapTransform::logicalToPhysical({self, other});
+  auto* self_batched = maybeGetBatchedImpl(self);
+  int64_t self_num_batch_dims = self_batched ? self_batched->bdims().size() : 0;
+  TORCH_CHECK(physical_args[0].numBatchDims() == self_num_batch_dims,
+      "vmap: an in-place operation on a Tensor would need to write a value per ",
+      "example into it, but the Tensor isn't batched over all of the vmapped ",
+      "dimensions of the other argument. Consider using the out-of-place ",
+      "variant of the operation instead.");
+  // physical_args[0] is a view of `self`.
+  (physical_args[0].tensor().*Method)(physical_args[1].tensor(), extra_args...);
+  return self;
+}
+
+// matmul, and mm, mv, dot and bmm through it, whose semantics it matches for
+// the arguments they accept. Logical vectors are made matrices (as matmul does)
+// so that the batch dims are never mistaken for the matrix dims of a vector:
+// the physical [B, k] of a logical vector [k] would be a matrix to at::matmul.
+Tensor matmul_batching_rule(const Tensor& self, const Tensor& other) {
+  TORCH_CHECK(self.dim() > 0 && other.dim() > 0,
+      "both arguments to matmul need to be at least 1D, but they are ",
+      self.dim(), "D and ", other.dim(), "D");
+  auto self_matrix = self.dim() == 1 ? self.unsqueeze(0) : self;
+  auto other_matrix = other.dim() == 1 ? other.unsqueeze(1) : other;
+
+  Tensor result;
+  if (!isBatchedTensor(other_matrix) && other_matrix.dim() == 2) {
+    // The common [B, ..., n, k] x [k, m] case (e.g. a linear layer), which
+    // at::matmul folds into a single mm.
+    auto self_physical = MultiBatchVmapTransform::logicalToPhysical(self_matrix);
+    result = self_physical.newLogicalFromPhysical(
+        at::matmul(self_physical.tensor(), other_matrix));
+  } else if (!isBatchedTensor(self_matrix) && self_matrix.dim() == 2) {
+    auto other_physical = MultiBatchVmapTransform::logicalToPhysical(other_matrix);
+    result = other_physical.newLogicalFromPhysical(
+        at::matmul(self_matrix, other_physical.tensor()));
+  } else {
+    // Aligns the batch dims, and pads the logical dims so that the batch dims
+    // of one aren't broadcast against the logical dims of the other.
+    auto physical_args = BroadcastingVmapTransform::logicalToPhysical({self_matrix, other_matrix});
+    result = physical_args[0].newLogicalFromPhysical(
+        at::matmul(physical_args[0].tensor(), physical_args[1].tensor()));
+  }
+  if (other.dim() == 1) {
+    result = result.squeeze(-1);
+  }
+  if (self.dim() == 1) {
+    result = result.squeeze(other.dim() == 1 ? -1 : -2);
+  }
+  return result;
+}
+
+Tensor mm_batching_rule(const Tensor& self, const Tensor& mat2) {
+  TORCH_CHECK(self.dim() == 2 && mat2.dim() == 2,
+      "mm: expected both arguments to be matrices, but they are ",
+      self.dim(), "D and ", mat2.dim(), "D");
+  return matmul_batching_rule(self, mat2);
+}
+
+Tensor mv_batching_rule(const Tensor& self, const Tensor& vec) {
+  TORCH_CHECK(self.dim() == 2 && vec.dim() == 1,
+      "mv: expected a matrix and a vector, but they are ",
+      self.dim(), "D and ", vec.dim(), "D");
+  return matmul_batching_rule(self, vec);
+}
+
+Tensor dot_batching_rule(const Tensor& self, const Tensor& tensor) {
+  TORCH_CHECK(self.dim() == 1 && tensor.dim() == 1,
+      "dot: expected both arguments to be vectors, but they are ",
+      self.dim(), "D and ", tensor.dim(), "D");
+  return matmul_batching_rule(self, tensor);
+}
+
+Tensor bmm_batching_rule(const Tensor& self, const Tensor& mat2) {
+  TORCH_CHECK(self.dim() == 3 && mat2.dim() == 3,
+      "bmm: expected both arguments to be 3D, but they are ",
+      self.dim(), "D and ", mat2.dim(), "D");
+  return matmul_batching_rule(self, mat2);
+}
+
+static bool isScalarEqualTo(Scalar scalar, double value) {
+  return scalar.isComplex()
+      ? scalar.toComplexDouble() == c10::complex<double>(value)
+      : scalar.toDouble() == value;
+}
+
+Tensor addmm_batching_rule(
+    const Tensor& self, const Tensor& mat1, const Tensor& mat2, Scalar beta, Scalar alpha) {
+  auto result = at::mm(mat1, mat2);
+  if (!isScalarEqualTo(alpha, 1)) {
+    result = at::mul(result, alpha);
+  }
+  // As for addmm, `self` is ignored when beta is 0.
+  if (isScalarEqualTo(beta, 0)) {
+    return result;
+  }
+  return at::add(result, self, beta);
+}
+
+Tensor linear_batching_rule(const Tensor& input, const Tensor& weight, const Tensor& bias) {
+  // native::linear folds 2D inputs into an addmm, which would need its own
+  // batching rule; matmul covers all of the ranks.
+  auto output = at::matmul(input, weight.t());
+  if (bias.defined()) {
+    output = at::add(output, bias);
+  }
+  return output;
+}
+
+Tensor conv2d_batching_rule(
+    const Tensor& input, const Tensor& weight, const Tensor& bias,
+    IntArrayRef stride, IntArrayRef padding, IntArrayRef dilation, int64_t groups) {
+  TORCH_CHECK(input.dim() == 4 && weight.dim() == 4,
+      "conv2d: expected a 4D input and a 4D weight, but they are ",
+      input.dim(), "D and ", weight.dim(), "D");
+  bool bias_defined = bias.defined();
+  if (!isBatchedTensor(weight) && !(bias_defined && isBatchedTensor(bias))) {
+    // Shared weights: the batch dims are folded into the examples dim.
+    auto input_physical = MultiBatchVmapTransform::logicalToPhysical(input);
+    auto num_batch_dims = input_physical.numBatchDims();
+    const auto& input_tensor = input_physical.tensor();
+    auto output = at::conv2d(
+        input_tensor.flatten(0, num_batch_dims), weight, bias, stride, padding, dilation, groups);
+    VmapDimVector output_sizes(
+        input_tensor.sizes().begin(), input_tensor.sizes().begin() + num_batch_dims + 1);
+    output_sizes.insert(output_sizes.end(), output.sizes().begin() + 1, output.sizes().end());
+    return input_physical.newLogicalFromPhysical(output.view(output_sizes));
+  }
+
+  // Per-example weights: the batch dims are folded into the channels, and the
+  // weights of every example make their own groups.
+  std::vector<Tensor> logical_args = {input, weight};
+  if (bias_defined) {
+    logical_args.push_back(bias);
+  }
+  auto physical_args = MultiBatchVmapTransform::logicalToPhysical(logical_args);
+  auto num_batch_dims = physical_args[0].numBatchDims();
+  const auto& input_tensor = physical_args[0].tensor();
+  // [B..., N, C, H, W] -> [N, B * C, H, W]
+  auto flat_input = input_tensor.flatten(0, num_batch_dims - 1).transpose(0, 1);
+  auto num_batches = flat_input.size(1);
+  flat_input = flat_input.flatten(1, 2);
+  // [B..., O, C / groups, kH, kW] -> [B * O, C / groups, kH, kW]
+  auto flat_weight = physical_args[1].tensor().flatten(0, num_batch_dims);
+  auto flat_bias = bias_defined ? physical_args[2].tensor().flatten(0, num_batch_dims) : bias;
+  auto output = at::conv2d(
+      flat_input, flat_weight, flat_bias, stride, padding, dilation, groups * num_batches);
+  // [N, B * O, H', W'] -> [B..., N, O, H', W']
+  auto output_sizes = output.sizes();
+  output = output.view({output_sizes[0], num_batches, -1, output_sizes[2], output_sizes[3]})
+      .transpose(0, 1);
+  VmapDimVector physical_sizes(
+      input_tensor.sizes().begin(), input_tensor.sizes().begin() + num_batch_dims + 1);
+  physical_sizes.insert(physical_sizes.end(), output.sizes().begin() + 2, output.sizes().end());
+  return physical_args[0].newLogicalFromPhysical(output.reshape(physical_sizes));
+}
+
 Tensor expand_batching_rule(const Tensor& self, IntArrayRef size, bool implicit) {
   auto self_physical = MultiBatchVmapTransform::logicalToPhysical(self);
   auto size_physical = self_physical.getPhysicalShape(size);
@@ -226,14 +488,25 @@ Tensor view_batching_rule(const Tensor& self, IntArrayRef size) {
   return self_physical.newLogicalFromPhysical(result);
 }
 
-template <Tensor (*Op)(const Tensor&)>
-Tensor unary_pointwise_batching_rule(const Tensor& input) {
+template <typename F, F Func, typename... ExtraArgs>
+Tensor unary_pointwise_batching_rule(const Tensor& input, ExtraArgs... extra_args) {
   auto* input_batched = unsafeGetBatchedImpl(input);
-  auto output_physical = Op(input_batched->value());
+  auto output_physical = Func(input_batched->value(), extra_args...);
   auto old_bdims = input_batched->bdims();
   return makeBatched(output_physical, BatchDims(old_bdims.begin(), old_bdims.end()));
 }
 
+Tensor to_dtype_batching_rule(
+    const Tensor& self, ScalarType dtype, bool non_blocking, bool copy,
+    optional<MemoryFormat> memory_format) {
+  // NB: Tensor.to returns `self` itself when there is nothing to convert, so
+  // the result is made from the physical result as is, aliasing included.
+  auto* self_batched = unsafeGetBatchedImpl(self);
+  auto result = self_batched->value().to(dtype, non_blocking, copy, memory_format);
+  auto old_bdims = self_batched->bdims();
+  return makeBatched(result, BatchDims(old_bdims.begin(), old_bdims.end()));
+}
+
 TORCH_LIBRARY_IMPL(_, Batched, m) {
   m.fallback(torch::CppFunction::makeFromBoxedFunction<&batchedTensorForLoopFallback>());
 }
@@ -247,8 +520,33 @@ TORCH_LIBRARY_IMPL(aten, Batched, m) {
   m.impl("_add_batch_dim", native::_add_batch_dim);
   m.impl("_remove_batch_dim", native::_remove_batch_dim);
 
-  m.impl_UNBOXED("sum.dim_IntList", sum_batching_rule);
-  m.impl_UNBOXED("mul.Tensor", mul_batching_rule);
+  // reductions
+  m.impl_UNBOXED("sum", sum_batching_rule);
+  m.impl_UNBOXED("sum.dim_IntList", sum_dim_batching_rule);
+  m.impl_UNBOXED("mean", mean_batching_rule);
+  m.impl_UNBOXED("mean.dim", mean_dim_batching_rule);
+  m.impl("logsumexp", logsumexp_batching_rule);
+  m.impl("sum_to_size", native::sum_to_size); // composite wrt autograd
+
+  m.impl_UNBOXED("to.dtype", to_dtype_batching_rule);
+
+  // softmax
+  m.impl_UNBOXED("softmax.int", static_cast<Tensor(*)(const Tensor&,int64_t,optional<ScalarType>)>(native::softmax)); // composite wrt autograd
+  m.impl_UNBOXED("log_softmax.int", static_cast<Tensor(*)(const Tensor&,int64_t,optional<ScalarType>)>(native::log_softmax)); // composite wrt autograd
+  m.impl("_softmax", softmax_batching_rule<at::_softmax>);
+  m.impl("_log_softmax", softmax_batching_rule<at::_log_softmax>);
+  m.impl("_softmax_backward_data", softmax_backward_batching_rule<at::_softmax_backward_data>);
+  m.impl("_log_softmax_backward_data", softmax_backward_batching_rule<at::_log_softmax_backward_data>);
+
+  // matrix products and the layers built on them
+  m.impl("matmul", matmul_batching_rule);
+  m.impl("mm", mm_batching_rule);
+  m.impl("mv", mv_batching_rule);
+  m.impl("dot", dot_batching_rule);
+  m.impl("bmm", bmm_batching_rule);
+  m.impl("addmm", addmm_batching_rule);
+  m.impl("linear", linear_batching_rule);
+  m.impl("conv2d", conv2d_batching_rule);
 
   // view operations
   m.impl("chunk", chunk_batching_rule);
@@ -278,7 +576,8 @@ TORCH_LIBRARY_IMPL(aten, Batched, m) {
   m.impl("view_as", native::view_as); // composite wrt autograd
 
   // unary pointwise, out-of-place, no additional arguments.
-#define UNARY_POINTWISE(op) m.impl(#op, unary_pointwise_batching_rule<at::op>);
+#define UNARY_POINTWISE(op) m.impl(#op, \
+    unary_pointwise_batching_rule<Tensor (*)(const Tensor&), at::op>);
   UNARY_POINTWISE(abs);
   UNARY_POINTWISE(acos);
   UNARY_POINTWISE(asin);
@@ -309,7 +608,47 @@ TORCH_LIBRARY_IMPL(aten, Batched, m) {
   UNARY_POINTWISE(tan);
   UNARY_POINTWISE(tanh);
   UNARY_POINTWISE(trunc);
+  UNARY_POINTWISE(gelu);
 #undef UNARY_POINTWISE
+
+  m.impl_UNBOXED("clone", unary_pointwise_batching_rule<
+      Tensor (*)(const Tensor&, optional<MemoryFormat>), at::clone, optional<MemoryFormat>>);
+
+  // unary pointwise, out-of-place, with scalar arguments.
+  using TensorScalarType = Tensor (*)(const Tensor&, Scalar);
+  using TensorScalarScalarType = Tensor (*)(const Tensor&, Scalar, Scalar);
+  using TensorOptScalarOptScalarType = Tensor (*)(const Tensor&, optional<Scalar>, optional<Scalar>);
+  m.impl("add.Scalar", unary_pointwise_batching_rule<TensorScalarScalarType, at::add, Scalar, Scalar>);
+  m.impl("sub.Scalar", unary_pointwise_batching_rule<TensorScalarScalarType, at::sub, Scalar, Scalar>);
+  m.impl("mul.Scalar", unary_pointwise_batching_rule<TensorScalarType, at::mul, Scalar>);
+  m.impl("div.Scalar", unary_pointwise_batching_rule<TensorScalarType, at::div, Scalar>);
+  m.impl("pow.Tensor_Scalar", unary_pointwise_batching_rule<TensorScalarType, at::pow, Scalar>);
+  m.impl("threshold", unary_pointwise_batching_rule<TensorScalarScalarType, at::threshold, Scalar, Scalar>);
+  m.impl("clamp", unary_pointwise_batching_rule<TensorOptScalarOptScalarType, at::clamp, optional<Scalar>, optional<Scalar>>);
+
+  // binary pointwise, out-of-place.
+  using TensorTensorType = Tensor (*)(const Tensor&, const Tensor&);
+  using TensorTensorScalarType = Tensor (*)(const Tensor&, const Tensor&, Scalar);
+  m.impl("add.Tensor", binary_pointwise_batching_rule<TensorTensorScalarType, at::add, Scalar>);
+  m.impl("sub.Tensor", binary_pointwise_batching_rule<TensorTensorScalarType, at::sub, Scalar>);
+  m.impl("rsub.Tensor", binary_pointwise_batching_rule<TensorTensorScalarType, at::rsub, Scalar>);
+  m.impl("mul.Tensor", binary_pointwise_batching_rule<TensorTensorType, at::mul>);
+  m.impl("div.Tensor", binary_pointwise_batching_rule<TensorTensorType, at::div>);
+  m.impl("pow.Tensor_Tensor", binary_pointwise_batching_rule<TensorTensorType, at::pow>);
+
+  // binary pointwise, in-place.
+  using TensorMethodTensorType = Tensor& (Tensor::*)(const Tensor&) const;
+  using TensorMethodTensorScalarType = Tensor& (Tensor::*)(const Tensor&, Scalar) const;
+  m.impl("add_.Tensor", binary_pointwise_inplace_batching_rule<TensorMethodTensorScalarType, &Tensor::add_, Scalar>);
+  m.impl("sub_.Tensor", binary_pointwise_inplace_batching_rule<TensorMethodTensorScalarType, &Tensor::sub_, Scalar>);
+  m.impl("mul_.Tensor", binary_pointwise_inplace_batching_rule<TensorMethodTensorType, &Tensor::mul_>);
+  m.impl("div_.Tensor", binary_pointwise_inplace_batching_rule<TensorMethodTensorType, &Tensor::div_>);
+
+  // backward of the pointwise activations
+  m.impl("threshold_backward", binary_pointwise_batching_rule<TensorTensorScalarType, at::threshold_backward, Scalar>);
+  m.impl("sigmoid_backward", binary_pointwise_batching_rule<TensorTensorType, at::sigmoid_backward>);
+  m.impl("tanh_backward", binary_pointwise_batching_rule<TensorTensorType, at::tanh_backward>);
+  m.impl("gelu_backward", binary_pointwise_batching_rule<TensorTensorType, at::gelu_backward>);
 }
 
 } // namespace at
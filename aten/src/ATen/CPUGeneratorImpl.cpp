@@ -43,7 +43,8 @@ CPUGeneratorImpl::CPUGeneratorImpl(uint64_t seed_in)
   : c10::GeneratorImpl{Device(DeviceType::CPU), DispatchKeySet(c10::DispatchKey::CPU)},
     engine_{seed_in},
     next_float_normal_sample_{c10::optional<float>()},
-    next_double_normal_sample_{c10::optional<double>()} { }
+    next_double_normal_sample_{c10::optional<double>()},
+    philox_mode_{false} { }
 
 /**
  * Manually seeds the engine with the seed input
@@ -151,6 +152,33 @@ void CPUGeneratorImpl::set_engine(at::mt19937 engine) {
   engine_ = engine;
 }
 
+/**
+ * Whether the CPU distribution kernels that support it draw from
+ * counter-based Philox streams rather than from the mt19937 engine.
+ *
+ * In Philox mode, every call of such a kernel draws a single 64 bit key
+ * from the engine, under the lock of the generator, and element i of the
+ * output is computed from the Philox outputs at a counter derived from i.
+ * The chunks of at::parallel_for can therefore generate their elements
+ * independently and without the lock, and the result depends neither on
+ * how the elements are split among threads nor on their number. The
+ * generator state is still the state of the engine, so get_state, set_state
+ * and manual_seed cover the Philox streams too. The numbers differ from the
+ * ones the kernels produce in the default mode.
+ */
+bool CPUGeneratorImpl::philox_mode() const {
+  return philox_mode_;
+}
+
+/**
+ * Enables or disables the Philox mode of the CPUGeneratorImpl
+ *
+ * See Note [Acquire lock when using random generators]
+ */
+void CPUGeneratorImpl::set_philox_mode(bool enabled) {
+  philox_mode_ = enabled;
+}
+
 /**
  * Public clone method implementation
  *
@@ -170,6 +198,7 @@ CPUGeneratorImpl* CPUGeneratorImpl::clone_impl() const {
   gen->set_engine(engine_);
   gen->set_next_float_normal_sample(next_float_normal_sample_);
   gen->set_next_double_normal_sample(next_double_normal_sample_);
+  gen->set_philox_mode(philox_mode_);
   return gen;
 }
 
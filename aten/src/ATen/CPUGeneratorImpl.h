@@ -26,12 +26,15 @@ struct CAFFE2_API CPUGeneratorImpl : public c10::GeneratorImpl {
   void set_next_double_normal_sample(c10::optional<double> randn);
   at::mt19937 engine();
   void set_engine(at::mt19937 engine);
+  bool philox_mode() const;
+  void set_philox_mode(bool enabled);
 
 private:
   CPUGeneratorImpl* clone_impl() const override;
   at::mt19937 engine_;
   c10::optional<float> next_float_normal_sample_;
   c10::optional<double> next_double_normal_sample_;
+  bool philox_mode_;
 };
 
 namespace detail {
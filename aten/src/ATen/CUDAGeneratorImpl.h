@@ -7,6 +7,53 @@
 
 namespace at {
 
+/**
+ * Note [CUDA Graph-safe RNG states]
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * The seed and offset a kernel gets from philox_engine_inputs are kernel
+ * arguments, so a CUDA graph captures them as constants: every replay would
+ * draw the same numbers, and the generator would not advance.
+ *
+ * Kernels that should work inside graphs get a PhiloxCudaState from
+ * philox_cuda_state instead, and turn it into a seed and offset on the device
+ * with at::cuda::philox::unpack (ATen/cuda/CUDAGraphsUtils.cuh). Outside of
+ * captures the state just holds the values. During a capture it holds a
+ * pointer to a one element device tensor owned by the CUDAGraph, plus the
+ * offset of the kernel within the graph. Before each replay, the graph
+ * reserves the offsets the whole graph uses from the generator and writes
+ * the first one into the tensor, so every replay draws fresh numbers and the
+ * generator advances as if the kernels ran eagerly.
+ *
+ * The seed is still baked into the graph: seeding the generator after
+ * capture has no effect on the replays.
+ */
+struct PhiloxCudaState {
+  PhiloxCudaState() = default;
+  // Called when no graph is being captured
+  PhiloxCudaState(uint64_t seed, uint64_t offset) {
+    seed_ = seed;
+    offset_.val = offset;
+  }
+  // Called while a graph is being captured
+  PhiloxCudaState(uint64_t seed, int64_t* offset_extragraph, uint32_t offset_intragraph) {
+    seed_ = seed;
+    offset_.ptr = offset_extragraph;
+    offset_intragraph_ = offset_intragraph;
+    captured_ = true;
+  }
+
+  union Payload {
+    uint64_t val;
+    int64_t* ptr;
+  };
+
+  uint64_t seed_ = 0;
+  Payload offset_;
+  uint32_t offset_intragraph_ = 0;
+  bool captured_ = false;
+};
+
 struct TORCH_CUDA_API CUDAGeneratorImpl : public c10::GeneratorImpl {
   // Constructors
   CUDAGeneratorImpl(DeviceIndex device_index = -1);
@@ -19,6 +66,11 @@ struct TORCH_CUDA_API CUDAGeneratorImpl : public c10::GeneratorImpl {
   uint64_t seed() override;
   void set_philox_offset_per_thread(uint64_t offset);
   uint64_t philox_offset_per_thread();
+  // See Note [CUDA Graph-safe RNG states]
+  void capture_prologue(int64_t* offset_extragraph);
+  uint64_t capture_epilogue();
+  PhiloxCudaState philox_cuda_state(uint64_t increment);
+  // Not graph-safe, use philox_cuda_state in new code
   std::pair<uint64_t, uint64_t> philox_engine_inputs(uint64_t increment);
   static DeviceType device_type();
 
@@ -26,6 +78,10 @@ private:
   CUDAGeneratorImpl* clone_impl() const override;
   uint64_t seed_ = default_rng_seed_val;
   uint64_t philox_offset_per_thread_ = 0;
+  // set between capture_prologue and capture_epilogue
+  int64_t* offset_extragraph_ = nullptr;
+  uint32_t offset_intragraph_ = 0;
+  bool graph_expects_this_gen_ = false;
 };
 
 namespace cuda {
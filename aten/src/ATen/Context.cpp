@@ -51,6 +51,30 @@ void Context::setUserEnabledMkldnn(bool e) {
   enabled_mkldnn = e;
 }
 
+bool Context::tensorIteratorPlanCache() const {
+  return tensor_iterator_plan_cache;
+}
+
+void Context::setTensorIteratorPlanCache(bool e) {
+  tensor_iterator_plan_cache = e;
+}
+
+bool Context::grainSizeAutotune() const {
+  return grain_size_autotune;
+}
+
+void Context::setGrainSizeAutotune(bool e) {
+  grain_size_autotune = e;
+}
+
+bool Context::persistentRNN() const {
+  return persistent_rnn;
+}
+
+void Context::setPersistentRNN(bool e) {
+  persistent_rnn = e;
+}
+
 bool Context::deterministicCuDNN() const {
   return deterministic_cudnn;
 }
@@ -108,6 +108,18 @@ class CAFFE2_API Context {
   void setUserEnabledCuDNN(bool e);
   bool userEnabledMkldnn() const;
   void setUserEnabledMkldnn(bool e);
+  // Whether TensorIterator reuses the setup of earlier builds with the same
+  // operand layouts, see Note [TensorIterator plan cache]
+  bool tensorIteratorPlanCache() const;
+  void setTensorIteratorPlanCache(bool e);
+  // Whether CPU kernels with a named cost hint tune their grain size, see
+  // Note [Parallel cost hints]
+  bool grainSizeAutotune() const;
+  void setGrainSizeAutotune(bool e);
+  // Whether the LSTM and GRU layers that do not use cuDNN run every step of
+  // a layer in a single persistent CUDA kernel when nothing requires grad
+  bool persistentRNN() const;
+  void setPersistentRNN(bool e);
   bool benchmarkCuDNN() const;
   void setBenchmarkCuDNN(bool);
   bool deterministicCuDNN() const;
@@ -148,6 +160,9 @@ class CAFFE2_API Context {
   bool benchmark_cudnn = false;
   bool allow_tf32_cublas = true;
   bool enabled_mkldnn = true;
+  bool tensor_iterator_plan_cache = false;
+  bool grain_size_autotune = false;
+  bool persistent_rnn = false;
   #ifdef C10_MOBILE
   bool release_original_weights = true;
   #else
@@ -7,8 +7,35 @@
 #include <c10/util/Half.h>
 #include <c10/util/complex.h>
 
+// The selective build of the dtypes of the kernels, see ATen/KernelDtypes.h.
+// The dtypes should_include_kernel_dtype() leaves out are constant false
+// branches, which the compiler drops along with the kernel code they call.
+#if defined(TORCH_SELECTED_DTYPES)
+#include <ATen/selected_dtypes.h>
+#define AT_PRIVATE_DISPATCH_NAME(NAME) \
+  constexpr const char* at_dispatch_name = #NAME;
+#define AT_PRIVATE_CHECK_SELECTIVE_BUILD(enum_type)                      \
+  if (!at::should_include_kernel_dtype(at_dispatch_name, enum_type)) {   \
+    AT_ERROR(                                                            \
+        at_dispatch_name,                                                \
+        " was not built for '",                                          \
+        toString(enum_type),                                             \
+        "', which the selective build left out");                        \
+  }
+#elif defined(TORCH_TRACE_KERNEL_DTYPES)
+#include <ATen/KernelDtypes.h>
+#define AT_PRIVATE_DISPATCH_NAME(NAME) \
+  constexpr const char* at_dispatch_name = #NAME;
+#define AT_PRIVATE_CHECK_SELECTIVE_BUILD(enum_type) \
+  at::detail::record_kernel_dtype(at_dispatch_name, enum_type);
+#else
+#define AT_PRIVATE_DISPATCH_NAME(NAME)
+#define AT_PRIVATE_CHECK_SELECTIVE_BUILD(enum_type)
+#endif
+
 #define AT_PRIVATE_CASE_TYPE(enum_type, type, ...) \
   case enum_type: {                                \
+    AT_PRIVATE_CHECK_SELECTIVE_BUILD(enum_type)    \
     using scalar_t = type;                         \
     return __VA_ARGS__();                          \
   }
@@ -25,6 +52,7 @@
 #define AT_QINT_PRIVATE_CASE_TYPE(                                           \
     enum_type, type, underlying_enum, underlying_type, ...)                  \
   case enum_type: {                                                          \
+    AT_PRIVATE_CHECK_SELECTIVE_BUILD(enum_type)                              \
     using scalar_t = type;                                                   \
     using underlying_t C10_UNUSED_DISPATCH_CUDA_WORKAROUND =                 \
         scalar_t::underlying;                                                \
@@ -134,6 +162,7 @@ inline void deprecated_AT_DISPATCH_ALL_TYPES_AND_HALF_AND_COMPLEX() {}
 
 #define AT_DISPATCH_FLOATING_TYPES(TYPE, NAME, ...)                         \
   [&] {                                                                     \
+    AT_PRIVATE_DISPATCH_NAME(NAME)                                          \
     const auto& the_type = TYPE;                                            \
     /* don't use TYPE again in case it is an expensive or side-effect op */ \
     at::ScalarType _st = ::detail::scalar_type(the_type);                   \
@@ -147,6 +176,7 @@ inline void deprecated_AT_DISPATCH_ALL_TYPES_AND_HALF_AND_COMPLEX() {}
 
 #define AT_DISPATCH_FLOATING_TYPES_AND_HALF(TYPE, NAME, ...)                \
   [&] {                                                                     \
+    AT_PRIVATE_DISPATCH_NAME(NAME)                                          \
     const auto& the_type = TYPE;                                            \
     /* don't use TYPE again in case it is an expensive or side-effect op */ \
     at::ScalarType _st = ::detail::scalar_type(the_type);                   \
@@ -161,6 +191,7 @@ inline void deprecated_AT_DISPATCH_ALL_TYPES_AND_HALF_AND_COMPLEX() {}
 
 #define AT_DISPATCH_FLOATING_TYPES_AND(SCALARTYPE, TYPE, NAME, ...)         \
   [&] {                                                                     \
+    AT_PRIVATE_DISPATCH_NAME(NAME)                                          \
     const auto& the_type = TYPE;                                            \
     /* don't use TYPE again in case it is an expensive or side-effect op */ \
     at::ScalarType _st = ::detail::scalar_type(the_type);                   \
@@ -179,6 +210,7 @@ inline void deprecated_AT_DISPATCH_ALL_TYPES_AND_HALF_AND_COMPLEX() {}
 #define AT_DISPATCH_FLOATING_TYPES_AND2(                                    \
     SCALARTYPE1, SCALARTYPE2, TYPE, NAME, ...)                              \
   [&] {                                                                     \
+    AT_PRIVATE_DISPATCH_NAME(NAME)                                          \
     const auto& the_type = TYPE;                                            \
     /* don't use TYPE again in case it is an expensive or side-effect op */ \
     at::ScalarType _st = ::detail::scalar_type(the_type);                   \
@@ -200,6 +232,7 @@ inline void deprecated_AT_DISPATCH_ALL_TYPES_AND_HALF_AND_COMPLEX() {}
 
 #define AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES(TYPE, NAME, ...)             \
   [&] {                                                                     \
+    AT_PRIVATE_DISPATCH_NAME(NAME)                                          \
     const auto& the_type = TYPE;                                            \
     /* don't use TYPE again in case it is an expensive or side-effect op */ \
     at::ScalarType _st = ::detail::scalar_type(the_type);                   \
@@ -218,6 +251,7 @@ inline void deprecated_AT_DISPATCH_ALL_TYPES_AND_HALF_AND_COMPLEX() {}
 #define AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES_AND1(                        \
     SCALARTYPE, TYPE, NAME, ...)                                            \
   [&] {                                                                     \
+    AT_PRIVATE_DISPATCH_NAME(NAME)                                          \
     const auto& the_type = TYPE;                                            \
     /* don't use TYPE again in case it is an expensive or side-effect op */ \
     at::ScalarType _st = ::detail::scalar_type(the_type);                   \
@@ -240,6 +274,7 @@ inline void deprecated_AT_DISPATCH_ALL_TYPES_AND_HALF_AND_COMPLEX() {}
 #define AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES_AND2(                        \
     SCALARTYPE1, SCALARTYPE2, TYPE, NAME, ...)                              \
   [&] {                                                                     \
+    AT_PRIVATE_DISPATCH_NAME(NAME)                                          \
     const auto& the_type = TYPE;                                            \
     /* don't use TYPE again in case it is an expensive or side-effect op */ \
     at::ScalarType _st = ::detail::scalar_type(the_type);                   \
@@ -265,6 +300,7 @@ inline void deprecated_AT_DISPATCH_ALL_TYPES_AND_HALF_AND_COMPLEX() {}
 
 #define AT_DISPATCH_INTEGRAL_TYPES(TYPE, NAME, ...)                         \
   [&] {                                                                     \
+    AT_PRIVATE_DISPATCH_NAME(NAME)                                          \
     const auto& the_type = TYPE;                                            \
     /* don't use TYPE again in case it is an expensive or side-effect op */ \
     at::ScalarType _st = ::detail::scalar_type(the_type);                   \
@@ -281,6 +317,7 @@ inline void deprecated_AT_DISPATCH_ALL_TYPES_AND_HALF_AND_COMPLEX() {}
 
 #define AT_DISPATCH_INTEGRAL_TYPES_AND(SCALARTYPE, TYPE, NAME, ...)     \
   [&] {                                                                 \
+    AT_PRIVATE_DISPATCH_NAME(NAME)                                      \
     switch (TYPE) {                                                     \
       AT_PRIVATE_CASE_TYPE(at::ScalarType::Byte, uint8_t, __VA_ARGS__)  \
       AT_PRIVATE_CASE_TYPE(at::ScalarType::Char, int8_t, __VA_ARGS__)   \
@@ -298,6 +335,7 @@ inline void deprecated_AT_DISPATCH_ALL_TYPES_AND_HALF_AND_COMPLEX() {}
 
 #define AT_DISPATCH_ALL_TYPES(TYPE, NAME, ...)                               \
   [&] {                                                                      \
+    AT_PRIVATE_DISPATCH_NAME(NAME)                                           \
     const auto& the_type = TYPE;                                             \
     /* don't use TYPE again in case it is an expensive or side-effect op  */ \
     at::ScalarType _st = ::detail::scalar_type(the_type);                    \
@@ -316,6 +354,7 @@ inline void deprecated_AT_DISPATCH_ALL_TYPES_AND_HALF_AND_COMPLEX() {}
 
 #define AT_DISPATCH_COMPLEX_TYPES(TYPE, NAME, ...)                          \
   [&] {                                                                     \
+    AT_PRIVATE_DISPATCH_NAME(NAME)                                          \
     const auto& the_type = TYPE;                                            \
     /* don't use TYPE again in case it is an expensive or side-effect op */ \
     at::ScalarType _st = ::detail::scalar_type(the_type);                   \
@@ -331,6 +370,7 @@ inline void deprecated_AT_DISPATCH_ALL_TYPES_AND_HALF_AND_COMPLEX() {}
 
 #define AT_DISPATCH_QINT_TYPES(TYPE, NAME, ...)                             \
   [&] {                                                                     \
+    AT_PRIVATE_DISPATCH_NAME(NAME)                                          \
     const auto& the_type = TYPE;                                            \
     /* don't use TYPE again in case it is an expensive or side-effect op */ \
     at::ScalarType _st = ::detail::scalar_type(the_type);                   \
@@ -348,6 +388,7 @@ inline void deprecated_AT_DISPATCH_ALL_TYPES_AND_HALF_AND_COMPLEX() {}
 
 #define AT_DISPATCH_ALL_TYPES_AND_COMPLEX(TYPE, NAME, ...)                  \
   [&] {                                                                     \
+    AT_PRIVATE_DISPATCH_NAME(NAME)                                          \
     const auto& the_type = TYPE;                                            \
     /* don't use TYPE again in case it is an expensive or side-effect op*/  \
     at::ScalarType _st = ::detail::scalar_type(the_type);                   \
@@ -370,6 +411,7 @@ inline void deprecated_AT_DISPATCH_ALL_TYPES_AND_HALF_AND_COMPLEX() {}
 
 #define AT_DISPATCH_ALL_TYPES_AND(SCALARTYPE, TYPE, NAME, ...)          \
   [&] {                                                                 \
+    AT_PRIVATE_DISPATCH_NAME(NAME)                                      \
     switch (TYPE) {                                                     \
       AT_PRIVATE_CASE_TYPE(at::ScalarType::Byte, uint8_t, __VA_ARGS__)  \
       AT_PRIVATE_CASE_TYPE(at::ScalarType::Char, int8_t, __VA_ARGS__)   \
@@ -389,6 +431,7 @@ inline void deprecated_AT_DISPATCH_ALL_TYPES_AND_HALF_AND_COMPLEX() {}
 
 #define AT_DISPATCH_ALL_TYPES_AND_COMPLEX_AND(SCALARTYPE, TYPE, NAME, ...)  \
   [&] {                                                                     \
+    AT_PRIVATE_DISPATCH_NAME(NAME)                                          \
     switch (TYPE) {                                                         \
       AT_PRIVATE_CASE_TYPE(at::ScalarType::Byte, uint8_t, __VA_ARGS__)      \
       AT_PRIVATE_CASE_TYPE(at::ScalarType::Char, int8_t, __VA_ARGS__)       \
@@ -412,6 +455,7 @@ inline void deprecated_AT_DISPATCH_ALL_TYPES_AND_HALF_AND_COMPLEX() {}
 
 #define AT_DISPATCH_ALL_TYPES_AND2(SCALARTYPE1, SCALARTYPE2, TYPE, NAME, ...) \
   [&] {                                                                       \
+    AT_PRIVATE_DISPATCH_NAME(NAME)                                            \
     switch (TYPE) {                                                           \
       AT_PRIVATE_CASE_TYPE(at::ScalarType::Byte, uint8_t, __VA_ARGS__)        \
       AT_PRIVATE_CASE_TYPE(at::ScalarType::Char, int8_t, __VA_ARGS__)         \
@@ -436,6 +480,7 @@ inline void deprecated_AT_DISPATCH_ALL_TYPES_AND_HALF_AND_COMPLEX() {}
 #define AT_DISPATCH_ALL_TYPES_AND_COMPLEX_AND2(                             \
     SCALARTYPE1, SCALARTYPE2, TYPE, NAME, ...)                              \
   [&] {                                                                     \
+    AT_PRIVATE_DISPATCH_NAME(NAME)                                          \
     switch (TYPE) {                                                         \
       AT_PRIVATE_CASE_TYPE(at::ScalarType::Byte, uint8_t, __VA_ARGS__)      \
       AT_PRIVATE_CASE_TYPE(at::ScalarType::Char, int8_t, __VA_ARGS__)       \
@@ -464,6 +509,7 @@ inline void deprecated_AT_DISPATCH_ALL_TYPES_AND_HALF_AND_COMPLEX() {}
 #define AT_DISPATCH_ALL_TYPES_AND3(                                     \
     SCALARTYPE1, SCALARTYPE2, SCALARTYPE3, TYPE, NAME, ...)             \
   [&] {                                                                 \
+    AT_PRIVATE_DISPATCH_NAME(NAME)                                      \
     switch (TYPE) {                                                     \
       AT_PRIVATE_CASE_TYPE(at::ScalarType::Byte, uint8_t, __VA_ARGS__)  \
       AT_PRIVATE_CASE_TYPE(at::ScalarType::Char, int8_t, __VA_ARGS__)   \
@@ -492,6 +538,7 @@ inline void deprecated_AT_DISPATCH_ALL_TYPES_AND_HALF_AND_COMPLEX() {}
 #define AT_DISPATCH_ALL_TYPES_AND_COMPLEX_AND3(                             \
     SCALARTYPE1, SCALARTYPE2, SCALARTYPE3, TYPE, NAME, ...)                 \
   [&] {                                                                     \
+    AT_PRIVATE_DISPATCH_NAME(NAME)                                          \
     switch (TYPE) {                                                         \
       AT_PRIVATE_CASE_TYPE(at::ScalarType::Byte, uint8_t, __VA_ARGS__)      \
       AT_PRIVATE_CASE_TYPE(at::ScalarType::Char, int8_t, __VA_ARGS__)       \
@@ -527,6 +574,7 @@ inline void deprecated_AT_DISPATCH_ALL_TYPES_AND_HALF_AND_COMPLEX() {}
 
 #define AT_DISPATCH_ALL_TYPES_AND_HALF(TYPE, NAME, ...)                     \
   [&] {                                                                     \
+    AT_PRIVATE_DISPATCH_NAME(NAME)                                          \
     detail::deprecated_AT_DISPATCH_ALL_TYPES_AND_HALF();                    \
     const auto& the_type = TYPE;                                            \
     /* don't use TYPE again in case it is an expensive or side-effect op */ \
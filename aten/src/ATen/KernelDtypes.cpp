@@ -0,0 +1,39 @@
+#include <ATen/KernelDtypes.h>
+
+#include <mutex>
+
+namespace at {
+
+namespace {
+
+std::mutex& recorded_kernel_dtypes_mutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+std::map<std::string, std::set<ScalarType>>& kernel_dtypes() {
+  static std::map<std::string, std::set<ScalarType>> dtypes;
+  return dtypes;
+}
+
+} // namespace
+
+namespace detail {
+
+void record_kernel_dtype(const char* tag, ScalarType dtype) {
+  std::string kernel(tag);
+  if (kernel.size() >= 2 && kernel.front() == '"' && kernel.back() == '"') {
+    kernel = kernel.substr(1, kernel.size() - 2);
+  }
+  std::lock_guard<std::mutex> lock(recorded_kernel_dtypes_mutex());
+  kernel_dtypes()[kernel].insert(dtype);
+}
+
+} // namespace detail
+
+std::map<std::string, std::set<ScalarType>> recorded_kernel_dtypes() {
+  std::lock_guard<std::mutex> lock(recorded_kernel_dtypes_mutex());
+  return kernel_dtypes();
+}
+
+} // namespace at
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <c10/core/ScalarType.h>
+#include <c10/macros/Export.h>
+
+#include <map>
+#include <set>
+#include <string>
+
+// Selective build of the dtypes of the kernels.
+//
+// A kernel is named by the NAME of its AT_DISPATCH macro, e.g. add_cpu. A
+// build with TORCH_TRACE_KERNEL_DTYPES records the dtypes every kernel
+// dispatches to, which a run of the models of an app on their bundled inputs
+// turns into a list of (kernel, dtypes), see binaries/dump_operator_names.cc.
+// A build with TORCH_SELECTED_DTYPES, given such a list as SELECTED_DTYPES,
+// generates should_include_kernel_dtype() in ATen/selected_dtypes.h, and the
+// AT_DISPATCH macros only compile the branches of the dtypes it selects, the
+// others throwing. The kernels missing from the list keep all their dtypes.
+
+namespace at {
+
+// Whether `tag`, the stringized NAME of an AT_DISPATCH macro, e.g.
+// "\"add_cpu\"", is the name `kernel`, e.g. "add_cpu".
+constexpr bool kernel_tag_equals(const char* tag, const char* kernel) {
+  size_t i = tag[0] == '"' ? 1 : 0;
+  size_t j = 0;
+  while (kernel[j] != '\0' && tag[i] == kernel[j]) {
+    ++i;
+    ++j;
+  }
+  return kernel[j] == '\0' &&
+      (tag[i] == '\0' || (tag[i] == '"' && tag[i + 1] == '\0'));
+}
+
+namespace detail {
+
+CAFFE2_API void record_kernel_dtype(const char* tag, ScalarType dtype);
+
+} // namespace detail
+
+// The dtypes each kernel dispatched to since the process started, by kernel
+// name. It is always empty unless built with TORCH_TRACE_KERNEL_DTYPES.
+CAFFE2_API std::map<std::string, std::set<ScalarType>> recorded_kernel_dtypes();
+
+} // namespace at
@@ -0,0 +1,63 @@
+#include <ATen/OperatorMetrics.h>
+
+#include <ATen/record_function.h>
+#include <c10/util/Metrics.h>
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace at {
+
+namespace {
+
+std::mutex& callbackMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+CallbackHandle& callbackHandle() {
+  static CallbackHandle handle = 0;
+  return handle;
+}
+
+void countCall(const RecordFunction& fn) {
+  if (!c10::metrics::enabled()) {
+    return;
+  }
+  // The counters of the operators this thread called, so that only their
+  // first call goes to the registry.
+  thread_local std::unordered_map<std::string, c10::metrics::Counter*>
+      counters;
+  std::string name = fn.name().str();
+  auto it = counters.find(name);
+  if (it == counters.end()) {
+    auto& counter = c10::metrics::MetricsRegistry::get().counter(
+        "aten_op_calls_total",
+        "Calls of the operators through the dispatcher",
+        "op=\"" + name + "\"");
+    it = counters.emplace(std::move(name), &counter).first;
+  }
+  it->second->add();
+}
+
+} // namespace
+
+void enableOperatorMetrics(bool enable) {
+  std::lock_guard<std::mutex> guard(callbackMutex());
+  auto& handle = callbackHandle();
+  if (enable && handle == 0) {
+    handle = addGlobalCallback(
+        RecordFunctionCallback(countCall).scopes({RecordScope::FUNCTION}));
+  } else if (!enable && handle != 0) {
+    removeCallback(handle);
+    handle = 0;
+  }
+}
+
+bool operatorMetricsEnabled() {
+  std::lock_guard<std::mutex> guard(callbackMutex());
+  return callbackHandle() != 0;
+}
+
+} // namespace at
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <c10/macros/Export.h>
+
+namespace at {
+
+// Counts the calls of every operator, in the aten_op_calls_total counters of
+// the c10::metrics registry labeled with the name of the operator. This
+// observes the operators with a RecordFunction callback, which the metrics
+// being disabled turns into a no-op, see c10::metrics::setEnabled.
+CAFFE2_API void enableOperatorMetrics(bool enable);
+CAFFE2_API bool operatorMetricsEnabled();
+
+} // namespace at
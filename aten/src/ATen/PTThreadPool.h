@@ -5,15 +5,61 @@
 
 namespace at {
 
+// Placement of the workers of a PyTorch thread pool.
+struct CAFFE2_API ThreadPoolAffinity {
+  // CPUs to pin the workers to: the i-th worker to start runs on
+  // cpus[(first_cpu + i) % cpus.size()]. Empty leaves placement to the OS.
+  std::vector<int> cpus;
+  // NUMA node the workers bind to (see c10::NUMABind), -1 for none
+  int numa_node_id = -1;
+  size_t first_cpu = 0;
+
+  bool empty() const {
+    return cpus.empty() && numa_node_id < 0;
+  }
+};
+
+namespace internal {
+
+// Returns the init function run by every worker of a PyTorch thread pool.
+CAFFE2_API std::function<void()> pool_thread_init(ThreadPoolAffinity affinity);
+
+// Reads a ThreadPoolAffinity from the given environment variables, holding
+// a CPU list such as "0-15,32-47" and a NUMA node id respectively.
+CAFFE2_API ThreadPoolAffinity thread_pool_affinity_from_env(
+    const char* cpus_var,
+    const char* numa_node_var);
+
+} // namespace internal
+
 class CAFFE2_API PTThreadPool : public c10::ThreadPool {
 public:
   explicit PTThreadPool(
       int pool_size,
       int numa_node_id = -1)
-    : c10::ThreadPool(pool_size, numa_node_id, [](){
-        c10::setThreadName("PTThreadPool");
-        at::init_num_threads();
-      }) {}
+    : PTThreadPool(pool_size, ThreadPoolAffinity{{}, numa_node_id}) {}
+
+  PTThreadPool(int pool_size, ThreadPoolAffinity affinity)
+    : c10::ThreadPool(
+          pool_size,
+          affinity.numa_node_id,
+          internal::pool_thread_init(affinity)) {}
+};
+
+class CAFFE2_API PTWorkStealingThreadPool
+    : public c10::WorkStealingThreadPool {
+public:
+  explicit PTWorkStealingThreadPool(
+      int pool_size,
+      int numa_node_id = -1)
+    : PTWorkStealingThreadPool(
+          pool_size, ThreadPoolAffinity{{}, numa_node_id}) {}
+
+  PTWorkStealingThreadPool(int pool_size, ThreadPoolAffinity affinity)
+    : c10::WorkStealingThreadPool(
+          pool_size,
+          affinity.numa_node_id,
+          internal::pool_thread_init(affinity)) {}
 };
 
 } // namespace at
@@ -4,6 +4,8 @@
 #include <ATen/core/ivalue.h>
 #include <c10/macros/Macros.h>
 
+#include <algorithm>
+
 namespace at {
 namespace internal {
 // This parameter is heuristically chosen to determine the minimum number of
@@ -12,6 +14,19 @@ namespace internal {
 // no parallel algorithm (such as parallel_reduce) should split work into
 // smaller than GRAIN_SIZE chunks.
 constexpr int64_t GRAIN_SIZE = 32768;
+
+// Number of elements per chunk for a loop that costs about
+// `cycles_per_element` cycles per element. GRAIN_SIZE is taken to be right
+// for one cycle per element, so cheaper loops get larger chunks and more
+// expensive loops smaller ones, keeping the work per chunk roughly constant.
+inline int64_t grain_size_for_cost(double cycles_per_element) {
+  if (!(cycles_per_element > 0)) {
+    return GRAIN_SIZE;
+  }
+  double grain_size = static_cast<double>(GRAIN_SIZE) / cycles_per_element;
+  grain_size = std::min(grain_size, static_cast<double>(64 * GRAIN_SIZE));
+  return std::max<int64_t>(1, static_cast<int64_t>(grain_size));
+}
 } // namespace internal
 
 inline int64_t divup(int64_t x, int64_t y) {
@@ -127,6 +142,16 @@ CAFFE2_API void set_num_interop_threads(int);
 // Returns the number of threads used for inter-op parallelism
 CAFFE2_API int get_num_interop_threads();
 
+// Pins the inter-op threads: the i-th thread to start runs on
+// cpus[i % cpus.size()]. If numa_node_id is not -1 the threads also bind to
+// that NUMA node (see c10::NUMABind), and if cpus is empty they are pinned to
+// the node's CPUs. Must be called before inter-op work starts; otherwise the
+// ATEN_INTEROP_CPUS and ATEN_INTEROP_NUMA_NODE environment variables are
+// used, e.g. ATEN_INTEROP_CPUS=32-63.
+CAFFE2_API void set_interop_thread_affinity(
+    std::vector<int> cpus,
+    int numa_node_id = -1);
+
 // Launches inter-op parallel task
 CAFFE2_API void launch(std::function<void()> func);
 namespace internal {
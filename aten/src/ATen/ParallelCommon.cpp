@@ -3,7 +3,10 @@
 #include <ATen/Config.h>
 #include <ATen/PTThreadPool.h>
 #include <ATen/Version.h>
+#include <c10/core/thread_budget.h>
 
+#include <atomic>
+#include <memory>
 #include <sstream>
 #include <thread>
 
@@ -42,6 +45,58 @@ size_t get_env_num_threads(const char* var_name, size_t def_value = 0) {
 
 } // namespace
 
+namespace internal {
+
+std::function<void()> pool_thread_init(ThreadPoolAffinity affinity) {
+  if (affinity.cpus.empty() && affinity.numa_node_id >= 0) {
+    affinity.cpus = c10::GetNUMANodeCPUs(affinity.numa_node_id);
+  }
+  auto next_worker = std::make_shared<std::atomic<size_t>>(0);
+  return [affinity, next_worker]() {
+    c10::setThreadName("PTThreadPool");
+    if (!affinity.cpus.empty()) {
+      size_t worker = next_worker->fetch_add(1);
+      int cpu =
+          affinity.cpus[(affinity.first_cpu + worker) % affinity.cpus.size()];
+      try {
+        c10::SetThreadAffinity({cpu});
+      } catch (const std::exception& e) {
+        LOG(WARNING) << "Could not pin thread pool worker to CPU " << cpu
+                     << ": " << e.what();
+      }
+    }
+    // Binds memory allocation to the node as well; together with the
+    // NUMAMove in c10::alloc_cpu this keeps tensors created by pool workers
+    // on the workers' node.
+    c10::NUMABind(affinity.numa_node_id);
+    at::init_num_threads();
+  };
+}
+
+ThreadPoolAffinity thread_pool_affinity_from_env(
+    const char* cpus_var,
+    const char* numa_node_var) {
+  ThreadPoolAffinity affinity;
+  try {
+    if (auto* value = std::getenv(cpus_var)) {
+      affinity.cpus = c10::ParseCPUList(value);
+    }
+    if (auto* value = std::getenv(numa_node_var)) {
+      affinity.numa_node_id = c10::stoi(value);
+      TORCH_CHECK(affinity.numa_node_id >= 0);
+    }
+  } catch (const std::exception& e) {
+    std::ostringstream oss;
+    oss << "Invalid " << cpus_var << " or " << numa_node_var
+        << " variable value, " << e.what();
+    TORCH_WARN(oss.str());
+    return ThreadPoolAffinity();
+  }
+  return affinity;
+}
+
+} // namespace internal
+
 std::string get_parallel_info() {
   std::ostringstream ss;
 
@@ -70,10 +125,33 @@ std::string get_parallel_info() {
      << get_env_var("OMP_NUM_THREADS", "[not set]") << std::endl;
   ss << "\tMKL_NUM_THREADS : "
      << get_env_var("MKL_NUM_THREADS", "[not set]") << std::endl;
+  ss << "\tATEN_INTRAOP_CPUS : "
+     << get_env_var("ATEN_INTRAOP_CPUS", "[not set]") << std::endl;
+  ss << "\tATEN_INTEROP_CPUS : "
+     << get_env_var("ATEN_INTEROP_CPUS", "[not set]") << std::endl;
+  ss << "\tTORCH_THREAD_BUDGET : "
+     << get_env_var("TORCH_THREAD_BUDGET", "[not set]") << std::endl;
+
+  auto& budget = c10::ThreadBudget::global();
+  ss << "Thread budget: ";
+  if (budget.cap() > 0) {
+    ss << budget.cap();
+  } else {
+    ss << "[no cap]";
+  }
+  ss << ", " << budget.numThreads() << " pool threads" << std::endl;
+  for (int kind = 0; kind < static_cast<int>(c10::ThreadPoolKind::NumKinds);
+       ++kind) {
+    auto pool_kind = static_cast<c10::ThreadPoolKind>(kind);
+    ss << "\t" << c10::toString(pool_kind) << " : "
+       << budget.numThreads(pool_kind) << std::endl;
+  }
 
   ss << "ATen parallel backend: ";
   #if AT_PARALLEL_OPENMP
   ss << "OpenMP";
+  #elif AT_PARALLEL_NATIVE_WS
+  ss << "native work stealing thread pool";
   #elif AT_PARALLEL_NATIVE
   ss << "native thread pool";
   #elif AT_PARALLEL_NATIVE_TBB
@@ -4,12 +4,14 @@
 #include <ATen/PTThreadPool.h>
 
 #ifndef C10_MOBILE
+#include <c10/core/thread_budget.h>
 #include <c10/core/thread_pool.h>
 #else
 #include <caffe2/utils/threadpool/pthreadpool-cpp.h>
 #endif // C10_MOBILE
 
 #include <atomic>
+#include <mutex>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -65,13 +67,49 @@ int _num_pool_threads(int nthreads) {
   return nthreads - 1;
 }
 
+// Placement of the intra-op threads set by the user, if not set taken from
+// ATEN_INTRAOP_CPUS / ATEN_INTRAOP_NUMA_NODE when the pool is created
+std::mutex intraop_affinity_mutex;
+c10::optional<ThreadPoolAffinity> intraop_affinity;
+
+std::shared_ptr<TaskThreadPoolBase> _create_intraop_pool() {
+  ThreadPoolAffinity affinity;
+  {
+    std::lock_guard<std::mutex> lock(intraop_affinity_mutex);
+    affinity = intraop_affinity ? *intraop_affinity
+                                : internal::thread_pool_affinity_from_env(
+                                      "ATEN_INTRAOP_CPUS",
+                                      "ATEN_INTRAOP_NUMA_NODE");
+  }
+  // Keep at least one thread, as parallel_for may have split work by the
+  // number of threads requested before the pool was created.
+  int pool_size = c10::ThreadBudget::global().acquire(
+      c10::ThreadPoolKind::IntraOp,
+      _num_pool_threads(num_intraop_threads.exchange(CONSUMED)));
+  if (affinity.empty()) {
+    return ThreadPoolRegistry()->Create(
+#if AT_PARALLEL_NATIVE_WS
+        "C10WorkStealing",
+#else
+        "C10",
+#endif
+        /* device_id */ 0,
+        /* pool_size */ pool_size,
+        /* create_new */ true); // create a separate thread pool for intra-op
+  }
+  // The first CPU is left to the thread calling parallel_for, which runs
+  // the first chunk itself.
+  affinity.first_cpu = 1;
+#if AT_PARALLEL_NATIVE_WS
+  return std::make_shared<PTWorkStealingThreadPool>(
+      pool_size, std::move(affinity));
+#else
+  return std::make_shared<PTThreadPool>(pool_size, std::move(affinity));
+#endif
+}
+
 TaskThreadPoolBase& _get_intraop_pool() {
-  static std::shared_ptr<TaskThreadPoolBase> pool =
-      ThreadPoolRegistry()->Create(
-          "C10",
-          /* device_id */ 0,
-          /* pool_size */ _num_pool_threads(num_intraop_threads.exchange(CONSUMED)),
-          /* create_new */ true); // create a separate thread pool for intra-op
+  static std::shared_ptr<TaskThreadPoolBase> pool = _create_intraop_pool();
   return *pool;
 }
 
@@ -112,6 +150,136 @@ struct ParallelRegionGuard {
   }
 };
 
+#ifndef C10_MOBILE
+
+// Nested parallelism, see set_nested_parallelism().
+std::atomic<bool> nested_parallelism_{false};
+// Maximum number of intra-op workers lent to nested loops at any time;
+// -1 means one less than the number of intra-op threads.
+std::atomic<int> max_nested_helpers_{-1};
+// Number of intra-op workers currently lent to nested loops.
+std::atomic<int> nested_helpers_{0};
+
+// Reserves up to `wanted` helpers within the cap, returns how many were
+// reserved.
+int _reserve_nested_helpers(int wanted) {
+  int cap = max_nested_helpers_.load();
+  if (cap < 0) {
+    cap = get_num_threads() - 1;
+  }
+  int current = nested_helpers_.load();
+  int reserved;
+  do {
+    reserved = std::min(wanted, cap - current);
+    if (reserved <= 0) {
+      return 0;
+    }
+  } while (!nested_helpers_.compare_exchange_weak(current, current + reserved));
+  return reserved;
+}
+
+// Like ParallelRegionGuard, but restores the enclosing region's state.
+struct NestedRegionGuard {
+  NestedRegionGuard(int64_t task_id)
+      : saved_thread_num_(thread_num_),
+        saved_in_region_(in_parallel_region_) {
+    _set_thread_num(task_id);
+    _set_in_parallel_region(true);
+  }
+
+  ~NestedRegionGuard() {
+    _set_in_parallel_region(saved_in_region_);
+    _set_thread_num(saved_thread_num_);
+  }
+
+ private:
+  size_t saved_thread_num_;
+  bool saved_in_region_;
+};
+
+// Runs a parallel_for issued from inside a parallel region. The calling
+// thread processes chunks itself and idle intra-op workers, if any, join in.
+// Workers that only get to their task after the caller has run out of chunks
+// return immediately, so the caller never waits for a task that has not
+// started and this cannot deadlock even when every worker is busy in an
+// enclosing loop.
+void _parallel_run_nested(
+    const int64_t begin,
+    const int64_t end,
+    const size_t num_tasks,
+    const size_t chunk_size,
+    const std::function<void(int64_t, int64_t, size_t)>& f) {
+  struct State {
+    std::atomic_flag err_flag = ATOMIC_FLAG_INIT;
+    std::exception_ptr eptr;
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t active = 0;
+    bool closed = false;
+    std::atomic<size_t> next_chunk{0};
+  };
+  auto state = std::make_shared<State>();
+
+  auto run_chunks = [&f, begin, end, chunk_size, num_tasks](State& state) {
+    for (size_t chunk_id = state.next_chunk++; chunk_id < num_tasks;
+         chunk_id = state.next_chunk++) {
+      int64_t local_start = begin + chunk_id * chunk_size;
+      int64_t local_end = std::min(end, (int64_t)(chunk_size + local_start));
+      try {
+        f(local_start, local_end, chunk_id);
+      } catch (...) {
+        if (!state.err_flag.test_and_set()) {
+          state.eptr = std::current_exception();
+        }
+      }
+    }
+  };
+
+  auto& pool = _get_intraop_pool();
+  int num_helpers = _reserve_nested_helpers(
+      std::min(num_tasks - 1, pool.numAvailable()));
+  for (int i = 1; i <= num_helpers; ++i) {
+    pool.run([state, run_chunks, i]() {
+      bool joined = false;
+      {
+        std::unique_lock<std::mutex> lk(state->mutex);
+        if (!state->closed) {
+          ++state->active;
+          joined = true;
+        }
+      }
+      if (joined) {
+        ParallelRegionGuard guard(i);
+        run_chunks(*state);
+      }
+      nested_helpers_--;
+      if (joined) {
+        std::unique_lock<std::mutex> lk(state->mutex);
+        if (--state->active == 0) {
+          state->cv.notify_one();
+        }
+      }
+    });
+  }
+
+  {
+    NestedRegionGuard guard(0);
+    run_chunks(*state);
+  }
+  {
+    std::unique_lock<std::mutex> lk(state->mutex);
+    state->closed = true;
+    while (state->active != 0) {
+      state->cv.wait(lk);
+    }
+  }
+  if (state->eptr) {
+    std::rethrow_exception(state->eptr);
+  }
+}
+
+#endif // C10_MOBILE
+
 } // namespace
 
 namespace internal {
@@ -127,28 +295,68 @@ void _parallel_run(
   std::tie(num_tasks, chunk_size) =
       internal::calc_num_tasks_and_chunk_size(begin, end, grain_size);
 
+#ifndef C10_MOBILE
+  if (in_parallel_region()) {
+    // parallel_for only gets here if nested parallelism is enabled
+    _parallel_run_nested(begin, end, num_tasks, chunk_size, f);
+    return;
+  }
+#endif // C10_MOBILE
+
   struct {
     std::atomic_flag err_flag = ATOMIC_FLAG_INIT;
     std::exception_ptr eptr;
     std::mutex mutex;
     volatile size_t remaining;
     std::condition_variable cv;
+    std::atomic<size_t> next_chunk{0};
   } state;
 
-  auto task = [f, &state, begin, end, chunk_size]
-      (int /* unused */, size_t task_id) {
-    int64_t local_start = begin + task_id * chunk_size;
+  auto run_chunk = [f, &state, begin, end, chunk_size](size_t chunk_id) {
+    int64_t local_start = begin + chunk_id * chunk_size;
     if (local_start < end) {
       int64_t local_end = std::min(end, (int64_t)(chunk_size + local_start));
       try {
-        ParallelRegionGuard guard(task_id);
-        f(local_start, local_end, task_id);
+        f(local_start, local_end, chunk_id);
       } catch (...) {
         if (!state.err_flag.test_and_set()) {
           state.eptr = std::current_exception();
         }
       }
     }
+  };
+
+#if AT_PARALLEL_NATIVE_WS
+  // calc_num_tasks_and_chunk_size splits the range into several chunks per
+  // thread. Start one task per thread and let each of them claim chunks until
+  // none are left, so that threads that drew cheap chunks keep helping while
+  // others are still busy with expensive ones.
+  size_t num_workers =
+      std::min(num_tasks, static_cast<size_t>(get_num_threads()));
+  auto task = [&run_chunk, &state, num_tasks]
+      (int /* unused */, size_t task_id) {
+    {
+      ParallelRegionGuard guard(task_id);
+      for (size_t chunk_id = state.next_chunk++; chunk_id < num_tasks;
+           chunk_id = state.next_chunk++) {
+        run_chunk(chunk_id);
+      }
+    }
+    {
+      std::unique_lock<std::mutex> lk(state.mutex);
+      if (--state.remaining == 0) {
+        state.cv.notify_one();
+      }
+    }
+  };
+  state.remaining = num_workers;
+  _run_with_pool(task, num_workers);
+#else
+  auto task = [&run_chunk, &state](int /* unused */, size_t task_id) {
+    {
+      ParallelRegionGuard guard(task_id);
+      run_chunk(task_id);
+    }
     {
       std::unique_lock<std::mutex> lk(state.mutex);
       if (--state.remaining == 0) {
@@ -158,6 +366,7 @@ void _parallel_run(
   };
   state.remaining = num_tasks;
   _run_with_pool(task, num_tasks);
+#endif
 
   // Wait for all tasks to finish.
   {
@@ -237,6 +446,50 @@ int get_thread_num() {
   return thread_num_;
 }
 
+void set_intraop_thread_affinity(std::vector<int> cpus, int numa_node_id) {
+#ifndef C10_MOBILE
+  TORCH_CHECK(
+      num_intraop_threads.load() != CONSUMED,
+      "Error: cannot set intra-op thread affinity after parallel work "
+      "has started");
+  TORCH_CHECK(numa_node_id >= -1, "Invalid NUMA node id ", numa_node_id);
+  std::lock_guard<std::mutex> lock(intraop_affinity_mutex);
+  intraop_affinity = ThreadPoolAffinity{std::move(cpus), numa_node_id};
+#else
+  if (numa_node_id >= 0) {
+    TORCH_WARN_ONCE(
+        "Binding intra-op threads to a NUMA node is not supported on mobile, "
+        "ignoring the numa_node_id of set_intraop_thread_affinity()");
+  }
+  caffe2::PThreadPool* const pool = caffe2::pthreadpool();
+  TORCH_INTERNAL_ASSERT(pool, "Invalid thread pool!");
+  pool->set_affinity(std::move(cpus));
+#endif // C10_MOBILE
+}
+
+void set_nested_parallelism(bool enabled, int max_helper_threads) {
+#ifndef C10_MOBILE
+  TORCH_CHECK(
+      max_helper_threads >= -1,
+      "Expected max_helper_threads to be non-negative or -1, got ",
+      max_helper_threads);
+  max_nested_helpers_ = max_helper_threads;
+  nested_parallelism_ = enabled;
+#else
+  TORCH_WARN_ONCE(
+      "Nested parallelism is not supported on mobile, ignoring "
+      "set_nested_parallelism()");
+#endif // C10_MOBILE
+}
+
+bool get_nested_parallelism() {
+#ifndef C10_MOBILE
+  return nested_parallelism_.load(std::memory_order_relaxed);
+#else
+  return false;
+#endif // C10_MOBILE
+}
+
 bool in_parallel_region() {
 #ifndef C10_MOBILE
   return in_parallel_region_ || (
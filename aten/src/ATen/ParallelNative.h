@@ -9,13 +9,25 @@
 namespace at {
 namespace internal {
 
+#if AT_PARALLEL_NATIVE_WS
+// Number of chunks per intra-op thread the work stealing backend splits a
+// range into, so that threads finishing early can pick up remaining work.
+constexpr int64_t kChunksPerThread = 4;
+#endif
+
 inline std::tuple<size_t, size_t> calc_num_tasks_and_chunk_size(
     int64_t begin, int64_t end, int64_t grain_size) {
   if ((end - begin) < grain_size) {
     return std::make_tuple(1, std::max((int64_t)0, end - begin));
   }
   // Choose number of tasks based on grain size and number of threads.
+#if AT_PARALLEL_NATIVE_WS
+  int64_t num_threads = get_num_threads();
+  size_t chunk_size = divup(
+      (end - begin), num_threads > 1 ? num_threads * kChunksPerThread : 1);
+#else
   size_t chunk_size = divup((end - begin), get_num_threads());
+#endif
   // Make sure each task is at least grain_size size.
   chunk_size = std::max((size_t)grain_size, chunk_size);
   size_t num_tasks = divup((end - begin), chunk_size);
@@ -30,6 +42,37 @@ CAFFE2_API void _parallel_run(
 
 } // namespace internal
 
+// Pins the intra-op threads. The calling thread runs the first chunk of
+// every parallel_for and is not pinned; cpus[0] is meant for it, and the
+// i-th worker to start runs on cpus[(i + 1) % cpus.size()]. numa_node_id
+// behaves as for set_interop_thread_affinity. Must be called before
+// intra-op work starts; otherwise ATEN_INTRAOP_CPUS and
+// ATEN_INTRAOP_NUMA_NODE are used. Only the native backend supports this.
+// On mobile all the threads of the pthreadpool are pinned to all of cpus,
+// at any time, and numa_node_id is ignored.
+CAFFE2_API void set_intraop_thread_affinity(
+    std::vector<int> cpus,
+    int numa_node_id = -1);
+
+// Nested parallelism
+//
+// By default parallel_for and parallel_reduce run sequentially on the calling
+// thread when called from inside a parallel region (e.g. from the body of
+// another parallel_for). When nested parallelism is enabled such a nested
+// loop instead splits its range as usual and offers the chunks to idle
+// intra-op workers; the calling thread keeps processing chunks itself, so
+// the loop makes progress even if no worker is free.
+//
+// max_helper_threads caps the number of intra-op workers lent to nested loops
+// at any one time, across all of them. The default (-1) is the number of
+// intra-op threads minus one, so nested loops never add threads beyond the
+// intra-op pool.
+//
+// Only the native backend supports this; it is off by default.
+CAFFE2_API void set_nested_parallelism(bool enabled, int max_helper_threads = -1);
+
+CAFFE2_API bool get_nested_parallelism();
+
 template <class F>
 inline void parallel_for(
     const int64_t begin,
@@ -40,7 +83,8 @@ inline void parallel_for(
   if (begin >= end) {
     return;
   }
-  if ((end - begin) < grain_size || in_parallel_region()) {
+  if ((end - begin) < grain_size ||
+      (in_parallel_region() && !get_nested_parallelism())) {
     f(begin, end);
     return;
   }
@@ -66,7 +110,8 @@ inline scalar_t parallel_reduce(
   if (begin >= end) {
     return ident;
   }
-  if ((end - begin) < grain_size || in_parallel_region()) {
+  if ((end - begin) < grain_size ||
+      (in_parallel_region() && !get_nested_parallelism())) {
     return f(begin, end, ident);
   }
   size_t num_tasks, chunk_size;
@@ -1,8 +1,10 @@
 #include <ATen/Config.h>
 #if AT_PARALLEL_OPENMP
 #include <ATen/Parallel.h>
+#include <c10/core/thread_budget.h>
 
 #include <atomic>
+#include <mutex>
 
 #ifdef TH_BLAS_MKL
 #include <mkl.h>
@@ -14,6 +16,21 @@ namespace {
 // Number of threads set by the user
 std::atomic<int> num_threads{-1};
 
+// The threads of an OpenMP team, besides the thread that forks it, granted
+// by the thread budget. Every thread running parallel work forks a team of
+// its own, and they are all counted as one.
+std::mutex budget_mutex;
+size_t budgeted_threads = 0;
+
+int budget_num_threads(int nthreads) {
+  std::lock_guard<std::mutex> lock(budget_mutex);
+  auto& budget = c10::ThreadBudget::global();
+  budget.release(c10::ThreadPoolKind::IntraOp, budgeted_threads);
+  budgeted_threads = budget.acquire(
+      c10::ThreadPoolKind::IntraOp, nthreads - 1, /* minimum */ 0);
+  return budgeted_threads + 1;
+}
+
 } // namespace
 
 void init_num_threads() {
@@ -26,9 +43,14 @@ void init_num_threads() {
     // Otherwise, MKL and our OpenMP-enabled functions will keep changing the
     // size of the OpenMP thread pool, resulting in worse performance (and memory
     // leaks in GCC 5.4)
-    omp_set_num_threads(mkl_get_max_threads());
+    int mkl_threads = mkl_get_max_threads();
+    int budgeted = budget_num_threads(mkl_threads);
+    omp_set_num_threads(budgeted);
+    if (budgeted != mkl_threads) {
+      mkl_set_num_threads(budgeted);
+    }
 #elif defined(_OPENMP)
-    omp_set_num_threads(intraop_default_num_threads());
+    omp_set_num_threads(budget_num_threads(intraop_default_num_threads()));
 #endif
   }
 }
@@ -36,6 +58,7 @@ void init_num_threads() {
 void set_num_threads(int nthreads) {
   TORCH_CHECK(nthreads > 0, "Expected positive number of threads");
   num_threads.store(nthreads);
+  nthreads = budget_num_threads(nthreads);
 #ifdef _OPENMP
   omp_set_num_threads(nthreads);
 #endif
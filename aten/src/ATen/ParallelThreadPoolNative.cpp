@@ -3,8 +3,10 @@
 #include <ATen/Parallel.h>
 #include <ATen/PTThreadPool.h>
 #include <ATen/ThreadLocalState.h>
+#include <c10/core/thread_budget.h>
 
 #include <atomic>
+#include <mutex>
 
 namespace at {
 
@@ -19,15 +21,40 @@ const int CONSUMED = -2;
 // NOT_SET -> CONSUMED
 std::atomic<int> num_interop_threads{NOT_SET};
 
+// Placement of the inter-op threads set by the user, if not set taken from
+// ATEN_INTEROP_CPUS / ATEN_INTEROP_NUMA_NODE when the pool is created
+std::mutex interop_affinity_mutex;
+c10::optional<ThreadPoolAffinity> interop_affinity;
+
+std::shared_ptr<TaskThreadPoolBase> create_interop_pool() {
+  ThreadPoolAffinity affinity;
+  {
+    std::lock_guard<std::mutex> lock(interop_affinity_mutex);
+    affinity = interop_affinity ? *interop_affinity
+                                : internal::thread_pool_affinity_from_env(
+                                      "ATEN_INTEROP_CPUS",
+                                      "ATEN_INTEROP_NUMA_NODE");
+  }
+  int pool_size = num_interop_threads.exchange(CONSUMED);
+  if (pool_size == NOT_SET) {
+    pool_size = TaskThreadPoolBase::defaultNumThreads();
+  }
+  pool_size = c10::ThreadBudget::global().acquire(
+      c10::ThreadPoolKind::InterOp, pool_size);
+  if (affinity.empty()) {
+    return ThreadPoolRegistry()->Create(
+        "C10",
+        /* device_id */ 0,
+        /* pool_size */ pool_size,
+        /* create_new */ true);
+  }
+  return std::make_shared<PTThreadPool>(pool_size, std::move(affinity));
+}
+
 // thread pool global instance is hidden,
 // users should use at::launch and get/set_num_interop_threads interface
 TaskThreadPoolBase& get_pool() {
-  static std::shared_ptr<TaskThreadPoolBase> pool =
-      ThreadPoolRegistry()->Create(
-          "C10",
-          /* device_id */ 0,
-          /* pool_size */ num_interop_threads.exchange(CONSUMED),
-          /* create_new */ true);
+  static std::shared_ptr<TaskThreadPoolBase> pool = create_interop_pool();
   return *pool;
 }
 
@@ -43,9 +70,22 @@ std::shared_ptr<TaskThreadPoolBase> create_c10_threadpool(
   return std::make_shared<PTThreadPool>(pool_size);
 }
 
+std::shared_ptr<TaskThreadPoolBase> create_c10_work_stealing_threadpool(
+    int device_id,
+    int pool_size,
+    bool create_new) {
+  TORCH_CHECK(device_id == 0);
+  TORCH_CHECK(create_new);
+  return std::make_shared<PTWorkStealingThreadPool>(pool_size);
+}
+
 } // namespace
 
 C10_REGISTER_CREATOR(ThreadPoolRegistry, C10, create_c10_threadpool);
+C10_REGISTER_CREATOR(
+    ThreadPoolRegistry,
+    C10WorkStealing,
+    create_c10_work_stealing_threadpool);
 
 void set_num_interop_threads(int nthreads) {
   TORCH_CHECK(nthreads > 0, "Expected positive number of threads");
@@ -56,6 +96,16 @@ void set_num_interop_threads(int nthreads) {
       "has started or set_num_interop_threads called");
 }
 
+void set_interop_thread_affinity(std::vector<int> cpus, int numa_node_id) {
+  TORCH_CHECK(
+      num_interop_threads.load() != CONSUMED,
+      "Error: cannot set inter-op thread affinity after parallel work "
+      "has started");
+  TORCH_CHECK(numa_node_id >= -1, "Invalid NUMA node id ", numa_node_id);
+  std::lock_guard<std::mutex> lock(interop_affinity_mutex);
+  interop_affinity = ThreadPoolAffinity{std::move(cpus), numa_node_id};
+}
+
 int get_num_interop_threads() {
   int nthreads = num_interop_threads.load();
   if (nthreads > 0) {
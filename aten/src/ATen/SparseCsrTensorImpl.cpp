@@ -0,0 +1,123 @@
+#include <ATen/ATen.h>
+#include <ATen/SparseCsrTensorImpl.h>
+#include <ATen/InitialTensorOptions.h>
+#include <ATen/core/LegacyTypeDispatch.h>
+
+namespace at {
+
+namespace {
+  DeviceType sparseCsrTensorSetToDeviceType(DispatchKeySet key_set) {
+    if (key_set.has(DispatchKey::SparseCsrCPU)) {
+      return kCPU;
+    } else if (key_set.has(DispatchKey::SparseCsrCUDA)) {
+      return kCUDA;
+    } else {
+      AT_ERROR("Cannot construct SparseCsrTensor with non-sparse CSR tensor type ID ", key_set);
+    }
+  }
+}
+
+// An empty CSR tensor is a [0, 0] matrix, with a single row offset.
+SparseCsrTensorImpl::SparseCsrTensorImpl(at::DispatchKeySet key_set, const caffe2::TypeMeta& data_type)
+  :   SparseCsrTensorImpl(key_set, data_type
+      , at::zeros({1}, at::initialTensorOptions().device(sparseCsrTensorSetToDeviceType(key_set)).dtype(ScalarType::Long))
+      , at::empty({0}, at::initialTensorOptions().device(sparseCsrTensorSetToDeviceType(key_set)).dtype(ScalarType::Long))
+      , at::empty({0}, at::initialTensorOptions().device(sparseCsrTensorSetToDeviceType(key_set)).dtype(data_type))) {}
+
+SparseCsrTensorImpl::SparseCsrTensorImpl(at::DispatchKeySet key_set, const caffe2::TypeMeta& data_type, at::Tensor crow_indices, at::Tensor col_indices, at::Tensor values)
+    : TensorImpl(key_set, data_type, values.device())
+    , crow_indices_(std::move(crow_indices))
+    , col_indices_(std::move(col_indices))
+    , values_(std::move(values)) {
+  // The members don't tell the number of columns, which
+  // set_member_tensors_unsafe and copy_tensor_metadata set.
+  sizes_and_strides_.set_sizes({crow_indices_.numel() - 1, 0});
+  refresh_numel();
+  AT_ASSERT(crow_indices_.device() == values_.device());
+  AT_ASSERT(col_indices_.device() == values_.device());
+  AT_ASSERT(values_.device() == device());
+}
+
+IntArrayRef SparseCsrTensorImpl::strides() const {
+  AT_ERROR("sparse CSR tensors do not have strides");
+}
+bool SparseCsrTensorImpl::is_contiguous(at::MemoryFormat memory_format) const {
+  AT_ERROR("sparse CSR tensors do not have is_contiguous");
+}
+int64_t SparseCsrTensorImpl::stride(int64_t d) const {
+  AT_ERROR("sparse CSR tensors do not have strides");
+}
+void SparseCsrTensorImpl::set_size(int64_t dim, int64_t new_size) {
+  AT_ERROR("sparse CSR tensors do not have set_size");
+}
+void SparseCsrTensorImpl::set_stride(int64_t dim, int64_t new_stride) {
+  AT_ERROR("sparse CSR tensors do not have set_stride");
+}
+void SparseCsrTensorImpl::set_storage_offset(int64_t storage_offset) {
+  AT_ERROR("sparse CSR tensors do not have set_storage_offset");
+}
+
+bool SparseCsrTensorImpl::has_storage() const {
+  return false;
+}
+const Storage& SparseCsrTensorImpl::storage() const {
+  AT_ERROR("sparse CSR tensors do not have storage");
+}
+int64_t SparseCsrTensorImpl::storage_offset() const {
+  AT_ERROR("sparse CSR tensors do not have storage");
+}
+
+void SparseCsrTensorImpl::resize_and_clear_(IntArrayRef size) {
+  TORCH_CHECK(allow_tensor_metadata_change(), "resize_and_clear_ ", err_msg_tensor_metadata_change_not_allowed);
+  TORCH_CHECK(size.size() == 2, "sparse CSR tensors must have 2 dimensions, but got ", size.size());
+  set_member_tensors_unsafe(
+      at::zeros({size[0] + 1}, crow_indices_.options()),
+      at::empty({0}, col_indices_.options()),
+      at::empty({0}, values_.options()),
+      size);
+}
+
+void SparseCsrTensorImpl::set_member_tensors_unsafe(
+    const Tensor& crow_indices,
+    const Tensor& col_indices,
+    const Tensor& values,
+    IntArrayRef size) {
+  TORCH_CHECK(allow_tensor_metadata_change(), "set_member_tensors_unsafe ", err_msg_tensor_metadata_change_not_allowed);
+  TORCH_INTERNAL_ASSERT(at::impl::variable_excluded_from_dispatch());
+
+  TORCH_CHECK(size.size() == 2, "sparse CSR tensors must have 2 dimensions, but got ", size.size());
+  TORCH_CHECK(
+      crow_indices.layout() == kStrided && col_indices.layout() == kStrided && values.layout() == kStrided,
+      "expected crow_indices, col_indices and values to be dense tensors, but got tensors of layouts ",
+      crow_indices.layout(), ", ", col_indices.layout(), " and ", values.layout());
+  TORCH_CHECK(values.device().type() == device().type(), "device type of values (", values.device().type(), ") must match device type of device().type()", device().type(), ")");
+  TORCH_CHECK(values.scalar_type() == typeMetaToScalarType(dtype()), "dtype of values (", values.scalar_type(), ") must match dtype of sparse CSR tensor (", typeMetaToScalarType(dtype()), ")");
+  TORCH_CHECK(
+      (crow_indices.scalar_type() == kInt || crow_indices.scalar_type() == kLong) &&
+          col_indices.scalar_type() == crow_indices.scalar_type(),
+      "crow_indices and col_indices must both be int32 or both be int64 tensors, but got ",
+      crow_indices.scalar_type(), " and ", col_indices.scalar_type());
+  TORCH_CHECK(
+      crow_indices.device() == values.device() && col_indices.device() == values.device(),
+      "crow_indices (", crow_indices.device(), "), col_indices (", col_indices.device(),
+      ") and values (", values.device(), ") must be on the same device");
+  TORCH_CHECK(
+      crow_indices.dim() == 1 && col_indices.dim() == 1 && values.dim() == 1,
+      "crow_indices, col_indices and values must be 1-dimensional, but got tensors of sizes ",
+      crow_indices.sizes(), ", ", col_indices.sizes(), " and ", values.sizes());
+  TORCH_CHECK(
+      crow_indices.size(0) == size[0] + 1,
+      "crow_indices must have nrows + 1 = ", size[0] + 1, " elements, but got ", crow_indices.size(0));
+  TORCH_CHECK(
+      col_indices.size(0) == values.size(0),
+      "col_indices and values must have the same nnz, but got ", col_indices.size(0), " and ", values.size(0));
+
+  crow_indices_ = crow_indices;
+  col_indices_ = col_indices;
+  values_ = values;
+  sizes_and_strides_.set_sizes(size);
+  refresh_numel();
+  AT_ASSERT(device() == values_.device());
+}
+
+} // namespace at
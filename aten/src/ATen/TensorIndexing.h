@@ -4,6 +4,8 @@
 #include <ATen/core/TensorBody.h>
 #include <ATen/ExpandUtils.h>
 #include <ATen/Functions.h>
+#include <ATen/TracerMode.h>
+#include <ATen/core/DimVector.h>
 
 namespace at {
 namespace indexing {
@@ -438,6 +440,96 @@ static inline Tensor applySlicing(
   }
   return result;
 }
+
+// Computes `self[indices]` for indices that are all integers, slices, None or
+// Ellipsis ("basic" indexing) as a single `as_strided` view of `self`, instead
+// of the chain of select / slice / unsqueeze calls of `applySlicing`, each of
+// which dispatches and, with autograd, records a node. The sizes and strides
+// are those the chain would produce. Returns an undefined tensor if any index
+// is of another kind or would raise an error, so that the caller takes the
+// general path, which also raises the errors.
+static inline Tensor applyBasicIndexing(const Tensor& self, const ArrayRef<TensorIndex>& indices) {
+  const auto device_type = self.device().type();
+  if (!(device_type == kCPU || device_type == kCUDA) || self.layout() != kStrided || self.is_quantized() ||
+      self.has_names() || self.unsafeGetTensorImpl()->key_set().has(DispatchKey::Batched)) {
+    return Tensor();
+  }
+  int64_t specified_dims = 0;
+  bool has_ellipsis = false;
+  for (const auto& index : indices) {
+    if (index.is_integer() || index.is_slice()) {
+      specified_dims++;
+    } else if (index.is_ellipsis()) {
+      if (has_ellipsis) {
+        return Tensor();
+      }
+      has_ellipsis = true;
+    } else if (!index.is_none()) {
+      return Tensor();
+    }
+  }
+  const int64_t ndim = self.dim();
+  if (specified_dims > ndim) {
+    return Tensor();
+  }
+
+  IntArrayRef self_sizes = self.sizes();
+  IntArrayRef self_strides = self.strides();
+  DimVector sizes;
+  DimVector strides;
+  int64_t storage_offset = self.storage_offset();
+  int64_t dim = 0;
+  for (const auto& index : indices) {
+    if (index.is_integer()) {
+      const int64_t size = self_sizes[dim];
+      int64_t i = index.integer();
+      if (i < -size || i >= size) {
+        return Tensor();
+      }
+      if (i < 0) {
+        i += size;
+      }
+      storage_offset += i * self_strides[dim];
+      dim++;
+    } else if (index.is_slice()) {
+      // mirrors at::native::slice
+      const int64_t size = self_sizes[dim];
+      int64_t start = index.slice().start();
+      int64_t stop = index.slice().stop();
+      const int64_t step = index.slice().step();
+      if (step <= 0) {
+        return Tensor();
+      }
+      if (start < 0) {
+        start += size;
+      }
+      if (stop < 0) {
+        stop += size;
+      }
+      start = std::min(std::max<int64_t>(start, 0), size);
+      stop = std::min(std::max(stop, start), size);
+      sizes.push_back((stop - start + step - 1) / step);
+      strides.push_back(self_strides[dim] * step);
+      storage_offset += start * self_strides[dim];
+      dim++;
+    } else if (index.is_none()) {
+      // mirrors at::native::unsqueeze, whose next dimension is the next
+      // dimension of `self` not indexed yet
+      sizes.push_back(1);
+      strides.push_back(dim < ndim ? self_sizes[dim] * self_strides[dim] : 1);
+    } else {
+      for (int64_t end = dim + ndim - specified_dims; dim < end; dim++) {
+        sizes.push_back(self_sizes[dim]);
+        strides.push_back(self_strides[dim]);
+      }
+    }
+  }
+  for (; dim < ndim; dim++) {
+    sizes.push_back(self_sizes[dim]);
+    strides.push_back(self_strides[dim]);
+  }
+  return self.as_strided(sizes, strides, storage_offset);
+}
 } // namespace impl
 
 static inline Tensor dispatch_index(const Tensor& self, std::vector<Tensor>&& indices) {
@@ -507,6 +599,15 @@ static inline Tensor get_item(const Tensor& self, const ArrayRef<TensorIndex>& i
     }
   }
 
+  // The tracer has to record every select and slice, see
+  // NOTE [ Setting `disable_slice_optimization` when calling C++ tensor indexing functions from Python ]
+  if (!disable_slice_optimization && !at::tracer::impl::is_dispatch_enabled()) {
+    Tensor result = impl::applyBasicIndexing(self, indices);
+    if (result.defined()) {
+      return result;
+    }
+  }
+
   std::vector<Tensor> tensorIndices;
   Tensor sliced = impl::applySlicing(self, indices, tensorIndices, disable_slice_optimization, self_device, self_sizes);
   if (tensorIndices.empty()) {
@@ -2,6 +2,7 @@
 #include <ATen/core/boxing/impl/make_boxed_from_unboxed_functor.h>
 #include <ATen/core/boxing/impl/WrapFunctionIntoFunctor.h>
 #include <ATen/core/boxing/impl/WrapFunctionIntoRuntimeFunctor.h>
+#include <c10/util/OverheadProbe.h>
 
 namespace c10 {
 
@@ -58,6 +59,7 @@ inline Return KernelFunction::call(const OperatorHandle& opHandle, Args... args)
         "Tried to call KernelFunction::call() on an uninitialized KernelFunction."
     );
 
+    C10_OVERHEAD_PROBE(Boxing);
     return impl::BoxedKernelWrapper<Return(Args...)>::call(
         boxed_kernel_func_,
         functor_.get(),
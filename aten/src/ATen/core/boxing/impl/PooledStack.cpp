@@ -0,0 +1,46 @@
+#include <ATen/core/boxing/impl/PooledStack.h>
+
+namespace c10 {
+namespace impl {
+
+namespace {
+
+// Enough for the nesting of boxed calls in practice, e.g. a backend fallback
+// calling an op that has a boxed kernel for another dispatch key.
+constexpr size_t kMaxPooledStacks = 8;
+// Stacks that grew larger than this (e.g. for ops taking lots of arguments)
+// give their memory back rather than keep it around.
+constexpr size_t kMaxPooledStackCapacity = 64;
+
+std::vector<torch::jit::Stack>& threadStackPool() {
+  static thread_local std::vector<torch::jit::Stack> pool = [] {
+    std::vector<torch::jit::Stack> result;
+    result.reserve(kMaxPooledStacks);
+    return result;
+  }();
+  return pool;
+}
+
+} // namespace
+
+PooledStack::PooledStack() {
+  auto& pool = threadStackPool();
+  if (!pool.empty()) {
+    stack_ = std::move(pool.back());
+    pool.pop_back();
+  }
+}
+
+PooledStack::~PooledStack() {
+  // Clear first, as destroying the values left on the stack can call ops
+  // that borrow stacks themselves.
+  stack_.clear();
+  auto& pool = threadStackPool();
+  if (pool.size() < kMaxPooledStacks &&
+      stack_.capacity() <= kMaxPooledStackCapacity) {
+    pool.push_back(std::move(stack_));
+  }
+}
+
+} // namespace impl
+} // namespace c10
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <ATen/core/stack.h>
+
+namespace c10 {
+namespace impl {
+
+/**
+ * A torch::jit::Stack borrowed from a pool of the current thread, which the
+ * unboxed to boxed wrappers (in boxing.h) box the arguments of a call onto.
+ * In the destructor, the stack is cleared and goes back to the pool, keeping
+ * its buffer, so that once a thread has warmed up, calling a boxed kernel
+ * (e.g. a backend fallback) through the unboxed API does not allocate a
+ * stack. As a boxed kernel can call other ops in turn, several stacks
+ * can be borrowed at once; the pool holds on to a few of them.
+ */
+class CAFFE2_API PooledStack final {
+ public:
+  PooledStack();
+  ~PooledStack();
+
+  PooledStack(const PooledStack&) = delete;
+  PooledStack& operator=(const PooledStack&) = delete;
+  PooledStack(PooledStack&&) = delete;
+  PooledStack& operator=(PooledStack&&) = delete;
+
+  torch::jit::Stack* get() {
+    return &stack_;
+  }
+
+  torch::jit::Stack& operator*() {
+    return stack_;
+  }
+
+  torch::jit::Stack* operator->() {
+    return &stack_;
+  }
+
+ private:
+  torch::jit::Stack stack_;
+};
+
+} // namespace impl
+} // namespace c10
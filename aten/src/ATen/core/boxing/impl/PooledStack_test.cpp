@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include <ATen/core/boxing/impl/PooledStack.h>
+
+#include <thread>
+
+using c10::IValue;
+using c10::impl::PooledStack;
+
+TEST(PooledStackTest, givenReturnedStack_whenBorrowingAgain_thenReusesItsBuffer) {
+  const IValue* data;
+  {
+    PooledStack stack;
+    stack->push_back(1);
+    stack->push_back(2);
+    data = stack->data();
+  }
+  PooledStack stack;
+  EXPECT_TRUE(stack->empty());
+  EXPECT_EQ(data, stack->data());
+  EXPECT_GE(stack->capacity(), 2);
+}
+
+TEST(PooledStackTest, givenNestedStacks_whenBorrowing_thenTheyAreDistinct) {
+  PooledStack outer;
+  outer->push_back(1);
+  {
+    PooledStack inner;
+    inner->push_back(2);
+    EXPECT_NE(outer.get(), inner.get());
+    EXPECT_NE(outer->data(), inner->data());
+  }
+  ASSERT_EQ(1, outer->size());
+  EXPECT_EQ(1, outer->at(0).toInt());
+}
+
+TEST(PooledStackTest, givenStackWithValues_whenReturning_thenValuesAreReleased) {
+  auto tuple = c10::make_intrusive<c10::ivalue::Tuple>(std::vector<IValue>{});
+  {
+    PooledStack stack;
+    stack->emplace_back(tuple);
+    EXPECT_EQ(2, tuple.use_count());
+  }
+  EXPECT_EQ(1, tuple.use_count());
+}
+
+TEST(PooledStackTest, givenThreads_whenBorrowing_thenPoolsArePerThread) {
+  const IValue* data;
+  {
+    PooledStack stack;
+    stack->push_back(1);
+    data = stack->data();
+  }
+  std::thread([data] {
+    PooledStack stack;
+    stack->push_back(1);
+    EXPECT_NE(data, stack->data());
+  }).join();
+}
@@ -7,6 +7,7 @@
 #include <c10/core/TensorOptions.h>
 
 #include <ATen/core/boxing/KernelFunction.h>
+#include <ATen/core/boxing/impl/PooledStack.h>
 
 #include <c10/util/Metaprogramming.h>
 
@@ -81,7 +82,7 @@ using can_unbox =
 //
 // 2. a `call` method that
 // - takes a boxed kernel and unboxed arguments as specified by FT,
-// - calls `boxArgs` to box the arguments
+// - boxes the arguments onto a PooledStack, moving those passed by value
 // - calls the boxed kernel
 // - unboxes and returns the result
 //
@@ -154,7 +155,6 @@ struct BoxedKernelWrapper<
   >
 > {
   static torch::jit::Stack boxArgs(Args... args) {
-    // TODO Reuse stack vector instead of allocating?
     torch::jit::Stack stack;
     stack.reserve(sizeof...(Args));
     torch::jit::push(stack, std::forward<Args>(args)...);
@@ -167,20 +167,22 @@ struct BoxedKernelWrapper<
     const OperatorHandle& opHandle,
     Args... args
   ) {
-    torch::jit::Stack stack = boxArgs(args...);
-    (*boxed_kernel_func)(functor, opHandle, &stack);
+    PooledStack stack;
+    stack->reserve(sizeof...(Args));
+    torch::jit::push(*stack, std::forward<Args>(args)...);
+    (*boxed_kernel_func)(functor, opHandle, stack.get());
 
     return guts::if_constexpr<!std::is_same<void, Result>::value>(
       [&] (auto delay_check) {
         // op has pushed one or more values onto the stack.
-        return delay_check(PopResult<Result>::call(stack));
+        return delay_check(PopResult<Result>::call(*stack));
       },
       [&] {
         // op returns void, boxed kernel has pushed nothing onto stack.
         TORCH_INTERNAL_ASSERT_DEBUG_ONLY(
-          stack.size() == 0,
+          stack->size() == 0,
           "Boxed kernel was expected to return no values on the stack, ",
-          "but instead returned ", stack.size(), " values."
+          "but instead returned ", stack->size(), " values."
         );
       }
     );
@@ -202,7 +204,6 @@ struct BoxedKernelWrapper<
   std::enable_if_t<can_box_all<OtherArgs...>::value, void>
 > {
   static torch::jit::Stack boxArgs(at::Tensor& outArg, OtherArgs... otherArgs) {
-    // TODO Reuse stack vector instead of allocating?
     torch::jit::Stack stack;
     stack.reserve(1 + sizeof...(OtherArgs));
     torch::jit::push_one(stack, outArg);
@@ -217,12 +218,15 @@ struct BoxedKernelWrapper<
     at::Tensor& outArg,
     OtherArgs... otherArgs
   ) {
-    torch::jit::Stack stack = boxArgs(outArg, otherArgs...);
-    (*boxed_kernel_func)(functor, opHandle, &stack);
+    PooledStack stack;
+    stack->reserve(1 + sizeof...(OtherArgs));
+    torch::jit::push_one(*stack, outArg);
+    torch::jit::push(*stack, std::forward<OtherArgs>(otherArgs)...);
+    (*boxed_kernel_func)(functor, opHandle, stack.get());
     TORCH_INTERNAL_ASSERT_DEBUG_ONLY(
-      stack.size() == 1,
+      stack->size() == 1,
       "Boxed kernel was expected to return a single value on the stack, ",
-      "but instead returned ", stack.size(), " values."
+      "but instead returned ", stack->size(), " values."
     );
 
     return outArg;
@@ -247,7 +251,6 @@ struct BoxedKernelWrapper<
   >
 > {
   static torch::jit::Stack boxArgs(Args... args) {
-    // TODO Reuse stack vector instead of allocating?
     torch::jit::Stack stack;
     stack.reserve(sizeof...(Args));
     torch::jit::push(stack, std::forward<Args>(args)...);
@@ -263,12 +266,14 @@ struct BoxedKernelWrapper<
     using ArgTuple = std::tuple<Args...>;
     constexpr int RetCount = std::tuple_size<Result>();
 
-    torch::jit::Stack stack = boxArgs(args...);
-    (*boxed_kernel_func)(functor, opHandle, &stack);
+    PooledStack stack;
+    stack->reserve(sizeof...(Args));
+    torch::jit::push(*stack, args...);
+    (*boxed_kernel_func)(functor, opHandle, stack.get());
     TORCH_INTERNAL_ASSERT_DEBUG_ONLY(
-      stack.size() == RetCount,
+      stack->size() == RetCount,
       "Boxed kernel was expected to return ", RetCount, " values on the stack, ",
-      "but instead returned ", stack.size(), " values."
+      "but instead returned ", stack->size(), " values."
     );
 
     auto result = guts::tuple_take<ArgTuple, RetCount>(ArgTuple{args...});
@@ -4,6 +4,7 @@
 #include <ATen/core/function_schema.h>
 #include <ATen/core/jit_type.h>
 #include <c10/util/Bitset.h>
+#include <c10/util/OverheadProbe.h>
 #include <c10/core/DispatchKeySet.h>
 #include <ATen/core/Variadic.h>
 #include <ATen/core/stack.h>
@@ -119,6 +120,7 @@ public:
   }
 
   DispatchKey getDispatchKeyBoxed(const torch::jit::Stack* stack) const {
+    C10_OVERHEAD_PROBE(KeyExtraction);
     DispatchKeySet ks;
     dispatch_arg_indices_reverse_.for_each_set_bit([&] (size_t reverse_arg_index) {
       const auto& ivalue = torch::jit::peek(*stack, 0, reverse_arg_index + 1);
@@ -137,6 +139,7 @@ public:
 
   template<class... Args>
   DispatchKey getDispatchKeyUnboxed(DispatchKeySet eligibleKeys, const Args&... args) const {
+    C10_OVERHEAD_PROBE(KeyExtraction);
     auto ks = detail::multi_dispatch_key_set(args...);
     return dispatchKeySetToDispatchKey_(eligibleKeys, ks);
   }
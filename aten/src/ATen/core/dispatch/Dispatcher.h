@@ -9,6 +9,7 @@
 #include <ATen/record_function.h>
 #include <c10/util/Exception.h>
 #include <c10/util/LeftRight.h>
+#include <c10/util/OverheadProbe.h>
 #include <mutex>
 #include <list>
 
@@ -340,6 +341,7 @@ template<class... Args> inline void unused_arg_(const Args&...) {}
 template<class Return, class... Args>
 inline Return Dispatcher::callWithDispatchKey(const TypedOperatorHandle<Return(Args...)>& op, DispatchKey dispatchKey, Args... args) const {
   detail::unused_arg_(args...);  // workaround for a false-positive warning about unused parameters in gcc 5
+  C10_OVERHEAD_PROBE(Dispatch);
   const KernelFunction& kernel = op.operatorIterator_->op.lookup(dispatchKey);
 
 #ifndef PYTORCH_DISABLE_PER_OP_PROFILING
@@ -349,6 +351,8 @@ inline Return Dispatcher::callWithDispatchKey(const TypedOperatorHandle<Return(A
 
   // Note: for perf reasons we wouldn't want to pass arguments into
   // the function call or prematurely box them
+  // The probe also times the end callbacks, as the guard goes first.
+  C10_OVERHEAD_PROBE(RecordFunction);
   at::RecordFunction guard(at::RecordScope::FUNCTION);
   if (C10_UNLIKELY(guard.active)) {
     if (shouldRecord(dispatchKey) && op.operatorIterator_->op.isObserved()) {
@@ -367,6 +371,7 @@ inline Return Dispatcher::callWithDispatchKey(const TypedOperatorHandle<Return(A
     }
   }
 #endif  // PYTORCH_DISABLE_PER_OP_PROFILING
+  C10_OVERHEAD_PROBE(Kernel);
   return kernel.template call<Return, Args...>(op, std::forward<Args>(args)...);
 }
 
@@ -384,6 +389,7 @@ inline Return Dispatcher::call(const TypedOperatorHandle<Return(Args...)>& op, A
 template<class Return, class... Args>
 inline Return Dispatcher::redispatch(const TypedOperatorHandle<Return (Args...)>& op, DispatchKey currentDispatchKey, Args... args) const {
   detail::unused_arg_(args...);  // workaround for a false-positive warning about unused parameters in gcc 5
+  C10_OVERHEAD_PROBE(Dispatch);
   auto dispatchKey = op.operatorIterator_->op.dispatchKeyExtractor()
     .template getDispatchKeyUnboxed<Args...>(
       DispatchKeySet(DispatchKeySet::FULL_AFTER, currentDispatchKey),
@@ -391,17 +397,20 @@ inline Return Dispatcher::redispatch(const TypedOperatorHandle<Return (Args...)>
     );
   // do not use RecordFunction on redispatch
   const KernelFunction& kernel = op.operatorIterator_->op.lookup(dispatchKey);
+  C10_OVERHEAD_PROBE(Kernel);
   return kernel.template call<Return, Args...>(op, std::forward<Args>(args)...);
 }
 
 inline void Dispatcher::callBoxed(const OperatorHandle& op, Stack* stack) const {
   // note: this doesn't need the mutex because write operations on the list keep iterators intact.
   const auto& entry = op.operatorIterator_->op;
+  C10_OVERHEAD_PROBE(Dispatch);
   auto dispatchKey = entry.dispatchKeyExtractor().getDispatchKeyBoxed(stack);
   const auto& kernel = entry.lookup(dispatchKey);
 
 #ifndef PYTORCH_DISABLE_PER_OP_PROFILING
   // using already existing stack to record function execution in observers
+  C10_OVERHEAD_PROBE(RecordFunction);
   at::RecordFunction guard(at::RecordScope::FUNCTION);
   if (C10_UNLIKELY(guard.active)) {
     if (shouldRecord(dispatchKey) && entry.isObserved()) {
@@ -417,6 +426,7 @@ inline void Dispatcher::callBoxed(const OperatorHandle& op, Stack* stack) const
     }
   }
 #endif  // PYTORCH_DISABLE_PER_OP_PROFILING
+  C10_OVERHEAD_PROBE(Kernel);
   kernel.callBoxed(op, stack);
 }
 
@@ -3,6 +3,7 @@
 #include <ATen/core/function_schema.h>
 #include <c10/util/Metaprogramming.h>
 #include <c10/util/flat_hash_map.h>
+#include <c10/util/OverheadProbe.h>
 #include <c10/util/either.h>
 #include <c10/core/DispatchKey.h>
 #include <ATen/core/ivalue.h>
@@ -170,6 +171,7 @@ public:
   [[noreturn]] void reportError(DispatchKey dispatchKey) const;
 
   const KernelFunction& lookup(DispatchKey k) const {
+    C10_OVERHEAD_PROBE(Lookup);
     const auto& kernel = dispatchTable_[static_cast<uint8_t>(k)];
     if (C10_UNLIKELY(!kernel.isValid())) {
       reportError(k);
@@ -560,6 +560,40 @@ bool is_null_or_equal(c10::optional<T> a, c10::IntArrayRef b) {
   return !a.has_value() || a.value() == b;
 }
 
+template <typename T>
+static bool is_null_or_equal(
+    const c10::optional<T>& expected,
+    const c10::optional<T>& actual) {
+  return !expected.has_value() || expected == actual;
+}
+
+// Whether the stride properties of a tensor match the `expected` ones of a
+// type, whose unknown properties match any, as the strides of the profiled
+// types of tensors whose sizes vary are partially unknown.
+static bool matchStrideProps(
+    const VaryingShape<Stride>& expected,
+    const VaryingShape<Stride>& actual) {
+  if (expected == actual) {
+    return true;
+  }
+  if (!expected.size() || expected.size() != actual.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < *expected.size(); i++) {
+    const auto& e = expected[i];
+    const auto& a = actual[i];
+    if (!e) {
+      continue;
+    }
+    if (!a || !is_null_or_equal(e->stride_index_, a->stride_index_) ||
+        !is_null_or_equal(e->contiguous_, a->contiguous_) ||
+        !is_null_or_equal(e->stride_, a->stride_)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 bool TensorType::matchTensor(const at::Tensor& t) {
   bool undef = undefined().value_or(!t.defined());
   if (undef != !t.defined()) {
@@ -576,7 +610,7 @@ bool TensorType::matchTensor(const at::Tensor& t) {
   // Here we know t.defined() == true and compare all other properties.
   bool rg = at::GradMode::is_enabled() && t.requires_grad();
   bool matched_strides = (!t.has_storage() && !stride_properties().isComplete())
-    || stride_properties() == computeStrideProps(t.sizes(), t.strides(), t.is_contiguous());
+    || matchStrideProps(stride_properties(), computeStrideProps(t.sizes(), t.strides(), t.is_contiguous()));
   return scalarType().value_or(t.scalar_type()) == t.scalar_type()
     && device().value_or(t.device()) == t.device()
     && requiresGrad().value_or(rg) == rg
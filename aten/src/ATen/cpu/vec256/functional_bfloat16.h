@@ -0,0 +1,370 @@
+#pragma once
+
+// DO NOT DEFINE STATIC DATA IN THIS HEADER!
+// See Note [Do not compile initializers with AVX]
+
+#include <ATen/cpu/vec256/functional.h>
+
+namespace at { namespace vec256 {
+
+// Note [BFloat16 functional helpers]
+// These are the BFloat16 overloads of reduce_all, map_reduce_all, map, ... in
+// functional.h. Each Vec256<BFloat16> loaded from memory is widened into two
+// Vec256<float> and the functors are applied to those, so the functors take
+// and return Vec256<float>. Reductions accumulate in float and return float;
+// map* round to BFloat16 only once, when storing the result.
+//
+// They are picked by overload resolution when the data pointers are
+// BFloat16*, i.e. call them as `vec256::reduce_all(op, data, size)` without
+// an explicit template argument.
+
+template <typename Op>
+inline float reduce_all(const Op& vec_fun, const BFloat16* data, int64_t size) {
+  using bVec = vec256::Vec256<BFloat16>;
+  using fVec = vec256::Vec256<float>;
+  if (size < bVec::size()) {
+    bVec data_bvec = bVec::loadu(data, size);
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(data_bvec);
+    if (size > fVec::size()) {
+      data_fvec0 = fVec::set(data_fvec0, vec_fun(data_fvec0, data_fvec1), size - fVec::size());
+      return vec_reduce_all<float>(vec_fun, data_fvec0, fVec::size());
+    }
+    return vec_reduce_all<float>(vec_fun, data_fvec0, size);
+  }
+  int64_t d = bVec::size();
+  bVec acc_bvec = bVec::loadu(data);
+  fVec acc_fvec0, acc_fvec1;
+  std::tie(acc_fvec0, acc_fvec1) = convert_bfloat16_float(acc_bvec);
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    bVec data_bvec = bVec::loadu(data + d);
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(data_bvec);
+    acc_fvec0 = vec_fun(acc_fvec0, data_fvec0);
+    acc_fvec1 = vec_fun(acc_fvec1, data_fvec1);
+  }
+  if (size - d > 0) {
+    bVec data_bvec = bVec::loadu(data + d, size - d);
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(data_bvec);
+    if (size - d > fVec::size()) {
+      acc_fvec0 = vec_fun(acc_fvec0, data_fvec0);
+      acc_fvec1 = fVec::set(acc_fvec1, vec_fun(acc_fvec1, data_fvec1), size - d - fVec::size());
+    } else {
+      acc_fvec0 = fVec::set(acc_fvec0, vec_fun(acc_fvec0, data_fvec0), size - d);
+    }
+  }
+  acc_fvec0 = vec_fun(acc_fvec0, acc_fvec1);
+  return vec_reduce_all<float>(vec_fun, acc_fvec0, fVec::size());
+}
+
+template <typename MapOp, typename ReduceOp>
+inline float map_reduce_all(
+    const MapOp& map_fun,
+    const ReduceOp& red_fun,
+    const BFloat16* data,
+    int64_t size) {
+  using bVec = vec256::Vec256<BFloat16>;
+  using fVec = vec256::Vec256<float>;
+  if (size < bVec::size()) {
+    bVec data_bvec = bVec::loadu(data, size);
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(data_bvec);
+    if (size > fVec::size()) {
+      data_fvec0 = map_fun(data_fvec0);
+      data_fvec1 = map_fun(data_fvec1);
+      data_fvec0 = fVec::set(data_fvec0, red_fun(data_fvec0, data_fvec1), size - fVec::size());
+      return vec_reduce_all<float>(red_fun, data_fvec0, fVec::size());
+    }
+    data_fvec0 = map_fun(data_fvec0);
+    return vec_reduce_all<float>(red_fun, data_fvec0, size);
+  }
+  int64_t d = bVec::size();
+  bVec acc_bvec = bVec::loadu(data);
+  fVec acc_fvec0, acc_fvec1;
+  std::tie(acc_fvec0, acc_fvec1) = convert_bfloat16_float(acc_bvec);
+  acc_fvec0 = map_fun(acc_fvec0);
+  acc_fvec1 = map_fun(acc_fvec1);
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    bVec data_bvec = bVec::loadu(data + d);
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(data_bvec);
+    data_fvec0 = map_fun(data_fvec0);
+    data_fvec1 = map_fun(data_fvec1);
+    acc_fvec0 = red_fun(acc_fvec0, data_fvec0);
+    acc_fvec1 = red_fun(acc_fvec1, data_fvec1);
+  }
+  if (size - d > 0) {
+    bVec data_bvec = bVec::loadu(data + d, size - d);
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(data_bvec);
+    if (size - d > fVec::size()) {
+      data_fvec0 = map_fun(data_fvec0);
+      data_fvec1 = map_fun(data_fvec1);
+      acc_fvec0 = red_fun(acc_fvec0, data_fvec0);
+      acc_fvec1 = fVec::set(acc_fvec1, red_fun(acc_fvec1, data_fvec1), size - d - fVec::size());
+    } else {
+      data_fvec0 = map_fun(data_fvec0);
+      acc_fvec0 = fVec::set(acc_fvec0, red_fun(acc_fvec0, data_fvec0), size - d);
+    }
+  }
+  acc_fvec0 = red_fun(acc_fvec0, acc_fvec1);
+  return vec_reduce_all<float>(red_fun, acc_fvec0, fVec::size());
+}
+
+template <typename MapOp, typename ReduceOp>
+inline float map2_reduce_all(
+    const MapOp& map_fun,
+    const ReduceOp& red_fun,
+    const BFloat16* data,
+    const BFloat16* data2,
+    int64_t size) {
+  using bVec = vec256::Vec256<BFloat16>;
+  using fVec = vec256::Vec256<float>;
+  if (size < bVec::size()) {
+    bVec data_bvec = bVec::loadu(data, size);
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(data_bvec);
+    bVec data2_bvec = bVec::loadu(data2, size);
+    fVec data2_fvec0, data2_fvec1;
+    std::tie(data2_fvec0, data2_fvec1) = convert_bfloat16_float(data2_bvec);
+    if (size > fVec::size()) {
+      data_fvec0 = map_fun(data_fvec0, data2_fvec0);
+      data_fvec1 = map_fun(data_fvec1, data2_fvec1);
+      data_fvec0 = fVec::set(data_fvec0, red_fun(data_fvec0, data_fvec1), size - fVec::size());
+      return vec_reduce_all<float>(red_fun, data_fvec0, fVec::size());
+    }
+    data_fvec0 = map_fun(data_fvec0, data2_fvec0);
+    return vec_reduce_all<float>(red_fun, data_fvec0, size);
+  }
+  int64_t d = bVec::size();
+  bVec acc_bvec = bVec::loadu(data);
+  fVec acc_fvec0, acc_fvec1;
+  std::tie(acc_fvec0, acc_fvec1) = convert_bfloat16_float(acc_bvec);
+  bVec acc2_bvec = bVec::loadu(data2);
+  fVec acc2_fvec0, acc2_fvec1;
+  std::tie(acc2_fvec0, acc2_fvec1) = convert_bfloat16_float(acc2_bvec);
+  acc_fvec0 = map_fun(acc_fvec0, acc2_fvec0);
+  acc_fvec1 = map_fun(acc_fvec1, acc2_fvec1);
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    bVec data_bvec = bVec::loadu(data + d);
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(data_bvec);
+    bVec data2_bvec = bVec::loadu(data2 + d);
+    fVec data2_fvec0, data2_fvec1;
+    std::tie(data2_fvec0, data2_fvec1) = convert_bfloat16_float(data2_bvec);
+    data_fvec0 = map_fun(data_fvec0, data2_fvec0);
+    data_fvec1 = map_fun(data_fvec1, data2_fvec1);
+    acc_fvec0 = red_fun(acc_fvec0, data_fvec0);
+    acc_fvec1 = red_fun(acc_fvec1, data_fvec1);
+  }
+  if (size - d > 0) {
+    bVec data_bvec = bVec::loadu(data + d, size - d);
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(data_bvec);
+    bVec data2_bvec = bVec::loadu(data2 + d, size - d);
+    fVec data2_fvec0, data2_fvec1;
+    std::tie(data2_fvec0, data2_fvec1) = convert_bfloat16_float(data2_bvec);
+    if (size - d > fVec::size()) {
+      data_fvec0 = map_fun(data_fvec0, data2_fvec0);
+      data_fvec1 = map_fun(data_fvec1, data2_fvec1);
+      acc_fvec0 = red_fun(acc_fvec0, data_fvec0);
+      acc_fvec1 = fVec::set(acc_fvec1, red_fun(acc_fvec1, data_fvec1), size - d - fVec::size());
+    } else {
+      data_fvec0 = map_fun(data_fvec0, data2_fvec0);
+      acc_fvec0 = fVec::set(acc_fvec0, red_fun(acc_fvec0, data_fvec0), size - d);
+    }
+  }
+  acc_fvec0 = red_fun(acc_fvec0, acc_fvec1);
+  return vec_reduce_all<float>(red_fun, acc_fvec0, fVec::size());
+}
+
+template <typename MapOp, typename ReduceOp>
+inline float map3_reduce_all(
+    const MapOp& map_fun,
+    const ReduceOp& red_fun,
+    const BFloat16* data,
+    const BFloat16* data2,
+    const BFloat16* data3,
+    int64_t size) {
+  using bVec = vec256::Vec256<BFloat16>;
+  using fVec = vec256::Vec256<float>;
+  if (size < bVec::size()) {
+    bVec data_bvec = bVec::loadu(data, size);
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(data_bvec);
+    bVec data2_bvec = bVec::loadu(data2, size);
+    fVec data2_fvec0, data2_fvec1;
+    std::tie(data2_fvec0, data2_fvec1) = convert_bfloat16_float(data2_bvec);
+    bVec data3_bvec = bVec::loadu(data3, size);
+    fVec data3_fvec0, data3_fvec1;
+    std::tie(data3_fvec0, data3_fvec1) = convert_bfloat16_float(data3_bvec);
+    if (size > fVec::size()) {
+      data_fvec0 = map_fun(data_fvec0, data2_fvec0, data3_fvec0);
+      data_fvec1 = map_fun(data_fvec1, data2_fvec1, data3_fvec1);
+      data_fvec0 = fVec::set(data_fvec0, red_fun(data_fvec0, data_fvec1), size - fVec::size());
+      return vec_reduce_all<float>(red_fun, data_fvec0, fVec::size());
+    }
+    data_fvec0 = map_fun(data_fvec0, data2_fvec0, data3_fvec0);
+    return vec_reduce_all<float>(red_fun, data_fvec0, size);
+  }
+  int64_t d = bVec::size();
+  bVec acc_bvec = bVec::loadu(data);
+  fVec acc_fvec0, acc_fvec1;
+  std::tie(acc_fvec0, acc_fvec1) = convert_bfloat16_float(acc_bvec);
+  bVec acc2_bvec = bVec::loadu(data2);
+  fVec acc2_fvec0, acc2_fvec1;
+  std::tie(acc2_fvec0, acc2_fvec1) = convert_bfloat16_float(acc2_bvec);
+  bVec acc3_bvec = bVec::loadu(data3);
+  fVec acc3_fvec0, acc3_fvec1;
+  std::tie(acc3_fvec0, acc3_fvec1) = convert_bfloat16_float(acc3_bvec);
+  acc_fvec0 = map_fun(acc_fvec0, acc2_fvec0, acc3_fvec0);
+  acc_fvec1 = map_fun(acc_fvec1, acc2_fvec1, acc3_fvec1);
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    bVec data_bvec = bVec::loadu(data + d);
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(data_bvec);
+    bVec data2_bvec = bVec::loadu(data2 + d);
+    fVec data2_fvec0, data2_fvec1;
+    std::tie(data2_fvec0, data2_fvec1) = convert_bfloat16_float(data2_bvec);
+    bVec data3_bvec = bVec::loadu(data3 + d);
+    fVec data3_fvec0, data3_fvec1;
+    std::tie(data3_fvec0, data3_fvec1) = convert_bfloat16_float(data3_bvec);
+    data_fvec0 = map_fun(data_fvec0, data2_fvec0, data3_fvec0);
+    data_fvec1 = map_fun(data_fvec1, data2_fvec1, data3_fvec1);
+    acc_fvec0 = red_fun(acc_fvec0, data_fvec0);
+    acc_fvec1 = red_fun(acc_fvec1, data_fvec1);
+  }
+  if (size - d > 0) {
+    bVec data_bvec = bVec::loadu(data + d, size - d);
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(data_bvec);
+    bVec data2_bvec = bVec::loadu(data2 + d, size - d);
+    fVec data2_fvec0, data2_fvec1;
+    std::tie(data2_fvec0, data2_fvec1) = convert_bfloat16_float(data2_bvec);
+    bVec data3_bvec = bVec::loadu(data3 + d, size - d);
+    fVec data3_fvec0, data3_fvec1;
+    std::tie(data3_fvec0, data3_fvec1) = convert_bfloat16_float(data3_bvec);
+    if (size - d > fVec::size()) {
+      data_fvec0 = map_fun(data_fvec0, data2_fvec0, data3_fvec0);
+      data_fvec1 = map_fun(data_fvec1, data2_fvec1, data3_fvec1);
+      acc_fvec0 = red_fun(acc_fvec0, data_fvec0);
+      acc_fvec1 = fVec::set(acc_fvec1, red_fun(acc_fvec1, data_fvec1), size - d - fVec::size());
+    } else {
+      data_fvec0 = map_fun(data_fvec0, data2_fvec0, data3_fvec0);
+      acc_fvec0 = fVec::set(acc_fvec0, red_fun(acc_fvec0, data_fvec0), size - d);
+    }
+  }
+  acc_fvec0 = red_fun(acc_fvec0, acc_fvec1);
+  return vec_reduce_all<float>(red_fun, acc_fvec0, fVec::size());
+}
+
+template <typename Op>
+inline void map(
+    const Op& vec_fun,
+    BFloat16* output_data,
+    const BFloat16* input_data,
+    int64_t size) {
+  using bVec = vec256::Vec256<BFloat16>;
+  using fVec = vec256::Vec256<float>;
+  int64_t d = 0;
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    bVec data_bvec = bVec::loadu(input_data + d);
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(data_bvec);
+    fVec output_fvec0 = vec_fun(data_fvec0);
+    fVec output_fvec1 = vec_fun(data_fvec1);
+    bVec output_bvec = convert_float_bfloat16(output_fvec0, output_fvec1);
+    output_bvec.store(output_data + d);
+  }
+  if (size - d > 0) {
+    bVec data_bvec = bVec::loadu(input_data + d, size - d);
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(data_bvec);
+    fVec output_fvec0 = vec_fun(data_fvec0);
+    fVec output_fvec1 = vec_fun(data_fvec1);
+    bVec output_bvec = convert_float_bfloat16(output_fvec0, output_fvec1);
+    output_bvec.store(output_data + d, size - d);
+  }
+}
+
+template <typename Op>
+inline void map2(
+    const Op& vec_fun,
+    BFloat16* output_data,
+    const BFloat16* input_data,
+    const BFloat16* input_data2,
+    int64_t size) {
+  using bVec = vec256::Vec256<BFloat16>;
+  using fVec = vec256::Vec256<float>;
+  int64_t d = 0;
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    bVec data_bvec = bVec::loadu(input_data + d);
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(data_bvec);
+    bVec data2_bvec = bVec::loadu(input_data2 + d);
+    fVec data2_fvec0, data2_fvec1;
+    std::tie(data2_fvec0, data2_fvec1) = convert_bfloat16_float(data2_bvec);
+    fVec output_fvec0 = vec_fun(data_fvec0, data2_fvec0);
+    fVec output_fvec1 = vec_fun(data_fvec1, data2_fvec1);
+    bVec output_bvec = convert_float_bfloat16(output_fvec0, output_fvec1);
+    output_bvec.store(output_data + d);
+  }
+  if (size - d > 0) {
+    bVec data_bvec = bVec::loadu(input_data + d, size - d);
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(data_bvec);
+    bVec data2_bvec = bVec::loadu(input_data2 + d, size - d);
+    fVec data2_fvec0, data2_fvec1;
+    std::tie(data2_fvec0, data2_fvec1) = convert_bfloat16_float(data2_bvec);
+    fVec output_fvec0 = vec_fun(data_fvec0, data2_fvec0);
+    fVec output_fvec1 = vec_fun(data_fvec1, data2_fvec1);
+    bVec output_bvec = convert_float_bfloat16(output_fvec0, output_fvec1);
+    output_bvec.store(output_data + d, size - d);
+  }
+}
+
+template <typename Op>
+inline void map3(
+    const Op& vec_fun,
+    BFloat16* output_data,
+    const BFloat16* input_data1,
+    const BFloat16* input_data2,
+    const BFloat16* input_data3,
+    int64_t size) {
+  using bVec = vec256::Vec256<BFloat16>;
+  using fVec = vec256::Vec256<float>;
+  int64_t d = 0;
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    bVec data1_bvec = bVec::loadu(input_data1 + d);
+    fVec data1_fvec0, data1_fvec1;
+    std::tie(data1_fvec0, data1_fvec1) = convert_bfloat16_float(data1_bvec);
+    bVec data2_bvec = bVec::loadu(input_data2 + d);
+    fVec data2_fvec0, data2_fvec1;
+    std::tie(data2_fvec0, data2_fvec1) = convert_bfloat16_float(data2_bvec);
+    bVec data3_bvec = bVec::loadu(input_data3 + d);
+    fVec data3_fvec0, data3_fvec1;
+    std::tie(data3_fvec0, data3_fvec1) = convert_bfloat16_float(data3_bvec);
+    fVec output_fvec0 = vec_fun(data1_fvec0, data2_fvec0, data3_fvec0);
+    fVec output_fvec1 = vec_fun(data1_fvec1, data2_fvec1, data3_fvec1);
+    bVec output_bvec = convert_float_bfloat16(output_fvec0, output_fvec1);
+    output_bvec.store(output_data + d);
+  }
+  if (size - d > 0) {
+    bVec data1_bvec = bVec::loadu(input_data1 + d, size - d);
+    fVec data1_fvec0, data1_fvec1;
+    std::tie(data1_fvec0, data1_fvec1) = convert_bfloat16_float(data1_bvec);
+    bVec data2_bvec = bVec::loadu(input_data2 + d, size - d);
+    fVec data2_fvec0, data2_fvec1;
+    std::tie(data2_fvec0, data2_fvec1) = convert_bfloat16_float(data2_bvec);
+    bVec data3_bvec = bVec::loadu(input_data3 + d, size - d);
+    fVec data3_fvec0, data3_fvec1;
+    std::tie(data3_fvec0, data3_fvec1) = convert_bfloat16_float(data3_bvec);
+    fVec output_fvec0 = vec_fun(data1_fvec0, data2_fvec0, data3_fvec0);
+    fVec output_fvec1 = vec_fun(data1_fvec1, data2_fvec1, data3_fvec1);
+    bVec output_bvec = convert_float_bfloat16(output_fvec0, output_fvec1);
+    output_bvec.store(output_data + d, size - d);
+  }
+}
+
+}} // namespace at::vec256
@@ -0,0 +1,133 @@
+#include <ATen/cuda/AsyncCopy.h>
+
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/CUDAEvent.h>
+#include <c10/cuda/CUDAGuard.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace at { namespace cuda {
+namespace {
+
+// How long the poller sleeps between two queries of the pending copies.
+constexpr auto kPollInterval = std::chrono::microseconds(50);
+
+struct PendingCopy {
+  CUDAEvent event;
+  c10::intrusive_ptr<c10::ivalue::Future> future;
+  IValue value;
+};
+
+// A thread that completes the futures of the copies whose events were
+// reached. It sleeps while there are none pending.
+class CopyPoller {
+ public:
+  CopyPoller() : thread_([this] { run(); }) {
+    thread_.detach();
+  }
+
+  void add(PendingCopy copy) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      added_.push_back(std::move(copy));
+    }
+    cv_.notify_one();
+  }
+
+ private:
+  void run() {
+    std::vector<PendingCopy> pending;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [&] { return !pending.empty() || !added_.empty(); });
+        for (auto& copy : added_) {
+          pending.push_back(std::move(copy));
+        }
+        added_.clear();
+      }
+      std::vector<PendingCopy> still_pending;
+      for (auto& copy : pending) {
+        bool done = false;
+        try {
+          done = copy.event.query();
+        } catch (const std::exception& e) {
+          copy.future->setError(e.what());
+          continue;
+        }
+        if (done) {
+          copy.future->markCompleted(std::move(copy.value));
+        } else {
+          still_pending.push_back(std::move(copy));
+        }
+      }
+      pending = std::move(still_pending);
+      if (!pending.empty()) {
+        std::this_thread::sleep_for(kPollInterval);
+      }
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<PendingCopy> added_;
+  std::thread thread_;
+};
+
+CopyPoller& poller() {
+  // Leaked, as its thread runs until the process exits.
+  static CopyPoller* poller = new CopyPoller();
+  return *poller;
+}
+
+Tensor pinned_copy(const Tensor& src) {
+  auto dst = at::empty_like(
+      src,
+      src.options().device(kCPU).pinned_memory(true),
+      MemoryFormat::Preserve);
+  // A copy to pinned memory is asynchronous, and the caching host allocator
+  // keeps the memory until it is done.
+  dst.copy_(src, /*non_blocking=*/true);
+  return dst;
+}
+
+c10::intrusive_ptr<c10::ivalue::Future> enqueue(
+    Device device, TypePtr type, IValue value) {
+  CUDAGuard device_guard(device);
+  CUDAEvent event;
+  event.record(getCurrentCUDAStream(device.index()));
+  auto future = c10::make_intrusive<c10::ivalue::Future>(std::move(type));
+  poller().add({std::move(event), future, std::move(value)});
+  return future;
+}
+
+} // namespace
+
+c10::intrusive_ptr<c10::ivalue::Future> copy_to_host_async(const Tensor& src) {
+  TORCH_CHECK(
+      src.is_cuda(),
+      "copy_to_host_async expects a CUDA tensor, but got a tensor on ",
+      src.device());
+  return enqueue(src.device(), TensorType::get(), pinned_copy(src));
+}
+
+c10::intrusive_ptr<c10::ivalue::Future> copy_to_host_async(TensorList srcs) {
+  TORCH_CHECK(!srcs.empty(), "copy_to_host_async expects at least one tensor");
+  const auto device = srcs[0].device();
+  c10::List<Tensor> dsts;
+  dsts.reserve(srcs.size());
+  for (const auto& src : srcs) {
+    TORCH_CHECK(
+        src.is_cuda() && src.device() == device,
+        "copy_to_host_async expects CUDA tensors on a single device, but got "
+        "tensors on ", device, " and ", src.device());
+    dsts.push_back(pinned_copy(src));
+  }
+  return enqueue(device, ListType::ofTensors(), std::move(dsts));
+}
+
+}} // namespace at::cuda
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/core/ivalue.h>
+
+namespace at { namespace cuda {
+
+// Copies CUDA tensors to pinned host memory, asynchronously on the current
+// stream of their device, and returns a future that completes with the host
+// tensors once the copies are done. The future is completed by a thread that
+// polls the copies, so that neither the caller nor the stream wait for them,
+// and its callbacks never run on a thread of the CUDA driver.
+TORCH_CUDA_API c10::intrusive_ptr<c10::ivalue::Future> copy_to_host_async(
+    const Tensor& src);
+
+// The same for a list of tensors, all of them on the same device, whose future
+// completes with the list of their host copies.
+TORCH_CUDA_API c10::intrusive_ptr<c10::ivalue::Future> copy_to_host_async(
+    TensorList srcs);
+
+}} // namespace at::cuda
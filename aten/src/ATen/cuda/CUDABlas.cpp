@@ -5,6 +5,16 @@
 #include <ATen/cuda/CUDABlas.h>
 #include <ATen/cuda/Exceptions.h>
 
+#if CUDABLAS_LT_ENABLED()
+#include <ATen/native/utils/ParamsHash.h>
+#include <c10/cuda/CUDACachingAllocator.h>
+#include <cublasLt.h>
+
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+#endif
+
 #define CUDABLAS_POSINT_CHECK(FD, X)         \
   TORCH_CHECK(                               \
       (X > 0 && X <= INT_MAX),               \
@@ -329,6 +339,375 @@ void gemm<at::BFloat16>(CUDABLAS_GEMM_ARGTYPES(at::BFloat16)) {
 }
 #endif
 
+#if CUDABLAS_LT_ENABLED()
+
+namespace {
+
+template <typename Dtype>
+struct CuBlasLtType {};
+
+template <>
+struct CuBlasLtType<double> {
+  static constexpr cudaDataType_t data = CUDA_R_64F;
+  static constexpr cudaDataType_t scale = CUDA_R_64F;
+  static constexpr cublasComputeType_t compute = CUBLAS_COMPUTE_64F;
+};
+
+template <>
+struct CuBlasLtType<float> {
+  static constexpr cudaDataType_t data = CUDA_R_32F;
+  static constexpr cudaDataType_t scale = CUDA_R_32F;
+  static constexpr cublasComputeType_t compute = CUBLAS_COMPUTE_32F;
+};
+
+template <>
+struct CuBlasLtType<at::Half> {
+  static constexpr cudaDataType_t data = CUDA_R_16F;
+  static constexpr cudaDataType_t scale = CUDA_R_32F;
+  static constexpr cublasComputeType_t compute = CUBLAS_COMPUTE_32F;
+};
+
+template <>
+struct CuBlasLtType<at::BFloat16> {
+  static constexpr cudaDataType_t data = CUDA_R_16BF;
+  static constexpr cudaDataType_t scale = CUDA_R_32F;
+  static constexpr cublasComputeType_t compute = CUBLAS_COMPUTE_32F;
+};
+
+// Owns a cuBLASLt descriptor.
+template <typename T, cublasStatus_t (*destructor)(T*)>
+struct CuBlasLtDescriptorDeleter {
+  void operator()(T* x) {
+    if (x != nullptr) {
+      TORCH_CUDABLAS_CHECK(destructor(x));
+    }
+  }
+};
+
+template <typename T, cublasStatus_t (*destructor)(T*)>
+using CuBlasLtDescriptor =
+    std::unique_ptr<T, CuBlasLtDescriptorDeleter<T, destructor>>;
+
+using MatmulDesc =
+    CuBlasLtDescriptor<cublasLtMatmulDescOpaque_t, &cublasLtMatmulDescDestroy>;
+using MatrixLayout = CuBlasLtDescriptor<
+    cublasLtMatrixLayoutOpaque_t,
+    &cublasLtMatrixLayoutDestroy>;
+using MatmulPreference = CuBlasLtDescriptor<
+    cublasLtMatmulPreferenceOpaque_t,
+    &cublasLtMatmulPreferenceDestroy>;
+
+MatrixLayout createLayout(
+    cudaDataType_t type,
+    uint64_t rows,
+    uint64_t cols,
+    int64_t ld) {
+  cublasLtMatrixLayout_t raw = nullptr;
+  TORCH_CUDABLAS_CHECK(
+      cublasLtMatrixLayoutCreate(&raw, type, rows, cols, ld));
+  return MatrixLayout(raw);
+}
+
+// The largest power of two up to 16 that divides the address, which the
+// kernels of cuBLASLt may rely on.
+uint32_t alignmentOf(const void* ptr) {
+  uint32_t alignment = 16;
+  while (reinterpret_cast<uintptr_t>(ptr) % alignment != 0) {
+    alignment /= 2;
+  }
+  return alignment;
+}
+
+// The maximum size of the workspace of the algorithms.
+constexpr size_t kLtWorkspaceSize = 4 * 1024 * 1024;
+
+// Identifies the algorithm that the cuBLASLt heuristic picks for a GEMM.
+// Must be a POD, see ParamsHash.
+struct LtAlgoKey {
+  int device;
+  cudaDataType_t type;
+  cublasComputeType_t compute;
+  cublasLtEpilogue_t epilogue;
+  bool transpose_mat1;
+  bool transpose_mat2;
+  int64_t m, n, k;
+  int64_t mat1_ld, mat2_ld, result_ld;
+  uint32_t mat1_alignment, mat2_alignment, result_alignment;
+};
+
+struct LtAlgo {
+  cublasLtMatmulAlgo_t algo;
+  size_t workspace_size;
+};
+
+struct LtAlgoCache {
+  std::mutex mutex;
+  std::unordered_map<
+      LtAlgoKey,
+      LtAlgo,
+      at::native::ParamsHash<LtAlgoKey>,
+      at::native::ParamsEqual<LtAlgoKey>>
+      map;
+};
+
+LtAlgoCache& ltAlgoCache() {
+  static LtAlgoCache cache;
+  return cache;
+}
+
+// Runs result = epilogue(alpha * op(mat1) * op(mat2)), where the epilogue
+// reads or writes the vector bias.
+template <typename Dtype>
+void ltMatmul(
+    bool transpose_mat1,
+    bool transpose_mat2,
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    at::acc_type<Dtype, true> alpha,
+    const Dtype* mat1,
+    int64_t mat1_ld,
+    const Dtype* mat2,
+    int64_t mat2_ld,
+    const void* bias,
+    Dtype* result,
+    int64_t result_ld,
+    cublasLtEpilogue_t epilogue) {
+  globalContext().alertCuBLASConfigNotDeterministic();
+  CUDABLAS_POSINT_CHECK(gemm_and_bias<Dtype>, m);
+  CUDABLAS_POSINT_CHECK(gemm_and_bias<Dtype>, n);
+  CUDABLAS_POSINT_CHECK(gemm_and_bias<Dtype>, k);
+  using Type = CuBlasLtType<Dtype>;
+  using scale_t = at::acc_type<Dtype, true>;
+
+  // Like gemm, float GEMMs may use TF32 if allowed.
+  cublasComputeType_t compute = Type::compute;
+  if (std::is_same<Dtype, float>::value &&
+      at::globalContext().allowTF32CuBLAS()) {
+    compute = CUBLAS_COMPUTE_32F_FAST_TF32;
+  }
+
+  cublasLtMatmulDesc_t raw_desc = nullptr;
+  TORCH_CUDABLAS_CHECK(
+      cublasLtMatmulDescCreate(&raw_desc, compute, Type::scale));
+  MatmulDesc desc(raw_desc);
+  cublasOperation_t opa = transpose_mat1 ? CUBLAS_OP_T : CUBLAS_OP_N;
+  cublasOperation_t opb = transpose_mat2 ? CUBLAS_OP_T : CUBLAS_OP_N;
+  TORCH_CUDABLAS_CHECK(cublasLtMatmulDescSetAttribute(
+      desc.get(), CUBLASLT_MATMUL_DESC_TRANSA, &opa, sizeof(opa)));
+  TORCH_CUDABLAS_CHECK(cublasLtMatmulDescSetAttribute(
+      desc.get(), CUBLASLT_MATMUL_DESC_TRANSB, &opb, sizeof(opb)));
+  TORCH_CUDABLAS_CHECK(cublasLtMatmulDescSetAttribute(
+      desc.get(), CUBLASLT_MATMUL_DESC_EPILOGUE, &epilogue, sizeof(epilogue)));
+  TORCH_CUDABLAS_CHECK(cublasLtMatmulDescSetAttribute(
+      desc.get(), CUBLASLT_MATMUL_DESC_BIAS_POINTER, &bias, sizeof(bias)));
+
+  auto mat1_layout = createLayout(
+      Type::data, transpose_mat1 ? k : m, transpose_mat1 ? m : k, mat1_ld);
+  auto mat2_layout = createLayout(
+      Type::data, transpose_mat2 ? n : k, transpose_mat2 ? k : n, mat2_ld);
+  auto result_layout = createLayout(Type::data, m, n, result_ld);
+
+  cublasLtHandle_t handle =
+      reinterpret_cast<cublasLtHandle_t>(at::cuda::getCurrentCUDABlasHandle());
+
+  LtAlgoKey key;
+  // Zero the padding, which is hashed and compared too.
+  memset(&key, 0, sizeof(key));
+  key.device = c10::cuda::current_device();
+  key.type = Type::data;
+  key.compute = compute;
+  key.epilogue = epilogue;
+  key.transpose_mat1 = transpose_mat1;
+  key.transpose_mat2 = transpose_mat2;
+  key.m = m;
+  key.n = n;
+  key.k = k;
+  key.mat1_ld = mat1_ld;
+  key.mat2_ld = mat2_ld;
+  key.result_ld = result_ld;
+  key.mat1_alignment = alignmentOf(mat1);
+  key.mat2_alignment = alignmentOf(mat2);
+  key.result_alignment = alignmentOf(result);
+
+  LtAlgo algo;
+  auto& cache = ltAlgoCache();
+  std::unique_lock<std::mutex> lock(cache.mutex);
+  auto it = cache.map.find(key);
+  if (it != cache.map.end()) {
+    algo = it->second;
+  } else {
+    lock.unlock();
+    cublasLtMatmulPreference_t raw_preference = nullptr;
+    TORCH_CUDABLAS_CHECK(cublasLtMatmulPreferenceCreate(&raw_preference));
+    MatmulPreference preference(raw_preference);
+    uint64_t workspace_size = kLtWorkspaceSize;
+    TORCH_CUDABLAS_CHECK(cublasLtMatmulPreferenceSetAttribute(
+        preference.get(),
+        CUBLASLT_MATMUL_PREF_MAX_WORKSPACE_BYTES,
+        &workspace_size,
+        sizeof(workspace_size)));
+    TORCH_CUDABLAS_CHECK(cublasLtMatmulPreferenceSetAttribute(
+        preference.get(),
+        CUBLASLT_MATMUL_PREF_MIN_ALIGNMENT_A_BYTES,
+        &key.mat1_alignment,
+        sizeof(key.mat1_alignment)));
+    TORCH_CUDABLAS_CHECK(cublasLtMatmulPreferenceSetAttribute(
+        preference.get(),
+        CUBLASLT_MATMUL_PREF_MIN_ALIGNMENT_B_BYTES,
+        &key.mat2_alignment,
+        sizeof(key.mat2_alignment)));
+    TORCH_CUDABLAS_CHECK(cublasLtMatmulPreferenceSetAttribute(
+        preference.get(),
+        CUBLASLT_MATMUL_PREF_MIN_ALIGNMENT_C_BYTES,
+        &key.result_alignment,
+        sizeof(key.result_alignment)));
+    TORCH_CUDABLAS_CHECK(cublasLtMatmulPreferenceSetAttribute(
+        preference.get(),
+        CUBLASLT_MATMUL_PREF_MIN_ALIGNMENT_D_BYTES,
+        &key.result_alignment,
+        sizeof(key.result_alignment)));
+
+    cublasLtMatmulHeuristicResult_t heuristic = {};
+    int num_results = 0;
+    TORCH_CUDABLAS_CHECK(cublasLtMatmulAlgoGetHeuristic(
+        handle,
+        desc.get(),
+        mat1_layout.get(),
+        mat2_layout.get(),
+        result_layout.get(),
+        result_layout.get(),
+        preference.get(),
+        1,
+        &heuristic,
+        &num_results));
+    if (num_results == 0) {
+      TORCH_CUDABLAS_CHECK(CUBLAS_STATUS_NOT_SUPPORTED);
+    }
+    algo = LtAlgo{heuristic.algo, heuristic.workspaceSize};
+    lock.lock();
+    cache.map.emplace(key, algo);
+  }
+  lock.unlock();
+
+  // The workspace is freed once the GEMM on the current stream is done.
+  auto workspace = c10::cuda::CUDACachingAllocator::get()->allocate(
+      algo.workspace_size);
+  scale_t beta = 0;
+  TORCH_CUDABLAS_CHECK(cublasLtMatmul(
+      handle,
+      desc.get(),
+      &alpha,
+      mat1,
+      mat1_layout.get(),
+      mat2,
+      mat2_layout.get(),
+      &beta,
+      result,
+      result_layout.get(),
+      result,
+      result_layout.get(),
+      &algo.algo,
+      workspace.get(),
+      algo.workspace_size,
+      at::cuda::getCurrentCUDAStream()));
+}
+
+} // anonymous namespace
+
+template <typename Dtype>
+void gemm_and_bias(
+    bool transpose_mat1,
+    bool transpose_mat2,
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    at::acc_type<Dtype, true> alpha,
+    const Dtype* mat1,
+    int64_t mat1_ld,
+    const Dtype* mat2,
+    int64_t mat2_ld,
+    const Dtype* bias,
+    Dtype* result,
+    int64_t result_ld,
+    GEMMAndBiasActivationEpilogue activation) {
+  cublasLtEpilogue_t epilogue = CUBLASLT_EPILOGUE_BIAS;
+  switch (activation) {
+    case GEMMAndBiasActivationEpilogue::None:
+      break;
+    case GEMMAndBiasActivationEpilogue::RELU:
+      epilogue = CUBLASLT_EPILOGUE_RELU_BIAS;
+      break;
+    case GEMMAndBiasActivationEpilogue::GELU:
+      epilogue = CUBLASLT_EPILOGUE_GELU_BIAS;
+      break;
+  }
+  ltMatmul<Dtype>(
+      transpose_mat1,
+      transpose_mat2,
+      m,
+      n,
+      k,
+      alpha,
+      mat1,
+      mat1_ld,
+      mat2,
+      mat2_ld,
+      bias,
+      result,
+      result_ld,
+      epilogue);
+}
+
+template <typename Dtype>
+void gemm_and_bias_grad(
+    bool transpose_mat1,
+    bool transpose_mat2,
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    const Dtype* mat1,
+    int64_t mat1_ld,
+    const Dtype* mat2,
+    int64_t mat2_ld,
+    Dtype* result,
+    int64_t result_ld,
+    Dtype* bias_grad) {
+  ltMatmul<Dtype>(
+      transpose_mat1,
+      transpose_mat2,
+      m,
+      n,
+      k,
+      1,
+      mat1,
+      mat1_ld,
+      mat2,
+      mat2_ld,
+      bias_grad,
+      result,
+      result_ld,
+      CUBLASLT_EPILOGUE_BGRADA);
+}
+
+#define INSTANTIATE_GEMM_AND_BIAS(Dtype)                                    \
+  template void gemm_and_bias<Dtype>(                                       \
+      bool, bool, int64_t, int64_t, int64_t, at::acc_type<Dtype, true>,     \
+      const Dtype*, int64_t, const Dtype*, int64_t, const Dtype*, Dtype*,   \
+      int64_t, GEMMAndBiasActivationEpilogue);                              \
+  template void gemm_and_bias_grad<Dtype>(                                  \
+      bool, bool, int64_t, int64_t, int64_t, const Dtype*, int64_t,         \
+      const Dtype*, int64_t, Dtype*, int64_t, Dtype*);
+
+INSTANTIATE_GEMM_AND_BIAS(double)
+INSTANTIATE_GEMM_AND_BIAS(float)
+INSTANTIATE_GEMM_AND_BIAS(at::Half)
+INSTANTIATE_GEMM_AND_BIAS(at::BFloat16)
+
+#undef INSTANTIATE_GEMM_AND_BIAS
+
+#endif // CUDABLAS_LT_ENABLED()
+
 /* LEVEL 2 BLAS FUNCTIONS */
 
 #define GEMV_CHECK_ARGVALUES(Dtype)           \
@@ -545,6 +924,54 @@ void dot<at::Half>(CUDABLAS_DOT_ARGTYPES(at::Half)) {
 #endif
 }
 
+/* BATCHED LU FUNCTIONS */
+
+#ifndef __HIP_PLATFORM_HCC__
+template <>
+void getrfBatched<double>(CUDABLAS_GETRF_BATCHED_ARGTYPES(double)) {
+  cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
+  TORCH_CUDABLAS_CHECK(cublasDgetrfBatched(
+      handle, n, dA_array, ldda, ipiv_array, info_array, batchsize));
+}
+
+template <>
+void getrfBatched<float>(CUDABLAS_GETRF_BATCHED_ARGTYPES(float)) {
+  cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
+  TORCH_CUDABLAS_CHECK(cublasSgetrfBatched(
+      handle, n, dA_array, ldda, ipiv_array, info_array, batchsize));
+}
+
+template <>
+void getriBatched<double>(CUDABLAS_GETRI_BATCHED_ARGTYPES(double)) {
+  cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
+  TORCH_CUDABLAS_CHECK(cublasDgetriBatched(
+      handle, n, dA_array, ldda, ipiv_array, dC_array, lddc, info_array, batchsize));
+}
+
+template <>
+void getriBatched<float>(CUDABLAS_GETRI_BATCHED_ARGTYPES(float)) {
+  cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
+  TORCH_CUDABLAS_CHECK(cublasSgetriBatched(
+      handle, n, dA_array, ldda, ipiv_array, dC_array, lddc, info_array, batchsize));
+}
+
+template <>
+void getrsBatched<double>(CUDABLAS_GETRS_BATCHED_ARGTYPES(double)) {
+  cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
+  TORCH_CUDABLAS_CHECK(cublasDgetrsBatched(
+      handle, CUBLAS_OP_N, n, nrhs, dA_array, ldda, ipiv_array, dB_array, lddb,
+      info, batchsize));
+}
+
+template <>
+void getrsBatched<float>(CUDABLAS_GETRS_BATCHED_ARGTYPES(float)) {
+  cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
+  TORCH_CUDABLAS_CHECK(cublasSgetrsBatched(
+      handle, CUBLAS_OP_N, n, nrhs, dA_array, ldda, ipiv_array, dB_array, lddb,
+      info, batchsize));
+}
+#endif
+
 } // namespace blas
 } // namespace cuda
 } // namespace at
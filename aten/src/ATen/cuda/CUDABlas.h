@@ -9,10 +9,23 @@
 
     dot<Dtype>(n, x, incx, y, incy, result)
 
+    getrfBatched<Dtype>(n, dA_array, ldda, ipiv_array, info_array, batchsize)
+
+    getriBatched<Dtype>(n, dA_array, ldda, ipiv_array, dC_array, lddc,
+  info_array, batchsize)
+
+    getrsBatched<Dtype>(n, nrhs, dA_array, ldda, ipiv_array, dB_array, lddb,
+  info, batchsize)
+
   where Dtype is double, float, at::Half or at::BFloat16 (ROCm, NOT for dot).
+  The batched LU functions are only available for double and float on CUDA.
   The functions are available in at::cuda::blas namespace.
+
+  With CUDA 11.4 and later, gemm_and_bias and gemm_and_bias_grad run GEMMs
+  with fused epilogues through cuBLASLt, see below.
  */
 
+#include <ATen/AccumulateType.h>
 #include <ATen/cuda/CUDAContext.h>
 
 namespace at {
@@ -69,6 +82,67 @@ template <>
 void gemm<at::BFloat16>(CUDABLAS_GEMM_ARGTYPES(at::BFloat16));
 #endif
 
+#if defined(CUDA_VERSION) && CUDA_VERSION >= 11040 && !defined(__HIP_PLATFORM_HCC__)
+#define CUDABLAS_LT_ENABLED() 1
+#else
+#define CUDABLAS_LT_ENABLED() 0
+#endif
+
+#if CUDABLAS_LT_ENABLED()
+// GEMMs through cuBLASLt, which applies the bias and activation in the
+// epilogue of the GEMM kernel instead of in separate kernels re-reading
+// its result. Available for double, float, at::Half and at::BFloat16 with
+// CUDA 11.4 and later. The algorithm is picked by the cuBLASLt heuristic
+// once per shape, layout, alignment and device, and its workspace comes from
+// the caching allocator.
+
+enum class GEMMAndBiasActivationEpilogue {
+  None,
+  RELU,
+  GELU,
+};
+
+// result = activation(alpha * op(mat1) * op(mat2) + bias), column major like
+// gemm, where bias has m elements, one per row of result. The operations are
+// 't' if transpose_mat1 (transpose_mat2) and 'n' otherwise.
+template <typename Dtype>
+void gemm_and_bias(
+    bool transpose_mat1,
+    bool transpose_mat2,
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    at::acc_type<Dtype, true> alpha,
+    const Dtype* mat1,
+    int64_t mat1_ld,
+    const Dtype* mat2,
+    int64_t mat2_ld,
+    const Dtype* bias,
+    Dtype* result,
+    int64_t result_ld,
+    GEMMAndBiasActivationEpilogue activation =
+        GEMMAndBiasActivationEpilogue::None);
+
+// result = op(mat1) * op(mat2), column major like gemm, and bias_grad = the
+// sums of the rows of op(mat1), i.e. its reduction over k, which has m
+// elements. This is the weight and bias gradient of a linear layer, with
+// mat1 being the gradient of its output.
+template <typename Dtype>
+void gemm_and_bias_grad(
+    bool transpose_mat1,
+    bool transpose_mat2,
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    const Dtype* mat1,
+    int64_t mat1_ld,
+    const Dtype* mat2,
+    int64_t mat2_ld,
+    Dtype* result,
+    int64_t result_ld,
+    Dtype* bias_grad);
+#endif // CUDABLAS_LT_ENABLED()
+
 /* LEVEL 2 BLAS FUNCTIONS */
 
 #define CUDABLAS_GEMV_ARGTYPES(Dtype)                                         \
@@ -131,6 +205,57 @@ void dot<c10::complex<double>>(CUDABLAS_DOT_ARGTYPES(c10::complex<double>));
 template <>
 void dot<c10::complex<float>>(CUDABLAS_DOT_ARGTYPES(c10::complex<float>));
 
+/* BATCHED LU FUNCTIONS */
+
+// The arrays of matrices and the pivots live on the device; the pivots of the
+// i-th matrix are ipiv_array[i * n, (i + 1) * n). A null ipiv_array factors
+// the matrices without pivoting.
+#define CUDABLAS_GETRF_BATCHED_ARGTYPES(Dtype)                         \
+  int n, Dtype **dA_array, int ldda, int *ipiv_array, int *info_array, \
+      int batchsize
+
+template <typename Dtype>
+inline void getrfBatched(CUDABLAS_GETRF_BATCHED_ARGTYPES(Dtype)) {
+  AT_ERROR("at::cuda::blas::getrfBatched: not implemented for ", typeid(Dtype).name());
+}
+
+// Writes the inverses of the matrices factored by getrfBatched to dC_array.
+#define CUDABLAS_GETRI_BATCHED_ARGTYPES(Dtype)                          \
+  int n, Dtype **dA_array, int ldda, int *ipiv_array, Dtype **dC_array, \
+      int lddc, int *info_array, int batchsize
+
+template <typename Dtype>
+inline void getriBatched(CUDABLAS_GETRI_BATCHED_ARGTYPES(Dtype)) {
+  AT_ERROR("at::cuda::blas::getriBatched: not implemented for ", typeid(Dtype).name());
+}
+
+// Solves the systems of the matrices factored by getrfBatched in place of
+// dB_array. Unlike for the other two, `info` is a single value on the host,
+// which only reports invalid arguments.
+#define CUDABLAS_GETRS_BATCHED_ARGTYPES(Dtype)                   \
+  int n, int nrhs, Dtype **dA_array, int ldda, int *ipiv_array, \
+      Dtype **dB_array, int lddb, int *info, int batchsize
+
+template <typename Dtype>
+inline void getrsBatched(CUDABLAS_GETRS_BATCHED_ARGTYPES(Dtype)) {
+  AT_ERROR("at::cuda::blas::getrsBatched: not implemented for ", typeid(Dtype).name());
+}
+
+#ifndef __HIP_PLATFORM_HCC__
+template <>
+void getrfBatched<double>(CUDABLAS_GETRF_BATCHED_ARGTYPES(double));
+template <>
+void getrfBatched<float>(CUDABLAS_GETRF_BATCHED_ARGTYPES(float));
+template <>
+void getriBatched<double>(CUDABLAS_GETRI_BATCHED_ARGTYPES(double));
+template <>
+void getriBatched<float>(CUDABLAS_GETRI_BATCHED_ARGTYPES(float));
+template <>
+void getrsBatched<double>(CUDABLAS_GETRS_BATCHED_ARGTYPES(double));
+template <>
+void getrsBatched<float>(CUDABLAS_GETRS_BATCHED_ARGTYPES(float));
+#endif
+
 } // namespace blas
 } // namespace cuda
 } // namespace at
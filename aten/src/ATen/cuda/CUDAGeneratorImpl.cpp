@@ -1,7 +1,10 @@
 #include <ATen/CUDAGeneratorImpl.h>
+#include <ATen/cuda/CUDAGraphsUtils.cuh>
 #include <c10/cuda/CUDAFunctions.h>
 #include <ATen/Utils.h>
 
+#include <limits>
+
 namespace at {
 
 namespace cuda { namespace detail {
@@ -144,11 +147,66 @@ uint64_t CUDAGeneratorImpl::philox_offset_per_thread() {
  * See Note [Acquire lock when using random generators]
  */
 std::pair<uint64_t, uint64_t> CUDAGeneratorImpl::philox_engine_inputs(uint64_t increment) {
+  at::cuda::assertNotCapturing("Call to CUDAGeneratorImpl::philox_engine_inputs");
   uint64_t offset = this->philox_offset_per_thread_;
   this->philox_offset_per_thread_ += increment;
   return std::make_pair(this->seed_, offset);
 }
 
+/**
+ * Called by CUDAGraph to prepare this instance for a graph capture:
+ * kernels captured until capture_epilogue read their offset from
+ * offset_extragraph, a one element int64 device tensor.
+ *
+ * See Note [CUDA Graph-safe RNG states]
+ */
+void CUDAGeneratorImpl::capture_prologue(int64_t* offset_extragraph) {
+  offset_extragraph_ = offset_extragraph;
+  offset_intragraph_ = 0;
+  graph_expects_this_gen_ = true;
+}
+
+/**
+ * Called by CUDAGraph to finalize a graph capture. Returns the offset
+ * increment the whole graph needs on each replay.
+ */
+uint64_t CUDAGeneratorImpl::capture_epilogue() {
+  graph_expects_this_gen_ = false;
+  offset_extragraph_ = nullptr;
+  return offset_intragraph_;
+}
+
+/**
+ * Like philox_engine_inputs, but the state it returns is also valid when the
+ * kernel is captured into a CUDA graph. Kernels read the seed and offset from
+ * it with at::cuda::philox::unpack.
+ *
+ * See Note [CUDA Graph-safe RNG states]
+ * See Note [Acquire lock when using random generators]
+ */
+PhiloxCudaState CUDAGeneratorImpl::philox_cuda_state(uint64_t increment) {
+  // rounds increment up to the nearest multiple of 4, so that the offsets
+  // of consecutive kernels do not overlap within a philox round
+  increment = ((increment + 3) / 4) * 4;
+  if (at::cuda::currentStreamCaptureStatus() != at::cuda::CaptureStatus::None) {
+    TORCH_CHECK(graph_expects_this_gen_,
+                "philox_cuda_state for an unexpected CUDA generator used during capture. "
+                "Only the default generator of the capturing device can be used in a CUDA graph.");
+    uint32_t offset = this->offset_intragraph_;
+    TORCH_INTERNAL_ASSERT(this->offset_intragraph_ <=
+                          std::numeric_limits<uint32_t>::max() - increment);
+    this->offset_intragraph_ += increment;
+    return PhiloxCudaState(this->seed_, this->offset_extragraph_, offset);
+  } else {
+    TORCH_CHECK(!graph_expects_this_gen_,
+                "CUDA generator expects graph capture to be underway, "
+                "but the current stream is not capturing.");
+    uint64_t offset = this->philox_offset_per_thread_;
+    this->philox_offset_per_thread_ += increment;
+    return PhiloxCudaState(this->seed_, offset);
+  }
+}
+
 /*
  * Gets the DeviceType of CUDAGeneratorImpl.
  * Used for type checking during run time.
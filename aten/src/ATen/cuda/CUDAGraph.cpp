@@ -0,0 +1,190 @@
+#include <ATen/cuda/CUDAGraph.h>
+
+#include <ATen/CUDAGeneratorImpl.h>
+#include <ATen/Functions.h>
+#include <ATen/cuda/CUDAGraphsUtils.cuh>
+#include <ATen/cuda/Exceptions.h>
+#include <c10/cuda/CUDAFunctions.h>
+#include <c10/cuda/CUDAGuard.h>
+
+#include <atomic>
+
+namespace at {
+namespace cuda {
+
+using c10::cuda::CUDACachingAllocator::MempoolId_t;
+
+MempoolId_t graph_pool_handle() {
+#ifdef C10_CUDA_GRAPHS_SUPPORTED
+  // The first element is 0, so that the handles never collide with the
+  // {capture id, 0} ids of the pools graphs create for themselves.
+  static std::atomic<c10::cuda::CUDACachingAllocator::CaptureId_t> uid{1};
+  return {0, uid++};
+#else
+  TORCH_CHECK(false, "CUDA graphs may only be used in Pytorch built with CUDA >= 11.0");
+  return {0, 0};
+#endif
+}
+
+CUDAGraph::CUDAGraph()
+  // CUDAStreams may not be default-constructed.
+  : capture_stream_(at::cuda::getCurrentCUDAStream()) {
+#ifndef C10_CUDA_GRAPHS_SUPPORTED
+  TORCH_CHECK(false, "CUDA graphs may only be used in Pytorch built with CUDA >= 11.0");
+#endif
+}
+
+void CUDAGraph::capture_begin(MempoolId_t pool) {
+#ifdef C10_CUDA_GRAPHS_SUPPORTED
+  TORCH_CHECK(!has_graph_exec_,
+              "This CUDAGraph instance already owns a captured graph. "
+              "To capture a new graph, create a new instance or call reset() first.");
+
+  auto stream = at::cuda::getCurrentCUDAStream();
+  TORCH_CHECK(stream != at::cuda::getDefaultCUDAStream(),
+              "CUDA graphs must be captured on a non-default stream. "
+              "(However, after capture, it's ok to replay them on the default stream.)");
+  capture_stream_ = stream;
+  capture_dev_ = c10::cuda::current_device();
+
+  // Captured random kernels read their offset from offset_extragraph_,
+  // which replay() refreshes. See Note [CUDA Graph-safe RNG states].
+  capture_gen_ = check_generator<CUDAGeneratorImpl>(
+      cuda::detail::getDefaultCUDAGenerator(capture_dev_));
+  offset_extragraph_ = at::empty({1}, at::TensorOptions().dtype(kLong).device(kCUDA, capture_dev_));
+  {
+    // See Note [Acquire lock when using random generators]
+    std::lock_guard<std::mutex> lock(capture_gen_->mutex_);
+    capture_gen_->capture_prologue(offset_extragraph_.data_ptr<int64_t>());
+  }
+
+  // cudaStreamCaptureModeGlobal is the most conservative option to prevent
+  // potentially unsafe CUDA API calls during capture, e.g. a cudaFree by
+  // another thread.
+  AT_CUDA_CHECK(cudaStreamBeginCapture(capture_stream_, cudaStreamCaptureModeGlobal));
+
+  cudaStreamCaptureStatus status;
+  AT_CUDA_CHECK(cudaStreamGetCaptureInfo(stream, &status, &id_));
+  TORCH_INTERNAL_ASSERT(status == cudaStreamCaptureStatusActive);
+  TORCH_INTERNAL_ASSERT(id_ > 0);
+
+  if (pool.first != 0 || pool.second != 0) {
+    // the user wants the graph to share the pool of other graphs
+    TORCH_INTERNAL_ASSERT(!(pool.first && pool.second));
+    mempool_id_ = pool;
+  } else {
+    mempool_id_ = {id_, 0};
+  }
+
+  // Allocations on the capturing stream now come from the private pool.
+  // Every allocation checks whether its stream is capturing, so this must
+  // follow cudaStreamBeginCapture.
+  c10::cuda::CUDACachingAllocator::notifyCaptureBegin(capture_dev_, id_, mempool_id_);
+#else
+  TORCH_CHECK(false, "CUDA graphs may only be used in Pytorch built with CUDA >= 11.0");
+#endif
+}
+
+void CUDAGraph::capture_end() {
+#ifdef C10_CUDA_GRAPHS_SUPPORTED
+  auto stream = at::cuda::getCurrentCUDAStream();
+
+  TORCH_CHECK(stream == capture_stream_,
+              "Capture must end on the same stream it began on.");
+
+  c10::cuda::CUDACachingAllocator::notifyCaptureEnd(capture_dev_, id_);
+
+  {
+    std::lock_guard<std::mutex> lock(capture_gen_->mutex_);
+    wholegraph_increment_ = capture_gen_->capture_epilogue();
+  }
+
+  AT_CUDA_CHECK(cudaStreamEndCapture(capture_stream_, &graph_));
+  TORCH_CHECK(graph_ != NULL, "Invalid capture.");
+  has_graph_ = true;
+
+  // cudaGraphInstantiate's error reporting arguments are not needed, a
+  // failure is reported by its return value as well.
+  AT_CUDA_CHECK(cudaGraphInstantiate(&graph_exec_, graph_, NULL, NULL, 0));
+  has_graph_exec_ = true;
+
+  // The instantiated graph keeps what it needs, the captured graph can go.
+  AT_CUDA_CHECK(cudaGraphDestroy(graph_));
+  has_graph_ = false;
+#else
+  TORCH_CHECK(false, "CUDA graphs may only be used in Pytorch built with CUDA >= 11.0");
+#endif
+}
+
+void CUDAGraph::replay() {
+#ifdef C10_CUDA_GRAPHS_SUPPORTED
+  TORCH_CHECK(has_graph_exec_,
+              "Called CUDAGraph::replay without a preceding successful capture.");
+
+  c10::cuda::CUDAGuard device_guard{capture_dev_};
+
+  // Reserves the offsets of the whole graph, just like any RNG consumer
+  // kernel would, and passes the first one to the captured kernels.
+  if (wholegraph_increment_) {
+    PhiloxCudaState rng_engine_inputs;
+    {
+      std::lock_guard<std::mutex> lock(capture_gen_->mutex_);
+      rng_engine_inputs = capture_gen_->philox_cuda_state(wholegraph_increment_);
+    }
+    offset_extragraph_.fill_(int64_t(rng_engine_inputs.offset_.val));
+  }
+
+  AT_CUDA_CHECK(cudaGraphLaunch(graph_exec_, at::cuda::getCurrentCUDAStream()));
+#else
+  TORCH_CHECK(false, "CUDA graphs may only be used in Pytorch built with CUDA >= 11.0");
+#endif
+}
+
+void CUDAGraph::reset() {
+#ifdef C10_CUDA_GRAPHS_SUPPORTED
+  // Called from the destructor, so errors are reported with AT_CUDA_CHECK
+  // only after all cleanup was attempted.
+  //
+  // A graph has a private pool from a successful capture_begin on: the
+  // allocator is told the graph is gone once it has an instantiated graph to
+  // drop. A failed capture leaves its pool to the allocator, which is not
+  // ideal but safe.
+  if (has_graph_ || has_graph_exec_) {
+    c10::cuda::CUDACachingAllocator::notifyCaptureDestroy(capture_dev_, mempool_id_);
+  }
+  cudaError_t graph_err = cudaSuccess;
+  cudaError_t exec_err = cudaSuccess;
+  if (has_graph_) {
+    graph_err = cudaGraphDestroy(graph_);
+    has_graph_ = false;
+  }
+  if (has_graph_exec_) {
+    exec_err = cudaGraphExecDestroy(graph_exec_);
+    has_graph_exec_ = false;
+  }
+  offset_extragraph_.reset();
+  AT_CUDA_CHECK(graph_err);
+  AT_CUDA_CHECK(exec_err);
+#else
+  TORCH_CHECK(false, "CUDA graphs may only be used in Pytorch built with CUDA >= 11.0");
+#endif
+}
+
+MempoolId_t CUDAGraph::pool() {
+#ifdef C10_CUDA_GRAPHS_SUPPORTED
+  TORCH_CHECK(has_graph_exec_,
+              "Called CUDAGraph::pool() without a preceding successful capture.");
+#else
+  TORCH_CHECK(false, "CUDA graphs may only be used in Pytorch built with CUDA >= 11.0");
+#endif
+  return mempool_id_;
+}
+
+CUDAGraph::~CUDAGraph() {
+  try {
+    reset();
+  } catch (...) { /* No throw */ }
+}
+
+} // namespace cuda
+} // namespace at
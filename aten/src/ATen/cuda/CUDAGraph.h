@@ -0,0 +1,97 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include <ATen/cuda/ATenCUDAGeneral.h>
+#include <c10/core/Device.h>
+#include <c10/cuda/CUDACachingAllocator.h>
+#include <c10/cuda/CUDAStream.h>
+
+namespace at {
+
+struct CUDAGeneratorImpl;
+
+namespace cuda {
+
+// Returns a handle to a fresh private memory pool. Passing it to
+// CUDAGraph::capture_begin of several graphs makes them share the pool.
+TORCH_CUDA_API c10::cuda::CUDACachingAllocator::MempoolId_t graph_pool_handle();
+
+/*
+ * A CUDAGraph records the work a CUDA stream runs between capture_begin and
+ * capture_end, and replays it with a single launch.
+ *
+ *   at::cuda::CUDAStream stream = at::cuda::getStreamFromPool();
+ *   at::cuda::CUDAGraph graph;
+ *   {
+ *     at::cuda::CUDAStreamGuard guard(stream);
+ *     graph.capture_begin();
+ *     out.copy_(at::dropout(in, 0.5, true));
+ *     graph.capture_end();
+ *   }
+ *   graph.replay();  // recomputes out from the current contents of in
+ *
+ * Captures have to run on a non-default stream. Replays run on the current
+ * stream and read and write the same memory as the captured work, so inputs
+ * are fed by copying into the tensors used during capture.
+ *
+ * Memory allocated during the capture comes from a private pool of the
+ * caching allocator (see notifyCaptureBegin), which keeps it reserved for the
+ * replays until the graph is reset or destroyed.
+ *
+ * Random ops need a graph-safe generator, see
+ * Note [CUDA Graph-safe RNG states]. Only the default generator of the
+ * capturing device can be used, and each replay draws fresh numbers from it.
+ *
+ * Requires CUDA 11. Other builds raise an error on capture_begin.
+ */
+struct TORCH_CUDA_API CUDAGraph {
+  CUDAGraph();
+  ~CUDAGraph();
+
+  CUDAGraph(const CUDAGraph&) = delete;
+  CUDAGraph& operator=(const CUDAGraph&) = delete;
+
+  // pool {0, 0} gives the graph a pool of its own
+  void capture_begin(c10::cuda::CUDACachingAllocator::MempoolId_t pool = {0, 0});
+  void capture_end();
+  void replay();
+  // frees the graph, and lets the allocator reuse its private pool
+  void reset();
+  c10::cuda::CUDACachingAllocator::MempoolId_t pool();
+
+ protected:
+#ifdef C10_CUDA_GRAPHS_SUPPORTED
+  cudaGraph_t graph_ = NULL;
+  cudaGraphExec_t graph_exec_ = NULL;
+#endif
+
+  // internal states so reset() can do its best cleaning up
+  // Set to true in capture_end if cudaStreamEndCapture succeeded
+  bool has_graph_ = false;
+  // Set to true in capture_end if cudaGraphInstantiate succeeded
+  bool has_graph_exec_ = false;
+
+  // the ID assigned by CUDA during capture
+  c10::cuda::CUDACachingAllocator::CaptureId_t id_;
+
+  // the private pool the allocator served the capture from. Either
+  // {id_, 0} for a pool of this graph, or a handle of graph_pool_handle().
+  c10::cuda::CUDACachingAllocator::MempoolId_t mempool_id_;
+
+  // stream on which capture began
+  at::cuda::CUDAStream capture_stream_;
+
+  // device on which capture began
+  DeviceIndex capture_dev_;
+
+  // the default generator of capture_dev_, and the tensor its captured
+  // kernels read their philox offset from
+  CUDAGeneratorImpl* capture_gen_ = nullptr;
+  at::Tensor offset_extragraph_;
+
+  // philox offset increment each replay consumes
+  uint64_t wholegraph_increment_ = 0;
+};
+
+} // namespace cuda
+} // namespace at
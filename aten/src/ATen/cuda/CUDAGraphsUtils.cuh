@@ -0,0 +1,64 @@
+#pragma once
+
+#include <ATen/CUDAGeneratorImpl.h>
+#include <ATen/cuda/CUDAContext.h>
+#include <c10/cuda/CUDACachingAllocator.h>
+
+#include <string>
+#include <tuple>
+
+namespace at {
+namespace cuda {
+namespace philox {
+
+// In-kernel call to retrieve the philox seed and offset from a PhiloxCudaState,
+// whether it was created while a graph was being captured or not.
+// See Note [CUDA Graph-safe RNG states].
+__device__ __forceinline__ std::tuple<uint64_t, uint64_t>
+unpack(at::PhiloxCudaState arg) {
+  if (arg.captured_) {
+    return std::make_tuple(
+        arg.seed_,
+        static_cast<uint64_t>(*(arg.offset_.ptr) + arg.offset_intragraph_));
+  } else {
+    return std::make_tuple(arg.seed_, arg.offset_.val);
+  }
+}
+
+} // namespace philox
+
+// Mirrors cudaStreamCaptureStatus, which does not exist before CUDA 11.
+#ifdef C10_CUDA_GRAPHS_SUPPORTED
+enum class CaptureStatus : int {
+  None = int(cudaStreamCaptureStatus::cudaStreamCaptureStatusNone),
+  Active = int(cudaStreamCaptureStatus::cudaStreamCaptureStatusActive),
+  Invalidated = int(cudaStreamCaptureStatus::cudaStreamCaptureStatusInvalidated)
+};
+#else
+enum class CaptureStatus : int {
+  None = 0
+};
+#endif
+
+// Whether the current stream of the current device is being captured.
+inline CaptureStatus currentStreamCaptureStatus() {
+#ifdef C10_CUDA_GRAPHS_SUPPORTED
+  cudaStreamCaptureStatus is_capturing;
+  AT_CUDA_CHECK(cudaStreamIsCapturing(at::cuda::getCurrentCUDAStream(), &is_capturing));
+  return CaptureStatus(is_capturing);
+#else
+  return CaptureStatus::None;
+#endif
+}
+
+// For calls whose effect a graph replay would not repeat, e.g. host side
+// bookkeeping of random offsets.
+inline void assertNotCapturing(const std::string& attempt) {
+  auto status = currentStreamCaptureStatus();
+  TORCH_CHECK(status == CaptureStatus::None,
+              attempt, " is not allowed during CUDA graph capture. ",
+              "Current cudaStreamCaptureStatus: ", int(status));
+}
+
+} // namespace cuda
+} // namespace at
@@ -0,0 +1,184 @@
+#include <ATen/cuda/CoalescedCopy.h>
+
+#include <ATen/Parallel.h>
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/native/cuda/MultiTensorApply.cuh>
+#include <c10/cuda/CUDAGuard.h>
+
+#include <cstring>
+
+namespace at { namespace cuda {
+namespace {
+
+// The offset of every tensor in the buffer is a multiple of it, so that the
+// tensors are copied in words and the views of the buffer are aligned.
+constexpr size_t kAlignment = 64;
+// The tensors larger than this are copied on their own.
+constexpr size_t kMaxCoalescedBytes = 1 << 20;
+// The tensors copied by a thread of the host at least.
+constexpr int64_t kHostGrainSize = 16;
+
+size_t aligned(size_t nbytes) {
+  return (nbytes + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+// Copies the bytes of the tensors of the first list to those of the second,
+// in 16 byte words when both are aligned.
+struct CopyBytesFunctor {
+  __device__ __forceinline__ void operator()(
+      int chunk_size,
+      native::TensorListMetadata<2>& tl) {
+    const int tensor_loc = tl.block_to_tensor[blockIdx.x];
+    const int chunk_idx = tl.block_to_chunk[blockIdx.x];
+    const int n = min(tl.sizes[tensor_loc] - chunk_idx * chunk_size, chunk_size);
+    const char* src =
+        static_cast<const char*>(tl.addresses[0][tensor_loc]) + chunk_idx * chunk_size;
+    char* dst = static_cast<char*>(tl.addresses[1][tensor_loc]) + chunk_idx * chunk_size;
+
+    int start = 0;
+    if (reinterpret_cast<uintptr_t>(src) % sizeof(uint4) == 0 &&
+        reinterpret_cast<uintptr_t>(dst) % sizeof(uint4) == 0) {
+      const int words = n / sizeof(uint4);
+      for (int i = threadIdx.x; i < words; i += blockDim.x) {
+        reinterpret_cast<uint4*>(dst)[i] = reinterpret_cast<const uint4*>(src)[i];
+      }
+      start = words * sizeof(uint4);
+    }
+    for (int i = start + threadIdx.x; i < n; i += blockDim.x) {
+      dst[i] = src[i];
+    }
+  }
+};
+
+// The bytes of a contiguous tensor, as a tensor of uint8.
+Tensor bytes_of(const Tensor& tensor) {
+  return at::empty({0}, tensor.options().dtype(kByte))
+      .set_(
+          tensor.storage(),
+          tensor.storage_offset() * tensor.element_size(),
+          {static_cast<int64_t>(tensor.nbytes())},
+          {1});
+}
+
+// A contiguous tensor like `like`, viewing the bytes of `buffer` at `offset`.
+Tensor view_of(const Tensor& buffer, size_t offset, const Tensor& like) {
+  return at::empty({0}, like.options().device(buffer.device()))
+      .set_(buffer.storage(), offset / like.element_size(), like.sizes(), like.strides());
+}
+
+} // namespace
+
+std::vector<Tensor> to_coalesced(
+    TensorList tensors,
+    Device device,
+    bool non_blocking,
+    bool views) {
+  TORCH_CHECK(!tensors.empty(), "to_coalesced expects at least one tensor");
+  const auto src_device = tensors[0].device();
+  if (device.is_cuda() && !device.has_index()) {
+    device = Device(kCUDA, c10::cuda::current_device());
+  }
+  TORCH_CHECK(
+      (src_device.is_cpu() && device.is_cuda()) ||
+          (src_device.is_cuda() && device.is_cpu()),
+      "to_coalesced copies from the host to a CUDA device or the other way "
+      "round, but got a copy from ", src_device, " to ", device);
+  const bool to_device = device.is_cuda();
+
+  std::vector<Tensor> srcs;
+  std::vector<Tensor> results(tensors.size());
+  // The tensors packed into the buffer, and their offsets.
+  std::vector<size_t> packed;
+  std::vector<size_t> offsets;
+  size_t total = 0;
+  srcs.reserve(tensors.size());
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    const auto& tensor = tensors[i];
+    TORCH_CHECK(
+        tensor.device() == src_device,
+        "to_coalesced expects tensors on a single device, but got tensors on ",
+        src_device, " and ", tensor.device());
+    TORCH_CHECK(
+        tensor.layout() == kStrided && !tensor.is_quantized(),
+        "to_coalesced expects dense tensors, but got a tensor of layout ",
+        tensor.layout(), " and dtype ", tensor.scalar_type());
+    srcs.push_back(tensor.contiguous());
+    if (srcs[i].nbytes() > kMaxCoalescedBytes) {
+      results[i] = tensor.to(device, non_blocking);
+      continue;
+    }
+    packed.push_back(i);
+    offsets.push_back(total);
+    total += aligned(srcs[i].nbytes());
+  }
+  if (packed.empty()) {
+    return results;
+  }
+
+  const auto cuda_device = to_device ? device : src_device;
+  CUDAGuard device_guard(cuda_device);
+  auto host_buffer = at::empty(
+      {static_cast<int64_t>(total)},
+      TensorOptions(kByte).pinned_memory(true));
+  auto device_buffer =
+      at::empty({static_cast<int64_t>(total)}, TensorOptions(kByte).device(cuda_device));
+  auto* host_ptr = static_cast<char*>(host_buffer.data_ptr());
+
+  if (to_device) {
+    at::parallel_for(0, packed.size(), kHostGrainSize, [&](int64_t begin, int64_t end) {
+      for (int64_t p = begin; p < end; ++p) {
+        const auto& src = srcs[packed[p]];
+        std::memcpy(host_ptr + offsets[p], src.data_ptr(), src.nbytes());
+      }
+    });
+    device_buffer.copy_(host_buffer, non_blocking);
+    if (views) {
+      for (size_t p = 0; p < packed.size(); ++p) {
+        results[packed[p]] = view_of(device_buffer, offsets[p], srcs[packed[p]]);
+      }
+      return results;
+    }
+    std::vector<std::vector<Tensor>> tensor_lists(2);
+    for (size_t p = 0; p < packed.size(); ++p) {
+      const auto& src = srcs[packed[p]];
+      auto result = at::empty(src.sizes(), src.options().device(device));
+      tensor_lists[0].push_back(
+          device_buffer.narrow(0, offsets[p], src.nbytes()));
+      tensor_lists[1].push_back(bytes_of(result));
+      results[packed[p]] = std::move(result);
+    }
+    native::multi_tensor_apply<2>(tensor_lists, CopyBytesFunctor());
+    return results;
+  }
+
+  std::vector<std::vector<Tensor>> tensor_lists(2);
+  for (size_t p = 0; p < packed.size(); ++p) {
+    const auto& src = srcs[packed[p]];
+    tensor_lists[0].push_back(bytes_of(src));
+    tensor_lists[1].push_back(device_buffer.narrow(0, offsets[p], src.nbytes()));
+  }
+  native::multi_tensor_apply<2>(tensor_lists, CopyBytesFunctor());
+  host_buffer.copy_(device_buffer, non_blocking);
+  if (views) {
+    for (size_t p = 0; p < packed.size(); ++p) {
+      results[packed[p]] = view_of(host_buffer, offsets[p], srcs[packed[p]]);
+    }
+    return results;
+  }
+  if (non_blocking) {
+    getCurrentCUDAStream().synchronize();
+  }
+  for (size_t p = 0; p < packed.size(); ++p) {
+    const auto& src = srcs[packed[p]];
+    results[packed[p]] = at::empty(src.sizes(), src.options().device(kCPU));
+  }
+  at::parallel_for(0, packed.size(), kHostGrainSize, [&](int64_t begin, int64_t end) {
+    for (int64_t p = begin; p < end; ++p) {
+      const auto& result = results[packed[p]];
+      std::memcpy(result.data_ptr(), host_ptr + offsets[p], result.nbytes());
+    }
+  });
+  return results;
+}
+
+}} // namespace at::cuda
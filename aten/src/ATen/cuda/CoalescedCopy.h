@@ -0,0 +1,30 @@
+#pragma once
+
+#include <ATen/ATen.h>
+
+#include <vector>
+
+namespace at { namespace cuda {
+
+// Copies many tensors between the host and a CUDA device at once, which is
+// much faster than copying small tensors one by one, as every copy costs a
+// transfer of its own. The tensors, of any dtypes, are packed into one
+// buffer, in pinned memory on the host, which is copied at once and unpacked
+// on the other side: by a single kernel on the device, or by the CPU.
+//
+// The sources are all on the host and `device` is a CUDA device, or the other
+// way round. If `views` is true the results are views of the buffer the
+// tensors were copied into, and unpacking is skipped. Tensors larger than a
+// MiB are copied on their own, as the transfer of their bytes costs more than
+// its launch.
+//
+// With `non_blocking`, the copies are asynchronous wrt the host like those of
+// `Tensor::to`, except for the unpacking of the copies to the host into
+// separate tensors, which waits for the current stream.
+TORCH_CUDA_API std::vector<Tensor> to_coalesced(
+    TensorList tensors,
+    Device device,
+    bool non_blocking = false,
+    bool views = false);
+
+}} // namespace at::cuda
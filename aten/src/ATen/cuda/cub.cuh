@@ -0,0 +1,138 @@
+#pragma once
+
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/Exceptions.h>
+#include <c10/cuda/CUDACachingAllocator.h>
+#include <c10/util/Half.h>
+
+#include <cub/device/device_radix_sort.cuh>
+#include <cub/device/device_run_length_encode.cuh>
+#include <cub/device/device_segmented_radix_sort.cuh>
+#include <cub/device/device_select.cuh>
+#include <cuda_fp16.h>
+
+#include <limits>
+
+// Wrappers of the CUB device-wide algorithms used by ATen. They run on the
+// current stream and take their temporary storage from the caching
+// allocator, so repeated calls of the same size reuse the same block instead
+// of allocating one each time.
+
+// Calls `func` once to size its temporary storage and once to run it.
+#define CUB_WRAPPER(func, ...) do {                                         \
+  size_t temp_storage_bytes = 0;                                            \
+  AT_CUDA_CHECK(func(nullptr, temp_storage_bytes, __VA_ARGS__));            \
+  auto& caching_allocator = *::c10::cuda::CUDACachingAllocator::get();      \
+  auto temp_storage = caching_allocator.allocate(temp_storage_bytes);       \
+  AT_CUDA_CHECK(func(temp_storage.get(), temp_storage_bytes, __VA_ARGS__)); \
+} while (false)
+
+namespace at { namespace cuda { namespace cub {
+
+namespace detail {
+
+// CUB radix sorts CUDA's own types; c10::Half shares the layout of __half.
+template <typename T>
+struct cuda_type {
+  using type = T;
+};
+
+template <>
+struct cuda_type<c10::Half> {
+  using type = __half;
+};
+
+template <>
+struct cuda_type<bool> {
+  using type = uint8_t;
+};
+
+inline void check_num_items(int64_t n) {
+  TORCH_CHECK(n <= std::numeric_limits<int>::max(),
+      "cub sorts at most ", std::numeric_limits<int>::max(), " elements, but got ", n);
+}
+
+} // namespace detail
+
+// Whether `scalar_type` can be used as a key of the radix sorts below.
+inline bool is_radix_sortable(ScalarType scalar_type) {
+  return scalar_type != kBFloat16 && !isComplexType(scalar_type);
+}
+
+template <typename key_t>
+void sort_keys(
+    const key_t* keys_in, key_t* keys_out, int64_t n, bool descending = false,
+    int begin_bit = 0, int end_bit = sizeof(key_t) * 8) {
+  detail::check_num_items(n);
+  using key_t_ = typename detail::cuda_type<key_t>::type;
+  const key_t_* keys_in_ = reinterpret_cast<const key_t_*>(keys_in);
+  key_t_* keys_out_ = reinterpret_cast<key_t_*>(keys_out);
+  if (descending) {
+    CUB_WRAPPER(::cub::DeviceRadixSort::SortKeysDescending,
+        keys_in_, keys_out_, static_cast<int>(n), begin_bit, end_bit, at::cuda::getCurrentCUDAStream());
+  } else {
+    CUB_WRAPPER(::cub::DeviceRadixSort::SortKeys,
+        keys_in_, keys_out_, static_cast<int>(n), begin_bit, end_bit, at::cuda::getCurrentCUDAStream());
+  }
+}
+
+template <typename key_t, typename value_t>
+void sort_pairs(
+    const key_t* keys_in, key_t* keys_out, const value_t* values_in, value_t* values_out,
+    int64_t n, bool descending = false, int begin_bit = 0, int end_bit = sizeof(key_t) * 8) {
+  detail::check_num_items(n);
+  using key_t_ = typename detail::cuda_type<key_t>::type;
+  const key_t_* keys_in_ = reinterpret_cast<const key_t_*>(keys_in);
+  key_t_* keys_out_ = reinterpret_cast<key_t_*>(keys_out);
+  if (descending) {
+    CUB_WRAPPER(::cub::DeviceRadixSort::SortPairsDescending,
+        keys_in_, keys_out_, values_in, values_out, static_cast<int>(n), begin_bit, end_bit,
+        at::cuda::getCurrentCUDAStream());
+  } else {
+    CUB_WRAPPER(::cub::DeviceRadixSort::SortPairs,
+        keys_in_, keys_out_, values_in, values_out, static_cast<int>(n), begin_bit, end_bit,
+        at::cuda::getCurrentCUDAStream());
+  }
+}
+
+// Sorts segments [begin_offsets[i], end_offsets[i]) of the n items
+// independently; the offsets are read on the device.
+template <typename key_t, typename value_t, typename offset_t>
+void segmented_sort_pairs(
+    const key_t* keys_in, key_t* keys_out, const value_t* values_in, value_t* values_out,
+    int64_t n, int64_t num_segments, offset_t begin_offsets, offset_t end_offsets,
+    bool descending = false, int begin_bit = 0, int end_bit = sizeof(key_t) * 8) {
+  detail::check_num_items(n);
+  detail::check_num_items(num_segments);
+  using key_t_ = typename detail::cuda_type<key_t>::type;
+  const key_t_* keys_in_ = reinterpret_cast<const key_t_*>(keys_in);
+  key_t_* keys_out_ = reinterpret_cast<key_t_*>(keys_out);
+  if (descending) {
+    CUB_WRAPPER(::cub::DeviceSegmentedRadixSort::SortPairsDescending,
+        keys_in_, keys_out_, values_in, values_out, static_cast<int>(n), static_cast<int>(num_segments),
+        begin_offsets, end_offsets, begin_bit, end_bit, at::cuda::getCurrentCUDAStream());
+  } else {
+    CUB_WRAPPER(::cub::DeviceSegmentedRadixSort::SortPairs,
+        keys_in_, keys_out_, values_in, values_out, static_cast<int>(n), static_cast<int>(num_segments),
+        begin_offsets, end_offsets, begin_bit, end_bit, at::cuda::getCurrentCUDAStream());
+  }
+}
+
+// Writes the first item of every run of equal consecutive items to `out` and
+// the number of runs to `num_out` on the device.
+template <typename scalar_t>
+void unique(const scalar_t* in, scalar_t* out, int64_t* num_out, int64_t n) {
+  detail::check_num_items(n);
+  CUB_WRAPPER(::cub::DeviceSelect::Unique,
+      in, out, num_out, static_cast<int>(n), at::cuda::getCurrentCUDAStream());
+}
+
+// Like unique, also writing the length of every run to `counts`.
+template <typename scalar_t>
+void run_length_encode(const scalar_t* in, scalar_t* out, int64_t* counts, int64_t* num_out, int64_t n) {
+  detail::check_num_items(n);
+  CUB_WRAPPER(::cub::DeviceRunLengthEncode::Encode,
+      in, out, counts, num_out, static_cast<int>(n), at::cuda::getCurrentCUDAStream());
+}
+
+}}} // namespace at::cuda::cub
@@ -18,6 +18,7 @@
 
 #if AT_CUDNN_ENABLED()
 #include <ATen/cudnn/cudnn-wrapper.h>
+#include <ATen/native/cudnn/ConvBenchmarkCache.h>
 #endif
 
 #ifdef USE_MAGMA
@@ -323,6 +324,22 @@ double CUDAHooks::batchnormMinEpsilonCuDNN() const {
 #endif
 }
 
+void CUDAHooks::saveCuDNNConvBenchmarkCache(const std::string& path) const {
+#if AT_CUDNN_ENABLED()
+  at::native::detail::cudnn_save_conv_benchmark_cache_impl(path);
+#else
+  AT_ERROR("Cannot save the cuDNN benchmark cache if ATen_cuda is not built with CuDNN");
+#endif
+}
+
+int64_t CUDAHooks::loadCuDNNConvBenchmarkCache(const std::string& path) const {
+#if AT_CUDNN_ENABLED()
+  return at::native::detail::cudnn_load_conv_benchmark_cache_impl(path);
+#else
+  AT_ERROR("Cannot load the cuDNN benchmark cache if ATen_cuda is not built with CuDNN");
+#endif
+}
+
 int64_t CUDAHooks::cuFFTGetPlanCacheMaxSize(int64_t device_index) const {
 #ifndef __HIP_PLATFORM_HCC__
   return at::native::detail::cufft_get_plan_cache_max_size_impl(device_index);
@@ -347,6 +364,22 @@ int64_t CUDAHooks::cuFFTGetPlanCacheSize(int64_t device_index) const {
 #endif
 }
 
+int64_t CUDAHooks::cuFFTGetPlanCacheHits(int64_t device_index) const {
+#ifndef __HIP_PLATFORM_HCC__
+  return at::native::detail::cufft_get_plan_cache_hits_impl(device_index);
+#else
+  AT_ERROR("cuFFT with HIP is not supported");
+#endif
+}
+
+int64_t CUDAHooks::cuFFTGetPlanCacheMisses(int64_t device_index) const {
+#ifndef __HIP_PLATFORM_HCC__
+  return at::native::detail::cufft_get_plan_cache_misses_impl(device_index);
+#else
+  AT_ERROR("cuFFT with HIP is not supported");
+#endif
+}
+
 void CUDAHooks::cuFFTClearPlanCache(int64_t device_index) const {
 #ifndef __HIP_PLATFORM_HCC__
   at::native::detail::cufft_clear_plan_cache_impl(device_index);
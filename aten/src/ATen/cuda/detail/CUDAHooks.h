@@ -33,9 +33,13 @@ struct CUDAHooks : public at::CUDAHooksInterface {
   long versionCuDNN() const override;
   std::string showConfig() const override;
   double batchnormMinEpsilonCuDNN() const override;
+  void saveCuDNNConvBenchmarkCache(const std::string& path) const override;
+  int64_t loadCuDNNConvBenchmarkCache(const std::string& path) const override;
   int64_t cuFFTGetPlanCacheMaxSize(int64_t device_index) const override;
   void cuFFTSetPlanCacheMaxSize(int64_t device_index, int64_t max_size) const override;
   int64_t cuFFTGetPlanCacheSize(int64_t device_index) const override;
+  int64_t cuFFTGetPlanCacheHits(int64_t device_index) const override;
+  int64_t cuFFTGetPlanCacheMisses(int64_t device_index) const override;
   void cuFFTClearPlanCache(int64_t device_index) const override;
   int getNumGPUs() const override;
 };
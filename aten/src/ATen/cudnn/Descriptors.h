@@ -280,6 +280,17 @@ struct TORCH_CUDA_API CTCLossDescriptor
 #endif
 };
 
+struct TORCH_CUDA_API ActivationDescriptor
+  : public Descriptor<cudnnActivationStruct,
+                      &cudnnCreateActivationDescriptor,
+                      &cudnnDestroyActivationDescriptor>
+{
+  void set(cudnnActivationMode_t mode) {
+    AT_CUDNN_CHECK(cudnnSetActivationDescriptor(
+        mut_desc(), mode, CUDNN_PROPAGATE_NAN, /*coef=*/0.0));
+  }
+};
+
 union Constant
 {
   float f;
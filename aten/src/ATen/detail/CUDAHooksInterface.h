@@ -162,6 +162,14 @@ struct CAFFE2_API CUDAHooksInterface {
         "Cannot query batchnormMinEpsilonCuDNN() without ATen_cuda library. ", CUDA_HELP);
   }
 
+  virtual void saveCuDNNConvBenchmarkCache(const std::string& path) const {
+    TORCH_CHECK(false, "Cannot save the cuDNN benchmark cache without ATen_cuda library. ", CUDA_HELP);
+  }
+
+  virtual int64_t loadCuDNNConvBenchmarkCache(const std::string& path) const {
+    TORCH_CHECK(false, "Cannot load the cuDNN benchmark cache without ATen_cuda library. ", CUDA_HELP);
+  }
+
   virtual int64_t cuFFTGetPlanCacheMaxSize(int64_t device_index) const {
     TORCH_CHECK(false, "Cannot access cuFFT plan cache without ATen_cuda library. ", CUDA_HELP);
   }
@@ -174,6 +182,14 @@ struct CAFFE2_API CUDAHooksInterface {
     TORCH_CHECK(false, "Cannot access cuFFT plan cache without ATen_cuda library. ", CUDA_HELP);
   }
 
+  virtual int64_t cuFFTGetPlanCacheHits(int64_t device_index) const {
+    TORCH_CHECK(false, "Cannot access cuFFT plan cache without ATen_cuda library. ", CUDA_HELP);
+  }
+
+  virtual int64_t cuFFTGetPlanCacheMisses(int64_t device_index) const {
+    TORCH_CHECK(false, "Cannot access cuFFT plan cache without ATen_cuda library. ", CUDA_HELP);
+  }
+
   virtual void cuFFTClearPlanCache(int64_t device_index) const {
     TORCH_CHECK(false, "Cannot access cuFFT plan cache without ATen_cuda library. ", CUDA_HELP);
   }
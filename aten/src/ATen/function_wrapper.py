@@ -1610,7 +1610,7 @@ def create_derived(backend_type_env, declarations):
                 option['native_type_method_dispatch'] = native_dispatch
                 option['device_init'] = gen_device_init(option, backend_type_env)
 
-                if backend in ['CPU', 'SparseCPU', 'QuantizedCPU', 'MkldnnCPU']:
+                if backend in ['CPU', 'SparseCPU', 'SparseCsrCPU', 'QuantizedCPU', 'MkldnnCPU']:
                     # Omit the device guard entirely in these cases
                     def_backend = NATIVE_DISPATCH_DEFINITION_CPU_BACKEND
                 else:
@@ -5,6 +5,7 @@
 #include <ATen/Dispatch.h>
 #include <ATen/NativeFunctions.h>
 #include <ATen/native/TensorIterator.h>
+#include <ATen/native/xnnpack/Engine.h>
 #include <ATen/Parallel.h>
 #include <ATen/core/DistributionsHelper.h>
 
@@ -141,6 +142,11 @@ Tensor elu_backward(
 }
 
 Tensor hardswish(const Tensor& self) {
+#if defined(C10_MOBILE)
+  if (xnnpack::use_hardswish(self)) {
+    return xnnpack::hardswish(self);
+  }
+#endif
   Tensor result;
   auto iter = TensorIterator::unary_op(result, self);
   hardswish_stub(iter.device_type(), iter);
@@ -154,6 +160,11 @@ Tensor& hardswish_out(Tensor& result, const Tensor& self) {
 }
 
 Tensor& hardswish_(Tensor& self) {
+#if defined(C10_MOBILE)
+  if (xnnpack::use_hardswish(self)) {
+    return xnnpack::hardswish_(self);
+  }
+#endif
   auto iter = TensorIterator::unary_op(self, self);
   hardswish_stub(iter.device_type(), iter);
   return self;
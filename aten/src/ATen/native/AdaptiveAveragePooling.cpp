@@ -1,6 +1,7 @@
 #include <ATen/ATen.h>
 #include <ATen/NativeFunctions.h>
 #include <ATen/Parallel.h>
+#include <ATen/native/xnnpack/Engine.h>
 #include <tuple>
 
 
@@ -329,6 +330,13 @@ namespace {
       return at::mkldnn_adaptive_avg_pool2d(input, output_size);
     }
 
+#if defined(C10_MOBILE)
+    if (output_size[0] == 1 && output_size[1] == 1 &&
+        xnnpack::use_global_average_pool(input)) {
+      return xnnpack::global_average_pool(input);
+    }
+#endif
+
     // TODO: fastpath for Channels_last should be explored later;
     if (input.suggest_memory_format() == at::MemoryFormat::Contiguous && !input.is_quantized() && output_size[0] == 1 && output_size[1] == 1) {
       // in this case, adaptive pooling is just computing mean over hw
@@ -2,6 +2,7 @@
 #include <ATen/Parallel.h>
 #include <ATen/NativeFunctions.h>
 #include <ATen/native/Pool.h>
+#include <ATen/native/xnnpack/Engine.h>
 #include <tuple>
 
 
@@ -366,6 +367,12 @@ Tensor avg_pool2d_cpu(
   bool count_include_pad,
   c10::optional<int64_t> divisor_override)
 {
+#if defined(C10_MOBILE)
+  if (xnnpack::use_avg_pool2d(input, kernel_size, padding, stride,
+                              ceil_mode, count_include_pad, divisor_override)) {
+    return xnnpack::avg_pool2d(input, kernel_size, padding, stride, ceil_mode);
+  }
+#endif
   Tensor output = at::empty({0}, input.options());
   avg_pool2d_out_cpu_template(
     output,
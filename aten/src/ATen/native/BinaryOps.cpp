@@ -7,6 +7,7 @@
 #include <ATen/MemoryOverlap.h>
 #include <ATen/NativeFunctions.h>
 #include <ATen/native/TensorIterator.h>
+#include <ATen/native/xnnpack/Engine.h>
 
 #include <torch/library.h>
 
@@ -58,6 +59,11 @@ Tensor& add_out(Tensor& result, const Tensor& self, const Tensor& other, Scalar
 }
 
 Tensor add(const Tensor& self, const Tensor& other, Scalar alpha) {
+#if defined(C10_MOBILE)
+  if (xnnpack::use_add(self, other, alpha)) {
+    return xnnpack::add(self, other);
+  }
+#endif
   Tensor result;
   auto iter = TensorIterator::binary_op(result, self, other);
   alpha_check(iter.dtype(), alpha);
@@ -802,7 +808,6 @@ Tensor& floor_divide_(Tensor& self, Scalar other) {
 Tensor& fmod_out(Tensor & result, const Tensor& self, const Tensor& other) {
   auto iter = TensorIterator::binary_op(result, self, other,
                                         /*check_mem_overlap=*/true);
-  TORCH_CHECK(iter.device_type() == at::kCPU, "Native fmod only supports CPU");
   fmod_stub(iter.device_type(), iter);
   return result;
 }
@@ -810,7 +815,6 @@ Tensor& fmod_out(Tensor & result, const Tensor& self, const Tensor& other) {
 Tensor& fmod_out(Tensor & result, const Tensor& self, Scalar other) {
   auto iter = TensorIterator::unary_op(result, self,
                                        /*check_mem_overlap=*/true);
-  TORCH_CHECK(iter.device_type() == at::kCPU, "Native fmod only supports CPU");
   fmod_scalar_stub(iter.device_type(), iter, other);
   return result;
 }
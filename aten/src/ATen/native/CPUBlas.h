@@ -1,6 +1,7 @@
 #pragma once
 
 #include <ATen/native/DispatchStub.h>
+#include <c10/util/BFloat16.h>
 #include <c10/util/complex.h>
 #include <c10/core/ScalarType.h>
 #include <c10/core/Scalar.h>
@@ -34,6 +35,30 @@ using gemm_fn = void(*)(
 
 DECLARE_DISPATCH(gemm_fn, gemm_stub);
 
+// The largest sizes of the matrices gemm_batched_small is meant for.
+constexpr int64_t kSmallGemmMaxSize = 64;
+
+// Computes c[i] = alpha * a[i] @ b[i] + beta * c[i] for the `batch_size`
+// matrices of each operand, which are `*_batch_stride` elements apart. The
+// elements of a and b can have any strides, the rows of c must be
+// contiguous. c isn't read when beta is 0.
+//
+// This is for small matrices, whose multiplication is dominated by the
+// overhead of a BLAS call: the batch is split among the threads, and each
+// product is computed by register-blocked kernels vectorized for the CPU.
+// Only implemented for float and double.
+using gemm_batched_small_fn = void(*)(
+    at::ScalarType type,
+    int64_t batch_size,
+    int64_t m, int64_t n, int64_t k,
+    Scalar alpha,
+    const void *a, int64_t a_batch_stride, int64_t a_row_stride, int64_t a_col_stride,
+    const void *b, int64_t b_batch_stride, int64_t b_row_stride, int64_t b_col_stride,
+    Scalar beta,
+    void *c, int64_t c_batch_stride, int64_t ldc);
+
+DECLARE_DISPATCH(gemm_batched_small_fn, gemm_batched_small_stub);
+
 template <typename scalar_t>
 void gemm(
     TransposeType transa, TransposeType transb,
@@ -67,6 +92,16 @@ void gemm(
     float beta,
     float *c, int64_t ldc);
 
+// Uses oneDNN when ATen is built with MKLDNN, see mkldnn_bf16_gemm.
+void gemm(
+    TransposeType transa, TransposeType transb,
+    int64_t m, int64_t n, int64_t k,
+    c10::BFloat16 alpha,
+    const c10::BFloat16 *a, int64_t lda,
+    const c10::BFloat16 *b, int64_t ldb,
+    c10::BFloat16 beta,
+    c10::BFloat16 *c, int64_t ldc);
+
 void gemm(
     TransposeType transa, TransposeType transb,
     int64_t m, int64_t n, int64_t k,
@@ -5,6 +5,7 @@
 #include <ATen/native/utils/ParamUtils.h>
 #include <ATen/native/ConvUtils.h>
 #include <ATen/native/xnnpack/Engine.h>
+#include <ATen/core/grad_mode.h>
 
 #include <ATen/Config.h>
 #include <c10/macros/Macros.h>
@@ -19,6 +20,7 @@ constexpr int MIOPEN_DIM_MAX = 5;
 namespace at { namespace native {
 
 DEFINE_DISPATCH(convolution_depthwise3x3_winograd_stub);
+DEFINE_DISPATCH(convolution_depthwise_stub);
 
 struct ConvParams {
   std::vector<int64_t> stride;
@@ -40,6 +42,7 @@ struct ConvParams {
   bool is_stride_nonpos() const;
   void view1d_as_2d();
   bool use_cpu_depthwise3x3_winograd(const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias) const;
+  bool use_cpu_depthwise(const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias) const;
   bool needs_64bit_indexing_no_split(const at::Tensor& input, const at::Tensor& weight) const;
   bool use_cudnn(const at::Tensor& input, const at::Tensor& weight) const;
   bool use_cudnn_depthwise(const at::Tensor& input, const at::Tensor& weight) const;
@@ -159,6 +162,40 @@ auto ConvParams::use_cpu_depthwise3x3_winograd(
 #endif
 }
 
+auto ConvParams::use_cpu_depthwise(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias) const -> bool {
+  // The direct kernels do not record anything for autograd, since the
+  // convolution is composite; they are only used for inference.
+  if (at::GradMode::is_enabled() &&
+      (input.requires_grad() || weight.requires_grad() ||
+       (bias.defined() && bias.requires_grad()))) {
+    return false;
+  }
+  // Depthwise 3x3 and 5x5 convolutions of stride 1 or 2 on tensors of float.
+  return (input.ndimension() == 4) &&
+         (groups > 1) &&
+         (input.size(1) == groups) &&
+         (weight.ndimension() == 4) &&
+         (weight.size(0) % input.size(1) == 0) &&
+         (weight.size(2) == weight.size(3)) &&
+         (weight.size(2) == 3 || weight.size(2) == 5) &&
+         (stride[0] == stride[1]) &&
+         (stride[0] == 1 || stride[0] == 2) &&
+         (input.device().type() == c10::DeviceType::CPU) &&
+         (input.layout() == c10::kStrided) &&
+         (input.scalar_type() == at::kFloat) &&
+         (weight.device().type() == c10::DeviceType::CPU) &&
+         (weight.layout() == c10::kStrided) &&
+         (weight.scalar_type() == at::kFloat) &&
+         (!bias.defined() ||
+            ((bias.device().type() == c10::DeviceType::CPU) &&
+             (bias.scalar_type() == at::kFloat))) &&
+         !is_dilated() &&
+         !transposed;
+}
+
 auto ConvParams::needs_64bit_indexing_no_split(const at::Tensor& input, const at::Tensor& weight) const -> bool {
   constexpr int64_t int_max = std::numeric_limits<int>::max();
   int64_t numel_input = input.numel();
@@ -270,6 +307,16 @@ auto ConvParams::use_xnnpack(
                 dilation,
                 groups);
   }
+  return (input.size(1) == groups) &&
+          xnnpack::use_conv_transpose2d(
+              input,
+              weight,
+              bias,
+              padding,
+              output_padding,
+              stride,
+              dilation,
+              groups);
 #endif
   return false;
 }
@@ -735,23 +782,43 @@ at::Tensor _convolution(
   } else if (params.use_xnnpack(input, weight, bias)) {
     // Using prepacked conv is preferred, but XNNPACK is still the fastest
     // option for NHWC.
-    output = xnnpack::convolution2d(
+    if (params.transposed) {
+      output = xnnpack::conv_transpose2d(
+          input,
+          weight,
+          bias,
+          params.padding,
+          params.output_padding,
+          params.stride,
+          params.dilation,
+          params.groups);
+    } else {
+      output = xnnpack::convolution2d(
+          input,
+          weight,
+          bias,
+          params.padding,
+          params.stride,
+          params.dilation,
+          params.groups);
+    }
+  } else if (params.use_cpu_depthwise3x3_winograd(input, weight, bias)) {
+    output = convolution_depthwise3x3_winograd_stub(
+        input.device().type(),
         input,
         weight,
         bias,
-        params.padding,
         params.stride,
-        params.dilation,
+        params.padding,
         params.groups);
-  } else if (params.use_cpu_depthwise3x3_winograd(input, weight, bias)) {
-    output = convolution_depthwise3x3_winograd_stub(
+  } else if (params.use_cpu_depthwise(input, weight, bias)) {
+    output = convolution_depthwise_stub(
         input.device().type(),
         input,
         weight,
         bias,
         params.stride,
-        params.padding,
-        params.groups);
+        params.padding);
   } else if (
         !params.transposed && (input.ndimension() == 5) &&
         (input.device().type() == c10::DeviceType::CPU) &&
@@ -1110,4 +1177,15 @@ std::tuple<Tensor,Tensor,Tensor> _convolution_double_backward(
   return std::tuple<Tensor,Tensor,Tensor>{ggO, gI, gW};
 }
 
+// We call the following methods via CUDA hooks because the benchmark cache of
+// cuDNN convolutions is only there when CUDA is loaded. See
+// native/cudnn/ConvBenchmarkCache.h for more details.
+void _cudnn_save_conv_benchmark_cache(std::string path) {
+  detail::getCUDAHooks().saveCuDNNConvBenchmarkCache(path);
+}
+
+int64_t _cudnn_load_conv_benchmark_cache(std::string path) {
+  return detail::getCUDAHooks().loadCuDNNConvBenchmarkCache(path);
+}
+
 }} // at::native
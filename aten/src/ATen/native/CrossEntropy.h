@@ -0,0 +1,29 @@
+#pragma once
+
+#include <ATen/ATen.h>
+
+namespace at { namespace native {
+
+// Checks the arguments of _cross_entropy_rows and its backward, shared by the
+// CPU and CUDA implementations. Every row of the 2D `self` holds the logits
+// of one sample, whose class index is the element of `target` of that row.
+inline void cross_entropy_rows_check_inputs(const Tensor& self, const Tensor& target, const Tensor& weight) {
+  TORCH_CHECK(self.dim() == 2, "_cross_entropy_rows: expected a 2D input, but got ", self.dim(), "D");
+  TORCH_CHECK(target.scalar_type() == ScalarType::Long,
+      "_cross_entropy_rows: expected a target of dtype Long, but got ", target.scalar_type());
+  TORCH_CHECK(target.dim() == 1 && target.size(0) == self.size(0),
+      "_cross_entropy_rows: expected a target of size [", self.size(0), "], but got ", target.sizes());
+  if (weight.defined()) {
+    TORCH_CHECK(weight.numel() == self.size(1) && weight.scalar_type() == self.scalar_type(),
+        "_cross_entropy_rows: expected a weight of ", self.size(1), " elements of dtype ",
+        self.scalar_type(), ", but got ", weight.numel(), " elements of dtype ", weight.scalar_type());
+  }
+}
+
+// The dtype the logsumexp of every row is saved in for backward, so that
+// reduced precision inputs keep the precision of the softmax.
+inline ScalarType cross_entropy_logsumexp_type(ScalarType input_type) {
+  return input_type == ScalarType::Double ? ScalarType::Double : ScalarType::Float;
+}
+
+}}  // namespace at::native
@@ -2,6 +2,7 @@
 #include <ATen/NativeFunctions.h>
 #include <ATen/Parallel.h>
 #include <ATen/TensorUtils.h>
+#include <ATen/native/RadixSort.h>
 
 #include <TH/THBlasUtils.h>
 
@@ -12,6 +13,7 @@
 #endif
 
 #include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <iostream>
 #include <memory>
@@ -41,12 +43,188 @@ static void make_offset2bag(const Tensor &offsets, const Tensor &indices, Tensor
 
 namespace {
 
+bool isReducedPrecision(const Tensor& t) {
+  return t.scalar_type() == kHalf || t.scalar_type() == kBFloat16;
+}
+
 bool isFastPathIndexSelect(const Tensor& src, Tensor& output) {
-  return src.scalar_type() == kFloat && src.stride(1) == 1 && output.stride(1) == 1;
+  return (src.scalar_type() == kFloat || isReducedPrecision(src)) &&
+      src.stride(1) == 1 && output.stride(1) == 1;
 }
 
 bool isFastPathIndexSelectScale(const Tensor& src, const Tensor& scale, Tensor& output) {
-  return src.scalar_type() == kFloat && src.stride(1) == 1 && output.stride(1) == 1 && scale.stride(0) == 1;
+  return (src.scalar_type() == kFloat || isReducedPrecision(src)) &&
+      src.stride(1) == 1 && output.stride(1) == 1 && scale.stride(0) == 1;
+}
+
+// The fast paths take offsets with the end of the last bag appended.
+const int64_t* offsets_with_last(
+    const Tensor& offsets,
+    const Tensor& select_indices,
+    bool include_last_offset,
+    std::vector<int64_t>& offsets_include_last,
+    int64_t& output_size) {
+  if (include_last_offset) {
+    output_size = offsets.numel() - 1;
+    return offsets.data_ptr<int64_t>();
+  }
+  output_size = offsets.numel();
+  offsets_include_last.resize(offsets.numel() + 1);
+  std::memcpy(
+      offsets_include_last.data(),
+      offsets.data_ptr<int64_t>(),
+      sizeof(int64_t) * offsets.numel());
+  offsets_include_last[offsets.numel()] = select_indices.numel();
+  return offsets_include_last.data();
+}
+
+// Half and BFloat16 tables are reduced into a float output, so the table can
+// be stored at half the size without losing precision in the sums (see
+// _embedding_bag_cpu_impl).
+template <typename T>
+struct embedding_bag_output {
+  using type = T;
+};
+template <>
+struct embedding_bag_output<at::Half> {
+  using type = float;
+};
+template <>
+struct embedding_bag_output<at::BFloat16> {
+  using type = float;
+};
+
+// Sums the BFloat16 rows src[select_indices[offsets[b]:offsets[b + 1]]]
+// (each scaled by scale_data[i] if given) into the float output[b]. Neither
+// FBGEMM nor caffe2's EmbeddingLookupIdx has a bf16 kernel.
+void embedding_bag_bfloat16_fast_path(
+    const Tensor& select_indices,
+    const float* scale_data,
+    const Tensor& src,
+    Tensor& output,
+    const Tensor& offsets,
+    bool include_last_offset) {
+  int64_t ddim = src.size(1);
+  auto src_stride0 = src.stride(0);
+  auto* src_data = src.data_ptr<BFloat16>();
+  auto* select_indices_data = select_indices.data_ptr<int64_t>();
+  auto* output_data = output.data_ptr<float>();
+  auto output_stride0 = output.stride(0);
+
+  int64_t output_size = 0;
+  std::vector<int64_t> offsets_include_last;
+  const int64_t* offsets_data = offsets_with_last(
+      offsets, select_indices, include_last_offset, offsets_include_last, output_size);
+
+  at::parallel_for(
+      0, output_size, 1, [&](int64_t start_idx, int64_t end_idx) {
+        for (int64_t bag = start_idx; bag < end_idx; bag++) {
+          float* output_row = output_data + output_stride0 * bag;
+          std::fill(output_row, output_row + ddim, 0.f);
+          for (int64_t i = offsets_data[bag]; i < offsets_data[bag + 1]; i++) {
+            const BFloat16* src_row = src_data + src_stride0 * select_indices_data[i];
+            const float scale = scale_data ? scale_data[i] : 1.f;
+            // Plain loop so that the compiler widens and accumulates a full
+            // register of lanes at a time.
+            for (int64_t j = 0; j < ddim; j++) {
+              output_row[j] += static_cast<float>(src_row[j]) * scale;
+            }
+          }
+        }
+      });
+}
+
+// Same as the float fast path in index_select_add<float>, reading fp16 rows.
+void embedding_bag_half_fast_path(
+    const Tensor& select_indices,
+    const float* scale_data,
+    const Tensor& src,
+    Tensor& output,
+    const Tensor& offsets,
+    bool include_last_offset) {
+  int64_t ddim = src.size(1);
+  auto* src_data = src.data_ptr<at::Half>();
+  auto* select_indices_data = select_indices.data_ptr<int64_t>();
+  auto* output_data = output.data_ptr<float>();
+
+  int64_t output_size = 0;
+  std::vector<int64_t> offsets_include_last;
+  const int64_t* offsets_data = offsets_with_last(
+      offsets, select_indices, include_last_offset, offsets_include_last, output_size);
+
+#ifdef USE_FBGEMM
+  auto kernel_fp16_i64 =
+    fbgemm::GenerateEmbeddingSpMDM<fbgemm::float16, int64_t, int64_t>(
+      /* block_size */ddim,
+      /* has_weight */scale_data != nullptr,
+      /* normalize_by_lengths */false,
+      /* prefetch */16,
+      /* is_weight_positional */false,
+      /* use_offsets */true
+    );
+#endif
+  at::parallel_for(
+      0, output_size, 1, [&](int64_t start_idx, int64_t end_idx) {
+#ifdef USE_FBGEMM
+        bool success = kernel_fp16_i64(
+          /* output_size */end_idx - start_idx,
+          /* index_size */offsets_data[end_idx] - offsets_data[start_idx],
+          /* data_size */src.size(0),
+          /* input */reinterpret_cast<const fbgemm::float16*>(src_data),
+          /* indices */select_indices_data + offsets_data[start_idx],
+          /* offsets_or_lengths */offsets_data + start_idx,
+          /* weights */scale_data ? scale_data + offsets_data[start_idx] : nullptr,
+          /* output */output_data + start_idx * ddim);
+        TORCH_CHECK(
+            success,
+            "FBGEMM GenerateEmbeddingSpMDM kernel failed for fp16 input: "
+            "an index is out of range of the embedding table");
+#else
+        caffe2::EmbeddingLookupIdx(
+            /*block_size=*/ddim,
+            /*output_size=*/end_idx - start_idx,
+            /*index_size=*/offsets_data[end_idx] - offsets_data[start_idx],
+            /*data_size=*/src.size(0),
+            /*input=*/src_data,
+            /*indices=*/select_indices_data + offsets_data[start_idx],
+            /*offsets=*/offsets_data + start_idx,
+            /*weights=*/scale_data ? scale_data + offsets_data[start_idx] : nullptr,
+            /*scale_bias=*/nullptr,
+            /*normalize_by_lengths=*/false,
+            /*out=*/output_data + start_idx * ddim);
+#endif
+      });
+}
+
+// Slow path for reduced-precision tables with a non-unit feature stride.
+template <typename T>
+void index_select_add_reduced_precision(
+    const Tensor& select_indices,
+    const Tensor& add_indices,
+    const float* scale_data,
+    int64_t scale_stride,
+    const Tensor& src,
+    Tensor& output) {
+  AT_ASSERT(select_indices.numel() == add_indices.numel());
+  auto* add_indices_data = add_indices.data_ptr<int64_t>();
+  auto* select_indices_data = select_indices.data_ptr<int64_t>();
+  auto* src_data = src.data_ptr<T>();
+  auto* output_data = output.data_ptr<float>();
+  auto numel = add_indices.numel();
+  int64_t ddim = src.size(1);
+  auto src_stride0 = src.stride(0);
+  auto src_stride1 = src.stride(1);
+  auto output_stride0 = output.stride(0);
+  auto output_stride1 = output.stride(1);
+  for (int64_t i = 0; i < numel; i++) {
+    auto* src_base = src_data + src_stride0 * select_indices_data[i];
+    auto* output_base = output_data + output_stride0 * add_indices_data[i];
+    float scale = scale_data ? scale_data[i * scale_stride] : 1.f;
+    for (int64_t j = 0; j < ddim; j++) {
+      output_base[j * output_stride1] +=
+          static_cast<float>(src_base[j * src_stride1]) * scale;
+    }
+  }
 }
 
 // This function combines index_select (using select_indices as the index) and
@@ -91,22 +269,10 @@ void index_select_add<float>(const Tensor &select_indices,
   auto* output_data = output.data_ptr<float>();
 
   if (isFastPathIndexSelect(src, output)) {
-    int64_t output_size = offsets.numel() - 1;
-    auto* offsets_data = offsets.data_ptr<int64_t>();
+    int64_t output_size = 0;
     std::vector<int64_t> offsets_include_last;
-
-    if (include_last_offset) {
-      output_size = offsets.numel() - 1;
-    } else {
-      output_size = offsets.numel();
-      offsets_include_last.resize(offsets.numel() + 1);
-      std::memcpy(
-          offsets_include_last.data(),
-          offsets.data_ptr<int64_t>(),
-          sizeof(int64_t) * offsets.numel());
-      offsets_include_last[offsets.numel()] = select_indices.numel();
-      offsets_data = offsets_include_last.data();
-    }
+    const int64_t* offsets_data = offsets_with_last(
+        offsets, select_indices, include_last_offset, offsets_include_last, output_size);
 
 #ifdef USE_FBGEMM
     auto kernel_fp32_i64 =
@@ -166,6 +332,38 @@ void index_select_add<float>(const Tensor &select_indices,
   }
 }
 
+template<>
+void index_select_add<at::Half>(const Tensor &select_indices,
+                                const Tensor &add_indices,
+                                const Tensor &src,
+                                Tensor &output,
+                                const Tensor& offsets,
+                                bool include_last_offset) {
+  if (isFastPathIndexSelect(src, output)) {
+    embedding_bag_half_fast_path(
+        select_indices, /*scale_data=*/nullptr, src, output, offsets, include_last_offset);
+    return;
+  }
+  index_select_add_reduced_precision<at::Half>(
+      select_indices, add_indices, /*scale_data=*/nullptr, 0, src, output);
+}
+
+template<>
+void index_select_add<BFloat16>(const Tensor &select_indices,
+                                const Tensor &add_indices,
+                                const Tensor &src,
+                                Tensor &output,
+                                const Tensor& offsets,
+                                bool include_last_offset) {
+  if (isFastPathIndexSelect(src, output)) {
+    embedding_bag_bfloat16_fast_path(
+        select_indices, /*scale_data=*/nullptr, src, output, offsets, include_last_offset);
+    return;
+  }
+  index_select_add_reduced_precision<BFloat16>(
+      select_indices, add_indices, /*scale_data=*/nullptr, 0, src, output);
+}
+
 // This function fuses the following three fns:
 // index_select (using select_indices as the index)
 // mul (scaling by per_sample_weights)
@@ -218,22 +416,10 @@ void index_select_scale_add<float>(const Tensor &select_indices,
   auto* output_data = output.data_ptr<float>();
 
   if (isFastPathIndexSelectScale(src, scale, output)) {
-    int64_t output_size = offsets.numel() - 1;
-    auto* offsets_data = offsets.data_ptr<int64_t>();
+    int64_t output_size = 0;
     std::vector<int64_t> offsets_include_last;
-
-    if (include_last_offset) {
-      output_size = offsets.numel() - 1;
-    } else {
-      output_size = offsets.numel();
-      offsets_include_last.resize(offsets.numel() + 1);
-      std::memcpy(
-          offsets_include_last.data(),
-          offsets.data_ptr<int64_t>(),
-          sizeof(int64_t) * offsets.numel());
-      offsets_include_last[offsets.numel()] = select_indices.numel();
-      offsets_data = offsets_include_last.data();
-    }
+    const int64_t* offsets_data = offsets_with_last(
+        offsets, select_indices, include_last_offset, offsets_include_last, output_size);
 
 #ifdef USE_FBGEMM
     auto kernel_fp32_i64 =
@@ -295,6 +481,44 @@ void index_select_scale_add<float>(const Tensor &select_indices,
   }
 }
 
+// For Half and BFloat16 tables, `scale` has been converted to float by
+// _embedding_bag_cpu_impl.
+template<>
+void index_select_scale_add<at::Half>(const Tensor &select_indices,
+                                      const Tensor &add_indices,
+                                      const Tensor &scale,
+                                      const Tensor &src,
+                                      Tensor &output,
+                                      const Tensor& offsets,
+                                      bool include_last_offset) {
+  auto* scale_data = scale.data_ptr<float>();
+  if (isFastPathIndexSelectScale(src, scale, output)) {
+    embedding_bag_half_fast_path(
+        select_indices, scale_data, src, output, offsets, include_last_offset);
+    return;
+  }
+  index_select_add_reduced_precision<at::Half>(
+      select_indices, add_indices, scale_data, scale.stride(0), src, output);
+}
+
+template<>
+void index_select_scale_add<BFloat16>(const Tensor &select_indices,
+                                      const Tensor &add_indices,
+                                      const Tensor &scale,
+                                      const Tensor &src,
+                                      Tensor &output,
+                                      const Tensor& offsets,
+                                      bool include_last_offset) {
+  auto* scale_data = scale.data_ptr<float>();
+  if (isFastPathIndexSelectScale(src, scale, output)) {
+    embedding_bag_bfloat16_fast_path(
+        select_indices, scale_data, src, output, offsets, include_last_offset);
+    return;
+  }
+  index_select_add_reduced_precision<BFloat16>(
+      select_indices, add_indices, scale_data, scale.stride(0), src, output);
+}
+
 }  // namespace
 
 static at::Tensor make_bag_size(
@@ -388,7 +612,8 @@ std::tuple<Tensor, Tensor, Tensor, Tensor> embedding_bag_cpu_max(
   auto max_indices_stride = max_indices.stride(0);
 
   auto* weight_data = weight.data_ptr<scalar_t>();
-  auto* output_data = output.data_ptr<scalar_t>();
+  using output_t = typename embedding_bag_output<scalar_t>::type;
+  auto* output_data = output.data_ptr<output_t>();
   auto weight_stride0 = weight.stride(0);
   auto weight_stride1 = weight.stride(1);
   auto output_stride = output.stride(0);
@@ -429,7 +654,7 @@ std::tuple<Tensor, Tensor, Tensor, Tensor> _embedding_bag_cpu_impl(
   auto offsets_arg = TensorArg(offsets, "offsets", 1);
   checkScalarType("embedding_bag", offsets_arg, kLong);
   auto weight_arg = TensorArg(weight, "weight", 1);
-  checkScalarTypes("embedding_bag", weight_arg, {kFloat, kDouble});
+  checkScalarTypes("embedding_bag", weight_arg, {kFloat, kDouble, kHalf, kBFloat16});
   int64_t offset_0 = offsets.data_ptr<int64_t>()[0];
   int64_t offset_n = offsets.data_ptr<int64_t>()[offsets.size(0)-1];
   TORCH_CHECK(offset_0 == 0, "offsets[0] has to be 0, i.e., the first sequence "
@@ -439,12 +664,22 @@ std::tuple<Tensor, Tensor, Tensor, Tensor> _embedding_bag_cpu_impl(
                "be greater than input's length ", indices.size(0), " but got offsets[-1] of ",
                offset_n);
 
+  // Half and BFloat16 tables are accumulated in and return float; their
+  // per_sample_weights may be given in either the table's type or float.
+  Tensor per_sample_weights_;
   if (per_sample_weights.defined()) {
     TORCH_CHECK(mode == MODE_SUM,
         "embedding_bag: per_sample_weights only supported with mode='sum'");
     auto per_input_weights_arg = TensorArg(
         per_sample_weights,"per_sample_weights", 1);
-    checkSameType("embedding_bag", weight_arg, per_input_weights_arg);
+    if (isReducedPrecision(weight)) {
+      checkScalarTypes(
+          "embedding_bag", per_input_weights_arg, {weight.scalar_type(), kFloat});
+      per_sample_weights_ = per_sample_weights.to(kFloat);
+    } else {
+      checkSameType("embedding_bag", weight_arg, per_input_weights_arg);
+      per_sample_weights_ = per_sample_weights;
+    }
     TORCH_CHECK(per_sample_weights.dim() == 1);
     TORCH_CHECK(per_sample_weights.numel() == indices.numel());
   }
@@ -468,13 +703,13 @@ std::tuple<Tensor, Tensor, Tensor, Tensor> _embedding_bag_cpu_impl(
   auto output = at::empty(
       {include_last_offset ? offsets.size(0) - 1 : offsets.size(0),
        weight.size(1)},
-      weight.options());
+      isReducedPrecision(weight) ? weight.options().dtype(kFloat) : weight.options());
 
   // To save compute, if we are going to go down the fast path case for the 'sum'
   // mode, we skip calculating offset2bag, since it is not going to be used.
-  auto fast_path_sum = [&weight, &per_sample_weights, &output]() {
-    if (per_sample_weights.defined()) {
-      return isFastPathIndexSelectScale(weight, per_sample_weights, output);
+  auto fast_path_sum = [&weight, &per_sample_weights_, &output]() {
+    if (per_sample_weights_.defined()) {
+      return isFastPathIndexSelectScale(weight, per_sample_weights_, output);
     } else {
       return isFastPathIndexSelect(weight, output);
     }
@@ -501,11 +736,12 @@ std::tuple<Tensor, Tensor, Tensor, Tensor> _embedding_bag_cpu_impl(
   }
 
   if (mode == MODE_MEAN || mode == MODE_SUM) {
-    AT_DISPATCH_FLOATING_TYPES(weight.scalar_type(), "embedding_bag_cpu", [&]() {
-      if (per_sample_weights.defined()) {
+    AT_DISPATCH_FLOATING_TYPES_AND2(
+      at::ScalarType::Half, at::ScalarType::BFloat16, weight.scalar_type(), "embedding_bag_cpu", [&]() {
+      if (per_sample_weights_.defined()) {
         AT_ASSERT(mode == MODE_SUM);
         index_select_scale_add<scalar_t>(
-            indices, offset2bag, per_sample_weights, weight, output, offsets, include_last_offset);
+            indices, offset2bag, per_sample_weights_, weight, output, offsets, include_last_offset);
       } else {
         index_select_add<scalar_t>(indices, offset2bag, weight, output, offsets, include_last_offset);
       }
@@ -517,8 +753,8 @@ std::tuple<Tensor, Tensor, Tensor, Tensor> _embedding_bag_cpu_impl(
     if (per_sample_weights.defined()) {
       maybe_per_sample_weights = per_sample_weights;
     }
-    return AT_DISPATCH_FLOATING_TYPES_AND_HALF(
-      weight.scalar_type(), "embedding_bag_cpu_max", [&]() {
+    return AT_DISPATCH_FLOATING_TYPES_AND2(
+      at::ScalarType::Half, at::ScalarType::BFloat16, weight.scalar_type(), "embedding_bag_cpu_max", [&]() {
         return embedding_bag_cpu_max<scalar_t>(
             weight, indices, offset2bag, output, bag_size, offsets, include_last_offset);
       }
@@ -582,6 +818,27 @@ _embedding_bag_cpu(const Tensor &weight, const Tensor &indices,
       /*requires_grad=*/true);
 }
 
+// The forward skips computing offset2bag on the 'sum' fast path and returns an
+// empty tensor instead (see _embedding_bag_cpu_impl); rebuild it in that case.
+static Tensor backward_offset2bag(
+    const Tensor& offsets,
+    const Tensor& indices,
+    const Tensor& offset2bag) {
+  if (indices.numel() != 0 && offset2bag.numel() == 0) {
+    Tensor offset2bag_ = at::zeros(
+       {indices.sizes()[0] + 1}, indices.options()); // offset2bag = [0 0 0 0 0]
+
+    make_offset2bag(offsets, indices, offset2bag_);
+
+    offset2bag_.resize_({indices.sizes()[0]});
+    return offset2bag_;
+  }
+  auto offset2bag_arg = TensorArg(offset2bag, "offset2bag", 1);
+  checkScalarType("embedding_bag", offset2bag_arg, kLong);
+  checkContiguous("embedding_bag", offset2bag_arg);
+  return offset2bag;
+}
+
 // Assumes all input tensors are contiguous.
 // See NOTE [ embedding_bag Native Functions ] in native_functions.yaml for details
 Tensor _embedding_bag_backward(const Tensor &grad, const Tensor &indices,
@@ -600,20 +857,7 @@ Tensor _embedding_bag_backward(const Tensor &grad, const Tensor &indices,
   checkScalarType("embedding_bag", offsets_arg, kLong);
   checkContiguous("embedding_bag", offsets_arg);
 
-  Tensor offset2bag_;
-  if (indices.numel() != 0 && offset2bag.numel() == 0) {
-    offset2bag_ = at::zeros(
-       {indices.sizes()[0] + 1}, indices.options()); // offset2bag = [0 0 0 0 0]
-
-    make_offset2bag(offsets, indices, offset2bag_);
-
-    offset2bag_.resize_({indices.sizes()[0]});
-  } else {
-    auto offset2bag_arg = TensorArg(offset2bag, "offset2bag", 1);
-    checkScalarType("embedding_bag", offset2bag_arg, kLong);
-    checkContiguous("embedding_bag", offset2bag_arg);
-    offset2bag_ = offset2bag;
-  }
+  Tensor offset2bag_ = backward_offset2bag(offsets, indices, offset2bag);
 
   if (sparse) {
     return at::_embedding_bag_sparse_backward(
@@ -644,120 +888,177 @@ static Tensor _embedding_bag_dense_backward_cpu_max(
   return index_grad_weight;
 }
 
-static std::vector<int64_t> compute_counts(
-    int64_t num_weights,
-    int64_t* indices_data,
-    int64_t indices_length) {
-  std::vector<int64_t> counts(num_weights, 0);
-  for (int i = 0; i < indices_length; i++) {
-    counts[indices_data[i]]++;
-  }
-  return counts;
-}
-
-// counts_uniq stores the index of the NEXT unique element
-// of the (sorted) indices vector.
-//
-// For example:
-// indices: [0, 0, 0, 1, 3, 3, 4]
-// counts: [3, 1, 0, 2, 1, 0]
-// counts_uniq: [3, 4, 6, 7]
-//
-// The unique indices can be found at index 0, 3, 4, 6.
-static std::vector<int64_t> compute_counts_uniq(
-    int64_t num_weights,
-    int64_t* indices_data,
-    int64_t indices_length,
-    const std::vector<int64_t>& counts) {
-  std::vector<int64_t> counts_uniq;
-  counts_uniq.reserve(num_weights);
-  int64_t o = 0;
-  for (int64_t i = 0; i < indices_length; i += counts[indices_data[i]]) {
-    counts_uniq.push_back(counts[indices_data[i]]);
-    if (o > 0) {
-      counts_uniq[o] += counts_uniq[o - 1];
+namespace {
+
+// The positions (into indices and offset2bag) of every occurrence of embedding
+// row sorted_indices[segment_starts[k]] are
+// sorted_positions[segment_starts[k]:segment_starts[k + 1]].
+struct EmbeddingBagSegments {
+  std::vector<int64_t> sorted_indices;
+  std::vector<int64_t> sorted_positions;
+  std::vector<int64_t> segment_starts;
+
+  int64_t num_segments() const {
+    return segment_starts.size() - 1;
+  }
+};
+
+EmbeddingBagSegments segment_indices(const Tensor& indices, int64_t num_weights) {
+  constexpr int64_t kMinChunkSize = 1 << 12;
+  const int64_t numel = indices.numel();
+  auto* indices_data = indices.data_ptr<int64_t>();
+  EmbeddingBagSegments segments;
+  if (numel == 0) {
+    segments.segment_starts = {0};
+    return segments;
+  }
+  const int64_t min_index = indices.min().item<int64_t>();
+  const int64_t max_index = indices.max().item<int64_t>();
+  TORCH_CHECK(
+      min_index >= 0 && max_index < num_weights,
+      "embedding_bag: indices must be in [0, ", num_weights, "), but got ",
+      min_index < 0 ? min_index : max_index);
+
+  std::vector<int64_t> keys(numel), values(numel), tmp_keys(numel), tmp_values(numel);
+  at::parallel_for(0, numel, at::internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+    std::copy(indices_data + begin, indices_data + end, keys.data() + begin);
+    for (int64_t i = begin; i < end; i++) {
+      values[i] = i;
+    }
+  });
+  auto sorted = radix_sort_parallel(
+      keys.data(), values.data(), tmp_keys.data(), tmp_values.data(), numel, max_index);
+  const bool in_place = sorted.first == keys.data();
+  segments.sorted_indices = std::move(in_place ? keys : tmp_keys);
+  segments.sorted_positions = std::move(in_place ? values : tmp_values);
+  const int64_t* sorted_indices = segments.sorted_indices.data();
+
+  // A segment starts wherever the sorted index changes. Count the starts per
+  // chunk, then let each chunk write its own range of segment_starts.
+  const int64_t num_chunks = std::max<int64_t>(
+      1, std::min<int64_t>(at::get_num_threads(), numel / kMinChunkSize));
+  const int64_t chunk_size = divup(numel, num_chunks);
+  std::vector<int64_t> chunk_starts(num_chunks + 1, 0);
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      int64_t count = 0;
+      for (int64_t i = c * chunk_size; i < std::min(numel, (c + 1) * chunk_size); i++) {
+        count += (i == 0 || sorted_indices[i] != sorted_indices[i - 1]);
+      }
+      chunk_starts[c + 1] = count;
     }
-    o++;
+  });
+  for (int64_t c = 0; c < num_chunks; c++) {
+    chunk_starts[c + 1] += chunk_starts[c];
   }
-  return counts_uniq;
+  segments.segment_starts.resize(chunk_starts[num_chunks] + 1);
+  segments.segment_starts[chunk_starts[num_chunks]] = numel;
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      int64_t k = chunk_starts[c];
+      for (int64_t i = c * chunk_size; i < std::min(numel, (c + 1) * chunk_size); i++) {
+        if (i == 0 || sorted_indices[i] != sorted_indices[i - 1]) {
+          segments.segment_starts[k++] = i;
+        }
+      }
+    }
+  });
+  return segments;
 }
 
-template <typename scalar_t>
-void _embedding_bag_dense_backward_cpu_sum_mean(
+// Reduces the gradient of every embedding row referenced by `indices` and
+// calls fn(segment, index, row) with it, each row exactly once, in parallel
+// over rows. The gradient of a row is the sum over its occurrences of the
+// output gradient of the bag the occurrence belongs to, scaled by
+// per_sample_weights, 1 / bag size (mode='mean') and 1 / the number of
+// occurrences (scale_grad_by_freq). `grad` and `per_sample_weights` must be
+// contiguous and of type scalar_t.
+template <typename scalar_t, typename Fn>
+void embedding_bag_backward_rows(
     const Tensor& grad,
-    const Tensor& indices_,
-    const Tensor& offsets_,
-    const Tensor& offset2bag__,
-    int64_t num_weights,
-    bool scale_grad_by_freq,
+    const EmbeddingBagSegments& segments,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const Tensor& offset2bag,
     int64_t mode,
-    const Tensor& per_sample_weights_,
-    Tensor& index_grad_weight) {
-
-  Tensor &offset2bag_ = const_cast<Tensor &>(offset2bag__);
-
-  auto ind_sort_ = indices_.sort();
-  auto indices = std::get<0>(ind_sort_);
-  auto ind_sort = std::get<1>(ind_sort_);
-  auto offset2bag = offset2bag_.index_select(0, ind_sort);
-
-  optional<Tensor> per_sample_weights;
-  scalar_t* per_sample_weights_data;
-  optional<int64_t> per_sample_weights_stride;
-  if (per_sample_weights_.defined()) {
-    per_sample_weights = per_sample_weights_.index_select(0, ind_sort);
-    per_sample_weights_data = per_sample_weights->data_ptr<scalar_t>();
-    per_sample_weights_stride = per_sample_weights->stride(0);
+    bool scale_grad_by_freq,
+    const Tensor& per_sample_weights,
+    const Fn& fn) {
+  const int64_t ddim = grad.size(1);
+  const int64_t numel = indices.numel();
+  const int64_t num_offsets = offsets.size(0);
+  auto* grad_data = grad.data_ptr<scalar_t>();
+  auto* offsets_data = offsets.data_ptr<int64_t>();
+  auto* offset2bag_data = offset2bag.data_ptr<int64_t>();
+  const scalar_t* per_sample_weights_data =
+      per_sample_weights.defined() ? per_sample_weights.data_ptr<scalar_t>() : nullptr;
+  const int64_t* sorted_indices = segments.sorted_indices.data();
+  const int64_t* sorted_positions = segments.sorted_positions.data();
+  const int64_t* segment_starts = segments.segment_starts.data();
+  const int64_t num_segments = segments.num_segments();
+  if (num_segments == 0) {
+    return;
   }
 
-  auto* indices_data = indices.data_ptr<int64_t>();
-  auto* offsets_data = offsets_.data_ptr<int64_t>();
-  auto* offset2bag_data = offset2bag.data_ptr<int64_t>();
-  int64_t numel = indices.numel();
-
-  auto counts = compute_counts(num_weights, indices_data, numel);
-  auto next_unique_index_idx =
-      compute_counts_uniq(num_weights, indices_data, numel, counts);
-
-  auto loop = [&](int64_t start, int64_t end) {
-    for (int64_t i = start; i < end; i++) {
-      int64_t start = i == 0 ? 0 : next_unique_index_idx[i - 1];
-      int64_t index = indices_data[start];
-      for (int64_t j = start; j < next_unique_index_idx[i]; j++) {
-        int64_t source = offset2bag_data[j];
-        double scale = 1.0;
-        if (per_sample_weights) {
-          AT_ASSERT(mode == MODE_SUM);
-          scale = per_sample_weights_data[*per_sample_weights_stride * j];
-        }
+  // Aim for GRAIN_SIZE multiply-adds per task.
+  const int64_t grain_size = std::max<int64_t>(
+      1, at::internal::GRAIN_SIZE / std::max<int64_t>(1, ddim * divup(numel, num_segments)));
+  at::parallel_for(0, num_segments, grain_size, [&](int64_t begin, int64_t end) {
+    std::vector<scalar_t> row(ddim);
+    for (int64_t k = begin; k < end; k++) {
+      std::fill(row.begin(), row.end(), scalar_t(0));
+      const int64_t segment_begin = segment_starts[k];
+      const int64_t segment_end = segment_starts[k + 1];
+      for (int64_t j = segment_begin; j < segment_end; j++) {
+        const int64_t position = sorted_positions[j];
+        const int64_t bag = offset2bag_data[position];
+        scalar_t scale = per_sample_weights_data ? per_sample_weights_data[position] : 1;
         if (scale_grad_by_freq) {
-          scale /= counts[indices_data[i]];
+          scale /= segment_end - segment_begin;
         }
-        if (mode == 1) { // MODE_MEAN
-          if (offsets_.size(0) == 1) {
-            auto bag_size = indices.size(0);
-            scale /= bag_size;
-          } else {
-            if (source == offsets_.size(0) - 1) {
-              scale /= indices.size(0) - offsets_data[offsets_.size(0) - 1];
-            } else {
-              scale /= offsets_data[source + 1] - offsets_data[source];
-            }
-          }
+        if (mode == MODE_MEAN) {
+          const int64_t bag_end =
+              bag == num_offsets - 1 ? numel : offsets_data[bag + 1];
+          scale /= bag_end - offsets_data[bag];
+        }
+        const scalar_t* grad_row = grad_data + ddim * bag;
+        for (int64_t d = 0; d < ddim; d++) {
+          row[d] += scale * grad_row[d];
         }
-        int64_t ddim = grad.size(1);
-        auto igwd = index_grad_weight.data_ptr<scalar_t>();
-        auto gd = grad.data_ptr<scalar_t>();
-        THBlas_axpy<scalar_t>(ddim, (scalar_t)scale, gd + ddim * source, 1,
-                    igwd + ddim * index, 1);
       }
+      fn(k, sorted_indices[segment_begin], row.data());
     }
-  };
-  if (numel > 1000) {
-    at::parallel_for(0, (int64_t)next_unique_index_idx.size(), 0, loop);
-  } else {
-    loop(0, (int64_t)next_unique_index_idx.size());
+  });
+}
+
+} // namespace
+
+template <typename scalar_t>
+void _embedding_bag_dense_backward_cpu_sum_mean(
+    const Tensor& grad,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const Tensor& offset2bag,
+    int64_t num_weights,
+    bool scale_grad_by_freq,
+    int64_t mode,
+    const Tensor& per_sample_weights_,
+    Tensor& index_grad_weight) {
+  Tensor per_sample_weights;
+  if (per_sample_weights_.defined()) {
+    AT_ASSERT(mode == MODE_SUM);
+    // Reduced-precision per_sample_weights of a Half or BFloat16 table are
+    // applied to the float gradient in float.
+    per_sample_weights = per_sample_weights_.to(grad.scalar_type()).contiguous();
   }
+  auto segments = segment_indices(indices, num_weights);
+  const int64_t ddim = grad.size(1);
+  auto* index_grad_weight_data = index_grad_weight.data_ptr<scalar_t>();
+  embedding_bag_backward_rows<scalar_t>(
+      grad, segments, indices, offsets, offset2bag, mode, scale_grad_by_freq,
+      per_sample_weights, [&](int64_t /*segment*/, int64_t index, const scalar_t* row) {
+        std::copy(row, row + ddim, index_grad_weight_data + ddim * index);
+      });
 }
 
 Tensor _embedding_bag_dense_backward_cpu(const Tensor &grad_, const Tensor &indices_,
@@ -792,7 +1093,24 @@ Tensor _embedding_bag_dense_backward_cpu(const Tensor &grad_, const Tensor &indi
   return index_grad_weight;
 }
 
-template<typename scalar_t>
+template <typename scalar_t>
+scalar_t embedding_bag_dot(
+    int64_t n, scalar_t* x, int64_t incx, scalar_t* y, int64_t incy) {
+  return dot_impl<scalar_t>(n, x, incx, y, incy);
+}
+
+// The gradient of a Half or BFloat16 table's output is float.
+template <typename scalar_t, typename weight_t>
+scalar_t embedding_bag_dot(
+    int64_t n, scalar_t* x, int64_t incx, weight_t* y, int64_t incy) {
+  scalar_t sum = 0;
+  for (int64_t i = 0; i < n; i++) {
+    sum += x[i * incx] * static_cast<scalar_t>(y[i * incy]);
+  }
+  return sum;
+}
+
+template<typename weight_t>
 Tensor _embedding_bag_per_sample_weights_backward_cpu_template(
     const Tensor& grad,
     const Tensor& weight,  // NB: embedding table, not per_sample_weights
@@ -819,26 +1137,17 @@ Tensor _embedding_bag_per_sample_weights_backward_cpu_template(
   checkScalarType("embedding_bag", indices_arg, kLong);
   checkContiguous("embedding_bag", indices_arg);
 
-  Tensor offset2bag_;
-  if (indices.numel() != 0 && offset2bag.numel() == 0) {
-    offset2bag_ = at::zeros(
-       {indices.sizes()[0] + 1}, indices.options()); // offset2bag = [0 0 0 0 0]
-
-    make_offset2bag(offsets, indices, offset2bag_);
+  Tensor offset2bag_ = backward_offset2bag(offsets, indices, offset2bag);
 
-    offset2bag_.resize_({indices.sizes()[0]});
-  } else {
-    auto offset2bag_arg = TensorArg(offset2bag, "offset2bag", 1);
-    checkScalarType("embedding_bag", offset2bag_arg, kLong);
-    checkContiguous("embedding_bag", offset2bag_arg);
-    offset2bag_ = offset2bag;
-  }
+  using scalar_t = typename embedding_bag_output<weight_t>::type;
+  auto grad_arg = TensorArg(grad, "grad", 1);
+  checkScalarType("embedding_bag", grad_arg, c10::CppTypeToScalarType<scalar_t>::value);
 
   auto* grad_data = grad.data_ptr<scalar_t>();
   auto grad_stride0 = grad.stride(0);
   auto grad_stride1 = grad.stride(1);
 
-  auto* weight_data = weight.data_ptr<scalar_t>();
+  auto* weight_data = weight.data_ptr<weight_t>();
   auto weight_stride0 = weight.stride(0);
   auto weight_stride1 = weight.stride(1);
 
@@ -854,7 +1163,7 @@ Tensor _embedding_bag_per_sample_weights_backward_cpu_template(
       auto bag_idx = offset2bag_data[sample_idx];
       auto embedding_idx = indices_data[sample_idx];
 
-      output_data[sample_idx] = dot_impl<scalar_t>(
+      output_data[sample_idx] = embedding_bag_dot(
           embedding_features,
           grad_data + grad_stride0 * bag_idx, grad_stride1,
           weight_data + weight_stride0 * embedding_idx, weight_stride1);
@@ -870,14 +1179,51 @@ Tensor _embedding_bag_per_sample_weights_backward_cpu(
     const Tensor& offsets,
     const Tensor& offset2bag,
     int64_t mode) {
-  return AT_DISPATCH_FLOATING_TYPES(
-    grad.scalar_type(), "_embedding_bag_per_sample_weights_backward_cpu", [&]() {
+  return AT_DISPATCH_FLOATING_TYPES_AND2(
+    at::ScalarType::Half, at::ScalarType::BFloat16, weight.scalar_type(),
+    "_embedding_bag_per_sample_weights_backward_cpu", [&]() {
       return _embedding_bag_per_sample_weights_backward_cpu_template<scalar_t>(
           grad, weight, indices, offsets, offset2bag, mode);
     }
   );
 }
 
+// Returns a coalesced sparse gradient with one row per distinct index, reduced
+// in parallel, instead of the uncoalesced one-row-per-index gradient built by
+// embedding_backward.
+static Tensor _embedding_bag_sparse_backward_cpu(
+    const Tensor &grad_, const Tensor &indices, const Tensor &offsets,
+    const Tensor &offset2bag, int64_t num_weights,
+    bool scale_grad_by_freq, int64_t mode, const Tensor& per_sample_weights_) {
+  auto grad = grad_.contiguous();
+  auto grad_arg = TensorArg(grad, "grad_", 1);
+  checkScalarTypes("embedding_bag", grad_arg, {kFloat, kDouble});
+  checkDim("embedding_bag", grad_arg, 2);
+
+  Tensor per_sample_weights;
+  if (per_sample_weights_.defined()) {
+    AT_ASSERT(mode == MODE_SUM);
+    per_sample_weights = per_sample_weights_.to(grad.scalar_type()).contiguous();
+  }
+  auto segments = segment_indices(indices, num_weights);
+  const int64_t ddim = grad.size(1);
+  auto sparse_indices = at::empty({1, segments.num_segments()}, indices.options());
+  auto values = at::empty({segments.num_segments(), ddim}, grad.options());
+
+  AT_DISPATCH_FLOATING_TYPES(grad.scalar_type(), "embedding_bag_sparse_backward_cpu", [&] {
+    auto* sparse_indices_data = sparse_indices.data_ptr<int64_t>();
+    auto* values_data = values.data_ptr<scalar_t>();
+    embedding_bag_backward_rows<scalar_t>(
+        grad, segments, indices, offsets, offset2bag, mode, scale_grad_by_freq,
+        per_sample_weights, [&](int64_t segment, int64_t index, const scalar_t* row) {
+          sparse_indices_data[segment] = index;
+          std::copy(row, row + ddim, values_data + ddim * segment);
+        });
+  });
+  return at::_sparse_coo_tensor_unsafe(
+      sparse_indices, values, {num_weights, ddim})._coalesced_(true);
+}
+
 Tensor _embedding_bag_sparse_backward(
     const Tensor &grad_, const Tensor &indices, const Tensor &offsets,
     const Tensor &offset2bag, const Tensor &bag_size_, int64_t num_weights,
@@ -887,6 +1233,12 @@ Tensor _embedding_bag_sparse_backward(
   // Also see NOTE [ embedding_bag Native Functions ] in native_functions.yaml
   // for more details.
 
+  if (grad_.device().type() == kCPU) {
+    return _embedding_bag_sparse_backward_cpu(
+        grad_, indices, offsets, offset2bag, num_weights, scale_grad_by_freq,
+        mode, per_sample_weights);
+  }
+
   Tensor grad = grad_;
   Tensor index_grad = grad_.index_select(0, offset2bag);
   index_grad = apply_bag_size_backward(offsets, indices, mode, index_grad,
@@ -898,5 +1250,134 @@ Tensor _embedding_bag_sparse_backward(
   return native::embedding_backward(index_grad, indices, num_weights, -1,
                                     scale_grad_by_freq, true);
 }
+
+// Fused backward + optimizer step: applies the update for each row's gradient
+// (reduced as in the sparse backward) directly to `weight`, without
+// materializing the gradient. With `momentum` undefined this is SGD,
+//   w[i] -= lr * g[i],
+// otherwise row-wise Adagrad, which keeps one accumulator per row,
+//   momentum[i] += mean(g[i]^2)
+//   w[i] -= lr * g[i] / (sqrt(momentum[i]) + eps).
+// Every row is updated by exactly one thread, so no synchronization is needed.
+template <typename weight_t>
+static void embedding_bag_sparse_update_cpu(
+    Tensor& weight,
+    const Tensor& momentum,
+    const Tensor& grad_,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const Tensor& offset2bag_,
+    int64_t mode,
+    const Tensor& per_sample_weights_,
+    double lr,
+    double eps) {
+  // The gradient of a Half or BFloat16 table is float.
+  using scalar_t = typename embedding_bag_output<weight_t>::type;
+  auto grad = grad_.contiguous();
+  auto grad_arg = TensorArg(grad, "grad", 1);
+  checkScalarType("embedding_bag", grad_arg, c10::CppTypeToScalarType<scalar_t>::value);
+  checkDim("embedding_bag", grad_arg, 2);
+  TORCH_CHECK(
+      grad.size(1) == weight.size(1),
+      "embedding_bag: expected grad to have ", weight.size(1), " columns, but got ",
+      grad.size(1));
+  scalar_t* momentum_data = nullptr;
+  if (momentum.defined()) {
+    auto momentum_arg = TensorArg(momentum, "momentum", 2);
+    checkScalarType("embedding_bag", momentum_arg, c10::CppTypeToScalarType<scalar_t>::value);
+    checkContiguous("embedding_bag", momentum_arg);
+    TORCH_CHECK(
+        momentum.dim() == 1 && momentum.numel() == weight.size(0),
+        "embedding_bag: expected momentum to hold one value per row of weight (",
+        weight.size(0), "), but got shape ", momentum.sizes());
+    momentum_data = momentum.data_ptr<scalar_t>();
+  }
+
+  Tensor per_sample_weights;
+  if (per_sample_weights_.defined()) {
+    TORCH_CHECK(
+        mode == MODE_SUM,
+        "embedding_bag: per_sample_weights only supported with mode='sum'");
+    per_sample_weights = per_sample_weights_.to(grad.scalar_type()).contiguous();
+  }
+  auto offset2bag = backward_offset2bag(offsets, indices, offset2bag_);
+  auto segments = segment_indices(indices, weight.size(0));
+
+  const int64_t ddim = weight.size(1);
+  auto* weight_data = weight.data_ptr<weight_t>();
+  const int64_t weight_stride0 = weight.stride(0);
+  const int64_t weight_stride1 = weight.stride(1);
+  const scalar_t lr_ = lr;
+  const scalar_t eps_ = eps;
+  embedding_bag_backward_rows<scalar_t>(
+      grad, segments, indices, offsets, offset2bag, mode, /*scale_grad_by_freq=*/false,
+      per_sample_weights, [&](int64_t /*segment*/, int64_t index, const scalar_t* row) {
+        scalar_t step = lr_;
+        if (momentum_data) {
+          scalar_t sum_sq = 0;
+          for (int64_t d = 0; d < ddim; d++) {
+            sum_sq += row[d] * row[d];
+          }
+          momentum_data[index] += sum_sq / ddim;
+          step = lr_ / (std::sqrt(momentum_data[index]) + eps_);
+        }
+        weight_t* weight_row = weight_data + weight_stride0 * index;
+        for (int64_t d = 0; d < ddim; d++) {
+          weight_row[d * weight_stride1] = static_cast<scalar_t>(
+              weight_row[d * weight_stride1]) - step * row[d];
+        }
+      });
+}
+
+static void check_embedding_bag_sparse_update(
+    const Tensor& weight,
+    const Tensor& indices,
+    const Tensor& offsets,
+    int64_t mode) {
+  auto weight_arg = TensorArg(weight, "weight", 1);
+  checkDim("embedding_bag", weight_arg, 2);
+  checkScalarTypes("embedding_bag", weight_arg, {kFloat, kDouble, kHalf, kBFloat16});
+  auto indices_arg = TensorArg(indices, "indices", 3);
+  checkScalarType("embedding_bag", indices_arg, kLong);
+  checkContiguous("embedding_bag", indices_arg);
+  auto offsets_arg = TensorArg(offsets, "offsets", 4);
+  checkScalarType("embedding_bag", offsets_arg, kLong);
+  checkContiguous("embedding_bag", offsets_arg);
+  TORCH_CHECK(
+      mode == MODE_SUM || mode == MODE_MEAN,
+      "embedding_bag: fused sparse updates only support mode='sum' and mode='mean'");
+}
+
+Tensor& _embedding_bag_sparse_sgd_cpu_(
+    Tensor& weight, const Tensor& grad, const Tensor& indices,
+    const Tensor& offsets, const Tensor& offset2bag, int64_t mode,
+    const Tensor& per_sample_weights, double lr) {
+  check_embedding_bag_sparse_update(weight, indices, offsets, mode);
+  AT_DISPATCH_FLOATING_TYPES_AND2(
+    at::ScalarType::Half, at::ScalarType::BFloat16, weight.scalar_type(),
+    "_embedding_bag_sparse_sgd_cpu_", [&]() {
+      embedding_bag_sparse_update_cpu<scalar_t>(
+          weight, /*momentum=*/Tensor(), grad, indices, offsets, offset2bag,
+          mode, per_sample_weights, lr, /*eps=*/0);
+    }
+  );
+  return weight;
+}
+
+Tensor& _embedding_bag_sparse_rowwise_adagrad_cpu_(
+    Tensor& weight, Tensor& momentum, const Tensor& grad, const Tensor& indices,
+    const Tensor& offsets, const Tensor& offset2bag, int64_t mode,
+    const Tensor& per_sample_weights, double lr, double eps) {
+  check_embedding_bag_sparse_update(weight, indices, offsets, mode);
+  AT_DISPATCH_FLOATING_TYPES_AND2(
+    at::ScalarType::Half, at::ScalarType::BFloat16, weight.scalar_type(),
+    "_embedding_bag_sparse_rowwise_adagrad_cpu_", [&]() {
+      embedding_bag_sparse_update_cpu<scalar_t>(
+          weight, momentum, grad, indices, offsets, offset2bag,
+          mode, per_sample_weights, lr, eps);
+    }
+  );
+  return weight;
+}
 }
 } // namespace at::native
@@ -1,14 +1,222 @@
 #include <ATen/ATen.h>
+#include <ATen/native/ForeachUtils.h>
+
 namespace at { namespace native {
 
-std::vector<Tensor> foreach_add_scalar_kernel_fallback(TensorList tensors, Scalar scalar) {
-  TORCH_CHECK(tensors.size() > 0, "Tensor list must have at least one tensor.");
+// The slow path of the foreach ops: the per-tensor op applied to each tensor
+// in turn. It is the CPU implementation, and the CUDA kernels fall back to it
+// for inputs they can't handle (see can_use_fast_route).
+
+#define FOREACH_BINARY_OP_SCALAR(OP)                                                                      \
+void foreach_tensor_##OP##_scalar_kernel_slow_(TensorList tensors, Scalar scalar) {                       \
+  check_foreach_api_restrictions(tensors);                                                                \
+                                                                                                          \
+  for (auto& t: tensors) {                                                                                \
+    t.OP##_(scalar);                                                                                      \
+  }                                                                                                       \
+}                                                                                                         \
+                                                                                                          \
+std::vector<Tensor> foreach_tensor_##OP##_scalar_kernel_slow(TensorList tensors, Scalar scalar) {         \
+  check_foreach_api_restrictions(tensors);                                                                \
+                                                                                                          \
+  std::vector<Tensor> result;                                                                             \
+  result.reserve(tensors.size());                                                                         \
+  for (const auto& t: tensors) {                                                                          \
+    result.emplace_back(t.OP(scalar));                                                                    \
+  }                                                                                                       \
+                                                                                                          \
+  return result;                                                                                          \
+}
+
+#define FOREACH_BINARY_OP_SCALARLIST(OP)                                                                  \
+void foreach_tensor_##OP##_scalarlist_kernel_slow_(TensorList tensors, at::ArrayRef<double> scalars) {    \
+  check_foreach_api_restrictions(tensors, scalars);                                                       \
+                                                                                                          \
+  for (size_t i = 0; i < tensors.size(); i++) {                                                           \
+    tensors[i].OP##_(scalars[i]);                                                                         \
+  }                                                                                                       \
+}                                                                                                         \
+                                                                                                          \
+std::vector<Tensor> foreach_tensor_##OP##_scalarlist_kernel_slow(TensorList tensors, at::ArrayRef<double> scalars) { \
+  check_foreach_api_restrictions(tensors, scalars);                                                       \
+                                                                                                          \
+  std::vector<Tensor> result;                                                                             \
+  result.reserve(tensors.size());                                                                         \
+  for (size_t i = 0; i < tensors.size(); i++) {                                                           \
+    result.emplace_back(tensors[i].OP(scalars[i]));                                                       \
+  }                                                                                                       \
+                                                                                                          \
+  return result;                                                                                          \
+}
+
+#define FOREACH_BINARY_OP_LIST(OP)                                                                        \
+std::vector<Tensor> foreach_tensor_##OP##_list_kernel_slow(TensorList tensors1, TensorList tensors2) {    \
+  check_foreach_api_restrictions(tensors1, tensors2);                                                     \
+                                                                                                          \
+  std::vector<Tensor> result;                                                                             \
+  result.reserve(tensors1.size());                                                                        \
+  for (size_t i = 0; i < tensors1.size(); i++) {                                                          \
+    result.emplace_back(tensors1[i].OP(tensors2[i]));                                                     \
+  }                                                                                                       \
+                                                                                                          \
+  return result;                                                                                          \
+}                                                                                                         \
+                                                                                                          \
+void foreach_tensor_##OP##_list_kernel_slow_(TensorList tensors1, TensorList tensors2) {                  \
+  check_foreach_api_restrictions(tensors1, tensors2);                                                     \
+                                                                                                          \
+  for (size_t i = 0; i < tensors1.size(); i++) {                                                          \
+    tensors1[i].OP##_(tensors2[i]);                                                                       \
+  }                                                                                                       \
+}
+
+#define FOREACH_BINARY_OP_LIST_ALPHA(OP)                                                                  \
+std::vector<Tensor> foreach_tensor_##OP##_list_kernel_slow(TensorList tensors1, TensorList tensors2, Scalar alpha) { \
+  check_foreach_api_restrictions(tensors1, tensors2);                                                     \
+                                                                                                          \
+  std::vector<Tensor> result;                                                                             \
+  result.reserve(tensors1.size());                                                                        \
+  for (size_t i = 0; i < tensors1.size(); i++) {                                                          \
+    result.emplace_back(tensors1[i].OP(tensors2[i], alpha));                                              \
+  }                                                                                                       \
+                                                                                                          \
+  return result;                                                                                          \
+}                                                                                                         \
+                                                                                                          \
+void foreach_tensor_##OP##_list_kernel_slow_(TensorList tensors1, TensorList tensors2, Scalar alpha) {    \
+  check_foreach_api_restrictions(tensors1, tensors2);                                                     \
+                                                                                                          \
+  for (size_t i = 0; i < tensors1.size(); i++) {                                                          \
+    tensors1[i].OP##_(tensors2[i], alpha);                                                                \
+  }                                                                                                       \
+}
+
+#define FOREACH_UNARY_OP(OP)                                                  \
+std::vector<Tensor> foreach_tensor_##OP##_slow(TensorList tensors) {          \
+  check_foreach_api_restrictions(tensors);                                    \
+                                                                              \
+  std::vector<Tensor> result;                                                 \
+  result.reserve(tensors.size());                                             \
+  for (const auto& t : tensors) {                                             \
+    result.emplace_back(t.OP());                                              \
+  }                                                                           \
+                                                                              \
+  return result;                                                              \
+}                                                                             \
+                                                                              \
+void foreach_tensor_##OP##_slow_(TensorList tensors) {                        \
+  check_foreach_api_restrictions(tensors);                                    \
+                                                                              \
+  for (auto& t : tensors) {                                                   \
+    t.OP##_();                                                                \
+  }                                                                           \
+}
+
+#define FOREACH_POINTWISE_OP_SCALAR(OP)                                                                                 \
+std::vector<Tensor> foreach_tensor_##OP##_scalar_slow(TensorList input, TensorList tensors1, TensorList tensors2, Scalar scalar) { \
+  check_foreach_api_restrictions(input, tensors1, tensors2);                                                            \
+                                                                                                                        \
+  std::vector<Tensor> result;                                                                                           \
+  result.reserve(input.size());                                                                                         \
+  for (size_t i = 0; i < input.size(); i++) {                                                                           \
+    result.emplace_back(input[i].OP(tensors1[i], tensors2[i], scalar));                                                 \
+  }                                                                                                                     \
+                                                                                                                        \
+  return result;                                                                                                        \
+}                                                                                                                       \
+                                                                                                                        \
+void foreach_tensor_##OP##_scalar_slow_(TensorList input, TensorList tensors1, TensorList tensors2, Scalar scalar) {   \
+  check_foreach_api_restrictions(input, tensors1, tensors2);                                                            \
+                                                                                                                        \
+  for (size_t i = 0; i < input.size(); i++) {                                                                           \
+    input[i].OP##_(tensors1[i], tensors2[i], scalar);                                                                   \
+  }                                                                                                                     \
+}
+
+#define FOREACH_POINTWISE_OP_SCALARLIST(OP)                                                                             \
+std::vector<Tensor> foreach_tensor_##OP##_scalarlist_slow(TensorList input, TensorList tensors1, TensorList tensors2, at::ArrayRef<double> scalars) { \
+  check_foreach_api_restrictions(input, tensors1, tensors2, scalars);                                                   \
+                                                                                                                        \
+  std::vector<Tensor> result;                                                                                           \
+  result.reserve(input.size());                                                                                         \
+  for (size_t i = 0; i < input.size(); i++) {                                                                           \
+    result.emplace_back(input[i].OP(tensors1[i], tensors2[i], scalars[i]));                                             \
+  }                                                                                                                     \
+                                                                                                                        \
+  return result;                                                                                                        \
+}                                                                                                                       \
+                                                                                                                        \
+void foreach_tensor_##OP##_scalarlist_slow_(TensorList input, TensorList tensors1, TensorList tensors2, at::ArrayRef<double> scalars) { \
+  check_foreach_api_restrictions(input, tensors1, tensors2, scalars);                                                   \
+                                                                                                                        \
+  for (size_t i = 0; i < input.size(); i++) {                                                                           \
+    input[i].OP##_(tensors1[i], tensors2[i], scalars[i]);                                                               \
+  }                                                                                                                     \
+}
+
+FOREACH_BINARY_OP_SCALAR(add);
+FOREACH_BINARY_OP_SCALAR(sub);
+FOREACH_BINARY_OP_SCALAR(mul);
+FOREACH_BINARY_OP_SCALAR(div);
+FOREACH_BINARY_OP_SCALARLIST(add);
+FOREACH_BINARY_OP_SCALARLIST(sub);
+FOREACH_BINARY_OP_SCALARLIST(mul);
+FOREACH_BINARY_OP_SCALARLIST(div);
+FOREACH_BINARY_OP_LIST(mul);
+FOREACH_BINARY_OP_LIST(div);
+FOREACH_BINARY_OP_LIST_ALPHA(add);
+FOREACH_BINARY_OP_LIST_ALPHA(sub);
+FOREACH_UNARY_OP(sqrt);
+FOREACH_UNARY_OP(exp);
+FOREACH_POINTWISE_OP_SCALAR(addcdiv);
+FOREACH_POINTWISE_OP_SCALAR(addcmul);
+FOREACH_POINTWISE_OP_SCALARLIST(addcdiv);
+FOREACH_POINTWISE_OP_SCALARLIST(addcmul);
+
+void foreach_tensor_zero_slow_(TensorList tensors) {
+  check_foreach_api_restrictions(tensors);
+
+  for (auto& t : tensors) {
+    t.zero_();
+  }
+}
+
+std::vector<Tensor> foreach_tensor_norm_slow(TensorList tensors, Scalar ord) {
+  check_foreach_api_restrictions(tensors);
 
   std::vector<Tensor> result;
-  for (int i = 0; i < tensors.size(); i++) {
-    auto temp = tensors[i].add(scalar);
-    result.emplace_back(temp);
+  result.reserve(tensors.size());
+  for (const auto& t : tensors) {
+    result.emplace_back(at::norm(t, ord));
   }
   return result;
 }
+
+// The norm of the norms of the tensors, on the device of the first one.
+Tensor foreach_tensor_total_norm_slow(TensorList tensors, Scalar ord) {
+  check_foreach_api_restrictions(tensors);
+
+  const auto device = tensors[0].device();
+  std::vector<Tensor> norms;
+  norms.reserve(tensors.size());
+  for (const auto& t : tensors) {
+    norms.emplace_back(at::norm(t, ord).to(device));
+  }
+  // the few per-tensor norms are combined in double
+  auto stacked = at::stack(norms);
+  return at::norm(stacked.to(kDouble), ord).to(stacked.scalar_type());
+}
+
+void foreach_tensor_clip_scale_slow_(TensorList tensors, const Tensor& total_norm, double max_norm) {
+  check_foreach_api_restrictions(tensors);
+  TORCH_CHECK(total_norm.numel() == 1, "total_norm must be a 1-element tensor.");
+
+  // the tensors are left alone if the coefficient is at least 1 or NaN
+  auto clip_coef = (total_norm.to(kDouble) + 1e-6).reciprocal_().mul_(max_norm);
+  clip_coef.masked_fill_(clip_coef.lt(1).logical_not_(), 1);
+  for (auto& t : tensors) {
+    t.mul_(clip_coef.to(t.device()));
+  }
+}
+
 }} // namespace at::native
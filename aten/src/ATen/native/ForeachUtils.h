@@ -0,0 +1,102 @@
+#pragma once
+
+#include <ATen/ATen.h>
+
+namespace at {
+namespace native {
+
+// The foreach ops apply an elementwise op to every tensor of a list, or to
+// the corresponding tensors of several lists. The CUDA kernels (see
+// native/cuda/MultiTensorApply.cuh) handle many tensors per launch, but only
+// when all of them can be walked as one flat array each: same dtype and
+// device, strided and non-overlapping and dense, and the same sizes and
+// strides across the lists. Other inputs take the slow path, which calls the
+// per-tensor op for each tensor.
+
+inline void check_foreach_api_restrictions(TensorList tensors) {
+  TORCH_CHECK(tensors.size() > 0, "Tensor list must have at least one tensor.");
+}
+
+inline void check_foreach_api_restrictions(TensorList tensors, ArrayRef<double> scalars) {
+  check_foreach_api_restrictions(tensors);
+  TORCH_CHECK(tensors.size() == scalars.size(),
+              "Tensor list must have same number of elements as scalar list, got ",
+              tensors.size(), " and ", scalars.size());
+}
+
+inline void check_foreach_api_restrictions(TensorList tensors1, TensorList tensors2) {
+  TORCH_CHECK(tensors1.size() > 0, "Tensor list must have at least one tensor.");
+  TORCH_CHECK(tensors2.size() > 0, "Tensor list must have at least one tensor.");
+  TORCH_CHECK(tensors1.size() == tensors2.size(),
+              "Tensor lists must have the same number of tensors, got ",
+              tensors1.size(), " and ", tensors2.size());
+
+  for (size_t i = 0; i < tensors1.size(); i++) {
+    TORCH_CHECK(tensors1[i].sizes() == tensors2[i].sizes(),
+                "Corresponding tensors in lists must have the same size, got ",
+                tensors1[i].sizes(), " and ", tensors2[i].sizes());
+  }
+}
+
+inline void check_foreach_api_restrictions(TensorList tensors1, TensorList tensors2, TensorList tensors3) {
+  check_foreach_api_restrictions(tensors1, tensors2);
+  check_foreach_api_restrictions(tensors1, tensors3);
+}
+
+inline void check_foreach_api_restrictions(TensorList tensors1, TensorList tensors2, TensorList tensors3,
+                                    ArrayRef<double> scalars) {
+  check_foreach_api_restrictions(tensors1, tensors2, tensors3);
+  check_foreach_api_restrictions(tensors1, scalars);
+}
+
+// Whether the tensors of all lists can be processed by one multi-tensor
+// kernel. An op whose result is of another dtype than its inputs (integer
+// division, sqrt of integers, bool arithmetic) takes the slow path, which
+// promotes like the per-tensor op.
+inline bool can_use_fast_route(ArrayRef<TensorList> tensor_lists, bool floating_point_result = false) {
+  const auto& first = tensor_lists[0][0];
+  const auto expected_dtype = first.scalar_type();
+  const auto expected_device = first.device();
+
+  if (expected_dtype == kBool ||
+      (floating_point_result && isIntegralType(expected_dtype, /*includeBool=*/true))) {
+    return false;
+  }
+
+  for (const auto& tensors : tensor_lists) {
+    for (size_t i = 0; i < tensors.size(); i++) {
+      const auto& t = tensors[i];
+      const auto& ref = tensor_lists[0][i];
+      if (t.scalar_type() != expected_dtype ||
+          t.device() != expected_device ||
+          t.layout() != at::kStrided ||
+          !t.is_non_overlapping_and_dense() ||
+          t.sizes() != ref.sizes() ||
+          t.strides() != ref.strides()) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+inline bool can_use_fast_route(TensorList tensors, Scalar scalar, bool floating_point_result = false) {
+  const auto dtype = tensors[0].scalar_type();
+  if ((isIntegralType(dtype, /*includeBool=*/true) && scalar.isFloatingPoint()) ||
+      (!isComplexType(dtype) && scalar.isComplex())) {
+    return false;
+  }
+  return can_use_fast_route({tensors}, floating_point_result);
+}
+
+inline bool can_use_fast_route(TensorList tensors, ArrayRef<double> scalars, bool floating_point_result = false) {
+  // the scalars are doubles, which only combine with floating point tensors
+  // without promotion
+  if (!isFloatingType(tensors[0].scalar_type())) {
+    return false;
+  }
+  return can_use_fast_route({tensors}, floating_point_result);
+}
+
+} // namespace native
+} // namespace at
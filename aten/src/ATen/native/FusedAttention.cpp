@@ -0,0 +1,162 @@
+#include <ATen/native/FusedAttention.h>
+
+#include <ATen/AccumulateType.h>
+#include <ATen/Dispatch.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/Parallel.h>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace at {
+namespace native {
+
+namespace {
+
+// The queries of a task, which go over the keys a block at a time while the
+// block is in cache.
+constexpr int64_t kQueryBlock = 32;
+constexpr int64_t kKeyBlock = 64;
+
+template <typename scalar_t>
+void fused_attention_cpu_kernel(
+    Tensor& output,
+    const Tensor& query,
+    const Tensor& key,
+    const Tensor& value,
+    const Tensor& key_padding_mask,
+    bool causal,
+    double scale) {
+  using acc_t = at::acc_type<scalar_t, /*is_cuda=*/false>;
+  const int64_t B = query.size(0);
+  const int64_t H = query.size(1);
+  const int64_t L = query.size(2);
+  const int64_t D = query.size(3);
+  const int64_t S = key.size(2);
+  const int64_t num_query_blocks = (L + kQueryBlock - 1) / kQueryBlock;
+
+  const scalar_t* q_data = query.data_ptr<scalar_t>();
+  const scalar_t* k_data = key.data_ptr<scalar_t>();
+  const scalar_t* v_data = value.data_ptr<scalar_t>();
+  scalar_t* out_data = output.data_ptr<scalar_t>();
+  const bool* mask_data =
+      key_padding_mask.defined() ? key_padding_mask.data_ptr<bool>() : nullptr;
+  const int64_t mask_stride_b =
+      key_padding_mask.defined() ? key_padding_mask.stride(0) : 0;
+  const int64_t mask_stride_s =
+      key_padding_mask.defined() ? key_padding_mask.stride(1) : 0;
+  const acc_t neg_inf = -std::numeric_limits<acc_t>::infinity();
+
+  at::parallel_for(0, B * H * num_query_blocks, 1, [&](int64_t begin, int64_t end) {
+    // The running maximum and sum of the softmax of each query of a block,
+    // its unnormalized output and the scores of the current block of keys.
+    std::vector<acc_t> running_max(kQueryBlock);
+    std::vector<acc_t> sum(kQueryBlock);
+    std::vector<acc_t> acc(kQueryBlock * D);
+    std::vector<acc_t> scores(kKeyBlock);
+
+    for (int64_t task = begin; task < end; task++) {
+      const int64_t bh = task / num_query_blocks;
+      const int64_t b = bh / H;
+      const int64_t h = bh % H;
+      const int64_t l_begin = (task % num_query_blocks) * kQueryBlock;
+      const int64_t l_end = std::min(l_begin + kQueryBlock, L);
+      const scalar_t* q_bh = q_data + b * query.stride(0) + h * query.stride(1);
+      const scalar_t* k_bh = k_data + b * key.stride(0) + h * key.stride(1);
+      const scalar_t* v_bh = v_data + b * value.stride(0) + h * value.stride(1);
+
+      std::fill(running_max.begin(), running_max.end(), neg_inf);
+      std::fill(sum.begin(), sum.end(), acc_t(0));
+      std::fill(acc.begin(), acc.end(), acc_t(0));
+
+      // The keys after the last query of the block are masked for all of them.
+      const int64_t s_end = causal ? std::min(S, l_end) : S;
+      for (int64_t s_begin = 0; s_begin < s_end; s_begin += kKeyBlock) {
+        const int64_t s_block_end = std::min(s_begin + kKeyBlock, s_end);
+        for (int64_t l = l_begin; l < l_end; l++) {
+          const scalar_t* q_row = q_bh + l * query.stride(2);
+          acc_t block_max = neg_inf;
+          for (int64_t s = s_begin; s < s_block_end; s++) {
+            acc_t score = neg_inf;
+            const bool masked = (causal && s > l) ||
+                (mask_data && mask_data[b * mask_stride_b + s * mask_stride_s]);
+            if (!masked) {
+              const scalar_t* k_row = k_bh + s * key.stride(2);
+              acc_t dot = 0;
+              for (int64_t d = 0; d < D; d++) {
+                dot += static_cast<acc_t>(q_row[d]) * static_cast<acc_t>(k_row[d]);
+              }
+              score = dot * static_cast<acc_t>(scale);
+              block_max = std::max(block_max, score);
+            }
+            scores[s - s_begin] = score;
+          }
+          if (block_max == neg_inf) {
+            continue;
+          }
+
+          const int64_t i = l - l_begin;
+          const acc_t new_max = std::max(running_max[i], block_max);
+          const acc_t correction = std::exp(running_max[i] - new_max);
+          acc_t* acc_row = acc.data() + i * D;
+          sum[i] *= correction;
+          for (int64_t d = 0; d < D; d++) {
+            acc_row[d] *= correction;
+          }
+          for (int64_t s = s_begin; s < s_block_end; s++) {
+            const acc_t score = scores[s - s_begin];
+            if (score == neg_inf) {
+              continue;
+            }
+            const acc_t p = std::exp(score - new_max);
+            sum[i] += p;
+            const scalar_t* v_row = v_bh + s * value.stride(2);
+            for (int64_t d = 0; d < D; d++) {
+              acc_row[d] += p * static_cast<acc_t>(v_row[d]);
+            }
+          }
+          running_max[i] = new_max;
+        }
+      }
+
+      // Queries without any key left get NaNs, as the softmax of -inf scores.
+      for (int64_t l = l_begin; l < l_end; l++) {
+        const int64_t i = l - l_begin;
+        const acc_t* acc_row = acc.data() + i * D;
+        scalar_t* out_row = out_data + (bh * L + l) * D;
+        for (int64_t d = 0; d < D; d++) {
+          out_row[d] = static_cast<scalar_t>(acc_row[d] / sum[i]);
+        }
+      }
+    }
+  });
+}
+
+} // namespace
+
+Tensor fused_attention_cpu(
+    const Tensor& query_,
+    const Tensor& key_,
+    const Tensor& value_,
+    const Tensor& key_padding_mask /* optional */,
+    bool causal,
+    double scale) {
+  check_fused_attention_inputs(query_, key_, value_, key_padding_mask);
+  const auto query = fused_attention_contiguous_rows(query_);
+  const auto key = fused_attention_contiguous_rows(key_);
+  const auto value = fused_attention_contiguous_rows(value_);
+  auto output = at::empty(query.sizes(), query.options());
+  if (output.numel() == 0) {
+    return output;
+  }
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      kBFloat16, query.scalar_type(), "fused_attention_cpu", [&] {
+        fused_attention_cpu_kernel<scalar_t>(
+            output, query, key, value, key_padding_mask, causal, scale);
+      });
+  return output;
+}
+
+} // namespace native
+} // namespace at
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <ATen/ATen.h>
+
+namespace at {
+namespace native {
+
+// _fused_attention computes softmax(scale * query @ key^T + masks) @ value
+// head by head, over blocks of keys with an online softmax: the scores of a
+// query are only kept for the current block of keys, rescaling the partial
+// output each time a block raises their running maximum. The [L, S] matrix of
+// attention weights is never materialized.
+//
+// query:            [B, H, L, D]
+// key, value:       [B, H, S, D]
+// key_padding_mask: [B, S] bool, true for the keys to ignore (optional)
+// causal:           whether query i ignores the keys after key i
+//
+// The innermost dimension of query, key and value must be contiguous, the
+// other ones can have any strides, e.g. those of the transposed projections
+// of MultiheadAttention. The output is contiguous.
+inline void check_fused_attention_inputs(
+    const Tensor& query,
+    const Tensor& key,
+    const Tensor& value,
+    const Tensor& key_padding_mask) {
+  TORCH_CHECK(
+      query.dim() == 4 && key.dim() == 4 && value.dim() == 4,
+      "_fused_attention: expected 4-D query, key and value, but got ",
+      query.dim(), "-D, ", key.dim(), "-D and ", value.dim(), "-D tensors");
+  TORCH_CHECK(
+      key.sizes() == value.sizes(),
+      "_fused_attention: expected key and value of the same shape, but got ",
+      key.sizes(), " and ", value.sizes());
+  TORCH_CHECK(
+      query.size(0) == key.size(0) && query.size(1) == key.size(1) &&
+          query.size(3) == key.size(3),
+      "_fused_attention: expected query of shape [B, H, L, D] and key of ",
+      "shape [B, H, S, D], but got ", query.sizes(), " and ", key.sizes());
+  TORCH_CHECK(
+      query.scalar_type() == key.scalar_type() &&
+          key.scalar_type() == value.scalar_type(),
+      "_fused_attention: expected query, key and value of the same dtype");
+  if (key_padding_mask.defined()) {
+    TORCH_CHECK(
+        key_padding_mask.scalar_type() == kBool,
+        "_fused_attention: expected a bool key_padding_mask, but got ",
+        key_padding_mask.scalar_type());
+    TORCH_CHECK(
+        key_padding_mask.dim() == 2 &&
+            key_padding_mask.size(0) == key.size(0) &&
+            key_padding_mask.size(1) == key.size(2),
+        "_fused_attention: expected key_padding_mask of shape [B, S], but got ",
+        key_padding_mask.sizes());
+  }
+}
+
+// The innermost dimension contiguous, without copying when it already is.
+inline Tensor fused_attention_contiguous_rows(const Tensor& t) {
+  return t.stride(-1) == 1 ? t : t.contiguous();
+}
+
+} // namespace native
+} // namespace at
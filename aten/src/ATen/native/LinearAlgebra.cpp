@@ -375,6 +375,16 @@ Tensor &addmm_cpu_(Tensor& self, const Tensor& mat1, const Tensor& mat2, Scalar
   return addmm_cpu_out(self, self, mat1, mat2, beta, alpha);
 }
 
+Tensor _addmm_activation(const Tensor& self, const Tensor& mat1, const Tensor& mat2, Scalar beta, Scalar alpha, bool use_gelu) {
+  Tensor result = at::addmm(self, mat1, mat2, beta, alpha);
+  return use_gelu ? at::gelu(result) : at::relu_(result);
+}
+
+std::tuple<Tensor, Tensor> _mm_and_bias_grad(const Tensor& grad, const Tensor& mat1) {
+  TORCH_CHECK(grad.dim() == 2 && mat1.dim() == 2, "tensors must be 2-D");
+  return std::make_tuple(at::mm(mat1.t(), grad), grad.sum(0));
+}
+
 Tensor& mm_cpu_out(Tensor & result, const Tensor & self, const Tensor & mat2) {
   TORCH_CHECK(self.dim() == 2, "self must be a matrix");
   TORCH_CHECK(mat2.dim() == 2, "mat2 must be a matrix");
@@ -432,6 +442,10 @@ inline void baddbmm_cpu_kernel(const Tensor& result, const Tensor& self, const T
 }
 
 // This tries to apply some optimizations to bmm/baddbmm:
+// - When the matrices are small and floating point, the batch is split among
+//   the threads and multiplied by the vectorized kernels of
+//   cpublas::gemm_batched_small, which doesn't have the per call overhead of
+//   BLAS.
 // - When the operand size is small, computation are parallelized over the batch
 //   dimension using OMP and naive matrix multiplication is applied.
 // - When the operand size is larger than the threshold, if compiled with MKL, MKL's batch gemm is used.
@@ -482,7 +496,26 @@ static inline Tensor& bmm_out_or_baddbmm_(Tensor& self_or_result, const Tensor&
             || (t.stride(1) == 1 && t.stride(2) >= t.size(1));
   };
 
-  if (contraction_size * res_rows * res_cols < 400) {
+  bool use_small_gemm =
+      (self_or_result.scalar_type() == kFloat ||
+       self_or_result.scalar_type() == kDouble) &&
+      batch1.scalar_type() == self_or_result.scalar_type() &&
+      batch2.scalar_type() == self_or_result.scalar_type() &&
+      res_rows <= cpublas::kSmallGemmMaxSize &&
+      res_cols <= cpublas::kSmallGemmMaxSize &&
+      contraction_size <= cpublas::kSmallGemmMaxSize &&
+      self_or_result.stride(2) == 1;
+
+  if (use_small_gemm) {
+    cpublas::gemm_batched_small_stub(
+        kCPU, self_or_result.scalar_type(), bs,
+        res_rows, res_cols, contraction_size,
+        alpha,
+        batch1.data_ptr(), batch1.stride(0), batch1.stride(1), batch1.stride(2),
+        batch2.data_ptr(), batch2.stride(0), batch2.stride(1), batch2.stride(2),
+        beta,
+        self_or_result.data_ptr(), self_or_result.stride(0), self_or_result.stride(1));
+  } else if (contraction_size * res_rows * res_cols < 400) {
     if (is_bmm_out) {
       AT_DISPATCH_ALL_TYPES_AND_COMPLEX(batch1.scalar_type(), "bmm", [&] {
           baddbmm_cpu_kernel<scalar_t, true>(self_or_result, batch1, batch2, beta, alpha);
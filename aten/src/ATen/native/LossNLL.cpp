@@ -3,6 +3,7 @@
 #include <ATen/Dispatch.h>
 #include <ATen/Parallel.h>
 #include <ATen/TensorUtils.h>
+#include <ATen/native/CrossEntropy.h>
 
 namespace at {
 namespace native {
@@ -323,6 +324,159 @@ void nll_loss_backward_out_cpu_template(
       });
 }
 
+// The classes of a row are visited in chunks small enough to stay in cache
+// between the pass finding the maximum of the chunk and the pass summing its
+// exponentials, so the running sum is only rescaled once per chunk.
+constexpr int64_t kCrossEntropyChunk = 1024;
+
+template <typename scalar_t>
+static void cross_entropy_rows_frame(
+    Tensor& losses,
+    Tensor& logsumexp,
+    const Tensor& input,
+    const Tensor& target,
+    const Tensor& weight,
+    int64_t ignore_index,
+    double label_smoothing) {
+  using acc_t = acc_type<scalar_t, false>;
+  using lse_t = typename std::conditional<
+      std::is_same<scalar_t, double>::value, double, float>::type;
+  const int64_t batch_size = input.size(0);
+  const int64_t n_classes = input.size(1);
+  const scalar_t* input_data = input.data_ptr<scalar_t>();
+  const int64_t* target_data = target.data_ptr<int64_t>();
+  const scalar_t* weight_data = optional_data<scalar_t>(weight);
+  scalar_t* losses_data = losses.data_ptr<scalar_t>();
+  lse_t* logsumexp_data = logsumexp.data_ptr<lse_t>();
+
+  const acc_t smoothing = label_smoothing;
+  acc_t weight_sum = n_classes;
+  if (weight_data != nullptr) {
+    weight_sum = 0;
+    for (int64_t c = 0; c < n_classes; c++) {
+      weight_sum += weight_data[c];
+    }
+  }
+
+  const int64_t grain_size =
+      std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(n_classes, 1));
+  at::parallel_for(0, batch_size, grain_size, [&](int64_t start, int64_t end) {
+    for (int64_t i = start; i < end; i++) {
+      const scalar_t* row = input_data + i * n_classes;
+      acc_t max = -std::numeric_limits<acc_t>::infinity();
+      acc_t sum = 0;
+      acc_t dot = 0;
+      for (int64_t chunk = 0; chunk < n_classes; chunk += kCrossEntropyChunk) {
+        const int64_t chunk_end = std::min(chunk + kCrossEntropyChunk, n_classes);
+        acc_t chunk_max = -std::numeric_limits<acc_t>::infinity();
+        for (int64_t c = chunk; c < chunk_end; c++) {
+          chunk_max = std::max(chunk_max, static_cast<acc_t>(row[c]));
+        }
+        if (chunk_max > max) {
+          sum *= std::exp(max - chunk_max);
+          max = chunk_max;
+        }
+        for (int64_t c = chunk; c < chunk_end; c++) {
+          sum += std::exp(static_cast<acc_t>(row[c]) - max);
+        }
+        if (smoothing > 0) {
+          for (int64_t c = chunk; c < chunk_end; c++) {
+            const acc_t w = weight_data ? static_cast<acc_t>(weight_data[c]) : acc_t(1);
+            dot += w * static_cast<acc_t>(row[c]);
+          }
+        }
+      }
+      const acc_t lse = max + std::log(sum);
+      logsumexp_data[i] = static_cast<lse_t>(lse);
+
+      const int64_t cur_target = target_data[i];
+      if (cur_target == ignore_index) {
+        losses_data[i] = 0;
+        continue;
+      }
+      TORCH_CHECK_INDEX(
+          cur_target >= 0 && cur_target < n_classes,
+          "Target ",
+          cur_target,
+          " is out of bounds.");
+      const acc_t cur_weight =
+          weight_data ? static_cast<acc_t>(weight_data[cur_target]) : acc_t(1);
+      acc_t loss = (1 - smoothing) * cur_weight * (lse - static_cast<acc_t>(row[cur_target]));
+      if (smoothing > 0) {
+        loss += smoothing / n_classes * (lse * weight_sum - dot);
+      }
+      losses_data[i] = static_cast<scalar_t>(loss);
+    }
+  });
+}
+
+template <typename scalar_t>
+static void cross_entropy_rows_backward_frame(
+    Tensor& grad_input,
+    const Tensor& grad_losses,
+    const Tensor& input,
+    const Tensor& target,
+    const Tensor& weight,
+    int64_t ignore_index,
+    double label_smoothing,
+    const Tensor& logsumexp) {
+  using acc_t = acc_type<scalar_t, false>;
+  using lse_t = typename std::conditional<
+      std::is_same<scalar_t, double>::value, double, float>::type;
+  const int64_t batch_size = input.size(0);
+  const int64_t n_classes = input.size(1);
+  const scalar_t* input_data = input.data_ptr<scalar_t>();
+  const scalar_t* grad_losses_data = grad_losses.data_ptr<scalar_t>();
+  const int64_t* target_data = target.data_ptr<int64_t>();
+  const scalar_t* weight_data = optional_data<scalar_t>(weight);
+  const lse_t* logsumexp_data = logsumexp.data_ptr<lse_t>();
+  scalar_t* grad_input_data = grad_input.data_ptr<scalar_t>();
+
+  const acc_t smoothing = label_smoothing;
+  const acc_t uniform = smoothing / std::max<int64_t>(n_classes, 1);
+  acc_t weight_sum = n_classes;
+  if (weight_data != nullptr) {
+    weight_sum = 0;
+    for (int64_t c = 0; c < n_classes; c++) {
+      weight_sum += weight_data[c];
+    }
+  }
+
+  const int64_t grain_size =
+      std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(n_classes, 1));
+  at::parallel_for(0, batch_size, grain_size, [&](int64_t start, int64_t end) {
+    for (int64_t i = start; i < end; i++) {
+      const scalar_t* row = input_data + i * n_classes;
+      scalar_t* grad_row = grad_input_data + i * n_classes;
+      const int64_t cur_target = target_data[i];
+      if (cur_target == ignore_index) {
+        std::fill(grad_row, grad_row + n_classes, scalar_t(0));
+        continue;
+      }
+      TORCH_CHECK_INDEX(
+          cur_target >= 0 && cur_target < n_classes,
+          "Target ",
+          cur_target,
+          " is out of bounds.");
+      // d loss / d x_c = p_c * coef - (1 - smoothing) * w_t * [c == t]
+      //                  - smoothing / C * w_c
+      const acc_t grad = grad_losses_data[i];
+      const acc_t lse = logsumexp_data[i];
+      const acc_t cur_weight =
+          weight_data ? static_cast<acc_t>(weight_data[cur_target]) : acc_t(1);
+      const acc_t coef = (1 - smoothing) * cur_weight + uniform * weight_sum;
+      for (int64_t c = 0; c < n_classes; c++) {
+        const acc_t w = weight_data ? static_cast<acc_t>(weight_data[c]) : acc_t(1);
+        acc_t grad_c = std::exp(static_cast<acc_t>(row[c]) - lse) * coef - uniform * w;
+        if (c == cur_target) {
+          grad_c -= (1 - smoothing) * cur_weight;
+        }
+        grad_row[c] = static_cast<scalar_t>(grad * grad_c);
+      }
+    }
+  });
+}
+
 } // namespace
 
 std::tuple<Tensor&, Tensor&> nll_loss_forward_out_cpu(
@@ -402,6 +556,116 @@ Tensor nll_loss(const Tensor & self, const Tensor & target, const Tensor & weigh
   return std::get<0>(at::nll_loss_forward(self, target, weight, reduction, ignore_index));
 }
 
+std::tuple<Tensor, Tensor> cross_entropy_rows_cpu(
+    const Tensor& self,
+    const Tensor& target,
+    const Tensor& weight,
+    int64_t ignore_index,
+    double label_smoothing) {
+  cross_entropy_rows_check_inputs(self, target, weight);
+  auto input = self.contiguous();
+  auto target_contiguous = target.contiguous();
+  auto weight_contiguous = optional_contiguous(weight);
+  auto losses = at::empty({input.size(0)}, input.options());
+  auto logsumexp = at::empty(
+      {input.size(0)},
+      input.options().dtype(cross_entropy_logsumexp_type(input.scalar_type())));
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      ScalarType::BFloat16, input.scalar_type(), "cross_entropy_rows_cpu", [&] {
+        cross_entropy_rows_frame<scalar_t>(
+            losses,
+            logsumexp,
+            input,
+            target_contiguous,
+            weight_contiguous,
+            ignore_index,
+            label_smoothing);
+      });
+  return std::make_tuple(losses, logsumexp);
+}
+
+Tensor cross_entropy_rows_backward_cpu(
+    const Tensor& grad_losses,
+    const Tensor& self,
+    const Tensor& target,
+    const Tensor& weight,
+    int64_t ignore_index,
+    double label_smoothing,
+    const Tensor& logsumexp) {
+  cross_entropy_rows_check_inputs(self, target, weight);
+  auto input = self.contiguous();
+  auto grad_input = at::empty_like(input, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  auto grad_losses_contiguous = grad_losses.contiguous();
+  auto target_contiguous = target.contiguous();
+  auto weight_contiguous = optional_contiguous(weight);
+  auto logsumexp_contiguous = logsumexp.contiguous();
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      ScalarType::BFloat16, input.scalar_type(), "cross_entropy_rows_backward_cpu", [&] {
+        cross_entropy_rows_backward_frame<scalar_t>(
+            grad_input,
+            grad_losses_contiguous,
+            input,
+            target_contiguous,
+            weight_contiguous,
+            ignore_index,
+            label_smoothing,
+            logsumexp_contiguous);
+      });
+  return grad_input;
+}
+
+// Cross entropy of the logits `self` over the classes of dimension 1, without
+// materializing the log-probabilities: each row is reduced to its loss and
+// logsumexp by _cross_entropy_rows, and the gradient is computed from them
+// directly in backward.
+Tensor cross_entropy_loss(
+    const Tensor& self,
+    const Tensor& target,
+    const Tensor& weight,
+    int64_t reduction,
+    int64_t ignore_index,
+    double label_smoothing) {
+  TORCH_CHECK(
+      self.dim() >= 2, "cross_entropy_loss: expected input with at least 2 dimensions, got ", self.dim());
+  TORCH_CHECK(
+      label_smoothing >= 0 && label_smoothing <= 1,
+      "cross_entropy_loss: label_smoothing must be between 0.0 and 1.0, got ", label_smoothing);
+  auto target_sizes = self.sizes().vec();
+  target_sizes.erase(target_sizes.begin() + 1);
+  TORCH_CHECK(
+      target.sizes() == IntArrayRef(target_sizes),
+      "cross_entropy_loss: expected a target of size ", target_sizes,
+      " for an input of size ", self.sizes(), ", got ", target.sizes());
+  const int64_t n_classes = self.size(1);
+  // Rows of (N, C, d1, ...) inputs are the classes of every (n, d1, ...).
+  auto input = self.dim() == 2 ? self : self.movedim(1, -1).reshape({target.numel(), n_classes});
+  auto flat_target = target.reshape({-1});
+  auto losses = std::get<0>(at::_cross_entropy_rows(
+      input, flat_target, weight, ignore_index, label_smoothing));
+
+  if (reduction == Reduction::None) {
+    return losses.view(target.sizes());
+  }
+  if (reduction == Reduction::Sum) {
+    return losses.sum();
+  }
+  auto mask = flat_target.ne(ignore_index);
+  Tensor total_weight;
+  if (weight.defined()) {
+    total_weight = weight.index_select(0, flat_target.masked_fill(mask.logical_not(), 0))
+                       .mul(mask)
+                       .sum();
+  } else {
+    total_weight = mask.sum().to(losses.scalar_type());
+  }
+  if (input.numel() != 0) {
+    // like nll_loss, a zero total weight gives a zero loss unless the input is
+    // empty, see #15870
+    total_weight = total_weight.masked_fill(total_weight.eq(0), 1);
+  }
+  return losses.sum().div(total_weight);
+}
+
 
 } // namespace native
 } // namespace at
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <ATen/ATen.h>
+
+namespace at { namespace native {
+
+// Checks the arguments of _masked_softmax, shared by the CPU and CUDA
+// implementations. The softmax is taken over the last dimension of `self`.
+// `mask`, if defined, is either a bool tensor whose true elements are masked
+// out, or a tensor of the dtype of `self` that is added to the scaled input.
+// It has to broadcast to `self` without broadcasting its last dimension.
+inline void masked_softmax_check_inputs(const Tensor& self, const Tensor& mask, double dropout_p) {
+  TORCH_CHECK(self.dim() >= 1, "_masked_softmax: expected an input with at least one dimension");
+  TORCH_CHECK(at::isFloatingType(self.scalar_type()),
+      "_masked_softmax: expected a floating point input, but got ", self.scalar_type());
+  TORCH_CHECK(dropout_p >= 0 && dropout_p < 1,
+      "_masked_softmax: dropout probability has to be in [0, 1), but got ", dropout_p);
+  if (mask.defined()) {
+    TORCH_CHECK(mask.scalar_type() == ScalarType::Bool || mask.scalar_type() == self.scalar_type(),
+        "_masked_softmax: expected a bool mask or an additive mask of the input dtype ",
+        self.scalar_type(), ", but got ", mask.scalar_type());
+    TORCH_CHECK(mask.device() == self.device(),
+        "_masked_softmax: expected the mask on ", self.device(), ", but got ", mask.device());
+    TORCH_CHECK(mask.dim() >= 1 && mask.dim() <= self.dim() && mask.size(-1) == self.size(-1),
+        "_masked_softmax: the mask of shape ", mask.sizes(), " has to match the last dimension of the input ",
+        "of shape ", self.sizes(), " and broadcast to it");
+  }
+}
+
+// Expands `mask` to the shape of `self`, keeping its last dimension
+// contiguous so that every row of the mask is a contiguous run.
+inline Tensor masked_softmax_expand_mask(const Tensor& self, const Tensor& mask) {
+  Tensor m = mask.stride(-1) == 1 ? mask : mask.contiguous();
+  return m.expand(self.sizes());
+}
+
+}}  // namespace at::native
@@ -667,6 +667,19 @@ struct Cell {
       const hidden_type& hidden,
       const cell_params& params,
       bool pre_compute_input = false) const = 0;
+
+  // Applies the cell over all the steps of `inputs` (in reverse if `reverse`),
+  // whose input gates were computed beforehand, in a single kernel, see
+  // Note [Persistent RNN]. Returns false if it cannot.
+  virtual bool apply_sequence(
+      const Tensor& inputs,
+      const hidden_type& hidden,
+      const cell_params& params,
+      bool reverse,
+      Tensor& outputs,
+      hidden_type& final_hidden) const {
+    return false;
+  }
 };
 
 template<typename nonlinearity, typename cell_params>
@@ -682,6 +695,50 @@ struct SimpleCell : Cell<Tensor, cell_params> {
   }
 };
 
+// Whether the fused CPU kernels can update the states of a step from its
+// gates. They do not record anything for autograd.
+bool use_fused_cpu_cell(TensorList tensors) {
+  const auto scalar_type = tensors[0].scalar_type();
+  if (scalar_type != kFloat && scalar_type != kDouble) {
+    return false;
+  }
+  for (const auto& t : tensors) {
+    if (!t.device().is_cpu() || t.layout() != kStrided || t.dim() != 2 ||
+        t.scalar_type() != scalar_type ||
+        (at::GradMode::is_enabled() && t.requires_grad())) {
+      return false;
+    }
+  }
+  return tensors[0].sizes() == tensors[1].sizes();
+}
+
+// The recurrent weights that the persistent kernels read, which only the plain
+// parameters have.
+const Tensor* recurrent_weight(const CellParams& params) {
+  return &params.w_hh;
+}
+
+template <typename cell_params>
+const Tensor* recurrent_weight(const cell_params& params) {
+  return nullptr;
+}
+
+// Whether the persistent kernels can apply a cell over a whole sequence, see
+// Note [Persistent RNN]. They do not record anything for autograd.
+bool use_persistent_rnn(const Tensor& inputs, const Tensor& hx, const Tensor* w_hh) {
+  if (!w_hh || !at::globalContext().persistentRNN() || !inputs.is_cuda() ||
+      inputs.dim() != 3 || hx.dim() != 2) {
+    return false;
+  }
+  const auto scalar_type = inputs.scalar_type();
+  if ((scalar_type != kFloat && scalar_type != kHalf && scalar_type != kDouble) ||
+      hx.scalar_type() != scalar_type || w_hh->scalar_type() != scalar_type) {
+    return false;
+  }
+  return !(at::GradMode::is_enabled() &&
+           (inputs.requires_grad() || hx.requires_grad() || w_hh->requires_grad()));
+}
+
 // TODO: can use inplace ops?
 template <typename cell_params>
 struct LSTMCell : Cell<std::tuple<Tensor, Tensor>, cell_params> {
@@ -696,17 +753,26 @@ struct LSTMCell : Cell<std::tuple<Tensor, Tensor>, cell_params> {
     const auto& cx = std::get<1>(hidden);
 
     if (input.is_cuda()) {
-      TORCH_CHECK(!pre_compute_input);
-      auto igates = params.matmul_ih(input);
-      auto hgates = params.matmul_hh(hx);
-      auto result = at::_thnn_fused_lstm_cell(
-          igates, hgates, cx, params.b_ih(), params.b_hh());
+      // The precomputed input gates already include the input bias, and the
+      // fused cell only adds the biases if both are given.
+      auto result = pre_compute_input
+          ? at::_thnn_fused_lstm_cell(input, params.linear_hh(hx), cx)
+          : at::_thnn_fused_lstm_cell(
+                params.matmul_ih(input), params.matmul_hh(hx), cx,
+                params.b_ih(), params.b_hh());
       // Slice off the workspace argument (it's needed only for AD).
       return std::make_tuple(std::move(std::get<0>(result)), std::move(std::get<1>(result)));
     }
 
-    const auto gates = params.linear_hh(hx).add_(
-        pre_compute_input ? input : params.linear_ih(input));
+    const auto igates = pre_compute_input ? input : params.linear_ih(input);
+    auto hgates = params.linear_hh(hx);
+    if (use_fused_cpu_cell({igates, hgates, cx})) {
+      auto hy = at::empty_like(cx, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+      auto cy = at::empty_like(cx, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+      lstm_cell_cpu_stub(kCPU, hy, cy, igates, hgates, cx);
+      return std::make_tuple(std::move(hy), std::move(cy));
+    }
+    const auto gates = hgates.add_(igates);
     auto chunked_gates = gates.unsafe_chunk(4, 1);
     auto ingate = chunked_gates[0].sigmoid_();
     auto forgetgate = chunked_gates[1].sigmoid_();
@@ -717,6 +783,24 @@ struct LSTMCell : Cell<std::tuple<Tensor, Tensor>, cell_params> {
     return std::make_tuple(std::move(hy), std::move(cy));
   }
 
+  bool apply_sequence(
+      const Tensor& inputs,
+      const hidden_type& hidden,
+      const cell_params& params,
+      bool reverse,
+      Tensor& outputs,
+      hidden_type& final_hidden) const override {
+    const auto& hx = std::get<0>(hidden);
+    const auto& cx = std::get<1>(hidden);
+    const Tensor* w_hh = recurrent_weight(params);
+    if (!use_persistent_rnn(inputs, hx, w_hh) || cx.requires_grad()) {
+      return false;
+    }
+    auto result = at::_thnn_persistent_lstm(inputs, hx, cx, *w_hh, params.b_hh(), reverse);
+    outputs = std::move(std::get<0>(result));
+    final_hidden = std::make_tuple(std::move(std::get<1>(result)), std::move(std::get<2>(result)));
+    return true;
+  }
 };
 
 template <typename cell_params>
@@ -729,18 +813,24 @@ struct GRUCell : Cell<Tensor, cell_params> {
       const cell_params& params,
       bool pre_compute_input = false) const override {
     if (input.is_cuda()) {
-      TORCH_CHECK(!pre_compute_input);
-      auto igates = params.matmul_ih(input);
-      auto hgates = params.matmul_hh(hidden);
-      auto result = at::_thnn_fused_gru_cell(
-          igates, hgates, hidden, params.b_ih(), params.b_hh());
+      // As for LSTMCell, the precomputed input gates include the input bias.
+      auto result = pre_compute_input
+          ? at::_thnn_fused_gru_cell(input, params.linear_hh(hidden), hidden)
+          : at::_thnn_fused_gru_cell(
+                params.matmul_ih(input), params.matmul_hh(hidden), hidden,
+                params.b_ih(), params.b_hh());
       // Slice off the workspace argument (it's needed only for AD).
       return std::move(std::get<0>(result));
     }
-    const auto chunked_igates = pre_compute_input
-        ? input.unsafe_chunk(3, 1)
-        : params.linear_ih(input).unsafe_chunk(3, 1);
-    auto chunked_hgates = params.linear_hh(hidden).unsafe_chunk(3, 1);
+    const auto igates = pre_compute_input ? input : params.linear_ih(input);
+    auto hgates = params.linear_hh(hidden);
+    if (use_fused_cpu_cell({igates, hgates, hidden})) {
+      auto hy = at::empty_like(hidden, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+      gru_cell_cpu_stub(kCPU, hy, igates, hgates, hidden);
+      return hy;
+    }
+    const auto chunked_igates = igates.unsafe_chunk(3, 1);
+    auto chunked_hgates = hgates.unsafe_chunk(3, 1);
     const auto reset_gate =
         chunked_hgates[0].add_(chunked_igates[0]).sigmoid_();
     const auto input_gate =
@@ -749,6 +839,22 @@ struct GRUCell : Cell<Tensor, cell_params> {
         chunked_igates[2].add(chunked_hgates[2].mul_(reset_gate)).tanh_();
     return (hidden - new_gate).mul_(input_gate).add_(new_gate);
   }
+
+  bool apply_sequence(
+      const Tensor& inputs,
+      const hidden_type& hidden,
+      const cell_params& params,
+      bool reverse,
+      Tensor& outputs,
+      hidden_type& final_hidden) const override {
+    const Tensor* w_hh = recurrent_weight(params);
+    if (!use_persistent_rnn(inputs, hidden, w_hh)) {
+      return false;
+    }
+    std::tie(outputs, final_hidden) =
+        at::_thnn_persistent_gru(inputs, hidden, *w_hh, params.b_hh(), reverse);
+    return true;
+  }
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -803,22 +909,38 @@ struct FullLayer : Layer<Tensor, hidden_type, cell_params> {
     return {step_outputs, hidden};
   }
 
-  output_type operator()(
-      const Tensor& inputs,
+  // Applies the cell over the input gates of every step, computed beforehand
+  // in a single GEMM, in reverse if `reverse`.
+  output_type apply_precomputed(
+      const Tensor& inputs_w,
       const hidden_type& input_hidden,
-      const cell_params& params) const override {
-    if (inputs.device().is_cpu()) {
-      const auto inputs_w = params.linear_ih(inputs);
-      auto unstacked_output =
-          (*this)(inputs_w.unbind(0), input_hidden, params, true);
-      return {at::stack(unstacked_output.outputs, 0),
-              unstacked_output.final_hidden};
+      const cell_params& params,
+      bool reverse = false) const {
+    output_type output;
+    if (cell_.apply_sequence(
+            inputs_w, input_hidden, params, reverse, output.outputs,
+            output.final_hidden)) {
+      return output;
+    }
+    auto step_inputs = inputs_w.unbind(0);
+    if (reverse) {
+      std::reverse(step_inputs.begin(), step_inputs.end());
+    }
+    auto unstacked_output = (*this)(step_inputs, input_hidden, params, true);
+    if (reverse) {
+      std::reverse(unstacked_output.outputs.begin(), unstacked_output.outputs.end());
     }
-    auto unstacked_output = (*this)(inputs.unbind(0), input_hidden, params);
     return {at::stack(unstacked_output.outputs, 0),
             unstacked_output.final_hidden};
   }
 
+  output_type operator()(
+      const Tensor& inputs,
+      const hidden_type& input_hidden,
+      const cell_params& params) const override {
+    return apply_precomputed(params.linear_ih(inputs), input_hidden, params);
+  }
+
   Cell<hidden_type, cell_params>& cell_;
 };
 
@@ -836,41 +958,16 @@ struct FullBidirectionalLayer
       const Tensor& input,
       const hidden_type& input_hidden,
       const param_type& params) const override {
-    std::vector<Tensor> step_inputs;
-    if (input.device().is_cpu()) {
-      auto input_w = params.first.linear_ih(input);
-      step_inputs = input_w.unbind(0);
-      auto fw_result = layer_(
-          step_inputs, input_hidden.first, params.first, true);
-      auto fw_output = at::stack(fw_result.outputs, 0);
-      input_w = params.second.linear_ih(input);
-      step_inputs = input_w.unbind(0);
-      auto rev_step_inputs = reverse(std::move(step_inputs));
-      auto rev_result =
-          layer_(rev_step_inputs, input_hidden.second, params.second, true);
-      std::reverse(rev_result.outputs.begin(), rev_result.outputs.end());
-      auto rev_output = at::stack(rev_result.outputs, 0);
-      return {at::cat({fw_output, rev_output}, fw_output.dim() - 1),
-              std::make_pair(fw_result.final_hidden, rev_result.final_hidden)};
-    }
-
-    step_inputs = input.unbind(0);
-    auto fw_result = layer_(step_inputs, input_hidden.first, params.first);
-    auto fw_output = at::stack(fw_result.outputs, 0);
-    auto rev_step_inputs = reverse(std::move(step_inputs));
-    auto rev_result =
-        layer_(rev_step_inputs, input_hidden.second, params.second);
-    std::reverse(rev_result.outputs.begin(), rev_result.outputs.end());
-    auto rev_output = at::stack(rev_result.outputs, 0);
-    return {at::cat({fw_output, rev_output}, fw_output.dim() - 1),
+    auto fw_result = layer_.apply_precomputed(
+        params.first.linear_ih(input), input_hidden.first, params.first);
+    auto rev_result = layer_.apply_precomputed(
+        params.second.linear_ih(input), input_hidden.second, params.second,
+        /*reverse=*/true);
+    const auto& fw_output = fw_result.outputs;
+    return {at::cat({fw_output, rev_result.outputs}, fw_output.dim() - 1),
             std::make_pair(fw_result.final_hidden, rev_result.final_hidden)};
   }
 
-  std::vector<Tensor> reverse(std::vector<Tensor>&& x) const {
-    std::reverse(x.begin(), x.end());
-    return std::move(x);
-  }
-
   FullLayer<dir_hidden_type, cell_params> layer_;
 };
 
@@ -894,14 +991,8 @@ struct PackedLayer : Layer<PackedSequence, hidden_type, cell_params> {
     int64_t* batch_sizes = input.batch_sizes.data_ptr<int64_t>();
     int64_t last_batch_size = batch_sizes[0];
 
-    const Tensor* input_ptr = &input.data;
-    bool pre_compute_input = false;
-    Tensor input_w;
-    if (input.data.device().is_cpu()) {
-      input_w = params.linear_ih(input.data);
-      input_ptr = &input_w;
-      pre_compute_input = true;
-    }
+    // Compute the input gates of all the steps in a single GEMM.
+    const auto input_w = params.linear_ih(input.data);
 
     // Batch sizes is a sequence of decreasing lengths, which are offsets
     // into a 1D list of inputs. At every step we slice out batch_size elements,
@@ -912,7 +1003,7 @@ struct PackedLayer : Layer<PackedSequence, hidden_type, cell_params> {
     auto hidden = input_hidden;
     for (int64_t i = 0; i < num_steps; ++i) {
       const int64_t batch_size = batch_sizes[i];
-      auto step_input = input_ptr->narrow(0, input_offset, batch_size);
+      auto step_input = input_w.narrow(0, input_offset, batch_size);
       input_offset += batch_size;
       const int64_t dec = last_batch_size - batch_size;
       if (dec > 0) {
@@ -922,7 +1013,7 @@ struct PackedLayer : Layer<PackedSequence, hidden_type, cell_params> {
       }
 
       last_batch_size = batch_size;
-      hidden = cell_(step_input, hidden, params, pre_compute_input);
+      hidden = cell_(step_input, hidden, params, /*pre_compute_input=*/true);
       step_outputs.push_back(hidden_as_output(hidden));
     }
     hiddens.emplace_back(hidden);
@@ -953,14 +1044,8 @@ struct ReversedPackedLayer : Layer<PackedSequence, hidden_type, cell_params> {
     int64_t* batch_sizes = input.batch_sizes.data_ptr<int64_t>();
     int64_t last_batch_size = batch_sizes[num_steps - 1];
 
-    const Tensor* input_ptr = &input.data;
-    bool pre_compute_input = false;
-    Tensor input_w;
-    if (input.data.device().is_cpu()) {
-      input_w = params.linear_ih(input.data);
-      input_ptr = &input_w;
-      pre_compute_input = true;
-    }
+    // Compute the input gates of all the steps in a single GEMM.
+    const auto input_w = params.linear_ih(input.data);
 
     // Here the situation is similar to that above, except we start out with
     // the smallest batch size (and a small set of hidden states we actually use),
@@ -975,10 +1060,10 @@ struct ReversedPackedLayer : Layer<PackedSequence, hidden_type, cell_params> {
             hidden, hidden_slice(input_hidden, last_batch_size, batch_size)});
       }
       auto step_input =
-          input_ptr->narrow(0, input_offset - batch_size, batch_size);
+          input_w.narrow(0, input_offset - batch_size, batch_size);
       input_offset -= batch_size;
       last_batch_size = batch_size;
-      hidden = cell_(step_input, hidden, params, pre_compute_input);
+      hidden = cell_(step_input, hidden, params, /*pre_compute_input=*/true);
       step_outputs.emplace_back(hidden_as_output(hidden));
     }
     std::reverse(step_outputs.begin(), step_outputs.end());
@@ -1383,6 +1468,8 @@ ONE_HIDDEN_RNN(rnn_tanh, tanf_cell_type)
 using relu_cell_type = SimpleCell<relu_f, CellParams>;
 ONE_HIDDEN_RNN(rnn_relu, relu_cell_type);
 
+DEFINE_DISPATCH(lstm_cell_cpu_stub);
+DEFINE_DISPATCH(gru_cell_cpu_stub);
 DEFINE_DISPATCH(lstm_cudnn_stub);
 DEFINE_DISPATCH(lstm_packed_cudnn_stub);
 DEFINE_DISPATCH(lstm_miopen_stub);
@@ -27,6 +27,16 @@ DECLARE_DISPATCH(rnn_packed_fn, rnn_tanh_packed_miopen_stub);
 DECLARE_DISPATCH(rnn_packed_fn, rnn_relu_packed_cudnn_stub);
 DECLARE_DISPATCH(rnn_packed_fn, rnn_relu_packed_miopen_stub);
 
+// The gate nonlinearities and state updates of a step of the LSTM and GRU
+// cells on CPU, fused into one pass over the gates. They take the outputs of
+// the input and hidden linear layers, biases included, and write the new
+// hidden (and cell) state(s).
+using lstm_cell_cpu_fn = void(*)(Tensor& hy, Tensor& cy, const Tensor& igates, const Tensor& hgates, const Tensor& cx);
+using gru_cell_cpu_fn = void(*)(Tensor& hy, const Tensor& igates, const Tensor& hgates, const Tensor& hx);
+
+DECLARE_DISPATCH(lstm_cell_cpu_fn, lstm_cell_cpu_stub);
+DECLARE_DISPATCH(gru_cell_cpu_fn, gru_cell_cpu_stub);
+
 inline void check_device(const Tensor& input, const TensorList& params, const TensorList& hiddens) {
   auto input_device = input.device();
 
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <ATen/Parallel.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace at {
+namespace native {
+
+// Stable LSD radix sort of (key, value) pairs by key, for keys in
+// [0, max_key]. key_t is an unsigned integer type, or int64_t for keys known
+// to be non-negative (e.g. embedding indices). Each pass sorts on the next 8
+// bits, so the number of passes only depends on max_key (e.g. 3 passes for a
+// table of 10M rows), and a pass is skipped when all keys share its digit.
+// Within a pass the input is split into one chunk per thread: every chunk
+// builds its own histogram, a serial prefix sum over (digit, chunk) gives each
+// chunk its output ranges, and the chunks then scatter independently.
+//
+// keys/values and tmp_keys/tmp_values are used as ping-pong buffers; the
+// returned pointers say which of the two holds the sorted result.
+template <typename key_t>
+std::pair<key_t*, int64_t*> radix_sort_parallel(
+    key_t* keys,
+    int64_t* values,
+    key_t* tmp_keys,
+    int64_t* tmp_values,
+    int64_t n,
+    key_t max_key) {
+  constexpr int kDigitBits = 8;
+  constexpr int kNumBuckets = 1 << kDigitBits;
+  constexpr int64_t kMinChunkSize = 1 << 12;
+  static_assert(std::is_integral<key_t>::value, "radix_sort_parallel needs integer keys");
+
+  int num_passes = 0;
+  for (uint64_t k = static_cast<uint64_t>(max_key); k != 0; k >>= kDigitBits) {
+    num_passes++;
+  }
+  if (n <= 1 || num_passes == 0) {
+    return std::make_pair(keys, values);
+  }
+
+  const int64_t num_chunks = std::max<int64_t>(
+      1, std::min<int64_t>(at::get_num_threads(), n / kMinChunkSize));
+  const int64_t chunk_size = divup(n, num_chunks);
+  std::vector<int64_t> offsets(num_chunks * kNumBuckets);
+  auto digit = [](key_t key, int shift) {
+    return (static_cast<uint64_t>(key) >> shift) & (kNumBuckets - 1);
+  };
+
+  for (int pass = 0; pass < num_passes; pass++) {
+    const int shift = pass * kDigitBits;
+    std::fill(offsets.begin(), offsets.end(), 0);
+
+    at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        int64_t* histogram = offsets.data() + c * kNumBuckets;
+        const int64_t chunk_end = std::min(n, (c + 1) * chunk_size);
+        for (int64_t i = c * chunk_size; i < chunk_end; i++) {
+          histogram[digit(keys[i], shift)]++;
+        }
+      }
+    });
+
+    // Exclusive scan in (digit, chunk) order keeps the sort stable.
+    int64_t sum = 0;
+    bool single_bucket = false;
+    for (int d = 0; d < kNumBuckets; d++) {
+      int64_t bucket_begin = sum;
+      for (int64_t c = 0; c < num_chunks; c++) {
+        int64_t count = offsets[c * kNumBuckets + d];
+        offsets[c * kNumBuckets + d] = sum;
+        sum += count;
+      }
+      single_bucket |= sum - bucket_begin == n;
+    }
+    if (single_bucket) {
+      continue;
+    }
+
+    at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        int64_t* offset = offsets.data() + c * kNumBuckets;
+        const int64_t chunk_end = std::min(n, (c + 1) * chunk_size);
+        for (int64_t i = c * chunk_size; i < chunk_end; i++) {
+          int64_t pos = offset[digit(keys[i], shift)]++;
+          tmp_keys[pos] = keys[i];
+          tmp_values[pos] = values[i];
+        }
+      }
+    });
+
+    std::swap(keys, tmp_keys);
+    std::swap(values, tmp_values);
+  }
+  return std::make_pair(keys, values);
+}
+
+}} // namespace at::native
@@ -27,6 +27,7 @@ namespace native {
 DEFINE_DISPATCH(sum_stub);
 DEFINE_DISPATCH(nansum_stub);
 DEFINE_DISPATCH(std_var_stub);
+DEFINE_DISPATCH(multi_reduce_stub);
 DEFINE_DISPATCH(prod_stub);
 DEFINE_DISPATCH(norm_stub);
 DEFINE_DISPATCH(mean_stub);
@@ -865,6 +866,63 @@ std::tuple<Tensor,Tensor> var_mean(const Tensor& self, bool unbiased) {
   return at::native::var_mean_out(result1, result2, self, unbiased);
 }
 
+// Computes the requested subset of sum, sum of squares, min, max and number
+// of elements over `dim` and returns them in that order. The first four come
+// from a single pass over `self`; the count needs no pass at all.
+std::vector<Tensor> _multi_reduce(
+    const Tensor& self, IntArrayRef dim, bool keepdim, bool compute_sum,
+    bool compute_sumsq, bool compute_min, bool compute_max, bool compute_count) {
+  const char* fname = "multi_reduce";
+  TORCH_CHECK(self.device().type() == DeviceType::CPU || self.device().type() == DeviceType::CUDA,
+              fname, " only supports CPU AND CUDA device type, got: ", self.device().type());
+  TORCH_CHECK(self.layout() == Layout::Strided,
+              fname, " only supports strided layout, got: ", self.layout());
+  TORCH_CHECK(at::isFloatingType(self.scalar_type()),
+              fname, " only supports floating-point dtypes, got: ", self.scalar_type());
+
+  int64_t ndim = self.dim();
+  auto mask = make_dim_mask(dim, ndim);
+  int64_t count = 1;
+  for (int64_t d = 0; d < ndim; d++) {
+    if (mask[d]) {
+      count *= self.size(d);
+    }
+  }
+
+  std::vector<Tensor> results;
+  if (compute_sum || compute_sumsq || compute_min || compute_max) {
+    TORCH_CHECK(count > 0 || !(compute_min || compute_max),
+                fname, ": cannot compute min or max over a reduction with no elements");
+    std::vector<Tensor> outputs(4);
+    std::vector<Tensor> viewed_outputs;
+    for (auto& output : outputs) {
+      allocate_reduction_result(output, self, mask, keepdim, self.scalar_type());
+      viewed_outputs.push_back(review_reduce_result(output, ndim, mask, keepdim));
+      namedinference::propagate_names_for_reduction(output, self, dim, keepdim);
+    }
+    auto iter = TensorIterator::reduce_op(viewed_outputs, self);
+    if (iter.numel() == 0) {
+      outputs[0].zero_();
+      outputs[1].zero_();
+    } else {
+      multi_reduce_stub(iter.device_type(), iter);
+    }
+    const bool requested[] = {compute_sum, compute_sumsq, compute_min, compute_max};
+    for (int i = 0; i < 4; i++) {
+      if (requested[i]) {
+        results.push_back(outputs[i]);
+      }
+    }
+  }
+  if (compute_count) {
+    Tensor count_result;
+    allocate_reduction_result(count_result, self, mask, keepdim, kLong);
+    namedinference::propagate_names_for_reduction(count_result, self, dim, keepdim);
+    results.push_back(count_result.fill_(count));
+  }
+  return results;
+}
+
 Tensor var(const Tensor& self, bool unbiased) {
   TORCH_CHECK(self.device().type() == DeviceType::CPU || self.device().type() == DeviceType::CUDA,
               "var only supports CPU AND CUDA device type, got: ", self.device().type());
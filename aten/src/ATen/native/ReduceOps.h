@@ -27,6 +27,10 @@ using reduce_std_var_function =
   void (*)(TensorIterator&, bool unbiased, bool take_sqrt);
 DECLARE_DISPATCH(reduce_std_var_function, std_var_stub);
 
+// Writes the sum, sum of squares, min and max to the four outputs of a
+// reduction iterator in one pass over the input
+DECLARE_DISPATCH(reduce_fn, multi_reduce_stub);
+
 using reduce_norm_fn =
     void (*)(Tensor&, const Tensor&, Scalar, c10::optional<int64_t>);
 DECLARE_DISPATCH(reduce_norm_fn, norm_kernel);
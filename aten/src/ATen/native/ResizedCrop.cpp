@@ -0,0 +1,115 @@
+#include <ATen/ATen.h>
+#include <ATen/AccumulateType.h>
+#include <ATen/Dispatch.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/Parallel.h>
+#include <ATen/native/ResizedCrop.h>
+#include <ATen/native/UpSample.h>
+
+namespace at {
+namespace native {
+namespace {
+
+template <typename scalar_t, typename result_t, typename accscalar_t>
+void resized_crop_flip_normalize_kernel(
+    Tensor& result,
+    const Tensor& params,
+    const Tensor& normalization) {
+  const int64_t num_images = result.size(0);
+  const int64_t channels = result.size(1);
+  const int64_t output_height = result.size(2);
+  const int64_t output_width = result.size(3);
+  auto* result_data = result.data_ptr<result_t>();
+  const auto* params_data = params.data_ptr<int64_t>();
+  const auto* scale = normalization.data_ptr<float>();
+  const auto* offset = scale + channels;
+
+  // Every task resizes rows of the output, of all the channels of an image.
+  at::parallel_for(
+      0,
+      num_images * output_height,
+      at::internal::GRAIN_SIZE / (output_width * channels) + 1,
+      [&](int64_t begin, int64_t end) {
+        for (int64_t row = begin; row < end; ++row) {
+          const int64_t n = row / output_height;
+          const int64_t y = row % output_height;
+          const int64_t* p = params_data + n * CROP_NUM_PARAMS;
+          const auto* image = reinterpret_cast<const scalar_t*>(p[CROP_DATA]);
+          const int64_t height = p[CROP_HEIGHT];
+          const int64_t width = p[CROP_WIDTH];
+
+          const accscalar_t rheight = area_pixel_compute_scale<accscalar_t>(
+              height, output_height, /*align_corners=*/false, c10::nullopt);
+          const accscalar_t rwidth = area_pixel_compute_scale<accscalar_t>(
+              width, output_width, /*align_corners=*/false, c10::nullopt);
+          const accscalar_t h1r = area_pixel_compute_source_index<accscalar_t>(
+              rheight, y, /*align_corners=*/false, /*cubic=*/false);
+          const int64_t h1 = h1r;
+          const int64_t h1p = (h1 < height - 1) ? 1 : 0;
+          const accscalar_t h1lambda = h1r - h1;
+          const accscalar_t h0lambda = static_cast<accscalar_t>(1) - h1lambda;
+          const scalar_t* row0 =
+              image + (p[CROP_TOP] + h1) * p[CROP_STRIDE_H] + p[CROP_LEFT] * p[CROP_STRIDE_W];
+          const scalar_t* row1 = row0 + h1p * p[CROP_STRIDE_H];
+
+          for (int64_t c = 0; c < channels; ++c) {
+            result_t* out = result_data +
+                ((n * channels + c) * output_height + y) * output_width;
+            const int64_t channel = c * p[CROP_STRIDE_C];
+            for (int64_t x = 0; x < output_width; ++x) {
+              // The output is flipped horizontally after the resize.
+              const int64_t w2 = p[CROP_FLIP] ? output_width - 1 - x : x;
+              const accscalar_t w1r = area_pixel_compute_source_index<accscalar_t>(
+                  rwidth, w2, /*align_corners=*/false, /*cubic=*/false);
+              const int64_t w1 = w1r;
+              const int64_t w1p = (w1 < width - 1) ? 1 : 0;
+              const accscalar_t w1lambda = w1r - w1;
+              const accscalar_t w0lambda = static_cast<accscalar_t>(1) - w1lambda;
+              const int64_t i0 = channel + w1 * p[CROP_STRIDE_W];
+              const int64_t i1 = i0 + w1p * p[CROP_STRIDE_W];
+              const accscalar_t val = h0lambda *
+                      (w0lambda * static_cast<accscalar_t>(row0[i0]) +
+                       w1lambda * static_cast<accscalar_t>(row0[i1])) +
+                  h1lambda *
+                      (w0lambda * static_cast<accscalar_t>(row1[i0]) +
+                       w1lambda * static_cast<accscalar_t>(row1[i1]));
+              out[x] = static_cast<result_t>(val * scale[c] + offset[c]);
+            }
+          }
+        }
+      });
+}
+
+} // namespace
+
+Tensor resized_crop_flip_normalize_cpu(
+    TensorList images,
+    const Tensor& boxes,
+    const Tensor& flips,
+    IntArrayRef output_size,
+    ArrayRef<double> mean,
+    ArrayRef<double> std) {
+  auto params = resized_crop_params(images, boxes, flips, output_size, mean, std);
+  const auto& first = images[0];
+  TORCH_CHECK(
+      first.device().is_cpu(),
+      "_resized_crop_flip_normalize: expected CPU images, but got images on ",
+      first.device());
+  const int64_t channels = first.size(0);
+  auto normalization = resized_crop_normalization(channels, mean, std);
+  auto result = at::empty(
+      {static_cast<int64_t>(images.size()), channels, output_size[0], output_size[1]},
+      first.options().dtype(resized_crop_result_type(first.scalar_type())));
+
+  AT_DISPATCH_FLOATING_TYPES_AND2(
+      kByte, kHalf, first.scalar_type(), "resized_crop_flip_normalize_cpu", [&] {
+        using result_t = resized_crop_result_t<scalar_t>;
+        using accscalar_t = at::acc_type<result_t, /*is_cuda=*/false>;
+        resized_crop_flip_normalize_kernel<scalar_t, result_t, accscalar_t>(
+            result, params, normalization);
+      });
+  return result;
+}
+
+} // namespace native
+} // namespace at
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <ATen/ATen.h>
+
+#include <type_traits>
+
+namespace at {
+namespace native {
+
+// The parameters of every image of _resized_crop_flip_normalize, packed in a
+// single tensor of int64 so that they reach the device in a single copy.
+enum ResizedCropParam {
+  CROP_DATA,
+  CROP_STRIDE_C,
+  CROP_STRIDE_H,
+  CROP_STRIDE_W,
+  CROP_TOP,
+  CROP_LEFT,
+  CROP_HEIGHT,
+  CROP_WIDTH,
+  CROP_FLIP,
+  CROP_NUM_PARAMS
+};
+
+// Integral images are resized and normalized in float
+template <typename scalar_t>
+using resized_crop_result_t = typename std::conditional<
+    std::is_integral<scalar_t>::value,
+    float,
+    scalar_t>::type;
+
+static inline ScalarType resized_crop_result_type(ScalarType type) {
+  return isIntegralType(type, /*includeBool=*/false) ? kFloat : type;
+}
+
+// Checks the arguments of _resized_crop_flip_normalize and returns the
+// parameters of the images.
+static inline Tensor resized_crop_params(
+    TensorList images,
+    const Tensor& boxes,
+    const Tensor& flips,
+    IntArrayRef output_size,
+    ArrayRef<double> mean,
+    ArrayRef<double> std) {
+  TORCH_CHECK(!images.empty(), "_resized_crop_flip_normalize: expected at least one image");
+  TORCH_CHECK(
+      output_size.size() == 2 && output_size[0] > 0 && output_size[1] > 0,
+      "_resized_crop_flip_normalize: expected a positive output size of 2 elements, but got ",
+      output_size);
+  const auto& first = images[0];
+  TORCH_CHECK(
+      first.dim() == 3 && first.size(0) > 0,
+      "_resized_crop_flip_normalize: expected images of shape [C, H, W], but got ",
+      first.sizes());
+  TORCH_CHECK(
+      first.scalar_type() == kByte || isFloatingType(first.scalar_type()),
+      "_resized_crop_flip_normalize: expected images of type uint8 or of a floating type, but got ",
+      first.scalar_type());
+  const int64_t channels = first.size(0);
+  TORCH_CHECK(
+      (mean.size() == 1 || mean.size() == channels) &&
+          (std.size() == 1 || std.size() == channels),
+      "_resized_crop_flip_normalize: expected a mean and a standard deviation of 1 or ",
+      channels, " elements, but got ", mean.size(), " and ", std.size());
+  const int64_t num_images = images.size();
+  TORCH_CHECK(
+      boxes.device().is_cpu() && boxes.dim() == 2 &&
+          boxes.size(0) == num_images && boxes.size(1) == 4,
+      "_resized_crop_flip_normalize: expected a CPU tensor of ", num_images,
+      " boxes of shape [", num_images, ", 4], but got ", boxes.sizes());
+  TORCH_CHECK(
+      flips.device().is_cpu() && flips.dim() == 1 && flips.size(0) == num_images,
+      "_resized_crop_flip_normalize: expected a CPU tensor of ", num_images,
+      " flips, but got ", flips.sizes());
+
+  auto params = at::empty({num_images, CROP_NUM_PARAMS}, TensorOptions(kLong));
+  auto params_a = params.accessor<int64_t, 2>();
+  auto boxes_a = boxes.to(kLong).contiguous();
+  auto boxes_data = boxes_a.accessor<int64_t, 2>();
+  auto flips_a = flips.to(kBool).contiguous();
+  auto flips_data = flips_a.accessor<bool, 1>();
+  for (int64_t n = 0; n < num_images; ++n) {
+    const auto& image = images[n];
+    TORCH_CHECK(
+        image.dim() == 3 && image.size(0) == channels &&
+            image.scalar_type() == first.scalar_type() &&
+            image.device() == first.device(),
+        "_resized_crop_flip_normalize: expected all the images to have ",
+        channels, " channels, and the type and device of the first one, but image ",
+        n, " has shape ", image.sizes(), ", type ", image.scalar_type(),
+        " and device ", image.device());
+    const int64_t top = boxes_data[n][0];
+    const int64_t left = boxes_data[n][1];
+    const int64_t height = boxes_data[n][2];
+    const int64_t width = boxes_data[n][3];
+    TORCH_CHECK(
+        top >= 0 && left >= 0 && height > 0 && width > 0 &&
+            top + height <= image.size(1) && left + width <= image.size(2),
+        "_resized_crop_flip_normalize: the box (top ", top, ", left ", left,
+        ", height ", height, ", width ", width, ") of image ", n,
+        " is not within the image of shape ", image.sizes());
+    params_a[n][CROP_DATA] = reinterpret_cast<int64_t>(image.data_ptr());
+    params_a[n][CROP_STRIDE_C] = image.stride(0);
+    params_a[n][CROP_STRIDE_H] = image.stride(1);
+    params_a[n][CROP_STRIDE_W] = image.stride(2);
+    params_a[n][CROP_TOP] = top;
+    params_a[n][CROP_LEFT] = left;
+    params_a[n][CROP_HEIGHT] = height;
+    params_a[n][CROP_WIDTH] = width;
+    params_a[n][CROP_FLIP] = flips_data[n];
+  }
+  return params;
+}
+
+// The normalization of every channel, (x - mean) / std, as the scale (row 0)
+// and the offset (row 1) of x.
+static inline Tensor resized_crop_normalization(
+    int64_t channels,
+    ArrayRef<double> mean,
+    ArrayRef<double> std) {
+  auto normalization = at::empty({2, channels}, TensorOptions(kFloat));
+  auto normalization_a = normalization.accessor<float, 2>();
+  for (int64_t c = 0; c < channels; ++c) {
+    const double channel_std = std.size() == 1 ? std[0] : std[c];
+    TORCH_CHECK(
+        channel_std != 0,
+        "_resized_crop_flip_normalize: the standard deviation of channel ", c, " is zero");
+    normalization_a[0][c] = 1.0 / channel_std;
+    normalization_a[1][c] = -(mean.size() == 1 ? mean[0] : mean[c]) / channel_std;
+  }
+  return normalization;
+}
+
+} // namespace native
+} // namespace at
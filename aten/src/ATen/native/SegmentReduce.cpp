@@ -0,0 +1,262 @@
+#include <ATen/native/SegmentReduce.h>
+
+#include <ATen/ATen.h>
+#include <ATen/AccumulateType.h>
+#include <ATen/Dispatch.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/NumericUtils.h>
+#include <ATen/Parallel.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace at { namespace native {
+
+namespace {
+
+void check_offsets_values_cpu(const char* fn, const Tensor& offsets, int64_t num_rows) {
+  const int64_t* offsets_data = offsets.data_ptr<int64_t>();
+  const int64_t num_segments = offsets.numel() - 1;
+  TORCH_CHECK(offsets_data[0] == 0, fn, ": expected offsets[0] to be 0, but got ", offsets_data[0]);
+  TORCH_CHECK(offsets_data[num_segments] == num_rows,
+      fn, ": expected offsets[-1] to be data.size(0) = ", num_rows, ", but got ", offsets_data[num_segments]);
+  for (int64_t b = 0; b < num_segments; b++) {
+    TORCH_CHECK(offsets_data[b] <= offsets_data[b + 1],
+        fn, ": expected non-decreasing offsets, but got offsets[", b, "] = ", offsets_data[b],
+        " > offsets[", b + 1, "] = ", offsets_data[b + 1]);
+  }
+}
+
+// Number of segments handled per task, so that tasks cover about GRAIN_SIZE
+// elements of data on average.
+int64_t segment_grain_size(int64_t num_segments, int64_t numel) {
+  return std::max<int64_t>(1, at::internal::GRAIN_SIZE * num_segments / std::max<int64_t>(numel, 1));
+}
+
+template <typename scalar_t>
+void segment_reduce_cpu_kernel(
+    const Tensor& data, const Tensor& offsets, SegmentReductionType reduce,
+    Tensor& output, Tensor& arg) {
+  using acc_t = acc_type<scalar_t, /*is_cuda=*/false>;
+  const scalar_t* data_ptr = data.data_ptr<scalar_t>();
+  const int64_t* offsets_ptr = offsets.data_ptr<int64_t>();
+  scalar_t* output_ptr = output.data_ptr<scalar_t>();
+  int64_t* arg_ptr = reduce == SegmentReductionType::MAX ? arg.data_ptr<int64_t>() : nullptr;
+  const int64_t num_segments = offsets.numel() - 1;
+  const int64_t inner_size = segment_inner_size(data);
+
+  at::parallel_for(0, num_segments, segment_grain_size(num_segments, data.numel()), [&](int64_t begin, int64_t end) {
+    std::vector<acc_t> acc(inner_size);
+    for (int64_t b = begin; b < end; b++) {
+      const int64_t start = offsets_ptr[b];
+      const int64_t stop = offsets_ptr[b + 1];
+      scalar_t* out = output_ptr + b * inner_size;
+      if (reduce == SegmentReductionType::MAX) {
+        int64_t* out_arg = arg_ptr + b * inner_size;
+        // Empty segments give 0, with -1 as their index.
+        std::fill(out, out + inner_size, scalar_t(0));
+        std::fill(out_arg, out_arg + inner_size, -1);
+        for (int64_t row = start; row < stop; row++) {
+          const scalar_t* in = data_ptr + row * inner_size;
+          for (int64_t f = 0; f < inner_size; f++) {
+            // NaN propagates; ties keep the first row.
+            if (row == start || (!_isnan(out[f]) && (in[f] > out[f] || _isnan(in[f])))) {
+              out[f] = in[f];
+              out_arg[f] = row;
+            }
+          }
+        }
+        continue;
+      }
+      std::fill(acc.begin(), acc.end(), acc_t(0));
+      for (int64_t row = start; row < stop; row++) {
+        const scalar_t* in = data_ptr + row * inner_size;
+        for (int64_t f = 0; f < inner_size; f++) {
+          acc[f] += static_cast<acc_t>(in[f]);
+        }
+      }
+      // Empty segments give 0 for the mean as well.
+      const acc_t scale = reduce == SegmentReductionType::MEAN && stop > start
+          ? acc_t(1) / static_cast<acc_t>(stop - start) : acc_t(1);
+      for (int64_t f = 0; f < inner_size; f++) {
+        out[f] = static_cast<scalar_t>(acc[f] * scale);
+      }
+    }
+  });
+}
+
+template <typename scalar_t>
+void segment_softmax_cpu_kernel(const Tensor& data, const Tensor& offsets, Tensor& output) {
+  using acc_t = acc_type<scalar_t, /*is_cuda=*/false>;
+  const scalar_t* data_ptr = data.data_ptr<scalar_t>();
+  const int64_t* offsets_ptr = offsets.data_ptr<int64_t>();
+  scalar_t* output_ptr = output.data_ptr<scalar_t>();
+  const int64_t num_segments = offsets.numel() - 1;
+  const int64_t inner_size = segment_inner_size(data);
+
+  at::parallel_for(0, num_segments, segment_grain_size(num_segments, data.numel()), [&](int64_t begin, int64_t end) {
+    std::vector<acc_t> max(inner_size);
+    std::vector<acc_t> sum(inner_size);
+    for (int64_t b = begin; b < end; b++) {
+      const int64_t start = offsets_ptr[b];
+      const int64_t stop = offsets_ptr[b + 1];
+      if (start == stop) {
+        continue;
+      }
+      std::fill(max.begin(), max.end(), -std::numeric_limits<acc_t>::infinity());
+      std::fill(sum.begin(), sum.end(), acc_t(0));
+      for (int64_t row = start; row < stop; row++) {
+        const scalar_t* in = data_ptr + row * inner_size;
+        for (int64_t f = 0; f < inner_size; f++) {
+          max[f] = std::max(max[f], static_cast<acc_t>(in[f]));
+        }
+      }
+      for (int64_t row = start; row < stop; row++) {
+        const scalar_t* in = data_ptr + row * inner_size;
+        scalar_t* out = output_ptr + row * inner_size;
+        for (int64_t f = 0; f < inner_size; f++) {
+          const acc_t e = std::exp(static_cast<acc_t>(in[f]) - max[f]);
+          sum[f] += e;
+          out[f] = static_cast<scalar_t>(e);
+        }
+      }
+      for (int64_t row = start; row < stop; row++) {
+        scalar_t* out = output_ptr + row * inner_size;
+        for (int64_t f = 0; f < inner_size; f++) {
+          out[f] = static_cast<scalar_t>(static_cast<acc_t>(out[f]) / sum[f]);
+        }
+      }
+    }
+  });
+}
+
+// Stable sort of each segment of a 1-D `data`; NaN sorts above everything,
+// like in sort.
+template <typename scalar_t>
+void segment_sort_cpu_kernel(
+    const Tensor& data, const Tensor& offsets, bool descending,
+    Tensor& values, Tensor& indices) {
+  const scalar_t* data_ptr = data.data_ptr<scalar_t>();
+  const int64_t* offsets_ptr = offsets.data_ptr<int64_t>();
+  scalar_t* values_ptr = values.data_ptr<scalar_t>();
+  int64_t* indices_ptr = indices.data_ptr<int64_t>();
+  const int64_t num_segments = offsets.numel() - 1;
+
+  at::parallel_for(0, num_segments, segment_grain_size(num_segments, data.numel()), [&](int64_t begin, int64_t end) {
+    for (int64_t b = begin; b < end; b++) {
+      const int64_t start = offsets_ptr[b];
+      const int64_t stop = offsets_ptr[b + 1];
+      const scalar_t* in = data_ptr + start;
+      int64_t* idx = indices_ptr + start;
+      std::iota(idx, idx + (stop - start), int64_t(0));
+      if (descending) {
+        std::stable_sort(idx, idx + (stop - start), [&](int64_t i, int64_t j) {
+          return (_isnan(in[i]) && !_isnan(in[j])) || in[i] > in[j];
+        });
+      } else {
+        std::stable_sort(idx, idx + (stop - start), [&](int64_t i, int64_t j) {
+          return (!_isnan(in[i]) && _isnan(in[j])) || in[i] < in[j];
+        });
+      }
+      for (int64_t i = 0; i < stop - start; i++) {
+        values_ptr[start + i] = in[idx[i]];
+      }
+    }
+  });
+}
+
+// Index of the segment of every row of a `num_rows` long segmented dimension.
+Tensor segment_ids(const Tensor& offsets, int64_t num_rows) {
+  auto rows = at::arange(num_rows, offsets.options());
+  return at::searchsorted(offsets, rows, /*out_int32=*/false, /*right=*/true).sub_(1);
+}
+
+} // namespace
+
+std::tuple<Tensor, Tensor> segment_reduce_cpu(const Tensor& data_, const Tensor& offsets_, std::string reduce) {
+  segment_check_inputs("segment_reduce", data_, offsets_);
+  const auto reduction = get_segment_reduction_type(reduce);
+  auto data = data_.contiguous();
+  auto offsets = offsets_.contiguous();
+  check_offsets_values_cpu("segment_reduce", offsets, data.size(0));
+
+  auto output = at::empty(segment_output_size(data, offsets), data.options());
+  auto arg = reduction == SegmentReductionType::MAX
+      ? at::empty(output.sizes(), data.options().dtype(kLong))
+      : at::empty({0}, data.options().dtype(kLong));
+  AT_DISPATCH_FLOATING_TYPES_AND2(kHalf, kBFloat16, data.scalar_type(), "segment_reduce_cpu", [&] {
+    segment_reduce_cpu_kernel<scalar_t>(data, offsets, reduction, output, arg);
+  });
+  return std::make_tuple(output, arg);
+}
+
+Tensor segment_softmax_cpu(const Tensor& data_, const Tensor& offsets_) {
+  segment_check_inputs("segment_softmax", data_, offsets_);
+  auto data = data_.contiguous();
+  auto offsets = offsets_.contiguous();
+  check_offsets_values_cpu("segment_softmax", offsets, data.size(0));
+
+  auto output = at::empty_like(data, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  AT_DISPATCH_FLOATING_TYPES_AND2(kHalf, kBFloat16, data.scalar_type(), "segment_softmax_cpu", [&] {
+    segment_softmax_cpu_kernel<scalar_t>(data, offsets, output);
+  });
+  return output;
+}
+
+std::tuple<Tensor, Tensor> segment_sort_cpu(const Tensor& data_, const Tensor& offsets_, bool descending) {
+  segment_check_inputs("segment_sort", data_, offsets_);
+  TORCH_CHECK(data_.dim() == 1, "segment_sort: expected 1-D data, but got data of shape ", data_.sizes());
+  auto data = data_.contiguous();
+  auto offsets = offsets_.contiguous();
+  check_offsets_values_cpu("segment_sort", offsets, data.size(0));
+
+  auto values = at::empty_like(data, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  auto indices = at::empty(data.sizes(), data.options().dtype(kLong));
+  AT_DISPATCH_ALL_TYPES_AND2(kHalf, kBFloat16, data.scalar_type(), "segment_sort_cpu", [&] {
+    segment_sort_cpu_kernel<scalar_t>(data, offsets, descending, values, indices);
+  });
+  return std::make_tuple(values, indices);
+}
+
+Tensor segment_reduce(const Tensor& data, const Tensor& offsets, std::string reduce) {
+  return std::get<0>(at::_segment_reduce(data, offsets, reduce));
+}
+
+Tensor _segment_reduce_backward(
+    const Tensor& grad, const Tensor& data, const Tensor& offsets, const Tensor& arg, std::string reduce) {
+  const auto reduction = get_segment_reduction_type(reduce);
+  const int64_t num_rows = data.size(0);
+  if (num_rows == 0) {
+    return at::zeros_like(data, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  }
+  if (reduction == SegmentReductionType::MAX) {
+    // Empty segments have index -1 and no gradient.
+    auto grad_input = at::zeros_like(data, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+    return grad_input.scatter_add_(0, arg.clamp_min(0), grad * arg.ge(0));
+  }
+  Tensor g = grad;
+  if (reduction == SegmentReductionType::MEAN) {
+    const int64_t num_segments = offsets.numel() - 1;
+    std::vector<int64_t> lengths_size(data.dim(), 1);
+    lengths_size[0] = num_segments;
+    auto lengths = offsets.narrow(0, 1, num_segments) - offsets.narrow(0, 0, num_segments);
+    g = grad / lengths.clamp_min(1).view(lengths_size);
+  }
+  return g.index_select(0, segment_ids(offsets, num_rows));
+}
+
+Tensor _segment_softmax_backward(const Tensor& grad_output, const Tensor& output, const Tensor& offsets) {
+  auto sum = std::get<0>(at::_segment_reduce(grad_output * output, offsets, "sum"));
+  return output * (grad_output - sum.index_select(0, segment_ids(offsets, output.size(0))));
+}
+
+Tensor _segment_sort_backward(const Tensor& grad, const Tensor& indices, const Tensor& offsets) {
+  // indices are relative to the start of their segment.
+  auto starts = offsets.index_select(0, segment_ids(offsets, indices.size(0)));
+  return at::zeros_like(grad, LEGACY_CONTIGUOUS_MEMORY_FORMAT).index_put_({indices + starts}, grad);
+}
+
+}} // namespace at::native
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <ATen/ATen.h>
+
+#include <string>
+
+namespace at { namespace native {
+
+// Segmented ops work on ragged batches stored back to back along the first
+// dimension of `data`: segment `b` is rows [offsets[b], offsets[b + 1]).
+// `offsets` is a 1-D int64 tensor of B + 1 non-decreasing values starting at
+// 0 and ending at data.size(0). The values are validated on CPU only; on CUDA
+// that would need a synchronization, so invalid offsets are clamped instead.
+
+enum class SegmentReductionType { SUM, MEAN, MAX };
+
+inline SegmentReductionType get_segment_reduction_type(const std::string& reduce) {
+  if (reduce == "sum") {
+    return SegmentReductionType::SUM;
+  } else if (reduce == "mean") {
+    return SegmentReductionType::MEAN;
+  } else if (reduce == "max") {
+    return SegmentReductionType::MAX;
+  }
+  TORCH_CHECK(false, "segment_reduce: reduce has to be one of \"sum\", \"mean\" or \"max\", but got \"", reduce, "\"");
+}
+
+inline void segment_check_inputs(const char* fn, const Tensor& data, const Tensor& offsets) {
+  TORCH_CHECK(data.dim() >= 1, fn, ": expected data with at least one dimension");
+  TORCH_CHECK(offsets.dim() == 1 && offsets.numel() >= 1,
+      fn, ": expected 1-D offsets with at least one element, but got offsets of shape ", offsets.sizes());
+  TORCH_CHECK(offsets.scalar_type() == kLong,
+      fn, ": expected int64 offsets, but got ", offsets.scalar_type());
+  TORCH_CHECK(offsets.device() == data.device(),
+      fn, ": expected offsets on ", data.device(), ", but got ", offsets.device());
+}
+
+// Number of elements of one row of `data`, i.e. of everything but the
+// segmented first dimension.
+inline int64_t segment_inner_size(const Tensor& data) {
+  int64_t inner_size = 1;
+  for (int64_t d = 1; d < data.dim(); d++) {
+    inner_size *= data.size(d);
+  }
+  return inner_size;
+}
+
+// Shape of the per-segment results: the first dimension of `data` replaced by
+// the number of segments.
+inline std::vector<int64_t> segment_output_size(const Tensor& data, const Tensor& offsets) {
+  auto sizes = data.sizes().vec();
+  sizes[0] = offsets.numel() - 1;
+  return sizes;
+}
+
+}}  // namespace at::native
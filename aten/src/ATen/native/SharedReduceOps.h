@@ -18,6 +18,7 @@
 #include <cmath>
 #define device_sqrt std::sqrt
 #endif
+#include <limits>
 #if defined(__CUDACC__) || defined(__HIPCC__)
 #define MAX(X, Y) ::max(X,Y)
 #define MIN(X, Y) ::min(X,Y)
@@ -340,6 +341,62 @@ struct NanSumOps {
 #endif
 };
 
+// Sum, sum of squares, min and max of the input in a single pass. The
+// outputs are written in that order. min and max propagate NaN like MinOps
+// and MaxOps.
+template <typename acc_scalar_t>
+struct MultiReduceData {
+  acc_scalar_t sum;
+  acc_scalar_t sumsq;
+  acc_scalar_t min;
+  acc_scalar_t max;
+  C10_HOST_DEVICE MultiReduceData()
+    : sum(0), sumsq(0),
+      min(std::numeric_limits<acc_scalar_t>::infinity()),
+      max(-std::numeric_limits<acc_scalar_t>::infinity()) {}
+  C10_HOST_DEVICE MultiReduceData(acc_scalar_t sum, acc_scalar_t sumsq, acc_scalar_t min, acc_scalar_t max)
+    : sum(sum), sumsq(sumsq), min(min), max(max) {}
+};
+
+template <typename scalar_t, typename acc_scalar_t, typename res_t>
+struct MultiReduceOps {
+  using acc_t = MultiReduceData<acc_scalar_t>;
+
+  static inline C10_DEVICE acc_scalar_t min_or_nan(acc_scalar_t a, acc_scalar_t b) {
+    return (at::_isnan(a) || a < b) ? a : b;
+  }
+
+  static inline C10_DEVICE acc_scalar_t max_or_nan(acc_scalar_t a, acc_scalar_t b) {
+    return (at::_isnan(a) || a > b) ? a : b;
+  }
+
+  inline C10_DEVICE acc_t reduce(acc_t acc, scalar_t data, int64_t /*idx*/) const {
+    acc_scalar_t x = data;
+    return acc_t(acc.sum + x, acc.sumsq + x * x, min_or_nan(acc.min, x), max_or_nan(acc.max, x));
+  }
+
+  inline C10_DEVICE acc_t combine(acc_t a, acc_t b) const {
+    return acc_t(
+        a.sum + b.sum, a.sumsq + b.sumsq, min_or_nan(a.min, b.min), max_or_nan(a.max, b.max));
+  }
+
+  inline C10_DEVICE res_t project(acc_t acc) const {
+    return res_t((scalar_t)acc.sum, (scalar_t)acc.sumsq, (scalar_t)acc.min, (scalar_t)acc.max);
+  }
+
+  static C10_DEVICE acc_t translate_idx(acc_t acc, int64_t /*base_idx*/) {
+    return acc;
+  }
+
+#if defined(__CUDACC__) || defined(__HIPCC__)
+  inline C10_DEVICE acc_t warp_shfl_down(acc_t acc, int offset) const {
+    return acc_t(
+        WARP_SHFL_DOWN(acc.sum, offset), WARP_SHFL_DOWN(acc.sumsq, offset),
+        WARP_SHFL_DOWN(acc.min, offset), WARP_SHFL_DOWN(acc.max, offset));
+  }
+#endif
+};
+
 namespace detail {
 
 template <typename scalar_t>
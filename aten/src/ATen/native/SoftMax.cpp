@@ -5,8 +5,11 @@
 #include <ATen/TensorUtils.h>
 #include <ATen/WrapDimUtils.h>
 #include <ATen/native/cpu/SoftmaxKernel.h>
+#include <ATen/native/MaskedSoftmax.h>
 #include <ATen/NamedTensorUtils.h>
 
+#include <limits>
+
 namespace at {
 namespace native {
 namespace {
@@ -134,9 +137,9 @@ Tensor softmax_cpu(const Tensor& input_, const int64_t dim_, const bool half_to_
   if (input.ndimension() > 0 && dim == input.ndimension() - 1) {
     softmax_lastdim_kernel(kCPU, output, input);
   } else {
-    AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "softmax", [&] {
-      host_softmax<scalar_t, false>(output, input, dim);
-    });
+    AT_DISPATCH_FLOATING_TYPES_AND(
+        at::ScalarType::BFloat16, input.scalar_type(), "softmax",
+        [&] { host_softmax<scalar_t, false>(output, input, dim); });
   }
   return output;
 }
@@ -190,9 +193,10 @@ Tensor softmax_backward_cpu(
   if (grad.ndimension() > 0 && dim == grad.ndimension() - 1) {
     softmax_backward_lastdim_kernel(kCPU, grad_input, grad, output);
   } else {
-    AT_DISPATCH_FLOATING_TYPES(grad.scalar_type(), "softmax_backward", [&] {
-      host_softmax_backward<scalar_t, false>(grad_input, grad, output, dim);
-    });
+    AT_DISPATCH_FLOATING_TYPES_AND(
+        at::ScalarType::BFloat16, grad.scalar_type(), "softmax_backward", [&] {
+          host_softmax_backward<scalar_t, false>(grad_input, grad, output, dim);
+        });
   }
   return grad_input;
 }
@@ -277,6 +281,42 @@ Tensor log_softmax(const Tensor& input_, const int64_t dim_, c10::optional<Scala
   return result;
 }
 
+std::tuple<Tensor, Tensor, Tensor> masked_softmax_cpu(
+    const Tensor& self, const Tensor& mask, double scale, double dropout_p,
+    c10::optional<Generator> gen) {
+  masked_softmax_check_inputs(self, mask, dropout_p);
+  Tensor input = self * scale;
+  if (mask.defined()) {
+    Tensor expanded_mask = masked_softmax_expand_mask(self, mask);
+    if (mask.scalar_type() == ScalarType::Bool) {
+      input = input.masked_fill(expanded_mask, -std::numeric_limits<double>::infinity());
+    } else {
+      input = input + expanded_mask;
+    }
+  }
+  Tensor softmax = at::_softmax(input, -1, false);
+  if (input.numel() > 0) {
+    // rows with every element masked out produce zeros rather than NaNs
+    Tensor fully_masked = std::get<0>(input.max(-1, /*keepdim=*/true)) == -std::numeric_limits<double>::infinity();
+    softmax.masked_fill_(fully_masked, 0);
+  }
+  if (dropout_p == 0) {
+    return std::make_tuple(softmax, at::empty({0}, self.options()), at::empty({0}, self.options().dtype(kByte)));
+  }
+  Tensor dropout_mask = at::empty_like(softmax, LEGACY_CONTIGUOUS_MEMORY_FORMAT).bernoulli_(1 - dropout_p, gen).to(kByte);
+  Tensor output = softmax * dropout_mask * (1. / (1 - dropout_p));
+  return std::make_tuple(output, softmax, dropout_mask);
+}
+
+Tensor masked_softmax_backward_cpu(
+    const Tensor& grad_output, const Tensor& output, const Tensor& softmax,
+    const Tensor& dropout_mask, double scale, double dropout_p) {
+  Tensor y = dropout_p == 0 ? output : softmax;
+  Tensor grad = dropout_p == 0 ? grad_output : grad_output * dropout_mask * (1. / (1 - dropout_p));
+  Tensor grad_y = grad * y;
+  return (grad_y - y * grad_y.sum(-1, /*keepdim=*/true)) * scale;
+}
+
 DEFINE_DISPATCH(softmax_lastdim_kernel);
 DEFINE_DISPATCH(log_softmax_lastdim_kernel);
 DEFINE_DISPATCH(softmax_backward_lastdim_kernel);
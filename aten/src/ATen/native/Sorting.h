@@ -5,8 +5,12 @@
 
 namespace at { namespace native {
 
+// sort_stub sorts `values`, which already holds a copy of the input, in place
+// along `dim` and writes the source positions to `indices`.
+using sort_fn = void(*)(Tensor& values, Tensor& indices, int64_t dim, bool descending);
 using topk_fn = void(*)(Tensor&, Tensor&, const Tensor&, int64_t, int64_t, bool, bool);
 
+DECLARE_DISPATCH(sort_fn, sort_stub);
 DECLARE_DISPATCH(topk_fn, topk_stub);
 
 }} // at::native
@@ -153,6 +153,14 @@ int64_t _cufft_get_plan_cache_size(int64_t device_index) {
   return detail::getCUDAHooks().cuFFTGetPlanCacheSize(device_index);
 }
 
+int64_t _cufft_get_plan_cache_hits(int64_t device_index) {
+  return detail::getCUDAHooks().cuFFTGetPlanCacheHits(device_index);
+}
+
+int64_t _cufft_get_plan_cache_misses(int64_t device_index) {
+  return detail::getCUDAHooks().cuFFTGetPlanCacheMisses(device_index);
+}
+
 void _cufft_clear_plan_cache(int64_t device_index) {
   detail::getCUDAHooks().cuFFTClearPlanCache(device_index);
 }
@@ -372,6 +372,40 @@ Tensor& index_add_cpu_(Tensor & self, int64_t dim, const Tensor & index, const T
     auto self_stride_bytes = self.stride(dim) * elementSize(self.scalar_type());
     auto source_stride_bytes = source.stride(dim) * elementSize(source.scalar_type());
     auto self_dim_size = self.size(dim);
+
+    // When the slices are contiguous, e.g. rows of a matrix for dim == 0,
+    // split the slice elements across threads instead: every thread adds its
+    // range of columns for all indices, so no two threads write the same
+    // element even when indices repeat, and the order of the additions is
+    // the same as in the serial loop.
+    if (selfSlice.is_contiguous() && sourceSlice.is_contiguous() &&
+        selfSlice.sizes() == sourceSlice.sizes() &&
+        (isIntegralType(self.scalar_type(), /*includeBool=*/false) || isFloatingType(self.scalar_type()))) {
+      for (auto i = 0; i < numel; i++) {
+        auto self_i = index_data[i];
+        TORCH_CHECK_INDEX((self_i >= 0) && (self_i < self_dim_size), "index out of range in self");
+      }
+      auto slice_size = selfSlice.numel();
+      AT_DISPATCH_ALL_TYPES_AND2(at::ScalarType::Half, at::ScalarType::BFloat16,
+                                 self.scalar_type(), "index_add_", [&] {
+        auto* self_ptr = selfSlice.data_ptr<scalar_t>();
+        auto* source_ptr = sourceSlice.data_ptr<scalar_t>();
+        auto self_dim_stride = self.stride(dim);
+        auto source_dim_stride = source.stride(dim);
+        auto grain_size = std::max<int64_t>(1, at::internal::GRAIN_SIZE / numel);
+        at::parallel_for(0, slice_size, grain_size, [&](int64_t begin, int64_t end) {
+          for (auto i = 0; i < numel; i++) {
+            scalar_t* self_row = self_ptr + index_data[i] * self_dim_stride;
+            const scalar_t* source_row = source_ptr + i * source_dim_stride;
+            for (int64_t k = begin; k < end; k++) {
+              self_row[k] += source_row[k];
+            }
+          }
+        });
+      });
+      return self;
+    }
+
     auto iter = TensorIterator::binary_op(selfSlice, selfSlice, sourceSlice);
 
     for (auto i = 0; i < numel; i++) {
@@ -434,13 +468,41 @@ Tensor & index_select_out_cpu_(Tensor & result, const Tensor & self, int64_t dim
       return result;
     }
 
+    auto self_dim_size = self.size(dim);
+    for (auto i = 0; i < numel; i++) {
+      auto self_i = index_data[i];
+      TORCH_CHECK_INDEX((self_i >= 0) && (self_i < self_dim_size), "index out of range in self");
+    }
+
+    // Selecting along the innermost dim of contiguous tensors: every slice is
+    // strided, so gather each outer row directly instead of copying one
+    // strided slice per index.
+    if (dim == self.dim() - 1 && self.is_contiguous() && result.is_contiguous()) {
+      auto outer_size = self.numel() / self_dim_size;
+      AT_DISPATCH_ALL_TYPES_AND_COMPLEX_AND3(at::ScalarType::Half, at::ScalarType::Bool, at::ScalarType::BFloat16,
+                                             self.scalar_type(), "index_select", [&] {
+        auto* self_ptr = self.data_ptr<scalar_t>();
+        auto* result_ptr = result.data_ptr<scalar_t>();
+        auto grain_size = std::max<int64_t>(1, at::internal::GRAIN_SIZE / numel);
+        at::parallel_for(0, outer_size, grain_size, [&](int64_t begin, int64_t end) {
+          for (int64_t row = begin; row < end; row++) {
+            const scalar_t* self_row = self_ptr + row * self_dim_size;
+            scalar_t* result_row = result_ptr + row * numel;
+            for (int64_t i = 0; i < numel; i++) {
+              result_row[i] = self_row[index_data[i]];
+            }
+          }
+        });
+      });
+      return result;
+    }
+
     auto selfSlice = self.select(dim, 0);
     auto resultSlice = result.select(dim, 0);
     auto selfSlice_data = selfSlice.data_ptr();
     auto resultSlice_data = resultSlice.data_ptr();
     auto self_stride_bytes = self.stride(dim) * elementSize(self.scalar_type());
     auto result_stride_bytes = result.stride(dim) * elementSize(result.scalar_type());
-    auto self_dim_size = self.size(dim);
     auto slice_size = selfSlice.numel();
 
     auto iter = TensorIteratorConfig()
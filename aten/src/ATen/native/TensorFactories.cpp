@@ -20,6 +20,7 @@
 #include <TH/THAllocator.h>
 #include <ATen/detail/CUDAHooksInterface.h>
 #include <c10/util/Exception.h>
+#include <c10/util/OverheadProbe.h>
 #include <ATen/NamedTensorUtils.h>
 
 #include <algorithm>
@@ -178,6 +179,7 @@ Tensor empty_cpu(IntArrayRef size, const TensorOptions& options_, c10::optional<
   AT_ASSERT(options.device().type() == DeviceType::CPU);
   TORCH_INTERNAL_ASSERT(impl::variable_excluded_from_dispatch());
   check_size_nonnegative(size);
+  C10_OVERHEAD_PROBE(Allocation);
 
   c10::Allocator* allocator;
   if (options.pinned_memory()) {
@@ -293,6 +295,10 @@ Tensor empty_like(
     return result;
   }
 
+  if (options.layout() == kSparseCsr && self.is_sparse_csr()) {
+    return at::empty(self.sizes(), options);
+  }
+
   auto memory_format = options.memory_format_opt().value_or(MemoryFormat::Preserve);
 
   if (self.is_quantized()) {
@@ -1,6 +1,14 @@
 #include <ATen/native/TensorIterator.h>
 
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+#include <ATen/Context.h>
 #include <ATen/ExpandUtils.h>
 #include <ATen/Parallel.h>
 #include <ATen/native/TypeProperties.h>
@@ -564,7 +572,7 @@ void TensorIterator::for_each(loop2d_t loop, int64_t grain_size) {
   int64_t numel = this->numel();
   if (numel == 0) {
     return;
-  } else if (numel < internal::GRAIN_SIZE || at::get_num_threads() == 1) {
+  } else if (numel < grain_size || at::get_num_threads() == 1) {
     return serial_for_each(loop, {0, numel});
   } else {
     at::parallel_for(0, numel, grain_size, [&](int64_t begin, int64_t end) {
@@ -573,6 +581,115 @@ void TensorIterator::for_each(loop2d_t loop, int64_t grain_size) {
   }
 }
 
+namespace {
+
+// Inputs smaller than this are never tuned: timing them costs about as much
+// as running them.
+constexpr int64_t kMinTunedNumel = 1024;
+// Measurements of each candidate before picking the fastest
+constexpr int64_t kTuningTrials = 3;
+
+// The search for the grain size of one op, dtype and input size. The
+// candidates are measured round-robin and the fastest run of each is kept.
+struct GrainSizeTuning {
+  std::vector<int64_t> candidates;
+  std::vector<double> best_seconds;
+  int64_t next = 0;
+  int64_t grain_size = -1;
+};
+
+using GrainSizeKey = std::tuple<std::string, ScalarType, int64_t>;
+
+std::mutex grain_size_mutex;
+std::map<GrainSizeKey, GrainSizeTuning> grain_size_tunings;
+
+GrainSizeTuning make_grain_size_tuning(int64_t estimate, int64_t numel) {
+  GrainSizeTuning tuning;
+  // A grain size of numel runs serially.
+  for (auto grain_size : {estimate / 4, estimate / 2, estimate, estimate * 2, estimate * 4, numel}) {
+    grain_size = std::max<int64_t>(1, std::min(grain_size, numel));
+    if (std::find(tuning.candidates.begin(), tuning.candidates.end(), grain_size) == tuning.candidates.end()) {
+      tuning.candidates.push_back(grain_size);
+    }
+  }
+  tuning.best_seconds.assign(tuning.candidates.size(), std::numeric_limits<double>::infinity());
+  return tuning;
+}
+
+} // namespace
+
+std::vector<TunedGrainSize> get_tuned_grain_sizes() {
+  std::lock_guard<std::mutex> guard(grain_size_mutex);
+  std::vector<TunedGrainSize> result;
+  for (const auto& entry : grain_size_tunings) {
+    if (entry.second.grain_size > 0) {
+      result.push_back({std::get<0>(entry.first), std::get<1>(entry.first),
+                        std::get<2>(entry.first), entry.second.grain_size});
+    }
+  }
+  return result;
+}
+
+void clear_tuned_grain_sizes() {
+  std::lock_guard<std::mutex> guard(grain_size_mutex);
+  grain_size_tunings.clear();
+}
+
+void TensorIterator::for_each(loop_t loop, const ParallelCost& cost) {
+  for_each(LOOP_WRAPPER(ntensors(), loop), cost);
+}
+
+void TensorIterator::for_each(loop2d_t loop, const ParallelCost& cost) {
+  int64_t grain_size = internal::grain_size_for_cost(cost.cycles_per_element);
+  int64_t numel = this->numel();
+  if (cost.name == nullptr || !at::globalContext().grainSizeAutotune() ||
+      numel < kMinTunedNumel || at::get_num_threads() == 1 || at::in_parallel_region()) {
+    return for_each(loop, grain_size);
+  }
+
+  int64_t log2_numel = 0;
+  while (numel >> (log2_numel + 1)) {
+    log2_numel++;
+  }
+  GrainSizeKey key(cost.name, ninputs() > 0 ? input_dtype() : dtype(), log2_numel);
+  int64_t candidate = -1;
+  {
+    std::lock_guard<std::mutex> guard(grain_size_mutex);
+    auto it = grain_size_tunings.find(key);
+    if (it == grain_size_tunings.end()) {
+      it = grain_size_tunings.emplace(key, make_grain_size_tuning(grain_size, numel)).first;
+    }
+    auto& tuning = it->second;
+    if (tuning.grain_size > 0) {
+      grain_size = tuning.grain_size;
+    } else {
+      candidate = tuning.next++ % tuning.candidates.size();
+      grain_size = tuning.candidates[candidate];
+    }
+  }
+  if (candidate < 0) {
+    return for_each(loop, grain_size);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for_each(loop, grain_size);
+  std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+
+  std::lock_guard<std::mutex> guard(grain_size_mutex);
+  auto it = grain_size_tunings.find(key);
+  if (it == grain_size_tunings.end() || it->second.grain_size > 0) {
+    // Cleared while running, or finished by another thread
+    return;
+  }
+  auto& tuning = it->second;
+  auto& best = tuning.best_seconds[candidate];
+  best = std::min(best, seconds.count());
+  if (tuning.next >= kTuningTrials * static_cast<int64_t>(tuning.candidates.size())) {
+    auto fastest = std::min_element(tuning.best_seconds.begin(), tuning.best_seconds.end());
+    tuning.grain_size = tuning.candidates[fastest - tuning.best_seconds.begin()];
+  }
+}
+
 StrideVector TensorIterator::get_strides() const {
   StrideVector strides;
   for (int dim = 0; dim < ndim(); dim++) {
@@ -767,6 +884,27 @@ TensorIterator TensorIterator::reduce_op(Tensor& out1, Tensor& out2, const Tenso
     .build();
 }
 
+TensorIterator TensorIterator::reduce_op(TensorList outs, const Tensor& a) {
+  TORCH_INTERNAL_ASSERT(!outs.empty());
+  TensorIteratorConfig config;
+  for (const auto& out : outs) {
+    TORCH_INTERNAL_ASSERT(out.defined());
+    TORCH_CHECK((!a.is_cuda() && !out.is_cuda()) || a.device() == out.device(),
+        "reduce_op(): expected input and outputs to be on same device, but input is on ", a.device(),
+        " and an output is on ", out.device());
+    TORCH_CHECK(out.sizes() == outs[0].sizes() && out.strides() == outs[0].strides(),
+        "reduce_op(): expected all outputs to have the same sizes and strides, but got sizes ",
+        outs[0].sizes(), " and ", out.sizes(), " and strides ", outs[0].strides(), " and ", out.strides());
+    config.add_output(out);
+  }
+  return config
+    .add_input(a)
+    .resize_outputs(false)
+    .is_reduction(true)
+    .check_all_same_dtype(false)
+    .build();
+}
+
 void TensorIterator::populate_operands(TensorIteratorConfig& config) {
   for (int i = 0; i < config.tensors_.size(); i++) {
     operands_.emplace_back(std::move(config.tensors_[i]));
@@ -1132,6 +1270,168 @@ FastSetupType TensorIterator::compute_fast_setup_type(const TensorIteratorConfig
   return FastSetupType::NONE;
 }
 
+// The setup of a TensorIterator that can be replayed for operands with the
+// same layout, see Note [TensorIterator plan cache]
+struct TensorIteratorPlan {
+  struct Operand {
+    StrideVector stride_bytes;
+    ScalarType target_dtype;
+    Device device = kCPU;
+    // Outputs allocated by the build, with their sizes and strides
+    bool allocated = false;
+    DimVector sizes;
+    DimVector strides;
+  };
+
+  bool cacheable = false;
+  DimVector shape;
+  DimVector perm;
+  bool has_coalesced_dimensions = false;
+  bool all_ops_same_shape = false;
+  ScalarType common_dtype = ScalarType::Undefined;
+  SmallVector<Operand, 4> operands;
+};
+
+namespace {
+
+struct PlanKeyHash {
+  size_t operator()(const std::vector<int64_t>& key) const {
+    size_t hash = key.size();
+    for (auto v : key) {
+      hash ^= std::hash<int64_t>()(v) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    }
+    return hash;
+  }
+};
+
+// Plans are kept per thread so that lookups need no lock. A full cache is
+// simply cleared; the steady state of a model is far below the limit.
+constexpr size_t kMaxCachedPlans = 4096;
+
+std::atomic<int64_t> plan_cache_hits{0};
+std::atomic<int64_t> plan_cache_misses{0};
+std::atomic<int64_t> plan_cache_uncacheable{0};
+// Bumped by reset_tensor_iterator_plan_cache() to invalidate every thread's
+// cache the next time that thread builds an iterator.
+std::atomic<int64_t> plan_cache_generation{0};
+
+struct PlanCache {
+  int64_t generation = -1;
+  std::unordered_map<std::vector<int64_t>, TensorIteratorPlan, PlanKeyHash> plans;
+};
+
+PlanCache& thread_plan_cache() {
+  static thread_local PlanCache cache;
+  auto generation = plan_cache_generation.load(std::memory_order_relaxed);
+  if (cache.generation != generation) {
+    cache.plans.clear();
+    cache.generation = generation;
+  }
+  return cache;
+}
+
+} // namespace
+
+TensorIteratorPlanCacheStats get_tensor_iterator_plan_cache_stats() {
+  TensorIteratorPlanCacheStats stats;
+  stats.hits = plan_cache_hits.load(std::memory_order_relaxed);
+  stats.misses = plan_cache_misses.load(std::memory_order_relaxed);
+  stats.uncacheable = plan_cache_uncacheable.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void reset_tensor_iterator_plan_cache() {
+  plan_cache_generation.fetch_add(1, std::memory_order_relaxed);
+  plan_cache_hits.store(0, std::memory_order_relaxed);
+  plan_cache_misses.store(0, std::memory_order_relaxed);
+  plan_cache_uncacheable.store(0, std::memory_order_relaxed);
+}
+
+// Encodes everything the setup depends on. Returns false for builds that are
+// never cached.
+bool TensorIterator::compute_plan_key(const TensorIteratorConfig& config, std::vector<int64_t>& key) const {
+  key.clear();
+  key.push_back(
+      (int64_t(config.resize_outputs_) << 0) |
+      (int64_t(config.check_all_same_dtype_) << 1) |
+      (int64_t(config.check_all_same_device_) << 2) |
+      (int64_t(config.enforce_safe_casting_to_output_) << 3) |
+      (int64_t(config.promote_inputs_to_common_dtype_) << 4) |
+      (int64_t(config.promote_integer_inputs_to_float_) << 5) |
+      (int64_t(config.cast_common_dtype_to_outputs_) << 6) |
+      (int64_t(config.allow_cpu_scalars_) << 7) |
+      (int64_t(is_reduction_) << 8) |
+      (int64_t(config.static_shape_.has_value()) << 9) |
+      (int64_t(config.static_dtype_and_device_.has_value()) << 10));
+  key.push_back(num_outputs_);
+  if (config.static_shape_.has_value()) {
+    key.push_back(config.static_shape_->size());
+    key.insert(key.end(), config.static_shape_->begin(), config.static_shape_->end());
+  }
+  if (config.static_dtype_and_device_.has_value()) {
+    const auto& dtype_and_device = *config.static_dtype_and_device_;
+    key.push_back(static_cast<int64_t>(dtype_and_device.first));
+    key.push_back(static_cast<int64_t>(dtype_and_device.second.type()));
+    key.push_back(dtype_and_device.second.index());
+  }
+  for (const auto& op : operands_) {
+    const auto& t = op.tensor;
+    if (!t.defined()) {
+      key.push_back(-1);
+      continue;
+    }
+    if (t.has_names()) {
+      return false;
+    }
+    auto* impl = t.unsafeGetTensorImpl();
+    key.push_back(
+        (static_cast<int64_t>(op.current_dtype) << 0) |
+        (static_cast<int64_t>(op.device.type()) << 8) |
+        (static_cast<int64_t>(op.device.index() + 1) << 16) |
+        (int64_t(impl->is_wrapped_number()) << 32) |
+        (int64_t(op.is_read_write) << 33));
+    key.push_back(t.dim());
+    key.insert(key.end(), t.sizes().begin(), t.sizes().end());
+    key.insert(key.end(), t.strides().begin(), t.strides().end());
+  }
+  return true;
+}
+
+void TensorIterator::save_plan(TensorIteratorPlan& plan) const {
+  plan.shape = shape_;
+  plan.perm = perm_;
+  plan.has_coalesced_dimensions = has_coalesced_dimensions_;
+  plan.all_ops_same_shape = all_ops_same_shape_;
+  plan.common_dtype = common_dtype_;
+  plan.operands.clear();
+  for (const auto& op : operands_) {
+    TensorIteratorPlan::Operand plan_op;
+    plan_op.stride_bytes = op.stride_bytes;
+    plan_op.target_dtype = op.target_dtype;
+    plan_op.device = op.device;
+    plan.operands.push_back(std::move(plan_op));
+  }
+}
+
+void TensorIterator::apply_plan(const TensorIteratorPlan& plan) {
+  shape_ = plan.shape;
+  perm_ = plan.perm;
+  has_coalesced_dimensions_ = plan.has_coalesced_dimensions;
+  all_ops_same_shape_ = plan.all_ops_same_shape;
+  common_dtype_ = plan.common_dtype;
+  for (int i = 0; i < ntensors(); i++) {
+    auto& op = operands_[i];
+    const auto& plan_op = plan.operands[i];
+    op.stride_bytes = plan_op.stride_bytes;
+    op.target_dtype = plan_op.target_dtype;
+    op.device = plan_op.device;
+    if (plan_op.allocated) {
+      op.tensor = at::empty_strided(plan_op.sizes, plan_op.strides, op.options());
+      op.current_dtype = op.target_dtype;
+    }
+  }
+}
+
 TensorIterator::TensorIterator(TensorIteratorConfig& config) {
   build(config);
 }
@@ -1147,27 +1447,87 @@ void TensorIterator::build(TensorIteratorConfig& config) {
   // Check that the outputs have no internal overlap
   // and do not share memory with inputs.
   compute_mem_overlaps(config);
-  // Check that input dimensions are aligned correctly & compute outnames.
-  compute_names(config);
-  // compute the broadcasted shape
-  compute_shape(config);
-  // resize outputs if necessary
-  resize_outputs(config);
-  // compute the result dtype and device
-  compute_types(config);
-  // try fast setup output tensor, if failed, fallback to normal setup
-  if (!fast_set_up(config)) {
-    // compute each tensor's stride after broadcasting
-    compute_strides(config);
-    // re-order dimensions to improve coalescing
-    reorder_dimensions(config);
-    // allocate the output tensor if it's not provided
-    allocate_outputs();
-    // coalesce adjacent dimensions when possible
-    coalesce_dimensions();
+
+  std::vector<int64_t> plan_key;
+  const bool use_plan_cache = at::globalContext().tensorIteratorPlanCache() &&
+      compute_plan_key(config, plan_key);
+  TensorIteratorPlan* cached_plan = nullptr;
+  if (use_plan_cache) {
+    auto& plans = thread_plan_cache().plans;
+    auto it = plans.find(plan_key);
+    if (it != plans.end()) {
+      cached_plan = &it->second;
+    }
+  }
+
+  if (cached_plan && cached_plan->cacheable) {
+    plan_cache_hits.fetch_add(1, std::memory_order_relaxed);
+    apply_plan(*cached_plan);
+  } else {
+    // Remember the operands to tell afterwards whether the build replaced
+    // or resized any of them.
+    SmallVector<Tensor, 4> original_operands;
+    SmallVector<std::pair<DimVector, DimVector>, 4> original_layouts;
+    if (use_plan_cache && !cached_plan) {
+      for (const auto& op : operands_) {
+        original_operands.push_back(op.tensor);
+        original_layouts.emplace_back(
+            op.tensor.defined() ? DimVector(op.tensor.sizes()) : DimVector(),
+            op.tensor.defined() ? DimVector(op.tensor.strides()) : DimVector());
+      }
+    }
+
+    // Check that input dimensions are aligned correctly & compute outnames.
+    compute_names(config);
+    // compute the broadcasted shape
+    compute_shape(config);
+    // resize outputs if necessary
+    resize_outputs(config);
+    // compute the result dtype and device
+    compute_types(config);
+    // try fast setup output tensor, if failed, fallback to normal setup
+    if (!fast_set_up(config)) {
+      // compute each tensor's stride after broadcasting
+      compute_strides(config);
+      // re-order dimensions to improve coalescing
+      reorder_dimensions(config);
+      // allocate the output tensor if it's not provided
+      allocate_outputs();
+      // coalesce adjacent dimensions when possible
+      coalesce_dimensions();
+    }
+    // perform name inference
+    propagate_names_to_outputs();
+
+    if (cached_plan) {
+      plan_cache_uncacheable.fetch_add(1, std::memory_order_relaxed);
+    } else if (use_plan_cache) {
+      plan_cache_misses.fetch_add(1, std::memory_order_relaxed);
+      TensorIteratorPlan plan;
+      save_plan(plan);
+      plan.cacheable = true;
+      for (int i = 0; i < ntensors(); i++) {
+        const auto& op = operands_[i];
+        const auto& original = original_operands[i];
+        if (!original.defined()) {
+          plan.operands[i].allocated = true;
+          plan.operands[i].sizes = op.tensor.sizes();
+          plan.operands[i].strides = op.tensor.strides();
+        } else if (op.original_tensor.defined() || !op.tensor.is_same(original) ||
+                   op.tensor.sizes() != IntArrayRef(original_layouts[i].first) ||
+                   op.tensor.strides() != IntArrayRef(original_layouts[i].second)) {
+          // Outputs that were resized or replaced by a temporary for a cast
+          // have to go through the full setup every time.
+          plan.cacheable = false;
+        }
+      }
+      auto& plans = thread_plan_cache().plans;
+      if (plans.size() >= kMaxCachedPlans) {
+        plans.clear();
+      }
+      plans.emplace(std::move(plan_key), std::move(plan));
+    }
   }
-  // perform name inference
-  propagate_names_to_outputs();
 
   for (auto& op : operands_) {
     TORCH_INTERNAL_ASSERT(op.tensor.defined());
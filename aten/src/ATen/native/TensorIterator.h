@@ -129,6 +129,67 @@ enum class FastSetupType : uint8_t {
 };
 
 class TensorIteratorConfig;
+struct TensorIteratorPlan;
+
+// Note [Parallel cost hints]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~
+// CPU kernels can tell TensorIterator::for_each roughly how many cycles one
+// element of their loop costs. The grain size is scaled by the cost (see
+// at::internal::grain_size_for_cost), so a cheap add is split into fewer,
+// larger chunks than an expensive special function and small inputs to
+// expensive ops are still parallelized.
+//
+// With at::globalContext().setGrainSizeAutotune(true), a named hint instead
+// makes for_each time a few grain sizes around the estimate on successive
+// calls and then keep the fastest one for that op, dtype and input size
+// (rounded to a power of two). The tuned values can be inspected with
+// get_tuned_grain_sizes().
+struct ParallelCost {
+  // Key for auto-tuning; hints without a name are never tuned
+  const char* name = nullptr;
+  double cycles_per_element = 1.0;
+
+  constexpr ParallelCost() = default;
+  constexpr ParallelCost(const char* name, double cycles_per_element)
+    : name(name), cycles_per_element(cycles_per_element) {}
+};
+
+struct TunedGrainSize {
+  std::string name;
+  ScalarType dtype;
+  // Inputs with numel in [2^log2_numel, 2^(log2_numel + 1))
+  int64_t log2_numel;
+  int64_t grain_size;
+};
+
+CAFFE2_API std::vector<TunedGrainSize> get_tuned_grain_sizes();
+CAFFE2_API void clear_tuned_grain_sizes();
+
+// Note [TensorIterator plan cache]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Building a TensorIterator (broadcasting, type promotion, reordering and
+// coalescing dimensions) only depends on the sizes, strides, dtypes and
+// devices of the operands and on the TensorIteratorConfig flags. For small
+// tensors it can cost more than the loop itself. When enabled with
+// at::globalContext().setTensorIteratorPlanCache(true), every thread keeps
+// the result of each build keyed on those properties, and a build with the
+// same key only re-runs the memory overlap checks, allocates any missing
+// outputs with the recorded strides and then goes straight to the loop.
+//
+// Builds that cast operands to temporaries or resize outputs, and builds
+// with named tensors, always take the full path.
+struct TensorIteratorPlanCacheStats {
+  // Builds set up from a cached plan
+  int64_t hits = 0;
+  // Builds that recorded a new plan
+  int64_t misses = 0;
+  // Builds with a known key whose setup cannot be replayed
+  int64_t uncacheable = 0;
+};
+
+CAFFE2_API TensorIteratorPlanCacheStats get_tensor_iterator_plan_cache_stats();
+// Drops the plans of all threads and zeroes the counters
+CAFFE2_API void reset_tensor_iterator_plan_cache();
 
 struct CAFFE2_API TensorIterator {
   using DimMask = std::bitset<64>;
@@ -164,6 +225,8 @@ struct CAFFE2_API TensorIterator {
     bool check_mem_overlap = false);
   static TensorIterator reduce_op(Tensor& out, const Tensor& a);
   static TensorIterator reduce_op(Tensor& out1, Tensor& out2, const Tensor& a);
+  // Reduction with any number of outputs, which must share their sizes and strides
+  static TensorIterator reduce_op(TensorList outs, const Tensor& a);
 
   int ndim() const { return shape_.size(); }
   IntArrayRef shape() const { return shape_; }
@@ -244,6 +307,9 @@ struct CAFFE2_API TensorIterator {
 
   void for_each(loop_t loop, int64_t grain_size = at::internal::GRAIN_SIZE);
   void for_each(loop2d_t loop, int64_t grain_size = at::internal::GRAIN_SIZE);
+  // See Note [Parallel cost hints]
+  void for_each(loop_t loop, const ParallelCost& cost);
+  void for_each(loop2d_t loop, const ParallelCost& cost);
 
   void parallel_reduce(loop2d_t loop);
 
@@ -316,6 +382,9 @@ protected:
   void resize_outputs(const TensorIteratorConfig&);
   void propagate_names_to_outputs();
   void coalesce_dimensions();
+  bool compute_plan_key(const TensorIteratorConfig&, std::vector<int64_t>& key) const;
+  void save_plan(TensorIteratorPlan&) const;
+  void apply_plan(const TensorIteratorPlan&);
 
   template <int dim, MemoryFormat memory_format> bool requires_channels_last_nd_output();
   bool requires_channels_last_2d_output();
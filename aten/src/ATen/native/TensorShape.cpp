@@ -21,7 +21,7 @@
 namespace at {
 namespace native {
 
-DEFINE_DISPATCH(cat_serial_stub);
+DEFINE_DISPATCH(cat_stub);
 
 Tensor _reshape_from_tensor(const Tensor& self, const Tensor& shape_tensor) {
   TORCH_CHECK(shape_tensor.dim() == 1);
@@ -107,7 +107,6 @@ Tensor & _cat_out_cpu(Tensor& result, TensorList tensors, int64_t dim) {
   // size (i.e. other empty sizes are not skipped).
   // FIXME: warn if this is the case
   bool allSkipped = true;
-  bool allContiguous = true;
   Tensor notSkippedTensor;
 
   // Inputs cannot alias the output tensor
@@ -136,12 +135,8 @@ Tensor & _cat_out_cpu(Tensor& result, TensorList tensors, int64_t dim) {
   TORCH_CHECK(tensors.size() > 0, "expected a non-empty list of Tensors");
   TORCH_CHECK(dim <= notSkippedTensor.dim(), "dimension ", dim, "out of range");
 
-  // when the input tensors are of the same size and strides,
-  // reuse the same iterator for all input tensors
-  bool reuse_iterator = true;
-  bool no_type_promotion = true;
   // Check the type of the result
-  no_type_promotion = result.dtype() == notSkippedTensor.dtype();
+  bool no_type_promotion = result.dtype() == notSkippedTensor.dtype();
 
   // compute size of the result in the cat dimension
   int64_t cat_dim_size = 0;
@@ -149,21 +144,11 @@ Tensor & _cat_out_cpu(Tensor& result, TensorList tensors, int64_t dim) {
   for (int i = 0; i < tensors.size(); i++) {
     auto const &tensor = tensors[i];
     if (should_skip(tensor)) {
-      // don't use fast path for empty tensor
-      allContiguous = false;
       continue;
     }
     check_cat_shape_except_dim(notSkippedTensor, tensor, dim, i);
     cat_dim_size += tensor.size(dim);
 
-    if (!tensor.is_contiguous(first_tensor_mem_format)) {
-      allContiguous = false;
-    }
-
-    if (tensor.sizes() != notSkippedTensor.sizes() ||
-        tensor.strides() != notSkippedTensor.strides()) {
-      reuse_iterator = false;
-    }
     if (tensor.dtype() != notSkippedTensor.dtype()) {
       no_type_promotion = false;
     }
@@ -176,62 +161,32 @@ Tensor & _cat_out_cpu(Tensor& result, TensorList tensors, int64_t dim) {
     return result;
   }
 
-  // fast path for single thread when both inputs and result are contiguous and not empty
-  allContiguous = allContiguous && result.is_contiguous(first_tensor_mem_format);
-  bool use_serial_kernel = result.numel() < at::internal::GRAIN_SIZE || at::get_num_threads() == 1;
-  ScalarType dtype = notSkippedTensor.scalar_type();
-  if (use_serial_kernel && allContiguous && no_type_promotion && (dtype == ScalarType::Double || dtype == ScalarType::Float)) {
-    cat_serial_stub(kCPU, result, tensors, dim);
+  // Without type promotion every input is a plain copy, which cat_stub plans
+  // for all inputs at once and runs in parallel.
+  if (no_type_promotion) {
+    at::assert_no_internal_overlap(result);
+    cat_stub(kCPU, result, tensors, dim);
     return result;
   }
 
   int64_t offset = 0;
-  if (reuse_iterator &&
-      result.is_contiguous(first_tensor_mem_format) &&
-      no_type_promotion) {
-    auto source_slice = notSkippedTensor;
-    auto slice_dim_size = source_slice.size(dim);
-    auto result_slice = result.narrow(dim, 0, slice_dim_size);
-    auto result_slice_data = result_slice.data_ptr();
-    auto result_stride_bytes = result.stride(dim) * elementSize(result.scalar_type());
+  for (auto const &tensor: tensors) {
+    if (should_skip(tensor)) {
+      continue;
+    }
+    auto slice_dim_size = tensor.size(dim);
+    auto result_slice = result.narrow(dim, offset, slice_dim_size);
 
     auto iter = TensorIteratorConfig()
       .resize_outputs(false)
       .add_output(result_slice)
-      .add_input(source_slice)
+      .add_input(tensor)
+      .promote_inputs_to_common_dtype(true)
+      .cast_common_dtype_to_outputs(true)
       .enforce_safe_casting_to_output(true)
       .build();
-
-    for (auto const &tensor : tensors) {
-      if (should_skip(tensor)) {
-        continue;
-      }
-      auto source_data = static_cast<char*>(tensor.data_ptr());
-      auto result_data = static_cast<char*>(result_slice_data) + offset * result_stride_bytes;
-      iter.unsafe_replace_operand(0, result_data);
-      iter.unsafe_replace_operand(1, source_data);
-      copy_stub(iter.device_type(), iter, false);
-      offset += slice_dim_size;
-    }
-  } else {
-    for (auto const &tensor: tensors) {
-      if (should_skip(tensor)) {
-        continue;
-      }
-      auto slice_dim_size = tensor.size(dim);
-      auto result_slice = result.narrow(dim, offset, slice_dim_size);
-
-      auto iter = TensorIteratorConfig()
-        .resize_outputs(false)
-        .add_output(result_slice)
-        .add_input(tensor)
-        .promote_inputs_to_common_dtype(true)
-        .cast_common_dtype_to_outputs(true)
-        .enforce_safe_casting_to_output(true)
-        .build();
-      copy_stub(iter.device_type(), iter, false);
-      offset += slice_dim_size;
-    }
+    copy_stub(iter.device_type(), iter, false);
+    offset += slice_dim_size;
   }
 
   return result;
@@ -529,6 +484,27 @@ std::vector<Tensor> unsafe_chunk(const Tensor& self, int64_t chunks, int64_t dim
   }
 }
 
+// Creates a view of self with the given geometry without going through the
+// dispatcher again. The callers compute the geometry from that of self, so it
+// is in bounds for its storage and does not need to be checked once more. For
+// the dense tensors of CPU and CUDA this does what as_strided_tensorimpl does;
+// other tensors (quantized, XLA, ...) go through their own as_strided.
+static Tensor as_strided_view(
+    const Tensor& self,
+    IntArrayRef sizes,
+    IntArrayRef strides,
+    optional<int64_t> storage_offset = c10::nullopt) {
+  const auto key = legacyExtractDispatchKey(self.key_set());
+  if (key != DispatchKey::CPU && key != DispatchKey::CUDA) {
+    return self.as_strided(sizes, strides, storage_offset);
+  }
+  auto impl = c10::make_intrusive<TensorImpl>(
+      Storage(self.storage()), self.key_set(), self.dtype());
+  impl->set_storage_offset(storage_offset.value_or(self.storage_offset()));
+  impl->set_sizes_and_strides(sizes, strides);
+  return Tensor(std::move(impl));
+}
+
 Tensor diagflat(const Tensor& self, int64_t offset) {
   return self.contiguous().view(-1).diag(offset);
 }
@@ -579,7 +555,7 @@ Tensor diagonal(const Tensor& self, int64_t offset, int64_t dim1_, int64_t dim2_
   strides.push_back(self.stride(dim1)+self.stride(dim2));
 
   // return view with new parameters
-  auto result = self.as_strided(sizes, strides, storage_offset);
+  auto result = as_strided_view(self, sizes, strides, storage_offset);
 
   no_names_guard.reset();
   namedinference::propagate_names_if_nonempty(result, outnames);
@@ -633,7 +609,7 @@ Tensor expand(const Tensor& self, IntArrayRef size, bool implicit) {
   std::vector<int64_t> expandedStrides;
   std::tie(expandedSizes, expandedStrides) = inferExpandGeometry(self.sizes(), self.strides(), size);
 
-  auto result = self.as_strided(expandedSizes, expandedStrides);
+  auto result = as_strided_view(self, expandedSizes, expandedStrides);
   namedinference::propagate_names_for_expand(result, self);
   return result;
 }
@@ -757,7 +733,7 @@ Tensor permute(const Tensor& self, IntArrayRef dims) {
     newSizes[i] = oldSizes[dim];
     newStrides[i] = oldStrides[dim];
   }
-  return self.as_strided(newSizes, newStrides);
+  return as_strided_view(self, newSizes, newStrides);
 }
 
 Tensor repeat(const Tensor& self, IntArrayRef repeats) {
@@ -918,7 +894,7 @@ Tensor select(const Tensor& self, int64_t dim, int64_t index) {
   auto storage_offset = self.storage_offset() + index * strides[dim];
   sizes.erase(sizes.begin() + dim);
   strides.erase(strides.begin() + dim);
-  auto result = self.as_strided(sizes, strides, storage_offset);
+  auto result = as_strided_view(self, sizes, strides, storage_offset);
   namedinference::propagate_names_except(result, self, {dim});
   return result;
 }
@@ -1042,7 +1018,7 @@ Tensor slice(const Tensor& self, int64_t dim, int64_t start, int64_t end, int64_
   auto len = end - start;
   sizes[dim] = (len + step - 1) / step;  // round-up
   strides[dim] *= step;
-  auto result = self.as_strided(sizes, strides, storage_offset);
+  auto result = as_strided_view(self, sizes, strides, storage_offset);
   namedinference::propagate_names(result, self);
   return result;
 }
@@ -1279,7 +1255,7 @@ Tensor transpose(const Tensor & self, int64_t dim0, int64_t dim1) {
   auto sizes = self.sizes().vec();
   std::swap(strides[dim0], strides[dim1]);
   std::swap(sizes[dim0], sizes[dim1]);
-  auto result = self.as_strided(sizes, strides);
+  auto result = as_strided_view(self, sizes, strides);
   propagate_transposed_names(result, self, dim0, dim1);
   return result;
 }
@@ -1405,7 +1381,7 @@ Tensor squeeze(const Tensor& self) {
   if (self.is_quantized()) {
     result = squeeze_qtensor(self);
   } else {
-    result = self.as_strided(std::get<0>(g), std::get<1>(g));
+    result = as_strided_view(self, std::get<0>(g), std::get<1>(g));
   }
   auto maybe_outnames = namedinference::compute_squeeze_outnames(self);
   namedinference::propagate_names_if_nonempty(result, maybe_outnames);
@@ -1420,10 +1396,10 @@ Tensor squeeze(const Tensor& self, int64_t dim) {
     return squeeze_qtensor(self, dim);
   }
   if (dims == 0 || self.sizes()[dim] != 1) {
-    return self.as_strided(self.sizes(), self.strides());
+    return as_strided_view(self, self.sizes(), self.strides());
   }
   auto g = inferSqueezeGeometry(self, dim);
-  auto result = self.as_strided(std::get<0>(g), std::get<1>(g));
+  auto result = as_strided_view(self, std::get<0>(g), std::get<1>(g));
   namedinference::propagate_names_except(result, self, {dim});
   return result;
 }
@@ -1505,7 +1481,7 @@ Tensor unsqueeze(const Tensor& self, int64_t dim) {
     return unsqueeze_qtensor(self, dim);
   } else {
     auto g = inferUnsqueezeGeometry(self, dim);
-    return self.as_strided(std::get<0>(g), std::get<1>(g));
+    return as_strided_view(self, std::get<0>(g), std::get<1>(g));
   }
 }
 
@@ -35,7 +35,8 @@ void add_kernel(TensorIterator& iter, Scalar alpha_scalar) {
         [=](scalar_t a, scalar_t b) __ubsan_ignore_undefined__ -> scalar_t { return a + alpha * b; },
         [=](Vec256<scalar_t> a, Vec256<scalar_t> b) __ubsan_ignore_undefined__ {
           return vec256::fmadd(b, alpha_vec, a);
-        });
+        },
+        ParallelCost("add", 0.5));
       });
   }
 }
@@ -87,7 +88,8 @@ void mul_kernel(TensorIterator& iter) {
         [=](scalar_t a, scalar_t b) -> scalar_t { return a * b; },
         [=](Vec256<scalar_t> a, Vec256<scalar_t> b) {
           return a * b;
-        });
+        },
+        ParallelCost("mul", 0.5));
     });
   }
 }
@@ -1,6 +1,11 @@
 #include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/vec256.h>
 #include <ATen/native/CPUBlas.h>
 
+#include <algorithm>
+#include <vector>
+
 namespace at {
 namespace native {
 namespace cpublas {
@@ -189,9 +194,164 @@ void cpublas_gemm_impl(
       });
 }
 
+// The rows of c a block of the small kernels computes at once, and the
+// vectors of their columns.
+constexpr int64_t kSmallGemmBlockRows = 4;
+constexpr int64_t kSmallGemmBlockVecs = 2;
+
+// Computes `rows` rows and `cols` columns of c, with cols at most
+// kSmallGemmBlockVecs vectors, keeping the sums in registers over k.
+template <typename scalar_t, int64_t rows>
+inline void gemm_small_block_(
+    int64_t cols, int64_t k,
+    scalar_t alpha,
+    const scalar_t *a, int64_t a_row_stride, int64_t a_col_stride,
+    const scalar_t *b, int64_t ldb,
+    scalar_t beta,
+    scalar_t *c, int64_t ldc) {
+  using Vec = vec256::Vec256<scalar_t>;
+  constexpr int64_t kVecSize = Vec::size();
+  int64_t cols0 = std::min(cols, kVecSize);
+  int64_t cols1 = cols - cols0;
+
+  Vec acc0[rows];
+  Vec acc1[rows];
+  for (int64_t r = 0; r < rows; r++) {
+    acc0[r] = Vec(scalar_t(0));
+    acc1[r] = Vec(scalar_t(0));
+  }
+  for (int64_t l = 0; l < k; l++) {
+    const scalar_t *b_row = b + l * ldb;
+    Vec b0 = Vec::loadu(b_row, cols0);
+    Vec b1 = cols1 > 0 ? Vec::loadu(b_row + kVecSize, cols1) : Vec(scalar_t(0));
+    for (int64_t r = 0; r < rows; r++) {
+      Vec a_rl(a[r * a_row_stride + l * a_col_stride]);
+      acc0[r] = vec256::fmadd(a_rl, b0, acc0[r]);
+      acc1[r] = vec256::fmadd(a_rl, b1, acc1[r]);
+    }
+  }
+
+  Vec alpha_vec(alpha);
+  Vec beta_vec(beta);
+  for (int64_t r = 0; r < rows; r++) {
+    scalar_t *c_row = c + r * ldc;
+    Vec out0 = acc0[r] * alpha_vec;
+    if (beta != scalar_t(0)) {
+      out0 = vec256::fmadd(Vec::loadu(c_row, cols0), beta_vec, out0);
+    }
+    out0.store(c_row, cols0);
+    if (cols1 > 0) {
+      Vec out1 = acc1[r] * alpha_vec;
+      if (beta != scalar_t(0)) {
+        out1 = vec256::fmadd(Vec::loadu(c_row + kVecSize, cols1), beta_vec, out1);
+      }
+      out1.store(c_row + kVecSize, cols1);
+    }
+  }
+}
+
+template <typename scalar_t>
+void gemm_small_(
+    int64_t m, int64_t n, int64_t k,
+    scalar_t alpha,
+    const scalar_t *a, int64_t a_row_stride, int64_t a_col_stride,
+    const scalar_t *b, int64_t ldb,
+    scalar_t beta,
+    scalar_t *c, int64_t ldc) {
+  constexpr int64_t kBlockCols =
+      kSmallGemmBlockVecs * vec256::Vec256<scalar_t>::size();
+  for (int64_t i = 0; i < m; i += kSmallGemmBlockRows) {
+    const scalar_t *a_i = a + i * a_row_stride;
+    scalar_t *c_i = c + i * ldc;
+    for (int64_t j = 0; j < n; j += kBlockCols) {
+      int64_t cols = std::min(kBlockCols, n - j);
+      switch (std::min(kSmallGemmBlockRows, m - i)) {
+        case 4:
+          gemm_small_block_<scalar_t, 4>(
+              cols, k, alpha, a_i, a_row_stride, a_col_stride,
+              b + j, ldb, beta, c_i + j, ldc);
+          break;
+        case 3:
+          gemm_small_block_<scalar_t, 3>(
+              cols, k, alpha, a_i, a_row_stride, a_col_stride,
+              b + j, ldb, beta, c_i + j, ldc);
+          break;
+        case 2:
+          gemm_small_block_<scalar_t, 2>(
+              cols, k, alpha, a_i, a_row_stride, a_col_stride,
+              b + j, ldb, beta, c_i + j, ldc);
+          break;
+        default:
+          gemm_small_block_<scalar_t, 1>(
+              cols, k, alpha, a_i, a_row_stride, a_col_stride,
+              b + j, ldb, beta, c_i + j, ldc);
+      }
+    }
+  }
+}
+
+template <typename scalar_t>
+void gemm_batched_small_(
+    int64_t batch_size,
+    int64_t m, int64_t n, int64_t k,
+    scalar_t alpha,
+    const scalar_t *a, int64_t a_batch_stride, int64_t a_row_stride, int64_t a_col_stride,
+    const scalar_t *b, int64_t b_batch_stride, int64_t b_row_stride, int64_t b_col_stride,
+    scalar_t beta,
+    scalar_t *c, int64_t c_batch_stride, int64_t ldc) {
+  int64_t grain_size = std::max(at::internal::GRAIN_SIZE / (m * n * k), (int64_t)1);
+  parallel_for(0, batch_size, grain_size, [&](int64_t begin, int64_t end) {
+    // The kernels load the rows of b as vectors, so the matrices of b whose
+    // rows aren't contiguous, e.g. transposed ones, are copied first.
+    std::vector<scalar_t> packed_b;
+    if (b_col_stride != 1) {
+      packed_b.resize(k * n);
+    }
+    for (int64_t i = begin; i < end; i++) {
+      const scalar_t *b_i = b + i * b_batch_stride;
+      int64_t ldb = b_row_stride;
+      if (b_col_stride != 1) {
+        for (int64_t l = 0; l < k; l++) {
+          for (int64_t j = 0; j < n; j++) {
+            packed_b[l * n + j] = b_i[l * b_row_stride + j * b_col_stride];
+          }
+        }
+        b_i = packed_b.data();
+        ldb = n;
+      }
+      gemm_small_(
+          m, n, k, alpha,
+          a + i * a_batch_stride, a_row_stride, a_col_stride,
+          b_i, ldb, beta,
+          c + i * c_batch_stride, ldc);
+    }
+  });
+}
+
+void cpublas_gemm_batched_small_impl(
+    at::ScalarType type,
+    int64_t batch_size,
+    int64_t m, int64_t n, int64_t k,
+    Scalar alpha,
+    const void *a, int64_t a_batch_stride, int64_t a_row_stride, int64_t a_col_stride,
+    const void *b, int64_t b_batch_stride, int64_t b_row_stride, int64_t b_col_stride,
+    Scalar beta,
+    void *c, int64_t c_batch_stride, int64_t ldc) {
+  AT_DISPATCH_FLOATING_TYPES(type, "cpublas_gemm_batched_small_impl", [&] {
+    gemm_batched_small_(
+        batch_size, m, n, k,
+        alpha.to<scalar_t>(),
+        static_cast<const scalar_t *>(a), a_batch_stride, a_row_stride, a_col_stride,
+        static_cast<const scalar_t *>(b), b_batch_stride, b_row_stride, b_col_stride,
+        beta.to<scalar_t>(),
+        static_cast<scalar_t *>(c), c_batch_stride, ldc);
+  });
+}
+
 }}  // namespace cpublas::(anonymous)
 
 
 REGISTER_DISPATCH(cpublas::gemm_stub, &cpublas::cpublas_gemm_impl);
+REGISTER_DISPATCH(cpublas::gemm_batched_small_stub, &cpublas::cpublas_gemm_batched_small_impl);
 
 }}  // namespace at::native
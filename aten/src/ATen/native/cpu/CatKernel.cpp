@@ -1,67 +1,199 @@
 #include <ATen/ATen.h>
 
-#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
 #include <ATen/native/cpu/CatKernel.h>
-#include <ATen/cpu/vec256/functional.h>
-#include <ATen/cpu/vec256/vec256.h>
+#include <c10/util/SmallVector.h>
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
 
 namespace at { namespace native {
 
 namespace {
 
-struct InputMeta {
-  void* data_ptr;
-  int64_t inner_size;
-
-  InputMeta(const Tensor& t, int64_t dim, int64_t inner)
-    : data_ptr(t.data_ptr())
-    , inner_size(t.size(dim) * inner) {}
+// One input of a cat, described as `num_rows` rows of `row_size` elements.
+// The rows are the innermost dimension left after coalescing the input with
+// its slice of the result; the remaining dimensions, innermost first, are
+// walked with `sizes` and the byte strides.
+struct CatInputPlan {
+  const char* src;
+  char* dst;
+  int64_t row_size;
+  int64_t src_row_stride;
+  int64_t dst_row_stride;
+  int64_t num_rows;
+  c10::SmallVector<int64_t, 5> sizes;
+  c10::SmallVector<int64_t, 5> src_strides;
+  c10::SmallVector<int64_t, 5> dst_strides;
 };
 
-template <typename scalar_t>
-void cat_serial_kernel_impl(Tensor& result, TensorList tensors, int64_t dim) {
-  int64_t outer = result.numel() / (result.size(dim) * result.stride(dim));
-  scalar_t* result_data = result.data_ptr<scalar_t>();
-  int64_t ninputs = tensors.size();
-  std::vector<InputMeta> inputs;
-  inputs.reserve(ninputs);
-  for (auto const &tensor : tensors) {
-    inputs.emplace_back(tensor, dim, result.stride(dim));
+// Orders the dimensions of `result` from outermost to innermost in memory, so
+// that channels-last results are walked in their own order.
+std::vector<int64_t> result_dim_order(const Tensor& result) {
+  std::vector<int64_t> order(result.dim());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int64_t a, int64_t b) {
+    return result.stride(a) > result.stride(b);
+  });
+  return order;
+}
+
+CatInputPlan plan_input(
+    const Tensor& input, char* dst, const Tensor& result,
+    const std::vector<int64_t>& dim_order) {
+  const int64_t element_size = result.element_size();
+  CatInputPlan plan;
+  plan.src = static_cast<const char*>(input.data_ptr());
+  plan.dst = dst;
+
+  // Walk the dimensions from the innermost one, merging a dimension into the
+  // previous one when it continues it in both the input and the result.
+  for (auto it = dim_order.rbegin(); it != dim_order.rend(); it++) {
+    const int64_t d = *it;
+    const int64_t size = input.size(d);
+    if (size == 1) {
+      continue;
+    }
+    const int64_t src_stride = input.stride(d) * element_size;
+    const int64_t dst_stride = result.stride(d) * element_size;
+    if (!plan.sizes.empty() &&
+        plan.sizes.back() * plan.src_strides.back() == src_stride &&
+        plan.sizes.back() * plan.dst_strides.back() == dst_stride) {
+      plan.sizes.back() *= size;
+    } else {
+      plan.sizes.push_back(size);
+      plan.src_strides.push_back(src_stride);
+      plan.dst_strides.push_back(dst_stride);
+    }
+  }
+
+  if (plan.sizes.empty()) {
+    plan.row_size = 1;
+    plan.src_row_stride = element_size;
+    plan.dst_row_stride = element_size;
+  } else {
+    plan.row_size = plan.sizes[0];
+    plan.src_row_stride = plan.src_strides[0];
+    plan.dst_row_stride = plan.dst_strides[0];
+    plan.sizes.erase(plan.sizes.begin());
+    plan.src_strides.erase(plan.src_strides.begin());
+    plan.dst_strides.erase(plan.dst_strides.begin());
   }
+  plan.num_rows = std::accumulate(
+      plan.sizes.begin(), plan.sizes.end(), int64_t(1), std::multiplies<int64_t>());
+  return plan;
+}
+
+template <typename T>
+void copy_strided_row(
+    char* dst, const char* src, int64_t n, int64_t dst_stride, int64_t src_stride) {
+  for (int64_t i = 0; i < n; i++) {
+    *reinterpret_cast<T*>(dst + i * dst_stride) =
+        *reinterpret_cast<const T*>(src + i * src_stride);
+  }
+}
 
-  using Vec = vec256::Vec256<scalar_t>;
-  scalar_t* result_ptr = result_data;
-  for (int64_t i = 0; i < outer; ++i) {
-    for (int64_t j = 0; j < ninputs; j++) {
-      int64_t local_inner = inputs[j].inner_size;
-      scalar_t* input_ptr = (scalar_t*)(inputs[j].data_ptr) + i * local_inner;
-      if (local_inner < Vec::size()) {
-        #ifndef _MSC_VER
-        # pragma unroll
-        #endif
-        for (int64_t k = 0; k < local_inner; k++) {
-          result_ptr[k] = input_ptr[k];
-        }
-      } else {
-        vec256::map(
-            [](Vec x) { return x; },
-            result_ptr,
-            input_ptr,
-            local_inner);
+void copy_row(
+    char* dst, const char* src, int64_t n, int64_t dst_stride, int64_t src_stride,
+    int64_t element_size) {
+  if (dst_stride == element_size && src_stride == element_size) {
+    std::memcpy(dst, src, n * element_size);
+    return;
+  }
+  switch (element_size) {
+    case 1: copy_strided_row<uint8_t>(dst, src, n, dst_stride, src_stride); break;
+    case 2: copy_strided_row<uint16_t>(dst, src, n, dst_stride, src_stride); break;
+    case 4: copy_strided_row<uint32_t>(dst, src, n, dst_stride, src_stride); break;
+    case 8: copy_strided_row<uint64_t>(dst, src, n, dst_stride, src_stride); break;
+    default:
+      for (int64_t i = 0; i < n; i++) {
+        std::memcpy(dst + i * dst_stride, src + i * src_stride, element_size);
       }
-      result_ptr += local_inner;
+  }
+}
+
+// Copies rows [begin, end) of one input. The position in the outer
+// dimensions is decomposed once and then advanced like an odometer.
+void copy_rows(const CatInputPlan& plan, int64_t begin, int64_t end, int64_t element_size) {
+  const int64_t ndim = plan.sizes.size();
+  c10::SmallVector<int64_t, 5> counter(ndim);
+  int64_t src_offset = 0;
+  int64_t dst_offset = 0;
+  int64_t linear = begin;
+  for (int64_t d = 0; d < ndim; d++) {
+    counter[d] = linear % plan.sizes[d];
+    linear /= plan.sizes[d];
+    src_offset += counter[d] * plan.src_strides[d];
+    dst_offset += counter[d] * plan.dst_strides[d];
+  }
+  for (int64_t row = begin; row < end; row++) {
+    copy_row(
+        plan.dst + dst_offset, plan.src + src_offset, plan.row_size,
+        plan.dst_row_stride, plan.src_row_stride, element_size);
+    for (int64_t d = 0; d < ndim; d++) {
+      src_offset += plan.src_strides[d];
+      dst_offset += plan.dst_strides[d];
+      if (++counter[d] < plan.sizes[d]) {
+        break;
+      }
+      src_offset -= plan.sizes[d] * plan.src_strides[d];
+      dst_offset -= plan.sizes[d] * plan.dst_strides[d];
+      counter[d] = 0;
     }
   }
 }
 
-void cat_serial_kernel(Tensor& result, TensorList tensors, int64_t dim) {
-  AT_DISPATCH_FLOATING_TYPES(result.scalar_type(), "cat_serial_kernel", [&]() {
-    cat_serial_kernel_impl<scalar_t>(result, tensors, dim);
+// Plans the copies of all inputs in one pass, then splits the rows of all
+// inputs together across the intra-op pool, so that many small inputs are
+// copied in parallel as well as a few large ones.
+void cat_kernel(Tensor& result, TensorList tensors, int64_t dim) {
+  const int64_t element_size = result.element_size();
+  const int64_t dst_dim_stride = result.stride(dim) * element_size;
+  const auto dim_order = result_dim_order(result);
+
+  std::vector<CatInputPlan> plans;
+  plans.reserve(tensors.size());
+  // first_row[i] is the index of the first row of plans[i] among all rows.
+  std::vector<int64_t> first_row;
+  first_row.reserve(tensors.size() + 1);
+  int64_t num_rows = 0;
+  int64_t numel = 0;
+  char* dst = static_cast<char*>(result.data_ptr());
+  for (auto const &tensor : tensors) {
+    if (tensor.numel() == 0) {
+      // Skipped size [0] inputs have fewer dimensions than the result.
+      if (tensor.dim() == result.dim()) {
+        dst += tensor.size(dim) * dst_dim_stride;
+      }
+      continue;
+    }
+    TORCH_INTERNAL_ASSERT(tensor.scalar_type() == result.scalar_type());
+    plans.push_back(plan_input(tensor, dst, result, dim_order));
+    first_row.push_back(num_rows);
+    num_rows += plans.back().num_rows;
+    numel += tensor.numel();
+    dst += tensor.size(dim) * dst_dim_stride;
+  }
+  first_row.push_back(num_rows);
+  if (num_rows == 0) {
+    return;
+  }
+
+  const int64_t grain_size = std::max<int64_t>(
+      1, at::internal::GRAIN_SIZE * num_rows / numel);
+  at::parallel_for(0, num_rows, grain_size, [&](int64_t begin, int64_t end) {
+    auto input = std::upper_bound(first_row.begin(), first_row.end(), begin) - first_row.begin() - 1;
+    for (int64_t row = begin; row < end; input++) {
+      const int64_t input_end = std::min(end, first_row[input + 1]);
+      copy_rows(plans[input], row - first_row[input], input_end - first_row[input], element_size);
+      row = input_end;
+    }
   });
 }
 
 } // anonymous namespace
 
-REGISTER_DISPATCH(cat_serial_stub, &cat_serial_kernel);
+REGISTER_DISPATCH(cat_stub, &cat_kernel);
 
 }} // at::native
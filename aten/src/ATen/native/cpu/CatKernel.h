@@ -5,7 +5,9 @@
 
 namespace at { namespace native {
 
-using cat_serial_fn = void(*)(Tensor &, TensorList, int64_t);
-DECLARE_DISPATCH(cat_serial_fn, cat_serial_stub);
+// Copies `tensors` into the already resized `result` along `dim`. All
+// non-empty inputs must have the dtype of `result`; any strides are allowed.
+using cat_fn = void(*)(Tensor &, TensorList, int64_t);
+DECLARE_DISPATCH(cat_fn, cat_stub);
 
 }}  // namespace at::native
@@ -1,6 +1,8 @@
 #include <ATen/ATen.h>
 
 #include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/intrinsics.h>
 #include <ATen/native/Copy.h>
 #include <ATen/native/TensorIterator.h>
 #include <ATen/native/cpu/Loops.h>
@@ -10,9 +12,264 @@ namespace at {
 namespace native {
 namespace {
 
+// Copies that transpose, like permute(...).contiguous() or conversions
+// between NCHW and NHWC, read or write with a large stride in the innermost
+// loop of TensorIterator. They are done instead by blocks of kTransposeBlock
+// x kTransposeBlock elements of the dimensions in which the destination and
+// the source are contiguous, which fit in the L1 cache, with the blocks of
+// 8x8 transposed in registers where possible.
+constexpr int64_t kTransposeBlock = 64;
+constexpr int64_t kTransposeMicroBlock = 8;
+
+// Copying is moving bytes, so elements are moved as unsigned integers of
+// their size.
+struct alignas(8) Bytes16 {
+  uint64_t data[2];
+};
+
+// dst[c * ld_dst + r] = src[r * ld_src + c] for the block of rows x cols.
+template <typename scalar_t>
+inline void transpose_block_scalar(
+    const scalar_t* src, int64_t ld_src, scalar_t* dst, int64_t ld_dst,
+    int64_t rows, int64_t cols) {
+  for (int64_t r = 0; r < rows; r++) {
+    for (int64_t c = 0; c < cols; c++) {
+      dst[c * ld_dst + r] = src[r * ld_src + c];
+    }
+  }
+}
+
+// Transposes the 8x8 block at src into dst in registers, for the types
+// with a vectorized transpose.
+template <typename scalar_t>
+struct Transpose8x8 {
+  static constexpr bool vectorized = false;
+  static void apply(const scalar_t* src, int64_t ld_src, scalar_t* dst, int64_t ld_dst) {}
+};
+
+#if (defined(CPU_CAPABILITY_AVX) || defined(CPU_CAPABILITY_AVX2)) && !defined(_MSC_VER)
+
+template <>
+struct Transpose8x8<uint32_t> {
+  static constexpr bool vectorized = true;
+  static void apply(const uint32_t* src, int64_t ld_src, uint32_t* dst, int64_t ld_dst);
+};
+
+inline void Transpose8x8<uint32_t>::apply(const uint32_t* src, int64_t ld_src, uint32_t* dst, int64_t ld_dst) {
+  // Lanes are only moved, never computed, so the float shuffles move any
+  // 32-bit value unchanged.
+  const float* s = reinterpret_cast<const float*>(src);
+  float* d = reinterpret_cast<float*>(dst);
+  __m256 r0 = _mm256_loadu_ps(s + 0 * ld_src);
+  __m256 r1 = _mm256_loadu_ps(s + 1 * ld_src);
+  __m256 r2 = _mm256_loadu_ps(s + 2 * ld_src);
+  __m256 r3 = _mm256_loadu_ps(s + 3 * ld_src);
+  __m256 r4 = _mm256_loadu_ps(s + 4 * ld_src);
+  __m256 r5 = _mm256_loadu_ps(s + 5 * ld_src);
+  __m256 r6 = _mm256_loadu_ps(s + 6 * ld_src);
+  __m256 r7 = _mm256_loadu_ps(s + 7 * ld_src);
+
+  // Interleave pairs of rows, then pairs of pairs, within the 128-bit lanes.
+  __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+  __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+  __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+  __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+  __m256 t4 = _mm256_unpacklo_ps(r4, r5);
+  __m256 t5 = _mm256_unpackhi_ps(r4, r5);
+  __m256 t6 = _mm256_unpacklo_ps(r6, r7);
+  __m256 t7 = _mm256_unpackhi_ps(r6, r7);
+  __m256 u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+  __m256 u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+  __m256 u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+  __m256 u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+  __m256 u4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+  __m256 u5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+  __m256 u6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+  __m256 u7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+  // Swap the 128-bit halves across the rows 0-3 and 4-7.
+  _mm256_storeu_ps(d + 0 * ld_dst, _mm256_permute2f128_ps(u0, u4, 0x20));
+  _mm256_storeu_ps(d + 1 * ld_dst, _mm256_permute2f128_ps(u1, u5, 0x20));
+  _mm256_storeu_ps(d + 2 * ld_dst, _mm256_permute2f128_ps(u2, u6, 0x20));
+  _mm256_storeu_ps(d + 3 * ld_dst, _mm256_permute2f128_ps(u3, u7, 0x20));
+  _mm256_storeu_ps(d + 4 * ld_dst, _mm256_permute2f128_ps(u0, u4, 0x31));
+  _mm256_storeu_ps(d + 5 * ld_dst, _mm256_permute2f128_ps(u1, u5, 0x31));
+  _mm256_storeu_ps(d + 6 * ld_dst, _mm256_permute2f128_ps(u2, u6, 0x31));
+  _mm256_storeu_ps(d + 7 * ld_dst, _mm256_permute2f128_ps(u3, u7, 0x31));
+}
+
+template <>
+struct Transpose8x8<uint8_t> {
+  static constexpr bool vectorized = true;
+  static void apply(const uint8_t* src, int64_t ld_src, uint8_t* dst, int64_t ld_dst);
+};
+
+inline void Transpose8x8<uint8_t>::apply(const uint8_t* src, int64_t ld_src, uint8_t* dst, int64_t ld_dst) {
+  __m128i r0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + 0 * ld_src));
+  __m128i r1 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + 1 * ld_src));
+  __m128i r2 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + 2 * ld_src));
+  __m128i r3 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + 3 * ld_src));
+  __m128i r4 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + 4 * ld_src));
+  __m128i r5 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + 5 * ld_src));
+  __m128i r6 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + 6 * ld_src));
+  __m128i r7 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + 7 * ld_src));
+
+  // Interleave the bytes of pairs of rows, then their 16-bit and 32-bit
+  // groups, so that every 64-bit half holds a column.
+  __m128i t0 = _mm_unpacklo_epi8(r0, r1);
+  __m128i t1 = _mm_unpacklo_epi8(r2, r3);
+  __m128i t2 = _mm_unpacklo_epi8(r4, r5);
+  __m128i t3 = _mm_unpacklo_epi8(r6, r7);
+  __m128i u0 = _mm_unpacklo_epi16(t0, t1);
+  __m128i u1 = _mm_unpackhi_epi16(t0, t1);
+  __m128i u2 = _mm_unpacklo_epi16(t2, t3);
+  __m128i u3 = _mm_unpackhi_epi16(t2, t3);
+  __m128i v0 = _mm_unpacklo_epi32(u0, u2);
+  __m128i v1 = _mm_unpackhi_epi32(u0, u2);
+  __m128i v2 = _mm_unpacklo_epi32(u1, u3);
+  __m128i v3 = _mm_unpackhi_epi32(u1, u3);
+
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 0 * ld_dst), v0);
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 1 * ld_dst), _mm_unpackhi_epi64(v0, v0));
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 2 * ld_dst), v1);
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 3 * ld_dst), _mm_unpackhi_epi64(v1, v1));
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 4 * ld_dst), v2);
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 5 * ld_dst), _mm_unpackhi_epi64(v2, v2));
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 6 * ld_dst), v3);
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 7 * ld_dst), _mm_unpackhi_epi64(v3, v3));
+}
+
+#endif
+
+template <typename scalar_t>
+inline void transpose_block(
+    const scalar_t* src, int64_t ld_src, scalar_t* dst, int64_t ld_dst,
+    int64_t rows, int64_t cols) {
+  constexpr int64_t kMicro = kTransposeMicroBlock;
+  const int64_t full_rows = rows - rows % kMicro;
+  const int64_t full_cols = cols - cols % kMicro;
+  if (!Transpose8x8<scalar_t>::vectorized || full_rows == 0 || full_cols == 0) {
+    transpose_block_scalar(src, ld_src, dst, ld_dst, rows, cols);
+    return;
+  }
+  for (int64_t r = 0; r < full_rows; r += kMicro) {
+    for (int64_t c = 0; c < full_cols; c += kMicro) {
+      Transpose8x8<scalar_t>::apply(src + r * ld_src + c, ld_src, dst + c * ld_dst + r, ld_dst);
+    }
+  }
+  // The columns right of the 8x8 blocks, then the rows below them.
+  transpose_block_scalar(
+      src + full_cols, ld_src, dst + full_cols * ld_dst, ld_dst,
+      full_rows, cols - full_cols);
+  transpose_block_scalar(
+      src + full_rows * ld_src, ld_src, dst + full_rows, ld_dst,
+      rows - full_rows, cols);
+}
+
+// The dimension of iter in which the source is contiguous, if the
+// destination is contiguous in the first one and the source is not, both
+// large enough to be worth transposing in blocks, or -1 otherwise.
+static int transposed_dim(const TensorIterator& iter) {
+  const int64_t element_size = iter.element_size(0);
+  if (iter.ndim() < 2 || iter.strides(0)[0] != element_size ||
+      iter.strides(1)[0] == element_size ||
+      iter.shape()[0] < kTransposeMicroBlock) {
+    return -1;
+  }
+  for (int dim = 1; dim < iter.ndim(); dim++) {
+    if (iter.strides(1)[dim] == element_size) {
+      return iter.shape()[dim] < kTransposeMicroBlock ? -1 : dim;
+    }
+  }
+  return -1;
+}
+
+template <typename scalar_t>
+void transpose_copy_kernel(TensorIterator& iter, int src_dim) {
+  const int64_t element_size = sizeof(scalar_t);
+  auto shape = iter.shape();
+  auto dst_strides = iter.strides(0);
+  auto src_strides = iter.strides(1);
+
+  // Blocks of the matrix of rows in dimension 0 and columns in src_dim, for
+  // every index of the other dimensions.
+  const int64_t rows = shape[0];
+  const int64_t cols = shape[src_dim];
+  const int64_t row_blocks = (rows + kTransposeBlock - 1) / kTransposeBlock;
+  const int64_t col_blocks = (cols + kTransposeBlock - 1) / kTransposeBlock;
+  const int64_t ld_src = src_strides[0] / element_size;
+  const int64_t ld_dst = dst_strides[src_dim] / element_size;
+  const int64_t num_matrices = iter.numel() / (rows * cols);
+  const int64_t num_blocks = num_matrices * row_blocks * col_blocks;
+
+  char* dst_base = reinterpret_cast<char*>(iter.data_ptr(0));
+  const char* src_base = reinterpret_cast<const char*>(iter.data_ptr(1));
+  const int64_t grain_size = std::max<int64_t>(
+      1, internal::GRAIN_SIZE / (kTransposeBlock * kTransposeBlock));
+  at::parallel_for(0, num_blocks, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t block = begin; block < end; block++) {
+      const int64_t col_block = block % col_blocks;
+      const int64_t row_block = (block / col_blocks) % row_blocks;
+      int64_t matrix = block / (col_blocks * row_blocks);
+
+      // The offsets of the matrix in the dimensions other than the two
+      // transposed ones.
+      int64_t dst_offset = 0;
+      int64_t src_offset = 0;
+      for (int dim = 1; dim < iter.ndim(); dim++) {
+        if (dim == src_dim) {
+          continue;
+        }
+        const int64_t index = matrix % shape[dim];
+        matrix /= shape[dim];
+        dst_offset += index * dst_strides[dim];
+        src_offset += index * src_strides[dim];
+      }
+
+      const int64_t r = row_block * kTransposeBlock;
+      const int64_t c = col_block * kTransposeBlock;
+      const auto* src = reinterpret_cast<const scalar_t*>(src_base + src_offset) + r * ld_src + c;
+      auto* dst = reinterpret_cast<scalar_t*>(dst_base + dst_offset) + c * ld_dst + r;
+      transpose_block(
+          src, ld_src, dst, ld_dst,
+          std::min(kTransposeBlock, rows - r), std::min(kTransposeBlock, cols - c));
+    }
+  });
+}
+
+// Copies iter in blocks if it transposes, returning false if it does not.
+static bool transpose_copy(TensorIterator& iter) {
+  const int src_dim = transposed_dim(iter);
+  if (src_dim < 0) {
+    return false;
+  }
+  switch (iter.element_size(0)) {
+    case 1:
+      transpose_copy_kernel<uint8_t>(iter, src_dim);
+      return true;
+    case 2:
+      transpose_copy_kernel<uint16_t>(iter, src_dim);
+      return true;
+    case 4:
+      transpose_copy_kernel<uint32_t>(iter, src_dim);
+      return true;
+    case 8:
+      transpose_copy_kernel<uint64_t>(iter, src_dim);
+      return true;
+    case 16:
+      transpose_copy_kernel<Bytes16>(iter, src_dim);
+      return true;
+    default:
+      return false;
+  }
+}
+
 static void copy_kernel(TensorIterator& iter, bool non_blocking) {
   ScalarType dtype = iter.dtype(0);
   if (dtype == iter.dtype(1)) {
+    if (transpose_copy(iter)) {
+      return;
+    }
     if (dtype == ScalarType::Half) {
       cpu_kernel(iter, [=](at::Half a) -> at::Half { return a; });
     } else if (dtype == ScalarType::BFloat16) {
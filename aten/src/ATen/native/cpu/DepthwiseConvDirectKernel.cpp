@@ -0,0 +1,265 @@
+#include <ATen/native/cpu/DepthwiseConvKernel.h>
+#include <ATen/ATen.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/vec256.h>
+
+#include <algorithm>
+
+namespace at {
+namespace native {
+namespace {
+
+using namespace vec256;
+using Vec = Vec256<float>;
+
+struct Arguments final {
+  int64_t channels;
+  int64_t in_rows;
+  int64_t in_cols;
+  int64_t pad_rows;
+  int64_t pad_cols;
+  int64_t out_rows;
+  int64_t out_cols;
+};
+
+// out[x] += w * in[x * Stride] for x in [0, count), where `in` has `in_count`
+// readable elements.
+template <int64_t Stride>
+inline void strided_axpy(
+    float* out,
+    const float* in,
+    float w,
+    int64_t count,
+    int64_t in_count);
+
+template <>
+inline void strided_axpy<1>(
+    float* out,
+    const float* in,
+    float w,
+    int64_t count,
+    int64_t /*in_count*/) {
+  const Vec w_vec(w);
+  int64_t x = 0;
+  for (; x + Vec::size() <= count; x += Vec::size()) {
+    fmadd(w_vec, Vec::loadu(in + x), Vec::loadu(out + x)).store(out + x);
+  }
+  for (; x < count; ++x) {
+    out[x] += w * in[x];
+  }
+}
+
+template <>
+inline void strided_axpy<2>(
+    float* out,
+    const float* in,
+    float w,
+    int64_t count,
+    int64_t in_count) {
+  const Vec w_vec(w);
+  int64_t x = 0;
+  // The even elements of two vectors of the input; the odd element after the
+  // last one used must be readable too.
+  for (; x + Vec::size() <= count && 2 * (x + Vec::size()) <= in_count;
+       x += Vec::size()) {
+    const auto even = deinterleave2(
+        Vec::loadu(in + 2 * x), Vec::loadu(in + 2 * x + Vec::size())).first;
+    fmadd(w_vec, even, Vec::loadu(out + x)).store(out + x);
+  }
+  for (; x < count; ++x) {
+    out[x] += w * in[2 * x];
+  }
+}
+
+// Convolves a plane of the input with a Kernel x Kernel filter, one row of the
+// output at a time: the row sums the taps of the filter that overlap the
+// input, each of them scaling a strided row of the input.
+template <int64_t Kernel, int64_t Stride>
+void depthwise_conv_plane(
+    const Arguments& args,
+    const float* input,
+    const float* weight,
+    float bias,
+    float* output) {
+  for (int64_t y = 0; y < args.out_rows; ++y) {
+    float* out_row = output + y * args.out_cols;
+    std::fill(out_row, out_row + args.out_cols, bias);
+    for (int64_t kh = 0; kh < Kernel; ++kh) {
+      const int64_t iy = y * Stride - args.pad_rows + kh;
+      if (iy < 0 || iy >= args.in_rows) {
+        continue;
+      }
+      const float* in_row = input + iy * args.in_cols;
+      for (int64_t kw = 0; kw < Kernel; ++kw) {
+        // The columns x of the output whose input column x * Stride + offset
+        // is within the row.
+        const int64_t offset = kw - args.pad_cols;
+        const int64_t begin = offset < 0 ? (Stride - 1 - offset) / Stride : 0;
+        const int64_t end = std::min(
+            args.out_cols, (args.in_cols - offset + Stride - 1) / Stride);
+        if (begin >= end) {
+          continue;
+        }
+        const int64_t in_begin = begin * Stride + offset;
+        strided_axpy<Stride>(
+            out_row + begin,
+            in_row + in_begin,
+            weight[kh * Kernel + kw],
+            end - begin,
+            args.in_cols - in_begin);
+      }
+    }
+  }
+}
+
+// Convolves a row of the output in channels last, vectorized over the
+// channels. `weight` holds the taps of the filter one after another, the
+// channels of a tap contiguous.
+template <int64_t Kernel, int64_t Stride>
+void depthwise_conv_row_channels_last(
+    const Arguments& args,
+    const float* input,
+    const float* weight,
+    const float* bias,
+    float* output,
+    int64_t y) {
+  const int64_t channels = args.channels;
+  const int64_t kh_begin = std::max<int64_t>(0, args.pad_rows - y * Stride);
+  const int64_t kh_end =
+      std::min<int64_t>(Kernel, args.in_rows + args.pad_rows - y * Stride);
+  for (int64_t x = 0; x < args.out_cols; ++x) {
+    const int64_t kw_begin = std::max<int64_t>(0, args.pad_cols - x * Stride);
+    const int64_t kw_end =
+        std::min<int64_t>(Kernel, args.in_cols + args.pad_cols - x * Stride);
+    float* out = output + x * channels;
+    for (int64_t c = 0; c < channels; c += Vec::size()) {
+      const int64_t count = std::min<int64_t>(Vec::size(), channels - c);
+      Vec acc = Vec::loadu(bias + c, count);
+      for (int64_t kh = kh_begin; kh < kh_end; ++kh) {
+        const int64_t iy = y * Stride - args.pad_rows + kh;
+        for (int64_t kw = kw_begin; kw < kw_end; ++kw) {
+          const int64_t ix = x * Stride - args.pad_cols + kw;
+          const float* in = input + (iy * args.in_cols + ix) * channels + c;
+          const float* w = weight + (kh * Kernel + kw) * channels + c;
+          acc = fmadd(Vec::loadu(w, count), Vec::loadu(in, count), acc);
+        }
+      }
+      acc.store(out + c, count);
+    }
+  }
+}
+
+template <int64_t Kernel, int64_t Stride>
+Tensor depthwise_conv(
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& bias,
+    const Arguments& args) {
+  const int64_t batch = input.size(0);
+  const int64_t in_channels = input.size(1);
+  const int64_t out_channels = weight.size(0);
+  const int64_t multiplier = out_channels / in_channels;
+  const Tensor bias_contig = bias.defined()
+      ? bias.contiguous()
+      : at::zeros({out_channels}, input.options());
+  const float* bias_data = bias_contig.data_ptr<float>();
+
+  const bool channels_last =
+      input.suggest_memory_format() == at::MemoryFormat::ChannelsLast &&
+      multiplier == 1;
+  if (channels_last) {
+    auto input_nhwc = input.contiguous(at::MemoryFormat::ChannelsLast);
+    auto output = at::empty(
+        {batch, out_channels, args.out_rows, args.out_cols},
+        input.options().memory_format(at::MemoryFormat::ChannelsLast));
+    // (C, 1, K, K) -> (K, K, C)
+    auto weight_hwc = weight.view({out_channels, Kernel * Kernel}).t().contiguous();
+    const float* input_data = input_nhwc.data_ptr<float>();
+    const float* weight_data = weight_hwc.data_ptr<float>();
+    float* output_data = output.data_ptr<float>();
+    const int64_t in_image = args.in_rows * args.in_cols * in_channels;
+    const int64_t out_row = args.out_cols * out_channels;
+    const int64_t grain_size = std::max<int64_t>(
+        1, at::internal::GRAIN_SIZE / (out_row * Kernel * Kernel));
+    at::parallel_for(
+        0, batch * args.out_rows, grain_size, [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            const int64_t n = i / args.out_rows;
+            const int64_t y = i % args.out_rows;
+            depthwise_conv_row_channels_last<Kernel, Stride>(
+                args,
+                input_data + n * in_image,
+                weight_data,
+                bias_data,
+                output_data + i * out_row,
+                y);
+          }
+        });
+    return output;
+  }
+
+  auto input_contig = input.contiguous();
+  auto weight_contig = weight.contiguous();
+  auto output = at::empty(
+      {batch, out_channels, args.out_rows, args.out_cols}, input.options());
+  const float* input_data = input_contig.data_ptr<float>();
+  const float* weight_data = weight_contig.data_ptr<float>();
+  float* output_data = output.data_ptr<float>();
+  const int64_t in_plane = args.in_rows * args.in_cols;
+  const int64_t out_plane = args.out_rows * args.out_cols;
+  const int64_t grain_size = std::max<int64_t>(
+      1, at::internal::GRAIN_SIZE / (out_plane * Kernel * Kernel));
+  at::parallel_for(
+      0, batch * out_channels, grain_size, [&](int64_t begin, int64_t end) {
+        for (int64_t k = begin; k < end; ++k) {
+          const int64_t n = k / out_channels;
+          const int64_t oc = k % out_channels;
+          const int64_t ic = oc / multiplier;
+          depthwise_conv_plane<Kernel, Stride>(
+              args,
+              input_data + (n * in_channels + ic) * in_plane,
+              weight_data + oc * Kernel * Kernel,
+              bias_data[oc],
+              output_data + k * out_plane);
+        }
+      });
+  return output;
+}
+
+Tensor _convolution_depthwise(
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& bias,
+    const IntArrayRef stride,
+    const IntArrayRef padding) {
+  const int64_t kernel = weight.size(2);
+  Arguments args;
+  args.channels = input.size(1);
+  args.in_rows = input.size(2);
+  args.in_cols = input.size(3);
+  args.pad_rows = padding[0];
+  args.pad_cols = padding[1];
+  args.out_rows = (args.in_rows + 2 * args.pad_rows - kernel) / stride[0] + 1;
+  args.out_cols = (args.in_cols + 2 * args.pad_cols - kernel) / stride[1] + 1;
+
+  if (kernel == 3 && stride[0] == 1) {
+    return depthwise_conv<3, 1>(input, weight, bias, args);
+  } else if (kernel == 3 && stride[0] == 2) {
+    return depthwise_conv<3, 2>(input, weight, bias, args);
+  } else if (kernel == 5 && stride[0] == 1) {
+    return depthwise_conv<5, 1>(input, weight, bias, args);
+  } else if (kernel == 5 && stride[0] == 2) {
+    return depthwise_conv<5, 2>(input, weight, bias, args);
+  }
+  TORCH_CHECK(
+      false,
+      "Depthwise convolution only supports 3x3 and 5x5 filters of stride 1 or 2, got ",
+      weight.sizes(), " and stride ", stride);
+}
+
+}  // namespace
+
+REGISTER_DISPATCH(convolution_depthwise_stub, &_convolution_depthwise);
+
+}  // namespace native
+}  // namespace at
@@ -15,5 +15,15 @@ using convolution_depthwise3x3_winograd_fn =
 
 DECLARE_DISPATCH(convolution_depthwise3x3_winograd_fn, convolution_depthwise3x3_winograd_stub);
 
+/*
+  Direct depthwise 3x3 and 5x5 convolution operator, of stride 1 or 2, for
+  float tensors in NCHW or channels last (input, weight, bias, stride, padding)
+*/
+
+using convolution_depthwise_fn =
+    Tensor (*)(const Tensor &, const Tensor &, const Tensor &, IntArrayRef, IntArrayRef);
+
+DECLARE_DISPATCH(convolution_depthwise_fn, convolution_depthwise_stub);
+
 }  // namespace native
 }  // namespace at
@@ -2,9 +2,15 @@
 
 #include <ATen/Dispatch.h>
 #include <ATen/CPUApplyUtils.h>
+#include <ATen/CPUGeneratorImpl.h>
+#include <ATen/Parallel.h>
 #include <ATen/core/DistributionsHelper.h>
+#include <ATen/core/PhiloxRNGEngine.h>
+#include <ATen/cpu/vec256/functional.h>
+#include <ATen/cpu/vec256/vec256.h>
 #include <ATen/native/TensorIterator.h>
 #include <ATen/native/cpu/Loops.h>
+#include <algorithm>
 #include <limits>
 #include <mutex>
 
@@ -19,6 +25,73 @@ namespace templates {
 namespace cpu {
 namespace {
 
+// ==================================================== Philox ========================================================
+
+// See CPUGeneratorImpl::philox_mode. Other generators, e.g. the custom RNGs
+// of cpu_rng_test.cpp, always draw from their engine.
+template<typename RNG>
+bool use_philox(RNG generator) {
+  return false;
+}
+
+inline bool use_philox(CPUGeneratorImpl* generator) {
+  return generator->philox_mode();
+}
+
+// The key of the Philox stream of one kernel call.
+template<typename RNG>
+uint64_t philox_key(RNG generator) {
+  // See Note [Acquire lock when using random generators]
+  std::lock_guard<std::mutex> lock(generator->mutex_);
+  return generator->random64();
+}
+
+// The elements of a tensor are generated in blocks of this many elements.
+constexpr int64_t kPhiloxBlock = 256;
+
+// Writes the n 32 bit outputs of the Philox stream of `key` that start at
+// output `first`.
+inline void philox_outputs(uint64_t key, uint64_t first, int64_t n, uint32_t* outputs) {
+  at::Philox4_32_10 engine(key, /*subsequence=*/0, /*offset=*/first / 4);
+  for (uint64_t i = 0; i < first % 4; ++i) {
+    engine();
+  }
+  for (int64_t i = 0; i < n; ++i) {
+    outputs[i] = engine();
+  }
+}
+
+inline uint64_t philox_output64(const uint32_t* outputs) {
+  return (static_cast<uint64_t>(outputs[0]) << 32) | outputs[1];
+}
+
+// Fills `self` in parallel, element i from the `words` outputs of the Philox
+// stream of `key` that start at output i * words. `fill(outputs, data, n)`
+// computes n elements of a block from its outputs. The blocks are made of
+// whole groups of `group` elements, and the outputs of the last block cover
+// its last group even past the end of `self`, for kernels that compute a
+// group of elements at once.
+template <typename scalar_t, int64_t words, int64_t group = 1, typename func_t>
+void philox_fill(Tensor& self, uint64_t key, const func_t& fill) {
+  static_assert(kPhiloxBlock % group == 0, "Philox blocks must hold whole groups");
+  Tensor result = self.is_contiguous() ? self : at::empty(self.sizes(), self.options());
+  scalar_t* data = result.data_ptr<scalar_t>();
+  const int64_t numel = result.numel();
+  const int64_t num_groups = (numel + group - 1) / group;
+  at::parallel_for(0, num_groups, at::internal::GRAIN_SIZE / group, [&](int64_t begin, int64_t end) {
+    uint32_t outputs[kPhiloxBlock * words];
+    for (int64_t g = begin; g < end; g += kPhiloxBlock / group) {
+      const int64_t first = g * group;
+      const int64_t groups = std::min(kPhiloxBlock / group, end - g);
+      philox_outputs(key, first * words, groups * group * words, outputs);
+      fill(outputs, data + first, std::min(groups * group, numel - first));
+    }
+  });
+  if (!result.is_same(self)) {
+    self.copy_(result);
+  }
+}
+
 // ==================================================== Random ========================================================
 
 template<typename RNG>
@@ -170,9 +243,52 @@ void normal_fill(Tensor& self, const scalar_t mean, const scalar_t std, RNG gene
   }
 }
 
+// Box-Muller transforms of groups of 2 * Vec256<scalar_t>::size() uniforms,
+// the first half of each group giving the radii and the second the angles.
+template <typename scalar_t>
+void normal_fill_philox(Tensor& self, const scalar_t mean, const scalar_t std, uint64_t key) {
+  using Vec = vec256::Vec256<scalar_t>;
+  constexpr int64_t words = std::is_same<scalar_t, double>::value ? 2 : 1;
+  constexpr int64_t half = Vec::size();
+  philox_fill<scalar_t, words, 2 * half>(self, key, [&](const uint32_t* outputs, scalar_t* data, int64_t n) {
+    scalar_t buffer[kPhiloxBlock];
+    const int64_t padded = (n + 2 * half - 1) / (2 * half) * (2 * half);
+    for (int64_t i = 0; i < padded; ++i) {
+      buffer[i] = words == 2
+          ? transformation::uniform_real<scalar_t>(philox_output64(outputs + 2 * i), 0, 1)
+          : transformation::uniform_real<scalar_t>(outputs[i], 0, 1);
+    }
+    const Vec one(1), minus_two(-2), two_pi(2.0 * M_PI), mean_v(mean), std_v(std);
+    for (int64_t i = 0; i < padded; i += 2 * half) {
+      const Vec u1 = one - Vec::loadu(buffer + i); // [0, 1) -> (0, 1] for log.
+      const Vec u2 = Vec::loadu(buffer + i + half);
+      const Vec radius = (minus_two * u1.log()).sqrt();
+      const Vec theta = two_pi * u2;
+      (radius * theta.cos() * std_v + mean_v).store(buffer + i);
+      (radius * theta.sin() * std_v + mean_v).store(buffer + i + half);
+    }
+    std::copy(buffer, buffer + n, data);
+  });
+}
+
 template<typename RNG>
 void normal_kernel(Tensor& self, double mean, double std, RNG generator) {
   auto size = self.numel();
+  if (use_philox(generator)) {
+    const uint64_t key = philox_key(generator);
+    if (self.scalar_type() == ScalarType::Double) {
+      normal_fill_philox<double>(self, mean, std, key);
+    } else if (self.scalar_type() == ScalarType::Float) {
+      normal_fill_philox<float>(self, static_cast<float>(mean), static_cast<float>(std), key);
+    } else {
+      AT_DISPATCH_FLOATING_TYPES_AND_HALF(self.scalar_type(), "normal_kernel_cpu", [&] {
+        Tensor result = at::empty(self.sizes(), self.options().dtype(kFloat));
+        normal_fill_philox<float>(result, static_cast<float>(mean), static_cast<float>(std), key);
+        self.copy_(result);
+      });
+    }
+    return;
+  }
   if (self.scalar_type() == ScalarType::Float && size >= 16 && self.is_contiguous()) {
 #ifdef CPU_CAPABILITY_AVX2
     normal_fill_AVX2(self, static_cast<float>(mean), static_cast<float>(std), generator);
@@ -206,8 +322,45 @@ struct NormalKernel {
 
 // ==================================================== Uniform =======================================================
 
+template <typename scalar_t>
+void uniform_fill_philox(Tensor& self, const scalar_t from, const scalar_t to, uint64_t key) {
+  constexpr int64_t words = std::is_same<scalar_t, double>::value ? 2 : 1;
+  philox_fill<scalar_t, words>(self, key, [&](const uint32_t* outputs, scalar_t* data, int64_t n) {
+    for (int64_t i = 0; i < n; ++i) {
+      data[i] = static_cast<scalar_t>(words == 2
+          ? transformation::uniform_real<scalar_t>(philox_output64(outputs + 2 * i), from, to)
+          : transformation::uniform_real<scalar_t>(outputs[i], from, to));
+    }
+  });
+}
+
+// The float conversion of transformation::uniform_real, vectorized.
+template <>
+void uniform_fill_philox<float>(Tensor& self, const float from, const float to, uint64_t key) {
+  using Vec = vec256::Vec256<float>;
+  constexpr int digits = std::numeric_limits<float>::digits;
+  const Vec scale(static_cast<float>(to - from) / (1 << digits));
+  const Vec from_v(from);
+  philox_fill<float, 1>(self, key, [&](const uint32_t* outputs, float* data, int64_t n) {
+    int32_t bits[kPhiloxBlock];
+    for (int64_t i = 0; i < n; ++i) {
+      bits[i] = static_cast<int32_t>(outputs[i] & ((1u << digits) - 1));
+    }
+    vec256::convert(bits, data, n);
+    vec256::map([&](Vec x) { return x * scale + from_v; }, data, data, n);
+  });
+}
+
 template<typename RNG>
 void uniform_kernel(TensorIterator& iter, double from_, double to_, RNG generator) {
+  if (use_philox(generator)) {
+    const uint64_t key = philox_key(generator);
+    Tensor self = iter.output();
+    AT_DISPATCH_FLOATING_TYPES_AND2(at::ScalarType::Half, at::ScalarType::BFloat16, iter.dtype(), "uniform_kernel_cpu", [&]() {
+      uniform_fill_philox<scalar_t>(self, static_cast<scalar_t>(from_), static_cast<scalar_t>(to_), key);
+    });
+    return;
+  }
   AT_DISPATCH_FLOATING_TYPES_AND2(at::ScalarType::Half, at::ScalarType::BFloat16, iter.dtype(), "uniform_kernel_cpu", [&]() {
     std::lock_guard<std::mutex> lock(generator->mutex_);
     auto from = static_cast<scalar_t>(from_);
@@ -339,6 +492,18 @@ void bernoulli_kernel(Tensor& self, const Tensor& p_, RNG generator) {
 
 template<typename RNG>
 void bernoulli_kernel(Tensor& self, double p, RNG generator) {
+  if (use_philox(generator)) {
+    const uint64_t key = philox_key(generator);
+    AT_DISPATCH_ALL_TYPES_AND(at::ScalarType::Bool, self.scalar_type(), "bernoulli_scalar_cpu_", [&] {
+      philox_fill<scalar_t, 2>(self, key, [p](const uint32_t* outputs, scalar_t* data, int64_t n) {
+        for (int64_t i = 0; i < n; ++i) {
+          const double u = transformation::uniform_real<double>(philox_output64(outputs + 2 * i), 0.0, 1.0);
+          data[i] = static_cast<scalar_t>(transformation::bernoulli<double>(u, p));
+        }
+      });
+    });
+    return;
+  }
   AT_DISPATCH_ALL_TYPES_AND(at::ScalarType::Bool, self.scalar_type(), "bernoulli_scalar_cpu_", [&] {
     // See Note [Acquire lock when using random generators]
     std::lock_guard<std::mutex> lock(generator->mutex_);
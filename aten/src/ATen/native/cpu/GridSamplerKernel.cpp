@@ -9,6 +9,7 @@
 #include <c10/util/C++17.h>
 
 #include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <type_traits>
 
@@ -886,6 +887,104 @@ static inline void grid_sample_2d_grid_slice_iterator(
   }
 }
 
+// ~~~~~~~~~~~~~~~~~~~~~~ Channels Last Grid Sample ~~~~~~~~~~~~~~~~~~~~~~~~~~
+// With a channels last input, the values of all the channels of a pixel are
+// contiguous, while gathering the values of a channel for a vector of
+// locations would touch a cache line per location. So the locations are
+// computed one at a time, and the interpolation is vectorized over the
+// channels instead. The output is channels last too.
+
+template<typename scalar_t>
+static void grid_sample_2d_channels_last(
+    Tensor& output, const Tensor& input, const Tensor& grid,
+    GridSamplerInterpolation interpolation_mode,
+    GridSamplerPadding padding_mode, bool align_corners) {
+  using Vec = Vec256<scalar_t>;
+  int64_t N = input.size(0);
+  int64_t C = input.size(1);
+  int64_t inp_H = input.size(2);
+  int64_t inp_W = input.size(3);
+  int64_t out_H = grid.size(1);
+  int64_t out_W = grid.size(2);
+  int64_t grid_sN = grid.stride(0);
+  int64_t grid_sH = grid.stride(1);
+  int64_t grid_sW = grid.stride(2);
+  int64_t grid_sCoor = grid.stride(3);
+  const scalar_t* inp_ptr = input.data_ptr<scalar_t>();
+  const scalar_t* grid_ptr = grid.data_ptr<scalar_t>();
+  scalar_t* out_ptr = output.data_ptr<scalar_t>();
+
+  // Sums the values of the `num` pixels at `corners` weighted by `weights`
+  // into the pixel at `out`.
+  auto interpolate = [C](scalar_t* out, const scalar_t* const* corners,
+                         const scalar_t* weights, int64_t num) {
+    int64_t c = 0;
+    for (; c < C - (C % Vec::size()); c += Vec::size()) {
+      Vec acc(0);
+      for (int64_t i = 0; i < num; i++) {
+        acc = fmadd(Vec(weights[i]), Vec::loadu(corners[i] + c), acc);
+      }
+      acc.store(out + c);
+    }
+    for (; c < C; c++) {
+      scalar_t acc = 0;
+      for (int64_t i = 0; i < num; i++) {
+        acc += weights[i] * corners[i][c];
+      }
+      out[c] = acc;
+    }
+  };
+
+  auto grain_size = std::max(
+      at::internal::GRAIN_SIZE / std::max(out_W * C * 4, (int64_t)1), (int64_t)1);
+  parallel_for(0, N * out_H, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t nh = begin; nh < end; nh++) {
+      int64_t n = nh / out_H;
+      int64_t h = nh % out_H;
+      const scalar_t* inp_slice = inp_ptr + n * inp_H * inp_W * C;
+      const scalar_t* grid_row = grid_ptr + n * grid_sN + h * grid_sH;
+      scalar_t* out_row = out_ptr + nh * out_W * C;
+      for (int64_t w = 0; w < out_W; w++) {
+        scalar_t x = grid_sampler_compute_source_index(
+            grid_row[w * grid_sW], inp_W, padding_mode, align_corners);
+        scalar_t y = grid_sampler_compute_source_index(
+            grid_row[w * grid_sW + grid_sCoor], inp_H, padding_mode, align_corners);
+        scalar_t* out = out_row + w * C;
+
+        const scalar_t* corners[4];
+        scalar_t weights[4];
+        int64_t num = 0;
+        if (interpolation_mode == GridSamplerInterpolation::Bilinear) {
+          int64_t ix_w = static_cast<int64_t>(std::floor(x));
+          int64_t iy_n = static_cast<int64_t>(std::floor(y));
+          scalar_t e = ix_w + 1 - x;
+          scalar_t s = iy_n + 1 - y;
+          const int64_t ixs[4] = {ix_w, ix_w + 1, ix_w, ix_w + 1};
+          const int64_t iys[4] = {iy_n, iy_n, iy_n + 1, iy_n + 1};
+          const scalar_t ws[4] = {
+              e * s, (1 - e) * s, e * (1 - s), (1 - e) * (1 - s)};
+          for (int64_t i = 0; i < 4; i++) {
+            if (within_bounds_2d(iys[i], ixs[i], inp_H, inp_W)) {
+              corners[num] = inp_slice + (iys[i] * inp_W + ixs[i]) * C;
+              weights[num] = ws[i];
+              num++;
+            }
+          }
+        } else {
+          int64_t ix = static_cast<int64_t>(std::nearbyint(x));
+          int64_t iy = static_cast<int64_t>(std::nearbyint(y));
+          if (within_bounds_2d(iy, ix, inp_H, inp_W)) {
+            corners[0] = inp_slice + (iy * inp_W + ix) * C;
+            weights[0] = 1;
+            num = 1;
+          }
+        }
+        interpolate(out, corners, weights, num);
+      }
+    }
+  });
+}
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~ Grid Sample Kernels ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // Use the structs & functions defined above to calculate grid sample forward
 // and backward.
@@ -897,6 +996,18 @@ Tensor grid_sampler_2d_cpu_kernel_impl(const Tensor& input, const Tensor& grid,
   auto N = input.size(0);
   auto H = grid.size(1);
   auto W = grid.size(2);
+  if (input.is_contiguous(MemoryFormat::ChannelsLast) && !input.is_contiguous()) {
+    auto output = at::empty(
+        {N, input.size(1), H, W},
+        input.options().memory_format(MemoryFormat::ChannelsLast));
+    AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "grid_sampler_2d_channels_last", [&] {
+      grid_sample_2d_channels_last<scalar_t>(
+          output, input, grid,
+          static_cast<GridSamplerInterpolation>(interpolation_mode),
+          static_cast<GridSamplerPadding>(padding_mode), align_corners);
+    });
+    return output;
+  }
   auto output = at::empty({N, input.size(1), H, W}, input.options());
   auto spatial_size = H * W;
   auto grain_size = spatial_size == 0 ? (N + 1)
@@ -1,7 +1,10 @@
 #include <ATen/native/TensorAdvancedIndexing.h>
 
 #include <cmath>
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include <type_traits>
 #include <ATen/Dispatch.h>
 #include <ATen/native/TensorIterator.h>
 #include <ATen/Parallel.h>
@@ -97,12 +100,105 @@ void cpu_index_kernel(TensorIterator& iter, IntArrayRef index_size, IntArrayRef
   }
 }
 
+// Number of elements whose source offsets are computed before they are
+// gathered, see gather_block.
+constexpr int64_t kGatherBlockSize = 64;
+
+template <typename scalar_t>
+using is_gather_vectorized = std::integral_constant<bool,
+    std::is_same<scalar_t, float>::value || std::is_same<scalar_t, double>::value>;
+
+// Copies src[offsets[i]] to dst[i] for the n <= kGatherBlockSize elements of
+// a block. Float and double use vector gathers (vpgather on AVX2), which take
+// element offsets of the same width as the element.
+template <typename scalar_t,
+          typename std::enable_if<is_gather_vectorized<scalar_t>::value, int>::type = 0>
+void gather_block(scalar_t* dst, const scalar_t* src, const int64_t* offsets, int64_t n) {
+  using Vec = Vec256<scalar_t>;
+  using offset_t = int_same_size_t<scalar_t>;
+  offset_t narrow_offsets[kGatherBlockSize];
+  for (int64_t i = 0; i < n; i++) {
+    narrow_offsets[i] = static_cast<offset_t>(offsets[i]);
+  }
+  int64_t i = 0;
+  for (; i + Vec::size() <= n; i += Vec::size()) {
+    auto vindex = Vec256<offset_t>::loadu(narrow_offsets + i);
+    gather<sizeof(scalar_t)>(src, vindex).store(dst + i);
+  }
+  for (; i < n; i++) {
+    dst[i] = src[offsets[i]];
+  }
+}
+
+template <typename scalar_t,
+          typename std::enable_if<!is_gather_vectorized<scalar_t>::value, int>::type = 0>
+void gather_block(scalar_t* dst, const scalar_t* src, const int64_t* offsets, int64_t n) {
+  for (int64_t i = 0; i < n; i++) {
+    dst[i] = src[offsets[i]];
+  }
+}
+
+// index() is a pure gather, so unlike cpu_index_kernel it can copy whole rows
+// when every element of the inner loop uses the same index, and gather
+// blocks of elements into a contiguous output otherwise.
+template <typename scalar_t>
+void cpu_index_copy_kernel(TensorIterator& iter, IntArrayRef index_size, IntArrayRef index_stride) {
+  int ntensor = iter.ntensors();
+  // See cpu_index_kernel
+  const int index_parallel_grain_size = 3000;
+
+  // Vector gathers take offsets as wide as the element, so the float path
+  // needs every source offset to fit in 32 bits.
+  int64_t max_index_offset = 0;
+  for (size_t j = 0; j < index_size.size(); j++) {
+    max_index_offset += (index_size[j] - 1) * std::abs(index_stride[j]);
+  }
+
+  auto loop = [&](char** data, const int64_t* strides, int64_t n) {
+    auto indexer = Indexer(ntensor - 2, &data[2], &strides[2], index_size, index_stride);
+    char* dst = data[0];
+    char* src = data[1];
+    const bool contiguous_dst = strides[0] == sizeof(scalar_t);
+    if (is_constant_index(ntensor, strides)) {
+      // specialization for when every element uses the same index
+      int64_t offset = indexer.get(0);
+      if (contiguous_dst && strides[1] == sizeof(scalar_t)) {
+        std::memcpy(dst, src + offset, n * sizeof(scalar_t));
+      } else {
+        for (int64_t i = 0; i < n; i++) {
+          *(scalar_t*)(dst + strides[0] * i) = *(scalar_t*)(src + offset + strides[1] * i);
+        }
+      }
+      return;
+    }
+
+    const int64_t max_offset = max_index_offset + n * std::abs(strides[1]);
+    const bool offsets_fit = sizeof(scalar_t) >= sizeof(int64_t) ||
+        max_offset / static_cast<int64_t>(sizeof(scalar_t)) <= std::numeric_limits<int32_t>::max();
+    if (contiguous_dst && offsets_fit && strides[1] % sizeof(scalar_t) == 0) {
+      int64_t offsets[kGatherBlockSize];
+      for (int64_t begin = 0; begin < n; begin += kGatherBlockSize) {
+        const int64_t len = std::min(kGatherBlockSize, n - begin);
+        for (int64_t i = 0; i < len; i++) {
+          offsets[i] = (indexer.get(begin + i) + strides[1] * (begin + i)) / sizeof(scalar_t);
+        }
+        gather_block((scalar_t*)dst + begin, (const scalar_t*)src, offsets, len);
+      }
+      return;
+    }
+
+    for (int64_t i = 0; i < n; i++) {
+      int64_t offset = indexer.get(i);
+      *(scalar_t*)(dst + strides[0] * i) = *(scalar_t*)(src + strides[1] * i + offset);
+    }
+  };
+  iter.for_each(loop, index_parallel_grain_size);
+}
+
 void index_kernel(TensorIterator& iter, IntArrayRef index_size, IntArrayRef index_stride) {
   AT_DISPATCH_ALL_TYPES_AND_COMPLEX_AND3(at::ScalarType::Half, at::ScalarType::Bool, at::ScalarType::BFloat16,
     iter.dtype(), "index_cpu", [&] {
-    cpu_index_kernel<scalar_t>(iter, index_size, index_stride, [](char* dst, char* src, int64_t offset) {
-      *(scalar_t*)dst = *(scalar_t*)(src + offset);
-    });
+    cpu_index_copy_kernel<scalar_t>(iter, index_size, index_stride);
   });
 }
 
@@ -184,8 +184,9 @@ static inline void unroll_contiguous_scalar_checks(
   }
 }
 
+// `cost` is an optional per-element cost hint, see Note [Parallel cost hints]
 template <typename func_t>
-void cpu_kernel(TensorIterator& iter, func_t&& op) {
+void cpu_kernel(TensorIterator& iter, func_t&& op, const ParallelCost& cost = ParallelCost()) {
   using traits = function_traits<func_t>;
   // this could be extended to work with void return types
   TORCH_INTERNAL_ASSERT(iter.ninputs() == traits::arity);
@@ -202,12 +203,13 @@ void cpu_kernel(TensorIterator& iter, func_t&& op) {
         basic_loop(data, strides, 0, n, std::forward<func_t>(op));
       });
     }
-  });
+  }, cost);
   iter.cast_outputs();
 }
 
 template <bool check_dynamic_cast=true, typename func_t, typename vec_func_t>
-void cpu_kernel_vec(TensorIterator& iter, func_t&& op, vec_func_t&& vop) {
+void cpu_kernel_vec(TensorIterator& iter, func_t&& op, vec_func_t&& vop,
+                    const ParallelCost& cost = ParallelCost()) {
   using traits = function_traits<func_t>;
   // this could be extended to work with void return types
   TORCH_INTERNAL_ASSERT(iter.ninputs() == traits::arity);
@@ -231,7 +233,7 @@ void cpu_kernel_vec(TensorIterator& iter, func_t&& op, vec_func_t&& vop) {
         }
       });
     }
-  });
+  }, cost);
   iter.cast_outputs();
 }
 
@@ -0,0 +1,149 @@
+#include <ATen/native/RNN.h>
+
+#include <ATen/ATen.h>
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/vec256.h>
+
+namespace at {
+namespace native {
+
+namespace {
+
+using namespace vec256;
+
+template <typename scalar_t>
+inline Vec256<scalar_t> sigmoid(const Vec256<scalar_t>& x) {
+  const Vec256<scalar_t> one(scalar_t(1));
+  return one / (one + x.neg().exp());
+}
+
+template <typename scalar_t>
+inline Vec256<scalar_t> load(const scalar_t* ptr, int64_t count) {
+  using Vec = Vec256<scalar_t>;
+  return count == Vec::size() ? Vec::loadu(ptr) : Vec::loadu(ptr, count);
+}
+
+template <typename scalar_t>
+inline void store(const Vec256<scalar_t>& x, scalar_t* ptr, int64_t count) {
+  if (count == Vec256<scalar_t>::size()) {
+    x.store(ptr);
+  } else {
+    x.store(ptr, count);
+  }
+}
+
+// The rows of the batch a thread updates at least, in elements of the gates.
+constexpr int64_t kRNNCellGrainSize = 32768;
+
+// Calls f(row, j, count) for every vector of `count` hidden units starting at
+// unit j of every row of a batch, splitting the rows between threads.
+template <typename scalar_t, typename F>
+inline void parallel_for_hidden(int64_t batch_size, int64_t hidden_size, int64_t gates_per_unit, const F& f) {
+  using Vec = Vec256<scalar_t>;
+  const int64_t grain_size =
+      std::max<int64_t>(1, kRNNCellGrainSize / (gates_per_unit * hidden_size));
+  at::parallel_for(0, batch_size, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t row = begin; row < end; ++row) {
+      int64_t j = 0;
+      for (; j + Vec::size() <= hidden_size; j += Vec::size()) {
+        f(row, j, Vec::size());
+      }
+      if (j < hidden_size) {
+        f(row, j, hidden_size - j);
+      }
+    }
+  });
+}
+
+// i, f, g, o = sigmoid, sigmoid, tanh, sigmoid of the gates
+// cy = f * cx + i * g
+// hy = o * tanh(cy)
+template <typename scalar_t>
+void lstm_cell_kernel_impl(Tensor& hy, Tensor& cy, const Tensor& igates, const Tensor& hgates, const Tensor& cx) {
+  using Vec = Vec256<scalar_t>;
+  const int64_t batch_size = cx.size(0);
+  const int64_t hidden_size = cx.size(1);
+  TORCH_CHECK(
+      igates.size(0) == batch_size && igates.size(1) == 4 * hidden_size,
+      "lstm_cell: expected gates of size ", IntArrayRef{batch_size, 4 * hidden_size},
+      " for a cell state of size ", cx.sizes(), ", but got ", igates.sizes());
+  const auto igates_contig = igates.contiguous();
+  const auto hgates_contig = hgates.contiguous();
+  const auto cx_contig = cx.contiguous();
+  const scalar_t* igates_data = igates_contig.data_ptr<scalar_t>();
+  const scalar_t* hgates_data = hgates_contig.data_ptr<scalar_t>();
+  const scalar_t* cx_data = cx_contig.data_ptr<scalar_t>();
+  scalar_t* hy_data = hy.data_ptr<scalar_t>();
+  scalar_t* cy_data = cy.data_ptr<scalar_t>();
+
+  parallel_for_hidden<scalar_t>(batch_size, hidden_size, 4, [&](int64_t row, int64_t j, int64_t count) {
+    const scalar_t* ig = igates_data + row * 4 * hidden_size + j;
+    const scalar_t* hg = hgates_data + row * 4 * hidden_size + j;
+    const int64_t state = row * hidden_size + j;
+    const Vec ingate = sigmoid(load(ig, count) + load(hg, count));
+    const Vec forgetgate = sigmoid(
+        load(ig + hidden_size, count) + load(hg + hidden_size, count));
+    const Vec cellgate =
+        (load(ig + 2 * hidden_size, count) + load(hg + 2 * hidden_size, count)).tanh();
+    const Vec outgate = sigmoid(
+        load(ig + 3 * hidden_size, count) + load(hg + 3 * hidden_size, count));
+    const Vec c = forgetgate * load(cx_data + state, count) + ingate * cellgate;
+    store(c, cy_data + state, count);
+    store(outgate * c.tanh(), hy_data + state, count);
+  });
+}
+
+// r, z = sigmoid of the sums of the reset and input gates
+// n = tanh(in + r * hn)
+// hy = (hx - n) * z + n
+template <typename scalar_t>
+void gru_cell_kernel_impl(Tensor& hy, const Tensor& igates, const Tensor& hgates, const Tensor& hx) {
+  using Vec = Vec256<scalar_t>;
+  const int64_t batch_size = hx.size(0);
+  const int64_t hidden_size = hx.size(1);
+  TORCH_CHECK(
+      igates.size(0) == batch_size && igates.size(1) == 3 * hidden_size,
+      "gru_cell: expected gates of size ", IntArrayRef{batch_size, 3 * hidden_size},
+      " for a hidden state of size ", hx.sizes(), ", but got ", igates.sizes());
+  const auto igates_contig = igates.contiguous();
+  const auto hgates_contig = hgates.contiguous();
+  const auto hx_contig = hx.contiguous();
+  const scalar_t* igates_data = igates_contig.data_ptr<scalar_t>();
+  const scalar_t* hgates_data = hgates_contig.data_ptr<scalar_t>();
+  const scalar_t* hx_data = hx_contig.data_ptr<scalar_t>();
+  scalar_t* hy_data = hy.data_ptr<scalar_t>();
+
+  parallel_for_hidden<scalar_t>(batch_size, hidden_size, 3, [&](int64_t row, int64_t j, int64_t count) {
+    const scalar_t* ig = igates_data + row * 3 * hidden_size + j;
+    const scalar_t* hg = hgates_data + row * 3 * hidden_size + j;
+    const int64_t state = row * hidden_size + j;
+    const Vec reset_gate = sigmoid(load(ig, count) + load(hg, count));
+    const Vec input_gate = sigmoid(
+        load(ig + hidden_size, count) + load(hg + hidden_size, count));
+    const Vec new_gate = (load(ig + 2 * hidden_size, count) +
+                          reset_gate * load(hg + 2 * hidden_size, count)).tanh();
+    store((load(hx_data + state, count) - new_gate) * input_gate + new_gate,
+          hy_data + state, count);
+  });
+}
+
+void lstm_cell_kernel(Tensor& hy, Tensor& cy, const Tensor& igates, const Tensor& hgates, const Tensor& cx) {
+  AT_DISPATCH_FLOATING_TYPES(cx.scalar_type(), "lstm_cell_cpu", [&] {
+    lstm_cell_kernel_impl<scalar_t>(hy, cy, igates, hgates, cx);
+  });
+}
+
+void gru_cell_kernel(Tensor& hy, const Tensor& igates, const Tensor& hgates, const Tensor& hx) {
+  AT_DISPATCH_FLOATING_TYPES(hx.scalar_type(), "gru_cell_cpu", [&] {
+    gru_cell_kernel_impl<scalar_t>(hy, igates, hgates, hx);
+  });
+}
+
+} // namespace
+
+REGISTER_DISPATCH(lstm_cell_cpu_stub, &lstm_cell_kernel);
+REGISTER_DISPATCH(gru_cell_cpu_stub, &gru_cell_kernel);
+
+} // namespace native
+} // namespace at
@@ -3,6 +3,7 @@
 #include <algorithm>
 
 #include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
 #include <ATen/cpu/vec256/vec256.h>
 #include <ATen/native/ReduceOps.h>
 #include <ATen/native/ReduceOpsUtils.h>
@@ -18,12 +19,72 @@ namespace at { namespace native { namespace {
 
 using namespace vec256;
 
-template <typename scalar_t, typename func_t>
+// Lines of the scanned dimension longer than this are scanned in blocks of
+// this size in parallel, when that exposes more parallelism than scanning
+// the lines in parallel (see cpu_cum_base_kernel).
+constexpr int64_t kCumBlockSize = 16384;
+// Lines adjacent in memory are scanned together, this many at a time, so
+// that the inner loop runs over contiguous elements.
+constexpr int64_t kCumLanes = 64;
+
+// Scans `size` elements from `self_data` into `result_data`, starting from
+// the accumulated value `acc`, and returns the accumulated value.
+template <typename scalar_t, typename acc_t, typename op_t>
+static inline acc_t cum_scan_line(
+    scalar_t* result_data, int64_t result_dim_stride,
+    const scalar_t* self_data, int64_t self_dim_stride,
+    int64_t size, const op_t& op, acc_t acc) {
+  for (int64_t i = 0; i < size; ++i) {
+    acc = op(acc, static_cast<acc_t>(self_data[i * self_dim_stride]));
+    result_data[i * result_dim_stride] = static_cast<scalar_t>(acc);
+  }
+  return acc;
+}
+
+// Scans one long line in two passes over blocks of kCumBlockSize elements:
+// the first reduces every block in parallel, then the totals are scanned
+// serially, and the second pass scans every block in parallel starting from
+// the total of the blocks before it. The blocks only depend on the line
+// length, so the result does not depend on the number of threads.
+template <typename scalar_t, typename acc_t, typename op_t>
+static void cum_scan_line_blocked(
+    scalar_t* result_data, int64_t result_dim_stride,
+    const scalar_t* self_data, int64_t self_dim_stride,
+    int64_t size, const op_t& op, acc_t init_val) {
+  const int64_t num_blocks = (size + kCumBlockSize - 1) / kCumBlockSize;
+  std::vector<acc_t> offsets(num_blocks, init_val);
+  at::parallel_for(0, num_blocks - 1, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t b = begin; b < end; ++b) {
+      const scalar_t* block = self_data + b * kCumBlockSize * self_dim_stride;
+      acc_t total = init_val;
+      for (int64_t i = 0; i < kCumBlockSize; ++i) {
+        total = op(total, static_cast<acc_t>(block[i * self_dim_stride]));
+      }
+      offsets[b + 1] = total;
+    }
+  });
+  for (int64_t b = 1; b < num_blocks; ++b) {
+    offsets[b] = op(offsets[b - 1], offsets[b]);
+  }
+  at::parallel_for(0, num_blocks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t b = begin; b < end; ++b) {
+      const int64_t first = b * kCumBlockSize;
+      cum_scan_line<scalar_t>(
+        result_data + first * result_dim_stride, result_dim_stride,
+        self_data + first * self_dim_stride, self_dim_stride,
+        std::min(kCumBlockSize, size - first), op, offsets[b]);
+    }
+  });
+}
+
+// Computes the cumulative `op`, on values of type acc_t, of `self` along
+// `dim` into `result`.
+template <typename scalar_t, typename acc_t, typename op_t>
 static inline void cpu_cum_base_kernel(Tensor& result,
     const Tensor& self,
     int64_t dim,
-    const func_t& f,
-    scalar_t init_val) {
+    const op_t& op,
+    acc_t init_val) {
   if (result.sizes() != self.sizes()) {
     result.resize_as_(self);
   }
@@ -46,80 +107,92 @@ static inline void cpu_cum_base_kernel(Tensor& result,
 
   auto result_dim_stride = ensure_nonempty_stride(result, dim);
   auto self_dim_stride = ensure_nonempty_stride(self, dim);
+  const int64_t self_dim_size = ensure_nonempty_size(self, dim);
+  const int64_t num_lines = iter.numel();
+
+  // A few long lines, e.g. a 1-D scan: scan every line in parallel blocks.
+  if (self_dim_size > kCumBlockSize && self_dim_size / kCumBlockSize > num_lines) {
+    iter.serial_for_each([&](char** data, const int64_t* strides, int64_t n) {
+      for (int64_t i = 0; i < n; ++i) {
+        cum_scan_line_blocked<scalar_t>(
+          (scalar_t*)(data[0] + i * strides[0]), result_dim_stride,
+          (const scalar_t*)(data[1] + i * strides[1]), self_dim_stride,
+          self_dim_size, op, init_val);
+      }
+    }, {0, num_lines});
+    return;
+  }
 
+  // Otherwise scan the lines in parallel, with a grain size accounting for
+  // the length of the lines.
   auto loop = [&](char** data, const int64_t* strides, int64_t n) {
     auto* result_data_bytes = data[0];
     const auto* self_data_bytes = data[1];
 
-    for (int64_t i = 0; i < n; ++i) {
-      f(
-        (scalar_t*)result_data_bytes, result_dim_stride,
-        (scalar_t*)self_data_bytes, self_dim_stride, init_val
-      );
-      result_data_bytes += strides[0];
-      self_data_bytes += strides[1];
+    int64_t i = 0;
+    // Lines next to each other in memory, as when scanning a dimension other
+    // than the innermost of a contiguous tensor, are scanned rows first, so
+    // that both the inner loop and the memory accesses are contiguous.
+    if (strides[0] == sizeof(scalar_t) && strides[1] == sizeof(scalar_t)) {
+      acc_t acc[kCumLanes];
+      for (; i + 1 < n; i += kCumLanes) {
+        const int64_t lanes = std::min(kCumLanes, n - i);
+        auto* result_data = (scalar_t*)result_data_bytes + i;
+        const auto* self_data = (const scalar_t*)self_data_bytes + i;
+        std::fill(acc, acc + lanes, init_val);
+        for (int64_t k = 0; k < self_dim_size; ++k) {
+          for (int64_t j = 0; j < lanes; ++j) {
+            acc[j] = op(acc[j], static_cast<acc_t>(self_data[k * self_dim_stride + j]));
+            result_data[k * result_dim_stride + j] = static_cast<scalar_t>(acc[j]);
+          }
+        }
+      }
+    }
+    for (; i < n; ++i) {
+      cum_scan_line<scalar_t>(
+        (scalar_t*)(result_data_bytes + i * strides[0]), result_dim_stride,
+        (const scalar_t*)(self_data_bytes + i * strides[1]), self_dim_stride,
+        self_dim_size, op, init_val);
     }
   };
 
-  iter.for_each(loop);
+  iter.for_each(loop, std::max<int64_t>(1, at::internal::GRAIN_SIZE / self_dim_size));
 }
 
 static void cumsum_cpu_kernel(Tensor& result, const Tensor& self, int64_t dim) {
   auto wrap_dim = maybe_wrap_dim(dim, self.dim());
-  int64_t self_dim_size = ensure_nonempty_size(self, wrap_dim);
 
   AT_DISPATCH_ALL_TYPES_AND_COMPLEX(self.scalar_type(), "cumsum_out_cpu", [&] {
-    cpu_cum_base_kernel<scalar_t>(result, self, wrap_dim, [&] (
-      scalar_t* result_data, auto result_dim_stride,
-      const scalar_t* self_data, auto self_dim_stride, scalar_t init_val) {
-        auto cum_number = (at::acc_type<scalar_t, false>)init_val;
-        for (int64_t i = 0; i < self_dim_size; ++i) {
-          cum_number += self_data[i * self_dim_stride];
-          result_data[i * result_dim_stride] = (scalar_t)cum_number;
-        }
-      }, /*init_val=*/ 0
+    using acc_t = at::acc_type<scalar_t, false>;
+    cpu_cum_base_kernel<scalar_t>(result, self, wrap_dim,
+      [](acc_t acc, acc_t x) { return acc + x; },
+      /*init_val=*/ acc_t(0)
     );
   });
 }
 
 static void cumprod_cpu_kernel(Tensor& result, const Tensor& self, int64_t dim) {
   auto wrap_dim = maybe_wrap_dim(dim, self.dim());
-  int64_t self_dim_size = ensure_nonempty_size(self, wrap_dim);
 
   AT_DISPATCH_ALL_TYPES_AND_COMPLEX(self.scalar_type(), "cumprod_out_cpu", [&] {
-    cpu_cum_base_kernel<scalar_t>(result, self, wrap_dim, [&] (
-      scalar_t* result_data, auto result_dim_stride,
-      const scalar_t* self_data, auto self_dim_stride, scalar_t init_val) {
-        auto cum_number = (at::acc_type<scalar_t, false>)init_val;
-        for (int64_t i = 0; i < self_dim_size; ++i) {
-          cum_number *= self_data[i * self_dim_stride];
-          result_data[i * result_dim_stride] = (scalar_t)cum_number;
-        }
-      }, /*init_val=*/ 1
+    using acc_t = at::acc_type<scalar_t, false>;
+    cpu_cum_base_kernel<scalar_t>(result, self, wrap_dim,
+      [](acc_t acc, acc_t x) { return acc * x; },
+      /*init_val=*/ acc_t(1)
     );
   });
 }
 
 static void logcumsumexp_cpu_kernel(Tensor& result, const Tensor& self, int64_t dim) {
   auto wrap_dim = maybe_wrap_dim(dim, self.dim());
-  int64_t self_dim_size = ensure_nonempty_size(self, wrap_dim);
 
   AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "logcumsumexp_out_cpu", [&] {
-    cpu_cum_base_kernel<scalar_t>(result, self, wrap_dim, [&] (
-      scalar_t* result_data, auto result_dim_stride,
-      const scalar_t* self_data, auto self_dim_stride, scalar_t init_val) {
-        scalar_t cum_number = (at::acc_type<scalar_t, false>)init_val;
-        for (int64_t i = 0; i < self_dim_size; ++i) {
-          scalar_t x = self_data[i * self_dim_stride];
-
-          // Reference : https://www.tensorflow.org/api_docs/python/tf/math/cumulative_logsumexp
-          auto log_add_exp = [](scalar_t x, scalar_t y) -> scalar_t {
-            return std::log1p(std::exp(std::min(x, y) - std::max(x, y))) + std::max(x, y);
-          };
-          cum_number = log_add_exp(x, cum_number);
-          result_data[i * result_dim_stride] = static_cast<scalar_t>(cum_number);
-        }
-      }, /*init_val=*/ -std::numeric_limits<scalar_t>::infinity()
+    cpu_cum_base_kernel<scalar_t>(result, self, wrap_dim,
+      // Reference : https://www.tensorflow.org/api_docs/python/tf/math/cumulative_logsumexp
+      [](scalar_t acc, scalar_t x) -> scalar_t {
+        return std::log1p(std::exp(std::min(x, acc) - std::max(x, acc))) + std::max(x, acc);
+      },
+      /*init_val=*/ -std::numeric_limits<scalar_t>::infinity()
     );
   });
 }
@@ -157,6 +230,17 @@ static void std_var_kernel_impl(TensorIterator &iter, bool unbiased, bool take_s
   });
 }
 
+static void multi_reduce_kernel_impl(TensorIterator& iter) {
+  AT_DISPATCH_FLOATING_TYPES_AND2(kBFloat16, kHalf, iter.dtype(), "multi_reduce_cpu", [&] {
+    using acc_t = at::acc_type<scalar_t, /*is_cuda=*/false>;
+    binary_kernel_reduce(
+      iter,
+      MultiReduceOps<scalar_t, acc_t, std::tuple<scalar_t, scalar_t, scalar_t, scalar_t>> {},
+      MultiReduceData<acc_t>()
+    );
+  });
+}
+
 static void prod_kernel_impl(TensorIterator& iter) {
   AT_DISPATCH_ALL_TYPES_AND_COMPLEX(iter.dtype(), "prod_cpu", [&] {
     binary_kernel_reduce_vec(
@@ -309,6 +393,7 @@ static void argmin_kernel_impl(TensorIterator &iter) {
 
 REGISTER_DISPATCH(nansum_stub, &nansum_kernel_impl);
 REGISTER_DISPATCH(std_var_stub, &std_var_kernel_impl);
+REGISTER_DISPATCH(multi_reduce_stub, &multi_reduce_kernel_impl);
 REGISTER_DISPATCH(prod_stub, &prod_kernel_impl);
 REGISTER_DISPATCH(mean_stub, &mean_kernel_impl);
 REGISTER_DISPATCH(norm_stub, &norm_kernel_tensor_iterator_impl);
@@ -3,6 +3,10 @@
 #include <ATen/native/TensorIterator.h>
 #include <ATen/native/TensorAdvancedIndexing.h>
 #include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/vec256.h>
+
+#include <limits>
+#include <type_traits>
 
 namespace at { namespace native {
 
@@ -58,6 +62,53 @@ public:
 };
 static TensorAssign tensor_assign;
 
+template <typename scalar_t>
+using is_gather_vectorized = std::integral_constant<bool,
+    std::is_same<scalar_t, float>::value || std::is_same<scalar_t, double>::value>;
+
+// Gathers src[index[i] * src_dim_stride] into a contiguous run of `self`
+// with vector gathers, after checking a block of indices at a time.
+template <typename scalar_t,
+          typename std::enable_if<is_gather_vectorized<scalar_t>::value, int>::type = 0>
+void gather_dim_contiguous(
+    scalar_t* self_data, const int64_t* index_data, int64_t index_dim_stride,
+    const scalar_t* src_data, int64_t src_dim_stride,
+    int64_t dim, int64_t index_dim_size, int64_t index_upper_bound) {
+  using Vec = vec256::Vec256<scalar_t>;
+  using offset_t = vec256::int_same_size_t<scalar_t>;
+  constexpr int64_t kBlockSize = 64;
+  offset_t offsets[kBlockSize];
+  for (int64_t begin = 0; begin < index_dim_size; begin += kBlockSize) {
+    const int64_t len = std::min(kBlockSize, index_dim_size - begin);
+    for (int64_t i = 0; i < len; i++) {
+      int64_t idx_dim = index_data[(begin + i) * index_dim_stride];
+      TORCH_CHECK(idx_dim >= 0 && idx_dim < index_upper_bound,
+        "index ", index_data[(begin + i) * index_dim_stride],
+        " is out of bounds for dimension ", dim,
+        " with size ", index_upper_bound
+      );
+      offsets[i] = static_cast<offset_t>(idx_dim * src_dim_stride);
+    }
+    int64_t i = 0;
+    for (; i + Vec::size() <= len; i += Vec::size()) {
+      auto vindex = vec256::Vec256<offset_t>::loadu(offsets + i);
+      vec256::gather<sizeof(scalar_t)>(src_data, vindex).store(self_data + begin + i);
+    }
+    for (; i < len; i++) {
+      self_data[begin + i] = src_data[offsets[i]];
+    }
+  }
+}
+
+template <typename scalar_t,
+          typename std::enable_if<!is_gather_vectorized<scalar_t>::value, int>::type = 0>
+void gather_dim_contiguous(
+    scalar_t* self_data, const int64_t* index_data, int64_t index_dim_stride,
+    const scalar_t* src_data, int64_t src_dim_stride,
+    int64_t dim, int64_t index_dim_size, int64_t index_upper_bound) {
+  TORCH_INTERNAL_ASSERT(false, "gather_dim_contiguous is only used for float and double");
+}
+
 template <bool is_scatter_like = true>
 struct _cpu_scatter_gather_dim_loop {
   template <typename scalar_t, typename func_t>
@@ -70,6 +121,18 @@ struct _cpu_scatter_gather_dim_loop {
     func_t& f
   ) {
 
+    // gather into a contiguous output, as for gather along the last dim.
+    // Offsets must fit in the element-sized integers vector gathers take.
+    if (!is_scatter_like && std::is_same<func_t, TensorAssign>::value &&
+        is_gather_vectorized<scalar_t>::value && self_dim_stride == 1 &&
+        (sizeof(scalar_t) == sizeof(int64_t) ||
+         (index_upper_bound - 1) * src_dim_stride <= std::numeric_limits<int32_t>::max())) {
+      gather_dim_contiguous(
+        self_data, index_data, index_dim_stride, src_data, src_dim_stride,
+        dim, index_dim_size, index_upper_bound);
+      return;
+    }
+
     for (int64_t i = 0; i < index_dim_size; ++i) {
       int64_t idx_dim = index_data[i * index_dim_stride];
       // we are not putting idx_dim in the error message because it disables
@@ -334,7 +397,61 @@ void scatter_fill_cpu_kernel(Tensor& self, int64_t dim, const Tensor& index, Sca
     self, dim, index, value, "scatter_fill_cpu_", tensor_assign);
 }
 
+// scatter_add_ on 1-D tensors has no other dimension for TensorIterator to
+// parallelize over. When there are many more indices than outputs, every
+// thread accumulates its range of indices into a private copy of `self`, and
+// the copies are then summed into `self` in thread order.
+static bool scatter_add_1d_parallel(Tensor& self, int64_t dim, const Tensor& index, const Tensor& src) {
+  const int64_t num_threads = at::get_num_threads();
+  if (self.dim() > 1 || num_threads == 1 || at::in_parallel_region() ||
+      index.numel() < at::internal::GRAIN_SIZE ||
+      self.numel() > index.numel() / num_threads) {
+    return false;
+  }
+  dim = maybe_wrap_dim(dim, self.dim());
+  scatter_gather_dtype_check("scatter_add_", self, index, src);
+  scatter_shape_check(self, dim, index, src);
+
+  const int64_t self_size = ensure_nonempty_size(self, 0);
+  const int64_t self_stride = ensure_nonempty_stride(self, 0);
+  const int64_t index_size = ensure_nonempty_size(index, 0);
+  const int64_t index_stride = ensure_nonempty_stride(index, 0);
+  const int64_t src_stride = ensure_nonempty_stride(src, 0);
+  const int64_t* index_data = index.data_ptr<int64_t>();
+
+  AT_DISPATCH_ALL_TYPES_AND_COMPLEX_AND2(
+    ScalarType::Bool, ScalarType::Half, self.scalar_type(), "scatter_add_", [&] {
+      auto* self_data = self.data_ptr<scalar_t>();
+      auto* src_data = src.data_ptr<scalar_t>();
+      auto partials = at::zeros({num_threads, self_size}, self.options());
+      auto* partials_data = partials.data_ptr<scalar_t>();
+      at::parallel_for(0, index_size, at::internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+        scalar_t* partial = partials_data + at::get_thread_num() * self_size;
+        for (int64_t i = begin; i < end; i++) {
+          int64_t idx = index_data[i * index_stride];
+          TORCH_CHECK(idx >= 0 && idx < self_size,
+            "index ", index_data[i * index_stride],
+            " is out of bounds for dimension ", 0,
+            " with size ", self_size);
+          reduce_add(partial + idx, src_data + i * src_stride);
+        }
+      });
+      at::parallel_for(0, self_size, at::internal::GRAIN_SIZE / num_threads, [&](int64_t begin, int64_t end) {
+        for (int64_t j = begin; j < end; j++) {
+          for (int64_t t = 0; t < num_threads; t++) {
+            reduce_add(self_data + j * self_stride, partials_data + t * self_size + j);
+          }
+        }
+      });
+    }
+  );
+  return true;
+}
+
 void scatter_add_cpu_kernel(Tensor& self, int64_t dim, const Tensor& index, const Tensor& src) {
+  if (index.numel() > 0 && scatter_add_1d_parallel(self, dim, index, src)) {
+    return;
+  }
   cpu_scatter_gather_base_kernel<>()(
     self, dim, index, src,
     "scatter_add_", reduce_add);
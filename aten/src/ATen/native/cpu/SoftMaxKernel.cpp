@@ -6,8 +6,13 @@
 
 #include <ATen/Dispatch.h>
 #include <ATen/Parallel.h>
+#if defined(CPU_CAPABILITY_AVX512)
+#include <ATen/cpu/vec512/functional.h>
+#include <ATen/cpu/vec512/vec512.h>
+#else
 #include <ATen/cpu/vec256/functional.h>
 #include <ATen/cpu/vec256/vec256.h>
+#endif
 #include <c10/util/Optional.h>
 
 // [Note AVX-SSE transitions] In general we avoid calls into cmath for code
@@ -22,13 +27,24 @@
 namespace at { namespace native {
 namespace {
 
+// Use the full register width of the capability this file is compiled for.
+#if defined(CPU_CAPABILITY_AVX512)
+namespace vec = vec512;
+template <typename T>
+using Vectorized = vec512::Vec512<T>;
+#else
+namespace vec = vec256;
+template <typename T>
+using Vectorized = vec256::Vec256<T>;
+#endif
+
 template <typename scalar_t>
 inline void _vec_log_softmax_lastdim(
     scalar_t* input_data_base,
     scalar_t* output_data_base,
     int64_t outer_size,
     int64_t dim_size) {
-  using Vec = vec256::Vec256<scalar_t>;
+  using Vec = Vectorized<scalar_t>;
   static constexpr int64_t CHUNK_SIZE = (128 / sizeof(scalar_t)) * Vec::size();
   int64_t grain_size = internal::GRAIN_SIZE / (16 * dim_size * CHUNK_SIZE);
   if (grain_size < CHUNK_SIZE)
@@ -48,8 +64,8 @@ inline void _vec_log_softmax_lastdim(
           for (int64_t j = 0; j < loop_end; j++) {
             int64_t i = ii + j;
             scalar_t* input_data = input_data_base + i * dim_size;
-            max_input_arr[j] = vec256::reduce_all<scalar_t>(
-                [](Vec& x, Vec& y) { return vec256::maximum(x, y); },
+            max_input_arr[j] = vec::reduce_all<scalar_t>(
+                [](Vec& x, Vec& y) { return vec::maximum(x, y); },
                 input_data,
                 dim_size);
           }
@@ -57,7 +73,7 @@ inline void _vec_log_softmax_lastdim(
             int64_t i = ii + j;
             scalar_t* input_data = input_data_base + i * dim_size;
             scalar_t max_input = max_input_arr[j];
-            tmp_sum_scalar[j] = vec256::map_reduce_all<scalar_t>(
+            tmp_sum_scalar[j] = vec::map_reduce_all<scalar_t>(
                 [max_input](Vec x) { return (x - Vec(max_input)).exp(); },
                 [](Vec x, Vec y) { return x + y; },
                 input_data,
@@ -65,7 +81,7 @@ inline void _vec_log_softmax_lastdim(
           }
           // See [Note AVX-SSE transitions] for why this should call the
           // vectorized version (aside from perf improvements).
-          vec256::map(
+          vec::map(
               [](Vec x) { return x.log(); },
               tmp_sum_scalar,
               tmp_sum_scalar,
@@ -82,7 +98,7 @@ inline void _vec_log_softmax_lastdim(
             // is small, if we compute `max_input` plus `tmp_sum` before,
             // there would be a numerical problem. See an example in
             // https://github.com/pytorch/pytorch/issues/11752#issuecomment-422883379
-            vec256::map(
+            vec::map(
                 [tmp_sum, max_input](Vec x) { return x - Vec(max_input) - Vec(tmp_sum); },
                 output_data,
                 input_data,
@@ -98,7 +114,7 @@ inline void _vec_softmax_lastdim(
     scalar_t* output_data_base,
     int64_t outer_size,
     int64_t dim_size) {
-  using Vec = vec256::Vec256<scalar_t>;
+  using Vec = Vectorized<scalar_t>;
   int64_t grain_size = internal::GRAIN_SIZE / (16 * dim_size);
   if (grain_size < 1)
     grain_size = 1;
@@ -111,19 +127,19 @@ inline void _vec_softmax_lastdim(
         for (int64_t i = begin; i < end; i++) {
           scalar_t* input_data = input_data_base + i * dim_size;
           scalar_t* output_data = output_data_base + i * dim_size;
-          scalar_t max_input = vec256::reduce_all<scalar_t>(
-              [](Vec& x, Vec& y) { return vec256::maximum(x, y); },
+          scalar_t max_input = vec::reduce_all<scalar_t>(
+              [](Vec& x, Vec& y) { return vec::maximum(x, y); },
               input_data,
               dim_size);
-          vec256::map(
+          vec::map(
               [max_input](Vec x) { return (x - Vec(max_input)).exp(); },
               output_data,
               input_data,
               dim_size);
-          scalar_t tmp_sum = vec256::reduce_all<scalar_t>(
+          scalar_t tmp_sum = vec::reduce_all<scalar_t>(
               [](Vec x, Vec y) { return x + y; }, output_data, dim_size);
           tmp_sum = 1 / tmp_sum;
-          vec256::map(
+          vec::map(
               [tmp_sum](Vec x) { return x * Vec(tmp_sum); },
               output_data,
               output_data,
@@ -132,14 +148,14 @@ inline void _vec_softmax_lastdim(
       });
 }
 
-template <typename scalar_t, bool log_softmax>
+template <bool log_softmax, typename scalar_t>
 inline void _vec_host_softmax_backward_lastdim(
     scalar_t* grad_input_data_base,
     scalar_t* grad_data_base,
     scalar_t* output_data_base,
     int64_t outer_size,
     int64_t dim_size) {
-  using Vec = vec256::Vec256<scalar_t>;
+  using Vec = Vectorized<scalar_t>;
   int64_t grain_size = internal::GRAIN_SIZE / (16 * dim_size);
   if (grain_size < 1)
     grain_size = 1;
@@ -155,10 +171,10 @@ inline void _vec_host_softmax_backward_lastdim(
           scalar_t* output_data = output_data_base + i * dim_size;
           scalar_t sum;
           if (log_softmax) {
-            sum = vec256::reduce_all<scalar_t>(
+            sum = vec::reduce_all<scalar_t>(
                 [](Vec& x, Vec& y) { return x + y; }, grad_data, dim_size);
           } else {
-            sum = vec256::map2_reduce_all<scalar_t>(
+            sum = vec::map2_reduce_all<scalar_t>(
                 [](Vec x, Vec y) { return x * y; },
                 [](Vec x, Vec y) { return x + y; },
                 grad_data,
@@ -166,14 +182,14 @@ inline void _vec_host_softmax_backward_lastdim(
                 dim_size);
           }
           if (log_softmax) {
-            vec256::map2(
+            vec::map2(
                 [sum](Vec x, Vec y) { return x - ((y.exp()) * Vec(sum)); },
                 grad_input_data,
                 grad_data,
                 output_data,
                 dim_size);
           } else {
-            vec256::map2(
+            vec::map2(
                 [sum](Vec x, Vec y) { return (x - Vec(sum)) * y; },
                 grad_input_data,
                 grad_data,
@@ -184,6 +200,167 @@ inline void _vec_host_softmax_backward_lastdim(
       });
 }
 
+// BFloat16 versions of the kernels above. Each row is read as BFloat16 and
+// widened to float in registers (see Note [BFloat16 functional helpers]), so
+// max, sum and the final scaling are all done in float and only the output is
+// rounded to BFloat16.
+inline void _vec_log_softmax_lastdim(
+    BFloat16* input_data_base,
+    BFloat16* output_data_base,
+    int64_t outer_size,
+    int64_t dim_size) {
+  using fVec = Vectorized<float>;
+  static constexpr int64_t CHUNK_SIZE = (128 / sizeof(BFloat16)) * Vectorized<BFloat16>::size();
+  int64_t grain_size = internal::GRAIN_SIZE / (16 * dim_size * CHUNK_SIZE);
+  if (grain_size < CHUNK_SIZE)
+    grain_size = CHUNK_SIZE;
+
+  parallel_for(
+      0,
+      outer_size,
+      grain_size,
+      [&](int64_t begin, int64_t end) {
+        for (int64_t ii = begin; ii < end; ii += CHUNK_SIZE) {
+          float tmp_sum_scalar[CHUNK_SIZE];
+          float max_input_arr[CHUNK_SIZE];
+          int64_t loop_end = CHUNK_SIZE;
+          if (ii + CHUNK_SIZE > end)
+            loop_end = end - ii;
+          for (int64_t j = 0; j < loop_end; j++) {
+            int64_t i = ii + j;
+            BFloat16* input_data = input_data_base + i * dim_size;
+            max_input_arr[j] = vec::reduce_all(
+                [](fVec& x, fVec& y) { return vec::maximum(x, y); },
+                input_data,
+                dim_size);
+          }
+          for (int64_t j = 0; j < loop_end; j++) {
+            int64_t i = ii + j;
+            BFloat16* input_data = input_data_base + i * dim_size;
+            float max_input = max_input_arr[j];
+            tmp_sum_scalar[j] = vec::map_reduce_all(
+                [max_input](fVec x) { return (x - fVec(max_input)).exp(); },
+                [](fVec x, fVec y) { return x + y; },
+                input_data,
+                dim_size);
+          }
+          // See [Note AVX-SSE transitions] for why this should call the
+          // vectorized version (aside from perf improvements).
+          vec::map(
+              [](fVec x) { return x.log(); },
+              tmp_sum_scalar,
+              tmp_sum_scalar,
+              loop_end);
+          for (int64_t j = 0; j < loop_end; j++) {
+            int64_t i = ii + j;
+            BFloat16* input_data = input_data_base + i * dim_size;
+            BFloat16* output_data = output_data_base + i * dim_size;
+            float tmp_sum = tmp_sum_scalar[j];
+            float max_input = max_input_arr[j];
+            vec::map(
+                [tmp_sum, max_input](fVec x) { return x - fVec(max_input) - fVec(tmp_sum); },
+                output_data,
+                input_data,
+                dim_size);
+          }
+        }
+      });
+}
+
+inline void _vec_softmax_lastdim(
+    BFloat16* input_data_base,
+    BFloat16* output_data_base,
+    int64_t outer_size,
+    int64_t dim_size) {
+  using fVec = Vectorized<float>;
+  int64_t grain_size = internal::GRAIN_SIZE / (16 * dim_size);
+  if (grain_size < 1)
+    grain_size = 1;
+
+  parallel_for(
+      0,
+      outer_size,
+      grain_size,
+      [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          BFloat16* input_data = input_data_base + i * dim_size;
+          BFloat16* output_data = output_data_base + i * dim_size;
+          float max_input = vec::reduce_all(
+              [](fVec& x, fVec& y) { return vec::maximum(x, y); },
+              input_data,
+              dim_size);
+          // Unlike the float version, the exponentials are not stored and
+          // read back for the normalization: that would sum values already
+          // rounded to BFloat16. They are recomputed from the input instead.
+          float tmp_sum = vec::map_reduce_all(
+              [max_input](fVec x) { return (x - fVec(max_input)).exp(); },
+              [](fVec x, fVec y) { return x + y; },
+              input_data,
+              dim_size);
+          tmp_sum = 1 / tmp_sum;
+          vec::map(
+              [max_input, tmp_sum](fVec x) {
+                return (x - fVec(max_input)).exp() * fVec(tmp_sum);
+              },
+              output_data,
+              input_data,
+              dim_size);
+        }
+      });
+}
+
+template <bool log_softmax>
+inline void _vec_host_softmax_backward_lastdim(
+    BFloat16* grad_input_data_base,
+    BFloat16* grad_data_base,
+    BFloat16* output_data_base,
+    int64_t outer_size,
+    int64_t dim_size) {
+  using fVec = Vectorized<float>;
+  int64_t grain_size = internal::GRAIN_SIZE / (16 * dim_size);
+  if (grain_size < 1)
+    grain_size = 1;
+
+  parallel_for(
+      0,
+      outer_size,
+      grain_size,
+      [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          BFloat16* grad_input_data = grad_input_data_base + i * dim_size;
+          BFloat16* grad_data = grad_data_base + i * dim_size;
+          BFloat16* output_data = output_data_base + i * dim_size;
+          float sum;
+          if (log_softmax) {
+            sum = vec::reduce_all(
+                [](fVec& x, fVec& y) { return x + y; }, grad_data, dim_size);
+          } else {
+            sum = vec::map2_reduce_all(
+                [](fVec x, fVec y) { return x * y; },
+                [](fVec x, fVec y) { return x + y; },
+                grad_data,
+                output_data,
+                dim_size);
+          }
+          if (log_softmax) {
+            vec::map2(
+                [sum](fVec x, fVec y) { return x - ((y.exp()) * fVec(sum)); },
+                grad_input_data,
+                grad_data,
+                output_data,
+                dim_size);
+          } else {
+            vec::map2(
+                [sum](fVec x, fVec y) { return (x - fVec(sum)) * y; },
+                grad_input_data,
+                grad_data,
+                output_data,
+                dim_size);
+          }
+        }
+      });
+}
+
 template <typename scalar_t, bool LogSoftMax>
 struct vec_host_softmax_lastdim {
   static void apply(Tensor& output, const Tensor& input) {
@@ -214,7 +391,7 @@ struct vec_host_softmax_backward_lastdim {
     scalar_t* grad_input_data_base = grad_input.data_ptr<scalar_t>();
     scalar_t* grad_data_base = grad.data_ptr<scalar_t>();
     scalar_t* output_data_base = output.data_ptr<scalar_t>();
-    _vec_host_softmax_backward_lastdim<scalar_t, LogSoftMax>(
+    _vec_host_softmax_backward_lastdim<LogSoftMax>(
         grad_input_data_base,
         grad_data_base,
         output_data_base,
@@ -224,9 +401,10 @@ struct vec_host_softmax_backward_lastdim {
 };
 
 static void softmax_lastdim_kernel_impl(Tensor& result, const Tensor& self) {
-  AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "softmax_lastdim_kernel_impl", [&] {
-    vec_host_softmax_lastdim<scalar_t, false>::apply(result, self);
-  });
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      at::ScalarType::BFloat16, self.scalar_type(),
+      "softmax_lastdim_kernel_impl",
+      [&] { vec_host_softmax_lastdim<scalar_t, false>::apply(result, self); });
 }
 
 static void log_softmax_lastdim_kernel_impl(
@@ -242,8 +420,9 @@ static void softmax_backward_lastdim_kernel_impl(
     Tensor& grad_input,
     const Tensor& grad,
     const Tensor& output) {
-  AT_DISPATCH_FLOATING_TYPES(
-      grad.scalar_type(), "softmax_backward_lastdim_kernel_impl", [&] {
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      at::ScalarType::BFloat16, grad.scalar_type(),
+      "softmax_backward_lastdim_kernel_impl", [&] {
         vec_host_softmax_backward_lastdim<scalar_t, false>::apply(
             grad_input, grad, output);
       });
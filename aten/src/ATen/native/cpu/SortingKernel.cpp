@@ -2,13 +2,393 @@
 #include <ATen/Dispatch.h>
 #include <ATen/Parallel.h>
 #include <ATen/NumericUtils.h>
+#if defined(CPU_CAPABILITY_AVX512)
+#include <ATen/cpu/vec512/vec512.h>
+#else
+#include <ATen/cpu/vec256/vec256.h>
+#endif
+#include <ATen/native/RadixSort.h>
 #include <ATen/native/Sorting.h>
 #include <ATen/native/SortingUtils.h>
+#include <ATen/native/TensorIterator.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
 
 namespace at { namespace native {
 
 namespace {
 
+// Use the full register width of the capability this file is compiled for.
+#if defined(CPU_CAPABILITY_AVX512)
+template <typename T>
+using Vectorized = vec512::Vec512<T>;
+#else
+template <typename T>
+using Vectorized = vec256::Vec256<T>;
+#endif
+
+// A single slice at least this long is sorted by all threads together;
+// shorter slices are sorted one per thread.
+constexpr int64_t kParallelSortMinSize = 1 << 16;
+constexpr int64_t kMergeSortMinChunkSize = 1 << 12;
+
+// We want NaN to be sorted as top for numpy compatibility: last in ascending
+// order, first in descending order.
+template <typename scalar_t>
+struct KeyValueCompAsc {
+  template <typename elem_t>
+  bool operator()(const elem_t& x, const elem_t& y) const {
+    return (!_isnan<scalar_t>(x.first) && _isnan<scalar_t>(y.first)) || (x.first < y.first);
+  }
+};
+
+template <typename scalar_t>
+struct KeyValueCompDesc {
+  template <typename elem_t>
+  bool operator()(const elem_t& x, const elem_t& y) const {
+    return (_isnan<scalar_t>(x.first) && !_isnan<scalar_t>(y.first)) || (x.first > y.first);
+  }
+};
+
+// RadixKey<scalar_t>::encode maps a value to an unsigned integer whose order
+// is the ascending sort order above. Types without a specialization are
+// merge sorted instead.
+template <typename scalar_t, typename = void>
+struct RadixKey {
+  static constexpr bool supported = false;
+  using type = uint8_t;
+  static type encode(scalar_t) { return 0; }
+};
+
+template <>
+struct RadixKey<bool> {
+  static constexpr bool supported = true;
+  using type = uint8_t;
+  static type encode(bool x) { return x; }
+};
+
+template <typename scalar_t>
+struct RadixKey<scalar_t, typename std::enable_if<std::is_integral<scalar_t>::value>::type> {
+  static constexpr bool supported = true;
+  using type = typename std::make_unsigned<scalar_t>::type;
+  // Flipping the sign bit orders signed values as unsigned ones.
+  static type encode(scalar_t x) {
+    constexpr type sign_bit = std::is_signed<scalar_t>::value
+        ? static_cast<type>(type(1) << (sizeof(type) * 8 - 1))
+        : 0;
+    return static_cast<type>(x) ^ sign_bit;
+  }
+};
+
+template <typename scalar_t>
+struct RadixKey<scalar_t, typename std::enable_if<std::is_floating_point<scalar_t>::value>::type> {
+  static constexpr bool supported = true;
+  using type = typename std::conditional<sizeof(scalar_t) == 4, uint32_t, uint64_t>::type;
+  // Positive values get the sign bit set and negative values are inverted, so
+  // that unsigned order is numeric order. NaNs map above +inf, and -0.0 and
+  // 0.0 share a key so that they keep their relative order like they would
+  // in a comparison sort.
+  static type encode(scalar_t x) {
+    constexpr type sign_bit = type(1) << (sizeof(type) * 8 - 1);
+    if (_isnan(x)) {
+      return std::numeric_limits<type>::max();
+    }
+    if (x == 0) {
+      return sign_bit;
+    }
+    type bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    return (bits & sign_bit) ? static_cast<type>(~bits) : (bits | sign_bit);
+  }
+};
+
+// Sorts one long slice with a parallel LSD radix sort of the encoded keys.
+// The sort is stable; in descending order the keys are inverted, which keeps
+// equal elements in their original order too.
+template <typename scalar_t>
+void sort_radix_parallel(
+    scalar_t* values, int64_t values_stride,
+    int64_t* indices, int64_t indices_stride,
+    int64_t n, bool descending) {
+  using key_t = typename RadixKey<scalar_t>::type;
+  std::vector<scalar_t> original(n);
+  std::vector<key_t> keys(n), tmp_keys(n);
+  std::vector<int64_t> perm(n), tmp_perm(n);
+  at::parallel_for(0, n, at::internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      original[i] = values[i * values_stride];
+      key_t key = RadixKey<scalar_t>::encode(original[i]);
+      keys[i] = descending ? static_cast<key_t>(~key) : key;
+      perm[i] = i;
+    }
+  });
+  auto sorted = radix_sort_parallel(
+      keys.data(), perm.data(), tmp_keys.data(), tmp_perm.data(), n,
+      std::numeric_limits<key_t>::max());
+  const int64_t* sorted_perm = sorted.second;
+  at::parallel_for(0, n, at::internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      values[i * values_stride] = original[sorted_perm[i]];
+      indices[i * indices_stride] = sorted_perm[i];
+    }
+  });
+}
+
+// Returns how many elements of a come first in the first k elements of the
+// stable merge of a and b.
+template <typename elem_t, typename Comp>
+int64_t merge_path_split(
+    const elem_t* a, int64_t na, const elem_t* b, int64_t nb, int64_t k,
+    const Comp& comp) {
+  int64_t lo = std::max<int64_t>(0, k - nb);
+  int64_t hi = std::min(k, na);
+  while (lo < hi) {
+    int64_t i = lo + (hi - lo) / 2;
+    int64_t j = k - i;
+    // a[i] is merged before b[j - 1] unless b[j - 1] is strictly smaller.
+    if (j > 0 && !comp(b[j - 1], a[i])) {
+      lo = i + 1;
+    } else {
+      hi = i;
+    }
+  }
+  return lo;
+}
+
+// Sorts one long slice with a parallel merge sort: every thread stable-sorts
+// a chunk, and the sorted runs are then merged pairwise. Each merge round is
+// split into equal parts of the output with merge_path_split, so the last
+// rounds still use all threads.
+template <typename scalar_t, typename Comp>
+void sort_merge_parallel(
+    scalar_t* values, int64_t values_stride,
+    int64_t* indices, int64_t indices_stride,
+    int64_t n, const Comp& comp) {
+  using elem_t = std::pair<scalar_t, int64_t>;
+  std::vector<elem_t> buffer(n), tmp(n);
+  at::parallel_for(0, n, at::internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      buffer[i] = elem_t(values[i * values_stride], i);
+    }
+  });
+
+  const int64_t num_threads = at::get_num_threads();
+  const int64_t num_chunks = std::max<int64_t>(
+      1, std::min<int64_t>(num_threads, n / kMergeSortMinChunkSize));
+  const int64_t chunk_size = divup(n, num_chunks);
+  auto run_begin = [&](int64_t run) { return std::min(n, run * chunk_size); };
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      std::stable_sort(
+          buffer.begin() + run_begin(c), buffer.begin() + run_begin(c + 1), comp);
+    }
+  });
+
+  elem_t* src = buffer.data();
+  elem_t* dst = tmp.data();
+  for (int64_t width = 1; width < num_chunks; width *= 2) {
+    const int64_t num_merges = divup(num_chunks, 2 * width);
+    const int64_t parts = std::max<int64_t>(1, num_threads / num_merges);
+    at::parallel_for(0, num_merges * parts, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t task = begin; task < end; task++) {
+        const int64_t merge = task / parts;
+        const int64_t part = task % parts;
+        const int64_t lo = run_begin(2 * merge * width);
+        const int64_t mid = run_begin((2 * merge + 1) * width);
+        const int64_t hi = run_begin((2 * merge + 2) * width);
+        const int64_t na = mid - lo;
+        const int64_t nb = hi - mid;
+        const int64_t k_begin = (na + nb) * part / parts;
+        const int64_t k_end = (na + nb) * (part + 1) / parts;
+        const int64_t i_begin = merge_path_split(src + lo, na, src + mid, nb, k_begin, comp);
+        const int64_t i_end = merge_path_split(src + lo, na, src + mid, nb, k_end, comp);
+        std::merge(
+            src + lo + i_begin, src + lo + i_end,
+            src + mid + (k_begin - i_begin), src + mid + (k_end - i_end),
+            dst + lo + k_begin, comp);
+      }
+    });
+    std::swap(src, dst);
+  }
+
+  at::parallel_for(0, n, at::internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      values[i * values_stride] = src[i].first;
+      indices[i * indices_stride] = src[i].second;
+    }
+  });
+}
+
+template <typename scalar_t, typename Comp>
+void sort_slice_serial(
+    scalar_t* values, int64_t values_stride,
+    int64_t* indices, int64_t indices_stride,
+    int64_t n, const Comp& comp, std::vector<std::pair<scalar_t, int64_t>>& buffer) {
+  buffer.resize(n);
+  for (int64_t i = 0; i < n; i++) {
+    buffer[i].first = values[i * values_stride];
+    buffer[i].second = i;
+  }
+  std::stable_sort(buffer.begin(), buffer.end(), comp);
+  for (int64_t i = 0; i < n; i++) {
+    values[i * values_stride] = buffer[i].first;
+    indices[i * indices_stride] = buffer[i].second;
+  }
+}
+
+// `values` holds a copy of the input; sorts it in place along `dim` and
+// writes the permutation to `indices`. The sort is stable.
+static void sort_kernel(
+    Tensor& values,
+    Tensor& indices,
+    int64_t dim,
+    bool descending) {
+  const int64_t dim_size = values.size(dim);
+  const int64_t values_dim_stride = values.stride(dim);
+  const int64_t indices_dim_stride = indices.stride(dim);
+  if (values.numel() == 0 || dim_size == 0) {
+    return;
+  }
+  const int64_t num_slices = values.numel() / dim_size;
+
+  AT_DISPATCH_ALL_TYPES_AND3(
+      ScalarType::Bool, ScalarType::Half, ScalarType::BFloat16, values.scalar_type(), "sort_cpu", [&] {
+    // One long slice: sort it with all threads.
+    if (num_slices == 1 && dim_size >= kParallelSortMinSize && at::get_num_threads() > 1) {
+      auto* values_data = values.data_ptr<scalar_t>();
+      auto* indices_data = indices.data_ptr<int64_t>();
+      if (RadixKey<scalar_t>::supported) {
+        sort_radix_parallel(
+            values_data, values_dim_stride, indices_data, indices_dim_stride,
+            dim_size, descending);
+      } else if (descending) {
+        sort_merge_parallel(
+            values_data, values_dim_stride, indices_data, indices_dim_stride,
+            dim_size, KeyValueCompDesc<scalar_t>());
+      } else {
+        sort_merge_parallel(
+            values_data, values_dim_stride, indices_data, indices_dim_stride,
+            dim_size, KeyValueCompAsc<scalar_t>());
+      }
+      return;
+    }
+
+    auto iter = TensorIteratorConfig()
+      .check_all_same_dtype(false)
+      .resize_outputs(false)
+      .declare_static_shape(values.sizes(), /*squash_dim=*/dim)
+      .add_output(values)
+      .add_output(indices)
+      .build();
+    auto loop = [&](char** data, const int64_t* strides, int64_t n) {
+      std::vector<std::pair<scalar_t, int64_t>> buffer;
+      for (int64_t i = 0; i < n; i++) {
+        auto* values_data = reinterpret_cast<scalar_t*>(data[0] + i * strides[0]);
+        auto* indices_data = reinterpret_cast<int64_t*>(data[1] + i * strides[1]);
+        if (descending) {
+          sort_slice_serial(
+              values_data, values_dim_stride, indices_data, indices_dim_stride,
+              dim_size, KeyValueCompDesc<scalar_t>(), buffer);
+        } else {
+          sort_slice_serial(
+              values_data, values_dim_stride, indices_data, indices_dim_stride,
+              dim_size, KeyValueCompAsc<scalar_t>(), buffer);
+        }
+      }
+    };
+    // Aim for GRAIN_SIZE elements per task.
+    iter.for_each(loop, std::max<int64_t>(1, at::internal::GRAIN_SIZE / dim_size));
+  });
+}
+
+template <typename scalar_t>
+using is_vectorized_topk = std::integral_constant<bool,
+    std::is_same<scalar_t, float>::value || std::is_same<scalar_t, double>::value>;
+
+// Whether any of the Vectorized<scalar_t>::size() elements at `data` beats
+// `threshold`, i.e. is larger (or NaN) when `largest`, or smaller otherwise.
+template <typename scalar_t,
+          typename std::enable_if<!is_vectorized_topk<scalar_t>::value, int>::type = 0>
+bool any_beats(const scalar_t* data, scalar_t threshold, bool largest) {
+  return true;
+}
+
+template <typename scalar_t,
+          typename std::enable_if<is_vectorized_topk<scalar_t>::value, int>::type = 0>
+bool any_beats(const scalar_t* data, scalar_t threshold, bool largest) {
+  using Vec = Vectorized<scalar_t>;
+  auto x = Vec::loadu(data);
+  auto t = Vec(threshold);
+  auto beats = largest ? ((x > t) | (x != x)) : (x < t);
+  // zero_mask() has a bit set for every lane that compared false.
+  return beats.zero_mask() != (1 << Vec::size()) - 1;
+}
+
+// Top-k for small k: keeps the k best elements seen so far in a heap whose
+// top is the worst of them, and only touches the heap for elements that beat
+// it. Once the heap is warm nearly every element loses, so for float and
+// double on contiguous slices a whole vector is compared against the heap top
+// at once and vectors without a candidate are skipped.
+template <typename scalar_t, typename Comp>
+void topk_small_k(
+    const scalar_t* self_data, int64_t self_stride, int64_t n,
+    scalar_t* values_data, int64_t values_stride,
+    int64_t* indices_data, int64_t indices_stride,
+    int64_t k, bool largest, bool sorted, const Comp& better,
+    std::vector<std::pair<scalar_t, int64_t>>& heap) {
+  using elem_t = std::pair<scalar_t, int64_t>;
+  using Vec = Vectorized<scalar_t>;
+  constexpr bool vectorize = is_vectorized_topk<scalar_t>::value;
+
+  heap.resize(k);
+  for (int64_t j = 0; j < k; j++) {
+    heap[j] = elem_t(self_data[j * self_stride], j);
+  }
+  std::make_heap(heap.begin(), heap.end(), better);
+
+  auto offer = [&](int64_t j) {
+    elem_t candidate(self_data[j * self_stride], j);
+    if (better(candidate, heap.front())) {
+      std::pop_heap(heap.begin(), heap.end(), better);
+      heap.back() = candidate;
+      std::push_heap(heap.begin(), heap.end(), better);
+    }
+  };
+
+  int64_t j = k;
+  if (vectorize && self_stride == 1) {
+    for (; j + Vec::size() <= n; j += Vec::size()) {
+      // Nothing but NaN can replace a NaN when largest; when smallest, NaN
+      // is the worst value and the vector compare cannot tell.
+      const scalar_t threshold = heap.front().first;
+      if (_isnan(threshold) || any_beats(self_data + j, threshold, largest)) {
+        for (int64_t l = j; l < j + Vec::size(); l++) {
+          offer(l);
+        }
+      }
+    }
+  }
+  for (; j < n; j++) {
+    offer(j);
+  }
+
+  if (sorted) {
+    std::sort_heap(heap.begin(), heap.end(), better);
+  }
+  for (int64_t l = 0; l < k; l++) {
+    values_data[l * values_stride] = heap[l].first;
+    indices_data[l * indices_stride] = heap[l].second;
+  }
+}
+
+// The vectorized path is only worthwhile while the heap stays in cache and
+// most elements are rejected.
+constexpr int64_t kTopkSmallKMax = 32;
+
 static void topk_kernel(
     Tensor& values,
     Tensor& indices,
@@ -30,7 +410,27 @@ static void topk_kernel(
           auto use_partial_sort = k * 64 <= n;
 
           using elem_t = std::pair<scalar_t, int64_t>;
-          std::vector<elem_t> queue(n);
+          std::vector<elem_t> queue;
+
+          if (use_partial_sort && k > 0 && k <= kTopkSmallKMax) {
+            auto* self_data = tl[0].data_ptr<scalar_t>();
+            auto* values_data = tl[1].data_ptr<scalar_t>();
+            auto* indices_data = tl[2].data_ptr<int64_t>();
+            if (largest) {
+              topk_small_k(
+                  self_data, tl[0].stride(0), n, values_data, tl[1].stride(0),
+                  indices_data, tl[2].stride(0), k, largest, sorted,
+                  KeyValueCompDesc<scalar_t>(), queue);
+            } else {
+              topk_small_k(
+                  self_data, tl[0].stride(0), n, values_data, tl[1].stride(0),
+                  indices_data, tl[2].stride(0), k, largest, sorted,
+                  KeyValueCompAsc<scalar_t>(), queue);
+            }
+            return;
+          }
+
+          queue.resize(n);
           for (int64_t j = 0; j < n; j++) {
             queue[j].first = tmp_values[j];
             queue[j].second = j;
@@ -85,6 +485,7 @@ static void topk_kernel(
 
 } // anonymous namespace
 
+REGISTER_DISPATCH(sort_stub, &sort_kernel);
 REGISTER_DISPATCH(topk_stub, &topk_kernel);
 
 }} //at::native
@@ -294,7 +294,8 @@ static void sinh_kernel(TensorIterator& iter) {
     cpu_kernel_vec(
         iter,
         [=](scalar_t a) -> scalar_t { return std::sinh(a); },
-        [=](Vec256<scalar_t> self_vec){return self_vec.sinh();});
+        [=](Vec256<scalar_t> self_vec){return self_vec.sinh();},
+        ParallelCost("sinh", 10));
   });
 }
 
@@ -303,7 +304,8 @@ static void cosh_kernel(TensorIterator& iter) {
     cpu_kernel_vec(
         iter,
         [=](scalar_t a) -> scalar_t { return std::cosh(a); },
-        [=](Vec256<scalar_t> self_vec){return self_vec.cosh();});
+        [=](Vec256<scalar_t> self_vec){return self_vec.cosh();},
+        ParallelCost("cosh", 10));
   });
 }
 
@@ -311,7 +313,8 @@ static void acosh_kernel(TensorIterator& iter) {
     AT_DISPATCH_FLOATING_TYPES(iter.dtype(), "acosh_cpu", [&]() {
       cpu_kernel(
         iter,
-        [=](scalar_t a) -> scalar_t { return std::acosh(a); });
+        [=](scalar_t a) -> scalar_t { return std::acosh(a); },
+        ParallelCost("acosh", 20));
     });
 }
 
@@ -319,7 +322,8 @@ static void asinh_kernel(TensorIterator& iter) {
     AT_DISPATCH_FLOATING_TYPES(iter.dtype(), "asinh_cpu", [&]() {
       cpu_kernel(
         iter,
-        [=](scalar_t a) -> scalar_t { return std::asinh(a); });
+        [=](scalar_t a) -> scalar_t { return std::asinh(a); },
+        ParallelCost("asinh", 20));
     });
 }
 
@@ -327,7 +331,8 @@ static void atanh_kernel(TensorIterator& iter) {
     AT_DISPATCH_FLOATING_TYPES(iter.dtype(), "atanh_cpu", [&]() {
       cpu_kernel(
         iter,
-        [=](scalar_t a) -> scalar_t { return std::atanh(a); });
+        [=](scalar_t a) -> scalar_t { return std::atanh(a); },
+        ParallelCost("atanh", 20));
     });
 }
 
@@ -335,7 +340,8 @@ static void digamma_kernel(TensorIterator& iter) {
   AT_DISPATCH_FLOATING_TYPES(iter.dtype(), "digamma", [&]() {
     cpu_kernel(
         iter,
-        [=](scalar_t a) -> scalar_t { return calc_digamma(a); });
+        [=](scalar_t a) -> scalar_t { return calc_digamma(a); },
+        ParallelCost("digamma", 50));
   });
 }
 
@@ -343,7 +349,8 @@ static void trigamma_kernel(TensorIterator& iter) {
   AT_DISPATCH_FLOATING_TYPES(iter.dtype(), "trigamma", [&]() {
     cpu_kernel(
         iter,
-        [=](scalar_t a) -> scalar_t { return trigamma(a); });
+        [=](scalar_t a) -> scalar_t { return trigamma(a); },
+        ParallelCost("trigamma", 50));
   });
 }
 
@@ -355,7 +362,8 @@ static void polygamma_kernel(TensorIterator& iter, int64_t n) {
   } else {
     AT_DISPATCH_FLOATING_TYPES(iter.dtype(), "polygamma", [&]() {
       cpu_kernel(
-          iter, [=](scalar_t a) -> scalar_t { return calc_polygamma(n, a); });
+          iter, [=](scalar_t a) -> scalar_t { return calc_polygamma(n, a); },
+          ParallelCost("polygamma", 200));
     });
   }
 }
@@ -416,8 +424,9 @@ void bernoulli_scalar_kernel(Tensor& self, double p, c10::optional<Generator> ge
 }
 #else
 void bernoulli_scalar_kernel(Tensor &self, double p, c10::optional<Generator> gen) {
-  if (cpuinfo_initialize() && cpuinfo_vendor_intel == cpuinfo_get_processor(0)->core->vendor) {
-    CPUGeneratorImpl* generator = get_generator_or_default<CPUGeneratorImpl>(gen, detail::getDefaultCPUGenerator());
+  CPUGeneratorImpl* generator = get_generator_or_default<CPUGeneratorImpl>(gen, detail::getDefaultCPUGenerator());
+  if (!generator->philox_mode() &&
+      cpuinfo_initialize() && cpuinfo_vendor_intel == cpuinfo_get_processor(0)->core->vendor) {
     int64_t seed;
     {
       // See Note [Acquire lock when using random generators]
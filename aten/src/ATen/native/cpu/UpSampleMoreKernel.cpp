@@ -5,6 +5,8 @@
 #include <ATen/Parallel.h>
 #include <ATen/cpu/vec256/vec256.h>
 
+#include <vector>
+
 namespace at {
 namespace native {
 namespace {
@@ -224,40 +226,50 @@ void cpu_upsample_linear_channels_last(
           h * input_width * channels + w * channels;
     };
 
+    // The source columns and weights are the same for every output row.
+    std::vector<int64_t> iw0s(output_width), iw1s(output_width);
+    std::vector<scalar_t> w0lambdas(output_width), w1lambdas(output_width);
+    for (int64_t ow = 0; ow < output_width; ow++) {
+      compute_source_index_and_lambda(
+          iw0s[ow], iw1s[ow], w0lambdas[ow], w1lambdas[ow], width_scale, ow, input_width, output_width, align_corners);
+    }
+
     int64_t ih0, ih1, iw0, iw1;
     scalar_t h0lambda, h1lambda, w0lambda, w1lambda;
-    for (int64_t n = begin; n < end; n++) {
-      for (int64_t oh = 0; oh < output_height; oh++) {
-        compute_source_index_and_lambda(
-            ih0, ih1, h0lambda, h1lambda, height_scale, oh, input_height, output_height, align_corners);
-        for (int64_t ow = 0; ow < output_width; ow++) {
-          compute_source_index_and_lambda(
-              iw0, iw1, w0lambda, w1lambda, width_scale, ow, input_width, output_width, align_corners);
-
-          scalar_t* out = output_data + n * output_slice_size +
-              oh * output_width * channels + ow * channels;
-          scalar_t* i00 = input_indexr(n, ih0, iw0);
-          scalar_t* i01 = input_indexr(n, ih0, iw1);
-          scalar_t* i10 = input_indexr(n, ih1, iw0);
-          scalar_t* i11 = input_indexr(n, ih1, iw1);
-
-          int64_t size = channels;
-          int64_t d = 0;
-          for (; d < size - (size % Vec::size()); d += Vec::size()) {
-            Vec out_vec =
-                Vec(h0lambda * w0lambda) * Vec::loadu(i00 + d) + /* h0 * w0 * i00 */
-                Vec(h0lambda * w1lambda) * Vec::loadu(i01 + d) + /* h0 * w1 * i01 */
-                Vec(h1lambda * w0lambda) * Vec::loadu(i10 + d) + /* h1 * w0 * i10 */
-                Vec(h1lambda * w1lambda) * Vec::loadu(i11 + d);  /* h1 * w1 * i11 */
-            out_vec.store(out + d);
-          }
-          for (; d < size; d++) {
-            out[d] =
-                h0lambda * w0lambda * i00[d] + /* h0 * w0 * i00 */
-                h0lambda * w1lambda * i01[d] + /* h0 * w1 * i01 */
-                h1lambda * w0lambda * i10[d] + /* h1 * w0 * i10 */
-                h1lambda * w1lambda * i11[d];  /* h1 * w1 * i11 */
-          }
+    for (int64_t i = begin; i < end; i++) {
+      int64_t n = i / output_height;
+      int64_t oh = i % output_height;
+      compute_source_index_and_lambda(
+          ih0, ih1, h0lambda, h1lambda, height_scale, oh, input_height, output_height, align_corners);
+      for (int64_t ow = 0; ow < output_width; ow++) {
+        iw0 = iw0s[ow];
+        iw1 = iw1s[ow];
+        w0lambda = w0lambdas[ow];
+        w1lambda = w1lambdas[ow];
+
+        scalar_t* out = output_data + n * output_slice_size +
+            oh * output_width * channels + ow * channels;
+        scalar_t* i00 = input_indexr(n, ih0, iw0);
+        scalar_t* i01 = input_indexr(n, ih0, iw1);
+        scalar_t* i10 = input_indexr(n, ih1, iw0);
+        scalar_t* i11 = input_indexr(n, ih1, iw1);
+
+        int64_t size = channels;
+        int64_t d = 0;
+        for (; d < size - (size % Vec::size()); d += Vec::size()) {
+          Vec out_vec =
+              Vec(h0lambda * w0lambda) * Vec::loadu(i00 + d) + /* h0 * w0 * i00 */
+              Vec(h0lambda * w1lambda) * Vec::loadu(i01 + d) + /* h0 * w1 * i01 */
+              Vec(h1lambda * w0lambda) * Vec::loadu(i10 + d) + /* h1 * w0 * i10 */
+              Vec(h1lambda * w1lambda) * Vec::loadu(i11 + d);  /* h1 * w1 * i11 */
+          out_vec.store(out + d);
+        }
+        for (; d < size; d++) {
+          out[d] =
+              h0lambda * w0lambda * i00[d] + /* h0 * w0 * i00 */
+              h0lambda * w1lambda * i01[d] + /* h0 * w1 * i01 */
+              h1lambda * w0lambda * i10[d] + /* h1 * w0 * i10 */
+              h1lambda * w1lambda * i11[d];  /* h1 * w1 * i11 */
         }
       }
     }
@@ -279,67 +291,69 @@ void cpu_upsample_linear_channels_last(
 
     int64_t id0, id1, ih0, ih1, iw0, iw1;
     scalar_t d0lambda, d1lambda, h0lambda, h1lambda, w0lambda, w1lambda;
-    for (int64_t n = begin; n < end; n++) {
-      for (int64_t od = 0; od < output_depth; od++) {
+    for (int64_t i = begin; i < end; i++) {
+      int64_t n = i / output_depth;
+      int64_t od = i % output_depth;
+      compute_source_index_and_lambda(
+          id0, id1, d0lambda, d1lambda, depth_scale, od, input_depth, output_depth, align_corners);
+      for (int64_t oh = 0; oh < output_height; oh++) {
         compute_source_index_and_lambda(
-            id0, id1, d0lambda, d1lambda, depth_scale, od, input_depth, output_depth, align_corners);
-        for (int64_t oh = 0; oh < output_height; oh++) {
+            ih0, ih1, h0lambda, h1lambda, height_scale, oh, input_height, output_height, align_corners);
+        for (int64_t ow = 0; ow < output_width; ow++) {
           compute_source_index_and_lambda(
-              ih0, ih1, h0lambda, h1lambda, height_scale, oh, input_height, output_height, align_corners);
-          for (int64_t ow = 0; ow < output_width; ow++) {
-            compute_source_index_and_lambda(
-                iw0, iw1, w0lambda, w1lambda, width_scale, ow, input_width, output_width, align_corners);
+              iw0, iw1, w0lambda, w1lambda, width_scale, ow, input_width, output_width, align_corners);
 
-            scalar_t* out = output_data + n * output_slice_size +
-                od * output_height * output_width * channels +
-                oh * output_width * channels + ow * channels;
-            scalar_t* i000 = input_indexr(n, id0, ih0, iw0);
-            scalar_t* i001 = input_indexr(n, id0, ih0, iw1);
-            scalar_t* i010 = input_indexr(n, id0, ih1, iw0);
-            scalar_t* i011 = input_indexr(n, id0, ih1, iw1);
-            scalar_t* i100 = input_indexr(n, id1, ih0, iw0);
-            scalar_t* i101 = input_indexr(n, id1, ih0, iw1);
-            scalar_t* i110 = input_indexr(n, id1, ih1, iw0);
-            scalar_t* i111 = input_indexr(n, id1, ih1, iw1);
-
-            int64_t size = channels;
-            int64_t d = 0;
-            for (; d < size - (size % Vec::size()); d += Vec::size()) {
-              Vec out_vec =
-                  Vec(d0lambda * h0lambda * w0lambda) * Vec::loadu(i000 + d) + /* d0 * h0 * w0 * i000 */
-                  Vec(d0lambda * h0lambda * w1lambda) * Vec::loadu(i001 + d) + /* d0 * h0 * w1 * i001 */
-                  Vec(d0lambda * h1lambda * w0lambda) * Vec::loadu(i010 + d) + /* d0 * h1 * w0 * i010 */
-                  Vec(d0lambda * h1lambda * w1lambda) * Vec::loadu(i011 + d) + /* d0 * h1 * w1 * i011 */
-                  Vec(d1lambda * h0lambda * w0lambda) * Vec::loadu(i100 + d) + /* d1 * h0 * w0 * i100 */
-                  Vec(d1lambda * h0lambda * w1lambda) * Vec::loadu(i101 + d) + /* d1 * h0 * w1 * i101 */
-                  Vec(d1lambda * h1lambda * w0lambda) * Vec::loadu(i110 + d) + /* d1 * h1 * w0 * i110 */
-                  Vec(d1lambda * h1lambda * w1lambda) * Vec::loadu(i111 + d);  /* d1 * h1 * w1 * i111 */
-              out_vec.store(out + d);
-            }
-            for (; d < size; d++) {
-              out[d] =
-                  d0lambda * h0lambda * w0lambda * i000[d] + /* d0 * h0 * w0 * i000 */
-                  d0lambda * h0lambda * w1lambda * i001[d] + /* d0 * h0 * w1 * i001 */
-                  d0lambda * h1lambda * w0lambda * i010[d] + /* d0 * h1 * w0 * i010 */
-                  d0lambda * h1lambda * w1lambda * i011[d] + /* d0 * h1 * w1 * i011 */
-                  d1lambda * h0lambda * w0lambda * i100[d] + /* d1 * h0 * w0 * i100 */
-                  d1lambda * h0lambda * w1lambda * i101[d] + /* d1 * h0 * w1 * i101 */
-                  d1lambda * h1lambda * w0lambda * i110[d] + /* d1 * h1 * w0 * i110 */
-                  d1lambda * h1lambda * w1lambda * i111[d];  /* d1 * h1 * w1 * i111 */
-            }
+          scalar_t* out = output_data + n * output_slice_size +
+              od * output_height * output_width * channels +
+              oh * output_width * channels + ow * channels;
+          scalar_t* i000 = input_indexr(n, id0, ih0, iw0);
+          scalar_t* i001 = input_indexr(n, id0, ih0, iw1);
+          scalar_t* i010 = input_indexr(n, id0, ih1, iw0);
+          scalar_t* i011 = input_indexr(n, id0, ih1, iw1);
+          scalar_t* i100 = input_indexr(n, id1, ih0, iw0);
+          scalar_t* i101 = input_indexr(n, id1, ih0, iw1);
+          scalar_t* i110 = input_indexr(n, id1, ih1, iw0);
+          scalar_t* i111 = input_indexr(n, id1, ih1, iw1);
+
+          int64_t size = channels;
+          int64_t d = 0;
+          for (; d < size - (size % Vec::size()); d += Vec::size()) {
+            Vec out_vec =
+                Vec(d0lambda * h0lambda * w0lambda) * Vec::loadu(i000 + d) + /* d0 * h0 * w0 * i000 */
+                Vec(d0lambda * h0lambda * w1lambda) * Vec::loadu(i001 + d) + /* d0 * h0 * w1 * i001 */
+                Vec(d0lambda * h1lambda * w0lambda) * Vec::loadu(i010 + d) + /* d0 * h1 * w0 * i010 */
+                Vec(d0lambda * h1lambda * w1lambda) * Vec::loadu(i011 + d) + /* d0 * h1 * w1 * i011 */
+                Vec(d1lambda * h0lambda * w0lambda) * Vec::loadu(i100 + d) + /* d1 * h0 * w0 * i100 */
+                Vec(d1lambda * h0lambda * w1lambda) * Vec::loadu(i101 + d) + /* d1 * h0 * w1 * i101 */
+                Vec(d1lambda * h1lambda * w0lambda) * Vec::loadu(i110 + d) + /* d1 * h1 * w0 * i110 */
+                Vec(d1lambda * h1lambda * w1lambda) * Vec::loadu(i111 + d);  /* d1 * h1 * w1 * i111 */
+            out_vec.store(out + d);
+          }
+          for (; d < size; d++) {
+            out[d] =
+                d0lambda * h0lambda * w0lambda * i000[d] + /* d0 * h0 * w0 * i000 */
+                d0lambda * h0lambda * w1lambda * i001[d] + /* d0 * h0 * w1 * i001 */
+                d0lambda * h1lambda * w0lambda * i010[d] + /* d0 * h1 * w0 * i010 */
+                d0lambda * h1lambda * w1lambda * i011[d] + /* d0 * h1 * w1 * i011 */
+                d1lambda * h0lambda * w0lambda * i100[d] + /* d1 * h0 * w0 * i100 */
+                d1lambda * h0lambda * w1lambda * i101[d] + /* d1 * h0 * w1 * i101 */
+                d1lambda * h1lambda * w0lambda * i110[d] + /* d1 * h1 * w0 * i110 */
+                d1lambda * h1lambda * w1lambda * i111[d];  /* d1 * h1 * w1 * i111 */
           }
         }
       }
     }
   };
 
+  // The rows, or the planes in 3d, are split among the threads rather than
+  // the batches, as there's often a single image.
   if (ndim == 4) {
-    // upsample nearest 2d
-    at::parallel_for(0, num_batches, at::internal::GRAIN_SIZE / output_slice_size / 4, loop2d);
+    // upsample linear 2d
+    at::parallel_for(0, num_batches * output_height, at::internal::GRAIN_SIZE / (output_width * channels) / 4, loop2d);
   } else {
-    // upsample nearest 3d
+    // upsample linear 3d
     TORCH_INTERNAL_ASSERT(ndim == 5);
-    at::parallel_for(0, num_batches, at::internal::GRAIN_SIZE / output_slice_size / 8, loop3d);
+    at::parallel_for(0, num_batches * output_depth, at::internal::GRAIN_SIZE / (output_height * output_width * channels) / 8, loop3d);
   }
 
   if (!output_.is_contiguous(channels_last_memory_format)) {
@@ -6,6 +6,9 @@
 #include <ATen/native/TensorIterator.h>
 #include <ATen/native/cpu/Loops.h>
 
+#include <tuple>
+#include <vector>
+
 namespace at { namespace native {
 namespace {
 
@@ -35,8 +38,8 @@ void batch_norm_cpu_inference_collect_linear_and_constant_terms(
   /// cases where image_size == 1 && batch_size == 1, it is slow.
   for (int64_t c = 0; c < n_channel; c++) {
     scalar_t inv_var = 1 / std::sqrt(var_data[c] + static_cast<scalar_t>(eps));
-    scalar_t weight_v = weight_data ? weight_data[c] : 1;
-    scalar_t bias_v = bias_data ? bias_data[c] : 0;
+    scalar_t weight_v = weight_data ? weight_data[c] : static_cast<scalar_t>(1);
+    scalar_t bias_v = bias_data ? bias_data[c] : static_cast<scalar_t>(0);
     alpha[c] = inv_var * weight_v;
     beta[c] = bias_v - mean_data[c] * alpha[c];
   }
@@ -100,9 +103,78 @@ void batch_norm_cpu_inference_contiguous_impl(Tensor& output,
   }
 }
 
+/// BFloat16 version of the fast path above. alpha and beta are kept in float
+/// and every Vec256<BFloat16> of input is widened to two Vec256<float>, so
+/// the output is rounded to BFloat16 once instead of after each operation.
+template<>
+void batch_norm_cpu_inference_contiguous_impl<BFloat16>(Tensor& output,
+    const Tensor& input, const Tensor& weight, const Tensor& bias,
+    const Tensor& mean, const Tensor& variance, double eps) {
+
+  using bVec = Vec256<BFloat16>;
+  using fVec = Vec256<float>;
+  int64_t n_batch = input.size(0);
+  int64_t n_channel = input.size(1);
+  int64_t image_size = input.numel() / n_batch / n_channel;
+
+  const BFloat16* weight_data = weight.defined() ? weight.data_ptr<BFloat16>() : nullptr;
+  const BFloat16* bias_data = bias.defined() ? bias.data_ptr<BFloat16>() : nullptr;
+  const BFloat16* mean_data = mean.data_ptr<BFloat16>();
+  const BFloat16* var_data = variance.data_ptr<BFloat16>();
+  std::vector<float> alpha_data(n_channel);
+  std::vector<float> beta_data(n_channel);
+  for (int64_t c = 0; c < n_channel; c++) {
+    float inv_var = 1.0f / std::sqrt(static_cast<float>(var_data[c]) + static_cast<float>(eps));
+    float weight_v = weight_data ? static_cast<float>(weight_data[c]) : 1.0f;
+    float bias_v = bias_data ? static_cast<float>(bias_data[c]) : 0.0f;
+    alpha_data[c] = inv_var * weight_v;
+    beta_data[c] = bias_v - static_cast<float>(mean_data[c]) * alpha_data[c];
+  }
+
+  BFloat16* output_data = output.data_ptr<BFloat16>();
+  const BFloat16* input_data = input.data_ptr<BFloat16>();
+
+  if (image_size != 1) {
+    const int64_t n_offset = n_channel * image_size;
+    const int64_t loop_size = image_size - (image_size % bVec::size());
+    for (int64_t n = 0; n < n_batch; n++) {
+      for (int64_t c = 0; c < n_channel; c++) {
+        const fVec alpha_fvec(alpha_data[c]);
+        const fVec beta_fvec(beta_data[c]);
+        int64_t offset = n * n_offset + c * image_size;
+        int64_t d = 0;
+        for (; d < loop_size; d += bVec::size()) {
+          fVec data_fvec0, data_fvec1;
+          std::tie(data_fvec0, data_fvec1) =
+              convert_bfloat16_float(bVec::loadu(input_data + offset + d));
+          fVec output_fvec0 = data_fvec0 * alpha_fvec + beta_fvec;
+          fVec output_fvec1 = data_fvec1 * alpha_fvec + beta_fvec;
+          convert_float_bfloat16(output_fvec0, output_fvec1).store(output_data + offset + d);
+        }
+        if (image_size - d > 0) {
+          fVec data_fvec0, data_fvec1;
+          std::tie(data_fvec0, data_fvec1) =
+              convert_bfloat16_float(bVec::loadu(input_data + offset + d, image_size - d));
+          fVec output_fvec0 = data_fvec0 * alpha_fvec + beta_fvec;
+          fVec output_fvec1 = data_fvec1 * alpha_fvec + beta_fvec;
+          convert_float_bfloat16(output_fvec0, output_fvec1).store(output_data + offset + d, image_size - d);
+        }
+      }
+    }
+  } else {
+    // image_size == 1
+    for (int64_t n = 0; n < n_batch; ++n) {
+      for (int64_t c = 0; c < n_channel; ++c) {
+        int64_t offset = n * n_channel + c;
+        output_data[offset] = static_cast<float>(input_data[offset]) * alpha_data[c] + beta_data[c];
+      }
+    }
+  }
+}
+
 void batch_norm_cpu_inference_contiguous_kernel(Tensor& output, const Tensor& input,
     const Tensor& weight, const Tensor& bias, const Tensor& mean, const Tensor& variance, double eps) {
-  AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "batch_norm_cpu_inference_contiguous", [&] {
+  AT_DISPATCH_FLOATING_TYPES_AND(at::ScalarType::BFloat16, input.scalar_type(), "batch_norm_cpu_inference_contiguous", [&] {
     batch_norm_cpu_inference_contiguous_impl<scalar_t>(output, input, weight, bias, mean, variance, eps);
   });
 }
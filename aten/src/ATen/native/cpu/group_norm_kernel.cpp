@@ -3,6 +3,9 @@
 #include <algorithm>
 #include <array>
 #include <numeric>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 #include <ATen/ATen.h>
 #include <ATen/CPUApplyUtils.h>
@@ -14,6 +17,77 @@ namespace native {
 
 namespace {
 
+// Whether X, contiguous in either format, has its channels innermost.
+bool IsChannelsLast(const Tensor& X) {
+  if (X.is_contiguous()) {
+    return false;
+  }
+  const auto memory_format = X.suggest_memory_format();
+  TORCH_CHECK(
+      memory_format != MemoryFormat::Contiguous &&
+          X.is_contiguous(memory_format),
+      "group_norm expects a contiguous or channels-last input");
+  return true;
+}
+
+// Computes the mean and the biased variance of the \p rows rows of \p cols
+// elements of \p X, \p stride elements apart, with Welford's algorithm,
+// which unlike the sums of the elements and of their squares doesn't lose
+// the variance to cancellation when the mean is large.
+template <typename T>
+std::pair<T, T> RowwiseMoments(
+    const T* X,
+    int64_t rows,
+    int64_t cols,
+    int64_t stride) {
+  using Vec = vec256::Vec256<T>;
+  constexpr int64_t K = Vec::size();
+  const int64_t inner_size = cols / K * K;
+  // Every lane of the vectors sees vec_count elements.
+  Vec m1_vec(0);
+  Vec m2_vec(0);
+  int64_t vec_count = 0;
+  T m1 = 0;
+  T m2 = 0;
+  int64_t count = 0;
+  for (int64_t i = 0; i < rows; ++i) {
+    const T* X_ptr = X + i * stride;
+    for (int64_t j = 0; j < inner_size; j += K) {
+      const Vec x_vec = Vec::loadu(X_ptr + j);
+      const Vec delta_vec = x_vec - m1_vec;
+      ++vec_count;
+      m1_vec = m1_vec + delta_vec * Vec(T(1) / static_cast<T>(vec_count));
+      m2_vec = m2_vec + delta_vec * (x_vec - m1_vec);
+    }
+    for (int64_t j = inner_size; j < cols; ++j) {
+      const T delta = X_ptr[j] - m1;
+      ++count;
+      m1 += delta / static_cast<T>(count);
+      m2 += delta * (X_ptr[j] - m1);
+    }
+  }
+  if (vec_count == 0) {
+    return std::make_pair(m1, count == 0 ? T(0) : m2 / static_cast<T>(count));
+  }
+  std::array<T, K> m1_arr;
+  std::array<T, K> m2_arr;
+  m1_vec.store(m1_arr.data());
+  m2_vec.store(m2_arr.data());
+  // Merges the lanes, then the elements of the tails.
+  T mean = std::accumulate(m1_arr.cbegin(), m1_arr.cend(), T(0)) /
+      static_cast<T>(K);
+  T var = std::accumulate(m2_arr.cbegin(), m2_arr.cend(), T(0));
+  for (int64_t k = 0; k < K; ++k) {
+    var += static_cast<T>(vec_count) * (m1_arr[k] - mean) * (m1_arr[k] - mean);
+  }
+  const T n_vec = static_cast<T>(vec_count * K);
+  const T n = n_vec + static_cast<T>(count);
+  const T delta = m1 - mean;
+  mean += delta * static_cast<T>(count) / n;
+  var += m2 + delta * delta * n_vec * static_cast<T>(count) / n;
+  return std::make_pair(mean, var / n);
+}
+
 template <typename T>
 void GroupNormKernelImplInternal(
     const Tensor& X,
@@ -38,35 +112,18 @@ void GroupNormKernelImplInternal(
   T* Y_data = Y->data_ptr<T>();
   T* mean_data = mean->data_ptr<T>();
   T* rstd_data = rstd->data_ptr<T>();
-  const T s = T(1) / static_cast<T>(D * HxW);
   const bool gamma_null = (gamma_data == nullptr);
   const bool beta_null = beta_data == nullptr;
 
+  // The moments and the affine of each group are computed by the same task,
+  // so that the group is normalized while it is still in the cache.
   at::parallel_for(0, N * G, 1, [&](int64_t start, int64_t end) {
-    constexpr int64_t K = vec256::Vec256<T>::size();
-    const int64_t inner_size = D * HxW / K * K;
-    std::array<T, K> mean_arr;
-    std::array<T, K> rstd_arr;
     for (int64_t i = start; i < end; ++i) {
       const T* X_ptr = X_data + i * D * HxW;
-      vec256::Vec256<T> mean_vec(0);
-      vec256::Vec256<T> rstd_vec(0);
-      for (int64_t j = 0; j < inner_size; j += K) {
-        const vec256::Vec256<T> x_vec = vec256::Vec256<T>::loadu(X_ptr + j);
-        mean_vec = mean_vec + x_vec;
-        rstd_vec = rstd_vec + x_vec * x_vec;
-      }
-      mean_vec.store(mean_arr.data());
-      rstd_vec.store(rstd_arr.data());
-      T mean_val = std::accumulate(mean_arr.cbegin(), mean_arr.cend(), T(0));
-      T rstd_val = std::accumulate(rstd_arr.cbegin(), rstd_arr.cend(), T(0));
-      for (int64_t j = inner_size; j < D * HxW; ++j) {
-        mean_val += X_ptr[j];
-        rstd_val += X_ptr[j] * X_ptr[j];
-      }
-      mean_val *= s;
-      rstd_val = std::max(rstd_val * s - mean_val * mean_val, T(0));
-      rstd_val = T(1) / std::sqrt(rstd_val + eps);
+      T mean_val;
+      T var_val;
+      std::tie(mean_val, var_val) = RowwiseMoments(X_ptr, 1, D * HxW, 0);
+      const T rstd_val = T(1) / std::sqrt(std::max(var_val, T(0)) + eps);
 
       const int64_t g = i % G;
       for (int64_t j = 0; j < D; ++j) {
@@ -85,6 +142,88 @@ void GroupNormKernelImplInternal(
   });
 }
 
+// The forward of a channels-last X, whose N x HxW rows hold the C channels
+// of each position. The moments of each group are computed from its D
+// columns directly, then every row is normalized with the scales and biases
+// of its channels.
+template <typename T>
+void GroupNormChannelsLastKernelImplInternal(
+    const Tensor& X,
+    const Tensor& gamma,
+    const Tensor& beta,
+    int64_t N,
+    int64_t C,
+    int64_t HxW,
+    int64_t group,
+    T eps,
+    Tensor* Y,
+    Tensor* mean,
+    Tensor* rstd) {
+  TORCH_CHECK(X.numel() == N * C * HxW);
+  TORCH_CHECK(!gamma.defined() || gamma.numel() == C);
+  TORCH_CHECK(!beta.defined() || beta.numel() == C);
+  const int64_t G = group;
+  const int64_t D = C / G;
+  const T* X_data = X.data_ptr<T>();
+  const T* gamma_data = gamma.defined() ? gamma.data_ptr<T>() : nullptr;
+  const T* beta_data = beta.defined() ? beta.data_ptr<T>() : nullptr;
+  T* Y_data = Y->data_ptr<T>();
+  T* mean_data = mean->data_ptr<T>();
+  T* rstd_data = rstd->data_ptr<T>();
+  const bool gamma_null = (gamma_data == nullptr);
+  const bool beta_null = beta_data == nullptr;
+
+  at::parallel_for(0, N * G, 1, [&](int64_t start, int64_t end) {
+    for (int64_t i = start; i < end; ++i) {
+      const int64_t n = i / G;
+      const int64_t g = i % G;
+      T mean_val;
+      T var_val;
+      std::tie(mean_val, var_val) =
+          RowwiseMoments(X_data + n * HxW * C + g * D, HxW, D, C);
+      mean_data[i] = mean_val;
+      rstd_data[i] = T(1) / std::sqrt(std::max(var_val, T(0)) + eps);
+    }
+  });
+
+  Tensor scale = at::empty({N, C}, X.options());
+  Tensor bias = at::empty({N, C}, X.options());
+  T* scale_data = scale.data_ptr<T>();
+  T* bias_data = bias.data_ptr<T>();
+  for (int64_t n = 0; n < N; ++n) {
+    for (int64_t c = 0; c < C; ++c) {
+      const int64_t i = n * G + c / D;
+      const T scale_val =
+          rstd_data[i] * (gamma_null ? T(1) : gamma_data[c]);
+      scale_data[n * C + c] = scale_val;
+      bias_data[n * C + c] =
+          -scale_val * mean_data[i] + (beta_null ? T(0) : beta_data[c]);
+    }
+  }
+
+  using Vec = vec256::Vec256<T>;
+  const int64_t grain_size =
+      std::max<int64_t>(at::internal::GRAIN_SIZE / C, 1);
+  at::parallel_for(0, N * HxW, grain_size, [&](int64_t start, int64_t end) {
+    constexpr int64_t K = Vec::size();
+    const int64_t inner_size = C / K * K;
+    for (int64_t i = start; i < end; ++i) {
+      const T* X_ptr = X_data + i * C;
+      T* Y_ptr = Y_data + i * C;
+      const T* scale_ptr = scale_data + i / HxW * C;
+      const T* bias_ptr = bias_data + i / HxW * C;
+      for (int64_t j = 0; j < inner_size; j += K) {
+        const Vec y_vec = Vec::loadu(X_ptr + j) * Vec::loadu(scale_ptr + j) +
+            Vec::loadu(bias_ptr + j);
+        y_vec.store(Y_ptr + j);
+      }
+      for (int64_t j = inner_size; j < C; ++j) {
+        Y_ptr[j] = scale_ptr[j] * X_ptr[j] + bias_ptr[j];
+      }
+    }
+  });
+}
+
 void GroupNormKernelImpl(
     const Tensor& X,
     const Tensor& gamma,
@@ -97,19 +236,35 @@ void GroupNormKernelImpl(
     Tensor* Y,
     Tensor* mean,
     Tensor* rstd) {
+  const bool channels_last = IsChannelsLast(X);
   AT_DISPATCH_FLOATING_TYPES(X.scalar_type(), "GroupNormKernelImpl", [&]() {
-    GroupNormKernelImplInternal<scalar_t>(
-        X,
-        gamma,
-        beta,
-        N,
-        C,
-        HxW,
-        group,
-        static_cast<scalar_t>(eps),
-        Y,
-        mean,
-        rstd);
+    if (channels_last) {
+      GroupNormChannelsLastKernelImplInternal<scalar_t>(
+          X,
+          gamma,
+          beta,
+          N,
+          C,
+          HxW,
+          group,
+          static_cast<scalar_t>(eps),
+          Y,
+          mean,
+          rstd);
+    } else {
+      GroupNormKernelImplInternal<scalar_t>(
+          X,
+          gamma,
+          beta,
+          N,
+          C,
+          HxW,
+          group,
+          static_cast<scalar_t>(eps),
+          Y,
+          mean,
+          rstd);
+    }
   });
 }
 
@@ -152,6 +307,55 @@ void ComputeInternalGradients(
   });
 }
 
+// Computes the coefficients c2 and c3 of the gradient
+// dX = c1 * dY + c2 * X + c3 shared by the channels of the group g of the
+// sample n, from the sums ds and db of their channels.
+template <typename T>
+std::pair<T, T> ComputeBackwardFusedParams(
+    int64_t C,
+    int64_t HxW,
+    int64_t group,
+    int64_t n,
+    int64_t g,
+    const T* mean,
+    const T* rstd,
+    const T* gamma,
+    const T* ds,
+    const T* db) {
+  const int64_t G = group;
+  const int64_t D = C / G;
+  const int64_t i = n * G + g;
+  const T s = T(1) / static_cast<T>(D * HxW);
+  const bool gamma_null = (gamma == nullptr);
+  constexpr int64_t K = vec256::Vec256<T>::size();
+  const int64_t d = D / K * K;
+  std::array<T, K> ds_arr;
+  std::array<T, K> db_arr;
+  const T* ds_ptr = ds + i * D;
+  const T* db_ptr = db + i * D;
+  vec256::Vec256<T> ds_vec(0);
+  vec256::Vec256<T> db_vec(0);
+  for (int64_t j = 0; j < d; j += K) {
+    const vec256::Vec256<T> gamma_vec = gamma_null
+        ? vec256::Vec256<T>(1)
+        : vec256::Vec256<T>::loadu(gamma + g * D + j);
+    ds_vec = ds_vec + vec256::Vec256<T>::loadu(ds_ptr + j) * gamma_vec;
+    db_vec = db_vec + vec256::Vec256<T>::loadu(db_ptr + j) * gamma_vec;
+  }
+  ds_vec.store(ds_arr.data());
+  db_vec.store(db_arr.data());
+  T ds_val = std::accumulate(ds_arr.cbegin(), ds_arr.cend(), T(0));
+  T db_val = std::accumulate(db_arr.cbegin(), db_arr.cend(), T(0));
+  for (int64_t j = d; j < D; ++j) {
+    const T gamma_v = gamma_null ? T(1) : gamma[g * D + j];
+    ds_val += ds_ptr[j] * gamma_v;
+    db_val += db_ptr[j] * gamma_v;
+  }
+  const T c2 = (db_val * mean[i] - ds_val) * rstd[i] * rstd[i] * rstd[i] * s;
+  const T c3 = -c2 * mean[i] - db_val * rstd[i] * s;
+  return std::make_pair(c2, c3);
+}
+
 template <typename T>
 void GroupNormInputBackward(
     int64_t N,
@@ -168,38 +372,14 @@ void GroupNormInputBackward(
     T* dX) {
   const int64_t G = group;
   const int64_t D = C / G;
-  const T s = T(1) / static_cast<T>(D * HxW);
   const bool gamma_null = (gamma == nullptr);
   at::parallel_for(0, N * G, 1, [=](int64_t start, int64_t end) {
-    constexpr int64_t K = vec256::Vec256<T>::size();
-    const int64_t d = D / K * K;
-    std::array<T, K> ds_arr;
-    std::array<T, K> db_arr;
     for (int64_t i = start; i < end; ++i) {
       const int64_t g = i % G;
-      const T* ds_ptr = ds + i * D;
-      const T* db_ptr = db + i * D;
-      vec256::Vec256<T> ds_vec(0);
-      vec256::Vec256<T> db_vec(0);
-      for (int64_t j = 0; j < d; j += K) {
-        const vec256::Vec256<T> gamma_vec = gamma_null
-            ? vec256::Vec256<T>(1)
-            : vec256::Vec256<T>::loadu(gamma + g * D + j);
-        ds_vec = ds_vec + vec256::Vec256<T>::loadu(ds_ptr + j) * gamma_vec;
-        db_vec = db_vec + vec256::Vec256<T>::loadu(db_ptr + j) * gamma_vec;
-      }
-      ds_vec.store(ds_arr.data());
-      db_vec.store(db_arr.data());
-      T ds_val = std::accumulate(ds_arr.cbegin(), ds_arr.cend(), T(0));
-      T db_val = std::accumulate(db_arr.cbegin(), db_arr.cend(), T(0));
-      for (int64_t j = d; j < D; ++j) {
-        const T gamma_v = gamma_null ? T(1) : gamma[g * D + j];
-        ds_val += ds_ptr[j] * gamma_v;
-        db_val += db_ptr[j] * gamma_v;
-      }
-      const T c2 =
-          (db_val * mean[i] - ds_val) * rstd[i] * rstd[i] * rstd[i] * s;
-      const T c3 = -c2 * mean[i] - db_val * rstd[i] * s;
+      T c2;
+      T c3;
+      std::tie(c2, c3) = ComputeBackwardFusedParams(
+          C, HxW, G, i / G, g, mean, rstd, gamma, ds, db);
       for (int64_t j = 0; j < D; ++j) {
         const int64_t c = g * D + j;
         const T* dY_ptr = dY + (i * D + j) * HxW;
@@ -214,6 +394,112 @@ void GroupNormInputBackward(
   });
 }
 
+// The channels-last counterparts of ComputeInternalGradients and
+// GroupNormInputBackward. The sums of each channel are accumulated over the
+// rows of the positions, and each row of dX is computed from the
+// coefficients of its channels.
+template <typename T>
+void ComputeInternalGradientsChannelsLast(
+    int64_t N,
+    int64_t C,
+    int64_t HxW,
+    const T* dY,
+    const T* X,
+    T* ds,
+    T* db) {
+  using Vec = vec256::Vec256<T>;
+  constexpr int64_t K = Vec::size();
+  at::parallel_for(0, C, K, [=](int64_t start, int64_t end) {
+    const int64_t inner_end = start + (end - start) / K * K;
+    for (int64_t n = 0; n < N; ++n) {
+      T* ds_ptr = ds + n * C;
+      T* db_ptr = db + n * C;
+      std::fill(ds_ptr + start, ds_ptr + end, T(0));
+      std::fill(db_ptr + start, db_ptr + end, T(0));
+      for (int64_t p = 0; p < HxW; ++p) {
+        const T* dY_ptr = dY + (n * HxW + p) * C;
+        const T* X_ptr = X + (n * HxW + p) * C;
+        for (int64_t j = start; j < inner_end; j += K) {
+          const Vec dy_vec = Vec::loadu(dY_ptr + j);
+          const Vec ds_vec =
+              Vec::loadu(ds_ptr + j) + dy_vec * Vec::loadu(X_ptr + j);
+          const Vec db_vec = Vec::loadu(db_ptr + j) + dy_vec;
+          ds_vec.store(ds_ptr + j);
+          db_vec.store(db_ptr + j);
+        }
+        for (int64_t j = inner_end; j < end; ++j) {
+          ds_ptr[j] += dY_ptr[j] * X_ptr[j];
+          db_ptr[j] += dY_ptr[j];
+        }
+      }
+    }
+  });
+}
+
+template <typename T>
+void GroupNormInputBackwardChannelsLast(
+    int64_t N,
+    int64_t C,
+    int64_t HxW,
+    int64_t group,
+    const T* dY,
+    const T* X,
+    const T* mean,
+    const T* rstd,
+    const T* gamma,
+    const T* ds,
+    const T* db,
+    T* dX) {
+  const int64_t G = group;
+  const int64_t D = C / G;
+  const bool gamma_null = (gamma == nullptr);
+  std::vector<T> c1(N * C);
+  std::vector<T> c2(N * C);
+  std::vector<T> c3(N * C);
+  for (int64_t n = 0; n < N; ++n) {
+    for (int64_t g = 0; g < G; ++g) {
+      const int64_t i = n * G + g;
+      T c2_val;
+      T c3_val;
+      std::tie(c2_val, c3_val) = ComputeBackwardFusedParams(
+          C, HxW, G, n, g, mean, rstd, gamma, ds, db);
+      for (int64_t c = g * D; c < (g + 1) * D; ++c) {
+        c1[n * C + c] = rstd[i] * (gamma_null ? T(1) : gamma[c]);
+        c2[n * C + c] = c2_val;
+        c3[n * C + c] = c3_val;
+      }
+    }
+  }
+
+  using Vec = vec256::Vec256<T>;
+  const T* c1_data = c1.data();
+  const T* c2_data = c2.data();
+  const T* c3_data = c3.data();
+  const int64_t grain_size =
+      std::max<int64_t>(at::internal::GRAIN_SIZE / C, 1);
+  at::parallel_for(0, N * HxW, grain_size, [=](int64_t start, int64_t end) {
+    constexpr int64_t K = Vec::size();
+    const int64_t inner_size = C / K * K;
+    for (int64_t i = start; i < end; ++i) {
+      const T* dY_ptr = dY + i * C;
+      const T* X_ptr = X + i * C;
+      T* dX_ptr = dX + i * C;
+      const T* c1_ptr = c1_data + i / HxW * C;
+      const T* c2_ptr = c2_data + i / HxW * C;
+      const T* c3_ptr = c3_data + i / HxW * C;
+      for (int64_t j = 0; j < inner_size; j += K) {
+        const Vec dx_vec = Vec::loadu(c1_ptr + j) * Vec::loadu(dY_ptr + j) +
+            Vec::loadu(c2_ptr + j) * Vec::loadu(X_ptr + j) +
+            Vec::loadu(c3_ptr + j);
+        dx_vec.store(dX_ptr + j);
+      }
+      for (int64_t j = inner_size; j < C; ++j) {
+        dX_ptr[j] = c1_ptr[j] * dY_ptr[j] + c2_ptr[j] * X_ptr[j] + c3_ptr[j];
+      }
+    }
+  });
+}
+
 template <typename T>
 void GammaBackward(
     int64_t N,
@@ -290,10 +576,18 @@ void GroupNormBackwardKernelImplInternal(
   T* ds_data = ds.data_ptr<T>();
   T* db_data = db.data_ptr<T>();
 
-  ComputeInternalGradients<T>(N, C, HxW, dY_data, X_data, ds_data, db_data);
+  const bool channels_last = IsChannelsLast(X);
+  if (channels_last) {
+    ComputeInternalGradientsChannelsLast<T>(
+        N, C, HxW, dY_data, X_data, ds_data, db_data);
+  } else {
+    ComputeInternalGradients<T>(N, C, HxW, dY_data, X_data, ds_data, db_data);
+  }
 
   if (dX_data != nullptr) {
-    GroupNormInputBackward<T>(
+    auto input_backward = channels_last ? GroupNormInputBackwardChannelsLast<T>
+                                        : GroupNormInputBackward<T>;
+    input_backward(
         N,
         C,
         HxW,
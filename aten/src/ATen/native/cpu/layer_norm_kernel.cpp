@@ -1,12 +1,18 @@
 #include <ATen/native/layer_norm.h>
 
 #include <cmath>
+#include <tuple>
 
 #include <ATen/ATen.h>
 #include <ATen/CPUApplyUtils.h>
 #include <ATen/Dispatch.h>
+#if defined(CPU_CAPABILITY_AVX512)
+#include <ATen/cpu/vec512/functional.h>
+#include <ATen/cpu/vec512/vec512.h>
+#else
 #include <ATen/cpu/vec256/functional.h>
 #include <ATen/cpu/vec256/vec256.h>
+#endif
 #include <ATen/Parallel.h>
 
 namespace at {
@@ -14,6 +20,17 @@ namespace native {
 
 namespace {
 
+// Use the full register width of the capability this file is compiled for.
+#if defined(CPU_CAPABILITY_AVX512)
+namespace vec = vec512;
+template <typename T>
+using Vectorized = vec512::Vec512<T>;
+#else
+namespace vec = vec256;
+template <typename T>
+using Vectorized = vec256::Vec256<T>;
+#endif
+
 template <typename T>
 void LayerNormKernelImplInternal(
     const Tensor& X,
@@ -21,11 +38,11 @@ void LayerNormKernelImplInternal(
     const Tensor& beta,
     int64_t M,
     int64_t N,
-    T eps,
+    double eps,
     Tensor* Y,
     Tensor* mean,
     Tensor* rstd) {
-  using Vec = vec256::Vec256<T>;
+  using Vec = Vectorized<T>;
   DCHECK_EQ(X.numel(), M * N);
   DCHECK(!gamma.defined() || gamma.numel() == N);
   DCHECK(!beta.defined() || beta.numel() == N);
@@ -42,18 +59,18 @@ void LayerNormKernelImplInternal(
     for (int64_t i = start; i < end; ++i) {
       T* X_ptr = X_data + i * N;
       T* Y_ptr = Y_data + i * N;
-      T mean_val = vec256::reduce_all<T>(
+      T mean_val = vec::reduce_all<T>(
           [](Vec& x, Vec& y) { return x + y; },
           X_ptr,
           N);
-      T rstd_val = vec256::map_reduce_all<T>(
+      T rstd_val = vec::map_reduce_all<T>(
           [](Vec x) { return x * x; },
           [](Vec x, Vec y) { return x + y; },
           X_ptr,
           N);
       mean_val *= c;
       rstd_val = std::max(rstd_val * c - mean_val * mean_val, T(0));
-      rstd_val = T(1) / std::sqrt(rstd_val + eps);
+      rstd_val = T(1) / std::sqrt(rstd_val + static_cast<T>(eps));
       const T scale = rstd_val;
       const T bias = -rstd_val * mean_val;
       if (gamma_null || beta_null) {
@@ -63,7 +80,7 @@ void LayerNormKernelImplInternal(
           Y_ptr[j] = (X_ptr[j] * scale + bias) * gamma_v + beta_v;
         }
       } else {
-        vec256::map3<T>(
+        vec::map3<T>(
             [scale, bias](Vec x, Vec gamma, Vec beta) {
               return (x * Vec(scale) + Vec(bias)) * gamma + beta;
             },
@@ -79,7 +96,11 @@ void LayerNormKernelImplInternal(
   });
 }
 
-void LayerNormKernelImpl(
+// BFloat16 inputs are widened to float in registers (see Note [BFloat16
+// functional helpers]); the statistics are computed in float and only rounded
+// to BFloat16 when written to Y, mean and rstd.
+template <>
+void LayerNormKernelImplInternal<BFloat16>(
     const Tensor& X,
     const Tensor& gamma,
     const Tensor& beta,
@@ -89,12 +110,77 @@ void LayerNormKernelImpl(
     Tensor* Y,
     Tensor* mean,
     Tensor* rstd) {
-  AT_DISPATCH_FLOATING_TYPES(X.scalar_type(), "LayerNormKernelImpl", [&]() {
-    LayerNormKernelImplInternal<scalar_t>(
-        X, gamma, beta, M, N, static_cast<scalar_t>(eps), Y, mean, rstd);
+  using fVec = Vectorized<float>;
+  DCHECK_EQ(X.numel(), M * N);
+  DCHECK(!gamma.defined() || gamma.numel() == N);
+  DCHECK(!beta.defined() || beta.numel() == N);
+  const BFloat16* X_data = X.data_ptr<BFloat16>();
+  const BFloat16* gamma_data = gamma.defined() ? gamma.data_ptr<BFloat16>() : nullptr;
+  const BFloat16* beta_data = beta.defined() ? beta.data_ptr<BFloat16>() : nullptr;
+  BFloat16* Y_data = Y->data_ptr<BFloat16>();
+  BFloat16* mean_data = mean->data_ptr<BFloat16>();
+  BFloat16* rstd_data = rstd->data_ptr<BFloat16>();
+  const float c = 1.0f / static_cast<float>(N);
+  const bool gamma_null = gamma_data == nullptr;
+  const bool beta_null = beta_data == nullptr;
+  at::parallel_for(0, M, 1, [&](int64_t start, int64_t end) {
+    for (int64_t i = start; i < end; ++i) {
+      const BFloat16* X_ptr = X_data + i * N;
+      BFloat16* Y_ptr = Y_data + i * N;
+      float mean_val = vec::reduce_all(
+          [](fVec& x, fVec& y) { return x + y; },
+          X_ptr,
+          N);
+      float rstd_val = vec::map_reduce_all(
+          [](fVec x) { return x * x; },
+          [](fVec x, fVec y) { return x + y; },
+          X_ptr,
+          N);
+      mean_val *= c;
+      rstd_val = std::max(rstd_val * c - mean_val * mean_val, 0.0f);
+      rstd_val = 1.0f / std::sqrt(rstd_val + static_cast<float>(eps));
+      const float scale = rstd_val;
+      const float bias = -rstd_val * mean_val;
+      if (gamma_null || beta_null) {
+        for (int64_t j = 0; j < N; ++j) {
+          const float gamma_v = gamma_null ? 1.0f : static_cast<float>(gamma_data[j]);
+          const float beta_v = beta_null ? 0.0f : static_cast<float>(beta_data[j]);
+          Y_ptr[j] = (static_cast<float>(X_ptr[j]) * scale + bias) * gamma_v + beta_v;
+        }
+      } else {
+        vec::map3(
+            [scale, bias](fVec x, fVec gamma, fVec beta) {
+              return (x * fVec(scale) + fVec(bias)) * gamma + beta;
+            },
+            Y_ptr,
+            X_ptr,
+            gamma_data,
+            beta_data,
+            N);
+      }
+      mean_data[i] = mean_val;
+      rstd_data[i] = rstd_val;
+    }
   });
 }
 
+void LayerNormKernelImpl(
+    const Tensor& X,
+    const Tensor& gamma,
+    const Tensor& beta,
+    int64_t M,
+    int64_t N,
+    double eps,
+    Tensor* Y,
+    Tensor* mean,
+    Tensor* rstd) {
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      at::ScalarType::BFloat16, X.scalar_type(), "LayerNormKernelImpl", [&]() {
+        LayerNormKernelImplInternal<scalar_t>(
+            X, gamma, beta, M, N, eps, Y, mean, rstd);
+      });
+}
+
 template <typename T>
 void LayerNormBackwardKernelImplInternal(
     const Tensor& dY,
@@ -107,7 +193,7 @@ void LayerNormBackwardKernelImplInternal(
     Tensor* dX,
     Tensor* dgamma,
     Tensor* dbeta) {
-  using Vec = vec256::Vec256<T>;
+  using Vec = Vectorized<T>;
   DCHECK_EQ(dY.numel(), M * N);
   DCHECK_EQ(X.numel(), M * N);
   DCHECK_EQ(mean.numel(), M);
@@ -161,7 +247,7 @@ void LayerNormBackwardKernelImplInternal(
         // for (int64_t j = 0; j < N; ++j) {
         //   dgamma_data[j] += dY_ptr[j] * (a * X_ptr[j] + b);
         // }
-        vec256::map3<T>(
+        vec::map3<T>(
             [a, b](Vec dgamma, Vec dy, Vec x) { return dgamma + dy * (Vec(a) * x + Vec(b)); },
             dgamma_buffer_ptr,
             dgamma_buffer_ptr,
@@ -174,7 +260,7 @@ void LayerNormBackwardKernelImplInternal(
         // for (int64_t j = 0; j < N; ++j) {
         //   dbeta_data[j] += dY_ptr[j];
         // }
-        vec256::map2<T>(
+        vec::map2<T>(
             [](Vec dbeta, Vec dy) { return dbeta + dy; },
             dbeta_buffer_ptr,
             dbeta_buffer_ptr,
@@ -192,25 +278,25 @@ void LayerNormBackwardKernelImplInternal(
         //   db += dY_ptr[j] * gamma_v;
         // }
         if (gamma_null) {
-          ds = vec256::map2_reduce_all<T>(
+          ds = vec::map2_reduce_all<T>(
               [](Vec x, Vec y) { return x * y; },
               [](Vec x, Vec y) { return x + y; },
               dY_ptr,
               X_ptr,
               N);
-          db = vec256::reduce_all<T>(
+          db = vec::reduce_all<T>(
               [](Vec& x, Vec& y) { return x + y; },
               dY_ptr,
               N);
         } else {
-          ds = vec256::map3_reduce_all<T>(
+          ds = vec::map3_reduce_all<T>(
               [](Vec x, Vec y, Vec z) { return x * y * z; },
               [](Vec x, Vec y) { return x + y; },
               dY_ptr,
               X_ptr,
               gamma_data,
               N);
-          db = vec256::map2_reduce_all<T>(
+          db = vec::map2_reduce_all<T>(
               [](Vec x, Vec y) { return x * y; },
               [](Vec x, Vec y) { return x + y; },
               dY_ptr,
@@ -226,14 +312,14 @@ void LayerNormBackwardKernelImplInternal(
         //   dX_ptr[j] = a * dY_ptr[j] * gamma_v + b * X_ptr[j] + c;
         // }
         if (gamma_null) {
-          vec256::map2<T>(
+          vec::map2<T>(
               [a, b, c](Vec dy, Vec x) { return Vec(a) * dy + Vec(b) * x + Vec(c); },
               dX_ptr,
               dY_ptr,
               X_ptr,
               N);
         } else {
-          vec256::map3<T>(
+          vec::map3<T>(
               [a, b, c](Vec dy, Vec gamma, Vec x) { return Vec(a) * dy * gamma + Vec(b) * x + Vec(c); },
               dX_ptr,
               dY_ptr,
@@ -266,6 +352,175 @@ void LayerNormBackwardKernelImplInternal(
   }
 }
 
+template <>
+void LayerNormBackwardKernelImplInternal<BFloat16>(
+    const Tensor& dY,
+    const Tensor& X,
+    const Tensor& mean,
+    const Tensor& rstd,
+    const Tensor& gamma,
+    int64_t M,
+    int64_t N,
+    Tensor* dX,
+    Tensor* dgamma,
+    Tensor* dbeta) {
+  using bVec = Vectorized<BFloat16>;
+  using fVec = Vectorized<float>;
+  DCHECK_EQ(dY.numel(), M * N);
+  DCHECK_EQ(X.numel(), M * N);
+  DCHECK_EQ(mean.numel(), M);
+  DCHECK_EQ(rstd.numel(), M);
+  DCHECK(!gamma.defined() || gamma.numel() == N);
+  const BFloat16* dY_data = dY.data_ptr<BFloat16>();
+  const BFloat16* X_data = X.data_ptr<BFloat16>();
+  const BFloat16* mean_data = mean.data_ptr<BFloat16>();
+  const BFloat16* rstd_data = rstd.data_ptr<BFloat16>();
+  const BFloat16* gamma_data = gamma.defined() ? gamma.data_ptr<BFloat16>() : nullptr;
+  BFloat16* dX_data = dX->defined() ? dX->data_ptr<BFloat16>() : nullptr;
+  BFloat16* dgamma_data = dgamma->defined() ? dgamma->data_ptr<BFloat16>() : nullptr;
+  BFloat16* dbeta_data = dbeta->defined() ? dbeta->data_ptr<BFloat16>() : nullptr;
+  const float scale = 1.0f / static_cast<float>(N);
+  const bool gamma_null = gamma_data == nullptr;
+  const bool dX_null = dX_data == nullptr;
+  const bool dgamma_null = dgamma_data == nullptr;
+  const bool dbeta_null = dbeta_data == nullptr;
+
+  // Same two path reduction as the generic version above, except that the
+  // immediate dgamma/dbeta buffer is float so that the sum over M is not
+  // rounded to BFloat16 once per row.
+  int num_threads = at::get_num_threads();
+  Tensor buffer = at::empty({0}, X.options().dtype(kFloat));
+  float* buffer_data = nullptr;
+  if (!dgamma_null || !dbeta_null) {
+    buffer.resize_({2, num_threads, N}).zero_();
+    buffer_data = buffer.data_ptr<float>();
+  }
+
+  // First path of dgamma/dbeta and dX
+  at::parallel_for(0, M, 1, [&](int64_t start, int64_t end) {
+    int tid = at::get_thread_num();
+    TORCH_CHECK(tid < num_threads,
+                "expect thread id smaller than ", num_threads, ", got thread id ", tid);
+    float* dgamma_buffer_ptr = dgamma_null ? nullptr : buffer_data + tid * N;
+    float* dbeta_buffer_ptr = dbeta_null ? nullptr : buffer_data + num_threads * N + tid * N;
+    for (int64_t i = start; i < end; ++i) {
+      const BFloat16* dY_ptr = dY_data + i * N;
+      const BFloat16* X_ptr = X_data + i * N;
+      const float mean_v = static_cast<float>(mean_data[i]);
+      const float rstd_v = static_cast<float>(rstd_data[i]);
+      if (!dgamma_null || !dbeta_null) {
+        // Scalar math:
+        // for (int64_t j = 0; j < N; ++j) {
+        //   dgamma_data[j] += dY_ptr[j] * (a * X_ptr[j] + b);
+        //   dbeta_data[j] += dY_ptr[j];
+        // }
+        const float a = rstd_v;
+        const float b = -a * mean_v;
+        int64_t j = 0;
+        for (; j < N - (N % bVec::size()); j += bVec::size()) {
+          fVec dy_fvec0, dy_fvec1;
+          std::tie(dy_fvec0, dy_fvec1) = vec::convert_bfloat16_float(bVec::loadu(dY_ptr + j));
+          if (!dgamma_null) {
+            fVec x_fvec0, x_fvec1;
+            std::tie(x_fvec0, x_fvec1) = vec::convert_bfloat16_float(bVec::loadu(X_ptr + j));
+            fVec dgamma_fvec0 = fVec::loadu(dgamma_buffer_ptr + j) +
+                dy_fvec0 * (fVec(a) * x_fvec0 + fVec(b));
+            fVec dgamma_fvec1 = fVec::loadu(dgamma_buffer_ptr + j + fVec::size()) +
+                dy_fvec1 * (fVec(a) * x_fvec1 + fVec(b));
+            dgamma_fvec0.store(dgamma_buffer_ptr + j);
+            dgamma_fvec1.store(dgamma_buffer_ptr + j + fVec::size());
+          }
+          if (!dbeta_null) {
+            fVec dbeta_fvec0 = fVec::loadu(dbeta_buffer_ptr + j) + dy_fvec0;
+            fVec dbeta_fvec1 = fVec::loadu(dbeta_buffer_ptr + j + fVec::size()) + dy_fvec1;
+            dbeta_fvec0.store(dbeta_buffer_ptr + j);
+            dbeta_fvec1.store(dbeta_buffer_ptr + j + fVec::size());
+          }
+        }
+        for (; j < N; ++j) {
+          const float dy = static_cast<float>(dY_ptr[j]);
+          if (!dgamma_null) {
+            dgamma_buffer_ptr[j] += dy * (a * static_cast<float>(X_ptr[j]) + b);
+          }
+          if (!dbeta_null) {
+            dbeta_buffer_ptr[j] += dy;
+          }
+        }
+      }
+      if (!dX_null) {
+        BFloat16* dX_ptr = dX_data + i * N;
+        float ds = 0.0f;
+        float db = 0.0f;
+        if (gamma_null) {
+          ds = vec::map2_reduce_all(
+              [](fVec x, fVec y) { return x * y; },
+              [](fVec x, fVec y) { return x + y; },
+              dY_ptr,
+              X_ptr,
+              N);
+          db = vec::reduce_all(
+              [](fVec& x, fVec& y) { return x + y; },
+              dY_ptr,
+              N);
+        } else {
+          ds = vec::map3_reduce_all(
+              [](fVec x, fVec y, fVec z) { return x * y * z; },
+              [](fVec x, fVec y) { return x + y; },
+              dY_ptr,
+              X_ptr,
+              gamma_data,
+              N);
+          db = vec::map2_reduce_all(
+              [](fVec x, fVec y) { return x * y; },
+              [](fVec x, fVec y) { return x + y; },
+              dY_ptr,
+              gamma_data,
+              N);
+        }
+        const float a = rstd_v;
+        const float b = (db * mean_v - ds) * a * a * a * scale;
+        const float c = -b * mean_v - db * a * scale;
+        if (gamma_null) {
+          vec::map2(
+              [a, b, c](fVec dy, fVec x) { return fVec(a) * dy + fVec(b) * x + fVec(c); },
+              dX_ptr,
+              dY_ptr,
+              X_ptr,
+              N);
+        } else {
+          vec::map3(
+              [a, b, c](fVec dy, fVec gamma, fVec x) { return fVec(a) * dy * gamma + fVec(b) * x + fVec(c); },
+              dX_ptr,
+              dY_ptr,
+              gamma_data,
+              X_ptr,
+              N);
+        }
+      }
+    }
+  });
+
+  // Second path of dgamma/dbeta
+  if (buffer_data != nullptr) {
+    parallel_for(0, N, 1, [&](int64_t start, int64_t end) {
+      for (int64_t j = start; j < end; ++j) {
+        float dgamma_v = 0.0f;
+        float dbeta_v = 0.0f;
+        for (int64_t i = 0; i < num_threads; ++i) {
+          dgamma_v += buffer_data[i * N + j];
+          dbeta_v += buffer_data[num_threads * N + i * N + j];
+        }
+        if (!dgamma_null) {
+          dgamma_data[j] = dgamma_v;
+        }
+        if (!dbeta_null) {
+          dbeta_data[j] = dbeta_v;
+        }
+      }
+    });
+  }
+}
+
 void LayerNormBackwardKernelImpl(
     const Tensor& dY,
     const Tensor& X,
@@ -277,8 +532,8 @@ void LayerNormBackwardKernelImpl(
     Tensor* dX,
     Tensor* dgamma,
     Tensor* dbeta) {
-  AT_DISPATCH_FLOATING_TYPES(
-      X.scalar_type(), "LayerNormBackwardKernelImpl", [&]() {
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      at::ScalarType::BFloat16, X.scalar_type(), "LayerNormBackwardKernelImpl", [&]() {
         LayerNormBackwardKernelImplInternal<scalar_t>(
             dY, X, mean, rstd, gamma, M, N, dX, dgamma, dbeta);
       });
@@ -5,7 +5,9 @@
 #include <ATen/ATen.h>
 #include <ATen/Dispatch.h>
 #include <ATen/native/TensorIterator.h>
+#include <ATen/native/ForeachUtils.h>
 #include <ATen/native/cuda/Loops.cuh>
+#include <ATen/native/cuda/MultiTensorApply.cuh>
 
 namespace {
 // Thin wrapper around https://docs.nvidia.com/cuda/cuda-math-api/group__CUDA__MATH__SINGLE.html#group__CUDA__MATH__SINGLE_1g57a3c8313f570282a1a7bcc78743b08e,
@@ -80,6 +82,86 @@ void _amp_non_finite_check_and_unscale_cuda_(Tensor& scaled_grad,
 }
 
 
+namespace {
+
+// Unscales one chunk of a tensor in place, like the gpu_kernel lambda of
+// _amp_non_finite_check_and_unscale_cuda_.
+template<typename scalar_t>
+struct NonFiniteCheckAndUnscaleFunctor {
+  __device__ __forceinline__ void operator() (
+      int chunk_size,
+      TensorListMetadata<1>& tl,
+      float* found_inf_ptr,
+      const float* inv_scale_ptr) {
+    const int tensor_loc = tl.block_to_tensor[blockIdx.x];
+    const int chunk_idx = tl.block_to_chunk[blockIdx.x];
+    const int n = tl.sizes[tensor_loc] - chunk_idx * chunk_size;
+    scalar_t* x = (scalar_t*)tl.addresses[0][tensor_loc] + chunk_idx * chunk_size;
+
+    const auto inv_scale_val = *inv_scale_ptr;
+    for (int i = threadIdx.x; i < n && i < chunk_size; i += blockDim.x) {
+      float fval = static_cast<float>(x[i]);
+      // See isfinite_ensure_cuda_math above.
+      if (!isfinite_ensure_cuda_math(fval)) {
+        *found_inf_ptr = 1.f;
+      }
+      x[i] = static_cast<scalar_t>(inv_scale_val == 1.f ? fval : fval*inv_scale_val);
+    }
+  }
+};
+
+} // anonymous namespace
+
+// _amp_non_finite_check_and_unscale_cuda_ for a list of gradients, which takes
+// one kernel launch for many tensors when they are dense and of one dtype and
+// device. Other lists are unscaled one tensor at a time.
+//
+// Args:
+// scaled_grads:  A list of (scaled) gradient tensors.  May contain infs or NaNs.
+// found_inf:  A single-element float tensor to which 1.0 will be written if any gradients contain infs/nans.
+//             Pre-zeroing found_inf, if appropriate, is the responsibility of the caller.
+// inv_scale:  The inverse of the scale factor by which the scaled_grads are currently multiplied.
+void _amp_foreach_non_finite_check_and_unscale_cuda_(TensorList scaled_grads,
+                                                     Tensor& found_inf,
+                                                     const Tensor& inv_scale)
+{
+  if (scaled_grads.size() == 0) {
+    return;
+  }
+
+  TORCH_CHECK(inv_scale.is_cuda(), "inv_scale must be a CUDA tensor.");
+  TORCH_CHECK(found_inf.is_cuda(), "found_inf must be a CUDA tensor.");
+  TORCH_CHECK(inv_scale.numel() == 1, "inv_scale must be a 1-element tensor.");
+  TORCH_CHECK(found_inf.numel() == 1, "found_inf must be a 1-element tensor.");
+  TORCH_CHECK(inv_scale.scalar_type() == at::ScalarType::Float, "inv_scale must be a float tensor.");
+  TORCH_CHECK(found_inf.scalar_type() == at::ScalarType::Float, "found_inf must be a float tensor.");
+
+  if (!can_use_fast_route({scaled_grads}) ||
+      scaled_grads[0].device() != found_inf.device() ||
+      scaled_grads[0].device() != inv_scale.device()) {
+    for (const auto& t : scaled_grads) {
+      Tensor scaled_grad = t;
+      _amp_non_finite_check_and_unscale_cuda_(scaled_grad, found_inf, inv_scale);
+    }
+    return;
+  }
+
+  TORCH_CHECK(scaled_grads[0].is_cuda(), "scaled_grads must be CUDA tensors.");
+
+  std::vector<std::vector<at::Tensor>> tensor_lists;
+  tensor_lists.emplace_back(scaled_grads.vec());
+
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(
+    scaled_grads[0].scalar_type(),
+    "_amp_foreach_non_finite_check_and_unscale_cuda",
+    [&tensor_lists, &found_inf, &inv_scale] {
+      multi_tensor_apply<1>(tensor_lists,
+                            NonFiniteCheckAndUnscaleFunctor<scalar_t>(),
+                            found_inf.data_ptr<float>(),
+                            inv_scale.data_ptr<float>());
+    });
+}
+
 // amp_update_scale_cuda_kernel is launched with a single thread to compute the new scale.
 // The scale factor is maintained and updated on the GPU to avoid synchronization.
 __global__ void amp_update_scale_cuda_kernel(int* growth_tracker,
@@ -1,5 +1,6 @@
 #include <ATen/Context.h>
 #include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/CUDABlas.h>
 #include <ATen/Dispatch.h>
 #include <ATen/NativeFunctions.h>
 #include <ATen/cuda/PinnedMemoryAllocator.h>
@@ -528,6 +529,113 @@ void magmaLuSolveBatched<float>(
   auto storage_##name = pin_memory<type>(size); \
   name = static_cast<type*>(storage_##name.data());
 
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ cuBLAS batched LU ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+// The batched LU routines of cuBLAS factor, invert or solve every matrix of a
+// batch of small matrices in a single kernel, without the queue of MAGMA nor
+// its launches per column, and are much faster for these batches. MAGMA keeps
+// the larger matrices, which cuBLAS handles one thread block per matrix.
+constexpr int64_t kCublasBatchedLuMaxSize = 32;
+
+static inline bool use_cublas_batched_lu(const Tensor& A) {
+#ifdef __HIP_PLATFORM_HCC__
+  return false;
+#else
+  return A.dim() > 2 && batchCount(A) > 1 &&
+      A.size(-1) <= kCublasBatchedLuMaxSize &&
+      batchCount(A) <= std::numeric_limits<int>::max();
+#endif
+}
+
+// The device pointers to the matrices of a batch of matrices, computed on the
+// device.
+template <typename scalar_t>
+static Tensor batched_matrix_pointers(const Tensor& self) {
+  auto base = reinterpret_cast<int64_t>(self.data_ptr<scalar_t>());
+  int64_t stride = matrixStride(self) * sizeof(scalar_t);
+  return at::arange(batchCount(self), self.options().dtype(at::kLong))
+      .mul_(stride)
+      .add_(base);
+}
+
+template <typename scalar_t>
+static scalar_t** matrix_array(Tensor& pointers) {
+  return reinterpret_cast<scalar_t**>(pointers.data_ptr<int64_t>());
+}
+
+static void copy_infos(const Tensor& infos_tensor, std::vector<int64_t>& infos) {
+  auto infos_cpu = infos_tensor.cpu();
+  auto infos_data = infos_cpu.data_ptr<int>();
+  std::copy(infos_data, infos_data + infos_cpu.numel(), infos.begin());
+}
+
+template <typename scalar_t>
+static void apply_solve_cublas(Tensor& b, Tensor& A, std::vector<int64_t>& infos) {
+  int n = A.size(-2);
+  int nrhs = b.size(-1);
+  int batch_size = batchCount(A);
+  auto A_pointers = batched_matrix_pointers<scalar_t>(A);
+  auto b_pointers = batched_matrix_pointers<scalar_t>(b);
+  auto pivots = at::empty({batch_size, n}, A.options().dtype(at::kInt));
+  auto infos_tensor = at::empty({batch_size}, A.options().dtype(at::kInt));
+
+  at::cuda::blas::getrfBatched<scalar_t>(
+      n, matrix_array<scalar_t>(A_pointers), n, pivots.data_ptr<int>(),
+      infos_tensor.data_ptr<int>(), batch_size);
+  int info = 0;
+  at::cuda::blas::getrsBatched<scalar_t>(
+      n, nrhs, matrix_array<scalar_t>(A_pointers), n, pivots.data_ptr<int>(),
+      matrix_array<scalar_t>(b_pointers), n, &info, batch_size);
+  TORCH_INTERNAL_ASSERT(info == 0, "getrsBatched: Argument ", -info, " has illegal value");
+  copy_infos(infos_tensor, infos);
+}
+
+template <typename scalar_t>
+static void apply_inverse_cublas(Tensor& self, Tensor& self_inv, std::vector<int64_t>& infos) {
+  int n = self.size(-2);
+  int batch_size = batchCount(self);
+  auto self_pointers = batched_matrix_pointers<scalar_t>(self);
+  auto self_inv_pointers = batched_matrix_pointers<scalar_t>(self_inv);
+  auto pivots = at::empty({batch_size, n}, self.options().dtype(at::kInt));
+  auto infos_lu = at::empty({batch_size}, self.options().dtype(at::kInt));
+  auto infos_getri = at::empty({batch_size}, self.options().dtype(at::kInt));
+
+  at::cuda::blas::getrfBatched<scalar_t>(
+      n, matrix_array<scalar_t>(self_pointers), n, pivots.data_ptr<int>(),
+      infos_lu.data_ptr<int>(), batch_size);
+  at::cuda::blas::getriBatched<scalar_t>(
+      n, matrix_array<scalar_t>(self_pointers), n, pivots.data_ptr<int>(),
+      matrix_array<scalar_t>(self_inv_pointers), n, infos_getri.data_ptr<int>(),
+      batch_size);
+  // Both report the singular matrices, the factorization first.
+  copy_infos(at::where(infos_lu != 0, infos_lu, infos_getri), infos);
+}
+
+template <typename scalar_t>
+static void apply_lu_cublas(Tensor& self, Tensor& pivots, Tensor& infos, bool get_pivots) {
+  int n = self.size(-1);
+  int batch_size = batchCount(self);
+  auto self_pointers = batched_matrix_pointers<scalar_t>(self);
+  at::cuda::blas::getrfBatched<scalar_t>(
+      n, matrix_array<scalar_t>(self_pointers), n,
+      get_pivots ? pivots.data_ptr<int>() : nullptr, infos.data_ptr<int>(),
+      batch_size);
+}
+
+template <typename scalar_t>
+static void apply_lu_solve_cublas(Tensor& b, const Tensor& lu, const Tensor& pivots, int64_t& info) {
+  int n = lu.size(-2);
+  int nrhs = b.size(-1);
+  int batch_size = batchCount(b);
+  auto lu_pointers = batched_matrix_pointers<scalar_t>(lu);
+  auto b_pointers = batched_matrix_pointers<scalar_t>(b);
+  int info_tmp = 0;
+  at::cuda::blas::getrsBatched<scalar_t>(
+      n, nrhs, matrix_array<scalar_t>(lu_pointers), n, pivots.data_ptr<int>(),
+      matrix_array<scalar_t>(b_pointers), n, &info_tmp, batch_size);
+  info = info_tmp;
+}
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ solve ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 template <typename scalar_t>
@@ -609,7 +717,11 @@ std::tuple<Tensor, Tensor> _solve_helper_cuda(const Tensor& self, const Tensor&
   auto A_working_copy = cloneBatchedColumnMajor(A);
   std::vector<int64_t> infos(batchCount(self), 0);
   AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "solve_cuda", [&]{
-    apply_solve<scalar_t>(self_working_copy, A_working_copy, infos);
+    if (use_cublas_batched_lu(A_working_copy)) {
+      apply_solve_cublas<scalar_t>(self_working_copy, A_working_copy, infos);
+    } else {
+      apply_solve<scalar_t>(self_working_copy, A_working_copy, infos);
+    }
   });
   if (self.dim() > 2) {
     batchCheckErrors(infos, "solve_cuda");
@@ -719,8 +831,13 @@ Tensor _inverse_helper_cuda(const Tensor& self) {
     std::vector<int64_t> infos(batchCount(self), 0);
     auto self_working_copy = cloneBatchedColumnMajor(self);
     AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "inverse_cuda", [&]{
-      apply_batched_inverse<scalar_t>(
-        self_working_copy, self_inv_working_copy, infos);
+      if (use_cublas_batched_lu(self_working_copy)) {
+        apply_inverse_cublas<scalar_t>(
+          self_working_copy, self_inv_working_copy, infos);
+      } else {
+        apply_batched_inverse<scalar_t>(
+          self_working_copy, self_inv_working_copy, infos);
+      }
     });
     batchCheckErrors(infos, "inverse_cuda");
   } else {
@@ -985,7 +1102,11 @@ std::tuple<Tensor, Tensor, Tensor> _lu_with_info_cuda(const Tensor& self, bool p
   } else {
     self_working_copy = cloneBatchedColumnMajor(self);
     AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "lu_cuda", [&]{
+      if (m == n && use_cublas_batched_lu(self_working_copy)) {
+        apply_lu_cublas<scalar_t>(self_working_copy, pivots_tensor, infos_tensor, pivot);
+      } else {
         apply_lu<scalar_t>(self_working_copy, pivots_tensor, infos_tensor, pivot);
+      }
     });
   }
   if (check_errors) {
@@ -1458,7 +1579,11 @@ Tensor _lu_solve_helper_cuda(const Tensor& self, const Tensor& LU_data, const Te
     return at::zeros_like(self, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
   }
   AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "lu_solve_cuda", [&]{
-    apply_lu_solve<scalar_t>(self_working_copy, LU_data_working_copy, LU_pivots_working_copy, info);
+    if (use_cublas_batched_lu(LU_data_working_copy)) {
+      apply_lu_solve_cublas<scalar_t>(self_working_copy, LU_data_working_copy, LU_pivots_working_copy, info);
+    } else {
+      apply_lu_solve<scalar_t>(self_working_copy, LU_data_working_copy, LU_pivots_working_copy, info);
+    }
   });
   TORCH_CHECK(info == 0, "MAGMA lu_solve : invalid argument: ", -info);
   return self_working_copy;
@@ -1,3 +1,4 @@
+#include <ATen/AccumulateType.h>
 #include <ATen/Dispatch.h>
 #include <ATen/native/DispatchStub.h>
 #include <ATen/native/cuda/Loops.cuh>
@@ -32,6 +33,46 @@ void remainder_kernel_cuda(TensorIterator& iter) {
   }
 }
 
+void fmod_kernel_cuda(TensorIterator& iter) {
+  if (isIntegralType(iter.dtype(), /*includeBool*/ false)) {
+    AT_DISPATCH_INTEGRAL_TYPES(iter.dtype(), "fmod_cuda", [&]() {
+      gpu_kernel_with_scalars(iter, []GPU_LAMBDA(scalar_t a, scalar_t b) -> scalar_t {
+        return a % b;
+      });
+    });
+  } else {
+    AT_DISPATCH_FLOATING_TYPES_AND_HALF(iter.dtype(), "fmod_cuda", [&]() {
+      gpu_kernel_with_scalars(iter,
+        []GPU_LAMBDA(scalar_t a, scalar_t b) __ubsan_ignore_float_divide_by_zero__ -> scalar_t {
+          return ::fmod(a, b);
+        });
+    });
+  }
+}
+
+void fmod_scalar_kernel_cuda(TensorIterator& iter, Scalar divisor) {
+  if (isIntegralType(iter.dtype(), /*includeBool*/ false)) {
+    AT_DISPATCH_INTEGRAL_TYPES(iter.dtype(), "fmod_scalar_cuda", [&]() {
+      const auto div = divisor.to<scalar_t>();
+      TORCH_CHECK(div != 0, "ZeroDivisionError");
+      gpu_kernel(iter, [div]GPU_LAMBDA(scalar_t a) -> scalar_t {
+        return a % div;
+      });
+    });
+  } else {
+    AT_DISPATCH_FLOATING_TYPES_AND_HALF(iter.dtype(), "fmod_scalar_cuda", [&]() {
+      using accscalar_t = at::acc_type<scalar_t, true>;
+      const auto div = divisor.to<accscalar_t>();
+      gpu_kernel(iter,
+        [div]GPU_LAMBDA(scalar_t a) __ubsan_ignore_float_divide_by_zero__ -> scalar_t {
+          return ::fmod(static_cast<accscalar_t>(a), div);
+        });
+    });
+  }
+}
+
 REGISTER_DISPATCH(remainder_stub, &remainder_kernel_cuda);
+REGISTER_DISPATCH(fmod_stub, &fmod_kernel_cuda);
+REGISTER_DISPATCH(fmod_scalar_stub, &fmod_scalar_kernel_cuda);
 
 }} // namespace at::native
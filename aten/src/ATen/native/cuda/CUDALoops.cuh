@@ -28,6 +28,8 @@
 // See BinaryOpsKernel.cu for the complete implementation
 //
 
+#include <algorithm>
+#include <array>
 #include <type_traits>
 #include <tuple>
 
@@ -59,23 +61,59 @@
 
 namespace at { namespace native {
 
-template<int vec_size, typename func_t, typename array_t>
+// Handles the `remaining` (< block_work_size) elements of the last block of a
+// vectorized launch with a naive unrolled loop.
+template<int work_size, typename func_t, typename array_t>
+__device__ inline void vectorized_kernel_tail(int remaining, func_t f, array_t data) {
+  using traits = function_traits<func_t>;
+  auto input_calc = TrivialOffsetCalculator<traits::arity>();
+  auto output_calc = TrivialOffsetCalculator<1>();
+  auto loader = memory::LoadWithoutCast();
+  auto storer = memory::StoreWithoutCast();
+  auto policy = memory::policies::unroll<array_t, decltype(input_calc), decltype(output_calc),
+                                         memory::LoadWithoutCast, memory::StoreWithoutCast, 1, work_size>(
+    data, remaining, input_calc, output_calc, loader, storer);
+  elementwise_kernel_helper(f, policy);
+}
+
+template<int vec_size, int work_size, typename func_t, typename array_t>
 C10_LAUNCH_BOUNDS_1(num_threads)
 __global__ void vectorized_elementwise_kernel(int N, func_t f, array_t data) {
-  using traits = function_traits<func_t>;
-  int remaining = N - block_work_size * blockIdx.x;
+  constexpr int block_work = work_size * num_threads;
+  int remaining = N - block_work * blockIdx.x;
 
-  if (remaining < block_work_size) {  // if this block handles the reminder, just do a naive unrolled loop
-    auto input_calc = TrivialOffsetCalculator<traits::arity>();
-    auto output_calc = TrivialOffsetCalculator<1>();
-    auto loader = memory::LoadWithoutCast();
-    auto storer = memory::StoreWithoutCast();
-    auto policy = memory::policies::unroll<array_t, decltype(input_calc), decltype(output_calc),
-                                           memory::LoadWithoutCast, memory::StoreWithoutCast>(
-      data, remaining, input_calc, output_calc, loader, storer);
-    elementwise_kernel_helper(f, policy);
+  if (remaining < block_work) {  // if this block handles the reminder, just do a naive unrolled loop
+    vectorized_kernel_tail<work_size>(remaining, f, data);
   } else {  // if this block has a full `block_work_size` data to handle, use vectorized memory access
-    elementwise_kernel_helper(f, memory::policies::vectorized<vec_size, array_t>(data));
+    elementwise_kernel_helper(f, memory::policies::vectorized<vec_size, array_t, work_size>(data));
+  }
+}
+
+// Like vectorized_elementwise_kernel, for iterators whose innermost dimension
+// is contiguous in every operand but whose outer dimensions are strided or
+// broadcast, e.g. adding a bias of size [C] to a [N, C] tensor. blockIdx.x
+// walks a row of `inner_size` elements and blockIdx.y walks the rows, whose
+// byte offsets come from `outer_calc`.
+template<int vec_size, int work_size, typename func_t, typename array_t, typename outer_calc_t>
+C10_LAUNCH_BOUNDS_1(num_threads)
+__global__ void vectorized_inner_elementwise_kernel(
+    int inner_size, int num_rows, func_t f, array_t data, outer_calc_t outer_calc) {
+  constexpr int ntensors = function_traits<func_t>::arity + 1;
+  constexpr int block_work = work_size * num_threads;
+  int remaining = inner_size - block_work * blockIdx.x;
+
+  for (int row = blockIdx.y; row < num_rows; row += gridDim.y) {
+    auto offsets = outer_calc.get(row);
+    array_t row_data;
+    #pragma unroll
+    for (int i = 0; i < ntensors; i++) {
+      row_data[i] = data[i] + offsets[i];
+    }
+    if (remaining < block_work) {
+      vectorized_kernel_tail<work_size>(remaining, f, row_data);
+    } else {
+      elementwise_kernel_helper(f, memory::policies::vectorized<vec_size, array_t, work_size>(row_data));
+    }
   }
 }
 
@@ -89,6 +127,50 @@ __global__ void unrolled_elementwise_kernel(int N, func_t f, array_t data,
   elementwise_kernel_helper(f, policy);
 }
 
+// Picks how wide the vectorized accesses of `func_t` may be on the current
+// device. vec4 accesses of 4 and 8 byte types are already 128 bits wide; for
+// 1 and 2 byte types we go up to vec8 (and 8 elements per thread) on Volta and
+// newer, where the wider loads are what it takes to saturate HBM. Older parts
+// keep vec4, which was the best setting there.
+template<typename func_t>
+static inline int max_vectorize_size() {
+  if (memory::max_operand_size<func_t>::value > 2) {
+    return 4;
+  }
+  return at::cuda::getCurrentDeviceProperties()->major >= 7 ? 8 : 4;
+}
+
+template<typename func_t, bool enabled = (memory::max_operand_size<func_t>::value <= 2)>
+struct launch_vec8 {
+  template<typename array_t>
+  static void vectorized(int64_t N, const func_t& f, array_t data, cudaStream_t stream) {
+    constexpr int block_work = 8 * num_threads;
+    int64_t grid = (N + block_work - 1) / block_work;
+    vectorized_elementwise_kernel<8, 8, func_t, array_t><<<grid, num_threads, 0, stream>>>(N, f, data);
+  }
+  template<typename array_t, typename outer_calc_t>
+  static void vectorized_inner(int64_t inner_size, int64_t num_rows, const func_t& f, array_t data,
+                               outer_calc_t outer_calc, cudaStream_t stream) {
+    constexpr int block_work = 8 * num_threads;
+    dim3 grid((inner_size + block_work - 1) / block_work, std::min<int64_t>(num_rows, 65535));
+    vectorized_inner_elementwise_kernel<8, 8, func_t, array_t><<<grid, num_threads, 0, stream>>>(
+        inner_size, num_rows, f, data, outer_calc);
+  }
+};
+
+// Operands wider than 2 bytes never ask for vec8, so don't instantiate it.
+template<typename func_t>
+struct launch_vec8<func_t, false> {
+  template<typename array_t>
+  static void vectorized(int64_t, const func_t&, array_t, cudaStream_t) {
+    TORCH_INTERNAL_ASSERT(false, "Unexpected vectorization size");
+  }
+  template<typename array_t, typename outer_calc_t>
+  static void vectorized_inner(int64_t, int64_t, const func_t&, array_t, outer_calc_t, cudaStream_t) {
+    TORCH_INTERNAL_ASSERT(false, "Unexpected vectorization size");
+  }
+};
+
 // this function assume trivial 1d and no dynamic casting
 template<typename func_t, typename array_t>
 static inline void launch_vectorized_kernel(int64_t N, const func_t& f, array_t data) {
@@ -96,14 +178,18 @@ static inline void launch_vectorized_kernel(int64_t N, const func_t& f, array_t
   using traits = function_traits<func_t>;
   int64_t grid = (N + block_work_size - 1) / block_work_size;
   auto stream = at::cuda::getCurrentCUDAStream();
-  int vec_size = memory::can_vectorize_up_to<func_t>(data);
+  int vec_size = max_vectorize_size<func_t>() == 8 ?
+      memory::can_vectorize_up_to<func_t, 8>(data) : memory::can_vectorize_up_to<func_t>(data);
 
   switch (vec_size) {
+  case 8:
+    launch_vec8<func_t>::vectorized(N, f, data, stream);
+    break;
   case 4:
-    vectorized_elementwise_kernel<4, func_t, array_t><<<grid, num_threads, 0, stream>>>(N, f, data);
+    vectorized_elementwise_kernel<4, thread_work_size, func_t, array_t><<<grid, num_threads, 0, stream>>>(N, f, data);
     break;
   case 2:
-    vectorized_elementwise_kernel<2, func_t, array_t><<<grid, num_threads, 0, stream>>>(N, f, data);
+    vectorized_elementwise_kernel<2, thread_work_size, func_t, array_t><<<grid, num_threads, 0, stream>>>(N, f, data);
     break;
   case 1: {
     auto input_calc = TrivialOffsetCalculator<traits::arity>();
@@ -119,6 +205,77 @@ static inline void launch_vectorized_kernel(int64_t N, const func_t& f, array_t
   AT_CUDA_CHECK(cudaGetLastError());
 }
 
+// Returns the vector size usable by vectorized_inner_elementwise_kernel, or 1
+// if `iter` doesn't have a contiguous inner dimension worth vectorizing. Every
+// row has to start on a vector boundary, so besides the base pointers, the
+// row length and each outer byte stride must be multiples of the vector width.
+template<typename func_t, typename array_t>
+static inline int inner_vectorize_size(const TensorIterator& iter, array_t data) {
+  if (iter.ndim() < 2 || iter.shape()[0] < num_threads * thread_work_size) {
+    return 1;
+  }
+  for (int i = 0; i < iter.ntensors(); i++) {
+    if (iter.strides(i)[0] != iter.element_size(i)) {
+      return 1;
+    }
+  }
+  int vec_size = max_vectorize_size<func_t>() == 8 ?
+      memory::can_vectorize_up_to<func_t, 8>(data) : memory::can_vectorize_up_to<func_t>(data);
+  const int64_t inner_size = iter.shape()[0];
+  auto row_aligned = [&](int vec) {
+    if (inner_size % vec != 0) {
+      return false;
+    }
+    for (int i = 0; i < iter.ntensors(); i++) {
+      const int64_t vec_bytes = vec * iter.element_size(i);
+      for (int d = 1; d < iter.ndim(); d++) {
+        if (iter.strides(i)[d] % vec_bytes != 0) {
+          return false;
+        }
+      }
+    }
+    return true;
+  };
+  while (vec_size > 1 && !row_aligned(vec_size)) {
+    vec_size /= 2;
+  }
+  return vec_size;
+}
+
+// this function assumes no dynamic casting and a contiguous innermost
+// dimension in every operand, as checked by inner_vectorize_size
+template<typename func_t, typename array_t>
+static inline void launch_vectorized_inner_kernel(const TensorIterator& iter, int vec_size, const func_t& f, array_t data) {
+  constexpr int ntensors = function_traits<func_t>::arity + 1;
+  const int64_t inner_size = iter.shape()[0];
+  const int64_t num_rows = iter.numel() / inner_size;
+  std::array<const int64_t*, ntensors> strides;
+  for (int i = 0; i < ntensors; i++) {
+    strides[i] = iter.strides(i).data() + 1;
+  }
+  // byte strides, so the offsets can be added to the char* data pointers
+  auto outer_calc = OffsetCalculator<ntensors>(iter.ndim() - 1, iter.shape().data() + 1, strides.data());
+  auto stream = at::cuda::getCurrentCUDAStream();
+  dim3 grid((inner_size + block_work_size - 1) / block_work_size, std::min<int64_t>(num_rows, 65535));
+
+  switch (vec_size) {
+  case 8:
+    launch_vec8<func_t>::vectorized_inner(inner_size, num_rows, f, data, outer_calc, stream);
+    break;
+  case 4:
+    vectorized_inner_elementwise_kernel<4, thread_work_size, func_t, array_t><<<grid, num_threads, 0, stream>>>(
+        inner_size, num_rows, f, data, outer_calc);
+    break;
+  case 2:
+    vectorized_inner_elementwise_kernel<2, thread_work_size, func_t, array_t><<<grid, num_threads, 0, stream>>>(
+        inner_size, num_rows, f, data, outer_calc);
+    break;
+  default:
+    TORCH_INTERNAL_ASSERT(false, "Unexpected vectorization size");
+  }
+  AT_CUDA_CHECK(cudaGetLastError());
+}
+
 template<typename func_t, typename array_t, typename inp_calc_t, typename out_calc_t, typename loader_t, typename storer_t>
 static inline void launch_unrolled_kernel(int64_t N, const func_t& f, array_t data,
                                           inp_calc_t ic, out_calc_t oc, loader_t l, storer_t s)
@@ -151,8 +308,11 @@ void gpu_kernel_impl(TensorIterator& iter, const func_t& f) {
   bool dynamic_casting = needs_dynamic_casting<func_t>::check(iter);
 
   if (!dynamic_casting) {
+    int inner_vec_size = contiguous ? 1 : inner_vectorize_size<func_t>(iter, data);
     if (contiguous) {
       launch_vectorized_kernel(numel, f, data);
+    } else if (inner_vec_size > 1) {
+      launch_vectorized_inner_kernel(iter, inner_vec_size, f, data);
     } else {
       auto input_offset_calculator = make_input_offset_calculator<traits::arity>(iter);
       auto output_offset_calculator = make_output_offset_calculator(iter);
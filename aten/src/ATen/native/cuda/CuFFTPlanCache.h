@@ -3,8 +3,11 @@
 #include <ATen/Config.h>
 #include <ATen/native/cuda/CuFFTUtils.h>
 #include <ATen/native/utils/ParamsHash.h>
+#include <c10/util/Metrics.h>
 
 #include <list>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <string>
 #include <stdexcept>
@@ -363,9 +366,13 @@ static_assert(CUFFT_DEFAULT_CACHE_SIZE >= 0 && CUFFT_DEFAULT_CACHE_SIZE <= CUFFT
 // value returned from try_emplace_value.
 // The contract of using this cache is that try_emplace_value should only be
 // used when the max_size is positive.
+//
+// Values are held by shared_ptr so that a config returned by
+// try_emplace_value stays alive when a later call evicts it, e.g., when a
+// batched transform looks up several plans in a row from a small cache.
 class CuFFTParamsLRUCache {
 public:
-  using kv_t = typename std::pair<CuFFTParams, CuFFTConfig>;
+  using kv_t = typename std::pair<CuFFTParams, std::shared_ptr<CuFFTConfig>>;
   using map_t = typename std::unordered_map<std::reference_wrapper<CuFFTParams>,
                                             typename std::list<kv_t>::iterator,
                                             ParamsHash<CuFFTParams>,
@@ -382,32 +389,48 @@ public:
   CuFFTParamsLRUCache(CuFFTParamsLRUCache&& other) noexcept :
     _usage_list(std::move(other._usage_list)),
     _cache_map(std::move(other._cache_map)),
-    _max_size(other._max_size) {}
+    _max_size(other._max_size),
+    _hits(other._hits),
+    _misses(other._misses) {}
 
   CuFFTParamsLRUCache& operator=(CuFFTParamsLRUCache&& other) noexcept {
     _usage_list = std::move(other._usage_list);
     _cache_map = std::move(other._cache_map);
     _max_size = other._max_size;
+    _hits = other._hits;
+    _misses = other._misses;
     return *this;
   }
 
   // If key is in this cache, return the cached config. Otherwise, emplace the
   // config in this cache using value_args and return it.
-  // Return const reference because CuFFTConfig shouldn't be tampered with once
-  // created.
+  // Return pointer to const because CuFFTConfig shouldn't be tampered with
+  // once created.
   // This is similar to c++ 17 try_emplace.
   template<typename K, class ...VArgs>
-  const CuFFTConfig &try_emplace_value(K&& key, VArgs&&... value_args) {
+  std::shared_ptr<const CuFFTConfig> try_emplace_value(K&& key, VArgs&&... value_args) {
     AT_ASSERT(_max_size > 0);
 
     map_kkv_iter_t map_it = _cache_map.find(key);
     // Hit, put to list front
     if (map_it != _cache_map.end()) {
+      _hits++;
+      C10_METRICS_COUNTER_ADD(
+          "aten_cufft_plan_cache_hits_total",
+          "FFTs whose cuFFT plan was in the plan cache of their device", 1);
       _usage_list.splice(_usage_list.begin(), _usage_list, map_it->second);
       return map_it->second->second;
     }
 
     // Miss
+    _misses++;
+    C10_METRICS_COUNTER_ADD(
+        "aten_cufft_plan_cache_misses_total",
+        "FFTs whose cuFFT plan had to be created", 1);
+    // construct new plan before evicting, so a failing plan creation leaves
+    // the cache untouched
+    auto config = std::make_shared<CuFFTConfig>(value_args...);
+
     // remove if needed
     if (_usage_list.size() >= _max_size) {
       auto last = _usage_list.end();
@@ -416,10 +439,10 @@ public:
       _usage_list.pop_back();
     }
 
-    // construct new plan at list front, then insert into _cache_map
+    // insert new plan at list front, then insert into _cache_map
     _usage_list.emplace_front(std::piecewise_construct,
                        std::forward_as_tuple(key),
-                       std::forward_as_tuple(value_args...));
+                       std::forward_as_tuple(std::move(config)));
     auto kv_it = _usage_list.begin();
     _cache_map.emplace(std::piecewise_construct,
                 std::forward_as_tuple(kv_it->first),
@@ -427,9 +450,12 @@ public:
     return kv_it->second;
   }
 
+  // Also resets the hit and miss counters.
   void clear() {
     _cache_map.clear();
     _usage_list.clear();
+    _hits = 0;
+    _misses = 0;
   }
 
   void resize(int64_t new_size) {
@@ -449,11 +475,13 @@ public:
 
   size_t max_size() const noexcept { return _max_size; }
 
-  std::mutex mutex;
+  // Number of try_emplace_value calls that found, resp. had to create, their
+  // plan since construction or the last clear().
+  size_t hits() const noexcept { return _hits; }
 
-private:
-  // Only sets size and does value check. Does not resize the data structures.
-  void _set_max_size(int64_t new_size) {
+  size_t misses() const noexcept { return _misses; }
+
+  static void check_max_size(int64_t new_size) {
     // We check that 0 <= new_size <= CUFFT_MAX_PLAN_NUM here. Since
     // CUFFT_MAX_PLAN_NUM is of type size_t, we need to do non-negativity check
     // first.
@@ -461,12 +489,22 @@ private:
              "cuFFT plan cache size must be non-negative, but got ", new_size);
     TORCH_CHECK(new_size <= CUFFT_MAX_PLAN_NUM,
              "cuFFT plan cache size can not be larger than ", CUFFT_MAX_PLAN_NUM, ", but got ", new_size);
+  }
+
+  std::mutex mutex;
+
+private:
+  // Only sets size and does value check. Does not resize the data structures.
+  void _set_max_size(int64_t new_size) {
+    check_max_size(new_size);
     _max_size = static_cast<size_t>(new_size);
   }
 
   std::list<kv_t> _usage_list;
   map_t _cache_map;
   size_t _max_size;
+  size_t _hits = 0;
+  size_t _misses = 0;
 };
 
 // Since ATen is separated into CPU build and CUDA build, we need a way to call
@@ -474,10 +512,13 @@ private:
 // (at cuda/detail/CUDAHooks.cpp), and call the hooked functions from the actual
 // native function counterparts (at native/SpectralOps.cpp), i.e.,
 // _cufft_get_plan_cache_max_size, _cufft_set_plan_cache_max_size
-// _cufft_get_plan_cache_size, and _cufft_clear_plan_cache.
+// _cufft_get_plan_cache_size, _cufft_get_plan_cache_hits,
+// _cufft_get_plan_cache_misses and _cufft_clear_plan_cache.
 int64_t cufft_get_plan_cache_max_size_impl(int64_t device_index);
 void cufft_set_plan_cache_max_size_impl(int64_t device_index, int64_t max_size);
 int64_t cufft_get_plan_cache_size_impl(int64_t device_index);
+int64_t cufft_get_plan_cache_hits_impl(int64_t device_index);
+int64_t cufft_get_plan_cache_misses_impl(int64_t device_index);
 void cufft_clear_plan_cache_impl(int64_t device_index);
 
 }}} // namespace at::native::detail
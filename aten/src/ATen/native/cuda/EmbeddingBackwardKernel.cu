@@ -11,6 +11,7 @@
 #include <THC/THCThrustAllocator.cuh>
 #include <THC/THCAtomics.cuh>
 
+#include <thrust/copy.h>
 #include <thrust/execution_policy.h>
 #include <thrust/unique.h>
 
@@ -21,18 +22,32 @@ namespace native {
 
 namespace {
 
-// The maximum block size in CUDA
-constexpr int MAX_BLOCK_SIZE = 1024;
-/* This code computes the sum of the weights in two-steps:
-  1) Each GPU warp sums `NROWS_PER_THREAD` number of row given by `indeces`
-  2) Each partial-sum from 1) are summed and scatter into `grad_weight`
-
-  Notice, `NROWS_PER_THREAD` impacts the Achieved Occupancy of the
-  kernel execution. If it is high, the size of the thread blocks will be
-  too small to achieve good occupancy. Similarly, a very low value will
-  make the size of the thread blocks in the final sum in step 2) too small.
+/* This code computes the sum of the weights in two steps:
+  1) Each GPU warp sums up to `NROWS_PER_PARTIAL` rows given by `indices`,
+     a partial-segment of the rows of one segment (see below). A warp stages
+     the gradient row and scale of its rows in shared memory once, and then
+     sweeps the feature dimension with each lane owning one feature of a tile
+     of C10_WARP_SIZE features, so every row is read fully coalesced.
+  2) The partial-sums of the segments that were split into several
+     partial-segments are combined and scattered into `grad_weight`.
+
+  Segments that fit into a single partial-segment, i.e., almost all of them
+  for a large vocabulary, are written to `grad_weight` directly by 1). Hot
+  rows are split across many warps instead of being summed by one thread.
+
+  How 2) combines the partial-sums depends on the deterministic flag of the
+  global context:
+  - By default, 1) atomically adds the partial-sums of float and double
+    gradients to `grad_weight` and 2) is skipped.
+  - If `at::globalContext().deterministic()` is set, or for reduced precision
+    gradients (which are accumulated in float), 1) stores the partial-sums
+    and 2) reduces them in a fixed order: each of the `NWARPS_PER_BLOCK`
+    warps of a block sums every NWARPS_PER_BLOCK-th partial-sum of a segment
+    for a tile of features, and the warps' sums are then added up in warp
+    order through shared memory.
 */
-constexpr int NROWS_PER_THREAD = 10;
+constexpr int NROWS_PER_PARTIAL = C10_WARP_SIZE;
+constexpr int NWARPS_PER_BLOCK = 4;
 
 // Fast ceil division (no overflow checking)
 __host__ __device__ __forceinline__
@@ -48,13 +63,14 @@ void krn_partials_per_segment(int64_t *ret, const int64_t *segment_offsets,
     const int64_t idx_start = segment_offsets[id];
     const int64_t idx_end = (id == num_of_segments-1)?numel:segment_offsets[id+1];
     const int64_t size = idx_end - idx_start;
-    ret[id] = ceil_div(size, NROWS_PER_THREAD);
+    ret[id] = ceil_div(size, NROWS_PER_PARTIAL);
   }
 }
 
 __global__
 void krn_partial_segment_offset(
         int64_t *ret,
+        int64_t *partial_segment,
         const int64_t *partials_per_segment,
         const int64_t *partials_per_segment_offset,
         const int64_t *segment_offsets,
@@ -65,117 +81,149 @@ void krn_partial_segment_offset(
     const int64_t num_partials = partials_per_segment[id];
     const int64_t segment_offset = segment_offsets[id];
     for (int64_t i=0; i<num_partials; ++i) {
-      ret[idx++] = segment_offset + i * NROWS_PER_THREAD;
+      partial_segment[idx] = id;
+      ret[idx++] = segment_offset + i * NROWS_PER_PARTIAL;
     }
   }
 }
 
+struct is_split_segment {
+  const int64_t *partials_per_segment;
 
-template <typename scalar_t>
-__global__ void compute_grad_weight_bags(
-    int64_t *indices, scalar_t *gradOutput,
-    int64_t *offset2bag, int64_t *count, ptrdiff_t numel,
-    int64_t stride, int mode_mean, const int64_t *bag_size,
-    scalar_t* per_sample_weights, int64_t per_sample_weights_stride,
-    int64_t* segment_offsets, int64_t num_of_segments,
-    acc_type<scalar_t, true> *grad_weight_per_segment,
-    const int64_t stride_warped) {
-
-  const int gid = blockIdx.x * blockDim.x + threadIdx.x;
-  const int id = gid / stride_warped;
-  const int startFeature = gid % stride_warped;
-  if (startFeature >= stride) {
-    return;
+  __device__ bool operator()(int64_t segment) const {
+    return partials_per_segment[segment] > 1;
   }
-  if (id >= num_of_segments) {
-    return;
-  }
-  const int idx_begin = segment_offsets[id];
-  const int idx_end = (id == num_of_segments-1)?numel:segment_offsets[id+1];
-
-  acc_type<scalar_t, true> weight = 0;
-  for (int idx=idx_begin; idx < idx_end; ++idx) {
-    const int origRow = indices[idx];
-    const int seq_number = offset2bag[origRow];
-    const int gradOutputRow = seq_number * stride;
-
-    acc_type<scalar_t, true> scale = count ? 1.0 / count[idx] : 1.0;
-    if (per_sample_weights) {
-      scale *= per_sample_weights[origRow * per_sample_weights_stride];
-    }
+};
 
-    acc_type<scalar_t, true> gradient = gradOutput[gradOutputRow + startFeature];
-    if (mode_mean) {
-      gradient /= bag_size[seq_number];
-    }
-    weight += gradient * scale;
-  }
-  grad_weight_per_segment[id * stride + startFeature] = weight;
-}
-
-template <typename scalar_t>
+// Step 1), one warp per partial-segment. `offset2bag` is null unless the
+// gradient is the one of an embedding bag, whose rows are the bags.
+template <typename scalar_t, bool use_atomics>
 __global__ void compute_grad_weight(
-    int64_t *indices,
-    scalar_t *gradOutput,
-    int64_t *count,
+    const int64_t *orig_indices,
+    const int64_t *sorted_indices,
+    const scalar_t *gradOutput,
+    const int64_t *offset2bag,
+    const int64_t *count,
     ptrdiff_t numel,
     int64_t stride,
-    int64_t* segment_offsets,
+    bool mode_mean,
+    const int64_t *bag_size,
+    const scalar_t *per_sample_weights,
+    int64_t per_sample_weights_stride,
+    const int64_t *segment_offsets,
     int64_t num_of_segments,
+    const int64_t *partials_per_segment,
+    const int64_t *partial_segment_offset,
+    const int64_t *partial_segment,
+    int64_t num_of_partial_segments,
+    int64_t padding_idx,
     acc_type<scalar_t, true> *grad_weight_per_segment,
-    const int64_t stride_warped) {
+    scalar_t *gradWeight) {
 
   using accscalar_t = acc_type<scalar_t, true>;
-  const int gid = blockIdx.x * blockDim.x + threadIdx.x;
-  const int id = gid / stride_warped;
-  const int startFeature = gid % stride_warped;
-  if (startFeature >= stride) {
+  __shared__ int64_t grad_rows[NWARPS_PER_BLOCK][NROWS_PER_PARTIAL];
+  __shared__ accscalar_t scales[NWARPS_PER_BLOCK][NROWS_PER_PARTIAL];
+
+  const int lane = threadIdx.x;
+  const int warp = threadIdx.y;
+  const int64_t id = static_cast<int64_t>(blockIdx.x) * NWARPS_PER_BLOCK + warp;
+
+  int64_t segment = 0;
+  int64_t idx_begin = 0;
+  int64_t idx_end = 0;
+  if (id < num_of_partial_segments) {
+    segment = partial_segment[id];
+    const int64_t segment_end = (segment == num_of_segments-1)?numel:segment_offsets[segment+1];
+    idx_begin = partial_segment_offset[id];
+    idx_end = ::min(idx_begin + NROWS_PER_PARTIAL, segment_end);
+
+    const int64_t idx = idx_begin + lane;
+    if (idx < idx_end) {
+      const int64_t origRow = orig_indices[idx];
+      accscalar_t scale = count ? static_cast<accscalar_t>(1.0) / count[idx] : 1.0;
+      int64_t gradOutputRow = origRow;
+      if (offset2bag) {
+        gradOutputRow = offset2bag[origRow];
+        if (per_sample_weights) {
+          scale *= static_cast<accscalar_t>(per_sample_weights[origRow * per_sample_weights_stride]);
+        }
+        if (mode_mean) {
+          scale /= bag_size[gradOutputRow];
+        }
+      }
+      grad_rows[warp][lane] = gradOutputRow * stride;
+      scales[warp][lane] = scale;
+    }
+  }
+  __syncthreads();
+
+  if (id >= num_of_partial_segments) {
     return;
   }
-  if (id >= num_of_segments) {
+  const int64_t target_row = sorted_indices[idx_begin];
+  if (target_row == padding_idx) {
     return;
   }
-  const int idx_begin = segment_offsets[id];
-  const int idx_end = (id == num_of_segments-1)?numel:segment_offsets[id+1];
+  const bool whole_segment = partials_per_segment[segment] == 1;
+  const int nrows = static_cast<int>(idx_end - idx_begin);
 
-  accscalar_t weight = 0;
-  for (int idx=idx_begin; idx < idx_end; ++idx) {
-    const int64_t target_row = indices[idx];
-    const accscalar_t scale = count ? (accscalar_t)1.0 / count[idx] : 1.0;
-    weight += gradOutput[target_row * stride + startFeature] * scale;
+  for (int64_t feature = lane; feature < stride; feature += C10_WARP_SIZE) {
+    accscalar_t weight = 0;
+    for (int i = 0; i < nrows; ++i) {
+      weight += static_cast<accscalar_t>(gradOutput[grad_rows[warp][i] + feature]) * scales[warp][i];
+    }
+    if (whole_segment) {
+      gradWeight[target_row * stride + feature] = static_cast<scalar_t>(weight);
+    } else if (use_atomics) {
+      gpuAtomicAdd(&gradWeight[target_row * stride + feature], static_cast<scalar_t>(weight));
+    } else {
+      grad_weight_per_segment[id * stride + feature] = weight;
+    }
   }
-  grad_weight_per_segment[id * stride + startFeature] = weight;
 }
 
-// This kernel assumes that all input tensors are contiguous.
+// Step 2) for the deterministic mode, one block per split segment and tile
+// of C10_WARP_SIZE features.
 template <typename scalar_t>
 __global__ void sum_and_scatter(
-    int64_t *input, scalar_t *gradWeight, int64_t stride,
-    int64_t* segment_offsets, int64_t num_of_segments,
+    const int64_t *sorted_indices, scalar_t *gradWeight, int64_t stride,
+    const int64_t *segment_offsets,
+    const int64_t *split_segments,
     const acc_type<scalar_t, true> *grad_weight_per_segment,
-    const int64_t *segment_sizes_offsets, int64_t num_of_partial_segments,
-    const int64_t padding_idx,
-    const int64_t stride_warped) {
-
-  const int gid = blockIdx.x * blockDim.x + threadIdx.x;
-  const int id = gid / stride_warped;
-  const int startFeature = gid % stride_warped;
-  if (startFeature >= stride) {
-    return;
-  }
-  if (id >= num_of_segments) {
+    const int64_t *partials_per_segment,
+    const int64_t *partials_per_segment_offset,
+    const int64_t padding_idx) {
+
+  using accscalar_t = acc_type<scalar_t, true>;
+  __shared__ accscalar_t warp_sums[NWARPS_PER_BLOCK][C10_WARP_SIZE];
+
+  const int lane = threadIdx.x;
+  const int warp = threadIdx.y;
+  const int64_t segment = split_segments[blockIdx.x];
+  const int64_t feature = static_cast<int64_t>(blockIdx.y) * C10_WARP_SIZE + lane;
+  const int64_t target_row = sorted_indices[segment_offsets[segment]];
+  if (target_row == padding_idx) {
     return;
   }
 
-  const int idx_begin = segment_sizes_offsets[id];
-  const int idx_end = (id == num_of_segments-1)?num_of_partial_segments:segment_sizes_offsets[id+1];
-  acc_type<scalar_t, true> weight = 0;
-  for (int idx=idx_begin; idx < idx_end; ++idx) {
-    weight += grad_weight_per_segment[idx*stride + startFeature];
+  const int64_t partials_begin = partials_per_segment_offset[segment];
+  const int64_t num_partials = partials_per_segment[segment];
+  accscalar_t weight = 0;
+  if (feature < stride) {
+    for (int64_t i = warp; i < num_partials; i += NWARPS_PER_BLOCK) {
+      weight += grad_weight_per_segment[(partials_begin + i) * stride + feature];
+    }
   }
-  int64_t target_row = input[segment_offsets[id]];
-  if (target_row != padding_idx) {
-    gradWeight[target_row * stride + startFeature] = weight;
+  warp_sums[warp][lane] = weight;
+  __syncthreads();
+
+  if (warp == 0 && feature < stride) {
+    weight = 0;
+    #pragma unroll
+    for (int w = 0; w < NWARPS_PER_BLOCK; ++w) {
+      weight += warp_sums[w][lane];
+    }
+    gradWeight[target_row * stride + feature] = static_cast<scalar_t>(weight);
   }
 }
 
@@ -222,9 +270,9 @@ Tensor embedding_backward_cuda_kernel(
     num_of_segments = thrust::get<0>(ends) - dummy_dev;
   }
 
-  // We split the segments up into sizes of `NROWS_PER_THREAD`
-  // Compute the number partial-segments per segment (some partial-segments 
-  // may not be the full `NROWS_PER_THREAD` number of rows)
+  // We split the segments up into sizes of `NROWS_PER_PARTIAL`
+  // Compute the number partial-segments per segment (some partial-segments
+  // may not be the full `NROWS_PER_PARTIAL` number of rows)
   auto partials_per_segment = at::empty({num_of_segments}, orig_indices.options());
   {
     krn_partials_per_segment<<<ceil_div(num_of_segments, 32), 32, 0, stream>>> (
@@ -246,24 +294,33 @@ Tensor embedding_backward_cuda_kernel(
           thrust::device_ptr<int64_t>(partials_per_segment_offset.data_ptr<int64_t>()));
 
   // The total number of partial-segments is the sum of `partials_per_segment_offset`
-  const int num_of_partial_segments = partials_per_segment[num_of_segments-1].item<int64_t>() +
+  const int64_t num_of_partial_segments = partials_per_segment[num_of_segments-1].item<int64_t>() +
           partials_per_segment_offset[num_of_segments-1].item<int64_t>();
 
-  // Now we can compute the start position of each partial-segment
+  // Now we can compute the start position of each partial-segment, and the
+  // segment it belongs to.
   // Unit: index in `sorted_indices` and `orig_indices`
   auto partial_segment_offset = at::empty({num_of_partial_segments}, orig_indices.options());
+  auto partial_segment = at::empty({num_of_partial_segments}, orig_indices.options());
   {
     krn_partial_segment_offset<<<ceil_div(num_of_segments, 32), 32, 0, stream>>> (
             partial_segment_offset.data_ptr<int64_t>(),
+            partial_segment.data_ptr<int64_t>(),
             partials_per_segment.data_ptr<int64_t>(),
             partials_per_segment_offset.data_ptr<int64_t>(),
             segment_offsets.data_ptr<int64_t>(),
             num_of_segments);
   }
 
-  const int stride_warped = ceil_div(stride, C10_WARP_SIZE)*C10_WARP_SIZE;
-  const int block = std::min(stride_warped, MAX_BLOCK_SIZE);
-  const int grid = ceil_div(num_of_partial_segments*stride_warped, block);
+  // Only the segments split into several partial-segments need step 2).
+  const bool any_split_segment = num_of_partial_segments > num_of_segments;
+  // Atomics leave the order of the summation of partial-sums undefined, and
+  // lose precision for reduced precision gradients.
+  const bool use_atomics = !globalContext().deterministic() &&
+      (grad.scalar_type() == at::kFloat || grad.scalar_type() == at::kDouble);
+
+  const dim3 block(C10_WARP_SIZE, NWARPS_PER_BLOCK);
+  const int64_t grid = ceil_div(num_of_partial_segments, NWARPS_PER_BLOCK);
 
   AT_DISPATCH_FLOATING_TYPES_AND2(at::ScalarType::Half, at::ScalarType::BFloat16,
     grad.scalar_type(), "embedding_bag_backward_cuda_compute_grad_weight", [&] {
@@ -277,46 +334,59 @@ Tensor embedding_backward_cuda_kernel(
         } else {
             op = grad.options();
         }
-        auto grad_weight_per_segment = at::empty({num_of_partial_segments, stride}, op);
+        const bool store_partials = any_split_segment && !use_atomics;
+        auto grad_weight_per_segment = at::empty({store_partials ? num_of_partial_segments : 0, stride}, op);
         // Compute the sum of each partial-segment and handle bags
-        if (offset2bag.defined()) {
-              compute_grad_weight_bags<scalar_t><<<grid, block, 0, stream>>>(
-                orig_indices.data_ptr<int64_t>(),
-                grad.data_ptr<scalar_t>(),
-                offset2bag.data_ptr<int64_t>(),
-                count.defined() ? count.data_ptr<int64_t>() : nullptr, numel, stride,
-                mode_mean, bag_size.data_ptr<int64_t>(),
-                per_sample_weights.defined() ? per_sample_weights.data_ptr<scalar_t>() : NULL,
-                per_sample_weights.defined() ? per_sample_weights.stride(0) : 0,
-                partial_segment_offset.data_ptr<int64_t>(),
-                num_of_partial_segments, grad_weight_per_segment.data_ptr<partial_weight_t>(),
-                stride_warped);
-        } else {
-              compute_grad_weight<scalar_t><<<grid, block, 0, stream>>>(
-                orig_indices.data_ptr<int64_t>(),
-                grad.data_ptr<scalar_t>(),
-                count.defined() ? count.data_ptr<int64_t>() : nullptr,
-                numel, stride,
-                partial_segment_offset.data_ptr<int64_t>(),
-                num_of_partial_segments,
-                grad_weight_per_segment.data_ptr<partial_weight_t>(),
-                stride_warped);
-        }
+        const bool has_bags = offset2bag.defined();
+        auto compute_grad_weight_kernel = use_atomics ?
+            compute_grad_weight<scalar_t, true> : compute_grad_weight<scalar_t, false>;
+        compute_grad_weight_kernel<<<grid, block, 0, stream>>>(
+            orig_indices.data_ptr<int64_t>(),
+            sorted_indices.data_ptr<int64_t>(),
+            grad.data_ptr<scalar_t>(),
+            has_bags ? offset2bag.data_ptr<int64_t>() : nullptr,
+            count.defined() ? count.data_ptr<int64_t>() : nullptr, numel, stride,
+            mode_mean, has_bags ? bag_size.data_ptr<int64_t>() : nullptr,
+            per_sample_weights.defined() ? per_sample_weights.data_ptr<scalar_t>() : nullptr,
+            per_sample_weights.defined() ? per_sample_weights.stride(0) : 0,
+            segment_offsets.data_ptr<int64_t>(),
+            num_of_segments,
+            partials_per_segment.data_ptr<int64_t>(),
+            partial_segment_offset.data_ptr<int64_t>(),
+            partial_segment.data_ptr<int64_t>(),
+            num_of_partial_segments,
+            padding_idx,
+            grad_weight_per_segment.data_ptr<partial_weight_t>(),
+            grad_weight.data_ptr<scalar_t>());
         AT_CUDA_CHECK(cudaGetLastError());
 
-        // Finally, we sum all the partial-sums and scatter them
-        // into `grad_weight`.
-        const int grid2 = ceil_div(num_of_segments*stride_warped, block);
-            sum_and_scatter<scalar_t><<<grid2, block, 0, stream>>>(
-              sorted_indices.data_ptr<int64_t>(),
-              grad_weight.data_ptr<scalar_t>(),
-              stride,
-              segment_offsets.data_ptr<int64_t>(),
-              num_of_segments, grad_weight_per_segment.data_ptr<partial_weight_t>(),
-              partials_per_segment_offset.data_ptr<int64_t>(),
-              num_of_partial_segments,
-              padding_idx,
-              stride_warped);
+        if (!store_partials) {
+          return;
+        }
+
+        // Finally, we sum the partial-sums of the split segments and scatter
+        // them into `grad_weight`.
+        auto split_segments = at::empty({num_of_segments}, orig_indices.options());
+        auto split_segments_dev = thrust::device_ptr<int64_t>(split_segments.data_ptr<int64_t>());
+        auto split_segments_end = thrust::copy_if(
+            policy,
+            thrust::make_counting_iterator<int64_t>(0),
+            thrust::make_counting_iterator<int64_t>(num_of_segments),
+            split_segments_dev,
+            is_split_segment{partials_per_segment.data_ptr<int64_t>()});
+        const int64_t num_of_split_segments = split_segments_end - split_segments_dev;
+
+        const dim3 grid2(num_of_split_segments, ceil_div(stride, C10_WARP_SIZE));
+        sum_and_scatter<scalar_t><<<grid2, block, 0, stream>>>(
+            sorted_indices.data_ptr<int64_t>(),
+            grad_weight.data_ptr<scalar_t>(),
+            stride,
+            segment_offsets.data_ptr<int64_t>(),
+            split_segments.data_ptr<int64_t>(),
+            grad_weight_per_segment.data_ptr<partial_weight_t>(),
+            partials_per_segment.data_ptr<int64_t>(),
+            partials_per_segment_offset.data_ptr<int64_t>(),
+            padding_idx);
         AT_CUDA_CHECK(cudaGetLastError());
     });
   });
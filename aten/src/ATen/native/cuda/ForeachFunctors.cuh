@@ -0,0 +1,216 @@
+#pragma once
+#include <ATen/AccumulateType.h>
+#include <ATen/native/cuda/ForeachUtils.cuh>
+#include <ATen/native/cuda/MultiTensorApply.cuh>
+#include <c10/util/complex.h>
+
+namespace at { namespace native {
+
+namespace {
+
+// Functors for multi_tensor_apply. A functor gets the tensors of depth lists
+// and reads its inputs from the first r_args_depth of them; the result is
+// written to list res_arg_index, which is 0 for in-place ops and
+// r_args_depth for ops with an output list. The math is done in opmath_t,
+// which is float for Half and BFloat16.
+
+// Applies f to the opmath_t values of the r_args_depth inputs of every
+// element of the chunk handled by this block.
+template<typename T, int depth, int r_args_depth, int res_arg_index, typename Meta, typename F>
+__device__ __forceinline__ void pointwise_apply(int chunk_size, Meta& tl, F f) {
+  using opmath_t = at::acc_type<T, /*is_cuda=*/true>;
+  const int tensor_loc = tl.block_to_tensor[blockIdx.x];
+  const int chunk_idx = tl.block_to_chunk[blockIdx.x];
+  const int n = tl.sizes[tensor_loc] - chunk_idx * chunk_size;
+
+  T* args[depth];
+  bool all_aligned = true;
+#pragma unroll
+  for (int d = 0; d < depth; d++) {
+    args[d] = (T*)tl.addresses[d][tensor_loc] + chunk_idx * chunk_size;
+    all_aligned = all_aligned && is_aligned(args[d]);
+  }
+
+  T r_args[r_args_depth][kILP];
+  T r_out[kILP];
+  opmath_t vals[r_args_depth];
+
+  // to make things simple, we put aligned case in a different code path
+  if (n % kILP == 0 && chunk_size % kILP == 0 && all_aligned) {
+    for (int i_start = threadIdx.x; i_start * kILP < n && i_start * kILP < chunk_size; i_start += blockDim.x) {
+      // load
+#pragma unroll
+      for (int d = 0; d < r_args_depth; d++) {
+        load_store(r_args[d], args[d], 0, i_start);
+      }
+#pragma unroll
+      for (int ii = 0; ii < kILP; ii++) {
+#pragma unroll
+        for (int d = 0; d < r_args_depth; d++) {
+          vals[d] = static_cast<opmath_t>(r_args[d][ii]);
+        }
+        r_out[ii] = static_cast<T>(f(vals));
+      }
+      // store
+      load_store(args[res_arg_index], r_out, i_start, 0);
+    }
+  } else {
+    for (int i_start = 0; i_start < n && i_start < chunk_size; i_start += blockDim.x * kILP) {
+#pragma unroll
+      for (int ii = 0; ii < kILP; ii++) {
+        const int i = i_start + threadIdx.x + ii * blockDim.x;
+#pragma unroll
+        for (int d = 0; d < r_args_depth; d++) {
+          r_args[d][ii] = (i < n && i < chunk_size) ? args[d][i] : T(0);
+        }
+      }
+#pragma unroll
+      for (int ii = 0; ii < kILP; ii++) {
+#pragma unroll
+        for (int d = 0; d < r_args_depth; d++) {
+          vals[d] = static_cast<opmath_t>(r_args[d][ii]);
+        }
+        r_out[ii] = static_cast<T>(f(vals));
+      }
+#pragma unroll
+      for (int ii = 0; ii < kILP; ii++) {
+        const int i = i_start + threadIdx.x + ii * blockDim.x;
+        if (i < n && i < chunk_size) {
+          args[res_arg_index][i] = r_out[ii];
+        }
+      }
+    }
+  }
+}
+
+// out = op(x, scalar)
+template<typename T, int depth, int r_args_depth, int res_arg_index>
+struct BinaryOpScalarFunctor {
+  using opmath_t = at::acc_type<T, /*is_cuda=*/true>;
+  template<typename Op>
+  __device__ __forceinline__ void operator() (
+      int chunk_size,
+      TensorListMetadata<depth>& tl,
+      Op op,
+      opmath_t scalar) {
+    pointwise_apply<T, depth, r_args_depth, res_arg_index>(chunk_size, tl,
+        [&](const opmath_t* a) { return op(a[0], scalar); });
+  }
+};
+
+// out = op(x, scalars[i]) for the i-th tensor
+template<typename T, int depth, int r_args_depth, int res_arg_index>
+struct BinaryOpScalarListFunctor {
+  using opmath_t = at::acc_type<T, /*is_cuda=*/true>;
+  template<typename Op>
+  __device__ __forceinline__ void operator() (
+      int chunk_size,
+      TensorListScalarListMetadata<opmath_t, depth>& tl,
+      Op op) {
+    const opmath_t scalar = tl.scalar_vals[tl.block_to_tensor[blockIdx.x]];
+    pointwise_apply<T, depth, r_args_depth, res_arg_index>(chunk_size, tl,
+        [&](const opmath_t* a) { return op(a[0], scalar); });
+  }
+};
+
+// out = op(x, alpha * y)
+template<typename T, int depth, int r_args_depth, int res_arg_index>
+struct BinaryOpListAlphaFunctor {
+  using opmath_t = at::acc_type<T, /*is_cuda=*/true>;
+  template<typename Op>
+  __device__ __forceinline__ void operator() (
+      int chunk_size,
+      TensorListMetadata<depth>& tl,
+      Op op,
+      opmath_t alpha) {
+    pointwise_apply<T, depth, r_args_depth, res_arg_index>(chunk_size, tl,
+        [&](const opmath_t* a) { return op(a[0], alpha * a[1]); });
+  }
+};
+
+// out = op(x)
+template<typename T, int depth, int r_args_depth, int res_arg_index>
+struct UnaryOpFunctor {
+  using opmath_t = at::acc_type<T, /*is_cuda=*/true>;
+  template<typename Op>
+  __device__ __forceinline__ void operator() (
+      int chunk_size,
+      TensorListMetadata<depth>& tl,
+      Op op) {
+    pointwise_apply<T, depth, r_args_depth, res_arg_index>(chunk_size, tl,
+        [&](const opmath_t* a) { return op(a[0]); });
+  }
+};
+
+// out = x + scalar * op(t1, t2), e.g. addcmul and addcdiv
+template<typename T, int depth, int r_args_depth, int res_arg_index>
+struct PointwiseOpScalarFunctor {
+  using opmath_t = at::acc_type<T, /*is_cuda=*/true>;
+  template<typename Op>
+  __device__ __forceinline__ void operator() (
+      int chunk_size,
+      TensorListMetadata<depth>& tl,
+      Op op,
+      opmath_t scalar) {
+    pointwise_apply<T, depth, r_args_depth, res_arg_index>(chunk_size, tl,
+        [&](const opmath_t* a) { return a[0] + scalar * op(a[1], a[2]); });
+  }
+};
+
+// out = x + scalars[i] * op(t1, t2) for the i-th tensors
+template<typename T, int depth, int r_args_depth, int res_arg_index>
+struct PointwiseOpScalarListFunctor {
+  using opmath_t = at::acc_type<T, /*is_cuda=*/true>;
+  template<typename Op>
+  __device__ __forceinline__ void operator() (
+      int chunk_size,
+      TensorListScalarListMetadata<opmath_t, depth>& tl,
+      Op op) {
+    const opmath_t scalar = tl.scalar_vals[tl.block_to_tensor[blockIdx.x]];
+    pointwise_apply<T, depth, r_args_depth, res_arg_index>(chunk_size, tl,
+        [&](const opmath_t* a) { return a[0] + scalar * op(a[1], a[2]); });
+  }
+};
+
+// x = 0
+template<typename T>
+struct ZeroFunctor {
+  __device__ __forceinline__ void operator() (
+      int chunk_size,
+      TensorListMetadata<1>& tl) {
+    const int tensor_loc = tl.block_to_tensor[blockIdx.x];
+    const int chunk_idx = tl.block_to_chunk[blockIdx.x];
+    const int n = tl.sizes[tensor_loc] - chunk_idx * chunk_size;
+    T* x = (T*)tl.addresses[0][tensor_loc] + chunk_idx * chunk_size;
+
+    T r_out[kILP];
+#pragma unroll
+    for (int ii = 0; ii < kILP; ii++) {
+      r_out[ii] = T(0);
+    }
+
+    if (n % kILP == 0 && chunk_size % kILP == 0 && is_aligned(x)) {
+      for (int i_start = threadIdx.x; i_start * kILP < n && i_start * kILP < chunk_size; i_start += blockDim.x) {
+        load_store(x, r_out, i_start, 0);
+      }
+    } else {
+      for (int i = threadIdx.x; i < n && i < chunk_size; i += blockDim.x) {
+        x[i] = T(0);
+      }
+    }
+  }
+};
+
+template<typename T>
+struct Sqrt {
+  __device__ __forceinline__ T operator()(T t) const { return std::sqrt(t); }
+};
+
+template<typename T>
+struct Exp {
+  __device__ __forceinline__ T operator()(T t) const { return std::exp(t); }
+};
+
+} // namespace
+
+}} // namespace at::native
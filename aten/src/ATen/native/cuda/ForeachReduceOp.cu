@@ -0,0 +1,322 @@
+#include <ATen/Dispatch.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/native/cuda/ForeachFunctors.cuh>
+#include <ATen/native/cuda/block_reduce.cuh>
+
+#include <cmath>
+#include <type_traits>
+
+namespace at { namespace native {
+
+namespace {
+
+// The NormType of the infinity norm.
+constexpr int kInfNorm = 0;
+
+// Reduces the terms of a norm: sums |x| (NormType 1) or x^2 (NormType 2), or
+// takes the max of |x| (kInfNorm), propagating NaNs like max.
+template<typename opmath_t, int NormType>
+struct LpNormOps {
+  static_assert(NormType == 1 || NormType == 2 || NormType == kInfNorm,
+                "foreach_norm supports only L1, L2 and infinity norm");
+
+  static __device__ __forceinline__ opmath_t term(opmath_t x) {
+    return NormType == 2 ? x * x : ::abs(x);
+  }
+
+  __device__ __forceinline__ opmath_t combine(opmath_t a, opmath_t b) const {
+    if (NormType == kInfNorm) {
+      return (a > b || ::isnan(a)) ? a : b;
+    }
+    return a + b;
+  }
+
+  __device__ __forceinline__ opmath_t warp_shfl_down(opmath_t val, int offset) const {
+    return WARP_SHFL_DOWN(val, offset);
+  }
+
+  static __device__ __forceinline__ opmath_t project(opmath_t acc) {
+    return NormType == 2 ? ::sqrt(acc) : acc;
+  }
+};
+
+// Writes the reduction of the norm terms over one chunk to
+// output_per_tensor[tensor * max_chunks_per_tensor + chunk], where tensor is
+// the index of the tensor in the list.
+template<typename T, int NormType>
+struct LpNormFunctor {
+  using opmath_t = at::acc_type<T, /*is_cuda=*/true>;
+  using Ops = LpNormOps<opmath_t, NormType>;
+  __device__ __forceinline__ void operator() (
+      int chunk_size,
+      TensorListMetadata<1>& tl,
+      opmath_t* output_per_tensor,
+      const int max_chunks_per_tensor) {
+    const int tensor_loc = tl.block_to_tensor[blockIdx.x];
+    const int chunk_idx = tl.block_to_chunk[blockIdx.x];
+    const int n = tl.sizes[tensor_loc] - chunk_idx * chunk_size;
+    T* x = (T*)tl.addresses[0][tensor_loc] + chunk_idx * chunk_size;
+
+    const Ops ops{};
+    __shared__ opmath_t s_vals[kBlockSize / C10_WARP_SIZE];
+    opmath_t vals[kILP];
+    T r_x[kILP];
+#pragma unroll
+    for (int ii = 0; ii < kILP; ii++) {
+      vals[ii] = opmath_t(0);
+    }
+
+    if (n % kILP == 0 && chunk_size % kILP == 0 && is_aligned(x)) {
+      for (int i_start = threadIdx.x; i_start * kILP < n && i_start * kILP < chunk_size; i_start += blockDim.x) {
+        load_store(r_x, x, 0, i_start);
+#pragma unroll
+        for (int ii = 0; ii < kILP; ii++) {
+          vals[ii] = ops.combine(vals[ii], Ops::term(static_cast<opmath_t>(r_x[ii])));
+        }
+      }
+    } else {
+      for (int i_start = 0; i_start < n && i_start < chunk_size; i_start += blockDim.x * kILP) {
+#pragma unroll
+        for (int ii = 0; ii < kILP; ii++) {
+          const int i = i_start + threadIdx.x + ii * blockDim.x;
+          if (i < n && i < chunk_size) {
+            vals[ii] = ops.combine(vals[ii], Ops::term(static_cast<opmath_t>(x[i])));
+          }
+        }
+      }
+    }
+
+    opmath_t val = opmath_t(0);
+#pragma unroll
+    for (int ii = 0; ii < kILP; ii++) {
+      val = ops.combine(val, vals[ii]);
+    }
+    const opmath_t final = cuda_utils::BlockReduce(val, ops, opmath_t(0), s_vals);
+    if (threadIdx.x == 0) {
+      output_per_tensor[(tl.start_tensor_this_launch + tensor_loc) * max_chunks_per_tensor + chunk_idx] = final;
+    }
+  }
+};
+
+// One block per tensor: reduces the chunk results of LpNormFunctor.
+template<typename T, int NormType, typename opmath_t = at::acc_type<T, /*is_cuda=*/true>>
+C10_LAUNCH_BOUNDS_1(kBlockSize)
+__global__ void lpnorm_cleanup(
+    const opmath_t* output_per_tensor,
+    T* ret_per_tensor,
+    int max_chunks_per_tensor) {
+  using Ops = LpNormOps<opmath_t, NormType>;
+  const Ops ops{};
+  __shared__ opmath_t vals[kBlockSize / C10_WARP_SIZE];
+
+  const opmath_t* output_this_tensor = output_per_tensor + blockIdx.x * max_chunks_per_tensor;
+  opmath_t val = opmath_t(0);
+  for (int i = threadIdx.x; i < max_chunks_per_tensor; i += blockDim.x) {
+    val = ops.combine(val, output_this_tensor[i]);
+  }
+  const opmath_t final = cuda_utils::BlockReduce(val, ops, opmath_t(0), vals);
+  if (threadIdx.x == 0) {
+    ret_per_tensor[blockIdx.x] = static_cast<T>(Ops::project(final));
+  }
+}
+
+// One block for all tensors: reduces all the chunk results of LpNormFunctor
+// to the norm of the tensors viewed as a single vector. The unused slots of
+// output_per_tensor are zeros, which do not change the result.
+template<typename T, int NormType, typename opmath_t = at::acc_type<T, /*is_cuda=*/true>>
+C10_LAUNCH_BOUNDS_1(kBlockSize)
+__global__ void lpnorm_total_cleanup(
+    const opmath_t* output_per_tensor,
+    T* ret,
+    int64_t num_outputs) {
+  using Ops = LpNormOps<opmath_t, NormType>;
+  const Ops ops{};
+  __shared__ opmath_t vals[kBlockSize / C10_WARP_SIZE];
+
+  opmath_t val = opmath_t(0);
+  for (int64_t i = threadIdx.x; i < num_outputs; i += blockDim.x) {
+    val = ops.combine(val, output_per_tensor[i]);
+  }
+  const opmath_t final = cuda_utils::BlockReduce(val, ops, opmath_t(0), vals);
+  if (threadIdx.x == 0) {
+    *ret = static_cast<T>(Ops::project(final));
+  }
+}
+
+// x *= max_norm / (total_norm + 1e-6) if that is less than 1. The total norm
+// is read on the device, so clipping doesn't wait for it on the host; the
+// blocks return without writing when there is nothing to clip.
+template<typename T>
+struct ClipScaleFunctor {
+  using opmath_t = at::acc_type<T, /*is_cuda=*/true>;
+  __device__ __forceinline__ void operator() (
+      int chunk_size,
+      TensorListMetadata<1>& tl,
+      const T* total_norm,
+      opmath_t max_norm) {
+    const opmath_t clip_coef = max_norm / (static_cast<opmath_t>(*total_norm) + opmath_t(1e-6));
+    // also false if the norm is NaN
+    if (!(clip_coef < opmath_t(1))) {
+      return;
+    }
+    pointwise_apply<T, 1, 1, 0>(chunk_size, tl,
+        [&](const opmath_t* a) { return a[0] * clip_coef; });
+  }
+};
+
+// The NormType of the fast path for the norm of order p, or -1 if there is
+// none.
+int fast_norm_type(double p) {
+  if (p == 1 || p == 2) {
+    return static_cast<int>(p);
+  }
+  if (std::isinf(p) && p > 0) {
+    return kInfNorm;
+  }
+  return -1;
+}
+
+double norm_order(Scalar ord, const char* op_name) {
+  TORCH_CHECK(ord.isIntegral(false) || ord.isFloatingPoint(),
+              op_name, " expects ord to be integer or float");
+  return ord.to<double>();
+}
+
+// Runs LpNormFunctor over the tensors with the NormType of the fast path,
+// then the cleanup kernel that launch_cleanup launches with that NormType.
+template<typename scalar_t, typename CleanupLauncher>
+void launch_lpnorm(
+    std::vector<std::vector<at::Tensor>>& tensor_lists,
+    int norm_type,
+    at::Tensor& output_per_tensor,
+    int max_chunks_per_tensor,
+    const CleanupLauncher& launch_cleanup) {
+  using opmath_t = at::acc_type<scalar_t, /*is_cuda=*/true>;
+  auto run = [&](auto norm_type_tag) {
+    constexpr int NormType = decltype(norm_type_tag)::value;
+    multi_tensor_apply<1>(tensor_lists,
+                          LpNormFunctor<scalar_t, NormType>(),
+                          output_per_tensor.data_ptr<opmath_t>(),
+                          max_chunks_per_tensor);
+    launch_cleanup(norm_type_tag);
+  };
+  if (norm_type == 1) {
+    run(std::integral_constant<int, 1>());
+  } else if (norm_type == 2) {
+    run(std::integral_constant<int, 2>());
+  } else {
+    run(std::integral_constant<int, kInfNorm>());
+  }
+  AT_CUDA_CHECK(cudaGetLastError());
+}
+
+int max_num_chunks(TensorList tensors) {
+  int max_chunks = 0;
+  for (const auto& t : tensors) {
+    const int max_chunks_this_tensor = (t.numel() + kChunkSize - 1) / kChunkSize;
+    max_chunks = std::max(max_chunks, max_chunks_this_tensor);
+  }
+  return max_chunks;
+}
+
+} // namespace
+
+// The fast path handles the L1, L2 and infinity norms of floating point
+// tensors; the other norms and the integral and complex dtypes go to the slow
+// path.
+std::vector<Tensor> foreach_tensor_norm_cuda(TensorList tensors, Scalar ord) {
+  const double p = norm_order(ord, "foreach_tensor_norm_cuda");
+  check_foreach_api_restrictions(tensors);
+  const int norm_type = fast_norm_type(p);
+  if (!can_use_fast_route({tensors}) || !at::isFloatingType(tensors[0].scalar_type()) || norm_type < 0) {
+    return foreach_tensor_norm_slow(tensors, ord);
+  }
+
+  const int ntensors = tensors.size();
+  const int max_chunks = max_num_chunks(tensors);
+  const auto options = tensors[0].options();
+  auto ret_per_tensor = at::empty({ntensors}, options);
+
+  std::vector<std::vector<at::Tensor>> tensor_lists;
+  tensor_lists.emplace_back(tensors.vec());
+
+  AT_DISPATCH_FLOATING_TYPES_AND2(kHalf, kBFloat16, tensor_lists[0][0].scalar_type(), "foreach_tensor_norm_cuda", [&]() {
+    using opmath_t = at::acc_type<scalar_t, /*is_cuda=*/true>;
+    auto output_per_tensor = at::zeros(
+        {ntensors * max_chunks}, options.dtype(c10::CppTypeToScalarType<opmath_t>::value));
+    const at::cuda::OptionalCUDAGuard device_guard(device_of(output_per_tensor));
+    auto stream = at::cuda::getCurrentCUDAStream();
+    launch_lpnorm<scalar_t>(tensor_lists, norm_type, output_per_tensor, max_chunks, [&](auto norm_type_tag) {
+      lpnorm_cleanup<scalar_t, decltype(norm_type_tag)::value><<<ntensors, kBlockSize, 0, stream>>>(
+          output_per_tensor.data_ptr<opmath_t>(),
+          ret_per_tensor.data_ptr<scalar_t>(),
+          max_chunks);
+    });
+  });
+
+  std::vector<Tensor> result;
+  result.reserve(ntensors);
+  for (int i = 0; i < ntensors; i++) {
+    result.emplace_back(ret_per_tensor[i]);
+  }
+  return result;
+}
+
+// Like foreach_tensor_norm_cuda, but the chunk results of all tensors are
+// reduced together by a single cleanup block.
+Tensor foreach_tensor_total_norm_cuda(TensorList tensors, Scalar ord) {
+  const double p = norm_order(ord, "foreach_tensor_total_norm_cuda");
+  check_foreach_api_restrictions(tensors);
+  const int norm_type = fast_norm_type(p);
+  if (!can_use_fast_route({tensors}) || !at::isFloatingType(tensors[0].scalar_type()) || norm_type < 0) {
+    return foreach_tensor_total_norm_slow(tensors, ord);
+  }
+
+  const int ntensors = tensors.size();
+  const int max_chunks = max_num_chunks(tensors);
+  const auto options = tensors[0].options();
+  auto ret = at::empty({}, options);
+
+  std::vector<std::vector<at::Tensor>> tensor_lists;
+  tensor_lists.emplace_back(tensors.vec());
+
+  AT_DISPATCH_FLOATING_TYPES_AND2(kHalf, kBFloat16, tensor_lists[0][0].scalar_type(), "foreach_tensor_total_norm_cuda", [&]() {
+    using opmath_t = at::acc_type<scalar_t, /*is_cuda=*/true>;
+    auto output_per_tensor = at::zeros(
+        {ntensors * max_chunks}, options.dtype(c10::CppTypeToScalarType<opmath_t>::value));
+    const at::cuda::OptionalCUDAGuard device_guard(device_of(output_per_tensor));
+    auto stream = at::cuda::getCurrentCUDAStream();
+    launch_lpnorm<scalar_t>(tensor_lists, norm_type, output_per_tensor, max_chunks, [&](auto norm_type_tag) {
+      lpnorm_total_cleanup<scalar_t, decltype(norm_type_tag)::value><<<1, kBlockSize, 0, stream>>>(
+          output_per_tensor.data_ptr<opmath_t>(),
+          ret.data_ptr<scalar_t>(),
+          output_per_tensor.numel());
+    });
+  });
+  return ret;
+}
+
+void foreach_tensor_clip_scale_cuda_(TensorList tensors, const Tensor& total_norm, double max_norm) {
+  check_foreach_api_restrictions(tensors);
+  TORCH_CHECK(total_norm.numel() == 1, "total_norm must be a 1-element tensor.");
+  if (!can_use_fast_route({tensors}) || !at::isFloatingType(tensors[0].scalar_type())) {
+    foreach_tensor_clip_scale_slow_(tensors, total_norm, max_norm);
+    return;
+  }
+
+  // a no-op if the norm comes from foreach_tensor_total_norm_cuda
+  const auto norm = total_norm.to(tensors[0].options());
+
+  std::vector<std::vector<at::Tensor>> tensor_lists;
+  tensor_lists.emplace_back(tensors.vec());
+
+  AT_DISPATCH_FLOATING_TYPES_AND2(kHalf, kBFloat16, tensor_lists[0][0].scalar_type(), "foreach_tensor_clip_scale_cuda_", [&]() {
+    using opmath_t = at::acc_type<scalar_t, /*is_cuda=*/true>;
+    multi_tensor_apply<1>(tensor_lists,
+                          ClipScaleFunctor<scalar_t>(),
+                          norm.data_ptr<scalar_t>(),
+                          static_cast<opmath_t>(max_norm));
+  });
+}
+
+}} // namespace at::native
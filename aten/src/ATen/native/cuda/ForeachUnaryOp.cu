@@ -0,0 +1,83 @@
+#include <ATen/Dispatch.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/native/cuda/ForeachFunctors.cuh>
+
+namespace at { namespace native {
+
+template<template<class> class Op>
+std::vector<Tensor> foreach_unary_op(TensorList tensors) {
+    std::vector<std::vector<at::Tensor>> tensor_lists;
+    std::vector<at::Tensor> vec_res;
+    vec_res.reserve(tensors.size());
+    for (const auto& t: tensors) {
+        vec_res.emplace_back(at::native::empty_like(t));
+    }
+
+    tensor_lists.emplace_back(tensors.vec());
+    tensor_lists.emplace_back(std::move(vec_res));
+
+    AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES_AND2(kHalf, kBFloat16, tensors[0].scalar_type(), "foreach_unary_op_cuda", [&]() {
+        using opmath_t = at::acc_type<scalar_t, /*is_cuda=*/true>;
+        multi_tensor_apply<2>(tensor_lists,
+                              UnaryOpFunctor<scalar_t,
+                                             /* depth */ 2,
+                                             /* r_args_depth */ 1,
+                                             /* res_arg_index */ 1>(),
+                              Op<opmath_t>());
+    });
+    return tensor_lists[1];
+}
+
+template<template<class> class Op>
+void foreach_unary_op_(TensorList tensors) {
+    std::vector<std::vector<at::Tensor>> tensor_lists;
+    tensor_lists.emplace_back(tensors.vec());
+
+    AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES_AND2(kHalf, kBFloat16, tensors[0].scalar_type(), "foreach_unary_op_cuda_", [&]() {
+        using opmath_t = at::acc_type<scalar_t, /*is_cuda=*/true>;
+        multi_tensor_apply<1>(tensor_lists,
+                              UnaryOpFunctor<scalar_t,
+                                             /* depth */ 1,
+                                             /* r_args_depth */ 1,
+                                             /* res_arg_index */ 0>(),
+                              Op<opmath_t>());
+    });
+}
+
+#define FOREACH_UNARY_OP(NAME, OP)                                          \
+std::vector<Tensor> foreach_tensor_##NAME##_cuda(TensorList tensors) {      \
+    check_foreach_api_restrictions(tensors);                                \
+    if (!can_use_fast_route({tensors}, /*floating_point_result*/ true)) {   \
+        return at::native::foreach_tensor_##NAME##_slow(tensors);           \
+    }                                                                       \
+                                                                            \
+    return foreach_unary_op<OP>(tensors);                                   \
+}                                                                           \
+                                                                            \
+void foreach_tensor_##NAME##_cuda_(TensorList tensors) {                    \
+    check_foreach_api_restrictions(tensors);                                \
+    if (!can_use_fast_route({tensors}, /*floating_point_result*/ true)) {   \
+        return at::native::foreach_tensor_##NAME##_slow_(tensors);          \
+    }                                                                       \
+                                                                            \
+    foreach_unary_op_<OP>(tensors);                                         \
+}
+
+FOREACH_UNARY_OP(sqrt, Sqrt);
+FOREACH_UNARY_OP(exp, Exp);
+
+void foreach_tensor_zero_cuda_(TensorList tensors) {
+    check_foreach_api_restrictions(tensors);
+    if (!can_use_fast_route({tensors})) {
+        return at::native::foreach_tensor_zero_slow_(tensors);
+    }
+
+    std::vector<std::vector<at::Tensor>> tensor_lists;
+    tensor_lists.emplace_back(tensors.vec());
+
+    AT_DISPATCH_ALL_TYPES_AND_COMPLEX_AND2(kHalf, kBFloat16, tensors[0].scalar_type(), "foreach_zero_cuda_", [&]() {
+        multi_tensor_apply<1>(tensor_lists, ZeroFunctor<scalar_t>());
+    });
+}
+
+}} // namespace at::native
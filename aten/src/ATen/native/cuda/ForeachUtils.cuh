@@ -1,5 +1,6 @@
 #pragma once
 #include <ATen/ATen.h>
+#include <ATen/native/ForeachUtils.h>
 #include <ATen/native/cuda/Loops.cuh>
 #include <ATen/native/cuda/MemoryAccess.cuh>
 namespace at { 
@@ -22,35 +23,4 @@ __device__ __forceinline__ void load_store(T* dst, T* src, int dst_offset, int s
 }
 
 }
-
-bool check_fast_route(TensorList tensors, Scalar scalar) {
-  TORCH_CHECK(tensors.size() > 0, "Tensor list must have at least one tensor.");
-  auto expected_dtype = tensors[0].dtype();
-  auto expected_device = tensors[0].device();
-
-  for (auto t : tensors) {
-    if (t.dtype() != expected_dtype) {
-      return false;
-    }
-
-    if (t.device() != expected_device) {
-      return false;
-    }
-
-    if (t.layout() != at::kStrided) {
-      return false;
-    }
-
-    if (!t.is_non_overlapping_and_dense()) {
-      return false;
-    }
-
-    if ((at::isIntegralType(t.scalar_type(), true) && scalar.isFloatingPoint()) || 
-        t.scalar_type() == at::kBool) {
-     return false;
-    }
-  }
-
-  return true;
-}
 }} // at::native
@@ -0,0 +1,248 @@
+#include <ATen/native/FusedAttention.h>
+
+#include <ATen/ATen.h>
+#include <ATen/AccumulateType.h>
+#include <ATen/Dispatch.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/DeviceUtils.cuh>
+
+#include <c10/cuda/CUDAMathCompat.h>
+
+#include <limits>
+
+namespace at {
+namespace native {
+
+namespace {
+
+constexpr int kMaxHeadDim = 128;
+constexpr int kWarpsPerBlock = 8;
+constexpr int kDimsPerLane = kMaxHeadDim / C10_WARP_SIZE;
+
+// The keys of a tile, one per lane. Fewer for double, whose tiles would
+// otherwise not fit in shared memory.
+template <typename scalar_t>
+constexpr int key_tile_size() {
+  return sizeof(scalar_t) > 4 ? C10_WARP_SIZE / 2 : C10_WARP_SIZE;
+}
+
+// The rows of the key and value tiles are padded by one element, so that the
+// lanes reading the rows of consecutive keys hit different banks.
+template <typename scalar_t, typename acc_t>
+size_t fused_attention_shared_memory_size(int64_t D) {
+  return kWarpsPerBlock * D * sizeof(acc_t) +
+      2 * key_tile_size<scalar_t>() * (D + 1) * sizeof(scalar_t);
+}
+
+// Each warp computes the output of a query: the block loads the tiles of keys
+// and values to shared memory, then lane j scores key j of the tile and the
+// warp updates the running maximum and sum of the softmax of its query, and
+// its output, whose dimensions lane, lane + 32, ... are held by each lane.
+template <typename scalar_t, typename acc_t>
+__global__ void fused_attention_kernel(
+    scalar_t* __restrict__ output,
+    const scalar_t* __restrict__ query,
+    const scalar_t* __restrict__ key,
+    const scalar_t* __restrict__ value,
+    const bool* __restrict__ key_padding_mask,
+    int64_t H,
+    int64_t L,
+    int64_t S,
+    int64_t D,
+    int64_t q_stride_b,
+    int64_t q_stride_h,
+    int64_t q_stride_l,
+    int64_t k_stride_b,
+    int64_t k_stride_h,
+    int64_t k_stride_s,
+    int64_t v_stride_b,
+    int64_t v_stride_h,
+    int64_t v_stride_s,
+    int64_t mask_stride_b,
+    int64_t mask_stride_s,
+    bool causal,
+    acc_t scale) {
+  constexpr int kKeyTile = key_tile_size<scalar_t>();
+  extern __shared__ char shared_mem[];
+  acc_t* q_shared = reinterpret_cast<acc_t*>(shared_mem);
+  scalar_t* k_shared =
+      reinterpret_cast<scalar_t*>(q_shared + kWarpsPerBlock * D);
+  scalar_t* v_shared = k_shared + kKeyTile * (D + 1);
+
+  const int64_t bh = blockIdx.y;
+  const int64_t b = bh / H;
+  const int64_t h = bh % H;
+  const int warp = threadIdx.x / C10_WARP_SIZE;
+  const int lane = threadIdx.x % C10_WARP_SIZE;
+  const int64_t l_begin = static_cast<int64_t>(blockIdx.x) * kWarpsPerBlock;
+  const int64_t l = l_begin + warp;
+  const bool active = l < L;
+  const acc_t neg_inf = -std::numeric_limits<acc_t>::infinity();
+
+  const scalar_t* k_bh = key + b * k_stride_b + h * k_stride_h;
+  const scalar_t* v_bh = value + b * v_stride_b + h * v_stride_h;
+  acc_t* q_row = q_shared + warp * D;
+  if (active) {
+    const scalar_t* q = query + b * q_stride_b + h * q_stride_h + l * q_stride_l;
+    for (int64_t d = lane; d < D; d += C10_WARP_SIZE) {
+      q_row[d] = static_cast<acc_t>(q[d]) * scale;
+    }
+  }
+
+  acc_t running_max = neg_inf;
+  acc_t sum = 0;
+  acc_t acc[kDimsPerLane];
+#pragma unroll
+  for (int i = 0; i < kDimsPerLane; i++) {
+    acc[i] = 0;
+  }
+
+  // The keys after the last query of the block are masked for all of them.
+  const int64_t s_end =
+      causal ? std::min(S, std::min(L, l_begin + kWarpsPerBlock)) : S;
+  for (int64_t s_begin = 0; s_begin < s_end; s_begin += kKeyTile) {
+    const int tile = static_cast<int>(std::min<int64_t>(kKeyTile, s_end - s_begin));
+    __syncthreads();
+    for (int64_t i = threadIdx.x; i < tile * D; i += blockDim.x) {
+      const int64_t j = i / D;
+      const int64_t d = i % D;
+      k_shared[j * (D + 1) + d] = k_bh[(s_begin + j) * k_stride_s + d];
+      v_shared[j * (D + 1) + d] = v_bh[(s_begin + j) * v_stride_s + d];
+    }
+    __syncthreads();
+    if (!active) {
+      continue;
+    }
+
+    const int64_t s = s_begin + lane;
+    acc_t score = neg_inf;
+    if (lane < tile && !(causal && s > l) &&
+        !(key_padding_mask &&
+          key_padding_mask[b * mask_stride_b + s * mask_stride_s])) {
+      const scalar_t* k_row = k_shared + lane * (D + 1);
+      acc_t dot = 0;
+      for (int64_t d = 0; d < D; d++) {
+        dot += q_row[d] * static_cast<acc_t>(k_row[d]);
+      }
+      score = dot;
+    }
+    acc_t tile_max = score;
+    for (int offset = C10_WARP_SIZE / 2; offset > 0; offset /= 2) {
+      tile_max = ::max(tile_max, WARP_SHFL_XOR(tile_max, offset));
+    }
+    if (tile_max == neg_inf) {
+      continue;
+    }
+
+    const acc_t new_max = ::max(running_max, tile_max);
+    const acc_t correction = c10::cuda::compat::exp(running_max - new_max);
+    const acc_t p =
+        score == neg_inf ? acc_t(0) : c10::cuda::compat::exp(score - new_max);
+    acc_t tile_sum = p;
+    for (int offset = C10_WARP_SIZE / 2; offset > 0; offset /= 2) {
+      tile_sum += WARP_SHFL_XOR(tile_sum, offset);
+    }
+    sum = sum * correction + tile_sum;
+    running_max = new_max;
+#pragma unroll
+    for (int i = 0; i < kDimsPerLane; i++) {
+      acc[i] *= correction;
+    }
+    for (int j = 0; j < tile; j++) {
+      const acc_t p_j = WARP_SHFL(p, j);
+      const scalar_t* v_row = v_shared + j * (D + 1);
+#pragma unroll
+      for (int i = 0; i < kDimsPerLane; i++) {
+        const int64_t d = lane + i * C10_WARP_SIZE;
+        if (d < D) {
+          acc[i] += p_j * static_cast<acc_t>(v_row[d]);
+        }
+      }
+    }
+  }
+
+  // Queries without any key left get NaNs, as the softmax of -inf scores.
+  if (active) {
+    scalar_t* out_row = output + (bh * L + l) * D;
+#pragma unroll
+    for (int i = 0; i < kDimsPerLane; i++) {
+      const int64_t d = lane + i * C10_WARP_SIZE;
+      if (d < D) {
+        out_row[d] = static_cast<scalar_t>(acc[i] / sum);
+      }
+    }
+  }
+}
+
+} // namespace
+
+Tensor fused_attention_cuda(
+    const Tensor& query_,
+    const Tensor& key_,
+    const Tensor& value_,
+    const Tensor& key_padding_mask /* optional */,
+    bool causal,
+    double scale) {
+  check_fused_attention_inputs(query_, key_, value_, key_padding_mask);
+  TORCH_CHECK(
+      query_.size(3) <= kMaxHeadDim,
+      "_fused_attention: expected a head dimension of at most ", kMaxHeadDim,
+      " on CUDA, but got ", query_.size(3));
+  const auto query = fused_attention_contiguous_rows(query_);
+  const auto key = fused_attention_contiguous_rows(key_);
+  const auto value = fused_attention_contiguous_rows(value_);
+  auto output = at::empty(query.sizes(), query.options());
+  if (output.numel() == 0) {
+    return output;
+  }
+
+  const int64_t B = query.size(0);
+  const int64_t H = query.size(1);
+  const int64_t L = query.size(2);
+  const int64_t D = query.size(3);
+  const int64_t S = key.size(2);
+  TORCH_CHECK(
+      B * H <= at::cuda::getCurrentDeviceProperties()->maxGridSize[1],
+      "_fused_attention: too many batches and heads (", B * H, ") on CUDA");
+  const dim3 grid((L + kWarpsPerBlock - 1) / kWarpsPerBlock, B * H);
+  const dim3 block(kWarpsPerBlock * C10_WARP_SIZE);
+  const bool has_mask = key_padding_mask.defined();
+  cudaStream_t stream = at::cuda::getCurrentCUDAStream();
+
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(
+      query.scalar_type(), "fused_attention_cuda", [&] {
+        using acc_t = acc_type<scalar_t, true>;
+        const size_t shared_mem =
+            fused_attention_shared_memory_size<scalar_t, acc_t>(D);
+        fused_attention_kernel<scalar_t, acc_t>
+            <<<grid, block, shared_mem, stream>>>(
+                output.data_ptr<scalar_t>(),
+                query.data_ptr<scalar_t>(),
+                key.data_ptr<scalar_t>(),
+                value.data_ptr<scalar_t>(),
+                has_mask ? key_padding_mask.data_ptr<bool>() : nullptr,
+                H,
+                L,
+                S,
+                D,
+                query.stride(0),
+                query.stride(1),
+                query.stride(2),
+                key.stride(0),
+                key.stride(1),
+                key.stride(2),
+                value.stride(0),
+                value.stride(1),
+                value.stride(2),
+                has_mask ? key_padding_mask.stride(0) : 0,
+                has_mask ? key_padding_mask.stride(1) : 0,
+                causal,
+                static_cast<acc_t>(scale));
+        AT_CUDA_CHECK(cudaGetLastError());
+      });
+  return output;
+}
+
+} // namespace native
+} // namespace at
@@ -0,0 +1,374 @@
+#include <ATen/Dispatch.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/native/cuda/ForeachFunctors.cuh>
+
+#include <type_traits>
+
+// Optimizer steps that read and write every tensor of a param group once.
+//
+// The lists of a step are walked with multi_tensor_apply: for each element the
+// kernel loads the param, its grad and the optimizer state, computes the
+// update in opmath_t and stores the new values. Params may be Half or BFloat16
+// with float master params: the master params and the optimizer state are
+// then float, the update is applied to the master params and the params
+// receive the rounded result.
+//
+// If found_inf is given (as written by _amp_non_finite_check_and_unscale_ or
+// _amp_foreach_non_finite_check_and_unscale_), the kernels leave all tensors
+// untouched when it is nonzero, without synchronizing with the host. Step
+// counts are kept by the caller, which has to account for skipped steps.
+
+namespace at { namespace native {
+
+namespace {
+
+template<typename T>
+__device__ __forceinline__ T* list_ptr(void* address, int chunk_idx, int chunk_size) {
+  return static_cast<T*>(address) + chunk_idx * chunk_size;
+}
+
+// Lists: param, grad, exp_avg, exp_avg_sq, [max_exp_avg_sq], [master_param].
+// tl.scalar_vals holds the step count of each param.
+template<typename param_t, bool amsgrad, bool has_master>
+struct FusedAdamFunctor {
+  using opmath_t = at::acc_type<param_t, /*is_cuda=*/true>;
+  using state_t = typename std::conditional<has_master, opmath_t, param_t>::type;
+  static constexpr int depth = 4 + amsgrad + has_master;
+
+  __device__ __forceinline__ void operator() (
+      int chunk_size,
+      TensorListScalarListMetadata<opmath_t, depth>& tl,
+      opmath_t lr,
+      opmath_t beta1,
+      opmath_t beta2,
+      opmath_t weight_decay,
+      opmath_t eps,
+      bool decoupled_weight_decay,
+      const float* found_inf) {
+    if (found_inf != nullptr && *found_inf != 0.f) {
+      return;
+    }
+    const int tensor_loc = tl.block_to_tensor[blockIdx.x];
+    const int chunk_idx = tl.block_to_chunk[blockIdx.x];
+    const int n = tl.sizes[tensor_loc] - chunk_idx * chunk_size;
+
+    const opmath_t step = tl.scalar_vals[tensor_loc];
+    const opmath_t bias_correction1 = 1 - ::pow(beta1, step);
+    const opmath_t bias_correction2_sqrt = ::sqrt(1 - ::pow(beta2, step));
+    const opmath_t step_size = lr / bias_correction1;
+
+    param_t* param = list_ptr<param_t>(tl.addresses[0][tensor_loc], chunk_idx, chunk_size);
+    param_t* grad = list_ptr<param_t>(tl.addresses[1][tensor_loc], chunk_idx, chunk_size);
+    state_t* exp_avg = list_ptr<state_t>(tl.addresses[2][tensor_loc], chunk_idx, chunk_size);
+    state_t* exp_avg_sq = list_ptr<state_t>(tl.addresses[3][tensor_loc], chunk_idx, chunk_size);
+    state_t* max_exp_avg_sq = amsgrad ? list_ptr<state_t>(tl.addresses[4][tensor_loc], chunk_idx, chunk_size) : nullptr;
+    state_t* master = has_master ? list_ptr<state_t>(tl.addresses[depth - 1][tensor_loc], chunk_idx, chunk_size) : nullptr;
+
+    opmath_t r_p[kILP];
+    opmath_t r_g[kILP];
+    opmath_t r_m[kILP];
+    opmath_t r_v[kILP];
+    opmath_t r_v_max[kILP];
+
+    for (int i_start = 0; i_start < n && i_start < chunk_size; i_start += blockDim.x * kILP) {
+#pragma unroll
+      for (int ii = 0; ii < kILP; ii++) {
+        const int i = i_start + threadIdx.x + ii * blockDim.x;
+        if (i < n && i < chunk_size) {
+          r_p[ii] = has_master ? static_cast<opmath_t>(master[i]) : static_cast<opmath_t>(param[i]);
+          r_g[ii] = static_cast<opmath_t>(grad[i]);
+          r_m[ii] = static_cast<opmath_t>(exp_avg[i]);
+          r_v[ii] = static_cast<opmath_t>(exp_avg_sq[i]);
+          r_v_max[ii] = amsgrad ? static_cast<opmath_t>(max_exp_avg_sq[i]) : opmath_t(0);
+        }
+      }
+#pragma unroll
+      for (int ii = 0; ii < kILP; ii++) {
+        if (weight_decay != 0) {
+          if (decoupled_weight_decay) {
+            r_p[ii] *= 1 - lr * weight_decay;
+          } else {
+            r_g[ii] += weight_decay * r_p[ii];
+          }
+        }
+        r_m[ii] = beta1 * r_m[ii] + (1 - beta1) * r_g[ii];
+        r_v[ii] = beta2 * r_v[ii] + (1 - beta2) * r_g[ii] * r_g[ii];
+        opmath_t denom;
+        if (amsgrad) {
+          r_v_max[ii] = r_v_max[ii] > r_v[ii] ? r_v_max[ii] : r_v[ii];
+          denom = ::sqrt(r_v_max[ii]) / bias_correction2_sqrt + eps;
+        } else {
+          denom = ::sqrt(r_v[ii]) / bias_correction2_sqrt + eps;
+        }
+        r_p[ii] -= step_size * r_m[ii] / denom;
+      }
+#pragma unroll
+      for (int ii = 0; ii < kILP; ii++) {
+        const int i = i_start + threadIdx.x + ii * blockDim.x;
+        if (i < n && i < chunk_size) {
+          param[i] = static_cast<param_t>(r_p[ii]);
+          exp_avg[i] = static_cast<state_t>(r_m[ii]);
+          exp_avg_sq[i] = static_cast<state_t>(r_v[ii]);
+          if (amsgrad) {
+            max_exp_avg_sq[i] = static_cast<state_t>(r_v_max[ii]);
+          }
+          if (has_master) {
+            master[i] = static_cast<state_t>(r_p[ii]);
+          }
+        }
+      }
+    }
+  }
+};
+
+// Lists: param, grad, [momentum_buffer], [master_param].
+template<typename param_t, bool has_momentum, bool has_master>
+struct FusedSGDFunctor {
+  using opmath_t = at::acc_type<param_t, /*is_cuda=*/true>;
+  using state_t = typename std::conditional<has_master, opmath_t, param_t>::type;
+  static constexpr int depth = 2 + has_momentum + has_master;
+
+  __device__ __forceinline__ void operator() (
+      int chunk_size,
+      TensorListMetadata<depth>& tl,
+      opmath_t lr,
+      opmath_t momentum,
+      opmath_t dampening,
+      opmath_t weight_decay,
+      bool nesterov,
+      bool first_step,
+      const float* found_inf) {
+    if (found_inf != nullptr && *found_inf != 0.f) {
+      return;
+    }
+    const int tensor_loc = tl.block_to_tensor[blockIdx.x];
+    const int chunk_idx = tl.block_to_chunk[blockIdx.x];
+    const int n = tl.sizes[tensor_loc] - chunk_idx * chunk_size;
+
+    param_t* param = list_ptr<param_t>(tl.addresses[0][tensor_loc], chunk_idx, chunk_size);
+    param_t* grad = list_ptr<param_t>(tl.addresses[1][tensor_loc], chunk_idx, chunk_size);
+    state_t* buf = has_momentum ? list_ptr<state_t>(tl.addresses[2][tensor_loc], chunk_idx, chunk_size) : nullptr;
+    state_t* master = has_master ? list_ptr<state_t>(tl.addresses[depth - 1][tensor_loc], chunk_idx, chunk_size) : nullptr;
+
+    opmath_t r_p[kILP];
+    opmath_t r_g[kILP];
+    opmath_t r_buf[kILP];
+
+    for (int i_start = 0; i_start < n && i_start < chunk_size; i_start += blockDim.x * kILP) {
+#pragma unroll
+      for (int ii = 0; ii < kILP; ii++) {
+        const int i = i_start + threadIdx.x + ii * blockDim.x;
+        if (i < n && i < chunk_size) {
+          r_p[ii] = has_master ? static_cast<opmath_t>(master[i]) : static_cast<opmath_t>(param[i]);
+          r_g[ii] = static_cast<opmath_t>(grad[i]);
+          r_buf[ii] = (has_momentum && !first_step) ? static_cast<opmath_t>(buf[i]) : opmath_t(0);
+        }
+      }
+#pragma unroll
+      for (int ii = 0; ii < kILP; ii++) {
+        if (weight_decay != 0) {
+          r_g[ii] += weight_decay * r_p[ii];
+        }
+        if (has_momentum) {
+          // The buffer starts as a copy of the first gradient.
+          r_buf[ii] = first_step ? r_g[ii] : momentum * r_buf[ii] + (1 - dampening) * r_g[ii];
+          r_g[ii] = nesterov ? r_g[ii] + momentum * r_buf[ii] : r_buf[ii];
+        }
+        r_p[ii] -= lr * r_g[ii];
+      }
+#pragma unroll
+      for (int ii = 0; ii < kILP; ii++) {
+        const int i = i_start + threadIdx.x + ii * blockDim.x;
+        if (i < n && i < chunk_size) {
+          param[i] = static_cast<param_t>(r_p[ii]);
+          if (has_momentum) {
+            buf[i] = static_cast<state_t>(r_buf[ii]);
+          }
+          if (has_master) {
+            master[i] = static_cast<state_t>(r_p[ii]);
+          }
+        }
+      }
+    }
+  }
+};
+
+// Checks that list `name` has a tensor for each param, with the layout of the
+// param, on its device and of dtype `dtype`.
+void check_fused_list(TensorList params, TensorList tensors, ScalarType dtype, const char* name) {
+  TORCH_CHECK(tensors.size() == params.size(),
+              "Expected ", params.size(), " tensors in ", name, ", got ", tensors.size());
+  for (size_t i = 0; i < tensors.size(); i++) {
+    const auto& t = tensors[i];
+    TORCH_CHECK(t.device() == params[0].device(),
+                "Expected all tensors of a fused optimizer step on ", params[0].device(),
+                ", got ", name, "[", i, "] on ", t.device());
+    TORCH_CHECK(t.scalar_type() == dtype,
+                "Expected ", name, "[", i, "] of dtype ", dtype, ", got ", t.scalar_type());
+    TORCH_CHECK(t.layout() == at::kStrided && t.is_non_overlapping_and_dense() &&
+                t.sizes() == params[i].sizes() && t.strides() == params[i].strides(),
+                "Expected ", name, "[", i, "] dense and of the same sizes and strides as its param");
+  }
+}
+
+// Checks the params and grads and returns the dtype of the optimizer state
+// and master params.
+ScalarType check_fused_params(TensorList params, TensorList grads, TensorList master_params,
+                              const Tensor& found_inf) {
+  TORCH_CHECK(params.size() > 0, "Tensor list must have at least one tensor.");
+  const auto dtype = params[0].scalar_type();
+  TORCH_CHECK(params[0].is_cuda(), "Fused optimizer steps expect CUDA params, got ", params[0].device());
+  TORCH_CHECK(at::isFloatingType(dtype), "Fused optimizer steps expect floating point params, got ", dtype);
+  check_fused_list(params, params, dtype, "params");
+  check_fused_list(params, grads, dtype, "grads");
+
+  ScalarType state_dtype = dtype;
+  if (master_params.size() > 0) {
+    TORCH_CHECK(dtype == kHalf || dtype == kBFloat16,
+                "Master params are supported only for Half and BFloat16 params, got ", dtype);
+    state_dtype = kFloat;
+    check_fused_list(params, master_params, state_dtype, "master_params");
+  }
+  if (found_inf.defined()) {
+    TORCH_CHECK(found_inf.device() == params[0].device(), "found_inf must be on the device of the params.");
+    TORCH_CHECK(found_inf.numel() == 1, "found_inf must be a 1-element tensor.");
+    TORCH_CHECK(found_inf.scalar_type() == at::ScalarType::Float, "found_inf must be a float tensor.");
+  }
+  return state_dtype;
+}
+
+template<typename scalar_t, bool amsgrad, bool has_master>
+void fused_adam_impl(
+    std::vector<std::vector<at::Tensor>>& tensor_lists, ArrayRef<double> steps,
+    double lr, double beta1, double beta2, double weight_decay, double eps,
+    bool decoupled_weight_decay, const float* found_inf_ptr) {
+  using Functor = FusedAdamFunctor<scalar_t, amsgrad, has_master>;
+  using opmath_t = typename Functor::opmath_t;
+  multi_tensor_apply<Functor::depth, opmath_t>(
+      tensor_lists, steps, Functor(),
+      static_cast<opmath_t>(lr), static_cast<opmath_t>(beta1), static_cast<opmath_t>(beta2),
+      static_cast<opmath_t>(weight_decay), static_cast<opmath_t>(eps),
+      decoupled_weight_decay, found_inf_ptr);
+}
+
+template<typename scalar_t, bool has_momentum, bool has_master>
+void fused_sgd_impl(
+    std::vector<std::vector<at::Tensor>>& tensor_lists,
+    double lr, double momentum, double dampening, double weight_decay,
+    bool nesterov, bool first_step, const float* found_inf_ptr) {
+  using Functor = FusedSGDFunctor<scalar_t, has_momentum, has_master>;
+  using opmath_t = typename Functor::opmath_t;
+  multi_tensor_apply<Functor::depth>(
+      tensor_lists, Functor(),
+      static_cast<opmath_t>(lr), static_cast<opmath_t>(momentum),
+      static_cast<opmath_t>(dampening), static_cast<opmath_t>(weight_decay),
+      nesterov, first_step, found_inf_ptr);
+}
+
+} // namespace
+
+// Adam step of all params; with decoupled_weight_decay, the AdamW step.
+// max_exp_avg_sqs must be empty unless amsgrad is set, and master_params is
+// either empty or has a float tensor for each Half or BFloat16 param.
+void _fused_adam_cuda_(
+    TensorList params,
+    TensorList grads,
+    TensorList exp_avgs,
+    TensorList exp_avg_sqs,
+    TensorList max_exp_avg_sqs,
+    TensorList master_params,
+    ArrayRef<double> steps,
+    double lr,
+    double beta1,
+    double beta2,
+    double weight_decay,
+    double eps,
+    bool amsgrad,
+    bool decoupled_weight_decay,
+    const Tensor& found_inf) {
+  const auto state_dtype = check_fused_params(params, grads, master_params, found_inf);
+  check_fused_list(params, exp_avgs, state_dtype, "exp_avgs");
+  check_fused_list(params, exp_avg_sqs, state_dtype, "exp_avg_sqs");
+  if (amsgrad) {
+    check_fused_list(params, max_exp_avg_sqs, state_dtype, "max_exp_avg_sqs");
+  } else {
+    TORCH_CHECK(max_exp_avg_sqs.size() == 0, "max_exp_avg_sqs must be empty without amsgrad");
+  }
+  TORCH_CHECK(steps.size() == params.size(),
+              "Expected a step count for each of the ", params.size(), " params, got ", steps.size());
+
+  std::vector<std::vector<at::Tensor>> tensor_lists;
+  tensor_lists.emplace_back(params.vec());
+  tensor_lists.emplace_back(grads.vec());
+  tensor_lists.emplace_back(exp_avgs.vec());
+  tensor_lists.emplace_back(exp_avg_sqs.vec());
+  if (amsgrad) {
+    tensor_lists.emplace_back(max_exp_avg_sqs.vec());
+  }
+  const bool has_master = master_params.size() > 0;
+  if (has_master) {
+    tensor_lists.emplace_back(master_params.vec());
+  }
+  const float* found_inf_ptr = found_inf.defined() ? found_inf.data_ptr<float>() : nullptr;
+
+  AT_DISPATCH_FLOATING_TYPES_AND2(kHalf, kBFloat16, params[0].scalar_type(), "_fused_adam_cuda_", [&]() {
+    if (amsgrad && has_master) {
+      fused_adam_impl<scalar_t, true, true>(tensor_lists, steps, lr, beta1, beta2, weight_decay, eps, decoupled_weight_decay, found_inf_ptr);
+    } else if (amsgrad) {
+      fused_adam_impl<scalar_t, true, false>(tensor_lists, steps, lr, beta1, beta2, weight_decay, eps, decoupled_weight_decay, found_inf_ptr);
+    } else if (has_master) {
+      fused_adam_impl<scalar_t, false, true>(tensor_lists, steps, lr, beta1, beta2, weight_decay, eps, decoupled_weight_decay, found_inf_ptr);
+    } else {
+      fused_adam_impl<scalar_t, false, false>(tensor_lists, steps, lr, beta1, beta2, weight_decay, eps, decoupled_weight_decay, found_inf_ptr);
+    }
+  });
+}
+
+// SGD step of all params. momentum_buffers must be empty if momentum is 0;
+// with first_step set, the buffers are overwritten with the gradients.
+void _fused_sgd_cuda_(
+    TensorList params,
+    TensorList grads,
+    TensorList momentum_buffers,
+    TensorList master_params,
+    double lr,
+    double momentum,
+    double dampening,
+    double weight_decay,
+    bool nesterov,
+    bool first_step,
+    const Tensor& found_inf) {
+  const auto state_dtype = check_fused_params(params, grads, master_params, found_inf);
+  const bool has_momentum = momentum != 0;
+  if (has_momentum) {
+    check_fused_list(params, momentum_buffers, state_dtype, "momentum_buffers");
+  } else {
+    TORCH_CHECK(momentum_buffers.size() == 0, "momentum_buffers must be empty without momentum");
+  }
+
+  std::vector<std::vector<at::Tensor>> tensor_lists;
+  tensor_lists.emplace_back(params.vec());
+  tensor_lists.emplace_back(grads.vec());
+  if (has_momentum) {
+    tensor_lists.emplace_back(momentum_buffers.vec());
+  }
+  const bool has_master = master_params.size() > 0;
+  if (has_master) {
+    tensor_lists.emplace_back(master_params.vec());
+  }
+  const float* found_inf_ptr = found_inf.defined() ? found_inf.data_ptr<float>() : nullptr;
+
+  AT_DISPATCH_FLOATING_TYPES_AND2(kHalf, kBFloat16, params[0].scalar_type(), "_fused_sgd_cuda_", [&]() {
+    if (has_momentum && has_master) {
+      fused_sgd_impl<scalar_t, true, true>(tensor_lists, lr, momentum, dampening, weight_decay, nesterov, first_step, found_inf_ptr);
+    } else if (has_momentum) {
+      fused_sgd_impl<scalar_t, true, false>(tensor_lists, lr, momentum, dampening, weight_decay, nesterov, first_step, found_inf_ptr);
+    } else if (has_master) {
+      fused_sgd_impl<scalar_t, false, true>(tensor_lists, lr, momentum, dampening, weight_decay, nesterov, first_step, found_inf_ptr);
+    } else {
+      fused_sgd_impl<scalar_t, false, false>(tensor_lists, lr, momentum, dampening, weight_decay, nesterov, first_step, found_inf_ptr);
+    }
+  });
+}
+
+}} // namespace at::native
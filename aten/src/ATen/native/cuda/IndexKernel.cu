@@ -3,6 +3,7 @@
 #include <ATen/ATen.h>
 #include <ATen/Dispatch.h>
 #include <ATen/native/TensorIterator.h>
+#include <ATen/native/cuda/Loops.cuh>
 #include <ATen/core/Array.h>
 #include <ATen/cuda/detail/OffsetCalculator.cuh>
 #include <ATen/cuda/CUDAContext.h>
@@ -154,6 +155,119 @@ Tensor & masked_select_out_cuda(Tensor & result, const Tensor & self, const Tens
   return masked_select_out_cuda_impl(result, self, mask);
 }
 
+template <typename mask_t>
+void masked_fill_kernel(TensorIterator& iter, Scalar value) {
+  AT_DISPATCH_ALL_TYPES_AND_COMPLEX_AND3(at::ScalarType::Bool, at::ScalarType::Half, at::ScalarType::BFloat16, iter.dtype(), "masked_fill_", [&] {
+    const auto value_ = value.to<scalar_t>();
+    gpu_kernel(iter, [value_]GPU_LAMBDA(scalar_t self, mask_t mask) -> scalar_t {
+      if (mask) {
+        return value_;
+      }
+      return self;
+    });
+  });
+}
+
+static Tensor & masked_fill_impl_cuda(Tensor& self, const Tensor& mask, Scalar value) {
+  NoNamesGuard guard;
+  TORCH_CHECK(self.device() == mask.device(), "expected self and mask to be on the same device, but got mask on ",
+              mask.device(), " and self on ", self.device());
+  TORCH_CHECK(mask.scalar_type() == ScalarType::Byte || mask.scalar_type() == ScalarType::Bool,
+              "masked_fill_: expected BoolTensor or ByteTensor for mask");
+  Tensor b_mask;
+  std::tie(b_mask) = expand_inplace(self, mask, "masked_fill_");
+
+  auto iter = TensorIteratorConfig()
+    .check_all_same_dtype(false)
+    .resize_outputs(false)
+    .add_output(self)
+    .add_input(self)
+    .add_input(b_mask)
+    .build();
+
+  if (b_mask.dtype() == ScalarType::Byte) {
+    TORCH_WARN("masked_fill_ received a mask with dtype torch.uint8, this behavior is now deprecated," \
+            "please use a mask with dtype torch.bool instead.");
+    masked_fill_kernel<uint8_t>(iter, value);
+  } else {
+    masked_fill_kernel<bool>(iter, value);
+  }
+  return self;
+}
+
+Tensor & masked_fill__cuda(Tensor& self, const Tensor& mask, Scalar value) {
+  auto maybe_outnames = namedinference::broadcast_to_outnames(self, mask, "masked_fill_");
+  masked_fill_impl_cuda(self, mask, value);
+  namedinference::propagate_names_if_nonempty(self, maybe_outnames);
+  return self;
+}
+
+Tensor & masked_fill__cuda(Tensor& self, const Tensor& mask, const Tensor& value) {
+  auto maybe_outnames = namedinference::broadcast_to_outnames(self, mask, "masked_fill_");
+  TORCH_CHECK(value.dim() == 0, "masked_fill_ only supports a 0-dimensional value tensor, but got tensor "
+      "with ", value.dim(), " dimension(s).");
+  masked_fill_impl_cuda(self, mask, value.item());
+  namedinference::propagate_names_if_nonempty(self, maybe_outnames);
+  return self;
+}
+
+template <typename scalar_t, typename mask_t>
+void masked_scatter_kernel(TensorIterator& iter, const scalar_t* source) {
+  gpu_kernel(iter, [source]GPU_LAMBDA(scalar_t self, mask_t mask, int64_t count) -> scalar_t {
+    if (mask) {
+      return source[count - 1];
+    }
+    return self;
+  });
+}
+
+Tensor & masked_scatter__cuda(Tensor& self, const Tensor& mask, const Tensor& source) {
+  NoNamesGuard guard;
+  at::assert_no_internal_overlap(self);
+  TORCH_CHECK(self.scalar_type() == source.scalar_type(), "masked_scatter_: expected self and source to have the same "
+              "dtype, but got ", self.scalar_type(), " and ", source.scalar_type());
+  TORCH_CHECK(self.device() == mask.device() && self.device() == source.device(),
+              "masked_scatter_: expected self, mask and source to be on the same device");
+  TORCH_CHECK(mask.scalar_type() == ScalarType::Byte || mask.scalar_type() == ScalarType::Bool,
+              "masked_scatter_: expected BoolTensor or ByteTensor for mask");
+  Tensor b_mask;
+  std::tie(b_mask) = expand_inplace(self, mask, "masked_scatter_");
+  if (b_mask.dtype() == ScalarType::Byte) {
+    TORCH_WARN("masked_scatter_ received a mask with dtype torch.uint8, this behavior is now deprecated," \
+            "please use a mask with dtype torch.bool instead.");
+  }
+  if (self.numel() == 0) {
+    return self;
+  }
+
+  // The selected elements of self take the elements of source in order, so
+  // an element takes the one at the number of selected elements up to it,
+  // counting in the row-major order of self.
+  auto counts = at::cumsum(b_mask.contiguous().view(-1), 0, ScalarType::Long);
+  const auto num_selected = counts[-1].item<int64_t>();
+  TORCH_CHECK(num_selected <= source.numel(), "masked_scatter_: expected source to have at least ", num_selected,
+              " elements, but got ", source.numel());
+  const auto source_contig = source.contiguous();
+
+  auto iter = TensorIteratorConfig()
+    .check_all_same_dtype(false)
+    .resize_outputs(false)
+    .add_output(self)
+    .add_input(self)
+    .add_input(b_mask)
+    .add_input(counts.view(b_mask.sizes()))
+    .build();
+
+  AT_DISPATCH_ALL_TYPES_AND_COMPLEX_AND3(at::ScalarType::Bool, at::ScalarType::Half, at::ScalarType::BFloat16, self.scalar_type(), "masked_scatter_", [&] {
+    if (b_mask.dtype() == ScalarType::Byte) {
+      masked_scatter_kernel<scalar_t, uint8_t>(iter, source_contig.data_ptr<scalar_t>());
+    } else {
+      masked_scatter_kernel<scalar_t, bool>(iter, source_contig.data_ptr<scalar_t>());
+    }
+  });
+  return self;
+}
+
 REGISTER_DISPATCH(index_stub, &index_kernel);
 REGISTER_DISPATCH(index_put_stub, &index_put_kernel);
 
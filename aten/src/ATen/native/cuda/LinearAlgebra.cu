@@ -1,6 +1,7 @@
 #include <ATen/ATen.h>
 #include <ATen/LegacyTHFunctionsCUDA.h>
 #include <ATen/NamedTensorUtils.h>
+#include <ATen/AccumulateType.h>
 #include <ATen/cuda/CUDABlas.h>
 
 namespace at { namespace native {
@@ -52,7 +53,33 @@ Tensor prepare_matrix_for_cublas(Tensor& tensor, bool& transpose_tensor) {
 
 namespace {
 
-Tensor& addmm_out_cuda_impl(Tensor& result, const Tensor& self, const Tensor& mat1, const Tensor& mat2, Scalar beta, Scalar alpha) {
+enum class Activation {
+  None,
+  RELU,
+  GELU,
+};
+
+// Whether the bias self, broadcast over the rows of the result, and the
+// activation can be applied in the epilogue of a cuBLASLt GEMM. As the bias
+// is applied along the first dimension of the column major result, result
+// must be row major, i.e. transposed for cuBLAS.
+bool use_gemm_and_bias(const Tensor& result, const Tensor& self, const Tensor& mat1, const Tensor& mat2, Scalar beta) {
+#if CUDABLAS_LT_ENABLED()
+  at::ScalarType scalar_type = self.scalar_type();
+  return &result != &self && beta.toComplexDouble() == 1.0 &&
+      self.dim() == 1 && self.size(0) == mat2.size(1) && self.is_contiguous() &&
+      result.is_contiguous() && mat1.size(0) > 1 && mat2.size(1) > 1 &&
+      mat1.size(1) > 0 &&
+      (scalar_type == at::ScalarType::Double ||
+       scalar_type == at::ScalarType::Float ||
+       scalar_type == at::ScalarType::Half ||
+       scalar_type == at::ScalarType::BFloat16);
+#else
+  return false;
+#endif
+}
+
+Tensor& addmm_out_cuda_impl(Tensor& result, const Tensor& self, const Tensor& mat1, const Tensor& mat2, Scalar beta, Scalar alpha, Activation activation = Activation::None) {
   TORCH_CHECK(mat1.dim() == 2 && mat2.dim() == 2, "tensors must be 2-D");
 
   Tensor self_;
@@ -71,9 +98,10 @@ Tensor& addmm_out_cuda_impl(Tensor& result, const Tensor& self, const Tensor& ma
 
   if (&result != &self) {
     at::native::resize_as_(result, self_);
-    if (beta.to<double>() != 0.0) {
-      at::native::copy_(result, self_);
-    }
+  }
+  bool gemm_and_bias = use_gemm_and_bias(result, self, mat1, mat2, beta);
+  if (&result != &self && !gemm_and_bias && beta.to<double>() != 0.0) {
+    at::native::copy_(result, self_);
   }
 
   TORCH_CHECK(result.dim() == 2 && self_.dim() == 2, "tensors must be 2-D");
@@ -83,6 +111,50 @@ Tensor& addmm_out_cuda_impl(Tensor& result, const Tensor& self, const Tensor& ma
     return result;
   }
 
+#if CUDABLAS_LT_ENABLED()
+  if (gemm_and_bias) {
+    // result is contiguous, so it is transposed for cuBLAS: compute
+    // result^T = mat2^T * mat1^T + self, with self along its columns.
+    bool transpose_mat1;
+    bool transpose_mat2;
+    Tensor mat1_ = mat2;
+    Tensor mat2_ = mat1;
+    mat1_ = prepare_matrix_for_cublas(mat1_, transpose_mat1);
+    mat2_ = prepare_matrix_for_cublas(mat2_, transpose_mat2);
+    transpose_mat1 = !transpose_mat1;
+    transpose_mat2 = !transpose_mat2;
+    int64_t m = mat2_sizes[1];
+    int64_t k = mat1_sizes[1];
+    int64_t n = mat1_sizes[0];
+    int64_t mat1_ld = mat1_.stride(transpose_mat1 ? 1 : 0);
+    int64_t mat2_ld = mat2_.stride(transpose_mat2 ? 1 : 0);
+    int64_t result_ld = result.stride(0);
+    // cuBLASLt's GELU epilogue is the tanh approximation, while gelu is
+    // exact, so GELU is applied by its own kernel.
+    auto epilogue = activation == Activation::RELU
+        ? at::cuda::blas::GEMMAndBiasActivationEpilogue::RELU
+        : at::cuda::blas::GEMMAndBiasActivationEpilogue::None;
+
+    AT_DISPATCH_FLOATING_TYPES_AND2(at::ScalarType::Half, at::ScalarType::BFloat16, self.scalar_type(), "addmm_cuda_lt", [&] {
+      at::cuda::blas::gemm_and_bias<scalar_t>(
+        transpose_mat1,
+        transpose_mat2,
+        m, n, k,
+        alpha.to<at::acc_type<scalar_t, true>>(),
+        mat1_.data_ptr<scalar_t>(), mat1_ld,
+        mat2_.data_ptr<scalar_t>(), mat2_ld,
+        self.data_ptr<scalar_t>(),
+        result.data_ptr<scalar_t>(), result_ld,
+        epilogue
+      );
+    });
+    if (activation == Activation::GELU) {
+      result.copy_(at::gelu(result));
+    }
+    return result;
+  }
+#endif
+
   bool transpose_result;
   Tensor result_ = prepare_matrix_for_cublas(result, transpose_result);
   bool transpose_mat1;
@@ -127,6 +199,16 @@ Tensor& addmm_out_cuda_impl(Tensor& result, const Tensor& self, const Tensor& ma
   if (result.data_ptr() != result_.data_ptr()) {
     result.copy_(result_);
   }
+  switch (activation) {
+    case Activation::RELU:
+      at::relu_(result);
+      break;
+    case Activation::GELU:
+      result.copy_(at::gelu(result));
+      break;
+    default:
+      break;
+  }
   return result;
 }
 
@@ -166,6 +248,53 @@ Tensor& addmm__cuda(Tensor& self, const Tensor& mat1, const Tensor& mat2,
   return self;
 }
 
+Tensor addmm_activation_cuda(const Tensor& self, const Tensor& mat1, const Tensor& mat2,
+                             Scalar beta, Scalar alpha, bool use_gelu) {
+  Tensor result = at::empty({0}, self.options());
+  {
+    at::NoNamesGuard guard;
+    addmm_out_cuda_impl(result, self, mat1, mat2, beta, alpha,
+                        use_gelu ? Activation::GELU : Activation::RELU);
+  }
+  at::namedinference::propagate_names_for_addmm(result, mat1, mat2, self);
+  return result;
+}
+
+std::tuple<Tensor, Tensor> mm_and_bias_grad_cuda(const Tensor& grad, const Tensor& mat1) {
+  TORCH_CHECK(grad.dim() == 2 && mat1.dim() == 2, "tensors must be 2-D");
+  TORCH_CHECK(grad.size(0) == mat1.size(0), "grad dim 0 must match mat1 dim 0");
+#if CUDABLAS_LT_ENABLED()
+  at::ScalarType scalar_type = grad.scalar_type();
+  if (grad.is_contiguous() && mat1.is_contiguous() &&
+      grad.size(0) > 0 && grad.size(1) > 1 && mat1.size(1) > 1 &&
+      (scalar_type == at::ScalarType::Double ||
+       scalar_type == at::ScalarType::Float ||
+       scalar_type == at::ScalarType::Half ||
+       scalar_type == at::ScalarType::BFloat16)) {
+    // Column major, mat2_grad^T = grad^T * mat1, where the reduction of
+    // grad^T over k, the rows of grad, is the bias gradient.
+    int64_t m = grad.size(1);
+    int64_t n = mat1.size(1);
+    int64_t k = grad.size(0);
+    Tensor mat2_grad = at::empty({n, m}, grad.options());
+    Tensor bias_grad = at::empty({m}, grad.options());
+    AT_DISPATCH_FLOATING_TYPES_AND2(at::ScalarType::Half, at::ScalarType::BFloat16, scalar_type, "mm_and_bias_grad_cuda", [&] {
+      at::cuda::blas::gemm_and_bias_grad<scalar_t>(
+        false,
+        true,
+        m, n, k,
+        grad.data_ptr<scalar_t>(), m,
+        mat1.data_ptr<scalar_t>(), n,
+        mat2_grad.data_ptr<scalar_t>(), m,
+        bias_grad.data_ptr<scalar_t>()
+      );
+    });
+    return std::make_tuple(mat2_grad, bias_grad);
+  }
+#endif
+  return std::make_tuple(at::mm(mat1.t(), grad), grad.sum(0));
+}
+
 template<typename scalar_t>
 void addr_impl_ger_cuda(Tensor &out, const Tensor &self,
                         const Tensor& vec1, const Tensor& vec2,
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
+#include <tuple>
 #include <type_traits>
 #include <c10/util/Exception.h>
 #include <c10/util/TypeCast.h>
@@ -59,7 +61,7 @@ struct vectorized_load_helper {
     using arg_t = std::tuple_element_t<arg_index, args_t>;
     // `data` hold the data_ptr for tensors [output, input0, input1, ...], so we
     // need a +1 offset to get the input
-    auto ptr = reinterpret_cast<arg_t *>(self.data[arg_index + 1]) + block_work_size * idx;
+    auto ptr = reinterpret_cast<arg_t *>(self.data[arg_index + 1]) + policy_t::block_work_size * idx;
     auto args_accessor = [&args] __device__ (int thread_unroll_idx) -> arg_t & { return std::get<arg_index>(args[thread_unroll_idx]); };
     self.load_single_arg(args_accessor, ptr);
   }
@@ -150,9 +152,15 @@ namespace policies {
 
 // Assumption:
 // all tensors are contiguous, that is: stride == sizeof(type) for all tensors
-template<typename data_t, typename inp_calc_t, typename out_calc_t, typename loader_t, typename storer_t, int num_outputs = 1>
+//
+// Each thread handles `work_size_` elements; it defaults to the global
+// thread_work_size and is only raised together with vectorized<8, ...>.
+template<typename data_t, typename inp_calc_t, typename out_calc_t, typename loader_t, typename storer_t, int num_outputs = 1, int work_size_ = thread_work_size>
 struct unroll {
 
+  static constexpr int work_size = work_size_;
+  static constexpr int block_work_size = work_size * num_threads;
+
   data_t data;
   int remaining;
   inp_calc_t input_offset_calculator;
@@ -172,7 +180,7 @@ struct unroll {
     constexpr int arity = std::tuple_size<args_t>::value;
     int thread_idx = threadIdx.x;
     #pragma unroll
-    for (int i = 0; i < thread_work_size; i++) {
+    for (int i = 0; i < work_size; i++) {
       if (thread_idx >= remaining) {
         return;
       }
@@ -188,7 +196,7 @@ struct unroll {
     int thread_idx = threadIdx.x;
     scalar_t *to = reinterpret_cast<scalar_t *>(data[0]) + block_work_size * idx;
     #pragma unroll
-    for (int i = 0; i < thread_work_size; i++) {
+    for (int i = 0; i < work_size; i++) {
       if (thread_idx >= remaining) {
         return;
       }
@@ -205,11 +213,16 @@ struct unroll {
 // Note:
 // Functions in vectorized policy does not do boundary check. It assumes the whole block
 // has its job to do. So the reminders should be handled by the the caller manually.
-template <int vec_size, typename data_t>  // vec_size: number of scalars, can be 1, 2, or 4.
+// vec_size: number of scalars, can be 1, 2, 4 or 8. vec_size 8 needs a work_size_
+// of 8 as well and is meant for 1 and 2 byte types, whose vec4 loads are narrower
+// than the 128-bit loads the hardware can issue.
+template <int vec_size, typename data_t, int work_size_ = thread_work_size>
 struct vectorized {
 
-  static_assert(thread_work_size % vec_size == 0, "The workload per thread must be a multiple of vec_size");
-  static constexpr int loop_size = thread_work_size / vec_size;
+  static constexpr int work_size = work_size_;
+  static constexpr int block_work_size = work_size * num_threads;
+  static_assert(work_size % vec_size == 0, "The workload per thread must be a multiple of vec_size");
+  static constexpr int loop_size = work_size / vec_size;
 
   data_t data;
 
@@ -262,6 +275,8 @@ struct vectorized {
 template <typename data_t, typename inp_calc_t, typename out_calc_t, int num_outputs>
 struct multi_outputs_unroll : unroll<data_t, inp_calc_t, out_calc_t, LoadWithoutCast, StoreWithoutCast, num_outputs> {
 
+  using unroll<data_t, inp_calc_t, out_calc_t, LoadWithoutCast, StoreWithoutCast, num_outputs>::block_work_size;
+
   __device__ multi_outputs_unroll(data_t data, int remaining, inp_calc_t ic, out_calc_t oc):
     unroll<data_t, inp_calc_t, out_calc_t, LoadWithoutCast, StoreWithoutCast, num_outputs>(data, remaining, ic, oc, LoadWithoutCast(), StoreWithoutCast()) {}
 
@@ -286,12 +301,18 @@ struct multi_outputs_unroll : unroll<data_t, inp_calc_t, out_calc_t, LoadWithout
 // This is only used in host, but we will wrap this into some templates
 // which is C10_HOST_DEVICE, so we have to make this C10_HOST_DEVICE
 // in order to compile
-template<typename scalar_t>
+//
+// Returns 8 only when `max_vec_size` asks for it, so the existing callers,
+// whose kernels stop at vec4, keep getting at most 4.
+template<typename scalar_t, int max_vec_size = 4>
 inline C10_HOST_DEVICE int can_vectorize_up_to(char *pointer) {
   uint64_t address = reinterpret_cast<uint64_t>(pointer);
   constexpr int vec2_alignment = std::alignment_of<aligned_vector<scalar_t, 2>>::value;
   constexpr int vec4_alignment = std::alignment_of<aligned_vector<scalar_t, 4>>::value;
-  if (address % vec4_alignment == 0) {
+  constexpr int vec8_alignment = std::alignment_of<aligned_vector<scalar_t, 8>>::value;
+  if (max_vec_size >= 8 && address % vec8_alignment == 0) {
+    return 8;
+  } else if (address % vec4_alignment == 0) {
     return 4;
   } else if (address % vec2_alignment == 0) {
     return 2;
@@ -306,20 +327,33 @@ struct can_vectorize_up_to_helper {
     using arg_t = typename traits::template arg<i>::type;
     // `pointers` hold the data_ptr for tensors [output, input0, input1, ...], so we
     // need a +1 offset to get the input
-    result = std::min<int>(result, can_vectorize_up_to<arg_t>(pointers[i + 1]));
+    result = std::min<int>(result, can_vectorize_up_to<arg_t, 8>(pointers[i + 1]));
   }
 };
 
-template<typename func_t, typename array_t>
+template<typename func_t, int max_vec_size = 4, typename array_t>
 inline int can_vectorize_up_to(array_t pointers) {
   using traits = function_traits<func_t>;
   using return_t = typename traits::result_type;
   constexpr int arity = traits::arity;
-  int result = can_vectorize_up_to<return_t>(pointers[0]);
+  int result = can_vectorize_up_to<return_t, 8>(pointers[0]);
   // We need to get the type for each argument of `func_t`, this can only
   // be done at compile time.
   detail::static_unroll<can_vectorize_up_to_helper, arity>::with_args(result, pointers, traits());
-  return result;
+  return std::min<int>(result, max_vec_size);
 }
 
+// The widest operand of `func_t` in bytes, used to decide whether vec4 accesses
+// already reach 128 bits.
+template<typename func_t>
+struct max_operand_size {
+  template<typename tuple_t> struct of_tuple;
+  template<typename... Ts> struct of_tuple<std::tuple<Ts...>> {
+    static constexpr size_t value = std::max<size_t>({size_t(1), sizeof(Ts)...});
+  };
+  using traits = function_traits<func_t>;
+  static constexpr size_t value = std::max<size_t>(
+      sizeof(typename traits::result_type), of_tuple<typename traits::ArgsTuple>::value);
+};
+
 }}} // namespace at::native::memory
@@ -1,3 +1,4 @@
+#pragma once
 #include <ATen/ATen.h>
 #include <ATen/cuda/CUDAContext.h>
 #include <ATen/native/cuda/ForeachUtils.cuh>
@@ -8,8 +9,9 @@ namespace at { namespace native {
 namespace {
 
 // TensorListMetadata has to be < 4KB - the limit for kernel launch argument
-static constexpr int depth_to_max_tensors[5] = {110, 64, 48, 36, 30};
-static constexpr int depth_to_max_blocks[5] = {320, 320, 320, 320, 320};
+static constexpr int depth_to_max_tensors[6] = {110, 64, 48, 36, 30, 24};
+static constexpr int depth_to_max_blocks[6] = {320, 320, 320, 320, 320, 320};
+static constexpr int depth_to_max_tensors_scalarlist[6] = {96, 64, 48, 36, 30, 24};
 
 template<int n> struct TensorListMetadata
 {
@@ -17,6 +19,19 @@ template<int n> struct TensorListMetadata
   int sizes[depth_to_max_tensors[n-1]];
   unsigned char block_to_tensor[depth_to_max_blocks[n-1]];
   int block_to_chunk[depth_to_max_blocks[n-1]];
+  // index in the tensor lists of the tensor in slot 0
+  int start_tensor_this_launch;
+};
+
+// Like TensorListMetadata, with a scalar for each tensor
+template<typename scalar_vals_t, int n> struct TensorListScalarListMetadata
+{
+  void* addresses[n][depth_to_max_tensors_scalarlist[n-1]];
+  int sizes[depth_to_max_tensors_scalarlist[n-1]];
+  scalar_vals_t scalar_vals[depth_to_max_tensors_scalarlist[n-1]];
+  unsigned char block_to_tensor[depth_to_max_blocks[n-1]];
+  int block_to_chunk[depth_to_max_blocks[n-1]];
+  int start_tensor_this_launch;
 };
 
 template<typename T, typename U, typename... ArgTypes>
@@ -30,60 +45,126 @@ multi_tensor_apply_kernel(
   callable(kChunkSize, tensorListMeta, args...); 
 }
 
-template<int depth, typename T, typename... ArgTypes>
-void multi_tensor_apply(
+// Splits the tensors of tensor_lists into chunks of kChunkSize elements and
+// launches one block per chunk, as many chunks per launch as the metadata
+// holds. tensor_lists[d][t] is the d-th argument of the functor for tensor
+// t; all tensors of one t must have the same number of elements.
+//
+// Fills the tensor slots of meta, calling set_extras(meta, slot, t) for each
+// new slot and move_slot(meta, from, to) when a tensor that is only partially
+// processed moves to slot 0 for the next launch.
+template<int depth, int max_tensors, typename Meta, typename SetExtras, typename MoveSlot,
+         typename T, typename... ArgTypes>
+void multi_tensor_apply_impl(
     std::vector<std::vector<at::Tensor>>& tensor_lists,
+    Meta& tensorListMeta,
+    SetExtras set_extras,
+    MoveSlot move_slot,
     T callable,
     ArgTypes... args) {
         TORCH_CHECK(tensor_lists.size() == depth, "Number of tensor lists has to match the depth.");
         const cuda::OptionalCUDAGuard device_guard(device_of(tensor_lists[0][0]));
 
-        size_t n_tensors = tensor_lists[0].size();
-        TensorListMetadata<depth> tensorListMeta;
+        const size_t n_tensors = tensor_lists[0].size();
+        const int max_blocks = depth_to_max_blocks[depth-1];
+
+        auto launch = [&](int n_blocks) {
+            multi_tensor_apply_kernel<<<n_blocks, kBlockSize, 0, at::cuda::getCurrentCUDAStream()>>>(
+                tensorListMeta,
+                callable,
+                args...);
+            AT_CUDA_CHECK(cudaGetLastError());
+        };
 
         int loc_block_info = 0;
         int loc_tensor_info = 0;
+        tensorListMeta.start_tensor_this_launch = 0;
         for(size_t t = 0; t < n_tensors; t++) {
+            if (loc_tensor_info == max_tensors) {
+                // no slot left for this tensor
+                if (loc_block_info > 0) {
+                    launch(loc_block_info);
+                }
+                loc_block_info = 0;
+                loc_tensor_info = 0;
+                tensorListMeta.start_tensor_this_launch = t;
+            }
+
             tensorListMeta.sizes[loc_tensor_info] = tensor_lists[0][t].numel();
             for (int d = 0; d < depth; d++) {
                 tensorListMeta.addresses[d][loc_tensor_info] = tensor_lists[d][t].data_ptr();
             }
+            set_extras(tensorListMeta, loc_tensor_info, t);
             loc_tensor_info++;
 
-            int chunks = (tensor_lists[0][t].numel() + kChunkSize - 1)/kChunkSize;
+            const int chunks = (tensor_lists[0][t].numel() + kChunkSize - 1)/kChunkSize;
             for (int chunk = 0; chunk < chunks; chunk++) {
                 tensorListMeta.block_to_tensor[loc_block_info] = loc_tensor_info - 1;
                 tensorListMeta.block_to_chunk[loc_block_info] = chunk;
                 loc_block_info++;
 
-                bool tensors_full = (loc_tensor_info == depth_to_max_tensors[depth-1] &&
-                    chunk == chunks - 1);
-                bool blocks_full = (loc_block_info == depth_to_max_blocks[depth-1]);
-                bool last_chunk = (t == n_tensors - 1 && chunk == chunks - 1);
-
-                if (tensors_full || blocks_full || last_chunk) {
-                    multi_tensor_apply_kernel<<<loc_block_info, kBlockSize, 0, at::cuda::getCurrentCUDAStream()>>>(
-                        tensorListMeta,
-                        callable,
-                        args...);
-
-                    AT_CUDA_CHECK(cudaGetLastError());
+                if (loc_block_info == max_blocks) {
+                    launch(loc_block_info);
 
                     // Reset.
                     loc_block_info = 0;
-                    if(chunk == chunks - 1) {
-                        loc_tensor_info = 0; 
-                    }
-                    else {
+                    if (chunk == chunks - 1) {
+                        loc_tensor_info = 0;
+                        tensorListMeta.start_tensor_this_launch = t + 1;
+                    } else {
                         tensorListMeta.sizes[0] = tensorListMeta.sizes[loc_tensor_info-1];
-                        for(int d = 0; d < depth; d++) {
+                        for (int d = 0; d < depth; d++) {
                             tensorListMeta.addresses[d][0] = tensorListMeta.addresses[d][loc_tensor_info-1];
                         }
+                        move_slot(tensorListMeta, loc_tensor_info - 1, 0);
                         loc_tensor_info = 1;
+                        tensorListMeta.start_tensor_this_launch = t;
                     }
                 }
             }
         }
+
+        if (loc_block_info > 0) {
+            launch(loc_block_info);
+        }
+    }
+
+template<int depth, typename T, typename... ArgTypes>
+void multi_tensor_apply(
+    std::vector<std::vector<at::Tensor>>& tensor_lists,
+    T callable,
+    ArgTypes... args) {
+        TensorListMetadata<depth> tensorListMeta;
+        multi_tensor_apply_impl<depth, depth_to_max_tensors[depth-1]>(
+            tensor_lists,
+            tensorListMeta,
+            [](TensorListMetadata<depth>&, int, size_t) {},
+            [](TensorListMetadata<depth>&, int, int) {},
+            callable,
+            args...);
+    }
+
+// Like multi_tensor_apply, but also passes scalars[t], converted to
+// scalar_vals_t, to the functor as tl.scalar_vals[slot] for tensor t.
+template<int depth, typename scalar_vals_t, typename T, typename... ArgTypes>
+void multi_tensor_apply(
+    std::vector<std::vector<at::Tensor>>& tensor_lists,
+    at::ArrayRef<double> scalars,
+    T callable,
+    ArgTypes... args) {
+        TORCH_CHECK(scalars.size() == tensor_lists[0].size(), "Number of scalars has to match the number of tensors.");
+        TensorListScalarListMetadata<scalar_vals_t, depth> tensorListMeta;
+        multi_tensor_apply_impl<depth, depth_to_max_tensors_scalarlist[depth-1]>(
+            tensor_lists,
+            tensorListMeta,
+            [&](TensorListScalarListMetadata<scalar_vals_t, depth>& meta, int slot, size_t t) {
+                meta.scalar_vals[slot] = static_cast<scalar_vals_t>(scalars[t]);
+            },
+            [](TensorListScalarListMetadata<scalar_vals_t, depth>& meta, int from, int to) {
+                meta.scalar_vals[to] = meta.scalar_vals[from];
+            },
+            callable,
+            args...);
     }
 } // namespace
 }} // at::native
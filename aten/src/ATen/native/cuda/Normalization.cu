@@ -31,7 +31,7 @@ std::tuple<Tensor&, Tensor&, Tensor&> batch_norm_cuda_out(Tensor& output, Tensor
 
 std::tuple<Tensor, Tensor, Tensor> batch_norm_cuda(const Tensor& self, const Tensor& weight, const Tensor& bias,
                                                    const Tensor& running_mean, const Tensor& running_var, bool train, double momentum, double epsilon) {
-  auto output = at::empty_like(self, at::MemoryFormat::Contiguous);
+  auto output = at::empty_like(self, batch_norm_use_channels_last_kernels(self) ? at::MemoryFormat::ChannelsLast : at::MemoryFormat::Contiguous);
   int64_t n_input = self.size(1);
   auto input_options = self.options();
   // Accumulate in higher precision if input is half/bfloat16
@@ -8,6 +8,7 @@
 #include <ATen/cuda/CUDAApplyUtils.cuh>
 #include <ATen/native/cuda/DeviceSqrt.cuh>
 #include <ATen/native/cuda/LaunchUtils.h>
+#include <ATen/native/cuda/MemoryAccess.cuh>
 #include <c10/macros/Macros.h>
 
 namespace at { namespace native {
@@ -499,6 +500,274 @@ __global__ void batch_norm_backward_elemt_kernel(
   }
 }
 
+// The channels-last kernels view a 4-D channels-last input as a
+// (reduction_size, stride) matrix, with reduction_size = N * H * W rows of
+// stride = C channels. The threads of a warp take consecutive channels of a
+// row, rather than the strided accesses of the kernels above; the reductions
+// split the rows between the blocks of a grid column, each of which writes
+// the partial results of its rows to a staging buffer that a second kernel
+// combines per channel.
+inline bool batch_norm_use_channels_last_kernels(const Tensor& self) {
+  return self.dim() == 4 && self.numel() > 0 && !self.is_contiguous() &&
+      self.is_contiguous(at::MemoryFormat::ChannelsLast);
+}
+
+template <typename T>
+__device__ __forceinline__ void welford_merge(T& avg, T& var_n, int& n, T o_avg, T o_var_n, int o_n) {
+  T factor = 1.0 / fmaxf(1.0, n + o_n);
+  var_n += o_var_n + (avg - o_avg) * (avg - o_avg) * n * o_n * factor;
+  avg = (n * avg + o_n * o_avg) * factor;
+  n += o_n;
+}
+
+template <typename input_scalar_t, typename stat_accscalar_t, typename index_t>
+__global__ void batch_norm_collect_statistics_channels_last_kernel(
+    const input_scalar_t* __restrict__ input,
+    stat_accscalar_t* __restrict__ staging_avg,
+    stat_accscalar_t* __restrict__ staging_var_n,
+    int* __restrict__ staging_n,
+    const index_t reduction_size,
+    const index_t stride) {
+  // blockDim.x * blockDim.y (avg, var_n, n) triplets
+  extern __shared__ char shared_buf[];
+  stat_accscalar_t* shared_avg = reinterpret_cast<stat_accscalar_t*>(shared_buf);
+  stat_accscalar_t* shared_var_n = shared_avg + blockDim.x * blockDim.y;
+  int* shared_n = reinterpret_cast<int*>(shared_var_n + blockDim.x * blockDim.y);
+
+  const index_t c = blockIdx.x * blockDim.x + threadIdx.x;
+  const int tid = threadIdx.y * blockDim.x + threadIdx.x;
+
+  // Welford over the rows of the thread, see batch_norm_collect_statistics_kernel
+  stat_accscalar_t avg = 0;
+  stat_accscalar_t var_n = 0;
+  int n = 0;
+  if (c < stride) {
+    for (index_t row = blockIdx.y * blockDim.y + threadIdx.y; row < reduction_size;
+         row += gridDim.y * blockDim.y) {
+      stat_accscalar_t v = input[row * stride + c];
+      stat_accscalar_t d1 = v - avg;
+      n++;
+      avg += d1 / n;
+      var_n += d1 * (v - avg);
+    }
+  }
+
+  // then across the rows of the block, blockDim.y being a power of 2
+  for (int offset = blockDim.y / 2; offset > 0; offset >>= 1) {
+    if (threadIdx.y >= offset && threadIdx.y < 2 * offset) {
+      shared_avg[tid] = avg;
+      shared_var_n[tid] = var_n;
+      shared_n[tid] = n;
+    }
+    __syncthreads();
+    if (threadIdx.y < offset) {
+      const int o_tid = tid + offset * blockDim.x;
+      welford_merge(avg, var_n, n, shared_avg[o_tid], shared_var_n[o_tid], shared_n[o_tid]);
+    }
+    __syncthreads();
+  }
+
+  if (threadIdx.y == 0 && c < stride) {
+    staging_avg[blockIdx.y * stride + c] = avg;
+    staging_var_n[blockIdx.y * stride + c] = var_n;
+    staging_n[blockIdx.y * stride + c] = n;
+  }
+}
+
+template <typename stat_scalar_t, typename stat_accscalar_t, typename index_t>
+__global__ void batch_norm_reduce_statistics_channels_last_kernel(
+    const stat_accscalar_t* __restrict__ staging_avg,
+    const stat_accscalar_t* __restrict__ staging_var_n,
+    const int* __restrict__ staging_n,
+    const int num_partials,
+    const index_t stride,
+    const stat_accscalar_t epsilon,
+    const stat_accscalar_t momentum,
+    stat_scalar_t* __restrict__ running_mean,
+    stat_scalar_t* __restrict__ running_var,
+    stat_accscalar_t* __restrict__ save_mean,
+    stat_accscalar_t* __restrict__ save_invstd) {
+  const index_t c = blockIdx.x * blockDim.x + threadIdx.x;
+  if (c >= stride) {
+    return;
+  }
+
+  stat_accscalar_t avg = 0;
+  stat_accscalar_t var_n = 0;
+  int n = 0;
+  for (int i = 0; i < num_partials; ++i) {
+    welford_merge(avg, var_n, n, staging_avg[i * stride + c], staging_var_n[i * stride + c], staging_n[i * stride + c]);
+  }
+
+  save_mean[c] = avg;
+  save_invstd[c] = InvStd<stat_accscalar_t>{}(var_n / n, epsilon);
+  if (running_mean != nullptr) {
+    running_mean[c] = static_cast<stat_scalar_t>((1 - momentum) * running_mean[c] + momentum * avg);
+  }
+  if (running_var != nullptr) {
+    stat_accscalar_t unbiasedVar = var_n / (n - 1);
+    running_var[c] = static_cast<stat_scalar_t>((1 - momentum) * running_var[c] + momentum * unbiasedVar);
+  }
+}
+
+template <typename input_scalar_t, typename stat_scalar_t, typename stat_accscalar_t, bool train, typename index_t, int vec_size>
+__global__ void batch_norm_transform_input_channels_last_kernel(
+    const input_scalar_t* __restrict__ input,
+    input_scalar_t* __restrict__ output,
+    const typename std::conditional<train, stat_accscalar_t, stat_scalar_t>::type* __restrict__ mean_,
+    const typename std::conditional<train, stat_accscalar_t, stat_scalar_t>::type* __restrict__ var_or_invstd,
+    const stat_scalar_t* __restrict__ weight,
+    const stat_scalar_t* __restrict__ bias,
+    const stat_accscalar_t epsilon,
+    const index_t reduction_size,
+    const index_t stride) {
+  using vec_t = memory::aligned_vector<input_scalar_t, vec_size>;
+
+  const index_t numel = reduction_size * stride;
+  const index_t step = static_cast<index_t>(gridDim.x) * blockDim.x * vec_size;
+  for (index_t index = (static_cast<index_t>(blockIdx.x) * blockDim.x + threadIdx.x) * vec_size;
+       index < numel; index += step) {
+    const index_t c = index % stride;
+    const vec_t in = *reinterpret_cast<const vec_t*>(input + index);
+    vec_t out;
+#pragma unroll
+    for (int i = 0; i < vec_size; i++) {
+      stat_accscalar_t gamma = weight != nullptr ? static_cast<stat_accscalar_t>(weight[c + i]) : static_cast<stat_accscalar_t>(1);
+      stat_accscalar_t beta = bias != nullptr ? static_cast<stat_accscalar_t>(bias[c + i]) : static_cast<stat_accscalar_t>(0);
+      stat_accscalar_t mean = static_cast<stat_accscalar_t>(mean_[c + i]);
+      stat_accscalar_t invstd;
+      if (train) {
+        invstd = var_or_invstd[c + i];
+      } else {
+        invstd = static_cast<stat_accscalar_t>(1) / device_sqrt(static_cast<stat_accscalar_t>(var_or_invstd[c + i]) + epsilon);
+      }
+      out.val[i] = static_cast<input_scalar_t>(gamma * (in.val[i] - mean) * invstd + beta);
+    }
+    *reinterpret_cast<vec_t*>(output + index) = out;
+  }
+}
+
+template <typename input_scalar_t, typename stat_accscalar_t, typename index_t>
+__global__ void batch_norm_backward_reduce_channels_last_kernel(
+    const input_scalar_t* __restrict__ input,
+    const input_scalar_t* __restrict__ grad_output,
+    const stat_accscalar_t* __restrict__ mean,
+    stat_accscalar_t* __restrict__ staging_sum_dy,
+    stat_accscalar_t* __restrict__ staging_sum_dy_xmu,
+    const index_t reduction_size,
+    const index_t stride) {
+  // blockDim.x * blockDim.y (sum_dy, sum_dy_xmu) pairs
+  extern __shared__ char shared_buf[];
+  stat_accscalar_t* shared_sum_dy = reinterpret_cast<stat_accscalar_t*>(shared_buf);
+  stat_accscalar_t* shared_sum_dy_xmu = shared_sum_dy + blockDim.x * blockDim.y;
+
+  const index_t c = blockIdx.x * blockDim.x + threadIdx.x;
+  const int tid = threadIdx.y * blockDim.x + threadIdx.x;
+
+  // Sum(grad_output) and DotProduct(input - mean, grad_output) over the rows
+  // of the thread, then across the rows of the block
+  stat_accscalar_t sum_dy = 0;
+  stat_accscalar_t sum_dy_xmu = 0;
+  if (c < stride) {
+    const stat_accscalar_t m_c = mean[c];
+    for (index_t row = blockIdx.y * blockDim.y + threadIdx.y; row < reduction_size;
+         row += gridDim.y * blockDim.y) {
+      const stat_accscalar_t dy = grad_output[row * stride + c];
+      sum_dy += dy;
+      sum_dy_xmu += dy * (static_cast<stat_accscalar_t>(input[row * stride + c]) - m_c);
+    }
+  }
+  shared_sum_dy[tid] = sum_dy;
+  shared_sum_dy_xmu[tid] = sum_dy_xmu;
+  __syncthreads();
+  for (int offset = blockDim.y / 2; offset > 0; offset >>= 1) {
+    if (threadIdx.y < offset) {
+      shared_sum_dy[tid] += shared_sum_dy[tid + offset * blockDim.x];
+      shared_sum_dy_xmu[tid] += shared_sum_dy_xmu[tid + offset * blockDim.x];
+    }
+    __syncthreads();
+  }
+
+  if (threadIdx.y == 0 && c < stride) {
+    staging_sum_dy[blockIdx.y * stride + c] = shared_sum_dy[tid];
+    staging_sum_dy_xmu[blockIdx.y * stride + c] = shared_sum_dy_xmu[tid];
+  }
+}
+
+// Combines the partial sums, into the gradients of the weight and the bias and
+// into the terms of batch_norm_backward_elemt_channels_last_kernel, which are
+// 0 in evaluation mode, where the statistics don't depend on the input.
+template <typename stat_scalar_t, typename stat_accscalar_t, typename index_t>
+__global__ void batch_norm_backward_reduce_statistics_channels_last_kernel(
+    const stat_accscalar_t* __restrict__ staging_sum_dy,
+    const stat_accscalar_t* __restrict__ staging_sum_dy_xmu,
+    const int num_partials,
+    const index_t reduction_size,
+    const index_t stride,
+    const stat_accscalar_t* __restrict__ invstd,
+    const bool train,
+    stat_accscalar_t* __restrict__ mean_dy,
+    stat_accscalar_t* __restrict__ mean_dy_xmu,
+    stat_scalar_t* __restrict__ grad_weight,
+    stat_scalar_t* __restrict__ grad_bias) {
+  const index_t c = blockIdx.x * blockDim.x + threadIdx.x;
+  if (c >= stride) {
+    return;
+  }
+
+  stat_accscalar_t sum_dy = 0;
+  stat_accscalar_t sum_dy_xmu = 0;
+  for (int i = 0; i < num_partials; ++i) {
+    sum_dy += staging_sum_dy[i * stride + c];
+    sum_dy_xmu += staging_sum_dy_xmu[i * stride + c];
+  }
+
+  if (grad_weight != nullptr) {
+    grad_weight[c] = static_cast<stat_scalar_t>(sum_dy_xmu * invstd[c]);
+  }
+  if (grad_bias != nullptr) {
+    grad_bias[c] = static_cast<stat_scalar_t>(sum_dy);
+  }
+  stat_accscalar_t norm = stat_accscalar_t(1) / reduction_size;
+  mean_dy[c] = train ? sum_dy * norm : stat_accscalar_t(0);
+  mean_dy_xmu[c] = train ? sum_dy_xmu * norm : stat_accscalar_t(0);
+}
+
+template <typename input_scalar_t, typename stat_scalar_t, typename stat_accscalar_t, typename index_t, int vec_size>
+__global__ void batch_norm_backward_elemt_channels_last_kernel(
+    const input_scalar_t* __restrict__ input,
+    const input_scalar_t* __restrict__ grad_output,
+    const stat_accscalar_t* __restrict__ mean,
+    const stat_accscalar_t* __restrict__ invstd,
+    const stat_scalar_t* __restrict__ weight,
+    const stat_accscalar_t* __restrict__ mean_dy,
+    const stat_accscalar_t* __restrict__ mean_dy_xmu,
+    input_scalar_t* __restrict__ grad_input,
+    const index_t reduction_size,
+    const index_t stride) {
+  using vec_t = memory::aligned_vector<input_scalar_t, vec_size>;
+
+  const index_t numel = reduction_size * stride;
+  const index_t step = static_cast<index_t>(gridDim.x) * blockDim.x * vec_size;
+  for (index_t index = (static_cast<index_t>(blockIdx.x) * blockDim.x + threadIdx.x) * vec_size;
+       index < numel; index += step) {
+    const index_t c = index % stride;
+    const vec_t g_o = *reinterpret_cast<const vec_t*>(grad_output + index);
+    const vec_t in = *reinterpret_cast<const vec_t*>(input + index);
+    vec_t g_i;
+#pragma unroll
+    for (int i = 0; i < vec_size; i++) {
+      stat_accscalar_t factor_1_c = invstd[c + i];
+      stat_accscalar_t factor_2_c = weight != nullptr ? static_cast<stat_accscalar_t>(weight[c + i]) : stat_accscalar_t(1);
+      factor_2_c *= factor_1_c;
+      factor_1_c = factor_1_c * factor_1_c * mean_dy_xmu[c + i];
+      g_i.val[i] = static_cast<input_scalar_t>(
+          (g_o.val[i] - mean_dy[c + i] - (in.val[i] - mean[c + i]) * factor_1_c) * factor_2_c);
+    }
+    *reinterpret_cast<vec_t*>(grad_input + index) = g_i;
+  }
+}
+
 template <typename scalar_t, int64_t dim, template <typename U> class PtrTraits = DefaultPtrTraits, typename index_t = int64_t>
 static GenericPackedTensorAccessor<scalar_t, dim, PtrTraits, index_t> packed_accessor_or_dummy(const Tensor& t) {
   if (! t.defined()) {
@@ -508,6 +777,179 @@ static GenericPackedTensorAccessor<scalar_t, dim, PtrTraits, index_t> packed_acc
   return t.generic_packed_accessor<scalar_t, dim, PtrTraits, index_t>();
 }
 
+// The launch configuration of the channels-last reductions: warp-wide tiles
+// of channels, with enough blocks along the rows to fill the device.
+static void batch_norm_channels_last_reduction_config(int64_t reduction_size, int64_t stride, dim3& block, dim3& grid) {
+  block.x = std::min<int>(lastPow2(stride), C10_WARP_SIZE);
+  block.y = MAX_BLOCK_SIZE / block.x;
+  block.z = 1;
+  grid.x = cuda::ATenCeilDiv<int64_t>(stride, block.x);
+  const int64_t max_grid_y = std::max<int64_t>(
+      1, 4 * at::cuda::getCurrentDeviceProperties()->multiProcessorCount / grid.x);
+  // at least 4 rows per thread
+  grid.y = std::min<int64_t>(
+      std::min<int64_t>(cuda::ATenCeilDiv<int64_t>(reduction_size, block.y * 4), max_grid_y), 65535);
+  grid.z = 1;
+}
+
+static dim3 batch_norm_channels_last_elementwise_grid(int64_t numel, int vec_size) {
+  return dim3(std::min<int64_t>(
+      cuda::ATenCeilDiv<int64_t>(numel / vec_size, MAX_BLOCK_SIZE),
+      at::cuda::getCurrentDeviceProperties()->maxGridSize[0]));
+}
+
+// The elementwise channels-last kernels access 4 channels at a time when the
+// channels and the alignment of the tensors allow it.
+template <typename scalar_t>
+static int batch_norm_channels_last_vec_size(int64_t stride, std::initializer_list<const Tensor*> tensors) {
+  if (stride % 4 != 0) {
+    return 1;
+  }
+  for (const Tensor* t : tensors) {
+    if (memory::can_vectorize_up_to<scalar_t>(static_cast<char*>(t->data_ptr())) < 4) {
+      return 1;
+    }
+  }
+  return 4;
+}
+
+template<typename input_scalar_t, typename stat_scalar_t, typename index_t>
+void batch_norm_cuda_channels_last_template(Tensor& output_, Tensor& save_mean_, Tensor& save_invstd_, const Tensor& input_, const Tensor& weight_, const Tensor& bias_,
+                                            const Tensor& running_mean_, const Tensor& running_var_,
+                                            bool train, double momentum, double epsilon) {
+  using stat_accscalar_t = at::acc_type<stat_scalar_t, true>;
+  const index_t stride = input_.size(1);
+  const index_t reduction_size = input_.numel() / stride;
+  auto input_options = input_.options();
+  if (input_.scalar_type() == at::ScalarType::Half || input_.scalar_type() == at::ScalarType::BFloat16) {
+    input_options = input_options.dtype(ScalarType::Float);
+  }
+  const input_scalar_t* input = input_.data_ptr<input_scalar_t>();
+  input_scalar_t* output = output_.data_ptr<input_scalar_t>();
+  const stat_scalar_t* weight = weight_.defined() ? weight_.data_ptr<stat_scalar_t>() : nullptr;
+  const stat_scalar_t* bias = bias_.defined() ? bias_.data_ptr<stat_scalar_t>() : nullptr;
+  stat_scalar_t* running_mean = running_mean_.defined() ? running_mean_.data_ptr<stat_scalar_t>() : nullptr;
+  stat_scalar_t* running_var = running_var_.defined() ? running_var_.data_ptr<stat_scalar_t>() : nullptr;
+  auto stream = at::cuda::getCurrentCUDAStream();
+
+  const int vec_size = batch_norm_channels_last_vec_size<input_scalar_t>(stride, {&input_, &output_});
+  const dim3 blocks_trans = batch_norm_channels_last_elementwise_grid(input_.numel(), vec_size);
+  const dim3 threads_trans(MAX_BLOCK_SIZE);
+  if (!train) {
+    if (vec_size == 4) {
+      batch_norm_transform_input_channels_last_kernel<input_scalar_t, stat_scalar_t, stat_accscalar_t, false, index_t, 4> <<<blocks_trans, threads_trans, 0, stream>>>
+        (input, output, running_mean, running_var, weight, bias, epsilon, reduction_size, stride);
+    } else {
+      batch_norm_transform_input_channels_last_kernel<input_scalar_t, stat_scalar_t, stat_accscalar_t, false, index_t, 1> <<<blocks_trans, threads_trans, 0, stream>>>
+        (input, output, running_mean, running_var, weight, bias, epsilon, reduction_size, stride);
+    }
+  } else {
+    dim3 block, grid;
+    batch_norm_channels_last_reduction_config(reduction_size, stride, block, grid);
+    auto staging_avg = at::empty({static_cast<int64_t>(grid.y), static_cast<int64_t>(stride)}, input_options);
+    auto staging_var_n = at::empty({static_cast<int64_t>(grid.y), static_cast<int64_t>(stride)}, input_options);
+    auto staging_n = at::empty({static_cast<int64_t>(grid.y), static_cast<int64_t>(stride)}, input_options.dtype(kInt));
+    const size_t shmem_size = block.x * block.y * (2 * sizeof(stat_accscalar_t) + sizeof(int));
+    batch_norm_collect_statistics_channels_last_kernel<input_scalar_t, stat_accscalar_t, index_t> <<<grid, block, shmem_size, stream>>>
+      (input, staging_avg.data_ptr<stat_accscalar_t>(), staging_var_n.data_ptr<stat_accscalar_t>(), staging_n.data_ptr<int>(),
+       reduction_size, stride);
+    batch_norm_reduce_statistics_channels_last_kernel<stat_scalar_t, stat_accscalar_t, index_t>
+      <<<cuda::ATenCeilDiv<int64_t>(stride, MAX_BLOCK_SIZE), MAX_BLOCK_SIZE, 0, stream>>>
+      (staging_avg.data_ptr<stat_accscalar_t>(), staging_var_n.data_ptr<stat_accscalar_t>(), staging_n.data_ptr<int>(),
+       grid.y, stride, epsilon, momentum, running_mean, running_var,
+       save_mean_.data_ptr<stat_accscalar_t>(), save_invstd_.data_ptr<stat_accscalar_t>());
+    const stat_accscalar_t* save_mean = save_mean_.data_ptr<stat_accscalar_t>();
+    const stat_accscalar_t* save_invstd = save_invstd_.data_ptr<stat_accscalar_t>();
+    if (vec_size == 4) {
+      batch_norm_transform_input_channels_last_kernel<input_scalar_t, stat_scalar_t, stat_accscalar_t, true, index_t, 4> <<<blocks_trans, threads_trans, 0, stream>>>
+        (input, output, save_mean, save_invstd, weight, bias, epsilon, reduction_size, stride);
+    } else {
+      batch_norm_transform_input_channels_last_kernel<input_scalar_t, stat_scalar_t, stat_accscalar_t, true, index_t, 1> <<<blocks_trans, threads_trans, 0, stream>>>
+        (input, output, save_mean, save_invstd, weight, bias, epsilon, reduction_size, stride);
+    }
+  }
+  AT_CUDA_CHECK(cudaGetLastError());
+}
+
+template<typename input_scalar_t, typename stat_scalar_t, typename index_t>
+std::tuple<Tensor, Tensor, Tensor> batch_norm_backward_cuda_channels_last_template(const Tensor& grad_out_, const Tensor& input_, const Tensor& weight_,
+                                                                                   const Tensor& running_mean_, const Tensor& running_var_, const Tensor& save_mean_, const Tensor& save_invstd_,
+                                                                                   bool train, double epsilon, std::array<bool,3> grad_input_mask) {
+  using accscalar_t = at::acc_type<stat_scalar_t, true>;
+  const index_t stride = input_.size(1);
+  const index_t reduction_size = input_.numel() / stride;
+  auto input_options = input_.options();
+  if (input_.scalar_type() == at::ScalarType::Half || input_.scalar_type() == at::ScalarType::BFloat16) {
+    input_options = input_options.dtype(ScalarType::Float);
+  }
+  const Tensor grad_out = grad_out_.contiguous(at::MemoryFormat::ChannelsLast);
+
+  // The statistics the input was normalized with
+  Tensor mean_, invstd_;
+  if (train) {
+    mean_ = save_mean_;
+    invstd_ = save_invstd_;
+  } else {
+    mean_ = running_mean_.to(input_options.dtype()).contiguous();
+    invstd_ = (running_var_.to(input_options.dtype()) + epsilon).rsqrt();
+  }
+
+  Tensor grad_input_;
+  Tensor grad_weight_;
+  Tensor grad_bias_;
+  if (grad_input_mask[0]) {
+    grad_input_ = at::empty_like(input_, at::MemoryFormat::ChannelsLast);
+  }
+  if (grad_input_mask[1]) {
+    grad_weight_ = at::empty_like(weight_, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  }
+  if (grad_input_mask[2]) {
+    grad_bias_ = at::empty_like(weight_, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  }
+
+  const input_scalar_t* input = input_.data_ptr<input_scalar_t>();
+  const input_scalar_t* grad_output = grad_out.data_ptr<input_scalar_t>();
+  const accscalar_t* mean = mean_.data_ptr<accscalar_t>();
+  const accscalar_t* invstd = invstd_.data_ptr<accscalar_t>();
+  auto stream = at::cuda::getCurrentCUDAStream();
+
+  dim3 block, grid;
+  batch_norm_channels_last_reduction_config(reduction_size, stride, block, grid);
+  auto staging_sum_dy = at::empty({static_cast<int64_t>(grid.y), static_cast<int64_t>(stride)}, input_options);
+  auto staging_sum_dy_xmu = at::empty({static_cast<int64_t>(grid.y), static_cast<int64_t>(stride)}, input_options);
+  auto mean_dy = at::empty({static_cast<int64_t>(stride)}, input_options);
+  auto mean_dy_xmu = at::empty({static_cast<int64_t>(stride)}, input_options);
+  const size_t shmem_size = block.x * block.y * 2 * sizeof(accscalar_t);
+  batch_norm_backward_reduce_channels_last_kernel<input_scalar_t, accscalar_t, index_t> <<<grid, block, shmem_size, stream>>>
+    (input, grad_output, mean, staging_sum_dy.data_ptr<accscalar_t>(), staging_sum_dy_xmu.data_ptr<accscalar_t>(),
+     reduction_size, stride);
+  batch_norm_backward_reduce_statistics_channels_last_kernel<stat_scalar_t, accscalar_t, index_t>
+    <<<cuda::ATenCeilDiv<int64_t>(stride, MAX_BLOCK_SIZE), MAX_BLOCK_SIZE, 0, stream>>>
+    (staging_sum_dy.data_ptr<accscalar_t>(), staging_sum_dy_xmu.data_ptr<accscalar_t>(), grid.y,
+     reduction_size, stride, invstd, train, mean_dy.data_ptr<accscalar_t>(), mean_dy_xmu.data_ptr<accscalar_t>(),
+     grad_weight_.defined() ? grad_weight_.data_ptr<stat_scalar_t>() : nullptr,
+     grad_bias_.defined() ? grad_bias_.data_ptr<stat_scalar_t>() : nullptr);
+
+  if (grad_input_.defined()) {
+    const stat_scalar_t* weight = weight_.defined() ? weight_.data_ptr<stat_scalar_t>() : nullptr;
+    input_scalar_t* grad_input = grad_input_.data_ptr<input_scalar_t>();
+    const int vec_size = batch_norm_channels_last_vec_size<input_scalar_t>(stride, {&input_, &grad_out, &grad_input_});
+    const dim3 blocks = batch_norm_channels_last_elementwise_grid(input_.numel(), vec_size);
+    if (vec_size == 4) {
+      batch_norm_backward_elemt_channels_last_kernel<input_scalar_t, stat_scalar_t, accscalar_t, index_t, 4> <<<blocks, MAX_BLOCK_SIZE, 0, stream>>>
+        (input, grad_output, mean, invstd, weight, mean_dy.data_ptr<accscalar_t>(), mean_dy_xmu.data_ptr<accscalar_t>(),
+         grad_input, reduction_size, stride);
+    } else {
+      batch_norm_backward_elemt_channels_last_kernel<input_scalar_t, stat_scalar_t, accscalar_t, index_t, 1> <<<blocks, MAX_BLOCK_SIZE, 0, stream>>>
+        (input, grad_output, mean, invstd, weight, mean_dy.data_ptr<accscalar_t>(), mean_dy_xmu.data_ptr<accscalar_t>(),
+         grad_input, reduction_size, stride);
+    }
+  }
+  AT_CUDA_CHECK(cudaGetLastError());
+
+  return std::make_tuple(grad_input_, grad_weight_, grad_bias_);
+}
+
 template<typename input_scalar_t, typename stat_scalar_t, typename index_t>
 void batch_norm_cuda_template(Tensor& output_, Tensor& save_mean_, Tensor& save_invstd_, const Tensor& input_, const Tensor& weight_, const Tensor& bias_,
                                                             const Tensor& running_mean_, const Tensor& running_var_,
@@ -524,6 +966,12 @@ void batch_norm_cuda_template(Tensor& output_, Tensor& save_mean_, Tensor& save_
   CheckedFrom c = "batch_norm_cuda";
   checkAllSameGPU(c, {output_arg, save_mean_arg, save_invstd_arg, input_arg, weight_arg, bias_arg, run_mean_arg, run_var_arg});
 
+  if (batch_norm_use_channels_last_kernels(input_) && output_.is_contiguous(at::MemoryFormat::ChannelsLast)) {
+    batch_norm_cuda_channels_last_template<input_scalar_t, stat_scalar_t, index_t>(
+      output_, save_mean_, save_invstd_, input_, weight_, bias_, running_mean_, running_var_, train, momentum, epsilon);
+    return;
+  }
+
   using stat_accscalar_t = at::acc_type<stat_scalar_t, true>;
   auto input_reshaped = input_.reshape({input_.size(0), input_.size(1), -1}); // internally we merge the feature dimensions
   auto output_reshaped = output_.view({input_.size(0), input_.size(1), -1});
@@ -577,6 +1025,11 @@ std::tuple<Tensor, Tensor, Tensor> batch_norm_backward_cuda_template(const Tenso
                                                                      const Tensor& running_mean_, const Tensor& running_var_, const Tensor& save_mean_, const Tensor& save_invstd_,
                                                                      bool train, double epsilon, std::array<bool,3> grad_input_mask) {
 
+  if (batch_norm_use_channels_last_kernels(input_)) {
+    return batch_norm_backward_cuda_channels_last_template<input_scalar_t, stat_scalar_t, index_t>(
+      grad_out_, input_, weight_, running_mean_, running_var_, save_mean_, save_invstd_, train, epsilon, grad_input_mask);
+  }
+
   using accscalar_t = at::acc_type<stat_scalar_t, true>;
   Tensor grad_input_;
   Tensor grad_input_reshaped;
@@ -0,0 +1,334 @@
+#include <ATen/ATen.h>
+#include <ATen/AccumulateType.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/TensorUtils.h>
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/Exceptions.h>
+#include <THC/THCDeviceUtils.cuh>
+#include <c10/macros/Macros.h>
+
+// Note [Persistent RNN]
+// Without cuDNN, every step of an LSTM or a GRU layer launches a GEMM of the
+// hidden state with the recurrent weights and a kernel for the gates. For
+// small batches neither fills the GPU, and the weights are read again from
+// global memory at every step. Instead, a single kernel runs all the steps of
+// a layer, the input gates of every step computed beforehand in one GEMM:
+//
+//   - every block owns a slice of the hidden units, and keeps the rows of the
+//     recurrent weights of their gates in shared memory when they fit;
+//   - a warp computes the gates of one unit of one sequence of the batch,
+//     reading the previous hidden state from the output of the last step, and
+//     updates the cell and the hidden states of that unit;
+//   - the blocks wait for each other between the steps on a barrier in global
+//     memory, which is why they must all be resident: the kernel is launched
+//     with cudaLaunchCooperativeKernel, with at most one block per SM.
+//
+// It records nothing for autograd, so the layers only use it when nothing
+// requires grad, and only when torch.backends.cuda.rnn.persistent is set.
+
+namespace at { namespace native {
+
+namespace {
+
+constexpr int kPersistentRNNThreads = 512;
+
+#ifndef __HIP_PLATFORM_HCC__
+
+template <typename T>
+__device__ __forceinline__ T device_sigmoid(T in) {
+  T one = static_cast<T>(1.0);
+  return one / (one + ::exp(-in));
+}
+
+// The hidden states written by other blocks since the last barrier must not
+// be read from the (incoherent) L1 cache.
+template <typename T>
+__device__ __forceinline__ T load_coherent(const T* ptr) {
+  return __ldcg(ptr);
+}
+
+template <>
+__device__ __forceinline__ c10::Half load_coherent(const c10::Half* ptr) {
+  return c10::Half(
+      __ldcg(reinterpret_cast<const unsigned short*>(ptr)),
+      c10::Half::from_bits());
+}
+
+// Waits until all the blocks of the grid have arrived `generation` times.
+__device__ __forceinline__ void grid_barrier(
+    unsigned int* arrived,
+    unsigned int generation) {
+  __syncthreads();
+  if (threadIdx.x == 0) {
+    __threadfence();
+    atomicAdd(arrived, 1);
+    const unsigned int expected = generation * gridDim.x;
+    while (atomicAdd(arrived, 0) < expected) {
+    }
+    __threadfence();
+  }
+  __syncthreads();
+}
+
+// NumGates is 4 for LSTM (in the order input, forget, cell, output) and 3 for
+// GRU (reset, input, new), as in the fused cells of RNN.cu. The input gates
+// include the input bias, the hidden bias is added to the hidden gates.
+template <typename scalar_t, typename accscalar_t, int NumGates>
+C10_LAUNCH_BOUNDS_1(kPersistentRNNThreads)
+__global__ void persistent_rnn_kernel(
+    const scalar_t* __restrict__ input_gates,
+    const scalar_t* __restrict__ hx,
+    const scalar_t* __restrict__ w_hh,
+    const scalar_t* __restrict__ b_hh,
+    scalar_t* output,
+    scalar_t* cy,
+    unsigned int* arrived,
+    int seq_len,
+    int batch_size,
+    int hidden_size,
+    int units_per_block,
+    bool weights_in_shared,
+    bool reverse) {
+  extern __shared__ char shared_raw[];
+  scalar_t* shared_weights = reinterpret_cast<scalar_t*>(shared_raw);
+
+  const int H = hidden_size;
+  const int first_unit = blockIdx.x * units_per_block;
+  const int units = min(units_per_block, H - first_unit);
+  const int lane = threadIdx.x % C10_WARP_SIZE;
+  const int warp = threadIdx.x / C10_WARP_SIZE;
+  const int num_warps = blockDim.x / C10_WARP_SIZE;
+
+  // The rows of the gates of the units of the block, gate after gate.
+  if (weights_in_shared) {
+    const int rows = NumGates * units;
+    for (int i = threadIdx.x; i < rows * H; i += blockDim.x) {
+      const int row = i / H;
+      const int gate = row / units;
+      const int unit = row % units;
+      shared_weights[i] = w_hh[(gate * H + first_unit + unit) * H + i % H];
+    }
+    __syncthreads();
+  }
+
+  for (int t = 0; t < seq_len; ++t) {
+    const int step = reverse ? seq_len - 1 - t : t;
+    const int prev_step = reverse ? step + 1 : step - 1;
+    const scalar_t* h_prev =
+        t == 0 ? hx : output + static_cast<int64_t>(prev_step) * batch_size * H;
+    const scalar_t* step_gates =
+        input_gates + static_cast<int64_t>(step) * batch_size * NumGates * H;
+    scalar_t* h_next = output + static_cast<int64_t>(step) * batch_size * H;
+
+    for (int pair = warp; pair < batch_size * units; pair += num_warps) {
+      const int b = pair / units;
+      const int unit = pair % units;
+      const int j = first_unit + unit;
+
+      accscalar_t acc[NumGates];
+#pragma unroll
+      for (int gate = 0; gate < NumGates; ++gate) {
+        acc[gate] = 0;
+      }
+      for (int k = lane; k < H; k += C10_WARP_SIZE) {
+        const accscalar_t h = load_coherent(h_prev + b * H + k);
+#pragma unroll
+        for (int gate = 0; gate < NumGates; ++gate) {
+          const scalar_t w = weights_in_shared
+              ? shared_weights[(gate * units + unit) * H + k]
+              : w_hh[(gate * H + j) * H + k];
+          acc[gate] += static_cast<accscalar_t>(w) * h;
+        }
+      }
+#pragma unroll
+      for (int gate = 0; gate < NumGates; ++gate) {
+        for (int offset = C10_WARP_SIZE / 2; offset > 0; offset /= 2) {
+          acc[gate] += WARP_SHFL_DOWN(acc[gate], offset);
+        }
+      }
+
+      if (lane == 0) {
+        accscalar_t hidden_gates[NumGates];
+        accscalar_t in_gates[NumGates];
+#pragma unroll
+        for (int gate = 0; gate < NumGates; ++gate) {
+          hidden_gates[gate] = acc[gate] +
+              (b_hh ? static_cast<accscalar_t>(b_hh[gate * H + j]) : accscalar_t(0));
+          in_gates[gate] = static_cast<accscalar_t>(
+              step_gates[(b * NumGates + gate) * H + j]);
+        }
+        if (NumGates == 4) {
+          const accscalar_t ig = device_sigmoid(in_gates[0] + hidden_gates[0]);
+          const accscalar_t fg = device_sigmoid(in_gates[1] + hidden_gates[1]);
+          const accscalar_t cg = ::tanh(in_gates[2] + hidden_gates[2]);
+          const accscalar_t og = device_sigmoid(in_gates[3] + hidden_gates[3]);
+          const accscalar_t c =
+              fg * static_cast<accscalar_t>(cy[b * H + j]) + ig * cg;
+          cy[b * H + j] = static_cast<scalar_t>(c);
+          h_next[b * H + j] = static_cast<scalar_t>(og * ::tanh(c));
+        } else {
+          const accscalar_t rg = device_sigmoid(in_gates[0] + hidden_gates[0]);
+          const accscalar_t ig = device_sigmoid(in_gates[1] + hidden_gates[1]);
+          const accscalar_t ng = ::tanh(in_gates[2] + rg * hidden_gates[2]);
+          const accscalar_t h =
+              static_cast<accscalar_t>(load_coherent(h_prev + b * H + j));
+          h_next[b * H + j] = static_cast<scalar_t>(ng + ig * (h - ng));
+        }
+      }
+    }
+
+    if (t + 1 < seq_len) {
+      grid_barrier(arrived, t + 1);
+    }
+  }
+}
+
+#endif // __HIP_PLATFORM_HCC__
+
+template <typename scalar_t, int NumGates>
+void persistent_rnn_impl(
+    const Tensor& input_gates,
+    const Tensor& hx,
+    const Tensor& w_hh,
+    const Tensor& b_hh,
+    const Tensor& output,
+    const Tensor& cy,
+    bool reverse) {
+#ifdef __HIP_PLATFORM_HCC__
+  TORCH_CHECK(false, "The persistent RNN kernels are not supported on ROCm");
+#else
+  using accscalar_t = acc_type<scalar_t, /*is_cuda=*/true>;
+  int seq_len = input_gates.size(0);
+  int batch_size = input_gates.size(1);
+  int hidden_size = hx.size(1);
+
+  const cudaDeviceProp* prop = at::cuda::getCurrentDeviceProperties();
+  TORCH_CHECK(
+      prop->cooperativeLaunch,
+      "The persistent RNN kernels need a device supporting cooperative launches");
+  int units_per_block =
+      (hidden_size + prop->multiProcessorCount - 1) / prop->multiProcessorCount;
+  const int num_blocks = (hidden_size + units_per_block - 1) / units_per_block;
+
+  auto kernel = &persistent_rnn_kernel<scalar_t, accscalar_t, NumGates>;
+  size_t shared_bytes = static_cast<size_t>(NumGates) * units_per_block *
+      hidden_size * sizeof(scalar_t);
+  bool weights_in_shared = shared_bytes <= prop->sharedMemPerBlockOptin;
+  if (weights_in_shared) {
+    AT_CUDA_CHECK(cudaFuncSetAttribute(
+        kernel, cudaFuncAttributeMaxDynamicSharedMemorySize, shared_bytes));
+    int blocks_per_sm = 0;
+    AT_CUDA_CHECK(cudaOccupancyMaxActiveBlocksPerMultiprocessor(
+        &blocks_per_sm, kernel, kPersistentRNNThreads, shared_bytes));
+    weights_in_shared = blocks_per_sm > 0;
+  }
+  if (!weights_in_shared) {
+    shared_bytes = 0;
+  }
+
+  auto arrived = at::zeros({1}, input_gates.options().dtype(kInt));
+  const scalar_t* input_gates_ptr = input_gates.data_ptr<scalar_t>();
+  const scalar_t* hx_ptr = hx.data_ptr<scalar_t>();
+  const scalar_t* w_hh_ptr = w_hh.data_ptr<scalar_t>();
+  const scalar_t* b_hh_ptr = b_hh.defined() ? b_hh.data_ptr<scalar_t>() : nullptr;
+  scalar_t* output_ptr = output.data_ptr<scalar_t>();
+  scalar_t* cy_ptr = cy.defined() ? cy.data_ptr<scalar_t>() : nullptr;
+  unsigned int* arrived_ptr = reinterpret_cast<unsigned int*>(arrived.data_ptr<int>());
+  void* args[] = {
+      &input_gates_ptr, &hx_ptr, &w_hh_ptr, &b_hh_ptr, &output_ptr, &cy_ptr,
+      &arrived_ptr, &seq_len, &batch_size, &hidden_size, &units_per_block,
+      &weights_in_shared, &reverse};
+  AT_CUDA_CHECK(cudaLaunchCooperativeKernel(
+      reinterpret_cast<void*>(kernel),
+      num_blocks,
+      kPersistentRNNThreads,
+      args,
+      shared_bytes,
+      at::cuda::getCurrentCUDAStream()));
+#endif
+}
+
+void check_persistent_rnn_args(
+    CheckedFrom c,
+    const TensorArg& input_gates,
+    const TensorArg& hx,
+    const TensorArg& w_hh,
+    const TensorArg& b_hh,
+    int64_t num_gates) {
+  checkDim(c, input_gates, 3);
+  checkDim(c, hx, 2);
+  const int64_t hidden_size = hx->size(1);
+  checkSize(c, input_gates, 1, hx->size(0));
+  checkSize(c, input_gates, 2, num_gates * hidden_size);
+  checkDim(c, w_hh, 2);
+  checkSize(c, w_hh, 0, num_gates * hidden_size);
+  checkSize(c, w_hh, 1, hidden_size);
+  if (b_hh->defined()) {
+    checkDim(c, b_hh, 1);
+    checkNumel(c, b_hh, num_gates * hidden_size);
+    checkAllSameType(c, {input_gates, hx, w_hh, b_hh});
+    checkAllSameGPU(c, {input_gates, hx, w_hh, b_hh});
+  } else {
+    checkAllSameType(c, {input_gates, hx, w_hh});
+    checkAllSameGPU(c, {input_gates, hx, w_hh});
+  }
+  TORCH_CHECK(
+      input_gates->numel() <= std::numeric_limits<int>::max() &&
+          w_hh->numel() <= std::numeric_limits<int>::max(),
+      c, ": the input gates or the weights are too large for 32 bit indexing");
+}
+
+} // anonymous namespace
+
+std::tuple<Tensor, Tensor, Tensor> _thnn_persistent_lstm_cuda(
+    const Tensor& input_gates_, const Tensor& hx_, const Tensor& cx_,
+    const Tensor& w_hh_, const Tensor& b_hh_, bool reverse) {
+  CheckedFrom c = "_thnn_persistent_lstm_cuda";
+  check_persistent_rnn_args(
+      c, {input_gates_, "input_gates", 1}, {hx_, "hx", 2}, {w_hh_, "w_hh", 4},
+      {b_hh_, "b_hh", 5}, /*num_gates=*/4);
+  checkSameSize(c, {hx_, "hx", 2}, {cx_, "cx", 3});
+  checkAllSameType(c, {{hx_, "hx", 2}, {cx_, "cx", 3}});
+
+  auto input_gates = input_gates_.contiguous();
+  auto hx = hx_.contiguous();
+  auto w_hh = w_hh_.contiguous();
+  auto b_hh = b_hh_.defined() ? b_hh_.contiguous() : b_hh_;
+  auto output = at::empty(
+      {input_gates.size(0), hx.size(0), hx.size(1)}, hx.options());
+  auto cy = cx_.clone(at::MemoryFormat::Contiguous);
+  if (output.numel() == 0) {
+    return std::make_tuple(output, hx.clone(), cy);
+  }
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(input_gates.scalar_type(), "_thnn_persistent_lstm_cuda", [&] {
+    persistent_rnn_impl<scalar_t, 4>(input_gates, hx, w_hh, b_hh, output, cy, reverse);
+  });
+  auto hy = output.select(0, reverse ? 0 : output.size(0) - 1).clone();
+  return std::make_tuple(output, hy, cy);
+}
+
+std::tuple<Tensor, Tensor> _thnn_persistent_gru_cuda(
+    const Tensor& input_gates_, const Tensor& hx_,
+    const Tensor& w_hh_, const Tensor& b_hh_, bool reverse) {
+  CheckedFrom c = "_thnn_persistent_gru_cuda";
+  check_persistent_rnn_args(
+      c, {input_gates_, "input_gates", 1}, {hx_, "hx", 2}, {w_hh_, "w_hh", 3},
+      {b_hh_, "b_hh", 4}, /*num_gates=*/3);
+
+  auto input_gates = input_gates_.contiguous();
+  auto hx = hx_.contiguous();
+  auto w_hh = w_hh_.contiguous();
+  auto b_hh = b_hh_.defined() ? b_hh_.contiguous() : b_hh_;
+  auto output = at::empty(
+      {input_gates.size(0), hx.size(0), hx.size(1)}, hx.options());
+  if (output.numel() == 0) {
+    return std::make_tuple(output, hx.clone());
+  }
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(input_gates.scalar_type(), "_thnn_persistent_gru_cuda", [&] {
+    persistent_rnn_impl<scalar_t, 3>(input_gates, hx, w_hh, b_hh, output, Tensor(), reverse);
+  });
+  auto hy = output.select(0, reverse ? 0 : output.size(0) - 1).clone();
+  return std::make_tuple(output, hy);
+}
+
+}} // namespace at::native
@@ -18,6 +18,7 @@
 #include <type_traits>
 #include <utility>
 #include <thrust/pair.h>
+#include <thrust/tuple.h>
 
 namespace at { namespace native {
 
@@ -296,7 +297,10 @@ struct ReduceOp {
   InputCalculator input_calc;
   OutputCalculator output_calc;
   const void* src;
-  const char* dst[2]; //it accepts at most two destinations
+  // Reductions with several outputs write them to dst[0], dst[1], ...; all
+  // outputs share the strides of dst[0].
+  static constexpr int MAX_NUM_OUTPUTS = 4;
+  const char* dst[MAX_NUM_OUTPUTS];
   // acc_buf used for accumulation among sub Tensor Iterator when accumulation on
   // output is not permissible
   void* acc_buf;
@@ -314,8 +318,7 @@ struct ReduceOp {
       InputCalculator input_calc,
       OutputCalculator output_calc,
       const void* src,
-      char* dst0,
-      optional<char*> dst1,
+      const at::detail::Array<char*, MAX_NUM_OUTPUTS>& dsts,
       void* acc_buf,
       void* cta_buf,
       int* semaphores,
@@ -333,9 +336,8 @@ struct ReduceOp {
         semaphores(semaphores),
         base_idx(base_idx),
         noutputs(noutputs) {
-    dst[0] = dst0;
-    if (dst1.has_value()) {
-      dst[1] = dst1.value();
+    for (int i = 0; i < MAX_NUM_OUTPUTS; i++) {
+      dst[i] = dsts[i];
     }
   }
 
@@ -725,6 +727,24 @@ struct ReduceOp {
     }
   }
 
+  template<class T1, class T2, class T3, class T4>
+  C10_DEVICE void set_results(const thrust::tuple<T1, T2, T3, T4> x, const index_t base_offset) const {
+    // base_offset is in units of T1, see the pair overload above
+    auto element_offset = base_offset / sizeof(T1);
+    if (noutputs >= 1) {
+      *(T1*)((char*)dst[0] + element_offset * sizeof(T1)) = thrust::get<0>(x);
+    }
+    if (noutputs >= 2) {
+      *(T2*)((char*)dst[1] + element_offset * sizeof(T2)) = thrust::get<1>(x);
+    }
+    if (noutputs >= 3) {
+      *(T3*)((char*)dst[2] + element_offset * sizeof(T3)) = thrust::get<2>(x);
+    }
+    if (noutputs >= 4) {
+      *(T4*)((char*)dst[3] + element_offset * sizeof(T4)) = thrust::get<3>(x);
+    }
+  }
+
   template <int output_vec_size>
   C10_DEVICE void set_results_to_output(at::detail::Array<arg_t, output_vec_size> value, at::detail::Array<index_t, output_vec_size> base_offset) const {
     assert(final_output);
@@ -961,11 +981,11 @@ inline void gpu_reduce_kernel(TensorIterator& iter, const ops_t& ops, ident_t id
   const char* in_data = (char*)iter.data_ptr(iter.ntensors() - 1);
   char* out_data = (char*)iter.data_ptr(0);
   const auto noutputs = iter.noutputs();
-  optional<char*> out_data_extra;
-  if (noutputs > 1) {
-    out_data_extra = (char*)iter.data_ptr(1);
-  } else {
-    out_data_extra = nullopt;
+  using reduce_op_t = ReduceOp<scalar_t, ops_t, uint32_t, out_scalar_t, vt0>;
+  TORCH_INTERNAL_ASSERT(noutputs <= reduce_op_t::MAX_NUM_OUTPUTS);
+  at::detail::Array<char*, reduce_op_t::MAX_NUM_OUTPUTS> out_data_all;
+  for (int i = 0; i < reduce_op_t::MAX_NUM_OUTPUTS; i++) {
+    out_data_all[i] = i < noutputs ? (char*)iter.data_ptr(i) : nullptr;
   }
   char* acc_data = acc_buf_ptr->get_acc_slice(out_data);
 
@@ -1111,14 +1131,13 @@ inline void gpu_reduce_kernel(TensorIterator& iter, const ops_t& ops, ident_t id
   AT_ASSERT(can_use_32bit_indexing);
   auto output_calc = make_output_calculator<uint32_t>(iter);
   auto input_calc = make_input_calculator<uint32_t>(iter);
-  auto reduce = ReduceOp<scalar_t, ops_t, uint32_t, out_scalar_t, vt0>(
+  auto reduce = reduce_op_t(
       ops,
       config,
       input_calc,
       output_calc,
       in_data,
-      out_data,
-      out_data_extra,
+      out_data_all,
       acc_data,
       buffer.get(),
       (int*)semaphores.get(),
@@ -36,6 +36,21 @@ static void std_var_kernel_cuda(TensorIterator& iter, bool unbiased, bool take_s
   });
 }
 
+template <typename scalar_t, typename acc_t=scalar_t>
+void multi_reduce_kernel_impl(TensorIterator& iter) {
+  // Four accumulators per input, so unroll by two as for the welford kernel.
+  gpu_reduce_kernel<scalar_t, scalar_t, 2>(iter, MultiReduceOps<scalar_t, acc_t, thrust::tuple<scalar_t, scalar_t, scalar_t, scalar_t>> {}, MultiReduceData<acc_t> {});
+}
+
+static void multi_reduce_kernel_cuda(TensorIterator& iter) {
+  if (iter.dtype() == kHalf) {
+    return multi_reduce_kernel_impl<at::Half, float>(iter);
+  }
+  AT_DISPATCH_FLOATING_TYPES(iter.dtype(), "multi_reduce_cuda", [&]() {
+    multi_reduce_kernel_impl<scalar_t>(iter);
+  });
+}
+
 template <typename scalar_t, typename acc_t=scalar_t, typename out_t=scalar_t>
 void mean_kernel_impl(TensorIterator& iter) {
   float factor = float(iter.num_output_elements()) / iter.numel();
@@ -63,6 +78,7 @@ static void mean_kernel_cuda(TensorIterator& iter) {
 }
 
 REGISTER_DISPATCH(std_var_stub, &std_var_kernel_cuda);
+REGISTER_DISPATCH(multi_reduce_stub, &multi_reduce_kernel_cuda);
 REGISTER_DISPATCH(mean_stub, &mean_kernel_cuda);
 
 }} // namespace at::native
@@ -0,0 +1,132 @@
+#include <ATen/ATen.h>
+#include <ATen/AccumulateType.h>
+#include <ATen/Dispatch.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/cuda/CUDAApplyUtils.cuh>
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/native/ResizedCrop.h>
+#include <ATen/native/cuda/UpSample.cuh>
+
+namespace at {
+namespace native {
+namespace {
+
+// Every thread computes elements of the output, of any of the images, so
+// that a whole batch of images of different sizes takes a single launch.
+template <typename scalar_t, typename result_t, typename accscalar_t>
+C10_LAUNCH_BOUNDS_1(1024)
+__global__ void resized_crop_flip_normalize_out_frame(
+    const int64_t numel,
+    const int64_t channels,
+    const int64_t output_height,
+    const int64_t output_width,
+    const int64_t* __restrict__ params,
+    const float* __restrict__ normalization,
+    result_t* __restrict__ result) {
+  for (int64_t index = blockIdx.x * blockDim.x + threadIdx.x; index < numel;
+       index += blockDim.x * gridDim.x) {
+    const int64_t x = index % output_width;
+    const int64_t y = (index / output_width) % output_height;
+    const int64_t c = (index / (output_width * output_height)) % channels;
+    const int64_t n = index / (output_width * output_height * channels);
+    const int64_t* p = params + n * CROP_NUM_PARAMS;
+    const auto* image = reinterpret_cast<const scalar_t*>(p[CROP_DATA]);
+    const int64_t height = p[CROP_HEIGHT];
+    const int64_t width = p[CROP_WIDTH];
+
+    // As area_pixel_compute_scale does without align_corners
+    const accscalar_t rheight = output_height > 1
+        ? static_cast<accscalar_t>(height) / output_height
+        : static_cast<accscalar_t>(0);
+    const accscalar_t rwidth = output_width > 1
+        ? static_cast<accscalar_t>(width) / output_width
+        : static_cast<accscalar_t>(0);
+    const accscalar_t h1r = area_pixel_compute_source_index<accscalar_t>(
+        rheight, y, /*align_corners=*/false, /*cubic=*/false);
+    const int64_t h1 = h1r;
+    const int64_t h1p = (h1 < height - 1) ? 1 : 0;
+    const accscalar_t h1lambda = h1r - h1;
+    const accscalar_t h0lambda = static_cast<accscalar_t>(1) - h1lambda;
+    // The output is flipped horizontally after the resize.
+    const int64_t w2 = p[CROP_FLIP] ? output_width - 1 - x : x;
+    const accscalar_t w1r = area_pixel_compute_source_index<accscalar_t>(
+        rwidth, w2, /*align_corners=*/false, /*cubic=*/false);
+    const int64_t w1 = w1r;
+    const int64_t w1p = (w1 < width - 1) ? 1 : 0;
+    const accscalar_t w1lambda = w1r - w1;
+    const accscalar_t w0lambda = static_cast<accscalar_t>(1) - w1lambda;
+
+    const scalar_t* row0 = image + c * p[CROP_STRIDE_C] +
+        (p[CROP_TOP] + h1) * p[CROP_STRIDE_H] +
+        (p[CROP_LEFT] + w1) * p[CROP_STRIDE_W];
+    const scalar_t* row1 = row0 + h1p * p[CROP_STRIDE_H];
+    const int64_t right = w1p * p[CROP_STRIDE_W];
+    const accscalar_t val = h0lambda *
+            (w0lambda * static_cast<accscalar_t>(row0[0]) +
+             w1lambda * static_cast<accscalar_t>(row0[right])) +
+        h1lambda *
+            (w0lambda * static_cast<accscalar_t>(row1[0]) +
+             w1lambda * static_cast<accscalar_t>(row1[right]));
+    result[index] = static_cast<result_t>(
+        val * normalization[c] + normalization[channels + c]);
+  }
+}
+
+} // namespace
+
+Tensor resized_crop_flip_normalize_cuda(
+    TensorList images,
+    const Tensor& boxes,
+    const Tensor& flips,
+    IntArrayRef output_size,
+    ArrayRef<double> mean,
+    ArrayRef<double> std) {
+  auto params = resized_crop_params(images, boxes, flips, output_size, mean, std);
+  const auto& first = images[0];
+  TORCH_CHECK(
+      first.is_cuda(),
+      "_resized_crop_flip_normalize: expected CUDA images, but got images on ",
+      first.device());
+  const int64_t channels = first.size(0);
+  auto normalization = resized_crop_normalization(channels, mean, std);
+  // Copied from pinned memory, which the caching host allocator keeps until
+  // the copies are done, so that they do not block the host.
+  params = params.pin_memory().to(first.device(), /*non_blocking=*/true);
+  normalization =
+      normalization.pin_memory().to(first.device(), /*non_blocking=*/true);
+  auto result = at::empty(
+      {static_cast<int64_t>(images.size()), channels, output_size[0], output_size[1]},
+      first.options().dtype(resized_crop_result_type(first.scalar_type())));
+
+  const int64_t numel = result.numel();
+  const int num_threads = std::min(
+      at::cuda::getCurrentDeviceProperties()->maxThreadsPerBlock, 1024);
+  const int64_t max_blocks =
+      at::cuda::getCurrentDeviceProperties()->multiProcessorCount *
+      (at::cuda::getCurrentDeviceProperties()->maxThreadsPerMultiProcessor /
+       num_threads);
+  const int num_blocks =
+      std::min(cuda::ATenCeilDiv(numel, int64_t(num_threads)), max_blocks);
+  cudaStream_t stream = at::cuda::getCurrentCUDAStream();
+
+  AT_DISPATCH_FLOATING_TYPES_AND2(
+      kByte, kHalf, first.scalar_type(), "resized_crop_flip_normalize_cuda", [&] {
+        using result_t = resized_crop_result_t<scalar_t>;
+        using accscalar_t = at::acc_type<result_t, /*is_cuda=*/true>;
+        resized_crop_flip_normalize_out_frame<scalar_t, result_t, accscalar_t>
+            <<<num_blocks, num_threads, 0, stream>>>(
+                numel,
+                channels,
+                output_size[0],
+                output_size[1],
+                params.data_ptr<int64_t>(),
+                normalization.data_ptr<float>(),
+                result.data_ptr<result_t>());
+      });
+
+  AT_CUDA_CHECK(cudaGetLastError());
+  return result;
+}
+
+} // namespace native
+} // namespace at
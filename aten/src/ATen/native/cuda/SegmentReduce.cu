@@ -0,0 +1,343 @@
+#include <ATen/native/SegmentReduce.h>
+
+#include <ATen/ATen.h>
+#include <ATen/AccumulateType.h>
+#include <ATen/Dispatch.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/cub.cuh>
+#include <THC/THCNumerics.cuh>
+#include <c10/cuda/CUDAMathCompat.h>
+
+#include <cub/block/block_reduce.cuh>
+
+#include <limits>
+
+namespace at { namespace native {
+
+namespace {
+
+// Segments are reduced either with one thread per (segment, column), walking
+// the rows of the segment in order, when rows are wide enough to keep a warp
+// busy, or with a block per (segment, column) that splits the rows of the
+// segment between its threads otherwise (e.g. for 1-D data).
+constexpr int kColumnThreads = 256;
+constexpr int kRowThreads = 128;
+constexpr int64_t kMinColumnsForColumnKernel = C10_WARP_SIZE;
+
+// Rows of segment `b`, clamped to [0, num_rows) so that invalid offsets
+// coming from the device can not lead to out of bounds accesses.
+__device__ __forceinline__ void segment_bounds(
+    const int64_t* offsets, int64_t b, int64_t num_rows, int64_t* start, int64_t* stop) {
+  *start = ::min(::max(offsets[b], int64_t(0)), num_rows);
+  *stop = ::min(::max(offsets[b + 1], *start), num_rows);
+}
+
+// Running reduction of a segment. `index` is the row of the max for MAX and
+// -1 while nothing has been accumulated.
+template <typename acc_t>
+struct SegmentAcc {
+  acc_t value;
+  int64_t index;
+};
+
+template <typename acc_t>
+struct SegmentCombine {
+  SegmentReductionType reduce;
+
+  __device__ __forceinline__ SegmentAcc<acc_t> operator()(
+      const SegmentAcc<acc_t>& a, const SegmentAcc<acc_t>& b) const {
+    if (reduce != SegmentReductionType::MAX) {
+      return {a.value + b.value, ::max(a.index, b.index)};
+    }
+    if (a.index < 0) {
+      return b;
+    }
+    if (b.index < 0) {
+      return a;
+    }
+    // NaN propagates; ties keep the first row, so the result does not depend
+    // on the order of the combines.
+    const bool a_nan = THCNumerics<acc_t>::isnan(a.value);
+    const bool b_nan = THCNumerics<acc_t>::isnan(b.value);
+    if (a_nan != b_nan) {
+      return a_nan ? a : b;
+    }
+    if (!a_nan && a.value != b.value) {
+      return a.value > b.value ? a : b;
+    }
+    return a.index < b.index ? a : b;
+  }
+};
+
+template <typename scalar_t, typename acc_t>
+__device__ __forceinline__ void segment_reduce_write(
+    const SegmentAcc<acc_t>& acc, SegmentReductionType reduce, int64_t length,
+    scalar_t* output, int64_t* arg) {
+  if (reduce == SegmentReductionType::MAX) {
+    *output = acc.index < 0 ? scalar_t(0) : static_cast<scalar_t>(acc.value);
+    *arg = acc.index;
+  } else if (reduce == SegmentReductionType::MEAN) {
+    *output = length > 0 ? static_cast<scalar_t>(acc.value / static_cast<acc_t>(length)) : scalar_t(0);
+  } else {
+    *output = static_cast<scalar_t>(acc.value);
+  }
+}
+
+template <typename scalar_t, typename acc_t>
+__global__ void segment_reduce_column_kernel(
+    const scalar_t* data, const int64_t* offsets, int64_t num_rows, int64_t inner_size,
+    SegmentReductionType reduce, scalar_t* output, int64_t* arg) {
+  const int64_t b = blockIdx.x;
+  const int64_t f = blockIdx.y * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  if (f >= inner_size) {
+    return;
+  }
+  int64_t start, stop;
+  segment_bounds(offsets, b, num_rows, &start, &stop);
+  SegmentCombine<acc_t> combine{reduce};
+  SegmentAcc<acc_t> acc{acc_t(0), -1};
+  for (int64_t row = start; row < stop; row++) {
+    acc = combine(acc, {static_cast<acc_t>(data[row * inner_size + f]), row});
+  }
+  segment_reduce_write(
+      acc, reduce, stop - start, output + b * inner_size + f,
+      arg == nullptr ? nullptr : arg + b * inner_size + f);
+}
+
+template <typename scalar_t, typename acc_t>
+__global__ void segment_reduce_row_kernel(
+    const scalar_t* data, const int64_t* offsets, int64_t num_rows, int64_t inner_size,
+    SegmentReductionType reduce, scalar_t* output, int64_t* arg) {
+  using BlockReduce = cub::BlockReduce<SegmentAcc<acc_t>, kRowThreads>;
+  __shared__ typename BlockReduce::TempStorage temp_storage;
+  const int64_t b = blockIdx.x;
+  const int64_t f = blockIdx.y;
+  int64_t start, stop;
+  segment_bounds(offsets, b, num_rows, &start, &stop);
+  SegmentCombine<acc_t> combine{reduce};
+  SegmentAcc<acc_t> acc{acc_t(0), -1};
+  for (int64_t row = start + threadIdx.x; row < stop; row += blockDim.x) {
+    acc = combine(acc, {static_cast<acc_t>(data[row * inner_size + f]), row});
+  }
+  acc = BlockReduce(temp_storage).Reduce(acc, combine);
+  if (threadIdx.x == 0) {
+    segment_reduce_write(
+        acc, reduce, stop - start, output + b * inner_size + f,
+        arg == nullptr ? nullptr : arg + b * inner_size + f);
+  }
+}
+
+// Online max and sum of exponentials, as in the softmax kernels.
+template <typename acc_t>
+struct SegmentMaxSumExp {
+  acc_t max;
+  acc_t sum;
+};
+
+template <typename acc_t>
+struct SegmentMaxSumExpCombine {
+  __device__ __forceinline__ SegmentMaxSumExp<acc_t> operator()(
+      const SegmentMaxSumExp<acc_t>& a, const SegmentMaxSumExp<acc_t>& b) const {
+    if (a.sum == acc_t(0)) {
+      return b;
+    }
+    if (b.sum == acc_t(0)) {
+      return a;
+    }
+    const acc_t max = ::max(a.max, b.max);
+    return {max, a.sum * std::exp(a.max - max) + b.sum * std::exp(b.max - max)};
+  }
+};
+
+template <typename acc_t>
+__device__ __forceinline__ SegmentMaxSumExp<acc_t> segment_max_sum_exp_add(
+    const SegmentMaxSumExp<acc_t>& a, acc_t x) {
+  return SegmentMaxSumExpCombine<acc_t>()(a, {x, acc_t(1)});
+}
+
+template <typename scalar_t, typename acc_t>
+__global__ void segment_softmax_column_kernel(
+    const scalar_t* data, const int64_t* offsets, int64_t num_rows, int64_t inner_size,
+    scalar_t* output) {
+  const int64_t b = blockIdx.x;
+  const int64_t f = blockIdx.y * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  if (f >= inner_size) {
+    return;
+  }
+  int64_t start, stop;
+  segment_bounds(offsets, b, num_rows, &start, &stop);
+  SegmentMaxSumExp<acc_t> acc{-std::numeric_limits<acc_t>::infinity(), acc_t(0)};
+  for (int64_t row = start; row < stop; row++) {
+    acc = segment_max_sum_exp_add(acc, static_cast<acc_t>(data[row * inner_size + f]));
+  }
+  for (int64_t row = start; row < stop; row++) {
+    const int64_t index = row * inner_size + f;
+    output[index] = std::exp(static_cast<acc_t>(data[index]) - acc.max) / acc.sum;
+  }
+}
+
+template <typename scalar_t, typename acc_t>
+__global__ void segment_softmax_row_kernel(
+    const scalar_t* data, const int64_t* offsets, int64_t num_rows, int64_t inner_size,
+    scalar_t* output) {
+  using BlockReduce = cub::BlockReduce<SegmentMaxSumExp<acc_t>, kRowThreads>;
+  __shared__ typename BlockReduce::TempStorage temp_storage;
+  __shared__ SegmentMaxSumExp<acc_t> segment_stats;
+  const int64_t b = blockIdx.x;
+  const int64_t f = blockIdx.y;
+  int64_t start, stop;
+  segment_bounds(offsets, b, num_rows, &start, &stop);
+  SegmentMaxSumExp<acc_t> acc{-std::numeric_limits<acc_t>::infinity(), acc_t(0)};
+  for (int64_t row = start + threadIdx.x; row < stop; row += blockDim.x) {
+    acc = segment_max_sum_exp_add(acc, static_cast<acc_t>(data[row * inner_size + f]));
+  }
+  acc = BlockReduce(temp_storage).Reduce(acc, SegmentMaxSumExpCombine<acc_t>());
+  if (threadIdx.x == 0) {
+    segment_stats = acc;
+  }
+  __syncthreads();
+  acc = segment_stats;
+  for (int64_t row = start + threadIdx.x; row < stop; row += blockDim.x) {
+    const int64_t index = row * inner_size + f;
+    output[index] = std::exp(static_cast<acc_t>(data[index]) - acc.max) / acc.sum;
+  }
+}
+
+// Turns the positions in `data` produced by the radix sort into positions
+// relative to the start of each segment.
+__global__ void segment_sort_localize_indices_kernel(
+    const int64_t* offsets, int64_t num_rows, int64_t* indices) {
+  int64_t start, stop;
+  segment_bounds(offsets, blockIdx.x, num_rows, &start, &stop);
+  for (int64_t row = start + threadIdx.x; row < stop; row += blockDim.x) {
+    indices[row] -= start;
+  }
+}
+
+__global__ void segment_sort_iota_kernel(int64_t n, int64_t* indices) {
+  const int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  if (i < n) {
+    indices[i] = i;
+  }
+}
+
+// Launch configuration shared by the reduction and softmax kernels.
+bool use_column_kernel(int64_t inner_size) {
+  return inner_size >= kMinColumnsForColumnKernel;
+}
+
+dim3 segment_grid(int64_t num_segments, int64_t inner_size) {
+  const int64_t grid_y = use_column_kernel(inner_size)
+      ? (inner_size + kColumnThreads - 1) / kColumnThreads
+      : inner_size;
+  TORCH_CHECK(num_segments <= std::numeric_limits<int32_t>::max() &&
+      grid_y <= at::cuda::getCurrentDeviceProperties()->maxGridSize[1],
+      "segment ops: too many segments or too wide rows for CUDA");
+  return dim3(num_segments, grid_y);
+}
+
+} // namespace
+
+std::tuple<Tensor, Tensor> segment_reduce_cuda(const Tensor& data_, const Tensor& offsets_, std::string reduce) {
+  segment_check_inputs("segment_reduce", data_, offsets_);
+  const auto reduction = get_segment_reduction_type(reduce);
+  auto data = data_.contiguous();
+  auto offsets = offsets_.contiguous();
+
+  auto output = at::empty(segment_output_size(data, offsets), data.options());
+  auto arg = reduction == SegmentReductionType::MAX
+      ? at::empty(output.sizes(), data.options().dtype(kLong))
+      : at::empty({0}, data.options().dtype(kLong));
+  const int64_t num_segments = offsets.numel() - 1;
+  const int64_t inner_size = segment_inner_size(data);
+  if (output.numel() == 0) {
+    return std::make_tuple(output, arg);
+  }
+
+  const dim3 grid = segment_grid(num_segments, inner_size);
+  cudaStream_t stream = at::cuda::getCurrentCUDAStream();
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(data.scalar_type(), "segment_reduce_cuda", [&] {
+    using acc_t = acc_type<scalar_t, /*is_cuda=*/true>;
+    int64_t* arg_ptr = arg.numel() > 0 ? arg.data_ptr<int64_t>() : nullptr;
+    if (use_column_kernel(inner_size)) {
+      segment_reduce_column_kernel<scalar_t, acc_t><<<grid, kColumnThreads, 0, stream>>>(
+          data.data_ptr<scalar_t>(), offsets.data_ptr<int64_t>(), data.size(0), inner_size,
+          reduction, output.data_ptr<scalar_t>(), arg_ptr);
+    } else {
+      segment_reduce_row_kernel<scalar_t, acc_t><<<grid, kRowThreads, 0, stream>>>(
+          data.data_ptr<scalar_t>(), offsets.data_ptr<int64_t>(), data.size(0), inner_size,
+          reduction, output.data_ptr<scalar_t>(), arg_ptr);
+    }
+    AT_CUDA_CHECK(cudaGetLastError());
+  });
+  return std::make_tuple(output, arg);
+}
+
+Tensor segment_softmax_cuda(const Tensor& data_, const Tensor& offsets_) {
+  segment_check_inputs("segment_softmax", data_, offsets_);
+  auto data = data_.contiguous();
+  auto offsets = offsets_.contiguous();
+
+  auto output = at::empty_like(data, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  const int64_t num_segments = offsets.numel() - 1;
+  const int64_t inner_size = segment_inner_size(data);
+  if (output.numel() == 0 || num_segments == 0) {
+    return output;
+  }
+
+  const dim3 grid = segment_grid(num_segments, inner_size);
+  cudaStream_t stream = at::cuda::getCurrentCUDAStream();
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(data.scalar_type(), "segment_softmax_cuda", [&] {
+    using acc_t = acc_type<scalar_t, /*is_cuda=*/true>;
+    if (use_column_kernel(inner_size)) {
+      segment_softmax_column_kernel<scalar_t, acc_t><<<grid, kColumnThreads, 0, stream>>>(
+          data.data_ptr<scalar_t>(), offsets.data_ptr<int64_t>(), data.size(0), inner_size,
+          output.data_ptr<scalar_t>());
+    } else {
+      segment_softmax_row_kernel<scalar_t, acc_t><<<grid, kRowThreads, 0, stream>>>(
+          data.data_ptr<scalar_t>(), offsets.data_ptr<int64_t>(), data.size(0), inner_size,
+          output.data_ptr<scalar_t>());
+    }
+    AT_CUDA_CHECK(cudaGetLastError());
+  });
+  return output;
+}
+
+std::tuple<Tensor, Tensor> segment_sort_cuda(const Tensor& data_, const Tensor& offsets_, bool descending) {
+  segment_check_inputs("segment_sort", data_, offsets_);
+  TORCH_CHECK(data_.dim() == 1, "segment_sort: expected 1-D data, but got data of shape ", data_.sizes());
+  auto data = data_.contiguous();
+  auto offsets = offsets_.contiguous();
+
+  auto values = at::empty_like(data, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  auto indices = at::empty(data.sizes(), data.options().dtype(kLong));
+  const int64_t num_rows = data.numel();
+  const int64_t num_segments = offsets.numel() - 1;
+  if (num_rows == 0 || num_segments == 0) {
+    return std::make_tuple(values, indices);
+  }
+
+  cudaStream_t stream = at::cuda::getCurrentCUDAStream();
+  auto positions = at::empty({num_rows}, indices.options());
+  segment_sort_iota_kernel<<<(num_rows + kColumnThreads - 1) / kColumnThreads, kColumnThreads, 0, stream>>>(
+      num_rows, positions.data_ptr<int64_t>());
+  AT_CUDA_CHECK(cudaGetLastError());
+
+  // The radix sort is stable, orders NaN above +inf, and does not need the
+  // offsets on the host.
+  AT_DISPATCH_ALL_TYPES_AND(kHalf, data.scalar_type(), "segment_sort_cuda", [&] {
+    const int64_t* begin_offsets = offsets.data_ptr<int64_t>();
+    at::cuda::cub::segmented_sort_pairs(
+        data.data_ptr<scalar_t>(), values.data_ptr<scalar_t>(),
+        positions.data_ptr<int64_t>(), indices.data_ptr<int64_t>(),
+        num_rows, num_segments, begin_offsets, begin_offsets + 1, descending);
+  });
+
+  segment_sort_localize_indices_kernel<<<num_segments, kColumnThreads, 0, stream>>>(
+      offsets.data_ptr<int64_t>(), num_rows, indices.data_ptr<int64_t>());
+  AT_CUDA_CHECK(cudaGetLastError());
+  return std::make_tuple(values, indices);
+}
+
+}} // namespace at::native
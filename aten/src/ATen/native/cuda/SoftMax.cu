@@ -10,11 +10,19 @@
 
 #include <ATen/AccumulateType.h>
 #include <ATen/cuda/NumericLimits.cuh>
+#include <limits>
 #include <type_traits>
 
 #include <ATen/native/cuda/Loops.cuh>
 #include <ATen/native/cuda/MemoryAccess.cuh>
 #include <ATen/native/cuda/PersistentSoftmax.cuh>
+#include <ATen/native/MaskedSoftmax.h>
+#include <ATen/native/CrossEntropy.h>
+#include <ATen/CUDAGeneratorImpl.h>
+#include <ATen/cuda/CUDAGraphsUtils.cuh>
+#include <ATen/cuda/detail/IndexUtils.cuh>
+#include <ATen/cuda/detail/OffsetCalculator.cuh>
+#include <curand_kernel.h>
 
 namespace at {
 namespace native {
@@ -307,14 +315,6 @@ __global__ void cunn_SpatialSoftMaxBackward(
 ////////////////////////////////////////////////////////////////////////////////
 
 
-template <typename T, typename AccumT>
-struct MaxFloat
-{
-  __device__ __forceinline__ AccumT operator()(AccumT max, T v) const {
-    return ::max(max, (AccumT)v);
-  }
-};
-
 template<typename T, typename AccumT>
 struct AddFloat
 {
@@ -323,17 +323,35 @@ struct AddFloat
   }
 };
 
-template<typename T, typename AccumT>
-struct SumExpFloat
-{
-  __device__ __forceinline__ SumExpFloat(AccumT v)
-    : max_k(v) {}
+// The running max of a row together with the sum of exp(x - max) over the
+// elements seen so far. Folding elements in with OnlineSumExpFloat and
+// merging partial results with MaxSumExpCombine gives both statistics softmax
+// needs from a single read of the row: when the max grows the sum is rescaled
+// by exp(old_max - new_max).
+template <typename AccumT>
+struct MaxSumExp {
+  AccumT max;
+  AccumT sum;
+};
 
-  __device__ __forceinline__ AccumT operator()(AccumT sum, T v) const {
-    return sum + std::exp(v - max_k);
+template <typename T, typename Acc>
+struct OnlineSumExpFloat
+{
+  __device__ __forceinline__ Acc operator()(Acc acc, T v) const {
+    const auto x = static_cast<decltype(acc.max)>(v);
+    if (x > acc.max) {
+      return {x, acc.sum * std::exp(acc.max - x) + 1};
+    }
+    return {acc.max, acc.sum + std::exp(x - acc.max)};
   }
+};
 
-  const AccumT max_k;
+template <typename Acc>
+struct MaxSumExpCombine {
+  __device__ __forceinline__ Acc operator()(Acc a, Acc b) const {
+    const auto max = a.max < b.max ? b.max : a.max;
+    return {max, a.sum * std::exp(a.max - max) + b.sum * std::exp(b.max - max)};
+  }
 };
 
 template <template<typename> class Reduction, typename AccumT>
@@ -630,19 +648,15 @@ cunn_SoftMaxForward(outscalar_t *output, scalar_t *input, int classes)
   const int shift = ((uint64_t)input) % ALIGN_BYTES / sizeof(scalar_t);
   const int output_shift = ((uint64_t)output) % ALIGN_BYTES / sizeof(outscalar_t);
 
-  // find the max
-  accscalar_t threadMax = ilpReduce<MaxFloat, ILP, scalar_t, accscalar_t>(
-      shift, input, classes, MaxFloat<scalar_t, accscalar_t>(), -at::numeric_limits<accscalar_t>::max());
-  accscalar_t max_k = blockReduce<Max, accscalar_t>(
-      sdata, threadMax, Max<accscalar_t>(), -at::numeric_limits<accscalar_t>::max());
-
-  // reduce all values
-  accscalar_t threadExp = ilpReduce<SumExpFloat, ILP, scalar_t, accscalar_t>(
-      shift, input, classes, SumExpFloat<scalar_t, accscalar_t>(max_k), static_cast<accscalar_t>(0));
-  accscalar_t sumAll = blockReduce<Add, accscalar_t>(
-      sdata, threadExp, Add<accscalar_t>(), static_cast<accscalar_t>(0));
+  // find the max and the sum of exponentials in one pass over the input
+  using acc_t = MaxSumExp<accscalar_t>;
+  const acc_t init = {-at::numeric_limits<accscalar_t>::max(), accscalar_t(0)};
+  acc_t threadVal = ilpReduce<OnlineSumExpFloat, ILP, scalar_t, acc_t>(
+      shift, input, classes, OnlineSumExpFloat<scalar_t, acc_t>(), init);
+  acc_t blockVal = blockReduce<MaxSumExpCombine, acc_t>(
+      reinterpret_cast<acc_t*>(sdata), threadVal, MaxSumExpCombine<acc_t>(), init);
 
-  Epilogue<scalar_t, accscalar_t, outscalar_t> epilogue(max_k, sumAll);
+  Epilogue<scalar_t, accscalar_t, outscalar_t> epilogue(blockVal.max, blockVal.sum);
 
   if (shift == output_shift) {
     WriteFpropResultsVectorized<ILP, scalar_t, accscalar_t, outscalar_t, Epilogue>(classes, shift, input, output, epilogue);
@@ -651,6 +665,68 @@ cunn_SoftMaxForward(outscalar_t *output, scalar_t *input, int classes)
   }
 }
 
+// Same as cunn_SoftMaxForward for rows that fit in shared memory: the row is
+// cached there while the max and sum are computed, so the input is read from
+// global memory once and the output written once. The caller checks that the
+// rows of input and output are aligned for ILP-wide vector accesses and that
+// classes * sizeof(scalar_t) bytes of cache plus the reduction buffer fit.
+template <int ILP, typename scalar_t, typename accscalar_t, typename outscalar_t, template <typename, typename, typename> class Epilogue>
+__global__ void
+cunn_SoftMaxForwardSmem(outscalar_t *output, scalar_t *input, int classes)
+{
+  using acc_t = MaxSumExp<accscalar_t>;
+  using LoadT = at::native::memory::aligned_vector<scalar_t, ILP>;
+  using StoreT = at::native::memory::aligned_vector<outscalar_t, ILP>;
+
+  extern __shared__ unsigned char smem[];
+  auto row_cache = reinterpret_cast<LoadT*>(smem);
+  auto sdata = reinterpret_cast<acc_t*>(smem + classes * sizeof(scalar_t));
+
+  input += blockIdx.x * classes;
+  output += blockIdx.x * classes;
+
+  const acc_t init = {-at::numeric_limits<accscalar_t>::max(), accscalar_t(0)};
+  const OnlineSumExpFloat<scalar_t, acc_t> reduce_op;
+  acc_t threadVal = init;
+  for (int offset = threadIdx.x; offset * ILP < classes; offset += blockDim.x) {
+    LoadT crnt_vec = reinterpret_cast<LoadT*>(input)[offset];
+    row_cache[offset] = crnt_vec;
+
+    #pragma unroll
+    for (int j = 0; j < ILP; ++j) {
+      threadVal = reduce_op(threadVal, crnt_vec.val[j]);
+    }
+  }
+  // blockReduce synchronizes before it returns, which also publishes row_cache
+  acc_t blockVal = blockReduce<MaxSumExpCombine, acc_t>(
+      sdata, threadVal, MaxSumExpCombine<acc_t>(), init);
+
+  Epilogue<scalar_t, accscalar_t, outscalar_t> epilogue(blockVal.max, blockVal.sum);
+
+  for (int offset = threadIdx.x; offset * ILP < classes; offset += blockDim.x) {
+    LoadT crnt_vec = row_cache[offset];
+    StoreT out_vec;
+
+    #pragma unroll
+    for (int j = 0; j < ILP; ++j) {
+      out_vec.val[j] = epilogue(crnt_vec.val[j]);
+    }
+    reinterpret_cast<StoreT*>(output)[offset] = out_vec;
+  }
+}
+
+// Returns whether cunn_SoftMaxForwardSmem can handle rows of `dim_size`
+// elements with `block` threads, given the input and output buffers.
+template <int ILP, typename scalar_t, typename accscalar_t, typename outscalar_t>
+bool can_use_smem_softmax(const void* input, const void* output, int64_t dim_size, dim3 block) {
+  const bool aligned =
+      dim_size % ILP == 0 &&
+      reinterpret_cast<uint64_t>(input) % (ILP * sizeof(scalar_t)) == 0 &&
+      reinterpret_cast<uint64_t>(output) % (ILP * sizeof(outscalar_t)) == 0;
+  const size_t smem_size = dim_size * sizeof(scalar_t) + block.x * sizeof(MaxSumExp<accscalar_t>);
+  return aligned && smem_size <= at::cuda::getCurrentDeviceProperties()->sharedMemPerBlock;
+}
+
 template <int ILP, typename scalar_t, typename accscalar_t, typename outscalar_t, template<typename, typename, typename> class Epilogue>
 __global__ void
 cunn_SoftMaxBackward(scalar_t *gradInput, outscalar_t *output, outscalar_t *gradOutput, int classes)
@@ -716,10 +792,18 @@ Tensor host_softmax(const Tensor & input_, const int64_t dim_, const bool half_t
         } else {
           constexpr int ILP = sizeof(float4) / sizeof(scalar_t);
           dim3 block = SoftMax_getBlockSize(ILP, dim_size);
-          cunn_SoftMaxForward<ILP, scalar_t, accscalar_t, scalar_t, Epilogue>
-            <<<grid, block, block.x * sizeof(accscalar_t), stream>>>(
-              output.data_ptr<scalar_t>(), input.data_ptr<scalar_t>(), dim_size
-          );
+          if (can_use_smem_softmax<ILP, scalar_t, accscalar_t, scalar_t>(
+                  input.data_ptr(), output.data_ptr(), dim_size, block)) {
+            cunn_SoftMaxForwardSmem<ILP, scalar_t, accscalar_t, scalar_t, Epilogue>
+              <<<grid, block, dim_size * sizeof(scalar_t) + block.x * sizeof(MaxSumExp<accscalar_t>), stream>>>(
+                output.data_ptr<scalar_t>(), input.data_ptr<scalar_t>(), dim_size
+            );
+          } else {
+            cunn_SoftMaxForward<ILP, scalar_t, accscalar_t, scalar_t, Epilogue>
+              <<<grid, block, block.x * sizeof(MaxSumExp<accscalar_t>), stream>>>(
+                output.data_ptr<scalar_t>(), input.data_ptr<scalar_t>(), dim_size
+            );
+          }
         }
       } else {
         if (dim_size <= 1024 && dim_size*sizeof(scalar_t) <= 4096) {
@@ -728,10 +812,18 @@ Tensor host_softmax(const Tensor & input_, const int64_t dim_, const bool half_t
         } else {
           constexpr int ILP = sizeof(float4) / sizeof(accscalar_t);
           dim3 block = SoftMax_getBlockSize(ILP, dim_size);
-          cunn_SoftMaxForward<ILP, scalar_t, accscalar_t, accscalar_t, Epilogue>
-            <<<grid, block, block.x * sizeof(accscalar_t), stream>>>(
-              output.data_ptr<accscalar_t>(), input.data_ptr<scalar_t>(), dim_size
-          );
+          if (can_use_smem_softmax<ILP, scalar_t, accscalar_t, accscalar_t>(
+                  input.data_ptr(), output.data_ptr(), dim_size, block)) {
+            cunn_SoftMaxForwardSmem<ILP, scalar_t, accscalar_t, accscalar_t, Epilogue>
+              <<<grid, block, dim_size * sizeof(scalar_t) + block.x * sizeof(MaxSumExp<accscalar_t>), stream>>>(
+                output.data_ptr<accscalar_t>(), input.data_ptr<scalar_t>(), dim_size
+            );
+          } else {
+            cunn_SoftMaxForward<ILP, scalar_t, accscalar_t, accscalar_t, Epilogue>
+              <<<grid, block, block.x * sizeof(MaxSumExp<accscalar_t>), stream>>>(
+                output.data_ptr<accscalar_t>(), input.data_ptr<scalar_t>(), dim_size
+            );
+          }
         }
       }
       });
@@ -861,6 +953,268 @@ Tensor host_softmax_backward(const Tensor &grad_, const Tensor &output_, int64_t
   AT_CUDA_CHECK(cudaGetLastError());
   return gI;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+// Masked softmax: softmax(input * scale + mask) over the last dimension,
+// optionally followed by dropout, with one block per row.
+////////////////////////////////////////////////////////////////////////////////
+
+struct NoMask {
+  template <typename accscalar_t>
+  __device__ __forceinline__ accscalar_t operator()(accscalar_t x, uint32_t offset) const {
+    return x;
+  }
+};
+
+// true elements of the mask are left out of the softmax
+struct BoolMask {
+  const bool* mask;
+  template <typename accscalar_t>
+  __device__ __forceinline__ accscalar_t operator()(accscalar_t x, uint32_t offset) const {
+    return mask[offset] ? -std::numeric_limits<accscalar_t>::infinity() : x;
+  }
+};
+
+template <typename scalar_t>
+struct AdditiveMask {
+  const scalar_t* mask;
+  template <typename accscalar_t>
+  __device__ __forceinline__ accscalar_t operator()(accscalar_t x, uint32_t offset) const {
+    return x + static_cast<accscalar_t>(mask[offset]);
+  }
+};
+
+// With cache_row, the masked and scaled row is kept in shared memory between
+// the reduction and the write, so input and mask are read once; otherwise
+// they are read again for the write. `mask_calc` maps a row to the offset of
+// its mask row. With has_dropout, `softmax` and `dropout_mask` receive the
+// softmax before dropout and the kept elements, as the backward needs them.
+template <typename scalar_t, typename accscalar_t, typename mask_op_t, bool cache_row, bool has_dropout>
+__global__ void
+cunn_MaskedSoftMaxForward(scalar_t *output, scalar_t *softmax, uint8_t *dropout_mask,
+                          const scalar_t *input, int classes, accscalar_t scale,
+                          mask_op_t mask_op, OffsetCalculator<1> mask_calc,
+                          accscalar_t keep_prob, PhiloxCudaState philox_args)
+{
+  using acc_t = MaxSumExp<accscalar_t>;
+  extern __shared__ unsigned char smem[];
+  auto sdata = reinterpret_cast<acc_t*>(smem);
+  auto row_cache = reinterpret_cast<accscalar_t*>(smem + blockDim.x * sizeof(acc_t));
+
+  const int64_t row_offset = static_cast<int64_t>(blockIdx.x) * classes;
+  input += row_offset;
+  output += row_offset;
+  const uint32_t mask_offset = mask_calc.get(blockIdx.x)[0];
+  auto load = [&](int c) {
+    return mask_op(static_cast<accscalar_t>(input[c]) * scale, mask_offset + c);
+  };
+
+  const acc_t init = {-at::numeric_limits<accscalar_t>::max(), accscalar_t(0)};
+  const OnlineSumExpFloat<accscalar_t, acc_t> reduce_op;
+  acc_t threadVal = init;
+  for (int c = threadIdx.x; c < classes; c += blockDim.x) {
+    const accscalar_t x = load(c);
+    if (cache_row) {
+      row_cache[c] = x;
+    }
+    threadVal = reduce_op(threadVal, x);
+  }
+  acc_t blockVal = blockReduce<MaxSumExpCombine, acc_t>(
+      sdata, threadVal, MaxSumExpCombine<acc_t>(), init);
+  // rows with every element masked out have a zero sum and produce zeros
+  const accscalar_t inv_sum = blockVal.sum == 0 ? accscalar_t(0) : accscalar_t(1) / blockVal.sum;
+
+  curandStatePhilox4_32_10_t state;
+  if (has_dropout) {
+    softmax += row_offset;
+    dropout_mask += row_offset;
+    auto seeds = at::cuda::philox::unpack(philox_args);
+    curand_init(
+        std::get<0>(seeds),
+        static_cast<uint64_t>(blockIdx.x) * blockDim.x + threadIdx.x,
+        std::get<1>(seeds),
+        &state);
+  }
+  for (int c = threadIdx.x; c < classes; c += blockDim.x) {
+    const accscalar_t x = cache_row ? row_cache[c] : load(c);
+    const accscalar_t y = std::exp(x - blockVal.max) * inv_sum;
+    if (has_dropout) {
+      const bool keep = curand_uniform(&state) < keep_prob;
+      softmax[c] = static_cast<scalar_t>(y);
+      dropout_mask[c] = keep;
+      output[c] = static_cast<scalar_t>(keep ? y / keep_prob : accscalar_t(0));
+    } else {
+      output[c] = static_cast<scalar_t>(y);
+    }
+  }
+}
+
+// grad_input = scale * y * (g - sum(g * y)), where y is the softmax before
+// dropout and g the gradient with respect to it.
+template <typename scalar_t, typename accscalar_t, bool has_dropout>
+__global__ void
+cunn_MaskedSoftMaxBackward(scalar_t *grad_input, const scalar_t *grad_output,
+                           const scalar_t *softmax, const uint8_t *dropout_mask,
+                           int classes, accscalar_t scale, accscalar_t inv_keep_prob)
+{
+  extern __shared__ unsigned char smem[];
+  auto sdata = reinterpret_cast<accscalar_t*>(smem);
+
+  const int64_t row_offset = static_cast<int64_t>(blockIdx.x) * classes;
+  grad_input += row_offset;
+  grad_output += row_offset;
+  softmax += row_offset;
+  if (has_dropout) {
+    dropout_mask += row_offset;
+  }
+  auto load_grad = [&](int c) {
+    const accscalar_t g = static_cast<accscalar_t>(grad_output[c]);
+    return has_dropout ? (dropout_mask[c] ? g * inv_keep_prob : accscalar_t(0)) : g;
+  };
+
+  accscalar_t threadSum = 0;
+  for (int c = threadIdx.x; c < classes; c += blockDim.x) {
+    threadSum += load_grad(c) * static_cast<accscalar_t>(softmax[c]);
+  }
+  const accscalar_t sum = blockReduce<Add, accscalar_t>(
+      sdata, threadSum, Add<accscalar_t>(), accscalar_t(0));
+
+  for (int c = threadIdx.x; c < classes; c += blockDim.x) {
+    const accscalar_t y = static_cast<accscalar_t>(softmax[c]);
+    grad_input[c] = static_cast<scalar_t>(scale * y * (load_grad(c) - sum));
+  }
+}
+
+template <typename scalar_t, typename accscalar_t, typename mask_op_t>
+void launch_masked_softmax_forward(
+    Tensor& output, Tensor& softmax, Tensor& dropout_mask, const Tensor& input,
+    int64_t rows, int64_t classes, double scale, mask_op_t mask_op,
+    const OffsetCalculator<1>& mask_calc, double dropout_p, PhiloxCudaState philox_args) {
+  using acc_t = MaxSumExp<accscalar_t>;
+  const dim3 grid(rows);
+  const dim3 block = SoftMax_getBlockSize(1, classes);
+  const size_t reduce_smem = block.x * sizeof(acc_t);
+  const size_t cached_smem = reduce_smem + classes * sizeof(accscalar_t);
+  const bool cache_row = cached_smem <= at::cuda::getCurrentDeviceProperties()->sharedMemPerBlock;
+  const size_t smem = cache_row ? cached_smem : reduce_smem;
+  const accscalar_t keep_prob = 1 - dropout_p;
+  auto stream = at::cuda::getCurrentCUDAStream();
+
+#define LAUNCH_MASKED_SOFTMAX_FORWARD(CACHE_ROW, HAS_DROPOUT)                              \
+  cunn_MaskedSoftMaxForward<scalar_t, accscalar_t, mask_op_t, CACHE_ROW, HAS_DROPOUT>      \
+    <<<grid, block, smem, stream>>>(                                                      \
+      output.data_ptr<scalar_t>(),                                                        \
+      HAS_DROPOUT ? softmax.data_ptr<scalar_t>() : nullptr,                               \
+      HAS_DROPOUT ? dropout_mask.data_ptr<uint8_t>() : nullptr,                           \
+      input.data_ptr<scalar_t>(), classes, static_cast<accscalar_t>(scale),               \
+      mask_op, mask_calc, keep_prob, philox_args)
+
+  if (dropout_p > 0) {
+    if (cache_row) {
+      LAUNCH_MASKED_SOFTMAX_FORWARD(true, true);
+    } else {
+      LAUNCH_MASKED_SOFTMAX_FORWARD(false, true);
+    }
+  } else {
+    if (cache_row) {
+      LAUNCH_MASKED_SOFTMAX_FORWARD(true, false);
+    } else {
+      LAUNCH_MASKED_SOFTMAX_FORWARD(false, false);
+    }
+  }
+#undef LAUNCH_MASKED_SOFTMAX_FORWARD
+}
+
+// Each block reduces a row of logits to its cross entropy and logsumexp. The
+// logsumexp is found in a single pass like in cunn_SoftMaxForward; the label
+// smoothing takes a second pass for the dot product of the row with the class
+// weights. Nothing of the size of the row is written.
+template <int ILP, typename scalar_t, typename accscalar_t>
+__global__ void
+cunn_CrossEntropyRowsForward(scalar_t *losses, accscalar_t *logsumexp, scalar_t *input,
+                             const int64_t *target, const scalar_t *weight,
+                             const accscalar_t *weight_sum, int classes,
+                             int64_t ignore_index, accscalar_t smoothing)
+{
+  extern __shared__ unsigned char smem[];
+
+  input += static_cast<int64_t>(blockIdx.x) * classes;
+  const int shift = ((uint64_t)input) % ALIGN_BYTES / sizeof(scalar_t);
+
+  using acc_t = MaxSumExp<accscalar_t>;
+  const acc_t init = {-at::numeric_limits<accscalar_t>::max(), accscalar_t(0)};
+  acc_t threadVal = ilpReduce<OnlineSumExpFloat, ILP, scalar_t, acc_t>(
+      shift, input, classes, OnlineSumExpFloat<scalar_t, acc_t>(), init);
+  acc_t blockVal = blockReduce<MaxSumExpCombine, acc_t>(
+      reinterpret_cast<acc_t*>(smem), threadVal, MaxSumExpCombine<acc_t>(), init);
+  const accscalar_t lse = blockVal.max + std::log(blockVal.sum);
+
+  accscalar_t smooth_loss = 0;
+  if (smoothing > 0) {
+    accscalar_t threadDot = 0;
+    for (int c = threadIdx.x; c < classes; c += blockDim.x) {
+      const accscalar_t w = weight ? static_cast<accscalar_t>(weight[c]) : accscalar_t(1);
+      threadDot += w * static_cast<accscalar_t>(input[c]);
+    }
+    const accscalar_t dot = blockReduce<Add, accscalar_t>(
+        reinterpret_cast<accscalar_t*>(smem), threadDot, Add<accscalar_t>(), accscalar_t(0));
+    const accscalar_t total = weight ? *weight_sum : static_cast<accscalar_t>(classes);
+    smooth_loss = smoothing / classes * (lse * total - dot);
+  }
+
+  if (threadIdx.x == 0) {
+    const int64_t t = target[blockIdx.x];
+    logsumexp[blockIdx.x] = lse;
+    if (t == ignore_index) {
+      losses[blockIdx.x] = scalar_t(0);
+    } else {
+      CUDA_KERNEL_ASSERT(t >= 0 && t < classes && "target out of bounds");
+      const accscalar_t w = weight ? static_cast<accscalar_t>(weight[t]) : accscalar_t(1);
+      const accscalar_t x = static_cast<accscalar_t>(input[t]);
+      losses[blockIdx.x] = static_cast<scalar_t>((1 - smoothing) * w * (lse - x) + smooth_loss);
+    }
+  }
+}
+
+// The gradient of the cross entropy of a row straight from its logsumexp:
+// g * (softmax(x) * coef - (1 - smoothing) * w_t * onehot(t) - smoothing / C * w).
+template <typename scalar_t, typename accscalar_t>
+__global__ void
+cunn_CrossEntropyRowsBackward(scalar_t *grad_input, const scalar_t *grad_losses,
+                              const scalar_t *input, const int64_t *target,
+                              const scalar_t *weight, const accscalar_t *weight_sum,
+                              const accscalar_t *logsumexp, int classes,
+                              int64_t ignore_index, accscalar_t smoothing)
+{
+  const int64_t row_offset = static_cast<int64_t>(blockIdx.x) * classes;
+  grad_input += row_offset;
+  input += row_offset;
+
+  const int64_t t = target[blockIdx.x];
+  if (t == ignore_index) {
+    for (int c = threadIdx.x; c < classes; c += blockDim.x) {
+      grad_input[c] = scalar_t(0);
+    }
+    return;
+  }
+  CUDA_KERNEL_ASSERT(t >= 0 && t < classes && "target out of bounds");
+  const accscalar_t g = static_cast<accscalar_t>(grad_losses[blockIdx.x]);
+  const accscalar_t lse = logsumexp[blockIdx.x];
+  const accscalar_t target_weight = weight ? static_cast<accscalar_t>(weight[t]) : accscalar_t(1);
+  const accscalar_t total = weight ? *weight_sum : static_cast<accscalar_t>(classes);
+  const accscalar_t uniform = smoothing / classes;
+  const accscalar_t coef = (1 - smoothing) * target_weight + uniform * total;
+
+  for (int c = threadIdx.x; c < classes; c += blockDim.x) {
+    const accscalar_t w = weight ? static_cast<accscalar_t>(weight[c]) : accscalar_t(1);
+    accscalar_t grad = std::exp(static_cast<accscalar_t>(input[c]) - lse) * coef - uniform * w;
+    if (c == t) {
+      grad -= (1 - smoothing) * target_weight;
+    }
+    grad_input[c] = static_cast<scalar_t>(g * grad);
+  }
+}
+
 }
 
 Tensor log_softmax_cuda(const Tensor &input, const int64_t dim, const bool half_to_float){
@@ -888,5 +1242,188 @@ Tensor softmax_backward_cuda(const Tensor &grad, const Tensor &output, int64_t d
   return host_softmax_backward<SoftMaxBackwardEpilogue,false>(tmp, output, dim, half_to_float);
 }
 
+std::tuple<Tensor, Tensor, Tensor> masked_softmax_cuda(
+    const Tensor& self, const Tensor& mask, double scale, double dropout_p,
+    c10::optional<Generator> gen_) {
+  masked_softmax_check_inputs(self, mask, dropout_p);
+  TORCH_CHECK(cuda::detail::canUse32BitIndexMath(self),
+      "_masked_softmax: inputs with more than 2^31 elements are not supported");
+  auto input = self.contiguous();
+  Tensor output = at::empty_like(input, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  const bool has_dropout = dropout_p > 0;
+  Tensor softmax = has_dropout ? at::empty_like(input, LEGACY_CONTIGUOUS_MEMORY_FORMAT) : at::empty({0}, input.options());
+  Tensor dropout_mask = has_dropout ? at::empty(input.sizes(), input.options().dtype(kByte)) : at::empty({0}, input.options().dtype(kByte));
+  if (input.numel() == 0) {
+    return std::make_tuple(output, softmax, dropout_mask);
+  }
+
+  const int64_t classes = input.size(-1);
+  const int64_t rows = input.numel() / classes;
+
+  // Offsets of the mask row of each input row. OffsetCalculator walks the
+  // dimensions innermost first, so the outer dimensions are passed reversed.
+  Tensor expanded_mask;
+  std::vector<int64_t> outer_sizes;
+  std::vector<int64_t> outer_strides;
+  if (mask.defined()) {
+    expanded_mask = masked_softmax_expand_mask(input, mask);
+    TORCH_CHECK(cuda::detail::canUse32BitIndexMath(expanded_mask),
+        "_masked_softmax: masks with more than 2^31 elements are not supported");
+    for (int64_t d = input.dim() - 2; d >= 0; d--) {
+      outer_sizes.push_back(expanded_mask.size(d));
+      outer_strides.push_back(expanded_mask.stride(d));
+    }
+  }
+  const int64_t* strides[] = {outer_strides.data()};
+  // strides are in elements, as mask rows are indexed through typed pointers
+  auto mask_calc = OffsetCalculator<1>(outer_sizes.size(), outer_sizes.data(), strides);
+
+  PhiloxCudaState rng_engine_inputs;
+  if (has_dropout) {
+    auto gen = get_generator_or_default<CUDAGeneratorImpl>(gen_, cuda::detail::getDefaultCUDAGenerator());
+    const int64_t block_size = SoftMax_getBlockSize(1, classes).x;
+    // each thread draws one number per element it handles, four at a time
+    const int64_t counter_offset = ((classes + block_size - 1) / block_size + 3) / 4 * 4;
+    // See Note [Acquire lock when using random generators]
+    std::lock_guard<std::mutex> lock(gen->mutex_);
+    rng_engine_inputs = gen->philox_cuda_state(counter_offset);
+  }
+
+  AT_DISPATCH_FLOATING_TYPES_AND2(at::ScalarType::Half, at::ScalarType::BFloat16, input.scalar_type(), "masked_softmax", [&] {
+  AT_SKIP_BFLOAT16_IF_NOT_ROCM(scalar_t, "masked_softmax", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    if (!mask.defined()) {
+      launch_masked_softmax_forward<scalar_t, accscalar_t>(
+          output, softmax, dropout_mask, input, rows, classes, scale,
+          NoMask(), mask_calc, dropout_p, rng_engine_inputs);
+    } else if (mask.scalar_type() == ScalarType::Bool) {
+      launch_masked_softmax_forward<scalar_t, accscalar_t>(
+          output, softmax, dropout_mask, input, rows, classes, scale,
+          BoolMask{expanded_mask.data_ptr<bool>()}, mask_calc, dropout_p, rng_engine_inputs);
+    } else {
+      launch_masked_softmax_forward<scalar_t, accscalar_t>(
+          output, softmax, dropout_mask, input, rows, classes, scale,
+          AdditiveMask<scalar_t>{expanded_mask.data_ptr<scalar_t>()}, mask_calc, dropout_p, rng_engine_inputs);
+    }
+  });
+  });
+  AT_CUDA_CHECK(cudaGetLastError());
+  return std::make_tuple(output, softmax, dropout_mask);
+}
+
+Tensor masked_softmax_backward_cuda(
+    const Tensor& grad_output_, const Tensor& output, const Tensor& softmax_,
+    const Tensor& dropout_mask_, double scale, double dropout_p) {
+  const bool has_dropout = dropout_p > 0;
+  auto softmax = (has_dropout ? softmax_ : output).contiguous();
+  auto grad_output = grad_output_.contiguous();
+  TORCH_CHECK(grad_output.sizes() == softmax.sizes(),
+      "_masked_softmax_backward: expected grad_output of shape ", softmax.sizes(), ", but got ", grad_output.sizes());
+  Tensor grad_input = at::empty_like(softmax, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  if (softmax.numel() == 0) {
+    return grad_input;
+  }
+  auto dropout_mask = has_dropout ? dropout_mask_.contiguous() : dropout_mask_;
+  const int64_t classes = softmax.size(-1);
+  const int64_t rows = softmax.numel() / classes;
+  const dim3 grid(rows);
+  const dim3 block = SoftMax_getBlockSize(1, classes);
+  auto stream = at::cuda::getCurrentCUDAStream();
+
+  AT_DISPATCH_FLOATING_TYPES_AND2(at::ScalarType::Half, at::ScalarType::BFloat16, softmax.scalar_type(), "masked_softmax_backward", [&] {
+  AT_SKIP_BFLOAT16_IF_NOT_ROCM(scalar_t, "masked_softmax_backward", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    const accscalar_t inv_keep_prob = accscalar_t(1) / (1 - dropout_p);
+    if (has_dropout) {
+      cunn_MaskedSoftMaxBackward<scalar_t, accscalar_t, true>
+        <<<grid, block, block.x * sizeof(accscalar_t), stream>>>(
+          grad_input.data_ptr<scalar_t>(), grad_output.data_ptr<scalar_t>(), softmax.data_ptr<scalar_t>(),
+          dropout_mask.data_ptr<uint8_t>(), classes, static_cast<accscalar_t>(scale), inv_keep_prob);
+    } else {
+      cunn_MaskedSoftMaxBackward<scalar_t, accscalar_t, false>
+        <<<grid, block, block.x * sizeof(accscalar_t), stream>>>(
+          grad_input.data_ptr<scalar_t>(), grad_output.data_ptr<scalar_t>(), softmax.data_ptr<scalar_t>(),
+          nullptr, classes, static_cast<accscalar_t>(scale), inv_keep_prob);
+    }
+  });
+  });
+  AT_CUDA_CHECK(cudaGetLastError());
+  return grad_input;
+}
+
+std::tuple<Tensor, Tensor> cross_entropy_rows_cuda(
+    const Tensor& self, const Tensor& target, const Tensor& weight,
+    int64_t ignore_index, double label_smoothing) {
+  cross_entropy_rows_check_inputs(self, target, weight);
+  TORCH_CHECK(self.size(1) <= std::numeric_limits<int>::max(),
+      "_cross_entropy_rows: inputs with more than 2^31 classes are not supported");
+  auto input = self.contiguous();
+  auto target_ = target.contiguous();
+  auto weight_ = weight.defined() ? weight.contiguous() : weight;
+  const auto lse_type = cross_entropy_logsumexp_type(input.scalar_type());
+  Tensor losses = at::empty({input.size(0)}, input.options());
+  Tensor logsumexp = at::empty({input.size(0)}, input.options().dtype(lse_type));
+  if (input.numel() == 0) {
+    return std::make_tuple(losses.zero_(), logsumexp.fill_(-std::numeric_limits<double>::infinity()));
+  }
+  // The sum of the class weights stays on the device, so that the launch does
+  // not wait for it.
+  Tensor weight_sum = weight_.defined() ? weight_.to(lse_type).sum() : Tensor();
+
+  const int classes = input.size(1);
+  const dim3 grid(input.size(0));
+  auto stream = at::cuda::getCurrentCUDAStream();
+  AT_DISPATCH_FLOATING_TYPES_AND2(at::ScalarType::Half, at::ScalarType::BFloat16, input.scalar_type(), "cross_entropy_rows", [&] {
+  AT_SKIP_BFLOAT16_IF_NOT_ROCM(scalar_t, "cross_entropy_rows", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    constexpr int ILP = sizeof(float4) / sizeof(scalar_t);
+    const dim3 block = SoftMax_getBlockSize(ILP, classes);
+    cunn_CrossEntropyRowsForward<ILP, scalar_t, accscalar_t>
+      <<<grid, block, block.x * sizeof(MaxSumExp<accscalar_t>), stream>>>(
+        losses.data_ptr<scalar_t>(), logsumexp.data_ptr<accscalar_t>(), input.data_ptr<scalar_t>(),
+        target_.data_ptr<int64_t>(), weight_.defined() ? weight_.data_ptr<scalar_t>() : nullptr,
+        weight_sum.defined() ? weight_sum.data_ptr<accscalar_t>() : nullptr, classes,
+        ignore_index, static_cast<accscalar_t>(label_smoothing));
+  });
+  });
+  AT_CUDA_CHECK(cudaGetLastError());
+  return std::make_tuple(losses, logsumexp);
+}
+
+Tensor cross_entropy_rows_backward_cuda(
+    const Tensor& grad_losses, const Tensor& self, const Tensor& target, const Tensor& weight,
+    int64_t ignore_index, double label_smoothing, const Tensor& logsumexp) {
+  cross_entropy_rows_check_inputs(self, target, weight);
+  auto input = self.contiguous();
+  Tensor grad_input = at::empty_like(input, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  if (input.numel() == 0) {
+    return grad_input;
+  }
+  auto grad_losses_ = grad_losses.contiguous();
+  auto target_ = target.contiguous();
+  auto weight_ = weight.defined() ? weight.contiguous() : weight;
+  auto logsumexp_ = logsumexp.contiguous();
+  Tensor weight_sum = weight_.defined() ? weight_.to(logsumexp_.scalar_type()).sum() : Tensor();
+
+  const int classes = input.size(1);
+  const dim3 grid(input.size(0));
+  const dim3 block = SoftMax_getBlockSize(1, classes);
+  auto stream = at::cuda::getCurrentCUDAStream();
+  AT_DISPATCH_FLOATING_TYPES_AND2(at::ScalarType::Half, at::ScalarType::BFloat16, input.scalar_type(), "cross_entropy_rows_backward", [&] {
+  AT_SKIP_BFLOAT16_IF_NOT_ROCM(scalar_t, "cross_entropy_rows_backward", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    cunn_CrossEntropyRowsBackward<scalar_t, accscalar_t>
+      <<<grid, block, 0, stream>>>(
+        grad_input.data_ptr<scalar_t>(), grad_losses_.data_ptr<scalar_t>(), input.data_ptr<scalar_t>(),
+        target_.data_ptr<int64_t>(), weight_.defined() ? weight_.data_ptr<scalar_t>() : nullptr,
+        weight_sum.defined() ? weight_sum.data_ptr<accscalar_t>() : nullptr,
+        logsumexp_.data_ptr<accscalar_t>(), classes, ignore_index,
+        static_cast<accscalar_t>(label_smoothing));
+  });
+  });
+  AT_CUDA_CHECK(cudaGetLastError());
+  return grad_input;
+}
+
 }
 }
@@ -0,0 +1,108 @@
+#include <ATen/ATen.h>
+#include <ATen/Dispatch.h>
+#include <ATen/LegacyTHFunctionsCUDA.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/WrapDimUtils.h>
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/cub.cuh>
+
+#include <limits>
+
+namespace at { namespace native {
+
+namespace {
+
+// Slices up to this size are sorted in place by the bitonic sort of
+// THCTensorSort, one block per slice. Longer slices used to go through two
+// thrust sorts of the whole tensor; they now take a single CUB radix sort,
+// segmented when there is more than one slice.
+constexpr int64_t kMaxBitonicSortSize = 2048;
+
+bool should_use_radix_sort(const Tensor& self, int64_t dim) {
+  return self.dim() > 0 &&
+      self.size(dim) > kMaxBitonicSortSize &&
+      self.numel() <= std::numeric_limits<int>::max() &&
+      at::cuda::cub::is_radix_sortable(self.scalar_type());
+}
+
+void sort_radix_cuda(
+    const Tensor& self, int64_t dim, bool descending, Tensor& values, Tensor& indices) {
+  const int64_t nsort = self.size(dim);
+  const int64_t numel = self.numel();
+  const int64_t nsegments = numel / nsort;
+  const bool is_last_dim = dim == self.dim() - 1;
+  // The radix sort works on rows of a contiguous tensor, with the sorted
+  // dimension last.
+  Tensor self_t = is_last_dim ? self.contiguous() : self.transpose(dim, -1).contiguous();
+  // CUB can not sort in place, so sorting `self` into itself goes through a
+  // temporary as well.
+  const bool direct_out = is_last_dim && values.is_contiguous() &&
+      indices.is_contiguous() && !values.is_same(self);
+  Tensor values_t = direct_out ? values : at::empty_like(self_t, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  Tensor indices_t = direct_out ? indices : at::empty(self_t.sizes(), indices.options());
+
+  auto index_options = indices.options();
+  Tensor positions = at::arange(nsort, index_options);
+  if (nsegments > 1) {
+    positions = positions.repeat({nsegments});
+  }
+
+  AT_DISPATCH_ALL_TYPES_AND2(kBool, kHalf, self.scalar_type(), "sort_radix_cuda", [&] {
+    const scalar_t* keys_in = self_t.data_ptr<scalar_t>();
+    scalar_t* keys_out = values_t.data_ptr<scalar_t>();
+    const int64_t* values_in = positions.data_ptr<int64_t>();
+    int64_t* values_out = indices_t.data_ptr<int64_t>();
+    if (nsegments == 1) {
+      at::cuda::cub::sort_pairs(keys_in, keys_out, values_in, values_out, numel, descending);
+    } else {
+      Tensor offsets = at::arange(0, numel + 1, nsort, index_options);
+      const int64_t* offsets_ptr = offsets.data_ptr<int64_t>();
+      at::cuda::cub::segmented_sort_pairs(
+          keys_in, keys_out, values_in, values_out, numel, nsegments,
+          offsets_ptr, offsets_ptr + 1, descending);
+    }
+  });
+
+  if (!direct_out) {
+    values.copy_(is_last_dim ? values_t : values_t.transpose(dim, -1));
+    indices.copy_(is_last_dim ? indices_t : indices_t.transpose(dim, -1));
+  }
+}
+
+} // namespace
+
+std::tuple<Tensor&, Tensor&> sort_out_cuda(
+    Tensor& values,
+    Tensor& indices,
+    const Tensor& self,
+    int64_t dim_,
+    bool descending) {
+  int64_t dim = maybe_wrap_dim(dim_, self.dim(), /*wrap_scalar=*/true);
+  if (!should_use_radix_sort(self, dim)) {
+    return legacy::cuda::_th_sort_out(values, indices, self, dim, descending);
+  }
+  TORCH_CHECK(
+      self.options().type_equal(values.options()),
+      "output values must be of same type as input");
+  TORCH_CHECK(
+      indices.dtype() == kLong, "output indices must be of scalar type Long");
+  TORCH_CHECK(
+      indices.device() == self.device(),
+      "output indices must be on same device as input");
+
+  values.resize_(self.sizes());
+  indices.resize_(self.sizes());
+  sort_radix_cuda(self, dim, descending, values, indices);
+  return std::forward_as_tuple(values, indices);
+}
+
+std::tuple<Tensor, Tensor> sort_cuda(
+    const Tensor& self,
+    int64_t dim,
+    bool descending) {
+  Tensor values = at::empty({0}, self.options());
+  Tensor indices = at::empty({0}, self.options().dtype(kLong));
+  return sort_out_cuda(values, indices, self, dim, descending);
+}
+
+}} // namespace at::native
@@ -8,6 +8,7 @@
 #include <ATen/native/SpectralOpsUtils.h>
 #include <ATen/native/cuda/CuFFTUtils.h>
 #include <ATen/native/cuda/CuFFTPlanCache.h>
+#include <c10/cuda/CUDACachingAllocator.h>
 #include <THC/THCTensorSort.cuh>
 #include <THC/THCThrustAllocator.cuh>
 
@@ -17,6 +18,9 @@
 #include <cufftXt.h>
 #include <vector>
 #include <cmath>
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
 
 namespace at { namespace native {
 
@@ -172,29 +176,10 @@ static void _fft_fill_with_conjugate_symmetry_(Tensor& input,
 // tensors being contiguous, and that the strides at the innermost signal
 // dimension being unit (1) w.r.t. the corresponding data type.
 
-static inline Tensor _run_cufft(
-    const CuFFTConfig &config, Tensor& input, int64_t signal_ndim,
-    bool complex_input, bool complex_output, bool inverse,
-    IntArrayRef checked_signal_sizes, bool normalized, bool onesided,
-    IntArrayRef output_sizes, bool input_was_cloned
-) {
-  if (config.should_clone_input() && !input_was_cloned) {
-    input = input.clone(at::MemoryFormat::Contiguous);
-  }
-
-  auto& plan = config.plan();
-  auto& ctx = at::globalContext();
-
-  // set output
-  auto output = at::empty(output_sizes, input.options());
-
-  // set to current stream
-  CUFFT_CHECK(cufftSetStream(plan, at::cuda::getCurrentCUDAStream()));
-
-  auto ws = at::empty({ config.workspace_size() }, at::device(at::kCUDA).dtype(at::kByte));
-  CUFFT_CHECK(cufftSetWorkArea(plan, ws.data_ptr()));
-
-  // run
+// Executes `plan` on the data of `input` into `output`, on whatever stream and
+// workspace were set on the plan.
+static inline void _exec_cufft(const cufftHandle& plan, const Tensor& input, const Tensor& output,
+                               bool complex_input, bool complex_output, bool inverse) {
 #ifdef __HIP_PLATFORM_HCC__
   if (input.scalar_type() == ScalarType::Float) {
       if (complex_input && complex_output) {
@@ -234,7 +219,14 @@ static inline Tensor _run_cufft(
   CUFFT_CHECK(cufftXtExec(plan, input.data_ptr(), output.data_ptr(),
     inverse ? CUFFT_INVERSE : CUFFT_FORWARD));
 #endif
+}
 
+// Rescales `output` as needed by the normalized flag or an inverse transform,
+// and fills out the other half of twosided real-to-complex transforms using
+// conjugate symmetry.
+static inline void _finalize_cufft_output(
+    Tensor& output, int64_t signal_ndim, bool complex_input, bool complex_output,
+    bool inverse, IntArrayRef checked_signal_sizes, bool normalized, bool onesided) {
   // rescale if needed by normalized flag or inverse transform
   auto size_last_signal_dim = checked_signal_sizes[signal_ndim - 1];
   if (normalized || inverse) {
@@ -258,16 +250,168 @@ static inline Tensor _run_cufft(
     auto start_slice = infer_ft_real_to_complex_onesided_size(size_last_signal_dim);
     _fft_fill_with_conjugate_symmetry_(output, size_last_signal_dim, start_slice);
   }
+}
+
+static inline Tensor _run_cufft(
+    const CuFFTConfig &config, Tensor& input, int64_t signal_ndim,
+    bool complex_input, bool complex_output, bool inverse,
+    IntArrayRef checked_signal_sizes, bool normalized, bool onesided,
+    IntArrayRef output_sizes, bool input_was_cloned
+) {
+  if (config.should_clone_input() && !input_was_cloned) {
+    input = input.clone(at::MemoryFormat::Contiguous);
+  }
+
+  auto& plan = config.plan();
+
+  // set output
+  auto output = at::empty(output_sizes, input.options());
+
+  // set to current stream
+  CUFFT_CHECK(cufftSetStream(plan, at::cuda::getCurrentCUDAStream()));
+
+  // The workspace comes from the caching allocator on the current stream, so
+  // it is released for reuse as soon as the transform has been enqueued.
+  auto ws = c10::cuda::CUDACachingAllocator::get()->allocate(config.workspace_size());
+  CUFFT_CHECK(cufftSetWorkArea(plan, ws.get()));
+
+  // run
+  _exec_cufft(plan, input, output, complex_input, complex_output, inverse);
+
+  _finalize_cufft_output(output, signal_ndim, complex_input, complex_output,
+                         inverse, checked_signal_sizes, normalized, onesided);
+  return output;
+}
+
+// NOTE [ cuFFT Batched Plans ]
+//
+// A cuFFT plan is made for a fixed batch size, and the batch size is part of
+// the plan cache key. A workload whose batch varies from call to call, e.g.,
+// stft of clips of different lengths, where the batch is the number of
+// frames, would thus create and cache a new plan for almost every call.
+//
+// Instead, 1-D transforms with a batch of at least kMinBatchedPlanSize split
+// their batch into chunks by its binary representation: one chunk for every
+// set bit of weight >= kMinBatchedPlanSize, largest first, plus a chunk of
+// the remaining (batch % kMinBatchedPlanSize) signals at the end. Every chunk
+// is executed with the plan for its own batch size. For a given signal
+// geometry there are then at most log2(batch) + kMinBatchedPlanSize - 1
+// distinct plans, shared by all batch sizes, at the cost of one cuFFT
+// execution per chunk. Since all chunks but the last one have sizes that are
+// multiples of kMinBatchedPlanSize, every chunk starts at an even offset and
+// keeps the alignment of input and output.
+constexpr int64_t kMinBatchedPlanSize = 16;
+
+static inline std::vector<int64_t> _cufft_batch_chunk_sizes(int64_t batch) {
+  int64_t chunk_size = kMinBatchedPlanSize;
+  while (chunk_size <= batch / 2) {
+    chunk_size *= 2;
+  }
+  std::vector<int64_t> chunk_sizes;
+  for (; chunk_size >= kMinBatchedPlanSize; chunk_size /= 2) {
+    if (batch & chunk_size) {
+      chunk_sizes.push_back(chunk_size);
+    }
+  }
+  if (batch % kMinBatchedPlanSize != 0) {
+    chunk_sizes.push_back(batch % kMinBatchedPlanSize);
+  }
+  return chunk_sizes;
+}
+
+// Runs the transform as a sequence of chunks planned through `plan_cache`.
+// See NOTE [ cuFFT Batched Plans ]. Must be called with plan_cache.mutex held.
+static inline Tensor _run_cufft_batched(
+    CuFFTParamsLRUCache& plan_cache, Tensor& input, int64_t signal_ndim,
+    bool complex_input, bool complex_output, bool inverse,
+    IntArrayRef checked_signal_sizes, bool normalized, bool onesided,
+    IntArrayRef output_sizes, bool input_was_cloned
+) {
+  auto chunk_sizes = _cufft_batch_chunk_sizes(input.size(0));
+  std::vector<int64_t> chunk_output_sizes(output_sizes.begin(), output_sizes.end());
+
+  // The configs stay alive through the shared_ptr even if looking up a later
+  // chunk evicts them from the cache.
+  std::vector<std::shared_ptr<const CuFFTConfig>> configs;
+  configs.reserve(chunk_sizes.size());
+  int64_t ws_size = 0;
+  for (auto chunk_size : chunk_sizes) {
+    auto input_chunk = input.narrow(0, 0, chunk_size);
+    chunk_output_sizes[0] = chunk_size;
+    CuFFTParams params;
+    setCuFFTParams(&params, input_chunk, signal_ndim, complex_input,
+      complex_output, checked_signal_sizes, onesided);
+    configs.push_back(plan_cache.try_emplace_value(std::move(params),
+                                                   input_chunk, signal_ndim, complex_input,
+                                                   complex_output, checked_signal_sizes,
+                                                   onesided, chunk_output_sizes));
+    ws_size = std::max(ws_size, configs.back()->workspace_size());
+  }
+
+  // The clone decision only depends on the strides, which all chunks share.
+  // A plan cached under a key that ignores the batch stride of a single
+  // signal could still disagree, in which case the chunks can't share one
+  // input and we fall back to one plan for the whole batch.
+  const bool should_clone_input = configs[0]->should_clone_input();
+  for (const auto& config : configs) {
+    if (config->should_clone_input() != should_clone_input) {
+      CuFFTConfig whole_config(input, signal_ndim, complex_input, complex_output,
+                               checked_signal_sizes, onesided, output_sizes);
+      return _run_cufft(whole_config, input, signal_ndim, complex_input,
+                        complex_output, inverse, checked_signal_sizes, normalized,
+                        onesided, output_sizes, input_was_cloned);
+    }
+  }
+
+  if (should_clone_input && !input_was_cloned) {
+    input = input.clone(at::MemoryFormat::Contiguous);
+  }
+  auto output = at::empty(output_sizes, input.options());
+
+  // The chunks run one after the other on the current stream, so they share
+  // one workspace sized for the largest of them.
+  cudaStream_t stream = at::cuda::getCurrentCUDAStream();
+  auto ws = c10::cuda::CUDACachingAllocator::get()->allocate(ws_size);
+
+  int64_t start = 0;
+  for (size_t i = 0; i < chunk_sizes.size(); i++) {
+    auto& plan = configs[i]->plan();
+    CUFFT_CHECK(cufftSetStream(plan, stream));
+    CUFFT_CHECK(cufftSetWorkArea(plan, ws.get()));
+    _exec_cufft(plan, input.narrow(0, start, chunk_sizes[i]),
+                output.narrow(0, start, chunk_sizes[i]),
+                complex_input, complex_output, inverse);
+    start += chunk_sizes[i];
+  }
+
+  _finalize_cufft_output(output, signal_ndim, complex_input, complex_output,
+                         inverse, checked_signal_sizes, normalized, onesided);
   return output;
 }
 
-// The cuFFT plan cache
+// The cuFFT plan caches
+//
+// A plan records the stream and workspace it runs with, so concurrent
+// transforms must not share a plan. Each (device, stream) pair has its own
+// LRU cache with its own mutex: transforms on different streams never wait
+// for each other, and the lock only serializes threads that enqueue work on
+// the same stream, which would run one after the other anyway. All caches of
+// a device share the capacity set through cufft_set_plan_cache_max_size; the
+// size and hit/miss statistics of a device are summed over its streams.
+struct CuFFTDevicePlanCaches {
+  // guards max_size and caches, but not the contents of the caches
+  std::mutex mutex;
+  int64_t max_size = CUFFT_DEFAULT_CACHE_SIZE;
+  // unique_ptr to avoid reference invalidation on rehash
+  std::unordered_map<c10::StreamId, std::unique_ptr<CuFFTParamsLRUCache>> caches;
+};
+
 // unique_ptr for nullability and to avoid reference invalidation on vector resize
-static std::vector<std::unique_ptr<CuFFTParamsLRUCache>> plan_caches;
+static std::vector<std::unique_ptr<CuFFTDevicePlanCaches>> plan_caches;
 static std::mutex plan_caches_mutex;
 
 static inline
-CuFFTParamsLRUCache &cufft_get_plan_cache(int64_t device_index) {
+CuFFTDevicePlanCaches &cufft_get_device_plan_caches(int64_t device_index) {
   std::lock_guard<std::mutex> guard(plan_caches_mutex);
 
   AT_ASSERT(device_index >= 0);
@@ -277,45 +421,97 @@ CuFFTParamsLRUCache &cufft_get_plan_cache(int64_t device_index) {
   }
 
   if (!plan_caches[device_index]) {
-    plan_caches[device_index] = std::make_unique<CuFFTParamsLRUCache>();
+    plan_caches[device_index] = std::make_unique<CuFFTDevicePlanCaches>();
   }
 
   return *plan_caches[device_index];
 }
 
+static inline
+CuFFTParamsLRUCache &cufft_get_plan_cache(int64_t device_index, c10::StreamId stream_id) {
+  auto& device_caches = cufft_get_device_plan_caches(device_index);
+  std::lock_guard<std::mutex> guard(device_caches.mutex);
 
-namespace detail {
+  auto& plan_cache = device_caches.caches[stream_id];
+  if (!plan_cache) {
+    plan_cache = std::make_unique<CuFFTParamsLRUCache>(device_caches.max_size);
+  }
+  return *plan_cache;
+}
 
-int64_t cufft_get_plan_cache_max_size_impl(int64_t device_index) {
+// Calls `fn` on every plan cache of the device, with the cache locked.
+template <typename Fn>
+static inline void cufft_for_each_plan_cache(int64_t device_index, const Fn& fn) {
+  auto& device_caches = cufft_get_device_plan_caches(device_index);
+  std::lock_guard<std::mutex> guard(device_caches.mutex);
+  for (auto& stream_and_cache : device_caches.caches) {
+    auto& plan_cache = *stream_and_cache.second;
+    std::lock_guard<std::mutex> cache_guard(plan_cache.mutex);
+    fn(plan_cache);
+  }
+}
+
+static inline void cufft_check_device_index(const char* fn_name, int64_t device_index) {
   TORCH_CHECK(0 <= device_index && device_index < at::detail::getCUDAHooks().getNumGPUs(),
-    "cufft_get_plan_cache_max_size: expected 0 <= device_index < ",
+    fn_name, ": expected 0 <= device_index < ",
     at::detail::getCUDAHooks().getNumGPUs(), "], but got device_index=",
     device_index);
-  return cufft_get_plan_cache(device_index).max_size();
+}
+
+namespace detail {
+
+int64_t cufft_get_plan_cache_max_size_impl(int64_t device_index) {
+  cufft_check_device_index("cufft_get_plan_cache_max_size", device_index);
+  auto& device_caches = cufft_get_device_plan_caches(device_index);
+  std::lock_guard<std::mutex> guard(device_caches.mutex);
+  return device_caches.max_size;
 }
 
 void cufft_set_plan_cache_max_size_impl(int64_t device_index, int64_t max_size) {
-  TORCH_CHECK(0 <= device_index && device_index < at::detail::getCUDAHooks().getNumGPUs(),
-    "cufft_set_plan_cache_max_size: expected 0 <= device_index < ",
-    at::detail::getCUDAHooks().getNumGPUs(), "], but got device_index=",
-    device_index);
-  return cufft_get_plan_cache(device_index).resize(max_size);
+  cufft_check_device_index("cufft_set_plan_cache_max_size", device_index);
+  CuFFTParamsLRUCache::check_max_size(max_size);
+  auto& device_caches = cufft_get_device_plan_caches(device_index);
+  std::lock_guard<std::mutex> guard(device_caches.mutex);
+  device_caches.max_size = max_size;
+  for (auto& stream_and_cache : device_caches.caches) {
+    auto& plan_cache = *stream_and_cache.second;
+    std::lock_guard<std::mutex> cache_guard(plan_cache.mutex);
+    plan_cache.resize(max_size);
+  }
 }
 
 int64_t cufft_get_plan_cache_size_impl(int64_t device_index) {
-  TORCH_CHECK(0 <= device_index && device_index < at::detail::getCUDAHooks().getNumGPUs(),
-    "cufft_get_plan_cache_size: expected 0 <= device_index < ",
-    at::detail::getCUDAHooks().getNumGPUs(), "], but got device_index=",
-    device_index);
-  return cufft_get_plan_cache(device_index).size();
+  cufft_check_device_index("cufft_get_plan_cache_size", device_index);
+  int64_t size = 0;
+  cufft_for_each_plan_cache(device_index, [&](const CuFFTParamsLRUCache& plan_cache) {
+    size += plan_cache.size();
+  });
+  return size;
+}
+
+int64_t cufft_get_plan_cache_hits_impl(int64_t device_index) {
+  cufft_check_device_index("cufft_get_plan_cache_hits", device_index);
+  int64_t hits = 0;
+  cufft_for_each_plan_cache(device_index, [&](const CuFFTParamsLRUCache& plan_cache) {
+    hits += plan_cache.hits();
+  });
+  return hits;
+}
+
+int64_t cufft_get_plan_cache_misses_impl(int64_t device_index) {
+  cufft_check_device_index("cufft_get_plan_cache_misses", device_index);
+  int64_t misses = 0;
+  cufft_for_each_plan_cache(device_index, [&](const CuFFTParamsLRUCache& plan_cache) {
+    misses += plan_cache.misses();
+  });
+  return misses;
 }
 
 void cufft_clear_plan_cache_impl(int64_t device_index) {
-  TORCH_CHECK(0 <= device_index && device_index < at::detail::getCUDAHooks().getNumGPUs(),
-    "cufft_clear_plan_cache: expected 0 <= device_index < ",
-    at::detail::getCUDAHooks().getNumGPUs(), "], but got device_index=",
-    device_index);
-  return cufft_get_plan_cache(device_index).clear();
+  cufft_check_device_index("cufft_clear_plan_cache", device_index);
+  cufft_for_each_plan_cache(device_index, [](CuFFTParamsLRUCache& plan_cache) {
+    plan_cache.clear();
+  });
 }
 
 } // namespace at::native::detail
@@ -327,7 +523,8 @@ Tensor _fft_cufft(const Tensor& self, int64_t signal_ndim,
                   IntArrayRef checked_signal_sizes, bool normalized, bool onesided,
                   IntArrayRef output_sizes) {
 
-  CuFFTParamsLRUCache& plan_cache = cufft_get_plan_cache(self.device().index());
+  CuFFTParamsLRUCache& plan_cache = cufft_get_plan_cache(
+      self.device().index(), at::cuda::getCurrentCUDAStream().id());
 
   Tensor input = self;
   bool input_was_cloned = false;
@@ -370,13 +567,22 @@ Tensor _fft_cufft(const Tensor& self, int64_t signal_ndim,
     CuFFTParams params;
     setCuFFTParams(&params, input, signal_ndim, complex_input,
       complex_output, checked_signal_sizes, onesided);
+    // The plan is only used by transforms on the current stream. The lock is
+    // held through the execution, as the plan's stream and workspace are set
+    // right before it.
     std::lock_guard<std::mutex> guard(plan_cache.mutex);
     if (plan_cache.max_size() > 0) {  // check again after acquiring the lock
-      const CuFFTConfig &config = plan_cache.try_emplace_value(std::move(params),
-                                             input, signal_ndim, complex_input,
-                                             complex_output, checked_signal_sizes,
-                                             onesided, output_sizes);
-      return _run_cufft(config, input, signal_ndim, complex_input,
+      // See NOTE [ cuFFT Batched Plans ].
+      if (signal_ndim == 1 && input.size(0) >= kMinBatchedPlanSize) {
+        return _run_cufft_batched(plan_cache, input, signal_ndim, complex_input,
+                                  complex_output, inverse, checked_signal_sizes,
+                                  normalized, onesided, output_sizes, input_was_cloned);
+      }
+      auto config = plan_cache.try_emplace_value(std::move(params),
+                                                 input, signal_ndim, complex_input,
+                                                 complex_output, checked_signal_sizes,
+                                                 onesided, output_sizes);
+      return _run_cufft(*config, input, signal_ndim, complex_input,
                         complex_output, inverse, checked_signal_sizes, normalized,
                         onesided, output_sizes, input_was_cloned);
     }
@@ -1,11 +1,13 @@
 #include <ATen/ATen.h>
 #include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/cub.cuh>
 #include <THC/THCGeneral.h>
 #include <THC/THCThrustAllocator.cuh>
 #include <thrust/execution_policy.h>
 
 #include <tuple>
 #include <iterator>
+#include <limits>
 #include <thrust/adjacent_difference.h>
 #include <thrust/unique.h>
 #include <thrust/sort.h>
@@ -118,6 +120,94 @@ std::tuple<Tensor, Tensor, Tensor> unique_cuda_template(
   return std::tuple<Tensor, Tensor, Tensor>(output, inverse_indices, counts);
 }
 
+// Unique of a flattened tensor through CUB: one radix sort (skipped when
+// consecutive), then a single run length encoding pass that produces both
+// the unique values and their counts. The inverse comes from a scan of the
+// run starts, scattered back through the sort permutation.
+template <typename scalar_t>
+std::tuple<Tensor, Tensor, Tensor> unique_cuda_cub_template(
+  const Tensor& self,
+  const bool consecutive,
+  const bool return_inverse,
+  const bool return_counts
+) {
+  auto options = self.options().dtype(kLong);
+  Tensor input = self.contiguous().reshape(-1);
+  int64_t num_inp = input.numel();
+
+  Tensor sorted;
+  Tensor sorted_indices;
+  if (consecutive) {
+    sorted = input;
+  } else {
+    sorted = at::empty_like(input, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+    if (return_inverse) {
+      Tensor positions = at::arange(num_inp, options);
+      sorted_indices = at::empty({num_inp}, options);
+      at::cuda::cub::sort_pairs(
+          input.data_ptr<scalar_t>(), sorted.data_ptr<scalar_t>(),
+          positions.data_ptr<int64_t>(), sorted_indices.data_ptr<int64_t>(), num_inp);
+    } else {
+      at::cuda::cub::sort_keys(input.data_ptr<scalar_t>(), sorted.data_ptr<scalar_t>(), num_inp);
+    }
+  }
+
+  Tensor output = at::empty({num_inp}, self.options());
+  Tensor counts = at::empty({return_counts ? num_inp : 0}, options);
+  Tensor num_out_tensor = at::empty({1}, options);
+  if (return_counts) {
+    at::cuda::cub::run_length_encode(
+        sorted.data_ptr<scalar_t>(), output.data_ptr<scalar_t>(), counts.data_ptr<int64_t>(),
+        num_out_tensor.data_ptr<int64_t>(), num_inp);
+  } else {
+    at::cuda::cub::unique(
+        sorted.data_ptr<scalar_t>(), output.data_ptr<scalar_t>(),
+        num_out_tensor.data_ptr<int64_t>(), num_inp);
+  }
+
+  Tensor inverse_indices;
+  if (!return_inverse || num_inp == 0) {
+    inverse_indices = at::empty({0}, options);
+  } else {
+    // inv_loc[i] is the number of runs that start in sorted[1..i].
+    Tensor inv_loc = at::zeros({num_inp}, options);
+    inv_loc.narrow(0, 1, num_inp - 1).copy_(
+        sorted.narrow(0, 1, num_inp - 1).ne(sorted.narrow(0, 0, num_inp - 1)));
+    inv_loc = inv_loc.cumsum(0);
+    if (consecutive) {
+      inverse_indices = inv_loc;
+    } else {
+      inverse_indices = at::empty({num_inp}, options);
+      inverse_indices.scatter_(0, sorted_indices, inv_loc);
+    }
+  }
+
+  const int64_t num_out = num_out_tensor.item<int64_t>();
+  output.resize_(num_out);
+  if (return_counts) {
+    counts.resize_(num_out);
+  }
+  if (return_inverse) {
+    inverse_indices.resize_(self.sizes());
+  }
+  return std::tuple<Tensor, Tensor, Tensor>(output, inverse_indices, counts);
+}
+
+// The CUB path handles up to INT_MAX elements; larger inputs go through
+// thrust.
+template <typename scalar_t>
+std::tuple<Tensor, Tensor, Tensor> unique_cuda_dispatch(
+  const Tensor& self,
+  const bool consecutive,
+  const bool return_inverse,
+  const bool return_counts
+) {
+  if (self.numel() <= std::numeric_limits<int>::max()) {
+    return unique_cuda_cub_template<scalar_t>(self, consecutive, return_inverse, return_counts);
+  }
+  return unique_cuda_template<scalar_t>(self, consecutive, return_inverse, return_counts);
+}
+
 template <typename scalar_t>
 std::tuple<Tensor, Tensor, Tensor> unique_dim_cuda_template(
   const Tensor& self,
@@ -225,7 +315,7 @@ _unique_cuda(const Tensor& self, const bool sorted, const bool return_inverse) {
     // The current CUDA implementation of unique always sort due to the
     // lack of hashtable implementation in thrust
     Tensor output, inverse;
-    std::tie(output, inverse, std::ignore) = unique_cuda_template<scalar_t>(self, false, return_inverse, false);
+    std::tie(output, inverse, std::ignore) = unique_cuda_dispatch<scalar_t>(self, false, return_inverse, false);
     return std::make_tuple(output, inverse);
   });
 }
@@ -235,7 +325,7 @@ _unique2_cuda(const Tensor& self, const bool sorted, const bool return_inverse,
   return AT_DISPATCH_ALL_TYPES_AND2(kBool, kHalf, self.scalar_type(), "unique", [&] {
     // The current CUDA implementation of unique always sort due to the
     // lack of hashtable implementation in thrust
-    return unique_cuda_template<scalar_t>(self, false, return_inverse, return_counts);
+    return unique_cuda_dispatch<scalar_t>(self, false, return_inverse, return_counts);
   });
 }
 
@@ -259,7 +349,7 @@ unique_consecutive_cuda(const Tensor& self, const bool return_inverse, const boo
     return AT_DISPATCH_ALL_TYPES_AND2(kBool, kHalf, self.scalar_type(), "unique", [&] {
       // The current CUDA implementation of unique always sort due to the
       // lack of hashtable implementation in thrust
-      return unique_cuda_template<scalar_t>(self, true, return_inverse, return_counts);
+      return unique_cuda_dispatch<scalar_t>(self, true, return_inverse, return_counts);
     });
   }
   return unique_dim_consecutive_cuda(self, dim.value(), return_inverse, return_counts);
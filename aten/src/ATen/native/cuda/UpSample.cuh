@@ -1,6 +1,7 @@
 #include <ATen/ATen.h>
 #include <ATen/TensorUtils.h>
 #include <ATen/cuda/CUDAApplyUtils.cuh>
+#include <ATen/native/cuda/MemoryAccess.cuh>
 #include <THC/THCAtomics.cuh>
 
 #include <math.h>
@@ -257,6 +258,36 @@ __device__ __forceinline__ static int nearest_neighbor_bw_compute_source_index(
   return src_index;
 }
 
+// The offset of element (n, c, h, w) of a 4-D channels-last (NHWC) tensor.
+__device__ __forceinline__ static size_t idx_cl(
+    const size_t n,
+    const size_t h,
+    const size_t w,
+    const size_t c,
+    const size_t height,
+    const size_t width,
+    const size_t channels) {
+  return ((n * height + h) * width + w) * channels + c;
+}
+
+// The number of channels the channels-last kernels load and store at a time:
+// 4 when the number of channels and the alignment of the data allow it, 1
+// otherwise.
+template <typename scalar_t>
+static inline int upsample_channels_last_vec_size(
+    int64_t channels,
+    const Tensor& input,
+    const Tensor& output) {
+  if (channels % 4 == 0 &&
+      memory::can_vectorize_up_to<scalar_t>(
+          static_cast<char*>(input.data_ptr())) >= 4 &&
+      memory::can_vectorize_up_to<scalar_t>(
+          static_cast<char*>(output.data_ptr())) >= 4) {
+    return 4;
+  }
+  return 1;
+}
+
 /* Used by UpSampleBicubic2d.cu */
 template <typename scalar_t>
 __device__ __forceinline__ static scalar_t upsample_get_value_bounded(
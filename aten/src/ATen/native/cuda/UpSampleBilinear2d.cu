@@ -151,6 +151,135 @@ __global__ void upsample_bilinear2d_backward_out_frame(
   }
 }
 
+// The channels-last version of upsample_bilinear2d_out_frame: a thread
+// interpolates vec_size channels of an output pixel, so that the threads of a
+// warp access consecutive channels.
+template <typename scalar_t, typename accscalar_t, int vec_size>
+C10_LAUNCH_BOUNDS_1(1024)
+__global__ void upsample_bilinear2d_nhwc_out_frame(
+    const accscalar_t rheight,
+    const accscalar_t rwidth,
+    const bool align_corners,
+    const int channels,
+    const int height1,
+    const int width1,
+    const int height2,
+    const int width2,
+    const scalar_t* __restrict__ idata,
+    scalar_t* __restrict__ odata,
+    const size_t out_numel) {
+  using vec_t = memory::aligned_vector<scalar_t, vec_size>;
+
+  const size_t index =
+      (static_cast<size_t>(blockIdx.x) * blockDim.x + threadIdx.x) * vec_size;
+  if (index >= out_numel) {
+    return;
+  }
+
+  const int c = index % channels;
+  const int w2 = (index / channels) % width2;
+  const int h2 = (index / channels / width2) % height2;
+  const size_t n = index / channels / width2 / height2;
+  //
+  const accscalar_t h1r = area_pixel_compute_source_index<accscalar_t>(
+      rheight, h2, align_corners, /*cubic=*/false);
+  const int h1 = h1r;
+  const int h1p = (h1 < height1 - 1) ? 1 : 0;
+  const accscalar_t h1lambda = h1r - h1;
+  const accscalar_t h0lambda = static_cast<accscalar_t>(1) - h1lambda;
+  //
+  const accscalar_t w1r = area_pixel_compute_source_index<accscalar_t>(
+      rwidth, w2, align_corners, /*cubic=*/false);
+  const int w1 = w1r;
+  const int w1p = (w1 < width1 - 1) ? 1 : 0;
+  const accscalar_t w1lambda = w1r - w1;
+  const accscalar_t w0lambda = static_cast<accscalar_t>(1) - w1lambda;
+  //
+  const vec_t v00 = *reinterpret_cast<const vec_t*>(
+      idata + idx_cl(n, h1, w1, c, height1, width1, channels));
+  const vec_t v01 = *reinterpret_cast<const vec_t*>(
+      idata + idx_cl(n, h1, w1 + w1p, c, height1, width1, channels));
+  const vec_t v10 = *reinterpret_cast<const vec_t*>(
+      idata + idx_cl(n, h1 + h1p, w1, c, height1, width1, channels));
+  const vec_t v11 = *reinterpret_cast<const vec_t*>(
+      idata + idx_cl(n, h1 + h1p, w1 + w1p, c, height1, width1, channels));
+  vec_t out;
+#pragma unroll
+  for (int i = 0; i < vec_size; i++) {
+    const accscalar_t val = h0lambda *
+            (w0lambda * v00.val[i] + w1lambda * v01.val[i]) +
+        h1lambda * (w0lambda * v10.val[i] + w1lambda * v11.val[i]);
+    out.val[i] = static_cast<scalar_t>(val);
+  }
+  *reinterpret_cast<vec_t*>(odata + index) = out;
+}
+
+// The channels-last version of upsample_bilinear2d_backward_out_frame: the
+// threads of a warp accumulate consecutive channels of grad_input.
+template <typename scalar_t, typename accscalar_t>
+C10_LAUNCH_BOUNDS_1(1024)
+__global__ void upsample_bilinear2d_backward_nhwc_out_frame(
+    const int channels,
+    const int height1,
+    const int width1,
+    const int height2,
+    const int width2,
+    const accscalar_t rheight,
+    const accscalar_t rwidth,
+    const bool align_corners,
+    scalar_t* __restrict__ idata,
+    const scalar_t* __restrict__ odata,
+    const size_t o_numel,
+    const size_t i_numel) {
+  for (size_t index = blockDim.x * blockIdx.x + threadIdx.x; index < o_numel;
+       index += blockDim.x * gridDim.x) {
+    const int c = index % channels;
+    const int w2 = (index / channels) % width2;
+    const int h2 = (index / channels / width2) % height2;
+    const size_t n = index / channels / width2 / height2;
+    //
+    const accscalar_t h1r = area_pixel_compute_source_index<accscalar_t>(
+        rheight, h2, align_corners, /*cubic=*/false);
+    const int h1 = h1r;
+    const int h1p = (h1 < height1 - 1) ? 1 : 0;
+    const accscalar_t h1lambda = h1r - h1;
+    const accscalar_t h0lambda = static_cast<accscalar_t>(1) - h1lambda;
+    //
+    const accscalar_t w1r = area_pixel_compute_source_index<accscalar_t>(
+        rwidth, w2, align_corners, /*cubic=*/false);
+    const int w1 = w1r;
+    const int w1p = (w1 < width1 - 1) ? 1 : 0;
+    const accscalar_t w1lambda = w1r - w1;
+    const accscalar_t w0lambda = static_cast<accscalar_t>(1) - w1lambda;
+    //
+    const scalar_t d2val = odata[index];
+    fastAtomicAdd(
+        idata,
+        idx_cl(n, h1, w1, c, height1, width1, channels),
+        i_numel,
+        static_cast<scalar_t>(h0lambda * w0lambda * d2val),
+        true);
+    fastAtomicAdd(
+        idata,
+        idx_cl(n, h1, w1 + w1p, c, height1, width1, channels),
+        i_numel,
+        static_cast<scalar_t>(h0lambda * w1lambda * d2val),
+        true);
+    fastAtomicAdd(
+        idata,
+        idx_cl(n, h1 + h1p, w1, c, height1, width1, channels),
+        i_numel,
+        static_cast<scalar_t>(h1lambda * w0lambda * d2val),
+        true);
+    fastAtomicAdd(
+        idata,
+        idx_cl(n, h1 + h1p, w1 + w1p, c, height1, width1, channels),
+        i_numel,
+        static_cast<scalar_t>(h1lambda * w1lambda * d2val),
+        true);
+  }
+}
+
 static void upsample_bilinear2d_out_cuda_template(
     Tensor& output,
     const Tensor& input,
@@ -184,17 +313,69 @@ static void upsample_bilinear2d_out_cuda_template(
       output_height,
       output_width);
 
-  output.resize_({input.size(0), input.size(1), output_height, output_width});
-
   AT_ASSERT(
       input_height > 0 && input_width > 0 && output_height > 0 &&
       output_width > 0);
 
-  const int num_kernels = output_height * output_width;
   const int num_threads = std::min(
       at::cuda::getCurrentDeviceProperties()->maxThreadsPerBlock, 1024);
   cudaStream_t stream = at::cuda::getCurrentCUDAStream();
 
+  // Channels-last inputs get channels-last outputs, see
+  // upsample_bilinear2d_nhwc_out_frame.
+  if (input.suggest_memory_format() == at::MemoryFormat::ChannelsLast) {
+    const Tensor input_cl = input.contiguous(at::MemoryFormat::ChannelsLast);
+    output.resize_(
+        {nbatch, channels, output_height, output_width},
+        at::MemoryFormat::ChannelsLast);
+    if (output.numel() == 0) {
+      return;
+    }
+    const size_t out_numel = output.numel();
+
+    AT_DISPATCH_FLOATING_TYPES_AND_HALF(
+        input.scalar_type(), "upsample_bilinear2d_nhwc_out_frame", [&] {
+          using accscalar_t = at::acc_type<scalar_t, true>;
+
+          const int vec_size = upsample_channels_last_vec_size<scalar_t>(
+              channels, input_cl, output);
+          const size_t num_blocks = cuda::ATenCeilDiv(
+              out_numel / vec_size, static_cast<size_t>(num_threads));
+          TORCH_CHECK(
+              num_blocks <= at::cuda::getCurrentDeviceProperties()->maxGridSize[0],
+              "input tensor has spatial dimension larger than the kernel capacity");
+
+          auto idata = input_cl.data_ptr<scalar_t>();
+          auto odata = output.data_ptr<scalar_t>();
+
+          const accscalar_t rheight = area_pixel_compute_scale<accscalar_t>(
+              input_height, output_height, align_corners, scales_h);
+          const accscalar_t rwidth = area_pixel_compute_scale<accscalar_t>(
+              input_width, output_width, align_corners, scales_w);
+
+          if (vec_size == 4) {
+            upsample_bilinear2d_nhwc_out_frame<scalar_t, accscalar_t, 4>
+                <<<num_blocks, num_threads, 0, stream>>>(
+                    rheight, rwidth, align_corners, channels, input_height,
+                    input_width, output_height, output_width, idata, odata,
+                    out_numel);
+          } else {
+            upsample_bilinear2d_nhwc_out_frame<scalar_t, accscalar_t, 1>
+                <<<num_blocks, num_threads, 0, stream>>>(
+                    rheight, rwidth, align_corners, channels, input_height,
+                    input_width, output_height, output_width, idata, odata,
+                    out_numel);
+          }
+        });
+
+    AT_CUDA_CHECK(cudaGetLastError());
+    return;
+  }
+
+  output.resize_({input.size(0), input.size(1), output_height, output_width});
+
+  const int num_kernels = output_height * output_width;
+
   AT_DISPATCH_FLOATING_TYPES_AND_HALF(
       input.scalar_type(), "upsample_bilinear2d_out_frame", [&] {
         using accscalar_t = at::acc_type<scalar_t, true>;
@@ -260,15 +441,16 @@ static void upsample_bilinear2d_backward_out_cuda_template(
       output_height,
       output_width);
 
-  Tensor grad_output = grad_output_.contiguous();
+  // Channels-last gradients are accumulated into a channels-last grad_input,
+  // see upsample_bilinear2d_backward_nhwc_out_frame.
+  const auto memory_format = grad_output_.suggest_memory_format();
+  Tensor grad_output = grad_output_.contiguous(memory_format);
 
-  grad_input.resize_({nbatch, channels, input_height, input_width});
+  grad_input.resize_({nbatch, channels, input_height, input_width}, memory_format);
   if (grad_input.numel() == 0) {
     return;
   }
 
-  // A contiguous tensor is required for the kernel launch config
-  grad_input.contiguous();
   // initialization to zero is required here. As we launch one thread per output
   // element, and atomicAdd to input gradient. Given a sparse sampling case, our
   // threads are not covering the whole input tensor.
@@ -279,6 +461,42 @@ static void upsample_bilinear2d_backward_out_cuda_template(
       at::cuda::getCurrentDeviceProperties()->maxThreadsPerBlock, 1024);
   cudaStream_t stream = at::cuda::getCurrentCUDAStream();
 
+  if (memory_format == at::MemoryFormat::ChannelsLast) {
+    AT_DISPATCH_FLOATING_TYPES_AND_HALF(
+        grad_output.scalar_type(), "upsample_bilinear2d_backward_nhwc_out_frame", [&] {
+          using accscalar_t = at::acc_type<scalar_t, true>;
+
+          auto idata = grad_input.data_ptr<scalar_t>();
+          auto odata = grad_output.data_ptr<scalar_t>();
+
+          const accscalar_t rheight = area_pixel_compute_scale<accscalar_t>(
+              input_height, output_height, align_corners, scales_h);
+          const accscalar_t rwidth = area_pixel_compute_scale<accscalar_t>(
+              input_width, output_width, align_corners, scales_w);
+
+          upsample_bilinear2d_backward_nhwc_out_frame<scalar_t, accscalar_t>
+              <<<cuda::ATenCeilDiv(num_kernels, static_cast<size_t>(num_threads)),
+                 num_threads,
+                 0,
+                 stream>>>(
+                  channels,
+                  input_height,
+                  input_width,
+                  output_height,
+                  output_width,
+                  rheight,
+                  rwidth,
+                  align_corners,
+                  idata,
+                  odata,
+                  num_kernels,
+                  grad_input.numel());
+        });
+
+    AT_CUDA_CHECK(cudaGetLastError());
+    return;
+  }
+
   AT_DISPATCH_FLOATING_TYPES_AND_HALF(
       grad_output.scalar_type(), "upsample_bilinear2d_backward_out_frame", [&] {
         using accscalar_t = at::acc_type<scalar_t, true>;
@@ -107,6 +107,90 @@ __global__ void upsample_nearest2d_backward_out_frame(
   }
 }
 
+// The channels-last version of upsample_nearest2d_out_frame: a thread copies
+// vec_size channels of an output pixel, so that the threads of a warp access
+// consecutive channels.
+template <typename scalar_t, int vec_size>
+C10_LAUNCH_BOUNDS_1(1024)
+__global__ void upsample_nearest2d_nhwc_out_frame(
+    const scalar_t* idata,
+    scalar_t* odata,
+    const size_t channels,
+    const size_t height1,
+    const size_t width1,
+    const size_t height2,
+    const size_t width2,
+    float height_scale,
+    float width_scale,
+    const size_t out_numel) {
+  using vec_t = memory::aligned_vector<scalar_t, vec_size>;
+
+  const size_t index =
+      (static_cast<size_t>(blockIdx.x) * blockDim.x + threadIdx.x) * vec_size;
+  if (index >= out_numel) {
+    return;
+  }
+
+  const size_t c = index % channels;
+  const int w2 = (index / channels) % width2;
+  const int h2 = (index / channels / width2) % height2;
+  const size_t n = index / channels / width2 / height2;
+
+  const size_t h1 = height1 == height2
+      ? h2
+      : nearest_neighbor_compute_source_index(height_scale, h2, height1);
+  const size_t w1 = width1 == width2
+      ? w2
+      : nearest_neighbor_compute_source_index(width_scale, w2, width1);
+
+  *reinterpret_cast<vec_t*>(odata + index) = *reinterpret_cast<const vec_t*>(
+      idata + idx_cl(n, h1, w1, c, height1, width1, channels));
+}
+
+// The channels-last version of upsample_nearest2d_backward_out_frame: a thread
+// computes one channel of a grad_input pixel.
+template <typename scalar_t, typename accscalar_t>
+C10_LAUNCH_BOUNDS_1(1024)
+__global__ void upsample_nearest2d_backward_nhwc_out_frame(
+    const scalar_t* grad_o,
+    size_t channels,
+    size_t src_dim_h,
+    size_t src_dim_w,
+    size_t dst_dim_h,
+    size_t dst_dim_w,
+    scalar_t* grad_i,
+    float height_scale,
+    float width_scale,
+    const size_t gi_numel) {
+  const size_t index =
+      static_cast<size_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  if (index >= gi_numel) {
+    return;
+  }
+
+  const size_t c = index % channels;
+  const int dst_x = (index / channels) % dst_dim_w;
+  const int dst_y = (index / channels / dst_dim_w) % dst_dim_h;
+  const size_t n = index / channels / dst_dim_w / dst_dim_h;
+
+  int src_y =
+      nearest_neighbor_bw_compute_source_index(height_scale, dst_y, src_dim_h);
+  int src_y_up = nearest_neighbor_bw_compute_source_index(
+      height_scale, dst_y + 1, src_dim_h + 1);
+  int src_x =
+      nearest_neighbor_bw_compute_source_index(width_scale, dst_x, src_dim_w);
+  int src_x_up = nearest_neighbor_bw_compute_source_index(
+      width_scale, dst_x + 1, src_dim_w + 1);
+
+  accscalar_t grad = 0;
+  for (int y = src_y; y < src_y_up; y++) {
+    for (int x = src_x; x < src_x_up; x++) {
+      grad += grad_o[idx_cl(n, y, x, c, src_dim_h, src_dim_w, channels)];
+    }
+  }
+  grad_i[index] = static_cast<scalar_t>(grad);
+}
+
 static void upsample_nearest2d_out_cuda_template(
     Tensor& output,
     const Tensor& input_,
@@ -144,13 +228,55 @@ static void upsample_nearest2d_out_cuda_template(
       input_height > 0 && input_width > 0 && output_height > 0 &&
       output_width > 0);
 
-  Tensor input = input_.contiguous();
-  output.resize_({nbatch, channels, output_height, output_width});
+  // Channels-last inputs get channels-last outputs, see
+  // upsample_nearest2d_nhwc_out_frame.
+  const auto memory_format = input_.suggest_memory_format();
+  Tensor input = input_.contiguous(memory_format);
+  output.resize_({nbatch, channels, output_height, output_width}, memory_format);
 
   if (input.numel() == 0) {
     return;
   }
 
+  cudaStream_t stream = at::cuda::getCurrentCUDAStream();
+
+  if (memory_format == at::MemoryFormat::ChannelsLast) {
+    const size_t out_numel = output.numel();
+    const int num_threads = std::min<int>(
+        at::cuda::getCurrentDeviceProperties()->maxThreadsPerBlock, MAX_THREADS);
+    AT_DISPATCH_FLOATING_TYPES_AND2(ScalarType::Half, ScalarType::Byte, input.scalar_type(), "upsample_nearest2d_nhwc_out_frame", [&] {
+          const int vec_size =
+              upsample_channels_last_vec_size<scalar_t>(channels, input, output);
+          const size_t num_blocks = cuda::ATenCeilDiv(
+              out_numel / vec_size, static_cast<size_t>(num_threads));
+          TORCH_CHECK(
+              num_blocks <= at::cuda::getCurrentDeviceProperties()->maxGridSize[0],
+              "input tensor has spatial dimension larger than the kernel capacity");
+
+          auto idata = input.data_ptr<scalar_t>();
+          auto odata = output.data_ptr<scalar_t>();
+
+          const float height_scale = compute_scales_value<float>(scales_h, input_height, output_height);
+          const float width_scale = compute_scales_value<float>(scales_w, input_width, output_width);
+
+          if (vec_size == 4) {
+            upsample_nearest2d_nhwc_out_frame<scalar_t, 4>
+                <<<num_blocks, num_threads, 0, stream>>>(
+                    idata, odata, channels, input_height, input_width,
+                    output_height, output_width, height_scale, width_scale,
+                    out_numel);
+          } else {
+            upsample_nearest2d_nhwc_out_frame<scalar_t, 1>
+                <<<num_blocks, num_threads, 0, stream>>>(
+                    idata, odata, channels, input_height, input_width,
+                    output_height, output_width, height_scale, width_scale,
+                    out_numel);
+          }
+        });
+    AT_CUDA_CHECK(cudaGetLastError());
+    return;
+  }
+
   int nc = nbatch * channels;
 
   const int max_threads = std::min<int>(
@@ -183,7 +309,6 @@ static void upsample_nearest2d_out_cuda_template(
       grid_x <= maxGridSize[0] && grid_y <= maxGridSize[1],
       "input tensor has spatial dimension larger than the kernel capacity");
 
-  cudaStream_t stream = at::cuda::getCurrentCUDAStream();
   AT_DISPATCH_FLOATING_TYPES_AND2(ScalarType::Half, ScalarType::Byte, input.scalar_type(), "upsample_nearest2d_out_frame", [&] {
         using accscalar_t = at::acc_type<scalar_t, true>;
 
@@ -250,13 +375,48 @@ static void upsample_nearest2d_backward_out_cuda_template(
       output_height,
       output_width);
 
-  Tensor grad_output = grad_output_.contiguous();
-  grad_input.resize_({nbatch, channels, input_height, input_width});
+  const auto memory_format = grad_output_.suggest_memory_format();
+  Tensor grad_output = grad_output_.contiguous(memory_format);
+  grad_input.resize_({nbatch, channels, input_height, input_width}, memory_format);
 
   if (grad_input.numel() == 0) {
     return;
   }
 
+  if (memory_format == at::MemoryFormat::ChannelsLast) {
+    const size_t gi_numel = grad_input.numel();
+    const int num_threads = std::min<int>(
+        at::cuda::getCurrentDeviceProperties()->maxThreadsPerBlock, MAX_THREADS);
+    const size_t num_blocks =
+        cuda::ATenCeilDiv(gi_numel, static_cast<size_t>(num_threads));
+    TORCH_CHECK(
+        num_blocks <= at::cuda::getCurrentDeviceProperties()->maxGridSize[0],
+        "input tensor has spatial dimension larger than the kernel capacity");
+
+    cudaStream_t stream = at::cuda::getCurrentCUDAStream();
+    AT_DISPATCH_FLOATING_TYPES_AND2(ScalarType::Half, ScalarType::Byte, grad_output.scalar_type(), "upsample_nearest2d_backward_nhwc_out_frame", [&] {
+          using accscalar_t = at::acc_type<scalar_t, true>;
+
+          const float height_scale = compute_scales_value_backwards<float>(scales_h, output_height, input_height);
+          const float width_scale = compute_scales_value_backwards<float>(scales_w, output_width, input_width);
+
+          upsample_nearest2d_backward_nhwc_out_frame<scalar_t, accscalar_t>
+              <<<num_blocks, num_threads, 0, stream>>>(
+                  grad_output.data_ptr<scalar_t>(),
+                  channels,
+                  output_height,
+                  output_width,
+                  input_height,
+                  input_width,
+                  grad_input.data_ptr<scalar_t>(),
+                  height_scale,
+                  width_scale,
+                  gi_numel);
+        });
+    AT_CUDA_CHECK(cudaGetLastError());
+    return;
+  }
+
   // upsample_2d_shape_check makes sure `nbatch != 0`
   unsigned int n = grad_input.numel() / nbatch;
   dim3 bdim{std::min<unsigned int>(
@@ -6,11 +6,17 @@
 #include <ATen/NativeFunctions.h>
 #include <ATen/cuda/CUDAApplyUtils.cuh>
 #include <ATen/cuda/detail/IndexUtils.cuh>
+#include <ATen/native/SharedReduceOps.h>
 #include <ATen/native/cuda/block_reduce.cuh>
 #include <THC/THCDeviceUtils.cuh>
 
 #include <c10/cuda/CUDAMathCompat.h>
 
+#include <thrust/pair.h>
+#include <thrust/tuple.h>
+
+#include <type_traits>
+
 namespace at {
 namespace native {
 
@@ -19,32 +25,109 @@ namespace {
 constexpr int kCUDANumThreads = 256;
 constexpr int kReduceTileSize = 32;
 
+// The groups of at most kFusedGroupSize elements are normalized by the
+// block computing their moments, while they are still in its cache, instead
+// of by separate kernels.
+constexpr int64_t kFusedGroupSize = 4096;
+
+template <typename T>
+using WelfordType = WelfordData<acc_type<T, true>, int64_t, acc_type<T, true>>;
+
+template <typename T>
+using WelfordOpType = WelfordOps<
+    acc_type<T, true>,
+    acc_type<T, true>,
+    int64_t,
+    acc_type<T, true>,
+    thrust::pair<acc_type<T, true>, acc_type<T, true>>>;
+
+// Computes the moments of the N elements of X with Welford's algorithm,
+// which unlike the sums of the elements and of their squares doesn't lose
+// the variance to cancellation when the mean is large. The result is only
+// valid in the thread 0.
+template <typename T>
+__device__ WelfordType<T>
+BlockWelfordMoments(int64_t N, const WelfordOpType<T>& welford_op, const T* X) {
+  using T_ACC = acc_type<T, true>;
+  __shared__ typename std::aligned_storage<
+      sizeof(WelfordType<T>),
+      alignof(WelfordType<T>)>::type val_shared[C10_WARP_SIZE];
+  WelfordType<T>* val_shared_ptr =
+      reinterpret_cast<WelfordType<T>*>(val_shared);
+  WelfordType<T> val;
+  for (int64_t j = threadIdx.x; j < N; j += blockDim.x) {
+    val = welford_op.reduce(val, static_cast<T_ACC>(X[j]), j);
+  }
+  return cuda_utils::BlockReduce(
+      val, welford_op, WelfordType<T>(), val_shared_ptr);
+}
+
 template <typename T>
 __global__ void RowwiseMomentsCUDAKernel(
     int64_t N,
     T eps,
+    WelfordOpType<T> welford_op,
     const T* X,
     T* mean,
     T* rstd) {
   using T_ACC = acc_type<T, true>;
-  __shared__ T_ACC m_shared[C10_WARP_SIZE];
-  __shared__ T_ACC v_shared[C10_WARP_SIZE];
   const int64_t i = blockIdx.x;
-  T_ACC sum1 = 0;
-  T_ACC sum2 = 0;
-  for (int64_t j = threadIdx.x; j < N; j += blockDim.x) {
-    const int64_t index = i * N + j;
-    sum1 += static_cast<T_ACC>(X[index]);
-    sum2 += static_cast<T_ACC>(X[index]) * static_cast<T_ACC>(X[index]);
+  const WelfordType<T> val = BlockWelfordMoments<T>(N, welford_op, X + i * N);
+  if (threadIdx.x == 0) {
+    T_ACC m1;
+    T_ACC m2;
+    thrust::tie(m2, m1) = welford_op.project(val);
+    mean[i] = m1;
+    rstd[i] = c10::cuda::compat::rsqrt(
+        c10::cuda::compat::max(m2, T_ACC(0)) + static_cast<T_ACC>(eps));
   }
-  sum1 = cuda_utils::BlockReduceSum<T_ACC>(sum1, m_shared);
-  sum2 = cuda_utils::BlockReduceSum<T_ACC>(sum2, v_shared);
+}
+
+// Computes the moments of the group i = n * G + g and normalizes it.
+template <typename T>
+__global__ void GroupNormForwardFusedCUDAKernel(
+    int64_t C,
+    int64_t HxW,
+    int64_t group,
+    T eps,
+    WelfordOpType<T> welford_op,
+    const T* X,
+    const T* gamma,
+    const T* beta,
+    T* mean,
+    T* rstd,
+    T* Y) {
+  using T_ACC = acc_type<T, true>;
+  __shared__ T_ACC m_shared;
+  __shared__ T_ACC r_shared;
+  const int64_t D = C / group;
+  const int64_t i = blockIdx.x;
+  const int64_t g = i % group;
+  const T* X_ptr = X + i * D * HxW;
+  T* Y_ptr = Y + i * D * HxW;
+  const WelfordType<T> val =
+      BlockWelfordMoments<T>(D * HxW, welford_op, X_ptr);
   if (threadIdx.x == 0) {
-    const T_ACC scale = T_ACC(1) / static_cast<T_ACC>(N);
-    sum1 *= scale;
-    sum2 = c10::cuda::compat::max(sum2 * scale - sum1 * sum1, T_ACC(0));
-    mean[i] = sum1;
-    rstd[i] = c10::cuda::compat::rsqrt(sum2 + static_cast<T_ACC>(eps));
+    T_ACC m1;
+    T_ACC m2;
+    thrust::tie(m2, m1) = welford_op.project(val);
+    m_shared = m1;
+    r_shared = c10::cuda::compat::rsqrt(
+        c10::cuda::compat::max(m2, T_ACC(0)) + static_cast<T_ACC>(eps));
+    mean[i] = m_shared;
+    rstd[i] = r_shared;
+  }
+  __syncthreads();
+  const T_ACC mean_val = m_shared;
+  const T_ACC rstd_val = r_shared;
+  for (int64_t j = threadIdx.x; j < D * HxW; j += blockDim.x) {
+    const int64_t c = g * D + j / HxW;
+    const T_ACC scale = (gamma == nullptr)
+        ? rstd_val
+        : rstd_val * static_cast<T_ACC>(gamma[c]);
+    const T_ACC bias =
+        (beta == nullptr) ? T_ACC(0) : static_cast<T_ACC>(beta[c]);
+    Y_ptr[j] = (static_cast<T_ACC>(X_ptr[j]) - mean_val) * scale + bias;
   }
 }
 
@@ -372,6 +455,25 @@ void GroupNormKernelImplInternal(
   if (N == 0) {
     return;
   }
+  if (!X.is_contiguous()) {
+    // The kernels index the contiguous format, a channels-last X is
+    // normalized in it.
+    Tensor Y_contig = at::empty_like(X, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+    GroupNormKernelImplInternal<T>(
+        X.contiguous(),
+        gamma,
+        beta,
+        N,
+        C,
+        HxW,
+        group,
+        eps,
+        &Y_contig,
+        mean,
+        rstd);
+    Y->copy_(Y_contig);
+    return;
+  }
   const int64_t G = group;
   const int64_t D = C / G;
   const T* X_data = X.data_ptr<T>();
@@ -380,15 +482,36 @@ void GroupNormKernelImplInternal(
   T* Y_data = Y->data_ptr<T>();
   T* mean_data = mean->data_ptr<T>();
   T* rstd_data = rstd->data_ptr<T>();
+  cudaStream_t cuda_stream = at::cuda::getCurrentCUDAStream();
+  const WelfordOpType<T> welford_op(/*unbiased=*/false, /*take_sqrt=*/false);
+  if (D * HxW <= kFusedGroupSize) {
+    // A warp is enough for the smallest groups.
+    const int num_threads =
+        D * HxW < kCUDANumThreads ? C10_WARP_SIZE : kCUDANumThreads;
+    GroupNormForwardFusedCUDAKernel<T>
+        <<<N * G, num_threads, 0, cuda_stream>>>(
+            C,
+            HxW,
+            G,
+            eps,
+            welford_op,
+            X_data,
+            gamma_data,
+            beta_data,
+            mean_data,
+            rstd_data,
+            Y_data);
+    AT_CUDA_CHECK(cudaGetLastError());
+    return;
+  }
   const auto kAccType = X.scalar_type() == kHalf ? kFloat : X.scalar_type();
   Tensor a = at::empty({N, C}, X.options().dtype(kAccType));
   Tensor b = at::empty({N, C}, X.options().dtype(kAccType));
   T_ACC* a_data = a.data_ptr<T_ACC>();
   T_ACC* b_data = b.data_ptr<T_ACC>();
-  cudaStream_t cuda_stream = at::cuda::getCurrentCUDAStream();
   RowwiseMomentsCUDAKernel<T>
       <<<N * G, cuda_utils::kCUDABlockReduceNumThreads, 0, cuda_stream>>>(
-          D * HxW, eps, X_data, mean_data, rstd_data);
+          D * HxW, eps, welford_op, X_data, mean_data, rstd_data);
   int64_t B = (N * C + kCUDANumThreads - 1) / kCUDANumThreads;
   ComputeFusedParamsCUDAKernel<T><<<B, kCUDANumThreads, 0, cuda_stream>>>(
       N, C, G, mean_data, rstd_data, gamma_data, beta_data, a_data, b_data);
@@ -474,6 +597,31 @@ void GroupNormBackwardKernelImplInternal(
     }
     return;
   }
+  if (!X.is_contiguous()) {
+    // As in the forward, a channels-last X is handled in the contiguous
+    // format.
+    Tensor dX_contig;
+    if (dX->defined()) {
+      dX_contig = at::empty_like(X, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+    }
+    GroupNormBackwardKernelImplInternal<T>(
+        dY.contiguous(),
+        X.contiguous(),
+        mean,
+        rstd,
+        gamma,
+        N,
+        C,
+        HxW,
+        group,
+        &dX_contig,
+        dgamma,
+        dbeta);
+    if (dX->defined()) {
+      dX->copy_(dX_contig);
+    }
+    return;
+  }
 
   const T* dY_data = dY.data_ptr<T>();
   const T* X_data = X.data_ptr<T>();
@@ -489,7 +637,7 @@ void GroupNormBackwardKernelImplInternal(
   ComputeInternalGradientsCUDAKernel<T>
       <<<N * C, cuda_utils::kCUDABlockReduceNumThreads, 0, cuda_stream>>>(
           HxW, dY_data, X_data, ds_data, db_data);
-  if (dX != nullptr) {
+  if (dX_data != nullptr) {
     Tensor c1 = at::empty({N, C}, X.options().dtype(kAccType));
     Tensor c2 = at::empty({N, G}, X.options().dtype(kAccType));
     Tensor c3 = at::empty({N, G}, X.options().dtype(kAccType));
@@ -4,12 +4,18 @@
 #include <ATen/AccumulateType.h>
 #include <ATen/Dispatch.h>
 #include <ATen/NativeFunctions.h>
+#include <ATen/CUDAGeneratorImpl.h>
 #include <ATen/cuda/CUDAApplyUtils.cuh>
+#include <ATen/cuda/CUDAGraphsUtils.cuh>
 #include <ATen/cuda/detail/IndexUtils.cuh>
+#include <ATen/native/cuda/MemoryAccess.cuh>
 #include <ATen/native/cuda/block_reduce.cuh>
 #include <THC/THCDeviceUtils.cuh>
 
 #include <c10/cuda/CUDAMathCompat.h>
+#include <curand_kernel.h>
+
+#include <algorithm>
 
 namespace at {
 namespace native {
@@ -254,6 +260,335 @@ __global__ void GammaBetaBackwardCUDAKernel(
   }
 }
 
+template <typename T>
+void GammaBetaBackwardCUDAImpl(
+    int64_t M,
+    int64_t N,
+    const T* dY_data,
+    const T* X_data,
+    const T* mean_data,
+    const T* rstd_data,
+    T* dgamma_data,
+    T* dbeta_data) {
+  cudaStream_t cuda_stream = at::cuda::getCurrentCUDAStream();
+  if (M < 512) {
+    // For small batch size, do colwise reduce directly.
+    const int64_t B = (N + kCUDANumThreads - 1) / kCUDANumThreads;
+    GammaBetaBackwardSimpleCUDAKernel<T>
+        <<<B, kCUDANumThreads, 0, cuda_stream>>>(
+            M,
+            N,
+            dY_data,
+            X_data,
+            mean_data,
+            rstd_data,
+            dgamma_data,
+            dbeta_data);
+  } else {
+    const int64_t B =
+        (N + kColwiseReduceTileSize - 1) / kColwiseReduceTileSize;
+    constexpr int kThreadX = kColwiseReduceTileSize;
+    constexpr int kThreadY = kColwiseReduceTileSize / 2;
+    GammaBetaBackwardCUDAKernel<T>
+        <<<B, dim3(kThreadX, kThreadY), 0, cuda_stream>>>(
+            M,
+            N,
+            dY_data,
+            X_data,
+            mean_data,
+            rstd_data,
+            dgamma_data,
+            dbeta_data);
+  }
+}
+
+// Loads vector `v` of row `i` of X for RowCachedLayerNormCUDAKernel.
+template <typename T, int kVecSize>
+struct LayerNormLoader {
+  using T_ACC = acc_type<T, true>;
+  using vec_t = memory::aligned_vector<T, kVecSize>;
+
+  const T* X;
+  int64_t N;
+
+  __device__ void init_thread(int64_t /* i */) {}
+
+  __device__ void load(int64_t i, int64_t v, T_ACC* out) {
+    const vec_t x = reinterpret_cast<const vec_t*>(X + i * N)[v];
+#pragma unroll
+    for (int j = 0; j < kVecSize; ++j) {
+      out[j] = static_cast<T_ACC>(x.val[j]);
+    }
+  }
+};
+
+// Produces S = R + dropout(X) for RowCachedLayerNormCUDAKernel, writing S
+// (needed by the backward) and the dropout mask as it goes.
+template <typename T, int kVecSize, bool kHasDropout>
+struct DropoutAddLoader {
+  using T_ACC = acc_type<T, true>;
+  using vec_t = memory::aligned_vector<T, kVecSize>;
+  using mask_vec_t = memory::aligned_vector<uint8_t, kVecSize>;
+
+  const T* X;
+  const T* R;
+  T* S;
+  uint8_t* mask;
+  int64_t N;
+  T_ACC keep_prob;
+  T_ACC scale;
+  PhiloxCudaState philox_args;
+  curandStatePhilox4_32_10_t state;
+
+  __device__ void init_thread(int64_t i) {
+    if (kHasDropout) {
+      auto seeds = at::cuda::philox::unpack(philox_args);
+      curand_init(
+          std::get<0>(seeds),
+          i * blockDim.x + threadIdx.x,
+          std::get<1>(seeds),
+          &state);
+    }
+  }
+
+  __device__ void load(int64_t i, int64_t v, T_ACC* out) {
+    const vec_t x = reinterpret_cast<const vec_t*>(X + i * N)[v];
+    const vec_t r = reinterpret_cast<const vec_t*>(R + i * N)[v];
+    vec_t s;
+    mask_vec_t m;
+#pragma unroll
+    for (int j0 = 0; j0 < kVecSize; j0 += 4) {
+      float4 rand;
+      if (kHasDropout) {
+        rand = curand_uniform4(&state);
+      }
+#pragma unroll
+      for (int j = j0; j < j0 + 4 && j < kVecSize; ++j) {
+        T_ACC x_v = static_cast<T_ACC>(x.val[j]);
+        if (kHasDropout) {
+          const bool keep = (&rand.x)[j - j0] < keep_prob;
+          m.val[j] = keep;
+          x_v = keep ? x_v * scale : T_ACC(0);
+        }
+        s.val[j] = static_cast<T>(static_cast<T_ACC>(r.val[j]) + x_v);
+        out[j] = static_cast<T_ACC>(s.val[j]);
+      }
+    }
+    reinterpret_cast<vec_t*>(S + i * N)[v] = s;
+    if (kHasDropout) {
+      reinterpret_cast<mask_vec_t*>(mask + i * N)[v] = m;
+    }
+  }
+};
+
+// Layer norm of a row short enough to live in registers: each thread keeps
+// kVecsPerThread vectors of kVecSize elements, so the row is read once, the
+// variance is computed from the centered values, and Y needs no second pass
+// over X. The input row is produced by `loader`.
+template <typename T, int kVecSize, int kVecsPerThread, typename loader_t>
+__global__ void RowCachedLayerNormCUDAKernel(
+    int64_t N,
+    acc_type<T, true> eps,
+    loader_t loader,
+    const T* gamma,
+    const T* beta,
+    T* Y,
+    T* mean,
+    T* rstd) {
+  using T_ACC = acc_type<T, true>;
+  using vec_t = memory::aligned_vector<T, kVecSize>;
+  __shared__ T_ACC shared[C10_WARP_SIZE];
+  __shared__ T_ACC row_stat;
+  const int64_t i = blockIdx.x;
+  const int64_t num_vecs = N / kVecSize;
+  loader.init_thread(i);
+
+  T_ACC vals[kVecsPerThread][kVecSize];
+  T_ACC sum = 0;
+#pragma unroll
+  for (int k = 0; k < kVecsPerThread; ++k) {
+    const int64_t v = threadIdx.x + k * blockDim.x;
+    if (v < num_vecs) {
+      loader.load(i, v, vals[k]);
+#pragma unroll
+      for (int j = 0; j < kVecSize; ++j) {
+        sum += vals[k][j];
+      }
+    }
+  }
+  sum = cuda_utils::BlockReduceSum<T_ACC>(sum, shared);
+  if (threadIdx.x == 0) {
+    row_stat = sum / static_cast<T_ACC>(N);
+  }
+  __syncthreads();
+  const T_ACC m = row_stat;
+
+  T_ACC sq = 0;
+#pragma unroll
+  for (int k = 0; k < kVecsPerThread; ++k) {
+    const int64_t v = threadIdx.x + k * blockDim.x;
+    if (v < num_vecs) {
+#pragma unroll
+      for (int j = 0; j < kVecSize; ++j) {
+        const T_ACC d = vals[k][j] - m;
+        sq += d * d;
+      }
+    }
+  }
+  sq = cuda_utils::BlockReduceSum<T_ACC>(sq, shared);
+  if (threadIdx.x == 0) {
+    row_stat = c10::cuda::compat::rsqrt(sq / static_cast<T_ACC>(N) + eps);
+    mean[i] = m;
+    rstd[i] = row_stat;
+  }
+  __syncthreads();
+  const T_ACC r = row_stat;
+
+#pragma unroll
+  for (int k = 0; k < kVecsPerThread; ++k) {
+    const int64_t v = threadIdx.x + k * blockDim.x;
+    if (v < num_vecs) {
+      vec_t g;
+      vec_t b;
+      if (gamma != nullptr) {
+        g = reinterpret_cast<const vec_t*>(gamma)[v];
+      }
+      if (beta != nullptr) {
+        b = reinterpret_cast<const vec_t*>(beta)[v];
+      }
+      vec_t y;
+#pragma unroll
+      for (int j = 0; j < kVecSize; ++j) {
+        const T_ACC gamma_v =
+            gamma == nullptr ? T_ACC(1) : static_cast<T_ACC>(g.val[j]);
+        const T_ACC beta_v =
+            beta == nullptr ? T_ACC(0) : static_cast<T_ACC>(b.val[j]);
+        y.val[j] = (vals[k][j] - m) * r * gamma_v + beta_v;
+      }
+      reinterpret_cast<vec_t*>(Y + i * N)[v] = y;
+    }
+  }
+}
+
+// Backward of layer_norm(R + dropout(X)) for one row per block: dS is the
+// usual layer norm input gradient, written as the residual gradient, and
+// dX = dS * mask * scale. When kHasDropout is false dX is a copy of dS.
+template <typename T, bool kHasDropout>
+__global__ void DropoutAddLayerNormBackwardCUDAKernel(
+    int64_t N,
+    const T* dY,
+    const T* S,
+    const T* mean,
+    const T* rstd,
+    const T* gamma,
+    const uint8_t* mask,
+    acc_type<T, true> scale,
+    T* dS,
+    T* dX) {
+  using T_ACC = acc_type<T, true>;
+  __shared__ T_ACC ds_shared[C10_WARP_SIZE];
+  __shared__ T_ACC db_shared[C10_WARP_SIZE];
+  __shared__ T_ACC c1_shared;
+  __shared__ T_ACC c2_shared;
+  const int64_t i = blockIdx.x;
+  T_ACC sum1 = 0;
+  T_ACC sum2 = 0;
+  for (int64_t j = threadIdx.x; j < N; j += blockDim.x) {
+    const int64_t index = i * N + j;
+    const T_ACC gamma_v =
+        gamma == nullptr ? T_ACC(1) : static_cast<T_ACC>(gamma[j]);
+    sum1 +=
+        static_cast<T_ACC>(dY[index]) * static_cast<T_ACC>(S[index]) * gamma_v;
+    sum2 += static_cast<T_ACC>(dY[index]) * gamma_v;
+  }
+  sum1 = cuda_utils::BlockReduceSum<T_ACC>(sum1, ds_shared);
+  sum2 = cuda_utils::BlockReduceSum<T_ACC>(sum2, db_shared);
+  const T_ACC rstd_v = static_cast<T_ACC>(rstd[i]);
+  if (threadIdx.x == 0) {
+    const T_ACC mean_v = static_cast<T_ACC>(mean[i]);
+    const T_ACC s = T_ACC(1) / static_cast<T_ACC>(N);
+    const T_ACC a = (sum2 * mean_v - sum1) * rstd_v * rstd_v * rstd_v * s;
+    c1_shared = a;
+    c2_shared = -(a * mean_v + sum2 * rstd_v * s);
+  }
+  __syncthreads();
+  const T_ACC c1 = c1_shared;
+  const T_ACC c2 = c2_shared;
+  for (int64_t j = threadIdx.x; j < N; j += blockDim.x) {
+    const int64_t index = i * N + j;
+    const T_ACC gamma_v =
+        gamma == nullptr ? T_ACC(1) : static_cast<T_ACC>(gamma[j]);
+    const T_ACC ds_v = rstd_v * static_cast<T_ACC>(dY[index]) * gamma_v +
+        c1 * static_cast<T_ACC>(S[index]) + c2;
+    if (dS != nullptr) {
+      dS[index] = ds_v;
+    }
+    if (dX != nullptr) {
+      dX[index] = kHasDropout ? (mask[index] ? ds_v * scale : T_ACC(0)) : ds_v;
+    }
+  }
+}
+
+template <typename T>
+bool IsAligned(const T* ptr, int64_t alignment) {
+  return reinterpret_cast<uintptr_t>(ptr) % alignment == 0;
+}
+
+// Picks the block size and the number of vectors each thread keeps for a row
+// of `num_vecs` vectors; returns 0 if the row does not fit in registers.
+inline int RowCachedVecsPerThread(int64_t num_vecs, int* num_threads) {
+  constexpr int kMaxVecsPerThread = 8;
+  *num_threads = static_cast<int>(std::min<int64_t>(
+      kCUDANumThreads,
+      (num_vecs + C10_WARP_SIZE - 1) / C10_WARP_SIZE * C10_WARP_SIZE));
+  for (int k = 1; k <= kMaxVecsPerThread; k *= 2) {
+    if (static_cast<int64_t>(*num_threads) * k >= num_vecs) {
+      return k;
+    }
+  }
+  return 0;
+}
+
+template <typename T, int kVecSize, typename loader_t>
+void LaunchRowCachedLayerNorm(
+    int64_t M,
+    int64_t N,
+    int vecs_per_thread,
+    int num_threads,
+    acc_type<T, true> eps,
+    const loader_t& loader,
+    const T* gamma_data,
+    const T* beta_data,
+    T* Y_data,
+    T* mean_data,
+    T* rstd_data) {
+  cudaStream_t cuda_stream = at::cuda::getCurrentCUDAStream();
+#define LAUNCH_ROW_CACHED_LAYER_NORM(K)                                  \
+  case K:                                                                \
+    RowCachedLayerNormCUDAKernel<T, kVecSize, K, loader_t>               \
+        <<<M, num_threads, 0, cuda_stream>>>(                            \
+            N, eps, loader, gamma_data, beta_data, Y_data, mean_data,    \
+            rstd_data);                                                  \
+    break;
+  switch (vecs_per_thread) {
+    LAUNCH_ROW_CACHED_LAYER_NORM(1)
+    LAUNCH_ROW_CACHED_LAYER_NORM(2)
+    LAUNCH_ROW_CACHED_LAYER_NORM(4)
+    LAUNCH_ROW_CACHED_LAYER_NORM(8)
+    default:
+      TORCH_INTERNAL_ASSERT(false, "unexpected vecs_per_thread ", vecs_per_thread);
+  }
+#undef LAUNCH_ROW_CACHED_LAYER_NORM
+  AT_CUDA_CHECK(cudaGetLastError());
+}
+
+// Vector width for the row cached kernels: 16 bytes when every row and the
+// affine parameters are 16 byte aligned, otherwise scalar.
+template <typename T>
+constexpr int RowCachedMaxVecSize() {
+  return sizeof(T) >= 16 ? 1 : 16 / sizeof(T);
+}
+
 template <typename T>
 void LayerNormKernelImplInternal(
     const Tensor& X,
@@ -274,6 +609,34 @@ void LayerNormKernelImplInternal(
   T* Y_data = Y->data_ptr<T>();
   T* mean_data = mean->data_ptr<T>();
   T* rstd_data = rstd->data_ptr<T>();
+
+  // Rows that fit in registers are normalized by a single kernel.
+  using T_ACC = acc_type<T, true>;
+  constexpr int kVecSize = RowCachedMaxVecSize<T>();
+  constexpr int kAlignment = kVecSize * sizeof(T);
+  int num_threads = 0;
+  if (N % kVecSize == 0 && IsAligned(X_data, kAlignment) &&
+      IsAligned(Y_data, kAlignment) && IsAligned(gamma_data, kAlignment) &&
+      IsAligned(beta_data, kAlignment)) {
+    const int vecs_per_thread =
+        RowCachedVecsPerThread(N / kVecSize, &num_threads);
+    if (vecs_per_thread > 0) {
+      LaunchRowCachedLayerNorm<T, kVecSize>(
+          M, N, vecs_per_thread, num_threads, static_cast<T_ACC>(eps),
+          LayerNormLoader<T, kVecSize>{X_data, N}, gamma_data, beta_data,
+          Y_data, mean_data, rstd_data);
+      return;
+    }
+  }
+  const int vecs_per_thread = RowCachedVecsPerThread(N, &num_threads);
+  if (vecs_per_thread > 0) {
+    LaunchRowCachedLayerNorm<T, 1>(
+        M, N, vecs_per_thread, num_threads, static_cast<T_ACC>(eps),
+        LayerNormLoader<T, 1>{X_data, N}, gamma_data, beta_data, Y_data,
+        mean_data, rstd_data);
+    return;
+  }
+
   cudaStream_t cuda_stream = at::cuda::getCurrentCUDAStream();
   RowwiseMomentsCUDAKernel<T>
       <<<M, cuda_utils::kCUDABlockReduceNumThreads, 0, cuda_stream>>>(
@@ -366,35 +729,8 @@ void LayerNormBackwardKernelImplInternal(
     T* dgamma_data =
         dgamma->defined() ? dgamma->template data_ptr<T>() : nullptr;
     T* dbeta_data = dbeta->defined() ? dbeta->template data_ptr<T>() : nullptr;
-    if (M < 512) {
-      // For small batch size, do colwise reduce directly.
-      const int64_t B = (N + kCUDANumThreads - 1) / kCUDANumThreads;
-      GammaBetaBackwardSimpleCUDAKernel<T>
-          <<<B, kCUDANumThreads, 0, cuda_stream>>>(
-              M,
-              N,
-              dY_data,
-              X_data,
-              mean_data,
-              rstd_data,
-              dgamma_data,
-              dbeta_data);
-    } else {
-      const int64_t B =
-          (N + kColwiseReduceTileSize - 1) / kColwiseReduceTileSize;
-      constexpr int kThreadX = kColwiseReduceTileSize;
-      constexpr int kThreadY = kColwiseReduceTileSize / 2;
-      GammaBetaBackwardCUDAKernel<T>
-          <<<B, dim3(kThreadX, kThreadY), 0, cuda_stream>>>(
-              M,
-              N,
-              dY_data,
-              X_data,
-              mean_data,
-              rstd_data,
-              dgamma_data,
-              dbeta_data);
-    }
+    GammaBetaBackwardCUDAImpl<T>(
+        M, N, dY_data, X_data, mean_data, rstd_data, dgamma_data, dbeta_data);
   }
 }
 
@@ -418,6 +754,168 @@ void LayerNormBackwardKernelImpl(
       });
 }
 
+template <typename T, int kVecSize>
+bool LaunchRowCachedDropoutAddLayerNorm(
+    const Tensor& X,
+    const Tensor& R,
+    const Tensor& gamma,
+    const Tensor& beta,
+    int64_t M,
+    int64_t N,
+    double p,
+    double eps,
+    c10::optional<Generator> gen_,
+    Tensor* Y,
+    Tensor* S,
+    Tensor* mean,
+    Tensor* rstd,
+    Tensor* dropout_mask) {
+  using T_ACC = acc_type<T, true>;
+  constexpr int kAlignment = kVecSize * sizeof(T);
+  const T* X_data = X.data_ptr<T>();
+  const T* R_data = R.data_ptr<T>();
+  const T* gamma_data = gamma.defined() ? gamma.data_ptr<T>() : nullptr;
+  const T* beta_data = beta.defined() ? beta.data_ptr<T>() : nullptr;
+  T* Y_data = Y->data_ptr<T>();
+  T* S_data = S->data_ptr<T>();
+  if (N % kVecSize != 0 || !IsAligned(X_data, kAlignment) ||
+      !IsAligned(R_data, kAlignment) || !IsAligned(gamma_data, kAlignment) ||
+      !IsAligned(beta_data, kAlignment) || !IsAligned(Y_data, kAlignment) ||
+      !IsAligned(S_data, kAlignment)) {
+    return false;
+  }
+  int num_threads = 0;
+  const int vecs_per_thread =
+      RowCachedVecsPerThread(N / kVecSize, &num_threads);
+  if (vecs_per_thread == 0) {
+    return false;
+  }
+  T* mean_data = mean->data_ptr<T>();
+  T* rstd_data = rstd->data_ptr<T>();
+  const T_ACC keep_prob = static_cast<T_ACC>(1 - p);
+  const T_ACC scale = p < 1 ? T_ACC(1) / keep_prob : T_ACC(0);
+  if (p > 0) {
+    auto gen = get_generator_or_default<CUDAGeneratorImpl>(
+        gen_, cuda::detail::getDefaultCUDAGenerator());
+    // Each thread draws one float4 per four elements of each of its vectors.
+    const int64_t counter_offset =
+        vecs_per_thread * ((kVecSize + 3) / 4) * 4;
+    PhiloxCudaState rng_engine_inputs;
+    {
+      // See Note [Acquire lock when using random generators]
+      std::lock_guard<std::mutex> lock(gen->mutex_);
+      rng_engine_inputs = gen->philox_cuda_state(counter_offset);
+    }
+    DropoutAddLoader<T, kVecSize, true> loader{
+        X_data, R_data, S_data, dropout_mask->data_ptr<uint8_t>(), N,
+        keep_prob, scale, rng_engine_inputs};
+    LaunchRowCachedLayerNorm<T, kVecSize>(
+        M, N, vecs_per_thread, num_threads, static_cast<T_ACC>(eps), loader,
+        gamma_data, beta_data, Y_data, mean_data, rstd_data);
+  } else {
+    DropoutAddLoader<T, kVecSize, false> loader{
+        X_data, R_data, S_data, nullptr, N, keep_prob, scale};
+    LaunchRowCachedLayerNorm<T, kVecSize>(
+        M, N, vecs_per_thread, num_threads, static_cast<T_ACC>(eps), loader,
+        gamma_data, beta_data, Y_data, mean_data, rstd_data);
+  }
+  return true;
+}
+
+template <typename T>
+void DropoutAddLayerNormKernelImplInternal(
+    const Tensor& X,
+    const Tensor& R,
+    const Tensor& gamma,
+    const Tensor& beta,
+    int64_t M,
+    int64_t N,
+    double p,
+    double eps,
+    c10::optional<Generator> gen,
+    Tensor* Y,
+    Tensor* S,
+    Tensor* mean,
+    Tensor* rstd,
+    Tensor* dropout_mask) {
+  DCHECK_EQ(X.numel(), M * N);
+  DCHECK_EQ(R.numel(), M * N);
+  if (LaunchRowCachedDropoutAddLayerNorm<T, RowCachedMaxVecSize<T>()>(
+          X, R, gamma, beta, M, N, p, eps, gen, Y, S, mean, rstd,
+          dropout_mask) ||
+      LaunchRowCachedDropoutAddLayerNorm<T, 1>(
+          X, R, gamma, beta, M, N, p, eps, gen, Y, S, mean, rstd,
+          dropout_mask)) {
+    return;
+  }
+  // Rows too long for registers: build S with the dropout kernel, then
+  // normalize it like any other input.
+  if (p >= 1) {
+    dropout_mask->zero_();
+    S->copy_(R);
+  } else if (p > 0) {
+    auto dropped = at::_fused_dropout(X, 1 - p, gen);
+    at::add_out(*S, R, std::get<0>(dropped));
+    dropout_mask->copy_(std::get<1>(dropped));
+  } else {
+    at::add_out(*S, X, R);
+  }
+  LayerNormKernelImplInternal<T>(
+      *S, gamma, beta, M, N, static_cast<T>(eps), Y, mean, rstd);
+}
+
+template <typename T>
+void DropoutAddLayerNormBackwardKernelImplInternal(
+    const Tensor& dY,
+    const Tensor& S,
+    const Tensor& mean,
+    const Tensor& rstd,
+    const Tensor& dropout_mask,
+    const Tensor& gamma,
+    int64_t M,
+    int64_t N,
+    double p,
+    Tensor* dX,
+    Tensor* dR,
+    Tensor* dgamma,
+    Tensor* dbeta) {
+  using T_ACC = acc_type<T, true>;
+  DCHECK_EQ(dY.numel(), M * N);
+  DCHECK_EQ(S.numel(), M * N);
+  const T* dY_data = dY.template data_ptr<T>();
+  const T* S_data = S.template data_ptr<T>();
+  const T* mean_data = mean.template data_ptr<T>();
+  const T* rstd_data = rstd.template data_ptr<T>();
+  const T* gamma_data =
+      gamma.defined() ? gamma.template data_ptr<T>() : nullptr;
+  T* dX_data = dX->defined() ? dX->template data_ptr<T>() : nullptr;
+  T* dR_data = dR->defined() ? dR->template data_ptr<T>() : nullptr;
+  cudaStream_t cuda_stream = at::cuda::getCurrentCUDAStream();
+  if (dX_data != nullptr || dR_data != nullptr) {
+    const T_ACC scale = p < 1 ? T_ACC(1) / static_cast<T_ACC>(1 - p) : T_ACC(0);
+    if (p > 0) {
+      DropoutAddLayerNormBackwardCUDAKernel<T, true>
+          <<<M, cuda_utils::kCUDABlockReduceNumThreads, 0, cuda_stream>>>(
+              N, dY_data, S_data, mean_data, rstd_data, gamma_data,
+              dropout_mask.template data_ptr<uint8_t>(), scale, dR_data,
+              dX_data);
+    } else {
+      DropoutAddLayerNormBackwardCUDAKernel<T, false>
+          <<<M, cuda_utils::kCUDABlockReduceNumThreads, 0, cuda_stream>>>(
+              N, dY_data, S_data, mean_data, rstd_data, gamma_data, nullptr,
+              scale, dR_data, dX_data);
+    }
+    AT_CUDA_CHECK(cudaGetLastError());
+  }
+  if (dgamma->defined() || dbeta->defined()) {
+    T* dgamma_data =
+        dgamma->defined() ? dgamma->template data_ptr<T>() : nullptr;
+    T* dbeta_data = dbeta->defined() ? dbeta->template data_ptr<T>() : nullptr;
+    GammaBetaBackwardCUDAImpl<T>(
+        M, N, dY_data, S_data, mean_data, rstd_data, dgamma_data, dbeta_data);
+  }
+}
+
 } // namespace
 
 std::tuple<Tensor, Tensor, Tensor> layer_norm_cuda(
@@ -465,6 +963,80 @@ std::tuple<Tensor, Tensor, Tensor> layer_norm_backward_cuda(
 }
 
 
+std::tuple<Tensor, Tensor, Tensor, Tensor, Tensor> dropout_add_layer_norm_cuda(
+    const Tensor& X,
+    const Tensor& R,
+    const Tensor& gamma /* optional */,
+    const Tensor& beta /* optional */,
+    int64_t M,
+    int64_t N,
+    double p,
+    double eps,
+    c10::optional<Generator> gen) {
+  Tensor Y = at::native::empty_like(X, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  Tensor S = at::native::empty_like(X, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  Tensor mean = at::empty({M}, X.options());
+  Tensor rstd = at::empty({M}, X.options());
+  Tensor dropout_mask = p > 0
+      ? at::empty(X.sizes(), X.options().dtype(kByte))
+      : at::empty({0}, X.options().dtype(kByte));
+  if (M > 0) {
+    AT_DISPATCH_FLOATING_TYPES_AND2(at::ScalarType::Half, at::ScalarType::BFloat16,
+        X.scalar_type(), "dropout_add_layer_norm_cuda", [&]() {
+          AT_SKIP_BFLOAT16_IF_NOT_ROCM(scalar_t, "dropout_add_layer_norm_cuda", [&] {
+            DropoutAddLayerNormKernelImplInternal<scalar_t>(
+                X, R, gamma, beta, M, N, p, eps, gen, &Y, &S, &mean, &rstd,
+                &dropout_mask);
+          });
+        });
+  }
+  return std::make_tuple(
+      std::move(Y), std::move(S), std::move(mean), std::move(rstd),
+      std::move(dropout_mask));
+}
+
+std::tuple<Tensor, Tensor, Tensor, Tensor> dropout_add_layer_norm_backward_cuda(
+    const Tensor& dY,
+    const Tensor& S,
+    const Tensor& mean,
+    const Tensor& rstd,
+    const Tensor& dropout_mask,
+    const Tensor& gamma,
+    int64_t M,
+    int64_t N,
+    double p,
+    std::array<bool, 4> grad_input_mask) {
+  Tensor dX;
+  Tensor dR;
+  Tensor dgamma;
+  Tensor dbeta;
+  if (grad_input_mask[0]) {
+    dX = at::native::empty_like(S, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  }
+  if (grad_input_mask[1]) {
+    dR = at::native::empty_like(S, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  }
+  if (grad_input_mask[2]) {
+    dgamma = M > 0 ? at::native::empty_like(gamma, LEGACY_CONTIGUOUS_MEMORY_FORMAT) : at::native::zeros_like(gamma, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  }
+  if (grad_input_mask[3]) {
+    dbeta = M > 0 ? at::native::empty_like(gamma, LEGACY_CONTIGUOUS_MEMORY_FORMAT) : at::native::zeros_like(gamma, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  }
+  if (M > 0) {
+    AT_DISPATCH_FLOATING_TYPES_AND2(at::ScalarType::Half, at::ScalarType::BFloat16,
+        S.scalar_type(), "dropout_add_layer_norm_backward_cuda", [&]() {
+          AT_SKIP_BFLOAT16_IF_NOT_ROCM(scalar_t, "dropout_add_layer_norm_backward_cuda", [&] {
+            DropoutAddLayerNormBackwardKernelImplInternal<scalar_t>(
+                dY, S, mean, rstd, dropout_mask, gamma, M, N, p, &dX, &dR,
+                &dgamma, &dbeta);
+          });
+        });
+  }
+  return std::make_tuple(
+      std::move(dX), std::move(dR), std::move(dgamma), std::move(dbeta));
+}
+
+
 REGISTER_DISPATCH(LayerNormKernel, &LayerNormKernelImpl);
 REGISTER_DISPATCH(LayerNormBackwardKernel, &LayerNormBackwardKernelImpl);
 
@@ -70,24 +70,41 @@ std::tuple<at::Tensor,at::Tensor> cudnn_convolution_transpose_backward(
   AT_ERROR("cudnn_convolution_transpose_backward: ATen not compiled with cuDNN support");
 }
 
+at::Tensor cudnn_convolution_relu(
+    const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias,
+    IntArrayRef stride, IntArrayRef padding, IntArrayRef dilation, int64_t groups) {
+  AT_ERROR("cudnn_convolution_relu: ATen not compiled with cuDNN support");
+}
+
+at::Tensor cudnn_convolution_add_relu(
+    const at::Tensor& input, const at::Tensor& weight, const at::Tensor& z, const at::Tensor& bias,
+    IntArrayRef stride, IntArrayRef padding, IntArrayRef dilation, int64_t groups, Scalar alpha) {
+  AT_ERROR("cudnn_convolution_add_relu: ATen not compiled with cuDNN support");
+}
+
 }}
 
 #else  // AT_CUDNN_ENABLED
 
 #include <THC/THC.h>
 
+#include <ATen/cuda/CUDAContext.h>
 #include <ATen/cudnn/cudnn-wrapper.h>
 #include <ATen/cudnn/Descriptors.h>
 #include <ATen/cudnn/Types.h>
 #include <ATen/cudnn/Utils.h>
+#include <ATen/native/cudnn/ConvBenchmarkCache.h>
 #include <ATen/native/utils/ParamsHash.h>
 
 #include <ATen/TensorUtils.h>
+#include <c10/util/Metrics.h>
 
 #include <functional>
 #include <iterator>
 #include <sstream>
 #include <algorithm>
+#include <cstring>
+#include <fstream>
 #include <memory>
 #include <mutex>
 #include <stdint.h>
@@ -282,8 +299,14 @@ struct BenchmarkCache {
     std::lock_guard<std::mutex> guard(mutex);
     auto it = map.find(params);
     if (it == map.end()) {
+      C10_METRICS_COUNTER_ADD(
+          "aten_cudnn_benchmark_cache_misses_total",
+          "Convolutions whose cuDNN algorithm wasn't in the cache", 1);
       return false;
     }
+    C10_METRICS_COUNTER_ADD(
+        "aten_cudnn_benchmark_cache_hits_total",
+        "Convolutions whose cuDNN algorithm was in the cache", 1);
     *results = it->second;
     return true;
   }
@@ -292,12 +315,104 @@ struct BenchmarkCache {
     std::lock_guard<std::mutex> guard(mutex);
     map[params] = results;
   }
+
+  // Writes the number of entries, then every entry as it is laid out in
+  // memory; the parameters are PODs with their padding zeroed.
+  void save(std::ostream& out) {
+    std::lock_guard<std::mutex> guard(mutex);
+    const uint64_t size = map.size();
+    out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    for (const auto& entry : map) {
+      out.write(reinterpret_cast<const char*>(&entry.first), sizeof(ConvolutionParams));
+      out.write(reinterpret_cast<const char*>(&entry.second), sizeof(T));
+    }
+  }
+
+  // Reads the entries written by save, which replace those of the same
+  // parameters, and returns their number.
+  int64_t load(std::istream& in, const std::string& path) {
+    uint64_t size = 0;
+    in.read(reinterpret_cast<char*>(&size), sizeof(size));
+    TORCH_CHECK(in, "The cuDNN benchmark cache at ", path, " is truncated");
+    std::lock_guard<std::mutex> guard(mutex);
+    for (uint64_t i = 0; i < size; ++i) {
+      ConvolutionParams params;
+      T results;
+      in.read(reinterpret_cast<char*>(&params), sizeof(params));
+      in.read(reinterpret_cast<char*>(&results), sizeof(results));
+      TORCH_CHECK(in, "The cuDNN benchmark cache at ", path, " is truncated");
+      map[params] = results;
+    }
+    return static_cast<int64_t>(size);
+  }
 };
 
 BenchmarkCache<cudnnConvolutionFwdAlgoPerf_t> fwd_algos;
 BenchmarkCache<cudnnConvolutionBwdDataAlgoPerf_t> bwd_data_algos;
 BenchmarkCache<cudnnConvolutionBwdFilterAlgoPerf_t> bwd_filter_algos;
 
+// The algorithms only hold for the GPU and the version of cuDNN that picked
+// them, and the entries for the layout of the structs they were saved with.
+struct BenchmarkCacheHeader {
+  char magic[8];
+  int64_t cudnn_version;
+  char device_name[256];
+  uint64_t params_size;
+  uint64_t perf_sizes[3];
+};
+
+constexpr char kBenchmarkCacheMagic[8] = {'P', 'T', 'C', 'U', 'D', 'N', 'N', '1'};
+
+BenchmarkCacheHeader currentBenchmarkCacheHeader() {
+  BenchmarkCacheHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kBenchmarkCacheMagic, sizeof(header.magic));
+  header.cudnn_version = static_cast<int64_t>(cudnnGetVersion());
+  strncpy(header.device_name, at::cuda::getCurrentDeviceProperties()->name,
+          sizeof(header.device_name) - 1);
+  header.params_size = sizeof(ConvolutionParams);
+  header.perf_sizes[0] = sizeof(cudnnConvolutionFwdAlgoPerf_t);
+  header.perf_sizes[1] = sizeof(cudnnConvolutionBwdDataAlgoPerf_t);
+  header.perf_sizes[2] = sizeof(cudnnConvolutionBwdFilterAlgoPerf_t);
+  return header;
+}
+
+namespace detail {
+
+void cudnn_save_conv_benchmark_cache_impl(const std::string& path) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  TORCH_CHECK(out, "Error opening ", path, " to save the cuDNN benchmark cache");
+  const auto header = currentBenchmarkCacheHeader();
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  fwd_algos.save(out);
+  bwd_data_algos.save(out);
+  bwd_filter_algos.save(out);
+  TORCH_CHECK(out, "Error writing the cuDNN benchmark cache to ", path);
+}
+
+int64_t cudnn_load_conv_benchmark_cache_impl(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  TORCH_CHECK(in, "Error opening ", path, " to load the cuDNN benchmark cache");
+  BenchmarkCacheHeader header;
+  in.read(reinterpret_cast<char*>(&header), sizeof(header));
+  TORCH_CHECK(in && memcmp(header.magic, kBenchmarkCacheMagic, sizeof(header.magic)) == 0,
+              path, " is not a cuDNN benchmark cache");
+  header.device_name[sizeof(header.device_name) - 1] = '\0';
+  const auto expected = currentBenchmarkCacheHeader();
+  if (memcmp(&header, &expected, sizeof(header)) != 0) {
+    TORCH_WARN("Ignoring the cuDNN benchmark cache at ", path, ", which was saved on ",
+               header.device_name, " with cuDNN ", header.cudnn_version, " rather than on ",
+               expected.device_name, " with cuDNN ", expected.cudnn_version);
+    return 0;
+  }
+  int64_t loaded = fwd_algos.load(in, path);
+  loaded += bwd_data_algos.load(in, path);
+  loaded += bwd_filter_algos.load(in, path);
+  return loaded;
+}
+
+} // namespace detail
+
 // TODO: Stop manually allocating CUDA memory; allocate an ATen byte
 // tensor instead.
 struct Workspace {
@@ -906,6 +1021,140 @@ Tensor cudnn_convolution(
   return output_t;
 }
 
+// ---------------------------------------------------------------------
+//
+// Convolution fused with an addition, a bias and a relu
+//
+// ---------------------------------------------------------------------
+
+// output = relu(conv(input, weight) + alpha * z + bias) in one kernel, z having
+// the sizes and the layout of the output. It shares the benchmark cache of the
+// forward convolution, since it takes the same algorithms.
+void raw_cudnn_convolution_add_relu_out(
+    const Tensor& output, const Tensor& input, const Tensor& weight,
+    const Tensor& z, float alpha, const Tensor& bias,
+    IntArrayRef stride, IntArrayRef padding, IntArrayRef dilation, int64_t groups,
+    bool benchmark, bool deterministic) {
+
+  auto dataType = getCudnnDataType(input);
+
+  ConvolutionArgs args{ input, output, weight };
+  args.handle = getCudnnHandle();
+  setConvolutionParams(&args.params, input, weight, padding, stride, dilation, groups, deterministic);
+  args.idesc.set(input);
+  args.wdesc.set(weight, 0, input.suggest_memory_format()==at::MemoryFormat::ChannelsLast);
+  args.odesc.set(output);
+  args.cdesc.set(dataType, input.dim() - 2, args.params.padding, args.params.stride, args.params.dilation, args.params.groups);
+
+  TensorDescriptor bdesc;
+  bdesc.set(bias.view({1, bias.size(0)}), output.dim());
+  ActivationDescriptor adesc;
+  adesc.set(CUDNN_ACTIVATION_RELU);
+
+  AlgoIterator<cudnnConvolutionFwdAlgoPerf_t>(args, benchmark).try_all(
+    [&](const cudnnConvolutionFwdAlgoPerf_t &fwdAlgPerf){
+      Tensor workspace = allocate_workspace(fwdAlgPerf.memory, input);
+
+      // See Note [behavior of cudnnFind and cudnnGet]
+      AT_CUDNN_CHECK(cudnnSetConvolutionMathType(args.cdesc.mut_desc(), fwdAlgPerf.mathType));
+
+      Constant one(dataType, 1);
+      Constant alpha_(dataType, alpha);
+
+      AT_CUDNN_CHECK(cudnnConvolutionBiasActivationForward(
+        args.handle,
+        &one, args.idesc.desc(), input.data_ptr(),
+        args.wdesc.desc(), weight.data_ptr(),
+        args.cdesc.desc(), fwdAlgPerf.algo, workspace.data_ptr(), fwdAlgPerf.memory,
+        &alpha_, args.odesc.desc(), z.data_ptr(),
+        bdesc.desc(), bias.data_ptr(),
+        adesc.desc(),
+        args.odesc.desc(), output.data_ptr()));
+      }
+  );
+}
+
+Tensor cudnn_convolution_add_relu_forward(
+    CheckedFrom c,
+    const TensorArg& input, const TensorArg& weight, const Tensor& z_t,
+    float alpha, const Tensor& bias_t,
+    IntArrayRef stride, IntArrayRef padding, IntArrayRef dilation, int64_t groups)
+{
+  checkAllSameType(c, {input, weight});
+  checkAllSameGPU(c, {input, weight});
+
+  auto layout = cudnn_conv_use_channels_last(*input, *weight) ?
+      at::MemoryFormat::ChannelsLast : at::MemoryFormat::Contiguous;
+  auto output_t = at::empty(
+                    conv_output_size(input->sizes(), weight->sizes(),
+                                     padding, stride, dilation),
+                    input->options(),
+                    layout);
+
+  if (output_t.numel() == 0) {
+    return output_t;
+  }
+
+  TensorArg output{ output_t, "result", 0 };
+  convolution_shape_check(c, input, weight, output, padding, stride, dilation, groups);
+  TORCH_CHECK(input->numel() <= std::numeric_limits<int>::max() &&
+              output->numel() <= std::numeric_limits<int>::max(),
+              c, ": tensors needing 64 bit indexing are not supported");
+
+  Tensor z;
+  if (z_t.defined()) {
+    TORCH_CHECK(z_t.sizes() == output->sizes(),
+                c, ": expected z of sizes ", output->sizes(), ", got ", z_t.sizes());
+    z = z_t.to(input->options()).contiguous(layout);
+  } else {
+    // cuDNN may read z even though alpha is 0, so let it read zeros.
+    z = output_t.zero_();
+    alpha = 0;
+  }
+  Tensor bias = bias_t.defined()
+      ? bias_t.to(input->options()).contiguous()
+      : at::zeros({weight->size(0)}, input->options());
+  TORCH_CHECK(bias.dim() == 1 && bias.size(0) == weight->size(0),
+              c, ": expected a bias of ", weight->size(0), " elements, got ", bias.sizes());
+
+  // See #4500
+  Tensor weight_contig = weight->contiguous(layout);
+  // Make sure that NC11 strides follow formula
+  weight_contig.resize_(weight_contig.sizes(), layout);
+  Tensor input_contig = input->contiguous(layout);
+  input_contig.resize_(input_contig.sizes(), layout);
+
+  raw_cudnn_convolution_add_relu_out(
+      *output, input_contig, weight_contig, z, alpha, bias,
+      stride, padding, dilation, groups,
+      at::globalContext().benchmarkCuDNN(), at::globalContext().deterministicCuDNN());
+
+  return *output;
+}
+
+Tensor cudnn_convolution_relu(
+    const Tensor& input_t, const Tensor& weight_t, const Tensor& bias_t,
+    IntArrayRef stride, IntArrayRef padding, IntArrayRef dilation, int64_t groups)
+{
+  TensorArg input  { input_t,  "input",  1 },
+            weight { weight_t, "weight", 2 };
+  CheckedFrom c = "cudnn_convolution_relu";
+  return cudnn_convolution_add_relu_forward(
+    c, input, weight, Tensor(), 0, bias_t, stride, padding, dilation, groups);
+}
+
+Tensor cudnn_convolution_add_relu(
+    const Tensor& input_t, const Tensor& weight_t, const Tensor& z_t, const Tensor& bias_t,
+    IntArrayRef stride, IntArrayRef padding, IntArrayRef dilation, int64_t groups, Scalar alpha)
+{
+  TensorArg input  { input_t,  "input",  1 },
+            weight { weight_t, "weight", 2 };
+  CheckedFrom c = "cudnn_convolution_add_relu";
+  TORCH_CHECK(z_t.defined(), c, ": expected a defined z");
+  return cudnn_convolution_add_relu_forward(
+    c, input, weight, z_t, alpha.to<float>(), bias_t, stride, padding, dilation, groups);
+}
+
 // NB: output_padding not needed here, as there is no ambiguity to
 // resolve
 Tensor cudnn_convolution_transpose_backward_input(
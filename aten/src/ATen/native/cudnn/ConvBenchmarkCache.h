@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace at { namespace native { namespace detail {
+
+// The algorithms that cuDNN convolutions picked (see the BenchmarkCache of
+// native/cudnn/Conv.cpp) may be saved to a file and loaded again by another
+// process, so that torch.backends.cudnn.benchmark does not have to benchmark
+// every shape again on every start. As the convolutions of ATen_cuda are only
+// there when CUDA is loaded, the native functions
+// _cudnn_save_conv_benchmark_cache and _cudnn_load_conv_benchmark_cache (at
+// native/Convolution.cpp) call these through the CUDA hooks.
+void cudnn_save_conv_benchmark_cache_impl(const std::string& path);
+int64_t cudnn_load_conv_benchmark_cache_impl(const std::string& path);
+
+}}}  // namespace at::native::detail
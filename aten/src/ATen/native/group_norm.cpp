@@ -25,7 +25,9 @@ std::tuple<Tensor, Tensor, Tensor> native_group_norm(
     int64_t HxW,
     int64_t group,
     double eps) {
-  Tensor Y = at::native::empty_like(X, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  // A channels-last X is normalized in place, without a layout conversion,
+  // and Y keeps its layout.
+  Tensor Y = at::native::empty_like(X, X.suggest_memory_format());
   Tensor mean = at::empty({N, group}, X.options());
   Tensor rstd = at::empty({N, group}, X.options());
   GroupNormKernel(
@@ -59,7 +61,7 @@ std::tuple<Tensor, Tensor, Tensor> native_group_norm_backward(
   Tensor dgamma;
   Tensor dbeta;
   if (grad_input_mask[0]) {
-    dX = at::native::empty_like(X, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+    dX = at::native::empty_like(X, X.suggest_memory_format());
   }
   if (grad_input_mask[1]) {
     dgamma = at::native::empty_like(gamma, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
@@ -69,7 +71,7 @@ std::tuple<Tensor, Tensor, Tensor> native_group_norm_backward(
   }
   GroupNormBackwardKernel(
       X.device().type(),
-      dY,
+      dY.contiguous(X.suggest_memory_format()),
       X,
       mean,
       rstd,
@@ -123,7 +125,10 @@ Tensor group_norm(
       1LL,
       std::multiplies<int64_t>());
 
-  const auto& X = input.is_contiguous() ? input : input.contiguous();
+  const auto memory_format = input.suggest_memory_format();
+  const auto& X = input.is_contiguous(memory_format)
+      ? input
+      : input.contiguous(memory_format);
   const auto& gamma = weight.is_contiguous() ? weight : weight.contiguous();
   const auto& beta = bias.is_contiguous() ? bias : bias.contiguous();
   return std::get<0>(
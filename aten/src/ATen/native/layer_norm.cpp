@@ -61,6 +61,61 @@ std::tuple<Tensor, Tensor, Tensor> layer_norm_backward_cpu(
   return std::make_tuple(std::move(dX), std::move(dgamma), std::move(dbeta));
 }
 
+std::tuple<Tensor, Tensor, Tensor, Tensor, Tensor> dropout_add_layer_norm_cpu(
+    const Tensor& X,
+    const Tensor& R,
+    const Tensor& gamma /* optional */,
+    const Tensor& beta /* optional */,
+    int64_t M,
+    int64_t N,
+    double p,
+    double eps,
+    c10::optional<Generator> gen) {
+  Tensor S;
+  Tensor dropout_mask;
+  if (p > 0) {
+    dropout_mask = at::empty(X.sizes(), X.options().dtype(kByte));
+    dropout_mask.bernoulli_(1 - p, gen);
+    const double scale = p < 1 ? 1 / (1 - p) : 0;
+    S = at::add(R, X * dropout_mask, scale);
+  } else {
+    dropout_mask = at::empty({0}, X.options().dtype(kByte));
+    S = at::add(R, X);
+  }
+  auto outputs = layer_norm_cpu(S, gamma, beta, M, N, eps);
+  return std::make_tuple(
+      std::move(std::get<0>(outputs)), std::move(S),
+      std::move(std::get<1>(outputs)), std::move(std::get<2>(outputs)),
+      std::move(dropout_mask));
+}
+
+std::tuple<Tensor, Tensor, Tensor, Tensor> dropout_add_layer_norm_backward_cpu(
+    const Tensor& dY,
+    const Tensor& S,
+    const Tensor& mean,
+    const Tensor& rstd,
+    const Tensor& dropout_mask,
+    const Tensor& gamma,
+    int64_t M,
+    int64_t N,
+    double p,
+    std::array<bool, 4> grad_input_mask) {
+  auto grads = layer_norm_backward_cpu(
+      dY, S, mean, rstd, gamma, M, N,
+      {grad_input_mask[0] || grad_input_mask[1], grad_input_mask[2],
+       grad_input_mask[3]});
+  const Tensor& dS = std::get<0>(grads);
+  Tensor dX;
+  if (grad_input_mask[0]) {
+    const double scale = p < 1 ? 1 / (1 - p) : 0;
+    dX = p > 0 ? dS * dropout_mask * scale : dS.clone();
+  }
+  Tensor dR = grad_input_mask[1] ? dS : Tensor();
+  return std::make_tuple(
+      std::move(dX), std::move(dR), std::move(std::get<1>(grads)),
+      std::move(std::get<2>(grads)));
+}
+
 Tensor layer_norm(
     const Tensor& input,
     IntArrayRef normalized_shape,
@@ -79,6 +134,38 @@ Tensor layer_norm(
   return std::get<0>(at::native_layer_norm(X, gamma, beta, M, N, eps));
 }
 
+Tensor dropout_add_layer_norm(
+    const Tensor& input,
+    const Tensor& residual,
+    IntArrayRef normalized_shape,
+    const Tensor& weight /* optional */,
+    const Tensor& bias /* optional */,
+    double p,
+    bool train,
+    double eps) {
+  TORCH_CHECK(
+      p >= 0 && p <= 1,
+      "dropout probability has to be between 0 and 1, but got ", p);
+  TORCH_CHECK(
+      residual.sizes() == input.sizes(),
+      "Expected residual to have the same size as input, but got residual of size ",
+      residual.sizes(), " and input of size ", input.sizes());
+  TORCH_CHECK(
+      residual.scalar_type() == input.scalar_type(),
+      "Expected residual to have the same dtype as input, but got ",
+      residual.scalar_type(), " and ", input.scalar_type());
+
+  auto inputs = _prepare_layer_norm_inputs(input, normalized_shape, weight, bias);
+  auto X = std::get<0>(inputs);
+  auto gamma = std::get<1>(inputs);
+  auto beta = std::get<2>(inputs);
+  auto M = std::get<3>(inputs);
+  auto N = std::get<4>(inputs);
+
+  return std::get<0>(at::native_dropout_add_layer_norm(
+      X, residual.contiguous(), gamma, beta, M, N, train ? p : 0.0, eps));
+}
+
 DEFINE_DISPATCH(LayerNormKernel);
 DEFINE_DISPATCH(LayerNormBackwardKernel);
 
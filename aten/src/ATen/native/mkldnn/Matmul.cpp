@@ -0,0 +1,105 @@
+#include <ATen/native/mkldnn/Matmul.h>
+
+#if !AT_MKLDNN_ENABLED()
+
+namespace at {
+namespace native {
+
+bool mkldnn_bf16_gemm(
+    cpublas::TransposeType transa, cpublas::TransposeType transb,
+    int64_t m, int64_t n, int64_t k,
+    float alpha,
+    const c10::BFloat16 *a, int64_t lda,
+    const c10::BFloat16 *b, int64_t ldb,
+    float beta,
+    c10::BFloat16 *c, int64_t ldc) {
+  return false;
+}
+
+} // namespace native
+} // namespace at
+
+#else // AT_MKLDNN_EBABLED
+
+#include <ATen/native/mkldnn/MKLDNNCommon.h>
+#include <cpuinfo.h>
+
+namespace at {
+namespace native {
+
+static bool use_mkldnn_bf16_gemm() {
+  // oneDNN only has optimized BFloat16 kernels from AVX512 on; on older
+  // CPUs its reference implementation is slower than ours.
+  static bool avx512_available = cpuinfo_initialize() &&
+      cpuinfo_has_x86_avx512f() && cpuinfo_has_x86_avx512bw() &&
+      cpuinfo_has_x86_avx512vl() && cpuinfo_has_x86_avx512dq();
+  return at::globalContext().userEnabledMkldnn() && avx512_available;
+}
+
+bool mkldnn_bf16_gemm(
+    cpublas::TransposeType transa, cpublas::TransposeType transb,
+    int64_t m, int64_t n, int64_t k,
+    float alpha,
+    const c10::BFloat16 *a_data, int64_t lda,
+    const c10::BFloat16 *b_data, int64_t ldb,
+    float beta,
+    c10::BFloat16 *c_data, int64_t ldc) {
+  // Tiny problems are dominated by the primitive creation overhead.
+  if (!use_mkldnn_bf16_gemm() || m * n * k <= 16 * 16 * 16 || alpha == 0.0f) {
+    return false;
+  }
+
+  // Accumulate into c with a sum post-op when beta != 0.
+  ideep::attr_t op_attr;
+  if (beta != 0.0f) {
+    op_attr = ideep::attr_t::fuse_sum();
+  }
+
+  // The column-major m x n problem C = op(A) op(B) is the row-major n x m
+  // problem C^T = op(B)^T op(A)^T, so the buffers can be handed to oneDNN as
+  // they are, with the transposes expressed through the strides.
+  ideep::tensor::dims a_strides{{lda, 1}}, b_strides{{ldb, 1}}, c_strides{{ldc, 1}};
+  if (transa != cpublas::NoTranspose) {
+    std::swap(a_strides[0], a_strides[1]);
+  }
+  if (transb != cpublas::NoTranspose) {
+    std::swap(b_strides[0], b_strides[1]);
+  }
+
+  ideep::tensor a({
+      /*sizes=*/{k, m},
+      ideep::tensor::data_type::bf16,
+      /*strides=*/a_strides},
+    const_cast<c10::BFloat16*>(a_data));
+  ideep::tensor b({
+      /*sizes=*/{n, k},
+      ideep::tensor::data_type::bf16,
+      /*strides=*/b_strides},
+    const_cast<c10::BFloat16*>(b_data));
+  ideep::tensor c({
+      /*sizes=*/{n, m},
+      ideep::tensor::data_type::bf16,
+      /*strides=*/c_strides},
+    c_data);
+
+  ideep::matmul_forward::compute(
+      b, a, c, alpha, beta,
+      ideep::scale_t(), ideep::scale_t(), ideep::scale_t(), op_attr);
+
+  if (c.get_data_handle() != c_data) {
+    // oneDNN picked a different layout for the output and allocated its own
+    // buffer; copy the result back into the caller's.
+    ideep::tensor real_output({
+        /*sizes=*/{n, m},
+        ideep::tensor::data_type::bf16,
+        /*strides=*/c_strides},
+      c_data);
+    c.reorder_to(real_output);
+  }
+  return true;
+}
+
+} // namespace native
+} // namespace at
+
+#endif // AT_MKLDNN_EBABLED
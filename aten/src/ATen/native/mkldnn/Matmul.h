@@ -0,0 +1,22 @@
+#pragma once
+
+#include <ATen/Config.h>
+#include <ATen/native/CPUBlas.h>
+
+namespace at { namespace native {
+
+// Routes a BFloat16 gemm (same column-major interface as cpublas::gemm)
+// to oneDNN's matmul, which accumulates in float and uses the AVX512-BF16
+// instructions where the CPU has them. Returns false, without touching c, if
+// oneDNN is not available or not worth it for this problem; the caller falls
+// back to the generic kernel in that case.
+bool mkldnn_bf16_gemm(
+    cpublas::TransposeType transa, cpublas::TransposeType transb,
+    int64_t m, int64_t n, int64_t k,
+    float alpha,
+    const c10::BFloat16 *a, int64_t lda,
+    const c10::BFloat16 *b, int64_t ldb,
+    float beta,
+    c10::BFloat16 *c, int64_t ldc);
+
+}} // namespace at::native
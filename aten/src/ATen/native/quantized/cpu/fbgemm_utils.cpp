@@ -353,6 +353,17 @@ torch::class_<LinearPackedParamsBase> register_linear_params() {
                 weight = std::move(std::get<0>(state));
                 bias = std::move(std::get<1>(state));
 
+                // The weights of CUDA tensors are packed by the CUDA kernel
+                // of quantized::linear_prepack, whatever the engine.
+                if (weight.is_cuda()) {
+                  static auto op =
+                      c10::Dispatcher::singleton()
+                          .findSchemaOrThrow("quantized::linear_prepack", "")
+                          .typed<c10::intrusive_ptr<LinearPackedParamsBase>(
+                              at::Tensor, c10::optional<at::Tensor>)>();
+                  return op.call(std::move(weight), std::move(bias));
+                }
+
 #ifdef USE_FBGEMM
                 if (at::globalContext().qEngine() == at::QEngine::FBGEMM) {
                   if (weight.scalar_type() == at::kQInt8) {
@@ -32,6 +32,9 @@ inline void check_inputs(const Tensor& qa, const Tensor& qb) {
   TORCH_CHECK(
       qa.scalar_type() == qb.scalar_type(),
       "Add operands should have same data type.");
+  TORCH_CHECK(
+      qa.device() == qb.device(),
+      "Add operands should be on the same device.");
 }
 
 // Note: out is assumed to be the same size as self and other.
@@ -211,13 +214,14 @@ Tensor qadd(Tensor qa, Tensor qb, double scale, int64_t zero_point) {
   check_inputs(qa, qb);
 #ifdef USE_PYTORCH_QNNPACK
   if (at::globalContext().qEngine() == at::QEngine::QNNPACK &&
-      qa.scalar_type() == kQUInt8 && qb.scalar_type() == kQUInt8) {
+      qa.is_cpu() && qa.scalar_type() == kQUInt8 &&
+      qb.scalar_type() == kQUInt8) {
     return qnnpack_add<ReLUFused>(qa, qb, scale, zero_point);
   }
 #endif
   auto qc = at::_empty_affine_quantized(
       qa.sizes(),
-      at::device(kCPU)
+      at::device(qa.device())
          .dtype(qa.scalar_type())
          .memory_format(qa.suggest_memory_format()),
       scale,
@@ -287,6 +291,15 @@ TORCH_LIBRARY_IMPL(quantized, QuantizedCPU, m) {
   m.impl("add_scalar_relu_out.Tensor", TORCH_FN(qadd_scalar_tensor_out</*ReLUFused=*/true>));
 }
 
+// The tensor-tensor additions run the qadd kernels of the device of the
+// inputs, see quantized/cuda/qadd.cu.
+TORCH_LIBRARY_IMPL(quantized, QuantizedCUDA, m) {
+  m.impl("add",                 TORCH_FN(qadd</*ReLUFused=*/false>));
+  m.impl("add.out",             TORCH_FN(qadd_out</*ReLUFused=*/false>));
+  m.impl("add_relu",            TORCH_FN(qadd</*ReLUFused=*/true>));
+  m.impl("add_relu.out",        TORCH_FN(qadd_out</*ReLUFused=*/true>));
+}
+
 TORCH_LIBRARY_IMPL(_quantized, QuantizedCPU, m) {
   m.impl("add", TORCH_FN(qadd</*ReLUFused=*/false>));
 }
@@ -9,6 +9,11 @@
 
 #include <ATen/Parallel.h>
 
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+
 torch::class_<EmbeddingPackedParamsBase> register_embedding_params();
 
 at::Tensor PackedEmbeddingBagWeight::embeddingbag_byte(
@@ -208,195 +213,397 @@ Tensor embedding_bag_byte_rowwise_offsets(
   return output;
 }
 
-Tensor embedding_bag_4bit_rowwise_offsets(
-    const Tensor& weight,
-    const Tensor& indices,
-    const c10::optional<Tensor>& offsets_in,
-    const bool /* scale_grad_by_freq */,
-    const int64_t /* mode */,
-    bool sparse,
-    const c10::optional<Tensor>& per_sample_weights_,
-    const c10::optional<Tensor>& compressed_indices_mapping,
-    bool include_last_offset) {
-  TORCH_CHECK(offsets_in.has_value(), "embedding_bag_4bit_rowwise_offsets expects offsets to be set");
-
-  TORCH_CHECK(weight.ndimension() == 2);
-  TORCH_CHECK(indices.ndimension() == 1);
-
-  auto offsets = offsets_in.value();
-  TORCH_CHECK(offsets.ndimension() == 1);
+#ifdef USE_FBGEMM
+// Returns the FBGEMM kernel that `generate` makes for a configuration of the
+// N-bit embedding_bag, generated on its first call and cached for the next
+// ones, since making it (even when FBGEMM finds its code in its own cache)
+// costs far more than a lookup of a small batch of bags. There is a cache per
+// call site, i.e., per kind of kernel and per index type.
+template <typename Kernel, typename Generator>
+const Kernel& cached_nbit_kernel(
+    int bit_rate,
+    int64_t block_size,
+    bool has_weight,
+    bool normalize_by_lengths,
+    Generator generate) {
+  using Key = std::tuple<int, int64_t, bool, bool>;
+  static std::mutex mutex;
+  static std::map<Key, Kernel> kernels;
+  std::lock_guard<std::mutex> lock(mutex);
+  const Key key{bit_rate, block_size, has_weight, normalize_by_lengths};
+  auto it = kernels.find(key);
+  if (it == kernels.end()) {
+    it = kernels.emplace(key, generate()).first;
+  }
+  return it->second;
+}
+#endif
 
-  // FBGEMM expects the offsets to be of int type.
-  at::Tensor offsets_new = offsets.toType(ScalarType::Int);
+// Sums (or averages) the bags of `indices` delimited by the output_size + 1
+// `offsets_data` of a weight of N-bit rows, each followed by its fp16 scale
+// and bias, into `output`. The bags are split between the threads of the
+// intra-op pool, and the indices and offsets are read in their own type.
+template <typename IndexType, typename OffsetType>
+void embedding_bag_nbit_impl(
+    at::Tensor& output,
+    const at::Tensor& weight,
+    const int bit_rate,
+    const at::Tensor& indices,
+    const OffsetType* offsets_data,
+    bool pruned_weights,
+    const c10::optional<at::Tensor>& per_sample_weights_,
+    const c10::optional<at::Tensor>& compressed_indices_mapping,
+    bool normalize_by_lengths) {
+  const int64_t output_size = output.size(0);
+  const int64_t block_size = output.size(1);
+  const int64_t N = weight.size(0);
+  const int64_t index_size = indices.numel();
 
-  auto offsets_data = offsets_new.data_ptr<int>();
-  const auto weight_data = weight.data_ptr<uint8_t>();
-  uint8_t* input_data = nullptr;
-  if (!weight.is_contiguous()) {
-    auto weight_contig = weight.contiguous();
-    input_data = weight_contig.data_ptr<uint8_t>();
-  } else {
-    input_data = weight.data_ptr<uint8_t>();
-  }
+  const auto weight_contig = weight.contiguous();
+  const uint8_t* input_data = weight_contig.data_ptr<uint8_t>();
+  const IndexType* indices_data = indices.data_ptr<IndexType>();
+  const float* per_sample_weights_data = per_sample_weights_.has_value()
+      ? per_sample_weights_.value().data_ptr<float>()
+      : nullptr;
+  float* output_data = output.data_ptr<float>();
 
   // Get compressed indices for sparse op.
-  int32_t* compressed_indices_mapping_data = nullptr;
-  int compressed_index_size = 0;
-  if (sparse) {
+  const int32_t* compressed_indices_mapping_data = nullptr;
+  int64_t compressed_index_size = 0;
+  if (pruned_weights) {
+    TORCH_CHECK(
+        compressed_indices_mapping.has_value(),
+        "embedding_bag_", bit_rate,
+        "bit_rowwise_offsets expects compressed_indices_mapping to be set for sparse weights");
     compressed_index_size = compressed_indices_mapping.value().numel();
     compressed_indices_mapping_data =
         compressed_indices_mapping.value().data_ptr<int32_t>();
   }
+  TORCH_CHECK(
+      offsets_data[output_size] <= index_size,
+      "Expect the offsets to be at most the number of indices");
 
-  const auto indices_data = indices.data_ptr<int64_t>();
-  const int64_t N = weight.size(0);
-  const int64_t D =
-      (weight.size(1) - 4) * 2; // NB: 2-byte fp16 scale and 2-byte zero_offset
-  const int64_t M = offsets.size(0);
+#ifdef USE_FBGEMM
+  constexpr int prefetch_distance = 16;
+  const bool has_weight = per_sample_weights_.has_value();
+  using DenseKernel =
+      decltype(fbgemm::GenerateEmbeddingSpMDMNBit<IndexType>(0, 0, false, false));
+  using SparseKernel = decltype(
+      fbgemm::GenerateEmbeddingSpMDMNBitRowWiseSparse<IndexType>(0, 0, false, false));
+  const DenseKernel* dense_kernel = nullptr;
+  const SparseKernel* sparse_kernel = nullptr;
+  if (!pruned_weights) {
+    dense_kernel = &cached_nbit_kernel<DenseKernel>(
+        bit_rate, block_size, has_weight, normalize_by_lengths, [&]() {
+          return fbgemm::GenerateEmbeddingSpMDMNBit<IndexType>(
+              /*bit rate=*/bit_rate,
+              /*block size=*/block_size,
+              /*has weights=*/has_weight,
+              /*normalize_by_lengths=*/normalize_by_lengths,
+              /*prefetch distance=*/prefetch_distance,
+              /*is_weight_positional=*/false,
+              /*use_offsets=*/true);
+        });
+  } else {
+    sparse_kernel = &cached_nbit_kernel<SparseKernel>(
+        bit_rate, block_size, has_weight, normalize_by_lengths, [&]() {
+          return fbgemm::GenerateEmbeddingSpMDMNBitRowWiseSparse<IndexType>(
+              /*bit rate=*/bit_rate,
+              /*block_size=*/block_size,
+              /*has weights=*/has_weight,
+              /*normalize_by_lengths=*/normalize_by_lengths,
+              /*prefetch distance*/ prefetch_distance,
+              /*is_weight_positional*/ false,
+              /*use_offsets*/ true);
+        });
+  }
 
-  int64_t output_size = M - 1;
-  std::vector<int> offsets_include_last_val;
+  at::parallel_for(
+      0, output_size, 1, [&](int64_t start_idx, int64_t end_idx) {
+        const OffsetType first = offsets_data[start_idx];
+        // The kernels take int offsets. Those of a range of bags are rebased
+        // to its first index, which keeps them in range of an int.
+        const int* range_offsets = nullptr;
+        std::vector<int> range_offsets_int;
+        if (std::is_same<OffsetType, int32_t>::value) {
+          range_offsets = reinterpret_cast<const int*>(offsets_data + start_idx);
+        } else {
+          range_offsets_int.resize(end_idx - start_idx + 1);
+          for (int64_t m = start_idx; m <= end_idx; ++m) {
+            range_offsets_int[m - start_idx] =
+                static_cast<int>(offsets_data[m] - first);
+          }
+          range_offsets = range_offsets_int.data();
+        }
+        const int64_t range_index_size = offsets_data[end_idx] - first;
+        const float* range_weights =
+            has_weight ? per_sample_weights_data + first : nullptr;
+        float* range_output = output_data + start_idx * block_size;
+
+        bool success = false;
+        if (!pruned_weights) {
+          success = (*dense_kernel)(
+              /*output_size=*/end_idx - start_idx,
+              /*index_size=*/range_index_size,
+              /*data_size=*/N,
+              /*input=*/input_data,
+              /*indices=*/indices_data + first,
+              /*offsets=*/range_offsets,
+              /*weights=*/range_weights,
+              /*output=*/range_output);
+        } else {
+          success = (*sparse_kernel)(
+              /*output_size=*/end_idx - start_idx,
+              /*index_size=*/range_index_size,
+              /*data_size=*/compressed_index_size,
+              /*input=*/input_data,
+              /*indices=*/indices_data + first,
+              /*offsets=*/range_offsets,
+              /*weights=*/range_weights,
+              /*output=*/range_output,
+              /*compressed_indices_table=*/compressed_indices_mapping_data);
+        }
+        TORCH_CHECK(
+            success,
+            "FBGEMM GenerateEmbeddingSpMDMNBit",
+            pruned_weights ? "RowWiseSparse" : "",
+            " kernel failed for ", bit_rate, "-bit input");
+      });
+#else
+  const int64_t num_elem_per_byte = 8 / bit_rate;
+  const int64_t weight_columns = weight.size(1);
+  const int64_t scale_bias_offset =
+      (block_size + num_elem_per_byte - 1) / num_elem_per_byte;
+  at::parallel_for(
+      0, output_size, 1, [&](int64_t start_idx, int64_t end_idx) {
+        for (int64_t m = start_idx; m < end_idx; ++m) {
+          float* output_row = output_data + m * block_size;
+          memset(output_row, 0, block_size * sizeof(float));
+          const int64_t begin = offsets_data[m];
+          const int64_t end = offsets_data[m + 1];
+          TORCH_CHECK(
+              begin <= end, "Expect the offsets to be non-decreasing");
+
+          for (int64_t current = begin; current < end; ++current) {
+            int64_t idx;
+            if (!pruned_weights) {
+              idx = indices_data[current];
+              TORCH_CHECK((idx >= 0 && idx < N), "Invalid indices data");
+            } else {
+              int64_t uncompressed_idx = indices_data[current];
+              TORCH_CHECK(
+                  uncompressed_idx >= 0 &&
+                      uncompressed_idx < compressed_index_size,
+                  "Invalid indices data for Sparse Op.")
+              idx = compressed_indices_mapping_data[uncompressed_idx];
+              if (idx == -1) {
+                continue;
+              }
+            }
+            const uint8_t* input_row = input_data + idx * weight_columns;
+            const at::Half* scale_bias =
+                reinterpret_cast<const at::Half*>(input_row + scale_bias_offset);
+
+            float weight_val = 1.0f;
+            if (per_sample_weights_data) {
+              weight_val = per_sample_weights_data[current];
+            }
+            const float scale = weight_val * scale_bias[0];
+            const float bias = weight_val * scale_bias[1];
+
+            for (int64_t j = 0; j < block_size; ++j) {
+              uint8_t quantized = input_row[j / num_elem_per_byte];
+              quantized >>= (j % num_elem_per_byte) * bit_rate;
+              quantized &= (1 << bit_rate) - 1;
+
+              output_row[j] = fma(scale, quantized, output_row[j] + bias);
+            }
+          } // for each index of the bag
+          if (normalize_by_lengths && end > begin) {
+            const float inverse_length = 1.0f / (end - begin);
+            for (int64_t j = 0; j < block_size; ++j) {
+              output_row[j] *= inverse_length;
+            }
+          }
+        } // for each bag
+      });
+#endif
+}
+
+// The bags of the offsets of a type, with an offset past the last bag
+// appended to them unless `include_last_offset`.
+template <typename IndexType, typename OffsetType>
+void embedding_bag_nbit_offsets_impl(
+    at::Tensor& output,
+    const at::Tensor& weight,
+    const int bit_rate,
+    const at::Tensor& indices,
+    const at::Tensor& offsets,
+    bool pruned_weights,
+    const c10::optional<at::Tensor>& per_sample_weights_,
+    const c10::optional<at::Tensor>& compressed_indices_mapping,
+    bool normalize_by_lengths,
+    bool include_last_offset) {
+  const auto offsets_contig = offsets.contiguous();
+  const OffsetType* offsets_data = offsets_contig.data_ptr<OffsetType>();
+  const int64_t M = offsets.size(0);
+  std::vector<OffsetType> offsets_include_last_val;
   if (!include_last_offset) {
-    output_size = M;
     offsets_include_last_val.resize(M + 1);
-    // Avoid `null pointer passed as argument 2` ASAN violation when ofests
+    // Avoid `null pointer passed as argument 2` ASAN violation when offsets
     // tensor is empty.
     if (M > 0) {
       std::memcpy(
-          offsets_include_last_val.data(), offsets_data, sizeof(int) * M);
+          offsets_include_last_val.data(),
+          offsets_data,
+          sizeof(OffsetType) * M);
     }
     offsets_include_last_val[M] = indices.numel();
     offsets_data = offsets_include_last_val.data();
   }
+  embedding_bag_nbit_impl<IndexType, OffsetType>(
+      output,
+      weight,
+      bit_rate,
+      indices,
+      offsets_data,
+      pruned_weights,
+      per_sample_weights_,
+      compressed_indices_mapping,
+      normalize_by_lengths);
+}
 
-  const std::vector<int64_t> shape = {output_size, D};
-  auto output = at::empty(shape, weight.options().dtype(at::kFloat));
-  auto* output_data = output.data_ptr<float>();
-  const int64_t block_size = output.size(1);
-  TORCH_CHECK(block_size % 2 == 0, "block size must be divisible by 2");
-  const int index_size = indices.numel();
-  constexpr int prefetch_distance = 16;
-#ifdef USE_FBGEMM
-  if (!sparse) {
-    // Generate the fbgemm kernel
-    auto kernel_64_ = fbgemm::GenerateEmbeddingSpMDMNBit<std::int64_t>(
-        /*bit rate=*/4,
-        /*block size=*/block_size,
-        /*has weights=*/per_sample_weights_.has_value(),
-        /*normalize_by_lengths=*/false,
-        /*prefetch distance=*/prefetch_distance,
-        /*is_weight_positional=*/false,
-        /*use_offsets=*/true);
-
-    bool success = kernel_64_(
-        /*output_size=*/output_size,
-        /*index_size=*/index_size,
-        /*data_size=*/N,
-        /*input=*/input_data,
-        /*indices=*/indices_data,
-        /*offsets=*/offsets_data,
-        /*weights=*/
-        per_sample_weights_.has_value()
-            ? per_sample_weights_.value().data_ptr<float>()
-            : nullptr,
-        /*output=*/output_data);
+Tensor embedding_bag_nbit_helper(
+    const Tensor& weight,
+    const int bit_rate,
+    const Tensor& indices,
+    const c10::optional<Tensor>& offsets_in,
+    const int64_t mode,
+    bool pruned_weights,
+    const c10::optional<Tensor>& per_sample_weights_,
+    const c10::optional<Tensor>& compressed_indices_mapping,
+    bool include_last_offset) {
+  TORCH_CHECK(
+      offsets_in.has_value(),
+      "embedding_bag_", bit_rate, "bit_rowwise_offsets expects offsets to be set");
 
+  TORCH_CHECK(weight.ndimension() == 2);
+  TORCH_CHECK(weight.scalar_type() == at::kByte);
+  TORCH_CHECK(indices.ndimension() == 1);
+
+  auto offsets = offsets_in.value();
+  TORCH_CHECK(offsets.ndimension() == 1);
+  TORCH_CHECK(
+      indices.scalar_type() == at::kInt || indices.scalar_type() == at::kLong,
+      "Expect 32 or 64 bit indices, but found ", indices.scalar_type(),
+      " instead.");
+  TORCH_CHECK(
+      offsets.scalar_type() == indices.scalar_type(),
+      "Expect the offsets to be of the type of the indices, ",
+      indices.scalar_type(), ", but found ", offsets.scalar_type(),
+      " instead.");
+  // Modes of embedding_bag, as in EmbeddingBag.cpp.
+  TORCH_CHECK(
+      mode == 0 || mode == 1,
+      "embedding_bag_", bit_rate, "bit_rowwise_offsets only supports the sum (0) and mean (1) modes");
+  TORCH_CHECK(
+      !per_sample_weights_.has_value() || mode == 0,
+      "embedding_bag_", bit_rate,
+      "bit_rowwise_offsets: per_sample_weights is only supported for the sum mode");
+  if (per_sample_weights_.has_value()) {
     TORCH_CHECK(
-        success,
-        "FBGEMM GenerateEmbeddingSpMDMNBit kernel failed for 4-bit input");
-  } else {
-    auto kernel_64_ =
-        fbgemm::GenerateEmbeddingSpMDMNBitRowWiseSparse<std::int64_t>(
-            /*bit rate=*/4,
-            /*block_size=*/block_size,
-            /*has weights=*/per_sample_weights_.has_value(),
-            /*normalize_by_lengths=*/false,
-            /*prefetch distance*/ prefetch_distance,
-            /*is_weight_positional*/ false,
-            /*use_offsets*/ true);
-    bool success = kernel_64_(
-        /*output_size=*/output_size,
-        /*index_size=*/index_size,
-        /*data_size=*/compressed_index_size,
-        /*input=*/weight_data,
-        /*indices=*/indices_data,
-        /*offsets=*/offsets_data,
-        /*weights=*/
-        per_sample_weights_.has_value()
-            ? per_sample_weights_.value().data_ptr<float>()
-            : nullptr,
-        /*output=*/output_data,
-        /*compressed_indices_table=*/compressed_indices_mapping_data);
-    TORCH_CHECK(
-        success,
-        "FBGEMM GenerateEmbeddingSpMDMNBitRowWiseSparse kernel failed for 4-bit input");
+        per_sample_weights_.value().scalar_type() == at::kFloat &&
+            per_sample_weights_.value().is_contiguous() &&
+            per_sample_weights_.value().numel() == indices.numel(),
+        "Expect per_sample_weights to be a contiguous float tensor of one weight per index");
   }
-#else
 
-  auto accessor = offsets.accessor<int64_t, 1>();
-  std::vector<int> lengths_data;
+  const int64_t num_elem_per_byte = 8 / bit_rate;
+  // NB: 2-byte fp16 scale and 2-byte zero_offset
+  const int64_t D = (weight.size(1) - 2 * sizeof(at::Half)) * num_elem_per_byte;
+  const int64_t M = offsets.size(0);
+  const int64_t output_size = include_last_offset ? M - 1 : M;
 
-  int64_t lower = accessor[0];
-  for (int64_t i = 1; i < offsets.numel(); ++i) {
-    lengths_data.push_back(accessor[i] - lower);
-    lower = accessor[i];
-  }
-  if (!include_last_offset) {
-    lengths_data.push_back(indices.numel() - lower);
+  const std::vector<int64_t> shape = {output_size, D};
+  auto output = at::empty(shape, weight.options().dtype(at::kFloat));
+  if (output_size == 0) {
+    return output;
   }
 
-  int64_t current = 0;
-  float* per_sample_weights_data;
-  if (per_sample_weights_.has_value()) {
-    per_sample_weights_data = per_sample_weights_.value().data_ptr<float>();
+  const auto indices_contig = indices.contiguous();
+  const bool normalize_by_lengths = mode == 1;
+  if (indices.scalar_type() == at::kInt) {
+    embedding_bag_nbit_offsets_impl<int32_t, int32_t>(
+        output,
+        weight,
+        bit_rate,
+        indices_contig,
+        offsets,
+        pruned_weights,
+        per_sample_weights_,
+        compressed_indices_mapping,
+        normalize_by_lengths,
+        include_last_offset);
+  } else {
+    embedding_bag_nbit_offsets_impl<int64_t, int64_t>(
+        output,
+        weight,
+        bit_rate,
+        indices_contig,
+        offsets,
+        pruned_weights,
+        per_sample_weights_,
+        compressed_indices_mapping,
+        normalize_by_lengths,
+        include_last_offset);
   }
-  for (int m = 0; m < output_size; ++m) {
-    memset(output_data, 0, block_size * sizeof(float));
-    TORCH_CHECK(
-        current + lengths_data[m] <= index_size,
-        "Expect the lengths data to be less than indices size");
-
-    for (int i = 0; i < lengths_data[m]; ++i, ++current) {
-      int64_t idx;
-      if (!sparse) {
-        idx = indices_data[current];
-        TORCH_CHECK((idx >= 0 && idx < N), "Invalid indices data");
-      } else {
-        int64_t uncompressed_idx = indices_data[current];
-        TORCH_CHECK(
-            uncompressed_idx >= 0 && uncompressed_idx < compressed_index_size,
-            "Invalid indices data for Sparse Op.")
-        idx = compressed_indices_mapping_data[uncompressed_idx];
-        if (idx == -1) {
-          continue;
-        }
-      }
-      const at::Half* scale_bias = reinterpret_cast<const at::Half*>(
-          input_data + (idx + 1) * weight.size(1) - 2 * sizeof(at::Half));
-
-      float weight_val = 1.0f;
-      if (per_sample_weights_.has_value()) {
-        weight_val = per_sample_weights_data[current];
-      }
-      const float scale = weight_val * scale_bias[0];
-      const float bias = weight_val * scale_bias[1];
-
-      for (int j = 0; j < block_size; ++j) {
-        uint8_t quantized =
-            input_data[idx * weight.size(1) + j / /*NUM_ELEM_PER_BYTE*/ 2];
-        quantized >>= (j % 2) * 4;
-        quantized &= (1 << 4) - 1;
-
-        output_data[j] = fma(scale, quantized, output_data[j] + bias);
-      }
-    } // for each i
-    output_data += block_size;
-  } // for each m
-
-#endif
   return output;
 }
 
+Tensor embedding_bag_4bit_rowwise_offsets(
+    const Tensor& weight,
+    const Tensor& indices,
+    const c10::optional<Tensor>& offsets_in,
+    const bool /* scale_grad_by_freq */,
+    const int64_t mode,
+    bool sparse,
+    const c10::optional<Tensor>& per_sample_weights_,
+    const c10::optional<Tensor>& compressed_indices_mapping,
+    bool include_last_offset) {
+  return embedding_bag_nbit_helper(
+      weight,
+      4,
+      indices,
+      offsets_in,
+      mode,
+      sparse,
+      per_sample_weights_,
+      compressed_indices_mapping,
+      include_last_offset);
+}
+
+Tensor embedding_bag_2bit_rowwise_offsets(
+    const Tensor& weight,
+    const Tensor& indices,
+    const c10::optional<Tensor>& offsets_in,
+    const bool /* scale_grad_by_freq */,
+    const int64_t mode,
+    bool sparse,
+    const c10::optional<Tensor>& per_sample_weights_,
+    const c10::optional<Tensor>& compressed_indices_mapping,
+    bool include_last_offset) {
+  return embedding_bag_nbit_helper(
+      weight,
+      2,
+      indices,
+      offsets_in,
+      mode,
+      sparse,
+      per_sample_weights_,
+      compressed_indices_mapping,
+      include_last_offset);
+}
+
 template <int bit_rate>
 class QEmbeddingBag final {
  public:
@@ -429,6 +636,8 @@ TORCH_LIBRARY_IMPL(quantized, CPU, m) {
       "embedding_bag_byte_rowwise_offsets", embedding_bag_byte_rowwise_offsets);
   m.impl(
       "embedding_bag_4bit_rowwise_offsets", embedding_bag_4bit_rowwise_offsets);
+  m.impl(
+      "embedding_bag_2bit_rowwise_offsets", embedding_bag_2bit_rowwise_offsets);
 }
 } // namespace
 } // namespace native
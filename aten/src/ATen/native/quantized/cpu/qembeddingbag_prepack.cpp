@@ -137,19 +137,28 @@ Tensor qembeddingbag_byte_prepack(const Tensor& weight) {
   return output;
 }
 
-Tensor qembeddingbag_4bit_prepack(const Tensor& weight) {
+// Quantizes every row of a float weight to `bit_rate` bits, with a scale and
+// bias (Xmin) of its own, and packs 8 / bit_rate values in a byte.
+Tensor qembeddingbag_nbit_prepack_helper(const Tensor& weight, int bit_rate) {
+  TORCH_CHECK(
+      weight.dim() == 2,
+      "quantized::embedding_bag_", bit_rate,
+      "bit_prepack weight tensor rank should be 2");
+  TORCH_CHECK(
+      weight.scalar_type() == at::kFloat,
+      "quantized::embedding_bag_", bit_rate,
+      "bit_prepack expects a float weight");
   int64_t embedding_rows = weight.size(0);
   int64_t embedding_cols = weight.size(1);
 
   Tensor weight_contig = weight.contiguous(weight.suggest_memory_format());
 
-  const auto weight_data = weight.data_ptr<float>();
-  constexpr int BIT_RATE = 4;
-  constexpr int NUM_ELEM_PER_BYTE = 8 / BIT_RATE;
+  const auto weight_data = weight_contig.data_ptr<float>();
+  const int NUM_ELEM_PER_BYTE = 8 / bit_rate;
   TORCH_CHECK(
       weight_contig.size(weight.dim() - 1) % NUM_ELEM_PER_BYTE == 0,
-      "FloatToFused4BitRowwiseQuantizedOp only works for the number of "
-      "columns a multiple of 2");
+      "FloatToFused", bit_rate, "BitRowwiseQuantizedOp only works for the number of "
+      "columns a multiple of ", NUM_ELEM_PER_BYTE);
 
   // The "fused" representation stores the scale and bias with the
   // row-wise quantized data in one tensor.
@@ -169,56 +178,68 @@ Tensor qembeddingbag_4bit_prepack(const Tensor& weight) {
   auto* output_data = output.data_ptr<uint8_t>();
   const auto output_columns = output.size(output.dim() - 1);
 
-  for (int row = 0; row < embedding_rows; ++row) {
-    const float* input_row = weight_data + row * embedding_cols;
-    std::uint8_t* output_row = output_data + row * output_columns;
+  at::parallel_for(
+      0, embedding_rows, 1, [&](int64_t start_idx, int64_t end_idx) {
+        for (int64_t row = start_idx; row < end_idx; ++row) {
+          const float* input_row = weight_data + row * embedding_cols;
+          std::uint8_t* output_row = output_data + row * output_columns;
 
-    float Xmin = *std::min_element(input_row, input_row + embedding_cols);
-    float Xmax = *std::max_element(input_row, input_row + embedding_cols);
-
-    Xmin = static_cast<at::Half>(Xmin);
-    const float range = Xmax - Xmin;
-
-    // Set scale to 1.0f for the corner case of Xmax == Xmin .
-    // Any non-zero scale would work because during quantization
-    // (X - Xmin) / scale will be 0 for all X unless scale is 0.
-    at::Half scale = range == 0 ? 1.0f : range / ((1 << BIT_RATE) - 1);
-    float inverse_scale = scale == 0 ? 1.0f : 1.0f / scale;
-    if (scale == 0 || std::isinf(inverse_scale)) {
-      // Corner case handling when Xmax == Xmin
-      // Any scale would work because X - Xmin will be 0 for all X
-      scale = 1.0f;
-      inverse_scale = 1.0f;
-    }
-
-    // Update the scale and zero_point of each row.
-    at::Half* output_row_scale_zp = reinterpret_cast<at::Half*>(
-        output_row +
-        (embedding_cols + NUM_ELEM_PER_BYTE - 1) / NUM_ELEM_PER_BYTE);
-
-    output_row_scale_zp[0] = scale;
-    output_row_scale_zp[1] = Xmin;
-
-    // Pack the weight values.
-    for (int col = 0; col < embedding_cols; ++col) {
-      float X = input_row[col];
-      std::uint8_t quantized = std::max(
-          0,
-          std::min<int>(
-              lrintf((X - Xmin) * inverse_scale), (1 << BIT_RATE) - 1));
-      // We pack 2 4-bit values in a byte. Index 0 is packed in the lower 4-bits
-      // and index 1 is packed in the upper 4-bits.
-      if (col % NUM_ELEM_PER_BYTE == 0) {
-        output_row[col / NUM_ELEM_PER_BYTE] = quantized;
-      } else {
-        output_row[col / NUM_ELEM_PER_BYTE] |=
-            (quantized << ((col % NUM_ELEM_PER_BYTE) * BIT_RATE));
-      }
-    } // embedding_cols
-  } // embedding_rows
+          float Xmin = *std::min_element(input_row, input_row + embedding_cols);
+          float Xmax = *std::max_element(input_row, input_row + embedding_cols);
+
+          Xmin = static_cast<at::Half>(Xmin);
+          const float range = Xmax - Xmin;
+
+          // Set scale to 1.0f for the corner case of Xmax == Xmin .
+          // Any non-zero scale would work because during quantization
+          // (X - Xmin) / scale will be 0 for all X unless scale is 0.
+          at::Half scale = range == 0 ? 1.0f : range / ((1 << bit_rate) - 1);
+          float inverse_scale = scale == 0 ? 1.0f : 1.0f / scale;
+          if (scale == 0 || std::isinf(inverse_scale)) {
+            // Corner case handling when Xmax == Xmin
+            // Any scale would work because X - Xmin will be 0 for all X
+            scale = 1.0f;
+            inverse_scale = 1.0f;
+          }
+
+          // Update the scale and zero_point of each row.
+          at::Half* output_row_scale_zp = reinterpret_cast<at::Half*>(
+              output_row +
+              (embedding_cols + NUM_ELEM_PER_BYTE - 1) / NUM_ELEM_PER_BYTE);
+
+          output_row_scale_zp[0] = scale;
+          output_row_scale_zp[1] = Xmin;
+
+          // Pack the weight values.
+          for (int64_t col = 0; col < embedding_cols; ++col) {
+            float X = input_row[col];
+            std::uint8_t quantized = std::max(
+                0,
+                std::min<int>(
+                    lrintf((X - Xmin) * inverse_scale), (1 << bit_rate) - 1));
+            // We pack NUM_ELEM_PER_BYTE values in a byte, from its lower bits
+            // to its upper ones, e.g., for 4 bits index 0 is packed in the
+            // lower 4-bits and index 1 is packed in the upper 4-bits.
+            if (col % NUM_ELEM_PER_BYTE == 0) {
+              output_row[col / NUM_ELEM_PER_BYTE] = quantized;
+            } else {
+              output_row[col / NUM_ELEM_PER_BYTE] |=
+                  (quantized << ((col % NUM_ELEM_PER_BYTE) * bit_rate));
+            }
+          } // embedding_cols
+        } // embedding_rows
+      });
   return output;
 }
 
+Tensor qembeddingbag_4bit_prepack(const Tensor& weight) {
+  return qembeddingbag_nbit_prepack_helper(weight, 4 /*bit_rate*/);
+}
+
+Tensor qembeddingbag_2bit_prepack(const Tensor& weight) {
+  return qembeddingbag_nbit_prepack_helper(weight, 2 /*bit_rate*/);
+}
+
 class QEmbeddingPackWeights final {
  public:
   static c10::intrusive_ptr<EmbeddingPackedParamsBase> run(at::Tensor weight) {
@@ -229,6 +250,7 @@ class QEmbeddingPackWeights final {
 TORCH_LIBRARY_IMPL(quantized, CPU, m) {
   m.impl("embedding_bag_byte_prepack", qembeddingbag_byte_prepack);
   m.impl("embedding_bag_4bit_prepack", qembeddingbag_4bit_prepack);
+  m.impl("embedding_bag_2bit_prepack", qembeddingbag_2bit_prepack);
 }
 TORCH_LIBRARY_IMPL(quantized, QuantizedCPU, m) {
   m.impl("embedding_bag_prepack", TORCH_FN(QEmbeddingPackWeights::run));
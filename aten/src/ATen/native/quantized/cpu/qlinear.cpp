@@ -271,7 +271,7 @@ at::Tensor PackedLinearWeightsQnnp::apply_impl(
       at::Tensor bias_quant_scales =
           weight_contig.q_per_channel_scales() * input_scale;
       at::Tensor bias_zp = at::zeros(bias_quant_scales.sizes(), c10::kInt);
-      qbias = at::native::quantize_per_channel_cpu(
+      qbias = at::native::quantize_per_channel(
           bias_fp32, bias_quant_scales, bias_zp, 0, c10::kQInt32);
     } else {
       qbias = at::native::quantize_per_tensor(
@@ -395,6 +395,12 @@ TORCH_LIBRARY_IMPL(quantized, QuantizedCPU, m) {
   m.impl("linear_relu", TORCH_FN(QLinearInt8<true>::run));
 }
 
+// The packed weights of CUDA tensors are prepacked by quantized/cuda/qlinear.cu.
+TORCH_LIBRARY_IMPL(quantized, QuantizedCUDA, m) {
+  m.impl("linear", TORCH_FN(QLinearInt8<false>::run));
+  m.impl("linear_relu", TORCH_FN(QLinearInt8<true>::run));
+}
+
 TORCH_LIBRARY_IMPL(_quantized, QuantizedCPU, m) {
   m.impl("linear", TORCH_FN(QLinearInt8<false>::run));
 }
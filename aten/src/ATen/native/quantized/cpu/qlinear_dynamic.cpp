@@ -16,6 +16,43 @@
 torch::class_<LinearPackedParamsBase> register_linear_params();
 
 #ifdef USE_FBGEMM
+namespace {
+// The elements of the input whose range a thread finds at least.
+constexpr int64_t kMinMaxGrainSize = 32768;
+
+// Finds the range of the input of a dynamic linear, in chunks split between
+// the threads of the intra-op pool. This is the only pass over the input
+// before the GEMM: the input is quantized as it is packed.
+void find_min_max_parallel(
+    const float* input_ptr,
+    int64_t numel,
+    float* x_min,
+    float* x_max) {
+  const int64_t num_chunks = std::max<int64_t>(
+      1,
+      std::min<int64_t>(at::get_num_threads(), numel / kMinMaxGrainSize));
+  if (num_chunks == 1) {
+    fbgemm::FindMinMax(input_ptr, x_min, x_max, numel);
+    return;
+  }
+  const int64_t chunk_size = (numel + num_chunks - 1) / num_chunks;
+  std::vector<float> chunk_min(num_chunks);
+  std::vector<float> chunk_max(num_chunks);
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t chunk = begin; chunk < end; ++chunk) {
+      const int64_t start = chunk * chunk_size;
+      fbgemm::FindMinMax(
+          input_ptr + start,
+          &chunk_min[chunk],
+          &chunk_max[chunk],
+          std::min(chunk_size, numel - start));
+    }
+  });
+  *x_min = *std::min_element(chunk_min.begin(), chunk_min.end());
+  *x_max = *std::max_element(chunk_max.begin(), chunk_max.end());
+}
+} // namespace
+
 template <bool ReluFused>
 at::Tensor PackedLinearWeight::apply_dynamic_impl(at::Tensor input, bool reduce_range) {
   using at::Tensor;
@@ -50,11 +87,11 @@ at::Tensor PackedLinearWeight::apply_dynamic_impl(at::Tensor input, bool reduce_
 
   // Calculate statistics for quantization of the input Tensor
   float x_min, x_max;
-  fbgemm::FindMinMax(
-      /*m=*/input_ptr,
-      /*min=*/&x_min,
-      /*max=*/&x_max,
-      /*len=*/input.numel());
+  find_min_max_parallel(
+      /*input_ptr=*/input_ptr,
+      /*numel=*/input.numel(),
+      /*x_min=*/&x_min,
+      /*x_max=*/&x_max);
 
   // Input tensor is quantized as 8-bit unsigned values
   static constexpr int precision = 8;
@@ -80,15 +117,15 @@ at::Tensor PackedLinearWeight::apply_dynamic_impl(at::Tensor input, bool reduce_
   // ReQuantizeForFloat won't index past 0.
 
   const float* bias_ptr = nullptr;
-  at::Tensor bias_vec;
+  at::Tensor bias_contig;
   if (bias_.has_value()) {
-    bias_vec = bias_.value();
+    const at::Tensor& bias_vec = bias_.value();
     TORCH_CHECK(bias_vec.dim() == 1, "bias should be a vector (1D Tensor)");
     TORCH_CHECK(
         bias_vec.size(0) == N,
         "bias should have N elements: " + std::to_string(N));
     // TODO: contiguous is called for further jit optimizations.
-    auto bias_contig = bias_vec.contiguous();
+    bias_contig = bias_vec.contiguous();
     bias_ptr = bias_contig.data_ptr<float>();
   }
   // The resulting matrix here is 2-D, let's view it with the original
@@ -372,19 +409,35 @@ at::Tensor PackedLinearWeightFp16::apply_dynamic_impl(at::Tensor input) {
   output_size.back() = N;
   at::Tensor output = at::empty(output_size, input.options().dtype(at::kFloat));
 
-  // Call the fp16 gemm interface
-  fbgemm::cblas_gemm_compute(
-      fbgemm::matrix_op_t::NoTranspose,
-      M,
-      input_ptr,
-      packed_weight_fp16,
-      0.0f,
-      output.data_ptr<float>());
-
-  // Add bias term
+  // The bias is added by the GEMM, which accumulates into an output holding
+  // the bias of every row (beta = 1) rather than into an empty one.
+  float beta = 0.0f;
   if (bias_.has_value()) {
-    TORCH_CHECK(bias_->dim() == 1);
-    output.add_(*bias_);
+    TORCH_CHECK(bias_->dim() == 1 && bias_->size(0) == N,
+        "bias should have N elements: " + std::to_string(N));
+    output.copy_(bias_->expand_as(output));
+    beta = 1.0f;
+  }
+
+  // Call the fp16 gemm interface, splitting it between the threads of the
+  // intra-op pool.
+  int num_tasks = at::get_num_threads();
+  at::parallel_for(0, num_tasks, 1, [&](int64_t begin, int64_t end) {
+    for (int task_id = begin; task_id < end; ++task_id) {
+      fbgemm::cblas_gemm_compute(
+          /*transa=*/fbgemm::matrix_op_t::NoTranspose,
+          /*m=*/M,
+          /*A=*/input_ptr,
+          /*Bp=*/packed_weight_fp16,
+          /*beta=*/beta,
+          /*C=*/output.data_ptr<float>(),
+          /*thread_id=*/task_id,
+          /*num_threads=*/num_tasks);
+    }
+  });
+
+  if (ReluFused) {
+    output.relu_();
   }
 
   return output;
@@ -438,8 +491,11 @@ class QLinearDynamicFp16 final {
     TORCH_CHECK(
         fbgemm::fbgemmSupportedCPU(), "Your CPU doesn't support FBGEMM.");
 
-    TORCH_INTERNAL_ASSERT(!ReluFused);
-    return packed_weight->apply_dynamic(std::move(input));
+    if (ReluFused) {
+      return packed_weight->apply_dynamic_relu(std::move(input));
+    } else {
+      return packed_weight->apply_dynamic(std::move(input));
+    }
   }
 #else // USE_FBGEMM
   static at::Tensor run(
@@ -458,6 +514,7 @@ TORCH_LIBRARY_IMPL(quantized, CPU, m) {
   m.impl("linear_dynamic", TORCH_FN(QLinearDynamicInt8<false>::run));
   m.impl("linear_relu_dynamic", TORCH_FN(QLinearDynamicInt8<true>::run));
   m.impl("linear_dynamic_fp16", TORCH_FN(QLinearDynamicFp16<false>::run));
+  m.impl("linear_relu_dynamic_fp16", TORCH_FN(QLinearDynamicFp16<true>::run));
 }
 
 TORCH_LIBRARY_IMPL(_quantized, CPU, m) {
@@ -54,6 +54,71 @@ void dequantize_tensor_per_tensor_affine_cuda(
       });
 }
 
+// Views the scales or zero points of the channels along `axis` of `like` on
+// its device, so that TensorIterator broadcasts them along the other
+// dimensions.
+Tensor channel_params_view(
+    const Tensor& params,
+    const Tensor& like,
+    int64_t axis) {
+  std::vector<int64_t> sizes(like.dim(), 1);
+  sizes[axis] = params.numel();
+  return params.to(like.device()).view(sizes);
+}
+
+void quantize_tensor_per_channel_affine_cuda(
+    Tensor rtensor,
+    Tensor qtensor,
+    Tensor scales,
+    Tensor zero_points,
+    int64_t axis) {
+  AT_DISPATCH_QINT_TYPES(
+      qtensor.scalar_type(), "quantize_tensor_per_channel_affine_cuda", [&]() {
+        constexpr int64_t qmin = std::numeric_limits<underlying_t>::min();
+        constexpr int64_t qmax = std::numeric_limits<underlying_t>::max();
+
+        auto iter = TensorIteratorConfig()
+          .check_all_same_dtype(false)
+          .add_output(qtensor)
+          .add_input(rtensor)
+          .add_input(channel_params_view(scales, rtensor, axis))
+          .add_input(channel_params_view(zero_points, rtensor, axis))
+          .build();
+
+        gpu_kernel(iter,
+          [=] GPU_LAMBDA (float raw_val, double scale, int64_t zero_point) -> scalar_t {
+            int64_t qvalue = static_cast<int64_t>(nearbyint(raw_val / scale + zero_point));
+            qvalue = std::max<int64_t>(qvalue, qmin);
+            qvalue = std::min<int64_t>(qvalue, qmax);
+            scalar_t quantized_val;
+            quantized_val.val_ = qvalue;
+            return quantized_val;
+        });
+      });
+}
+
+void dequantize_tensor_per_channel_affine_cuda(
+    Tensor qtensor,
+    Tensor rtensor,
+    Tensor scales,
+    Tensor zero_points,
+    int64_t axis) {
+  AT_DISPATCH_QINT_TYPES(
+      qtensor.scalar_type(), "dequantize_tensor_per_channel_affine_cuda", [&]() {
+        auto iter = TensorIteratorConfig()
+          .check_all_same_dtype(false)
+          .add_output(rtensor)
+          .add_input(qtensor)
+          .add_input(channel_params_view(scales, qtensor, axis))
+          .add_input(channel_params_view(zero_points, qtensor, axis))
+          .build();
+        gpu_kernel(iter,
+          [=] GPU_LAMBDA (scalar_t value, double scale, int64_t zero_point) -> float {
+            return (static_cast<float>(value.val_) - zero_point) * scale;
+        });
+      });
+}
+
 } // anonymous namespace
 
 REGISTER_DISPATCH(
@@ -62,6 +127,12 @@ REGISTER_DISPATCH(
 REGISTER_DISPATCH(
     dequantize_tensor_per_tensor_affine_stub,
     &dequantize_tensor_per_tensor_affine_cuda);
+REGISTER_DISPATCH(
+    quantize_tensor_per_channel_affine_stub,
+    &quantize_tensor_per_channel_affine_cuda);
+REGISTER_DISPATCH(
+    dequantize_tensor_per_channel_affine_stub,
+    &dequantize_tensor_per_channel_affine_cuda);
 
 } // namespace native
 } // namespace at
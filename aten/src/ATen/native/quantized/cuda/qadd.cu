@@ -0,0 +1,47 @@
+#include <ATen/ATen.h>
+#include <ATen/native/TensorIterator.h>
+#include <ATen/native/cuda/Loops.cuh>
+#include <ATen/native/quantized/cpu/quantized_ops.h>
+#include <math.h>
+
+namespace at {
+namespace native {
+namespace {
+
+template <bool ReLUFused = false>
+void qadd_kernel_cuda(Tensor& out, const Tensor& self, const Tensor& other) {
+  const float inv_scale = 1.0f / out.q_scale();
+  const int64_t zero_point = out.q_zero_point();
+  const float self_scale = self.q_scale();
+  const int64_t self_zero_point = self.q_zero_point();
+  const float other_scale = other.q_scale();
+  const int64_t other_zero_point = other.q_zero_point();
+
+  auto iter = TensorIterator::binary_op(out, self, other);
+
+  AT_DISPATCH_QINT_TYPES(out.scalar_type(), "qadd_cuda", [&]() {
+    constexpr int64_t qmin = std::numeric_limits<underlying_t>::min();
+    constexpr int64_t qmax = std::numeric_limits<underlying_t>::max();
+    gpu_kernel(iter, [=] GPU_LAMBDA(scalar_t a, scalar_t b) -> scalar_t {
+      float c = (static_cast<float>(a.val_) - self_zero_point) * self_scale +
+          (static_cast<float>(b.val_) - other_zero_point) * other_scale;
+      if (ReLUFused) {
+        c = c > 0.0f ? c : 0.0f;
+      }
+      int64_t qvalue = static_cast<int64_t>(nearbyintf(c * inv_scale)) + zero_point;
+      qvalue = std::max<int64_t>(qvalue, qmin);
+      qvalue = std::min<int64_t>(qvalue, qmax);
+      scalar_t result;
+      result.val_ = qvalue;
+      return result;
+    });
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(qadd_relu_stub, &qadd_kernel_cuda<true>);
+REGISTER_DISPATCH(qadd_stub, &qadd_kernel_cuda<false>);
+
+} // namespace native
+} // namespace at
@@ -0,0 +1,300 @@
+#include <ATen/ATen.h>
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/Exceptions.h>
+#include <ATen/native/TensorIterator.h>
+#include <ATen/native/cuda/Loops.cuh>
+#include <ATen/native/quantized/cpu/packed_params.h>
+#include <torch/custom_class.h>
+#include <torch/library.h>
+#include <math.h>
+
+namespace at {
+namespace native {
+namespace {
+
+// The int8 GEMM of cuBLAS needs the leading dimensions of its operands to be
+// multiples of 4.
+constexpr int64_t kGemmAlignment = 4;
+
+int64_t round_up(int64_t value) {
+  return (value + kGemmAlignment - 1) / kGemmAlignment * kGemmAlignment;
+}
+
+// acc[m][n] = sum_k x[m][k] * w[n][k], for x of M x K and w of N x K, both
+// row major int8 with K a multiple of 4 and N a multiple of 4.
+void gemm_int8(const Tensor& x, const Tensor& w, Tensor& acc) {
+#ifdef __HIP_PLATFORM_HCC__
+  TORCH_CHECK(false, "quantized::linear is not supported on ROCm");
+#else
+  const int M = x.size(0);
+  const int N = w.size(0);
+  const int K = x.size(1);
+  const int32_t alpha = 1;
+  const int32_t beta = 0;
+  cublasHandle_t handle = at::cuda::getCurrentCUDABlasHandle();
+  // cuBLAS is column major: acc^T (N x M) = w (N x K) * x^T (K x M).
+  TORCH_CUDABLAS_CHECK(cublasGemmEx(
+      handle,
+      CUBLAS_OP_T,
+      CUBLAS_OP_N,
+      N,
+      M,
+      K,
+      &alpha,
+      w.data_ptr<int8_t>(),
+      CUDA_R_8I,
+      K,
+      x.data_ptr<int8_t>(),
+      CUDA_R_8I,
+      K,
+      &beta,
+      acc.data_ptr<int32_t>(),
+      CUDA_R_32I,
+      N,
+#if defined(CUDA_VERSION) && CUDA_VERSION >= 11000
+      CUBLAS_COMPUTE_32I,
+#else
+      CUDA_R_32I,
+#endif
+      CUBLAS_GEMM_DEFAULT_TENSOR_OP));
+#endif
+}
+
+struct PackedLinearWeightCuda : public LinearPackedParamsBase {
+  PackedLinearWeightCuda(
+      Tensor orig_weight,
+      c10::optional<Tensor> bias,
+      Tensor w,
+      Tensor w_row_sums,
+      Tensor w_scales,
+      Tensor w_zero_points)
+      : orig_weight_(std::move(orig_weight)),
+        bias_(std::move(bias)),
+        w_(std::move(w)),
+        w_row_sums_(std::move(w_row_sums)),
+        w_scales_(std::move(w_scales)),
+        w_zero_points_(std::move(w_zero_points)) {}
+
+  Tensor apply(Tensor input, double output_scale, int64_t output_zero_point)
+      override {
+    return apply_impl<false>(std::move(input), output_scale, output_zero_point);
+  }
+
+  Tensor apply_relu(
+      Tensor input,
+      double output_scale,
+      int64_t output_zero_point) override {
+    return apply_impl<true>(std::move(input), output_scale, output_zero_point);
+  }
+
+  Tensor apply_dynamic(Tensor input, bool reduce_range = false) override {
+    TORCH_CHECK(
+        false, "quantized::linear_dynamic is not supported on CUDA");
+  }
+
+  Tensor apply_dynamic_relu(Tensor input, bool reduce_range = false) override {
+    TORCH_CHECK(
+        false, "quantized::linear_relu_dynamic is not supported on CUDA");
+  }
+
+  std::tuple<Tensor, c10::optional<Tensor>> unpack() override {
+    return std::make_tuple(orig_weight_, bias_);
+  }
+
+  c10::optional<Tensor> bias() override {
+    return bias_;
+  }
+
+  void set_bias(c10::optional<Tensor> bias) override {
+    bias_ = std::move(bias);
+  }
+
+  static c10::intrusive_ptr<LinearPackedParamsBase> prepack(
+      Tensor weight,
+      c10::optional<Tensor> bias);
+
+ private:
+  template <bool ReluFused>
+  Tensor apply_impl(
+      Tensor input,
+      double output_scale,
+      int64_t output_zero_point);
+
+  Tensor orig_weight_;
+  c10::optional<Tensor> bias_;
+  // The int8 values of the weight, N x K padded to multiples of 4 with zeros.
+  Tensor w_;
+  // The sums of the rows of the weight, and its scales and zero points, of
+  // every output channel.
+  Tensor w_row_sums_;
+  Tensor w_scales_;
+  Tensor w_zero_points_;
+};
+
+c10::intrusive_ptr<LinearPackedParamsBase> PackedLinearWeightCuda::prepack(
+    Tensor weight,
+    c10::optional<Tensor> bias) {
+  TORCH_CHECK(
+      weight.dim() == 2,
+      "The weight tensor for quantized::linear_prepack (CUDA) should be 2-dimensional.");
+  TORCH_CHECK(
+      weight.scalar_type() == kQInt8,
+      "quantized::linear_prepack (CUDA) only supports qint8 weights, got ",
+      toString(weight.scalar_type()));
+  const auto qtype = weight.qscheme();
+  TORCH_CHECK(
+      qtype == kPerTensorAffine ||
+          (qtype == kPerChannelAffine && weight.q_per_channel_axis() == 0),
+      "quantized::linear_prepack (CUDA) only supports per tensor or per output "
+      "channel affine weights");
+  const int64_t N = weight.size(0);
+  const int64_t K = weight.size(1);
+  const auto device = weight.device();
+
+  auto w_int8 = weight.int_repr();
+  auto w = at::zeros({round_up(N), round_up(K)}, at::device(device).dtype(kChar));
+  w.narrow(0, 0, N).narrow(1, 0, K).copy_(w_int8);
+  auto w_row_sums = w_int8.sum(1, /*keepdim=*/false, kInt);
+
+  Tensor w_scales;
+  Tensor w_zero_points;
+  if (qtype == kPerTensorAffine) {
+    w_scales = at::full(
+        {N}, weight.q_scale(), at::device(device).dtype(kFloat));
+    w_zero_points = at::full(
+        {N}, weight.q_zero_point(), at::device(device).dtype(kInt));
+  } else {
+    w_scales = weight.q_per_channel_scales().to(device, kFloat);
+    w_zero_points = weight.q_per_channel_zero_points().to(device, kInt);
+  }
+
+  if (bias.has_value()) {
+    TORCH_CHECK(bias->dim() == 1, "bias should be a vector (1D Tensor)");
+    TORCH_CHECK(
+        bias->size(0) == N,
+        "bias should have N elements: " + std::to_string(N));
+    bias = bias->to(device, kFloat).contiguous();
+  }
+
+  return c10::make_intrusive<PackedLinearWeightCuda>(
+      std::move(weight),
+      std::move(bias),
+      std::move(w),
+      std::move(w_row_sums),
+      std::move(w_scales),
+      std::move(w_zero_points));
+}
+
+template <bool ReluFused>
+Tensor PackedLinearWeightCuda::apply_impl(
+    Tensor input,
+    double output_scale,
+    int64_t output_zero_point) {
+  TORCH_CHECK(
+      input.dim() >= 2,
+      "The dimension of input tensor should be larger than or equal to 2");
+  TORCH_CHECK(
+      input.scalar_type() == kQUInt8,
+      "quantized::linear (CUDA) expects quint8 inputs, got ",
+      toString(input.scalar_type()));
+  TORCH_CHECK(
+      input.qscheme() == kPerTensorAffine,
+      "quantized::linear (CUDA) expects per tensor affine inputs");
+  TORCH_CHECK(
+      input.device() == w_.device(),
+      "The input and the weight of quantized::linear should be on the same device");
+  const int64_t N = orig_weight_.size(0);
+  const int64_t K = orig_weight_.size(1);
+  TORCH_CHECK(
+      input.size(input.dim() - 1) == K,
+      "The number of rows in the packB should be equal to K: " +
+          std::to_string(K));
+  const int64_t M = input.numel() / K;
+  const auto device = input.device();
+
+  // Shift the quint8 input to int8 for the int8 GEMM; the zero point shifts
+  // with it.
+  const float input_scale = input.q_scale();
+  const int32_t input_zero_point = input.q_zero_point() - 128;
+  auto x = at::zeros({M, round_up(K)}, at::device(device).dtype(kChar));
+  auto x_valid = x.narrow(1, 0, K);
+  auto shift = TensorIteratorConfig()
+                   .check_all_same_dtype(false)
+                   .add_output(x_valid)
+                   .add_input(input.contiguous().view({M, K}))
+                   .build();
+  gpu_kernel(shift, [] GPU_LAMBDA(c10::quint8 value) -> int8_t {
+    return static_cast<int8_t>(static_cast<int32_t>(value.val_) - 128);
+  });
+  auto x_row_sums = x.sum(1, /*keepdim=*/true, kInt);
+
+  auto acc = at::empty({M, w_.size(0)}, at::device(device).dtype(kInt));
+  gemm_int8(x, w_, acc);
+
+  std::vector<int64_t> out_sizes = input.sizes().vec();
+  out_sizes.back() = N;
+  auto output = at::_empty_affine_quantized(
+      out_sizes,
+      at::device(device).dtype(kQUInt8),
+      output_scale,
+      output_zero_point);
+  auto bias = bias_.has_value()
+      ? bias_->view({1, N})
+      : at::zeros({1, N}, at::device(device).dtype(kFloat));
+
+  // Requantize the accumulators, correcting them for the zero points:
+  // sum_k (x - x_zp)(w - w_zp)
+  //   = acc - x_zp * sum_k w - w_zp * sum_k x + K * x_zp * w_zp
+  auto epilogue = TensorIteratorConfig()
+                      .check_all_same_dtype(false)
+                      .add_output(output.view({M, N}))
+                      .add_input(acc.narrow(1, 0, N))
+                      .add_input(x_row_sums)
+                      .add_input(w_row_sums_.view({1, N}))
+                      .add_input(w_zero_points_.view({1, N}))
+                      .add_input(w_scales_.view({1, N}))
+                      .add_input(bias)
+                      .build();
+  const float inv_output_scale = 1.0f / output_scale;
+  const int32_t out_zero_point = output_zero_point;
+  const int32_t k = K;
+  gpu_kernel(
+      epilogue,
+      [=] GPU_LAMBDA(
+          int32_t acc,
+          int32_t x_row_sum,
+          int32_t w_row_sum,
+          int32_t w_zero_point,
+          float w_scale,
+          float bias) -> c10::quint8 {
+        const int32_t corrected = acc - input_zero_point * w_row_sum -
+            w_zero_point * x_row_sum + k * input_zero_point * w_zero_point;
+        const float value = corrected * input_scale * w_scale + bias;
+        int32_t qvalue =
+            static_cast<int32_t>(nearbyintf(value * inv_output_scale)) +
+            out_zero_point;
+        qvalue = std::max<int32_t>(qvalue, ReluFused ? out_zero_point : 0);
+        qvalue = std::min<int32_t>(qvalue, 255);
+        c10::quint8 result;
+        result.val_ = qvalue;
+        return result;
+      });
+  return output;
+}
+
+class QLinearPackWeightInt8Cuda final {
+ public:
+  static c10::intrusive_ptr<LinearPackedParamsBase> run(
+      Tensor weight,
+      c10::optional<Tensor> bias) {
+    return PackedLinearWeightCuda::prepack(std::move(weight), std::move(bias));
+  }
+};
+
+TORCH_LIBRARY_IMPL(quantized, QuantizedCUDA, m) {
+  m.impl("linear_prepack", TORCH_FN(QLinearPackWeightInt8Cuda::run));
+}
+
+} // namespace
+} // namespace native
+} // namespace at
@@ -0,0 +1,233 @@
+// Basic functions on sparse CSR tensors
+
+#include <ATen/ATen.h>
+#include <ATen/InitialTensorOptions.h>
+#include <ATen/Layout.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/SparseCsrTensorImpl.h>
+#include <ATen/SparseCsrTensorUtils.h>
+#include <ATen/SparseTensorUtils.h>
+
+namespace at { namespace native {
+
+using namespace at::sparse_csr;
+using at::sparse::SparseTensor;
+
+namespace {
+
+// The row offsets of a matrix of `nrows` rows whose nonzero elements are in
+// the rows `rows`, sorted.
+Tensor rows_to_crow_indices(const Tensor& rows, int64_t nrows, ScalarType index_type) {
+  auto crow_indices = at::zeros({nrows + 1}, rows.options().dtype(kLong));
+  if (rows.numel() > 0) {
+    crow_indices.narrow(0, 1, nrows).copy_(
+        at::bincount(rows, /*weights=*/{}, /*minlength=*/nrows).cumsum(0));
+  }
+  return crow_indices.to(index_type);
+}
+
+// The rows of the nonzero elements of a CSR matrix, given its row offsets.
+Tensor crow_indices_to_rows(const Tensor& crow_indices) {
+  const int64_t nrows = crow_indices.numel() - 1;
+  auto crow = crow_indices.to(kLong);
+  return at::repeat_interleave(crow.narrow(0, 1, nrows) - crow.narrow(0, 0, nrows));
+}
+
+} // namespace
+
+/******************************************************************************
+ * access methods
+ ******************************************************************************/
+
+int64_t _nnz_sparse_csr(const SparseCsrTensor& self) {
+  return get_sparse_csr_impl(self)->nnz();
+}
+
+Tensor values_sparse_csr(const SparseCsrTensor& self) {
+  return get_sparse_csr_impl(self)->values().alias();
+}
+
+Tensor crow_indices_sparse_csr(const SparseCsrTensor& self) {
+  return get_sparse_csr_impl(self)->crow_indices().alias();
+}
+
+Tensor col_indices_sparse_csr(const SparseCsrTensor& self) {
+  return get_sparse_csr_impl(self)->col_indices().alias();
+}
+
+/******************************************************************************
+ * creation methods
+ ******************************************************************************/
+
+SparseCsrTensor new_sparse_csr(const TensorOptions& options) {
+  TORCH_INTERNAL_ASSERT(impl::variable_excluded_from_dispatch());
+  AT_ASSERT(options.layout() == kSparseCsr);
+  DispatchKey dispatch_key;
+  if (options.device().is_cuda()) {
+    dispatch_key = DispatchKey::SparseCsrCUDA;
+  } else {
+    dispatch_key = DispatchKey::SparseCsrCPU;
+  }
+  // The members are on the device of `options`, including its index, which
+  // the device of the matrix is taken from.
+  auto index_options = options.layout(kStrided).dtype(kLong);
+  return detail::make_tensor<SparseCsrTensorImpl>(
+      DispatchKeySet(dispatch_key), options.dtype(),
+      at::zeros({1}, index_options),
+      at::empty({0}, index_options),
+      at::empty({0}, options.layout(kStrided)));
+}
+
+Tensor empty_sparse_csr(IntArrayRef size, const TensorOptions& options, c10::optional<MemoryFormat> optional_memory_format) {
+  TORCH_CHECK(!options.pinned_memory(), "Only dense CPU tensors can be pinned");
+  SparseCsrTensor self = new_sparse_csr(options);
+  get_sparse_csr_impl(self)->resize_and_clear_(size);
+  return self;
+}
+
+SparseCsrTensor new_with_tensors_sparse_csr(
+    const Tensor& crow_indices,
+    const Tensor& col_indices,
+    const Tensor& values,
+    IntArrayRef size,
+    const TensorOptions& options) {
+  SparseCsrTensor self = new_sparse_csr(options);
+  // As for a COO tensor, the members of a CSR tensor don't contain
+  // AutogradMeta, so they are shallow copies of the given tensors.
+  auto shallow_copy = [](const Tensor& tensor) {
+    return Tensor(tensor.unsafeGetTensorImpl()->shallow_copy_and_detach(
+        /*version_counter=*/tensor.unsafeGetTensorImpl()->version_counter(),
+        /*allow_tensor_metadata_change=*/true));
+  };
+  get_sparse_csr_impl(self)->set_member_tensors_unsafe(
+      shallow_copy(crow_indices), shallow_copy(col_indices), shallow_copy(values), size);
+  return self;
+}
+
+void _validate_sparse_csr_tensor_args(const Tensor& crow_indices, const Tensor& col_indices, const Tensor& values, IntArrayRef size) {
+  // The shapes and types are checked again by
+  // SparseCsrTensorImpl::set_member_tensors_unsafe, but they are needed to
+  // check the indices.
+  TORCH_CHECK(size.size() == 2, "sparse CSR tensors must have 2 dimensions, but got size ", size);
+  TORCH_CHECK(
+      crow_indices.dim() == 1 && col_indices.dim() == 1 && values.dim() == 1,
+      "crow_indices, col_indices and values must be 1-dimensional, but got tensors of sizes ",
+      crow_indices.sizes(), ", ", col_indices.sizes(), " and ", values.sizes());
+  TORCH_CHECK(
+      crow_indices.numel() == size[0] + 1,
+      "crow_indices must have nrows + 1 = ", size[0] + 1, " elements, but got ", crow_indices.numel());
+  TORCH_CHECK(
+      col_indices.numel() == values.numel(),
+      "col_indices and values must have the same nnz, but got ", col_indices.numel(), " and ", values.numel());
+
+  const int64_t nnz = values.numel();
+  auto crow = crow_indices.to(kLong);
+  TORCH_CHECK(crow[0].item<int64_t>() == 0, "crow_indices must start with 0");
+  TORCH_CHECK(
+      crow[-1].item<int64_t>() == nnz,
+      "crow_indices must end with nnz = ", nnz, ", but got ", crow[-1].item<int64_t>());
+  TORCH_CHECK(
+      (crow.narrow(0, 1, size[0]) >= crow.narrow(0, 0, size[0])).all().item<bool>(),
+      "crow_indices must be nondecreasing");
+  if (nnz > 0) {
+    const int64_t min_col = col_indices.min().item<int64_t>();
+    const int64_t max_col = col_indices.max().item<int64_t>();
+    TORCH_CHECK(min_col >= 0, "found negative column index ", min_col);
+    TORCH_CHECK(
+        max_col < size[1],
+        "size is inconsistent with col_indices: there are ", size[1], " columns but found index ", max_col);
+  }
+}
+
+// NOTE: _sparse_csr_tensor_unsafe() differs from sparse_csr_tensor() in that
+// it doesn't check the indices, thus avoiding a copy from CUDA to CPU. It
+// should ONLY be used where the indices are known to be valid.
+Tensor _sparse_csr_tensor_unsafe(const Tensor& crow_indices, const Tensor& col_indices, const Tensor& values, IntArrayRef size, const TensorOptions& options) {
+  return at::_sparse_csr_tensor_with_tensors(
+      crow_indices, col_indices, values, size, values.options().layout(kSparseCsr));
+}
+
+Tensor sparse_csr_tensor(const Tensor& crow_indices, const Tensor& col_indices, const Tensor& values, IntArrayRef size, const TensorOptions& options) {
+  TORCH_CHECK(!options.has_layout() || options.layout() == kSparseCsr, "expected sparse CSR layout, but got layout ", options.layout());
+  // The members take the dtype and the device of `options`, if any.
+  const Device device = options.has_device() ? options.device() : values.device();
+  const ScalarType dtype = options.has_dtype() ? typeMetaToScalarType(options.dtype()) : values.scalar_type();
+  Tensor crow_indices_ = crow_indices.to(device);
+  Tensor col_indices_ = col_indices.to(device);
+  Tensor values_ = values.to(device, dtype);
+  at::native::_validate_sparse_csr_tensor_args(crow_indices_, col_indices_, values_, size);
+  return at::native::_sparse_csr_tensor_unsafe(crow_indices_, col_indices_, values_, size, options);
+}
+
+Tensor sparse_csr_tensor(const Tensor& crow_indices, const Tensor& col_indices, const Tensor& values, const TensorOptions& options) {
+  TORCH_CHECK(crow_indices.dim() == 1 && crow_indices.numel() > 0,
+      "crow_indices must be a 1-dimensional tensor of nrows + 1 elements, but got a tensor of size ", crow_indices.sizes());
+  const int64_t nrows = crow_indices.numel() - 1;
+  const int64_t ncols = col_indices.numel() > 0 ? col_indices.max().item<int64_t>() + 1 : 0;
+  return at::native::sparse_csr_tensor(crow_indices, col_indices, values, {nrows, ncols}, options);
+}
+
+// The members of `self` are replaced by copies of those of `src`, converted
+// to the dtype and the device of `self`.
+SparseCsrTensor& copy_sparse_csr_(SparseCsrTensor& self, const SparseCsrTensor& src, bool non_blocking) {
+  if (self.is_same(src)) {
+    return self;
+  }
+  auto src_impl = get_sparse_csr_impl(src);
+  const auto index_options = src_impl->crow_indices().options().device(self.device());
+  get_sparse_csr_impl(self)->set_member_tensors_unsafe(
+      src_impl->crow_indices().to(index_options, non_blocking, /*copy=*/true),
+      src_impl->col_indices().to(index_options, non_blocking, /*copy=*/true),
+      src_impl->values().to(src_impl->values().options().dtype(self.dtype()).device(self.device()), non_blocking, /*copy=*/true),
+      src.sizes());
+  return self;
+}
+
+/******************************************************************************
+ * conversions
+ ******************************************************************************/
+
+SparseCsrTensor dense_to_sparse_csr(const Tensor& self) {
+  TORCH_CHECK(self.dim() == 2, "to_sparse_csr expects a matrix, but got a tensor of size ", self.sizes());
+  // The nonzero elements are in row-major order, as a CSR matrix needs.
+  auto indices = self.nonzero();
+  auto rows = indices.select(1, 0);
+  auto cols = indices.select(1, 1).contiguous();
+  auto values = self.reshape({-1}).index_select(0, rows * self.size(1) + cols);
+  return at::_sparse_csr_tensor_with_tensors(
+      rows_to_crow_indices(rows, self.size(0), kLong), cols, values, self.sizes(),
+      values.options().layout(kSparseCsr));
+}
+
+SparseCsrTensor sparse_to_sparse_csr(const SparseTensor& self) {
+  TORCH_CHECK(
+      self.sparse_dim() == 2 && self.dense_dim() == 0,
+      "to_sparse_csr expects a sparse matrix, but got a tensor of ", self.sparse_dim() ,
+      " sparse and ", self.dense_dim(), " dense dimensions");
+  // Its indices are sorted once coalesced.
+  auto coalesced = self.coalesce();
+  auto indices = coalesced._indices();
+  auto rows = indices.select(0, 0);
+  auto cols = indices.select(0, 1).contiguous();
+  auto values = coalesced._values();
+  return at::_sparse_csr_tensor_with_tensors(
+      rows_to_crow_indices(rows, self.size(0), kLong), cols, values, self.sizes(),
+      values.options().layout(kSparseCsr));
+}
+
+SparseTensor sparse_csr_to_sparse(const SparseCsrTensor& self) {
+  auto rows = crow_indices_to_rows(self.crow_indices());
+  auto indices = at::stack({rows, self.col_indices().to(kLong)});
+  return at::_sparse_coo_tensor_unsafe(indices, self.values(), self.sizes())._coalesced_(true);
+}
+
+Tensor sparse_csr_to_dense(const SparseCsrTensor& self) {
+  auto result = at::zeros(self.sizes(), self.values().options());
+  if (self._nnz() > 0) {
+    auto rows = crow_indices_to_rows(self.crow_indices());
+    result.view({-1}).index_copy_(0, rows * self.size(1) + self.col_indices().to(kLong), self.values());
+  }
+  return result;
+}
+
+}} // namespace at::native
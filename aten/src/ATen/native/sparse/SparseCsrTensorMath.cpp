@@ -0,0 +1,171 @@
+#include <ATen/ATen.h>
+#include <ATen/Dispatch.h>
+#include <ATen/ExpandUtils.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/Parallel.h>
+#include <ATen/SparseCsrTensorImpl.h>
+#include <ATen/SparseCsrTensorUtils.h>
+
+#include <algorithm>
+
+namespace at { namespace native {
+
+using namespace at::sparse_csr;
+
+// --------------------------------------------------------------------
+// addmm(Tensor, SparseCsrTensor, Tensor, Scalar, Scalar)  [broadcasts]
+// --------------------------------------------------------------------
+
+namespace {
+
+// The rows of a matrix are split into chunks of about as many nonzero
+// elements each, rather than of as many rows, so that the threads are kept
+// as busy on the skewed rows of, e.g., the adjacency matrix of a graph. A
+// chunk owns its rows of the result, thus no atomics are needed.
+constexpr int64_t kChunksPerThread = 4;
+
+template <typename scalar_t, typename index_t>
+void addmm_out_sparse_csr_dense_worker(
+    Tensor& r,
+    const Tensor& crow_indices,
+    const Tensor& col_indices,
+    const Tensor& values,
+    const Tensor& dense,
+    Scalar alpha) {
+  const int64_t nrows = crow_indices.numel() - 1;
+  const int64_t nnz = values.numel();
+  const int64_t dim_k = dense.size(1);
+  const scalar_t cast_alpha = alpha.to<scalar_t>();
+
+  const index_t* crow = crow_indices.data_ptr<index_t>();
+  const index_t* col = col_indices.data_ptr<index_t>();
+  const scalar_t* vals = values.data_ptr<scalar_t>();
+  const scalar_t* dense_ptr = dense.data_ptr<scalar_t>();
+  scalar_t* r_ptr = r.data_ptr<scalar_t>();
+  const int64_t dense_stride0 = dense.stride(0);
+  const int64_t dense_stride1 = dense.stride(1);
+  const int64_t r_stride0 = r.stride(0);
+  const int64_t r_stride1 = r.stride(1);
+
+  // The first row of a chunk is the first one whose nonzero elements start
+  // at or after the share of the chunk.
+  const int64_t num_chunks = std::max<int64_t>(
+      std::min<int64_t>(at::get_num_threads() * kChunksPerThread, nrows), 1);
+  auto first_row = [&](int64_t chunk) -> int64_t {
+    if (chunk == num_chunks) {
+      return nrows;
+    }
+    const int64_t share = nnz * chunk / num_chunks;
+    return std::lower_bound(crow, crow + nrows, static_cast<index_t>(share)) - crow;
+  };
+
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t row = first_row(begin); row < first_row(end); row++) {
+      scalar_t* r_row = r_ptr + row * r_stride0;
+      for (index_t i = crow[row]; i < crow[row + 1]; i++) {
+        const scalar_t val = cast_alpha * vals[i];
+        const scalar_t* dense_row = dense_ptr + col[i] * dense_stride0;
+        for (int64_t k = 0; k < dim_k; k++) {
+          r_row[k * r_stride1] += val * dense_row[k * dense_stride1];
+        }
+      }
+    }
+  });
+}
+
+} // namespace
+
+Tensor& s_addmm_out_sparse_csr_dense_cpu(
+    Tensor& r,
+    const Tensor& t,
+    const SparseCsrTensor& sparse,
+    const Tensor& dense,
+    Scalar beta,
+    Scalar alpha) {
+  TORCH_CHECK(!t.is_cuda(), "addmm: expected 'self' to be a CPU tensor, but got a CUDA tensor");
+  TORCH_CHECK(!r.is_cuda(), "addmm: expected 'out' to be a CPU tensor, but got a CUDA tensor");
+  TORCH_CHECK(!sparse.is_cuda(), "addmm: expected 'mat1' to be a CPU tensor, but got a CUDA tensor");
+  TORCH_CHECK(!dense.is_cuda(), "addmm: expected 'mat2' to be a CPU tensor, but got a CUDA tensor");
+  TORCH_CHECK(dense.layout() == kStrided, "addmm: expected 'mat2' to be a dense tensor, but got layout ", dense.layout());
+  TORCH_CHECK(dense.dim() == 2, "addmm: matrices expected, got ", dense.dim(), "D tensor");
+  TORCH_CHECK(dense.scalar_type() == sparse.scalar_type(),
+      "addmm: expected 'mat1' and 'mat2' to have the same dtype, but got ", sparse.scalar_type(), " and ", dense.scalar_type());
+
+  // ixj * jxk = ixk
+  const int64_t dim_i = sparse.size(0);
+  const int64_t dim_j = sparse.size(1);
+  const int64_t dim_k = dense.size(1);
+
+  TORCH_CHECK(dense.size(0) == dim_j,
+      "addmm: Argument #3 (dense): Expected dim 0 size ", dim_j, ", got ", dense.size(0));
+  TORCH_CHECK(t.size(0) == dim_i,
+      "addmm: Argument #1 (t): Expected dim 0 size ", dim_i, ", got ", t.size(0));
+  TORCH_CHECK(t.size(1) == dim_k,
+      "addmm: Argument #1 (t): Expected dim 1 size ", dim_k, ", got ", t.size(1));
+
+  r.resize_({dim_i, dim_k});
+
+  // With beta == 0, t is ignored, NaN and inf included, as for dense addmm.
+  if (beta.toComplexDouble() == 0.) {
+    r.zero_();
+  } else {
+    at::mul_out(r, t, at::scalar_tensor(beta, r.options()));
+  }
+
+  auto impl = get_sparse_csr_impl(sparse);
+  if (impl->nnz() == 0 || dim_k == 0) {
+    return r;
+  }
+
+  const Tensor& crow_indices = impl->crow_indices();
+  const Tensor& col_indices = impl->col_indices();
+  Tensor values = impl->values().contiguous();
+  AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES(
+      values.scalar_type(), "addmm_sparse_csr_dense", [&] {
+        if (crow_indices.scalar_type() == kInt) {
+          addmm_out_sparse_csr_dense_worker<scalar_t, int32_t>(
+              r, crow_indices.contiguous(), col_indices.contiguous(), values, dense, alpha);
+        } else {
+          addmm_out_sparse_csr_dense_worker<scalar_t, int64_t>(
+              r, crow_indices.contiguous(), col_indices.contiguous(), values, dense, alpha);
+        }
+      });
+  return r;
+}
+
+Tensor& addmm_out_sparse_csr_dense_cpu(
+    Tensor& result,
+    const Tensor& self,
+    const SparseCsrTensor& mat1,
+    const Tensor& mat2,
+    Scalar beta,
+    Scalar alpha) {
+  Tensor b_self;
+  std::tie(b_self) = expand_size(self, {mat1.size(0), mat2.size(1)}, "addmm_out");
+  return s_addmm_out_sparse_csr_dense_cpu(result, b_self, mat1, mat2, beta, alpha);
+}
+
+Tensor addmm_sparse_csr_dense_cpu(
+    const Tensor& self,
+    const SparseCsrTensor& mat1,
+    const Tensor& mat2,
+    Scalar beta,
+    Scalar alpha) {
+  Tensor b_self;
+  std::tie(b_self) = expand_size(self, {mat1.size(0), mat2.size(1)}, "addmm_out");
+  Tensor r = at::empty({0}, b_self.options());
+  s_addmm_out_sparse_csr_dense_cpu(r, b_self, mat1, mat2, beta, alpha);
+  return r;
+}
+
+// NB: like the COO one, the in-place addmm doesn't broadcast
+Tensor& s_addmm_sparse_csr_dense_cpu_(
+    Tensor& t,
+    const SparseCsrTensor& sparse,
+    const Tensor& dense,
+    Scalar beta,
+    Scalar alpha) {
+  return s_addmm_out_sparse_csr_dense_cpu(t, t, sparse, dense, beta, alpha);
+}
+
+}} // namespace at::native
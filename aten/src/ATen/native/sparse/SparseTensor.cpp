@@ -10,6 +10,10 @@
 
 #include <TH/THBlasUtils.h>
 
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
 namespace at { namespace native {
 
 using namespace at::sparse;
@@ -353,6 +357,77 @@ SparseTensor& copy_sparse_(SparseTensor& self, const SparseTensor& src, bool non
   return self._coalesced_(src.is_coalesced());
 }
 
+namespace {
+
+// The elements sorted or merged by a thread of coalesce at least.
+constexpr int64_t kCoalesceGrainSize = 32768;
+constexpr int kRadixBits = 8;
+constexpr int64_t kRadix = 1 << kRadixBits;
+
+// Sorts the nonnegative `keys`, and `values` with them, stably, with an LSD
+// radix sort over the significant bits of the keys only. Every pass splits
+// the keys into chunks, whose histograms give every chunk the positions its
+// keys go to, so that the chunks are sorted in parallel.
+void radix_sort_pairs(LongTensor& keys, LongTensor& values) {
+  const int64_t n = keys.numel();
+  const int64_t max_key = keys.max().item<int64_t>();
+  int num_bits = 0;
+  while (num_bits < 63 && (max_key >> num_bits) > 0) {
+    num_bits++;
+  }
+  if (num_bits == 0) {
+    return;
+  }
+
+  const int64_t num_chunks = std::max<int64_t>(
+      std::min<int64_t>(at::get_num_threads(), n / kCoalesceGrainSize), 1);
+  auto chunk_begin = [&](int64_t chunk) { return n * chunk / num_chunks; };
+  std::vector<int64_t> offsets(num_chunks * kRadix);
+  LongTensor keys_buffer = at::empty_like(keys);
+  LongTensor values_buffer = at::empty_like(values);
+  for (int shift = 0; shift < num_bits; shift += kRadixBits) {
+    const int64_t* keys_ptr = keys.data_ptr<int64_t>();
+    const int64_t* values_ptr = values.data_ptr<int64_t>();
+    int64_t* keys_buffer_ptr = keys_buffer.data_ptr<int64_t>();
+    int64_t* values_buffer_ptr = values_buffer.data_ptr<int64_t>();
+    auto digit = [&](int64_t key) { return (key >> shift) & (kRadix - 1); };
+
+    std::fill(offsets.begin(), offsets.end(), 0);
+    at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t chunk = begin; chunk < end; chunk++) {
+        int64_t* counts = offsets.data() + chunk * kRadix;
+        for (int64_t j = chunk_begin(chunk); j < chunk_begin(chunk + 1); j++) {
+          counts[digit(keys_ptr[j])]++;
+        }
+      }
+    });
+    // The keys of a digit go after those of the smaller digits, and after
+    // those of the same digit in the previous chunks.
+    int64_t offset = 0;
+    for (int64_t d = 0; d < kRadix; d++) {
+      for (int64_t chunk = 0; chunk < num_chunks; chunk++) {
+        const int64_t count = offsets[chunk * kRadix + d];
+        offsets[chunk * kRadix + d] = offset;
+        offset += count;
+      }
+    }
+    at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t chunk = begin; chunk < end; chunk++) {
+        int64_t* positions = offsets.data() + chunk * kRadix;
+        for (int64_t j = chunk_begin(chunk); j < chunk_begin(chunk + 1); j++) {
+          const int64_t position = positions[digit(keys_ptr[j])]++;
+          keys_buffer_ptr[position] = keys_ptr[j];
+          values_buffer_ptr[position] = values_ptr[j];
+        }
+      }
+    });
+    std::swap(keys, keys_buffer);
+    std::swap(values, values_buffer);
+  }
+}
+
+} // namespace
+
 SparseTensor coalesce_sparse_cpu(const SparseTensor& self) {
   AT_ASSERT(self.defined());
   TORCH_INTERNAL_ASSERT(at::impl::variable_excluded_from_dispatch());
@@ -369,13 +444,13 @@ SparseTensor coalesce_sparse_cpu(const SparseTensor& self) {
     return dst;
   }
 
-  LongTensor indices = self._indices();
+  LongTensor indices = self._indices().contiguous();
   Tensor values = self._values().contiguous();
   int64_t sparse_dim = self.sparse_dim();
   int64_t dense_dim = self.dense_dim();
   int64_t nnz = self._nnz();
 
-  LongTensor indices_scalar = flatten_indices(indices, self.sizes());
+  LongTensor indices_scalar = flatten_indices(indices, self.sizes()).contiguous();
 
   SparseTensor dst = new_sparse(self.options());
   get_sparse_impl(dst)->resize_(sparse_dim, dense_dim, self.sizes());
@@ -384,44 +459,67 @@ SparseTensor coalesce_sparse_cpu(const SparseTensor& self) {
   Tensor newValues = at::empty(values.sizes(), values.options());
   alias_into_sparse(dst, newIndices, newValues);
 
-  LongTensor indicesBuffer;
-  LongTensor indicesPermutation;
-  std::tie(indicesBuffer, indicesPermutation) = indices_scalar.sort(0);
+  // The sort is stable, so that the values of an index are summed in the
+  // order they came in, whatever the number of threads.
+  LongTensor indicesBuffer = indices_scalar.clone(at::MemoryFormat::Contiguous);
+  LongTensor indicesPermutation = at::arange(nnz, indices.options());
+  radix_sort_pairs(indicesBuffer, indicesPermutation);
+
+  // The sorted indices are split into chunks, and a chunk merges the runs of
+  // equal indices starting in it, once their position in the result is known.
+  const int64_t num_chunks = std::max<int64_t>(
+      std::min<int64_t>(at::get_num_threads(), nnz / kCoalesceGrainSize), 1);
+  const int64_t* keys = indicesBuffer.data_ptr<int64_t>();
+  const int64_t* perm = indicesPermutation.data_ptr<int64_t>();
+  std::vector<int64_t> chunk_runs(num_chunks + 1, 0);
+  auto chunk_begin = [&](int64_t chunk) { return nnz * chunk / num_chunks; };
+  auto run_starts_at = [&](int64_t j) { return j == 0 || keys[j] != keys[j - 1]; };
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t chunk = begin; chunk < end; chunk++) {
+      int64_t runs = 0;
+      for (int64_t j = chunk_begin(chunk); j < chunk_begin(chunk + 1); j++) {
+        runs += run_starts_at(j);
+      }
+      chunk_runs[chunk + 1] = runs;
+    }
+  });
+  std::partial_sum(chunk_runs.begin(), chunk_runs.end(), chunk_runs.begin());
+
   // NB: The accessor accesses here rely on self._nnz() > 0 (tested earlier in this function)
   auto newIndicesAccessor = newIndices.accessor<int64_t, 2>();
   auto indicesAccessor = indices.accessor<int64_t, 2>();
-  auto indicesPermutationAccessor = indicesPermutation.accessor<int64_t, 1>();
-  auto indicesBufferAccessor = indicesBuffer.accessor<int64_t, 1>();
-
-  int64_t i = -1;
   AT_DISPATCH_ALL_TYPES(
       values.scalar_type(), "coalesce", [&] {
-        int64_t prev = -1;
-        int64_t blockSize = values.stride(0);
+        // if values is an empty tensor, there are no elements to copy
+        int64_t blockSize = values.numel() > 0 ? values.stride(0) : 0;
         scalar_t* values_ptr = values.data_ptr<scalar_t>();
         scalar_t* newValues_ptr = newValues.data_ptr<scalar_t>();
-        for (int64_t j = 0; j < nnz; j++) {
-          int64_t pos = indicesPermutationAccessor[j];
-          int64_t curr = indicesBufferAccessor[j];
-          if (curr == prev) {
-            if (values.numel() > 0) {  // if values is an empty tensor, there are no elements to copy
-              THBlas_axpy<scalar_t>(blockSize, 1, values_ptr + pos * blockSize, 1, newValues_ptr + i * blockSize, 1);
-            }
-          } else {
-            ++i;
-            for (int64_t d = 0; d < sparse_dim; d++) {
-              newIndicesAccessor[d][i] = indicesAccessor[d][pos];
-            }
-            if (values.numel() > 0) {  // if values is an empty tensor, there are no elements to copy
-              THBlas_copy<scalar_t>(blockSize, values_ptr + pos * blockSize, 1, newValues_ptr + i * blockSize, 1);
+        at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+          for (int64_t chunk = begin; chunk < end; chunk++) {
+            int64_t i = chunk_runs[chunk];
+            for (int64_t j = chunk_begin(chunk); j < chunk_begin(chunk + 1); j++) {
+              if (!run_starts_at(j)) {
+                continue;
+              }
+              for (int64_t d = 0; d < sparse_dim; d++) {
+                newIndicesAccessor[d][i] = indicesAccessor[d][perm[j]];
+              }
+              scalar_t* out = newValues_ptr + i * blockSize;
+              std::copy_n(values_ptr + perm[j] * blockSize, blockSize, out);
+              for (int64_t k = j + 1; k < nnz && keys[k] == keys[j]; k++) {
+                const scalar_t* in = values_ptr + perm[k] * blockSize;
+                for (int64_t b = 0; b < blockSize; b++) {
+                  out[b] += in[b];
+                }
+              }
+              i++;
             }
           }
-          prev = curr;
-        }
+        });
     });
 
   dst._coalesced_(true);
-  get_sparse_impl(dst)->set_nnz_and_narrow(i + 1);
+  get_sparse_impl(dst)->set_nnz_and_narrow(chunk_runs[num_chunks]);
 
   return dst;
 }
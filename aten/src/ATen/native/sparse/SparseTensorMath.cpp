@@ -434,10 +434,146 @@ Tensor& sub_out_sparse(Tensor& r, const Tensor& self, const Tensor& other, Scala
 }
 
 
+namespace {
+
+// The elements merged by a thread of add(SparseTensor, SparseTensor) at least.
+constexpr int64_t kMergeGrainSize = 32768;
+
+// Merges the coalesced `t` and `src`, whose flattened indices are sorted and
+// unique, into r = t + value * src. The merged sequence is split into chunks
+// of about as many elements each: the first index of a chunk is found by a
+// binary search along a diagonal of the merge path, and both inputs are split
+// before it, so that a pair of equal indices always lands in the same chunk.
+// A chunk counts its output elements, then writes them once the positions of
+// the chunks are known.
+template <typename scalar_t>
+int64_t add_out_sparse_coalesced_worker(
+    LongTensor& r_indices, Tensor& r_values,
+    const LongTensor& t_indices, const Tensor& t_values,
+    const LongTensor& src_indices, const Tensor& s_values,
+    IntArrayRef sizes, Scalar value) {
+  const int64_t t_nnz = t_indices.size(1);
+  const int64_t s_nnz = src_indices.size(1);
+  const int64_t total = t_nnz + s_nnz;
+  const int64_t sparse_dim = t_indices.size(0);
+  const int64_t blockSize = r_values.numel() > 0 ? r_values.stride(0) : 0;
+
+  LongTensor t_keys_tensor = flatten_indices(t_indices, sizes).contiguous();
+  LongTensor s_keys_tensor = flatten_indices(src_indices, sizes).contiguous();
+  const int64_t* t_keys = t_keys_tensor.data_ptr<int64_t>();
+  const int64_t* s_keys = s_keys_tensor.data_ptr<int64_t>();
+
+  const int64_t num_chunks = std::max<int64_t>(
+      std::min<int64_t>(at::get_num_threads(), total / kMergeGrainSize), 1);
+  std::vector<int64_t> t_begin(num_chunks + 1), s_begin(num_chunks + 1);
+  t_begin[0] = s_begin[0] = 0;
+  t_begin[num_chunks] = t_nnz;
+  s_begin[num_chunks] = s_nnz;
+  for (int64_t chunk = 1; chunk < num_chunks; chunk++) {
+    // The number of elements of t among the first `diag` ones merged
+    const int64_t diag = total * chunk / num_chunks;
+    int64_t lo = std::max<int64_t>(0, diag - s_nnz);
+    int64_t hi = std::min<int64_t>(diag, t_nnz);
+    while (lo < hi) {
+      const int64_t mid = lo + (hi - lo) / 2;
+      if (t_keys[mid] <= s_keys[diag - mid - 1]) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    const int64_t s_i = diag - lo;
+    const int64_t key = (lo < t_nnz && (s_i >= s_nnz || t_keys[lo] <= s_keys[s_i]))
+        ? t_keys[lo] : s_keys[s_i];
+    t_begin[chunk] = std::lower_bound(t_keys, t_keys + t_nnz, key) - t_keys;
+    s_begin[chunk] = std::lower_bound(s_keys, s_keys + s_nnz, key) - s_keys;
+  }
+
+  // Calls f(t_i, s_i) for every output element of a chunk, either index being
+  // -1 if the element is missing from that input.
+  auto merge_chunk = [&](int64_t chunk, auto f) {
+    int64_t t_i = t_begin[chunk], s_i = s_begin[chunk];
+    const int64_t t_end = t_begin[chunk + 1], s_end = s_begin[chunk + 1];
+    while (t_i < t_end || s_i < s_end) {
+      if (s_i >= s_end || (t_i < t_end && t_keys[t_i] < s_keys[s_i])) {
+        f(t_i++, -1);
+      } else if (t_i >= t_end || s_keys[s_i] < t_keys[t_i]) {
+        f(-1, s_i++);
+      } else {
+        f(t_i++, s_i++);
+      }
+    }
+  };
+
+  std::vector<int64_t> chunk_offsets(num_chunks + 1, 0);
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t chunk = begin; chunk < end; chunk++) {
+      int64_t count = 0;
+      merge_chunk(chunk, [&](int64_t, int64_t) { count++; });
+      chunk_offsets[chunk + 1] = count;
+    }
+  });
+  std::partial_sum(chunk_offsets.begin(), chunk_offsets.end(), chunk_offsets.begin());
+
+  auto t_indices_accessor = t_indices.accessor<int64_t, 2>();
+  auto src_indices_accessor = src_indices.accessor<int64_t, 2>();
+  auto r_indices_accessor = r_indices.accessor<int64_t, 2>();
+  const scalar_t* t_values_ptr = t_values.data_ptr<scalar_t>();
+  const scalar_t* s_values_ptr = s_values.data_ptr<scalar_t>();
+  scalar_t* r_values_ptr = r_values.data_ptr<scalar_t>();
+  const scalar_t cast_value = value.to<scalar_t>();
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t chunk = begin; chunk < end; chunk++) {
+      int64_t r_i = chunk_offsets[chunk];
+      merge_chunk(chunk, [&](int64_t t_i, int64_t s_i) {
+        for (int64_t d = 0; d < sparse_dim; d++) {
+          r_indices_accessor[d][r_i] = t_i >= 0
+              ? t_indices_accessor[d][t_i] : src_indices_accessor[d][s_i];
+        }
+        scalar_t* out = r_values_ptr + r_i * blockSize;
+        if (t_i >= 0 && s_i >= 0) {
+          for (int64_t b = 0; b < blockSize; b++) {
+            out[b] = t_values_ptr[t_i * blockSize + b] + cast_value * s_values_ptr[s_i * blockSize + b];
+          }
+        } else if (t_i >= 0) {
+          std::copy_n(t_values_ptr + t_i * blockSize, blockSize, out);
+        } else {
+          for (int64_t b = 0; b < blockSize; b++) {
+            out[b] = cast_value * s_values_ptr[s_i * blockSize + b];
+          }
+        }
+        r_i++;
+      });
+    }
+  });
+  return chunk_offsets[num_chunks];
+}
+
+} // namespace
+
 SparseTensor& add_out_sparse_contiguous(SparseTensor& r, const SparseTensor& t, const SparseTensor& src, Scalar value, ScalarType commonDtype) {
     // saving those because they can be overwritten when doing in-place operations
     int64_t t_nnz = t._nnz(), s_nnz = src._nnz(), max_nnz = t_nnz + s_nnz;
     bool coalesced = t.is_coalesced() && src.is_coalesced();
+
+    if (coalesced) {
+      LongTensor r_indices = at::empty({src.sparse_dim(), max_nnz}, t._indices().options());
+      Tensor t_values = t._values().to(commonDtype).contiguous();
+      Tensor s_values = src._values().to(commonDtype).contiguous();
+      Tensor r_values = new_values_with_size_of(s_values, max_nnz);
+      int64_t r_nnz;
+      AT_DISPATCH_ALL_TYPES(
+          commonDtype, "cadd_sparse", [&] {
+            r_nnz = add_out_sparse_coalesced_worker<scalar_t>(
+                r_indices, r_values, t._indices(), t_values, src._indices(), s_values, t.sizes(), value);
+          });
+      if (r.scalar_type() != commonDtype) {
+        r_values = r_values.to(r.scalar_type());
+      }
+      get_sparse_impl(r)->set_indices_and_values_unsafe(r_indices, r_values);
+      get_sparse_impl(r)->set_nnz_and_narrow(r_nnz);
+      return r._coalesced_(true);
+    }
     int64_t sparse_dim = src.sparse_dim();
 
     LongTensor r_indices = at::empty({src.sparse_dim(), max_nnz}, t._indices().options());
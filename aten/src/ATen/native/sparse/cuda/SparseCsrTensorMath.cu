@@ -0,0 +1,176 @@
+#include <ATen/ATen.h>
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/CUDAUtils.h>
+#include <ATen/Dispatch.h>
+#include <ATen/ExpandUtils.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/ScalarOps.h>
+#include <ATen/SparseCsrTensorImpl.h>
+#include <ATen/SparseCsrTensorUtils.h>
+#include <ATen/SparseTensorUtils.h>
+#include <ATen/native/sparse/cuda/SparseCUDABlas.cuh>
+
+#include <limits>
+
+namespace at { namespace native {
+
+using namespace at::sparse_csr;
+using at::sparse::is_same_tensor;
+
+// --------------------------------------------------------------------
+// addmm(Tensor, SparseCsrTensor, Tensor, Scalar, Scalar)  [broadcasts]
+// --------------------------------------------------------------------
+
+namespace {
+
+// Unlike a COO matrix, whose indices are converted to CSR at every product,
+// a CSR matrix is given to cuSPARSE as it is if its indices are int32.
+template <typename scalar_t>
+void s_addmm_out_sparse_csr_dense_cuda_worker(int64_t nnz, int64_t m, int64_t n, int64_t k, Tensor& r_, const Tensor& crow_indices, const Tensor& col_indices, const Tensor& values, const Tensor& dense, Scalar alpha) {
+  scalar_t cast_alpha = alpha.to<scalar_t>();
+
+  Tensor r__;
+  if(r_.stride(0) == 1 && r_.stride(1) == r_.size(0)) {
+    r__ = r_;
+  } else {
+    r__ = r_.transpose(0, 1).clone(at::MemoryFormat::Contiguous);
+    r__.transpose_(0, 1);
+  }
+
+  Tensor dense_;
+  char transpose_dense;
+  if(dense.stride(0) == 1 && dense.stride(1) == dense.size(0)) {
+    transpose_dense = 'n';
+    dense_ = dense;
+  } else if(dense.stride(1) == 1 && dense.stride(0) != dense.size(1)) {
+    transpose_dense = 't';
+    dense_ = dense;
+  } else {
+    transpose_dense = 't';
+    dense_ = dense.contiguous();
+  }
+
+  // r_ is already scaled by beta.
+  sparse::cuda::csrmm2(
+    'n',
+    transpose_dense,
+    m,
+    n,
+    k,
+    nnz,
+    cast_alpha,
+    values.data_ptr<scalar_t>(),
+    crow_indices.data_ptr<int32_t>(),
+    col_indices.data_ptr<int32_t>(),
+    dense_.data_ptr<scalar_t>(),
+    (transpose_dense == 'n' ? dense_.stride(1) : dense_.stride(0)),
+    scalar_t(1),
+    r__.data_ptr<scalar_t>(),
+    r__.stride(1));
+
+  if (!is_same_tensor(r__, r_)) {
+    r_.copy_(r__);
+  }
+}
+
+} // namespace
+
+Tensor& s_addmm_out_sparse_csr_dense_cuda(Tensor& r_, const Tensor& t, const SparseCsrTensor& sparse, const Tensor& dense, Scalar beta, Scalar alpha) {
+  TORCH_CHECK(t.is_cuda(), "addmm: expected 'self' to be CUDA, but got CPU");
+  TORCH_CHECK(r_.is_cuda(), "addmm: expected 'out' to be CUDA, but got CPU");
+  TORCH_CHECK(sparse.is_cuda(), "addmm: expected 'mat1' to be CUDA, but got CPU");
+  TORCH_CHECK(dense.is_cuda(), "addmm: expected 'mat2' to be CUDA, but got CPU");
+
+  TORCH_CHECK(cuda::check_device({sparse, r_, t, dense}));
+
+  TORCH_CHECK(dense.layout() == kStrided, "addmm: expected 'mat2' to be a dense tensor, but got layout ", dense.layout());
+  TORCH_CHECK(dense.dim() == 2, "addmm: 2D tensor expected, got ", dense.dim(), "D tensor");
+  TORCH_CHECK(dense.scalar_type() == sparse.scalar_type(),
+      "addmm: expected 'mat1' and 'mat2' to have the same dtype, but got ", sparse.scalar_type(), " and ", dense.scalar_type());
+
+  // mxk * kxn = mxn
+  int64_t m = sparse.size(0);
+  int64_t k = sparse.size(1);
+  int64_t n = dense.size(1);
+
+  TORCH_CHECK(t.size(0) == m,
+      "addmm: Argument #1 (t): Expected dim 0 size ", m, ", got ", t.size(0));
+  TORCH_CHECK(t.size(1) == n,
+      "addmm: Argument #1 (t): Expected dim 1 size ", n, ", got ", t.size(1));
+  TORCH_CHECK(dense.size(0) == k,
+      "addmm: Argument #3 (dense): Expected dim 0 size ", k, ", got ", dense.size(0));
+
+  r_.resize_({m, n});
+
+  if (beta.toComplexDouble() == 0.) {
+    r_.zero_();
+  } else if (beta.toComplexDouble() == 1.) {
+    if (!is_same_tensor(t, r_)) {
+      r_.copy_(t);
+    }
+  } else {
+    at::mul_out(r_, t, scalar_to_tensor(beta));
+  }
+
+  auto impl = get_sparse_csr_impl(sparse);
+  int64_t nnz = impl->nnz();
+  if (nnz == 0 || n == 0) {
+    return r_;
+  }
+
+  // cuSPARSE only takes int32 indices.
+  TORCH_CHECK(nnz <= std::numeric_limits<int32_t>::max() && m < std::numeric_limits<int32_t>::max(),
+      "addmm: sparse CSR matrices of more than 2^31 - 1 nonzero elements or rows are not supported on CUDA");
+  Tensor crow_indices = impl->crow_indices().to(kInt).contiguous();
+  Tensor col_indices = impl->col_indices().to(kInt).contiguous();
+  Tensor values = impl->values().contiguous();
+
+  // No half support, as for the COO product
+  AT_DISPATCH_FLOATING_TYPES(
+    values.scalar_type(), "addmm_sparse_csr_cuda", [&] {
+      s_addmm_out_sparse_csr_dense_cuda_worker<scalar_t>(nnz, m, n, k, r_, crow_indices, col_indices, values, dense, alpha);
+    }
+  );
+
+  return r_;
+}
+
+Tensor& addmm_out_sparse_csr_dense_cuda(
+    Tensor& result,
+    const Tensor& self,
+    const SparseCsrTensor& mat1,
+    const Tensor& mat2,
+    Scalar beta,
+    Scalar alpha
+) {
+  Tensor b_self;
+  std::tie(b_self) = expand_size(self, {mat1.size(0), mat2.size(1)}, "addmm_out");
+  return s_addmm_out_sparse_csr_dense_cuda(result, b_self, mat1, mat2, beta, alpha);
+}
+
+Tensor addmm_sparse_csr_dense_cuda(
+    const Tensor& self,
+    const SparseCsrTensor& mat1,
+    const Tensor& mat2,
+    Scalar beta,
+    Scalar alpha
+) {
+  Tensor b_self;
+  std::tie(b_self) = expand_size(self, {mat1.size(0), mat2.size(1)}, "addmm_out");
+  Tensor r = at::empty({0}, b_self.options());
+  s_addmm_out_sparse_csr_dense_cuda(r, b_self, mat1, mat2, beta, alpha);
+  return r;
+}
+
+// NB: like the COO one, the in-place addmm doesn't broadcast
+Tensor& s_addmm_sparse_csr_dense_cuda_(
+    Tensor& t,
+    const SparseCsrTensor& sparse,
+    const Tensor& dense,
+    Scalar beta,
+    Scalar alpha
+) {
+  return s_addmm_out_sparse_csr_dense_cuda(t, t, sparse, dense, beta, alpha);
+}
+
+}} // namespace at::native
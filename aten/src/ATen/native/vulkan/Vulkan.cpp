@@ -1,9 +1,13 @@
 #include <stdio.h>
 #include <unistd.h>
+#include <algorithm>
+#include <cstdlib>
 #include <cstring>
 #include <functional>
 #include <iostream>
+#include <iterator>
 #include <numeric>
+#include <utility>
 
 #include <c10/util/ArrayRef.h>
 #include <c10/util/Exception.h>
@@ -42,6 +46,11 @@ VContext::VContext(const bool enableValidationLayers)
   createDevice();
 
   computeUnitFactory_ = std::make_unique<ComputeUnitFactory>(device_);
+  memoryAllocator_ =
+      std::make_unique<MemoryAllocator>(device_, physicalDevice_);
+  descriptorCache_ = std::make_unique<DescriptorCache>(device_);
+  commandBatch_ = std::make_unique<CommandBatch>(
+      device_, commandPool_, queue_, *descriptorCache_);
 }
 
 VContext::~VContext() {
@@ -53,9 +62,16 @@ VContext::~VContext() {
     }
   }
 
+  // The pending commands complete and release what they use before the
+  // descriptor pools and the memory are destroyed.
+  commandBatch_->flush();
+  commandBatch_.reset();
+  descriptorCache_.reset();
+
   // ComputeUnitFactory_ owns ComputeUnits and VkPipelineCache, need valid
   // VkDevice for destructing, destructing before vkDestroyDevice
   computeUnitFactory_.reset();
+  memoryAllocator_.reset();
 
   vkDestroyCommandPool(device_, commandPool_, nullptr);
   vkDestroyDevice(device_, nullptr);
@@ -230,7 +246,8 @@ void VContext::createDevice() {
 
   VkCommandPoolCreateInfo commandPoolCreateInfo{};
   commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-  commandPoolCreateInfo.flags = 0;
+  // The command buffer of the CommandBatch is reset when it is begun again.
+  commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
   commandPoolCreateInfo.queueFamilyIndex = queueFamilyIndex_;
   VK_CHECK(vkCreateCommandPool(
       device_, &commandPoolCreateInfo, nullptr, &commandPool_));
@@ -282,6 +299,180 @@ uint32_t findMemoryType(
   return -1;
 }
 
+struct MemoryBlock final {
+  VkDeviceMemory memory;
+  VkDeviceSize size;
+  void* mapped;
+  uint32_t memoryTypeIndex;
+  bool linear;
+  // The free ranges of the block, size by offset, the adjacent ones merged.
+  std::map<VkDeviceSize, VkDeviceSize> freeRanges;
+
+  bool empty() const {
+    return freeRanges.size() == 1 && freeRanges.begin()->second == size;
+  }
+};
+
+namespace {
+
+inline VkDeviceSize alignUp(
+    const VkDeviceSize value,
+    const VkDeviceSize alignment) {
+  return UP_DIV(value, alignment) * alignment;
+}
+
+// First fit in the free ranges of the block.
+bool allocateFromBlock(
+    MemoryBlock& block,
+    const VkDeviceSize size,
+    const VkDeviceSize alignment,
+    MemoryAllocation* const allocation) {
+  for (auto it = block.freeRanges.begin(); it != block.freeRanges.end(); ++it) {
+    const VkDeviceSize begin = it->first;
+    const VkDeviceSize end = it->first + it->second;
+    const VkDeviceSize offset = alignUp(begin, alignment);
+    if (offset + size > end) {
+      continue;
+    }
+    block.freeRanges.erase(it);
+    if (offset > begin) {
+      block.freeRanges.emplace(begin, offset - begin);
+    }
+    if (offset + size < end) {
+      block.freeRanges.emplace(offset + size, end - offset - size);
+    }
+    allocation->memory = block.memory;
+    allocation->offset = offset;
+    allocation->size = size;
+    allocation->mapped =
+        block.mapped ? static_cast<char*>(block.mapped) + offset : nullptr;
+    allocation->block = &block;
+    return true;
+  }
+  return false;
+}
+
+} // namespace
+
+MemoryAllocator::MemoryAllocator(
+    const VkDevice device,
+    const VkPhysicalDevice physicalDevice)
+    : device_(device), physicalDevice_(physicalDevice) {
+  vkGetPhysicalDeviceMemoryProperties(physicalDevice_, &memoryProperties_);
+  VkPhysicalDeviceProperties properties{};
+  vkGetPhysicalDeviceProperties(physicalDevice_, &properties);
+  nonCoherentAtomSize_ =
+      std::max<VkDeviceSize>(properties.limits.nonCoherentAtomSize, 1);
+}
+
+MemoryAllocator::~MemoryAllocator() {
+  for (const auto& block : blocks_) {
+    vkFreeMemory(device_, block->memory, nullptr);
+  }
+}
+
+MemoryAllocation MemoryAllocator::allocate(
+    const VkMemoryRequirements& requirements,
+    const VkMemoryPropertyFlags properties,
+    const bool linear) {
+  const uint32_t memoryTypeIndex = findMemoryType(
+      physicalDevice_, requirements.memoryTypeBits, properties);
+  TORCH_CHECK(
+      memoryTypeIndex != static_cast<uint32_t>(-1),
+      "Vulkan: No memory type with the property flags ",
+      properties);
+  const bool hostVisible =
+      memoryProperties_.memoryTypes[memoryTypeIndex].propertyFlags &
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+  // The ranges of host visible memory that are flushed or invalidated must be
+  // aligned to nonCoherentAtomSize.
+  const VkDeviceSize alignment = hostVisible
+      ? std::max(requirements.alignment, nonCoherentAtomSize_)
+      : requirements.alignment;
+  const VkDeviceSize size = alignUp(requirements.size, alignment);
+
+  const auto allocateMemory = [&](const VkDeviceSize allocationSize,
+                                  VkDeviceMemory* const memory,
+                                  void** const mapped) {
+    VkMemoryAllocateInfo allocateInfo{};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocateInfo.allocationSize = allocationSize;
+    allocateInfo.memoryTypeIndex = memoryTypeIndex;
+    VK_CHECK(vkAllocateMemory(device_, &allocateInfo, nullptr, memory));
+    *mapped = nullptr;
+    if (hostVisible) {
+      VK_CHECK(vkMapMemory(device_, *memory, 0, VK_WHOLE_SIZE, 0, mapped));
+    }
+  };
+
+  MemoryAllocation allocation{};
+  if (size > kBlockSize / 2) {
+    allocateMemory(size, &allocation.memory, &allocation.mapped);
+    allocation.size = size;
+    return allocation;
+  }
+
+  for (const auto& block : blocks_) {
+    if (block->memoryTypeIndex == memoryTypeIndex && block->linear == linear &&
+        allocateFromBlock(*block, size, alignment, &allocation)) {
+      return allocation;
+    }
+  }
+
+  auto block = std::make_unique<MemoryBlock>();
+  allocateMemory(kBlockSize, &block->memory, &block->mapped);
+  block->size = kBlockSize;
+  block->memoryTypeIndex = memoryTypeIndex;
+  block->linear = linear;
+  block->freeRanges.emplace(0, kBlockSize);
+  const bool allocated = allocateFromBlock(*block, size, alignment, &allocation);
+  TORCH_INTERNAL_ASSERT(allocated);
+  blocks_.push_back(std::move(block));
+  return allocation;
+}
+
+void MemoryAllocator::free(const MemoryAllocation& allocation) {
+  MemoryBlock* const block = allocation.block;
+  if (!block) {
+    if (allocation.memory != VK_NULL_HANDLE) {
+      vkFreeMemory(device_, allocation.memory, nullptr);
+    }
+    return;
+  }
+
+  auto& freeRanges = block->freeRanges;
+  VkDeviceSize offset = allocation.offset;
+  VkDeviceSize size = allocation.size;
+  const auto next = freeRanges.lower_bound(offset);
+  if (next != freeRanges.begin()) {
+    const auto previous = std::prev(next);
+    if (previous->first + previous->second == offset) {
+      offset = previous->first;
+      size += previous->second;
+      freeRanges.erase(previous);
+    }
+  }
+  if (next != freeRanges.end() && offset + size == next->first) {
+    size += next->second;
+    freeRanges.erase(next);
+  }
+  freeRanges.emplace(offset, size);
+
+  // Only one empty block of each kind is kept for the next allocations.
+  if (block->empty()) {
+    for (auto it = blocks_.begin(); it != blocks_.end(); ++it) {
+      const auto& other = *it;
+      if (other.get() != block &&
+          other->memoryTypeIndex == block->memoryTypeIndex &&
+          other->linear == block->linear && other->empty()) {
+        vkFreeMemory(device_, other->memory, nullptr);
+        blocks_.erase(it);
+        break;
+      }
+    }
+  }
+}
+
 void VBuffer::MapMemory::flushWriteToDevice() {
   VkMappedMemoryRange range{};
   range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
@@ -310,7 +501,6 @@ VBuffer::VBuffer(
     const VkDescriptorType descriptorType)
     : bufferSizeBytes_(bufferSizeBytes), descriptorType_(descriptorType) {
   const auto device = context().device();
-  const auto physicalDevice = context().physicalDevice();
   VkBufferCreateInfo bufferCreateInfo{};
   bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
   bufferCreateInfo.size = bufferSizeBytes_;
@@ -319,21 +509,68 @@ VBuffer::VBuffer(
   VK_CHECK(vkCreateBuffer(device, &bufferCreateInfo, nullptr, &buffer_));
   VkMemoryRequirements memoryRequirements;
   vkGetBufferMemoryRequirements(device, buffer_, &memoryRequirements);
-  VkMemoryAllocateInfo allocateInfo{};
-  allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  allocateInfo.allocationSize = memoryRequirements.size;
-  allocateInfo.memoryTypeIndex = findMemoryType(
-      physicalDevice,
-      memoryRequirements.memoryTypeBits,
+  allocation_ = context().memoryAllocator().allocate(
+      memoryRequirements,
       VK_MEMORY_PROPERTY_HOST_COHERENT_BIT |
-          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
-  VK_CHECK(vkAllocateMemory(device, &allocateInfo, nullptr, &bufferMemory_));
-  VK_CHECK(vkBindBufferMemory(device, buffer_, bufferMemory_, 0));
+          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+      true /* linear */);
+  VK_CHECK(vkBindBufferMemory(
+      device, buffer_, allocation_.memory, allocation_.offset));
+}
+
+VBuffer::VBuffer(VBuffer&& other) noexcept
+    : bufferSizeBytes_(other.bufferSizeBytes_),
+      descriptorType_(other.descriptorType_),
+      buffer_(std::exchange(other.buffer_, VkBuffer{})),
+      allocation_(std::exchange(other.allocation_, MemoryAllocation{})),
+      lastUse_(other.lastUse_) {}
+
+VBuffer& VBuffer::operator=(VBuffer&& other) noexcept {
+  if (this != &other) {
+    release();
+    bufferSizeBytes_ = other.bufferSizeBytes_;
+    descriptorType_ = other.descriptorType_;
+    buffer_ = std::exchange(other.buffer_, VkBuffer{});
+    allocation_ = std::exchange(other.allocation_, MemoryAllocation{});
+    lastUse_ = other.lastUse_;
+  }
+  return *this;
 }
 
 VBuffer::~VBuffer() {
-  vkFreeMemory(context().device(), bufferMemory_, nullptr);
-  vkDestroyBuffer(context().device(), buffer_, nullptr);
+  release();
+}
+
+void VBuffer::release() {
+  if (buffer_ == VK_NULL_HANDLE) {
+    return;
+  }
+  const auto device = context().device();
+  const auto allocator = &context().memoryAllocator();
+  const auto buffer = buffer_;
+  const auto allocation = allocation_;
+  context().commandBatch().release(
+      lastUse_, [device, allocator, buffer, allocation]() {
+        vkDestroyBuffer(device, buffer, nullptr);
+        allocator->free(allocation);
+      });
+  buffer_ = VK_NULL_HANDLE;
+}
+
+VBuffer::MapMemory VBuffer::map() const {
+  auto& commandBatch = context().commandBatch();
+  if (commandBatch.pending(lastUse_)) {
+    commandBatch.flush();
+  }
+  return MapMemory{context().device(),
+                   allocation_.memory,
+                   allocation_.offset,
+                   allocation_.size,
+                   allocation_.mapped};
+}
+
+void VBuffer::recordUse() const {
+  lastUse_ = context().commandBatch().id();
 }
 
 void VBuffer::copy_from_device_to_host(
@@ -385,6 +622,7 @@ VkWriteDescriptorSet VBuffer::makeWriteDescriptorSet(
 }
 
 void VBuffer::bind(const VkDescriptorSet descriptorSet, const uint32_t binding) const {
+  recordUse();
   const auto descrBufferInfo = makeDescriptorBufferInfo();
   const auto writeDescrSet =
       makeWriteDescriptorSet(descriptorSet, binding, &descrBufferInfo);
@@ -424,7 +662,6 @@ void VBuffer::addBufferMemoryBarrier(
 VImage::VImage(const ImageSize imageSize, const ImageSize dataSize)
     : imageSize_(imageSize), dataSize_(dataSize) {
   const auto device = context().device();
-  const auto physicalDevice = context().physicalDevice();
 
   VkImageCreateInfo imageInfo{};
   imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -449,16 +686,10 @@ VImage::VImage(const ImageSize imageSize, const ImageSize dataSize)
 
   VkMemoryRequirements memReqs{};
   vkGetImageMemoryRequirements(device, image_, &memReqs);
-  VkMemoryAllocateInfo allocInfo{};
-  allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  allocInfo.allocationSize = memReqs.size;
-  allocInfo.memoryTypeIndex = findMemoryType(
-      physicalDevice,
-      memReqs.memoryTypeBits,
-      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-
-  VK_CHECK(vkAllocateMemory(device, &allocInfo, nullptr, &imageMemory_));
-  VK_CHECK(vkBindImageMemory(device, image_, imageMemory_, 0));
+  allocation_ = context().memoryAllocator().allocate(
+      memReqs, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, false /* linear */);
+  VK_CHECK(vkBindImageMemory(
+      device, image_, allocation_.memory, allocation_.offset));
 
   const VkImageViewCreateInfo imageViewCreateInfo = makeImageViewCreateInfo();
   VK_CHECK(
@@ -468,11 +699,53 @@ VImage::VImage(const ImageSize imageSize, const ImageSize dataSize)
   VK_CHECK(vkCreateSampler(device, &samplerCreateInfo, nullptr, &sampler_));
 }
 
+VImage::VImage(VImage&& other) noexcept
+    : imageSize_(other.imageSize_),
+      dataSize_(other.dataSize_),
+      image_(std::exchange(other.image_, VkImage{})),
+      allocation_(std::exchange(other.allocation_, MemoryAllocation{})),
+      imageView_(std::exchange(other.imageView_, VkImageView{})),
+      sampler_(std::exchange(other.sampler_, VkSampler{})),
+      imageLayout_(other.imageLayout_),
+      lastUse_(other.lastUse_) {}
+
+VImage& VImage::operator=(VImage&& other) noexcept {
+  if (this != &other) {
+    release();
+    imageSize_ = other.imageSize_;
+    dataSize_ = other.dataSize_;
+    image_ = std::exchange(other.image_, VkImage{});
+    allocation_ = std::exchange(other.allocation_, MemoryAllocation{});
+    imageView_ = std::exchange(other.imageView_, VkImageView{});
+    sampler_ = std::exchange(other.sampler_, VkSampler{});
+    imageLayout_ = other.imageLayout_;
+    lastUse_ = other.lastUse_;
+  }
+  return *this;
+}
+
 VImage::~VImage() {
-  vkFreeMemory(context().device(), imageMemory_, nullptr);
-  vkDestroySampler(context().device(), sampler_, nullptr);
-  vkDestroyImageView(context().device(), imageView_, nullptr);
-  vkDestroyImage(context().device(), image_, nullptr);
+  release();
+}
+
+void VImage::release() {
+  if (image_ == VK_NULL_HANDLE) {
+    return;
+  }
+  const auto device = context().device();
+  const auto allocator = &context().memoryAllocator();
+  const auto image = image_;
+  const auto imageView = imageView_;
+  const auto sampler = sampler_;
+  const auto allocation = allocation_;
+  context().commandBatch().release(
+      lastUse_, [device, allocator, image, imageView, sampler, allocation]() {
+        vkDestroySampler(device, sampler, nullptr);
+        vkDestroyImageView(device, imageView, nullptr);
+        vkDestroyImage(device, image, nullptr);
+        allocator->free(allocation);
+      });
+  image_ = VK_NULL_HANDLE;
 }
 
 VkImageViewCreateInfo VImage::makeImageViewCreateInfo() const {
@@ -540,6 +813,7 @@ void VImage::bind(
     const uint32_t binding,
     const VkDescriptorType descriptorType,
     const VkImageLayout imageLayout) const {
+  lastUse_ = context().commandBatch().id();
   const auto descrImageInfo = makeDescriptorImageInfo(imageLayout);
   const auto writeDescrSet = makeWriteDescriptorSet(
       descriptorSet, binding, descriptorType, &descrImageInfo);
@@ -572,6 +846,7 @@ void VImage::addImageMemoryBarrier(
     return;
   }
 
+  lastUse_ = context().commandBatch().id();
   VkImageMemoryBarrier barrier{};
   barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
   barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
@@ -689,25 +964,95 @@ void allocateDescriptorSet(
   VK_CHECK(vkAllocateDescriptorSets(device, &allocateInfo, descriptorSet));
 }
 
-void createDescriptorSetLayoutSinglePool(
-    const VkDevice device,
-    const std::vector<VkDescriptorType>& descrTypes,
-    VkDescriptorSetLayout* const descrSetLayout,
-    VkDescriptorPool* const descrPool,
-    VkDescriptorSet* const descrSet) {
-  const auto size = descrTypes.size();
+DescriptorCache::~DescriptorCache() {
+  for (const auto& pools : {pools_, previousPools_, freePools_}) {
+    for (const auto pool : pools) {
+      vkDestroyDescriptorPool(device_, pool, nullptr);
+    }
+  }
+  for (const auto& layout : layouts_) {
+    vkDestroyDescriptorSetLayout(device_, layout.second, nullptr);
+  }
+}
+
+VkDescriptorSetLayout DescriptorCache::layout(
+    const std::vector<VkDescriptorType>& descrTypes) {
+  const auto it = layouts_.find(descrTypes);
+  if (it != layouts_.end()) {
+    return it->second;
+  }
   std::vector<VkDescriptorSetLayoutBinding> bindings;
-  std::vector<VkDescriptorPoolSize> poolSizes;
   uint32_t i = 0;
   for (const auto& descrType : descrTypes) {
     bindings.push_back(descriptorSetLayoutBinding(i, descrType));
-    poolSizes.push_back(VkDescriptorPoolSize{descrType, 1});
     i++;
   }
-  createDescriptorSetLayout(device, bindings.data(), size, descrSetLayout);
+  VkDescriptorSetLayout descrSetLayout{};
+  createDescriptorSetLayout(
+      device_, bindings.data(), bindings.size(), &descrSetLayout);
+  layouts_.emplace(descrTypes, descrSetLayout);
+  return descrSetLayout;
+}
+
+VkDescriptorPool DescriptorCache::createPool() {
+  if (!freePools_.empty()) {
+    const auto pool = freePools_.back();
+    freePools_.pop_back();
+    return pool;
+  }
+  const VkDescriptorPoolSize poolSizes[] = {
+      {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, kDescriptorsPerPool},
+      {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, kDescriptorsPerPool},
+      {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, kDescriptorsPerPool},
+      {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, kDescriptorsPerPool}};
+  VkDescriptorPool pool{};
   createDescriptorPool(
-      device, poolSizes.data(), size, 1 /* maxSets */, descrPool);
-  allocateDescriptorSet(device, *descrPool, descrSetLayout, descrSet);
+      device_, poolSizes, 4 /* poolSizeCount */, kSetsPerPool, &pool);
+  return pool;
+}
+
+VkDescriptorSet DescriptorCache::allocate(
+    const VkDescriptorSetLayout descrSetLayout,
+    VkDescriptorPool* const descrPool) {
+  if (pools_.empty()) {
+    pools_.push_back(createPool());
+  }
+  VkDescriptorSetAllocateInfo allocateInfo{};
+  allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+  allocateInfo.pNext = nullptr;
+  allocateInfo.descriptorPool = pools_.back();
+  allocateInfo.descriptorSetCount = 1;
+  allocateInfo.pSetLayouts = &descrSetLayout;
+  VkDescriptorSet descrSet{};
+  if (vkAllocateDescriptorSets(device_, &allocateInfo, &descrSet) !=
+      VK_SUCCESS) {
+    // The pool is exhausted.
+    pools_.push_back(createPool());
+    allocateInfo.descriptorPool = pools_.back();
+    VK_CHECK(vkAllocateDescriptorSets(device_, &allocateInfo, &descrSet));
+  }
+  *descrPool = pools_.back();
+  return descrSet;
+}
+
+void DescriptorCache::batchCompleted() {
+  for (const auto pool : previousPools_) {
+    VK_CHECK(vkResetDescriptorPool(device_, pool, 0));
+    freePools_.push_back(pool);
+  }
+  previousPools_ = std::move(pools_);
+  pools_.clear();
+}
+
+void createDescriptorSetLayoutSinglePool(
+    const VkDevice device,
+    const std::vector<VkDescriptorType>& descrTypes,
+    VkDescriptorSetLayout* const descrSetLayout,
+    VkDescriptorPool* const descrPool,
+    VkDescriptorSet* const descrSet) {
+  auto& descriptorCache = context().descriptorCache();
+  *descrSetLayout = descriptorCache.layout(descrTypes);
+  *descrSet = descriptorCache.allocate(*descrSetLayout, descrPool);
 }
 
 void allocateCommandBuffer(VkDevice device, VkCommandBuffer* commandBuffer) {
@@ -754,6 +1099,132 @@ void submitAndWaitCommandBuffer(
   vkDestroyFence(device, fence, NULL);
 }
 
+CommandBatch::CommandBatch(
+    const VkDevice device,
+    const VkCommandPool commandPool,
+    const VkQueue queue,
+    DescriptorCache& descriptorCache)
+    : device_(device), queue_(queue), descriptorCache_(descriptorCache) {
+  VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
+  commandBufferAllocateInfo.sType =
+      VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  commandBufferAllocateInfo.commandPool = commandPool;
+  commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  commandBufferAllocateInfo.commandBufferCount = 1;
+  VK_CHECK(vkAllocateCommandBuffers(
+      device_, &commandBufferAllocateInfo, &commandBuffer_));
+
+  VkFenceCreateInfo fenceCreateInfo{};
+  fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+  fenceCreateInfo.flags = 0;
+  VK_CHECK(vkCreateFence(device_, &fenceCreateInfo, nullptr, &fence_));
+
+  const char* const immediate = std::getenv("PYTORCH_VULKAN_IMMEDIATE_SUBMIT");
+  deferred_ = !(immediate && std::strcmp(immediate, "1") == 0);
+}
+
+CommandBatch::~CommandBatch() {
+  // The command buffer is freed with the command pool.
+  vkDestroyFence(device_, fence_, nullptr);
+}
+
+VkCommandBuffer CommandBatch::record() {
+  if (!recording_) {
+    beginCommandBuffer(commandBuffer_);
+    recording_ = true;
+    return commandBuffer_;
+  }
+  // The commands of an op read what the previous ones wrote, and may
+  // overwrite what they read.
+  VkMemoryBarrier barrier{};
+  barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+  barrier.pNext = nullptr;
+  barrier.srcAccessMask =
+      VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT |
+      VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_UNIFORM_READ_BIT |
+      VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+  vkCmdPipelineBarrier(
+      commandBuffer_,
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+      0,
+      1,
+      &barrier,
+      0,
+      nullptr,
+      0,
+      nullptr);
+  return commandBuffer_;
+}
+
+void CommandBatch::recorded() {
+  if (!deferred_ || ++numDispatches_ >= kMaxDispatches) {
+    flush();
+  }
+}
+
+void CommandBatch::flush() {
+  if (!recording_) {
+    return;
+  }
+  // Makes what the commands wrote visible to the host.
+  VkMemoryBarrier barrier{};
+  barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+  barrier.pNext = nullptr;
+  barrier.srcAccessMask =
+      VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+  vkCmdPipelineBarrier(
+      commandBuffer_,
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_PIPELINE_STAGE_HOST_BIT,
+      0,
+      1,
+      &barrier,
+      0,
+      nullptr,
+      0,
+      nullptr);
+  endCommandBuffer(commandBuffer_);
+
+  VkSubmitInfo submitInfo{};
+  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers = &commandBuffer_;
+  VK_CHECK(vkQueueSubmit(queue_, 1, &submitInfo, fence_));
+  VK_CHECK(vkWaitForFences(
+      device_, 1, &fence_, VK_TRUE, ComputeUnit::kFenceTimeoutNanos));
+  VK_CHECK(vkResetFences(device_, 1, &fence_));
+
+  recording_ = false;
+  numDispatches_ = 0;
+  id_++;
+  descriptorCache_.batchCompleted();
+  auto releases = std::move(releases_);
+  releases_.clear();
+  for (const auto& release : releases) {
+    release();
+  }
+}
+
+void CommandBatch::release(
+    const uint64_t lastUse,
+    std::function<void()> releaseFn) {
+  if (pending(lastUse)) {
+    releases_.push_back(std::move(releaseFn));
+  } else {
+    releaseFn();
+  }
+}
+
+void CommandBatch::setDeferred(const bool deferred) {
+  if (!deferred) {
+    flush();
+  }
+  deferred_ = deferred;
+}
+
 ComputeUnit::~ComputeUnit() {
   vkDestroyShaderModule(context().device(), computeShaderModule_, nullptr);
   vkDestroyPipelineLayout(context().device(), pipelineLayout_, nullptr);
@@ -863,22 +1334,7 @@ void ComputeUnit::createComputePipelineCompile(
 #endif
 
 void ComputeUnit::createCommandBuffer(VkDescriptorSet& descriptorSet) {
-  const auto device = context().device();
-  VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
-  commandBufferAllocateInfo.sType =
-      VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-  commandBufferAllocateInfo.commandPool = context().commandPool();
-  commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-  commandBufferAllocateInfo.commandBufferCount = 1;
-
-  VK_CHECK(vkAllocateCommandBuffers(
-      device, &commandBufferAllocateInfo, &commandBuffer_));
-
-  VkCommandBufferBeginInfo beginInfo{};
-  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-  VK_CHECK(vkBeginCommandBuffer(commandBuffer_, &beginInfo));
-
+  commandBuffer_ = context().commandBatch().record();
   vkCmdBindPipeline(commandBuffer_, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_);
   vkCmdBindDescriptorSets(
       commandBuffer_,
@@ -922,7 +1378,7 @@ void ComputeUnit::dispatchCommandBuffer(
 }
 
 void ComputeUnit::endCommandBuffer() {
-  at::native::vulkan::detail::endCommandBuffer(commandBuffer_);
+  // Other ops may record their commands after these, see CommandBatch.
 }
 
 void ComputeUnit::dispatchCommandBuffer(
@@ -937,21 +1393,7 @@ void ComputeUnit::dispatchCommandBuffer(
 }
 
 void ComputeUnit::submitAndWaitCommandBuffer() {
-  VkSubmitInfo submitInfo{};
-  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-  submitInfo.commandBufferCount = 1;
-  submitInfo.pCommandBuffers = &commandBuffer_;
-
-  VkFence fence{};
-  VkFenceCreateInfo fenceCreateInfo{};
-  fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-  fenceCreateInfo.flags = 0;
-  VK_CHECK(vkCreateFence(context().device(), &fenceCreateInfo, NULL, &fence))
-
-  VK_CHECK(vkQueueSubmit(context().queue(), 1, &submitInfo, fence));
-  vkWaitForFences(context().device(), 1, &fence, VK_TRUE, kFenceTimeoutNanos);
-
-  vkDestroyFence(context().device(), fence, NULL);
+  context().commandBatch().recorded();
 }
 
 VBuffer makeUniformConstBuffer(const void* const ptr, const VkDeviceSize size) {
@@ -1045,22 +1487,16 @@ void copy_buffer_to_image(const VBuffer& buffer, VImage& image) {
   VBuffer constBuffer = makeUniformConstBuffer(&constBlock, sizeof(constBlock));
 
   VkDescriptorSetLayout descrSetLayout{};
-  VkDescriptorSetLayoutBinding bindings[] = {
-      descriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE),
-      descriptorSetLayoutBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER),
-      descriptorSetLayoutBinding(2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)};
-  createDescriptorSetLayout(
-      device, bindings, 3 /* bindingsCount */, &descrSetLayout);
-
   VkDescriptorPool descrPool{};
-  VkDescriptorPoolSize poolSizes[] = {{VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1},
-                                      {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1},
-                                      {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1}};
-  createDescriptorPool(
-      device, poolSizes, 3 /* poolSizeCount */, 1 /* maxSets */, &descrPool);
-
   VkDescriptorSet descrSet{};
-  allocateDescriptorSet(device, descrPool, &descrSetLayout, &descrSet);
+  createDescriptorSetLayoutSinglePool(
+      device,
+      {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+       VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+       VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER},
+      &descrSetLayout,
+      &descrPool,
+      &descrSet);
 
   image.bindStorageImage(descrSet, 0);
   buffer.bind(descrSet, 1);
@@ -1083,9 +1519,6 @@ void copy_buffer_to_image(const VBuffer& buffer, VImage& image) {
       image.w(), image.h(), image.d(), workGroupSize);
   computeUnit.endCommandBuffer();
   computeUnit.submitAndWaitCommandBuffer();
-
-  vkDestroyDescriptorPool(device, descrPool, nullptr);
-  vkDestroyDescriptorSetLayout(device, descrSetLayout, nullptr);
 }
 
 void copy_image_to_buffer(
@@ -1105,23 +1538,16 @@ void copy_image_to_buffer(
   VBuffer constBuffer = makeUniformConstBuffer(&constBlock, sizeof(constBlock));
 
   VkDescriptorSetLayout descrSetLayout{};
-  const VkDescriptorSetLayoutBinding bindings[] = {
-      descriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER),
-      descriptorSetLayoutBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER),
-      descriptorSetLayoutBinding(2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)};
-  createDescriptorSetLayout(
-      device, bindings, 3 /* bindingsCount */, &descrSetLayout);
-
   VkDescriptorPool descrPool{};
-  const VkDescriptorPoolSize poolSizes[] = {
-      {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1},
-      {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1},
-      {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1}};
-  createDescriptorPool(
-      device, poolSizes, 3 /* poolSizeCount */, 1 /* maxSets */, &descrPool);
-
   VkDescriptorSet descrSet{};
-  allocateDescriptorSet(device, descrPool, &descrSetLayout, &descrSet);
+  createDescriptorSetLayoutSinglePool(
+      device,
+      {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+       VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+       VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER},
+      &descrSetLayout,
+      &descrPool,
+      &descrSet);
 
   image.bindShaderRead(descrSet, 0);
   buffer.bind(descrSet, 1);
@@ -1145,9 +1571,6 @@ void copy_image_to_buffer(
   }
   computeUnit.endCommandBuffer();
   computeUnit.submitAndWaitCommandBuffer();
-
-  vkDestroyDescriptorPool(device, descrPool, nullptr);
-  vkDestroyDescriptorSetLayout(device, descrSetLayout, nullptr);
 } // VBuffer <-> VImage
 
 void copy_buffer_to_buffer(
@@ -1156,10 +1579,10 @@ void copy_buffer_to_buffer(
     VkDeviceSize size,
     VkDeviceSize srcOffset,
     VkDeviceSize dstOffset) {
-  auto device = context().device();
-  VkCommandBuffer commandBuffer{};
-  allocateCommandBuffer(device, &commandBuffer);
-  beginCommandBuffer(commandBuffer);
+  auto& commandBatch = context().commandBatch();
+  const auto commandBuffer = commandBatch.record();
+  srcBuffer.recordUse();
+  dstBuffer.recordUse();
 
   VkBufferCopy copyRegion{};
   copyRegion.srcOffset = srcOffset;
@@ -1171,9 +1594,7 @@ void copy_buffer_to_buffer(
       dstBuffer.vkbuffer(),
       1,
       &copyRegion);
-
-  endCommandBuffer(commandBuffer);
-  submitAndWaitCommandBuffer(device, context().queue(), commandBuffer);
+  commandBatch.recorded();
 }
 
 // VulkanTensor
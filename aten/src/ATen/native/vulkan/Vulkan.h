@@ -3,6 +3,8 @@
 #include <c10/util/Optional.h>
 #include <array>
 #include <cstring>
+#include <functional>
+#include <map>
 #include <memory>
 #include <vector>
 
@@ -147,6 +149,9 @@ class VulkanTensor final {
 };
 
 class ComputeUnitFactory;
+class MemoryAllocator;
+class DescriptorCache;
+class CommandBatch;
 class VContext final {
  public:
   explicit VContext(bool enableValidationLayers);
@@ -174,6 +179,15 @@ class VContext final {
   ComputeUnitFactory& computeUnitFactory() const {
     return *(computeUnitFactory_.get());
   }
+  MemoryAllocator& memoryAllocator() const {
+    return *(memoryAllocator_.get());
+  }
+  DescriptorCache& descriptorCache() const {
+    return *(descriptorCache_.get());
+  }
+  CommandBatch& commandBatch() const {
+    return *(commandBatch_.get());
+  }
 
  private:
   void createInstance();
@@ -192,26 +206,172 @@ class VContext final {
   bool enableValidationLayers_;
   VkCommandPool commandPool_;
   std::unique_ptr<ComputeUnitFactory> computeUnitFactory_;
+  std::unique_ptr<MemoryAllocator> memoryAllocator_;
+  std::unique_ptr<DescriptorCache> descriptorCache_;
+  std::unique_ptr<CommandBatch> commandBatch_;
+};
+
+struct MemoryBlock;
+
+// A range of device memory of the MemoryAllocator.
+struct MemoryAllocation final {
+  VkDeviceMemory memory = VK_NULL_HANDLE;
+  VkDeviceSize offset = 0;
+  VkDeviceSize size = 0;
+  // The host address of the range for host visible memory, which stays mapped
+  // as long as it is allocated.
+  void* mapped = nullptr;
+  // The block the range is in, null for a dedicated allocation.
+  MemoryBlock* block = nullptr;
+};
+
+// Allocates the memory of VBuffers and VImages from blocks of kBlockSize
+// bytes of device memory, instead of a vkAllocateMemory per tensor, whose
+// number is limited and which is slow on mobile drivers. The freed ranges are
+// reused by the next allocations, e.g. by the tensors of the next inference;
+// the host visible blocks are mapped once. Allocations larger than half a
+// block get memory of their own.
+class MemoryAllocator final {
+ public:
+  static constexpr VkDeviceSize kBlockSize = 16 * 1024 * 1024;
+
+  MemoryAllocator(VkDevice device, VkPhysicalDevice physicalDevice);
+  ~MemoryAllocator();
+  MemoryAllocator(const MemoryAllocator&) = delete;
+  MemoryAllocator& operator=(const MemoryAllocator&) = delete;
+
+  // linear is whether the memory is for a buffer rather than for an optimally
+  // tiled image: they are allocated from different blocks so that they are
+  // never closer than bufferImageGranularity.
+  MemoryAllocation allocate(
+      const VkMemoryRequirements& requirements,
+      VkMemoryPropertyFlags properties,
+      bool linear);
+  void free(const MemoryAllocation& allocation);
+
+ private:
+  VkDevice device_;
+  VkPhysicalDevice physicalDevice_;
+  VkPhysicalDeviceMemoryProperties memoryProperties_;
+  VkDeviceSize nonCoherentAtomSize_;
+  std::vector<std::unique_ptr<MemoryBlock>> blocks_;
+};
+
+// The descriptor set layouts, created once for each list of descriptor types,
+// and the descriptor pools the ops allocate their descriptor sets from. A pool
+// is reset once the commands of the batches its sets were allocated for
+// completed, see CommandBatch, and then reused.
+class DescriptorCache final {
+ public:
+  static constexpr uint32_t kSetsPerPool = 256;
+  static constexpr uint32_t kDescriptorsPerPool = 4 * kSetsPerPool;
+
+  explicit DescriptorCache(VkDevice device) : device_(device) {}
+  ~DescriptorCache();
+  DescriptorCache(const DescriptorCache&) = delete;
+  DescriptorCache& operator=(const DescriptorCache&) = delete;
+
+  VkDescriptorSetLayout layout(const std::vector<VkDescriptorType>& descrTypes);
+  VkDescriptorSet allocate(
+      VkDescriptorSetLayout descrSetLayout,
+      VkDescriptorPool* descrPool);
+
+  // Called once a batch completed: the sets allocated up to now may still be
+  // used by the next batch, only the sets allocated up to the previous batch
+  // are released.
+  void batchCompleted();
+
+ private:
+  VkDescriptorPool createPool();
+
+  VkDevice device_;
+  std::map<std::vector<VkDescriptorType>, VkDescriptorSetLayout> layouts_;
+  // The pools of the batch being recorded, the last one being allocated from,
+  // those of the previous batch, and the ones that are reset.
+  std::vector<VkDescriptorPool> pools_;
+  std::vector<VkDescriptorPool> previousPools_;
+  std::vector<VkDescriptorPool> freePools_;
+};
+
+// The command buffer the ops record their dispatches and copies in.
+//
+// The submission is deferred by default: the commands of successive ops are
+// recorded in the same command buffer, ordered by barriers, which is only
+// submitted when the host maps the memory of a buffer they use, e.g. to read
+// an output back, or after kMaxDispatches ops. Set the
+// PYTORCH_VULKAN_IMMEDIATE_SUBMIT environment variable to 1 to submit and wait
+// for every op instead. The buffers and images destroyed while commands using
+// them are pending are only released once these complete.
+class CommandBatch final {
+ public:
+  static constexpr uint32_t kMaxDispatches = 128;
+
+  CommandBatch(
+      VkDevice device,
+      VkCommandPool commandPool,
+      VkQueue queue,
+      DescriptorCache& descriptorCache);
+  ~CommandBatch();
+  CommandBatch(const CommandBatch&) = delete;
+  CommandBatch& operator=(const CommandBatch&) = delete;
+
+  // The command buffer to record the commands of an op in, after those
+  // recorded before.
+  VkCommandBuffer record();
+  // Called once the commands of an op are recorded, they are submitted and
+  // waited for unless the submission is deferred.
+  void recorded();
+  // Submits the recorded commands and waits for them.
+  void flush();
+
+  // The batch being recorded, that the buffers and images remember as their
+  // last use when they are bound.
+  inline uint64_t id() const {
+    return id_;
+  }
+  // Whether the recorded commands may use a resource last used by batch
+  // lastUse.
+  inline bool pending(const uint64_t lastUse) const {
+    return recording_ && lastUse == id_;
+  }
+  // Calls releaseFn once the commands that may use the resource are done.
+  void release(uint64_t lastUse, std::function<void()> releaseFn);
+
+  inline bool deferred() const {
+    return deferred_;
+  }
+  void setDeferred(bool deferred);
+
+ private:
+  VkDevice device_;
+  VkQueue queue_;
+  DescriptorCache& descriptorCache_;
+  VkCommandBuffer commandBuffer_;
+  VkFence fence_;
+  bool deferred_;
+  bool recording_ = false;
+  uint32_t numDispatches_ = 0;
+  uint64_t id_ = 1;
+  std::vector<std::function<void()>> releases_;
 };
 
 class VBuffer final {
  public:
+  // A view of the memory of the buffer, which the allocator keeps mapped.
   class MapMemory final {
    public:
     MapMemory(
         const VkDevice device,
         const VkDeviceMemory deviceMemory,
         const VkDeviceSize offset,
-        const VkDeviceSize size)
+        const VkDeviceSize size,
+        void* const mappedMemory)
         : device_(device),
           deviceMemory_(deviceMemory),
           offset_(offset),
-          size_(size) {
-      vkMapMemory(device_, deviceMemory_, 0, size, 0, &mappedMemory_);
-    }
-    ~MapMemory() {
-      vkUnmapMemory(device_, deviceMemory_);
-    }
+          size_(size),
+          mappedMemory_(mappedMemory) {}
+    ~MapMemory() = default;
     MapMemory(const MapMemory&) = delete;
     MapMemory& operator=(const MapMemory&) = delete;
     MapMemory(MapMemory&&) = default;
@@ -243,8 +403,8 @@ class VBuffer final {
 
   VBuffer(const VBuffer&) = delete;
   VBuffer& operator=(const VBuffer&) = delete;
-  VBuffer(VBuffer&&) = default;
-  VBuffer& operator=(VBuffer&&) = default;
+  VBuffer(VBuffer&& other) noexcept;
+  VBuffer& operator=(VBuffer&& other) noexcept;
 
   static inline VBuffer makeUniformBuffer(const VkDeviceSize bufferSize) {
     return VBuffer{bufferSize,
@@ -252,9 +412,8 @@ class VBuffer final {
                    VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER};
   }
 
-  MapMemory map() const {
-    return MapMemory{context().device(), bufferMemory_, 0, bufferSizeBytes_};
-  }
+  // Waits for the pending commands using the buffer first.
+  MapMemory map() const;
 
   void copy_from_device_to_host(void* outputData, int64_t size) const;
   void copy_from_host_to_device(const void* data, int64_t size);
@@ -281,11 +440,18 @@ class VBuffer final {
     return buffer_;
   }
 
+  // Remembers that the commands being recorded use the buffer.
+  void recordUse() const;
+
  private:
+  void release();
+
   VkDeviceSize bufferSizeBytes_;
   VkDescriptorType descriptorType_;
   VkBuffer buffer_;
-  VkDeviceMemory bufferMemory_;
+  MemoryAllocation allocation_;
+  // The batch of commands that last used the buffer, see CommandBatch.
+  mutable uint64_t lastUse_ = 0;
 };
 
 VBuffer makeUniformConstBuffer(const void* ptr, VkDeviceSize size);
@@ -305,8 +471,8 @@ class VImage final {
   ~VImage();
   VImage(const VImage&) = delete;
   VImage& operator=(const VImage&) = delete;
-  VImage(VImage&&) = default;
-  VImage& operator=(VImage&&) = default;
+  VImage(VImage&& other) noexcept;
+  VImage& operator=(VImage&& other) noexcept;
 
   inline auto w() const {
     return imageSize_[0];
@@ -354,16 +520,20 @@ class VImage final {
   void addImageMemoryBarrierToShaderRead(VkCommandBuffer commandBuffer) const;
 
  private:
+  void release();
+
   ImageSize imageSize_;
   ImageSize dataSize_;
   VkImage image_;
-  VkDeviceMemory imageMemory_;
+  MemoryAllocation allocation_;
   VkImageView imageView_;
   VkSampler sampler_;
   // Holds current image layout that will be used in
   // addImageMemoryBarrier as the previous layout. Need to be mutable to
   // use addImageMemoryBarrier() for const VImage.
   mutable VkImageLayout imageLayout_;
+  // The batch of commands that last used the image, see CommandBatch.
+  mutable uint64_t lastUse_ = 0;
 };
 
 void copy_buffer_to_image(const VBuffer& buffer, VImage& image);
@@ -396,6 +566,10 @@ void allocateDescriptorSet(
     const VkDescriptorSetLayout* descriptorSetLayout,
     VkDescriptorSet* descriptorSet);
 
+// Returns the layout of a descriptor set of these types and allocates such a
+// set, which are owned by the DescriptorCache of the context: the set is valid
+// for the commands recorded by the op, the layout and the pool must not be
+// destroyed.
 void createDescriptorSetLayoutSinglePool(
     VkDevice device,
     const std::vector<VkDescriptorType>& descrTypes,
@@ -460,6 +634,8 @@ class ComputeUnit final {
       WorkGroupSize workGroupSize);
 #endif
 
+  // Binds the pipeline and the descriptor set in the command buffer of the
+  // context, see CommandBatch, for the commands of the unit.
   void createCommandBuffer(VkDescriptorSet& descriptorSet);
   void addMemoryBarrier(
       VkPipelineStageFlags srcStageMask,
@@ -475,7 +651,10 @@ class ComputeUnit final {
       uint32_t gridY,
       uint32_t gridZ,
       WorkGroupSize workGroupSize);
+  // Submits the commands of the unit and waits for them, unless the
+  // submission is deferred, see CommandBatch.
   void submitAndWaitCommandBuffer();
+  // The command buffer of the context is ended when it is submitted.
   void endCommandBuffer();
   inline VkCommandBuffer commandBuffer() {
     return commandBuffer_;
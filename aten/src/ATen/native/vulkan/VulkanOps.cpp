@@ -71,8 +71,6 @@ void upsample_nearest2d(
   computeUnit.dispatchCommandBuffer(OW, OH, C, workGroupSize);
   computeUnit.endCommandBuffer();
   computeUnit.submitAndWaitCommandBuffer();
-  vkDestroyDescriptorPool(device, descriptorPool, nullptr);
-  vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
 }
 
 VulkanTensor reshape_copy(
@@ -156,8 +154,6 @@ void adaptive_avg_pool2d(
   computeUnit.dispatchCommandBuffer(OW, OH, C, workGroupSize);
   computeUnit.endCommandBuffer();
   computeUnit.submitAndWaitCommandBuffer();
-  vkDestroyDescriptorPool(device, descriptorPool, nullptr);
-  vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
 }
 
 void max_pool2d(
@@ -223,8 +219,6 @@ void max_pool2d(
   computeUnit.dispatchCommandBuffer(oW, oH, c, workGroupSize);
   computeUnit.endCommandBuffer();
   computeUnit.submitAndWaitCommandBuffer();
-  vkDestroyDescriptorPool(device, descriptorPool, nullptr);
-  vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
 }
 
 void add(
@@ -306,8 +300,6 @@ void add(
   computeUnit.dispatchCommandBuffer(W, H, C, workGroupSize);
   computeUnit.endCommandBuffer();
   computeUnit.submitAndWaitCommandBuffer();
-  vkDestroyDescriptorPool(device, descriptorPool, nullptr);
-  vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
 }
 
 VBuffer kernelNCHW_OCHW_repack_O4C4HWi4o4(
@@ -452,8 +444,6 @@ void conv2d_depthwise(
   computeUnit.endCommandBuffer();
   computeUnit.submitAndWaitCommandBuffer();
 
-  vkDestroyDescriptorPool(device, descriptorPool, nullptr);
-  vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
 }
 
 void conv2d_depthwise(
@@ -570,9 +560,6 @@ void conv2d_prepack_weights_to_image(
   computeUnit.dispatchCommandBuffer(C_4, OC_4, KH * KW, workGroupSize);
   computeUnit.endCommandBuffer();
   computeUnit.submitAndWaitCommandBuffer();
-  vkDestroyDescriptorPool(context().device(), descriptorPool, nullptr);
-  vkDestroyDescriptorSetLayout(
-      context().device(), descriptorSetLayout, nullptr);
 }
 
 VImage conv2d_prepack_weights_image(
@@ -685,8 +672,6 @@ void conv2d(
   computeUnit.endCommandBuffer();
   computeUnit.submitAndWaitCommandBuffer();
 
-  vkDestroyDescriptorPool(device, descriptorPool, nullptr);
-  vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
 }
 
 void conv2d(
@@ -860,8 +845,6 @@ void clamp(
   computeUnit.dispatchCommandBuffer(W, H, C, workGroupSize);
   computeUnit.endCommandBuffer();
   computeUnit.submitAndWaitCommandBuffer();
-  vkDestroyDescriptorPool(device, descriptorPool, nullptr);
-  vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
 }
 
 void addmm(
@@ -975,8 +958,6 @@ void addmm(
     computeUnit.endCommandBuffer();
     computeUnit.submitAndWaitCommandBuffer();
   }
-  vkDestroyDescriptorPool(device, descriptorPool, nullptr);
-  vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
 }
 
 void mean(VulkanTensor& output, const VulkanTensor& input) {
@@ -1026,8 +1007,6 @@ void mean(VulkanTensor& output, const VulkanTensor& input) {
   computeUnit.dispatchCommandBuffer(1, 1, C_4, workGroupSize);
   computeUnit.endCommandBuffer();
   computeUnit.submitAndWaitCommandBuffer();
-  vkDestroyDescriptorPool(device, descriptorPool, nullptr);
-  vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
 }
 
 } // namespace detail
@@ -0,0 +1,112 @@
+#ifdef USE_XNNPACK
+
+#include <ATen/native/xnnpack/Common.h>
+#include <ATen/native/xnnpack/Engine.h>
+#include <ATen/native/xnnpack/Factory.h>
+
+namespace at {
+namespace native {
+namespace xnnpack {
+namespace {
+
+// The input and the output are dense in the same memory format, which is what
+// allocate_padded_contiguous_if_needed and empty_with_tail_padding return, so
+// the elementwise operator can treat them as a single row of numel() channels.
+
+void hardswish_impl(const Tensor& input, Tensor& output) {
+  using namespace internal;
+
+  xnn_operator_t hardswish_op{};
+
+  const xnn_status create_status = xnn_create_hardswish_nc_f32(
+      1,                // channels
+      1,                // input stride
+      1,                // output stride
+      0,                // flags
+      &hardswish_op);   // operator
+
+  Operator hardswish_scoped_op(hardswish_op);
+
+  TORCH_CHECK(
+      xnn_status_success == create_status,
+      "xnn_create_hardswish_nc_f32 failed!");
+
+  const xnn_status setup_status = xnn_setup_hardswish_nc_f32(
+      hardswish_op,               // operator
+      input.numel(),              // batch_size
+      input.data_ptr<float>(),    // input
+      output.data_ptr<float>(),   // output
+      caffe2::pthreadpool_());    // threadpool
+
+  TORCH_CHECK(
+      xnn_status_success == setup_status,
+      "xnn_setup_hardswish_nc_f32 failed!");
+
+  const xnn_status run_status = xnn_run_operator(
+      hardswish_op,             // operator
+      caffe2::pthreadpool_());  // threadpool
+
+  TORCH_INTERNAL_ASSERT(
+      xnn_status_success == run_status,
+      "xnn_run_operator failed!");
+}
+
+} // namespace
+
+bool use_hardswish(
+    const Tensor& input) {
+  return xnnpack::internal::available() &&
+      (1 <= input.ndimension()) &&
+      (c10::DeviceType::CPU == input.device().type()) &&
+      (kFloat == input.scalar_type()) &&
+      !input.requires_grad() &&
+      true;
+}
+
+Tensor hardswish(
+    const Tensor& input) {
+  using namespace internal;
+
+  const Tensor padded_input = allocate_padded_contiguous_if_needed(
+      input,
+      input.suggest_memory_format());
+
+  Tensor output = empty_with_tail_padding(
+      padded_input.sizes(),
+      padded_input.options().dtype(),
+      input.suggest_memory_format(),
+      padded_input.names());
+
+  hardswish_impl(padded_input, output);
+  return output;
+}
+
+Tensor& hardswish_(
+    Tensor& input) {
+  using namespace internal;
+
+  const Tensor padded_input = allocate_padded_contiguous_if_needed(
+      input,
+      input.suggest_memory_format());
+
+  // The operator can run in place when the input is already dense and padded.
+  if (input.data_ptr() == padded_input.data_ptr()) {
+    hardswish_impl(input, input);
+    return input;
+  }
+
+  Tensor output = empty_with_tail_padding(
+      padded_input.sizes(),
+      padded_input.options().dtype(),
+      input.suggest_memory_format(),
+      padded_input.names());
+
+  hardswish_impl(padded_input, output);
+  return input.copy_(output);
+}
+
+} // namespace xnnpack
+} // namespace native
+} // namespace at
+
+#endif /* USE_XNNPACK */
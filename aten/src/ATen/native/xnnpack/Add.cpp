@@ -0,0 +1,102 @@
+#ifdef USE_XNNPACK
+
+#include <ATen/native/xnnpack/Common.h>
+#include <ATen/native/xnnpack/Engine.h>
+#include <ATen/native/xnnpack/Factory.h>
+
+namespace at {
+namespace native {
+namespace xnnpack {
+
+// Supports NHWC and NCHW FP32 addition of two tensors of the same shape.
+// Broadcasting is left to TensorIterator, as are non-unit alphas.
+
+bool use_add(
+    const Tensor& self,
+    const Tensor& other,
+    const Scalar alpha) {
+  return xnnpack::internal::available() &&
+      // Self
+      (1 <= self.ndimension()) &&
+      (c10::DeviceType::CPU == self.device().type()) &&
+      (kFloat == self.scalar_type()) &&
+      !self.requires_grad() &&
+      // Other
+      (c10::DeviceType::CPU == other.device().type()) &&
+      (kFloat == other.scalar_type()) &&
+      !other.requires_grad() &&
+      (self.sizes() == other.sizes()) &&
+      // Alpha
+      (1.0 == alpha.to<double>()) &&
+      true;
+}
+
+Tensor add(
+    const Tensor& self,
+    const Tensor& other) {
+  using namespace internal;
+
+  // Both operands are laid out in the memory format of self, which is then
+  // also that of the output, so that the operator sees three flat arrays.
+  const MemoryFormat memory_format = self.suggest_memory_format();
+
+  const Tensor self_padded = allocate_padded_contiguous_if_needed(
+      self,
+      memory_format);
+  const Tensor other_padded = allocate_padded_contiguous_if_needed(
+      other,
+      memory_format);
+
+  Tensor output = empty_with_tail_padding(
+      self_padded.sizes(),
+      self_padded.options().dtype(),
+      memory_format,
+      self_padded.names());
+
+  xnn_operator_t add_op{};
+
+  const xnn_status create_status = xnn_create_add_nd_f32(
+      -std::numeric_limits<float>::infinity(),  // output_min
+      +std::numeric_limits<float>::infinity(),  // output_max
+      0u,                                       // flags
+      &add_op);                                 // operator
+
+  Operator add_scoped_op(add_op);
+
+  TORCH_CHECK(
+      xnn_status_success == create_status,
+      "xnn_create_add_nd_f32 failed!");
+
+  const size_t shape[] = {static_cast<size_t>(self_padded.numel())};
+
+  const xnn_status setup_status = xnn_setup_add_nd_f32(
+      add_op,                           // operator
+      1u,                               // num_input1_dims
+      shape,                            // input1_shape
+      1u,                               // num_input2_dims
+      shape,                            // input2_shape
+      self_padded.data_ptr<float>(),    // input1
+      other_padded.data_ptr<float>(),   // input2
+      output.data_ptr<float>(),         // output
+      caffe2::pthreadpool_());          // threadpool
+
+  TORCH_CHECK(
+      xnn_status_success == setup_status,
+      "xnn_setup_add_nd_f32 failed!");
+
+  const xnn_status run_status = xnn_run_operator(
+      add_op,                   // operator
+      caffe2::pthreadpool_());  // threadpool
+
+  TORCH_INTERNAL_ASSERT(
+      xnn_status_success == run_status,
+      "xnn_run_operator failed!");
+
+  return output;
+}
+
+} // namespace xnnpack
+} // namespace native
+} // namespace at
+
+#endif /* USE_XNNPACK */
@@ -0,0 +1,297 @@
+#ifdef USE_XNNPACK
+
+#include <ATen/native/Pool.h>
+#include <ATen/native/xnnpack/Common.h>
+#include <ATen/native/xnnpack/Engine.h>
+#include <ATen/native/xnnpack/Factory.h>
+#include <ATen/native/xnnpack/Pooling.h>
+
+namespace at {
+namespace native {
+namespace xnnpack {
+
+// Supports NHWC and NCHW FP32 average pooling with any
+//  - kernel size
+//  - padding, which is excluded from the averages as XNNPACK does
+//  - stride
+
+bool use_avg_pool2d(
+    const Tensor& input,
+    const IntArrayRef kernel_,
+    const IntArrayRef padding_,
+    IntArrayRef stride_,
+    const bool ceil_mode,
+    const bool count_include_pad,
+    const c10::optional<int64_t> divisor_override) {
+  using namespace internal;
+
+  // Make sure we are not dealing with an unorthodox configuration.
+  if (kernel_.empty() || padding_.empty()) {
+    return false;
+  }
+
+  // Stride can be legitimately empty, in which case it is to be defaulted to kernel size.
+  if (stride_.empty()) {
+    stride_ = kernel_;
+  }
+
+  if ((4 != input.dim()) || (2 < kernel_.size()) ||
+      (2 < padding_.size()) || (2 < stride_.size())) {
+    return false;
+  }
+
+  // Normalize the parameters.
+  const internal::pooling::Parameters parameters{
+    kernel_,
+    padding_,
+    stride_,
+    {1},
+  };
+
+  // Here are the list of conditions required for this code path to be taken:
+  // * Input must be 4D CPU float tensor with no gradients.
+  // * Kernel must contain two positive numbers, which are not both 1 as
+  //   XNNPACK prohibits 1x1 kernels.
+  // * Padding must contain two non-negative numbers, at most half the kernel
+  //   size, past which the ATen implementation raises an error.
+  // * Padding is excluded from the averages in XNNPACK, so either it is zero
+  //   or count_include_pad is disabled.
+  // * Stride must contain two positive numbers.
+  // * The divisor cannot be overridden.
+  // * Ceil mode is only supported if it yields the shape floor mode does.
+  // * The output must have a valid shape.
+  const auto output_size = [&](const size_t dim, const size_t parameter, const bool ceil) {
+    return pooling_output_shape(
+        input.size(dim),
+        parameters.kernel[parameter],
+        parameters.padding[parameter],
+        parameters.stride[parameter],
+        parameters.dilation[parameter],
+        ceil);
+  };
+
+  if ((parameters.kernel[Layout::Parameter::height] <= 0) ||
+      (parameters.kernel[Layout::Parameter::width] <= 0) ||
+      (parameters.stride[Layout::Parameter::height] <= 0) ||
+      (parameters.stride[Layout::Parameter::width] <= 0)) {
+    return false;
+  }
+
+  const bool has_padding = (parameters.padding[Layout::Parameter::height] > 0) ||
+      (parameters.padding[Layout::Parameter::width] > 0);
+
+  return xnnpack::internal::available() &&
+      // Input
+      (c10::DeviceType::CPU == input.device().type()) &&
+      (kFloat == input.scalar_type()) &&
+      !input.requires_grad() &&
+      (input.size(Layout::Activation4D::channels) > 0) &&
+      // Kernel
+      ((parameters.kernel[Layout::Parameter::height] *
+        parameters.kernel[Layout::Parameter::width]) > 1) &&
+      // Padding
+      (parameters.padding[Layout::Parameter::height] >= 0) &&
+      (parameters.padding[Layout::Parameter::width] >= 0) &&
+      (parameters.padding[Layout::Parameter::height] <=
+        parameters.kernel[Layout::Parameter::height] / 2) &&
+      (parameters.padding[Layout::Parameter::width] <=
+        parameters.kernel[Layout::Parameter::width] / 2) &&
+      (!has_padding || !count_include_pad) &&
+      // Divisor
+      !divisor_override &&
+      // Ceil Mode
+      (!ceil_mode ||
+        ((output_size(Layout::Activation4D::height, Layout::Parameter::height, true) ==
+          output_size(Layout::Activation4D::height, Layout::Parameter::height, false)) &&
+         (output_size(Layout::Activation4D::width, Layout::Parameter::width, true) ==
+          output_size(Layout::Activation4D::width, Layout::Parameter::width, false)))) &&
+      // Output
+      (output_size(Layout::Activation4D::height, Layout::Parameter::height, false) > 0) &&
+      (output_size(Layout::Activation4D::width, Layout::Parameter::width, false) > 0) &&
+      true;
+}
+
+Tensor avg_pool2d(
+    const Tensor& input,
+    const IntArrayRef kernel_,
+    const IntArrayRef padding_,
+    IntArrayRef stride_,
+    const bool ceil_mode) {
+  using namespace internal;
+
+  // A call to avg_pool2d must have been gated by a call to use_avg_pool2d, so
+  // the parameters are guaranteed to be valid at this point, and ceil mode to
+  // have no effect on the shape of the output.
+
+  if (stride_.empty()) {
+    stride_ = kernel_;
+  }
+
+  const internal::pooling::Parameters parameters{
+    kernel_,
+    padding_,
+    stride_,
+    {1},
+  };
+
+  const Tensor input_padded_contig_nhwc = allocate_padded_contiguous_if_needed(
+      input,
+      MemoryFormat::ChannelsLast);
+
+  Tensor output_padded_contig_nhwc = empty_with_tail_padding(
+      {
+        input_padded_contig_nhwc.size(Layout::Activation4D::batch),
+        input_padded_contig_nhwc.size(Layout::Activation4D::channels),
+        pooling_output_shape(
+            input_padded_contig_nhwc.size(Layout::Activation4D::height),
+            parameters.kernel[Layout::Parameter::height],
+            parameters.padding[Layout::Parameter::height],
+            parameters.stride[Layout::Parameter::height],
+            parameters.dilation[Layout::Parameter::height],
+            false),
+        pooling_output_shape(
+            input_padded_contig_nhwc.size(Layout::Activation4D::width),
+            parameters.kernel[Layout::Parameter::width],
+            parameters.padding[Layout::Parameter::width],
+            parameters.stride[Layout::Parameter::width],
+            parameters.dilation[Layout::Parameter::width],
+            false),
+      },
+      input_padded_contig_nhwc.options().dtype(),
+      MemoryFormat::ChannelsLast,
+      input_padded_contig_nhwc.names());
+
+  xnn_operator_t avg_pool_op{};
+
+  const xnn_status create_status = xnn_create_average_pooling2d_nhwc_f32(
+      parameters.padding[Layout::Parameter::height],                  // input_padding_top
+      parameters.padding[Layout::Parameter::width],                   // input_padding_right
+      parameters.padding[Layout::Parameter::height],                  // input_padding_bottom
+      parameters.padding[Layout::Parameter::width],                   // input_padding_left
+      parameters.kernel[Layout::Parameter::height],                   // pooling_height
+      parameters.kernel[Layout::Parameter::width],                    // pooling_width
+      parameters.stride[Layout::Parameter::height],                   // stride_height
+      parameters.stride[Layout::Parameter::width],                    // stride_width
+      input_padded_contig_nhwc.size(Layout::Activation4D::channels),  // channels
+      input_padded_contig_nhwc.size(Layout::Activation4D::channels),  // input_pixel_stride - NHWC Contiguous
+      output_padded_contig_nhwc.size(Layout::Activation4D::channels), // output_pixel_stride - NHWC Contiguous
+      -std::numeric_limits<float>::infinity(),                        // output_min
+      +std::numeric_limits<float>::infinity(),                        // output_max
+      0u,                                                             // flags
+      &avg_pool_op);                                                  // operator
+
+  Operator avg_pool_scoped_op(avg_pool_op);
+
+  TORCH_CHECK(
+      xnn_status_success == create_status,
+      "xnn_create_average_pooling2d_nhwc_f32 failed!");
+
+  const xnn_status setup_status = xnn_setup_average_pooling2d_nhwc_f32(
+      avg_pool_op,                                                  // operator
+      input_padded_contig_nhwc.size(Layout::Activation4D::batch),   // batch_size
+      input_padded_contig_nhwc.size(Layout::Activation4D::height),  // input_height
+      input_padded_contig_nhwc.size(Layout::Activation4D::width),   // input_width
+      input_padded_contig_nhwc.data_ptr<float>(),                   // input
+      output_padded_contig_nhwc.data_ptr<float>(),                  // output
+      caffe2::pthreadpool_());                                      // threadpool
+
+  TORCH_CHECK(
+      xnn_status_success == setup_status,
+      "xnn_setup_average_pooling2d_nhwc_f32 failed!");
+
+  const xnn_status run_status = xnn_run_operator(
+      avg_pool_op,              // operator
+      caffe2::pthreadpool_());  // threadpool
+
+  TORCH_INTERNAL_ASSERT(
+      xnn_status_success == run_status,
+      "xnn_run_operator failed!");
+
+  return output_padded_contig_nhwc.contiguous(input.suggest_memory_format());
+}
+
+// Global average pooling, i.e. adaptive average pooling to 1x1, of 4D FP32
+// inputs, which XNNPACK computes as an NWC reduction over the H * W pixels.
+
+bool use_global_average_pool(
+    const Tensor& input) {
+  using namespace internal;
+
+  return xnnpack::internal::available() &&
+      (4 == input.dim()) &&
+      (c10::DeviceType::CPU == input.device().type()) &&
+      (kFloat == input.scalar_type()) &&
+      !input.requires_grad() &&
+      (input.size(Layout::Activation4D::batch) >= 0) &&
+      (input.size(Layout::Activation4D::channels) > 0) &&
+      (input.size(Layout::Activation4D::height) > 0) &&
+      (input.size(Layout::Activation4D::width) > 0) &&
+      true;
+}
+
+Tensor global_average_pool(
+    const Tensor& input) {
+  using namespace internal;
+
+  const Tensor input_padded_contig_nhwc = allocate_padded_contiguous_if_needed(
+      input,
+      MemoryFormat::ChannelsLast);
+
+  Tensor output = empty_with_tail_padding(
+      {
+        input_padded_contig_nhwc.size(Layout::Activation4D::batch),
+        input_padded_contig_nhwc.size(Layout::Activation4D::channels),
+        1,
+        1,
+      },
+      input_padded_contig_nhwc.options().dtype(),
+      MemoryFormat::ChannelsLast,
+      input_padded_contig_nhwc.names());
+
+  xnn_operator_t global_average_pooling_op{};
+
+  const xnn_status create_status = xnn_create_global_average_pooling_nwc_f32(
+      input_padded_contig_nhwc.size(Layout::Activation4D::channels),  // channels
+      input_padded_contig_nhwc.size(Layout::Activation4D::channels),  // input stride
+      input_padded_contig_nhwc.size(Layout::Activation4D::channels),  // output stride
+      -std::numeric_limits<float>::infinity(),                        // output_min
+      +std::numeric_limits<float>::infinity(),                        // output_max
+      0u,                                                             // flags
+      &global_average_pooling_op);                                    // operator
+
+  Operator global_average_pooling_scoped_op(global_average_pooling_op);
+
+  TORCH_CHECK(
+      xnn_status_success == create_status,
+      "xnn_create_global_average_pooling_nwc_f32 failed!");
+
+  const xnn_status setup_status = xnn_setup_global_average_pooling_nwc_f32(
+      global_average_pooling_op,                                   // operator
+      input_padded_contig_nhwc.size(Layout::Activation4D::batch),  // batch_size
+      input_padded_contig_nhwc.size(Layout::Activation4D::height) *
+          input_padded_contig_nhwc.size(Layout::Activation4D::width), // width
+      input_padded_contig_nhwc.data_ptr<float>(),                  // input
+      output.data_ptr<float>(),                                    // output
+      caffe2::pthreadpool_());                                     // threadpool
+
+  TORCH_CHECK(
+      xnn_status_success == setup_status,
+      "xnn_setup_global_average_pooling_nwc_f32 failed!");
+
+  const xnn_status run_status = xnn_run_operator(
+      global_average_pooling_op,  // operator
+      caffe2::pthreadpool_());    // threadpool
+
+  TORCH_INTERNAL_ASSERT(
+      xnn_status_success == run_status,
+      "xnn_run_operator failed!");
+
+  // A 1x1 output has the same layout in both memory formats.
+  return output.contiguous(input.suggest_memory_format());
+}
+
+} // namespace xnnpack
+} // namespace native
+} // namespace at
+
+#endif /* USE_XNNPACK */
@@ -295,6 +295,189 @@ Tensor convolution2d(
       ContextConv2D::kMax);
 }
 
+// Supports NHWC and NCHW FP32 transposed convolutions, depthwise included,
+// with any valid kernel size, padding, stride, dilation and grouping, and an
+// output padding smaller than the stride.
+
+bool use_conv_transpose2d(
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& bias,
+    const IntArrayRef padding_,
+    const IntArrayRef output_padding_,
+    const IntArrayRef stride_,
+    const IntArrayRef dilation_,
+    const int64_t groups) {
+  using namespace internal;
+
+  if ((4 != weight.ndimension()) || (4 != input.ndimension()) || (groups <= 0)) {
+    return false;
+  }
+
+  const auto padding = expand_param_if_needed(padding_, "padding", 2);
+  const auto output_padding = expand_param_if_needed(output_padding_, "output_padding", 2);
+  const auto stride = expand_param_if_needed(stride_, "stride", 2);
+  const auto dilation = expand_param_if_needed(dilation_, "dilation", 2);
+
+  // The weight of a transposed convolution is laid out as (input channels,
+  // output channels / groups, height, width).
+  const auto output_size = [&](const size_t dim, const size_t parameter) {
+    return (input.size(dim) - 1) * stride[parameter] -
+        2 * padding[parameter] +
+        dilation[parameter] * (weight.size(dim) - 1) +
+        output_padding[parameter] + 1;
+  };
+
+  return internal::convolution2d::usable(input) &&
+         // XNNPACK
+         xnnpack::internal::available() &&
+         // Weight
+         (weight.size(Layout::Filter::height) > 0) &&
+         (weight.size(Layout::Filter::width) > 0) &&
+         (c10::DeviceType::CPU == weight.device().type()) &&
+         (kFloat == weight.scalar_type()) &&
+         (weight.size(0) == input.size(Layout::Activation4D::channels)) &&
+         ((weight.size(0) % groups) == 0) &&
+         (weight.size(1) > 0) &&
+         // Bias
+         (bias.defined() ? ((1 == bias.ndimension()) &&
+                            (c10::DeviceType::CPU == bias.device().type()) &&
+                            (kFloat == bias.scalar_type()) &&
+                            ((weight.size(1) * groups) == bias.size(0)))
+                         : true) &&
+         // Padding
+         (padding[Layout::Parameter::height] >= 0) &&
+         (padding[Layout::Parameter::width] >= 0) &&
+         // Stride
+         (stride[Layout::Parameter::height] > 0) &&
+         (stride[Layout::Parameter::width] > 0) &&
+         // Dilation
+         (dilation[Layout::Parameter::height] > 0) &&
+         (dilation[Layout::Parameter::width] > 0) &&
+         // Output Padding - XNNPACK adjustments must be smaller than the stride.
+         (output_padding[Layout::Parameter::height] >= 0) &&
+         (output_padding[Layout::Parameter::width] >= 0) &&
+         (output_padding[Layout::Parameter::height] < stride[Layout::Parameter::height]) &&
+         (output_padding[Layout::Parameter::width] < stride[Layout::Parameter::width]) &&
+         // Output
+         (output_size(Layout::Activation4D::height, Layout::Parameter::height) > 0) &&
+         (output_size(Layout::Activation4D::width, Layout::Parameter::width) > 0) &&
+         true;
+}
+
+Tensor conv_transpose2d(
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& bias,
+    const IntArrayRef padding_,
+    const IntArrayRef output_padding_,
+    const IntArrayRef stride_,
+    const IntArrayRef dilation_,
+    const int64_t groups) {
+  using namespace internal;
+
+  const auto padding = expand_param_if_needed(padding_, "padding", 2);
+  const auto output_padding = expand_param_if_needed(output_padding_, "output_padding", 2);
+  const auto stride = expand_param_if_needed(stride_, "stride", 2);
+  const auto dilation = expand_param_if_needed(dilation_, "dilation", 2);
+
+  const int64_t group_input_channels = weight.size(0) / groups;
+  const int64_t group_output_channels = weight.size(1);
+  const int64_t kernel_height = weight.size(Layout::Filter::height);
+  const int64_t kernel_width = weight.size(Layout::Filter::width);
+
+  // XNNPACK expects (groups, output channels / groups, height, width, input
+  // channels / groups) kernels.
+  const Tensor weight_reordered = weight.reshape({
+      groups,
+      group_input_channels,
+      group_output_channels,
+      kernel_height,
+      kernel_width,
+  }).permute({0, 2, 3, 4, 1}).contiguous();
+  const Tensor bias_contig = bias.defined() ? bias.contiguous() : bias;
+
+  const Tensor padded_input_nhwc = allocate_padded_contiguous_if_needed(
+      input, MemoryFormat::ChannelsLast);
+
+  Tensor output = empty_with_tail_padding(
+      {
+        padded_input_nhwc.size(Layout::Activation4D::batch),
+        group_output_channels * groups,
+        (padded_input_nhwc.size(Layout::Activation4D::height) - 1) *
+            stride[Layout::Parameter::height] -
+            2 * padding[Layout::Parameter::height] +
+            dilation[Layout::Parameter::height] * (kernel_height - 1) +
+            output_padding[Layout::Parameter::height] + 1,
+        (padded_input_nhwc.size(Layout::Activation4D::width) - 1) *
+            stride[Layout::Parameter::width] -
+            2 * padding[Layout::Parameter::width] +
+            dilation[Layout::Parameter::width] * (kernel_width - 1) +
+            output_padding[Layout::Parameter::width] + 1,
+      },
+      padded_input_nhwc.options().dtype(),
+      MemoryFormat::ChannelsLast,
+      padded_input_nhwc.names());
+
+  xnn_operator_t deconvolution_op{};
+
+  const xnn_status create_status = xnn_create_deconvolution2d_nhwc_f32(
+      padding[Layout::Parameter::height],                     // output_padding_top
+      padding[Layout::Parameter::width],                      // output_padding_right
+      padding[Layout::Parameter::height],                     // output_padding_bottom
+      padding[Layout::Parameter::width],                      // output_padding_left
+      kernel_height,                                          // kernel_height
+      kernel_width,                                           // kernel_width
+      stride[Layout::Parameter::height],                      // stride_height
+      stride[Layout::Parameter::width],                       // stride_width
+      dilation[Layout::Parameter::height],                    // dilation_height
+      dilation[Layout::Parameter::width],                     // dilation_width
+      groups,                                                 // groups
+      group_input_channels,                                   // group_input_channels
+      group_output_channels,                                  // group_output_channels
+      group_input_channels * groups,                          // input_pixel_stride
+      group_output_channels * groups,                         // output_pixel_stride
+      weight_reordered.data_ptr<float>(),                     // kernel
+      bias_contig.defined()
+          ? bias_contig.data_ptr<float>()
+          : nullptr,                                          // bias
+      ContextConv2D::kMin,                                    // output_min
+      ContextConv2D::kMax,                                    // output_max
+      0u,                                                     // flags
+      &deconvolution_op);                                     // operator
+
+  Operator deconvolution_scoped_op(deconvolution_op);
+
+  TORCH_CHECK(
+      xnn_status_success == create_status,
+      "xnn_create_deconvolution2d_nhwc_f32 failed!");
+
+  const xnn_status setup_status = xnn_setup_deconvolution2d_nhwc_f32(
+      deconvolution_op,                                      // operator
+      padded_input_nhwc.size(Layout::Activation4D::batch),   // batch_size
+      padded_input_nhwc.size(Layout::Activation4D::height),  // input_height
+      padded_input_nhwc.size(Layout::Activation4D::width),   // input_width
+      output_padding[Layout::Parameter::height],             // adjustment_height
+      output_padding[Layout::Parameter::width],              // adjustment_width
+      padded_input_nhwc.data_ptr<float>(),                   // input
+      output.data_ptr<float>(),                              // output
+      caffe2::pthreadpool_());                               // threadpool
+
+  TORCH_CHECK(
+      xnn_status_success == setup_status,
+      "xnn_setup_deconvolution2d_nhwc_f32 failed!");
+
+  const xnn_status run_status = xnn_run_operator(
+      deconvolution_op,         // operator
+      caffe2::pthreadpool_());  // threadpool
+
+  TORCH_INTERNAL_ASSERT(
+      xnn_status_success == run_status,
+      "xnn_run_operator failed!");
+
+  return output.contiguous(input.suggest_memory_format());
+}
+
 } // namespace xnnpack
 
 } // namespace native
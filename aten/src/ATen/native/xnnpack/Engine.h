@@ -28,6 +28,26 @@ Tensor convolution2d(
     const IntArrayRef dilation,
     const int64_t groups);
 
+bool use_conv_transpose2d(
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& bias,
+    const IntArrayRef padding,
+    const IntArrayRef output_padding,
+    const IntArrayRef stride,
+    const IntArrayRef dilation,
+    const int64_t groups);
+
+Tensor conv_transpose2d(
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& bias,
+    const IntArrayRef padding,
+    const IntArrayRef output_padding,
+    const IntArrayRef stride,
+    const IntArrayRef dilation,
+    const int64_t groups);
+
 //
 // Linear
 //
@@ -66,6 +86,70 @@ Tensor max_pool2d(
     float output_min = -std::numeric_limits<float>::infinity(),
     float output_max = +std::numeric_limits<float>::infinity());
 
+//
+// Average Pooling
+//
+
+bool use_avg_pool2d(
+    const Tensor& input,
+    IntArrayRef kernel,
+    IntArrayRef padding,
+    IntArrayRef stride,
+    bool ceil_mode,
+    bool count_include_pad,
+    c10::optional<int64_t> divisor_override);
+
+Tensor avg_pool2d(
+    const Tensor& input,
+    IntArrayRef kernel,
+    IntArrayRef padding,
+    IntArrayRef stride,
+    bool ceil_mode);
+
+bool use_global_average_pool(
+    const Tensor& input);
+
+Tensor global_average_pool(
+    const Tensor& input);
+
+//
+// Activations
+//
+
+bool use_hardswish(
+    const Tensor& input);
+
+Tensor hardswish(
+    const Tensor& input);
+
+Tensor& hardswish_(
+    Tensor& input);
+
+//
+// Binary Ops
+//
+
+bool use_add(
+    const Tensor& self,
+    const Tensor& other,
+    Scalar alpha);
+
+Tensor add(
+    const Tensor& self,
+    const Tensor& other);
+
+//
+// Channel Shuffle
+//
+
+bool use_channel_shuffle(
+    const Tensor& input,
+    const int64_t groups);
+
+Tensor channel_shuffle(
+    const Tensor& input,
+    const int64_t groups);
+
 } // namespace xnnpack
 } // namespace native
 } // namespace at
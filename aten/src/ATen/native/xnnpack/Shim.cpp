@@ -50,6 +50,30 @@ Tensor convolution2d(
   TORCH_CHECK(false, internal::kError);
 }
 
+bool use_conv_transpose2d(
+    const Tensor&,
+    const Tensor&,
+    const Tensor&,
+    const IntArrayRef,
+    const IntArrayRef,
+    const IntArrayRef,
+    const IntArrayRef,
+    const int64_t) {
+  return false;
+}
+
+Tensor conv_transpose2d(
+    const Tensor&,
+    const Tensor&,
+    const Tensor&,
+    const IntArrayRef,
+    const IntArrayRef,
+    const IntArrayRef,
+    const IntArrayRef,
+    const int64_t) {
+  TORCH_CHECK(false, internal::kError);
+}
+
 bool use_linear(
     const Tensor&,
     const Tensor&,
@@ -88,6 +112,76 @@ Tensor max_pool2d(
   TORCH_CHECK(false, internal::kError);
 }
 
+bool use_avg_pool2d(
+    const Tensor&,
+    const IntArrayRef,
+    const IntArrayRef,
+    const IntArrayRef,
+    const bool,
+    const bool,
+    const c10::optional<int64_t>) {
+  return false;
+}
+
+Tensor avg_pool2d(
+    const Tensor&,
+    const IntArrayRef,
+    const IntArrayRef,
+    const IntArrayRef,
+    const bool) {
+  TORCH_CHECK(false, internal::kError);
+}
+
+bool use_global_average_pool(
+    const Tensor&) {
+  return false;
+}
+
+Tensor global_average_pool(
+    const Tensor&) {
+  TORCH_CHECK(false, internal::kError);
+}
+
+bool use_hardswish(
+    const Tensor&) {
+  return false;
+}
+
+Tensor hardswish(
+    const Tensor&) {
+  TORCH_CHECK(false, internal::kError);
+}
+
+Tensor& hardswish_(
+    Tensor&) {
+  TORCH_CHECK(false, internal::kError);
+}
+
+bool use_add(
+    const Tensor&,
+    const Tensor&,
+    const Scalar) {
+  return false;
+}
+
+Tensor add(
+    const Tensor&,
+    const Tensor&) {
+  TORCH_CHECK(false, internal::kError);
+}
+
+bool use_channel_shuffle(
+    const Tensor&,
+    const int64_t) {
+  return false;
+}
+
+Tensor channel_shuffle(
+    const Tensor&,
+    const int64_t) {
+  TORCH_CHECK(false, internal::kError);
+}
+
 } // namespace xnnpack
 
 } // namespace native
@@ -60,8 +60,10 @@ QuantizerPtr make_per_channel_affine_quantizer(
                                                                       axis);
   }
   else {
-    Tensor scales_double = scales.to(kDouble).contiguous();
-    Tensor zero_points_int64 = zero_points.to(kLong).contiguous();
+    // The quantization parameters stay on the host, where they are checked;
+    // the kernels of other devices copy them over.
+    Tensor scales_double = scales.to(kCPU, kDouble).contiguous();
+    Tensor zero_points_int64 = zero_points.to(kCPU, kLong).contiguous();
     return c10::make_intrusive<PerChannelAffineQuantizer>(scalar_type,
                                                           scales_double,
                                                           zero_points_int64,
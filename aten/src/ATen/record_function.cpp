@@ -1,6 +1,7 @@
 #include <ATen/record_function.h>
 #include <algorithm>
 #include <cstdlib>
+#include <limits>
 #include <random>
 
 namespace at {
@@ -24,6 +25,61 @@ thread_local RecordFunctionCallbacks sorted_tls_callbacks_;
 
 std::atomic<int64_t> defaultNodeId(-1);
 
+// Note [Pre-sampling]
+// ~~~~~~~~~~~~~~~~~~~
+// Sampled callbacks (samplingProb/samplingEvery) run on a subset of the
+// RecordFunctions of each thread. Rather than flipping a coin for every
+// sampled callback in every RecordFunction, every thread counts its
+// RecordFunctions and keeps, for each sampled callback, the index of the
+// next one the callback runs on: drawn from a geometric distribution for
+// a sampling probability, every n-th one for samplingEvery(n). When all the
+// callbacks are sampled, the RecordFunctions before the earliest of these
+// indices don't look at the callbacks at all: their cost is a thread local
+// increment and comparison, which is what makes always-on sampled observers
+// affordable. Callbacks that aren't sampled are checked on every
+// RecordFunction, as before.
+//
+// A callback picked for a RecordFunction of a scope it doesn't observe stays
+// due until the next RecordFunction of a scope it does observe. The sampling
+// state is reset for every thread when the callbacks change, which bumps
+// callbacks_version_.
+
+std::atomic<uint64_t> callbacks_version_ {1};
+
+inline void bump_callbacks_version() {
+  callbacks_version_.fetch_add(1, std::memory_order_relaxed);
+}
+
+struct SamplingState {
+  // Number of RecordFunctions created by this thread with callbacks enabled
+  uint64_t calls = 0;
+  // The RecordFunctions before this index don't run any callback
+  uint64_t next_active_call = 0;
+  // callbacks_version_ next_calls and next_active_call are valid for
+  uint64_t version = 0;
+  // (sampled callback, index of the next RecordFunction it runs on)
+  c10::SmallVector<std::pair<CallbackHandle, uint64_t>, kSoftLimitCallbacks>
+      next_calls;
+};
+
+thread_local SamplingState sampling_state_;
+
+// Number of RecordFunctions until the next one the callback runs on,
+// counting the next one
+uint64_t sample_next_call_distance(const RecordFunctionCallback& cb) {
+  if (cb.samplingEvery() != 1) {
+    return cb.samplingEvery();
+  }
+  if (cb.samplingProb() == 0.0) {
+    return std::numeric_limits<uint64_t>::max() / 2;
+  }
+  static thread_local auto gen =
+      std::make_unique<std::mt19937>(std::random_device()());
+  // number of failures before the first success
+  std::geometric_distribution<uint64_t> dist(cb.samplingProb());
+  return dist(*gen) + 1;
+}
+
 class CallbackManager {
  public:
   CallbackHandle addThreadLocalCallback(RecordFunctionCallback cb) {
@@ -31,12 +87,14 @@ class CallbackManager {
     // sorted_tls_callbacks_ sorted
     auto handle = next_unique_callback_handle();
     sorted_tls_callbacks_.emplace_back(std::move(cb), handle);
+    bump_callbacks_version();
     return handle;
   }
 
   CallbackHandle addGlobalCallback(RecordFunctionCallback cb) {
     auto handle = next_unique_callback_handle();
     sorted_global_callbacks_.emplace_back(std::move(cb), handle);
+    bump_callbacks_version();
     return handle;
   }
 
@@ -64,14 +122,17 @@ class CallbackManager {
     if (!found) {
       LOG(WARNING) << "Requested callback is not found";
     }
+    bump_callbacks_version();
   }
 
   void clearGlobalCallbacks() {
     sorted_global_callbacks_.clear();
+    bump_callbacks_version();
   }
 
   void clearThreadLocalCallbacks() {
     sorted_tls_callbacks_.clear();
+    bump_callbacks_version();
   }
 
   inline bool hasGlobalCallbacks() const {
@@ -86,16 +147,44 @@ class CallbackManager {
   // determine which thread local and global callbacks are going
   // to be executed and whether any of them need inputs
   inline void init(RecordFunction& rec_fn) {
+    auto& sampling = sampling_state_;
+    auto call = sampling.calls++;
+    auto version = callbacks_version_.load(std::memory_order_relaxed);
+    if (C10_LIKELY(call < sampling.next_active_call && sampling.version == version)) {
+      // no sampled callback is due, see Note [Pre-sampling]
+      return;
+    }
+    if (sampling.version != version) {
+      resetSampling(sampling, version);
+    }
+
     auto scope = rec_fn.scope();
     bool found_active_cb = false;
     bool found_needs_inputs = false;
     bool found_needs_ids = false;
+    uint64_t next_active_call = std::numeric_limits<uint64_t>::max();
     auto init_handles = [
-        scope, &found_active_cb, &found_needs_inputs, &found_needs_ids](
+        scope, call, &sampling, &next_active_call,
+        &found_active_cb, &found_needs_inputs, &found_needs_ids](
           CallbackHandles& handles, RecordFunctionCallbacks& cbs) {
       handles.clear();
       for (const auto& cb : cbs) {
-        if (cb.first.shouldRun(scope)) {
+        bool run = false;
+        if (cb.first.isSampled()) {
+          auto& next_call = nextCall(sampling, cb, call);
+          if (call >= next_call) {
+            // due; if it doesn't observe this scope, it stays due
+            run = cb.first.shouldRun(scope);
+            if (run) {
+              next_call = call + sample_next_call_distance(cb.first);
+            }
+          }
+          next_active_call = std::min(next_active_call, std::max(next_call, call + 1));
+        } else {
+          run = cb.first.shouldRun(scope);
+          next_active_call = call + 1;
+        }
+        if (run) {
           handles.push_back(cb.second);
           found_active_cb = true;
           if (cb.first.needsInputs()) {
@@ -110,6 +199,7 @@ class CallbackManager {
 
     init_handles(rec_fn.sorted_active_tls_handles_, sorted_tls_callbacks_);
     init_handles(rec_fn.sorted_active_global_handles_, sorted_global_callbacks_);
+    sampling.next_active_call = next_active_call;
     rec_fn.active = found_active_cb;
     rec_fn.needs_inputs = found_needs_inputs;
     if (found_needs_ids && found_active_cb) {
@@ -145,6 +235,43 @@ class CallbackManager {
   }
 
  private:
+  // Drops the sampling state of the callbacks that were removed
+  void resetSampling(SamplingState& sampling, uint64_t version) {
+    auto exists = [this](CallbackHandle handle) {
+      auto has_handle = [handle](const RecordFunctionCallbacks& cbs) {
+        return std::any_of(cbs.begin(), cbs.end(),
+            [handle](const std::pair<RecordFunctionCallback, CallbackHandle>& el) {
+              return el.second == handle;
+            });
+      };
+      return has_handle(sorted_tls_callbacks_) || has_handle(sorted_global_callbacks_);
+    };
+    auto& next_calls = sampling.next_calls;
+    next_calls.erase(
+        std::remove_if(next_calls.begin(), next_calls.end(),
+            [&exists](const std::pair<CallbackHandle, uint64_t>& el) {
+              return !exists(el.first);
+            }),
+        next_calls.end());
+    sampling.version = version;
+  }
+
+  // The index of the next RecordFunction the sampled callback runs on,
+  // drawn the first time the callback is seen by this thread
+  static uint64_t& nextCall(
+      SamplingState& sampling,
+      const std::pair<RecordFunctionCallback, CallbackHandle>& cb,
+      uint64_t call) {
+    for (auto& el : sampling.next_calls) {
+      if (el.first == cb.second) {
+        return el.second;
+      }
+    }
+    sampling.next_calls.emplace_back(
+        cb.second, call + sample_next_call_distance(cb.first) - 1);
+    return sampling.next_calls.back().second;
+  }
+
   bool tryRunCallback(
       const std::function<void(const RecordFunction&)>& fn,
       RecordFunction& rf) {
@@ -212,24 +339,6 @@ inline CallbackManager& manager() {
 
 thread_local bool tls_record_function_enabled_ = true;
 
-// Low probability constant
-const double kLowProb = 0.001;
-thread_local int tries_left_ = 0;
-
-int sample_geometric() {
-  static thread_local auto gen =
-      std::make_unique<std::mt19937>(std::random_device()());
-  std::geometric_distribution<int> dist(kLowProb);
-  return dist(*gen);
-}
-
-double sample_zero_one() {
-  static thread_local auto gen =
-      std::make_unique<std::mt19937>(std::random_device()());
-  std::uniform_real_distribution<double> dist(0.0, 1.0);
-  return dist(*gen);
-}
-
 } // namespace
 
 bool RecordFunctionCallback::shouldRun(RecordScope scope) const {
@@ -242,25 +351,6 @@ bool RecordFunctionCallback::shouldRun(RecordScope scope) const {
   if (should_run_) {
     return should_run_(*this);
   }
-  // otherwise potentially do the uniform sampling
-  if (sampling_prob_ != 1.0) {
-    // model the low probability events as events happening
-    // with prob. kLowProb followed by another sampling with
-    // prob. (sampling_prob_ / kLowProb), then replace the coin
-    // flip for kLowProb with a thread local number of tries tries_left_
-    // sampled from the geometric distribution
-    if (sampling_prob_ < kLowProb) {
-      if (tries_left_ == 0) {
-        tries_left_ = sample_geometric();
-        return (sample_zero_one() < sampling_prob_ / kLowProb);
-      } else {
-        --tries_left_;
-        return false;
-      }
-    } else {
-      return (sample_zero_one() < sampling_prob_);
-    }
-  }
   return true;
 }
 
@@ -269,6 +359,18 @@ RecordFunctionCallbacks _getTLSCallbacks() {
 }
 
 void _setTLSCallbacks(const RecordFunctionCallbacks& callbacks) {
+  // ThreadLocalStateGuard sets the callbacks on every thread switch, only
+  // reset the sampling if they change
+  auto same_handles = callbacks.size() == sorted_tls_callbacks_.size() &&
+      std::is_permutation(
+          callbacks.begin(), callbacks.end(), sorted_tls_callbacks_.begin(),
+          [](const std::pair<RecordFunctionCallback, CallbackHandle>& l,
+              const std::pair<RecordFunctionCallback, CallbackHandle>& r) {
+            return l.second == r.second;
+          });
+  if (!same_handles) {
+    bump_callbacks_version();
+  }
   // keep the original handles
   sorted_tls_callbacks_ = callbacks;
   std::sort(
@@ -203,6 +203,9 @@ struct TORCH_API RecordFunction {
  *   sampling_probability - if not 1.0, then the callback is probabilistically sampled
  *     to run; NOTE: start and end callbacks always run as a pair and are sampled
  *     together;
+ *   sampling_every - if not 1, then the callback runs on one in every
+ *     sampling_every RecordFunctions of each thread; replaces sampling_probability
+ *     and the other way around;
  *   scopes - types of scopes to execute the callbacks on (see RecordScope);
  *     passing empty set means the callbacks will be executed for all possible
  *     scope types
@@ -231,9 +234,17 @@ class TORCH_API RecordFunctionCallback {
   }
 
   RecordFunctionCallback& samplingProb(double sampling_prob) {
-    TORCH_CHECK(sampling_prob >= 0.0 && sampling_prob_ <= 1.0,
+    TORCH_CHECK(sampling_prob >= 0.0 && sampling_prob <= 1.0,
         "Invalid sampling probability");
     sampling_prob_ = sampling_prob;
+    sampling_every_ = 1;
+    return *this;
+  }
+
+  RecordFunctionCallback& samplingEvery(uint64_t sampling_every) {
+    TORCH_CHECK(sampling_every >= 1, "Invalid sampling interval");
+    sampling_every_ = sampling_every;
+    sampling_prob_ = 1.0;
     return *this;
   }
 
@@ -268,6 +279,16 @@ class TORCH_API RecordFunctionCallback {
     return sampling_prob_;
   }
 
+  inline uint64_t samplingEvery() const {
+    return sampling_every_;
+  }
+
+  // whether the RecordFunctions the callbacks run on are sampled by
+  // the callback manager (see Note [Pre-sampling])
+  inline bool isSampled() const {
+    return !should_run_ && (sampling_prob_ != 1.0 || sampling_every_ != 1);
+  }
+
   inline bool checkScope(RecordScope sc) const {
     return scopes_[(size_t)sc];
   }
@@ -280,7 +301,8 @@ class TORCH_API RecordFunctionCallback {
     return end_;
   }
 
-  // whether the callbacks should run in the given scope
+  // whether the callbacks should run in the given scope; sampling is
+  // done separately, by the callback manager
   bool shouldRun(RecordScope scope) const;
 
  private:
@@ -290,6 +312,7 @@ class TORCH_API RecordFunctionCallback {
   bool needs_inputs_ = false;
   bool needs_ids_ = false;
   double sampling_prob_ = 1.0;
+  uint64_t sampling_every_ = 1;
   std::array<bool, static_cast<size_t>(RecordScope::NUM_SCOPES)> scopes_ = {};
 };
 
@@ -328,8 +351,11 @@ class TORCH_API RecordFunctionCallback {
 //       invoked by every RecordFunction, in addition to the thread local
 //       callbacks specific to the given thread
 //  - we allow the added callbacks to be sampled, by specifying a sampling
-//    probability for each callback pair, if the start callback is
-//    not picked to run, the corresponding end callback won't be called
+//    probability or interval for each callback pair, if the start callback is
+//    not picked to run, the corresponding end callback won't be called;
+//    when all the callbacks are sampled, the RecordFunctions none of them
+//    is picked for skip the callbacks at the cost of a thread local counter
+//    increment
 //  - a typical use case for the global callbacks is passive monitoring
 //    in the background (e.g. fleet-wide monitoring), without focusing on
 //    the specific peice of code
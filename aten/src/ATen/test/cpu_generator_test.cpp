@@ -41,6 +41,17 @@ TEST(CPUGeneratorImpl, TestCloning) {
   ASSERT_EQ(cpu_gen1->random(), cpu_gen2->random());
 }
 
+TEST(CPUGeneratorImpl, TestPhiloxMode) {
+  // Test Description:
+  // Check the Philox mode is off by default and survives cloning.
+  auto gen1 = at::detail::createCPUGenerator();
+  auto cpu_gen1 = check_generator<CPUGeneratorImpl>(gen1);
+  ASSERT_FALSE(cpu_gen1->philox_mode());
+  cpu_gen1->set_philox_mode(true);
+  auto gen2 = gen1.clone();
+  ASSERT_TRUE(check_generator<CPUGeneratorImpl>(gen2)->philox_mode());
+}
+
 void thread_func_get_engine_op(CPUGeneratorImpl* generator) {
   std::lock_guard<std::mutex> lock(generator->mutex_);
   generator->random();
@@ -152,3 +152,51 @@ TEST(TestVectorizedMemoryAccess, CopyKernel) {
     }
   }
 }
+
+TEST(TestVectorizedMemoryAccess, CanVectorizeUpTo8) {
+  char *ptr = reinterpret_cast<char *>(buffer1);
+
+  // 8 is only returned when asked for.
+  ASSERT_EQ((memory::can_vectorize_up_to<int16_t, 8>(ptr)), 8);
+  ASSERT_EQ((memory::can_vectorize_up_to<int8_t, 8>(ptr + 8)), 8);
+  ASSERT_EQ((memory::can_vectorize_up_to<int16_t, 8>(ptr + 8)), 4);
+  ASSERT_EQ((memory::can_vectorize_up_to<int16_t, 8>(ptr + 2)), 1);
+  ASSERT_EQ((memory::can_vectorize_up_to<int16_t>(ptr)), 4);
+}
+
+// Same as vectorized_copy, with 8 elements per thread.
+template <typename scalar_t>
+__global__ void vectorized_copy8(scalar_t *dst, scalar_t *src) {
+  using array_t = at::detail::Array<char*, 2>;
+  array_t data;
+  data[0] = reinterpret_cast<char *>(dst);
+  data[1] = reinterpret_cast<char *>(src);
+  int idx = blockIdx.x;
+  using vectorized = policies::vectorized<8, array_t, 8>;
+  auto policy = vectorized(data);
+  scalar_t buf[8];
+  auto accessor = [&](int index) -> scalar_t & { return buf[index]; };
+  policy.load_single_arg(accessor, src + vectorized::block_work_size * blockIdx.x);
+  policy.store(buf, idx);
+}
+
+TEST(TestVectorizedMemoryAccess, CopyKernel8) {
+  if (!at::cuda::is_available()) {
+    return;
+  }
+
+  int16_t *b1 = reinterpret_cast<int16_t *>(buffer1);
+  int16_t *b2 = reinterpret_cast<int16_t *>(buffer2);
+  constexpr int numel = sizeof(buffer1) / sizeof(int16_t);
+  for (int i = 0; i < numel; i++) {
+    b1[i] = i;
+    b2[i] = -1;
+  }
+  cudaDeviceSynchronize();
+  vectorized_copy8<int16_t><<<numel / (8 * num_threads), num_threads>>>(b2, b1);
+  cudaDeviceSynchronize();
+  ASSERT_EQ(cudaGetLastError(), cudaSuccess);
+  for (int i = 0; i < numel; i++) {
+    ASSERT_EQ(b1[i], b2[i]);
+  }
+}
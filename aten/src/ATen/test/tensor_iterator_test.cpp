@@ -210,3 +210,67 @@ TEST(TensorIteratorTest, FailNonPromotingBinaryOp) {
   config.add_input(at::ones({1,1}, at::dtype(at::kInt)));
   ASSERT_ANY_THROW(config.build());
 }
+
+TEST(TensorIteratorTest, PlanCacheReusesSetup) {
+  auto a = at::randn({8, 3, 5}).transpose(0, 2);
+  auto b = at::randn({5, 3, 1});
+  at::globalContext().setTensorIteratorPlanCache(true);
+  at::reset_tensor_iterator_plan_cache();
+  auto expected = at::add(a, b);
+  for (int i = 0; i < 3; i++) {
+    ASSERT_TRUE(at::add(a, b).equal(expected));
+  }
+  auto stats = at::get_tensor_iterator_plan_cache_stats();
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.hits, 3);
+
+  // An output that has to be resized can't be replayed.
+  for (int i = 0; i < 2; i++) {
+    auto out = at::empty({0});
+    at::add_out(out, a, b);
+    ASSERT_TRUE(out.equal(expected));
+  }
+  stats = at::get_tensor_iterator_plan_cache_stats();
+  EXPECT_EQ(stats.hits, 3);
+  EXPECT_EQ(stats.uncacheable, 1);
+
+  at::reset_tensor_iterator_plan_cache();
+  stats = at::get_tensor_iterator_plan_cache_stats();
+  EXPECT_EQ(stats.hits + stats.misses + stats.uncacheable, 0);
+  at::globalContext().setTensorIteratorPlanCache(false);
+}
+
+TEST(TensorIteratorTest, GrainSizeForCost) {
+  EXPECT_EQ(at::internal::grain_size_for_cost(1.0), at::internal::GRAIN_SIZE);
+  EXPECT_EQ(at::internal::grain_size_for_cost(0.0), at::internal::GRAIN_SIZE);
+  EXPECT_EQ(at::internal::grain_size_for_cost(0.5), 2 * at::internal::GRAIN_SIZE);
+  EXPECT_EQ(at::internal::grain_size_for_cost(1e9), 1);
+  EXPECT_LT(at::internal::grain_size_for_cost(50.0), at::internal::GRAIN_SIZE);
+}
+
+TEST(TensorIteratorTest, GrainSizeAutotune) {
+  auto input = at::rand({1 << 14}) + 1;
+  auto expected = at::digamma(input);
+  at::clear_tuned_grain_sizes();
+  at::globalContext().setGrainSizeAutotune(true);
+  for (int i = 0; i < 32; i++) {
+    ASSERT_TRUE(at::digamma(input).equal(expected));
+  }
+  at::globalContext().setGrainSizeAutotune(false);
+  if (at::get_num_threads() == 1) {
+    return;
+  }
+  bool found = false;
+  for (const auto& tuned : at::get_tuned_grain_sizes()) {
+    if (tuned.name == "digamma") {
+      found = true;
+      EXPECT_TRUE(tuned.dtype == at::kFloat);
+      EXPECT_EQ(tuned.log2_numel, 14);
+      EXPECT_GE(tuned.grain_size, 1);
+      EXPECT_LE(tuned.grain_size, 1 << 14);
+    }
+  }
+  EXPECT_TRUE(found);
+  at::clear_tuned_grain_sizes();
+  EXPECT_TRUE(at::get_tuned_grain_sizes().empty());
+}
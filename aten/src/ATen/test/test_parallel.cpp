@@ -69,3 +69,77 @@ TEST(TestParallel, IntraOpLaunchFuture) {
 
   ASSERT_TRUE(v1 == 1 && v2 == 2);
 }
+
+TEST(TestParallel, UnevenWorkload) {
+  // Every index must be visited exactly once however the range is split and
+  // whichever thread ends up running a chunk.
+  const int64_t numel = 10000;
+  std::vector<std::atomic<int>> visits(numel);
+  for (auto& v : visits) {
+    v = 0;
+  }
+  at::parallel_for(0, numel, 1, [&](int64_t begin, int64_t end) {
+    ASSERT_LT(at::get_thread_num(), at::get_num_threads());
+    for (int64_t i = begin; i < end; ++i) {
+      // make later indices more expensive
+      volatile int64_t sink = 0;
+      for (int64_t k = 0; k < i / 100; ++k) {
+        sink += k;
+      }
+      visits[i]++;
+    }
+  });
+  for (const auto& v : visits) {
+    ASSERT_EQ(v.load(), 1);
+  }
+
+  auto sum = at::parallel_reduce(
+      0, numel, 1, (int64_t)0,
+      [](int64_t begin, int64_t end, int64_t ident) {
+        int64_t partial = ident;
+        for (int64_t i = begin; i < end; ++i) {
+          partial += i;
+        }
+        return partial;
+      },
+      std::plus<int64_t>());
+  ASSERT_EQ(sum, numel * (numel - 1) / 2);
+}
+
+#if AT_PARALLEL_NATIVE
+TEST(TestParallel, NestedParallelism) {
+  at::set_nested_parallelism(true);
+  std::atomic<int64_t> total{0};
+  at::parallel_for(0, 4, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t outer = begin; outer < end; ++outer) {
+      int outer_thread_num = at::get_thread_num();
+      auto partial = at::parallel_reduce(
+          0, 100000, 100, (int64_t)0,
+          [](int64_t begin, int64_t end, int64_t ident) {
+            EXPECT_TRUE(at::in_parallel_region());
+            EXPECT_LT(at::get_thread_num(), at::get_num_threads());
+            int64_t partial = ident;
+            for (int64_t i = begin; i < end; ++i) {
+              partial += i;
+            }
+            return partial;
+          },
+          std::plus<int64_t>());
+      // the enclosing region is restored once the nested loop returns
+      EXPECT_EQ(at::get_thread_num(), outer_thread_num);
+      EXPECT_TRUE(at::in_parallel_region());
+      total += partial;
+    }
+  });
+  ASSERT_EQ(total.load(), 4 * (100000LL * 99999 / 2));
+
+  ASSERT_THROW(
+    at::parallel_for(0, 10, 1, [&](int64_t begin, int64_t end) {
+      at::parallel_for(0, 1000, 1, [&](int64_t begin, int64_t end) {
+        throw std::runtime_error("exception");
+      });
+    }),
+    std::runtime_error);
+  at::set_nested_parallelism(false);
+}
+#endif
@@ -723,3 +723,30 @@ TEST(VulkanTest, max_pool2d) {
   }
   ASSERT_TRUE(check);
 }
+
+TEST(VulkanTest, chainedOpsReadBackOnce) {
+  if (!at::is_vulkan_available())
+    return;
+
+  // More ops than a batch of commands holds, whose intermediate outputs are
+  // released while the commands using them are pending.
+  auto t_x =
+      at::rand({1, 3, 5, 7}, at::TensorOptions(at::kCPU).dtype(at::kFloat));
+  const auto t_y =
+      at::rand({1, 3, 5, 7}, at::TensorOptions(at::kCPU).dtype(at::kFloat)) -
+      0.5;
+  auto tv_x = t_x.vulkan();
+  const auto tv_y = t_y.vulkan();
+  for (int i = 0; i < 300; ++i) {
+    t_x = at::clamp(at::add(t_x, t_y), 0, 1);
+    tv_x = at::clamp(at::add(tv_x, tv_y), 0, 1);
+  }
+  const auto t_out = tv_x.cpu();
+
+  const auto check = almostEqual(t_out, t_x);
+  if (!check) {
+    std::cout << "expected:" << t_x << std::endl;
+    std::cout << "got:" << t_out << std::endl;
+  }
+  ASSERT_TRUE(check);
+}
@@ -1,64 +1,196 @@
 #include <THC/THCCachingHostAllocator.h>
 #include <ATen/DeviceGuard.h>
 #include <ATen/detail/CUDAHooksInterface.h>
+#include <c10/core/CPUAllocator.h>
+#include <c10/util/numa.h>
 
 
 #include <cuda_runtime_api.h>
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cctype>
 #include <deque>
+#include <fstream>
 #include <memory>
 #include <mutex>
 #include <stdint.h>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <set>
 #include <utility>
+#include <vector>
 
 namespace {
 
-struct BlockSize
+using c10::cuda::CUDACachingAllocator::DeviceStats;
+using c10::cuda::CUDACachingAllocator::Stat;
+using c10::cuda::CUDACachingAllocator::StatArray;
+using c10::cuda::CUDACachingAllocator::StatType;
+
+// Size classes, the same as the defaults of the device caching allocator.
+constexpr size_t kMinBlockSize = 512;       // all sizes are rounded to at least 512 bytes
+constexpr size_t kSmallSize = 1048576;      // largest "small" allocation is 1 MiB
+constexpr size_t kSmallBuffer = 2097152;    // "small" allocations are packed in 2 MiB blocks
+constexpr size_t kLargeBuffer = 20971520;   // "large" allocations may be packed in 20 MiB blocks
+constexpr size_t kMinLargeAlloc = 10485760; // allocations between 1 and 10 MiB may use kLargeBuffer
+constexpr size_t kRoundLarge = 2097152;     // round up large allocations to 2 MiB
+
+typedef std::bitset<static_cast<size_t>(StatType::NUM_TYPES)> StatTypes;
+
+void update_stat(Stat& stat, int64_t amount) {
+  stat.current += amount;
+  THAssert(stat.current >= 0);
+  if (stat.current > stat.peak) {
+    stat.peak = stat.current;
+  }
+  if (amount > 0) {
+    stat.allocated += amount;
+  }
+  if (amount < 0) {
+    stat.freed += -amount;
+  }
+}
+
+void reset_accumulated_stat(Stat& stat) {
+  stat.allocated = 0;
+  stat.freed = 0;
+}
+
+void reset_peak_stat(Stat& stat) {
+  stat.peak = stat.current;
+}
+
+void update_stat_array(StatArray& stat_array, int64_t amount, const StatTypes& stat_types) {
+  for (size_t stat_type = 0; stat_type < stat_types.size(); ++stat_type) {
+    if (stat_types[stat_type]) {
+      update_stat(stat_array[stat_type], amount);
+    }
+  }
+}
+
+enum class SegmentKind {
+  HOST_ALLOC,  // allocated with cudaHostAlloc
+  REGISTERED,  // allocated on a NUMA node and pinned with cudaHostRegister
+  USER,        // arena owned by the user, pinned with cudaHostRegister
+};
+
+// one pinned allocation, which is split into blocks
+struct Segment
 {
-  size_t  size; // allocation size
-  void*   ptr;  // host memory pointer
+  void*        ptr;
+  size_t       size;
+  SegmentKind  kind;
 
-  BlockSize(size_t size, void* ptr=NULL) : size(size), ptr(ptr) {}
+  Segment(void* ptr, size_t size, SegmentKind kind) :
+      ptr(ptr), size(size), kind(kind) {}
 };
 
-struct Block : public BlockSize
+struct Block;
+typedef bool (*Comparison)(const Block*, const Block*);
+typedef std::set<Block*, Comparison> BlockPool;
+
+struct Block
 {
-  bool  allocated;    // true if the block is currently allocated
-  int   event_count;  // number of outstanding cuda events
+  size_t      size;         // block size in bytes
+  void*       ptr;          // host memory pointer
+  int         numa_node;    // NUMA node of the memory, -1 if not bound
+  BlockPool*  pool;         // owning memory pool
+  Segment*    segment;      // owning segment
+  bool        allocated;    // true if the block is currently allocated
+  int         event_count;  // number of outstanding cuda events
   std::unordered_set<at::cuda::CUDAStream> streams;
+  Block*      prev;         // prev block if split from a larger segment
+  Block*      next;         // next block if split from a larger segment
+
+  Block(size_t size, void* ptr, int numa_node, BlockPool* pool, Segment* segment) :
+      size(size), ptr(ptr), numa_node(numa_node), pool(pool), segment(segment),
+      allocated(false), event_count(0), streams(), prev(nullptr), next(nullptr) {}
+
+  // constructor for search key
+  Block(size_t size, int numa_node) :
+      size(size), ptr(nullptr), numa_node(numa_node), pool(nullptr), segment(nullptr),
+      allocated(false), event_count(0), streams(), prev(nullptr), next(nullptr) {}
+
+  bool is_split() const {
+    return (prev != nullptr) || (next != nullptr);
+  }
+};
+
+// a cudaEvent recorded for a use of block on a stream
+struct StreamUseEvent
+{
+  cudaEvent_t  event;
+  int          device;  // device the event was created on
+  Block*       block;
 
-  Block(size_t size, void* ptr, bool allocated) :
-      BlockSize(size, ptr), allocated(allocated), event_count(0), streams() {}
+  StreamUseEvent(cudaEvent_t event, int device, Block* block) :
+      event(event), device(device), block(block) {}
 };
 
-static bool BlockComparator(const BlockSize& a, const BlockSize& b)
+static bool BlockComparator(const Block* a, const Block* b)
 {
-  // sort by size, break ties with pointer
-  if (a.size != b.size) {
-    return a.size < b.size;
+  // sort by NUMA node, then by size, break ties with pointer
+  if (a->numa_node != b->numa_node) {
+    return a->numa_node < b->numa_node;
+  }
+  if (a->size != b->size) {
+    return a->size < b->size;
   }
-  return (uintptr_t)a.ptr < (uintptr_t)b.ptr;
+  return (uintptr_t)a->ptr < (uintptr_t)b->ptr;
 }
 
-struct HostAllocator
+// NUMA node the PCI device of a CUDA device is attached to, or -1
+static int getDeviceNUMANode(int device)
 {
-  typedef bool (*Comparison)(const BlockSize&, const BlockSize&);
+#ifdef __linux__
+  char bus_id[32];
+  if (cudaDeviceGetPCIBusId(bus_id, sizeof(bus_id), device) != cudaSuccess) {
+    cudaGetLastError();  // clear CUDA error
+    return -1;
+  }
+  std::string path = "/sys/bus/pci/devices/";
+  for (const char* c = bus_id; *c; ++c) {
+    path += static_cast<char>(std::tolower(*c));
+  }
+  path += "/numa_node";
+  std::ifstream file(path);
+  int node = -1;
+  if (file >> node) {
+    return node;
+  }
+#endif
+  return -1;
+}
 
+struct HostAllocator
+{
   // lock around all operations
   std::mutex mutex;
 
-  // blocks by pointer
-  std::unordered_map<void*, Block> blocks;
+  // allocator statistics
+  DeviceStats stats;
+
+  // unallocated cached blocks larger than 1 MB
+  BlockPool large_blocks;
+
+  // unallocated cached blocks 1 MB or smaller
+  BlockPool small_blocks;
 
-  // pointers that are ready to be allocated (event_count=0)
-  std::set<BlockSize, Comparison> available;
+  // allocated blocks by pointer
+  std::unordered_map<void*, Block*> allocated_blocks;
 
   // outstanding cuda events
-  std::deque<std::pair<cudaEvent_t, void*>> cuda_events;
+  std::deque<StreamUseEvent> cuda_events;
 
-  HostAllocator() : available(BlockComparator) {}
+  // cuda events that are not in use, by the device they were created on
+  std::unordered_map<int, std::vector<cudaEvent_t>> free_events;
+
+  // NUMA node of each CUDA device, looked up on first use
+  std::unordered_map<int, int> device_numa_nodes;
+
+  HostAllocator() : large_blocks(BlockComparator), small_blocks(BlockComparator) {}
 
   cudaError_t malloc(void** ptr, size_t size)
   {
@@ -70,39 +202,79 @@ struct HostAllocator
       return err;
     }
 
-    // search for the smallest block which can hold this allocation
-    BlockSize search_key(size);
-    auto it = available.lower_bound(search_key);
-    if (it != available.end()) {
-      Block& block = blocks.at(it->ptr);
-      THAssert(!block.allocated && block.event_count == 0);
-      block.allocated = true;
-      *ptr = block.ptr;
-      available.erase(it);
+    *ptr = nullptr;
+    if (size == 0) {
       return cudaSuccess;
     }
 
-    // Pinned memory pointers allocated by any device can be directly used by any
-    // other device, regardless of the current device at the time of allocation,
-    // since we assume unified addressing.
-    // So we grab any existing primary context, if available.
-    // See pytorch/pytorch#21081.
-    at::OptionalDeviceGuard device_guard;
-    auto primary_ctx_device_index = at::detail::getCUDAHooks().getDevceIndexWithPrimaryContext();
-    if (primary_ctx_device_index.has_value()) {
-      device_guard.reset_device(at::Device(at::DeviceType::CUDA, *primary_ctx_device_index));
+    size = roundSize(size);
+    BlockPool& pool = getPool(size);
+    StatTypes stat_types;
+    stat_types[static_cast<size_t>(StatType::AGGREGATE)] = true;
+    stat_types[static_cast<size_t>(getStatTypeForPool(pool))] = true;
+
+    // search for the smallest block on this NUMA node which can hold this
+    // allocation, or allocate a new segment. If that fails, release all
+    // cached segments and retry.
+    const int numa_node = currentNUMANode();
+    Block* block = getFreeBlock(pool, size, numa_node);
+    if (!block) {
+      err = allocSegment(pool, size, numa_node, stat_types, &block);
+      if (err == cudaErrorMemoryAllocation) {
+        cudaGetLastError();  // clear CUDA error
+        stats.num_alloc_retries += 1;
+        freeCachedSegments();
+        err = allocSegment(pool, size, numa_node, stat_types, &block);
+      }
+      if (err != cudaSuccess) {
+        if (err == cudaErrorMemoryAllocation) {
+          stats.num_ooms += 1;
+        }
+        return err;
+      }
     }
+    THAssert(!block->allocated && block->event_count == 0);
 
-    // note that cudaHostAlloc may not touch pointer if size is 0
-    *ptr = 0;
+    const bool already_split = block->is_split();
+    if (shouldSplit(block, size)) {
+      Block* remaining = block;
 
-    // allocate a new block if no cached allocation is found
-    err = cudaHostAlloc(ptr, size, cudaHostAllocDefault);
-    if (err != cudaSuccess) {
-      return err;
+      block = new Block(size, remaining->ptr, remaining->numa_node, &pool, remaining->segment);
+      block->prev = remaining->prev;
+      if (block->prev) {
+        block->prev->next = block;
+      }
+      block->next = remaining;
+
+      remaining->prev = block;
+      remaining->ptr = static_cast<char*>(remaining->ptr) + size;
+      remaining->size -= size;
+      pool.insert(remaining);
+
+      if (already_split) {
+        // An already-split inactive block is being shrunk by size bytes.
+        update_stat_array(stats.inactive_split_bytes, -block->size, stat_types);
+      } else {
+        // A new split inactive block is being created from a previously unsplit block,
+        // size remaining->size bytes.
+        update_stat_array(stats.inactive_split_bytes, remaining->size, stat_types);
+        update_stat_array(stats.inactive_split, 1, stat_types);
+      }
+    } else if (already_split) {
+      // An already-split block is becoming active
+      update_stat_array(stats.inactive_split_bytes, -block->size, stat_types);
+      update_stat_array(stats.inactive_split, -1, stat_types);
     }
 
-    blocks.insert({*ptr, Block(size, *ptr, true)});
+    block->allocated = true;
+    allocated_blocks[block->ptr] = block;
+
+    update_stat_array(stats.allocation, 1, stat_types);
+    update_stat_array(stats.allocated_bytes, block->size, stat_types);
+    update_stat_array(stats.active, 1, stat_types);
+    update_stat_array(stats.active_bytes, block->size, stat_types);
+
+    *ptr = block->ptr;
     return cudaSuccess;
   }
 
@@ -120,15 +292,22 @@ struct HostAllocator
       return err;
     }
 
-    auto it = blocks.find(ptr);
-    THAssert(it != blocks.end());
+    auto it = allocated_blocks.find(ptr);
+    THAssert(it != allocated_blocks.end());
 
-    Block& block = it->second;
-    THAssert(block.allocated);
+    Block* block = it->second;
+    allocated_blocks.erase(it);
+    THAssert(block->allocated);
 
     // free (on valid memory) shouldn't fail, so mark unallocated before
     // we process the streams.
-    block.allocated = false;
+    block->allocated = false;
+
+    StatTypes stat_types;
+    stat_types[static_cast<size_t>(StatType::AGGREGATE)] = true;
+    stat_types[static_cast<size_t>(getStatTypeForPool(*block->pool))] = true;
+    update_stat_array(stats.allocation, -1, stat_types);
+    update_stat_array(stats.allocated_bytes, -block->size, stat_types);
 
     // insert CUDA events for each stream on which this block was used. This
     err = insertEvents(block);
@@ -136,9 +315,9 @@ struct HostAllocator
       return err;
     }
 
-    if (block.event_count == 0) {
+    if (block->event_count == 0) {
       // the block can be re-used if there are no outstanding cuda events
-      available.insert(block);
+      freeBlock(block);
     }
     return cudaSuccess;
   }
@@ -147,16 +326,41 @@ struct HostAllocator
   {
     std::lock_guard<std::mutex> lock(mutex);
 
-    auto it = blocks.find(ptr);
-    if (it == blocks.end()) {
+    auto it = allocated_blocks.find(ptr);
+    if (it == allocated_blocks.end()) {
       // ignore events for untracked pointers
       return cudaSuccess;
     }
 
-    Block& block = it->second;
-    THAssert(block.allocated);
+    Block* block = it->second;
+    THAssert(block->allocated);
+
+    block->streams.insert(stream);
+    return cudaSuccess;
+  }
+
+  cudaError_t registerArena(void* ptr, size_t size)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    THAssert(ptr && size > 0);
+
+    at::OptionalDeviceGuard device_guard;
+    usePrimaryContext(device_guard);
+
+    cudaError_t err = cudaHostRegister(ptr, size, cudaHostRegisterDefault);
+    if (err != cudaSuccess) {
+      return err;
+    }
+
+    BlockPool& pool = size <= kSmallBuffer ? small_blocks : large_blocks;
+    StatTypes stat_types;
+    stat_types[static_cast<size_t>(StatType::AGGREGATE)] = true;
+    stat_types[static_cast<size_t>(getStatTypeForPool(pool))] = true;
 
-    block.streams.insert(stream);
+    Segment* segment = new Segment(ptr, size, SegmentKind::USER);
+    pool.insert(new Block(size, ptr, c10::GetNUMANode(ptr), &pool, segment));
+    update_stat_array(stats.segment, 1, stat_types);
+    update_stat_array(stats.reserved_bytes, size, stat_types);
     return cudaSuccess;
   }
 
@@ -169,23 +373,20 @@ struct HostAllocator
     // the processing of some events may be delayed.
     while (!cuda_events.empty()) {
       auto& e = cuda_events.front();
-      cudaEvent_t event = e.first;
 
-      cudaError_t err = cudaEventQuery(event);
+      cudaError_t err = cudaEventQuery(e.event);
       if (err == cudaErrorNotReady) {
+        cudaGetLastError();  // clear CUDA error
         break;
       } else if (err != cudaSuccess) {
         return err;
       }
-      err = cudaEventDestroy(event);
-      if (err != cudaSuccess) {
-        return err;
-      }
+      releaseEvent(e);
 
-      Block& block = blocks.at(e.second);
-      block.event_count--;
-      if (block.event_count == 0 && !block.allocated) {
-        available.insert(block);
+      Block* block = e.block;
+      block->event_count--;
+      if (block->event_count == 0 && !block->allocated) {
+        freeBlock(block);
       }
       cuda_events.pop_front();
     }
@@ -196,35 +397,73 @@ struct HostAllocator
   {
     std::lock_guard<std::mutex> lock(mutex);
 
-    // remove events for freed blocks
+    // wait for the outstanding uses of freed blocks
     for (auto it = cuda_events.begin(); it != cuda_events.end(); ++it) {
-      cudaEvent_t event = it->first;
-      Block& block = blocks.at(it->second);
-      if (!block.allocated) {
-        THCudaCheckWarn(cudaEventDestroy(event));
-        block.event_count--;
+      cudaEvent_t event = it->event;
+      Block* block = it->block;
+      THCudaCheckWarn(cudaEventSynchronize(event));
+      THCudaCheckWarn(cudaEventDestroy(event));
+      block->event_count--;
+      if (block->event_count == 0 && !block->allocated) {
+        freeBlock(block);
       }
     }
 
     // all cuda_events have been processed
     cuda_events.clear();
 
-    // clear list of available blocks
-    available.clear();
-
-    // free and erase non-allocated blocks
-    for (auto it = blocks.begin(); it != blocks.end();) {
-      Block& block = it->second;
-      if (!block.allocated) {
-        THCudaCheckWarn(cudaFreeHost(block.ptr));
-        it = blocks.erase(it);
-      } else {
-        ++it;
+    for (auto& device_events : free_events) {
+      for (cudaEvent_t event : device_events.second) {
+        THCudaCheckWarn(cudaEventDestroy(event));
       }
     }
+    free_events.clear();
+
+    freeCachedSegments();
+  }
+
+  DeviceStats getStats()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+  }
+
+  void resetAccumulatedStats()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (size_t statType = 0; statType < static_cast<size_t>(StatType::NUM_TYPES); ++statType) {
+      reset_accumulated_stat(stats.allocation[statType]);
+      reset_accumulated_stat(stats.segment[statType]);
+      reset_accumulated_stat(stats.active[statType]);
+      reset_accumulated_stat(stats.inactive_split[statType]);
+      reset_accumulated_stat(stats.allocated_bytes[statType]);
+      reset_accumulated_stat(stats.reserved_bytes[statType]);
+      reset_accumulated_stat(stats.active_bytes[statType]);
+      reset_accumulated_stat(stats.inactive_split_bytes[statType]);
+    }
+
+    stats.num_alloc_retries = 0;
+    stats.num_ooms = 0;
+  }
+
+  void resetPeakStats()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (size_t statType = 0; statType < static_cast<size_t>(StatType::NUM_TYPES); ++statType) {
+      reset_peak_stat(stats.allocation[statType]);
+      reset_peak_stat(stats.segment[statType]);
+      reset_peak_stat(stats.active[statType]);
+      reset_peak_stat(stats.inactive_split[statType]);
+      reset_peak_stat(stats.allocated_bytes[statType]);
+      reset_peak_stat(stats.reserved_bytes[statType]);
+      reset_peak_stat(stats.active_bytes[statType]);
+      reset_peak_stat(stats.inactive_split_bytes[statType]);
+    }
   }
 
-  cudaError_t insertEvents(Block& block)
+  cudaError_t insertEvents(Block* block)
   {
     cudaError_t err;
 
@@ -232,25 +471,260 @@ struct HostAllocator
     err = cudaGetDevice(&prev_device);
     if (err != cudaSuccess) return err;
 
-    std::unordered_set<at::cuda::CUDAStream> streams(std::move(block.streams));
+    std::unordered_set<at::cuda::CUDAStream> streams(std::move(block->streams));
     for (auto it = streams.begin(); it != streams.end(); ++it) {
       err = cudaSetDevice(it->device_index());
       if (err != cudaSuccess) break;
 
       cudaEvent_t event;
-      err = cudaEventCreateWithFlags(&event, cudaEventDisableTiming);
+      err = acquireEvent(it->device_index(), &event);
       if (err != cudaSuccess) break;
 
       err = cudaEventRecord(event, it->stream());
       if (err != cudaSuccess) break;
 
-      block.event_count++;
-      cuda_events.emplace_back(event, block.ptr);
+      block->event_count++;
+      cuda_events.emplace_back(event, it->device_index(), block);
     }
 
     cudaSetDevice(prev_device);
     return err;
   }
+
+ private:
+  // All private methods assume the mutex is held.
+
+  static size_t roundSize(size_t size) {
+    if (size < kMinBlockSize) {
+      return kMinBlockSize;
+    } else {
+      return kMinBlockSize * ((size + kMinBlockSize - 1) / kMinBlockSize);
+    }
+  }
+
+  static size_t getAllocationSize(size_t size) {
+    if (size <= kSmallSize) {
+      return kSmallBuffer;
+    } else if (size < kMinLargeAlloc) {
+      return kLargeBuffer;
+    } else {
+      return kRoundLarge * ((size + kRoundLarge - 1) / kRoundLarge);
+    }
+  }
+
+  BlockPool& getPool(size_t size) {
+    if (size <= kSmallSize) {
+      return small_blocks;
+    } else {
+      return large_blocks;
+    }
+  }
+
+  StatType getStatTypeForPool(const BlockPool& pool) {
+    if (&pool == &small_blocks) {
+      return StatType::SMALL_POOL;
+    } else {
+      return StatType::LARGE_POOL;
+    }
+  }
+
+  bool shouldSplit(const Block* block, size_t size) {
+    size_t remaining = block->size - size;
+    if (block->pool == &small_blocks) {
+      return remaining >= kMinBlockSize;
+    } else {
+      return remaining > kSmallSize;
+    }
+  }
+
+  // Pinned memory pointers allocated by any device can be directly used by any
+  // other device, regardless of the current device at the time of allocation,
+  // since we assume unified addressing.
+  // So we grab any existing primary context, if available.
+  // See pytorch/pytorch#21081.
+  static void usePrimaryContext(at::OptionalDeviceGuard& device_guard) {
+    auto primary_ctx_device_index = at::detail::getCUDAHooks().getDevceIndexWithPrimaryContext();
+    if (primary_ctx_device_index.has_value()) {
+      device_guard.reset_device(at::Device(at::DeviceType::CUDA, *primary_ctx_device_index));
+    }
+  }
+
+  // NUMA node that new pinned memory should live on: the node of the current
+  // device, so that copies to it do not cross sockets, or the node of the
+  // calling thread if the device's node is unknown. -1 if NUMA is disabled.
+  int currentNUMANode() {
+    if (!c10::IsNUMAEnabled()) {
+      return -1;
+    }
+    int device;
+    if (cudaGetDevice(&device) != cudaSuccess) {
+      cudaGetLastError();  // clear CUDA error
+      return c10::GetCurrentNUMANode();
+    }
+    auto it = device_numa_nodes.find(device);
+    if (it == device_numa_nodes.end()) {
+      it = device_numa_nodes.emplace(device, getDeviceNUMANode(device)).first;
+    }
+    return it->second >= 0 ? it->second : c10::GetCurrentNUMANode();
+  }
+
+  Block* getFreeBlock(BlockPool& pool, size_t size, int numa_node) {
+    Block search_key(size, numa_node);
+    auto it = pool.lower_bound(&search_key);
+    if (it == pool.end() || (*it)->numa_node != numa_node) {
+      return nullptr;
+    }
+    Block* block = *it;
+    pool.erase(it);
+    return block;
+  }
+
+  cudaError_t allocSegment(BlockPool& pool, size_t size, int numa_node,
+                           const StatTypes& stat_types, Block** block) {
+    const size_t alloc_size = getAllocationSize(size);
+
+    at::OptionalDeviceGuard device_guard;
+    usePrimaryContext(device_guard);
+
+    void* ptr = nullptr;
+    SegmentKind kind;
+    if (numa_node >= 0) {
+      // bind the pages to the node before cudaHostRegister faults them in
+      ptr = c10::alloc_cpu(alloc_size);
+      c10::NUMAMove(ptr, alloc_size, numa_node);
+      cudaError_t err = cudaHostRegister(ptr, alloc_size, cudaHostRegisterDefault);
+      if (err != cudaSuccess) {
+        c10::free_cpu(ptr);
+        return err;
+      }
+      kind = SegmentKind::REGISTERED;
+    } else {
+      cudaError_t err = cudaHostAlloc(&ptr, alloc_size, cudaHostAllocDefault);
+      if (err != cudaSuccess) {
+        return err;
+      }
+      kind = SegmentKind::HOST_ALLOC;
+    }
+
+    Segment* segment = new Segment(ptr, alloc_size, kind);
+    *block = new Block(alloc_size, ptr, numa_node, &pool, segment);
+    update_stat_array(stats.segment, 1, stat_types);
+    update_stat_array(stats.reserved_bytes, alloc_size, stat_types);
+    return cudaSuccess;
+  }
+
+  /** moves a block into the pool of cached blocks, merging with free neighbours */
+  void freeBlock(Block* block) {
+    THAssert(!block->allocated && block->event_count == 0);
+
+    size_t original_block_size = block->size;
+
+    auto& pool = *block->pool;
+    int64_t net_change_inactive_split_blocks = 0;
+    int64_t net_change_inactive_split_size = 0;
+
+    const std::array<Block*, 2> merge_candidates = {block->prev, block->next};
+    for (Block* merge_candidate : merge_candidates) {
+      const int64_t subsumed_size = tryMergeBlocks(block, merge_candidate, pool);
+      if (subsumed_size > 0) {
+        net_change_inactive_split_blocks -= 1;
+        net_change_inactive_split_size -= subsumed_size;
+      }
+    }
+
+    pool.insert(block);
+
+    if (block->is_split()) {
+      net_change_inactive_split_blocks += 1;
+      net_change_inactive_split_size += block->size;
+    }
+
+    StatTypes stat_types;
+    stat_types[static_cast<size_t>(StatType::AGGREGATE)] = true;
+    stat_types[static_cast<size_t>(getStatTypeForPool(pool))] = true;
+    update_stat_array(stats.inactive_split, net_change_inactive_split_blocks, stat_types);
+    update_stat_array(stats.inactive_split_bytes, net_change_inactive_split_size, stat_types);
+    update_stat_array(stats.active, -1, stat_types);
+    update_stat_array(stats.active_bytes, -original_block_size, stat_types);
+  }
+
+  /** combine previously split blocks. returns the size of the subsumed block, or 0 on failure. */
+  size_t tryMergeBlocks(Block* dst, Block* src, BlockPool& pool) {
+    if (!src || src->allocated || src->event_count > 0) {
+      return 0;
+    }
+
+    if (dst->prev == src) {
+      dst->ptr = src->ptr;
+      dst->prev = src->prev;
+      if (dst->prev) {
+        dst->prev->next = dst;
+      }
+    } else {
+      dst->next = src->next;
+      if (dst->next) {
+        dst->next->prev = dst;
+      }
+    }
+
+    const size_t subsumed_size = src->size;
+    dst->size += subsumed_size;
+    pool.erase(src);
+    delete src;
+
+    return subsumed_size;
+  }
+
+  /** releases all cached segments that are not split */
+  void freeCachedSegments() {
+    for (BlockPool* pool : {&large_blocks, &small_blocks}) {
+      StatTypes stat_types;
+      stat_types[static_cast<size_t>(StatType::AGGREGATE)] = true;
+      stat_types[static_cast<size_t>(getStatTypeForPool(*pool))] = true;
+
+      auto it = pool->begin();
+      while (it != pool->end()) {
+        Block* block = *it;
+        if (block->is_split()) {
+          ++it;
+          continue;
+        }
+        Segment* segment = block->segment;
+        switch (segment->kind) {
+          case SegmentKind::HOST_ALLOC:
+            THCudaCheckWarn(cudaFreeHost(segment->ptr));
+            break;
+          case SegmentKind::REGISTERED:
+            THCudaCheckWarn(cudaHostUnregister(segment->ptr));
+            c10::free_cpu(segment->ptr);
+            break;
+          case SegmentKind::USER:
+            THCudaCheckWarn(cudaHostUnregister(segment->ptr));
+            break;
+        }
+        update_stat_array(stats.segment, -1, stat_types);
+        update_stat_array(stats.reserved_bytes, -segment->size, stat_types);
+
+        it = pool->erase(it);
+        delete segment;
+        delete block;
+      }
+    }
+  }
+
+  cudaError_t acquireEvent(int device, cudaEvent_t* event) {
+    auto& events = free_events[device];
+    if (!events.empty()) {
+      *event = events.back();
+      events.pop_back();
+      return cudaSuccess;
+    }
+    return cudaEventCreateWithFlags(event, cudaEventDisableTiming);
+  }
+
+  void releaseEvent(const StreamUseEvent& e) {
+    free_events[e.device].push_back(e.event);
+  }
 };
 
 }  // namespace
@@ -267,6 +741,26 @@ void THCCachingHostAllocator_emptyCache()
   allocator.emptyCache();
 }
 
+cudaError_t THCCachingHostAllocator_registerArena(void* ptr, size_t size)
+{
+  return allocator.registerArena(ptr, size);
+}
+
+c10::cuda::CUDACachingAllocator::DeviceStats THCCachingHostAllocator_getStats()
+{
+  return allocator.getStats();
+}
+
+void THCCachingHostAllocator_resetAccumulatedStats()
+{
+  allocator.resetAccumulatedStats();
+}
+
+void THCCachingHostAllocator_resetPeakStats()
+{
+  allocator.resetPeakStats();
+}
+
 static void THCCachingHostDeleter(void* ptr) {
   allocator.free(ptr);
 }
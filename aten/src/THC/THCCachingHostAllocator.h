@@ -4,6 +4,7 @@
 #include <THC/THCGeneral.h>
 
 
+#include <c10/cuda/CUDACachingAllocator.h>
 #include <c10/cuda/CUDAStream.h>
 
 //
@@ -18,8 +19,15 @@
 // call between host and device. We implement this for storages and tensors in
 // copy_from_cpu_async_ and copy_to_cpu_async_.
 //
-// Note that this allocator does not split larger allocations into smaller
-// blocks, unlike the caching device allocator.
+// Like the caching device allocator, requests are served from pinned
+// segments that are split into blocks and merged again when the blocks are
+// freed: requests of up to 1 MB are packed into 2 MB segments, requests of
+// less than 10 MB into 20 MB segments, and larger ones get their own segment.
+//
+// When NUMA is enabled (--caffe2_cpu_numa_enabled), segments are allocated on
+// the NUMA node of the current CUDA device and blocks are only reused by
+// requests for the same node, so that host-device copies do not cross
+// sockets.
 //
 THC_API c10::Allocator* getTHCCachingHostAllocator(void);
 
@@ -30,4 +38,16 @@ THC_API cudaError_t THCCachingHostAllocator_recordEvent(void *ptr, at::cuda::CUD
 // Releases cached pinned memory allocations via cudaHostFree
 THC_API void THCCachingHostAllocator_emptyCache(void);
 
+// Pins the user-owned memory [ptr, ptr + size) with cudaHostRegister and
+// serves future allocations from it. The memory is unregistered, but not
+// freed, by THCCachingHostAllocator_emptyCache once none of it is in use, and
+// must stay valid until then.
+THC_API cudaError_t THCCachingHostAllocator_registerArena(void* ptr, size_t size);
+
+// Statistics of the allocator, in the format of the caching device allocator.
+// "segment" and "reserved_bytes" count pinned memory.
+THC_API c10::cuda::CUDACachingAllocator::DeviceStats THCCachingHostAllocator_getStats(void);
+THC_API void THCCachingHostAllocator_resetAccumulatedStats(void);
+THC_API void THCCachingHostAllocator_resetPeakStats(void);
+
 #endif
@@ -43,12 +43,6 @@
 #include <THC/generic/THCTensorMathReduce.h>
 #include <THC/THCGenerateBFloat16Type.h>
 
-#include <THC/generic/THCTensorMasked.h>
-#include <THC/THCGenerateAllTypes.h>
-
-#include <THC/generic/THCTensorMasked.h>
-#include <THC/THCGenerateBoolType.h>
-
 #include <THC/generic/THCTensorScatterGather.h>
 #include <THC/THCGenerateAllTypes.h>
 
@@ -64,9 +58,6 @@
 #include <THC/generic/THCTensorIndex.h>
 #include <THC/THCGenerateBFloat16Type.h>
 
-#include <THC/generic/THCTensorMasked.h>
-#include <THC/THCGenerateBFloat16Type.h>
-
 #include <THC/generic/THCTensorSort.h>
 #include <THC/THCGenerateAllTypes.h>
 
@@ -21,34 +21,6 @@ struct TensorMulConstantOp {
   const T val;
 };
 
-template <typename T>
-struct TensorFmodOp {
-  TensorFmodOp(T v) : val((float)v) {}
-  __device__ __forceinline__ void operator()(T* out, T* in) {
-    *out = (T) fmodf((float) *in, val);
-  }
-
-  __device__ __forceinline__ void operator()(T* v) {
-    *v = (T) fmodf((float) *v, val);
-  }
-
-  const float val;
-};
-
-template <>
-struct TensorFmodOp<double> {
-  TensorFmodOp(double v) : val(v) {}
-  __device__ __forceinline__ void operator()(double* out, double* in) {
-    *out = fmod(*in, val);
-  }
-
-  __device__ __forceinline__ void operator()(double* v) {
-    *v = fmod(*v, val);
-  }
-
-  const double val;
-};
-
 #include <THC/generic/THCTensorMathPairwise.cu>
 #include <THC/THCGenerateAllTypes.h>
 
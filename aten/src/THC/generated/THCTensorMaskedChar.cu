@@ -1,5 +0,0 @@
-#include <THC/THCTensorMasked.cuh>
-#include <THC/THCTensor.hpp>
-
-#include <THC/generic/THCTensorMasked.cu>
-#include <THC/THCGenerateCharType.h>
@@ -65,6 +65,15 @@ def allequal(iterator):
     return all(first == rest for rest in iterator)
 
 
+COMM_HOOKS = {
+    "allreduce": dist.BuiltinCommHookType.ALLREDUCE,
+    "fp16": dist.BuiltinCommHookType.FP16_COMPRESS,
+    "bf16": dist.BuiltinCommHookType.BF16_COMPRESS,
+    "powersgd": dist.BuiltinCommHookType.POWER_SGD,
+    "topk": dist.BuiltinCommHookType.TOP_K,
+}
+
+
 def benchmark_process_group(pg, benchmark, use_ddp_for_single_rank=True):
     torch.manual_seed(pg.rank())
     torch.cuda.manual_seed(pg.rank())
@@ -84,6 +93,11 @@ def benchmark_process_group(pg, benchmark, use_ddp_for_single_rank=True):
             broadcast_buffers=False,
             process_group=pg,
             bucket_cap_mb=benchmark.bucket_size)
+        if benchmark.comm_hook is not None:
+            model._register_builtin_comm_hook(
+                COMM_HOOKS[benchmark.comm_hook],
+                powersgd_rank=benchmark.powersgd_rank,
+                topk_ratio=benchmark.topk_ratio)
 
     measurements = []
     warmup_iterations = 5
@@ -171,11 +185,15 @@ def sweep(benchmark):
 
 
 class Benchmark(object):
-    def __init__(self, device, distributed_backend, bucket_size):
+    def __init__(self, device, distributed_backend, bucket_size,
+                 comm_hook=None, powersgd_rank=1, topk_ratio=0.01):
         self.device = device
         self.batch_size = 32
         self.distributed_backend = distributed_backend
         self.bucket_size = bucket_size
+        self.comm_hook = comm_hook
+        self.powersgd_rank = powersgd_rank
+        self.topk_ratio = topk_ratio
 
     def __str__(self):
         raise NotImplementedError
@@ -191,11 +209,12 @@ class Benchmark(object):
 
 
 class TorchvisionBenchmark(Benchmark):
-    def __init__(self, device, distributed_backend, bucket_size, model):
+    def __init__(self, device, distributed_backend, bucket_size, model, **kwargs):
         super(TorchvisionBenchmark, self).__init__(
             device,
             distributed_backend,
             bucket_size,
+            **kwargs
         )
         self.model = model
 
@@ -222,6 +241,10 @@ def main():
     parser.add_argument("--master-port", type=str, required=True)
     parser.add_argument("--model", type=str)
     parser.add_argument("--json", type=str, metavar="PATH", help="Write file with benchmark results")
+    parser.add_argument("--comm-hook", type=str, choices=sorted(COMM_HOOKS),
+                        help="Builtin DDP communication hook to register")
+    parser.add_argument("--powersgd-rank", type=int, default=1)
+    parser.add_argument("--topk-ratio", type=float, default=0.01)
     args = parser.parse_args()
 
     num_gpus_per_node = torch.cuda.device_count()
@@ -250,6 +273,7 @@ def main():
         print("* CUDA version: {}".format(torch.version.cuda))
         print("* Distributed backend: {}".format(args.distributed_backend))
         print("* Maximum bucket size: {}MB".format(args.bucket_size))
+        print("* Communication hook: {}".format(args.comm_hook or "none"))
         print("")
         print("--- nvidia-smi topo -m ---")
         print("")
@@ -260,6 +284,10 @@ def main():
     torch.cuda.set_device(dist.get_rank() % 8)
     device = torch.device('cuda:%d' % (dist.get_rank() % 8))
 
+    hook_opts = dict(
+        comm_hook=args.comm_hook,
+        powersgd_rank=args.powersgd_rank,
+        topk_ratio=args.topk_ratio)
     benchmarks = []
     if args.model:
         benchmarks.append(
@@ -267,7 +295,8 @@ def main():
                 device=device,
                 distributed_backend=args.distributed_backend,
                 bucket_size=args.bucket_size,
-                model=args.model))
+                model=args.model,
+                **hook_opts))
     else:
         for model in ["resnet50", "resnet101", "resnext50_32x4d", "resnext101_32x8d"]:
             benchmarks.append(
@@ -275,7 +304,8 @@ def main():
                     device=device,
                     distributed_backend=args.distributed_backend,
                     bucket_size=args.bucket_size,
-                    model=model))
+                    model=model,
+                    **hook_opts))
 
     benchmark_results = []
     for benchmark in benchmarks:
@@ -295,6 +325,9 @@ def main():
             "cuda_version": torch.version.cuda,
             "distributed_backend": args.distributed_backend,
             "bucket_size": args.bucket_size,
+            "comm_hook": args.comm_hook,
+            "powersgd_rank": args.powersgd_rank,
+            "topk_ratio": args.topk_ratio,
             "benchmark_results": benchmark_results,
         }
         with open(args.json, 'w') as f:
@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+#
+# Measure the pipeline bubble of torch.distributed.pipeline.
+#
+# This program trains an MLP split evenly over --world-size stages, one
+# process each, for every number of micro-batches in --chunks, and reports
+# the fraction of the step the stages spent idle next to the (p - 1) /
+# (m + p - 1) bubble of a pipeline of p stages running m micro-batches of
+# equal cost.
+#
+
+import argparse
+import os
+
+import torch
+import torch.distributed as dist
+import torch.multiprocessing as mp
+import torch.nn as nn
+
+from torch.distributed.pipeline import Pipe, partition, GPIPE, ONE_F_ONE_B
+
+
+def model(args):
+    layers = []
+    for _ in range(args.depth):
+        layers.append(nn.Sequential(nn.Linear(args.width, args.width), nn.ReLU()))
+    return nn.Sequential(*layers)
+
+
+def run(rank, args):
+    os.environ["MASTER_ADDR"] = args.master_addr
+    os.environ["MASTER_PORT"] = str(args.master_port)
+    dist.init_process_group(args.backend, rank=rank, world_size=args.world_size)
+    device = torch.device("cuda", rank) if args.backend == "nccl" else torch.device("cpu")
+    if device.type == "cuda":
+        torch.cuda.set_device(device)
+
+    balance = [args.depth // args.world_size] * args.world_size
+    for i in range(args.depth % args.world_size):
+        balance[i] += 1
+    stage = partition(model(args), balance)[rank].to(device)
+    loss_fn = nn.MSELoss()
+    optimizer = torch.optim.SGD(stage.parameters(), lr=0.01)
+
+    for chunks in args.chunks:
+        pipe = Pipe(stage, chunks, schedule=args.schedule,
+                    checkpoint=args.checkpoint, device=device, profile=True)
+        inputs = torch.randn(args.batch_size, args.width, device=device)
+        targets = torch.randn(args.batch_size, args.width, device=device)
+
+        stats = torch.zeros(2, dtype=torch.float64)
+        for i in range(args.warmup + args.iterations):
+            optimizer.zero_grad()
+            pipe.train_step(inputs if pipe.is_first_stage else None,
+                            targets if pipe.is_last_stage else None,
+                            loss_fn)
+            optimizer.step()
+            if i >= args.warmup:
+                stats[0] += pipe.last_step_stats["time"]
+                stats[1] += pipe.last_step_stats["busy"]
+
+        # The bubble is the idle time of the average stage over the step.
+        stats = stats.to(device)
+        dist.all_reduce(stats)
+        step_time = stats[0].item() / args.world_size / args.iterations
+        busy_time = stats[1].item() / args.world_size / args.iterations
+        if rank == 0:
+            p = args.world_size
+            print("{:>8} {:>12.3f} {:>12.3f} {:>10.3f} {:>12.3f}".format(
+                chunks, step_time * 1e3, busy_time * 1e3,
+                1 - busy_time / step_time, (p - 1.0) / (chunks + p - 1)))
+
+    dist.destroy_process_group()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Pipeline parallel bubble benchmark")
+    parser.add_argument("--backend", type=str, default="gloo", choices=["gloo", "nccl"])
+    parser.add_argument("--world-size", type=int, default=4)
+    parser.add_argument("--master-addr", type=str, default="localhost")
+    parser.add_argument("--master-port", type=int, default=29500)
+    parser.add_argument("--schedule", type=str, default=ONE_F_ONE_B, choices=[GPIPE, ONE_F_ONE_B])
+    parser.add_argument("--checkpoint", action="store_true")
+    parser.add_argument("--chunks", type=int, nargs="+", default=[1, 2, 4, 8, 16, 32])
+    parser.add_argument("--batch-size", type=int, default=256)
+    parser.add_argument("--width", type=int, default=1024)
+    parser.add_argument("--depth", type=int, default=16)
+    parser.add_argument("--warmup", type=int, default=3)
+    parser.add_argument("--iterations", type=int, default=10)
+    args = parser.parse_args()
+
+    if args.backend == "nccl" and torch.cuda.device_count() < args.world_size:
+        raise RuntimeError("The NCCL benchmark needs one GPU per stage")
+    if args.batch_size < max(args.chunks):
+        raise RuntimeError("The batch size must be at least the number of micro-batches")
+
+    print("{} stages, {} schedule{}, batch of {}".format(
+        args.world_size, args.schedule,
+        " with checkpointing" if args.checkpoint else "", args.batch_size))
+    print("{:>8} {:>12} {:>12} {:>10} {:>12}".format(
+        "chunks", "step (ms)", "busy (ms)", "bubble", "(p-1)/(m+p-1)"))
+    mp.spawn(run, args=(args,), nprocs=args.world_size, join=True)
+
+
+if __name__ == "__main__":
+    main()
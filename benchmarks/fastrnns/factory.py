@@ -62,6 +62,21 @@ def pytorch_lstm_creator(**kwargs):
         backward=simple_backward)
 
 
+def pytorch_lstm_inference_creator(**kwargs):
+    input, hidden, _, module = lstm_inputs(return_module=True, **kwargs)
+
+    def forward(input, hidden):
+        with torch.no_grad():
+            return module(input, hidden)
+
+    return ModelDef(
+        inputs=[input, hidden],
+        params=flatten_list(module.all_weights),
+        forward=forward,
+        backward_setup=None,
+        backward=None)
+
+
 def lstm_creator(script=True, **kwargs):
     input, hidden, params, _ = lstm_inputs(return_module=False, **kwargs)
     inputs = [input, hidden] + params[0]
@@ -15,6 +15,16 @@ class DisableCuDNN():
         torch.backends.cudnn.enabled = self.saved
 
 
+class PersistentRNN():
+    def __enter__(self):
+        self.saved = torch.backends.cudnn.enabled, torch.backends.cuda.rnn.persistent
+        torch.backends.cudnn.enabled = False
+        torch.backends.cuda.rnn.persistent = True
+
+    def __exit__(self, *args, **kwargs):
+        torch.backends.cudnn.enabled, torch.backends.cuda.rnn.persistent = self.saved
+
+
 class DummyContext():
     def __enter__(self):
         pass
@@ -50,6 +60,8 @@ nn_runners = {
     'vl_jit': RNNRunner('vl_jit', partial(varlen_lstm_creator, script=True), DummyContext),
     'vl_py': RNNRunner('vl_py', varlen_lstm_creator, DummyContext),
     'aten': RNNRunner('aten', pytorch_lstm_creator, DisableCuDNN),
+    'aten_inference': RNNRunner('aten_inference', pytorch_lstm_inference_creator, DisableCuDNN),
+    'aten_persistent': RNNRunner('aten_persistent', pytorch_lstm_inference_creator, PersistentRNN),
     'jit': RNNRunner('jit', lstm_creator, DummyContext),
     'jit_premul': RNNRunner('jit_premul', lstm_premul_creator, DummyContext),
     'jit_premul_bias': RNNRunner('jit_premul_bias', lstm_premul_bias_creator, DummyContext),
@@ -0,0 +1,112 @@
+from __future__ import absolute_import, division, print_function, unicode_literals
+import argparse
+import time
+
+import torch
+
+from utils import secs_to_us
+
+""" Autograd engine overhead benchmark script.
+Benchmarks the CPU time the autograd engine spends per node in backward, on
+graphs of many tiny nodes, where the scheduling of the nodes dominates.
+Supported graphs:
+    chain:      a chain of additions, every node makes a single one ready.
+    per_sample: a loop over the samples of a batch, every sample being a short
+                chain, as in per-sample gradient computations.
+    fan_in:     a sum of many small products of a few shared leaves, as in
+                message passing over a graph.
+Example run:
+python autograd_overhead_benchmark.py --graph chain --num_nodes 10000
+"""
+
+SUPPORTED_GRAPHS = {"chain", "per_sample", "fan_in"}
+
+
+def build_chain(x, num_nodes):
+    z = x
+    for _ in range(num_nodes):
+        z = z + 1
+    return z.sum()
+
+
+def build_per_sample(x, num_nodes):
+    samples = x.unbind(0)
+    per_sample_len = max(num_nodes // len(samples), 1)
+    losses = []
+    for s in samples:
+        for _ in range(per_sample_len):
+            s = s * 2
+        losses.append(s.sum())
+    return torch.stack(losses).sum()
+
+
+def build_fan_in(x, num_nodes):
+    rows = x.unbind(0)
+    out = 0
+    for i in range(num_nodes // 2):
+        out = out + rows[i % len(rows)] * rows[(i * 7 + 1) % len(rows)]
+    return out.sum()
+
+
+BUILDERS = {
+    "chain": build_chain,
+    "per_sample": build_per_sample,
+    "fan_in": build_fan_in,
+}
+
+
+def count_nodes(loss):
+    seen = set()
+    stack = [loss.grad_fn]
+    while stack:
+        fn = stack.pop()
+        if fn is None or fn in seen:
+            continue
+        seen.add(fn)
+        stack.extend(next_fn for next_fn, _ in fn.next_functions)
+    return len(seen)
+
+
+def benchmark_backward(args):
+    build = BUILDERS[args.graph]
+    x = torch.randn(args.batch_size, 4, device=args.device, requires_grad=True)
+    num_nodes = count_nodes(build(x, args.num_nodes))
+
+    total = 0.
+    for i in range(args.num_warmup_iters + args.num_iters):
+        loss = build(x, args.num_nodes)
+        if args.device == "cuda":
+            torch.cuda.synchronize()
+        start = time.time()
+        loss.backward()
+        if args.device == "cuda":
+            torch.cuda.synchronize()
+        if i >= args.num_warmup_iters:
+            total += time.time() - start
+        x.grad = None
+    return total / args.num_iters, num_nodes
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--graph", default="chain", type=str)
+    parser.add_argument("--num_nodes", type=int, default=10000)
+    parser.add_argument("--batch_size", type=int, default=64)
+    parser.add_argument("--device", default="cpu", type=str)
+    parser.add_argument("--num_warmup_iters", type=int, default=3)
+    parser.add_argument("--num_iters", type=int, default=10)
+    args = parser.parse_args()
+
+    if args.graph not in SUPPORTED_GRAPHS:
+        print("Graph {} is not supported: Supported graphs are:{}".format(args.graph, SUPPORTED_GRAPHS))
+        return
+
+    latency, num_nodes = benchmark_backward(args)
+    print("===================================")
+    print("{}, nodes:{}, backward latency (us):{}".format(args.graph, num_nodes, secs_to_us(latency)))
+    print("{}, latency per node (us):{}".format(args.graph, secs_to_us(latency) / num_nodes))
+    print("===================================")
+
+
+if __name__ == "__main__":
+    main()
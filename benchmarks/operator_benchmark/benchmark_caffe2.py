@@ -3,6 +3,8 @@ from __future__ import division
 from __future__ import print_function
 from __future__ import unicode_literals
 
+import time
+
 from caffe2.python import workspace
 from caffe2.python import core
 from caffe2.proto import caffe2_pb2
@@ -128,6 +130,37 @@ class Caffe2OperatorTestCase(object):
         if not workspace.RunOperatorMultiple(op, num_runs):
             raise ValueError("Unable to run operator gradient test case: {}".format(self.test_name))
 
+    def _run_timed(self, op, num_runs):
+        # The operator runs in a net, so that it is created once rather than
+        # at each iteration as with RunOperatorOnce.
+        net = core.Net(self.test_config.test_name + "_timed")
+        net.Proto().op.extend([op])
+        workspace.CreateNet(net, True)
+        latencies = []
+        for _ in range(num_runs):
+            start_time = time.perf_counter()
+            if not workspace.RunNet(net):
+                raise ValueError("Unable to run operator test case: {}".format(
+                    self.test_config.test_name))
+            latencies.append((time.perf_counter() - start_time) * 1e6)
+        return latencies
+
+    def run_forward_timed(self, num_runs, cuda_sync=False):
+        """ Run the forward path of an operator, and return the latency of
+            each iteration in us
+        """
+        with core.DeviceScope(self.op_bench.dev):
+            op = self.op_bench.forward()
+        return self._run_timed(op, num_runs)
+
+    def run_backward_timed(self, num_runs):
+        """ Run the backward path of an operator, and return the latency of
+            each iteration in us
+        """
+        with core.DeviceScope(self.op_bench.dev):
+            op = self.op_bench.backward()
+        return self._run_timed(op, num_runs)
+
     def _print_per_iter(self):
         pass
 
@@ -0,0 +1,118 @@
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+from __future__ import unicode_literals
+
+import argparse
+import json
+import sys
+
+"""Compares the results of two operator benchmark runs.
+
+The runs are JSON files saved with --output_json, e.g. on two commits:
+
+    python -m pt.add_test --output_json base.json
+    python -m pt.add_test --output_json new.json
+    python benchmark_compare.py base.json new.json
+
+Tests are matched by framework, name, mode, runtime and thread count. The
+exit code is 1 if some test got slower by more than the threshold.
+"""
+
+# The machine metadata that makes results not comparable when it differs.
+_MACHINE_KEYS = ['hostname', 'cpu_model', 'cpu_count', 'cuda_device']
+
+
+def _load(path):
+    with open(path) as f:
+        return json.load(f)
+
+
+def _key(result):
+    return (result['framework'], result['name'], result['mode'],
+            result['runtime'], result['num_threads'])
+
+
+def _value(result, metric):
+    """ The latency of a result for metric, falling back to the median of the
+        runs when the latencies weren't collected.
+    """
+    latency = result.get('latency_us')
+    if metric != 'run_time' and latency:
+        return latency[metric]
+    run_times = sorted(result['run_time_us'])
+    return run_times[len(run_times) // 2]
+
+
+def _print_machine_differences(base, new):
+    for key in _MACHINE_KEYS:
+        if base.get(key) != new.get(key):
+            print("# Warning: {} differs: {} vs {}".format(key, base.get(key), new.get(key)))
+    for info in (base, new):
+        frequency = info.get('cpu_frequency') or {}
+        if frequency.get('turbo') or frequency.get('governor') not in (None, 'performance'):
+            print("# Warning: {} ran with governor {} and turbo {}".format(
+                info.get('hostname'), frequency.get('governor'), frequency.get('turbo')))
+    print("# Base: torch {} ({})".format(base.get('torch_version'), base.get('torch_git_version')))
+    print("# New:  torch {} ({})".format(new.get('torch_version'), new.get('torch_git_version')))
+
+
+def compare(base, new, metric, threshold):
+    """ Prints the change of each test found in both runs and returns the
+        number of regressions.
+    """
+    base_results = {_key(result): result for result in base['results']}
+    regressions = 0
+    print("{:<60} {:>12} {:>12} {:>9}".format("Test", "Base (us)", "New (us)", "Change"))
+    for result in new['results']:
+        key = _key(result)
+        if key not in base_results:
+            continue
+        base_value = _value(base_results[key], metric)
+        new_value = _value(result, metric)
+        change = (new_value - base_value) / base_value if base_value > 0 else 0.0
+        flag = ""
+        if change > threshold:
+            flag = "REGRESSION"
+            regressions += 1
+        elif change < -threshold:
+            flag = "improvement"
+        name = "{} {} {}".format(result['framework'], result['name'], result['mode'])
+        if result['runtime']:
+            name += " " + result['runtime']
+        if result['num_threads'] is not None:
+            name += " threads={}".format(result['num_threads'])
+        print("{:<60} {:>12.3f} {:>12.3f} {:>+8.1f}% {}".format(
+            name, base_value, new_value, 100 * change, flag))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Compare two operator benchmark results.",
+        formatter_class=argparse.ArgumentDefaultsHelpFormatter,
+    )
+    parser.add_argument('base', help='JSON results of the baseline')
+    parser.add_argument('new', help='JSON results to compare to the baseline')
+    parser.add_argument(
+        '--metric',
+        choices=['p50', 'p90', 'p99', 'mean', 'run_time'],
+        default='p50',
+        help='Latency to compare; run_time is the median of the measured runs')
+    parser.add_argument(
+        '--threshold',
+        type=float,
+        default=0.05,
+        help='Relative slowdown above which a test is reported as a regression')
+    args = parser.parse_args()
+
+    base = _load(args.base)
+    new = _load(args.new)
+    _print_machine_differences(base['machine'], new['machine'])
+    regressions = compare(base, new, args.metric, args.threshold)
+    print("# {} regression(s) above {:.1f}%".format(regressions, 100 * args.threshold))
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -182,6 +182,15 @@ class BenchmarkRunner(object):
         # to match the tag anymore
         if self.args.test_name is not None:
             self.args.tag_filter = None
+        self.thread_counts = None
+        if self.args.num_threads:
+            self.thread_counts = [int(n) for n in
+                                  benchmark_utils.process_arg_list(self.args.num_threads)]
+        # Per-iteration latencies are collected for the percentiles, and
+        # always saved with the results.
+        self.collect_latencies = (self.args.report_percentiles or
+                                  self.args.output_json is not None)
+        self.results = []
 
     def _print_header(self):
         DASH_LINE = '-' * 40
@@ -189,6 +198,10 @@ class BenchmarkRunner(object):
               "# PyTorch/Caffe2 Operator Micro-benchmarks\n"
               "# {}\n"
               "# Tag : {}\n".format(DASH_LINE, DASH_LINE, self.args.tag_filter))
+        if not (self.args.list_tests or self.args.list_ops):
+            cpu_frequency = benchmark_utils.get_cpu_frequency_info()
+            for warning in benchmark_utils.cpu_frequency_warnings(cpu_frequency):
+                print("# Warning: {}, timings may vary from run to run".format(warning))
         if self.args.list_tests:
             print("# List of tests:")
         elif self.args.list_ops:
@@ -197,7 +210,14 @@ class BenchmarkRunner(object):
             if self.args.operators:
                 print("# {}".format(self.args.operators))
 
-    def _print_perf_result(self, reported_run_time_us, test_case):
+    def _runtime_mode(self, test_case):
+        if test_case.framework != "PyTorch":
+            return None
+        if self.args.cpp_mode:
+            return "C++"
+        return "JIT" if self.use_jit else "Eager"
+
+    def _print_perf_result(self, reported_run_time_us, test_case, latency=None):
         if self.args.ai_pep_format:
             # Output for AI-PEP
             # Print out per iteration execution time instead of avg time
@@ -214,7 +234,9 @@ class BenchmarkRunner(object):
                 ))
         else:
             if test_case.framework == "PyTorch":
-                print("# Mode: {}".format("JIT" if self.use_jit else "Eager"))
+                print("# Mode: {}".format(self._runtime_mode(test_case)))
+                if self.thread_counts:
+                    print("# Threads: {}".format(torch.get_num_threads()))
 
             print("# Name: {}\n"
                   "# Input: {}".format(
@@ -227,10 +249,23 @@ class BenchmarkRunner(object):
                     print("Run: {}, {} Execution Time (us) : {:.3f}".format(
                         run,
                         mode, reported_run_time_us[run]))
-                print()
             else:
-                print("{} Execution Time (us) : {:.3f}\n".format(
+                print("{} Execution Time (us) : {:.3f}".format(
                     mode, reported_run_time_us[0]))
+                self._print_bandwidth(reported_run_time_us[0], test_case)
+            if latency is not None and self.args.report_percentiles:
+                print("{} Latency (us) : p50 {:.3f}, p90 {:.3f}, p99 {:.3f}, "
+                      "max {:.3f}".format(mode, latency['p50'], latency['p90'],
+                                          latency['p99'], latency['max']))
+            print()
+
+    def _print_bandwidth(self, reported_run_time_us, test_case):
+        bytes_accessed = None
+        if test_case.framework == "PyTorch" and not test_case.test_config.run_backward:
+            bytes_accessed = test_case.op_bench.bytes_accessed()
+        if bytes_accessed is not None and reported_run_time_us > 0:
+            print("Forward Achieved Bandwidth (GB/s) : {:.3f}".format(
+                bytes_accessed / (reported_run_time_us * 1e3)))
 
     def _predict_num_iter_needed(self, i):
         return (i * self.multiplier)
@@ -250,6 +285,8 @@ class BenchmarkRunner(object):
         """ Use Python's timeit module to measure execution time (unit: second).
         """
         cuda_sync = True if 'cuda' in test_case.test_config.test_name else False
+        if self.args.cpp_mode:
+            return sum(test_case.run_cpp_forward_timed(iters, cuda_sync)) / 1e6
         func = test_case.run_forward
         if self.use_jit:
             func = test_case.run_jit_forward
@@ -304,7 +341,50 @@ class BenchmarkRunner(object):
             # iteration count, and run the benchmark again...
             iters = self._predict_num_iter_needed(iters)
         reported_run_time_us = np.percentile(np.array(time_trace), 50)
-        return reported_run_time_us
+        return reported_run_time_us, iters
+
+    def _collect_latencies(self, test_case, iters):
+        """ Run the test case for <iters> more iterations, timing each of them,
+        and return the distribution of the latencies, which the mean measured
+        over all the iterations hides.
+        """
+        cuda_sync = 'cuda' in test_case.test_config.test_name
+        if test_case.test_config.run_backward:
+            latencies = test_case.run_backward_timed(iters)
+        elif self.args.cpp_mode:
+            latencies = test_case.run_cpp_forward_timed(iters, cuda_sync)
+        elif self.use_jit:
+            latencies = test_case.run_jit_forward_timed(iters, cuda_sync)
+        else:
+            latencies = test_case.run_forward_timed(iters, cuda_sync)
+        histogram = benchmark_utils.LatencyHistogram()
+        histogram.record_all(latencies)
+        return histogram.summary()
+
+    def _record_result(self, test_case, reported_time, iters, latency):
+        op_test_config = test_case.test_config
+        self.results.append({
+            'framework': test_case.framework,
+            'operator': test_case.op_bench.module_name(),
+            'name': op_test_config.test_name,
+            'input_config': op_test_config.input_config,
+            'mode': "Backward" if op_test_config.run_backward else "Forward",
+            'runtime': self._runtime_mode(test_case),
+            'num_threads': (torch.get_num_threads()
+                            if test_case.framework == "PyTorch" else None),
+            'iterations': iters,
+            'run_time_us': reported_time,
+            'latency_us': latency,
+        })
+
+    def _write_json(self):
+        with open(self.args.output_json, 'w') as f:
+            json.dump({
+                'machine': benchmark_utils.get_machine_info(),
+                'args': vars(self.args),
+                'results': self.results,
+            }, f, indent=2, sort_keys=True)
+        print("# Results saved to {}".format(self.args.output_json))
 
     def _check_keep(self, test_flag, cmd_flag):
         return (cmd_flag is None or test_flag == cmd_flag)
@@ -339,7 +419,9 @@ class BenchmarkRunner(object):
                     self._check_keep(op_test_config.tag, self.args.tag_filter)) and
                 (not self.args.forward_only or op_test_config.run_backward != self.args.forward_only) and
                 (self.args.device == 'None' or 'device' not in test_case.test_config.input_config or
-                    self.args.device in op_test_config.test_name)):
+                    self.args.device in op_test_config.test_name) and
+                (not self.args.cpp_mode or
+                    (test_case.framework == "PyTorch" and not op_test_config.run_backward))):
             return True
 
         return False
@@ -390,11 +472,34 @@ class BenchmarkRunner(object):
                 else:
                     launch_func = self._launch_forward
 
-                # Warmup
-                launch_func(test_case, self.args.warmup_iterations, print_per_iter=False)
-                # Actual Execution
-                reported_time = [self._measure_time(launch_func, test_case,
-                                                    self.iters, self.print_per_iter)
-                                 for _ in range(self.num_runs)]
-
-                self._print_perf_result(reported_time, test_case)
+                # The intra-op thread count can only be changed at runtime for PyTorch.
+                thread_counts = [None]
+                if self.thread_counts and test_case.framework == "PyTorch":
+                    thread_counts = self.thread_counts
+                    default_num_threads = torch.get_num_threads()
+
+                for num_threads in thread_counts:
+                    if num_threads is not None:
+                        torch.set_num_threads(num_threads)
+
+                    # Warmup
+                    launch_func(test_case, self.args.warmup_iterations, print_per_iter=False)
+                    # Actual Execution
+                    measurements = [self._measure_time(launch_func, test_case,
+                                                       self.iters, self.print_per_iter)
+                                    for _ in range(self.num_runs)]
+                    reported_time = [run_time for run_time, _ in measurements]
+                    iters = measurements[-1][1]
+
+                    latency = None
+                    if self.collect_latencies:
+                        latency = self._collect_latencies(test_case, iters)
+
+                    self._print_perf_result(reported_time, test_case, latency)
+                    self._record_result(test_case, reported_time, iters, latency)
+
+                if thread_counts != [None]:
+                    torch.set_num_threads(default_num_threads)
+
+        if self.args.output_json and not (self.args.list_tests or self.args.list_ops):
+            self._write_json()
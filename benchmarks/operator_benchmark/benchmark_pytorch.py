@@ -25,6 +25,7 @@ class TorchBenchmarkBase(object):
     def __init__(self):
         self.user_given_name = None
         self._jit_forward = None
+        self._cpp_forward = None
         self._pass_count = 0
         self._num_inputs_require_grads = 0
 
@@ -57,6 +58,13 @@ class TorchBenchmarkBase(object):
     def forward(self):
         pass
 
+    def bytes_accessed(self):
+        """ Benchmarks of memory bound operators can return the number of bytes
+            one forward call reads and writes. The runner then also reports the
+            achieved bandwidth next to the execution time.
+        """
+        return None
+
     def _wrap_forward(self, foo):
         """ The function passed to JIT trace must have at least one argument,
             this function is to wrap the forward method to meet that requirement.
@@ -81,6 +89,20 @@ class TorchBenchmarkBase(object):
             return result
         return _jit_forward_graph
 
+    def _generate_cpp_forward_module(self):
+        """ trace the forward function into a module, whose forward method
+            the C++ extension can call without going through Python
+        """
+        class _Forward(torch.nn.Module):
+            def __init__(self, op_bench):
+                super(_Forward, self).__init__()
+                self.op_bench = op_bench
+
+            def forward(self, place_holder):
+                return self.op_bench._wrap_forward(place_holder)
+
+        return torch.jit.trace(_Forward(self), torch.rand(1))
+
     def module_name(self):
         """ this is used to label the operator being benchmarked
         """
@@ -134,6 +156,35 @@ class PyTorchOperatorTestCase(object):
             self.op_bench._jit_forward = self.op_bench._generate_jit_forward_graph()
         self.op_bench._jit_forward(num_runs, self.place_holder_tensor)
 
+    def run_jit_forward_timed(self, num_runs, cuda_sync=False):
+        """ Run the forward path of an op with JIT mode, and return the
+            latency of each iteration in us
+        """
+        if self.op_bench._jit_forward is None:
+            self.op_bench._jit_forward = self.op_bench._generate_jit_forward_graph()
+        latencies = []
+        for _ in range(num_runs):
+            start_time = time.perf_counter()
+            self.op_bench._jit_forward(1, self.place_holder_tensor)
+            if cuda_sync:
+                torch.cuda.synchronize(torch.cuda.current_device())
+            latencies.append((time.perf_counter() - start_time) * 1e6)
+        return latencies
+
+    def run_cpp_forward_timed(self, num_runs, cuda_sync=False):
+        """ Run the traced forward path of an op from C++, so that the Python
+            overhead isn't measured, and return the latency of each iteration in us
+        """
+        try:
+            import cpp_extension as benchmark_extension
+        except ImportError:
+            raise RuntimeError("The C++ mode needs the extension in pt_extension "
+                               "to be installed (see README.md)")
+        if self.op_bench._cpp_forward is None:
+            self.op_bench._cpp_forward = self.op_bench._generate_cpp_forward_module()
+        return benchmark_extension._time_forward(
+            self.op_bench._cpp_forward._c, self.place_holder_tensor, num_runs, cuda_sync)
+
     def _print_per_iter(self):
         # print last 50 values
         length = min(len(self.time_series), 50)
@@ -164,6 +215,19 @@ class PyTorchOperatorTestCase(object):
             if cuda_sync: 
                 torch.cuda.synchronize(torch.cuda.current_device())
 
+    def run_forward_timed(self, num_runs, cuda_sync):
+        """ Run the forward path of an op with eager mode, and return the
+            latency of each iteration in us
+        """
+        latencies = []
+        for _ in range(num_runs):
+            start_time = time.perf_counter()
+            self.output = self.op_bench.forward()
+            if cuda_sync:
+                torch.cuda.synchronize(torch.cuda.current_device())
+            latencies.append((time.perf_counter() - start_time) * 1e6)
+        return latencies
+
     def _output_mean(self):
         """ TODO (mingzhe): it is not necessary to sum up everything by myself,
             torch.autograd.backward do take a gradient tensor. By default, it
@@ -181,6 +245,17 @@ class PyTorchOperatorTestCase(object):
         for _ in range(num_runs):
             self.mean.backward(retain_graph=True)
 
+    def run_backward_timed(self, num_runs):
+        """ Run the backward path of an op, and return the latency of each
+            iteration in us
+        """
+        latencies = []
+        for _ in range(num_runs):
+            start_time = time.perf_counter()
+            self.mean.backward(retain_graph=True)
+            latencies.append((time.perf_counter() - start_time) * 1e6)
+        return latencies
+
 
 def create_pytorch_op_test_case(op_bench, test_config):
     """ This method is used to generate est. func_name is a global unique
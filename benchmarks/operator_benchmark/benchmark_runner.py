@@ -122,6 +122,38 @@ def main():
         help="Only run the forward path of operators"
     )
 
+    parser.add_argument(
+        "--report_percentiles",
+        type=benchmark_utils.str2bool,
+        nargs='?',
+        const=True,
+        default=False,
+        help="Also time each iteration of the tests and report the p50/p90/p99 latencies"
+    )
+
+    parser.add_argument(
+        "--num_threads",
+        help="Comma-delimited list of intra-op thread counts to run each PyTorch test with "
+             "(e.g. 1,2,4), set with torch.set_num_threads",
+        default=None)
+
+    parser.add_argument(
+        "--output_json",
+        help="Save the results, their latency percentiles and the machine metadata "
+             "to this JSON file, which benchmark_compare.py diffs",
+        default=None)
+
+    parser.add_argument(
+        "--cpp_mode",
+        type=benchmark_utils.str2bool,
+        nargs='?',
+        const=True,
+        default=False,
+        help="Run the traced forward path of PyTorch operators in a loop in C++, "
+             "which leaves the Python overhead out of the measurements "
+             "(needs the extension in pt_extension)"
+    )
+
     parser.add_argument(
         '--framework',
         help='Comma-delimited list of frameworks to test (Caffe2, PyTorch)',
@@ -8,6 +8,11 @@ import itertools
 import random
 import os
 import bisect
+import math
+import multiprocessing
+import platform
+import socket
+import time
 
 
 """Performance microbenchmarks's utils.
@@ -350,3 +355,145 @@ def process_arg_list(arg_list):
         return None
 
     return [fr.strip() for fr in arg_list.split(',') if len(fr.strip()) > 0]
+
+
+class LatencyHistogram(object):
+    """ A histogram of latencies in the spirit of HdrHistogram: each bucket
+        is a fixed fraction wider than the previous one, so that percentiles
+        are known within relative_error of their value whatever the range of
+        the latencies, in memory that only grows with the log of that range.
+    """
+    def __init__(self, relative_error=0.01):
+        self._log_base = math.log1p(2 * relative_error)
+        self._counts = {}
+        self.count = 0
+        self.total = 0.0
+        self.min = float('inf')
+        self.max = 0.0
+
+    def _bucket(self, value):
+        # Latencies are positive, the smallest ones go to the first bucket.
+        return int(math.floor(math.log(max(value, 1e-9)) / self._log_base))
+
+    def record(self, value):
+        bucket = self._bucket(value)
+        self._counts[bucket] = self._counts.get(bucket, 0) + 1
+        self.count += 1
+        self.total += value
+        self.min = min(self.min, value)
+        self.max = max(self.max, value)
+
+    def record_all(self, values):
+        for value in values:
+            self.record(value)
+
+    def mean(self):
+        return self.total / self.count if self.count else 0.0
+
+    def percentile(self, p):
+        """ The value below which p percent of the latencies are, as the
+            middle of its bucket, clamped to the recorded range.
+        """
+        if not self.count:
+            return 0.0
+        rank = max(1, int(math.ceil(p / 100.0 * self.count)))
+        seen = 0
+        for bucket in sorted(self._counts):
+            seen += self._counts[bucket]
+            if seen >= rank:
+                value = math.exp((bucket + 0.5) * self._log_base)
+                return min(max(value, self.min), self.max)
+        return self.max
+
+    def summary(self):
+        return {
+            'count': self.count,
+            'mean': self.mean(),
+            'min': self.min if self.count else 0.0,
+            'max': self.max,
+            'p50': self.percentile(50),
+            'p90': self.percentile(90),
+            'p99': self.percentile(99),
+        }
+
+
+def _read_sysfs(path):
+    try:
+        with open(path) as f:
+            return f.read().strip()
+    except (IOError, OSError):
+        return None
+
+
+def get_cpu_frequency_info():
+    """ Frequency scaling settings of the CPUs (Linux only, None elsewhere
+        or when not exposed), which make timings vary from run to run unless
+        the governor is `performance` and turbo is disabled.
+    """
+    cpufreq = '/sys/devices/system/cpu/cpu0/cpufreq/'
+    info = {
+        'governor': _read_sysfs(cpufreq + 'scaling_governor'),
+        'driver': _read_sysfs(cpufreq + 'scaling_driver'),
+        'min_mhz': None,
+        'max_mhz': None,
+        'cur_mhz': None,
+        'turbo': None,
+    }
+    for key, name in [('min_mhz', 'scaling_min_freq'),
+                      ('max_mhz', 'scaling_max_freq'),
+                      ('cur_mhz', 'scaling_cur_freq')]:
+        khz = _read_sysfs(cpufreq + name)
+        if khz is not None and khz.isdigit():
+            info[key] = int(khz) // 1000
+    # intel_pstate exposes no_turbo, acpi-cpufreq exposes boost.
+    no_turbo = _read_sysfs('/sys/devices/system/cpu/intel_pstate/no_turbo')
+    boost = _read_sysfs('/sys/devices/system/cpu/cpufreq/boost')
+    if no_turbo is not None:
+        info['turbo'] = no_turbo == '0'
+    elif boost is not None:
+        info['turbo'] = boost == '1'
+    return info
+
+
+def cpu_frequency_warnings(info):
+    warnings = []
+    if info['governor'] is not None and info['governor'] != 'performance':
+        warnings.append("CPU frequency governor is '{}', not 'performance'"
+                        .format(info['governor']))
+    if info['turbo']:
+        warnings.append("CPU turbo boost is enabled")
+    return warnings
+
+
+def _cpu_model_name():
+    try:
+        with open('/proc/cpuinfo') as f:
+            for line in f:
+                if line.startswith('model name'):
+                    return line.split(':', 1)[1].strip()
+    except (IOError, OSError):
+        pass
+    return platform.processor()
+
+
+def get_machine_info():
+    """ Metadata of the machine and build the benchmarks run on, saved with
+        the results so that results from different commits or machines can be
+        told apart when compared.
+    """
+    import torch
+    return {
+        'hostname': socket.gethostname(),
+        'platform': platform.platform(),
+        'python_version': platform.python_version(),
+        'cpu_model': _cpu_model_name(),
+        'cpu_count': multiprocessing.cpu_count(),
+        'cpu_frequency': get_cpu_frequency_info(),
+        'torch_version': torch.__version__,
+        'torch_git_version': getattr(torch.version, 'git_version', None),
+        'cuda_version': torch.version.cuda,
+        'cuda_device': (torch.cuda.get_device_name(0)
+                        if torch.cuda.is_available() else None),
+        'num_threads': torch.get_num_threads(),
+        'timestamp': time.strftime('%Y-%m-%dT%H:%M:%S%z'),
+    }
@@ -0,0 +1,114 @@
+import operator_benchmark as op_bench
+import torch
+
+"""Microbenchmarks that report the memory bandwidth achieved by the CUDA
+elementwise and reduction templates. Each case is memory bound, so the
+reported GB/s can be compared against the peak bandwidth of the device."""
+
+
+def _nbytes(*tensors):
+    return sum(t.numel() * t.element_size() for t in tensors)
+
+
+# N is the length of the contiguous inner dimension, M the number of rows.
+elementwise_configs = op_bench.cross_product_configs(
+    M=[1, 1024],
+    N=[1 << 20, 1027],
+    dtype=[torch.float, torch.half],
+    device=['cuda'],
+    tags=['short']
+) + op_bench.cross_product_configs(
+    M=[1, 64, 4096],
+    N=[1 << 24, 4096, 1027],
+    dtype=[torch.float, torch.half, torch.bfloat16, torch.uint8],
+    device=['cuda'],
+    tags=['long']
+)
+
+
+class ContiguousBinaryBandwidthBenchmark(op_bench.TorchBenchmarkBase):
+    """Both inputs and the output are contiguous: the flat vectorized path."""
+    def init(self, M, N, dtype, device):
+        self.input_one = torch.ones(M, N, device=device, dtype=dtype)
+        self.input_two = torch.ones(M, N, device=device, dtype=dtype)
+        self.output = torch.empty(M, N, device=device, dtype=dtype)
+        self.set_module_name("add_contiguous")
+
+    def forward(self):
+        return torch.add(self.input_one, self.input_two, out=self.output)
+
+    def bytes_accessed(self):
+        return _nbytes(self.input_one, self.input_two, self.output)
+
+
+class BroadcastBinaryBandwidthBenchmark(op_bench.TorchBenchmarkBase):
+    """A [N] bias added to a [M, N] tensor: contiguous inner dimension, broadcast rows."""
+    def init(self, M, N, dtype, device):
+        self.input_one = torch.ones(M, N, device=device, dtype=dtype)
+        self.bias = torch.ones(N, device=device, dtype=dtype)
+        self.output = torch.empty(M, N, device=device, dtype=dtype)
+        self.set_module_name("add_broadcast")
+
+    def forward(self):
+        return torch.add(self.input_one, self.bias, out=self.output)
+
+    def bytes_accessed(self):
+        return _nbytes(self.input_one, self.bias, self.output)
+
+
+class StridedRowsBandwidthBenchmark(op_bench.TorchBenchmarkBase):
+    """Rows of a wider buffer: contiguous inner dimension, strided rows."""
+    def init(self, M, N, dtype, device):
+        self.input_one = torch.ones(M, N + 64, device=device, dtype=dtype)[:, :N]
+        self.output = torch.empty(M, N, device=device, dtype=dtype)
+        self.set_module_name("mul_strided_rows")
+
+    def forward(self):
+        return torch.mul(self.input_one, 2, out=self.output)
+
+    def bytes_accessed(self):
+        return _nbytes(self.input_one, self.output)
+
+
+op_bench.generate_pt_test(elementwise_configs, ContiguousBinaryBandwidthBenchmark)
+op_bench.generate_pt_test(elementwise_configs, BroadcastBinaryBandwidthBenchmark)
+op_bench.generate_pt_test(elementwise_configs, StridedRowsBandwidthBenchmark)
+
+
+# R is the length of the reduced dimension, V the length of the kept one.
+reduction_configs = op_bench.cross_product_configs(
+    R=[1 << 20, 1024],
+    V=[1, 1024],
+    dim=[0, 1],
+    dtype=[torch.float, torch.half],
+    device=['cuda'],
+    tags=['short']
+) + op_bench.cross_product_configs(
+    R=[1 << 24, 4096, 64],
+    V=[1, 64, 4096],
+    dim=[0, 1],
+    dtype=[torch.float, torch.half],
+    device=['cuda'],
+    tags=['long']
+)
+
+
+class SumBandwidthBenchmark(op_bench.TorchBenchmarkBase):
+    def init(self, R, V, dim, dtype, device):
+        shape = (R, V) if dim == 0 else (V, R)
+        self.input_tensor = torch.ones(shape, device=device, dtype=dtype)
+        self.dim = dim
+        self.output = self.input_tensor.sum(dim=self.dim)
+        self.set_module_name("sum_bandwidth")
+
+    def forward(self):
+        return torch.sum(self.input_tensor, dim=self.dim, out=self.output)
+
+    def bytes_accessed(self):
+        return _nbytes(self.input_tensor, self.output)
+
+
+op_bench.generate_pt_test(reduction_configs, SumBandwidthBenchmark)
+
+if __name__ == "__main__":
+    op_bench.benchmark_runner.main()
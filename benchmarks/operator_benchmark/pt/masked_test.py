@@ -0,0 +1,59 @@
+import operator_benchmark as op_bench
+import torch
+
+
+"""Microbenchmarks for masked_fill_ and masked_scatter_ operators."""
+
+
+# Benchmark ops performance with a mask of the shape of the input, and with
+# one broadcast across its first dimension.
+masked_ops_list = op_bench.op_list(
+    attr_names=['op_name', 'op_func'],
+    attrs=[
+        ['masked_fill_', lambda input, mask, source: input.masked_fill_(mask, 1)],
+        ['masked_scatter_', lambda input, mask, source: input.masked_scatter_(mask, source)],
+    ],
+)
+
+masked_short_configs = op_bench.config_list(
+    attr_names=['M', 'N', 'broadcast'],
+    attrs=[
+        [64, 64, False],
+        [256, 1024, False],
+        [256, 1024, True],
+    ],
+    cross_product_configs={
+        'device': ['cpu', 'cuda'],
+        'dtype': [torch.float],
+    },
+    tags=['short'],
+)
+
+masked_long_configs = op_bench.cross_product_configs(
+    M=[128, 1024],
+    N=[1024, 4096],
+    broadcast=[False, True],
+    device=['cpu', 'cuda'],
+    dtype=[torch.uint8, torch.half, torch.float, torch.double],
+    tags=['long']
+)
+
+
+class MaskedOpBenchmark(op_bench.TorchBenchmarkBase):
+    def init(self, M, N, broadcast, device, dtype, op_func):
+        self.input = torch.zeros(M, N, device=device).to(dtype=dtype)
+        self.mask = torch.rand(1 if broadcast else M, N, device=device) > 0.5
+        self.source = torch.ones(M, N, device=device).to(dtype=dtype)
+        self.op_func = op_func
+
+    def forward(self):
+        return self.op_func(self.input, self.mask, self.source)
+
+
+op_bench.generate_pt_tests_from_op_list(masked_ops_list,
+                                        masked_short_configs + masked_long_configs,
+                                        MaskedOpBenchmark)
+
+
+if __name__ == "__main__":
+    op_bench.benchmark_runner.main()
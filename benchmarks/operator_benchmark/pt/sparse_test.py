@@ -0,0 +1,63 @@
+import operator_benchmark as op_bench
+import torch
+
+"""Microbenchmarks for coalescing and adding sparse COO tensors."""
+
+# N is the number of rows of the tensor, D the size of a row, and nnz the
+# number of its (uncoalesced) rows, as for the gradient of an embedding.
+sparse_configs = op_bench.cross_product_configs(
+    N=[10000],
+    D=[1, 64],
+    nnz=[1000, 100000],
+    device=['cpu', 'cuda'],
+    tags=['short']
+) + op_bench.cross_product_configs(
+    N=[1000000],
+    D=[1, 64],
+    nnz=[1000000],
+    device=['cpu', 'cuda'],
+    tags=['long']
+)
+
+
+def _sparse_rows(N, D, nnz, device):
+    indices = torch.randint(N, (1, nnz), device=device)
+    values = torch.rand(nnz, D, device=device)
+    return torch.sparse_coo_tensor(indices, values, (N, D))
+
+
+class CoalesceBenchmark(op_bench.TorchBenchmarkBase):
+    def init(self, N, D, nnz, device):
+        self.input = _sparse_rows(N, D, nnz, device)
+        self.set_module_name("coalesce")
+
+    def forward(self):
+        # The input stays uncoalesced, coalesce returns a new tensor.
+        return self.input.coalesce()
+
+
+class SparseAddBenchmark(op_bench.TorchBenchmarkBase):
+    def init(self, N, D, nnz, device):
+        self.input_one = _sparse_rows(N, D, nnz, device).coalesce()
+        self.input_two = _sparse_rows(N, D, nnz, device).coalesce()
+        self.set_module_name("sparse_add")
+
+    def forward(self):
+        return torch.add(self.input_one, self.input_two)
+
+
+class SparseSumBenchmark(op_bench.TorchBenchmarkBase):
+    def init(self, N, D, nnz, device):
+        self.input = _sparse_rows(N, D, nnz, device)
+        self.set_module_name("sparse_sum")
+
+    def forward(self):
+        return torch.sparse.sum(self.input, dim=0)
+
+
+op_bench.generate_pt_test(sparse_configs, CoalesceBenchmark)
+op_bench.generate_pt_test(sparse_configs, SparseAddBenchmark)
+op_bench.generate_pt_test(sparse_configs, SparseSumBenchmark)
+
+if __name__ == "__main__":
+    op_bench.benchmark_runner.main()
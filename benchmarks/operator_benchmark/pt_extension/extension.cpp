@@ -1,6 +1,12 @@
 #include <torch/extension.h>
 #include <torch/script.h>
 
+#include <c10/core/Event.h>
+#include <c10/core/impl/VirtualGuardImpl.h>
+
+#include <chrono>
+#include <vector>
+
 using torch::Tensor;
 
 Tensor consume(Tensor a) {
@@ -15,6 +21,37 @@ Tensor consume(Tensor a) {
 auto reg = torch::RegisterOperators()
   .op("operator_benchmark::_consume", &consume);
 
+// Calls the forward method of a traced module iters times from C++, so that
+// the Python interpreter isn't part of the measured latencies, and returns the
+// latency of each call in microseconds. With sync, each call also waits for
+// the work it queued on the current stream of its output's device.
+std::vector<double> time_forward(
+    torch::jit::Module module,
+    Tensor input,
+    int64_t iters,
+    bool sync) {
+  pybind11::gil_scoped_release no_gil;
+  std::vector<torch::jit::IValue> inputs = {input};
+  std::vector<double> latencies;
+  latencies.reserve(iters);
+  for (int64_t i = 0; i < iters; ++i) {
+    const auto start = std::chrono::steady_clock::now();
+    const auto output = module.forward(inputs).toTensor();
+    if (sync && !output.device().is_cpu()) {
+      const auto device = output.device();
+      c10::Event event(device.type());
+      event.record(c10::impl::VirtualGuardImpl(device.type()).getStream(device));
+      while (!event.query()) {
+      }
+    }
+    const auto end = std::chrono::steady_clock::now();
+    latencies.push_back(
+        std::chrono::duration<double, std::micro>(end - start).count());
+  }
+  return latencies;
+}
+
 PYBIND11_MODULE(cpp_extension, m) {
   m.def("_consume", &consume, "consume");
+  m.def("_time_forward", &time_forward, "time_forward");
 }
@@ -29,11 +29,30 @@ def prepare_resnet50_jit(bench_args):
     model = torch.jit.trace(model, inputs)
     return inputs, model
 
+def prepare_small_ops(bench_args):
+    # many cheap ops, where the per-op cost of RecordFunction shows the most
+    x = torch.randn(4, 4)
+
+    def model(x):
+        for _ in range(1000):
+            x = x + 1
+        return x
+    return (x,), model
+
 MODELS = {
     'resnet50_jit' : prepare_resnet50_jit,
     'lstm_jit' : prepare_lstm_jit,
+    'small_ops' : prepare_small_ops,
 }
 
+# (name, sampling probability, sampling interval) of the empty observer;
+# observers sampled this rarely measure the cost of the unsampled calls
+OBSERVERS = [
+    ('without_rec_fn', None, None),
+    ('with_rec_fn_sampling_prob', 0.0001, 1),
+    ('with_rec_fn_sampling_every', 1.0, 10000),
+]
+
 NUM_THREADS = [1, 2, 4, 8, 16, 32]
 
 def run_bench(model_names, bench_args):
@@ -50,21 +69,22 @@ def run_bench(model_names, bench_args):
         print("finished")
 
         for num_threads in NUM_THREADS:
-            for with_rec_fn in [True, False]:
+            for observer, sampling_prob, sampling_every in OBSERVERS:
+                with_rec_fn = sampling_prob is not None
                 torch.autograd._enable_record_function(with_rec_fn)
                 torch.autograd._clear_callbacks()
                 if with_rec_fn:
-                    torch.autograd._set_empty_test_observer(True, 0.0001)
+                    torch.autograd._set_empty_test_observer(True, sampling_prob, sampling_every)
 
-                print("Running {} RecordFunction, num threads {} ...".format(
-                    "with" if with_rec_fn else "without", num_threads), end=" ")
+                print("Running {}, num threads {} ...".format(
+                    observer, num_threads), end=" ")
                 sys.stdout.flush()
                 timer = benchmark_utils.Timer(
                     stmt="model(*inputs)",
                     globals={"model": model, "inputs": inputs},
                     description=model_name,
                     label="Record function overhead",
-                    sub_label=f"with{'' if with_rec_fn else 'out'}_rec_fn, num_threads {num_threads}",
+                    sub_label=f"{observer}, num_threads {num_threads}",
                     num_threads=num_threads)
                 result = timer.blocked_autorange(min_run_time=bench_args.timer_min_run_time)
                 print("finished")
@@ -0,0 +1,40 @@
+import io
+
+import torch
+from pyarkbench import Benchmark, Timer, default_args
+
+
+class StateDict(torch.nn.Module):
+    def __init__(self, num_entries):
+        super(StateDict, self).__init__()
+        # Like the state of an optimizer: many small tensors keyed by name
+        self.state = {
+            "param.{}".format(i): torch.ones(4) for i in range(num_entries)
+        }
+
+    def forward(self):
+        return len(self.state)
+
+
+class StateDictLoad(Benchmark):
+    def benchmark(self):
+        results = {}
+        for num_entries in (1000, 50000):
+            buf = io.BytesIO()
+            module = torch.jit.script(StateDict(num_entries))
+            with Timer() as save:
+                torch.jit.save(module, buf)
+
+            with Timer() as load:
+                buf.seek(0)
+                torch.jit.load(buf)
+
+            results["Save {} Entries".format(num_entries)] = save.ms_duration
+            results["Load {} Entries".format(num_entries)] = load.ms_duration
+        return results
+
+
+if __name__ == '__main__':
+    bench = StateDictLoad(*default_args.bench())
+    results = bench.run()
+    bench.print_stats(results, stats=['mean', 'median'])
@@ -74,18 +74,43 @@ static void BM_deep_wide_static(benchmark::State& state) {
   for (auto _ : state) {
     runtime.run(inputs);
   }
+  auto stats = runtime.memory_stats();
+  state.counters["planned_bytes"] = stats.planned_bytes;
+  state.counters["unplanned_bytes"] = stats.unplanned_bytes;
 }
 
-BENCHMARK(BM_deep_wide_base)->RangeMultiplier(8)->Ranges({{1, 20}});
+// Every benchmark thread runs the same prepared module, with a runtime of its
+// own.
+static void BM_deep_wide_static_threaded(benchmark::State& state) {
+  static auto smod =
+      torch::jit::PrepareForStaticRuntime(getDeepAndWideSciptModel());
+  torch::jit::StaticRuntime runtime(smod);
+
+  const int batch_size = 1;
+  auto ad_emb_packed = torch::randn({batch_size, 1, embedding_size});
+  auto user_emb = torch::randn({batch_size, 1, embedding_size});
+  auto wide = torch::randn({batch_size, num_features});
+
+  std::vector<at::Tensor> inputs({ad_emb_packed, user_emb, wide});
+
+  runtime.run(inputs);
+  for (auto _ : state) {
+    runtime.run(inputs);
+  }
+}
+
+BENCHMARK(BM_deep_wide_base)->RangeMultiplier(8)->Ranges({{1, 64}});
 
 BENCHMARK(BM_deep_wide_jit_graph_executor)
     ->RangeMultiplier(8)
-    ->Ranges({{1, 20}});
+    ->Ranges({{1, 64}});
 
 BENCHMARK(BM_deep_wide_jit_profiling_executor)
     ->RangeMultiplier(8)
-    ->Ranges({{1, 20}});
+    ->Ranges({{1, 64}});
+
+BENCHMARK(BM_deep_wide_static)->RangeMultiplier(8)->Ranges({{1, 64}});
 
-BENCHMARK(BM_deep_wide_static)->RangeMultiplier(8)->Ranges({{1, 20}});
+BENCHMARK(BM_deep_wide_static_threaded)->Threads(8);
 
 BENCHMARK_MAIN();
@@ -0,0 +1,250 @@
+#!/usr/bin/env python3
+#
+# Measure the training throughput of canonical models.
+#
+# Each model of the zoo in models.py is trained on synthetic data loaded by a
+# DataLoader, in eager mode and as TorchScript, and the time of each phase of
+# the iterations (data, forward, backward, optimizer, comm) is reported along
+# with the samples per second, the data loader stall time and the peak memory.
+#
+# Run it as a single process, or with torch.distributed.launch for data
+# parallel training, in which case the scaling efficiency is reported against
+# the results of a single process run passed with --scaling_baseline.
+#
+
+import argparse
+import contextlib
+import json
+import os
+import resource
+import time
+from collections import OrderedDict
+
+import torch
+import torch.distributed as dist
+
+from models import MODELS, SyntheticDataset
+
+
+PHASES = ["data", "forward", "backward", "optimizer", "comm"]
+
+
+class PhaseTimer(object):
+    """ Accumulates the time spent in each phase of the iterations. On CUDA
+        the device is synchronized at the phase boundaries, so that the
+        kernels are accounted to the phase that queued them.
+    """
+    def __init__(self, device):
+        self.sync = device.type == "cuda"
+        self.reset()
+
+    def reset(self):
+        self.totals = OrderedDict((phase, 0.0) for phase in PHASES)
+        self.stall = 0.0
+
+    def _now(self):
+        if self.sync:
+            torch.cuda.synchronize()
+        return time.perf_counter()
+
+    @contextlib.contextmanager
+    def phase(self, name):
+        start = self._now()
+        yield
+        self.totals[name] += self._now() - start
+
+
+def to_torchscript(model, example_inputs):
+    try:
+        return torch.jit.script(model)
+    except Exception as e:
+        print("# Scripting failed ({}), tracing instead".format(
+            str(e).splitlines()[0]))
+        return torch.jit.trace(model, example_inputs)
+
+
+def peak_memory(device):
+    if device.type == "cuda":
+        stats = torch.cuda.memory_stats(device)
+        return {
+            "allocated_bytes": stats.get("allocated_bytes.all.peak", 0),
+            "reserved_bytes": stats.get("reserved_bytes.all.peak", 0),
+        }
+    # The peak resident set size of the process, in kilobytes on Linux.
+    return {"max_rss_bytes": resource.getrusage(resource.RUSAGE_SELF).ru_maxrss * 1024}
+
+
+def train(spec, mode, batch_size, device, args):
+    torch.manual_seed(0)
+    world_size = dist.get_world_size() if dist.is_initialized() else 1
+    model = spec.create_model().to(device)
+    dataset = SyntheticDataset(
+        spec, batch_size * (args.warmup_iterations + 2 * args.iterations))
+    loader = torch.utils.data.DataLoader(
+        dataset, batch_size=batch_size, num_workers=args.num_workers,
+        pin_memory=device.type == "cuda", drop_last=True)
+
+    if mode == "jit":
+        example = [t.unsqueeze(0).to(device) for t in dataset[0][:-1]]
+        model = to_torchscript(model, tuple(example))
+    if world_size > 1:
+        model = torch.nn.parallel.DistributedDataParallel(
+            model,
+            device_ids=[device] if device.type == "cuda" else None,
+            broadcast_buffers=False)
+    optimizer = spec.optimizer(model.parameters())
+
+    timer = PhaseTimer(device)
+    iterator = iter(loader)
+
+    def step():
+        with timer.phase("data"):
+            start = time.perf_counter()
+            batch = next(iterator)
+            timer.stall += time.perf_counter() - start
+            batch = [t.to(device, non_blocking=True) for t in batch]
+        inputs, target = batch[:-1], batch[-1]
+        with timer.phase("forward"):
+            loss = spec.loss(model(*inputs), target)
+        with timer.phase("backward"):
+            loss.backward()
+        with timer.phase("optimizer"):
+            optimizer.step()
+            optimizer.zero_grad()
+
+    for _ in range(args.warmup_iterations):
+        step()
+    timer.reset()
+    if device.type == "cuda":
+        torch.cuda.reset_peak_memory_stats(device)
+    start = timer._now()
+    for _ in range(args.iterations):
+        step()
+    elapsed = timer._now() - start
+    totals = timer.totals
+    stall = timer.stall
+
+    if world_size > 1:
+        # DDP overlaps the gradient all-reduce with the backward pass: the
+        # communication that isn't hidden is the extra time of the backward
+        # pass over that of iterations which don't synchronize the gradients.
+        timer.reset()
+        with model.no_sync():
+            for _ in range(args.iterations):
+                step()
+        local_backward = timer.totals["backward"]
+        totals["comm"] = max(0.0, totals["backward"] - local_backward)
+        totals["backward"] -= totals["comm"]
+        elapsed = max(item for item in all_gather(elapsed))
+
+    iteration_ms = OrderedDict(
+        (phase, 1e3 * total / args.iterations) for phase, total in totals.items())
+    return OrderedDict([
+        ("samples_per_sec", batch_size * world_size * args.iterations / elapsed),
+        ("iteration_ms", 1e3 * elapsed / args.iterations),
+        ("phase_ms", iteration_ms),
+        ("dataloader_stall_ms", 1e3 * stall / args.iterations),
+        ("peak_memory", peak_memory(device)),
+    ])
+
+
+def all_gather(obj):
+    objects = [None] * dist.get_world_size()
+    dist.all_gather_object(objects, obj)
+    return objects
+
+
+def scaling_efficiency(baseline, name, mode, result, world_size):
+    for entry in baseline["results"]:
+        if entry["model"] == name and entry["mode"] == mode:
+            return result["samples_per_sec"] / (world_size * entry["samples_per_sec"])
+    return None
+
+
+def print_result(name, mode, result):
+    phases = ", ".join("{} {:.2f}".format(phase, ms)
+                       for phase, ms in result["phase_ms"].items())
+    memory = ", ".join("{} {:.2f} GB".format(key.replace("_bytes", ""), value / 2**30)
+                       for key, value in result["peak_memory"].items())
+    print("{:<12} {:<6} {:>10.1f} samples/s, {:.2f} ms/iteration ({} ms), "
+          "stall {:.2f} ms, peak {}".format(
+              name, mode, result["samples_per_sec"], result["iteration_ms"],
+              phases, result["dataloader_stall_ms"], memory))
+    if result.get("scaling_efficiency") is not None:
+        print("{:<12} {:<6} scaling efficiency {:.1f}%".format(
+            name, mode, 100 * result["scaling_efficiency"]))
+
+
+def metadata(device, args):
+    return OrderedDict([
+        ("torch_version", torch.__version__),
+        ("torch_git_version", getattr(torch.version, "git_version", None)),
+        ("cuda_version", torch.version.cuda),
+        ("cudnn_version", torch.backends.cudnn.version()
+            if torch.backends.cudnn.is_available() else None),
+        ("device", torch.cuda.get_device_name(device)
+            if device.type == "cuda" else "cpu"),
+        ("num_threads", torch.get_num_threads()),
+        ("world_size", dist.get_world_size() if dist.is_initialized() else 1),
+        ("args", vars(args)),
+    ])
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Training throughput benchmarks")
+    parser.add_argument("--models", default=",".join(sorted(MODELS)),
+                        help="Comma-delimited list of models to train")
+    parser.add_argument("--modes", default="eager,jit",
+                        help="Comma-delimited list of modes: eager, jit")
+    parser.add_argument("--device", default="cuda" if torch.cuda.is_available() else "cpu")
+    parser.add_argument("--batch_size", type=int, default=None,
+                        help="Batch size per process, each model's default if unset")
+    parser.add_argument("--warmup_iterations", type=int, default=5)
+    parser.add_argument("--iterations", type=int, default=20)
+    parser.add_argument("--num_workers", type=int, default=2,
+                        help="Number of DataLoader worker processes")
+    parser.add_argument("--distributed_backend", default="nccl")
+    parser.add_argument("--local_rank", type=int, default=0,
+                        help="Set by torch.distributed.launch")
+    parser.add_argument("--json", default=None, help="Save the results to this file")
+    parser.add_argument("--scaling_baseline", default=None,
+                        help="JSON results of a single process run, to report "
+                             "the scaling efficiency of distributed runs against")
+    args = parser.parse_args()
+
+    device = torch.device(args.device)
+    if device.type == "cuda":
+        device = torch.device("cuda", args.local_rank)
+        torch.cuda.set_device(device)
+    world_size = int(os.environ.get("WORLD_SIZE", 1))
+    if world_size > 1:
+        dist.init_process_group(backend=args.distributed_backend, init_method="env://")
+    rank = dist.get_rank() if dist.is_initialized() else 0
+
+    baseline = None
+    if args.scaling_baseline:
+        with open(args.scaling_baseline) as f:
+            baseline = json.load(f)
+
+    results = []
+    for name in args.models.split(","):
+        spec = MODELS[name]
+        batch_size = args.batch_size or spec.default_batch_size
+        for mode in args.modes.split(","):
+            result = train(spec, mode, batch_size, device, args)
+            if baseline is not None:
+                result["scaling_efficiency"] = scaling_efficiency(
+                    baseline, name, mode, result, world_size)
+            entry = OrderedDict([("model", name), ("mode", mode), ("batch_size", batch_size)])
+            entry.update(result)
+            results.append(entry)
+            if rank == 0:
+                print_result(name, mode, result)
+
+    if args.json and rank == 0:
+        with open(args.json, "w") as f:
+            json.dump({"metadata": metadata(device, args), "results": results}, f, indent=2)
+
+
+if __name__ == "__main__":
+    main()
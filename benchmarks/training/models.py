@@ -0,0 +1,211 @@
+"""The model zoo of the training benchmarks.
+
+Each model comes with the synthetic samples it is trained on, its loss and
+its optimizer, which is what the benchmark runner needs to train it. The
+models follow the canonical architectures; the data is random, as only the
+speed of the training is measured.
+"""
+
+from collections import namedtuple
+
+import torch
+import torch.nn as nn
+import torch.nn.functional as F
+
+
+# create_model() returns the model, on CPU.
+# sample(generator) returns the tensors of one training sample, on CPU: the
+#   inputs of the model followed by the target of the loss.
+# loss(output, target) returns the loss to back-propagate.
+# optimizer(parameters) returns the optimizer of the model's parameters.
+ModelSpec = namedtuple(
+    "ModelSpec", "create_model sample loss optimizer default_batch_size")
+
+
+def _resnet50():
+    import torchvision
+    return torchvision.models.resnet50()
+
+
+def _image_sample(generator):
+    return (torch.randn(3, 224, 224, generator=generator),
+            torch.randint(1000, (), generator=generator))
+
+
+class BertBase(nn.Module):
+    """ BERT-base (12 layers, 768 hidden units, 12 heads) trained on masked
+        language modeling, with every position predicted.
+    """
+    def __init__(self, vocab_size=30522, hidden_size=768, num_layers=12,
+                 num_heads=12, intermediate_size=3072, max_positions=512):
+        super(BertBase, self).__init__()
+        self.word_embeddings = nn.Embedding(vocab_size, hidden_size)
+        self.position_embeddings = nn.Embedding(max_positions, hidden_size)
+        self.norm = nn.LayerNorm(hidden_size)
+        self.dropout = nn.Dropout(0.1)
+        layer = nn.TransformerEncoderLayer(
+            hidden_size, num_heads, intermediate_size, dropout=0.1,
+            activation="gelu")
+        self.encoder = nn.TransformerEncoder(layer, num_layers)
+        self.lm_head = nn.Linear(hidden_size, vocab_size)
+
+    def forward(self, input_ids):
+        positions = torch.arange(
+            input_ids.size(1), device=input_ids.device).unsqueeze(0)
+        x = self.word_embeddings(input_ids) + self.position_embeddings(positions)
+        x = self.dropout(self.norm(x))
+        # The encoder takes (sequence, batch, features) inputs.
+        x = self.encoder(x.transpose(0, 1)).transpose(0, 1)
+        return self.lm_head(x)
+
+
+def _bert_sample(generator, sequence_length=128, vocab_size=30522):
+    return (torch.randint(vocab_size, (sequence_length,), generator=generator),
+            torch.randint(vocab_size, (sequence_length,), generator=generator))
+
+
+def _sequence_cross_entropy(output, target):
+    return F.cross_entropy(output.reshape(-1, output.size(-1)), target.reshape(-1))
+
+
+def _mlp(sizes):
+    layers = []
+    for i in range(len(sizes) - 1):
+        layers.append(nn.Linear(sizes[i], sizes[i + 1]))
+        layers.append(nn.ReLU())
+    return nn.Sequential(*layers[:-1])
+
+
+class DLRM(nn.Module):
+    """ DLRM with the Criteo Terabyte dimensions (13 dense features, 26
+        embedding tables of 64 features, 512-256-64 bottom and 512-256-1 top
+        MLPs, dot interactions), with tables of table_rows rows each. The
+        tables are held by a single EmbeddingBag, each table being a range
+        of its rows, so that all the lookups are one operator.
+    """
+    def __init__(self, num_dense=13, num_tables=26, table_rows=100000,
+                 embedding_dim=64):
+        super(DLRM, self).__init__()
+        self.num_tables = num_tables
+        self.table_rows = table_rows
+        self.bottom_mlp = _mlp([num_dense, 512, 256, embedding_dim])
+        self.embeddings = nn.EmbeddingBag(
+            num_tables * table_rows, embedding_dim, mode="sum", sparse=True)
+        num_features = num_tables + 1
+        num_interactions = num_features * (num_features - 1) // 2
+        self.top_mlp = _mlp([embedding_dim + num_interactions, 512, 256, 1])
+        rows, cols = torch.tril_indices(num_features, num_features, -1)
+        self.register_buffer("interaction_rows", rows)
+        self.register_buffer("interaction_cols", cols)
+
+    def forward(self, dense, sparse):
+        # sparse holds (batch, tables, lookups) row indices into each table.
+        batch_size = dense.size(0)
+        x = self.bottom_mlp(dense)
+        offsets = torch.arange(
+            self.num_tables, device=sparse.device) * self.table_rows
+        indices = (sparse + offsets.view(1, -1, 1)).view(
+            batch_size * self.num_tables, -1)
+        embedded = self.embeddings(indices).view(batch_size, self.num_tables, -1)
+        features = torch.cat([x.unsqueeze(1), embedded], dim=1)
+        interactions = torch.bmm(features, features.transpose(1, 2))
+        interactions = interactions[:, self.interaction_rows, self.interaction_cols]
+        return self.top_mlp(torch.cat([x, interactions], dim=1)).squeeze(1)
+
+
+def _dlrm_sample(generator, num_dense=13, num_tables=26, table_rows=100000,
+                 lookups=1):
+    return (torch.rand(num_dense, generator=generator),
+            torch.randint(table_rows, (num_tables, lookups), generator=generator),
+            torch.randint(2, (), generator=generator).float())
+
+
+class RNNT(nn.Module):
+    """ A small RNN-T: an LSTM encoder over stacked frames, an LSTM
+        prediction network over the labels, starting from blank, and a joint
+        network over every (frame, label) pair.
+    """
+    def __init__(self, num_features=80, vocab_size=128, stack=2,
+                 encoder_hidden=320, encoder_layers=2, predictor_hidden=320,
+                 joint_hidden=320):
+        super(RNNT, self).__init__()
+        self.stack = stack
+        self.blank = vocab_size
+        self.encoder = nn.LSTM(
+            num_features * stack, encoder_hidden, encoder_layers, batch_first=True)
+        self.embedding = nn.Embedding(vocab_size + 1, predictor_hidden)
+        self.predictor = nn.LSTM(predictor_hidden, predictor_hidden, batch_first=True)
+        self.joint_encoder = nn.Linear(encoder_hidden, joint_hidden)
+        self.joint_predictor = nn.Linear(predictor_hidden, joint_hidden, bias=False)
+        self.output = nn.Linear(joint_hidden, vocab_size + 1)
+
+    def forward(self, features, labels):
+        batch_size, length, num_features = features.shape
+        length = length // self.stack
+        x = features[:, :length * self.stack].reshape(
+            batch_size, length, num_features * self.stack)
+        encoded, _ = self.encoder(x)
+        start = torch.full(
+            (batch_size, 1), self.blank, dtype=labels.dtype, device=labels.device)
+        predicted, _ = self.predictor(self.embedding(torch.cat([start, labels], dim=1)))
+        joint = torch.tanh(self.joint_encoder(encoded).unsqueeze(2) +
+                           self.joint_predictor(predicted).unsqueeze(1))
+        # (batch, frames, labels + 1, vocabulary + blank)
+        return self.output(joint)
+
+
+def _rnnt_sample(generator, frames=200, num_features=80, num_labels=40,
+                 vocab_size=128, stack=2):
+    # The target is an alignment of the joint network outputs: the RNN-T loss
+    # isn't part of PyTorch, the cross entropy of the outputs stands in for it.
+    return (torch.randn(frames, num_features, generator=generator),
+            torch.randint(vocab_size, (num_labels,), generator=generator),
+            torch.randint(vocab_size + 1, (frames // stack, num_labels + 1),
+                          generator=generator))
+
+
+MODELS = {
+    "resnet50": ModelSpec(
+        create_model=_resnet50,
+        sample=_image_sample,
+        loss=F.cross_entropy,
+        optimizer=lambda parameters: torch.optim.SGD(
+            parameters, lr=0.1, momentum=0.9, weight_decay=1e-4),
+        default_batch_size=64),
+    "bert_base": ModelSpec(
+        create_model=BertBase,
+        sample=_bert_sample,
+        loss=_sequence_cross_entropy,
+        optimizer=lambda parameters: torch.optim.AdamW(parameters, lr=1e-4),
+        default_batch_size=16),
+    "dlrm": ModelSpec(
+        create_model=DLRM,
+        sample=_dlrm_sample,
+        loss=F.binary_cross_entropy_with_logits,
+        # Sparse gradients, which plain SGD applies, as in the DLRM reference.
+        optimizer=lambda parameters: torch.optim.SGD(parameters, lr=0.1),
+        default_batch_size=2048),
+    "rnnt_small": ModelSpec(
+        create_model=RNNT,
+        sample=_rnnt_sample,
+        loss=_sequence_cross_entropy,
+        optimizer=lambda parameters: torch.optim.Adam(parameters, lr=1e-3),
+        default_batch_size=32),
+}
+
+
+class SyntheticDataset(torch.utils.data.Dataset):
+    """ num_samples samples of a model, cycling through a pool of pool_size
+        random ones so that generating them doesn't dominate data loading.
+    """
+    def __init__(self, spec, num_samples, pool_size=256, seed=0):
+        generator = torch.Generator()
+        generator.manual_seed(seed)
+        self.pool = [spec.sample(generator) for _ in range(pool_size)]
+        self.num_samples = num_samples
+
+    def __len__(self):
+        return self.num_samples
+
+    def __getitem__(self, index):
+        return self.pool[index % len(self.pool)]
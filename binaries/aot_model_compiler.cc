@@ -0,0 +1,161 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "c10/util/string_utils.h"
+#include "torch/csrc/jit/api/module.h"
+#include "torch/csrc/jit/passes/freeze_module.h"
+#include "torch/csrc/jit/runtime/aot_module.h"
+#include "torch/csrc/jit/serialization/import.h"
+
+C10_DEFINE_string(model, "", "The given torch script model to compile.");
+C10_DEFINE_string(
+    input_dims,
+    "",
+    "Alternate to input_files, if all inputs are simple "
+    "float TensorCPUs, specify the dimension using comma "
+    "separated numbers. If multiple input needed, use "
+    "semicolon to separate the dimension of different "
+    "tensors.");
+C10_DEFINE_string(
+    input_types,
+    "",
+    "The scalar types of the inputs, e.g., float;long, separated by "
+    "semicolons. Float by default.");
+C10_DEFINE_string(
+    output,
+    "",
+    "Name of the output model and library, without extension. The model "
+    "is written to <output>.pt and its kernels to <output>.so.");
+C10_DEFINE_string(
+    cxx,
+    "c++",
+    "The compiler driver linking the kernels into a shared library.");
+
+namespace {
+
+std::vector<std::string> split(char separator, const std::string& str) {
+  std::vector<std::string> parts;
+  std::istringstream in(str);
+  std::string part;
+  while (std::getline(in, part, separator)) {
+    parts.push_back(part);
+  }
+  return parts;
+}
+
+at::ScalarType parseScalarType(const std::string& name) {
+  if (name.empty() || name == "float") {
+    return at::kFloat;
+  } else if (name == "double") {
+    return at::kDouble;
+  } else if (name == "half") {
+    return at::kHalf;
+  } else if (name == "bfloat16") {
+    return at::kBFloat16;
+  } else if (name == "int") {
+    return at::kInt;
+  } else if (name == "long") {
+    return at::kLong;
+  }
+  CAFFE_THROW("Unsupported input type: ", name);
+}
+
+std::vector<c10::TensorTypePtr> parseInputTypes() {
+  auto dims = split(';', FLAGS_input_dims);
+  auto types = split(';', FLAGS_input_types);
+  CAFFE_ENFORCE(
+      types.empty() || types.size() == dims.size(),
+      "Expected a type for every input.");
+  std::vector<c10::TensorTypePtr> input_types;
+  for (size_t i = 0; i < dims.size(); ++i) {
+    std::vector<int64_t> sizes;
+    for (const auto& size : split(',', dims[i])) {
+      sizes.push_back(c10::stoi(size));
+    }
+    input_types.push_back(c10::TensorType::createContiguous(
+        parseScalarType(types.empty() ? "" : types[i]), at::kCPU, sizes));
+  }
+  return input_types;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  c10::SetUsageMessage(
+      "Compile a TorchScript model ahead of time.\n"
+      "Example usage:\n"
+      "./aot_model_compiler"
+      " --model=<model_file>"
+      " --input_dims=\"1,3,224,224\""
+      " --output=<output_name>");
+  if (!c10::ParseCommandLineFlags(&argc, &argv)) {
+    std::cerr << "Failed to parse command line flags!" << std::endl;
+    return 1;
+  }
+
+  CAFFE_ENFORCE(FLAGS_model != "", "Valid input must be provided.");
+  CAFFE_ENFORCE(FLAGS_input_dims != "", "Input dims must be specified.");
+
+#ifndef TORCH_ENABLE_LLVM
+  CAFFE_THROW("Compiling models ahead of time needs a build with LLVM.");
+#else
+  std::string output_name = FLAGS_output;
+  if (output_name == "") {
+    output_name =
+        FLAGS_model.substr(0, FLAGS_model.find(".")) + "_aot_compiled";
+  }
+  auto input_types = parseInputTypes();
+
+  // The kernels are compiled for the fusion groups of the model as it will
+  // be loaded, so that the graph they are compiled from is that of the
+  // runtime.
+  auto module = torch::jit::load(FLAGS_model);
+  module.eval();
+  module = torch::jit::freeze_module(module);
+  auto model_path = output_name + ".pt";
+  torch::jit::SaveAotModel(module, input_types, model_path);
+  module = torch::jit::LoadAotModel(model_path, input_types);
+  auto graph = torch::jit::PrepareForAotCompilation(module, input_types);
+  auto objects = torch::jit::CompileFusionGroupsToObjects(graph);
+
+  std::string link_command = FLAGS_cxx + " -shared -o " + output_name + ".so";
+  std::vector<std::string> object_paths;
+  for (const auto& object : objects) {
+    auto path = output_name + "." + object.first + ".o";
+    std::ofstream out(path, std::ios::binary);
+    out << object.second;
+    CAFFE_ENFORCE(out, "Can't write ", path);
+    object_paths.push_back(path);
+    link_command += " " + path;
+  }
+  std::cout << "Compiled " << objects.size() << " kernels" << std::endl;
+  int status = std::system(link_command.c_str());
+  for (const auto& path : object_paths) {
+    std::remove(path.c_str());
+  }
+  CAFFE_ENFORCE(status == 0, "Failed to link the kernels: ", link_command);
+#endif
+
+  return 0;
+}
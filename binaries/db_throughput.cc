@@ -28,6 +28,14 @@ C10_DEFINE_string(input_db_type, "", "The input db type.");
 C10_DEFINE_int(report_interval, 1000, "The report interval.");
 C10_DEFINE_int(repeat, 10, "The number to repeat the throughput test.");
 C10_DEFINE_bool(use_reader, false, "If true, use the reader interface.");
+C10_DEFINE_bool(
+    use_views,
+    false,
+    "If true, read the records through the zero-copy cursor views.");
+C10_DEFINE_int(
+    batch_size,
+    1,
+    "The number of records each read of the reader interface returns.");
 C10_DEFINE_int(
     num_read_threads,
     1,
@@ -44,10 +52,15 @@ void TestThroughputWithDB() {
   std::unique_ptr<Cursor> cursor(in_db->NewCursor());
   for (int iter_id = 0; iter_id < FLAGS_repeat; ++iter_id) {
     caffe2::Timer timer;
+    size_t bytes = 0;
     for (int i = 0; i < FLAGS_report_interval; ++i) {
-      string key = cursor->key();
-      string value = cursor->value();
-      //VLOG(1) << "Key " << key;
+      if (FLAGS_use_views) {
+        bytes += cursor->key_view().size() + cursor->value_view().size();
+      } else {
+        string key = cursor->key();
+        string value = cursor->value();
+        bytes += key.size() + value.size();
+      }
       cursor->Next();
       if (!cursor->Valid()) {
         cursor->SeekToFirst();
@@ -55,19 +68,28 @@ void TestThroughputWithDB() {
     }
     double elapsed_seconds = timer.Seconds();
     printf(
-        "Iteration %03d, took %4.5f seconds, throughput %f items/sec.\n",
+        "Iteration %03d, took %4.5f seconds, throughput %f items/sec, "
+        "%f MB/sec.\n",
         iter_id,
         elapsed_seconds,
-        FLAGS_report_interval / elapsed_seconds);
+        FLAGS_report_interval / elapsed_seconds,
+        bytes / elapsed_seconds / 1e6);
   }
 }
 
 void TestThroughputWithReaderWorker(const DBReader* reader, int thread_id) {
   string key, value;
+  std::vector<string> keys, values;
   for (int iter_id = 0; iter_id < FLAGS_repeat; ++iter_id) {
     caffe2::Timer timer;
-    for (int i = 0; i < FLAGS_report_interval; ++i) {
-      reader->Read(&key, &value);
+    if (FLAGS_batch_size > 1) {
+      for (int i = 0; i < FLAGS_report_interval; i += FLAGS_batch_size) {
+        reader->ReadBatch(FLAGS_batch_size, &keys, &values);
+      }
+    } else {
+      for (int i = 0; i < FLAGS_report_interval; ++i) {
+        reader->Read(&key, &value);
+      }
     }
     double elapsed_seconds = timer.Seconds();
     printf(
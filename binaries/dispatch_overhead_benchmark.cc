@@ -0,0 +1,158 @@
+#include <torch/torch.h>
+#include <ATen/core/dispatch/Dispatcher.h>
+#include <ATen/record_function.h>
+#include <c10/util/OverheadProbe.h>
+#include <torch/library.h>
+
+#include "c10/util/Flags.h"
+
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+C10_DEFINE_int(iter, 1000000, "Number of iterations of every scenario");
+C10_DEFINE_int(warmup_iter, 10000, "Number of warmup iterations");
+C10_DEFINE_string(
+    scenarios,
+    "",
+    "Comma separated names of the scenarios to run, all of them if empty");
+
+// Measures the overhead of the calls of operators, i.e. of ops that do next to
+// no work, with and without grad and RecordFunction callbacks. When built with
+// USE_OVERHEAD_PROBES=1 it also breaks the time of a call down into the layers
+// it goes through (see c10/util/OverheadProbe.h); the probes add the cost of
+// reading the clock twice per layer, so compare totals between builds without
+// them. Pass --caffe2_pool_tensor_objects to compare with the TensorImpls and
+// StorageImpls of the outputs allocated from the object pools
+// (see c10/core/impl/ObjectPool.h).
+
+namespace {
+
+// An operator whose kernel does nothing but return its input.
+at::Tensor empty_kernel(const at::Tensor& self) {
+  return self;
+}
+
+TORCH_LIBRARY(overhead_benchmark, m) {
+  m.def("empty(Tensor self) -> Tensor");
+}
+
+TORCH_LIBRARY_IMPL(overhead_benchmark, CPU, m) {
+  m.impl("empty", empty_kernel);
+}
+
+struct Scenario {
+  std::string name;
+  // Whether the inputs require grad.
+  bool requires_grad;
+  // Whether a RecordFunction callback is registered.
+  bool callbacks;
+  std::function<void(const at::Tensor&)> call;
+};
+
+std::vector<Scenario> scenarios() {
+  static auto empty_op = c10::Dispatcher::singleton()
+      .findSchemaOrThrow("overhead_benchmark::empty", "")
+      .typed<at::Tensor(const at::Tensor&)>();
+  std::vector<Scenario> result;
+  for (bool callbacks : {false, true}) {
+    for (bool requires_grad : {false, true}) {
+      result.push_back({"empty", requires_grad, callbacks,
+          [](const at::Tensor& x) { empty_op.call(x); }});
+      result.push_back({"add", requires_grad, callbacks,
+          [](const at::Tensor& x) { at::add(x, x); }});
+      result.push_back({"view", requires_grad, callbacks,
+          [](const at::Tensor& x) { x.view({-1}); }});
+      result.push_back({"transpose", requires_grad, callbacks,
+          [](const at::Tensor& x) { x.transpose(0, 1); }});
+      result.push_back({"select", requires_grad, callbacks,
+          [](const at::Tensor& x) { x.select(0, 0); }});
+      result.push_back({"slice", requires_grad, callbacks,
+          [](const at::Tensor& x) { x.slice(1, 0, 1); }});
+    }
+    // In place ops on leaves that require grad are not allowed, and on
+    // other tensors they would grow a graph with every call.
+    result.push_back({"add_", false, callbacks,
+        [](const at::Tensor& x) { x.add_(1); }});
+  }
+  return result;
+}
+
+std::string label(const Scenario& scenario) {
+  return scenario.name + (scenario.requires_grad ? "/grad" : "/no_grad") +
+      (scenario.callbacks ? "/callbacks" : "");
+}
+
+bool selected(const Scenario& scenario) {
+  if (FLAGS_scenarios.empty()) {
+    return true;
+  }
+  const std::string list = "," + FLAGS_scenarios + ",";
+  return list.find("," + scenario.name + ",") != std::string::npos;
+}
+
+void run(const Scenario& scenario) {
+  auto x = torch::ones({1, 1}, torch::requires_grad(scenario.requires_grad));
+  c10::optional<at::CallbackHandle> handle;
+  if (scenario.callbacks) {
+    handle = at::addGlobalCallback(at::RecordFunctionCallback(
+        [](const at::RecordFunction&) {}, [](const at::RecordFunction&) {}));
+  }
+
+  for (int i = 0; i < FLAGS_warmup_iter; ++i) {
+    scenario.call(x);
+  }
+  c10::probe::resetThreadStats();
+  typedef std::chrono::high_resolution_clock clock;
+  const auto start_time = clock::now();
+  for (int i = 0; i < FLAGS_iter; ++i) {
+    scenario.call(x);
+  }
+  const double total_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              clock::now() - start_time)
+                              .count();
+  const auto stats = c10::probe::threadStats();
+  if (handle) {
+    at::removeCallback(*handle);
+  }
+
+  std::cout << std::left << std::setw(32) << label(scenario) << std::right
+            << std::setw(10) << std::fixed << std::setprecision(1)
+            << total_ns / FLAGS_iter << " ns/call" << std::endl;
+  for (size_t i = 0; i < c10::probe::kNumLayers; ++i) {
+    if (stats[i].calls == 0) {
+      continue;
+    }
+    const auto layer = static_cast<c10::probe::Layer>(i);
+    std::cout << "    " << std::left << std::setw(28)
+              << c10::probe::layerName(layer) << std::right << std::setw(10)
+              << static_cast<double>(stats[i].nanos) / FLAGS_iter
+              << " ns/call" << std::setw(8)
+              << static_cast<double>(stats[i].calls) / FLAGS_iter
+              << " entries/call" << std::endl;
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  if (!c10::ParseCommandLineFlags(&argc, &argv)) {
+    std::cout << "Failed to parse command line flags" << std::endl;
+    return -1;
+  }
+  at::set_num_threads(1);
+  at::enableRecordFunction();
+#ifndef C10_USE_OVERHEAD_PROBES
+  std::cout << "Built without USE_OVERHEAD_PROBES, "
+            << "only the totals of the calls are measured." << std::endl;
+#endif
+  for (const auto& scenario : scenarios()) {
+    if (selected(scenario)) {
+      run(scenario);
+    }
+  }
+  return 0;
+}
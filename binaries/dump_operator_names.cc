@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <ATen/KernelDtypes.h>
+#include <torch/csrc/autograd/grad_mode.h>
 #include <torch/csrc/jit/api/module.h>
 #include <torch/csrc/jit/mobile/module.h>
 #include <torch/csrc/jit/serialization/import.h>
@@ -48,11 +50,33 @@ void dump_opnames(const Module& m, std::unordered_set<std::string>& opnames) {
     dump_opnames(sub_m, opnames);
   }
 }
+
+// Runs the forward method of `m` on each of its bundled inputs, so that a
+// build with TORCH_TRACE_KERNEL_DTYPES records the dtypes its kernels use.
+void run_bundled_inputs(Module& m) {
+  auto get_method = m.find_method("get_all_bundled_inputs");
+  CAFFE_ENFORCE(
+      get_method,
+      "The model has no bundled inputs, see "
+      "torch.utils.bundled_inputs.augment_model_with_bundled_inputs.");
+  torch::autograd::AutoGradMode guard(false);
+  m.eval();
+  auto all_inputs = (*get_method)({}).toList();
+  for (size_t i = 0; i < all_inputs.size(); ++i) {
+    m.forward(all_inputs.get(i).toTuple()->elements());
+  }
+}
 }
 }
 
 C10_DEFINE_string(model, "", "The given torch script model.");
 C10_DEFINE_string(output, "", "The output yaml file of operator list.");
+C10_DEFINE_string(
+    dtypes_output,
+    "",
+    "The output yaml file of the dtypes of each kernel, the SELECTED_DTYPES "
+    "of a custom build. It needs a build with TRACE_KERNEL_DTYPES, which "
+    "records them while the model runs on its bundled inputs.");
 
 int main(int argc, char** argv) {
   c10::SetUsageMessage(
@@ -80,4 +104,23 @@ int main(int argc, char** argv) {
     ofile << "- " << name << std::endl;
   }
   ofile.close();
+
+  if (!FLAGS_dtypes_output.empty()) {
+    torch::jit::run_bundled_inputs(m);
+    auto kernel_dtypes = at::recorded_kernel_dtypes();
+    CAFFE_ENFORCE(
+        !kernel_dtypes.empty(),
+        "No kernel dtypes were recorded, the build needs TRACE_KERNEL_DTYPES.");
+    std::ofstream dtypes_file(FLAGS_dtypes_output);
+    std::cout << "-- Kernel dtypes --" << std::endl;
+    for (const auto& kernel : kernel_dtypes) {
+      std::cout << kernel.first << ":";
+      dtypes_file << kernel.first << ":" << std::endl;
+      for (auto dtype : kernel.second) {
+        std::cout << " " << c10::toString(dtype);
+        dtypes_file << "- " << c10::toString(dtype) << std::endl;
+      }
+      std::cout << std::endl;
+    }
+  }
 }
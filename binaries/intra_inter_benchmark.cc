@@ -21,6 +21,9 @@ C10_DEFINE_int(benchmark_iter, 10, "Number of times to run benchmark")
 C10_DEFINE_bool(extra_stats, false,
     "Collect extra stats; warning: skews results");
 C10_DEFINE_string(task_type, "add", "Tensor operation: add or mm");
+C10_DEFINE_int(skew, 0,
+    "Subtask k runs the tensor operation 1 + k * skew / sub_iter times; "
+    "use a positive value to model uneven workloads");
 
 namespace {
 std::atomic<int> counter{0};
@@ -50,10 +53,13 @@ void _launch_tasks_tree(
         tids.insert(std::this_thread::get_id());
       }
       for (auto k = begin; k < end; ++k) {
-        if (run_mm) {
-          left.mm(right);
-        } else {
-          left.add(right);
+        auto repeat = 1 + k * FLAGS_skew / FLAGS_sub_iter;
+        for (auto r = 0; r < repeat; ++r) {
+          if (run_mm) {
+            left.mm(right);
+          } else {
+            left.add(right);
+          }
         }
         auto cur_ctr = ++counter;
         if (cur_ctr == overall_tasks) {
@@ -119,6 +125,7 @@ int main(int argc, char** argv) {
   }
 
   TORCH_CHECK(FLAGS_task_type == "add" || FLAGS_task_type == "mm");
+  TORCH_CHECK(FLAGS_skew >= 0);
   run_mm = FLAGS_task_type == "mm";
 
   auto left = at::ones({FLAGS_tensor_dim, FLAGS_tensor_dim}, at::kFloat);
@@ -142,7 +149,11 @@ int main(int argc, char** argv) {
             << at::get_num_interop_threads() << " inter-op threads and "
             << at::get_num_threads() << " intra-op threads, "
             << "tensor dim: " << FLAGS_tensor_dim
-            << ", task type: " << FLAGS_task_type << std::endl;
+            << ", task type: " << FLAGS_task_type
+            << ", skew: " << FLAGS_skew << std::endl;
+  // Backends are chosen at build time (ATEN_THREADING=OMP/NATIVE/NATIVE_WS/
+  // TBB); compare them by running this binary from each build.
+  std::cout << at::get_parallel_info();
 
   std::vector<float> runtimes;
   for (auto bench_iter = 0; bench_iter < FLAGS_benchmark_iter; ++bench_iter) {
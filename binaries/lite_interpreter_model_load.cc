@@ -3,10 +3,25 @@
 #include <torch/csrc/autograd/generated/variable_factories.h>
 #include <torch/csrc/jit/mobile/import.h>
 #include <torch/csrc/jit/mobile/module.h>
+#include <torch/csrc/jit/mobile/observer.h>
 #include <torch/csrc/jit/serialization/import.h>
 #include "torch/script.h"
 
+#include <chrono>
+
 C10_DEFINE_string(model, "", "The given bytecode model to check if it is supported by lite_interpreter.");
+C10_DEFINE_bool(print_load_times, false, "Whether to print the time each stage of the load takes.");
+
+namespace {
+
+class LoadTimesObserver : public torch::MobileModuleObserver {
+ public:
+  void onLoadModelStage(const std::string& stage, int64_t duration_us) override {
+    std::cout << stage << ": " << duration_us << " us" << std::endl;
+  }
+};
+
+} // namespace
 
 int main(int argc, char** argv) {
   c10::SetUsageMessage(
@@ -28,6 +43,18 @@ int main(int argc, char** argv) {
   // TODO: avoid having to set this guard for custom mobile build with mobile
   // interpreter.
   torch::AutoNonVariableTypeMode non_var_guard{true};
+  if (FLAGS_print_load_times) {
+    torch::observerConfig().setModuleObserver(
+        std::make_unique<LoadTimesObserver>());
+  }
+  auto start = std::chrono::steady_clock::now();
   torch::jit::mobile::Module bc = torch::jit::_load_for_mobile(FLAGS_model);
+  if (FLAGS_print_load_times) {
+    std::cout << "total: "
+              << std::chrono::duration_cast<std::chrono::microseconds>(
+                     std::chrono::steady_clock::now() - start)
+                     .count()
+              << " us" << std::endl;
+  }
   return 0;
 }
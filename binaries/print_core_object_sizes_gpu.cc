@@ -20,6 +20,7 @@
 #include "caffe2/core/context.h"
 #include "caffe2/core/context_gpu.h"
 #include "caffe2/proto/caffe2_pb.h"
+#include "c10/core/TensorImpl.h"
 
 #define PRINT_SIZE(cls) \
   std::cout << "Size of " #cls ": " << sizeof(cls) << " bytes." \
@@ -28,6 +29,8 @@
 int main(int /* unused */, char** /* unused */) {
   PRINT_SIZE(caffe2::Blob);
   PRINT_SIZE(caffe2::Tensor);
+  PRINT_SIZE(c10::TensorImpl);
+  PRINT_SIZE(c10::impl::SizesAndStrides);
   PRINT_SIZE(caffe2::CPUContext);
   PRINT_SIZE(caffe2::CUDAContext);
   PRINT_SIZE(caffe2::OperatorBase);
@@ -14,11 +14,14 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
 #include "ATen/ATen.h"
+#include "ATen/Parallel.h"
 #include "caffe2/core/timer.h"
+#include "caffe2/utils/threadpool/pthreadpool-cpp.h"
 #include "caffe2/utils/string_utils.h"
 #include "torch/csrc/autograd/grad_mode.h"
 #include "torch/csrc/jit/serialization/import.h"
@@ -63,6 +66,36 @@ C10_DEFINE_bool(
 
 C10_DEFINE_int(pytext_len, 0, "Length of input sequence.");
 C10_DEFINE_bool(vulkan, false, "Whether to use Vulkan backend (GPU).");
+C10_DEFINE_int(
+    num_threads,
+    0,
+    "The number of intra-op threads, 0 to keep the default.");
+C10_DEFINE_string(
+    thread_policy,
+    "",
+    "Where the intra-op threads run on mobile: big_cores, pinned to the "
+    "cores of the fastest cluster, or all_cores. Empty keeps the default.");
+
+void set_threads() {
+  if (!FLAGS_thread_policy.empty()) {
+#ifdef USE_PTHREADPOOL
+    if (FLAGS_thread_policy == "big_cores") {
+      caffe2::setPThreadPoolPolicy(caffe2::PThreadPoolPolicy::kBigCores);
+    } else if (FLAGS_thread_policy == "all_cores") {
+      caffe2::setPThreadPoolPolicy(caffe2::PThreadPoolPolicy::kAllCores);
+    } else {
+      CAFFE_THROW("Unsupported thread policy: ", FLAGS_thread_policy);
+    }
+#else
+    CAFFE_THROW("--thread_policy requires a build with USE_PTHREADPOOL");
+#endif
+  }
+  if (FLAGS_num_threads > 0) {
+    at::set_num_threads(FLAGS_num_threads);
+  }
+  std::cout << "Running with " << at::get_num_threads() << " threads."
+            << std::endl;
+}
 
 std::vector<std::string>
 split(char separator, const std::string& string, bool ignore_empty = true) {
@@ -169,6 +202,7 @@ int main(int argc, char** argv) {
     return 1;
   }
 
+  set_threads();
   std::vector<c10::IValue> inputs = create_inputs();
 
   torch::autograd::AutoGradMode guard(false);
@@ -235,6 +269,13 @@ int main(int argc, char** argv) {
             << micros / FLAGS_iter
             << ". Iters per second: " << 1000.0 * 1000 * FLAGS_iter / micros
             << std::endl;
+  if (!times.empty()) {
+    // The stragglers of the parallel loops show in the tail of the latencies.
+    std::sort(times.begin(), times.end());
+    std::cout << "Microseconds per iter, p50: " << times[times.size() / 2]
+              << ", p90: " << times[times.size() * 9 / 10]
+              << ", max: " << times.back() << std::endl;
+  }
 
   return 0;
 }
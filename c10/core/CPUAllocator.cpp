@@ -1,5 +1,6 @@
 #include <c10/core/CPUAllocator.h>
 #include <c10/core/DeviceType.h>
+#include <c10/util/Metrics.h>
 
 // TODO: rename flags to C10
 C10_DEFINE_bool(
@@ -100,6 +101,10 @@ struct C10_API DefaultCPUAllocator final : at::Allocator {
   at::DataPtr allocate(size_t nbytes) const override {
     void* data = alloc_cpu(nbytes);
     profiledCPUMemoryReporter().New(data, nbytes);
+    C10_METRICS_HISTOGRAM_RECORD(
+        "c10_cpu_allocation_bytes",
+        "Sizes of the allocations of the default CPU allocator",
+        nbytes);
     return {data, data, &ReportAndDelete, at::Device(at::DeviceType::CPU)};
   }
 
@@ -0,0 +1,427 @@
+#include <c10/core/CPUCachingAllocator.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include <c10/core/CPUAllocator.h>
+
+C10_DEFINE_int64(
+    caffe2_cpu_caching_allocator_thread_cache_bytes,
+    4 << 20,
+    "Maximum number of bytes the caching CPU allocator keeps cached per thread");
+
+C10_DEFINE_int64(
+    caffe2_cpu_caching_allocator_global_cache_bytes,
+    64 << 20,
+    "Maximum number of bytes the caching CPU allocator keeps in the pool "
+    "shared by all threads");
+
+namespace c10 {
+namespace CPUCachingAllocator {
+
+namespace {
+
+// Every block starts with a header recording its size class, followed by
+// the memory handed out to the caller. The header is gAlignment bytes so the
+// returned pointer keeps the alignment alloc_cpu guarantees, and doubles as
+// the pre-guard QNNPACK needs.
+struct BlockHeader {
+  size_t size_class;
+  size_t nbytes;
+};
+
+constexpr size_t kHeaderSize = gAlignment;
+static_assert(sizeof(BlockHeader) <= kHeaderSize, "header does not fit");
+
+// XNNPACK may read up to 16 bytes past the end of a tensor.
+constexpr size_t kPostGuardBytes = 16;
+
+constexpr size_t kMinBlockSize = gAlignment;
+constexpr size_t kUncached = static_cast<size_t>(-1);
+
+constexpr size_t numSizeClasses(size_t size) {
+  return size >= kMaxCachedBlockSize ? 1 : 1 + numSizeClasses(size * 2);
+}
+
+constexpr size_t kNumSizeClasses = numSizeClasses(kMinBlockSize);
+
+using FreeLists = std::array<std::vector<void*>, kNumSizeClasses>;
+
+size_t block_size(size_t size_class) {
+  return kMinBlockSize << size_class;
+}
+
+size_t get_size_class(size_t nbytes) {
+  size_t size = nbytes + kPostGuardBytes;
+  if (size > kMaxCachedBlockSize) {
+    return kUncached;
+  }
+  size_t size_class = 0;
+  while (block_size(size_class) < size) {
+    ++size_class;
+  }
+  return size_class;
+}
+
+// Bytes obtained from alloc_cpu for a block, header included.
+size_t reserved_size(const BlockHeader* header) {
+  return kHeaderSize +
+      (header->size_class == kUncached ? header->nbytes + kPostGuardBytes
+                                       : block_size(header->size_class));
+}
+
+BlockHeader* header_of(void* data) {
+  return reinterpret_cast<BlockHeader*>(
+      static_cast<char*>(data) - kHeaderSize);
+}
+
+void* data_of(BlockHeader* header) {
+  return reinterpret_cast<char*>(header) + kHeaderSize;
+}
+
+// A Stat that is only ever written by the thread owning it, but may be read
+// concurrently by getStats(). Plain relaxed loads and stores are enough and
+// keep the fast path free of read-modify-write instructions.
+struct LocalStat {
+  std::atomic<int64_t> current{0};
+  std::atomic<int64_t> peak{0};
+  std::atomic<int64_t> allocated{0};
+  std::atomic<int64_t> freed{0};
+
+  void update(int64_t amount) {
+    int64_t value = current.load(std::memory_order_relaxed) + amount;
+    current.store(value, std::memory_order_relaxed);
+    if (value > peak.load(std::memory_order_relaxed)) {
+      peak.store(value, std::memory_order_relaxed);
+    }
+    if (amount > 0) {
+      bump(allocated, amount);
+    } else {
+      bump(freed, -amount);
+    }
+  }
+
+  static void bump(std::atomic<int64_t>& counter, int64_t amount) {
+    counter.store(
+        counter.load(std::memory_order_relaxed) + amount,
+        std::memory_order_relaxed);
+  }
+
+  void addTo(Stat& stat) const {
+    stat.current += current.load(std::memory_order_relaxed);
+    stat.peak += peak.load(std::memory_order_relaxed);
+    stat.allocated += allocated.load(std::memory_order_relaxed);
+    stat.freed += freed.load(std::memory_order_relaxed);
+  }
+};
+
+void update_stat(Stat& stat, int64_t amount) {
+  stat.current += amount;
+  stat.peak = std::max(stat.current, stat.peak);
+  if (amount > 0) {
+    stat.allocated += amount;
+  } else {
+    stat.freed += -amount;
+  }
+}
+
+struct ThreadCache;
+
+struct GlobalPool {
+  std::mutex mutex;
+  FreeLists blocks;
+  size_t cached_bytes = 0;
+  std::unordered_set<ThreadCache*> threads;
+  // statistics of threads that have exited, and of frees performed while a
+  // thread was tearing down its cache
+  Stats retired;
+  Stat reserved_bytes;
+
+  void* pop(size_t size_class) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& list = blocks[size_class];
+    if (list.empty()) {
+      return nullptr;
+    }
+    void* block = list.back();
+    list.pop_back();
+    cached_bytes -= block_size(size_class);
+    return block;
+  }
+
+  // Returns false if the pool is full and the caller should free the block.
+  bool push(size_t size_class, void* block) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return push_locked(size_class, block);
+  }
+
+  bool push_locked(size_t size_class, void* block) {
+    size_t size = block_size(size_class);
+    if (cached_bytes + size >
+        static_cast<size_t>(
+            FLAGS_caffe2_cpu_caching_allocator_global_cache_bytes)) {
+      return false;
+    }
+    blocks[size_class].push_back(block);
+    cached_bytes += size;
+    return true;
+  }
+
+  void record_reserved(int64_t amount) {
+    std::lock_guard<std::mutex> lock(mutex);
+    update_stat(reserved_bytes, amount);
+  }
+};
+
+// Leaked on purpose: thread caches flush into the pool when their thread
+// exits, which may happen after static destructors have run.
+GlobalPool& global_pool() {
+  static GlobalPool* pool = new GlobalPool();
+  return *pool;
+}
+
+void release_block(BlockHeader* header) {
+  int64_t size = reserved_size(header);
+  free_cpu(header);
+  global_pool().record_reserved(-size);
+}
+
+// Set once the calling thread's cache has been destroyed, so that storages
+// released later during thread teardown bypass it. It is trivially
+// destructible and therefore stays readable until the thread is gone.
+thread_local bool tls_cache_destroyed = false;
+
+struct ThreadCache {
+  FreeLists blocks;
+  size_t cached_bytes = 0;
+  LocalStat allocation;
+  LocalStat allocated_bytes;
+  std::atomic<int64_t> num_cache_hits{0};
+  std::atomic<int64_t> num_cache_misses{0};
+
+  ThreadCache() {
+    auto& pool = global_pool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    pool.threads.insert(this);
+  }
+
+  ~ThreadCache() {
+    tls_cache_destroyed = true;
+    std::vector<BlockHeader*> to_release;
+    auto& pool = global_pool();
+    {
+      std::lock_guard<std::mutex> lock(pool.mutex);
+      for (size_t size_class = 0; size_class < kNumSizeClasses; ++size_class) {
+        for (void* block : blocks[size_class]) {
+          if (!pool.push_locked(size_class, block)) {
+            to_release.push_back(static_cast<BlockHeader*>(block));
+          }
+        }
+      }
+      addStatsTo(pool.retired);
+      pool.threads.erase(this);
+    }
+    for (BlockHeader* header : to_release) {
+      release_block(header);
+    }
+  }
+
+  void* pop(size_t size_class) {
+    auto& list = blocks[size_class];
+    if (list.empty()) {
+      return nullptr;
+    }
+    void* block = list.back();
+    list.pop_back();
+    cached_bytes -= block_size(size_class);
+    return block;
+  }
+
+  bool push(size_t size_class, void* block) {
+    size_t size = block_size(size_class);
+    if (cached_bytes + size >
+        static_cast<size_t>(
+            FLAGS_caffe2_cpu_caching_allocator_thread_cache_bytes)) {
+      return false;
+    }
+    blocks[size_class].push_back(block);
+    cached_bytes += size;
+    return true;
+  }
+
+  void empty() {
+    for (size_t size_class = 0; size_class < kNumSizeClasses; ++size_class) {
+      for (void* block : blocks[size_class]) {
+        release_block(static_cast<BlockHeader*>(block));
+      }
+      blocks[size_class].clear();
+    }
+    cached_bytes = 0;
+  }
+
+  void addStatsTo(Stats& stats) const {
+    allocation.addTo(stats.allocation);
+    allocated_bytes.addTo(stats.allocated_bytes);
+    stats.num_cache_hits += num_cache_hits.load(std::memory_order_relaxed);
+    stats.num_cache_misses += num_cache_misses.load(std::memory_order_relaxed);
+  }
+};
+
+// Returns nullptr while the calling thread is being torn down.
+ThreadCache* local_cache() {
+  if (C10_UNLIKELY(tls_cache_destroyed)) {
+    return nullptr;
+  }
+  static thread_local ThreadCache cache;
+  return &cache;
+}
+
+void record_allocation(ThreadCache* cache, int64_t count, size_t nbytes) {
+  int64_t bytes = count * static_cast<int64_t>(nbytes);
+  if (C10_LIKELY(cache)) {
+    cache->allocation.update(count);
+    cache->allocated_bytes.update(bytes);
+  } else {
+    auto& pool = global_pool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    update_stat(pool.retired.allocation, count);
+    update_stat(pool.retired.allocated_bytes, bytes);
+  }
+}
+
+void fill_reused(void* data, size_t nbytes) {
+  // alloc_cpu applies these to fresh memory; do the same for reused blocks
+  // so that opting into caching does not change what callers observe.
+  if (FLAGS_caffe2_cpu_allocator_do_zero_fill) {
+    memset(data, 0, nbytes);
+  } else if (FLAGS_caffe2_cpu_allocator_do_junk_fill) {
+    memset_junk(data, nbytes);
+  }
+}
+
+struct CachingCPUAllocator final : public at::Allocator {
+  CachingCPUAllocator() = default;
+  ~CachingCPUAllocator() override = default;
+
+  at::DataPtr allocate(size_t nbytes) const override {
+    if (C10_UNLIKELY(nbytes == 0)) {
+      return {nullptr, nullptr, &deleter, at::Device(at::DeviceType::CPU)};
+    }
+
+    size_t size_class = get_size_class(nbytes);
+    ThreadCache* cache = local_cache();
+    void* block = nullptr;
+    if (size_class != kUncached) {
+      if (C10_LIKELY(cache)) {
+        block = cache->pop(size_class);
+      }
+      if (!block) {
+        block = global_pool().pop(size_class);
+      }
+    }
+
+    BlockHeader* header;
+    if (block) {
+      header = static_cast<BlockHeader*>(block);
+      fill_reused(data_of(header), nbytes);
+    } else {
+      BlockHeader proto{size_class, nbytes};
+      size_t size = reserved_size(&proto);
+      header = static_cast<BlockHeader*>(alloc_cpu(size));
+      global_pool().record_reserved(size);
+    }
+    header->size_class = size_class;
+    header->nbytes = nbytes;
+
+    if (C10_LIKELY(cache)) {
+      LocalStat::bump(
+          block ? cache->num_cache_hits : cache->num_cache_misses, 1);
+    } else {
+      auto& pool = global_pool();
+      std::lock_guard<std::mutex> lock(pool.mutex);
+      (block ? pool.retired.num_cache_hits : pool.retired.num_cache_misses)++;
+    }
+    record_allocation(cache, 1, nbytes);
+
+    void* data = data_of(header);
+    profiledCPUMemoryReporter().New(data, nbytes);
+    return {data, data, &deleter, at::Device(at::DeviceType::CPU)};
+  }
+
+  static void deleter(void* data) {
+    if (!data) {
+      return;
+    }
+    profiledCPUMemoryReporter().Delete(data);
+
+    BlockHeader* header = header_of(data);
+    ThreadCache* cache = local_cache();
+    record_allocation(cache, -1, header->nbytes);
+
+    size_t size_class = header->size_class;
+    if (size_class != kUncached) {
+      if (C10_LIKELY(cache) && cache->push(size_class, header)) {
+        return;
+      }
+      if (global_pool().push(size_class, header)) {
+        return;
+      }
+    }
+    release_block(header);
+  }
+
+  at::DeleterFnPtr raw_deleter() const override {
+    return &deleter;
+  }
+};
+
+} // namespace
+
+at::Allocator* get() {
+  static CachingCPUAllocator allocator;
+  return &allocator;
+}
+
+Stats getStats() {
+  auto& pool = global_pool();
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  Stats stats = pool.retired;
+  for (const ThreadCache* cache : pool.threads) {
+    cache->addStatsTo(stats);
+  }
+  stats.reserved_bytes = pool.reserved_bytes;
+  return stats;
+}
+
+void emptyCache() {
+  if (ThreadCache* cache = local_cache()) {
+    cache->empty();
+  }
+  std::vector<BlockHeader*> to_release;
+  auto& pool = global_pool();
+  {
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    for (auto& list : pool.blocks) {
+      for (void* block : list) {
+        to_release.push_back(static_cast<BlockHeader*>(block));
+      }
+      list.clear();
+    }
+    pool.cached_bytes = 0;
+  }
+  for (BlockHeader* header : to_release) {
+    release_block(header);
+  }
+}
+
+} // namespace CPUCachingAllocator
+
+at::Allocator* GetCPUCachingAllocator() {
+  return CPUCachingAllocator::get();
+}
+
+} // namespace c10
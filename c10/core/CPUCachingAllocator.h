@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <c10/core/Allocator.h>
+#include <c10/util/Flags.h>
+
+C10_DECLARE_int64(caffe2_cpu_caching_allocator_thread_cache_bytes);
+C10_DECLARE_int64(caffe2_cpu_caching_allocator_global_cache_bytes);
+
+namespace c10 {
+
+// Caching CPU allocator
+//
+// DefaultCPUAllocator goes to posix_memalign / free for every storage, which
+// for workloads that churn through many small temporaries means the malloc
+// arena locks (and the page faults of freshly mmap'ed memory) show up on
+// profiles, especially once intra-op threads allocate concurrently.
+//
+// This allocator keeps freed blocks in power-of-two size classes (gAlignment
+// up to kMaxCachedBlockSize) and hands them out again without touching the
+// system allocator:
+//
+// - Each thread owns a free list per size class. Allocating from and freeing
+//   to it takes no lock. A block freed on another thread than the one that
+//   allocated it simply lands in the freeing thread's cache.
+// - When a thread's cache holds more than
+//   FLAGS_caffe2_cpu_caching_allocator_thread_cache_bytes, further frees go
+//   to a mutex-protected global pool, which other threads fall back to
+//   before calling into the system allocator. Once the global pool holds
+//   FLAGS_caffe2_cpu_caching_allocator_global_cache_bytes, blocks are
+//   returned to the system.
+// - When a thread exits its cache is moved to the global pool (up to the
+//   same limit).
+// - Requests larger than kMaxCachedBlockSize are not cached.
+//
+// Every block carries a gAlignment-sized header in front of the returned
+// pointer and at least 16 bytes of slack behind it, so memory from this
+// allocator is also safe for the out-of-bound reads performed by QNNPACK and
+// XNNPACK (see DefaultMobileCPUAllocator).
+//
+// The allocator is not installed by default. To use it, do
+//
+//   c10::SetCPUAllocator(c10::GetCPUCachingAllocator());
+//
+// before allocating any tensors.
+
+namespace CPUCachingAllocator {
+
+constexpr size_t kMaxCachedBlockSize = 1 << 20; // 1 MiB
+
+struct Stat {
+  int64_t current = 0;
+  int64_t peak = 0;
+  int64_t allocated = 0;
+  int64_t freed = 0;
+};
+
+// Counterpart of c10::cuda::CUDACachingAllocator::DeviceStats.
+struct Stats {
+  // COUNT: allocations handed out by the allocator
+  Stat allocation;
+  // SUM: bytes requested by those allocations
+  Stat allocated_bytes;
+  // SUM: bytes obtained from the system allocator, including cached blocks
+  Stat reserved_bytes;
+
+  // COUNT: allocations served from a thread cache or the global pool
+  int64_t num_cache_hits = 0;
+  // COUNT: allocations that had to call into the system allocator
+  int64_t num_cache_misses = 0;
+};
+
+// Returns the allocator; the pointer stays valid for the lifetime of the
+// process.
+C10_API at::Allocator* get();
+
+// Process-wide statistics. Counts and sums are exact; because allocations
+// are tracked per thread, allocation.peak and allocated_bytes.peak are the
+// sum of the per-thread peaks and therefore an upper bound.
+C10_API Stats getStats();
+
+// Returns the blocks cached by the calling thread and by the global pool to
+// the system. Blocks cached by other threads are left alone.
+C10_API void emptyCache();
+
+} // namespace CPUCachingAllocator
+
+C10_API at::Allocator* GetCPUCachingAllocator();
+
+} // namespace c10
@@ -52,6 +52,10 @@ const char* toString(DispatchKey t) {
       return "SparseCUDA";
     case DispatchKey::SparseHIP:
       return "SparseHIP";
+    case DispatchKey::SparseCsrCPU:
+      return "SparseCsrCPU";
+    case DispatchKey::SparseCsrCUDA:
+      return "SparseCsrCUDA";
 
     case DispatchKey::PrivateUse1:
       return "PrivateUse1";
@@ -60,6 +64,9 @@ const char* toString(DispatchKey t) {
     case DispatchKey::PrivateUse3:
       return "PrivateUse3";
 
+    case DispatchKey::Lazy:
+      return "Lazy";
+
     case DispatchKey::Meta:
       return "Meta";
 
@@ -79,6 +86,8 @@ const char* toString(DispatchKey t) {
 
     case DispatchKey::Autocast:
       return "Autocast";
+    case DispatchKey::AutocastCPU:
+      return "AutocastCPU";
 
     case DispatchKey::PrivateUse1_PreAutograd:
       return "PrivateUse1_PreAutograd";
@@ -99,6 +99,8 @@ enum class DispatchKey : uint8_t {
   SparseCUDA, // registered at build/aten/src/ATen/SparseCUDAType.cpp
   SparseHIP, // TODO: I think this is not actually used, due to Note
              // [Masquerading as CUDA]
+  SparseCsrCPU, // registered at build/aten/src/ATen/SparseCsrCPUType.cpp
+  SparseCsrCUDA, // registered at build/aten/src/ATen/SparseCsrCUDAType.cpp
 
   // Here are reserved backends for user-defined backends, see Note [Private use
   // DispatchKey]
@@ -107,6 +109,13 @@ enum class DispatchKey : uint8_t {
   PrivateUse2,
   PrivateUse3,
 
+  // Lazy tensors record the ops run on them into a graph instead of running
+  // them, and run the graph when their values are needed. They multi-dispatch
+  // with the dense tensors they are mixed with, so this key must be handled
+  // before those of the dense backends. See
+  // torch/csrc/jit/runtime/lazy_tensor.h
+  Lazy,
+
   // The meta function characterizes how an operation affects the metadata of a
   // tensor (shape, dtype) without doing any of the actual computation.  A
   // meta tensor can be used to dry run operators without actually doing
@@ -206,7 +215,10 @@ enum class DispatchKey : uint8_t {
 
   // Autocasting precedes VariableTypeId, to ensure casts are autograd-exposed
   // and inputs are saved for backward in the post-autocast type.
+  // Autocast casts CUDA tensors (to fp16), AutocastCPU casts CPU tensors (to
+  // bf16); the two are enabled independently.
   Autocast,
+  AutocastCPU,
 
   // Here are some reserved pre-autograd keys for user-defined backends, see
   // Note [Private use DispatchKey]
@@ -1 +1,13 @@
 #include <c10/core/StorageImpl.h>
+
+namespace c10 {
+
+void* StorageImpl::operator new(size_t size) {
+  return impl::allocatePooledObject(impl::PooledObject::StorageImpl, size);
+}
+
+void StorageImpl::operator delete(void* ptr, size_t /* size */) noexcept {
+  impl::deallocatePooledObject(impl::PooledObject::StorageImpl, ptr);
+}
+
+} // namespace c10
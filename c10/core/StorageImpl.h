@@ -2,6 +2,7 @@
 
 #include <c10/core/Allocator.h>
 #include <c10/core/ScalarType.h>
+#include <c10/core/impl/ObjectPool.h>
 
 #include <c10/util/intrusive_ptr.h>
 
@@ -47,6 +48,10 @@ struct C10_API StorageImpl final : public c10::intrusive_ptr_target {
   StorageImpl(const StorageImpl&) = delete;
   ~StorageImpl() = default;
 
+  // Allocated from the object pools of c10/core/impl/ObjectPool.h.
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr, size_t size) noexcept;
+
   void reset() {
     data_ptr_.clear();
     size_bytes_ = 0;
@@ -167,6 +172,18 @@ struct C10_API StorageImpl final : public c10::intrusive_ptr_target {
     return received_cuda_;
   }
 
+  // The data of a read-only storage, e.g. that of a non-writeable NumPy array
+  // viewed by tensors, must not be written. The autograd wrappers of the ops
+  // check this for the arguments they modify (see check_writeable in
+  // torch/csrc/autograd/VariableTypeUtils.h); the kernels don't.
+  bool read_only() const {
+    return read_only_;
+  }
+
+  void set_read_only(bool read_only) {
+    read_only_ = read_only;
+  }
+
  private:
   DataPtr data_ptr_;
   size_t size_bytes_;
@@ -174,6 +191,7 @@ struct C10_API StorageImpl final : public c10::intrusive_ptr_target {
   // Identifies that Storage was received from another process and doesn't have
   // local to process cuda memory allocation
   bool received_cuda_;
+  bool read_only_ = false;
   Allocator* allocator_;
 };
 } // namespace c10
@@ -12,6 +12,9 @@
 
 namespace c10 {
 
+// Forward declaration
+class DataPtr;
+
 /**
  * Flags defining the behavior of events.
  *
@@ -109,6 +112,14 @@ struct C10_API DeviceGuardImplInterface {
     TORCH_CHECK(false, "Backend doesn't support acquiring a default stream.")
   }
 
+  /**
+   * Get a stream from the pool of streams of a given device, which is not
+   * the current one of any thread unless it is made so.
+   */
+  virtual Stream getStreamFromPool(Device, bool isHighPriority = false) const {
+    TORCH_CHECK(false, "Backend doesn't support acquiring a stream from pool.")
+  }
+
   /**
    * Set a stream to be the thread local current stream for its device.
    * Return the previous stream for that device. You are NOT required
@@ -145,6 +156,15 @@ struct C10_API DeviceGuardImplInterface {
  * When the stream reaches this command it will stop processing
  * additional commands until that version of the event is marked as recorded.
  */
+  /**
+   * Ensure the caching allocator (if any) is aware that the given DataPtr is
+   * being used on the given stream, and that it should thus avoid recycling
+   * the DataPtr until all work on that stream is done.
+   */
+  virtual void recordDataPtrOnStream(
+    const c10::DataPtr&,
+    const Stream&) const { }
+
   virtual void block(
     void* event,
     const Stream& stream) const {
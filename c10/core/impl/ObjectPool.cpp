@@ -0,0 +1,94 @@
+#include <c10/core/impl/ObjectPool.h>
+
+#include <new>
+
+C10_DEFINE_bool(
+    caffe2_pool_tensor_objects,
+    false,
+    "If set, reuses the memory of the TensorImpls and StorageImpls freed by a "
+    "thread for those it allocates.");
+
+namespace c10 {
+namespace impl {
+
+namespace {
+
+constexpr size_t kNumPooledObjects =
+    static_cast<size_t>(PooledObject::NumPooledObjects);
+constexpr uint32_t kMaxPooledBlocks = 4096;
+
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+struct ThreadPools {
+  FreeBlock* head[kNumPooledObjects];
+  uint32_t size[kNumPooledObjects];
+  bool cleanupRegistered;
+  bool exited;
+};
+
+// Trivially constructible and destructible so that accessing it needs no
+// guard, and that the destructors of thread locals which run after the cleanup
+// below, and which may free tensors, can still see that the thread exited.
+thread_local ThreadPools pools{};
+
+struct ThreadPoolsCleanup {
+  ~ThreadPoolsCleanup() {
+    for (size_t kind = 0; kind < kNumPooledObjects; ++kind) {
+      FreeBlock* block = pools.head[kind];
+      while (block != nullptr) {
+        FreeBlock* next = block->next;
+        ::operator delete(block);
+        block = next;
+      }
+      pools.head[kind] = nullptr;
+      pools.size[kind] = 0;
+    }
+    pools.exited = true;
+  }
+
+  // Accessing the thread local constructs it, which registers its destructor.
+  void registerCleanup() {}
+};
+
+thread_local ThreadPoolsCleanup cleanup;
+
+} // namespace
+
+void* allocatePooledObject(PooledObject kind, size_t size) {
+  const auto k = static_cast<size_t>(kind);
+  ThreadPools& p = pools;
+  FreeBlock* block = p.head[k];
+  if (block != nullptr) {
+    p.head[k] = block->next;
+    --p.size[k];
+    return block;
+  }
+  return ::operator new(size);
+}
+
+void deallocatePooledObject(PooledObject kind, void* ptr) noexcept {
+  const auto k = static_cast<size_t>(kind);
+  ThreadPools& p = pools;
+  if (FLAGS_caffe2_pool_tensor_objects && !p.exited &&
+      p.size[k] < kMaxPooledBlocks) {
+    if (C10_UNLIKELY(!p.cleanupRegistered)) {
+      cleanup.registerCleanup();
+      p.cleanupRegistered = true;
+    }
+    auto* block = static_cast<FreeBlock*>(ptr);
+    block->next = p.head[k];
+    p.head[k] = block;
+    ++p.size[k];
+    return;
+  }
+  ::operator delete(ptr);
+}
+
+size_t pooledObjectCount(PooledObject kind) {
+  return pools.size[static_cast<size_t>(kind)];
+}
+
+} // namespace impl
+} // namespace c10
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <c10/macros/Macros.h>
+#include <c10/util/Flags.h>
+
+C10_DECLARE_bool(caffe2_pool_tensor_objects);
+
+namespace c10 {
+namespace impl {
+
+// The classes whose objects are allocated from the object pools, by their
+// class-specific operator new and operator delete. Every op output creates a
+// TensorImpl and usually a StorageImpl, so with tiny tensors their malloc and
+// free are a noticeable part of the cost of an op.
+enum class PooledObject : uint8_t {
+  TensorImpl,
+  StorageImpl,
+  NumPooledObjects,
+};
+
+// Every thread keeps a free list of up to a few thousand blocks per kind of
+// object. Objects are allocated from the free list of the allocating thread
+// and returned to that of the thread that destroys them, which needs no
+// synchronization and works for objects that cross threads since all the
+// blocks of a kind have the same size and come from ::operator new. The free
+// lists of a thread are released when it exits.
+//
+// All the objects of a kind must have the same size; an operator new of a
+// class with subclasses only uses the pool for objects of that class' size.
+// Blocks are only returned to the pools when caffe2_pool_tensor_objects is
+// set, which may change at any time since pooled and unpooled blocks can be
+// freed either way.
+C10_API void* allocatePooledObject(PooledObject kind, size_t size);
+C10_API void deallocatePooledObject(PooledObject kind, void* ptr) noexcept;
+
+// The number of blocks in the free list of the current thread, for tests.
+C10_API size_t pooledObjectCount(PooledObject kind);
+
+} // namespace impl
+} // namespace c10
@@ -0,0 +1,106 @@
+#include <c10/core/thread_budget.h>
+
+#include <c10/util/Exception.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace c10 {
+
+const char* toString(ThreadPoolKind kind) {
+  switch (kind) {
+    case ThreadPoolKind::IntraOp:
+      return "intra_op";
+    case ThreadPoolKind::InterOp:
+      return "inter_op";
+    case ThreadPoolKind::Autograd:
+      return "autograd";
+    case ThreadPoolKind::Distributed:
+      return "distributed";
+    default:
+      break;
+  }
+  TORCH_INTERNAL_ASSERT(
+      false, "Unknown thread pool kind ", static_cast<int>(kind));
+  return "";
+}
+
+ThreadBudget& ThreadBudget::global() {
+  // Leaky, as pools release threads from static destructors.
+  static ThreadBudget* budget = new ThreadBudget();
+  return *budget;
+}
+
+ThreadBudget::ThreadBudget() : cap_(0) {
+  threads_.fill(0);
+  if (const char* env = std::getenv("TORCH_THREAD_BUDGET")) {
+    char* end = nullptr;
+    long long cap = std::strtoll(env, &end, 10);
+    TORCH_CHECK(
+        end != env && *end == '\0' && cap >= 0,
+        "TORCH_THREAD_BUDGET must be a non-negative integer, got '",
+        env,
+        "'");
+    cap_ = static_cast<size_t>(cap);
+  }
+}
+
+void ThreadBudget::setCap(size_t cap) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  cap_ = cap;
+}
+
+size_t ThreadBudget::cap() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return cap_;
+}
+
+size_t ThreadBudget::acquire(
+    ThreadPoolKind kind,
+    size_t requested,
+    size_t minimum) {
+  minimum = std::min(minimum, requested);
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t granted = requested;
+  if (cap_ > 0) {
+    size_t total = 0;
+    for (auto threads : threads_) {
+      total += threads;
+    }
+    size_t left = cap_ > total ? cap_ - total : 0;
+    granted = std::max(minimum, std::min(requested, left));
+  }
+  threads_[static_cast<size_t>(kind)] += granted;
+  return granted;
+}
+
+void ThreadBudget::release(ThreadPoolKind kind, size_t count) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& threads = threads_[static_cast<size_t>(kind)];
+  TORCH_INTERNAL_ASSERT(
+      threads >= count,
+      "Releasing ",
+      count,
+      " ",
+      toString(kind),
+      " threads, but only ",
+      threads,
+      " were acquired");
+  threads -= count;
+}
+
+size_t ThreadBudget::numThreads(ThreadPoolKind kind) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return threads_[static_cast<size_t>(kind)];
+}
+
+size_t ThreadBudget::numThreads() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t total = 0;
+  for (auto threads : threads_) {
+    total += threads;
+  }
+  return total;
+}
+
+} // namespace c10
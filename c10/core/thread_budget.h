@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <mutex>
+
+#include <c10/macros/Macros.h>
+
+namespace c10 {
+
+// The thread pools of the process that draw from the ThreadBudget.
+enum class ThreadPoolKind : int {
+  // The intra-op pool of the native backend, or the OpenMP team.
+  IntraOp = 0,
+  // The inter-op pool of at::launch.
+  InterOp,
+  // The device, CPU worker and reentrant threads of the autograd engine.
+  Autograd,
+  // The thread pools of the RPC agents.
+  Distributed,
+  NumKinds,
+};
+
+C10_API const char* toString(ThreadPoolKind kind);
+
+/**
+ * The process-wide budget of the worker threads of the thread pools above.
+ *
+ * Every pool sizes itself independently, mostly to the number of cores, so a
+ * process running intra-op, inter-op, autograd and RPC work can easily run
+ * several times as many threads as there are cores. Pools ask the budget for
+ * the threads they start and give them back when they stop them, so that
+ * numThreads() reports the threads of every kind, and, once a cap is set
+ * with setCap() or the TORCH_THREAD_BUDGET environment variable, a pool gets
+ * no more threads than what is left of the cap, first come first served.
+ * Threads a pool cannot work without, e.g. the autograd thread of every
+ * device, are counted but always granted.
+ *
+ * The cap only applies to pools started after it is set: pools are never
+ * shrunk.
+ */
+class C10_API ThreadBudget {
+ public:
+  static ThreadBudget& global();
+
+  // Sets the cap on the sum of the threads of all pools; 0 removes it.
+  void setCap(size_t cap);
+  size_t cap() const;
+
+  // Grants a pool of the kind between `minimum` and `requested` threads,
+  // depending on what is left of the cap, and returns the number granted.
+  size_t acquire(ThreadPoolKind kind, size_t requested, size_t minimum = 1);
+  // Gives back threads granted by acquire().
+  void release(ThreadPoolKind kind, size_t count);
+
+  size_t numThreads(ThreadPoolKind kind) const;
+  size_t numThreads() const;
+
+ private:
+  ThreadBudget();
+
+  mutable std::mutex mutex_;
+  size_t cap_;
+  std::array<size_t, static_cast<size_t>(ThreadPoolKind::NumKinds)> threads_;
+};
+
+} // namespace c10
@@ -132,6 +132,162 @@ void ThreadPool::main_loop(std::size_t index) {
   } // while running_
 }
 
+namespace {
+// The work stealing pool the calling thread belongs to, if any, and its
+// index in that pool.
+thread_local const WorkStealingThreadPool* current_ws_pool_ = nullptr;
+thread_local std::size_t current_ws_index_ = 0;
+} // namespace
+
+WorkStealingThreadPool::WorkStealingThreadPool(
+    int pool_size,
+    int numa_node_id,
+    std::function<void()> init_thread)
+    : threads_(pool_size < 0 ? defaultNumThreads() : pool_size),
+      running_(true),
+      pending_(0),
+      available_(threads_.size()),
+      next_worker_(0),
+      numa_node_id_(numa_node_id) {
+  for (std::size_t i = 0; i < threads_.size(); ++i) {
+    workers_.emplace_back(new Worker());
+  }
+  for (std::size_t i = 0; i < threads_.size(); ++i) {
+    threads_[i] = std::thread([this, i, init_thread]() {
+      if (init_thread) {
+        init_thread();
+      }
+      this->main_loop(i);
+    });
+  }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    running_ = false;
+    condition_.notify_all();
+  }
+
+  for (auto& t : threads_) {
+    try {
+      t.join();
+    } catch (const std::exception&) {
+    }
+  }
+}
+
+size_t WorkStealingThreadPool::size() const {
+  return threads_.size();
+}
+
+size_t WorkStealingThreadPool::numAvailable() const {
+  return available_.load();
+}
+
+bool WorkStealingThreadPool::inThreadPool() const {
+  return current_ws_pool_ == this;
+}
+
+void WorkStealingThreadPool::run(std::function<void()> func) {
+  runWithPriority(std::move(func), 0);
+}
+
+void WorkStealingThreadPool::runWithPriority(
+    std::function<void()> func,
+    int64_t priority) {
+  if (threads_.size() == 0) {
+    throw std::runtime_error("No threads to run a task");
+  }
+  std::size_t index = inThreadPool()
+      ? current_ws_index_
+      : next_worker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+  {
+    std::lock_guard<std::mutex> lock(workers_[index]->mutex);
+    auto& tasks = workers_[index]->tasks;
+    if (tasks.empty() || tasks.back().priority <= priority) {
+      tasks.push_back(Task{priority, std::move(func)});
+    } else {
+      auto it = std::upper_bound(
+          tasks.begin(),
+          tasks.end(),
+          priority,
+          [](int64_t p, const Task& t) { return p < t.priority; });
+      tasks.insert(it, Task{priority, std::move(func)});
+    }
+  }
+  // Bump pending_ under mutex_ so that a worker checking it right before
+  // going to sleep cannot miss the notification.
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++pending_;
+  }
+  condition_.notify_one();
+}
+
+bool WorkStealingThreadPool::pop_task(
+    std::size_t index,
+    std::function<void()>& task) {
+  {
+    Worker& own = *workers_[index];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back().func);
+      own.tasks.pop_back();
+      --pending_;
+      return true;
+    }
+  }
+  for (std::size_t offset = 1; offset < workers_.size(); ++offset) {
+    Worker& victim = *workers_[(index + offset) % workers_.size()];
+    std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+    if (lock.owns_lock() && !victim.tasks.empty()) {
+      if (victim.tasks.back().priority > victim.tasks.front().priority) {
+        task = std::move(victim.tasks.back().func);
+        victim.tasks.pop_back();
+      } else {
+        task = std::move(victim.tasks.front().func);
+        victim.tasks.pop_front();
+      }
+      --pending_;
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingThreadPool::main_loop(std::size_t index) {
+  current_ws_pool_ = this;
+  current_ws_index_ = index;
+  while (true) {
+    {
+      std::function<void()> task;
+      if (pop_task(index, task)) {
+        --available_;
+        try {
+          task();
+        } catch (const std::exception& e) {
+          LOG(ERROR) << "Exception in thread pool task: " << e.what();
+        } catch (...) {
+          LOG(ERROR) << "Exception in thread pool task: unknown";
+        }
+        ++available_;
+        continue;
+      }
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    // pending_ may be non-zero while every deque we tried was locked by a
+    // concurrent thief; in that case simply go around again.
+    while (running_ && pending_.load() == 0) {
+      condition_.wait(lock);
+    }
+    if (!running_ && pending_.load() == 0) {
+      break;
+    }
+  }
+}
+
 C10_DEFINE_SHARED_REGISTRY(
     ThreadPoolRegistry,
     TaskThreadPoolBase,
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <thread>
@@ -19,6 +23,14 @@ class C10_API TaskThreadPoolBase {
  public:
   virtual void run(std::function<void()> func) = 0;
 
+  /**
+   * Runs func ahead of the queued tasks of lower priority in the pools that
+   * support priorities; the others run it as run() does.
+   */
+  virtual void runWithPriority(std::function<void()> func, int64_t priority) {
+    run(std::move(func));
+  }
+
   virtual size_t size() const = 0;
 
   /**
@@ -114,6 +126,82 @@ class C10_API TaskThreadPool : public c10::ThreadPool {
       }) {}
 };
 
+/**
+ * A thread pool in which every worker owns a task deque.
+ *
+ * ThreadPool funnels all submissions and all workers through one mutex-guarded
+ * queue. Here a task submitted from a worker thread is pushed onto that
+ * worker's own deque and a task submitted from outside goes to the workers'
+ * deques round robin. Workers pop from the back of their own deque (most
+ * recently submitted, hence cache-warm, work first) and, once it is empty,
+ * steal from the front of the others'. The pool-wide mutex is only taken to
+ * put idle workers to sleep and to wake them up.
+ *
+ * Each deque is kept sorted by priority (the tasks submitted with run() have
+ * priority 0), so workers pop the highest priority task of their own deque,
+ * and thieves take it too if it has a higher priority than the task at the
+ * front of the victim's deque.
+ */
+class C10_API WorkStealingThreadPool : public c10::TaskThreadPoolBase {
+ public:
+  WorkStealingThreadPool() = delete;
+
+  explicit WorkStealingThreadPool(
+      int pool_size,
+      int numa_node_id = -1,
+      std::function<void()> init_thread = nullptr);
+
+  ~WorkStealingThreadPool();
+
+  size_t size() const override;
+
+  size_t numAvailable() const override;
+
+  bool inThreadPool() const override;
+
+  void run(std::function<void()> func) override;
+
+  void runWithPriority(std::function<void()> func, int64_t priority) override;
+
+ private:
+  struct Task {
+    int64_t priority;
+    std::function<void()> func;
+  };
+
+  struct Worker {
+    std::mutex mutex;
+    // Sorted by increasing priority, in submission order among equal ones.
+    std::deque<Task> tasks;
+  };
+
+  bool pop_task(std::size_t index, std::function<void()>& task);
+
+  // @brief Entry point for pool threads.
+  void main_loop(std::size_t index);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  bool running_;
+  std::atomic<std::size_t> pending_;
+  std::atomic<std::size_t> available_;
+  std::atomic<std::size_t> next_worker_;
+  int numa_node_id_;
+};
+
+class C10_API WorkStealingTaskThreadPool : public c10::WorkStealingThreadPool {
+ public:
+  explicit WorkStealingTaskThreadPool(
+      std::size_t pool_size,
+      int numa_node_id = -1)
+      : WorkStealingThreadPool(pool_size, numa_node_id, [numa_node_id](){
+        setThreadName("CaffeTaskThread");
+        NUMABind(numa_node_id);
+      }) {}
+};
+
 C10_DECLARE_SHARED_REGISTRY(
     ThreadPoolRegistry,
     TaskThreadPoolBase,
@@ -1,19 +1,29 @@
 #include <c10/cuda/CUDACachingAllocator.h>
 
 #include <c10/cuda/CUDAGuard.h>
+#include <c10/cuda/CUDADriverAPI.h>
 #include <c10/cuda/CUDAException.h>
 #include <c10/cuda/CUDAFunctions.h>
+#include <c10/util/Backtrace.h>
+#include <c10/util/Metrics.h>
+#include <c10/util/Optional.h>
 #include <c10/util/UniqueVoidPtr.h>
+#include <c10/util/llvmMathExtras.h>
 
 #include <cuda_runtime_api.h>
 #include <algorithm>
+#include <atomic>
 #include <bitset>
+#include <chrono>
+#include <cstdlib>
 #include <deque>
 #include <iterator>
+#include <limits>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <set>
+#include <sstream>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -40,6 +50,19 @@ namespace CUDACachingAllocator {
 //   smallest available free block or allocate a new block using cudaMalloc.
 //   To reduce fragmentation, requests between 1MB and 10MB will allocate and
 //   split a 20MB block, if no free block of sufficient size is available.
+//   All of these thresholds can be changed through PYTORCH_CUDA_ALLOC_CONF
+//   or setAllocatorSettings(), see CachingAllocatorConfig.
+// - Blocks of at least max_split_size bytes ("oversize" blocks) are never
+//   split and are only reused for requests of a similar size. This keeps
+//   very large segments from being carved up by small requests.
+// - setMemoryFraction() caps the memory reserved on a device. Requests that
+//   would exceed the cap fail as if the device were out of memory. Before
+//   giving up, the allocator first releases only as many of the least
+//   recently freed cached segments as needed, and only then all of them.
+// - With a cap and garbage_collection_threshold set, least recently freed
+//   cached segments are also released whenever the reserved memory exceeds
+//   that fraction of the cap, so that the cache shrinks gradually instead of
+//   all at once on the first OOM.
 //
 // With this allocator, allocations and frees should logically be considered
 // "usages" of the memory segment associated with streams, just like kernel
@@ -51,6 +74,30 @@ namespace CUDACachingAllocator {
 // ensure that the block is not reused before each recorded stream completes
 // work.
 //
+// With PYTORCH_CUDA_ALLOC_CONF=cross_stream_reuse:True, a request that finds
+// no cached block on its stream does not wait for that work to complete
+// before it falls back to cudaMalloc. Instead:
+// - blocks of the same stream that are only held back by recordStream() uses
+//   are released by making the stream wait (cudaStreamWaitEvent) on the
+//   events recorded for those uses, and
+// - an unsplit cached segment of another stream is handed over to the
+//   requesting stream, which first waits on an event recorded on the
+//   segment's old stream.
+// Both only order work on the GPU; the host never blocks.
+//
+// Expandable segments (PYTORCH_CUDA_ALLOC_CONF=expandable_segments:True):
+//
+// - Instead of one cudaMalloc per segment, the allocator reserves a virtual
+//   address range large enough for the whole device once per stream and pool,
+//   and backs it with physical pages (cuMemCreate/cuMemMap) on demand.
+// - Free space at the end of a segment is therefore always adjacent to the
+//   rest of the segment, so a request that is larger than any cached block
+//   can be satisfied by mapping more pages behind the last free block rather
+//   than by a fresh cudaMalloc. Freed pages are unmapped by emptyCache() and
+//   on OOM, and the address range stays reserved.
+// - Blocks that cover unmapped address space are kept in a separate set per
+//   pool so that they are never returned by the normal best-fit search.
+//
 
 
 namespace {
@@ -58,6 +105,8 @@ namespace {
 using stream_set = std::unordered_set<cuda::CUDAStream>;
 
 constexpr size_t kMinBlockSize = 512;       // all sizes are rounded to at least 512 bytes
+
+// defaults for the thresholds in CachingAllocatorConfig
 constexpr size_t kSmallSize = 1048576;      // largest "small" allocation is 1 MiB
 constexpr size_t kSmallBuffer = 2097152;    // "small" allocations are packed in 2 MiB blocks
 constexpr size_t kLargeBuffer = 20971520;   // "large" allocations may be packed in 20 MiB blocks
@@ -98,8 +147,20 @@ void update_stat_array(StatArray& stat_array, int64_t amount, const StatTypes& s
 }
 
 struct Block;
+struct ExpandableSegment;
+struct PrivatePool;
 typedef bool (*Comparison)(const Block*, const Block*);
-typedef std::set<Block*, Comparison> BlockPool;
+
+struct BlockPool : public std::set<Block*, Comparison> {
+  BlockPool(Comparison comparator, bool small, PrivatePool* private_pool = nullptr) :
+    std::set<Block*, Comparison>(comparator),
+    is_small(small),
+    owner_PrivatePool(private_pool) {}
+
+  const bool is_small;
+  // the graph pool this pool belongs to, or nullptr for the default pools
+  PrivatePool* const owner_PrivatePool;
+};
 
 struct Block {
   int           device;      // gpu
@@ -112,19 +173,36 @@ struct Block {
   Block*        prev;        // prev block if split from a larger allocation
   Block*        next;        // next block if split from a larger allocation
   int           event_count; // number of outstanding CUDA events
+  bool          mapped;      // false if the address range has no physical pages
+  ExpandableSegment* expandable_segment; // owning segment, if expandable
+  uint64_t      free_tick;   // when the block was last returned to its pool
 
   Block(int device, cudaStream_t stream, size_t size, BlockPool* pool, void* ptr) :
     device(device), stream(stream), stream_uses(), size(size), pool(pool),
-    ptr(ptr), allocated(0), prev(nullptr), next(nullptr), event_count(0) { }
+    ptr(ptr), allocated(0), prev(nullptr), next(nullptr), event_count(0),
+    mapped(true), expandable_segment(nullptr), free_tick(0) { }
 
   // constructor for search key
   Block(int device, cudaStream_t stream, size_t size) :
     device(device), stream(stream), stream_uses(), size(size), pool(nullptr),
-    ptr(nullptr), allocated(0), prev(nullptr), next(nullptr), event_count(0) { }
+    ptr(nullptr), allocated(0), prev(nullptr), next(nullptr), event_count(0),
+    mapped(true), expandable_segment(nullptr), free_tick(0) { }
 
   bool is_split() const {
     return (prev != nullptr) || (next != nullptr);
   }
+
+  // links this block in between before and after
+  void splice(Block* before, Block* after) {
+    if (before) {
+      before->next = this;
+    }
+    prev = before;
+    if (after) {
+      after->prev = this;
+    }
+    next = after;
+  }
 };
 
 static bool BlockComparator(const Block* a, const Block* b)
@@ -157,6 +235,439 @@ static std::string format_size(uint64_t size) {
   return os.str();
 }
 
+// Parses PYTORCH_CUDA_ALLOC_CONF, a comma separated list of option:value pairs,
+// e.g. PYTORCH_CUDA_ALLOC_CONF=max_split_size_mb:256,roundup_power2_divisions:4
+//
+//   expandable_segments      grow segments by mapping pages (default False)
+//   max_split_size_mb        blocks this large or larger are never split
+//                            (default unlimited)
+//   roundup_power2_divisions round requests up to one of N equal divisions
+//                            between consecutive powers of two (default 0, off)
+//   small_size_mb            largest allocation served from the small pool (1)
+//   small_buffer_mb          size of the segments of the small pool (2)
+//   large_buffer_mb          size of the segments used for requests smaller
+//                            than min_large_alloc_mb (20)
+//   min_large_alloc_mb       smallest request that gets its own segment (10)
+//   round_large_mb           rounding of the segments of large requests (2)
+//   garbage_collection_threshold
+//                            with a memory fraction set, release least
+//                            recently freed cached segments once reserved
+//                            memory exceeds this fraction of the cap
+//                            (0 < value < 1, default 0, off)
+//   cross_stream_reuse       reuse blocks held by other streams by inserting
+//                            cudaStreamWaitEvent (default False)
+//
+// The same string can be passed to setAllocatorSettings(). Settings only
+// affect allocations made after they are applied; blocks already cached keep
+// the pool and size they were created with.
+class CachingAllocatorConfig {
+ public:
+  static bool expandable_segments() {
+    return instance().m_expandable_segments;
+  }
+
+  static size_t max_split_size() {
+    return instance().m_max_split_size;
+  }
+
+  static size_t roundup_power2_divisions() {
+    return instance().m_roundup_power2_divisions;
+  }
+
+  static size_t small_size() {
+    return instance().m_small_size;
+  }
+
+  static size_t small_buffer() {
+    return instance().m_small_buffer;
+  }
+
+  static size_t large_buffer() {
+    return instance().m_large_buffer;
+  }
+
+  static size_t min_large_alloc() {
+    return instance().m_min_large_alloc;
+  }
+
+  static size_t round_large() {
+    return instance().m_round_large;
+  }
+
+  static double garbage_collection_threshold() {
+    return instance().m_garbage_collection_threshold;
+  }
+
+  static bool cross_stream_reuse() {
+    return instance().m_cross_stream_reuse;
+  }
+
+  static void setAllocatorSettings(const std::string& env) {
+    std::lock_guard<std::mutex> lock(instance().m_mutex);
+    instance().parseArgs(env.c_str());
+  }
+
+ private:
+  static CachingAllocatorConfig& instance() {
+    static CachingAllocatorConfig* s_instance = ([]() {
+      auto inst = new CachingAllocatorConfig();
+      inst->parseArgs(std::getenv("PYTORCH_CUDA_ALLOC_CONF"));
+      return inst;
+    })();
+    return *s_instance;
+  }
+
+  CachingAllocatorConfig()
+      : m_expandable_segments(false),
+        m_max_split_size(std::numeric_limits<size_t>::max()),
+        m_roundup_power2_divisions(0),
+        m_small_size(kSmallSize),
+        m_small_buffer(kSmallBuffer),
+        m_large_buffer(kLargeBuffer),
+        m_min_large_alloc(kMinLargeAlloc),
+        m_round_large(kRoundLarge),
+        m_garbage_collection_threshold(0),
+        m_cross_stream_reuse(false) {}
+
+  static bool parseBool(const std::string& option, const std::string& value) {
+    TORCH_CHECK(value == "True" || value == "False" || value == "1" || value == "0",
+      "PYTORCH_CUDA_ALLOC_CONF: expected True or False for ", option, ", got ", value);
+    return value == "True" || value == "1";
+  }
+
+  static size_t parseSize(const std::string& option, const std::string& value) {
+    size_t pos = 0;
+    size_t result = 0;
+    try {
+      result = std::stoull(value, &pos);
+    } catch (const std::exception&) {
+      pos = 0;
+    }
+    TORCH_CHECK(pos > 0 && pos == value.size(),
+      "PYTORCH_CUDA_ALLOC_CONF: expected a non-negative integer for ", option, ", got ", value);
+    return result;
+  }
+
+  static double parseFraction(const std::string& option, const std::string& value) {
+    size_t pos = 0;
+    double result = 0;
+    try {
+      result = std::stod(value, &pos);
+    } catch (const std::exception&) {
+      pos = 0;
+    }
+    TORCH_CHECK(pos > 0 && pos == value.size() && result > 0 && result < 1,
+      "PYTORCH_CUDA_ALLOC_CONF: expected a value in (0, 1) for ", option, ", got ", value);
+    return result;
+  }
+
+  void parseArgs(const char* env) {
+    if (env == nullptr) {
+      return;
+    }
+    // parse into a copy so that an invalid string leaves the config untouched
+    CachingAllocatorConfig config(*this);
+    std::stringstream config_stream(env);
+    std::string item;
+    while (std::getline(config_stream, item, ',')) {
+      if (item.empty()) {
+        continue;
+      }
+      const auto colon = item.find(':');
+      TORCH_CHECK(colon != std::string::npos,
+        "PYTORCH_CUDA_ALLOC_CONF: expected option:value, got ", item);
+      const std::string option = item.substr(0, colon);
+      const std::string value = item.substr(colon + 1);
+      if (option == "expandable_segments") {
+        config.m_expandable_segments = parseBool(option, value);
+#ifndef C10_CUDA_DRIVER_API_SUPPORTED
+        if (config.m_expandable_segments) {
+          TORCH_WARN_ONCE("expandable_segments not supported on this platform");
+          config.m_expandable_segments = false;
+        }
+#endif
+      } else if (option == "max_split_size_mb") {
+        const size_t mb = parseSize(option, value);
+        // cap so that the conversion to bytes cannot overflow
+        config.m_max_split_size = std::min<size_t>(mb, std::numeric_limits<size_t>::max() / 1048576) * 1048576;
+      } else if (option == "roundup_power2_divisions") {
+        const size_t divisions = parseSize(option, value);
+        TORCH_CHECK(divisions == 0 || llvm::isPowerOf2_64(divisions),
+          "PYTORCH_CUDA_ALLOC_CONF: roundup_power2_divisions must be 0 or a power of 2, got ", value);
+        config.m_roundup_power2_divisions = divisions;
+      } else if (option == "small_size_mb") {
+        config.m_small_size = parseSize(option, value) * 1048576;
+      } else if (option == "small_buffer_mb") {
+        config.m_small_buffer = parseSize(option, value) * 1048576;
+      } else if (option == "large_buffer_mb") {
+        config.m_large_buffer = parseSize(option, value) * 1048576;
+      } else if (option == "min_large_alloc_mb") {
+        config.m_min_large_alloc = parseSize(option, value) * 1048576;
+      } else if (option == "round_large_mb") {
+        config.m_round_large = parseSize(option, value) * 1048576;
+      } else if (option == "garbage_collection_threshold") {
+        config.m_garbage_collection_threshold = parseFraction(option, value);
+      } else if (option == "cross_stream_reuse") {
+        config.m_cross_stream_reuse = parseBool(option, value);
+      } else {
+        TORCH_CHECK(false, "PYTORCH_CUDA_ALLOC_CONF: unrecognized option ", option);
+      }
+    }
+
+    TORCH_CHECK(config.m_small_size > 0 && config.m_small_buffer >= config.m_small_size,
+      "PYTORCH_CUDA_ALLOC_CONF: small_buffer_mb must be at least small_size_mb and both must be positive");
+    TORCH_CHECK(config.m_min_large_alloc > config.m_small_size &&
+                config.m_large_buffer >= config.m_min_large_alloc,
+      "PYTORCH_CUDA_ALLOC_CONF: expected small_size_mb < min_large_alloc_mb <= large_buffer_mb");
+    TORCH_CHECK(config.m_round_large > 0,
+      "PYTORCH_CUDA_ALLOC_CONF: round_large_mb must be positive");
+    TORCH_CHECK(config.m_max_split_size > config.m_large_buffer,
+      "PYTORCH_CUDA_ALLOC_CONF: max_split_size_mb must be larger than large_buffer_mb (",
+      config.m_large_buffer / 1048576, ")");
+
+    m_expandable_segments = config.m_expandable_segments;
+    m_max_split_size = config.m_max_split_size;
+    m_roundup_power2_divisions = config.m_roundup_power2_divisions;
+    m_small_size = config.m_small_size;
+    m_small_buffer = config.m_small_buffer;
+    m_large_buffer = config.m_large_buffer;
+    m_min_large_alloc = config.m_min_large_alloc;
+    m_round_large = config.m_round_large;
+    m_garbage_collection_threshold = config.m_garbage_collection_threshold;
+    m_cross_stream_reuse = config.m_cross_stream_reuse;
+  }
+
+  CachingAllocatorConfig(const CachingAllocatorConfig& other)
+      : m_expandable_segments(other.m_expandable_segments),
+        m_max_split_size(other.m_max_split_size),
+        m_roundup_power2_divisions(other.m_roundup_power2_divisions),
+        m_small_size(other.m_small_size),
+        m_small_buffer(other.m_small_buffer),
+        m_large_buffer(other.m_large_buffer),
+        m_min_large_alloc(other.m_min_large_alloc),
+        m_round_large(other.m_round_large),
+        m_garbage_collection_threshold(other.m_garbage_collection_threshold),
+        m_cross_stream_reuse(other.m_cross_stream_reuse) {}
+
+  std::mutex m_mutex;
+  bool m_expandable_segments;
+  size_t m_max_split_size;
+  size_t m_roundup_power2_divisions;
+  size_t m_small_size;
+  size_t m_small_buffer;
+  size_t m_large_buffer;
+  size_t m_min_large_alloc;
+  size_t m_round_large;
+  double m_garbage_collection_threshold;
+  bool m_cross_stream_reuse;
+};
+
+struct SegmentRange {
+  char* ptr;
+  size_t size;
+  SegmentRange(void* p, size_t s) : ptr(static_cast<char*>(p)), size(s) {}
+};
+
+#ifdef C10_CUDA_DRIVER_API_SUPPORTED
+
+// A virtual address range reserved once and backed by physical memory in
+// units of segment_size. Only whole units are ever mapped or unmapped:
+// map() rounds the requested range out to unit boundaries and unmap() rounds
+// it in, and both return the range that was actually affected.
+struct ExpandableSegment {
+  ExpandableSegment(int device, cudaStream_t stream, size_t segment_size)
+      : device_(device), stream_(stream), ptr_(0), max_handles_(0),
+        segment_size_(segment_size) {
+    CUDAGuard device_guard(device_);
+    size_t device_free;
+    size_t device_total;
+    C10_CUDA_CHECK(cudaMemGetInfo(&device_free, &device_total));
+    // reserve a little more address space than there is memory on the device
+    // so that the segment can never be the reason for running out.
+    max_handles_ = numSegments(device_total + device_total / 8);
+    C10_CUDA_DRIVER_CHECK(DriverAPI::get()->cuMemAddressReserve_(
+        &ptr_, segment_size_ * max_handles_, 0ULL, 0, 0ULL));
+  }
+
+  // segments are only destroyed once all of their pages have been unmapped
+  ~ExpandableSegment() {
+    const CUresult err = DriverAPI::get()->cuMemAddressFree_(ptr_, size());
+    if (err != CUDA_SUCCESS) {
+      TORCH_WARN("CUDA driver error in cuMemAddressFree: ", err);
+    }
+  }
+
+  // backs the pages covering range with physical memory. Returns an empty
+  // range if the device is out of memory.
+  SegmentRange map(SegmentRange range) {
+    const size_t begin = segmentLeft(range.ptr);
+    const size_t end = segmentRight(range.ptr + range.size);
+    TORCH_INTERNAL_ASSERT(ptr() + begin * segment_size_ == range.ptr);
+    if (begin == end) {
+      return rangeFromHandles(begin, end);
+    }
+    CUDAGuard device_guard(device_);
+    while (end > handles_.size()) {
+      handles_.emplace_back(c10::nullopt);
+    }
+    for (size_t i = begin; i < end; ++i) {
+      TORCH_INTERNAL_ASSERT(!handles_.at(i));
+      CUmemGenericAllocationHandle handle;
+      CUmemAllocationProp prop = {};
+      prop.type = CU_MEM_ALLOCATION_TYPE_PINNED;
+      prop.location.type = CU_MEM_LOCATION_TYPE_DEVICE;
+      prop.location.id = device_;
+      const CUresult status =
+          DriverAPI::get()->cuMemCreate_(&handle, segment_size_, &prop, 0);
+      if (status == CUDA_ERROR_OUT_OF_MEMORY) {
+        for (size_t j = begin; j < i; ++j) {
+          const auto h = handles_.at(j).value();
+          handles_.at(j) = c10::nullopt;
+          C10_CUDA_DRIVER_CHECK(DriverAPI::get()->cuMemRelease_(h));
+        }
+        trimHandles();
+        return rangeFromHandles(begin, begin);
+      }
+      C10_CUDA_DRIVER_CHECK(status);
+      handles_.at(i) = handle;
+    }
+    for (size_t i = begin; i < end; ++i) {
+      C10_CUDA_DRIVER_CHECK(DriverAPI::get()->cuMemMap_(
+          ptr_ + i * segment_size_, segment_size_, 0, handles_.at(i).value(), 0ULL));
+    }
+    CUmemAccessDesc desc;
+    desc.location.type = CU_MEM_LOCATION_TYPE_DEVICE;
+    desc.location.id = device_;
+    desc.flags = CU_MEM_ACCESS_FLAGS_PROT_READWRITE;
+    C10_CUDA_DRIVER_CHECK(DriverAPI::get()->cuMemSetAccess_(
+        ptr_ + begin * segment_size_, (end - begin) * segment_size_, &desc, 1));
+    return rangeFromHandles(begin, end);
+  }
+
+  // releases the physical memory of all pages fully contained in range.
+  SegmentRange unmap(SegmentRange range) {
+    const size_t begin = segmentRight(range.ptr);
+    const size_t end = segmentLeft(range.ptr + range.size);
+    if (begin >= end) {
+      return SegmentRange{range.ptr, 0};
+    }
+    CUDAGuard device_guard(device_);
+    unmapHandles(begin, end);
+    return rangeFromHandles(begin, end);
+  }
+
+  char* ptr() const {
+    return reinterpret_cast<char*>(ptr_);
+  }
+
+  size_t size() const {
+    return max_handles_ * segment_size_;
+  }
+
+  cudaStream_t stream() const {
+    return stream_;
+  }
+
+  // unit in which physical memory is mapped and unmapped
+  size_t segmentSize() const {
+    return segment_size_;
+  }
+
+  static bool supported(int device) {
+    CUdevice dev;
+    int supported = 0;
+    C10_CUDA_DRIVER_CHECK(DriverAPI::get()->cuDeviceGet_(&dev, device));
+    C10_CUDA_DRIVER_CHECK(DriverAPI::get()->cuDeviceGetAttribute_(
+        &supported, CU_DEVICE_ATTRIBUTE_VIRTUAL_ADDRESS_MANAGEMENT_SUPPORTED, dev));
+    return supported != 0;
+  }
+
+  static size_t granularity(int device) {
+    CUmemAllocationProp prop = {};
+    prop.type = CU_MEM_ALLOCATION_TYPE_PINNED;
+    prop.location.type = CU_MEM_LOCATION_TYPE_DEVICE;
+    prop.location.id = device;
+    size_t granularity = 0;
+    C10_CUDA_DRIVER_CHECK(DriverAPI::get()->cuMemGetAllocationGranularity_(
+        &granularity, &prop, CU_MEM_ALLOC_GRANULARITY_MINIMUM));
+    return granularity;
+  }
+
+ private:
+  void unmapHandles(size_t begin, size_t end) {
+    end = std::min(end, handles_.size());
+    if (std::none_of(handles_.begin() + std::min(begin, end), handles_.begin() + end,
+                     [](const c10::optional<CUmemGenericAllocationHandle>& h) { return h.has_value(); })) {
+      return;
+    }
+    // note: unlike cudaFree, cuMemUnmap and cuMemRelease do not synchronize,
+    // so wait for outstanding work on the stream before the pages go away.
+    C10_CUDA_CHECK(cudaStreamSynchronize(stream_));
+    for (size_t i = begin; i < end; ++i) {
+      if (!handles_.at(i)) {
+        continue;
+      }
+      const auto h = handles_.at(i).value();
+      handles_.at(i) = c10::nullopt;
+      C10_CUDA_DRIVER_CHECK(DriverAPI::get()->cuMemUnmap_(
+          ptr_ + segment_size_ * i, segment_size_));
+      C10_CUDA_DRIVER_CHECK(DriverAPI::get()->cuMemRelease_(h));
+    }
+    trimHandles();
+  }
+
+  void trimHandles() {
+    while (!handles_.empty() && !handles_.back()) {
+      handles_.pop_back();
+    }
+  }
+
+  size_t numSegments(size_t size) const {
+    return (size + segment_size_ - 1) / segment_size_;
+  }
+
+  size_t segmentLeft(char* p) const {
+    const size_t offset = p - ptr();
+    return offset / segment_size_;
+  }
+
+  size_t segmentRight(char* p) const {
+    const size_t offset = p - ptr();
+    return numSegments(offset);
+  }
+
+  SegmentRange rangeFromHandles(size_t begin, size_t end) const {
+    return SegmentRange(ptr() + segment_size_ * begin, segment_size_ * (end - begin));
+  }
+
+  int device_;
+  cudaStream_t stream_;
+  CUdeviceptr ptr_;
+  size_t max_handles_;
+  size_t segment_size_;
+  std::vector<c10::optional<CUmemGenericAllocationHandle>> handles_;
+};
+
+#else
+
+// Stub so that the allocator compiles on platforms without the driver API.
+// CachingAllocatorConfig never enables expandable segments there.
+struct ExpandableSegment {
+  ExpandableSegment(int device, cudaStream_t stream, size_t segment_size) {
+    TORCH_INTERNAL_ASSERT(false, "expandable segments not supported");
+  }
+  SegmentRange map(SegmentRange range) { return SegmentRange(nullptr, 0); }
+  SegmentRange unmap(SegmentRange range) { return SegmentRange(nullptr, 0); }
+  char* ptr() const { return nullptr; }
+  size_t size() const { return 0; }
+  cudaStream_t stream() const { return nullptr; }
+  size_t segmentSize() const { return 1; }
+  static bool supported(int device) { return false; }
+  static size_t granularity(int device) { return 1; }
+};
+
+#endif // C10_CUDA_DRIVER_API_SUPPORTED
+
 struct AllocParams {
   AllocParams(int device, size_t size, cudaStream_t stream, BlockPool* pool, size_t alloc_size,
               DeviceStats& stats) :
@@ -176,10 +687,47 @@ struct AllocParams {
   Block* block;
   StatTypes stat_types;
   cudaError_t err;
+  std::shared_ptr<Context> context;
+};
+
+// a cudaEvent recorded for a use of block on another stream
+struct StreamUseEvent {
+  StreamUseEvent(cudaEvent_t event, int device, Block* block) :
+    event(event), device(device), block(block) {}
+
+  cudaEvent_t event;
+  int device;   // device the event was created on
+  Block* block;
 };
 
+int64_t current_time_us() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
 } // namespace
 
+// The cached blocks of a CUDA graph capture, or of several captures sharing a
+// pool. Blocks freed into it are only handed out again to captures using the
+// pool, because replays of the graphs still read and write them.
+struct PrivatePool {
+  PrivatePool() :
+    use_count(1),
+    cudaMalloc_count(0),
+    large_blocks(BlockComparator, /*small=*/false, this),
+    small_blocks(BlockComparator, /*small=*/true, this) {}
+  PrivatePool(const PrivatePool&) = delete;
+  PrivatePool& operator=(const PrivatePool&) = delete;
+
+  // number of live graphs (or captures underway) using the pool
+  int use_count;
+  // number of cudaMalloc'd segments owned by the pool; once use_count is 0,
+  // the pool is destroyed when free_cached_blocks has released all of them
+  int cudaMalloc_count;
+  BlockPool large_blocks;
+  BlockPool small_blocks;
+};
+
 class DeviceCachingAllocator {
 
  private:
@@ -196,44 +744,110 @@ class DeviceCachingAllocator {
   // unallocated cached blocks 1 MB or smaller
   BlockPool small_blocks;
 
+  // address space of expandable segments that is not backed by memory,
+  // for blocks belonging to large_blocks and small_blocks respectively
+  BlockPool large_unmapped;
+  BlockPool small_unmapped;
+
   // allocated or in use by a stream
   std::unordered_set<Block*> active_blocks;
 
+  // reserved virtual address ranges (only with expandable_segments:True)
+  std::vector<std::unique_ptr<ExpandableSegment>> expandable_segments;
+
+  // allocation history, a ring buffer of the last alloc_trace_max_entries
+  // events; alloc_trace_next is the oldest entry once the buffer is full
+  bool record_history = false;
+  std::atomic<CreateContextFn> context_recorder{nullptr};
+  size_t alloc_trace_max_entries = 1;
+  size_t alloc_trace_next = 0;
+  std::vector<TraceEntry> alloc_trace;
+
   // outstanding cuda events
-  std::deque<std::pair<cudaEvent_t, Block*>> cuda_events;
+  std::deque<StreamUseEvent> cuda_events;
+
+  // cuda events that are not in use, by the device they were created on.
+  // Creating an event is much slower than recording one.
+  std::unordered_map<int, std::vector<cudaEvent_t>> free_events;
+
+  // upper bound on reserved memory set by setMemoryFraction
+  bool set_fraction = false;
+  size_t allowed_memory_maximum = 0;
+
+  // incremented whenever a block is returned to a pool, to find the least
+  // recently freed blocks
+  uint64_t free_ticks = 0;
+
+  // number of graph captures on this device that began and did not end yet.
+  // While it is nonzero, every allocation checks whether its stream is
+  // capturing.
+  int captures_underway = 0;
+  // the private pool each capture underway allocates from
+  std::unordered_map<CaptureId_t, MempoolId_t> capture_to_pool_map;
+  // private pools, by the id they were created with
+  std::map<MempoolId_t, std::unique_ptr<PrivatePool>> graph_pools;
+  // private pools no graph uses anymore, see free_cached_blocks
+  std::map<MempoolId_t, PrivatePool*> graph_pools_freeable;
+  // blocks with stream uses freed during a capture. Recording events on the
+  // other streams could join them to the capture, so the events are only
+  // inserted once no capture is underway.
+  std::vector<Block*> needs_events_deferred_until_no_capture;
 
  public:
 
   DeviceCachingAllocator() :
-      large_blocks(BlockComparator),
-      small_blocks(BlockComparator) {}
+      large_blocks(BlockComparator, /*small=*/false),
+      small_blocks(BlockComparator, /*small=*/true),
+      large_unmapped(BlockComparator, /*small=*/false),
+      small_unmapped(BlockComparator, /*small=*/true) {}
 
   // All public methods (except the above) acquire the allocator mutex.
   // Thus, do not call a public method from another public method.
 
   Block* malloc(int device, size_t size, cudaStream_t stream)
   {
+    // the context recorder may need other locks (e.g. the GIL), so it must
+    // run before the allocator mutex is taken
+    std::shared_ptr<Context> context = maybe_gather_context();
+
     std::unique_lock<std::recursive_mutex> lock(mutex);
 
-    // process outstanding cudaEvents
-    process_events();
+    // Querying or synchronizing events and cudaFree are not allowed while a
+    // stream is being captured, so the cache is only maintained between
+    // captures.
+    const bool capturing = captures_underway > 0;
+    if (C10_LIKELY(!capturing)) {
+      insert_events_deferred_until_no_capture();
+
+      // process outstanding cudaEvents
+      process_events();
+
+      // shrink the cache early if it is getting close to the cap
+      garbage_collect_cached_blocks();
+    }
 
     size = round_size(size);
-    auto& pool = get_pool(size);
+    auto& pool = get_pool(size, stream);
     const size_t alloc_size = get_allocation_size(size);
     AllocParams params(device, size, stream, &pool, alloc_size, stats);
     params.stat_types[static_cast<size_t>(StatType::AGGREGATE)] = true;
     params.stat_types[static_cast<size_t>(get_stat_type_for_pool(pool))] = true;
+    params.context = context;
 
     bool block_found =
       // Search pool
       get_free_block(params)
       // Trigger callbacks and retry search
       || (trigger_free_memory_callbacks(params) && get_free_block(params))
+      // Take blocks held by other streams, ordering this stream after them
+      || (!capturing && CachingAllocatorConfig::cross_stream_reuse() &&
+          get_cross_stream_block(params))
       // Attempt allocate
       || alloc_block(params, false)
+      // Free enough of the least recently freed cached blocks and retry alloc.
+      || (!capturing && release_lru_cached_blocks(params) && alloc_block(params, false))
       // Free all non-split cached blocks and retry alloc.
-      || (free_cached_blocks() && alloc_block(params, true));
+      || (!capturing && free_cached_blocks() && alloc_block(params, true));
 
     TORCH_INTERNAL_ASSERT((!block_found && params.err != cudaSuccess) || params.block);
     if (!block_found) {
@@ -243,6 +857,7 @@ class DeviceCachingAllocator {
         C10_CUDA_CHECK(cudaMemGetInfo(&device_free, &device_total));
 
         stats.num_ooms += 1;
+        record_trace(TraceEntry::OOM, reinterpret_cast<void*>(device_free), alloc_size, stream, context);
 
         // "total capacity": total global memory on GPU
         // "already allocated": memory allocated by the program using the
@@ -261,6 +876,10 @@ class DeviceCachingAllocator {
         // Note that at this point free_cached_blocks has already returned all
         // possible "cached" memory to the driver. The only remaining "cached"
         // memory is split from a larger block that is partially in-use.
+        std::string allowed_info;
+        if (set_fraction) {
+          allowed_info = format_size(allowed_memory_maximum) + " allowed; ";
+        }
         TORCH_CHECK_WITH(CUDAOutOfMemoryError, false,
           "CUDA out of memory. Tried to allocate ", format_size(alloc_size),
           " (GPU ", device, "; ",
@@ -268,6 +887,7 @@ class DeviceCachingAllocator {
           format_size(stats.allocated_bytes[static_cast<size_t>(StatType::AGGREGATE)].current),
           " already allocated; ",
           format_size(device_free), " free; ",
+          allowed_info,
           format_size(stats.reserved_bytes[static_cast<size_t>(StatType::AGGREGATE)].current),
           " reserved in total by PyTorch)");
       } else {
@@ -278,12 +898,20 @@ class DeviceCachingAllocator {
     Block* block = params.block;
     Block* remaining = nullptr;
     TORCH_INTERNAL_ASSERT(block);
-
+    C10_METRICS_HISTOGRAM_RECORD(
+        "c10_cuda_allocation_bytes",
+        "Sizes of the allocations of the CUDA caching allocator, rounded",
+        size);
+
+    // Free memory of expandable segments can always be unmapped, so it is
+    // never counted as inactive split memory.
+    const bool track_split = !block->expandable_segment;
     const bool already_split = block->is_split();
     if (should_split(block, size)) {
       remaining = block;
 
       block = new Block(device, stream, size, &pool, block->ptr);
+      block->expandable_segment = remaining->expandable_segment;
       block->prev = remaining->prev;
       if (block->prev) {
         block->prev->next = block;
@@ -294,8 +922,11 @@ class DeviceCachingAllocator {
       remaining->ptr = static_cast<char*>(remaining->ptr) + size;
       remaining->size -= size;
       pool.insert(remaining);
+      record_trace(TraceEntry::SPLIT, remaining->ptr, remaining->size, stream, context);
 
-      if (already_split) {
+      if (!track_split) {
+        // not tracked
+      } else if (already_split) {
         // An already-split inactive block is being shrunk by size bytes.
         update_stat_array(stats.inactive_split_bytes, -block->size, params.stat_types);
       } else {
@@ -304,7 +935,7 @@ class DeviceCachingAllocator {
         update_stat_array(stats.inactive_split_bytes, remaining->size, params.stat_types);
         update_stat_array(stats.inactive_split, 1, params.stat_types);
       }
-    } else if (already_split) {
+    } else if (track_split && already_split) {
       // An already-split block is becoming active
       update_stat_array(stats.inactive_split_bytes, -block->size, params.stat_types);
       update_stat_array(stats.inactive_split, -1, params.stat_types);
@@ -314,40 +945,50 @@ class DeviceCachingAllocator {
     active_blocks.insert(block);
 
     c10::reportMemoryUsageToProfiler(
-        block, block->size, c10::Device(c10::DeviceType::CUDA, device));
+        block->ptr, block->size, c10::Device(c10::DeviceType::CUDA, device));
 
     update_stat_array(stats.allocation, 1, params.stat_types);
     update_stat_array(stats.allocated_bytes, block->size, params.stat_types);
     update_stat_array(stats.active, 1, params.stat_types);
     update_stat_array(stats.active_bytes, block->size, params.stat_types);
+    record_trace(TraceEntry::ALLOC, block->ptr, block->size, stream, context);
 
     return block;
   }
 
   void free(Block* block)
   {
+    std::shared_ptr<Context> context = maybe_gather_context();
+
     std::lock_guard<std::recursive_mutex> lock(mutex);
 
     block->allocated = false;
 
     c10::reportMemoryUsageToProfiler(
-        block, -block->size, c10::Device(c10::DeviceType::CUDA, block->device));
+        block->ptr, -block->size, c10::Device(c10::DeviceType::CUDA, block->device));
 
     StatTypes stat_types;
     stat_types[static_cast<size_t>(StatType::AGGREGATE)] = true;
     stat_types[static_cast<size_t>(get_stat_type_for_pool(*(block->pool)))] = true;
     update_stat_array(stats.allocation, -1, {stat_types});
     update_stat_array(stats.allocated_bytes, -block->size, {stat_types});
+    record_trace(TraceEntry::FREE, block->ptr, block->size, block->stream, context);
 
     if (!block->stream_uses.empty()) {
-      insert_events(block);
+      if (C10_UNLIKELY(captures_underway > 0)) {
+        needs_events_deferred_until_no_capture.push_back(block);
+      } else {
+        insert_events(block);
+      }
     } else {
-      free_block(block);
+      free_block(block, context);
     }
   }
 
   void* getBaseAllocation(Block* block, size_t* outSize) {
     std::lock_guard<std::recursive_mutex> lock(mutex);
+    TORCH_CHECK(!block->expandable_segment,
+      "Tensors allocated with expandable_segments:True cannot be shared between processes.");
     while (block->prev) {
       block = block->prev;
     }
@@ -373,6 +1014,16 @@ class DeviceCachingAllocator {
     block->stream_uses.insert(stream);
   }
 
+  /** caps the memory reserved on the device at fraction of its capacity **/
+  void setMemoryFraction(double fraction) {
+    size_t device_free;
+    size_t device_total;
+    C10_CUDA_CHECK(cudaMemGetInfo(&device_free, &device_total));
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    allowed_memory_maximum = static_cast<size_t>(fraction * device_total);
+    set_fraction = true;
+  }
+
   /** returns cached blocks to the system allocator **/
   void emptyCache() {
     std::lock_guard<std::recursive_mutex> lock(mutex);
@@ -433,6 +1084,31 @@ class DeviceCachingAllocator {
     }
   }
 
+  void recordHistory(bool enabled, CreateContextFn recorder, size_t max_entries) {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    if (enabled && !record_history) {
+      alloc_trace.clear();
+      alloc_trace_next = 0;
+    }
+    record_history = enabled;
+    context_recorder.store(enabled ? recorder : nullptr);
+    alloc_trace_max_entries = std::max<size_t>(1, max_entries);
+    if (alloc_trace.size() > alloc_trace_max_entries) {
+      // keep the newest entries when the buffer shrinks
+      std::vector<TraceEntry> trace = get_history();
+      alloc_trace.assign(
+        std::make_move_iterator(trace.end() - alloc_trace_max_entries),
+        std::make_move_iterator(trace.end()));
+      alloc_trace_next = 0;
+    }
+  }
+
+  /** Returns the recorded history, oldest entry first **/
+  std::vector<TraceEntry> history() const {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    return get_history();
+  }
+
   /** Dump a complete snapshot of the memory held by the allocator. Potentially VERY expensive. **/
   std::vector<SegmentInfo> snapshot() const {
     std::lock_guard<std::recursive_mutex> lock(mutex);
@@ -448,10 +1124,16 @@ class DeviceCachingAllocator {
       SegmentInfo& segment_info = result.back();
       segment_info.device = head_block->device;
       segment_info.address = reinterpret_cast<int64_t>(head_block->ptr);
-      segment_info.is_large = (head_block->pool == &large_blocks);
+      segment_info.is_large = !head_block->pool->is_small;
+      segment_info.is_expandable = (head_block->expandable_segment != nullptr);
 
       const Block* block = head_block;
       while (block != nullptr) {
+        if (!block->mapped) {
+          // address space of an expandable segment without backing memory
+          block = block->next;
+          continue;
+        }
         segment_info.blocks.emplace_back();
         BlockInfo& block_info = segment_info.blocks.back();
 
@@ -469,6 +1151,9 @@ class DeviceCachingAllocator {
 
         block = block->next;
       }
+      if (segment_info.blocks.empty()) {
+        result.pop_back();
+      }
     }
 
     std::sort(result.begin(), result.end(), [](const SegmentInfo& a, const SegmentInfo& b) {
@@ -478,32 +1163,135 @@ class DeviceCachingAllocator {
     return result;
   }
 
+  /** makes allocations on streams captured as graph_id come from the
+      private pool mempool_id, creating the pool if it does not exist **/
+  void notifyCaptureBegin(CaptureId_t graph_id, MempoolId_t mempool_id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    captures_underway++;
+    auto it = graph_pools.find(mempool_id);
+    if (it == graph_pools.end()) {
+      graph_pools.emplace(mempool_id, std::unique_ptr<PrivatePool>(new PrivatePool()));
+    } else {
+      // the capture shares the pool of a graph that is still alive
+      TORCH_INTERNAL_ASSERT(it->second->use_count > 0);
+      it->second->use_count++;
+    }
+    const bool inserted = capture_to_pool_map.insert({graph_id, mempool_id}).second;
+    TORCH_INTERNAL_ASSERT(inserted);
+  }
+
+  /** ends the routing of allocations set up by notifyCaptureBegin **/
+  void notifyCaptureEnd(CaptureId_t graph_id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    captures_underway--;
+    auto it = capture_to_pool_map.find(graph_id);
+    TORCH_INTERNAL_ASSERT(it != capture_to_pool_map.end());
+    capture_to_pool_map.erase(it);
+  }
+
+  /** called when a graph using mempool_id is destroyed **/
+  void notifyCaptureDestroy(MempoolId_t mempool_id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    auto it = graph_pools.find(mempool_id);
+    TORCH_INTERNAL_ASSERT(it != graph_pools.end());
+    const int use_count = --(it->second->use_count);
+    TORCH_INTERNAL_ASSERT(use_count >= 0);
+    if (use_count == 0) {
+      // the blocks of the pool may still be in use by tensors, so the pool
+      // is only released by a later free_cached_blocks
+      const bool inserted = graph_pools_freeable.insert({mempool_id, it->second.get()}).second;
+      TORCH_INTERNAL_ASSERT(inserted);
+    }
+  }
+
   static size_t round_size(size_t size) {
     if (size < kMinBlockSize) {
       return kMinBlockSize;
-    } else {
-      return kMinBlockSize * ((size + kMinBlockSize - 1) / kMinBlockSize);
     }
+    const size_t divisions = CachingAllocatorConfig::roundup_power2_divisions();
+    if (divisions > 0 && size > kMinBlockSize * divisions) {
+      return roundup_power2_next_division(size, divisions);
+    }
+    return kMinBlockSize * ((size + kMinBlockSize - 1) / kMinBlockSize);
+  }
+
+  // Rounds size up to the next of `divisions` equally spaced values between
+  // the two powers of two surrounding it, e.g. with 4 divisions a request of
+  // 1200 MiB becomes 1280 MiB (1024, 1280, 1536, 1792, 2048).
+  static size_t roundup_power2_next_division(size_t size, size_t divisions) {
+    if (llvm::isPowerOf2_64(size)) {
+      return size;
+    }
+    const size_t power2_floor = llvm::PowerOf2Floor(size);
+    const size_t power2_division = power2_floor / divisions;
+    if (power2_division == 0) {
+      return power2_floor << 1;
+    }
+    const size_t round_size_floor = size & ~(power2_division - 1);
+    return (round_size_floor == size) ? size : round_size_floor + power2_division;
   }
 
  private:
 
   // All private methods do not acquire the allocator mutex.
 
+  std::shared_ptr<Context> maybe_gather_context() {
+    CreateContextFn recorder = context_recorder.load();
+    return recorder ? recorder() : nullptr;
+  }
+
+  void record_trace(TraceEntry::Action action, void* addr, size_t size,
+                    cudaStream_t stream, std::shared_ptr<Context> context) {
+    if (!record_history) {
+      return;
+    }
+    TraceEntry entry{
+      action,
+      reinterpret_cast<int64_t>(addr),
+      static_cast<int64_t>(size),
+      stream,
+      current_time_us(),
+      stats.allocated_bytes[static_cast<size_t>(StatType::AGGREGATE)].current,
+      stats.reserved_bytes[static_cast<size_t>(StatType::AGGREGATE)].current,
+      std::move(context)};
+    if (alloc_trace.size() < alloc_trace_max_entries) {
+      alloc_trace.emplace_back(std::move(entry));
+    } else {
+      alloc_trace[alloc_trace_next] = std::move(entry);
+      alloc_trace_next = (alloc_trace_next + 1) % alloc_trace_max_entries;
+    }
+  }
+
+  std::vector<TraceEntry> get_history() const {
+    std::vector<TraceEntry> result;
+    result.reserve(alloc_trace.size());
+    result.insert(result.end(), alloc_trace.begin() + alloc_trace_next, alloc_trace.end());
+    result.insert(result.end(), alloc_trace.begin(), alloc_trace.begin() + alloc_trace_next);
+    return result;
+  }
+
   std::vector<const Block*> get_all_blocks() const {
     std::vector<const Block*> blocks;
     blocks.insert(blocks.end(), small_blocks.begin(), small_blocks.end());
     blocks.insert(blocks.end(), large_blocks.begin(), large_blocks.end());
+    blocks.insert(blocks.end(), small_unmapped.begin(), small_unmapped.end());
+    blocks.insert(blocks.end(), large_unmapped.begin(), large_unmapped.end());
+    for (const auto& graph_pool : graph_pools) {
+      const PrivatePool& private_pool = *graph_pool.second;
+      blocks.insert(blocks.end(), private_pool.small_blocks.begin(), private_pool.small_blocks.end());
+      blocks.insert(blocks.end(), private_pool.large_blocks.begin(), private_pool.large_blocks.end());
+    }
     blocks.insert(blocks.end(), active_blocks.begin(), active_blocks.end());
     return blocks;
   }
 
   /** moves a block into a pool of cached free blocks */
-  void free_block(Block* block)
+  void free_block(Block* block, std::shared_ptr<Context> context = nullptr)
   {
     TORCH_INTERNAL_ASSERT(!block->allocated && block->event_count == 0);
 
     size_t original_block_size = block->size;
+    block->free_tick = ++free_ticks;
 
     auto& pool = *block->pool;
     int64_t net_change_inactive_split_blocks = 0;
@@ -520,6 +1308,9 @@ class DeviceCachingAllocator {
 
     active_blocks.erase(block);
     pool.insert(block);
+    if (block->size != original_block_size) {
+      record_trace(TraceEntry::MERGE, block->ptr, block->size, block->stream, std::move(context));
+    }
 
     if (block->is_split()) {
       net_change_inactive_split_blocks += 1;
@@ -529,8 +1320,10 @@ class DeviceCachingAllocator {
     StatTypes stat_types;
     stat_types[static_cast<size_t>(StatType::AGGREGATE)] = true;
     stat_types[static_cast<size_t>(get_stat_type_for_pool(*(block->pool)))] = true;
-    update_stat_array(stats.inactive_split, net_change_inactive_split_blocks, stat_types);
-    update_stat_array(stats.inactive_split_bytes, net_change_inactive_split_size, stat_types);
+    if (!block->expandable_segment) {
+      update_stat_array(stats.inactive_split, net_change_inactive_split_blocks, stat_types);
+      update_stat_array(stats.inactive_split_bytes, net_change_inactive_split_size, stat_types);
+    }
     update_stat_array(stats.active, -1, stat_types);
     update_stat_array(stats.active_bytes, -original_block_size, stat_types);
   }
@@ -538,7 +1331,7 @@ class DeviceCachingAllocator {
   /** combine previously split blocks. returns the size of the subsumed block, or 0 on failure. */
   size_t try_merge_blocks(Block* dst, Block* src, BlockPool& pool)
   {
-    if (!src || src->allocated || src->event_count > 0) {
+    if (!src || src->allocated || src->event_count > 0 || src->mapped != dst->mapped) {
       return 0;
     }
 
@@ -559,48 +1352,65 @@ class DeviceCachingAllocator {
 
     const size_t subsumed_size = src->size;
     dst->size += subsumed_size;
-    pool.erase(src);
+    if (src->mapped) {
+      pool.erase(src);
+    } else {
+      get_unmapped_pool(pool).erase(src);
+    }
     delete src;
 
     return subsumed_size;
   }
 
-  BlockPool& get_pool(size_t size) {
-    if (size <= kSmallSize) {
-      return small_blocks;
-    } else {
-      return large_blocks;
+  BlockPool& get_pool(size_t size, cudaStream_t stream) {
+    const bool small = size <= CachingAllocatorConfig::small_size();
+#ifdef C10_CUDA_GRAPHS_SUPPORTED
+    // captures_underway is almost always 0, which spares the capture query
+    if (C10_UNLIKELY(captures_underway > 0)) {
+      CaptureId_t id;
+      cudaStreamCaptureStatus status;
+      C10_CUDA_CHECK(cudaStreamGetCaptureInfo(stream, &status, &id));
+      if (status != cudaStreamCaptureStatusNone) {
+        TORCH_INTERNAL_ASSERT(status != cudaStreamCaptureStatusInvalidated);
+        auto mempool_id = capture_to_pool_map.find(id);
+        TORCH_INTERNAL_ASSERT(mempool_id != capture_to_pool_map.end());
+        auto private_pool = graph_pools.find(mempool_id->second);
+        TORCH_INTERNAL_ASSERT(private_pool != graph_pools.end());
+        return small ? private_pool->second->small_blocks : private_pool->second->large_blocks;
+      }
     }
+#endif
+    return small ? small_blocks : large_blocks;
+  }
+
+  BlockPool& get_unmapped_pool(const BlockPool& pool) {
+    // private pools never use expandable segments
+    TORCH_INTERNAL_ASSERT(!pool.owner_PrivatePool);
+    return pool.is_small ? small_unmapped : large_unmapped;
   }
 
   StatType get_stat_type_for_pool(const BlockPool& pool) {
-    if (&pool == &small_blocks) {
-      return StatType::SMALL_POOL;
-    } else if (&pool == &large_blocks) {
-      return StatType::LARGE_POOL;
-    } else {
-      AT_ERROR("get_stat_type_for_pool: invalid pool");
-    }
+    return pool.is_small ? StatType::SMALL_POOL : StatType::LARGE_POOL;
   }
 
   bool should_split(const Block* block, size_t size) {
     size_t remaining = block->size - size;
-    if (block->pool == &small_blocks) {
+    if (block->pool->is_small) {
       return remaining >= kMinBlockSize;
-    } else if (block->pool == &large_blocks) {
-      return remaining > kSmallSize;
     } else {
-      AT_ERROR("should_split: invalid pool");
+      return (size < CachingAllocatorConfig::max_split_size()) &&
+        (remaining > CachingAllocatorConfig::small_size());
     }
   }
 
   static size_t get_allocation_size(size_t size) {
-    if (size <= kSmallSize) {
-      return kSmallBuffer;
-    } else if (size < kMinLargeAlloc) {
-      return kLargeBuffer;
+    if (size <= CachingAllocatorConfig::small_size()) {
+      return CachingAllocatorConfig::small_buffer();
+    } else if (size < CachingAllocatorConfig::min_large_alloc()) {
+      return CachingAllocatorConfig::large_buffer();
     } else {
-      return kRoundLarge * ((size + kRoundLarge - 1) / kRoundLarge);
+      const size_t round_large = CachingAllocatorConfig::round_large();
+      return round_large * ((size + round_large - 1) / round_large);
     }
   }
 
@@ -609,11 +1419,90 @@ class DeviceCachingAllocator {
     auto it = pool.lower_bound(&p.search_key);
     if (it == pool.end() || (*it)->stream != p.stream())
       return false;
+    const size_t max_split_size = CachingAllocatorConfig::max_split_size();
+    // Do not hand out an oversize block for a request that would split it
+    if ((p.size() < max_split_size) && ((*it)->size >= max_split_size))
+      return false;
+    // Do not waste more than one large buffer on an oversize request
+    if ((p.size() >= max_split_size) &&
+        ((*it)->size >= p.size() + CachingAllocatorConfig::large_buffer()))
+      return false;
     p.block = *it;
     pool.erase(it);
     return true;
   }
 
+  /** finds a block for p among blocks that are only unavailable because of
+      work on other streams, and makes p's stream wait for that work. */
+  bool get_cross_stream_block(AllocParams& p) {
+    if (wait_for_stream_uses(p.stream()) && get_free_block(p)) {
+      return true;
+    }
+
+    // best fit among unsplit segments of other streams. Expandable segments
+    // are reserved per stream and cannot change hands.
+    BlockPool& pool = *p.pool;
+    const size_t max_split_size = CachingAllocatorConfig::max_split_size();
+    Block* best = nullptr;
+    for (Block* block : pool) {
+      if (block->stream == p.stream() || block->is_split() ||
+          block->expandable_segment || block->size < p.size()) {
+        continue;
+      }
+      // same oversize rules as get_free_block
+      if ((p.size() < max_split_size) && (block->size >= max_split_size)) {
+        continue;
+      }
+      if ((p.size() >= max_split_size) &&
+          (block->size >= p.size() + CachingAllocatorConfig::large_buffer())) {
+        continue;
+      }
+      if (!best || block->size < best->size) {
+        best = block;
+      }
+    }
+    if (!best) {
+      return false;
+    }
+
+    // all work using the block was submitted to its stream before it was
+    // freed, so waiting for the work submitted so far is enough
+    cudaEvent_t event = create_event_internal(p.device());
+    C10_CUDA_CHECK(cudaEventRecord(event, best->stream));
+    C10_CUDA_CHECK(cudaStreamWaitEvent(p.stream(), event, 0));
+    free_event_internal(event, p.device());
+
+    pool.erase(best);
+    best->stream = p.stream();
+    p.block = best;
+    return true;
+  }
+
+  /** makes stream wait for the recorded uses of its freed blocks on other
+      streams and returns those blocks to the pool. Returns true if any block
+      became free. */
+  bool wait_for_stream_uses(cudaStream_t stream) {
+    bool freed = false;
+    auto it = cuda_events.begin();
+    while (it != cuda_events.end()) {
+      Block* block = it->block;
+      if (block->stream != stream) {
+        ++it;
+        continue;
+      }
+      C10_CUDA_CHECK(cudaStreamWaitEvent(stream, it->event, 0));
+      free_event_internal(it->event, it->device);
+      it = cuda_events.erase(it);
+
+      block->event_count--;
+      if (block->event_count == 0) {
+        free_block(block);
+        freed = true;
+      }
+    }
+    return freed;
+  }
+
   bool trigger_free_memory_callbacks(AllocParams& p) {
     bool freed_memory = false;
     for (const auto& name : FreeCudaMemoryCallbacksRegistry()->Keys()) {
@@ -631,76 +1520,416 @@ class DeviceCachingAllocator {
       stats.num_alloc_retries += 1;
     }
 
+    // The address ranges of expandable segments are remapped as the cache
+    // grows and shrinks, which graphs replaying fixed addresses cannot
+    // follow, so private pools always cudaMalloc.
+    if (CachingAllocatorConfig::expandable_segments() && !p.pool->owner_PrivatePool) {
+      return alloc_expandable_block(p);
+    }
+
+    if (!within_memory_fraction(size)) {
+      p.err = cudaErrorMemoryAllocation;
+      return false;
+    }
+
     p.err = cudaMalloc(&ptr, size);
     if (p.err != cudaSuccess) {
       if (!isRetry || p.err == cudaErrorMemoryAllocation)
         cudaGetLastError();  // clear CUDA error
       return false;
     }
+    // The allocations that missed the cache, out of the count of
+    // c10_cuda_allocation_bytes
+    C10_METRICS_COUNTER_ADD(
+        "c10_cuda_malloc_calls_total",
+        "Segments the CUDA caching allocator allocated with cudaMalloc",
+        1);
+
+    if (p.pool->owner_PrivatePool) {
+      p.pool->owner_PrivatePool->cudaMalloc_count++;
+    }
 
     p.block = new Block(p.device(), p.stream(), size, p.pool, (char*)ptr);
     update_stat_array(stats.segment, 1, p.stat_types);
     update_stat_array(stats.reserved_bytes, size, p.stat_types);
+    record_trace(TraceEntry::SEGMENT_ALLOC, ptr, size, p.stream(), p.context);
 
     return (p.block != nullptr);
   }
 
+  // true if b is unused address space of an expandable segment, mapped or not
+  static bool is_expandable_free(const Block* b) {
+    return b && b->expandable_segment && !b->allocated &&
+      b->event_count == 0 && b->stream_uses.empty();
+  }
+
+  /** returns a block of unused address space in an expandable segment for the
+      stream of p, such that it and the blocks following it span p.size().
+      Reserves a new segment if there is none. */
+  Block* find_expandable_block(AllocParams& p) {
+    BlockPool& unmapped = get_unmapped_pool(*p.pool);
+    const size_t size = p.size();
+
+    auto has_available_address_space = [&](Block* b) {
+      size_t bytes = 0;
+      while (bytes < size && is_expandable_free(b)) {
+        bytes += b->size;
+        b = b->next;
+      }
+      return bytes >= size;
+    };
+
+    Block key(p.device(), p.stream(), 0);
+    for (auto it = unmapped.lower_bound(&key);
+         it != unmapped.end() && (*it)->stream == p.stream(); ++it) {
+      Block* candidate = *it;
+      // a free block right before the unmapped range can be grown in place
+      if (is_expandable_free(candidate->prev)) {
+        candidate = candidate->prev;
+      }
+      if (has_available_address_space(candidate)) {
+        return candidate;
+      }
+    }
+
+    TORCH_CHECK(ExpandableSegment::supported(p.device()),
+      "expandable_segments:True requires a device that supports virtual memory management");
+    const size_t segment_size = p.pool->is_small
+      ? CachingAllocatorConfig::small_buffer()
+      : CachingAllocatorConfig::large_buffer();
+    const size_t granularity = ExpandableSegment::granularity(p.device());
+    TORCH_CHECK(segment_size % granularity == 0,
+      "expandable_segments:True requires small_buffer_mb and large_buffer_mb to be multiples of ",
+      format_size(granularity));
+
+    expandable_segments.emplace_back(new ExpandableSegment(p.device(), p.stream(), segment_size));
+    ExpandableSegment* segment = expandable_segments.back().get();
+    Block* candidate = new Block(p.device(), p.stream(), segment->size(), p.pool, segment->ptr());
+    candidate->mapped = false;
+    candidate->expandable_segment = segment;
+    unmapped.insert(candidate);
+    update_stat_array(stats.segment, 1, p.stat_types);
+    return candidate;
+  }
+
+  /** backs the first size bytes of an unmapped block with memory and moves
+      them into the pool of free blocks, merging with free neighbours. */
+  bool map_block(Block* to_map, size_t size, const StatTypes& stat_types,
+                 const std::shared_ptr<Context>& context) {
+    TORCH_INTERNAL_ASSERT(!to_map->mapped && size <= to_map->size);
+    // unmapped blocks start on a page boundary, so the pages to map are known
+    const size_t page = to_map->expandable_segment->segmentSize();
+    if (!within_memory_fraction(std::min(to_map->size, (size + page - 1) / page * page))) {
+      return false;
+    }
+    const SegmentRange mapped_range =
+      to_map->expandable_segment->map(SegmentRange(to_map->ptr, size));
+    if (mapped_range.size == 0) {
+      return false;
+    }
+    TORCH_INTERNAL_ASSERT(mapped_range.ptr == to_map->ptr && mapped_range.size >= size);
+
+    BlockPool& pool = *to_map->pool;
+    get_unmapped_pool(pool).erase(to_map);
+    to_map->mapped = true;
+    if (mapped_range.size < to_map->size) {
+      Block* remaining = new Block(to_map->device, to_map->stream,
+        to_map->size - mapped_range.size, &pool, mapped_range.ptr + mapped_range.size);
+      remaining->mapped = false;
+      remaining->expandable_segment = to_map->expandable_segment;
+      remaining->splice(to_map, to_map->next);
+      get_unmapped_pool(pool).insert(remaining);
+      to_map->size = mapped_range.size;
+    }
+
+    const std::array<Block*, 2> merge_candidates = {to_map->prev, to_map->next};
+    for (Block* merge_candidate : merge_candidates) {
+      try_merge_blocks(to_map, merge_candidate, pool);
+    }
+    pool.insert(to_map);
+
+    update_stat_array(stats.reserved_bytes, mapped_range.size, stat_types);
+    record_trace(TraceEntry::SEGMENT_ALLOC, mapped_range.ptr, mapped_range.size,
+      to_map->stream, context);
+    return true;
+  }
+
+  bool alloc_expandable_block(AllocParams& p) {
+    const size_t size = p.size();
+    Block* candidate = find_expandable_block(p);
+    // candidate is either unmapped, or free and followed by unmapped space
+    if (!candidate->mapped &&
+        !map_block(candidate, std::min(candidate->size, size), p.stat_types, p.context)) {
+      p.err = cudaErrorMemoryAllocation;
+      return false;
+    }
+    TORCH_INTERNAL_ASSERT(candidate->mapped);
+    while (candidate->size < size) {
+      // map_block merges the next unmapped range into candidate (and frees
+      // candidate), so continue with the merged block.
+      Block* next = candidate->next;
+      if (!map_block(next, std::min(size - candidate->size, next->size), p.stat_types, p.context)) {
+        p.err = cudaErrorMemoryAllocation;
+        return false;
+      }
+      candidate = next;
+    }
+    p.pool->erase(candidate);
+    p.block = candidate;
+    return true;
+  }
+
+  /** releases the memory of all whole pages in a free expandable block. */
+  void unmap_block(Block* block) {
+    const SegmentRange unmapped =
+      block->expandable_segment->unmap(SegmentRange(block->ptr, block->size));
+    if (unmapped.size == 0) {
+      return;
+    }
+
+    BlockPool& pool = *block->pool;
+    StatTypes stat_types;
+    stat_types[static_cast<size_t>(StatType::AGGREGATE)] = true;
+    stat_types[static_cast<size_t>(get_stat_type_for_pool(pool))] = true;
+
+    pool.erase(block);
+
+    // partial pages at either end stay mapped as free blocks
+    const size_t before_size = unmapped.ptr - static_cast<char*>(block->ptr);
+    if (before_size > 0) {
+      Block* before_free = new Block(block->device, block->stream, before_size, &pool, block->ptr);
+      before_free->expandable_segment = block->expandable_segment;
+      before_free->splice(block->prev, block);
+      pool.insert(before_free);
+    }
+    const size_t after_size = block->size - (before_size + unmapped.size);
+    if (after_size > 0) {
+      Block* after_free = new Block(block->device, block->stream, after_size, &pool,
+        unmapped.ptr + unmapped.size);
+      after_free->expandable_segment = block->expandable_segment;
+      after_free->splice(block, block->next);
+      pool.insert(after_free);
+    }
+
+    block->ptr = unmapped.ptr;
+    block->size = unmapped.size;
+    block->mapped = false;
+    const std::array<Block*, 2> merge_candidates = {block->prev, block->next};
+    for (Block* merge_candidate : merge_candidates) {
+      try_merge_blocks(block, merge_candidate, pool);
+    }
+    get_unmapped_pool(pool).insert(block);
+
+    update_stat_array(stats.reserved_bytes, -unmapped.size, stat_types);
+    record_trace(TraceEntry::SEGMENT_FREE, unmapped.ptr, unmapped.size, block->stream, nullptr);
+  }
+
+  /** gives back the address space of expandable segments that are entirely unmapped */
+  void release_expandable_segments(BlockPool& pool) {
+    BlockPool& unmapped = get_unmapped_pool(pool);
+    StatTypes stat_types;
+    stat_types[static_cast<size_t>(StatType::AGGREGATE)] = true;
+    stat_types[static_cast<size_t>(get_stat_type_for_pool(pool))] = true;
+
+    auto it = unmapped.begin();
+    while (it != unmapped.end()) {
+      Block* block = *it;
+      if (block->is_split()) {
+        ++it;
+        continue;
+      }
+      ExpandableSegment* segment = block->expandable_segment;
+      it = unmapped.erase(it);
+      delete block;
+      expandable_segments.erase(std::find_if(
+        expandable_segments.begin(), expandable_segments.end(),
+        [&](const std::unique_ptr<ExpandableSegment>& s) { return s.get() == segment; }));
+      update_stat_array(stats.segment, -1, stat_types);
+    }
+  }
+
   bool free_cached_blocks()
   {
     // First ensure that all blocks that can't currently be allocated due to
     // outstanding events are returned to the pool.
     synchronize_and_free_events();
+    destroy_free_events();
 
     // Free all non-split cached blocks
     free_blocks(large_blocks);
     free_blocks(small_blocks);
+
+    // Free the cached blocks of private pools no graph uses anymore, and the
+    // pools themselves once all of their segments are released
+    auto it = graph_pools_freeable.begin();
+    while (it != graph_pools_freeable.end()) {
+      PrivatePool* private_pool = it->second;
+      TORCH_INTERNAL_ASSERT(private_pool->use_count == 0);
+      free_blocks(private_pool->large_blocks);
+      free_blocks(private_pool->small_blocks);
+      if (private_pool->cudaMalloc_count == 0) {
+        const auto erased = graph_pools.erase(it->first);
+        TORCH_INTERNAL_ASSERT(erased == 1);
+        it = graph_pools_freeable.erase(it);
+      } else {
+        ++it;
+      }
+    }
     return true;
   }
 
+  bool within_memory_fraction(size_t size) const {
+    return !set_fraction ||
+      stats.reserved_bytes[static_cast<size_t>(StatType::AGGREGATE)].current + size <= allowed_memory_maximum;
+  }
+
+  // true if the block is a whole cudaMalloc'd segment that can be cudaFree'd
+  static bool is_releasable(const Block* block) {
+    return !block->expandable_segment && !block->prev && !block->next;
+  }
+
+  /** cudaFrees a releasable cached block **/
+  void release_block(Block* block) {
+    C10_CUDA_CHECK(cudaFree((void*)block->ptr));
+
+    StatTypes stat_types;
+    stat_types[static_cast<size_t>(StatType::AGGREGATE)] = true;
+    stat_types[static_cast<size_t>(get_stat_type_for_pool(*(block->pool)))] = true;
+    update_stat_array(stats.segment, -1, stat_types);
+    update_stat_array(stats.reserved_bytes, -block->size, stat_types);
+    record_trace(TraceEntry::SEGMENT_FREE, block->ptr, block->size, block->stream, nullptr);
+
+    if (block->pool->owner_PrivatePool) {
+      TORCH_INTERNAL_ASSERT(block->pool->owner_PrivatePool->cudaMalloc_count > 0);
+      block->pool->owner_PrivatePool->cudaMalloc_count--;
+    }
+
+    block->pool->erase(block);
+    delete block;
+  }
+
+  /** releases the least recently freed releasable cached blocks until at
+      least bytes bytes are returned. Returns the number of bytes released. */
+  size_t release_lru_blocks(size_t bytes) {
+    std::vector<Block*> candidates;
+    for (BlockPool* pool : {&large_blocks, &small_blocks}) {
+      for (Block* block : *pool) {
+        if (is_releasable(block)) {
+          candidates.push_back(block);
+        }
+      }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+      [](const Block* a, const Block* b) { return a->free_tick < b->free_tick; });
+
+    size_t released = 0;
+    for (Block* block : candidates) {
+      if (released >= bytes) {
+        break;
+      }
+      released += block->size;
+      release_block(block);
+    }
+    return released;
+  }
+
+  /** on a failed allocation, releases just enough cached memory for it.
+      Unlike free_cached_blocks, this does not synchronize with other streams. */
+  bool release_lru_cached_blocks(AllocParams& p) {
+    if (p.err != cudaErrorMemoryAllocation) {
+      return false;
+    }
+    size_t needed = p.alloc_size;
+    if (set_fraction) {
+      const size_t reserved =
+        stats.reserved_bytes[static_cast<size_t>(StatType::AGGREGATE)].current;
+      if (reserved + p.alloc_size > allowed_memory_maximum) {
+        needed = reserved + p.alloc_size - allowed_memory_maximum;
+      }
+    }
+    return release_lru_blocks(needed) > 0;
+  }
+
+  /** keeps reserved memory below garbage_collection_threshold of the cap by
+      releasing the least recently freed cached blocks. */
+  void garbage_collect_cached_blocks() {
+    const double threshold = CachingAllocatorConfig::garbage_collection_threshold();
+    if (!set_fraction || threshold <= 0) {
+      return;
+    }
+    const size_t gc_threshold = static_cast<size_t>(threshold * allowed_memory_maximum);
+    const size_t reserved =
+      stats.reserved_bytes[static_cast<size_t>(StatType::AGGREGATE)].current;
+    if (reserved <= gc_threshold) {
+      return;
+    }
+    release_lru_blocks(reserved - gc_threshold);
+  }
+
   void free_blocks(BlockPool& blocks)
   {
     // Frees all non-split blocks
     auto it = blocks.begin();
     while (it != blocks.end()) {
       Block* block = *it;
-      if (!block->prev && !block->next) {
-        C10_CUDA_CHECK(cudaFree((void*)block->ptr));
+      ++it;
+      if (is_releasable(block)) {
+        release_block(block);
+      }
+    }
 
-        StatTypes stat_types;
-        stat_types[static_cast<size_t>(StatType::AGGREGATE)] = true;
-        stat_types[static_cast<size_t>(get_stat_type_for_pool(*(block->pool)))] = true;
-        update_stat_array(stats.segment, -1, stat_types);
-        update_stat_array(stats.reserved_bytes, -block->size, stat_types);
+    if (blocks.owner_PrivatePool) {
+      return;
+    }
 
-        auto cur = it;
-        ++it;
-        blocks.erase(cur);
-        delete block;
-      } else {
-        ++it;
+    // Unmaps the free pages of expandable segments, split or not
+    std::vector<Block*> to_unmap;
+    for (Block* block : blocks) {
+      if (block->expandable_segment) {
+        to_unmap.push_back(block);
       }
     }
+    for (Block* block : to_unmap) {
+      unmap_block(block);
+    }
+    release_expandable_segments(blocks);
   }
 
-  cudaEvent_t create_event_internal() {
+  /** returns an event of the current device, which must be device **/
+  cudaEvent_t create_event_internal(int device) {
+    auto& events = free_events[device];
+    if (!events.empty()) {
+      cudaEvent_t event = events.back();
+      events.pop_back();
+      return event;
+    }
     cudaEvent_t event;
     C10_CUDA_CHECK(cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
     return event;
   }
 
-  void free_event_internal(cudaEvent_t event) {
-    C10_CUDA_CHECK(cudaEventDestroy(event));
+  void free_event_internal(cudaEvent_t event, int device) {
+    free_events[device].push_back(event);
+  }
+
+  void destroy_free_events() {
+    for (auto& device_events : free_events) {
+      for (cudaEvent_t event : device_events.second) {
+        C10_CUDA_CHECK(cudaEventDestroy(event));
+      }
+    }
+    free_events.clear();
   }
 
   void synchronize_and_free_events() {
     // Synchronize on outstanding events and then free associated blocks.
 
     for (auto& e : cuda_events) {
-      cudaEvent_t event = e.first;
-      Block* block = e.second;
+      cudaEvent_t event = e.event;
+      Block* block = e.block;
 
       C10_CUDA_CHECK(cudaEventSynchronize(event));
-      free_event_internal(event);
+      free_event_internal(event, e.device);
 
       block->event_count--;
       if (block->event_count == 0) {
@@ -721,16 +1950,26 @@ class DeviceCachingAllocator {
     for (auto it = streams.begin(); it != streams.end(); ++it) {
       C10_CUDA_CHECK(cudaSetDevice(it->device_index()));
 
-      cudaEvent_t event = create_event_internal();
+      cudaEvent_t event = create_event_internal(it->device_index());
       C10_CUDA_CHECK(cudaEventRecord(event, it->stream()));
 
       block->event_count++;
-      cuda_events.emplace_back(event, block);
+      cuda_events.emplace_back(event, it->device_index(), block);
     }
 
     C10_CUDA_CHECK(cudaSetDevice(prev_device));
   }
 
+  void insert_events_deferred_until_no_capture() {
+    if (C10_UNLIKELY(!needs_events_deferred_until_no_capture.empty())) {
+      for (Block* block : needs_events_deferred_until_no_capture) {
+        TORCH_INTERNAL_ASSERT(!block->stream_uses.empty());
+        insert_events(block);
+      }
+      needs_events_deferred_until_no_capture.clear();
+    }
+  }
+
   void process_events()
   {
     // Process outstanding cudaEvents. Events that are completed are removed
@@ -740,8 +1979,8 @@ class DeviceCachingAllocator {
     // the processing of some events may be delayed.
     while (!cuda_events.empty()) {
       auto& e = cuda_events.front();
-      cudaEvent_t event = e.first;
-      Block* block = e.second;
+      cudaEvent_t event = e.event;
+      Block* block = e.block;
 
       cudaError_t err = cudaEventQuery(event);
       if (err == cudaErrorNotReady) {
@@ -752,7 +1991,7 @@ class DeviceCachingAllocator {
         C10_CUDA_CHECK(err);
       }
 
-      free_event_internal(event);
+      free_event_internal(event, e.device);
 
       block->event_count--;
       if (block->event_count == 0) {
@@ -968,10 +2207,144 @@ void resetPeakStats(int device) {
   caching_allocator.device_allocator[device]->resetPeakStats();
 }
 
+void setMemoryFraction(double fraction, int device) {
+  assertValidDevice(device);
+  TORCH_CHECK(0 <= fraction && fraction <= 1,
+    "invalid fraction: ", fraction, ". Please set within [0, 1].");
+  CUDAGuard device_guard(device);
+  caching_allocator.device_allocator[device]->setMemoryFraction(fraction);
+}
+
 std::vector<SegmentInfo> snapshot() {
   return caching_allocator.snapshot();
 }
 
+void setAllocatorSettings(const std::string& env) {
+  CachingAllocatorConfig::setAllocatorSettings(env);
+}
+
+void recordHistory(bool enabled, CreateContextFn context_recorder, size_t max_entries) {
+  for (auto& allocator : caching_allocator.device_allocator) {
+    allocator->recordHistory(enabled, context_recorder, max_entries);
+  }
+}
+
+std::vector<TraceEntry> getHistory(int device) {
+  assertValidDevice(device);
+  return caching_allocator.device_allocator[device]->history();
+}
+
+void notifyCaptureBegin(int device, CaptureId_t graph_id, MempoolId_t mempool_id) {
+  assertValidDevice(device);
+  caching_allocator.device_allocator[device]->notifyCaptureBegin(graph_id, mempool_id);
+}
+
+void notifyCaptureEnd(int device, CaptureId_t graph_id) {
+  assertValidDevice(device);
+  caching_allocator.device_allocator[device]->notifyCaptureEnd(graph_id);
+}
+
+void notifyCaptureDestroy(int device, MempoolId_t mempool_id) {
+  assertValidDevice(device);
+  caching_allocator.device_allocator[device]->notifyCaptureDestroy(mempool_id);
+}
+
+namespace {
+
+struct CppBacktraceContext : public Context {
+  explicit CppBacktraceContext(std::string backtrace) : backtrace(std::move(backtrace)) {}
+  std::string str() const override {
+    return backtrace;
+  }
+  std::string backtrace;
+};
+
+const char* trace_action_name(TraceEntry::Action action) {
+  switch (action) {
+    case TraceEntry::ALLOC:
+      return "alloc";
+    case TraceEntry::FREE:
+      return "free";
+    case TraceEntry::SPLIT:
+      return "split";
+    case TraceEntry::MERGE:
+      return "merge";
+    case TraceEntry::SEGMENT_ALLOC:
+      return "segment_alloc";
+    case TraceEntry::SEGMENT_FREE:
+      return "segment_free";
+    case TraceEntry::OOM:
+      return "oom";
+  }
+  return "unknown";
+}
+
+void write_json_string(std::ostream& os, const std::string& str) {
+  static const char* hex = "0123456789abcdef";
+  os << '"';
+  for (const char c : str) {
+    switch (c) {
+      case '"':
+        os << "\\\"";
+        break;
+      case '\\':
+        os << "\\\\";
+        break;
+      case '\n':
+        os << "\\n";
+        break;
+      case '\t':
+        os << "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          os << "\\u00" << hex[(c >> 4) & 0xf] << hex[c & 0xf];
+        } else {
+          os << c;
+        }
+    }
+  }
+  os << '"';
+}
+
+} // namespace
+
+std::shared_ptr<Context> gatherCppBacktrace() {
+  // skip this function and the allocator frames above it
+  return std::make_shared<CppBacktraceContext>(c10::get_backtrace(/*frames_to_skip=*/3));
+}
+
+std::string historyToJson() {
+  std::ostringstream os;
+  os << "{\"traceEvents\": [";
+  bool first = true;
+  const int count = caching_allocator.device_allocator.size();
+  for (int device = 0; device < count; ++device) {
+    for (const TraceEntry& entry : caching_allocator.device_allocator[device]->history()) {
+      os << (first ? "\n" : ",\n");
+      first = false;
+      os << "{\"name\": \"" << trace_action_name(entry.action)
+         << "\", \"cat\": \"cuda_memory\", \"ph\": \"i\", \"s\": \"t\""
+         << ", \"pid\": " << device
+         << ", \"tid\": " << reinterpret_cast<uintptr_t>(entry.stream)
+         << ", \"ts\": " << entry.time_us
+         << ", \"args\": {\"addr\": " << entry.addr
+         << ", \"size\": " << entry.size;
+      if (entry.context) {
+        os << ", \"stack\": ";
+        write_json_string(os, entry.context->str());
+      }
+      os << "}},\n";
+      os << "{\"name\": \"memory\", \"ph\": \"C\", \"pid\": " << device
+         << ", \"ts\": " << entry.time_us
+         << ", \"args\": {\"allocated\": " << entry.allocated_bytes
+         << ", \"reserved\": " << entry.reserved_bytes << "}}";
+    }
+  }
+  os << "\n]}\n";
+  return os.str();
+}
+
 //
 // In CUDA IPC, sender sends a tensor to receiver, getIpcDevPtr
 // is called by the receiving process to map the CUDA memory from the sending
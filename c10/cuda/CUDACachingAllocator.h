@@ -7,7 +7,17 @@
 #include <c10/util/Registry.h>
 
 #include <array>
+#include <memory>
 #include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Stream capture into CUDA graphs needs CUDA 11 (cudaStreamGetCaptureInfo
+// and friends).
+#if !defined(__HIP_PLATFORM_HCC__) && defined(CUDART_VERSION) && CUDART_VERSION >= 11000
+#define C10_CUDA_GRAPHS_SUPPORTED
+#endif
 
 namespace c10 {
 
@@ -102,9 +112,45 @@ struct SegmentInfo {
   int64_t allocated_size = 0;
   int64_t active_size = 0;
   bool is_large = false;
+  bool is_expandable = false;
   std::vector<BlockInfo> blocks;
 };
 
+// Annotation attached to allocation history entries, e.g. a stack trace.
+struct C10_CUDA_API Context {
+  virtual ~Context() {}
+  // human readable form, used when the history is exported
+  virtual std::string str() const = 0;
+};
+
+// Called by the allocator, outside of its locks, to annotate history entries.
+typedef std::shared_ptr<Context> (*CreateContextFn)(void);
+
+// One event in the allocation history of a device, see recordHistory().
+struct TraceEntry {
+  enum Action {
+    ALLOC,         // block handed out to client code
+    FREE,          // block returned by client code
+    SPLIT,         // cached block split to serve an allocation; addr and size
+                   // describe the remainder that stays cached
+    MERGE,         // freed block merged with a free neighbour; addr and size
+                   // describe the merged block
+    SEGMENT_ALLOC, // cudaMalloc, or pages mapped into an expandable segment
+    SEGMENT_FREE,  // cudaFree, or pages unmapped from an expandable segment
+    OOM            // allocation failed; size is the request, addr the free
+                   // device memory reported by the driver
+  };
+
+  Action action;
+  int64_t addr;
+  int64_t size;
+  cudaStream_t stream;
+  int64_t time_us;          // microseconds since the epoch
+  int64_t allocated_bytes;  // device totals right after the event
+  int64_t reserved_bytes;
+  std::shared_ptr<Context> context;
+};
+
 C10_CUDA_API void* raw_alloc(size_t nbytes);
 C10_CUDA_API void* raw_alloc_with_stream(size_t nbytes, cudaStream_t stream);
 C10_CUDA_API void raw_delete(void* ptr);
@@ -118,10 +164,50 @@ C10_CUDA_API void recordStream(const DataPtr&, CUDAStream stream);
 C10_CUDA_API DeviceStats getDeviceStats(int device);
 C10_CUDA_API void resetAccumulatedStats(int device);
 C10_CUDA_API void resetPeakStats(int device);
+// Caps the memory the allocator may reserve on device at fraction of its
+// total memory. Allocations beyond the cap raise an out-of-memory error.
+C10_CUDA_API void setMemoryFraction(double fraction, int device);
 C10_CUDA_API std::vector<SegmentInfo> snapshot();
+// Applies a PYTORCH_CUDA_ALLOC_CONF style string, e.g.
+// "max_split_size_mb:512,roundup_power2_divisions:4", on top of the current
+// settings. Only allocations made afterwards are affected.
+C10_CUDA_API void setAllocatorSettings(const std::string& env);
+
+// Starts (or stops) recording allocator events into a ring buffer of the last
+// max_entries events per device. Enabling clears the previous history. If
+// context_recorder is given, it is called for every client allocation and
+// free and its result is attached to the entries caused by that call.
+C10_CUDA_API void recordHistory(
+    bool enabled,
+    CreateContextFn context_recorder,
+    size_t max_entries);
+// Returns the recorded events of a device, oldest first.
+C10_CUDA_API std::vector<TraceEntry> getHistory(int device);
+// Returns the history of all devices as a Chrome trace (chrome://tracing)
+// JSON document: one instant event per entry plus a counter track of the
+// allocated and reserved bytes of each device.
+C10_CUDA_API std::string historyToJson();
+// Context recorder that captures the C++ stack with c10::get_backtrace().
+C10_CUDA_API std::shared_ptr<Context> gatherCppBacktrace();
 
 C10_CUDA_API std::mutex* getFreeMutex();
 
+// CUDA graph capture support. Allocations made on a stream that is being
+// captured come from a private pool of the capture, so that the addresses
+// baked into the graph stay reserved for its replays, even after the tensors
+// of the capture are freed. Several captures may share a pool by passing the
+// same mempool_id to notifyCaptureBegin. A pool's memory is returned to the
+// cache's cudaFree path (emptyCache) only once every graph using it was
+// destroyed and all of its blocks were freed.
+using CaptureId_t = unsigned long long;
+// first is the capture id of the graph that created the pool, or 0 for a
+// handle reserved with graph_pool_handle(), whose id is in second
+using MempoolId_t = std::pair<CaptureId_t, CaptureId_t>;
+
+C10_CUDA_API void notifyCaptureBegin(int device, CaptureId_t graph_id, MempoolId_t mempool_id);
+C10_CUDA_API void notifyCaptureEnd(int device, CaptureId_t graph_id);
+C10_CUDA_API void notifyCaptureDestroy(int device, MempoolId_t mempool_id);
+
 C10_CUDA_API std::shared_ptr<void> getIpcDevPtr(std::string handle);
 } // namespace CUDACachingAllocator
 
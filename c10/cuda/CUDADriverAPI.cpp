@@ -0,0 +1,39 @@
+#include <c10/cuda/CUDADriverAPI.h>
+
+#ifdef C10_CUDA_DRIVER_API_SUPPORTED
+
+#include <dlfcn.h>
+
+namespace c10 {
+namespace cuda {
+
+namespace {
+
+DriverAPI create_driver_api() {
+  void* handle = dlopen("libcuda.so.1", RTLD_LAZY | RTLD_NOLOAD);
+  if (!handle) {
+    handle = dlopen("libcuda.so.1", RTLD_LAZY);
+  }
+  TORCH_CHECK(handle, "Error in dlopen for libcuda.so.1: ", dlerror());
+
+  DriverAPI r{};
+
+#define LOOKUP_ENTRY(name)                                             \
+  r.name##_ = reinterpret_cast<decltype(&name)>(dlsym(handle, #name)); \
+  TORCH_INTERNAL_ASSERT(r.name##_, "Can't find ", #name, ": ", dlerror());
+  C10_FORALL_DRIVER_API(LOOKUP_ENTRY)
+#undef LOOKUP_ENTRY
+
+  return r;
+}
+
+} // namespace
+
+DriverAPI* DriverAPI::get() {
+  static DriverAPI singleton = create_driver_api();
+  return &singleton;
+}
+
+}} // namespace c10::cuda
+
+#endif // C10_CUDA_DRIVER_API_SUPPORTED
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <c10/cuda/CUDAException.h>
+#include <c10/cuda/CUDAMacros.h>
+
+// NOTE [ USE OF DRIVER API IN C10 CUDA ]
+//
+// c10_cuda does not link against libcuda, for the same reason ATen does not
+// (see NOTE [ USE OF NVRTC AND DRIVER API ] in ATen/cuda/nvrtc_stub): a CUDA
+// build must still be importable on a machine that has no driver installed.
+// The few driver entry points c10 needs (currently only the virtual memory
+// management API used by the caching allocator) are resolved lazily with
+// dlopen the first time DriverAPI::get() is called.
+//
+// IT IS AN ERROR TO CALL ANY cu* FUNCTION DIRECTLY FROM c10. Instead, do
+//
+//   C10_CUDA_DRIVER_CHECK(DriverAPI::get()->cuMemCreate_(...));
+//
+// If a function is missing, add it to C10_FORALL_DRIVER_API below.
+
+#if !defined(__HIP_PLATFORM_HCC__) && !defined(_WIN32) && \
+    defined(CUDA_VERSION) && CUDA_VERSION >= 10020
+#define C10_CUDA_DRIVER_API_SUPPORTED
+#endif
+
+#ifdef C10_CUDA_DRIVER_API_SUPPORTED
+
+#define C10_CUDA_DRIVER_CHECK(EXPR)                                          \
+  do {                                                                       \
+    CUresult __err = EXPR;                                                   \
+    if (__err != CUDA_SUCCESS) {                                             \
+      const char* __err_str = nullptr;                                       \
+      ::c10::cuda::DriverAPI::get()->cuGetErrorString_(__err, &__err_str);   \
+      TORCH_CHECK(                                                           \
+          false,                                                             \
+          "CUDA driver error: ",                                             \
+          __err_str ? __err_str : "unknown error");                          \
+    }                                                                        \
+  } while (0)
+
+#define C10_FORALL_DRIVER_API(_)     \
+  _(cuGetErrorString)                \
+  _(cuDeviceGet)                     \
+  _(cuDeviceGetAttribute)            \
+  _(cuMemAddressReserve)             \
+  _(cuMemAddressFree)                \
+  _(cuMemCreate)                     \
+  _(cuMemRelease)                    \
+  _(cuMemMap)                        \
+  _(cuMemUnmap)                      \
+  _(cuMemSetAccess)                  \
+  _(cuMemGetAllocationGranularity)
+
+namespace c10 {
+namespace cuda {
+
+struct C10_CUDA_API DriverAPI {
+#define CREATE_MEMBER(name) decltype(&name) name##_;
+  C10_FORALL_DRIVER_API(CREATE_MEMBER)
+#undef CREATE_MEMBER
+
+  // Returns the process-wide function table. Throws if libcuda cannot be
+  // loaded or does not export one of the required symbols.
+  static DriverAPI* get();
+};
+
+}} // namespace c10::cuda
+
+#endif // C10_CUDA_DRIVER_API_SUPPORTED
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include <c10/core/CPUAllocator.h>
+#include <c10/core/CPUCachingAllocator.h>
+
+using namespace c10;
+
+TEST(CPUCachingAllocatorTest, ReusesFreedBlocks) {
+  at::Allocator* allocator = GetCPUCachingAllocator();
+  CPUCachingAllocator::emptyCache();
+  auto before = CPUCachingAllocator::getStats();
+
+  void* first;
+  {
+    at::DataPtr ptr = allocator->allocate(1000);
+    first = ptr.get();
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(first) % gAlignment, 0);
+    ASSERT_EQ(ptr.get(), ptr.get_context());
+  }
+  // Same size class, so the block just freed is handed out again.
+  at::DataPtr ptr = allocator->allocate(600);
+  ASSERT_EQ(ptr.get(), first);
+
+  auto after = CPUCachingAllocator::getStats();
+  ASSERT_EQ(after.num_cache_misses - before.num_cache_misses, 1);
+  ASSERT_EQ(after.num_cache_hits - before.num_cache_hits, 1);
+  ASSERT_EQ(after.allocation.current - before.allocation.current, 1);
+  ASSERT_EQ(after.allocated_bytes.current - before.allocated_bytes.current, 600);
+  ASSERT_EQ(after.allocated_bytes.allocated - before.allocated_bytes.allocated, 1600);
+}
+
+TEST(CPUCachingAllocatorTest, LargeAllocationsAreNotCached) {
+  at::Allocator* allocator = GetCPUCachingAllocator();
+  CPUCachingAllocator::emptyCache();
+  auto before = CPUCachingAllocator::getStats();
+  {
+    at::DataPtr ptr =
+        allocator->allocate(CPUCachingAllocator::kMaxCachedBlockSize * 2);
+  }
+  auto after = CPUCachingAllocator::getStats();
+  ASSERT_EQ(after.reserved_bytes.current, before.reserved_bytes.current);
+  ASSERT_EQ(after.num_cache_misses - before.num_cache_misses, 1);
+}
+
+TEST(CPUCachingAllocatorTest, EmptyCacheReleasesBlocks) {
+  at::Allocator* allocator = GetCPUCachingAllocator();
+  CPUCachingAllocator::emptyCache();
+  auto before = CPUCachingAllocator::getStats();
+  {
+    std::vector<at::DataPtr> ptrs;
+    for (size_t nbytes = 1; nbytes < (1 << 16); nbytes *= 3) {
+      ptrs.push_back(allocator->allocate(nbytes));
+    }
+  }
+  ASSERT_GT(
+      CPUCachingAllocator::getStats().reserved_bytes.current,
+      before.reserved_bytes.current);
+  CPUCachingAllocator::emptyCache();
+  ASSERT_EQ(
+      CPUCachingAllocator::getStats().reserved_bytes.current,
+      before.reserved_bytes.current);
+}
+
+TEST(CPUCachingAllocatorTest, CrossThreadFree) {
+  at::Allocator* allocator = GetCPUCachingAllocator();
+  CPUCachingAllocator::emptyCache();
+  auto before = CPUCachingAllocator::getStats();
+
+  std::vector<at::DataPtr> ptrs;
+  std::thread producer([&] {
+    for (int i = 0; i < 100; ++i) {
+      ptrs.push_back(allocator->allocate(256));
+    }
+  });
+  producer.join();
+  // The producer's (empty) cache is gone; freeing here must still work and
+  // keep the process-wide counts balanced.
+  ptrs.clear();
+
+  auto after = CPUCachingAllocator::getStats();
+  ASSERT_EQ(after.allocation.current, before.allocation.current);
+  ASSERT_EQ(after.allocated_bytes.current, before.allocated_bytes.current);
+  ASSERT_EQ(after.allocation.allocated - before.allocation.allocated, 100);
+
+  // The blocks now sit in this thread's cache.
+  at::DataPtr ptr = allocator->allocate(256);
+  ASSERT_EQ(
+      CPUCachingAllocator::getStats().num_cache_hits - after.num_cache_hits, 1);
+}
+
+TEST(CPUCachingAllocatorTest, ZeroFill) {
+  at::Allocator* allocator = GetCPUCachingAllocator();
+  {
+    at::DataPtr ptr = allocator->allocate(128);
+    memset(ptr.get(), 0xff, 128);
+  }
+  FLAGS_caffe2_cpu_allocator_do_zero_fill = true;
+  at::DataPtr ptr = allocator->allocate(128);
+  FLAGS_caffe2_cpu_allocator_do_zero_fill = false;
+  for (int i = 0; i < 128; ++i) {
+    ASSERT_EQ(static_cast<uint8_t*>(ptr.get())[i], 0);
+  }
+}
@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+
+#include <c10/core/thread_budget.h>
+#include <c10/util/Exception.h>
+
+using namespace c10;
+
+TEST(ThreadBudgetTest, UncappedGrantsRequests) {
+  auto& budget = ThreadBudget::global();
+  budget.setCap(0);
+  size_t before = budget.numThreads(ThreadPoolKind::InterOp);
+  ASSERT_EQ(budget.acquire(ThreadPoolKind::InterOp, 64), 64);
+  ASSERT_EQ(budget.numThreads(ThreadPoolKind::InterOp), before + 64);
+  budget.release(ThreadPoolKind::InterOp, 64);
+  ASSERT_EQ(budget.numThreads(ThreadPoolKind::InterOp), before);
+}
+
+TEST(ThreadBudgetTest, CapSharedAcrossPools) {
+  auto& budget = ThreadBudget::global();
+  size_t used = budget.numThreads();
+  budget.setCap(used + 8);
+  ASSERT_EQ(budget.cap(), used + 8);
+
+  ASSERT_EQ(budget.acquire(ThreadPoolKind::IntraOp, 6, 0), 6);
+  // Only 2 threads are left for the next pool.
+  ASSERT_EQ(budget.acquire(ThreadPoolKind::Distributed, 4), 2);
+  // The budget is spent, but pools still get their minimum.
+  ASSERT_EQ(budget.acquire(ThreadPoolKind::InterOp, 4, 0), 0);
+  ASSERT_EQ(budget.acquire(ThreadPoolKind::Autograd, 3, 3), 3);
+  ASSERT_EQ(budget.numThreads(), used + 11);
+
+  // Released threads can be granted again.
+  budget.release(ThreadPoolKind::IntraOp, 6);
+  ASSERT_EQ(budget.acquire(ThreadPoolKind::InterOp, 4), 3);
+
+  budget.release(ThreadPoolKind::Distributed, 2);
+  budget.release(ThreadPoolKind::Autograd, 3);
+  budget.release(ThreadPoolKind::InterOp, 3);
+  ASSERT_EQ(budget.numThreads(), used);
+  budget.setCap(0);
+}
+
+TEST(ThreadBudgetTest, ReleaseMoreThanAcquiredThrows) {
+  auto& budget = ThreadBudget::global();
+  size_t threads = budget.numThreads(ThreadPoolKind::Distributed);
+  ASSERT_THROW(
+      budget.release(ThreadPoolKind::Distributed, threads + 1), c10::Error);
+}
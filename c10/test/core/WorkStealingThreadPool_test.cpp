@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+
+#include <c10/core/thread_pool.h>
+
+using namespace c10;
+
+TEST(WorkStealingThreadPoolTest, RunsAllTasks) {
+  std::atomic<int> counter{0};
+  {
+    WorkStealingThreadPool pool(4);
+    ASSERT_EQ(pool.size(), 4);
+    ASSERT_FALSE(pool.inThreadPool());
+    for (int i = 0; i < 1000; ++i) {
+      pool.run([&] { counter++; });
+    }
+    // The destructor drains all queued tasks before joining.
+  }
+  ASSERT_EQ(counter.load(), 1000);
+}
+
+TEST(WorkStealingThreadPoolTest, TasksSubmittedFromWorkers) {
+  std::atomic<int> counter{0};
+  std::atomic<bool> in_pool{true};
+  {
+    WorkStealingThreadPool pool(3);
+    for (int i = 0; i < 10; ++i) {
+      pool.run([&] {
+        in_pool = in_pool && pool.inThreadPool();
+        // Submitted to this worker's own deque; idle workers steal them.
+        for (int j = 0; j < 10; ++j) {
+          pool.run([&] { counter++; });
+        }
+      });
+    }
+    while (counter.load() < 100) {
+      std::this_thread::yield();
+    }
+  }
+  ASSERT_TRUE(in_pool.load());
+  ASSERT_EQ(counter.load(), 100);
+}
+
+TEST(WorkStealingThreadPoolTest, RunsHigherPrioritiesFirst) {
+  std::vector<int> order;
+  std::atomic<bool> release{false};
+  std::atomic<bool> started{false};
+  {
+    WorkStealingThreadPool pool(1);
+    // Keep the only worker busy while the tasks are queued.
+    pool.run([&] {
+      started = true;
+      while (!release.load()) {
+        std::this_thread::yield();
+      }
+    });
+    while (!started.load()) {
+      std::this_thread::yield();
+    }
+    pool.runWithPriority([&] { order.push_back(1); }, 1);
+    pool.runWithPriority([&] { order.push_back(3); }, 3);
+    pool.run([&] { order.push_back(0); });
+    pool.runWithPriority([&] { order.push_back(2); }, 2);
+    pool.runWithPriority([&] { order.push_back(4); }, 3);
+    release = true;
+  }
+  // Equal priorities run most recently submitted first, as with run().
+  ASSERT_EQ(order, std::vector<int>({4, 3, 2, 1, 0}));
+}
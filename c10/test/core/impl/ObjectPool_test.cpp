@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+
+#include <c10/core/StorageImpl.h>
+#include <c10/core/TensorImpl.h>
+#include <c10/core/impl/ObjectPool.h>
+
+#include <thread>
+
+using namespace c10;
+using namespace c10::impl;
+
+namespace {
+
+struct PoolsEnabled {
+  PoolsEnabled() {
+    FLAGS_caffe2_pool_tensor_objects = true;
+  }
+  ~PoolsEnabled() {
+    FLAGS_caffe2_pool_tensor_objects = false;
+  }
+};
+
+intrusive_ptr<TensorImpl> makeTensorImpl() {
+  return make_intrusive<TensorImpl>(
+      Storage(make_intrusive<StorageImpl>(
+          StorageImpl::use_byte_size_t(),
+          0,
+          DataPtr(nullptr, Device(DeviceType::CPU)),
+          nullptr,
+          false)),
+      DispatchKeySet(DispatchKey::CPU),
+      caffe2::TypeMeta::Make<float>());
+}
+
+// Same size as TensorImpl, so it's allocated from its pool.
+struct SameSizeTensorImpl : public TensorImpl {
+  using TensorImpl::TensorImpl;
+};
+
+} // namespace
+
+TEST(ObjectPoolTest, ReusesFreedObjects) {
+  PoolsEnabled enabled;
+  const auto tensors = pooledObjectCount(PooledObject::TensorImpl);
+  const auto storages = pooledObjectCount(PooledObject::StorageImpl);
+
+  auto impl = makeTensorImpl();
+  const void* implAddress = impl.get();
+  const void* storageAddress = impl->storage().unsafeGetStorageImpl();
+  impl.reset();
+  EXPECT_EQ(pooledObjectCount(PooledObject::TensorImpl), tensors + 1);
+  EXPECT_EQ(pooledObjectCount(PooledObject::StorageImpl), storages + 1);
+
+  impl = makeTensorImpl();
+  EXPECT_EQ(impl.get(), implAddress);
+  EXPECT_EQ(impl->storage().unsafeGetStorageImpl(), storageAddress);
+  EXPECT_EQ(pooledObjectCount(PooledObject::TensorImpl), tensors);
+  EXPECT_EQ(pooledObjectCount(PooledObject::StorageImpl), storages);
+}
+
+TEST(ObjectPoolTest, WeakReferencesKeepTheMemory) {
+  PoolsEnabled enabled;
+  auto impl = makeTensorImpl();
+  const auto tensors = pooledObjectCount(PooledObject::TensorImpl);
+  weak_intrusive_ptr<TensorImpl> weak(impl);
+  impl.reset();
+  EXPECT_EQ(pooledObjectCount(PooledObject::TensorImpl), tensors);
+  weak.reset();
+  EXPECT_EQ(pooledObjectCount(PooledObject::TensorImpl), tensors + 1);
+}
+
+TEST(ObjectPoolTest, SubclassesOfTheSameSizeArePooled) {
+  static_assert(
+      sizeof(SameSizeTensorImpl) == sizeof(TensorImpl),
+      "SameSizeTensorImpl must have the size of TensorImpl");
+  PoolsEnabled enabled;
+  auto impl = make_intrusive<SameSizeTensorImpl>(
+      DispatchKeySet(DispatchKey::CPU),
+      caffe2::TypeMeta::Make<float>(),
+      Device(DeviceType::CPU));
+  const auto tensors = pooledObjectCount(PooledObject::TensorImpl);
+  impl.reset();
+  EXPECT_EQ(pooledObjectCount(PooledObject::TensorImpl), tensors + 1);
+}
+
+TEST(ObjectPoolTest, ObjectsFreedByAnotherThreadGoToItsPool) {
+  PoolsEnabled enabled;
+  auto impl = makeTensorImpl();
+  const auto tensors = pooledObjectCount(PooledObject::TensorImpl);
+  std::thread([&impl] {
+    ASSERT_EQ(pooledObjectCount(PooledObject::TensorImpl), 0);
+    impl.reset();
+    EXPECT_EQ(pooledObjectCount(PooledObject::TensorImpl), 1);
+    // And it's released when the thread exits.
+  }).join();
+  EXPECT_EQ(pooledObjectCount(PooledObject::TensorImpl), tensors);
+}
+
+TEST(ObjectPoolTest, DisabledPoolsFreeObjects) {
+  const auto tensors = pooledObjectCount(PooledObject::TensorImpl);
+  makeTensorImpl().reset();
+  EXPECT_EQ(pooledObjectCount(PooledObject::TensorImpl), tensors);
+}
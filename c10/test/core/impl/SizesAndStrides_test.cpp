@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include <c10/core/impl/SizesAndStrides.h>
+
+using namespace c10;
+using namespace c10::impl;
+
+namespace {
+
+void checkData(
+    const SizesAndStrides& sz,
+    IntArrayRef sizes,
+    IntArrayRef strides) {
+  EXPECT_EQ(sizes.size(), strides.size())
+      << "bad test case: size() of sizes and strides don't match";
+  EXPECT_EQ(sz.size(), sizes.size());
+
+  int idx = 0;
+  for (auto x : sizes) {
+    EXPECT_EQ(sz.size_at_unchecked(idx), x) << "index: " << idx;
+    EXPECT_EQ(sz.size_at(idx), x) << "index: " << idx;
+    EXPECT_EQ(sz.sizes_data()[idx], x) << "index: " << idx;
+    EXPECT_EQ(*(sz.sizes_begin() + idx), x) << "index: " << idx;
+    idx++;
+  }
+  EXPECT_EQ(sz.sizes_arrayref(), sizes);
+
+  idx = 0;
+  for (auto x : strides) {
+    EXPECT_EQ(sz.stride_at_unchecked(idx), x) << "index: " << idx;
+    EXPECT_EQ(sz.stride_at(idx), x) << "index: " << idx;
+    EXPECT_EQ(sz.strides_data()[idx], x) << "index: " << idx;
+    EXPECT_EQ(*(sz.strides_begin() + idx), x) << "index: " << idx;
+    idx++;
+  }
+  EXPECT_EQ(sz.strides_arrayref(), strides);
+}
+
+// Fills the sizes with 1, 2, ... and the strides with 11, 12, ...
+void fill(SizesAndStrides& sz) {
+  for (size_t i = 0; i < sz.size(); ++i) {
+    sz.size_at(i) = i + 1;
+    sz.stride_at(i) = i + 11;
+  }
+}
+
+} // namespace
+
+TEST(SizesAndStridesTest, DefaultConstructor) {
+  SizesAndStrides sz;
+  checkData(sz, {0}, {1});
+}
+
+TEST(SizesAndStridesTest, SetSizes) {
+  SizesAndStrides sz;
+  sz.set_sizes({5, 6, 7, 8});
+  checkData(sz, {5, 6, 7, 8}, {1, 0, 0, 0});
+}
+
+TEST(SizesAndStridesTest, ResizeInline) {
+  SizesAndStrides sz;
+  sz.resize(2);
+  fill(sz);
+  checkData(sz, {1, 2}, {11, 12});
+
+  // Growing zeroes the new dimensions.
+  sz.resize(5);
+  checkData(sz, {1, 2, 0, 0, 0}, {11, 12, 0, 0, 0});
+
+  sz.resize(1);
+  checkData(sz, {1}, {11});
+
+  sz.resize(0);
+  checkData(sz, {}, {});
+}
+
+TEST(SizesAndStridesTest, ResizeOutOfLine) {
+  SizesAndStrides sz;
+  sz.resize(3);
+  fill(sz);
+
+  // Inline to out of line.
+  sz.resize(7);
+  checkData(sz, {1, 2, 3, 0, 0, 0, 0}, {11, 12, 13, 0, 0, 0, 0});
+
+  // Out of line, growing and shrinking.
+  fill(sz);
+  sz.resize(9);
+  checkData(
+      sz,
+      {1, 2, 3, 4, 5, 6, 7, 0, 0},
+      {11, 12, 13, 14, 15, 16, 17, 0, 0});
+  sz.resize(6);
+  checkData(sz, {1, 2, 3, 4, 5, 6}, {11, 12, 13, 14, 15, 16});
+
+  // Out of line to inline.
+  sz.resize(4);
+  checkData(sz, {1, 2, 3, 4}, {11, 12, 13, 14});
+}
+
+TEST(SizesAndStridesTest, CopyAndMove) {
+  for (size_t inlineSize : {3, 7}) {
+    for (size_t otherSize : {2, 8}) {
+      SizesAndStrides source;
+      source.resize(inlineSize);
+      fill(source);
+      const auto sizes = source.sizes_arrayref().vec();
+      const auto strides = source.strides_arrayref().vec();
+
+      SizesAndStrides copied(source);
+      checkData(copied, sizes, strides);
+      checkData(source, sizes, strides);
+
+      SizesAndStrides assigned;
+      assigned.resize(otherSize);
+      assigned = source;
+      checkData(assigned, sizes, strides);
+      checkData(source, sizes, strides);
+
+      SizesAndStrides moved(std::move(copied));
+      checkData(moved, sizes, strides);
+      EXPECT_EQ(copied.size(), 0);
+
+      SizesAndStrides moveAssigned;
+      moveAssigned.resize(otherSize);
+      moveAssigned = std::move(assigned);
+      checkData(moveAssigned, sizes, strides);
+      EXPECT_EQ(assigned.size(), 0);
+    }
+  }
+}
@@ -0,0 +1,157 @@
+#include <c10/util/Metrics.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <thread>
+#include <vector>
+
+using c10::metrics::Histogram;
+using c10::metrics::MetricsRegistry;
+using c10::metrics::MetricsSnapshot;
+using c10::metrics::MetricType;
+
+namespace {
+
+const c10::metrics::MetricSample* findSample(
+    const MetricsSnapshot& snapshot,
+    const std::string& name,
+    const std::string& labels = "") {
+  for (const auto& sample : snapshot.samples) {
+    if (sample.name == name && sample.labels == labels) {
+      return &sample;
+    }
+  }
+  return nullptr;
+}
+
+} // namespace
+
+TEST(MetricsTest, givenSameName_whenRegistering_thenReturnsSameMetric) {
+  auto& registry = MetricsRegistry::get();
+  auto& counter = registry.counter("test_same_total", "help");
+  EXPECT_EQ(&counter, &registry.counter("test_same_total", "help"));
+  EXPECT_NE(
+      &counter, &registry.counter("test_same_total", "help", "op=\"add\""));
+  EXPECT_ANY_THROW(registry.gauge("test_same_total", "help"));
+}
+
+TEST(MetricsTest, givenUpdatesFromManyThreads_whenReading_thenSumsThem) {
+  auto& counter = MetricsRegistry::get().counter("test_threads_total", "help");
+  auto& gauge = MetricsRegistry::get().gauge("test_threads_bytes", "help");
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&] {
+      for (int j = 0; j < 1000; ++j) {
+        counter.add();
+        gauge.add(3);
+      }
+      gauge.sub(1000);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // The threads exited, which keeps what they added.
+  EXPECT_EQ(4000, counter.value());
+  EXPECT_EQ(4 * 2000, gauge.value());
+
+  counter.add(5);
+  EXPECT_EQ(4005, counter.value());
+}
+
+TEST(MetricsTest, givenValues_whenRecordingHistogram_thenBucketsByPowerOfTwo) {
+  EXPECT_EQ(0, Histogram::bucket(-3));
+  EXPECT_EQ(0, Histogram::bucket(0));
+  EXPECT_EQ(1, Histogram::bucket(1));
+  EXPECT_EQ(2, Histogram::bucket(2));
+  EXPECT_EQ(2, Histogram::bucket(3));
+  EXPECT_EQ(11, Histogram::bucket(1024));
+  EXPECT_EQ(63, Histogram::bucket(std::numeric_limits<int64_t>::max()));
+  EXPECT_EQ(1024, Histogram::bucketLowerBound(11));
+
+  auto& histogram =
+      MetricsRegistry::get().histogram("test_latency_us", "Latency");
+  for (int64_t value : {1, 3, 3, 100}) {
+    histogram.record(value);
+  }
+  EXPECT_EQ(4, histogram.count());
+  EXPECT_EQ(107, histogram.sum());
+
+  const auto snapshot = MetricsRegistry::get().snapshot();
+  const auto* sample = findSample(snapshot, "test_latency_us");
+  ASSERT_NE(nullptr, sample);
+  EXPECT_EQ(MetricType::Histogram, sample->type);
+  EXPECT_EQ(107, sample->value);
+  EXPECT_EQ(1, sample->buckets[1]);
+  EXPECT_EQ(2, sample->buckets[2]);
+  EXPECT_EQ(1, sample->buckets[7]);
+}
+
+TEST(MetricsTest, givenSnapshot_whenFormatting_thenPrometheusText) {
+  auto& registry = MetricsRegistry::get();
+  registry.counter("test_calls_total", "Calls", "op=\"add\"").add(2);
+  registry.counter("test_calls_total", "Calls", "op=\"mul\"").add(1);
+  registry.histogram("test_size_bytes", "Sizes").record(3);
+
+  const auto text = c10::metrics::toPrometheusText(registry.snapshot());
+  // One HELP and TYPE for the samples of a name
+  EXPECT_NE(std::string::npos, text.find(
+      "# HELP test_calls_total Calls\n"
+      "# TYPE test_calls_total counter\n"
+      "test_calls_total{op=\"add\"} 2\n"
+      "test_calls_total{op=\"mul\"} 1\n"));
+  EXPECT_NE(std::string::npos, text.find(
+      "# TYPE test_size_bytes histogram\n"
+      "test_size_bytes_bucket{le=\"0\"} 0\n"
+      "test_size_bytes_bucket{le=\"1\"} 0\n"
+      "test_size_bytes_bucket{le=\"3\"} 1\n"
+      "test_size_bytes_bucket{le=\"+Inf\"} 1\n"
+      "test_size_bytes_sum 3\n"
+      "test_size_bytes_count 1\n"));
+}
+
+TEST(MetricsTest, givenSink_whenReporting_thenReceivesSnapshot) {
+  auto& registry = MetricsRegistry::get();
+  registry.counter("test_sink_total", "help").add(7);
+  int64_t reported = -1;
+  auto sink = std::make_shared<c10::metrics::CallbackSink>(
+      [&](const MetricsSnapshot& snapshot) {
+        reported = findSample(snapshot, "test_sink_total")->value;
+      });
+  registry.addSink(sink);
+  registry.report();
+  registry.removeSink(sink);
+  EXPECT_EQ(7, reported);
+
+  reported = -1;
+  registry.report();
+  EXPECT_EQ(-1, reported);
+}
+
+TEST(MetricsTest, givenReportingThread_whenWaiting_thenReportsPeriodically) {
+  auto& registry = MetricsRegistry::get();
+  std::atomic<int> reports{0};
+  auto sink = std::make_shared<c10::metrics::CallbackSink>(
+      [&](const MetricsSnapshot&) { reports++; });
+  registry.addSink(sink);
+  registry.startReporting(std::chrono::milliseconds(5));
+  for (int i = 0; i < 400 && reports < 2; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  registry.stopReporting();
+  registry.removeSink(sink);
+  EXPECT_GE(reports, 2);
+}
+
+TEST(MetricsTest, givenDisabledMetrics_whenUsingMacros_thenNoUpdate) {
+  auto& counter = MetricsRegistry::get().counter("test_macro_total", "Macro");
+  c10::metrics::setEnabled(false);
+  C10_METRICS_COUNTER_ADD("test_macro_total", "Macro", 1);
+  EXPECT_EQ(0, counter.value());
+  c10::metrics::setEnabled(true);
+  C10_METRICS_COUNTER_ADD("test_macro_total", "Macro", 1);
+  c10::metrics::setEnabled(false);
+  EXPECT_EQ(1, counter.value());
+}
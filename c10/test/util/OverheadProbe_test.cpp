@@ -0,0 +1,59 @@
+#include <c10/util/OverheadProbe.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+using c10::probe::Layer;
+using c10::probe::Scope;
+
+namespace {
+
+const c10::probe::LayerStats& stats(
+    const c10::probe::Stats& all,
+    Layer layer) {
+  return all[static_cast<size_t>(layer)];
+}
+
+} // namespace
+
+TEST(OverheadProbeTest, givenNestedScopes_whenTiming_thenLayersAreExclusive) {
+  c10::probe::resetThreadStats();
+  {
+    Scope outer(Layer::Dispatch);
+    {
+      Scope inner(Layer::Kernel);
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    {
+      Scope inner(Layer::Kernel);
+    }
+  }
+  const auto all = c10::probe::threadStats();
+  EXPECT_EQ(1, stats(all, Layer::Dispatch).calls);
+  EXPECT_EQ(2, stats(all, Layer::Kernel).calls);
+  EXPECT_EQ(0, stats(all, Layer::Lookup).calls);
+  EXPECT_GE(stats(all, Layer::Kernel).nanos, 20000000);
+  // The time of the kernels is not counted again in the dispatch.
+  EXPECT_LT(stats(all, Layer::Dispatch).nanos, stats(all, Layer::Kernel).nanos);
+}
+
+TEST(OverheadProbeTest, givenStats_whenResetting_thenTheyAreCleared) {
+  {
+    Scope scope(Layer::Lookup);
+  }
+  c10::probe::resetThreadStats();
+  const auto all = c10::probe::threadStats();
+  for (const auto& layer : all) {
+    EXPECT_EQ(0, layer.calls);
+    EXPECT_EQ(0, layer.nanos);
+  }
+}
+
+TEST(OverheadProbeTest, givenThreads_whenTiming_thenStatsArePerThread) {
+  c10::probe::resetThreadStats();
+  std::thread([] {
+    Scope scope(Layer::Autograd);
+  }).join();
+  EXPECT_EQ(0, stats(c10::probe::threadStats(), Layer::Autograd).calls);
+}
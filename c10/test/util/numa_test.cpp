@@ -0,0 +1,18 @@
+#include <gtest/gtest.h>
+
+#include <c10/util/numa.h>
+
+TEST(NUMATest, ParseCPUList) {
+  EXPECT_EQ(c10::ParseCPUList("0-3,8,10-11\n"),
+            (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+  EXPECT_EQ(c10::ParseCPUList("5"), std::vector<int>{5});
+  EXPECT_TRUE(c10::ParseCPUList("").empty());
+  EXPECT_THROW(c10::ParseCPUList("3-1"), c10::Error);
+  EXPECT_THROW(c10::ParseCPUList("zero"), c10::Error);
+}
+
+TEST(NUMATest, GetNUMANodeCPUs) {
+  EXPECT_TRUE(c10::GetNUMANodeCPUs(-1).empty());
+  // nodes that do not exist have no CPUs
+  EXPECT_TRUE(c10::GetNUMANodeCPUs(1 << 20).empty());
+}
@@ -0,0 +1,472 @@
+#include <c10/util/Metrics.h>
+
+#include <c10/util/Exception.h>
+#include <c10/util/Logging.h>
+#include <c10/util/llvmMathExtras.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace c10 {
+namespace metrics {
+
+namespace detail {
+
+namespace {
+
+bool enabledFromEnv() {
+  const char* value = std::getenv("PYTORCH_METRICS");
+  return value != nullptr && std::strcmp(value, "1") == 0;
+}
+
+} // namespace
+
+std::atomic<bool> g_enabled{enabledFromEnv()};
+
+SlotChunk::SlotChunk() {
+  for (auto& slot : slots) {
+    slot.store(0, std::memory_order_relaxed);
+  }
+}
+
+ThreadSlots::ThreadSlots() {
+  for (auto& chunk : chunks_) {
+    chunk.store(nullptr, std::memory_order_relaxed);
+  }
+  MetricsRegistry::get().registerThread(this);
+}
+
+ThreadSlots::~ThreadSlots() {
+  // Once unregistered, the snapshots no longer read the chunks.
+  MetricsRegistry::get().unregisterThread(this);
+  for (auto& chunk : chunks_) {
+    delete chunk.load(std::memory_order_relaxed);
+  }
+}
+
+int64_t ThreadSlots::read(size_t slot) const {
+  const SlotChunk* chunk =
+      chunks_[slot / kSlotsPerChunk].load(std::memory_order_acquire);
+  if (!chunk) {
+    return 0;
+  }
+  return chunk->slots[slot % kSlotsPerChunk].load(std::memory_order_relaxed);
+}
+
+SlotChunk* ThreadSlots::allocateChunk(size_t index) {
+  auto* chunk = new SlotChunk();
+  chunks_[index].store(chunk, std::memory_order_release);
+  return chunk;
+}
+
+ThreadSlots& threadSlots() {
+  static thread_local ThreadSlots slots;
+  return slots;
+}
+
+} // namespace detail
+
+void setEnabled(bool enabled) {
+  detail::g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+Metric::Metric(
+    MetricType type,
+    std::string name,
+    std::string labels,
+    std::string help,
+    size_t slot)
+    : type_(type),
+      name_(std::move(name)),
+      labels_(std::move(labels)),
+      help_(std::move(help)),
+      slot_(slot) {}
+
+int64_t Counter::value() const {
+  return MetricsRegistry::get().sum(slot_);
+}
+
+int64_t Gauge::value() const {
+  return MetricsRegistry::get().sum(slot_);
+}
+
+size_t Histogram::bucket(int64_t value) {
+  if (value <= 0) {
+    return 0;
+  }
+  return 64 - llvm::countLeadingZeros(static_cast<uint64_t>(value));
+}
+
+int64_t Histogram::bucketLowerBound(size_t bucket) {
+  return bucket == 0 ? 0 : int64_t(1) << (bucket - 1);
+}
+
+int64_t Histogram::count() const {
+  int64_t count = 0;
+  for (size_t i = 0; i < kNumHistogramBuckets; ++i) {
+    count += MetricsRegistry::get().sum(slot_ + i);
+  }
+  return count;
+}
+
+int64_t Histogram::sum() const {
+  return MetricsRegistry::get().sum(slot_ + kNumHistogramBuckets);
+}
+
+namespace {
+
+const char* typeName(MetricType type) {
+  switch (type) {
+    case MetricType::Counter:
+      return "counter";
+    case MetricType::Gauge:
+      return "gauge";
+    case MetricType::Histogram:
+      return "histogram";
+    default:
+      return "untyped";
+  }
+}
+
+std::string escapeHelp(const std::string& help) {
+  std::string escaped;
+  for (char c : help) {
+    if (c == '\\') {
+      escaped += "\\\\";
+    } else if (c == '\n') {
+      escaped += "\\n";
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+// `name{labels,extra}`, without the braces if there is no label.
+std::string series(
+    const std::string& name,
+    const std::string& labels,
+    const std::string& extra = "") {
+  std::string all = labels;
+  if (!extra.empty()) {
+    all += (all.empty() ? "" : ",") + extra;
+  }
+  return all.empty() ? name : name + "{" + all + "}";
+}
+
+// Reports the snapshots of a registry every interval until destroyed.
+class Reporter {
+ public:
+  Reporter(MetricsRegistry& registry, std::chrono::milliseconds interval)
+      : thread_([this, &registry, interval] { run(registry, interval); }) {}
+
+  ~Reporter() {
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+  }
+
+ private:
+  void run(MetricsRegistry& registry, std::chrono::milliseconds interval) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!cv_.wait_for(lock, interval, [this] { return stop_; })) {
+      lock.unlock();
+      try {
+        registry.report();
+      } catch (const std::exception& e) {
+        LOG(WARNING) << "Failed to report the metrics: " << e.what();
+      }
+      lock.lock();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stop_ = false;
+  // last, so that it starts once the above is initialized
+  std::thread thread_;
+};
+
+// Destroyed at exit, which stops the reporting before the sinks go away.
+struct ReporterHolder {
+  std::mutex mutex;
+  std::unique_ptr<Reporter> reporter;
+};
+
+ReporterHolder& reporterHolder() {
+  static ReporterHolder holder;
+  return holder;
+}
+
+} // namespace
+
+std::string toPrometheusText(const MetricsSnapshot& snapshot) {
+  // The samples of a name, which share their HELP and TYPE lines.
+  std::vector<std::string> names;
+  std::unordered_map<std::string, std::vector<const MetricSample*>> by_name;
+  for (const auto& sample : snapshot.samples) {
+    auto& samples = by_name[sample.name];
+    if (samples.empty()) {
+      names.push_back(sample.name);
+    }
+    samples.push_back(&sample);
+  }
+
+  std::ostringstream out;
+  for (const auto& name : names) {
+    const auto& samples = by_name[name];
+    out << "# HELP " << name << " " << escapeHelp(samples[0]->help) << "\n";
+    out << "# TYPE " << name << " " << typeName(samples[0]->type) << "\n";
+    for (const MetricSample* sample : samples) {
+      if (sample->type != MetricType::Histogram) {
+        out << series(name, sample->labels) << " " << sample->value << "\n";
+        continue;
+      }
+      size_t last = 0;
+      for (size_t i = 0; i < sample->buckets.size(); ++i) {
+        if (sample->buckets[i] != 0) {
+          last = i;
+        }
+      }
+      int64_t count = 0;
+      for (size_t i = 0; i <= last && i < sample->buckets.size(); ++i) {
+        count += sample->buckets[i];
+        // the largest value of the bucket
+        const int64_t upper_bound =
+            i + 1 < kNumHistogramBuckets ? Histogram::bucketLowerBound(i + 1) - 1
+                                         : std::numeric_limits<int64_t>::max();
+        out << series(
+                   name + "_bucket",
+                   sample->labels,
+                   "le=\"" + std::to_string(upper_bound) + "\"")
+            << " " << count << "\n";
+      }
+      out << series(name + "_bucket", sample->labels, "le=\"+Inf\"") << " "
+          << count << "\n";
+      out << series(name + "_sum", sample->labels) << " " << sample->value
+          << "\n";
+      out << series(name + "_count", sample->labels) << " " << count << "\n";
+    }
+  }
+  return out.str();
+}
+
+void PrometheusTextFileSink::report(const MetricsSnapshot& snapshot) {
+  // Written next to the file and renamed over it, so that the readers of the
+  // file never see a partial snapshot.
+  const std::string tmp_path = path_ + ".tmp";
+  {
+    std::ofstream out(tmp_path, std::ios::trunc);
+    TORCH_CHECK(out, "Can't open ", tmp_path, " to write the metrics to");
+    out << toPrometheusText(snapshot);
+    TORCH_CHECK(out, "Failed to write the metrics to ", tmp_path);
+  }
+  TORCH_CHECK(
+      std::rename(tmp_path.c_str(), path_.c_str()) == 0,
+      "Can't rename ",
+      tmp_path,
+      " to ",
+      path_);
+}
+
+struct MetricsRegistry::State {
+  mutable std::mutex mutex;
+  std::vector<std::unique_ptr<Metric>> metrics;
+  // By name and labels
+  std::unordered_map<std::string, Metric*> metrics_by_key;
+  size_t num_slots = 0;
+  std::unordered_set<detail::ThreadSlots*> threads;
+  // The slots of the threads that exited, summed
+  std::vector<int64_t> exited_sums;
+
+  std::mutex sinks_mutex;
+  std::vector<std::shared_ptr<MetricsSink>> sinks;
+
+  int64_t sumLocked(size_t slot) const {
+    int64_t sum = slot < exited_sums.size() ? exited_sums[slot] : 0;
+    for (const auto* thread : threads) {
+      sum += thread->read(slot);
+    }
+    return sum;
+  }
+};
+
+MetricsRegistry::MetricsRegistry() : state_(new State()) {}
+
+MetricsRegistry& MetricsRegistry::get() {
+  // Leaked, as the threads that exit after the static destructors ran still
+  // unregister their slots from it.
+  static MetricsRegistry* registry = new MetricsRegistry();
+  return *registry;
+}
+
+Metric& MetricsRegistry::getOrRegister(
+    MetricType type,
+    const std::string& name,
+    const std::string& help,
+    const std::string& labels) {
+  std::lock_guard<std::mutex> guard(state_->mutex);
+  const std::string key = labels.empty() ? name : name + "{" + labels + "}";
+  auto it = state_->metrics_by_key.find(key);
+  if (it != state_->metrics_by_key.end()) {
+    TORCH_CHECK(
+        it->second->type() == type,
+        "Metric ",
+        key,
+        " was registered as a ",
+        typeName(it->second->type()),
+        ", not a ",
+        typeName(type));
+    return *it->second;
+  }
+
+  const size_t num_slots =
+      type == MetricType::Histogram ? Histogram::kNumSlots : 1;
+  TORCH_CHECK(
+      state_->num_slots + num_slots <= detail::kMaxSlots,
+      "Too many metrics registered, can't register ",
+      key);
+  const size_t slot = state_->num_slots;
+  state_->num_slots += num_slots;
+  std::unique_ptr<Metric> metric;
+  switch (type) {
+    case MetricType::Counter:
+      metric.reset(new Counter(type, name, labels, help, slot));
+      break;
+    case MetricType::Gauge:
+      metric.reset(new Gauge(type, name, labels, help, slot));
+      break;
+    case MetricType::Histogram:
+      metric.reset(new Histogram(type, name, labels, help, slot));
+      break;
+  }
+  Metric& result = *metric;
+  state_->metrics_by_key.emplace(key, metric.get());
+  state_->metrics.push_back(std::move(metric));
+  return result;
+}
+
+Counter& MetricsRegistry::counter(
+    const std::string& name,
+    const std::string& help,
+    const std::string& labels) {
+  return static_cast<Counter&>(
+      getOrRegister(MetricType::Counter, name, help, labels));
+}
+
+Gauge& MetricsRegistry::gauge(
+    const std::string& name,
+    const std::string& help,
+    const std::string& labels) {
+  return static_cast<Gauge&>(
+      getOrRegister(MetricType::Gauge, name, help, labels));
+}
+
+Histogram& MetricsRegistry::histogram(
+    const std::string& name,
+    const std::string& help,
+    const std::string& labels) {
+  return static_cast<Histogram&>(
+      getOrRegister(MetricType::Histogram, name, help, labels));
+}
+
+int64_t MetricsRegistry::sum(size_t slot) const {
+  std::lock_guard<std::mutex> guard(state_->mutex);
+  return state_->sumLocked(slot);
+}
+
+MetricsSnapshot MetricsRegistry::snapshot() {
+  MetricsSnapshot snapshot;
+  snapshot.time = std::chrono::system_clock::now();
+  std::lock_guard<std::mutex> guard(state_->mutex);
+  snapshot.samples.reserve(state_->metrics.size());
+  for (const auto& metric : state_->metrics) {
+    MetricSample sample;
+    sample.type = metric->type();
+    sample.name = metric->name();
+    sample.labels = metric->labels();
+    sample.help = metric->help();
+    if (sample.type == MetricType::Histogram) {
+      sample.buckets.resize(kNumHistogramBuckets);
+      for (size_t i = 0; i < kNumHistogramBuckets; ++i) {
+        sample.buckets[i] = state_->sumLocked(metric->slot_ + i);
+      }
+      sample.value = state_->sumLocked(metric->slot_ + kNumHistogramBuckets);
+    } else {
+      sample.value = state_->sumLocked(metric->slot_);
+    }
+    snapshot.samples.push_back(std::move(sample));
+  }
+  return snapshot;
+}
+
+void MetricsRegistry::addSink(std::shared_ptr<MetricsSink> sink) {
+  std::lock_guard<std::mutex> guard(state_->sinks_mutex);
+  state_->sinks.push_back(std::move(sink));
+}
+
+void MetricsRegistry::removeSink(const std::shared_ptr<MetricsSink>& sink) {
+  std::lock_guard<std::mutex> guard(state_->sinks_mutex);
+  auto& sinks = state_->sinks;
+  sinks.erase(std::remove(sinks.begin(), sinks.end(), sink), sinks.end());
+}
+
+void MetricsRegistry::report() {
+  std::vector<std::shared_ptr<MetricsSink>> sinks;
+  {
+    std::lock_guard<std::mutex> guard(state_->sinks_mutex);
+    sinks = state_->sinks;
+  }
+  if (sinks.empty()) {
+    return;
+  }
+  const auto current = snapshot();
+  for (const auto& sink : sinks) {
+    sink->report(current);
+  }
+}
+
+void MetricsRegistry::startReporting(std::chrono::milliseconds interval) {
+  TORCH_CHECK(interval.count() > 0, "The reporting interval must be positive");
+  auto& holder = reporterHolder();
+  std::lock_guard<std::mutex> guard(holder.mutex);
+  holder.reporter.reset();
+  holder.reporter.reset(new Reporter(*this, interval));
+}
+
+void MetricsRegistry::stopReporting() {
+  auto& holder = reporterHolder();
+  std::lock_guard<std::mutex> guard(holder.mutex);
+  holder.reporter.reset();
+}
+
+void MetricsRegistry::registerThread(detail::ThreadSlots* slots) {
+  std::lock_guard<std::mutex> guard(state_->mutex);
+  state_->threads.insert(slots);
+}
+
+void MetricsRegistry::unregisterThread(detail::ThreadSlots* slots) {
+  std::lock_guard<std::mutex> guard(state_->mutex);
+  auto& exited_sums = state_->exited_sums;
+  exited_sums.resize(state_->num_slots, 0);
+  for (size_t slot = 0; slot < state_->num_slots; ++slot) {
+    exited_sums[slot] += slots->read(slot);
+  }
+  state_->threads.erase(slots);
+}
+
+} // namespace metrics
+} // namespace c10
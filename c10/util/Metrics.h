@@ -0,0 +1,326 @@
+#pragma once
+
+#include <c10/macros/Macros.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Process-wide metrics: counters, gauges and histograms that the allocators,
+// the dispatcher, the JIT and the data loaders update, which the
+// MetricsRegistry aggregates into snapshots for the sinks it reports to.
+//
+// A metric is registered once, by name, and then updated without locking: each
+// thread adds to slots of its own, which only it writes, and a snapshot sums
+// the slots of every thread (and of the threads that exited). Updates are only
+// made while the metrics are enabled, see setEnabled, so that the instrumented
+// code costs a relaxed load otherwise. Use the C10_METRICS_* macros at the
+// instrumented sites, which register the metric on their first update.
+
+namespace c10 {
+namespace metrics {
+
+enum class C10_API_ENUM MetricType : uint8_t {
+  // A total that only increases, e.g. the number of calls.
+  Counter,
+  // A value that goes up and down, e.g. the bytes in use.
+  Gauge,
+  // The distribution of measured values, e.g. of latencies.
+  Histogram,
+};
+
+// The bucket of a histogram a value goes into: 0 for the values <= 0, then i
+// for the values in [2^(i-1), 2^i).
+constexpr size_t kNumHistogramBuckets = 64;
+
+namespace detail {
+
+constexpr size_t kSlotsPerChunk = 256;
+constexpr size_t kMaxChunks = 64;
+constexpr size_t kMaxSlots = kSlotsPerChunk * kMaxChunks;
+
+struct SlotChunk {
+  SlotChunk();
+  std::array<std::atomic<int64_t>, kSlotsPerChunk> slots;
+};
+
+// The slots a thread adds to, allocated a chunk at a time on the first update
+// of one of its slots.
+class C10_API ThreadSlots {
+ public:
+  ThreadSlots();
+  ~ThreadSlots();
+
+  void add(size_t slot, int64_t value) {
+    SlotChunk* chunk =
+        chunks_[slot / kSlotsPerChunk].load(std::memory_order_acquire);
+    if (C10_UNLIKELY(!chunk)) {
+      chunk = allocateChunk(slot / kSlotsPerChunk);
+    }
+    // This thread is the only writer of its slots, the snapshots only read
+    // them: a load and a store are enough.
+    auto& s = chunk->slots[slot % kSlotsPerChunk];
+    s.store(s.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+  }
+
+  int64_t read(size_t slot) const;
+
+  ThreadSlots(const ThreadSlots&) = delete;
+  ThreadSlots& operator=(const ThreadSlots&) = delete;
+
+ private:
+  SlotChunk* allocateChunk(size_t index);
+
+  std::array<std::atomic<SlotChunk*>, kMaxChunks> chunks_;
+};
+
+C10_API ThreadSlots& threadSlots();
+
+C10_API extern std::atomic<bool> g_enabled;
+
+} // namespace detail
+
+// Whether the metrics are updated. Off by default, on if the PYTORCH_METRICS
+// environment variable is set to 1.
+inline bool enabled() {
+  return detail::g_enabled.load(std::memory_order_relaxed);
+}
+
+C10_API void setEnabled(bool enabled);
+
+class C10_API Metric {
+ public:
+  Metric(
+      MetricType type,
+      std::string name,
+      std::string labels,
+      std::string help,
+      size_t slot);
+  virtual ~Metric() = default;
+
+  MetricType type() const {
+    return type_;
+  }
+
+  const std::string& name() const {
+    return name_;
+  }
+
+  const std::string& labels() const {
+    return labels_;
+  }
+
+  const std::string& help() const {
+    return help_;
+  }
+
+ protected:
+  friend class MetricsRegistry;
+
+  const MetricType type_;
+  const std::string name_;
+  const std::string labels_;
+  const std::string help_;
+  // The first of the slots of the metric
+  const size_t slot_;
+};
+
+class C10_API Counter final : public Metric {
+ public:
+  using Metric::Metric;
+
+  void add(int64_t value = 1) {
+    detail::threadSlots().add(slot_, value);
+  }
+
+  int64_t value() const;
+};
+
+class C10_API Gauge final : public Metric {
+ public:
+  using Metric::Metric;
+
+  void add(int64_t value) {
+    detail::threadSlots().add(slot_, value);
+  }
+
+  void sub(int64_t value) {
+    detail::threadSlots().add(slot_, -value);
+  }
+
+  int64_t value() const;
+};
+
+class C10_API Histogram final : public Metric {
+ public:
+  using Metric::Metric;
+
+  // The slots of a histogram: its buckets, then the sum of its values.
+  static constexpr size_t kNumSlots = kNumHistogramBuckets + 1;
+
+  static size_t bucket(int64_t value);
+
+  // The smallest value of a bucket but the first, whose values are <= 0.
+  static int64_t bucketLowerBound(size_t bucket);
+
+  void record(int64_t value) {
+    auto& slots = detail::threadSlots();
+    slots.add(slot_ + bucket(value), 1);
+    slots.add(slot_ + kNumHistogramBuckets, value);
+  }
+
+  int64_t count() const;
+  int64_t sum() const;
+};
+
+// The value of a metric in a snapshot.
+struct C10_API MetricSample {
+  MetricType type;
+  std::string name;
+  std::string labels;
+  std::string help;
+  // The value of a counter or a gauge, the sum of the values of a histogram.
+  int64_t value = 0;
+  // The number of values in each bucket of a histogram, empty otherwise.
+  std::vector<int64_t> buckets;
+};
+
+struct C10_API MetricsSnapshot {
+  std::chrono::system_clock::time_point time;
+  // In the order the metrics were registered in.
+  std::vector<MetricSample> samples;
+};
+
+// Where the registry reports its snapshots to. report() is called from the
+// thread that calls MetricsRegistry::report, the reporting thread if
+// startReporting was called.
+class C10_API MetricsSink {
+ public:
+  virtual ~MetricsSink() = default;
+  virtual void report(const MetricsSnapshot& snapshot) = 0;
+};
+
+class C10_API CallbackSink final : public MetricsSink {
+ public:
+  explicit CallbackSink(std::function<void(const MetricsSnapshot&)> callback)
+      : callback_(std::move(callback)) {}
+
+  void report(const MetricsSnapshot& snapshot) override {
+    callback_(snapshot);
+  }
+
+ private:
+  std::function<void(const MetricsSnapshot&)> callback_;
+};
+
+// Writes every snapshot to a file in the Prometheus text format, e.g. for the
+// textfile collector of the node exporter. The file is replaced atomically.
+class C10_API PrometheusTextFileSink final : public MetricsSink {
+ public:
+  explicit PrometheusTextFileSink(std::string path) : path_(std::move(path)) {}
+
+  void report(const MetricsSnapshot& snapshot) override;
+
+ private:
+  std::string path_;
+};
+
+// Formats a snapshot in the Prometheus text exposition format. The buckets of
+// the histograms go up to the highest non-empty one.
+C10_API std::string toPrometheusText(const MetricsSnapshot& snapshot);
+
+class C10_API MetricsRegistry {
+ public:
+  static MetricsRegistry& get();
+
+  // Return the metric registered with this name and labels, registering it
+  // if there isn't one; throws if it was registered with another type. The
+  // labels are in the Prometheus format, e.g. `op="aten::add",device="cpu"`.
+  // The metrics live as long as the process.
+  Counter& counter(
+      const std::string& name,
+      const std::string& help,
+      const std::string& labels = "");
+  Gauge& gauge(
+      const std::string& name,
+      const std::string& help,
+      const std::string& labels = "");
+  Histogram& histogram(
+      const std::string& name,
+      const std::string& help,
+      const std::string& labels = "");
+
+  MetricsSnapshot snapshot();
+
+  void addSink(std::shared_ptr<MetricsSink> sink);
+  void removeSink(const std::shared_ptr<MetricsSink>& sink);
+
+  // Reports a snapshot to the sinks.
+  void report();
+
+  // Reports a snapshot to the sinks every interval from a background thread,
+  // until stopReporting, replacing any previous reporting thread.
+  void startReporting(std::chrono::milliseconds interval);
+  void stopReporting();
+
+ private:
+  friend class Counter;
+  friend class Gauge;
+  friend class Histogram;
+  friend class detail::ThreadSlots;
+
+  struct State;
+
+  MetricsRegistry();
+
+  Metric& getOrRegister(
+      MetricType type,
+      const std::string& name,
+      const std::string& help,
+      const std::string& labels);
+
+  // The sum of a slot over the threads, the exited ones included.
+  int64_t sum(size_t slot) const;
+
+  void registerThread(detail::ThreadSlots* slots);
+  void unregisterThread(detail::ThreadSlots* slots);
+
+  std::unique_ptr<State> state_;
+};
+
+} // namespace metrics
+} // namespace c10
+
+// Update a metric of the registry when the metrics are enabled, registering it
+// on the first update. The name and the help must be string literals.
+#define C10_METRICS_COUNTER_ADD(name, help, value)                     \
+  do {                                                                 \
+    if (C10_UNLIKELY(::c10::metrics::enabled())) {                     \
+      static auto& c10_metric_ =                                       \
+          ::c10::metrics::MetricsRegistry::get().counter(name, help);  \
+      c10_metric_.add(value);                                          \
+    }                                                                  \
+  } while (0)
+
+#define C10_METRICS_GAUGE_ADD(name, help, value)                       \
+  do {                                                                 \
+    if (C10_UNLIKELY(::c10::metrics::enabled())) {                     \
+      static auto& c10_metric_ =                                       \
+          ::c10::metrics::MetricsRegistry::get().gauge(name, help);    \
+      c10_metric_.add(value);                                          \
+    }                                                                  \
+  } while (0)
+
+#define C10_METRICS_HISTOGRAM_RECORD(name, help, value)                \
+  do {                                                                 \
+    if (C10_UNLIKELY(::c10::metrics::enabled())) {                     \
+      static auto& c10_metric_ =                                       \
+          ::c10::metrics::MetricsRegistry::get().histogram(name, help); \
+      c10_metric_.record(value);                                       \
+    }                                                                  \
+  } while (0)
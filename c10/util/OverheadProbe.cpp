@@ -0,0 +1,45 @@
+#include <c10/util/OverheadProbe.h>
+
+namespace c10 {
+namespace probe {
+
+const char* layerName(Layer layer) {
+  switch (layer) {
+    case Layer::Dispatch:
+      return "Dispatch";
+    case Layer::KeyExtraction:
+      return "KeyExtraction";
+    case Layer::Lookup:
+      return "Lookup";
+    case Layer::RecordFunction:
+      return "RecordFunction";
+    case Layer::Boxing:
+      return "Boxing";
+    case Layer::Autograd:
+      return "Autograd";
+    case Layer::Allocation:
+      return "Allocation";
+    case Layer::TensorImpl:
+      return "TensorImpl";
+    case Layer::Kernel:
+      return "Kernel";
+    default:
+      return "Unknown";
+  }
+}
+
+ThreadProbes& threadProbes() {
+  static thread_local ThreadProbes probes;
+  return probes;
+}
+
+Stats threadStats() {
+  return threadProbes().stats;
+}
+
+void resetThreadStats() {
+  threadProbes() = ThreadProbes();
+}
+
+} // namespace probe
+} // namespace c10
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <c10/macros/Macros.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace c10 {
+namespace probe {
+
+// The layers that a call of an operator goes through, whose time the overhead
+// probes measure.
+enum class C10_API_ENUM Layer : uint8_t {
+  // Dispatcher::call and redispatch, besides the layers below.
+  Dispatch = 0,
+  // Computing the dispatch key from the arguments.
+  KeyExtraction,
+  // OperatorEntry::lookup of the kernel of the dispatch key.
+  Lookup,
+  // Checking for (and running) the RecordFunction callbacks.
+  RecordFunction,
+  // Calling a kernel that only has a boxed version, boxing included.
+  Boxing,
+  // The VariableType wrappers, besides the kernels they redispatch to.
+  Autograd,
+  // Allocating the storage of a new tensor.
+  Allocation,
+  // Constructing a TensorImpl.
+  TensorImpl,
+  // The kernels, besides the layers above that they go through again.
+  Kernel,
+  NumLayers,
+};
+
+constexpr size_t kNumLayers = static_cast<size_t>(Layer::NumLayers);
+
+C10_API const char* layerName(Layer layer);
+
+struct LayerStats {
+  uint64_t calls = 0;
+  // The time spent in the layer itself, i.e. not in the probes nested in it.
+  uint64_t nanos = 0;
+};
+
+using Stats = std::array<LayerStats, kNumLayers>;
+
+// The probes of a thread, which keep the time of every layer exclusive of the
+// probes that are nested in it.
+struct ThreadProbes {
+  Stats stats;
+  // The time spent in the probes nested in the innermost open probe.
+  uint64_t nested_nanos = 0;
+};
+
+C10_API ThreadProbes& threadProbes();
+
+// The stats of the current thread since the last reset.
+C10_API Stats threadStats();
+C10_API void resetThreadStats();
+
+// Times the scope it lives in as part of `layer`. It is only compiled in with
+// the overhead probes, see C10_OVERHEAD_PROBE, as it costs two reads of the
+// clock.
+class Scope {
+ public:
+  explicit Scope(Layer layer)
+      : probes_(threadProbes()),
+        layer_(layer),
+        outer_nested_nanos_(probes_.nested_nanos),
+        start_(std::chrono::steady_clock::now()) {
+    probes_.nested_nanos = 0;
+  }
+
+  ~Scope() {
+    const uint64_t elapsed =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_)
+            .count();
+    auto& stats = probes_.stats[static_cast<size_t>(layer_)];
+    stats.calls++;
+    stats.nanos += elapsed > probes_.nested_nanos
+        ? elapsed - probes_.nested_nanos
+        : 0;
+    probes_.nested_nanos = outer_nested_nanos_ + elapsed;
+  }
+
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+ private:
+  ThreadProbes& probes_;
+  Layer layer_;
+  uint64_t outer_nested_nanos_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace probe
+} // namespace c10
+
+// Times the rest of the enclosing scope as part of the given layer of the
+// calls of operators, when built with USE_OVERHEAD_PROBES (see
+// binaries/dispatch_overhead_benchmark.cc). It compiles to nothing otherwise.
+#ifdef C10_USE_OVERHEAD_PROBES
+#define C10_OVERHEAD_PROBE(layer)                            \
+  ::c10::probe::Scope C10_ANONYMOUS_VARIABLE(overhead_probe_)( \
+      ::c10::probe::Layer::layer)
+#else
+#define C10_OVERHEAD_PROBE(layer)
+#endif
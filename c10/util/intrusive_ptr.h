@@ -21,6 +21,11 @@ namespace raw {
  * (i.e. in a member of the object itself).
  * Your class T needs to inherit from intrusive_ptr_target to allow it to be
  * used in an intrusive_ptr<T>.
+ *
+ * Targets are created by make_intrusive with `new T` and destroyed with
+ * `delete`, so a class can change how its objects are allocated with its own
+ * operator new and operator delete (e.g., TensorImpl and StorageImpl use the
+ * object pools of c10/core/impl/ObjectPool.h).
  */
 
 // Note [Stack allocated intrusive_ptr_target safety]
@@ -1,5 +1,12 @@
 #include <c10/util/numa.h>
 
+#include <fstream>
+#include <sstream>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
 C10_DEFINE_bool(caffe2_cpu_numa_enabled, false, "Use NUMA whenever possible.");
 
 #if defined(__linux__) && defined(C10_USE_NUMA) && !defined(C10_MOBILE)
@@ -129,4 +136,65 @@ int GetCurrentNUMANode() {
 
 #endif // C10_NUMA_ENABLED
 
+std::vector<int> GetNUMANodeCPUs(int numa_node_id) {
+  if (numa_node_id < 0) {
+    return {};
+  }
+  std::ifstream file(
+      "/sys/devices/system/node/node" + std::to_string(numa_node_id) +
+      "/cpulist");
+  std::string cpu_list;
+  if (!file || !std::getline(file, cpu_list)) {
+    return {};
+  }
+  return ParseCPUList(cpu_list);
+}
+
+std::vector<int> ParseCPUList(const std::string& cpu_list) {
+  std::vector<int> cpus;
+  std::istringstream stream(cpu_list);
+  std::string range;
+  while (std::getline(stream, range, ',')) {
+    if (range.find_first_not_of(" \t\n") == std::string::npos) {
+      continue;
+    }
+    try {
+      size_t pos = 0;
+      int first = std::stoi(range, &pos);
+      int last = first;
+      if (pos < range.size() && range[pos] == '-') {
+        last = std::stoi(range.substr(pos + 1));
+      }
+      TORCH_CHECK(first >= 0 && first <= last);
+      for (int cpu = first; cpu <= last; ++cpu) {
+        cpus.push_back(cpu);
+      }
+    } catch (const std::exception&) {
+      TORCH_CHECK(false, "Invalid CPU list: \"", cpu_list, "\"");
+    }
+  }
+  return cpus;
+}
+
+void SetThreadAffinity(const std::vector<int>& cpus) {
+  if (cpus.empty()) {
+    return;
+  }
+#ifdef __linux__
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  for (int cpu : cpus) {
+    TORCH_CHECK(
+        cpu >= 0 && cpu < CPU_SETSIZE, "CPU id ", cpu, " is out of range");
+    CPU_SET(cpu, &mask);
+  }
+  TORCH_CHECK(
+      sched_setaffinity(0, sizeof(mask), &mask) == 0,
+      "Unable to set thread affinity, errno:",
+      errno);
+#else
+  TORCH_WARN_ONCE("Setting thread affinity is only supported on Linux");
+#endif
+}
+
 } // namespace c10
@@ -3,6 +3,9 @@
 #include <c10/util/Logging.h>
 #include <c10/util/Optional.h>
 
+#include <string>
+#include <vector>
+
 C10_DECLARE_bool(caffe2_cpu_numa_enabled);
 
 namespace c10 {
@@ -37,4 +40,21 @@ C10_API void NUMAMove(void* ptr, size_t size, int numa_node_id);
  */
 C10_API int GetCurrentNUMANode();
 
+/**
+ * Get the CPUs belonging to a given NUMA node, or an empty list if that
+ * cannot be determined. Unlike the functions above this does not require
+ * NUMA support to be enabled.
+ */
+C10_API std::vector<int> GetNUMANodeCPUs(int numa_node_id);
+
+/**
+ * Parse a CPU list in the format of taskset and /sys, e.g. "0-3,8,10-11"
+ */
+C10_API std::vector<int> ParseCPUList(const std::string& cpu_list);
+
+/**
+ * Pin the calling thread to the given CPUs (Linux only)
+ */
+C10_API void SetThreadAffinity(const std::vector<int>& cpus);
+
 } // namespace c10
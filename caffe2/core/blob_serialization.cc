@@ -1,5 +1,8 @@
 #include "caffe2/core/blob_serialization.h"
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
 #include <mutex>
 #include <sstream>
 
@@ -26,6 +29,13 @@ C10_DEFINE_bool(
     false,
     "Serialize BOOL, UINT8, INT8, UINT16, INT16, INT64, FLOAT16 tensors using byte_data field instead of int32");
 
+C10_DEFINE_bool(
+    caffe2_serialize_tensors_as_bytes,
+    false,
+    "Serialize the tensors of every fixed-width type, FLOAT, DOUBLE, INT32 "
+    "and INT64 included, using byte_data field instead of their repeated "
+    "fields");
+
 #ifdef _MSC_VER
 // It's MSVC, so we just have to guess ... and allow an override
 #ifdef FOLLY_ENDIAN_BE
@@ -79,6 +89,36 @@ class StringDeserializer : public BlobDeserializerBase {
 };
 
 namespace {
+// Runs fn(0), ..., fn(n - 1) on up to caffe2_max_tensor_serializer_threads
+// threads, the calling one included.
+void ParallelForChunks(size_t n, const std::function<void(size_t)>& fn) {
+#ifndef __ANDROID__
+  const size_t num_threads = std::min<size_t>(
+      n, std::max(FLAGS_caffe2_max_tensor_serializer_threads, 1));
+  if (num_threads > 1) {
+    std::atomic<size_t> next(0);
+    auto task = [&]() {
+      for (size_t i = next++; i < n; i = next++) {
+        fn(i);
+      }
+    };
+    std::vector<std::future<void>> futures;
+    futures.reserve(num_threads - 1);
+    for (size_t i = 1; i < num_threads; ++i) {
+      futures.emplace_back(std::async(std::launch::async, task));
+    }
+    task();
+    for (auto& fut : futures) {
+      fut.get();
+    }
+    return;
+  }
+#endif
+  for (size_t i = 0; i < n; ++i) {
+    fn(i);
+  }
+}
+
 void SerializeBlob(
     const void* pointer,
     TypeMeta typeMeta,
@@ -153,50 +193,15 @@ void TensorSerializer::SerializeWithChunkSize(
         SerializeBlobProtoAsString_EnforceCheck(blob_proto));
   };
 
-#ifndef __ANDROID__
-  // Poorman's IOBound ThreadPool
-  SimpleQueue<size_t> chunkQueue;
-  auto task = [&]() {
-    size_t chunkStart;
-    while (chunkQueue.Pop(&chunkStart)) {
-      processChunk(chunkStart);
-    }
-  };
-  std::vector<std::future<void>> futures;
-  if (tensor.numel() > chunk_size) {
-    futures.reserve(FLAGS_caffe2_max_tensor_serializer_threads);
-    for (int i = 0; i < FLAGS_caffe2_max_tensor_serializer_threads; ++i) {
-      futures.emplace_back(std::async(std::launch::async, task));
-    }
-  }
-#endif
-
   VLOG(1) << "Serializing blob " << name;
   // Serialize whole vector. If vector is empty, it's shape still needs to be
   // serialized in empty proto
-  for (size_t chunkBegin = 0;
-       chunkBegin < std::max(tensor.numel(), static_cast<int64_t>(1));
-       chunkBegin += chunk_size) {
-    VLOG(2) << "Starting a chunk at " << chunkBegin;
-#ifndef __ANDROID__
-    if (tensor.numel() > chunk_size) {
-      chunkQueue.Push(chunkBegin);
-    } else {
-      // Sync mode for small tensors
-      processChunk(chunkBegin);
-    }
-#else
-    // Since Android does not have std::future, we will always do sync mode
-    processChunk(chunkBegin);
-#endif
-  }
-
-#ifndef __ANDROID__
-  chunkQueue.NoMoreJobs();
-  for (auto& fut : futures) {
-    fut.get();
-  }
-#endif
+  const int64_t numChunks = std::max(
+      (tensor.numel() + chunk_size - 1) / chunk_size, static_cast<int64_t>(1));
+  ParallelForChunks(numChunks, [&](size_t chunkId) {
+    VLOG(2) << "Starting a chunk at " << chunkId * chunk_size;
+    processChunk(chunkId * chunk_size);
+  });
 }
 
 static bool EnableByteEncoding(
@@ -206,7 +211,8 @@ static bool EnableByteEncoding(
   bool ret = false;
   bool safeForEndianness = (typeSize == 1 || kIsLittleEndian);
   if (safeForEndianness) {
-    ret = FLAGS_caffe2_serialize_using_bytes_as_holder;
+    ret = FLAGS_caffe2_serialize_using_bytes_as_holder ||
+        FLAGS_caffe2_serialize_tensors_as_bytes;
     // Check if special casing for float is enabled if
     // caffe2_serialize_using_bytes_as_holder is not enabled.
     if (!ret) {
@@ -218,6 +224,26 @@ static bool EnableByteEncoding(
   return ret;
 }
 
+// Copies the elements of the chunk as they are into the byte_data field.
+template <typename S>
+static void SerializeUsingBytes(
+    const Tensor& input,
+    size_t chunkBegin,
+    int32_t chunkSize,
+    BaseContext* context,
+    TensorProto& proto) {
+  const auto bufSize = sizeof(S) * chunkSize;
+  auto* byteData =
+      reinterpret_cast<const uint8_t*>(input.template data<S>() + chunkBegin);
+  std::string* buffer = proto.mutable_byte_data();
+  buffer->resize(bufSize);
+  if (bufSize > 0) {
+    context->template CopyToCPU<uint8_t>(
+        bufSize, byteData, reinterpret_cast<uint8_t*>(&(*buffer)[0]));
+  }
+  context->FinishDeviceComputation();
+}
+
 template <typename T, typename S = T>
 static void SerializeUsingBytesOrInt32(
     const Tensor& input,
@@ -228,13 +254,7 @@ static void SerializeUsingBytesOrInt32(
     TensorProto& proto) {
   const auto typeSize = sizeof(T);
   if (EnableByteEncoding(dataType, typeSize)) {
-    const auto bufSize = typeSize * chunkSize;
-    auto* byteData =
-        reinterpret_cast<const uint8_t*>(input.template data<S>() + chunkBegin);
-    unique_ptr<uint8_t[]> buffer(new uint8_t[bufSize]);
-    context->template CopyToCPU<uint8_t>(bufSize, byteData, buffer.get());
-    context->FinishDeviceComputation();
-    proto.set_byte_data(buffer.get(), bufSize);
+    SerializeUsingBytes<S>(input, chunkBegin, chunkSize, context, proto);
   } else {
     detail::CopyToProtoWithCast(
         chunkSize,
@@ -244,6 +264,23 @@ static void SerializeUsingBytesOrInt32(
   }
 }
 
+template <typename T, typename F>
+static void SerializeUsingBytesOrAsIs(
+    const Tensor& input,
+    const TensorProto::DataType& dataType,
+    size_t chunkBegin,
+    int32_t chunkSize,
+    BaseContext* context,
+    google::protobuf::RepeatedField<F>* field,
+    TensorProto& proto) {
+  if (EnableByteEncoding(dataType, sizeof(T))) {
+    SerializeUsingBytes<T>(input, chunkBegin, chunkSize, context, proto);
+  } else {
+    detail::CopyToProtoAsIs(
+        chunkSize, input.template data<T>() + chunkBegin, field, context);
+  }
+}
+
 void TensorSerializer::Serialize(
     const Tensor& input,
     const string& name,
@@ -290,18 +327,24 @@ void TensorSerializer::Serialize(
   // A lot of copypaste is error prone. Should we create a macro for this?
   switch (data_type) {
     case TensorProto_DataType_FLOAT:
-      detail::CopyToProtoAsIs(
+      SerializeUsingBytesOrAsIs<float>(
+          input,
+          data_type,
+          chunkBegin,
           chunkSize,
-          input.template data<float>() + chunkBegin,
+          uniq_ptr.get(),
           proto.mutable_float_data(),
-          uniq_ptr.get());
+          proto);
       break;
     case TensorProto_DataType_INT32:
-      detail::CopyToProtoAsIs(
+      SerializeUsingBytesOrAsIs<int>(
+          input,
+          data_type,
+          chunkBegin,
           chunkSize,
-          input.template data<int>() + chunkBegin,
+          uniq_ptr.get(),
           proto.mutable_int32_data(),
-          uniq_ptr.get());
+          proto);
       break;
     case TensorProto_DataType_BYTE:
       LOG(FATAL) << "This should not happen. When serializing, "
@@ -336,22 +379,28 @@ void TensorSerializer::Serialize(
           input, data_type, chunkBegin, chunkSize, uniq_ptr.get(), proto);
       break;
     case TensorProto_DataType_INT64:
-      detail::CopyToProtoAsIs(
+      SerializeUsingBytesOrAsIs<int64_t>(
+          input,
+          data_type,
+          chunkBegin,
           chunkSize,
-          input.template data<int64_t>() + chunkBegin,
+          uniq_ptr.get(),
           proto.mutable_int64_data(),
-          uniq_ptr.get());
+          proto);
       break;
     case TensorProto_DataType_FLOAT16:
       SerializeUsingBytesOrInt32<uint16_t, at::Half>(
           input, data_type, chunkBegin, chunkSize, uniq_ptr.get(), proto);
       break;
     case TensorProto_DataType_DOUBLE:
-      detail::CopyToProtoAsIs(
+      SerializeUsingBytesOrAsIs<double>(
+          input,
+          data_type,
+          chunkBegin,
           chunkSize,
-          input.template data<double>() + chunkBegin,
+          uniq_ptr.get(),
           proto.mutable_double_data(),
-          uniq_ptr.get());
+          proto);
       break;
     case TensorProto_DataType_UNDEFINED: {
       proto.mutable_string_data()->Reserve(chunkSize);
@@ -418,6 +467,71 @@ void DeserializeBlob(const BlobProto& blob_proto, Blob* result) {
   }
 }
 
+namespace {
+// Whether the chunk can be copied into the tensor that the first chunk set
+// up, concurrently with the other chunks.
+bool IsSegmentOf(const BlobProto& chunk, const BlobProto& first) {
+  if (chunk.type() != kTensorBlobType || first.type() != kTensorBlobType) {
+    return false;
+  }
+  const auto& tensor_proto = chunk.tensor();
+  const auto& first_proto = first.tensor();
+  // The elements of the tensors of UNDEFINED data type are blobs, which set
+  // up the tensor as they are deserialized.
+  if (!tensor_proto.has_segment() ||
+      tensor_proto.data_type() == TensorProto_DataType_UNDEFINED ||
+      tensor_proto.data_type() != first_proto.data_type() ||
+      tensor_proto.dims_size() != first_proto.dims_size()) {
+    return false;
+  }
+  for (int i = 0; i < tensor_proto.dims_size(); ++i) {
+    if (tensor_proto.dims(i) != first_proto.dims(i)) {
+      return false;
+    }
+  }
+  const auto& device = tensor_proto.device_detail();
+  const auto& first_device = first_proto.device_detail();
+  return device.device_type() == first_device.device_type() &&
+      device.device_id() == first_device.device_id();
+}
+} // namespace
+
+std::vector<BlobProto> ParseBlobProtos(const std::vector<string>& contents) {
+  std::vector<BlobProto> protos(contents.size());
+  ParallelForChunks(contents.size(), [&](size_t i) {
+    CAFFE_ENFORCE(
+        protos[i].ParseFromString(contents[i]),
+        "Cannot parse content into a BlobProto.");
+  });
+  return protos;
+}
+
+void DeserializeBlobChunks(
+    const std::vector<BlobProto>& chunks,
+    Blob* result) {
+  if (chunks.empty()) {
+    return;
+  }
+  DeserializeBlob(chunks[0], result);
+  bool concurrent = result->IsType<Tensor>();
+  for (size_t i = 1; concurrent && i < chunks.size(); ++i) {
+    concurrent = IsSegmentOf(chunks[i], chunks[0]);
+  }
+  if (!concurrent) {
+    for (size_t i = 1; i < chunks.size(); ++i) {
+      DeserializeBlob(chunks[i], result);
+    }
+    return;
+  }
+  // The tensor has its size and data type, so the chunks only copy their
+  // segments into it.
+  Tensor* tensor = result->GetMutable<Tensor>();
+  TensorDeserializer deserializer;
+  ParallelForChunks(chunks.size() - 1, [&](size_t i) {
+    deserializer.DeserializeToTensor(chunks[i + 1].tensor(), tensor);
+  });
+}
+
 // === Local helper functions ===
 // Get dimensions from Tensor proto
 static std::vector<int64_t> DimsFromTensorProto(const TensorProto& proto) {
@@ -507,6 +621,34 @@ void TensorDeserializer::Deserialize(const BlobProto& blob_proto, Blob* blob) {
   }
 }
 
+template <typename T, typename D = T>
+void DeserializeFromBytes(
+    const TensorProto& tensor_proto,
+    size_t chunkBegin,
+    int32_t chunkSize,
+    BaseContext* context,
+    Tensor* tensor) {
+  auto typeSize = sizeof(T);
+  CAFFE_ENFORCE(
+      kIsLittleEndian || typeSize == 1,
+      "Serialization with bytes not supported on big endian platform.");
+  size_t numElems = tensor_proto.byte_data().size();
+  if (tensor_proto.data_type() == TensorProto_DataType_UINT8) {
+    if (tensor_proto.has_segment()) {
+      const auto& segment = tensor_proto.segment();
+      numElems = segment.end() - segment.begin();
+    }
+  }
+  CAFFE_ENFORCE_EQ(
+      typeSize * chunkSize, numElems, "Incorrect proto field size.");
+  const uint8_t* protoData =
+      reinterpret_cast<const uint8_t*>(tensor_proto.byte_data().data());
+  context->template CopyToCPU<D>(
+      chunkSize,
+      reinterpret_cast<const D*>(protoData),
+      tensor->template mutable_data<D>() + chunkBegin);
+}
+
 template <typename T, typename D = T>
 void DeserializeFromBytesOrInt32(
     const TensorProto& tensor_proto,
@@ -515,25 +657,8 @@ void DeserializeFromBytesOrInt32(
     BaseContext* context,
     Tensor* tensor) {
   if (tensor_proto.has_byte_data()) {
-    auto typeSize = sizeof(T);
-    CAFFE_ENFORCE(
-        kIsLittleEndian || typeSize == 1,
-        "Serialization with bytes not supported on big endian platform.");
-    size_t numElems = tensor_proto.byte_data().size();
-    if (tensor_proto.data_type() == TensorProto_DataType_UINT8) {
-      if (tensor_proto.has_segment()) {
-        const auto& segment = tensor_proto.segment();
-        numElems = segment.end() - segment.begin();
-      }
-    }
-    CAFFE_ENFORCE_EQ(
-        typeSize * chunkSize, numElems, "Incorrect proto field size.");
-    const uint8_t* protoData =
-        reinterpret_cast<const uint8_t*>(tensor_proto.byte_data().data());
-    context->template CopyToCPU<D>(
-        chunkSize,
-        reinterpret_cast<const D*>(protoData),
-        tensor->template mutable_data<D>() + chunkBegin);
+    DeserializeFromBytes<T, D>(
+        tensor_proto, chunkBegin, chunkSize, context, tensor);
   } else {
     // Backward compatibility with models which used int32_data field
     detail::CopyFromProtoWithCast(
@@ -544,6 +669,28 @@ void DeserializeFromBytesOrInt32(
   }
 }
 
+// The types with a repeated field of their own are in byte_data if they were
+// serialized with caffe2_serialize_tensors_as_bytes.
+template <typename T, typename F>
+void DeserializeFromBytesOrAsIs(
+    const TensorProto& tensor_proto,
+    const google::protobuf::RepeatedField<F>& field,
+    size_t chunkBegin,
+    int32_t chunkSize,
+    BaseContext* context,
+    Tensor* tensor) {
+  if (tensor_proto.has_byte_data()) {
+    DeserializeFromBytes<T>(
+        tensor_proto, chunkBegin, chunkSize, context, tensor);
+  } else {
+    detail::CopyFromProtoAsIs(
+        chunkSize,
+        field,
+        tensor->template mutable_data<T>() + chunkBegin,
+        context);
+  }
+}
+
 void TensorDeserializer::DeserializeToTensor(
     const TensorProto& tensor_proto,
     Tensor* tensor) {
@@ -575,18 +722,22 @@ void TensorDeserializer::DeserializeToTensor(
 
   switch (tensor_proto.data_type()) {
     case TensorProto_DataType_FLOAT:
-      detail::CopyFromProtoAsIs(
-          chunkSize,
+      DeserializeFromBytesOrAsIs<float>(
+          tensor_proto,
           tensor_proto.float_data(),
-          tensor->template mutable_data<float>() + chunkBegin,
-          context);
+          chunkBegin,
+          chunkSize,
+          context,
+          tensor);
       break;
     case TensorProto_DataType_INT32:
-      detail::CopyFromProtoAsIs(
-          chunkSize,
+      DeserializeFromBytesOrAsIs<int>(
+          tensor_proto,
           tensor_proto.int32_data(),
-          tensor->template mutable_data<int>() + chunkBegin,
-          context);
+          chunkBegin,
+          chunkSize,
+          context,
+          tensor);
       break;
     case TensorProto_DataType_BYTE:
       // Since BYTE stores the data in a string field instead of a repreated
@@ -630,22 +781,26 @@ void TensorDeserializer::DeserializeToTensor(
           tensor_proto, chunkBegin, chunkSize, context, tensor);
       break;
     case TensorProto_DataType_INT64:
-      detail::CopyFromProtoAsIs(
-          chunkSize,
+      DeserializeFromBytesOrAsIs<int64_t>(
+          tensor_proto,
           tensor_proto.int64_data(),
-          tensor->template mutable_data<int64_t>() + chunkBegin,
-          context);
+          chunkBegin,
+          chunkSize,
+          context,
+          tensor);
       break;
     case TensorProto_DataType_FLOAT16:
       DeserializeFromBytesOrInt32<uint16_t, at::Half>(
           tensor_proto, chunkBegin, chunkSize, context, tensor);
       break;
     case TensorProto_DataType_DOUBLE:
-      detail::CopyFromProtoAsIs(
-          chunkSize,
+      DeserializeFromBytesOrAsIs<double>(
+          tensor_proto,
           tensor_proto.double_data(),
-          tensor->template mutable_data<double>() + chunkBegin,
-          context);
+          chunkBegin,
+          chunkSize,
+          context,
+          tensor);
       break;
     case TensorProto_DataType_UNDEFINED: {
       Blob temp_blob;
@@ -16,6 +16,7 @@
 C10_DECLARE_int(caffe2_tensor_chunk_size);
 C10_DECLARE_int(caffe2_max_tensor_serializer_threads);
 C10_DECLARE_bool(caffe2_serialize_fp16_as_bytes);
+C10_DECLARE_bool(caffe2_serialize_tensors_as_bytes);
 
 namespace caffe2 {
 
@@ -55,6 +56,24 @@ CAFFE2_API string SerializeBlob(const Blob& blob, const string& name);
 CAFFE2_API void DeserializeBlob(const string& content, Blob* result);
 CAFFE2_API void DeserializeBlob(const BlobProto& proto, Blob* result);
 
+/**
+ * Parses the given BlobProto strings concurrently, on up to
+ * caffe2_max_tensor_serializer_threads threads.
+ */
+CAFFE2_API std::vector<BlobProto> ParseBlobProtos(
+    const std::vector<string>& contents);
+
+/**
+ * Deserializes chunks of a blob that SerializeBlob split with a chunk size,
+ * in any order. The first chunk of a tensor sets it up, and the others are
+ * deserialized concurrently, each directly into its segment of the tensor,
+ * on up to caffe2_max_tensor_serializer_threads threads. The chunks of other
+ * blobs are deserialized one after the other.
+ */
+CAFFE2_API void DeserializeBlobChunks(
+    const std::vector<BlobProto>& chunks,
+    Blob* result);
+
 /*
  * Get an empty Tensor from the TensorProto given the meta data in proto (data
  * type and size of the Tensor) without actually filling in the data.
@@ -161,10 +180,7 @@ inline void CopyToProtoAsIs(
       sizeof(SrcType) == sizeof(DstType),
       "The source type and dest type cannot be copied as-is. Did "
       "you mean CopyToProtoWithCast?");
-  field->Reserve(size);
-  for (size_t i = 0; i < size; ++i) {
-    field->Add(0);
-  }
+  field->Resize(size, 0);
   context->template CopyToCPU<SrcType>(
       size, src, reinterpret_cast<SrcType*>(field->mutable_data()));
   // Make sure that we finish the copy into the protobuf.
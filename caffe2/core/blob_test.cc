@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <mutex>
@@ -23,6 +24,7 @@ C10_DEFINE_int64(caffe2_test_big_tensor_size, 100000000, "");
 C10_DECLARE_int(caffe2_tensor_chunk_size);
 C10_DECLARE_bool(caffe2_serialize_fp16_as_bytes);
 C10_DECLARE_bool(caffe2_serialize_using_bytes_as_holder);
+C10_DECLARE_bool(caffe2_serialize_tensors_as_bytes);
 
 namespace caffe2 {
 using namespace ::caffe2::db;
@@ -1077,6 +1079,63 @@ TEST(CustomChunkSize, BigTensorSerialization) {
   EXPECT_EQ(counter, 1);
 }
 
+template <typename T>
+void TestTensorSerializationAsBytes() {
+  Blob blob;
+  Tensor* tensor = BlobGetMutableTensor(&blob, CPU);
+  tensor->Resize(2, 3);
+  for (int i = 0; i < 6; ++i) {
+    tensor->mutable_data<T>()[i] = static_cast<T>(i * 3 - 7);
+  }
+  FLAGS_caffe2_serialize_tensors_as_bytes = true;
+  string serialized = SerializeBlob(blob, "test");
+  FLAGS_caffe2_serialize_tensors_as_bytes = false;
+  BlobProto proto;
+  CHECK(proto.ParseFromString(serialized));
+  EXPECT_EQ(proto.tensor().byte_data().size(), 6 * sizeof(T));
+  Blob new_blob;
+  EXPECT_NO_THROW(DeserializeBlob(serialized, &new_blob));
+  const TensorCPU& new_tensor = new_blob.Get<TensorCPU>();
+  EXPECT_EQ(new_tensor.sizes(), tensor->sizes());
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(tensor->data<T>()[i], new_tensor.data<T>()[i]);
+  }
+}
+
+TEST(TensorSerialization, TensorsAsBytes) {
+  TestTensorSerializationAsBytes<float>();
+  TestTensorSerializationAsBytes<double>();
+  TestTensorSerializationAsBytes<int>();
+  TestTensorSerializationAsBytes<int64_t>();
+}
+
+TEST(TensorSerialization, DeserializeBlobChunks) {
+  Blob blob;
+  Tensor* tensor = BlobGetMutableTensor(&blob, CPU);
+  tensor->Resize(10, 1000);
+  for (int i = 0; i < tensor->numel(); ++i) {
+    tensor->mutable_data<float>()[i] = i;
+  }
+  std::vector<string> chunks;
+  std::mutex mutex;
+  auto acceptor = [&](const std::string& /*key*/, const std::string& value) {
+    std::lock_guard<std::mutex> guard(mutex);
+    chunks.push_back(value);
+  };
+  SerializeBlob(blob, "test", acceptor, 999);
+  EXPECT_EQ(chunks.size(), 11u);
+  // The chunks come in any order.
+  std::reverse(chunks.begin(), chunks.end());
+
+  Blob new_blob;
+  DeserializeBlobChunks(ParseBlobProtos(chunks), &new_blob);
+  const TensorCPU& new_tensor = new_blob.Get<TensorCPU>();
+  EXPECT_EQ(new_tensor.sizes(), tensor->sizes());
+  for (int i = 0; i < tensor->numel(); ++i) {
+    EXPECT_EQ(tensor->data<float>()[i], new_tensor.data<float>()[i]);
+  }
+}
+
 TEST(QTensor, QTensorSizingTest) {
   vector<int> dims(3);
   dims[0] = 2;
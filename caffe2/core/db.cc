@@ -77,6 +77,16 @@ class MiniDBCursor : public Cursor {
     return string(value_.data(), value_len_);
   }
 
+  c10::string_view key_view() override {
+    CAFFE_ENFORCE(valid_, "Cursor is at invalid location!");
+    return c10::string_view(key_.data(), key_len_);
+  }
+
+  c10::string_view value_view() override {
+    CAFFE_ENFORCE(valid_, "Cursor is at invalid location!");
+    return c10::string_view(value_.data(), value_len_);
+  }
+
   bool Valid() override { return valid_; }
 
  private:
@@ -192,6 +202,103 @@ void DBReaderSerializer::Serialize(
   acceptor(name, SerializeBlobProtoAsString_EnforceCheck(blob_proto));
 }
 
+namespace {
+
+constexpr char kRawTensorRecordMagic[] = "C2RT";
+constexpr size_t kRawTensorRecordMagicSize = 4;
+constexpr uint32_t kRawTensorRecordVersion = 1;
+
+template <typename T>
+void appendRaw(string* out, const T& value) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T readRaw(c10::string_view record, size_t* offset) {
+  CAFFE_ENFORCE_LE(
+      *offset + sizeof(T), record.size(), "Truncated raw tensor record.");
+  T value;
+  memcpy(&value, record.data() + *offset, sizeof(T));
+  *offset += sizeof(T);
+  return value;
+}
+
+} // namespace
+
+string SerializeRawTensorRecord(const vector<const Tensor*>& tensors) {
+  size_t size = kRawTensorRecordMagicSize + 2 * sizeof(uint32_t);
+  for (const auto* tensor : tensors) {
+    size += sizeof(int32_t) + sizeof(uint32_t) +
+        tensor->dim() * sizeof(int64_t) + tensor->nbytes();
+  }
+  string record;
+  record.reserve(size);
+  record.append(kRawTensorRecordMagic, kRawTensorRecordMagicSize);
+  appendRaw(&record, kRawTensorRecordVersion);
+  appendRaw(&record, static_cast<uint32_t>(tensors.size()));
+  for (const auto* tensor : tensors) {
+    CAFFE_ENFORCE(
+        tensor->GetDeviceType() == CPU,
+        "Raw tensor records only hold CPU tensors.");
+    const auto data_type = TypeMetaToDataType(tensor->dtype());
+    CAFFE_ENFORCE(
+        data_type != TensorProto::UNDEFINED &&
+            tensor->dtype().placementNew() == nullptr,
+        "Raw tensor records only hold tensors of fixed size types, not ",
+        tensor->dtype());
+    appendRaw(&record, static_cast<int32_t>(data_type));
+    appendRaw(&record, static_cast<uint32_t>(tensor->dim()));
+    for (const auto d : tensor->sizes()) {
+      appendRaw(&record, static_cast<int64_t>(d));
+    }
+    record.append(
+        static_cast<const char*>(tensor->raw_data()), tensor->nbytes());
+  }
+  return record;
+}
+
+bool IsRawTensorRecord(c10::string_view record) {
+  return record.size() >= kRawTensorRecordMagicSize &&
+      memcmp(
+          record.data(), kRawTensorRecordMagic, kRawTensorRecordMagicSize) == 0;
+}
+
+vector<RawTensorView> ParseRawTensorRecord(c10::string_view record) {
+  CAFFE_ENFORCE(IsRawTensorRecord(record), "Not a raw tensor record.");
+  size_t offset = kRawTensorRecordMagicSize;
+  const auto version = readRaw<uint32_t>(record, &offset);
+  CAFFE_ENFORCE_EQ(
+      version,
+      kRawTensorRecordVersion,
+      "Unsupported raw tensor record version.");
+  const auto num_tensors = readRaw<uint32_t>(record, &offset);
+  vector<RawTensorView> tensors(num_tensors);
+  for (auto& tensor : tensors) {
+    tensor.dtype = DataTypeToTypeMeta(
+        static_cast<TensorProto::DataType>(readRaw<int32_t>(record, &offset)));
+    CAFFE_ENFORCE(
+        tensor.dtype.placementNew() == nullptr,
+        "Raw tensor records only hold tensors of fixed size types, not ",
+        tensor.dtype);
+    const auto ndim = readRaw<uint32_t>(record, &offset);
+    tensor.dims.resize(ndim);
+    int64_t numel = 1;
+    for (auto& d : tensor.dims) {
+      d = readRaw<int64_t>(record, &offset);
+      CAFFE_ENFORCE_GE(d, 0, "Negative dimension in raw tensor record.");
+      numel *= d;
+    }
+    tensor.nbytes = numel * tensor.dtype.itemsize();
+    CAFFE_ENFORCE_LE(
+        offset + tensor.nbytes, record.size(), "Truncated raw tensor record.");
+    tensor.data = record.data() + offset;
+    offset += tensor.nbytes;
+  }
+  CAFFE_ENFORCE_EQ(
+      offset, record.size(), "Trailing bytes in raw tensor record.");
+  return tensors;
+}
+
 void DBReaderDeserializer::Deserialize(const BlobProto& proto, Blob* blob) {
   DBReaderProto reader_proto;
   CAFFE_ENFORCE(
@@ -4,6 +4,7 @@
 #include <mutex>
 
 #include "c10/util/Registry.h"
+#include "c10/util/string_view.h"
 #include "caffe2/core/blob_serialization.h"
 #include "caffe2/proto/caffe2_pb.h"
 
@@ -46,12 +47,30 @@ class CAFFE2_API Cursor {
    * Returns the current value.
    */
   virtual string value() = 0;
+  /**
+   * Returns the current key and value without copying them, if the db
+   * supports it (e.g. views into the mmap'd pages of lmdb). The views are
+   * valid until the cursor moves or is destroyed. In default, they view a
+   * copy held by the cursor.
+   */
+  virtual c10::string_view key_view() {
+    key_copy_ = key();
+    return key_copy_;
+  }
+  virtual c10::string_view value_view() {
+    value_copy_ = value();
+    return value_copy_;
+  }
   /**
    * Returns whether the current location is valid - for example, if we have
    * reached the end of the database, return false.
    */
   virtual bool Valid() = 0;
 
+ private:
+  string key_copy_;
+  string value_copy_;
+
   C10_DISABLE_COPY_AND_ASSIGN(Cursor);
 };
 
@@ -231,13 +250,29 @@ class CAFFE2_API DBReader {
     *key = cursor_->key();
     *value = cursor_->value();
 
-    // In sharded mode, each read skips num_shards_ records
-    for (uint32_t s = 0; s < num_shards_; s++) {
-      cursor_->Next();
-      if (!cursor_->Valid()) {
-        MoveToBeginning();
-        break;
-      }
+    MoveToNext();
+  }
+
+  /**
+   * Reads `n` sets of key and value under a single lock, as Read() would one
+   * at a time. Thread safe.
+   *
+   * The records are copied straight from the cursor into the strings of keys
+   * and values, which are reused: once they have grown to the size of the
+   * records, reading a batch doesn't allocate.
+   */
+  void ReadBatch(size_t n, vector<string>* keys, vector<string>* values)
+      const {
+    CAFFE_ENFORCE(cursor_ != nullptr, "Reader not initialized.");
+    keys->resize(n);
+    values->resize(n);
+    std::unique_lock<std::mutex> mutex_lock(reader_mutex_);
+    for (size_t i = 0; i < n; ++i) {
+      const auto key = cursor_->key_view();
+      (*keys)[i].assign(key.data(), key.size());
+      const auto value = cursor_->value_view();
+      (*values)[i].assign(value.data(), value.size());
+      MoveToNext();
     }
   }
 
@@ -274,6 +309,17 @@ class CAFFE2_API DBReader {
     SeekToFirst();
   }
 
+  void MoveToNext() const {
+    // In sharded mode, each read skips num_shards_ records
+    for (uint32_t s = 0; s < num_shards_; s++) {
+      cursor_->Next();
+      if (!cursor_->Valid()) {
+        MoveToBeginning();
+        break;
+      }
+    }
+  }
+
   void MoveToBeginning() const {
     cursor_->SeekToFirst();
     for (uint32_t s = 0; s < shard_id_; s++) {
@@ -312,6 +358,29 @@ class CAFFE2_API DBReaderDeserializer : public BlobDeserializerBase {
   void Deserialize(const BlobProto& proto, Blob* blob) override;
 };
 
+/**
+ * Raw tensor records store tensors of fixed size types as their bytes, so
+ * that input ops read them without a protobuf decode: after a header
+ * ("C2RT", a version and the number of tensors, as uint32), each tensor is
+ * its TensorProto::DataType (int32), its number of dimensions (uint32), its
+ * dimensions (int64) and its data, all in the byte order of the machine that
+ * wrote the record.
+ */
+struct RawTensorView {
+  TypeMeta dtype;
+  vector<int64_t> dims;
+  // Unaligned, and valid as long as the record is.
+  const char* data;
+  size_t nbytes;
+};
+
+CAFFE2_API string SerializeRawTensorRecord(
+    const vector<const Tensor*>& tensors);
+
+CAFFE2_API bool IsRawTensorRecord(c10::string_view record);
+
+CAFFE2_API vector<RawTensorView> ParseRawTensorRecord(c10::string_view record);
+
 }  // namespace db
 }  // namespace caffe2
 
@@ -56,6 +56,17 @@ C10_DEFINE_bool(
     false,
     "Run root tasks in current thread instread of scheduling to threadpool");
 
+C10_DEFINE_bool(
+    caffe2_net_async_prioritize_critical_path,
+    false,
+    "Schedule ready tasks by the length of their longest path to the end "
+    "of the net, measured in ops or, with profiling, in time");
+
+C10_DEFINE_bool(
+    caffe2_net_async_use_work_stealing_pools,
+    false,
+    "Use work stealing CPU thread pools");
+
 namespace caffe2 {
 
 std::vector<int>& AsyncNetBase::getStreamCounters() {
@@ -156,8 +167,12 @@ TaskThreadPoolBase* AsyncNetBase::poolGetter(
   std::unique_lock<std::mutex> pools_lock(pools_mutex_);
   auto pool = pools[device_id][pool_size];
   if (!pool) {
+    auto pool_name = DeviceTypeName(device_type);
+    if (options_.use_work_stealing_pools_ && device_type == PROTO_CPU) {
+      pool_name = "CPUWorkStealing";
+    }
     pool = c10::ThreadPoolRegistry()->Create(
-        DeviceTypeName(device_type),
+        pool_name,
         device_id,
         pool_size,
         options_.use_per_net_pools_);
@@ -588,6 +603,8 @@ ExecutionOptions::ExecutionOptions(
   }
 
   use_dfs_scheduling_ = false;
+  prioritize_critical_path_ = FLAGS_caffe2_net_async_prioritize_critical_path;
+  use_work_stealing_pools_ = FLAGS_caffe2_net_async_use_work_stealing_pools;
 
   for (int arg_idx = 0; arg_idx < net_def->arg_size(); ++arg_idx) {
     auto& arg = net_def->arg(arg_idx);
@@ -599,6 +616,14 @@ ExecutionOptions::ExecutionOptions(
       CAFFE_ENFORCE(arg.has_i(), "deferrable_mode should be an int");
       use_dfs_scheduling_ = arg.i() == 1; // corr. to DFS scheduling
     }
+    if (arg.has_name() && arg.name() == "prioritize_critical_path") {
+      CAFFE_ENFORCE(arg.has_i(), "prioritize_critical_path should be an int");
+      prioritize_critical_path_ = arg.i() == 1;
+    }
+    if (arg.has_name() && arg.name() == "use_work_stealing_pools") {
+      CAFFE_ENFORCE(arg.has_i(), "use_work_stealing_pools should be an int");
+      use_work_stealing_pools_ = arg.i() == 1;
+    }
   }
 
   if (FLAGS_caffe2_net_async_profile_operators) {
@@ -615,6 +640,12 @@ C10_REGISTER_CREATOR(
     ThreadPoolRegistry,
     CPU,
     caffe2::GetAsyncNetThreadPool<TaskThreadPool, caffe2::PROTO_CPU>);
+C10_REGISTER_CREATOR(
+    ThreadPoolRegistry,
+    CPUWorkStealing,
+    caffe2::GetAsyncNetThreadPool<
+        WorkStealingTaskThreadPool,
+        caffe2::PROTO_CPU>);
 C10_REGISTER_CREATOR(
     ThreadPoolRegistry,
     CUDA,
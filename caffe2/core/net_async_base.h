@@ -23,6 +23,8 @@ C10_DECLARE_bool(caffe2_net_async_check_stream_status);
 C10_DECLARE_bool(caffe2_net_async_use_single_pool);
 C10_DECLARE_bool(caffe2_net_async_use_per_net_pools);
 C10_DECLARE_bool(caffe2_net_async_run_root_tasks_inline);
+C10_DECLARE_bool(caffe2_net_async_prioritize_critical_path);
+C10_DECLARE_bool(caffe2_net_async_use_work_stealing_pools);
 C10_DECLARE_bool(caffe2_net_async_profile_operators);
 
 namespace caffe2 {
@@ -55,6 +57,10 @@ struct ExecutionOptions {
   bool use_dfs_scheduling_ = false;
   // run net's root tasks in RunAsync thread instead of in thread pool
   bool run_root_tasks_inline_ = false;
+  // schedule the ready tasks on the longest remaining path of the net first
+  bool prioritize_critical_path_ = false;
+  // use work stealing CPU thread pools, which also honor task priorities
+  bool use_work_stealing_pools_ = false;
 };
 
 struct CAFFE2_API AsyncNetCancelled : public std::exception {
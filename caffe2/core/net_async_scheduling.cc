@@ -7,7 +7,11 @@ namespace caffe2 {
 AsyncSchedulingNet::AsyncSchedulingNet(
     const std::shared_ptr<const NetDef>& net_def,
     Workspace* ws)
-    : AsyncNetBase(net_def, ws), running_(false) {}
+    : AsyncNetBase(net_def, ws), running_(false) {
+  if (options_.prioritize_critical_path_) {
+    computeTaskPriorities();
+  }
+}
 
 void AsyncSchedulingNet::reset() {
   AsyncNetBase::reset();
@@ -32,6 +36,78 @@ bool AsyncSchedulingNet::isInlineTask(int parent_id, int child_id) const {
       last_parent_op->device_option(), first_child_op->device_option());
 }
 
+void AsyncSchedulingNet::computeTaskPriorities() {
+  std::vector<float> op_times;
+  if (options_.report_stats_) {
+    op_times = counters_.GetPerOpMeanTimes();
+  }
+  // Without measurements each op costs 1, with them its mean time in
+  // microseconds, and at least 1 for the ops faster than the timer
+  auto task_cost = [this, &op_times](int task_id) {
+    int64_t cost = 0;
+    for (auto op_id : chains_[task_id]) {
+      cost += op_times.empty()
+          ? 1
+          : std::max<int64_t>(1, static_cast<int64_t>(op_times[op_id] * 1000));
+    }
+    return cost;
+  };
+
+  // Visit the tasks from the end of the net, each after all of its children
+  const auto tasks_num = tasksNum();
+  std::vector<int64_t> priorities(tasks_num, 0);
+  std::vector<size_t> unvisited_children(tasks_num);
+  std::vector<int> visitable;
+  for (auto task_id = 0; task_id < tasks_num; ++task_id) {
+    unvisited_children[task_id] = children(task_id).size();
+    if (unvisited_children[task_id] == 0) {
+      visitable.push_back(task_id);
+    }
+  }
+  while (!visitable.empty()) {
+    auto task_id = visitable.back();
+    visitable.pop_back();
+    int64_t longest_child_path = 0;
+    for (auto child_id : children(task_id)) {
+      longest_child_path = std::max(longest_child_path, priorities[child_id]);
+    }
+    priorities[task_id] = task_cost(task_id) + longest_child_path;
+    for (auto parent_id : parents(task_id)) {
+      if (--unvisited_children[parent_id] == 0) {
+        visitable.push_back(parent_id);
+      }
+    }
+  }
+
+  auto by_priority = [&priorities](int lhs, int rhs) {
+    return priorities[lhs] > priorities[rhs];
+  };
+  std::vector<std::vector<int>> prioritized_children(tasks_num);
+  std::vector<int> prioritized_roots;
+  for (auto task_id = 0; task_id < tasks_num; ++task_id) {
+    prioritized_children[task_id] = children(task_id);
+    std::stable_sort(
+        prioritized_children[task_id].begin(),
+        prioritized_children[task_id].end(),
+        by_priority);
+    if (parents(task_id).empty()) {
+      prioritized_roots.push_back(task_id);
+    }
+  }
+  std::stable_sort(
+      prioritized_roots.begin(), prioritized_roots.end(), by_priority);
+
+  task_priorities_ = std::move(priorities);
+  prioritized_children_ = std::move(prioritized_children);
+  prioritized_roots_ = std::move(prioritized_roots);
+}
+
+const std::vector<int>& AsyncSchedulingNet::prioritizedChildren(
+    int task_id) const {
+  return options_.prioritize_critical_path_ ? prioritized_children_[task_id]
+                                            : children(task_id);
+}
+
 // schedule() is not supposed to throw, all exceptions in the ops are caught
 // and reported in the end of the graph's execution, the full graph of tasks
 // is expected to be scheduled
@@ -72,7 +148,23 @@ void AsyncSchedulingNet::schedule(int task_id, bool run_inline) noexcept {
         }
       }
 
-      for (auto child_id : children(task_id)) {
+      // When prioritizing, the child to run inline, if any, is the highest
+      // priority one of those that can; it only runs after the other ready
+      // children were handed to the pools
+      int inline_child_id = -1;
+      auto schedule_child = [this, task_id, &inline_child_id](int child_id) {
+        bool run_inline = isInlineTask(task_id, child_id);
+        if (run_inline && options_.prioritize_critical_path_) {
+          if (inline_child_id < 0) {
+            inline_child_id = child_id;
+            return;
+          }
+          run_inline = false;
+        }
+        schedule(child_id, run_inline);
+      };
+
+      for (auto child_id : prioritizedChildren(task_id)) {
         int parent_count = updateParentCount(child_id);
         if (parent_count == 0) {
           // Schedule a child if:
@@ -85,7 +177,7 @@ void AsyncSchedulingNet::schedule(int task_id, bool run_inline) noexcept {
               options_.finish_chain_ || canSchedule(child_id)) {
             // if DFS scheduling is enabled, run children inline,
             // ignore DFS scheduling in callbacks
-            schedule(child_id, isInlineTask(task_id, child_id));
+            schedule_child(child_id);
           } else {
             bool parent_failed = false;
             bool parent_needs_polling = false;
@@ -123,7 +215,7 @@ void AsyncSchedulingNet::schedule(int task_id, bool run_inline) noexcept {
             if (parent_failed) {
               // one of parents failed, set failure flag and wrap up execution
               success_ = false;
-              schedule(child_id, isInlineTask(task_id, child_id));
+              schedule_child(child_id);
             } else if (parent_needs_polling) {
               // some parents are blocking us from scheduling a child and don't
               // support callbacks, using polling
@@ -141,11 +233,14 @@ void AsyncSchedulingNet::schedule(int task_id, bool run_inline) noexcept {
               }
             } else {
               // we're ready to schedule a child
-              schedule(child_id, isInlineTask(task_id, child_id));
+              schedule_child(child_id);
             }
           }
         }
       }
+      if (inline_child_id >= 0) {
+        schedule(inline_child_id, /* run_inline */ true);
+      }
 
       // In case of net's failure, make sure all pending tasks are finished
       if (!success_) {
@@ -174,7 +269,12 @@ void AsyncSchedulingNet::schedule(int task_id, bool run_inline) noexcept {
     schedule_func();
   } else {
     const auto& device_option = event(task_id).GetDeviceOption();
-    pool(device_option)->run(schedule_func);
+    if (options_.prioritize_critical_path_) {
+      pool(device_option)
+          ->runWithPriority(schedule_func, task_priorities_[task_id]);
+    } else {
+      pool(device_option)->run(schedule_func);
+    }
   }
 }
 
@@ -217,6 +317,10 @@ void AsyncSchedulingNet::finishRun() {
   finalizeEvents();
   if (options_.report_stats_) {
     counters_.ReportRunEnd();
+    // refine the priorities with the measured op times
+    if (options_.prioritize_critical_path_) {
+      computeTaskPriorities();
+    }
   }
   // notify observers and waiters
   StopAllObservers();
@@ -251,10 +355,16 @@ bool AsyncSchedulingNet::RunAsync() {
 
   // schedule() is not expected to throw, at this moment all the initial tasks
   // will be scheduled and the full graph of tasks will be executed
-  for (auto task_id = 0; task_id < tasksNum(); ++task_id) {
-    if (parents(task_id).empty()) {
+  if (options_.prioritize_critical_path_) {
+    for (auto task_id : prioritized_roots_) {
       schedule(task_id, options_.run_root_tasks_inline_);
     }
+  } else {
+    for (auto task_id = 0; task_id < tasksNum(); ++task_id) {
+      if (parents(task_id).empty()) {
+        schedule(task_id, options_.run_root_tasks_inline_);
+      }
+    }
   }
 
   if (tasksNum() == 0) {
@@ -16,6 +16,10 @@ class CAFFE2_API AsyncSchedulingNet : public AsyncNetBase {
 
   void Cancel() override;
 
+  const std::vector<int64_t>& TEST_task_priorities() const {
+    return task_priorities_;
+  }
+
  protected:
   bool RunAsync() override;
 
@@ -28,6 +32,17 @@ class CAFFE2_API AsyncSchedulingNet : public AsyncNetBase {
 
   void CancelAndFinishAsyncTasks();
 
+  // Computes the priority of each task, the length of the longest path from
+  // the task to the end of the net: in ops, or in microseconds once profiling
+  // measured the ops' times; and orders the root tasks and the children of
+  // each task by decreasing priority
+  void computeTaskPriorities();
+  const std::vector<int>& prioritizedChildren(int task_id) const;
+
+  std::vector<int64_t> task_priorities_;
+  std::vector<std::vector<int>> prioritized_children_;
+  std::vector<int> prioritized_roots_;
+
   std::mutex running_mutex_;
   std::condition_variable running_cv_;
   std::atomic<bool> running_;
@@ -920,6 +920,82 @@ TEST(NetTest, AsyncErrorOpTest) {
   ASSERT_FALSE(net->Run());
 }
 
+TEST(NetTest, AsyncSchedulingCriticalPath) {
+  std::string spec_template = R"DOC(
+        name: "critical_path_net"
+        type: "async_scheduling"
+        arg {
+          name: "prioritize_critical_path"
+          i: 1
+        }
+        arg {
+          name: "use_work_stealing_pools"
+          i: 1
+        }
+        arg {
+          name: "enable_profiling"
+          i: <PROFILING>
+        }
+        external_input: "in"
+        op {
+          input: "in"
+          output: "a"
+          type: "NetTestDummy"
+        }
+        op {
+          input: "a"
+          output: "b"
+          type: "NetTestDummy"
+        }
+        op {
+          input: "a"
+          output: "c"
+          type: "NetTestDummy"
+        }
+        op {
+          input: "b"
+          output: "d"
+          type: "NetTestDummy"
+        }
+        op {
+          input: "d"
+          output: "e"
+          type: "NetTestDummy"
+        }
+  )DOC";
+
+  for (auto profiling : {false, true}) {
+    std::string spec = spec_template;
+    ReplaceAll(spec, "<PROFILING>", profiling ? "1" : "0");
+    NetDef net_def;
+    CAFFE_ENFORCE(TextFormat::ParseFromString(spec, &net_def));
+
+    Workspace ws;
+    ws.CreateBlob("in");
+    auto net = CreateNet(net_def, &ws);
+    auto* scheduling_net = dynamic_cast_if_rtti<AsyncSchedulingNet*>(net.get());
+    ASSERT_TRUE(scheduling_net != nullptr);
+
+    // Before any measurement, priorities count the ops on the longest path
+    // (in -> a -> b -> d -> e) from each task
+    const auto& priorities = scheduling_net->TEST_task_priorities();
+    ASSERT_EQ(
+        priorities.size(), scheduling_net->TEST_execution_chains().size());
+    auto max_priority = *std::max_element(priorities.begin(), priorities.end());
+    ASSERT_GE(max_priority, 4);
+    ASSERT_LE(max_priority, 5);
+
+    for (auto run = 0; run < 10; ++run) {
+      counter.exchange(0);
+      ASSERT_TRUE(net->Run());
+      ASSERT_EQ(5, counter.load());
+    }
+    for (auto priority : scheduling_net->TEST_task_priorities()) {
+      ASSERT_GE(priority, 1);
+    }
+  }
+}
+
 TEST(NetTest, AsyncErrorTimingsTest) {
   Workspace ws;
   std::string spec = R"DOC(
@@ -105,6 +105,10 @@ class ProfDAGCounters {
   void AddPerOpAsyncEndTime(size_t op_id);
   ProfDAGReport GetReport() const;
 
+  // Mean execution time (in ms) of each operator of the net over the valid
+  // runs so far, empty if there weren't any
+  std::vector<float> GetPerOpMeanTimes() const;
+
  private:
   Timer timer_;
 
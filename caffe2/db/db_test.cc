@@ -200,5 +200,68 @@ TEST(DBReaderShardedTest, Reader) {
   EXPECT_EQ(value, "05");
 }
 
+TEST(DBReaderTest, ReadBatch) {
+  std::string name = std::tmpnam(nullptr);
+  CreateAndFill("minidb", name);
+  DBReader reader("minidb", name);
+  vector<string> keys, values;
+  reader.ReadBatch(4, &keys, &values);
+  EXPECT_EQ(keys, (vector<string>{"00", "01", "02", "03"}));
+  EXPECT_EQ(values, keys);
+  // Wraps around at the end of the db.
+  reader.ReadBatch(8, &keys, &values);
+  EXPECT_EQ(
+      keys,
+      (vector<string>{"04", "05", "06", "07", "08", "09", "00", "01"}));
+  string key, value;
+  reader.Read(&key, &value);
+  EXPECT_EQ(key, "02");
+}
+
+TEST(DBCursorTest, MiniDBViews) {
+  std::string name = std::tmpnam(nullptr);
+  CreateAndFill("minidb", name);
+  std::unique_ptr<DB> db(CreateDB("minidb", name, READ));
+  std::unique_ptr<Cursor> cursor(db->NewCursor());
+  for (int i = 0; i < kMaxItems; ++i) {
+    ASSERT_TRUE(cursor->Valid());
+    EXPECT_EQ(string(cursor->key_view()), cursor->key());
+    EXPECT_EQ(string(cursor->value_view()), cursor->value());
+    cursor->Next();
+  }
+  EXPECT_FALSE(cursor->Valid());
+}
+
+TEST(RawTensorRecordTest, RoundTrip) {
+  Tensor floats(vector<int64_t>{2, 3}, CPU);
+  for (int i = 0; i < floats.numel(); ++i) {
+    floats.mutable_data<float>()[i] = i * 0.5f;
+  }
+  Tensor ints(vector<int64_t>{4}, CPU);
+  for (int i = 0; i < ints.numel(); ++i) {
+    ints.mutable_data<int64_t>()[i] = -i;
+  }
+  Tensor scalar(vector<int64_t>{}, CPU);
+  scalar.mutable_data<uint8_t>()[0] = 7;
+
+  const string record = SerializeRawTensorRecord({&floats, &ints, &scalar});
+  EXPECT_TRUE(IsRawTensorRecord(record));
+  EXPECT_FALSE(IsRawTensorRecord("00"));
+  const auto tensors = ParseRawTensorRecord(record);
+  ASSERT_EQ(tensors.size(), 3);
+  EXPECT_EQ(tensors[0].dtype, TypeMeta::Make<float>());
+  EXPECT_EQ(tensors[0].dims, (vector<int64_t>{2, 3}));
+  EXPECT_EQ(memcmp(tensors[0].data, floats.raw_data(), floats.nbytes()), 0);
+  EXPECT_EQ(tensors[1].dtype, TypeMeta::Make<int64_t>());
+  EXPECT_EQ(tensors[1].dims, (vector<int64_t>{4}));
+  EXPECT_EQ(memcmp(tensors[1].data, ints.raw_data(), ints.nbytes()), 0);
+  EXPECT_EQ(tensors[2].dtype, TypeMeta::Make<uint8_t>());
+  EXPECT_TRUE(tensors[2].dims.empty());
+  EXPECT_EQ(tensors[2].nbytes, 1);
+  EXPECT_EQ(tensors[2].data[0], 7);
+
+  EXPECT_ANY_THROW(ParseRawTensorRecord(record.substr(0, record.size() - 1)));
+}
+
 } // namespace db
 } // namespace caffe2
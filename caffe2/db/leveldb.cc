@@ -25,6 +25,14 @@ class LevelDBCursor : public Cursor {
   void Next() override { iter_->Next(); }
   string key() override { return iter_->key().ToString(); }
   string value() override { return iter_->value().ToString(); }
+  c10::string_view key_view() override {
+    const auto key = iter_->key();
+    return c10::string_view(key.data(), key.size());
+  }
+  c10::string_view value_view() override {
+    const auto value = iter_->value();
+    return c10::string_view(value.data(), value.size());
+  }
   bool Valid() override { return iter_->Valid(); }
 
  private:
@@ -68,6 +68,18 @@ class LMDBCursor : public Cursor {
         mdb_value_.mv_size);
   }
 
+  // Views into the mmap'd pages, which stay readable for the lifetime of the
+  // read-only transaction.
+  c10::string_view key_view() override {
+    return c10::string_view(
+        static_cast<const char*>(mdb_key_.mv_data), mdb_key_.mv_size);
+  }
+
+  c10::string_view value_view() override {
+    return c10::string_view(
+        static_cast<const char*>(mdb_value_.mv_data), mdb_value_.mv_size);
+  }
+
   bool Valid() override { return valid_; }
 
  private:
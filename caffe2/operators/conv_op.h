@@ -5,23 +5,34 @@
 #include "caffe2/core/operator.h"
 #include "caffe2/operators/conv_op_shared.h"
 #include "caffe2/operators/conv_pool_op_base.h"
+#include "caffe2/operators/elementwise_chain_op.h"
 
 C10_DECLARE_bool(caffe2_force_shared_col_buffer);
 
 namespace caffe2 {
 
+// On CPU, the "activation" argument applies Relu to the output in place, as
+// it does for the NNPACK engine.
 template <typename T, class Context>
 class ConvOp final : public ConvPoolOpBase<Context> {
  public:
   USE_CONV_POOL_BASE_FUNCTIONS(Context);
   explicit ConvOp(const OperatorDef& operator_def, Workspace* ws)
-      : ConvPoolOpBase<Context>(operator_def, ws) {
+      : ConvPoolOpBase<Context>(operator_def, ws),
+        activation_(ParseFusedActivation(
+            this->template GetSingleArgument<std::string>("activation", ""))) {
     // Since this is the default convolution implementation, we will
     // use CAFFE_ENFORCE instead of OPERATOR_NEEDS_FEATURE.
     CAFFE_ENFORCE(
         (group_ == 1 || order_ == StorageOrder::NCHW ||
          std::is_same<Context, CPUContext>::value),
         "Group convolution only supports NCHW order or CPUContext right now.");
+    CAFFE_ENFORCE(
+        activation_ == FusedActivation::NONE ||
+            (activation_ == FusedActivation::RELU &&
+             std::is_same<Context, CPUContext>::value &&
+             std::is_same<T, float>::value),
+        "Conv only fuses Relu, on float CPU tensors.");
 
     // Create shared buffer mutex in the constructor
     // to avoid race-condition in DAGNet.
@@ -31,6 +42,18 @@ class ConvOp final : public ConvPoolOpBase<Context> {
   }
   ~ConvOp() {}
 
+  bool RunOnDevice() override {
+    if (!ConvPoolOpBase<Context>::RunOnDevice()) {
+      return false;
+    }
+    if (activation_ != FusedActivation::NONE) {
+      auto* Y = Output(0);
+      float* Y_data = reinterpret_cast<float*>(Y->template mutable_data<T>());
+      ApplyFusedActivation(activation_, Y->numel(), Y_data, Y_data);
+    }
+    return true;
+  }
+
   bool RunOnDeviceWithOrderNCHW() override;
   bool RunOnDeviceWithOrderNHWC() override;
 
@@ -59,6 +82,7 @@ class ConvOp final : public ConvPoolOpBase<Context> {
   Tensor bias_multiplier_{Context::GetDeviceType()};
   Tensor img_shape_device_{Context::GetDeviceType()};
   Tensor col_buffer_shape_device_{Context::GetDeviceType()};
+  const FusedActivation activation_;
   // Input: X, W, b
   // Output: Y
   INPUT_TAGS(INPUT, FILTER, BIAS);
@@ -0,0 +1,254 @@
+#include "caffe2/operators/elementwise_chain_op.h"
+
+#include <algorithm>
+
+#include "caffe2/operators/elementwise_ops_utils.h"
+#include "caffe2/utils/eigen_utils.h"
+#include "caffe2/utils/math.h"
+
+namespace caffe2 {
+
+namespace {
+
+// The number of elements each step of the chain is run on at a time. The
+// block of the output and those of the operands fit in L1.
+constexpr int64_t kBlockSize = 1024;
+
+// The dimensions of B, leading ones aside, are the trailing ones of A: B
+// repeats over the leading dimensions of A, and A op B has the shape of A.
+bool RepeatsOver(at::IntArrayRef B_dims, at::IntArrayRef A_dims) {
+  size_t leading_ones = 0;
+  while (leading_ones < B_dims.size() && B_dims[leading_ones] == 1) {
+    ++leading_ones;
+  }
+  const auto B_trailing = B_dims.slice(leading_ones);
+  return B_trailing.size() <= A_dims.size() &&
+      A_dims.slice(A_dims.size() - B_trailing.size()) == B_trailing;
+}
+
+// C[i] = A[i] op B[(offset + i) % B_size] for i in [0, N).
+void ApplyBinaryStep(
+    bool mul,
+    int64_t N,
+    int64_t offset,
+    const float* A,
+    const float* B,
+    int64_t B_size,
+    float* C) {
+  if (B_size == 1) {
+    if (mul) {
+      EigenVectorArrayMap<float>(C, N) =
+          ConstEigenVectorArrayMap<float>(A, N) * B[0];
+    } else {
+      EigenVectorArrayMap<float>(C, N) =
+          ConstEigenVectorArrayMap<float>(A, N) + B[0];
+    }
+    return;
+  }
+  int64_t j = offset % B_size;
+  for (int64_t i = 0; i < N;) {
+    const int64_t n = std::min(N - i, B_size - j);
+    if (mul) {
+      EigenVectorArrayMap<float>(C + i, n) =
+          ConstEigenVectorArrayMap<float>(A + i, n) *
+          ConstEigenVectorArrayMap<float>(B + j, n);
+    } else {
+      EigenVectorArrayMap<float>(C + i, n) =
+          ConstEigenVectorArrayMap<float>(A + i, n) +
+          ConstEigenVectorArrayMap<float>(B + j, n);
+    }
+    i += n;
+    j = 0;
+  }
+}
+
+} // namespace
+
+FusedActivation ParseFusedActivation(const std::string& name) {
+  if (name.empty()) {
+    return FusedActivation::NONE;
+  } else if (name == "Relu") {
+    return FusedActivation::RELU;
+  } else if (name == "Sigmoid") {
+    return FusedActivation::SIGMOID;
+  } else if (name == "Tanh") {
+    return FusedActivation::TANH;
+  } else if (name == "Exp") {
+    return FusedActivation::EXP;
+  }
+  CAFFE_THROW("Unsupported fused activation: ", name);
+}
+
+void ApplyFusedActivation(
+    FusedActivation activation,
+    int64_t N,
+    const float* X,
+    float* Y) {
+  // The CPU math functions don't use their context.
+  CPUContext* context = nullptr;
+  switch (activation) {
+    case FusedActivation::NONE:
+      if (X != Y) {
+        std::copy(X, X + N, Y);
+      }
+      break;
+    case FusedActivation::RELU:
+      EigenVectorMap<float>(Y, N) =
+          ConstEigenVectorMap<float>(X, N).cwiseMax(0.0f);
+      break;
+    case FusedActivation::SIGMOID:
+      EigenVectorArrayMap<float>(Y, N) =
+          1.0f / (1.0f + (-ConstEigenVectorArrayMap<float>(X, N)).exp());
+      break;
+    case FusedActivation::TANH:
+      math::Tanh<float, CPUContext>(N, X, Y, context);
+      break;
+    case FusedActivation::EXP:
+      math::Exp<float, CPUContext>(N, X, Y, context);
+      break;
+  }
+}
+
+ElementwiseChainOp::ElementwiseChainOp(
+    const OperatorDef& operator_def,
+    Workspace* ws)
+    : Operator<CPUContext>(operator_def, ws) {
+  int num_operands = 0;
+  for (const auto& type : this->GetRepeatedArgument<std::string>("ops")) {
+    if (type == "Add" || type == "Mul") {
+      steps_.push_back({type == "Add" ? StepKind::ADD : StepKind::MUL,
+                        FusedActivation::NONE});
+      ++num_operands;
+    } else {
+      const auto activation = ParseFusedActivation(type);
+      CAFFE_ENFORCE(activation != FusedActivation::NONE, "Empty op type.");
+      steps_.push_back({StepKind::UNARY, activation});
+    }
+  }
+  CAFFE_ENFORCE(!steps_.empty(), "ElementwiseChain needs ops to run.");
+  CAFFE_ENFORCE_EQ(
+      InputSize(),
+      num_operands + 1,
+      "ElementwiseChain takes one input per Add and Mul besides X.");
+}
+
+bool ElementwiseChainOp::RunOnDevice() {
+  const auto& X = Input(0);
+  for (int i = 1; i < InputSize(); ++i) {
+    const auto& B = Input(i);
+    // An operand being the output, or X when it is the output, would be
+    // overwritten by the steps before it.
+    if (!RepeatsOver(B.sizes(), X.sizes()) || IsInputOutputAlias(i, 0) ||
+        (IsInputOutputAlias(0, 0) && B.raw_data() == X.raw_data())) {
+      return RunStepwise();
+    }
+  }
+  return RunBlocked();
+}
+
+bool ElementwiseChainOp::RunBlocked() {
+  const auto& X = Input(0);
+  auto* Y = Output(0, X.sizes(), at::dtype<float>());
+  const int64_t N = X.numel();
+  const float* X_data = X.data<float>();
+  float* Y_data = Y->template mutable_data<float>();
+  for (int64_t begin = 0; begin < N; begin += kBlockSize) {
+    const int64_t n = std::min(kBlockSize, N - begin);
+    const float* src = X_data + begin;
+    float* dst = Y_data + begin;
+    int operand = 1;
+    for (const auto& step : steps_) {
+      if (step.kind == StepKind::UNARY) {
+        ApplyFusedActivation(step.activation, n, src, dst);
+      } else {
+        const auto& B = Input(operand++);
+        ApplyBinaryStep(
+            step.kind == StepKind::MUL,
+            n,
+            begin,
+            src,
+            B.data<float>(),
+            B.numel(),
+            dst);
+      }
+      src = dst;
+    }
+  }
+  return true;
+}
+
+bool ElementwiseChainOp::RunStepwise() {
+  // Some operand broadcasts to a larger shape than X's: run the steps one
+  // after the other as the operators would, broadcasting like Add and Mul.
+  Tensor current = Input(0).UnsafeSharedInstance();
+  int operand = 1;
+  for (const auto& step : steps_) {
+    Tensor next(CPU);
+    if (step.kind == StepKind::UNARY) {
+      next.Resize(current.sizes());
+      ApplyFusedActivation(
+          step.activation,
+          current.numel(),
+          current.data<float>(),
+          next.mutable_data<float>());
+    } else {
+      const auto& B = Input(operand++);
+      const std::vector<int> A_dims(
+          current.sizes().cbegin(), current.sizes().cend());
+      const std::vector<int> B_dims(B.sizes().cbegin(), B.sizes().cend());
+      const auto C_dims =
+          elementwise_ops_utils::ComputeBinaryBroadcastForwardDims(
+              A_dims, B_dims);
+      next.Resize(C_dims);
+      if (step.kind == StepKind::MUL) {
+        math::Mul<float, CPUContext>(
+            A_dims.size(),
+            A_dims.data(),
+            B_dims.size(),
+            B_dims.data(),
+            current.data<float>(),
+            B.data<float>(),
+            next.mutable_data<float>(),
+            &context_);
+      } else {
+        math::Add<float, CPUContext>(
+            A_dims.size(),
+            A_dims.data(),
+            B_dims.size(),
+            B_dims.data(),
+            current.data<float>(),
+            B.data<float>(),
+            next.mutable_data<float>(),
+            &context_);
+      }
+    }
+    current = std::move(next);
+  }
+  Output(0)->CopyFrom(current);
+  return true;
+}
+
+REGISTER_CPU_OPERATOR(ElementwiseChain, ElementwiseChainOp);
+
+OPERATOR_SCHEMA(ElementwiseChain)
+    .NumInputs(1, INT_MAX)
+    .NumOutputs(1)
+    .AllowInplace({{0, 0}})
+    .SetDoc(R"DOC(
+Runs a chain of elementwise operators on float tensors as a single operator,
+without materializing the intermediate results. The `ops` are run in order:
+the first one on X, each of the others on the result of the previous one.
+Relu, Sigmoid, Tanh and Exp are computed as the operators of the same name. Add
+and Mul take the next of the other inputs as their second operand, and
+broadcast it as the operators of the same name do.
+
+The net fusion passes of caffe2/opt create this operator from chains of the
+operators it fuses; it is not meant to be written by hand.
+)DOC")
+    .Arg("ops", "(list of strings) The types of the operators of the chain.")
+    .Input(0, "X", "The input of the first operator of the chain.")
+    .Output(0, "Y", "The output of the last operator of the chain.");
+
+SHOULD_NOT_DO_GRADIENT(ElementwiseChain);
+
+} // namespace caffe2
@@ -0,0 +1,52 @@
+#ifndef CAFFE2_OPERATORS_ELEMENTWISE_CHAIN_OP_H_
+#define CAFFE2_OPERATORS_ELEMENTWISE_CHAIN_OP_H_
+
+#include <string>
+#include <vector>
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+
+namespace caffe2 {
+
+// The activations FC and Conv apply in place to their outputs when given an
+// "activation" argument, which are also the unary steps of ElementwiseChain.
+enum class FusedActivation { NONE, RELU, SIGMOID, TANH, EXP };
+
+// Parses an operator type ("Relu", "Sigmoid", ...) into an activation, NONE
+// for the empty string. Throws for the other types.
+CAFFE2_API FusedActivation ParseFusedActivation(const std::string& name);
+
+// Computes the activation as the operator of the same name does. Y may be X.
+CAFFE2_API void ApplyFusedActivation(
+    FusedActivation activation,
+    int64_t N,
+    const float* X,
+    float* Y);
+
+// Runs a chain of elementwise operators (see the schema) as one, a block of
+// elements after the other, so that the intermediate values stay in cache
+// instead of going through blobs of their own.
+class ElementwiseChainOp final : public Operator<CPUContext> {
+ public:
+  USE_OPERATOR_FUNCTIONS(CPUContext);
+  ElementwiseChainOp(const OperatorDef& operator_def, Workspace* ws);
+
+  bool RunOnDevice() override;
+
+ private:
+  enum class StepKind { UNARY, ADD, MUL };
+  struct Step {
+    StepKind kind;
+    FusedActivation activation;
+  };
+
+  bool RunBlocked();
+  bool RunStepwise();
+
+  std::vector<Step> steps_;
+};
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_ELEMENTWISE_CHAIN_OP_H_
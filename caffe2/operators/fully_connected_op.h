@@ -4,12 +4,15 @@
 #include <c10/util/Optional.h>
 #include "caffe2/core/context.h"
 #include "caffe2/core/operator.h"
+#include "caffe2/operators/elementwise_chain_op.h"
 #include "caffe2/utils/conversions.h"
 #include "caffe2/utils/math.h"
 
 namespace caffe2 {
 
 // This is Caffe's InnerProductOp, with a name that fits its purpose better.
+// On CPU, the "activation" argument applies Relu, Sigmoid or Tanh to the
+// output in place, as the fusion passes of caffe2/opt do.
 template <
     class Context,
     class Engine = DefaultEngine,
@@ -23,7 +26,14 @@ class FullyConnectedOp final : public Operator<Context> {
         axis_(this->template GetSingleArgument<int32_t>("axis", 1)),
         axis_w_(this->template GetSingleArgument<int32_t>("axis_w", 1)),
         float16_compute_(
-            this->template GetSingleArgument<bool>("float16_compute", false)) {}
+            this->template GetSingleArgument<bool>("float16_compute", false)),
+        activation_(ParseFusedActivation(
+            this->template GetSingleArgument<std::string>("activation", ""))) {
+    CAFFE_ENFORCE(
+        (activation_ == FusedActivation::NONE ||
+         std::is_same<Context, CPUContext>::value),
+        "FC only fuses activations on CPU.");
+  }
   ~FullyConnectedOp() {}
 
   template <
@@ -91,6 +101,18 @@ class FullyConnectedOp final : public Operator<Context> {
       math_type = TensorProto_DataType_FLOAT16;
     }
 
+    // On CPU, Y starts as copies of the bias, on which the GEMM accumulates,
+    // rather than the bias being added by a second GEMM.
+    const bool bias_in_gemm = std::is_same<Context, CPUContext>::value &&
+        std::is_same<T_B, T_Y>::value;
+    if (bias_in_gemm) {
+      T_Y* Y_data = Y->template mutable_data<T_Y>();
+      const T_B* b_data = b.template data<T_B>();
+      for (int64_t i = 0; i < M; ++i) {
+        memcpy(Y_data + i * N, b_data, N * sizeof(T_Y));
+      }
+    }
+
     // W * x
     math::Gemm<T_X, Context, Engine>(
         CblasNoTrans,
@@ -101,11 +123,16 @@ class FullyConnectedOp final : public Operator<Context> {
         1,
         X.template data<T_X>(),
         W.template data<T_W>(),
-        0,
+        bias_in_gemm ? 1 : 0,
         Y->template mutable_data<T_Y>(),
         &context_,
         math_type);
 
+    if (bias_in_gemm) {
+      ApplyActivation<T_Y>(M * N, Y->template mutable_data<T_Y>());
+      return true;
+    }
+
     // Add bias term
     if (!bias_multiplier_.has_value()) {
       bias_multiplier_ =
@@ -138,6 +165,7 @@ class FullyConnectedOp final : public Operator<Context> {
         &context_,
         math_type);
 
+    ApplyActivation<T_Y>(M * N, Y->template mutable_data<T_Y>());
     return true;
   }
 
@@ -159,6 +187,23 @@ class FullyConnectedOp final : public Operator<Context> {
   c10::optional<Tensor> bias_multiplier_;
 
   bool float16_compute_;
+  FusedActivation activation_;
+
+ private:
+  template <typename T>
+  void ApplyActivation(int64_t N, T* Y) {
+    if (activation_ == FusedActivation::NONE) {
+      return;
+    }
+    CAFFE_ENFORCE(
+        (std::is_same<T, float>::value),
+        "FC only fuses activations into float outputs.");
+    ApplyFusedActivation(
+        activation_,
+        N,
+        reinterpret_cast<const float*>(Y),
+        reinterpret_cast<float*>(Y));
+  }
 };
 
 template <
@@ -213,6 +213,7 @@ class LoadOp final : public Operator<Context> {
       int* total_loaded_blobs) {
     CAFFE_ENFORCE(cursor, "cursor is not valid");
     int loaded_blobs = 0;
+    ChunkBatch batch;
     for (; cursor->Valid(); cursor->Next()) {
       const auto key = load_save_op_util::buildBlobNameFromDbKey(
           cursor->key(), strip_prefix_, add_prefix_);
@@ -222,17 +223,15 @@ class LoadOp final : public Operator<Context> {
         key_to_dbid_[key] = db_id;
       }
 
-      BlobProto proto;
-      CAFFE_ENFORCE(
-          proto.ParseFromString(cursor->value()), "Couldn't parse Proto");
-      if (!keep_device_) {
-        // If we are not keeping the device as the one specified in the
-        // proto, we will set the current device.
-        SetCurrentDevice(&proto);
+      if (!batch.accepts(key)) {
+        processBatch(
+            &batch, ws_->CreateBlob(batch.key), blob_states, &loaded_blobs);
       }
-      Blob* blob = ws_->CreateBlob(key);
-      load_save_op_util::ProcessBlob(
-          blob, proto, blob_states, key, &loaded_blobs);
+      batch.add(key, cursor->value());
+    }
+    if (!batch.values.empty()) {
+      processBatch(
+          &batch, ws_->CreateBlob(batch.key), blob_states, &loaded_blobs);
     }
     *total_loaded_blobs += loaded_blobs;
   }
@@ -245,6 +244,14 @@ class LoadOp final : public Operator<Context> {
       int* total_loaded_blobs) {
     CAFFE_ENFORCE(cursor);
     int loaded_blobs = 0;
+    ChunkBatch batch;
+    // Returns whether all the blobs are loaded.
+    auto flush = [&]() {
+      Blob* blob = outputs.at(output_indices_[batch.key]);
+      processBatch(&batch, blob, blob_states, &loaded_blobs);
+      return *total_loaded_blobs + loaded_blobs == OutputSize();
+    };
+    bool loaded_all = false;
     for (; cursor->Valid(); cursor->Next()) {
       const auto key = load_save_op_util::buildBlobNameFromDbKey(
           cursor->key(), strip_prefix_, add_prefix_);
@@ -258,27 +265,61 @@ class LoadOp final : public Operator<Context> {
         }
 
         VLOG(2) << "Deserializing blob " << key;
-        BlobProto proto;
-        CAFFE_ENFORCE(proto.ParseFromString(cursor->value()));
-        if (!keep_device_) {
-          // If we are not keeping the device as the one specified in the
-          // proto, we will set the current device.
-          SetCurrentDevice(&proto);
-        }
-        auto blobIndex = output_indices_[key];
-        Blob* blob = outputs.at(blobIndex);
-        load_save_op_util::ProcessBlob(
-            blob, proto, blob_states, key, &loaded_blobs);
-
-        if (*total_loaded_blobs + loaded_blobs == OutputSize()) {
-          break;
+        if (!batch.accepts(key)) {
+          loaded_all = flush();
+          if (loaded_all) {
+            break;
+          }
         }
+        batch.add(key, cursor->value());
       }
     }
+    if (!loaded_all && !batch.values.empty()) {
+      flush();
+    }
 
     *total_loaded_blobs += loaded_blobs;
   }
 
+  // Consecutive chunks of the same blob, which are parsed and deserialized
+  // together, the chunks of a tensor concurrently. A batch holds at most
+  // caffe2_max_tensor_serializer_threads chunks, which bounds the memory
+  // their serialized strings take.
+  struct ChunkBatch {
+    string key;
+    std::vector<string> values;
+
+    bool accepts(const string& next_key) const {
+      return values.empty() ||
+          (next_key == key &&
+           values.size() <
+               static_cast<size_t>(FLAGS_caffe2_max_tensor_serializer_threads));
+    }
+
+    void add(const string& next_key, string value) {
+      key = next_key;
+      values.push_back(std::move(value));
+    }
+  };
+
+  void processBatch(
+      ChunkBatch* batch,
+      Blob* blob,
+      std::unordered_map<string, load_save_op_util::BlobState>* blob_states,
+      int* loaded_blobs) {
+    auto protos = ParseBlobProtos(batch->values);
+    batch->values.clear();
+    if (!keep_device_) {
+      // If we are not keeping the device as the one specified in the
+      // proto, we will set the current device.
+      for (auto& proto : protos) {
+        SetCurrentDevice(&proto);
+      }
+    }
+    load_save_op_util::ProcessBlobChunks(
+        blob, protos, blob_states, batch->key, loaded_blobs);
+  }
+
  private:
   Workspace* ws_;
   bool absolute_path_;
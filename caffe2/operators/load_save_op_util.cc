@@ -18,13 +18,12 @@ std::string buildBlobNameFromDbKey(
   return key;
 }
 
-void ProcessBlob(
+namespace {
+
+void ResetIfFirstChunk(
     Blob* blob,
-    const BlobProto& proto,
-    std::unordered_map<std::string, BlobState>* blob_states_ptr,
-    const std::string& key,
-    int* loaded_blobs) {
-  auto& blob_states = *blob_states_ptr;
+    const std::unordered_map<std::string, BlobState>& blob_states,
+    const std::string& key) {
   if (blob_states.count(key) == 0) {
     // We reset the blob so that any existing content is destroyed. This
     // is to guarantee correct device placement: if we are deserializing
@@ -33,7 +32,14 @@ void ProcessBlob(
     // different GPU.
     blob->Reset();
   }
-  DeserializeBlob(proto, blob);
+}
+
+void UpdateBlobState(
+    const BlobProto& proto,
+    std::unordered_map<std::string, BlobState>* blob_states_ptr,
+    const std::string& key,
+    int* loaded_blobs) {
+  auto& blob_states = *blob_states_ptr;
   if (proto.has_content_num_chunks()) {
     if (!blob_states.count(key)) {
       blob_states[key] = BlobState(proto.content_num_chunks());
@@ -109,6 +115,32 @@ void ProcessBlob(
   }
 }
 
+} // namespace
+
+void ProcessBlob(
+    Blob* blob,
+    const BlobProto& proto,
+    std::unordered_map<std::string, BlobState>* blob_states_ptr,
+    const std::string& key,
+    int* loaded_blobs) {
+  ResetIfFirstChunk(blob, *blob_states_ptr, key);
+  DeserializeBlob(proto, blob);
+  UpdateBlobState(proto, blob_states_ptr, key, loaded_blobs);
+}
+
+void ProcessBlobChunks(
+    Blob* blob,
+    const std::vector<BlobProto>& protos,
+    std::unordered_map<std::string, BlobState>* blob_states_ptr,
+    const std::string& key,
+    int* loaded_blobs) {
+  ResetIfFirstChunk(blob, *blob_states_ptr, key);
+  DeserializeBlobChunks(protos, blob);
+  for (const auto& proto : protos) {
+    UpdateBlobState(proto, blob_states_ptr, key, loaded_blobs);
+  }
+}
+
 void validateBlobStates(
     const std::unordered_map<std::string, BlobState>& blob_states) {
   for (const auto& iter : blob_states) {
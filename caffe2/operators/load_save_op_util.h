@@ -4,6 +4,7 @@
 #include <set>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "caffe2/core/blob.h"
 #include "caffe2/core/blob_serialization.h"
@@ -40,6 +41,15 @@ CAFFE2_API void ProcessBlob(
     const std::string& key,
     int* loaded_blobs);
 
+// Like ProcessBlob, for consecutive chunks of the same blob, the chunks of a
+// tensor being deserialized concurrently.
+CAFFE2_API void ProcessBlobChunks(
+    Blob* blob,
+    const std::vector<BlobProto>& protos,
+    std::unordered_map<std::string, BlobState>* blob_states_ptr,
+    const std::string& key,
+    int* loaded_blobs);
+
 CAFFE2_API void validateBlobStates(
     const std::unordered_map<std::string, BlobState>& blob_states);
 
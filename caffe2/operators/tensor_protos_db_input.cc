@@ -14,7 +14,9 @@ will be grouped into batches of the given size. The DB Reader is provided as
 input to the operator and it returns as many output tensors as the size of the
 TensorProtos object. Each output will simply be a tensor containing a batch of
 data with size specified by the 'batch_size' argument containing data from the
-corresponding index in the TensorProtos objects in the DB.
+corresponding index in the TensorProtos objects in the DB. The values can also
+be raw tensor records (see db::SerializeRawTensorRecord), which are copied into
+the batches without being decoded as protobufs.
 )DOC")
   .Arg("batch_size", "(int, default 0) the number of samples in a batch. The "
        "default value of 0 means that the operator will attempt to insert the "
@@ -29,6 +29,8 @@ class TensorProtosDBInput final : public PrefetchOperator<Context> {
   bool shape_inferred_ = false;
   string key_;
   string value_;
+  vector<string> keys_;
+  vector<string> values_;
 };
 
 template <class Context>
@@ -48,6 +50,21 @@ bool TensorProtosDBInput<Context>::Prefetch() {
     // We do not need to construct a batch. As a result, we will simply
     // deserialize everything into the target prefetched blob.
     reader.Read(&key_, &value_);
+    if (db::IsRawTensorRecord(value_)) {
+      const auto tensors = db::ParseRawTensorRecord(value_);
+      CAFFE_ENFORCE(tensors.size() == OutputSize());
+      for (int i = 0; i < tensors.size(); ++i) {
+        Tensor* dst = BlobGetMutableTensor(
+            &prefetched_blobs_[i],
+            tensors[i].dims,
+            at::dtype(tensors[i].dtype).device(CPU));
+        memcpy(
+            dst->raw_mutable_data(tensors[i].dtype),
+            tensors[i].data,
+            tensors[i].nbytes);
+      }
+      return true;
+    }
     TensorProtos protos;
     CAFFE_ENFORCE(protos.ParseFromString(value_));
     CAFFE_ENFORCE(protos.protos_size() == OutputSize());
@@ -62,10 +79,31 @@ bool TensorProtosDBInput<Context>::Prefetch() {
       //     CPU));
     }
   } else {
+    reader.ReadBatch(batch_size_, &keys_, &values_);
     for (int item_id = 0; item_id < batch_size_; ++item_id) {
-      reader.Read(&key_, &value_);
+      const auto& value = values_[item_id];
+      if (db::IsRawTensorRecord(value)) {
+        // The items are copied straight from the records into the batch.
+        const auto tensors = db::ParseRawTensorRecord(value);
+        CAFFE_ENFORCE(tensors.size() == OutputSize());
+        for (int i = 0; i < tensors.size(); ++i) {
+          vector<int64_t> dims(tensors[i].dims);
+          dims.insert(dims.begin(), batch_size_);
+          Tensor* dst = BlobGetMutableTensor(
+              &prefetched_blobs_[i],
+              dims,
+              at::dtype(tensors[i].dtype).device(CPU));
+          DCHECK_EQ(tensors[i].nbytes * batch_size_, dst->nbytes());
+          memcpy(
+              static_cast<char*>(dst->raw_mutable_data(tensors[i].dtype)) +
+                  tensors[i].nbytes * item_id,
+              tensors[i].data,
+              tensors[i].nbytes);
+        }
+        continue;
+      }
       TensorProtos protos;
-      CAFFE_ENFORCE(protos.ParseFromString(value_));
+      CAFFE_ENFORCE(protos.ParseFromString(value));
       CAFFE_ENFORCE(protos.protos_size() == OutputSize());
       // Note: shape_inferred_ is ignored, we'll always get dimensions from
       // proto
@@ -2,6 +2,7 @@
 #include "caffe2/core/logging.h"
 #include "caffe2/opt/converter.h"
 #include "caffe2/opt/passes.h"
+#include "caffe2/utils/proto_utils.h"
 
 namespace caffe2 {
 namespace opt {
@@ -121,5 +122,173 @@ void fuseConvBN(nom::repr::NNModule* nn, caffe2::Workspace* ws) {
 
 REGISTER_WS_OPT_PASS_FROM_FUNC(FuseConvBN, fuseConvBN);
 
+namespace {
+
+// The OperatorDef of an operator node that runs on CPU with the default
+// engine, which the operators fused below support, or nullptr.
+const caffe2::OperatorDef* getFusibleOperatorDef(repr::NNGraph::NodeRef node) {
+  NOM_REQUIRE_OR_RET_NULL(repr::nn::is<repr::NeuralNetOperator>(node));
+  auto annotation =
+      repr::nn::get<repr::NeuralNetOperator>(node)->getAnnotation();
+  NOM_REQUIRE_OR_RET_NULL(annotation && isa<Caffe2Annotation>(annotation));
+  const auto& op = dyn_cast<Caffe2Annotation>(annotation)->getOperatorDef();
+  NOM_REQUIRE_OR_RET_NULL(
+      op.device_option().device_type() == caffe2::PROTO_CPU &&
+      op.engine().empty());
+  return &op;
+}
+
+bool hasArgument(const caffe2::OperatorDef& op, const std::string& name) {
+  for (const auto& arg : op.arg()) {
+    if (arg.name() == name) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool isChainActivation(const std::string& type) {
+  return type == "Relu" || type == "Sigmoid" || type == "Tanh" ||
+      type == "Exp";
+}
+
+bool fuseActivationEpilogueHelper(repr::NNModule* nn) {
+  for (auto node : nn->dataFlow.getMutableNodes()) {
+    auto op = getFusibleOperatorDef(node);
+    NOM_REQUIRE_OR_CONT(op && (op->type() == "FC" || op->type() == "Conv"));
+    NOM_REQUIRE_OR_CONT(!hasArgument(*op, "activation"));
+
+    auto outputs = repr::nn::getOutputs(node);
+    NOM_REQUIRE_OR_CONT(outputs.size() == 1);
+    auto output = outputs.front();
+    NOM_REQUIRE_OR_CONT(!nn->outputs.count(output));
+
+    auto consumers = repr::nn::getConsumers(output);
+    NOM_REQUIRE_OR_CONT(consumers.size() == 1);
+    auto actNode = consumers.front();
+    auto act = getFusibleOperatorDef(actNode);
+    NOM_REQUIRE_OR_CONT(act);
+    if (op->type() == "FC") {
+      NOM_REQUIRE_OR_CONT(
+          act->type() == "Relu" || act->type() == "Sigmoid" ||
+          act->type() == "Tanh");
+    } else {
+      NOM_REQUIRE_OR_CONT(act->type() == "Relu");
+    }
+    auto actOutputs = repr::nn::getOutputs(actNode);
+    NOM_REQUIRE_OR_CONT(actOutputs.size() == 1);
+    auto actOutput = actOutputs.front();
+
+    // FC and Conv cannot be in-place.
+    const auto& actOutputName =
+        repr::nn::get<repr::NeuralNetData>(actOutput)->getName();
+    bool inplace = false;
+    for (auto input : repr::nn::getInputs(node)) {
+      if (repr::nn::get<repr::NeuralNetData>(input)->getName() ==
+          actOutputName) {
+        inplace = true;
+      }
+    }
+    NOM_REQUIRE_OR_CONT(!inplace);
+
+    const auto activation = act->type();
+    nn->dataFlow.deleteNode(output);
+    nn->dataFlow.deleteNode(actNode);
+    nn->dataFlow.createEdge(node, actOutput);
+
+    auto annotation = dyn_cast<Caffe2Annotation>(
+        repr::nn::get<repr::NeuralNetOperator>(node)->getMutableAnnotation());
+    auto* arg = annotation->getMutableOperatorDef()->add_arg();
+    arg->set_name("activation");
+    arg->set_s(activation);
+    return true;
+  }
+  return false;
+}
+
+bool fuseElementwiseChainHelper(repr::NNModule* nn) {
+  for (auto bbNode : nn->controlFlow.getMutableNodes()) {
+    // Copied, as fusing deletes instructions.
+    const auto instructions = bbNode->data().getInstructions();
+    for (size_t i = 0; i < instructions.size(); ++i) {
+      auto first = instructions[i];
+      auto firstOp = getFusibleOperatorDef(first);
+      NOM_REQUIRE_OR_CONT(firstOp && isChainActivation(firstOp->type()));
+      NOM_REQUIRE_OR_CONT(
+          repr::nn::getInputs(first).size() == 1 &&
+          repr::nn::getOutputs(first).size() == 1);
+
+      std::vector<std::string> types = {firstOp->type()};
+      std::vector<repr::NNGraph::NodeRef> intermediates;
+      std::vector<repr::NNGraph::NodeRef> fused;
+      std::vector<repr::NNGraph::NodeRef> operands;
+      auto output = repr::nn::getOutputs(first).front();
+      for (size_t j = i + 1; j < instructions.size(); ++j) {
+        NOM_REQUIRE_OR_BREAK(!nn->outputs.count(output));
+        auto consumers = repr::nn::getConsumers(output);
+        NOM_REQUIRE_OR_BREAK(
+            consumers.size() == 1 && consumers.front() == instructions[j]);
+
+        auto next = instructions[j];
+        auto nextOp = getFusibleOperatorDef(next);
+        NOM_REQUIRE_OR_BREAK(nextOp);
+        auto nextOutputs = repr::nn::getOutputs(next);
+        NOM_REQUIRE_OR_BREAK(nextOutputs.size() == 1);
+        auto inputs = repr::nn::getInputs(next);
+        if (isChainActivation(nextOp->type())) {
+          NOM_REQUIRE_OR_BREAK(inputs.size() == 1);
+        } else if (nextOp->type() == "Add" || nextOp->type() == "Mul") {
+          // The legacy broadcast of the "broadcast" argument isn't supported.
+          NOM_REQUIRE_OR_BREAK(
+              inputs.size() == 2 && !hasArgument(*nextOp, "broadcast"));
+          operands.push_back(inputs[0] == output ? inputs[1] : inputs[0]);
+        } else {
+          break;
+        }
+        types.push_back(nextOp->type());
+        intermediates.push_back(output);
+        fused.push_back(next);
+        output = nextOutputs.front();
+      }
+      NOM_REQUIRE_OR_CONT(!fused.empty());
+
+      caffe2::OperatorDef chainOp;
+      chainOp.set_type("ElementwiseChain");
+      chainOp.set_name(firstOp->name());
+      chainOp.mutable_device_option()->CopyFrom(firstOp->device_option());
+      chainOp.add_arg()->CopyFrom(MakeArgument("ops", types));
+
+      for (auto node : intermediates) {
+        nn->dataFlow.deleteNode(node);
+      }
+      for (auto node : fused) {
+        nn->dataFlow.deleteNode(node);
+      }
+      for (auto operand : operands) {
+        nn->dataFlow.createEdge(operand, first);
+      }
+      nn->dataFlow.createEdge(first, output);
+      first->resetData(convertToNeuralNetOperator(chainOp));
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+void fuseActivationEpilogues(repr::NNModule* nn) {
+  while (fuseActivationEpilogueHelper(nn)) {
+  }
+}
+
+void fuseElementwiseChains(repr::NNModule* nn) {
+  while (fuseElementwiseChainHelper(nn)) {
+  }
+}
+
+REGISTER_OPT_PASS_FROM_FUNC(FuseActivationEpilogues, fuseActivationEpilogues);
+REGISTER_OPT_PASS_FROM_FUNC(FuseElementwiseChains, fuseElementwiseChains);
+
 } // namespace opt
 } // namespace caffe2
@@ -27,6 +27,17 @@ using namespace nom;
 
 CAFFE2_API void fuseConvBN(repr::NNModule* nn, caffe2::Workspace* ws);
 
+// Folds the Relu, Sigmoid or Tanh consuming the output of an FC, and the Relu
+// consuming that of a Conv, into the "activation" argument of the operator.
+// Only CPU operators of the default engine are fused.
+CAFFE2_API void fuseActivationEpilogues(repr::NNModule* nn);
+
+// Replaces the chains of consecutive elementwise CPU operators, a Relu,
+// Sigmoid, Tanh or Exp followed by any of these and of Add and Mul, whose
+// intermediate results are only used by the next operator of the chain, with
+// an ElementwiseChain operator.
+CAFFE2_API void fuseElementwiseChains(repr::NNModule* nn);
+
 // Generic activation fusion helper.
 //
 // \tparam OperationT The operator to be fused.
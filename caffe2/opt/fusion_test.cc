@@ -0,0 +1,185 @@
+#include "caffe2/core/common.h"
+#include "caffe2/core/workspace.h"
+#include "caffe2/opt/converter.h"
+#include "caffe2/opt/passes.h"
+#include "caffe2/utils/proto_utils.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+caffe2::OperatorDef* addOp(
+    caffe2::NetDef* net,
+    const std::string& type,
+    const std::vector<std::string>& inputs,
+    const std::string& output) {
+  auto* def = net->add_op();
+  def->set_type(type);
+  for (const auto& input : inputs) {
+    def->add_input(input);
+  }
+  def->add_output(output);
+  return def;
+}
+
+caffe2::NetDef runPass(
+    const std::string& pass_name,
+    const caffe2::NetDef& net) {
+  auto nn = caffe2::convertToNNModule(net);
+  auto pass = caffe2::OptimizationPassRegistry()->Create(pass_name, &nn);
+  pass->run();
+  return caffe2::convertToCaffe2Proto(nn, net);
+}
+
+void fillInput(
+    caffe2::Workspace* ws,
+    const std::string& name,
+    const std::vector<int64_t>& dims) {
+  auto* tensor = BlobGetMutableTensor(ws->CreateBlob(name), caffe2::CPU);
+  tensor->Resize(dims);
+  float* data = tensor->mutable_data<float>();
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = static_cast<float>((i * 7) % 11) / 5.0f - 1.0f;
+  }
+}
+
+// Runs both nets on the same inputs and compares their output.
+void expectSameOutput(
+    const caffe2::NetDef& net,
+    const caffe2::NetDef& optimized_net,
+    const std::vector<std::pair<std::string, std::vector<int64_t>>>& inputs,
+    const std::string& output) {
+  caffe2::Workspace ws;
+  caffe2::Workspace optimized_ws;
+  for (const auto& input : inputs) {
+    fillInput(&ws, input.first, input.second);
+    fillInput(&optimized_ws, input.first, input.second);
+  }
+  ASSERT_TRUE(ws.RunNetOnce(net));
+  ASSERT_TRUE(optimized_ws.RunNetOnce(optimized_net));
+  const auto& Y = ws.GetBlob(output)->Get<caffe2::TensorCPU>();
+  const auto& optimized_Y =
+      optimized_ws.GetBlob(output)->Get<caffe2::TensorCPU>();
+  ASSERT_EQ(Y.sizes(), optimized_Y.sizes());
+  for (int64_t i = 0; i < Y.numel(); ++i) {
+    EXPECT_NEAR(Y.data<float>()[i], optimized_Y.data<float>()[i], 1e-5);
+  }
+}
+
+} // namespace
+
+TEST(FusionTest, FCActivation) {
+  for (const std::string activation : {"Relu", "Sigmoid", "Tanh"}) {
+    caffe2::NetDef net;
+    addOp(&net, "FC", {"X", "W", "b"}, "Y");
+    addOp(&net, activation, {"Y"}, "Z");
+    net.add_external_input("X");
+    net.add_external_input("W");
+    net.add_external_input("b");
+    net.add_external_output("Z");
+
+    auto optimized_net = runPass("FuseActivationEpilogues", net);
+    ASSERT_EQ(optimized_net.op().size(), 1);
+    const auto& op = optimized_net.op(0);
+    EXPECT_EQ(op.type(), "FC");
+    EXPECT_EQ(op.output(0), "Z");
+    caffe2::ArgumentHelper helper(op);
+    EXPECT_EQ(
+        helper.GetSingleArgument<std::string>("activation", ""), activation);
+
+    expectSameOutput(
+        net, optimized_net, {{"X", {5, 3}}, {"W", {4, 3}}, {"b", {4}}}, "Z");
+  }
+}
+
+TEST(FusionTest, FCExternalOutputNotFused) {
+  caffe2::NetDef net;
+  addOp(&net, "FC", {"X", "W", "b"}, "Y");
+  addOp(&net, "Relu", {"Y"}, "Z");
+  net.add_external_output("Y");
+  net.add_external_output("Z");
+
+  auto optimized_net = runPass("FuseActivationEpilogues", net);
+  EXPECT_EQ(optimized_net.op().size(), 2);
+}
+
+TEST(FusionTest, ConvRelu) {
+  caffe2::NetDef net;
+  auto* conv = addOp(&net, "Conv", {"X", "W", "b"}, "Y");
+  conv->add_arg()->CopyFrom(caffe2::MakeArgument<int>("kernel", 3));
+  addOp(&net, "Relu", {"Y"}, "Z");
+  net.add_external_output("Z");
+
+  auto optimized_net = runPass("FuseActivationEpilogues", net);
+  ASSERT_EQ(optimized_net.op().size(), 1);
+  caffe2::ArgumentHelper helper(optimized_net.op(0));
+  EXPECT_EQ(helper.GetSingleArgument<std::string>("activation", ""), "Relu");
+
+  expectSameOutput(
+      net,
+      optimized_net,
+      {{"X", {2, 3, 6, 6}}, {"W", {4, 3, 3, 3}}, {"b", {4}}},
+      "Z");
+}
+
+TEST(FusionTest, ConvOnlyFusesRelu) {
+  caffe2::NetDef net;
+  auto* conv = addOp(&net, "Conv", {"X", "W", "b"}, "Y");
+  conv->add_arg()->CopyFrom(caffe2::MakeArgument<int>("kernel", 3));
+  addOp(&net, "Sigmoid", {"Y"}, "Z");
+  net.add_external_output("Z");
+
+  auto optimized_net = runPass("FuseActivationEpilogues", net);
+  EXPECT_EQ(optimized_net.op().size(), 2);
+}
+
+TEST(FusionTest, ElementwiseChain) {
+  caffe2::NetDef net;
+  addOp(&net, "Sigmoid", {"X"}, "A");
+  addOp(&net, "Mul", {"A", "S"}, "B");
+  addOp(&net, "Relu", {"B"}, "C");
+  addOp(&net, "Add", {"T", "C"}, "D");
+  net.add_external_input("X");
+  net.add_external_input("S");
+  net.add_external_input("T");
+  net.add_external_output("D");
+
+  auto optimized_net = runPass("FuseElementwiseChains", net);
+  ASSERT_EQ(optimized_net.op().size(), 1);
+  const auto& op = optimized_net.op(0);
+  EXPECT_EQ(op.type(), "ElementwiseChain");
+  ASSERT_EQ(op.input().size(), 3);
+  EXPECT_EQ(op.input(0), "X");
+  EXPECT_EQ(op.input(1), "S");
+  EXPECT_EQ(op.input(2), "T");
+  EXPECT_EQ(op.output(0), "D");
+  caffe2::ArgumentHelper helper(op);
+  EXPECT_EQ(
+      helper.GetRepeatedArgument<std::string>("ops"),
+      std::vector<std::string>({"Sigmoid", "Mul", "Relu", "Add"}));
+
+  // Operands repeating over the leading dimensions of X, and one that
+  // broadcasts X to a larger shape.
+  expectSameOutput(
+      net,
+      optimized_net,
+      {{"X", {3, 1500}}, {"S", {1500}}, {"T", {1}}},
+      "D");
+  expectSameOutput(
+      net, optimized_net, {{"X", {3, 4}}, {"S", {2, 3, 1}}, {"T", {4}}}, "D");
+}
+
+TEST(FusionTest, ElementwiseChainStopsAtSharedIntermediate) {
+  caffe2::NetDef net;
+  addOp(&net, "Relu", {"X"}, "A");
+  addOp(&net, "Mul", {"A", "A"}, "B");
+  addOp(&net, "Tanh", {"B"}, "C");
+  addOp(&net, "Exp", {"C"}, "D");
+  net.add_external_output("D");
+
+  auto optimized_net = runPass("FuseElementwiseChains", net);
+  ASSERT_EQ(optimized_net.op().size(), 3);
+  EXPECT_EQ(optimized_net.op(0).type(), "Relu");
+  EXPECT_EQ(optimized_net.op(1).type(), "Mul");
+  EXPECT_EQ(optimized_net.op(2).type(), "ElementwiseChain");
+}
@@ -24,6 +24,8 @@ void graphOptimzations(nom::repr::NNModule* nn, int level) {
       opt::addNNPACK(nn, false);
       opt::fuseNNPACKConvRelu(nn);
 #endif
+      opt::fuseActivationEpilogues(nn);
+      opt::fuseElementwiseChains(nn);
     case 0:
     default:
       break;
@@ -32,8 +34,10 @@ void graphOptimzations(nom::repr::NNModule* nn, int level) {
 
 NetDef optimize(NetDef net, Workspace* ws, int level) {
   auto nn = convertToNNModule(net);
-  graphOptimzations(&nn, level);
+  // Conv + BatchNormalization + Relu is Conv + Relu once the batch norm is
+  // folded, which the graph optimizations fuse.
   workspaceOptimizations(&nn, ws, level);
+  graphOptimzations(&nn, level);
   return convertToCaffe2Proto(nn, net);
 }
 
@@ -1,6 +1,8 @@
 #include "caffe2/predictor/predictor.h"
+#include <set>
 #include <unordered_set>
 #include "caffe2/core/init.h"
+#include "caffe2/core/memonger.h"
 
 namespace caffe2 {
 
@@ -27,6 +29,31 @@ const Tensor& getTensor(Workspace* ws, const std::string& name) {
 
 } // namespace
 
+// Lends the workspace a run executes in: an activation arena that goes back
+// to the Predictor at the end of the run, or the workspace of the Predictor.
+class Predictor::WorkspaceLease {
+ public:
+  explicit WorkspaceLease(Predictor* predictor) : predictor_(predictor) {
+    if (predictor_->config_.use_activation_arenas) {
+      arena_ = predictor_->acquireArena();
+    }
+  }
+
+  ~WorkspaceLease() {
+    if (arena_) {
+      predictor_->releaseArena(std::move(arena_));
+    }
+  }
+
+  Workspace* get() const {
+    return arena_ ? arena_.get() : predictor_->config_.ws.get();
+  }
+
+ private:
+  Predictor* predictor_;
+  std::unique_ptr<Workspace> arena_;
+};
+
 Predictor::Predictor(
     const NetDef& init_net,
     const NetDef& run_net,
@@ -44,6 +71,24 @@ Predictor::Predictor(PredictorConfig config) : config_(std::move(config)) {
   const auto& initialized_vec = config_.ws->Blobs();
   const std::unordered_set<std::string> initialized{initialized_vec.begin(),
                                                     initialized_vec.end()};
+  if (config_.use_activation_arenas) {
+    // Everything but the intermediate blobs outlives a run, or is shared by
+    // the runs.
+    std::set<std::string> static_blobs{initialized.begin(), initialized.end()};
+    const auto& net = *config_.predict_net;
+    static_blobs.insert(
+        net.external_input().begin(), net.external_input().end());
+    static_blobs.insert(
+        net.external_output().begin(), net.external_output().end());
+    static_blobs.insert(config_.input_names.begin(), config_.input_names.end());
+    static_blobs.insert(
+        config_.output_names.begin(), config_.output_names.end());
+    config_.predict_net = std::make_shared<NetDef>(
+        memonger::optimize_inference_net(net, static_blobs));
+    // Creating the net checks it, and the first arena gets reused.
+    releaseArena(acquireArena());
+    return;
+  }
   for (const auto& name : config_.predict_net->external_input()) {
     if (!initialized.count(name)) {
       auto* blob = config_.ws->CreateBlob(name);
@@ -53,30 +98,91 @@ Predictor::Predictor(PredictorConfig config) : config_(std::move(config)) {
   CAFFE_ENFORCE(config_.ws->CreateNet(config_.predict_net));
 }
 
+size_t Predictor::num_activation_arenas() const {
+  std::lock_guard<std::mutex> guard(arenas_mutex_);
+  return num_arenas_;
+}
+
+std::unique_ptr<Workspace> Predictor::acquireArena() {
+  {
+    std::lock_guard<std::mutex> guard(arenas_mutex_);
+    if (!free_arenas_.empty()) {
+      auto arena = std::move(free_arenas_.back());
+      free_arenas_.pop_back();
+      return arena;
+    }
+  }
+  auto arena = caffe2::make_unique<Workspace>(config_.ws.get());
+  // The inputs set by the runs must be local to the arena, and exist before
+  // the net is created for its operators to see them.
+  for (const auto& name : config_.predict_net->external_input()) {
+    if (!config_.ws->HasBlob(name)) {
+      BlobGetMutableTensor(arena->CreateLocalBlob(name), CPU);
+    }
+  }
+  for (const auto& name : config_.input_names) {
+    BlobGetMutableTensor(arena->CreateLocalBlob(name), CPU);
+  }
+  CAFFE_ENFORCE(arena->CreateNet(config_.predict_net));
+  std::lock_guard<std::mutex> guard(arenas_mutex_);
+  ++num_arenas_;
+  return arena;
+}
+
+void Predictor::releaseArena(std::unique_ptr<Workspace> arena) {
+  std::lock_guard<std::mutex> guard(arenas_mutex_);
+  free_arenas_.push_back(std::move(arena));
+}
+
+Blob* Predictor::getInputBlob(Workspace* ws, const std::string& name) {
+  auto* blob = getBlob(ws, name);
+  CAFFE_ENFORCE(
+      ws == config_.ws.get() || !config_.ws->HasBlob(name) ||
+          blob != config_.ws->GetBlob(name),
+      "Input ",
+      name,
+      " is a blob of the parameter workspace; "
+      "list it in the input names of the PredictorConfig.");
+  return blob;
+}
+
+TensorCPU Predictor::getOutput(Workspace* ws, const std::string& name) {
+  if (ws == config_.ws.get()) {
+    return getTensor(ws, name).UnsafeSharedInstance();
+  }
+  // The arena goes to another run next, so the output is handed over to the
+  // caller, and the next run of the arena allocates a new one.
+  auto* blob = getBlob(ws, name);
+  auto output = BlobGetMutableTensor(blob, CPU)->UnsafeSharedInstance();
+  blob->Reset();
+  return output;
+}
+
 bool Predictor::operator()(const TensorList& inputs, TensorList* outputs) {
   CAFFE_ENFORCE(
       inputs.size() <=
       static_cast<unsigned>(config_.predict_net->external_input_size()));
+  WorkspaceLease lease(this);
+  auto* ws = lease.get();
   for (size_t i = 0; i < inputs.size(); ++i) {
     // This is evil and shares the same underlying tensor
     BlobSetTensor(
-        getBlob(config_.ws.get(), config_.predict_net->external_input(i)),
+        getInputBlob(ws, config_.predict_net->external_input(i)),
         inputs[i].UnsafeSharedInstance());
   }
 
-  if (!config_.ws->RunNet(config_.predict_net->name())) {
+  if (!ws->RunNet(config_.predict_net->name())) {
     return false;
   }
   outputs->clear();
   for (size_t i = 0; i < config_.predict_net->external_output_size(); ++i) {
     outputs->emplace_back(
-        getTensor(config_.ws.get(), config_.predict_net->external_output(i))
-            .UnsafeSharedInstance());
+        getOutput(ws, config_.predict_net->external_output(i)));
   }
   return true;
 }
 
-bool Predictor::run_map_workspace(const TensorMap& inputs) {
+bool Predictor::run_map_workspace(Workspace* ws, const TensorMap& inputs) {
   if (!config_.input_names.empty()) {
     CAFFE_ENFORCE_EQ(inputs.size(), input_names().size());
   }
@@ -90,35 +196,34 @@ bool Predictor::run_map_workspace(const TensorMap& inputs) {
     }
     // This is evil and shares the same underlying tensor
     BlobSetTensor(
-        getBlob(config_.ws.get(), input.first),
-        input.second.UnsafeSharedInstance());
+        getInputBlob(ws, input.first), input.second.UnsafeSharedInstance());
   }
 
-  return config_.ws->RunNet(config_.predict_net->name());
+  return ws->RunNet(config_.predict_net->name());
 }
 
 bool Predictor::operator()(const TensorMap& inputs, TensorList* outputs) {
-  if (!run_map_workspace(inputs)) {
+  WorkspaceLease lease(this);
+  auto* ws = lease.get();
+  if (!run_map_workspace(ws, inputs)) {
     return false;
   }
   outputs->clear();
   for (size_t i = 0; i < config_.predict_net->external_output_size(); ++i) {
-    outputs->push_back(
-        getTensor(config_.ws.get(), config_.predict_net->external_output(i))
-            .UnsafeSharedInstance());
+    outputs->push_back(getOutput(ws, config_.predict_net->external_output(i)));
   }
   return true;
 }
 
 bool Predictor::operator()(const TensorMap& inputs, TensorMap* outputs) {
-  if (!run_map_workspace(inputs)) {
+  WorkspaceLease lease(this);
+  auto* ws = lease.get();
+  if (!run_map_workspace(ws, inputs)) {
     return false;
   }
 
   for (const std::string& outputName : output_names()) {
-    outputs->emplace(
-        outputName,
-        getTensor(config_.ws.get(), outputName).UnsafeSharedInstance());
+    outputs->emplace(outputName, getOutput(ws, outputName));
   }
   return true;
 }
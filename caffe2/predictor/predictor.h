@@ -1,5 +1,6 @@
 #pragma once
 
+#include <mutex>
 #include <unordered_set>
 #include "caffe2/core/net.h"
 #include "caffe2/core/tensor.h"
@@ -34,7 +35,8 @@ class CAFFE2_API Predictor {
   //   outputs->size() == run_net.external_inputs.size()
 
   // NOTE: output is a part of thread local workspace
-  // and is only valid until the next predictor execution.
+  // and is only valid until the next predictor execution,
+  // unless config().use_activation_arenas is set.
 
   // Returns true on success
   virtual bool operator()(const TensorList& inputs, TensorList* outputs);
@@ -50,6 +52,7 @@ class CAFFE2_API Predictor {
     return *config_.predict_net;
   };
 
+  // The workspace of the parameters when activation arenas are used.
   Workspace* ws() {
     return config_.ws.get();
   };
@@ -62,8 +65,26 @@ class CAFFE2_API Predictor {
     return config_.output_names;
   }
 
+  const PredictorConfig& config() const {
+    return config_;
+  }
+
+  // The number of activation arenas created so far.
+  size_t num_activation_arenas() const;
+
  private:
-  bool run_map_workspace(const TensorMap& inputs);
+  class WorkspaceLease;
+
+  bool run_map_workspace(Workspace* ws, const TensorMap& inputs);
+  Blob* getInputBlob(Workspace* ws, const std::string& name);
+  TensorCPU getOutput(Workspace* ws, const std::string& name);
+
+  std::unique_ptr<Workspace> acquireArena();
+  void releaseArena(std::unique_ptr<Workspace> arena);
+
+  mutable std::mutex arenas_mutex_;
+  std::vector<std::unique_ptr<Workspace>> free_arenas_;
+  size_t num_arenas_{0};
 
  protected:
   PredictorConfig config_;
@@ -39,6 +39,16 @@ struct CAFFE2_API PredictorConfig {
   // tensor. Once tensor support intrusive_ptr, we'll get rid of this and use
   // parameters to construct Workspace
   std::shared_ptr<Workspace> ws;
+
+  // If set, `ws` only holds the parameters, which the runs share, and each
+  // concurrent run of the Predictor uses an activation arena of its own: a
+  // child workspace of `ws` holding the inputs and the intermediate blobs of
+  // `predict_net`. Arenas are recycled across runs and threads, so that there
+  // are only as many of them as there have been concurrent runs; the outputs
+  // are then owned by the caller rather than the Predictor. The intermediate
+  // blobs of simple nets also share their memory when their lifetimes don't
+  // overlap (see memonger::optimize_inference_net).
+  bool use_activation_arenas{false};
 };
 
 CAFFE2_API Workspace makeWorkspace(std::shared_ptr<PredictorParameters> parameters);
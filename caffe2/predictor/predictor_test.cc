@@ -6,6 +6,8 @@
 
 #include <gtest/gtest.h>
 
+#include <thread>
+
 namespace caffe2 {
 
 namespace {
@@ -26,6 +28,37 @@ const char* predictSpec = R"DOC(
         }
 )DOC";
 
+const char* simplePredictSpec = R"DOC(
+        name: "predict"
+        type: "simple"
+        external_input: "data"
+        external_input: "W"
+        external_input: "b"
+        external_output: "y"
+        op {
+          input: "data"
+          input: "W"
+          input: "b"
+          output: "h1"
+          type: "FC"
+        }
+        op {
+          input: "h1"
+          output: "h2"
+          type: "Relu"
+        }
+        op {
+          input: "h2"
+          output: "h3"
+          type: "Relu"
+        }
+        op {
+          input: "h3"
+          output: "y"
+          type: "Relu"
+        }
+)DOC";
+
 const char* initSpec = R"DOC(
         name: "init"
         type: "dag"
@@ -205,4 +238,78 @@ TEST_F(PredictorTest, SimpleBatchSizedMapInput) {
   EXPECT_NEAR(output.front().data<float>()[4], 0.1209, 1E-4);
 }
 
+TEST_F(PredictorTest, ActivationArenas) {
+  auto config =
+      makePredictorConfig(parseNetDef(initSpec), parseNetDef(predictSpec));
+  config.use_activation_arenas = true;
+  Predictor p(config);
+  EXPECT_EQ(p.num_activation_arenas(), 1);
+
+  constexpr int kThreads = 4;
+  std::vector<std::unique_ptr<Blob>> inputData;
+  std::vector<Predictor::TensorList> expected(kThreads);
+  for (int i = 0; i < kThreads; ++i) {
+    inputData.push_back(randomTensor({i + 1, 4}, ctx_.get()));
+    Predictor::TensorList input;
+    input.emplace_back(BlobGetMutableTensor(inputData[i].get(), CPU)->Alias());
+    Predictor::TensorList output;
+    (*p_)(input, &output);
+    expected[i].emplace_back(output.front().Clone());
+  }
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    threads.emplace_back([&, i]() {
+      Predictor::TensorList input;
+      input.emplace_back(
+          BlobGetMutableTensor(inputData[i].get(), CPU)->Alias());
+      std::vector<Predictor::TensorList> outputs(10);
+      for (auto& output : outputs) {
+        EXPECT_TRUE(p(input, &output));
+      }
+      // The outputs are owned by the caller, and stay valid across runs.
+      for (const auto& output : outputs) {
+        ASSERT_EQ(output.size(), 1);
+        ASSERT_EQ(output.front().sizes(), expected[i].front().sizes());
+        for (int64_t j = 0; j < output.front().numel(); ++j) {
+          EXPECT_EQ(
+              output.front().data<float>()[j],
+              expected[i].front().data<float>()[j]);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_LE(p.num_activation_arenas(), kThreads);
+  // The parameters live in the shared workspace only.
+  EXPECT_TRUE(p.ws()->HasBlob("W"));
+  EXPECT_FALSE(p.ws()->HasBlob("y"));
+}
+
+TEST_F(PredictorTest, ActivationArenasShareBlobs) {
+  Predictor reference(makePredictorConfig(
+      parseNetDef(initSpec), parseNetDef(simplePredictSpec)));
+  auto config = makePredictorConfig(
+      parseNetDef(initSpec), parseNetDef(simplePredictSpec));
+  config.use_activation_arenas = true;
+  Predictor p(config);
+  // h3 is computed once h1 is dead, and takes its place.
+  EXPECT_EQ(p.def().op(0).output(0), p.def().op(2).output(0));
+  EXPECT_EQ(p.def().op(3).output(0), "y");
+
+  auto inputData = randomTensor({2, 4}, ctx_.get());
+  Predictor::TensorList input;
+  input.emplace_back(BlobGetMutableTensor(inputData.get(), CPU)->Alias());
+  Predictor::TensorList output;
+  reference(input, &output);
+  auto expected = output.front().Clone();
+  EXPECT_TRUE(p(input, &output));
+  ASSERT_EQ(output.front().sizes(), expected.sizes());
+  for (int64_t i = 0; i < expected.numel(); ++i) {
+    EXPECT_EQ(output.front().data<float>()[i], expected.data<float>()[i]);
+  }
+}
+
 } // namespace caffe2
@@ -1,10 +1,20 @@
 #include "caffe2/serialize/file_adapter.h"
 #include <c10/util/Exception.h>
+#include <cerrno>
+#include <cstring>
 #include "caffe2/core/common.h"
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace caffe2 {
 namespace serialize {
 
+#ifdef _WIN32
+
 FileAdapter::FileAdapter(const std::string& file_name) {
   file_stream_.open(file_name, std::ifstream::in | std::ifstream::binary);
   if (!file_stream_) {
@@ -22,7 +32,63 @@ size_t FileAdapter::read(uint64_t pos, void* buf, size_t n, const char* what)
   return istream_adapter_->read(pos, buf, n, what);
 }
 
+bool FileAdapter::concurrentReads() const {
+  return false;
+}
+
 FileAdapter::~FileAdapter() {}
 
+#else
+
+FileAdapter::FileAdapter(const std::string& file_name) {
+  fd_ = open(file_name.c_str(), O_RDONLY);
+  if (fd_ == -1) {
+    AT_ERROR("open file failed, file path: ", file_name);
+  }
+  struct stat file_stat;
+  if (fstat(fd_, &file_stat) == -1) {
+    close(fd_);
+    AT_ERROR("stat file failed, file path: ", file_name);
+  }
+  size_ = file_stat.st_size;
+}
+
+size_t FileAdapter::size() const {
+  return size_;
+}
+
+size_t FileAdapter::read(uint64_t pos, void* buf, size_t n, const char* what)
+    const {
+  // Like the stream reads, the reads must get all the requested bytes.
+  size_t done = 0;
+  while (done < n) {
+    ssize_t ret =
+        pread(fd_, static_cast<char*>(buf) + done, n - done, pos + done);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret <= 0) {
+      AT_ERROR(
+          "file reader failed: ",
+          what,
+          ": ",
+          ret < 0 ? strerror(errno) : "unexpected end of file",
+          ".");
+    }
+    done += ret;
+  }
+  return n;
+}
+
+bool FileAdapter::concurrentReads() const {
+  return true;
+}
+
+FileAdapter::~FileAdapter() {
+  close(fd_);
+}
+
+#endif
+
 } // namespace serialize
 } // namespace caffe2
@@ -5,6 +5,10 @@
 #include <ostream>
 #include <fstream>
 #include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 #include <c10/core/Allocator.h>
 #include <c10/core/CPUAllocator.h>
@@ -76,6 +80,7 @@ void PyTorchStreamReader::init() {
   memset(ar_.get(), 0, sizeof(mz_zip_archive));
 
   size_t size = in_->size();
+  mapping_ = in_->mapping();
 
   // check for the old magic number,
   constexpr size_t kMagicValueLength = 8;
@@ -150,6 +155,49 @@ constexpr int MZ_ZIP_LOCAL_DIR_HEADER_SIZE = 30;
 constexpr int MZ_ZIP_LDH_FILENAME_LEN_OFS = 26;
 constexpr int MZ_ZIP_LDH_EXTRA_LEN_OFS = 28;
 
+// The comment of the records whose bytes are shuffled, followed by the size
+// of their elements.
+constexpr const char* kShuffleComment = "byteshuffle=";
+
+// Stores the i-th bytes of all the elements, for each i, one after the other.
+static void byteShuffle(
+    const char* src,
+    char* dst,
+    size_t size,
+    size_t element_size) {
+  size_t num_elements = size / element_size;
+  for (size_t i = 0; i < num_elements; i++) {
+    for (size_t b = 0; b < element_size; b++) {
+      dst[b * num_elements + i] = src[i * element_size + b];
+    }
+  }
+}
+
+static void byteUnshuffle(
+    const char* src,
+    char* dst,
+    size_t size,
+    size_t element_size) {
+  size_t num_elements = size / element_size;
+  for (size_t i = 0; i < num_elements; i++) {
+    for (size_t b = 0; b < element_size; b++) {
+      dst[i * element_size + b] = src[b * num_elements + i];
+    }
+  }
+}
+
+// The size of the elements whose bytes were shuffled in the record, or 0 if
+// they weren't.
+static size_t shuffledElementSize(const mz_zip_archive_file_stat& stat) {
+  size_t prefix_size = strlen(kShuffleComment);
+  if (stat.m_comment_size <= prefix_size ||
+      strncmp(stat.m_comment, kShuffleComment, prefix_size) != 0) {
+    return 0;
+  }
+  return caffe2::stoull(
+      std::string(stat.m_comment + prefix_size, stat.m_comment_size - prefix_size));
+}
+
 static size_t getPadding(
     size_t cursor,
     size_t filename_size,
@@ -213,19 +261,108 @@ size_t PyTorchStreamReader::getRecordID(const std::string& name) {
   return result;
 }
 
+static void deleteMappedRecord(void* ctx) {
+  delete static_cast<std::shared_ptr<void>*>(ctx);
+}
+
 // return dataptr, size
 std::tuple<at::DataPtr, size_t> PyTorchStreamReader::getRecord(const std::string& name) {
   size_t key = getRecordID(name);
   mz_zip_archive_file_stat stat;
   mz_zip_reader_file_stat(ar_.get(), key, &stat);
   valid("retrieving file meta-data for ", name.c_str());
+  if (mapping_ && stat.m_method == 0 &&
+      stat.m_comp_size == stat.m_uncomp_size) {
+    size_t offset = getRecordOffset(name);
+    AT_ASSERTM(
+        offset + stat.m_uncomp_size <= in_->size(),
+        "record ", name, " is out of the archive");
+    void* data = static_cast<char*>(mapping_.get()) + offset;
+    return std::make_tuple(
+        at::DataPtr(
+            data,
+            new std::shared_ptr<void>(mapping_),
+            deleteMappedRecord,
+            at::DeviceType::CPU),
+        stat.m_uncomp_size);
+  }
   at::DataPtr retval = c10::GetCPUAllocator()->allocate(stat.m_uncomp_size);
   mz_zip_reader_extract_to_mem(ar_.get(), key, retval.get(), stat.m_uncomp_size, 0);
   valid("reading file ", name.c_str());
 
+  size_t element_size = shuffledElementSize(stat);
+  if (element_size > 1) {
+    at::DataPtr unshuffled =
+        c10::GetCPUAllocator()->allocate(stat.m_uncomp_size);
+    byteUnshuffle(
+        static_cast<const char*>(retval.get()),
+        static_cast<char*>(unshuffled.get()),
+        stat.m_uncomp_size,
+        element_size);
+    retval = std::move(unshuffled);
+  }
   return std::make_tuple(std::move(retval), stat.m_uncomp_size);
 }
 
+std::vector<std::tuple<at::DataPtr, size_t>> PyTorchStreamReader::getRecords(
+    const std::vector<std::string>& names,
+    size_t num_threads) {
+  std::vector<std::tuple<at::DataPtr, size_t>> records(names.size());
+  // The offsets of the records stored without compression, which are read
+  // from the source directly; miniz reads the other ones.
+  std::vector<size_t> stored;
+  std::vector<size_t> header_offsets(names.size());
+  for (size_t i = 0; i < names.size(); i++) {
+    mz_zip_archive_file_stat stat;
+    mz_zip_reader_file_stat(ar_.get(), getRecordID(names[i]), &stat);
+    valid("retrieving file meta-data for ", names[i].c_str());
+    if (mapping_ || !in_->concurrentReads() || num_threads <= 1 ||
+        stat.m_method != 0 || stat.m_comp_size != stat.m_uncomp_size) {
+      records[i] = getRecord(names[i]);
+      continue;
+    }
+    header_offsets[i] = stat.m_local_header_ofs;
+    records[i] = std::make_tuple(
+        c10::GetCPUAllocator()->allocate(stat.m_uncomp_size),
+        stat.m_uncomp_size);
+    stored.push_back(i);
+  }
+  if (stored.empty()) {
+    return records;
+  }
+
+  std::atomic<size_t> next{0};
+  std::mutex error_mutex;
+  std::exception_ptr error;
+  auto worker = [&]() {
+    for (size_t j = next++; j < stored.size(); j = next++) {
+      size_t i = stored[j];
+      try {
+        in_->read(
+            getDataOffset(header_offsets[i]),
+            std::get<0>(records[i]).get(),
+            std::get<1>(records[i]),
+            "reading record");
+      } catch (...) {
+        std::lock_guard<std::mutex> guard(error_mutex);
+        error = std::current_exception();
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < std::min(num_threads, stored.size()); t++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  return records;
+}
+
 static int64_t read_le_16(uint8_t* buf) {
   return buf[0] + (buf[1] << 8);
 }
@@ -234,15 +371,26 @@ size_t PyTorchStreamReader::getRecordOffset(const std::string& name) {
   mz_zip_archive_file_stat stat;
   mz_zip_reader_file_stat(ar_.get(), getRecordID(name), &stat);
   valid("retrieving file meta-data for ", name.c_str());
+  return getDataOffset(stat.m_local_header_ofs);
+}
+
+uint32_t PyTorchStreamReader::getRecordCrc32(const std::string& name) {
+  mz_zip_archive_file_stat stat;
+  mz_zip_reader_file_stat(ar_.get(), getRecordID(name), &stat);
+  valid("retrieving file meta-data for ", name.c_str());
+  return stat.m_crc32;
+}
+
+size_t PyTorchStreamReader::getDataOffset(uint64_t local_header_ofs) {
   uint8_t local_header[MZ_ZIP_LOCAL_DIR_HEADER_SIZE];
   in_->read(
-      stat.m_local_header_ofs,
+      local_header_ofs,
       local_header,
       MZ_ZIP_LOCAL_DIR_HEADER_SIZE,
       "reading file header");
   size_t filename_len = read_le_16(local_header + MZ_ZIP_LDH_FILENAME_LEN_OFS);
   size_t extra_len = read_le_16(local_header + MZ_ZIP_LDH_EXTRA_LEN_OFS);
-  return stat.m_local_header_ofs + MZ_ZIP_LOCAL_DIR_HEADER_SIZE + filename_len + extra_len;
+  return local_header_ofs + MZ_ZIP_LOCAL_DIR_HEADER_SIZE + filename_len + extra_len;
 }
 
 
@@ -340,6 +488,108 @@ void PyTorchStreamWriter::writeRecord(
   valid("writing file ", name.c_str());
 }
 
+bool PyTorchStreamWriter::writeCompressedRecord(
+    const std::string& name,
+    const void* data,
+    size_t size,
+    size_t element_size) {
+  AT_ASSERT(!finalized_);
+  AT_ASSERT(!archive_name_plus_slash_.empty());
+  const char* src = static_cast<const char*>(data);
+  std::vector<char> shuffled;
+  std::string comment;
+  if (element_size > 1 && size % element_size == 0) {
+    shuffled.resize(size);
+    byteShuffle(src, shuffled.data(), size, element_size);
+    src = shuffled.data();
+    comment = kShuffleComment + c10::to_string(element_size);
+  }
+  // The compressed data must be smaller than the record, so a buffer of its
+  // size is enough and the compression fails when it doesn't fit.
+  std::vector<char> compressed(size);
+  size_t compressed_size = size > 0
+      ? tdefl_compress_mem_to_mem(
+            compressed.data(),
+            compressed.size(),
+            src,
+            size,
+            tdefl_create_comp_flags_from_zip_params(
+                MZ_BEST_COMPRESSION,
+                -MZ_DEFAULT_WINDOW_BITS,
+                MZ_DEFAULT_STRATEGY))
+      : 0;
+  if (compressed_size == 0) {
+    writeRecord(name, data, size);
+    return false;
+  }
+
+  std::string full_name = archive_name_plus_slash_ + name;
+  size_t padding_size =
+      getPadding(ar_->m_archive_size, full_name.size(), size, padding_);
+  mz_zip_writer_add_mem_ex_v2(
+      ar_.get(),
+      full_name.c_str(),
+      compressed.data(),
+      compressed_size,
+      comment.empty() ? nullptr : comment.c_str(),
+      comment.size(),
+      MZ_BEST_COMPRESSION | MZ_ZIP_FLAG_COMPRESSED_DATA,
+      size,
+      mz_crc32(MZ_CRC32_INIT, reinterpret_cast<const mz_uint8*>(src), size),
+      nullptr,
+      padding_.c_str(),
+      padding_size,
+      nullptr,
+      0);
+  valid("writing file ", name.c_str());
+  if (!comment.empty()) {
+    setMinVersion(kShuffledRecordsVersion);
+  }
+  return true;
+}
+
+static size_t read_func_callback(
+    void* pOpaque,
+    uint64_t file_ofs,
+    void* pBuf,
+    size_t n) {
+  auto read = static_cast<
+      const std::function<size_t(uint64_t pos, void* buf, size_t n)>*>(
+      pOpaque);
+  return (*read)(file_ofs, pBuf, n);
+}
+
+void PyTorchStreamWriter::writeRecord(
+    const std::string& name,
+    size_t size,
+    const std::function<size_t(uint64_t pos, void* buf, size_t n)>& read,
+    bool compress) {
+  AT_ASSERT(!finalized_);
+  AT_ASSERT(!archive_name_plus_slash_.empty());
+  std::string full_name = archive_name_plus_slash_ + name;
+  size_t padding_size =
+      getPadding(ar_->m_archive_size, full_name.size(), size, padding_);
+  uint32_t flags = compress ? MZ_BEST_COMPRESSION : 0;
+  // The sizes and the CRC of the record are only known once it is written,
+  // so they follow its data in a data descriptor, and the data starts right
+  // after the local header like for the other records.
+  mz_zip_writer_add_read_buf_callback(
+      ar_.get(),
+      full_name.c_str(),
+      read_func_callback,
+      const_cast<void*>(static_cast<const void*>(&read)),
+      size,
+      nullptr,
+      nullptr,
+      0,
+      flags,
+      padding_.c_str(),
+      padding_size,
+      nullptr,
+      0);
+  valid("writing file ", name.c_str());
+}
+
 void PyTorchStreamWriter::writeEndOfFile() {
   // Rewrites version info
   std::string version = c10::to_string(version_);
@@ -39,7 +39,10 @@ typedef struct mz_zip_archive mz_zip_archive;
 //
 // The PyTorchStreamWriter also ensures additional useful properties for these
 // files
-// 1. All files are stored uncompressed.
+// 1. All files are stored uncompressed, unless written with compress or
+//    writeCompressedRecord, e.g., to ship smaller models. The records of
+//    writeCompressedRecord may have their bytes shuffled, which the reader
+//    undoes.
 // 2. All files in the archive are aligned to 64 byte boundaries such that
 //    it is possible to mmap the entire file and get an aligned pointer to
 //    tensor data.
@@ -91,7 +94,7 @@ namespace caffe2 {
 namespace serialize {
 
 constexpr uint64_t kMinSupportedFileFormatVersion = 0x1L;
-constexpr uint64_t kMaxSupportedFileFormatVersion = 0x5L;
+constexpr uint64_t kMaxSupportedFileFormatVersion = 0x6L;
 
 // Versions (i.e. why was the version number bumped?)
 
@@ -131,8 +134,13 @@ constexpr uint64_t kMaxSupportedFileFormatVersion = 0x5L;
 //      (a versioned symbol preserves the historic behavior of versions 1--3)
 // 5. (Dynamic) Stops torch.full inferring a floating point dtype
 //      when given bool or integer fill values.
+// 6. (Dynamic) Records compressed after shuffling the bytes of their
+//      elements, which the readers must unshuffle.
 constexpr uint64_t kProducedFileFormatVersion = 0x3L;
 
+// The version of the archives that contain byte-shuffled records.
+constexpr uint64_t kShuffledRecordsVersion = 0x6L;
+
 // the version we write when the archive contains bytecode.
 // It must be higher or eq to kProducedFileFormatVersion.
 // Because torchscript changes is likely introduce bytecode change,
@@ -154,9 +162,20 @@ class CAFFE2_API PyTorchStreamReader final {
   explicit PyTorchStreamReader(std::istream* in);
   explicit PyTorchStreamReader(std::unique_ptr<ReadAdapterInterface> in);
 
-  // return dataptr, size
+  // return dataptr, size. The records stored without compression point into
+  // the source when it is mapped in memory, e.g., by a MmapFileAdapter, and
+  // keep the mapping alive; the others are copies.
   std::tuple<at::DataPtr, size_t> getRecord(const std::string& name);
+  // Reads the records of `names`, in their order. When the source allows
+  // concurrent reads, the records stored without compression are read on
+  // `num_threads` threads, each reading a record at once.
+  std::vector<std::tuple<at::DataPtr, size_t>> getRecords(
+      const std::vector<std::string>& names,
+      size_t num_threads);
   size_t getRecordOffset(const std::string& name);
+  // The CRC-32 of the record, as stored in the archive, which is computed on
+  // the bytes it was written with, before any compression.
+  uint32_t getRecordCrc32(const std::string& name);
   bool hasRecord(const std::string& name);
   std::vector<std::string> getAllRecords();
 
@@ -170,6 +189,9 @@ class CAFFE2_API PyTorchStreamReader final {
   size_t read(uint64_t pos, char* buf, size_t n);
   void valid(const char* what, const char* info = "");
   size_t getRecordID(const std::string& name);
+  // The offset of the data of the record whose local header is at
+  // `local_header_ofs`.
+  size_t getDataOffset(uint64_t local_header_ofs);
 
   friend size_t
   istream_read_func(void* pOpaque, uint64_t file_ofs, void* pBuf, size_t n);
@@ -177,6 +199,8 @@ class CAFFE2_API PyTorchStreamReader final {
   std::string archive_name_;
   std::string archive_name_plus_slash_;
   std::unique_ptr<ReadAdapterInterface> in_;
+  // The contents of in_ if they are mapped in memory.
+  std::shared_ptr<void> mapping_;
   int64_t version_;
 };
 
@@ -193,6 +217,27 @@ class CAFFE2_API PyTorchStreamWriter final {
       const void* data,
       size_t size,
       bool compress = false);
+  // Writes a record of `size` bytes that doesn't need to be in memory at once:
+  // `read` is called with the offsets of the successive chunks of the record,
+  // in order, and must copy the next `n` bytes of it into `buf` and return
+  // `n`. The CRC of the record is computed as the chunks are written.
+  void writeRecord(
+      const std::string& name,
+      size_t size,
+      const std::function<size_t(uint64_t pos, void* buf, size_t n)>& read,
+      bool compress = false);
+  // Writes a record compressed with deflate, or uncompressed like
+  // writeRecord when that doesn't make it smaller, which keeps it mappable.
+  // With an element_size larger than 1, the bytes of the elements are
+  // shuffled before the compression, the first bytes of all the elements
+  // followed by their second bytes and so on, which compresses floating point
+  // data much better; the reader unshuffles them. Returns whether the record
+  // was compressed.
+  bool writeCompressedRecord(
+      const std::string& name,
+      const void* data,
+      size_t size,
+      size_t element_size = 1);
   void writeEndOfFile();
 
   bool finalized() const {
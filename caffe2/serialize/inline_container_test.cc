@@ -1,10 +1,13 @@
 #include <cstdio>
 #include <string>
 #include <array>
+#include <vector>
 
 #include <gtest/gtest.h>
 
+#include "caffe2/serialize/file_adapter.h"
 #include "caffe2/serialize/inline_container.h"
+#include "caffe2/serialize/mmap_file_adapter.h"
 
 namespace caffe2 {
 namespace serialize {
@@ -63,6 +66,182 @@ TEST(PyTorchStreamWriterAndReader, SaveAndLoad) {
   ASSERT_EQ(memcmp(the_file.c_str() + off2, data2.data(), data2.size()), 0);
 }
 
+TEST(PyTorchStreamWriterAndReader, GetRecords) {
+  std::ostringstream oss;
+  PyTorchStreamWriter writer([&](const void* b, size_t n) -> size_t {
+    oss.write(static_cast<const char*>(b), n);
+    return oss ? n : 0;
+  });
+  std::vector<std::string> names;
+  std::vector<std::vector<char>> datas;
+  for (int i = 0; i < 16; ++i) {
+    names.push_back("data/" + std::to_string(i));
+    datas.emplace_back(100 + i, static_cast<char>(i));
+    writer.writeRecord(names.back(), datas.back().data(), datas.back().size());
+  }
+  writer.writeEndOfFile();
+
+  std::string the_file = oss.str();
+  std::ofstream foo("output_records.zip");
+  foo.write(the_file.c_str(), the_file.size());
+  foo.close();
+
+  PyTorchStreamReader reader(
+      std::make_unique<FileAdapter>("output_records.zip"));
+  auto records = reader.getRecords(names, 4);
+  ASSERT_EQ(records.size(), names.size());
+  for (size_t i = 0; i < names.size(); ++i) {
+    ASSERT_EQ(std::get<1>(records[i]), datas[i].size());
+    ASSERT_EQ(
+        memcmp(std::get<0>(records[i]).get(), datas[i].data(), datas[i].size()),
+        0);
+  }
+  std::remove("output_records.zip");
+}
+
+TEST(PyTorchStreamWriterAndReader, RecordCrc32) {
+  std::ostringstream oss;
+  PyTorchStreamWriter writer([&](const void* b, size_t n) -> size_t {
+    oss.write(static_cast<const char*>(b), n);
+    return oss ? n : 0;
+  });
+  std::vector<char> data1(1000, 'a');
+  std::vector<char> data2(1000, 'b');
+  writer.writeRecord("key1", data1.data(), data1.size());
+  writer.writeRecord("key2", data2.data(), data2.size());
+  writer.writeRecord("key3", data1.data(), data1.size(), /*compress=*/true);
+  writer.writeEndOfFile();
+
+  std::istringstream iss(oss.str());
+  PyTorchStreamReader reader(&iss);
+  // The CRC is the one of the uncompressed bytes.
+  ASSERT_EQ(reader.getRecordCrc32("key1"), reader.getRecordCrc32("key3"));
+  ASSERT_NE(reader.getRecordCrc32("key1"), reader.getRecordCrc32("key2"));
+}
+
+TEST(PyTorchStreamWriterAndReader, WriteChunkedRecord) {
+  std::ostringstream oss;
+  PyTorchStreamWriter writer([&](const void* b, size_t n) -> size_t {
+    oss.write(static_cast<const char*>(b), n);
+    return oss ? n : 0;
+  });
+  // Larger than the chunks the writer asks for, so that it is read in pieces.
+  std::vector<char> data1(200000);
+  for (size_t i = 0; i < data1.size(); ++i) {
+    data1[i] = static_cast<char>(i * 7);
+  }
+  std::vector<uint64_t> offsets;
+  writer.writeRecord(
+      "key1", data1.size(), [&](uint64_t pos, void* buf, size_t n) -> size_t {
+        offsets.push_back(pos);
+        memcpy(buf, data1.data() + pos, n);
+        return n;
+      });
+  std::array<char, 17> data2;
+  data2.fill('x');
+  writer.writeRecord("key2", data2.data(), data2.size());
+  writer.writeEndOfFile();
+  ASSERT_GT(offsets.size(), 1);
+  ASSERT_EQ(offsets[0], 0);
+
+  std::string the_file = oss.str();
+  std::istringstream iss(the_file);
+  PyTorchStreamReader reader(&iss);
+  at::DataPtr data_ptr;
+  int64_t size;
+  std::tie(data_ptr, size) = reader.getRecord("key1");
+  ASSERT_EQ(size, data1.size());
+  ASSERT_EQ(memcmp(data_ptr.get(), data1.data(), data1.size()), 0);
+  size_t off1 = reader.getRecordOffset("key1");
+  ASSERT_EQ(off1 % kFieldAlignment, 0);
+  ASSERT_EQ(memcmp(the_file.c_str() + off1, data1.data(), data1.size()), 0);
+
+  std::tie(data_ptr, size) = reader.getRecord("key2");
+  ASSERT_EQ(size, data2.size());
+  ASSERT_EQ(memcmp(data_ptr.get(), data2.data(), data2.size()), 0);
+  ASSERT_EQ(reader.getRecordOffset("key2") % kFieldAlignment, 0);
+}
+
+TEST(PyTorchStreamWriterAndReader, WriteCompressedRecord) {
+  std::ostringstream oss;
+  PyTorchStreamWriter writer([&](const void* b, size_t n) -> size_t {
+    oss.write(static_cast<const char*>(b), n);
+    return oss ? n : 0;
+  });
+  std::vector<float> data1(4096);
+  for (size_t i = 0; i < data1.size(); ++i) {
+    data1[i] = 1.0f + i / 4096.0f;
+  }
+  std::vector<char> data2(1000, 'a');
+  std::array<char, 127> data3;
+  for (int i = 0; i < data3.size(); ++i) {
+    data3[i] = data3.size() - i;
+  }
+  ASSERT_TRUE(writer.writeCompressedRecord(
+      "key1", data1.data(), data1.size() * sizeof(float), sizeof(float)));
+  ASSERT_TRUE(writer.writeCompressedRecord("key2", data2.data(), data2.size()));
+  // Doesn't compress, so it is stored as is.
+  ASSERT_FALSE(writer.writeCompressedRecord("key3", data3.data(), data3.size()));
+  writer.writeEndOfFile();
+
+  std::string the_file = oss.str();
+  std::istringstream iss(the_file);
+  PyTorchStreamReader reader(&iss);
+  ASSERT_EQ(reader.version(), kShuffledRecordsVersion);
+  at::DataPtr data_ptr;
+  int64_t size;
+  std::tie(data_ptr, size) = reader.getRecord("key1");
+  ASSERT_EQ(size, data1.size() * sizeof(float));
+  ASSERT_EQ(memcmp(data_ptr.get(), data1.data(), size), 0);
+  std::tie(data_ptr, size) = reader.getRecord("key2");
+  ASSERT_EQ(size, data2.size());
+  ASSERT_EQ(memcmp(data_ptr.get(), data2.data(), size), 0);
+  std::tie(data_ptr, size) = reader.getRecord("key3");
+  ASSERT_EQ(size, data3.size());
+  ASSERT_EQ(memcmp(data_ptr.get(), data3.data(), size), 0);
+  size_t off3 = reader.getRecordOffset("key3");
+  ASSERT_EQ(off3 % kFieldAlignment, 0);
+  ASSERT_EQ(memcmp(the_file.c_str() + off3, data3.data(), data3.size()), 0);
+}
+
+#ifndef _WIN32
+TEST(PyTorchStreamWriterAndReader, LoadMapped) {
+  std::ostringstream oss;
+  PyTorchStreamWriter writer([&](const void* b, size_t n) -> size_t {
+    oss.write(static_cast<const char*>(b), n);
+    return oss ? n : 0;
+  });
+  std::array<char, 127> data1;
+  for (int i = 0; i < data1.size(); ++i) {
+    data1[i] = data1.size() - i;
+  }
+  writer.writeRecord("key1", data1.data(), data1.size());
+  writer.writeEndOfFile();
+
+  std::string the_file = oss.str();
+  std::ofstream foo("output_mapped.zip");
+  foo.write(the_file.c_str(), the_file.size());
+  foo.close();
+
+  at::DataPtr data_ptr;
+  int64_t size;
+  {
+    auto adapter = std::make_unique<MmapFileAdapter>("output_mapped.zip");
+    auto mapping = adapter->mapping();
+    ASSERT_NE(mapping, nullptr);
+    PyTorchStreamReader reader(std::move(adapter));
+    std::tie(data_ptr, size) = reader.getRecord("key1");
+    // The record points into the mapping instead of being copied.
+    size_t off1 = reader.getRecordOffset("key1");
+    ASSERT_EQ(data_ptr.get(), static_cast<char*>(mapping.get()) + off1);
+  }
+  // And keeps it alive after the reader is gone.
+  ASSERT_EQ(size, data1.size());
+  ASSERT_EQ(memcmp(data_ptr.get(), data1.data(), data1.size()), 0);
+  std::remove("output_mapped.zip");
+}
+#endif
+
 } // namespace
 } // namespace serialize
 } // namespace caffe2
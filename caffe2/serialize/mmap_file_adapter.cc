@@ -0,0 +1,78 @@
+#include "caffe2/serialize/mmap_file_adapter.h"
+#include <c10/util/Exception.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include "caffe2/core/common.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace caffe2 {
+namespace serialize {
+
+MmapFileAdapter::MmapFileAdapter(const std::string& file_name) {
+#ifdef _WIN32
+  AT_ERROR("memory-mapped loading is not supported on Windows");
+#else
+  int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd == -1) {
+    AT_ERROR("open file failed, file path: ", file_name);
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) == -1) {
+    close(fd);
+    AT_ERROR("stat file failed, file path: ", file_name);
+  }
+  size_ = file_stat.st_size;
+  if (size_ == 0) {
+    close(fd);
+    AT_ERROR("file is empty, file path: ", file_name);
+  }
+  // The records are writable, as the tensors loaded from them are, but their
+  // pages are only copied when written to.
+  void* data =
+      mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  // The mapping keeps the file alive.
+  close(fd);
+  if (data == MAP_FAILED) {
+    AT_ERROR("mmap failed, file path: ", file_name, ": ", strerror(errno));
+  }
+  size_t size = size_;
+  data_ = std::shared_ptr<void>(data, [size](void* ptr) { munmap(ptr, size); });
+#endif
+}
+
+size_t MmapFileAdapter::size() const {
+  return size_;
+}
+
+size_t MmapFileAdapter::read(
+    uint64_t pos,
+    void* buf,
+    size_t n,
+    const char* what) const {
+  if (pos >= size_) {
+    return 0;
+  }
+  n = std::min<size_t>(n, size_ - pos);
+  std::memcpy(buf, static_cast<const char*>(data_.get()) + pos, n);
+  return n;
+}
+
+std::shared_ptr<void> MmapFileAdapter::mapping() const {
+  return data_;
+}
+
+bool MmapFileAdapter::concurrentReads() const {
+  return true;
+}
+
+MmapFileAdapter::~MmapFileAdapter() {}
+
+} // namespace serialize
+} // namespace caffe2
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "c10/macros/Macros.h"
+#include "caffe2/serialize/read_adapter_interface.h"
+
+namespace caffe2 {
+namespace serialize {
+
+// Reads a file through a private, copy-on-write memory mapping of it. The
+// PyTorchStreamReader of the adapter returns the records stored without
+// compression, like the tensors of a TorchScript archive, as pointers into
+// the mapping instead of copies, and the mapping lives as long as the
+// adapter or the records. The processes loading the same file share the
+// pages of the page cache until they write to them.
+class CAFFE2_API MmapFileAdapter final : public ReadAdapterInterface {
+ public:
+  C10_DISABLE_COPY_AND_ASSIGN(MmapFileAdapter);
+  explicit MmapFileAdapter(const std::string& file_name);
+  size_t size() const override;
+  size_t read(uint64_t pos, void* buf, size_t n, const char* what = "")
+      const override;
+  std::shared_ptr<void> mapping() const override;
+  bool concurrentReads() const override;
+  ~MmapFileAdapter();
+
+ private:
+  std::shared_ptr<void> data_;
+  size_t size_;
+};
+
+} // namespace serialize
+} // namespace caffe2
@@ -3,6 +3,14 @@
 namespace caffe2 {
 namespace serialize {
 
+std::shared_ptr<void> ReadAdapterInterface::mapping() const {
+  return nullptr;
+}
+
+bool ReadAdapterInterface::concurrentReads() const {
+  return false;
+}
+
 ReadAdapterInterface::~ReadAdapterInterface() {}
 
 } // namespace serialize
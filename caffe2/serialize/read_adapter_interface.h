@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 
 #include "c10/macros/Macros.h"
 
@@ -16,6 +17,11 @@ class CAFFE2_API ReadAdapterInterface {
   virtual size_t size() const = 0;
   virtual size_t read(uint64_t pos, void* buf, size_t n, const char* what = "")
       const = 0;
+  // The contents of the whole source, when they are mapped in memory for as
+  // long as the returned pointer or the adapter is alive, or nullptr.
+  virtual std::shared_ptr<void> mapping() const;
+  // Whether read can be called from several threads at once.
+  virtual bool concurrentReads() const;
   virtual ~ReadAdapterInterface();
 };
 
@@ -2,6 +2,8 @@
 #include "WorkersPool.h"
 #include "caffe2/core/logging.h"
 
+#include <algorithm>
+
 #include <cpuinfo.h>
 
 C10_DEFINE_bool(
@@ -15,8 +17,44 @@ C10_DEFINE_int(caffe2_threadpool_android_cap, true, "");
 // Whether or not threadpool caps apply to iOS
 C10_DEFINE_int(caffe2_threadpool_ios_cap, true, "");
 
+C10_DEFINE_bool(
+    caffe2_threadpool_android_big_cores,
+    true,
+    "Whether the threads of the pthreadpool run on the big cores on Android");
+
 namespace caffe2 {
 
+std::vector<int> getBigCoreCPUs() {
+  std::vector<int> cpus;
+#if defined(__linux__)
+  CAFFE_ENFORCE(cpuinfo_initialize(), "cpuinfo initialization failed");
+  // The clusters of a big.LITTLE CPU are told apart by their maximum
+  // frequency, which cpuinfo reads from cpufreq.
+  const uint32_t num_clusters = cpuinfo_get_clusters_count();
+  uint64_t max_frequency = 0;
+  for (uint32_t i = 0; i < num_clusters; ++i) {
+    max_frequency = std::max(max_frequency, cpuinfo_get_cluster(i)->frequency);
+  }
+  if (num_clusters < 2 || max_frequency == 0) {
+    return cpus;
+  }
+  for (uint32_t i = 0; i < num_clusters; ++i) {
+    const auto* cluster = cpuinfo_get_cluster(i);
+    if (cluster->frequency != max_frequency) {
+      continue;
+    }
+    for (uint32_t j = 0; j < cluster->processor_count; ++j) {
+      cpus.push_back(
+          cpuinfo_get_processor(cluster->processor_start + j)->linux_id);
+    }
+  }
+  if (cpus.size() == cpuinfo_get_processors_count()) {
+    cpus.clear();
+  }
+#endif
+  return cpus;
+}
+
 size_t getDefaultNumThreads() {
   CAFFE_ENFORCE(cpuinfo_initialize(), "cpuinfo initialization failed");
   int numThreads = cpuinfo_get_processors_count();
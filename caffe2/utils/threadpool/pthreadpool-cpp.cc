@@ -1,5 +1,14 @@
 #include <caffe2/utils/threadpool/pthreadpool-cpp.h>
 #include <c10/util/Exception.h>
+#include <c10/util/Flags.h>
+#include <c10/util/Logging.h>
+#include <c10/util/numa.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+C10_DECLARE_bool(caffe2_threadpool_android_big_cores);
 
 namespace caffe2 {
 
@@ -22,7 +31,74 @@ void PThreadPool::set_thread_count(const size_t thread_count) {
   // user of the API, which means re-initializing the library, without the
   // need to wait on any pending tasks, is all one needs to do to re-adjust
   // the thread count.
+  if (pthreadpool_get_threads_count(threadpool_.get()) == thread_count) {
+    return;
+  }
   threadpool_.reset(pthreadpool_create(thread_count));
+  pinned_ = affinity_.empty();
+}
+
+void PThreadPool::set_affinity(std::vector<int> cpus) {
+  std::lock_guard<std::mutex> lock{mutex_};
+
+  if (cpus.empty() && !affinity_.empty()) {
+    // New threads aren't pinned.
+    threadpool_.reset(
+        pthreadpool_create(pthreadpool_get_threads_count(threadpool_.get())));
+  }
+  affinity_ = std::move(cpus);
+  pinned_ = affinity_.empty();
+}
+
+std::vector<int> PThreadPool::get_affinity() const {
+  std::lock_guard<std::mutex> lock{mutex_};
+  return affinity_;
+}
+
+void PThreadPool::pin_threads() {
+  pinned_ = true;
+  const size_t thread_count = pthreadpool_get_threads_count(threadpool_.get());
+  if (thread_count <= 1) {
+    return;
+  }
+
+  struct Context final {
+    const std::vector<int>& cpus;
+    const std::thread::id caller;
+    const size_t thread_count;
+    std::atomic<size_t> started;
+    std::atomic<bool> failed;
+  } context{affinity_, std::this_thread::get_id(), thread_count, {0}, {false}};
+
+  pthreadpool_parallelize_1d(
+      threadpool_.get(),
+      [](void* const context, const size_t /* item */) {
+        auto* ctx = reinterpret_cast<Context*>(context);
+        // Every thread of the pool runs one of the items, as none of them
+        // returns before all have started. The deadline only guards against
+        // a pool running fewer threads than it reports.
+        ctx->started++;
+        const auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+        while (ctx->started.load() < ctx->thread_count &&
+               std::chrono::steady_clock::now() < deadline) {
+          std::this_thread::yield();
+        }
+        if (std::this_thread::get_id() == ctx->caller) {
+          return;
+        }
+        try {
+          c10::SetThreadAffinity(ctx->cpus);
+        } catch (const std::exception&) {
+          ctx->failed = true;
+        }
+      },
+      &context,
+      thread_count,
+      0u);
+  if (context.failed) {
+    LOG(WARNING) << "Could not pin the threads of the thread pool";
+  }
 }
 
 void PThreadPool::run(
@@ -31,6 +107,9 @@ void PThreadPool::run(
   std::lock_guard<std::mutex> lock{mutex_};
 
   TORCH_INTERNAL_ASSERT(threadpool_.get(), "Invalid threadpool!");
+  if (!pinned_) {
+    pin_threads();
+  }
 
   struct Context final {
     const std::function<void(size_t)>& fn;
@@ -55,12 +134,45 @@ void PThreadPool::run(
 // Forward declaration
 size_t getDefaultNumThreads();
 
+namespace {
+
+std::atomic<PThreadPoolPolicy> pthreadpool_policy{PThreadPoolPolicy::kAllCores};
+
+void applyPolicy(PThreadPool* threadpool, PThreadPoolPolicy policy) {
+  std::vector<int> cpus;
+  if (policy == PThreadPoolPolicy::kBigCores) {
+    cpus = getBigCoreCPUs();
+  }
+  threadpool->set_thread_count(
+      cpus.empty() ? getDefaultNumThreads() : cpus.size());
+  threadpool->set_affinity(std::move(cpus));
+  pthreadpool_policy = policy;
+}
+
+} // namespace
+
 PThreadPool* pthreadpool() {
-  static std::unique_ptr<PThreadPool> threadpool =
-      std::make_unique<PThreadPool>(getDefaultNumThreads());
+  static std::unique_ptr<PThreadPool> threadpool = [] {
+    auto pool = std::make_unique<PThreadPool>(getDefaultNumThreads());
+#if defined(C10_ANDROID)
+    if (FLAGS_caffe2_threadpool_android_big_cores) {
+      applyPolicy(pool.get(), PThreadPoolPolicy::kBigCores);
+    }
+#endif
+    return pool;
+  }();
   return threadpool.get();
 }
 
+void setPThreadPoolPolicy(PThreadPoolPolicy policy) {
+  applyPolicy(pthreadpool(), policy);
+}
+
+PThreadPoolPolicy getPThreadPoolPolicy() {
+  pthreadpool();
+  return pthreadpool_policy;
+}
+
 pthreadpool_t pthreadpool_() {
   PThreadPool* const threadpool = pthreadpool();
   TORCH_INTERNAL_ASSERT(
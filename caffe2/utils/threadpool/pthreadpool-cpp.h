@@ -11,6 +11,7 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 namespace caffe2 {
 
@@ -28,6 +29,13 @@ class PThreadPool final {
   size_t get_thread_count() const;
   void set_thread_count(size_t thread_count);
 
+  // Pins the threads of the pool to `cpus`, e.g., to the big cores of a
+  // big.LITTLE CPU, or lets them run on any CPU if it is empty. The threads
+  // are pinned before the next run, and again after the thread count changes.
+  // The thread calling run(), which runs part of the work, is left as it is.
+  void set_affinity(std::vector<int> cpus);
+  std::vector<int> get_affinity() const;
+
   // Run, in parallel, function fn(task_id) over task_id in range [0, range).
   // This function is blocking.  All input is processed by the time it returns.
   void run(const std::function<void(size_t)>& fn, size_t range);
@@ -35,11 +43,37 @@ class PThreadPool final {
  private:
   friend pthreadpool_t pthreadpool_();
 
+  // Requires mutex_ to be held.
+  void pin_threads();
+
  private:
   mutable std::mutex mutex_;
   std::unique_ptr<pthreadpool, decltype(&pthreadpool_destroy)> threadpool_;
+  std::vector<int> affinity_;
+  bool pinned_ = true;
+};
+
+// How the threads of the pthreadpool() singleton are placed on the cores of a
+// big.LITTLE CPU, where the threads running on the little cores would be the
+// stragglers of every parallel loop.
+enum class PThreadPoolPolicy {
+  // A thread per core the OS may schedule anywhere, capped as on any CPU.
+  kAllCores,
+  // A thread per core of the fastest cluster, pinned to these cores. It is
+  // the default on Android, unless --caffe2_threadpool_android_big_cores is
+  // false, and it falls back to kAllCores on CPUs with a single cluster.
+  kBigCores,
 };
 
+// Resets the thread count and affinity of pthreadpool() for `policy`. The
+// thread count may still be changed afterwards.
+void setPThreadPoolPolicy(PThreadPoolPolicy policy);
+PThreadPoolPolicy getPThreadPoolPolicy();
+
+// The CPU ids of the cores of the cluster with the highest frequency, or an
+// empty list if the CPU has a single cluster or their frequencies are unknown.
+std::vector<int> getBigCoreCPUs();
+
 // Return a singleton instance of PThreadPool for ATen/TH multithreading.
 PThreadPool* pthreadpool();
 
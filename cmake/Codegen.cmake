@@ -110,6 +110,16 @@ if(INTERN_BUILD_ATEN_OPS)
     endif(MSVC)
   endif(CXX_AVX2_FOUND)
 
+  if(CXX_AVX512_FOUND AND CXX_AVX2_FOUND)
+    set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DHAVE_AVX512_CPU_DEFINITION")
+    list(APPEND CPU_CAPABILITY_NAMES "AVX512")
+    if(MSVC)
+      list(APPEND CPU_CAPABILITY_FLAGS "${OPT_FLAG}/arch:AVX512")
+    else(MSVC)
+      list(APPEND CPU_CAPABILITY_FLAGS "${OPT_FLAG} -mavx512f -mavx512bw -mavx512vl -mavx512dq -mfma ${CPU_NO_AVX256_SPLIT_FLAGS}")
+    endif(MSVC)
+  endif(CXX_AVX512_FOUND AND CXX_AVX2_FOUND)
+
   list(LENGTH CPU_CAPABILITY_NAMES NUM_CPU_CAPABILITY_NAMES)
   math(EXPR NUM_CPU_CAPABILITY_NAMES "${NUM_CPU_CAPABILITY_NAMES}-1")
 
@@ -128,6 +138,16 @@ if(INTERN_BUILD_ATEN_OPS)
       else(MSVC)
         set(EXTRA_FLAGS "-DCPU_CAPABILITY=${CPU_CAPABILITY} -DCPU_CAPABILITY_${CPU_CAPABILITY}")
       endif(MSVC)
+      # AVX512 is a superset of AVX2; keep the Vec256 AVX2 specializations
+      # (and any kernel code guarded by CPU_CAPABILITY_AVX2) enabled for the
+      # AVX512 build so that code not yet ported to Vec512 doesn't regress.
+      if("${CPU_CAPABILITY}" STREQUAL "AVX512")
+        if(MSVC)
+          set(EXTRA_FLAGS "${EXTRA_FLAGS} /DCPU_CAPABILITY_AVX2")
+        else(MSVC)
+          set(EXTRA_FLAGS "${EXTRA_FLAGS} -DCPU_CAPABILITY_AVX2")
+        endif(MSVC)
+      endif()
       # Disable certain warnings for GCC-9.X
       if(CMAKE_COMPILER_IS_GNUCXX AND (CMAKE_CXX_COMPILER_VERSION VERSION_GREATER 9.0.0))
         if(("${NAME}" STREQUAL "native/cpu/GridSamplerKernel.cpp") AND ("${CPU_CAPABILITY}" STREQUAL "DEFAULT"))
@@ -183,6 +203,20 @@ if(INTERN_BUILD_ATEN_OPS)
       --force_schema_registration
       --op_registration_whitelist ${OP_REGISTRATION_WHITELIST})
   endif()
+  if(SELECTED_DTYPES)
+    file(MAKE_DIRECTORY ${CMAKE_BINARY_DIR}/aten/src/ATen)
+    execute_process(
+      COMMAND
+      "${PYTHON_EXECUTABLE}" ${CMAKE_CURRENT_LIST_DIR}/../tools/code_analyzer/gen_selected_dtypes.py
+      --kernel-dtypes "${SELECTED_DTYPES}"
+      --output ${CMAKE_BINARY_DIR}/aten/src/ATen/selected_dtypes.h
+      RESULT_VARIABLE SELECTED_DTYPES_RETURN_VALUE
+    )
+    if(NOT SELECTED_DTYPES_RETURN_VALUE EQUAL 0)
+      message(FATAL_ERROR "Failed to generate ATen/selected_dtypes.h from ${SELECTED_DTYPES}")
+    endif()
+    message(STATUS "Custom build with the kernel dtypes of ${SELECTED_DTYPES}")
+  endif()
   if(USE_VULKAN)
     set(GEN_VULKAN_FLAGS --vulkan)
   endif()
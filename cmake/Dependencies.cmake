@@ -1108,6 +1108,7 @@ if(USE_CUDA)
   set(CAFFE2_USE_CUDNN ${USE_CUDNN})
   set(CAFFE2_USE_NVRTC ${USE_NVRTC})
   set(CAFFE2_USE_TENSORRT ${USE_TENSORRT})
+  set(CAFFE2_USE_CUPTI ${USE_CUPTI})
   include(${CMAKE_CURRENT_LIST_DIR}/public/cuda.cmake)
   if(CAFFE2_USE_CUDA)
     # A helper variable recording the list of Caffe2 dependent libraries
@@ -1130,6 +1131,9 @@ if(USE_CUDA)
     else()
       caffe2_update_option(USE_TENSORRT OFF)
     endif()
+    if(NOT CAFFE2_USE_CUPTI)
+      caffe2_update_option(USE_CUPTI OFF)
+    endif()
   else()
     message(WARNING
       "Not compiling with CUDA. Suppress this warning with "
@@ -25,6 +25,21 @@ SET(AVX2_CODE "
   }
 ")
 
+SET(AVX512_CODE "
+  #include <immintrin.h>
+
+  int main()
+  {
+    __m512i a = _mm512_set1_epi16(1);      // AVX512BW
+    __m512d b = _mm512_set1_pd(1.0);
+    __m256i c = _mm512_cvtepi64_epi32(a);  // AVX512F
+    __m512i d = _mm512_cvtpd_epi64(b);     // AVX512DQ
+    __m256 e = _mm256_maskz_mov_ps(0, _mm256_castsi256_ps(c)); // AVX512VL
+    a = _mm512_abs_epi16(d);
+    return _mm512_reduce_add_epi32(a) + (int)_mm256_cvtss_f32(e);
+  }
+")
+
 MACRO(CHECK_SSE lang type flags)
   SET(__FLAG_I 1)
   SET(CMAKE_REQUIRED_FLAGS_SAVE ${CMAKE_REQUIRED_FLAGS})
@@ -59,3 +74,4 @@ CHECK_SSE(C "AVX2" " ;-mavx2 -mfma;/arch:AVX2")
 
 CHECK_SSE(CXX "AVX" " ;-mavx;/arch:AVX")
 CHECK_SSE(CXX "AVX2" " ;-mavx2 -mfma;/arch:AVX2")
+CHECK_SSE(CXX "AVX512" " ;-mavx512f -mavx512bw -mavx512vl -mavx512dq -mfma;/arch:AVX512")
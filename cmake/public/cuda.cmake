@@ -142,6 +142,22 @@ if(CAFFE2_USE_TENSORRT)
   endif()
 endif()
 
+# Optionally, find CUPTI (with the external correlation API of CUDA 10)
+if(CAFFE2_USE_CUPTI)
+  find_path(CUPTI_INCLUDE_DIR cupti.h
+    HINTS ${CUDA_TOOLKIT_ROOT_DIR}/extras/CUPTI
+    PATH_SUFFIXES include)
+  if(NOT CUDA_cupti_LIBRARY OR NOT CUPTI_INCLUDE_DIR)
+    message(WARNING
+      "Caffe2: Cannot find CUPTI library. Turning the option off.")
+    set(CAFFE2_USE_CUPTI OFF)
+  elseif(CUDA_VERSION VERSION_LESS 10.0)
+    message(WARNING
+      "Caffe2: CUPTI activity tracing needs CUDA 10.0 or newer. Turning the option off.")
+    set(CAFFE2_USE_CUPTI OFF)
+  endif()
+endif()
+
 # ---[ Extract versions
 if(CAFFE2_USE_CUDNN)
   # Get cuDNN version
@@ -188,6 +204,11 @@ find_library(CUDA_CUDA_LIB cuda
 find_library(CUDA_NVRTC_LIB nvrtc
     PATHS ${CUDA_TOOLKIT_ROOT_DIR}
     PATH_SUFFIXES lib lib64 lib/x64)
+if(CUDA_VERSION VERSION_GREATER_EQUAL 10.1)
+  find_library(CUDA_CUBLASLT_LIB cublasLt
+      PATHS ${CUDA_TOOLKIT_ROOT_DIR}
+      PATH_SUFFIXES lib lib64 lib/x64)
+endif()
 
 # Create new style imported libraries.
 # Several of these libraries have a hardcoded path if CAFFE2_STATIC_LINK_CUDA
@@ -253,6 +274,17 @@ else()
       ${LIBNVTOOLSEXT})
 endif()
 
+# cupti
+if(CAFFE2_USE_CUPTI)
+  add_library(torch::cupti INTERFACE IMPORTED)
+  set_property(
+      TARGET torch::cupti PROPERTY INTERFACE_LINK_LIBRARIES
+      ${CUDA_cupti_LIBRARY})
+  set_property(
+      TARGET torch::cupti PROPERTY INTERFACE_INCLUDE_DIRECTORIES
+      ${CUPTI_INCLUDE_DIR})
+endif()
+
 # cudnn
 # static linking is handled by USE_STATIC_CUDNN environment variable
 if(CAFFE2_USE_CUDNN)
@@ -343,6 +375,11 @@ else()
     set_property(
         TARGET caffe2::cublas PROPERTY INTERFACE_LINK_LIBRARIES
         ${CUDA_CUBLAS_LIBRARIES})
+    if(CUDA_CUBLASLT_LIB)
+      set_property(
+        TARGET caffe2::cublas APPEND PROPERTY INTERFACE_LINK_LIBRARIES
+        ${CUDA_CUBLASLT_LIB})
+    endif()
 endif()
 set_property(
     TARGET caffe2::cublas PROPERTY INTERFACE_INCLUDE_DIRECTORIES
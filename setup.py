@@ -152,6 +152,7 @@
 #     possible values:
 #       OMP - use OpenMP for intra-op and native backend for inter-op tasks
 #       NATIVE - use native thread pool for both intra- and inter-op tasks
+#       NATIVE_WS - like NATIVE, with a work stealing intra-op thread pool
 #       TBB - using TBB for intra- and native thread pool for inter-op parallelism
 #
 #   USE_TBB
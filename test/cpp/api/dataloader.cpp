@@ -9,6 +9,7 @@
 
 #include <algorithm>
 #include <chrono>
+#include <fstream>
 #include <future>
 #include <iostream>
 #include <iterator>
@@ -639,6 +640,147 @@ TEST(DataTest, MapDoesNotCopy) {
   ASSERT_EQ(data[0].item<float>(), 7);
 }
 
+// Writes `num_records` records of 3 floats and an int64 target to `path`.
+void write_records(
+    const std::string& path,
+    int64_t first_record,
+    int64_t num_records) {
+  std::ofstream file(path, std::ios::binary);
+  for (int64_t i = first_record; i < first_record + num_records; ++i) {
+    float data[3] = {float(i), float(i) + 0.5f, float(-i)};
+    file.write(reinterpret_cast<const char*>(data), sizeof data);
+    file.write(reinterpret_cast<const char*>(&i), sizeof i);
+  }
+}
+
+TEST(DataTest, RecordDatasetGathersBatchesAcrossShards) {
+  auto first = c10::make_tempfile();
+  auto second = c10::make_tempfile();
+  write_records(first.name, 0, 5);
+  write_records(second.name, 5, 3);
+
+  datasets::RecordDataset dataset(
+      std::vector<std::string>{first.name, second.name},
+      datasets::RecordDatasetOptions({3}));
+  ASSERT_EQ(dataset.size().value(), 8);
+  ASSERT_EQ(dataset.shard_sizes(), std::vector<size_t>({5, 3}));
+
+  std::vector<size_t> indices = {7, 0, 4, 5};
+  auto batch = dataset.get_batch(indices);
+  ASSERT_EQ(batch.data.sizes(), std::vector<int64_t>({4, 3}));
+  ASSERT_EQ(batch.target.sizes(), std::vector<int64_t>({4}));
+  for (size_t i = 0; i < indices.size(); ++i) {
+    ASSERT_EQ(batch.target[i].item<int64_t>(), indices[i]);
+    ASSERT_EQ(batch.data[i][1].item<float>(), float(indices[i]) + 0.5f);
+  }
+  ASSERT_THROWS_WITH(
+      dataset.get_batch(std::vector<size_t>{8}), "out of range");
+}
+
+TEST(DataTest, RecordDatasetWorksWithDistributedSampler) {
+  auto file = c10::make_tempfile();
+  write_records(file.name, 0, 10);
+  datasets::RecordDataset dataset(file.name, datasets::RecordDatasetOptions({3}));
+
+  std::vector<int64_t> targets;
+  for (size_t rank = 0; rank < 2; ++rank) {
+    auto data_loader = torch::data::make_data_loader(
+        dataset,
+        samplers::DistributedRandomSampler(dataset.size().value(), 2, rank),
+        DataLoaderOptions(3));
+    for (auto& batch : *data_loader) {
+      for (int64_t i = 0; i < batch.target.size(0); ++i) {
+        targets.push_back(batch.target[i].item<int64_t>());
+      }
+    }
+  }
+  std::sort(targets.begin(), targets.end());
+  ASSERT_EQ(targets, std::vector<int64_t>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+}
+
+struct CountingSliceDataset : datasets::SliceDataset<CountingSliceDataset> {
+  using SliceDataset::SliceDataset;
+
+  datasets::ExampleLayout layout() const override {
+    return {{2}, torch::kFloat, {}, torch::kLong};
+  }
+  void get_into(size_t index, torch::Tensor data, torch::Tensor target)
+      override {
+    data.fill_(static_cast<double>(index));
+    target.fill_(static_cast<int64_t>(index));
+  }
+  torch::optional<size_t> size() const override {
+    return 10;
+  }
+};
+
+TEST(DataTest, SliceDatasetWritesExamplesIntoPooledBatches) {
+  CountingSliceDataset dataset;
+  std::vector<size_t> indices = {3, 1, 4};
+  void* data_ptr = nullptr;
+  {
+    auto batch = dataset.get_batch(indices);
+    ASSERT_EQ(batch.data.sizes(), std::vector<int64_t>({3, 2}));
+    ASSERT_EQ(batch.target.sizes(), std::vector<int64_t>({3}));
+    for (size_t i = 0; i < indices.size(); ++i) {
+      ASSERT_EQ(batch.data[i][1].item<float>(), indices[i]);
+      ASSERT_EQ(batch.target[i].item<int64_t>(), indices[i]);
+    }
+    data_ptr = batch.data.data_ptr();
+    // The batch is still alive, so the next one can't reuse its tensors.
+    ASSERT_NE(dataset.get_batch(indices).data.data_ptr(), data_ptr);
+  }
+  ASSERT_EQ(dataset.get_batch(indices).data.data_ptr(), data_ptr);
+}
+
+TEST(DataTest, StackWithPoolReusesReleasedBatches) {
+  auto pool = std::make_shared<TensorPool>();
+  transforms::Stack<> stack(pool);
+  auto make_examples = [] {
+    return std::vector<Example<>>{{torch::ones({2}), torch::zeros({})},
+                                  {torch::ones({2}) * 2, torch::ones({})}};
+  };
+  void* data_ptr = nullptr;
+  {
+    auto batch = stack.apply_batch(make_examples());
+    ASSERT_TRUE(torch::equal(batch.data, torch::tensor({{1., 1.}, {2., 2.}})));
+    ASSERT_TRUE(torch::equal(batch.target, torch::tensor({0., 1.})));
+    data_ptr = batch.data.data_ptr();
+  }
+  ASSERT_EQ(stack.apply_batch(make_examples()).data.data_ptr(), data_ptr);
+}
+
+TEST(DataTest, RandomResizedCropCollatesImagesOfDifferentSizes) {
+  transforms::RandomResizedCrop crop(
+      transforms::RandomResizedCropOptions({8, 6})
+          .mean({100, 50, 0})
+          .stddev({2, 4, 8}));
+  std::vector<Example<>> examples{
+      {torch::full({3, 20, 30}, 200, torch::kByte), torch::tensor(1)},
+      {torch::full({3, 5, 7}, 200, torch::kByte), torch::tensor(2)},
+      {torch::full({3, 40, 9}, 200, torch::kByte), torch::tensor(3)}};
+  auto batch = crop.apply_batch(examples);
+  ASSERT_EQ(batch.data.sizes(), std::vector<int64_t>({3, 3, 8, 6}));
+  ASSERT_EQ(batch.data.scalar_type(), torch::kFloat);
+  // Every part of images of a single value has that value, normalized.
+  auto expected = torch::tensor({50., 37.5, 25.}).view({1, 3, 1, 1});
+  ASSERT_TRUE(batch.data.allclose(expected.expand_as(batch.data)));
+  ASSERT_TRUE(torch::equal(batch.target, torch::tensor({1, 2, 3})));
+}
+
+TEST(DataTest, RandomResizedCropOfWholeImagesResizesThem) {
+  transforms::RandomResizedCrop crop(
+      transforms::RandomResizedCropOptions({4, 4})
+          .scale({1.0, 1.0})
+          .ratio({1.0, 1.0})
+          .flip_probability(0));
+  auto image = torch::rand({2, 8, 8});
+  auto batch = crop.apply_batch({{image, torch::tensor(0)}});
+  auto expected = torch::upsample_bilinear2d(
+      image.unsqueeze(0), {4, 4}, /*align_corners=*/false);
+  ASSERT_TRUE(batch.data.allclose(expected));
+}
+
 TEST(DataTest, QueuePushAndPopFromSameThread) {
   torch::data::detail::Queue<int> queue;
   queue.push(1);
@@ -688,6 +830,51 @@ TEST(DataTest, QueueClearEmptiesTheQueue) {
   ASSERT_THROWS_WITH(queue.pop(1 * kMillisecond), "Timeout");
 }
 
+TEST(DataTest, QueuePushBlocksWhileFull) {
+  torch::data::detail::Queue<int> queue(2);
+  queue.push(1);
+  queue.push(2);
+  auto future = std::async(std::launch::async, [&queue] { queue.push(3); });
+  ASSERT_EQ(
+      future.wait_for(20 * kMillisecond), std::future_status::timeout);
+  ASSERT_EQ(queue.pop(), 1);
+  future.get();
+  ASSERT_EQ(queue.pop(), 2);
+  ASSERT_EQ(queue.pop(), 3);
+}
+
+TEST(DataTest, QueueManyProducersAndConsumers) {
+  torch::data::detail::Queue<int> queue(4);
+  const int kThreads = 4;
+  const int kValues = 1000;
+  std::vector<std::thread> producers;
+  for (int t = 0; t < kThreads; ++t) {
+    producers.emplace_back([&queue] {
+      for (int i = 1; i <= kValues; ++i) {
+        queue.push(i);
+      }
+    });
+  }
+  std::vector<std::future<int64_t>> consumers;
+  for (int t = 0; t < kThreads; ++t) {
+    consumers.push_back(std::async(std::launch::async, [&queue] {
+      int64_t sum = 0;
+      for (int i = 0; i < kValues; ++i) {
+        sum += queue.pop();
+      }
+      return sum;
+    }));
+  }
+  int64_t sum = 0;
+  for (auto& consumer : consumers) {
+    sum += consumer.get();
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  ASSERT_EQ(sum, kThreads * kValues * (kValues + 1) / 2);
+}
+
 TEST(DataTest, DataShuttleCanPushAndPopJob) {
   torch::data::detail::DataShuttle<int, int> shuttle;
   shuttle.push_job(1);
@@ -934,6 +1121,78 @@ TEST(DataTest, CanSaveAndLoadDistributedRandomSampler) {
   }
 }
 
+TEST(DataTest, DistributedPermutationSamplerProducesEveryIndexOncePerEpoch) {
+  const size_t sample_count = 1000;
+  samplers::DistributedPermutationSampler sampler(sample_count);
+  std::vector<size_t> previous;
+  for (size_t epoch = 0; epoch < 3; ++epoch) {
+    sampler.set_epoch(epoch);
+    sampler.reset();
+    std::vector<size_t> res;
+    torch::optional<std::vector<size_t>> idx;
+    while ((idx = sampler.next(7)).has_value()) {
+      res.insert(std::end(res), std::begin(*idx), std::end(*idx));
+    }
+    ASSERT_NE(res, previous);
+    previous = res;
+    std::sort(res.begin(), res.end());
+    std::vector<size_t> expected(sample_count);
+    std::iota(expected.begin(), expected.end(), 0);
+    ASSERT_EQ(res, expected);
+  }
+}
+
+TEST(DataTest, DistributedPermutationSamplerMultiReplicaProduceCorrectSamples) {
+  const size_t sample_count = 10;
+  const size_t num_replicas = 3;
+  for (bool allow_duplicates : {true, false}) {
+    std::vector<size_t> res;
+    for (size_t rank = 0; rank < num_replicas; ++rank) {
+      samplers::DistributedPermutationSampler sampler(
+          sample_count, num_replicas, rank, allow_duplicates, /*seed=*/42);
+      torch::optional<std::vector<size_t>> idx;
+      while ((idx = sampler.next(2)).has_value()) {
+        res.insert(std::end(res), std::begin(*idx), std::end(*idx));
+      }
+    }
+    std::sort(res.begin(), res.end());
+    if (allow_duplicates) {
+      ASSERT_EQ(res, std::vector<size_t>({0, 0, 1, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+    } else {
+      // The replicas sample 9 distinct indices.
+      ASSERT_EQ(res.size(), 9);
+      ASSERT_EQ(std::unique(res.begin(), res.end()), res.end());
+      ASSERT_LT(res.back(), sample_count);
+    }
+  }
+}
+
+TEST(DataTest, DistributedPermutationSamplerSamplesHugeDatasets) {
+  // Way more indices than fit in memory.
+  const size_t sample_count = size_t(1) << 40;
+  samplers::DistributedPermutationSampler sampler(sample_count, 1000, 999);
+  auto indices = sampler.next(1000).value();
+  ASSERT_EQ(indices.size(), 1000);
+  for (size_t index : indices) {
+    ASSERT_LT(index, sample_count);
+  }
+}
+
+TEST(DataTest, CanSaveAndLoadDistributedPermutationSampler) {
+  samplers::DistributedPermutationSampler a(100, 2, 1);
+  a.set_epoch(3);
+  a.reset();
+  a.next(10);
+  std::stringstream stream;
+  torch::save(a, stream);
+
+  samplers::DistributedPermutationSampler b(100, 2, 1);
+  torch::load(b, stream);
+  ASSERT_EQ(b.epoch(), 3);
+  ASSERT_EQ(b.index(), a.index());
+  ASSERT_EQ(b.next(20), a.next(20));
+}
+
 TEST(DataTest, DistributedSequentialSamplerSingleReplicaProduceCorrectSamples) {
   size_t sample_count = 10;
   size_t batch_size = 3;
@@ -1429,6 +1688,42 @@ TEST(DataLoaderTest, Reset) {
   ASSERT_EQ(++iterator, end);
 }
 
+TEST(DataLoaderTest, PrefetchesBatchesToDevice) {
+  auto dataset = datasets::TensorDataset(torch::arange(10).view({10, 1}))
+                     .map(transforms::Stack<TensorExample>());
+  auto data_loader = torch::data::make_data_loader(
+      std::move(dataset),
+      DataLoaderOptions(2).workers(2).device(torch::kCPU).device_prefetch(3));
+
+  for (size_t epoch = 0; epoch < 2; ++epoch) {
+    int64_t expected = 0;
+    for (auto& batch : *data_loader) {
+      ASSERT_EQ(batch.data.size(0), 2);
+      ASSERT_EQ(batch.data[0].item<int64_t>(), expected);
+      ASSERT_EQ(batch.data[1].item<int64_t>(), expected + 1);
+      expected += 2;
+    }
+    ASSERT_EQ(expected, 10);
+  }
+}
+
+TEST(DataLoaderTest, PinsMemoryAndPrefetchesBatchesToDevice_CUDA) {
+  auto dataset = datasets::TensorDataset(torch::arange(10).view({10, 1}))
+                     .map(transforms::Stack<TensorExample>());
+  auto data_loader = torch::data::make_data_loader(
+      std::move(dataset),
+      DataLoaderOptions(2).workers(2).pin_memory(true).device(torch::kCUDA));
+
+  int64_t expected = 0;
+  for (auto& batch : *data_loader) {
+    ASSERT_TRUE(batch.data.is_cuda());
+    ASSERT_TRUE(torch::equal(
+        batch.data.cpu(), torch::arange(expected, expected + 2).view({2, 1})));
+    expected += 2;
+  }
+  ASSERT_EQ(expected, 10);
+}
+
 TEST(DataLoaderTest, TestExceptionsArePropagatedFromWorkers) {
   struct D : datasets::Dataset<DummyDataset, int> {
     int get(size_t index) override {
@@ -1690,6 +1985,80 @@ TEST(DataLoaderTest, ChunkDataSetGetBatch) {
   }
 }
 
+TEST(DataLoaderTest, ChunkDataSetOrderedWithDecoders) {
+  const size_t batch_size = 5;
+  DummyChunkDataReader data_reader;
+  samplers::SequentialSampler sampler(0);
+  std::atomic<size_t> decoded_chunks{0};
+
+  datasets::SharedBatchDataset<datasets::ChunkDataset<
+      DummyChunkDataReader,
+      samplers::SequentialSampler,
+      samplers::SequentialSampler>>
+      dataset = datasets::make_shared_dataset<datasets::ChunkDataset<
+          DummyChunkDataReader,
+          samplers::SequentialSampler,
+          samplers::SequentialSampler>>(
+          data_reader,
+          sampler,
+          sampler,
+          datasets::ChunkDatasetOptions(3, batch_size)
+              .decoder_count(2)
+              .ordered(true),
+          [&decoded_chunks](std::vector<int>& data) { ++decoded_chunks; });
+
+  auto data_loader = torch::data::make_data_loader(
+      dataset, DataLoaderOptions(batch_size).workers(0));
+
+  for (int epoch = 0; epoch < 2; ++epoch) {
+    int expected = 0;
+    for (auto& batch : *data_loader) {
+      ASSERT_EQ(batch.size(), batch_size);
+      for (int example : batch) {
+        ASSERT_EQ(example, expected++);
+      }
+    }
+    ASSERT_EQ(expected, 35);
+  }
+  ASSERT_EQ(decoded_chunks.load(), 6);
+}
+
+TEST(DataLoaderTest, ChunkDataSetShuffleBuffer) {
+  const size_t batch_size = 4;
+  DummyChunkDataReader data_reader;
+  samplers::SequentialSampler sampler(0);
+
+  datasets::SharedBatchDataset<datasets::ChunkDataset<
+      DummyChunkDataReader,
+      samplers::SequentialSampler,
+      samplers::SequentialSampler>>
+      dataset = datasets::make_shared_dataset<datasets::ChunkDataset<
+          DummyChunkDataReader,
+          samplers::SequentialSampler,
+          samplers::SequentialSampler>>(
+          data_reader,
+          sampler,
+          sampler,
+          datasets::ChunkDatasetOptions(2, batch_size).shuffle_buffer_size(8));
+
+  auto data_loader = torch::data::make_data_loader(
+      dataset, DataLoaderOptions(batch_size).workers(0));
+
+  std::vector<int> examples;
+  size_t partial_batches = 0;
+  for (auto& batch : *data_loader) {
+    ASSERT_LE(batch.size(), batch_size);
+    partial_batches += batch.size() < batch_size;
+    examples.insert(examples.end(), batch.begin(), batch.end());
+  }
+  // Only the last batch of the epoch may be partial.
+  ASSERT_LE(partial_batches, 1);
+  std::sort(examples.begin(), examples.end());
+  std::vector<int> expected(35);
+  std::iota(expected.begin(), expected.end(), 0);
+  ASSERT_EQ(examples, expected);
+}
+
 TEST(DataLoaderTest, ChunkDataSetWithBatchSizeMismatch) {
   const size_t prefetch_count = 1;
   const size_t batch_size = 5;
@@ -0,0 +1,59 @@
+#include <torch/torch.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+// Measures the overhead of the DataLoader itself, with datasets whose
+// examples cost next to nothing to produce.
+
+struct CountingDataset
+    : torch::data::datasets::Dataset<CountingDataset, size_t> {
+  explicit CountingDataset(size_t size) : size_(size) {}
+
+  size_t get(size_t index) override {
+    return index;
+  }
+  torch::optional<size_t> size() const override {
+    return size_;
+  }
+
+  size_t size_;
+};
+
+void DataLoader_Throughput(
+    size_t numExamples,
+    size_t batchSize,
+    size_t workers,
+    bool enforceOrdering) {
+  auto data_loader = torch::data::make_data_loader(
+      CountingDataset(numExamples),
+      torch::data::DataLoaderOptions(batchSize)
+          .workers(workers)
+          .enforce_ordering(enforceOrdering));
+  size_t batches = 0;
+  size_t checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (auto& batch : *data_loader) {
+    checksum += batch.front();
+    ++batches;
+  }
+  auto usec = std::chrono::duration_cast<std::chrono::microseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+  std::cout << "Workers(" << workers << ") BatchSize(" << batchSize
+            << ") Ordered(" << enforceOrdering << "): "
+            << static_cast<double>(usec) / static_cast<double>(batches)
+            << " usec/batch, "
+            << static_cast<double>(batches) * 1e6 / static_cast<double>(usec)
+            << " batches/sec (checksum " << checksum << ")\n";
+}
+
+int main(int argc, char** argv) {
+  size_t N = argc > 1 ? std::atoi(argv[1]) : 1000000;
+  for (size_t workers : {0, 1, 4, 16, 32}) {
+    DataLoader_Throughput(N, 1, workers, true);
+    DataLoader_Throughput(N, 1, workers, false);
+    DataLoader_Throughput(N, 64, workers, false);
+  }
+  return 0;
+}
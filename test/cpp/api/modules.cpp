@@ -2119,6 +2119,20 @@ TEST_F(ModulesTest, CrossEntropyLoss) {
       ->forward(input, target).allclose(expected, 1e-04));
 }
 
+TEST_F(ModulesTest, CrossEntropyLossLabelSmoothing) {
+  CrossEntropyLoss loss(CrossEntropyLossOptions().label_smoothing(0.3));
+  auto input = torch::tensor({{1., 2., 3.}, {3., 2., 1.}}, torch::dtype(torch::kFloat).requires_grad(true));
+  auto target = torch::tensor({2, 1}, torch::kLong);
+  auto output = loss->forward(input, target);
+  auto log_probs = torch::log_softmax(input, 1);
+  auto expected = (-0.7 * log_probs.gather(1, target.unsqueeze(1)).squeeze(1) -
+                   0.3 * log_probs.mean(1)).mean();
+  output.backward();
+
+  ASSERT_TRUE(output.allclose(expected, 1e-04));
+  ASSERT_EQ(input.sizes(), input.grad().sizes());
+}
+
 TEST_F(ModulesTest, CosineSimilarity) {
   CosineSimilarity cos(CosineSimilarityOptions().dim(1));
   auto input1 = torch::tensor({{1, 2, 3}, {4, 5, 6}}, torch::dtype(torch::kFloat).requires_grad(true));
@@ -130,6 +130,16 @@ TEST(TensorIndexingTest, TestNone) {
   ASSERT_EQ(v.index({"...", None}).sizes(), torch::IntArrayRef({5, 7, 3, 1}));
 }
 
+TEST(TensorIndexingTest, TestBasicIndexingView) {
+  auto v = torch::arange(5 * 7 * 6).view({5, 7, 6}).index({Slice(1), Slice(), Slice(None, None, 2)});
+  auto expected = v.select(0, 2).slice(0, 1, 5, 3).unsqueeze(1).select(2, -1);
+  auto result = v.index({2, Slice(1, 5, 3), None, -1});
+  ASSERT_EQ(result.sizes(), expected.sizes());
+  ASSERT_EQ(result.strides(), expected.strides());
+  ASSERT_EQ(result.storage_offset(), expected.storage_offset());
+  assert_tensor_equal(result, expected);
+}
+
 TEST(TensorIndexingTest, TestStep) {
   auto v = torch::arange(10);
   assert_tensor_equal(v.index({Slice(None, None, 1)}), v);
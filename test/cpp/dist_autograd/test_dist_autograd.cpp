@@ -1,4 +1,5 @@
 #include <memory>
+#include <thread>
 
 #include <gtest/gtest.h>
 
@@ -104,6 +105,61 @@ TEST_F(DistAutogradTest, TestInitializedContextCleanupSendFunction) {
   ASSERT_EQ(0, engine.numBackwardPasses());
 }
 
+TEST_F(DistAutogradTest, TestConcurrentSendFunctionsAcrossContexts) {
+  // Keep a current context for TearDown.
+  autogradContainer_->newContext();
+  auto& engine = DistEngine::getInstance();
+  ASSERT_EQ(0, engine.numBackwardPasses());
+
+  // Every context gets two send functions, run concurrently with each other
+  // and with those of the other contexts. Ids close to the maximum are not
+  // handed out by newContext().
+  constexpr int kNumContexts = 16;
+  auto options = at::TensorOptions().requires_grad(true);
+  std::vector<ContextPtr> contexts;
+  std::vector<torch::Tensor> leaves;
+  for (int i = 0; i < kNumContexts; i++) {
+    auto context = autogradContainer_->getOrCreateContext(
+        autogradContainer_->getMaxId() - i);
+    auto t = torch::ones({2}, options);
+    auto tensors = std::vector<torch::Tensor>{t};
+    for (int64_t messageId = 0; messageId < 2; messageId++) {
+      addSendRpcBackward(
+          context, AutogradMetadata(context->contextId(), messageId), tensors);
+      context->retrieveSendFunction(messageId)->setGrads(
+          {torch::ones({2})});
+    }
+    contexts.push_back(context);
+    leaves.push_back(t);
+  }
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumContexts; i++) {
+    for (int64_t messageId = 0; messageId < 2; messageId++) {
+      threads.emplace_back([&engine, &contexts, i, messageId]() {
+        engine
+            .executeSendFunctionAsync(
+                contexts[i],
+                contexts[i]->retrieveSendFunction(messageId),
+                /*retrainGraph*/ false)
+            ->wait();
+      });
+    }
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // Both gradients are accumulated in every context, which is cleaned up.
+  for (int i = 0; i < kNumContexts; i++) {
+    auto grads = contexts[i]->getGradients();
+    ASSERT_EQ(1, grads.size());
+    ASSERT_TRUE(grads.at(leaves[i]).equal(torch::full({2}, 2.0)));
+    autogradContainer_->releaseContext(contexts[i]->contextId());
+  }
+  ASSERT_EQ(0, engine.numBackwardPasses());
+}
+
 } // namespace autograd
 } // namespace distributed
 } // namespace torch
@@ -1185,6 +1185,36 @@ void testMemoryDAG() {
       AT_ASSERT(!dag->mayContainAlias(e, elem));
     }
   }
+  {
+    // c -> a
+    // b(c)
+    // d(a)
+    // e is by itself
+    auto t = std::make_unique<MemoryDAGBuilder>();
+    auto a = t->makeFreshValue(aValue);
+    auto b = t->makeFreshValue(bValue);
+    auto c = t->makeFreshValue(cValue);
+    auto d = t->makeFreshValue(dValue);
+    auto e = t->makeFreshValue(eValue);
+    t->makePointerTo(c, a);
+    t->addToContainedElements(c, b);
+    t->addToContainedElements(a, d);
+
+    auto dag = std::make_unique<MemoryDAG>(std::move(t));
+    // The second round is answered from the cached contained locations
+    for (int i = 0; i < 2; ++i) {
+      const auto& bLocs = dag->getAllContainedMemoryLocations(b);
+      AT_ASSERT(bLocs.test(b->index));
+      AT_ASSERT(bLocs.test(c->index));
+      AT_ASSERT(bLocs.test(a->index));
+      AT_ASSERT(!bLocs.test(d->index));
+
+      AT_ASSERT(dag->mayContainAlias(b, d));
+      AT_ASSERT(dag->mayContainAlias(d, c));
+      AT_ASSERT(!dag->mayContainAlias(b, e));
+      AT_ASSERT(!dag->mayContainAlias(d, e));
+    }
+  }
 }
 
 void testAliasRegistration() {
@@ -1,4 +1,5 @@
 #include <torch/csrc/jit/backends/backend.h>
+#include <torch/csrc/jit/api/module.h>
 
 namespace torch {
 namespace jit {
@@ -67,8 +68,65 @@ class TestBackend : public PyTorchBackendInterface {
   }
 };
 
+// This test JIT backend runs the methods of the processed module in the
+// interpreter, so that the results of modules that are only partly lowered to
+// it can be checked.
+class TestInterpreterBackend : public PyTorchBackendInterface {
+ public:
+  // Constructor.
+  explicit TestInterpreterBackend() {}
+  virtual ~TestInterpreterBackend() = default;
+
+  c10::IValue preprocess(
+      c10::IValue mod,
+      c10::impl::GenericDict method_compile_spec) override {
+    return mod;
+  }
+
+  c10::impl::GenericDict compile(
+      c10::IValue processed,
+      c10::impl::GenericDict method_compile_spec) override {
+    module_ = processed.toModule();
+    auto spec =
+        c10::impl::toTypedDict<std::string, at::IValue>(method_compile_spec);
+
+    // The handle of a method is its name.
+    auto handles = c10::Dict<std::string, std::string>();
+    for (auto it = spec.begin(), end = spec.end(); it != end; ++it) {
+      handles.insert(it->key(), it->key());
+    }
+    return c10::impl::toGenericDict(handles);
+  }
+
+  c10::impl::GenericList execute(
+      c10::IValue handle,
+      c10::impl::GenericList inputs) override {
+    TORCH_INTERNAL_ASSERT(handle.isString());
+    TORCH_INTERNAL_ASSERT(module_.has_value());
+
+    auto output = module_->get_method(handle.toStringRef())(
+        std::vector<c10::IValue>(inputs.begin(), inputs.end()));
+
+    // The elements of a tuple are returned as separate outputs.
+    c10::impl::GenericList output_list(c10::AnyType::get());
+    if (output.isTuple()) {
+      for (const auto& element : output.toTuple()->elements()) {
+        output_list.emplace_back(element);
+      }
+    } else {
+      output_list.emplace_back(output);
+    }
+    return output_list;
+  }
+
+ private:
+  c10::optional<Module> module_;
+};
+
 namespace {
 static auto cls = torch::jit::backend<TestBackend>("test_backend");
+static auto interpreter_cls =
+    torch::jit::backend<TestInterpreterBackend>("test_interpreter_backend");
 }
 
 } // namespace jit
@@ -3880,6 +3880,56 @@ void testGPU_FusionZeroDimReduction() {
       aten_output.sub(output).abs().max());
 }
 
+void testGPU_FusionVectorizePointwise() {
+  torch::jit::fuser::cuda::CudaKernel prog;
+  Fusion& fusion = *prog.fusion_;
+  FusionGuard fg(&fusion);
+
+  const int vector_width = 4;
+  const int bdimx = 128;
+
+  TensorView* tv0 = makeDummyTensor(2);
+  fusion.addInput(tv0);
+
+  // Copy the input to registers, compute, then copy the result back out, so
+  // that the global accesses are the vectorized copies.
+  auto tv1 = static_cast<TensorView*>(unaryOp(UnaryOpType::Set, tv0));
+  auto tv2 = add(tv1, new Float(1));
+  auto tv3 = static_cast<TensorView*>(unaryOp(UnaryOpType::Set, tv2));
+  fusion.addOutput(tv3);
+
+  tv3->merge(0, 1);
+  tv3->split(0, vector_width);
+  tv3->split(0, bdimx);
+  tv0->computeAt(tv3, 1);
+
+  for (auto tv : {tv1, tv2, tv3}) {
+    tv->axis(0)->parallelize(ParallelType::BIDx);
+    tv->axis(1)->parallelize(ParallelType::TIDx);
+    tv->axis(2)->parallelize(ParallelType::Vectorize);
+  }
+
+  // The last block only partially covers the input, and runs the scalar
+  // copies.
+  const int rows = 37;
+  const int cols = 100;
+  prog.device_ = 0;
+  prog.grid((rows * cols + bdimx * vector_width - 1) / (bdimx * vector_width));
+  prog.block(bdimx);
+
+  torch::jit::fuser::cuda::compileKernel(&prog);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor input = at::rand({rows, cols}, options);
+  at::Tensor output = at::empty_like(input, options);
+  torch::jit::fuser::cuda::runTestKernel(&prog, {input}, {output});
+  auto aten_output = input + 1;
+  TORCH_CHECK(
+      aten_output.allclose(output),
+      "Error of: ",
+      aten_output.sub(output).abs().max());
+}
+
 } // namespace jit
 } // namespace torch
 #endif // #if defined(USE_CUDA)
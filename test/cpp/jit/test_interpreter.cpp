@@ -1,6 +1,8 @@
 #include "test/cpp/jit/test_base.h"
 #include "test/cpp/jit/test_utils.h"
 
+#include <torch/csrc/jit/runtime/instruction.h>
+
 namespace torch {
 namespace jit {
 
@@ -27,5 +29,97 @@ void testInterp() {
   ASSERT_TRUE(exactlyEqual(outputs[0], hx));
   ASSERT_TRUE(exactlyEqual(outputs[1], cx));
 }
+
+void testInterpreterSuperinstructions() {
+  auto graph = std::make_shared<Graph>();
+  parseIR(
+      R"IR(
+graph(%a : Tensor, %b : Tensor, %n : int):
+  %one : int = prim::Constant[value=1]()
+  %true : bool = prim::Constant[value=1]()
+  %r : Tensor = prim::Loop(%n, %true, %a)
+    block0(%i : int, %x : Tensor):
+      %y : Tensor = aten::mul(%x, %b)
+      %z : Tensor = aten::add(%y, %b, %one)
+      -> (%true, %z)
+  return (%r))IR",
+      &*graph);
+  auto a = at::randn({4});
+  auto b = at::randn({4});
+
+  auto run_code = [&](bool superinstructions) {
+    bool old_state = superinstructionsEnabled();
+    setSuperinstructionsEnabled(superinstructions);
+    Code code(graph, "");
+    setSuperinstructionsEnabled(old_state);
+    InterpreterState interp(code);
+    Stack stack{a, b, 3};
+    interp.run(stack);
+    return std::make_pair(code.instructions(), stack.at(0).toTensor());
+  };
+  auto fused = run_code(true);
+  auto plain = run_code(false);
+  ASSERT_TRUE(exactlyEqual(fused.second, plain.second));
+
+  // the superinstructions only replace the first instruction of their
+  // sequence
+  ASSERT_EQ(fused.first.size(), plain.first.size());
+  bool has_superinstructions = false;
+  for (size_t i = 0; i < fused.first.size(); ++i) {
+    auto inst = unfused(fused.first[i]);
+    ASSERT_EQ(inst.op, plain.first[i].op);
+    ASSERT_EQ(inst.X, plain.first[i].X);
+    ASSERT_EQ(inst.N, plain.first[i].N);
+    has_superinstructions |= fused.first[i].op != plain.first[i].op;
+  }
+  ASSERT_TRUE(has_superinstructions);
+
+  resetInstructionPairCounts();
+  setInstructionProfilingEnabled(true);
+  run_code(false);
+  setInstructionProfilingEnabled(false);
+  auto counts = instructionPairCounts();
+  ASSERT_FALSE(counts.empty());
+  // the loop body runs 3 times
+  ASSERT_GE(std::get<2>(counts.front()), 3);
+  resetInstructionPairCounts();
+  ASSERT_TRUE(instructionPairCounts().empty());
+}
+
+void testInterpreterUnpackSharedContainers() {
+  // The tuple and the list are unpacked while the graph still uses them, so
+  // unpacking must copy their elements rather than move them.
+  auto graph = std::make_shared<Graph>();
+  parseIR(
+      R"IR(
+graph(%a : Tensor, %b : Tensor):
+  %zero : int = prim::Constant[value=0]()
+  %t : (Tensor, Tensor) = prim::TupleConstruct(%a, %b)
+  %x : Tensor, %y : Tensor = prim::TupleUnpack(%t)
+  %l : Tensor[] = prim::ListConstruct(%a, %b)
+  %u : Tensor, %v : Tensor = prim::ListUnpack(%l)
+  %i : Tensor = prim::TupleIndex(%t, %zero)
+  %r : (Tensor, Tensor, Tensor, Tensor, Tensor, (Tensor, Tensor), Tensor[]) = prim::TupleConstruct(%x, %y, %u, %v, %i, %t, %l)
+  return (%r))IR",
+      &*graph);
+  auto a = at::randn({4});
+  auto b = at::randn({4});
+  Code code(graph, "");
+  InterpreterState interp(code);
+  Stack stack{a, b};
+  interp.run(stack);
+  auto outputs = stack.at(0).toTuple()->elements();
+  ASSERT_TRUE(outputs[0].toTensor().is_same(a));
+  ASSERT_TRUE(outputs[1].toTensor().is_same(b));
+  ASSERT_TRUE(outputs[2].toTensor().is_same(a));
+  ASSERT_TRUE(outputs[3].toTensor().is_same(b));
+  ASSERT_TRUE(outputs[4].toTensor().is_same(a));
+  auto t = outputs[5].toTuple()->elements();
+  ASSERT_TRUE(t[0].toTensor().is_same(a));
+  ASSERT_TRUE(t[1].toTensor().is_same(b));
+  auto l = outputs[6].toTensorList();
+  ASSERT_TRUE(l.get(0).is_same(a));
+  ASSERT_TRUE(l.get(1).is_same(b));
+}
 } // namespace jit
 } // namespace torch
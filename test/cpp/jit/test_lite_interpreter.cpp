@@ -4,6 +4,7 @@
 #include <torch/csrc/jit/api/module.h>
 #include <torch/csrc/jit/mobile/import.h>
 #include <torch/csrc/jit/mobile/module.h>
+#include <torch/csrc/jit/mobile/observer.h>
 #include <torch/csrc/jit/serialization/import.h>
 #include <torch/custom_class.h>
 #include <torch/torch.h>
@@ -71,6 +72,29 @@ void testLiteInterpreterAdd() {
   AT_ASSERT(resd == refd);
 }
 
+void testLiteInterpreterCompressedTensors() {
+  Module m("m");
+  m.register_parameter("weight", torch::arange(4096.), false);
+  m.define(R"(
+    def forward(self, x):
+      return x + self.weight
+  )");
+
+  std::stringstream ss, compressed_ss;
+  m._save_for_mobile(ss);
+  m._save_for_mobile(
+      compressed_ss,
+      ExtraFilesMap(),
+      /*save_mobile_debug_info=*/false,
+      /*compress_tensors=*/true);
+  ASSERT_LT(compressed_ss.str().size(), ss.str().size());
+
+  mobile::Module bc = _load_for_mobile(compressed_ss);
+  auto x = torch::ones({4096});
+  auto res = bc.forward({x}).toTensor();
+  ASSERT_TRUE(res.equal(x + torch::arange(4096.)));
+}
+
 void testLiteInterpreterConv() {
   auto s = std::getenv("PYTORCH_TEST_WITH_TSAN");
   if (s && strcmp(s, "1") == 0)
@@ -593,6 +617,102 @@ void testLiteInterpreterEval() {
       outputref[0][0][0][0].item<int>() == output[0][0][0][0].item<int>());
 }
 
+namespace {
+class LoadStagesObserver : public torch::MobileModuleObserver {
+ public:
+  explicit LoadStagesObserver(std::vector<std::string>* stages)
+      : stages_(stages) {}
+
+  void onLoadModelStage(const std::string& stage, int64_t) override {
+    stages_->push_back(stage);
+  }
+
+ private:
+  std::vector<std::string>* stages_;
+};
+} // namespace
+
+void testLiteInterpreterSharedOperators() {
+  Module m("m");
+  m.register_parameter("foo", torch::ones({}), false);
+  m.define(R"(
+    def add_it(self, x):
+      return self.foo + x
+
+    def forward(self, x):
+      return self.add_it(x) + x
+  )");
+  std::stringstream ss;
+  m._save_for_mobile(ss);
+
+  std::vector<std::string> stages;
+  torch::observerConfig().setModuleObserver(
+      std::make_unique<LoadStagesObserver>(&stages));
+  mobile::Module bc = _load_for_mobile(ss);
+  torch::observerConfig().setModuleObserver(nullptr);
+  std::vector<std::string> expected_stages = {
+      "bytecode", "methods", "operators", "data"};
+  ASSERT_EQ(stages, expected_stages);
+
+  // The methods share the aten::add operator the module resolved once.
+  auto x = 2 * torch::ones({});
+  ASSERT_EQ(bc.run_method("add_it", {x}).toTensor().item<float>(), 3);
+  ASSERT_EQ(bc.run_method("forward", {x}).toTensor().item<float>(), 5);
+}
+
+namespace {
+class RunMemoryObserver : public torch::MobileModuleObserver {
+ public:
+  explicit RunMemoryObserver(std::vector<mobile::MemoryStats>* runs)
+      : runs_(runs) {}
+
+  void onRunMethodMemory(size_t planned_bytes, size_t unplanned_bytes)
+      override {
+    mobile::MemoryStats stats;
+    stats.planned_bytes = planned_bytes;
+    stats.unplanned_bytes = unplanned_bytes;
+    runs_->push_back(stats);
+  }
+
+ private:
+  std::vector<mobile::MemoryStats>* runs_;
+};
+} // namespace
+
+void testLiteInterpreterMemoryPlan() {
+  Module m("m");
+  m.define(R"(
+    def forward(self, x):
+      y = x * x
+      z = y + x
+      return z * y
+  )");
+  std::stringstream ss;
+  m._save_for_mobile(ss);
+  mobile::Module bc = _load_for_mobile(ss);
+
+  std::vector<mobile::MemoryStats> runs;
+  torch::observerConfig().setModuleObserver(
+      std::make_unique<RunMemoryObserver>(&runs));
+  auto out1 = bc.forward({torch::ones({64})}).toTensor();
+  auto out2 = bc.forward({2 * torch::ones({64})}).toTensor();
+  torch::observerConfig().setModuleObserver(nullptr);
+
+  // The second run writes into the tensors the first one left in the arena,
+  // but not into the output the caller still holds.
+  ASSERT_TRUE(out1.equal(2 * torch::ones({64})));
+  ASSERT_TRUE(out2.equal(24 * torch::ones({64})));
+  ASSERT_EQ(runs.size(), 2);
+  ASSERT_GT(runs[0].unplanned_bytes, 0);
+  ASSERT_GT(runs[1].planned_bytes, 0);
+  ASSERT_LT(runs[1].unplanned_bytes, runs[0].unplanned_bytes);
+
+  // The inputs of another dtype aren't written into the planned tensors.
+  auto out3 = bc.forward({torch::ones({64}, at::kLong)}).toTensor();
+  ASSERT_EQ(out3.scalar_type(), at::kLong);
+  ASSERT_TRUE(out3.equal(2 * torch::ones({64}, at::kLong)));
+}
+
 namespace {
 static auto reg =
     torch::class_<TorchBindLiteInterpreterTestStruct>(
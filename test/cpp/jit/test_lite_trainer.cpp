@@ -183,5 +183,35 @@ void testLiteSGD() {
   AT_ASSERT(parameters[0].item<float>() == bc_parameters[0].item<float>());
 }
 
+void testLiteSGDInPlace() {
+  auto options = ::torch::jit::mobile::SGDOptions(0.1)
+                     .momentum(0.9)
+                     .weight_decay(0.01)
+                     .nesterov(true);
+  auto ref_options = ::torch::optim::SGDOptions(0.1)
+                         .momentum(0.9)
+                         .weight_decay(0.01)
+                         .nesterov(true);
+  auto p = torch::ones({4}, at::requires_grad());
+  auto ref_p = torch::ones({4}, at::requires_grad());
+  ::torch::jit::mobile::SGD optimizer(std::vector<at::Tensor>{p}, options);
+  ::torch::optim::SGD ref_optimizer(
+      std::vector<at::Tensor>{ref_p}, ref_options);
+
+  const void* data = p.data_ptr();
+  for (int step = 0; step < 5; ++step) {
+    auto x = torch::arange(4, at::kFloat) + step;
+    optimizer.zero_grad();
+    (p * x).sum().backward();
+    optimizer.step();
+    ref_optimizer.zero_grad();
+    (ref_p * x).sum().backward();
+    ref_optimizer.step();
+    // The parameters are updated in place.
+    AT_ASSERT(p.data_ptr() == data);
+    AT_ASSERT(p.allclose(ref_p));
+  }
+}
+
 } // namespace jit
 } // namespace torch
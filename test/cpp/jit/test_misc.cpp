@@ -929,6 +929,38 @@ void testRecordFunction() {
   TORCH_CHECK(sampled_cb_ctr == 1000);
   clearCallbacks();
 
+  // test callbacks sampled every n-th RecordFunction
+  int every_cb_ctr = 0;
+  addGlobalCallback(RecordFunctionCallback(
+                        [&every_cb_ctr](const RecordFunction& fn) {
+                          ++every_cb_ctr;
+                        },
+                        [](const RecordFunction&) {})
+                        .samplingEvery(10));
+  for (auto k = 0; k < 1000; k++) {
+    RECORD_USER_SCOPE("test");
+  }
+  TORCH_CHECK(every_cb_ctr == 100);
+
+  // a callback picked for a scope it doesn't observe runs on the next
+  // RecordFunction of a scope it observes
+  clearCallbacks();
+  every_cb_ctr = 0;
+  addGlobalCallback(RecordFunctionCallback(
+                        [&every_cb_ctr](const RecordFunction& fn) {
+                          ++every_cb_ctr;
+                        },
+                        [](const RecordFunction&) {})
+                        .samplingEvery(10)
+                        .scopes({RecordScope::USER_SCOPE}));
+  for (auto k = 0; k < 20; k++) {
+    RECORD_FUNCTION("not_observed", std::vector<c10::IValue>());
+  }
+  TORCH_CHECK(every_cb_ctr == 0);
+  { RECORD_USER_SCOPE("test"); }
+  TORCH_CHECK(every_cb_ctr == 1);
+  clearCallbacks();
+
   // test the scope of the callbacks
   checkScopeCallbacks();
   clearCallbacks();
@@ -5,6 +5,7 @@
 #include <torch/csrc/jit/serialization/export.h>
 #include <torch/csrc/jit/serialization/import.h>
 #include <torch/csrc/jit/serialization/import_source.h>
+#include <torch/csrc/jit/serialization/storage_registry.h>
 #include <torch/torch.h>
 
 #include "caffe2/serialize/istream_adapter.h"
@@ -121,5 +122,108 @@ void testTypeTags() {
   }
 }
 
+void testPickleLargeDict() {
+  auto dict = c10::Dict<std::string, at::Tensor>();
+  auto list = c10::impl::GenericList(AnyType::get());
+  for (int64_t i = 0; i < 10000; i++) {
+    dict.insert("state." + std::to_string(i), torch::full({2}, i));
+    list.push_back(c10::ivalue::Tuple::create({i, "step"}));
+  }
+  auto loaded = torch::pickle_load(
+      torch::pickle_save(c10::ivalue::Tuple::create({dict, list})));
+  const auto& elements = loaded.toTuple()->elements();
+  auto loaded_dict = elements.at(0).toGenericDict();
+  ASSERT_EQ(loaded_dict.size(), dict.size());
+  int64_t i = 0;
+  // The items keep their order.
+  for (const auto& item : loaded_dict) {
+    ASSERT_EQ(item.key().toStringRef(), "state." + std::to_string(i));
+    ASSERT_TRUE(item.value().toTensor().equal(torch::full({2}, i)));
+    i++;
+  }
+  auto loaded_list = elements.at(1).toListRef();
+  ASSERT_EQ(loaded_list.size(), list.size());
+  for (size_t j = 0; j < loaded_list.size(); j++) {
+    const auto& item = loaded_list[j].toTuple()->elements();
+    ASSERT_EQ(item.at(0).toInt(), static_cast<int64_t>(j));
+    ASSERT_EQ(item.at(1).toStringRef(), "step");
+  }
+}
+
+void testLoadMmap() {
+#ifndef _WIN32
+  Module m("m");
+  m.register_parameter("weight", torch::arange(1024.), false);
+  m.define(R"(
+    def forward(self, x):
+        return x + self.weight
+  )");
+  std::string path = "load_mmap_test.pt";
+  m.save(path);
+  {
+    auto loaded = torch::jit::load_mmap(path);
+    auto weight = loaded.attr("weight").toTensor();
+    ASSERT_TRUE(weight.equal(torch::arange(1024.)));
+    auto x = torch::ones({1024});
+    ASSERT_TRUE(loaded.forward({x}).toTensor().equal(x + weight));
+    // The mapping is private, so writing to the tensors doesn't change the
+    // file.
+    weight.zero_();
+  }
+  auto loaded = torch::jit::load_mmap(path);
+  ASSERT_TRUE(
+      loaded.attr("weight").toTensor().equal(torch::arange(1024.)));
+  std::remove(path.c_str());
+#endif
+}
+
+void testSharedStorages() {
+#ifdef __linux__
+  auto save = [](const at::Tensor& weight) {
+    Module m("m");
+    m.register_parameter("weight", weight, false);
+    m.register_parameter("bias", torch::ones({4}), false);
+    std::stringstream ss;
+    m.save(ss);
+    return ss;
+  };
+  auto base = torch::arange(4096.);
+  auto ss1 = save(base);
+  auto ss2 = save(base.clone());
+  auto ss3 = save(base + 1);
+
+  bool enabled = setStorageSharingEnabled(true);
+  auto before = getSharedStorageStats();
+  {
+    auto m1 = torch::jit::load(ss1);
+    auto m2 = torch::jit::load(ss2);
+    auto m3 = torch::jit::load(ss3);
+    auto w1 = m1.attr("weight").toTensor();
+    auto w2 = m2.attr("weight").toTensor();
+    auto w3 = m3.attr("weight").toTensor();
+    ASSERT_TRUE(w1.equal(base));
+    ASSERT_TRUE(w3.equal(base + 1));
+
+    // The biases are too small to be shared.
+    auto stats = getSharedStorageStats();
+    ASSERT_EQ(stats.num_records - before.num_records, 2);
+    ASSERT_EQ(stats.num_references - before.num_references, 3);
+    ASSERT_EQ(
+        stats.bytes_saved - before.bytes_saved,
+        static_cast<int64_t>(base.nbytes()));
+
+    // Writing to a shared storage copies it.
+    w1.zero_();
+    ASSERT_TRUE(w2.equal(base));
+    auto m4 = torch::jit::load(ss2);
+    ASSERT_TRUE(m4.attr("weight").toTensor().equal(base));
+  }
+  auto after = getSharedStorageStats();
+  ASSERT_EQ(after.num_records, before.num_records);
+  ASSERT_EQ(after.bytes_saved, before.bytes_saved);
+  setStorageSharingEnabled(enabled);
+#endif
+}
+
 } // namespace jit
 } // namespace torch
@@ -69,6 +69,9 @@ namespace jit {
   _(ScriptObject)                                 \
   _(ExtraFilesHookPreference)                     \
   _(SaveExtraFilesHook)                           \
+  _(LoadMmap)                                     \
+  _(SharedStorages)                               \
+  _(PickleLargeDict)                              \
   _(TypeTags)                                     \
   _(DCE)                                          \
   _(CustomFusionNestedBlocks)                     \
@@ -79,7 +82,10 @@ namespace jit {
   _(ClassTypeAddRemoveAttr)                       \
   _(Inliner)                                      \
   _(LiteInterpreterAdd)                           \
+  _(LiteInterpreterCompressedTensors)             \
   _(LiteInterpreterConv)                          \
+  _(LiteInterpreterSharedOperators)               \
+  _(LiteInterpreterMemoryPlan)                    \
   _(LiteInterpreterInline)                        \
   _(LiteInterpreterTuple)                         \
   _(LiteInterpreterUpsampleNearest2d)             \
@@ -108,7 +114,10 @@ namespace jit {
   _(MobileNamedParameters)                        \
   _(MobileSaveLoadData)                           \
   _(LiteSGD)                                      \
-  _(FusionAliasing)
+  _(LiteSGDInPlace)                               \
+  _(FusionAliasing)                               \
+  _(InterpreterSuperinstructions)                 \
+  _(InterpreterUnpackSharedContainers)
 
 #if defined(USE_CUDA)
 #define TH_FORALL_TESTS_CUDA(_)   \
@@ -179,7 +188,8 @@ namespace jit {
   _(GPU_FusionZeroDimComputeAt)   \
   _(GPU_FusionZeroDimBroadcast)   \
   _(GPU_FusionZeroDimReduction)   \
-  _(GPU_FusionReductionMultiConsumer)
+  _(GPU_FusionReductionMultiConsumer) \
+  _(GPU_FusionVectorizePointwise)
 #else
 #define TH_FORALL_TESTS_CUDA(_) \
   _(ArgumentSpec)               \
@@ -34,6 +34,31 @@ TEST(WireSerialize, Base) {
   run("", {torch::randn({5, 5})});
   run("hi", {torch::randn({5, 5})});
   run("more", {torch::randn({5, 5}), torch::rand({10, 10})});
+  // Not contiguous, so not sent in the compact format.
+  run("hi", {torch::randn({5, 5}).t()});
+  run("mixed", {torch::randn({5, 5}), torch::randn({4, 6}).t()});
+}
+
+TEST(WireSerialize, Compact) {
+  std::vector<at::Tensor> tensors = {
+      torch::arange(10, torch::kInt64),
+      torch::randn({2, 3}).requires_grad_(),
+      torch::zeros({0, 4}),
+      torch::tensor(true)};
+  auto ser = torch::distributed::rpc::wireSerialize({'h', 'i'}, tensors);
+  EXPECT_EQ(ser[0], '\0');
+  auto deser = torch::distributed::rpc::wireDeserialize(ser.data(), ser.size());
+  EXPECT_EQ(std::string(deser.first.begin(), deser.first.end()), "hi");
+  ASSERT_EQ(deser.second.size(), tensors.size());
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    EXPECT_EQ(deser.second[i].scalar_type(), tensors[i].scalar_type());
+    EXPECT_EQ(deser.second[i].sizes(), tensors[i].sizes());
+    EXPECT_EQ(deser.second[i].requires_grad(), tensors[i].requires_grad());
+    EXPECT_TRUE(torch::equal(deser.second[i], tensors[i]));
+  }
+  EXPECT_THROW(
+      torch::distributed::rpc::wireDeserialize(ser.data(), ser.size() - 1),
+      std::runtime_error);
 }
 
 TEST(WireSerialize, RecopySparseTensors) {
@@ -447,6 +447,34 @@ void testBoundsInferenceAdjacent() {
   }
 }
 
+void testBoundsInferenceManyLoops() {
+  KernelScope kernel_scope;
+  // A block of loops, each of which reads a shifted window of a; the bounds
+  // of every loop only cover its own accesses.
+  const int kLoops = 16;
+  ExprHandle H(6);
+  Buffer a(BufHandle("a", {6 + kLoops}, kFloat));
+  std::vector<Tensor*> outputs;
+  for (int i = 0; i < kLoops; i++) {
+    outputs.push_back(Compute(
+        "b" + std::to_string(i), {{H, "x"}}, [&](const VarHandle& x) {
+          return a(x + i);
+        }));
+  }
+  LoopNest l(outputs);
+
+  auto bounds_info = inferBounds(l.root_stmt());
+  ASSERT_EQ(bounds_info.size(), kLoops + 1);
+  ASSERT_EQ(bounds_info.at(a.data()).size(), 1);
+  ASSERT_EQ(bounds_info.at(a.data())[0].kind, kLoad);
+  verifyConstBounds(bounds_info.at(a.data())[0], {{0, 5 + kLoops - 1}});
+  for (Tensor* b : outputs) {
+    ASSERT_EQ(bounds_info.at(b->buf()).size(), 1);
+    ASSERT_EQ(bounds_info.at(b->buf())[0].kind, kStore);
+    verifyConstBounds(bounds_info.at(b->buf())[0], {{0, 5}});
+  }
+}
+
 void testMergeInferredBounds() {
   KernelScope kernel_scope;
   Buffer a(BufHandle("a", {10}, kFloat));
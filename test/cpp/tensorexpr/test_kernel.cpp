@@ -1,6 +1,7 @@
 #include <test/cpp/tensorexpr/test_base.h>
 #include <torch/csrc/jit/ir/ir.h>
 #include <torch/csrc/jit/ir/irparser.h>
+#include <torch/csrc/jit/tensorexpr/aot_codegen.h>
 #include <torch/csrc/jit/tensorexpr/buffer.h>
 #include <torch/csrc/jit/tensorexpr/kernel.h>
 #include <torch/csrc/jit/tensorexpr/loopnest.h>
@@ -261,5 +262,98 @@ void testKernel_4() {
   }
 }
 
+void testKernel_5() {
+  // Test that the output is written into the buffer of an input that dies
+  // with the kernel, and only then.
+  KernelScope kernel_scope;
+
+  const auto graph_string = R"IR(
+      graph(%0 : Float(5:3,3:1, device=cpu),
+            %1 : Float(5:3,3:1, device=cpu)):
+        %2 : Float(5:3,3:1) = aten::mul(%0, %1)
+        %3 : Float(5:3,3:1) = aten::relu(%2)
+        return (%3))IR";
+  auto graph = std::make_shared<Graph>();
+  parseIR(graph_string, &*graph);
+
+  auto a = at::rand({5, 3}, TensorOptions(kCPU).dtype(at::kFloat)) - 0.5;
+  auto b = at::rand({5, 3}, TensorOptions(kCPU).dtype(at::kFloat));
+  auto ref = at::relu(a * b);
+  TensorExprKernel k(graph);
+
+  std::vector<IValue> stack = {a, b};
+  k.run(stack);
+  auto o = stack[0].toTensor();
+  ASSERT_NE(o.data_ptr(), a.data_ptr());
+  ASSERT_TRUE(at::equal(o, ref));
+
+  stack = {a.clone(), b};
+  void* inputPtr = stack[0].toTensor().data_ptr();
+  k.run(stack);
+  o = stack[0].toTensor();
+  ASSERT_EQ(o.data_ptr(), inputPtr);
+  ASSERT_TRUE(at::equal(o, ref));
+}
+
+void testKernel_6() {
+  // Test that the loop nests of outputs over the same ranges are fused.
+  KernelScope kernel_scope;
+
+  const auto graph_string = R"IR(
+      graph(%0 : Float(5:3,3:1, device=cpu),
+            %1 : Float(5:3,3:1, device=cpu)):
+        %2 : Float(5:3,3:1) = aten::relu(%0)
+        %3 : Float(5:3,3:1) = aten::mul(%0, %1)
+        return (%2, %3))IR";
+  auto graph = std::make_shared<Graph>();
+  parseIR(graph_string, &*graph);
+
+  auto a = at::rand({5, 3}, TensorOptions(kCPU).dtype(at::kFloat)) - 0.5;
+  auto b = at::rand({5, 3}, TensorOptions(kCPU).dtype(at::kFloat));
+  TensorExprKernel k(graph);
+  Stmt* s = k.getCodeGenStmt();
+  Block* root = dynamic_cast<Block*>(s);
+  ASSERT_EQ(root ? root->nstmts() : 1, 1);
+
+  std::vector<IValue> stack = {a, b};
+  k.run(stack);
+  ASSERT_TRUE(at::equal(stack[0].toTensor(), at::relu(a)));
+  ASSERT_TRUE(at::equal(stack[1].toTensor(), a * b));
+}
+
+void testKernel_7() {
+  // Test that the kernels compiled ahead of time are named after their IR,
+  // and that a kernel the library doesn't hold doesn't lower.
+  KernelScope kernel_scope;
+
+  const auto graph_string = R"IR(
+      graph(%0 : Float(5:3,3:1, device=cpu),
+            %1 : Float(5:3,3:1, device=cpu)):
+        %2 : Float(5:3,3:1) = aten::mul(%0, %1)
+        return (%2))IR";
+  const auto other_graph_string = R"IR(
+      graph(%0 : Float(5:3,3:1, device=cpu),
+            %1 : Float(5:3,3:1, device=cpu)):
+        %2 : int = prim::Constant[value=1]()
+        %3 : Float(5:3,3:1) = aten::add(%0, %1, %2)
+        return (%3))IR";
+  auto kernelName = [](const std::string& str) {
+    auto graph = std::make_shared<Graph>();
+    parseIR(str, &*graph);
+    TensorExprKernel k(graph);
+    return aotKernelName(k.getCodeGenStmt(), k.getCodeGenArgs());
+  };
+  auto name = kernelName(graph_string);
+  ASSERT_EQ(name, kernelName(graph_string));
+  ASSERT_NE(name, kernelName(other_graph_string));
+
+  auto library = std::make_shared<AotKernelLibrary>("");
+  ASSERT_EQ(library->find(name), nullptr);
+  AotKernelLibraryGuard guard(library);
+  auto graph = std::make_shared<Graph>();
+  parseIR(graph_string, &*graph);
+  ASSERT_THROWS_WITH(TensorExprKernel k(graph), "has no kernel");
+}
+
 } // namespace jit
 } // namespace torch
@@ -13,6 +13,8 @@
 #include "torch/csrc/jit/tensorexpr/loopnest.h"
 #include "torch/csrc/jit/tensorexpr/tensor.h"
 
+#include <cmath>
+#include <limits>
 #include <numeric>
 
 namespace torch {
@@ -151,6 +153,57 @@ void testLLVMHalfToLongCastTest() {
   ASSERT_EQ(cg.value<int64_t>(), 2);
 }
 
+void testLLVMBFloat16CastTest() {
+  KernelScope kernel_scope;
+  constexpr int N = 8;
+  Buffer a(BufHandle("A", {N}, kFloat));
+  Buffer b(BufHandle("B", {N}, kBFloat16));
+  Buffer c(BufHandle("C", {N}, kFloat));
+  // The values round to the nearest BFloat16, ties to even.
+  std::vector<float> a_buffer = {0.f,
+                                 1.f,
+                                 -2.5f,
+                                 1.00390625f,
+                                 1.01171875f,
+                                 3.14159f,
+                                 1e30f,
+                                 std::numeric_limits<float>::quiet_NaN()};
+  std::vector<at::BFloat16> b_buffer(N);
+  std::vector<float> c_buffer(N);
+
+  auto mask = IntImm::make(1);
+  VarHandle i("i", kInt);
+  VarHandle j("j", kInt);
+  auto expr = Block::make(
+      {For::make(
+           i,
+           0,
+           N,
+           Store::make(
+               b, {i}, Cast::make(kBFloat16, Load::make(a, {i}, mask)), mask)),
+       For::make(
+           j,
+           0,
+           N,
+           Store::make(
+               c, {j}, Cast::make(kFloat, Load::make(b, {j}, mask)), mask))});
+
+  LLVMCodeGen cg(expr, {a, b, c});
+
+  std::vector<void*> args({a_buffer.data(), b_buffer.data(), c_buffer.data()});
+  ASSERT_EQ(cg.value<int>(args), 0);
+
+  for (int k = 0; k < N; k++) {
+    at::BFloat16 ref(a_buffer[k]);
+    ASSERT_EQ(b_buffer[k].x, ref.x);
+    if (std::isnan(a_buffer[k])) {
+      ASSERT_TRUE(std::isnan(c_buffer[k]));
+    } else {
+      ASSERT_EQ(c_buffer[k], static_cast<float>(ref));
+    }
+  }
+}
+
 void testLLVMByteToDoubleCastTest() {
   KernelScope kernel_scope;
   auto a = ByteImm::make(2);
@@ -324,6 +377,24 @@ void testLLVMVecLoadStoreTest() {
   ASSERT_EQ(b_buffer[3], 1);
 }
 
+void testLLVMCompileToObjectCodeTest() {
+  KernelScope kernel_scope;
+  Buffer a(BufHandle("A", {8}, kFloat));
+  Buffer b(BufHandle("B", {8}, kFloat));
+  auto store = Store::make(
+      b,
+      {Ramp::make(0, 1, 8)},
+      acos(Load::make(
+          a, {Ramp::make(0, 1, 8)}, Broadcast::make(IntImm::make(1), 8))),
+      Broadcast::make(IntImm::make(1), 8));
+  std::string object = compileToObjectCode(store, {a, b}, "test_aot_kernel");
+  ASSERT_FALSE(object.empty());
+  // The object exports the kernel, and calls the math library rather than
+  // the Sleef functions only the JIT knows.
+  ASSERT_NE(object.find("test_aot_kernel"), std::string::npos);
+  ASSERT_EQ(object.find("Sleef_"), std::string::npos);
+}
+
 #define FLOAT_INTRINSICS_TEST(Name, Lanes)                       \
   void testLLVMVecFloat_##Name##Lane##Lanes##Test() {            \
     KernelScope kernel_scope;                                    \
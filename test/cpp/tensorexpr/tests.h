@@ -197,6 +197,7 @@ namespace jit {
   _(BoundsInference_6)                      \
   _(BoundsInferenceNonOverlapping)          \
   _(BoundsInferenceAdjacent)                \
+  _(BoundsInferenceManyLoops)               \
   _(MergeInferredBounds)                    \
   _(MergeInferredLoadStoreDiff)             \
   _(MergeInferred2DBounds)                  \
@@ -229,6 +230,9 @@ namespace jit {
   _(Kernel_2)                               \
   _(Kernel_3)                               \
   _(Kernel_4)                               \
+  _(Kernel_5)                               \
+  _(Kernel_6)                               \
+  _(Kernel_7)                               \
   _(FuserPass_1)                            \
   _(FuserPass_2)                            \
   _(TrainBasic)
@@ -279,6 +283,8 @@ namespace jit {
   _(LLVMIntToLongCastTest)                 \
   _(LLVMByteToCharCastTest)                \
   _(LLVMHalfToLongCastTest)                \
+  _(LLVMBFloat16CastTest)                  \
+  _(LLVMCompileToObjectCodeTest)           \
   _(LLVMByteToDoubleCastTest)              \
   _(LLVMLetTest01)                         \
   _(LLVMLetTest02)                         \
@@ -215,6 +215,17 @@ class StoreTestBase(object):
     def test_set_get(self):
         self._test_set_get(self._create_store())
 
+    def test_multi_get_set(self):
+        fs = self._create_store()
+        fs.multi_set(["mkey0", "mkey1", "mkey2"], ["value0", "value1", "value2"])
+        fs.set("mkey3", "value3")
+        self.assertEqual(
+            [b"value2", b"value0", b"value3"],
+            fs.multi_get(["mkey2", "mkey0", "mkey3"]))
+        self.assertEqual([], fs.multi_get([]))
+        with self.assertRaisesRegex(ValueError, "as many values as keys"):
+            fs.multi_set(["mkey0", "mkey1"], ["value0"])
+
 
 class FileStoreTest(TestCase, StoreTestBase):
     def setUp(self):
@@ -273,6 +284,25 @@ class TCPStoreTest(TestCase, StoreTestBase):
             store1 = c10d.TCPStore(addr, port, 1, True)  # noqa: F841
             store2 = c10d.TCPStore(addr, port, 1, True)  # noqa: F841
 
+    def test_compare_set(self):
+        store = self._create_store()
+        # A missing key is only set when an empty value is expected
+        self.assertEqual(b"", store.compare_set("cs_key", "old", "new"))
+        self.assertEqual(b"first", store.compare_set("cs_key", "", "first"))
+        self.assertEqual(b"first", store.compare_set("cs_key", "other", "second"))
+        self.assertEqual(b"second", store.compare_set("cs_key", "first", "second"))
+        self.assertEqual(b"second", store.get("cs_key"))
+
+    def test_server_stats(self):
+        store = self._create_store()
+        store.set("key", "value")
+        store.multi_get(["key", "key"])
+        stats = store._server_stats()
+        self.assertGreaterEqual(stats["set"]["count"], 1)
+        self.assertEqual(1, stats["multi_get"]["count"])
+        self.assertGreaterEqual(
+            stats["multi_get"]["total_us"], stats["multi_get"]["max_us"])
+
 
 class PrefixTCPStoreTest(TestCase, StoreTestBase):
     def setUp(self):
@@ -799,6 +829,34 @@ class ProcessGroupGlooTest(MultiProcessTestCase):
     def test_allreduce_basics_cuda(self):
         self._test_allreduce_basics(lambda t: t.clone().cuda())
 
+    def test_hierarchical_collectives(self):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        opts = self.opts()
+        opts.hierarchical = True
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, opts)
+
+        x = torch.tensor([self.rank + 1.0, 2 * self.rank])
+        pg.allreduce(x).wait()
+        self.assertEqual(
+            torch.tensor([
+                self.world_size * (self.world_size + 1) / 2.0,
+                self.world_size * (self.world_size - 1.0),
+            ]),
+            x,
+        )
+
+        outputs = [[torch.zeros(2) for _ in range(self.world_size)]]
+        pg.allgather(outputs, [torch.tensor([self.rank, -self.rank]).float()]).wait()
+        for rank, output in enumerate(outputs[0]):
+            self.assertEqual(torch.tensor([rank, -rank]).float(), output)
+
+        for root in range(self.world_size):
+            opts = c10d.BroadcastOptions()
+            opts.rootRank = root
+            x = torch.tensor([self.rank])
+            pg.broadcast([x], opts).wait()
+            self.assertEqual(torch.tensor([root]), x)
+
     def _test_allreduce_stress(self, inputs):
         store = c10d.FileStore(self.file_name, self.world_size)
         pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts(threads=8))
@@ -1598,6 +1656,27 @@ class ProcessGroupNCCLTest(TestCase):
         pg.reduce_scatter(ys, xs).wait()
         self.assertEqual(0, ys[0].numel())
 
+    def test_options(self):
+        store = c10d.FileStore(self.file.name, self.world_size)
+        opts = c10d.ProcessGroupNCCL.Options()
+        self.assertFalse(opts.is_high_priority_stream)
+        self.assertEqual(-1, opts.min_channels)
+        self.assertEqual(-1, opts.max_channels)
+        opts.is_high_priority_stream = True
+        opts.eager_init_devices = [torch.device("cuda", i) for i in range(self.num_gpus)]
+        pg = c10d.ProcessGroupNCCL(store, self.rank, self.world_size, opts)
+
+        tensors = [torch.tensor([i + 1]).cuda(i) for i in range(self.num_gpus)]
+        pg.allreduce(tensors).wait()
+        for i in range(self.num_gpus):
+            self.assertEqual(torch.tensor([self.num_gpus * (self.num_gpus + 1) // 2]), tensors[i])
+
+        opts = c10d.ProcessGroupNCCL.Options()
+        opts.min_channels = 4
+        opts.max_channels = 2
+        with self.assertRaisesRegex(RuntimeError, "must not exceed maxChannels|requires NCCL 2.17"):
+            c10d.ProcessGroupNCCL(store, self.rank, self.world_size, opts)
+
     def test_broadcast_ops(self):
         store = c10d.FileStore(self.file.name, self.world_size)
         pg = c10d.ProcessGroupNCCL(store, self.rank, self.world_size)
@@ -1681,6 +1760,55 @@ class ProcessGroupNCCLTest(TestCase):
             with self.assertRaisesRegex(RuntimeError, "Cannot use " + str(op) + " with NCCL"):
                 allreduce(tensors, op)
 
+    def test_allreduce_coalesced_ops(self):
+        store = c10d.FileStore(self.file.name, self.world_size)
+        pg = c10d.ProcessGroupNCCL(store, self.rank, self.world_size)
+
+        # Tensors of different shapes and types, on a single device.
+        tensors = [
+            torch.ones(3, device="cuda:0"),
+            torch.full((2, 2), 2, dtype=torch.double, device="cuda:0"),
+            torch.arange(4, dtype=torch.long, device="cuda:0"),
+        ]
+        expected = [t * self.world_size for t in tensors]
+        opts = c10d.AllreduceCoalescedOptions()
+        pg.allreduce_coalesced(tensors, opts).wait()
+        self.assertEqual(expected, tensors)
+
+        with self.assertRaisesRegex(RuntimeError, "same device"):
+            pg.allreduce_coalesced([torch.ones(1, device="cuda:0"),
+                                    torch.ones(1, device="cuda:1")], opts)
+
+    def test_coalesced_collectives(self):
+        store = c10d.FileStore(self.file.name, self.world_size)
+        pg = c10d.ProcessGroupNCCL(store, self.rank, self.world_size)
+
+        xs = [torch.tensor([i + 1]).cuda(i) for i in range(self.num_gpus)]
+        ys = [torch.tensor([float(i)]).cuda(i) for i in range(self.num_gpus)]
+        pg._start_coalescing()
+        xs_work = pg.allreduce(xs)
+        ys_work = pg.broadcast(ys)
+        with self.assertRaisesRegex(RuntimeError, "after the endCoalescing"):
+            xs_work.wait()
+        work = pg._end_coalescing()
+        work.wait()
+        # The works of the collectives are valid too.
+        xs_work.wait()
+        ys_work.wait()
+
+        for i in range(self.num_gpus):
+            self.assertEqual(torch.tensor([self.num_gpus * (self.num_gpus + 1) // 2]), xs[i])
+            self.assertEqual(torch.tensor([0.]), ys[i])
+
+        pg._start_coalescing()
+        pg.allreduce(xs)
+        with self.assertRaisesRegex(RuntimeError, "same devices"):
+            pg.allreduce([xs[0]])
+        pg._end_coalescing().wait()
+
+        with self.assertRaisesRegex(RuntimeError, "without a matching startCoalescing"):
+            pg._end_coalescing()
+
     def test_reduce_ops(self):
         store = c10d.FileStore(self.file.name, self.world_size)
         pg = c10d.ProcessGroupNCCL(store, self.rank, self.world_size)
@@ -1974,13 +2102,15 @@ class DistributedDataParallelTest(MultiProcessTestCase):
     def world_size(self):
         return 2
 
-    def _prepare_single_device_module(self, process_group, devices, device_ids, global_batch_size):
+    def _prepare_single_device_module(
+            self, process_group, devices, device_ids, global_batch_size, gradient_as_bucket_view=False):
         model = Net()
         ddp_model = DistributedDataParallel(
             copy.deepcopy(model).to(devices[0]),
             device_ids=device_ids,
             process_group=process_group,
-            bucket_cap_mb=0.001)
+            bucket_cap_mb=0.001,
+            gradient_as_bucket_view=gradient_as_bucket_view)
 
         model.to(devices[0])
 
@@ -1989,7 +2119,8 @@ class DistributedDataParallelTest(MultiProcessTestCase):
 
         return model, ddp_model, input, target
 
-    def _prepare_multi_device_module(self, process_group, devices, device_ids, global_batch_size):
+    def _prepare_multi_device_module(
+            self, process_group, devices, device_ids, global_batch_size, gradient_as_bucket_view=False):
         self.assertTrue(
             len(devices) == 2 or len(devices) == 4,
             "unexpected devices for ddp tests {}".format(devices))
@@ -2002,14 +2133,16 @@ class DistributedDataParallelTest(MultiProcessTestCase):
             copy.deepcopy(model),
             device_ids=device_ids,
             process_group=process_group,
-            bucket_cap_mb=0.001)
+            bucket_cap_mb=0.001,
+            gradient_as_bucket_view=gradient_as_bucket_view)
 
         input = torch.randn(global_batch_size, 2).cuda(devices[0])
         target = torch.randn(global_batch_size, 4)
 
         return model, ddp_model, input, target
 
-    def _test_ddp_with_process_group(self, process_group, devices, device_ids, multi_device=False):
+    def _test_ddp_with_process_group(
+            self, process_group, devices, device_ids, multi_device=False, gradient_as_bucket_view=False):
         """
         Note: we pass down `device_ids` all the way to DistributedDataParallel
         as part of the test. Below you find tests that either use a list of
@@ -2023,11 +2156,11 @@ class DistributedDataParallelTest(MultiProcessTestCase):
         if multi_device:
             model, ddp_model, input, target = \
                 self._prepare_multi_device_module(
-                    process_group, devices, device_ids, global_batch_size)
+                    process_group, devices, device_ids, global_batch_size, gradient_as_bucket_view)
         else:
             model, ddp_model, input, target = \
                 self._prepare_single_device_module(
-                    process_group, devices, device_ids, global_batch_size)
+                    process_group, devices, device_ids, global_batch_size, gradient_as_bucket_view)
 
         def step_model(model, input, target):
             model.train()
@@ -2062,17 +2195,22 @@ class DistributedDataParallelTest(MultiProcessTestCase):
             torch.manual_seed(1337 + iteration)
             input = input[torch.randperm(global_batch_size)]
 
-    def _test_gloo_backend(self, devices, device_ids, multi_device=False):
+    def _test_gloo_backend(self, devices, device_ids, multi_device=False, gradient_as_bucket_view=False):
         store = c10d.FileStore(self.file_name, self.world_size)
         options = c10d.ProcessGroupGloo.Options()
         options.devices = [c10d.ProcessGroupGloo.create_device(interface=LOOPBACK)]
         process_group = c10d.ProcessGroupGloo(store, self.rank, self.world_size, options)
-        self._test_ddp_with_process_group(process_group, devices, device_ids, multi_device)
+        self._test_ddp_with_process_group(
+            process_group, devices, device_ids, multi_device, gradient_as_bucket_view)
 
     @requires_gloo()
     def test_gloo_backend_cpu_module(self):
         self._test_gloo_backend([torch.device('cpu')], [])
 
+    @requires_gloo()
+    def test_gloo_backend_cpu_module_grad_is_view(self):
+        self._test_gloo_backend([torch.device('cpu')], [], gradient_as_bucket_view=True)
+
     @requires_gloo()
     @skip_if_not_multigpu
     def test_gloo_backend_1gpu_module_device_ids_integer_list(self):
@@ -2101,10 +2239,11 @@ class DistributedDataParallelTest(MultiProcessTestCase):
         devices = list([torch.device('cuda:' + str(i)) for i in int_devices])
         self._test_gloo_backend(devices, [], multi_device=True)
 
-    def _test_nccl_backend(self, devices, device_ids, multi_device=False):
+    def _test_nccl_backend(self, devices, device_ids, multi_device=False, gradient_as_bucket_view=False):
         store = c10d.FileStore(self.file_name, self.world_size)
         process_group = c10d.ProcessGroupNCCL(store, self.rank, self.world_size)
-        self._test_ddp_with_process_group(process_group, devices, device_ids, multi_device)
+        self._test_ddp_with_process_group(
+            process_group, devices, device_ids, multi_device, gradient_as_bucket_view)
 
     @requires_nccl()
     @skip_if_not_multigpu
@@ -2120,6 +2259,13 @@ class DistributedDataParallelTest(MultiProcessTestCase):
         devices = list([torch.device('cuda:' + str(i)) for i in int_devices])
         self._test_nccl_backend(devices, devices)
 
+    @requires_nccl()
+    @skip_if_not_multigpu
+    def test_nccl_backend_1gpu_module_grad_is_view(self):
+        int_devices = gpus_for_rank(self.world_size)[self.rank][:1]
+        devices = list([torch.device('cuda:' + str(i)) for i in int_devices])
+        self._test_nccl_backend(devices, int_devices, gradient_as_bucket_view=True)
+
     @requires_nccl()
     @skip_if_lt_x_gpu(4)
     def test_nccl_backend_2gpu_module(self):
@@ -3250,6 +3396,95 @@ class DistributedDataParallelTest(MultiProcessTestCase):
         ):
             model._register_comm_hook(None, dummy_hook)
 
+    @requires_gloo()
+    def test_ddp_builtin_comm_hooks_cpu(self):
+        """
+        The gradients of TestDdpCommHook are the same on every rank and of rank
+        one, so the allreduce, fp16 and PowerSGD hooks must give the exact
+        average, and so must the top-k hook when it sends every entry.
+        """
+        store = c10d.FileStore(self.file_name, self.world_size)
+        process_group = c10d.ProcessGroupGloo(store, self.rank, self.world_size)
+
+        for comm_hook_type in [
+            dist.BuiltinCommHookType.ALLREDUCE,
+            dist.BuiltinCommHookType.FP16_COMPRESS,
+            dist.BuiltinCommHookType.POWER_SGD,
+            dist.BuiltinCommHookType.TOP_K,
+        ]:
+            cpu_model = DistributedDataParallel(
+                TestDdpCommHook().cpu(), process_group=process_group
+            )
+            cpu_model._register_builtin_comm_hook(comm_hook_type, topk_ratio=1.0)
+            # Twice, to run with the error feedback of the first iteration.
+            for _ in range(2):
+                self._run_and_verify_hook(cpu_model, 8, 0.25 * torch.ones(2, 2))
+                cpu_model.zero_grad()
+
+    @requires_gloo()
+    def test_ddp_builtin_comm_hook_topk_cpu(self):
+        """
+        With a ratio of 1/4, the top-k hook only sends one of the four entries
+        of the bucket and keeps the others for the next iteration.
+        """
+        store = c10d.FileStore(self.file_name, self.world_size)
+        process_group = c10d.ProcessGroupGloo(store, self.rank, self.world_size)
+
+        cpu_model = DistributedDataParallel(
+            TestDdpCommHook().cpu(), process_group=process_group
+        )
+        cpu_model._register_builtin_comm_hook(
+            dist.BuiltinCommHookType.TOP_K, topk_ratio=0.25
+        )
+        output = cpu_model(8, self.rank)
+        output.mean().backward()
+        for p in cpu_model.parameters():
+            self.assertEqual(p.grad.sum().item(), 0.25)
+            # Every rank sends a single entry.
+            self.assertLessEqual((p.grad != 0).sum().item(), self.world_size)
+
+    @requires_nccl()
+    @skip_if_lt_x_gpu(2)
+    @skip_if_rocm
+    def test_ddp_builtin_comm_hooks_nccl(self):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        process_group = c10d.ProcessGroupNCCL(store, self.rank, self.world_size)
+
+        for comm_hook_type in [
+            dist.BuiltinCommHookType.ALLREDUCE,
+            dist.BuiltinCommHookType.FP16_COMPRESS,
+            dist.BuiltinCommHookType.BF16_COMPRESS,
+            dist.BuiltinCommHookType.POWER_SGD,
+        ]:
+            gpu_model = self._gpu_model_with_ddp_comm_hook(process_group)
+            gpu_model._register_builtin_comm_hook(comm_hook_type)
+            for _ in range(2):
+                self._run_and_verify_hook(gpu_model, 8, 0.25 * torch.ones(2, 2))
+                gpu_model.zero_grad()
+
+    @requires_gloo()
+    def test_ddp_invalid_builtin_comm_hook(self):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        process_group = c10d.ProcessGroupGloo(store, self.rank, self.world_size)
+
+        model = DistributedDataParallel(TestDdpCommHook(), process_group=process_group)
+
+        with self.assertRaisesRegex(RuntimeError, "PowerSGD rank must be at least 1"):
+            model._register_builtin_comm_hook(
+                dist.BuiltinCommHookType.POWER_SGD, powersgd_rank=0
+            )
+
+        with self.assertRaisesRegex(RuntimeError, "Top-k ratio must be in"):
+            model._register_builtin_comm_hook(
+                dist.BuiltinCommHookType.TOP_K, topk_ratio=1.5
+            )
+
+        model._register_builtin_comm_hook(dist.BuiltinCommHookType.ALLREDUCE)
+        with self.assertRaisesRegex(
+            RuntimeError, "register_comm_hook can only be called once."
+        ):
+            model._register_builtin_comm_hook(dist.BuiltinCommHookType.FP16_COMPRESS)
+
     @requires_gloo()
     def test_ddp_comm_hook_sparse_gradients(self):
         """
@@ -3377,6 +3612,36 @@ class ReducerTest(TestCase):
             for parameter in parameters:
                 self.assertEqual(parameters[0].grad, parameter.grad)
 
+    def _run_bucket_tuning(self, find_unused_parameters, use_fc3):
+        batch_size = 10
+        model = ReducerModule()
+        parameters = list(model.parameters())
+        reducer = dist.Reducer(
+            [parameters], [list(range(len(parameters)))], self.process_group,
+            find_unused_parameters=find_unused_parameters,
+            bucket_tuning_iterations=2)
+        loss = nn.CrossEntropyLoss()
+        for i in range(6):
+            input = torch.rand([batch_size, 2])
+            target = torch.LongTensor([random.randrange(4) for _ in range(batch_size)])
+            output = loss(model(input, use_fc3=use_fc3(i)), target)
+            reducer.prepare_for_backward(output)
+            output.backward()
+            # Every parameter is in exactly one bucket.
+            layout = reducer.get_bucket_layout()
+            self.assertEqual(list(range(len(parameters))), sorted(sum(layout, [])))
+        return reducer
+
+    def test_bucket_tuning(self):
+        reducer = self._run_bucket_tuning(False, lambda i: True)
+        # The tuned buckets follow the order in which the gradients are ready,
+        # starting with the one of the last layer.
+        self.assertEqual(2, reducer.get_bucket_layout()[0][0])
+
+    def test_bucket_tuning_unused_parameters(self):
+        # The set of used parameters changes after the first profile.
+        self._run_bucket_tuning(True, lambda i: i < 3)
+
     def test_forward_backward_unused_parameters(self):
         batch_size = 10
         model = self._create_mixed_precision_model()
@@ -3692,7 +3957,7 @@ class CommTest(MultiProcessTestCase):
     def world_size(self):
         return 2
 
-    def _test_broadcast_coalesced(self, process_group, device):
+    def _test_broadcast_coalesced(self, process_group, device, algorithm=None):
         half = torch.float16
 
         # No support for float16 for CPU tensors
@@ -3713,10 +3978,13 @@ class CommTest(MultiProcessTestCase):
         else:
             tensors = list(torch.empty_like(tensor) for tensor in target)
 
+        if algorithm is None:
+            algorithm = c10d.BroadcastAlgorithm.BROADCAST
         c10d._broadcast_coalesced(
             process_group,
             tensors,
-            buffer_size=256)
+            buffer_size=256,
+            algorithm=algorithm)
 
         self.assertEqual(tensors, target)
 
@@ -3747,6 +4015,16 @@ class CommTest(MultiProcessTestCase):
         device = torch.device('cpu')
         self._test_broadcast_coalesced(process_group, device)
 
+    @requires_gloo()
+    def test_broadcast_coalesced_scatter_allgather_gloo_cpu(self):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        options = c10d.ProcessGroupGloo.Options()
+        options.devices = [c10d.ProcessGroupGloo.create_device(interface=LOOPBACK)]
+        process_group = c10d.ProcessGroupGloo(store, self.rank, self.world_size, options)
+        device = torch.device('cpu')
+        self._test_broadcast_coalesced(
+            process_group, device, c10d.BroadcastAlgorithm.SCATTER_ALLGATHER)
+
 
 if __name__ == '__main__':
     assert not torch.cuda._initialized, "test_distributed must not have initialized CUDA context on main process"
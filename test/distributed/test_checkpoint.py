@@ -0,0 +1,133 @@
+import os
+import shutil
+import sys
+
+import torch
+import torch.distributed as dist
+
+if not dist.is_available():
+    print("Distributed not available, skipping tests", file=sys.stderr)
+    sys.exit(0)
+
+from torch.distributed.checkpoint import Shard, load_state_dict, save_state_dict
+from torch.testing._internal.common_distributed import MultiProcessTestCase, \
+    requires_gloo, requires_nccl, skip_if_lt_x_gpu
+from torch.testing._internal.common_utils import TestCase, run_tests, \
+    TEST_WITH_TSAN
+
+
+def _weight():
+    return torch.arange(12 * 5, dtype=torch.float32).view(12, 5)
+
+
+class ShardTest(TestCase):
+    def test_invalid(self):
+        with self.assertRaisesRegex(ValueError, "needs 2 offsets"):
+            Shard(torch.zeros(2, 2), [0], [4, 2])
+        with self.assertRaisesRegex(ValueError, "does not fit"):
+            Shard(torch.zeros(2, 2), [3, 0], [4, 2])
+
+
+class CheckpointTest(MultiProcessTestCase):
+    def setUp(self):
+        super(CheckpointTest, self).setUp()
+        self._fork_processes()
+
+    def tearDown(self):
+        super(CheckpointTest, self).tearDown()
+        try:
+            os.remove(self.file_name)
+        except OSError:
+            pass
+        shutil.rmtree(self.checkpoint_dir, ignore_errors=True)
+
+    @property
+    def world_size(self):
+        return 3
+
+    @property
+    def checkpoint_dir(self):
+        return self.file_name + "_checkpoint"
+
+    def _init(self, backend):
+        dist.init_process_group(
+            backend, init_method="file://{}".format(self.file_name),
+            rank=self.rank, world_size=self.world_size)
+
+    def _state_dict(self, device="cpu"):
+        # Every rank holds 4 rows of the weight and replicas of the bias.
+        weight = _weight().to(device)
+        return {
+            "weight": Shard(weight[self.rank * 4:(self.rank + 1) * 4].clone(),
+                            [self.rank * 4, 0], weight.size()),
+            "bias": torch.arange(7, dtype=torch.float64, device=device),
+            "running_mean": torch.ones(3, device=device),
+            "step": 10,
+        }
+
+    def _check_load(self, path):
+        # Load the 3 shards as 2 of 6 rows into a differently sharded state
+        # dict, or as the whole tensor on the last rank.
+        if self.rank < 2:
+            weight = Shard(torch.zeros(6, 5), [self.rank * 6, 0], [12, 5])
+        else:
+            weight = torch.zeros(12, 5)
+        state_dict = {
+            "weight": weight,
+            "bias": torch.zeros(7, dtype=torch.float64),
+            "step": None,
+        }
+        load_state_dict(state_dict, path)
+        if self.rank < 2:
+            self.assertEqual(weight.tensor, _weight()[self.rank * 6:(self.rank + 1) * 6])
+        else:
+            self.assertEqual(weight, _weight())
+        self.assertEqual(state_dict["bias"], torch.arange(7, dtype=torch.float64))
+        self.assertEqual(state_dict["step"], 10)
+
+    @requires_gloo()
+    def test_save_load(self):
+        self._init("gloo")
+        self.assertIsNone(save_state_dict(self._state_dict(), self.checkpoint_dir))
+        self._check_load(self.checkpoint_dir)
+
+        # Every rank writes a file of its own.
+        files = [name for name in os.listdir(self.checkpoint_dir) if name.endswith(".shards")]
+        self.assertEqual(sorted(files), ["rank_0.shards", "rank_1.shards", "rank_2.shards"])
+
+    @requires_gloo()
+    def test_async_save(self):
+        self._init("gloo")
+        state_dict = self._state_dict()
+        future = save_state_dict(state_dict, self.checkpoint_dir, async_save=True)
+        # The checkpoint holds the state at the time of the call.
+        state_dict["weight"].tensor.zero_()
+        state_dict["bias"].zero_()
+        future.wait()
+        self._check_load(self.checkpoint_dir)
+
+    @requires_gloo()
+    def test_load_errors(self):
+        self._init("gloo")
+        save_state_dict(self._state_dict(), self.checkpoint_dir)
+        with self.assertRaisesRegex(KeyError, "missing is not in the checkpoint"):
+            load_state_dict({"missing": torch.zeros(2)}, self.checkpoint_dir)
+        with self.assertRaisesRegex(ValueError, "has size"):
+            load_state_dict({"bias": torch.zeros(8)}, self.checkpoint_dir)
+        with self.assertRaisesRegex(RuntimeError, "does not hold a complete checkpoint"):
+            load_state_dict({}, os.path.join(self.checkpoint_dir, "missing"))
+
+    @requires_nccl()
+    @skip_if_lt_x_gpu(3)
+    def test_async_save_cuda(self):
+        torch.cuda.set_device(self.rank)
+        self._init("nccl")
+        future = save_state_dict(
+            self._state_dict("cuda:{}".format(self.rank)), self.checkpoint_dir, async_save=True)
+        future.wait()
+        self._check_load(self.checkpoint_dir)
+
+
+if __name__ == "__main__":
+    if not TEST_WITH_TSAN:
+        run_tests()
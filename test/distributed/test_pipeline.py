@@ -0,0 +1,221 @@
+import copy
+import os
+import sys
+
+import torch
+import torch.distributed as dist
+from torch import nn
+
+if not dist.is_available():
+    print("Distributed not available, skipping tests", file=sys.stderr)
+    sys.exit(0)
+
+from torch.distributed.pipeline import Pipe, partition, schedule, GPIPE, ONE_F_ONE_B
+from torch.testing._internal.common_distributed import MultiProcessTestCase, \
+    requires_gloo, requires_nccl, requires_nccl_version, skip_if_lt_x_gpu
+from torch.testing._internal.common_utils import TestCase, run_tests, \
+    TEST_WITH_TSAN
+
+
+def _model():
+    torch.manual_seed(0)
+    return nn.Sequential(
+        nn.Linear(8, 16),
+        nn.ReLU(),
+        nn.Dropout(0.5),
+        nn.Linear(16, 16),
+        nn.Tanh(),
+        nn.Linear(16, 4),
+    )
+
+
+class ScheduleTest(TestCase):
+    def test_gpipe(self):
+        steps = schedule(GPIPE, 1, 4, 3)
+        self.assertEqual(
+            [(s.kind, s.micro_batch) for s in steps],
+            [("forward", 0), ("forward", 1), ("forward", 2),
+             ("backward", 0), ("backward", 1), ("backward", 2)])
+
+    def test_1f1b(self):
+        self.assertEqual(
+            [(s.kind, s.micro_batch) for s in schedule(ONE_F_ONE_B, 0, 3, 4)],
+            [("forward", 0), ("forward", 1), ("forward", 2), ("backward", 0),
+             ("forward", 3), ("backward", 1), ("backward", 2), ("backward", 3)])
+        # The last stage alternates from the start.
+        self.assertEqual(
+            [(s.kind, s.micro_batch) for s in schedule(ONE_F_ONE_B, 2, 3, 2)],
+            [("forward", 0), ("backward", 0), ("forward", 1), ("backward", 1)])
+        # Fewer micro-batches than stages.
+        self.assertEqual(
+            [(s.kind, s.micro_batch) for s in schedule(ONE_F_ONE_B, 0, 4, 2)],
+            [("forward", 0), ("forward", 1), ("backward", 0), ("backward", 1)])
+
+    def test_1f1b_bounds_in_flight_micro_batches(self):
+        for num_stages in range(1, 5):
+            for stage in range(num_stages):
+                in_flight = max_in_flight = 0
+                for step in schedule(ONE_F_ONE_B, stage, num_stages, 8):
+                    in_flight += 1 if step.kind == "forward" else -1
+                    max_in_flight = max(max_in_flight, in_flight)
+                self.assertEqual(max_in_flight, num_stages - stage)
+
+    def test_invalid(self):
+        with self.assertRaisesRegex(ValueError, "unknown pipeline schedule"):
+            schedule("interleaved", 0, 2, 2)
+        with self.assertRaisesRegex(ValueError, "stage 2 is not in"):
+            schedule(GPIPE, 2, 2, 2)
+
+    def test_partition(self):
+        model = _model()
+        stages = partition(model, [2, 3, 1])
+        self.assertEqual([len(stage) for stage in stages], [2, 3, 1])
+        self.assertIs(stages[1][2], model[4])
+        self.assertEqual(list(stages[2]._modules.keys()), ["5"])
+        with self.assertRaisesRegex(ValueError, "does not split"):
+            partition(model, [2, 2])
+
+
+class PipeTest(MultiProcessTestCase):
+    def setUp(self):
+        super(PipeTest, self).setUp()
+        self._fork_processes()
+
+    def tearDown(self):
+        super(PipeTest, self).tearDown()
+        try:
+            os.remove(self.file_name)
+        except OSError:
+            pass
+
+    @property
+    def world_size(self):
+        return 3
+
+    def _init(self, backend):
+        dist.init_process_group(
+            backend, init_method="file://{}".format(self.file_name),
+            rank=self.rank, world_size=self.world_size)
+
+    def _check_without_dropout(self, sched, checkpoint, device="cpu"):
+        self._init("gloo" if device == "cpu" else "nccl")
+        model = _model()
+        model[2].p = 0.0
+        model = model.to(device)
+        stage = partition(copy.deepcopy(model), [2, 3, 1])[self.rank]
+        pipe = Pipe(stage, chunks=5, schedule=sched, checkpoint=checkpoint)
+        torch.manual_seed(1)
+        inputs = torch.randn(22, 8, device=device)
+        targets = torch.randn(22, 4, device=device)
+
+        loss = pipe.train_step(
+            inputs if pipe.is_first_stage else None,
+            targets if pipe.is_last_stage else None,
+            nn.MSELoss())
+
+        reference_loss = nn.MSELoss()(model(inputs), targets)
+        reference_loss.backward()
+        reference = partition(model, [2, 3, 1])[self.rank]
+        for param, reference_param in zip(stage.parameters(), reference.parameters()):
+            self.assertEqual(param.grad, reference_param.grad)
+        if pipe.is_last_stage:
+            self.assertEqual(loss, reference_loss.detach())
+        else:
+            self.assertIsNone(loss)
+
+        # Forward passes alone go through the same pipeline.
+        outputs = pipe.forward(inputs if pipe.is_first_stage else None)
+        if pipe.is_last_stage:
+            self.assertEqual(outputs, model(inputs).detach())
+        else:
+            self.assertIsNone(outputs)
+
+    @requires_gloo()
+    def test_gpipe(self):
+        self._check_without_dropout(GPIPE, checkpoint=False)
+
+    @requires_gloo()
+    def test_1f1b(self):
+        self._check_without_dropout(ONE_F_ONE_B, checkpoint=False)
+
+    @requires_gloo()
+    def test_gpipe_checkpoint(self):
+        self._check_without_dropout(GPIPE, checkpoint=True)
+
+    @requires_gloo()
+    def test_1f1b_checkpoint(self):
+        self._check_without_dropout(ONE_F_ONE_B, checkpoint=True)
+
+    @requires_gloo()
+    def test_checkpoint_replays_dropout(self):
+        # With the random number generator state replayed, the recomputation
+        # draws the dropout masks of the forward pass, so both runs agree.
+        self._init("gloo")
+        grads = []
+        for checkpoint in (False, True):
+            stage = partition(_model(), [2, 3, 1])[self.rank]
+            pipe = Pipe(stage, chunks=4, checkpoint=checkpoint)
+            torch.manual_seed(1)
+            inputs = torch.randn(16, 8)
+            targets = torch.randn(16, 4)
+            torch.manual_seed(2 + self.rank)
+            pipe.train_step(
+                inputs if pipe.is_first_stage else None,
+                targets if pipe.is_last_stage else None,
+                nn.MSELoss())
+            grads.append([p.grad for p in stage.parameters()])
+        for grad, checkpoint_grad in zip(*grads):
+            self.assertEqual(grad, checkpoint_grad)
+
+    @requires_gloo()
+    def test_non_float_activations(self):
+        # Integer activations, here the argmax of the first stage, are sent
+        # forward but no gradient is sent back for them.
+        self._init("gloo")
+
+        class Argmax(nn.Module):
+            def forward(self, x):
+                return x.argmax(dim=1, keepdim=True)
+
+        class Embed(nn.Module):
+            def __init__(self):
+                super(Embed, self).__init__()
+                self.embedding = nn.Embedding(16, 4)
+
+            def forward(self, x):
+                return self.embedding(x).squeeze(1)
+
+        torch.manual_seed(0)
+        model = nn.Sequential(nn.Linear(8, 16), Argmax(), Embed(), nn.Linear(4, 4))
+        stage = partition(model, [2, 1, 1])[self.rank]
+        pipe = Pipe(stage, chunks=2)
+        loss = pipe.train_step(
+            torch.randn(6, 8) if pipe.is_first_stage else None,
+            torch.randn(6, 4) if pipe.is_last_stage else None,
+            nn.MSELoss())
+        if pipe.is_first_stage:
+            self.assertIsNone(stage[0].weight.grad)
+        else:
+            self.assertTrue(all(p.grad is not None for p in stage.parameters()))
+        if pipe.is_last_stage:
+            self.assertIsNotNone(loss)
+
+    @requires_gloo()
+    def test_batch_smaller_than_chunks(self):
+        self._init("gloo")
+        pipe = Pipe(partition(_model(), [2, 3, 1])[self.rank], chunks=4)
+        if pipe.is_first_stage:
+            with self.assertRaisesRegex(ValueError, "cannot be split into 4 micro-batches"):
+                pipe.train_step(torch.randn(3, 8))
+
+    @requires_nccl()
+    @requires_nccl_version(2700, "Need NCCL 2.7+ for send/recv")
+    @skip_if_lt_x_gpu(3)
+    def test_1f1b_nccl(self):
+        torch.cuda.set_device(self.rank)
+        self._check_without_dropout(ONE_F_ONE_B, checkpoint=True, device="cuda:{}".format(self.rank))
+
+
+if __name__ == "__main__":
+    if not TEST_WITH_TSAN:
+        run_tests()
@@ -542,6 +542,36 @@ class TestAsync(JitTestCase):
             def forward(self, x):
                 futs = torch.jit.annotate(List[torch.jit.Future], [])
 
+    def test_async_max_concurrent_forks(self):
+        @torch.jit.script
+        def leaf(x):
+            return x + 1
+
+        @torch.jit.script
+        def node(x):
+            futs = [torch.jit.fork(leaf, x) for _ in range(4)]
+            return torch.stack([torch.jit.wait(fut) for fut in futs]).sum(0)
+
+        @torch.jit.script
+        def root(x):
+            futs = [torch.jit.fork(node, x) for _ in range(4)]
+            return torch.stack([torch.jit.wait(fut) for fut in futs]).sum(0)
+
+        x = torch.rand(3, 4)
+        expected = (x + 1) * 16
+        old_max_forks = torch._C._jit_set_max_concurrent_forks(1)
+        try:
+            # the forks over the limit run inline in the waiting interpreter
+            self.assertEqual(root(x), expected)
+            with torch.autograd.profiler.profile() as prof:
+                self.assertEqual(root(x), expected)
+            names = [evt.name for evt in prof.function_events]
+            self.assertIn("fork::node", names)
+            self.assertIn("fork::leaf", names)
+        finally:
+            torch._C._jit_set_max_concurrent_forks(old_max_forks)
+        self.assertEqual(root(x), expected)
+
 
 if __name__ == '__main__':
     raise RuntimeError("This test file is not meant to be run directly, use:\n\n"
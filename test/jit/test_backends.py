@@ -177,6 +177,46 @@ class NestedModuleTest(JitBackendTestCase):
         self.test_execution()
 
 
+class PartialModuleTest(JitBackendTestCase):
+    """
+    Tests for a module of which only some ops are lowered to a backend, while the
+    others keep running in the interpreter.
+    """
+    class PartialModule(torch.nn.Module):
+        def forward(self, x, h):
+            y = torch.relu(x + h)
+            z = torch.sigmoid(y)
+            return torch.tanh(z - x), z
+
+    def setUp(self):
+        super().setUp()
+        self.module = PartialModuleTest.PartialModule()
+        self.scripted_module = torch.jit.script(PartialModuleTest.PartialModule())
+        self.lowered_module = torch._C._jit_to_backend_partial(
+            "test_interpreter_backend",
+            self.scripted_module._c,
+            {"forward": {"": ""}},
+            ["aten::add", "aten::relu", "aten::sub", "aten::tanh"],
+        )
+
+    def test_partition(self):
+        # sigmoid splits the supported ops into two lowered subgraphs.
+        kinds = [node.kind() for node in self.lowered_module.graph.nodes()]
+        self.assertEqual(kinds.count("prim::CallMethod"), 2)
+        self.assertEqual(kinds.count("aten::sigmoid"), 1)
+        for kind in ["aten::add", "aten::relu", "aten::sub", "aten::tanh"]:
+            self.assertNotIn(kind, kinds)
+
+    def test_execution(self):
+        input = torch.randn(5)
+        self.check_function("forward", input)
+
+    def test_save_load(self):
+        self.test_execution()
+        self.save_load()
+        self.test_execution()
+
+
 class TestBackends(JitTestCase):
     """
     This class wraps and invokes all subclasses of JitBackendTestCase so that each one
@@ -187,19 +227,27 @@ class TestBackends(JitTestCase):
         super().__init__(name)
         self.basic_module_test = BasicModuleTest(name)
         self.nested_module_test = NestedModuleTest(name)
+        self.partial_module_test = PartialModuleTest(name)
 
     def setUp(self):
         super().setUp()
         if not TEST_WITH_ROCM:
             self.basic_module_test.setUp()
             self.nested_module_test.setUp()
+            self.partial_module_test.setUp()
 
     @skipIfRocm
     def test_execution(self):
         self.basic_module_test.test_execution()
         self.nested_module_test.test_execution()
+        self.partial_module_test.test_execution()
 
     @skipIfRocm
     def test_save_load(self):
         self.basic_module_test.test_save_load()
         self.nested_module_test.test_save_load()
+        self.partial_module_test.test_save_load()
+
+    @skipIfRocm
+    def test_partition(self):
+        self.partial_module_test.test_partition()
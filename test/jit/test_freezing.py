@@ -1082,3 +1082,50 @@ class TestFreezing(JitTestCase):
             # It used to segfault while running frozen module.
             m_frozen_res = m_frozen(data)
             self.assertEqual(m_res, m_frozen_res)
+
+    def test_freeze_fold_conv_bn(self):
+        class ConvBN(nn.Module):
+            def __init__(self):
+                super(ConvBN, self).__init__()
+                self.conv = nn.Conv2d(3, 8, 3, bias=False)
+                self.bn = nn.BatchNorm2d(8)
+
+            def forward(self, x):
+                return self.bn(self.conv(x))
+
+        model = ConvBN().eval()
+        # non-trivial statistics, so that a wrong folding shows
+        model.bn.running_mean.uniform_()
+        model.bn.running_var.uniform_(0.5, 1.5)
+        frozen = torch.jit.freeze(torch.jit.script(model))
+        torch._C._jit_pass_fold_frozen_conv_bn(frozen.graph)
+        FileCheck().check("aten::conv2d").check_not("aten::batch_norm").run(frozen.graph)
+
+        x = torch.rand(2, 3, 10, 10)
+        self.assertEqual(frozen(x), model(x))
+
+    @unittest.skipIf(not torch._C.has_mkldnn, "MKL-DNN build is disabled")
+    def test_freeze_optimize_mkldnn(self):
+        class Net(nn.Module):
+            def __init__(self):
+                super(Net, self).__init__()
+                self.conv1 = nn.Conv2d(3, 8, 3, padding=1)
+                self.bn = nn.BatchNorm2d(8)
+                self.conv2 = nn.Conv2d(8, 8, 3, padding=1)
+
+            def forward(self, x):
+                x = torch.relu(self.bn(self.conv1(x)))
+                x = torch.relu(self.conv2(x))
+                return torch.nn.functional.adaptive_avg_pool2d(x, (1, 1)).flatten(1)
+
+        model = Net().eval()
+        model.bn.running_var.uniform_(0.5, 1.5)
+        frozen = torch.jit.freeze(torch.jit.script(model), optimize=True)
+        # the layout is only converted at the boundaries of the MKL-DNN ops
+        FileCheck().check_count("aten::to_mkldnn", 1, exactly=True) \
+                   .check_count("aten::mkldnn_convolution", 2, exactly=True) \
+                   .check_count("aten::to_dense", 1, exactly=True) \
+                   .check_not("aten::batch_norm").run(frozen.graph)
+
+        x = torch.rand(2, 3, 16, 16)
+        self.assertEqual(frozen(x), model(x))
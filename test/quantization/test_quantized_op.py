@@ -18,7 +18,7 @@ from hypothesis import strategies as st
 import torch.testing._internal.hypothesis_utils as hu
 hu.assert_deadline_disabled()
 
-from torch.testing._internal.common_utils import TestCase
+from torch.testing._internal.common_utils import TestCase, TEST_WITH_ROCM
 from torch.testing._internal.common_quantization import skipIfNoFBGEMM
 from torch.testing._internal.common_quantized import _quantize, _dequantize, _calculate_dynamic_qparams, \
     override_quantized_engine, supported_qengines, override_qengines
@@ -683,6 +683,20 @@ class TestQuantizedOps(TestCase):
             self.assertEqual(qCrelu_hat, qCrelu_out_hat,
                              msg="AddReLU.out failed")
 
+    """Tests the correctness of the add and add_relu op on CUDA."""
+    @unittest.skipIf(not torch.cuda.is_available() or TEST_WITH_ROCM, 'CUDA is not available')
+    def test_qadd_relu_cuda(self):
+        A = torch.arange(-128, 130, dtype=torch.float)
+        B = torch.arange(-25, 233, dtype=torch.float)
+        for dtype in [torch.quint8, torch.qint8, torch.qint32]:
+            qA = torch.quantize_per_tensor(A, scale=2.0, zero_point=10, dtype=dtype)
+            qB = torch.quantize_per_tensor(B, scale=0.5, zero_point=3, dtype=dtype)
+            for op in [torch.ops.quantized.add, torch.ops.quantized.add_relu]:
+                qC = op(qA, qB, scale=1.5, zero_point=5)
+                qC_cuda = op(qA.cuda(), qB.cuda(), scale=1.5, zero_point=5)
+                self.assertEqual(qC_cuda.device.type, 'cuda')
+                np.testing.assert_equal(qC.int_repr().numpy(),
+                                        qC_cuda.int_repr().cpu().numpy())
 
     """Tests the correctness of the add and add_relu op."""
     def test_qadd_relu_different_qparams(self):
@@ -2247,6 +2261,38 @@ class TestDynamicQuantizedLinear(TestCase):
         self.assertEqual(Y_fp32, Y_fp32_ref,
                          msg="torch.ops.quantized.linear_dynamic results are off")
 
+    """Tests the correctness of the dynamic linear and linear_relu ops with fp16 weights."""
+    @skipIfNoFBGEMM
+    @given(
+        batch_size=st.integers(1, 64),
+        input_channels=st.integers(16, 64),
+        output_channels=st.integers(4, 32),
+        use_bias=st.booleans(),
+        use_relu=st.booleans(),
+        use_multi_dim_input=st.booleans())
+    def test_qlinear_fp16(self, batch_size, input_channels, output_channels,
+                          use_bias, use_relu, use_multi_dim_input):
+        qlinear_prepack = torch.ops.quantized.linear_prepack_fp16
+        if use_relu:
+            qlinear_dynamic = torch.ops.quantized.linear_relu_dynamic_fp16
+        else:
+            qlinear_dynamic = torch.ops.quantized.linear_dynamic_fp16
+
+        X = torch.randn(batch_size, input_channels)
+        if use_multi_dim_input:
+            X = X.repeat(3, 1, 1)
+        W = torch.randn(output_channels, input_channels)
+        b = torch.randn(output_channels) if use_bias else None
+
+        W_prepack = qlinear_prepack(W, b)
+        Y = qlinear_dynamic(X, W_prepack)
+
+        Y_ref = F.linear(X, W.half().float(), b)
+        if use_relu:
+            Y_ref = F.relu(Y_ref)
+        self.assertEqual(Y, Y_ref, atol=1e-3, rtol=1e-3,
+                         msg="torch.ops.quantized.linear_dynamic_fp16 results are off")
+
 class TestDynamicQuantizedRNNOp(TestCase):
     """Tests the correctness of the dynamic quantized lstm/gru."""
 
@@ -2670,6 +2716,46 @@ class TestQuantizedLinear(unittest.TestCase):
         np.testing.assert_array_almost_equal(
             Y_q_ref2.int_repr().numpy(), Y_q.int_repr().numpy(), decimal=decimal_val)
 
+    """Tests the correctness of the quantized linear and linear_relu op on CUDA."""
+    @unittest.skipIf(not torch.cuda.is_available() or TEST_WITH_ROCM, 'CUDA is not available')
+    @given(batch_size=st.integers(1, 4),
+           input_channels=st.integers(1, 33),
+           output_channels=st.integers(1, 9),
+           use_bias=st.booleans(),
+           use_relu=st.booleans(),
+           use_channelwise=st.booleans())
+    def test_qlinear_cuda(self, batch_size, input_channels, output_channels,
+                          use_bias, use_relu, use_channelwise):
+        X = torch.rand(batch_size, 3, input_channels) * 4 - 2
+        W = torch.rand(output_channels, input_channels) * 2 - 1
+        b = torch.rand(output_channels) if use_bias else None
+        X_q = torch.quantize_per_tensor(X, scale=4.0 / 255, zero_point=127, dtype=torch.quint8)
+        if use_channelwise:
+            W_scales = torch.rand(output_channels, dtype=torch.double) * 0.01 + 0.005
+            W_zps = torch.randint(-5, 5, (output_channels,), dtype=torch.long)
+            W_q = torch.quantize_per_channel(W, W_scales, W_zps, 0, torch.qint8)
+        else:
+            W_q = torch.quantize_per_tensor(W, scale=2.0 / 255, zero_point=2, dtype=torch.qint8)
+        Y_scale, Y_zp = 0.1, 120
+
+        W_prepack = torch.ops.quantized.linear_prepack(W_q.cuda(), b.cuda() if use_bias else None)
+        qlinear = torch.ops.quantized.linear_relu if use_relu else torch.ops.quantized.linear
+        Y_q = qlinear(X_q.cuda(), W_prepack, Y_scale, Y_zp)
+        self.assertEqual(Y_q.device.type, 'cuda')
+        self.assertEqual(Y_q.shape, (batch_size, 3, output_channels))
+
+        # Reference quantized result from the float linear operator
+        Y_ref = F.linear(X_q.dequantize(), W_q.dequantize(), b)
+        if use_relu:
+            Y_ref[Y_ref < 0.0] = 0.0
+        Y_q_ref = torch.quantize_per_tensor(Y_ref, Y_scale, Y_zp, torch.quint8)
+        # The float accumulation may round the other way in rare cases.
+        self.assertLessEqual(
+            (Y_q_ref.int_repr().int() - Y_q.int_repr().cpu().int()).abs().max().item(), 1)
+
+        W_unpacked, b_unpacked = torch.ops.quantized.linear_unpack(W_prepack)
+        self.assertEqual(W_unpacked.int_repr().cpu(), W_q.int_repr())
+
     """Tests the correctness of the quantized::linear_unpack op."""
     @given(W=hu.tensor(shapes=hu.array_shapes(2, 2,),
                        qparams=hu.qparams(dtypes=torch.qint8)),
@@ -2743,8 +2829,8 @@ class TestQuantizedEmbeddingBag(TestCase):
         # compare against C2 to ensure numerical equivalency.
         from caffe2.python import core, workspace
         conversion_op = "FloatToFused8BitRowwiseQuantized"
-        if bit_rate == 4:
-            conversion_op = "FloatToFused4BitRowwiseQuantized"
+        if bit_rate < 8:
+            conversion_op = "FloatToFused{}BitRowwiseQuantized".format(bit_rate)
 
         def get_c2_weights(weights):
             workspace.ResetWorkspace()
@@ -2756,10 +2842,11 @@ class TestQuantizedEmbeddingBag(TestCase):
                 )
             )
             emb_q = workspace.FetchBlob("quantized_weights")
-            if bit_rate == 4:
+            if bit_rate < 8:
                 workspace.RunOperatorOnce(
                     core.CreateOperator(
-                        "Fused4BitRowwiseQuantizedToFloat", ["quantized_weights"], ["dequantized_weights"]
+                        "Fused{}BitRowwiseQuantizedToFloat".format(bit_rate),
+                        ["quantized_weights"], ["dequantized_weights"]
                     )
                 )
                 dequantized_data = torch.from_numpy(workspace.FetchBlob("dequantized_weights"))
@@ -2794,15 +2881,33 @@ class TestQuantizedEmbeddingBag(TestCase):
 
         self._test_embedding_bag_unpack_fn(pack_fn, unpack_fn, num_embeddings, embedding_dim, bit_rate=4)
 
+    """ Tests the correctness of the embedding_bag_2bit pack/unpack op against C2 """
+    @given(num_embeddings=st.integers(10, 100),
+           embedding_dim=st.integers(5, 50).filter(lambda x: x % 4 == 0),)
+    def test_embedding_bag_2bit_unpack(self, num_embeddings, embedding_dim):
+        pack_fn = torch.ops.quantized.embedding_bag_2bit_prepack
+        unpack_fn = torch.ops.quantized.embedding_bag_2bit_unpack
+
+        self._test_embedding_bag_unpack_fn(pack_fn, unpack_fn, num_embeddings, embedding_dim, bit_rate=2)
+
     def embedding_bag_rowwise_offsets_run(
             self, bit_rate, num_embeddings,
             embedding_dim, num_offsets, enable_per_sample_weights,
-            include_last_offset, atol, rtol):
+            include_last_offset, atol, rtol, mode='sum', index_dtype=torch.long):
         pt_op = torch.ops.quantized.embedding_bag_byte_rowwise_offsets
         pt_prepack_op = torch.ops.quantized.embedding_bag_byte_prepack
+        pt_unpack_op = torch.ops.quantized.embedding_bag_byte_unpack
         if bit_rate == 4:
             pt_op = torch.ops.quantized.embedding_bag_4bit_rowwise_offsets
             pt_prepack_op = torch.ops.quantized.embedding_bag_4bit_prepack
+            pt_unpack_op = torch.ops.quantized.embedding_bag_4bit_unpack
+        elif bit_rate == 2:
+            pt_op = torch.ops.quantized.embedding_bag_2bit_rowwise_offsets
+            pt_prepack_op = torch.ops.quantized.embedding_bag_2bit_prepack
+            pt_unpack_op = torch.ops.quantized.embedding_bag_2bit_unpack
+        if mode == 'mean':
+            # Per sample weights are only supported for the sum mode.
+            enable_per_sample_weights = False
 
         weights = torch.from_numpy((np.random.random_sample((
             num_embeddings, embedding_dim)) + 1).astype(np.float32))
@@ -2838,7 +2943,12 @@ class TestQuantizedEmbeddingBag(TestCase):
                 (offsets, torch.tensor([indices.size(0)], dtype=torch.long)), 0
             )
 
-        # Reference result will be the floating point torch.nn.EmbeddingBag.
+        # Reference result will be the floating point torch.nn.EmbeddingBag,
+        # of the dequantized weights for 2 bits, whose quantization error is
+        # larger than any tolerance of the original weights.
+        if bit_rate == 2:
+            weights = pt_unpack_op(q_weights)
+
         def get_reference_result(
                 num_embeddings, embedding_dim,
                 include_last_offset, weights, per_sample_weights,
@@ -2847,7 +2957,7 @@ class TestQuantizedEmbeddingBag(TestCase):
                 num_embeddings=num_embeddings,
                 embedding_dim=embedding_dim,
                 include_last_offset=include_last_offset, _weight=weights,
-                scale_grad_by_freq=False, mode='sum'
+                scale_grad_by_freq=False, mode=mode
             )
             return embedding_bag(indices, offsets,
                                  per_sample_weights=per_sample_weights)
@@ -2857,9 +2967,9 @@ class TestQuantizedEmbeddingBag(TestCase):
             per_sample_weights, indices, offsets)
         result = pt_op(
             q_weights,
-            indices,
-            offsets,
-            mode=0,
+            indices.to(index_dtype),
+            offsets.to(index_dtype),
+            mode=0 if mode == 'sum' else 1,
             per_sample_weights=per_sample_weights,
             include_last_offset=include_last_offset,
         )
@@ -2904,16 +3014,40 @@ class TestQuantizedEmbeddingBag(TestCase):
            embedding_dim=st.integers(5, 50).filter(lambda x: x % 4 == 0),
            num_offsets=st.integers(1, 20),
            enable_per_sample_weights=st.booleans(),
-           include_last_offset=st.booleans())
+           include_last_offset=st.booleans(),
+           mode=st.sampled_from(['sum', 'mean']),
+           index_dtype=st.sampled_from([torch.int, torch.long]))
     def test_embedding_bag_4bit_rowwise_offsets(self, num_embeddings,
                                                 embedding_dim, num_offsets,
                                                 enable_per_sample_weights,
-                                                include_last_offset):
+                                                include_last_offset, mode,
+                                                index_dtype):
         self.embedding_bag_rowwise_offsets_run(4, num_embeddings,
                                                embedding_dim, num_offsets,
                                                enable_per_sample_weights,
                                                include_last_offset, atol=0.1,
-                                               rtol=1e-2)
+                                               rtol=1e-2, mode=mode,
+                                               index_dtype=index_dtype)
+
+    """ Tests the correctness of the embedding_bag_2bit quantized operator """
+    @given(num_embeddings=st.integers(10, 100),
+           embedding_dim=st.integers(5, 50).filter(lambda x: x % 4 == 0),
+           num_offsets=st.integers(1, 20),
+           enable_per_sample_weights=st.booleans(),
+           include_last_offset=st.booleans(),
+           mode=st.sampled_from(['sum', 'mean']),
+           index_dtype=st.sampled_from([torch.int, torch.long]))
+    def test_embedding_bag_2bit_rowwise_offsets(self, num_embeddings,
+                                                embedding_dim, num_offsets,
+                                                enable_per_sample_weights,
+                                                include_last_offset, mode,
+                                                index_dtype):
+        self.embedding_bag_rowwise_offsets_run(2, num_embeddings,
+                                               embedding_dim, num_offsets,
+                                               enable_per_sample_weights,
+                                               include_last_offset, atol=1e-3,
+                                               rtol=1e-3, mode=mode,
+                                               index_dtype=index_dtype)
 
 
 class TestQuantizedConv(unittest.TestCase):
@@ -611,6 +611,22 @@ class TestQuantizedTensor(TestCase):
         x = torch.randn(3)
         self.assertEqual(x.is_pinned(), False)
 
+    @unittest.skipIf(not torch.cuda.is_available() or TEST_WITH_ROCM, 'CUDA is not available')
+    def test_cuda_cpu_per_channel_consistency(self):
+        r = torch.rand(4, 6, 5, dtype=torch.float32) * 25 - 4
+        scales = torch.tensor([0.02, 0.05, 0.1, 0.2], dtype=torch.double)
+        zero_points = torch.tensor([2, 0, -1, 3], dtype=torch.long)
+        for dtype in [torch.qint8, torch.quint8, torch.qint32]:
+            zps = zero_points.abs() if dtype == torch.quint8 else zero_points
+            qr_cpu = torch.quantize_per_channel(r, scales, zps, 0, dtype)
+            qr_cuda = torch.quantize_per_channel(r.cuda(), scales, zps, 0, dtype)
+            self.assertEqual(qr_cuda.q_per_channel_axis(), 0)
+            self.assertEqual(qr_cuda.q_per_channel_scales(), scales)
+            self.assertEqual(qr_cuda.q_per_channel_zero_points(), zps)
+            np.testing.assert_equal(qr_cpu.int_repr().numpy(), qr_cuda.int_repr().cpu().numpy())
+            r_cpu, r_cuda = qr_cpu.dequantize().numpy(), qr_cuda.dequantize().cpu().numpy()
+            np.testing.assert_almost_equal(r_cuda, r_cpu, decimal=5)
+
 
     def test_fp16_saturate_op(self):
         x = torch.ones(5, 5, dtype=torch.float32) * 65532
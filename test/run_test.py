@@ -46,6 +46,8 @@ TESTS = [
     'test_multiprocessing',
     'test_multiprocessing_spawn',
     'distributed/test_nccl',
+    'distributed/test_pipeline',
+    'distributed/test_checkpoint',
     'test_native_functions',
     'test_nn',
     'test_numba_integration',
@@ -55,6 +57,7 @@ TESTS = [
     'test_vulkan',
     'test_quantization',
     'test_sparse',
+    'test_sparse_csr',
     'test_spectral_ops',
     'test_serialization',
     'test_show_pickle',
@@ -94,6 +97,8 @@ WINDOWS_BLOCKLIST = [
     'distributed/rpc/test_process_group_agent',
     'distributed/rpc/test_tensorpipe_agent',
     'distributed/test_distributed',
+    'distributed/test_pipeline',
+    'distributed/test_checkpoint',
 ]
 
 ROCM_BLOCKLIST = [
@@ -2754,6 +2754,50 @@ class TestAutograd(TestCase):
             # Now validate the json
             json.load(f)
 
+    @unittest.skipIf(not torch.cuda.is_available() or not torch.autograd._cupti_available(),
+                     "CUPTI profiling requires CUDA and a build with CUPTI")
+    def test_profiler_cupti(self):
+        device = torch.device("cuda:0")
+        x = torch.randn(64, 64, device=device)
+        y = torch.randn(64, 64, device=device)
+        with profile(use_cupti=True) as prof:
+            z = torch.mm(x, y)
+            z.cpu()
+
+        events = {evt.name: evt for evt in prof.function_events}
+        # the matmul kernel is attributed to the op that launched it, the
+        # device to host copy to the copy op
+        self.assertGreater(len(events["aten::mm"].kernels), 0)
+        self.assertGreater(events["aten::mm"].cuda_time_total, 0)
+        copy_kernels = [k.name for evt in prof.function_events for k in evt.kernels
+                        if k.name == "Memcpy DtoH"]
+        self.assertEqual(len(copy_kernels), 1)
+        for evt in prof.function_events:
+            for kernel in evt.kernels:
+                self.assertEqual(kernel.device, 0)
+                self.assertGreaterEqual(kernel.interval.elapsed_us(), 0)
+
+        with tempfile.NamedTemporaryFile(mode="w+") as f:
+            prof.export_chrome_trace(f.name)
+            json.load(f)
+
+        # a profiler on another thread can't use CUPTI while the first one does
+        errors = []
+
+        def enable_on_other_thread():
+            try:
+                with profile(use_cupti=True):
+                    pass
+            except RuntimeError as e:
+                errors.append(str(e))
+
+        with profile(use_cupti=True):
+            t = threading.Thread(target=enable_on_other_thread)
+            t.start()
+            t.join()
+        self.assertEqual(len(errors), 1)
+        self.assertIn("already used by another profiler", errors[0])
+
     def test_profiler(self):
         x = torch.randn(10, 10)
 
@@ -2777,6 +2821,31 @@ class TestAutograd(TestCase):
                 last_end = info.cpu_interval.end
             self.assertEqual(info.name, expected_name)
 
+    def test_profiler_sampling(self):
+        x = torch.randn(10)
+
+        def run():
+            for _ in range(3000):
+                torch.add(x, x)
+
+        # more events than fit in a block of the per-thread event lists
+        with profile() as prof:
+            run()
+        num_adds = len([evt for evt in prof.function_events if evt.name == "aten::add"])
+        self.assertEqual(num_adds, 3000)
+
+        num_events = len(prof.function_events)
+
+        # one in every ten ranges is recorded, whatever op it is
+        with profile(sample_every=10) as prof:
+            run()
+        num_sampled_events = len(prof.function_events)
+        self.assertGreater(num_sampled_events, 0)
+        self.assertLess(num_sampled_events, num_events // 4)
+
+        with self.assertRaisesRegex(ValueError, "sample_every"):
+            profile(sample_every=0)
+
     def test_profiler_seq_nr(self):
         with profile() as p:
             x = torch.randn(10, 10, requires_grad=True)
@@ -2967,6 +3036,27 @@ class TestAutograd(TestCase):
         self.assertEqual(avg.cpu_time, 7.5)
         self.assertEqual(avg.cuda_time_total, 0)
 
+    def test_profiler_communication_overlap(self):
+        def event(id, name, cpu_start, cpu_end):
+            return FunctionEvent(id=id, node_id=0, name=name, thread=0,
+                                 cpu_start=cpu_start, cpu_end=cpu_end)
+
+        forward = event(0, "forward", 0, 100)
+        mm = event(1, "aten::mm", 10, 20)
+        all_reduce = event(2, "nccl:all_reduce", 30, 35)
+        # forward has children, its time on the stream is ignored
+        forward.append_kernel("forward", 0, 0, 100, stream=0)
+        forward.append_kernel("volta_sgemm", 0, 50, 55, stream=0)
+        mm.append_kernel("aten::mm", 0, 10, 40, stream=0)
+        all_reduce.append_kernel("nccl:all_reduce", 0, 30, 60, stream=7)
+        events = EventList([forward, mm, all_reduce])
+
+        overlap = events.communication_overlap()
+        self.assertEqual(overlap.communication_time, 30)
+        # hidden behind aten::mm from 30 to 40 and volta_sgemm from 50 to 55
+        self.assertEqual(overlap.exposed_communication_time, 15)
+        self.assertEqual(all_reduce.kernels[0].stream, 7)
+
     def test_profiler_shapes(self):
         print("")
         layer1 = torch.nn.Linear(20, 30)
@@ -2995,6 +3085,82 @@ class TestAutograd(TestCase):
                 self.assertEqual(event.input_shapes, input_shape_expected)
                 last_end = event.cpu_interval.end
 
+    def test_profiler_flops(self):
+        a = torch.randn(128, 20)
+        b = torch.randn(20, 30)
+        c = torch.randn(30)
+        x = torch.randn(8, 3, 16, 16)
+        w = torch.randn(4, 3, 3, 3)
+        with profile(with_flops=True) as prof:
+            torch.mm(a, b)
+            torch.addmm(c, a, b)
+            torch.bmm(a.expand(4, 128, 20), b.expand(4, 20, 30))
+            torch.nn.functional.conv2d(x, w, stride=2, padding=1)
+            a * 2
+            a + a
+            torch.cat([a, a])
+
+        def event(name):
+            return next(evt for evt in prof.function_events if evt.name == name)
+
+        self.assertEqual(event("aten::mm").flops, 2 * 128 * 20 * 30)
+        self.assertEqual(event("aten::mm").bytes_moved, (128 * 20 + 20 * 30 + 128 * 30) * 4)
+        self.assertEqual(event("aten::addmm").flops, 2 * 128 * 20 * 30 + 128 * 30)
+        self.assertEqual(event("aten::bmm").flops, 4 * 2 * 128 * 20 * 30)
+        # output of 8 x 4 x 8 x 8, each the dot product of 3 x 3 x 3 inputs
+        self.assertEqual(event("aten::conv2d").flops, 2 * 8 * 4 * 8 * 8 * 3 * 3 * 3)
+        self.assertEqual(event("aten::mul").flops, 128 * 20)
+        self.assertEqual(event("aten::add").bytes_moved, 3 * 128 * 20 * 4)
+        self.assertEqual(event("aten::cat").flops, 0)
+
+        averages = prof.key_averages()
+        mm = next(evt for evt in averages if evt.key == "aten::mm")
+        self.assertEqual(mm.flops, 2 * 128 * 20 * 30)
+        self.assertGreater(mm.tflops, 0)
+        self.assertGreater(mm.gbps, 0)
+        table = averages.table()
+        self.assertIn("TFLOPS", table)
+        self.assertIn("GB/s", table)
+
+        # off by default
+        with profile() as prof:
+            torch.mm(a, b)
+        self.assertTrue(all(evt.flops == 0 for evt in prof.function_events))
+        self.assertNotIn("TFLOPS", prof.key_averages().table())
+
+    @unittest.skipIf(not torch.autograd._perf_counters_available(),
+                     "hardware performance counters are not available")
+    def test_profiler_perf_counters(self):
+        a = torch.randn(256, 256)
+        with profile(with_perf_counters=True) as prof:
+            for _ in range(4):
+                torch.mm(a, a)
+
+        for evt in prof.function_events:
+            if evt.name == "aten::mm":
+                self.assertGreater(evt.cycles, 0)
+                self.assertGreater(evt.instructions, 0)
+                self.assertGreaterEqual(evt.llc_misses, 0)
+                self.assertGreaterEqual(evt.branch_misses, 0)
+                # the counters of a range include those of its children
+                for child in evt.cpu_children:
+                    self.assertLessEqual(child.instructions, evt.instructions)
+
+        averages = prof.key_averages()
+        mm = next(evt for evt in averages if evt.key == "aten::mm")
+        self.assertEqual(mm.instructions, sum(
+            evt.instructions for evt in prof.function_events if evt.name == "aten::mm"))
+        self.assertGreater(mm.ipc, 0)
+        table = averages.table(sort_by="cycles")
+        self.assertIn("Instructions", table)
+        self.assertIn("IPC", table)
+
+        # off by default
+        with profile() as prof:
+            torch.mm(a, a)
+        self.assertTrue(all(evt.cycles == 0 for evt in prof.function_events))
+        self.assertNotIn("IPC", prof.key_averages().table())
+
     def test_profiler_no_cuda(self):
         print("")
         layer = torch.nn.Linear(20, 30)
@@ -3150,6 +3316,59 @@ class TestAutograd(TestCase):
             ]
         )
 
+    def test_memory_profiler_attribution(self):
+        class Inner(torch.nn.Module):
+            def forward(self, x):
+                return x * 2
+
+        class Outer(torch.nn.Module):
+            def __init__(self):
+                super(Outer, self).__init__()
+                self.inner = Inner()
+
+            def forward(self, x):
+                return self.inner(x) + 1
+
+        model = Outer()
+        x = torch.rand(100, 100)
+        with profile(profile_memory=True, record_modules=True) as prof:
+            with record_function("test_user_scope_alloc"):
+                y = model(x)
+                z = torch.rand(100, 100)
+            with record_function("test_user_scope_dealloc"):
+                del y
+        tensor_size = 100 * 100 * 4
+
+        allocations = prof.function_events.memory_allocations()
+        self.assertTrue(all(alloc.device == torch.device('cpu') for alloc in allocations))
+        self.assertEqual(allocations, sorted(allocations, key=lambda alloc: alloc.alloc_time))
+        # the output of the module is freed, the other tensor outlives the profiler
+        module_outputs = [alloc for alloc in allocations
+                          if alloc.scope[:3] == ("test_user_scope_alloc", "nn.Module: Outer", "nn.Module: Inner")]
+        self.assertTrue(len(module_outputs) > 0)
+        self.assertTrue(all(alloc.size >= tensor_size for alloc in module_outputs))
+        freed = [alloc for alloc in allocations if alloc.free_time is not None]
+        self.assertTrue(all(alloc.free_time >= alloc.alloc_time for alloc in freed))
+        alive = [alloc for alloc in allocations if alloc.free_time is None]
+        self.assertTrue(any(alloc.scope[:2] == ("test_user_scope_alloc", "aten::rand") for alloc in alive))
+
+        stats = {evt.key: evt for evt in prof.key_averages()}
+        self.assertTrue(stats["nn.Module: Outer"].peak_cpu_memory_usage >= 2 * tensor_size)
+        self.assertTrue(stats["test_user_scope_alloc"].peak_cpu_memory_usage >=
+                        stats["test_user_scope_alloc"].cpu_memory_usage)
+        self.assertEqual(stats["test_user_scope_dealloc"].peak_cpu_memory_usage, 0)
+        self.assertIn("CPU Peak Mem", prof.key_averages().table())
+
+        timeline = prof.function_events.memory_timeline('cpu')
+        self.assertEqual(len(timeline), len(allocations) + len(freed))
+        self.assertEqual([time for time, _ in timeline], sorted(time for time, _ in timeline))
+        self.assertEqual(timeline[-1][1], sum(alloc.size for alloc in alive))
+
+        # the hooks are removed with the profiler
+        with profile(profile_memory=True) as prof:
+            model(x)
+        self.assertFalse(any(evt.name.startswith("nn.Module") for evt in prof.function_events))
+
     def test_record_function(self):
         x = torch.randn(10, 10)
 
@@ -3421,6 +3640,191 @@ class TestAutograd(TestCase):
         d, = torch.autograd.grad(c, a, retain_graph=True, create_graph=True)
         self.assertTrue(d.requires_grad)
 
+    def test_backward_many_small_nodes(self):
+        # Most nodes become ready on the thread that runs the node before them,
+        # mixed with reentrant backwards that must still see all the work.
+        class Reentrant(Function):
+            @staticmethod
+            def forward(ctx, x):
+                ctx.save_for_backward(x)
+                return x * 2
+
+            @staticmethod
+            def backward(ctx, grad):
+                x, = ctx.saved_tensors
+                with torch.enable_grad():
+                    x = x.detach().requires_grad_()
+                    (x * x).sum().backward()
+                return grad * 2
+
+        a = torch.randn(3, requires_grad=True)
+        rows = []
+        for i in range(300):
+            b = a * (i % 5)
+            if i % 50 == 0:
+                b = Reentrant.apply(b)
+            rows.append(b + i)
+        torch.stack(rows).sum().backward()
+        expected = sum((i % 5) * (2 if i % 50 == 0 else 1) for i in range(300))
+        self.assertEqual(a.grad, torch.full_like(a, expected))
+
+    def test_parallel_cpu_backward(self):
+        prev = torch.autograd.get_num_cpu_backward_threads()
+        torch.autograd.set_num_cpu_backward_threads(4)
+        try:
+            self.assertEqual(torch.autograd.get_num_cpu_backward_threads(), 4)
+            a = torch.randn(8, 8, requires_grad=True)
+            bs = [torch.randn(8, 8, requires_grad=True) for _ in range(12)]
+
+            def towers():
+                outs = []
+                for b in bs:
+                    x = a.mm(b)
+                    for _ in range(5):
+                        x = x.tanh() * 2
+                    outs.append(x.sum())
+                return torch.stack(outs).sum()
+
+            towers().backward()
+            grads = [a.grad.clone()] + [b.grad.clone() for b in bs]
+            a.grad = None
+            for b in bs:
+                b.grad = None
+
+            torch.autograd.set_num_cpu_backward_threads(0)
+            towers().backward()
+            self.assertEqual(grads, [a.grad] + [b.grad for b in bs])
+            torch.autograd.set_num_cpu_backward_threads(4)
+
+            # only the nodes needed for the requested inputs run
+            ga, = torch.autograd.grad(towers(), a)
+            self.assertEqual(ga, grads[0])
+
+            # reentrant backward inside the branches
+            from torch.utils.checkpoint import checkpoint
+            a.grad = None
+            outs = [checkpoint(lambda x, b=b: x.mm(b).tanh(), a).sum() for b in bs]
+            torch.stack(outs).sum().backward()
+            expected = sum((1 - a.detach().mm(b.detach()).tanh() ** 2).mm(b.detach().t()) for b in bs)
+            self.assertEqual(a.grad, expected)
+
+            # errors in a branch surface on the calling thread
+            class Fail(Function):
+                @staticmethod
+                def forward(ctx, x):
+                    return x.clone()
+
+                @staticmethod
+                def backward(ctx, grad):
+                    raise RuntimeError("failing branch")
+
+            out = sum((Fail.apply(a) if i == 5 else a * i).sum() for i in range(12))
+            with self.assertRaisesRegex(RuntimeError, "failing branch"):
+                out.backward()
+
+            with self.assertRaisesRegex(RuntimeError, "must be non-negative"):
+                torch.autograd.set_num_cpu_backward_threads(-1)
+        finally:
+            torch.autograd.set_num_cpu_backward_threads(prev)
+
+    def test_backward_schedule_caching(self):
+        prev = torch.autograd.is_backward_schedule_caching_enabled()
+        torch.autograd.set_backward_schedule_caching(True)
+        try:
+            self.assertTrue(torch.autograd.is_backward_schedule_caching_enabled())
+            a = torch.randn(4, 4, requires_grad=True)
+            b = torch.randn(4, 4, requires_grad=True)
+
+            def loss():
+                x = a.mm(b)
+                y = x.tanh() + x.sigmoid() * a
+                return (y * y).sum() + b.exp().sum()
+
+            def reference():
+                with torch.no_grad():
+                    x = a.mm(b)
+                    t, s = x.tanh(), x.sigmoid()
+                    y = t + s * a
+                    gy = 2 * y
+                    gx = gy * (1 - t * t) + gy * a * s * (1 - s)
+                    return gx.mm(b.t()) + gy * s, a.t().mm(gx) + b.exp()
+
+            expected = reference()
+            # the first iteration records the schedule, the others replay it
+            for _ in range(3):
+                a.grad = None
+                b.grad = None
+                loss().backward()
+                self.assertEqual((a.grad, b.grad), expected)
+
+            # grad only runs the needed nodes
+            for _ in range(2):
+                ga, = torch.autograd.grad(loss(), a)
+                self.assertEqual(ga, expected[0])
+
+            # hooks, retain_graph and errors behave as without caching
+            seen = []
+            out = loss()
+            a.register_hook(lambda g: seen.append(g))
+            out.backward(retain_graph=True)
+            a.grad = None
+            out.backward()
+            self.assertEqual(len(seen), 2)
+            self.assertEqual(a.grad, expected[0])
+            with self.assertRaisesRegex(RuntimeError, "Trying to backward through the graph a second time"):
+                out.backward()
+        finally:
+            torch.autograd.set_backward_schedule_caching(prev)
+
+    def test_saved_tensors_hooks(self):
+        counts = {"pack": 0, "unpack": 0, "prefetch": 0}
+
+        def pack(x):
+            counts["pack"] += 1
+            return [x.clone()]
+
+        def unpack(packed):
+            counts["unpack"] += 1
+            return packed[0]
+
+        def prefetch(packed):
+            counts["prefetch"] += 1
+
+        a = torch.randn(5, requires_grad=True)
+        with torch.autograd.graph.saved_tensors_hooks(pack, unpack, prefetch):
+            # mul saves both of its inputs and exp its result
+            y = (a * a).exp()
+            # ops of the hooks themselves don't save anything
+            self.assertEqual(counts["pack"], 3)
+        z = a * 2
+        self.assertEqual(counts["pack"], 3)
+
+        y.sum().backward(retain_graph=True)
+        self.assertEqual(counts["unpack"], 3)
+        self.assertEqual(counts["prefetch"], 3)
+        self.assertEqual(a.grad, 2 * a * (a * a).exp())
+
+        a.grad = None
+        y.sum().backward()
+        self.assertEqual(counts["unpack"], 6)
+        self.assertEqual(a.grad, 2 * a * (a * a).exp())
+        with self.assertRaisesRegex(RuntimeError, "Trying to backward through the graph a second time"):
+            y.sum().backward()
+
+        # nested hooks replace the outer ones
+        with torch.autograd.graph.saved_tensors_hooks(
+                lambda x: self.fail("outer hooks called"), lambda x: x):
+            with torch.autograd.graph.saved_tensors_hooks(pack, unpack):
+                y = a * a
+        y.sum().backward()
+        self.assertEqual(counts["pack"], 5)
+        self.assertEqual(counts["unpack"], 8)
+
+        with torch.autograd.graph.saved_tensors_hooks(lambda x: x, lambda x: 1):
+            y = a * a
+        with self.assertRaisesRegex(TypeError, "unpack_hook expected to be a Tensor"):
+            y.sum().backward()
+
     def test_anomaly_detect_nan(self):
         size = 10
 
@@ -3460,6 +3864,59 @@ class TestAutograd(TestCase):
                     out.backward()
             self.assertIn('MyFunc.apply', str(w[0].message))
 
+    def test_anomaly_nan_check(self):
+        size = 10
+
+        class MyFunc(Function):
+            @staticmethod
+            def forward(ctx, inp, bad_value):
+                ctx.bad_value = bad_value
+                return inp.sum(0, keepdim=True)
+
+            @staticmethod
+            def backward(ctx, gO):
+                gI = gO.clone().expand(size)
+                if ctx.bad_value is not None:
+                    gI[0] = ctx.bad_value
+                return gI, None
+
+        inp = torch.rand(size, requires_grad=True)
+        with warnings.catch_warnings(record=True) as w:
+            with detect_anomaly(check_nan_only=True):
+                self.assertTrue(torch.is_anomaly_nan_check_enabled())
+                self.assertFalse(torch.is_anomaly_enabled())
+                MyFunc.apply(inp, None).backward()
+        self.assertEqual(len(w), 0)
+        self.assertFalse(torch.is_anomaly_nan_check_enabled())
+
+        for bad_value in [float('nan'), float('inf'), -float('inf')]:
+            out = MyFunc.apply(inp, bad_value)
+            with self.assertRaisesRegex(RuntimeError, "Anomaly nan check"):
+                with detect_anomaly(check_nan_only=True):
+                    out.backward()
+
+        with torch.autograd.set_detect_anomaly(True, check_nan_only=True):
+            self.assertTrue(torch.is_anomaly_nan_check_enabled())
+        self.assertFalse(torch.is_anomaly_nan_check_enabled())
+
+        runs = []
+
+        @torch.autograd.detect_nan_with_rerun
+        def step(bad_value):
+            runs.append(torch.is_anomaly_enabled())
+            inp.grad = None
+            MyFunc.apply(inp, bad_value).backward()
+            return inp.grad
+
+        self.assertEqual(step(None), torch.ones(size))
+        self.assertEqual(runs, [False])
+        with self.assertRaisesRegex(RuntimeError, "Function 'MyFuncBackward' returned nan values in its 0th output."):
+            step(float('nan'))
+        self.assertEqual(runs, [False, False, True])
+        # the full mode only checks for nans, the error of the first run is raised
+        with self.assertRaisesRegex(RuntimeError, "Anomaly nan check"):
+            step(float('inf'))
+
     def test_anomaly_grad_warnings(self):
         # PyTorch won't throw warnings if there is an error
         # but we'd want to at least see them in stderr
@@ -6285,6 +6742,22 @@ class TestAutogradDeviceType(TestCase):
         # previous allocation of z had the same size as the current one.
         self.assertEqual(base_mem, end_mem)
 
+    @onlyCUDA
+    def test_save_on_cpu(self, device):
+        a = torch.randn(1024, 1024, device=device, requires_grad=True)
+        b = a.detach().clone().requires_grad_()
+        with torch.autograd.graph.save_on_cpu():
+            z = ((a * a).exp() ** 2).exp()
+        z.sum().backward()
+        ((b * b).exp() ** 2).exp().sum().backward()
+        self.assertEqual(a.grad, b.grad)
+
+        with torch.autograd.graph.save_on_cpu(pin_memory=False):
+            y = (a.cpu() * a.cpu()).sum() + (a * a).sum()
+        a.grad = None
+        y.backward()
+        self.assertEqual(a.grad, 4 * a)
+
     @onlyCUDA
     def test_pin_memory(self, device):
         x = torch.randn(2, 2, requires_grad=True)
@@ -6517,6 +6990,44 @@ class TestAutogradDeviceType(TestCase):
         # gpu thread ReadyQueue
         out.sum().backward()
 
+    def test_strided_views_share_base_and_version(self, device):
+        # The strided views are created without going through as_strided and
+        # their TensorImpl is reused by autograd, check that they still are
+        # proper views of their base
+        view_fns = [
+            lambda x: x.select(0, 1),
+            lambda x: x[:, 1:3],
+            lambda x: x.transpose(0, 1),
+            lambda x: x.unsqueeze(1),
+            lambda x: x.unsqueeze(0).squeeze(),
+            lambda x: x[:1].expand(3, 4),
+            lambda x: x.permute(1, 0),
+            lambda x: x.diagonal(),
+        ]
+        for requires_grad in (False, True):
+            for view_fn in view_fns:
+                root = torch.randn(3, 4, device=device, requires_grad=requires_grad)
+                base = root.clone()
+                view = view_fn(base)
+                self.assertTrue(view._is_view())
+                self.assertIs(view._base, base)
+                self.assertEqual(view, view_fn(base.detach()))
+                version = base._version
+                base.add_(1)
+                self.assertEqual(view._version, version + 1)
+                self.assertEqual(view, view_fn(base.detach()))
+                with torch.no_grad():
+                    detached = view_fn(base.detach())
+                self.assertEqual(detached._version, base._version)
+
+        root = torch.randn(3, 4, device=device, requires_grad=True)
+        base = root.clone()
+        base.transpose(0, 1).select(0, 1).mul_(2)
+        base.sum().backward()
+        expected = torch.ones(3, 4, device=device)
+        expected[:, 1] = 2
+        self.assertEqual(root.grad, expected)
+
     def test_inplace_view_backprop_base(self, device):
         # modify view and back-prop through base
         root = torch.randn(2, 2, device=device, requires_grad=True)
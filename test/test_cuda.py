@@ -3,7 +3,7 @@ import io
 import tempfile
 import unittest
 import sys
-from itertools import repeat, chain
+from itertools import repeat, chain, product
 import os
 import gc
 import threading
@@ -44,6 +44,8 @@ TEST_MAGMA = TEST_CUDA
 TEST_LARGE_TENSOR = TEST_CUDA
 TEST_MEDIUM_TENSOR = TEST_CUDA
 TEST_CUDNN = TEST_CUDA
+TEST_CUDA_GRAPH = TEST_CUDA and not TEST_WITH_ROCM and torch.version.cuda is not None and \
+    int(torch.version.cuda.split(".")[0]) >= 11
 if TEST_CUDA:
     torch.ones(1).cuda()  # has_magma shows up after cuda is initialized
     TEST_CUDNN = TEST_CUDA and (TEST_WITH_ROCM or
@@ -125,7 +127,8 @@ class TestCuda(TestCase):
             expected["active_bytes.all.current"] += segment["active_size"]
             expected["active_bytes." + pool_str + ".current"] += segment["active_size"]
 
-            is_split = len(segment["blocks"]) > 1
+            # free memory of expandable segments is not counted as inactive split
+            is_split = len(segment["blocks"]) > 1 and not segment["is_expandable"]
             for block in segment["blocks"]:
                 if block["state"] == "active_allocated":
                     expected["allocation.all.current"] += 1
@@ -302,6 +305,243 @@ class TestCuda(TestCase):
                 torch.cuda.caching_allocator_delete(mem)
                 self.assertEqual(torch.cuda.memory_allocated(), prev)
 
+    @unittest.skipIf(TEST_WITH_ROCM, "expandable segments are not supported on ROCm")
+    def test_expandable_segments(self):
+        import subprocess
+        subprocess.check_call([sys.executable, '-c', """\
+import torch
+# growing allocations on one stream are served by a single segment
+tensors = [torch.empty(30 * 2 ** 20, dtype=torch.uint8, device='cuda') for _ in range(8)]
+stats = torch.cuda.memory_stats()
+assert stats['segment.large_pool.current'] == 1, stats['segment.large_pool.current']
+assert torch.cuda.memory_reserved() >= 8 * 30 * 2 ** 20
+# a request larger than any free block extends the segment behind the free tail
+del tensors[-1]
+big = torch.empty(60 * 2 ** 20, dtype=torch.uint8, device='cuda')
+assert torch.cuda.memory_stats()['segment.large_pool.current'] == 1
+big.fill_(1)
+assert big.sum().item() == 60 * 2 ** 20
+del tensors, big
+torch.cuda.empty_cache()
+assert torch.cuda.memory_reserved() == 0, torch.cuda.memory_reserved()
+assert torch.cuda.memory_stats()['segment.all.current'] == 0
+"""], env=dict(os.environ, PYTORCH_CUDA_ALLOC_CONF="expandable_segments:True"))
+
+    def test_allocator_settings(self):
+        import subprocess
+        subprocess.check_call([sys.executable, '-c', """\
+import torch
+MB = 2 ** 20
+# requests are rounded up to one of 4 divisions between powers of two
+x = torch.empty(1100 * 2 ** 10, dtype=torch.uint8, device='cuda')
+assert torch.cuda.memory_allocated() == 1280 * 2 ** 10, torch.cuda.memory_allocated()
+del x
+# blocks of max_split_size_mb or more are not split for smaller requests
+x = torch.empty(300 * MB, dtype=torch.uint8, device='cuda')
+del x
+y = torch.empty(30 * MB, dtype=torch.uint8, device='cuda')
+assert torch.cuda.memory_stats()['segment.large_pool.current'] == 2
+assert torch.cuda.memory_stats()['inactive_split.large_pool.current'] == 0
+"""], env=dict(os.environ, PYTORCH_CUDA_ALLOC_CONF="max_split_size_mb:200,roundup_power2_divisions:4"))
+
+        for conf in ["max_split_size_mb:10", "roundup_power2_divisions:3", "small_size_mb:4", "foo:1",
+                     "garbage_collection_threshold:1.5"]:
+            with self.assertRaises(subprocess.CalledProcessError):
+                subprocess.check_call([sys.executable, '-c', "import torch; torch.empty(1, device='cuda')"],
+                                      env=dict(os.environ, PYTORCH_CUDA_ALLOC_CONF=conf),
+                                      stderr=subprocess.DEVNULL)
+
+    def test_cross_stream_reuse(self):
+        import subprocess
+        subprocess.check_call([sys.executable, '-c', """\
+import torch
+MB = 2 ** 20
+s = torch.cuda.Stream()
+x = torch.empty(30 * MB, dtype=torch.uint8, device='cuda')
+ptr = x.data_ptr()
+with torch.cuda.stream(s):
+    torch.cuda._sleep(50000000)
+x.record_stream(s)
+del x
+reserved = torch.cuda.memory_reserved()
+# the block is reused while the use on s may still be running
+y = torch.empty(30 * MB, dtype=torch.uint8, device='cuda')
+assert y.data_ptr() == ptr
+assert torch.cuda.memory_reserved() == reserved
+del y
+# a segment cached for the current stream is handed over to s
+with torch.cuda.stream(s):
+    z = torch.empty(30 * MB, dtype=torch.uint8, device='cuda')
+assert z.data_ptr() == ptr
+assert torch.cuda.memory_reserved() == reserved
+"""], env=dict(os.environ, PYTORCH_CUDA_ALLOC_CONF="cross_stream_reuse:True"))
+
+    @unittest.skipIf(not TEST_CUDA_GRAPH, "CUDA >= 11.0 required for graphs")
+    def test_graph_capture_simple(self):
+        s = torch.cuda.Stream()
+        a = torch.full((1000,), 1, device="cuda")
+        with torch.cuda.stream(s):
+            g = torch.cuda.CUDAGraph()
+            g.capture_begin()
+            b = a
+            for _ in range(10):
+                b = b + 1
+            g.capture_end()
+        torch.cuda.current_stream().wait_stream(s)
+
+        # capture does not run the work
+        g.replay()
+        self.assertEqual(b.sum().item(), 11000.)
+        a.fill_(2)
+        g.replay()
+        self.assertEqual(b.sum().item(), 12000.)
+
+    @unittest.skipIf(not TEST_CUDA_GRAPH, "CUDA >= 11.0 required for graphs")
+    def test_graph_capture_errors(self):
+        g = torch.cuda.CUDAGraph()
+        with self.assertRaisesRegex(RuntimeError, "non-default stream"):
+            g.capture_begin()
+        with self.assertRaisesRegex(RuntimeError, "without a preceding successful capture"):
+            g.replay()
+
+        # random ops that are not graph-safe refuse to be captured
+        s = torch.cuda.Stream()
+        with torch.cuda.stream(s):
+            g.capture_begin()
+            try:
+                with self.assertRaisesRegex(RuntimeError, "during CUDA graph capture"):
+                    torch.randn(4, device="cuda")
+            finally:
+                try:
+                    g.capture_end()
+                except RuntimeError:
+                    pass
+        torch.cuda.synchronize()
+
+    @unittest.skipIf(not TEST_CUDA_GRAPH, "CUDA >= 11.0 required for graphs")
+    def test_graph_rng_dropout(self):
+        size = 10000
+        x = torch.ones(size, device="cuda")
+        s = torch.cuda.Stream()
+
+        torch.cuda.manual_seed(5)
+        eager = [torch.nn.functional.dropout(x, 0.5) for _ in range(3)]
+
+        torch.cuda.manual_seed(5)
+        with torch.cuda.stream(s):
+            g = torch.cuda.CUDAGraph()
+            g.capture_begin()
+            out = torch.nn.functional.dropout(x, 0.5)
+            g.capture_end()
+        torch.cuda.current_stream().wait_stream(s)
+
+        # each replay draws the numbers eager mode would have drawn next
+        for expected in eager:
+            g.replay()
+            self.assertEqual(out, expected)
+        # and the generator advanced past them
+        self.assertNotEqual(torch.nn.functional.dropout(x, 0.5), eager[0])
+
+    @unittest.skipIf(not TEST_CUDA_GRAPH, "CUDA >= 11.0 required for graphs")
+    def test_graph_memory_pool(self):
+        s = torch.cuda.Stream()
+        a = torch.ones(1 << 20, device="cuda")
+        with torch.cuda.stream(s):
+            g = torch.cuda.CUDAGraph()
+            g.capture_begin()
+            b = a * 2
+            ptr = b.data_ptr()
+            c = b + 1
+            del b
+            g.capture_end()
+        torch.cuda.current_stream().wait_stream(s)
+
+        # memory freed during capture stays reserved for the replays
+        d = torch.empty(1 << 20, device="cuda")
+        self.assertNotEqual(d.data_ptr(), ptr)
+        g.replay()
+        self.assertEqual(c, torch.full_like(a, 3))
+
+        # another graph can share the pool
+        g2 = torch.cuda.CUDAGraph()
+        with torch.cuda.stream(s):
+            g2.capture_begin(pool=g.pool())
+            e = c + 1
+            g2.capture_end()
+        torch.cuda.current_stream().wait_stream(s)
+        g2.replay()
+        self.assertEqual(e, torch.full_like(a, 4))
+
+        # once the graphs and their tensors are gone, empty_cache releases the pool
+        reserved = torch.cuda.memory_reserved()
+        del c, e
+        g.reset()
+        del g2
+        torch.cuda.empty_cache()
+        self.assertLess(torch.cuda.memory_reserved(), reserved)
+
+    def test_set_per_process_memory_fraction(self):
+        import subprocess
+        subprocess.check_call([sys.executable, '-c', """\
+import torch
+MB = 2 ** 20
+total = torch.cuda.get_device_properties(0).total_memory
+torch.cuda.set_per_process_memory_fraction(0.5, 0)
+# up to the cap, least recently freed cached blocks are released to make room
+a = torch.empty(int(total * 0.2), dtype=torch.uint8, device='cuda')
+b = torch.empty(int(total * 0.2), dtype=torch.uint8, device='cuda')
+del a
+del b
+c = torch.empty(int(total * 0.3), dtype=torch.uint8, device='cuda')
+assert torch.cuda.memory_reserved() <= total * 0.5
+try:
+    torch.empty(int(total * 0.3), dtype=torch.uint8, device='cuda')
+    raise AssertionError('allocation beyond the cap succeeded')
+except RuntimeError as e:
+    assert 'out of memory' in str(e), str(e)
+del c
+torch.cuda.empty_cache()
+# with a garbage collection threshold the cache is trimmed before reaching the cap
+x = [torch.empty(30 * MB, dtype=torch.uint8, device='cuda') for _ in range(int(total * 0.45) // (30 * MB))]
+del x
+torch.empty(1, device='cuda')
+assert torch.cuda.memory_reserved() <= total * 0.5 * 0.6 + 30 * MB, torch.cuda.memory_reserved()
+"""], env=dict(os.environ, PYTORCH_CUDA_ALLOC_CONF="garbage_collection_threshold:0.6"))
+
+        with self.assertRaises(RuntimeError):
+            torch.cuda.set_per_process_memory_fraction(1.5)
+        with self.assertRaises(TypeError):
+            torch.cuda.set_per_process_memory_fraction(1)
+
+    def test_memory_history(self):
+        import json
+        torch.cuda.empty_cache()
+        torch.cuda.record_memory_history(True, context="python", max_entries=1000)
+        try:
+            x = torch.empty(3 * 2 ** 20, dtype=torch.uint8, device='cuda')
+            addr = x.data_ptr()
+            del x
+            trace = json.loads(torch.cuda.memory_history())
+        finally:
+            torch.cuda.record_memory_history(False)
+
+        events = [e for e in trace['traceEvents'] if e['ph'] == 'i']
+        allocs = [e for e in events if e['name'] == 'alloc' and e['args']['addr'] == addr]
+        frees = [e for e in events if e['name'] == 'free' and e['args']['addr'] == addr]
+        self.assertEqual(len(allocs), 1)
+        self.assertEqual(len(frees), 1)
+        self.assertGreaterEqual(allocs[0]['args']['size'], 3 * 2 ** 20)
+        self.assertLessEqual(allocs[0]['ts'], frees[0]['ts'])
+        self.assertIn('test_memory_history', allocs[0]['args']['stack'])
+        self.assertTrue(any(e['name'] == 'memory' for e in trace['traceEvents']))
+
+        # disabling the recorder keeps the history but stops appending to it
+        torch.empty(1, device='cuda')
+        self.assertEqual(json.loads(torch.cuda.memory_history()), trace)
+
+        with self.assertRaises(RuntimeError):
+            torch.cuda.record_memory_history(True, context="foo")
+
     def test_check_error(self):
         # Assert this call doesn't raise.
         torch.cuda.check_error(0)
@@ -493,6 +733,49 @@ class TestCuda(TestCase):
         y = torch.ones(10000000, dtype=torch.uint8).cuda()
         _test_copy_non_blocking(x, y)
 
+    def test_copy_to_host_async(self):
+        x = torch.randn(1000, 100, device='cuda')
+        y = torch.arange(10, device='cuda')
+        fut = torch.cuda.copy_to_host_async(x)
+        host = fut.wait()
+        self.assertFalse(host.is_cuda)
+        self.assertTrue(host.is_pinned())
+        self.assertEqual(host, x.cpu())
+
+        done = threading.Event()
+        fut = torch.cuda.copy_to_host_async([x, y.t()])
+        fut.then(lambda fut: done.set())
+        copies = fut.wait()
+        self.assertEqual(len(copies), 2)
+        self.assertEqual(copies[0], x.cpu())
+        self.assertEqual(copies[1], y.cpu())
+        self.assertTrue(done.wait(timeout=10))
+
+        with self.assertRaisesRegex(RuntimeError, "expects a CUDA tensor"):
+            torch.cuda.copy_to_host_async(x.cpu())
+
+    def test_to_coalesced(self):
+        tensors = [torch.randn(3, 5), torch.arange(7), torch.tensor([True, False, True]),
+                   torch.randn(4, 6).t(), torch.empty(0), torch.randn(1000, 1000),
+                   torch.randn(2, 3, dtype=torch.double)[1:]]
+        for non_blocking, views in product([False, True], [False, True]):
+            copies = torch.cuda.to_coalesced(tensors, 'cuda', non_blocking, views)
+            self.assertEqual(len(copies), len(tensors))
+            for copy, tensor in zip(copies, tensors):
+                self.assertTrue(copy.is_cuda)
+                self.assertEqual(copy.dtype, tensor.dtype)
+                self.assertEqual(copy.cpu(), tensor)
+            back = torch.cuda.to_coalesced(copies, 'cpu', non_blocking, views)
+            torch.cuda.current_stream().synchronize()
+            for copy, tensor in zip(back, tensors):
+                self.assertFalse(copy.is_cuda)
+                self.assertEqual(copy, tensor)
+
+        with self.assertRaisesRegex(RuntimeError, "from the host to a CUDA device"):
+            torch.cuda.to_coalesced(tensors, 'cpu')
+        with self.assertRaisesRegex(RuntimeError, "on a single device"):
+            torch.cuda.to_coalesced([tensors[0], tensors[1].cuda()], 'cuda')
+
     @unittest.skip("skipped because test could be flaky, see #35144")
     def test_to_non_blocking(self):
         def _test_to_non_blocking(a, non_blocking):
@@ -1284,6 +1567,26 @@ class TestCuda(TestCase):
         self.assertNotEqual(t.data_ptr(), ptr, msg='allocation re-used too soon')
         self.assertEqual(list(gpu_tensor), [1])
 
+    def test_caching_pinned_memory_split(self):
+        before = torch.cuda.host_memory_stats()
+
+        # small requests are packed into shared pinned segments
+        ts = [torch.empty(1000, dtype=torch.uint8).pin_memory() for _ in range(10)]
+        stats = torch.cuda.host_memory_stats()
+        self.assertLessEqual(stats["segment.all.current"], before["segment.all.current"] + 1)
+        self.assertEqual(stats["allocation.small_pool.current"], before["allocation.small_pool.current"] + 10)
+        self.assertEqual(stats["allocated_bytes.small_pool.current"],
+                         before["allocated_bytes.small_pool.current"] + 10 * 1024)
+        self.assertEqual(len({t.data_ptr() for t in ts}), 10)
+
+        del ts
+        stats = torch.cuda.host_memory_stats()
+        self.assertEqual(stats["allocated_bytes.small_pool.current"], before["allocated_bytes.small_pool.current"])
+
+        torch.cuda.reset_host_memory_stats()
+        stats = torch.cuda.host_memory_stats()
+        self.assertEqual(stats["allocation.all.peak"], stats["allocation.all.current"])
+
     @unittest.skipIf(not TEST_MULTIGPU, "only one GPU detected")
     def test_caching_pinned_memory_multi_gpu(self):
         # checks that the events preventing pinned memory from being re-used
@@ -1673,6 +1976,66 @@ class TestCuda(TestCase):
 
         self.assertEqual(x.grad, torch.ones_like(x) * 5)
 
+    def test_backward_multi_stream(self):
+        default_stream = torch.cuda.current_stream()
+        streams = set()
+
+        class RecordStream(torch.autograd.Function):
+            @staticmethod
+            def forward(ctx, x):
+                return x * 2
+
+            @staticmethod
+            def backward(ctx, grad):
+                streams.add(torch.cuda.current_stream())
+                # delays the operation in the background stream
+                torch.cuda._sleep(1000 * 1000)
+                return grad * 2
+
+        prev = torch.autograd.is_backward_multi_stream_enabled()
+        torch.autograd.set_backward_multi_stream(True)
+        try:
+            self.assertTrue(torch.autograd.is_backward_multi_stream_enabled())
+            x = torch.randn(5, 5, device='cuda', requires_grad=True)
+            branches = [RecordStream.apply(x) * (i + 1) for i in range(4)]
+            torch.stack(branches).sum().backward()
+        finally:
+            torch.autograd.set_backward_multi_stream(prev)
+
+        self.assertNotIn(default_stream, streams)
+        self.assertEqual(x.grad, torch.ones_like(x) * 2 * (1 + 2 + 3 + 4))
+
+    def test_parallel_branches(self):
+        default_stream = torch.cuda.current_stream()
+        streams = []
+
+        class Branch(torch.nn.Module):
+            def __init__(self, scale):
+                super(Branch, self).__init__()
+                self.scale = scale
+
+            def forward(self, x):
+                streams.append(torch.cuda.current_stream())
+                # delays the operation in the branch stream
+                torch.cuda._sleep(1000 * 1000)
+                return x * self.scale
+
+        branches = torch.nn.ModuleList([Branch(i + 1) for i in range(4)])
+        x = torch.randn(5, 5, device='cuda', requires_grad=True)
+        outputs = torch.nn.parallel.parallel_branches(branches, x)
+        self.assertEqual(len(set(streams)), len(branches))
+        self.assertNotIn(default_stream, streams)
+        self.assertEqual(torch.cuda.current_stream(), default_stream)
+        for i, output in enumerate(outputs):
+            self.assertEqual(output, x * (i + 1))
+        torch.stack(outputs).sum().backward()
+        self.assertEqual(x.grad, torch.ones_like(x) * (1 + 2 + 3 + 4))
+
+        # runs the branches in turn on the CPU
+        streams.clear()
+        outputs = torch.nn.parallel.parallel_branches(branches[:1], torch.ones(2))
+        self.assertEqual(outputs, [torch.ones(2)])
+
     @unittest.skipIf(not TEST_MULTIGPU, "only one GPU detected")
     def test_streaming_backwards_device_transfer(self):
         # This function must run with non-default current streams on all devices, otherwise it's meaningless.
@@ -1832,6 +2195,108 @@ t2.start()
         found_inf = scaler._unscale_grads_(opt, inv_scale, found_inf, True)[cur]
         self.assertEqual(found_inf, 1.0)
 
+    def test_grad_scaling_unscale_foreach(self, device="cuda"):
+        inv_scale = torch.tensor([0.25], dtype=torch.float, device=device)
+        found_inf = torch.zeros((1,), dtype=torch.float, device=device)
+
+        # many tensors, to span several launches, and a non-dense one for the per-tensor path
+        grads = [torch.full((size,), 4., device=device) for size in range(1, 200)]
+        grads.append(torch.full((4, 4), 4., device=device).t())
+        torch._amp_foreach_non_finite_check_and_unscale_(grads, found_inf, inv_scale)
+        self.assertEqual(found_inf, 0.0)
+        for g in grads:
+            self.assertEqual(g, torch.ones_like(g))
+
+        for bad in (float('inf'), float('nan')):
+            grads = [torch.full((1000,), 4., device=device) for _ in range(5)]
+            grads[3][517] = bad
+            found_inf.zero_()
+            torch._amp_foreach_non_finite_check_and_unscale_(grads, found_inf, inv_scale)
+            self.assertEqual(found_inf, 1.0)
+
+    def _fused_optimizer_params(self, dtype):
+        # sizes that span several chunks and launches
+        sizes = [(3,), (70000,), (17, 5)] + [(7,)] * 40
+        return [torch.randn(size, device="cuda").to(dtype) for size in sizes]
+
+    def test_fused_adam(self):
+        for dtype in (torch.float, torch.double):
+            for amsgrad, weight_decay, decoupled in [(False, 0., False), (True, 0.1, False), (False, 0.1, True)]:
+                params = self._fused_optimizer_params(dtype)
+                ref_params = [p.clone().requires_grad_() for p in params]
+                opt_cls = torch.optim.AdamW if decoupled else torch.optim.Adam
+                ref_opt = opt_cls(ref_params, lr=0.1, weight_decay=weight_decay, amsgrad=amsgrad)
+                exp_avgs = [torch.zeros_like(p) for p in params]
+                exp_avg_sqs = [torch.zeros_like(p) for p in params]
+                max_exp_avg_sqs = [torch.zeros_like(p) for p in params] if amsgrad else []
+
+                for step in range(1, 4):
+                    grads = [torch.randn_like(p) for p in params]
+                    for p, g in zip(ref_params, grads):
+                        p.grad = g.clone()
+                    ref_opt.step()
+                    torch._fused_adam_(params, grads, exp_avgs, exp_avg_sqs, max_exp_avg_sqs, [],
+                                       [float(step)] * len(params), lr=0.1, beta1=0.9, beta2=0.999,
+                                       weight_decay=weight_decay, eps=1e-8, amsgrad=amsgrad,
+                                       decoupled_weight_decay=decoupled)
+                    self.assertEqual(params, [p.detach() for p in ref_params])
+
+    def test_fused_adam_master_params(self):
+        for dtype in (torch.half, torch.bfloat16):
+            params = self._fused_optimizer_params(dtype)
+            masters = [p.float() for p in params]
+            ref_params = [m.clone().requires_grad_() for m in masters]
+            ref_opt = torch.optim.Adam(ref_params, lr=0.1)
+            exp_avgs = [torch.zeros_like(m) for m in masters]
+            exp_avg_sqs = [torch.zeros_like(m) for m in masters]
+
+            for step in range(1, 4):
+                grads = [torch.randn_like(p) for p in params]
+                for p, g in zip(ref_params, grads):
+                    p.grad = g.float()
+                ref_opt.step()
+                torch._fused_adam_(params, grads, exp_avgs, exp_avg_sqs, [], masters,
+                                   [float(step)] * len(params), lr=0.1, beta1=0.9, beta2=0.999,
+                                   weight_decay=0., eps=1e-8, amsgrad=False, decoupled_weight_decay=False)
+                self.assertEqual(masters, [p.detach() for p in ref_params])
+                self.assertEqual(params, [m.to(dtype) for m in masters])
+
+    def test_fused_sgd(self):
+        for momentum, nesterov, weight_decay in [(0., False, 0.), (0.9, False, 0.1), (0.9, True, 0.)]:
+            params = self._fused_optimizer_params(torch.float)
+            ref_params = [p.clone().requires_grad_() for p in params]
+            ref_opt = torch.optim.SGD(ref_params, lr=0.1, momentum=momentum, nesterov=nesterov,
+                                      weight_decay=weight_decay)
+            bufs = [torch.empty_like(p) for p in params] if momentum != 0 else []
+
+            for step in range(3):
+                grads = [torch.randn_like(p) for p in params]
+                for p, g in zip(ref_params, grads):
+                    p.grad = g.clone()
+                ref_opt.step()
+                torch._fused_sgd_(params, grads, bufs, [], lr=0.1, momentum=momentum, dampening=0.,
+                                  weight_decay=weight_decay, nesterov=nesterov, first_step=(step == 0))
+                self.assertEqual(params, [p.detach() for p in ref_params])
+
+    def test_fused_optimizer_skips_step_on_found_inf(self):
+        params = self._fused_optimizer_params(torch.float)
+        expected = [p.clone() for p in params]
+        grads = [torch.randn_like(p) for p in params]
+        bufs = [torch.zeros_like(p) for p in params]
+        found_inf = torch.ones((1,), device="cuda")
+        torch._fused_adam_(params, grads, [torch.zeros_like(p) for p in params],
+                           [torch.zeros_like(p) for p in params], [], [], [1.] * len(params),
+                           lr=0.1, beta1=0.9, beta2=0.999, weight_decay=0., eps=1e-8,
+                           amsgrad=False, decoupled_weight_decay=False, found_inf=found_inf)
+        torch._fused_sgd_(params, grads, bufs, [], lr=0.1, momentum=0.9, dampening=0.,
+                          weight_decay=0., nesterov=False, first_step=True, found_inf=found_inf)
+        self.assertEqual(params, expected)
+        self.assertEqual(bufs, [torch.zeros_like(p) for p in params])
+
+        with self.assertRaisesRegex(RuntimeError, "same sizes and strides"):
+            torch._fused_sgd_(params, [g.t() if g.dim() == 2 else g for g in grads], [], [], lr=0.1,
+                              momentum=0., dampening=0., weight_decay=0., nesterov=False, first_step=False)
+
     @unittest.skipIf(not TEST_MULTIGPU, "only one GPU detected")
     def test_grad_scaling_device_as_key(self):
         # Ensure that different instances of "device" objects that point to the same device
@@ -2486,7 +2951,7 @@ t2.start()
                 b_ignore = torch.ones((8, 8), dtype=ignore_type, device="cuda:0")
                 c_16 = torch.ones((8, 8), dtype=torch.float16, device="cuda:0")
 
-                # Tests if CastPolicy::fp16 ops ignore double and int
+                # Tests if CastPolicy::lower_precision_fp ops ignore double and int
                 # Currently, no ops belonging to this policy support integer inputs.
                 if ignore_type is torch.double:
                     with self.assertRaises(RuntimeError):
@@ -2600,6 +3065,43 @@ t2.start()
             model()
             model_jit_script()
 
+    def test_autocast_linear(self):
+        linear = torch.nn.Linear(8, 4).cuda()
+        x = torch.randn((3, 5, 8), device="cuda")
+        with torch.cuda.amp.autocast():
+            out = linear(x)
+        self.assertTrue(out.dtype is torch.float16)
+        self.assertEqual(out.shape, (3, 5, 4))
+        expected = torch.nn.functional.linear(x.half(), linear.weight.half(), linear.bias.half())
+        self.assertEqual(out, expected, atol=1e-3, rtol=1e-3)
+        out.float().sum().backward()
+        self.assertTrue(linear.weight.grad.dtype is torch.float32)
+        self.assertTrue(linear.bias.grad.dtype is torch.float32)
+
+    def test_autocast_persistent_cache(self):
+        linear = torch.nn.Linear(8, 8).cuda()
+        x = torch.randn((4, 8), device="cuda")
+
+        def count_casts():
+            with torch.autograd.profiler.profile() as prof:
+                with torch.cuda.amp.autocast(persistent_cache=True):
+                    linear(x)
+            return len([e for e in prof.function_events if e.name == "aten::to"])
+
+        try:
+            # The first pass casts the input, the weight and the bias, the second one only the input
+            self.assertEqual(count_casts(), 3)
+            self.assertEqual(count_casts(), 1)
+            with torch.no_grad():
+                linear.weight.add_(1)
+            self.assertEqual(count_casts(), 2)
+            # Without persistent_cache, the casts are dropped as the region exits
+            with torch.cuda.amp.autocast():
+                linear(x)
+            self.assertEqual(count_casts(), 3)
+        finally:
+            torch.clear_autocast_cache()
+
     @slowTest
     @unittest.skipIf(not TEST_LARGE_TENSOR, "not enough memory")
     def test_max_large_axis(self):
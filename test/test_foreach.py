@@ -1,7 +1,8 @@
 import torch
 import torch.cuda
+from torch._six import inf
 from torch.testing._internal.common_utils import TestCase, run_tests
-from torch.testing._internal.common_device_type import instantiate_device_type_tests, dtypes
+from torch.testing._internal.common_device_type import instantiate_device_type_tests, dtypes, dtypesIfCUDA
 
 class TestForeach(TestCase):
     @dtypes(*torch.testing.get_all_dtypes())
@@ -96,6 +97,191 @@ class TestForeach(TestCase):
         res = torch._foreach_add(tensors, scalar)
         self.assertEqual(res, [torch.tensor([1.1], device=device)])
 
+    def _get_test_data(self, device, dtype, N=20):
+        return [torch.randn(N, N, device=device).to(dtype) for _ in range(N)]
+
+    def _test_binary_op_scalar(self, foreach_op, foreach_op_, torch_op, device, dtype, scalar):
+        tensors = self._get_test_data(device, dtype)
+        expected = [torch_op(t, scalar) for t in tensors]
+
+        res = foreach_op(tensors, scalar)
+        self.assertEqual(res, expected)
+
+        foreach_op_(tensors, scalar)
+        self.assertEqual(tensors, expected)
+
+    @dtypes(torch.float, torch.double)
+    @dtypesIfCUDA(*torch.testing.get_all_fp_dtypes())
+    def test_binary_ops_scalar(self, device, dtype):
+        for scalar in [2, 0.5]:
+            self._test_binary_op_scalar(torch._foreach_add, torch._foreach_add_, torch.add, device, dtype, scalar)
+            self._test_binary_op_scalar(torch._foreach_sub, torch._foreach_sub_, torch.sub, device, dtype, scalar)
+            self._test_binary_op_scalar(torch._foreach_mul, torch._foreach_mul_, torch.mul, device, dtype, scalar)
+            self._test_binary_op_scalar(torch._foreach_div, torch._foreach_div_, torch.div, device, dtype, scalar)
+
+    def test_div_scalar_with_int_tensors(self, device):
+        # integer division promotes to float, which goes the slow route
+        tensors = [torch.arange(10, device=device), torch.arange(4, device=device)]
+        res = torch._foreach_div(tensors, 2)
+        self.assertEqual(res, [torch.div(t, 2) for t in tensors])
+
+    @dtypes(torch.float, torch.double)
+    @dtypesIfCUDA(*torch.testing.get_all_fp_dtypes())
+    def test_binary_ops_scalarlist(self, device, dtype):
+        tensors = self._get_test_data(device, dtype)
+        scalars = [float(i + 1) for i in range(len(tensors))]
+        for foreach_op, foreach_op_, torch_op in [
+                (torch._foreach_add, torch._foreach_add_, torch.add),
+                (torch._foreach_sub, torch._foreach_sub_, torch.sub),
+                (torch._foreach_mul, torch._foreach_mul_, torch.mul),
+                (torch._foreach_div, torch._foreach_div_, torch.div)]:
+            inputs = [t.clone() for t in tensors]
+            expected = [torch_op(t, s) for t, s in zip(inputs, scalars)]
+            self.assertEqual(foreach_op(inputs, scalars), expected)
+            foreach_op_(inputs, scalars)
+            self.assertEqual(inputs, expected)
+
+    def test_binary_ops_scalarlist_with_wrong_length(self, device):
+        tensors = self._get_test_data(device, torch.float)
+        with self.assertRaisesRegex(RuntimeError, "same number of elements as scalar list"):
+            torch._foreach_add(tensors, [1.0, 2.0])
+
+    @dtypes(*torch.testing.get_all_dtypes(include_half=False, include_bfloat16=False, include_bool=False))
+    @dtypesIfCUDA(*torch.testing.get_all_dtypes(include_bool=False))
+    def test_binary_ops_list(self, device, dtype):
+        tensors1 = self._get_test_data(device, dtype)
+        tensors2 = self._get_test_data(device, dtype)
+
+        self.assertEqual(torch._foreach_add(tensors1, tensors2), [torch.add(t1, t2) for t1, t2 in zip(tensors1, tensors2)])
+        self.assertEqual(torch._foreach_sub(tensors1, tensors2), [torch.sub(t1, t2) for t1, t2 in zip(tensors1, tensors2)])
+        self.assertEqual(torch._foreach_mul(tensors1, tensors2), [torch.mul(t1, t2) for t1, t2 in zip(tensors1, tensors2)])
+        self.assertEqual(
+            torch._foreach_add(tensors1, tensors2, alpha=2),
+            [torch.add(t1, t2, alpha=2) for t1, t2 in zip(tensors1, tensors2)])
+
+        expected = [torch.sub(t1, t2, alpha=3) for t1, t2 in zip(tensors1, tensors2)]
+        torch._foreach_sub_(tensors1, tensors2, alpha=3)
+        self.assertEqual(tensors1, expected)
+
+    @dtypes(torch.float, torch.double)
+    @dtypesIfCUDA(*torch.testing.get_all_fp_dtypes())
+    def test_div_list(self, device, dtype):
+        tensors1 = self._get_test_data(device, dtype)
+        tensors2 = [t.abs().add(1) for t in self._get_test_data(device, dtype)]
+
+        expected = [torch.div(t1, t2) for t1, t2 in zip(tensors1, tensors2)]
+        self.assertEqual(torch._foreach_div(tensors1, tensors2), expected)
+        torch._foreach_div_(tensors1, tensors2)
+        self.assertEqual(tensors1, expected)
+
+    def test_binary_ops_list_with_different_sizes(self, device):
+        tensors1 = [torch.zeros(10, 10, device=device) for _ in range(10)]
+        tensors2 = [torch.ones(11, 11, device=device) for _ in range(10)]
+        with self.assertRaisesRegex(RuntimeError, "Corresponding tensors in lists must have the same size"):
+            torch._foreach_add(tensors1, tensors2)
+
+    def test_binary_ops_list_slow_route(self, device):
+        # different dtypes, overlapping and non-contiguous tensors go the slow route
+        tensors1 = [torch.ones(3, 3, device=device), torch.ones(3, 3, device=device, dtype=torch.double)]
+        tensors2 = [torch.ones(3, 3, device=device).t(), torch.ones(1, 1, device=device).expand(3, 3)]
+        expected = [torch.add(t1, t2) for t1, t2 in zip(tensors1, tensors2)]
+        self.assertEqual(torch._foreach_add(tensors1, tensors2), expected)
+
+    @dtypes(torch.float, torch.double)
+    @dtypesIfCUDA(*torch.testing.get_all_fp_dtypes())
+    def test_pointwise_ops(self, device, dtype):
+        inputs = self._get_test_data(device, dtype)
+        tensors1 = self._get_test_data(device, dtype)
+        tensors2 = [t.abs().add(1) for t in self._get_test_data(device, dtype)]
+        scalars = [float(i + 1) for i in range(len(inputs))]
+
+        for foreach_op, foreach_op_, torch_op in [
+                (torch._foreach_addcmul, torch._foreach_addcmul_, torch.addcmul),
+                (torch._foreach_addcdiv, torch._foreach_addcdiv_, torch.addcdiv)]:
+            expected = [torch_op(i, t1, t2, value=2) for i, t1, t2 in zip(inputs, tensors1, tensors2)]
+            self.assertEqual(foreach_op(inputs, tensors1, tensors2, 2), expected)
+
+            expected = [torch_op(i, t1, t2, value=s) for i, t1, t2, s in zip(inputs, tensors1, tensors2, scalars)]
+            self.assertEqual(foreach_op(inputs, tensors1, tensors2, scalars), expected)
+
+            res = [t.clone() for t in inputs]
+            foreach_op_(res, tensors1, tensors2, scalars)
+            self.assertEqual(res, expected)
+
+    @dtypes(torch.float, torch.double)
+    @dtypesIfCUDA(*torch.testing.get_all_fp_dtypes())
+    def test_unary_ops(self, device, dtype):
+        tensors = [t.abs() for t in self._get_test_data(device, dtype)]
+        for foreach_op, foreach_op_, torch_op in [
+                (torch._foreach_sqrt, torch._foreach_sqrt_, torch.sqrt),
+                (torch._foreach_exp, torch._foreach_exp_, torch.exp)]:
+            inputs = [t.clone() for t in tensors]
+            expected = [torch_op(t) for t in inputs]
+            self.assertEqual(foreach_op(inputs), expected)
+            foreach_op_(inputs)
+            self.assertEqual(inputs, expected)
+
+    @dtypes(*torch.testing.get_all_dtypes())
+    def test_zero(self, device, dtype):
+        tensors = [torch.ones(20, 20, device=device, dtype=dtype) for _ in range(20)]
+        tensors.append(torch.ones(3, 3, device=device, dtype=dtype).t())
+        torch._foreach_zero_(tensors)
+        for t in tensors:
+            self.assertEqual(t, torch.zeros_like(t))
+
+    @dtypes(torch.float, torch.double)
+    @dtypesIfCUDA(*torch.testing.get_all_fp_dtypes())
+    def test_norm(self, device, dtype):
+        tensors = self._get_test_data(device, dtype)
+        for ord in [1, 2, 3]:
+            res = torch._foreach_norm(tensors, ord)
+            expected = [torch.norm(t, ord) for t in tensors]
+            self.assertEqual(res, expected)
+
+    def test_norm_with_large_tensors(self, device):
+        # tensors of many chunks, split over several launches
+        tensors = [torch.randn(70000, device=device) for _ in range(5)]
+        tensors += [torch.randn(10, device=device) for _ in range(120)]
+        res = torch._foreach_norm(tensors)
+        self.assertEqual(res, [torch.norm(t) for t in tensors])
+
+    @dtypes(torch.float, torch.double)
+    @dtypesIfCUDA(*torch.testing.get_all_fp_dtypes())
+    def test_total_norm(self, device, dtype):
+        tensors = self._get_test_data(device, dtype)
+        for ord in [1, 2, 3, inf]:
+            res = torch._foreach_total_norm(tensors, ord)
+            expected = torch.norm(torch.cat([t.flatten() for t in tensors]), ord)
+            self.assertEqual(res, expected)
+
+    def test_total_norm_with_large_tensors(self, device):
+        tensors = [torch.randn(70000, device=device) for _ in range(5)]
+        tensors += [torch.randn(10, device=device) for _ in range(120)]
+        res = torch._foreach_total_norm(tensors)
+        self.assertEqual(res, torch.norm(torch.cat(tensors)))
+
+    @dtypes(torch.float, torch.double)
+    def test_clip_scale(self, device, dtype):
+        tensors = [torch.randn(100, device=device, dtype=dtype) for _ in range(10)]
+        total_norm = torch._foreach_total_norm(tensors)
+        # nothing to clip
+        expected = [t.clone() for t in tensors]
+        torch._foreach_clip_scale_(tensors, total_norm, total_norm.item() * 2)
+        self.assertEqual(tensors, expected)
+        torch._foreach_clip_scale_(tensors, torch.tensor(float('nan'), device=device), 1.)
+        self.assertEqual(tensors, expected)
+        # clipped to half the norm
+        torch._foreach_clip_scale_(tensors, total_norm, total_norm.item() / 2)
+        clip_coef = total_norm.item() / 2 / (total_norm.item() + 1e-6)
+        self.assertEqual(tensors, [t * clip_coef for t in expected])
+
+    def test_many_tensors_with_scalarlist(self, device):
+        # more tensors than one launch holds
+        tensors = [torch.ones(1000, device=device) for _ in range(300)]
+        scalars = [float(i) for i in range(300)]
+        res = torch._foreach_mul(tensors, scalars)
+        self.assertEqual(res, [t * s for t, s in zip(tensors, scalars)])
+
 instantiate_device_type_tests(TestForeach, globals())
 
 if __name__ == '__main__':
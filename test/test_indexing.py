@@ -371,6 +371,45 @@ class TestIndexing(TestCase):
         self.assertEqual(x[idx, ...].tolist(), [[0, 1, 2],
                                                 [6, 7, 8]])
 
+    def test_basic_indexing_view(self, device):
+        # indices made only of integers, slices, None and Ellipsis give the
+        # view the chain of select, slice and unsqueeze calls would
+        def reference(x, indices):
+            specified = sum(1 for i in indices if i is not None and i is not Ellipsis)
+            ndim = x.dim()
+            dim = 0
+            for i in indices:
+                if i is None:
+                    x = x.unsqueeze(dim)
+                    dim += 1
+                elif i is Ellipsis:
+                    dim += ndim - specified
+                elif isinstance(i, slice):
+                    start, stop, step = i.indices(x.size(dim))
+                    x = x.narrow(dim, start, max(stop - start, 0))
+                    x = x.transpose(0, dim)[::step].transpose(0, dim)
+                    dim += 1
+                else:
+                    x = x.select(dim, i)
+            return x
+
+        base = torch.arange(4 * 5 * 6 * 7, dtype=torch.double, device=device).view(4, 5, 6, 7)
+        base = base[1:, :, ::2].transpose(1, 3)
+        for indices in [(0, 1), (slice(1, None), None, -1), (None, Ellipsis, 2),
+                        (1, Ellipsis, None, slice(None, None, 2)), (slice(-2, 10), 0, slice(1, 1)),
+                        (None, None), (-3, 4, 2, 1), (Ellipsis,), ()]:
+            out = base[indices]
+            expected = reference(base, indices)
+            self.assertEqual(out.size(), expected.size())
+            self.assertEqual(out.stride(), expected.stride())
+            self.assertEqual(out.storage_offset(), expected.storage_offset())
+            self.assertEqual(out, expected)
+
+            leaf = torch.randn(base.size(), dtype=torch.double, device=device, requires_grad=True)
+            grad, = torch.autograd.grad(leaf[indices].sum() * 2, leaf)
+            expected_grad, = torch.autograd.grad(reference(leaf, indices).sum() * 2, leaf)
+            self.assertEqual(grad, expected_grad)
+
     def test_invalid_index(self, device):
         x = torch.arange(0, 16, device=device).view(4, 4)
         self.assertRaisesRegex(TypeError, 'slice indices', lambda: x["0":"1"])
@@ -89,6 +89,7 @@ import random
 import shutil
 import sys
 import tempfile
+import time
 import types
 import unittest
 import warnings
@@ -1021,6 +1022,29 @@ class TestJit(JitTestCase):
 
         self.assertExportImport(g, (x, y))
 
+    def test_pass_timings(self):
+        @torch.jit.script
+        def fn(x):
+            return x + x, x + x
+
+        torch._C._jit_reset_pass_timings()
+        old_state = torch._C._jit_set_pass_timing_enabled(True)
+        try:
+            self.run_pass('cse', fn.graph)
+            self.run_pass('cse', fn.graph)
+        finally:
+            torch._C._jit_set_pass_timing_enabled(old_state)
+        timings = torch._C._jit_get_pass_timings()
+        runs, seconds = timings["EliminateCommonSubexpression"]
+        self.assertEqual(runs, 2)
+        self.assertGreaterEqual(seconds, 0)
+        # CSE builds an alias db
+        self.assertIn("AliasDb", timings)
+
+        torch._C._jit_reset_pass_timings()
+        self.run_pass('cse', fn.graph)
+        self.assertEqual(torch._C._jit_get_pass_timings(), {})
+
     def test_cse_not_introduce_aliasing(self):
         @torch.jit.script
         def tensor_alias_outputs(x):
@@ -2545,6 +2569,51 @@ graph(%Ra, %Rb):
 
         torch._C._set_graph_executor_optimize(prev_opt)
 
+    def test_lazy_tensor(self):
+        def fn(x, y):
+            return torch.sigmoid(x * y + 2).neg()
+
+        x = torch.rand(3, 4)
+        y = torch.rand(4)
+        cache_size = torch._C._jit_lazy_graph_cache_size()
+        for _ in range(3):
+            lazy_x = torch._C._jit_to_lazy(x)
+            out = fn(lazy_x, torch._C._jit_to_lazy(y))
+            self.assertTrue(torch._C._jit_is_lazy(out))
+            self.assertEqual(out.size(), (3, 4))
+            self.assertEqual(out.dtype, x.dtype)
+            self.assertEqual(torch._C._jit_lazy_materialize(out), fn(x, y))
+        # The ops of every iteration are the same graph
+        self.assertEqual(torch._C._jit_lazy_graph_cache_size(), cache_size + 1)
+
+        # The ops that aren't recorded run eagerly, and their results are lazy
+        summed = out.sum()
+        self.assertTrue(torch._C._jit_is_lazy(summed))
+        self.assertEqual(summed.item(), fn(x, y).sum().item())
+
+        # Ops of differing dtypes aren't recorded
+        out = torch._C._jit_to_lazy(x) + torch._C._jit_to_lazy(x.double())
+        self.assertEqual(torch._C._jit_lazy_materialize(out), x + x.double())
+
+    def test_lazy_tensor_inplace(self):
+        x = torch.rand(2, 3)
+        base = torch._C._jit_to_lazy(x.clone())
+        before = base * 2
+        base.add_(1)
+        after = base * 2
+        self.assertTrue(torch._C._jit_is_lazy(base))
+        self.assertEqual(torch._C._jit_lazy_materialize(before), x * 2)
+        self.assertEqual(torch._C._jit_lazy_materialize(after), (x + 1) * 2)
+
+    def test_lazy_tensor_autograd(self):
+        x = torch.rand(2, 3)
+        lazy_x = torch._C._jit_to_lazy(x).requires_grad_()
+        out = torch.tanh(lazy_x * 3).mul(lazy_x)
+        out.backward(torch.ones(2, 3))
+        ref_x = x.clone().requires_grad_()
+        torch.tanh(ref_x * 3).mul(ref_x).backward(torch.ones(2, 3))
+        self.assertEqual(torch._C._jit_lazy_materialize(lazy_x.grad), ref_x.grad)
+
 
 class TestFrontend(JitTestCase):
 
@@ -2795,6 +2864,57 @@ class TestScript(JitTestCase):
                 FileCheck().check("Double(*:2, 2:1, requires_grad=0, device=cpu) = ").run(graph_str)
                 FileCheck().check_not("Double(1:2, 2:1, requires_grad=0, device=cpu) = ").run(graph_str)
 
+    @unittest.skipIf(GRAPH_EXECUTOR != ProfilingMode.PROFILING, "skip if profiling isn't enabled")
+    def test_profile_cache(self):
+        def make_fn():
+            def fn(x, y):
+                return x * y + x
+            return torch.jit.script(fn)
+
+        x = torch.rand(2, 3)
+        y = torch.rand(2, 3)
+        with tempfile.TemporaryDirectory() as cache_dir:
+            old_dir = torch._C._jit_set_profile_cache_dir(cache_dir)
+            try:
+                with enable_profiling_mode_for_profiling_tests(), num_profiled_runs(2):
+                    fn = make_fn()
+                    for _ in range(3):
+                        fn(x, y)
+                    self.assertEqual(len(os.listdir(cache_dir)), 1)
+
+                    # the same graph skips profiling and is optimized on its
+                    # first run
+                    cached_fn = make_fn()
+                    self.assertEqual(cached_fn(x, y), x * y + x)
+                    g = torch.jit.last_executed_optimized_graph()
+                    FileCheck().check_not("prim::profile").check("Float(2:3, 3:1").run(g)
+            finally:
+                torch._C._jit_set_profile_cache_dir(old_dir)
+
+    @unittest.skipIf(GRAPH_EXECUTOR != ProfilingMode.PROFILING, "skip if profiling isn't enabled")
+    def test_background_optimization(self):
+        @torch.jit.script
+        def fn(x, y):
+            return x * y + x
+
+        x = torch.rand(2, 3)
+        y = torch.rand(2, 3)
+        old_state = torch._C._jit_set_background_optimization(True)
+        try:
+            with enable_profiling_mode_for_profiling_tests(), num_profiled_runs(1):
+                fn(x, y)
+                # the runs don't wait for the optimization, and get its plan
+                # once it is done
+                for _ in range(1000):
+                    self.assertEqual(fn(x, y), x * y + x)
+                    g = torch.jit.last_executed_optimized_graph()
+                    if "Float(2:3, 3:1" in str(g):
+                        break
+                    time.sleep(0.01)
+                FileCheck().check_not("prim::profile").check("Float(2:3, 3:1").run(g)
+        finally:
+            torch._C._jit_set_background_optimization(old_state)
+
 
     def test_nested_bailouts(self):
         @torch.jit.script
@@ -10596,6 +10716,39 @@ a")
             self.assertEqual(torch.autograd.grad(sout.sum(), inputs),
                              torch.autograd.grad(out.sum(), inputs))
 
+    def test_batch_independent_gemms(self):
+        def heads(x, w0, w1, w2, w3, b0, b1, b2, b3):
+            y0 = torch.relu(torch._C._nn.linear(x, w0, b0))
+            y1 = torch.relu(torch._C._nn.linear(x, w1, b1))
+            y2 = torch.relu(torch._C._nn.linear(x, w2, b2))
+            y3 = torch.relu(torch._C._nn.linear(x, w3, b3))
+            z0 = torch.addmm(b0, y0, w0.t())
+            z1 = torch.addmm(b1, y1, w1.t())
+            z2 = torch.addmm(b2, y2, w2.t())
+            z3 = torch.addmm(b3, y3, w3.t())
+            return z0, z1, z2, z3
+
+        graph = torch.jit.script(heads).graph.copy()
+        self.run_pass('batch_mm', graph)
+        # the linears and the addmms form a batch each, the relus running on
+        # the batched output of the linears
+        FileCheck().check_count("prim::BatchedGEMM", 2, exactly=True).run(graph)
+        FileCheck().check_not("aten::linear").check_not("aten::addmm").check_not("aten::relu").run(graph)
+        fn = torch._C._create_function_from_graph("heads", graph)
+
+        # the large GEMMs run one by one
+        for batch, features in [(8, 16), (1024, 256)]:
+            x = torch.rand(batch, features)
+            weights = [torch.rand(features, features) for _ in range(4)]
+            biases = [torch.rand(features) for _ in range(4)]
+            self.assertEqual(fn(x, *weights, *biases), heads(x, *weights, *biases))
+
+        # operands of different shapes run one by one too
+        weights = [torch.rand(16, 16) for _ in range(3)] + [torch.rand(16, 16).t()]
+        biases = [torch.rand(16) for _ in range(3)] + [torch.rand(1, 16)]
+        x = torch.rand(8, 16)
+        self.assertEqual(fn(x, *weights, *biases), heads(x, *weights, *biases))
+
     def test_loop_unrolling(self):
         def fn(x):
             y = 0
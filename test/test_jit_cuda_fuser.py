@@ -499,6 +499,98 @@ class TestCudaFuser(JitTestCase):
         self.assertGraphContains(t_jit.graph_for(x, y, z), FUSION_GROUP)
 
 
+    @unittest.skipIf(not RUN_CUDA, "requires CUDA")
+    @unittest.skipIf(GRAPH_EXECUTOR != ProfilingMode.PROFILING and GRAPH_EXECUTOR !=
+                     ProfilingMode.LEGACY, "Requires fusion optimization pass to be effective")
+    @skipIfRocm
+    def test_vectorized_pointwise(self):
+        dtype = torch.float
+        device = "cuda"
+
+        def t(x: torch.Tensor, y: torch.Tensor):
+            o = torch.add(x, y)
+            o = torch.relu(o)
+            return o
+        t_jit = torch.jit.script(t)
+
+        base_x = torch.randn([65, 132], dtype=dtype, device=device)
+        base_y = torch.randn([65, 132], dtype=dtype, device=device)
+        # aligned inputs run the vectorized kernel; the misaligned ones, and
+        # the ones with rows that aren't a multiple of the vector width, the
+        # scalar one.
+        for begin, end in ((0, 128), (1, 129), (0, 131)):
+            x = base_x[:, begin:end]
+            y = base_y[:, begin:end]
+            jit_o = t_jit(x, y)
+            jit_o = t_jit(x, y)
+            o = t(x, y)
+            self.assertEqual(o.dtype, jit_o.dtype)
+            self.assertEqual(o, jit_o)
+        self.assertGraphContains(t_jit.graph_for(x, y), FUSION_GROUP)
+
+    @unittest.skipIf(not RUN_CUDA, "requires CUDA")
+    @unittest.skipIf(GRAPH_EXECUTOR != ProfilingMode.PROFILING and GRAPH_EXECUTOR !=
+                     ProfilingMode.LEGACY, "Requires fusion optimization pass to be effective")
+    @skipIfRocm
+    def test_softmax(self):
+        dtype = torch.float
+        device = "cuda"
+
+        def t(x: torch.Tensor, y: torch.Tensor):
+            o = torch.add(x, y)
+            o = torch.softmax(o, dim=-1)
+            return o
+
+        def t_log(x: torch.Tensor, y: torch.Tensor):
+            o = torch.add(x, y)
+            o = torch.log_softmax(o, dim=1)
+            return o
+
+        # rows held by a single thread, by a block, and by a block whose
+        # threads hold several elements each
+        for sizes in ([17, 3], [8, 200], [4, 5000]):
+            x = torch.randn(sizes, dtype=dtype, device=device)
+            y = torch.randn(sizes, dtype=dtype, device=device)
+            for fn in (t, t_log):
+                t_jit = torch.jit.script(fn)
+                jit_o = t_jit(x, y)
+                jit_o = t_jit(x, y)
+                o = fn(x, y)
+                self.assertEqual(o.dtype, jit_o.dtype)
+                self.assertEqual(o, jit_o)
+                self.assertGraphContains(t_jit.graph_for(x, y), FUSION_GROUP)
+
+    @unittest.skipIf(not RUN_CUDA, "requires CUDA")
+    @unittest.skipIf(GRAPH_EXECUTOR != ProfilingMode.PROFILING and GRAPH_EXECUTOR !=
+                     ProfilingMode.LEGACY, "Requires fusion optimization pass to be effective")
+    @skipIfRocm
+    def test_layer_norm(self):
+        dtype = torch.float
+        device = "cuda"
+        x = torch.randn([6, 7, 16, 32], dtype=dtype, device=device)
+        w = torch.randn([16, 32], dtype=dtype, device=device)
+        b = torch.randn([16, 32], dtype=dtype, device=device)
+
+        def t(x: torch.Tensor, w: torch.Tensor, b: torch.Tensor):
+            o = torch.relu(x)
+            o = torch.layer_norm(o, [16, 32], w, b, 1e-5)
+            return o
+
+        def t_no_affine(x: torch.Tensor, w: torch.Tensor, b: torch.Tensor):
+            o = torch.relu(x)
+            o = torch.layer_norm(o, [32])
+            return o
+
+        for fn in (t, t_no_affine):
+            t_jit = torch.jit.script(fn)
+            jit_o = t_jit(x, w, b)
+            jit_o = t_jit(x, w, b)
+            o = fn(x, w, b)
+            self.assertEqual(o.dtype, jit_o.dtype)
+            self.assertEqual(o, jit_o)
+            self.assertGraphContains(t_jit.graph_for(x, w, b), FUSION_GROUP)
+
+
 class TestPassManagerCudaFuser(JitTestCase):
 
     @unittest.skipIf(not RUN_CUDA, "requires CUDA")
@@ -180,6 +180,20 @@ def fs_sharing():
         mp.set_sharing_strategy(prev_strategy)
 
 
+@contextlib.contextmanager
+def arena_sharing(arena_size=None):
+    prev_strategy = mp.get_sharing_strategy()
+    prev_arena_size = mp.get_arena_size()
+    mp.set_sharing_strategy('arena')
+    if arena_size is not None:
+        mp.set_arena_size(arena_size)
+    try:
+        yield
+    finally:
+        mp.set_sharing_strategy(prev_strategy)
+        mp.set_arena_size(prev_arena_size)
+
+
 class leak_checker(object):
 
     def __init__(self, test_case):
@@ -364,6 +378,47 @@ class TestMultiprocessing(TestCase):
             for _ in range(TEST_REPEATS):
                 queue_put()
 
+    @unittest.skipIf(platform != 'linux', "arena strategy is only supported on Linux")
+    def test_arena_sharing(self):
+        # The arena only holds a few of the tensors at a time, whose blocks
+        # are reused once they are released (or replaced by a storage of its
+        # own for a tensor that does not fit)
+        count, size = 200, 256
+        with arena_sharing(16 * size * 4):
+            q = mp.Queue()
+            e = mp.Event()
+            p = mp.Process(target=send_and_delete_tensors,
+                           args=(q, e, 'cpu', torch.float, count, size))
+            p.daemon = True
+            p.start()
+            for i in range(count):
+                t = q.get()
+                self.assertTrue(t.is_shared())
+                self.assertEqual(t, torch.full([size], i), atol=0, rtol=0)
+                del t
+            e.set()
+            p.join(1)
+            self.assertFalse(p.is_alive())
+
+    @unittest.skipIf(platform != 'linux', "arena strategy is only supported on Linux")
+    def test_arena_fill(self):
+        with arena_sharing():
+            x = torch.zeros(5, 5)
+            q = mp.Queue()
+            e = mp.Event()
+            data = [x, x[:, 1]]
+            q.put(data)
+            p = mp.Process(target=simple_fill, args=(q, e))
+            p.daemon = True
+            p.start()
+            e.wait(10)
+            self.assertTrue(e.is_set())
+            self.assertTrue(x.is_shared())
+            self.assertTrue(data[0].eq(4).all())
+            self.assertTrue(data[1].eq(4).all())
+            p.join(1)
+            self.assertFalse(p.is_alive())
+
     def test_inherit_tensor(self):
         t = torch.zeros(5, 5)
         p = SubProcess(t.share_memory_())
@@ -459,6 +514,29 @@ class TestMultiprocessing(TestCase):
         p2.join(1)
         p3.join(1)
 
+    @unittest.skipIf(NO_MULTIPROCESSING_SPAWN, "Disabled for environments that \
+                     don't support multiprocessing with spawn start method")
+    @unittest.skipIf(not TEST_CUDA_IPC, 'CUDA IPC not available')
+    def test_cuda_send_recycled_events(self, size=5, count=3000):
+        # More tensors than the producer creates IPC events, so that the
+        # events of the tensors the consumer released are recorded again.
+        ctx = mp.get_context('spawn')
+        q1 = ctx.Queue()
+        q2 = ctx.Queue()
+        e1 = ctx.Event()
+        e2 = ctx.Event()
+        p1 = ctx.Process(target=send_and_delete_tensors, args=(q1, e1, 'cuda', torch.long, count, size))
+        p2 = ctx.Process(target=receive_and_send_sum, args=(q1, q2, e2, 'cuda', torch.long, count, size))
+        p1.start()
+        p2.start()
+        result = q2.get()
+        self.assertEqual(result.cpu(), torch.full([size], count * (count - 1) // 2, dtype=torch.long))
+        del result
+        e1.set()
+        e2.set()
+        p1.join(1)
+        p2.join(1)
+
     @unittest.skipIf(NO_MULTIPROCESSING_SPAWN, "Disabled for environments that \
                      don't support multiprocessing with spawn start method")
     @unittest.skipIf(not TEST_CUDA_IPC, 'CUDA IPC not available')
@@ -36,15 +36,15 @@ from torch.nn.parallel._functions import Broadcast
 from torch.testing._internal.common_utils import freeze_rng_state, run_tests, TestCase, skipIfNoLapack, skipIfRocm, \
     TEST_NUMPY, TEST_SCIPY, TEST_WITH_ROCM, download_file, \
     get_function_arglist, load_tests, repeat_test_for_types, ALL_TENSORTYPES, \
-    ALL_TENSORTYPES2, TemporaryFileName, TEST_WITH_UBSAN, IS_PPC
+    ALL_TENSORTYPES2, TemporaryFileName, TEST_WITH_UBSAN, IS_PPC, wrapDeterministicFlagAPITest
 from torch.testing._internal.common_cuda import TEST_CUDA, TEST_MULTIGPU, TEST_CUDNN, TEST_CUDNN_VERSION
 from torch.testing._internal.common_nn import NNTestCase, NewModuleTest, NewCriterionTest, \
     module_tests, criterion_tests, new_criterion_tests, loss_reference_fns, \
     ctcloss_reference, new_module_tests
 from torch.testing._internal.common_device_type import instantiate_device_type_tests, dtypes, \
-    dtypesIfCUDA, skipCUDAIfNoCudnn, skipCUDAIfCudnnVersionLessThan, onlyCUDA, \
+    dtypesIfCUDA, skipCUDAIfNoCudnn, skipCUDAIfCudnnVersionLessThan, onlyCUDA, onlyCPU, \
     skipCUDAIfRocm, skipCUDAIf, skipCUDAIfNotRocm, largeCUDATensorTest, onlyOnCPUAndCUDA, \
-    deviceCountAtLeast, expectedAlertNondeterministic, largeTensorTest
+    deviceCountAtLeast, expectedAlertNondeterministic, largeTensorTest, precisionOverride
 from torch.nn import MultiheadAttention
 
 from hypothesis import given
@@ -3925,6 +3925,41 @@ class TestNN(NNTestCase):
             # but it should work with the same type
             nn.functional.conv2d(inputs.float(), weights.float(), bias.float())
 
+    @unittest.skipIf(not TEST_CUDA, 'CUDA not available')
+    @unittest.skipIf(not TEST_CUDNN, 'CUDNN not available')
+    def test_cudnn_convolution_add_relu(self):
+        for memory_format in [torch.contiguous_format, torch.channels_last]:
+            x = torch.randn(2, 8, 9, 11, device="cuda").contiguous(memory_format=memory_format)
+            w = torch.randn(6, 4, 3, 3, device="cuda")
+            b = torch.randn(6, device="cuda")
+            z = torch.randn(2, 6, 5, 9, device="cuda")
+            conv = F.conv2d(x, w, b, stride=(2, 1), padding=(1, 0), groups=2)
+            self.assertEqual(
+                torch.cudnn_convolution_relu(x, w, b, (2, 1), (1, 0), (1, 1), 2),
+                F.relu(conv))
+            self.assertEqual(
+                torch.cudnn_convolution_relu(x, w, None, (2, 1), (1, 0), (1, 1), 2),
+                F.relu(conv - b.view(1, -1, 1, 1)))
+            self.assertEqual(
+                torch.cudnn_convolution_add_relu(x, w, z, b, (2, 1), (1, 0), (1, 1), 2, alpha=0.5),
+                F.relu(conv + 0.5 * z))
+
+    @unittest.skipIf(not TEST_CUDA, 'CUDA not available')
+    @unittest.skipIf(not TEST_CUDNN, 'CUDNN not available')
+    def test_cudnn_benchmark_cache_save_load(self):
+        x = torch.randn(2, 3, 17, 19, device="cuda", requires_grad=True)
+        conv = nn.Conv2d(3, 5, 3).cuda()
+        with cudnn.flags(enabled=True, benchmark=True):
+            conv(x).sum().backward()
+        with TemporaryFileName() as fname:
+            cudnn.save_benchmark_cache(fname)
+            # The forward, data and filter algorithms of the convolution at least.
+            self.assertGreaterEqual(cudnn.load_benchmark_cache(fname), 3)
+            with open(fname, 'r+b') as f:
+                f.write(b'garbage!')
+            self.assertRaisesRegex(RuntimeError, 'is not a cuDNN benchmark cache',
+                                   lambda: cudnn.load_benchmark_cache(fname))
+
     @unittest.skipIf(not TEST_CUDA, 'CUDA not available')
     @unittest.skipIf(not TEST_CUDNN, 'CUDNN not available')
     @repeat_test_for_types(ALL_TENSORTYPES2)
@@ -4081,6 +4116,21 @@ class TestNN(NNTestCase):
                              torch.cat([m1.weight.grad.data, m2.weight.grad.data], 0),
                              atol=1e-1 if dtype == torch.half else dtype2prec_DONTUSE[dtype], rtol=0)
 
+    def test_Conv2d_depthwise_inference_cpu(self):
+        # Without autograd, depthwise 3x3 and 5x5 convolutions of stride 1 or 2
+        # take the direct kernels, which must match the grouped convolution.
+        for kernel_size, stride, padding, multiplier, bias, channels_last in product(
+                [3, 5], [1, 2], [0, 1, 2], [1, 2], [True, False], [True, False]):
+            m = nn.Conv2d(12, 12 * multiplier, kernel_size, stride=stride,
+                          padding=padding, groups=12, bias=bias)
+            i = torch.randn(2, 12, 11, 14)
+            if channels_last:
+                i = i.contiguous(memory_format=torch.channels_last)
+            expected = m(i.requires_grad_()).detach()
+            with torch.no_grad(), torch.backends.mkldnn.flags(enabled=False):
+                output = m(i)
+            self.assertEqual(output, expected)
+
     # Almost identical to the above `test_Conv2d_naive_groups`
     # Covering special case when group > 1, input-channel / group < 16 and output-channel is multiple of 16
     # See also https://github.com/pytorch/pytorch/pull/18463#issuecomment-476563686
@@ -4666,6 +4716,19 @@ class TestNN(NNTestCase):
 
             (hx + cx).sum().backward()
 
+    def test_RNN_fused_cpu_cell(self):
+        # Without autograd, the LSTM and GRU cells update their states on
+        # CPU with fused kernels, which must match the composite ones.
+        for module, hidden_size, dtype in itertools.product(
+                (nn.LSTM, nn.GRU, nn.LSTMCell, nn.GRUCell), (20, 37), (torch.float, torch.double)):
+            rnn = module(10, hidden_size).to(dtype)
+            is_cell = module in (nn.LSTMCell, nn.GRUCell)
+            input = torch.randn(3, 10, dtype=dtype) if is_cell else torch.randn(5, 3, 10, dtype=dtype)
+            expected = rnn(input)
+            with torch.no_grad():
+                result = rnn(input)
+            self.assertEqual(result, expected)
+
     @unittest.skipIf(not TEST_CUDA, 'CUDA not available')
     def test_pack_sequence_batch_sizes_throw(self):
         with self.assertRaisesRegex(ValueError, r"batch_sizes should always be on CPU"):
@@ -5709,6 +5772,24 @@ class TestNN(NNTestCase):
         # Because of dropout randomness, can only compare dropout=0 and dropout=1
         self._test_RNN_cpu_vs_cudnn(1)
 
+    @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
+    @skipIfRocm
+    def test_RNN_persistent_cuda(self):
+        input = torch.randn(7, 3, 10, device='cuda', dtype=torch.double)
+        for module in (nn.LSTM, nn.GRU):
+            rnn = module(10, 6, num_layers=2, bidirectional=True).to('cuda', torch.double)
+            with torch.no_grad(), torch.backends.cudnn.flags(enabled=False):
+                saved = torch.backends.cuda.rnn.persistent
+                try:
+                    torch.backends.cuda.rnn.persistent = False
+                    expected_output, expected_hidden = rnn(input)
+                    torch.backends.cuda.rnn.persistent = True
+                    output, hidden = rnn(input)
+                finally:
+                    torch.backends.cuda.rnn.persistent = saved
+            self.assertEqual(output, expected_output)
+            self.assertEqual(hidden, expected_hidden)
+
     @unittest.skipIf(not TEST_CUDNN, "needs cudnn")
     def test_RNN_cudnn_weight_norm(self):
         input_size = 10
@@ -6980,6 +7061,19 @@ class TestNN(NNTestCase):
                         with cudnn.flags(enabled=False):
                             test(N, C, H, W, mode, padding_mode, align_corners=align_corners)
 
+    def test_grid_sample_channels_last(self):
+        for mode, padding_mode, align_corners, C in product(
+                ['bilinear', 'nearest'], ['zeros', 'border', 'reflection'], [True, False], [3, 19]):
+            input = torch.randn(2, C, 7, 9)
+            # Some locations fall outside the input.
+            grid = torch.rand(2, 5, 6, 2) * 2.4 - 1.2
+            expected = F.grid_sample(input, grid, mode=mode, padding_mode=padding_mode,
+                                     align_corners=align_corners)
+            out = F.grid_sample(input.contiguous(memory_format=torch.channels_last), grid,
+                                mode=mode, padding_mode=padding_mode, align_corners=align_corners)
+            self.assertTrue(out.is_contiguous(memory_format=torch.channels_last))
+            self.assertEqual(out, expected)
+
     def test_grid_sample_3d(self):
         def test(N, C, D, H, W, mode, padding_mode, align_corners):
             def test_shape(N, C, ID, IH, IW, D, H, W, mode, padding_mode, align_corners):
@@ -7669,6 +7763,17 @@ class TestNN(NNTestCase):
                     input = torch.randn(2, 2, 2, 2, requires_grad=True)
                     gradcheck(lambda x: F.interpolate(x, out_size, **kwargs), [input])
 
+    def test_upsamplingLinear_channels_last(self):
+        for align_corners, C in product([True, False], [3, 19]):
+            for mode, input, memory_format in [
+                    ('bilinear', torch.randn(1, C, 5, 7), torch.channels_last),
+                    ('trilinear', torch.randn(1, C, 3, 5, 7), torch.channels_last_3d)]:
+                expected = F.interpolate(input, scale_factor=1.7, mode=mode, align_corners=align_corners)
+                out = F.interpolate(input.contiguous(memory_format=memory_format), scale_factor=1.7,
+                                    mode=mode, align_corners=align_corners)
+                self.assertTrue(out.is_contiguous(memory_format=memory_format))
+                self.assertEqual(out, expected)
+
     def test_upsamplingBilinear2d_spatial_invariance(self):
         m = nn.Upsample(scale_factor=3, mode='bilinear', align_corners=False)
         in_t_9 = torch.zeros(1, 1, 9, 9)
@@ -9558,12 +9663,125 @@ class TestNNDeviceType(NNTestCase):
         if self.device_type == 'cuda':
             self._test_LayerNorm_cuda_half(device)
 
+    def test_layer_norm_row_sizes(self, device):
+        # Covers the single kernel path for short rows, both with vector and
+        # scalar loads, and the two kernel path for long rows.
+        for N in (3, 64, 768, 1000, 4096, 20000):
+            for elementwise_affine in (True, False):
+                ln = nn.LayerNorm(N, elementwise_affine=elementwise_affine).to(device, torch.double)
+                if elementwise_affine:
+                    with torch.no_grad():
+                        ln.weight.uniform_()
+                        ln.bias.uniform_()
+                x = torch.randn(5, N + 1, device=device, dtype=torch.double)[:, 1:] * 3 + 1
+                ref = (x - x.mean(-1, keepdim=True)) / torch.sqrt(x.var(-1, unbiased=False, keepdim=True) + ln.eps)
+                if elementwise_affine:
+                    ref = ref * ln.weight + ln.bias
+                self.assertEqual(ln(x), ref)
+                self.assertEqual(ln(x.contiguous()), ref)
+
+    def _dropout_add_layer_norm_reference(self, x, r, mask, p, weight, bias):
+        if p > 0:
+            x = x * mask.to(x.dtype) * (1 / (1 - p) if p < 1 else 0)
+        h = r + x
+        return h, F.layer_norm(h, (x.size(-1),), weight, bias)
+
+    def test_dropout_add_layer_norm(self, device):
+        for N, dtype in product((16, 768, 1001, 20000), (torch.float, torch.double)):
+            x = torch.randn(4, 3, N, device=device, dtype=dtype, requires_grad=True)
+            r = torch.randn(4, 3, N, device=device, dtype=dtype, requires_grad=True)
+            weight = torch.rand(N, device=device, dtype=dtype, requires_grad=True)
+            bias = torch.rand(N, device=device, dtype=dtype, requires_grad=True)
+
+            # Without dropout it is layer_norm(x + r).
+            out = torch.dropout_add_layer_norm(x, r, (N,), weight, bias, p=0.3, train=False)
+            self.assertEqual(out, F.layer_norm(x + r, (N,), weight, bias))
+
+            for p in (0., 0.3, 1.):
+                out, h, mean, rstd, mask = torch.native_dropout_add_layer_norm(
+                    x, r, weight, bias, 12, N, p, 1e-5)
+                if p > 0:
+                    self.assertEqual(mask.dtype, torch.uint8)
+                    self.assertEqual(mask.shape, x.shape)
+                else:
+                    self.assertEqual(mask.numel(), 0)
+                if p == 1:
+                    self.assertEqual(mask.sum().item(), 0)
+                ref_h, ref = self._dropout_add_layer_norm_reference(x, r, mask, p, weight, bias)
+                self.assertEqual(h, ref_h)
+                self.assertEqual(out, ref)
+
+                grad = torch.randn_like(out)
+                grads = torch.autograd.grad(out, (x, r, weight, bias), grad)
+                ref_grads = torch.autograd.grad(ref, (x, r, weight, bias), grad)
+                for g, ref_g in zip(grads, ref_grads):
+                    self.assertEqual(g, ref_g)
+
+        x = torch.randn(2, 8, device=device, dtype=torch.double, requires_grad=True)
+        r = torch.randn(2, 8, device=device, dtype=torch.double, requires_grad=True)
+        weight = torch.rand(8, device=device, dtype=torch.double, requires_grad=True)
+        bias = torch.rand(8, device=device, dtype=torch.double, requires_grad=True)
+        self.assertTrue(gradcheck(
+            lambda x, r, w, b: torch.dropout_add_layer_norm(x, r, (8,), w, b, p=0.5, train=False),
+            (x, r, weight, bias)))
+
+    @onlyCUDA
+    def test_dropout_add_layer_norm_half(self, device):
+        for N in (768, 1024, 1001):
+            x = torch.randn(8, N, device=device, dtype=torch.half)
+            r = torch.randn(8, N, device=device, dtype=torch.half)
+            weight = torch.rand(N, device=device, dtype=torch.half)
+            bias = torch.rand(N, device=device, dtype=torch.half)
+            out, h, mean, rstd, mask = torch.native_dropout_add_layer_norm(
+                x, r, weight, bias, 8, N, 0.1, 1e-5)
+            _, ref = self._dropout_add_layer_norm_reference(
+                x.float(), r.float(), mask, 0.1, weight.float(), bias.float())
+            self.assertEqual(out, ref.half(), atol=1e-2, rtol=1e-2)
+            # About a tenth of the elements are dropped.
+            self.assertEqual(1 - mask.float().mean().item(), 0.1, atol=0.02, rtol=0)
+
+    def test_dropout_add_layer_norm_errors(self, device):
+        x = torch.randn(2, 4, device=device)
+        with self.assertRaisesRegex(RuntimeError, "same size"):
+            torch.dropout_add_layer_norm(x, torch.randn(2, 3, device=device), (4,))
+        with self.assertRaisesRegex(RuntimeError, "same dtype"):
+            torch.dropout_add_layer_norm(x, torch.randn(2, 4, device=device, dtype=torch.double), (4,))
+        with self.assertRaisesRegex(RuntimeError, "between 0 and 1"):
+            torch.dropout_add_layer_norm(x, x, (4,), p=1.5)
+
     def test_GroupNorm_general(self, device):
         self._test_GroupNorm_general(device)
 
         if self.device_type == 'cuda':
             self._test_GroupNorm_cuda_half()
 
+    @dtypes(torch.float, torch.double)
+    def test_GroupNorm_channels_last(self, device, dtype):
+        for shape, memory_format, groups in [
+                ((2, 16, 5, 7), torch.channels_last, 4),
+                ((3, 12, 2, 3, 4), torch.channels_last_3d, 3),
+                ((1, 6, 1, 1), torch.channels_last, 6)]:
+            # The large mean checks the moments don't lose the variance.
+            x = (torch.randn(shape, device=device, dtype=dtype) + 100).requires_grad_()
+            x_cl = x.detach().clone().contiguous(memory_format=memory_format).requires_grad_()
+            gn = nn.GroupNorm(groups, shape[1]).to(device, dtype)
+            gn.weight.data.uniform_()
+            gn.bias.data.uniform_()
+            gn_cl = deepcopy(gn)
+
+            out = gn(x)
+            out_cl = gn_cl(x_cl)
+            self.assertTrue(out_cl.is_contiguous(memory_format=memory_format))
+            self.assertEqual(out, out_cl)
+
+            grad = torch.randn_like(out)
+            out.backward(grad)
+            out_cl.backward(grad)
+            self.assertTrue(x_cl.grad.is_contiguous(memory_format=memory_format))
+            self.assertEqual(x.grad, x_cl.grad)
+            self.assertEqual(gn.weight.grad, gn_cl.weight.grad)
+            self.assertEqual(gn.bias.grad, gn_cl.bias.grad)
+
     def test_GroupNorm_raises_error_if_one_value_per_group(self, device):
         x = torch.rand(10)[None, :, None]
         with self.assertRaises(ValueError):
@@ -10004,7 +10222,9 @@ class TestNNDeviceType(NNTestCase):
     def test_softmax_results(self, device, dtype):
         # Non-even sizes and non-zero shifts test fallback paths in vectorized kernel
         # Note: dim1 > 1024 is needed to exercise the vectorized (non-persistent) path, (16, 30576) is BERT-esque
-        sizes = [(0, 10), (32, 20), (10, 0), (31, 20), (32, 21), (31, 23), (32, 1536), (31, 2048), (33, 2049), (16, 30576)]
+        # (8, 8192) fits in shared memory for the single-read kernel, (16, 30576) doesn't
+        sizes = [(0, 10), (32, 20), (10, 0), (31, 20), (32, 21), (31, 23), (32, 1536), (31, 2048), (33, 2049), (8, 8192),
+                 (16, 30576)]
         shifts = [(0, 0), (1, 0), (0, 1), (1, 1)]
         for fn in [F.softmax, F.log_softmax]:
             for size in sizes:
@@ -10046,8 +10266,80 @@ class TestNNDeviceType(NNTestCase):
             self.assertEqual(F.log_softmax(x_small, -1), F.log_softmax(x_big, -1))
         _test_helper((16, 4))
         if self.device_type == 'cuda':
-            # test non-persistent softmax kernel
+            # test non-persistent softmax kernels, with and without the row cached in shared memory
             _test_helper((4, 1536))
+            _test_helper((4, 30576))
+
+    def _masked_softmax_reference(self, input, mask, scale):
+        x = input.double() * scale
+        if mask is not None:
+            if mask.dtype == torch.bool:
+                x = x.masked_fill(mask, float('-inf'))
+            else:
+                x = x + mask.double()
+        out = torch.softmax(x, -1)
+        return out.masked_fill(x.max(-1, keepdim=True)[0] == float('-inf'), 0)
+
+    @dtypesIfCUDA(torch.half, torch.float, torch.double)
+    @dtypes(torch.float, torch.double)
+    def test_masked_softmax(self, device, dtype):
+        B, H = 2, 3
+        # 16384 is too long to cache a float row in shared memory on CUDA
+        for S in (5, 33, 1536, 16384):
+            T = 4 if S == 16384 else S
+            input = torch.randn(B, H, T, S, device=device, dtype=dtype)
+            padding = torch.zeros(B, 1, 1, S, dtype=torch.bool, device=device)
+            padding[0, ..., S // 2:] = True
+            padding[1, ..., :] = True  # every element of these rows is masked out
+            causal = torch.ones(T, S, dtype=torch.bool, device=device).triu(1)
+            additive = torch.randn(T, S, device=device, dtype=dtype)
+            for mask in (None, padding, causal, additive):
+                scale = 0.125
+                x = input.clone().requires_grad_()
+                out, softmax, dropout_mask = torch._masked_softmax(x, mask, scale)
+                self.assertEqual(softmax.numel(), 0)
+                self.assertEqual(dropout_mask.numel(), 0)
+
+                x_ref = input.clone().double().requires_grad_()
+                ref = self._masked_softmax_reference(x_ref, mask, scale)
+                atol, rtol = (1e-3, 1e-3) if dtype == torch.half else (1e-5, 1e-4)
+                self.assertEqual(out, ref.to(dtype), atol=atol, rtol=rtol)
+
+                grad = torch.randn_like(out)
+                out.backward(grad)
+                ref.backward(grad.double())
+                self.assertEqual(x.grad, x_ref.grad.to(dtype), atol=atol, rtol=rtol)
+
+    @dtypes(torch.float)
+    def test_masked_softmax_dropout(self, device, dtype):
+        p = 0.3
+        input = torch.randn(4, 64, 256, device=device, dtype=dtype, requires_grad=True)
+        mask = torch.rand(64, 256, device=device) < 0.2
+        out, softmax, dropout_mask = torch._masked_softmax(input, mask, 0.5, p)
+        self.assertEqual(softmax, self._masked_softmax_reference(input.detach(), mask, 0.5).to(dtype))
+        self.assertEqual(dropout_mask.dtype, torch.uint8)
+        self.assertEqual(out, softmax * dropout_mask / (1 - p))
+        keep = dropout_mask.double().mean().item()
+        self.assertTrue(abs(keep - (1 - p)) < 0.02, "kept a fraction {} of the elements".format(keep))
+
+        grad = torch.randn_like(out)
+        grad_input, = torch.autograd.grad(out, input, grad)
+        g = grad * dropout_mask / (1 - p)
+        expected = (g * softmax - softmax * (g * softmax).sum(-1, keepdim=True)) * 0.5
+        self.assertEqual(grad_input, expected)
+
+        # dropout_p == 0 doesn't touch the output
+        out, softmax, dropout_mask = torch._masked_softmax(input, mask, 0.5, 0.)
+        self.assertEqual(out, self._masked_softmax_reference(input.detach(), mask, 0.5).to(dtype))
+
+    def test_masked_softmax_errors(self, device):
+        input = torch.randn(2, 3, 4, device=device)
+        with self.assertRaisesRegex(RuntimeError, "has to match the last dimension"):
+            torch._masked_softmax(input, torch.zeros(3, 5, dtype=torch.bool, device=device))
+        with self.assertRaisesRegex(RuntimeError, "expected a bool mask or an additive mask"):
+            torch._masked_softmax(input, torch.zeros(4, dtype=torch.long, device=device))
+        with self.assertRaisesRegex(RuntimeError, "dropout probability"):
+            torch._masked_softmax(input, None, 1., 1.)
 
     @largeCUDATensorTest('12GB')
     def test_conv_large_nosplit(self, device):
@@ -10433,6 +10725,124 @@ class TestNNDeviceType(NNTestCase):
         inp = torch.rand(1, 1, 2**15, 2**8, device=device)
         out = m(inp)
 
+    def _test_module_nhwc(self, device, dtype, module, input_size):
+        # Runs module on a channels-last input and on its contiguous copy,
+        # checking the channels-last result and gradient against the other ones
+        input = torch.randint(-3, 3, input_size, dtype=dtype, device=device)
+        input = input.contiguous(memory_format=torch.channels_last).requires_grad_()
+        ref_input = input.detach().clone().contiguous().requires_grad_()
+        ref_module = deepcopy(module)
+
+        out = module(input)
+        ref_out = ref_module(ref_input)
+        grad = torch.randint_like(out, -3, 3)
+        out.backward(grad)
+        ref_out.backward(grad.contiguous())
+
+        self.assertTrue(out.is_contiguous(memory_format=torch.channels_last))
+        self.assertTrue(input.grad.is_contiguous(memory_format=torch.channels_last))
+        self.assertEqual(out, ref_out)
+        self.assertEqual(input.grad, ref_input.grad)
+
+    @onlyCUDA
+    @dtypes(torch.half, torch.float)
+    def test_upsampling_nhwc(self, device, dtype):
+        # 3 and 8 channels, with and without vectorized accesses
+        for channels, mode, scale_factor in product([3, 8], ['nearest', 'bilinear'], [0.5, 2, 1.5]):
+            kwargs = dict(align_corners=False) if mode == 'bilinear' else {}
+            m = nn.Upsample(scale_factor=scale_factor, mode=mode, **kwargs)
+            self._test_module_nhwc(device, dtype, m, (2, channels, 7, 6))
+
+    @onlyCUDA
+    @precisionOverride({torch.half: 1e-2})
+    @dtypes(torch.half, torch.float)
+    def test_batchnorm_nhwc(self, device, dtype):
+        # cudnn would take the channels-last inputs otherwise
+        with torch.backends.cudnn.flags(enabled=False):
+            for channels, affine in product([3, 8], [True, False]):
+                bn = nn.BatchNorm2d(channels, affine=affine).to(device)
+                self._test_module_nhwc(device, dtype, bn, (4, channels, 5, 5))
+                bn.eval()
+                self._test_module_nhwc(device, dtype, bn, (4, channels, 5, 5))
+
+    @onlyCUDA
+    def test_grid_sample_nhwc(self, device):
+        for mode in ['bilinear', 'nearest']:
+            grid = torch.rand(2, 4, 5, 2, device=device) * 2 - 1
+            self._test_module_nhwc(
+                device, torch.float,
+                lambda input: F.grid_sample(input, grid, mode=mode, align_corners=False),
+                (2, 4, 6, 6))
+
+    @dtypesIfCUDA(torch.half, torch.float, torch.double)
+    @dtypes(torch.float, torch.double)
+    @precisionOverride({torch.half: 1e-2})
+    def test_fused_attention(self, device, dtype):
+        B, H, L, S = 2, 3, 70, 90
+        for D in [8, 33, 64]:
+            # A key spanning several tiles and a transposed query
+            query = torch.randn(B, L, H, D, device=device, dtype=dtype).transpose(1, 2)
+            key = torch.randn(B, H, S, D, device=device, dtype=dtype)
+            value = torch.randn(B, H, S, D, device=device, dtype=dtype)
+            key_padding_mask = torch.zeros(B, S, dtype=torch.bool, device=device)
+            key_padding_mask[0, 50:] = True
+            key_padding_mask[1, ::3] = True
+            for mask, causal in product([None, key_padding_mask], [False, True]):
+                scale = D ** -0.5
+                weights = torch.matmul(query.float(), key.float().transpose(-1, -2)) * scale
+                if mask is not None:
+                    weights = weights.masked_fill(mask[:, None, None, :], float('-inf'))
+                if causal:
+                    weights = weights.masked_fill(
+                        torch.ones(L, S, dtype=torch.bool, device=device).triu(1), float('-inf'))
+                expected = torch.matmul(weights.softmax(-1), value.float()).to(dtype)
+                out = torch._fused_attention(query, key, value, mask, causal=causal, scale=scale)
+                self.assertTrue(out.is_contiguous())
+                self.assertEqual(out, expected)
+
+    @dtypes(torch.float, torch.double)
+    def test_multihead_attn_fused(self, device, dtype):
+        embed_dim, num_heads = 16, 4
+        mha = nn.MultiheadAttention(embed_dim, num_heads).to(device, dtype)
+        query = torch.randn(7, 3, embed_dim, device=device, dtype=dtype)
+        key = torch.randn(11, 3, embed_dim, device=device, dtype=dtype)
+        key_padding_mask = torch.zeros(3, 11, dtype=torch.bool, device=device)
+        key_padding_mask[1, 6:] = True
+        for k, mask in [(query, None), (key, None), (key, key_padding_mask)]:
+            # The weights, which the fused attention doesn't compute, are the
+            # same as its output computed without it.
+            expected, _ = mha(query, k, k, key_padding_mask=mask)
+            with torch.no_grad():
+                out, weights = mha(query, k, k, key_padding_mask=mask, need_weights=False)
+            self.assertIsNone(weights)
+            self.assertEqual(out, expected)
+
+    @dtypes(torch.uint8, torch.float, torch.double)
+    def test_resized_crop_flip_normalize(self, device, dtype):
+        # Images of different sizes, the second one channels last
+        images = [torch.randint(0, 256, (3, 20, 30), device=device).to(dtype),
+                  torch.randint(0, 256, (17, 9, 3), device=device).to(dtype).permute(2, 0, 1)]
+        boxes = torch.tensor([[2, 5, 15, 20], [0, 1, 17, 8]])
+        flips = torch.tensor([False, True])
+        mean, std = [120., 110., 100.], [60., 50., 40.]
+        out = torch._resized_crop_flip_normalize(images, boxes, flips, [12, 16], mean, std)
+        result_type = torch.float if dtype == torch.uint8 else dtype
+        self.assertEqual(out.dtype, result_type)
+        self.assertEqual(out.shape, (2, 3, 12, 16))
+        mean_t = torch.tensor(mean, device=device, dtype=result_type).view(3, 1, 1)
+        std_t = torch.tensor(std, device=device, dtype=result_type).view(3, 1, 1)
+        for i, image in enumerate(images):
+            top, left, height, width = boxes[i].tolist()
+            crop = image[:, top:top + height, left:left + width].to(result_type)
+            expected = F.interpolate(crop.unsqueeze(0), size=(12, 16), mode='bilinear',
+                                     align_corners=False)[0]
+            if flips[i]:
+                expected = expected.flip(-1)
+            self.assertEqual(out[i], (expected - mean_t) / std_t, atol=1e-4, rtol=1e-5)
+
+        with self.assertRaisesRegex(RuntimeError, 'is not within the image'):
+            torch._resized_crop_flip_normalize(images, boxes + 1, flips, [12, 16], mean, std)
+
     @onlyCUDA
     @skipCUDAIfCudnnVersionLessThan(7600)
     def test_CTCLoss_cudnn(self, device):
@@ -11018,6 +11428,47 @@ class TestNNDeviceType(NNTestCase):
         self._test_EmbeddingBag(device, 'mean', True, dtype, test_backward=test_backward)
 
 
+    @onlyCUDA
+    @dtypes(torch.half, torch.float, torch.double)
+    @wrapDeterministicFlagAPITest
+    def test_embedding_backward_skewed_indices(self, device, dtype):
+        # Enough indices to take the sorted path, with a few hot rows that are
+        # split across several warps and many rows seen once.
+        num_weights, dim = 1000, 70
+        hot = torch.tensor([3, 500, 999]).repeat_interleave(torch.tensor([400, 90, 33]))
+        indices = torch.cat((hot, torch.randint(num_weights, (1200,))))
+        indices = indices[torch.randperm(indices.numel())].to(device)
+        offsets = torch.arange(0, indices.numel(), 7, device=device)
+        per_sample_weights = torch.randn(indices.numel(), device=device, dtype=dtype)
+        prec = 5e-2 if dtype == torch.half else None
+
+        def grads(fn, *args):
+            results = []
+            for weight_device, weight_dtype in ((device, dtype), ('cpu', torch.double)):
+                weight = torch.randn(num_weights, dim, dtype=torch.double, requires_grad=True)
+                out = fn(weight.to(weight_device, weight_dtype), *[
+                    a.to(weight_device, weight_dtype if a.is_floating_point() else a.dtype) for a in args])
+                out.backward(torch.ones_like(out))
+                results.append(weight.grad)
+            return results
+
+        cases = [
+            (lambda w, i: F.embedding(i, w), indices),
+            (lambda w, i: F.embedding(i, w, padding_idx=3), indices),
+            (lambda w, i: F.embedding(i, w, scale_grad_by_freq=True), indices),
+            (lambda w, i, o: F.embedding_bag(i, w, o, mode='sum'), indices, offsets),
+            (lambda w, i, o: F.embedding_bag(i, w, o, mode='mean'), indices, offsets),
+            (lambda w, i, o, p: F.embedding_bag(i, w, o, mode='sum', per_sample_weights=p),
+             indices, offsets, per_sample_weights),
+        ]
+        for deterministic in (False, True):
+            torch.set_deterministic(deterministic)
+            for case in cases:
+                res, ref = grads(*case)
+                self.assertEqual(res, ref, atol=prec, rtol=prec)
+                if deterministic:
+                    self.assertTrue(torch.equal(res, grads(*case)[0]))
+
     @onlyCUDA
     @skipCUDAIfNotRocm
     def test_embedding_bag_bfloat16(self, device):
@@ -11598,6 +12049,164 @@ class TestNNDeviceType(NNTestCase):
     def test_softmax_bfloat16(self, device):
         self._test_bfloat16_ops(torch.nn.Softmax(dim=1), device, inp_dims=(16, 32), prec=1e-2)
 
+    @onlyCPU
+    def test_normalization_bfloat16_cpu(self, device):
+        # Sizes that are not a multiple of the vector width exercise the tails.
+        self._test_bfloat16_ops(torch.nn.Softmax(dim=1), device, inp_dims=(16, 37), prec=1e-2)
+        self._test_bfloat16_ops(torch.nn.Softmax(dim=1), device, inp_dims=(4, 37, 3), prec=1e-2)
+        self._test_bfloat16_ops(torch.nn.LogSoftmax(dim=1), device, inp_dims=(16, 37), prec=5e-2)
+        self._test_bfloat16_ops(torch.nn.LayerNorm(37), device, inp_dims=(16, 37), prec=5e-2)
+        self._test_bfloat16_ops(torch.nn.LayerNorm([5, 7]), device, inp_dims=(3, 5, 7), prec=5e-2)
+        self._test_bfloat16_ops(torch.nn.BatchNorm2d(3), device, inp_dims=(4, 3, 5, 7), prec=5e-2)
+
+    @onlyCPU
+    def test_batchnorm_eval_bfloat16_cpu(self, device):
+        bn = torch.nn.BatchNorm2d(19).eval()
+        bn.running_mean.uniform_(-1, 1)
+        bn.running_var.uniform_(0.5, 2)
+        input = torch.randn(4, 19, 5, 7, device=device)
+        out_bf16 = bn.bfloat16()(input.bfloat16())
+        self.assertEqual(out_bf16.dtype, torch.bfloat16)
+        self.assertEqual(bn.float()(input), out_bf16, atol=5e-2, rtol=0, exact_dtype=False)
+
+    @onlyCPU
+    @dtypes(torch.half, torch.bfloat16)
+    def test_embedding_bag_reduced_precision_cpu(self, device, dtype):
+        # Half and BFloat16 tables are accumulated in and return float32, so
+        # the result matches a float32 table holding the same (rounded) values.
+        weight = torch.randn(20, 37, device=device).to(dtype)
+        weight_ref = weight.float()
+        indices = torch.tensor([1, 2, 4, 5, 4, 3, 2, 9, 19, 0], device=device)
+        offsets = torch.tensor([0, 3, 3, 7], device=device)
+        per_sample_weights = torch.rand(10, device=device)
+        for mode, include_last_offset in product(('sum', 'mean', 'max'), (False, True)):
+            expected = F.embedding_bag(indices, weight_ref, offsets, mode=mode,
+                                       include_last_offset=include_last_offset)
+            actual = F.embedding_bag(indices, weight, offsets, mode=mode,
+                                     include_last_offset=include_last_offset)
+            self.assertEqual(actual.dtype, torch.float)
+            self.assertEqual(expected, actual, atol=1e-5, rtol=0)
+        for psw in (per_sample_weights, per_sample_weights.to(dtype)):
+            expected = F.embedding_bag(indices, weight_ref, offsets, mode='sum',
+                                       per_sample_weights=psw.float())
+            actual = F.embedding_bag(indices, weight, offsets, mode='sum',
+                                     per_sample_weights=psw)
+            self.assertEqual(expected, actual, atol=1e-5, rtol=0)
+        # Non-contiguous rows take the slow path.
+        weight_t = weight.t().contiguous().t()
+        actual = F.embedding_bag(indices, weight_t, offsets, mode='sum')
+        self.assertEqual(F.embedding_bag(indices, weight_ref, offsets, mode='sum'), actual,
+                         atol=1e-5, rtol=0)
+
+        # The backward runs on the float32 output gradient; autograd rounds the
+        # result to the table's dtype when accumulating it into weight.grad.
+        for mode, sparse in (('sum', True), ('sum', False), ('mean', True), ('max', False)):
+            weight_ref_ = weight_ref.clone().requires_grad_()
+            weight_ = weight.clone().requires_grad_()
+            grad = torch.randn(offsets.numel(), 37, device=device)
+            F.embedding_bag(indices, weight_ref_, offsets, mode=mode, sparse=sparse).backward(grad)
+            F.embedding_bag(indices, weight_, offsets, mode=mode, sparse=sparse).backward(grad)
+            self.assertEqual(weight_.grad.is_sparse, sparse)
+            self.assertEqual(weight_ref_.grad.to_dense() if sparse else weight_ref_.grad,
+                             weight_.grad.to_dense() if sparse else weight_.grad,
+                             atol=5e-2, rtol=0, exact_dtype=False)
+
+        psw_ref = per_sample_weights.clone().requires_grad_()
+        psw = per_sample_weights.to(dtype).requires_grad_()
+        grad = torch.randn(offsets.numel(), 37, device=device)
+        F.embedding_bag(indices, weight_ref.requires_grad_(), offsets, mode='sum',
+                        per_sample_weights=psw_ref).backward(grad)
+        F.embedding_bag(indices, weight.requires_grad_(), offsets, mode='sum',
+                        per_sample_weights=psw).backward(grad)
+        self.assertEqual(psw.grad.dtype, dtype)
+        self.assertEqual(psw_ref.grad, psw.grad, atol=1e-1, rtol=1e-2, exact_dtype=False)
+
+    def _embedding_bag_grad_reference(self, weight, indices, offsets, mode, grad,
+                                      per_sample_weights=None, scale_grad_by_freq=False):
+        positions = torch.arange(indices.numel(), device=indices.device)
+        bags = torch.searchsorted(offsets, positions, right=True) - 1
+        scale = torch.ones(indices.numel(), device=indices.device, dtype=weight.dtype)
+        if per_sample_weights is not None:
+            scale *= per_sample_weights
+        if mode == 'mean':
+            ends = torch.cat([offsets[1:], offsets.new_tensor([indices.numel()])])
+            scale /= (ends - offsets)[bags]
+        if scale_grad_by_freq:
+            scale /= torch.bincount(indices, minlength=weight.size(0))[indices]
+        ref = torch.zeros_like(weight)
+        ref.index_add_(0, indices, grad[bags] * scale.unsqueeze(1))
+        return ref
+
+    @onlyCPU
+    @dtypes(torch.float, torch.double)
+    def test_embedding_bag_backward_parallel_cpu(self, device, dtype):
+        # Enough indices for the radix sort and the row reduction to be split
+        # across threads, with many repeated rows.
+        num_weights, dim, num_bags = 3000, 5, 400
+        weight = torch.randn(num_weights, dim, device=device, dtype=dtype)
+        indices = torch.randint(num_weights, (20000,), device=device)
+        offsets = torch.sort(torch.randint(20000, (num_bags,), device=device))[0]
+        offsets[0] = 0
+        grad = torch.randn(num_bags, dim, device=device, dtype=dtype)
+        psw = torch.rand(indices.numel(), device=device, dtype=dtype)
+        for mode, sparse, scale_grad_by_freq, with_psw in product(
+                ('sum', 'mean'), (False, True), (False, True), (False, True)):
+            if with_psw and mode != 'sum':
+                continue
+            w = weight.clone().requires_grad_()
+            out = F.embedding_bag(indices, w, offsets, mode=mode, sparse=sparse,
+                                  scale_grad_by_freq=scale_grad_by_freq,
+                                  per_sample_weights=psw if with_psw else None)
+            out.backward(grad)
+            if sparse:
+                self.assertTrue(w.grad.is_coalesced())
+                self.assertEqual(w.grad._nnz(), indices.unique().numel())
+            ref = self._embedding_bag_grad_reference(
+                weight, indices, offsets, mode, grad,
+                per_sample_weights=psw if with_psw else None,
+                scale_grad_by_freq=scale_grad_by_freq)
+            self.assertEqual(w.grad.to_dense() if sparse else w.grad, ref)
+
+    @onlyCPU
+    @dtypes(torch.float, torch.double, torch.half, torch.bfloat16)
+    def test_embedding_bag_sparse_fused_update_cpu(self, device, dtype):
+        num_weights, dim = 50, 7
+        weight = torch.randn(num_weights, dim, device=device).to(dtype)
+        indices = torch.tensor([1, 2, 4, 5, 4, 3, 2, 9, 19, 0, 49, 2], device=device)
+        offsets = torch.tensor([0, 3, 3, 7], device=device)
+        psw = torch.rand(indices.numel(), device=device)
+        grad_dtype = torch.float if dtype in (torch.half, torch.bfloat16) else dtype
+        grad = torch.randn(offsets.numel(), dim, device=device, dtype=grad_dtype)
+        lr, eps = 0.1, 1e-8
+        tol = dict(atol=1e-2, rtol=1e-2) if grad_dtype != dtype else {}
+        for mode, with_psw in (('sum', False), ('sum', True), ('mean', False)):
+            _, offset2bag, _, _ = torch._embedding_bag(
+                weight, indices, offsets, False, 0 if mode == 'sum' else 1, True,
+                psw if with_psw else None)
+            g = self._embedding_bag_grad_reference(
+                weight.to(grad_dtype), indices, offsets, mode, grad,
+                per_sample_weights=psw if with_psw else None)
+
+            w = weight.clone()
+            torch._embedding_bag_sparse_sgd_(
+                w, grad, indices, offsets, offset2bag, 0 if mode == 'sum' else 1,
+                psw if with_psw else None, lr)
+            self.assertEqual(w, weight.to(grad_dtype) - lr * g, exact_dtype=False, **tol)
+
+            w = weight.clone()
+            momentum = torch.rand(num_weights, device=device, dtype=grad_dtype)
+            ref_momentum = momentum + g.pow(2).mean(1)
+            torch._embedding_bag_sparse_rowwise_adagrad_(
+                w, momentum, grad, indices, offsets, offset2bag, 0 if mode == 'sum' else 1,
+                psw if with_psw else None, lr, eps)
+            self.assertEqual(momentum, ref_momentum)
+            ref = weight.to(grad_dtype) - lr * g / (ref_momentum.sqrt() + eps).unsqueeze(1)
+            self.assertEqual(w, ref, exact_dtype=False, **tol)
+
+        with self.assertRaisesRegex(RuntimeError, "only support mode='sum' and mode='mean'"):
+            torch._embedding_bag_sparse_sgd_(
+                weight.clone(), grad, indices, offsets, offset2bag, 2, None, lr)
+
     @onlyCUDA
     @skipCUDAIfRocm
     @skipCUDAIfCudnnVersionLessThan(7603)
@@ -11805,6 +12414,73 @@ class TestNNDeviceType(NNTestCase):
         helper([2, 3, 5, 7])
         helper([2, 3, 5, 7, 9])
 
+    def _cross_entropy_reference(self, input, target, weight, ignore_index, reduction, label_smoothing):
+        # -sum_c w_c q_c log p_c with q the one-hot target mixed with the
+        # uniform distribution
+        n_classes = input.size(1)
+        log_probs = F.log_softmax(input, 1).movedim(1, -1)
+        class_weight = torch.ones(n_classes, device=input.device, dtype=input.dtype) if weight is None else weight
+        mask = target != ignore_index
+        safe_target = target.masked_fill(~mask, 0)
+        q = F.one_hot(safe_target, n_classes).to(input.dtype) * (1 - label_smoothing) + label_smoothing / n_classes
+        losses = -(class_weight * q * log_probs).sum(-1) * mask
+        if reduction == 'none':
+            return losses
+        if reduction == 'sum':
+            return losses.sum()
+        return losses.sum() / (class_weight[safe_target] * mask).sum()
+
+    def test_cross_entropy_loss_matches_reference(self, device):
+        for size, weighted, reduction, label_smoothing in product(
+                [(5, 7), (3, 4, 5), (2, 3, 4, 5)], [False, True], ['none', 'mean', 'sum'], [0.0, 0.25]):
+            input = torch.randn(size, device=device, dtype=torch.double, requires_grad=True)
+            n_classes = size[1]
+            target_size = (size[0],) + size[2:]
+            target = torch.randint(n_classes, target_size, device=device)
+            target.view(-1)[::3] = -1
+            weight = torch.rand(n_classes, device=device, dtype=torch.double) if weighted else None
+
+            out = F.cross_entropy(input, target, weight, ignore_index=-1, reduction=reduction,
+                                  label_smoothing=label_smoothing)
+            expected = self._cross_entropy_reference(input, target, weight, -1, reduction, label_smoothing)
+            self.assertEqual(out, expected)
+            if label_smoothing == 0:
+                self.assertEqual(out, F.nll_loss(F.log_softmax(input, 1), target, weight,
+                                                 ignore_index=-1, reduction=reduction))
+
+            grad, = torch.autograd.grad(out.sum(), input)
+            expected_grad, = torch.autograd.grad(expected.sum(), input)
+            self.assertEqual(grad, expected_grad)
+
+    def test_cross_entropy_loss_large_vocab(self, device):
+        # the rows span several chunks of classes, with the maximum of a row in a
+        # later chunk than the first
+        input = torch.randn(4, 50000, device=device, dtype=torch.float)
+        input[:, 40000] += 20
+        target = torch.tensor([40000, 3, 49999, 1024], device=device)
+        for label_smoothing in [0.0, 0.1]:
+            out = F.cross_entropy(input, target, reduction='none', label_smoothing=label_smoothing)
+            expected = self._cross_entropy_reference(input.double(), target, None, -100, 'none', label_smoothing)
+            self.assertEqual(out.double(), expected, atol=1e-4, rtol=1e-5)
+
+    def test_cross_entropy_loss_gradgrad(self, device):
+        input = torch.randn(4, 5, device=device, dtype=torch.double, requires_grad=True)
+        target = torch.tensor([0, 4, -100, 2], device=device)
+        weight = torch.rand(5, device=device, dtype=torch.double)
+        for label_smoothing in [0.0, 0.3]:
+            def func(x):
+                return F.cross_entropy(x, target, weight, label_smoothing=label_smoothing)
+            gradcheck(func, [input])
+            gradgradcheck(func, [input])
+
+    def test_cross_entropy_loss_label_smoothing_errors(self, device):
+        input = torch.randn(3, 5, device=device)
+        target = torch.tensor([0, 1, 2], device=device)
+        with self.assertRaisesRegex(RuntimeError, 'label_smoothing must be between 0.0 and 1.0'):
+            F.cross_entropy(input, target, label_smoothing=1.5)
+        with self.assertRaisesRegex(RuntimeError, 'expected a target of size'):
+            F.cross_entropy(input, target[:2])
+
     def test_softshrink_negative(self, device):
         input = torch.randn(5, device=device, requires_grad=True)
         m = torch.nn.Softshrink(-1)
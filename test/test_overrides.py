@@ -533,6 +533,32 @@ class TestTorchFunctionOverride(TestCase):
         with self.assertRaises(TypeError):
             sn1 + s2
 
+    def test_torch_function_added_later(self):
+        """Whether types have a __torch_function__ is cached, which must
+        notice the classes that are given one."""
+        class Base(object):
+            pass
+
+        class Derived(Base):
+            pass
+
+        t = torch.tensor([1.])
+        for _ in range(2):
+            with self.assertRaises(TypeError):
+                t.add(Derived())
+            with self.assertRaises(TypeError):
+                torch.add(t, Derived())
+
+        def torch_function(self, func, types, args=(), kwargs=None):
+            return (func.__name__, len(args), kwargs)
+        Base.__torch_function__ = torch_function
+        self.assertEqual(t.add(Derived(), alpha=2), ('add', 2, {'alpha': 2}))
+        self.assertEqual(torch.add(t, Derived()), ('add', 2, None))
+
+        del Base.__torch_function__
+        with self.assertRaises(TypeError):
+            t.add(Derived())
+
 
 def generate_tensor_like_override_tests(cls):
     from torch.testing._internal.generated.annotated_fn_args import annotated_args
@@ -1736,6 +1736,28 @@ class TestSparse(TestCase):
 
         self.assertFalse(z._indices().numel() != 2 and z.is_coalesced())
 
+    def test_coalesce_and_add_many_nonzeros(self):
+        # Enough nonzero elements to be split between threads
+        nnz = 200000
+        size = torch.Size([1000, 50, 3])
+        for dtype in [torch.double, torch.long]:
+            def gen():
+                i = torch.stack([torch.randint(s, (nnz,), device=self.device) for s in size[:2]])
+                v = torch.randint(-5, 5, (nnz, 3), dtype=dtype, device=self.device)
+                return torch.sparse_coo_tensor(i, v, size)
+
+            x, y = gen(), gen()
+            x_coalesced = x.coalesce()
+            self.assertTrue(x_coalesced.is_coalesced())
+            keys = x_coalesced._indices()[0] * size[1] + x_coalesced._indices()[1]
+            self.assertTrue((keys[1:] > keys[:-1]).all())
+            self.assertEqual(x.to_dense(), x_coalesced.to_dense())
+
+            z = torch.add(x_coalesced, y.coalesce(), alpha=2)
+            self.assertTrue(z.is_coalesced())
+            self.assertEqual(x.to_dense() + 2 * y.to_dense(), z.to_dense())
+            self.assertEqual(z, self.safeCoalesce(z))
+
     @cuda_only
     def test_storage_not_null(self):
         x = torch.cuda.sparse.FloatTensor(2)
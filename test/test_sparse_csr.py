@@ -0,0 +1,139 @@
+import torch
+import itertools
+from torch.testing._internal.common_utils import TestCase, run_tests, load_tests
+from torch.testing._internal.common_device_type import \
+    (instantiate_device_type_tests, dtypes, dtypesIfCUDA, onlyCPU)
+
+# load_tests from torch.testing._internal.common_utils is used to automatically filter tests for
+# sharding on sandcastle. This line silences flake warnings
+load_tests = load_tests
+
+
+class TestSparseCSR(TestCase):
+
+    def _gen_matrix(self, nrows, ncols, density, dtype, device):
+        dense = torch.randn(nrows, ncols, dtype=torch.double, device=device).to(dtype)
+        return dense * (torch.rand(nrows, ncols, device=device) < density).to(dtype)
+
+    def test_csr_layout(self):
+        self.assertEqual(str(torch.sparse_csr), 'torch.sparse_csr')
+        self.assertEqual(type(torch.sparse_csr), torch.layout)
+
+    @dtypes(torch.double, torch.float)
+    def test_sparse_csr_from_dense(self, device, dtype):
+        dense = torch.tensor([[4, 5, 0], [0, 0, 0], [1, 0, 0]], dtype=dtype, device=device)
+        csr = dense.to_sparse_csr()
+        self.assertEqual(csr.layout, torch.sparse_csr)
+        self.assertEqual(csr.shape, (3, 3))
+        self.assertEqual(csr._nnz(), 3)
+        self.assertEqual(torch.tensor([0, 2, 2, 3], device=device), csr.crow_indices())
+        self.assertEqual(torch.tensor([0, 1, 0], device=device), csr.col_indices())
+        self.assertEqual(torch.tensor([4, 5, 1], dtype=dtype, device=device), csr.values())
+        self.assertEqual(dense, csr.to_dense())
+
+    @dtypes(torch.double)
+    def test_sparse_csr_constructor(self, device, dtype):
+        for index_dtype in [torch.int32, torch.int64]:
+            crow_indices = torch.tensor([0, 2, 4], dtype=index_dtype, device=device)
+            col_indices = torch.tensor([0, 1, 0, 1], dtype=index_dtype, device=device)
+            values = torch.tensor([1, 2, 3, 4], dtype=dtype, device=device)
+            csr = torch.sparse_csr_tensor(crow_indices, col_indices, values, (2, 3))
+            self.assertEqual((2, 3), csr.shape)
+            self.assertEqual(index_dtype, csr.crow_indices().dtype)
+            self.assertEqual(torch.tensor([[1, 2, 0], [3, 4, 0]], dtype=dtype, device=device), csr.to_dense())
+
+            # The size is inferred from the indices if not given.
+            csr = torch.sparse_csr_tensor(crow_indices, col_indices, values)
+            self.assertEqual((2, 2), csr.shape)
+
+    def test_sparse_csr_constructor_invalid(self, device):
+        values = torch.tensor([1., 2., 3.], device=device)
+        with self.assertRaisesRegex(RuntimeError, "crow_indices must end with nnz"):
+            torch.sparse_csr_tensor(torch.tensor([0, 1, 2], device=device),
+                                    torch.tensor([0, 1, 0], device=device), values, (2, 2))
+        with self.assertRaisesRegex(RuntimeError, "crow_indices must be nondecreasing"):
+            torch.sparse_csr_tensor(torch.tensor([0, 4, 3], device=device),
+                                    torch.tensor([0, 1, 0], device=device), values, (2, 2))
+        with self.assertRaisesRegex(RuntimeError, "there are 2 columns but found index 2"):
+            torch.sparse_csr_tensor(torch.tensor([0, 2, 3], device=device),
+                                    torch.tensor([0, 2, 0], device=device), values, (2, 2))
+        with self.assertRaisesRegex(RuntimeError, "both be int32 or both be int64"):
+            torch.sparse_csr_tensor(torch.tensor([0, 2, 3], device=device),
+                                    torch.tensor([0, 1, 0], dtype=torch.int32, device=device), values, (2, 2))
+
+    @dtypes(torch.double, torch.float)
+    def test_sparse_csr_to_from_coo(self, device, dtype):
+        for nrows, ncols in [(0, 0), (5, 0), (10, 7), (100, 100)]:
+            dense = self._gen_matrix(nrows, ncols, 0.1, dtype, device)
+            coo = dense.to_sparse()
+            csr = coo.to_sparse_csr()
+            self.assertEqual(dense, csr.to_dense())
+            self.assertEqual(csr.crow_indices(), dense.to_sparse_csr().crow_indices())
+            coo_again = csr.to_sparse()
+            self.assertTrue(coo_again.is_coalesced())
+            self.assertEqual(coo.coalesce(), coo_again)
+
+    @dtypes(torch.double, torch.float)
+    @dtypesIfCUDA(torch.double, torch.float)
+    def test_sparse_csr_matmul(self, device, dtype):
+        for index_dtype, (m, k, n) in itertools.product(
+                [torch.int32, torch.int64], [(0, 5, 3), (7, 5, 0), (10, 20, 30), (100, 50, 1)]):
+            dense_a = self._gen_matrix(m, k, 0.2, dtype, device)
+            csr = dense_a.to_sparse_csr()
+            csr = torch._sparse_csr_tensor_unsafe(csr.crow_indices().to(index_dtype),
+                                                  csr.col_indices().to(index_dtype),
+                                                  csr.values(), csr.shape)
+            b = torch.randn(k, n, dtype=dtype, device=device)
+            c = torch.randn(m, n, dtype=dtype, device=device)
+
+            self.assertEqual(dense_a.mm(b), torch.mm(csr, b))
+            self.assertEqual(torch.addmm(c, dense_a, b, beta=0.5, alpha=2),
+                             torch.addmm(c, csr, b, beta=0.5, alpha=2))
+            # A transposed dense operand and a broadcast self
+            self.assertEqual(torch.addmm(c[0], dense_a, b.t().contiguous().t()),
+                             torch.addmm(c[0], csr, b.t().contiguous().t()))
+            # beta == 0 ignores NaN in self, as for dense matrices
+            self.assertEqual(dense_a.mm(b), torch.addmm(torch.full_like(c, float('nan')), csr, b, beta=0))
+            out = torch.empty(0, dtype=dtype, device=device)
+            torch.addmm(c, csr, b, out=out)
+            self.assertEqual(torch.addmm(c, dense_a, b), out)
+            c_ = c.clone()
+            c_.addmm_(csr, b)
+            self.assertEqual(torch.addmm(c, dense_a, b), c_)
+
+            v = torch.randn(k, dtype=dtype, device=device)
+            self.assertEqual(dense_a.mv(v), csr.mv(v))
+
+    @onlyCPU
+    def test_sparse_csr_matmul_skewed_rows(self, device):
+        # A single row holding most of the nonzero elements, as a hub of a graph
+        dense_a = self._gen_matrix(1000, 200, 0.01, torch.double, device)
+        dense_a[3] = torch.randn(200, dtype=torch.double)
+        b = torch.randn(200, 16, dtype=torch.double)
+        self.assertEqual(dense_a.mm(b), torch.mm(dense_a.to_sparse_csr(), b))
+
+    @dtypes(torch.double)
+    def test_sparse_csr_grad_dense_operand(self, device, dtype):
+        dense_a = self._gen_matrix(10, 8, 0.3, dtype, device)
+        csr = dense_a.to_sparse_csr()
+        b = torch.randn(8, 4, dtype=dtype, device=device, requires_grad=True)
+        torch.mm(csr, b).sum().backward()
+        b_ = b.detach().requires_grad_()
+        torch.mm(dense_a, b_).sum().backward()
+        self.assertEqual(b_.grad, b.grad)
+
+    @dtypes(torch.double)
+    def test_sparse_csr_copy_and_print(self, device, dtype):
+        csr = self._gen_matrix(4, 5, 0.5, dtype, device).to_sparse_csr()
+        other = torch.empty((0, 0), layout=torch.sparse_csr, dtype=torch.float, device=device)
+        other.copy_(csr)
+        self.assertEqual(csr.to_dense().float(), other.to_dense())
+        self.assertEqual(csr.to_dense(), torch.empty_like(csr).to_dense() + csr.to_dense())
+        self.assertIn('crow_indices=tensor(', str(csr))
+        self.assertIn('layout=torch.sparse_csr', str(csr))
+
+
+instantiate_device_type_tests(TestSparseCSR, globals())
+
+if __name__ == '__main__':
+    run_tests()
@@ -227,6 +227,47 @@ class TestFFT(TestCase):
         with self.assertRaisesRegex(RuntimeError, r"but got device with index"):
             torch.backends.cuda.cufft_plan_cache[torch.cuda.device_count() + 10]
 
+        with self.assertRaisesRegex(RuntimeError, r"read-only property"):
+            torch.backends.cuda.cufft_plan_cache.hits = 0
+
+        # hits and misses count the lookups since the last clear
+        plan_cache = torch.backends.cuda.cufft_plan_cache[devices[0]]
+        x = torch.randn(4, 8, device=devices[0], dtype=dtype)
+        plan_cache.clear()
+        self.assertEqual((plan_cache.size, plan_cache.hits, plan_cache.misses), (0, 0, 0))
+        x.rfft(1)
+        self.assertEqual((plan_cache.hits, plan_cache.misses), (0, 1))
+        x.rfft(1)
+        self.assertEqual((plan_cache.hits, plan_cache.misses), (1, 1))
+        self.assertEqual(plan_cache.size, 1)
+
+        # every stream has a cache of its own
+        with torch.cuda.stream(torch.cuda.Stream(devices[0])):
+            x.rfft(1)
+            self.assertEqual((plan_cache.hits, plan_cache.misses), (1, 2))
+        torch.cuda.synchronize(devices[0])
+        self.assertEqual(plan_cache.size, 2)
+        with plan_cache_max_size(devices[0], 1):
+            self.assertEqual(plan_cache.size, 2)  # capacity applies per stream
+        plan_cache.clear()
+        self.assertEqual((plan_cache.size, plan_cache.hits, plan_cache.misses), (0, 0, 0))
+
+        # batched 1-D transforms share their plans across batch sizes, see
+        # NOTE [ cuFFT Batched Plans ]
+        for batch in (1000, 1001, 1002, 1016, 37, 16):
+            x = torch.randn(batch, 6, device=devices[0], dtype=dtype)
+            for normalized, onesided in product((True, False), (True, False)):
+                res = x.rfft(1, normalized=normalized, onesided=onesided)
+                ref = torch.cat([r.rfft(1, normalized=normalized, onesided=onesided)
+                                 for r in x.split(8)])
+                self.assertEqual(res, ref)
+                self.assertEqual(res.irfft(1, normalized=normalized, onesided=onesided, signal_sizes=(6,)), x)
+        misses = plan_cache.misses
+        x = torch.randn(1017, 6, device=devices[0], dtype=dtype)
+        x.rfft(1).irfft(1, signal_sizes=(6,))
+        self.assertEqual(plan_cache.misses, misses)
+        plan_cache.clear()
+
         # Multigpu tests
         if len(devices) > 1:
             # Test that different GPU has different cache
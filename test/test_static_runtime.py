@@ -1,3 +1,5 @@
+import threading
+
 import torch
 from torch import nn
 import numpy as np
@@ -8,6 +10,8 @@ class StaticRuntime:
         # this is an nn.Module
         if hasattr(scripted, "_c"):
             self.static_runtime = torch._C._jit_to_static_runtime(scripted._c)
+        elif isinstance(scripted, torch._C.StaticInferenceModule):
+            self.static_runtime = torch._C._jit_to_static_runtime(scripted)
         else:
             self.static_runtime = torch._C._jit_to_static_runtime(scripted.graph)
 
@@ -91,6 +95,18 @@ def trivial_graph(a, b, c):
     return a + b * c + s
 
 
+def add_alpha_graph(a, b):
+    return torch.add(a, b, alpha=2).sigmoid()
+
+
+def chain_graph(a, b):
+    c = torch.mul(a, b)
+    d = torch.add(c, b)
+    e = torch.mul(d, a)
+    f = torch.add(e, c)
+    return torch.sigmoid(f)
+
+
 if __name__ == "__main__":
     HID_DIM = 256
     QUERY_LEN = 8
@@ -120,6 +136,50 @@ if __name__ == "__main__":
     o_test = tg_a(s, s, s)[0]
     torch.testing.assert_allclose(o_ref, o_test)
 
+    a = torch.randn(4, 4)
+    b = torch.randn(4, 4)
+    ag = torch.jit.script(add_alpha_graph)
+    ag_a = StaticRuntime(ag)
+    for _ in range(2):
+        torch.testing.assert_allclose(ag(a, b), ag_a(a, b)[0])
+
+    # the intermediates are planned into the arena from the second run on,
+    # and the outputs of a run aren't overwritten by the next one
+    cg = torch.jit.script(chain_graph)
+    cg_a = StaticRuntime(cg)
+    results = []
+    for shape in [(4, 4), (4, 4), (8, 4), (2, 4)]:
+        a = torch.randn(shape)
+        b = torch.randn(shape)
+        results.append((cg(a, b), cg_a(a, b)[0]))
+    for o_ref, o_test in results:
+        torch.testing.assert_allclose(o_ref, o_test)
+    stats = cg_a.static_runtime.memory_stats()
+    assert stats["num_managed_tensors"] == 4, stats
+    assert stats["num_buffers"] < stats["num_managed_tensors"], stats
+    assert stats["planned_bytes"] >= 2 * 4 * 4 * 4, stats
+
+    # runtimes sharing a prepared module, run concurrently
+    cg_mod = torch._C._jit_prepare_for_static_runtime(cg.graph)
+    errors = []
+
+    def run_shared():
+        try:
+            runtime = StaticRuntime(cg_mod)
+            for _ in range(20):
+                a = torch.randn(8, 4)
+                b = torch.randn(8, 4)
+                torch.testing.assert_allclose(cg(a, b), runtime(a, b)[0])
+        except Exception as e:
+            errors.append(e)
+
+    threads = [threading.Thread(target=run_shared) for _ in range(4)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    assert not errors, errors
+
     # Arguments taken from benchmark script, ./bench/dlrm_s_benchmark.sh
     ln_bot = [512, 512, 64]
     sigmoid_bot = -1
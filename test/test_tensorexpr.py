@@ -1,4 +1,6 @@
 import numpy as np
+import os
+import tempfile
 import torch
 import torch.nn.functional as F
 import unittest
@@ -550,6 +552,98 @@ class TestTensorExprFuser(BaseTestClass):
         np.testing.assert_allclose(traced(a)[0], np.amin(a.numpy(), axis=1))
 
 
+    def test_sum_mean(self):
+        def test_sum(x, y):
+            return (x * y + 1.0).sum([1])
+
+        def test_sum_keepdim(x, y):
+            return x / (x * y).sum([0, 2], keepdim=True)
+
+        def test_mean(x, y):
+            return torch.relu(x - y).mean([-1]) * 2.0
+
+        for fn in [test_sum, test_sum_keepdim, test_mean]:
+            x, y = torch.rand(4, 8, 16), torch.rand(4, 8, 16)
+            traced = torch.jit.trace(fn, (x, y))
+            llvm_executed = LLVMCodeGenExecuted()
+            simple_ir_eval_executed = SimpleIREvalExecuted()
+            for _ in range(3):
+                np.testing.assert_allclose(
+                    traced(x, y).numpy(), fn(x, y).numpy(), rtol=1e-5)
+            assert (
+                llvm_executed.elapsed_value() >= 1
+                or simple_ir_eval_executed.elapsed_value() >= 1
+            ), fn.__name__
+
+    def test_softmax_layer_norm(self):
+        def test_softmax(x, y):
+            return F.softmax(x * y, dim=1) + 1.0
+
+        def test_log_softmax(x, y):
+            return F.log_softmax(x - y, dim=-1)
+
+        def test_layer_norm(x, y):
+            return F.layer_norm(x + y, [16], eps=1e-5) * 2.0
+
+        def test_layer_norm_affine(x, y):
+            return torch.tanh(F.layer_norm(x, [8, 16], y[0], y[1]))
+
+        for fn in [test_softmax, test_log_softmax, test_layer_norm, test_layer_norm_affine]:
+            x, y = 4.0 * torch.rand(4, 8, 16), torch.rand(4, 8, 16)
+            traced = torch.jit.trace(fn, (x, y))
+            llvm_executed = LLVMCodeGenExecuted()
+            simple_ir_eval_executed = SimpleIREvalExecuted()
+            for _ in range(3):
+                np.testing.assert_allclose(
+                    traced(x, y).numpy(), fn(x, y).numpy(), rtol=1e-4, atol=1e-5)
+            assert (
+                llvm_executed.elapsed_value() >= 1
+                or simple_ir_eval_executed.elapsed_value() >= 1
+            ), fn.__name__
+
+    def test_large_and_transposed(self):
+        def test(x, y):
+            return torch.sigmoid(x * y) + x
+
+        # large enough for the kernel to run in chunks on several threads,
+        # with an input read across its rows and sizes that aren't a
+        # multiple of the vector width
+        for y_t, size in [(False, (300, 517)), (True, (256, 512)), (True, (67, 45))]:
+            x = torch.rand(*size)
+            y = torch.rand(size[1], size[0]).t() if y_t else torch.rand(*size)
+            traced = torch.jit.trace(test, (x, y))
+            llvm_executed = LLVMCodeGenExecuted()
+            simple_ir_eval_executed = SimpleIREvalExecuted()
+            for _ in range(3):
+                np.testing.assert_allclose(
+                    traced(x, y).numpy(), test(x, y).numpy(), rtol=1e-6)
+            assert (
+                llvm_executed.elapsed_value() >= 1
+                or simple_ir_eval_executed.elapsed_value() >= 1
+            )
+
+    def test_kernel_cache(self):
+        def test(x, y):
+            return torch.sigmoid(x * y) + x
+
+        x = torch.rand(8, 16)
+        y = torch.rand(8, 16)
+        with tempfile.TemporaryDirectory() as cache_dir:
+            old_dir = torch._C._jit_set_kernel_cache_dir(cache_dir)
+            try:
+                # the second trace loads the kernel the first one compiled
+                for _ in range(2):
+                    traced = torch.jit.trace(test, (x, y))
+                    llvm_executed = LLVMCodeGenExecuted()
+                    for _ in range(3):
+                        np.testing.assert_allclose(
+                            traced(x, y).numpy(), test(x, y).numpy(), rtol=1e-6)
+                    if llvm_executed.elapsed_value() >= 1:
+                        entries = [f for f in os.listdir(cache_dir) if f.endswith(".kernel")]
+                        self.assertEqual(len(entries), 1)
+            finally:
+                torch._C._jit_set_kernel_cache_dir(old_dir)
+
     def test_clamp(self):
         def test(x):
             return torch.clamp(x + 3.0, 0.0, 6.0)
@@ -1266,5 +1360,151 @@ class TestTensorExprFuser(BaseTestClass):
         assert torch.allclose(scripted(a), 2 * a)
         assert cx.elapsed_value() == 1
 
+    @unittest.skipIf(not torch.cuda.is_available(), "requires CUDA")
+    def test_dropout_cuda(self):
+        def test(x, y):
+            return torch.nn.functional.dropout(x + y, 0.25, True)
+        a = torch.rand(1 << 16, device="cuda")
+        b = torch.rand(1, device="cuda")
+        scripted = torch.jit.script(test)
+        scripted(a, b)
+        scripted(a, b)
+        cx = CudaCodeGenExecuted()
+        out = scripted(a, b)
+        assert cx.elapsed_value() == 1
+        kept = out != 0
+        np.testing.assert_allclose(
+            kept.float().mean().item(), 0.75, rtol=2e-2)
+        assert torch.allclose(out[kept], (a + b)[kept] / 0.75)
+        # Every call draws new numbers.
+        assert not torch.equal(scripted(a, b), out)
+
+    @unittest.skipIf(not torch.cuda.is_available(), "requires CUDA")
+    def test_broadcast_rand_cuda(self):
+        def test(x, y):
+            r = torch.rand_like(x)
+            return r * y + r
+        a = torch.rand(64, 64, device="cuda")
+        b = torch.rand(1, 64, device="cuda")
+        scripted = torch.jit.script(test)
+        scripted(a, b)
+        scripted(a, b)
+        cx = CudaCodeGenExecuted()
+        out = scripted(a, b)
+        assert cx.elapsed_value() == 1
+        r = out / (b + 1)
+        assert ((r >= 0) & (r < 1)).all()
+
+    def test_dynamic_shapes(self):
+        def fn(x, y):
+            return x * y + x
+
+        old_state = torch._C._jit_texpr_dynamic_shapes_enabled()
+        torch._C._jit_texpr_set_dynamic_shapes_enabled(True)
+        try:
+            with num_profiled_runs(2):
+                scripted = torch.jit.script(fn)
+                # the batch sizes of the profiled runs differ, so the kernel
+                # takes the batch size as an argument
+                for batch in (2, 3):
+                    x, y = torch.rand(batch, 4), torch.rand(batch, 4)
+                    scripted(x, y)
+                llvm_executed = LLVMCodeGenExecuted()
+                simple_ir_eval_executed = SimpleIREvalExecuted()
+                for batch in (5, 7, 9):
+                    x, y = torch.rand(batch, 4), torch.rand(batch, 4)
+                    np.testing.assert_allclose(scripted(x, y).numpy(), fn(x, y).numpy())
+                assert (
+                    llvm_executed.elapsed_value() >= 3
+                    or simple_ir_eval_executed.elapsed_value() >= 3
+                )
+                # the sizes that broadcast still give the right results
+                x, y = torch.rand(1, 4), torch.rand(6, 4)
+                np.testing.assert_allclose(scripted(x, y).numpy(), fn(x, y).numpy())
+        finally:
+            torch._C._jit_texpr_set_dynamic_shapes_enabled(old_state)
+
+    def test_inplace_intermediates(self):
+        def fn(x, y):
+            z = x * y
+            z.add_(1)
+            z.relu_()
+            return z, z * 2
+
+        with num_profiled_runs(1):
+            scripted = torch.jit.script(fn)
+            x, y = torch.randn(8, 16), torch.randn(8, 16)
+            scripted(x, y)
+            llvm_executed = LLVMCodeGenExecuted()
+            simple_ir_eval_executed = SimpleIREvalExecuted()
+            x, y = torch.randn(8, 16), torch.randn(8, 16)
+            for out, ref in zip(scripted(x, y), fn(x, y)):
+                np.testing.assert_allclose(out.numpy(), ref.numpy())
+            # the in-place ops on the intermediates are fused with the others
+            # in a single kernel
+            assert (
+                llvm_executed.elapsed_value() == 1
+                or simple_ir_eval_executed.elapsed_value() == 1
+            )
+
+    def test_inplace_input_unchanged(self):
+        def fn(x):
+            return torch.relu(x * 2) + 1
+
+        with num_profiled_runs(1):
+            scripted = torch.jit.script(fn)
+            x = torch.randn(8, 16)
+            scripted(x)
+            x = torch.randn(8, 16)
+            x_copy = x.clone()
+            out = scripted(x)
+            # the inputs the caller holds are never written into
+            np.testing.assert_allclose(x.numpy(), x_copy.numpy())
+            np.testing.assert_allclose(out.numpy(), fn(x_copy).numpy())
+
+    def _test_low_precision(self, device, dtype):
+        def fn(x, y):
+            z = x * y + 1
+            return torch.sigmoid(z) * torch.exp(-z), torch.tanh(z) > 0.5
+
+        with num_profiled_runs(1):
+            scripted = torch.jit.script(fn)
+            x = torch.randn(8, 32, device=device).to(dtype)
+            y = torch.randn(8, 32, device=device).to(dtype)
+            scripted(x, y)
+            for out, ref in zip(scripted(x, y), fn(x, y)):
+                assert out.dtype == ref.dtype
+                # every node rounds its output like the eager kernels, which
+                # compute in float, so the results are those of eager mode up
+                # to the rounding of the transcendental functions
+                np.testing.assert_allclose(
+                    out.float().cpu().numpy(), ref.float().cpu().numpy(),
+                    rtol=2e-2, atol=2e-2)
+
+    def test_bfloat16(self):
+        self._test_low_precision("cpu", torch.bfloat16)
+
+    def test_bfloat16_softmax(self):
+        def fn(x):
+            return torch.softmax(x * 2, dim=1), torch.sum(x, dim=[1])
+
+        with num_profiled_runs(1):
+            scripted = torch.jit.script(fn)
+            x = torch.randn(6, 40).to(torch.bfloat16)
+            scripted(x)
+            for out, ref in zip(scripted(x), fn(x)):
+                assert out.dtype == torch.bfloat16
+                np.testing.assert_allclose(
+                    out.float().numpy(), ref.float().numpy(),
+                    rtol=2e-2, atol=5e-2)
+
+    @unittest.skipIf(not torch.cuda.is_available(), "requires CUDA")
+    def test_half_cuda(self):
+        self._test_low_precision("cuda", torch.half)
+
+    @unittest.skipIf(not torch.cuda.is_available(), "requires CUDA")
+    def test_bfloat16_cuda(self):
+        self._test_low_precision("cuda", torch.bfloat16)
+
 if __name__ == '__main__':
     unittest.main()
@@ -2197,14 +2197,81 @@ class AbstractTestCases:
             self.assertEqual(b.nelement(), 3 * 100 * 100)
             self.assertEqual(b.numel(), 3 * 100 * 100)
 
-        # Note: the warning this tests for only appears once per program, so
-        # other instances of this warning should be addressed to avoid
-        # the tests depending on the order in which they're run.
+        def test_autocast_cpu(self):
+            linear = torch.nn.Linear(8, 4)
+            x = torch.randn(3, 5, 8)
+            self.assertFalse(torch.is_autocast_cpu_enabled())
+            with torch.cpu.amp.autocast():
+                self.assertTrue(torch.is_autocast_cpu_enabled())
+                self.assertFalse(torch.is_autocast_enabled())
+                out = linear(x)
+                self.assertEqual(out.dtype, torch.bfloat16)
+                self.assertEqual(out.shape, (3, 5, 4))
+                # fp32 ops, and promotion to the widest type
+                self.assertEqual(torch.exp(out).dtype, torch.float32)
+                self.assertEqual(torch.softmax(out, -1).dtype, torch.float32)
+                self.assertEqual(torch.cat((out, out)).dtype, torch.bfloat16)
+                self.assertEqual(torch.cat((out, x[..., :4])).dtype, torch.float32)
+                # Doubles are left alone
+                self.assertEqual(torch.mm(x[0].double(), linear.weight.double().t()).dtype, torch.float64)
+                with torch.cpu.amp.autocast(enabled=False):
+                    self.assertEqual(linear(x).dtype, torch.float32)
+                loss = out.float().sum()
+            self.assertFalse(torch.is_autocast_cpu_enabled())
+            loss.backward()
+            self.assertEqual(linear.weight.grad.dtype, torch.float32)
+            expected = torch.nn.functional.linear(x.bfloat16(), linear.weight.bfloat16(), linear.bias.bfloat16())
+            self.assertEqual(out, expected, atol=5e-2, rtol=2e-2)
+
+        def test_autocast_persistent_cache(self):
+            linear = torch.nn.Linear(8, 4)
+            x = torch.randn(2, 8)
+            try:
+                with torch.cpu.amp.autocast(persistent_cache=True):
+                    out = linear(x)
+                with torch.cpu.amp.autocast(persistent_cache=True):
+                    self.assertEqual(linear(x), out, atol=0, rtol=0)
+
+                # Weights modified in place are recast
+                with torch.no_grad():
+                    linear.weight.mul_(2)
+                with torch.cpu.amp.autocast(persistent_cache=True):
+                    out = linear(x)
+                self.assertEqual(out, torch.nn.functional.linear(x, linear.weight, linear.bias), atol=5e-2, rtol=2e-2)
+
+                # Casts cached under no_grad aren't reused by regions that need autograd
+                torch.clear_autocast_cache()
+                with torch.cpu.amp.autocast(persistent_cache=True):
+                    with torch.no_grad():
+                        linear(x)
+                    linear(x).float().sum().backward()
+                self.assertIsNotNone(linear.weight.grad)
+                self.assertIsNotNone(linear.bias.grad)
+            finally:
+                torch.clear_autocast_cache()
+
         @unittest.skipIf(not TEST_NUMPY, "Numpy not found")
         def test_numpy_non_writeable(self):
-            arr = np.zeros(5)
+            arr = np.arange(5.)
             arr.flags['WRITEABLE'] = False
-            self.assertWarns(UserWarning, lambda: torch.from_numpy(arr))
+            t = torch.from_numpy(arr)
+            self.assertEqual(t.data_ptr(), arr.ctypes.data)
+            self.assertEqual(t * 2, torch.arange(5.) * 2)
+            self.assertFalse(t.numpy().flags['WRITEABLE'])
+            self.assertFalse(t[1:].numpy().flags['WRITEABLE'])
+            with self.assertRaisesRegex(RuntimeError, 'read-only memory'):
+                t.add_(1)
+            with self.assertRaisesRegex(RuntimeError, 'read-only memory'):
+                torch.mul(t, 2, out=t)
+            with self.assertRaisesRegex(RuntimeError, 'read-only memory'):
+                t[1:].zero_()
+            self.assertEqual(arr, np.arange(5.))
+
+            # Copies are writeable
+            c = torch.tensor(arr)
+            c.add_(1)
+            self.assertTrue(c.numpy().flags['WRITEABLE'])
+            self.assertEqual(arr, np.arange(5.))
 
         @unittest.skipIf(not TEST_NUMPY, "Numpy not found")
         def test_empty_storage_view(self):
@@ -3462,6 +3529,53 @@ class AbstractTestCases:
             g2_normal = q.normal_(generator=g2)
             self.assertEqual(g1_normal, g2_normal)
 
+        def test_generator_cpu_philox_mode(self):
+            self.assertFalse(torch.Generator().philox_mode())
+            g = torch.Generator().manual_seed(123).set_philox_mode(True)
+            self.assertTrue(g.philox_mode())
+
+            def sample(dtype):
+                return {
+                    'uniform': torch.empty(100003, dtype=dtype).uniform_(-2, 3, generator=g),
+                    'normal': torch.empty(100003, dtype=dtype).normal_(1, 2, generator=g),
+                    'bernoulli': torch.empty(100003, dtype=dtype).bernoulli_(0.3, generator=g),
+                }
+
+            for dtype in [torch.float, torch.double]:
+                # The numbers only depend on the generator state, not on the
+                # number of threads.
+                state = g.get_state()
+                parallel = sample(dtype)
+                num_threads = torch.get_num_threads()
+                try:
+                    torch.set_num_threads(1)
+                    g.set_state(state)
+                    serial = sample(dtype)
+                finally:
+                    torch.set_num_threads(num_threads)
+                for name in parallel:
+                    self.assertEqual(parallel[name], serial[name], atol=0, rtol=0)
+
+                self.assertNotEqual(parallel['uniform'], sample(dtype)['uniform'])
+                self.assertTrue((parallel['uniform'] >= -2).all() and (parallel['uniform'] < 3).all())
+                self.assertEqual(parallel['uniform'].mean().item(), 0.5, atol=0.05, rtol=0)
+                self.assertEqual(parallel['normal'].mean().item(), 1, atol=0.05, rtol=0)
+                self.assertEqual(parallel['normal'].std().item(), 2, atol=0.05, rtol=0)
+                self.assertEqual(parallel['bernoulli'].mean().item(), 0.3, atol=0.01, rtol=0)
+
+            # Non-contiguous tensors get the numbers of contiguous ones, in
+            # their logical order.
+            for fill in [lambda t: t.uniform_(generator=g), lambda t: t.normal_(generator=g),
+                         lambda t: t.bernoulli_(0.5, generator=g)]:
+                state = g.get_state()
+                x = fill(torch.empty(37, 51).t())
+                g.set_state(state)
+                self.assertEqual(x, fill(torch.empty(51, 37)), atol=0, rtol=0)
+
+            # Half is generated in float.
+            x = torch.empty(1000, dtype=torch.half).normal_(generator=g)
+            self.assertEqual(x.float().mean().item(), 0, atol=0.2, rtol=0)
+
         def test_invalid_generator_raises(self):
             self.assertRaises(RuntimeError, lambda: torch.Generator('opengl'))
 
@@ -3615,6 +3729,46 @@ class AbstractTestCases:
                                    "missing 1 required positional arguments",
                                    lambda: torch.tensor().new_zeros((5, 5), 0))
 
+        def test_parsing_method_args(self):
+            # Tensor methods take their arguments by vectorcall
+            x = torch.randn(2, 3)
+            y = torch.randn(2, 3)
+            self.assertEqual(x.add(y, alpha=2), x + 2 * y)
+            # keyword names that aren't interned
+            self.assertEqual(x.add(y, **{'al' + 'pha': 2}), x + 2 * y)
+            self.assertEqual(x.add(**{'other': y, 'alpha': 2}), x + 2 * y)
+            # var-args IntArrayRef
+            self.assertEqual(x.view(3, 2).shape, (3, 2))
+            self.assertEqual(x.view((3, 2)).shape, (3, 2))
+            self.assertEqual(x.permute(*[1, 0]).shape, (3, 2))
+            self.assertEqual(x.sum(1, keepdim=True).shape, (2, 1))
+            self.assertRaisesRegex(TypeError, "unexpected keyword argument 'beta'",
+                                   lambda: x.add(y, beta=2))
+            self.assertRaisesRegex(TypeError, "multiple values for argument 'other'",
+                                   lambda: x.add(y, other=y))
+            self.assertRaisesRegex(TypeError, "invalid combination of arguments",
+                                   lambda: x.add(y, 'a'))
+            self.assertRaises(TypeError, lambda: x + object())
+
+        def test_parsing_cached_overload(self):
+            # The signature matched by the calls of a method is tried first for
+            # the next calls with arguments of the same types, which must still
+            # match the first signature that accepts them.
+            x = torch.zeros(2)
+            y = torch.ones(2)
+            scalar = torch.tensor(2.)
+            scalar_requiring_grad = torch.tensor(2., requires_grad=True)
+            for _ in range(3):
+                with warnings.catch_warnings(record=True):
+                    # add(Scalar alpha, Tensor other) is deprecated
+                    self.assertEqual(x.add(2, y), 2 * y)
+                    self.assertEqual(x.add(scalar, y), 2 * y)
+                    self.assertRaises(TypeError, lambda: x.add(scalar_requiring_grad, y))
+                self.assertEqual(x.add(y), y)
+                self.assertEqual(torch.ones(2, 2).sum(1).shape, (2,))
+                self.assertEqual(torch.ones(2, 2).sum(), 4)
+                self.assertEqual(torch.ones(2, 2).sum(1, True).shape, (2, 1))
+
         def test_half_tensor(self):
             x = torch.randn(5, 5).float()
             y = torch.randn(5, 5).float()
@@ -4355,6 +4509,25 @@ tensor([[[1.+1.j, 1.+1.j, 1.+1.j,  ..., 1.+1.j, 1.+1.j, 1.+1.j],
             x.strides = (3,)
             self.assertRaises(ValueError, lambda: torch.from_numpy(x))
 
+            # check negative strides raise exception, since from_numpy never copies
+            x = np.arange(6.).reshape(2, 3)
+            self.assertRaises(ValueError, lambda: torch.from_numpy(x[::-1]))
+
+        @unittest.skipIf(not TEST_NUMPY, "Numpy not found")
+        def test_ctor_with_numpy_negative_strides(self) -> None:
+            x = np.arange(24.).reshape(2, 3, 4)
+            for view in (x[::-1], x[:, ::-2], x[::-1, :, ::-1], x[:, ::-1].transpose(2, 0, 1),
+                         x[:, 2:0:-1], x[::-1, :0]):
+                expected = torch.from_numpy(view.copy())
+                for ctor in (torch.tensor, torch.as_tensor):
+                    t = ctor(view)
+                    self.assertEqual(t, expected)
+                    self.assertTrue(t.numpy().flags['WRITEABLE'])
+                self.assertEqual(torch.as_tensor(view, dtype=torch.float), expected.float())
+                # The copies don't share the memory of the array
+                torch.as_tensor(view).fill_(-1)
+            self.assertEqual(x, np.arange(24.).reshape(2, 3, 4))
+
         @unittest.skipIf(not TEST_NUMPY, "Numpy not found")
         def test_ctor_with_numpy_scalar_ctor(self) -> None:
             dtypes = [
@@ -4778,6 +4951,20 @@ tensor([[[1.+1.j, 1.+1.j, 1.+1.j,  ..., 1.+1.j, 1.+1.j, 1.+1.j],
         def test_parallel_info(self):
             torch.__config__.parallel_info()
 
+        def test_thread_budget(self):
+            cap = torch.get_thread_budget()
+            try:
+                torch.set_thread_budget(64)
+                self.assertEqual(torch.get_thread_budget(), 64)
+                self.assertIn("Thread budget: 64", torch.__config__.parallel_info())
+            finally:
+                torch.set_thread_budget(cap)
+            usage = torch._C._thread_budget_usage()
+            self.assertEqual(sorted(usage.keys()), ["autograd", "distributed", "inter_op", "intra_op"])
+            self.assertTrue(all(threads >= 0 for threads in usage.values()))
+            with self.assertRaisesRegex(RuntimeError, "non-negative"):
+                torch.set_thread_budget(-1)
+
         @slowTest
         def test_slow_test(self):
             # Just a smoketest to make sure our slowTest decorator works.
@@ -7332,6 +7519,50 @@ class TestTorchDeviceType(TestCase):
             self.assertTrue(res2.is_contiguous(memory_format=torch.channels_last))
             self.assertEqual(res1, res2)
 
+    @onlyCPU
+    @dtypes(torch.bool, torch.uint8, torch.int16, torch.half, torch.float, torch.double, torch.complex128)
+    def test_cat_mixed_layouts(self, device, dtype):
+        def make(*shape):
+            return torch.randint(0, 10, shape, device=device).to(dtype)
+
+        # Many small inputs with contiguous, channels-last, transposed,
+        # strided and expanded layouts. The larger shape covers splitting one
+        # input across threads.
+        for shape in ((2, 3, 4, 5), (4, 15, 64, 64)):
+            inputs = []
+            for i in range(60):
+                x = make(*shape)
+                kind = i % 5
+                if kind == 1:
+                    x = x.contiguous(memory_format=torch.channels_last)
+                elif kind == 2:
+                    x = x.transpose(2, 3).contiguous().transpose(2, 3)
+                elif kind == 3:
+                    x = make(shape[0], shape[1], shape[2], 2 * shape[3])[..., ::2]
+                elif kind == 4:
+                    x = make(shape[0], 1, shape[2], shape[3]).expand(shape)
+                inputs.append(x)
+            if shape[-1] > 5:
+                inputs = inputs[:6]
+            for dim in range(4):
+                res = torch.cat(inputs, dim=dim)
+                expected = torch.empty(res.shape, dtype=dtype, device=device)
+                offset = 0
+                for x in inputs:
+                    expected.narrow(dim, offset, x.size(dim)).copy_(x)
+                    offset += x.size(dim)
+                self.assertEqual(res, expected, atol=0, rtol=0)
+
+                res = torch.stack(inputs, dim=dim)
+                self.assertEqual(res, torch.cat([x.unsqueeze(dim) for x in inputs], dim=dim), atol=0, rtol=0)
+                for i, x in enumerate(inputs):
+                    self.assertEqual(res.select(dim, i), x, atol=0, rtol=0)
+
+                out = torch.empty(expected.shape, dtype=dtype, device=device)
+                out = out.contiguous(memory_format=torch.channels_last)
+                torch.cat(inputs, dim=dim, out=out)
+                self.assertEqual(out, expected, atol=0, rtol=0)
+
     @onlyCUDA
     def test_cat_preserve_channels_last(self, device):
         x = torch.randn((4, 3, 8, 8), device=device)
@@ -7548,6 +7779,41 @@ class TestTorchDeviceType(TestCase):
         self.assertEqual(torch.matmul(matrices, matrices_inverse),
                          torch.eye(3, dtype=torch.float64).to(device).expand_as(matrices))
 
+    # Batches of small matrices run batched LU routines on CUDA, and are
+    # spread over the threads on the CPU: check them against single matrices
+    # on both sides of the size the batched routines stop at.
+    @skipCUDAIfNoMagma
+    @skipCPUIfNoLapack
+    @dtypes(torch.float64)
+    def test_linalg_small_matrix_batches(self, device, dtype):
+        from torch.testing._internal.common_utils import random_fullrank_matrix_distinct_singular_value
+
+        for n in [1, 3, 32, 33]:
+            A = random_fullrank_matrix_distinct_singular_value(n, 7).to(device)
+            b = torch.randn(7, n, 2, dtype=dtype, device=device)
+
+            A_inv = torch.inverse(A)
+            x, _ = torch.solve(b, A)
+            A_LU, pivots = torch.lu(A)
+            x_lu = torch.lu_solve(b, A_LU, pivots)
+            for i in range(7):
+                self.assertEqual(A_inv[i], torch.inverse(A[i]))
+                self.assertEqual(x[i], torch.solve(b[i], A[i])[0])
+                LU_i, pivots_i = torch.lu(A[i])
+                self.assertEqual(A_LU[i], LU_i)
+                self.assertEqual(pivots[i], pivots_i)
+                self.assertEqual(x_lu[i], x[i])
+
+            # The first singular matrix of a batch is reported
+            A[4] = 0
+            A[5] = 0
+            with self.assertRaisesRegex(RuntimeError, "For batch 4"):
+                torch.inverse(A)
+            with self.assertRaisesRegex(RuntimeError, "For batch 4"):
+                torch.solve(b, A)
+            _, _, infos = torch.lu(A, get_infos=True)
+            self.assertEqual(infos.nonzero().flatten().tolist(), [4, 5])
+
     @skipCUDAIfNoMagma
     @skipCPUIfNoLapack
     @dtypes(torch.double)
@@ -12112,6 +12378,27 @@ class TestTorchDeviceType(TestCase):
             self.assertEqual(a1 * a2, torch.tensor([0.11, 0.01], dtype=torch.bfloat16, device=device), atol=0.01, rtol=0)
             self.assertEqual(a1.mul(a2), a1 * a2)
 
+    # Covers the vectorized CUDA paths: flat contiguous inputs, and a
+    # contiguous inner dimension with broadcast or strided rows, including
+    # rows whose length isn't a multiple of the vector width.
+    @onlyCUDA
+    @dtypes(torch.half, torch.float, torch.uint8)
+    def test_elementwise_vectorized_inner_dim(self, device, dtype):
+        for rows, cols in ((1, 4099), (3, 1024), (5, 4096), (7, 1027), (2, 8200)):
+            a = torch.randint(0, 10, (rows, cols), device=device).to(dtype)
+            bias = torch.randint(0, 10, (cols,), device=device).to(dtype)
+            self.assertEqual(a + bias, (a.cpu().double() + bias.cpu().double()).to(dtype))
+
+            wide = torch.randint(0, 10, (rows, cols + 8), device=device).to(dtype)
+            rows_view = wide[:, 8:]
+            self.assertEqual(rows_view * 2, (rows_view.cpu().double() * 2).to(dtype))
+            self.assertEqual(rows_view + bias, (rows_view.cpu().double() + bias.cpu().double()).to(dtype))
+
+            # offset rows break the row alignment, which falls back to the
+            # unvectorized path
+            odd = wide[:, 1:cols + 1]
+            self.assertEqual(odd + bias, (odd.cpu().double() + bias.cpu().double()).to(dtype))
+
     def test_cumsum(self, device):
         x = torch.rand(100, 100, device=device)
         res1 = torch.cumsum(x, 1)
@@ -12338,6 +12625,33 @@ class TestTorchDeviceType(TestCase):
         self.assertFalse(y.is_contiguous())
         self.assertEqual(out, y, atol=0., rtol=0.)
 
+    @onlyCPU
+    def test_cum_ops_long_and_short_dims(self, device):
+        # Lines long enough to be scanned in parallel blocks on the CPU.
+        n = 100003
+        x = torch.arange(1, n + 1, device=device)
+        expected = x * (x + 1) // 2
+        self.assertEqual(torch.cumsum(x, 0), expected, atol=0, rtol=0)
+        self.assertEqual(torch.cumsum(x.view(1, n).expand(2, n), 1), expected.expand(2, n), atol=0, rtol=0)
+        self.assertEqual(torch.cumsum(x[::2], 0), torch.cumsum(x[::2].contiguous(), 0), atol=0, rtol=0)
+
+        signs = torch.randint(2, (n,), device=device) * 2 - 1
+        expected = torch.ones(n, dtype=torch.long, device=device)
+        expected[(signs == -1).cumsum(0) % 2 == 1] = -1
+        self.assertEqual(torch.cumprod(signs, 0), expected, atol=0, rtol=0)
+
+        a = torch.randn(n, device=device, dtype=torch.double)
+        self.assertEqual(torch.logcumsumexp(a, 0), torch.cumsum(a.exp(), 0).log())
+
+        # Short lines next to each other in memory, scanned together.
+        for dtype in [torch.float, torch.double, torch.long, torch.cfloat]:
+            x = torch.randn(5, 37, 130, device=device).to(dtype)
+            for dim in range(3):
+                expected = x.transpose(dim, 2).contiguous().cumsum(2).transpose(dim, 2)
+                self.assertEqual(x.cumsum(dim), expected)
+                expected = x.transpose(dim, 2).contiguous().cumprod(2).transpose(dim, 2)
+                self.assertEqual(x.cumprod(dim), expected)
+
     def _test_cumminmax_helper(self, x, fn, expected_val, expected_ind):
         val, ind = fn(x, -1)
         self.assertEqual(val, expected_val, atol=0, rtol=0)
@@ -12418,6 +12732,61 @@ class TestTorchDeviceType(TestCase):
                         self.assertEqual(std1, std2)
                         self.assertEqual(mean1, mean2)
 
+    @dtypes(torch.float, torch.double)
+    def test_multi_reduce(self, device, dtype):
+        x = torch.randn(40, 30, 20, device=device, dtype=dtype)
+        all_reductions = ['sum', 'sumsq', 'min', 'max', 'count']
+
+        def reference(x, dim, keepdim):
+            if dim is None:
+                x, dim = x.reshape(-1), 0
+                keepdim = False
+            return {'sum': x.sum(dim, keepdim=keepdim),
+                    'sumsq': (x * x).sum(dim, keepdim=keepdim),
+                    'min': x.min(dim, keepdim=keepdim)[0],
+                    'max': x.max(dim, keepdim=keepdim)[0],
+                    'count': torch.full_like(x.sum(dim, keepdim=keepdim), x.size(dim), dtype=torch.long)}
+
+        for dim in [None, 0, 1, 2]:
+            for keepdim in [False, True]:
+                expected = reference(x, dim, keepdim)
+                results = torch.multi_reduce(x, all_reductions, dim=dim, keepdim=keepdim)
+                self.assertEqual(len(results), len(all_reductions))
+                for name, result in zip(all_reductions, results):
+                    self.assertEqual(result, expected[name])
+
+        # Any subset, in the requested order
+        mx, s = torch.multi_reduce(x, ['max', 'sum'], dim=1)
+        self.assertEqual(mx, x.max(1)[0])
+        self.assertEqual(s, x.sum(1))
+        n, = torch.multi_reduce(x, 'count', dim=(0, 2))
+        self.assertEqual(n, torch.full((30,), 800, dtype=torch.long, device=device))
+        s, = torch.multi_reduce(x, ['sum'], dim=(0, 2), keepdim=True)
+        self.assertEqual(s, x.sum((0, 2), keepdim=True))
+
+        # Non-contiguous input and NaN propagation
+        y = x.transpose(0, 2).clone()
+        y[3, 5, 7] = float('nan')
+        mn, mx = torch.multi_reduce(y, ['min', 'max'], dim=2)
+        self.assertTrue(mn[3, 5].isnan() and mx[3, 5].isnan())
+        mn[3, 5] = mx[3, 5] = 0
+        ref_mn, ref_mx = y.min(2)[0], y.max(2)[0]
+        ref_mn[3, 5] = ref_mx[3, 5] = 0
+        self.assertEqual(mn, ref_mn)
+        self.assertEqual(mx, ref_mx)
+
+        # Empty reductions
+        e = torch.empty(3, 0, device=device, dtype=dtype)
+        s, n = torch.multi_reduce(e, ['sum', 'count'], dim=1)
+        self.assertEqual(s, torch.zeros(3, device=device, dtype=dtype))
+        self.assertEqual(n, torch.zeros(3, device=device, dtype=torch.long))
+        with self.assertRaisesRegex(RuntimeError, "min or max"):
+            torch.multi_reduce(e, ['min'], dim=1)
+        with self.assertRaisesRegex(ValueError, "unknown reduction"):
+            torch.multi_reduce(x, ['mean'])
+        with self.assertRaisesRegex(RuntimeError, "floating-point"):
+            torch.multi_reduce(x.long(), ['sum'])
+
     def test_zeros_like(self, device):
         expected = torch.zeros((100, 100,), device=device)
 
@@ -12600,6 +12969,44 @@ class TestTorchDeviceType(TestCase):
             # not the data
             self.assertEqual(x, y)
 
+    @dtypes(torch.uint8, torch.bool, torch.int16, torch.half, torch.float,
+            torch.double, torch.cdouble)
+    def test_copy_transpose_blocked(self, device, dtype):
+        def reference(src, perm):
+            # An element by element gather, independent of the copy kernels.
+            flat = src.cpu().view(-1)
+            size = [src.size(d) for d in perm]
+            index = torch.zeros(size, dtype=torch.long)
+            for out_dim, in_dim in enumerate(perm):
+                shape = [1] * len(perm)
+                shape[out_dim] = size[out_dim]
+                index = index + torch.arange(size[out_dim]).view(shape) * src.stride(in_dim)
+            return flat[index.view(-1)].view(size)
+
+        def make(*size):
+            x = torch.arange(1, 1 + reduce(operator.mul, size), device=device).view(size) % 251
+            return x.to(dtype) if dtype is not torch.bool else (x % 2).bool()
+
+        # Matrices smaller than, equal to and not multiples of the tiles,
+        # batched matrices and an NCHW to NHWC permutation.
+        for size, perm in [((7, 9), (1, 0)),
+                           ((8, 8), (1, 0)),
+                           ((67, 131), (1, 0)),
+                           ((3, 70, 65), (0, 2, 1)),
+                           ((2, 19, 33, 45), (0, 2, 3, 1)),
+                           ((2, 19, 33, 45), (0, 3, 1, 2))]:
+            x = make(*size)
+            y = x.permute(perm).contiguous()
+            self.assertEqual(y.cpu(), reference(x, perm))
+
+        # A destination that is a view into a larger tensor.
+        x = make(70, 90).t()
+        out = torch.zeros(90, 100, dtype=dtype, device=device)
+        out[:, 5:75].copy_(x)
+        self.assertEqual(out[:, 5:75].cpu(), reference(x.t(), (1, 0)))
+        self.assertEqual(out[:, :5], torch.zeros(90, 5, dtype=dtype, device=device))
+        self.assertEqual(out[:, 75:], torch.zeros(90, 25, dtype=dtype, device=device))
+
     def test_resize_all_dtypes_and_devices(self, device):
         shape = (2, 2)
         for dt in torch.testing.get_all_dtypes():
@@ -13272,6 +13679,57 @@ class TestTorchDeviceType(TestCase):
                                             [False, True, False, True, False],
                                             [True, False, True, False, True]], device=device))
 
+    @onlyCPU
+    @dtypes(torch.int64, torch.float, torch.double)
+    def test_gather_scatter_add_fast_paths(self, device, dtype):
+        src = torch.arange(40 * 300, device=device).to(dtype).view(40, 300)
+        index = torch.randint(0, 300, (40, 1000), device=device)
+        expected = torch.stack([src[i][index[i]] for i in range(40)])
+        self.assertEqual(torch.gather(src, 1, index), expected, atol=0, rtol=0)
+        self.assertEqual(torch.gather(src.t(), 0, index.t()), expected.t(), atol=0, rtol=0)
+        index[3, 500] = 300
+        self.assertRaisesRegex(RuntimeError, "out of bounds", lambda: torch.gather(src, 1, index))
+
+        # 1-D scatter_add_ with many repeated indices
+        index = torch.randint(0, 100, (200000,), device=device)
+        values = torch.randint(0, 5, (200000,), device=device).to(dtype)
+        res = torch.zeros(100, dtype=dtype, device=device).scatter_add_(0, index, values)
+        expected = torch.zeros(100, dtype=dtype, device=device)
+        for i in range(100):
+            expected[i] = values[index == i].sum()
+        self.assertEqual(res, expected, atol=0, rtol=0)
+        index[1234] = -1
+        self.assertRaisesRegex(RuntimeError, "out of bounds",
+                               lambda: torch.zeros(100, dtype=dtype, device=device).scatter_add_(0, index, values))
+
+    @onlyCPU
+    @dtypes(torch.bool, torch.int32, torch.half, torch.bfloat16, torch.float, torch.double, torch.complex64)
+    def test_index_select_index_add_fast_paths(self, device, dtype):
+        src = torch.randint(0, 2, (30, 70), device=device).to(dtype)
+        index = torch.randint(0, 70, (500,), device=device)
+        expected = torch.stack([src[:, i] for i in index.tolist()], dim=1)
+        self.assertEqual(torch.index_select(src, 1, index), expected, atol=0, rtol=0)
+        self.assertEqual(src[:, index], expected, atol=0, rtol=0)
+        self.assertEqual(src.t()[index], expected.t(), atol=0, rtol=0)
+        self.assertEqual(src.t().contiguous()[index], expected.t(), atol=0, rtol=0)
+        bad = index.clone()
+        bad[7] = 70
+        self.assertRaises(IndexError, lambda: torch.index_select(src, 1, bad))
+
+        if dtype in (torch.bool, torch.complex64):
+            return
+        # Rows added with repeated indices
+        self_ = torch.randint(0, 4, (20, 130), device=device).to(dtype)
+        source = torch.randint(0, 4, (300, 130), device=device).to(dtype)
+        index = torch.randint(0, 20, (300,), device=device)
+        expected = self_.double()
+        for i, j in enumerate(index.tolist()):
+            expected[j] += source[i].double()
+        self.assertEqual(self_.clone().index_add_(0, index, source).double(), expected, atol=0, rtol=0)
+        bad = index.clone()
+        bad[10] = 20
+        self.assertRaises(IndexError, lambda: self_.clone().index_add_(0, bad, source))
+
     def test_masked_scatter_bool_tensor(self, device):
         src = torch.tensor([True, True, True], device=device)
         dst = torch.tensor([False, False, False], device=device)
@@ -13284,6 +13742,22 @@ class TestTorchDeviceType(TestCase):
         dst = dst.masked_scatter(mask, src)
         self.assertEqual(dst, torch.tensor([True, True, True], device=device))
 
+    def test_masked_scatter_noncontiguous(self, device):
+        # The selected elements take the elements of source in the row-major
+        # order of self, whatever its strides, and the mask broadcasts.
+        dst = torch.arange(12., device=device).view(3, 4).t()
+        mask = torch.tensor([True, False, True], device=device)
+        src = torch.arange(100., 112., device=device).view(3, 4)
+        result = dst.clone().masked_scatter_(mask, src)
+
+        expected = dst.cpu().contiguous()
+        flat_mask = mask.cpu().expand(4, 3).reshape(-1)
+        expected.view(-1)[flat_mask] = src.cpu().view(-1)[:int(flat_mask.sum())]
+        self.assertEqual(result, expected)
+
+        with self.assertRaises(RuntimeError):
+            dst.clone().masked_scatter_(mask, src.view(-1)[:7])
+
     @dtypes(*torch.testing.get_all_dtypes())
     def test_masked_select(self, device, dtype):
         if device == 'cpu':
@@ -14861,6 +15335,118 @@ class TestTorchDeviceType(TestCase):
         self.assertEqual(val, expected_val, atol=0, rtol=0)
         self.assertEqual(ind, expected_ind, atol=0, rtol=0)
 
+    @onlyCPU
+    @unittest.skipIf(not TEST_NUMPY, "Numpy not found")
+    @dtypes(torch.bool, torch.uint8, torch.int8, torch.int16, torch.int32, torch.int64,
+            torch.half, torch.bfloat16, torch.float, torch.double)
+    def test_sort_stable_cpu(self, device, dtype):
+        # 2**17 elements in a single slice take the parallel radix and merge
+        # sorts; the other layouts sort one slice per thread.
+        for n in (100, 2 ** 17):
+            if dtype == torch.bool:
+                x = torch.randint(0, 2, (n,), device=device).to(dtype)
+            else:
+                low = 0 if dtype == torch.uint8 else -10
+                x = torch.randint(low, 10, (n,), device=device).to(dtype)
+            for descending in (False, True):
+                for t in (x, x.view(10, -1), x.view(-1, 10).t()):
+                    values, indices = t.sort(dim=-1, descending=descending)
+                    # A stable sort keeps equal keys in index order.
+                    key = t.to(torch.double).cpu().numpy()
+                    expected = np.argsort(-key if descending else key, axis=-1, kind='stable')
+                    self.assertEqual(indices, torch.from_numpy(expected), atol=0, rtol=0)
+                    self.assertEqual(values, t.gather(-1, indices), atol=0, rtol=0)
+
+    @onlyCPU
+    @dtypes(torch.half, torch.bfloat16, torch.float, torch.double)
+    def test_sort_nonfinite_cpu(self, device, dtype):
+        base = torch.tensor([float('nan'), -float('inf'), 1., -0., 0., float('inf'), -1.],
+                            device=device, dtype=dtype)
+        for reps in (1, 2 ** 15):
+            x = base.repeat(reps)
+            values, indices = x.sort()
+            self.assertTrue(torch.isnan(values[-reps:]).all())
+            self.assertEqual(values[:reps], torch.full((reps,), -float('inf'), dtype=dtype),
+                             atol=0, rtol=0)
+            # -0. and 0. compare equal and keep their order.
+            zeros = indices[values == 0]
+            self.assertEqual(zeros, zeros.sort()[0], atol=0, rtol=0)
+            self.assertEqual(values, x[indices], atol=0, rtol=0)
+
+            values, indices = x.sort(descending=True)
+            self.assertTrue(torch.isnan(values[:reps]).all())
+            self.assertEqual(values[-reps:], torch.full((reps,), -float('inf'), dtype=dtype),
+                             atol=0, rtol=0)
+
+    @onlyCUDA
+    @dtypes(torch.bool, torch.uint8, torch.int32, torch.int64, torch.half, torch.float, torch.double)
+    def test_sort_large_cuda(self, device, dtype):
+        # Slices longer than 2048 take the radix sort, segmented when there is
+        # more than one slice.
+        n = 3 * 5000
+        if dtype == torch.bool:
+            x = torch.randint(0, 2, (n,), device=device).to(dtype)
+        elif dtype.is_floating_point:
+            x = torch.randn(n, device=device, dtype=dtype)
+            x[7] = float('nan')
+            x[8] = float('inf')
+            x[9] = -float('inf')
+        else:
+            x = torch.randint(0, 100, (n,), device=device, dtype=dtype)
+        for t, dim in ((x, 0), (x.view(3, -1), 1), (x.view(-1, 3), 0), (x.view(3, -1).t(), 0)):
+            for descending in (False, True):
+                values, indices = t.sort(dim=dim, descending=descending)
+                expected = t.cpu().sort(dim=dim, descending=descending)[0]
+                self.assertEqual(values, expected, atol=0, rtol=0)
+                self.assertEqual(t.gather(dim, indices), values, atol=0, rtol=0)
+                self.assertEqual(t.argsort(dim=dim, descending=descending), indices, atol=0, rtol=0)
+
+                out_values = torch.empty(0, device=device, dtype=dtype)
+                out_indices = torch.empty(0, device=device, dtype=torch.long)
+                torch.sort(t, dim=dim, descending=descending, out=(out_values, out_indices))
+                self.assertEqual(out_values, values, atol=0, rtol=0)
+                self.assertEqual(out_indices, indices, atol=0, rtol=0)
+
+    @onlyCUDA
+    @dtypes(torch.bool, torch.int64, torch.half, torch.float)
+    def test_unique_large_cuda(self, device, dtype):
+        if dtype == torch.bool:
+            x = torch.randint(0, 2, (100000,), device=device).to(dtype)
+        else:
+            x = torch.randint(0, 1000, (100000,), device=device).to(dtype)
+        for sorted_x in (False, True):
+            t = x.sort()[0] if sorted_x else x
+            output, inverse, counts = torch.unique(t, return_inverse=True, return_counts=True)
+            expected = torch.unique(t.cpu(), return_inverse=True, return_counts=True)
+            self.assertEqual(output, expected[0], atol=0, rtol=0)
+            self.assertEqual(inverse, expected[1], atol=0, rtol=0)
+            self.assertEqual(counts, expected[2], atol=0, rtol=0)
+            self.assertEqual(torch.unique(t), expected[0], atol=0, rtol=0)
+
+            output, inverse, counts = torch.unique_consecutive(t, return_inverse=True, return_counts=True)
+            expected = torch.unique_consecutive(t.cpu(), return_inverse=True, return_counts=True)
+            self.assertEqual(output, expected[0], atol=0, rtol=0)
+            self.assertEqual(inverse, expected[1], atol=0, rtol=0)
+            self.assertEqual(counts, expected[2], atol=0, rtol=0)
+
+    @onlyCPU
+    @dtypes(torch.int32, torch.int64, torch.float, torch.double)
+    def test_topk_small_k_cpu(self, device, dtype):
+        x = torch.randperm(4096, device=device).to(dtype)
+        if dtype.is_floating_point:
+            x[100] = float('nan')
+        for t in (x, x.view(2, -1), x.view(-1, 2).t()):
+            for k in (1, 5, 32):
+                for largest in (True, False):
+                    expected = t.sort(dim=-1, descending=largest)[0].narrow(-1, 0, k)
+                    val, idx = t.topk(k, largest=largest)
+                    self.assertEqual(val, expected, atol=0, rtol=0)
+                    self.assertEqual(t.gather(-1, idx), val, atol=0, rtol=0)
+                    val, idx = t.topk(k, largest=largest, sorted=False)
+                    self.assertEqual(val.sort(dim=-1, descending=largest)[0], expected,
+                                     atol=0, rtol=0)
+                    self.assertEqual(t.gather(-1, idx), val, atol=0, rtol=0)
+
 
 
 
@@ -15379,6 +15965,36 @@ class TestTorchDeviceType(TestCase):
         z = from_dlpack(to_dlpack(x))
         self.assertEqual(z, x)
 
+    def test_dlpack_conversion_with_stream(self, device):
+        x = torch.randn(1, 2, 3, 4, device=device, dtype=torch.float)
+        # The stream is ignored on the CPU
+        stream = torch.cuda.Stream(device) if x.is_cuda else 0
+        z = from_dlpack(to_dlpack(x, stream=stream), stream=stream)
+        self.assertEqual(z, x)
+        self.assertEqual(z.data_ptr(), x.data_ptr())
+
+    @onlyCUDA
+    def test_dlpack_stream_ordering(self, device):
+        producer = torch.cuda.Stream(device)
+        with torch.cuda.stream(producer):
+            torch.cuda._sleep(1 << 26)
+            x = torch.ones(1 << 20, device=device)
+        # The consumer reads x after the producer wrote it, without the host
+        # synchronizing with either of them.
+        z = from_dlpack(to_dlpack(x), stream=producer)
+        self.assertEqual(z.sum().item(), 1 << 20)
+
+        consumer = torch.cuda.Stream(device)
+        x = torch.ones(1 << 20, device=device)
+        capsule = to_dlpack(x.mul_(2), stream=consumer.cuda_stream)
+        with torch.cuda.stream(consumer):
+            total = from_dlpack(capsule).sum()
+        consumer.synchronize()
+        self.assertEqual(total.item(), 2 << 20)
+
+        with self.assertRaisesRegex(TypeError, 'expected a CUDA stream'):
+            to_dlpack(x, stream='default')
+
     @onlyCUDA
     @unittest.skipIf(PYTORCH_CUDA_MEMCHECK, "is_pinned uses failure to detect pointer property")
     def test_pin_memory_from_constructor(self, device):
@@ -16702,6 +17318,34 @@ scipy_lobpcg  | {:10.2e}  | {:10.2e}  | {:6} | N/A
                                 res2[i, j] += m1[i, l] * m2[l, j]
                     self.assertEqual(res1, res2)
 
+    @dtypes(torch.float, torch.double)
+    @tf32_on_and_off(0.005)
+    def test_addmm_activation(self, device, dtype):
+        # Row major results with a bias take the fused epilogues on CUDA
+        for use_gelu, transpose in product((False, True), (False, True)):
+            bias = torch.randn(25, device=device, dtype=dtype, requires_grad=True)
+            m1 = torch.randn(10, 50, device=device, dtype=dtype, requires_grad=True)
+            m2 = torch.randn(50, 25, device=device, dtype=dtype)
+            if transpose:
+                m2 = m2.t().contiguous().t()
+            m2.requires_grad_()
+            activation = torch.nn.functional.gelu if use_gelu else torch.relu
+            res1 = torch._addmm_activation(bias, m1, m2, use_gelu=use_gelu)
+            res2 = activation(torch.addmm(bias, m1, m2))
+            self.assertEqual(res1, res2)
+
+            grad = torch.randn_like(res1)
+            grads1 = torch.autograd.grad(res1, (bias, m1, m2), grad)
+            grads2 = torch.autograd.grad(res2, (bias, m1, m2), grad)
+            self.assertEqual(grads1, grads2)
+
+        # Scaled and 2-D inputs take the unfused path
+        M = torch.randn(10, 25, device=device, dtype=dtype)
+        m1 = torch.randn(10, 50, device=device, dtype=dtype)
+        m2 = torch.randn(50, 25, device=device, dtype=dtype)
+        self.assertEqual(torch._addmm_activation(M, m1, m2, beta=0.5, alpha=2),
+                         torch.relu(torch.addmm(M, m1, m2, beta=0.5, alpha=2)))
+
     @onlyCPU
     @dtypes(*(torch.testing.get_all_complex_dtypes() + [torch.float, torch.double]))
     def test_dot(self, device, dtype):
@@ -17049,7 +17693,6 @@ scipy_lobpcg  | {:10.2e}  | {:10.2e}  | {:6} | N/A
             z = torch.tensor([math.trunc(30. / v.item()) for v in x], dtype=dtype, device=device)
         self.assertEqual(y, z)
 
-    @onlyCPU
     @dtypes(*torch.testing.get_all_dtypes(include_bfloat16=False, include_bool=False, include_complex=False))
     def test_fmod(self, device, dtype):
         m1 = torch.Tensor(10, 10).uniform_(-10., 10.).to(dtype=dtype, device=device)
@@ -17061,12 +17704,19 @@ scipy_lobpcg  | {:10.2e}  | {:10.2e}  | {:6} | N/A
             res2[i, 3] = math.fmod(res2[i, 3], q)
         self.assertEqual(res1, res2)
 
+        # Broadcasting, and a divisor on the CPU as a scalar.
+        divisor = torch.arange(1, 11, device=device).to(dtype)
+        self.assertEqual(m1.fmod(divisor), torch.stack([m1[i].fmod(divisor) for i in range(10)]))
+        self.assertEqual(m1.fmod(torch.tensor(q, dtype=dtype)), m1.fmod(q))
+
         zero = torch.zeros_like(m1)
         if dtype in torch.testing.get_all_int_dtypes():
             with self.assertRaisesRegex(RuntimeError, "ZeroDivisionError"):
                 m1.fmod(0)
-            with self.assertRaisesRegex(RuntimeError, "ZeroDivisionError"):
-                m1.fmod(zero)
+            # Kernels on the GPU cannot raise.
+            if self.device_type == 'cpu':
+                with self.assertRaisesRegex(RuntimeError, "ZeroDivisionError"):
+                    m1.fmod(zero)
         else:
             self.assertTrue(torch.all(m1.fmod(0).isnan()))
             self.assertTrue(torch.all(m1.fmod(zero).isnan()))
@@ -17386,6 +18036,28 @@ scipy_lobpcg  | {:10.2e}  | {:10.2e}  | {:6} | N/A
             self.assertRaises(RuntimeError, lambda: torch.bmm(b1, b2.cuda()))
             self.assertRaises(RuntimeError, lambda: torch.bmm(b1.cuda(), b2))
 
+    @onlyCPU
+    @dtypes(torch.float, torch.double)
+    def test_bmm_small_sizes(self, device, dtype):
+        num_batches = 7
+        for M, N, O in [(1, 1, 1), (3, 5, 7), (8, 8, 8), (17, 33, 9), (64, 64, 64), (65, 8, 8)]:
+            for transpose1, transpose2 in product([False, True], repeat=2):
+                b1 = torch.randn(num_batches, M, N, dtype=dtype, device=device)
+                b2 = torch.randn(num_batches, N, O, dtype=dtype, device=device)
+                if transpose1:
+                    b1 = b1.transpose(1, 2).contiguous().transpose(1, 2)
+                if transpose2:
+                    b2 = b2.transpose(1, 2).contiguous().transpose(1, 2)
+                expected = torch.stack([torch.mm(b1[i], b2[i]) for i in range(num_batches)])
+                self.assertEqual(torch.bmm(b1, b2), expected)
+                self.assertEqual(torch.matmul(b1, b2), expected)
+
+                c = torch.randn(num_batches, M, O, dtype=dtype, device=device)
+                self.assertEqual(torch.baddbmm(c, b1, b2, beta=.5, alpha=2), c * .5 + expected * 2)
+                # With beta 0, self is ignored, NaNs included.
+                c.fill_(float('nan'))
+                self.assertEqual(torch.baddbmm(c, b1, b2, beta=0), expected)
+
     @onlyCUDA
     @unittest.skipIf(IS_WINDOWS, "Test is broken on Windows. See https://github.com/pytorch/pytorch/issues/42501")
     @wrapDeterministicFlagAPITest
@@ -18320,6 +18992,113 @@ else:
         test_output_dtype(torch.int32, False)
         test_output_dtype(torch.int64, True)
 
+    def _segment_offsets(self, lengths, device):
+        offsets = [0]
+        for length in lengths:
+            offsets.append(offsets[-1] + length)
+        return torch.tensor(offsets, device=device, dtype=torch.long)
+
+    @dtypesIfCUDA(torch.half, torch.float, torch.double)
+    @dtypes(torch.float, torch.double)
+    def test_segment_reduce(self, device, dtype):
+        lengths = [3, 0, 1, 70, 5, 0, 300]
+        offsets = self._segment_offsets(lengths, device)
+        # 1-D and narrow rows use a block per segment on CUDA, wide rows a
+        # thread per column.
+        for inner in ((), (5,), (40,)):
+            data = torch.randn(sum(lengths), *inner, device=device, dtype=dtype)
+            for reduce in ("sum", "mean", "max"):
+                out = torch.segment_reduce(data, offsets, reduce)
+                expected = []
+                for start, stop in zip(offsets[:-1].tolist(), offsets[1:].tolist()):
+                    segment = data[start:stop].double()
+                    if start == stop:
+                        expected.append(torch.zeros(inner, device=device, dtype=torch.double))
+                    elif reduce == "max":
+                        expected.append(segment.max(0)[0])
+                    else:
+                        expected.append(getattr(segment, reduce)(0))
+                self.assertEqual(out, torch.stack(expected).to(dtype), atol=1e-2 if dtype == torch.half else None,
+                                 rtol=1e-2 if dtype == torch.half else None)
+
+        # The index of the max is the first one for ties and -1 for empty segments.
+        data = torch.tensor([1., 3., 3., 2., 5.], device=device, dtype=dtype)
+        out, arg = torch._segment_reduce(data, torch.tensor([0, 4, 4, 5], device=device), "max")
+        self.assertEqual(out, torch.tensor([3., 0., 5.], device=device, dtype=dtype))
+        self.assertEqual(arg, torch.tensor([1, -1, 4], device=device))
+
+        data = torch.tensor([1., float('nan'), 2.], device=device, dtype=dtype)
+        out = torch.segment_reduce(data, torch.tensor([0, 3], device=device), "max")
+        self.assertTrue(torch.isnan(out).all())
+
+        if dtype == torch.double:
+            lengths = [2, 0, 3, 1]
+            offsets = self._segment_offsets(lengths, device)
+            data = torch.randn(6, 3, device=device, dtype=dtype, requires_grad=True)
+            for reduce in ("sum", "mean", "max"):
+                self.assertTrue(torch.autograd.gradcheck(
+                    lambda x: torch.segment_reduce(x, offsets, reduce), (data,)))
+
+    @dtypesIfCUDA(torch.half, torch.float, torch.double)
+    @dtypes(torch.float, torch.double)
+    def test_segment_softmax(self, device, dtype):
+        lengths = [3, 0, 1, 70, 5, 300]
+        offsets = self._segment_offsets(lengths, device)
+        for inner in ((), (5,), (40,)):
+            data = torch.randn(sum(lengths), *inner, device=device, dtype=dtype)
+            out = torch.segment_softmax(data, offsets)
+            expected = torch.cat([torch.softmax(segment.double(), 0) for segment in data.split(lengths)])
+            self.assertEqual(out, expected.to(dtype), atol=1e-3 if dtype == torch.half else None,
+                             rtol=1e-3 if dtype == torch.half else None)
+
+        if dtype == torch.double:
+            data = torch.randn(6, 3, device=device, dtype=dtype, requires_grad=True)
+            offsets = self._segment_offsets([2, 0, 3, 1], device)
+            self.assertTrue(torch.autograd.gradcheck(lambda x: torch.segment_softmax(x, offsets), (data,)))
+            self.assertTrue(torch.autograd.gradgradcheck(lambda x: torch.segment_softmax(x, offsets), (data,)))
+
+    @dtypes(torch.float, torch.double, torch.int32, torch.int64, torch.uint8)
+    def test_segment_sort(self, device, dtype):
+        lengths = [3, 0, 1, 70, 5, 2000]
+        offsets = self._segment_offsets(lengths, device)
+        if dtype.is_floating_point:
+            data = torch.randn(sum(lengths), device=device, dtype=dtype)
+            data[4] = float('nan')
+        else:
+            # Small values so that there are ties.
+            data = torch.randint(0, 10, (sum(lengths),), device=device, dtype=dtype)
+        for descending in (False, True):
+            values, indices = torch.segment_sort(data, offsets, descending=descending)
+            for segment, segment_values, segment_indices in zip(
+                    data.split(lengths), values.split(lengths), indices.split(lengths)):
+                expected, _ = segment.sort(descending=descending)
+                self.assertEqual(segment_values, expected)
+                self.assertEqual(segment[segment_indices], segment_values)
+                # The sort is stable.
+                ties = segment_values[:-1] == segment_values[1:]
+                self.assertTrue((segment_indices[:-1] < segment_indices[1:])[ties].all())
+
+        if dtype == torch.double:
+            data = torch.randn(6, device=device, dtype=dtype, requires_grad=True)
+            offsets = self._segment_offsets([2, 0, 3, 1], device)
+            self.assertTrue(torch.autograd.gradcheck(lambda x: torch.segment_sort(x, offsets)[0], (data,)))
+
+    def test_segment_errors(self, device):
+        data = torch.randn(5, device=device)
+        with self.assertRaisesRegex(RuntimeError, "reduce has to be one of"):
+            torch.segment_reduce(data, torch.tensor([0, 5], device=device), "min")
+        with self.assertRaisesRegex(RuntimeError, "expected int64 offsets"):
+            torch.segment_reduce(data, torch.tensor([0, 5], device=device, dtype=torch.int32), "sum")
+        with self.assertRaisesRegex(RuntimeError, "expected 1-D offsets"):
+            torch.segment_softmax(data, torch.tensor([[0, 5]], device=device))
+        with self.assertRaisesRegex(RuntimeError, "expected 1-D data"):
+            torch.segment_sort(data.view(5, 1), torch.tensor([0, 5], device=device))
+        if self.device_type == 'cpu':
+            with self.assertRaisesRegex(RuntimeError, "offsets\\[-1\\] to be data.size\\(0\\)"):
+                torch.segment_reduce(data, torch.tensor([0, 4]), "sum")
+            with self.assertRaisesRegex(RuntimeError, "non-decreasing"):
+                torch.segment_softmax(data, torch.tensor([0, 3, 2, 5]))
+
     def test_pickle_gradscaler(self, device):
         # This test is not in test_cuda.py because it should pass in 3 cases:
         #  1. cuda is not available.
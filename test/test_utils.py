@@ -9,6 +9,7 @@ import unittest
 import torch
 import torch.nn as nn
 import torch.utils.data
+import torch.utils.metrics
 import torch.cuda
 from torch.utils.checkpoint import checkpoint, checkpoint_sequential
 import torch.utils._benchmark as benchmark_utils
@@ -267,6 +268,92 @@ class TestCheckpoint(TestCase):
         out = checkpoint(run_fn, input_var, None)
         out.sum().backward()
 
+    def test_checkpoint_without_reentrant(self):
+        inp = torch.randn(4, 8, requires_grad=True)
+        weight = torch.randn(8, 8, requires_grad=True)
+        num_calls = [0]
+
+        def block(x):
+            num_calls[0] += 1
+            return torch.nn.functional.layer_norm(x.sin().exp(), (8,)).tanh()
+
+        def run(use_checkpoint):
+            h = inp.mm(weight)
+            if use_checkpoint:
+                h = checkpoint(block, h, use_reentrant=False)
+            else:
+                h = block(h)
+            out = h.mm(weight).sum()
+            return torch.autograd.grad(out, (inp, weight))
+
+        expected = run(False)
+        num_calls[0] = 0
+        self.assertEqual(run(True), expected)
+        # Once in the forward pass, once when backward needs the dropped tensors.
+        self.assertEqual(num_calls[0], 2)
+
+    def test_checkpoint_without_reentrant_drops_saved_tensors(self):
+        packed = []
+
+        def pack(x):
+            packed.append(x)
+            return x
+
+        inp = torch.randn(100, requires_grad=True)
+        with torch.autograd.graph.saved_tensors_hooks(pack, lambda x: x):
+            # The exp and the input of sin are saved outside the region.
+            out = checkpoint(lambda x: x.sin().cos(), inp.exp(), use_reentrant=False).sum()
+        # The region's own saved tensors are not packed by the outer hooks.
+        self.assertEqual(len(packed), 1)
+        out.backward()
+        self.assertEqual(inp.grad, -(inp.exp().sin().sin() * inp.exp().cos() * inp.exp()))
+
+    def test_checkpoint_without_reentrant_nested(self):
+        def inner(x):
+            return x.sin().sin()
+
+        def outer(x):
+            return checkpoint(inner, x.cos(), use_reentrant=False).exp()
+
+        inp = torch.randn(10, requires_grad=True)
+        out = checkpoint(outer, inp, use_reentrant=False)
+        out.sum().backward(retain_graph=True)
+        grad = inp.grad.clone()
+        inp.grad = None
+        # The recomputed tensors are kept while the graph is retained.
+        out.sum().backward()
+        self.assertEqual(inp.grad, grad)
+        inp.grad = None
+        outer(inp).sum().backward()
+        self.assertEqual(inp.grad, grad)
+
+    def test_checkpoint_without_reentrant_rng(self):
+        inp = torch.randn(20000, requires_grad=True)
+        dropout = torch.nn.Dropout()
+        state = torch.get_rng_state()
+        out = checkpoint(lambda x: dropout(x).exp(), inp, use_reentrant=False)
+        # Backward recomputes the dropout with the RNG state of the forward
+        # pass, whatever ran in between.
+        torch.rand(10)
+        out.sum().backward()
+        grad_with_checkpointing = inp.grad
+
+        torch.set_rng_state(state)
+        inp.grad = None
+        dropout(inp).exp().sum().backward()
+        self.assertEqual(grad_with_checkpointing, inp.grad)
+
+    def test_checkpoint_without_reentrant_mismatch(self):
+        calls = [0]
+
+        def run_fn(x):
+            calls[0] += 1
+            return x.exp() if calls[0] == 1 else x.exp().exp()
+
+        out = checkpoint(run_fn, torch.randn(3, requires_grad=True) * 2, use_reentrant=False)
+        with self.assertRaisesRegex(RuntimeError, "must run the same operations"):
+            out.sum().backward()
+
 
 class TestDataLoader(TestCase):
     def setUp(self):
@@ -629,5 +716,62 @@ class TestBenchmarkUtils(TestCase):
                 x, torch.Tensor(expected_results[i]), rtol=1e-3, atol=1e-3)
 
 
+class TestMetrics(TestCase):
+    def setUp(self):
+        self.was_enabled = torch.utils.metrics.is_enabled()
+        torch.utils.metrics.enable(operators=True)
+
+    def tearDown(self):
+        torch.utils.metrics.disable()
+        if self.was_enabled:
+            torch.utils.metrics.enable()
+
+    def _value(self, name, labels=""):
+        for sample in torch.utils.metrics.snapshot():
+            if sample["name"] == name and sample["labels"] == labels:
+                return sample["value"]
+        return 0
+
+    def test_operator_counts(self):
+        labels = 'op="aten::mul"'
+        before = self._value("aten_op_calls_total", labels)
+        x = torch.ones(3)
+        for _ in range(5):
+            x.mul(2)
+        self.assertGreaterEqual(self._value("aten_op_calls_total", labels) - before, 5)
+        self.assertIn("# TYPE aten_op_calls_total counter",
+                      torch.utils.metrics.prometheus_text())
+
+    def test_dataloader_wait(self):
+        loader = torch.utils.data.DataLoader(torch.arange(8), batch_size=2)
+        for _ in loader:
+            pass
+        for sample in torch.utils.metrics.snapshot():
+            if sample["name"] == "torch_dataloader_batch_wait_us":
+                self.assertGreaterEqual(sum(sample["buckets"]), 4)
+                break
+        else:
+            self.fail("torch_dataloader_batch_wait_us wasn't recorded")
+
+    def test_sinks(self):
+        torch.utils.metrics.counter_add("test_utils_sink_total", "help", 3)
+        reports = []
+        sink = torch.utils.metrics.add_sink(reports.append)
+        torch.utils.metrics.report()
+        torch.utils.metrics.remove_sink(sink)
+        torch.utils.metrics.report()
+        self.assertEqual(len(reports), 1)
+        self.assertIn("test_utils_sink_total",
+                      [sample["name"] for sample in reports[0]])
+
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "torch.prom")
+            sink = torch.utils.metrics.add_prometheus_file_sink(path)
+            torch.utils.metrics.report()
+            torch.utils.metrics.remove_sink(sink)
+            with open(path) as f:
+                self.assertIn("test_utils_sink_total 3", f.read())
+
+
 if __name__ == '__main__':
     run_tests()
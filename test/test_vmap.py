@@ -1,6 +1,6 @@
 from torch.testing._internal.common_utils import TestCase, run_tests
 import torch
-from torch import vmap
+from torch import vmap, Tensor
 import functools
 import warnings
 
@@ -446,32 +446,52 @@ class TestVmapAPI(TestCase):
             self.assertRegex(str(wa[-1].message),
                              r'falling back to slow \(for loop and stack\) implementation')
 
-    def test_fallback_sub(self):
-        # NB: One day we will implement a batching rule for torch.sub.
+    def test_fallback_atan2(self):
+        # NB: One day we will implement a batching rule for torch.atan2.
         # If/when we do, this test should be replaced to test the fallback
         # path on another operator to avoid bitrot.
         x = torch.randn(5, 7, 11)
         y = torch.randn(5, 7, 11)
 
-        self._assert_uses_vmap_fallback((torch.sub,), (x, y))
+        self._assert_uses_vmap_fallback((torch.atan2,), (x, y))
 
-        # fallback on torch.sub
+        # fallback on torch.atan2
         x = torch.randn(7, 11, 5)
         y = torch.randn(5, 7, 11)
-        result = vmap(torch.sub, (2, 0))(x, y)
-        self.assertEqual(result, x.permute(2, 0, 1) - y)
+        result = vmap(torch.atan2, (2, 0))(x, y)
+        self.assertEqual(result, torch.atan2(x.permute(2, 0, 1), y))
 
-        # fallback on torch.sub, nested vmap
+        # fallback on torch.atan2, nested vmap
         x = torch.randn(7, 11, 5)
         y = torch.randn(5, 7, 11)
-        result = vmap(vmap(torch.sub), (2, 0))(x, y)
-        self.assertEqual(result, x.permute(2, 0, 1) - y)
+        result = vmap(vmap(torch.atan2), (2, 0))(x, y)
+        self.assertEqual(result, torch.atan2(x.permute(2, 0, 1), y))
 
         # big batch size (total 10000)
         x = torch.randn(100, 10, 10, 5)
         y = torch.randn(100, 10, 10)
-        result = vmap(vmap(vmap(torch.sub)))(x, y)
-        self.assertEqual(result, x - y.view(100, 10, 10, 1))
+        result = vmap(vmap(vmap(torch.atan2)))(x, y)
+        self.assertEqual(result, torch.atan2(x, y.view(100, 10, 10, 1)))
+
+    def test_fallback_counts(self):
+        x = torch.randn(5, 7)
+        torch._C._reset_vmap_fallback_counts()
+        with warnings.catch_warnings(record=True):
+            vmap(torch.atan2)(x, x)
+            vmap(vmap(torch.atan2))(x, x)
+            vmap(torch.var_mean)(x)
+            # Ops that have a batching rule aren't counted
+            vmap(torch.mul)(x, x)
+        self.assertEqual(torch._C._vmap_fallback_counts(),
+                         {'aten::atan2': 2, 'aten::var_mean': 1})
+
+        # Ops that can't go through the fallback are counted too
+        with self.assertRaisesRegex(RuntimeError, 'Batching rule not implemented'):
+            vmap(torch.Tensor.item)(x)
+        self.assertEqual(torch._C._vmap_fallback_counts()['aten::item'], 1)
+
+        torch._C._reset_vmap_fallback_counts()
+        self.assertEqual(torch._C._vmap_fallback_counts(), {})
 
     def test_fallback_masked_fill(self):
         # NB: One day we will implement a batching rule for masked_fill
@@ -727,6 +747,255 @@ class TestVmapOperators(TestCase):
             test(vmap(op), getter([B1, 2, 5, B0, 3], device), in_dims=2)
             test(vmap(op, in_dims=2), getter([2, 5, B0, B1, 3], device), in_dims=2, out_dims=2)
 
+    def test_binary_pointwise_ops(self):
+        cases = [
+            torch.add,
+            lambda x, y: torch.add(x, y, alpha=2),
+            torch.sub,
+            lambda x, y: torch.sub(x, y, alpha=0.5),
+            lambda x, y: torch.rsub(x, y, alpha=3),
+            torch.mul,
+            torch.div,
+            lambda x, y: torch.pow(x.abs(), y),
+        ]
+        test = self._vmap_test
+        B0, B1 = 7, 11
+        for op in cases:
+            self._assert_doesnt_use_vmap_fallback([op], (torch.randn(B0, 3), torch.randn(B0, 3)))
+
+            # Batched x batched, with broadcasting
+            test(op, (torch.randn(B0, 3), torch.randn(B0, 3)))
+            test(op, (torch.randn(B0, 2, 3), torch.randn(B0, 3)))
+            test(op, (torch.randn(B0, 3), torch.randn(3, B0)), in_dims=(0, 1))
+            # Batched x unbatched
+            test(op, (torch.randn(B0, 2, 3), torch.randn(3)), in_dims=(0, None))
+            test(op, (torch.randn(B0, 3), torch.randn(2, 3)), in_dims=(0, None))
+            test(op, (torch.randn(2, 3), torch.randn(B0, 3)), in_dims=(None, 0))
+            # Unbatched 0-dim tensors keep their type promotion semantics
+            test(op, (torch.randn(B0, 3), torch.tensor(2.5, dtype=torch.double)), in_dims=(0, None))
+            # Doubly nested vmap
+            test(vmap(op), (torch.randn(B0, B1, 3), torch.randn(B0, B1, 3)))
+            test(vmap(op, in_dims=(0, None)), (torch.randn(B1, 2, B0, 3), torch.randn(B0, 3)),
+                 in_dims=(2, 0))
+            test(vmap(op, in_dims=(None, 0)), (torch.randn(B0, 3), torch.randn(B1, 2, 3)),
+                 in_dims=(0, None))
+
+        # Batched 0-dim tensors
+        result = vmap(torch.mul)(torch.randn(B0), torch.randn(B0, 3))
+        self.assertEqual(result.shape, (B0, 3))
+        x = torch.tensor([1, 2, 3])
+        self.assertEqual(vmap(lambda t: t * 2.5)(x), x * 2.5)
+        self.assertEqual(vmap(lambda t: t * torch.tensor(2.5))(x), x * 2.5)
+
+    def test_inplace_binary_pointwise_ops(self):
+        cases = [
+            (Tensor.add_, torch.add),
+            (lambda x, y: x.add_(y, alpha=2), lambda x, y: torch.add(x, y, alpha=2)),
+            (Tensor.sub_, torch.sub),
+            (Tensor.mul_, torch.mul),
+            (Tensor.div_, torch.div),
+        ]
+        B0, B1 = 7, 11
+        for inplace_op, op in cases:
+            # `y_aligned` is `y` with its batch dims aligned to those of `x`
+            def check(x, y, in_dims=0, nested=False, y_aligned=None):
+                expected = op(x, y if y_aligned is None else y_aligned)
+                if nested:
+                    inplace_fn = vmap(inplace_op, in_dims=in_dims)
+                    in_dims = 0
+                else:
+                    inplace_fn = inplace_op
+                self._assert_doesnt_use_vmap_fallback([inplace_fn, in_dims], (x.clone(), y))
+                result = vmap(inplace_fn, in_dims=in_dims)(x, y)
+                self.assertEqual(result, expected)
+                self.assertEqual(x, expected)
+                self.assertEqual(result.data_ptr(), x.data_ptr())
+
+            check(torch.randn(B0, 3), torch.randn(B0, 3))
+            y = torch.randn(B0, 3)
+            check(torch.randn(B0, 2, 3), y, y_aligned=y.view(B0, 1, 3))
+            check(torch.randn(B0, 2, 3), torch.randn(3), in_dims=(0, None))
+            check(torch.randn(B0, B1, 3), torch.randn(B0, B1, 3), nested=True)
+            check(torch.randn(B0, B1, 3), y, in_dims=(0, None), nested=True, y_aligned=y.view(B0, 1, 3))
+
+            # The Tensor modified in-place must be batched over all of the
+            # vmapped dimensions.
+            msg = 'in-place operation on a Tensor would need to write a value per example'
+            captured = torch.randn(3)
+            with self.assertRaisesRegex(RuntimeError, msg):
+                vmap(lambda t: inplace_op(captured, t))(torch.randn(B0, 3))
+            with self.assertRaisesRegex(RuntimeError, msg):
+                vmap(vmap(inplace_op, in_dims=(None, 0)))(torch.randn(B0, 3), torch.randn(B0, B1, 3))
+
+        # clone() is a rule, so cloning first keeps the inputs as they are
+        x = torch.randn(B0, 3)
+        self._vmap_test(lambda t, u: t.clone().mul_(u), (x, torch.randn(B0, 3)))
+        self._assert_doesnt_use_vmap_fallback([torch.clone], (x,))
+
+    def test_scalar_pointwise_ops(self):
+        cases = [
+            lambda t: t + 2,
+            lambda t: torch.add(t, 2, alpha=3),
+            lambda t: t - 1.5,
+            lambda t: t * 3,
+            lambda t: t / 2,
+            lambda t: t ** 2,
+            lambda t: torch.threshold(t, 0.1, 20),
+            lambda t: torch.clamp(t, -0.5, 0.5),
+            lambda t: torch.clamp(t, min=0),
+            torch.nn.functional.gelu,
+        ]
+        test = self._vmap_test
+        B0, B1 = 7, 11
+        for op in cases:
+            self._assert_doesnt_use_vmap_fallback([op], (torch.randn(B0, 3),))
+            test(op, (torch.randn(B0, 3),))
+            test(op, (torch.randn(2, 5, B0, 3),), in_dims=2, out_dims=2)
+            test(vmap(op), (torch.randn(B0, B1, 3),))
+
+    def test_reductions(self):
+        cases = [
+            torch.sum,
+            lambda t: torch.sum(t, dtype=torch.double),
+            lambda t: torch.sum(t, 0),
+            lambda t: torch.sum(t, (0, -1), keepdim=True),
+            torch.mean,
+            lambda t: torch.mean(t, -1),
+            lambda t: torch.mean(t, (0, 1), keepdim=True),
+            lambda t: torch.logsumexp(t, 1),
+            lambda t: torch.logsumexp(t, (0, 1), keepdim=True),
+        ]
+        test = self._vmap_test
+        B0, B1 = 7, 11
+        for op in cases:
+            self._assert_doesnt_use_vmap_fallback([op], (torch.randn(B0, 2, 3),))
+            test(op, (torch.randn(B0, 2, 3),))
+            test(op, (torch.randn(2, B0, 3),), in_dims=1)
+            test(vmap(op), (torch.randn(B0, B1, 2, 3),))
+            test(vmap(op, in_dims=2), (torch.randn(2, B0, 3, B1),), in_dims=1)
+
+        # Full reductions of 0-dim examples
+        x = torch.randn(B0)
+        self.assertEqual(vmap(torch.sum)(x), x)
+        self.assertEqual(vmap(torch.mean)(x), x)
+        self.assertEqual(vmap(lambda t: torch.sum(t, []))(torch.randn(B0, 3)).shape, (B0,))
+
+    def test_softmax(self):
+        cases = [
+            lambda t: torch.softmax(t, -1),
+            lambda t: torch.softmax(t, 0),
+            lambda t: torch.log_softmax(t, 1),
+            lambda t: torch.nn.functional.log_softmax(t, dim=0),
+        ]
+        test = self._vmap_test
+        B0, B1 = 7, 11
+        for op in cases:
+            self._assert_doesnt_use_vmap_fallback([op], (torch.randn(B0, 2, 3),))
+            test(op, (torch.randn(B0, 2, 3),))
+            test(op, (torch.randn(2, B0, 3),), in_dims=1, out_dims=2)
+            test(vmap(op), (torch.randn(B0, B1, 2, 3),))
+
+    def test_matmul(self):
+        test = self._vmap_test
+        B0, B1 = 7, 11
+        sizes = [(5,), (2, 5), (3, 2, 5)]
+        other_sizes = [(5,), (5, 4), (3, 5, 4)]
+        for size in sizes:
+            for other_size in other_sizes:
+                x = torch.randn(B0, *size)
+                y = torch.randn(B0, *other_size)
+                self._assert_doesnt_use_vmap_fallback([torch.matmul], (x, y))
+                test(torch.matmul, (x, y))
+                test(torch.matmul, (x, y[0]), in_dims=(0, None))
+                test(torch.matmul, (x[0], y), in_dims=(None, 0))
+                test(torch.matmul, (x.movedim(0, -1), y), in_dims=(-1 + x.dim(), 0))
+                test(vmap(torch.matmul), (torch.randn(B0, B1, *size), torch.randn(B0, B1, *other_size)))
+                test(vmap(torch.matmul, in_dims=(None, 0)),
+                     (torch.randn(B0, *size), torch.randn(B1, *other_size)), in_dims=(0, None))
+
+        # The variants of matmul check their ranks
+        test(torch.mm, (torch.randn(B0, 2, 5), torch.randn(5, 3)), in_dims=(0, None))
+        test(torch.mm, (torch.randn(B0, 2, 5), torch.randn(B0, 5, 3)))
+        test(torch.mv, (torch.randn(B0, 2, 5), torch.randn(B0, 5)))
+        test(torch.dot, (torch.randn(B0, 5), torch.randn(5)), in_dims=(0, None))
+        test(torch.bmm, (torch.randn(B0, 3, 2, 5), torch.randn(3, 5, 4)), in_dims=(0, None))
+        with self.assertRaisesRegex(RuntimeError, 'mm: expected both arguments to be matrices'):
+            vmap(torch.mm)(torch.randn(B0, 5), torch.randn(B0, 5, 3))
+        with self.assertRaisesRegex(RuntimeError, 'dot: expected both arguments to be vectors'):
+            vmap(torch.dot)(torch.randn(B0, 2, 5), torch.randn(B0, 5))
+        with self.assertRaisesRegex(RuntimeError, 'need to be at least 1D'):
+            vmap(torch.matmul)(torch.randn(B0), torch.randn(B0, 5))
+
+    def test_linear(self):
+        test = self._vmap_test
+        B0, B1 = 7, 11
+        weight = torch.randn(4, 5)
+        bias = torch.randn(4)
+        ops = [
+            lambda x: torch.nn.functional.linear(x, weight),
+            lambda x: torch.nn.functional.linear(x, weight, bias),
+        ]
+        for op in ops:
+            self._assert_doesnt_use_vmap_fallback([op], (torch.randn(B0, 5),))
+            test(op, (torch.randn(B0, 5),))
+            test(op, (torch.randn(B0, 3, 5),))
+            test(op, (torch.randn(3, B0, 5),), in_dims=1)
+            test(vmap(op), (torch.randn(B0, B1, 2, 5),))
+
+        # Per-example weights and biases
+        op = torch.nn.functional.linear
+        test(op, (torch.randn(B0, 3, 5), torch.randn(B0, 4, 5), torch.randn(B0, 4)))
+        test(op, (torch.randn(3, 5), torch.randn(B0, 4, 5), bias), in_dims=(None, 0, None))
+        test(op, (torch.randn(3, 5), weight, torch.randn(B0, 4)), in_dims=(None, None, 0))
+
+    def test_conv2d(self):
+        test = self._vmap_test
+        op = torch.nn.functional.conv2d
+        B0, B1 = 3, 2
+        x = torch.randn(B0, 2, 4, 6, 5)
+        weight = torch.randn(6, 2, 3, 3)
+        bias = torch.randn(6)
+        self._assert_doesnt_use_vmap_fallback([op, (0, None, None)], (x, weight, bias))
+
+        # Shared weights
+        test(op, (x, weight), in_dims=(0, None))
+        test(op, (x, weight, bias), in_dims=(0, None, None))
+        test(lambda x, w: op(x, w, stride=2, padding=1), (x, weight), in_dims=(0, None))
+        test(lambda x, w: op(x, w[:, :2], groups=2), (x, weight), in_dims=(0, None))
+        test(op, (x.movedim(0, 2), weight), in_dims=(2, None))
+        test(vmap(op, in_dims=(0, None)), (torch.randn(B0, B1, 2, 4, 6, 5), weight), in_dims=(0, None))
+
+        # Per-example weights
+        test(op, (x, torch.randn(B0, 6, 4, 3, 3)))
+        test(op, (x, torch.randn(B0, 6, 4, 3, 3), torch.randn(B0, 6)))
+        test(op, (x, weight, torch.randn(B0, 6)), in_dims=(0, None, 0))
+        test(op, (x[0], torch.randn(B0, 6, 4, 3, 3), bias), in_dims=(None, 0, None))
+        test(lambda x, w: op(x, w, padding=1, groups=2), (x, torch.randn(B0, 6, 2, 3, 3)))
+        test(vmap(op), (torch.randn(B0, B1, 2, 4, 6, 5), torch.randn(B0, B1, 6, 4, 3, 3)))
+
+    def test_per_sample_grads(self):
+        # The backward of the ops of a small network run on batched gradients
+        # (grad_outputs) without going through the fallback.
+        B0 = 5
+        x = torch.randn(3, 8, requires_grad=True)
+        weight = torch.randn(6, 8, requires_grad=True)
+        bias = torch.randn(6, requires_grad=True)
+        activations = [torch.relu, torch.sigmoid, torch.tanh,
+                       torch.nn.functional.gelu, lambda t: torch.log_softmax(t, -1),
+                       lambda t: torch.softmax(t, -1)]
+        for activation in activations:
+            output = activation(torch.nn.functional.linear(x, weight, bias)).mean(0)
+
+            def vjp(v):
+                return torch.autograd.grad([output], [x, weight, bias], grad_outputs=[v],
+                                           retain_graph=True)
+
+            batched_v = torch.eye(6)
+            self._assert_doesnt_use_vmap_fallback([vjp], (batched_v,))
+            result = vmap(vjp)(batched_v)
+            expected = [torch.stack(per_v) for per_v in zip(*[vjp(v) for v in batched_v])]
+            self.assertEqual(result, expected)
+
     def test_chunk(self):
         test = self._vmap_view_test
         op = torch.chunk
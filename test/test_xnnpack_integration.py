@@ -658,6 +658,53 @@ class TestXNNPACKRewritePass(TestCase):
             prepack_removal=True,
             fuse_clamping_ops=True)
 
+    def test_clamp_fusion(self):
+        data_shape = [2, 3, 16, 16]
+        conv_weight_shape = (8, 3, 3, 3)
+        linear_weight_shape = (4, 14)
+
+        class M(torch.nn.Module):
+            def __init__(self, inplace=False, min_max=(0., 6.)):
+                super(M, self).__init__()
+                self.conv_weight = torch.nn.Parameter(torch.rand(conv_weight_shape), requires_grad=False)
+                self.conv_bias = torch.nn.Parameter(torch.rand(conv_weight_shape[0]), requires_grad=False)
+                self.linear_weight = torch.nn.Parameter(torch.rand(linear_weight_shape), requires_grad=False)
+                self.linear_bias = torch.nn.Parameter(torch.rand(linear_weight_shape[0]), requires_grad=False)
+                self.inplace = inplace
+                self.min = min_max[0]
+                self.max = min_max[1]
+
+            def forward(self, x):
+                o = F.conv2d(x, self.conv_weight, self.conv_bias)
+                if self.inplace:
+                    o = torch.clamp_(o, self.min, self.max)
+                else:
+                    o = torch.clamp(o, self.min, self.max)
+                o = F.linear(o, self.linear_weight, self.linear_bias)
+                return torch.clamp(o, min=self.min)
+
+        for inplace in [False, True]:
+            # The clamp of the linear output is never in place.
+            pattern_count_map = {"aten::clamp(": 1 if inplace else 2,
+                                 "aten::clamp_": 1 if inplace else -1,
+                                 "prepacked::conv2d_clamp_prepack": -1,
+                                 "prepacked::conv2d_clamp_run": 1,
+                                 "prepacked::linear_clamp_prepack": -1,
+                                 "prepacked::linear_clamp_run": 1}
+            TestXNNPACKRewritePass.validate_transformed_module(
+                M(inplace),
+                pattern_count_map,
+                data_shape,
+                prepack_removal=True)
+            pattern_count_map["aten::clamp("] = -1
+            pattern_count_map["aten::clamp_"] = -1
+            TestXNNPACKRewritePass.validate_transformed_module(
+                M(inplace),
+                pattern_count_map,
+                data_shape,
+                prepack_removal=True,
+                fuse_clamping_ops=True)
+
     def test_decomposed_linear(self):
         data_shape = [2, 32]
         weight_output_dim = 24
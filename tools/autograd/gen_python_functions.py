@@ -65,7 +65,7 @@ SKIP_PYTHON_BINDINGS = [
     '_cholesky.*', '_triangular_solve.*', '_qr.*', '_symeig.*', '_svd.*',
     'slice', 'randint(_out)?',
     'item', '_local_scalar_dense', 'to',
-    'copy_sparse_to_sparse_', 'copy_',
+    'copy_sparse_to_sparse_', 'copy_sparse_csr_to_sparse_csr_', 'copy_',
     'numpy_T',  # this needs to be an attribute in Python, not a function
     'nonzero(_(out|numpy))?',
     'set_quantizer_',  # return types not supported yet
@@ -287,6 +287,7 @@ UNPACK_METHODS = {
     'c10::optional<double>': 'toDoubleOptional',
     'c10::optional<ArrayRef<double>>': 'doublelistOptional',
     'IntArrayRef': 'intlist',
+    'ArrayRef<double>': 'doublelist',
     'Scalar': 'scalar',
     'ScalarType': 'scalartype',
     'Dimname': 'dimname',
@@ -854,10 +855,19 @@ def is_noarg_binding(overloads):
     return len(overloads) == 1 and get_python_argc(overloads[0]) == 0
 
 
+# The parameters of a python binding, and the arguments it passes to the
+# parser and to handle_torch_function. Tensor methods take their arguments by
+# vectorcall (METH_FASTCALL | METH_KEYWORDS), which saves the tuple and the dict
+# of the arguments of every call; see PythonArgParser::parse.
+PY_VARARGS_PARAMS = 'PyObject* args, PyObject* kwargs'
+PY_VARARGS_ARGS = 'args, kwargs'
+PY_FASTCALL_PARAMS = 'PyObject* const* args, Py_ssize_t nargs, PyObject* kwnames'
+PY_FASTCALL_ARGS = 'args, nargs, kwnames'
+
 # python binding for all overloads of a particular function/method
 PY_VARIABLE_METHOD_VARARGS = CodeTemplate(r"""\
 // ${name}
-static PyObject * ${pycname}(PyObject* self_, PyObject* args, PyObject* kwargs)
+static PyObject * ${pycname}(PyObject* self_, ${py_params})
 {
   ${method_header}
   static PythonArgParser parser({
@@ -865,7 +875,7 @@ static PyObject * ${pycname}(PyObject* self_, PyObject* args, PyObject* kwargs)
   }, /*traceable=*/${traceable});
 
   ParsedArgs<${max_args}> parsed_args;
-  auto _r = parser.parse(${self_}, args, kwargs, parsed_args);
+  auto _r = parser.parse(${self_}, ${py_args}, parsed_args);
   ${check_has_torch_function}
   switch (_r.idx) {
     ${dispatch}
@@ -878,7 +888,7 @@ static PyObject * ${pycname}(PyObject* self_, PyObject* args, PyObject* kwargs)
 # python binding for single-overload function/method
 PY_VARIABLE_METHOD_VARARGS_SINGLETON = CodeTemplate("""\
 // ${name}
-static PyObject * ${pycname}(PyObject* self_, PyObject* args, PyObject* kwargs)
+static PyObject * ${pycname}(PyObject* self_, ${py_params})
 {
   ${method_header}
   static PythonArgParser parser({
@@ -886,7 +896,7 @@ static PyObject * ${pycname}(PyObject* self_, PyObject* args, PyObject* kwargs)
   }, /*traceable=*/${traceable});
 
   ParsedArgs<${max_args}> parsed_args;
-  auto _r = parser.parse(${self_}, args, kwargs, parsed_args);
+  auto _r = parser.parse(${self_}, ${py_args}, parsed_args);
   ${check_has_torch_function}
   ${dispatch}
   ${method_footer}
@@ -909,7 +919,7 @@ static PyObject * ${pycname}(PyObject* self_, PyObject* args)
 
 TORCH_FUNCTION_CHECK = CodeTemplate("""\
 if(_r.has_torch_function()) {
-  return handle_torch_function(_r, ${self_}, args, kwargs, ${namespace}, ${modulename});
+  return handle_torch_function(_r, ${self_}, ${py_args}, ${namespace}, ${modulename});
 }
 """)
 
@@ -975,17 +985,22 @@ def method_impl(name, declarations, is_python_method, module):
     else:
         template = PY_VARIABLE_METHOD_VARARGS
 
+    py_params = PY_FASTCALL_PARAMS if is_python_method else PY_VARARGS_PARAMS
+    py_args = PY_FASTCALL_ARGS if is_python_method else PY_VARARGS_ARGS
+
     if module:
         check_has_torch_function = TORCH_FUNCTION_CHECK.substitute(
             namespace=NATIVE_NAMESPACE_MAPPING[module],
             modulename='"' + module + '"',
             self_="self_" if is_python_method else "nullptr",
+            py_args=py_args,
         )
     else:
         check_has_torch_function = TORCH_FUNCTION_CHECK.substitute(
             namespace="THPVariableClass",
             modulename='"torch.Tensor"',
             self_="self_" if is_python_method else "nullptr",
+            py_args=py_args,
         )
 
     max_args = max([get_python_argc(decl) for decl in declarations])
@@ -994,6 +1009,8 @@ def method_impl(name, declarations, is_python_method, module):
     return template.substitute(
         name=name,
         pycname=pycname,
+        py_params=py_params,
+        py_args=py_args,
         method_header=method_header,
         max_args=max_args,
         signatures=signatures,
@@ -1077,7 +1094,7 @@ def method_def(name, declarations, is_python_method, module):
         flags = 'METH_NOARGS' if is_python_method else 'METH_VARARGS | METH_KEYWORDS'
     else:
         pycfunc_voidcast = '(void(*)(void))'
-        flags = 'METH_VARARGS | METH_KEYWORDS'
+        flags = 'THP_METH_FASTCALL_KEYWORDS' if is_python_method else 'METH_VARARGS | METH_KEYWORDS'
 
     if module == "torch":
         flags += ' | METH_STATIC'
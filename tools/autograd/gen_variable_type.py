@@ -1038,7 +1038,7 @@ def emit_body(declaration):
 
             if len(differentiable_output_vars) == 0:
                 # no output is differentiable (.indices() for SparseTensors for example)
-                rhs_value = 'as_view({}, {}, /* is_differentiable */ false)'.format(view_info, var)
+                rhs_value = 'as_view({}, std::move({}), /* is_differentiable */ false)'.format(view_info, var)
             elif len(differentiable_output_vars) == 1:
                 # Single differentiable output (Tensor or Tensor[])
                 return_info = differentiable_outputs[0]
@@ -1053,12 +1053,12 @@ def emit_body(declaration):
                         creation_meta = "CreationMeta::MULTI_OUTPUT_SAFE"
                     else:
                         creation_meta = "CreationMeta::MULTI_OUTPUT_NODE"
-                    rhs_value = ("as_view(/* base */ {}, /* output */ {}, /* is_differentiable */ true, "
+                    rhs_value = ("as_view(/* base */ {}, /* output */ std::move({}), /* is_differentiable */ true, "
                                  "/* creation_meta */ {})").format(view_info, var, creation_meta)
                 else:
                     call += emit_view_lambda()
                     creation_meta = "GradMode::is_enabled() ? CreationMeta::DEFAULT: CreationMeta::NO_GRAD_MODE"
-                    rhs_value = ("as_view(/* base */ {}, /* output */ {}, /* is_differentiable */ true, "
+                    rhs_value = ("as_view(/* base */ {}, /* output */ std::move({}), /* is_differentiable */ true, "
                                  "/* view_func */ func, /* creation_meta */ {})").format(view_info, var, creation_meta)
             else:
                 # This could be supported but we don't need it at the moment, so keeping things simple.
@@ -1145,6 +1145,11 @@ def emit_body(declaration):
             return []
         return ['check_inplace({});'.format(arg['name']) for arg in differentiable_outputs]
 
+    def emit_check_writeable():
+        if not modifies_arguments:
+            return []
+        return ['check_writeable({});'.format(arg['name']) for arg in returns]
+
     def emit_increment_version():
         if not modifies_arguments:
             return []
@@ -1153,12 +1158,15 @@ def emit_body(declaration):
     env = {}
     combined = nested_dict(env, declaration)
 
-    body = []
+    # See c10/util/OverheadProbe.h
+    body = ['C10_OVERHEAD_PROBE(Autograd);']
 
     declare_returned_variables, tie_return_values, get_return_value = format_return_variables(declaration)
 
     if strategy != 'use_type':
         body.extend(unpack_args(env, declaration))
+    if strategy == 'use_derived':
+        body.extend(emit_check_writeable())
     if requires_derivative:
         body.extend(emit_check_inplace())
         body.extend(setup_derivative(differentiable_inputs))
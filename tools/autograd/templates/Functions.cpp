@@ -624,7 +624,7 @@ Tensor clamp_backward(const Tensor & grad, const Tensor &self, const optional<Sc
 
 Tensor mm_mat1_backward(const Tensor & grad, const Tensor & mat2, const Tensor & mat1, const Scalar & alpha) {
   // if input was column-major, return grad as column-order for efficiency
-  if (mat1.is_sparse()) {
+  if (mat1.is_sparse() || mat1.is_sparse_csr()) {
     throw std::runtime_error("calculating the gradient of a sparse Tensor argument to mm is not supported.");
   }
   at::IntArrayRef sizes = mat1.sizes();
@@ -636,7 +636,9 @@ Tensor mm_mat1_backward(const Tensor & grad, const Tensor & mat2, const Tensor &
   }
 }
 
-Tensor mm_mat2_backward(const Tensor & grad, const Tensor & mat1, IntArrayRef sizes, IntArrayRef strides, const Scalar & alpha) {
+Tensor mm_mat2_backward(const Tensor & grad, const Tensor & mat1_, IntArrayRef sizes, IntArrayRef strides, const Scalar & alpha) {
+  // A CSR matrix can't be transposed, so its gradient goes through COO
+  const Tensor & mat1 = mat1_.is_sparse_csr() ? mat1_.to_sparse() : mat1_;
   // if input was column-major, return grad as column-order for efficiency
   if (strides[0] == 1 && strides[1] == sizes[0]) {
     if (mat1.is_sparse()) {
@@ -959,6 +961,47 @@ Tensor infinitely_differentiable_gelu_backward(
   return cdf.addcmul_(self, pdf, kAlpha).mul_(grad);
 }
 
+std::tuple<Tensor, Tensor, Tensor> addmm_activation_backward(
+    const Tensor& grad,
+    const Tensor& self,
+    const Tensor& mat1,
+    const Tensor& mat2,
+    const Scalar& beta,
+    const Scalar& alpha,
+    bool use_gelu,
+    const Tensor& result,
+    std::array<bool, 3> grad_input_mask) {
+  Tensor grad_addmm;
+  if (use_gelu) {
+    Tensor addmm = at::addmm(self, mat1, mat2, beta, alpha);
+    grad_addmm = GradMode::is_enabled()
+        ? infinitely_differentiable_gelu_backward(grad, addmm)
+        : at::gelu_backward(grad, addmm);
+  } else {
+    grad_addmm = at::threshold_backward(grad, result, 0);
+  }
+
+  Tensor grad_self, grad_mat1, grad_mat2;
+  if (grad_input_mask[1]) {
+    grad_mat1 = mm_mat1_backward(grad_addmm, mat2, mat1, alpha);
+  }
+  // The weight and bias gradients of a linear layer come out of one GEMM,
+  // which is not differentiable itself.
+  if (grad_input_mask[0] && grad_input_mask[2] && self.dim() == 1 &&
+      beta.toComplexDouble() == 1.0 && alpha.toComplexDouble() == 1.0 &&
+      !GradMode::is_enabled()) {
+    std::tie(grad_mat2, grad_self) = at::_mm_and_bias_grad(grad_addmm, mat1);
+    return std::make_tuple(grad_self, grad_mat1, grad_mat2);
+  }
+  if (grad_input_mask[0]) {
+    grad_self = maybe_multiply(grad_addmm, beta);
+  }
+  if (grad_input_mask[2]) {
+    grad_mat2 = mm_mat2_backward(grad_addmm, mat1, mat2.sizes(), mat2.strides(), alpha);
+  }
+  return std::make_tuple(grad_self, grad_mat1, grad_mat2);
+}
+
 Tensor infinitely_differentiable_silu_backward(
     const Tensor& grad_output,
     const Tensor& input) {
@@ -1160,6 +1203,38 @@ Tensor mse_loss_double_backward_grad_output(const Tensor & grad, const Tensor &
   return (r * grad).sum();
 }
 
+// The gradient of _cross_entropy_rows is g * (P * coef - Q), with P the
+// softmax of the rows, coef the weight of the loss of each row and Q the
+// weighted (smoothed) one-hot targets, neither of which depends on the input.
+std::tuple<Tensor, Tensor> cross_entropy_rows_double_backward(
+    const Tensor & grad, const Tensor & grad_losses, const Tensor & self, const Tensor & target,
+    const Tensor & weight, int64_t ignore_index, double label_smoothing, std::array<bool, 2> grad_input_mask) {
+  const int64_t n_classes = self.size(1);
+  auto mask = target.ne(ignore_index).to(self.scalar_type());
+  auto safe_target = target.masked_fill(target.eq(ignore_index), 0);
+  auto class_weight = weight.defined() ? weight : at::ones({n_classes}, self.options());
+  auto target_weight = class_weight.index_select(0, safe_target) * mask;
+  auto coef = target_weight * (1 - label_smoothing) +
+      mask * (class_weight.sum() * (label_smoothing / n_classes));
+  auto probs = at::softmax(self, 1);
+
+  Tensor grad_grad_losses;
+  Tensor grad_self;
+  if (grad_input_mask[0]) {
+    auto targets = at::zeros_like(self, LEGACY_CONTIGUOUS_MEMORY_FORMAT).scatter_(
+        1, safe_target.unsqueeze(1), (target_weight * (1 - label_smoothing)).unsqueeze(1));
+    if (label_smoothing > 0) {
+      targets = targets + mask.unsqueeze(1) * class_weight.unsqueeze(0) * (label_smoothing / n_classes);
+    }
+    grad_grad_losses = (grad * (probs * coef.unsqueeze(1) - targets)).sum(1);
+  }
+  if (grad_input_mask[1]) {
+    auto probs_grad = probs * grad;
+    grad_self = (grad_losses * coef).unsqueeze(1) * (probs_grad - probs * probs_grad.sum(1, true));
+  }
+  return std::make_tuple(grad_grad_losses, grad_self);
+}
+
 Tensor soft_margin_loss_double_backward(const Tensor & grad, const Tensor & input, const Tensor & target, int64_t reduction) {
   auto z = (input * -target).exp();
   auto zplus1 = z + 1;
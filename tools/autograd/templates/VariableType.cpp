@@ -3,6 +3,7 @@
 #include <ATen/TypeDefault.h>
 #include <torch/library.h>
 #include <ATen/core/op_registration/hacky_wrapper_for_legacy_signatures.h>
+#include <c10/util/OverheadProbe.h>
 
 // ${generated_comment}
 
@@ -0,0 +1,88 @@
+"""
+This util is invoked from cmake to produce ATen/selected_dtypes.h for custom
+mobile build with selected dtypes.
+It takes the yaml file of the dtypes each kernel dispatched to while the models
+of an app ran, as written by `dump_operator_names --dtypes_output`, e.g.:
+
+  add_cpu:
+  - Float
+  - Long
+
+and outputs the header defining `at::should_include_kernel_dtype()`, which the
+AT_DISPATCH macros consult to compile only the branches of these dtypes. The
+kernels missing from the yaml file keep all their dtypes, unless
+--prune-unlisted-kernels is given.
+"""
+
+import argparse
+import re
+import yaml
+
+
+HEADER = """\
+#pragma once
+
+// @generated by tools/code_analyzer/gen_selected_dtypes.py
+
+#include <ATen/KernelDtypes.h>
+
+namespace at {{
+
+constexpr bool should_include_kernel_dtype(
+    const char* tag,
+    at::ScalarType dtype) {{
+{body}}}
+
+}} // namespace at
+"""
+
+
+def load_kernel_dtypes(fname):
+    with open(fname, 'r') as stream:
+        kernel_dtypes = yaml.safe_load(stream) or {}
+    for kernel, dtypes in kernel_dtypes.items():
+        if not re.match(r'^[A-Za-z0-9_]+$', kernel):
+            raise ValueError('Invalid kernel name: {}'.format(kernel))
+        for dtype in dtypes:
+            if not re.match(r'^[A-Za-z0-9]+$', dtype):
+                raise ValueError(
+                    'Invalid dtype of kernel {}: {}'.format(kernel, dtype))
+    return kernel_dtypes
+
+
+def gen_header(kernel_dtypes, prune_unlisted_kernels):
+    body = ''
+    for kernel in sorted(kernel_dtypes):
+        dtypes = sorted(set(kernel_dtypes[kernel]))
+        condition = ' ||\n        '.join(
+            'dtype == at::ScalarType::{}'.format(dtype) for dtype in dtypes)
+        body += '  if (kernel_tag_equals(tag, "{}")) {{\n'.format(kernel)
+        body += '    return {};\n'.format(condition or 'false')
+        body += '  }\n'
+    body += '  return {};\n'.format(
+        'false' if prune_unlisted_kernels else 'true')
+    return HEADER.format(body=body)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(
+        description='Util to produce the selected dtypes of the kernels for '
+                    'custom build')
+    parser.add_argument(
+        '--kernel-dtypes',
+        required=True,
+        help='input yaml file of the dtypes of each kernel')
+    parser.add_argument(
+        '--output',
+        required=True,
+        help='output header file')
+    parser.add_argument(
+        '--prune-unlisted-kernels',
+        action='store_true',
+        help='leave out all the dtypes of the kernels missing from the list')
+    args = parser.parse_args()
+
+    header = gen_header(
+        load_kernel_dtypes(args.kernel_dtypes), args.prune_unlisted_kernels)
+    with open(args.output, 'w') as f:
+        f.write(header)
@@ -59,6 +59,7 @@ TYPE_MAP = {
     'std::vector<Tensor>': 'Tensor[]',
     'IntArrayRef': 'int[]',
     'IntArrayRef?': 'int[]?',
+    'ArrayRef<double>': 'float[]',
     'ArrayRef<double>?': 'float[]?',
     'Layout': 'Layout',
     'Layout?': 'Layout?',
@@ -114,6 +115,7 @@ FROM_IVALUE = {
     'Device?': '{}.toOptional<c10::Device>()',
     'IntArrayRef': '{}.toIntVector()',
     'IntArrayRef?': '{}.toOptionalIntArray()',
+    'ArrayRef<double>': '{}.toDoubleVector()',
     'ArrayRef<double>?': '{}.toOptionalDoubleArray()',
     'Layout': '{}.toLayout()',
     'Layout?': '{}.toOptional<c10::Layout>()',
@@ -138,6 +138,7 @@ def type_to_python(typename, size=None):
         'MemoryFormat': 'memory_format',
         'IntArrayRef': '_size',
         'IntArrayRef[]': 'Union[_int, _size]',
+        'ArrayRef<double>': 'List[_float]',
         'TensorList': 'Union[Tuple[Tensor, ...], List[Tensor]]',
         'TensorList[]': 'Union[Tensor, Tuple[Tensor, ...], List[Tensor]]',
         'bool': '_bool',
@@ -458,6 +458,7 @@ del ComplexFloatStorageBase
 ################################################################################
 
 import torch.cuda
+import torch.cpu
 import torch.autograd
 from torch.autograd import no_grad, enable_grad, set_grad_enabled
 # import torch.fft  # TODO: enable once torch.fft() is removed
@@ -1423,6 +1423,28 @@ See also :meth:`Tensor.values`.
   :meth:`Tensor.coalesce` for details.
 """)
 
+add_docstr_all('crow_indices',
+               r"""
+crow_indices() -> Tensor
+
+If :attr:`self` is a sparse CSR matrix (i.e., with ``torch.sparse_csr`` layout),
+this returns a view of the offsets of its rows into its column indices and
+values, of ``nrows + 1`` elements. Otherwise, this throws an error.
+
+See also :meth:`Tensor.col_indices` and :meth:`Tensor.values`.
+""")
+
+add_docstr_all('col_indices',
+               r"""
+col_indices() -> Tensor
+
+If :attr:`self` is a sparse CSR matrix (i.e., with ``torch.sparse_csr`` layout),
+this returns a view of the column indices of its nonzero elements, row after
+row. Otherwise, this throws an error.
+
+See also :meth:`Tensor.crow_indices` and :meth:`Tensor.values`.
+""")
+
 add_docstr_all('get_device',
                r"""
 get_device() -> Device ordinal (Integer)
@@ -3404,6 +3426,22 @@ Example::
            size=(3, 3), nnz=1, layout=torch.sparse_coo)
 """)
 
+add_docstr_all('to_sparse_csr',
+               r"""
+to_sparse_csr() -> Tensor
+Returns a copy of the matrix in :ref:`CSR format <sparse-docs>`, of
+``torch.sparse_csr`` layout, with ``int64`` indices.
+
+Example::
+
+    >>> d = torch.tensor([[0, 0, 0], [9, 0, 10], [0, 0, 0]])
+    >>> d.to_sparse_csr()
+    tensor(crow_indices=tensor([0, 0, 2, 2]),
+           col_indices=tensor([0, 2]),
+           values=tensor([ 9, 10]), size=(3, 3), nnz=2,
+           layout=torch.sparse_csr)
+""")
+
 add_docstr_all('to_mkldnn',
                r"""
 to_mkldnn() -> Tensor
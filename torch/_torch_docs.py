@@ -5922,6 +5922,31 @@ Sets the number of threads used for intraop parallelism on CPU.
     must be called before running eager, JIT or autograd code.
 """)
 
+add_docstr(torch.get_thread_budget,
+           r"""
+get_thread_budget() -> int
+
+Returns the cap on the threads of all the thread pools of the process set by
+:func:`torch.set_thread_budget`, or 0 if there is none.
+""")
+
+add_docstr(torch.set_thread_budget, r"""
+set_thread_budget(int)
+
+Caps the number of threads of the intra-op, inter-op, autograd and RPC agent
+thread pools of the process, which otherwise each size themselves to the
+machine and together may run many more threads than there are cores. The
+pools started afterwards get threads first come first served until the cap is
+reached, and then only the threads they cannot work without, e.g., one autograd
+thread per device. 0 removes the cap. The cap can also be set with the
+``TORCH_THREAD_BUDGET`` environment variable, and the number of threads of
+each kind of pool is reported by :func:`torch.__config__.parallel_info`.
+
+.. warning::
+    Pools are never shrunk, so the cap should be set before any parallel
+    work is started.
+""")
+
 add_docstr(torch.set_num_interop_threads, r"""
 set_num_interop_threads(int)
 
@@ -6229,6 +6254,43 @@ Example::
 .. _torch.sparse: https://pytorch.org/docs/stable/sparse.html
 """.format(**factory_common_args))
 
+add_docstr(torch.sparse_csr_tensor,
+           r"""
+sparse_csr_tensor(crow_indices, col_indices, values, size=None, dtype=None, device=None, requires_grad=False) -> Tensor
+
+Constructs a matrix in CSR (Compressed Sparse Row) format with the given :attr:`values`
+in the columns :attr:`col_indices`, row after row, the rows starting at the offsets
+:attr:`crow_indices` into them: `torch.sparse`_.
+
+Args:
+    crow_indices (Tensor): the offsets of the rows into :attr:`col_indices` and :attr:`values`,
+        of ``nrows + 1`` elements, from 0 to ``nnz``.
+    col_indices (Tensor): the column indices of the nonzero elements. Of the same dtype as
+        :attr:`crow_indices`, either ``torch.int32`` or ``torch.int64``.
+    values (Tensor): the values of the nonzero elements.
+    size (list, tuple, or :class:`torch.Size`, optional): Size of the matrix. If not
+        provided, it has ``nrows`` rows and as many columns as the largest column index
+        needs.
+    dtype (:class:`torch.dtype`, optional): the desired data type of returned tensor.
+        Default: if None, infers data type from :attr:`values`.
+    device (:class:`torch.device`, optional): the desired device of returned tensor.
+        Default: if None, the device of :attr:`values`.
+    {requires_grad}
+
+Example::
+
+    >>> crow_indices = torch.tensor([0, 2, 3])
+    >>> col_indices = torch.tensor([1, 2, 0])
+    >>> values = torch.tensor([3., 5., 4.])
+    >>> torch.sparse_csr_tensor(crow_indices, col_indices, values, (2, 3))
+    tensor(crow_indices=tensor([0, 2, 3]),
+           col_indices=tensor([1, 2, 0]),
+           values=tensor([3., 5., 4.]), size=(2, 3), nnz=3,
+           layout=torch.sparse_csr)
+
+.. _torch.sparse: https://pytorch.org/docs/stable/sparse.html
+""".format(**factory_common_args))
+
 add_docstr(torch.sqrt,
            r"""
 sqrt(input, out=None) -> Tensor
@@ -8755,6 +8817,44 @@ Example::
 """)
 
 
+add_docstr(torch.Generator.set_philox_mode,
+           r"""
+Generator.set_philox_mode(enabled) -> Generator
+
+Sets whether :meth:`~Tensor.uniform_`, :meth:`~Tensor.normal_` and
+:meth:`~Tensor.bernoulli_` with a scalar probability, and hence dropout, draw
+from counter-based Philox streams on a CPU generator. In this mode every call
+takes a single number from the generator and then generates the elements of
+the tensor in parallel, each one from the Philox outputs at its index, so the
+result is the same for any number of threads. The generator state,
+e.g. :meth:`get_state` and :meth:`manual_seed`, still determines the numbers,
+but they differ from the ones generated in the default mode. Other random
+functions are not affected. Returns a `torch.Generator` object.
+
+Arguments:
+    enabled (bool): Whether to use Philox streams.
+
+Example::
+
+    >>> g_cpu = torch.Generator().manual_seed(0).set_philox_mode(True)
+    >>> torch.empty(100000000).normal_(generator=g_cpu)
+""")
+
+
+add_docstr(torch.Generator.philox_mode,
+           r"""
+Generator.philox_mode() -> bool
+
+Returns whether the CPU generator is in the Philox mode set by
+:meth:`set_philox_mode`.
+
+Example::
+
+    >>> torch.default_generator.philox_mode()
+    False
+""")
+
+
 add_docstr(torch.Generator.device,
            r"""
 Generator.device -> device
@@ -8843,6 +8943,77 @@ Example::
             [1, 3, 4]])
 """)
 
+add_docstr(torch.segment_reduce,
+           r"""
+segment_reduce(data, offsets, reduce) -> Tensor
+
+Reduces the segments of a ragged batch stored back to back along the first dimension of
+:attr:`data`. Segment ``b`` is made of the rows ``data[offsets[b]:offsets[b + 1]]``, and
+``out[b]`` is their sum, mean or max, so that ``out`` has ``len(offsets) - 1`` rows.
+Empty segments give 0.
+
+Args:
+    data (Tensor): the segments, concatenated along the first dimension.
+    offsets (LongTensor): 1-D tensor of non-decreasing start offsets of the segments, followed
+                          by ``data.size(0)``; ``offsets[0]`` has to be 0.
+    reduce (str): one of ``"sum"``, ``"mean"`` or ``"max"``.
+
+.. note:: The values of :attr:`offsets` are only validated on CPU, validating them on CUDA
+          would need a synchronization.
+
+Example::
+
+    >>> data = torch.tensor([1., 2., 3., 4., 5., 6.])
+    >>> offsets = torch.tensor([0, 2, 2, 6])
+    >>> torch.segment_reduce(data, offsets, "sum")
+    tensor([ 3.,  0., 18.])
+    >>> torch.segment_reduce(data, offsets, "max")
+    tensor([2., 0., 6.])
+""")
+
+add_docstr(torch.segment_softmax,
+           r"""
+segment_softmax(data, offsets) -> Tensor
+
+Applies softmax over the rows of each segment of :attr:`data`, separately for every element
+of the rows. Segments are described by :attr:`offsets` as in :func:`torch.segment_reduce`.
+
+Args:
+    data (Tensor): the segments, concatenated along the first dimension.
+    offsets (LongTensor): 1-D tensor of non-decreasing start offsets of the segments, followed
+                          by ``data.size(0)``.
+
+Example::
+
+    >>> data = torch.tensor([0., 0., 1., 1., 1.])
+    >>> torch.segment_softmax(data, torch.tensor([0, 2, 5]))
+    tensor([0.5000, 0.5000, 0.3333, 0.3333, 0.3333])
+""")
+
+add_docstr(torch.segment_sort,
+           r"""
+segment_sort(data, offsets, descending=False) -> (Tensor, LongTensor)
+
+Sorts each segment of the 1-D tensor :attr:`data` independently. Segments are described by
+:attr:`offsets` as in :func:`torch.segment_reduce`. The sort is stable and NaN compares greater
+than every other value.
+
+A tuple of (values, indices) is returned, where ``indices`` are the positions of the
+values relative to the start of their segment.
+
+Args:
+    data (Tensor): 1-D tensor of the segments, back to back.
+    offsets (LongTensor): 1-D tensor of non-decreasing start offsets of the segments, followed
+                          by ``data.size(0)``.
+    descending (bool, optional): controls the sorting order (ascending or descending).
+
+Example::
+
+    >>> data = torch.tensor([3., 1., 2., 5., 4.])
+    >>> torch.segment_sort(data, torch.tensor([0, 3, 5]))
+    (tensor([1., 2., 3., 4., 5.]), tensor([1, 2, 0, 1, 0]))
+""")
+
 add_docstr(torch.bucketize,
            r"""
 bucketize(input, boundaries, out_int32=False, right=False, out=None) -> Tensor
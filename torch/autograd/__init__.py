@@ -15,9 +15,10 @@ from .variable import Variable
 from .function import Function, NestedIOFunction
 from .gradcheck import gradcheck, gradgradcheck
 from .grad_mode import no_grad, enable_grad, set_grad_enabled
-from .anomaly_mode import detect_anomaly, set_detect_anomaly
+from .anomaly_mode import detect_anomaly, set_detect_anomaly, detect_nan_with_rerun
 from . import profiler
 from . import functional
+from . import graph
 
 __all__ = ['Variable', 'Function', 'backward', 'grad_mode']
 
@@ -210,6 +211,84 @@ def _is_checkpoint_valid():
     return Variable._execution_engine.is_checkpoint_valid()
 
 
+def set_num_cpu_backward_threads(num_threads: int) -> None:
+    r"""Sets the number of threads that the CPU nodes of backward run on, in
+    addition to the thread that calls :func:`backward` or :func:`grad`.
+
+    By default (``0``), all the CPU nodes of a backward pass run on the
+    calling thread, one after the other. With ``num_threads > 0``, when a node
+    makes several CPU nodes ready, e.g., at the point where independent
+    branches of a model join, all but one of them are handed to a pool of
+    ``num_threads`` worker threads, so that the branches are backpropagated
+    through in parallel. This pool is separate from the intra-op threads of
+    :func:`torch.set_num_threads` and applies to the backward passes started
+    after the call. Reentrant backward calls, e.g., of checkpointing, still run
+    on the thread that makes them.
+
+    Args:
+        num_threads (int): number of CPU worker threads, ``0`` to disable them.
+    """
+    torch.autograd._set_num_cpu_backward_threads(num_threads)
+
+
+def get_num_cpu_backward_threads() -> int:
+    r"""Returns the number of CPU worker threads of backward set by
+    :func:`set_num_cpu_backward_threads`."""
+    return torch.autograd._get_num_cpu_backward_threads()
+
+
+def set_backward_schedule_caching(enabled: bool) -> None:
+    r"""Enables or disables caching the schedules of backward graphs.
+
+    When enabled, the engine records the order it runs the nodes of a
+    backward graph in, under the structure of the graph. The backward calls
+    on graphs of a structure it has seen before, e.g., the iterations of a
+    training loop of static shapes, then run in that order on the calling
+    thread, without the dynamic scheduling of the engine. This reduces the
+    CPU overhead of backward for graphs of many small nodes.
+
+    Only graphs whose nodes all run on the CPU are cached. Disabling the
+    caching drops the cached schedules.
+
+    Args:
+        enabled (bool): whether to cache the schedules.
+    """
+    torch.autograd._set_backward_schedule_caching(enabled)
+
+
+def is_backward_schedule_caching_enabled() -> bool:
+    r"""Returns whether the schedules of backward graphs are cached, see
+    :func:`set_backward_schedule_caching`."""
+    return torch.autograd._is_backward_schedule_caching_enabled()
+
+
+def set_backward_multi_stream(enabled: bool) -> None:
+    r"""Enables or disables running the CUDA nodes of backward on pooled
+    streams.
+
+    By default, the backward of each op runs on the stream its forward ran
+    on, so the backward of independent branches that ran on one stream, e.g.,
+    of the towers of a multi-task head or of separate losses, runs one kernel
+    after the other. When enabled, each CUDA node of backward runs on a
+    stream from the pool of its device, synchronized with the streams of its
+    inputs and joined back to its own stream when it is done, so that the
+    kernels of the nodes that are ready at the same time overlap.
+
+    This costs two CUDA events per node, which only pays off when the
+    kernels of the nodes are too small to fill the GPU.
+
+    Args:
+        enabled (bool): whether to run the nodes on pooled streams.
+    """
+    torch.autograd._set_backward_multi_stream(enabled)
+
+
+def is_backward_multi_stream_enabled() -> bool:
+    r"""Returns whether the CUDA nodes of backward run on pooled streams, see
+    :func:`set_backward_multi_stream`."""
+    return torch.autograd._is_backward_multi_stream_enabled()
+
+
 def variable(*args, **kwargs):
     warnings.warn("torch.autograd.variable(...) is deprecated, use torch.tensor(...) instead")
     return torch.tensor(*args, **kwargs)
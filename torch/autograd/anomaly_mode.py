@@ -1,7 +1,10 @@
+import functools
 import torch
 import warnings
 
-from typing import Any
+from typing import Any, Callable, TypeVar
+
+T = TypeVar('T')
 
 class detect_anomaly(object):
     r"""Context-manager that enable anomaly detection for the autograd engine.
@@ -16,6 +19,18 @@ class detect_anomaly(object):
         This mode should be enabled only for debugging as the different tests
         will slow down your program execution.
 
+    With ``check_nan_only=True``, only the second check is done, and once per
+    backward rather than after every backward function: the outputs of the
+    functions are reduced on their device, without synchronizing with it,
+    and backward raises at its end if any of them held a "nan" or an
+    infinity, without telling which function returned them. This is cheap
+    enough to be left on outside of debugging; :func:`detect_nan_with_rerun`
+    then runs the failing step again in the full mode to find the function.
+
+    Arguments:
+        check_nan_only (bool, optional): Only checks that backward computes
+            finite values, at its end. Default: ``False``
+
     Example:
 
         >>> import torch
@@ -67,17 +82,24 @@ class detect_anomaly(object):
 
     """
 
-    def __init__(self) -> None:
+    def __init__(self, check_nan_only: bool = False) -> None:
+        self.check_nan_only = check_nan_only
         self.prev = torch.is_anomaly_enabled()
-        warnings.warn('Anomaly Detection has been enabled. '
-                      'This mode will increase the runtime '
-                      'and should only be enabled for debugging.', stacklevel=2)
+        self.prev_nan_check = torch.is_anomaly_nan_check_enabled()
+        if not check_nan_only:
+            warnings.warn('Anomaly Detection has been enabled. '
+                          'This mode will increase the runtime '
+                          'and should only be enabled for debugging.', stacklevel=2)
 
     def __enter__(self) -> None:
-        torch.set_anomaly_enabled(True)
+        if self.check_nan_only:
+            torch.set_anomaly_nan_check_enabled(True)
+        else:
+            torch.set_anomaly_enabled(True)
 
     def __exit__(self, *args: Any) -> None:
         torch.set_anomaly_enabled(self.prev)
+        torch.set_anomaly_nan_check_enabled(self.prev_nan_check)
 
 
 class set_detect_anomaly(object):
@@ -92,15 +114,68 @@ class set_detect_anomaly(object):
     Arguments:
         mode (bool): Flag whether to enable anomaly detection (``True``),
                      or disable (``False``).
+        check_nan_only (bool, optional): Whether ``mode`` applies to the
+            lightweight check of ``detect_anomaly(check_nan_only=True)``
+            rather than the full mode. Default: ``False``
 
     """
 
-    def __init__(self, mode: bool) -> None:
-        self.prev = torch.is_anomaly_enabled()
-        torch.set_anomaly_enabled(mode)
+    def __init__(self, mode: bool, check_nan_only: bool = False) -> None:
+        self.check_nan_only = check_nan_only
+        if check_nan_only:
+            self.prev = torch.is_anomaly_nan_check_enabled()
+            torch.set_anomaly_nan_check_enabled(mode)
+        else:
+            self.prev = torch.is_anomaly_enabled()
+            torch.set_anomaly_enabled(mode)
 
     def __enter__(self) -> None:
         pass
 
     def __exit__(self, *args: Any) -> None:
-        torch.set_anomaly_enabled(self.prev)
+        if self.check_nan_only:
+            torch.set_anomaly_nan_check_enabled(self.prev)
+        else:
+            torch.set_anomaly_enabled(self.prev)
+
+
+def detect_nan_with_rerun(step: Callable[..., T]) -> Callable[..., T]:
+    r"""Decorator that runs a step, e.g. of training, under
+    ``detect_anomaly(check_nan_only=True)``, and runs it again under the full
+    :class:`detect_anomaly` if its backward computed non-finite values. The
+    second run then raises the error of the full mode, which tells which
+    backward function returned them and prints the traceback of the forward
+    operation that created it.
+
+    The step must compute the same thing when it is run again: it should, for
+    instance, zero the gradients before calling backward, and not have updated
+    anything before that. If the second run doesn't find any non-finite value,
+    the error of the first one is raised.
+
+    Example:
+
+        >>> @torch.autograd.detect_nan_with_rerun
+        ... def step(inp):
+        ...     model.zero_grad()
+        ...     loss = model(inp).sum()
+        ...     loss.backward()
+        ...     return loss
+        >>> loss = step(inp)
+        >>> optimizer.step()
+    """
+    @functools.wraps(step)
+    def wrapper(*args, **kwargs):
+        try:
+            with detect_anomaly(check_nan_only=True):
+                return step(*args, **kwargs)
+        except RuntimeError as e:
+            if "Anomaly nan check" not in str(e):
+                raise
+            # the rerun is a consequence of the error, not a choice to warn about
+            with warnings.catch_warnings():
+                warnings.filterwarnings("ignore", message="Anomaly Detection has been enabled")
+                full_mode = detect_anomaly()
+            with full_mode:
+                step(*args, **kwargs)
+            raise
+    return wrapper
@@ -0,0 +1,142 @@
+import torch
+from typing import Any, Callable, Dict, Optional
+
+
+class saved_tensors_hooks(object):
+    r"""Context-manager that sets a pair of pack / unpack hooks for saved tensors.
+
+    Use this context-manager to define how the tensors saved by the
+    operations of the forward pass, for use in backward, should be stored.
+    Every tensor saved while it is active is passed to ``pack_hook`` once, and
+    the autograd graph keeps what ``pack_hook`` returns in place of the tensor.
+    When backward needs the tensor, ``unpack_hook`` is called on that object
+    and must return a tensor with the same content as the one that was packed.
+
+    If ``prefetch_hook`` is given, the engine calls it on the packed object
+    right before it runs the nodes that feed the node that saved it, giving the
+    hooks a chance to start bringing the data back ahead of ``unpack_hook``.
+    It may be called several times, or not at all.
+
+    The hooks apply to the tensors saved on the current thread. Nesting the
+    context-manager replaces the outer hooks by the inner ones until it exits.
+
+    Args:
+        pack_hook (Callable): ``pack_hook(tensor: Tensor) -> Any``
+        unpack_hook (Callable): ``unpack_hook(packed: Any) -> Tensor``
+        prefetch_hook (Callable, optional): ``prefetch_hook(packed: Any) -> None``
+
+    Example::
+
+        >>> def pack_hook(x):
+        ...     return x.to("cpu")
+        >>>
+        >>> def unpack_hook(x):
+        ...     return x.to("cuda")
+        >>>
+        >>> a = torch.ones(5, requires_grad=True, device="cuda")
+        >>> with torch.autograd.graph.saved_tensors_hooks(pack_hook, unpack_hook):
+        ...     y = a * a
+        >>> y.sum().backward()
+
+    .. warning ::
+        Modifying the tensor passed to ``pack_hook`` in place, or returning a
+        tensor of a different content from ``unpack_hook``, silently
+        corrupts the gradients.
+    """
+    def __init__(self, pack_hook: Callable[[torch.Tensor], Any],
+                 unpack_hook: Callable[[Any], torch.Tensor],
+                 prefetch_hook: Optional[Callable[[Any], None]] = None):
+        self.pack_hook = pack_hook
+        self.unpack_hook = unpack_hook
+        self.prefetch_hook = prefetch_hook
+
+    def __enter__(self):
+        torch.autograd._push_saved_tensors_default_hooks(
+            self.pack_hook, self.unpack_hook, self.prefetch_hook)
+
+    def __exit__(self, *args: Any):
+        torch.autograd._pop_saved_tensors_default_hooks()
+
+
+class save_on_cpu(saved_tensors_hooks):
+    r"""Context-manager under which the CUDA tensors saved for backward are
+    kept in host memory.
+
+    Every CUDA tensor saved while it is active is copied to the CPU, on a side
+    stream of its device so that the copy overlaps with the rest of the
+    forward pass, and its device memory is released as soon as the copy is
+    done. The engine prefetches the copy back to the device, on the same side
+    stream, before the node that needs it runs; backward then only waits for
+    that copy to finish. Tensors that are already on the CPU are saved as
+    they are.
+
+    This trades device memory for host-device bandwidth: it lets a model
+    whose activations do not fit on the device train with its usual batch
+    size.
+
+    Args:
+        pin_memory (bool): If ``True``, the host copies are in pinned memory,
+            which makes both copies asynchronous. Default: ``True``.
+
+    Example::
+
+        >>> a = torch.randn(5, requires_grad=True, device="cuda")
+        >>> with torch.autograd.graph.save_on_cpu():
+        ...     y = (a * a).exp()
+        >>> y.sum().backward()
+    """
+    def __init__(self, pin_memory: bool = True):
+        side_streams: Dict[torch.device, torch.cuda.Stream] = {}
+
+        def side_stream(device):
+            if device not in side_streams:
+                side_streams[device] = torch.cuda.Stream(device)
+            return side_streams[device]
+
+        def pack_to_cpu(tensor):
+            if not tensor.is_cuda:
+                return (tensor.device, tensor, None)
+            stream = side_stream(tensor.device)
+            # The side stream must not read the tensor before the current
+            # stream is done writing it, and the caching allocator must not
+            # hand its memory out again before the side stream is done
+            # reading it.
+            stream.wait_stream(torch.cuda.current_stream(tensor.device))
+            tensor.record_stream(stream)
+            with torch.cuda.stream(stream):
+                packed = torch.empty(
+                    tensor.size(),
+                    dtype=tensor.dtype,
+                    layout=tensor.layout,
+                    pin_memory=pin_memory)
+                packed.copy_(tensor, non_blocking=pin_memory)
+            # The host copy is only complete once the side stream reached
+            # this point, which prefetch and unpack wait for.
+            event = stream.record_event()
+            return [tensor.device, packed, event]
+
+        def prefetch_to_device(packed):
+            device, tensor, event = packed
+            if event is None or tensor.is_cuda:
+                return
+            stream = side_stream(device)
+            with torch.cuda.stream(stream):
+                stream.wait_event(event)
+                tensor = tensor.to(device, non_blocking=pin_memory)
+                packed[1] = tensor
+                packed[2] = stream.record_event()
+
+        def unpack_from_cpu(packed):
+            device, tensor, event = packed
+            if event is None:
+                return tensor
+            if not tensor.is_cuda:
+                # Not prefetched: copy it back on the current stream.
+                torch.cuda.current_stream(device).wait_event(event)
+                return tensor.to(device, non_blocking=pin_memory)
+            current = torch.cuda.current_stream(device)
+            current.wait_event(event)
+            tensor.record_stream(current)
+            return tensor
+
+        super(save_on_cpu, self).__init__(pack_to_cpu, unpack_from_cpu, prefetch_to_device)
@@ -1,4 +1,5 @@
 import itertools
+import threading
 import torch
 
 from collections import defaultdict, namedtuple
@@ -25,10 +26,14 @@ class EventList(list):
     def __init__(self, *args, **kwargs):
         use_cuda = kwargs.pop('use_cuda', True)
         profile_memory = kwargs.pop('profile_memory', False)
+        with_flops = kwargs.pop('with_flops', False)
+        with_perf_counters = kwargs.pop('with_perf_counters', False)
         super(EventList, self).__init__(*args, **kwargs)
         self._cpu_children_populated = False
         self._use_cuda = use_cuda
         self._profile_memory = profile_memory
+        self._with_flops = with_flops
+        self._with_perf_counters = with_perf_counters
 
     def __str__(self):
         return self.table()
@@ -113,7 +118,10 @@ class EventList(list):
                 they are printed in the same order as they were registered.
                 Valid keys include: ``cpu_time``, ``cuda_time``, ``cpu_time_total``,
                 ``cuda_time_total``, ``cpu_memory_usage``, ``cuda_memory_usage``,
-                ``self_cpu_memory_usage``, ``self_cuda_memory_usage``, ``count``.
+                ``self_cpu_memory_usage``, ``self_cuda_memory_usage``,
+                ``peak_cpu_memory_usage``, ``peak_cuda_memory_usage``, ``flops``,
+                ``bytes_moved``, ``tflops``, ``gbps``, ``cycles``, ``instructions``,
+                ``ipc``, ``llc_misses``, ``branch_misses``, ``count``.
 
         Returns:
             A string containing the table.
@@ -124,7 +132,9 @@ class EventList(list):
             row_limit=row_limit,
             header=header,
             use_cuda=self._use_cuda,
-            profile_memory=self._profile_memory)
+            profile_memory=self._profile_memory,
+            with_flops=self._with_flops,
+            with_perf_counters=self._with_perf_counters)
 
     def export_chrome_trace(self, path):
         """Exports an EventList as a Chrome tracing tools file.
@@ -171,6 +181,8 @@ class EventList(list):
                             '"cat": "cpu_to_cuda", '
                             '"args": {}}, ' % (evt.name, evt.cpu_interval.start,
                                                evt.thread, next_id))
+                    # a row per stream when it is known, per device otherwise
+                    tid = k.device if k.stream < 0 else '"device %s stream %s"' % (k.device, k.stream)
                     f.write('{"name": "%s", '
                             '"ph": "f", '
                             '"ts": %s, '
@@ -178,7 +190,7 @@ class EventList(list):
                             '"pid": "CUDA functions", '
                             '"id": %s, '
                             '"cat": "cpu_to_cuda", '
-                            '"args": {}}, ' % (k.name, k.interval.start, k.device, next_id))
+                            '"args": {}}, ' % (k.name, k.interval.start, tid, next_id))
                     f.write('{"name": "%s", '
                             '"ph": "X", '
                             '"ts": %s, '
@@ -186,14 +198,97 @@ class EventList(list):
                             '"tid": %s, '
                             '"pid": "CUDA functions", '
                             '"args": {}}, ' % (k.name, k.interval.start,
-                                               k.interval.elapsed_us(), k.device))
+                                               k.interval.elapsed_us(), tid))
                     next_id += 1
 
+            # the memory allocated on each device over time, as counters
+            for device, timeline in self._memory_timelines().items():
+                for time, allocated in timeline:
+                    f.write('{"name": "Memory (%s)", '
+                            '"ph": "C", '
+                            '"ts": %s, '
+                            '"pid": "Memory", '
+                            '"args": {"bytes": %s}}, ' % (device, time, allocated))
+
             # remove trailing whitespace and comma
             f.seek(f.tell() - 2, os.SEEK_SET)
             f.truncate()
             f.write("]")
 
+    def memory_allocations(self):
+        """Returns the allocations made while profiling memory, in the order
+        they were made, as ``MemoryAllocation`` tuples of ``ptr``, ``size``,
+        ``device``, ``alloc_time`` and ``free_time`` (``None`` if it was still
+        alive when profiling stopped), ``thread`` and ``scope``, the names of
+        the ranges the allocation was made in, outermost first. With
+        ``record_modules=True``, the scope includes the modules whose forward
+        made the allocation.
+
+        Allocations made outside of any range aren't attributed to any event
+        and thus aren't returned.
+        """
+        allocations = [alloc for evt in self if isinstance(evt, FunctionEvent)
+                       for alloc in evt.memory_allocations]
+        return sorted(allocations, key=attrgetter('alloc_time'))
+
+    def memory_timeline(self, device='cpu'):
+        """Returns the memory allocated on ``device`` by the allocations of
+        :meth:`memory_allocations`, as a list of ``(time, bytes)`` pairs, in
+        us since the profiler start, one for every allocation and free.
+        """
+        return self._memory_timelines().get(torch.device(device), [])
+
+    def _memory_timelines(self):
+        changes = defaultdict(list)
+        for alloc in self.memory_allocations():
+            changes[alloc.device].append((alloc.alloc_time, alloc.size))
+            if alloc.free_time is not None:
+                changes[alloc.device].append((alloc.free_time, -alloc.size))
+        timelines = {}
+        for device, device_changes in changes.items():
+            allocated = 0
+            timeline = []
+            for time, size in sorted(device_changes, key=lambda change: change[0]):
+                allocated += size
+                timeline.append((time, allocated))
+            timelines[device] = timeline
+        return timelines
+
+    def communication_overlap(self):
+        """Returns how much of the time the GPUs spent in collectives was
+        hidden behind computation, as a ``CommunicationOverlap`` of the
+        ``communication_time``, the time in us during which a collective ran
+        on a device, and the ``exposed_communication_time``, the part of it
+        during which no other kernel ran on that device. Divide them by the
+        number of iterations profiled for their time per step.
+
+        The collectives are the NCCL kernels traced with CUPTI, or the
+        ``nccl:*`` ranges of ``ProcessGroupNCCL`` when profiling with
+        ``use_cuda=True``, which are timed on the stream they run on. The
+        computation is every other kernel, and the ranges without children
+        timed with ``use_cuda=True``: those with children span the time
+        their stream waited for the collectives.
+        """
+        self.populate_cpu_children()
+        communication = defaultdict(list)
+        computation = defaultdict(list)
+        for evt in self:
+            for k in evt.kernels:
+                interval = (k.interval.start, k.interval.end)
+                if k.name.startswith("nccl"):
+                    communication[k.device].append(interval)
+                elif k.name != evt.name or not evt.cpu_children:
+                    computation[k.device].append(interval)
+        total = 0
+        exposed = 0
+        for device, intervals in communication.items():
+            intervals = _merge_intervals(intervals)
+            busy = sum(end - start for start, end in intervals)
+            total += busy
+            exposed += busy - _intersection(
+                intervals, _merge_intervals(computation[device]))
+        return CommunicationOverlap(total, exposed)
+
     def key_averages(self, group_by_input_shapes=False):
         """Averages all function events over their keys.
 
@@ -216,7 +311,9 @@ class EventList(list):
         for evt in self:
             stats[get_key(evt, group_by_input_shapes)].add(
                 evt, group_by_input_shapes)
-        return EventList(stats.values(), use_cuda=self._use_cuda, profile_memory=self._profile_memory)
+        return EventList(
+            stats.values(), use_cuda=self._use_cuda, profile_memory=self._profile_memory,
+            with_flops=self._with_flops, with_perf_counters=self._with_perf_counters)
 
     def total_average(self):
         """Averages all events.
@@ -247,6 +344,21 @@ class profile(object):
             Adds approximately 4us of overhead to each tensor operation.
             Default: ``False``
 
+        use_cupti (bool, optional): Enables tracing of the kernels, memcpys and memsets
+            the GPUs actually run, using the CUPTI activity API, instead of timing
+            every operation with cudaEvents. Each of them is attributed to the
+            innermost operation that launched it and its timeline is included in
+            the chrome trace. Only one profiler can use CUPTI at a time, and
+            PyTorch must have been built with it (see
+            ``torch.autograd._cupti_available()``). Default: ``False``
+
+        sample_every (int, optional): Records only one in every ``sample_every``
+            operations of each thread. The operations that aren't recorded cost
+            close to nothing, which allows to keep the profiler on over long
+            runs, e.g. in production. Nested operations are sampled
+            independently, so the children of a recorded operation may be
+            missing. Default: ``1``
+
         record_shapes (bool, optional): If shapes recording is set, information
             about input dimensions will be collected. This allows one to see which
             dimensions have been used under the hood and further group by them
@@ -258,7 +370,29 @@ class profile(object):
             self cpu time might be artificially increased because of the shape
             collection.
 
-        profile_memory (bool, optional): Whether to report memory usage, default: ``False``
+        with_flops (bool, optional): Estimates the floating point operations and the
+            bytes moved of the matrix multiplications, 2d convolutions and common
+            elementwise operations from their inputs, and reports the achieved
+            TFLOPS and GB/s of each, over their CUDA time if they have any, or else
+            their CPU time. Default: ``False``
+
+        with_perf_counters (bool, optional): Reads the hardware performance counters
+            of the thread (cycles, instructions, last level cache misses and branch
+            misses) at the start and the end of every range, and reports what each
+            range executed, its children included, along with the instructions per
+            cycle. Linux only, it needs access to the PMU, which
+            ``kernel.perf_event_paranoid`` above 2 or running in a virtual machine
+            may deny; the counters are then not reported (see
+            ``torch.autograd._perf_counters_available()``). Default: ``False``
+
+        profile_memory (bool, optional): Whether to report memory usage, default: ``False``.
+            Every allocation is attributed to the innermost range it was made in,
+            see :meth:`EventList.memory_allocations` and
+            :meth:`EventList.memory_timeline`.
+
+        record_modules (bool, optional): Wraps the forward of every ``nn.Module`` in a
+            range named after its class, which attributes the time and memory of
+            the operations to the module hierarchy that ran them. Default: ``False``
 
     .. warning:
         Enabling memory profiling incurs additional profiler overhead
@@ -297,15 +431,28 @@ class profile(object):
             enabled=True,
             use_cuda=False,
             record_shapes=False,
-            profile_memory=False):
+            profile_memory=False,
+            use_cupti=False,
+            sample_every=1,
+            record_modules=False,
+            with_flops=False,
+            with_perf_counters=False):
         self.enabled = enabled
         self.use_cuda = use_cuda
+        self.use_cupti = use_cupti
+        if sample_every < 1:
+            raise ValueError("sample_every must be at least 1, got {}".format(sample_every))
+        self.sample_every = sample_every
         self.function_events = None
         if not self.enabled:
             return
         self.entered = False
         self.record_shapes = record_shapes
         self.profile_memory = profile_memory
+        self.record_modules = record_modules
+        self.with_flops = with_flops
+        self.with_perf_counters = with_perf_counters
+        self._module_hooks = []
 
     def __enter__(self):
         if not self.enabled:
@@ -313,21 +460,56 @@ class profile(object):
         if self.entered:
             raise RuntimeError("autograd profiler traces are not reentrant")
         self.entered = True
-        profiler_kind = torch.autograd.ProfilerState.CUDA if self.use_cuda \
-            else torch.autograd.ProfilerState.CPU
-
-        config = torch.autograd.ProfilerConfig(profiler_kind, self.record_shapes, self.profile_memory)
+        if self.use_cupti:
+            profiler_kind = torch.autograd.ProfilerState.CUPTI
+        elif self.use_cuda:
+            profiler_kind = torch.autograd.ProfilerState.CUDA
+        else:
+            profiler_kind = torch.autograd.ProfilerState.CPU
+
+        config = torch.autograd.ProfilerConfig(
+            profiler_kind, self.record_shapes, self.profile_memory, self.sample_every,
+            self.with_flops, self.with_perf_counters)
         torch.autograd._enable_profiler(config)
+        if self.record_modules:
+            self._register_module_hooks()
         return self
 
+    def _register_module_hooks(self):
+        # the ranges of the modules being run, per thread
+        local = threading.local()
+
+        def pre_hook(module, input):
+            if not hasattr(local, 'handles'):
+                local.handles = []
+            local.handles.append(torch.ops.profiler._record_function_enter(
+                "nn.Module: " + type(module).__name__))
+
+        def hook(module, input, output):
+            # the forward may have raised after the pre hook ran, in which case
+            # the range is never closed and the profiler drops it
+            if getattr(local, 'handles', None):
+                torch.ops.profiler._record_function_exit(local.handles.pop())
+
+        from torch.nn.modules.module import register_module_forward_pre_hook, register_module_forward_hook
+        self._module_hooks = [
+            register_module_forward_pre_hook(pre_hook),
+            register_module_forward_hook(hook),
+        ]
+
     def __exit__(self, exc_type, exc_val, exc_tb):
         if not self.enabled:
             return
+        for handle in self._module_hooks:
+            handle.remove()
+        self._module_hooks = []
         records = torch.autograd._disable_profiler()
         self.function_events = EventList(
             parse_cpu_trace(records),
-            use_cuda=self.use_cuda,
-            profile_memory=self.profile_memory)
+            use_cuda=self.use_cuda or self.use_cupti,
+            profile_memory=self.profile_memory,
+            with_flops=self.with_flops,
+            with_perf_counters=self.with_perf_counters)
         return False
 
     def __repr__(self):
@@ -367,6 +549,11 @@ class profile(object):
         return self.function_events.total_average()
     total_average.__doc__ = EventList.total_average.__doc__
 
+    def communication_overlap(self):
+        self._check_finish()
+        return self.function_events.communication_overlap()
+    communication_overlap.__doc__ = EventList.communication_overlap.__doc__
+
     @property
     def self_cpu_time_total(self):
         """ Returns total time spent on CPU obtained as a sum of
@@ -630,6 +817,22 @@ class FormattedTimesMixin(object):
     def cuda_time(self):
         return 0.0 if self.count == 0 else 1.0 * self.cuda_time_total / self.count
 
+    # The achieved throughputs are over the time of the kernels if there are
+    # any, which is what the work took on the GPU, and the CPU time otherwise.
+    @property
+    def tflops(self):
+        time_us = self.cuda_time_total or self.cpu_time_total
+        return 0.0 if time_us == 0 else self.flops / time_us / 1e6
+
+    @property
+    def gbps(self):
+        time_us = self.cuda_time_total or self.cpu_time_total
+        return 0.0 if time_us == 0 else self.bytes_moved / time_us / 1e3
+
+    @property
+    def ipc(self):
+        return 0.0 if self.cycles == 0 else 1.0 * self.instructions / self.cycles
+
 
 class Interval(object):
     def __init__(self, start, end):
@@ -640,7 +843,50 @@ class Interval(object):
         return self.end - self.start
 
 
-Kernel = namedtuple('Kernel', ['name', 'device', 'interval'])
+# ``stream`` is the id of the stream the kernel ran on, -1 if unknown. The
+# kernels traced with CUPTI have the ids CUPTI gives the streams, the others
+# those of torch.cuda.Stream.
+Kernel = namedtuple('Kernel', ['name', 'device', 'interval', 'stream'])
+
+CommunicationOverlap = namedtuple(
+    'CommunicationOverlap', ['communication_time', 'exposed_communication_time'])
+
+
+def _merge_intervals(intervals):
+    """Returns the union of (start, end) intervals, as sorted disjoint ones."""
+    merged = []
+    for start, end in sorted(intervals):
+        if merged and start <= merged[-1][1]:
+            merged[-1][1] = max(merged[-1][1], end)
+        else:
+            merged.append([start, end])
+    return merged
+
+
+def _intersection(a, b):
+    """Returns the length of the intersection of two unions of intervals, as
+    merged by _merge_intervals."""
+    total = 0
+    i = j = 0
+    while i < len(a) and j < len(b):
+        start = max(a[i][0], b[j][0])
+        end = min(a[i][1], b[j][1])
+        if end > start:
+            total += end - start
+        if a[i][1] < b[j][1]:
+            i += 1
+        else:
+            j += 1
+    return total
+
+# An allocation made while profiling memory: ``ptr``, ``size`` in bytes,
+# ``device`` (a torch.device), ``alloc_time`` and ``free_time`` (None if it was
+# still alive when profiling stopped) in us since the profiler start,
+# ``thread``, and ``scope``, the names of the ranges that were open on the
+# thread when it was made, the innermost one last.
+MemoryAllocation = namedtuple(
+    'MemoryAllocation',
+    ['ptr', 'size', 'device', 'alloc_time', 'free_time', 'thread', 'scope'])
 
 
 class FunctionEvent(FormattedTimesMixin):
@@ -648,7 +894,7 @@ class FunctionEvent(FormattedTimesMixin):
     def __init__(
             self, id, node_id, name, thread, cpu_start, cpu_end, input_shapes=None,
             cpu_memory_usage=0, cuda_memory_usage=0, is_async=False, is_remote=True,
-            sequence_nr=-1):
+            sequence_nr=-1, flops=0, bytes_moved=0, perf_counters=None):
         self.id = id
         self.node_id = node_id
         self.name = name
@@ -660,12 +906,23 @@ class FunctionEvent(FormattedTimesMixin):
         self.input_shapes = input_shapes
         self.cpu_memory_usage = cpu_memory_usage
         self.cuda_memory_usage = cuda_memory_usage
+        # highest net memory allocated since the start of the range, children included
+        self.peak_cpu_memory_usage = 0
+        self.peak_cuda_memory_usage = 0
+        # allocations made directly in this range, not in its children
+        self.memory_allocations = []
         self.is_async = is_async
         self.is_remote = is_remote
         self.sequence_nr = sequence_nr
+        # estimated work of the operator, 0 if unknown
+        self.flops = flops
+        self.bytes_moved = bytes_moved
+        # hardware counters over the range, children included, 0 if not read
+        self.cycles, self.instructions, self.llc_misses, self.branch_misses = \
+            perf_counters or (0, 0, 0, 0)
 
-    def append_kernel(self, name, device, start, end):
-        self.kernels.append(Kernel(name, device, Interval(start, end)))
+    def append_kernel(self, name, device, start, end, stream=-1):
+        self.kernels.append(Kernel(name, device, Interval(start, end), stream))
 
     def append_cpu_child(self, child):
         """Append a CPU child of type FunctionEvent.
@@ -754,6 +1011,14 @@ class FunctionEventAvg(FormattedTimesMixin):
         self.cuda_memory_usage = 0
         self.self_cpu_memory_usage = 0
         self.self_cuda_memory_usage = 0
+        self.peak_cpu_memory_usage = 0
+        self.peak_cuda_memory_usage = 0
+        self.flops = 0
+        self.bytes_moved = 0
+        self.cycles = 0
+        self.instructions = 0
+        self.llc_misses = 0
+        self.branch_misses = 0
 
     def add(self, other, group_by_input_shapes=False):
         if self.key is None:
@@ -779,6 +1044,14 @@ class FunctionEventAvg(FormattedTimesMixin):
         self.cuda_memory_usage += other.cuda_memory_usage
         self.self_cpu_memory_usage += other.self_cpu_memory_usage
         self.self_cuda_memory_usage += other.self_cuda_memory_usage
+        self.peak_cpu_memory_usage = max(self.peak_cpu_memory_usage, other.peak_cpu_memory_usage)
+        self.peak_cuda_memory_usage = max(self.peak_cuda_memory_usage, other.peak_cuda_memory_usage)
+        self.flops += other.flops
+        self.bytes_moved += other.bytes_moved
+        self.cycles += other.cycles
+        self.instructions += other.instructions
+        self.llc_misses += other.llc_misses
+        self.branch_misses += other.branch_misses
         self.count += other.count
         return self
 
@@ -827,6 +1100,8 @@ def parse_cpu_trace(thread_records):
     next_id = 0
     start_record = None
     cuda_records = {}
+    # device activities traced with CUPTI, per key of the range that launched them
+    device_activities = defaultdict(list)
     functions = []
     record_stack = []
     string_table = StringTable()
@@ -861,13 +1136,33 @@ def parse_cpu_trace(thread_records):
             # key for cuda_records is (node_id, device) in case of multiple nodes
             # having the same device
             cuda_records[(record.node_id(), record.device())] = record
+        elif record.kind() == 'device_activity':
+            device_activities[get_record_key(record)].append(record)
 
     assert start_record is not None and not start_record.is_remote()
 
+    # match the allocations with their frees, which may happen on other threads
+    free_times = {}
+    live_allocations = {}
+    memory_records = sorted(
+        (record for record in itertools.chain(*thread_records) if record.kind() == 'memory_alloc'),
+        key=lambda record: start_record.cpu_elapsed_us(record))
+    for record in memory_records:
+        key = (record.memory_ptr(), record.device())
+        if record.cpu_memory_usage() > 0 or record.cuda_memory_usage() > 0:
+            live_allocations[key] = record
+        elif key in live_allocations:
+            free_times[id(live_allocations.pop(key))] = start_record.cpu_elapsed_us(record)
+
     for thread_record_list in thread_records:
         # accumulated memory allocations per handle
         cpu_memory_allocs = {}
         cuda_memory_allocs = {}
+        # peak accumulated memory allocations per handle
+        cpu_memory_peaks = {}
+        cuda_memory_peaks = {}
+        # allocations made directly in the range, per handle
+        range_allocations = {}
         # ranges per handle
         range_starts = {}
 
@@ -891,11 +1186,18 @@ def parse_cpu_trace(thread_records):
                     )
                     if duplicate:
                         filtered_handles.add(record_key)
+                        # the activities of the redispatch belong to the wrapper
+                        if record_key in device_activities:
+                            device_activities[get_record_key(prev_record)].extend(
+                                device_activities.pop(record_key))
                         continue
 
                 range_starts[record_key] = record
                 cpu_memory_allocs[record_key] = 0
                 cuda_memory_allocs[record_key] = 0
+                cpu_memory_peaks[record_key] = 0
+                cuda_memory_peaks[record_key] = 0
+                range_allocations[record_key] = []
             elif record.kind() == 'pop':
                 assert (
                     record_key in range_starts
@@ -910,6 +1212,10 @@ def parse_cpu_trace(thread_records):
                 cuda_memory_usage = cuda_memory_allocs[record_key]
                 is_async = start.thread_id() != record.thread_id()
                 is_remote_event = record.is_remote()
+                perf_counters = None
+                if not is_async and start.perf_counters() and record.perf_counters():
+                    perf_counters = [
+                        end - begin for begin, end in zip(start.perf_counters(), record.perf_counters())]
 
                 fe = FunctionEvent(
                     id=record.handle(),
@@ -924,7 +1230,13 @@ def parse_cpu_trace(thread_records):
                     is_async=is_async,
                     is_remote=is_remote_event,
                     sequence_nr=start.sequence_nr(),
+                    flops=start.flops(),
+                    bytes_moved=start.bytes_moved(),
+                    perf_counters=perf_counters,
                 )
+                fe.peak_cpu_memory_usage = cpu_memory_peaks[record_key]
+                fe.peak_cuda_memory_usage = cuda_memory_peaks[record_key]
+                fe.memory_allocations = range_allocations[record_key]
                 # note: async events have only cpu total time
                 if not is_async and start.has_cuda():
                     cuda_start = adjusted_time(start, cuda_records)
@@ -934,16 +1246,45 @@ def parse_cpu_trace(thread_records):
                             start.name(),
                             start.device(),
                             cuda_start,
-                            cuda_end)
+                            cuda_end,
+                            start.stream())
+                for activity in device_activities.get(record_key, []):
+                    activity_start = start_record.cpu_elapsed_us(activity)
+                    fe.append_kernel(
+                        activity.name(),
+                        activity.device(),
+                        activity_start,
+                        activity_start + activity.device_elapsed_us(),
+                        activity.stream())
                 functions.append(fe)
                 del range_starts[record_key]
                 del cpu_memory_allocs[record_key]
                 del cuda_memory_allocs[record_key]
+                del cpu_memory_peaks[record_key]
+                del cuda_memory_peaks[record_key]
+                del range_allocations[record_key]
             elif record.kind() == 'memory_alloc':
                 for handle in cpu_memory_allocs.keys():
                     cpu_memory_allocs[handle] += record.cpu_memory_usage()
+                    cpu_memory_peaks[handle] = max(cpu_memory_peaks[handle], cpu_memory_allocs[handle])
                 for handle in cuda_memory_allocs.keys():
                     cuda_memory_allocs[handle] += record.cuda_memory_usage()
+                    cuda_memory_peaks[handle] = max(cuda_memory_peaks[handle], cuda_memory_allocs[handle])
+                # the ranges are open in the order they were started in, the
+                # allocation belongs to the innermost one
+                size = record.cpu_memory_usage() or record.cuda_memory_usage()
+                if size > 0 and range_starts:
+                    innermost = next(reversed(list(range_starts.keys())))
+                    range_allocations[innermost].append(MemoryAllocation(
+                        ptr=record.memory_ptr(),
+                        size=size,
+                        device=(torch.device('cuda', record.device()) if record.cuda_memory_usage() != 0
+                                else torch.device('cpu')),
+                        alloc_time=start_record.cpu_elapsed_us(record),
+                        free_time=free_times.get(id(record)),
+                        thread=record.thread_id(),
+                        scope=tuple(string_table[open_start.name()] for open_start in range_starts.values()),
+                    ))
             prev_record = record
 
     # Sort functions by start time then by end time ascending.
@@ -1043,7 +1384,9 @@ def build_table(
         header=None,
         row_limit=100,
         use_cuda=True,
-        profile_memory=False):
+        profile_memory=False,
+        with_flops=False,
+        with_perf_counters=False):
     """Prints a summary of events (which can be a list of FunctionEvent or FunctionEventAvg)."""
     if len(events) == 0:
         return ""
@@ -1051,7 +1394,8 @@ def build_table(
     if sort_by is not None:
         events = EventList(sorted(
             events, key=lambda evt: getattr(evt, sort_by), reverse=True
-        ), use_cuda=use_cuda, profile_memory=profile_memory)
+        ), use_cuda=use_cuda, profile_memory=profile_memory, with_flops=with_flops,
+            with_perf_counters=with_perf_counters)
 
     has_input_shapes = any(
         [event.input_shapes is not None for event in events])
@@ -1077,12 +1421,27 @@ def build_table(
         headers.extend([
             'CPU Mem',
             'Self CPU Mem',
+            'CPU Peak Mem',
         ])
         if torch.cuda.is_available():
             headers.extend([
                 'CUDA Mem',
                 'Self CUDA Mem',
+                'CUDA Peak Mem',
             ])
+    if with_flops:
+        headers.extend([
+            'TFLOPS',
+            'GB/s',
+        ])
+    if with_perf_counters:
+        headers.extend([
+            'Cycles',
+            'Instructions',
+            'IPC',
+            'LLC misses',
+            'Branch misses',
+        ])
     headers.append(
         'Number of Calls'
     )
@@ -1159,6 +1518,8 @@ def build_table(
                 format_memory(evt.cpu_memory_usage),
                 # Self CPU Mem Total
                 format_memory(evt.self_cpu_memory_usage),
+                # CPU Peak Mem
+                format_memory(evt.peak_cpu_memory_usage),
             ])
             if torch.cuda.is_available():
                 row_values.extend([
@@ -1166,7 +1527,24 @@ def build_table(
                     format_memory(evt.cuda_memory_usage),
                     # Self CUDA Mem Total
                     format_memory(evt.self_cuda_memory_usage),
+                    # CUDA Peak Mem
+                    format_memory(evt.peak_cuda_memory_usage),
                 ])
+        if with_flops:
+            row_values.extend([
+                # left empty for the operators of unknown cost
+                '{:.3f}'.format(evt.tflops) if evt.flops > 0 else '',
+                '{:.3f}'.format(evt.gbps) if evt.bytes_moved > 0 else '',
+            ])
+        if with_perf_counters:
+            # left empty for the ranges the counters weren't read for
+            row_values.extend([
+                evt.cycles or '',
+                evt.instructions or '',
+                '{:.2f}'.format(evt.ipc) if evt.cycles > 0 else '',
+                evt.llc_misses if evt.cycles > 0 else '',
+                evt.branch_misses if evt.cycles > 0 else '',
+            ])
         row_values.append(
             evt.count,  # Number of calls
         )
@@ -29,8 +29,8 @@ class cuFFTPlanCacheAttrContextProp(object):
 class cuFFTPlanCache(object):
     r"""
     Represents a specific plan cache for a specific `device_index`. The
-    attributes `size` and `max_size`, and method `clear`, can fetch and/ or
-    change properties of the C++ cuFFT plan cache.
+    attributes `size`, `max_size`, `hits` and `misses`, and method `clear`,
+    can fetch and/ or change properties of the C++ cuFFT plan cache.
     """
     def __init__(self, device_index):
         self.device_index = device_index
@@ -43,6 +43,16 @@ class cuFFTPlanCache(object):
     max_size = cuFFTPlanCacheAttrContextProp(torch._cufft_get_plan_cache_max_size,
                                              torch._cufft_set_plan_cache_max_size)
 
+    hits = cuFFTPlanCacheAttrContextProp(
+        torch._cufft_get_plan_cache_hits,
+        '.hits is a read-only property counting the plan lookups that found their '
+        'plan in the cache since it was last cleared.')
+
+    misses = cuFFTPlanCacheAttrContextProp(
+        torch._cufft_get_plan_cache_misses,
+        '.misses is a read-only property counting the plan lookups that had to '
+        'create their plan since the cache was last cleared.')
+
     def clear(self):
         return torch._cufft_clear_plan_cache(self.device_index)
 
@@ -93,5 +103,22 @@ class cuBLASModule:
         return torch._C._set_cublas_allow_tf32(value)
 
 
+class RNNModule:
+    r"""
+    ``torch.backends.cuda.rnn.persistent = True`` makes the LSTM and GRU
+    layers that do not use cuDNN run all the steps of a layer in a single
+    persistent kernel, which keeps the recurrent weights in shared memory when
+    they fit. It is only used when nothing requires grad.
+    """
+    def __getattr__(self, name):
+        assert name == "persistent", "Unknown attribute " + name
+        return torch._C._get_persistent_rnn()
+
+    def __setattr__(self, name, value):
+        assert name == "persistent", "Unknown attribute " + name
+        return torch._C._set_persistent_rnn(value)
+
+
 cufft_plan_cache = cuFFTPlanCacheManager()
 matmul = cuBLASModule()
+rnn = RNNModule()
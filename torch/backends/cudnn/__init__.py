@@ -105,6 +105,26 @@ def flags(enabled=False, benchmark=False, deterministic=False):
             set_flags(orig_flags[0], orig_flags[1], orig_flags[2])
 
 
+def save_benchmark_cache(path):
+    r"""Saves the convolution algorithms that cuDNN picked so far, e.g. when
+    ``torch.backends.cudnn.benchmark`` is ``True``, to the file at ``path``.
+
+    :func:`load_benchmark_cache` restores them in another process, which then
+    skips benchmarking the shapes it finds there. The algorithms are only kept
+    for the GPU model of the current device and the cuDNN version in use.
+    """
+    torch._cudnn_save_conv_benchmark_cache(path)
+
+
+def load_benchmark_cache(path):
+    r"""Loads the convolution algorithms saved by :func:`save_benchmark_cache`
+    at ``path``, which replace those picked for the same shapes, and returns
+    their number. A file saved for another GPU model or cuDNN version is
+    ignored with a warning, returning 0.
+    """
+    return torch._cudnn_load_conv_benchmark_cache(path)
+
+
 # The magic here is to allow us to intercept code like this:
 #
 #   torch.backends.<cudnn|mkldnn>.enabled = True
@@ -0,0 +1,6 @@
+r"""
+This package contains the CPU counterparts of the features of :mod:`torch.cuda`
+that aren't specific to CUDA, such as autocasting.
+"""
+
+from . import amp  # noqa: F401
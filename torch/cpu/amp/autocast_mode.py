@@ -0,0 +1,54 @@
+import torch
+import functools
+
+
+class autocast(object):
+    r"""
+    Instances of :class:`autocast` serve as context managers or decorators that
+    allow regions of your script to run in mixed precision on the CPU.
+
+    In these regions, convolutions and matrix multiplications (``conv1d``, ``conv2d``,
+    ``conv3d``, ``addmm``, ``mm``, ``linear``) of CPU Tensors run in ``torch.bfloat16``,
+    and the ops that need the precision of ``torch.float32`` (reductions, losses, norms,
+    ``exp``, ``log``, ...) cast their ``torch.bfloat16`` inputs back to ``torch.float32``.
+    ``torch.bfloat16`` has the range of ``torch.float32``, so gradients don't need to be scaled.
+
+    CPU autocasting is independent of :class:`torch.cuda.amp.autocast`: CUDA Tensors aren't
+    affected by it, and both can be enabled at once.  Like CUDA autocasting, it caches
+    the casts of the model's weights within the region, and is thread-local.
+
+    Example::
+
+        model = Net()
+        with torch.cpu.amp.autocast():
+            output = model(input)
+            loss = loss_fn(output, target)
+        loss.backward()
+
+    Arguments:
+        enabled(bool, optional, default=True):  Whether CPU autocasting should be enabled in the region.
+        persistent_cache(bool, optional, default=False):  Whether to keep the cached casts of the weights
+            when the region exits, see :class:`torch.cuda.amp.autocast`.
+    """
+    def __init__(self, enabled=True, persistent_cache=False):
+        self._enabled = enabled
+        self._persistent_cache = persistent_cache
+
+    def __enter__(self):
+        self.prev = torch.is_autocast_cpu_enabled()
+        torch.set_autocast_cpu_enabled(self._enabled)
+        torch.autocast_increment_nesting()
+
+    def __exit__(self, *args):
+        # Drop the cache when we exit to a nesting level that's outside any instance of autocast.
+        if torch.autocast_decrement_nesting() == 0 and not self._persistent_cache:
+            torch.clear_autocast_cache()
+        torch.set_autocast_cpu_enabled(self.prev)
+        return False
+
+    def __call__(self, func):
+        @functools.wraps(func)
+        def decorate_autocast(*args, **kwargs):
+            with self:
+                return func(*args, **kwargs)
+        return decorate_autocast
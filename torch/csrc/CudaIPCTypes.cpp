@@ -1,9 +1,11 @@
 #ifdef USE_CUDA
 #include <torch/csrc/CudaIPCTypes.h>
 #include <TH/THAllocator.h>
+#include <algorithm>
 #include <map>
 #include <mutex>
 #include <random>
+#include <unordered_map>
 
 #ifdef _MSC_VER
 #include <windows.h>
@@ -25,12 +27,22 @@ void warnProducerTerminatedBeforeSharedTensorsReleased() {
   }
 }
 
+struct CudaIPCEvent {
+  cudaEvent_t event_;
+  cudaIpcEventHandle_t ipc_handle_;
+};
+
 struct CudaIPCGlobalEntities {
   std::mutex ref_counters_mutex_;
   std::atomic<int64_t> sync_events_used_;
   std::map<std::string, std::shared_ptr<CudaIPCRefCountersFile>>
       ref_counters_files_;
   std::shared_ptr<CudaIPCRefCountersFile> next_available_ref_counters_file_;
+  // The interprocess events of the blocks the consumers are done with, by
+  // device. Creating an event and getting its handle costs more than sharing
+  // the block itself, so the events are recycled rather than destroyed.
+  std::mutex events_mutex_;
+  std::unordered_map<c10::DeviceIndex, std::vector<CudaIPCEvent>> free_events_;
   CudaIPCSentDataLimbo CudaIPCSentDataLimbo_;
   CudaIPCGlobalEntities() : ref_counters_files_() {}
   ~CudaIPCGlobalEntities() {
@@ -39,7 +51,43 @@ struct CudaIPCGlobalEntities {
     if (next_available_ref_counters_file_) {
       warnProducerTerminatedBeforeSharedTensorsReleased();
     }
+#ifndef __HIP_PLATFORM_HCC__
+    // Best effort, the CUDA runtime may already be shut down.
+    for (auto& device_events : free_events_) {
+      for (auto& event : device_events.second) {
+        cudaEventDestroy(event.event_);
+      }
+    }
+#endif
+  }
+#ifndef __HIP_PLATFORM_HCC__
+  // Takes an event of the pool of `device`, or creates one unless
+  // CUDA_IPC_MAXIMUM_EVENTS_TO_USE events exist already.
+  bool take_event(c10::DeviceIndex device, CudaIPCEvent* event) {
+    std::lock_guard<std::mutex> lock(events_mutex_);
+    auto& events = free_events_[device];
+    if (!events.empty()) {
+      *event = events.back();
+      events.pop_back();
+      return true;
+    }
+    if (sync_events_used_.load() >= CUDA_IPC_MAXIMUM_EVENTS_TO_USE) {
+      return false;
+    }
+    at::cuda::CUDAGuard device_guard(device);
+    C10_CUDA_CHECK(cudaEventCreateWithFlags(
+        &event->event_,
+        cudaEventDisableTiming | cudaEventInterprocess |
+            cudaEventBlockingSync));
+    C10_CUDA_CHECK(cudaIpcGetEventHandle(&event->ipc_handle_, event->event_));
+    sync_events_used_++;
+    return true;
+  }
+  void return_event(c10::DeviceIndex device, const CudaIPCEvent& event) {
+    std::lock_guard<std::mutex> lock(events_mutex_);
+    free_events_[device].push_back(event);
   }
+#endif
   void safe_clean_current_file() {
     std::lock_guard<std::mutex> lock(ref_counters_mutex_);
     if (next_available_ref_counters_file_ &&
@@ -64,7 +112,7 @@ bool CudaIPCSentDataLimbo::collect() {
   std::vector<std::unique_ptr<CudaIPCSentData>> reset_blocks;
   { // Begin critical section to modify shared blocks
     std::lock_guard<std::mutex> lock(limbo_mutex_);
-    std::vector<std::unique_ptr<CudaIPCSentData>> kept_blocks;
+    std::deque<std::unique_ptr<CudaIPCSentData>> kept_blocks;
     for (auto& sd : shared_blocks_) {
       if (sd->counter_value() > 0) {
         kept_blocks.push_back(std::move(sd));
@@ -82,6 +130,22 @@ bool CudaIPCSentDataLimbo::collect() {
   return freed_memory;
 }
 
+bool CudaIPCSentDataLimbo::collect_front() {
+  std::vector<std::unique_ptr<CudaIPCSentData>> reset_blocks;
+  {
+    std::lock_guard<std::mutex> lock(limbo_mutex_);
+    while (!shared_blocks_.empty() &&
+           shared_blocks_.front()->counter_value() <= 0) {
+      reset_blocks.push_back(std::move(shared_blocks_.front()));
+      shared_blocks_.pop_front();
+    }
+  }
+  for (auto& sd : reset_blocks) {
+    sd.reset();
+  }
+  return !reset_blocks.empty();
+}
+
 void CudaIPCSentDataLimbo::add(std::unique_ptr<CudaIPCSentData> shared_block) {
   std::lock_guard<std::mutex> lock(limbo_mutex_);
   static bool warned = false;
@@ -103,16 +167,19 @@ void CudaIPCSentDataDelete(void* ptr) {
   if (sent_data->counter_value() > 0) {
     cuda_ipc_global_entities.CudaIPCSentDataLimbo_.add(std::move(sent_data));
   }
-  cuda_ipc_global_entities.CudaIPCSentDataLimbo_.collect();
+  // The full traversal is left to CudaIPCCollect, i.e., to the caching
+  // allocator running out of memory and to explicit torch.cuda.ipc_collect().
+  cuda_ipc_global_entities.CudaIPCSentDataLimbo_.collect_front();
 }
 
-void ReturnRefCounter(const std::string& handle, uint64_t offset /* unused */) {
+void ReturnRefCounter(const std::string& handle, uint64_t offset) {
   std::lock_guard<std::mutex> lock(
       cuda_ipc_global_entities.ref_counters_mutex_);
-  cuda_ipc_global_entities.ref_counters_files_[handle]->return_offset(offset);
-  if (cuda_ipc_global_entities.ref_counters_files_[handle]->offsets_in_use() ==
-          0 &&
-      !cuda_ipc_global_entities.ref_counters_files_[handle]->have_offsets()) {
+  auto& file = cuda_ipc_global_entities.ref_counters_files_[handle];
+  file->return_offset(offset);
+  // The current file is only released by safe_clean_current_file().
+  if (file->offsets_in_use() == 0 &&
+      file != cuda_ipc_global_entities.next_available_ref_counters_file_) {
     cuda_ipc_global_entities.ref_counters_files_.erase(handle);
   }
 }
@@ -141,16 +208,16 @@ CudaIPCSentData::CudaIPCSentData(
   //  [i.record() for i in a]
   //  ```
   //
-  if (cuda_ipc_global_entities.sync_events_used_.load() < CUDA_IPC_MAXIMUM_EVENTS_TO_USE) {
-    // TODO: More efficient would be to create event inside of main thread (at
-    // the moment of the queue.put). The reason this is more efficient is
+  // The event of a block is only recycled once its consumers released the
+  // block, long after they waited on it.
+  CudaIPCEvent event;
+  if (cuda_ipc_global_entities.take_event(device.index(), &event)) {
+    // TODO: More efficient would be to record the event inside of main thread
+    // (at the moment of the queue.put). The reason this is more efficient is
     // because the main thread may have queued extra work on the stream, which
     // this event will consequently wait for (uselessly).
-    cuda_ipc_global_entities.sync_events_used_ ++;
-    C10_CUDA_CHECK(cudaEventCreateWithFlags(
-        &event_,
-        cudaEventDisableTiming | cudaEventInterprocess |
-            cudaEventBlockingSync));
+    event_ = event.event_;
+    ipc_event_handle_ = event.ipc_handle_;
     C10_CUDA_CHECK(cudaEventRecord(
         event_, c10::cuda::getCurrentCUDAStream(device.index())));
     event_sync_required_ = true;
@@ -173,9 +240,8 @@ CudaIPCSentData::~CudaIPCSentData() {
 #ifndef __HIP_PLATFORM_HCC__
   try {
     if (event_sync_required_) {
-      at::cuda::CUDAGuard device_guard(device_.index());
-      cudaEventDestroy(event_);
-      cuda_ipc_global_entities.sync_events_used_ --;
+      cuda_ipc_global_entities.return_event(
+          device_.index(), CudaIPCEvent{event_, ipc_event_handle_});
     }
   } catch (...) { /* No throw */
   }
@@ -187,7 +253,12 @@ int64_t CudaIPCSentData::counter_value() {
 }
 
 at::DataPtr GetNewRefCountedSentData(void* data, at::Device device) {
+  std::string counter_handle;
+  int64_t counter_offset;
+  int64_t* counter_ptr;
   {
+    // Held while taking a counter too, since ReturnRefCounter hands counters
+    // back to the current file.
     std::lock_guard<std::mutex> lock(
         cuda_ipc_global_entities.ref_counters_mutex_);
     if (!cuda_ipc_global_entities.next_available_ref_counters_file_) {
@@ -212,19 +283,18 @@ at::DataPtr GetNewRefCountedSentData(void* data, at::Device device) {
       cuda_ipc_global_entities.ref_counters_files_[ref_counter_handle] = rc;
       cuda_ipc_global_entities.next_available_ref_counters_file_ = rc;
     }
+    auto& file = cuda_ipc_global_entities.next_available_ref_counters_file_;
+    file->set_counter(1);
+    counter_handle = file->handle();
+    counter_offset = file->get_offset();
+    counter_ptr = file->counter_ptr();
+    file->rotate_offset();
+    if (!file->have_offsets()) {
+      file.reset();
+    }
   }
-  cuda_ipc_global_entities.next_available_ref_counters_file_->set_counter(1);
   auto sent_data = new CudaIPCSentData(
-      cuda_ipc_global_entities.next_available_ref_counters_file_->handle(),
-      cuda_ipc_global_entities.next_available_ref_counters_file_->get_offset(),
-      cuda_ipc_global_entities.next_available_ref_counters_file_->counter_ptr(),
-      device);
-
-  cuda_ipc_global_entities.next_available_ref_counters_file_->rotate_offset();
-  if (!cuda_ipc_global_entities.next_available_ref_counters_file_
-           ->have_offsets()) {
-    cuda_ipc_global_entities.next_available_ref_counters_file_.reset();
-  }
+      counter_handle, counter_offset, counter_ptr, device);
   return at::DataPtr(data, sent_data, CudaIPCSentDataDelete, device);
 }
 
@@ -236,6 +306,66 @@ bool CudaIPCCollect() {
   return freed_memory;
 }
 
+cudaEvent_t CudaIPCOpenEvent(const std::string& handle) {
+  static std::mutex mutex;
+  static std::unordered_map<std::string, cudaEvent_t> events;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = events.find(handle);
+  if (it != events.end()) {
+    return it->second;
+  }
+  // Every producer uses at most CUDA_IPC_MAXIMUM_EVENTS_TO_USE events, drop
+  // the events of the producers that went away now and then. Destroying an
+  // event doesn't affect the streams already waiting on it.
+  if (events.size() >= 4 * CUDA_IPC_MAXIMUM_EVENTS_TO_USE) {
+    for (auto& entry : events) {
+      cudaEventDestroy(entry.second);
+    }
+    events.clear();
+  }
+  cudaEvent_t event;
+  C10_CUDA_CHECK(cudaIpcOpenEventHandle(
+      &event, *reinterpret_cast<const cudaIpcEventHandle_t*>(handle.c_str())));
+  events.emplace(handle, event);
+  return event;
+}
+
+void CudaIPCReleaseRefCounter(const std::string& handle, int64_t offset) {
+  static std::mutex mutex;
+  // The most recently used files at the back.
+  static std::deque<std::pair<std::string, at::DataPtr>> files;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = std::find_if(files.begin(), files.end(), [&](const std::pair<std::string, at::DataPtr>& file) {
+    return file.first == handle;
+  });
+  if (it == files.end()) {
+    // We don't want to break existing code, so resource deletion is best
+    // effort basis. Exception expected if producer process terminated
+    // before consumer released data.
+    int flags =
+        TH_ALLOCATOR_MAPPED_SHAREDMEM | TH_ALLOCATOR_MAPPED_NOCREATE;
+    try {
+      auto sptr = THRefcountedMapAllocator::makeDataPtr(
+          handle.c_str(),
+          flags,
+          sizeof(int64_t) * CUDA_IPC_REF_COUNTER_FILE_SIZE,
+          nullptr);
+      if (files.size() >= CUDA_IPC_MAPPED_REF_COUNTER_FILES) {
+        files.pop_front();
+      }
+      files.emplace_back(handle, std::move(sptr));
+    } catch (c10::Error& err) {
+      // Already warned inside of producer process
+      return;
+    }
+  } else if (it + 1 != files.end()) {
+    auto file = std::move(*it);
+    files.erase(it);
+    files.push_back(std::move(file));
+  }
+  *(static_cast<int64_t*>(files.back().second.get()) + offset) -= 1;
+}
+
 } // namespace torch
 
 namespace c10 {
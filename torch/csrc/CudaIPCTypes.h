@@ -8,11 +8,21 @@
 #include <c10/util/Logging.h>
 #include <cuda_runtime_api.h>
 #include <cstddef>
+#include <deque>
+#include <vector>
 
 namespace torch {
 
 bool CudaIPCCollect();
 
+// Consumer side: the event of the producer behind an IPC event handle, opened
+// once per handle, as the producer recycles its events.
+cudaEvent_t CudaIPCOpenEvent(const std::string& handle);
+
+// Consumer side: decrements a reference counter of the producer, keeping the
+// counter files of the last producers mapped.
+void CudaIPCReleaseRefCounter(const std::string& handle, int64_t offset);
+
 struct CudaIPCReceivedData final {
   explicit CudaIPCReceivedData(std::shared_ptr<void> shared_ptr)
       : shared_ptr_(std::move(shared_ptr)) {}
@@ -24,7 +34,8 @@ struct CudaIPCSentData final {
   int64_t offset_;
   int64_t* counter_ptr_; // Reference counter shared memory block
   at::DataPtr original_ptr_; // Original mem allocation
-  cudaEvent_t event_; // Sync cuEventDestroy
+  cudaEvent_t event_; // Taken from the event pool, returned on destruction
+  cudaIpcEventHandle_t ipc_event_handle_;
   bool event_sync_required_;
   at::Device device_;
 
@@ -59,19 +70,26 @@ constexpr int64_t CUDA_IPC_WARN_AFTER_X_BLOCKS_IN_LIMBO = 1000;
 // tensors effectively.
 constexpr int64_t CUDA_IPC_MAXIMUM_EVENTS_TO_USE = 1000;
 
-// All to be deleted data blocks with non zero reference counter goes there
+// The number of reference counter files of producers a consumer keeps mapped.
+constexpr size_t CUDA_IPC_MAPPED_REF_COUNTER_FILES = 16;
+
+// All to be deleted data blocks with non zero reference counter goes there,
+// in the order they were deleted.
 struct CudaIPCSentDataLimbo final {
   ~CudaIPCSentDataLimbo();
+  // Frees all the blocks the consumers are done with.
   bool collect();
+  // Frees the blocks at the front of the limbo the consumers are done with.
+  // Consumers mostly release shared tensors in the order they got them, so
+  // this frees most of the blocks without traversing the others.
+  bool collect_front();
   void add(std::unique_ptr<CudaIPCSentData> shared_block);
   uint64_t size() {
     return shared_blocks_.size();
   }
 
  private:
-  // TODO: Can be changed to FIFO in order to avoid full traverse on every
-  // collect()
-  std::vector<std::unique_ptr<CudaIPCSentData>> shared_blocks_;
+  std::deque<std::unique_ptr<CudaIPCSentData>> shared_blocks_;
   std::mutex limbo_mutex_;
 };
 
@@ -87,7 +105,7 @@ struct CudaIPCRefCountersFile final {
         refcounted_shared_mem_(std::move(data_ptr)) {}
 
   int64_t* counter_ptr() {
-    return static_cast<int64_t*>(refcounted_shared_mem_.get()) + next_offset_;
+    return static_cast<int64_t*>(refcounted_shared_mem_.get()) + get_offset();
   }
 
   void set_counter(uint64_t value) {
@@ -95,24 +113,31 @@ struct CudaIPCRefCountersFile final {
   }
 
   bool have_offsets() {
-    return next_offset_ < size_;
+    return !free_offsets_.empty() || next_offset_ < size_;
   }
 
   bool offsets_in_use() {
     return used_slots_;
   }
 
+  // The counters the consumers released are handed out again first, so a
+  // producer keeps using the same file, which its consumers keep mapped.
   int64_t get_offset() {
-    return next_offset_;
+    return free_offsets_.empty() ? next_offset_ : free_offsets_.back();
   }
 
   void rotate_offset() {
-    next_offset_++;
+    if (free_offsets_.empty()) {
+      next_offset_++;
+    } else {
+      free_offsets_.pop_back();
+    }
     used_slots_++;
   }
 
-  void return_offset(uint64_t offset /* unused */) {
+  void return_offset(uint64_t offset) {
     used_slots_--;
+    free_offsets_.push_back(offset);
   }
 
   std::string handle() {
@@ -123,6 +148,7 @@ struct CudaIPCRefCountersFile final {
   uint64_t next_offset_;
   uint64_t size_;
   uint64_t used_slots_;
+  std::vector<uint64_t> free_offsets_;
   std::string handle_;
   at::DataPtr refcounted_shared_mem_;
 };
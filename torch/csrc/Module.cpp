@@ -9,14 +9,17 @@
 #include <cstdlib>
 #include <libshm.h>
 #include <TH/TH.h>
+#include <c10/core/thread_budget.h>
 #include <c10/util/Logging.h>
 #include <ATen/ATen.h>
+#include <ATen/BatchedFallback.h>
 #include <ATen/ExpandUtils.h>
 #include <ATen/dlpack.h>
 #include <ATen/DLConvertor.h>
 #include <ATen/Parallel.h>
 #include <ATen/Utils.h>
 #include <ATen/VmapMode.h>
+#include <ATen/native/TensorIterator.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
@@ -45,6 +48,7 @@
 #include <torch/csrc/utils/tensor_qschemes.h>
 #include <torch/csrc/utils/tensor_numpy.h>
 #include <torch/csrc/utils/python_dispatch.h>
+#include <torch/csrc/utils/python_metrics.h>
 #include <torch/csrc/jit/python/python_tracer.h>
 #include <torch/csrc/jit/python/init.h>
 #include <torch/csrc/jit/python/python_ir.h>
@@ -195,6 +199,34 @@ static PyObject * THPModule_setNumInteropThreads(PyObject *module, PyObject *arg
   Py_RETURN_NONE;
 }
 
+static PyObject * THPModule_getThreadBudget(PyObject *module, PyObject *noargs)
+{
+  return PyLong_FromSize_t(c10::ThreadBudget::global().cap());
+}
+
+static PyObject * THPModule_setThreadBudget(PyObject *module, PyObject *arg)
+{
+  THPUtils_assert(THPUtils_checkLong(arg), "set_thread_budget expects an int, "
+          "but got %s", THPUtils_typename(arg));
+  int64_t cap = THPUtils_unpackLong(arg);
+  THPUtils_assert(cap >= 0, "set_thread_budget expects a non-negative integer");
+  c10::ThreadBudget::global().setCap(cap);
+  Py_RETURN_NONE;
+}
+
+static PyObject * THPModule_threadBudgetUsage(PyObject *module, PyObject *noargs)
+{
+  HANDLE_TH_ERRORS
+  auto& budget = c10::ThreadBudget::global();
+  py::dict usage;
+  for (int kind = 0; kind < static_cast<int>(c10::ThreadPoolKind::NumKinds); ++kind) {
+    auto pool_kind = static_cast<c10::ThreadPoolKind>(kind);
+    usage[c10::toString(pool_kind)] = budget.numThreads(pool_kind);
+  }
+  return usage.release().ptr();
+  END_HANDLE_TH_ERRORS
+}
+
 PyObject * THPModule_setDefaultTensorType(PyObject *_unused, PyObject *type)
 {
   HANDLE_TH_ERRORS
@@ -573,6 +605,9 @@ static PyMethodDef TorchMethods[] = {
   {"set_num_threads", (PyCFunction)THPModule_setNumThreads,     METH_O,       nullptr},
   {"get_num_interop_threads", (PyCFunction)THPModule_getNumInteropThreads,     METH_NOARGS,  nullptr},
   {"set_num_interop_threads", (PyCFunction)THPModule_setNumInteropThreads,     METH_O,       nullptr},
+  {"get_thread_budget", (PyCFunction)THPModule_getThreadBudget,     METH_NOARGS,  nullptr},
+  {"set_thread_budget", (PyCFunction)THPModule_setThreadBudget,     METH_O,       nullptr},
+  {"_thread_budget_usage", (PyCFunction)THPModule_threadBudgetUsage, METH_NOARGS, nullptr},
   {"_get_cudnn_enabled", (PyCFunction)THPModule_userEnabledCuDNN, METH_NOARGS,     nullptr},
   {"_set_cudnn_enabled", (PyCFunction)THPModule_setUserEnabledCuDNN, METH_O,  nullptr},
   {"_get_mkldnn_enabled", (PyCFunction)THPModule_userEnabledMkldnn, METH_NOARGS,     nullptr},
@@ -616,6 +651,7 @@ bool THCPComplexFloatStorage_init(PyObject *module);
 
 void THCPStream_init(PyObject *module);
 void THCPEvent_init(PyObject *module);
+void THCPGraph_init(PyObject *module);
 
 #ifdef USE_CUDA
 PyMethodDef* THCPModule_methods();
@@ -710,6 +746,7 @@ PyObject* initModule() {
   torch::jit::initJITBindings(module);
   torch::impl::dispatch::initDispatchBindings(module);
   torch::throughput_benchmark::initThroughputBenchmarkBindings(module);
+  torch::metrics::initMetricsBindings(module);
   torch::autograd::initNNFunctions(module);
   torch::autograd::initFFTFunctions(module);
   torch::autograd::initLinalgFunctions(module);
@@ -754,6 +791,7 @@ PyObject* initModule() {
 
   THCPStream_init(module);
   THCPEvent_init(module);
+  THCPGraph_init(module);
 #endif
 
   auto set_module_attr = [&](const char* name, PyObject* v, bool incref = true) {
@@ -789,6 +827,47 @@ PyObject* initModule() {
   py_module.def("_demangle", &c10::demangle);
   py_module.def("_log_api_usage_once", &LogAPIUsageOnceFromPython);
 
+  py_module.def("_get_tensoriterator_plan_cache_enabled", []() {
+    return at::globalContext().tensorIteratorPlanCache();
+  });
+  py_module.def("_set_tensoriterator_plan_cache_enabled", [](bool enabled) {
+    at::globalContext().setTensorIteratorPlanCache(enabled);
+  });
+  py_module.def("_tensoriterator_plan_cache_stats", []() {
+    auto stats = at::get_tensor_iterator_plan_cache_stats();
+    std::unordered_map<std::string, int64_t> result;
+    result["hits"] = stats.hits;
+    result["misses"] = stats.misses;
+    result["uncacheable"] = stats.uncacheable;
+    return result;
+  });
+  py_module.def("_reset_tensoriterator_plan_cache", &at::reset_tensor_iterator_plan_cache);
+
+  py_module.def("_get_grain_size_autotune", []() {
+    return at::globalContext().grainSizeAutotune();
+  });
+  py_module.def("_set_grain_size_autotune", [](bool enabled) {
+    at::globalContext().setGrainSizeAutotune(enabled);
+  });
+  py_module.def("_tuned_grain_sizes", []() {
+    std::vector<std::tuple<std::string, std::string, int64_t, int64_t>> result;
+    for (const auto& tuned : at::get_tuned_grain_sizes()) {
+      result.emplace_back(tuned.name, c10::toString(tuned.dtype), tuned.log2_numel, tuned.grain_size);
+    }
+    return result;
+  });
+  py_module.def("_clear_tuned_grain_sizes", &at::clear_tuned_grain_sizes);
+
+  py_module.def("_vmap_fallback_counts", &at::getVmapFallbackCounts);
+  py_module.def("_reset_vmap_fallback_counts", &at::resetVmapFallbackCounts);
+
+  py_module.def("_get_persistent_rnn", []() {
+    return at::globalContext().persistentRNN();
+  });
+  py_module.def("_set_persistent_rnn", [](bool enabled) {
+    at::globalContext().setPersistentRNN(enabled);
+  });
+
   py_module.def(
     "init_num_threads",
     torch::wrap_pybind_function(at::init_num_threads),
@@ -2,6 +2,7 @@
 
 #include <torch/data/dataloader_options.h>
 #include <torch/data/detail/data_shuttle.h>
+#include <torch/data/detail/device_transfer.h>
 #include <torch/data/detail/sequencers.h>
 #include <torch/data/iterator.h>
 #include <torch/data/samplers/random.h>
@@ -37,7 +38,14 @@ class DataLoaderBase {
       std::unique_ptr<Dataset> main_thread_dataset = nullptr)
       : options_(std::move(options)),
         main_thread_dataset_(std::move(main_thread_dataset)),
-        sequencer_(new_sequencer()) {}
+        // The jobs in flight, and the messages that stop the workers.
+        shuttle_(options_.max_jobs + options_.workers),
+        sequencer_(new_sequencer()) {
+    if (options_.device) {
+      device_transfer_ = torch::make_unique<detail::DeviceTransfer<Batch>>(
+          *options_.device, options_.device_prefetch);
+    }
+  }
 
   virtual ~DataLoaderBase() {
     join();
@@ -136,6 +144,9 @@ class DataLoaderBase {
   /// Resets the internal state of the DataLoader, optionally pre-fetching
   /// new jobs.
   virtual void reset() {
+    if (device_transfer_) {
+      device_transfer_->clear();
+    }
     shuttle_.drain();
     sequence_number_ = 0;
     sequencer_ = new_sequencer();
@@ -163,6 +174,24 @@ class DataLoaderBase {
   /// is exhausted. This operation will block until a batch is available if one
   /// is still expected.
   optional<BatchType> next() {
+    if (!device_transfer_) {
+      return next_host_batch();
+    }
+    while (!device_transfer_->full()) {
+      auto batch = next_host_batch();
+      if (!batch) {
+        break;
+      }
+      device_transfer_->push(std::move(*batch));
+    }
+    if (device_transfer_->empty()) {
+      return nullopt;
+    }
+    return device_transfer_->pop();
+  }
+
+  /// Returns the next batch of data before it is moved to `options_.device`.
+  optional<BatchType> next_host_batch() {
     if (options_.workers > 0) {
       while (optional<Result> result = this->pop_result()) {
         if (result->exception) {
@@ -173,11 +202,22 @@ class DataLoaderBase {
         }
       }
     } else if (auto batch_request = get_batch_request()) {
-      return this->main_thread_dataset_->get_batch(std::move(*batch_request));
+      return fetch_batch(*main_thread_dataset_, std::move(*batch_request));
     }
     return nullopt;
   }
 
+  /// Gets a batch from `dataset`, in pinned memory if `options_.pin_memory`.
+  optional<BatchType> fetch_batch(
+      Dataset& dataset,
+      BatchRequestType&& batch_request) {
+    optional<BatchType> batch = dataset.get_batch(std::move(batch_request));
+    if (batch && options_.pin_memory) {
+      batch = detail::pin_memory(std::move(*batch));
+    }
+    return batch;
+  }
+
   /// The function that worker threads run.
   void worker_thread(Dataset& dataset) {
     while (true) {
@@ -186,7 +226,7 @@ class DataLoaderBase {
         break;
       }
       try {
-        auto batch = dataset.get_batch(std::move(*job.batch_request));
+        auto batch = fetch_batch(dataset, std::move(*job.batch_request));
         shuttle_.push_result({std::move(batch), job.sequence_number});
       } catch (...) {
         shuttle_.push_result({std::current_exception(), job.sequence_number});
@@ -241,6 +281,9 @@ class DataLoaderBase {
 
   /// True if the DataLoader has joined its worker threads.
   bool joined_ = false;
+
+  /// Moves the batches to `options_.device`, if one was configured.
+  std::unique_ptr<detail::DeviceTransfer<Batch>> device_transfer_;
 };
 } // namespace data
 } // namespace torch
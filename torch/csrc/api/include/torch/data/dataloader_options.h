@@ -37,6 +37,19 @@ struct DataLoaderOptions {
   /// Whether to omit the last batch if it contains less than `batch_size`
   /// examples.
   TORCH_ARG(bool, drop_last) = false;
+
+  /// Whether to copy the batches into page-locked (pinned) memory, from which
+  /// they are copied to CUDA devices asynchronously. The worker threads pin
+  /// the batches they fetch.
+  TORCH_ARG(bool, pin_memory) = false;
+
+  /// The device to move the batches to before handing them out, if any. The
+  /// batches are copied on a stream of their own, and the current stream waits
+  /// for the copy of a batch when it is handed out.
+  TORCH_ARG(optional<Device>, device);
+
+  /// The number of batches copied to `device` ahead of the one handed out.
+  TORCH_ARG(size_t, device_prefetch) = 2;
 };
 
 /// Like `DataLoaderOptions`, but without any unconfigured state.
@@ -52,7 +65,10 @@ struct FullDataLoaderOptions {
         max_jobs(options.max_jobs().value_or(2 * workers)),
         timeout(options.timeout()),
         enforce_ordering(options.enforce_ordering()),
-        drop_last(options.drop_last()) {}
+        drop_last(options.drop_last()),
+        pin_memory(options.pin_memory()),
+        device(options.device()),
+        device_prefetch(options.device_prefetch()) {}
 
   size_t batch_size;
   size_t workers;
@@ -60,6 +76,9 @@ struct FullDataLoaderOptions {
   optional<std::chrono::milliseconds> timeout;
   bool enforce_ordering;
   bool drop_last;
+  bool pin_memory;
+  optional<Device> device;
+  size_t device_prefetch;
 };
 } // namespace data
 } // namespace torch
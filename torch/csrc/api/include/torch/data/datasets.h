@@ -4,6 +4,8 @@
 #include <torch/data/datasets/chunk.h>
 #include <torch/data/datasets/map.h>
 #include <torch/data/datasets/mnist.h>
+#include <torch/data/datasets/records.h>
 #include <torch/data/datasets/shared.h>
+#include <torch/data/datasets/slice.h>
 #include <torch/data/datasets/stateful.h>
 #include <torch/data/datasets/tensor.h>
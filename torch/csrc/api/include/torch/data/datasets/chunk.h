@@ -3,8 +3,12 @@
 #include <torch/arg.h>
 #include <torch/csrc/utils/memory.h>
 #include <torch/data/datasets/stateful.h>
+#include <torch/data/detail/queue.h>
 #include <torch/data/samplers.h>
+#include <algorithm>
+#include <limits>
 #include <queue>
+#include <random>
 #include <thread>
 
 #include <torch/serialize.h>
@@ -39,10 +43,18 @@ class ChunkDataReader {
 
 namespace detail {
 /// BatchDataBuffer manages a queue of UnwrappedBatchData. After a new chunk is
-/// loaded, BatchDataBuffer splits it into small batches and push them into the
-/// queue. When get_batch is called from data loader, it pops cached batches and
-/// return. If the cache is empty, it either waits to load more chunks or return
-/// null if all chunks are loaded.
+/// loaded, BatchDataBuffer shuffles its examples, optionally through a shuffle
+/// buffer shared by all chunks, splits them into pieces of at most a batch and
+/// pushes the pieces into the queue. When get_batch is called from data loader,
+/// it assembles a batch from the pieces at the front of the queue. If the queue
+/// holds less than a batch, it either waits to load more chunks or returns
+/// what is left if all chunks are loaded.
+///
+/// The examples of a chunk are shuffled and split before the queue is locked,
+/// which is only held to push or pop the pieces. In ordered mode the chunks
+/// enter the queue in the order given by their sequence numbers, whatever the
+/// order in which they finish loading; otherwise a chunk enters the queue as
+/// soon as it is loaded.
 template <
     typename UnwrappedBatch,
     typename ExampleSampler = samplers::RandomSampler>
@@ -55,10 +67,22 @@ class BatchDataBuffer {
   BatchDataBuffer(
       size_t batch_size,
       ExampleSampler& example_sampler,
-      size_t queue_capacity)
+      size_t queue_capacity,
+      size_t shuffle_buffer_size = 0,
+      bool ordered = false)
       : batch_size_(batch_size),
         example_sampler_(example_sampler),
-        queue_capacity_(queue_capacity) {}
+        queue_capacity_(queue_capacity),
+        shuffle_buffer_size_(shuffle_buffer_size),
+        ordered_(ordered) {
+    if (shuffle_buffer_size_ > 0) {
+      // Seeded by the torch generator, for `torch::manual_seed` to make the
+      // shuffle reproducible.
+      random_engine_.seed(static_cast<std::mt19937::result_type>(
+          torch::randint(std::numeric_limits<int32_t>::max(), {1})
+              .template item<int64_t>()));
+    }
+  }
 
   /// Return batch data from the queue. Called from the ChunkDataset main
   /// thread.
@@ -69,91 +93,72 @@ class BatchDataBuffer {
       // loaded (i.e. the dataset is exhausted for this epoch)
       return (
           this->total_example_count_in_queue_ >= batch_size_ ||
-          this->stop_);
+          this->stop_ ||
+          (!this->batch_queue_.empty() && this->batch_queue_.front().exception));
     });
     if (batch_queue_.empty()) {
       AT_ASSERT(stop_);
       // All batches have been retrieved. Return an empty batch.
       return nullopt;
     }
-
-    UnwrappedBatchData batch = std::move(batch_queue_.front());
-    batch_queue_.pop();
-    if (batch.exception) {
-      throw WorkerException(batch.exception);
+    if (batch_queue_.front().exception) {
+      auto exception = batch_queue_.front().exception;
+      batch_queue_.pop();
+      throw WorkerException(exception);
     }
 
-    total_example_count_in_queue_ -= batch.batch_data.size();
+    UnwrappedBatchType batch;
+    while (!batch_queue_.empty() && !batch_queue_.front().exception &&
+           batch.size() < batch_size_) {
+      auto& piece = batch_queue_.front().batch_data;
+      const size_t example_count =
+          std::min(batch_size_ - batch.size(), piece.size());
+      if (batch.empty() && example_count == piece.size()) {
+        // The piece is a batch, or the rest of one.
+        batch = std::move(piece);
+        batch_queue_.pop();
+        continue;
+      }
+      batch.reserve(batch_size_);
+      std::move(
+          piece.begin(),
+          piece.begin() + example_count,
+          std::back_inserter(batch));
+      piece.erase(piece.begin(), piece.begin() + example_count);
+      if (piece.empty()) {
+        batch_queue_.pop();
+      }
+    }
+    total_example_count_in_queue_ -= batch.size();
     lock.unlock();
     cv_write_.notify_all();
 
-    return batch.batch_data;
+    return batch;
   }
 
   /// Push preloaded chunks to batch queue. Called from the ChunkDataset worker
-  /// threads.
-  void add_chunk_data(UnwrappedBatchType data) {
-    std::unique_lock<std::mutex> lock(queue_mutex_);
-    cv_write_.wait(lock, [this] {
-      // stop loading if we have preloaded enough data.
-      return this->total_example_count_in_queue_ < this->queue_capacity_ ||
-          this->stop_;
-    });
-    if (stop_) {
-      // When stop_ is true, it means no further chunk loading is necessary.
-      // Return without any further processing.
+  /// threads. `sequence` is the sequence number of the chunk in ordered mode.
+  void add_chunk_data(
+      UnwrappedBatchType data,
+      optional<size_t> sequence = nullopt) {
+    UnwrappedBatchType examples = shuffle_chunk(std::move(data));
+    if (!wait_for_turn(sequence)) {
       return;
     }
-
-    auto data_size = data.size();
-    auto remaining_size = data_size;
-    example_sampler_.reset(data_size);
-
-    auto fill_batch = [&](size_t example_count, UnwrappedBatchType& batch) {
-      auto batch_example_indices = this->example_sampler_.next(example_count);
-      AT_ASSERT(
-          batch_example_indices &&
-          batch_example_indices.value().size() == example_count);
-      BatchRequestType& indices = batch_example_indices.value();
-      for (size_t i : indices) {
-        TORCH_CHECK(i < data_size, "Index out of range");
-        batch.emplace_back(std::move(data[i]));
-      }
-      remaining_size -= example_count;
-    };
-
-    if (!batch_queue_.empty()) {
-      // if the queue has existing data, and the last batch doesn't have enough
-      // examples to fill a batch_size batch, add more example to this batch first.
-      auto& batch = batch_queue_.back();
-      size_t current_count = batch.batch_data.size();
-      if (current_count < batch_size_) {
-        auto example_count =
-            std::min(remaining_size, batch_size_ - current_count);
-        fill_batch(example_count, batch.batch_data);
-      }
+    if (shuffle_buffer_size_ > 0) {
+      examples = shuffle_through_buffer(std::move(examples));
     }
-
-    // If we still have data remaining after filling the last pushed batch, add
-    // them to the queue too.
-    while (remaining_size > 0) {
-      UnwrappedBatchType current_batch;
-
-      // Allocate the batch memory ahead of time.
-      current_batch.reserve(batch_size_);
-
-      auto example_count = std::min(remaining_size, batch_size_);
-      fill_batch(example_count, current_batch);
-      batch_queue_.emplace(std::move(current_batch));
-    }
-    total_example_count_in_queue_ += data_size;
-    lock.unlock();
-    cv_read_.notify_all();
+    push_pieces(split(std::move(examples)), sequence);
   }
 
   /// Push exceptions thrown during preloading into batch queue. Called from
   /// the ChunkDataset worker threads.
-  void add_chunk_data(std::exception_ptr e_ptr) {
+  void add_chunk_data(
+      std::exception_ptr e_ptr,
+      optional<size_t> sequence = nullopt) {
+    if (!wait_for_turn(sequence)) {
+      return;
+    }
     std::unique_lock<std::mutex> lock(queue_mutex_);
     cv_write_.wait(lock, [this] {
       // stop loading if we have preloaded enough data.
@@ -169,8 +174,25 @@ class BatchDataBuffer {
     }
 
     batch_queue_.emplace(e_ptr);
+    advance_turn(sequence);
     lock.unlock();
     cv_read_.notify_all();
+    cv_write_.notify_all();
+  }
+
+  /// Pushes the examples left in the shuffle buffer into the queue, once all
+  /// the chunks of the epoch are loaded.
+  void flush() {
+    if (shuffle_buffer_size_ == 0) {
+      return;
+    }
+    UnwrappedBatchType examples;
+    {
+      std::lock_guard<std::mutex> lock(shuffle_mutex_);
+      std::swap(examples, shuffle_buffer_);
+      std::shuffle(examples.begin(), examples.end(), random_engine_);
+    }
+    push_pieces(split(std::move(examples)), nullopt);
   }
 
   void stop(){
@@ -195,6 +217,121 @@ class BatchDataBuffer {
     // notify all readers too.
     cv_read_.notify_all();
   }
+
+ private:
+  /// Returns the examples of `data` in the order of the example sampler.
+  UnwrappedBatchType shuffle_chunk(UnwrappedBatchType data) {
+    const size_t data_size = data.size();
+    UnwrappedBatchType examples;
+    if (data_size == 0) {
+      return examples;
+    }
+    BatchRequestType indices;
+    {
+      std::lock_guard<std::mutex> lock(sampler_mutex_);
+      example_sampler_.reset(data_size);
+      auto example_indices = example_sampler_.next(data_size);
+      AT_ASSERT(
+          example_indices && example_indices.value().size() == data_size);
+      indices = std::move(example_indices.value());
+    }
+    examples.reserve(data_size);
+    for (size_t i : indices) {
+      TORCH_CHECK(i < data_size, "Index out of range");
+      examples.emplace_back(std::move(data[i]));
+    }
+    return examples;
+  }
+
+  /// Exchanges every example for a random one of the shuffle buffer, once it
+  /// is full, and returns the examples taken out of it.
+  UnwrappedBatchType shuffle_through_buffer(UnwrappedBatchType examples) {
+    std::lock_guard<std::mutex> lock(shuffle_mutex_);
+    UnwrappedBatchType output;
+    output.reserve(examples.size());
+    std::uniform_int_distribution<size_t> slot(0, shuffle_buffer_size_ - 1);
+    for (auto& example : examples) {
+      if (shuffle_buffer_.size() < shuffle_buffer_size_) {
+        shuffle_buffer_.emplace_back(std::move(example));
+        continue;
+      }
+      auto& buffered = shuffle_buffer_[slot(random_engine_)];
+      output.emplace_back(std::move(buffered));
+      buffered = std::move(example);
+    }
+    return output;
+  }
+
+  /// Splits `examples` into pieces of a batch at most.
+  std::vector<UnwrappedBatchType> split(UnwrappedBatchType examples) {
+    std::vector<UnwrappedBatchType> pieces;
+    if (examples.size() <= batch_size_) {
+      if (!examples.empty()) {
+        pieces.push_back(std::move(examples));
+      }
+      return pieces;
+    }
+    for (size_t begin = 0; begin < examples.size(); begin += batch_size_) {
+      const size_t end = std::min(begin + batch_size_, examples.size());
+      UnwrappedBatchType piece;
+      piece.reserve(end - begin);
+      std::move(
+          examples.begin() + begin,
+          examples.begin() + end,
+          std::back_inserter(piece));
+      pieces.push_back(std::move(piece));
+    }
+    return pieces;
+  }
+
+  void push_pieces(
+      std::vector<UnwrappedBatchType> pieces,
+      optional<size_t> sequence) {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    cv_write_.wait(lock, [this, &pieces] {
+      // stop loading if we have preloaded enough data.
+      return pieces.empty() ||
+          this->total_example_count_in_queue_ < this->queue_capacity_ ||
+          this->stop_;
+    });
+    if (stop_) {
+      // When stop_ is true, it means no further chunk loading is necessary.
+      // Return without any further processing.
+      return;
+    }
+    for (auto& piece : pieces) {
+      total_example_count_in_queue_ += piece.size();
+      batch_queue_.emplace(std::move(piece));
+    }
+    advance_turn(sequence);
+    lock.unlock();
+    cv_read_.notify_all();
+    if (ordered_) {
+      cv_write_.notify_all();
+    }
+  }
+
+  /// In ordered mode, waits until the chunk of `sequence` is the next one to
+  /// enter the queue. Returns false if the buffer was stopped.
+  bool wait_for_turn(const optional<size_t>& sequence) {
+    if (!ordered_ || !sequence) {
+      return true;
+    }
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    cv_write_.wait(lock, [this, &sequence] {
+      return this->next_sequence_ == *sequence || this->stop_;
+    });
+    return !stop_;
+  }
+
+  /// Lets the chunk following `sequence` enter the queue. Called with the
+  /// queue locked.
+  void advance_turn(const optional<size_t>& sequence) {
+    if (ordered_ && sequence) {
+      ++next_sequence_;
+    }
+  }
+
   /// The batch size is needed to create batches from the chunk data. Similar to
   /// regular dataloader where the batches are created with prefetches,
   /// BatchDataBuffer perform the batch creation using the provided batch size.
@@ -219,7 +356,7 @@ class BatchDataBuffer {
     std::exception_ptr exception;
   };
 
-  /// local cache to store example batches from loaded chunk
+  /// local cache to store the pieces of batches from loaded chunks
   std::queue<UnwrappedBatchData> batch_queue_;
 
   // sync batch_queue_ update.
@@ -230,9 +367,25 @@ class BatchDataBuffer {
 
   ExampleSampler& example_sampler_;
 
+  // sync example_sampler_ use, which shuffles one chunk at a time.
+  std::mutex sampler_mutex_;
+
   // configurable maximun number of elements the queue can hold at one time.
   size_t queue_capacity_;
 
+  // The number of examples of the shuffle buffer, or 0 if there is none.
+  size_t shuffle_buffer_size_;
+
+  // The examples held back by the shuffle buffer, and its random engine.
+  UnwrappedBatchType shuffle_buffer_;
+  std::mt19937 random_engine_;
+  std::mutex shuffle_mutex_;
+
+  // Whether the chunks enter the queue in the order of their sequence numbers,
+  // and the sequence number of the next one.
+  bool ordered_;
+  size_t next_sequence_ = 0;
+
   // When set to true, it wakes the writer threads from the wait and exit current
   // function call. This is needed when ChunkDataSet.Reset is called while the
   // previous epoch is not exhausted yet. When ChunkDataset is waiting its
@@ -292,6 +445,25 @@ struct ChunkDatasetOptions {
   // penalty when this value is greater than 1, as we need to do extra merge
   // between multiple chunks before performing example sampling.
   TORCH_ARG(size_t, cross_chunk_shuffle_count) = 1;
+
+  // The number of examples of a shuffle buffer that all the loaded chunks go
+  // through, on top of the example sampling within each chunk. Every example
+  // entering the full buffer takes the place of a random one, which leaves it
+  // for a batch, so that the examples of a chunk are spread over the batches
+  // of the next ones without loading several chunks at once. Default to 0,
+  // meaning no shuffle buffer.
+  TORCH_ARG(size_t, shuffle_buffer_size) = 0;
+
+  // The number of threads running the preprocessing policy on the loaded
+  // chunks, e.g., to decode them, apart from the preloaders which then only
+  // read them. Default to 0, meaning the preloaders preprocess the chunks they
+  // read.
+  TORCH_ARG(size_t, decoder_count) = 0;
+
+  // Whether the chunks are batched in the order the chunk sampler picked them,
+  // rather than as soon as one is loaded. Default to false: the batches of the
+  // first chunk loaded by any preloader are returned first.
+  TORCH_ARG(bool, ordered) = false;
 };
 
 /// A stateful dataset that support hierarchical sampling and prefetching of
@@ -374,6 +546,7 @@ class ChunkDataset final
     // free workers from previous reset if there is any.
     free_workers();
     preload_threads_.clear();
+    decode_threads_.clear();
 
     if (!load_checkpoint_){
       chunk_reader_.reset();
@@ -387,12 +560,25 @@ class ChunkDataset final
         detail::BatchDataBuffer<UnwrappedBatchType, ExampleSamplerType>>(
         options_.batch_size(),
         example_sampler_,
-        options_.cache_size());
+        options_.cache_size(),
+        options_.shuffle_buffer_size(),
+        options_.ordered());
+    chunk_sequence_ = 0;
 
     // create new workers for this new epoch.
     quit_worker_ = false;
 
     AT_ASSERT(running_preloaders_ == 0);
+    AT_ASSERT(running_decoders_ == 0);
+    if (options_.decoder_count() > 0) {
+      decode_queue_ =
+          torch::make_unique<torch::data::detail::Queue<DecodeJob>>(
+              2 * options_.decoder_count());
+      running_decoders_ = options_.decoder_count();
+      for (size_t i = 0; i < options_.decoder_count(); ++i) {
+        decode_threads_.emplace_back([this]() { this->decoder(); });
+      }
+    }
     running_preloaders_ = options_.preloader_count();
     for (size_t i = 0; i < options_.preloader_count(); ++i) {
       preload_threads_.emplace_back([this, i]() { this->preloader(i); });
@@ -425,12 +611,14 @@ class ChunkDataset final
   /// running on worker thread to preload chunk data.
   void preloader(size_t id) {
     while (!quit_worker_.load()) {
+      optional<size_t> sequence;
       try {
         std::vector<size_t> chunk_idx;
         {
           std::lock_guard<std::mutex> lock(chunk_index_guard_);
           if (auto chunk_sampler_result = chunk_sampler_.next(this->options_.cross_chunk_shuffle_count())) {
             chunk_idx = chunk_sampler_result.value();
+            sequence = chunk_sequence_++;
           } else {
             break;
           }
@@ -441,22 +629,61 @@ class ChunkDataset final
           std::move(
               chunk_data.begin(), chunk_data.end(), std::back_inserter(data));
         }
-        if (preprocessing_policy_) {
-          preprocessing_policy_(data);
-        }
-        if (!data.empty()) { // skip empty chunks.
-          batch_buffer_->add_chunk_data(std::move(data));
+        if (decode_queue_) {
+          decode_queue_->push(DecodeJob{std::move(data), *sequence});
+        } else {
+          preprocess(std::move(data), sequence);
         }
       } catch (...) {
-        batch_buffer_->add_chunk_data(std::current_exception());
+        batch_buffer_->add_chunk_data(std::current_exception(), sequence);
       }
     }
     AT_ASSERT(running_preloaders_.load() > 0);
-    --running_preloaders_;
-    if (running_preloaders_.load() == 0) {
-      // all preloaders are completed, so we can notify the batch_buffer.
-      batch_buffer_->stop();
+    if (--running_preloaders_ == 0) {
+      if (decode_queue_) {
+        // Every decoder exits on reading one of these.
+        for (size_t i = 0; i < options_.decoder_count(); ++i) {
+          decode_queue_->push(DecodeJob());
+        }
+      } else {
+        finish_loading();
+      }
+    }
+  }
+
+  /// running on decoder threads to preprocess the chunks read by preloaders.
+  void decoder() {
+    while (true) {
+      auto job = decode_queue_->pop();
+      if (!job.data) {
+        break;
+      }
+      try {
+        preprocess(std::move(*job.data), job.sequence);
+      } catch (...) {
+        batch_buffer_->add_chunk_data(std::current_exception(), job.sequence);
+      }
     }
+    AT_ASSERT(running_decoders_.load() > 0);
+    if (--running_decoders_ == 0) {
+      finish_loading();
+    }
+  }
+
+  /// Applies the preprocessing policy to a loaded chunk, and batches it.
+  void preprocess(UnwrappedBatchType data, optional<size_t> sequence) {
+    if (preprocessing_policy_) {
+      preprocessing_policy_(data);
+    }
+    // Empty chunks add no batch, but take their turn in ordered mode.
+    batch_buffer_->add_chunk_data(std::move(data), sequence);
+  }
+
+  /// Called once all the chunks are loaded and batched.
+  void finish_loading() {
+    batch_buffer_->flush();
+    // all chunks are loaded, so we can notify the batch_buffer.
+    batch_buffer_->stop();
   }
 
   /// Block the current thread until the workers finish execution and exit.
@@ -466,9 +693,20 @@ class ChunkDataset final
       for (auto& worker_thread : preload_threads_) {
         worker_thread.join();
       }
+      // The last preloader to exit made the decoders exit.
+      for (auto& worker_thread : decode_threads_) {
+        worker_thread.join();
+      }
     }
   }
 
+  /// A chunk read by a preloader, for a decoder to preprocess, or an empty
+  /// job telling the decoder to exit.
+  struct DecodeJob {
+    optional<UnwrappedBatchType> data;
+    size_t sequence = 0;
+  };
+
  private:
   // Templated class that defines what is a chunk and how to read chunk data.
   // When a chunk is returned by chunk_reader_, ChunkDataset split it into
@@ -488,6 +726,10 @@ class ChunkDataset final
   // worker thread pool
   std::vector<std::thread> preload_threads_;
 
+  // decoder thread pool, and the queue of the chunks they preprocess.
+  std::vector<std::thread> decode_threads_;
+  std::unique_ptr<torch::data::detail::Queue<DecodeJob>> decode_queue_;
+
   /// The options the Dataset was configured with.
   const ChunkDatasetOptions options_;
 
@@ -510,6 +752,13 @@ class ChunkDataset final
   // indicates that the chunk loading is completed.
   std::atomic<size_t> running_preloaders_;
 
+  // keep track of running decoders, the last one to exit notifies the batch
+  // buffer.
+  std::atomic<size_t> running_decoders_{0};
+
+  // The sequence number of the next chunk picked by the chunk sampler.
+  size_t chunk_sequence_ = 0;
+
   // mutex to synchronize chunk sampler next() call.
   mutable std::mutex chunk_index_guard_;
 
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <torch/arg.h>
+#include <torch/data/datasets/base.h>
+#include <torch/data/example.h>
+#include <torch/types.h>
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <c10/util/ArrayRef.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace datasets {
+
+/// Options to configure a `RecordDataset`.
+struct TORCH_API RecordDatasetOptions {
+  /* implicit */ RecordDatasetOptions(std::vector<int64_t> data_sizes = {})
+      : data_sizes_(std::move(data_sizes)) {}
+
+  /// The sizes of the data of a record.
+  TORCH_ARG(std::vector<int64_t>, data_sizes);
+
+  /// The scalar type of the data of a record.
+  TORCH_ARG(ScalarType, data_type) = kFloat;
+
+  /// The sizes of the target of a record, which follows its data.
+  TORCH_ARG(std::vector<int64_t>, target_sizes) = {};
+
+  /// The scalar type of the target of a record, or none if the records have
+  /// no target.
+  TORCH_ARG(optional<ScalarType>, target_type) = kLong;
+
+  /// The number of bytes from the start of a record to the start of the
+  /// next one, if the records are padded. Defaults to the size of a record.
+  TORCH_ARG(optional<size_t>, record_stride);
+
+  /// The number of bytes at the start of every file preceding its records.
+  TORCH_ARG(size_t, header_size) = 0;
+};
+
+/// A dataset of fixed size binary records, stored in one or more files (the
+/// shards of the dataset) one after another. A record holds its data, then
+/// its target, in the native byte order of the machine. The files are memory
+/// mapped rather than read, and the records of a batch are gathered directly
+/// into the tensors of the batch, so that neither the examples of the batch
+/// nor its collation cost an allocation. The indices of the dataset span its
+/// shards in order, and any sampler, e.g., a `DistributedRandomSampler`,
+/// picks the records of a batch.
+class TORCH_API RecordDataset
+    : public BatchDataset<RecordDataset, Example<>, ArrayRef<size_t>> {
+ public:
+  /// Maps the records of the file at `path`.
+  RecordDataset(const std::string& path, RecordDatasetOptions options);
+
+  /// Maps the records of the shards at `paths`.
+  RecordDataset(
+      const std::vector<std::string>& paths,
+      RecordDatasetOptions options);
+
+  /// Returns the batch of the records at `indices`, their data and targets
+  /// stacked along a new first dimension. The target is undefined if the
+  /// records have none.
+  Example<> get_batch(ArrayRef<size_t> indices) override;
+
+  /// Returns the number of records of all the shards.
+  optional<size_t> size() const override;
+
+  /// Returns the number of records of every shard.
+  std::vector<size_t> shard_sizes() const;
+
+  const RecordDatasetOptions& options() const noexcept {
+    return options_;
+  }
+
+ private:
+  struct Shard {
+    /// The bytes of the file, mapped into memory.
+    Tensor bytes;
+    /// The index of the first record of the shard in the dataset.
+    size_t first_record;
+    size_t num_records;
+  };
+
+  RecordDatasetOptions options_;
+  std::vector<Shard> shards_;
+  size_t data_bytes_;
+  size_t target_bytes_;
+  size_t record_stride_;
+  size_t size_ = 0;
+};
+} // namespace datasets
+} // namespace data
+} // namespace torch
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <torch/data/datasets/base.h>
+#include <torch/data/example.h>
+#include <torch/data/tensor_pool.h>
+#include <torch/types.h>
+
+#include <c10/util/ArrayRef.h>
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace datasets {
+
+/// The sizes and options of the data and of the target of every example of a
+/// `SliceDataset`.
+struct ExampleLayout {
+  std::vector<int64_t> data_sizes;
+  TensorOptions data_options;
+  std::vector<int64_t> target_sizes;
+  TensorOptions target_options = TensorOptions(kLong);
+};
+
+/// A dataset of examples of fixed sizes, which writes every example of a batch
+/// directly into a slice of the tensors of the batch rather than returning it.
+/// Its batches are collated as they are produced, without an allocation per
+/// example nor a copy by a `Stack` transform. The tensors of the batches come
+/// from a `TensorPool`, shared by the copies of the dataset.
+template <typename Self>
+class SliceDataset : public BatchDataset<Self, Example<>> {
+ public:
+  explicit SliceDataset(
+      std::shared_ptr<TensorPool> pool = std::make_shared<TensorPool>())
+      : pool_(std::move(pool)) {}
+
+  /// Returns the layout of the examples of the dataset.
+  virtual ExampleLayout layout() const = 0;
+
+  /// Writes the data and the target of the example at `index` into `data`
+  /// and `target`, which have the sizes and options of `layout()`.
+  virtual void get_into(size_t index, Tensor data, Tensor target) = 0;
+
+  /// Returns the batch of the examples at `indices`, stacked along a new first
+  /// dimension.
+  Example<> get_batch(ArrayRef<size_t> indices) override {
+    const auto example_layout = layout();
+    auto data = pool_->empty(
+        batch_sizes(indices.size(), example_layout.data_sizes),
+        example_layout.data_options);
+    auto target = pool_->empty(
+        batch_sizes(indices.size(), example_layout.target_sizes),
+        example_layout.target_options);
+    for (size_t i = 0; i < indices.size(); ++i) {
+      get_into(indices[i], data[i], target[i]);
+    }
+    return {std::move(data), std::move(target)};
+  }
+
+  const std::shared_ptr<TensorPool>& pool() const noexcept {
+    return pool_;
+  }
+
+ private:
+  static std::vector<int64_t> batch_sizes(
+      size_t batch_size,
+      const std::vector<int64_t>& sizes) {
+    std::vector<int64_t> result{static_cast<int64_t>(batch_size)};
+    result.insert(result.end(), sizes.begin(), sizes.end());
+    return result;
+  }
+
+  std::shared_ptr<TensorPool> pool_;
+};
+} // namespace datasets
+} // namespace data
+} // namespace torch
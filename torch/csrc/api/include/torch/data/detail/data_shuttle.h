@@ -25,6 +25,11 @@ namespace detail {
 template <typename Job, typename Result>
 class DataShuttle {
  public:
+  /// Creates a shuttle for up to `capacity` jobs at once, counting those
+  /// waiting for a worker, in flight, and waiting for the main thread.
+  explicit DataShuttle(size_t capacity = 1024)
+      : new_jobs_(capacity), results_(capacity) {}
+
   /// Pushes a new job. Called by the main thread.
   void push_job(Job job) {
     new_jobs_.push(std::move(job));
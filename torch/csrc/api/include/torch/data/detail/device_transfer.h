@@ -0,0 +1,173 @@
+#pragma once
+
+#include <torch/data/example.h>
+#include <torch/types.h>
+
+#include <c10/core/Event.h>
+#include <c10/core/StreamGuard.h>
+#include <c10/core/impl/VirtualGuardImpl.h>
+#include <c10/util/Exception.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace detail {
+
+/// Applies `function` to every tensor of a batch, which may be a tensor, an
+/// `Example` or a vector of them, and returns the batch of the results.
+template <typename F>
+Tensor map_tensors(Tensor tensor, const F& function);
+template <typename Data, typename F>
+Example<Data, example::NoTarget> map_tensors(
+    Example<Data, example::NoTarget> example,
+    const F& function);
+template <typename Data, typename Target, typename F>
+Example<Data, Target> map_tensors(
+    Example<Data, Target> example,
+    const F& function);
+template <typename T, typename F>
+std::vector<T> map_tensors(std::vector<T> batch, const F& function);
+template <typename T, typename F>
+T map_tensors(T batch, const F& function);
+
+template <typename F>
+Tensor map_tensors(Tensor tensor, const F& function) {
+  if (!tensor.defined()) {
+    return tensor;
+  }
+  return function(tensor);
+}
+
+template <typename Data, typename F>
+Example<Data, example::NoTarget> map_tensors(
+    Example<Data, example::NoTarget> example,
+    const F& function) {
+  return {map_tensors(std::move(example.data), function)};
+}
+
+template <typename Data, typename Target, typename F>
+Example<Data, Target> map_tensors(
+    Example<Data, Target> example,
+    const F& function) {
+  return {map_tensors(std::move(example.data), function),
+          map_tensors(std::move(example.target), function)};
+}
+
+template <typename T, typename F>
+std::vector<T> map_tensors(std::vector<T> batch, const F& function) {
+  for (auto& element : batch) {
+    element = map_tensors(std::move(element), function);
+  }
+  return batch;
+}
+
+template <typename T, typename F>
+T map_tensors(T batch, const F& function) {
+  TORCH_CHECK(
+      false,
+      "The pin_memory and device options of a DataLoader only support "
+      "batches of tensors, Examples, or vectors of them");
+  return batch;
+}
+
+/// Copies the tensors of a batch into page-locked memory. The pinned buffers
+/// come from the caching host allocator, which reuses them once the copies
+/// reading them are done.
+template <typename Batch>
+Batch pin_memory(Batch batch) {
+  return map_tensors(std::move(batch), [](const Tensor& tensor) {
+    return tensor.is_cuda() ? tensor : tensor.pin_memory();
+  });
+}
+
+/// Moves the batches of a DataLoader to a device. The batches are copied
+/// asynchronously on a stream from the pool of the device, up to `capacity`
+/// of them at once, and the current stream waits for the copy of a batch when
+/// it is handed out. The copies only overlap with the work on the device when
+/// the batches are in pinned memory.
+template <typename Batch>
+class DeviceTransfer {
+ public:
+  DeviceTransfer(Device device, size_t capacity)
+      : device_(device), capacity_(std::max<size_t>(capacity, 1)) {}
+
+  bool full() const noexcept {
+    return batches_.size() >= capacity_;
+  }
+
+  bool empty() const noexcept {
+    return batches_.empty();
+  }
+
+  /// Issues the copy of `batch` to the device.
+  void push(Batch batch) {
+    if (device_.is_cpu()) {
+      batches_.push_back({to_device(std::move(batch)), nullopt});
+      return;
+    }
+    c10::impl::VirtualGuardImpl impl(device_.type());
+    if (!stream_) {
+      if (!device_.has_index()) {
+        device_ = impl.getDevice();
+      }
+      stream_ = impl.getStreamFromPool(device_);
+    }
+    c10::StreamGuard guard(*stream_);
+    auto device_batch = to_device(std::move(batch));
+    c10::Event event(device_.type());
+    event.record(*stream_);
+    batches_.push_back({std::move(device_batch), std::move(event)});
+  }
+
+  /// Returns the oldest batch, once the current stream of the device waits
+  /// for its copy.
+  Batch pop() {
+    AT_ASSERT(!batches_.empty());
+    InFlight in_flight = std::move(batches_.front());
+    batches_.pop_front();
+    if (in_flight.event) {
+      c10::impl::VirtualGuardImpl impl(device_.type());
+      auto current_stream = impl.getStream(device_);
+      in_flight.event->block(current_stream);
+      // The batch was allocated on the copy stream, and must not be reused
+      // by it before the current stream is done with the batch.
+      map_tensors(in_flight.batch, [&](const Tensor& tensor) {
+        if (tensor.has_storage()) {
+          impl.recordDataPtrOnStream(tensor.storage().data_ptr(), current_stream);
+        }
+        return tensor;
+      });
+    }
+    return std::move(in_flight.batch);
+  }
+
+  void clear() {
+    batches_.clear();
+  }
+
+ private:
+  struct InFlight {
+    Batch batch;
+    /// Recorded on the copy stream after the copy of `batch`.
+    optional<c10::Event> event;
+  };
+
+  Batch to_device(Batch batch) {
+    return map_tensors(std::move(batch), [this](const Tensor& tensor) {
+      return tensor.to(device_, /*non_blocking=*/true);
+    });
+  }
+
+  Device device_;
+  size_t capacity_;
+  optional<c10::Stream> stream_;
+  std::deque<InFlight> batches_;
+};
+} // namespace detail
+} // namespace data
+} // namespace torch
@@ -4,21 +4,29 @@
 
 #include <c10/util/Exception.h>
 
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <mutex>
-#include <queue>
+#include <thread>
 
 namespace torch {
 namespace data {
 namespace detail {
 
-/// A basic locked, blocking MPMC queue.
+/// A bounded, lock-free, blocking MPMC queue.
 ///
-/// Every `push` and `pop` is guarded by a mutex. A condition variable is used
-/// to communicate insertion of new elements, such that waiting threads will be
-/// woken up if they are currently waiting inside a call to `pop()`.
+/// The elements are stored in a ring buffer of cells, each with a sequence
+/// number telling whether it is ready to be written or read at a given
+/// position (see http://www.1024cores.net/home/lock-free-algorithms/queues/
+/// bounded-mpmc-queue). A `push` or `pop` that can't proceed because the queue
+/// is full or empty spins for a short while, then parks its thread on a
+/// condition variable. The mutex of the condition variable is only taken by
+/// threads that park, and by the threads that wake them, so that pushes and
+/// pops never contend on a lock while the queue is neither full nor empty.
 ///
 /// Note that this data structure is written specifically for use with the
 /// `DataLoader`. Its behavior is tailored to this use case and may not be
@@ -26,14 +34,36 @@ namespace detail {
 template <typename T>
 class Queue {
  public:
-  /// Pushes a new value to the back of the `Queue` and notifies one thread on
-  /// the waiting side about this event.
+  /// Creates a queue holding up to `capacity` elements, rounded up to a power
+  /// of two. A `push` into a full queue blocks until an element is popped.
+  explicit Queue(size_t capacity = 1024) {
+    size_t size = 2;
+    while (size < capacity) {
+      size *= 2;
+    }
+    mask_ = size - 1;
+    cells_.reset(new Cell[size]);
+    for (size_t i = 0; i < size; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  Queue(const Queue&) = delete;
+  Queue& operator=(const Queue&) = delete;
+
+  /// Pushes a new value to the back of the `Queue` and wakes up one thread
+  /// parked on the popping side, if any.
   void push(T value) {
-    {
-      std::lock_guard<std::mutex> lock(mutex_);
-      queue_.push(std::move(value));
+    if (!spin([&] { return this->try_push(value); })) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      push_waiters_.fetch_add(1);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      while (!try_push(value)) {
+        not_full_.wait(lock);
+      }
+      push_waiters_.fetch_sub(1);
     }
-    cv_.notify_one();
+    notify(pop_waiters_, not_empty_);
   }
 
   /// Blocks until at least one element is ready to be popped from the front of
@@ -41,44 +71,157 @@ class Queue {
   /// spent waiting for an element. If the wait times out, an exception is
   /// raised.
   T pop(optional<std::chrono::milliseconds> timeout = nullopt) {
-    std::unique_lock<std::mutex> lock(mutex_);
-    if (timeout) {
-      if (!cv_.wait_for(
-              lock, *timeout, [this] { return !this->queue_.empty(); })) {
-        // clang-format off
-        AT_ERROR(
-            "Timeout in DataLoader queue while waiting for next batch"
-            " (timeout was ", timeout->count(), " ms)");
-        // clang-format on
+    const auto deadline = std::chrono::steady_clock::now() +
+        timeout.value_or(std::chrono::milliseconds(0));
+    T value;
+    if (!spin([&] { return this->try_pop(value); })) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      pop_waiters_.fetch_add(1);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      while (!try_pop(value)) {
+        if (!timeout) {
+          not_empty_.wait(lock);
+          continue;
+        }
+        if (not_empty_.wait_until(lock, deadline) == std::cv_status::timeout) {
+          if (try_pop(value)) {
+            break;
+          }
+          pop_waiters_.fetch_sub(1);
+          // clang-format off
+          AT_ERROR(
+              "Timeout in DataLoader queue while waiting for next batch"
+              " (timeout was ", timeout->count(), " ms)");
+          // clang-format on
+        }
       }
-    } else {
-      cv_.wait(lock, [this] { return !this->queue_.empty(); });
+      pop_waiters_.fetch_sub(1);
     }
-    AT_ASSERT(!queue_.empty());
-    T value = queue_.front();
-    queue_.pop();
-    lock.unlock();
+    notify(push_waiters_, not_full_);
     return value;
   }
 
-  /// Empties the queue and returns the number of elements that were present at
-  /// the start of the function. No threads are notified about this event as it
-  /// is assumed to be used to drain the queue during shutdown of a
-  /// `DataLoader`.
+  /// Empties the queue and returns the number of elements it popped. No
+  /// threads on the popping side are notified about this event as it is
+  /// assumed to be used to drain the queue during shutdown of a `DataLoader`.
   size_t clear() {
-    std::lock_guard<std::mutex> lock(this->mutex_);
-    const auto size = queue_.size();
-    while (!queue_.empty()) {
-      queue_.pop();
+    size_t size = 0;
+    T value;
+    while (try_pop(value)) {
+      ++size;
+    }
+    if (size > 0) {
+      notify(push_waiters_, not_full_);
     }
     return size;
   }
 
  private:
-  std::queue<T> queue_;
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  /// The number of times a thread retries a `push` or `pop` before parking.
+  static constexpr size_t kSpinCount = 64;
+
+  template <typename F>
+  static bool spin(const F& attempt) {
+    for (size_t i = 0; i < kSpinCount; ++i) {
+      if (attempt()) {
+        return true;
+      }
+      std::this_thread::yield();
+    }
+    return false;
+  }
+
+  /// Wakes up one of the threads parked on `cv`, if `waiters` counts any. The
+  /// fence orders the load of `waiters` after the push or pop that precedes
+  /// it, so that a thread about to park either sees the change or is counted.
+  void notify(const std::atomic<size_t>& waiters, std::condition_variable& cv) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters.load(std::memory_order_relaxed) > 0) {
+      // Taking the lock waits for a parking thread to be inside `wait`.
+      { std::lock_guard<std::mutex> lock(mutex_); }
+      cv.notify_one();
+    }
+  }
+
+  /// Moves `value` into the queue, unless it is full.
+  bool try_push(T& value) {
+    Cell* cell;
+    size_t position = push_position_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[position & mask_];
+      const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      const auto difference =
+          static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+      if (difference == 0) {
+        if (push_position_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (difference < 0) {
+        return false;
+      } else {
+        position = push_position_.load(std::memory_order_relaxed);
+      }
+    }
+    cell->value = std::move(value);
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Moves the front of the queue into `value`, unless it is empty.
+  bool try_pop(T& value) {
+    Cell* cell;
+    size_t position = pop_position_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[position & mask_];
+      const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      const auto difference =
+          static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+      if (difference == 0) {
+        if (pop_position_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (difference < 0) {
+        return false;
+      } else {
+        position = pop_position_.load(std::memory_order_relaxed);
+      }
+    }
+    value = std::move(cell->value);
+    // Release what the cell holds now rather than when it is overwritten.
+    cell->value = T();
+    cell->sequence.store(position + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// The size of the padding that keeps apart the members updated by
+  /// different threads, so that they don't share a cache line.
+  static constexpr size_t kPadding = 64;
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_;
+  char pad0_[kPadding];
+  std::atomic<size_t> push_position_{0};
+  char pad1_[kPadding];
+  std::atomic<size_t> pop_position_{0};
+  char pad2_[kPadding];
+  std::atomic<size_t> push_waiters_{0};
+  std::atomic<size_t> pop_waiters_{0};
   std::mutex mutex_;
-  std::condition_variable cv_;
+  std::condition_variable not_full_;
+  std::condition_variable not_empty_;
 };
+
+template <typename T>
+constexpr size_t Queue<T>::kSpinCount;
+template <typename T>
+constexpr size_t Queue<T>::kPadding;
 } // namespace detail
 } // namespace data
 } // namespace torch
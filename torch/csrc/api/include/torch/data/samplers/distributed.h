@@ -3,7 +3,9 @@
 #include <torch/csrc/WindowsTorchApiMacro.h>
 #include <torch/data/samplers/base.h>
 
+#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 
 namespace torch {
@@ -96,6 +98,59 @@ class TORCH_API DistributedRandomSampler : public DistributedSampler<> {
   std::vector<size_t> all_indices_;
 };
 
+/// Select samples randomly, like `DistributedRandomSampler`, but without
+/// materializing the indices: the permutation of an epoch is a keyed bijection
+/// of `[0, N)` (a Feistel network, cycle-walked into the range), evaluated
+/// lazily for every sampled position. Every replica computes its part of the
+/// same permutation, so that the sampler costs constant memory and time per
+/// index whatever the size of the dataset, and resuming at any position (e.g.,
+/// after `load()`) costs nothing. The permutation depends on the `seed` and on
+/// the epoch. Without `allow_duplicates`, the samples that do not divide
+/// evenly between the replicas are a random subset of the epoch's.
+class TORCH_API DistributedPermutationSampler : public DistributedSampler<> {
+ public:
+  DistributedPermutationSampler(
+      size_t size,
+      size_t num_replicas = 1,
+      size_t rank = 0,
+      bool allow_duplicates = true,
+      uint64_t seed = 0);
+
+  /// Resets the `DistributedPermutationSampler` to the permutation of the
+  /// current epoch.
+  void reset(optional<size_t> new_size = nullopt) override;
+
+  /// Returns the next batch of indices.
+  optional<std::vector<size_t>> next(size_t batch_size) override;
+
+  /// Serializes the `DistributedPermutationSampler` to the `archive`.
+  void save(serialize::OutputArchive& archive) const override;
+
+  /// Deserializes the `DistributedPermutationSampler` from the `archive`.
+  void load(serialize::InputArchive& archive) override;
+
+  /// Returns the current index of the `DistributedPermutationSampler`.
+  size_t index() const noexcept;
+
+ private:
+  static constexpr size_t kRounds = 6;
+
+  void populate_indices();
+
+  /// Returns the position that the permutation moves `position` to.
+  size_t permute(size_t position) const;
+
+  uint64_t seed_;
+  size_t begin_index_;
+  size_t end_index_;
+  size_t sample_index_;
+  /// The number of positions that are permuted.
+  size_t domain_;
+  /// Half the number of bits of the positions the Feistel network permutes.
+  size_t half_bits_;
+  std::array<uint64_t, kRounds> keys_;
+};
+
 /// Select samples sequentially.
 class TORCH_API DistributedSequentialSampler : public DistributedSampler<> {
  public:
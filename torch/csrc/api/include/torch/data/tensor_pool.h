@@ -0,0 +1,59 @@
+#pragma once
+
+#include <torch/types.h>
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace torch {
+namespace data {
+
+/// A pool of the tensors of batches. A tensor of the pool is handed out again
+/// once nothing else refers to it or shares its storage, i.e. once the batch
+/// it was part of was released by the DataLoader and by its user, so that the
+/// batches of an epoch reuse the memory of the previous ones instead of
+/// allocating (and faulting in) their own. A pool may be shared by the copies
+/// of a dataset that the workers of a DataLoader use.
+///
+/// If `pin_memory` is true the tensors are allocated in pinned memory, which
+/// is recycled by the caching host allocator rather than by the pool: it can
+/// tell when the asynchronous copies reading a tensor are done.
+class TensorPool {
+ public:
+  explicit TensorPool(size_t capacity = 64, bool pin_memory = false)
+      : capacity_(capacity), pin_memory_(pin_memory) {}
+
+  /// Returns an uninitialized tensor of the given sizes and options, a free
+  /// one of the pool if there is one.
+  Tensor empty(IntArrayRef sizes, const TensorOptions& options) {
+    if (pin_memory_) {
+      return torch::empty(sizes, options.pinned_memory(true));
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& tensor : tensors_) {
+      if (tensor.use_count() == 1 && tensor.storage().use_count() == 1 &&
+          tensor.sizes() == sizes && tensor.dtype() == options.dtype() &&
+          tensor.device() == options.device()) {
+        return tensor;
+      }
+    }
+    auto tensor = torch::empty(sizes, options);
+    if (tensors_.size() < capacity_) {
+      tensors_.push_back(tensor);
+    }
+    return tensor;
+  }
+
+  bool pin_memory() const noexcept {
+    return pin_memory_;
+  }
+
+ private:
+  size_t capacity_;
+  bool pin_memory_;
+  std::mutex mutex_;
+  std::vector<Tensor> tensors_;
+};
+} // namespace data
+} // namespace torch
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <torch/arg.h>
+#include <torch/data/example.h>
+#include <torch/data/transforms/collate.h>
+#include <torch/types.h>
+
+#include <c10/util/Exception.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace transforms {
+
+/// Options to configure a `RandomResizedCrop`.
+struct RandomResizedCropOptions {
+  using Range = std::pair<double, double>;
+
+  /* implicit */ RandomResizedCropOptions(std::vector<int64_t> size)
+      : size_(std::move(size)) {}
+
+  /// The height and width of the crops.
+  TORCH_ARG(std::vector<int64_t>, size);
+
+  /// The range of the area of a crop, relative to the area of its image.
+  TORCH_ARG(Range, scale) = Range(0.08, 1.0);
+
+  /// The range of the aspect ratio (the width over the height) of a crop.
+  TORCH_ARG(Range, ratio) = Range(3.0 / 4.0, 4.0 / 3.0);
+
+  /// The probability of flipping a crop horizontally.
+  TORCH_ARG(double, flip_probability) = 0.5;
+
+  /// The mean and the standard deviation that the crops are normalized with,
+  /// per channel or for all of them, in the units of the images (e.g., out of
+  /// 255 for images of bytes).
+  TORCH_ARG(std::vector<double>, mean) = {0.0};
+  TORCH_ARG(std::vector<double>, stddev) = {1.0};
+};
+
+/// A `Collation` for `Example<Tensor, Tensor>` types of images, of shape
+/// `[C, H, W]` and of any size, that crops a random part of every image,
+/// resizes it with bilinear interpolation, flips it horizontally at random and
+/// normalizes it, then stacks the crops into one tensor and the targets into
+/// another one. The parts are chosen like torchvision's RandomResizedCrop
+/// does. All of it is done by a single operator, in a single kernel on CUDA, so
+/// that the images of a batch can be augmented on the device they were decoded
+/// on. The images may be of bytes, and are cropped into floats, or of any
+/// floating type.
+struct RandomResizedCrop : public Collation<Example<>> {
+  explicit RandomResizedCrop(RandomResizedCropOptions options)
+      : options_(std::move(options)) {
+    TORCH_CHECK(
+        options_.size().size() == 2,
+        "RandomResizedCrop expects a size of 2 elements, the height and width of the crops");
+    TORCH_CHECK(
+        0 < options_.scale().first &&
+            options_.scale().first <= options_.scale().second,
+        "RandomResizedCrop expects a positive range of scales");
+    TORCH_CHECK(
+        0 < options_.ratio().first &&
+            options_.ratio().first <= options_.ratio().second,
+        "RandomResizedCrop expects a positive range of aspect ratios");
+  }
+
+  Example<> apply_batch(std::vector<Example<>> examples) override {
+    const int64_t batch_size = examples.size();
+    std::vector<Tensor> images, targets;
+    images.reserve(batch_size);
+    targets.reserve(batch_size);
+    // The random numbers of the whole batch at once, from the torch generator.
+    auto uniform = torch::rand({batch_size, kAttempts, 4}, torch::kDouble);
+    auto uniform_a = uniform.accessor<double, 3>();
+    auto boxes = torch::empty({batch_size, 4}, torch::kLong);
+    auto boxes_a = boxes.accessor<int64_t, 2>();
+    for (int64_t i = 0; i < batch_size; ++i) {
+      auto& image = examples[i].data;
+      TORCH_CHECK(
+          image.dim() == 3,
+          "RandomResizedCrop expects images of shape [C, H, W], but got ",
+          image.sizes());
+      const int64_t height = image.size(1);
+      const int64_t width = image.size(2);
+      int64_t box[4];
+      sample_box(height, width, uniform_a[i], box);
+      std::copy(box, box + 4, boxes_a[i].data());
+      images.push_back(std::move(image));
+      targets.push_back(std::move(examples[i].target));
+    }
+    auto flips = torch::rand({batch_size}) < options_.flip_probability();
+    auto data = torch::_resized_crop_flip_normalize(
+        images,
+        boxes,
+        flips,
+        options_.size(),
+        options_.mean(),
+        options_.stddev());
+    return {std::move(data), torch::stack(targets)};
+  }
+
+  const RandomResizedCropOptions& options() const noexcept {
+    return options_;
+  }
+
+ private:
+  static constexpr int64_t kAttempts = 10;
+
+  /// Writes the top, left, height and width of a part of an image of the given
+  /// size to `box`, of a random area and aspect ratio within the ranges of the
+  /// options if there is one that fits within the image after `kAttempts`
+  /// tries, or else of the whole image clamped to the range of aspect ratios.
+  template <typename Uniform>
+  void sample_box(int64_t height, int64_t width, Uniform uniform, int64_t* box)
+      const {
+    const double area = height * width;
+    const auto scale = options_.scale();
+    const double log_min_ratio = std::log(options_.ratio().first);
+    const double log_max_ratio = std::log(options_.ratio().second);
+    for (int64_t attempt = 0; attempt < kAttempts; ++attempt) {
+      const double target_area =
+          area * (scale.first + uniform[attempt][0] * (scale.second - scale.first));
+      const double aspect_ratio = std::exp(
+          log_min_ratio + uniform[attempt][1] * (log_max_ratio - log_min_ratio));
+      const auto w = static_cast<int64_t>(std::round(std::sqrt(target_area * aspect_ratio)));
+      const auto h = static_cast<int64_t>(std::round(std::sqrt(target_area / aspect_ratio)));
+      if (0 < w && w <= width && 0 < h && h <= height) {
+        box[0] = static_cast<int64_t>(uniform[attempt][2] * (height - h + 1));
+        box[1] = static_cast<int64_t>(uniform[attempt][3] * (width - w + 1));
+        box[2] = h;
+        box[3] = w;
+        return;
+      }
+    }
+    int64_t h = height;
+    int64_t w = width;
+    const double image_ratio = static_cast<double>(width) / height;
+    if (image_ratio < options_.ratio().first) {
+      h = std::max(static_cast<int64_t>(std::round(w / options_.ratio().first)), int64_t(1));
+    } else if (image_ratio > options_.ratio().second) {
+      w = std::max(static_cast<int64_t>(std::round(h * options_.ratio().second)), int64_t(1));
+    }
+    box[0] = (height - h) / 2;
+    box[1] = (width - w) / 2;
+    box[2] = h;
+    box[3] = w;
+  }
+
+  RandomResizedCropOptions options_;
+};
+} // namespace transforms
+} // namespace data
+} // namespace torch
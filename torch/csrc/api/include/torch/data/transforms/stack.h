@@ -1,14 +1,32 @@
 #pragma once
 
 #include <torch/data/example.h>
+#include <torch/data/tensor_pool.h>
 #include <torch/data/transforms/collate.h>
 #include <torch/types.h>
 
+#include <memory>
 #include <utility>
 #include <vector>
 
 namespace torch {
 namespace data {
+namespace detail {
+/// Stacks `tensors` into a tensor of `pool`, if there is one.
+inline Tensor stack(
+    const std::vector<Tensor>& tensors,
+    const std::shared_ptr<TensorPool>& pool) {
+  if (!pool || tensors.empty()) {
+    return torch::stack(tensors);
+  }
+  std::vector<int64_t> sizes{static_cast<int64_t>(tensors.size())};
+  const auto example_sizes = tensors.front().sizes();
+  sizes.insert(sizes.end(), example_sizes.begin(), example_sizes.end());
+  auto result = pool->empty(sizes, tensors.front().options());
+  return torch::stack_out(result, tensors);
+}
+} // namespace detail
+
 namespace transforms {
 
 template <typename T = Example<>>
@@ -16,8 +34,12 @@ struct Stack;
 
 /// A `Collation` for `Example<Tensor, Tensor>` types that stacks all data
 /// tensors into one tensor, and all target (label) tensors into one tensor.
+/// Given a `TensorPool`, the batches are stacked into tensors of the pool.
 template <>
 struct Stack<Example<>> : public Collation<Example<>> {
+  Stack() = default;
+  explicit Stack(std::shared_ptr<TensorPool> pool) : pool_(std::move(pool)) {}
+
   Example<> apply_batch(std::vector<Example<>> examples) override {
     std::vector<torch::Tensor> data, targets;
     data.reserve(examples.size());
@@ -26,8 +48,11 @@ struct Stack<Example<>> : public Collation<Example<>> {
       data.push_back(std::move(example.data));
       targets.push_back(std::move(example.target));
     }
-    return {torch::stack(data), torch::stack(targets)};
+    return {detail::stack(data, pool_), detail::stack(targets, pool_)};
   }
+
+ private:
+  std::shared_ptr<TensorPool> pool_;
 };
 
 /// A `Collation` for `Example<Tensor, NoTarget>` types that stacks all data
@@ -35,14 +60,20 @@ struct Stack<Example<>> : public Collation<Example<>> {
 template <>
 struct Stack<TensorExample>
     : public Collation<Example<Tensor, example::NoTarget>> {
+  Stack() = default;
+  explicit Stack(std::shared_ptr<TensorPool> pool) : pool_(std::move(pool)) {}
+
   TensorExample apply_batch(std::vector<TensorExample> examples) override {
     std::vector<torch::Tensor> data;
     data.reserve(examples.size());
     for (auto& example : examples) {
       data.push_back(std::move(example.data));
     }
-    return torch::stack(data);
+    return detail::stack(data, pool_);
   }
+
+ private:
+  std::shared_ptr<TensorPool> pool_;
 };
 } // namespace transforms
 } // namespace data
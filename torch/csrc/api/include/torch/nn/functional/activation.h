@@ -614,14 +614,15 @@ inline std::tuple<Tensor, Tensor> multi_head_attention_forward(
 
   Tensor q, k, v;
   if (!use_separate_proj_weight) {
-    if (torch::equal(query, key) && torch::equal(key, value)) {
+    if ((query.is_same(key) || torch::equal(query, key)) &&
+        (key.is_same(value) || torch::equal(key, value))) {
       // self-attention
       const auto chunks =
         F::linear(query, in_proj_weight, in_proj_bias).chunk(3, /*dim=*/-1);
       q = chunks[0];
       k = chunks[1];
       v = chunks[2];
-    } else if (torch::equal(key, value)) {
+    } else if (key.is_same(value) || torch::equal(key, value)) {
       // encoder-decoder attention
       // This is inline in_proj function with in_proj_weight and in_proj_bias
       auto _b = in_proj_bias;
@@ -801,6 +802,25 @@ inline std::tuple<Tensor, Tensor> multi_head_attention_forward(
         }, /*dim=*/1);
     }
   }
+  // Without the attention weights to return, nor an attention mask or dropout
+  // to apply to them, nor gradients to compute, the attention is computed
+  // head by head over blocks of keys, without the [tgt_len, src_len] weights.
+  const bool use_fused_attention = !need_weights && !attn_mask_.defined() &&
+      (dropout_p == 0 || !training) &&
+      !(q.requires_grad() || k.requires_grad() || v.requires_grad()) &&
+      (!q.is_cuda() || head_dim <= 128);
+  if (use_fused_attention) {
+    auto attn_output = torch::_fused_attention(
+      q.reshape({bsz, num_heads, tgt_len, head_dim}),
+      k.reshape({bsz, num_heads, src_len, head_dim}),
+      v.reshape({bsz, num_heads, src_len, head_dim}),
+      key_padding_mask_.defined() ? key_padding_mask_.to(torch::kBool) : Tensor(),
+      /*causal=*/false,
+      /*scale=*/1.0);
+    attn_output = attn_output.permute({2, 0, 1, 3}).reshape({tgt_len, bsz, embed_dim});
+    attn_output = F::linear(attn_output, out_proj_weight, out_proj_bias);
+    return std::make_tuple(attn_output, Tensor());
+  }
   auto attn_output_weights = torch::bmm(q, k.transpose(1, 2));
   TORCH_CHECK(attn_output_weights.sizes() == IntArrayRef({bsz * num_heads, tgt_len, src_len}));
   if (attn_mask_.defined()) {
@@ -764,26 +764,15 @@ inline Tensor cross_entropy(
     const Tensor& target,
     const Tensor& weight,
     int64_t ignore_index,
-    CrossEntropyFuncOptions::reduction_t reduction) {
-  NLLLossFuncOptions::reduction_t reduction_;
-  if (c10::get_if<enumtype::kNone>(&reduction)) {
-    reduction_ = torch::kNone;
-  } else if (c10::get_if<enumtype::kMean>(&reduction)) {
-    reduction_ = torch::kMean;
-  } else if (c10::get_if<enumtype::kSum>(&reduction)) {
-    reduction_ = torch::kSum;
-  } else {
-    TORCH_INTERNAL_ASSERT(
-      false,
-      enumtype::get_enum_name(reduction),
-      " is not valid");
-  }
-  return torch::nn::functional::detail::nll_loss(
-    torch::nn::functional::detail::log_softmax(input, 1, c10::nullopt),
+    CrossEntropyFuncOptions::reduction_t reduction,
+    double label_smoothing) {
+  return torch::cross_entropy_loss(
+    input,
     target,
     weight,
+    enumtype::reduction_get_enum(reduction),
     ignore_index,
-    reduction_);
+    label_smoothing);
 }
 } // namespace detail
 #endif /* DOXYGEN_SHOULD_SKIP_THIS */
@@ -808,7 +797,8 @@ inline Tensor cross_entropy(
       target,
       options.weight(),
       options.ignore_index(),
-      options.reduction());
+      options.reduction(),
+      options.label_smoothing());
 }
 
 // ============================================================================
@@ -14,37 +14,21 @@ inline double clip_grad_norm_(
     std::vector<Tensor> parameters,
     double max_norm,
     double norm_type = 2.0) {
-  std::vector<Tensor> params_with_grad;
-
+  std::vector<Tensor> grads;
   for (const auto& param : parameters) {
     auto& grad = param.grad();
     if (grad.defined()) {
-      params_with_grad.push_back(param);
-    }
-  }
-  double total_norm = 0.0;
-  if (norm_type == std::numeric_limits<double>::infinity()) {
-    for (const auto& param : params_with_grad) {
-      auto param_max = param.grad().data().abs().max().item().toDouble();
-      if (param_max > total_norm) {
-        total_norm = param_max;
-      }
+      grads.push_back(grad.data());
     }
-  } else {
-    for (const auto& param : params_with_grad) {
-      auto param_norm = param.grad().data().norm(norm_type);
-      total_norm += std::pow(param_norm.item().toDouble(), norm_type);
-    }
-    total_norm = std::pow(total_norm, 1.0 / norm_type);
   }
-
-  auto clip_coef = max_norm / (total_norm + 1e-6);
-  if (clip_coef < 1) {
-    for (auto& param : params_with_grad) {
-      param.grad().data().mul_(clip_coef);
-    }
+  if (grads.empty()) {
+    return 0.0;
   }
-  return total_norm;
+  // The gradients are scaled by a clip coefficient computed on the device,
+  // so the norm is only waited for once the clipping is queued.
+  auto total_norm = at::_foreach_total_norm(grads, norm_type);
+  at::_foreach_clip_scale_(grads, total_norm, max_norm);
+  return total_norm.item().toDouble();
 }
 
 // A wrapper around clip_grad_norm_ that allows us to call the function with a
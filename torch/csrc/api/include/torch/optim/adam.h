@@ -26,6 +26,10 @@ struct TORCH_API AdamOptions : public OptimizerCloneableOptions<AdamOptions> {
   TORCH_ARG(double, eps) = 1e-8;
   TORCH_ARG(double, weight_decay) = 0;
   TORCH_ARG(bool, amsgrad) = false;
+  /// Update each param group with fused CUDA kernels, which read and write
+  /// the params and the optimizer state once per step. Requires floating
+  /// point CUDA params; Half and BFloat16 params get float master params.
+  TORCH_ARG(bool, fused) = false;
 public:
   void serialize(torch::serialize::InputArchive& archive) override;
   void serialize(torch::serialize::OutputArchive& archive) const override;
@@ -38,6 +42,8 @@ struct TORCH_API AdamParamState : public OptimizerCloneableParamState<AdamParamS
   TORCH_ARG(torch::Tensor, exp_avg);
   TORCH_ARG(torch::Tensor, exp_avg_sq);
   TORCH_ARG(torch::Tensor, max_exp_avg_sq) = {};
+  /// Float copy of a Half or BFloat16 param updated by the fused step.
+  TORCH_ARG(torch::Tensor, master_param) = {};
 
 public:
   void serialize(torch::serialize::InputArchive& archive) override;
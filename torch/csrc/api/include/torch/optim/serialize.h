@@ -256,6 +256,15 @@ std::deque<T> list_to_deque(const c10::List<T>& list) {
   } \
 }
 
+// For options added after archives were first written: a missing value keeps
+// the default.
+#define _TORCH_OPTIM_DESERIALIZE_TORCH_ARG_IF_EXISTS(T, name) { \
+  c10::IValue ivalue; \
+  if (archive.try_read(#name, ivalue)) { \
+    name(ivalue.to<T>()); \
+  } \
+}
+
 #define _TORCH_OPTIM_DESERIALIZE_TORCH_ARG_OPTIONAL(T, name) { \
   c10::IValue ivalue; \
   bool exists = archive.try_read(#name, ivalue); \
@@ -28,6 +28,10 @@ struct TORCH_API SGDOptions : public OptimizerCloneableOptions<SGDOptions> {
   TORCH_ARG(double, dampening) = 0;
   TORCH_ARG(double, weight_decay) = 0;
   TORCH_ARG(bool, nesterov) = false;
+  /// Update each param group with fused CUDA kernels, which read and write
+  /// the params and the momentum buffers once per step. Requires floating
+  /// point CUDA params; Half and BFloat16 params get float master params.
+  TORCH_ARG(bool, fused) = false;
 public:
   void serialize(torch::serialize::InputArchive& archive) override;
   void serialize(torch::serialize::OutputArchive& archive) const override;
@@ -37,6 +41,8 @@ public:
 
 struct TORCH_API SGDParamState : public OptimizerCloneableParamState<SGDParamState> {
   TORCH_ARG(torch::Tensor, momentum_buffer);
+  /// Float copy of a Half or BFloat16 param updated by the fused step.
+  TORCH_ARG(torch::Tensor, master_param) = {};
 
 public:
   void serialize(torch::serialize::InputArchive& archive) override;
@@ -0,0 +1,148 @@
+#include <torch/data/datasets/records.h>
+
+#include <torch/data/example.h>
+#include <torch/types.h>
+
+#include <ATen/Parallel.h>
+#include <c10/util/Exception.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace datasets {
+namespace {
+// The records copied by a thread of a batch at least.
+constexpr int64_t kGatherGrainSize = 256;
+
+size_t num_bytes(IntArrayRef sizes, ScalarType type) {
+  return std::accumulate(
+             sizes.begin(), sizes.end(), int64_t(1), std::multiplies<int64_t>()) *
+      elementSize(type);
+}
+
+size_t file_size(const std::string& path) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  TORCH_CHECK(file, "Error opening records file at ", path);
+  return static_cast<size_t>(file.tellg());
+}
+
+std::vector<int64_t> batch_sizes(size_t batch_size, IntArrayRef sizes) {
+  std::vector<int64_t> result{static_cast<int64_t>(batch_size)};
+  result.insert(result.end(), sizes.begin(), sizes.end());
+  return result;
+}
+} // namespace
+
+RecordDataset::RecordDataset(
+    const std::string& path,
+    RecordDatasetOptions options)
+    : RecordDataset(std::vector<std::string>{path}, std::move(options)) {}
+
+RecordDataset::RecordDataset(
+    const std::vector<std::string>& paths,
+    RecordDatasetOptions options)
+    : options_(std::move(options)) {
+  TORCH_CHECK(!paths.empty(), "A RecordDataset needs at least one file");
+  data_bytes_ = num_bytes(options_.data_sizes(), options_.data_type());
+  target_bytes_ = options_.target_type()
+      ? num_bytes(options_.target_sizes(), *options_.target_type())
+      : 0;
+  record_stride_ =
+      options_.record_stride().value_or(data_bytes_ + target_bytes_);
+  TORCH_CHECK(
+      record_stride_ >= data_bytes_ + target_bytes_ && record_stride_ > 0,
+      "The record stride (", record_stride_,
+      " bytes) is smaller than a record (", data_bytes_ + target_bytes_,
+      " bytes)");
+
+  for (const auto& path : paths) {
+    const size_t bytes = file_size(path);
+    TORCH_CHECK(
+        bytes >= options_.header_size() &&
+            (bytes - options_.header_size()) % record_stride_ == 0,
+        "The size of ", path, " (", bytes, " bytes) is not that of a header of ",
+        options_.header_size(), " bytes followed by records of ",
+        record_stride_, " bytes");
+    const size_t num_records = (bytes - options_.header_size()) / record_stride_;
+    Shard shard{Tensor(), size_, num_records};
+    if (num_records > 0) {
+      shard.bytes = at::from_file(
+          path, /*shared=*/false, static_cast<int64_t>(bytes), torch::kByte);
+    }
+    shards_.push_back(std::move(shard));
+    size_ += num_records;
+  }
+}
+
+Example<> RecordDataset::get_batch(ArrayRef<size_t> indices) {
+  const size_t batch_size = indices.size();
+  for (const auto index : indices) {
+    TORCH_CHECK(
+        index < size_,
+        "Index ", index, " is out of range for a dataset of ", size_,
+        " records");
+  }
+  auto data = torch::empty(
+      batch_sizes(batch_size, options_.data_sizes()), options_.data_type());
+  Tensor target;
+  if (options_.target_type()) {
+    target = torch::empty(
+        batch_sizes(batch_size, options_.target_sizes()),
+        *options_.target_type());
+  }
+
+  auto* data_ptr = static_cast<uint8_t*>(data.data_ptr());
+  auto* target_ptr =
+      target.defined() ? static_cast<uint8_t*>(target.data_ptr()) : nullptr;
+  at::parallel_for(
+      0, batch_size, kGatherGrainSize, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          const size_t index = indices[i];
+          // The first shard starting after the record, less one.
+          auto shard = std::upper_bound(
+                           shards_.begin(),
+                           shards_.end(),
+                           index,
+                           [](size_t index, const Shard& shard) {
+                             return index < shard.first_record;
+                           }) -
+              1;
+          const auto* record = static_cast<const uint8_t*>(
+                                   shard->bytes.data_ptr()) +
+              options_.header_size() +
+              (index - shard->first_record) * record_stride_;
+          std::memcpy(data_ptr + i * data_bytes_, record, data_bytes_);
+          if (target_ptr) {
+            std::memcpy(
+                target_ptr + i * target_bytes_,
+                record + data_bytes_,
+                target_bytes_);
+          }
+        }
+      });
+  return {std::move(data), std::move(target)};
+}
+
+optional<size_t> RecordDataset::size() const {
+  return size_;
+}
+
+std::vector<size_t> RecordDataset::shard_sizes() const {
+  std::vector<size_t> sizes;
+  sizes.reserve(shards_.size());
+  for (const auto& shard : shards_) {
+    sizes.push_back(shard.num_records);
+  }
+  return sizes;
+}
+} // namespace datasets
+} // namespace data
+} // namespace torch
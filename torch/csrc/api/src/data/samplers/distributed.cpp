@@ -10,6 +10,15 @@
 namespace torch {
 namespace data {
 namespace samplers {
+namespace {
+// The finalizer of splitmix64, which maps its input to a pseudo-random value.
+uint64_t mix(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+} // namespace
 
 DistributedRandomSampler::DistributedRandomSampler(
     size_t size,
@@ -93,6 +102,117 @@ size_t DistributedRandomSampler::index() const noexcept {
   return sample_index_;
 }
 
+DistributedPermutationSampler::DistributedPermutationSampler(
+    size_t size,
+    size_t num_replicas,
+    size_t rank,
+    bool allow_duplicates,
+    uint64_t seed)
+    : DistributedSampler(size, num_replicas, rank, allow_duplicates),
+      seed_(seed),
+      begin_index_(0),
+      end_index_(0),
+      sample_index_(0),
+      domain_(0),
+      half_bits_(0) {
+  reset(size_);
+}
+
+optional<std::vector<size_t>> DistributedPermutationSampler::next(
+    size_t batch_size) {
+  if (sample_index_ == end_index_) {
+    return nullopt;
+  }
+
+  size_t end = sample_index_ + batch_size;
+  if (end > end_index_) {
+    end = end_index_;
+  }
+
+  std::vector<size_t> res;
+  res.reserve(end - sample_index_);
+  for (size_t position = sample_index_; position < end; ++position) {
+    // Positions past the end of the dataset are duplicates.
+    res.push_back(permute(position) % size_);
+  }
+  sample_index_ = end;
+  return res;
+}
+
+void DistributedPermutationSampler::reset(optional<size_t> new_size) {
+  size_ = new_size.value_or(size_);
+  populate_indices();
+
+  uint64_t state = mix(seed_) ^ mix(epoch_);
+  for (auto& key : keys_) {
+    state = mix(state);
+    key = state;
+  }
+  sample_index_ = begin_index_;
+}
+
+void DistributedPermutationSampler::populate_indices() {
+  size_t num_local_samples = local_sample_count();
+  size_t sample_count =
+      num_replicas_ == 1 ? size_ : num_local_samples * num_replicas_;
+  domain_ = std::max(size_, sample_count);
+  half_bits_ = 1;
+  while (half_bits_ < 32 && (uint64_t(1) << (2 * half_bits_)) < domain_) {
+    ++half_bits_;
+  }
+  begin_index_ = rank_ * num_local_samples;
+  end_index_ = begin_index_ + num_local_samples;
+  sample_index_ = begin_index_;
+}
+
+size_t DistributedPermutationSampler::permute(size_t position) const {
+  const uint64_t mask = (uint64_t(1) << half_bits_) - 1;
+  uint64_t x = position;
+  // The network permutes [0, 4^half_bits_), which holds fewer than four times
+  // as many positions as [0, domain_), so it takes fewer than four trips
+  // through it on average to get back into the range (and at worst it cycles
+  // back to `position`).
+  do {
+    uint64_t left = x >> half_bits_;
+    uint64_t right = x & mask;
+    for (const auto key : keys_) {
+      const uint64_t next = left ^ (mix(right ^ key) & mask);
+      left = right;
+      right = next;
+    }
+    x = (left << half_bits_) | right;
+  } while (x >= domain_);
+  return x;
+}
+
+void DistributedPermutationSampler::save(
+    serialize::OutputArchive& archive) const {
+  archive.write(
+      "sample_index_",
+      torch::tensor(static_cast<int64_t>(sample_index_)),
+      /*is_buffer=*/true);
+  archive.write(
+      "epoch_",
+      torch::tensor(static_cast<int64_t>(epoch_)),
+      /*is_buffer=*/true);
+}
+
+void DistributedPermutationSampler::load(serialize::InputArchive& archive) {
+  auto tensor = torch::empty(1, torch::kInt64);
+  archive.read("epoch_", tensor, /*is_buffer=*/true);
+  epoch_ = tensor.item<int64_t>();
+  // call reset() after loading epoch_ to compute the permutation.
+  reset(size_);
+
+  tensor = torch::empty(1, torch::kInt64);
+  archive.read("sample_index_", tensor, /*is_buffer=*/true);
+  sample_index_ = tensor.item<int64_t>();
+}
+
+size_t DistributedPermutationSampler::index() const noexcept {
+  return sample_index_;
+}
+
 DistributedSequentialSampler::DistributedSequentialSampler(
     size_t size,
     size_t num_replicas,
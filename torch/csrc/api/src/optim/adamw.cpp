@@ -21,7 +21,8 @@ bool operator==(const AdamWOptions& lhs, const AdamWOptions& rhs) {
          (std::get<1>(lhs.betas()) == std::get<1>(rhs.betas())) &&
          (lhs.eps() == rhs.eps()) &&
          (lhs.weight_decay() == rhs.weight_decay()) &&
-         (lhs.amsgrad() == rhs.amsgrad());
+         (lhs.amsgrad() == rhs.amsgrad()) &&
+         (lhs.fused() == rhs.fused());
 }
 
 void AdamWOptions::serialize(torch::serialize::OutputArchive& archive) const {
@@ -30,6 +31,7 @@ void AdamWOptions::serialize(torch::serialize::OutputArchive& archive) const {
   _TORCH_OPTIM_SERIALIZE_TORCH_ARG(eps);
   _TORCH_OPTIM_SERIALIZE_TORCH_ARG(weight_decay);
   _TORCH_OPTIM_SERIALIZE_TORCH_ARG(amsgrad);
+  _TORCH_OPTIM_SERIALIZE_TORCH_ARG(fused);
 }
 
 void AdamWOptions::serialize(torch::serialize::InputArchive& archive) {
@@ -38,13 +40,15 @@ void AdamWOptions::serialize(torch::serialize::InputArchive& archive) {
   _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(double, eps);
   _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(double, weight_decay);
   _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(bool, amsgrad);
+  _TORCH_OPTIM_DESERIALIZE_TORCH_ARG_IF_EXISTS(bool, fused);
 }
 
 bool operator==(const AdamWParamState& lhs, const AdamWParamState& rhs) {
   return (lhs.step() == rhs.step()) &&
           torch::equal(lhs.exp_avg(), rhs.exp_avg()) &&
           torch::equal(lhs.exp_avg_sq(), rhs.exp_avg_sq()) &&
-          torch::equal_if_defined(lhs.max_exp_avg_sq(), rhs.max_exp_avg_sq());
+          torch::equal_if_defined(lhs.max_exp_avg_sq(), rhs.max_exp_avg_sq()) &&
+          torch::equal_if_defined(lhs.master_param(), rhs.master_param());
 }
 
 void AdamWParamState::serialize(torch::serialize::OutputArchive& archive) const {
@@ -52,6 +56,7 @@ void AdamWParamState::serialize(torch::serialize::OutputArchive& archive) const
   _TORCH_OPTIM_SERIALIZE_TORCH_ARG(exp_avg);
   _TORCH_OPTIM_SERIALIZE_TORCH_ARG(exp_avg_sq);
   _TORCH_OPTIM_SERIALIZE_TORCH_ARG(max_exp_avg_sq);
+  _TORCH_OPTIM_SERIALIZE_TORCH_ARG(master_param);
 }
 
 void AdamWParamState::serialize(torch::serialize::InputArchive& archive) {
@@ -59,8 +64,37 @@ void AdamWParamState::serialize(torch::serialize::InputArchive& archive) {
   _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(Tensor, exp_avg);
   _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(Tensor, exp_avg_sq);
   _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(Tensor, max_exp_avg_sq);
+  _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(Tensor, master_param);
 }
 
+namespace {
+// The lists of one _fused_adam_ call: the params of a group that are on one
+// device and of one dtype.
+struct FusedAdamLists {
+  std::vector<Tensor> params;
+  std::vector<Tensor> grads;
+  std::vector<Tensor> exp_avgs;
+  std::vector<Tensor> exp_avg_sqs;
+  std::vector<Tensor> max_exp_avg_sqs;
+  std::vector<Tensor> master_params;
+  std::vector<double> steps;
+};
+
+FusedAdamLists& fused_lists_for(std::vector<FusedAdamLists>& buckets, const Tensor& p) {
+  for (auto& lists : buckets) {
+    if (lists.params[0].device() == p.device() && lists.params[0].scalar_type() == p.scalar_type()) {
+      return lists;
+    }
+  }
+  buckets.emplace_back();
+  return buckets.back();
+}
+
+bool needs_master_param(const Tensor& p) {
+  return p.scalar_type() == kHalf || p.scalar_type() == kBFloat16;
+}
+} // namespace
+
 Tensor AdamW::step(LossClosure closure)  {
   NoGradGuard no_grad;
   Tensor loss = {};
@@ -69,64 +103,129 @@ Tensor AdamW::step(LossClosure closure)  {
     loss = closure();
   }
   for (auto& group : param_groups_) {
+    auto& options = static_cast<AdamWOptions&>(group.options());
+    auto beta1 = std::get<0>(options.betas());
+    auto beta2 = std::get<1>(options.betas());
+
+    // The parameters of the group that have a gradient are updated together
+    // with the _foreach_ ops, which take one kernel launch for many tensors
+    // on CUDA. Each parameter keeps its own step count, so the bias
+    // corrections are passed as lists.
+    std::vector<Tensor> params_with_grad;
+    std::vector<Tensor> grads;
+    std::vector<Tensor> exp_avgs;
+    std::vector<Tensor> exp_avg_sqs;
+    std::vector<Tensor> max_exp_avg_sqs;
+    std::vector<double> bias_correction2_sqrts;
+    std::vector<double> step_sizes;
+    std::vector<FusedAdamLists> fused_buckets;
+
     for (auto& p : group.params()) {
       if (!p.grad().defined()) {
         continue;
       }
       auto grad = p.grad();
       TORCH_CHECK(!grad.is_sparse(), "AdamW does not support sparse gradients"/*, please consider SparseAdamW instead*/);
-      auto param_state = state_.find(c10::guts::to_string(p.unsafeGetTensorImpl()));
-      auto& options = static_cast<AdamWOptions&>(group.options());
-
-      // Perform stepweight decay
-      if(options.weight_decay() != 0) {
-        p.mul_(1 - options.lr() * options.weight_decay());
+      if(options.fused()) {
+        TORCH_CHECK(p.is_cuda() && at::isFloatingType(p.scalar_type()),
+                    "The fused AdamW step requires floating point CUDA params, got ", p.toString());
       }
+      auto param_state = state_.find(c10::guts::to_string(p.unsafeGetTensorImpl()));
 
       // State initialization
       if(param_state == state_.end()) {
         auto state = std::make_unique<AdamWParamState>();
         state->step(0);
+        // The fused step keeps the state of Half and BFloat16 params in float
+        auto state_options = p.options();
+        if(options.fused() && needs_master_param(p)) {
+          state->master_param(p.detach().to(kFloat, /*non_blocking=*/false, /*copy=*/true, MemoryFormat::Preserve));
+          state_options = state_options.dtype(kFloat);
+        }
         // Exponential moving average of gradient values
-        state->exp_avg(torch::zeros_like(p, MemoryFormat::Preserve));
+        state->exp_avg(torch::zeros_like(p, state_options, MemoryFormat::Preserve));
         // Exponential moving average of squared gradient values
-        state->exp_avg_sq(torch::zeros_like(p, MemoryFormat::Preserve));
+        state->exp_avg_sq(torch::zeros_like(p, state_options, MemoryFormat::Preserve));
         if(options.amsgrad()) {
           // Maintains max of all exp. moving avg. of sq. grad. values
-          state->max_exp_avg_sq(torch::zeros_like(p, MemoryFormat::Preserve));
+          state->max_exp_avg_sq(torch::zeros_like(p, state_options, MemoryFormat::Preserve));
         }
         state_[c10::guts::to_string(p.unsafeGetTensorImpl())] = std::move(state);
       }
 
       auto& state = static_cast<AdamWParamState&>(*state_[c10::guts::to_string(p.unsafeGetTensorImpl())]);
-      auto& exp_avg = state.exp_avg();
-      auto& exp_avg_sq = state.exp_avg_sq();
-      auto& max_exp_avg_sq = state.max_exp_avg_sq();
-
       state.step(state.step()+1);
-      auto beta1 = std::get<0>(options.betas());
-      auto beta2 = std::get<1>(options.betas());
+
+      if(options.fused()) {
+        auto& lists = fused_lists_for(fused_buckets, p);
+        lists.params.push_back(p);
+        lists.grads.push_back(grad);
+        lists.exp_avgs.push_back(state.exp_avg());
+        lists.exp_avg_sqs.push_back(state.exp_avg_sq());
+        if(options.amsgrad()) {
+          lists.max_exp_avg_sqs.push_back(state.max_exp_avg_sq());
+        }
+        if(state.master_param().defined()) {
+          lists.master_params.push_back(state.master_param());
+        }
+        lists.steps.push_back(state.step());
+        continue;
+      }
+
+      params_with_grad.push_back(p);
+      grads.push_back(grad);
+      exp_avgs.push_back(state.exp_avg());
+      exp_avg_sqs.push_back(state.exp_avg_sq());
+      if(options.amsgrad()) {
+        max_exp_avg_sqs.push_back(state.max_exp_avg_sq());
+      }
 
       auto bias_correction1 = 1 - std::pow(beta1, state.step());
       auto bias_correction2 = 1 - std::pow(beta2, state.step());
+      bias_correction2_sqrts.push_back(std::sqrt(bias_correction2));
+      step_sizes.push_back(-options.lr() / bias_correction1);
+    }
+
+    for (auto& lists : fused_buckets) {
+      TORCH_CHECK(lists.master_params.empty() || lists.master_params.size() == lists.params.size(),
+                  "The fused AdamW step found Half or BFloat16 params without master params; "
+                  "these params were stepped before fused() was set");
+      torch::_fused_adam_(lists.params, lists.grads, lists.exp_avgs, lists.exp_avg_sqs,
+                          lists.max_exp_avg_sqs, lists.master_params, lists.steps,
+                          options.lr(), beta1, beta2, options.weight_decay(), options.eps(),
+                          options.amsgrad(), /*decoupled_weight_decay=*/true);
+    }
 
-      // Decay the first and second moment running average coefficient
-      exp_avg.mul_(beta1).add_(grad, 1 - beta1);
-      exp_avg_sq.mul_(beta2).addcmul_(grad, grad, 1 - beta2);
+    if (params_with_grad.empty()) {
+      continue;
+    }
 
-      Tensor denom;
-      if(options.amsgrad()) {
-        // Maintains the maximum of all 2nd moment running avg. till now
-        torch::max_out(max_exp_avg_sq, exp_avg_sq, max_exp_avg_sq);
-        // Use the max. for normalizing running avg. of gradient
-        denom = (max_exp_avg_sq.sqrt() / sqrt(bias_correction2)).add_(options.eps());
-      } else {
-        denom = (exp_avg_sq.sqrt() / sqrt(bias_correction2)).add_(options.eps());
-      }
+    // Perform stepweight decay
+    if(options.weight_decay() != 0) {
+      torch::_foreach_mul_(params_with_grad, Scalar(1 - options.lr() * options.weight_decay()));
+    }
+
+    // Decay the first and second moment running average coefficient
+    torch::_foreach_mul_(exp_avgs, Scalar(beta1));
+    torch::_foreach_add_(exp_avgs, grads, 1 - beta1);
+    torch::_foreach_mul_(exp_avg_sqs, Scalar(beta2));
+    torch::_foreach_addcmul_(exp_avg_sqs, grads, grads, Scalar(1 - beta2));
 
-      auto step_size = options.lr() / bias_correction1;
-      p.addcdiv_(exp_avg, denom, -step_size);
+    std::vector<Tensor> denoms;
+    if(options.amsgrad()) {
+      // Maintains the maximum of all 2nd moment running avg. till now
+      for (size_t i = 0; i < max_exp_avg_sqs.size(); i++) {
+        torch::max_out(max_exp_avg_sqs[i], exp_avg_sqs[i], max_exp_avg_sqs[i]);
+      }
+      // Use the max. for normalizing running avg. of gradient
+      denoms = torch::_foreach_sqrt(max_exp_avg_sqs);
+    } else {
+      denoms = torch::_foreach_sqrt(exp_avg_sqs);
     }
+    torch::_foreach_div_(denoms, bias_correction2_sqrts);
+    torch::_foreach_add_(denoms, Scalar(options.eps()));
+
+    torch::_foreach_addcdiv_(params_with_grad, exp_avgs, denoms, step_sizes);
   }
   return loss;
 }
@@ -21,7 +21,8 @@ bool operator==(const SGDOptions& lhs, const SGDOptions& rhs) {
           (lhs.momentum() == rhs.momentum()) &&
           (lhs.dampening() == rhs.dampening()) &&
           (lhs.weight_decay() == rhs.weight_decay()) &&
-          (lhs.nesterov() == rhs.nesterov());
+          (lhs.nesterov() == rhs.nesterov()) &&
+          (lhs.fused() == rhs.fused());
 }
 
 void SGDOptions::serialize(torch::serialize::OutputArchive& archive) const {
@@ -30,6 +31,7 @@ void SGDOptions::serialize(torch::serialize::OutputArchive& archive) const {
   _TORCH_OPTIM_SERIALIZE_TORCH_ARG(dampening);
   _TORCH_OPTIM_SERIALIZE_TORCH_ARG(weight_decay);
   _TORCH_OPTIM_SERIALIZE_TORCH_ARG(nesterov);
+  _TORCH_OPTIM_SERIALIZE_TORCH_ARG(fused);
 }
 
 void SGDOptions::serialize(torch::serialize::InputArchive& archive) {
@@ -38,20 +40,49 @@ void SGDOptions::serialize(torch::serialize::InputArchive& archive) {
   _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(double, dampening);
   _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(double, weight_decay);
   _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(bool, nesterov);
+  _TORCH_OPTIM_DESERIALIZE_TORCH_ARG_IF_EXISTS(bool, fused);
 }
 
 bool operator==(const SGDParamState& lhs, const SGDParamState& rhs) {
-  return torch::equal(lhs.momentum_buffer(), rhs.momentum_buffer());
+  return torch::equal_if_defined(lhs.momentum_buffer(), rhs.momentum_buffer()) &&
+         torch::equal_if_defined(lhs.master_param(), rhs.master_param());
 }
 
 void SGDParamState::serialize(torch::serialize::OutputArchive& archive) const {
   _TORCH_OPTIM_SERIALIZE_TORCH_ARG(momentum_buffer);
+  _TORCH_OPTIM_SERIALIZE_TORCH_ARG(master_param);
 }
 
 void SGDParamState::serialize(torch::serialize::InputArchive& archive) {
   _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(Tensor, momentum_buffer);
+  _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(Tensor, master_param);
 }
 
+namespace {
+// The lists of one _fused_sgd_ call: the params of a group that are on one
+// device and of one dtype, and whose momentum buffers are all new or all
+// existing.
+struct FusedSGDLists {
+  std::vector<Tensor> params;
+  std::vector<Tensor> grads;
+  std::vector<Tensor> momentum_buffers;
+  std::vector<Tensor> master_params;
+  bool first_step;
+};
+
+FusedSGDLists& fused_lists_for(std::vector<FusedSGDLists>& buckets, const Tensor& p, bool first_step) {
+  for (auto& lists : buckets) {
+    if (lists.params[0].device() == p.device() && lists.params[0].scalar_type() == p.scalar_type() &&
+        lists.first_step == first_step) {
+      return lists;
+    }
+  }
+  buckets.emplace_back();
+  buckets.back().first_step = first_step;
+  return buckets.back();
+}
+} // namespace
+
 Tensor SGD::step(LossClosure closure)  {
   NoGradGuard no_grad;
   Tensor loss = {};
@@ -66,34 +97,100 @@ Tensor SGD::step(LossClosure closure)  {
     auto dampening = options.dampening();
     auto nesterov = options.nesterov();
 
+    // The parameters of the group that have a gradient are updated with the
+    // _foreach_ ops, which take one kernel launch for many tensors on CUDA.
+    std::vector<Tensor> params_with_grad;
+    std::vector<Tensor> d_p_list;
     for (auto& p : group.params()) {
       if (!p.grad().defined()) {
         continue;
       }
-      auto d_p = p.grad().data();
-      if (weight_decay != 0) {
-        d_p = d_p.add(p.data(), weight_decay);
+      params_with_grad.push_back(p);
+      d_p_list.push_back(p.grad());
+    }
+    if (params_with_grad.empty()) {
+      continue;
+    }
+
+    if (options.fused()) {
+      std::vector<FusedSGDLists> fused_buckets;
+      for (size_t i = 0; i < params_with_grad.size(); i++) {
+        const auto& p = params_with_grad[i];
+        TORCH_CHECK(p.is_cuda() && at::isFloatingType(p.scalar_type()),
+                    "The fused SGD step requires floating point CUDA params, got ", p.toString());
+        auto key = c10::guts::to_string(p.unsafeGetTensorImpl());
+        if (state_.find(key) == state_.end()) {
+          auto state = std::make_unique<SGDParamState>();
+          if (p.scalar_type() == kHalf || p.scalar_type() == kBFloat16) {
+            state->master_param(p.detach().to(kFloat, /*non_blocking=*/false, /*copy=*/true, MemoryFormat::Preserve));
+          }
+          state_[key] = std::move(state);
+        }
+        auto& state = static_cast<SGDParamState&>(*state_[key]);
+        // The kernel fills new buffers with the gradient
+        bool first_step = false;
+        if (momentum != 0 && !state.momentum_buffer().defined()) {
+          auto buf_options = state.master_param().defined() ? p.options().dtype(kFloat) : p.options();
+          state.momentum_buffer(torch::empty_like(p, buf_options, MemoryFormat::Preserve));
+          first_step = true;
+        }
+
+        auto& lists = fused_lists_for(fused_buckets, p, first_step);
+        lists.params.push_back(p);
+        lists.grads.push_back(d_p_list[i]);
+        if (momentum != 0) {
+          lists.momentum_buffers.push_back(state.momentum_buffer());
+        }
+        if (state.master_param().defined()) {
+          lists.master_params.push_back(state.master_param());
+        }
+      }
+      for (auto& lists : fused_buckets) {
+        TORCH_CHECK(lists.master_params.empty() || lists.master_params.size() == lists.params.size(),
+                    "The fused SGD step found Half or BFloat16 params without master params; "
+                    "these params were stepped before fused() was set");
+        torch::_fused_sgd_(lists.params, lists.grads, lists.momentum_buffers, lists.master_params,
+                           options.lr(), momentum, dampening, weight_decay, nesterov, lists.first_step);
       }
-      if (momentum != 0) {
-        Tensor buf;
-        auto param_state = state_.find(c10::guts::to_string(p.unsafeGetTensorImpl()));
+      continue;
+    }
+
+    if (weight_decay != 0) {
+      d_p_list = torch::_foreach_add(d_p_list, params_with_grad, weight_decay);
+    }
+    if (momentum != 0) {
+      // Buffers are created from the first gradient; the existing ones are
+      // updated together.
+      std::vector<Tensor> bufs;
+      std::vector<Tensor> existing_bufs;
+      std::vector<Tensor> existing_d_ps;
+      for (size_t i = 0; i < params_with_grad.size(); i++) {
+        auto key = c10::guts::to_string(params_with_grad[i].unsafeGetTensorImpl());
+        auto param_state = state_.find(key);
         if(param_state == state_.end()) {
-          buf = torch::clone(d_p).detach();
+          auto buf = torch::clone(d_p_list[i]).detach();
           auto state = std::make_unique<SGDParamState>();
           state->momentum_buffer(buf);
-          state_[c10::guts::to_string(p.unsafeGetTensorImpl())] = std::move(state);
-        } else {
-          buf = static_cast<SGDParamState&>(*param_state->second).momentum_buffer();
-          buf.mul_(momentum).add_(d_p, 1 - dampening);
-        }
-        if (nesterov) {
-          d_p = d_p.add(buf, momentum);
+          state_[key] = std::move(state);
+          bufs.push_back(buf);
         } else {
-          d_p = buf;
+          auto buf = static_cast<SGDParamState&>(*param_state->second).momentum_buffer();
+          existing_bufs.push_back(buf);
+          existing_d_ps.push_back(d_p_list[i]);
+          bufs.push_back(buf);
         }
       }
-      p.data().add_(d_p, -1 * options.lr());
+      if (!existing_bufs.empty()) {
+        torch::_foreach_mul_(existing_bufs, Scalar(momentum));
+        torch::_foreach_add_(existing_bufs, existing_d_ps, 1 - dampening);
+      }
+      if (nesterov) {
+        d_p_list = torch::_foreach_add(d_p_list, bufs, momentum);
+      } else {
+        d_p_list = bufs;
+      }
     }
+    torch::_foreach_add_(params_with_grad, d_p_list, -1 * options.lr());
   }
   return loss;
 }
@@ -55,6 +55,16 @@ inline void check_inplace(const Tensor& tensor) {
   }
 }
 
+inline void check_writeable(const Tensor& tensor) {
+  if (tensor.has_storage() &&
+      C10_UNLIKELY(tensor.storage().unsafeGetStorageImpl()->read_only())) {
+    AT_ERROR(
+      "a tensor on read-only memory, e.g. one created from a non-writeable NumPy "
+      "array, is being modified. You may want to copy it, or to make the array "
+      "writeable before converting it to a tensor.");
+  }
+}
+
 inline void throw_error_out_requires_grad(const char* name) {
   AT_ERROR(
       name, "(): functions with out=... arguments don't support automatic differentiation, "
@@ -3,6 +3,7 @@
 namespace torch { namespace autograd {
 
 bool AnomalyMode::_enabled = false;
+bool AnomalyMode::_nan_check_enabled = false;
 
 AnomalyMetadata::~AnomalyMetadata() = default;
 
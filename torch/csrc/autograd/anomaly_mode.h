@@ -13,8 +13,19 @@ struct TORCH_API AnomalyMode {
     _enabled = enabled;
   }
 
+  // Whether backward checks the outputs of the nodes for non-finite values
+  // once at the end, without the forward stack traces nor the check after
+  // every node of the full mode. See Note [Anomaly nan check] in engine.cpp.
+  static bool is_nan_check_enabled() {
+    return _nan_check_enabled;
+  }
+  static void set_nan_check_enabled(bool enabled) {
+    _nan_check_enabled = enabled;
+  }
+
 private:
   static bool _enabled;
+  static bool _nan_check_enabled;
 };
 
 
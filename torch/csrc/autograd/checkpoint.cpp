@@ -0,0 +1,151 @@
+#include <torch/csrc/autograd/checkpoint.h>
+
+#include <torch/csrc/autograd/grad_mode.h>
+
+#include <c10/util/Exception.h>
+
+namespace torch { namespace autograd {
+
+// The hooks of a variable saved in the forward pass of a region.
+struct CheckpointHooks : public SavedVariableHooks {
+  explicit CheckpointHooks(std::shared_ptr<CheckpointFrame> frame)
+    : frame_(std::move(frame)) {}
+
+  ~CheckpointHooks() override {
+    if (packed_ && !kept_.defined()) {
+      frame_->release(index_);
+    }
+  }
+
+  void call_pack_hook(at::Tensor tensor) override {
+    bool keep = false;
+    index_ = frame_->pack(tensor, keep);
+    packed_ = true;
+    if (keep) {
+      kept_ = std::move(tensor);
+    }
+  }
+
+  at::Tensor call_unpack_hook() override {
+    if (kept_.defined()) {
+      return kept_;
+    }
+    return frame_->unpack(index_);
+  }
+
+ private:
+  std::shared_ptr<CheckpointFrame> frame_;
+  size_t index_ = 0;
+  bool packed_ = false;
+  at::Tensor kept_;
+};
+
+// The hooks of a variable saved while recomputing a region, which hand the
+// data to the frame. The graph recorded by the recomputation is discarded.
+struct RecomputeHooks : public SavedVariableHooks {
+  explicit RecomputeHooks(CheckpointFrame* frame) : frame_(frame) {}
+
+  void call_pack_hook(at::Tensor tensor) override {
+    frame_->record(tensor);
+  }
+
+  at::Tensor call_unpack_hook() override {
+    TORCH_CHECK(false, "the graph recorded while recomputing a checkpointed region can't be used for backward");
+  }
+
+ private:
+  CheckpointFrame* frame_;
+};
+
+namespace {
+
+struct CheckpointHooksFactory : public SavedVariableHooksFactory {
+  explicit CheckpointHooksFactory(std::shared_ptr<CheckpointFrame> frame)
+    : frame_(std::move(frame)) {}
+
+  std::unique_ptr<SavedVariableHooks> make_hooks() const override {
+    return std::make_unique<CheckpointHooks>(frame_);
+  }
+
+ private:
+  std::shared_ptr<CheckpointFrame> frame_;
+};
+
+// Only installed by CheckpointFrame::unpack, which keeps the frame alive.
+struct RecomputeHooksFactory : public SavedVariableHooksFactory {
+  explicit RecomputeHooksFactory(CheckpointFrame* frame) : frame_(frame) {}
+
+  std::unique_ptr<SavedVariableHooks> make_hooks() const override {
+    return std::make_unique<RecomputeHooks>(frame_);
+  }
+
+ private:
+  CheckpointFrame* frame_;
+};
+
+} // namespace
+
+CheckpointFrame::CheckpointFrame(std::function<void()> recompute, std::vector<at::Tensor> inputs)
+  : recompute_(std::move(recompute)), inputs_(std::move(inputs)) {}
+
+std::shared_ptr<SavedVariableHooksFactory> CheckpointFrame::hooks() {
+  return std::make_shared<CheckpointHooksFactory>(shared_from_this());
+}
+
+bool CheckpointFrame::is_active() {
+  auto factory = SavedVariableDefaultHooks::get_hooks().get();
+  return dynamic_cast<CheckpointHooksFactory*>(factory) ||
+      dynamic_cast<RecomputeHooksFactory*>(factory);
+}
+
+size_t CheckpointFrame::pack(const at::Tensor& tensor, bool& keep) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  keep = false;
+  if (tensor.has_storage()) {
+    for (const auto& input : inputs_) {
+      if (input.defined() && input.has_storage() && tensor.storage().is_alias_of(input.storage())) {
+        keep = true;
+        break;
+      }
+    }
+  }
+  auto index = num_saved_++;
+  if (!keep) {
+    dropped_.emplace(index, at::Tensor());
+  }
+  return index;
+}
+
+void CheckpointFrame::record(const at::Tensor& tensor) {
+  auto index = num_recorded_++;
+  auto it = dropped_.find(index);
+  if (it != dropped_.end()) {
+    it->second = tensor;
+  }
+}
+
+at::Tensor CheckpointFrame::unpack(size_t index) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!recomputed_) {
+    num_recorded_ = 0;
+    {
+      SavedVariableHooksGuard recording(std::make_shared<RecomputeHooksFactory>(this));
+      AutoGradMode enable_grad(true);
+      recompute_();
+    }
+    TORCH_CHECK(num_recorded_ == num_saved_,
+        "a checkpointed region saved ", num_saved_, " tensors for backward in the forward pass, "
+        "but ", num_recorded_, " when recomputed; it must run the same operations both times");
+    recomputed_ = true;
+  }
+  auto it = dropped_.find(index);
+  TORCH_INTERNAL_ASSERT(it != dropped_.end() && it->second.defined());
+  return it->second;
+}
+
+void CheckpointFrame::release(size_t index) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  dropped_.erase(index);
+}
+
+}} // namespace torch::autograd
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+#include <torch/csrc/autograd/saved_variable_hooks.h>
+
+#include <ATen/ATen.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace torch { namespace autograd {
+
+/// A region of the forward pass whose saved variables are recomputed in
+/// backward instead of being kept, i.e., non-reentrant activation
+/// checkpointing: the region is recorded as usual, but every variable saved
+/// while the hooks of the frame are installed drops its data, unless the data
+/// shares storage with one of the `inputs` of the region, which backward
+/// keeps alive anyway.
+///
+/// The first time backward unpacks a dropped variable, `recompute` runs the
+/// region again, with grad mode enabled, and the variables it saves replace
+/// the dropped ones in the order they were saved. This happens inside the
+/// node that needs them, on the thread, device and stream the engine runs the
+/// node on, so no reentrant backward is involved and the rest of the graph,
+/// e.g., the hooks of DistributedDataParallel, sees the usual nodes.
+///
+/// `recompute` must save the same variables in the same order as the
+/// forward pass did, e.g., by restoring the RNG state it ran with.
+struct TORCH_API CheckpointFrame : public std::enable_shared_from_this<CheckpointFrame> {
+  CheckpointFrame(std::function<void()> recompute, std::vector<at::Tensor> inputs);
+
+  /// The factory to install while the region runs in the forward pass.
+  std::shared_ptr<SavedVariableHooksFactory> hooks();
+
+  /// Whether the variables saved on this thread go to a checkpoint frame,
+  /// either while its region runs or while it is recomputed. A region nested
+  /// in another one is simply run, so that it saves the same variables in
+  /// both cases.
+  static bool is_active();
+
+ private:
+  friend struct CheckpointHooks;
+  friend struct RecomputeHooks;
+
+  // Hands out the position of the next variable saved in the forward pass.
+  size_t pack(const at::Tensor& tensor, bool& keep);
+  at::Tensor unpack(size_t index);
+  void release(size_t index);
+  // Called for every variable saved while recomputing, with mutex_ held.
+  void record(const at::Tensor& tensor);
+
+  std::function<void()> recompute_;
+  std::vector<at::Tensor> inputs_;
+
+  std::mutex mutex_;
+  size_t num_saved_ = 0;
+  size_t num_recorded_ = 0;
+  bool recomputed_ = false;
+  // The dropped variables still referenced by the graph, and their data once
+  // the region was recomputed.
+  std::unordered_map<size_t, at::Tensor> dropped_;
+};
+
+}} // namespace torch::autograd
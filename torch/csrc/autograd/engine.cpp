@@ -5,6 +5,7 @@
 #include <torch/csrc/autograd/functions/basic_ops.h>
 #include <torch/csrc/autograd/grad_mode.h>
 #include <torch/csrc/autograd/anomaly_mode.h>
+#include <torch/csrc/autograd/saved_variable_hooks.h>
 #include <torch/csrc/autograd/variable.h>
 #include <torch/csrc/utils/memory.h>
 
@@ -17,8 +18,11 @@
 #include <c10/core/DeviceGuard.h>
 #include <c10/util/Optional.h>
 #include <c10/core/StreamGuard.h>
+#include <c10/core/impl/VirtualGuardImpl.h>
+#include <c10/core/thread_budget.h>
 
 #include <atomic>
+#include <cmath>
 #include <condition_variable>
 #include <cstdint>
 #include <functional>
@@ -97,6 +101,66 @@ static thread_local std::shared_ptr<GraphTask> current_graph_task = nullptr;
 // see Note [Reentrant backwards] for more details.
 static thread_local std::shared_ptr<ReadyQueue> local_ready_queue = nullptr;
 
+// Note [Local ready tasks]
+// ~~~~~~~~~~~~~~~~~~~~~~~~
+// Most of the tasks a worker makes ready are for its own ready queue, e.g.,
+// all of them in a CPU-only backward. Going through the ReadyQueue, those
+// take its lock twice and wake up no one, which dominates backward for graphs
+// of many tiny nodes. So while a worker runs thread_main, it keeps the tasks
+// it makes ready for its own queue in a heap of its own, without any lock,
+// and runs them before popping the shared queue. They are still counted in
+// the outstanding_tasks_ of their GraphTask from the start.
+//
+// Every thread_main call has its own heap, which it moves to the shared
+// queue when it exits. Before a reentrant backward blocks the worker, the
+// heap of the running thread_main is moved there as well, so that tasks are
+// never stuck behind a thread waiting on something else.
+namespace {
+
+struct LocalReadyTasks {
+  std::priority_queue<NodeTask, std::vector<NodeTask>, ReadyQueue::CompareNodeTaskTime> heap_;
+
+  // Moves the tasks to the shared ready queue of this thread.
+  void flush() {
+    while (!heap_.empty()) {
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+      auto task = std::move(const_cast<NodeTask&>(heap_.top())); heap_.pop();
+      local_ready_queue->push(std::move(task), /*incrementOutstandingTasks=*/false);
+    }
+  }
+};
+
+// The heap of the innermost thread_main running on this thread, if any.
+static thread_local LocalReadyTasks* local_ready_tasks = nullptr;
+
+struct LocalReadyTasksGuard {
+  LocalReadyTasksGuard() : prev_(local_ready_tasks) {
+    local_ready_tasks = &tasks_;
+  }
+  ~LocalReadyTasksGuard() {
+    tasks_.flush();
+    local_ready_tasks = prev_;
+  }
+
+  LocalReadyTasks tasks_;
+  LocalReadyTasks* prev_;
+};
+
+// Queues a task that just became ready, on the local heap if the task is for
+// the shared queue of this thread. See Note [Local ready tasks]
+void push_ready_task(ReadyQueue* queue, NodeTask task) {
+  if (local_ready_tasks && queue == local_ready_queue.get()) {
+    std::shared_ptr<GraphTask> graph_task = task.base_.lock();
+    TORCH_INTERNAL_ASSERT(graph_task, "GraphTask is no longer valid!");
+    ++graph_task->outstanding_tasks_;
+    local_ready_tasks->heap_.push(std::move(task));
+  } else {
+    queue->push(std::move(task));
+  }
+}
+
+} // namespace
+
 // Note [Reentrant backwards]
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~
 // To understand the reentrant backwards problem, we have to notice two
@@ -220,10 +284,16 @@ Engine::~Engine() {
   for (auto& queue: device_ready_queues_) {
     noBackward =  noBackward && queue->empty();
   }
+  for (auto& queue: cpu_worker_ready_queues_) {
+    noBackward =  noBackward && queue->empty();
+  }
   if (noBackward) {
     for (auto& queue : device_ready_queues_) {
      queue->pushShutdownTask();
     }
+    for (auto& queue : cpu_worker_ready_queues_) {
+     queue->pushShutdownTask();
+    }
     // Do not wait for termination of global threads on Windows
     // Because CRT terminates DLL threads before calling
     // global object destructors
@@ -344,6 +414,8 @@ auto Engine::thread_main(const std::shared_ptr<GraphTask>& graph_task) -> void {
 
   // local_ready_queue should already been initialized when we get into thread_main
   TORCH_INTERNAL_ASSERT(local_ready_queue != nullptr);
+  LocalReadyTasksGuard local_tasks_guard;
+  auto& local_tasks = local_tasks_guard.tasks_.heap_;
   while (graph_task == nullptr || !graph_task->future_result_->completed()) {
     // local_graph_task represents the graph_task we retrieve from the queue.
     // The outer graph_task represents the overall graph_task we need to execute
@@ -353,7 +425,14 @@ auto Engine::thread_main(const std::shared_ptr<GraphTask>& graph_task) -> void {
       // Scope this block of execution since NodeTask is not needed after this
       // block and can be deallocated (release any references to grad tensors
       // as part of inputs_).
-      NodeTask task = local_ready_queue->pop();
+      NodeTask task = [&] {
+        if (local_tasks.empty()) {
+          return local_ready_queue->pop();
+        }
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+        auto local_task = std::move(const_cast<NodeTask&>(local_tasks.top())); local_tasks.pop();
+        return local_task;
+      }();
       // This will only work if the worker is running a non backward task
       // TODO Needs to be fixed this to work in all cases
       if (task.isShutdownTask_) {
@@ -397,12 +476,14 @@ auto Engine::thread_main(const std::shared_ptr<GraphTask>& graph_task) -> void {
       // If it has work, it might see that graph_task->outstanding_tasks_ == 0
       // before it gets to the task, but it's a no-op anyway.
       //
-      // NB: This is not necessary if the current thread is the owning thread.
-      if (worker_device != base_owner) {
+      // NB: This is not necessary if the current thread works off the queue
+      // of the owning thread. Comparing queues rather than devices also
+      // wakes the owner when the task completes on a CPU worker thread.
+      auto owner_queue = ready_queue_by_index(local_graph_task->cpu_ready_queue_, base_owner);
+      if (owner_queue != local_ready_queue) {
         // Synchronize outstanding_tasks_ with queue mutex
         std::atomic_thread_fence(std::memory_order_release);
-        ready_queue_by_index(local_graph_task->cpu_ready_queue_, base_owner)
-            ->push(NodeTask(local_graph_task, nullptr, InputBuffer(0)));
+        owner_queue->push(NodeTask(local_graph_task, nullptr, InputBuffer(0)));
       }
     }
   }
@@ -509,6 +590,27 @@ void GraphTask::exec_post_processing() {
       default_stream.wait(event);
     }
   }
+
+  // See Note [Anomaly nan check]
+  for (const auto& stream_sum : nan_check_sums_) {
+    const auto& stream = stream_sum.first;
+    if (stream.device_type() != c10::DeviceType::CPU) {
+      const auto guard = c10::impl::VirtualGuardImpl{stream.device_type()};
+      const auto current_stream = guard.getStream(stream.device());
+      if (current_stream != stream) {
+        auto event = c10::Event{stream.device_type()};
+        event.record(stream);
+        current_stream.wait(event);
+      }
+    }
+    if (!std::isfinite(stream_sum.second.item<double>())) {
+      std::stringstream ss;
+      ss << "Anomaly nan check: a function returned non-finite values in backward on "
+         << stream.device() << ". Run the same step again under "
+         << "torch.autograd.detect_anomaly() to find which one.";
+      throw std::runtime_error(ss.str());
+    }
+  }
 }
 
 void GraphTask::set_exception_without_signal(const std::shared_ptr<Node>& fn) {
@@ -544,6 +646,37 @@ static variable_list call_post_hooks(Node& fn, variable_list outputs, const vari
   return outputs;
 }
 
+// Note [Anomaly nan check]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~
+// The nan check of anomaly mode doesn't check the outputs of every node as
+// the node runs, which would synchronize with the device after every node.
+// Every floating point output is summed in double precision instead, which
+// can only be non-finite if the output holds non-finite values, and the sums
+// are accumulated into a scalar per stream, on that stream. They are read
+// once, at the end of the graph task: a non-finite one means that a node
+// returned non-finite values, but not which node. Running the step again in
+// full anomaly mode tells which, see torch.autograd.detect_anomaly.
+static void accumulate_nan_check(GraphTask& graph_task, const variable_list& outputs) {
+  AutoGradMode grad_mode(false);
+  for (const auto& output : outputs) {
+    if (!output.defined() || output.layout() != c10::kStrided ||
+        !at::isFloatingType(output.scalar_type())) {
+      continue;
+    }
+    const auto device = output.device();
+    at::OptionalDeviceGuard guard(device);
+    const auto stream = c10::impl::VirtualGuardImpl{device.type()}.getStream(device);
+    auto sum = output.sum(at::kDouble);
+    std::lock_guard<std::mutex> lock(graph_task.mutex_);
+    auto it = graph_task.nan_check_sums_.find(stream);
+    if (it == graph_task.nan_check_sums_.end()) {
+      graph_task.nan_check_sums_.emplace(stream, std::move(sum));
+    } else {
+      it->second.add_(sum);
+    }
+  }
+}
+
 static bool is_compatible_type(const at::TensorOptions& expected, const at::TensorOptions& actual) {
   // Types are compatible if they exactly match or if the gradient is a sparse
   // version of the expected type.
@@ -690,6 +823,24 @@ static variable_list call_function(
   return outputs;
 }
 
+// Stores the inputs of a function that the GraphTask returns.
+static void capture_grads(
+    GraphTask& graph_task,
+    const GraphTask::ExecInfo& fn_info,
+    InputBuffer& inputs) {
+  if (auto* capture_vec = fn_info.captures_.get()) {
+    // Lock mutex for writing to graph_task.captured_vars_.
+    std::lock_guard<std::mutex> lock(graph_task.mutex_);
+    for (const auto& capture : *capture_vec) {
+      auto& captured_grad = graph_task.captured_vars_[capture.output_idx_];
+      captured_grad = inputs[capture.input_idx_];
+      for (auto& hook : capture.hooks_) {
+        captured_grad = (*hook)(captured_grad);
+      }
+    }
+  }
+}
+
 void Engine::evaluate_function(
     std::shared_ptr<GraphTask>& graph_task,
     Node* func,
@@ -699,17 +850,7 @@ void Engine::evaluate_function(
   auto& exec_info_ = graph_task->exec_info_;
   if (!exec_info_.empty()) {
     auto& fn_info = exec_info_.at(func);
-    if (auto* capture_vec = fn_info.captures_.get()) {
-      // Lock mutex for writing to graph_task->captured_vars_.
-      std::lock_guard<std::mutex> lock(graph_task->mutex_);
-      for (const auto& capture : *capture_vec) {
-        auto& captured_grad = graph_task->captured_vars_[capture.output_idx_];
-        captured_grad = inputs[capture.input_idx_];
-        for (auto& hook : capture.hooks_) {
-          captured_grad = (*hook)(captured_grad);
-        }
-      }
-    }
+    capture_grads(*graph_task, fn_info, inputs);
     if (!fn_info.needed_) {
       // Skip execution if we don't need to execute the function.
       return;
@@ -718,7 +859,37 @@ void Engine::evaluate_function(
 
   // Switches to a function's CUDA stream (if applicable) before calling it
   const auto opt_parent_stream = (*func).stream(c10::DeviceType::CUDA);
-  c10::OptionalStreamGuard parent_stream_guard{opt_parent_stream};
+  // See Note [Multi-stream backward]
+  auto opt_exec_stream = opt_parent_stream;
+  if (opt_parent_stream && multi_stream_enabled_.load()) {
+    const auto guard = c10::impl::VirtualGuardImpl{c10::DeviceType::CUDA};
+    opt_exec_stream = guard.getStreamFromPool(opt_parent_stream->device());
+    if (!inputs.ready_event()) {
+      inputs.record_ready_event(*opt_parent_stream);
+    }
+    opt_exec_stream->wait(*inputs.ready_event());
+    inputs.record_stream(*opt_exec_stream);
+  }
+  c10::OptionalStreamGuard parent_stream_guard{opt_exec_stream};
+
+  // The functions that take the outputs of this one run after it, so their
+  // saved variables can be brought back while this one runs. Prefetching the
+  // next functions of each function as it runs issues the prefetches in the
+  // order of the graph traversal. See saved_variable_hooks.h.
+  if (SavedVariableDefaultHooks::ever_used()) {
+    for (const auto& next : func->next_edges()) {
+      if (!next.is_valid()) {
+        continue;
+      }
+      if (!exec_info_.empty()) {
+        auto it = exec_info_.find(next.function.get());
+        if (it == exec_info_.end() || !it->second.should_execute()) {
+          continue;
+        }
+      }
+      next.function->prefetch_variables();
+    }
+  }
 
   auto outputs = call_function(graph_task, func, inputs);
 
@@ -727,6 +898,21 @@ void Engine::evaluate_function(
     fn.release_variables();
   }
 
+  if (opt_exec_stream != opt_parent_stream) {
+    // Joins the function's stream back: the rest of the engine sees the
+    // outputs as produced on the function's own stream.
+    const auto guard = c10::impl::VirtualGuardImpl{c10::DeviceType::CUDA};
+    for (const auto& output : outputs) {
+      if (output.defined() && output.has_storage() &&
+          output.device() == opt_parent_stream->device()) {
+        guard.recordDataPtrOnStream(output.storage().data_ptr(), *opt_parent_stream);
+      }
+    }
+    auto event = c10::Event{c10::DeviceType::CUDA};
+    event.record(*opt_exec_stream);
+    opt_parent_stream->wait(event);
+  }
+
   int num_outputs = outputs.size();
   if (num_outputs == 0) { // Note: doesn't acquire the mutex
     // Records leaf stream (if applicable)
@@ -749,8 +935,29 @@ void Engine::evaluate_function(
         throw std::runtime_error(ss.str());
       }
     }
+  } else if (AnomalyMode::is_nan_check_enabled()) {
+    accumulate_nan_check(*graph_task, outputs);
   }
 
+  // The task made ready for each device goes to the queue of that device.
+  // When the CPU nodes are spread across CPU worker threads, the first CPU
+  // task stays on this thread if it is a CPU one, and the others, i.e., the
+  // other branches of the graph, go to the workers in turn.
+  // See Note [Parallel CPU backward]
+  bool kept_cpu_task = false;
+  auto queue_for = [&](const InputBuffer& input_buffer) -> ReadyQueue* {
+    const auto device = input_buffer.device();
+    if (device.type() != at::kCPU || !graph_task->cpu_worker_queues_) {
+      return ready_queue(cpu_ready_queue, device).get();
+    }
+    if (!kept_cpu_task && worker_device == CPU_DEVICE) {
+      kept_cpu_task = true;
+      return local_ready_queue.get();
+    }
+    const auto& worker_queues = *graph_task->cpu_worker_queues_;
+    return worker_queues[graph_task->next_cpu_worker_++ % worker_queues.size()].get();
+  };
+
   // Lock mutex for the accesses to GraphTask dependencies_, not_ready_ and cpu_ready_queue_ below
   std::lock_guard<std::mutex> lock(graph_task->mutex_);
   for (int i = 0; i < num_outputs; ++i) {
@@ -793,8 +1000,11 @@ void Engine::evaluate_function(
                        opt_next_stream);
 
       if (is_ready) {
-        auto queue = ready_queue(cpu_ready_queue, input_buffer.device());
-        queue->push(
+        if (opt_next_stream && multi_stream_enabled_.load()) {
+          input_buffer.record_ready_event(*opt_next_stream);
+        }
+        push_ready_task(
+            queue_for(input_buffer),
             NodeTask(graph_task, next.function, std::move(input_buffer)));
       } else {
         not_ready.emplace(next.function.get(), std::move(input_buffer));
@@ -810,8 +1020,11 @@ void Engine::evaluate_function(
                        opt_parent_stream,
                        opt_next_stream);
       if (is_ready) {
-        auto queue = ready_queue(cpu_ready_queue, input_buffer.device());
-        queue->push(
+        if (opt_next_stream && multi_stream_enabled_.load()) {
+          input_buffer.record_ready_event(*opt_next_stream);
+        }
+        push_ready_task(
+            queue_for(input_buffer),
             NodeTask(graph_task, next.function, std::move(input_buffer)));
         not_ready.erase(not_ready_it);
       }
@@ -821,23 +1034,274 @@ void Engine::evaluate_function(
 
 /* Computes the number of dependencies for each function which requires grad */
 auto Engine::compute_dependencies(Node* root, GraphTask& task) -> void {
-  // Just to make sure that they will never be added to the queue again
-  std::unordered_set<Node*> seen;
   std::vector<Node*> queue { root };
 
   // Queue contains all nodes that will start propagating gradients.
   // We no longer have to expand functions that don't require grad.
+  // A function is in dependencies once it has been seen, which makes sure
+  // that it will never be added to the queue again, with a single lookup per
+  // edge.
   auto& dependencies = task.dependencies_;
   while (!queue.empty()) {
     auto fn = queue.back(); queue.pop_back();
     for (const auto& edge : fn->next_edges()) {
       if (auto next_ptr = edge.function.get()) {
-        dependencies[next_ptr] += 1;
-        const bool was_inserted = seen.insert(next_ptr).second;
-        if (was_inserted) queue.push_back(next_ptr);
+        auto it = dependencies.emplace(next_ptr, 0).first;
+        if (it->second++ == 0) {
+          queue.push_back(next_ptr);
+        }
+      }
+    }
+  }
+}
+
+// Note [Cached backward schedules]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// In a training loop of static shapes, every backward call runs a graph of
+// the same structure, from which compute_dependencies, the ready queues and
+// the not_ready_ buffers derive the same schedule every time. With schedule
+// caching enabled, a top-level backward call instead numbers the nodes of
+// the graph in breadth-first order from its root and records its structure:
+// the type of every node and the (node, input) that each of its edges points
+// to. The first time a structure is seen, the engine computes an order of its
+// nodes that the dynamic schedule could have picked, i.e., a topological
+// order that prefers the nodes created last, and caches it under the
+// structure. Backward calls on a graph of the same structure then run the
+// nodes in that order on the calling thread, accumulating the inputs of each
+// node in an InputBuffer of its own, without counting dependencies or
+// queueing tasks.
+//
+// Only graphs whose nodes all take CPU inputs are replayed, as the nodes of
+// the other devices run on their device threads, on their streams. Neither
+// does replay apply in anomaly mode, including its nan check, with the CPU
+// worker threads of Note [Parallel CPU backward] or to reentrant backward
+// calls, which all take the dynamic path. GraphTask::exec_info_ is honored as in evaluate_function.
+struct GraphTopology {
+  std::vector<Node*> nodes;
+  // The index of the node that each edge of each node points to, or -1 for an
+  // invalid edge. The edges of node i are [edge_offsets[i], edge_offsets[i + 1]).
+  std::vector<int> edge_targets;
+  std::vector<size_t> edge_offsets;
+  std::vector<uint64_t> signature;
+  uint64_t hash = 0;
+  bool all_cpu = true;
+};
+
+struct BackwardSchedule {
+  std::vector<uint64_t> signature;
+  std::vector<int> order;
+};
+
+// Caching a schedule per distinct structure, a loop of a few graphs of
+// different structures stays cached; anything beyond is likely dynamic.
+static constexpr size_t kMaxCachedSchedules = 64;
+
+static GraphTopology compute_topology(Node* root) {
+  GraphTopology topology;
+  std::unordered_map<Node*, int> index;
+  index.emplace(root, 0);
+  topology.nodes.push_back(root);
+  auto record = [&](uint64_t value) {
+    topology.signature.push_back(value);
+    topology.hash = topology.hash * 1000003 ^ value;
+  };
+  // nodes grows while it is traversed, which makes it the queue of a
+  // breadth-first traversal.
+  for (size_t i = 0; i < topology.nodes.size(); ++i) {
+    Node* fn = topology.nodes[i];
+    topology.edge_offsets.push_back(topology.edge_targets.size());
+    for (size_t k = 0; k < fn->num_inputs(); ++k) {
+      if (fn->input_metadata(k).device().type() != at::kCPU) {
+        topology.all_cpu = false;
+      }
+    }
+    record(typeid(*fn).hash_code());
+    record(fn->num_inputs());
+    record(fn->num_outputs());
+    for (const auto& edge : fn->next_edges()) {
+      int target = -1;
+      if (auto next_ptr = edge.function.get()) {
+        auto it = index.emplace(next_ptr, topology.nodes.size());
+        if (it.second) {
+          topology.nodes.push_back(next_ptr);
+        }
+        target = it.first->second;
+      }
+      topology.edge_targets.push_back(target);
+      record(static_cast<uint64_t>(target));
+      record(edge.input_nr);
+    }
+  }
+  topology.edge_offsets.push_back(topology.edge_targets.size());
+  return topology;
+}
+
+// A topological order of the nodes that runs the ready node created last
+// first, like the ReadyQueue.
+static std::vector<int> compute_schedule_order(const GraphTopology& topology) {
+  const auto& nodes = topology.nodes;
+  std::vector<int> dependencies(nodes.size(), 0);
+  for (int target : topology.edge_targets) {
+    if (target >= 0) {
+      ++dependencies[target];
+    }
+  }
+  auto created_before = [&](int a, int b) {
+    return nodes[a]->sequence_nr() < nodes[b]->sequence_nr();
+  };
+  std::priority_queue<int, std::vector<int>, decltype(created_before)> ready(created_before);
+  ready.push(0);
+  std::vector<int> order;
+  order.reserve(nodes.size());
+  while (!ready.empty()) {
+    const int i = ready.top();
+    ready.pop();
+    order.push_back(i);
+    for (size_t e = topology.edge_offsets[i]; e < topology.edge_offsets[i + 1]; ++e) {
+      const int target = topology.edge_targets[e];
+      if (target >= 0 && --dependencies[target] == 0) {
+        ready.push(target);
+      }
+    }
+  }
+  TORCH_INTERNAL_ASSERT(order.size() == nodes.size());
+  return order;
+}
+
+void Engine::set_schedule_caching_enabled(bool enabled) {
+  schedule_caching_enabled_.store(enabled);
+  if (!enabled) {
+    std::lock_guard<std::mutex> lock(schedule_cache_mutex_);
+    schedule_cache_.clear();
+  }
+}
+
+bool Engine::is_schedule_caching_enabled() const {
+  return schedule_caching_enabled_.load();
+}
+
+// Note [Multi-stream backward]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// A device thread runs the nodes of its device one after the other, and by
+// Note [Streaming backwards] each node queues its kernels on the stream of
+// its forward, so the backward of independent branches that ran on one
+// stream in forward serializes on the GPU even when each kernel only fills
+// a fraction of it. Once set_multi_stream_enabled(true) was called, each
+// CUDA node instead runs on a stream from the pool of its device:
+//
+//   - When a node becomes ready, an event is recorded on its own stream,
+//     which its inputs were accumulated on. The node's pooled stream waits
+//     on that event, so nodes that were ready at the same time don't wait
+//     for each other.
+//   - The inputs are marked as used on the pooled stream. This keeps the
+//     caching allocator from reusing their memory while the node still
+//     reads it.
+//   - After the node, its own stream waits on the pooled stream, and the
+//     outputs are marked as used on its own stream. This joins the node
+//     back: its saved variables, released meanwhile, and its outputs are
+//     only reused after the node is done. The rest of the engine, i.e. the
+//     accumulation of the outputs and the leaf streams, then sees the
+//     outputs as produced on the node's own stream, as without this mode.
+//
+// The mode costs two events per node, so it only pays off for graphs of
+// independent branches of small kernels.
+void Engine::set_multi_stream_enabled(bool enabled) {
+  multi_stream_enabled_.store(enabled);
+}
+
+bool Engine::is_multi_stream_enabled() const {
+  return multi_stream_enabled_.load();
+}
+
+auto Engine::cached_schedule(const GraphTopology& topology) -> std::shared_ptr<const BackwardSchedule> {
+  std::lock_guard<std::mutex> lock(schedule_cache_mutex_);
+  auto it = schedule_cache_.find(topology.hash);
+  if (it != schedule_cache_.end() && it->second->signature == topology.signature) {
+    return it->second;
+  }
+  auto schedule = std::make_shared<BackwardSchedule>();
+  schedule->signature = topology.signature;
+  schedule->order = compute_schedule_order(topology);
+  if (schedule_cache_.size() >= kMaxCachedSchedules) {
+    schedule_cache_.clear();
+  }
+  // A structure whose hash collides with a cached one replaces it.
+  schedule_cache_[topology.hash] = schedule;
+  return schedule;
+}
+
+auto Engine::execute_with_schedule(
+    const std::shared_ptr<GraphTask>& graph_task,
+    const GraphTopology& topology,
+    const BackwardSchedule& schedule) -> std::shared_ptr<FutureVariableList> {
+  // Like in execute_with_graph_task, this makes backward calls of the nodes
+  // reentrant ones.
+  set_device(CPU_DEVICE);
+  graph_task->owner_ = worker_device;
+  {
+    GraphTaskGuard guard(graph_task);
+    AutoGradMode grad_mode(graph_task->grad_mode_);
+    auto task = graph_task;
+    auto& exec_info = graph_task->exec_info_;
+    auto should_execute = [&](Node* fn) {
+      if (exec_info.empty()) {
+        return true;
+      }
+      auto it = exec_info.find(fn);
+      return it != exec_info.end() && it->second.should_execute();
+    };
+
+    std::vector<InputBuffer> buffers;
+    buffers.reserve(topology.nodes.size());
+    for (Node* fn : topology.nodes) {
+      buffers.emplace_back(fn->num_inputs());
+    }
+
+    Node* fn = nullptr;
+    try {
+      for (int i : schedule.order) {
+        fn = topology.nodes[i];
+        auto& inputs = buffers[i];
+        if (!exec_info.empty()) {
+          auto it = exec_info.find(fn);
+          if (it == exec_info.end()) {
+            continue;
+          }
+          capture_grads(*graph_task, it->second, inputs);
+          if (!it->second.needed_) {
+            continue;
+          }
+        }
+        if (SavedVariableDefaultHooks::ever_used()) {
+          for (const auto& next : fn->next_edges()) {
+            if (next.is_valid() && should_execute(next.function.get())) {
+              next.function->prefetch_variables();
+            }
+          }
+        }
+
+        auto outputs = call_function(task, fn, inputs);
+        if (!graph_task->keep_graph_) {
+          fn->release_variables();
+        }
+
+        const size_t edges_begin = topology.edge_offsets[i];
+        for (size_t k = 0; k < outputs.size(); ++k) {
+          const int target = topology.edge_targets[edges_begin + k];
+          if (target < 0 || !should_execute(topology.nodes[target])) {
+            continue;
+          }
+          buffers[target].add(
+              fn->next_edge(k).input_nr, std::move(outputs[k]), c10::nullopt, c10::nullopt);
+        }
       }
+    } catch (std::exception& e) {
+      thread_on_exception(graph_task, fn->shared_from_this(), e);
     }
   }
+  graph_task->mark_as_completed_and_run_post_processing();
+  worker_device = NO_DEVICE;
+  return graph_task->future_result_;
 }
 
 auto Engine::execute(const edge_list& roots,
@@ -865,6 +1329,21 @@ auto Engine::execute(const edge_list& roots,
 
   // Now compute the dependencies for all executable functions and queue the root
   auto graph_root = std::make_shared<GraphRoot>(roots, inputs);
+
+  // See Note [Cached backward schedules]
+  if (not_reentrant_backward_call && schedule_caching_enabled_.load() &&
+      !AnomalyMode::is_enabled() && !AnomalyMode::is_nan_check_enabled() &&
+      num_cpu_threads() == 0) {
+    auto topology = compute_topology(graph_root.get());
+    if (topology.all_cpu) {
+      auto schedule = cached_schedule(topology);
+      if (!outputs.empty()) {
+        graph_task->init_to_execute(*graph_root, outputs);
+      }
+      return execute_with_schedule(graph_task, topology, *schedule)->wait();
+    }
+  }
+
   compute_dependencies(graph_root.get(), *graph_task);
 
   if (!outputs.empty()) {
@@ -902,6 +1381,9 @@ std::shared_ptr<FutureVariableList> Engine::execute_with_graph_task(
 
     // set the graph_task owner to the current device
     graph_task->owner_ = worker_device;
+    // Only the top-level backward calls spread across the CPU workers,
+    // reentrant ones run where they are called.
+    graph_task->cpu_worker_queues_ = cpu_worker_queues();
 
     // The owning thread start to drive the engine execution with the GraphTask
     // that has already been pushed to the current CPU thread's ready_queue
@@ -917,6 +1399,11 @@ std::shared_ptr<FutureVariableList> Engine::execute_with_graph_task(
     // If worker_device is any devices (i.e. CPU, CUDA): this is a re-entrant
     //    backward call from that device.
     graph_task->owner_ = worker_device;
+    // This thread blocks until the new graph_task completes.
+    // See Note [Local ready tasks]
+    if (local_ready_tasks) {
+      local_ready_tasks->flush();
+    }
     if (current_depth >= max_recursion_depth_) {
       // See Note [Reentrant backwards]
       // If reached the max depth, switch to a different thread
@@ -1043,6 +1530,9 @@ auto Engine::start_device_threads() -> void {
 
   thread_pool_shared_ = std::make_shared<ThreadPoolShared>();
 
+  // Every device needs its thread, so they are counted but not capped.
+  c10::ThreadBudget::global().acquire(
+      c10::ThreadPoolKind::Autograd, num_devices, /* minimum */ num_devices);
   for (int i = 0; i < num_devices; ++i) {
     std::thread t(&Engine::thread_init, this, i, device_ready_queues_[i], true);
     t.detach();
@@ -1056,6 +1546,71 @@ auto Engine::start_device_threads() -> void {
   }
 }
 
+// Note [Parallel CPU backward]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// By default, all the CPU nodes of a backward call run on the thread that
+// called it, so a graph of independent branches, e.g., of a model with many
+// towers, is backpropagated through one branch after the other. Once
+// set_num_cpu_threads(n) set n > 0, the engine starts n CPU worker threads,
+// each with a ready queue of its own, which it serves like a device thread.
+// A node that makes several CPU nodes ready then keeps the first one on its
+// thread and hands the others to the workers in turn, so that a chain stays
+// on one thread while the branches fan out across the workers. Everything
+// else is unchanged: the dependencies and the exec_info_ of the GraphTask
+// are handled under its mutex as for device threads, and finishing the graph
+// task on a worker wakes up the owner like from a device thread.
+//
+// Only top-level backward calls are spread across the workers. A reentrant
+// backward, e.g., of checkpointing, runs on the thread that calls it as
+// before, which is what the owner of a graph task waiting on its ready queue
+// relies on (see Note [Reentrant backwards]).
+void Engine::set_num_cpu_threads(int num_threads) {
+  TORCH_CHECK(num_threads >= 0, "number of CPU backward threads must be non-negative, but got ", num_threads);
+  std::lock_guard<std::mutex> lock(cpu_workers_mutex_);
+  num_cpu_threads_ = num_threads;
+  active_cpu_worker_queues_ = nullptr;
+}
+
+int Engine::num_cpu_threads() {
+  std::lock_guard<std::mutex> lock(cpu_workers_mutex_);
+  return num_cpu_threads_;
+}
+
+auto Engine::cpu_worker_queues() -> std::shared_ptr<const std::vector<std::shared_ptr<ReadyQueue>>> {
+  std::lock_guard<std::mutex> lock(cpu_workers_mutex_);
+  if (num_cpu_threads_ == 0) {
+    return nullptr;
+  }
+  if (!active_cpu_worker_queues_) {
+    // The threads are started lazily from here rather than from
+    // set_num_cpu_threads, as the Python engine releases the GIL that their
+    // initialization needs only during execution.
+    // The workers are optional, so the thread budget may grant fewer of them,
+    // down to none, in which case the backward runs on the calling thread.
+    size_t num_new_workers = 0;
+    if (cpu_worker_ready_queues_.size() < static_cast<size_t>(num_cpu_threads_)) {
+      num_new_workers = c10::ThreadBudget::global().acquire(
+          c10::ThreadPoolKind::Autograd,
+          num_cpu_threads_ - cpu_worker_ready_queues_.size(),
+          /* minimum */ 0);
+    }
+    for (size_t i = 0; i < num_new_workers; ++i) {
+      auto queue = std::make_shared<ReadyQueue>();
+      std::thread t(&Engine::thread_init, this, CPU_DEVICE, queue, true);
+      t.detach();
+      cpu_worker_ready_queues_.push_back(std::move(queue));
+    }
+    auto num_workers = std::min(
+        cpu_worker_ready_queues_.size(), static_cast<size_t>(num_cpu_threads_));
+    if (num_workers == 0) {
+      return nullptr;
+    }
+    active_cpu_worker_queues_ = std::make_shared<const std::vector<std::shared_ptr<ReadyQueue>>>(
+        cpu_worker_ready_queues_.begin(), cpu_worker_ready_queues_.begin() + num_workers);
+  }
+  return active_cpu_worker_queues_;
+}
+
 void Engine::add_thread_pool_task(const std::weak_ptr<GraphTask>& graph_task) {
   std::unique_lock<std::mutex> lck(thread_pool_shared_->mutex_);
   // There may already be some items on the graphtasks_queue_ added by other
@@ -1066,6 +1621,9 @@ void Engine::add_thread_pool_task(const std::weak_ptr<GraphTask>& graph_task) {
   // Don't need to be holding the lock while actually creating the thread
   lck.unlock();
   if (create_thread) {
+    // Reentrant backwards wait for these threads, so they are not capped.
+    c10::ThreadBudget::global().acquire(
+        c10::ThreadPoolKind::Autograd, 1, /* minimum */ 1);
     std::thread t(&Engine::reentrant_thread_init, this);
     t.detach();
   }
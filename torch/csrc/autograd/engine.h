@@ -24,6 +24,8 @@
 
 namespace torch { namespace autograd {
 struct ReadyQueue;
+struct GraphTopology;
+struct BackwardSchedule;
 }} // namespace torch::autograd
 
 namespace torch { namespace autograd {
@@ -111,6 +113,10 @@ struct GraphTask: std::enable_shared_from_this<GraphTask> {
 
   std::unordered_set<c10::Stream> leaf_streams;
 
+  // The sums of the outputs of the nodes, per stream they were computed on,
+  // protected by mutex_. See Note [Anomaly nan check]
+  std::unordered_map<c10::Stream, at::Tensor> nan_check_sums_;
+
   void init_to_execute(Node& graph_root, const edge_list& outputs);
 
   // The value of worker_device in the thread that created this task.
@@ -120,6 +126,14 @@ struct GraphTask: std::enable_shared_from_this<GraphTask> {
   // The number of parent graph tasks for this graph task
   const int reentrant_depth_;
 
+  // The ready queues of the CPU worker threads that the CPU nodes of this
+  // graph task are spread across, or nullptr if they all run on the owner
+  // thread. Safe to read without synchronization after the task is started.
+  // See Note [Parallel CPU backward]
+  std::shared_ptr<const std::vector<std::shared_ptr<ReadyQueue>>> cpu_worker_queues_;
+  // The CPU worker to hand the next branch to, protected by mutex_.
+  size_t next_cpu_worker_ = 0;
+
   bool can_checkpoint() {
     return exec_info_.empty();
   }
@@ -217,7 +231,6 @@ struct NodeTask {
 
 
 struct ReadyQueue {
- private:
   // Returns true when t2 should be (weakly) BEFORE t1 in the queue.
   // Shutdown tasks are first and then empty NodeTask are next.
   struct CompareNodeTaskTime {
@@ -236,6 +249,7 @@ struct ReadyQueue {
     }
   };
 
+ private:
   // To notify threads waiting on the ReadyQueue of available tasks on the heap_
   std::condition_variable not_empty_;
   // To protect read and writes to heap_
@@ -312,6 +326,25 @@ struct TORCH_API Engine {
   // Should be called after fork to notify that worker threads are gone
   void release_workers();
 
+  // Sets the number of CPU worker threads that the independent branches of
+  // a backward call run on, in addition to the calling thread. 0, the
+  // default, runs all CPU nodes on the calling thread.
+  // See Note [Parallel CPU backward]
+  void set_num_cpu_threads(int num_threads);
+  int num_cpu_threads();
+
+  // Enables running backward calls of a graph structure seen before in the
+  // order recorded for it, without dynamic scheduling.
+  // See Note [Cached backward schedules]
+  void set_schedule_caching_enabled(bool enabled);
+  bool is_schedule_caching_enabled() const;
+
+  // Enables running the CUDA nodes of backward calls on streams from the
+  // pool, so that the kernels of independent nodes overlap.
+  // See Note [Multi-stream backward]
+  void set_multi_stream_enabled(bool enabled);
+  bool is_multi_stream_enabled() const;
+
   // Initializes a device thread for the autograd engine.
   virtual void thread_init(
       int device,
@@ -336,6 +369,17 @@ struct TORCH_API Engine {
   // start device threads (CUDA, XLA, etc.) in Engine,
   // note that it does NOT start CPU thread.
   void start_device_threads();
+  // Returns the ready queues of the CPU worker threads that a new graph task
+  // should use, starting the threads as needed.
+  std::shared_ptr<const std::vector<std::shared_ptr<ReadyQueue>>> cpu_worker_queues();
+  // Returns the schedule cached for the structure of topology, computing it
+  // the first time.
+  std::shared_ptr<const BackwardSchedule> cached_schedule(const GraphTopology& topology);
+  // Runs graph_task on the calling thread in the order of schedule.
+  std::shared_ptr<FutureVariableList> execute_with_schedule(
+      const std::shared_ptr<GraphTask>& graph_task,
+      const GraphTopology& topology,
+      const BackwardSchedule& schedule);
   void increment_non_reentrant_thread_count();
   void decrement_non_reentrant_thread_count();
   virtual void thread_main(const std::shared_ptr<GraphTask>& task);
@@ -347,6 +391,21 @@ struct TORCH_API Engine {
   // Safe to read device_ready_queues_ without synchronization after initialization
   std::vector<std::shared_ptr<ReadyQueue>> device_ready_queues_;
 
+  // The ready queues of all the CPU worker threads started so far, which
+  // only ever grow, and the number of them that new graph tasks use.
+  // Protected by cpu_workers_mutex_.
+  std::vector<std::shared_ptr<ReadyQueue>> cpu_worker_ready_queues_;
+  int num_cpu_threads_ = 0;
+  std::shared_ptr<const std::vector<std::shared_ptr<ReadyQueue>>> active_cpu_worker_queues_;
+  std::mutex cpu_workers_mutex_;
+
+  std::atomic<bool> schedule_caching_enabled_{false};
+  std::atomic<bool> multi_stream_enabled_{false};
+  // The schedules of the graph structures seen so far, by hash of their
+  // structure. Protected by schedule_cache_mutex_.
+  std::unordered_map<uint64_t, std::shared_ptr<const BackwardSchedule>> schedule_cache_;
+  std::mutex schedule_cache_mutex_;
+
   std::vector<std::function<void()>> final_callbacks_;
   // To protect reads and writes to final_callbacks_
   std::mutex post_callbacks_lock_;
@@ -307,6 +307,11 @@ struct TORCH_API Node : std::enable_shared_from_this<Node> {
   /// Releases saved variables if the operation won't be reused.
   virtual void release_variables() {}
 
+  /// Lets the hooks of saved variables bring their data back before an apply.
+  /// The engine calls it for the functions that run after the one it is about
+  /// to apply. See saved_variable_hooks.h.
+  virtual void prefetch_variables() {}
+
   /// Called before an apply if `release_variables()` is going to be called.
   /// Allows larger ops like `InterpreterAutogradFunction` to incrementally
   /// release variables as they run.
@@ -5,7 +5,11 @@
 #include <torch/csrc/autograd/grad_mode.h>
 #include <ATen/autocast_mode.h>
 #include <torch/csrc/autograd/profiler.h>
+#include <torch/csrc/autograd/profiler_utils.h>
 #include <torch/csrc/autograd/python_function.h>
+#include <torch/csrc/autograd/python_saved_variable_hooks.h>
+#include <torch/csrc/autograd/checkpoint.h>
+#include <torch/csrc/autograd/engine.h>
 #include <torch/csrc/autograd/function.h>
 
 PyObject* THPAutograd_initExtension(PyObject* _unused, PyObject *unused) {
@@ -34,16 +38,21 @@ PyObject* THPAutograd_initExtension(PyObject* _unused, PyObject *unused) {
       .value("Disabled", ProfilerState::Disabled)
       .value("CPU", ProfilerState::CPU)
       .value("CUDA", ProfilerState::CUDA)
-      .value("NVTX", ProfilerState::NVTX);
+      .value("NVTX", ProfilerState::NVTX)
+      .value("CUPTI", ProfilerState::CUPTI);
 
   py::class_<ProfilerConfig>(m, "ProfilerConfig")
-      .def(py::init<ProfilerState, bool, bool>());
+      .def(py::init<ProfilerState, bool, bool>())
+      .def(py::init<ProfilerState, bool, bool, uint64_t>())
+      .def(py::init<ProfilerState, bool, bool, uint64_t, bool>())
+      .def(py::init<ProfilerState, bool, bool, uint64_t, bool, bool>());
 
   py::class_<Event>(m, "ProfilerEvent")
       .def("kind", &Event::kind)
       .def("name", [](const Event& e) { return e.name(); })
       .def("thread_id", &Event::thread_id)
       .def("device", &Event::device)
+      .def("stream", &Event::stream)
       .def("cpu_elapsed_us", &Event::cpu_elapsed_us)
       .def("cuda_elapsed_us", &Event::cuda_elapsed_us)
       .def("has_cuda", &Event::has_cuda)
@@ -53,29 +62,90 @@ PyObject* THPAutograd_initExtension(PyObject* _unused, PyObject *unused) {
       .def("handle", &Event::handle)
       .def("node_id", &Event::node_id)
       .def("is_remote", &Event::isRemote)
-      .def("sequence_nr", &Event::sequence_nr);
+      .def("sequence_nr", &Event::sequence_nr)
+      .def("device_elapsed_us", &Event::device_elapsed_us)
+      .def("memory_ptr", &Event::memory_ptr)
+      .def("flops", &Event::flops)
+      .def("bytes_moved", &Event::bytes_moved)
+      .def("perf_counters", &Event::perf_counters);
 
   m.def("_enable_profiler", enableProfiler);
   m.def("_disable_profiler", disableProfiler);
   m.def("_profiler_enabled", profilerEnabled);
+  m.def("_cupti_available", cuptiAvailable);
+  m.def("_perf_counters_available", perfCountersAvailable);
   m.def("_enable_record_function", [](bool enable) {
     at::enableRecordFunction(enable);
   });
-  m.def("_set_empty_test_observer", [](bool is_global, double sampling_prob) {
+  m.def("_set_empty_test_observer", [](bool is_global, double sampling_prob, uint64_t sampling_every) {
     auto cb = at::RecordFunctionCallback(
         [](const at::RecordFunction&) {},
         [](const at::RecordFunction&) {})
-      .needsInputs(true)
-      .samplingProb(sampling_prob);
+      .needsInputs(true);
+    if (sampling_every != 1) {
+      cb.samplingEvery(sampling_every);
+    } else {
+      cb.samplingProb(sampling_prob);
+    }
     if (is_global) {
       at::addGlobalCallback(cb);
     } else {
       at::addThreadLocalCallback(cb);
     }
-  });
+  }, py::arg("is_global"), py::arg("sampling_prob"), py::arg("sampling_every") = 1);
   m.def("_clear_callbacks", []() {
     at::clearCallbacks();
   });
+  m.def("_set_num_cpu_backward_threads", [](int num_threads) {
+    torch::autograd::Engine::get_default_engine().set_num_cpu_threads(num_threads);
+  });
+  m.def("_get_num_cpu_backward_threads", []() {
+    return torch::autograd::Engine::get_default_engine().num_cpu_threads();
+  });
+  m.def("_set_backward_schedule_caching", [](bool enabled) {
+    torch::autograd::Engine::get_default_engine().set_schedule_caching_enabled(enabled);
+  });
+  m.def("_is_backward_schedule_caching_enabled", []() {
+    return torch::autograd::Engine::get_default_engine().is_schedule_caching_enabled();
+  });
+  m.def("_set_backward_multi_stream", [](bool enabled) {
+    torch::autograd::Engine::get_default_engine().set_multi_stream_enabled(enabled);
+  });
+  m.def("_is_backward_multi_stream_enabled", []() {
+    return torch::autograd::Engine::get_default_engine().is_multi_stream_enabled();
+  });
+  m.def("_push_saved_tensors_default_hooks", [](py::function pack_hook, py::function unpack_hook, py::object prefetch_hook) {
+    torch::autograd::SavedVariableDefaultHooks::push_hooks(
+        std::make_shared<torch::autograd::PySavedVariableHooksFactory>(
+            std::move(pack_hook), std::move(unpack_hook), std::move(prefetch_hook)));
+  });
+  m.def("_pop_saved_tensors_default_hooks", []() {
+    torch::autograd::SavedVariableDefaultHooks::pop_hooks();
+  });
+  m.def("_push_checkpoint_hooks", [](py::function recompute, std::vector<at::Tensor> inputs) {
+    // The frame, and so the function, lives as long as the graph, which may
+    // be released on a thread without the GIL.
+    std::shared_ptr<PyObject> fn(recompute.release().ptr(), [](PyObject* obj) {
+      if (Py_IsInitialized()) {
+        pybind11::gil_scoped_acquire gil;
+        Py_DECREF(obj);
+      }
+    });
+    auto frame = std::make_shared<torch::autograd::CheckpointFrame>([fn]() {
+      pybind11::gil_scoped_acquire gil;
+      THPObjectPtr res(PyObject_CallFunctionObjArgs(fn.get(), nullptr));
+      if (!res) {
+        throw python_error();
+      }
+    }, std::move(inputs));
+    torch::autograd::SavedVariableDefaultHooks::push_hooks(frame->hooks());
+  });
+  m.def("_pop_checkpoint_hooks", []() {
+    torch::autograd::SavedVariableDefaultHooks::pop_hooks();
+  });
+  m.def("_is_checkpoint_active", []() {
+    return torch::autograd::CheckpointFrame::is_active();
+  });
 
   Py_RETURN_TRUE;
 }
@@ -102,6 +172,26 @@ static PyObject * is_autocast_enabled(PyObject* _unused, PyObject *arg) {
   END_HANDLE_TH_ERRORS
 }
 
+static PyObject * set_autocast_cpu_enabled(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (!PyBool_Check(arg)) {
+    throw TypeError("enabled must be a bool (got %s)", Py_TYPE(arg)->tp_name);
+  }
+  at::autocast::set_cpu_enabled(arg == Py_True);
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * is_autocast_cpu_enabled(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (at::autocast::is_cpu_enabled()) {
+    Py_RETURN_TRUE;
+  } else {
+    Py_RETURN_FALSE;
+  }
+  END_HANDLE_TH_ERRORS
+}
+
 static PyObject * clear_autocast_cache(PyObject* _unused, PyObject *arg) {
   HANDLE_TH_ERRORS
   at::autocast::clear_cache();
@@ -161,17 +251,41 @@ static PyObject * is_anomaly_mode_enabled(PyObject* _unused, PyObject *arg) {
   END_HANDLE_TH_ERRORS
 }
 
+static PyObject * set_anomaly_nan_check_enabled(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (!PyBool_Check(arg)) {
+    throw TypeError("enabled must be a bool (got %s)", Py_TYPE(arg)->tp_name);
+  }
+  AnomalyMode::set_nan_check_enabled(arg == Py_True);
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * is_anomaly_nan_check_enabled(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (AnomalyMode::is_nan_check_enabled()) {
+    Py_RETURN_TRUE;
+  } else {
+    Py_RETURN_FALSE;
+  }
+  END_HANDLE_TH_ERRORS
+}
+
 // autograd methods on torch._C
 static PyMethodDef methods[] = { // NOLINT
   {"set_grad_enabled", (PyCFunction)set_grad_enabled, METH_O, nullptr},
   {"is_grad_enabled", (PyCFunction)is_grad_enabled, METH_NOARGS, nullptr},
   {"set_autocast_enabled", (PyCFunction)set_autocast_enabled, METH_O, nullptr},
   {"is_autocast_enabled", (PyCFunction)is_autocast_enabled, METH_NOARGS, nullptr},
+  {"set_autocast_cpu_enabled", (PyCFunction)set_autocast_cpu_enabled, METH_O, nullptr},
+  {"is_autocast_cpu_enabled", (PyCFunction)is_autocast_cpu_enabled, METH_NOARGS, nullptr},
   {"clear_autocast_cache", (PyCFunction)clear_autocast_cache, METH_NOARGS, nullptr},
   {"autocast_increment_nesting", (PyCFunction)autocast_increment_nesting, METH_NOARGS, nullptr},
   {"autocast_decrement_nesting", (PyCFunction)autocast_decrement_nesting, METH_NOARGS, nullptr},
   {"set_anomaly_enabled", (PyCFunction)set_anomaly_mode_enabled, METH_O, nullptr},
   {"is_anomaly_enabled", (PyCFunction)is_anomaly_mode_enabled, METH_NOARGS, nullptr},
+  {"set_anomaly_nan_check_enabled", (PyCFunction)set_anomaly_nan_check_enabled, METH_O, nullptr},
+  {"is_anomaly_nan_check_enabled", (PyCFunction)is_anomaly_nan_check_enabled, METH_NOARGS, nullptr},
   {nullptr, nullptr, 0, nullptr}
 };
 
@@ -3,6 +3,7 @@
 #include <c10/core/DeviceGuard.h>
 #include <c10/core/StreamGuard.h>
 #include <c10/core/Event.h>
+#include <c10/core/impl/VirtualGuardImpl.h>
 #include <c10/util/Optional.h>
 
 #include <cstddef>
@@ -136,6 +137,20 @@ auto InputBuffer::device() const -> at::Device {
   return at::kCPU;
 }
 
+void InputBuffer::record_ready_event(const c10::Stream& stream) {
+  ready_event_.emplace(stream.device_type());
+  ready_event_->record(stream);
+}
+
+void InputBuffer::record_stream(const c10::Stream& stream) {
+  const auto guard = c10::impl::VirtualGuardImpl{stream.device_type()};
+  for (const auto& var : buffer) {
+    if (var.defined() && var.has_storage() && var.device() == stream.device()) {
+      guard.recordDataPtrOnStream(var.storage().data_ptr(), stream);
+    }
+  }
+}
+
 auto InputBuffer::variables(InputBuffer&& g) -> std::vector<Variable> {
   std::vector<Variable> result = std::move(g.buffer);
   return result;
@@ -12,6 +12,7 @@
 
 #include <torch/csrc/autograd/variable.h>
 #include <c10/util/Optional.h>
+#include <c10/core/Event.h>
 #include <c10/core/Stream.h>
 
 namespace torch { namespace autograd {
@@ -33,6 +34,18 @@ struct InputBuffer {
 
   at::Device device() const;
 
+  // Records an event on the stream the inputs were accumulated on once all of
+  // them were added, for a function that runs on another stream to wait on.
+  // See Note [Multi-stream backward]
+  void record_ready_event(const c10::Stream& stream);
+  const c10::optional<c10::Event>& ready_event() const {
+    return ready_event_;
+  }
+
+  // Marks the memory of the inputs as used on stream, so that it isn't
+  // reused before the work queued on it until they are freed is done.
+  void record_stream(const c10::Stream& stream);
+
   Variable operator[](size_t pos) { return buffer[pos]; }
 
   // Returns the inputs as a list of variables. Destroys given InputBuffer.
@@ -40,6 +53,7 @@ struct InputBuffer {
 
 private:
   std::vector<Variable> buffer;
+  c10::optional<c10::Event> ready_event_;
 };
 
 }}  // namespace torch::autograd
@@ -1,4 +1,5 @@
 #include <torch/csrc/autograd/profiler.h>
+#include <torch/csrc/autograd/profiler_utils.h>
 #include <torch/csrc/autograd/function.h>
 #include <torch/csrc/jit/frontend/code_template.h>
 
@@ -7,11 +8,16 @@
 #include <ATen/core/op_registration/op_registration.h>
 #include <torch/library.h>
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <fstream>
+#include <iterator>
 #include <list>
 #include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <ATen/record_function.h>
@@ -36,6 +42,11 @@ namespace {
     CUDA_MEM_USAGE,
     CUDA_DEVICE,
     CUDA_US,
+    DEVICE_END_NS,
+    FLOPS,
+    BYTES_MOVED,
+    PERF_COUNTERS,
+    STREAM,
     NUM_EVENT_IVALUE_IDX // must be last in list
   };
 
@@ -43,6 +54,9 @@ namespace {
     STATE = 0,
     REPORT_INPUT_SHAPES,
     PROFILE_MEMORY,
+    SAMPLE_EVERY,
+    WITH_FLOPS,
+    WITH_PERF_COUNTERS,
     NUM_PROFILER_CFG_IVALUE_IDX // must be last in list
   };
 
@@ -141,25 +155,91 @@ static CUDAStubs* cuda_stubs = default_stubs_addr;
 //  - get the current profiling state (PROFILER slot in ThreadLocalDebugInfo)
 //  - save profiling events into the profiling state
 //
+//
+// CUPTI:
+//
+// In the CUPTI state, no CUDA event is recorded around the ranges. Instead,
+// every range pushes its handle as the CUPTI external correlation id of the
+// thread while it is open, and the CUPTI activity API reports the kernels,
+// memcpys and memsets the GPUs actually ran, each tagged with the id that
+// was on top when it was launched. enableProfiler starts the (process-wide)
+// activity tracing, disableProfiler stops it and adds the activities to the
+// events as DeviceActivity events, whose handle is the one of the range
+// that launched them.
+//
+
+// Sampled profiling:
+//
+// With a sample_every greater than 1, the profiler callbacks are sampled
+// (see Note [Pre-sampling] in record_function.cpp), so that the ranges that
+// aren't recorded cost close to nothing, which makes it possible to keep
+// the profiler on in production. As such a profiling run is long, a
+// background thread then moves the recorded events out of the per thread
+// event lists every kFlushInterval, which lets the threads reuse the blocks
+// of their lists instead of growing them.
+
+const std::chrono::milliseconds kFlushInterval(100);
+
+struct ProfilerThreadLocalState;
+
+// The event list of the current thread in the profiling run it was last
+// looked up for, so that recording an event doesn't lock the profiler state
+struct ThreadEventListCache {
+  uint64_t state_id = 0;
+  std::shared_ptr<RangeEventList> list;
+};
+
+thread_local ThreadEventListCache event_list_cache_;
+
+uint64_t next_profiler_state_id() {
+  static std::atomic<uint64_t> next_id {0};
+  return ++next_id;
+}
 
 // Profiler state
 struct ProfilerThreadLocalState
     : public c10::MemoryReportingInfoBase {
   explicit ProfilerThreadLocalState(
       const ProfilerConfig& config)
-    : config_(config), remoteProfiledEvents_{c10::nullopt} {}
-  ~ProfilerThreadLocalState() override = default;
+    : config_(config),
+      id_(next_profiler_state_id()),
+      remoteProfiledEvents_{c10::nullopt} {
+    if (config_.sample_every > 1 && config_.state != ProfilerState::NVTX) {
+      flusher_ = std::thread([this]() { flushLoop(); });
+    }
+  }
+
+  ~ProfilerThreadLocalState() override {
+    stopFlusher();
+  }
 
   inline const ProfilerConfig& config() const {
     return config_;
   }
 
   thread_event_lists consolidate() {
+    stopFlusher();
     std::lock_guard<std::mutex> g(state_mutex_);
     thread_event_lists result;
     for (auto& kv : event_lists_map_) {
       auto& list = kv.second;
-      result.emplace_back(list->consolidate());
+      auto flushed = flushed_events_.find(kv.first);
+      if (flushed != flushed_events_.end()) {
+        auto events = std::move(flushed->second);
+        auto rest = list->consolidate();
+        events.insert(
+            events.end(),
+            std::make_move_iterator(rest.begin()),
+            std::make_move_iterator(rest.end()));
+        result.emplace_back(std::move(events));
+      } else {
+        result.emplace_back(list->consolidate());
+      }
+    }
+    flushed_events_.clear();
+    if (!device_events_.empty()) {
+      result.emplace_back(std::move(device_events_));
+      device_events_.clear();
     }
     // Consolidate remote events if applicable as well.
     if (remoteProfiledEvents_) {
@@ -187,7 +267,7 @@ struct ProfilerThreadLocalState
         include_cuda && config_.state == ProfilerState::CUDA
       );
       evt.setNodeId(at::RecordFunction::getDefaultNodeId());
-      getEventList().record(std::move(evt));
+      currentEventList().record(std::move(evt));
     }
   }
 
@@ -201,12 +281,31 @@ struct ProfilerThreadLocalState
     }
   }
 
+  void addDeviceActivities(std::vector<DeviceActivityRecord>&& records) {
+    std::lock_guard<std::mutex> guard(state_mutex_);
+    auto thread_id = at::RecordFunction::currentThreadId();
+    device_events_.reserve(device_events_.size() + records.size());
+    for (auto& record : records) {
+      Event evt(
+          EventKind::DeviceActivity,
+          at::StringView(std::move(record.name)),
+          thread_id,
+          /* record_cuda */ false,
+          record.correlation_id);
+      evt.setNodeId(at::RecordFunction::getDefaultNodeId());
+      evt.setDeviceActivity(
+          record.device, record.stream, record.start_ns, record.end_ns);
+      device_events_.emplace_back(std::move(evt));
+    }
+  }
+
   void pushRange(
       const at::StringView& name,
       const char* msg = "",
       int64_t sequence_nr = -1,
       std::vector<std::vector<int64_t>>&& shapes = {},
-      at::RecordFunctionHandle handle = 0) {
+      at::RecordFunctionHandle handle = 0,
+      c10::optional<OpCost> cost = c10::nullopt) {
     if (config_.state == ProfilerState::Disabled) {
       return;
     }
@@ -222,7 +321,17 @@ struct ProfilerThreadLocalState
           std::move(shapes),
           at::RecordFunction::getDefaultNodeId());
       evt.setSequenceNr(sequence_nr);
-      getEventList().record(std::move(evt));
+      if (cost) {
+        evt.setOpCost(cost->flops, cost->bytes);
+      }
+      // Read last, so that the profiler's own work on the range is left out.
+      if (config_.with_perf_counters) {
+        evt.setPerfCounters(threadPerfCounters());
+      }
+      currentEventList().record(std::move(evt));
+      if (config_.state == ProfilerState::CUPTI) {
+        cuda_stubs->pushCorrelationId(handle);
+      }
     }
   }
 
@@ -233,6 +342,13 @@ struct ProfilerThreadLocalState
     if (config_.state == ProfilerState::NVTX) {
       cuda_stubs->nvtxRangePop();
     } else {
+      // Read first, for the same reason as in pushRange. The counters of
+      // another thread than the one the range started on say nothing of it.
+      std::vector<int64_t> perf_counters;
+      if (config_.with_perf_counters &&
+          thread_id == at::RecordFunction::currentThreadId()) {
+        perf_counters = threadPerfCounters();
+      }
       // In some cases RecordFunction (and popRange) may be
       // called on a different thread than pushRange
       // As a convention, we put the async pop on the original
@@ -243,7 +359,19 @@ struct ProfilerThreadLocalState
           config_.state == ProfilerState::CUDA,
           handle);
       evt.setNodeId(at::RecordFunction::getDefaultNodeId());
-      getEventList(thread_id).record(std::move(evt));
+      evt.setPerfCounters(std::move(perf_counters));
+      if (thread_id == at::RecordFunction::currentThreadId()) {
+        currentEventList().record(std::move(evt));
+      } else {
+        lookupEventList(thread_id).recordFromOtherThread(std::move(evt));
+      }
+      // The correlation ids are per thread, an async pop can't pop the id
+      // pushed by the original thread; it stays below the ids of the
+      // following ranges of that thread.
+      if (config_.state == ProfilerState::CUPTI &&
+          thread_id == at::RecordFunction::currentThreadId()) {
+        cuda_stubs->popCorrelationId();
+      }
     }
   }
 
@@ -256,7 +384,7 @@ struct ProfilerThreadLocalState
   }
 
   void reportMemoryUsage(
-      void* /* unused */, int64_t alloc_size, c10::Device device) override {
+      void* ptr, int64_t alloc_size, c10::Device device) override {
     if (config_.profile_memory && config_.state != ProfilerState::Disabled) {
       uint64_t thread_id = at::RecordFunction::currentThreadId();
       Event evt(
@@ -265,7 +393,8 @@ struct ProfilerThreadLocalState
           thread_id,
           config_.state == ProfilerState::CUDA);
       evt.updateMemoryStats(alloc_size, device);
-      getEventList(thread_id).record(std::move(evt));
+      evt.setMemoryPtr(ptr);
+      currentEventList().record(std::move(evt));
     }
   }
 
@@ -274,6 +403,14 @@ struct ProfilerThreadLocalState
   }
 
  private:
+  static std::vector<int64_t> threadPerfCounters() {
+    PerfCounterValues values;
+    if (!readPerfCounters(&values)) {
+      return {};
+    }
+    return std::vector<int64_t>(values.begin(), values.end());
+  }
+
   std::string getNvtxStr(
       const at::StringView& name,
       const char* msg,
@@ -311,30 +448,82 @@ struct ProfilerThreadLocalState
     }
   }
 
-  RangeEventList& getEventList(int64_t thread_id = -1) {
-    if (thread_id < 0) {
-      thread_id = at::RecordFunction::currentThreadId();
+  // The event list of the current thread, which only this thread records
+  // into (see RangeEventList)
+  RangeEventList& currentEventList() {
+    auto& cache = event_list_cache_;
+    if (cache.state_id != id_) {
+      cache.list = lookupEventListPtr(at::RecordFunction::currentThreadId());
+      cache.state_id = id_;
     }
-    RangeEventList* list_ptr = nullptr;
+    return *cache.list;
+  }
+
+  RangeEventList& lookupEventList(uint64_t thread_id) {
+    return *lookupEventListPtr(thread_id);
+  }
+
+  std::shared_ptr<RangeEventList> lookupEventListPtr(uint64_t thread_id) {
     std::lock_guard<std::mutex> guard(state_mutex_);
-    auto it = event_lists_map_.find(thread_id);
-    if (it != event_lists_map_.end()) {
-      list_ptr = it->second.get();
-    } else {
-      auto event_list = std::make_shared<RangeEventList>();
-      event_lists_map_[thread_id] = event_list;
-      list_ptr = event_list.get();
+    auto& event_list = event_lists_map_[thread_id];
+    if (!event_list) {
+      event_list = std::make_shared<RangeEventList>();
+    }
+    return event_list;
+  }
+
+  void flushLoop() {
+    std::unique_lock<std::mutex> lock(flusher_mutex_);
+    while (!flusher_cv_.wait_for(lock, kFlushInterval, [this] { return stop_flusher_; })) {
+      std::vector<std::pair<uint64_t, std::shared_ptr<RangeEventList>>> lists;
+      {
+        std::lock_guard<std::mutex> guard(state_mutex_);
+        lists.assign(event_lists_map_.begin(), event_lists_map_.end());
+      }
+      for (auto& kv : lists) {
+        auto events = kv.second->consolidate();
+        if (events.empty()) {
+          continue;
+        }
+        std::lock_guard<std::mutex> guard(state_mutex_);
+        auto& flushed = flushed_events_[kv.first];
+        flushed.insert(
+            flushed.end(),
+            std::make_move_iterator(events.begin()),
+            std::make_move_iterator(events.end()));
+      }
+    }
+  }
+
+  void stopFlusher() {
+    if (!flusher_.joinable()) {
+      return;
     }
-    return *list_ptr;
+    {
+      std::lock_guard<std::mutex> lock(flusher_mutex_);
+      stop_flusher_ = true;
+    }
+    flusher_cv_.notify_one();
+    flusher_.join();
   }
 
   std::mutex state_mutex_;
   std::unordered_map<uint64_t, std::shared_ptr<RangeEventList>>
       event_lists_map_;
+  std::vector<Event> device_events_;
+  // The events the flusher moved out of the event lists, per thread
+  std::unordered_map<uint64_t, std::vector<Event>> flushed_events_;
 
   ProfilerConfig config_ = ProfilerConfig(ProfilerState::Disabled, false, false);
+  // Unique across the profiling runs of the process
+  const uint64_t id_;
   at::CallbackHandle handle_ = 0;
   c10::optional<std::vector<std::vector<Event>>> remoteProfiledEvents_;
+
+  std::thread flusher_;
+  std::mutex flusher_mutex_;
+  std::condition_variable flusher_cv_;
+  bool stop_flusher_ = false;
 };
 
 ProfilerThreadLocalState* getProfilerTLSState() {
@@ -353,6 +542,10 @@ void pushProfilingCallbacks() {
         }
 
         auto* msg = (fn.seqNr() >= 0) ? ", seq = " : "";
+        c10::optional<OpCost> cost;
+        if (state_ptr->config().with_flops) {
+          cost = estimateOpCost(fn.name().str(), fn.inputs());
+        }
         if (state_ptr->config().report_input_shapes) {
           std::vector<std::vector<int64_t>> inputSizes;
           inputSizes.reserve(fn.inputs().size());
@@ -369,9 +562,9 @@ void pushProfilingCallbacks() {
             }
           }
           state_ptr->pushRange(
-              fn.name(), msg, fn.seqNr(), std::move(inputSizes), fn.handle());
+              fn.name(), msg, fn.seqNr(), std::move(inputSizes), fn.handle(), cost);
         } else {
-          state_ptr->pushRange(fn.name(), msg, fn.seqNr(), {}, fn.handle());
+          state_ptr->pushRange(fn.name(), msg, fn.seqNr(), {}, fn.handle(), cost);
         }
       },
       [](const at::RecordFunction& fn) {
@@ -381,8 +574,10 @@ void pushProfilingCallbacks() {
         }
         state_ptr->popRange(fn.getStartCallbacksThreadId(), fn.handle());
       })
-    .needsInputs(state_ptr->config().report_input_shapes)
-    .needsIds(true));
+    .needsInputs(
+        state_ptr->config().report_input_shapes || state_ptr->config().with_flops)
+    .needsIds(true)
+    .samplingEvery(state_ptr->config().sample_every));
   state_ptr->setCallbackHandle(handle);
 }
 
@@ -405,6 +600,9 @@ at::IValue ProfilerConfig::toIValue() const {
   eventIValueList.emplace_back(static_cast<int64_t>(state));
   eventIValueList.emplace_back(report_input_shapes);
   eventIValueList.emplace_back(profile_memory);
+  eventIValueList.emplace_back(static_cast<int64_t>(sample_every));
+  eventIValueList.emplace_back(with_flops);
+  eventIValueList.emplace_back(with_perf_counters);
   return eventIValueList;
 }
 
@@ -423,7 +621,10 @@ ProfilerConfig ProfilerConfig::fromIValue(
   return ProfilerConfig(
       static_cast<ProfilerState>(ivalues.get(ProfilerIValueIdx::STATE).toInt()),
       ivalues.get(ProfilerIValueIdx::REPORT_INPUT_SHAPES).toBool(),
-      ivalues.get(ProfilerIValueIdx::PROFILE_MEMORY).toBool());
+      ivalues.get(ProfilerIValueIdx::PROFILE_MEMORY).toBool(),
+      static_cast<uint64_t>(ivalues.get(ProfilerIValueIdx::SAMPLE_EVERY).toInt()),
+      ivalues.get(ProfilerIValueIdx::WITH_FLOPS).toBool(),
+      ivalues.get(ProfilerIValueIdx::WITH_PERF_COUNTERS).toBool());
 }
 
 ProfilerConfig getProfilerConfig() {
@@ -439,13 +640,32 @@ bool profilerEnabled() {
   return state_ptr && state_ptr->config().state != ProfilerState::Disabled;
 }
 
+bool cuptiAvailable() {
+  return cuda_stubs->activityTracingEnabled();
+}
+
 void enableProfiler(const ProfilerConfig& new_config) {
   TORCH_CHECK(new_config.state != ProfilerState::NVTX || cuda_stubs->enabled(),
     "Can't use NVTX profiler - PyTorch was compiled without CUDA");
+  TORCH_CHECK(new_config.state != ProfilerState::CUPTI || cuda_stubs->activityTracingEnabled(),
+    "Can't use CUPTI profiler - PyTorch was compiled without CUPTI");
 
   auto state_ptr = getProfilerTLSState();
   TORCH_CHECK(!state_ptr, "Profiler is already enabled on this thread");
 
+  if (new_config.with_perf_counters && !perfCountersAvailable()) {
+    TORCH_WARN(
+        "Hardware performance counters are not available, they won't be ",
+        "reported. They need Linux, access to the PMU and a ",
+        "kernel.perf_event_paranoid of at most 2.");
+  }
+
+  if (new_config.state == ProfilerState::CUPTI) {
+    // Throws if another profiler already traces the activities, so do it
+    // before setting any state.
+    cuda_stubs->startActivityTracing();
+  }
+
   auto state = std::make_shared<ProfilerThreadLocalState>(new_config);
   c10::ThreadLocalDebugInfo::_push(c10::DebugInfoKind::PROFILER_STATE, state);
 
@@ -488,6 +708,10 @@ thread_event_lists disableProfiler() {
 
   state_ptr->mark("__stop_profile");
 
+  if (state_ptr->config().state == ProfilerState::CUPTI) {
+    state_ptr->addDeviceActivities(cuda_stubs->stopActivityTracing());
+  }
+
   return state_ptr->consolidate();
 }
 
@@ -499,7 +723,7 @@ void addEventList(std::vector<Event>&& profiledEvents) {
 
 void Event::record(bool record_cuda) {
   if (record_cuda) {
-    cuda_stubs->record(&device_, &cuda_event, &cpu_ns_);
+    cuda_stubs->record(&device_, &stream_, &cuda_event, &cpu_ns_);
     return;
   }
   cpu_ns_ = getTime();
@@ -533,6 +757,17 @@ void Event::record(bool record_cuda) {
       ivalues.get(EventIValueIdx::CUDA_DEVICE).toInt(), // device
       ivalues.get(EventIValueIdx::CUDA_US).toInt() // cuda_us
   );
+  if (evt.eventKind() == EventKind::DeviceActivity) {
+    evt.setDeviceActivity(
+        evt.device(),
+        ivalues.get(EventIValueIdx::STREAM).toInt(),
+        ivalues.get(EventIValueIdx::CPU_NS).toInt(),
+        ivalues.get(EventIValueIdx::DEVICE_END_NS).toInt());
+  }
+  evt.setOpCost(
+      ivalues.get(EventIValueIdx::FLOPS).toInt(),
+      ivalues.get(EventIValueIdx::BYTES_MOVED).toInt());
+  evt.setPerfCounters(ivalues.get(EventIValueIdx::PERF_COUNTERS).toIntVector());
   return evt;
 }
 
@@ -552,6 +787,11 @@ at::IValue Event::toIValue() const {
   eventIValueList.emplace_back(static_cast<int64_t>(cuda_memory_usage_));
   eventIValueList.emplace_back(device_);
   eventIValueList.emplace_back(cuda_us_);
+  eventIValueList.emplace_back(device_end_ns_);
+  eventIValueList.emplace_back(flops_);
+  eventIValueList.emplace_back(bytes_moved_);
+  eventIValueList.emplace_back(perf_counters_);
+  eventIValueList.emplace_back(stream_);
   return at::IValue(eventIValueList);
 }
 
@@ -571,6 +811,99 @@ double Event::cuda_elapsed_us(const Event& e) const {
 
 CUDAStubs::~CUDAStubs() = default;
 
+RangeEventList::~RangeEventList() {
+  auto block = head_;
+  while (block) {
+    auto next = block->next.load(std::memory_order_acquire);
+    delete block;
+    block = next;
+  }
+  for (auto free_block : free_blocks_) {
+    delete free_block;
+  }
+}
+
+RangeEventList::Block* RangeEventList::appendBlock() {
+  Block* block = nullptr;
+  {
+    std::lock_guard<std::mutex> guard(free_blocks_mutex_);
+    if (!free_blocks_.empty()) {
+      block = free_blocks_.back();
+      free_blocks_.pop_back();
+    }
+  }
+  if (!block) {
+    block = new Block();
+  }
+  tail_->next.store(block, std::memory_order_release);
+  return block;
+}
+
+std::vector<Event> RangeEventList::consolidate() {
+  std::lock_guard<std::mutex> guard(consumer_mutex_);
+  std::vector<Event> result;
+  while (true) {
+    auto size = head_->size.load(std::memory_order_acquire);
+    // the events before `size` are published and never written again; don't
+    // go through the vector's end, which the producer may be moving
+    auto events = head_->events.data();
+    result.insert(
+        result.end(),
+        std::make_move_iterator(events + consumed_),
+        std::make_move_iterator(events + size));
+    consumed_ = size;
+    auto next = head_->next.load(std::memory_order_acquire);
+    if (size < kBlockSize || !next) {
+      break;
+    }
+    // the producer moved on to the next block, this one can be reused
+    auto block = head_;
+    head_ = next;
+    consumed_ = 0;
+    block->events.clear();
+    block->size.store(0, std::memory_order_relaxed);
+    block->next.store(nullptr, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> free_guard(free_blocks_mutex_);
+    free_blocks_.push_back(block);
+  }
+
+  std::vector<Event> other_threads_events;
+  {
+    std::lock_guard<std::mutex> other_guard(other_threads_mutex_);
+    other_threads_events.swap(other_threads_events_);
+  }
+  if (!other_threads_events.empty()) {
+    auto earlier = [](const Event& a, const Event& b) {
+      return a.cpu_us() < b.cpu_us();
+    };
+    std::stable_sort(
+        other_threads_events.begin(), other_threads_events.end(), earlier);
+    std::vector<Event> merged;
+    merged.reserve(result.size() + other_threads_events.size());
+    std::merge(
+        std::make_move_iterator(result.begin()),
+        std::make_move_iterator(result.end()),
+        std::make_move_iterator(other_threads_events.begin()),
+        std::make_move_iterator(other_threads_events.end()),
+        std::back_inserter(merged),
+        earlier);
+    result = std::move(merged);
+  }
+  return result;
+}
+
+size_t RangeEventList::size() {
+  std::lock_guard<std::mutex> guard(consumer_mutex_);
+  size_t size = 0;
+  auto consumed = consumed_;
+  for (auto block = head_; block; block = block->next.load(std::memory_order_acquire)) {
+    size += block->size.load(std::memory_order_acquire) - consumed;
+    consumed = 0;
+  }
+  std::lock_guard<std::mutex> other_guard(other_threads_mutex_);
+  return size + other_threads_events_.size();
+}
+
 
 static jit::CodeTemplate event_template(R"(
 {
@@ -583,6 +916,17 @@ static jit::CodeTemplate event_template(R"(
   "args": {}
 })");
 
+static jit::CodeTemplate device_event_template(R"(
+{
+  "name": "${name}",
+  "ph": "X",
+  "ts": ${ts},
+  "dur": ${dur},
+  "tid": ${tid},
+  "pid": "CUDA Functions",
+  "args": {}
+})");
+
 void writeProfilerEventsToStream(std::ostream& out, const std::vector<Event*>& events) {
   TORCH_CHECK(out, "Could not open file");
   Event* profiler_start = nullptr;
@@ -622,6 +966,17 @@ void writeProfilerEventsToStream(std::ostream& out, const std::vector<Event*>& e
       env.d("dur", evt_start->cpu_elapsed_us(*evt));
       env.d("tid", evt_start->thread_id());
       out << event_template.format(env);
+    } else if (evt->kind() == "device_activity") {
+      if (!first) {
+        out << ",\n";
+      }
+      first = false;
+      jit::TemplateEnv env;
+      env.s("name", evt->name());
+      env.d("ts", profiler_start->cpu_elapsed_us(*evt));
+      env.d("dur", evt->device_elapsed_us());
+      env.d("tid", evt->device());
+      out << device_event_template.format(env);
     }
   }
   out << "]\n";
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <iostream>
 #include <mutex>
 #include <memory>
@@ -29,8 +30,24 @@ struct Node;
 
 namespace profiler {
 
+// A kernel, memcpy or memset a GPU ran, as reported by the CUPTI activity
+// API. The times are on the clock of getTime(), `correlation_id` is the
+// handle of the innermost profiled range that was open on the thread that
+// launched it, or 0 if there was none. `stream` is the id CUPTI gives the
+// stream it ran on.
+struct DeviceActivityRecord {
+  std::string name;
+  int device;
+  int64_t stream;
+  int64_t start_ns;
+  int64_t end_ns;
+  at::RecordFunctionHandle correlation_id;
+};
+
 struct TORCH_API CUDAStubs {
-  virtual void record(int* device, CUDAEventStub* event, int64_t* cpu_ns) {
+  // Records an event on the current stream of the current device, returning
+  // the device and the id of the stream.
+  virtual void record(int* device, int64_t* stream, CUDAEventStub* event, int64_t* cpu_ns) {
     fail();
   }
   virtual float elapsed(const CUDAEventStub* event, const CUDAEventStub* event2) {
@@ -55,6 +72,22 @@ struct TORCH_API CUDAStubs {
   virtual void synchronize() {
     fail();
   }
+  virtual bool activityTracingEnabled() {
+    return false;
+  }
+  virtual void startActivityTracing() {
+    fail();
+  }
+  virtual std::vector<DeviceActivityRecord> stopActivityTracing() {
+    fail();
+    return {};
+  }
+  virtual void pushCorrelationId(at::RecordFunctionHandle id) {
+    fail();
+  }
+  virtual void popCorrelationId() {
+    fail();
+  }
   virtual ~CUDAStubs();
 
 private:
@@ -93,20 +126,36 @@ enum class C10_API_ENUM ProfilerState {
     CPU, // CPU-only profiling
     CUDA, // CPU + CUDA events
     NVTX,  // only emit NVTX markers
+    CUPTI, // CPU events + GPU activities traced with CUPTI
 };
 
 struct TORCH_API ProfilerConfig {
   ProfilerConfig(
       ProfilerState state,
       bool report_input_shapes,
-      bool profile_memory)
+      bool profile_memory,
+      uint64_t sample_every = 1,
+      bool with_flops = false,
+      bool with_perf_counters = false)
       : state(state),
         report_input_shapes(report_input_shapes),
-        profile_memory(profile_memory) {}
+        profile_memory(profile_memory),
+        sample_every(sample_every),
+        with_flops(with_flops),
+        with_perf_counters(with_perf_counters) {}
   ~ProfilerConfig();
   ProfilerState state;
   bool report_input_shapes;
   bool profile_memory;
+  // Records one in every `sample_every` ranges of each thread, see
+  // RecordFunctionCallback::samplingEvery
+  uint64_t sample_every;
+  // Estimates the flops and bytes moved of the operators it knows the cost
+  // of, see estimateOpCost
+  bool with_flops;
+  // Reads the hardware counters of the thread at the start and the end of
+  // each range, see readPerfCounters
+  bool with_perf_counters;
 
   // Returns IValues corresponding to ProfilerConfig struct, to be used for
   // serialization.
@@ -122,6 +171,7 @@ enum class C10_API_ENUM EventKind : uint16_t {
   PushRange,
   PopRange,
   MemoryAlloc,
+  DeviceActivity,
 };
 
 struct TORCH_API Event final {
@@ -191,6 +241,7 @@ struct TORCH_API Event final {
       case EventKind::PushRange: return "push";
       case EventKind::PopRange: return "pop";
       case EventKind::MemoryAlloc: return "memory_alloc";
+      case EventKind::DeviceActivity: return "device_activity";
     }
     throw std::runtime_error("unknown EventKind");
   }
@@ -224,11 +275,17 @@ struct TORCH_API Event final {
   int device() const {
     return device_;
   }
+  // The id of the stream the CUDA event or the device activity was
+  // recorded on, -1 if unknown.
+  int64_t stream() const {
+    return stream_;
+  }
 
   void updateMemoryStats(int64_t alloc_size, c10::Device device) {
     if (device.type() == c10::DeviceType::CUDA ||
         device.type() == c10::DeviceType::HIP) {
       cuda_memory_usage_ = alloc_size;
+      device_ = device.index();
     } else if (device.type() == c10::DeviceType::CPU ||
         device.type() == c10::DeviceType::MKLDNN ||
         device.type() == c10::DeviceType::IDEEP) {
@@ -246,6 +303,40 @@ struct TORCH_API Event final {
     return cuda_memory_usage_;
   }
 
+  // Address of the allocation a MemoryAlloc event reports, which its
+  // allocation and its free have in common.
+  uint64_t memory_ptr() const {
+    return memory_ptr_;
+  }
+
+  void setMemoryPtr(const void* ptr) {
+    memory_ptr_ = reinterpret_cast<uint64_t>(ptr);
+  }
+
+  // Estimated cost of the operator a PushRange event starts, 0 if unknown.
+  int64_t flops() const {
+    return flops_;
+  }
+
+  int64_t bytes_moved() const {
+    return bytes_moved_;
+  }
+
+  void setOpCost(int64_t flops, int64_t bytes_moved) {
+    flops_ = flops;
+    bytes_moved_ = bytes_moved;
+  }
+
+  // Hardware counters of the thread when the event was recorded, in the
+  // order of PerfCounter, empty if they weren't read.
+  const std::vector<int64_t>& perf_counters() const {
+    return perf_counters_;
+  }
+
+  void setPerfCounters(std::vector<int64_t> perf_counters) {
+    perf_counters_ = std::move(perf_counters);
+  }
+
   at::RecordFunctionHandle handle() const {
     return handle_;
   }
@@ -272,6 +363,23 @@ struct TORCH_API Event final {
     cuda_us_ = cuda_us;
   }
 
+  // Turns this event into the record of an activity that ran on `stream` of
+  // `device` from `start_ns` to `end_ns`.
+  void setDeviceActivity(int device, int64_t stream, int64_t start_ns, int64_t end_ns) {
+    device_ = device;
+    stream_ = stream;
+    cpu_ns_ = start_ns;
+    device_end_ns_ = end_ns;
+  }
+
+  double device_elapsed_us() const {
+    return (device_end_ns_ - cpu_ns_) / (1000.0);
+  }
+
+  int64_t device_end_ns() const {
+    return device_end_ns_;
+  }
+
   void setSequenceNr(int64_t sequence_nr) {
     sequence_nr_ = sequence_nr;
   }
@@ -291,50 +399,92 @@ struct TORCH_API Event final {
   int64_t cpu_memory_usage_ = 0;
   int64_t cuda_memory_usage_ = 0;
   int device_ = -1;
+  int64_t stream_ = -1;
   CUDAEventStub cuda_event = nullptr;
   int node_id_ = 0;
   bool is_remote_ = false;
   int64_t cuda_us_ = -1;
   int64_t sequence_nr_ = -1;
+  int64_t device_end_ns_ = 0;
+  uint64_t memory_ptr_ = 0;
+  int64_t flops_ = 0;
+  int64_t bytes_moved_ = 0;
+  std::vector<int64_t> perf_counters_;
 };
 
 // a linked-list of fixed sized vectors, to avoid
 // a std::vector resize from taking a large amount of time inside
 // a profiling  event
-struct RangeEventList {
-  RangeEventList() {
-    events_.reserve(kReservedCapacity);
-  }
-
+//
+// The list is written by a single thread, the one it records the events
+// of, without locking: the events go into a block reserved up front, whose
+// size is published after the event is constructed, so that consolidate(),
+// which may run concurrently on another thread (the background flusher, or
+// disableProfiler while the thread is still running), only reads published
+// events. Consolidated blocks are kept for reuse, so a thread recording at
+// a steady rate eventually stops allocating. The events other threads record
+// on behalf of this one (e.g. the end of an async range) go to a separate,
+// locked list, and are merged in by time on consolidation.
+struct TORCH_API RangeEventList {
+  RangeEventList() : head_(new Block()), tail_(head_) {}
+  ~RangeEventList();
+
+  RangeEventList(const RangeEventList&) = delete;
+  RangeEventList& operator=(const RangeEventList&) = delete;
+
+  // Only called by the thread the list belongs to.
   template<typename... Args>
   void record(Args&&... args) {
-    std::lock_guard<std::mutex> guard(mutex_);
-    events_.emplace_back(std::forward<Args>(args)...);
+    auto size = tail_->size.load(std::memory_order_relaxed);
+    if (size == kBlockSize) {
+      tail_ = appendBlock();
+      size = 0;
+    }
+    tail_->events.emplace_back(std::forward<Args>(args)...);
+    tail_->size.store(size + 1, std::memory_order_release);
   }
 
-  std::vector<Event> consolidate() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<Event> result;
-    result.insert(
-        result.begin(),
-        std::make_move_iterator(events_.begin()),
-        std::make_move_iterator(events_.end()));
-    events_.erase(events_.begin(), events_.end());
-    return result;
+  // Called by the other threads.
+  template<typename... Args>
+  void recordFromOtherThread(Args&&... args) {
+    std::lock_guard<std::mutex> guard(other_threads_mutex_);
+    other_threads_events_.emplace_back(std::forward<Args>(args)...);
   }
 
-  size_t size() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return events_.size();
-  }
+  // Moves out the events recorded since the last call, in time order.
+  std::vector<Event> consolidate();
+
+  size_t size();
 
  private:
-  // This mutex is used to serialize access when different threads are writing
-  // to the same instance of RangeEventList.
-  std::mutex mutex_;
-  std::vector<Event> events_;
+  static constexpr size_t kBlockSize = 1024;
+
+  struct Block {
+    Block() {
+      // never grows past kBlockSize, so the published events never move
+      events.reserve(kBlockSize);
+    }
+    std::vector<Event> events;
+    std::atomic<size_t> size{0};
+    std::atomic<Block*> next{nullptr};
+  };
+
+  Block* appendBlock();
+
+  // Written by the consumer (consolidate) only.
+  Block* head_;
+  size_t consumed_ = 0;
+  std::mutex consumer_mutex_;
+
+  // Written by the producer only.
+  Block* tail_;
+
+  // Consolidated blocks, for the producer to reuse.
+  std::mutex free_blocks_mutex_;
+  std::vector<Block*> free_blocks_;
 
-  static const size_t kReservedCapacity = 1024;
+  std::mutex other_threads_mutex_;
+  std::vector<Event> other_threads_events_;
 };
 
 using thread_event_lists = std::vector<std::vector<Event>>;
@@ -347,6 +497,8 @@ TORCH_API thread_event_lists disableProfiler();
 TORCH_API void addEventList(std::vector<Event>&& profiledEvents);
 // Returns if the profiler is currently enabled in the current thread.
 TORCH_API bool profilerEnabled();
+// Returns if PyTorch was built with CUPTI, i.e. ProfilerState::CUPTI can be used.
+TORCH_API bool cuptiAvailable();
 // Retrieve the thread_local ProfilerConfig.
 TORCH_API ProfilerConfig getProfilerConfig();
 // Writes profiled events to a stream.
@@ -1,8 +1,15 @@
 #include <torch/csrc/autograd/profiler.h>
 #include <c10/cuda/CUDAGuard.h>
 #include <nvToolsExt.h>
+#ifdef USE_CUPTI
+#include <c10/core/CPUAllocator.h>
+#include <c10/util/Type.h>
+#include <cupti.h>
+#endif
 
+#include <mutex>
 #include <sstream>
+#include <unordered_map>
 
 namespace torch { namespace autograd { namespace profiler {
 
@@ -31,8 +38,205 @@ static inline void cudaCheck(cudaError_t result, const char * file, int line) {
 }
 #define TORCH_CUDA_CHECK(result) cudaCheck(result,__FILE__,__LINE__);
 
+#ifdef USE_CUPTI
+static inline void cuptiCheck(CUptiResult result, const char * file, int line) {
+  if (result != CUPTI_SUCCESS) {
+    const char* msg = nullptr;
+    cuptiGetResultString(result, &msg);
+    std::stringstream ss;
+    ss << file << ":" << line << ": " << (msg ? msg : "unknown CUPTI error");
+    throw std::runtime_error(ss.str());
+  }
+}
+#define TORCH_CUPTI_CHECK(result) cuptiCheck(result,__FILE__,__LINE__);
+
+// Collects the GPU activities through the CUPTI activity API. CUPTI writes
+// the records into buffers it requests from us, and hands them back from its
+// own thread once they are full (or flushed), so the profiled code only pays
+// for the correlation id push/pop of every range. The records are kept with
+// their CUPTI correlation id, which the EXTERNAL_CORRELATION records map to
+// the handle of the range that launched them; as the two kinds of records come
+// in any order, they are only matched when tracing stops.
+//
+// There is a single CUPTI subscriber per process, so a single profiler can
+// trace the activities at a time.
+struct ActivityTracer {
+  static ActivityTracer& get() {
+    static ActivityTracer tracer;
+    return tracer;
+  }
+
+  void start() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    TORCH_CHECK(!active_, "CUPTI activity tracing is already used by another profiler");
+    if (!callbacks_registered_) {
+      TORCH_CUPTI_CHECK(cuptiActivityRegisterCallbacks(bufferRequested, bufferCompleted));
+      callbacks_registered_ = true;
+    }
+    {
+      std::lock_guard<std::mutex> records_guard(records_mutex_);
+      records_.clear();
+      external_ids_.clear();
+    }
+    for (auto kind : kActivityKinds) {
+      TORCH_CUPTI_CHECK(cuptiActivityEnable(kind));
+    }
+    // The CUPTI timestamps are on their own clock, offset them to getTime().
+    uint64_t cupti_ns = 0;
+    TORCH_CUPTI_CHECK(cuptiGetTimestamp(&cupti_ns));
+    clock_offset_ns_ = getTime() - static_cast<int64_t>(cupti_ns);
+    active_ = true;
+  }
+
+  std::vector<DeviceActivityRecord> stop() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    TORCH_INTERNAL_ASSERT(active_, "CUPTI activity tracing is not running");
+    active_ = false;
+    {
+      // Every activity launched in the profiled range must be complete
+      // before the buffers are flushed.
+      at::cuda::OptionalCUDAGuard device_guard;
+      for (int i = 0; i < at::cuda::device_count(); i++) {
+        device_guard.set_index(i);
+        TORCH_CUDA_CHECK(cudaDeviceSynchronize());
+      }
+    }
+    for (auto kind : kActivityKinds) {
+      TORCH_CUPTI_CHECK(cuptiActivityDisable(kind));
+    }
+    // Delivers the pending buffers to bufferCompleted, on this thread.
+    TORCH_CUPTI_CHECK(cuptiActivityFlushAll(CUPTI_ACTIVITY_FLAG_FLUSH_FORCED));
+
+    std::lock_guard<std::mutex> records_guard(records_mutex_);
+    std::vector<DeviceActivityRecord> result;
+    result.reserve(records_.size());
+    for (auto& record : records_) {
+      auto it = external_ids_.find(record.cupti_correlation_id);
+      result.push_back(DeviceActivityRecord{
+          std::move(record.name),
+          record.device,
+          static_cast<int64_t>(record.stream),
+          static_cast<int64_t>(record.start_ns) + clock_offset_ns_,
+          static_cast<int64_t>(record.end_ns) + clock_offset_ns_,
+          it != external_ids_.end() ? it->second : 0});
+    }
+    records_.clear();
+    external_ids_.clear();
+    return result;
+  }
+
+ private:
+  struct RawRecord {
+    std::string name;
+    int device;
+    uint32_t stream;
+    uint64_t start_ns;
+    uint64_t end_ns;
+    uint32_t cupti_correlation_id;
+  };
+
+  static constexpr size_t kBufferSize = 4 * 1024 * 1024;
+  static constexpr CUpti_ActivityKind kActivityKinds[] = {
+    CUPTI_ACTIVITY_KIND_CONCURRENT_KERNEL,
+    CUPTI_ACTIVITY_KIND_MEMCPY,
+    CUPTI_ACTIVITY_KIND_MEMSET,
+    CUPTI_ACTIVITY_KIND_EXTERNAL_CORRELATION,
+  };
+
+  static void CUPTIAPI bufferRequested(
+      uint8_t** buffer, size_t* size, size_t* max_num_records) {
+    // c10::alloc_cpu aligns to more than the 8 bytes CUPTI needs.
+    *buffer = static_cast<uint8_t*>(c10::alloc_cpu(kBufferSize));
+    *size = kBufferSize;
+    *max_num_records = 0;
+  }
+
+  static void CUPTIAPI bufferCompleted(
+      CUcontext /* unused */, uint32_t /* unused */, uint8_t* buffer,
+      size_t /* unused */, size_t valid_size) {
+    get().parse(buffer, valid_size);
+    c10::free_cpu(buffer);
+  }
+
+  static const char* memcpyName(uint8_t kind) {
+    switch (kind) {
+      case CUPTI_ACTIVITY_MEMCPY_KIND_HTOD: return "Memcpy HtoD";
+      case CUPTI_ACTIVITY_MEMCPY_KIND_DTOH: return "Memcpy DtoH";
+      case CUPTI_ACTIVITY_MEMCPY_KIND_DTOD: return "Memcpy DtoD";
+      case CUPTI_ACTIVITY_MEMCPY_KIND_HTOH: return "Memcpy HtoH";
+      case CUPTI_ACTIVITY_MEMCPY_KIND_PTOP: return "Memcpy PtoP";
+      default: return "Memcpy";
+    }
+  }
+
+  void parse(uint8_t* buffer, size_t valid_size) {
+    std::lock_guard<std::mutex> guard(records_mutex_);
+    CUpti_Activity* record = nullptr;
+    while (cuptiActivityGetNextRecord(buffer, valid_size, &record) == CUPTI_SUCCESS) {
+      switch (record->kind) {
+        case CUPTI_ACTIVITY_KIND_CONCURRENT_KERNEL: {
+          auto kernel = reinterpret_cast<CUpti_ActivityKernel4*>(record);
+          records_.push_back(RawRecord{
+              c10::demangle(kernel->name),
+              static_cast<int>(kernel->deviceId),
+              kernel->streamId,
+              kernel->start,
+              kernel->end,
+              kernel->correlationId});
+          break;
+        }
+        case CUPTI_ACTIVITY_KIND_MEMCPY: {
+          auto copy = reinterpret_cast<CUpti_ActivityMemcpy*>(record);
+          records_.push_back(RawRecord{
+              memcpyName(copy->copyKind),
+              static_cast<int>(copy->deviceId),
+              copy->streamId,
+              copy->start,
+              copy->end,
+              copy->correlationId});
+          break;
+        }
+        case CUPTI_ACTIVITY_KIND_MEMSET: {
+          auto set = reinterpret_cast<CUpti_ActivityMemset*>(record);
+          records_.push_back(RawRecord{
+              "Memset",
+              static_cast<int>(set->deviceId),
+              set->streamId,
+              set->start,
+              set->end,
+              set->correlationId});
+          break;
+        }
+        case CUPTI_ACTIVITY_KIND_EXTERNAL_CORRELATION: {
+          auto correlation = reinterpret_cast<CUpti_ActivityExternalCorrelation*>(record);
+          if (correlation->externalKind == CUPTI_EXTERNAL_CORRELATION_KIND_CUSTOM0) {
+            external_ids_[correlation->correlationId] = correlation->externalId;
+          }
+          break;
+        }
+        default:
+          break;
+      }
+    }
+  }
+
+  // Serializes start and stop.
+  std::mutex mutex_;
+  bool active_ = false;
+  bool callbacks_registered_ = false;
+  int64_t clock_offset_ns_ = 0;
+
+  // Guards the records, which bufferCompleted adds from the CUPTI thread.
+  std::mutex records_mutex_;
+  std::vector<RawRecord> records_;
+  std::unordered_map<uint32_t, at::RecordFunctionHandle> external_ids_;
+};
+
+constexpr CUpti_ActivityKind ActivityTracer::kActivityKinds[];
+#endif
+
 struct CUDAMethods : public CUDAStubs {
-  void record(int* device, CUDAEventStub* event, int64_t* cpu_ns) override {
+  void record(int* device, int64_t* stream_id, CUDAEventStub* event, int64_t* cpu_ns) override {
     TORCH_CUDA_CHECK(cudaGetDevice(device));
     CUevent_st* cuda_event_ptr;
     TORCH_CUDA_CHECK(cudaEventCreate(&cuda_event_ptr));
@@ -40,6 +244,7 @@ struct CUDAMethods : public CUDAStubs {
       TORCH_CUDA_CHECK(cudaEventDestroy(ptr));
     });
     auto stream = at::cuda::getCurrentCUDAStream();
+    *stream_id = stream.id();
     *cpu_ns = getTime();
     TORCH_CUDA_CHECK(cudaEventRecord(cuda_event_ptr, stream));
   }
@@ -73,6 +278,26 @@ struct CUDAMethods : public CUDAStubs {
   bool enabled() override {
     return true;
   }
+#ifdef USE_CUPTI
+  bool activityTracingEnabled() override {
+    return true;
+  }
+  void startActivityTracing() override {
+    ActivityTracer::get().start();
+  }
+  std::vector<DeviceActivityRecord> stopActivityTracing() override {
+    return ActivityTracer::get().stop();
+  }
+  void pushCorrelationId(at::RecordFunctionHandle id) override {
+    TORCH_CUPTI_CHECK(cuptiActivityPushExternalCorrelationId(
+        CUPTI_EXTERNAL_CORRELATION_KIND_CUSTOM0, id));
+  }
+  void popCorrelationId() override {
+    uint64_t id = 0;
+    TORCH_CUPTI_CHECK(cuptiActivityPopExternalCorrelationId(
+        CUPTI_EXTERNAL_CORRELATION_KIND_CUSTOM0, &id));
+  }
+#endif
 
 };
 
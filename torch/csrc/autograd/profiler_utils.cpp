@@ -0,0 +1,327 @@
+#include <torch/csrc/autograd/profiler_utils.h>
+
+#include <ATen/ATen.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace torch { namespace autograd { namespace profiler {
+
+namespace {
+
+using CostFn = c10::optional<OpCost> (*)(const std::vector<c10::IValue>&);
+
+const at::Tensor* tensorAt(const std::vector<c10::IValue>& inputs, size_t idx) {
+  if (idx >= inputs.size() || !inputs[idx].isTensor()) {
+    return nullptr;
+  }
+  const at::Tensor& tensor = inputs[idx].toTensor();
+  return tensor.defined() ? &tensor : nullptr;
+}
+
+int64_t nbytes(const at::Tensor& tensor) {
+  return tensor.numel() * tensor.element_size();
+}
+
+// (b x) n x k times (b x) k x m, plus an optional (b x) n x m summand
+c10::optional<OpCost> matmulCost(
+    const at::Tensor* self,
+    const at::Tensor* mat1,
+    const at::Tensor* mat2,
+    int64_t dim) {
+  if (!mat1 || !mat2 || mat1->dim() != dim || mat2->dim() != dim) {
+    return c10::nullopt;
+  }
+  int64_t batch = dim == 3 ? mat1->size(0) : 1;
+  int64_t n = mat1->size(-2);
+  int64_t k = mat1->size(-1);
+  int64_t m = mat2->size(-1);
+  OpCost cost;
+  cost.flops = 2 * batch * n * k * m;
+  cost.bytes = nbytes(*mat1) + nbytes(*mat2) + batch * n * m * mat1->element_size();
+  if (self) {
+    cost.flops += batch * n * m;
+    cost.bytes += nbytes(*self);
+  }
+  return cost;
+}
+
+c10::optional<OpCost> mmCost(const std::vector<c10::IValue>& inputs) {
+  return matmulCost(nullptr, tensorAt(inputs, 0), tensorAt(inputs, 1), 2);
+}
+
+c10::optional<OpCost> addmmCost(const std::vector<c10::IValue>& inputs) {
+  return matmulCost(tensorAt(inputs, 0), tensorAt(inputs, 1), tensorAt(inputs, 2), 2);
+}
+
+c10::optional<OpCost> bmmCost(const std::vector<c10::IValue>& inputs) {
+  return matmulCost(nullptr, tensorAt(inputs, 0), tensorAt(inputs, 1), 3);
+}
+
+c10::optional<OpCost> baddbmmCost(const std::vector<c10::IValue>& inputs) {
+  return matmulCost(tensorAt(inputs, 0), tensorAt(inputs, 1), tensorAt(inputs, 2), 3);
+}
+
+// The value of dimension `dim` of a conv2d int[2] argument, which may hold a
+// single value for both dimensions.
+c10::optional<int64_t> convParam(const c10::IValue& param, size_t dim) {
+  if (!param.isIntList()) {
+    return c10::nullopt;
+  }
+  auto values = param.toIntVector();
+  if (values.empty()) {
+    return c10::nullopt;
+  }
+  return values.size() > dim ? values[dim] : values[0];
+}
+
+// conv2d(input, weight, bias, stride, padding, dilation, groups)
+c10::optional<OpCost> conv2dCost(const std::vector<c10::IValue>& inputs) {
+  const at::Tensor* input = tensorAt(inputs, 0);
+  const at::Tensor* weight = tensorAt(inputs, 1);
+  const at::Tensor* bias = tensorAt(inputs, 2);
+  if (!input || !weight || input->dim() != 4 || weight->dim() != 4 ||
+      inputs.size() < 7) {
+    return c10::nullopt;
+  }
+  int64_t output_numel = input->size(0) * weight->size(0);
+  for (size_t dim = 0; dim < 2; ++dim) {
+    auto stride = convParam(inputs[3], dim);
+    auto padding = convParam(inputs[4], dim);
+    auto dilation = convParam(inputs[5], dim);
+    if (!stride || !padding || !dilation || *stride <= 0) {
+      return c10::nullopt;
+    }
+    int64_t kernel = weight->size(2 + dim);
+    int64_t output_size =
+        (input->size(2 + dim) + 2 * *padding - *dilation * (kernel - 1) - 1) / *stride + 1;
+    output_numel *= std::max<int64_t>(output_size, 0);
+  }
+  // every output element is a dot product over a receptive field of the
+  // input channels of its group
+  int64_t field = weight->size(1) * weight->size(2) * weight->size(3);
+  OpCost cost;
+  cost.flops = 2 * output_numel * field;
+  cost.bytes = nbytes(*input) + nbytes(*weight) + output_numel * input->element_size();
+  if (bias) {
+    cost.flops += output_numel;
+    cost.bytes += nbytes(*bias);
+  }
+  return cost;
+}
+
+// The number of elements of the broadcast of `a` and `b`, nullopt if they
+// don't broadcast.
+c10::optional<int64_t> broadcastNumel(const at::Tensor& a, const at::Tensor& b) {
+  int64_t numel = 1;
+  int64_t dim = std::max(a.dim(), b.dim());
+  for (int64_t i = 1; i <= dim; ++i) {
+    int64_t size_a = i <= a.dim() ? a.size(-i) : 1;
+    int64_t size_b = i <= b.dim() ? b.size(-i) : 1;
+    if (size_a != size_b && size_a != 1 && size_b != 1) {
+      return c10::nullopt;
+    }
+    numel *= size_a == 1 ? size_b : size_a;
+  }
+  return numel;
+}
+
+// One operation per output element, for the binary operators whose second
+// operand may be a scalar.
+c10::optional<OpCost> binaryCost(const std::vector<c10::IValue>& inputs) {
+  const at::Tensor* self = tensorAt(inputs, 0);
+  if (!self) {
+    return c10::nullopt;
+  }
+  const at::Tensor* other = tensorAt(inputs, 1);
+  c10::optional<int64_t> numel =
+      other ? broadcastNumel(*self, *other) : c10::optional<int64_t>(self->numel());
+  if (!numel) {
+    return c10::nullopt;
+  }
+  OpCost cost;
+  cost.flops = *numel;
+  cost.bytes = nbytes(*self) + (other ? nbytes(*other) : 0) + *numel * self->element_size();
+  return cost;
+}
+
+c10::optional<OpCost> unaryCost(const std::vector<c10::IValue>& inputs) {
+  const at::Tensor* self = tensorAt(inputs, 0);
+  if (!self) {
+    return c10::nullopt;
+  }
+  OpCost cost;
+  cost.flops = self->numel();
+  cost.bytes = 2 * nbytes(*self);
+  return cost;
+}
+
+// The bytes a collective sends, those of the tensors of its inputs
+c10::optional<OpCost> communicationCost(const std::vector<c10::IValue>& inputs) {
+  OpCost cost;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    if (const at::Tensor* tensor = tensorAt(inputs, i)) {
+      cost.bytes += nbytes(*tensor);
+    }
+  }
+  return cost;
+}
+
+const std::unordered_map<std::string, CostFn>& costFns() {
+  static const std::unordered_map<std::string, CostFn> cost_fns = {
+    {"aten::mm", mmCost},
+    {"aten::addmm", addmmCost},
+    {"aten::bmm", bmmCost},
+    {"aten::baddbmm", baddbmmCost},
+    {"aten::conv2d", conv2dCost},
+    {"aten::add", binaryCost},
+    {"aten::add_", binaryCost},
+    {"aten::sub", binaryCost},
+    {"aten::sub_", binaryCost},
+    {"aten::mul", binaryCost},
+    {"aten::mul_", binaryCost},
+    {"aten::div", binaryCost},
+    {"aten::div_", binaryCost},
+    {"aten::relu", unaryCost},
+    {"aten::relu_", unaryCost},
+    {"aten::sigmoid", unaryCost},
+    {"aten::tanh", unaryCost},
+    {"aten::exp", unaryCost},
+    {"nccl:all_reduce", communicationCost},
+    {"nccl:broadcast", communicationCost},
+    {"nccl:reduce", communicationCost},
+    {"nccl:all_gather", communicationCost},
+    {"nccl:reduce_scatter", communicationCost},
+    {"nccl:all_to_all", communicationCost},
+    {"nccl:coalesced", communicationCost},
+  };
+  return cost_fns;
+}
+
+#ifdef __linux__
+// The counters of a thread, opened as one group led by the cycles counter so
+// that the PMU schedules them together and a single read returns them all.
+class PerfCounterGroup {
+ public:
+  PerfCounterGroup() {
+    static const std::array<uint64_t, NUM_PERF_COUNTERS> configs = {{
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        // the last level cache misses on most PMUs
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES,
+    }};
+    for (size_t i = 0; i < NUM_PERF_COUNTERS; ++i) {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = configs[i];
+      // the group starts counting once all the counters are open
+      attr.disabled = i == 0;
+      // counting the kernel needs perf_event_paranoid < 2
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+          PERF_FORMAT_TOTAL_TIME_RUNNING;
+      int fd = syscall(
+          __NR_perf_event_open,
+          &attr,
+          /* pid: the calling thread */ 0,
+          /* cpu: any */ -1,
+          /* group_fd */ fds_.empty() ? -1 : fds_[0],
+          /* flags */ 0);
+      if (fd < 0) {
+        close();
+        return;
+      }
+      fds_.push_back(fd);
+    }
+    ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+
+  ~PerfCounterGroup() {
+    close();
+  }
+
+  bool read(PerfCounterValues* values) {
+    if (fds_.empty()) {
+      return false;
+    }
+    struct {
+      uint64_t nr;
+      uint64_t time_enabled;
+      uint64_t time_running;
+      uint64_t values[NUM_PERF_COUNTERS];
+    } data;
+    if (::read(fds_[0], &data, sizeof(data)) != sizeof(data) ||
+        data.nr != NUM_PERF_COUNTERS) {
+      return false;
+    }
+    // When other users of the PMU made the kernel multiplex the counters,
+    // they only counted while running and are extrapolated to the time they
+    // were enabled.
+    double scale = 1.0;
+    if (data.time_running > 0 && data.time_running < data.time_enabled) {
+      scale = static_cast<double>(data.time_enabled) / data.time_running;
+    }
+    for (size_t i = 0; i < NUM_PERF_COUNTERS; ++i) {
+      (*values)[i] = static_cast<int64_t>(data.values[i] * scale);
+    }
+    return true;
+  }
+
+ private:
+  void close() {
+    for (auto it = fds_.rbegin(); it != fds_.rend(); ++it) {
+      ::close(*it);
+    }
+    fds_.clear();
+  }
+
+  std::vector<int> fds_;
+};
+
+PerfCounterGroup& threadPerfCounterGroup() {
+  thread_local PerfCounterGroup group;
+  return group;
+}
+#endif
+
+} // namespace
+
+c10::optional<OpCost> estimateOpCost(
+    const char* name,
+    const std::vector<c10::IValue>& inputs) {
+  const auto& cost_fns = costFns();
+  auto it = cost_fns.find(name);
+  if (it == cost_fns.end()) {
+    return c10::nullopt;
+  }
+  return it->second(inputs);
+}
+
+bool readPerfCounters(PerfCounterValues* values) {
+#ifdef __linux__
+  return threadPerfCounterGroup().read(values);
+#else
+  return false;
+#endif
+}
+
+bool perfCountersAvailable() {
+  PerfCounterValues values;
+  return readPerfCounters(&values);
+}
+
+}}} // namespace torch::autograd::profiler
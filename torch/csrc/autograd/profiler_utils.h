@@ -0,0 +1,52 @@
+#pragma once
+
+#include <ATen/core/ivalue.h>
+#include <c10/util/Optional.h>
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace torch { namespace autograd { namespace profiler {
+
+// The work an operator does: the floating point operations it performs and
+// the bytes it reads and writes, assuming every input and output is moved
+// through memory once.
+struct OpCost {
+  int64_t flops = 0;
+  int64_t bytes = 0;
+};
+
+// Estimates the cost of the operator `name` (e.g. "aten::addmm") from its
+// inputs, for the matrix multiplications, 2d convolutions and common
+// elementwise operators, and the bytes the NCCL collectives of c10d send
+// (e.g. "nccl:all_reduce"). Returns nullopt for any other operator, or when the
+// inputs don't have the expected types or shapes.
+TORCH_API c10::optional<OpCost> estimateOpCost(
+    const char* name,
+    const std::vector<c10::IValue>& inputs);
+
+// The hardware events counted by readPerfCounters, in the order of its values.
+enum PerfCounter {
+  CYCLES = 0,
+  INSTRUCTIONS,
+  LLC_MISSES,
+  BRANCH_MISSES,
+  NUM_PERF_COUNTERS // must be last in list
+};
+
+using PerfCounterValues = std::array<int64_t, NUM_PERF_COUNTERS>;
+
+// Reads the hardware counters of the calling thread, which are opened with
+// perf_event_open the first time the thread reads them and count its user
+// space execution from then on. The difference of two reads is what the
+// thread executed between them. Returns false when the counters aren't
+// available: not on Linux, no PMU access, or kernel.perf_event_paranoid
+// forbidding it.
+TORCH_API bool readPerfCounters(PerfCounterValues* values);
+
+// Whether the calling thread can read its hardware counters.
+TORCH_API bool perfCountersAvailable();
+
+}}} // namespace torch::autograd::profiler
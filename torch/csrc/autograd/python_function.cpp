@@ -203,6 +203,14 @@ auto PyNode::release_variables() -> void {
   f->has_freed_buffers = 1;
 }
 
+auto PyNode::prefetch_variables() -> void {
+  pybind11::gil_scoped_acquire gil;
+  auto f = (THPFunction*) obj;
+  for (const auto& var : f->saved_variables) {
+    var.prefetch();
+  }
+}
+
 auto PyNode::name() const -> std::string {
   pybind11::gil_scoped_acquire gil;
   auto f = (THPFunction*) obj;
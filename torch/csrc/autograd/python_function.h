@@ -39,6 +39,7 @@ struct PyNode : public Node {
   // Follow up issue: https://github.com/pytorch/pytorch/issues/35006
   void throw_python_error();
   void release_variables() override;
+  void prefetch_variables() override;
   std::string name() const override;
   bool is_traceable() override;
 
@@ -0,0 +1,89 @@
+#include <torch/csrc/autograd/python_saved_variable_hooks.h>
+
+#include <torch/csrc/Exceptions.h>
+#include <torch/csrc/autograd/python_variable.h>
+#include <torch/csrc/utils/object_ptr.h>
+
+namespace torch { namespace autograd {
+
+PySavedVariableHooks::PySavedVariableHooks(
+    PyObject* pack_hook, PyObject* unpack_hook, PyObject* prefetch_hook)
+  : pack_hook_(pack_hook), unpack_hook_(unpack_hook), prefetch_hook_(prefetch_hook) {
+  // The variable is saved by the op, which may run without the GIL.
+  pybind11::gil_scoped_acquire gil;
+  Py_INCREF(pack_hook_);
+  Py_INCREF(unpack_hook_);
+  Py_INCREF(prefetch_hook_);
+}
+
+PySavedVariableHooks::~PySavedVariableHooks() {
+  // The last reference to the graph may be dropped on a thread without the
+  // GIL, e.g., by the engine at the end of backward.
+  if (Py_IsInitialized()) {
+    pybind11::gil_scoped_acquire gil;
+    Py_DECREF(pack_hook_);
+    Py_DECREF(unpack_hook_);
+    Py_DECREF(prefetch_hook_);
+    Py_XDECREF(data_);
+  }
+}
+
+void PySavedVariableHooks::call_pack_hook(at::Tensor tensor) {
+  pybind11::gil_scoped_acquire gil;
+  THPObjectPtr obj(THPVariable_Wrap(std::move(tensor)));
+  if (!obj) {
+    throw python_error();
+  }
+  THPObjectPtr packed(PyObject_CallFunctionObjArgs(pack_hook_, obj.get(), nullptr));
+  if (!packed) {
+    throw python_error();
+  }
+  Py_XDECREF(data_);
+  data_ = packed.release();
+}
+
+at::Tensor PySavedVariableHooks::call_unpack_hook() {
+  pybind11::gil_scoped_acquire gil;
+  TORCH_INTERNAL_ASSERT(data_, "unpack_hook called before pack_hook");
+  THPObjectPtr res(PyObject_CallFunctionObjArgs(unpack_hook_, data_, nullptr));
+  if (!res) {
+    throw python_error();
+  }
+  if (!THPVariable_Check(res.get())) {
+    throw TypeError("Output of saved tensor unpack_hook expected to be a Tensor but got result of type %s",
+        Py_TYPE(res.get())->tp_name);
+  }
+  return THPVariable_Unpack(res.get());
+}
+
+void PySavedVariableHooks::call_prefetch_hook() {
+  pybind11::gil_scoped_acquire gil;
+  if (prefetch_hook_ == Py_None || !data_) {
+    return;
+  }
+  THPObjectPtr res(PyObject_CallFunctionObjArgs(prefetch_hook_, data_, nullptr));
+  if (!res) {
+    throw python_error();
+  }
+}
+
+PySavedVariableHooksFactory::PySavedVariableHooksFactory(
+    py::function pack_hook, py::function unpack_hook, py::object prefetch_hook)
+  : pack_hook_(pack_hook.release().ptr()),
+    unpack_hook_(unpack_hook.release().ptr()),
+    prefetch_hook_(prefetch_hook.release().ptr()) {}
+
+PySavedVariableHooksFactory::~PySavedVariableHooksFactory() {
+  if (Py_IsInitialized()) {
+    pybind11::gil_scoped_acquire gil;
+    Py_DECREF(pack_hook_);
+    Py_DECREF(unpack_hook_);
+    Py_DECREF(prefetch_hook_);
+  }
+}
+
+std::unique_ptr<SavedVariableHooks> PySavedVariableHooksFactory::make_hooks() const {
+  return std::make_unique<PySavedVariableHooks>(pack_hook_, unpack_hook_, prefetch_hook_);
+}
+
+}} // namespace torch::autograd
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <torch/csrc/python_headers.h>
+#include <torch/csrc/autograd/saved_variable_hooks.h>
+
+#include <pybind11/pybind11.h>
+
+namespace py = pybind11;
+
+namespace torch { namespace autograd {
+
+// Saved variable hooks calling python functions: `pack_hook(tensor)` returns
+// the object kept in place of the tensor, `unpack_hook(packed)` returns the
+// tensor again and the optional `prefetch_hook(packed)` is called ahead of
+// unpacking.
+struct PySavedVariableHooks : public SavedVariableHooks {
+  PySavedVariableHooks(PyObject* pack_hook, PyObject* unpack_hook, PyObject* prefetch_hook);
+  ~PySavedVariableHooks() override;
+  void call_pack_hook(at::Tensor tensor) override;
+  at::Tensor call_unpack_hook() override;
+  void call_prefetch_hook() override;
+
+ private:
+  PyObject* pack_hook_;
+  PyObject* unpack_hook_;
+  PyObject* prefetch_hook_;
+  PyObject* data_ = nullptr;
+};
+
+struct PySavedVariableHooksFactory : public SavedVariableHooksFactory {
+  PySavedVariableHooksFactory(py::function pack_hook, py::function unpack_hook, py::object prefetch_hook);
+  ~PySavedVariableHooksFactory() override;
+  std::unique_ptr<SavedVariableHooks> make_hooks() const override;
+
+ private:
+  PyObject* pack_hook_;
+  PyObject* unpack_hook_;
+  PyObject* prefetch_hook_;
+};
+
+}} // namespace torch::autograd
@@ -206,6 +206,30 @@ static inline Variable applySlicing(
   return result;
 }
 
+// Converts the elements of the tuple `index` to TensorIndex if they are all
+// integers, slices, None or Ellipsis, for at::indexing::impl::applyBasicIndexing.
+// Returns false, leaving anything else to applySlicing, otherwise.
+static inline bool unpackBasicIndices(PyObject* index, c10::SmallVector<at::indexing::TensorIndex, 8>& indices) {
+  auto size = PyTuple_GET_SIZE(index); // NOLINT(cppcoreguidelines-pro-type-cstyle-cast)
+  for (Py_ssize_t i = 0; i < size; i++) {
+    PyObject* obj = PyTuple_GET_ITEM(index, i); // NOLINT(cppcoreguidelines-pro-type-cstyle-cast)
+    if (THPUtils_checkLong(obj)) {
+      indices.emplace_back(THPUtils_unpackLong(obj));
+    } else if (PySlice_Check(obj)) {
+      Py_ssize_t start, stop, step;
+      checkUnpackSlice(obj, &start, &stop, &step);
+      indices.emplace_back(at::indexing::Slice(start, stop, step));
+    } else if (obj == Py_None) {
+      indices.emplace_back(at::indexing::None);
+    } else if (obj == Py_Ellipsis) {
+      indices.emplace_back(at::indexing::Ellipsis);
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
 static inline bool treatSequenceAsTuple(PyObject* index) {
   if (PyTuple_Check(index)) {
     return true;
@@ -310,6 +334,18 @@ PyObject* THPVariable_getitem(PyObject* self, PyObject* index) {
   // wrap index in a tuple if it's not already one
   THPObjectPtr holder = wrapTuple(index);
 
+  // basic indexing, e.g. `x[i, j:k, None]`, computes its view in one step,
+  // unless the tracer has to record every select and slice
+  if (!is_tracing) {
+    c10::SmallVector<at::indexing::TensorIndex, 8> basicIndices;
+    if (unpackBasicIndices(holder.get(), basicIndices)) {
+      Variable result = at::indexing::impl::applyBasicIndexing(self_, basicIndices);
+      if (result.defined()) {
+        return THPVariable_Wrap(std::move(result));
+      }
+    }
+  }
+
   variable_list variableIndices;
   Variable sliced = applySlicing(
     self_, holder.get(), variableIndices, /*is_tracing=*/is_tracing, self_.device(), self_.sizes());
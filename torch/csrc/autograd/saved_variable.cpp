@@ -2,18 +2,48 @@
 
 #include <torch/csrc/autograd/edge.h>
 #include <torch/csrc/autograd/function.h>
+#include <torch/csrc/autograd/grad_mode.h>
 #include <torch/csrc/autograd/variable.h>
 #include <torch/csrc/autograd/anomaly_mode.h>
 
 #include <ATen/Tensor.h>
 
+#include <atomic>
 #include <cstdint>
 #include <list>
 #include <memory>
 #include <sstream>
+#include <vector>
 
 namespace torch { namespace autograd {
 
+namespace {
+
+thread_local std::vector<std::shared_ptr<SavedVariableHooksFactory>> default_hooks_stack;
+std::atomic<bool> default_hooks_ever_used{false};
+
+} // namespace
+
+void SavedVariableDefaultHooks::push_hooks(std::shared_ptr<SavedVariableHooksFactory> factory) {
+  if (factory) {
+    default_hooks_ever_used.store(true, std::memory_order_relaxed);
+  }
+  default_hooks_stack.push_back(std::move(factory));
+}
+
+void SavedVariableDefaultHooks::pop_hooks() {
+  TORCH_INTERNAL_ASSERT(!default_hooks_stack.empty(), "no saved variable hooks to pop");
+  default_hooks_stack.pop_back();
+}
+
+std::shared_ptr<SavedVariableHooksFactory> SavedVariableDefaultHooks::get_hooks() {
+  return default_hooks_stack.empty() ? nullptr : default_hooks_stack.back();
+}
+
+bool SavedVariableDefaultHooks::ever_used() {
+  return default_hooks_ever_used.load(std::memory_order_relaxed);
+}
+
 SavedVariable::SavedVariable(const Variable& variable, bool is_output, bool is_inplace_view) {
   if (variable.defined()) {
     was_default_constructed_ = false;
@@ -33,6 +63,16 @@ SavedVariable::SavedVariable(const Variable& variable, bool is_output, bool is_i
     }
     version_counter_ = impl::version_counter(variable);
     saved_version_ = version_counter_.current_version();
+
+    if (auto hooks_factory = SavedVariableDefaultHooks::get_hooks()) {
+      hooks_ = hooks_factory->make_hooks();
+      // Whatever the hooks compute isn't part of the graph, and doesn't save
+      // variables of its own.
+      SavedVariableHooksGuard no_hooks(nullptr);
+      AutoGradMode no_grad(false);
+      hooks_->call_pack_hook(data_);
+      data_.reset();
+    }
   }
 }
 
@@ -40,13 +80,21 @@ SavedVariable::SavedVariable(const c10::optional<Variable>& variable, bool is_ou
   : SavedVariable(variable.has_value() ? *variable : Variable(), is_output, is_inplace_view) {}
 
 Variable SavedVariable::unpack(std::shared_ptr<Node> saved_for) const {
-  if (!data_.defined()) {
+  if (!data_.defined() && !hooks_) {
     if (!was_default_constructed_) {
       throw std::runtime_error(ERR_BACKWARD_TWICE);
     }
     return Variable();
   }
 
+  at::Tensor data = data_;
+  if (hooks_) {
+    SavedVariableHooksGuard no_hooks(nullptr);
+    AutoGradMode no_grad(false);
+    data = hooks_->call_unpack_hook();
+    TORCH_CHECK(data.defined(), "the unpack hook of a saved tensor returned an undefined tensor");
+  }
+
   auto grad_fn = is_inplace_view_ ? weak_grad_fn_.lock() : grad_fn_;
   if (has_grad_fn_ && !grad_fn) {
     if (!saved_for) {
@@ -60,8 +108,8 @@ Variable SavedVariable::unpack(std::shared_ptr<Node> saved_for) const {
   if (saved_version_ != version_counter_.current_version()) {
     std::stringstream message;
     message << "one of the variables needed for gradient computation has been "
-        "modified by an inplace operation: [" << data_.toString() << " "
-        << data_.sizes() << "]";
+        "modified by an inplace operation: [" << data.toString() << " "
+        << data.sizes() << "]";
     if (grad_fn) {
         message << ", which is output " << output_nr_
             << " of " << grad_fn->name() << ",";
@@ -86,9 +134,9 @@ Variable SavedVariable::unpack(std::shared_ptr<Node> saved_for) const {
   // in-place functions on unpacked variables.
   Variable var;
   if (grad_fn) {
-    var = make_variable(data_, Edge(std::move(grad_fn), output_nr_));
+    var = make_variable(data, Edge(std::move(grad_fn), output_nr_));
   } else {
-    var = make_variable(data_, requires_grad_);
+    var = make_variable(data, requires_grad_);
   }
   impl::set_version_counter(var, saved_version_);
 
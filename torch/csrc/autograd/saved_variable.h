@@ -1,6 +1,7 @@
 #pragma once
 
 #include <torch/csrc/WindowsTorchApiMacro.h>
+#include <torch/csrc/autograd/saved_variable_hooks.h>
 
 #include <ATen/ATen.h>
 
@@ -16,6 +17,8 @@ TORCH_API extern const char* ERR_BACKWARD_TWICE;
 
 /// A snapshot of a variable at a certain version. A `SavedVariable` stores
 /// enough information to reconstruct a variable from a certain point in time.
+/// If saved variable hooks are installed when it is constructed, the data is
+/// handed to them instead of being held (see saved_variable_hooks.h).
 class TORCH_API SavedVariable {
  public:
   SavedVariable() = default;
@@ -30,9 +33,17 @@ class TORCH_API SavedVariable {
   Variable unpack(std::shared_ptr<Node> saved_for = nullptr) const;
 
   void reset_data() {
+    hooks_.reset();
     return data_.reset();
   }
 
+  /// Lets the hooks, if any, start bringing the data back before `unpack()`.
+  void prefetch() const {
+    if (hooks_) {
+      hooks_->call_prefetch_hook();
+    }
+  }
+
   void reset_grad_function() {
     grad_fn_.reset();
   }
@@ -40,6 +51,10 @@ class TORCH_API SavedVariable {
  private:
   at::Tensor data_;
 
+  // Set if the data was packed into saved variable hooks, in which case data_
+  // is undefined.
+  std::unique_ptr<SavedVariableHooks> hooks_;
+
   // The gradient function associated with this node. If has_grad_fn
   // is false, then this is a leaf node. Note that the grad_fn is not saved if
   // it would create a circular reference. In that case, the grad_fn must be
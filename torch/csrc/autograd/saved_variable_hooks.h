@@ -0,0 +1,58 @@
+#pragma once
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <ATen/ATen.h>
+
+#include <memory>
+
+namespace torch { namespace autograd {
+
+/// The hooks of a single `SavedVariable`, which take over the storage of the
+/// saved data, e.g., to offload it to host memory until backward needs it.
+struct TORCH_API SavedVariableHooks {
+  /// Called once when the variable is saved. From then on, the hooks own
+  /// whatever they keep of `tensor`; the `SavedVariable` doesn't hold it.
+  virtual void call_pack_hook(at::Tensor tensor) = 0;
+
+  /// Called every time the variable is unpacked. Must return a tensor with the
+  /// same sizes, dtype and content as the packed one.
+  virtual at::Tensor call_unpack_hook() = 0;
+
+  /// Called by the engine before it runs the node the variable was saved for,
+  /// so that the hooks can start bringing the data back ahead of
+  /// `call_unpack_hook`. May be called several times, or not at all.
+  virtual void call_prefetch_hook() {}
+
+  virtual ~SavedVariableHooks() = default;
+};
+
+/// Makes the hooks of the variables saved while it is installed.
+struct TORCH_API SavedVariableHooksFactory {
+  virtual std::unique_ptr<SavedVariableHooks> make_hooks() const = 0;
+  virtual ~SavedVariableHooksFactory() = default;
+};
+
+/// The saved variable hooks of the current thread are a stack of factories,
+/// of which the innermost one makes the hooks of every variable saved on this
+/// thread, i.e., of the part of the graph recorded while it is installed.
+/// Pushing nullptr disables the hooks until it is popped again.
+struct TORCH_API SavedVariableDefaultHooks {
+  static void push_hooks(std::shared_ptr<SavedVariableHooksFactory> factory);
+  static void pop_hooks();
+  static std::shared_ptr<SavedVariableHooksFactory> get_hooks();
+  /// Whether hooks were ever pushed, on any thread. The engine only issues
+  /// prefetches once they were.
+  static bool ever_used();
+};
+
+struct TORCH_API SavedVariableHooksGuard {
+  explicit SavedVariableHooksGuard(std::shared_ptr<SavedVariableHooksFactory> factory) {
+    SavedVariableDefaultHooks::push_hooks(std::move(factory));
+  }
+  ~SavedVariableHooksGuard() {
+    SavedVariableDefaultHooks::pop_hooks();
+  }
+};
+
+}} // namespace torch::autograd
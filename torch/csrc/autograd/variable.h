@@ -453,13 +453,22 @@ inline Variable make_variable_differentiable_view(
     CreationMeta creation_meta,
     c10::optional<std::function<at::Tensor(const at::Tensor&)>> view_func = c10::nullopt) {
   if (data.defined()) {
-    auto data_impl_copy = data.getIntrusivePtr()->shallow_copy_and_detach(
-      /*version_counter=*/0,
-      /*allow_tensor_metadata_change=*/true);
-    data_impl_copy->set_autograd_meta(std::make_unique<DifferentiableViewMeta>(
-      data_impl_copy.get(), std::move(base), std::move(view_func),
+    // The output of a view kernel is usually a fresh TensorImpl that nothing
+    // else refers to, in which case it becomes the view itself instead of
+    // being copied once more.
+    c10::intrusive_ptr<at::TensorImpl> data_impl;
+    if (data.getIntrusivePtr().use_count() == 1 && data.getIntrusivePtr()->unique_version()) {
+      data_impl = data.getIntrusivePtr();
+      data_impl->set_allow_tensor_metadata_change(true);
+    } else {
+      data_impl = data.getIntrusivePtr()->shallow_copy_and_detach(
+        /*version_counter=*/0,
+        /*allow_tensor_metadata_change=*/true);
+    }
+    data_impl->set_autograd_meta(std::make_unique<DifferentiableViewMeta>(
+      data_impl.get(), std::move(base), std::move(view_func),
       creation_meta));
-    return Variable(data_impl_copy);
+    return Variable(std::move(data_impl));
   }
   return Variable();
 }
@@ -471,6 +480,13 @@ inline Variable make_variable_non_differentiable_view(
     at::Tensor data,
     bool allow_tensor_metadata_change = true) {
   if (data.defined()) {
+    if (data.getIntrusivePtr().use_count() == 1 && data.getIntrusivePtr()->unique_version()) {
+      auto data_impl = data.getIntrusivePtr();
+      data_impl->set_version_counter(impl::version_counter(base));
+      data_impl->set_allow_tensor_metadata_change(allow_tensor_metadata_change);
+      data_impl->set_autograd_meta(nullptr);
+      return Variable(std::move(data_impl));
+    }
     auto data_impl_copy = data.getIntrusivePtr()->shallow_copy_and_detach(
       /*version_counter=*/impl::version_counter(base),
       /*allow_tensor_metadata_change=*/allow_tensor_metadata_change);
@@ -5,10 +5,15 @@
 #include <sstream>
 #include <TH/TH.h>
 #include <ATen/ATen.h>
+#include <ATen/cuda/AsyncCopy.h>
+#include <ATen/cuda/CoalescedCopy.h>
 #include <ATen/cuda/CUDAContext.h>
 #include <ATen/CUDAGeneratorImpl.h>
 #include <c10/cuda/CUDAFunctions.h>
 #include <c10/cuda/CUDACachingAllocator.h>
+#include <c10/cuda/CUDAException.h>
+#include <c10/cuda/CUDAGuard.h>
+#include <c10/util/Backtrace.h>
 #ifdef USE_NCCL
 #include <torch/csrc/cuda/python_nccl.h>
 #endif
@@ -20,8 +25,11 @@
 #include <torch/csrc/utils/python_strings.h>
 #include <torch/csrc/cuda/python_comm.h>
 #include <torch/csrc/Generator.h>
+#include <torch/csrc/jit/python/pybind_utils.h>
 #include <torch/csrc/python_headers.h>
 
+#include <frameobject.h>
+
 #ifndef WIN32
 #include <pthread.h>
 #endif
@@ -197,6 +205,41 @@ PyObject * THCPModule_cudaSynchronize(PyObject *_unused, PyObject *noargs)
   END_HANDLE_TH_ERRORS
 }
 
+// Makes the work queued on `consumer` from now on wait for the work queued on
+// `producer` so far, without blocking the host. Both are raw stream handles of
+// the given device, where 0 is its default stream.
+PyObject * THCPModule_cudaStreamWaitStream(PyObject *_unused, PyObject *args)
+{
+  HANDLE_TH_ERRORS
+  int device = -1;
+  unsigned long long producer = 0;
+  unsigned long long consumer = 0;
+  if (!PyArg_ParseTuple(args, "iKK", &device, &producer, &consumer)) {
+    THPUtils_invalidArguments(
+        args,
+        nullptr,
+        "_cuda_streamWaitStream",
+        1,
+        "(int device, intptr_t producer, intptr_t consumer);");
+    return nullptr;
+  }
+  if (producer == consumer) {
+    Py_RETURN_NONE;
+  }
+  {
+    pybind11::gil_scoped_release no_gil;
+    c10::cuda::CUDAGuard device_guard(static_cast<c10::DeviceIndex>(device));
+    cudaEvent_t event;
+    C10_CUDA_CHECK(cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
+    C10_CUDA_CHECK(cudaEventRecord(event, reinterpret_cast<cudaStream_t>(producer)));
+    C10_CUDA_CHECK(cudaStreamWaitEvent(reinterpret_cast<cudaStream_t>(consumer), event, 0));
+    // The wait is enqueued, so the event can go even if it hasn't happened yet.
+    C10_CUDA_CHECK(cudaEventDestroy(event));
+  }
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
 PyObject * THCPModule_cudaIPCCollect(PyObject *_unused, PyObject *noargs)
 {
   HANDLE_TH_ERRORS
@@ -271,12 +314,8 @@ PyObject * THCPModule_emptyCache(PyObject *_unused, PyObject *noargs)
   Py_RETURN_NONE;
 }
 
-PyObject * THCPModule_memoryStats(PyObject *_unused, PyObject *arg)
+static py::dict deviceStatsToDict(const c10::cuda::CUDACachingAllocator::DeviceStats& stats)
 {
-  HANDLE_TH_ERRORS
-  THPUtils_assert(THPUtils_checkLong(arg), "invalid argument to memory_allocated");
-  const int device = (int) THPUtils_unpackLong(arg);
-
   using c10::cuda::CUDACachingAllocator::StatType;
   using c10::cuda::CUDACachingAllocator::Stat;
   using c10::cuda::CUDACachingAllocator::StatArray;
@@ -303,8 +342,6 @@ PyObject * THCPModule_memoryStats(PyObject *_unused, PyObject *arg)
     return dict;
   };
 
-  const DeviceStats stats = c10::cuda::CUDACachingAllocator::getDeviceStats(device);
-
   py::dict result;
   result["num_alloc_retries"] = stats.num_alloc_retries;
   result["num_ooms"] = stats.num_ooms;
@@ -316,11 +353,34 @@ PyObject * THCPModule_memoryStats(PyObject *_unused, PyObject *arg)
   result["reserved_bytes"] = statArrayToDict(stats.reserved_bytes);
   result["active_bytes"] = statArrayToDict(stats.active_bytes);
   result["inactive_split_bytes"] = statArrayToDict(stats.inactive_split_bytes);
+  return result;
+}
 
-  return result.release().ptr();
+PyObject * THCPModule_memoryStats(PyObject *_unused, PyObject *arg)
+{
+  HANDLE_TH_ERRORS
+  THPUtils_assert(THPUtils_checkLong(arg), "invalid argument to memory_allocated");
+  const int device = (int) THPUtils_unpackLong(arg);
+  return deviceStatsToDict(c10::cuda::CUDACachingAllocator::getDeviceStats(device)).release().ptr();
+  END_HANDLE_TH_ERRORS
+}
+
+PyObject * THCPModule_hostMemoryStats(PyObject *_unused, PyObject *noargs)
+{
+  HANDLE_TH_ERRORS
+  return deviceStatsToDict(THCCachingHostAllocator_getStats()).release().ptr();
   END_HANDLE_TH_ERRORS
 }
 
+PyObject * THCPModule_resetHostMemoryStats(PyObject *_unused, PyObject *noargs)
+{
+  HANDLE_TH_ERRORS
+  THCCachingHostAllocator_resetAccumulatedStats();
+  THCCachingHostAllocator_resetPeakStats();
+  END_HANDLE_TH_ERRORS
+  Py_RETURN_NONE;
+}
+
 PyObject * THCPModule_resetAccumulatedMemoryStats(PyObject *_unused, PyObject *arg)
 {
   HANDLE_TH_ERRORS
@@ -341,6 +401,22 @@ PyObject * THCPModule_resetPeakMemoryStats(PyObject *_unused, PyObject *arg)
   Py_RETURN_NONE;
 }
 
+PyObject * THCPModule_setMemoryFraction(PyObject *_unused, PyObject *args)
+{
+  HANDLE_TH_ERRORS
+  double fraction = 0;
+  int device = 0;
+  if (!PyArg_ParseTuple(args, "di", &fraction, &device)) {
+    THPUtils_invalidArguments(
+        args, nullptr, "_cuda_setMemoryFraction", 1, "(float fraction, int device)");
+    return nullptr;
+  }
+  torch::utils::cuda_lazy_init();
+  c10::cuda::CUDACachingAllocator::setMemoryFraction(fraction, device);
+  END_HANDLE_TH_ERRORS
+  Py_RETURN_NONE;
+}
+
 PyObject * THCPModule_memorySnapshot(PyObject *_unused, PyObject *noargs)
 {
   HANDLE_TH_ERRORS
@@ -356,6 +432,7 @@ PyObject * THCPModule_memorySnapshot(PyObject *_unused, PyObject *noargs)
     segmentDict["allocated_size"] = segmentInfo.allocated_size;
     segmentDict["active_size"] = segmentInfo.active_size;
     segmentDict["segment_type"] = (segmentInfo.is_large ? "large" : "small");
+    segmentDict["is_expandable"] = segmentInfo.is_expandable;
 
     py::list blocks;
     for (const auto& blockInfo : segmentInfo.blocks) {
@@ -380,6 +457,87 @@ PyObject * THCPModule_memorySnapshot(PyObject *_unused, PyObject *noargs)
   END_HANDLE_TH_ERRORS
 }
 
+// Allocation history context holding the Python (and optionally C++) stack
+// of the allocating thread. Frames are rendered to a string right away so that
+// the context can be destroyed without the GIL.
+struct PythonStackContext : public c10::cuda::CUDACachingAllocator::Context {
+  std::string python_stack;
+  std::string cpp_stack;
+
+  std::string str() const override {
+    return cpp_stack.empty() ? python_stack : python_stack + cpp_stack;
+  }
+
+  static std::shared_ptr<PythonStackContext> gather() {
+    auto context = std::make_shared<PythonStackContext>();
+    if (!Py_IsInitialized()) {
+      return context;
+    }
+    pybind11::gil_scoped_acquire gil;
+    std::ostringstream oss;
+    for (PyFrameObject* frame = PyEval_GetFrame(); frame != nullptr; frame = frame->f_back) {
+      oss << THPUtils_unpackString(frame->f_code->co_filename) << ":"
+          << PyFrame_GetLineNumber(frame) << " "
+          << THPUtils_unpackString(frame->f_code->co_name) << "\n";
+    }
+    context->python_stack = oss.str();
+    return context;
+  }
+};
+
+static std::shared_ptr<c10::cuda::CUDACachingAllocator::Context> gatherPythonStack() {
+  return PythonStackContext::gather();
+}
+
+static std::shared_ptr<c10::cuda::CUDACachingAllocator::Context> gatherPythonAndCppStack() {
+  auto context = PythonStackContext::gather();
+  context->cpp_stack = c10::get_backtrace(/*frames_to_skip=*/3);
+  return context;
+}
+
+PyObject * THCPModule_recordMemoryHistory(PyObject *_unused, PyObject *args)
+{
+  HANDLE_TH_ERRORS
+  int enabled = 0;
+  const char* context = nullptr;
+  Py_ssize_t max_entries = 0;
+  if (!PyArg_ParseTuple(args, "pzn", &enabled, &context, &max_entries)) {
+    THPUtils_invalidArguments(
+        args, nullptr, "_cuda_recordMemoryHistory", 1,
+        "(bool enabled, str context, int max_entries)");
+    return nullptr;
+  }
+  THPUtils_assert(max_entries > 0, "max_entries must be positive");
+  c10::cuda::CUDACachingAllocator::CreateContextFn recorder = nullptr;
+  const std::string context_str = context ? context : "";
+  if (context_str == "python") {
+    recorder = gatherPythonStack;
+  } else if (context_str == "cpp") {
+    recorder = c10::cuda::CUDACachingAllocator::gatherCppBacktrace;
+  } else if (context_str == "all") {
+    recorder = gatherPythonAndCppStack;
+  } else {
+    THPUtils_assert(context == nullptr,
+        "context must be None, 'python', 'cpp' or 'all', got %s", context);
+  }
+  torch::utils::cuda_lazy_init();
+  c10::cuda::CUDACachingAllocator::recordHistory(enabled, recorder, max_entries);
+  END_HANDLE_TH_ERRORS
+  Py_RETURN_NONE;
+}
+
+PyObject * THCPModule_memoryHistoryJson(PyObject *_unused, PyObject *noargs)
+{
+  HANDLE_TH_ERRORS
+  std::string json;
+  {
+    pybind11::gil_scoped_release no_gil;
+    json = c10::cuda::CUDACachingAllocator::historyToJson();
+  }
+  return THPUtils_packString(json);
+  END_HANDLE_TH_ERRORS
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Cuda module initialization
 ////////////////////////////////////////////////////////////////////////////////
@@ -412,6 +570,29 @@ static void bindGetDeviceProperties(PyObject* module) {
   }, py::return_value_policy::reference);
 }
 
+static void bindCopyToHostAsync(PyObject* module) {
+  auto m = py::handle(module).cast<py::module>();
+  m.def("_copy_to_host_async", [](const at::Tensor& src) {
+    return std::make_shared<jit::PythonFutureWrapper>(
+        at::cuda::copy_to_host_async(src));
+  });
+  m.def("_copy_to_host_async", [](const std::vector<at::Tensor>& srcs) {
+    return std::make_shared<jit::PythonFutureWrapper>(
+        at::cuda::copy_to_host_async(srcs));
+  });
+}
+
+static void bindToCoalesced(PyObject* module) {
+  auto m = py::handle(module).cast<py::module>();
+  m.def("_to_coalesced", [](
+      const std::vector<at::Tensor>& tensors,
+      const std::string& device,
+      bool non_blocking,
+      bool views) {
+    return at::cuda::to_coalesced(tensors, at::Device(device), non_blocking, views);
+  }, py::call_guard<py::gil_scoped_release>());
+}
+
 // Callback for python part. Used for additional initialization of python classes
 static PyObject * THCPModule_initExtension(PyObject *self, PyObject *noargs)
 {
@@ -470,6 +651,8 @@ static PyObject * THCPModule_initExtension(PyObject *self, PyObject *noargs)
   }
   set_module_attr("default_generators", default_cuda_generators);
   bindGetDeviceProperties(m);
+  bindCopyToHostAsync(m);
+  bindToCoalesced(m);
 
   Py_RETURN_NONE;
   END_HANDLE_TH_ERRORS
@@ -500,13 +683,19 @@ static struct PyMethodDef _THCPModule_methods[] = {
   {"_cuda_hasPrimaryContext", (PyCFunction) THCPModule_hasPrimaryContext,  METH_O,  nullptr},
   {"_cuda_emptyCache", (PyCFunction) THCPModule_emptyCache, METH_NOARGS, nullptr},
   {"_cuda_memoryStats", (PyCFunction) THCPModule_memoryStats, METH_O, nullptr},
+  {"_cuda_hostMemoryStats", (PyCFunction) THCPModule_hostMemoryStats, METH_NOARGS, nullptr},
+  {"_cuda_resetHostMemoryStats", (PyCFunction) THCPModule_resetHostMemoryStats, METH_NOARGS, nullptr},
   {"_cuda_resetAccumulatedMemoryStats", (PyCFunction) THCPModule_resetAccumulatedMemoryStats, METH_O, nullptr},
   {"_cuda_resetPeakMemoryStats", (PyCFunction) THCPModule_resetPeakMemoryStats, METH_O,  nullptr},
+  {"_cuda_setMemoryFraction", (PyCFunction) THCPModule_setMemoryFraction, METH_VARARGS, nullptr},
   {"_cuda_memorySnapshot", (PyCFunction) THCPModule_memorySnapshot, METH_NOARGS, nullptr},
+  {"_cuda_recordMemoryHistory", (PyCFunction) THCPModule_recordMemoryHistory, METH_VARARGS, nullptr},
+  {"_cuda_memoryHistoryJson", (PyCFunction) THCPModule_memoryHistoryJson, METH_NOARGS, nullptr},
   {"_cuda_cudaHostAllocator", (PyCFunction)THCPModule_cudaHostAllocator, METH_NOARGS, nullptr},
   {"_cuda_cudaCachingAllocator_raw_alloc", (PyCFunction)THCPModule_cudaCachingAllocator_raw_alloc, METH_VARARGS, nullptr},
   {"_cuda_cudaCachingAllocator_raw_delete", (PyCFunction)THCPModule_cudaCachingAllocator_raw_delete, METH_O, nullptr},
   {"_cuda_synchronize", (PyCFunction)THCPModule_cudaSynchronize, METH_NOARGS, nullptr},
+  {"_cuda_streamWaitStream", (PyCFunction)THCPModule_cudaStreamWaitStream, METH_VARARGS, nullptr},
   {"_cuda_ipc_collect", (PyCFunction)THCPModule_cudaIPCCollect, METH_NOARGS, nullptr},
   {"_cuda_sleep", (PyCFunction)THCPModule_cudaSleep, METH_O, nullptr},
   {"_cuda_lock_mutex",   (PyCFunction)THCPModule_cudaLockMutex,   METH_NOARGS,  nullptr},
@@ -5,6 +5,7 @@
 #include <torch/csrc/autograd/input_buffer.h>
 #include <torch/csrc/distributed/autograd/context/container.h>
 #include <torch/csrc/distributed/autograd/engine/dist_engine.h>
+#include <torch/csrc/distributed/autograd/functions/recvrpc_backward.h>
 
 namespace torch {
 namespace distributed {
@@ -107,7 +108,7 @@ void DistEngine::globalCpuThread(
 }
 
 DistEngine::DistEngine()
-    : initializedContextIds_(),
+    : initializedContexts_(kNumInitializedContextsShards),
       engine_(Engine::get_default_engine()),
       global_cpu_ready_queue_(std::make_shared<ReadyQueue>()),
       global_cpu_thread_(
@@ -143,6 +144,30 @@ DistEngine& DistEngine::getInstance() {
   return *engine;
 }
 
+inline DistEngine::InitializedContextsShard& DistEngine::
+    getInitializedContextsShard(int64_t contextId) {
+  return initializedContexts_[contextId & (kNumInitializedContextsShards - 1)];
+}
+
+std::shared_ptr<std::once_flag> DistEngine::getOrCreateInitializedFlag(
+    int64_t contextId,
+    bool& inserted) {
+  auto& shard = getInitializedContextsShard(contextId);
+  std::lock_guard<std::mutex> guard(shard.lock);
+  auto& flag = shard.contexts[contextId];
+  inserted = (flag == nullptr);
+  if (inserted) {
+    flag = std::make_shared<std::once_flag>();
+  }
+  return flag;
+}
+
+void DistEngine::eraseInitializedContext(int64_t contextId) {
+  auto& shard = getInitializedContextsShard(contextId);
+  std::lock_guard<std::mutex> guard(shard.lock);
+  shard.contexts.erase(contextId);
+}
+
 void DistEngine::validateRootsAndRetrieveEdges(
     const variable_list& roots,
     edge_list& rootEdges,
@@ -329,6 +354,11 @@ void DistEngine::execute_graph_task_until_ready_queue_empty(
 
   torch::autograd::set_device(torch::autograd::CPU_DEVICE);
   graph_task->owner_ = torch::autograd::CPU_DEVICE;
+
+  // The RecvRpcBackward functions run below queue their gradients in the
+  // batch, which sends them once the ready queue is drained, in a single
+  // PropagateGradientsReq per destination worker.
+  PropagateGradientsBatch gradientsBatch;
   while (!cpu_ready_queue->empty()) {
     std::shared_ptr<GraphTask> local_graph_task;
     {
@@ -353,6 +383,17 @@ void DistEngine::execute_graph_task_until_ready_queue_empty(
           break;
         }
       }
+      // Send the gradients before the last task is marked as done, since a
+      // concurrent call for the same GraphTask could otherwise complete it
+      // and wait for the outstanding RPCs before these are recorded.
+      if (cpu_ready_queue->empty()) {
+        try {
+          gradientsBatch.send();
+        } catch (std::exception& e) {
+          engine_.thread_on_exception(local_graph_task, task.fn_, e);
+          break;
+        }
+      }
     }
     // Decrement the outstanding task.
     --local_graph_task->outstanding_tasks_;
@@ -422,19 +463,31 @@ std::shared_ptr<rpc::FutureMessage> DistEngine::executeSendFunctionAsync(
     const ContextPtr& autogradContext,
     const std::shared_ptr<Node>& sendFunction,
     bool retainGraph) {
-  std::unique_lock<std::mutex> lock(initializedContextIdsLock_);
-  if (initializedContextIds_.find(autogradContext->contextId()) ==
-      initializedContextIds_.end()) {
-    edge_list outputEdges;
-    // Pass in a dummy graphRoot since all send functions are the roots.
-    auto dummyRoot = std::make_shared<GraphRoot>(edge_list(), variable_list());
-    computeDependencies(
-        autogradContext, {}, {}, dummyRoot, outputEdges, retainGraph);
-
-    // Mark the autograd context id as initialized and unlock.
-    initializedContextIds_.insert(autogradContext->contextId());
-    lock.unlock();
+  bool inserted = false;
+  auto initializedFlag =
+      getOrCreateInitializedFlag(autogradContext->contextId(), inserted);
+
+  // The first call for the context computes the dependencies, while the
+  // concurrent calls for the same context wait for it to be done.
+  bool initializedHere = false;
+  edge_list outputEdges;
+  try {
+    std::call_once(*initializedFlag, [&]() {
+      // Pass in a dummy graphRoot since all send functions are the roots.
+      auto dummyRoot =
+          std::make_shared<GraphRoot>(edge_list(), variable_list());
+      computeDependencies(
+          autogradContext, {}, {}, dummyRoot, outputEdges, retainGraph);
+      initializedHere = true;
+    });
+  } catch (...) {
+    if (inserted) {
+      eraseInitializedContext(autogradContext->contextId());
+    }
+    throw;
+  }
 
+  if (initializedHere) {
     // Enqueue the current send function.
     auto graphTask = autogradContext->retrieveGraphTask();
     // Run the autograd engine.
@@ -490,7 +543,6 @@ std::shared_ptr<rpc::FutureMessage> DistEngine::executeSendFunctionAsync(
     // Return the future which waits for all async processing to be done.
     return callbackFuture;
   } else {
-    lock.unlock();
     auto graphTask = autogradContext->retrieveGraphTask();
     at::launch([this, graphTask, sendFunction]() {
       execute_graph_task_until_ready_queue_empty(
@@ -521,17 +573,26 @@ void DistEngine::execute(
   // Compute dependencies locally, starting from all roots and all 'send'
   // functions.
   {
-    std::lock_guard<std::mutex> guard(initializedContextIdsLock_);
+    bool inserted = false;
+    auto initializedFlag =
+        getOrCreateInitializedFlag(autogradContext->contextId(), inserted);
     // Context should not have been initialized already.
-    TORCH_INTERNAL_ASSERT(
-        initializedContextIds_.find(autogradContext->contextId()) ==
-        initializedContextIds_.end());
-
-    computeDependencies(
-        autogradContext, rootEdges, grads, graphRoot, outputEdges, retainGraph);
+    TORCH_INTERNAL_ASSERT(inserted);
 
-    // Mark the autograd context id as initialized.
-    initializedContextIds_.insert(autogradContext->contextId());
+    try {
+      std::call_once(*initializedFlag, [&]() {
+        computeDependencies(
+            autogradContext,
+            rootEdges,
+            grads,
+            graphRoot,
+            outputEdges,
+            retainGraph);
+      });
+    } catch (...) {
+      eraseInitializedContext(autogradContext->contextId());
+      throw;
+    }
   }
 
   BackwardPassCleanupGuard guard(autogradContext);
@@ -566,13 +627,16 @@ void DistEngine::cleanupBackwardPass(const ContextPtr& autogradContext) {
 
   // Clear the context id once we're done with the autograd engine
   // processing.
-  std::lock_guard<std::mutex> guard(initializedContextIdsLock_);
-  initializedContextIds_.erase(autogradContext->contextId());
+  eraseInitializedContext(autogradContext->contextId());
 }
 
 size_t DistEngine::numBackwardPasses() const {
-  std::lock_guard<std::mutex> guard(initializedContextIdsLock_);
-  return initializedContextIds_.size();
+  size_t ret = 0;
+  for (const auto& shard : initializedContexts_) {
+    std::lock_guard<std::mutex> guard(shard.lock);
+    ret += shard.contexts.size();
+  }
+  return ret;
 }
 
 std::unordered_map<std::string, int> DistEngine::getDebugInfo() const {
@@ -1,7 +1,7 @@
 #pragma once
 
 #include <mutex>
-#include <unordered_set>
+#include <unordered_map>
 
 #include <torch/csrc/autograd/engine.h>
 #include <torch/csrc/autograd/function.h>
@@ -138,11 +138,37 @@ class TORCH_API DistEngine {
   void globalCpuThread(
       const std::shared_ptr<torch::autograd::ReadyQueue>& ready_queue);
 
-  // Set of autograd context_ids, which we have already initialized for
-  // distributed autograd on this node (e.g.: already computed dependencies)
-  std::unordered_set<int64_t> initializedContextIds_;
+  // Number of shards for the set of initialized autograd contexts, which has
+  // to be a power of 2.
+  static constexpr uint32_t kNumInitializedContextsShards = 64;
+
+  // Use cache line size for alignment.
+  static constexpr int kCacheLineSize = 64;
+
+  // One shard of the autograd contexts this node runs a backward pass for,
+  // mapped to the flag which ensures dependencies are computed once for the
+  // context. The shard lock is only held to look up the flag: computing the
+  // dependencies of a context blocks the other callers for that context, but
+  // none of the backward passes of other contexts.
+  struct alignas(kCacheLineSize) InitializedContextsShard {
+    mutable std::mutex lock;
+    std::unordered_map<int64_t, std::shared_ptr<std::once_flag>> contexts;
+  };
+
+  InitializedContextsShard& getInitializedContextsShard(int64_t contextId);
 
-  mutable std::mutex initializedContextIdsLock_;
+  // Returns the flag to initialize the given context with, registering the
+  // context as running a backward pass if it is not already. Sets 'inserted'
+  // to whether the context was registered by this call.
+  std::shared_ptr<std::once_flag> getOrCreateInitializedFlag(
+      int64_t contextId,
+      bool& inserted);
+
+  void eraseInitializedContext(int64_t contextId);
+
+  // Sharded set of autograd context_ids, which we have already initialized for
+  // distributed autograd on this node (e.g.: already computed dependencies)
+  std::vector<InitializedContextsShard> initializedContexts_;
 
   // Reference to local autograd engine.
   torch::autograd::Engine& engine_;
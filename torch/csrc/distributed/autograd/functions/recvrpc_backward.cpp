@@ -10,6 +10,12 @@ namespace autograd {
 using torch::autograd::Variable;
 using torch::autograd::variable_list;
 
+namespace {
+
+thread_local PropagateGradientsBatch* current_batch_ = nullptr;
+
+} // namespace
+
 RecvRpcBackward::RecvRpcBackward(
     const AutogradMetadata& autogradMetadata,
     ContextPtr autogradContext,
@@ -38,12 +44,23 @@ variable_list RecvRpcBackward::apply(variable_list&& grads) {
           "means the autograd context was cleaned up by a different thread due ",
           "to an error before RecvRcpBackward had a chance to run"));
 
+  const bool retainGraph = sharedContext->retrieveGraphTask()->keep_graph_;
+
+  // Within a batch, the gradients are sent along with those of the other
+  // 'recv' functions for the same worker once the batch is sent.
+  if (auto batch = PropagateGradientsBatch::current()) {
+    batch->add(
+        sharedContext,
+        fromWorkerId_,
+        autogradMetadata_,
+        std::move(outputGrads),
+        retainGraph);
+    return variable_list();
+  }
+
   // Send the gradients over the wire and record the future in the autograd
   // context.
-  PropagateGradientsReq gradCall(
-      autogradMetadata_,
-      outputGrads,
-      sharedContext->retrieveGraphTask()->keep_graph_);
+  PropagateGradientsReq gradCall(autogradMetadata_, outputGrads, retainGraph);
 
   // Send the gradients over to the appropriate node.
   auto rpcAgent = rpc::RpcAgent::getCurrentRpcAgent();
@@ -58,6 +75,59 @@ variable_list RecvRpcBackward::apply(variable_list&& grads) {
   return variable_list();
 }
 
+PropagateGradientsBatch::PropagateGradientsBatch() : prev_(current_batch_) {
+  current_batch_ = this;
+}
+
+PropagateGradientsBatch::~PropagateGradientsBatch() {
+  // Gradients still queued here belong to a backward pass which failed.
+  current_batch_ = prev_;
+}
+
+PropagateGradientsBatch* PropagateGradientsBatch::current() {
+  return current_batch_;
+}
+
+void PropagateGradientsBatch::add(
+    const std::shared_ptr<DistAutogradContext>& autogradContext,
+    rpc::worker_id_t workerId,
+    const AutogradMetadata& autogradMetadata,
+    std::vector<Variable> grads,
+    bool retainGraph) {
+  auto& destination =
+      destinations_[std::make_pair(autogradContext->contextId(), workerId)];
+  destination.autogradContext = autogradContext;
+  destination.retainGraph = retainGraph;
+  destination.entries.push_back({autogradMetadata, std::move(grads)});
+}
+
+void PropagateGradientsBatch::send() {
+  if (destinations_.empty()) {
+    return;
+  }
+  auto destinations = std::move(destinations_);
+  destinations_.clear();
+
+  auto rpcAgent = rpc::RpcAgent::getCurrentRpcAgent();
+  for (auto& mapEntry : destinations) {
+    auto& destination = mapEntry.second;
+    auto sharedContext = destination.autogradContext.lock();
+    TORCH_CHECK(
+        sharedContext,
+        "Autograd context ",
+        mapEntry.first.first,
+        " no longer valid while sending its gradients to worker ",
+        mapEntry.first.second);
+
+    PropagateGradientsReq gradCall(
+        std::move(destination.entries), destination.retainGraph);
+    auto futureMessage = rpcAgent->send(
+        rpcAgent->getWorkerInfo(mapEntry.first.second),
+        std::move(gradCall).toMessage());
+    sharedContext->addOutstandingRpc(futureMessage);
+  }
+}
+
 } // namespace autograd
 } // namespace distributed
 } // namespace torch
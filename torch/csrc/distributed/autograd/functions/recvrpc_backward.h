@@ -1,8 +1,11 @@
 #pragma once
 
+#include <map>
+
 #include <torch/csrc/autograd/function.h>
 #include <torch/csrc/distributed/autograd/context/context.h>
 #include <torch/csrc/distributed/autograd/rpc_messages/autograd_metadata.h>
+#include <torch/csrc/distributed/autograd/rpc_messages/propagate_gradients_req.h>
 #include <torch/csrc/distributed/rpc/rpc_agent.h>
 
 namespace torch {
@@ -40,6 +43,49 @@ class TORCH_API RecvRpcBackward : public torch::autograd::Node {
   rpc::worker_id_t fromWorkerId_;
 };
 
+// While a PropagateGradientsBatch is alive, the RecvRpcBackward functions run
+// on the same thread queue their gradients in it instead of sending them, and
+// send() sends the gradients queued for the same autograd context and worker
+// in a single PropagateGradientsReq. The distributed engine batches each drain
+// of its ready queue this way, while the functions run on the device threads
+// of the local engine still send their gradients right away.
+class TORCH_API PropagateGradientsBatch {
+ public:
+  PropagateGradientsBatch();
+  ~PropagateGradientsBatch();
+
+  PropagateGradientsBatch(const PropagateGradientsBatch&) = delete;
+  PropagateGradientsBatch& operator=(const PropagateGradientsBatch&) = delete;
+
+  // Sends the queued gradients and records the futures of the RPCs in their
+  // autograd contexts.
+  void send();
+
+ private:
+  friend class RecvRpcBackward;
+
+  struct Destination {
+    std::weak_ptr<DistAutogradContext> autogradContext;
+    bool retainGraph;
+    std::vector<PropagateGradientsReq::Entry> entries;
+  };
+
+  // The batch of the current thread, or nullptr if there is none.
+  static PropagateGradientsBatch* current();
+
+  void add(
+      const std::shared_ptr<DistAutogradContext>& autogradContext,
+      rpc::worker_id_t workerId,
+      const AutogradMetadata& autogradMetadata,
+      std::vector<torch::autograd::Variable> grads,
+      bool retainGraph);
+
+  // Keyed by autograd context id and destination worker id.
+  std::map<std::pair<int64_t, rpc::worker_id_t>, Destination> destinations_;
+
+  PropagateGradientsBatch* prev_;
+};
+
 } // namespace autograd
 } // namespace distributed
 } // namespace torch
@@ -2,6 +2,8 @@
 #include <torch/csrc/distributed/rpc/rpc_agent.h>
 #include <torch/csrc/jit/serialization/pickle.h>
 
+#include <algorithm>
+
 namespace torch {
 namespace distributed {
 namespace autograd {
@@ -14,22 +16,33 @@ PropagateGradientsReq::PropagateGradientsReq(
     const AutogradMetadata& autogradMetadata,
     std::vector<Variable> grads,
     bool retainGraph)
-    : autogradMetadata_(autogradMetadata),
-      grads_(std::move(grads)),
-      retainGraph_(retainGraph) {}
+    : retainGraph_(retainGraph) {
+  entries_.push_back({autogradMetadata, std::move(grads)});
+}
+
+PropagateGradientsReq::PropagateGradientsReq(
+    std::vector<Entry> entries,
+    bool retainGraph)
+    : entries_(std::move(entries)), retainGraph_(retainGraph) {
+  TORCH_INTERNAL_ASSERT(!entries_.empty());
+}
 
 Message PropagateGradientsReq::toMessageImpl() && {
   std::vector<at::IValue> ivalues;
-  // Add all the grad tensors.
-  for (const auto& grad : grads_) {
-    ivalues.emplace_back(grad);
+  for (const auto& entry : entries_) {
+    // Add all the grad tensors.
+    for (const auto& grad : entry.grads) {
+      ivalues.emplace_back(grad);
+    }
+
+    // Now add autograd metadata and the number of grads of the entry.
+    ivalues.emplace_back(entry.autogradMetadata.autogradContextId);
+    ivalues.emplace_back(entry.autogradMetadata.autogradMessageId);
+    ivalues.emplace_back(static_cast<int64_t>(entry.grads.size()));
   }
 
-  // Now add autograd metadata.
-  ivalues.emplace_back(autogradMetadata_.autogradContextId);
-  ivalues.emplace_back(autogradMetadata_.autogradMessageId);
-
-  // Add retain graph.
+  // Add the number of entries and retain graph.
+  ivalues.emplace_back(static_cast<int64_t>(entries_.size()));
   ivalues.emplace_back(retainGraph_);
 
   // Now pickle using JIT pickler.
@@ -56,38 +69,63 @@ std::unique_ptr<PropagateGradientsReq> PropagateGradientsReq::fromMessage(
   std::vector<at::IValue> tupleElements = tuple.toTuple()->elements();
 
   // Build PropagateGradientsReq.
-  TORCH_INTERNAL_ASSERT(tupleElements.size() >= 3);
+  TORCH_INTERNAL_ASSERT(tupleElements.size() >= 5);
 
-  // Retrieve retainGraph.
+  // Retrieve retainGraph and the number of entries.
   bool retainGraph = tupleElements.back().toBool();
   tupleElements.pop_back();
-
-  // Build AutogradMetadata.
-  int64_t autogradContextId, autogradMessageId;
-  autogradMessageId = tupleElements.back().toInt();
-  tupleElements.pop_back();
-  autogradContextId = tupleElements.back().toInt();
+  int64_t numEntries = tupleElements.back().toInt();
   tupleElements.pop_back();
-
-  AutogradMetadata autogradMetadata(autogradContextId, autogradMessageId);
-
-  // Retrieve the gradient tensors.
-  std::vector<Variable> grads(tupleElements.size());
-  for (size_t i = 0; i < tupleElements.size(); i++) {
-    grads[i] = tupleElements[i].toTensor();
+  TORCH_INTERNAL_ASSERT(numEntries > 0);
+
+  // The entries are retrieved from the last one.
+  std::vector<Entry> entries;
+  entries.reserve(numEntries);
+  for (int64_t i = 0; i < numEntries; i++) {
+    TORCH_INTERNAL_ASSERT(tupleElements.size() >= 3);
+    int64_t numGrads = tupleElements.back().toInt();
+    tupleElements.pop_back();
+
+    // Build AutogradMetadata.
+    int64_t autogradContextId, autogradMessageId;
+    autogradMessageId = tupleElements.back().toInt();
+    tupleElements.pop_back();
+    autogradContextId = tupleElements.back().toInt();
+    tupleElements.pop_back();
+
+    // Retrieve the gradient tensors.
+    TORCH_INTERNAL_ASSERT(
+        numGrads >= 0 && static_cast<size_t>(numGrads) <= tupleElements.size());
+    const size_t start = tupleElements.size() - numGrads;
+    std::vector<Variable> grads(numGrads);
+    for (size_t j = 0; j < static_cast<size_t>(numGrads); j++) {
+      grads[j] = tupleElements[start + j].toTensor();
+    }
+    tupleElements.resize(start);
+
+    entries.push_back(
+        {AutogradMetadata(autogradContextId, autogradMessageId),
+         std::move(grads)});
   }
+  TORCH_INTERNAL_ASSERT(tupleElements.empty());
+  std::reverse(entries.begin(), entries.end());
 
   return std::unique_ptr<PropagateGradientsReq>(
-      new PropagateGradientsReq(autogradMetadata, grads, retainGraph));
+      new PropagateGradientsReq(std::move(entries), retainGraph));
 }
 
 const AutogradMetadata& PropagateGradientsReq::getAutogradMetadata() {
-  return autogradMetadata_;
+  return entries_.front().autogradMetadata;
 }
 
 const std::vector<torch::autograd::Variable>& PropagateGradientsReq::
     getGrads() {
-  return grads_;
+  return entries_.front().grads;
+}
+
+const std::vector<PropagateGradientsReq::Entry>& PropagateGradientsReq::
+    getEntries() {
+  return entries_;
 }
 
 bool PropagateGradientsReq::retainGraph() {
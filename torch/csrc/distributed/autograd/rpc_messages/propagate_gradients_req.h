@@ -11,18 +11,30 @@ namespace autograd {
 
 // Used to propagate gradients from one node to another during a distributed
 // backwards pass. This RPC call is invoked when we hit a `recv` autograd
-// function during backward pass execution.
+// function during backward pass execution. The gradients of several `recv`
+// functions for the same node may be sent together, as one entry each.
 class TORCH_API PropagateGradientsReq : public rpc::RpcCommandBase {
  public:
+  // The gradients for the `send` function of a single autograd message id.
+  struct Entry {
+    AutogradMetadata autogradMetadata;
+    std::vector<torch::autograd::Variable> grads;
+  };
+
   PropagateGradientsReq(
       const AutogradMetadata& autogradMetadata,
       std::vector<torch::autograd::Variable> grads,
       bool retainGraph = false);
 
+  PropagateGradientsReq(std::vector<Entry> entries, bool retainGraph = false);
+
+  // The metadata and gradients of the first entry.
   const AutogradMetadata& getAutogradMetadata();
 
   const std::vector<torch::autograd::Variable>& getGrads();
 
+  const std::vector<Entry>& getEntries();
+
   // Serialization and deserialization methods.
   rpc::Message toMessageImpl() && override;
   static std::unique_ptr<PropagateGradientsReq> fromMessage(
@@ -32,8 +44,7 @@ class TORCH_API PropagateGradientsReq : public rpc::RpcCommandBase {
   bool retainGraph();
 
  private:
-  AutogradMetadata autogradMetadata_;
-  std::vector<torch::autograd::Variable> grads_;
+  std::vector<Entry> entries_;
   bool retainGraph_;
 };
 
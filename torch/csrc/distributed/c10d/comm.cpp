@@ -12,15 +12,55 @@ namespace {
 
 class BroadcastWork {
  public:
+  // Flattens the tensors, without starting the broadcast yet, so that the
+  // flattening of a bucket overlaps with the broadcast of the previous ones.
   BroadcastWork(
       const std::shared_ptr<c10d::ProcessGroup>& process_group,
-      std::vector<at::Tensor> bucket_tensors)
-      : bucket_tensors_(std::move(bucket_tensors)),
-        flat_tensor_({torch::utils::flatten_dense_tensors(bucket_tensors_)}),
-        work_(process_group->broadcast(flat_tensor_)) {}
+      std::vector<at::Tensor> bucket_tensors,
+      BroadcastAlgorithm algorithm)
+      : process_group_(process_group),
+        algorithm_(algorithm),
+        bucket_tensors_(std::move(bucket_tensors)),
+        flat_tensor_({torch::utils::flatten_dense_tensors(bucket_tensors_)}) {
+    if (algorithm_ == BroadcastAlgorithm::SCATTER_ALLGATHER) {
+      // Pad the flattened tensor so that it splits into a chunk per process.
+      const auto world_size = process_group_->getSize();
+      const auto numel = flat_tensor_.front().numel();
+      const auto chunk_size = (numel + world_size - 1) / world_size;
+      padded_tensor_ = at::empty(
+          {chunk_size * world_size}, flat_tensor_.front().options());
+      if (process_group_->getRank() == 0) {
+        padded_tensor_.narrow(0, 0, numel).copy_(flat_tensor_.front());
+      }
+      chunks_ = padded_tensor_.chunk(world_size);
+    }
+  }
+
+  void start() {
+    if (algorithm_ == BroadcastAlgorithm::BROADCAST) {
+      work_ = process_group_->broadcast(flat_tensor_);
+      return;
+    }
+    // Every process receives its chunk from the root, then they allgather
+    // the chunks. Every link carries about twice the bucket, instead of the
+    // root sending the whole bucket to each of its children in the tree.
+    std::vector<at::Tensor> outputs{chunks_[process_group_->getRank()]};
+    std::vector<std::vector<at::Tensor>> inputs;
+    if (process_group_->getRank() == 0) {
+      inputs.push_back(chunks_);
+    }
+    work_ = process_group_->scatter(outputs, inputs);
+  }
 
   void finish() {
     work_->wait();
+    if (algorithm_ == BroadcastAlgorithm::SCATTER_ALLGATHER) {
+      std::vector<at::Tensor> inputs{chunks_[process_group_->getRank()]};
+      std::vector<std::vector<at::Tensor>> outputs{chunks_};
+      process_group_->allgather(outputs, inputs)->wait();
+      flat_tensor_.front() =
+          padded_tensor_.narrow(0, 0, flat_tensor_.front().numel());
+    }
 
     // Copy the output of the broadcast operation back.
     auto output_tensors = torch::utils::unflatten_dense_tensors(
@@ -32,6 +72,10 @@ class BroadcastWork {
   }
 
  protected:
+  std::shared_ptr<c10d::ProcessGroup> process_group_;
+
+  BroadcastAlgorithm algorithm_;
+
   // The list of tensors to broadcast. They are guaranteed to be
   // placed on the same device and have the same dtype.
   std::vector<at::Tensor> bucket_tensors_;
@@ -41,7 +85,12 @@ class BroadcastWork {
   // because c10d::ProcessGroup::broadcast takes a vector argument.
   std::vector<at::Tensor> flat_tensor_;
 
-  // The broadcast work that is kicked off upon construction.
+  // With SCATTER_ALLGATHER, the flattened tensor padded to a multiple of the
+  // number of processes, and its chunks.
+  at::Tensor padded_tensor_;
+  std::vector<at::Tensor> chunks_;
+
+  // The work of the broadcast, or of the scatter with SCATTER_ALLGATHER.
   std::shared_ptr<c10d::ProcessGroup::Work> work_;
 };
 
@@ -51,7 +100,8 @@ class BroadcastWork {
 void broadcast_coalesced(
     std::shared_ptr<c10d::ProcessGroup> process_group,
     at::TensorList tensors,
-    size_t buffer_size) {
+    size_t buffer_size,
+    BroadcastAlgorithm algorithm) {
   // Coalesce tensors into buckets taking into account the maximum buffer size.
   // This routine is multi-device aware, so the tensors can be split across
   // multiple devices and can contain a mix of CPU and CUDA tensors.
@@ -63,15 +113,18 @@ void broadcast_coalesced(
 
   // We maintain a maximum of 2 in flight broadcast operations to avoid
   // allocating too much memory (in case the specified tensors are very large).
+  // Every bucket is flattened while the previous ones are in flight, and
+  // only started once the oldest one is finished and unflattened.
   std::deque<BroadcastWork> in_flight;
   constexpr auto max_in_flight = 2;
   for (const auto& bucket : buckets) {
-    if (in_flight.size() >= max_in_flight) {
+    in_flight.emplace_back(
+        process_group, c10::fmap(bucket, lookup), algorithm);
+    if (in_flight.size() > max_in_flight) {
       in_flight.front().finish();
       in_flight.pop_front();
     }
-
-    in_flight.emplace_back(process_group, c10::fmap(bucket, lookup));
+    in_flight.back().start();
   }
 
   while (!in_flight.empty()) {
@@ -83,7 +136,7 @@ void broadcast_coalesced(
 GradBucket::GradBucket(std::vector<at::Tensor> tensors)
     : tensors_(std::move(tensors)){};
 
-const std::vector<at::Tensor>& GradBucket::getTensors() {
+const std::vector<at::Tensor>& GradBucket::getTensors() const {
   return tensors_;
 }
 
@@ -8,11 +8,22 @@
 
 namespace c10d {
 
+// How broadcast_coalesced sends a bucket from rank 0 to the other processes.
+enum class BroadcastAlgorithm : uint8_t {
+  // A broadcast of the process group.
+  BROADCAST,
+  // A scatter of the bucket followed by an allgather of its chunks, which
+  // sends less data in total for large buckets and many processes, on the
+  // backends that support scatter.
+  SCATTER_ALLGATHER,
+};
+
 // Broadcast many tensors to all processes in the process group.
 void broadcast_coalesced(
     std::shared_ptr<c10d::ProcessGroup> process_group,
     at::TensorList tensors,
-    size_t buffer_size);
+    size_t buffer_size,
+    BroadcastAlgorithm algorithm = BroadcastAlgorithm::BROADCAST);
 
 // This class passes bucket contents tensor (for multiple replicas) to
 // DDP communication hook.
@@ -25,7 +36,7 @@ class GradBucket {
   // each device. There will be multiple replicas only in the case of single
   // process multiple device mode. In the single process single device mode,
   // this list would consist of only a single tensor.
-  const std::vector<at::Tensor>& getTensors();
+  const std::vector<at::Tensor>& getTensors() const;
 
  private:
   std::vector<at::Tensor> tensors_;
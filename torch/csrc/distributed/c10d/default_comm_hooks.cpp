@@ -0,0 +1,303 @@
+#include <torch/csrc/distributed/c10d/default_comm_hooks.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+#include <ATen/ATen.h>
+#include <ATen/CPUGeneratorImpl.h>
+
+namespace c10d {
+namespace {
+
+// The PowerSGD approximations of every process must start from the same
+// matrix, drawn from a generator of this seed rather than the default one.
+constexpr uint64_t kPowerSGDSeed = 0;
+
+// The Future a builtin hook returns. Waiting on it waits for the works the
+// hook started, then runs the rest of the hook, which computes the new value
+// of the bucket, possibly after more communication. The reducer only waits on
+// the futures of the hooks at the end of backward, once all the buckets were
+// started, so the first communication of every bucket still overlaps with
+// backward, and the backend doesn't need to support Work::getFuture.
+class WorkFuture : public torch::jit::Future {
+ public:
+  WorkFuture(
+      std::vector<std::shared_ptr<ProcessGroup::Work>> works,
+      std::function<std::vector<at::Tensor>()> finish)
+      : torch::jit::Future(c10::ListType::create(c10::TensorType::get())),
+        works_(std::move(works)),
+        finish_(std::move(finish)) {}
+
+  void wait() override {
+    std::call_once(finished_, [this] {
+      try {
+        for (auto& work : works_) {
+          work->wait();
+        }
+        markCompleted(c10::IValue(finish_()));
+      } catch (const std::exception& e) {
+        setError(e.what());
+      }
+      works_.clear();
+      finish_ = nullptr;
+    });
+    torch::jit::Future::wait();
+  }
+
+  c10::IValue value() override {
+    wait();
+    return torch::jit::Future::value();
+  }
+
+ private:
+  std::once_flag finished_;
+  std::vector<std::shared_ptr<ProcessGroup::Work>> works_;
+  std::function<std::vector<at::Tensor>()> finish_;
+};
+
+class BuiltinCommHook : public CommHookInterface {
+ public:
+  explicit BuiltinCommHook(std::shared_ptr<ProcessGroup> process_group)
+      : process_group_(std::move(process_group)) {}
+
+  std::vector<at::Tensor> processFuture(c10::IValue future_value) override {
+    return future_value.toTensorVector();
+  }
+
+ protected:
+  // The flattened bucket, as the hooks only run with a single replica.
+  static const at::Tensor& bucketTensor(
+      const GradBucket& bucket,
+      const char* hook_name) {
+    const auto& tensors = bucket.getTensors();
+    TORCH_INTERNAL_ASSERT(tensors.size() == 1);
+    TORCH_CHECK(
+        !tensors[0].is_sparse(),
+        "The ",
+        hook_name,
+        " communication hook does not support sparse gradients.");
+    return tensors[0];
+  }
+
+  std::shared_ptr<ProcessGroup> process_group_;
+};
+
+class AllReduceCommHook : public BuiltinCommHook {
+ public:
+  using BuiltinCommHook::BuiltinCommHook;
+
+  c10::intrusive_ptr<torch::jit::Future> runHook(
+      const GradBucket& bucket) override {
+    auto tensors = bucket.getTensors();
+    auto work = process_group_->allreduce(tensors);
+    const auto world_size = process_group_->getSize();
+    return c10::make_intrusive<WorkFuture>(
+        std::vector<std::shared_ptr<ProcessGroup::Work>>{work},
+        [tensors, world_size]() mutable {
+          for (auto& tensor : tensors) {
+            tensor.div_(world_size);
+          }
+          return tensors;
+        });
+  }
+};
+
+class CastCompressCommHook : public BuiltinCommHook {
+ public:
+  CastCompressCommHook(
+      std::shared_ptr<ProcessGroup> process_group,
+      at::ScalarType dtype)
+      : BuiltinCommHook(std::move(process_group)), dtype_(dtype) {}
+
+  c10::intrusive_ptr<torch::jit::Future> runHook(
+      const GradBucket& bucket) override {
+    const auto& tensor = bucketTensor(bucket, "cast compression");
+    const auto world_size = process_group_->getSize();
+    // Dividing before the allreduce keeps the sum in the range of the
+    // compressed type.
+    std::vector<at::Tensor> compressed{tensor.to(dtype_).div_(world_size)};
+    auto work = process_group_->allreduce(compressed);
+    return c10::make_intrusive<WorkFuture>(
+        std::vector<std::shared_ptr<ProcessGroup::Work>>{work},
+        [tensor, compressed]() mutable {
+          tensor.copy_(compressed[0]);
+          return std::vector<at::Tensor>{tensor};
+        });
+  }
+
+ private:
+  at::ScalarType dtype_;
+};
+
+// The state of the hooks with error feedback, per bucket. The flattened
+// tensor of a bucket is the same from one iteration to the next, so it
+// identifies the bucket.
+template <typename State>
+class BucketStates {
+ public:
+  // The references stay valid as more states are added.
+  State& get(const at::Tensor& tensor) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return states_[tensor.data_ptr()];
+  }
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<const void*, State> states_;
+};
+
+class PowerSGDCommHook : public BuiltinCommHook {
+ public:
+  PowerSGDCommHook(std::shared_ptr<ProcessGroup> process_group, int64_t rank)
+      : BuiltinCommHook(std::move(process_group)), rank_(rank) {}
+
+  // The bucket of n entries is padded into a square matrix M of side
+  // ceil(sqrt(n)), plus the error of the previous approximation. Given the
+  // matrix Q of the previous iteration, every process computes P = M Q,
+  // which is allreduced and orthogonalized, then Q = M^T P, which is
+  // allreduced again and averaged. The approximation of the average of the
+  // M's is P Q^T, and every process keeps M - P Q^T as its error.
+  c10::intrusive_ptr<torch::jit::Future> runHook(
+      const GradBucket& bucket) override {
+    const auto& tensor = bucketTensor(bucket, "PowerSGD");
+    const auto numel = tensor.numel();
+    const auto side = static_cast<int64_t>(std::ceil(std::sqrt(numel)));
+    const auto rank = std::min(rank_, side);
+
+    auto& state = states_.get(tensor);
+    if (!state.error.defined() || state.error.size(0) != side ||
+        state.q.size(1) != rank) {
+      const auto options = tensor.options().dtype(at::kFloat);
+      state.error = at::zeros({side, side}, options);
+      auto generator = at::detail::createCPUGenerator(kPowerSGDSeed);
+      state.q = at::randn({side, rank}, generator, options.device(at::kCPU))
+                    .to(tensor.device());
+    }
+
+    auto matrix = state.error.clone();
+    matrix.view(-1).narrow(0, 0, numel).add_(tensor.view(-1));
+    std::vector<at::Tensor> p{at::mm(matrix, state.q)};
+    auto work = process_group_->allreduce(p);
+
+    auto process_group = process_group_;
+    State* state_ptr = &state;
+    return c10::make_intrusive<WorkFuture>(
+        std::vector<std::shared_ptr<ProcessGroup::Work>>{work},
+        [process_group, state_ptr, tensor, matrix, p]() mutable {
+          const auto world_size = process_group->getSize();
+          auto p_orth = std::get<0>(at::qr(p[0]));
+          std::vector<at::Tensor> q{at::mm(matrix.t(), p_orth)};
+          process_group->allreduce(q)->wait();
+          q[0].div_(world_size);
+          auto approximation = at::mm(p_orth, q[0].t());
+          state_ptr->error = matrix.sub_(approximation);
+          state_ptr->q = q[0];
+          tensor.view(-1).copy_(
+              approximation.view(-1).narrow(0, 0, tensor.numel()));
+          return std::vector<at::Tensor>{tensor};
+        });
+  }
+
+ private:
+  struct State {
+    at::Tensor error;
+    at::Tensor q;
+  };
+
+  int64_t rank_;
+  BucketStates<State> states_;
+};
+
+class TopKCommHook : public BuiltinCommHook {
+ public:
+  TopKCommHook(std::shared_ptr<ProcessGroup> process_group, double ratio)
+      : BuiltinCommHook(std::move(process_group)), ratio_(ratio) {}
+
+  // Every process sends the k entries of largest magnitude of its bucket
+  // plus its residual, along with their indices, and keeps the others as its
+  // new residual. The k is the same on every process as the buckets are.
+  c10::intrusive_ptr<torch::jit::Future> runHook(
+      const GradBucket& bucket) override {
+    const auto& tensor = bucketTensor(bucket, "top-k");
+    const auto numel = tensor.numel();
+    const auto k = std::max<int64_t>(
+        1, std::min<int64_t>(numel, static_cast<int64_t>(numel * ratio_)));
+
+    auto& residual = states_.get(tensor);
+    auto compensated = tensor.view(-1).clone();
+    if (residual.defined() && residual.numel() == numel) {
+      compensated.add_(residual);
+    }
+    auto indices = std::get<1>(at::topk(
+        compensated.abs(), k, /*dim=*/0, /*largest=*/true, /*sorted=*/false));
+    std::vector<at::Tensor> values{compensated.index_select(0, indices)};
+    std::vector<at::Tensor> local_indices{indices};
+    residual = compensated.index_fill_(0, indices, 0);
+
+    const auto world_size = process_group_->getSize();
+    std::vector<std::vector<at::Tensor>> gathered_values(1);
+    std::vector<std::vector<at::Tensor>> gathered_indices(1);
+    for (int i = 0; i < world_size; ++i) {
+      gathered_values[0].push_back(at::empty_like(values[0]));
+      gathered_indices[0].push_back(at::empty_like(indices));
+    }
+    auto values_work = process_group_->allgather(gathered_values, values);
+    auto indices_work =
+        process_group_->allgather(gathered_indices, local_indices);
+
+    return c10::make_intrusive<WorkFuture>(
+        std::vector<std::shared_ptr<ProcessGroup::Work>>{
+            values_work, indices_work},
+        [tensor, gathered_values, gathered_indices, world_size]() mutable {
+          auto flat = tensor.view(-1);
+          flat.zero_();
+          for (int i = 0; i < world_size; ++i) {
+            flat.index_add_(0, gathered_indices[0][i], gathered_values[0][i]);
+          }
+          flat.div_(world_size);
+          return std::vector<at::Tensor>{tensor};
+        });
+  }
+
+ private:
+  double ratio_;
+  BucketStates<at::Tensor> states_;
+};
+
+} // namespace
+
+std::unique_ptr<CommHookInterface> makeBuiltinCommHook(
+    BuiltinCommHookType type,
+    std::shared_ptr<ProcessGroup> process_group,
+    const BuiltinCommHookOptions& options) {
+  switch (type) {
+    case BuiltinCommHookType::ALLREDUCE:
+      return std::make_unique<AllReduceCommHook>(std::move(process_group));
+    case BuiltinCommHookType::FP16_COMPRESS:
+      return std::make_unique<CastCompressCommHook>(
+          std::move(process_group), at::kHalf);
+    case BuiltinCommHookType::BF16_COMPRESS:
+      return std::make_unique<CastCompressCommHook>(
+          std::move(process_group), at::kBFloat16);
+    case BuiltinCommHookType::POWER_SGD:
+      TORCH_CHECK(
+          options.powersgd_rank >= 1,
+          "PowerSGD rank must be at least 1, got ",
+          options.powersgd_rank);
+      return std::make_unique<PowerSGDCommHook>(
+          std::move(process_group), options.powersgd_rank);
+    case BuiltinCommHookType::TOP_K:
+      TORCH_CHECK(
+          options.topk_ratio > 0 && options.topk_ratio <= 1,
+          "Top-k ratio must be in (0, 1], got ",
+          options.topk_ratio);
+      return std::make_unique<TopKCommHook>(
+          std::move(process_group), options.topk_ratio);
+  }
+  TORCH_CHECK(false, "Unknown builtin communication hook type");
+}
+
+} // namespace c10d
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <memory>
+
+#include <c10d/ProcessGroup.hpp>
+#include <torch/csrc/distributed/c10d/comm.h>
+
+namespace c10d {
+
+// The communication hooks that come with DDP. They are implemented in C++,
+// so running them doesn't involve Python nor the GIL. Like DDP without a
+// hook, they all average the gradients across the processes of the group.
+enum class BuiltinCommHookType {
+  // Allreduces the bucket, as DDP does without a hook.
+  ALLREDUCE = 1,
+  // Allreduces the bucket cast to fp16 or bf16, which halves the bytes sent.
+  FP16_COMPRESS = 2,
+  BF16_COMPRESS = 3,
+  // Allreduces a low-rank approximation of the bucket, viewed as a square
+  // matrix, computed by one step of power iteration (PowerSGD, Vogels et al.
+  // 2019). What the approximation misses is added to the next gradients.
+  POWER_SGD = 4,
+  // Allgathers the largest entries of the bucket. What isn't sent is added to
+  // the next gradients.
+  TOP_K = 5,
+};
+
+struct BuiltinCommHookOptions {
+  // The rank of the approximation of POWER_SGD.
+  int64_t powersgd_rank = 1;
+  // The fraction of the entries of each bucket that TOP_K sends.
+  double topk_ratio = 0.01;
+};
+
+// Makes the builtin hook of the given type, communicating over
+// `process_group`.
+TORCH_API std::unique_ptr<CommHookInterface> makeBuiltinCommHook(
+    BuiltinCommHookType type,
+    std::shared_ptr<ProcessGroup> process_group,
+    const BuiltinCommHookOptions& options = {});
+
+} // namespace c10d
@@ -36,6 +36,8 @@ namespace {
 
 #ifdef USE_C10D_GLOO
 constexpr char* GLOO_SOCKET_IFNAME_ENV = "GLOO_SOCKET_IFNAME";
+constexpr char* GLOO_HIERARCHICAL_ENV = "GLOO_HIERARCHICAL";
+constexpr char* GLOO_GPUDIRECT_IBV_DEVICE_ENV = "GLOO_GPUDIRECT_IBV_DEVICE";
 #endif
 
 std::vector<std::string> split(char separator, const std::string& string) {
@@ -137,6 +139,34 @@ PyObject* c10d_init(PyObject* _unused) {
       py::arg("state"),
       py::arg("comm_hook"));
 
+  py::enum_<::c10d::BuiltinCommHookType>(module, "BuiltinCommHookType", R"(
+An enum-like class for the communication hooks DDP implements in C++:
+``ALLREDUCE``, ``FP16_COMPRESS``, ``BF16_COMPRESS``, ``POWER_SGD``, and
+``TOP_K``. They are registered with
+``DistributedDataParallel._register_builtin_comm_hook``.)")
+      .value("ALLREDUCE", ::c10d::BuiltinCommHookType::ALLREDUCE)
+      .value("FP16_COMPRESS", ::c10d::BuiltinCommHookType::FP16_COMPRESS)
+      .value("BF16_COMPRESS", ::c10d::BuiltinCommHookType::BF16_COMPRESS)
+      .value("POWER_SGD", ::c10d::BuiltinCommHookType::POWER_SGD)
+      .value("TOP_K", ::c10d::BuiltinCommHookType::TOP_K);
+
+  module.def(
+      "_register_builtin_comm_hook",
+      [](::c10d::Reducer& reducer,
+         ::c10d::BuiltinCommHookType comm_hook_type,
+         int64_t powersgd_rank,
+         double topk_ratio) {
+        ::c10d::BuiltinCommHookOptions options;
+        options.powersgd_rank = powersgd_rank;
+        options.topk_ratio = topk_ratio;
+        reducer.register_builtin_comm_hook(comm_hook_type, options);
+      },
+      py::arg("reducer"),
+      py::arg("comm_hook_type"),
+      py::arg("powersgd_rank") = 1,
+      py::arg("topk_ratio") = 0.01,
+      py::call_guard<py::gil_scoped_release>());
+
   shared_ptr_class_<::c10d::GradBucket>(module, "_GradBucket")
       .def(py::init<std::vector<Tensor>&>(), py::arg("tensors"))
       .def(
@@ -159,13 +189,17 @@ PyObject* c10d_init(PyObject* _unused) {
               std::shared_ptr<::c10d::ProcessGroup>,
               std::vector<std::vector<bool>>,
               int64_t,
-              bool>(),
+              bool,
+              bool,
+              int64_t>(),
           py::arg("replicas"),
           py::arg("bucket_indices"),
           py::arg("process_group"),
           py::arg("expect_sparse_gradients") = std::vector<std::vector<bool>>(),
           py::arg("bucket_bytes_cap") = ::c10d::kDefaultBucketBytesCap,
           py::arg("find_unused_parameters") = false,
+          py::arg("gradient_as_bucket_view") = false,
+          py::arg("bucket_tuning_iterations") = 0,
           py::call_guard<py::gil_scoped_release>())
       .def(
           "initialize_buckets",
@@ -180,7 +214,11 @@ PyObject* c10d_init(PyObject* _unused) {
           [](::c10d::Reducer& reducer, const torch::autograd::Variable& output)
               -> void { reducer.prepare_for_backward({output}); },
           py::call_guard<py::gil_scoped_release>())
-      .def("get_backward_stats", &::c10d::Reducer::get_backward_stats);
+      .def("get_backward_stats", &::c10d::Reducer::get_backward_stats)
+      .def(
+          "get_bucket_layout",
+          &::c10d::Reducer::get_bucket_layout,
+          py::call_guard<py::gil_scoped_release>());
 
   py::enum_<::c10d::ReduceOp>(module, "ReduceOp", R"(
 An enum-like class for available reduction operations: ``SUM``, ``PRODUCT``,
@@ -297,7 +335,55 @@ They are used in specifying strategies for reduction collectives, e.g.,
                  const std::chrono::milliseconds& timeout) {
                 store.wait(keys, timeout);
               },
-              py::call_guard<py::gil_scoped_release>());
+              py::call_guard<py::gil_scoped_release>())
+          .def(
+              "multi_get",
+              [](::c10d::Store& store,
+                 const std::vector<std::string>& keys) -> py::list {
+                std::vector<std::vector<uint8_t>> values;
+                {
+                  py::gil_scoped_release release;
+                  values = store.multiGet(keys);
+                }
+                py::list result;
+                for (auto& value : values) {
+                  result.append(py::bytes(
+                      reinterpret_cast<char*>(value.data()), value.size()));
+                }
+                return result;
+              })
+          .def(
+              "multi_set",
+              [](::c10d::Store& store,
+                 const std::vector<std::string>& keys,
+                 const std::vector<std::string>& values) {
+                std::vector<std::vector<uint8_t>> values_;
+                values_.reserve(values.size());
+                for (const auto& value : values) {
+                  values_.emplace_back(value.begin(), value.end());
+                }
+                store.multiSet(keys, values_);
+              },
+              py::call_guard<py::gil_scoped_release>())
+          .def(
+              "compare_set",
+              [](::c10d::Store& store,
+                 const std::string& key,
+                 const std::string& expected_value,
+                 const std::string& desired_value) -> py::bytes {
+                std::vector<uint8_t> value;
+                {
+                  py::gil_scoped_release release;
+                  value = store.compareSet(
+                      key,
+                      std::vector<uint8_t>(
+                          expected_value.begin(), expected_value.end()),
+                      std::vector<uint8_t>(
+                          desired_value.begin(), desired_value.end()));
+                }
+                return py::bytes(
+                    reinterpret_cast<char*>(value.data()), value.size());
+              });
 
   shared_ptr_class_<::c10d::FileStore>(module, "FileStore", store)
       .def(py::init<const std::string&, int>());
@@ -318,7 +404,20 @@ They are used in specifying strategies for reduction collectives, e.g.,
           py::arg("world_size"),
           py::arg("is_master"),
           py::arg("timeout") =
-              std::chrono::milliseconds(::c10d::Store::kDefaultTimeout));
+              std::chrono::milliseconds(::c10d::Store::kDefaultTimeout))
+      .def(
+          "_server_stats",
+          [](const ::c10d::TCPStore& store) {
+            py::dict result;
+            for (const auto& entry : store.getServerStats()) {
+              py::dict stats;
+              stats["count"] = entry.second.count;
+              stats["total_us"] = entry.second.total.count() / 1000.0;
+              stats["max_us"] = entry.second.max.count() / 1000.0;
+              result[py::str(entry.first)] = stats;
+            }
+            return result;
+          });
 
   shared_ptr_class_<::c10d::PrefixStore>(module, "PrefixStore", store)
       .def(py::init<const std::string&, std::shared_ptr<::c10d::Store>>());
@@ -611,7 +710,12 @@ They are used in specifying strategies for reduction collectives, e.g.,
       .def(py::init<>())
       .def_readwrite("devices", &::c10d::ProcessGroupGloo::Options::devices)
       .def_readwrite("timeout", &::c10d::ProcessGroupGloo::Options::timeout)
-      .def_readwrite("threads", &::c10d::ProcessGroupGloo::Options::threads);
+      .def_readwrite("threads", &::c10d::ProcessGroupGloo::Options::threads)
+      .def_readwrite(
+          "hierarchical", &::c10d::ProcessGroupGloo::Options::hierarchical)
+      .def_readwrite(
+          "gpu_direct_devices",
+          &::c10d::ProcessGroupGloo::Options::gpuDirectDevices);
 
   processGroupGloo.def_static(
       "create_device",
@@ -629,6 +733,11 @@ They are used in specifying strategies for reduction collectives, e.g.,
       py::arg("hostname") = "",
       py::arg("interface") = "");
 
+  processGroupGloo.def_static(
+      "create_ibverbs_device",
+      &::c10d::ProcessGroupGloo::createDeviceForIBVerbs,
+      py::arg("name") = "");
+
   processGroupGloo
       .def(py::init<
            const std::shared_ptr<::c10d::Store>&,
@@ -657,6 +766,22 @@ They are used in specifying strategies for reduction collectives, e.g.,
                   ::c10d::ProcessGroupGloo::createDefaultDevice());
             }
 
+            // Run the collectives in two levels if "GLOO_HIERARCHICAL" is 1.
+            char* hierarchicalEnv = getenv(GLOO_HIERARCHICAL_ENV);
+            options.hierarchical =
+                hierarchicalEnv && std::string(hierarchicalEnv) == "1";
+
+            // Run the allreduce of CUDA tensors over the GPUDirect capable
+            // InfiniBand devices listed in "GLOO_GPUDIRECT_IBV_DEVICE", if
+            // set.
+            char* ibvDeviceEnv = getenv(GLOO_GPUDIRECT_IBV_DEVICE_ENV);
+            if (ibvDeviceEnv) {
+              for (const auto& name : split(',', ibvDeviceEnv)) {
+                options.gpuDirectDevices.push_back(
+                    ::c10d::ProcessGroupGloo::createDeviceForIBVerbs(name));
+              }
+            }
+
             options.timeout = timeout;
             options.threads = options.devices.size() * 2;
             return std::make_shared<::c10d::ProcessGroupGloo>(
@@ -669,8 +794,36 @@ They are used in specifying strategies for reduction collectives, e.g.,
 #endif
 
 #ifdef USE_C10D_NCCL
-  shared_ptr_class_<::c10d::ProcessGroupNCCL>(
-      module, "ProcessGroupNCCL", processGroup)
+  auto processGroupNCCL = shared_ptr_class_<::c10d::ProcessGroupNCCL>(
+      module, "ProcessGroupNCCL", processGroup);
+
+  py::class_<::c10d::ProcessGroupNCCL::Options>(processGroupNCCL, "Options", R"(
+The options of a ``ProcessGroupNCCL``:
+
+* ``timeout``: the timeout of the operations, when ``NCCL_BLOCKING_WAIT`` is
+  set.
+* ``is_high_priority_stream``: run the NCCL kernels on high priority CUDA
+  streams, so that they preempt the kernels of the other streams.
+* ``min_channels``, ``max_channels``: bounds on the number of channels, i.e.,
+  of CUDA blocks, of the NCCL kernels, -1 to leave it to NCCL. Requires
+  NCCL 2.17+.
+* ``eager_init_devices``: the CUDA devices whose communicator is created by
+  the constructor rather than by the first collective on them.)")
+      .def(py::init<>())
+      .def_readwrite(
+          "timeout", &::c10d::ProcessGroupNCCL::Options::opTimeout)
+      .def_readwrite(
+          "is_high_priority_stream",
+          &::c10d::ProcessGroupNCCL::Options::isHighPriorityStream)
+      .def_readwrite(
+          "min_channels", &::c10d::ProcessGroupNCCL::Options::minChannels)
+      .def_readwrite(
+          "max_channels", &::c10d::ProcessGroupNCCL::Options::maxChannels)
+      .def_readwrite(
+          "eager_init_devices",
+          &::c10d::ProcessGroupNCCL::Options::eagerInitDevices);
+
+  processGroupNCCL
       .def(
           py::init<
               const std::shared_ptr<::c10d::Store>&,
@@ -681,7 +834,31 @@ They are used in specifying strategies for reduction collectives, e.g.,
           py::arg("rank"),
           py::arg("size"),
           py::arg("timeout") = std::chrono::milliseconds(
-              ::c10d::ProcessGroupNCCL::kProcessGroupNCCLOpTimeoutMillis));
+              ::c10d::ProcessGroupNCCL::kProcessGroupNCCLOpTimeoutMillis))
+      .def(
+          py::init<
+              const std::shared_ptr<::c10d::Store>&,
+              int,
+              int,
+              ::c10d::ProcessGroupNCCL::Options>(),
+          py::arg("store"),
+          py::arg("rank"),
+          py::arg("size"),
+          py::arg("options"),
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "_start_coalescing",
+          &::c10d::ProcessGroupNCCL::startCoalescing,
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "_end_coalescing",
+          &::c10d::ProcessGroupNCCL::endCoalescing,
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "_get_sequence_number",
+          &::c10d::ProcessGroupNCCL::getSequenceNumber,
+          R"(The sequence number of the last collective called on the group,
+which is the same on all its processes.)");
 #endif
 
 #ifdef USE_C10D_MPI
@@ -763,6 +940,15 @@ They are used in specifying strategies for reduction collectives, e.g.,
       py::arg("tensor_indices") = std::vector<int64_t>(),
       py::call_guard<py::gil_scoped_release>());
 
+  py::enum_<::c10d::BroadcastAlgorithm>(module, "BroadcastAlgorithm", R"(
+An enum-like class for the algorithms of ``_broadcast_coalesced``:
+``BROADCAST``, a broadcast of the process group, and ``SCATTER_ALLGATHER``,
+a scatter from rank 0 followed by an allgather, for the backends that support
+scatter.)")
+      .value("BROADCAST", ::c10d::BroadcastAlgorithm::BROADCAST)
+      .value(
+          "SCATTER_ALLGATHER", ::c10d::BroadcastAlgorithm::SCATTER_ALLGATHER);
+
   module.def(
       "_broadcast_coalesced",
       // Define a lambda such that the pybind11 prototype can take a std::vector
@@ -770,12 +956,15 @@ They are used in specifying strategies for reduction collectives, e.g.,
       // function as a c10::ArrayRef.
       [](std::shared_ptr<::c10d::ProcessGroup> process_group,
          std::vector<at::Tensor> tensors, // NOLINT
-         size_t buffer_size) {
-        broadcast_coalesced(std::move(process_group), tensors, buffer_size);
+         size_t buffer_size,
+         ::c10d::BroadcastAlgorithm algorithm) {
+        broadcast_coalesced(
+            std::move(process_group), tensors, buffer_size, algorithm);
       },
       py::arg("process_group"),
       py::arg("tensors"),
       py::arg("buffer_size"),
+      py::arg("algorithm") = ::c10d::BroadcastAlgorithm::BROADCAST,
       py::call_guard<py::gil_scoped_release>());
 
   module.def(
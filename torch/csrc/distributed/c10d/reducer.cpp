@@ -1,10 +1,16 @@
 #include <torch/csrc/distributed/c10d/reducer.h>
 
+#include <algorithm>
 #include <functional>
+#include <limits>
+#include <numeric>
 
+#include <ATen/record_function.h>
 #include <c10/core/DeviceGuard.h>
 #include <c10/core/StreamGuard.h>
 #include <c10/util/Exception.h>
+#include <c10/util/Logging.h>
+#include <c10/util/StringUtil.h>
 #include <torch/csrc/autograd/engine.h>
 #include <torch/csrc/autograd/function_hook.h>
 #include <torch/csrc/autograd/functions/accumulate_grad.h>
@@ -30,7 +36,9 @@ Reducer::Reducer(
     std::shared_ptr<c10d::ProcessGroup> process_group,
     std::vector<std::vector<bool>> expect_sparse_gradients,
     int64_t bucket_bytes_cap,
-    bool find_unused_parameters)
+    bool find_unused_parameters,
+    bool gradient_as_bucket_view,
+    int64_t bucket_tuning_iterations)
     : replicas_(std::move(replicas)),
       process_group_(std::move(process_group)),
       expect_sparse_gradients_(std::move(expect_sparse_gradients)),
@@ -39,14 +47,24 @@ Reducer::Reducer(
       next_bucket_(0),
       has_marked_unused_parameters_(false),
       find_unused_parameters_(find_unused_parameters),
+      gradient_as_bucket_view_(gradient_as_bucket_view),
       local_used_maps_reduced_(false),
       backward_stats_base_(0),
       has_rebuilt_bucket_(false),
       bucket_bytes_cap_(bucket_bytes_cap),
+      bucket_tuning_iterations_(bucket_tuning_iterations),
+      bucket_tuning_iteration_(0),
+      allreduce_latency_ns_(-1),
+      allreduce_ns_per_byte_(0),
       comm_hook_(nullptr) {
   C10_LOG_API_USAGE_ONCE("torch.distributed.ddp.reducer");
   TORCH_CHECK(replicas_.size() >= 1, "Expected at least one model replica.");
   TORCH_CHECK(replicas_[0].size() >= 1, "Expected at least one parameter.");
+  TORCH_CHECK(
+      bucket_tuning_iterations_ >= 0,
+      "Expected a non-negative number of bucket tuning iterations, got ",
+      bucket_tuning_iterations_);
+  tuning_ready_times_.resize(replicas_[0].size(), 0);
 
   // If `expect_sparse_gradients` is not specified, initialize it such that
   // we do not expect sparse gradients for any parameter.
@@ -313,7 +331,7 @@ void Reducer::mark_variable_ready_dense(VariableIndex index) {
   auto& variable = replica.variables[bucket_index.intra_bucket_index];
   const auto offset = replica.offsets[bucket_index.intra_bucket_index];
   const auto length = replica.lengths[bucket_index.intra_bucket_index];
-  auto& bucket_view = replica.bucket_views[bucket_index.intra_bucket_index];
+  auto& bucket_view = replica.bucket_views_in[bucket_index.intra_bucket_index];
 
   // Copy contents of gradient tensor to bucket tensor.
   // If the gradient is not set, we assume it wasn't computed
@@ -328,13 +346,25 @@ void Reducer::mark_variable_ready_dense(VariableIndex index) {
           bucket_view.toString(),
           ", got ",
           grad.toString());
-      // Assert that the grad tensor and the bucket don't share storage.
-      // If they did, we could avoid the copy altogether.
-      // The reason for not doing this is that existing code calls
-      // `detach_` from `zero_grad`, which is incompatible with views.
-      TORCH_INTERNAL_ASSERT(!grad.is_alias_of(bucket_view));
       TORCH_INTERNAL_ASSERT(grad.device() == bucket_view.device());
       TORCH_INTERNAL_ASSERT(grad.numel() == bucket_view.numel());
+      // See Note [Gradient as bucket view]
+      if (gradient_as_bucket_view_ && grad.is_alias_of(bucket_view)) {
+        // AccumulateGrad accumulated into the bucket view, which only needs
+        // to be averaged in place.
+        // See Note [DDP Communication Hook]
+        if (comm_hook_ == nullptr) {
+          bucket_view.div_(process_group_->getSize());
+        }
+        // The grad is not modified and doesn't need to be written back.
+        return false;
+      }
+      // Unless gradient_as_bucket_view, the grad tensor and the bucket
+      // don't share storage. The reason for not doing this by default is
+      // that existing code may call `detach_` on grads, which is
+      // incompatible with views.
+      TORCH_INTERNAL_ASSERT(
+          gradient_as_bucket_view_ || !grad.is_alias_of(bucket_view));
       // AccumulateGrad doesn't HAVE to obey the grad layout contract.
       // The penalty for disobedience is reduced performance, not numerical
       // death. Warnings here help diagnose poor DDP performance.
@@ -366,6 +396,12 @@ void Reducer::mark_variable_ready_dense(VariableIndex index) {
       } else {
         bucket_view.copy_(grad);
       }
+      if (gradient_as_bucket_view_) {
+        // From now on, AccumulateGrad accumulates into the bucket view.
+        grad = bucket_view;
+        // The grad is modified and needs to be written back.
+        return true;
+      }
     } else {
       bucket_view.zero_();
     }
@@ -435,7 +471,7 @@ void Reducer::autograd_hook(VariableIndex index) {
   // and intialized. Also we only need to dump tensors and parameter indcies of
   // one replica.
   if (!has_rebuilt_bucket_ && !find_unused_parameters_ &&
-      index.replica_index == 0) {
+      bucket_tuning_iterations_ == 0 && index.replica_index == 0) {
     rebuilt_params_.push_back(
         replicas_[index.replica_index][index.variable_index]);
     rebuilt_param_indices_.push_back(index.variable_index);
@@ -556,15 +592,8 @@ void Reducer::mark_variable_ready(VariableIndex index) {
       // Run callback with the current stream
       c10::OptionalStreamGuard currentStreamGuard{currentStream};
       this->finalize_backward();
-      // Rebuild bucket if this is the first time to rebuild
-      if (!rebuilt_params_.empty()) {
-        auto rebuilt_bucket_indices = rebuildBuckets();
-        // Unlock before initialize_buckets() as initialize_buckets() requires a
-        // lock, it could result in self deadlock without unlocking here.
-        lock.unlock();
-        initialize_buckets(std::move(rebuilt_bucket_indices));
-      } else {
-        lock.unlock();
+      if (this->should_rebuild_buckets()) {
+        this->rebuildBuckets();
       }
     });
   }
@@ -579,6 +608,7 @@ void Reducer::mark_bucket_ready(size_t bucket_index) {
   if (bucket_index > next_bucket_) {
     return;
   }
+  RECORD_FUNCTION("DDP::mark_bucket_ready", std::vector<c10::IValue>());
 
   // Keep going, until we either:
   // - have kicked off reduction for all buckets, or
@@ -600,6 +630,11 @@ void Reducer::mark_bucket_ready(size_t bucket_index) {
       //
       tensors.push_back(replica.contents);
     }
+    // The collective of the bucket is recorded within this range, which
+    // identifies the bucket for the profiler.
+    RECORD_FUNCTION(
+        c10::str("DDP::allreduce_bucket_", next_bucket_),
+        std::vector<c10::IValue>(tensors.begin(), tensors.end()));
     // See Note [DDP Communication Hook]
     // TODO(@sinannasir): merge `work` and `future_work`. Related to GH Issue
     // #41266.
@@ -760,27 +795,80 @@ void Reducer::initialize_buckets(
   }
 }
 
+// Note [Gradient as bucket view]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// By default, the grad of every parameter is a tensor of its own, which
+// mark_variable_ready_dense copies into the parameter's view of its bucket
+// and finalize_bucket_dense copies the reduced bucket back into. With
+// gradient_as_bucket_view, the grads are the bucket views themselves: the
+// first time a grad is ready (or, for grads that already exist, when the
+// buckets are initialized) it is moved into its view, which replaces it, so
+// that from then on AccumulateGrad accumulates into the bucket and the
+// reduction writes its result straight into the grads. This saves the
+// memory of the grads and both copies of every iteration.
+//
+// The grads being views, they can't be detached in place (zero_grad only
+// detaches grads with a grad_fn), and a grad that is replaced by another
+// tensor is copied into its view and replaced by it again at the next
+// iteration.
+//
 // (see Note:  "Gradient Layout Contract" in initialize_buckets).
 void Reducer::initialize_bucketviews(
     Reducer::BucketReplica& replica,
     at::Tensor& contents) {
   for (size_t i = 0; i < replica.variables.size(); i++) {
-    const auto& v = replica.variables[i];
+    auto& v = replica.variables[i];
     const auto offset = replica.offsets[i];
     const auto length = replica.lengths[i];
     if (v.is_non_overlapping_and_dense()) {
       // If the param's memory is dense, match its layout, anticipating
       // the autograd engine (AccumulateGrad) will also create gradients
       // matching its layout.
-      replica.bucket_views.push_back(
+      replica.bucket_views_in.push_back(
           contents.as_strided(v.sizes(), v.strides(), offset));
     } else {
       // Fall back to a C-style contiguous view, again anticipating
       // AccumulateGrad will do the same when stashing grads for non-dense
       // params.
-      replica.bucket_views.push_back(
+      replica.bucket_views_in.push_back(
           contents.narrow(0, offset, length).view(v.sizes()));
     }
+
+    // See Note [Gradient as bucket view]
+    if (gradient_as_bucket_view_) {
+      auto& bucket_view = replica.bucket_views_in.back();
+      runGradCallbackForVariable(v, [&](auto& grad) {
+        if (grad.defined() && !grad.is_alias_of(bucket_view)) {
+          bucket_view.copy_(grad);
+          grad = bucket_view;
+          // The grad is modified and needs to be written back.
+          return true;
+        }
+        // The grad is not modified and does not need to be written back.
+        return false;
+      });
+    }
+  }
+  // By default `bucket_views_out` and `bucket_views_in` are
+  // essentially the same thing.
+  replica.bucket_views_out = replica.bucket_views_in;
+}
+
+void Reducer::populate_bucket_views_out(
+    Reducer::BucketReplica& replica,
+    at::Tensor& tensor) {
+  replica.bucket_views_out.clear();
+  for (size_t i = 0; i < replica.variables.size(); i++) {
+    const auto& v = replica.variables[i];
+    const auto offset = replica.offsets[i];
+    const auto length = replica.lengths[i];
+    if (v.is_non_overlapping_and_dense()) {
+      replica.bucket_views_out.push_back(
+          tensor.as_strided(v.sizes(), v.strides(), offset));
+    } else {
+      replica.bucket_views_out.push_back(
+          tensor.narrow(0, offset, length).view(v.sizes()));
+    }
   }
 }
 
@@ -792,6 +880,12 @@ void Reducer::initialize_bucketviews(
 // want to start performing reductions on `torch.autograd.backward()`.
 void Reducer::prepare_for_backward(
     const std::vector<torch::autograd::Variable>& outputs) {
+  // Initialize the buckets rebuilt at the end of the previous backward pass.
+  // Their broadcast overlapped with the forward pass.
+  if (rebuilt_bucket_indices_work_) {
+    initialize_buckets(finish_sync_bucket_indices());
+  }
+
   std::lock_guard<std::mutex> lock(mutex_);
   std::unordered_set<torch::autograd::Node*> seen;
   std::vector<torch::autograd::Node*> queue;
@@ -927,7 +1021,30 @@ void Reducer::finalize_bucket_dense(Bucket& bucket) {
         }
       }
 
-      const auto& bucket_view = replica.bucket_views[intra_bucket_index];
+      const auto& bucket_view_out = replica.bucket_views_out[intra_bucket_index];
+      if (gradient_as_bucket_view_) {
+        // See Note [Gradient as bucket view]
+        auto& bucket_view_in = replica.bucket_views_in[intra_bucket_index];
+        // A communication hook returns its result in a new tensor, which
+        // has to be copied into the bucket, i.e., into the grad.
+        if (!bucket_view_in.is_alias_of(bucket_view_out)) {
+          bucket_view_in.copy_(bucket_view_out);
+        }
+        runGradCallbackForVariable(variable, [&](auto& grad) {
+          // If a parameter is globally unused, we keep its grad untouched.
+          if (!global_unused &&
+              (!grad.defined() || !grad.is_alias_of(bucket_view_in))) {
+            // The grad of a parameter unused locally, but used globally, was
+            // not defined when its bucket view was zeroed.
+            grad = bucket_view_in;
+            // The grad is modified and needs to be written back.
+            return true;
+          }
+          // The grad is not modified.
+          return false;
+        });
+        continue;
+      }
       runGradCallbackForVariable(variable, [&](auto& grad) {
         // If a parameter is globally unused, we keep its grad untouched.
         if (!global_unused) {
@@ -935,9 +1052,9 @@ void Reducer::finalize_bucket_dense(Bucket& bucket) {
             // Creates grad according to the "Gradient Layout Contract"
             // (see torch/csrc/grad/AccumulateGrad.h)
             grad = torch::autograd::utils::clone_obey_contract(
-                bucket_view, variable);
+                bucket_view_out, variable);
           } else {
-            grad.copy_(bucket_view);
+            grad.copy_(bucket_view_out);
           }
           // The grad is modified and needs to be written back.
           return true;
@@ -950,6 +1067,8 @@ void Reducer::finalize_bucket_dense(Bucket& bucket) {
 }
 
 void Reducer::finalize_backward() {
+  RECORD_FUNCTION("DDP::finalize_backward", std::vector<c10::IValue>());
+
   // No longer expect autograd hooks to fire after this function returns.
   TORCH_INTERNAL_ASSERT(expect_autograd_hooks_);
   expect_autograd_hooks_ = false;
@@ -984,10 +1103,9 @@ void Reducer::finalize_backward() {
         if (bucket.expect_sparse_gradient) {
           bucket.replicas[i].contents.copy_(future_result[i]);
         } else {
-          // Reinitialize bucket_views with the future_result by following
-          // the same logic in `inititalize_buckets`.
-          bucket.replicas[i].bucket_views.clear();
-          initialize_bucketviews(bucket.replicas[i], future_result[i]);
+          // Reinitialize only `bucket_views_out` with the future_result by
+          // following the same logic in `initialize_buckets`.
+          populate_bucket_views_out(bucket.replicas[i], future_result[i]);
         }
       }
     }
@@ -1043,105 +1161,258 @@ void Reducer::RpcContext::set(ContextPtr&& new_context_ptr) {
 }
 
 void Reducer::sync_bucket_indices(
-    std::vector<std::vector<size_t>>& bucket_indices) {
-  auto num_buckets = bucket_indices.size();
-  std::vector<size_t> bucket_sizes;
-  bucket_sizes.reserve(num_buckets);
-  int64_t total_size = 0;
-  for (size_t i = 0; i < num_buckets; i++) {
-    auto bucket_size = bucket_indices.at(i).size();
-    bucket_sizes.push_back(bucket_size);
-    total_size += bucket_size;
-  }
-
-  at::TensorOptions options;
-  options = options.dtype(at::kInt);
-  options = options.device(replicas_[0][0].device());
-
-  // Group indices and num_bucket together into indices_tensor
-  // Broadcast this tensor first, as its size is equal among all processes
-  auto indices_tensor = at::empty({total_size + 1}, at::kInt);
+    const std::vector<std::vector<size_t>>& bucket_indices) {
+  // There are at most as many buckets as variables, so the number of buckets,
+  // their sizes padded to the number of variables and the indices of the
+  // variables fit a tensor of the same size on all processes, which a single
+  // broadcast sends.
+  const auto num_variables = replicas_[0].size();
+  auto indices_tensor = at::zeros({int64_t(2 * num_variables + 1)}, at::kInt);
   auto indices_accessor = indices_tensor.accessor<int, 1>();
-  auto indices_accessor_Index = 0;
-  for (size_t i = 0; i < num_buckets; i++) {
-    const auto& bucket_size = bucket_indices.at(i).size();
-    for (size_t j = 0; j < bucket_size; j++) {
-      indices_accessor[indices_accessor_Index++] = bucket_indices[i][j];
+  indices_accessor[0] = bucket_indices.size();
+  size_t offset = 1 + num_variables;
+  for (size_t i = 0; i < bucket_indices.size(); i++) {
+    indices_accessor[1 + i] = bucket_indices[i].size();
+    for (const auto variable_index : bucket_indices[i]) {
+      indices_accessor[offset++] = variable_index;
     }
   }
-  indices_accessor[indices_accessor_Index] = num_buckets;
+  TORCH_INTERNAL_ASSERT(
+      static_cast<int64_t>(offset) == indices_tensor.numel());
 
   // Copy CPU tensor to device tensor, as the process_group_ could be NCCL and
   // it can only broadcast device tensors.
-  auto indices_tensor_device = at::empty({total_size + 1}, options);
+  auto indices_tensor_device = at::empty(
+      indices_tensor.sizes(),
+      indices_tensor.options().device(replicas_[0][0].device()));
   indices_tensor_device.copy_(indices_tensor, /*non_blocking=*/true);
   std::vector<at::Tensor> indices_tensor_list = {indices_tensor_device};
-  process_group_->broadcast(indices_tensor_list)->wait();
-  indices_tensor.copy_(indices_tensor_list.front(), /*non_blocking=*/false);
+  rebuilt_bucket_indices_work_ = process_group_->broadcast(indices_tensor_list);
+  rebuilt_bucket_indices_tensor_ = indices_tensor_device;
+}
 
-  // Update num_buckets after receiving it from rank 0
-  num_buckets = indices_accessor[indices_accessor_Index];
+std::vector<std::vector<size_t>> Reducer::finish_sync_bucket_indices() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  rebuilt_bucket_indices_work_->wait();
+  auto indices_tensor = rebuilt_bucket_indices_tensor_.to(at::kCPU);
+  rebuilt_bucket_indices_work_ = nullptr;
+  rebuilt_bucket_indices_tensor_ = at::Tensor();
 
-  // Broadcast bucket_sizes
-  auto bucket_sizes_tensor = at::empty({(int64_t)num_buckets}, at::kInt);
-  auto bucket_sizes_accessor = bucket_sizes_tensor.accessor<int, 1>();
-  for (size_t i = 0; i < num_buckets; i++) {
-    // For rank != 0, it is possible that local num buckets bucket_sizes.size()
-    // is smaller than broadcasted num_buckets
-    bucket_sizes_accessor[i] =
-        bucket_sizes.at(std::min(i, (bucket_sizes.size() - 1)));
-  }
-  auto bucket_sizes_tensor_device = at::empty({(int64_t)num_buckets}, options);
-  bucket_sizes_tensor_device.copy_(bucket_sizes_tensor, /*non_blocking=*/true);
-  std::vector<at::Tensor> bucket_sizes_tensor_list = {
-      bucket_sizes_tensor_device};
-  process_group_->broadcast(bucket_sizes_tensor_list)->wait();
-  bucket_sizes_tensor.copy_(
-      bucket_sizes_tensor_list.front(), /*non_blocking=*/false);
-
-  // Clear bucket_indices first, and then update bucket_indices using received
-  // num_buckets, bucket_sizes_tensor and indices_tensor from rank 0
-  bucket_indices.clear();
+  // Decode the buckets of rank 0, see sync_bucket_indices.
+  const auto num_variables = replicas_[0].size();
+  auto indices_accessor = indices_tensor.accessor<int, 1>();
+  const size_t num_buckets = indices_accessor[0];
+  std::vector<std::vector<size_t>> bucket_indices;
   bucket_indices.reserve(num_buckets);
-  indices_accessor_Index = 0;
+  size_t offset = 1 + num_variables;
   for (size_t i = 0; i < num_buckets; i++) {
-    const auto& bucket_size = bucket_sizes_accessor[i];
+    const size_t bucket_size = indices_accessor[1 + i];
     std::vector<size_t> bucket;
     bucket.reserve(bucket_size);
     for (size_t j = 0; j < bucket_size; j++) {
-      bucket.push_back(indices_accessor[indices_accessor_Index++]);
+      bucket.push_back(indices_accessor[offset++]);
     }
     bucket_indices.emplace_back(std::move(bucket));
   }
+
+  if (process_group_->getRank() == 0) {
+    std::vector<int64_t> bucket_bytes;
+    for (const auto& bucket : bucket_indices) {
+      int64_t bytes = 0;
+      for (const auto variable_index : bucket) {
+        const auto& variable = replicas_[0][variable_index];
+        bytes += variable.numel() * variable.element_size();
+      }
+      bucket_bytes.push_back(bytes);
+    }
+    LOG(INFO) << "Reducer rebuilt " << num_buckets
+              << " buckets, of sizes in bytes, in reduction order: "
+              << c10::Join(", ", bucket_bytes);
+  }
+  return bucket_indices;
 }
 
-std::vector<std::vector<size_t>> Reducer::rebuildBuckets() {
-  TORCH_INTERNAL_ASSERT(
-      rebuilt_params_.size() == rebuilt_param_indices_.size(),
-      "rebuilt parameter tensors size is not same as rebuilt parameter indices size.");
-  TORCH_INTERNAL_ASSERT(
-      replicas_[0].size() == rebuilt_param_indices_.size(),
-      "rebuilt parameter indices size is not same as original model parameters size.");
+std::vector<std::vector<size_t>> Reducer::get_bucket_layout() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::vector<size_t>> bucket_indices;
+  bucket_indices.reserve(buckets_.size());
+  for (const auto& bucket : buckets_) {
+    bucket_indices.push_back(bucket.variable_indices);
+  }
+  return bucket_indices;
+}
+
+bool Reducer::should_rebuild_buckets() {
+  if (bucket_tuning_iterations_ > 0) {
+    return record_bucket_tuning_iteration();
+  }
+  // Rebuild bucket if this is the first time to rebuild
+  return !rebuilt_params_.empty();
+}
+
+bool Reducer::record_bucket_tuning_iteration() {
+  const auto num_variables = replicas_[0].size();
+  if (find_unused_parameters_) {
+    // finalize_backward waited for the reduction of the maps.
+    auto used_map = local_used_maps_dev_[0].to(at::kCPU);
+    auto used_accessor = used_map.accessor<int, 1>();
+    std::vector<bool> used_parameters(num_variables);
+    for (size_t i = 0; i < num_variables; i++) {
+      used_parameters[i] = used_accessor[i] > 0;
+    }
+    if (used_parameters != tuning_used_parameters_) {
+      tuning_used_parameters_ = std::move(used_parameters);
+      bucket_tuning_iteration_ = 0;
+      std::fill(tuning_ready_times_.begin(), tuning_ready_times_.end(), 0);
+    }
+  }
+
+  if (bucket_tuning_iteration_ >= bucket_tuning_iterations_) {
+    return false;
+  }
+  for (size_t i = 0; i < num_variables; i++) {
+    tuning_ready_times_[i] += backward_stats_[0][i];
+  }
+  return ++bucket_tuning_iteration_ == bucket_tuning_iterations_;
+}
+
+void Reducer::measure_allreduce_cost() {
+  const auto& variable = replicas_[0][0];
+  const auto options = variable.options();
+  const int64_t large_numel =
+      std::max<int64_t>(bucket_bytes_cap_ / variable.element_size(), 1);
+
+  // The best of a few allreduces, the first one possibly paying for lazy
+  // initialization in the process group.
+  const auto time_allreduce = [&](int64_t numel) {
+    std::vector<at::Tensor> tensors = {at::zeros({numel}, options)};
+    int64_t best = std::numeric_limits<int64_t>::max();
+    for (int i = 0; i < 3; i++) {
+      // Copying an element to the CPU waits for the device, first for the
+      // prior work, then for the allreduce.
+      tensors[0].narrow(0, 0, 1).to(at::kCPU);
+      const auto start = current_time_in_nanos();
+      process_group_->allreduce(tensors)->wait();
+      tensors[0].narrow(0, 0, 1).to(at::kCPU);
+      best = std::min(best, current_time_in_nanos() - start);
+    }
+    return best;
+  };
+  const auto small_ns = time_allreduce(1);
+  const auto large_ns = time_allreduce(large_numel);
+  allreduce_latency_ns_ = small_ns;
+  allreduce_ns_per_byte_ = std::max<double>(large_ns - small_ns, 0) /
+      (large_numel * variable.element_size());
+}
+
+std::vector<std::vector<size_t>> Reducer::compute_tuned_bucket_assignment() {
+  const auto& variables = replicas_[0];
+  const auto num_variables = variables.size();
+
+  // The variables in the order their gradients are ready on average.
+  std::vector<int64_t> order(num_variables);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int64_t a, int64_t b) {
+    return tuning_ready_times_[a] < tuning_ready_times_[b];
+  });
+
+  // The simulation assumes a single sequence of buckets, so models with
+  // several dtypes or devices, or sparse gradients, are only bucketed in the
+  // profiled order.
+  bool uniform = true;
+  for (const auto& variable : variables) {
+    uniform = uniform && variable.dtype() == variables[0].dtype() &&
+        variable.device() == variables[0].device();
+  }
+  for (const auto expect_sparse : expect_sparse_gradients_[0]) {
+    uniform = uniform && !expect_sparse;
+  }
+  if (!uniform) {
+    std::vector<at::Tensor> tensors;
+    tensors.reserve(num_variables);
+    for (const auto variable_index : order) {
+      tensors.push_back(variables[variable_index]);
+    }
+    return compute_bucket_assignment_by_size(
+        tensors,
+        {static_cast<size_t>(kDefaultFirstBucketBytes),
+         static_cast<size_t>(bucket_bytes_cap_)},
+        expect_sparse_gradients_[0],
+        order);
+  }
+
+  if (allreduce_latency_ns_ < 0) {
+    measure_allreduce_cost();
+  }
+
+  // finish[j] is the earliest time at which the buckets of the first j
+  // variables in ready order can be reduced, the last of them starting at
+  // variable start[j].
+  std::vector<int64_t> prefix_bytes(num_variables + 1, 0);
+  for (size_t i = 0; i < num_variables; i++) {
+    const auto& variable = variables[order[i]];
+    prefix_bytes[i + 1] =
+        prefix_bytes[i] + variable.numel() * variable.element_size();
+  }
+  std::vector<double> finish(num_variables + 1, 0);
+  std::vector<size_t> start(num_variables + 1, 0);
+  for (size_t j = 1; j <= num_variables; j++) {
+    const double ready =
+        tuning_ready_times_[order[j - 1]] / bucket_tuning_iterations_;
+    finish[j] = std::numeric_limits<double>::infinity();
+    for (size_t i = j; i-- > 0;) {
+      const auto bytes = prefix_bytes[j] - prefix_bytes[i];
+      // A single variable larger than the cap still gets its own bucket.
+      if (bytes > bucket_bytes_cap_ && i + 1 < j) {
+        break;
+      }
+      const double end = std::max(finish[i], ready) + allreduce_latency_ns_ +
+          allreduce_ns_per_byte_ * bytes;
+      if (end < finish[j]) {
+        finish[j] = end;
+        start[j] = i;
+      }
+    }
+  }
+
+  std::vector<std::vector<size_t>> bucket_indices;
+  for (size_t j = num_variables; j > 0; j = start[j]) {
+    bucket_indices.emplace_back(
+        order.begin() + start[j], order.begin() + j);
+  }
+  std::reverse(bucket_indices.begin(), bucket_indices.end());
+  return bucket_indices;
+}
+
+void Reducer::rebuildBuckets() {
   std::vector<std::vector<size_t>> rebuilt_bucket_indices;
-  std::vector<size_t> bucket_size_limits;
-  bucket_size_limits.push_back(kDefaultFirstBucketBytes);
-  bucket_size_limits.push_back(bucket_bytes_cap_);
-  rebuilt_bucket_indices = compute_bucket_assignment_by_size(
-      rebuilt_params_,
-      bucket_size_limits,
-      expect_sparse_gradients_[0],
-      rebuilt_param_indices_);
+  if (bucket_tuning_iterations_ > 0) {
+    rebuilt_bucket_indices = compute_tuned_bucket_assignment();
+  } else {
+    TORCH_INTERNAL_ASSERT(
+        rebuilt_params_.size() == rebuilt_param_indices_.size(),
+        "rebuilt parameter tensors size is not same as rebuilt parameter indices size.");
+    TORCH_INTERNAL_ASSERT(
+        replicas_[0].size() == rebuilt_param_indices_.size(),
+        "rebuilt parameter indices size is not same as original model parameters size.");
+    std::vector<size_t> bucket_size_limits;
+    bucket_size_limits.push_back(kDefaultFirstBucketBytes);
+    bucket_size_limits.push_back(bucket_bytes_cap_);
+    rebuilt_bucket_indices = compute_bucket_assignment_by_size(
+        rebuilt_params_,
+        bucket_size_limits,
+        expect_sparse_gradients_[0],
+        rebuilt_param_indices_);
+  }
 
   // For rebuilt bucket indices, it needs to be synced across all ranks.
   // Broadcast the newly rebuilt bucket indices from rank 0 in default.
-  // After syncing up rebuilt bucket indices, initialize buckets for reducer.
+  // The next prepare_for_backward initializes the buckets once received.
   sync_bucket_indices(rebuilt_bucket_indices);
 
   has_rebuilt_bucket_ = true;
   rebuilt_params_.clear();
   rebuilt_param_indices_.clear();
-
-  return rebuilt_bucket_indices;
 }
 
 // See Note [DDP Communication Hook]
@@ -1157,6 +1428,13 @@ void Reducer::register_comm_hook(std::unique_ptr<CommHookInterface> iface) {
   comm_hook_ = std::move(iface);
 }
 
+void Reducer::register_builtin_comm_hook(
+    BuiltinCommHookType comm_hook_type,
+    const BuiltinCommHookOptions& options) {
+  register_comm_hook(
+      makeBuiltinCommHook(comm_hook_type, process_group_, options));
+}
+
 namespace {
 
 // Tensors may be coalesced into buckets. Buckets must contain tensors of
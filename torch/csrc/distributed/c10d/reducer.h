@@ -12,6 +12,7 @@
 #include <torch/csrc/autograd/variable.h>
 #include <torch/csrc/distributed/autograd/context/context.h>
 #include <torch/csrc/distributed/c10d/comm.h>
+#include <torch/csrc/distributed/c10d/default_comm_hooks.h>
 
 namespace c10d {
 
@@ -30,7 +31,9 @@ class Reducer {
       std::shared_ptr<c10d::ProcessGroup> process_group,
       std::vector<std::vector<bool>> expect_sparse_gradients,
       int64_t bucket_bytes_cap,
-      bool find_unused_parameters);
+      bool find_unused_parameters,
+      bool gradient_as_bucket_view,
+      int64_t bucket_tuning_iterations = 0);
 
   ~Reducer() noexcept(false);
 
@@ -54,11 +57,21 @@ class Reducer {
     return backward_stats_;
   }
 
+  // Returns the indices of the variables of every bucket, in the order the
+  // buckets are reduced.
+  std::vector<std::vector<size_t>> get_bucket_layout();
+
   // Registeres a hook to the reducer. The hook is `CommHookInterface`
   // type to allow both Python and CPP hooks. This function can only
   // be called once before calling backward.
   void register_comm_hook(std::unique_ptr<CommHookInterface> iface);
 
+  // Registers one of the builtin C++ hooks, which communicate over the
+  // process group of the reducer. Same restrictions as register_comm_hook.
+  void register_builtin_comm_hook(
+      BuiltinCommHookType comm_hook_type,
+      const BuiltinCommHookOptions& options = {});
+
  protected:
   // Forward declaration.
   struct Bucket;
@@ -86,6 +99,8 @@ class Reducer {
 
   bool has_marked_unused_parameters_;
   const bool find_unused_parameters_;
+  // See Note [Gradient as bucket view]
+  const bool gradient_as_bucket_view_;
   std::vector<VariableIndex> unused_parameters_;
   // Locally used parameter maps indicating if parameters are used locally
   // during the current iteration or no_sync session if no_sync is on. One
@@ -123,19 +138,34 @@ class Reducer {
 
   void finalize_backward();
 
-  // Broadcast rebuilt buckets from rank 0 to other ranks before initializing
-  // the buckets
-  void sync_bucket_indices(std::vector<std::vector<size_t>>& bucket_indices);
-  // Rebuild buckets based on rebuilt_params_ and rebuilt_param_indices_
-  // TODO this function makes broadcast communication call and
-  // could be overlapped with next forward() call, thus
-  // it could be async. Will make it async when rebuilding buckets for
-  // find_unused_parameters = true case, as we could rebuild buckets more than
-  // once for find_unused_parameters = true case, where subgraphs are trained
-  // and parameter indices order may change more frequently.
-  // For find_unused_parameters = false case, buckets are only rebuilt once,
-  // the performance cost is negligible.
-  std::vector<std::vector<size_t>> rebuildBuckets();
+  // Kicks off the broadcast of the rebuilt buckets of rank 0 to the other
+  // ranks. The broadcast overlaps with the forward pass of the next
+  // iteration, and the next call to `prepare_for_backward` waits for it,
+  // then initializes the buckets.
+  void sync_bucket_indices(
+      const std::vector<std::vector<size_t>>& bucket_indices);
+  // Waits for the broadcast kicked off by `sync_bucket_indices` and returns
+  // the buckets of rank 0.
+  std::vector<std::vector<size_t>> finish_sync_bucket_indices();
+  // Rebuild buckets based on rebuilt_params_ and rebuilt_param_indices_, or
+  // on the profile of the first iterations if bucket tuning is enabled, and
+  // kicks off their broadcast. See Note [Bucket tuning].
+  void rebuildBuckets();
+
+  // Whether the buckets are to be rebuilt at the end of this backward pass.
+  bool should_rebuild_buckets();
+
+  // Accounts the backward pass that just finished in the bucket tuning
+  // profile, and returns whether it was the last one to profile.
+  bool record_bucket_tuning_iteration();
+
+  // Times allreduces of the process group to fill allreduce_latency_ns_ and
+  // allreduce_ns_per_byte_. This is a collective call.
+  void measure_allreduce_cost();
+
+  // The buckets that minimize the estimated time at which the reduction of
+  // the last bucket finishes, given the profiled gradient ready times.
+  std::vector<std::vector<size_t>> compute_tuned_bucket_assignment();
 
   using GradCallback =
       torch::distributed::autograd::DistAutogradContext::GradCallback;
@@ -161,10 +191,15 @@ class Reducer {
     // Views into contents for each grad.  Each view will be created with
     // layout (sizes + strides) matching the grad's expected layout
     // ("Gradient Layout Contract" in torch/csrc/autograd/AccumulateGrad.h).
-    // grad.copy_(bucket_views[i]) and
-    // bucket_views[i].copy_(grad)
+    // bucket_views_in[i].copy_(grad) and
+    // grad.copy_(bucket_views_out[i])
     // provide convenient ways to move grad data in/out of contents.
-    std::vector<at::Tensor> bucket_views;
+    // bucket_views_in and bucket_views_out are the same views of contents,
+    // unless a communication hook returns its result in new tensors, which
+    // bucket_views_out then views.
+    // With gradient_as_bucket_view, the grads are bucket_views_in themselves.
+    std::vector<at::Tensor> bucket_views_in;
+    std::vector<at::Tensor> bucket_views_out;
 
     // Variables that contribute to this bucket replica. Use refcounted value
     // here so that we can easily unflatten the bucket contents into the
@@ -186,15 +221,18 @@ class Reducer {
     // std::vector<at::cuda::CUDAEvent> events;
   };
 
-  // This function is called inside `initialize_buckets` and
-  // `finalize_backward`. The function call in `initialize_bucket` creates views
+  // This function is called inside `initialize_buckets`. It creates views
   // into the contents tensor for each variable's grad. Views serve as entry
-  // points to copy_ each grad's data in/out of the flat contents tensor. The
-  // function call in `finalize_backward` happens only if DDP communication hook
-  // was registered to recrate views with the result of `future_work`. Before
-  // `finalize_backward` call, views must be cleared.
+  // points to copy_ each grad's data in/out of the flat contents tensor. With
+  // gradient_as_bucket_view, the grads that are already defined are moved into
+  // their views, which then replace them.
   void initialize_bucketviews(BucketReplica& replica, at::Tensor& contents);
 
+  // This function is called inside `finalize_backward`, only if a DDP
+  // communication hook was registered, to recreate bucket_views_out with the
+  // result of `future_work`.
+  void populate_bucket_views_out(BucketReplica& replica, at::Tensor& tensor);
+
   // A bucket holds N bucket replicas (1 per model replica).
   //
   // If every bucket in this struct is ready, the reduction can be kicked off.
@@ -248,6 +286,35 @@ class Reducer {
   std::vector<int64_t> rebuilt_param_indices_;
   const int64_t bucket_bytes_cap_;
 
+  // The broadcast of the rebuilt buckets, see sync_bucket_indices.
+  std::shared_ptr<c10d::ProcessGroup::Work> rebuilt_bucket_indices_work_;
+  at::Tensor rebuilt_bucket_indices_tensor_;
+
+  // Note [Bucket tuning]
+  // ~~~~~~~~~~~~~~~~~~~~
+  // If bucket_tuning_iterations_ is positive, the reducer profiles the time
+  // at which the gradients are ready during that many iterations instead of
+  // recording their order during the first one. It then assigns the buckets
+  // by simulating their reduction, which starts once their last gradient is
+  // ready and the previous bucket was reduced, and takes the latency plus
+  // the size over the bandwidth of an allreduce of the process group, both
+  // measured once. The buckets are still capped at bucket_bytes_cap_, and
+  // usually come out small first, then larger.
+  //
+  // With find_unused_parameters_, the set of parameters used by an iteration
+  // determines the order of the ready gradients, so the profile restarts
+  // whenever that set changes. The set is the globally reduced one, the same
+  // on all processes, so that they all rebuild their buckets together.
+  const int64_t bucket_tuning_iterations_;
+  int64_t bucket_tuning_iteration_;
+  // Sum of the ready times of the variables of replica 0 over the profiled
+  // iterations, in nanoseconds.
+  std::vector<double> tuning_ready_times_;
+  // The parameters used by the profiled iterations.
+  std::vector<bool> tuning_used_parameters_;
+  double allreduce_latency_ns_;
+  double allreduce_ns_per_byte_;
+
   struct RpcContext {
     using ContextPtr = torch::distributed::autograd::ContextPtr;
     // The shared_ptr is to hold the context instance.
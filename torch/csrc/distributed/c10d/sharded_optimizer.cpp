@@ -0,0 +1,152 @@
+#include <torch/csrc/distributed/c10d/sharded_optimizer.h>
+
+#include <algorithm>
+
+#include <ATen/ATen.h>
+#include <c10/util/Exception.h>
+
+namespace c10d {
+
+ShardedOptimizer::ShardedOptimizer(
+    std::vector<at::Tensor> parameters,
+    std::shared_ptr<ProcessGroup> process_group,
+    const OptimizerFactory& make_optimizer,
+    Options options)
+    : process_group_(std::move(process_group)), options_(options) {
+  TORCH_CHECK(!parameters.empty(), "Expected at least one parameter.");
+  const auto world_size = process_group_->getSize();
+  const auto rank = process_group_->getRank();
+
+  // Group the parameters by dtype and device, in their order.
+  for (auto& parameter : parameters) {
+    TORCH_CHECK(
+        !parameter.is_sparse(),
+        "ShardedOptimizer does not support sparse parameters.");
+    auto it = std::find_if(
+        partitions_.begin(), partitions_.end(), [&](const Partition& p) {
+          return p.parameters[0].scalar_type() == parameter.scalar_type() &&
+              p.parameters[0].device() == parameter.device();
+        });
+    if (it == partitions_.end()) {
+      partitions_.emplace_back();
+      it = partitions_.end() - 1;
+    }
+    it->parameters.push_back(parameter);
+  }
+
+  std::vector<at::Tensor> shards;
+  for (auto& partition : partitions_) {
+    int64_t numel = 0;
+    for (const auto& parameter : partition.parameters) {
+      partition.offsets.push_back(numel);
+      numel += parameter.numel();
+    }
+    const auto shard_numel = (numel + world_size - 1) / world_size;
+    const auto options = partition.parameters[0].options();
+    partition.flat_parameters = at::zeros({shard_numel * world_size}, options);
+    partition.flat_gradients = at::zeros({shard_numel * world_size}, options);
+    for (int i = 0; i < world_size; i++) {
+      partition.parameter_slices.push_back(
+          partition.flat_parameters.narrow(0, i * shard_numel, shard_numel));
+      partition.gradient_slices.push_back(
+          partition.flat_gradients.narrow(0, i * shard_numel, shard_numel));
+    }
+
+    // Move the parameters into their flat tensor.
+    at::NoGradGuard no_grad;
+    for (size_t i = 0; i < partition.parameters.size(); i++) {
+      auto& parameter = partition.parameters[i];
+      auto view = partition.flat_parameters
+                      .narrow(0, partition.offsets[i], parameter.numel())
+                      .view(parameter.sizes());
+      view.copy_(parameter);
+      parameter.set_data(view);
+    }
+
+    partition.shard = partition.parameter_slices[rank];
+    partition.shard.mutable_grad() = options_.reduce_scatter
+        ? at::zeros_like(partition.shard)
+        : partition.gradient_slices[rank];
+    shards.push_back(partition.shard);
+  }
+
+  zero_grad();
+  optimizer_ = make_optimizer(std::move(shards));
+  TORCH_CHECK(optimizer_, "The optimizer factory returned no optimizer.");
+}
+
+at::Tensor ShardedOptimizer::gradient_view(
+    const Partition& partition,
+    size_t index) {
+  const auto& parameter = partition.parameters[index];
+  return partition.flat_gradients
+      .narrow(0, partition.offsets[index], parameter.numel())
+      .view(parameter.sizes());
+}
+
+void ShardedOptimizer::gather_gradients(Partition& partition) {
+  for (size_t i = 0; i < partition.parameters.size(); i++) {
+    auto view = gradient_view(partition, i);
+    auto& grad = partition.parameters[i].mutable_grad();
+    if (!grad.defined()) {
+      view.zero_();
+      grad = view;
+    } else if (!grad.is_alias_of(view)) {
+      TORCH_CHECK(
+          !grad.is_sparse(),
+          "ShardedOptimizer does not support sparse gradients.");
+      view.copy_(grad);
+      grad = view;
+    }
+  }
+}
+
+void ShardedOptimizer::step() {
+  at::NoGradGuard no_grad;
+  const auto world_size = process_group_->getSize();
+  const auto rank = process_group_->getRank();
+
+  std::vector<std::shared_ptr<ProcessGroup::Work>> works;
+  for (auto& partition : partitions_) {
+    gather_gradients(partition);
+    if (options_.reduce_scatter) {
+      std::vector<at::Tensor> outputs = {partition.shard.mutable_grad()};
+      std::vector<std::vector<at::Tensor>> inputs = {
+          partition.gradient_slices};
+      works.push_back(process_group_->reduce_scatter(outputs, inputs));
+    } else {
+      std::vector<at::Tensor> tensors = {partition.flat_gradients};
+      works.push_back(process_group_->allreduce(tensors));
+    }
+  }
+  for (auto& work : works) {
+    work->wait();
+  }
+  for (auto& partition : partitions_) {
+    partition.shard.mutable_grad().div_(world_size);
+  }
+
+  optimizer_->step();
+
+  works.clear();
+  for (auto& partition : partitions_) {
+    std::vector<std::vector<at::Tensor>> outputs = {
+        partition.parameter_slices};
+    std::vector<at::Tensor> inputs = {partition.parameter_slices[rank]};
+    works.push_back(process_group_->allgather(outputs, inputs));
+  }
+  for (auto& work : works) {
+    work->wait();
+  }
+}
+
+void ShardedOptimizer::zero_grad() {
+  for (auto& partition : partitions_) {
+    partition.flat_gradients.zero_();
+    for (size_t i = 0; i < partition.parameters.size(); i++) {
+      partition.parameters[i].mutable_grad() = gradient_view(partition, i);
+    }
+  }
+}
+
+} // namespace c10d
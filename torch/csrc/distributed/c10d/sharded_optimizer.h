@@ -0,0 +1,104 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <c10d/ProcessGroup.hpp>
+#include <torch/optim/optimizer.h>
+
+namespace c10d {
+
+// Shards the state of an optimizer across the processes of a group, as in
+// stage 1 of ZeRO (Rajbhandari et al. 2019), for data parallel training
+// without DistributedDataParallel.
+//
+// The parameters of every dtype and device are moved into a flat tensor,
+// padded to a multiple of the size of the group, and so are their
+// gradients. Every process owns the slice of the flat tensor of its rank,
+// and the optimizer, made by the factory from these slices, only keeps
+// state for them. A step averages the gradients across the processes into
+// the slice of each, steps the optimizer, then allgathers the slices of the
+// parameters.
+//
+// The parameters end up views of the flat tensors, and their gradients too,
+// so that the gradients are accumulated directly into them.
+//
+// Example:
+//
+//   ShardedOptimizer optimizer(
+//       model->parameters(),
+//       process_group,
+//       [](std::vector<at::Tensor> shards) {
+//         return std::make_unique<torch::optim::Adam>(
+//             std::move(shards), torch::optim::AdamOptions(1e-3));
+//       });
+//   loss.backward();
+//   optimizer.step();
+//   optimizer.zero_grad();
+//
+class TORCH_API ShardedOptimizer {
+ public:
+  struct Options {
+    // Whether the gradients are reduced with reduce_scatter, so that every
+    // process only receives its slice, or with allreduce, for the process
+    // groups that don't support reduce_scatter, like ProcessGroupGloo.
+    bool reduce_scatter = true;
+  };
+
+  using OptimizerFactory =
+      std::function<std::unique_ptr<torch::optim::Optimizer>(
+          std::vector<at::Tensor>)>;
+
+  ShardedOptimizer(
+      std::vector<at::Tensor> parameters,
+      std::shared_ptr<ProcessGroup> process_group,
+      const OptimizerFactory& make_optimizer,
+      Options options = Options());
+
+  // Averages the gradients, steps the optimizer of the slices, and updates
+  // the parameters. All the processes of the group must call it together.
+  void step();
+
+  // Zeros the gradients, and makes them views of the flat gradients again
+  // if they were replaced.
+  void zero_grad();
+
+  // The optimizer of the slices of this process, for instance to change its
+  // learning rate or to save its state.
+  torch::optim::Optimizer& shard_optimizer() {
+    return *optimizer_;
+  }
+
+ private:
+  // The parameters of a dtype and device.
+  struct Partition {
+    std::vector<at::Tensor> parameters;
+    std::vector<int64_t> offsets;
+
+    // Of world_size * shard_numel elements.
+    at::Tensor flat_parameters;
+    at::Tensor flat_gradients;
+    // The slice of flat_parameters of every rank, and of flat_gradients.
+    std::vector<at::Tensor> parameter_slices;
+    std::vector<at::Tensor> gradient_slices;
+
+    // The slice of this rank, the parameter the optimizer steps. Its gradient
+    // is a tensor of its own with reduce_scatter, the slice of
+    // flat_gradients otherwise.
+    at::Tensor shard;
+  };
+
+  // The view of the flat gradients of the parameter at `index`.
+  static at::Tensor gradient_view(const Partition& partition, size_t index);
+
+  // Moves the gradients that are not views of the flat gradients into them.
+  void gather_gradients(Partition& partition);
+
+  std::shared_ptr<ProcessGroup> process_group_;
+  const Options options_;
+  std::vector<Partition> partitions_;
+  std::unique_ptr<torch::optim::Optimizer> optimizer_;
+};
+
+} // namespace c10d
@@ -0,0 +1,498 @@
+#include <torch/csrc/distributed/c10d/tensor_parallel.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <ATen/ATen.h>
+#include <c10/util/Exception.h>
+#include <torch/csrc/autograd/function.h>
+#include <torch/csrc/autograd/functions/utils.h>
+#include <torch/csrc/autograd/saved_variable.h>
+#include <torch/nn/init.h>
+
+namespace c10d {
+
+namespace {
+
+using torch::autograd::Node;
+using torch::autograd::SavedVariable;
+using torch::autograd::variable_list;
+using WorkList = std::vector<std::shared_ptr<ProcessGroup::Work>>;
+
+int64_t split_size(int64_t size, int world_size, const char* name) {
+  TORCH_CHECK(
+      size % world_size == 0,
+      name,
+      " (",
+      size,
+      ") must be divisible by the size of the process group (",
+      world_size,
+      ").");
+  return size / world_size;
+}
+
+// Computes `a.mm(b)` into `output`, a block of rows at a time, and starts
+// allreducing every block once it is computed, so that the collective of a
+// block overlaps the multiplication of the next one. The works are appended
+// to `works`, for the caller to overlap more computation before waiting.
+void mm_allreduce(
+    ProcessGroup& process_group,
+    const at::Tensor& a,
+    const at::Tensor& b,
+    at::Tensor& output,
+    int64_t chunks,
+    WorkList& works) {
+  const auto rows = a.size(0);
+  const auto block = std::max<int64_t>(1, (rows + chunks - 1) / chunks);
+  for (int64_t start = 0; start < rows; start += block) {
+    const auto length = std::min(block, rows - start);
+    auto output_block = output.narrow(0, start, length);
+    at::mm_out(output_block, a.narrow(0, start, length), b);
+    std::vector<at::Tensor> tensors = {output_block};
+    works.push_back(process_group.allreduce(tensors));
+  }
+}
+
+void wait(WorkList& works) {
+  for (auto& work : works) {
+    work->wait();
+  }
+}
+
+std::vector<int64_t> with_last_dim(at::IntArrayRef sizes, int64_t last) {
+  auto result = sizes.vec();
+  result.back() = last;
+  return result;
+}
+
+// The concatenation along the last dimension of the `tensor` of every
+// process.
+at::Tensor gather_last_dim(ProcessGroup& process_group, const at::Tensor& tensor) {
+  auto input = tensor.contiguous();
+  auto sizes = input.sizes().vec();
+  sizes.insert(sizes.begin(), process_group.getSize());
+  auto buffer = at::empty(sizes, input.options());
+  std::vector<std::vector<at::Tensor>> outputs = {buffer.unbind(0)};
+  std::vector<at::Tensor> inputs = {input};
+  process_group.allgather(outputs, inputs)->wait();
+  return at::cat(outputs[0], -1);
+}
+
+// The slice of the last dimension of `tensor` of this process.
+at::Tensor split_last_dim(ProcessGroup& process_group, const at::Tensor& tensor) {
+  const auto size = split_size(
+      tensor.size(-1), process_group.getSize(), "The last dimension");
+  return tensor.narrow(-1, process_group.getRank() * size, size).contiguous();
+}
+
+struct ColumnParallelLinearBackward : public Node {
+  ColumnParallelLinearBackward(
+      std::shared_ptr<ProcessGroup> process_group,
+      const at::Tensor& input,
+      const at::Tensor& weight,
+      int64_t chunks)
+      : process_group_(std::move(process_group)),
+        input_(input, false),
+        weight_(weight, false),
+        chunks_(chunks) {}
+
+  variable_list apply(variable_list&& grads) override {
+    variable_list result(3);
+    const auto& grad = grads[0];
+    if (!grad.defined()) {
+      return result;
+    }
+    auto input = input_.unpack();
+    auto weight = weight_.unpack();
+    auto grad_2d = grad.reshape({-1, grad.size(-1)});
+
+    // Start reducing the gradient of the input, which sums the
+    // contributions of the slices of the weight, before computing the
+    // gradients of the weight and bias, which need no communication.
+    WorkList works;
+    if (should_compute_output(0)) {
+      result[0] = at::empty(input.sizes(), grad.options());
+      auto grad_input_2d = result[0].view({-1, input.size(-1)});
+      mm_allreduce(
+          *process_group_, grad_2d, weight, grad_input_2d, chunks_, works);
+    }
+    if (should_compute_output(1)) {
+      result[1] = grad_2d.t().mm(input.reshape({-1, input.size(-1)}));
+    }
+    if (should_compute_output(2)) {
+      result[2] = grad_2d.sum(0);
+    }
+    wait(works);
+    return result;
+  }
+
+  void release_variables() override {
+    input_.reset_data();
+    input_.reset_grad_function();
+    weight_.reset_data();
+    weight_.reset_grad_function();
+  }
+
+  std::shared_ptr<ProcessGroup> process_group_;
+  SavedVariable input_;
+  SavedVariable weight_;
+  int64_t chunks_;
+};
+
+struct RowParallelLinearBackward : public Node {
+  RowParallelLinearBackward(const at::Tensor& input, const at::Tensor& weight)
+      : input_(input, false), weight_(weight, false) {}
+
+  variable_list apply(variable_list&& grads) override {
+    variable_list result(2);
+    const auto& grad = grads[0];
+    if (!grad.defined()) {
+      return result;
+    }
+    auto input = input_.unpack();
+    auto weight = weight_.unpack();
+    auto grad_2d = grad.reshape({-1, grad.size(-1)});
+    if (should_compute_output(0)) {
+      result[0] = grad_2d.mm(weight).view(input.sizes());
+    }
+    if (should_compute_output(1)) {
+      result[1] = grad_2d.t().mm(input.reshape({-1, input.size(-1)}));
+    }
+    return result;
+  }
+
+  void release_variables() override {
+    input_.reset_data();
+    input_.reset_grad_function();
+    weight_.reset_data();
+    weight_.reset_grad_function();
+  }
+
+  SavedVariable input_;
+  SavedVariable weight_;
+};
+
+// The backward of gathering the outputs of the processes: the slice of the
+// gradient of this process.
+struct GatherLastDimBackward : public Node {
+  explicit GatherLastDimBackward(std::shared_ptr<ProcessGroup> process_group)
+      : process_group_(std::move(process_group)) {}
+
+  variable_list apply(variable_list&& grads) override {
+    if (!grads[0].defined()) {
+      return {at::Tensor()};
+    }
+    return {split_last_dim(*process_group_, grads[0])};
+  }
+
+  std::shared_ptr<ProcessGroup> process_group_;
+};
+
+// The backward of splitting an input the same on all the processes: the
+// gradients of all the slices.
+struct SplitLastDimBackward : public Node {
+  explicit SplitLastDimBackward(std::shared_ptr<ProcessGroup> process_group)
+      : process_group_(std::move(process_group)) {}
+
+  variable_list apply(variable_list&& grads) override {
+    if (!grads[0].defined()) {
+      return {at::Tensor()};
+    }
+    return {gather_last_dim(*process_group_, grads[0])};
+  }
+
+  std::shared_ptr<ProcessGroup> process_group_;
+};
+
+struct VocabParallelEmbeddingBackward : public Node {
+  VocabParallelEmbeddingBackward(
+      at::Tensor indices,
+      at::Tensor mask,
+      int64_t num_weights)
+      : indices_(std::move(indices)),
+        mask_(std::move(mask)),
+        num_weights_(num_weights) {}
+
+  variable_list apply(variable_list&& grads) override {
+    const auto& grad = grads[0];
+    if (!grad.defined()) {
+      return {at::Tensor()};
+    }
+    // The indices out of the range of this process were looked up as 0, and
+    // contribute nothing to its weight.
+    return {at::embedding_backward(
+        grad.masked_fill(mask_.unsqueeze(-1), 0),
+        indices_,
+        num_weights_,
+        /*padding_idx=*/-1,
+        /*scale_grad_by_freq=*/false,
+        /*sparse=*/false)};
+  }
+
+  void release_variables() override {
+    indices_.reset();
+    mask_.reset();
+  }
+
+  at::Tensor indices_;
+  at::Tensor mask_;
+  int64_t num_weights_;
+};
+
+at::Tensor gather_from_tensor_parallel_region(
+    const std::shared_ptr<ProcessGroup>& process_group,
+    const at::Tensor& input) {
+  if (process_group->getSize() == 1) {
+    return input;
+  }
+  at::Tensor output;
+  {
+    at::NoGradGuard no_grad;
+    output = gather_last_dim(*process_group, input);
+  }
+  if (torch::autograd::compute_requires_grad(input)) {
+    auto grad_fn = std::make_shared<GatherLastDimBackward>(process_group);
+    grad_fn->set_next_edges(torch::autograd::collect_next_edges(input));
+    torch::autograd::set_history(output, grad_fn);
+  }
+  return output;
+}
+
+at::Tensor scatter_to_tensor_parallel_region(
+    const std::shared_ptr<ProcessGroup>& process_group,
+    const at::Tensor& input) {
+  if (process_group->getSize() == 1) {
+    return input;
+  }
+  at::Tensor output;
+  {
+    at::NoGradGuard no_grad;
+    output = split_last_dim(*process_group, input);
+  }
+  if (torch::autograd::compute_requires_grad(input)) {
+    auto grad_fn = std::make_shared<SplitLastDimBackward>(process_group);
+    grad_fn->set_next_edges(torch::autograd::collect_next_edges(input));
+    torch::autograd::set_history(output, grad_fn);
+  }
+  return output;
+}
+
+} // namespace
+
+ColumnParallelLinearImpl::ColumnParallelLinearImpl(
+    std::shared_ptr<ProcessGroup> process_group_,
+    const ColumnParallelLinearOptions& options_)
+    : process_group(std::move(process_group_)), options(options_) {
+  reset();
+}
+
+void ColumnParallelLinearImpl::reset() {
+  TORCH_CHECK(process_group, "ColumnParallelLinear needs a process group.");
+  TORCH_CHECK(options.chunks() > 0, "chunks must be positive.");
+  const auto out_features = split_size(
+      options.out_features(), process_group->getSize(), "out_features");
+  weight = register_parameter(
+      "weight", torch::empty({out_features, options.in_features()}));
+  if (options.bias()) {
+    bias = register_parameter("bias", torch::empty(out_features));
+  } else {
+    bias = register_parameter("bias", {}, /*requires_grad=*/false);
+  }
+
+  reset_parameters();
+}
+
+void ColumnParallelLinearImpl::reset_parameters() {
+  // The distribution of torch::nn::Linear, whose fan in is that of the
+  // slices.
+  const auto bound = 1 / std::sqrt(options.in_features());
+  torch::nn::init::uniform_(weight, -bound, bound);
+  if (bias.defined()) {
+    torch::nn::init::uniform_(bias, -bound, bound);
+  }
+}
+
+void ColumnParallelLinearImpl::pretty_print(std::ostream& stream) const {
+  stream << std::boolalpha
+         << "c10d::ColumnParallelLinear(in_features=" << options.in_features()
+         << ", out_features=" << options.out_features()
+         << ", bias=" << options.bias()
+         << ", gather_output=" << options.gather_output()
+         << ", world_size=" << process_group->getSize() << ")";
+}
+
+torch::Tensor ColumnParallelLinearImpl::forward(const torch::Tensor& input) {
+  TORCH_CHECK(
+      input.dim() >= 1 && input.size(-1) == options.in_features(),
+      "Expected an input of ",
+      options.in_features(),
+      " features, got one of size ",
+      input.sizes());
+  torch::Tensor output;
+  {
+    at::NoGradGuard no_grad;
+    output = at::empty(
+        with_last_dim(input.sizes(), weight.size(0)), input.options());
+    auto output_2d = output.view({-1, weight.size(0)});
+    auto input_2d = input.reshape({-1, input.size(-1)});
+    if (bias.defined()) {
+      at::addmm_out(output_2d, bias, input_2d, weight.t());
+    } else {
+      at::mm_out(output_2d, input_2d, weight.t());
+    }
+  }
+  if (torch::autograd::compute_requires_grad(input, weight, bias)) {
+    auto grad_fn = std::make_shared<ColumnParallelLinearBackward>(
+        process_group, input, weight, options.chunks());
+    grad_fn->set_next_edges(
+        torch::autograd::collect_next_edges(input, weight, bias));
+    torch::autograd::set_history(output, grad_fn);
+  }
+  if (options.gather_output()) {
+    return gather_from_tensor_parallel_region(process_group, output);
+  }
+  return output;
+}
+
+RowParallelLinearImpl::RowParallelLinearImpl(
+    std::shared_ptr<ProcessGroup> process_group_,
+    const RowParallelLinearOptions& options_)
+    : process_group(std::move(process_group_)), options(options_) {
+  reset();
+}
+
+void RowParallelLinearImpl::reset() {
+  TORCH_CHECK(process_group, "RowParallelLinear needs a process group.");
+  TORCH_CHECK(options.chunks() > 0, "chunks must be positive.");
+  const auto in_features = split_size(
+      options.in_features(), process_group->getSize(), "in_features");
+  weight = register_parameter(
+      "weight", torch::empty({options.out_features(), in_features}));
+  if (options.bias()) {
+    bias = register_parameter("bias", torch::empty(options.out_features()));
+  } else {
+    bias = register_parameter("bias", {}, /*requires_grad=*/false);
+  }
+
+  reset_parameters();
+}
+
+void RowParallelLinearImpl::reset_parameters() {
+  // The distribution of torch::nn::Linear over the whole fan in. The bias
+  // must be the same on all processes without communicating, as reset()
+  // runs on a single process when cloning, so it starts at zero.
+  const auto bound = 1 / std::sqrt(options.in_features());
+  torch::nn::init::uniform_(weight, -bound, bound);
+  if (bias.defined()) {
+    torch::nn::init::zeros_(bias);
+  }
+}
+
+void RowParallelLinearImpl::pretty_print(std::ostream& stream) const {
+  stream << std::boolalpha
+         << "c10d::RowParallelLinear(in_features=" << options.in_features()
+         << ", out_features=" << options.out_features()
+         << ", bias=" << options.bias()
+         << ", input_is_parallel=" << options.input_is_parallel()
+         << ", world_size=" << process_group->getSize() << ")";
+}
+
+torch::Tensor RowParallelLinearImpl::forward(const torch::Tensor& input) {
+  auto input_parallel = options.input_is_parallel()
+      ? input
+      : scatter_to_tensor_parallel_region(process_group, input);
+  TORCH_CHECK(
+      input_parallel.dim() >= 1 && input_parallel.size(-1) == weight.size(1),
+      "Expected an input of ",
+      options.input_is_parallel() ? weight.size(1) : options.in_features(),
+      " features, got one of size ",
+      input.sizes());
+  torch::Tensor output;
+  {
+    at::NoGradGuard no_grad;
+    output = at::empty(
+        with_last_dim(input_parallel.sizes(), weight.size(0)),
+        input_parallel.options());
+    auto output_2d = output.view({-1, weight.size(0)});
+    WorkList works;
+    mm_allreduce(
+        *process_group,
+        input_parallel.reshape({-1, weight.size(1)}),
+        weight.t(),
+        output_2d,
+        options.chunks(),
+        works);
+    wait(works);
+  }
+  if (torch::autograd::compute_requires_grad(input_parallel, weight)) {
+    auto grad_fn =
+        std::make_shared<RowParallelLinearBackward>(input_parallel, weight);
+    grad_fn->set_next_edges(
+        torch::autograd::collect_next_edges(input_parallel, weight));
+    torch::autograd::set_history(output, grad_fn);
+  }
+  // The gradient of the output is the same on all the processes, and so is
+  // that of the bias.
+  if (bias.defined()) {
+    return output + bias;
+  }
+  return output;
+}
+
+VocabParallelEmbeddingImpl::VocabParallelEmbeddingImpl(
+    std::shared_ptr<ProcessGroup> process_group_,
+    const VocabParallelEmbeddingOptions& options_)
+    : process_group(std::move(process_group_)), options(options_) {
+  reset();
+}
+
+void VocabParallelEmbeddingImpl::reset() {
+  TORCH_CHECK(process_group, "VocabParallelEmbedding needs a process group.");
+  const auto num_embeddings = split_size(
+      options.num_embeddings(), process_group->getSize(), "num_embeddings");
+  weight = register_parameter(
+      "weight", torch::empty({num_embeddings, options.embedding_dim()}));
+
+  reset_parameters();
+}
+
+void VocabParallelEmbeddingImpl::reset_parameters() {
+  torch::nn::init::normal_(weight);
+}
+
+void VocabParallelEmbeddingImpl::pretty_print(std::ostream& stream) const {
+  stream << "c10d::VocabParallelEmbedding(num_embeddings="
+         << options.num_embeddings()
+         << ", embedding_dim=" << options.embedding_dim()
+         << ", world_size=" << process_group->getSize() << ")";
+}
+
+torch::Tensor VocabParallelEmbeddingImpl::forward(const torch::Tensor& input) {
+  TORCH_CHECK(
+      input.scalar_type() == at::kLong || input.scalar_type() == at::kInt,
+      "Expected integer indices, got ",
+      input.scalar_type());
+  const auto num_weights = weight.size(0);
+  const auto start = process_group->getRank() * num_weights;
+  torch::Tensor output;
+  torch::Tensor indices;
+  torch::Tensor mask;
+  {
+    at::NoGradGuard no_grad;
+    mask = input.lt(start).logical_or_(input.ge(start + num_weights));
+    indices = input.sub(start).masked_fill_(mask, 0);
+    output = at::embedding(weight, indices);
+    output.masked_fill_(mask.unsqueeze(-1), 0);
+    std::vector<at::Tensor> tensors = {output};
+    process_group->allreduce(tensors)->wait();
+  }
+  if (torch::autograd::compute_requires_grad(weight)) {
+    auto grad_fn = std::make_shared<VocabParallelEmbeddingBackward>(
+        std::move(indices), std::move(mask), num_weights);
+    grad_fn->set_next_edges(torch::autograd::collect_next_edges(weight));
+    torch::autograd::set_history(output, grad_fn);
+  }
+  return output;
+}
+
+} // namespace c10d
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <memory>
+#include <ostream>
+
+#include <c10d/ProcessGroup.hpp>
+#include <torch/arg.h>
+#include <torch/nn/cloneable.h>
+#include <torch/nn/pimpl.h>
+#include <torch/types.h>
+
+namespace c10d {
+
+// Layers of a model split across the processes of a group, as in the tensor
+// model parallelism of Megatron-LM (Shoeybi et al. 2019). Every process
+// holds a slice of the weights of each layer and the processes exchange
+// activations, or their gradients, inside the layers. All the processes of
+// the group must run the forward and backward passes of the layers
+// together, with the same inputs unless stated otherwise.
+//
+// A column parallel layer followed by a row parallel one, e.g. the two
+// layers of a transformer MLP, only communicates once in each direction:
+//
+//   ColumnParallelLinear fc1(
+//       process_group,
+//       ColumnParallelLinearOptions(1024, 4096).gather_output(false));
+//   RowParallelLinear fc2(
+//       process_group,
+//       RowParallelLinearOptions(4096, 1024).input_is_parallel(true));
+//   auto output = fc2(torch::gelu(fc1(input)));
+//
+// The layers that reduce activations split their matrix multiplication into
+// `chunks` blocks of rows, and allreduce every block as soon as it is
+// computed, in place in the output, so that the collective of a block runs
+// while the next block is computed. With ProcessGroupNCCL, the collectives
+// run on the communication streams of the group and the output is allocated
+// once by the caching allocator, without staging buffers.
+
+struct TORCH_API ColumnParallelLinearOptions {
+  ColumnParallelLinearOptions(int64_t in_features, int64_t out_features)
+      : in_features_(in_features), out_features_(out_features) {}
+
+  // The size of each input sample.
+  TORCH_ARG(int64_t, in_features);
+
+  // The size of each output sample, split across the processes.
+  TORCH_ARG(int64_t, out_features);
+
+  // Whether the layer learns an additive bias, split like the outputs.
+  TORCH_ARG(bool, bias) = true;
+
+  // Whether the outputs of the processes are gathered, so that every
+  // process gets all the `out_features`, or kept split for a following
+  // `RowParallelLinear`.
+  TORCH_ARG(bool, gather_output) = true;
+
+  // The number of blocks the gradient of the input is computed and
+  // allreduced in.
+  TORCH_ARG(int64_t, chunks) = 4;
+};
+
+// Applies a linear transformation whose weight is split along its rows, the
+// output features, across the processes of `process_group`. The input must
+// be the same on all the processes, its gradient is allreduced.
+class TORCH_API ColumnParallelLinearImpl
+    : public torch::nn::Cloneable<ColumnParallelLinearImpl> {
+ public:
+  ColumnParallelLinearImpl(
+      std::shared_ptr<ProcessGroup> process_group,
+      const ColumnParallelLinearOptions& options_);
+
+  void reset() override;
+
+  void reset_parameters();
+
+  void pretty_print(std::ostream& stream) const override;
+
+  torch::Tensor forward(const torch::Tensor& input);
+
+  std::shared_ptr<ProcessGroup> process_group;
+
+  ColumnParallelLinearOptions options;
+
+  // The out_features / world_size rows of the weight of this process.
+  torch::Tensor weight;
+
+  // The slice of the bias of this process, undefined without `bias`.
+  torch::Tensor bias;
+};
+
+TORCH_MODULE(ColumnParallelLinear);
+
+struct TORCH_API RowParallelLinearOptions {
+  RowParallelLinearOptions(int64_t in_features, int64_t out_features)
+      : in_features_(in_features), out_features_(out_features) {}
+
+  // The size of each input sample, split across the processes.
+  TORCH_ARG(int64_t, in_features);
+
+  // The size of each output sample.
+  TORCH_ARG(int64_t, out_features);
+
+  // Whether the layer learns an additive bias, the same on all processes.
+  TORCH_ARG(bool, bias) = true;
+
+  // Whether every process passes its slice of the input features, like the
+  // output of a `ColumnParallelLinear` without `gather_output`, rather than
+  // all of them.
+  TORCH_ARG(bool, input_is_parallel) = false;
+
+  // The number of blocks the output is computed and allreduced in.
+  TORCH_ARG(int64_t, chunks) = 4;
+};
+
+// Applies a linear transformation whose weight is split along its columns,
+// the input features, across the processes of `process_group`. The partial
+// outputs of the processes are allreduced, so every process gets the whole
+// output.
+class TORCH_API RowParallelLinearImpl
+    : public torch::nn::Cloneable<RowParallelLinearImpl> {
+ public:
+  RowParallelLinearImpl(
+      std::shared_ptr<ProcessGroup> process_group,
+      const RowParallelLinearOptions& options_);
+
+  void reset() override;
+
+  void reset_parameters();
+
+  void pretty_print(std::ostream& stream) const override;
+
+  torch::Tensor forward(const torch::Tensor& input);
+
+  std::shared_ptr<ProcessGroup> process_group;
+
+  RowParallelLinearOptions options;
+
+  // The in_features / world_size columns of the weight of this process.
+  torch::Tensor weight;
+
+  // The whole bias, added after the reduction, undefined without `bias`.
+  torch::Tensor bias;
+};
+
+TORCH_MODULE(RowParallelLinear);
+
+struct TORCH_API VocabParallelEmbeddingOptions {
+  VocabParallelEmbeddingOptions(int64_t num_embeddings, int64_t embedding_dim)
+      : num_embeddings_(num_embeddings), embedding_dim_(embedding_dim) {}
+
+  // The size of the vocabulary, split across the processes.
+  TORCH_ARG(int64_t, num_embeddings);
+
+  // The size of each embedding vector.
+  TORCH_ARG(int64_t, embedding_dim);
+};
+
+// An embedding whose vocabulary is split across the processes of
+// `process_group`. Every process looks up the indices of its range of the
+// vocabulary, and the embeddings are allreduced, so every process gets the
+// embeddings of all the indices.
+class TORCH_API VocabParallelEmbeddingImpl
+    : public torch::nn::Cloneable<VocabParallelEmbeddingImpl> {
+ public:
+  VocabParallelEmbeddingImpl(
+      std::shared_ptr<ProcessGroup> process_group,
+      const VocabParallelEmbeddingOptions& options_);
+
+  void reset() override;
+
+  void reset_parameters();
+
+  void pretty_print(std::ostream& stream) const override;
+
+  torch::Tensor forward(const torch::Tensor& input);
+
+  std::shared_ptr<ProcessGroup> process_group;
+
+  VocabParallelEmbeddingOptions options;
+
+  // The embeddings of the num_embeddings / world_size indices of this
+  // process, starting at rank * num_embeddings / world_size.
+  torch::Tensor weight;
+};
+
+TORCH_MODULE(VocabParallelEmbedding);
+
+} // namespace c10d
@@ -410,6 +410,32 @@ PyObject* rpc_init(PyObject* /* unused */) {
           &ProcessGroupRpcBackendOptions::numSendRecvThreads,
           R"(
               The number of threads in the thread-pool used by ProcessGroupAgent.
+          )")
+      .def_readwrite(
+          "max_coalesced_bytes",
+          &ProcessGroupRpcBackendOptions::maxCoalescedBytes,
+          R"(
+              The maximum size, in bytes, of the writes into which
+              ProcessGroupAgent coalesces the messages to the same
+              destination. The messages that are sent while a write to their
+              destination is in flight are sent together in the next one.
+              0, the default, disables the coalescing.
+          )")
+      .def_readwrite(
+          "coalescing_window",
+          &ProcessGroupRpcBackendOptions::coalescingWindow,
+          R"(
+              How long the first message of a coalesced write waits for other
+              messages to the same destination, as a ``timedelta``
+              (default: 0).
+          )")
+      .def_readwrite(
+          "metrics_handler",
+          &ProcessGroupRpcBackendOptions::metricsHandler,
+          R"(
+              The name of the ``RpcMetricsHandler``, in its C++ registry, that
+              the metrics of the send queues of the coalescing are logged to.
+              Empty, the default, for none.
           )");
 
   module.attr("_DEFAULT_NUM_SEND_RECV_THREADS") =
@@ -419,14 +445,29 @@ PyObject* rpc_init(PyObject* /* unused */) {
       .def(py::init([](std::string workerName,
                        const std::shared_ptr<::c10d::ProcessGroup>& pg,
                        int numSendRecvThreads,
-                       std::chrono::milliseconds rpcTimeout) {
-        return std::make_unique<ProcessGroupAgent>(
-            std::move(workerName),
-            pg,
-            numSendRecvThreads,
-            rpcTimeout,
-            std::make_unique<RequestCallbackImpl>());
-      }))
+                       std::chrono::milliseconds rpcTimeout,
+                       int64_t maxCoalescedBytes,
+                       std::chrono::microseconds coalescingWindow,
+                       const std::string& metricsHandler) {
+             CoalescingOptions coalescingOptions;
+             coalescingOptions.maxBytes = maxCoalescedBytes;
+             coalescingOptions.window = coalescingWindow;
+             return std::make_unique<ProcessGroupAgent>(
+                 std::move(workerName),
+                 pg,
+                 numSendRecvThreads,
+                 rpcTimeout,
+                 std::make_unique<RequestCallbackImpl>(),
+                 coalescingOptions,
+                 metricsHandler);
+           }),
+           py::arg("name"),
+           py::arg("process_group"),
+           py::arg("num_send_recv_threads"),
+           py::arg("rpc_timeout"),
+           py::arg("max_coalesced_bytes") = 0,
+           py::arg("coalescing_window") = std::chrono::microseconds(0),
+           py::arg("metrics_handler") = "")
       .def(
           "get_worker_info",
           (const WorkerInfo& (ProcessGroupAgent::*)(void)const) &
@@ -593,6 +634,22 @@ PyObject* rpc_init(PyObject* /* unused */) {
     return RRefContext::getInstance().getDebugInfo();
   });
 
+  module.def(
+      "_set_rref_control_message_batching",
+      [](std::chrono::milliseconds interval) {
+        RRefContext::getInstance().setControlMessageBatching(interval);
+      },
+      py::arg("interval"),
+      py::call_guard<py::gil_scoped_release>());
+
+  module.def(
+      "_set_rref_metrics_handler",
+      [](const std::string& handlerName) {
+        RRefContext::getInstance().setMetricsHandler(handlerName);
+      },
+      py::arg("handler_name"),
+      py::call_guard<py::gil_scoped_release>());
+
   module.def(
       "_cleanup_python_rpc_handler",
       []() { PythonRpcHandler::getInstance().cleanup(); },
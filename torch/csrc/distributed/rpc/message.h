@@ -56,6 +56,10 @@ enum MessageType {
   RUN_WITH_PROFILING_REQ = 21,
   RUN_WITH_PROFILING_RESP = 22,
 
+  // Batched RREF_USER_DELETE, RREF_FORK_REQUEST and RREF_CHILD_ACCEPT
+  // messages, answered with a single RREF_ACK.
+  RREF_BATCHED_REQUEST = 23,
+
   // Other internal message types
   EXCEPTION = 55,
   UNKNOWN = 60
@@ -1,5 +1,6 @@
 #include <torch/csrc/distributed/rpc/process_group_agent.h>
 
+#include <c10/core/thread_budget.h>
 #include <c10/util/C++17.h>
 #include <c10d/ProcessGroup.hpp>
 #include <fmt/format.h>
@@ -13,6 +14,9 @@ const std::string kRPCTimeoutErrorStr =
 
 namespace {
 constexpr auto kSecToMsConversion = 1000;
+// The type in the preamble of a write of coalesced messages, whose id is the
+// number of messages.
+constexpr int64_t kCoalescedMessagesType = -1;
 }
 
 //////////////////////////  MessageCounter  /////////////////////////////////
@@ -62,6 +66,8 @@ const std::string kGilAverageWaitTime = "agent.gil_average_wait_time_us";
 const std::string kClientActiveCalls = "agent.client_active_calls";
 const std::string kServerActiveCalls = "agent.server_active_calls";
 const std::string kServerActiveAsyncCalls = "agent.server_active_async_calls";
+const std::string kCoalescedWrites = "agent.coalesced_writes";
+const std::string kCoalescedMessages = "agent.coalesced_messages";
 
 void ProcessGroupAgent::collectNames() {
   const std::string& workerName = workerInfo_.name_;
@@ -99,7 +105,9 @@ ProcessGroupAgent::ProcessGroupAgent(
     std::shared_ptr<c10d::ProcessGroup> pg,
     int numSendRecvThreads,
     std::chrono::milliseconds rpcTimeout,
-    std::unique_ptr<RequestCallback> cb)
+    std::unique_ptr<RequestCallback> cb,
+    CoalescingOptions coalescingOptions,
+    const std::string& metricsHandler)
     : RpcAgent(
           WorkerInfo(std::move(workerName), (int64_t)pg->getRank()),
           std::move(cb),
@@ -109,8 +117,21 @@ ProcessGroupAgent::ProcessGroupAgent(
       recvCounts_(pg_->getSize()),
       nextId_(0),
       sendMutexes_(pg_->getSize()),
-      threadPool_(numSendRecvThreads),
-      timeoutThreadEnabled_{false} {
+      threadPool_(c10::ThreadBudget::global().acquire(
+          c10::ThreadPoolKind::Distributed,
+          numSendRecvThreads)),
+      timeoutThreadEnabled_{false},
+      coalescingOptions_(coalescingOptions),
+      sendQueues_(pg_->getSize()) {
+  TORCH_CHECK(
+      coalescingOptions_.maxBytes >= 0,
+      "The maximum size of coalesced writes must not be negative, got ",
+      coalescingOptions_.maxBytes);
+  if (!metricsHandler.empty()) {
+    metricsHandler_ = RpcMetricsHandlerRegistry()->Create(metricsHandler);
+    TORCH_CHECK(
+        metricsHandler_, "Unknown RPC metrics handler ", metricsHandler);
+  }
   // initialize metric info counters
   metrics_.resize(ProcessGroupAgentMetrics::N_METRICS);
   metrics_[ProcessGroupAgentMetrics::GIL_WAIT_TIME] =
@@ -147,6 +168,8 @@ ProcessGroupAgent::~ProcessGroupAgent() {
   if (rpcAgentRunning_) {
     shutdown();
   }
+  c10::ThreadBudget::global().release(
+      c10::ThreadPoolKind::Distributed, threadPool_.size());
 }
 
 const WorkerInfo& ProcessGroupAgent::getWorkerInfo(
@@ -390,20 +413,45 @@ std::shared_ptr<FutureMessage> ProcessGroupAgent::send(
 }
 
 void ProcessGroupAgent::handleSend(const SendWork& work) {
-  auto serializedPayload = std::make_unique<std::string>(std::move(
-      wireSerialize(work.message_.payload(), work.message_.tensors())));
+  auto serializedPayload =
+      wireSerialize(work.message_.payload(), work.message_.tensors());
+  const auto dst = work.to_.id_;
+
+  sendCounts_.increment(dst);
+
+  if (coalescingOptions_.maxBytes > 0) {
+    coalesceSend(
+        dst,
+        QueuedMessage{work.message_.type(),
+                      work.message_.id(),
+                      work.message_.isRequest(),
+                      std::move(serializedPayload)});
+  } else {
+    sendPayload(
+        dst,
+        work.message_.type(),
+        work.message_.id(),
+        std::move(serializedPayload));
+  }
+}
+
+void ProcessGroupAgent::sendPayload(
+    worker_id_t dst,
+    MessageType type,
+    int64_t id,
+    std::string&& payloadData) {
+  auto serializedPayload = std::make_unique<std::string>(std::move(payloadData));
 
   std::vector<torch::Tensor> preamble = {torch::tensor(
       {(int64_t)pg_->getRank(),
        (int64_t)serializedPayload->length(),
-       (int64_t)work.message_.type(),
-       (int64_t)work.message_.id()},
+       (int64_t)type,
+       id},
       {torch::kInt64})};
 
   // ProcessGroup is not thread-safe when sending with the same tag,
   // hence the lock
   std::vector<std::shared_ptr<c10d::ProcessGroup::Work>> pendingSends;
-  const auto dst = work.to_.id_;
 
   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
   auto serializedPayloadData = const_cast<char*>(serializedPayload->data());
@@ -416,8 +464,6 @@ void ProcessGroupAgent::handleSend(const SendWork& work) {
       {torch::kChar})};
   pendingSends.reserve(2);
 
-  sendCounts_.increment(dst);
-
   {
     std::lock_guard<std::mutex> guard(sendMutexes_[dst]);
     pendingSends.emplace_back(pg_->send(preamble, dst, dst /* channelTag */));
@@ -451,6 +497,109 @@ void ProcessGroupAgent::handleSend(const SendWork& work) {
   }
 }
 
+void ProcessGroupAgent::coalesceSend(
+    worker_id_t dst,
+    QueuedMessage&& message) {
+  auto& queue = sendQueues_[dst];
+  {
+    std::lock_guard<std::mutex> guard(queue.mutex);
+    queue.bytes += message.data.size();
+    queue.messages.push_back(std::move(message));
+    if (metricsHandler_) {
+      const auto prefix = c10::str(
+          kRpcMetricsKeyPrefix, "send_queue.", allWorkerInfo_[dst].name_);
+      metricsHandler_->accumulateMetric(
+          prefix + ".queued_bytes", queue.bytes);
+      metricsHandler_->accumulateMetric(
+          prefix + ".queued_messages", queue.messages.size());
+    }
+    if (queue.flushing) {
+      // The thread sending the queue will send this message too.
+      return;
+    }
+    queue.flushing = true;
+  }
+  if (coalescingOptions_.window.count() > 0) {
+    /* sleep override */
+    std::this_thread::sleep_for(coalescingOptions_.window);
+  }
+  flushSendQueue(dst);
+}
+
+void ProcessGroupAgent::flushSendQueue(worker_id_t dst) {
+  auto& queue = sendQueues_[dst];
+  while (true) {
+    std::vector<QueuedMessage> batch;
+    size_t batchBytes = 0;
+    {
+      std::lock_guard<std::mutex> guard(queue.mutex);
+      if (queue.messages.empty()) {
+        queue.flushing = false;
+        return;
+      }
+      // A message larger than the limit is sent on its own.
+      while (!queue.messages.empty() &&
+             (batch.empty() ||
+              batchBytes + queue.messages.front().data.size() <=
+                  static_cast<size_t>(coalescingOptions_.maxBytes))) {
+        batchBytes += queue.messages.front().data.size();
+        batch.push_back(std::move(queue.messages.front()));
+        queue.messages.pop_front();
+      }
+      queue.bytes -= batchBytes;
+    }
+
+    ++coalescedWrites_;
+    coalescedMessages_ += batch.size();
+    if (metricsHandler_) {
+      const auto prefix = c10::str(
+          kRpcMetricsKeyPrefix, "send_queue.", allWorkerInfo_[dst].name_);
+      metricsHandler_->incrementMetric(prefix + ".writes");
+      metricsHandler_->accumulateMetric(
+          prefix + ".messages_per_write", batch.size());
+      metricsHandler_->accumulateMetric(prefix + ".bytes_per_write", batchBytes);
+    }
+
+    try {
+      if (batch.size() == 1) {
+        auto& message = batch.front();
+        sendPayload(dst, message.type, message.id, std::move(message.data));
+      } else {
+        // The coalesced messages follow each other, every one of them
+        // preceded by its type, id and size.
+        std::string data;
+        data.reserve(batchBytes + batch.size() * 3 * sizeof(int64_t));
+        for (const auto& message : batch) {
+          const int64_t header[] = {(int64_t)message.type,
+                                    message.id,
+                                    (int64_t)message.data.size()};
+          data.append(reinterpret_cast<const char*>(header), sizeof(header));
+          data.append(message.data);
+        }
+        sendPayload(
+            dst,
+            static_cast<MessageType>(kCoalescedMessagesType),
+            batch.size(),
+            std::move(data));
+      }
+    } catch (std::exception& e) {
+      auto errorStr = c10::str(
+          "Encountered exception in ProcessGroupAgent::flushSendQueue: ",
+          e.what(),
+          " on node: ",
+          RpcAgent::getWorkerInfo().id_);
+      for (const auto& message : batch) {
+        if (message.isRequest) {
+          markFutureWithError(message.id, errorStr);
+        } else {
+          LOG(WARNING) << "Failed to send response #" << message.id << " to "
+                       << allWorkerInfo_[dst].name_ << ": " << e.what();
+        }
+      }
+    }
+  }
+}
+
 void ProcessGroupAgent::sendToSelf(Message&& message) {
   threadPool_.run(std::bind(
       [this](const Message& message) {
@@ -512,7 +661,7 @@ void ProcessGroupAgent::enqueueSend(SendWork work) {
 
 bool ProcessGroupAgent::handleRecv(RecvWork& work) {
   torch::Tensor& payload = work.payload_;
-  auto data = wireDeserialize(payload.storage().data(), payload.numel());
+  auto data = wireDeserialize(payload.data_ptr(), payload.numel());
   Message message(
       std::move(data.first), std::move(data.second), work.type_, work.id_);
   if (message.isRequest()) {
@@ -732,7 +881,7 @@ void ProcessGroupAgent::listenLoopInternal() {
 
     auto srcRank = preamble_items[0];
     auto size = preamble_items[1];
-    MessageType type = MessageType(preamble_items[2]);
+    auto rawType = preamble_items[2];
     int64_t id = preamble_items[3];
 
     std::vector<torch::Tensor> tensors = {torch::empty({size}, {torch::kChar})};
@@ -747,8 +896,37 @@ void ProcessGroupAgent::listenLoopInternal() {
       return;
     }
 
-    enqueueRecv(
-        RecvWork(allWorkerInfo_[srcRank], type, id, std::move(tensors[0])));
+    if (rawType != kCoalescedMessagesType) {
+      enqueueRecv(RecvWork(
+          allWorkerInfo_[srcRank],
+          MessageType(rawType),
+          id,
+          std::move(tensors[0])));
+      continue;
+    }
+    // Split the coalesced messages, each of them keeping the received tensor
+    // alive through a view of its bytes.
+    const char* data = static_cast<const char*>(tensors[0].data_ptr());
+    int64_t offset = 0;
+    for (int64_t i = 0; i < id; ++i) {
+      int64_t header[3];
+      TORCH_CHECK(
+          offset + (int64_t)sizeof(header) <= size,
+          "Truncated coalesced RPC messages from rank ",
+          srcRank);
+      memcpy(header, data + offset, sizeof(header));
+      offset += sizeof(header);
+      TORCH_CHECK(
+          offset + header[2] <= size,
+          "Truncated coalesced RPC messages from rank ",
+          srcRank);
+      enqueueRecv(RecvWork(
+          allWorkerInfo_[srcRank],
+          MessageType(header[0]),
+          header[1],
+          tensors[0].narrow(0, offset, header[2])));
+      offset += header[2];
+    }
   }
 }
 
@@ -859,6 +1037,10 @@ std::unordered_map<std::string, std::string> ProcessGroupAgent::getMetrics() {
   metrics[kServerActiveCalls] = c10::to_string(serverActiveCalls_.load());
   metrics[kServerActiveAsyncCalls] =
       c10::to_string(serverActiveAsyncCalls_.load());
+  if (coalescingOptions_.maxBytes > 0) {
+    metrics[kCoalescedWrites] = c10::to_string(coalescedWrites_.load());
+    metrics[kCoalescedMessages] = c10::to_string(coalescedMessages_.load());
+  }
   if (isGILProfilingEnabled()) {
     // Add time-series based metrics, just GIL wait times for now.
     {
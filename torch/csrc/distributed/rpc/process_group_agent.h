@@ -2,10 +2,12 @@
 
 #include <c10/core/thread_pool.h>
 #include <c10d/ProcessGroup.hpp>
+#include <torch/csrc/distributed/rpc/metrics/RpcMetricsHandler.h>
 #include <torch/csrc/distributed/rpc/request_callback.h>
 #include <torch/csrc/distributed/rpc/rpc_agent.h>
 
 #include <atomic>
+#include <deque>
 #include <thread>
 
 namespace torch {
@@ -29,6 +31,23 @@ struct ProcessGroupRpcBackendOptions : public RpcBackendOptions {
   }
 
   int numSendRecvThreads;
+  // The messages to the same destination are coalesced into writes of up to
+  // this many bytes. 0 disables the coalescing.
+  int64_t maxCoalescedBytes = 0;
+  // How long the first message of a coalesced write waits for others. With
+  // 0, a write only coalesces the messages queued while the previous write
+  // to the same destination was in flight.
+  std::chrono::microseconds coalescingWindow{0};
+  // The name of the RpcMetricsHandler the send queue metrics are logged
+  // to, empty for none.
+  std::string metricsHandler;
+};
+
+// How the ProcessGroupAgent coalesces the messages to a destination, see
+// ProcessGroupRpcBackendOptions.
+struct CoalescingOptions {
+  int64_t maxBytes = 0;
+  std::chrono::microseconds window{0};
 };
 
 // SendWork and RecvWork will be put into a task queue, and later picked up by
@@ -64,7 +83,9 @@ class TORCH_API ProcessGroupAgent : public RpcAgent {
       std::shared_ptr<c10d::ProcessGroup> pg,
       int numSendRecvThreads,
       std::chrono::milliseconds rpcTimeout,
-      std::unique_ptr<RequestCallback> cb);
+      std::unique_ptr<RequestCallback> cb,
+      CoalescingOptions coalescingOptions = CoalescingOptions(),
+      const std::string& metricsHandler = "");
 
   const WorkerInfo& getWorkerInfo(const std::string& workerName) const override;
 
@@ -146,11 +167,40 @@ class TORCH_API ProcessGroupAgent : public RpcAgent {
     FutureInfo() = delete;
   };
 
+  // A serialized message waiting in the send queue of its destination.
+  struct QueuedMessage {
+    MessageType type;
+    int64_t id;
+    bool isRequest;
+    std::string data;
+  };
+
+  // The messages to a destination that wait for a coalesced write. A single
+  // thread at a time, the one that queued the first of them, sends them.
+  struct SendQueue {
+    std::mutex mutex;
+    std::deque<QueuedMessage> messages;
+    size_t bytes = 0;
+    bool flushing = false;
+  };
+
   void collectNames();
   // handle a SendWork request. This serializes the payload inside the work
   // object, and sends the message to the receiver using the underlying
   // ProcessGroup.
   void handleSend(const SendWork& work);
+  // Sends a serialized payload to `dst` with the given preamble.
+  void sendPayload(
+      worker_id_t dst,
+      MessageType type,
+      int64_t id,
+      std::string&& serializedPayload);
+  // Queues a serialized message to `dst`, and sends the queue unless
+  // another thread is already sending it.
+  void coalesceSend(worker_id_t dst, QueuedMessage&& message);
+  // Sends the messages of the queue of `dst` in coalesced writes until it
+  // is empty.
+  void flushSendQueue(worker_id_t dst);
   // put RecvWork into a queue and notify the worker thread
   void enqueueRecv(RecvWork work);
   // handle a RecvWork request. Return true if we should increment recvCounts,
@@ -280,6 +330,14 @@ class TORCH_API ProcessGroupAgent : public RpcAgent {
   std::atomic<int32_t> clientActiveCalls_{0};
   std::atomic<int32_t> serverActiveCalls_{0};
   std::atomic<int32_t> serverActiveAsyncCalls_{0};
+
+  const CoalescingOptions coalescingOptions_;
+  // One send queue per ProcessGroup rank, only used with coalescing.
+  std::vector<SendQueue> sendQueues_;
+  std::atomic<int64_t> coalescedWrites_{0};
+  std::atomic<int64_t> coalescedMessages_{0};
+  // The handler the send queue metrics are logged to, if any.
+  std::unique_ptr<RpcMetricsHandler> metricsHandler_;
 };
 
 } // namespace rpc
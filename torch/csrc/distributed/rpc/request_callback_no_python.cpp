@@ -362,6 +362,38 @@ void RequestCallbackNoPython::processRpc(
       markComplete(RRefAck().toMessage());
       return;
     }
+    case MessageType::RREF_BATCHED_REQUEST: {
+      auto& rbr = static_cast<RRefBatchedRequest&>(rpc);
+      auto& ctx = RRefContext::getInstance();
+      // Handle the entries in the order the sender queued them, which keeps
+      // a fork request ahead of a later delete of the same fork.
+      for (const auto& entry : rbr.entries()) {
+        switch (entry.type) {
+          case MessageType::RREF_USER_DELETE: {
+            auto deletedRRef = ctx.delForkOfOwner(entry.rrefId, entry.forkId);
+            handleRRefDelete(deletedRRef);
+            break;
+          }
+          case MessageType::RREF_CHILD_ACCEPT: {
+            ctx.delPendingChild(entry.forkId);
+            break;
+          }
+          case MessageType::RREF_FORK_REQUEST: {
+            ctx.addForkOfOwnerIfNotPresent(entry.rrefId, entry.forkId);
+            break;
+          }
+          default: {
+            TORCH_INTERNAL_ASSERT(
+                false,
+                "Unexpected message type ",
+                entry.type,
+                " in a batched RRef request.");
+          }
+        }
+      }
+      markComplete(RRefAck().toMessage());
+      return;
+    }
     case MessageType::FORWARD_AUTOGRAD_REQ: {
       auto& rpcWithAutograd = static_cast<RpcWithAutograd&>(rpc);
 
@@ -435,36 +467,43 @@ void RequestCallbackNoPython::processRpc(
     }
     case MessageType::BACKWARD_AUTOGRAD_REQ: {
       auto& gradientsCall = static_cast<PropagateGradientsReq&>(rpc);
-      const auto& autogradMetadata = gradientsCall.getAutogradMetadata();
-
-      // Retrieve the appropriate autograd context.
-      auto autogradContext =
-          DistAutogradContainer::getInstance().retrieveContext(
-              autogradMetadata.autogradContextId);
-
-      // Lookup the appropriate 'send' function to enqueue.
-      std::shared_ptr<SendRpcBackward> sendFunction =
-          autogradContext->retrieveSendFunction(
-              autogradMetadata.autogradMessageId);
-
-      // Attach the gradients to the send function.
-      sendFunction->setGrads(gradientsCall.getGrads());
-
-      // Now execute the autograd graph using the "distributed engine."
-      auto execFuture = DistEngine::getInstance().executeSendFunctionAsync(
-          autogradContext, sendFunction, gradientsCall.retainGraph());
-
-      // Our response is satisfied when the rpcs come back.
-      execFuture->addCallback(
-          [responseFuture, messageId](const FutureMessage& execFuture) {
-            if (!execFuture.hasError()) {
-              Message m = std::move(PropagateGradientsResp()).toMessage();
-              m.setId(messageId);
-              responseFuture->markCompleted(std::move(m));
-            } else {
-              responseFuture->setError(*(execFuture.error()));
-            }
-          });
+      const auto& entries = gradientsCall.getEntries();
+
+      // Our response is satisfied once the graph has been executed for every
+      // 'send' function of the request.
+      auto numPending = std::make_shared<std::atomic<size_t>>(entries.size());
+      for (const auto& entry : entries) {
+        const auto& autogradMetadata = entry.autogradMetadata;
+
+        // Retrieve the appropriate autograd context.
+        auto autogradContext =
+            DistAutogradContainer::getInstance().retrieveContext(
+                autogradMetadata.autogradContextId);
+
+        // Lookup the appropriate 'send' function to enqueue.
+        std::shared_ptr<SendRpcBackward> sendFunction =
+            autogradContext->retrieveSendFunction(
+                autogradMetadata.autogradMessageId);
+
+        // Attach the gradients to the send function.
+        sendFunction->setGrads(entry.grads);
+
+        // Now execute the autograd graph using the "distributed engine."
+        auto execFuture = DistEngine::getInstance().executeSendFunctionAsync(
+            autogradContext, sendFunction, gradientsCall.retainGraph());
+
+        // Our response is satisfied when the rpcs come back.
+        execFuture->addCallback([responseFuture, messageId, numPending](
+                                    const FutureMessage& execFuture) {
+          if (execFuture.hasError()) {
+            responseFuture->setErrorIfNeeded(*(execFuture.error()));
+          } else if (--*numPending == 0) {
+            Message m = std::move(PropagateGradientsResp()).toMessage();
+            m.setId(messageId);
+            responseFuture->markCompletedIfNeeded(std::move(m));
+          }
+        });
+      }
       return;
     };
     case MessageType::CLEANUP_AUTOGRAD_CONTEXT_REQ: {
@@ -75,6 +75,27 @@ const std::string kNumOwnerRRefs = "num_owner_rrefs";
 const std::string kNumPendingFutures = "num_pending_futures";
 const std::string kNumPendingUsers = "num_pending_users";
 const std::string kNumForks = "num_forks";
+const std::string kNumPendingChildren = "num_pending_children";
+const std::string kNumBatchedControlWrites = "num_batched_control_writes";
+const std::string kNumBatchedControlMessages = "num_batched_control_messages";
+
+namespace {
+
+Message toControlMessage(const RRefBatchedRequest::Entry& entry) {
+  switch (entry.type) {
+    case MessageType::RREF_USER_DELETE:
+      return RRefUserDelete(entry.rrefId, entry.forkId).toMessage();
+    case MessageType::RREF_FORK_REQUEST:
+      return RRefForkRequest(entry.rrefId, entry.forkId).toMessage();
+    case MessageType::RREF_CHILD_ACCEPT:
+      return RRefChildAccept(entry.forkId).toMessage();
+    default:
+      TORCH_INTERNAL_ASSERT(
+          false, "Unexpected RRef control message type ", entry.type);
+  }
+}
+
+} // namespace
 
 RRefContext& RRefContext::getInstance() {
   // Leaky singleton to avoid module destructor races.
@@ -89,6 +110,9 @@ std::vector<c10::intrusive_ptr<RRef>> RRefContext::destroyInstance(
     std::lock_guard<std::mutex> lock(ctx.destroyedMutex_);
     ctx.destroyed_ = true;
   }
+  // The agent may already be shut down, so, as delUser does after this
+  // point, drop the messages instead of sending them.
+  ctx.stopControlMessageBatching(/* flush */ false);
   ctx.checkRRefLeaks(ignoreRRefLeak);
   std::vector<c10::intrusive_ptr<RRef>> deletedRRefs;
   for (auto& entry : ctx.owners_) {
@@ -125,6 +149,7 @@ std::unordered_map<std::string, std::string> RRefContext::getDebugInfo() {
   std::unique_lock<std::mutex> lock(mutex_);
   auto ownerSize = owners_.size();
   auto numPendingUsers = pendingUsers_.size();
+  auto numPendingChildren = pendingChildren_.size();
   int numForks = 0;
   for (const auto& owner : forks_) {
     numForks += owner.second.size();
@@ -134,9 +159,170 @@ std::unordered_map<std::string, std::string> RRefContext::getDebugInfo() {
   info[kNumPendingFutures] = c10::to_string(numPendingFutures_.load());
   info[kNumPendingUsers] = c10::to_string(numPendingUsers);
   info[kNumForks] = c10::to_string(numForks);
+  info[kNumPendingChildren] = c10::to_string(numPendingChildren);
+  info[kNumBatchedControlWrites] =
+      c10::to_string(numBatchedControlWrites_.load());
+  info[kNumBatchedControlMessages] =
+      c10::to_string(numBatchedControlMessages_.load());
   return info;
 }
 
+void RRefContext::setControlMessageBatching(
+    std::chrono::milliseconds interval) {
+  TORCH_CHECK(
+      interval.count() >= 0,
+      "The RRef control message batching interval must not be negative, got ",
+      interval.count(),
+      "ms.");
+  std::lock_guard<std::mutex> guard(controlMessageBatchingMutex_);
+  if (interval.count() == 0) {
+    stopControlMessageBatching(/* flush */ true);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(controlMessagesMutex_);
+    controlMessageBatchingInterval_ = interval;
+    if (!controlMessageFlusher_.joinable()) {
+      controlMessageFlusher_ =
+          std::thread(&RRefContext::controlMessageFlushLoop, this);
+    }
+  }
+  // Wake the flusher up to pick up the new interval.
+  controlMessagesCV_.notify_all();
+}
+
+void RRefContext::setMetricsHandler(const std::string& handlerName) {
+  std::shared_ptr<RpcMetricsHandler> handler;
+  if (!handlerName.empty()) {
+    handler = RpcMetricsHandlerRegistry()->Create(handlerName);
+    TORCH_CHECK(handler, "Unknown RPC metrics handler ", handlerName);
+  }
+  std::lock_guard<std::mutex> lock(controlMessagesMutex_);
+  metricsHandler_ = std::move(handler);
+}
+
+void RRefContext::sendControlMessage(
+    worker_id_t dst,
+    RRefBatchedRequest::Entry entry,
+    std::function<void(const FutureMessage&)> callback) {
+  std::vector<ControlMessage> messages;
+  {
+    std::lock_guard<std::mutex> lock(controlMessagesMutex_);
+    if (controlMessageBatchingInterval_.count() > 0) {
+      heldControlMessages_[dst].push_back({entry, std::move(callback)});
+      return;
+    }
+  }
+  messages.push_back({entry, std::move(callback)});
+  sendControlMessages(dst, std::move(messages));
+}
+
+void RRefContext::sendControlMessages(
+    worker_id_t dst,
+    std::vector<ControlMessage> messages) {
+  const auto& dstInfo = agent_->getWorkerInfo(dst);
+  std::shared_ptr<FutureMessage> fm;
+  if (messages.size() == 1) {
+    fm = agent_->sendWithRetries(dstInfo, toControlMessage(messages[0].entry));
+  } else {
+    std::vector<RRefBatchedRequest::Entry> entries;
+    entries.reserve(messages.size());
+    for (const auto& message : messages) {
+      entries.push_back(message.entry);
+    }
+    fm = agent_->sendWithRetries(
+        dstInfo, RRefBatchedRequest(std::move(entries)).toMessage());
+    ++numBatchedControlWrites_;
+    numBatchedControlMessages_ += messages.size();
+  }
+
+  std::shared_ptr<RpcMetricsHandler> metricsHandler;
+  {
+    std::lock_guard<std::mutex> lock(controlMessagesMutex_);
+    metricsHandler = metricsHandler_;
+  }
+  if (metricsHandler) {
+    size_t numPendingUsers, numPendingChildren;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      numPendingUsers = pendingUsers_.size();
+      numPendingChildren = pendingChildren_.size();
+    }
+    const auto prefix = c10::str(kRpcMetricsKeyPrefix, "rref.");
+    metricsHandler->accumulateMetric(prefix + "pending_users", numPendingUsers);
+    metricsHandler->accumulateMetric(
+        prefix + "pending_children", numPendingChildren);
+    const auto writePrefix =
+        c10::str(prefix, "control_messages.", dstInfo.name_);
+    metricsHandler->incrementMetric(writePrefix + ".writes");
+    metricsHandler->accumulateMetric(
+        writePrefix + ".messages_per_write", messages.size());
+  }
+
+  // The single RREF_ACK acknowledges every message of the batch. Run all the
+  // callbacks even if one throws, which they do on errors, so that none of
+  // them leaves its RRef behind.
+  fm->addCallback([messages = std::move(messages)](const FutureMessage& fm) {
+    std::exception_ptr eptr;
+    for (const auto& message : messages) {
+      try {
+        message.callback(fm);
+      } catch (...) {
+        if (!eptr) {
+          eptr = std::current_exception();
+        }
+      }
+    }
+    if (eptr) {
+      std::rethrow_exception(eptr);
+    }
+  });
+}
+
+void RRefContext::flushControlMessages() {
+  std::unordered_map<worker_id_t, std::vector<ControlMessage>> held;
+  {
+    std::lock_guard<std::mutex> lock(controlMessagesMutex_);
+    held.swap(heldControlMessages_);
+  }
+  for (auto& messages : held) {
+    sendControlMessages(messages.first, std::move(messages.second));
+  }
+}
+
+void RRefContext::controlMessageFlushLoop() {
+  std::unique_lock<std::mutex> lock(controlMessagesMutex_);
+  while (controlMessageBatchingInterval_.count() > 0) {
+    controlMessagesCV_.wait_for(lock, controlMessageBatchingInterval_);
+    lock.unlock();
+    try {
+      flushControlMessages();
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "Failed to send RRef control messages: " << e.what();
+    }
+    lock.lock();
+  }
+}
+
+void RRefContext::stopControlMessageBatching(bool flush) {
+  std::thread flusher;
+  {
+    std::lock_guard<std::mutex> lock(controlMessagesMutex_);
+    controlMessageBatchingInterval_ = std::chrono::milliseconds(0);
+    flusher = std::move(controlMessageFlusher_);
+  }
+  controlMessagesCV_.notify_all();
+  if (flusher.joinable()) {
+    flusher.join();
+  }
+  if (flush) {
+    flushControlMessages();
+  } else {
+    std::lock_guard<std::mutex> lock(controlMessagesMutex_);
+    heldControlMessages_.clear();
+  }
+}
+
 void RRefContext::checkRRefLeaks(bool ignoreRRefLeak) {
   if (!forks_.empty()) {
     std::stringstream ss;
@@ -209,14 +395,13 @@ void RRefContext::delUser(
       // which is now idempotent. See the comment at RRefContext::delForkOfOwner
       // for more details.
       ++numPendingFutures_;
-      auto fm = agent_->sendWithRetries(
-          agent_->getWorkerInfo(owner),
-          RRefUserDelete(rrefId, forkId).toMessage());
-
-      fm->addCallback([this](const FutureMessage& fm) {
-        handleException(fm);
-        --numPendingFutures_;
-      });
+      sendControlMessage(
+          owner,
+          {MessageType::RREF_USER_DELETE, rrefId, forkId},
+          [this](const FutureMessage& fm) {
+            handleException(fm);
+            --numPendingFutures_;
+          });
     }
   }
 
@@ -255,6 +440,8 @@ void RRefContext::delAllUsersAndUnforkedOwners(
     // tryDel() below will re-acquire lock, lock must be released here.
     rref_ptr->tryDel();
   }
+  // Do not wait for the flusher to send the delete messages.
+  flushControlMessages();
 
   // If an rref in the owners_ map has never been forked, we will never get a
   // corresponding message from the forking node(s) telling us to delete the
@@ -483,26 +670,29 @@ void RRefContext::notifyOwnerAndParentOfFork(
     // into forks_. Because, there will be no real `UserRRef` associated
     // with this fork ID.
     ++numPendingFutures_;
-    auto fm = agent_->sendWithRetries(
-        agent_->getWorkerInfo(parent), RRefChildAccept(forkId).toMessage());
-    fm->addCallback([this](const FutureMessage& fm) {
-      handleException(fm);
-      --numPendingFutures_;
-    });
+    sendControlMessage(
+        parent,
+        {MessageType::RREF_CHILD_ACCEPT, forkId, forkId},
+        [this](const FutureMessage& fm) {
+          handleException(fm);
+          --numPendingFutures_;
+        });
   } else {
     ++numPendingFutures_;
-    auto fm = agent_->sendWithRetries(
-        agent_->getWorkerInfo(rref->owner()),
-        RRefForkRequest(rref->rrefId(), forkId).toMessage());
-
+    // Add the pending user first, as the callback may run as soon as the
+    // message is sent.
     addPendingUser(forkId, rref);
-    fm->addCallback([this, forkId, parent](const FutureMessage& fm) {
-      handleException(fm);
-      this->finishForkRequest(forkId, parent);
-      // Decrease after calling finishForkRequest because, as that creates a new
-      // future, it might otherwise cause the count to briefly go to zero.
-      --numPendingFutures_;
-    });
+    sendControlMessage(
+        rref->owner(),
+        {MessageType::RREF_FORK_REQUEST, rref->rrefId(), forkId},
+        [this, forkId, parent](const FutureMessage& fm) {
+          handleException(fm);
+          this->finishForkRequest(forkId, parent);
+          // Decrease after calling finishForkRequest because, as that creates
+          // a new future, it might otherwise cause the count to briefly go to
+          // zero.
+          --numPendingFutures_;
+        });
   }
 }
 
@@ -676,13 +866,13 @@ void RRefContext::clearRecordedPendingRRefsOnError() {
 void RRefContext::finishForkRequest(const ForkId& forkId, worker_id_t parent) {
   delPendingUser(forkId);
   ++numPendingFutures_;
-  auto fm = agent_->sendWithRetries(
-      agent_->getWorkerInfo(parent), RRefChildAccept(forkId).toMessage());
-
-  fm->addCallback([this](const FutureMessage& fm) {
-    handleException(fm);
-    --numPendingFutures_;
-  });
+  sendControlMessage(
+      parent,
+      {MessageType::RREF_CHILD_ACCEPT, forkId, forkId},
+      [this](const FutureMessage& fm) {
+        handleException(fm);
+        --numPendingFutures_;
+      });
 }
 
 void RRefContext::addSelfAsFork(c10::intrusive_ptr<OwnerRRef>& rref) {
@@ -2,13 +2,16 @@
 
 #include <c10/util/Optional.h>
 #include <torch/csrc/distributed/rpc/message.h>
+#include <torch/csrc/distributed/rpc/metrics/RpcMetricsHandler.h>
 #include <torch/csrc/distributed/rpc/rpc_agent.h>
 #include <torch/csrc/distributed/rpc/rref_impl.h>
+#include <torch/csrc/distributed/rpc/rref_proto.h>
 #include <torch/csrc/distributed/rpc/types.h>
 #include <torch/csrc/distributed/rpc/utils.h>
 #include <torch/csrc/utils/future.h>
 
 #include <atomic>
+#include <thread>
 
 namespace torch {
 namespace distributed {
@@ -207,9 +210,30 @@ class TORCH_API RRefContext {
       const ForkId& forkId);
   void delAllUsersAndUnforkedOwners(std::chrono::milliseconds timeoutMillis);
 
+  // Hold the RREF_USER_DELETE, RREF_FORK_REQUEST and RREF_CHILD_ACCEPT
+  // messages to each worker for up to ``interval`` and send them as a single
+  // RREF_BATCHED_REQUEST, which the receiver answers with a single RREF_ACK.
+  // Programs that share many RRefs, e.g., passing them as arguments in a
+  // loop, otherwise pay a round trip per fork and per deletion. A zero
+  // interval, the default, sends every message as soon as it is created and
+  // flushes the messages already held.
+  void setControlMessageBatching(std::chrono::milliseconds interval);
+  // Log the number of pending UserRRefs and children and the size of the
+  // control message writes to the RpcMetricsHandler registered under
+  // ``handlerName``, under the kRpcMetricsKeyPrefix + "rref." keys. An empty
+  // name stops logging.
+  void setMetricsHandler(const std::string& handlerName);
+
   std::unordered_map<std::string, std::string> getDebugInfo();
 
  private:
+  // An RREF_USER_DELETE, RREF_FORK_REQUEST or RREF_CHILD_ACCEPT message and
+  // the callback to run on its RREF_ACK.
+  struct ControlMessage {
+    RRefBatchedRequest::Entry entry;
+    std::function<void(const FutureMessage&)> callback;
+  };
+
   struct PendingUserState {
     PendingUserState(c10::intrusive_ptr<RRef> rref) : rref_(std::move(rref)) {}
 
@@ -234,6 +258,21 @@ class TORCH_API RRefContext {
 
   void finishForkRequest(const ForkId& forkId, worker_id_t parent);
 
+  // Send the message to ``dst``, or hold it for the next batch to ``dst`` if
+  // control message batching is enabled.
+  void sendControlMessage(
+      worker_id_t dst,
+      RRefBatchedRequest::Entry entry,
+      std::function<void(const FutureMessage&)> callback);
+  void sendControlMessages(
+      worker_id_t dst,
+      std::vector<ControlMessage> messages);
+  // Send the messages held for all workers.
+  void flushControlMessages();
+  void controlMessageFlushLoop();
+  // Join the flusher thread and then flush or drop the held messages.
+  void stopControlMessageBatching(bool flush);
+
   // If there is any leak on any RRef, this method will throw an error.
   void checkRRefLeaks(bool ignoreRRefLeak);
 
@@ -304,6 +343,20 @@ class TORCH_API RRefContext {
   std::mutex destroyedMutex_;
   bool destroyed_;
 
+  // Serializes setControlMessageBatching() calls, so that at most one flusher
+  // thread runs.
+  std::mutex controlMessageBatchingMutex_;
+  // Guards the fields below.
+  std::mutex controlMessagesMutex_;
+  std::condition_variable controlMessagesCV_;
+  std::chrono::milliseconds controlMessageBatchingInterval_{0};
+  std::unordered_map<worker_id_t, std::vector<ControlMessage>>
+      heldControlMessages_;
+  std::thread controlMessageFlusher_;
+  std::shared_ptr<RpcMetricsHandler> metricsHandler_;
+  std::atomic<int64_t> numBatchedControlWrites_{0};
+  std::atomic<int64_t> numBatchedControlMessages_{0};
+
   // Thread local states to keep UserRRefs deserialized from user function
   // arguments.
   static thread_local std::vector<std::shared_ptr<PendingUserState>> userTable_;
@@ -25,6 +25,34 @@ std::string getTypeStr(const c10::TypePtr& type) {
       return type->annotation_str();
   }
 }
+
+// Whether values of the type can be changed after they are set on the owner.
+// Tensors, lists, dicts and objects can be mutated in place, so a copy fetched
+// by to_here() may go stale.
+bool isImmutableType(const c10::TypePtr& type) {
+  switch (type->kind()) {
+    case c10::TypeKind::IntType:
+    case c10::TypeKind::FloatType:
+    case c10::TypeKind::BoolType:
+    case c10::TypeKind::NumberType:
+    case c10::TypeKind::StringType:
+    case c10::TypeKind::NoneType:
+    case c10::TypeKind::DeviceObjType:
+      return true;
+    case c10::TypeKind::OptionalType:
+      return isImmutableType(
+          type->expect<c10::OptionalType>()->getElementType());
+    case c10::TypeKind::TupleType:
+      for (const auto& elementType : type->containedTypes()) {
+        if (!isImmutableType(elementType)) {
+          return false;
+        }
+      }
+      return true;
+    default:
+      return false;
+  }
+}
 } // namespace
 
 namespace torch {
@@ -135,6 +163,14 @@ IValue UserRRef::toHere(const float timeoutSeconds) const {
       !deletedOnOwner_,
       *this,
       " has been deleted. Cannot call to_here() on it after deletion.");
+  // Python objects are opaque here, so only script values are cached.
+  const bool cacheable = !isPyObj() && isImmutableType(type_);
+  if (cacheable) {
+    std::lock_guard<std::mutex> lock(cachedValueMutex_);
+    if (cachedValue_) {
+      return *cachedValue_;
+    }
+  }
   auto toHereKey = std::string("");
   if (torch::autograd::profiler::profilerEnabled()) {
     toHereKey = fmt::format(
@@ -195,7 +231,12 @@ IValue UserRRef::toHere(const float timeoutSeconds) const {
     // made the C++ toHere interface to return single IValue
     return ivalue::Tuple::create(rrefFetchRet.values());
   } else {
-    return rrefFetchRet.values().front();
+    auto value = rrefFetchRet.values().front();
+    if (cacheable) {
+      std::lock_guard<std::mutex> lock(cachedValueMutex_);
+      cachedValue_ = value;
+    }
+    return value;
   }
 }
 
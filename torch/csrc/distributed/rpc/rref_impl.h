@@ -304,7 +304,8 @@ class TORCH_API UserRRef final : public RRef {
   const ForkId& forkId() const;
 
   // Get of copy of the value from the ``OwnerRRef``. If the value is not ready
-  // yet, this call will block.
+  // yet, this call will block. Values of immutable types, which the owner
+  // can neither rebind nor mutate, are only fetched once.
   IValue toHere(
       const float timeoutSeconds =
           torch::distributed::rpc::kUnsetRpcTimeout) const;
@@ -339,6 +340,11 @@ class TORCH_API UserRRef final : public RRef {
   bool deletedOnOwner_{false};
   // Indicating whether this UserRRef has been confirmed by its owner.
   std::atomic<bool> confirmedByOwner_;
+
+  // The value of the first successful toHere() call, if the type is
+  // immutable.
+  mutable std::mutex cachedValueMutex_;
+  mutable c10::optional<IValue> cachedValue_;
 };
 
 // Keep the template only on the derived class because ``RRefContext`` needs to
@@ -189,6 +189,39 @@ std::unique_ptr<RRefForkRequest> RRefForkRequest::fromMessage(
   return std::make_unique<RRefForkRequest>(pair.first, pair.second);
 }
 
+const std::vector<RRefBatchedRequest::Entry>& RRefBatchedRequest::entries()
+    const {
+  return entries_;
+}
+
+Message RRefBatchedRequest::toMessageImpl() && {
+  std::vector<IValue> ivalues;
+  ivalues.reserve(entries_.size() * 3);
+  for (const auto& entry : entries_) {
+    ivalues.emplace_back(static_cast<int64_t>(entry.type));
+    ivalues.emplace_back(entry.rrefId.toIValue());
+    ivalues.emplace_back(entry.forkId.toIValue());
+  }
+  return fromIValues(std::move(ivalues), MessageType::RREF_BATCHED_REQUEST);
+}
+
+std::unique_ptr<RRefBatchedRequest> RRefBatchedRequest::fromMessage(
+    const Message& message) {
+  auto values = toIValues(message, MessageType::RREF_BATCHED_REQUEST);
+  TORCH_INTERNAL_ASSERT(
+      values.size() % 3 == 0, "Expect 3 IValues per batched RRef message.");
+
+  std::vector<Entry> entries;
+  entries.reserve(values.size() / 3);
+  for (size_t i = 0; i < values.size(); i += 3) {
+    entries.push_back(
+        {static_cast<MessageType>(values[i].toInt()),
+         RRefId::fromIValue(values[i + 1]),
+         ForkId::fromIValue(values[i + 2])});
+  }
+  return std::make_unique<RRefBatchedRequest>(std::move(entries));
+}
+
 Message RRefAck::toMessageImpl() && {
   return Message({}, {}, MessageType::RREF_ACK);
 }
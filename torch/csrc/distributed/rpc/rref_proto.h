@@ -155,6 +155,31 @@ class TORCH_API RRefForkRequest final : public ForkMessageBase {
   static std::unique_ptr<RRefForkRequest> fromMessage(const Message& message);
 };
 
+// Carries several RREF_USER_DELETE, RREF_FORK_REQUEST and RREF_CHILD_ACCEPT
+// messages to the same worker, which handles them in order and replies with a
+// single RRefAck. See RRefContext::setControlMessageBatching.
+class TORCH_API RRefBatchedRequest final : public RpcCommandBase {
+ public:
+  struct Entry {
+    MessageType type;
+    // Unused for RREF_CHILD_ACCEPT.
+    RRefId rrefId;
+    ForkId forkId;
+  };
+
+  explicit RRefBatchedRequest(std::vector<Entry> entries)
+      : entries_(std::move(entries)) {}
+
+  const std::vector<Entry>& entries() const;
+
+  Message toMessageImpl() && override;
+  static std::unique_ptr<RRefBatchedRequest> fromMessage(
+      const Message& message);
+
+ private:
+  const std::vector<Entry> entries_;
+};
+
 class TORCH_API RRefAck final : public RpcCommandBase {
  public:
   RRefAck() {}
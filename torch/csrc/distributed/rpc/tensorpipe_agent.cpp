@@ -4,6 +4,7 @@
 
 #include <limits>
 
+#include <c10/core/thread_budget.h>
 #include <fmt/format.h>
 #include <tensorpipe/tensorpipe.h>
 
@@ -274,7 +275,9 @@ TensorPipeAgent::TensorPipeAgent(
           std::chrono::milliseconds(
               (long)(opts.rpcTimeoutSeconds * kToMilliseconds))),
       opts_(std::move(opts)),
-      threadPool_(opts_.numWorkerThreads),
+      threadPool_(c10::ThreadBudget::global().acquire(
+          c10::ThreadPoolKind::Distributed,
+          opts_.numWorkerThreads)),
       context_(std::make_shared<tensorpipe::Context>(
           tensorpipe::ContextOptions().name(workerInfo_.name_))),
       rankToNameStore_("names", store),
@@ -290,6 +293,8 @@ TensorPipeAgent::TensorPipeAgent(
 TensorPipeAgent::~TensorPipeAgent() {
   VLOG(1) << "RPC agent for " << workerInfo_.name_ << " is being destroyed";
   shutdown();
+  c10::ThreadBudget::global().release(
+      c10::ThreadPoolKind::Distributed, threadPool_.size());
 }
 
 void TensorPipeAgent::startImpl() {
@@ -22,6 +22,7 @@
 #include <torch/csrc/jit/serialization/unpickler.h>
 
 #ifdef USE_TENSORPIPE
+#include <ATen/detail/CUDAHooksInterface.h>
 #include <tensorpipe/core/message.h>
 #endif
 
@@ -134,6 +135,9 @@ std::unique_ptr<RpcCommandBase> deserializeRequest(const Message& request) {
     case MessageType::RREF_FORK_REQUEST: {
       return RRefForkRequest::fromMessage(request);
     }
+    case MessageType::RREF_BATCHED_REQUEST: {
+      return RRefBatchedRequest::fromMessage(request);
+    }
     case MessageType::FORWARD_AUTOGRAD_REQ: {
       return autograd::RpcWithAutograd::fromMessage(request);
     }
@@ -313,6 +317,109 @@ parseWireSections(const void* data, size_t data_size) {
 
 static const char* kMeta = "meta";
 static const char* kPayload = "payload";
+
+// The compact format, for the messages whose tensors are all dense,
+// contiguous CPU tensors, which don't need the pickler:
+//    \0
+//    payload size | payload
+//    number of tensors
+//    for every tensor: dtype | requires_grad | ndim | sizes | data
+// The sizes are written in the native byte order, like the data of the
+// tensors in both formats. The first byte can't start the header of the
+// format above, whose section names are never empty.
+constexpr char kCompactWireMagic = '\0';
+
+bool canSerializeCompact(const std::vector<at::Tensor>& tensors) {
+  return std::all_of(
+      tensors.begin(), tensors.end(), [](const at::Tensor& tensor) {
+        return tensor.device().is_cpu() && tensor.layout() == at::kStrided &&
+            !tensor.is_quantized() && !tensor.has_names() &&
+            tensor.is_contiguous();
+      });
+}
+
+template <typename T>
+void appendValue(std::string& out, T value) {
+  out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T readValue(const char*& ptr, const char* endp) {
+  if (endp - ptr < static_cast<ptrdiff_t>(sizeof(T))) {
+    throw std::runtime_error("failed bounds");
+  }
+  T value;
+  memcpy(&value, ptr, sizeof(T));
+  ptr += sizeof(T);
+  return value;
+}
+
+std::string wireSerializeCompact(
+    const std::vector<char>& payload,
+    const std::vector<at::Tensor>& tensors) {
+  size_t size = 1 + 2 * sizeof(uint64_t) + payload.size();
+  for (const auto& tensor : tensors) {
+    size += 3 + tensor.dim() * sizeof(int64_t) + tensor.nbytes();
+  }
+  std::string out;
+  out.reserve(size);
+  out.push_back(kCompactWireMagic);
+  appendValue<uint64_t>(out, payload.size());
+  out.append(payload.data(), payload.size());
+  appendValue<uint64_t>(out, tensors.size());
+  for (const auto& tensor : tensors) {
+    appendValue<int8_t>(out, static_cast<int8_t>(tensor.scalar_type()));
+    appendValue<uint8_t>(out, tensor.requires_grad());
+    appendValue<uint8_t>(out, tensor.dim());
+    for (auto dimSize : tensor.sizes()) {
+      appendValue<int64_t>(out, dimSize);
+    }
+    if (tensor.nbytes() > 0) {
+      out.append(static_cast<const char*>(tensor.data_ptr()), tensor.nbytes());
+    }
+  }
+  return out;
+}
+
+std::pair<std::vector<char>, std::vector<at::Tensor>> wireDeserializeCompact(
+    const char* ptr,
+    const char* endp) {
+  ++ptr; // past the magic byte
+  auto payloadSize = readValue<uint64_t>(ptr, endp);
+  if (static_cast<uint64_t>(endp - ptr) < payloadSize) {
+    throw std::runtime_error("failed bounds");
+  }
+  std::vector<char> payload(ptr, ptr + payloadSize);
+  ptr += payloadSize;
+
+  auto numTensors = readValue<uint64_t>(ptr, endp);
+  std::vector<at::Tensor> tensors;
+  tensors.reserve(numTensors);
+  for (uint64_t i = 0; i < numTensors; ++i) {
+    auto dtype = static_cast<at::ScalarType>(readValue<int8_t>(ptr, endp));
+    bool requiresGrad = readValue<uint8_t>(ptr, endp);
+    std::vector<int64_t> sizes(readValue<uint8_t>(ptr, endp));
+    for (auto& dimSize : sizes) {
+      dimSize = readValue<int64_t>(ptr, endp);
+    }
+    auto tensor = at::empty(sizes, at::TensorOptions().dtype(dtype));
+    if (static_cast<size_t>(endp - ptr) < tensor.nbytes()) {
+      throw std::runtime_error("failed bounds");
+    }
+    if (tensor.nbytes() > 0) {
+      memcpy(tensor.data_ptr(), ptr, tensor.nbytes());
+      ptr += tensor.nbytes();
+    }
+    if (requiresGrad) {
+      tensor.set_requires_grad(true);
+    }
+    tensors.push_back(std::move(tensor));
+  }
+  if (ptr != endp) {
+    throw std::runtime_error("failed bounds");
+  }
+  return {std::move(payload), std::move(tensors)};
+}
 }; // namespace
 
 c10::List<at::Tensor> cloneSparseTensors(
@@ -351,6 +458,13 @@ std::string wireSerialize(
         tensor.device());
   }
 
+  // Messages of dense, contiguous tensors skip the pickler and the text
+  // header. Only the bytes of the tensors are sent, so the views that
+  // cloneSparseTensors would clone don't need to be.
+  if (canSerializeCompact(tensors)) {
+    return wireSerializeCompact(payload, tensors);
+  }
+
   struct Ent {
     std::string name;
     const char* data;
@@ -412,6 +526,10 @@ std::string wireSerialize(
 std::pair<std::vector<char>, std::vector<at::Tensor>> wireDeserialize(
     const void* data,
     size_t data_size) {
+  const char* ptr = static_cast<const char*>(data);
+  if (data_size > 0 && *ptr == kCompactWireMagic) {
+    return wireDeserializeCompact(ptr, ptr + data_size);
+  }
   auto sections = parseWireSections(data, data_size);
 
   std::vector<char> payload;
@@ -520,10 +638,33 @@ std::tuple<tensorpipe::Message, TensorpipeWriteBuffers> tensorpipeSerialize(
   if (buffers.deviceIndices.empty()) {
     buffers.tensors = cloneSparseTensors(rpcMessage.tensors()).vec();
   } else {
+    // The CUDA tensors are copied into pinned memory on the current streams
+    // of their devices, after the kernels that produced them. Only the copy
+    // of the last tensor of every device blocks, which waits for the copies
+    // of the others as its stream runs them in order.
+    const auto& rpcTensors = rpcMessage.tensors();
+    std::unordered_map<c10::DeviceIndex, size_t> lastTensorOfDevice;
+    for (size_t i = 0; i < rpcTensors.size(); ++i) {
+      if (rpcTensors[i].is_cuda()) {
+        lastTensorOfDevice[rpcTensors[i].device().index()] = i;
+      }
+    }
     std::vector<torch::Tensor> tensors;
-    tensors.reserve(rpcMessage.tensors().size());
-    for (const auto& tensor : rpcMessage.tensors()) {
-      tensors.emplace_back(tensor.cpu());
+    tensors.reserve(rpcTensors.size());
+    for (size_t i = 0; i < rpcTensors.size(); ++i) {
+      const auto& tensor = rpcTensors[i];
+      if (!tensor.is_cuda()) {
+        tensors.emplace_back(tensor);
+      } else if (tensor.is_sparse()) {
+        tensors.emplace_back(tensor.cpu());
+      } else {
+        auto pinned = at::empty(
+            tensor.sizes(),
+            tensor.options().device(at::kCPU).pinned_memory(true));
+        const bool last = lastTensorOfDevice[tensor.device().index()] == i;
+        pinned.copy_(tensor, /*non_blocking=*/!last);
+        tensors.emplace_back(std::move(pinned));
+      }
     }
     buffers.tensors = cloneSparseTensors(tensors).vec();
   }
@@ -612,8 +753,14 @@ TensorpipeReadBuffers tensorpipeAllocate(tensorpipe::Message& tpMessage) {
   buffers.pickle.resize(tpMessage.payloads[kTpMessagePickleIdx].length);
   tpMessage.payloads[kTpMessagePickleIdx].data = buffers.pickle.data();
 
+  // The tensors of a message with device indices are received in pinned
+  // memory, from which they are copied to their devices asynchronously.
+  at::Allocator* allocator = at::getCPUAllocator();
+  if (!buffers.deviceIndices.empty() && at::hasCUDA()) {
+    allocator = at::detail::getCUDAHooks().getPinnedMemoryAllocator();
+  }
   for (auto& tensor : tpMessage.tensors) {
-    buffers.tensors.push_back(at::getCPUAllocator()->allocate(tensor.length));
+    buffers.tensors.push_back(allocator->allocate(tensor.length));
     tensor.data = buffers.tensors.back().get();
   }
 
@@ -660,10 +807,16 @@ Message tensorpipeDeserialize(
         " tensors with ",
         buffers.deviceIndices.size(),
         " device indices.");
+    // The copies run on the current streams of the devices, after which the
+    // kernels that use the tensors are queued, so there is no need to wait
+    // for them. The pinned memory allocator doesn't reuse the buffers before
+    // the copies are done.
     for (size_t i = 0; i < tensors.size(); ++i) {
       auto index = buffers.deviceIndices[i];
       if (tensors[i].device().index() != index) {
-        tensors[i] = tensors[i].to(indexToDevice(index));
+        tensors[i] = tensors[i].to(
+            tensors[i].options().device(indexToDevice(index)),
+            /*non_blocking=*/true);
       }
     }
   }
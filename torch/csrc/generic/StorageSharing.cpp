@@ -15,6 +15,11 @@ static PyObject * THPStorage_(sharedDecref)(THPStorage *self, PyObject *noargs)
   if (ctx) {
     ctx->decref();
   }
+#ifndef _WIN32
+  if (THSharedArenaBlock *block = THSharedArenaBlock::fromDataPtr(storage->data_ptr())) {
+    block->decref();
+  }
+#endif
 #endif
   Py_INCREF(self);
   return (PyObject *)self;
@@ -30,6 +35,11 @@ static PyObject * THPStorage_(sharedIncref)(THPStorage *self, PyObject *noargs)
   if (ctx) {
     ctx->incref();
   }
+#ifndef _WIN32
+  if (THSharedArenaBlock *block = THSharedArenaBlock::fromDataPtr(storage->data_ptr())) {
+    block->incref();
+  }
+#endif
 #endif
   Py_RETURN_NONE;
   END_HANDLE_TH_ERRORS
@@ -212,6 +222,111 @@ static PyObject * THPStorage_(newSharedFd)(PyObject *_unused, PyObject *args)
   END_HANDLE_TH_ERRORS
 }
 
+#ifndef _WIN32
+static THWStorage* THPStorage_(newArenaStorage)(ptrdiff_t size, size_t arena_size)
+{
+  at::DataPtr data_ptr =
+      THSharedArena::forCurrentProcess(arena_size)->allocate(size * sizeof(scalar_t));
+  if (!data_ptr) {
+    return nullptr;
+  }
+  return THWStorage_(newWithDataAndAllocator)(std::move(data_ptr), size, /* allocator */ nullptr);
+}
+
+static PyObject * THPStorage_(pyNewArenaStorage)(PyObject *_unused, PyObject *args)
+{
+  HANDLE_TH_ERRORS
+  long long size;
+  unsigned long long arena_size;
+  if (!PyArg_ParseTuple(args, "LK", &size, &arena_size)) {
+    return nullptr;
+  }
+  THWStorage *storage = THPStorage_(newArenaStorage)(size, arena_size);
+  if (!storage) {
+    Py_RETURN_NONE;
+  }
+  return THPStorage_(New)(storage);
+  END_HANDLE_TH_ERRORS
+}
+
+// Moves the storage into the arena of the current process, unless it is in
+// shared memory already, and returns None if it is not in an arena or if the
+// arena is full.
+static PyObject * THPStorage_(shareArena)(THPStorage *self, PyObject *arg)
+{
+  HANDLE_TH_ERRORS
+  THPUtils_assert(THPUtils_checkLong(arg), "_share_arena_(): arena size must be an 'int'");
+  THWStorage *storage = self->cdata;
+  THSharedArenaBlock *block = THSharedArenaBlock::fromDataPtr(storage->data_ptr());
+  if (!block) {
+    if (THMapAllocator::fromDataPtr(storage->data_ptr()) ||
+        THManagedMapAllocator::fromDataPtr(storage->data_ptr())) {
+      Py_RETURN_NONE;
+    }
+    THWStoragePtr new_storage(THPStorage_(newArenaStorage)(
+        storage->nbytes() / sizeof(scalar_t), THPUtils_unpackLong(arg)));
+    if (!new_storage) {
+      Py_RETURN_NONE;
+    }
+    THWStorage_(copy)(new_storage, storage);
+    THWStorage_(swap)(storage, new_storage);
+    block = THSharedArenaBlock::fromDataPtr(storage->data_ptr());
+    AT_ASSERT(block);
+  }
+
+  THPObjectPtr manager_handle(PyBytes_FromString(block->arena().manager_handle()));
+  if (!manager_handle) return nullptr;
+  THPObjectPtr arena_handle(PyBytes_FromString(block->arena().handle()));
+  if (!arena_handle) return nullptr;
+  THPObjectPtr arena_size(PyLong_FromSize_t(block->arena().size()));
+  if (!arena_size) return nullptr;
+  THPObjectPtr offset(PyLong_FromSize_t(block->offset()));
+  if (!offset) return nullptr;
+  THPObjectPtr size(PyLong_FromLong(storage->nbytes() / sizeof(scalar_t)));
+  if (!size) return nullptr;
+
+  THPObjectPtr tuple(PyTuple_New(5));
+  if (!tuple) return nullptr;
+  PyTuple_SET_ITEM(tuple.get(), 0, manager_handle.release());
+  PyTuple_SET_ITEM(tuple.get(), 1, arena_handle.release());
+  PyTuple_SET_ITEM(tuple.get(), 2, arena_size.release());
+  PyTuple_SET_ITEM(tuple.get(), 3, offset.release());
+  PyTuple_SET_ITEM(tuple.get(), 4, size.release());
+  return tuple.release();
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * THPStorage_(newSharedArena)(PyObject *_unused, PyObject *args)
+{
+  HANDLE_TH_ERRORS
+  THPUtils_assert(PyTuple_GET_SIZE(args) == 5, "tuple of 5 items expected");
+  PyObject *_manager_handle = PyTuple_GET_ITEM(args, 0);
+  PyObject *_arena_handle = PyTuple_GET_ITEM(args, 1);
+  PyObject *_arena_size = PyTuple_GET_ITEM(args, 2);
+  PyObject *_offset = PyTuple_GET_ITEM(args, 3);
+  PyObject *_size = PyTuple_GET_ITEM(args, 4);
+  if (!PyBytes_Check(_manager_handle) || !PyBytes_Check(_arena_handle) ||
+      !THPUtils_checkLong(_arena_size) || !THPUtils_checkLong(_offset) ||
+      !THPUtils_checkLong(_size)) {
+    THPUtils_invalidArguments(args, nullptr, "_new_shared in arena mode", 1,
+        "a manager handle (bytes), an arena handle (bytes), an arena size (int), "
+        "an offset (int) and a storage size (int)");
+    return nullptr;
+  }
+  auto arena = THSharedArena::open(
+      PyBytes_AS_STRING(_manager_handle),
+      PyBytes_AS_STRING(_arena_handle),
+      THPUtils_unpackLong(_arena_size));
+  int64_t size = THPUtils_unpackLong(_size);
+  return THPStorage_(New)(
+          THWStorage_(newWithDataAndAllocator)(
+            arena->block(THPUtils_unpackLong(_offset)),
+            size,
+            /* allocator */ nullptr));
+  END_HANDLE_TH_ERRORS
+}
+#endif
+
 #else // THC_GENERIC_FILE
 
 static PyObject * THPStorage_(shareCuda)(THPStorage *self, PyObject *noargs)
@@ -263,7 +378,7 @@ static PyObject * THPStorage_(shareCuda)(THPStorage *self, PyObject *noargs)
 
 #ifndef __HIP_PLATFORM_HCC__
     if (sent_data->event_sync_required_) {
-      THCudaCheck(cudaIpcGetEventHandle(&ipc_event_handle, sent_data->event_));
+      ipc_event_handle = sent_data->ipc_event_handle_;
     }
 #else
     // ipc_event_handle unused in storage receiver, we can leave it uninitialized.
@@ -314,21 +429,7 @@ static PyObject * THPStorage_(releaseIPCCounter)(PyObject *_unused, PyObject *ar
   std::string ref_counter_handle = PyBytes_AS_STRING(_ref_counter);
   ptrdiff_t ref_counter_offset =
       (ptrdiff_t)THPUtils_unpackLong(_ref_counter_offset);
-  // We don't want to break existing code, so resource deletion is best
-  // effort basis. Exception expected if producer process terminated
-  // before consumer released data.
-  int flags =
-      TH_ALLOCATOR_MAPPED_SHAREDMEM | TH_ALLOCATOR_MAPPED_NOCREATE;
-  try {
-    auto sptr = THRefcountedMapAllocator::makeDataPtr(
-        ref_counter_handle.c_str(),
-        flags,
-        sizeof(int64_t) * torch::CUDA_IPC_REF_COUNTER_FILE_SIZE,
-        nullptr);
-    *(static_cast<int64_t*>(sptr.get()) + ref_counter_offset) -= 1;
-  } catch (c10::Error& err) {
-    // Already warned inside of producer process
-  }
+  torch::CudaIPCReleaseRefCounter(ref_counter_handle, ref_counter_offset);
   Py_RETURN_NONE;
   END_HANDLE_TH_ERRORS
 }
@@ -380,10 +481,8 @@ static PyObject * THPStorage_(newSharedCuda)(PyObject *_unused, PyObject *args)
     // Ensure that producer prepared all tensor's data
     std::string s_ipc_event_handle =
         THPStorage_(bytesAsHandleString)(_event_handle);
-    auto ipc_event_handle = reinterpret_cast<const cudaIpcEventHandle_t*>(
-        s_ipc_event_handle.c_str());
-    cudaEvent_t event;
-    cudaIpcOpenEventHandle(&event, *ipc_event_handle);
+    // The producer recycles its events, which are opened once.
+    cudaEvent_t event = torch::CudaIPCOpenEvent(s_ipc_event_handle);
     AT_CUDA_CHECK(
         cudaStreamWaitEvent(c10::cuda::getCurrentCUDAStream(device), event, 0));
   }
@@ -420,21 +519,7 @@ static PyObject * THPStorage_(newSharedCuda)(PyObject *_unused, PyObject *args)
         // Callback and release counter inside of it (need to check performance impact)
         cudaStreamSynchronize(c10::cuda::getCurrentCUDAStream(device));
 
-        // We don't want to break existing code, so resource deletion is best
-        // effort basis. Exception expected if producer process terminated
-        // before consumer released data.
-        int flags =
-            TH_ALLOCATOR_MAPPED_SHAREDMEM | TH_ALLOCATOR_MAPPED_NOCREATE;
-        try {
-          auto sptr = THRefcountedMapAllocator::makeDataPtr(
-              ref_counter_handle.c_str(),
-              flags,
-              sizeof(int64_t) * torch::CUDA_IPC_REF_COUNTER_FILE_SIZE,
-              nullptr);
-          *(static_cast<int64_t*>(sptr.get()) + ref_counter_offset) -= 1;
-        } catch (c10::Error& err) {
-          // Already warned inside of producer process
-        }
+        torch::CudaIPCReleaseRefCounter(ref_counter_handle, ref_counter_offset);
       });
 
   THWStoragePtr base(THWStorage_(newWithDataAndAllocator)(
@@ -520,9 +605,13 @@ PyObject * THPStorage_(isShared)(THPStorage *self, PyObject *noargs)
   if (THMapAllocator::fromDataPtr(self->cdata->data_ptr()) ||
       THManagedMapAllocator::fromDataPtr(self->cdata->data_ptr())) {
     Py_RETURN_TRUE;
-  } else {
-    Py_RETURN_FALSE;
   }
+#ifndef _WIN32
+  if (THSharedArenaBlock::fromDataPtr(self->cdata->data_ptr())) {
+    Py_RETURN_TRUE;
+  }
+#endif
+  Py_RETURN_FALSE;
 #endif
 }
 
@@ -539,6 +628,11 @@ static PyMethodDef THPStorage_(sharingMethods)[] = {
   {"_share_filename_", (PyCFunction)THPStorage_(shareFilename), METH_NOARGS, nullptr},
   {"_new_shared_filename", (PyCFunction)(void(*)(void))THPStorage_(newSharedFilename), METH_VARARGS | METH_STATIC, nullptr},
   {"_new_using_filename", (PyCFunction)(void(*)(void))THPStorage_(pyNewFilenameStorage), METH_VARARGS | METH_STATIC, nullptr},
+#ifndef _WIN32
+  {"_share_arena_", (PyCFunction)THPStorage_(shareArena), METH_O, nullptr},
+  {"_new_shared_arena", (PyCFunction)(void(*)(void))THPStorage_(newSharedArena), METH_VARARGS | METH_STATIC, nullptr},
+  {"_new_using_arena", (PyCFunction)(void(*)(void))THPStorage_(pyNewArenaStorage), METH_VARARGS | METH_STATIC, nullptr},
+#endif
 #endif
   {"_weak_ref", (PyCFunction)THPStorage_(weakRef), METH_NOARGS, nullptr},
   {"_free_weak_ref", (PyCFunction)(void(*)(void))THPStorage_(freeWeakRef), METH_O | METH_STATIC, nullptr},
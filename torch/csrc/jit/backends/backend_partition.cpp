@@ -0,0 +1,171 @@
+#include <torch/csrc/jit/backends/backend_partition.h>
+
+#include <torch/csrc/jit/frontend/schema_matching.h>
+#include <torch/csrc/jit/ir/ir.h>
+#include <torch/csrc/jit/passes/dead_code_elimination.h>
+#include <torch/csrc/jit/passes/utils/subgraph_utils.h>
+
+namespace torch {
+namespace jit {
+namespace {
+
+// The kind of the nodes that hold a run of supported nodes until it is
+// lowered.
+const Symbol kBackendSubgraph = Symbol::fromQualString("prim::BackendSubgraph");
+
+bool isSupported(Node* n, const std::unordered_set<Symbol>& supported_ops) {
+  if (!supported_ops.count(n->kind()) || !n->blocks().empty()) {
+    return false;
+  }
+  // The backend returns new tensors, so it cannot mutate values of the
+  // interpreter.
+  if (n->maybeSchema() && n->schema().is_mutable()) {
+    return false;
+  }
+  // The generated methods of lowered modules take and return tensors.
+  // Constants are cloned into the subgraphs instead of being passed.
+  for (Value* input : n->inputs()) {
+    if (input->node()->kind() != prim::Constant &&
+        !input->type()->isSubtypeOf(TensorType::get())) {
+      return false;
+    }
+  }
+  for (Value* output : n->outputs()) {
+    if (!output->type()->isSubtypeOf(TensorType::get())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Collects the maximal runs of supported nodes of \p block and its nested
+// blocks. Constants do not break runs, as they are cloned into subgraphs.
+void collectRuns(
+    Block* block,
+    const std::unordered_set<Symbol>& supported_ops,
+    std::vector<std::vector<Node*>>& runs) {
+  std::vector<Node*> run;
+  for (Node* n : block->nodes()) {
+    for (Block* b : n->blocks()) {
+      collectRuns(b, supported_ops, runs);
+    }
+    if (n->kind() == prim::Constant) {
+      continue;
+    }
+    if (isSupported(n, supported_ops)) {
+      run.push_back(n);
+    } else if (!run.empty()) {
+      runs.push_back(std::move(run));
+      run.clear();
+    }
+  }
+  if (!run.empty()) {
+    runs.push_back(std::move(run));
+  }
+}
+
+// Creates a module whose forward method runs \p subgraph, its outputs
+// packed into a tuple if there are several.
+Module createSubgraphModule(
+    const Module& parent,
+    const std::string& method_name,
+    std::shared_ptr<Graph> subgraph) {
+  Module submodule(
+      c10::QualifiedName(*parent.type()->name(), method_name + "_subgraph"),
+      parent._ivalue()->compilation_unit(),
+      /*shouldMangle=*/true);
+
+  subgraph->insertInput(0, "self")->setType(submodule.type());
+  for (size_t i = 1; i < subgraph->inputs().size(); ++i) {
+    subgraph->inputs()[i]->setDebugName("input_" + c10::to_string(i - 1));
+  }
+  if (subgraph->outputs().size() > 1) {
+    WithInsertPoint guard(subgraph->return_node());
+    Value* tuple =
+        subgraph->insertNode(subgraph->createTuple(subgraph->outputs()))
+            ->output();
+    while (!subgraph->outputs().empty()) {
+      subgraph->eraseOutput(0);
+    }
+    subgraph->registerOutput(tuple);
+  }
+
+  auto fn = submodule._ivalue()->compilation_unit()->create_function(
+      c10::QualifiedName(*submodule.type()->name(), "forward"),
+      std::move(subgraph));
+  submodule.type()->addMethod(fn);
+  return submodule;
+}
+
+} // namespace
+
+Module partitionForBackend(
+    const Module& module,
+    const std::vector<std::string>& method_names,
+    const std::unordered_set<Symbol>& supported_ops,
+    const LowerSubgraphFn& lower_fn) {
+  // Partition a copy, so that the transformation is functional like
+  // lowering a whole module.
+  Module partitioned = module.clone();
+  size_t num_lowered = 0;
+
+  for (const auto& method_name : method_names) {
+    auto graph = partitioned.get_method(method_name).graph();
+
+    std::vector<std::vector<Node*>> runs;
+    collectRuns(graph->block(), supported_ops, runs);
+
+    for (const auto& run : runs) {
+      // Merge the run into a subgraph node, last node first, as every node
+      // merged into a subgraph node must come before it.
+      Node* group =
+          SubgraphUtils::createSingletonSubgraph(run.back(), kBackendSubgraph);
+      for (auto it = run.rbegin() + 1; it != run.rend(); ++it) {
+        SubgraphUtils::mergeNodeIntoSubgraph(*it, group);
+      }
+      if (group->outputs().empty()) {
+        SubgraphUtils::unmergeSubgraph(group);
+        continue;
+      }
+
+      auto submodule = createSubgraphModule(
+          partitioned, method_name, SubgraphUtils::getSubgraph(group)->copy());
+      Module lowered = lower_fn(submodule, method_name);
+
+      std::string name;
+      do {
+        name = "__" + method_name + "_lowered_" + c10::to_string(num_lowered++);
+      } while (partitioned.hasattr(name));
+      partitioned.register_module(name, lowered);
+
+      // Replace the subgraph node with a call of the lowered module.
+      WithInsertPoint guard(group);
+      std::vector<NamedValue> args;
+      args.emplace_back(graph->insertGetAttr(graph->inputs()[0], name));
+      for (Value* input : group->inputs()) {
+        args.emplace_back(input);
+      }
+      auto matched = matchSchema(
+          lowered.get_method("forward").function().getSchema(),
+          group->sourceRange(),
+          *graph,
+          args,
+          {});
+      Value* result = graph->insertMethodCall("forward", matched);
+      if (group->outputs().size() == 1) {
+        group->output()->replaceAllUsesWith(result);
+      } else {
+        auto outputs = createTupleUnpack(result);
+        for (size_t i = 0; i < outputs.size(); ++i) {
+          group->outputs()[i]->replaceAllUsesWith(outputs[i]);
+        }
+      }
+      group->destroy();
+    }
+    EliminateDeadCode(graph);
+  }
+  return partitioned;
+}
+
+} // namespace jit
+} // namespace torch
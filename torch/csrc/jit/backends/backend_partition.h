@@ -0,0 +1,31 @@
+#pragma once
+
+#include <torch/csrc/jit/api/module.h>
+
+namespace torch {
+namespace jit {
+
+// Lowers the module \p submodule, whose only method is forward, for the
+// method named \p method_name of the module being partitioned. \returns the
+// lowered module.
+using LowerSubgraphFn = std::function<
+    Module(const Module& submodule, const std::string& method_name)>;
+
+// Delegates the parts of the methods named in \p method_names that a backend
+// supports to it, while the rest of each method keeps running in the
+// interpreter. A node is supported if its kind is in \p supported_ops, it
+// does not mutate its inputs, and it only takes constants and tensors and
+// only returns tensors. Every maximal run of consecutive supported nodes of
+// a block is carved out into the forward method of a new module, which
+// \p lower_fn lowers to the backend. The lowered module is registered as a
+// submodule and the run replaced by a call of its forward method. Since the
+// lowered modules serialize their preprocessed form, loading the returned
+// module only compiles them. \returns a partitioned copy of \p module.
+TORCH_API Module partitionForBackend(
+    const Module& module,
+    const std::vector<std::string>& method_names,
+    const std::unordered_set<Symbol>& supported_ops,
+    const LowerSubgraphFn& lower_fn);
+
+} // namespace jit
+} // namespace torch
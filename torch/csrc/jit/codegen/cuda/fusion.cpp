@@ -550,6 +550,16 @@ bool Fusion::hasGridReduction() {
   return false;
 }
 
+bool Fusion::hasBlockBroadcast() {
+  for (auto expr : exprs(true))
+    for (auto out : expr->outputs())
+      if (out->getValType() == ValType::TensorView)
+        if (static_cast<TensorView*>(out)->hasBlockBroadcast())
+          return true;
+
+  return false;
+}
+
 } // namespace fuser
 } // namespace jit
 } // namespace torch
@@ -217,6 +217,7 @@ class TORCH_CUDA_API Fusion final {
   bool hasReduction();
   bool hasBlockReduction();
   bool hasGridReduction();
+  bool hasBlockBroadcast();
   size_t gridReductionTempBufferSize();
 
   void setValuesMap(std::unordered_map<Val*, Val*> values_map) {
@@ -26,12 +26,15 @@ constexpr size_t NVRTC_KERNEL_ARG_LIMIT = 128;
 
 namespace {
 
-Value* broadcastSizes(at::ArrayRef<Value*> sizes) {
+Value* broadcastSizes(at::ArrayRef<Value*> sizes, AliasDb* db = nullptr) {
   AT_ASSERT(!sizes.empty());
   Graph* graph = sizes[0]->owningGraph();
   Node* broadcast_n =
       graph->insertNode(graph->create(prim::BroadcastSizes, sizes));
   broadcast_n->output()->setType(ListType::ofInts());
+  if (db) {
+    db->createValue(broadcast_n->output());
+  }
   return broadcast_n->output();
 }
 
@@ -39,7 +42,7 @@ struct CudaGraphFuser {
   using FusionCallback = std::function<bool(Node*)>;
 
   Block* block_;
-  std::unique_ptr<AliasDb> aliasDb_;
+  AliasDb* aliasDb_;
   std::shared_ptr<Graph> graph_;
   Symbol kind_ = prim::CudaFusionGroup;
 
@@ -51,8 +54,11 @@ struct CudaGraphFuser {
   // Change with setInputArgLimit
   size_t subgraph_arg_limit_ = NVRTC_KERNEL_ARG_LIMIT;
 
-  CudaGraphFuser(Block* block, std::shared_ptr<Graph> graph)
-      : block_(block), graph_(std::move(graph)) {}
+  // The alias db is kept up to date as the graph is rewritten, so that it is
+  // built once for the whole graph rather than for every fusion round and
+  // every block.
+  CudaGraphFuser(AliasDb* aliasDb, Block* block, std::shared_ptr<Graph> graph)
+      : block_(block), aliasDb_(aliasDb), graph_(std::move(graph)) {}
 
   void setInputArgLimit(size_t limit) {
     subgraph_arg_limit_ = limit;
@@ -116,6 +122,8 @@ struct CudaGraphFuser {
     for (size_t i = 0; i < subgraph_outputs.size(); ++i) {
       auto outer_output = inner_to_outer.at(subgraph_outputs[i]);
       producer_group->outputs()[i]->replaceAllUsesWith(outer_output);
+      // new producer outputs have same aliasing properties as outer_output
+      aliasDb_->replaceWithNewValue(producer_group->outputs()[i], outer_output);
     }
     producer_group->destroy();
     producer_group =
@@ -136,6 +144,7 @@ struct CudaGraphFuser {
         consumer_subgraph->registerOutput(merged->outputs()[i]);
         auto new_output = consumer_group->addOutput();
         output->replaceAllUsesWith(new_output);
+        aliasDb_->replaceWithNewValue(output, new_output);
         new_output->setType(output->type());
       }
       node->destroy();
@@ -237,6 +246,7 @@ struct CudaGraphFuser {
     getSubgraph(group).registerOutput(mergedNode->output());
     auto sel = group->addOutput();
     sel->copyMetadata(n->output());
+    aliasDb_->replaceWithNewValue(n->output(), sel);
     n->replaceAllUsesWith(group);
     n->destroy();
     return group;
@@ -287,6 +297,7 @@ struct CudaGraphFuser {
       getSubgraph(group).registerOutput(merged->output());
       Value* new_producer = group->addOutput();
       new_producer->copyMetadata(producer);
+      aliasDb_->replaceWithNewValue(producer, new_producer);
       producer->replaceAllUsesWith(new_producer);
     }
     producer->node()->destroy();
@@ -356,9 +367,18 @@ struct CudaGraphFuser {
     auto* g = inputs[0]->owningGraph();
     auto* input_list =
         g->insertNode(g->createList(TensorType::get(), inputs))->output();
+    aliasDb_->createValue(input_list);
     auto* output_list = g->insert(aten::broadcast_tensors, {input_list});
+    aliasDb_->createValue(output_list);
     auto* unpack_node = g->insertNode(
         g->create(prim::ListUnpack, {output_list}, inputs.size()));
+
+    // `a_broadcasted` should receive the same aliasing info as `a`
+    TORCH_INTERNAL_ASSERT(unpack_node->outputs().size() == inputs.size());
+    for (size_t i = 0; i < inputs.size(); i++) {
+      aliasDb_->copyValue(inputs[i], unpack_node->outputs()[i]);
+    }
+
     return unpack_node->outputs();
   }
 
@@ -388,6 +408,7 @@ struct CudaGraphFuser {
       auto* old_output = chunk->outputs().at(i);
       auto* new_output = bchunk->outputs().at(i);
       new_output->copyMetadata(old_output);
+      aliasDb_->replaceWithNewValue(old_output, new_output);
       old_output->replaceAllUsesWith(new_output);
     }
     bchunk->copyAttributes(*chunk);
@@ -547,6 +568,10 @@ struct CudaGraphFuser {
       for (auto chunk_sel : producer_chunk_outputs) {
         Value* input_chunk_sel = bchunk->addOutput();
         input_chunk_sel->setType(chunk_sel->type());
+        // Add a fresh value for each output element of the broadcasting chunk
+        // node. This is safe because it will be consumed only by the chunked
+        // ops.
+        aliasDb_->createValue(input_chunk_sel);
         chunked_inputs.back().push_back(input_chunk_sel);
       }
     }
@@ -572,6 +597,7 @@ struct CudaGraphFuser {
       }
       bchunk->owningGraph()->insertNode(chunked_op);
       chunk_sel->replaceAllUsesWith(chunked_op->output());
+      aliasDb_->replaceWithNewValue(chunk_sel, chunked_op->output());
     }
 
     bchunk->removeInput(producer_index);
@@ -591,13 +617,15 @@ struct CudaGraphFuser {
       auto tensor_inputs = filter(
           producer_for_chunk_node->inputs(),
           [](Value* v) { return v->type()->isSubtypeOf(TensorType::get()); });
-      auto tensor_sizes = fmap(tensor_inputs, [](Value* v) {
-        return v->owningGraph()->insert(aten::size, {v});
+      auto tensor_sizes = fmap(tensor_inputs, [&](Value* v) {
+        Value* output = v->owningGraph()->insert(aten::size, {v});
+        aliasDb_->createValue(output);
+        return output;
       });
       AT_ASSERT(!tensor_sizes.empty());
       Value* output_size = tensor_sizes.size() == 1
           ? tensor_sizes[0]
-          : broadcastSizes(tensor_sizes);
+          : broadcastSizes(tensor_sizes, aliasDb_);
       for (Use u : size_calc_uses) {
         u.user->output()->replaceAllUsesWith(output_size);
         u.user->destroy();
@@ -659,6 +687,7 @@ struct CudaGraphFuser {
           auto old_output =
               bchunk->outputs().at(input_offset * nchunks + output_offset);
           new_output->copyMetadata(old_output);
+          aliasDb_->replaceWithNewValue(old_output, new_output);
           old_output->replaceAllUsesWith(new_output);
         }
       }
@@ -775,10 +804,6 @@ struct CudaGraphFuser {
   }
   */
 
-  void refreshAliasDb() {
-    aliasDb_ = torch::make_unique<AliasDb>(graph_);
-  }
-
   void optimizeFusedGraphs() {
     for (Node* node : block_->nodes()) {
       if (node->kind() != kind_) {
@@ -811,14 +836,12 @@ struct CudaGraphFuser {
     bool any_changed = true;
     while (any_changed) {
       any_changed = false;
-      refreshAliasDb();
       for (auto it = block_->nodes().rbegin(); it != block_->nodes().rend();) {
         bool changed;
         std::tie(it, changed) = scanNode(*it);
         any_changed |= changed;
       }
     }
-    refreshAliasDb();
 
     // fuseConcats();
 
@@ -840,7 +863,7 @@ struct CudaGraphFuser {
 
     for (Node* node : block_->nodes()) {
       for (Block* sub_block : node->blocks()) {
-        CudaGraphFuser(sub_block, graph_).run();
+        CudaGraphFuser(aliasDb_, sub_block, graph_).run();
       }
     }
   }
@@ -912,7 +935,10 @@ void PeepholeOptimizeShapeExpressions(Block* block) {
 } // anonymous namespace
 
 TORCH_CUDA_API void CudaFuseGraph(std::shared_ptr<Graph>& graph) {
-  CudaGraphFuser(graph->block(), graph).run();
+  PassTimingGuard timer("CudaFuseGraph");
+  AliasDb db(graph);
+  CudaGraphFuser(&db, graph->block(), graph).run();
+  Lint(&db);
   // After FuseGraph some common subexpressions may come back
   EliminateCommonSubexpression(graph);
   // We might have emitted a fair amount of useless shape propagating code, so
@@ -311,13 +311,10 @@ class TORCH_CUDA_API IterDomain : public Val {
             extent()->isConstScalar(),
             "Reductions can only be parallelized across dimensions of compile-time known constants.");
 
-    TORCH_CHECK(
-        t != ParallelType::Vectorize, "Vectorization not yet supported.");
-
-    if (t == ParallelType::Unroll)
+    if (t == ParallelType::Unroll || t == ParallelType::Vectorize)
       TORCH_CHECK(
           start()->isZeroInt() && extent()->isConstScalar(),
-          "Unrolling only supported with start = 0 and extent as a const int, but got ",
+          "Unrolling and vectorization only supported with start = 0 and extent as a const int, but got ",
           "a start of ",
           start(),
           " and extent ",
@@ -406,6 +403,7 @@ class TORCH_CUDA_API TensorDomain : public Val {
   bool hasReduction() const;
   bool hasBlockReduction() const;
   bool hasGridReduction() const;
+  bool hasBlockBroadcast() const;
   bool hasBroadcast() const;
   bool hasRFactor() const;
 
@@ -2,6 +2,7 @@
 #include <torch/csrc/jit/codegen/cuda/fusion.h>
 #include <torch/csrc/jit/codegen/cuda/ir_all_nodes.h>
 
+#include <algorithm>
 #include <iostream>
 
 namespace torch {
@@ -89,7 +90,8 @@ void IRPrinter::printHeader(Fusion* fusion, const std::string& kernel_name_) {
     indent();
     os << "Philox rnd(seed, idx, offset);\n";
   }
-  if (fusion->hasBlockReduction() || fusion->hasGridReduction()) {
+  if (fusion->hasBlockReduction() || fusion->hasGridReduction() ||
+      fusion->hasBlockBroadcast()) {
     indent();
     // TODO: Dynamic sizing possible? blockReduce originally used 1024
     // values of a given type
@@ -242,6 +244,11 @@ void IRPrinter::handle(const Int* i) {
     }
   }
 
+  if (i == vectorized_index_) {
+    os << "0";
+    return;
+  }
+
   if (i->isSymbolic()) {
     os << "i" << i->name();
   } else {
@@ -478,6 +485,34 @@ void IRPrinter::handle(const ReductionOp* rop) {
 }
 
 void IRPrinter::handle(const BroadcastOp* bop) {
+  // A broadcast along a thread dimension reads the value the thread at offset
+  // 0 of that dimension holds, e.g., the result of a block reduction.
+  if (bop->out()->getValType() == ValType::TensorIndex &&
+      bop->out()->as<TensorIndex>()->view()->hasBlockBroadcast()) {
+    bool tidx = false;
+    bool tidy = false;
+    bool tidz = false;
+    for (auto id : bop->out()->as<TensorIndex>()->view()->domain()->domain()) {
+      if (!id->isBroadcast() || !id->isThreadDim())
+        continue;
+      tidx = tidx || id->parallel_method() == ParallelType::TIDx;
+      tidy = tidy || id->parallel_method() == ParallelType::TIDy;
+      tidz = tidz || id->parallel_method() == ParallelType::TIDz;
+    }
+    auto d_type = bop->out()->getDataType().value();
+    indent();
+    os << "broadcast::blockBroadcast< " << (tidx ? "true" : "false") << ", "
+       << (tidy ? "true" : "false") << ", " << (tidz ? "true" : "false")
+       << " >"
+       << " ( ";
+    handle(bop->out());
+    os << ", ";
+    handle(bop->in());
+    os << ", reinterpret_cast<" << d_type << "*>(shared_mem)";
+    os << ");\n";
+    return;
+  }
+
   indent();
   handle(bop->out());
   os << "\n";
@@ -489,6 +524,29 @@ void IRPrinter::handle(const BroadcastOp* bop) {
   os << ";\n";
 }
 
+namespace {
+
+// Whether expr copies a tensor to or from global memory, which a vectorized
+// loop does with a single access.
+bool isVectorizableCopy(const Expr* expr) {
+  if (expr->getExprType() != ExprType::UnaryOp ||
+      expr->as<UnaryOp>()->getUnaryOpType() != UnaryOpType::Set) {
+    return false;
+  }
+  auto in = expr->as<UnaryOp>()->in();
+  auto out = expr->as<UnaryOp>()->out();
+  if (in->getValType() != ValType::TensorIndex ||
+      out->getValType() != ValType::TensorIndex ||
+      in->getDataType() != out->getDataType()) {
+    return false;
+  }
+  return in->as<TensorIndex>()->view()->getMemoryType() ==
+      MemoryType::Global ||
+      out->as<TensorIndex>()->view()->getMemoryType() == MemoryType::Global;
+}
+
+} // namespace
+
 void IRPrinter::handle(const ForLoop* fl) {
   if (fl->iter_domain()->isThread() || fl->iter_domain()->isBroadcast()) {
     for (auto& expr : fl->constBody().exprs())
@@ -496,6 +554,36 @@ void IRPrinter::handle(const ForLoop* fl) {
     return;
   }
 
+  // A vectorized loop whose body is only copies is printed as a single,
+  // aligned access of the whole loop per copy. The other ones, e.g., the
+  // predicated copies of the elements at the end of a tensor, are printed as
+  // loops.
+  if (fl->iter_domain()->parallel_method() == ParallelType::Vectorize &&
+      std::all_of(
+          fl->constBody().exprs().begin(),
+          fl->constBody().exprs().end(),
+          isVectorizableCopy)) {
+    const Int* prev_index = vectorized_index_;
+    vectorized_index_ = fl->index();
+    for (auto expr : fl->constBody().exprs()) {
+      auto uop = expr->as<UnaryOp>();
+      indent();
+      os << "*reinterpret_cast<Array<" << uop->out()->getDataType().value()
+         << ", ";
+      print_inline(fl->iter_domain()->extent());
+      os << ">*>(&";
+      handle(uop->out());
+      os << ") = *reinterpret_cast<Array<" << uop->in()->getDataType().value()
+         << ", ";
+      print_inline(fl->iter_domain()->extent());
+      os << ">*>(&";
+      handle(uop->in());
+      os << ");\n";
+    }
+    vectorized_index_ = prev_index;
+    return;
+  }
+
   indent();
   os << "for(size_t ";
   handle(fl->index());
@@ -547,6 +635,18 @@ void IRPrinter::handle(const IfThenElse* ite) {
 
 void IRPrinter::handle(const Allocate* a) {
   indent();
+  // The buffers of vectorized accesses must be aligned to their size.
+  if (a->buffer()->getValType() == ValType::TensorView) {
+    for (auto id : a->buffer()->as<TensorView>()->domain()->domain()) {
+      if (id->parallel_method() == ParallelType::Vectorize) {
+        os << "__align__("
+           << dataTypeSize(a->buf_type()) *
+                id->extent()->as<Int>()->value().value()
+           << ") ";
+        break;
+      }
+    }
+  }
   os << a->buf_type();
   if (a->buffer()->getValType() == ValType::TensorView) {
     os << " T" << a->buffer()->name() << "[";
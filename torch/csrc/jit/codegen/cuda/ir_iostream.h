@@ -59,6 +59,10 @@ class TORCH_CUDA_API IRPrinter : public OptInConstDispatch {
   // Handle value mapping
   bool follow_val_map = true;
 
+  // Index of the vectorized loop whose accesses are being printed, which is
+  // printed as 0 to get the address of the first element of each access.
+  const Int* vectorized_index_ = nullptr;
+
   // Indent the generated code
   void indent() {
     for (int i = 0; i < indent_size; i++)
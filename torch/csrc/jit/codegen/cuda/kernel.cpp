@@ -12,6 +12,7 @@
 #include <torch/csrc/jit/codegen/cuda/parser.h>
 
 #include <torch/csrc/jit/resource_guard.h>
+#include <torch/csrc/jit/runtime/compiled_kernel_cache.h>
 #include <fstream>
 #include <iostream>
 
@@ -155,7 +156,8 @@ std::pair<std::string, std::string> codeGeneration(Fusion* fusion) {
              << code_random_number_gen << "\n"
              << code_helper_funcs << "\n"
              << code_template_block_reduction << "\n"
-             << code_template_grid_reduction << "\n";
+             << code_template_grid_reduction << "\n"
+             << code_template_block_broadcast << "\n";
   std::stringstream cdg;
   GPULower gpulw(fusion);
   gpulw.printKernel(str_stream, kKernelName);
@@ -390,6 +392,67 @@ bool NaivePWKernelArgsReq::matchKernelSize(const at::ArrayRef<IValue> inputs) {
   return true;
 }
 
+bool canVectorize(const at::Tensor& tensor, int width) {
+  if (tensor.dim() == 0 || tensor.size(-1) % width != 0 ||
+      tensor.stride(-1) != 1) {
+    return false;
+  }
+  for (int64_t i = 0; i < tensor.dim() - 1; i++) {
+    if (tensor.size(i) != 1 && tensor.stride(i) % width != 0) {
+      return false;
+    }
+  }
+  return reinterpret_cast<uintptr_t>(tensor.data_ptr()) %
+      (width * tensor.element_size()) ==
+      0;
+}
+
+bool canVectorize(const at::ArrayRef<IValue> inputs, int width) {
+  bool has_tensor = false;
+  for (const auto& input : inputs) {
+    if (input.isTensor()) {
+      if (!canVectorize(input.toTensor(), width)) {
+        return false;
+      }
+      has_tensor = true;
+    }
+  }
+  return has_tensor;
+}
+
+bool VectorizedPWKernelArgsReq::matchKernelSize(
+    const at::ArrayRef<IValue> inputs) {
+  return NaivePWKernelArgsReq::matchKernelSize(inputs) &&
+      canVectorize(inputs, kPwVectorWidth) == vectorize_;
+}
+
+int64_t normalizedRowSize(
+    const at::ArrayRef<IValue> inputs,
+    int normalized_dims) {
+  // Inputs are broadcast to the shape of the normalized tensor, so the
+  // largest one gives the size of its rows.
+  int64_t row_size = 1;
+  for (const auto& input : inputs) {
+    if (!input.isTensor() || input.toTensor().dim() < normalized_dims) {
+      continue;
+    }
+    const auto sizes = input.toTensor().sizes();
+    int64_t size = 1;
+    for (size_t i = sizes.size() - normalized_dims; i < sizes.size(); i++) {
+      size *= sizes[i];
+    }
+    row_size = std::max(row_size, size);
+  }
+  return row_size;
+}
+
+bool NormalizationKernelArgsReq::matchKernelSize(
+    const at::ArrayRef<IValue> inputs) {
+  return NaivePWKernelArgsReq::matchKernelSize(inputs) &&
+      persistentFactor(normalizedRowSize(inputs, normalized_dims_)) ==
+      persistent_factor_;
+}
+
 void compileKernel(CudaKernel* entry) {
   // generating cuda code;
   std::string code;
@@ -435,38 +498,64 @@ void compileKernel(CudaKernel* entry) {
   int major, minor;
   major = prop->major;
   minor = prop->minor;
-  nvrtcProgram program;
-  AT_CUDA_NVRTC_CHECK(nvrtc().nvrtcCreateProgram(
-      &program, code.c_str(), nullptr, 0, nullptr, nullptr));
-  ResourceGuard holdProgram(
-      [&] { AT_CUDA_NVRTC_CHECK(nvrtc().nvrtcDestroyProgram(&program)); });
-
   const std::string compute = "--gpu-architecture=compute_" +
       std::to_string(major) + std::to_string(minor);
   const std::vector<const char*> args = {
       "--std=c++14", compute.c_str(), "-default-device"};
 
-  nvrtc().nvrtcAddNameExpression(program, func_name.c_str());
-  const auto result =
-      nvrtc().nvrtcCompileProgram(program, args.size(), args.data());
-  if (result != NVRTC_SUCCESS) {
-    size_t logsize;
-    nvrtc().nvrtcGetProgramLogSize(program, &logsize);
-    std::vector<char> log(logsize);
-    nvrtc().nvrtcGetProgramLog(program, log.data());
+  // The entries of the compiled kernel cache hold the lowered name of the
+  // kernel, then a null character and the PTX.
+  std::vector<std::string> key_parts = {
+      "nvfuser",
+      std::to_string(nvrtc_major) + "." + std::to_string(nvrtc_minor),
+      func_name,
+      code};
+  key_parts.insert(key_parts.end(), args.begin(), args.end());
+  const auto key = compiledKernelCacheKey(key_parts);
+
+  std::string lowered_kernel_name;
+  std::vector<char> ptx;
+  std::string cached;
+  size_t name_end = std::string::npos;
+  if (loadCompiledKernel(key, cached) &&
+      (name_end = cached.find('\0')) != std::string::npos) {
+    lowered_kernel_name = cached.substr(0, name_end);
+    ptx.assign(cached.begin() + name_end + 1, cached.end());
+  } else {
+    nvrtcProgram program;
+    AT_CUDA_NVRTC_CHECK(nvrtc().nvrtcCreateProgram(
+        &program, code.c_str(), nullptr, 0, nullptr, nullptr));
+    ResourceGuard holdProgram(
+        [&] { AT_CUDA_NVRTC_CHECK(nvrtc().nvrtcDestroyProgram(&program)); });
+
+    nvrtc().nvrtcAddNameExpression(program, func_name.c_str());
+    const auto result =
+        nvrtc().nvrtcCompileProgram(program, args.size(), args.data());
+    if (result != NVRTC_SUCCESS) {
+      size_t logsize;
+      nvrtc().nvrtcGetProgramLogSize(program, &logsize);
+      std::vector<char> log(logsize);
+      nvrtc().nvrtcGetProgramLog(program, log.data());
 
-    TORCH_INTERNAL_ASSERT(
-        false, code.c_str(), "\nCUDA NVRTC compile error: ", log.data());
+      TORCH_INTERNAL_ASSERT(
+          false, code.c_str(), "\nCUDA NVRTC compile error: ", log.data());
+    }
+    const char* lowered_name;
+    nvrtc().nvrtcGetLoweredName(program, func_name.c_str(), &lowered_name);
+    lowered_kernel_name = lowered_name;
+
+    AT_CUDA_NVRTC_CHECK(result);
+    size_t ptx_size;
+    AT_CUDA_NVRTC_CHECK(nvrtc().nvrtcGetPTXSize(program, &ptx_size));
+    ptx.resize(ptx_size);
+    AT_CUDA_NVRTC_CHECK(nvrtc().nvrtcGetPTX(program, ptx.data()));
+
+    std::string cache_entry = lowered_kernel_name;
+    cache_entry.push_back('\0');
+    cache_entry.append(ptx.begin(), ptx.end());
+    storeCompiledKernel(key, cache_entry);
   }
-  const char* lowered_kernel_name;
-  nvrtc().nvrtcGetLoweredName(program, func_name.c_str(), &lowered_kernel_name);
-
-  AT_CUDA_NVRTC_CHECK(result);
-  size_t ptx_size;
-  AT_CUDA_NVRTC_CHECK(nvrtc().nvrtcGetPTXSize(program, &ptx_size));
-  std::vector<char> ptx;
-  ptx.resize(ptx_size);
-  AT_CUDA_NVRTC_CHECK(nvrtc().nvrtcGetPTX(program, ptx.data()));
+  const size_t ptx_size = ptx.size();
 
   // TODO: We do go through different code path, should investigate whether this
   // has an impact on generated binary.
@@ -515,7 +604,7 @@ void compileKernel(CudaKernel* entry) {
         nvrtc().cuModuleLoadData(&(entry->module_), ptx.data()));
   }
   AT_CUDA_DRIVER_CHECK(nvrtc().cuModuleGetFunction(
-      &(entry->function_), entry->module_, lowered_kernel_name));
+      &(entry->function_), entry->module_, lowered_kernel_name.c_str()));
 #if defined(__HIP_PLATFORM_HCC__) && HIP_VERSION < 305
   // HIP function signature is not compatible yet
   uint32_t max_blocks;
@@ -535,6 +624,13 @@ void runKernel(
     const std::vector<at::Tensor>& outputs,
     const std::vector<int64_t>& broadcasted_shape) {
   validateKernelArgs(*entry, inputs, outputs);
+  if (entry->vectorize_) {
+    for (const auto& output : outputs) {
+      TORCH_CHECK(
+          canVectorize(output, entry->unroll_factor_),
+          "Outputs of a vectorized kernel must be aligned and contiguous");
+    }
+  }
 
   const auto prior_device = at::cuda::current_device();
   at::cuda::set_device(entry->device_);
@@ -547,7 +643,26 @@ void runKernel(
   int blocks = 1;
   int thread_x = 1;
   int thread_y = 1;
-  if (!entry->reduction_axes_.empty()) {
+  if (entry->normalized_dims_ > 0) {
+    // A block per row, whose threads each hold persistent_factor_ elements of
+    // it. The block must not have more threads than the split of the row, as
+    // the threads past its end would feed uninitialized partial results into
+    // the block reductions.
+    const auto sizes = outputs[0].sizes();
+    int64_t row_size = 1;
+    for (size_t i = sizes.size() - entry->normalized_dims_; i < sizes.size();
+         i++) {
+      row_size *= sizes[i];
+    }
+    blocks = row_size == 0 ? 0 : numel / row_size;
+    thread_x =
+        std::max(ceilDiv(row_size, entry->persistent_factor_), 1);
+    TORCH_INTERNAL_ASSERT(
+        thread_x <= kMaxNormalizationThreadX,
+        "Rows of ",
+        row_size,
+        " elements are too large for the normalization kernel");
+  } else if (!entry->reduction_axes_.empty()) {
     // TODO: MAJOR HACK! Expr evaluation makes launch configuration much easier
     blocks = numel;
     // Translated to `fcd_reduction`
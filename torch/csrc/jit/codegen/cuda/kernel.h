@@ -40,6 +40,37 @@ struct NaivePWKernelArgsReq : KernelArgsReq {
   std::vector<int> dims_;
 };
 
+// A pointwise kernel may access global memory with vectorized loads and
+// stores, which requires the tensors to be aligned and contiguous along their
+// innermost dimension. It is only reused for the inputs that agree with it on
+// whether they are, the other ones running the scalar kernel of the fusion.
+struct VectorizedPWKernelArgsReq : NaivePWKernelArgsReq {
+  bool matchKernelSize(const at::ArrayRef<c10::IValue> inputs) override;
+  bool vectorize_ = false;
+};
+
+// Whether the accesses of `width` consecutive elements of the tensors can be
+// vectorized: their innermost dimensions are contiguous and a multiple of
+// `width` elements, and all their rows are aligned to `width` elements.
+TORCH_CUDA_API bool canVectorize(const at::Tensor& tensor, int width);
+TORCH_CUDA_API bool canVectorize(
+    const at::ArrayRef<c10::IValue> inputs,
+    int width);
+
+// A normalization kernel keeps the part of a row each thread computes in
+// registers, so it is only reused for the rows that need as many of them.
+struct NormalizationKernelArgsReq : NaivePWKernelArgsReq {
+  bool matchKernelSize(const at::ArrayRef<c10::IValue> inputs) override;
+  int normalized_dims_ = 0;
+  int persistent_factor_ = 0;
+};
+
+// The size of the rows a normalization over the `normalized_dims` innermost
+// dimensions of `inputs` reduces.
+TORCH_CUDA_API int64_t normalizedRowSize(
+    const at::ArrayRef<c10::IValue> inputs,
+    int normalized_dims);
+
 class CudaKernel {
  public:
   CudaKernel() {
@@ -59,8 +90,16 @@ class CudaKernel {
   CUfunction function_;
   int max_blocks_;
   int unroll_factor_ = 1;
+  // whether the kernel accesses global memory with vectors of unroll_factor_
+  // elements;
+  bool vectorize_ = false;
   // mark reduction axes;
   std::vector<int> reduction_axes_;
+  // number of innermost dimensions a normalization kernel reduces then
+  // broadcasts back, 0 for other kernels, and the number of elements of a row
+  // each of its threads keeps in registers.
+  int normalized_dims_ = 0;
+  int persistent_factor_ = 1;
 
   // WARNING:
   // Block and Grid dimension setting is here for testing purposes only
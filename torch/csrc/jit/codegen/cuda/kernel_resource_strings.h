@@ -31,6 +31,13 @@ struct Tensor<T, 0> {
 
   T* data;
 };
+
+// N consecutive values of T, accessed with a single aligned load or store by
+// vectorized loops.
+template<typename T, int N>
+struct alignas(sizeof(T) * N) Array {
+  T val[N];
+};
 )";
 
 // Code support for FP16 __half type and intrinsics
@@ -570,6 +577,43 @@ __device__ void gridReduce(T& out, T inp_val, Func reduction_op,
 } // namespace reduction
 )";
 
+/**
+  Intra-block broadcast.
+
+  Function blockBroadcast makes the value a thread holds visible to the other
+  threads of its block. X/Y/Z_THREAD are true for the dimensions of the block
+  the value is broadcast along: the value of the thread at offset 0 of those
+  dimensions is written to out by every thread that shares its offset in the
+  other dimensions. It is how the result of a blockReduce, which only the
+  threads at offset 0 of the reduction dimensions hold, is used by all the
+  threads of the block, so every thread of the block must call it.
+*/
+static auto code_template_block_broadcast = R"(
+namespace broadcast {
+template <bool X_THREAD, bool Y_THREAD, bool Z_THREAD, typename T>
+__device__ void blockBroadcast(T& out, T inp_val, T* shared_mem) {
+  const bool has_valid_data =
+      (!X_THREAD || threadIdx.x == 0) &&
+      (!Y_THREAD || threadIdx.y == 0) &&
+      (!Z_THREAD || threadIdx.z == 0);
+
+  const unsigned int shared_offset =
+      (X_THREAD ? 0 : threadIdx.x) +
+      (Y_THREAD ? 0 : threadIdx.y) * (X_THREAD ? 1 : blockDim.x) +
+      (Z_THREAD ? 0 : threadIdx.z) * (X_THREAD ? 1 : blockDim.x) *
+          (Y_THREAD ? 1 : blockDim.y);
+
+  // shared_mem may still be read by a preceding block reduction or broadcast.
+  __syncthreads();
+  if (has_valid_data)
+    shared_mem[shared_offset] = inp_val;
+  __syncthreads();
+  out = shared_mem[shared_offset];
+  __syncthreads();
+}
+} // namespace broadcast
+)";
+
 } // namespace cuda
 } // namespace fuser
 } // namespace jit
@@ -28,8 +28,10 @@ Expr* LoopNestGenerator::pushAlloc(TensorView* tv) {
 
     // If we found an unroll, we want to place the allocation outside the unroll
     if (alloc_pos < tv->nDims() &&
-        tv->getComputeAtAxis(alloc_pos).first->parallel_method() ==
-            ParallelType::Unroll) {
+        (tv->getComputeAtAxis(alloc_pos).first->parallel_method() ==
+             ParallelType::Unroll ||
+         tv->getComputeAtAxis(alloc_pos).first->parallel_method() ==
+             ParallelType::Vectorize)) {
       break;
     }
     alloc_pos++;
@@ -136,8 +138,10 @@ void LoopNestGenerator::initReduction(
 
     // If we found an unroll, we want to place the allocation outside the unroll
     if (alloc_pos < tv->nDims() &&
-        tv->getComputeAtAxis(alloc_pos).first->parallel_method() ==
-            ParallelType::Unroll) {
+        (tv->getComputeAtAxis(alloc_pos).first->parallel_method() ==
+             ParallelType::Unroll ||
+         tv->getComputeAtAxis(alloc_pos).first->parallel_method() ==
+             ParallelType::Vectorize)) {
       break;
     }
     alloc_pos++;
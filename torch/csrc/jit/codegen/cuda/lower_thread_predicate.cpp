@@ -161,7 +161,16 @@ void ThreadPredicates::updateBitSet(Expr* expr) {
   for (const auto* out : expr->outputs()) {
     if (!ir_utils::isTV(out))
       continue;
-    thread_predicates[ir_utils::asConstTV(out)] = output_preds;
+    auto out_preds = output_preds;
+    // A broadcast along a thread dim makes its input valid on all the threads
+    // of that dim, and all of them must take part in it.
+    if (expr->getExprType() == ExprType::BroadcastOp) {
+      for (auto id : ir_utils::asConstTV(out)->domain()->domain()) {
+        if (id->isBroadcast() && id->isThreadDim())
+          out_preds[pt_to_offset.at(id->parallel_method())] = false;
+      }
+    }
+    thread_predicates[ir_utils::asConstTV(out)] = out_preds;
   }
 }
 ThreadPredicates::ThreadPredicates(Fusion* _fusion) : fusion_(_fusion) {
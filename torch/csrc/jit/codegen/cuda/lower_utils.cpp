@@ -463,8 +463,12 @@ bool isUnrolledFor(const Expr* expr) {
   if (expr->getExprType() != ExprType::ForLoop) {
     return false;
   }
-  return static_cast<const ForLoop*>(expr)->iter_domain()->parallel_method() ==
-      ParallelType::Unroll;
+  // A vectorized loop is unrolled too, its accesses are only vectorized when
+  // the whole loop is in bounds.
+  auto parallel_method =
+      static_cast<const ForLoop*>(expr)->iter_domain()->parallel_method();
+  return parallel_method == ParallelType::Unroll ||
+      parallel_method == ParallelType::Vectorize;
 }
 
 } // namespace ir_utils
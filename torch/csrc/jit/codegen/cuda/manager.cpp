@@ -25,6 +25,37 @@ std::unique_ptr<KernelArgsReq> makePWKernelSupport(
   return req_ptr;
 }
 
+// A pointwise kernel vectorizes its accesses if the inputs it is compiled for
+// allow it, and is only reused for the inputs that allow it too. The other
+// inputs run a scalar kernel of their own.
+std::unique_ptr<VectorizedPWKernelArgsReq> makeVectorizedPWKernelSupport(
+    const at::ArrayRef<IValue>& inputs) {
+  auto req_ptr = std::make_unique<VectorizedPWKernelArgsReq>();
+  for (const auto& input : inputs) {
+    req_ptr->dims_.push_back(input.isTensor() ? input.toTensor().dim() : -1);
+  }
+  req_ptr->vectorize_ = canVectorize(inputs, kPwVectorWidth);
+  return req_ptr;
+}
+
+// A normalization kernel is only reused for the inputs whose rows it holds
+// with the same number of elements per thread.
+std::unique_ptr<NormalizationKernelArgsReq> makeNormalizationKernelSupport(
+    const at::ArrayRef<IValue>& inputs,
+    int normalized_dims) {
+  auto req_ptr = std::make_unique<NormalizationKernelArgsReq>();
+  for (const auto& input : inputs) {
+    req_ptr->dims_.push_back(input.isTensor() ? input.toTensor().dim() : -1);
+  }
+  req_ptr->normalized_dims_ = normalized_dims;
+  req_ptr->persistent_factor_ =
+      persistentFactor(normalizedRowSize(inputs, normalized_dims));
+  TORCH_CHECK(
+      req_ptr->persistent_factor_ > 0,
+      "Rows of the normalization are too large for a single block");
+  return req_ptr;
+}
+
 // CudaFusionManager holds compiled `CudaKernel` and handles all interfacing
 // including compilation and execution.
 //
@@ -93,8 +124,28 @@ class CudaFusionManager {
     } else {
       // TODO: this should somehow be done after kernel compilation.
       //       we will want compileKernel to return a heuristic
-      cuda_kernel = kernel_cache_[kernel_id].allocateKernelInCache(
-          makePWKernelSupport(inputs));
+      const int normalized_dims = normalizedDims(graph->block());
+      TORCH_CHECK(
+          normalized_dims >= 0,
+          "Normalizations of different dimensions can't be fused together");
+      if (normalized_dims > 0) {
+        auto kernel_req =
+            makeNormalizationKernelSupport(inputs, normalized_dims);
+        const int persistent_factor = kernel_req->persistent_factor_;
+        cuda_kernel = kernel_cache_[kernel_id].allocateKernelInCache(
+            std::move(kernel_req));
+        cuda_kernel.value()->normalized_dims_ = normalized_dims;
+        cuda_kernel.value()->persistent_factor_ = persistent_factor;
+      } else if (!hasReductionNode(graph->block())) {
+        auto kernel_req = makeVectorizedPWKernelSupport(inputs);
+        const bool vectorize = kernel_req->vectorize_;
+        cuda_kernel = kernel_cache_[kernel_id].allocateKernelInCache(
+            std::move(kernel_req));
+        cuda_kernel.value()->vectorize_ = vectorize;
+      } else {
+        cuda_kernel = kernel_cache_[kernel_id].allocateKernelInCache(
+            makePWKernelSupport(inputs));
+      }
 
       // lower torch::jit::Graph to torch::jit::fuser::cuda::fusion
       // TODO: pass contiguity infor as well as size req, so we can apply proper
@@ -7,6 +7,7 @@
 #include <torch/csrc/jit/frontend/function_schema_parser.h>
 #include <torch/csrc/jit/ir/constants.h>
 
+#include <limits>
 #include <unordered_map>
 #include <utility>
 
@@ -32,6 +33,10 @@ typedef Expr* CgOp;
 typedef void (*ParseFuncPtr)(const Node*, std::unordered_map<size_t, CgValue>&);
 typedef bool (*MergeQueryFuncPtr)(const Node*);
 
+// TODO: we should categorize operation types based on their memory accessing
+//       pattern, which would affect fusion strategy and partition logic.
+enum class OperatorType { ElementWise, Reduction, Normalization };
+
 std::vector<int> reductionAxes(TensorView* tv) {
   size_t n_dims = tv->nDims();
   std::vector<int> reduction_axes;
@@ -63,6 +68,77 @@ size_t coalescReduction(TensorView* tv) {
   return reduction_axes.size();
 }
 
+// softmax (or log_softmax) over the innermost dimension of x
+TensorView* softmaxOp(TensorView* x, bool log_softmax) {
+  const int axis = static_cast<int>(x->nDims()) - 1;
+  std::vector<bool> is_broadcast_dim(x->nDims(), false);
+  is_broadcast_dim[axis] = true;
+
+  auto max_val = reductionOp(
+      BinaryOpType::Max,
+      {axis},
+      new Float(std::numeric_limits<float>::lowest()),
+      x);
+  auto shifted = sub(x, broadcast(max_val, is_broadcast_dim));
+  auto exp_val = unaryOp(UnaryOpType::Exp, shifted);
+  auto sum_exp = broadcast(sum(exp_val, {axis}), is_broadcast_dim);
+  if (log_softmax) {
+    return sub(shifted, unaryOp(UnaryOpType::Log, sum_exp));
+  }
+  return div(exp_val, sum_exp);
+}
+
+// layer_norm over the `normalized_dims` innermost dimensions of x; weight and
+// bias are optional.
+TensorView* layerNormOp(
+    TensorView* x,
+    size_t normalized_dims,
+    TensorView* weight,
+    TensorView* bias,
+    Val* eps) {
+  const size_t n_dims = x->nDims();
+  std::vector<int> axes;
+  std::vector<bool> is_broadcast_dim(n_dims, false);
+  Val* num_features = nullptr;
+  for (size_t i = n_dims - normalized_dims; i < n_dims; i++) {
+    axes.push_back(static_cast<int>(i));
+    is_broadcast_dim[i] = true;
+    auto extent = x->getRootDomain()[i]->extent();
+    num_features =
+        num_features == nullptr ? extent : mul(num_features, extent);
+  }
+
+  auto mean = div(sum(x, axes), num_features);
+  auto x_mu = sub(x, broadcast(mean, is_broadcast_dim));
+  auto var = div(sum(mul(x_mu, x_mu), axes), num_features);
+  auto rstd = unaryOp(UnaryOpType::Rsqrt, add(var, eps));
+  auto out = mul(x_mu, broadcast(rstd, is_broadcast_dim));
+  if (weight != nullptr) {
+    out = mul(out, weight);
+  }
+  if (bias != nullptr) {
+    out = add(out, bias);
+  }
+  return out;
+}
+
+// Whether the rows of the `normalized_dims` innermost dimensions of a tensor
+// of `type` fit in a normalization kernel, assuming they do when its sizes
+// aren't known.
+bool fitsNormalizationKernel(
+    const std::shared_ptr<c10::TensorType>& type,
+    size_t normalized_dims) {
+  auto sizes = type->sizes().concrete_sizes();
+  if (!sizes.has_value()) {
+    return true;
+  }
+  int64_t row_size = 1;
+  for (size_t i = sizes->size() - normalized_dims; i < sizes->size(); i++) {
+    row_size *= (*sizes)[i];
+  }
+  return persistentFactor(row_size) > 0;
+}
+
 // TODO: add a mutex to make it thread safe.
 class IrParser {
   class RegistrationEntry {
@@ -137,6 +213,17 @@ class IrParser {
           block->outputs()[0]->type()->cast<TensorType>()->dim().value();
     }
 
+    // Pointwise kernels copy their inputs to registers and their outputs from
+    // them with vectorized accesses, if their tensors allow it, as checked by
+    // the manager. Not with rand_like, see disable_unroll below.
+    bool vectorize = cuda_kernel_->vectorize_;
+    for (const JitOp* node : block->nodes()) {
+      if (node->kind() == aten::rand_like) {
+        vectorize = false;
+      }
+    }
+    cuda_kernel_->vectorize_ = vectorize;
+
     // register all inputs;
     // shape propagation during parsing is effctively done in parsing rules, as
     // we only explicitly register inputs in the graph.
@@ -144,6 +231,12 @@ class IrParser {
       TORCH_INTERNAL_ASSERT(registerValue(val, broadcast_dim));
       cuda_kernel_->fusion_->addInput(value_map_[val->unique()]);
 
+      if (vectorize &&
+          value_map_[val->unique()]->getValType() == ValType::TensorView) {
+        value_map_[val->unique()] =
+            unaryOp(UnaryOpType::Set, value_map_[val->unique()]);
+      }
+
       auto opt_dtype = value_map_[val->unique()]->getDataType();
       // computation promotion, we cast fp16 inputs to fp32 and use promoted
       // type in the computation.
@@ -158,6 +251,7 @@ class IrParser {
     bool disable_unroll = false;
     bool has_reduction = false;
     bool fcd_reduction = false;
+    const bool has_normalization = cuda_kernel_->normalized_dims_ > 0;
     // compose nodes in topo order;
     for (const JitOp* node : block->nodes()) {
       processJitNode(node);
@@ -182,12 +276,17 @@ class IrParser {
         // No need to update value_map_ after this point.
         out = static_cast<TensorView*>(castOp(DataType::Half, out));
       }
+      if (vectorize) {
+        out = static_cast<TensorView*>(unaryOp(UnaryOpType::Set, out));
+      }
 
       cuda_kernel_->fusion_->addOutput(out);
 
       // TODO: has_reduction for scheudling should be done on a per output
       //       tensor basis.
-      if (has_reduction) {
+      if (has_normalization) {
+        // scheduled with the intermediates below.
+      } else if (has_reduction) {
         // TODO: this scheduling only works for a single reduction operation in
         //       the fusion, in this case we can coalesc all reduction axes and
         //       merge them together. (same applies to iteration axes)
@@ -213,6 +312,15 @@ class IrParser {
           out->merge(1, 2);
         }
 
+      } else if (vectorize) {
+        // Merge all dimensions, then split the vectors, each of them in a
+        // single contiguous row of every tensor, and 128 of them which will be
+        // bockDim.x
+        while (out->nDims() > 1)
+          out->merge(0, 1);
+        out->split(0, kPwVectorWidth);
+        out->split(0, kPwThreadX);
+        cuda_kernel_->unroll_factor_ = kPwVectorWidth;
       } else {
         // Merge all dimensions because we're only supporting pointwise
         while (out->nDims() > 1)
@@ -228,7 +336,9 @@ class IrParser {
       }
     }
 
-    if (has_reduction) {
+    if (has_normalization) {
+      scheduleNormalization();
+    } else if (has_reduction) {
       // Run through outputs, grab all inputs of outputs
       // squeeze with computeAt to set overall structure.
       for (auto output : cuda_kernel_->fusion_->outputs()) {
@@ -301,7 +411,10 @@ class IrParser {
 
         // Should be true for all intermediates, but if one isn't hooked
         // up right, skip it and hope for the best for now
-        if (!disable_unroll && tv->nDims() == 3) {
+        if (vectorize && tv->nDims() == 3) {
+          tv->axis(-2)->parallelize(ParallelType::TIDx);
+          tv->axis(-1)->parallelize(ParallelType::Vectorize);
+        } else if (!disable_unroll && tv->nDims() == 3) {
           tv->axis(-2)->parallelize(ParallelType::Unroll);
           tv->axis(-1)->parallelize(ParallelType::TIDx);
         } else {
@@ -312,6 +425,63 @@ class IrParser {
     }
   }
 
+  // Schedules a fusion of normalizations and pointwise ops to a kernel that
+  // runs a block per row. Every tensor is viewed as [rows, row], with the
+  // row, i.e., its cuda_kernel_->normalized_dims_ innermost dimensions,
+  // split into [threads, persistent_factor_]: each thread reduces the part of
+  // the row it holds, then the block reduces these, and the results are
+  // broadcast back to the threads through shared memory. The tensors have no
+  // computeAt, so that the intermediates are held by the threads, in
+  // persistent_factor_ registers each, and are computed once even if several
+  // ops use them.
+  void scheduleNormalization() {
+    Fusion* fusion = cuda_kernel_->fusion_.get();
+    const int normalized_dims = cuda_kernel_->normalized_dims_;
+    const int persistent_factor = cuda_kernel_->persistent_factor_;
+
+    std::vector<TensorView*> tvs;
+    size_t n_dims = 0;
+    for (auto val : fusion->deterministic_vals()) {
+      if (val->getValType().value() == ValType::TensorView &&
+          !fusion->hasInput(val)) {
+        tvs.push_back(val->as<TensorView>());
+        n_dims = std::max(n_dims, tvs.back()->nDims());
+      }
+    }
+
+    std::vector<TensorView*> reductions;
+    for (auto tv : tvs) {
+      // The results of a reduction, e.g., the mean of a row, have no row.
+      const int row_dims = tv->nDims() == n_dims ? normalized_dims : 0;
+      // Merge the row, then the rest.
+      for (int i = 1; i < row_dims; i++) {
+        tv->merge(-2, -1);
+      }
+      while ((int)tv->nDims() > (row_dims > 0 ? 2 : 1)) {
+        tv->merge(0, 1);
+      }
+      if (row_dims == 0 || tv->axis(-1)->isBroadcast()) {
+        continue;
+      }
+      tv->split(-1, persistent_factor);
+      if (tv->axis(-1)->isReduction()) {
+        reductions.push_back(tv);
+      }
+    }
+    // The part of the row of each thread is reduced serially by the rfactor,
+    // the parts by a block reduction.
+    for (auto tv : reductions) {
+      tvs.push_back(tv->rFactor({-1}));
+    }
+
+    for (auto tv : tvs) {
+      tv->axis(0)->parallelize(ParallelType::BIDx);
+      if (tv->nDims() > 1) {
+        tv->axis(1)->parallelize(ParallelType::TIDx);
+      }
+    }
+  }
+
   static bool canParseNode(const Node* node) {
     if (init_registry_) {
       // TODO: mutex this guy;
@@ -342,22 +512,32 @@ class IrParser {
     return jit_reduction_op_registry_.count(node->kind());
   }
 
-  // TODO: is_reduction is too hacky here. we should categorize operation types
-  //       based on their memory accessing pattern, which would affect fusion
-  //       strategy and partition logic.
+  static bool isNormalizationNode(const Node* node) {
+    if (init_registry_) {
+      // TODO: mutex this guy;
+      registerJitOperator();
+      init_registry_ = false;
+    }
+
+    return jit_normalization_op_registry_.count(node->kind());
+  }
+
   static void registerParseRule(
       std::shared_ptr<Operator>& op,
       ParseFuncPtr parse_fn,
       MergeQueryFuncPtr merge_query_fn = nullptr,
-      bool is_reduction = false) {
+      OperatorType op_type = OperatorType::ElementWise) {
     jit_operator_registry_[Symbol::fromQualString(op->schema().name())]
         .emplace_back(
             std::piecewise_construct,
             std::forward_as_tuple(op),
             std::forward_as_tuple(parse_fn, merge_query_fn));
-    if (is_reduction) {
+    if (op_type == OperatorType::Reduction) {
       jit_reduction_op_registry_.emplace(
           Symbol::fromQualString(op->schema().name()));
+    } else if (op_type == OperatorType::Normalization) {
+      jit_normalization_op_registry_.emplace(
+          Symbol::fromQualString(op->schema().name()));
     }
   }
 
@@ -685,7 +865,86 @@ class IrParser {
             }
             return true;
           },
-          true);
+          OperatorType::Reduction);
+    }
+
+    std::array<const char*, 2> Softmax = {
+        "aten::softmax.int(Tensor self, int dim, ScalarType? dtype=None) -> Tensor",
+        "aten::log_softmax.int(Tensor self, int dim, ScalarType? dtype=None) -> Tensor"};
+    for (auto signature : Softmax) {
+      auto ptr_op = getOperatorForLiteral(signature);
+      registerParseRule(
+          ptr_op,
+          [](const Node* node,
+             std::unordered_map<size_t, CgValue>& value_map) -> void {
+            auto self = value_map[node->input(0)->unique()];
+            auto out = softmaxOp(
+                self->as<TensorView>(), node->kind() == aten::log_softmax);
+            value_map.emplace(node->output()->unique(), out);
+          },
+          [](const Node* node) -> bool {
+            // we don't support cast of output types yet;
+            if (!node->inputs()[2]->type()->isSubtypeOf(
+                    static_cast<c10::TypePtr>(NoneType::get()))) {
+              return false;
+            }
+            // we only normalize the innermost dimension;
+            auto type = node->input(0)->type()->cast<TensorType>();
+            auto dim = constant_as<int64_t>(node->input(1));
+            if (!type || !type->dim().has_value() || *type->dim() < 2 ||
+                !dim.has_value() ||
+                (*dim != -1 && *dim != (int64_t)*type->dim() - 1)) {
+              return false;
+            }
+            return fitsNormalizationKernel(type, 1);
+          },
+          OperatorType::Normalization);
+    }
+
+    {
+      auto ptr_op = getOperatorForLiteral(
+          "aten::layer_norm(Tensor input, int[] normalized_shape, Tensor? weight=None, Tensor? bias=None, float eps=1e-05, bool cudnn_enable=True) -> Tensor");
+      registerParseRule(
+          ptr_op,
+          [](const Node* node,
+             std::unordered_map<size_t, CgValue>& value_map) -> void {
+            auto input = value_map[node->input(0)->unique()];
+            auto normalized_shape =
+                constant_as<c10::List<int64_t>>(node->input(1));
+            TORCH_INTERNAL_ASSERT(
+                normalized_shape.has_value(),
+                "requires static normalized shape");
+            auto weight =
+                node->input(2)->type()->isSubtypeOf(
+                    static_cast<c10::TypePtr>(NoneType::get()))
+                ? nullptr
+                : value_map[node->input(2)->unique()]->as<TensorView>();
+            auto bias = node->input(3)->type()->isSubtypeOf(
+                            static_cast<c10::TypePtr>(NoneType::get()))
+                ? nullptr
+                : value_map[node->input(3)->unique()]->as<TensorView>();
+            auto eps = value_map[node->input(4)->unique()];
+            auto out = layerNormOp(
+                input->as<TensorView>(),
+                normalized_shape->size(),
+                weight,
+                bias,
+                eps);
+            value_map.emplace(node->output()->unique(), out);
+          },
+          [](const Node* node) -> bool {
+            // we don't support dynamic normalized shape;
+            auto normalized_shape =
+                constant_as<c10::List<int64_t>>(node->input(1));
+            auto type = node->input(0)->type()->cast<TensorType>();
+            if (!normalized_shape.has_value() || normalized_shape->empty() ||
+                !type || !type->dim().has_value() ||
+                *type->dim() <= normalized_shape->size()) {
+              return false;
+            }
+            return fitsNormalizationKernel(type, normalized_shape->size());
+          },
+          OperatorType::Normalization);
     }
   }
 
@@ -799,6 +1058,7 @@ class IrParser {
       std::vector<std::pair<std::shared_ptr<Operator>, RegistrationEntry>>>
       jit_operator_registry_;
   static std::unordered_set<Symbol> jit_reduction_op_registry_;
+  static std::unordered_set<Symbol> jit_normalization_op_registry_;
   static bool init_registry_;
 };
 
@@ -808,6 +1068,7 @@ std::unordered_map<
         std::pair<std::shared_ptr<Operator>, IrParser::RegistrationEntry>>>
     IrParser::jit_operator_registry_;
 std::unordered_set<Symbol> IrParser::jit_reduction_op_registry_;
+std::unordered_set<Symbol> IrParser::jit_normalization_op_registry_;
 bool IrParser::init_registry_ = true;
 
 } // namespace
@@ -830,6 +1091,53 @@ bool isReductionNode(const Node* node) {
   return IrParser::isReductionNode(node);
 }
 
+bool isNormalizationNode(const Node* node) {
+  return IrParser::isNormalizationNode(node);
+}
+
+int normalizedDims(const Node* node) {
+  if (node->kind() == prim::CudaFusionGroup) {
+    return normalizedDims(node->g(attr::Subgraph)->block());
+  }
+  if (!isNormalizationNode(node)) {
+    return 0;
+  }
+  if (node->kind() == aten::layer_norm) {
+    auto normalized_shape = constant_as<c10::List<int64_t>>(node->input(1));
+    return normalized_shape.has_value() ? normalized_shape->size() : -1;
+  }
+  // softmax and log_softmax normalize the innermost dimension.
+  return 1;
+}
+
+int normalizedDims(const Block* block) {
+  int normalized_dims = 0;
+  for (auto node : block->nodes()) {
+    int node_dims = normalizedDims(node);
+    if (node_dims == 0) {
+      continue;
+    }
+    if (node_dims < 0 ||
+        (normalized_dims != 0 && normalized_dims != node_dims)) {
+      return -1;
+    }
+    normalized_dims = node_dims;
+  }
+  return normalized_dims;
+}
+
+int persistentFactor(int64_t row_size) {
+  int factor = 1;
+  while (factor < kMaxPersistentFactor &&
+         (row_size + factor - 1) / factor > kNormalizationThreadX) {
+    factor *= 2;
+  }
+  if ((row_size + factor - 1) / factor > kMaxNormalizationThreadX) {
+    return -1;
+  }
+  return factor;
+}
+
 bool isNodeParsible(const Node* node) {
   return IrParser::canParseNode(node);
 }
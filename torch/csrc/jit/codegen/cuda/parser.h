@@ -27,14 +27,39 @@ namespace fuser {
 namespace cuda {
 
 constexpr int kPwThreadX = 128;
+// elements of the global memory accesses of vectorized pointwise kernels;
+constexpr int kPwVectorWidth = 4;
 constexpr int kFcdReductionThreadX = 128;
 constexpr int kNonFcdReductionThreadX = 32;
 constexpr int kNonFcdReductionThreadY = 32;
+// A normalization kernel runs a block per row, with about
+// kNormalizationThreadX threads for the rows that are small enough. The
+// threads of longer rows hold more of them, up to kMaxPersistentFactor
+// elements each, as long as the block has at most kMaxNormalizationThreadX
+// threads, which is what the shared memory of the block reductions holds.
+constexpr int kNormalizationThreadX = 256;
+constexpr int kMaxNormalizationThreadX = 1024;
+constexpr int kMaxPersistentFactor = 32;
 
 TORCH_CUDA_API bool hasReductionNode(const Block* block);
 
 TORCH_CUDA_API bool isReductionNode(const Node* node);
 
+// A normalization, e.g., softmax or layer_norm, reduces the innermost
+// dimensions of its input and broadcasts the result back to it, which a
+// fusion does in a single kernel that keeps the rows in registers.
+TORCH_CUDA_API bool isNormalizationNode(const Node* node);
+
+// The number of innermost dimensions the normalizations of `block` (or of
+// the fusion groups in it) normalize, 0 if it has none, or -1 if they don't
+// agree.
+TORCH_CUDA_API int normalizedDims(const Block* block);
+TORCH_CUDA_API int normalizedDims(const Node* node);
+
+// The number of elements of a row of `row_size` elements each thread of a
+// normalization kernel holds, or -1 if the row is too large for it.
+TORCH_CUDA_API int persistentFactor(int64_t row_size);
+
 // returns whether or not a parsing function exists for the given node type.
 TORCH_CUDA_API bool isNodeParsible(const Node* node);
 
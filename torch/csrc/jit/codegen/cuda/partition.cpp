@@ -71,6 +71,26 @@ bool hasReductionOperation(const Node* node) {
   return false;
 }
 
+// A fusion is scheduled as a single normalization kernel, which neither
+// supports reductions nor normalizations of different numbers of dimensions.
+bool isCompatibleNormalization(const Node* fusion, const Node* node) {
+  const int fusion_dims = normalizedDims(fusion);
+  const int node_dims = normalizedDims(node);
+  if (fusion_dims < 0 || node_dims < 0) {
+    return false;
+  }
+  if (fusion_dims != 0 && node_dims != 0 && fusion_dims != node_dims) {
+    return false;
+  }
+  if (node_dims != 0 && hasReductionOperation(fusion)) {
+    return false;
+  }
+  if (fusion_dims != 0 && hasReductionOperation(node)) {
+    return false;
+  }
+  return true;
+}
+
 } // namespace
 
 bool isFusableCudaFusionGroup(const Node* node) {
@@ -83,7 +103,8 @@ bool isFusableCudaFusionGroup(const Node* node) {
 bool isFusableCudaFusionGroup(const Node* fusion, const Node* node) {
   // TODO: lift the restriction of not fusing producer containing reduction when
   //       we have proper scheduling.
-  if (isFusableCudaFusionGroup(node) && !hasReductionOperation(node)) {
+  if (isFusableCudaFusionGroup(node) && !hasReductionOperation(node) &&
+      isCompatibleNormalization(fusion, node)) {
     // TODO: ensure legit fusion.
     // issue 0: currently codegen doesn't support broadcasting, except in the
     //          form of stride 0.
@@ -4,6 +4,7 @@
 #include <ATen/ExpandUtils.h>
 #include <ATen/core/functional.h>
 #include <ATen/core/stack.h>
+#include <c10/util/Metrics.h>
 #include <c10/util/Optional.h>
 #include <torch/csrc/jit/codegen/fuser/compiler.h>
 #include <torch/csrc/jit/codegen/fuser/interface.h>
@@ -12,6 +13,7 @@
 #include <torch/csrc/jit/codegen/fuser/tensor_info.h>
 
 #include <algorithm>
+#include <chrono>
 #include <iostream> // TODO: remove, debugging only
 #include <map>
 #include <stdexcept>
@@ -380,8 +382,20 @@ bool runFusion(const int64_t key, Stack& stack, std::string* code_out) {
   ArgSpec arg_spec{inputs, device.index()};
   auto maybe_kernel = spec.findKernel(arg_spec);
   if (!maybe_kernel) {
+    const auto start = std::chrono::steady_clock::now();
     const auto kernel = compileKernel(spec, arg_spec, *maybe_map_size, device);
     spec.cacheKernel(arg_spec, kernel);
+    C10_METRICS_HISTOGRAM_RECORD(
+        "torch_jit_fuser_compilation_us",
+        "Time the fuser took to compile a kernel, one per cache miss",
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count());
+  } else {
+    C10_METRICS_COUNTER_ADD(
+        "torch_jit_fuser_kernel_cache_hits_total",
+        "Fused kernels found compiled for their inputs",
+        1);
   }
   maybe_kernel = spec.findKernel(arg_spec);
   AT_ASSERT(maybe_kernel);
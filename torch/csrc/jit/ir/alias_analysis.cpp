@@ -1,6 +1,7 @@
 #include <torch/csrc/jit/ir/alias_analysis.h>
 
 #include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/passes/pass_manager.h>
 #include <torch/csrc/jit/runtime/operator.h>
 #include <torch/csrc/utils/memory.h>
 
@@ -149,6 +150,7 @@ AliasDb::AliasDb(std::shared_ptr<Graph> graph, bool isFrozen)
       isFrozen_(isFrozen),
       memoryDAGBuilder_(std::make_unique<MemoryDAGBuilder>()),
       writeRegistry_(std::make_unique<AliasDb::WriteRegistry>()) {
+  PassTimingGuard timer("AliasDb");
   analyze(graph_);
 
   memoryDAG_ = std::make_unique<MemoryDAG>(std::move(memoryDAGBuilder_));
@@ -491,6 +493,7 @@ void AliasDb::analyzeImpl(Node* node) {
     case prim::FusedConcat:
     case prim::MMTreeReduce:
     case prim::MMBatchSide:
+    case prim::BatchedGEMM:
     case prim::BroadcastSizes:
     case prim::ChunkSizes:
     case prim::Function:
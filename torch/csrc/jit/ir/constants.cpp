@@ -70,8 +70,9 @@ c10::optional<Value*> tryInsertConstant(
   Node* n = g.create(prim::Constant);
   if (val.isTensor()) {
     at::Tensor ref = val.toTensor();
-    if (!ref.has_storage()) {
-      // bail if tensor has no storage i.e. opaque tensor used in MKLdnn.
+    if (!ref.has_storage() && !ref.is_mkldnn()) {
+      // bail if tensor has no storage i.e. opaque tensor, except for the
+      // MKL-DNN weights of ConvertFrozenOpsToMKLDNN.
       n->destroy();
       return c10::nullopt;
     }
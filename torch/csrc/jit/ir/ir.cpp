@@ -102,6 +102,10 @@ std::ostream& operator<<(
 }
 
 static void printAttribute(std::ostream& out, const at::Tensor& tensor) {
+  if (tensor.is_mkldnn()) {
+    out << "<MKLDNN Tensor>";
+    return;
+  }
   // 1-elem tensors are usually boxed scalars, so print them like it
   if (tensor.numel() == 1) {
     auto scalar_tensor = tensor.view({}).item();
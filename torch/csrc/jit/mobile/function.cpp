@@ -27,32 +27,82 @@ void Function::append_instruction(OpCode op, int X, int N) {
   code_->instructions_.emplace_back(op, X, N);
 }
 
-bool Function::append_operator(
-    const std::string& name,
-    const std::string& overload_name) {
-  // Keep the original opname in code_
-  code_->op_names_.emplace_back(name, overload_name);
-  auto opname = code_->op_names_.back();
-
-  auto opname_c10 = opname;
-  std::function<void(Stack&)> fn;
-
+c10::optional<OperatorFunction> resolveOperator(
+    const c10::OperatorName& opname) {
   auto jit_op = findOperatorFor(opname);
   if (jit_op) {
-    fn = [jit_op](Stack& stack) { jit_op->getOperation()(&stack); };
-  } else {
-    auto op = c10::Dispatcher::singleton().findSchema(opname_c10);
-    if (op.has_value()) {
-      fn = [op](Stack& stack) { op->callBoxed(&stack); };
-    } else {
-      return false;
+    return OperatorFunction(
+        [jit_op](Stack& stack) { jit_op->getOperation()(&stack); });
+  }
+  auto op = c10::Dispatcher::singleton().findSchema(opname);
+  if (op.has_value()) {
+    return OperatorFunction([op](Stack& stack) { op->callBoxed(&stack); });
+  }
+  return c10::nullopt;
+}
+
+c10::optional<OutVariant> resolveOutVariant(const c10::OperatorName& opname) {
+  auto op = c10::Dispatcher::singleton().findSchema(opname);
+  if (!op.has_value()) {
+    return c10::nullopt;
+  }
+  auto out_op = c10::Dispatcher::singleton().findSchema({opname.name, "out"});
+  if (!out_op.has_value()) {
+    return c10::nullopt;
+  }
+  const auto& schema = op->schema();
+  const auto& out_schema = out_op->schema();
+  const auto& args = schema.arguments();
+  const auto& out_args = out_schema.arguments();
+  auto is_tensor = [](const c10::Argument& arg) {
+    return *arg.type() == *c10::TensorType::get();
+  };
+  if (schema.is_mutable() || schema.is_vararg() ||
+      schema.returns().size() != 1 || !is_tensor(schema.returns()[0]) ||
+      schema.returns()[0].alias_info() || out_args.size() != args.size() + 1 ||
+      out_schema.returns().size() != 1) {
+    return c10::nullopt;
+  }
+  for (size_t i = 0; i < args.size(); ++i) {
+    if (args[i].name() != out_args[i].name() ||
+        *args[i].type() != *out_args[i].type()) {
+      return c10::nullopt;
     }
   }
+  const auto& out_arg = out_args.back();
+  if (!is_tensor(out_arg) || !out_arg.alias_info() ||
+      !out_arg.alias_info()->isWrite()) {
+    return c10::nullopt;
+  }
+  return OutVariant{[out_op](Stack& stack) { out_op->callBoxed(&stack); },
+                    args.size()};
+}
 
-  code_->operators_.emplace_back(fn);
+bool Function::append_operator(
+    const std::string& name,
+    const std::string& overload_name) {
+  c10::OperatorName opname(name, overload_name);
+  auto fn = resolveOperator(opname);
+  if (!fn) {
+    // Keep the original opname in code_
+    code_->op_names_.push_back(std::move(opname));
+    return false;
+  }
+  append_operator(std::move(opname), std::move(*fn));
   return true;
 }
 
+void Function::append_operator(c10::OperatorName opname, OperatorFunction fn) {
+  // Keep the original opname in code_
+  code_->op_names_.push_back(std::move(opname));
+  code_->operators_.push_back(std::move(fn));
+}
+
+void Function::append_out_variant(c10::optional<OutVariant> out_variant) {
+  code_->out_variants_.resize(code_->operators_.size() - 1);
+  code_->out_variants_.push_back(std::move(out_variant));
+}
+
 void Function::set_module_debug_info_list_size(size_t size) {
   pc_to_module_debug_info_.resize(size);
   for (size_t i = 0; i < size; ++i) {
@@ -79,6 +129,15 @@ void Function::set_register_size(size_t size) {
   code_->register_size_ = size;
 }
 
+void Function::plan_memory() {
+  code_->memory_plan_ = planMemory(*code_);
+}
+
+MemoryStats Function::memory_stats() const {
+  std::lock_guard<std::mutex> lock(memory_stats_mutex_);
+  return memory_stats_;
+}
+
 std::string Function::get_module_debug_info(size_t pc) const {
   TORCH_CHECK(
       pc < pc_to_module_debug_info_.size(),
@@ -87,8 +146,22 @@ std::string Function::get_module_debug_info(size_t pc) const {
 }
 
 bool Function::run(Stack& stack) const {
-  InterpreterState interp_state(code_);
-  return interp_state.run(stack);
+  // A run starting while another one uses the arena runs without the plan.
+  if (code_->memory_plan_.num_slots == 0 || arena_in_use_.exchange(true)) {
+    InterpreterState interp_state(code_);
+    return interp_state.run(stack);
+  }
+  struct ArenaGuard {
+    ~ArenaGuard() {
+      in_use.store(false);
+    }
+    std::atomic<bool>& in_use;
+  } guard{arena_in_use_};
+  InterpreterState interp_state(code_, &arena_);
+  bool result = interp_state.run(stack);
+  std::lock_guard<std::mutex> lock(memory_stats_mutex_);
+  memory_stats_ = arena_.stats;
+  return result;
 }
 
 } // namespace mobile
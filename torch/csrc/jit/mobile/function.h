@@ -1,6 +1,10 @@
 #pragma once
 #include <ATen/core/ivalue.h>
-//#include <aten/src/Aten/core/operator_name.h>
+#include <ATen/core/operator_name.h>
+#include <torch/csrc/jit/mobile/interpreter.h>
+
+#include <atomic>
+#include <mutex>
 #include <vector>
 
 namespace torch {
@@ -9,7 +13,16 @@ using Stack = std::vector<c10::IValue>;
 enum OpCode : uint8_t;
 
 namespace mobile {
-struct Code;
+using OperatorFunction = std::function<void(Stack&)>;
+
+// The function running the operator `opname`, a JIT operator or else one of
+// the dispatcher, or nullopt if there is none.
+c10::optional<OperatorFunction> resolveOperator(
+    const c10::OperatorName& opname);
+
+// The out variant of `opname` if it is a functional operator returning a
+// tensor with an `out` overload taking the same arguments, or nullopt.
+c10::optional<OutVariant> resolveOutVariant(const c10::OperatorName& opname);
 
 class Function {
  public:
@@ -21,12 +34,22 @@ class Function {
   bool append_operator(
       const std::string& name,
       const std::string& overload_name);
+  // Appends an operator already resolved by resolveOperator, so that the
+  // functions of a module resolve each of their operators only once.
+  void append_operator(c10::OperatorName opname, OperatorFunction fn);
+  // Appends the out variant of the last appended operator, if it has one.
+  void append_out_variant(c10::optional<OutVariant> out_variant);
   void set_module_debug_info_list_size(size_t size);
   void set_module_info(const std::string& module_info, size_t pc);
   void append_constant(const c10::IValue& constant);
   void append_type(const c10::TypePtr& type);
 
   void set_register_size(size_t size);
+  // Plans the memory of the results of the operators with an out variant,
+  // once all the instructions and operators are appended.
+  void plan_memory();
+  // The memory of the last run that used the arena of the function.
+  MemoryStats memory_stats() const;
 
   std::string get_module_debug_info(size_t pc) const;
 
@@ -34,6 +57,11 @@ class Function {
   c10::QualifiedName name_;
   std::shared_ptr<Code> code_;
   std::vector<std::string> pc_to_module_debug_info_;
+  // The arena of the memory plan, used by one run at a time.
+  mutable MemoryArena arena_;
+  mutable std::atomic<bool> arena_in_use_{false};
+  mutable std::mutex memory_stats_mutex_;
+  mutable MemoryStats memory_stats_;
 };
 
 } // namespace mobile
@@ -1,6 +1,7 @@
 #include <torch/csrc/jit/mobile/import.h>
 #include <ATen/core/ivalue.h>
 #include <caffe2/serialize/inline_container.h>
+#include <caffe2/serialize/mmap_file_adapter.h>
 #include <torch/csrc/jit/api/compilation_unit.h>
 #include <torch/csrc/jit/mobile/observer.h>
 #include <torch/csrc/jit/mobile/type_parser.h>
@@ -9,9 +10,11 @@
 #include <torch/csrc/jit/serialization/unpickler.h>
 #include <torch/custom_class.h>
 
+#include <chrono>
 #include <exception>
 #include <fstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 // The import process to serialize the bytecode package.
@@ -47,6 +50,7 @@ TypePtr parseType(const std::string& pythonStr);
 namespace torch {
 namespace jit {
 using caffe2::serialize::IStreamAdapter;
+using caffe2::serialize::MmapFileAdapter;
 using caffe2::serialize::PyTorchStreamReader;
 using caffe2::serialize::ReadAdapterInterface;
 
@@ -87,7 +91,14 @@ void print_unsupported_ops_and_throw(
   TORCH_CHECK(false, "Following ops cannot be found:", error_message);
 }
 
-void parseMethods(
+int64_t microsecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+// Returns the microseconds spent resolving the operators.
+int64_t parseMethods(
     const std::vector<IValue>& vals,
     const c10::optional<std::vector<IValue>>& debug_info_vals,
     mobile::CompilationUnit& mcu) {
@@ -116,6 +127,17 @@ void parseMethods(
         "The numbers of bytecode values and debug info values do not match.");
   }
 
+  // The methods of a module share most of their operators, so they are
+  // resolved once for the whole module.
+  std::unordered_map<c10::OperatorName, mobile::OperatorFunction>
+      resolved_ops;
+  std::unordered_map<c10::OperatorName, c10::optional<mobile::OutVariant>>
+      resolved_out_variants;
+  int64_t resolve_us = 0;
+  // The pickler memoizes strings, so all the instructions with the same
+  // opcode share the string of their name.
+  std::unordered_map<const c10::ivalue::ConstantString*, OpCode> opcodes;
+
   for (size_t i = method_i_start; i < vals.size(); ++i) {
     const auto& element = vals[i];
     const auto& m_tuple = element.toTuple()->elements();
@@ -166,12 +188,19 @@ void parseMethods(
 
     function->set_module_debug_info_list_size(ins_list.size());
     for (size_t i = 0; i < ins_list.size(); ++i) {
-      auto ins_item = ins_list[i].toTuple()->elements();
+      const auto& ins_item = ins_list[i].toTuple()->elements();
       TORCH_CHECK(
           ins_item.size() == 3,
           "There should be three parts in an instruction. The function name is ",
           function_name);
-      OpCode op_code = parseOpCode(ins_item[0].toString()->string().c_str());
+      const auto* op_str = ins_item[0].toString().get();
+      auto opcode_it = opcodes.find(op_str);
+      if (opcode_it == opcodes.end()) {
+        opcode_it =
+            opcodes.emplace(op_str, parseOpCode(op_str->string().c_str()))
+                .first;
+      }
+      OpCode op_code = opcode_it->second;
       int X = ins_item[1].toInt();
       int N = ins_item[2].toInt();
       function->append_instruction(op_code, X, N);
@@ -185,16 +214,34 @@ void parseMethods(
 
     std::unordered_set<std::string> unsupported_op_names;
     for (const auto& op : ops_list) {
-      auto op_item = op.toTuple()->elements();
+      const auto& op_item = op.toTuple()->elements();
       TORCH_CHECK(
           op_item.size() == 2,
           "There should be two parts in an operator name.");
-      auto op_found = function->append_operator(
-          op_item[0].toString()->string(), op_item[1].toString()->string());
-      if (!op_found) {
-        unsupported_op_names.emplace(operator_str(
-            op_item[0].toString()->string(), op_item[1].toString()->string()));
+      c10::OperatorName opname(
+          op_item[0].toStringRef(), op_item[1].toStringRef());
+      auto it = resolved_ops.find(opname);
+      if (it == resolved_ops.end()) {
+        auto start = std::chrono::steady_clock::now();
+        auto fn = mobile::resolveOperator(opname);
+        resolve_us += microsecondsSince(start);
+        if (!fn) {
+          unsupported_op_names.emplace(
+              operator_str(opname.name, opname.overload_name));
+          continue;
+        }
+        it = resolved_ops.emplace(opname, std::move(*fn)).first;
       }
+      auto out_it = resolved_out_variants.find(opname);
+      if (out_it == resolved_out_variants.end()) {
+        auto start = std::chrono::steady_clock::now();
+        out_it = resolved_out_variants
+                     .emplace(opname, mobile::resolveOutVariant(opname))
+                     .first;
+        resolve_us += microsecondsSince(start);
+      }
+      function->append_operator(std::move(opname), it->second);
+      function->append_out_variant(out_it->second);
     }
     if (!unsupported_op_names.empty()) {
       print_unsupported_ops_and_throw(unsupported_op_names);
@@ -209,9 +256,11 @@ void parseMethods(
     }
 
     function->set_register_size(register_size);
+    function->plan_memory();
 
     mcu.register_function(std::move(function));
   }
+  return resolve_us;
 }
 
 // The deserializer class which loads the bytecode package from bc files.
@@ -238,6 +287,8 @@ BytecodeDeserializer::BytecodeDeserializer(
 mobile::Module BytecodeDeserializer::deserialize(
     c10::optional<at::Device> device) {
   device_ = device;
+  auto observer = torch::observerConfig().getModuleObserver();
+  auto start = std::chrono::steady_clock::now();
   auto mcu = std::make_shared<mobile::CompilationUnit>();
   auto bvals = readArchive("bytecode", mcu).toTuple()->elements();
 
@@ -245,9 +296,22 @@ mobile::Module BytecodeDeserializer::deserialize(
   if (reader_->hasRecord("mobile_debug.pkl")) {
     debug_info_bvals = readArchive("mobile_debug", mcu).toTuple()->elements();
   }
-  parseMethods(bvals, debug_info_bvals, *mcu);
+  if (observer) {
+    observer->onLoadModelStage("bytecode", microsecondsSince(start));
+    start = std::chrono::steady_clock::now();
+  }
+  int64_t resolve_us = parseMethods(bvals, debug_info_bvals, *mcu);
+  if (observer) {
+    observer->onLoadModelStage("methods", microsecondsSince(start));
+    observer->onLoadModelStage("operators", resolve_us);
+    start = std::chrono::steady_clock::now();
+  }
 
-  return mobile::Module(readArchive("data", mcu).toObject(), mcu);
+  auto data = readArchive("data", mcu).toObject();
+  if (observer) {
+    observer->onLoadModelStage("data", microsecondsSince(start));
+  }
+  return mobile::Module(std::move(data), mcu);
 }
 
 c10::IValue BytecodeDeserializer::readArchive(
@@ -364,6 +428,14 @@ mobile::Module _load_for_mobile(
   return module;
 }
 
+mobile::Module _load_for_mobile_mmap(
+    const std::string& filename,
+    c10::optional<at::Device> device) {
+  std::unique_ptr<MmapFileAdapter> rai =
+      std::make_unique<MmapFileAdapter>(filename);
+  return _load_for_mobile(std::move(rai), device);
+}
+
 mobile::Module _load_for_mobile(
     std::unique_ptr<ReadAdapterInterface> rai,
     c10::optional<c10::Device> device) {
@@ -23,5 +23,12 @@ TORCH_API mobile::Module _load_for_mobile(
 TORCH_API mobile::Module _load_for_mobile(
     std::unique_ptr<ReadAdapterInterface> rai,
     c10::optional<c10::Device> device = c10::nullopt);
+
+// Loads the module of `filename` through a memory mapping of the file, its
+// tensors being stored in the mapped pages instead of copies; see
+// torch::jit::load_mmap.
+TORCH_API mobile::Module _load_for_mobile_mmap(
+    const std::string& filename,
+    c10::optional<at::Device> device = c10::nullopt);
 } // namespace jit
 } // namespace torch
@@ -1,5 +1,6 @@
 #include <torch/csrc/jit/mobile/interpreter.h>
 #include <ATen/core/function.h>
+#include <ATen/core/grad_mode.h>
 #include <ATen/core/jit_type.h>
 #include <ATen/core/operator_name.h>
 #include <torch/csrc/jit/mobile/function.h>
@@ -8,18 +9,181 @@
 #include <ATen/record_function.h>
 #include <torch/csrc/jit/mobile/observer.h>
 
+#include <algorithm>
+
 namespace torch {
 namespace jit {
 char const* toString(OpCode op);
 std::ostream& operator<<(std::ostream& out, Instruction inst);
 namespace mobile {
-InterpreterState::InterpreterState(std::shared_ptr<Code> code)
-    : code_(std::move(code)) {
+
+MemoryPlan planMemory(const Code& code) {
+  const auto& instructions = code.instructions_;
+  MemoryPlan plan;
+  plan.slots.assign(instructions.size(), -1);
+
+  // The pc of the last instruction referring to each register.
+  std::vector<size_t> last_use(code.register_size_ + 1, 0);
+  auto use = [&](int64_t reg, size_t pc) {
+    if (reg > 0 && reg < static_cast<int64_t>(last_use.size())) {
+      last_use[reg] = pc;
+    }
+  };
+  for (size_t pc = 0; pc < instructions.size(); ++pc) {
+    const auto& inst = instructions[pc];
+    switch (inst.op) {
+      case LOAD:
+      case MOVE:
+      case STORE:
+      case DROPR:
+        use(inst.X, pc);
+        break;
+      case STOREN:
+        for (int64_t i = 0; i < inst.N; ++i) {
+          use(inst.X + i, pc);
+        }
+        break;
+      default:
+        break;
+    }
+  }
+
+  // A tensor the last use of its register pushes on the stack lives until the
+  // operator consuming it runs.
+  std::vector<size_t> next_op(instructions.size() + 1, instructions.size());
+  for (size_t pc = instructions.size(); pc > 0; --pc) {
+    auto op = instructions[pc - 1].op;
+    next_op[pc - 1] = (op == OP || op == OPN) ? pc - 1 : next_op[pc];
+  }
+
+  // The slots are assigned greedily in the order of the instructions, a slot
+  // being free again once the tensor of its register is dead.
+  std::vector<size_t> slot_ends;
+  for (size_t pc = 0; pc + 1 < instructions.size(); ++pc) {
+    const auto& inst = instructions[pc];
+    const auto& next = instructions[pc + 1];
+    if (inst.op != OP || next.op != STORE || inst.X < 0 ||
+        static_cast<size_t>(inst.X) >= code.out_variants_.size() ||
+        !code.out_variants_[inst.X] || next.X <= 0 ||
+        static_cast<size_t>(next.X) >= last_use.size()) {
+      continue;
+    }
+    size_t end = next_op[std::max(last_use[next.X], pc + 1)];
+    size_t slot = 0;
+    while (slot < slot_ends.size() && slot_ends[slot] >= pc) {
+      ++slot;
+    }
+    if (slot == slot_ends.size()) {
+      slot_ends.push_back(end);
+    } else {
+      slot_ends[slot] = end;
+    }
+    plan.slots[pc] = slot;
+  }
+  plan.num_slots = slot_ends.size();
+  return plan;
+}
+
+InterpreterState::InterpreterState(
+    std::shared_ptr<Code> code,
+    MemoryArena* arena)
+    : code_(std::move(code)), arena_(arena) {
   registers_.resize(code_->register_size_);
+  if (arena_) {
+    arena_->slots.resize(code_->memory_plan_.num_slots);
+    arena_->result_types.resize(
+        code_->instructions_.size(), c10::ScalarType::Undefined);
+    arena_->input_types.resize(code_->instructions_.size());
+    arena_->stats = MemoryStats();
+  }
 }
 
 using namespace at;
 
+namespace {
+
+// The out variants don't support autograd.
+bool inputsRequireGrad(const Stack& stack, size_t num_inputs) {
+  if (!at::GradMode::is_enabled()) {
+    return false;
+  }
+  for (auto it = stack.end() - num_inputs; it != stack.end(); ++it) {
+    if (it->isTensor() && it->toTensor().requires_grad()) {
+      return true;
+    }
+    if (it->isTensorList()) {
+      for (const at::Tensor& t : it->toTensorVector()) {
+        if (t.requires_grad()) {
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+// The dtypes of the tensor inputs and whether they are zero-dimensional,
+// which also matters to type promotion.
+uint64_t inputTypes(const Stack& stack, size_t num_inputs) {
+  uint64_t key = 0;
+  auto add = [&key](const at::Tensor& t) {
+    int64_t type = t.defined() ? static_cast<int64_t>(t.scalar_type()) : -1;
+    key = key * 131 + (type + 1) * 2 + (t.defined() && t.dim() == 0);
+  };
+  for (auto it = stack.end() - num_inputs; it != stack.end(); ++it) {
+    if (it->isTensor()) {
+      add(it->toTensor());
+    } else if (it->isTensorList()) {
+      for (const at::Tensor& t : it->toTensorVector()) {
+        add(t);
+      }
+    }
+  }
+  return key;
+}
+
+size_t storageBytes(const at::Tensor& t) {
+  return t.defined() && t.has_storage() ? t.storage().nbytes() : 0;
+}
+
+} // namespace
+
+void InterpreterState::runPlannedOperator(
+    size_t pc,
+    const Instruction& inst,
+    Stack& stack) {
+  auto& slot = arena_->slots[code_->memory_plan_.slots[pc]];
+  auto& result_type = arena_->result_types[pc];
+  const auto& out_variant = *code_->out_variants_[inst.X];
+  auto input_types = inputTypes(stack, out_variant.num_inputs);
+  // The tensor of the slot is only written into when nothing else refers to
+  // it or to its storage, e.g., a register, a view or the caller of a
+  // previous run.
+  if (slot.defined() && slot.scalar_type() == result_type &&
+      arena_->input_types[pc] == input_types && slot.use_count() == 1 &&
+      slot.storage().use_count() == 1 &&
+      !inputsRequireGrad(stack, out_variant.num_inputs)) {
+    stack.emplace_back(slot);
+    out_variant.fn(stack);
+    return;
+  }
+
+  code_->operators_[inst.X](stack);
+  result_type = c10::ScalarType::Undefined;
+  if (!stack.back().isTensor()) {
+    return;
+  }
+  const auto& result = stack.back().toTensor();
+  arena_->stats.unplanned_bytes += storageBytes(result);
+  if (result.defined() && result.layout() == at::kStrided &&
+      result.device().is_cpu() && result.is_contiguous() &&
+      !result.requires_grad()) {
+    result_type = result.scalar_type();
+    arena_->input_types[pc] = input_types;
+    slot = result;
+  }
+}
+
 bool InterpreterState::run(Stack& stack) {
   size_t pc = 0;
   while (true) {
@@ -56,7 +220,11 @@ bool InterpreterState::run(Stack& stack) {
         if (!prev_value) {
           enableRecordFunction(false);
         }
-        code_->operators_[inst.X](stack);
+        if (arena_ && code_->memory_plan_.slots[pc] >= 0) {
+          runPlannedOperator(pc, inst, stack);
+        } else {
+          code_->operators_[inst.X](stack);
+        }
         ++pc;
       } break;
       case OPN: {
@@ -148,6 +316,11 @@ bool InterpreterState::run(Stack& stack) {
         }
       } break;
       case RET:
+        if (arena_) {
+          for (const auto& t : arena_->slots) {
+            arena_->stats.planned_bytes += storageBytes(t);
+          }
+        }
         return false;
       case LIST_CONSTRUCT: {
         auto type = code_->types_[inst.X]->expect<at::ListType>();
@@ -8,23 +8,82 @@ namespace torch {
 namespace jit {
 namespace mobile {
 using Stack = std::vector<c10::IValue>;
+
+// The out variant of an operator returning a tensor: the function of its
+// `out` overload, which takes the arguments of the operator followed by the
+// tensor to write the result into, and the number of those arguments.
+struct OutVariant {
+  std::function<void(Stack&)> fn;
+  size_t num_inputs;
+};
+
+// The slots of the arena into which the operators with an out variant write
+// the tensors they compute, when these are stored into a register. The
+// tensors of the registers whose lifetimes don't overlap share a slot.
+struct MemoryPlan {
+  // The slot of the result of the instruction at each pc, or -1.
+  std::vector<int64_t> slots;
+  size_t num_slots = 0;
+};
+
 struct Code {
   std::vector<Instruction> instructions_;
   std::vector<c10::OperatorName> op_names_;
   std::vector<std::function<void(Stack&)>> operators_;
+  // The out variant of each operator, if it has one.
+  std::vector<c10::optional<OutVariant>> out_variants_;
   std::vector<c10::IValue> constants_;
   std::vector<c10::TypePtr> types_;
   size_t register_size_; // Aggregated output size.
+  MemoryPlan memory_plan_;
+};
+
+// Plans the results of the OP instructions of `code` whose operator has an
+// out variant and whose result is stored into a register, from the first
+// and last instructions referring to each register. The plan doesn't need
+// to be exact, e.g., in loops, as a slot is only written into when nothing
+// but the arena refers to its tensor.
+TORCH_API MemoryPlan planMemory(const Code& code);
+
+struct MemoryStats {
+  // The bytes of the tensors held by the arena at the end of the last run.
+  size_t planned_bytes = 0;
+  // The bytes of the results of the planned instructions that the last run
+  // allocated instead of writing them into a slot.
+  size_t unplanned_bytes = 0;
+};
+
+// The tensors of the slots of a MemoryPlan, kept from one run of a function
+// to the next. A planned instruction writes its result into the tensor of its
+// slot with the out variant of its operator if the instruction computed a
+// contiguous CPU tensor of the same dtype, from inputs of the same dtypes, in
+// its previous run, and otherwise runs the operator and keeps its result in
+// the slot for the next ones.
+struct MemoryArena {
+  std::vector<at::Tensor> slots;
+  // The dtype of the result of each planned instruction in its last run, or
+  // Undefined if it can't be written into a slot.
+  std::vector<c10::ScalarType> result_types;
+  // A key of the dtypes of the inputs of each planned instruction in its
+  // last run, as they decide the dtype of the result.
+  std::vector<uint64_t> input_types;
+  MemoryStats stats;
 };
 
 struct InterpreterState {
-  TORCH_API explicit InterpreterState(std::shared_ptr<Code> code);
+  // The runs with an arena plan the results of the instructions of `code`
+  // into it; it must not be used by another run at the same time.
+  TORCH_API explicit InterpreterState(
+      std::shared_ptr<Code> code,
+      MemoryArena* arena = nullptr);
   TORCH_API bool run(Stack& stack);
 
  private:
   std::shared_ptr<Code> code_;
   c10::IValue& reg(size_t reg);
+  void runPlannedOperator(size_t pc, const Instruction& inst, Stack& stack);
   std::vector<c10::IValue> registers_;
+  MemoryArena* arena_;
 };
 
 } // namespace mobile
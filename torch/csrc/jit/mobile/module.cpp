@@ -4,6 +4,7 @@
 #include <torch/csrc/jit/runtime/jit_exception.h>
 #include <exception>
 
+#include <ATen/Parallel.h>
 #include <ATen/record_function.h>
 
 namespace torch {
@@ -52,11 +53,16 @@ c10::IValue Module::run_method(const std::string& method_name, Stack stack) {
     }
     AT_ERROR("Method '", method_name, "' is not defined.");
   }
+  if (num_threads_ > 0 && at::get_num_threads() != num_threads_) {
+    at::set_num_threads(num_threads_);
+  }
   try {
     stack.insert(stack.begin(), object_);
     m->run(stack);
     c10::IValue result = stack.front();
     if (observer) {
+      auto stats = m->memory_stats();
+      observer->onRunMethodMemory(stats.planned_bytes, stats.unplanned_bytes);
       observer->onExitRunMethod();
     }
     return result;
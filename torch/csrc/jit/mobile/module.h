@@ -51,10 +51,21 @@ class TORCH_API Module {
   }
   /// True if the module is in training mode.
   bool is_training() const;
+  /// Runs the methods of the module with `num_threads` intra-op threads. The
+  /// modules share the intra-op thread pool, whose size is set before a run
+  /// when it differs; 0, the default, leaves it as it is.
+  void set_num_threads(int num_threads) {
+    TORCH_CHECK(num_threads >= 0, "Expected a non-negative number of threads");
+    num_threads_ = num_threads;
+  }
+  int num_threads() const {
+    return num_threads_;
+  }
 
  private:
   c10::intrusive_ptr<c10::ivalue::Object> object_;
   std::shared_ptr<CompilationUnit> cu_;
+  int num_threads_ = 0;
 };
 } // namespace mobile
 } // namespace jit
@@ -50,6 +50,16 @@ class MobileModuleObserver {
   virtual void onEnterLoadModel() {}
   virtual void onExitLoadModel(const std::string&) {}
   virtual void onFailLoadModel(const std::string&) {}
+  // Called while a model loads with the microseconds spent in `stage`:
+  // "bytecode" to unpickle the bytecode, "methods" to build the methods from
+  // it, of which "operators" to resolve their operators, and "data" to
+  // unpickle the module and load its tensors.
+  virtual void onLoadModelStage(const std::string&, int64_t) {}
+  // Called before onExitRunMethod with the memory of the run: the bytes held
+  // by the arena of the method, into which the results of the operators with
+  // an out variant are planned, and the bytes of those results the run
+  // allocated outside of it, e.g., in the first run.
+  virtual void onRunMethodMemory(size_t, size_t) {}
 };
 
 class MobileObserverConfig {
@@ -93,37 +93,53 @@ Tensor SGD::step(const LossClosure& closure) {
     auto momentum = options.momentum();
     auto dampening = options.dampening();
     auto nesterov = options.nesterov();
+    auto lr = options.lr();
 
+    // The updates are done in place, with d_p = grad + weight_decay * p
+    // folded into them, so that a step allocates nothing but the momentum
+    // buffers of its first step, which later steps reuse.
     for (auto& p : group.params()) {
-      if (!p.grad().defined()) {
+      const auto& grad = p.grad();
+      if (!grad.defined()) {
         continue;
       }
-      auto d_p = p.grad().data();
-      if (weight_decay != 0) {
-        d_p = d_p.add(p.data(), weight_decay);
+      if (momentum == 0) {
+        if (weight_decay != 0) {
+          // p - lr * (grad + weight_decay * p)
+          p.mul_(1 - lr * weight_decay);
+        }
+        p.add_(grad, -lr);
+        continue;
       }
-      if (momentum != 0) {
-        Tensor buf;
-        auto param_state =
-            state_.find(c10::guts::to_string(p.unsafeGetTensorImpl()));
-        if (param_state == state_.end()) {
-          buf = torch::clone(d_p).detach();
-          auto state = std::make_unique<SGDParamState>();
-          state->momentum_buffer(buf);
-          state_[c10::guts::to_string(p.unsafeGetTensorImpl())] =
-              std::move(state);
-        } else {
-          buf = static_cast<SGDParamState&>(*param_state->second)
-                    .momentum_buffer();
-          buf.mul_(momentum).add_(d_p, 1 - dampening);
+
+      auto key = c10::guts::to_string(p.unsafeGetTensorImpl());
+      auto param_state = state_.find(key);
+      Tensor buf;
+      if (param_state == state_.end()) {
+        buf = torch::clone(grad).detach();
+        if (weight_decay != 0) {
+          buf.add_(p, weight_decay);
         }
-        if (nesterov) {
-          d_p = d_p.add(buf, momentum);
-        } else {
-          d_p = buf;
+        auto state = std::make_unique<SGDParamState>();
+        state->momentum_buffer(buf);
+        state_[key] = std::move(state);
+      } else {
+        buf = static_cast<SGDParamState&>(*param_state->second)
+                  .momentum_buffer();
+        buf.mul_(momentum).add_(grad, 1 - dampening);
+        if (weight_decay != 0) {
+          buf.add_(p, weight_decay * (1 - dampening));
+        }
+      }
+      if (nesterov) {
+        // p - lr * (grad + weight_decay * p + momentum * buf)
+        if (weight_decay != 0) {
+          p.mul_(1 - lr * weight_decay);
         }
+        p.add_(grad, -lr).add_(buf, -lr * momentum);
+      } else {
+        p.add_(buf, -lr);
       }
-      p.data().add_(d_p, -1 * options.lr());
     }
   }
   return loss;
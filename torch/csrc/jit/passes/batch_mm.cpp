@@ -6,11 +6,13 @@
 #include <torch/csrc/jit/ir/alias_analysis.h>
 #include <torch/csrc/jit/ir/constants.h>
 #include <torch/csrc/jit/passes/dead_code_elimination.h>
+#include <torch/csrc/jit/passes/pass_manager.h>
 #include <torch/csrc/jit/passes/peephole.h>
 #include <torch/csrc/jit/runtime/custom_operator.h>
 
 #include <ATen/ATen.h>
 #include <algorithm>
+#include <map>
 #include <unordered_map>
 
 namespace torch {
@@ -452,6 +454,396 @@ void BatchMMSide(Block* block, AliasDb& alias_db) {
   }
 }
 
+// This pass batches groups of independent GEMMs of the same kind, typically
+// the many small linear layers of the heads of a multi-task model, which
+// each read the same features but don't depend on each other's results:
+//
+//   y_i = linear(x_i, W_i, b_i), for i in 0..N-1
+//
+// becomes a single batched GEMM on the stacked operands
+//
+//   Y = baddbmm(stack(b_i), stack(x_i), stack(W_i^T))
+//
+// whose slices are the y_i. The aten::linear, aten::addmm (with beta and
+// alpha of 1) and aten::bmm nodes are batched. When the weights are
+// constants, as in frozen graphs, they are stacked once when the graph is
+// compiled instead of on every run. When every y_i is only used by the same
+// elementwise activation, it runs once on Y as well.
+//
+// Whether batching wins depends on the shapes, which are only known when the
+// graph runs, so prim::BatchedGEMM only runs the batched GEMM when all its
+// operands have the same shape and each GEMM is small enough not to keep the
+// machine busy on its own, and falls back to running the GEMMs one by one
+// otherwise.
+
+// Tunable parameters. Below min_batch_size GEMMs the stacking isn't worth it,
+// and a GEMM with more multiply-adds than max_batched_gemm_size parallelizes
+// well on its own, so batching it only adds the copies into the stacked
+// operands.
+static constexpr size_t min_batch_size = 4;
+static constexpr int64_t max_batched_gemm_size = 128 * 128 * 128;
+
+enum class BatchedOp { Linear, Addmm, Bmm };
+
+// The weights of a group of GEMMs, in the layout of the batched GEMM.
+struct StackedWeights {
+  // [N, K, O], or the weights concatenated along their batch for bmm.
+  at::Tensor weight;
+  // Broadcastable to [N, M, O], undefined if the GEMMs have none.
+  at::Tensor bias;
+};
+
+bool have_same_type(at::TensorList inputs) {
+  return std::all_of(inputs.begin(), inputs.end(), [&](const at::Tensor& t) {
+    return t.options().type_equal(inputs[0].options());
+  });
+}
+
+c10::optional<StackedWeights> stack_weights(
+    BatchedOp op,
+    at::TensorList weights,
+    at::TensorList biases) {
+  if (!have_same_shape(weights) || !have_same_type(weights)) {
+    return c10::nullopt;
+  }
+  StackedWeights stacked;
+  if (op == BatchedOp::Bmm) {
+    stacked.weight = at::cat(weights, /*dim=*/0);
+    return stacked;
+  }
+  if (weights[0].dim() != 2) {
+    return c10::nullopt;
+  }
+  stacked.weight = at::stack(weights);
+  if (op == BatchedOp::Linear) {
+    stacked.weight = stacked.weight.transpose(1, 2);
+  }
+  bool has_bias = biases[0].defined();
+  for (const at::Tensor& bias : biases) {
+    if (bias.defined() != has_bias) {
+      return c10::nullopt;
+    }
+  }
+  if (!has_bias) {
+    return stacked;
+  }
+  if (!have_same_shape(biases) || !have_same_type(biases) ||
+      biases[0].dim() > 2) {
+    return c10::nullopt;
+  }
+  stacked.bias = at::stack(biases);
+  if (biases[0].dim() == 0) {
+    stacked.bias = stacked.bias.view({-1, 1, 1});
+  } else if (biases[0].dim() == 1) {
+    stacked.bias = stacked.bias.unsqueeze(1);
+  }
+  return stacked;
+}
+
+bool shape_is_fast_for_batch(
+    BatchedOp op,
+    at::TensorList inputs,
+    const at::Tensor& weight) {
+  if (!have_same_shape(inputs) || !have_same_type(inputs)) {
+    return false;
+  }
+  const at::Tensor& input = inputs[0];
+  if (op != BatchedOp::Bmm && weight.dim() != 2) {
+    return false;
+  }
+  int64_t output_size = 0;
+  switch (op) {
+    case BatchedOp::Linear:
+      if (input.dim() < 1 || input.size(-1) != weight.size(1)) {
+        return false;
+      }
+      output_size = weight.size(0);
+      break;
+    case BatchedOp::Addmm:
+      if (input.dim() != 2 || input.size(1) != weight.size(0)) {
+        return false;
+      }
+      output_size = weight.size(1);
+      break;
+    case BatchedOp::Bmm:
+      if (input.dim() != 3 || weight.dim() != 3) {
+        return false;
+      }
+      output_size = weight.size(2);
+      break;
+  }
+  return input.numel() * output_size <= max_batched_gemm_size;
+}
+
+at::Tensor run_gemm(
+    BatchedOp op,
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias) {
+  switch (op) {
+    case BatchedOp::Linear:
+      return at::linear(input, weight, bias);
+    case BatchedOp::Addmm:
+      return at::addmm(bias, input, weight);
+    case BatchedOp::Bmm:
+      return at::bmm(input, weight);
+  }
+  AT_ERROR("unknown batched GEMM");
+}
+
+void apply_activation(const std::string& activation, at::Tensor& t) {
+  if (activation == "relu") {
+    t.relu_();
+  } else if (activation == "sigmoid") {
+    t.sigmoid_();
+  } else if (activation == "tanh") {
+    t.tanh_();
+  }
+}
+
+std::vector<at::Tensor> run_batched_gemm(
+    BatchedOp op,
+    at::TensorList inputs,
+    const StackedWeights& stacked,
+    const std::string& activation) {
+  int64_t num_gemms = inputs.size();
+  if (op == BatchedOp::Bmm) {
+    auto output = at::cat(inputs, /*dim=*/0).bmm(stacked.weight);
+    apply_activation(activation, output);
+    return at::chunk(output, num_gemms, /*dim=*/0);
+  }
+  const at::Tensor& input = inputs[0];
+  auto batched_input =
+      at::stack(inputs).reshape({num_gemms, -1, input.size(-1)});
+  auto output = stacked.bias.defined()
+      ? at::baddbmm(stacked.bias, batched_input, stacked.weight)
+      : at::bmm(batched_input, stacked.weight);
+  apply_activation(activation, output);
+  auto output_sizes = input.sizes().vec();
+  output_sizes.back() = output.size(2);
+  return fmap(output.unbind(0), [&](const at::Tensor& t) {
+    return t.view(output_sizes);
+  });
+}
+
+RegisterOperators batched_gemm_reg({Operator(
+    prim::BatchedGEMM,
+    [](const Node* node) -> Operation {
+      auto op = static_cast<BatchedOp>(node->i(Symbol::attr("op")));
+      std::string activation = node->s(Symbol::attr("activation"));
+      size_t num_gemms = node->outputs().size();
+      size_t num_inputs = node->inputs().size();
+      // The weights and biases of frozen graphs are constants, and only need
+      // to be stacked once.
+      bool constant_weights = true;
+      std::vector<at::Tensor> weight_constants, bias_constants;
+      for (size_t i = num_gemms; i < num_inputs; ++i) {
+        auto ival = toIValue(node->input(i));
+        if (!ival) {
+          constant_weights = false;
+          break;
+        }
+        auto& tensors = i < 2 * num_gemms ? weight_constants : bias_constants;
+        tensors.push_back(ival->isTensor() ? ival->toTensor() : at::Tensor());
+      }
+      bias_constants.resize(num_gemms);
+      c10::optional<StackedWeights> stacked_constants;
+      if (constant_weights) {
+        stacked_constants =
+            stack_weights(op, weight_constants, bias_constants);
+      }
+      return [=](Stack* stack) {
+        std::vector<at::Tensor> inputs, weights, biases;
+        inputs.reserve(num_gemms);
+        weights.reserve(num_gemms);
+        biases.reserve(num_gemms);
+        auto args = last(stack, num_inputs);
+        for (size_t i = 0; i < num_inputs; ++i) {
+          auto& tensors =
+              i < num_gemms ? inputs : i < 2 * num_gemms ? weights : biases;
+          tensors.push_back(
+              args[i].isTensor() ? args[i].toTensor() : at::Tensor());
+        }
+        drop(stack, num_inputs);
+        biases.resize(num_gemms);
+
+        c10::optional<StackedWeights> stacked;
+        if ((!constant_weights || stacked_constants) &&
+            shape_is_fast_for_batch(op, inputs, weights[0])) {
+          stacked = constant_weights ? stacked_constants
+                                     : stack_weights(op, weights, biases);
+        }
+        if (stacked) {
+          auto outputs = run_batched_gemm(op, inputs, *stacked, activation);
+          stack->insert(
+              stack->end(),
+              std::make_move_iterator(outputs.begin()),
+              std::make_move_iterator(outputs.end()));
+        } else {
+          for (size_t i = 0; i < num_gemms; ++i) {
+            auto output = run_gemm(op, inputs[i], weights[i], biases[i]);
+            apply_activation(activation, output);
+            stack->emplace_back(std::move(output));
+          }
+        }
+      };
+    },
+    aliasAnalysisIsSpecialCase())});
+
+bool is_constant_one(Value* v) {
+  auto ival = toIValue(v);
+  return ival &&
+      ((ival->isInt() && ival->toInt() == 1) ||
+       (ival->isDouble() && ival->toDouble() == 1));
+}
+
+c10::optional<BatchedOp> batched_op_of(Node* n) {
+  if (n->matches(
+          "aten::linear(Tensor input, Tensor weight, Tensor? bias=None) -> Tensor")) {
+    return BatchedOp::Linear;
+  }
+  if (n->matches(
+          "aten::addmm(Tensor self, Tensor mat1, Tensor mat2, *, Scalar beta=1, Scalar alpha=1) -> Tensor") &&
+      is_constant_one(n->namedInput(attr::beta)) &&
+      is_constant_one(n->namedInput(attr::alpha))) {
+    return BatchedOp::Addmm;
+  }
+  if (n->matches("aten::bmm(Tensor self, Tensor mat2) -> Tensor")) {
+    return BatchedOp::Bmm;
+  }
+  return c10::nullopt;
+}
+
+// The input, weight and bias of a GEMM, the bias being nullptr for bmm.
+std::tuple<Value*, Value*, Value*> gemm_operands(BatchedOp op, Node* n) {
+  switch (op) {
+    case BatchedOp::Linear:
+      return std::make_tuple(n->input(0), n->input(1), n->input(2));
+    case BatchedOp::Addmm:
+      return std::make_tuple(n->input(1), n->input(2), n->input(0));
+    case BatchedOp::Bmm:
+      return std::make_tuple(n->input(0), n->input(1), nullptr);
+  }
+  AT_ERROR("unknown batched GEMM");
+}
+
+// The activation every output of `gemms` is only used by, if there is one.
+c10::optional<Symbol> common_activation(const std::vector<Node*>& gemms) {
+  c10::optional<Symbol> activation;
+  for (Node* gemm : gemms) {
+    const auto& uses = gemm->output()->uses();
+    if (uses.size() != 1) {
+      return c10::nullopt;
+    }
+    Node* user = uses[0].user;
+    if (!user->matches("aten::relu(Tensor self) -> Tensor") &&
+        !user->matches("aten::sigmoid(Tensor self) -> Tensor") &&
+        !user->matches("aten::tanh(Tensor self) -> Tensor")) {
+      return c10::nullopt;
+    }
+    if (activation && *activation != user->kind()) {
+      return c10::nullopt;
+    }
+    activation = user->kind();
+  }
+  return activation;
+}
+
+using GEMMGroup = std::pair<BatchedOp, std::vector<Node*>>;
+
+// Gathers the GEMMs of the blocks by kind, and by the shape of their weight
+// when it is a constant, in topological order.
+void gatherGEMMGroups(Block* block, std::vector<GEMMGroup>& groups) {
+  std::map<std::pair<int, std::vector<int64_t>>, std::vector<Node*>>
+      block_groups;
+  for (Node* node : block->nodes()) {
+    for (Block* subblock : node->blocks()) {
+      gatherGEMMGroups(subblock, groups);
+    }
+    auto op = batched_op_of(node);
+    if (!op) {
+      continue;
+    }
+    std::vector<int64_t> weight_sizes;
+    auto weight = toIValue(std::get<1>(gemm_operands(*op, node)));
+    if (weight && weight->isTensor()) {
+      weight_sizes = weight->toTensor().sizes().vec();
+    }
+    block_groups[std::make_pair(static_cast<int>(*op), std::move(weight_sizes))]
+        .push_back(node);
+  }
+  for (auto& item : block_groups) {
+    if (item.second.size() >= min_batch_size) {
+      groups.emplace_back(
+          static_cast<BatchedOp>(item.first.first), std::move(item.second));
+    }
+  }
+}
+
+void batchGEMMGroup(BatchedOp op, std::vector<Node*> gemms, AliasDb& alias_db) {
+  // Keep the GEMMs that don't depend on the ones before them, see
+  // gatherIndependentMMUses.
+  for (size_t i = 0; i < gemms.size(); ++i) {
+    if (gemms[i] == nullptr)
+      continue;
+    for (size_t j = i + 1; j < gemms.size(); ++j) {
+      if (gemms[j] == nullptr)
+        continue;
+      if (!alias_db.couldMoveBeforeTopologically(gemms[j], gemms[i])) {
+        gemms[j] = nullptr;
+      }
+    }
+  }
+  gemms = c10::filter(gemms, [](Node* n) { return n != nullptr; });
+  if (gemms.size() < min_batch_size) {
+    return;
+  }
+  for (int64_t i = static_cast<int64_t>(gemms.size()) - 2; i >= 0; --i) {
+    bool move_ok =
+        alias_db.moveBeforeTopologicallyValid(gemms[i], gemms[i + 1]);
+    AT_ASSERT(move_ok);
+  }
+
+  WithInsertPoint insert_guard{gemms[0]};
+  Graph* graph = gemms[0]->owningGraph();
+  Node* batched = graph->insertNode(graph->create(
+      prim::BatchedGEMM, /*inputs=*/{}, /*num_outputs=*/gemms.size()));
+  batched->i_(Symbol::attr("op"), static_cast<int>(op));
+  auto activation = common_activation(gemms);
+  batched->s_(
+      Symbol::attr("activation"),
+      activation ? activation->toUnqualString() : "");
+  for (Node* gemm : gemms) {
+    batched->addInput(std::get<0>(gemm_operands(op, gemm)));
+  }
+  for (Node* gemm : gemms) {
+    batched->addInput(std::get<1>(gemm_operands(op, gemm)));
+  }
+  if (op != BatchedOp::Bmm) {
+    for (Node* gemm : gemms) {
+      batched->addInput(std::get<2>(gemm_operands(op, gemm)));
+    }
+  }
+  for (size_t i = 0; i < gemms.size(); ++i) {
+    Value* output = activation
+        ? gemms[i]->output()->uses()[0].user->output()
+        : gemms[i]->output();
+    batched->output(i)->setType(output->type());
+    output->replaceAllUsesWith(batched->output(i));
+  }
+  // NB: the GEMMs and activations are now dead, DCE removes them.
+}
+
+void BatchGEMMs(std::shared_ptr<Graph>& graph) {
+  std::vector<GEMMGroup> groups;
+  gatherGEMMGroups(graph->block(), groups);
+  for (auto& group : groups) {
+    // Every group changes the graph, so it needs an AliasDb of its own.
+    AliasDb alias_db(graph);
+    batchGEMMGroup(group.first, std::move(group.second), alias_db);
+  }
+}
+
 bool hasMutableOperators(Block* block) {
   for (auto n : block->nodes()) {
     if (n->kind().is_aten() && n->schema().is_mutable())
@@ -465,6 +857,7 @@ bool hasMutableOperators(Block* block) {
 }
 
 void BatchMM(std::shared_ptr<Graph>& graph) {
+  PassTimingGuard timer("BatchMM");
   if (hasMutableOperators(graph->block())) {
     // TODO(suo): make BatchMM mutability-safe
     return;
@@ -473,6 +866,8 @@ void BatchMM(std::shared_ptr<Graph>& graph) {
   BatchMMTreeReduce(graph->block());
   BatchMMSide(graph->block(), alias_db);
   EliminateDeadCode(graph);
+  BatchGEMMs(graph);
+  EliminateDeadCode(graph);
   // It's possible that transpose rearrangements have created sequences of
   // consecutive transposes that didn't exist before.
   PeepholeOptimize(graph);
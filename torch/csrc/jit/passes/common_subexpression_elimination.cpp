@@ -4,6 +4,7 @@
 #include <torch/csrc/jit/ir/ir.h>
 #include <torch/csrc/jit/ir/node_hashing.h>
 #include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/passes/pass_manager.h>
 
 #include <unordered_map>
 
@@ -88,6 +89,7 @@ void EliminateCommonSubexpression(
 } // namespace
 
 void EliminateCommonSubexpression(const std::shared_ptr<Graph>& graph) {
+  PassTimingGuard timer("EliminateCommonSubexpression");
   AliasDb aliasDb(graph);
   GRAPH_DUMP("Before CSE", graph);
   EliminateCommonSubexpression(
@@ -3,6 +3,7 @@
 #include <torch/csrc/jit/ir/alias_analysis.h>
 #include <torch/csrc/jit/ir/ir.h>
 #include <torch/csrc/jit/ir/node_hashing.h>
+#include <torch/csrc/jit/passes/pass_manager.h>
 #include <unordered_set>
 
 namespace torch {
@@ -66,6 +67,7 @@ void ConstantPooling(
 } // anonymous namespace
 
 void ConstantPooling(const std::shared_ptr<Graph>& graph) {
+  PassTimingGuard timer("ConstantPooling");
   AliasDb aliasDb(graph);
   std::unordered_set<Node*, HashNode, EqualNode> constants;
   ConstantPooling(graph->block(), constants, aliasDb);
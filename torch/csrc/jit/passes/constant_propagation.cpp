@@ -9,6 +9,7 @@
 #include <torch/csrc/jit/ir/node_hashing.h>
 #include <torch/csrc/jit/jit_log.h>
 #include <torch/csrc/jit/passes/dead_code_elimination.h>
+#include <torch/csrc/jit/passes/pass_manager.h>
 #include <torch/csrc/jit/runtime/operator.h>
 #include <torch/csrc/jit/runtime/vararg_functions.h>
 #include <torch/csrc/utils/memory.h>
@@ -356,6 +357,7 @@ struct ConstantPropagator {
 } // anonymous namespace
 
 void ConstantPropagation(std::shared_ptr<Graph>& graph) {
+  PassTimingGuard timer("ConstantPropagation");
   ConstantPropagator cp = ConstantPropagator::WithAliasDb(graph);
   cp.run();
   EliminateDeadCode(graph);
@@ -363,6 +365,7 @@ void ConstantPropagation(std::shared_ptr<Graph>& graph) {
 }
 
 void ConstantPropagationImmutableTypes(std::shared_ptr<Graph>& graph) {
+  PassTimingGuard timer("ConstantPropagationImmutableTypes");
   ConstantPropagator cp = ConstantPropagator::NoAliasDb(graph);
   cp.run();
   EliminateDeadCode(graph);
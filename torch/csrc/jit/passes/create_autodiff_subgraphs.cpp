@@ -5,6 +5,7 @@
 #include <torch/csrc/jit/ir/ir.h>
 #include <torch/csrc/jit/passes/canonicalize.h>
 #include <torch/csrc/jit/passes/common_subexpression_elimination.h>
+#include <torch/csrc/jit/passes/pass_manager.h>
 #include <torch/csrc/jit/passes/utils/subgraph_utils.h>
 #include <torch/csrc/jit/runtime/autodiff.h>
 
@@ -334,6 +335,7 @@ class SubgraphSlicer {
 std::vector<Node*> CreateAutodiffSubgraphs(
     const std::shared_ptr<Graph>& graph,
     size_t threshold) {
+  PassTimingGuard timer("CreateAutodiffSubgraphs");
   std::vector<Node*> diff_nodes;
   AliasDb db(graph);
   SubgraphSlicer(graph->block(), graph, threshold, db, diff_nodes).run();
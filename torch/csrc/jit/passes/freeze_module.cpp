@@ -2,6 +2,8 @@
 #include <torch/csrc/jit/jit_log.h>
 
 #include <torch/csrc/jit/ir/alias_analysis.h>
+#include <torch/csrc/jit/passes/frozen_conv_folding.h>
+#include <torch/csrc/jit/passes/frozen_ops_to_mkldnn.h>
 #include <torch/csrc/jit/passes/inliner.h>
 #include <torch/csrc/jit/runtime/graph_executor_impl.h>
 
@@ -607,5 +609,12 @@ Module freeze_module(
   return moduleClone;
 }
 
+void OptimizeFrozenGraph(std::shared_ptr<Graph>& graph) {
+  // The folding must come first, as the MKL-DNN convolutions can't be
+  // folded into.
+  FoldFrozenConvBatchnorm(graph);
+  ConvertFrozenOpsToMKLDNN(graph);
+}
+
 } // namespace jit
 } // namespace torch
@@ -23,5 +23,15 @@ TORCH_API Module freeze_module(
     const Module& module,
     std::vector<std::string> preservedAttrs = std::vector<std::string>());
 
+/** \brief Optimizes the graph of a method of a frozen module for inference
+ * on CPU, using that its parameters are constants.
+ *
+ * The BatchNorms that follow a convolution are folded into it, and the
+ * convolutions and linear layers run on MKL-DNN, their weights converted to
+ * its layout once. The module can't be serialized anymore once it holds
+ * MKL-DNN weights.
+ */
+TORCH_API void OptimizeFrozenGraph(std::shared_ptr<Graph>& graph);
+
 } // namespace jit
 } // namespace torch
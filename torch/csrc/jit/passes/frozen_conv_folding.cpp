@@ -0,0 +1,106 @@
+#include <torch/csrc/jit/passes/frozen_conv_folding.h>
+
+#include <ATen/ATen.h>
+#include <torch/csrc/jit/ir/constants.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/passes/dead_code_elimination.h>
+#include <torch/csrc/jit/passes/fold_conv_bn.h>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+bool isConv(Node* n) {
+  return n->kind() == aten::conv1d || n->kind() == aten::conv2d ||
+      n->kind() == aten::conv3d;
+}
+
+// Whether the inputs of `n` but its first one are constants.
+bool hasConstantParameters(Node* n) {
+  for (size_t i = 1; i < n->inputs().size(); ++i) {
+    if (n->input(i)->node()->kind() != prim::Constant) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// The weight and bias of the conv, and the statistics and parameters of the
+// batch norm, none of their optional tensors being undefined.
+bool tryExtractingConvBNParameters(
+    Node* conv,
+    Node* bn,
+    ConvBNParameters& params) {
+  // batch_norm(input, weight, bias, running_mean, running_var, training,
+  // momentum, eps, cudnn_enabled)
+  auto training = toIValue(bn->input(5));
+  auto running_mean = toIValue(bn->input(3));
+  auto running_var = toIValue(bn->input(4));
+  if (!training || !training->isBool() || training->toBool() ||
+      !running_mean->isTensor() || !running_var->isTensor()) {
+    return false;
+  }
+  params.conv_w = toIValue(conv->input(1))->toTensor();
+  if (!params.conv_w.is_floating_point()) {
+    return false;
+  }
+  params.bn_rm = running_mean->toTensor();
+  params.bn_rv = running_var->toTensor();
+  params.bn_eps = toIValue(bn->input(7))->toDouble();
+
+  auto conv_b = toIValue(conv->input(2));
+  params.conv_b = conv_b->isTensor() ? conv_b->toTensor()
+                                     : at::zeros_like(params.bn_rm);
+  auto bn_w = toIValue(bn->input(1));
+  params.bn_w =
+      bn_w->isTensor() ? bn_w->toTensor() : at::ones_like(params.bn_rm);
+  auto bn_b = toIValue(bn->input(2));
+  params.bn_b =
+      bn_b->isTensor() ? bn_b->toTensor() : at::zeros_like(params.bn_rm);
+  return true;
+}
+
+bool foldFrozenConvBatchnorm(Block* b) {
+  bool changed = false;
+  for (Node* n : b->nodes()) {
+    for (Block* block : n->blocks()) {
+      changed |= foldFrozenConvBatchnorm(block);
+    }
+    if (n->kind() != aten::batch_norm || !isConv(n->input(0)->node())) {
+      continue;
+    }
+    Node* conv = n->input(0)->node();
+    if (conv->output()->uses().size() != 1 || !hasConstantParameters(conv) ||
+        !hasConstantParameters(n)) {
+      continue;
+    }
+    ConvBNParameters params;
+    if (!tryExtractingConvBNParameters(conv, n, params)) {
+      continue;
+    }
+    at::Tensor new_w, new_b;
+    std::tie(new_w, new_b) = computeUpdatedConvWeightAndBias(params);
+
+    WithInsertPoint guard(conv);
+    auto graph = conv->owningGraph();
+    conv->replaceInput(1, graph->insertConstant(new_w));
+    conv->replaceInput(2, graph->insertConstant(new_b));
+    n->output()->replaceAllUsesWith(conv->output());
+    GRAPH_UPDATE("Folded ", *n, " into ", *conv);
+    changed = true;
+  }
+  return changed;
+}
+
+} // namespace
+
+void FoldFrozenConvBatchnorm(std::shared_ptr<Graph>& graph) {
+  if (foldFrozenConvBatchnorm(graph->block())) {
+    EliminateDeadCode(graph);
+  }
+  GRAPH_DUMP("After FoldFrozenConvBatchnorm: ", graph);
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <torch/csrc/jit/ir/ir.h>
+
+namespace torch {
+namespace jit {
+
+/** \brief Folds the eval mode BatchNorms that follow a convolution into the
+ * weight and bias of the convolution, in a graph whose parameters were
+ * frozen into constants.
+ *
+ * Only the convolutions whose output is used by the BatchNorm alone, and
+ * whose weight, bias and parameters are constants, are folded.
+ */
+TORCH_API void FoldFrozenConvBatchnorm(std::shared_ptr<Graph>& graph);
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,233 @@
+#include <torch/csrc/jit/passes/frozen_ops_to_mkldnn.h>
+
+#include <ATen/ATen.h>
+#include <torch/csrc/jit/ir/constants.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/passes/dead_code_elimination.h>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+bool isConstant(Value* v) {
+  return v->node()->kind() == prim::Constant;
+}
+
+// Whether MKL-DNN can take `t`, a parameter of the graph.
+bool isMKLDNNCompatible(const at::Tensor& t) {
+  return t.device().is_cpu() && t.layout() == at::kStrided &&
+      t.scalar_type() == at::kFloat && !t.requires_grad();
+}
+
+c10::optional<std::vector<int64_t>> constantIntList(Value* v, size_t size) {
+  auto ival = toIValue(v);
+  if (!ival || !ival->isIntList() || ival->toIntVector().size() != size) {
+    return c10::nullopt;
+  }
+  return ival->toIntVector();
+}
+
+class MKLDNNConverter {
+ public:
+  explicit MKLDNNConverter(std::shared_ptr<Graph> graph)
+      : graph_(std::move(graph)) {}
+
+  bool run() {
+    convertBlock(graph_->block());
+    return changed_;
+  }
+
+ private:
+  // Whether `v` is the dense version of an MKL-DNN tensor.
+  static bool isToDense(Value* v) {
+    return v->node()->kind() == aten::to_dense;
+  }
+
+  // The MKL-DNN version of `v`, which is the tensor it was converted from
+  // when it is a dense version, so that no conversion runs between two
+  // MKL-DNN ops.
+  Value* toMKLDNN(Value* v) {
+    if (isToDense(v)) {
+      return v->node()->input(0);
+    }
+    return graph_->insert(Symbol::aten("to_mkldnn"), {v});
+  }
+
+  // Replaces the uses of `old_output` with the dense version of `output`,
+  // which computes it on MKL-DNN.
+  void replaceWithDense(Value* old_output, Value* output) {
+    Node* dense = graph_->create(aten::to_dense, 1)->insertAfter(output->node());
+    TypePtr type = old_output->type();
+    old_output->replaceAllUsesWith(dense->output());
+    dense->addInput(output);
+    dense->output()->setType(type);
+    // MKL-DNN tensors have no strides.
+    output->setType(TensorType::get());
+    changed_ = true;
+  }
+
+  // conv2d(input, weight, bias, stride, padding, dilation, groups)
+  bool convertConv2d(Node* n) {
+    for (size_t i = 1; i < n->inputs().size(); ++i) {
+      if (!isConstant(n->input(i))) {
+        return false;
+      }
+    }
+    auto weight = toIValue(n->input(1))->toTensor();
+    auto bias = toIValue(n->input(2));
+    auto stride = constantIntList(n->input(3), 2);
+    auto padding = constantIntList(n->input(4), 2);
+    auto dilation = constantIntList(n->input(5), 2);
+    if (!isMKLDNNCompatible(weight) || weight.dim() != 4 ||
+        (bias->isTensor() && !isMKLDNNCompatible(bias->toTensor())) ||
+        !stride || !padding || !dilation) {
+      return false;
+    }
+    auto groups = toIValue(n->input(6))->toInt();
+    // The weight is reordered into the blocked layout the convolution
+    // prefers once, instead of on every run.
+    auto mkldnn_weight = at::mkldnn_reorder_conv2d_weight(
+        weight.to_mkldnn(), *padding, *stride, *dilation, groups);
+
+    WithInsertPoint guard(n);
+    Value* output = graph_->insert(
+        aten::mkldnn_convolution,
+        {toMKLDNN(n->input(0)),
+         graph_->insertConstant(mkldnn_weight),
+         n->input(2),
+         n->input(4),
+         n->input(3),
+         n->input(5),
+         n->input(6)});
+    replaceWithDense(n->output(), output);
+    return true;
+  }
+
+  // linear(input, weight, bias)
+  bool convertLinear(Node* n) {
+    if (!isConstant(n->input(1)) || !isConstant(n->input(2))) {
+      return false;
+    }
+    auto weight = toIValue(n->input(1))->toTensor();
+    auto bias = toIValue(n->input(2));
+    if (!isMKLDNNCompatible(weight) || weight.dim() != 2 ||
+        (bias->isTensor() && !isMKLDNNCompatible(bias->toTensor()))) {
+      return false;
+    }
+    // mkldnn_linear only takes inputs of at least 2 dimensions.
+    auto input_type = n->input(0)->type()->cast<TensorType>();
+    if (!input_type || !input_type->dim() || *input_type->dim() < 2) {
+      return false;
+    }
+    auto mkldnn_bias = bias->isTensor()
+        ? bias->toTensor().to_mkldnn()
+        : at::zeros({weight.size(0)}, weight.options()).to_mkldnn();
+
+    WithInsertPoint guard(n);
+    Value* output = graph_->insert(
+        Symbol::aten("mkldnn_linear"),
+        {toMKLDNN(n->input(0)),
+         graph_->insertConstant(weight.to_mkldnn()),
+         graph_->insertConstant(mkldnn_bias)});
+    replaceWithDense(n->output(), output);
+    return true;
+  }
+
+  // Whether `n`, whose first input is the dense version of an MKL-DNN
+  // tensor, has an MKL-DNN kernel for its other inputs.
+  static bool hasMKLDNNKernel(Node* n) {
+    if (n->matches("aten::relu(Tensor self) -> Tensor") ||
+        n->matches("aten::relu_(Tensor(a!) self) -> Tensor(a!)") ||
+        n->matches("aten::sigmoid(Tensor self) -> Tensor") ||
+        n->matches("aten::sigmoid_(Tensor(a!) self) -> Tensor(a!)") ||
+        n->matches(
+            "aten::max_pool2d(Tensor self, int[2] kernel_size, int[2] stride=[], int[2] padding=0, int[2] dilation=1, bool ceil_mode=False) -> Tensor")) {
+      return true;
+    }
+    if (n->matches(
+            "aten::avg_pool2d(Tensor self, int[2] kernel_size, int[2] stride=[], int[2] padding=0, bool ceil_mode=False, bool count_include_pad=True, int? divisor_override=None) -> Tensor")) {
+      return n->input(6)->mustBeNone();
+    }
+    if (n->matches(
+            "aten::adaptive_avg_pool2d(Tensor self, int[2] output_size) -> Tensor")) {
+      // The MKL-DNN kernel only takes input sizes that are multiples of the
+      // output size, which holds for global pooling.
+      auto output_size = constantIntList(n->input(1), 2);
+      return output_size && (*output_size)[0] == 1 && (*output_size)[1] == 1;
+    }
+    if (n->matches(
+            "aten::add.Tensor(Tensor self, Tensor other, *, Scalar alpha=1) -> Tensor") ||
+        n->matches("aten::mul.Tensor(Tensor self, Tensor other) -> Tensor")) {
+      // The MKL-DNN kernels don't broadcast.
+      if (!isToDense(n->input(1))) {
+        return false;
+      }
+      auto self_sizes =
+          n->input(0)->type()->expect<TensorType>()->sizes().concrete_sizes();
+      auto other_type = n->input(1)->type()->cast<TensorType>();
+      return self_sizes && other_type &&
+          self_sizes == other_type->sizes().concrete_sizes();
+    }
+    return false;
+  }
+
+  bool convertElementwise(Node* n) {
+    if (!isToDense(n->input(0)) || !hasMKLDNNKernel(n)) {
+      return false;
+    }
+    // The in-place ops mutate the MKL-DNN tensor instead of its dense
+    // version, so neither of them may have other uses.
+    bool inplace = n->kind() == Symbol::aten("relu_") ||
+        n->kind() == Symbol::aten("sigmoid_");
+    if (inplace &&
+        (n->input(0)->uses().size() != 1 ||
+         n->input(0)->node()->input(0)->uses().size() != 1)) {
+      return false;
+    }
+    for (size_t i = 0; i < n->inputs().size(); ++i) {
+      if (isToDense(n->input(i))) {
+        n->replaceInput(i, n->input(i)->node()->input(0));
+      }
+    }
+    replaceWithDense(n->output(), n->output());
+    return true;
+  }
+
+  void convertBlock(Block* b) {
+    for (Node* n : b->nodes()) {
+      for (Block* block : n->blocks()) {
+        convertBlock(block);
+      }
+      if (n->kind() == aten::conv2d) {
+        convertConv2d(n);
+      } else if (n->kind() == aten::linear) {
+        convertLinear(n);
+      } else if (
+          n->kind() == Symbol::aten("to_mkldnn") && isToDense(n->input(0))) {
+        n->output()->replaceAllUsesWith(n->input(0)->node()->input(0));
+        changed_ = true;
+      } else if (n->inputs().size() > 0) {
+        convertElementwise(n);
+      }
+    }
+  }
+
+  std::shared_ptr<Graph> graph_;
+  bool changed_ = false;
+};
+
+} // namespace
+
+void ConvertFrozenOpsToMKLDNN(std::shared_ptr<Graph>& graph) {
+  if (!at::hasMKLDNN()) {
+    return;
+  }
+  if (MKLDNNConverter(graph).run()) {
+    EliminateDeadCode(graph);
+  }
+  GRAPH_DUMP("After ConvertFrozenOpsToMKLDNN: ", graph);
+}
+
+} // namespace jit
+} // namespace torch
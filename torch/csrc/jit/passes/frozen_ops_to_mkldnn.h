@@ -0,0 +1,25 @@
+#pragma once
+
+#include <torch/csrc/jit/ir/ir.h>
+
+namespace torch {
+namespace jit {
+
+/** \brief Runs the float convolutions and linear layers of a graph whose
+ * parameters were frozen into constants on MKL-DNN, in its blocked layout.
+ *
+ * The weights are converted to MKL-DNN tensors, and reordered into the
+ * layout the convolutions prefer, once, when the pass runs. The MKL-DNN
+ * outputs then flow through the elementwise ops and the pooling ops that
+ * have an MKL-DNN kernel, and are only converted back to dense tensors
+ * where a node that has none uses them, so that a chain of such ops runs
+ * without a layout conversion between them.
+ *
+ * The constants of the graph are opaque MKL-DNN tensors afterwards, so it
+ * can't be serialized anymore. It does nothing unless ATen was built with
+ * MKL-DNN.
+ */
+TORCH_API void ConvertFrozenOpsToMKLDNN(std::shared_ptr<Graph>& graph);
+
+} // namespace jit
+} // namespace torch
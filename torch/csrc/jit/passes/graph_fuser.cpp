@@ -7,6 +7,7 @@
 #include <torch/csrc/jit/passes/common_subexpression_elimination.h>
 #include <torch/csrc/jit/passes/constant_pooling.h>
 #include <torch/csrc/jit/passes/dead_code_elimination.h>
+#include <torch/csrc/jit/passes/pass_manager.h>
 #include <torch/csrc/jit/passes/utils/subgraph_utils.h>
 #include <torch/csrc/jit/runtime/autodiff.h>
 #include <torch/csrc/jit/runtime/custom_operator.h>
@@ -1246,6 +1247,7 @@ void PeepholeOptimizeShapeExpressions(Block* block, AliasDb* db) {
 } // anonymous namespace
 
 void FuseGraph(std::shared_ptr<Graph>& graph, bool strict_fuser_check) {
+  PassTimingGuard timer("FuseGraph");
   AliasDb db(graph);
   GraphFuser(&db, graph->block(), strict_fuser_check).run();
   Lint(&db);
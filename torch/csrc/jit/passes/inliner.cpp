@@ -2,6 +2,7 @@
 #include <torch/csrc/jit/api/module.h>
 #include <torch/csrc/jit/frontend/error_report.h>
 #include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/passes/pass_manager.h>
 
 namespace torch {
 namespace jit {
@@ -49,6 +50,7 @@ void inlineCalls(Block* block) {
 }
 
 void Inline(Graph& graph) {
+  PassTimingGuard timer("Inline");
   GRAPH_DUMP("Before Inlining: ", &graph);
   inlineCalls(graph.block());
   GRAPH_DUMP("After Inlining: ", &graph);
@@ -7,6 +7,7 @@
 #include <torch/csrc/jit/ir/ir_views.h>
 #include <torch/csrc/jit/jit_log.h>
 #include <torch/csrc/jit/passes/dead_code_elimination.h>
+#include <torch/csrc/jit/passes/pass_manager.h>
 
 namespace torch {
 namespace jit {
@@ -358,6 +359,7 @@ Node* PeelLoop(Node* n, size_t times) {
 }
 
 void UnrollLoops(std::shared_ptr<Graph>& graph) {
+  PassTimingGuard timer("UnrollLoops");
   UnrollLoops(graph->block());
   EliminateDeadCode(graph);
 }
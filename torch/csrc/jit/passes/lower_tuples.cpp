@@ -3,6 +3,7 @@
 #include <c10/util/Exception.h>
 #include <torch/csrc/jit/ir/constants.h>
 #include <torch/csrc/jit/passes/dead_code_elimination.h>
+#include <torch/csrc/jit/passes/pass_manager.h>
 
 namespace torch {
 namespace jit {
@@ -234,6 +235,7 @@ void LowerSimpleTuples(Block* block) {
 }
 
 void LowerSimpleTuples(const std::shared_ptr<Graph>& graph) {
+  PassTimingGuard timer("LowerSimpleTuples");
   LowerSimpleTuples(graph->block());
   EliminateDeadCode(graph);
 }
@@ -1,5 +1,10 @@
 #include <torch/csrc/jit/passes/pass_manager.h>
 
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
 namespace torch {
 namespace jit {
 
@@ -59,6 +64,68 @@ void clearAllPrePasses() {
   passes.erase(passes.begin(), passes.end());
 }
 
+namespace {
+
+std::atomic<bool>& passTimingFlag() {
+  static std::atomic<bool> enabled([] {
+    const char* env = std::getenv("PYTORCH_JIT_PASS_TIMING");
+    return env != nullptr && std::strcmp(env, "0") != 0;
+  }());
+  return enabled;
+}
+
+struct PassTimings {
+  std::mutex mutex;
+  std::unordered_map<std::string, PassTiming> timings;
+};
+
+PassTimings& passTimings() {
+  static PassTimings timings;
+  return timings;
+}
+
+} // namespace
+
+bool passTimingEnabled() {
+  return passTimingFlag().load(std::memory_order_relaxed);
+}
+
+void setPassTimingEnabled(bool enabled) {
+  passTimingFlag().store(enabled);
+}
+
+std::unordered_map<std::string, PassTiming> getPassTimings() {
+  auto& timings = passTimings();
+  std::lock_guard<std::mutex> guard(timings.mutex);
+  return timings.timings;
+}
+
+void resetPassTimings() {
+  auto& timings = passTimings();
+  std::lock_guard<std::mutex> guard(timings.mutex);
+  timings.timings.clear();
+}
+
+PassTimingGuard::PassTimingGuard(const char* pass_name)
+    : pass_name_(passTimingEnabled() ? pass_name : nullptr) {
+  if (pass_name_) {
+    start_ = std::chrono::steady_clock::now();
+  }
+}
+
+PassTimingGuard::~PassTimingGuard() {
+  if (!pass_name_) {
+    return;
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start_;
+  auto& timings = passTimings();
+  std::lock_guard<std::mutex> guard(timings.mutex);
+  auto& timing = timings.timings[pass_name_];
+  timing.runs++;
+  timing.seconds += elapsed.count();
+}
+
 // LEGACY CALL
 RegisterPostPass::RegisterPostPass(GraphPass p) {
   registerPass(p);
@@ -2,6 +2,8 @@
 
 #include <torch/csrc/jit/ir/ir.h>
 
+#include <chrono>
+
 /* `getCustomPrePasses()` returns a vector of passes that will be executed
  * after differentiation but before any fusion. This is the de-facto location
  * for compiler backends to insert passes.
@@ -49,6 +51,38 @@ TORCH_API void clearPrePass(GraphPassNameType p);
 TORCH_API void clearAllPostPasses();
 TORCH_API void clearAllPrePasses();
 
+/*
+ * Pass timing accumulates the number of runs and the wall time of the
+ * built-in graph passes, to find the passes dominating the compilation of
+ * large graphs. It is disabled by default, and enabled by
+ * `setPassTimingEnabled(true)` or by setting the environment variable
+ * PYTORCH_JIT_PASS_TIMING=1. The time of a pass includes the time of the
+ * passes it runs itself.
+ */
+struct PassTiming {
+  int64_t runs = 0;
+  double seconds = 0;
+};
+
+TORCH_API bool passTimingEnabled();
+TORCH_API void setPassTimingEnabled(bool enabled);
+TORCH_API std::unordered_map<std::string, PassTiming> getPassTimings();
+TORCH_API void resetPassTimings();
+
+// Adds the time until its destruction to the timing of the pass `pass_name`,
+// if pass timing is enabled. `pass_name` must outlive the guard.
+class TORCH_API PassTimingGuard {
+ public:
+  explicit PassTimingGuard(const char* pass_name);
+  ~PassTimingGuard();
+  PassTimingGuard(const PassTimingGuard&) = delete;
+  PassTimingGuard& operator=(const PassTimingGuard&) = delete;
+
+ private:
+  const char* pass_name_;
+  std::chrono::steady_clock::time_point start_;
+};
+
 // LEGACY CALL
 struct TORCH_API RegisterPostPass {
   RegisterPostPass(GraphPass p);
@@ -1,6 +1,7 @@
 #include <torch/csrc/jit/passes/remove_mutation.h>
 #include <c10/util/Exception.h>
 #include <torch/csrc/jit/ir/alias_analysis.h>
+#include <torch/csrc/jit/passes/pass_manager.h>
 #include <torch/csrc/utils/memory.h>
 
 namespace torch {
@@ -264,11 +265,13 @@ struct MutationRemover {
 };
 
 void RemoveListMutation(const std::shared_ptr<Graph>& graph) {
+  PassTimingGuard timer("RemoveListMutation");
   MutationRemover mr(graph);
   mr.removeListMutation();
 }
 
 void RemoveTensorMutation(const std::shared_ptr<Graph>& graph) {
+  PassTimingGuard timer("RemoveTensorMutation");
   MutationRemover mr(graph);
   mr.removeTensorMutation();
 }
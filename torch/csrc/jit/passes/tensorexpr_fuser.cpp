@@ -5,6 +5,7 @@
 #include <torch/csrc/jit/passes/common_subexpression_elimination.h>
 #include <torch/csrc/jit/passes/dead_code_elimination.h>
 #include <torch/csrc/jit/passes/pass_manager.h>
+#include <torch/csrc/jit/passes/remove_mutation.h>
 #include <torch/csrc/jit/passes/utils/subgraph_utils.h>
 #include <torch/csrc/jit/runtime/custom_operator.h>
 #include <torch/csrc/jit/runtime/operator_options.h>
@@ -15,6 +16,122 @@ namespace torch {
 namespace jit {
 
 namespace tensorexpr {
+
+// Whether the kernels compute with the values of `type` in float.
+static bool isFloatingType(c10::optional<at::ScalarType> type) {
+  return type == at::ScalarType::Float || type == at::ScalarType::Half ||
+      type == at::ScalarType::BFloat16;
+}
+
+// The kernels compute the reductions and normalizations of float, half and
+// bfloat16 tensors on the CPU, accumulating in float, along constant dims,
+// into tensors that have at least a dim.
+static bool isSupportedReduction(Node* node) {
+  static const OperatorSet reductions{
+      "aten::sum.dim_IntList(Tensor self, int[1] dim, bool keepdim=False, *, ScalarType? dtype=None) -> Tensor",
+      "aten::mean.dim(Tensor self, int[1] dim, bool keepdim=False, *, ScalarType? dtype=None) -> Tensor",
+  };
+  static const OperatorSet normalizations{
+      "aten::softmax.int(Tensor self, int dim, ScalarType? dtype=None) -> Tensor",
+      "aten::log_softmax.int(Tensor self, int dim, ScalarType? dtype=None) -> Tensor",
+      "aten::layer_norm(Tensor input, int[] normalized_shape, Tensor? weight=None, Tensor? bias=None, float eps=1e-05, bool cudnn_enable=True) -> Tensor",
+  };
+  bool isReduction = node->isMemberOf(reductions);
+  if (!isReduction && !node->isMemberOf(normalizations)) {
+    return false;
+  }
+  auto tt = node->input(0)->type()->cast<TensorType>();
+  if (!tt || !tt->dim() || !isFloatingType(tt->scalarType()) ||
+      !tt->device() || !tt->device()->is_cpu()) {
+    return false;
+  }
+  for (size_t i = 1; i < node->inputs().size(); i++) {
+    // The weight and bias of layer_norm are tensors, the other arguments
+    // must be constants.
+    auto param = node->input(i)->type()->cast<TensorType>();
+    if (param) {
+      if (param->scalarType() != tt->scalarType() ||
+          param->device() != tt->device()) {
+        return false;
+      }
+    } else if (!toIValue(node->input(i))) {
+      return false;
+    }
+  }
+
+  size_t rank = *tt->dim();
+  switch (node->kind()) {
+    case aten::sum:
+    case aten::mean: {
+      if (!toIValue(node->input(3))->isNone()) {
+        return false;
+      }
+      auto dims = toIValue(node->input(1))->toIntVector();
+      std::unordered_set<int64_t> reduced;
+      for (int64_t dim : dims) {
+        if (dim < -static_cast<int64_t>(rank) ||
+            dim >= static_cast<int64_t>(rank)) {
+          return false;
+        }
+        reduced.insert(dim < 0 ? dim + rank : dim);
+      }
+      return !reduced.empty() && reduced.size() == dims.size() &&
+          (reduced.size() < rank || toIValue(node->input(2))->toBool());
+    }
+    case aten::softmax:
+    case aten::log_softmax: {
+      int64_t dim = toIValue(node->input(1))->toInt();
+      return toIValue(node->input(2))->isNone() && rank > 1 &&
+          dim >= -static_cast<int64_t>(rank) &&
+          dim < static_cast<int64_t>(rank);
+    }
+    case aten::layer_norm: {
+      auto normalized_shape = toIValue(node->input(1))->toIntVector();
+      if (normalized_shape.empty() || normalized_shape.size() >= rank) {
+        return false;
+      }
+      for (size_t i = 2; i < 4; i++) {
+        auto param = node->input(i)->type()->cast<TensorType>();
+        if (param && param->sizes().concrete_sizes() != normalized_shape) {
+          return false;
+        }
+      }
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+// The kernels generate the random numbers of rand_like, bernoulli and
+// dropout on the GPU, from the default generator, and the arguments other
+// than the input must be constants.
+static bool isSupportedRandom(Node* node) {
+  static const OperatorSet randoms{
+      "aten::rand_like(Tensor self, *, ScalarType? dtype=None, Layout? layout=None, Device? device=None, bool? pin_memory=None, MemoryFormat? memory_format=None) -> Tensor",
+      "aten::bernoulli.p(Tensor self, float p, *, Generator? generator=None) -> Tensor",
+      "aten::dropout(Tensor input, float p, bool train) -> Tensor",
+  };
+  if (!node->isMemberOf(randoms)) {
+    return false;
+  }
+  auto tt = node->input(0)->type()->cast<TensorType>();
+  if (!tt || !tt->device() || !tt->device()->is_cuda()) {
+    return false;
+  }
+  for (size_t i = 1; i < node->inputs().size(); i++) {
+    auto value = toIValue(node->input(i));
+    if (!value) {
+      return false;
+    }
+    // The dtype and the layout of rand_like are those of its input.
+    if (node->kind() == aten::rand_like && !value->isNone()) {
+      return false;
+    }
+  }
+  return true;
+}
+
 bool isSupported(Node* node) {
   // TODO:
   switch (node->kind()) {
@@ -72,8 +189,6 @@ bool isSupported(Node* node) {
     case aten::slice:
     case aten::unsqueeze:
     case aten::frac:
-    // TODO: uncomment once we can handle rand+broadcasts
-    // case aten::rand_like:
     case aten::_sigmoid_backward:
     case aten::_tanh_backward:
     case aten::__and__:
@@ -94,6 +209,16 @@ bool isSupported(Node* node) {
         return false;
       }
       return true;
+    case aten::sum:
+    case aten::mean:
+    case aten::softmax:
+    case aten::log_softmax:
+    case aten::layer_norm:
+      return isSupportedReduction(node);
+    case aten::rand_like:
+    case aten::bernoulli:
+    case aten::dropout:
+      return isSupportedRandom(node);
     default:
       return false;
   }
@@ -116,6 +241,15 @@ bool tensorExprFuserEnabled() {
   return true;
 }
 
+static bool texpr_dynamic_shapes_enabled_ = false;
+void setTensorExprDynamicShapesEnabled(bool val) {
+  texpr_dynamic_shapes_enabled_ = val;
+}
+
+bool tensorExprDynamicShapesEnabled() {
+  return texpr_dynamic_shapes_enabled_;
+}
+
 const Symbol& getTensorExprSymbol() {
   static Symbol s = Symbol::fromQualString("tensorexpr::Group");
   return s;
@@ -141,14 +275,45 @@ value_list sortReverseTopological(
 }
 
 bool allShapesAreKnown(Value* v) {
-  if (!v->type()->cast<TensorType>()) {
+  auto tt = v->type()->cast<TensorType>();
+  if (!tt) {
+    return true;
+  }
+  if (v->isCompleteTensor()) {
     return true;
   }
-  return v->isCompleteTensor();
+  // The kernels take the symbolic sizes and the unknown strides as
+  // arguments, but need the rank, dtype and device.
+  return tensorExprDynamicShapesEnabled() && tt->scalarType() &&
+      tt->device() && tt->dim();
+}
+
+// The nodes whose kernels compute with the static sizes of their inputs.
+bool needsStaticShapes(Node* node) {
+  switch (node->kind()) {
+    case prim::ConstantChunk:
+    case aten::cat:
+    case aten::slice:
+    case aten::unsqueeze:
+    case aten::sum:
+    case aten::mean:
+    case aten::softmax:
+    case aten::log_softmax:
+    case aten::layer_norm:
+      return true;
+    default:
+      return false;
+  }
 }
 
 bool allShapesAreKnown(Node* node) {
-  // TODO: Relax the checks to support dynamic shapes
+  if (needsStaticShapes(node)) {
+    for (torch::jit::Value* v : node->inputs()) {
+      if (v->type()->cast<TensorType>() && !v->isCompleteTensor()) {
+        return false;
+      }
+    }
+  }
   for (torch::jit::Value* output : node->outputs()) {
     if (!allShapesAreKnown(output)) {
       return false;
@@ -372,9 +537,9 @@ class TensorExprFuser {
   }
 
   bool canMerge(Node* consumer, Node* producer) {
-    // Only handle complete tensor types
+    // Only handle tensor types with known shapes
     for (torch::jit::Value* output : consumer->outputs()) {
-      REQ(output->isCompleteTensor());
+      REQ(allShapesAreKnown(output));
     }
 
     // Only fuse within a block
@@ -428,11 +593,20 @@ class TensorExprFuser {
 };
 
 void FuseTensorExprs(std::shared_ptr<Graph>& graph) {
+  PassTimingGuard timer("FuseTensorExprs");
   GRAPH_DUMP("Before TExprFuser: ", graph);
 
   // Get rid of dead code so that we don't waste effort fusing it.
   EliminateDeadCode(graph);
 
+  // The in-place ops on values nothing else aliases, e.g., the activations
+  // applied in place to intermediates, become functional ops that can be
+  // fused; the kernels then write their outputs into the buffers of the
+  // inputs that die with them. Those mutating values that may be aliased,
+  // like the inputs of the graph, are left out of the fusion groups, which
+  // must stay pure.
+  RemoveTensorMutation(graph);
+
   TensorExprFuser fuser(graph);
   fuser.run();
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <ATen/core/interned_strings.h>
 #include <torch/csrc/WindowsTorchApiMacro.h>
 #include <torch/csrc/jit/passes/pass_manager.h>
 #include <memory>
@@ -14,6 +15,13 @@ TORCH_API void FuseTensorExprs(std::shared_ptr<Graph>& graph);
 
 TORCH_API void setTensorExprFuserEnabled(bool val);
 TORCH_API bool tensorExprFuserEnabled();
+// Whether the fuser fuses the tensors whose profiled shapes have symbolic
+// sizes, into kernels generated for all the sizes these may take.
+TORCH_API void setTensorExprDynamicShapesEnabled(bool val);
+TORCH_API bool tensorExprDynamicShapesEnabled();
+
+// The kind of the fusion groups.
+TORCH_API const Symbol& getTensorExprSymbol();
 
 namespace tensorexpr {
 TORCH_API bool isSupported(Node* node);
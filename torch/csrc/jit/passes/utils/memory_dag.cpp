@@ -51,8 +51,8 @@ bool MemoryDAG::mayAlias(const Element* a, const Element* b) const {
 }
 
 bool MemoryDAG::mayAliasImpl(const Element* a, const Element* b) const {
-  const auto aMemLoc = getMemoryLocations(a);
-  const auto bMemLoc = getMemoryLocations(b);
+  const auto& aMemLoc = getMemoryLocations(a);
+  const auto& bMemLoc = getMemoryLocations(b);
 
   return aMemLoc.intersects(bMemLoc);
 }
@@ -68,6 +68,26 @@ bool MemoryDAG::mayContainAlias(Element* a, Element* b) const {
 void MemoryDAG::collectAllContainedMemoryLocations(
     const Element* elem,
     MemoryLocations& cont) const {
+  cont |= getAllContainedMemoryLocations(elem);
+}
+
+const MemoryLocations& MemoryDAG::getAllContainedMemoryLocations(
+    const Element* e) const {
+  if (e->cachedAllContainedMemoryLocations_) {
+    return *e->cachedAllContainedMemoryLocations_;
+  }
+
+  // Only cache the results of complete traversals, as the containment
+  // relation may have cycles.
+  MemoryLocations ret;
+  collectAllContainedMemoryLocationsImpl(e, ret);
+  e->cachedAllContainedMemoryLocations_ = std::move(ret);
+  return *e->cachedAllContainedMemoryLocations_;
+}
+
+void MemoryDAG::collectAllContainedMemoryLocationsImpl(
+    const Element* elem,
+    MemoryLocations& cont) const {
   // we have already recursed on this element
   unsigned compIdx = elem->index;
   if (cont.test(compIdx)) {
@@ -76,22 +96,17 @@ void MemoryDAG::collectAllContainedMemoryLocations(
   cont.set(compIdx);
 
   for (const auto& mem_loc : getMemoryLocations(elem)) {
-    collectAllContainedMemoryLocations(fromIndex(mem_loc), cont);
+    collectAllContainedMemoryLocationsImpl(fromIndex(mem_loc), cont);
   }
 
   for (const auto& contained : elem->containedElements) {
-    collectAllContainedMemoryLocations(fromIndex(contained), cont);
+    collectAllContainedMemoryLocationsImpl(fromIndex(contained), cont);
   }
 }
 
 bool MemoryDAG::mayContainAliasImpl(const Element* a, const Element* b) const {
-  MemoryLocations all_a_mlocs;
-  MemoryLocations all_b_mlocs;
-
-  collectAllContainedMemoryLocations(a, all_a_mlocs);
-  collectAllContainedMemoryLocations(b, all_b_mlocs);
-
-  return all_a_mlocs.intersects(all_b_mlocs);
+  return getAllContainedMemoryLocations(a).intersects(
+      getAllContainedMemoryLocations(b));
 }
 
 bool MemoryDAG::mayContainAlias(
@@ -209,6 +224,12 @@ void MemoryDAG::setWildcards(
       e->cachedMemoryLocations_->set(wildcardElement->index);
     }
   }
+
+  // The contained memory locations are derived from the memory locations, so
+  // recompute them on demand.
+  for (const std::unique_ptr<Element>& e : this->indexToElementMap_) {
+    e->cachedAllContainedMemoryLocations_ = c10::nullopt;
+  }
 }
 
 Element* MemoryDAG::unsafeMakeFreshValue(const Value* v) {
@@ -95,6 +95,11 @@ class TORCH_API MemoryDAG {
       const Element* elem,
       MemoryLocations& cont) const;
 
+  // Return the elements and memory locations that `Element` holds a
+  // reference to, including itself, directly or through contained elements.
+  const MemoryLocations& getAllContainedMemoryLocations(
+      const Element* e) const;
+
   /**
    * The following methods are special cases where we need to reach mutate the
    * internals of MemoryDAG for efficiency reasons. Don't call them unless you
@@ -114,6 +119,9 @@ class TORCH_API MemoryDAG {
   bool mayAliasImpl(const Element* a, const Element* b) const;
   bool mayContainAliasImpl(const Element* contained, const Element* container)
       const;
+  void collectAllContainedMemoryLocationsImpl(
+      const Element* elem,
+      MemoryLocations& cont) const;
   std::vector<std::unique_ptr<Element>> indexToElementMap_;
 };
 
@@ -147,10 +155,13 @@ struct Element {
   void makePointerTo(Element* from, Element* to);
 
   friend class MemoryDAG;
-  // We memoize the results of `getMemoryLocations` to speed up queries.
-  // A nullopt means that this cache is not yet populated. Since `MemoryDAG` is
-  // immutable, this cache should never need to be invalidated.
+  // We memoize the results of `getMemoryLocations` and
+  // `getAllContainedMemoryLocations` to speed up queries. A nullopt means that
+  // the cache is not yet populated. `setWildcards` updates the former in
+  // place and drops the latter, other than that `MemoryDAG` is immutable and
+  // the caches never need to be invalidated.
   mutable c10::optional<MemoryLocations> cachedMemoryLocations_;
+  mutable c10::optional<MemoryLocations> cachedAllContainedMemoryLocations_;
 };
 
 } // namespace jit
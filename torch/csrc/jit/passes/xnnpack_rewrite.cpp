@@ -237,6 +237,55 @@ void fuseReluWithPackedOps(std::shared_ptr<Graph>& graph) {
   rewriter.runOnGraph(graph, torch::jit::graph_rewrite_helper::isClampFusable);
 }
 
+void fuseClampWithPackedOps(std::shared_ptr<Graph>& graph) {
+  SubgraphRewriter rewriter;
+
+  // Same as the hardtanh fusion above: a clamp with constant bounds, either of
+  // which may be None, becomes the output min / max of the preceding op.
+  std::string linear_prepack_run_clamp_fused = R"(
+    graph(%input, %weight, %bias, %output_min, %output_max, %dummy_min_max):
+        %packed_weight_bias : __torch__.torch.classes.xnnpack.LinearOpContext = prepacked::linear_clamp_prepack(
+            %weight, %bias, %output_min, %output_max)
+        %res = prepacked::linear_clamp_run(%input, %packed_weight_bias)
+        return (%res))";
+
+  std::string conv2d_prepack_run_clamp_fused = R"(
+    graph(%input, %weight, %bias, %stride:int[], %padding:int[],
+          %dilation:int[], %groups:int, %output_min, %output_max, %dummy_min_max):
+        %packed_weight_bias : __torch__.torch.classes.xnnpack.Conv2dOpContext = prepacked::conv2d_clamp_prepack(
+            %weight, %bias, %stride, %padding, %dilation, %groups,
+            %output_min, %output_max)
+        %r = prepacked::conv2d_clamp_run(%input, %packed_weight_bias)
+        return (%r) )";
+
+  for (const std::string clamp_op : {"aten::clamp", "aten::clamp_"}) {
+    const std::string linear_prepack_run_clamp = R"(
+    graph(%input, %weight, %bias, %output_min, %output_max, %dummy_min_max):
+        %packed_weight_bias = prepacked::linear_clamp_prepack(
+            %weight, %bias, %dummy_min_max, %dummy_min_max)
+        %linear_res = prepacked::linear_clamp_run(%input, %packed_weight_bias)
+        %res = )" + clamp_op + R"((%linear_res, %output_min, %output_max)
+        return (%res))";
+
+    const std::string conv2d_prepack_run_clamp = R"(
+    graph(%input, %weight, %bias, %stride:int[], %padding:int[],
+          %dilation:int[], %groups:int, %output_min, %output_max, %dummy_min_max):
+        %packed_weight_bias = prepacked::conv2d_clamp_prepack(
+            %weight, %bias, %stride, %padding, %dilation, %groups,
+            %dummy_min_max, %dummy_min_max)
+        %conv2d_res = prepacked::conv2d_clamp_run(%input, %packed_weight_bias)
+        %r = )" + clamp_op + R"((%conv2d_res, %output_min, %output_max)
+        return (%r) )";
+
+    rewriter.RegisterRewritePattern(
+        linear_prepack_run_clamp, linear_prepack_run_clamp_fused);
+    rewriter.RegisterRewritePattern(
+        conv2d_prepack_run_clamp, conv2d_prepack_run_clamp_fused);
+  }
+
+  rewriter.runOnGraph(graph, torch::jit::graph_rewrite_helper::isClampFusable);
+}
+
 void runCanonicalOptimizations(script::Module& module) {
   auto graph = module.get_method("forward").graph();
   // Not sure if we have models running on mobile that require loop unrolling.
@@ -265,6 +314,7 @@ void fusePrePackedLinearConvWithClamp(script::Module& module) {
   auto graph = module.get_method("forward").graph();
   fuseReluWithPackedOps(graph);
   fuseHardtanhWithPackedOps(graph);
+  fuseClampWithPackedOps(graph);
 }
 
 void FoldPrePackingOps(script::Module& m) {
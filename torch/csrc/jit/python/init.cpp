@@ -1,5 +1,6 @@
 #include <torch/csrc/utils/pybind.h>
 
+#include <torch/csrc/DynamicTypes.h>
 #include <torch/csrc/jit/api/module.h>
 #include <torch/csrc/jit/backends/backend_init.h>
 #include <torch/csrc/jit/codegen/fuser/interface.h>
@@ -20,6 +21,8 @@
 #include <torch/csrc/jit/passes/erase_number_types.h>
 #include <torch/csrc/jit/passes/fold_conv_bn.h>
 #include <torch/csrc/jit/passes/freeze_module.h>
+#include <torch/csrc/jit/passes/frozen_conv_folding.h>
+#include <torch/csrc/jit/passes/frozen_ops_to_mkldnn.h>
 #include <torch/csrc/jit/passes/fuse_linear.h>
 #include <torch/csrc/jit/passes/fuse_relu.h>
 #include <torch/csrc/jit/passes/graph_fuser.h>
@@ -42,6 +45,7 @@
 #include <torch/csrc/jit/passes/onnx/preprocess_for_onnx.h>
 #include <torch/csrc/jit/passes/onnx/scalar_type_analysis.h>
 #include <torch/csrc/jit/passes/onnx/unpack_quantized_weights.h>
+#include <torch/csrc/jit/passes/pass_manager.h>
 #include <torch/csrc/jit/passes/peephole.h>
 #include <torch/csrc/jit/passes/quantization/dedup_module_uses.h>
 #include <torch/csrc/jit/passes/quantization/finalize.h>
@@ -70,10 +74,14 @@
 #include <torch/csrc/jit/python/script_init.h>
 #include <torch/csrc/jit/runtime/argument_spec.h>
 #include <torch/csrc/jit/runtime/autodiff.h>
+#include <torch/csrc/jit/runtime/compiled_kernel_cache.h>
 #include <torch/csrc/jit/runtime/graph_executor.h>
+#include <torch/csrc/jit/runtime/interpreter.h>
 #include <torch/csrc/jit/runtime/jit_exception.h>
+#include <torch/csrc/jit/runtime/lazy_tensor.h>
 #include <torch/csrc/jit/runtime/operator.h>
 #include <torch/csrc/jit/runtime/print_handler.h>
+#include <torch/csrc/jit/runtime/profile_cache.h>
 #include <torch/csrc/jit/runtime/static/init.h>
 #include <torch/csrc/jit/serialization/export.h>
 #include <torch/csrc/jit/serialization/import.h>
@@ -139,6 +147,7 @@ void initJITBindings(PyObject* module) {
       .def("_jit_pass_onnx_preprocess_caffe2", PreprocessCaffe2Ops)
       .def("_jit_pass_onnx", ToONNX)
       .def("_jit_pass_lower_all_tuples", LowerAllTuples)
+      .def("_jit_pass_batch_mm", BatchMM)
       .def("_jit_pass_onnx_function_substitution", ONNXFunctionCallSubstitution)
       .def(
           "_jit_pass_onnx_peephole",
@@ -263,6 +272,10 @@ void initJITBindings(PyObject* module) {
           },
           py::arg("module"),
           py::arg("preservedAttrs") = std::vector<std::string>())
+      .def("_jit_pass_optimize_frozen_graph", &OptimizeFrozenGraph)
+      .def("_jit_pass_fold_frozen_conv_bn", &FoldFrozenConvBatchnorm)
+      .def(
+          "_jit_pass_convert_frozen_ops_to_mkldnn", &ConvertFrozenOpsToMKLDNN)
       .def("_jit_pass_fuse_linear", &FuseLinear)
       .def(
           "_jit_pass_fuse_add_relu",
@@ -488,12 +501,77 @@ void initJITBindings(PyObject* module) {
             getBailoutDepth() = depth;
             return old_depth;
           })
+      .def(
+          "_jit_set_background_optimization",
+          [](bool enabled) {
+            bool old_state = getBackgroundOptimization();
+            getBackgroundOptimization() = enabled;
+            return old_state;
+          })
+      .def(
+          "_jit_set_profile_cache_dir",
+          [](std::string dir) {
+            auto old_dir = getProfileCacheDir();
+            setProfileCacheDir(std::move(dir));
+            return old_dir;
+          })
+      .def(
+          "_jit_set_kernel_cache_dir",
+          [](std::string dir) {
+            auto old_dir = getCompiledKernelCacheDir();
+            setCompiledKernelCacheDir(std::move(dir));
+            return old_dir;
+          })
+      .def("_jit_to_lazy", [](const at::Tensor& tensor) { return toLazy(tensor); })
+      .def("_jit_is_lazy", [](const at::Tensor& tensor) { return isLazy(tensor); })
+      .def(
+          "_jit_lazy_materialize",
+          [](const at::Tensor& tensor) { return materializeLazy(tensor); })
+      .def("_jit_lazy_sync", [] { syncLazyTensors(); })
+      .def("_jit_lazy_graph_cache_size", [] { return lazyGraphCacheSize(); })
+      .def(
+          "_jit_set_max_concurrent_forks",
+          [](size_t max_forks) {
+            size_t old_max_forks = maxConcurrentForks();
+            setMaxConcurrentForks(max_forks);
+            return old_max_forks;
+          })
+      .def(
+          "_jit_set_superinstructions_enabled",
+          [](bool enabled) {
+            bool old_state = superinstructionsEnabled();
+            setSuperinstructionsEnabled(enabled);
+            return old_state;
+          })
+      .def(
+          "_jit_set_instruction_profiling",
+          [](bool enabled) { setInstructionProfilingEnabled(enabled); })
+      .def("_jit_instruction_pair_counts", &instructionPairCounts)
+      .def("_jit_reset_instruction_pair_counts", &resetInstructionPairCounts)
       .def(
           "_jit_set_inline_everything_mode",
           [](bool enabled) { getInlineEverythingMode() = enabled; })
       .def(
           "_jit_get_inline_everything_mode",
           []() { return getInlineEverythingMode(); })
+      .def(
+          "_jit_set_pass_timing_enabled",
+          [](bool enabled) {
+            bool oldState = passTimingEnabled();
+            setPassTimingEnabled(enabled);
+            return oldState;
+          })
+      .def(
+          "_jit_get_pass_timings",
+          []() {
+            py::dict timings;
+            for (const auto& entry : getPassTimings()) {
+              timings[py::str(entry.first)] =
+                  py::make_tuple(entry.second.runs, entry.second.seconds);
+            }
+            return timings;
+          })
+      .def("_jit_reset_pass_timings", resetPassTimings)
       .def(
           "_jit_try_infer_type",
           [](py::object obj) -> TypePtr {
@@ -550,6 +628,12 @@ void initJITBindings(PyObject* module) {
       .def("_jit_set_texpr_fuser_enabled", &setTensorExprFuserEnabled)
       .def("_jit_texpr_fuser_enabled", &tensorExprFuserEnabled)
       .def("_jit_texpr_fallback_allowed", &tensorexpr::fallbackAllowed)
+      .def(
+          "_jit_texpr_set_dynamic_shapes_enabled",
+          &setTensorExprDynamicShapesEnabled)
+      .def(
+          "_jit_texpr_dynamic_shapes_enabled",
+          &tensorExprDynamicShapesEnabled)
       .def("_jit_texpr_set_fallback_allowed", &tensorexpr::setFallbackAllowed)
       .def(
           "_jit_pass_fuse_tensorexprs",
@@ -739,6 +823,21 @@ void initJITBindings(PyObject* module) {
              size_t size) {
             return self.writeRecord(
                 name, reinterpret_cast<const char*>(data), size);
+          })
+      .def(
+          "write_storage_record",
+          [](PyTorchStreamWriter& self,
+             const std::string& name,
+             py::handle storage) {
+            TORCH_CHECK(
+                isStorage(storage.ptr()),
+                "write_storage_record expects a storage");
+            at::Storage data = createStorage(storage.ptr());
+            writeTensorRecord(
+                name,
+                at::empty({0}, at::device(data.device()).dtype(at::kByte))
+                    .set_(data),
+                self);
           });
 
   py::enum_<MobileOptimizerType>(m, "MobileOptimizerType")
@@ -0,0 +1,181 @@
+#include <torch/csrc/jit/runtime/aot_module.h>
+
+#include <ATen/core/grad_mode.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/passes/constant_propagation.h>
+#include <torch/csrc/jit/passes/dead_code_elimination.h>
+#include <torch/csrc/jit/passes/inliner.h>
+#include <torch/csrc/jit/passes/shape_analysis.h>
+#include <torch/csrc/jit/passes/tensorexpr_fuser.h>
+#include <torch/csrc/jit/serialization/import.h>
+#include <torch/csrc/jit/tensorexpr/kernel.h>
+
+#ifdef TORCH_ENABLE_LLVM
+#include <torch/csrc/jit/tensorexpr/llvm_codegen.h>
+#endif
+
+#include <sstream>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+// The extra file of the model that holds the types of its inputs.
+constexpr const char* kAotInputTypesFile = "aot_input_types";
+
+// A type is written as its scalar type, device and sizes on a line, e.g.,
+// "6 cpu 2 1 10" for a float tensor of sizes [1, 10]. The tensors are
+// contiguous.
+std::string writeInputTypes(const std::vector<TensorTypePtr>& types) {
+  std::ostringstream out;
+  for (const auto& type : types) {
+    auto sizes = type->sizes().concrete_sizes();
+    TORCH_CHECK(
+        type->scalarType() && type->device() && sizes,
+        "expected a complete type, got ",
+        *type);
+    out << static_cast<int>(*type->scalarType()) << ' '
+        << type->device()->str() << ' ' << sizes->size();
+    for (int64_t size : *sizes) {
+      out << ' ' << size;
+    }
+    out << '\n';
+  }
+  return out.str();
+}
+
+std::vector<TensorTypePtr> readInputTypes(const std::string& str) {
+  std::vector<TensorTypePtr> types;
+  std::istringstream in(str);
+  int scalar_type = 0;
+  while (in >> scalar_type) {
+    std::string device;
+    size_t rank = 0;
+    in >> device >> rank;
+    std::vector<int64_t> sizes(rank);
+    for (auto& size : sizes) {
+      in >> size;
+    }
+    TORCH_CHECK(
+        in && scalar_type >= 0 &&
+            scalar_type < static_cast<int>(at::ScalarType::NumOptions),
+        "invalid input types in the model compiled ahead of time");
+    types.push_back(TensorType::createContiguous(
+        static_cast<at::ScalarType>(scalar_type), at::Device(device), sizes));
+  }
+  return types;
+}
+
+} // namespace
+
+std::shared_ptr<Graph> PrepareForAotCompilation(
+    const Module& module,
+    const std::vector<TensorTypePtr>& input_types) {
+  auto graph = module.get_method("forward").graph()->copy();
+  TORCH_CHECK(
+      graph->inputs().size() == input_types.size() + 1,
+      "expected the types of the ",
+      graph->inputs().size() - 1,
+      " inputs of forward, got ",
+      input_types.size());
+  // The first input is the module itself.
+  for (size_t i = 0; i < input_types.size(); ++i) {
+    TORCH_CHECK(
+        input_types[i]->isComplete(),
+        "expected a complete type, got ",
+        *input_types[i]);
+    graph->inputs()[i + 1]->setType(input_types[i]);
+  }
+  Inline(*graph);
+  ConstantPropagation(graph);
+  PropagateInputShapes(graph);
+  FuseTensorExprs(graph);
+  GRAPH_DUMP("Graph compiled ahead of time: ", graph);
+  return graph;
+}
+
+void SaveAotModel(
+    const Module& module,
+    const std::vector<TensorTypePtr>& input_types,
+    const std::string& filename) {
+  ExtraFilesMap extra_files;
+  extra_files[kAotInputTypesFile] = writeInputTypes(input_types);
+  module.save(filename, extra_files);
+}
+
+Module LoadAotModel(
+    const std::string& filename,
+    std::vector<TensorTypePtr>& input_types) {
+  ExtraFilesMap extra_files;
+  extra_files[kAotInputTypesFile] = "";
+  auto module = load(filename, at::kCPU, extra_files);
+  input_types = readInputTypes(extra_files[kAotInputTypesFile]);
+  return module;
+}
+
+#ifdef TORCH_ENABLE_LLVM
+std::vector<std::pair<std::string, std::string>> CompileFusionGroupsToObjects(
+    const std::shared_ptr<Graph>& graph) {
+  std::vector<std::pair<std::string, std::string>> objects;
+  // The kernels must compile: those that only run in the interpreter at
+  // runtime would be held to be compiled ahead of time.
+  bool fallback_allowed = tensorexpr::setFallbackAllowed(false);
+  for (Node* n : graph->nodes()) {
+    if (n->kind() != getTensorExprSymbol()) {
+      continue;
+    }
+    tensorexpr::TensorExprKernel kernel(n->g(attr::Subgraph));
+    auto stmt = kernel.getCodeGenStmt();
+    const auto& args = kernel.getCodeGenArgs();
+    auto name = tensorexpr::aotKernelName(stmt, args);
+    objects.emplace_back(
+        name, tensorexpr::compileToObjectCode(stmt, args, name));
+  }
+  tensorexpr::setFallbackAllowed(fallback_allowed);
+  return objects;
+}
+#endif
+
+AotModule::AotModule(
+    const std::string& model_path,
+    const std::string& library_path)
+    : module_(LoadAotModel(model_path, input_types_)),
+      graph_(PrepareForAotCompilation(module_, input_types_)),
+      library_(std::make_shared<tensorexpr::AotKernelLibrary>(library_path)) {
+  // The kernels of the fusion groups are lowered, and bound to those of the
+  // library, when their operations are created, i.e., with the code.
+  tensorexpr::AotKernelLibraryGuard guard(library_);
+  code_ = std::make_unique<Code>(graph_, "forward");
+}
+
+IValue AotModule::forward(std::vector<IValue> inputs) {
+  TORCH_CHECK(
+      inputs.size() == input_types_.size(),
+      "expected ",
+      input_types_.size(),
+      " inputs, got ",
+      inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    TORCH_CHECK(
+        inputs[i].isTensor() &&
+            input_types_[i]->matchTensor(inputs[i].toTensor()),
+        "input ",
+        i,
+        " doesn't have the type ",
+        *input_types_[i],
+        " the model was compiled for");
+  }
+  at::NoGradGuard no_grad;
+  Stack stack;
+  stack.reserve(inputs.size() + 1);
+  stack.emplace_back(module_._ivalue());
+  for (auto& input : inputs) {
+    stack.emplace_back(std::move(input));
+  }
+  InterpreterState(*code_).run(stack);
+  return stack.back();
+}
+
+} // namespace jit
+} // namespace torch
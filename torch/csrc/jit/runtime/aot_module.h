@@ -0,0 +1,79 @@
+#pragma once
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+#include <torch/csrc/jit/api/module.h>
+#include <torch/csrc/jit/runtime/interpreter.h>
+#include <torch/csrc/jit/tensorexpr/aot_codegen.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace torch {
+namespace jit {
+
+// Compiling a model ahead of time specializes the forward method of a frozen
+// module to the types of its inputs and fuses its graph with the TensorExpr
+// fuser, whose CPU kernels are compiled by LLVM into a shared library; see
+// binaries/aot_model_compiler.cc. The ops the fuser doesn't handle stay calls
+// into ATen. The model is saved with the types of its inputs, and loading it
+// prepares the same graph, which then runs in the interpreter, its fusion
+// groups calling the kernels of the library: nothing is profiled or compiled
+// at runtime.
+
+// The graph of the forward method of `module`, specialized to `input_types`
+// and fused. `module` must be frozen, and every type complete.
+TORCH_API std::shared_ptr<Graph> PrepareForAotCompilation(
+    const Module& module,
+    const std::vector<TensorTypePtr>& input_types);
+
+// Saves the frozen `module` to `filename`, with the types of the inputs it is
+// compiled for.
+TORCH_API void SaveAotModel(
+    const Module& module,
+    const std::vector<TensorTypePtr>& input_types,
+    const std::string& filename);
+
+// Loads the model `filename` that SaveAotModel wrote, and the types of the
+// inputs it was compiled for into `input_types`.
+TORCH_API Module LoadAotModel(
+    const std::string& filename,
+    std::vector<TensorTypePtr>& input_types);
+
+#ifdef TORCH_ENABLE_LLVM
+// Compiles the kernels of the fusion groups of `graph` to object code, and
+// returns the name of every kernel with its object.
+TORCH_API std::vector<std::pair<std::string, std::string>>
+CompileFusionGroupsToObjects(const std::shared_ptr<Graph>& graph);
+#endif
+
+// A model compiled ahead of time, ready to run without the graph executor.
+// It may run on several threads at once.
+class TORCH_API AotModule {
+ public:
+  // Loads the model `model_path`, whose kernels are those of the library
+  // `library_path`, or those linked into the process when it is empty.
+  AotModule(const std::string& model_path, const std::string& library_path);
+
+  // Runs the forward method on `inputs`, which must have the types the model
+  // was compiled for.
+  IValue forward(std::vector<IValue> inputs);
+
+  const std::shared_ptr<Graph>& graph() const {
+    return graph_;
+  }
+
+  const std::vector<TensorTypePtr>& input_types() const {
+    return input_types_;
+  }
+
+ private:
+  Module module_;
+  std::vector<TensorTypePtr> input_types_;
+  std::shared_ptr<Graph> graph_;
+  std::shared_ptr<tensorexpr::AotKernelLibrary> library_;
+  std::unique_ptr<Code> code_;
+};
+
+} // namespace jit
+} // namespace torch
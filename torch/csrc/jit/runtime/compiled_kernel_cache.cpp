@@ -0,0 +1,140 @@
+#include <torch/csrc/jit/runtime/compiled_kernel_cache.h>
+
+#include <torch/csrc/jit/jit_log.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <sstream>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+constexpr const char* kKernelCacheMagic = "torch_jit_kernel";
+// Bumped whenever the format of the entries changes.
+constexpr int kKernelCacheVersion = 1;
+
+std::mutex kernel_cache_mutex;
+
+std::string& kernelCacheDir() {
+  static std::string dir = [] {
+    const char* env = std::getenv("PYTORCH_JIT_KERNEL_CACHE_DIR");
+    return std::string(env ? env : "");
+  }();
+  return dir;
+}
+
+// FNV-1a, as the names of the entries must be the same in every process.
+uint64_t stableHash(const std::string& str) {
+  uint64_t hash = 14695981039346656037ull;
+  for (unsigned char c : str) {
+    hash ^= c;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+std::string entryPath(const std::string& dir, const std::string& key) {
+  std::ostringstream ss;
+  ss << dir << "/" << std::hex << stableHash(key) << ".kernel";
+  return ss.str();
+}
+
+// Reads the `size` bytes that follow a size written on a line of its own.
+bool readSized(std::istream& in, std::string& str) {
+  size_t size = 0;
+  if (!(in >> size) || in.get() != '\n') {
+    return false;
+  }
+  str.resize(size);
+  return static_cast<bool>(in.read(&str[0], size));
+}
+
+void writeSized(std::ostream& out, const std::string& str) {
+  out << str.size() << '\n';
+  out.write(str.data(), str.size());
+}
+
+} // namespace
+
+void setCompiledKernelCacheDir(std::string dir) {
+  std::lock_guard<std::mutex> lock(kernel_cache_mutex);
+  kernelCacheDir() = std::move(dir);
+}
+
+std::string getCompiledKernelCacheDir() {
+  std::lock_guard<std::mutex> lock(kernel_cache_mutex);
+  return kernelCacheDir();
+}
+
+std::string compiledKernelCacheKey(const std::vector<std::string>& parts) {
+  if (getCompiledKernelCacheDir().empty()) {
+    return "";
+  }
+  // Every part is prefixed by its size, so that the keys of different parts
+  // never meet.
+  std::ostringstream key;
+  for (const auto& part : parts) {
+    key << part.size() << ':' << part;
+  }
+  return key.str();
+}
+
+bool loadCompiledKernel(const std::string& key, std::string& code) {
+  auto dir = getCompiledKernelCacheDir();
+  if (key.empty() || dir.empty()) {
+    return false;
+  }
+  std::ifstream in(entryPath(dir, key), std::ios::binary);
+  if (!in) {
+    return false;
+  }
+  std::string magic;
+  int version = 0;
+  std::string entry_key;
+  std::string entry_code;
+  in >> magic >> version;
+  if (!in || magic != kKernelCacheMagic || version != kKernelCacheVersion ||
+      in.get() != '\n' || !readSized(in, entry_key) || entry_key != key ||
+      !readSized(in, entry_code)) {
+    GRAPH_DEBUG("Ignoring the kernel cache entry ", entryPath(dir, key));
+    return false;
+  }
+  code = std::move(entry_code);
+  GRAPH_DEBUG("Loaded the compiled kernel ", entryPath(dir, key));
+  return true;
+}
+
+void storeCompiledKernel(const std::string& key, const std::string& code) {
+  auto dir = getCompiledKernelCacheDir();
+  if (key.empty() || dir.empty()) {
+    return;
+  }
+  // Every process writes a file of its own then renames it, so that the
+  // processes reading the entry never see a partial one.
+  auto path = entryPath(dir, key);
+  std::ostringstream suffix;
+  suffix << ".tmp" << std::hex << std::random_device()();
+  auto tmp_path = path + suffix.str();
+  {
+    std::ofstream out(tmp_path, std::ios::binary);
+    out << kKernelCacheMagic << ' ' << kKernelCacheVersion << '\n';
+    writeSized(out, key);
+    writeSized(out, code);
+    if (!out) {
+      GRAPH_DEBUG("Couldn't write the kernel cache entry ", tmp_path);
+      std::remove(tmp_path.c_str());
+      return;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    std::remove(tmp_path.c_str());
+  }
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <string>
+#include <vector>
+
+namespace torch {
+namespace jit {
+
+// A cache of the code the fusers compile their kernels to, e.g., the object
+// code of the LLVM kernels and the PTX of the CUDA ones, kept on disk so that
+// the processes compiling a kernel another one already compiled load its code
+// instead. An entry is addressed by the hash of everything its code depends
+// on: the source or IR of the kernel, the compiler and its version, and the
+// target. It holds that key too, and is only used for the same key, so that
+// the colliding hashes never load the code of another kernel.
+//
+// The cache is disabled when the directory is empty, which is the default
+// unless PYTORCH_JIT_KERNEL_CACHE_DIR is set. The directory must exist.
+TORCH_API void setCompiledKernelCacheDir(std::string dir);
+TORCH_API std::string getCompiledKernelCacheDir();
+
+// The key of the entry of the kernel whose code is determined by `parts`,
+// or an empty string if the cache is disabled.
+TORCH_API std::string compiledKernelCacheKey(
+    const std::vector<std::string>& parts);
+
+// Reads the code of the entry of `key` into `code`. Returns false, leaving
+// `code` unchanged, if there is no such entry.
+TORCH_API bool loadCompiledKernel(const std::string& key, std::string& code);
+
+// Writes `code` into the entry of `key`.
+TORCH_API void storeCompiledKernel(
+    const std::string& key,
+    const std::string& code);
+
+} // namespace jit
+} // namespace torch
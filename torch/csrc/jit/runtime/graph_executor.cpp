@@ -41,6 +41,7 @@
 #include <torch/csrc/autograd/edge.h>
 #include <torch/csrc/autograd/function.h>
 #include <torch/csrc/jit/runtime/logging.h>
+#include <c10/util/Metrics.h>
 
 #include <cstdint>
 #include <iterator>
@@ -567,12 +568,22 @@ struct GraphExecutorImpl : public GraphExecutorImplBase {
       if (it != plan_cache.end()) {
         logging::getLogger()->addStatValue(
             logging::runtime_counters::EXECUTION_PLAN_CACHE_HIT, 1.0);
+        C10_METRICS_COUNTER_ADD(
+            "torch_jit_execution_plan_cache_hits_total",
+            "Runs of graph executors that found a plan for their inputs",
+            1);
         return it->second;
       }
+      const auto start = logging::timePoint();
       auto plan = compileSpec(spec);
+      logging::recordGraphCompilationSince(start);
       auto r = plan_cache.emplace(std::move(spec), std::move(plan));
       logging::getLogger()->addStatValue(
           logging::runtime_counters::EXECUTION_PLAN_CACHE_MISS, 1.0);
+      C10_METRICS_COUNTER_ADD(
+          "torch_jit_execution_plan_cache_misses_total",
+          "Runs of graph executors that compiled a plan for their inputs",
+          1);
       return r.first->second;
     }
   }
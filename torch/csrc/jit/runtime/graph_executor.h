@@ -87,6 +87,10 @@ TORCH_API std::atomic<bool>& getProfilingMode();
 TORCH_API std::atomic<bool>& getExecutorMode();
 TORCH_API std::atomic<size_t>& getNumProfiledRuns();
 TORCH_API std::atomic<size_t>& getBailoutDepth();
+// Whether the profiling executor optimizes the profiled graphs in the
+// background, running their unprofiled graph meanwhile, instead of on the
+// thread that finished profiling them.
+TORCH_API std::atomic<bool>& getBackgroundOptimization();
 TORCH_API bool IsNewExecutorEnabled();
 
 struct TORCH_API GraphOptimizerEnabledGuard {
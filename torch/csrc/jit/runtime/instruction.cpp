@@ -69,6 +69,15 @@ OpCode parseOpCode(const char* str) {
   return OP;
 }
 
+Instruction unfused(Instruction inst) {
+  if (inst.op == ARGS_OP || inst.op == ARGS_OP_STORE) {
+    // N counts the arguments of the superinstruction, the loads don't use it
+    inst.N = 0;
+  }
+  inst.op = inst.unfused_op;
+  return inst;
+}
+
 bool isOpSupportedInMobile(OpCode op) {
   // clang-format off
   static constexpr OpCode supported_ops_in_mobile[] {
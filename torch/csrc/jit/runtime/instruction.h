@@ -53,7 +53,12 @@ namespace jit {
   _(FORK, "CN") /* launch a thread to run code entry x with N inputs  */    \
   _(WARN, "") /* emit a warning with line information */                    \
   _(ENTER, "EN") /* enter scope of a contextmanager */                      \
-  _(EXIT, "EX") /* exit the last entered contextmanager */
+  _(EXIT, "EX") /* exit the last entered contextmanager */                  \
+  /* superinstructions, see CodeImpl::fuseSuperinstructions */              \
+  _(ARGS_OP, "RI") /* push N arguments (LOAD/MOVE/LOADC), then OP */        \
+  _(ARGS_OP_STORE, "RI") /* push N arguments, then OP, then STORE */        \
+  _(OP_STORE, "O") /* invoke operator X, then STORE */                      \
+  _(GUARD_JF, "T") /* GUARD, then JF on its result */
 
 enum OpCode : uint8_t {
 #define DEFINE_OP(op, _) op,
@@ -63,14 +68,21 @@ enum OpCode : uint8_t {
 
 struct Instruction {
   OpCode op;
-  uint8_t unused;
+  // The opcode the instruction was emitted with, which differs from op once
+  // it is fused into a superinstruction.
+  OpCode unfused_op;
   uint16_t N;
   int32_t X;
   // TODO: check for overflow
   Instruction(OpCode op, int32_t X, uint16_t N)
-      : op(op), unused(0), N(N), X(X) {}
+      : op(op), unfused_op(op), N(N), X(X) {}
 };
 
+// A superinstruction only replaces the first instruction of the sequence it
+// runs, the others are left as they are. This returns the instruction it
+// replaced, or inst itself if it isn't a superinstruction.
+Instruction unfused(Instruction inst);
+
 bool isOpSupportedInMobile(OpCode op);
 
 } // namespace jit
@@ -28,6 +28,9 @@
 using torch::distributed::autograd::DistAutogradContainer;
 #endif
 
+#include <algorithm>
+#include <atomic>
+#include <deque>
 #include <exception>
 #include <iostream>
 #include <memory>
@@ -36,13 +39,123 @@ using torch::distributed::autograd::DistAutogradContainer;
 #include <stdexcept>
 #include <typeinfo>
 #include <unordered_map>
+#include <tuple>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#if defined(__GNUC__) || defined(__clang__)
+#define JIT_USE_COMPUTED_GOTO
+#endif
+
 namespace torch {
 namespace jit {
 
+char const* toString(OpCode op);
+
+namespace {
+
+std::atomic<bool> superinstructions_enabled{true};
+std::atomic<bool> instruction_profiling_enabled{false};
+
+constexpr size_t kNumOpCodes = 0
+#define COUNT_OPCODE(op, _) +1
+    FORALL_OPCODES(COUNT_OPCODE)
+#undef COUNT_OPCODE
+    ;
+
+// The number of times the interpreter ran an instruction right after
+// another one, while profiling, indexed by their opcodes.
+std::atomic<uint64_t> instruction_pair_counts[kNumOpCodes][kNumOpCodes];
+
+void countInstructionPair(OpCode first, OpCode second) {
+  instruction_pair_counts[first][second].fetch_add(
+      1, std::memory_order_relaxed);
+}
+
+std::atomic<size_t> max_concurrent_forks{0};
+
+// A forked function waiting to run, which runs once, either on the inter-op
+// pool or inline in the interpreter waiting on its future if that one gets
+// to it first.
+class ForkTask {
+ public:
+  ForkTask(InterpreterContinuation continuation, std::string name)
+      : continuation_(std::move(continuation)), name_(std::move(name)) {}
+
+  // Runs the fork until it completes or suspends, unless it already started.
+  // Returns whether it ran it.
+  bool tryRun() {
+    if (started_.exchange(true)) {
+      return false;
+    }
+    RECORD_USER_SCOPE(name_);
+    continuation_();
+    return true;
+  }
+
+  bool started() const {
+    return started_.load();
+  }
+
+ private:
+  std::atomic<bool> started_{false};
+  InterpreterContinuation continuation_;
+  std::string name_;
+};
+
+// Runs the forks on the inter-op pool, at most max_concurrent_forks at once
+// when it isn't 0. The forks over the limit are queued, and run by the
+// workers of the forks that finish, or stolen by the interpreters waiting on
+// them, so a deep tree of forks neither oversubscribes the pool nor blocks
+// on forks that didn't get a thread.
+class ForkScheduler {
+ public:
+  static ForkScheduler& get() {
+    static ForkScheduler scheduler;
+    return scheduler;
+  }
+
+  void schedule(std::shared_ptr<ForkTask> task) {
+    size_t limit = max_concurrent_forks.load();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (limit != 0 && num_workers_ >= limit) {
+        pending_.push_back(std::move(task));
+        return;
+      }
+      ++num_workers_;
+    }
+    at::launch([this, task]() mutable { runWorker(std::move(task)); });
+  }
+
+ private:
+  // Runs `task`, then the queued tasks that weren't stolen meanwhile.
+  void runWorker(std::shared_ptr<ForkTask> task) {
+    while (task) {
+      task->tryRun();
+      task = nullptr;
+      std::lock_guard<std::mutex> lock(mutex_);
+      while (!task && !pending_.empty()) {
+        task = std::move(pending_.front());
+        pending_.pop_front();
+        if (task->started()) {
+          task = nullptr;
+        }
+      }
+      if (!task) {
+        --num_workers_;
+      }
+    }
+  }
+
+  std::mutex mutex_;
+  size_t num_workers_ = 0;
+  std::deque<std::shared_ptr<ForkTask>> pending_;
+};
+
+} // namespace
+
 // Before we translate to intepreter instructions, we do
 // some preprocessing of the graph to turn it into a form that is closer
 // to what the instructions will look like.
@@ -483,6 +596,54 @@ struct CodeImpl {
     // we deferred the emission of bailout blocks so they appear at the end
     // emit them now and patch up the jumps
     insertBailoutBlocks();
+    if (superinstructions_enabled.load()) {
+      fuseSuperinstructions();
+    }
+  }
+
+  static bool isArgumentPush(OpCode op) {
+    return op == LOAD || op == MOVE || op == LOADC;
+  }
+
+  // Replaces the first instruction of the common sequences of instructions
+  // by a superinstruction, which runs the whole sequence in a single
+  // dispatch: the loads of the arguments of an OP followed by the OP, and
+  // its STORE if it has one, an OP and its STORE, and a GUARD and its JF.
+  // The other instructions of a sequence are kept, so that the jumps into
+  // the middle of it, and the sources of the instructions, are unchanged.
+  // The sequences don't overlap, so the instructions a superinstruction
+  // reads aren't superinstructions themselves.
+  void fuseSuperinstructions() {
+    const size_t size = instructions_.size();
+    size_t i = 0;
+    while (i < size) {
+      Instruction& inst = instructions_[i];
+      if (isArgumentPush(inst.op)) {
+        size_t end = i;
+        while (end < size && end - i < UINT16_MAX &&
+               isArgumentPush(instructions_[end].op)) {
+          ++end;
+        }
+        if (end == size || instructions_[end].op != OP) {
+          i = end;
+          continue;
+        }
+        bool store = end + 1 < size && instructions_[end + 1].op == STORE;
+        inst.op = store ? ARGS_OP_STORE : ARGS_OP;
+        inst.N = end - i;
+        i = end + (store ? 2 : 1);
+      } else if (
+          inst.op == OP && i + 1 < size && instructions_[i + 1].op == STORE) {
+        inst.op = OP_STORE;
+        i += 2;
+      } else if (
+          inst.op == GUARD && i + 1 < size && instructions_[i + 1].op == JF) {
+        inst.op = GUARD_JF;
+        i += 2;
+      } else {
+        ++i;
+      }
+    }
   }
 
   const std::vector<c10::IValue>& constant_table() const {
@@ -493,8 +654,8 @@ struct CodeImpl {
     auto count = index;
     for (size_t instr_index = 0; instr_index < instructions_.size();
          instr_index++) {
-      if (instructions_[instr_index].op == GUARD ||
-          instructions_[instr_index].op == FAIL_GUARD) {
+      auto op = instructions_[instr_index].op;
+      if (op == GUARD || op == GUARD_JF || op == FAIL_GUARD) {
         if (count-- == 0) {
           // patching GUARD to FAIL_GUARD
           instructions_[instr_index].op = FAIL_GUARD;
@@ -993,6 +1154,11 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
   // A stack of objects that have been __enter__'d.
   std::vector<IValue> entered_objects;
 
+  // The forks of this interpreter that weren't waited on yet, by their
+  // future, so that waiting on one that didn't start runs it inline.
+  std::unordered_map<const c10::ivalue::Future*, std::weak_ptr<ForkTask>>
+      forks_;
+
   // A Frame captures function's state
   // (e.g. `pc` and `base_pointer`)
   // Each Frame corresponds to a call to a `Frame::function`
@@ -1111,6 +1277,52 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
     *af = ActiveFrame(frames.back());
   }
 
+  bool guardPasses(const Stack& stack, const TypePtr& expected) {
+    if (!stack.back().isTensor()) {
+      // stack.back() is an Uninitialized IValue and this is a guard
+      // on a block output. Uninitialized IValues are never used
+      // so it's safe to pass this guard check
+      return true;
+    }
+    auto t = stack.back().toTensor();
+    auto expected_type = expected->cast<TensorType>();
+    if (t.defined() &&
+        !frames.back().symbols2dims.bindSymbolicShapes(
+            t.sizes(), expected_type->symbolic_sizes())) {
+      return false;
+    }
+    return expected_type->matchTensor(t);
+  }
+
+  void pushArgument(
+      Stack& stack,
+      const ActiveFrame& af,
+      OpCode op,
+      int32_t X) {
+    switch (op) {
+      case LOAD:
+        stack.emplace_back(reg(X));
+        break;
+      case MOVE:
+        stack.emplace_back(std::move(reg(X)));
+        break;
+      default:
+        TORCH_INTERNAL_ASSERT(op == LOADC);
+        stack.emplace_back(af.constants[X]);
+    }
+  }
+
+  // Pushes the N arguments of an ARGS_OP superinstruction, the first one
+  // being that of the load it replaced, the others those of the N - 1 loads
+  // after it.
+  void pushArguments(Stack& stack, const ActiveFrame& af, Instruction inst) {
+    pushArgument(stack, af, inst.unfused_op, inst.X);
+    for (size_t i = 1; i < inst.N; ++i) {
+      const Instruction& arg = af.instructions[af.pc + i];
+      pushArgument(stack, af, arg.op, arg.X);
+    }
+  }
+
   bool runImpl(Stack& stack) {
     // if we have never run before, then we might have to return the
     // stack when we suspend, record where it starts so we return the right
@@ -1125,19 +1337,51 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
     }
 
     ActiveFrame af(frames.back());
+    const bool profile_instructions =
+        instruction_profiling_enabled.load(std::memory_order_relaxed);
+    c10::optional<OpCode> last_op;
+
+#define PROFILE_INSTRUCTION()                   \
+  if (profile_instructions) {                   \
+    if (last_op) {                              \
+      countInstructionPair(*last_op, inst.op); \
+    }                                           \
+    last_op = inst.op;                          \
+  }
+#ifdef JIT_USE_COMPUTED_GOTO
+    // Every instruction jumps to the next one directly, which gives each of
+    // them its own indirect branch to predict.
+    static void* dispatch_table[] = {
+#define DISPATCH_LABEL(op, _) &&label_##op,
+        FORALL_OPCODES(DISPATCH_LABEL)
+#undef DISPATCH_LABEL
+    };
+#define INST(NAME) \
+  case NAME:       \
+  label_##NAME
+#define DISPATCH()                \
+  inst = af.instructions[af.pc]; \
+  PROFILE_INSTRUCTION();          \
+  goto* dispatch_table[inst.op]
+#else
+#define INST(NAME) case NAME
+#define DISPATCH() break
+#endif
+
     try {
       while (true) {
         // std::cout << "RUNNING ";
         // frames.back().function->dump(std::cout, af.pc);
         Instruction inst = af.instructions[af.pc];
+        PROFILE_INSTRUCTION();
         switch (inst.op) {
-          case ENTER: {
+          INST(ENTER): {
             auto obj = peek(stack, 0, 1);
             TORCH_INTERNAL_ASSERT(obj.isObject());
             entered_objects.push_back(obj);
             ++af.pc;
-          } break;
-          case EXIT: {
+          } DISPATCH();
+          INST(EXIT): {
             auto obj = entered_objects.back().toObject();
             auto& f = obj->type()->getMethod("__exit__");
             push(stack, obj);
@@ -1146,65 +1390,65 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             push(stack, IValue());
             push(stack, IValue());
             runGraphFunction(stack, &f, &af);
-          } break;
-          case OP:
+          } DISPATCH();
+          INST(OP):
             af.operators[inst.X](&stack);
             ++af.pc;
-            break;
-          case OPN:
+            DISPATCH();
+          INST(OPN):
             stack.push_back(inst.N);
             af.operators[inst.X](&stack);
             ++af.pc;
-            break;
-          case LOAD:
+            DISPATCH();
+          INST(LOAD):
             stack.emplace_back(reg(inst.X));
             ++af.pc;
-            break;
-          case MOVE:
+            DISPATCH();
+          INST(MOVE):
             stack.emplace_back(std::move(reg(inst.X)));
             ++af.pc;
-            break;
-          case STORE:
+            DISPATCH();
+          INST(STORE):
             reg(inst.X) = pop(stack);
             ++af.pc;
-            break;
-          case STOREN:
+            DISPATCH();
+          INST(STOREN):
             for (size_t i = inst.N; i > 0; --i) {
               reg(inst.X + i - 1) = pop(stack);
             }
             ++af.pc;
-            break;
-          case DROP:
+            DISPATCH();
+          INST(DROP):
             pop(stack);
             ++af.pc;
-            break;
-          case DROPR:
+            DISPATCH();
+          INST(DROPR):
             reg(inst.X) = IValue();
             ++af.pc;
-            break;
-          case LOADC:
+            DISPATCH();
+          INST(LOADC):
             stack.emplace_back(af.constants[inst.X]);
             ++af.pc;
-            break;
-          case GET_ATTR: {
+            DISPATCH();
+          INST(GET_ATTR): {
             auto userObj = pop(stack).toObject();
             auto value = userObj->getSlot(inst.X);
             push(stack, std::move(value));
             ++af.pc;
-          } break;
-          case SET_ATTR: {
+          } DISPATCH();
+          INST(SET_ATTR): {
             auto v = pop(stack);
             auto userObj = pop(stack).toObject();
             userObj->setSlot(inst.X, std::move(v));
             ++af.pc;
-          } break;
-          case JF:
+          } DISPATCH();
+          INST(JF):
             af.pc += (pop(stack).toBool()) ? 1 : inst.X;
-            break;
-          case JMP:
+            DISPATCH();
+          INST(JMP):
             af.pc += inst.X;
-            break;
-          case LOOP: {
+            DISPATCH();
+          INST(LOOP): {
             // stack: iteration_count, max_iter, cond, loop_carried_deps...
             auto frame = stack.end() - (inst.N + 1);
             int64_t trip_count = frame[0].toInt();
@@ -1222,16 +1466,16 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
               drop(stack, 3); // iteration_count, max_iter, cond
               af.pc += inst.X;
             }
-          } break;
-          case CALL: {
+          } DISPATCH();
+          INST(CALL): {
             Function* fn = af.functions[inst.X];
             if (!fn->isGraphFunction()) {
               runBuiltinFunction(stack, fn, &af);
             } else {
               runGraphFunction(stack, fn, &af);
             }
-          } break;
-          case INTERFACE_CALL: {
+          } DISPATCH();
+          INST(INTERFACE_CALL): {
             // note the hash table lookup to find the function
             // this can be more optimized if necessary, caching parts
             // of the hashing computation or storing the offset when
@@ -1254,12 +1498,12 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             } else {
               runGraphFunction(stack, &function, &af);
             }
-          } break;
-          case RET:
+          } DISPATCH();
+          INST(RET):
             if (frames.size() > 1) {
               leaveFrame();
               af = ActiveFrame(frames.back());
-              break;
+              DISPATCH();
             }
             if (future_) {
               auto num_outputs = frames.back().function->n_outputs;
@@ -1271,8 +1515,16 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
               }
             }
             return false;
-          case WAIT: {
+          INST(WAIT): {
             auto future = stack.back().toFuture();
+            auto fork = forks_.find(future.get());
+            if (fork != forks_.end()) {
+              auto task = fork->second.lock();
+              forks_.erase(fork);
+              if (task && !future->completed()) {
+                task->tryRun();
+              }
+            }
             if (!future->completed()) {
               getOrCreateFuture();
 
@@ -1324,8 +1576,8 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             stack.pop_back();
             stack.emplace_back(future->value());
             ++af.pc;
-          } break;
-          case PROFILE_OP: {
+          } DISPATCH();
+          INST(PROFILE_OP): {
             auto& frame_id_ref = frames.back().id;
             if (!frame_id_ref.has_value()) {
               frame_id_ref = Frame::num_frames++;
@@ -1334,38 +1586,46 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             push(stack, c10::IValue{static_cast<int64_t>(*frame_id_ref)});
             callback(stack);
             ++af.pc;
-            break;
+            DISPATCH();
           }
-          case FAIL_GUARD: {
+          INST(FAIL_GUARD): {
             // patch FAIL_GUARD back to GUARD
             GRAPH_DEBUG(
                 "Bailout ", inst.X, " triggered via bailout_requests_!");
             af.instructions[af.pc].op = GUARD;
             push(stack, false);
             ++af.pc;
-            break;
+            DISPATCH();
           }
-          case GUARD: {
-            if (!stack.back().isTensor()) {
-              // stack.back() is an Uninitialized IValue and this is a guard
-              // on a block output. Uninitialized IValues are never used
-              // so it's safe to pass this guard check
-              push(stack, true);
-            } else {
-              auto t = stack.back().toTensor();
-              const TypePtr& expected = af.types[inst.X];
-              auto expected_type = expected->cast<TensorType>();
-              if (t.defined() &&
-                  !frames.back().symbols2dims.bindSymbolicShapes(
-                      t.sizes(), expected_type->symbolic_sizes())) {
-                push(stack, false);
-              } else {
-                push(stack, expected_type->matchTensor(t));
-              }
-            }
+          INST(GUARD): {
+            push(stack, guardPasses(stack, af.types[inst.X]));
+            ++af.pc;
+          } DISPATCH();
+          INST(GUARD_JF): {
+            // the JF pops the result of the GUARD, which isn't pushed
+            af.pc += guardPasses(stack, af.types[inst.X])
+                ? 2
+                : 1 + af.instructions[af.pc + 1].X;
+          } DISPATCH();
+          INST(ARGS_OP): {
+            pushArguments(stack, af, inst);
+            af.pc += inst.N;
+            af.operators[af.instructions[af.pc].X](&stack);
             ++af.pc;
-          } break;
-          case TAIL_CALL: {
+          } DISPATCH();
+          INST(ARGS_OP_STORE): {
+            pushArguments(stack, af, inst);
+            af.pc += inst.N;
+            af.operators[af.instructions[af.pc].X](&stack);
+            reg(af.instructions[af.pc + 1].X) = pop(stack);
+            af.pc += 2;
+          } DISPATCH();
+          INST(OP_STORE): {
+            af.operators[inst.X](&stack);
+            reg(af.instructions[af.pc + 1].X) = pop(stack);
+            af.pc += 2;
+          } DISPATCH();
+          INST(TAIL_CALL): {
             GRAPH_DEBUG("running TAIL_CALL for ", inst.X);
             af.functions[inst.X]->ensure_defined();
             size_t remaining_bailout_depth =
@@ -1388,46 +1648,46 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             leaveFrame();
             enterFrame(code, base_pointer);
             af = ActiveFrame(frames.back());
-          } break;
-          case LIST_UNPACK: {
+          } DISPATCH();
+          INST(LIST_UNPACK): {
             listUnpack(stack, inst.X);
             ++af.pc;
-          } break;
-          case TUPLE_CONSTRUCT: {
+          } DISPATCH();
+          INST(TUPLE_CONSTRUCT): {
             tupleConstruct(stack, inst.X);
             ++af.pc;
-          } break;
-          case TUPLE_SLICE: {
+          } DISPATCH();
+          INST(TUPLE_SLICE): {
             tupleSlice(stack, inst.X, inst.X + inst.N);
             ++af.pc;
-          } break;
-          case NAMED_TUPLE_CONSTRUCT: {
+          } DISPATCH();
+          INST(NAMED_TUPLE_CONSTRUCT): {
             auto type = af.types[inst.X]->expect<TupleType>();
             namedTupleConstruct(stack, type, inst.N);
             ++af.pc;
-          } break;
-          case LIST_CONSTRUCT: {
+          } DISPATCH();
+          INST(LIST_CONSTRUCT): {
             auto type = af.types[inst.X]->expect<ListType>();
             listConstruct(stack, type, inst.N);
             ++af.pc;
-          } break;
-          case DICT_CONSTRUCT: {
+          } DISPATCH();
+          INST(DICT_CONSTRUCT): {
             auto type = af.types[inst.X]->expect<DictType>();
             dictConstruct(stack, type, inst.N);
             ++af.pc;
-          } break;
-          case CREATE_OBJECT: {
+          } DISPATCH();
+          INST(CREATE_OBJECT): {
             auto type = af.types[inst.X]->expect<ClassType>();
             createObject(stack, type);
             ++af.pc;
-          } break;
-          case ISINSTANCE: {
+          } DISPATCH();
+          INST(ISINSTANCE): {
             at::ArrayRef<TypePtr> types(
                 af.types + inst.X, af.types + inst.X + inst.N);
             isinstance(stack, types);
             ++af.pc;
-          } break;
-          case FORK: {
+          } DISPATCH();
+          INST(FORK): {
             // Move inputs to a separate stack
             Function* forked_fn = af.functions[inst.X];
             InterpreterState forked_interpreter(
@@ -1439,11 +1699,15 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
                 Stack(stack.end() - inst.N, stack.end()),
                 getDistAutogradContextId());
             drop(stack, inst.N);
-            push(stack, forked_interpreter.getFuture());
-            at::launch(std::move(continuation));
+            auto future = forked_interpreter.getFuture();
+            auto task = std::make_shared<ForkTask>(
+                std::move(continuation), "fork::" + forked_fn->name());
+            forks_.emplace(future.get(), task);
+            push(stack, std::move(future));
+            ForkScheduler::get().schedule(std::move(task));
             ++af.pc;
-          } break;
-          case WARN: {
+          } DISPATCH();
+          INST(WARN): {
             Node* node = frames.back().function->instructions_source_.at(af.pc);
             auto range = node->sourceRange().source();
             if (range->filename()) {
@@ -1461,9 +1725,12 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
               TORCH_WARN(pop(stack).toStringRef());
             }
             ++af.pc;
-          } break;
+          } DISPATCH();
         }
       }
+#undef DISPATCH
+#undef INST
+#undef PROFILE_INSTRUCTION
     } catch (std::exception& e) {
       frames.back().pc = af.pc;
       for (auto it = entered_objects.rbegin(), end = entered_objects.rend();
@@ -1618,6 +1885,54 @@ size_t Code::register_size() const {
   return pImpl->register_size_;
 }
 
+void setSuperinstructionsEnabled(bool enabled) {
+  superinstructions_enabled.store(enabled);
+}
+
+bool superinstructionsEnabled() {
+  return superinstructions_enabled.load();
+}
+
+void setInstructionProfilingEnabled(bool enabled) {
+  instruction_profiling_enabled.store(enabled);
+}
+
+std::vector<std::tuple<std::string, std::string, uint64_t>>
+instructionPairCounts() {
+  std::vector<std::tuple<std::string, std::string, uint64_t>> counts;
+  for (size_t first = 0; first < kNumOpCodes; ++first) {
+    for (size_t second = 0; second < kNumOpCodes; ++second) {
+      auto count = instruction_pair_counts[first][second].load();
+      if (count > 0) {
+        counts.emplace_back(
+            toString(static_cast<OpCode>(first)),
+            toString(static_cast<OpCode>(second)),
+            count);
+      }
+    }
+  }
+  std::sort(counts.begin(), counts.end(), [](const auto& a, const auto& b) {
+    return std::get<2>(a) > std::get<2>(b);
+  });
+  return counts;
+}
+
+void setMaxConcurrentForks(size_t max_forks) {
+  max_concurrent_forks.store(max_forks);
+}
+
+size_t maxConcurrentForks() {
+  return max_concurrent_forks.load();
+}
+
+void resetInstructionPairCounts() {
+  for (auto& counts : instruction_pair_counts) {
+    for (auto& count : counts) {
+      count.store(0);
+    }
+  }
+}
+
 InterpreterState::InterpreterState(const Code& code)
     : pImpl(c10::make_intrusive<InterpreterStateImpl>(code)) {}
 InterpreterState::~InterpreterState() = default;
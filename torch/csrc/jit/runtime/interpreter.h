@@ -1,6 +1,8 @@
 #pragma once
 #include <c10/util/Optional.h>
 #include <memory>
+#include <string>
+#include <tuple>
 #include <vector>
 
 #include <ATen/ThreadLocalState.h>
@@ -80,6 +82,26 @@ struct InterpreterState {
   friend struct InterpreterStateImpl;
 };
 
+// Whether the Code built from now on fuses the common sequences of
+// instructions into superinstructions, which it does by default.
+TORCH_API void setSuperinstructionsEnabled(bool enabled);
+TORCH_API bool superinstructionsEnabled();
+
+// While enabled, the interpreter counts the pairs of consecutive instructions
+// it runs, to find the sequences worth fusing into a superinstruction.
+TORCH_API void setInstructionProfilingEnabled(bool enabled);
+// The opcodes of the pairs counted since the last reset, and their counts,
+// most frequent first.
+TORCH_API std::vector<std::tuple<std::string, std::string, uint64_t>>
+instructionPairCounts();
+TORCH_API void resetInstructionPairCounts();
+
+// The number of forked functions that run on the inter-op pool at once, 0,
+// the default, for no limit. The forks over the limit are queued, and a wait
+// on the future of a fork that didn't start yet runs it inline.
+TORCH_API void setMaxConcurrentForks(size_t max_forks);
+TORCH_API size_t maxConcurrentForks();
+
 // Created by wait()
 struct Suspend : public std::exception {
   const char* what() const noexcept override {
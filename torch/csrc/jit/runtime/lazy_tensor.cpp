@@ -0,0 +1,494 @@
+#include <torch/csrc/jit/runtime/lazy_tensor.h>
+
+#include <ATen/ExpandUtils.h>
+#include <ATen/core/dispatch/Dispatcher.h>
+#include <torch/csrc/jit/ir/ir.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/runtime/graph_executor.h>
+#include <torch/library.h>
+
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+struct LazyValue;
+using LazyValuePtr = std::shared_ptr<LazyValue>;
+
+// An argument of a recorded op: either a lazy value, or an eager tensor or
+// a constant.
+struct LazyArgument {
+  LazyValuePtr lazy;
+  IValue value;
+};
+
+// The value of a lazy tensor, shared with its shallow copies. It is either
+// computed by a recorded op from its arguments, or, once it has been
+// materialized (and for the tensors made lazy by toLazy), held by an eager
+// tensor.
+struct LazyValue {
+  Symbol op;
+  std::vector<LazyArgument> arguments;
+  at::Tensor eager;
+};
+
+// All the fields of the lazy values, the list of the pending ones and the
+// graph cache are guarded by this mutex.
+std::mutex lazy_mutex;
+
+// The lazy values computed by recorded ops, some of which may have been
+// materialized or destroyed since, for syncLazyTensors.
+std::vector<std::weak_ptr<LazyValue>>& pendingValues() {
+  static std::vector<std::weak_ptr<LazyValue>> values;
+  return values;
+}
+
+std::unordered_map<std::string, GraphExecutor>& graphCache() {
+  static std::unordered_map<std::string, GraphExecutor> cache;
+  return cache;
+}
+
+struct LazyTensorImpl : public c10::TensorImpl {
+  LazyTensorImpl(
+      LazyValuePtr value,
+      const caffe2::TypeMeta& data_type,
+      c10::Device device,
+      at::IntArrayRef sizes)
+      : TensorImpl(
+            c10::DispatchKeySet(c10::DispatchKey::Lazy),
+            data_type,
+            device),
+        value_(std::move(value)) {
+    set_sizes_contiguous(sizes);
+  }
+
+  bool has_storage() const override {
+    return false;
+  }
+
+  const at::Storage& storage() const override {
+    TORCH_CHECK(
+        false,
+        "lazy tensors do not have storage, use "
+        "torch._C._jit_lazy_materialize to get their values");
+  }
+
+  int64_t storage_offset() const override {
+    TORCH_CHECK(false, "lazy tensors do not have storage");
+  }
+
+  void release_resources() override {
+    TensorImpl::release_resources();
+    value_.reset();
+  }
+
+  c10::intrusive_ptr<TensorImpl> shallow_copy_and_detach(
+      const c10::VariableVersion& version_counter,
+      bool allow_tensor_metadata_change) const override {
+    auto impl = c10::make_intrusive<LazyTensorImpl>(
+        value_, dtype(), device(), sizes());
+    copy_tensor_metadata(
+        /*src_impl=*/this,
+        /*dest_impl=*/impl.get(),
+        /*version_counter=*/version_counter,
+        /*allow_tensor_metadata_change=*/allow_tensor_metadata_change);
+    return impl;
+  }
+
+  void shallow_copy_from(const c10::intrusive_ptr<TensorImpl>& impl) override {
+    AT_ASSERT(has_compatible_shallow_copy_type(impl->key_set()));
+    copy_tensor_metadata(
+        /*src_impl=*/impl.get(),
+        /*dest_impl=*/this,
+        /*version_counter=*/version_counter(),
+        /*allow_tensor_metadata_change=*/allow_tensor_metadata_change());
+    value_ = static_cast<const LazyTensorImpl*>(impl.get())->value_;
+  }
+
+  const LazyValuePtr& value() const {
+    return value_;
+  }
+
+ private:
+  LazyValuePtr value_;
+};
+
+const LazyValuePtr& lazyValue(const at::Tensor& tensor) {
+  return static_cast<LazyTensorImpl*>(tensor.unsafeGetTensorImpl())->value();
+}
+
+at::Tensor makeLazy(
+    LazyValuePtr value,
+    const caffe2::TypeMeta& data_type,
+    c10::Device device,
+    at::IntArrayRef sizes) {
+  return at::detail::make_tensor<LazyTensorImpl>(
+      std::move(value), data_type, device, sizes);
+}
+
+// Builds the graph computing `roots`, whose inputs are the eager tensors
+// they depend on, pushed onto `inputs`.
+std::shared_ptr<Graph> buildGraph(
+    const std::vector<LazyValuePtr>& roots,
+    Stack& inputs) {
+  auto graph = std::make_shared<Graph>();
+  std::unordered_map<const LazyValue*, Value*> values;
+  std::unordered_map<const c10::TensorImpl*, Value*> eager_inputs;
+  auto eagerInput = [&](const at::Tensor& tensor) {
+    auto it = eager_inputs.find(tensor.unsafeGetTensorImpl());
+    if (it != eager_inputs.end()) {
+      return it->second;
+    }
+    Value* input = graph->addInput()->setType(TensorType::create(tensor));
+    inputs.emplace_back(tensor);
+    eager_inputs.emplace(tensor.unsafeGetTensorImpl(), input);
+    return input;
+  };
+
+  // The recorded graphs are as deep as the chains of ops, so they are walked
+  // without recursing: a value is visited once to push its arguments, and a
+  // second time, once they have been emitted, to emit its op.
+  std::vector<std::pair<const LazyValue*, bool>> todo;
+  for (auto it = roots.rbegin(); it != roots.rend(); ++it) {
+    todo.emplace_back(it->get(), false);
+  }
+  while (!todo.empty()) {
+    const LazyValue* value = todo.back().first;
+    const bool arguments_emitted = todo.back().second;
+    todo.pop_back();
+    if (values.count(value)) {
+      continue;
+    }
+    if (value->eager.defined()) {
+      values.emplace(value, eagerInput(value->eager));
+      continue;
+    }
+    if (!arguments_emitted) {
+      todo.emplace_back(value, true);
+      for (auto it = value->arguments.rbegin(); it != value->arguments.rend();
+           ++it) {
+        if (it->lazy && !values.count(it->lazy.get())) {
+          todo.emplace_back(it->lazy.get(), false);
+        }
+      }
+      continue;
+    }
+    Node* node = graph->create(value->op, /*num_outputs=*/1);
+    for (const auto& argument : value->arguments) {
+      if (argument.lazy) {
+        node->addInput(values.at(argument.lazy.get()));
+      } else if (argument.value.isTensor()) {
+        node->addInput(eagerInput(argument.value.toTensor()));
+      } else {
+        node->addInput(graph->insertConstant(argument.value));
+      }
+    }
+    graph->insertNode(node);
+    node->output()->setType(TensorType::get());
+    values.emplace(value, node->output());
+  }
+
+  for (const auto& root : roots) {
+    graph->registerOutput(values.at(root.get()));
+  }
+  return graph;
+}
+
+// Computes the eager values of `roots`. Must be called with lazy_mutex held.
+void materializeValues(const std::vector<LazyValuePtr>& roots) {
+  std::vector<LazyValuePtr> pending;
+  for (const auto& root : roots) {
+    if (!root->eager.defined()) {
+      pending.push_back(root);
+    }
+  }
+  if (pending.empty()) {
+    return;
+  }
+
+  Stack stack;
+  auto graph = buildGraph(pending, stack);
+  const auto key = graph->toString(/*print_source_locations=*/false);
+  auto it = graphCache().find(key);
+  if (it == graphCache().end()) {
+    GRAPH_DUMP("Compiling the graph of lazy tensors: ", graph);
+    it = graphCache().emplace(key, GraphExecutor(graph, "lazy")).first;
+  }
+  {
+    // The values of lazy tensors have no autograd history, autograd has
+    // recorded the ops on the lazy tensors themselves.
+    at::AutoNonVariableTypeMode non_var_type_mode(true);
+    at::NoGradGuard no_grad;
+    it->second.run(stack);
+  }
+  TORCH_INTERNAL_ASSERT(stack.size() == pending.size());
+  for (size_t i = 0; i < pending.size(); ++i) {
+    pending[i]->eager = std::move(stack[i]).toTensor();
+    // Release the arguments, which are no longer needed.
+    pending[i]->arguments.clear();
+  }
+}
+
+// The ops recorded by the fallback. They are pointwise, so their results
+// have the size their tensor arguments broadcast to, and they are only
+// recorded when these arguments have the same floating point dtype, which is
+// the dtype of their results.
+const std::unordered_set<std::string>& recordedOps() {
+  static const std::unordered_set<std::string> ops = {
+      "aten::add.Tensor",
+      "aten::add.Scalar",
+      "aten::sub.Tensor",
+      "aten::sub.Scalar",
+      "aten::mul.Tensor",
+      "aten::mul.Scalar",
+      "aten::div.Tensor",
+      "aten::div.Scalar",
+      "aten::neg",
+      "aten::abs",
+      "aten::reciprocal",
+      "aten::exp",
+      "aten::log",
+      "aten::sqrt",
+      "aten::rsqrt",
+      "aten::pow.Tensor_Scalar",
+      "aten::relu",
+      "aten::sigmoid",
+      "aten::tanh",
+      "aten::threshold_backward",
+      "aten::sigmoid_backward",
+      "aten::tanh_backward",
+  };
+  return ops;
+}
+
+std::string qualifiedName(const c10::FunctionSchema& schema) {
+  if (schema.overload_name().empty()) {
+    return schema.name();
+  }
+  return schema.name() + "." + schema.overload_name();
+}
+
+// Records the op of `schema` on `arguments` instead of running it, if it is
+// one of the recorded ops and all its tensor arguments qualify. Returns the
+// lazy result, or an undefined tensor if the op has to run eagerly.
+at::Tensor maybeRecord(
+    const c10::FunctionSchema& schema,
+    at::ArrayRef<IValue> arguments) {
+  if (!recordedOps().count(qualifiedName(schema))) {
+    return at::Tensor();
+  }
+  c10::optional<caffe2::TypeMeta> dtype;
+  c10::optional<c10::Device> device;
+  std::vector<int64_t> sizes;
+  for (const auto& argument : arguments) {
+    if (!argument.isTensor()) {
+      continue;
+    }
+    const auto& tensor = argument.toTensor();
+    if (!tensor.defined()) {
+      return at::Tensor();
+    }
+    // Numbers wrapped into tensors don't take part in type promotion with
+    // floating point tensors, and are 0-dim.
+    if (tensor.unsafeGetTensorImpl()->is_wrapped_number()) {
+      if (at::isComplexType(tensor.scalar_type())) {
+        return at::Tensor();
+      }
+      continue;
+    }
+    if (!dtype) {
+      if (!at::isFloatingType(tensor.scalar_type())) {
+        return at::Tensor();
+      }
+      dtype = tensor.dtype();
+      device = tensor.device();
+    } else if (tensor.dtype() != *dtype || tensor.device() != *device) {
+      return at::Tensor();
+    }
+    sizes = at::infer_size(sizes, tensor.sizes());
+  }
+  if (!dtype) {
+    return at::Tensor();
+  }
+
+  auto value = std::make_shared<LazyValue>();
+  value->op = Symbol::fromQualString(schema.name());
+  value->arguments.reserve(arguments.size());
+  for (const auto& argument : arguments) {
+    if (argument.isTensor() && isLazy(argument.toTensor())) {
+      value->arguments.push_back({lazyValue(argument.toTensor()), IValue()});
+    } else {
+      value->arguments.push_back({nullptr, argument});
+    }
+  }
+  {
+    std::lock_guard<std::mutex> guard(lazy_mutex);
+    auto& pending = pendingValues();
+    // Drop the values that were materialized or destroyed every now and then,
+    // so that the list doesn't keep growing along with the number of ops.
+    if (pending.size() >= 1024 && (pending.size() & (pending.size() - 1)) == 0) {
+      pending.erase(
+          std::remove_if(
+              pending.begin(),
+              pending.end(),
+              [](const std::weak_ptr<LazyValue>& weak) {
+                auto value = weak.lock();
+                return !value || value->eager.defined();
+              }),
+          pending.end());
+    }
+    pending.push_back(value);
+  }
+  return makeLazy(std::move(value), *dtype, *device, sizes);
+}
+
+// Replaces the lazy tensors in `value` by their eager values, and records
+// which lazy tensor every eager value belongs to into `lazy_tensors`.
+void materializeArgument(
+    IValue& value,
+    std::unordered_map<const c10::TensorImpl*, at::Tensor>& lazy_tensors) {
+  if (value.isTensor()) {
+    const auto& tensor = value.toTensor();
+    if (isLazy(tensor)) {
+      auto eager = materializeLazy(tensor);
+      lazy_tensors.emplace(eager.unsafeGetTensorImpl(), tensor);
+      value = std::move(eager);
+    }
+  } else if (value.isTensorList()) {
+    auto list = value.toTensorList();
+    for (size_t i = 0; i < list.size(); ++i) {
+      const at::Tensor tensor = list[i];
+      if (isLazy(tensor)) {
+        auto eager = materializeLazy(tensor);
+        lazy_tensors.emplace(eager.unsafeGetTensorImpl(), tensor);
+        list[i] = std::move(eager);
+      }
+    }
+  } else if (value.isList()) {
+    auto list = value.toList();
+    for (size_t i = 0; i < list.size(); ++i) {
+      IValue element = list[i];
+      materializeArgument(element, lazy_tensors);
+      list[i] = std::move(element);
+    }
+  }
+}
+
+// Makes the tensors in a result of an eagerly run op lazy. The results that
+// are arguments of the op (in place ops return those they modify) are
+// replaced by the lazy tensors these arguments were materialized from; the
+// results of ops that modify their arguments in place otherwise stay as
+// they are.
+void makeResultLazy(
+    IValue& value,
+    const std::unordered_map<const c10::TensorImpl*, at::Tensor>& lazy_tensors,
+    bool is_mutable) {
+  auto wrap = [&](const at::Tensor& tensor) {
+    auto it = lazy_tensors.find(tensor.unsafeGetTensorImpl());
+    if (it != lazy_tensors.end()) {
+      return it->second;
+    }
+    if (!tensor.defined() || is_mutable || isLazy(tensor)) {
+      return tensor;
+    }
+    return toLazy(tensor);
+  };
+  if (value.isTensor()) {
+    value = wrap(value.toTensor());
+  } else if (value.isTensorList()) {
+    auto list = value.toTensorList();
+    for (size_t i = 0; i < list.size(); ++i) {
+      list[i] = wrap(list[i]);
+    }
+  }
+}
+
+void lazyFallback(const c10::OperatorHandle& op, Stack* stack) {
+  const auto& schema = op.schema();
+  const auto num_arguments = schema.arguments().size();
+  const auto arguments_begin = stack->size() - num_arguments;
+
+  if (!schema.is_mutable() && schema.returns().size() == 1) {
+    auto result = maybeRecord(schema, torch::jit::last(stack, num_arguments));
+    if (result.defined()) {
+      drop(stack, num_arguments);
+      push(stack, std::move(result));
+      return;
+    }
+  }
+
+  if (schema.is_mutable()) {
+    syncLazyTensors();
+  }
+  std::unordered_map<const c10::TensorImpl*, at::Tensor> lazy_tensors;
+  for (size_t i = arguments_begin; i < stack->size(); ++i) {
+    materializeArgument((*stack)[i], lazy_tensors);
+  }
+
+  op.callBoxed(stack);
+
+  const auto num_returns = schema.returns().size();
+  for (size_t i = stack->size() - num_returns; i < stack->size(); ++i) {
+    makeResultLazy((*stack)[i], lazy_tensors, schema.is_mutable());
+  }
+}
+
+TORCH_LIBRARY_IMPL(_, Lazy, m) {
+  m.fallback(torch::CppFunction::makeFromBoxedFunction<&lazyFallback>());
+}
+
+} // namespace
+
+at::Tensor toLazy(const at::Tensor& tensor) {
+  TORCH_CHECK(tensor.defined(), "Expected a defined tensor");
+  if (isLazy(tensor)) {
+    return tensor;
+  }
+  TORCH_CHECK(
+      tensor.layout() == at::kStrided && !tensor.is_quantized(),
+      "Only dense tensors can be made lazy, got a tensor of type ",
+      tensor.toString());
+  auto value = std::make_shared<LazyValue>();
+  value->eager = tensor;
+  return makeLazy(
+      std::move(value), tensor.dtype(), tensor.device(), tensor.sizes());
+}
+
+bool isLazy(const at::Tensor& tensor) {
+  return tensor.defined() &&
+      tensor.unsafeGetTensorImpl()->key_set().has(c10::DispatchKey::Lazy);
+}
+
+at::Tensor materializeLazy(const at::Tensor& tensor) {
+  if (!isLazy(tensor)) {
+    return tensor;
+  }
+  const auto& value = lazyValue(tensor);
+  std::lock_guard<std::mutex> guard(lazy_mutex);
+  materializeValues({value});
+  return value->eager;
+}
+
+void syncLazyTensors() {
+  std::lock_guard<std::mutex> guard(lazy_mutex);
+  std::vector<LazyValuePtr> values;
+  for (const auto& weak : pendingValues()) {
+    if (auto value = weak.lock()) {
+      values.push_back(std::move(value));
+    }
+  }
+  pendingValues().clear();
+  materializeValues(values);
+}
+
+size_t lazyGraphCacheSize() {
+  std::lock_guard<std::mutex> guard(lazy_mutex);
+  return graphCache().size();
+}
+
+} // namespace jit
+} // namespace torch
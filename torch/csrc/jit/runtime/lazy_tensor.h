@@ -0,0 +1,51 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+namespace torch {
+namespace jit {
+
+// Lazy tensors defer the execution of eager ops to fuse them. They dispatch on
+// DispatchKey::Lazy, whose fallback records the pointwise ops (add, mul,
+// sigmoid, their backwards, ...) run on lazy tensors into a graph of the ops
+// instead of running them; the result is a lazy tensor of the inferred size,
+// dtype and device. The graph of a lazy tensor is built into a TorchScript
+// Graph when its value is needed, i.e. when it is passed to an op that isn't
+// recorded, including item(), printing and device transfers. Graphs are
+// cached by their IR, inputs types included, and run by a GraphExecutor each,
+// so the graphs of a training loop are profiled and fused (e.g. by NNC) by
+// the profiling executor as those of scripted functions are.
+//
+// The ops that aren't recorded run eagerly on the values of their lazy
+// arguments, and their tensor results are made lazy, so that the pointwise
+// ops following them are recorded again; the arguments they modify in
+// place keep their values. Before an op on lazy tensors modifies one of its
+// arguments in place, all the recorded ops of the process are run, so that
+// the values they were recorded on aren't changed under them. Eager tensors
+// that recorded ops use must not be modified in place by ops on eager
+// tensors only, which the fallback doesn't see, until these ops have run.
+//
+// Lazy tensors have no storage and contiguous strides; autograd works on
+// them as on the dense tensors of their device. As any boxed fallback, this
+// one doesn't support the ops that can't be boxed yet.
+
+// Returns a lazy tensor whose value is `tensor` itself (not a copy of it), so
+// that it sees the ops modifying `tensor` in place and the other way around.
+TORCH_API at::Tensor toLazy(const at::Tensor& tensor);
+
+TORCH_API bool isLazy(const at::Tensor& tensor);
+
+// Returns the value of a lazy tensor as an eager tensor, without autograd
+// history, running the ops it was recorded from if needed. Eager tensors are
+// returned as is.
+TORCH_API at::Tensor materializeLazy(const at::Tensor& tensor);
+
+// Runs the recorded ops of all the lazy tensors that are alive.
+TORCH_API void syncLazyTensors();
+
+// The number of graphs compiled for lazy tensors so far.
+TORCH_API size_t lazyGraphCacheSize();
+
+} // namespace jit
+} // namespace torch
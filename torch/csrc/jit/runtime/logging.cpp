@@ -1,5 +1,7 @@
 #include <torch/csrc/jit/runtime/logging.h>
 
+#include <c10/util/Metrics.h>
+
 #include <atomic>
 #include <mutex>
 #include <unordered_map>
@@ -67,6 +69,15 @@ void recordDurationSince(const std::string& name, JITTimePoint tp) {
   logging::getLogger()->addStatValue(name, seconds);
 }
 
+void recordGraphCompilationSince(JITTimePoint tp) {
+  C10_METRICS_HISTOGRAM_RECORD(
+      "torch_jit_graph_compilation_us",
+      "Time the graph executors took to optimize a graph into a plan",
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::high_resolution_clock::now() - tp.point)
+          .count());
+}
+
 } // namespace logging
 } // namespace jit
 } // namespace torch
@@ -63,6 +63,10 @@ struct JITTimePoint {
 TORCH_API JITTimePoint timePoint();
 TORCH_API void recordDurationSince(const std::string& name, JITTimePoint tp);
 
+// Records the time since tp in the c10::metrics histogram of the compilations
+// of the graph executors, if the metrics are enabled.
+TORCH_API void recordGraphCompilationSince(JITTimePoint tp);
+
 namespace runtime_counters {
 constexpr const char* GRAPH_EXECUTORS_CONSTRUCTED =
     "pytorch_runtime.graph_executors_constructed";
@@ -237,6 +237,7 @@ bool printerHasSpecialCaseFor(Symbol sym) {
       prim::Load, // used in interpreter only
       prim::MMTreeReduce, // used as an optimization
       prim::MMBatchSide, // used as an optimization
+      prim::BatchedGEMM, // used as an optimization
       prim::Store, // used in interpreter only
       prim::profile, // used in interpreter only
 
@@ -277,6 +278,7 @@ bool aliasAnalysisHasSpecialCaseFor(Symbol symbol) {
       prim::GradOf,
       prim::MMTreeReduce,
       prim::MMBatchSide,
+      prim::BatchedGEMM,
       prim::BroadcastSizes,
       prim::ChunkSizes,
       prim::Function,
@@ -0,0 +1,348 @@
+#include <torch/csrc/jit/runtime/profile_cache.h>
+
+#include <ATen/Version.h>
+#include <ATen/detail/CUDAHooksInterface.h>
+#include <ATen/native/DispatchStub.h>
+#include <torch/csrc/jit/jit_log.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <unordered_map>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+constexpr const char* kProfileCacheMagic = "torch_jit_profile";
+// Bumped whenever the format of the entries changes.
+constexpr int kProfileCacheVersion = 1;
+
+std::mutex profile_cache_mutex;
+
+std::string& profileCacheDir() {
+  static std::string dir = [] {
+    const char* env = std::getenv("PYTORCH_JIT_PROFILE_CACHE_DIR");
+    return std::string(env ? env : "");
+  }();
+  return dir;
+}
+
+// FNV-1a, as the keys must be the same in every process.
+uint64_t stableHash(const std::string& str) {
+  uint64_t hash = 14695981039346656037ull;
+  for (unsigned char c : str) {
+    hash ^= c;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+std::string toHex(uint64_t value) {
+  std::ostringstream ss;
+  ss << std::hex << value;
+  return ss.str();
+}
+
+// The profiles depend on the kernels the build and the machine pick, e.g.,
+// through the strides of their outputs, so they are only reused by the same
+// build on a machine with the same CPU capability and number of GPUs.
+const std::string& machineSignature() {
+  static const std::string signature = [] {
+    std::ostringstream ss;
+    ss << at::show_config() << ";cpu_capability="
+       << static_cast<int>(at::native::get_cpu_capability())
+       << ";num_gpus=" << at::detail::getCUDAHooks().getNumGPUs();
+    return toHex(stableHash(ss.str()));
+  }();
+  return signature;
+}
+
+std::string entryPath(const std::string& dir, const std::string& key) {
+  return dir + "/" + key + ".profile";
+}
+
+// The nodes profiling a value, in the order they appear in the graph.
+void collectProfileNodes(Block* block, std::vector<Node*>& nodes) {
+  for (Node* n : block->nodes()) {
+    if (n->kind() == prim::profile && n->outputs().size() == 1) {
+      nodes.push_back(n);
+    }
+    for (Block* b : n->blocks()) {
+      collectProfileNodes(b, nodes);
+    }
+  }
+}
+
+template <typename T>
+void writeOptional(std::ostream& out, const c10::optional<T>& value) {
+  if (value) {
+    out << *value;
+  } else {
+    out << '-';
+  }
+}
+
+// A type is written as its scalar type, device, requires_grad, undefined,
+// sizes and strides, separated by spaces, '-' standing for unknown values.
+// The sizes that aren't static are written as symbols numbered in the order
+// they appear in the profile, as the symbols of a process aren't those of
+// another one.
+void writeType(
+    std::ostream& out,
+    const TensorTypePtr& type,
+    std::map<c10::ShapeSymbol, size_t>& symbols) {
+  auto scalar_type = type->scalarType();
+  if (scalar_type) {
+    out << static_cast<int>(*scalar_type);
+  } else {
+    out << '-';
+  }
+  out << ' ';
+  if (type->device()) {
+    out << type->device()->str();
+  } else {
+    out << '-';
+  }
+  out << ' ';
+  writeOptional(out, type->requiresGrad());
+  out << ' ';
+  writeOptional(out, type->undefined());
+
+  auto sizes = type->symbolic_sizes().sizes();
+  out << ' ';
+  writeOptional(out, type->symbolic_sizes().rank());
+  if (sizes) {
+    for (const auto& symbol : *sizes) {
+      out << ' ';
+      if (symbol.is_static()) {
+        out << symbol.static_size();
+      } else {
+        auto it = symbols.emplace(symbol, symbols.size()).first;
+        out << 's' << it->second;
+      }
+    }
+  }
+
+  auto strides = type->stride_properties().sizes();
+  out << ' ';
+  writeOptional(out, type->stride_properties().size());
+  if (strides) {
+    for (const auto& stride : *strides) {
+      out << ' ';
+      if (!stride) {
+        out << '-';
+        continue;
+      }
+      writeOptional(out, stride->stride_index_);
+      out << ',';
+      writeOptional(out, stride->contiguous_);
+      out << ',';
+      writeOptional(out, stride->stride_);
+    }
+  }
+  out << '\n';
+}
+
+std::string readToken(std::istream& in) {
+  std::string token;
+  TORCH_CHECK(in >> token, "truncated profile cache entry");
+  return token;
+}
+
+c10::optional<int64_t> parseOptionalInt(const std::string& token) {
+  if (token == "-") {
+    return c10::nullopt;
+  }
+  size_t end = 0;
+  int64_t value = std::stoll(token, &end);
+  TORCH_CHECK(end == token.size(), "invalid profile cache value ", token);
+  return value;
+}
+
+c10::optional<bool> parseOptionalBool(const std::string& token) {
+  auto value = parseOptionalInt(token);
+  if (!value) {
+    return c10::nullopt;
+  }
+  TORCH_CHECK(*value == 0 || *value == 1, "invalid profile cache value ", token);
+  return *value == 1;
+}
+
+c10::optional<size_t> parseOptionalSize(const std::string& token) {
+  auto value = parseOptionalInt(token);
+  if (!value) {
+    return c10::nullopt;
+  }
+  TORCH_CHECK(*value >= 0, "invalid profile cache value ", token);
+  return static_cast<size_t>(*value);
+}
+
+TensorTypePtr readType(
+    std::istream& in,
+    std::unordered_map<std::string, c10::ShapeSymbol>& symbols) {
+  c10::optional<at::ScalarType> scalar_type;
+  if (auto value = parseOptionalInt(readToken(in))) {
+    TORCH_CHECK(
+        *value >= 0 &&
+            *value < static_cast<int64_t>(at::ScalarType::NumOptions),
+        "invalid scalar type in profile cache entry");
+    scalar_type = static_cast<at::ScalarType>(*value);
+  }
+  c10::optional<at::Device> device;
+  auto device_token = readToken(in);
+  if (device_token != "-") {
+    device = at::Device(device_token);
+  }
+  auto requires_grad = parseOptionalBool(readToken(in));
+  auto undefined = parseOptionalBool(readToken(in));
+
+  c10::SymbolicShape sizes;
+  if (auto rank = parseOptionalSize(readToken(in))) {
+    std::vector<c10::ShapeSymbol> dims;
+    for (size_t i = 0; i < *rank; ++i) {
+      auto token = readToken(in);
+      if (token[0] == 's') {
+        auto it = symbols.find(token);
+        if (it == symbols.end()) {
+          it = symbols.emplace(token, c10::ShapeSymbol::newSymbol()).first;
+        }
+        dims.push_back(it->second);
+      } else {
+        auto size = parseOptionalSize(token);
+        TORCH_CHECK(size, "invalid size in profile cache entry");
+        dims.push_back(c10::ShapeSymbol::fromStaticSize(*size));
+      }
+    }
+    sizes = c10::SymbolicShape(dims);
+  }
+
+  c10::VaryingShape<c10::Stride> strides;
+  if (auto rank = parseOptionalSize(readToken(in))) {
+    std::vector<c10::optional<c10::Stride>> dims;
+    for (size_t i = 0; i < *rank; ++i) {
+      auto token = readToken(in);
+      if (token == "-") {
+        dims.emplace_back();
+        continue;
+      }
+      std::istringstream fields(token);
+      std::string index, contiguous, stride;
+      TORCH_CHECK(
+          std::getline(fields, index, ',') &&
+              std::getline(fields, contiguous, ',') &&
+              std::getline(fields, stride),
+          "invalid stride in profile cache entry");
+      dims.emplace_back(c10::Stride(
+          parseOptionalSize(index),
+          parseOptionalBool(contiguous),
+          parseOptionalSize(stride)));
+    }
+    strides = c10::VaryingShape<c10::Stride>(std::move(dims));
+  }
+  return TensorType::create(
+      scalar_type, device, sizes, strides, requires_grad, undefined);
+}
+
+} // namespace
+
+void setProfileCacheDir(std::string dir) {
+  std::lock_guard<std::mutex> lock(profile_cache_mutex);
+  profileCacheDir() = std::move(dir);
+}
+
+std::string getProfileCacheDir() {
+  std::lock_guard<std::mutex> lock(profile_cache_mutex);
+  return profileCacheDir();
+}
+
+std::string profileCacheKey(const ProfilingRecord& pr) {
+  if (getProfileCacheDir().empty()) {
+    return "";
+  }
+  return toHex(stableHash(pr.graph()->toString(false)));
+}
+
+bool loadCachedProfile(const std::string& key, ProfilingRecord& pr) {
+  auto dir = getProfileCacheDir();
+  if (key.empty() || dir.empty()) {
+    return false;
+  }
+  std::ifstream in(entryPath(dir, key));
+  if (!in) {
+    return false;
+  }
+
+  std::vector<Node*> nodes;
+  collectProfileNodes(pr.graph()->block(), nodes);
+  std::vector<TensorTypePtr> types;
+  try {
+    std::string magic, signature;
+    int version = 0;
+    size_t num_types = 0;
+    in >> magic >> version >> signature >> num_types;
+    if (!in || magic != kProfileCacheMagic ||
+        version != kProfileCacheVersion || signature != machineSignature() ||
+        num_types != nodes.size()) {
+      GRAPH_DEBUG("Ignoring the stale profile cache entry ", key);
+      return false;
+    }
+    std::unordered_map<std::string, c10::ShapeSymbol> symbols;
+    for (size_t i = 0; i < num_types; ++i) {
+      types.push_back(readType(in, symbols));
+    }
+  } catch (const std::exception& e) {
+    GRAPH_DEBUG("Ignoring the invalid profile cache entry ", key, ": ", e.what());
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(pr.mutex_);
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    nodes[i]->ty_(attr::profiled_type, types[i]);
+  }
+  pr.profiling_count_ = 0;
+  GRAPH_DEBUG("Loaded the profile of ", nodes.size(), " values from ", key);
+  return true;
+}
+
+void storeProfile(const std::string& key, const ProfilingRecord& pr) {
+  auto dir = getProfileCacheDir();
+  if (key.empty() || dir.empty()) {
+    return;
+  }
+  std::vector<Node*> nodes;
+  collectProfileNodes(pr.graph()->block(), nodes);
+
+  std::ostringstream entry;
+  entry << kProfileCacheMagic << ' ' << kProfileCacheVersion << ' '
+        << machineSignature() << ' ' << nodes.size() << '\n';
+  std::map<c10::ShapeSymbol, size_t> symbols;
+  for (Node* n : nodes) {
+    writeType(entry, n->ty(attr::profiled_type)->expect<TensorType>(), symbols);
+  }
+
+  // Every process writes a file of its own then renames it, so that the
+  // processes reading the entry never see a partial one.
+  auto path = entryPath(dir, key);
+  auto tmp_path = path + ".tmp" + toHex(std::random_device()());
+  {
+    std::ofstream out(tmp_path);
+    out << entry.str();
+    if (!out) {
+      GRAPH_DEBUG("Couldn't write the profile cache entry ", tmp_path);
+      std::remove(tmp_path.c_str());
+      return;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    std::remove(tmp_path.c_str());
+  }
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+#include <torch/csrc/jit/runtime/profiling_record.h>
+
+#include <string>
+
+namespace torch {
+namespace jit {
+
+// A cache of the types the profiling executor records, kept on disk so that
+// a process running the same graphs on the same kind of machine optimizes
+// them on their first run instead of profiling them again. Every graph has
+// a file in the cache directory, named by the hash of its instrumented
+// graph, that holds the merged profiled types of its profile nodes and the
+// signature of the build and machine that recorded them. The optimizations
+// still run, on a graph carrying the cached profile, and the guards they
+// insert check the inputs against it like against a profile of this process.
+//
+// The cache is disabled when the directory is empty, which is the default
+// unless PYTORCH_JIT_PROFILE_CACHE_DIR is set. The directory must exist.
+TORCH_API void setProfileCacheDir(std::string dir);
+TORCH_API std::string getProfileCacheDir();
+
+// The key of the cache entry of the graph `pr` instrumented, or an empty
+// string if the cache is disabled. It must be computed before the graph runs,
+// as the profiled types are part of the graph.
+TORCH_API std::string profileCacheKey(const ProfilingRecord& pr);
+
+// Annotates the profile nodes of the graph of `pr` with the cached profile
+// of `key` and marks `pr` as ready. Returns false, leaving `pr` unchanged, if
+// there is no entry for `key` that was recorded by this build on this kind of
+// machine for a graph with as many profile nodes.
+TORCH_API bool loadCachedProfile(const std::string& key, ProfilingRecord& pr);
+
+// Writes the profile `pr` recorded into the entry of `key`.
+TORCH_API void storeProfile(const std::string& key, const ProfilingRecord& pr);
+
+} // namespace jit
+} // namespace torch
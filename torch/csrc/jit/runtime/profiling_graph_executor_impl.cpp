@@ -1,4 +1,5 @@
 #include <torch/csrc/jit/runtime/profiling_graph_executor_impl.h>
+#include <ATen/Parallel.h>
 #include <torch/csrc/jit/jit_log.h>
 #include <torch/csrc/jit/passes/bailout_graph.h>
 #include <torch/csrc/jit/passes/batch_mm.h>
@@ -27,6 +28,8 @@
 #include <torch/csrc/jit/passes/shape_analysis.h>
 #include <torch/csrc/jit/passes/specialize_autogradzero.h>
 #include <torch/csrc/jit/passes/tensorexpr_fuser.h>
+#include <torch/csrc/jit/runtime/logging.h>
+#include <torch/csrc/jit/runtime/profile_cache.h>
 
 C10_DECLARE_bool();
 
@@ -49,6 +52,7 @@ static std::atomic<bool> profiling_mode{false};
 
 static std::atomic<size_t> num_profiled_runs{1};
 static std::atomic<size_t> bailout_depth{1};
+static std::atomic<bool> background_optimization{false};
 
 std::atomic<bool>& getProfilingMode() {
   return profiling_mode;
@@ -65,6 +69,10 @@ std::atomic<size_t>& getBailoutDepth() {
   return bailout_depth;
 }
 
+std::atomic<bool>& getBackgroundOptimization() {
+  return background_optimization;
+}
+
 static bool needsGradientInProfilingMode(Block* b) {
   for (auto n : b->nodes()) {
     if (n->kind() == prim::BailOut) {
@@ -389,9 +397,13 @@ ExecutionPlan ProfilingGraphExecutorImpl::getPlanFor(
       PeelProfilingLoops(copy);
     }
     pr_ = ProfilingRecord::instrumentGraph(copy);
-    auto pr_copy = pr_->graph()->copy();
-    GRAPH_DUMP("Profiled Graph: ", pr_copy);
-    profiling_plan_ = ExecutionPlan(pr_copy, function_name_);
+    profile_cache_key_ = profileCacheKey(*pr_);
+    profile_from_cache_ = loadCachedProfile(profile_cache_key_, *pr_);
+    if (!profile_from_cache_) {
+      auto pr_copy = pr_->graph()->copy();
+      GRAPH_DUMP("Profiled Graph: ", pr_copy);
+      profiling_plan_ = ExecutionPlan(pr_copy, function_name_);
+    }
     // fall-through
   }
 
@@ -400,11 +412,69 @@ ExecutionPlan ProfilingGraphExecutorImpl::getPlanFor(
     return *profiling_plan_;
   }
 
+  if (!profile_from_cache_ && !background_optimization_) {
+    storeProfile(profile_cache_key_, *pr_);
+  }
+  if (getBackgroundOptimization()) {
+    return getBackgroundOptimizedPlan(remaining_bailout_depth);
+  }
+  const auto start = logging::timePoint();
   auto copy = pr_->graph()->copy();
   runProfilingOptimizations(copy);
   // cache
   optimized_plan_ =
       ExecutionPlan(copy, function_name_, remaining_bailout_depth);
+  logging::recordGraphCompilationSince(start);
+  return *optimized_plan_;
+}
+
+ExecutionPlan ProfilingGraphExecutorImpl::getBackgroundOptimizedPlan(
+    size_t remaining_bailout_depth) {
+  if (!background_optimization_) {
+    auto state = std::make_shared<BackgroundOptimization>();
+    background_optimization_ = state;
+    auto copy = pr_->graph()->copy();
+    // the optimizations read the thread local optimization flag
+    bool optimize = getGraphExecutorOptimize();
+    at::launch([state,
+                copy,
+                function_name = function_name_,
+                optimize,
+                remaining_bailout_depth]() mutable {
+      try {
+        GraphOptimizerEnabledGuard guard(optimize);
+        const auto start = logging::timePoint();
+        runProfilingOptimizations(copy);
+        ExecutionPlan plan(copy, function_name, remaining_bailout_depth);
+        logging::recordGraphCompilationSince(start);
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->plan = std::move(plan);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->error = std::current_exception();
+      }
+    });
+
+    auto fallback = graph->copy();
+    runProfilingInsensitiveOptimizations(fallback);
+    GRAPH_DUMP("Fallback Graph: ", fallback);
+    fallback_plan_ = ExecutionPlan(fallback, function_name_);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(background_optimization_->mutex);
+    if (background_optimization_->error) {
+      std::rethrow_exception(background_optimization_->error);
+    }
+    if (!background_optimization_->plan) {
+      return *fallback_plan_;
+    }
+    // the callers that got the fallback plan keep running it, and the next
+    // ones get the optimized plan
+    optimized_plan_ = std::move(background_optimization_->plan);
+  }
+  background_optimization_.reset();
+  fallback_plan_.reset();
   return *optimized_plan_;
 }
 
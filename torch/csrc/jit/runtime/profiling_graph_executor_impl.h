@@ -1,6 +1,8 @@
 #pragma once
 #include <torch/csrc/jit/runtime/graph_executor_impl.h>
 
+#include <exception>
+
 namespace torch {
 namespace jit {
 
@@ -16,11 +18,31 @@ struct ProfilingGraphExecutorImpl : public GraphExecutorImplBase {
 
  private:
   void runProfilingInsensitiveOptimizations(std::shared_ptr<Graph>& graph);
-  void runProfilingOptimizations(std::shared_ptr<Graph>& graph);
+  static void runProfilingOptimizations(std::shared_ptr<Graph>& graph);
+  // Starts optimizing the profiled graph in the background if it isn't
+  // already, and returns the optimized plan once it is ready, or a plan of
+  // the unprofiled graph until then.
+  ExecutionPlan getBackgroundOptimizedPlan(size_t remaining_bailout_depth);
+
+  // The result of an optimization running in the background, shared with
+  // the task running it, which may outlive the executor.
+  struct BackgroundOptimization {
+    std::mutex mutex;
+    c10::optional<ExecutionPlan> plan;
+    std::exception_ptr error;
+  };
+
   std::unique_ptr<ProfilingRecord> pr_;
   c10::optional<ExecutionPlan>
       profiling_plan_; // plan to run in order to profiling the code
   c10::optional<ExecutionPlan> optimized_plan_;
+  std::shared_ptr<BackgroundOptimization> background_optimization_;
+  // plan to run while the profiled graph is optimized in the background
+  c10::optional<ExecutionPlan> fallback_plan_;
+  // The key of the graph of pr_ in the profile cache, and whether its
+  // profile was loaded from it.
+  std::string profile_cache_key_;
+  bool profile_from_cache_ = false;
 };
 
 } // namespace jit
@@ -348,10 +348,14 @@ RegisterOperators reg(
            auto tuple = pop(stack).toTuple();
            auto norm_index = normalizeIndex(index, tuple->elements().size());
            if (norm_index < 0 ||
-               norm_index > static_cast<int64_t>(tuple->elements().size())) {
+               norm_index >= static_cast<int64_t>(tuple->elements().size())) {
              throw std::out_of_range("Tuple list index out of range");
            }
-           stack->emplace_back(tuple->elements()[norm_index]);
+           if (tuple.use_count() == 1) {
+             stack->emplace_back(std::move(tuple->elements()[norm_index]));
+           } else {
+             stack->emplace_back(tuple->elements()[norm_index]);
+           }
          },
          aliasAnalysisSpecialCase()),
      Operator(
@@ -1,31 +1,19 @@
 #include <torch/csrc/jit/runtime/static/impl.h>
-#include <ATen/core/op_registration/op_registration.h>
+#include <ATen/core/grad_mode.h>
+#include <c10/core/CPUAllocator.h>
+#include <torch/csrc/jit/ir/alias_analysis.h>
+#include <torch/csrc/jit/ir/constants.h>
 #include <torch/csrc/jit/passes/canonicalize.h>
 #include <torch/csrc/jit/passes/freeze_module.h>
+#include <torch/csrc/jit/passes/liveness.h>
 #include <torch/csrc/jit/passes/remove_mutation.h>
-#include <torch/csrc/jit/passes/subgraph_rewrite.h>
+
+#include <algorithm>
+#include <unordered_map>
 
 namespace torch {
 namespace jit {
 
-using c10::DispatchKey;
-using c10::RegisterOperators;
-
-static auto reg =
-    RegisterOperators()
-        .op("static::add(Tensor a, Tensor b) -> Tensor",
-            RegisterOperators::options().kernel(
-                DispatchKey::CPU,
-                [](at::Tensor a, at::Tensor b) -> at::Tensor { return a + b; }))
-        .op("static::mul.a(Tensor a, Tensor b) -> Tensor",
-            RegisterOperators::options().kernel(
-                DispatchKey::CPU,
-                [](at::Tensor a, at::Tensor b) -> at::Tensor { return a * b; }))
-        .op("static::mul.b(Tensor a, int b) -> Tensor",
-            RegisterOperators::options().kernel(
-                DispatchKey::CPU,
-                [](at::Tensor a, int64_t b) -> at::Tensor { return a * b; }));
-
 #define SUPPORTED_OPS(F) \
   F(aten::__getitem__)   \
   F(aten::add)           \
@@ -53,20 +41,20 @@ static auto reg =
   F(prim::ListConstruct) \
   F(prim::TupleConstruct)
 
-StaticRuntime::StaticRuntime(const torch::jit::Module& m)
-    : module_(m.deepcopy()), graph_(nullptr) {
-  module_.eval();
-  module_ = freeze_module(module_);
-  graph_ = module_.get_method("forward").graph();
-
-  Inline(*graph_);
-  ConstantPropagation(graph_);
-  Canonicalize(graph_);
-  ConstantPropagation(graph_);
-  RemoveTensorMutation(graph_);
-  ConstantPropagation(graph_);
-
-  for (auto n : graph_->nodes()) {
+InferenceModule::InferenceModule(const torch::jit::Module& m)
+    : module(m.deepcopy()), graph(nullptr) {
+  module.eval();
+  module = freeze_module(module);
+  graph = module.get_method("forward").graph();
+
+  Inline(*graph);
+  ConstantPropagation(graph);
+  Canonicalize(graph);
+  ConstantPropagation(graph);
+  RemoveTensorMutation(graph);
+  ConstantPropagation(graph);
+
+  for (auto n : graph->nodes()) {
     if (n->kind() == c10::Symbol::fromQualString("prim::GetAttr")) {
       throw std::runtime_error("Cannot accelerate unfrozen graphs");
     }
@@ -83,35 +71,191 @@ StaticRuntime::StaticRuntime(const torch::jit::Module& m)
     }
   }
 
-  SubgraphRewriter sr;
-  sr.RegisterRewritePattern(
-      R"IR(
-  graph(%x, %w, %s):
-    %r = aten::add(%x, %w, %s)
-    return (%r))IR",
-      R"IR(
-  graph(%x, %w, %s):
-    %y = static::add(%x, %w)
-    %r = static::mul(%y, %s)
-    return (%r))IR");
-  sr.runOnGraph(graph_);
-  code_ = std::make_unique<Code>(graph_, "");
-  interp_ = std::make_unique<InterpreterState>(*code_);
+  init();
+}
+
+InferenceModule::InferenceModule(std::shared_ptr<torch::jit::Graph> g)
+    : graph(std::move(g)) {
+  init();
+}
+
+void InferenceModule::init() {
+  std::unordered_map<Value*, size_t> value_to_reg;
+  auto assign_reg = [&](Value* v) {
+    value_to_reg.emplace(v, num_regs);
+    return num_regs++;
+  };
+  for (auto v : graph->inputs()) {
+    input_regs.push_back(assign_reg(v));
+  }
+  module_input =
+      !graph->inputs().empty() && graph->inputs()[0]->type()->is_module();
+
+  for (auto n : graph->nodes()) {
+    if (!n->blocks().empty()) {
+      throw std::runtime_error(
+          std::string("Control flow is not supported: ") +
+          n->kind().toQualString());
+    }
+    if (n->kind() == prim::Constant) {
+      constant_regs.push_back(assign_reg(n->output()));
+      constants.push_back(toIValue(n->output()).value());
+      continue;
+    }
+    std::vector<size_t> node_input_regs;
+    for (auto v : n->inputs()) {
+      node_input_regs.push_back(value_to_reg.at(v));
+    }
+    std::vector<size_t> node_output_regs;
+    for (auto v : n->outputs()) {
+      node_output_regs.push_back(assign_reg(v));
+    }
+    nodes.emplace_back(
+        n, std::move(node_input_regs), std::move(node_output_regs));
+  }
+  for (auto v : graph->outputs()) {
+    output_regs.push_back(value_to_reg.at(v));
+  }
+
+  planMemory(value_to_reg);
+  std::vector<bool> managed(num_regs, false);
+  for (auto reg : managed_regs) {
+    managed[reg] = true;
+  }
+  for (const auto& node : nodes) {
+    for (auto reg : node.output_regs()) {
+      if (!managed[reg]) {
+        temporary_regs.push_back(reg);
+      }
+    }
+  }
+}
+
+void InferenceModule::planMemory(
+    const std::unordered_map<Value*, size_t>& value_to_reg) {
+  std::unordered_map<Node*, size_t> node_pos;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    node_pos[nodes[i].get_node()] = i;
+  }
+
+  // The position of the last node each value is live at, or used by.
+  std::unordered_map<Value*, size_t> last_use;
+  auto use = [&](Value* v, size_t pos) {
+    auto it = last_use.emplace(v, pos).first;
+    it->second = std::max(it->second, pos);
+  };
+  for (const auto& entry : BuildLivenessSets(graph)) {
+    auto it = node_pos.find(entry.first);
+    if (it == node_pos.end()) {
+      continue;
+    }
+    for (auto v : entry.second) {
+      use(v, it->second);
+    }
+  }
+  std::vector<Value*> values(graph->inputs().begin(), graph->inputs().end());
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    auto n = nodes[i].get_node();
+    for (auto v : n->inputs()) {
+      use(v, i);
+    }
+    values.insert(values.end(), n->outputs().begin(), n->outputs().end());
+  }
+
+  // The tensors written by out variants are managed, but for those which may
+  // be part of the outputs of the graph, which are given to the caller. A
+  // managed tensor lives until the last use of the values that may alias
+  // it, e.g., its views, and its buffer is the first one free by then.
+  AliasDb alias_db(graph);
+  std::vector<size_t> buffer_ends;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    const auto& node = nodes[i];
+    auto n = node.get_node();
+    if (!node.has_out_variant() || n->outputs().size() != 1 ||
+        !n->output()->type()->cast<TensorType>() ||
+        alias_db.mayContainAlias({n->output()}, graph->outputs())) {
+      continue;
+    }
+    size_t end = i;
+    for (auto v : values) {
+      auto it = last_use.find(v);
+      if (it != last_use.end() && it->second > end &&
+          alias_db.mayContainAlias(n->output(), v)) {
+        end = it->second;
+      }
+    }
+    size_t buffer = 0;
+    while (buffer < buffer_ends.size() && buffer_ends[buffer] >= i) {
+      ++buffer;
+    }
+    if (buffer == buffer_ends.size()) {
+      buffer_ends.push_back(end);
+    } else {
+      buffer_ends[buffer] = end;
+    }
+    managed_regs.push_back(value_to_reg.at(n->output()));
+    buffer_of.push_back(buffer);
+  }
+  num_buffers = buffer_ends.size();
+}
+
+std::shared_ptr<InferenceModule> PrepareForStaticRuntime(
+    const torch::jit::Module& m) {
+  return std::make_shared<InferenceModule>(m);
+}
+
+std::shared_ptr<InferenceModule> PrepareForStaticRuntime(
+    std::shared_ptr<torch::jit::Graph> g) {
+  return std::make_shared<InferenceModule>(std::move(g));
+}
+
+StaticRuntime::StaticRuntime(std::shared_ptr<torch::jit::Graph> g)
+    : StaticRuntime(PrepareForStaticRuntime(std::move(g))) {}
+
+StaticRuntime::StaticRuntime(const torch::jit::Module& m)
+    : StaticRuntime(PrepareForStaticRuntime(m)) {}
+
+StaticRuntime::StaticRuntime(std::shared_ptr<const InferenceModule> module)
+    : module_(std::move(module)),
+      reg_(module_->num_regs),
+      planner_(module_.get()) {
+  // The constants are shared with the other runtimes of the module, they
+  // are never written to.
+  for (size_t i = 0; i < module_->constant_regs.size(); ++i) {
+    reg_[module_->constant_regs[i]] = module_->constants[i];
+  }
 }
 
 std::vector<at::Tensor> StaticRuntime::run(
-    const std::vector<at::Tensor>& inps) const {
-  std::vector<torch::jit::IValue> stack;
-  if (graph_->inputs().at(0)->type()->is_module()) {
-    stack.emplace_back(module_._ivalue());
+    const std::vector<at::Tensor>& inps) {
+  // The out variants write into tensors, which autograd doesn't support,
+  // and the runtime is meant for inference only anyway.
+  at::NoGradGuard no_grad;
+
+  const auto& input_regs = module_->input_regs;
+  size_t first_input = 0;
+  if (module_->module_input) {
+    reg_[input_regs[0]] = module_->module._ivalue();
+    first_input = 1;
   }
-  for (const auto& inp : inps) {
-    stack.emplace_back(inp);
+  TORCH_CHECK(
+      inps.size() + first_input == input_regs.size(),
+      "Expected ",
+      input_regs.size() - first_input,
+      " inputs, got ",
+      inps.size());
+  for (size_t i = 0; i < inps.size(); ++i) {
+    reg_[input_regs[i + first_input]] = inps[i];
+  }
+
+  planner_.allocate(reg_);
+  for (const auto& node : module_->nodes) {
+    node.run(reg_);
   }
 
-  interp_->run(stack);
   std::vector<at::Tensor> out;
-  for (const auto& v : stack) {
+  for (auto reg : module_->output_regs) {
+    const auto& v = reg_[reg];
     if (v.isTuple()) {
       auto t = v.toTuple();
       for (const auto& el : t->elements()) {
@@ -121,7 +265,158 @@ std::vector<at::Tensor> StaticRuntime::run(
       out.emplace_back(v.toTensor());
     }
   }
+  // The storages of the inputs and constants, which the views computed by
+  // the run may share, are not allocated by it.
+  seen_storages_.clear();
+  auto see = [this](const IValue& v) {
+    if (!v.isTensor()) {
+      return false;
+    }
+    auto impl = v.toTensor().unsafeGetTensorImpl();
+    return impl->has_storage() &&
+        seen_storages_.insert(impl->storage().unsafeGetStorageImpl()).second;
+  };
+  for (auto reg : input_regs) {
+    see(reg_[reg]);
+  }
+  for (auto reg : module_->constant_regs) {
+    see(reg_[reg]);
+  }
+  unplanned_bytes_ = 0;
+  for (auto reg : module_->temporary_regs) {
+    if (see(reg_[reg])) {
+      unplanned_bytes_ += reg_[reg].toTensor().storage().nbytes();
+    }
+  }
+  planner_.deallocate(reg_);
+
+  for (auto reg : module_->temporary_regs) {
+    reg_[reg] = IValue();
+  }
+  for (auto reg : input_regs) {
+    reg_[reg] = IValue();
+  }
   return out;
 }
+
+StaticRuntimeMemoryStats StaticRuntime::memory_stats() const {
+  StaticRuntimeMemoryStats stats;
+  stats.planned_bytes = planner_.planned_bytes();
+  stats.unplanned_bytes = unplanned_bytes_ + planner_.unplanned_bytes();
+  stats.num_managed_tensors = module_->managed_regs.size();
+  stats.num_buffers = module_->num_buffers;
+  return stats;
+}
+
+namespace {
+
+// The alignment of the buffers in the arena of a MemoryPlanner.
+constexpr size_t kBufferAlignment = 64;
+
+size_t alignBufferSize(size_t nbytes) {
+  return (nbytes + kBufferAlignment - 1) / kBufferAlignment * kBufferAlignment;
+}
+
+// The bytes `tensor` needs from the start of its storage.
+size_t neededBytes(const at::Tensor& tensor) {
+  if (!tensor.is_contiguous()) {
+    return tensor.storage().nbytes();
+  }
+  return (tensor.storage_offset() + tensor.numel()) * tensor.itemsize();
+}
+
+} // namespace
+
+MemoryPlanner::MemoryPlanner(const InferenceModule* module)
+    : module_(module),
+      buffer_sizes_(module->num_buffers, 0),
+      buffer_offsets_(module->num_buffers, 0) {}
+
+void MemoryPlanner::allocate(std::vector<IValue>& reg) {
+  if (planned_bytes_ == 0) {
+    return;
+  }
+  if (planned_bytes_ > arena_size_) {
+    arena_ = c10::GetCPUAllocator()->allocate(planned_bytes_);
+    arena_size_ = planned_bytes_;
+  }
+  auto base = static_cast<uint8_t*>(arena_.get());
+  for (size_t i = 0; i < module_->managed_regs.size(); ++i) {
+    const auto& v = reg[module_->managed_regs[i]];
+    if (!v.isTensor()) {
+      continue;
+    }
+    auto impl = v.toTensor().storage().unsafeGetStorageImpl();
+    if (impl->device_type() != c10::DeviceType::CPU) {
+      continue;
+    }
+    auto buffer = module_->buffer_of[i];
+    impl->set_data_ptr(
+        at::DataPtr(base + buffer_offsets_[buffer], at::Device(at::kCPU)));
+    impl->set_nbytes(buffer_sizes_[buffer]);
+  }
+}
+
+void MemoryPlanner::deallocate(std::vector<IValue>& reg) {
+  auto base = static_cast<uint8_t*>(arena_.get());
+  std::fill(buffer_sizes_.begin(), buffer_sizes_.end(), 0);
+  unplanned_bytes_ = 0;
+  for (size_t i = 0; i < module_->managed_regs.size(); ++i) {
+    const auto& v = reg[module_->managed_regs[i]];
+    if (!v.isTensor()) {
+      continue;
+    }
+    const auto& tensor = v.toTensor();
+    auto impl = tensor.storage().unsafeGetStorageImpl();
+    if (impl->device_type() != c10::DeviceType::CPU) {
+      continue;
+    }
+    auto data = static_cast<uint8_t*>(impl->data());
+    if (!base || data < base || data >= base + arena_size_) {
+      unplanned_bytes_ += impl->nbytes();
+    }
+    auto& size = buffer_sizes_[module_->buffer_of[i]];
+    size = std::max(size, alignBufferSize(neededBytes(tensor)));
+    // The tensor keeps its metadata, and its storage is pointed into the
+    // arena again by the next allocate.
+    impl->reset();
+  }
+  planned_bytes_ = 0;
+  for (size_t b = 0; b < buffer_sizes_.size(); ++b) {
+    buffer_offsets_[b] = planned_bytes_;
+    planned_bytes_ += buffer_sizes_[b];
+  }
+}
+
+ProcessedNode::ProcessedNode(
+    Node* node,
+    std::vector<size_t> input_regs,
+    std::vector<size_t> output_regs)
+    : node_(node),
+      fn_(getOutOfPlaceOperation(node)),
+      input_regs_(std::move(input_regs)),
+      output_regs_(std::move(output_regs)) {
+  if (!fn_) {
+    op_ = node->getOperation();
+  }
+}
+
+void ProcessedNode::run(std::vector<IValue>& reg) const {
+  if (fn_) {
+    fn_(this, reg);
+    return;
+  }
+  Stack stack;
+  stack.reserve(std::max(input_regs_.size(), output_regs_.size()));
+  for (auto i : input_regs_) {
+    stack.emplace_back(reg[i]);
+  }
+  op_(&stack);
+  TORCH_INTERNAL_ASSERT(stack.size() == output_regs_.size());
+  for (size_t i = 0; i < output_regs_.size(); ++i) {
+    reg[output_regs_[i]] = std::move(stack[i]);
+  }
+}
+
 } // namespace jit
 } // namespace torch
@@ -2,30 +2,181 @@
 
 #include <ATen/core/interned_strings.h>
 #include <ATen/core/ivalue.h>
+#include <c10/core/Allocator.h>
 #include <torch/csrc/jit/api/module.h>
 #include <torch/csrc/jit/ir/ir.h>
 #include <torch/csrc/jit/passes/constant_propagation.h>
 #include <torch/csrc/jit/passes/inliner.h>
+#include <torch/csrc/jit/runtime/static/ops.h>
+
+#include <unordered_map>
+#include <unordered_set>
 
 namespace torch {
 namespace jit {
 
+// A node of the graph of a StaticRuntime, resolved once at load time to the
+// kernel that runs it and to the registers of its inputs and outputs.
+class ProcessedNode {
+ public:
+  ProcessedNode(
+      Node* node,
+      std::vector<size_t> input_regs,
+      std::vector<size_t> output_regs);
+
+  void run(std::vector<IValue>& reg) const;
+
+  Node* get_node() const {
+    return node_;
+  }
+
+  const IValue& Input(size_t i, const std::vector<IValue>& reg) const {
+    return reg[input_regs_[i]];
+  }
+
+  IValue& Output(size_t i, std::vector<IValue>& reg) const {
+    return reg[output_regs_[i]];
+  }
+
+  const std::vector<size_t>& input_regs() const {
+    return input_regs_;
+  }
+
+  const std::vector<size_t>& output_regs() const {
+    return output_regs_;
+  }
+
+  bool has_out_variant() const {
+    return static_cast<bool>(fn_);
+  }
+
+ private:
+  Node* node_;
+  // The out variant kernel of the node if it has one, else its operation.
+  SROperator fn_;
+  Operation op_;
+  std::vector<size_t> input_regs_;
+  std::vector<size_t> output_regs_;
+};
+
+// The part of a model run by Static Runtime that the threads running it
+// share: the prepared graph, the frozen module holding the weights, the
+// resolved nodes, and the layout of the registers and of the memory plan. It
+// is immutable once prepared, and every thread runs it with a StaticRuntime
+// of its own, which only holds the registers and the arena of the thread.
+struct TORCH_API InferenceModule {
+  explicit InferenceModule(const torch::jit::Module& m);
+  explicit InferenceModule(std::shared_ptr<torch::jit::Graph> g);
+
+  torch::jit::Module module;
+  std::shared_ptr<torch::jit::Graph> graph;
+
+  // Whether the first input of graph is the module itself.
+  bool module_input = false;
+  size_t num_regs = 0;
+  std::vector<size_t> input_regs;
+  std::vector<size_t> output_regs;
+  // The registers of the constants, and their values.
+  std::vector<size_t> constant_regs;
+  std::vector<IValue> constants;
+  // The registers cleared at the end of a run, to release what it computed
+  // outside of the memory planner.
+  std::vector<size_t> temporary_regs;
+  std::vector<ProcessedNode> nodes;
+
+  // The registers of the tensors managed by the memory planner, and the
+  // buffer of each of them.
+  std::vector<size_t> managed_regs;
+  std::vector<size_t> buffer_of;
+  size_t num_buffers = 0;
+
+ private:
+  // Assigns the registers of the values of graph and resolves its nodes.
+  void init();
+  // Picks the tensors managed by the memory planner, and their buffers.
+  void planMemory(const std::unordered_map<Value*, size_t>& value_to_reg);
+};
+
+TORCH_API std::shared_ptr<InferenceModule> PrepareForStaticRuntime(
+    const torch::jit::Module& m);
+TORCH_API std::shared_ptr<InferenceModule> PrepareForStaticRuntime(
+    std::shared_ptr<torch::jit::Graph> g);
+
+struct StaticRuntimeMemoryStats {
+  // The bytes of the intermediates planned into the arena in the last run.
+  size_t planned_bytes = 0;
+  // The bytes of the other tensors the last run allocated, e.g., its outputs
+  // and the results of the nodes without an out variant.
+  size_t unplanned_bytes = 0;
+  size_t num_managed_tensors = 0;
+  size_t num_buffers = 0;
+};
+
+// Plans the storage of the intermediate tensors written by out variants.
+// They are kept in their registers from one run to the next, and the tensors
+// whose lifetimes don't overlap, given by the liveness of their values and of
+// the values that may alias them, share a buffer of a single arena. The
+// arena is kept across runs, so that once the shapes are known the out
+// variants write into it instead of allocating; a buffer is as large as the
+// largest of its tensors in the previous run, and the arena only grows when
+// the shapes do. The buffers are those of the plan of an InferenceModule.
+class MemoryPlanner {
+ public:
+  explicit MemoryPlanner(const InferenceModule* module);
+
+  // Points the storages of the managed tensors into the arena.
+  void allocate(std::vector<IValue>& reg);
+  // Records the sizes the managed tensors needed in the run, and detaches
+  // them from the arena.
+  void deallocate(std::vector<IValue>& reg);
+
+  size_t planned_bytes() const {
+    return planned_bytes_;
+  }
+
+  // The bytes of the managed tensors that outgrew their buffer in the last
+  // run, and were allocated outside of the arena.
+  size_t unplanned_bytes() const {
+    return unplanned_bytes_;
+  }
+
+ private:
+  const InferenceModule* module_;
+  std::vector<size_t> buffer_sizes_;
+  std::vector<size_t> buffer_offsets_;
+  size_t planned_bytes_ = 0;
+  size_t unplanned_bytes_ = 0;
+  at::DataPtr arena_;
+  size_t arena_size_ = 0;
+};
+
+// Runs an InferenceModule node by node. Every value of the graph has a
+// register, and the kernels of the nodes read their inputs from and write
+// their outputs to the registers directly. A runtime must not be run from
+// several threads at once, but any number of runtimes may share a module.
 class TORCH_API StaticRuntime {
  public:
-  explicit StaticRuntime(std::shared_ptr<torch::jit::Graph> g)
-      : graph_(std::move(g)) {}
+  explicit StaticRuntime(std::shared_ptr<torch::jit::Graph> g);
 
   explicit StaticRuntime(const torch::jit::Module& m);
 
-  std::vector<at::Tensor> run(const std::vector<at::Tensor>& inps) const;
+  explicit StaticRuntime(std::shared_ptr<const InferenceModule> module);
 
- private:
-  torch::jit::Module module_;
-  std::shared_ptr<torch::jit::Graph> graph_;
+  std::vector<at::Tensor> run(const std::vector<at::Tensor>& inps);
+
+  StaticRuntimeMemoryStats memory_stats() const;
 
-  // Jit interpreter state
-  std::unique_ptr<torch::jit::Code> code_;
-  std::unique_ptr<torch::jit::InterpreterState> interp_;
+  const std::shared_ptr<const InferenceModule>& module() const {
+    return module_;
+  }
+
+ private:
+  std::shared_ptr<const InferenceModule> module_;
+  std::vector<IValue> reg_;
+  MemoryPlanner planner_;
+  size_t unplanned_bytes_ = 0;
+  // The storages seen while counting the unplanned bytes of a run.
+  std::unordered_set<const c10::StorageImpl*> seen_storages_;
 };
 
 } // namespace jit
@@ -6,15 +6,45 @@ namespace jit {
 
 void initStaticRuntimeBindings(PyObject* module) {
   auto m = py::handle(module).cast<py::module>();
-  py::class_<StaticRuntime>(m, "StaticRuntime").def("run", &StaticRuntime::run);
+  py::class_<InferenceModule, std::shared_ptr<InferenceModule>>(
+      m, "StaticInferenceModule");
+  py::class_<StaticRuntime>(m, "StaticRuntime")
+      .def(
+          "run",
+          &StaticRuntime::run,
+          py::call_guard<py::gil_scoped_release>())
+      .def("memory_stats", [](const StaticRuntime& self) {
+        auto stats = self.memory_stats();
+        py::dict d;
+        d["planned_bytes"] = stats.planned_bytes;
+        d["unplanned_bytes"] = stats.unplanned_bytes;
+        d["num_managed_tensors"] = stats.num_managed_tensors;
+        d["num_buffers"] = stats.num_buffers;
+        return d;
+      });
   m.def(
        "_jit_to_static_runtime",
        [](const std::shared_ptr<torch::jit::Graph>& g) {
          return StaticRuntime(g);
        })
-      .def("_jit_to_static_runtime", [](const torch::jit::Module& m) {
-        return StaticRuntime(m);
-      });
+      .def(
+          "_jit_to_static_runtime",
+          [](const torch::jit::Module& m) { return StaticRuntime(m); })
+      .def(
+          "_jit_to_static_runtime",
+          [](const std::shared_ptr<InferenceModule>& module) {
+            return StaticRuntime(module);
+          })
+      .def(
+          "_jit_prepare_for_static_runtime",
+          [](const std::shared_ptr<torch::jit::Graph>& g) {
+            return PrepareForStaticRuntime(g);
+          })
+      .def(
+          "_jit_prepare_for_static_runtime",
+          [](const torch::jit::Module& m) {
+            return PrepareForStaticRuntime(m);
+          });
 }
 
 } // namespace jit
@@ -0,0 +1,157 @@
+#include <torch/csrc/jit/runtime/static/ops.h>
+
+#include <ATen/ATen.h>
+#include <torch/csrc/jit/runtime/static/impl.h>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+// Writes the result of a node with `out_fn` into the tensor its output
+// register holds, so that the buffer is reused, or computes it with `fn` when
+// the register holds none, or one of another dtype or device than `like`.
+template <typename Fn, typename OutFn>
+void runOutVariant(
+    IValue& output,
+    const at::Tensor& like,
+    const Fn& fn,
+    const OutFn& out_fn) {
+  if (output.isTensor()) {
+    auto out_t = output.toTensor();
+    if (out_t.scalar_type() == like.scalar_type() &&
+        out_t.device() == like.device()) {
+      // The out variants resize their output to the shape of the result,
+      // which keeps its storage if it is large enough.
+      out_t.resize_({0});
+      out_fn(out_t);
+      return;
+    }
+  }
+  output = fn();
+}
+
+c10::optional<at::Scalar> toOptionalScalar(const IValue& v) {
+  if (v.isNone()) {
+    return c10::nullopt;
+  }
+  return v.toScalar();
+}
+
+} // namespace
+
+SROperator getOutOfPlaceOperation(Node* n) {
+  if (n->matches(
+          "aten::add.Tensor(Tensor self, Tensor other, *, Scalar alpha=1) -> Tensor")) {
+    return [](const ProcessedNode* p_node, std::vector<IValue>& reg) {
+      auto self = p_node->Input(0, reg).toTensor();
+      auto other = p_node->Input(1, reg).toTensor();
+      auto alpha = p_node->Input(2, reg).toScalar();
+      runOutVariant(
+          p_node->Output(0, reg),
+          self,
+          [&] { return at::add(self, other, alpha); },
+          [&](at::Tensor& out) { at::add_out(out, self, other, alpha); });
+    };
+  }
+  if (n->matches("aten::mul.Tensor(Tensor self, Tensor other) -> Tensor")) {
+    return [](const ProcessedNode* p_node, std::vector<IValue>& reg) {
+      auto self = p_node->Input(0, reg).toTensor();
+      auto other = p_node->Input(1, reg).toTensor();
+      runOutVariant(
+          p_node->Output(0, reg),
+          self,
+          [&] { return at::mul(self, other); },
+          [&](at::Tensor& out) { at::mul_out(out, self, other); });
+    };
+  }
+  if (n->matches("aten::div.Tensor(Tensor self, Tensor other) -> Tensor")) {
+    return [](const ProcessedNode* p_node, std::vector<IValue>& reg) {
+      auto self = p_node->Input(0, reg).toTensor();
+      auto other = p_node->Input(1, reg).toTensor();
+      runOutVariant(
+          p_node->Output(0, reg),
+          self,
+          [&] { return at::div(self, other); },
+          [&](at::Tensor& out) { at::div_out(out, self, other); });
+    };
+  }
+  if (n->matches(
+          "aten::addmm(Tensor self, Tensor mat1, Tensor mat2, *, Scalar beta=1, Scalar alpha=1) -> Tensor")) {
+    return [](const ProcessedNode* p_node, std::vector<IValue>& reg) {
+      auto self = p_node->Input(0, reg).toTensor();
+      auto mat1 = p_node->Input(1, reg).toTensor();
+      auto mat2 = p_node->Input(2, reg).toTensor();
+      auto beta = p_node->Input(3, reg).toScalar();
+      auto alpha = p_node->Input(4, reg).toScalar();
+      runOutVariant(
+          p_node->Output(0, reg),
+          self,
+          [&] { return at::addmm(self, mat1, mat2, beta, alpha); },
+          [&](at::Tensor& out) {
+            at::addmm_out(out, self, mat1, mat2, beta, alpha);
+          });
+    };
+  }
+  if (n->matches("aten::bmm(Tensor self, Tensor mat2) -> Tensor")) {
+    return [](const ProcessedNode* p_node, std::vector<IValue>& reg) {
+      auto self = p_node->Input(0, reg).toTensor();
+      auto mat2 = p_node->Input(1, reg).toTensor();
+      runOutVariant(
+          p_node->Output(0, reg),
+          self,
+          [&] { return at::bmm(self, mat2); },
+          [&](at::Tensor& out) { at::bmm_out(out, self, mat2); });
+    };
+  }
+  if (n->matches("aten::matmul(Tensor self, Tensor other) -> Tensor")) {
+    return [](const ProcessedNode* p_node, std::vector<IValue>& reg) {
+      auto self = p_node->Input(0, reg).toTensor();
+      auto other = p_node->Input(1, reg).toTensor();
+      runOutVariant(
+          p_node->Output(0, reg),
+          self,
+          [&] { return at::matmul(self, other); },
+          [&](at::Tensor& out) { at::matmul_out(out, self, other); });
+    };
+  }
+  if (n->matches("aten::cat(Tensor[] tensors, int dim=0) -> Tensor")) {
+    return [](const ProcessedNode* p_node, std::vector<IValue>& reg) {
+      auto tensors = p_node->Input(0, reg).toTensorVector();
+      auto dim = p_node->Input(1, reg).toInt();
+      TORCH_CHECK(!tensors.empty(), "expected a non-empty list of Tensors");
+      runOutVariant(
+          p_node->Output(0, reg),
+          tensors[0],
+          [&] { return at::cat(tensors, dim); },
+          [&](at::Tensor& out) { at::cat_out(out, tensors, dim); });
+    };
+  }
+  if (n->matches(
+          "aten::clamp(Tensor self, Scalar? min=None, Scalar? max=None) -> Tensor")) {
+    return [](const ProcessedNode* p_node, std::vector<IValue>& reg) {
+      auto self = p_node->Input(0, reg).toTensor();
+      auto min = toOptionalScalar(p_node->Input(1, reg));
+      auto max = toOptionalScalar(p_node->Input(2, reg));
+      runOutVariant(
+          p_node->Output(0, reg),
+          self,
+          [&] { return at::clamp(self, min, max); },
+          [&](at::Tensor& out) { at::clamp_out(out, self, min, max); });
+    };
+  }
+  if (n->matches("aten::sigmoid(Tensor self) -> Tensor")) {
+    return [](const ProcessedNode* p_node, std::vector<IValue>& reg) {
+      auto self = p_node->Input(0, reg).toTensor();
+      runOutVariant(
+          p_node->Output(0, reg),
+          self,
+          [&] { return at::sigmoid(self); },
+          [&](at::Tensor& out) { at::sigmoid_out(out, self); });
+    };
+  }
+  return nullptr;
+}
+
+} // namespace jit
+} // namespace torch
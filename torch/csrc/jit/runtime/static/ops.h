@@ -0,0 +1,22 @@
+#pragma once
+
+#include <ATen/core/ivalue.h>
+#include <torch/csrc/jit/ir/ir.h>
+
+namespace torch {
+namespace jit {
+
+class ProcessedNode;
+
+// A kernel of the static runtime. It reads the inputs of its node from the
+// registers of the runtime and writes its outputs directly into them.
+using SROperator =
+    std::function<void(const ProcessedNode*, std::vector<IValue>&)>;
+
+// The out variant kernel of `n`, which writes its output into the tensor the
+// output register already holds when there is one, or an empty function if
+// `n` has none, in which case it runs its JIT operation on a stack.
+TORCH_API SROperator getOutOfPlaceOperation(Node* n);
+
+} // namespace jit
+} // namespace torch
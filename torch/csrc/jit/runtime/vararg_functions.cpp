@@ -4,9 +4,22 @@
 namespace torch {
 namespace jit {
 
+// The containers popped from the stack are often their elements' last
+// reference, e.g. when they were MOVEd from their register. The elements of
+// such containers are moved out of them rather than copied, which saves the
+// refcount bumps of the copies and of the destruction of the container.
+
 void tupleUnpack(Stack& stack) {
   auto tuple = pop(stack).toTuple();
-  stack.insert(stack.end(), tuple->elements().begin(), tuple->elements().end());
+  auto& elements = tuple->elements();
+  if (tuple.use_count() == 1) {
+    stack.insert(
+        stack.end(),
+        std::make_move_iterator(elements.begin()),
+        std::make_move_iterator(elements.end()));
+  } else {
+    stack.insert(stack.end(), elements.begin(), elements.end());
+  }
 }
 
 void format(Stack& stack, size_t num_inputs) {
@@ -47,7 +60,13 @@ void listUnpack(Stack& stack, size_t num_outputs) {
       num_outputs,
       " elements in a list but found ",
       list.size());
-  stack.insert(stack.end(), list.begin(), list.end());
+  if (list.use_count() == 1) {
+    for (size_t i = 0; i < num_outputs; ++i) {
+      stack.push_back(list.extract(i));
+    }
+  } else {
+    stack.insert(stack.end(), list.begin(), list.end());
+  }
 }
 
 void tupleConstruct(Stack& stack, size_t num_inputs) {
@@ -86,11 +105,8 @@ void dictConstruct(Stack& stack, at::DictTypePtr type, size_t num_inputs) {
   vals.reserve(num_inputs / 2);
   // loop from the bottom of the stack to ensure the dictConstruct preserve
   // the inputs order.
-  auto inputs = last(stack, num_inputs);
-  for (size_t i = 0; i < num_inputs; i += 2) {
-    auto key = inputs[i];
-    auto val = inputs[i + 1];
-    vals.insert_or_assign(std::move(key), std::move(val));
+  for (size_t i = stack.size() - num_inputs; i < stack.size(); i += 2) {
+    vals.insert_or_assign(std::move(stack[i]), std::move(stack[i + 1]));
   }
   drop(stack, num_inputs);
   push(stack, std::move(vals));
@@ -117,10 +133,16 @@ void isinstance(Stack& stack, at::ArrayRef<at::TypePtr> types) {
 
 void tupleSlice(Stack& stack, size_t begin, size_t end) {
   auto tuple = pop(stack).toTuple();
+  auto& elements = tuple->elements();
+  const bool unique = tuple.use_count() == 1;
   std::vector<IValue> output_elems;
   output_elems.reserve(end - begin);
   for (size_t i = begin; i < end; ++i) {
-    output_elems.emplace_back(tuple->elements()[i]);
+    if (unique) {
+      output_elems.emplace_back(std::move(elements[i]));
+    } else {
+      output_elems.emplace_back(elements[i]);
+    }
   }
   push(stack, c10::ivalue::Tuple::create(std::move(output_elems)));
 }
@@ -37,9 +37,8 @@ void writeArchiveAndTensors(
   std::string prefix = archive_name + "/";
   size_t i = 0;
   for (const auto& td : tensors) {
-    WriteableTensorData writable_td = getWriteableTensorData(td);
     std::string fname = prefix + std::to_string(i++);
-    out.writeRecord(fname, writable_td.data(), writable_td.sizeInBytes());
+    writeTensorRecord(fname, td, out);
   }
   std::string fname = archive_name + ".pkl";
   out.writeRecord(fname, data, size);
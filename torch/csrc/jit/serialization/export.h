@@ -53,26 +53,42 @@ TORCH_API std::string pretty_print_onnx(
     const std::map<std::string, int>& custom_opsets = {},
     bool add_node_names = true);
 
+// With compress_tensors, the records of the tensors are compressed when that
+// makes them smaller, see writeTensorRecord. The other records are still
+// stored uncompressed, and so are mappable.
 TORCH_API void ExportModule(
     const Module& module,
     std::ostream& out,
     const ExtraFilesMap& metadata = ExtraFilesMap(),
     bool bytecode_format = false,
-    bool save_mobile_debug_info = false);
+    bool save_mobile_debug_info = false,
+    bool compress_tensors = false);
 
 TORCH_API void ExportModule(
     const Module& module,
     const std::string& filename,
     const ExtraFilesMap& metadata = ExtraFilesMap(),
     bool bytecode_format = false,
-    bool save_mobile_debug_info = false);
+    bool save_mobile_debug_info = false,
+    bool compress_tensors = false);
 
 TORCH_API void ExportModule(
     const Module& module,
     const std::function<size_t(const void*, size_t)>& writer_func,
     const ExtraFilesMap& metadata = ExtraFilesMap(),
     bool bytecode_format = false,
-    bool save_mobile_debug_info = false);
+    bool save_mobile_debug_info = false,
+    bool compress_tensors = false);
+
+// Write the storage of `tensor` into the record `name`. The storages of CUDA
+// tensors are copied to the host chunk by chunk as they are written, instead
+// of all at once. With `compress`, the record is compressed when that makes
+// it smaller, after shuffling the bytes of floating point elements.
+TORCH_API void writeTensorRecord(
+    const std::string& name,
+    const at::Tensor& tensor,
+    caffe2::serialize::PyTorchStreamWriter& out,
+    bool compress = false);
 
 // Write the bytes of a pickle archive and the tensors referenced inside that
 // archive
@@ -17,10 +17,13 @@
 #include <caffe2/serialize/inline_container.h>
 
 #include <ATen/ATen.h>
+#include <c10/core/Event.h>
+#include <c10/core/impl/VirtualGuardImpl.h>
 
 #include <ATen/core/jit_type.h>
 #include <ATen/core/qualified_name.h>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace torch {
@@ -78,6 +81,10 @@ std::pair<IValue, c10::optional<IValue>> getFunctionTuple(
 
   torch::jit::Code code(graph, func.name());
   auto instructions_copy = code.instructions();
+  // the mobile interpreter doesn't run superinstructions
+  for (auto& ins : instructions_copy) {
+    ins = unfused(ins);
+  }
 
   // operator names
   std::vector<c10::OperatorName> opnames;
@@ -242,6 +249,102 @@ void SetExportModuleExtraFilesHook(ExportModuleExtraFilesHook hook) {
   GetExtraFilesHook() = hook;
 }
 
+// The size of the pinned buffers the CUDA storages are copied through.
+constexpr size_t kDeviceCopyChunkSize = 16 << 20;
+
+void writeTensorRecord(
+    const std::string& name,
+    const at::Tensor& tensor,
+    caffe2::serialize::PyTorchStreamWriter& out,
+    bool compress) {
+  const auto& storage = tensor.storage();
+  size_t nbytes = storage.nbytes();
+  // TODO HIP support
+  if (storage.device_type() != DeviceType::CUDA ||
+      nbytes <= kDeviceCopyChunkSize) {
+    WriteableTensorData writable_td = getWriteableTensorData(tensor);
+    if (compress) {
+      // The bytes of floating point numbers compress better once the
+      // signs and exponents are apart from the mantissas.
+      size_t element_size =
+          at::isFloatingType(tensor.scalar_type()) ? tensor.element_size() : 1;
+      out.writeCompressedRecord(
+          name, writable_td.data(), writable_td.sizeInBytes(), element_size);
+    } else {
+      out.writeRecord(name, writable_td.data(), writable_td.sizeInBytes());
+    }
+    return;
+  }
+
+  // The storage is copied through two pinned buffers, the copy of the next
+  // chunk running on the current stream while the writer reads the previous
+  // one, so that the host never holds more than two chunks of it.
+  at::Tensor src = at::empty({0}, tensor.options().dtype(at::kByte))
+                       .set_(
+                           storage,
+                           /* storage_offset = */ 0,
+                           /* size = */ {static_cast<int64_t>(nbytes)},
+                           /* stride = */ {1});
+  auto pinned = at::TensorOptions().dtype(at::kByte).pinned_memory(true);
+  at::Tensor buffers[2] = {
+      at::empty({static_cast<int64_t>(kDeviceCopyChunkSize)}, pinned),
+      at::empty({static_cast<int64_t>(kDeviceCopyChunkSize)}, pinned)};
+  c10::impl::VirtualGuardImpl impl(DeviceType::CUDA);
+  c10::Stream stream = impl.getStream(src.device());
+  c10::Event copied[2] = {
+      c10::Event(DeviceType::CUDA), c10::Event(DeviceType::CUDA)};
+  auto startCopy = [&](size_t chunk) {
+    size_t begin = chunk * kDeviceCopyChunkSize;
+    int64_t len = std::min(kDeviceCopyChunkSize, nbytes - begin);
+    buffers[chunk % 2].narrow(0, 0, len).copy_(
+        src.narrow(0, begin, len), /* non_blocking = */ true);
+    copied[chunk % 2].record(stream);
+  };
+
+  size_t num_chunks =
+      (nbytes + kDeviceCopyChunkSize - 1) / kDeviceCopyChunkSize;
+  size_t current = num_chunks;
+  auto waitFor = [&](size_t chunk) {
+    while (!copied[chunk % 2].query()) {
+      std::this_thread::yield();
+    }
+  };
+  auto read = [&](uint64_t pos, void* buf, size_t n) -> size_t {
+    size_t done = 0;
+    while (done < n) {
+      size_t chunk = (pos + done) / kDeviceCopyChunkSize;
+      if (chunk != current) {
+        waitFor(chunk);
+        current = chunk;
+        // The other buffer holds the previous chunk, which the writer is
+        // done with.
+        if (chunk + 1 < num_chunks) {
+          startCopy(chunk + 1);
+        }
+      }
+      size_t offset = pos + done - chunk * kDeviceCopyChunkSize;
+      size_t len = std::min(n - done, kDeviceCopyChunkSize - offset);
+      memcpy(
+          static_cast<char*>(buf) + done,
+          static_cast<const char*>(buffers[chunk % 2].data_ptr()) + offset,
+          len);
+      done += len;
+    }
+    return done;
+  };
+  // The buffers must outlive the copies into them, even when the writer
+  // fails before reading all the chunks.
+  startCopy(0);
+  try {
+    // The chunks are compressed as they are written, without shuffling.
+    out.writeRecord(name, nbytes, read, compress);
+  } catch (...) {
+    waitFor(0);
+    waitFor(1);
+    throw;
+  }
+}
+
 class ScriptModuleSerializer {
  public:
   explicit ScriptModuleSerializer(const std::string& filename)
@@ -255,8 +358,10 @@ class ScriptModuleSerializer {
       const Module& module,
       const ExtraFilesMap& extra_files,
       bool bytecode_format,
-      bool save_mobile_debug_info) {
+      bool save_mobile_debug_info,
+      bool compress_tensors = false) {
     C10_LOG_API_USAGE_ONCE("torch.script.save");
+    compress_tensors_ = compress_tensors;
     writeExtraFiles(module, extra_files);
     // Serialize the model object
     writeArchive("data", module._ivalue());
@@ -297,9 +402,8 @@ class ScriptModuleSerializer {
     size_t i = 0;
     std::string prefix = archive_name + "/";
     for (const auto& td : data_pickle.tensorData()) {
-      WriteableTensorData writable_td = getWriteableTensorData(td);
       std::string fname = prefix + c10::to_string(i++);
-      writer_.writeRecord(fname, writable_td.data(), writable_td.sizeInBytes());
+      writeTensorRecord(fname, td, writer_, compress_tensors_);
     }
     std::string fname = archive_name + ".pkl";
     writer_.writeRecord(fname, data.data(), data.size());
@@ -430,6 +534,7 @@ class ScriptModuleSerializer {
   std::unordered_set<c10::NamedTypePtr> converted_types_;
   std::vector<c10::NamedTypePtr> class_deps_;
   TypeNameUniquer type_name_uniquer_;
+  bool compress_tensors_ = false;
 
   // qualifier, e.g. '__torch__.Bar' -> PythonPrint for the file that will be
   // created
@@ -441,14 +546,19 @@ void ExportModule(
     std::ostream& out,
     const ExtraFilesMap& extra_files,
     bool bytecode_format,
-    bool save_mobile_debug_info) {
+    bool save_mobile_debug_info,
+    bool compress_tensors) {
   ScriptModuleSerializer serializer(
       [&](const void* buf, size_t nbytes) -> size_t {
         out.write(static_cast<const char*>(buf), nbytes);
         return !out ? 0 : nbytes;
       });
   serializer.serialize(
-      module, extra_files, bytecode_format, save_mobile_debug_info);
+      module,
+      extra_files,
+      bytecode_format,
+      save_mobile_debug_info,
+      compress_tensors);
 }
 
 void ExportModule(
@@ -456,10 +566,15 @@ void ExportModule(
     const std::string& filename,
     const ExtraFilesMap& extra_files,
     bool bytecode_format,
-    bool save_mobile_debug_info) {
+    bool save_mobile_debug_info,
+    bool compress_tensors) {
   ScriptModuleSerializer serializer(filename);
   serializer.serialize(
-      module, extra_files, bytecode_format, save_mobile_debug_info);
+      module,
+      extra_files,
+      bytecode_format,
+      save_mobile_debug_info,
+      compress_tensors);
 }
 
 void ExportModule(
@@ -467,10 +582,15 @@ void ExportModule(
     const std::function<size_t(const void*, size_t)>& writer_func,
     const ExtraFilesMap& extra_files,
     bool bytecode_format,
-    bool save_mobile_debug_info) {
+    bool save_mobile_debug_info,
+    bool compress_tensors) {
   ScriptModuleSerializer serializer(writer_func);
   serializer.serialize(
-      module, extra_files, bytecode_format, save_mobile_debug_info);
+      module,
+      extra_files,
+      bytecode_format,
+      save_mobile_debug_info,
+      compress_tensors);
 }
 
 namespace {
@@ -11,11 +11,13 @@
 #include <torch/csrc/jit/serialization/import_source.h>
 #include <torch/csrc/jit/serialization/pickle.h>
 #include <torch/csrc/jit/serialization/source_range_serialization.h>
+#include <torch/csrc/jit/serialization/storage_registry.h>
 #include <torch/csrc/jit/serialization/unpickler.h>
 
 #include <caffe2/serialize/file_adapter.h>
 #include <caffe2/serialize/inline_container.h>
 #include <caffe2/serialize/istream_adapter.h>
+#include <caffe2/serialize/mmap_file_adapter.h>
 
 #include <ATen/ATen.h>
 #include <fmt/format.h>
@@ -30,6 +32,7 @@ namespace jit {
 
 using caffe2::serialize::FileAdapter;
 using caffe2::serialize::IStreamAdapter;
+using caffe2::serialize::MmapFileAdapter;
 using caffe2::serialize::PyTorchStreamReader;
 using caffe2::serialize::ReadAdapterInterface;
 
@@ -80,10 +83,46 @@ IValue readArchiveAndTensors(
     return len;
   };
 
+  // The tensors of the archive are read ahead, at once and in parallel, as
+  // the unpickler asks for them one at a time.
   std::string archive_name_plus_slash = archive_name + "/";
+  std::vector<std::string> tensor_names;
+  for (const auto& record : stream_reader.getAllRecords()) {
+    // The records are in the top folder of the archive.
+    auto name = record.substr(record.find('/') + 1);
+    if (name.compare(
+            0, archive_name_plus_slash.size(), archive_name_plus_slash) == 0) {
+      tensor_names.push_back(name);
+    }
+  }
+  auto tensor_records = stream_reader.getRecords(
+      tensor_names, at::get_num_interop_threads());
+  std::unordered_map<std::string, std::tuple<at::DataPtr, size_t>> prefetched;
+  for (size_t i = 0; i < tensor_names.size(); i++) {
+    prefetched.emplace(tensor_names[i], std::move(tensor_records[i]));
+  }
+
+  // The tensors loaded on another device are copied there, so sharing their
+  // records wouldn't save anything.
+  bool share_storages =
+      storageSharingEnabled() && (!device || device->is_cpu());
   auto read_record = [&](const std::string& name) {
     std::string ss = archive_name_plus_slash + name;
-    return std::get<0>(stream_reader.getRecord(ss));
+    std::tuple<at::DataPtr, size_t> record;
+    auto it = prefetched.find(ss);
+    if (it != prefetched.end()) {
+      record = std::move(it->second);
+      prefetched.erase(it);
+    } else {
+      record = stream_reader.getRecord(ss);
+    }
+    if (share_storages) {
+      return shareStorage(
+          std::move(std::get<0>(record)),
+          std::get<1>(record),
+          stream_reader.getRecordCrc32(ss));
+    }
+    return std::move(std::get<0>(record));
   };
 
   Unpickler unpickler(
@@ -321,6 +360,15 @@ Module load(
   return module;
 }
 
+Module load_mmap(
+    const std::string& filename,
+    c10::optional<at::Device> device,
+    ExtraFilesMap& extra_files) {
+  std::unique_ptr<MmapFileAdapter> rai =
+      std::make_unique<MmapFileAdapter>(filename);
+  return load(std::move(rai), device, extra_files);
+}
+
 Module load(
     std::unique_ptr<ReadAdapterInterface> rai,
     c10::optional<c10::Device> device,
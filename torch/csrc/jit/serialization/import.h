@@ -65,6 +65,19 @@ TORCH_API Module load(
     c10::optional<c10::Device> device = c10::nullopt,
     ExtraFilesMap& extra_files = default_extra_files);
 
+/// Loads a serialized `Module` from the given `filename` through a memory
+/// mapping of the file.
+///
+/// The tensors of the module are stored in the mapped pages of the file
+/// instead of being read into memory, so that loading doesn't copy them, and
+/// the processes loading the same file share their pages until they write to
+/// them. The file must not be modified while the module is alive. The
+/// tensors loaded for another device than the CPU are copied as usual.
+TORCH_API Module load_mmap(
+    const std::string& filename,
+    c10::optional<c10::Device> device = c10::nullopt,
+    ExtraFilesMap& extra_files = default_extra_files);
+
 TORCH_API IValue readArchiveAndTensors(
     const std::string& archive_name,
     c10::optional<TypeResolver> type_resolver,
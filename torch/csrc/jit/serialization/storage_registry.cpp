@@ -0,0 +1,216 @@
+#include <torch/csrc/jit/serialization/storage_registry.h>
+
+#include <c10/util/Exception.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(SYS_memfd_create)
+#define TORCH_SHARED_STORAGES
+#endif
+#endif
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+std::atomic<bool>& storageSharingFlag() {
+  static std::atomic<bool> enabled([] {
+#ifdef TORCH_SHARED_STORAGES
+    const char* env = std::getenv("PYTORCH_JIT_SHARE_STORAGES");
+    return env != nullptr && std::strcmp(env, "0") != 0;
+#else
+    return false;
+#endif
+  }());
+  return enabled;
+}
+
+#ifdef TORCH_SHARED_STORAGES
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+
+// The contents of a record, in an anonymous file that the storages sharing
+// them map privately.
+struct SharedRecord {
+  SharedRecord(int fd, void* view, size_t size)
+      : fd(fd), view(view), size(size) {}
+  ~SharedRecord() {
+    munmap(view, size);
+    close(fd);
+  }
+
+  int fd;
+  // A read-only mapping of the file, to compare the records loaded later to.
+  void* view;
+  size_t size;
+  std::atomic<int64_t> num_references{0};
+};
+
+struct RecordMapping {
+  std::shared_ptr<SharedRecord> record;
+  void* data;
+};
+
+void deleteRecordMapping(void* ctx) {
+  auto mapping = static_cast<RecordMapping*>(ctx);
+  munmap(mapping->data, mapping->record->size);
+  mapping->record->num_references--;
+  delete mapping;
+}
+
+// Returns nullptr if the file can't be created, e.g. if the process is out
+// of file descriptors, in which case the record isn't shared.
+std::shared_ptr<SharedRecord> createRecord(const void* data, size_t size) {
+  int fd = syscall(SYS_memfd_create, "torch_shared_storage", MFD_CLOEXEC);
+  if (fd == -1) {
+    return nullptr;
+  }
+  if (ftruncate(fd, size) == -1) {
+    close(fd);
+    return nullptr;
+  }
+  void* view =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (view == MAP_FAILED) {
+    close(fd);
+    return nullptr;
+  }
+  std::memcpy(view, data, size);
+  mprotect(view, size, PROT_READ);
+  return std::make_shared<SharedRecord>(fd, view, size);
+}
+
+// Maps the record privately: its pages are shared until they are written to.
+at::DataPtr mapRecord(const std::shared_ptr<SharedRecord>& record) {
+  void* data = mmap(
+      nullptr,
+      record->size,
+      PROT_READ | PROT_WRITE,
+      MAP_PRIVATE,
+      record->fd,
+      0);
+  if (data == MAP_FAILED) {
+    return at::DataPtr();
+  }
+  record->num_references++;
+  return at::DataPtr(
+      data,
+      new RecordMapping{record, data},
+      deleteRecordMapping,
+      at::DeviceType::CPU);
+}
+
+class StorageRegistry {
+ public:
+  at::DataPtr share(at::DataPtr data, size_t size, uint32_t crc32) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    // The CRC only narrows down the candidates, the records sharing it are
+    // compared byte for byte.
+    auto& candidates = records_[{size, crc32}];
+    std::shared_ptr<SharedRecord> record;
+    for (auto it = candidates.begin(); it != candidates.end();) {
+      auto candidate = it->lock();
+      if (!candidate) {
+        it = candidates.erase(it);
+        continue;
+      }
+      if (std::memcmp(candidate->view, data.get(), size) == 0) {
+        record = std::move(candidate);
+        break;
+      }
+      ++it;
+    }
+    if (!record) {
+      record = createRecord(data.get(), size);
+      if (!record) {
+        return data;
+      }
+      candidates.push_back(record);
+    }
+    at::DataPtr shared = mapRecord(record);
+    return shared ? std::move(shared) : std::move(data);
+  }
+
+  SharedStorageStats stats() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    SharedStorageStats stats;
+    for (const auto& entry : records_) {
+      for (const auto& weak_record : entry.second) {
+        auto record = weak_record.lock();
+        if (!record) {
+          continue;
+        }
+        int64_t size = record->size;
+        int64_t num_references = record->num_references;
+        stats.num_records++;
+        stats.num_references += num_references;
+        stats.bytes += size;
+        if (num_references > 1) {
+          stats.bytes_saved += (num_references - 1) * size;
+        }
+      }
+    }
+    return stats;
+  }
+
+ private:
+  std::mutex mutex_;
+  // The records alive, by size and CRC. A record dies with the last storage
+  // sharing it.
+  std::map<std::pair<size_t, uint32_t>, std::vector<std::weak_ptr<SharedRecord>>>
+      records_;
+};
+
+StorageRegistry& storageRegistry() {
+  static StorageRegistry registry;
+  return registry;
+}
+
+#endif
+
+} // namespace
+
+bool storageSharingEnabled() {
+  return storageSharingFlag();
+}
+
+bool setStorageSharingEnabled(bool enabled) {
+#ifndef TORCH_SHARED_STORAGES
+  TORCH_CHECK(!enabled, "storage sharing is only supported on Linux");
+#endif
+  return storageSharingFlag().exchange(enabled);
+}
+
+SharedStorageStats getSharedStorageStats() {
+#ifdef TORCH_SHARED_STORAGES
+  return storageRegistry().stats();
+#else
+  return SharedStorageStats();
+#endif
+}
+
+at::DataPtr shareStorage(at::DataPtr data, size_t size, uint32_t crc32) {
+#ifdef TORCH_SHARED_STORAGES
+  if (storageSharingEnabled() && size >= kMinSharedStorageBytes) {
+    return storageRegistry().share(std::move(data), size, crc32);
+  }
+#endif
+  return data;
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <c10/core/Allocator.h>
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <cstdint>
+
+namespace torch {
+namespace jit {
+
+// When storage sharing is enabled, the tensor records of the modules loaded
+// afterwards are deduplicated across the process: the records with the same
+// contents share their memory, whichever archive they come from, which saves
+// a copy of the common weights of every model derived from the same base.
+//
+// The shared records are mapped privately, so a tensor written to gets its
+// own copy of the pages it writes, and the other tensors keep the loaded
+// contents. Only records of at least kMinSharedStorageBytes loaded on the CPU
+// are shared, and each distinct record holds a file descriptor.
+//
+// Storage sharing is only supported on Linux. It is disabled by default and
+// can be enabled by setting PYTORCH_JIT_SHARE_STORAGES=1.
+TORCH_API bool storageSharingEnabled();
+// \returns the previous state.
+TORCH_API bool setStorageSharingEnabled(bool enabled);
+
+constexpr size_t kMinSharedStorageBytes = 4096;
+
+struct SharedStorageStats {
+  // The distinct records alive.
+  int64_t num_records = 0;
+  // The tensor storages using them.
+  int64_t num_references = 0;
+  // The bytes of the distinct records.
+  int64_t bytes = 0;
+  // The bytes that loading every record separately would take in addition.
+  int64_t bytes_saved = 0;
+};
+
+TORCH_API SharedStorageStats getSharedStorageStats();
+
+// Returns the data of a record of \p size bytes whose CRC-32 in its archive is
+// \p crc32 that shares its memory with the identical records loaded before,
+// or \p data itself if the record isn't shared.
+TORCH_API at::DataPtr shareStorage(
+    at::DataPtr data,
+    size_t size,
+    uint32_t crc32);
+
+} // namespace jit
+} // namespace torch
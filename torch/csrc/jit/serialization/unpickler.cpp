@@ -7,6 +7,8 @@
 #include <torch/csrc/jit/mobile/type_parser.h>
 #include <torch/csrc/jit/serialization/pickler.h>
 #include <torch/csrc/jit/serialization/unpickler.h>
+#include <algorithm>
+#include <cstring>
 #include <string>
 
 namespace torch {
@@ -309,12 +311,10 @@ PickleOpCode Unpickler::readInstruction() {
     case PickleOpCode::TUPLE: {
       size_t start = marks_.back();
       marks_.pop_back();
-      auto tuple = c10::ivalue::Tuple::create({});
-      tuple->elements().reserve(stack_.size() - start);
       auto start_it = stack_.begin() + start;
-      for (auto it = start_it; it != stack_.end(); ++it) {
-        tuple->elements().emplace_back(*it);
-      }
+      auto tuple = c10::ivalue::Tuple::create(std::vector<IValue>(
+          std::make_move_iterator(start_it),
+          std::make_move_iterator(stack_.end())));
       stack_.erase(start_it, stack_.end());
       stack_.emplace_back(tuple);
     } break;
@@ -348,8 +348,9 @@ PickleOpCode Unpickler::readInstruction() {
       size_t start = marks_.back();
       marks_.pop_back();
       auto dict = c10::impl::GenericDict(AnyType::get(), AnyType::get());
+      dict.reserve((stack_.size() - start) / 2);
       for (size_t i = start; i < stack_.size(); i += 2) {
-        dict.insert_or_assign(stack_[i], stack_[i + 1]);
+        dict.insert_or_assign(std::move(stack_[i]), std::move(stack_[i + 1]));
       }
       stack_.erase(stack_.begin() + start, stack_.end());
       stack_.push_back(std::move(dict));
@@ -358,8 +359,10 @@ PickleOpCode Unpickler::readInstruction() {
       size_t start = marks_.back();
       marks_.pop_back();
       auto dict = stack_.at(start - 1).toGenericDict();
+      // The items of a large dict come in batches of SETITEMS.
+      dict.reserve(dict.size() + (stack_.size() - start) / 2);
       for (size_t i = start; i < stack_.size(); i += 2) {
-        dict.insert_or_assign(stack_[i], stack_[i + 1]);
+        dict.insert_or_assign(std::move(stack_[i]), std::move(stack_[i + 1]));
       }
       stack_.erase(stack_.begin() + start, stack_.end());
     } break;
@@ -394,7 +397,8 @@ PickleOpCode Unpickler::readInstruction() {
       globals_.at(idx)();
     } break;
     case PickleOpCode::BINPERSID: {
-      auto args = pop(stack_).toTuple()->elements();
+      auto args_tuple = pop(stack_).toTuple();
+      const auto& args = args_tuple->elements();
       AT_ASSERT(
           args.at(0).toStringRef() == "storage",
           "unknown PERSID key ",
@@ -783,8 +787,9 @@ void Unpickler::readList(IValue list_ivalue) {
   } else if (list_ivalue.isList()) {
     auto list = std::move(list_ivalue).toList();
     list.reserve(num_elements);
-    for (const auto& elem : elements) {
-      list.emplace_back(elem);
+    // The elements are erased from the stack below, so they can be moved.
+    for (size_t i = start; i < stack_.size(); ++i) {
+      list.emplace_back(std::move(stack_[i]));
     }
   } else {
     AT_ERROR("Unknown IValue list kind: ", list_ivalue.tagKind());
@@ -801,6 +806,16 @@ inline bool is_valid_python_id_char(char c) {
 // Read a newline terminated string
 std::string Unpickler::readString() {
   std::string ss;
+  // Fast path: the whole string is in the buffer.
+  const char* begin = buffer_.data() + buffer_pos_;
+  const char* end =
+      static_cast<const char*>(memchr(begin, '\n', buffer_remaining_));
+  if (end && std::all_of(begin, end, is_valid_python_id_char)) {
+    ss.assign(begin, end);
+    buffer_remaining_ -= end - begin + 1;
+    buffer_pos_ += end - begin + 1;
+    return ss;
+  }
   while (true) {
     char c = read<char>();
     if (c == '\n') {
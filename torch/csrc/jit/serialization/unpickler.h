@@ -111,8 +111,9 @@ class Unpickler {
   // Returns the number of bytes read. This should statefully
   // remember the position. Don't call reader_ directly.
   std::function<size_t(char*, size_t)> reader_;
-  // Small buffer to avoid calling reader_ on a per-byte basis.
-  std::array<char, 256> buffer_;
+  // Buffer to avoid calling reader_ on a per-byte basis. The readers copy
+  // from records in memory, so a larger buffer mostly saves calls.
+  std::array<char, 4096> buffer_;
   size_t buffer_pos_{0};
   size_t buffer_remaining_{0};
 
@@ -0,0 +1,140 @@
+#include <torch/csrc/jit/tensorexpr/aot_codegen.h>
+
+#include <c10/util/Exception.h>
+#include <c10/util/SmallVector.h>
+#include <torch/csrc/jit/tensorexpr/ir_printer.h>
+
+#include <sstream>
+
+#ifndef _WIN32
+#include <dlfcn.h>
+#endif
+
+namespace torch {
+namespace jit {
+namespace tensorexpr {
+
+namespace {
+
+// FNV-1a, as the names must be the same in every process.
+uint64_t stableHash(const std::string& str) {
+  uint64_t hash = 14695981039346656037ull;
+  for (unsigned char c : str) {
+    hash ^= c;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+thread_local std::shared_ptr<AotKernelLibrary> current_library;
+
+void* argToPtr(
+    const CodeGen::BufferArg& bufferArg,
+    const CodeGen::CallArg& callArg) {
+  if (!bufferArg.isVar()) {
+    return callArg.data();
+  }
+
+  switch (bufferArg.dtype().scalar_type()) {
+#define TYPE_CASE(_1, Name) \
+  case ScalarType::Name:    \
+    return callArg.Name##Ptr();
+
+    AT_FORALL_SCALAR_TYPES_AND3(Bool, Half, BFloat16, TYPE_CASE);
+#undef TYPE_CASE
+
+    default:
+      throw unsupported_dtype();
+  }
+  return nullptr;
+}
+
+} // namespace
+
+std::string aotKernelName(
+    Stmt* stmt,
+    const std::vector<CodeGen::BufferArg>& args) {
+  std::ostringstream ir;
+  for (const auto& arg : args) {
+    ir << arg.dtype() << (arg.isVar() ? " var" : " buf") << '\n';
+  }
+  ir << std::to_string(stmt);
+  std::ostringstream name;
+  name << "nnc_aot_kernel_" << std::hex << stableHash(ir.str());
+  return name.str();
+}
+
+AotKernelLibrary::AotKernelLibrary(const std::string& path) : path_(path) {
+#ifndef _WIN32
+  handle_ =
+      dlopen(path.empty() ? nullptr : path.c_str(), RTLD_LOCAL | RTLD_NOW);
+  TORCH_CHECK(
+      handle_, "Can't load the library of kernels ", path, ": ", dlerror());
+#else
+  TORCH_CHECK(false, "The kernels compiled ahead of time need dlopen");
+#endif
+}
+
+AotKernelLibrary::~AotKernelLibrary() {
+#ifndef _WIN32
+  if (handle_) {
+    dlclose(handle_);
+  }
+#endif
+}
+
+AotKernelFn AotKernelLibrary::find(const std::string& name) {
+#ifndef _WIN32
+  return reinterpret_cast<AotKernelFn>(dlsym(handle_, name.c_str()));
+#else
+  return nullptr;
+#endif
+}
+
+AotKernelLibraryGuard::AotKernelLibraryGuard(
+    std::shared_ptr<AotKernelLibrary> library)
+    : prev_(std::move(current_library)) {
+  current_library = std::move(library);
+}
+
+AotKernelLibraryGuard::~AotKernelLibraryGuard() {
+  current_library = std::move(prev_);
+}
+
+std::shared_ptr<AotKernelLibrary> currentAotKernelLibrary() {
+  return current_library;
+}
+
+AotCodeGen::AotCodeGen(
+    Stmt* stmt,
+    const std::vector<BufferArg>& args,
+    std::shared_ptr<AotKernelLibrary> library)
+    : CodeGen(stmt, args, at::kCPU), library_(std::move(library)) {
+  auto name = aotKernelName(stmt, args);
+  fn_ = library_->find(name);
+  TORCH_CHECK(
+      fn_,
+      "The library of kernels ",
+      library_->path(),
+      " has no kernel ",
+      name,
+      "; it was compiled by another build, for another kind of machine or ",
+      "for other inputs");
+}
+
+void AotCodeGen::call(const std::vector<CallArg>& args) {
+  const auto& buf_args = buffer_args();
+  if (args.size() != buf_args.size()) {
+    throw malformed_input("wrong number of args in call");
+  }
+
+  c10::SmallVector<void*, 16> argv(buf_args.size());
+  for (size_t i = 0, e = buf_args.size(); i < e; i++) {
+    argv[i] = argToPtr(buf_args[i], args[i]);
+  }
+  fn_(argv.data());
+}
+
+} // namespace tensorexpr
+} // namespace jit
+} // namespace torch
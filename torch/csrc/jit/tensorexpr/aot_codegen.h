@@ -0,0 +1,80 @@
+#pragma once
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+#include <torch/csrc/jit/tensorexpr/codegen.h>
+
+#include <memory>
+#include <string>
+
+namespace torch {
+namespace jit {
+namespace tensorexpr {
+
+// The C entry point of a kernel compiled ahead of time. It takes the array
+// of the pointers to its arguments, like the kernels the LLVM backend JITs.
+using AotKernelFn = int (*)(void**);
+
+// The name of the C function a kernel compiled ahead of time is exported
+// as. It is the hash of the IR of the kernel and of the types of its
+// arguments, which are the same in every process lowering the same fusion
+// group with the same build on the same kind of machine.
+TORCH_API std::string aotKernelName(
+    Stmt* stmt,
+    const std::vector<CodeGen::BufferArg>& args);
+
+// A shared library of kernels compiled ahead of time, or the kernels linked
+// into the process when its path is empty.
+class TORCH_API AotKernelLibrary {
+ public:
+  explicit AotKernelLibrary(const std::string& path);
+  ~AotKernelLibrary();
+
+  AotKernelLibrary(const AotKernelLibrary&) = delete;
+  AotKernelLibrary& operator=(const AotKernelLibrary&) = delete;
+
+  // The kernel exported as `name`, or nullptr if there is none.
+  AotKernelFn find(const std::string& name);
+
+  const std::string& path() const {
+    return path_;
+  }
+
+ private:
+  std::string path_;
+  void* handle_ = nullptr;
+};
+
+// While a guard lives, the CPU kernels the thread lowers call the kernels of
+// `library` instead of being compiled, and fail to lower when `library` has
+// no kernel of their name.
+class TORCH_API AotKernelLibraryGuard {
+ public:
+  explicit AotKernelLibraryGuard(std::shared_ptr<AotKernelLibrary> library);
+  ~AotKernelLibraryGuard();
+
+ private:
+  std::shared_ptr<AotKernelLibrary> prev_;
+};
+
+// The library of the innermost guard of the thread, or nullptr.
+TORCH_API std::shared_ptr<AotKernelLibrary> currentAotKernelLibrary();
+
+// Calls the kernel of `stmt` that `library` holds.
+class TORCH_API AotCodeGen : public CodeGen {
+ public:
+  AotCodeGen(
+      Stmt* stmt,
+      const std::vector<BufferArg>& args,
+      std::shared_ptr<AotKernelLibrary> library);
+
+  void call(const std::vector<CallArg>& args) override;
+
+ private:
+  // Keeps the library loaded while the kernel may be called.
+  std::shared_ptr<AotKernelLibrary> library_;
+  AotKernelFn fn_;
+};
+
+} // namespace tensorexpr
+} // namespace jit
+} // namespace torch
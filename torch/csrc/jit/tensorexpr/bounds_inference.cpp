@@ -10,6 +10,11 @@ namespace torch {
 namespace jit {
 namespace tensorexpr {
 
+DEFINE_TRIGGER(bounds_inference_us);
+
+// Collects the accesses of a statement. The accesses of a statement are
+// only those of its own subtree, so that every loop only rewrites the
+// bounds of the accesses in its body, and every access is found once.
 class BoundsInference : public IRVisitor {
  public:
   void visit(const FunctionCall* v) override;
@@ -23,9 +28,35 @@ class BoundsInference : public IRVisitor {
   }
 
  private:
+  // The bounds of an index at the start or at the end of the loop of `var`.
+  // The loads and stores of a loop body mostly use the same indices, so the
+  // bounds are memoized by the hash of the index.
+  const Expr* boundOf(
+      const Expr* index,
+      const Var* var,
+      const Expr* value,
+      std::unordered_map<SimplifierHashType, const Expr*>& bounds);
+
   BoundsInfo accesses_;
+  HashProvider hasher_;
 };
 
+const Expr* BoundsInference::boundOf(
+    const Expr* index,
+    const Var* var,
+    const Expr* value,
+    std::unordered_map<SimplifierHashType, const Expr*>& bounds) {
+  auto hash = hasher_.hash(index);
+  auto it = bounds.find(hash);
+  if (it != bounds.end()) {
+    return it->second;
+  }
+  const Expr* bound =
+      IRSimplifier::simplify(Substitute(index, {{var, value}}));
+  bounds.emplace(hash, bound);
+  return bound;
+}
+
 void BoundsInference::visit(const Load* v) {
   accesses_[v->buf()].push_back({kLoad, v->indices(), v->indices()});
 }
@@ -41,7 +72,12 @@ void BoundsInference::visit(const Store* v) {
 }
 
 void BoundsInference::visit(const For* v) {
+  BoundsInfo outer = std::move(accesses_);
+  accesses_.clear();
   v->body()->accept(this);
+  const Expr* last = IRSimplifier::simplify(new Sub(v->stop(), new IntImm(1)));
+  std::unordered_map<SimplifierHashType, const Expr*> starts;
+  std::unordered_map<SimplifierHashType, const Expr*> stops;
   for (auto& pair : accesses_) {
     for (TensorAccessBoundsInfo& access : pair.second) {
       for (size_t j = 0; j < access.start.size(); j++) {
@@ -51,29 +87,23 @@ void BoundsInference::visit(const For* v) {
         //     buf[i] = i
         // the range for i is [A, B). It should be generalized to correctly
         // handle all cases.
-        const Expr* old_start = access.start[j];
-        const Expr* old_stop = access.stop[j];
-        const Expr* new_start = Substitute(old_start, {{v->var(), v->start()}});
-        const Expr* new_stop = Substitute(
-            old_stop, {{v->var(), new Sub(v->stop(), new IntImm(1))}});
-
-        access.start[j] = IRSimplifier::simplify(new_start);
-        access.stop[j] = IRSimplifier::simplify(new_stop);
+        access.start[j] =
+            boundOf(access.start[j], v->var(), v->start(), starts);
+        access.stop[j] = boundOf(access.stop[j], v->var(), last, stops);
       }
     }
   }
+  for (auto& pair : accesses_) {
+    outer[pair.first].insert(
+        outer[pair.first].end(), pair.second.begin(), pair.second.end());
+  }
+  accesses_ = std::move(outer);
 }
 
 void BoundsInference::visit(const Block* v) {
-  BoundsInfo res;
   for (auto s : *v) {
     s->accept(this);
-    for (auto& pair : accesses_) {
-      res[pair.first].insert(
-          res[pair.first].end(), pair.second.begin(), pair.second.end());
-    }
   }
-  accesses_ = res;
 }
 
 void printBoundsInfo(const BoundsInfo& v) {
@@ -118,6 +148,9 @@ void printBoundsInfo(const BoundsInfo& v) {
 }
 
 bool equalExprs(const Expr* A, const Expr* B) {
+  if (A == B) {
+    return true;
+  }
   const Expr* diff = IRSimplifier::simplify(new Sub(B, A));
   return diff->isConstant() && immediateEquals(diff, 0);
 }
@@ -254,6 +287,7 @@ BoundsInfo mergeTensorAccesses(const BoundsInfo& unmerged) {
 }
 
 BoundsInfo inferBounds(Stmt* s) {
+  USE_TIMER(bounds_inference_us);
   BoundsInference ac;
   s->accept(&ac);
   return mergeTensorAccesses(ac.accesses());
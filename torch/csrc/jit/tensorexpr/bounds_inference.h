@@ -5,6 +5,7 @@
 #include <vector>
 
 #include <torch/csrc/WindowsTorchApiMacro.h>
+#include <torch/csrc/jit/tensorexpr/execution_counter.h>
 
 namespace torch {
 namespace jit {
@@ -25,6 +26,9 @@ struct TORCH_API TensorAccessBoundsInfo {
 using BoundsInfo =
     std::unordered_map<const Buf*, std::vector<TensorAccessBoundsInfo>>;
 
+// The microseconds spent in inferBounds.
+DECLARE_TRIGGER(bounds_inference_us);
+
 TORCH_API BoundsInfo inferBounds(Stmt* s);
 
 TORCH_API void printBoundsInfo(const BoundsInfo& v);
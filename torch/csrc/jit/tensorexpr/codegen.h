@@ -105,7 +105,7 @@ class CodeGen::CallArg {
 
 #define ARG_TYPE_CTOR(Type, Name) \
   CallArg(Type v) : Name##val_(v) {}
-  AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, ARG_TYPE_CTOR);
+  AT_FORALL_SCALAR_TYPES_AND3(Bool, Half, BFloat16, ARG_TYPE_CTOR);
 #undef ARG_TYPE_CTOR
 
   void* data() const {
@@ -116,14 +116,14 @@ class CodeGen::CallArg {
   Type Name##Data() const {         \
     return Name##val_;              \
   }
-  AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, ARG_DATA_DEFINE);
+  AT_FORALL_SCALAR_TYPES_AND3(Bool, Half, BFloat16, ARG_DATA_DEFINE);
 #undef ARG_DATA_DEFINE
 
 #define ARG_PTR_DEFINE(Type, Name)         \
   Type* Name##Ptr() const {                \
     return const_cast<Type*>(&Name##val_); \
   }
-  AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, ARG_PTR_DEFINE);
+  AT_FORALL_SCALAR_TYPES_AND3(Bool, Half, BFloat16, ARG_PTR_DEFINE);
 #undef ARG_PTR_DEFINE
 
  private:
@@ -131,7 +131,7 @@ class CodeGen::CallArg {
     void* ptr_;
 
 #define ARG_BACKING(Type, Name) Type Name##val_;
-    AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, ARG_BACKING);
+    AT_FORALL_SCALAR_TYPES_AND3(Bool, Half, BFloat16, ARG_BACKING);
 #undef ARG_BACKING
   };
 };
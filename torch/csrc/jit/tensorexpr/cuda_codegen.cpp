@@ -4,6 +4,7 @@
 #include <ATen/CUDAGeneratorImpl.h>
 #include <c10/cuda/CUDAFunctions.h>
 #include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/runtime/compiled_kernel_cache.h>
 #include <torch/csrc/jit/tensorexpr/analysis.h>
 #include <torch/csrc/jit/tensorexpr/cuda_random.h>
 #include <torch/csrc/jit/tensorexpr/eval.h>
@@ -229,6 +230,16 @@ void CudaPrinter::visit(const For* v) {
 }
 
 void CudaPrinter::visit(const Cast* v) {
+  // The Half and BFloat16 values are float ones, so that the casts to those
+  // types only round.
+  if (v->dtype().scalar_type() == ScalarType::Half) {
+    os() << "__half2float(__float2half(" << *v->src_value() << "))";
+    return;
+  }
+  if (v->dtype().scalar_type() == ScalarType::BFloat16) {
+    os() << "__bfloat162float(__float2bfloat16(" << *v->src_value() << "))";
+    return;
+  }
   os() << cudaDtypeCppString(v->dtype());
   os() << "(";
   v->src_value()->accept(this);
@@ -240,6 +251,11 @@ void CudaPrinter::visit(const Intrinsics* v) {
     os() << "Uint32ToFloat(" << *rand_func_ << "())";
     return;
   }
+  if (v->op_type() == IntrinsicsOp::kPhiloxRand) {
+    os() << "Uint32ToFloat(philox(" << *rand_seed_ << ", " << *rand_offset_
+         << ", " << *v->param(0) << ", " << *v->param(1) << "))";
+    return;
+  }
 
   std::string func_name = v->func_name();
 
@@ -249,7 +265,8 @@ void CudaPrinter::visit(const Intrinsics* v) {
     returnType = promoteTypes(returnType, v->param(i)->dtype().scalar_type());
   }
 
-  if (returnType == ScalarType::Half || returnType == ScalarType::Float) {
+  if (returnType == ScalarType::Half || returnType == ScalarType::BFloat16 ||
+      returnType == ScalarType::Float) {
     func_name = func_name + "f";
   }
 
@@ -272,6 +289,13 @@ void CudaPrinter::visit(const Load* v) {
       os() << "__half2float(" << *v->base_handle() << "[" << *v->flat_index()
            << "])";
     }
+  } else if (v->dtype().scalar_type() == ScalarType::BFloat16) {
+    if (v->indices().empty()) {
+      os() << "__bfloat162float(" << *v->base_handle() << ")";
+    } else {
+      os() << "__bfloat162float(" << *v->base_handle() << "["
+           << *v->flat_index() << "])";
+    }
   } else {
     // Detects whether the load target is also a store target.
     // TODO: this is currently too wide. It detects whether a store-target
@@ -291,6 +315,27 @@ void CudaPrinter::visit(const Load* v) {
 // TODO: maybe this should be a more shared location?
 // TODO: investigate how "Expr*" can be implicitly converted to "ExprHandle" as
 // a bool.
+// The number of the streams of the philox_rand intrinsics of a kernel.
+class PhiloxRandStreams : public IRVisitor {
+ public:
+  int num_streams() const {
+    return num_streams_;
+  }
+
+ private:
+  void visit(const Intrinsics* v) override {
+    if (v->op_type() == IntrinsicsOp::kPhiloxRand) {
+      if (!v->param(0)->isConstant()) {
+        throw malformed_input("expected a constant random stream", v);
+      }
+      num_streams_ = std::max(num_streams_, immediateAs<int>(v->param(0)) + 1);
+    }
+    IRVisitor::visit(v);
+  }
+
+  int num_streams_ = 0;
+};
+
 static bool CheckEqual(const Expr* lhs, const Expr* rhs) {
   // The fast path. Checks if the pointers are the same.
   if (lhs == rhs) {
@@ -349,6 +394,8 @@ void CudaPrinter::visit(const Store* v) {
   }
   if (v->value()->dtype().scalar_type() == ScalarType::Half) {
     os() << "__float2half(" << *v->value() << ");";
+  } else if (v->value()->dtype().scalar_type() == ScalarType::BFloat16) {
+    os() << "__float2bfloat16(" << *v->value() << ");";
   } else {
     os() << *v->value() << ";";
   }
@@ -372,6 +419,7 @@ void CudaPrinter::visit(const Max* v) {
   auto dtype = v->dtype().scalar_type();
   switch (dtype) {
     case ScalarType::Half:
+    case ScalarType::BFloat16:
       // doing Half math in float.
     case ScalarType::Float:
       os() << "fmaxf";
@@ -394,6 +442,7 @@ void CudaPrinter::visit(const Min* v) {
   auto dtype = v->dtype().scalar_type();
   switch (dtype) {
     case ScalarType::Half:
+    case ScalarType::BFloat16:
       // doing Half math in float.
     case ScalarType::Float:
       os() << "fminf";
@@ -437,7 +486,8 @@ void CudaPrinter::visit(const Block* v) {
 
 void CudaPrinter::visit(const Let* v) {
   emitIndent();
-  if (v->dtype().scalar_type() == ScalarType::Half) {
+  if (v->dtype().scalar_type() == ScalarType::Half ||
+      v->dtype().scalar_type() == ScalarType::BFloat16) {
     // we do math in floats so use that.
     os() << "float";
   } else {
@@ -759,7 +809,11 @@ void CudaCodeGen::Initialize() {
   apply_mutator(&intrinsics_expander);
 
   HasRand has_rand_func(stmt());
-  has_random_ = has_rand_func.has_rand();
+  has_thread_random_ = has_rand_func.has_rand();
+  PhiloxRandStreams streams;
+  stmt()->accept(&streams);
+  num_random_streams_ = streams.num_streams();
+  has_random_ = has_thread_random_ || num_random_streams_ > 0;
   cuda_analysis_ = std::make_unique<CudaAnalysis>();
   printer_ =
       std::make_unique<CudaPrinter>(&oss_, cuda_analysis_.get(), has_random_);
@@ -771,13 +825,16 @@ void CudaCodeGen::Initialize() {
     os() << philox_random_string << std::endl;
   }
 
-  // Check whether the statement uses the Half type, if so add the
-  // half_support_literal.
+  // Check whether the statement uses the Half or BFloat16 types, if so add
+  // the half_support_literal or the bfloat16_support_literal.
   CudaHalfChecker halfChecker;
   stmt()->accept(&halfChecker);
   if (halfChecker.hasHalf()) {
     os() << fuser::cuda::half_support_literal << std::endl;
   }
+  if (halfChecker.hasBFloat16()) {
+    os() << bfloat16_support_literal << std::endl;
+  }
 
   std::string func_name = GetUniqueFuncName("func");
   os() << "extern \"C\" __global__" << std::endl << "void " << func_name << "(";
@@ -793,12 +850,9 @@ void CudaCodeGen::Initialize() {
     os() << cudaDtypeCppString(dtype) << (buffer_arg.isVar() ? " " : "* ")
          << name_manager()->get_unique_name(var);
   }
-  const Var* rand_seed;
-  const Var* rand_offset;
+  const Var* rand_seed = printer_->rand_seed();
+  const Var* rand_offset = printer_->rand_offset();
   if (has_random_) {
-    // TODO: switch to kUint64 when it is available.
-    rand_seed = new Var("rand_seed", kInt);
-    rand_offset = new Var("rand_offset", kInt);
     std::string uint64_str = "unsigned long long";
     os() << ", " << uint64_str << " " << *rand_seed << ", " << uint64_str << " "
          << *rand_offset;
@@ -806,7 +860,7 @@ void CudaCodeGen::Initialize() {
   os() << ") {";
   os() << std::endl;
 
-  if (has_random_) {
+  if (has_thread_random_) {
     const Var* idx = new Var("idx", kInt);
     os() << "int " << *idx << " = blockIdx.x*blockDim.x + threadIdx.x;"
          << std::endl;
@@ -917,7 +971,7 @@ void CudaCodeGen::call(const std::vector<CallArg>& args) {
   case ScalarType::Name:                  \
     ptr_to_args[i] = args[i].Name##Ptr(); \
     break;
-        AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, TYPE_CASE);
+        AT_FORALL_SCALAR_TYPES_AND3(Bool, Half, BFloat16, TYPE_CASE);
 #undef TYPE_CASE
         default:
           throw unsupported_dtype();
@@ -932,6 +986,10 @@ void CudaCodeGen::call(const std::vector<CallArg>& args) {
     auto gen = at::cuda::detail::getDefaultCUDAGenerator();
     // TODO: total hack. Switch to numel when it is available.
     int64_t total_elements_per_thread = (1LL << 28);
+    if (!has_thread_random_) {
+      // The streams take 4 numbers of every subsequence; see philox.
+      total_elements_per_thread = 4 * num_random_streams_;
+    }
     {
       std::lock_guard<std::mutex> lock(gen.mutex());
       auto philox_engine_inputs =
@@ -993,11 +1051,6 @@ void CudaCodeGen::CompileToNVRTC(
   int major, minor;
   getMajorMinor(prop, major, minor);
 
-  // Creates the NVRTC program
-  nvrtcProgram program;
-  AT_CUDA_NVRTC_CHECK(nvrtc().nvrtcCreateProgram(
-      &program, code.c_str(), nullptr, 0, nullptr, nullptr));
-
 #ifdef __HIP_PLATFORM_HCC__
   std::vector<const char*> args = {};
 #else
@@ -1007,27 +1060,45 @@ void CudaCodeGen::CompileToNVRTC(
       "--std=c++14", compute.c_str(), "-default-device"};
 #endif
 
-  const auto result =
-      nvrtc().nvrtcCompileProgram(program, args.size(), args.data());
-  if (result != NVRTC_SUCCESS) {
-    size_t logsize;
-    AT_CUDA_NVRTC_CHECK(nvrtc().nvrtcGetProgramLogSize(program, &logsize));
-    std::vector<char> log(logsize);
-    AT_CUDA_NVRTC_CHECK(nvrtc().nvrtcGetProgramLog(program, log.data()));
-    std::stringstream cu;
-    cu << log.data() << std::endl;
-    cu << "nvrtc compilation failed: " << std::endl;
-    cu << code << std::endl;
-    throw std::runtime_error(cu.str());
-  }
-  ResourceGuard holdProgram(
-      [&] { AT_CUDA_NVRTC_CHECK(nvrtc().nvrtcDestroyProgram(&program)); });
-  AT_CUDA_NVRTC_CHECK(result);
-  size_t ptx_size;
-  AT_CUDA_NVRTC_CHECK(nvrtc().nvrtcGetPTXSize(program, &ptx_size));
-  std::vector<char> ptx;
-  ptx.resize(ptx_size);
-  AT_CUDA_NVRTC_CHECK(nvrtc().nvrtcGetPTX(program, ptx.data()));
+  // The PTX depends on the code, the options and the version of NVRTC.
+  int nvrtc_major, nvrtc_minor;
+  AT_CUDA_NVRTC_CHECK(nvrtc().nvrtcVersion(&nvrtc_major, &nvrtc_minor));
+  std::vector<std::string> key_parts = {
+      "cuda_codegen",
+      std::to_string(nvrtc_major) + "." + std::to_string(nvrtc_minor),
+      code};
+  key_parts.insert(key_parts.end(), args.begin(), args.end());
+  const auto key = torch::jit::compiledKernelCacheKey(key_parts);
+
+  std::string ptx;
+  if (!torch::jit::loadCompiledKernel(key, ptx)) {
+    // Creates the NVRTC program
+    nvrtcProgram program;
+    AT_CUDA_NVRTC_CHECK(nvrtc().nvrtcCreateProgram(
+        &program, code.c_str(), nullptr, 0, nullptr, nullptr));
+
+    const auto result =
+        nvrtc().nvrtcCompileProgram(program, args.size(), args.data());
+    if (result != NVRTC_SUCCESS) {
+      size_t logsize;
+      AT_CUDA_NVRTC_CHECK(nvrtc().nvrtcGetProgramLogSize(program, &logsize));
+      std::vector<char> log(logsize);
+      AT_CUDA_NVRTC_CHECK(nvrtc().nvrtcGetProgramLog(program, log.data()));
+      std::stringstream cu;
+      cu << log.data() << std::endl;
+      cu << "nvrtc compilation failed: " << std::endl;
+      cu << code << std::endl;
+      throw std::runtime_error(cu.str());
+    }
+    ResourceGuard holdProgram(
+        [&] { AT_CUDA_NVRTC_CHECK(nvrtc().nvrtcDestroyProgram(&program)); });
+    AT_CUDA_NVRTC_CHECK(result);
+    size_t ptx_size;
+    AT_CUDA_NVRTC_CHECK(nvrtc().nvrtcGetPTXSize(program, &ptx_size));
+    ptx.resize(ptx_size);
+    AT_CUDA_NVRTC_CHECK(nvrtc().nvrtcGetPTX(program, &ptx[0]));
+    torch::jit::storeCompiledKernel(key, ptx);
+  }
 
   CUmodule module;
   AT_CUDA_DRIVER_CHECK(nvrtc().cuModuleLoadData(&module, ptx.data()));
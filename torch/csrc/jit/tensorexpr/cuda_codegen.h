@@ -44,6 +44,9 @@ class CudaPrinter : public IRPrinter {
       : IRPrinter(*os), cuda_analysis_(cuda_analysis) {
     if (has_random) {
       rand_func_ = new Var("rand", kHandle);
+      // TODO: switch to kUint64 when it is available.
+      rand_seed_ = new Var("rand_seed", kInt);
+      rand_offset_ = new Var("rand_offset", kInt);
     }
   }
 
@@ -74,6 +77,15 @@ class CudaPrinter : public IRPrinter {
     return rand_func_;
   }
 
+  // The seed and the offset of the random numbers of the kernel call.
+  const Var* rand_seed() const {
+    return rand_seed_;
+  }
+
+  const Var* rand_offset() const {
+    return rand_offset_;
+  }
+
   using IRPrinter::name_manager;
   using IRPrinter::visit;
 
@@ -82,6 +94,8 @@ class CudaPrinter : public IRPrinter {
   std::vector<const Expr*> gpu_block_extents_;
   std::vector<const Expr*> gpu_thread_extents_;
   const Var* rand_func_;
+  const Var* rand_seed_ = nullptr;
+  const Var* rand_offset_ = nullptr;
   const CudaAnalysis* cuda_analysis_;
   bool need_sync_ = false;
   std::unordered_set<const Var*> thread_local_bufs_;
@@ -138,6 +152,10 @@ class TORCH_CUDA_API CudaCodeGen : public CodeGen {
   std::unique_ptr<CudaAnalysis> cuda_analysis_;
   CUfunction function_;
   bool has_random_ = false;
+  // Whether the kernel calls the generator of its thread, i.e., has rand
+  // intrinsics, and the number of the streams of its philox_rand ones.
+  bool has_thread_random_ = false;
+  int num_random_streams_ = 0;
 
   std::string GetUniqueFuncName(const std::string& func_prefix);
 };
@@ -7,24 +7,66 @@ namespace torch {
 namespace jit {
 namespace tensorexpr {
 
-// Walk the Statment looking for Half size loads/stores.
+// Walk the Statment looking for Half and BFloat16 size loads/stores/casts.
 class CudaHalfChecker : public IRVisitor {
  public:
   bool hasHalf() {
     return hasHalf_;
   }
 
+  bool hasBFloat16() {
+    return hasBFloat16_;
+  }
+
   void visit(const Load* v) override {
-    hasHalf_ |= v->dtype().scalar_type() == ScalarType::Half;
+    check(v->dtype());
+    IRVisitor::visit(v);
   }
   void visit(const Store* v) override {
-    hasHalf_ |= v->value()->dtype().scalar_type() == ScalarType::Half;
+    check(v->value()->dtype());
+    IRVisitor::visit(v);
+  }
+  void visit(const Cast* v) override {
+    check(v->dtype());
+    check(v->src_value()->dtype());
+    IRVisitor::visit(v);
   }
 
  private:
+  void check(const Dtype& dtype) {
+    hasHalf_ |= dtype.scalar_type() == ScalarType::Half;
+    hasBFloat16_ |= dtype.scalar_type() == ScalarType::BFloat16;
+  }
+
   bool hasHalf_{false};
+  bool hasBFloat16_{false};
 };
 
+// The kernels compute with the BFloat16 values in float, so they only need
+// to convert them, rounding to the nearest, ties to even, like c10::BFloat16.
+constexpr auto bfloat16_support_literal = R"(
+struct __align__(2) __bfloat16 {
+  unsigned short x;
+};
+
+__device__ __bfloat16 __float2bfloat16(const float f) {
+  __bfloat16 val;
+  if (f != f) {
+    val.x = 0x7fc0;
+  } else {
+    unsigned int bits = __float_as_uint(f);
+    val.x = (bits + ((bits >> 16) & 1) + 0x7fff) >> 16;
+  }
+  return val;
+}
+
+__device__ float __bfloat162float(const __bfloat16 b) {
+  return __uint_as_float(((unsigned int)b.x) << 16);
+}
+
+typedef __bfloat16 bfloat16;
+)";
+
 } // namespace tensorexpr
 } // namespace jit
 } // namespace torch
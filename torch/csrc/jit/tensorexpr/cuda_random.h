@@ -91,6 +91,23 @@ private:
   static const unsigned long kPhiloxSB = 0xCD9E8D57;
 };
 
+// The random number `index` of the stream `stream` of a kernel call. Every
+// stream has an offset of its own, after that of the call, and the numbers of
+// a stream are the outputs of the subsequences of the generator, 4 per
+// subsequence, so that a call reserves 4 numbers of every subsequence per
+// stream.
+__device__ inline unsigned int philox(unsigned long long seed,
+                                      unsigned long long offset,
+                                      unsigned int stream,
+                                      unsigned long long index) {
+  Philox rand(seed, index / 4, offset + 4 * (unsigned long long)stream);
+  unsigned int ret = rand();
+  for (unsigned int i = 0; i < index % 4; i++) {
+    ret = rand();
+  }
+  return ret;
+}
+
 // Inverse of 2^32.
 #define M_RAN_INVM32 2.3283064e-10f
 __device__  __inline__ float Uint32ToFloat(unsigned int x) {
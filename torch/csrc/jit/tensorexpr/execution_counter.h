@@ -2,6 +2,7 @@
 
 #include <torch/csrc/WindowsTorchApiMacro.h>
 
+#include <chrono>
 #include <string>
 #include <unordered_map>
 
@@ -38,6 +39,16 @@ counter = ExecutionCounter("useful_work_done") // this starts the counter from
 ... call C++ run() ...
 counter.elapsed_value()    // This returns the incremented value from the
                            // trigger since the creation of the counter.
+
+A trigger can also accumulate the microseconds spent in a scope, e.g., in a
+compiler pass:
+
+DEFINE_TRIGGER(useful_work_us);
+void run() {
+  USE_TIMER(useful_work_us);       // this adds the time spent in run to
+                                   // "useful_work_us"; the nested timers of
+                                   // the same trigger don't count twice.
+}
 */
 
 class ExecutionTrigger;
@@ -87,13 +98,43 @@ class ExecutionTrigger {
     value_++;
   }
 
+  void add(int value) {
+    value_ += value;
+  }
+
  private:
+  friend class ExecutionTimer;
+
   ExecutionTrigger(const ExecutionTrigger&) = delete;
   ExecutionTrigger& operator=(const ExecutionTrigger&) = delete;
   int value_ = 0;
+  // The number of the timers of the trigger that are running.
+  int running_timers_ = 0;
   const std::string name_;
 };
 
+class ExecutionTimer {
+ public:
+  explicit ExecutionTimer(ExecutionTrigger& trigger)
+      : trigger_(trigger), start_(std::chrono::steady_clock::now()) {
+    trigger_.running_timers_++;
+  }
+
+  ~ExecutionTimer() {
+    if (--trigger_.running_timers_ == 0) {
+      trigger_.add(std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::steady_clock::now() - start_)
+                       .count());
+    }
+  }
+
+ private:
+  ExecutionTimer(const ExecutionTimer&) = delete;
+  ExecutionTimer& operator=(const ExecutionTimer&) = delete;
+  ExecutionTrigger& trigger_;
+  std::chrono::steady_clock::time_point start_;
+};
+
 class ExecutionCounter {
  public:
   explicit ExecutionCounter(ExecutionTrigger& trigger) : trigger_(trigger) {
@@ -112,6 +153,7 @@ class ExecutionCounter {
 #define DEFINE_TRIGGER(name) ExecutionTrigger name(#name)
 #define DECLARE_TRIGGER(name) TORCH_API extern ExecutionTrigger name
 #define USE_TRIGGER(name) (name).trigger()
+#define USE_TIMER(name) ExecutionTimer name##_timer(name)
 
 } // namespace tensorexpr
 } // namespace jit
@@ -86,7 +86,7 @@ class TORCH_API HashProvider : public IRVisitor {
     CACHE_GUARD();                               \
     putHash(v, hash_combine(#Name, v->value())); \
   }
-  AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, IMM_VISIT);
+  AT_FORALL_SCALAR_TYPES_AND3(Bool, Half, BFloat16, IMM_VISIT);
 #undef IMM_VISIT
 
   void visit(const Cast* v) override;
@@ -155,12 +155,18 @@ class TORCH_API HashProvider : public IRVisitor {
     seed._h ^= te_hash(val) + 0x1f752c19 + (seed._h << 7) + (seed._h >> 4);
   }
 
-  // at:::Half doesn't have a prime_number_hash, so cast to short.
+  // at:::Half and at::BFloat16 don't have a prime_number_hash, so cast them
+  // to short.
   void _hash_combine(SimplifierHashType& seed, const at::Half& val) {
     seed._h ^=
         te_hash((uint16_t)val) + 0x1f752c19 + (seed._h << 7) + (seed._h >> 4);
   }
 
+  void _hash_combine(SimplifierHashType& seed, const at::BFloat16& val) {
+    seed._h ^=
+        te_hash((uint16_t)val) + 0x1f752c19 + (seed._h << 7) + (seed._h >> 4);
+  }
+
   void _hash_combine(SimplifierHashType& seed, const Dtype& val) {
     seed._h ^= te_hash(val.ToCppString()) + 0x1f752c19 + (seed._h << 7) +
         (seed._h >> 4);
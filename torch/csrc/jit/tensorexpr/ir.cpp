@@ -196,6 +196,9 @@ Dtype Intrinsics::IntrinsicsDtype(IntrinsicsOp op_type, Dtype dt1) {
 }
 
 Dtype Intrinsics::IntrinsicsDtype(IntrinsicsOp op_type, Dtype dt1, Dtype dt2) {
+  if (op_type == kPhiloxRand) {
+    return Dtype(kFloat, dt2.lanes());
+  }
   // TODO: check the op_type and make a real decision
   return dt1;
 }
@@ -207,6 +210,9 @@ Dtype Intrinsics::IntrinsicsDtype(
   if (params.size() == 0) {
     throw malformed_input("invalid params in Intrinsics");
   }
+  if (op_type == kPhiloxRand && params.size() == 2) {
+    return IntrinsicsDtype(op_type, params[0]->dtype(), params[1]->dtype());
+  }
 
   return params[0]->dtype();
 }
@@ -247,6 +253,7 @@ int Intrinsics::OpArgCount(IntrinsicsOp op_type) {
     case kFmod:
     case kPow:
     case kRemainder:
+    case kPhiloxRand:
       return 2;
     default:
       throw std::runtime_error("invalid op_type: " + c10::to_string(op_type));
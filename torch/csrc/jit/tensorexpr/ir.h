@@ -278,7 +278,7 @@ class Min : public BinaryOpNode<Min> {
    private:                                                   \
     Type value_;                                              \
   };
-AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, IMM_DECLARE);
+AT_FORALL_SCALAR_TYPES_AND3(Bool, Half, BFloat16, IMM_DECLARE);
 #undef IMM_DECLARE
 
 // Get immediate by ScalarType.
@@ -288,7 +288,7 @@ Expr* getImmediateByType(ScalarType immType, T initialVal) {
 #define TYPE_CASE(Type, Name) \
   case ScalarType::Name:      \
     return new Name##Imm(initialVal);
-    AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, TYPE_CASE);
+    AT_FORALL_SCALAR_TYPES_AND3(Bool, Half, BFloat16, TYPE_CASE);
 #undef TYPE_CASE
     default:
       throw unsupported_dtype();
@@ -307,7 +307,7 @@ T immediateAs(const Expr* e) {
   if (const Name##Imm* imm = dynamic_cast<const Name##Imm*>(e)) { \
     return imm->value();                                          \
   }
-  AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, TYPE_CASE);
+  AT_FORALL_SCALAR_TYPES_AND3(Bool, Half, BFloat16, TYPE_CASE);
 #undef TYPE_CASE
   throw unsupported_dtype();
   return 0;
@@ -319,7 +319,7 @@ bool immediateEquals(const Expr* e, T val) {
   if (const Name##Imm* imm = dynamic_cast<const Name##Imm*>(e)) { \
     return imm->value() == val;                                   \
   }
-  AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, TYPE_CASE);
+  AT_FORALL_SCALAR_TYPES_AND3(Bool, Half, BFloat16, TYPE_CASE);
 #undef TYPE_CASE
   throw unsupported_dtype();
   return false;
@@ -331,7 +331,7 @@ bool immediateIsNegative(const T* e) {
   if (const Name##Imm* imm = dynamic_cast<const Name##Imm*>(e)) { \
     return imm->value() < 0;                                      \
   }
-  AT_FORALL_SCALAR_TYPES_AND(Half, TYPE_CASE);
+  AT_FORALL_SCALAR_TYPES_AND2(Half, BFloat16, TYPE_CASE);
 #undef TYPE_CASE
   return false;
 }
@@ -635,6 +635,10 @@ enum IntrinsicsOp {
   kLgamma,
   kFrac,
   kRand, // We need more discussions on this. Should we consider stateful?
+  // philox_rand(stream, index): a float uniform in [0, 1) that only depends
+  // on the random seed and offset of the kernel call, on the stream, an
+  // integer constant, and on the index of the element.
+  kPhiloxRand,
 };
 
 class Intrinsics : public CallNode<Intrinsics> {
@@ -722,6 +726,8 @@ class Intrinsics : public CallNode<Intrinsics> {
         return "trunc";
       case kRand:
         return "rand";
+      case kPhiloxRand:
+        return "philox_rand";
       case kFmod:
         return "fmod";
       case kRemainder:
@@ -776,8 +782,10 @@ class Intrinsics : public CallNode<Intrinsics> {
     }
   }
 
+  // Whether the value only depends on the params, as the random numbers
+  // depend on the kernel call too.
   bool isPure() const {
-    return op_type_ != kRand;
+    return op_type_ != kRand && op_type_ != kPhiloxRand;
   }
 
  private:
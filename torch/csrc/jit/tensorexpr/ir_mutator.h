@@ -22,7 +22,7 @@ class Rshift;
 class CompareSelect;
 
 #define IMM_DECLARE(Type, Name) class Name##Imm;
-AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, IMM_DECLARE);
+AT_FORALL_SCALAR_TYPES_AND3(Bool, Half, BFloat16, IMM_DECLARE);
 #undef IMM_DECLARE
 
 class Cast;
@@ -69,7 +69,7 @@ class TORCH_API IRMutator {
   virtual const Expr* mutate(const CompareSelect* v);
 #define IMM_MUTATE_DECLARE(Type, Name) \
   virtual const Expr* mutate(const Name##Imm* v);
-  AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, IMM_MUTATE_DECLARE);
+  AT_FORALL_SCALAR_TYPES_AND3(Bool, Half, BFloat16, IMM_MUTATE_DECLARE);
 #undef IMM_MUTATE_DECLARE
   virtual const Expr* mutate(const Cast* v);
   virtual const Expr* mutate(const Var* v);
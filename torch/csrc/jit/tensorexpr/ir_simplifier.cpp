@@ -4,6 +4,8 @@ namespace torch {
 namespace jit {
 namespace tensorexpr {
 
+DEFINE_TRIGGER(ir_simplifier_us);
+
 // Simple recursive GCD.
 template <typename T>
 T gcd(T a, T b) {
@@ -133,7 +133,7 @@ static Expr* evaluateOp(const Expr* v) {
     Type val = eval.value<Type>();                            \
     return getImmediateByType(v->dtype().scalar_type(), val); \
   }
-    AT_FORALL_SCALAR_TYPES_AND(Half, TYPE_CASE);
+    AT_FORALL_SCALAR_TYPES_AND2(Half, BFloat16, TYPE_CASE);
 #undef TYPE_CASE
     default:
       LOG(FATAL) << "Unsupported datatype: " << v->dtype();
@@ -446,9 +446,18 @@ class TORCH_API TermExpander : public IRSimplifierBase {
   Stmt* mutate(const Free* v) override;
 };
 
+// The microseconds spent simplifying.
+DECLARE_TRIGGER(ir_simplifier_us);
+
 class TORCH_API IRSimplifier {
  public:
   static const Expr* simplify(const Expr* e) {
+    // The variables and the immediates are already simple, and the bounds
+    // and the indices of the kernels simplify many of them.
+    if (e->expr_type() == kPrimitive) {
+      return e;
+    }
+    USE_TIMER(ir_simplifier_us);
     PolynomialTransformer simplifier;
     e = e->accept_mutator(&simplifier);
 
@@ -467,6 +476,7 @@ class TORCH_API IRSimplifier {
   }
 
   static Stmt* simplify(Stmt* s) {
+    USE_TIMER(ir_simplifier_us);
     PolynomialTransformer simplifier;
     s = s->accept_mutator(&simplifier);
 
@@ -1,12 +1,17 @@
 #include <torch/csrc/jit/tensorexpr/kernel.h>
 
+#include <ATen/native/DispatchStub.h>
+#include <c10/core/WrapDimMinimal.h>
 #include <c10/util/string_utils.h>
 #include <torch/csrc/jit/jit_log.h>
 #include <torch/csrc/jit/tensorexpr/analysis.h>
+#include <torch/csrc/jit/tensorexpr/aot_codegen.h>
 #include <torch/csrc/jit/tensorexpr/ir_printer.h>
 #include <torch/csrc/jit/tensorexpr/ir_simplifier.h>
 #include <torch/csrc/jit/tensorexpr/loopnest.h>
 
+#include <limits>
+
 using namespace torch::jit;
 using namespace torch::jit::tensorexpr;
 
@@ -14,6 +19,10 @@ namespace torch {
 namespace jit {
 namespace tensorexpr {
 
+DEFINE_TRIGGER(texpr_kernel_compile_us);
+DEFINE_TRIGGER(texpr_kernel_schedule_us);
+DEFINE_TRIGGER(texpr_kernel_codegen_us);
+
 static int te_cuda_pointwise_loop_levels = -1;
 static int te_cuda_pointwise_block_count = -1;
 static int te_cuda_pointwise_block_size = -1;
@@ -162,6 +171,18 @@ std::vector<ExprHandle> TensorExprKernel::sizesForValue(
   return known_sizes_.at(v);
 }
 
+// Which of the `rank` dims of its input the list of dims `dims` of a
+// reduction reduces.
+static std::vector<bool> reducedDims(
+    const torch::jit::Value* dims,
+    size_t rank) {
+  std::vector<bool> reduced(rank, false);
+  for (int64_t dim : toIValue(dims)->toIntVector()) {
+    reduced.at(c10::maybe_wrap_dim(dim, static_cast<int64_t>(rank))) = true;
+  }
+  return reduced;
+}
+
 std::vector<ExprHandle> TensorExprKernel::inferSizesForValue(
     const torch::jit::Value* v) {
   switch (v->node()->kind()) {
@@ -181,6 +202,8 @@ std::vector<ExprHandle> TensorExprKernel::inferSizesForValue(
     case aten::sin:
     case aten::tan:
     case aten::rand_like:
+    case aten::bernoulli:
+    case aten::dropout:
     case aten::acos:
     case aten::asin:
     case aten::cosh:
@@ -309,6 +332,28 @@ std::vector<ExprHandle> TensorExprKernel::inferSizesForValue(
       throw std::runtime_error(
           "Shape info is not implemented for this kind of node");
 
+    case aten::softmax:
+    case aten::log_softmax:
+    case aten::layer_norm:
+      return sizesForValue(v->node()->input(0));
+
+    case aten::sum:
+    case aten::mean: {
+      auto const& n = v->node();
+      auto shape = sizesForValue(n->input(0));
+      auto reduced = reducedDims(n->input(1), shape.size());
+      bool keepdim = toIValue(n->input(2))->toBool();
+      std::vector<ExprHandle> sizes;
+      for (size_t i = 0; i < shape.size(); i++) {
+        if (!reduced[i]) {
+          sizes.push_back(shape[i]);
+        } else if (keepdim) {
+          sizes.push_back(IntImm::make(1));
+        }
+      }
+      return sizes;
+    }
+
     default: {
       GRAPH_DEBUG("Can't infer sizes for the node: ", *v->node());
       GRAPH_DEBUG("Full fusion group graph:\n", *v->node()->owningGraph());
@@ -357,6 +402,11 @@ void TensorExprKernel::promoteInputs(std::vector<ExprHandle>& inputs) {
     }
     highType = promoteTypes(highType, iType);
   }
+  // The Half and BFloat16 values are computed with in float, like the ATen
+  // kernels do, and only rounded to their type where a node outputs them.
+  if (highType == ScalarType::Half || highType == ScalarType::BFloat16) {
+    highType = ScalarType::Float;
+  }
 
   for (ExprHandle& e : inputs) {
     if (e.dtype().scalar_type() == ScalarType::Bool) {
@@ -373,7 +423,7 @@ void TensorExprKernel::promoteInputs(std::vector<ExprHandle>& inputs) {
   case ScalarType::Name:      \
     e = cast<Type>(e);        \
     break;
-      AT_FORALL_SCALAR_TYPES_AND(Half, TYPE_CASE);
+      AT_FORALL_SCALAR_TYPES_AND2(Half, BFloat16, TYPE_CASE);
 #undef TYPE_CASE
       default:
         throw unsupported_dtype();
@@ -388,11 +438,14 @@ ExprHandle TensorExprKernel::demoteOutput(
     return e;
   }
 
-  if (!v->isCompleteTensor()) {
+  // The outputs of unknown sizes still have the dtype of their node, as the
+  // Half and BFloat16 values are computed in float.
+  auto scalarType = v->type()->cast<TensorType>()->scalarType();
+  if (!scalarType) {
     return e;
   }
 
-  auto tt = *v->type()->cast<TensorType>()->scalarType();
+  auto tt = *scalarType;
 
   if (tt == static_cast<at::ScalarType>(e.dtype().scalar_type())) {
     return e;
@@ -403,7 +456,7 @@ ExprHandle TensorExprKernel::demoteOutput(
 #define TYPE_CASE(Type, Name) \
   case at::ScalarType::Name:  \
     return cast<Type>(e);
-    AT_FORALL_SCALAR_TYPES_AND(Half, TYPE_CASE);
+    AT_FORALL_SCALAR_TYPES_AND2(Half, BFloat16, TYPE_CASE);
 #undef TYPE_CASE
     case at::ScalarType::Bool:
       return cast<bool>(e);
@@ -460,6 +513,17 @@ std::vector<ExprHandle> TensorExprKernel::broadcastShapes(
         dim = *bt;
         hasBroadcast_ = true;
       }
+    } else if (
+        !isOne(*bt) && at->node() != bt->node() &&
+        (at->AsNode<Var>() || bt->AsNode<Var>()) &&
+        (at->AsNode<Var>() || at->AsNode<IntImm>()) &&
+        (bt->AsNode<Var>() || bt->AsNode<IntImm>())) {
+      // A symbolic size may be 1 when the kernel runs, which would broadcast
+      // it, so the kernel only runs when the sizes are equal.
+      sizeConstraints_.emplace_back(at->node(), bt->node());
+      if (at->AsNode<Var>()) {
+        dim = *bt;
+      }
     }
     ret.push_back(dim);
     at++;
@@ -649,6 +713,263 @@ Tensor* TensorExprKernel::computeFourOperand(
       });
 }
 
+// The reductions and normalizations of Half and BFloat16 tensors accumulate
+// in float.
+static ExprHandle toFloat(const ExprHandle& e) {
+  ScalarType type = e.dtype().scalar_type();
+  if (type == ScalarType::Half || type == ScalarType::BFloat16) {
+    return cast<float>(e);
+  }
+  return e;
+}
+
+Tensor* TensorExprKernel::computeRandom(
+    const std::string& name,
+    const torch::jit::Value* v,
+    const std::function<ExprHandle(
+        const ExprHandle&,
+        const std::vector<ExprHandle>&)>& innerExpr) {
+  if (!device_.is_cuda()) {
+    throw unimplemented_lowering();
+  }
+  auto sizes = sizesForValue(v);
+  int stream = randomStreams_++;
+  return Compute(
+      name,
+      dimsFromSizes(sizes),
+      [this, v, sizes, stream, innerExpr](const std::vector<VarHandle>& axes) {
+        ExprHandle index = IntImm::make(0);
+        for (size_t i = 0; i < axes.size(); i++) {
+          index = index * sizes[i] + axes[i];
+        }
+        ExprHandle rand = Intrinsics::make(
+            IntrinsicsOp::kPhiloxRand, IntImm::make(stream), index);
+        std::vector<ExprHandle> indices(axes.begin(), axes.end());
+        return demoteOutput(innerExpr(rand, indices), v);
+      });
+}
+
+Tensor* TensorExprKernel::computeSum(const torch::jit::Value* v, bool mean) {
+  auto const& n = v->node();
+  auto inputSizes = sizesForValue(n->input(0));
+  auto reduced = reducedDims(n->input(1), inputSizes.size());
+  bool keepdim = toIValue(n->input(2))->toBool();
+
+  std::vector<DimArg> outputDims;
+  std::vector<DimArg> reduceDims;
+  ExprHandle count = IntImm::make(1);
+  for (size_t i = 0; i < inputSizes.size(); i++) {
+    if (!reduced[i]) {
+      outputDims.emplace_back(inputSizes[i], "i" + c10::to_string(i));
+      continue;
+    }
+    if (keepdim) {
+      outputDims.emplace_back(IntImm::make(1), "i" + c10::to_string(i));
+    }
+    reduceDims.emplace_back(inputSizes[i], "r" + c10::to_string(i));
+    count = count * inputSizes[i];
+  }
+  // The mean scales every element rather than the sum, so that it is a
+  // single reduction.
+  ExprHandle scale = IRSimplifier::simplify(
+      ExprHandle(1.0f) / Cast::make(kFloat, count));
+  size_t nOutputDims = outputDims.size();
+
+  Tensor* sum = Reduce(
+      mean ? "aten_mean" : "aten_sum",
+      outputDims,
+      Sum(),
+      [this, n, reduced, keepdim, nOutputDims, mean, scale](
+          ParameterList& vars) {
+        // The vars are those of the output dims then of the reduced ones.
+        std::vector<ExprHandle> indices;
+        size_t outputIdx = 0;
+        size_t reduceIdx = nOutputDims;
+        for (bool isReduced : reduced) {
+          if (!isReduced) {
+            indices.push_back(vars[outputIdx++]);
+            continue;
+          }
+          if (keepdim) {
+            outputIdx++;
+          }
+          indices.push_back(vars[reduceIdx++]);
+        }
+        ExprHandle load = toFloat(tensorOrConstant(n->input(0), indices));
+        return mean ? load * scale : load;
+      },
+      reduceDims);
+  if (tensorType(sum) == *v->type()->cast<TensorType>()->scalarType()) {
+    return sum;
+  }
+  std::vector<DimArg> sumDims;
+  for (const Expr* dim : sum->dims()) {
+    sumDims.emplace_back(ExprHandle(dim));
+  }
+  return Compute(
+      mean ? "aten_mean_demoted" : "aten_sum_demoted",
+      sumDims,
+      [this, v, sum](const std::vector<VarHandle>& axes) {
+        std::vector<ExprHandle> indices(axes.begin(), axes.end());
+        return demoteOutput(sum->call(indices), v);
+      });
+}
+
+Tensor* TensorExprKernel::computeSoftmax(
+    const torch::jit::Value* v,
+    bool logSoftmax) {
+  // The softmax along a dim is computed by three loop nests, all reading the
+  // input: the maximum and the sum of the exponentials of the shifted input
+  // over the dim, into buffers of the size of the other dims, then the
+  // output from them.
+  auto const& n = v->node();
+  const torch::jit::Value* input = n->input(0);
+  auto inputSizes = sizesForValue(input);
+  size_t dim = c10::maybe_wrap_dim(
+      toIValue(n->input(1))->toInt(), static_cast<int64_t>(inputSizes.size()));
+
+  std::vector<DimArg> outerDims;
+  for (size_t i = 0; i < inputSizes.size(); i++) {
+    if (i != dim) {
+      outerDims.emplace_back(inputSizes[i], "i" + c10::to_string(i));
+    }
+  }
+  std::vector<DimArg> reduceDims = {{inputSizes[dim], "r"}};
+
+  // The indices of the input from those of the other dims and of the dim.
+  auto inputIndices = [dim](ParameterList& outer, const ExprHandle& k) {
+    std::vector<ExprHandle> indices(outer.begin(), outer.end());
+    indices.insert(indices.begin() + dim, k);
+    return indices;
+  };
+  auto outerIndices = [dim](ParameterList& axes) {
+    std::vector<ExprHandle> indices(axes.begin(), axes.end());
+    indices.erase(indices.begin() + dim);
+    return indices;
+  };
+
+  Tensor* max = Reduce(
+      "aten_softmax_max",
+      outerDims,
+      Maximum(ExprHandle(-std::numeric_limits<float>::infinity())),
+      [this, input, inputIndices](ParameterList& vars) {
+        std::vector<VarHandle> outer(vars.begin(), vars.end() - 1);
+        return toFloat(
+            tensorOrConstant(input, inputIndices(outer, vars.back())));
+      },
+      reduceDims);
+  Tensor* sum = Reduce(
+      "aten_softmax_sum",
+      outerDims,
+      Sum(),
+      [this, input, inputIndices, max](ParameterList& vars) {
+        std::vector<VarHandle> outer(vars.begin(), vars.end() - 1);
+        std::vector<ExprHandle> outerIdx(outer.begin(), outer.end());
+        return exp(
+            toFloat(tensorOrConstant(input, inputIndices(outer, vars.back()))) -
+            max->call(outerIdx));
+      },
+      reduceDims);
+
+  return Compute(
+      logSoftmax ? "aten_log_softmax" : "aten_softmax",
+      dimsFromSizes(inputSizes),
+      [this, v, input, outerIndices, max, sum, logSoftmax](
+          const std::vector<VarHandle>& axes) {
+        std::vector<ExprHandle> indices(axes.begin(), axes.end());
+        auto outer = outerIndices(axes);
+        ExprHandle shifted =
+            toFloat(tensorOrConstant(input, indices)) - max->call(outer);
+        if (logSoftmax) {
+          return demoteOutput(shifted - log(sum->call(outer)), v);
+        }
+        return demoteOutput(exp(shifted) / sum->call(outer), v);
+      });
+}
+
+Tensor* TensorExprKernel::computeLayerNorm(const torch::jit::Value* v) {
+  // The mean and the variance over the normalized dims, which are the last
+  // ones, are reductions into buffers of the size of the leading dims.
+  auto const& n = v->node();
+  const torch::jit::Value* input = n->input(0);
+  const torch::jit::Value* weight = n->input(2);
+  const torch::jit::Value* bias = n->input(3);
+  auto inputSizes = sizesForValue(input);
+  size_t nNormalized = toIValue(n->input(1))->toIntVector().size();
+  size_t nOuter = inputSizes.size() - nNormalized;
+
+  std::vector<DimArg> outerDims;
+  std::vector<DimArg> reduceDims;
+  ExprHandle count = IntImm::make(1);
+  for (size_t i = 0; i < inputSizes.size(); i++) {
+    if (i < nOuter) {
+      outerDims.emplace_back(inputSizes[i], "i" + c10::to_string(i));
+    } else {
+      reduceDims.emplace_back(inputSizes[i], "r" + c10::to_string(i));
+      count = count * inputSizes[i];
+    }
+  }
+  ExprHandle scale = IRSimplifier::simplify(
+      ExprHandle(1.0f) / Cast::make(kFloat, count));
+
+  Tensor* mean = Reduce(
+      "aten_layer_norm_mean",
+      outerDims,
+      Sum(),
+      [this, input, scale](ParameterList& vars) {
+        std::vector<ExprHandle> indices(vars.begin(), vars.end());
+        return toFloat(tensorOrConstant(input, indices)) * scale;
+      },
+      reduceDims);
+  Tensor* var = Reduce(
+      "aten_layer_norm_var",
+      outerDims,
+      Sum(),
+      [this, input, scale, mean, nOuter](ParameterList& vars) {
+        std::vector<ExprHandle> indices(vars.begin(), vars.end());
+        std::vector<ExprHandle> outer(
+            indices.begin(), indices.begin() + nOuter);
+        ExprHandle centered =
+            toFloat(tensorOrConstant(input, indices)) - mean->call(outer);
+        return centered * centered * scale;
+      },
+      reduceDims);
+
+  bool hasWeight = !weight->type()->isSubtypeOf(NoneType::get());
+  bool hasBias = !bias->type()->isSubtypeOf(NoneType::get());
+  ExprHandle eps = constant(n->input(4));
+  return Compute(
+      "aten_layer_norm",
+      dimsFromSizes(inputSizes),
+      [this,
+       v,
+       input,
+       weight,
+       bias,
+       hasWeight,
+       hasBias,
+       eps,
+       mean,
+       var,
+       nOuter](const std::vector<VarHandle>& axes) {
+        std::vector<ExprHandle> indices(axes.begin(), axes.end());
+        std::vector<ExprHandle> outer(
+            indices.begin(), indices.begin() + nOuter);
+        std::vector<ExprHandle> inner(
+            indices.begin() + nOuter, indices.end());
+        ExprHandle result = (toFloat(tensorOrConstant(input, indices)) -
+                             mean->call(outer)) *
+            rsqrt(var->call(outer) + eps);
+        if (hasWeight) {
+          result = result * toFloat(tensorOrConstant(weight, inner));
+        }
+        if (hasBias) {
+          result = result + toFloat(tensorOrConstant(bias, inner));
+        }
+        return demoteOutput(result, v);
+      });
+}
+
 Tensor* TensorExprKernel::computeValue(const torch::jit::Value* v) {
   switch (v->node()->kind()) {
     case aten::add: {
@@ -915,12 +1236,62 @@ Tensor* TensorExprKernel::computeValue(const torch::jit::Value* v) {
     } break;
 
     case aten::rand_like: {
+      if (device_.is_cuda()) {
+        return computeRandom(
+            "aten_rand_like",
+            v,
+            [](const ExprHandle& rand, const std::vector<ExprHandle>& indices) {
+              return rand;
+            });
+      }
       hasRandom_ = true;
       return computeOneOperand("aten_rand_like", v, [](const ExprHandle& a) {
         return Intrinsics::make(IntrinsicsOp::kRand, a.dtype());
       });
     } break;
 
+    case aten::bernoulli: {
+      return computeRandom(
+          "aten_bernoulli",
+          v,
+          [this, v](
+              const ExprHandle& rand, const std::vector<ExprHandle>& indices) {
+            ExprHandle p = constant(v->node()->inputs()[1]);
+            return CompareSelect::make(
+                rand,
+                Cast::make(kFloat, p),
+                FloatImm::make(1.0f),
+                FloatImm::make(0.0f),
+                kLT);
+          });
+    } break;
+
+    case aten::dropout: {
+      // The kept elements are scaled by 1 / (1 - p), like in ATen.
+      auto const& n = v->node();
+      double p = toIValue(n->inputs()[1])->toDouble();
+      bool train = toIValue(n->inputs()[2])->toBool();
+      if (!train || p == 0) {
+        return computeOneOperand(
+            "aten_dropout", v, [](const ExprHandle& a) { return a; });
+      }
+      return computeRandom(
+          "aten_dropout",
+          v,
+          [this, n, p](
+              const ExprHandle& rand, const std::vector<ExprHandle>& indices) {
+            std::vector<ExprHandle> inputs = {
+                tensorOrConstant(n->inputs()[0], indices),
+                FloatImm::make(p == 1 ? 0.0f : 1.0f / (1 - p)),
+                FloatImm::make(0.0f)};
+            promoteInputs(inputs);
+            return ifThenElse(
+                CompareSelect::make(rand, FloatImm::make(1 - p), kLT),
+                inputs[0] * inputs[1],
+                inputs[2]);
+          });
+    } break;
+
     case aten::pow: {
       return computeTwoOperand(
           "aten_pow", v, [](const ExprHandle& lhs, const ExprHandle& rhs) {
@@ -1211,12 +1582,253 @@ Tensor* TensorExprKernel::computeValue(const torch::jit::Value* v) {
           });
     }
 
+    case aten::sum: {
+      return computeSum(v, /*mean=*/false);
+    }
+
+    case aten::mean: {
+      return computeSum(v, /*mean=*/true);
+    }
+
+    case aten::softmax: {
+      return computeSoftmax(v, /*logSoftmax=*/false);
+    }
+
+    case aten::log_softmax: {
+      return computeSoftmax(v, /*logSoftmax=*/true);
+    }
+
+    case aten::layer_norm: {
+      return computeLayerNorm(v);
+    }
+
     default: {
       throw std::runtime_error("Unhandled node kind");
     }
   }
 }
 
+static bool isReduction(Tensor* t) {
+  return dynamic_cast<const ReduceOp*>(t->body()) != nullptr;
+}
+
+// The number of elements of `dtype` in a SIMD register of the machine.
+static int vectorWidth(Dtype dtype) {
+  int registerBytes = 16;
+  switch (at::native::get_cpu_capability()) {
+    case at::native::CPUCapability::AVX512:
+      registerBytes = 64;
+      break;
+    case at::native::CPUCapability::AVX2:
+    case at::native::CPUCapability::AVX:
+      registerBytes = 32;
+      break;
+    default:
+      break;
+  }
+  return std::max(registerBytes / dtype.byte_size(), 1);
+}
+
+// The side of the square tiles of the innermost two loops of the outputs
+// when an input is read across its rows, so that the cache lines of that
+// input are used up before they are evicted.
+static constexpr int kTileSize = 32;
+
+static bool isTileable(For* f) {
+  auto start = dynamic_cast<const IntImm*>(f->start());
+  auto stop = dynamic_cast<const IntImm*>(f->stop());
+  return start && stop && start->value() == 0 && stop->value() >= kTileSize &&
+      stop->value() % kTileSize == 0;
+}
+
+static void tileInnerLoops(LoopNest& l, Tensor* tensor) {
+  std::vector<For*> loops = l.getLoopStmtsFor(tensor);
+  if (loops.size() < 2) {
+    return;
+  }
+  For* rows = loops[loops.size() - 2];
+  For* cols = loops.back();
+  if (!isTileable(rows) || !isTileable(cols) || rows->body()->nstmts() != 1) {
+    return;
+  }
+  For* rowsOuter;
+  For* rowsInner;
+  For* rowsTail;
+  l.splitWithTail(rows, kTileSize, &rowsOuter, &rowsInner, &rowsTail);
+  cols = dynamic_cast<For*>(rowsInner->body()->front());
+  For* colsOuter;
+  For* colsInner;
+  For* colsTail;
+  l.splitWithTail(cols, kTileSize, &colsOuter, &colsInner, &colsTail);
+  l.reorderAxis(rowsInner, colsOuter);
+}
+
+// Whether the iterations of the top-level loops of `stmt` can be split
+// between threads: no loop nest may read a buffer another one writes, which
+// also rules out the intermediate buffers of reductions.
+static bool canChunkLoops(Stmt* stmt) {
+  Block* root = dynamic_cast<Block*>(stmt);
+  if (!root) {
+    return dynamic_cast<For*>(stmt) != nullptr;
+  }
+  std::vector<std::unordered_set<const Buf*>> stored;
+  std::vector<std::unordered_set<const Buf*>> loaded;
+  for (Stmt* s : *root) {
+    if (!dynamic_cast<For*>(s)) {
+      return false;
+    }
+    stored.emplace_back();
+    for (Store* store : NodeFinder<Store>::find(s)) {
+      stored.back().insert(store->buf());
+    }
+    loaded.emplace_back();
+    for (Load* load : NodeFinder<Load>::find(s)) {
+      loaded.back().insert(load->buf());
+    }
+  }
+  for (size_t i = 0; i < stored.size(); i++) {
+    for (size_t j = 0; j < loaded.size(); j++) {
+      if (i == j) {
+        continue;
+      }
+      for (const Buf* buf : stored[i]) {
+        if (loaded[j].count(buf)) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+// Restricts every top-level loop of `stmt` to the part `chunk` of its
+// iterations split in `numChunks` parts.
+static Stmt* chunkLoops(
+    Stmt* stmt,
+    const VarHandle& chunk,
+    const VarHandle& numChunks) {
+  std::vector<Stmt*> loops;
+  if (Block* root = dynamic_cast<Block*>(stmt)) {
+    loops = std::vector<Stmt*>(root->begin(), root->end());
+  } else {
+    loops.push_back(stmt);
+  }
+  std::vector<Stmt*> chunks;
+  for (Stmt* s : loops) {
+    For* f = dynamic_cast<For*>(s);
+    ExprHandle start(f->start());
+    ExprHandle extent = ExprHandle(f->stop()) - start;
+    ExprHandle chunkSize = (extent + numChunks - IntImm::make(1)) / numChunks;
+    ExprHandle chunkStart = Min::make(chunk * chunkSize, extent, false);
+    ExprHandle chunkStop =
+        Min::make(chunk * chunkSize + chunkSize, extent, false);
+    chunks.push_back(new For(
+        f->var(),
+        (start + chunkStart).node(),
+        (start + chunkStop).node(),
+        Stmt::clone(f->body()),
+        f->loop_options()));
+  }
+  return new Block(chunks);
+}
+
+// The loops of the perfect nest of `f`, outermost first, or none if the body
+// of its innermost loop has loops of its own.
+static std::vector<For*> perfectLoopNest(For* f) {
+  std::vector<For*> loops = {f};
+  while (loops.back()->body()->nstmts() == 1) {
+    For* inner = dynamic_cast<For*>(loops.back()->body()->front());
+    if (!inner) {
+      break;
+    }
+    loops.push_back(inner);
+  }
+  for (Stmt* s : *loops.back()->body()) {
+    if (dynamic_cast<For*>(s) || dynamic_cast<Block*>(s)) {
+      return {};
+    }
+  }
+  return loops;
+}
+
+// Whether the bodies of two loop nests over the same ranges can run in the
+// same iterations: every buffer one of them stores and the other accesses
+// must be accessed at a single index by both, so that an element is only
+// read in the iteration that writes it.
+static bool canFuseLoopBodies(Block* first, Block* second) {
+  std::unordered_set<const Buf*> stored;
+  std::unordered_map<const Buf*, std::vector<const Expr*>> accesses[2];
+  Block* bodies[] = {first, second};
+  for (int i = 0; i < 2; i++) {
+    for (Store* store : NodeFinder<Store>::find(bodies[i])) {
+      stored.insert(store->buf());
+      accesses[i][store->buf()].push_back(store->flat_index());
+    }
+    for (Load* load : NodeFinder<Load>::find(bodies[i])) {
+      accesses[i][load->buf()].push_back(load->flat_index());
+    }
+  }
+  HashProvider hasher;
+  for (const Buf* buf : stored) {
+    if (!accesses[0].count(buf) || !accesses[1].count(buf)) {
+      continue;
+    }
+    auto hash = hasher.hash(accesses[0].at(buf).front());
+    for (auto& bodyAccesses : accesses) {
+      for (const Expr* index : bodyAccesses.at(buf)) {
+        if (hasher.hash(index) != hash) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+// Merges the adjacent top-level loop nests of `root` over the same ranges,
+// e.g., those of the outputs of a kernel computing an activation and its
+// mask, or a value and its gradient, so that the inputs they share are read
+// once in a single pass over the elements.
+static void fuseLoopNests(Block* root) {
+  HashProvider hasher;
+  auto sameRange = [&](For* a, For* b) {
+    return hasher.hash(a->start()) == hasher.hash(b->start()) &&
+        hasher.hash(a->stop()) == hasher.hash(b->stop());
+  };
+  std::vector<Stmt*> stmts(root->begin(), root->end());
+  For* prev = nullptr;
+  for (Stmt* s : stmts) {
+    For* f = dynamic_cast<For*>(s);
+    if (!f || !prev) {
+      prev = f;
+      continue;
+    }
+    std::vector<For*> first = perfectLoopNest(prev);
+    std::vector<For*> second = perfectLoopNest(f);
+    bool sameRanges = !first.empty() && first.size() == second.size();
+    VarMapping mapping;
+    for (size_t i = 0; sameRanges && i < first.size(); i++) {
+      sameRanges = sameRange(first[i], second[i]);
+      mapping.emplace_back(second[i]->var(), first[i]->var());
+    }
+    if (!sameRanges) {
+      prev = f;
+      continue;
+    }
+    Block* body = dynamic_cast<Block*>(
+        Substitute(Stmt::clone(second.back()->body()), mapping));
+    if (!body || !canFuseLoopBodies(first.back()->body(), body)) {
+      prev = f;
+      continue;
+    }
+    for (Stmt* inner : body->stmts()) {
+      body->remove_stmt(inner);
+      first.back()->body()->append_stmt(inner);
+    }
+    root->remove_stmt(f);
+  }
+}
+
 void TensorExprKernel::flattenTensors(BackendType backendType) {
   if (backendType != BackendType::kCudaCodeGen) {
     // We only need to flatten for GPU, for other backends just use the same
@@ -1263,14 +1875,17 @@ void TensorExprKernel::flattenTensors(BackendType backendType) {
 }
 
 Stmt* TensorExprKernel::generateStmt(BackendType backendType) {
+  USE_TIMER(texpr_kernel_schedule_us);
   flattenTensors(backendType);
 
   torch::jit::tensorexpr::LoopNest l(flatTensorOutputs_);
   GRAPH_DEBUG("Original Stmt:\n", std::to_string(l.root_stmt()), "\n");
 
-  // Compute non-output tensors_ inline
+  // Compute non-output tensors_ inline, except for the reductions, which
+  // are computed once into buffers of their own. The tensors they read are
+  // inlined into their bodies, and those reading them load their buffers.
   for (auto& p : tensors_) {
-    if (!l.hasLoopBodyFor(p.second)) {
+    if (!l.hasLoopBodyFor(p.second) || isReduction(p.second)) {
       continue;
     }
     Stmt* loop = l.getLoopBodyFor(p.second);
@@ -1280,6 +1895,26 @@ Stmt* TensorExprKernel::generateStmt(BackendType backendType) {
       l.computeInline(loop);
     }
   }
+  // The loops over the reduced dims, which accumulate into the same element
+  // at every iteration, so that they must not be vectorized.
+  std::unordered_set<const Var*> reduceVars;
+  for (const ReduceOp* reduce : NodeFinder<ReduceOp>::find(l.root_stmt())) {
+    reduceVars.insert(
+        reduce->reduce_args().begin(), reduce->reduce_args().end());
+  }
+  if (backendType == kCudaCodeGen && !reduceVars.empty()) {
+    // The intermediate buffers of the reductions would have to be global
+    // allocations, and their loops can't be distributed over the threads
+    // like those of the flattened pointwise outputs.
+    throw std::runtime_error("Reductions are only supported on the CPU");
+  }
+  if (backendType == kLLVMCodeGen && hasTransposedInput_) {
+    for (Tensor* tensor : flatTensorOutputs_) {
+      if (!isReduction(tensor)) {
+        tileInnerLoops(l, tensor);
+      }
+    }
+  }
   if (backendType == kCudaCodeGen) {
     for (size_t i = 0; i < flatTensorOutputs_.size(); i++) {
       Tensor* tensor = flatTensorOutputs_[i];
@@ -1329,6 +1964,12 @@ Stmt* TensorExprKernel::generateStmt(BackendType backendType) {
 
   l.prepareForCodegen();
 
+  if (backendType != kCudaCodeGen) {
+    if (Block* root = dynamic_cast<Block*>(l.root_stmt())) {
+      fuseLoopNests(root);
+    }
+  }
+
   if (backendType == kLLVMCodeGen) {
     std::vector<For*> innerLoops;
     std::vector<For*> worklist;
@@ -1368,27 +2009,30 @@ Stmt* TensorExprKernel::generateStmt(BackendType backendType) {
         }
       }
 
-      if (!containsSubLoops) {
+      if (!containsSubLoops && !reduceVars.count(f->var())) {
         innerLoops.push_back(f);
       }
     }
 
-    // vectorize inner loops.
+    // vectorize inner loops to the width of the registers for the elements
+    // they store.
     for (For* loop : innerLoops) {
+      std::vector<Store*> stores = NodeFinder<Store>::find(loop);
+      Dtype dtype = stores.empty() ? kFloat : stores.front()->value()->dtype();
+      int bodyVectorWidth = vectorWidth(dtype);
+
       For* outer1;
       For* split1;
       For* tail1;
-
-      static const int kBodyVectorWidth = 8;
-      l.splitWithTail(loop, kBodyVectorWidth, &outer1, &split1, &tail1);
+      l.splitWithTail(loop, bodyVectorWidth, &outer1, &split1, &tail1);
       l.vectorize(split1);
 
-      if (tail1) {
+      int tailVectorWidth = bodyVectorWidth / 2;
+      if (tail1 && tailVectorWidth > 1) {
         For* outer2;
         For* split2;
         For* tail2;
-        static const int kTailVectorWidth = 4;
-        l.splitWithTail(tail1, kTailVectorWidth, &outer2, &split2, &tail2);
+        l.splitWithTail(tail1, tailVectorWidth, &outer2, &split2, &tail2);
         l.vectorize(split2);
       }
     }
@@ -1397,6 +2041,16 @@ Stmt* TensorExprKernel::generateStmt(BackendType backendType) {
   Stmt* stmt = l.root_stmt();
   // Arithmetic Simplification.
   stmt = IRSimplifier::simplify(stmt);
+
+  // The top-level loops of the LLVM kernels run in chunks on the threads of
+  // the ATen pool, when they are independent; see runKernel.
+  parallel_ = backendType == kLLVMCodeGen && !hasRandom_ &&
+      at::get_num_threads() > 1 && canChunkLoops(stmt);
+  if (parallel_) {
+    chunkVar_ = VarHandle("chunk", kInt);
+    numChunksVar_ = VarHandle("num_chunks", kInt);
+    stmt = IRSimplifier::simplify(chunkLoops(stmt, chunkVar_, numChunksVar_));
+  }
   GRAPH_DEBUG("Final Stmt:\n", std::to_string(stmt), "\n");
   return stmt;
 }
@@ -1430,6 +2084,10 @@ std::vector<CodeGen::BufferArg> TensorExprKernel::prepareBufferArgs() {
   for (auto& o : flatTensorOutputs_) {
     params.emplace_back(o);
   }
+  if (parallel_) {
+    params.emplace_back(chunkVar_);
+    params.emplace_back(numChunksVar_);
+  }
   return params;
 }
 
@@ -1551,27 +2209,58 @@ void TensorExprKernel::bindInput(const torch::jit::Value* input) {
           "t" + input->debugName(),
           ToDtype(static_cast<ScalarType>(*tt->scalarType())),
           {0});
-      std::vector<DimArg> inputTensorDims;
-      for (size_t i = 0; i < *tt->sizes().size(); i++) {
-        auto const size = *tt->sizes()[i];
-        inputTensorDims.emplace_back(
-            DimArg(IntImm::make(size), "i" + c10::to_string(i)));
-      }
+      // The sizes and strides that aren't static are passed to the kernel
+      // when it runs, and the sizes of the same symbol are those of the
+      // same variable.
+      auto const symbols = *tt->symbolic_sizes().sizes();
       auto const strides = tt->strides();
+      std::vector<ShapeArg> sizeArgs;
+      std::vector<ShapeArg> strideArgs;
+      std::vector<ExprHandle> inputTensorSizes;
+      std::vector<ExprHandle> inputTensorStrides;
+      for (size_t i = 0; i < symbols.size(); i++) {
+        if (symbols[i].is_static()) {
+          inputTensorSizes.push_back(IntImm::make(symbols[i].static_size()));
+        } else {
+          auto it = symbolVars_.find(symbols[i]);
+          if (it == symbolVars_.end()) {
+            VarHandle var(
+                "s" + input->debugName() + "_" + c10::to_string(i), kInt);
+            it = symbolVars_.emplace(symbols[i], var).first;
+            sizeArgs.emplace_back(i, var);
+          } else {
+            sizeChecks_.push_back({kernelArgs_.size(), i, it->second});
+          }
+          inputTensorSizes.push_back(it->second);
+        }
+        if (strides.size() && strides[i]) {
+          inputTensorStrides.push_back(IntImm::make(*strides[i]));
+          if (i + 1 == symbols.size() && i > 0 && *strides[i] != 1 &&
+              !(symbols[i].is_static() && symbols[i].static_size() == 1)) {
+            hasTransposedInput_ = true;
+          }
+        } else {
+          VarHandle var(
+              "st" + input->debugName() + "_" + c10::to_string(i), kInt);
+          strideArgs.emplace_back(i, var);
+          inputTensorStrides.push_back(var);
+        }
+      }
+      known_sizes_[input] = inputTensorSizes;
       tensors_.emplace(
           input->unique(),
           Compute(
               "input" + c10::to_string(tensors_.size() + 1),
-              inputTensorDims,
+              dimsFromSizes(inputTensorSizes),
               [&](const std::vector<VarHandle>& axes) {
                 ExprHandle idx = 0;
                 for (size_t i = 0; i < axes.size(); i++) {
-                  idx = idx + axes[i] * IntImm::make(*strides[i]);
+                  idx = idx + axes[i] * inputTensorStrides[i];
                 }
                 return inBuffer(idx);
               }));
       kernelArgs_.emplace_back(
-          inBuffer, std::vector<ShapeArg>(), std::vector<ShapeArg>());
+          inBuffer, std::move(sizeArgs), std::move(strideArgs));
       break;
     }
     case TypeKind::FloatType: {
@@ -1599,9 +2288,91 @@ void TensorExprKernel::bindInput(const torch::jit::Value* input) {
   }
 }
 
+// Whether every element of the output of `n` is computed from the elements
+// of its inputs at the same index, once they are broadcast.
+static bool isElementwise(const torch::jit::Node* n) {
+  switch (n->kind()) {
+    case prim::ConstantChunk:
+    case prim::ListConstruct:
+    case aten::cat:
+    case aten::slice:
+    case aten::unsqueeze:
+    case aten::sum:
+    case aten::mean:
+    case aten::softmax:
+    case aten::log_softmax:
+    case aten::layer_norm:
+      return false;
+    default:
+      return true;
+  }
+}
+
+// An output may be written into the buffer of an input of the same shape
+// and dtype when the input only flows to it, through elementwise nodes that
+// don't broadcast it: every element of the input is then read by the kernel
+// only to compute the same element of the output, before it is stored.
+void TensorExprKernel::findInplaceInputs() {
+  inplaceInputs_.assign(graph_->outputs().size(), -1);
+  for (size_t i = 0; i < graph_->inputs().size(); i++) {
+    const torch::jit::Value* input = graph_->inputs()[i];
+    auto inputType = input->type()->cast<TensorType>();
+    if (!inputType || !inputType->symbolic_sizes().sizes()) {
+      continue;
+    }
+    bool eligible = true;
+    const torch::jit::Value* reached = nullptr;
+    std::vector<const torch::jit::Value*> worklist = {input};
+    std::unordered_set<const torch::jit::Value*> seen = {input};
+    while (eligible && !worklist.empty()) {
+      const torch::jit::Value* v = worklist.back();
+      worklist.pop_back();
+      for (const torch::jit::Use& use : v->uses()) {
+        const torch::jit::Node* user = use.user;
+        if (user->kind() == prim::Return) {
+          eligible = eligible && v != input && (!reached || reached == v);
+          reached = v;
+          continue;
+        }
+        if (!isElementwise(user)) {
+          eligible = false;
+          break;
+        }
+        for (const torch::jit::Value* output : user->outputs()) {
+          auto outputType = output->type()->cast<TensorType>();
+          if (!outputType ||
+              outputType->symbolic_sizes().sizes() !=
+                  inputType->symbolic_sizes().sizes()) {
+            eligible = false;
+            break;
+          }
+          if (seen.insert(output).second) {
+            worklist.push_back(output);
+          }
+        }
+      }
+    }
+    if (!eligible || !reached ||
+        reached->type()->cast<TensorType>()->scalarType() !=
+            inputType->scalarType()) {
+      continue;
+    }
+    for (size_t j = 0; j < graph_->outputs().size(); j++) {
+      if (graph_->outputs()[j] == reached && inplaceInputs_[j] < 0) {
+        inplaceInputs_[j] = i;
+        break;
+      }
+    }
+  }
+}
+
 void TensorExprKernel::compile() {
+  USE_TIMER(texpr_kernel_compile_us);
   KernelScope kernelScope(&kernelArena_);
 
+  // The random nodes are lowered for the device of the kernel.
+  device_ = pickDeviceType(graph_->inputs());
+
   // Bind inputs to buffers.
   nInputs_ = graph_->inputs().size();
   for (auto const& input : graph_->inputs()) {
@@ -1634,15 +2405,21 @@ void TensorExprKernel::compile() {
     tensorOutputs_.emplace_back(tensors_.at(output->unique()));
     tensors_.erase(output->unique());
   }
+  findInplaceInputs();
 
-  device_ = pickDeviceType(graph_->inputs());
   BackendType backendType = inferBackendTypeFromDevice(device_);
   Stmt* stmt = generateStmt(backendType);
 
   // Set up formal params (inputs, then outputs) for kernel.
   std::vector<CodeGen::BufferArg> params = prepareBufferArgs();
 
-  // Generate code.
+  // Generate code, or call the kernel compiled ahead of time for the CPU.
+  USE_TIMER(texpr_kernel_codegen_us);
+  auto aotLibrary = currentAotKernelLibrary();
+  if (aotLibrary && backendType != kCudaCodeGen) {
+    codegen_ = std::make_unique<AotCodeGen>(stmt, params, aotLibrary);
+    return;
+  }
   codegen_ = CreateCodeGen(getCodeGenName(backendType), stmt, params, device_);
 }
 
@@ -1705,7 +2482,8 @@ std::vector<CodeGen::CallArg> TensorExprKernel::prepareRunArgs(
     }
   }
 
-  for (auto& o : tensorOutputs_) {
+  for (size_t i = 0; i < tensorOutputs_.size(); i++) {
+    Tensor* o = tensorOutputs_[i];
     std::vector<int64_t> tensorSize;
     for (const Expr* dim : o->dims()) {
       auto it = varToSize.find(dim);
@@ -1720,6 +2498,19 @@ std::vector<CodeGen::CallArg> TensorExprKernel::prepareRunArgs(
       }
     }
 
+    // The input is written into only when the stack holds the only reference
+    // to it and to its storage, i.e., it dies with this kernel.
+    int64_t j = inplaceInputs_[i];
+    if (j >= 0 && inputs[j].isTensor() && inputs[j].use_count() == 1) {
+      at::Tensor input = inputs[j].toTensor();
+      if (input.storage().use_count() == 1 && !input.requires_grad() &&
+          input.is_contiguous() && input.sizes() == tensorSize &&
+          input.scalar_type() == tensorType(o) && input.device() == device_) {
+        outputs.push_back(std::move(input));
+        runArgs.emplace_back(outputs.back().data_ptr());
+        continue;
+      }
+    }
     outputs.push_back(at::empty(
         tensorSize, c10::TensorOptions(tensorType(o)).device(device_)));
     runArgs.emplace_back(outputs.back().data_ptr());
@@ -1731,17 +2522,85 @@ Stmt* TensorExprKernel::getCodeGenStmt() {
   return codegen_->stmt();
 }
 
+const std::vector<CodeGen::BufferArg>& TensorExprKernel::getCodeGenArgs() {
+  return codegen_->buffer_args();
+}
+
+bool TensorExprKernel::symbolicSizesMatch(const at::ArrayRef<IValue>& inputs) {
+  if (sizeChecks_.empty() && sizeConstraints_.empty()) {
+    return true;
+  }
+  std::unordered_map<const Expr*, int64_t> sizes;
+  for (size_t i = 0; i < inputs.size(); i++) {
+    if (inputs[i].isTensor()) {
+      auto const& tensor = inputs[i].toTensor();
+      for (auto const& size : kernelArgs_[i].sizes()) {
+        sizes[size.var.node()] = tensor.sizes()[size.idx];
+      }
+    }
+  }
+  for (auto const& check : sizeChecks_) {
+    if (inputs[check.input].toTensor().sizes()[check.dim] !=
+        sizes.at(check.var.node())) {
+      return false;
+    }
+  }
+  auto value = [&](const Expr* e) {
+    if (auto imm = dynamic_cast<const IntImm*>(e)) {
+      return static_cast<int64_t>(imm->value());
+    }
+    return sizes.at(e);
+  };
+  for (auto const& constraint : sizeConstraints_) {
+    if (value(constraint.first) != value(constraint.second)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void TensorExprKernel::runKernel(Stack& stack) {
   KernelScope kernelScope(&kernelArena_);
 
   // Set up arguments (inputs, then outputs) for kernel call.
   auto inputs = last(stack, nInputs_);
+  if (!symbolicSizesMatch(inputs)) {
+    // The sizes broadcast in a way the kernel doesn't handle.
+    fallback(stack);
+    return;
+  }
   std::vector<at::Tensor> outputs;
 
   std::vector<CodeGen::CallArg> runArgs = prepareRunArgs(inputs, outputs);
 
   // Call the kernel.
-  codegen_->call(runArgs);
+  if (parallel_) {
+    // The chunks are large enough for the threads to be worth waking; the
+    // kernels too small for more than one run on the calling thread.
+    int64_t numel = 0;
+    for (auto const& o : outputs) {
+      numel = std::max(numel, o.numel());
+    }
+    int64_t numChunks = std::min<int64_t>(
+        at::get_num_threads(),
+        (numel + at::internal::GRAIN_SIZE - 1) / at::internal::GRAIN_SIZE);
+    numChunks = std::max<int64_t>(numChunks, 1);
+    runArgs.emplace_back((int32_t)0);
+    runArgs.emplace_back((int32_t)numChunks);
+    if (numChunks == 1) {
+      codegen_->call(runArgs);
+    } else {
+      at::parallel_for(0, numChunks, 1, [&](int64_t begin, int64_t end) {
+        std::vector<CodeGen::CallArg> chunkArgs = runArgs;
+        for (int64_t chunk = begin; chunk < end; chunk++) {
+          chunkArgs[chunkArgs.size() - 2] = CodeGen::CallArg((int32_t)chunk);
+          codegen_->call(chunkArgs);
+        }
+      });
+    }
+  } else {
+    codegen_->call(runArgs);
+  }
 
   // Update the stack.
   drop(stack, nInputs_);
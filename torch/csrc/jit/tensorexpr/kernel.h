@@ -3,17 +3,30 @@
 #include <torch/csrc/jit/ir/ir.h>
 #include <torch/csrc/jit/runtime/interpreter.h>
 #include <torch/csrc/jit/tensorexpr/codegen.h>
+#include <torch/csrc/jit/tensorexpr/execution_counter.h>
 #include <torch/csrc/jit/tensorexpr/tensor.h>
 
+#include <map>
+
 namespace torch {
 namespace jit {
 namespace tensorexpr {
 
+// The microseconds spent compiling the kernels, and in the scheduling of
+// their loop nests and in the creation of their code generators.
+DECLARE_TRIGGER(texpr_kernel_compile_us);
+DECLARE_TRIGGER(texpr_kernel_schedule_us);
+DECLARE_TRIGGER(texpr_kernel_codegen_us);
+
 template <typename T>
 inline std::vector<int64_t> bufferSizes(const T& t) {
   std::vector<int64_t> sizes;
   for (size_t i = 0; i < t->buf()->ndim(); i++) {
-    sizes.push_back(dynamic_cast<const IntImm*>(t->buf()->dim(i))->value());
+    auto const size = dynamic_cast<const IntImm*>(t->buf()->dim(i));
+    if (!size) {
+      throw malformed_input("expected a static size", t->buf()->dim(i));
+    }
+    sizes.push_back(size->value());
   }
   return sizes;
 }
@@ -29,6 +42,7 @@ class TORCH_API TensorExprKernel {
   }
 
   Stmt* getCodeGenStmt();
+  const std::vector<CodeGen::BufferArg>& getCodeGenArgs();
 
  private:
   enum BackendType {
@@ -41,6 +55,9 @@ class TORCH_API TensorExprKernel {
   void compile();
 
   void runKernel(Stack& stack);
+  // Whether the symbolic sizes of `inputs` meet the assumptions the kernel
+  // was generated with.
+  bool symbolicSizesMatch(const at::ArrayRef<IValue>& inputs);
 
   std::vector<DimArg> dimsFromSizes(const std::vector<ExprHandle>& sizes);
   std::vector<ExprHandle> sizesForValue(const torch::jit::Value* v);
@@ -113,6 +130,22 @@ class TORCH_API TensorExprKernel {
           const ExprHandle&,
           const ExprHandle&)>& innerExpr);
 
+  // The elements of `v` computed by `innerExpr` from a float uniform in [0, 1)
+  // and their indices. The random numbers of the element of a kernel call
+  // depend only on the linear index of the element and on the stream of `v`
+  // in the kernel, so that they are the same wherever the element is used.
+  Tensor* computeRandom(
+      const std::string& name,
+      const torch::jit::Value* v,
+      const std::function<ExprHandle(
+          const ExprHandle&,
+          const std::vector<ExprHandle>&)>& innerExpr);
+
+  // aten::sum and aten::mean over a list of dims.
+  Tensor* computeSum(const torch::jit::Value* v, bool mean);
+  Tensor* computeSoftmax(const torch::jit::Value* v, bool logSoftmax);
+  Tensor* computeLayerNorm(const torch::jit::Value* v);
+
   Tensor* computeValue(const torch::jit::Value* v);
 
   void flattenTensors(BackendType backendType);
@@ -128,6 +161,7 @@ class TORCH_API TensorExprKernel {
   at::Device pickDeviceType(const at::ArrayRef<torch::jit::Value*>& inputs);
 
   void bindInput(const torch::jit::Value* input);
+  void findInplaceInputs();
 
  private:
   struct ShapeArg {
@@ -167,6 +201,11 @@ class TORCH_API TensorExprKernel {
   int64_t nInputs_ = 0;
   std::vector<KernelArg> kernelArgs_;
   std::vector<Tensor*> tensorOutputs_;
+  // For every output, the index of the input whose buffer it may be written
+  // into when nothing else holds that input, or -1. The kernel then reads
+  // every element of the input only to compute the same element of the
+  // output; see findInplaceInputs.
+  std::vector<int64_t> inplaceInputs_;
   std::vector<Tensor*> flatTensorOutputs_;
   std::unordered_map<int64_t, Tensor*> tensors_;
   std::unordered_map<int64_t, VarHandle> scalars_;
@@ -178,9 +217,35 @@ class TORCH_API TensorExprKernel {
   Code code_;
   bool fallback_{false};
   bool hasRandom_{false};
+  // The number of the random streams of the kernel, one per random node
+  // lowered with computeRandom.
+  int randomStreams_{0};
   bool hasBroadcast_{false};
+  // Whether an input is read across its rows, as its last dim isn't the
+  // contiguous one.
+  bool hasTransposedInput_{false};
+  // Whether the top-level loops of the kernel run in chunks on several
+  // threads. The kernel then takes the index of its chunk and their number
+  // as its last two arguments.
+  bool parallel_{false};
+  VarHandle chunkVar_;
+  VarHandle numChunksVar_;
   std::unordered_map<const torch::jit::Value*, std::vector<ExprHandle>>
       known_sizes_;
+
+  // The variable of every symbolic size of the inputs.
+  std::map<c10::ShapeSymbol, VarHandle> symbolVars_;
+  // The sizes of inputs that are those of the variable of a symbol bound by
+  // a previous input, and must be equal to it.
+  struct SizeCheck {
+    size_t input;
+    size_t dim;
+    VarHandle var;
+  };
+  std::vector<SizeCheck> sizeChecks_;
+  // The pairs of sizes, static or variable, that the kernel assumes equal,
+  // as it doesn't broadcast them.
+  std::vector<std::pair<const Expr*, const Expr*>> sizeConstraints_;
 };
 
 TORCH_API int& getTECudaPointwiseLoopLevels();
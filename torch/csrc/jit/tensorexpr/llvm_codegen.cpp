@@ -3,9 +3,13 @@
 #include <torch/csrc/jit/tensorexpr/llvm_codegen.h>
 #include <torch/csrc/jit/tensorexpr/llvm_jit.h>
 
+#include <c10/util/SmallVector.h>
+
+#include <cctype>
 #include <memory>
 
 #include <llvm/Analysis/TargetTransformInfo.h>
+#include <llvm/Config/llvm-config.h>
 #include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>
 #include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
 #include <llvm/IR/IRBuilder.h>
@@ -15,6 +19,7 @@
 #include <llvm/Target/TargetMachine.h>
 #include <llvm/Transforms/IPO/PassManagerBuilder.h>
 
+#include <torch/csrc/jit/runtime/compiled_kernel_cache.h>
 #include <torch/csrc/jit/tensorexpr/buffer.h>
 #include <torch/csrc/jit/tensorexpr/execution_counter.h>
 #include <torch/csrc/jit/tensorexpr/ir.h>
@@ -42,10 +47,13 @@ class LLVMCodeGenImpl : public IRVisitor {
   llvm::BasicBlock* bb_;
   llvm::Value* value_{nullptr};
   llvm::JITTargetAddress kernelAddress_;
-  std::unique_ptr<void* []> argv_ { nullptr };
+  // The name of the function compiled ahead of time, or an empty string if
+  // the kernel is compiled by the JIT.
+  std::string aotName_;
+  std::string object_;
 
 #define LLVM_TYPE_DECLARE(_1, Name) llvm::Type* Name##Ty_;
-  AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, LLVM_TYPE_DECLARE);
+  AT_FORALL_SCALAR_TYPES_AND3(Bool, Half, BFloat16, LLVM_TYPE_DECLARE);
 #undef LLVM_TYPE_DECLARE
 
   std::unordered_map<const Var*, int> varToArg_;
@@ -65,11 +73,14 @@ class LLVMCodeGenImpl : public IRVisitor {
       Stmt* stmt,
       const std::vector<CodeGen::BufferArg>& args,
       at::Device device,
-      Dtype dtype);
+      Dtype dtype,
+      std::string aotName = "");
   ~LLVMCodeGenImpl() = default;
 
   llvm::JITTargetAddress getKernelAddress() const;
-  void** getArgvAddress() const;
+  const std::string& getObject() const {
+    return object_;
+  }
 
   void visit(const Add* v) override;
   void visit(const Sub* v) override;
@@ -86,10 +97,11 @@ class LLVMCodeGenImpl : public IRVisitor {
   void visit(const CompareSelect* v) override;
 
 #define IMM_VISIT_DECLARE(_1, Name) void visit(const Name##Imm* v) override;
-  AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, IMM_VISIT_DECLARE);
+  AT_FORALL_SCALAR_TYPES_AND3(Bool, Half, BFloat16, IMM_VISIT_DECLARE);
 #undef IMM_VISIT_DECLARE
 
   void visit(const Cast* v) override;
+  void emitCast(Dtype srcDtype, Dtype dstDtype, int lanes, const Cast* v);
   void visit(const Var* v) override;
   void visit(const Ramp* v) override;
   void visit(const Load* v) override;
@@ -106,6 +118,8 @@ class LLVMCodeGenImpl : public IRVisitor {
   void visit(const Let* v) override;
   void visit(const Cond* v) override;
 
+  llvm::Value* emitBFloat16ToFloat(llvm::Value* value, int lanes);
+  llvm::Value* emitFloatToBFloat16(llvm::Value* value, int lanes);
   llvm::Value* emitUnmaskedLoad(llvm::Value* addr, llvm::Value* idx);
   llvm::Value* emitMaskedLoad(
       llvm::Value* addr,
@@ -119,6 +133,10 @@ class LLVMCodeGenImpl : public IRVisitor {
       llvm::Value* val);
 
   void optimize(llvm::Module& M);
+  std::string emitObject(llvm::Module& M);
+  // The key of the compiled kernel cache entry of the module, before it is
+  // optimized, or an empty string if the cache is disabled.
+  std::string cacheKey();
 };
 } // namespace tensorexpr
 } // namespace jit
@@ -177,7 +195,7 @@ static void* argToPtr(
     return callArg.Name##Ptr();
     break;
 
-    AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, TYPE_CASE);
+    AT_FORALL_SCALAR_TYPES_AND3(Bool, Half, BFloat16, TYPE_CASE);
 #undef TYPE_CASE
 
     default:
@@ -186,19 +204,30 @@ static void* argToPtr(
   return nullptr;
 }
 
+std::string compileToObjectCode(
+    Stmt* stmt,
+    const std::vector<CodeGen::BufferArg>& args,
+    const std::string& name) {
+  TORCH_CHECK(!name.empty(), "expected the name of the kernel");
+  LLVMCodeGenImpl impl(stmt, args, at::kCPU, kInt, name);
+  return impl.getObject();
+}
+
 void LLVMCodeGen::call(const std::vector<CallArg>& args) {
   const auto& buf_args = buffer_args();
   if (args.size() != buf_args.size()) {
     throw malformed_input("wrong number of args in call");
   }
 
-  void** argv = impl_->getArgvAddress();
+  // The array of the arguments belongs to the call, so that the kernel can
+  // run on several threads at once.
+  c10::SmallVector<void*, 16> argv(buf_args.size());
   for (size_t i = 0, e = buf_args.size(); i < e; i++) {
     auto const& bufferArg = buf_args[i];
     auto const& callArg = args[i];
     argv[i] = argToPtr(bufferArg, callArg);
   }
-  value<float>(argv);
+  value<float>(argv.data());
   USE_TRIGGER(llvm_codegen_executed);
 }
 
@@ -210,16 +239,15 @@ llvm::JITTargetAddress LLVMCodeGenImpl::getKernelAddress() const {
   return kernelAddress_;
 }
 
-void** LLVMCodeGenImpl::getArgvAddress() const {
-  return argv_.get();
-}
-
 LLVMCodeGenImpl::LLVMCodeGenImpl(
     Stmt* stmt,
     const std::vector<CodeGen::BufferArg>& args,
     at::Device device,
-    Dtype dtype)
-    : context_(std::make_unique<llvm::LLVMContext>()), irb_(getContext()) {
+    Dtype dtype,
+    std::string aotName)
+    : context_(std::make_unique<llvm::LLVMContext>()),
+      irb_(getContext()),
+      aotName_(std::move(aotName)) {
   // Manually map types to LLVM types.
   ByteTy_ = llvm::Type::getInt8Ty(getContext());
   CharTy_ = llvm::Type::getInt8Ty(getContext());
@@ -230,6 +258,9 @@ LLVMCodeGenImpl::LLVMCodeGenImpl(
   FloatTy_ = llvm::Type::getFloatTy(getContext());
   DoubleTy_ = llvm::Type::getDoubleTy(getContext());
   BoolTy_ = ByteTy_;
+  // The BFloat16 values are their bits, which are only loaded, stored and
+  // cast: the kernels compute with them in float.
+  BFloat16Ty_ = ShortTy_;
 
   llvm::InitializeNativeTarget();
   llvm::InitializeNativeTargetAsmPrinter();
@@ -266,11 +297,33 @@ LLVMCodeGenImpl::LLVMCodeGenImpl(
   emitWrapper(params);
   emitKernel(stmt, params);
 
-  cantFail(jit_->addModule(
-      llvm::orc::ThreadSafeModule(std::move(module_), context_)));
+  if (!aotName_.empty()) {
+    kernelAddress_ = 0;
+    optimize(*module_);
+    object_ = emitObject(*module_);
+    return;
+  }
+
+  // With the compiled kernel cache, the module is compiled to object code
+  // here rather than by the JIT, so that the kernels compiled by another
+  // process are neither optimized nor compiled again.
+  auto key = cacheKey();
+  if (key.empty()) {
+    optimize(*module_);
+    cantFail(jit_->addModule(
+        llvm::orc::ThreadSafeModule(std::move(module_), context_)));
+  } else {
+    std::string object;
+    if (!torch::jit::loadCompiledKernel(key, object)) {
+      optimize(*module_);
+      object = emitObject(*module_);
+      torch::jit::storeCompiledKernel(key, object);
+    }
+    cantFail(
+        jit_->addObjectFile(llvm::MemoryBuffer::getMemBufferCopy(object)));
+  }
   auto sym = jit_->findSymbol("wrapper");
   kernelAddress_ = cantFail(sym.getAddress());
-  argv_ = std::make_unique<void*[]>(params.size());
 
   USE_TRIGGER(llvm_codegen_created);
 }
@@ -286,7 +339,7 @@ llvm::Type* LLVMCodeGenImpl::dtypeToLLVM(Dtype dtype) {
     return n##Ty_;       \
     break;
 
-    AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, TYPE_CASE);
+    AT_FORALL_SCALAR_TYPES_AND3(Bool, Half, BFloat16, TYPE_CASE);
 #undef TYPE_CASE
     default:
       throw unsupported_dtype();
@@ -303,7 +356,7 @@ void LLVMCodeGenImpl::emitWrapper(const std::vector<llvm::Type*>& params) {
   auto wrapper = llvm::Function::Create(
       llvm::FunctionType::get(IntTy_, {voidPtrPtrTy}, false),
       llvm::Function::ExternalLinkage,
-      "wrapper",
+      aotName_.empty() ? "wrapper" : aotName_,
       module_.get());
   auto wrapBB = llvm::BasicBlock::Create(getContext(), "wrapBB", wrapper);
   irb_.SetInsertPoint(wrapBB);
@@ -441,21 +494,38 @@ void LLVMCodeGenImpl::emitKernel(
   if (llvm::verifyFunction(*fn_, &llvm::outs())) {
     throw std::runtime_error("Function verification failed");
   }
-  optimize(*module_);
+}
 
-#if DEBUG_PRINT
-  llvm::errs() << *module_;
-  llvm::SmallVector<char, 0> asmBuffer;
-  llvm::raw_svector_ostream asmStream(asmBuffer);
+std::string LLVMCodeGenImpl::cacheKey() {
+  if (torch::jit::getCompiledKernelCacheDir().empty()) {
+    return "";
+  }
+  std::string ir;
+  llvm::raw_string_ostream irStream(ir);
+  module_->print(irStream, nullptr);
+  irStream.flush();
+  return torch::jit::compiledKernelCacheKey(
+      {"llvm_codegen",
+       LLVM_VERSION_STRING,
+       TM_->getTargetTriple().str(),
+       TM_->getTargetCPU().str(),
+       TM_->getTargetFeatureString().str(),
+       ir});
+}
+
+std::string LLVMCodeGenImpl::emitObject(llvm::Module& M) {
+  llvm::SmallVector<char, 0> objBuffer;
+  llvm::raw_svector_ostream objStream(objBuffer);
   llvm::legacy::PassManager PM;
-  TM_->addPassesToEmitFile(
-      PM,
-      asmStream,
-      nullptr,
-      llvm::TargetMachine::CodeGenFileType::CGFT_AssemblyFile);
-  PM.run(*module_);
-  llvm::errs() << asmStream.str();
-#endif
+  if (TM_->addPassesToEmitFile(
+          PM,
+          objStream,
+          nullptr,
+          llvm::TargetMachine::CodeGenFileType::CGFT_ObjectFile)) {
+    throw std::runtime_error("Can't emit object code for the target");
+  }
+  PM.run(M);
+  return std::string(objBuffer.begin(), objBuffer.end());
 }
 
 // TODO: The binary ops are copypasta.
@@ -747,25 +817,95 @@ void LLVMCodeGenImpl::visit(const HalfImm* v) {
   value_ = llvm::ConstantFP::get(HalfTy_, v->value());
 }
 
+void LLVMCodeGenImpl::visit(const BFloat16Imm* v) {
+  value_ = llvm::ConstantInt::get(BFloat16Ty_, v->value().x);
+}
+
 void LLVMCodeGenImpl::visit(const BoolImm* v) {
   value_ = llvm::ConstantInt::get(BoolTy_, v->value());
 }
 
+// A BFloat16 is the upper half of the bits of a float.
+llvm::Value* LLVMCodeGenImpl::emitBFloat16ToFloat(
+    llvm::Value* value,
+    int lanes) {
+  llvm::Type* intType = IntTy_;
+  llvm::Type* floatType = FloatTy_;
+  if (lanes > 1) {
+    intType = llvm::VectorType::get(IntTy_, lanes);
+    floatType = llvm::VectorType::get(FloatTy_, lanes);
+  }
+  auto bits = irb_.CreateZExt(value, intType);
+  bits = irb_.CreateShl(bits, llvm::ConstantInt::get(intType, 16));
+  return irb_.CreateBitCast(bits, floatType);
+}
+
+// Rounds a float to the nearest BFloat16, ties to even, like c10::BFloat16.
+llvm::Value* LLVMCodeGenImpl::emitFloatToBFloat16(
+    llvm::Value* value,
+    int lanes) {
+  llvm::Type* intType = IntTy_;
+  llvm::Type* shortType = BFloat16Ty_;
+  if (lanes > 1) {
+    intType = llvm::VectorType::get(IntTy_, lanes);
+    shortType = llvm::VectorType::get(BFloat16Ty_, lanes);
+  }
+  auto bits = irb_.CreateBitCast(value, intType);
+  auto lsb = irb_.CreateAnd(
+      irb_.CreateLShr(bits, llvm::ConstantInt::get(intType, 16)),
+      llvm::ConstantInt::get(intType, 1));
+  auto bias = irb_.CreateAdd(lsb, llvm::ConstantInt::get(intType, 0x7fff));
+  auto rounded = irb_.CreateTrunc(
+      irb_.CreateLShr(
+          irb_.CreateAdd(bits, bias), llvm::ConstantInt::get(intType, 16)),
+      shortType);
+  auto isNan = irb_.CreateFCmpUNO(value, value);
+  return irb_.CreateSelect(
+      isNan, llvm::ConstantInt::get(shortType, 0x7fc0), rounded);
+}
+
 void LLVMCodeGenImpl::visit(const Cast* v) {
   v->src_value()->accept(this);
 
-  llvm::Type* dstType = dtypeToLLVM(v->dtype());
-  if (v->dtype().lanes() > 1) {
-    dstType = llvm::VectorType::get(dstType, v->dtype().lanes());
+  Dtype srcDtype = v->src_value()->dtype();
+  Dtype dstDtype = v->dtype();
+  if (srcDtype.scalar_type() == dstDtype.scalar_type()) {
+    return;
+  }
+  // The BFloat16 values are cast from and to float, which is then cast like
+  // any other.
+  int lanes = dstDtype.lanes();
+  if (srcDtype.scalar_type() == ScalarType::BFloat16) {
+    value_ = emitBFloat16ToFloat(value_, lanes);
+    srcDtype = kFloat;
+  }
+  bool toBFloat16 = dstDtype.scalar_type() == ScalarType::BFloat16;
+  if (toBFloat16) {
+    dstDtype = kFloat;
+  }
+  emitCast(srcDtype, dstDtype, lanes, v);
+  if (toBFloat16) {
+    value_ = emitFloatToBFloat16(value_, lanes);
+  }
+}
+
+void LLVMCodeGenImpl::emitCast(
+    Dtype srcDtype,
+    Dtype dstDtype,
+    int lanes,
+    const Cast* v) {
+  llvm::Type* dstType = dtypeToLLVM(dstDtype);
+  if (lanes > 1) {
+    dstType = llvm::VectorType::get(dstType, lanes);
   }
-  llvm::Type* srcType = dtypeToLLVM(v->src_value()->dtype());
+  llvm::Type* srcType = dtypeToLLVM(srcDtype);
 
   if (srcType == dstType) {
     // do nothing.
     return;
   }
 
-  bool destUnsigned = v->dtype().scalar_type() == ScalarType::Byte;
+  bool destUnsigned = dstDtype.scalar_type() == ScalarType::Byte;
 
   // Scalar casts
   if (srcType->isFPOrFPVectorTy()) {
@@ -832,7 +972,7 @@ void LLVMCodeGenImpl::visit(const Ramp* v) {
   case ScalarType::Name:                               \
     vecType = llvm::VectorType::get(Name##Ty_, lanes); \
     break;
-    AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, TYPE_CASE);
+    AT_FORALL_SCALAR_TYPES_AND3(Bool, Half, BFloat16, TYPE_CASE);
 #undef TYPE_CASE
     default:
       throw std::runtime_error("invalid dtype in Ramp");
@@ -905,7 +1045,7 @@ void LLVMCodeGenImpl::visit(const Load* v) {
   case ScalarType::Name:                                             \
     loadType = llvm::VectorType::get(Name##Ty_, v->dtype().lanes()); \
     break;
-    AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, TYPE_CASE);
+    AT_FORALL_SCALAR_TYPES_AND3(Bool, Half, BFloat16, TYPE_CASE);
 #undef TYPE_CASE
     default:
       throw std::runtime_error("invalid dtype in Load");
@@ -1506,6 +1646,29 @@ void LLVMCodeGenImpl::visit(const Intrinsics* v) {
     }
   }
 
+  // The vector Sleef functions are only known to the JIT, which maps them to
+  // the implementations linked into torch, so the kernels compiled ahead of
+  // time call the math library a lane at a time instead: the name of the
+  // Sleef function is that of the math function followed by its lanes.
+  if (call_simd_sleef && !aotName_.empty()) {
+    std::string fname = llvm::cast<llvm::Function>(call_fn)->getName().str();
+    fname = fname.substr(std::string("Sleef_").size());
+    while (!fname.empty() && std::isdigit(fname.back())) {
+      fname.pop_back();
+    }
+    llvm::Type* type = call_ty->getReturnType()->getScalarType();
+    if (type == DoubleTy_ && fname.back() == 'd') {
+      fname.pop_back();
+    }
+    std::vector<llvm::Type*> paramTys(call_ty->getNumParams(), type);
+    auto callee = module_->getOrInsertFunction(
+        fname, llvm::FunctionType::get(type, paramTys, false), {});
+    call_ty = callee.getFunctionType();
+    call_fn = callee.getCallee();
+    applyMathFunctionAttributes(llvm::cast<llvm::Function>(call_fn));
+    call_simd_sleef = false;
+  }
+
   std::vector<llvm::Value*> params;
   for (auto& p : v->params()) {
     p->accept(this);
@@ -1612,6 +1775,20 @@ void LLVMCodeGenImpl::optimize(llvm::Module& M) {
   }
   FPM.doFinalization();
   PM.run(M);
+
+#if DEBUG_PRINT
+  llvm::errs() << M;
+  llvm::SmallVector<char, 0> asmBuffer;
+  llvm::raw_svector_ostream asmStream(asmBuffer);
+  llvm::legacy::PassManager AsmPM;
+  TM_->addPassesToEmitFile(
+      AsmPM,
+      asmStream,
+      nullptr,
+      llvm::TargetMachine::CodeGenFileType::CGFT_AssemblyFile);
+  AsmPM.run(M);
+  llvm::errs() << asmStream.str();
+#endif
 }
 
 RegisterCodeGen<LLVMCodeGen> llvm_codegen_reg("llvm_codegen");
@@ -53,6 +53,16 @@ class TORCH_API LLVMCodeGen : public CodeGen {
   std::unique_ptr<LLVMCodeGenImpl> impl_;
 };
 
+// Compiles `stmt` ahead of time, for the host machine, to the object code of
+// an externally visible C function `name` that takes the array of the
+// pointers to its arguments, like the kernels LLVMCodeGen compiles. The
+// object only refers to the C math library, so that it can be linked into a
+// library of its own.
+TORCH_API std::string compileToObjectCode(
+    Stmt* stmt,
+    const std::vector<CodeGen::BufferArg>& args,
+    const std::string& name);
+
 } // namespace tensorexpr
 } // namespace jit
 } // namespace torch
@@ -28,6 +28,7 @@ bool is_integral(const ScalarType& type) {
 bool is_floating_point(const ScalarType& type) {
   switch (type) {
     case ScalarType::Half:
+    case ScalarType::BFloat16:
     case ScalarType::Float:
     case ScalarType::Double:
       return true;
@@ -45,7 +46,7 @@ Dtype Dtype::scalar_dtype() const {
 // NOLINTNEXTLINE
 #define DTYPE_DEFINE(_1, n) TORCH_API Dtype k##n(ScalarType::n, 1);
 
-AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, DTYPE_DEFINE)
+AT_FORALL_SCALAR_TYPES_AND3(Bool, Half, BFloat16, DTYPE_DEFINE)
 
 #undef DTYPE_DEFINE
 
@@ -59,7 +60,7 @@ Dtype ToDtype(ScalarType type) {
 #define TYPE_CASE(_1, n) \
   case ScalarType::n:    \
     return k##n;
-    AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, TYPE_CASE)
+    AT_FORALL_SCALAR_TYPES_AND3(Bool, Half, BFloat16, TYPE_CASE)
 #undef TYPE_CASE
 
     case ScalarType::Handle:
@@ -92,7 +93,7 @@ TORCH_API std::ostream& operator<<(
     stream << #ttt;          \
     break;
 
-    AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, TYPE_CASE);
+    AT_FORALL_SCALAR_TYPES_AND3(Bool, Half, BFloat16, TYPE_CASE);
 #undef TYPE_CASE
 
     case ScalarType::Undefined:
@@ -122,7 +123,7 @@ int Dtype::byte_size() const {
     scalar_size = sizeof(Type); \
     break;
 
-    AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, TYPE_CASE);
+    AT_FORALL_SCALAR_TYPES_AND3(Bool, Half, BFloat16, TYPE_CASE);
 #undef TYPE_CASE
     default:
       throw std::runtime_error(
@@ -141,6 +142,8 @@ std::string Dtype::ToCppString() const {
 #undef TYPE_CASE
     case ScalarType::Half:
       return "half";
+    case ScalarType::BFloat16:
+      return "bfloat16";
     default:
       throw unsupported_dtype();
   }
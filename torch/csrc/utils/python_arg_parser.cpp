@@ -248,6 +248,105 @@ auto handle_torch_function(PythonArgs &r, PyObject* args, PyObject* kwargs, PyOb
   return handle_torch_function(r, nullptr, args, kwargs, torch_api, module_name);
 }
 
+auto handle_torch_function(PythonArgs &r, PyObject* self, PyObject* const* args, Py_ssize_t nargs, PyObject* kwnames, PyObject* torch_api, const char* module_name) -> PyObject*
+{
+  THPObjectPtr varargs;
+  PythonCallArgs call_args(args, nargs, kwnames, varargs);
+  auto kwargs = call_args.kwargs_dict();
+  return handle_torch_function(r, self, call_args.args_tuple(), kwargs.get(), torch_api, module_name);
+}
+
+namespace {
+
+// A direct mapped cache of whether types have a __torch_function__.
+struct TorchFunctionTypeCacheEntry {
+  PyTypeObject* type;
+  unsigned int version_tag;
+  bool has_torch_function;
+};
+
+constexpr size_t kTorchFunctionTypeCacheSize = 64;
+TorchFunctionTypeCacheEntry torch_function_type_cache[kTorchFunctionTypeCacheSize];
+
+} // namespace
+
+auto type_has_torch_function(PyObject* obj) -> bool
+{
+  PyTypeObject* tp = Py_TYPE(obj);
+  auto& entry = torch_function_type_cache[
+      (reinterpret_cast<uintptr_t>(tp) >> 4) % kTorchFunctionTypeCacheSize];
+  // The version tag of a type changes when it or one of its bases is
+  // modified, e.g. given a __torch_function__, and isn't reused by other
+  // types. Types get one when their attributes are looked up.
+  const bool has_version_tag = PyType_HasFeature(tp, Py_TPFLAGS_VALID_VERSION_TAG);
+  if (has_version_tag && entry.type == tp && entry.version_tag == tp->tp_version_tag) {
+    return entry.has_torch_function;
+  }
+  py::object method = PyTorch_LookupSpecial(obj, "__torch_function__");
+  const bool has_torch_function =
+      method.ptr() != nullptr && method.ptr() != disabled_torch_function_impl();
+  if (PyType_HasFeature(tp, Py_TPFLAGS_VALID_VERSION_TAG)) {
+    entry = {tp, tp->tp_version_tag, has_torch_function};
+  }
+  return has_torch_function;
+}
+
+PyObject* PythonCallArgs::kwarg(PyObject* name) const {
+  if (!kwnames_) {
+    return kwargs_ ? PyDict_GetItem(kwargs_, name) : nullptr;
+  }
+  const auto num_kwargs = PyTuple_GET_SIZE(kwnames_);
+  for (Py_ssize_t i = 0; i < num_kwargs; i++) {
+    PyObject* kwname = PyTuple_GET_ITEM(kwnames_, i);
+    // The names in the code of the callers are interned, but not those of
+    // **kwargs.
+    if (kwname == name ||
+        (!PyUnicode_CHECK_INTERNED(kwname) && PyUnicode_Compare(kwname, name) == 0)) {
+      return args[nargs + i];
+    }
+  }
+  return nullptr;
+}
+
+PyObject* PythonCallArgs::args_tuple() {
+  if (tuple_) {
+    return tuple_;
+  }
+  TORCH_INTERNAL_ASSERT(varargs_);
+  THPObjectPtr tuple(PyTuple_New(nargs));
+  if (!tuple) {
+    throw python_error();
+  }
+  for (Py_ssize_t i = 0; i < nargs; i++) {
+    Py_INCREF(args[i]);
+    PyTuple_SET_ITEM(tuple.get(), i, args[i]);
+  }
+  tuple_ = tuple.get();
+  *varargs_ = std::move(tuple);
+  return tuple_;
+}
+
+THPObjectPtr PythonCallArgs::kwargs_dict() const {
+  if (!kwnames_) {
+    Py_XINCREF(kwargs_);
+    return THPObjectPtr(kwargs_);
+  }
+  const auto num_kwargs = PyTuple_GET_SIZE(kwnames_);
+  if (num_kwargs == 0) {
+    return THPObjectPtr();
+  }
+  THPObjectPtr dict(PyDict_New());
+  if (!dict) {
+    throw python_error();
+  }
+  for (Py_ssize_t i = 0; i < num_kwargs; i++) {
+    if (PyDict_SetItem(dict.get(), PyTuple_GET_ITEM(kwnames_, i), args[nargs + i]) < 0) {
+      throw python_error();
+    }
+  }
+  return dict;
+}
+
 /*
  *  obj has a __torch_function__ implementation and may either be a
  *  subclass of Tensor or a Tensor-like duck type. We may need to
@@ -386,6 +485,14 @@ auto FunctionParameter::check(PyObject* obj, std::vector<py::handle> &overloaded
         return false;
       }
       auto size = tuple ? PyTuple_GET_SIZE(obj) : PyList_GET_SIZE(obj);
+      // A sequence of numbers is left to a float[] overload, e.g. the scalar
+      // lists of the _foreach_ ops.
+      if (size > 0) {
+        PyObject* first = tuple ? PyTuple_GET_ITEM(obj, 0) : PyList_GET_ITEM(obj, 0);
+        if (THPUtils_checkDouble(first)) {
+          return false;
+        }
+      }
       for (auto idx = 0; idx < size; idx++) {
         PyObject* iobj = tuple ? PyTuple_GET_ITEM(obj, idx) : PyList_GET_ITEM(obj, idx);
         if (!check_tensor_or_overload(iobj, overloaded_args)) {
@@ -402,7 +509,19 @@ auto FunctionParameter::check(PyObject* obj, std::vector<py::handle> &overloaded
       // if a size is specified (e.g. IntArrayRef[2]) we also allow passing a single int
       return size > 0 && THPUtils_checkLong(obj);
     }
-    case ParameterType::FLOAT_LIST: return (PyTuple_Check(obj) || PyList_Check(obj));
+    case ParameterType::FLOAT_LIST: {
+      auto tuple = six::isTuple(obj);
+      if (!(tuple || PyList_Check(obj))) {
+        return false;
+      }
+      // don't match a list of tensors, so that TensorList overloads are tried
+      auto size = tuple ? PyTuple_GET_SIZE(obj) : PyList_GET_SIZE(obj);
+      if (size > 0) {
+        PyObject* first = tuple ? PyTuple_GET_ITEM(obj, 0) : PyList_GET_ITEM(obj, 0);
+        return THPUtils_checkDouble(first);
+      }
+      return true;
+    }
     case ParameterType::GENERATOR: return THPGenerator_Check(obj);
     case ParameterType::BOOL: return PyBool_Check(obj);
     case ParameterType::STORAGE: return isStorage(obj);
@@ -717,12 +836,57 @@ static void extra_kwargs(FunctionSignature& signature, PyObject* kwargs, ssize_t
   throw TypeError("invalid keyword arguments");
 }
 
+// Whether obj, rejected by param, would be for the objects of its type, see
+// Note [Caching the matched signature]. tried_varargs tells if it was also
+// checked as the first of the var-args of an IntArrayRef.
+static bool rejected_by_type(const FunctionParameter& param, PyObject* obj, bool tried_varargs) {
+  if (THPVariable_Check(obj)) {
+    // Tensors bind to Scalars depending on their dims, dtype and whether they
+    // require grad, and have an __index__ depending on these too.
+    switch (param.type_) {
+      case ParameterType::SCALAR:
+      case ParameterType::COMPLEX:
+      case ParameterType::DOUBLE:
+      case ParameterType::INT64:
+        return false;
+      default:
+        return !tried_varargs;
+    }
+  }
+  // Classes defined in Python may be given a __torch_function__ at any time,
+  // and the __index__ of other objects (e.g. of numpy arrays) may depend on
+  // their value.
+  if (PyType_HasFeature(Py_TYPE(obj), Py_TPFLAGS_HEAPTYPE) ||
+      (tried_varargs && !_is_basic_python_type(Py_TYPE(obj)))) {
+    return false;
+  }
+  switch (param.type_) {
+    case ParameterType::TENSOR_LIST:
+    case ParameterType::FLOAT_LIST:
+    case ParameterType::DIMNAME_LIST:
+      // These look at the elements of the sequences.
+      return !(PyTuple_Check(obj) || PyList_Check(obj));
+    default:
+      return true;
+  }
+}
+
 bool FunctionSignature::parse(PyObject* self, PyObject* args, PyObject* kwargs, PyObject* dst[],  // NOLINT
                               bool raise_exception) {
-  auto nargs = args ? PyTuple_GET_SIZE(args) : 0;
-  ssize_t remaining_kwargs = kwargs ? PyDict_Size(kwargs) : 0;
+  PythonCallArgs call_args(args, kwargs);
+  return parse(self, call_args, dst, raise_exception);
+}
+
+bool FunctionSignature::parse(PyObject* self, PythonCallArgs& args, PyObject* dst[],  // NOLINT
+                              bool raise_exception, bool* rejected_by_types) {
+  auto nargs = args.nargs;
+  ssize_t remaining_kwargs = args.num_kwargs();
   ssize_t arg_pos = 0;
   bool allow_varargs_intlist = false;
+  if (rejected_by_types) {
+    // Set back to false if the call is rejected because of a value.
+    *rejected_by_types = true;
+  }
 
   // if there is a single positional IntArrayRef argument, i.e. expand(..), view(...),
   // allow a var-args style IntArrayRef, so expand(5,3) behaves as expand((5,3))
@@ -757,14 +921,14 @@ bool FunctionSignature::parse(PyObject* self, PyObject* args, PyObject* kwargs,
         }
         return false;
       }
-      obj = PyTuple_GET_ITEM(args, arg_pos);
-    } else if (kwargs) {
-      obj = PyDict_GetItem(kwargs, param.python_name);
+      obj = args.args[arg_pos];
+    } else if (remaining_kwargs > 0) {
+      obj = args.kwarg(param.python_name);
       for (PyObject *numpy_name: param.numpy_python_names) {
         if (obj) {
           break;
         }
-        obj = PyDict_GetItem(kwargs, numpy_name);
+        obj = args.kwarg(numpy_name);
       }
       is_kwd = true;
     }
@@ -786,7 +950,7 @@ bool FunctionSignature::parse(PyObject* self, PyObject* args, PyObject* kwargs,
                THPUtils_checkIndex(obj)) {
       // take all positional arguments as this parameter
       // e.g. permute(1, 2, 3) -> permute((1, 2, 3))
-      dst[i++] = args;
+      dst[i++] = args.args_tuple();
       arg_pos = nargs;
       continue;
     } else if (raise_exception) {
@@ -802,6 +966,10 @@ bool FunctionSignature::parse(PyObject* self, PyObject* args, PyObject* kwargs,
             param.type_name().c_str(), Py_TYPE(obj)->tp_name);
       }
     } else {
+      if (rejected_by_types) {
+        *rejected_by_types = rejected_by_type(
+            param, obj, allow_varargs_intlist && arg_pos == 0 && !is_kwd);
+      }
       return false;
     }
 
@@ -815,7 +983,7 @@ bool FunctionSignature::parse(PyObject* self, PyObject* args, PyObject* kwargs,
   if (remaining_kwargs > 0) {
     if (raise_exception) {
       // foo() got an unexpected keyword argument "b"
-      extra_kwargs(*this, kwargs, nargs);
+      extra_kwargs(*this, args.kwargs_dict().get(), nargs);
     }
     return false;
   }
@@ -865,26 +1033,69 @@ void PythonArgParser::check_deprecated(const FunctionSignature & signature) {
   }
 }
 
-PythonArgs PythonArgParser::raw_parse(PyObject* self, PyObject* args, PyObject* kwargs, PyObject* parsed_args[]) {  // NOLINT
+bool PythonArgParser::SignatureCache::matches(const PythonCallArgs& args) const {
+  if (signature < 0 || args.nargs != nargs) {
+    return false;
+  }
+  for (ssize_t i = 0; i < nargs; i++) {
+    if ((PyObject*)Py_TYPE(args.args[i]) != types[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void PythonArgParser::SignatureCache::update(int signature_, const PythonCallArgs& args) {
+  std::array<PyObject*, kMaxCachedArgs> old_types = types;
+  const ssize_t old_nargs = nargs;
+  for (ssize_t i = 0; i < args.nargs; i++) {
+    types[i] = (PyObject*)Py_TYPE(args.args[i]);
+    Py_INCREF(types[i]);
+  }
+  nargs = args.nargs;
+  signature = signature_;
+  for (ssize_t i = 0; i < old_nargs; i++) {
+    Py_DECREF(old_types[i]);
+  }
+}
+
+PythonArgs PythonArgParser::raw_parse(PyObject* self, PythonCallArgs& args, PyObject* parsed_args[]) {  // NOLINT
   if (signatures_.size() == 1) {
     auto& signature = signatures_[0];
-    signature.parse(self, args, kwargs, parsed_args, true);
+    signature.parse(self, args, parsed_args, true);
     check_deprecated(signature);
     return PythonArgs(traceable, signature, parsed_args);
   }
 
-  for (auto& signature : signatures_) {
-    if (signature.parse(self, args, kwargs, parsed_args, false)) {
+  // See Note [Caching the matched signature]
+  const bool cacheable = args.nargs <= kMaxCachedArgs && args.num_kwargs() == 0;
+  if (cacheable && signature_cache_.matches(args)) {
+    auto& signature = signatures_[signature_cache_.signature];
+    if (signature.parse(self, args, parsed_args, false)) {
+      check_deprecated(signature);
+      return PythonArgs(traceable, signature, parsed_args);
+    }
+  }
+
+  bool rejected_by_types = cacheable;
+  for (size_t i = 0; i < signatures_.size(); i++) {
+    auto& signature = signatures_[i];
+    bool signature_rejected_by_types = false;
+    if (signature.parse(self, args, parsed_args, false, &signature_rejected_by_types)) {
+      if (rejected_by_types && i > 0) {
+        signature_cache_.update(static_cast<int>(i), args);
+      }
       check_deprecated(signature);
       return PythonArgs(traceable, signature, parsed_args);
     }
+    rejected_by_types = rejected_by_types && signature_rejected_by_types;
   }
 
-  print_error(self, args, kwargs, parsed_args);
+  print_error(self, args, parsed_args);
 }
 
-void PythonArgParser::print_error(PyObject* self, PyObject* args, PyObject* kwargs, PyObject* parsed_args[]) {  // NOLINT
-  auto num_args = PyTuple_GET_SIZE(args) + (kwargs ? PyDict_Size(kwargs) : 0);
+void PythonArgParser::print_error(PyObject* self, PythonCallArgs& args, PyObject* parsed_args[]) {  // NOLINT
+  auto num_args = args.nargs + args.num_kwargs();
   std::vector<int> plausible_idxs;
   ssize_t i = 0;
   for (auto& signature : signatures_) {
@@ -896,11 +1107,12 @@ void PythonArgParser::print_error(PyObject* self, PyObject* args, PyObject* kwar
 
   if (plausible_idxs.size() == 1) {
     auto& signature = signatures_[plausible_idxs[0]];
-    signature.parse(self, args, kwargs, parsed_args, true);
+    signature.parse(self, args, parsed_args, true);
   }
 
   auto options = get_signatures();
-  auto msg = torch::format_invalid_args(args, kwargs, function_name + "()", options);
+  auto kwargs = args.kwargs_dict();
+  auto msg = torch::format_invalid_args(args.args_tuple(), kwargs.get(), function_name + "()", options);
   throw TypeError("%s", msg.c_str());
 }
 
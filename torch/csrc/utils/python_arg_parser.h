@@ -91,6 +91,61 @@ template<int N>
 struct ParsedArgs {
   ParsedArgs() : args() { }
   PyObject* args[N];
+  // The tuple of the positional arguments of a vectorcall, if it was needed
+  // (e.g. for the sizes of x.view(2, 3)), which the args may point to.
+  THPObjectPtr varargs;
+};
+
+// The arguments of a call of a binding: the positional ones in an array, and
+// the keyword ones either in a dict (METH_VARARGS | METH_KEYWORDS) or, for a
+// vectorcall (METH_FASTCALL | METH_KEYWORDS), as the tuple of their names,
+// whose values follow the positional arguments in the array.
+struct PythonCallArgs {
+  // A tuple and a dict, which may both be null.
+  PythonCallArgs(PyObject* args, PyObject* kwargs)
+    : args(args ? &PyTuple_GET_ITEM(args, 0) : nullptr)
+    , nargs(args ? PyTuple_GET_SIZE(args) : 0)
+    , tuple_(args)
+    , kwargs_(kwargs)
+    , kwnames_(nullptr)
+    , varargs_(nullptr) {}
+
+  // The arguments of a vectorcall; kwnames may be null. varargs holds the
+  // tuple of the positional arguments if one is created.
+  PythonCallArgs(PyObject* const* args, Py_ssize_t nargs, PyObject* kwnames, THPObjectPtr& varargs)
+    : args(args)
+    , nargs(nargs)
+    , tuple_(nullptr)
+    , kwargs_(nullptr)
+    , kwnames_(kwnames)
+    , varargs_(&varargs) {}
+
+  Py_ssize_t num_kwargs() const {
+    if (kwnames_) {
+      return PyTuple_GET_SIZE(kwnames_);
+    }
+    return kwargs_ ? PyDict_Size(kwargs_) : 0;
+  }
+
+  // The value of the keyword argument `name`, an interned string, or null if
+  // it wasn't given. Borrowed.
+  PyObject* kwarg(PyObject* name) const;
+
+  // The positional arguments as a tuple, created for a vectorcall. Borrowed.
+  PyObject* args_tuple();
+
+  // The keyword arguments as a dict, created for a vectorcall, or null if
+  // there are none.
+  THPObjectPtr kwargs_dict() const;
+
+  PyObject* const* args;
+  Py_ssize_t nargs;
+
+private:
+  PyObject* tuple_;
+  PyObject* kwargs_;
+  PyObject* kwnames_;
+  THPObjectPtr* varargs_;
 };
 
 struct PythonArgParser {
@@ -105,16 +160,50 @@ struct PythonArgParser {
 
   inline PythonArgs parse(PyObject* self, ParsedArgs<0>& dst);
 
+  // For the bindings taking their arguments by vectorcall, i.e. the
+  // METH_FASTCALL | METH_KEYWORDS methods of Tensor: the nargs positional
+  // arguments followed by the values of the keyword arguments named in the
+  // tuple kwnames, if any. This saves the tuple and the dict of the arguments.
+  template<int N>
+  inline PythonArgs parse(PyObject* self, PyObject* const* args, Py_ssize_t nargs, PyObject* kwnames, ParsedArgs<N>& dst);
+
   // Formatted strings of non-hidden signatures
   std::vector<std::string> get_signatures() const;
 
 private:
   [[noreturn]]
-  void print_error(PyObject* self, PyObject* args, PyObject* kwargs, PyObject* parsed_args[]);
+  void print_error(PyObject* self, PythonCallArgs& args, PyObject* parsed_args[]);
   void check_deprecated(const FunctionSignature & signature);
-  PythonArgs raw_parse(PyObject* self, PyObject* args, PyObject* kwargs, PyObject* parsed_args[]);
+  template<int N>
+  inline void check_capacity() const;
+  PythonArgs raw_parse(PyObject* self, PythonCallArgs& args, PyObject* parsed_args[]);
+
+  // Note [Caching the matched signature]
+  // Trying the signatures in order until one of them matches is the bulk of
+  // the parsing of the calls of the overloaded functions, and the calls of a
+  // call site usually match the same one. So we remember the signature that
+  // matched the last call without keyword arguments, with the types of its
+  // positional arguments, and try it first for the calls with arguments of
+  // the same types. This finds the first signature that matches, as required
+  // by Note [Order of overloads matters], as long as the signatures before
+  // it rejected the call for reasons that only depend on these types, e.g.
+  // not because a Tensor didn't bind to a Scalar as it required grad. The
+  // cache is only updated in that case, see FunctionSignature::parse.
+  static constexpr ssize_t kMaxCachedArgs = 6;
+  struct SignatureCache {
+    bool matches(const PythonCallArgs& args) const;
+    void update(int signature, const PythonCallArgs& args);
+
+    // The index in signatures_, -1 if none.
+    int signature = -1;
+    ssize_t nargs = 0;
+    // Strong references, so that other types can't get their addresses. Like
+    // FunctionParameter::python_name these are leaked.
+    std::array<PyObject*, kMaxCachedArgs> types{};
+  };
 
   std::vector<FunctionSignature> signatures_;
+  SignatureCache signature_cache_;
   std::string function_name;
   ssize_t max_args;
   bool traceable;
@@ -125,6 +214,12 @@ struct PYBIND11_EXPORT FunctionSignature {
 
   bool parse(PyObject* self, PyObject* args, PyObject* kwargs, PyObject* dst[], bool raise_exception);
 
+  // If the call is rejected, *rejected_by_types tells whether every call
+  // with arguments of the same types, passed the same way, would be; see
+  // Note [Caching the matched signature].
+  bool parse(PyObject* self, PythonCallArgs& args, PyObject* dst[], bool raise_exception,
+             bool* rejected_by_types = nullptr);
+
   std::string toString() const;
 
   std::string name;
@@ -172,6 +267,7 @@ struct PythonArgs {
   inline c10::optional<int64_t> toInt64Optional(int i);
   inline c10::optional<bool> toBoolOptional(int i);
   inline c10::optional<double> toDoubleOptional(int i);
+  inline std::vector<double> doublelist(int i);
   inline c10::OptionalArray<double> doublelistOptional(int i);
   inline at::Layout layout(int i);
   inline at::Layout layoutWithDefault(int i, at::Layout default_layout);
@@ -234,12 +330,25 @@ struct FunctionParameter {
 };
 
 template<int N>
-inline PythonArgs PythonArgParser::parse(PyObject* self, PyObject* args, PyObject* kwargs, ParsedArgs<N>& dst) {
+inline void PythonArgParser::check_capacity() const {
   if (N < max_args) {
     throw ValueError("PythonArgParser: dst ParsedArgs buffer does not have enough capacity, expected %d (got %d)",
         (int)max_args, N);
   }
-  return raw_parse(self, args, kwargs, dst.args);
+}
+
+template<int N>
+inline PythonArgs PythonArgParser::parse(PyObject* self, PyObject* args, PyObject* kwargs, ParsedArgs<N>& dst) {
+  check_capacity<N>();
+  PythonCallArgs call_args(args, kwargs);
+  return raw_parse(self, call_args, dst.args);
+}
+
+template<int N>
+inline PythonArgs PythonArgParser::parse(PyObject* self, PyObject* const* args, Py_ssize_t nargs, PyObject* kwnames, ParsedArgs<N>& dst) {
+  check_capacity<N>();
+  PythonCallArgs call_args(args, nargs, kwnames, dst.varargs);
+  return raw_parse(self, call_args, dst.args);
 }
 
 template<int N>
@@ -368,10 +477,7 @@ inline c10::OptionalArray<int64_t> PythonArgs::intlistOptional(int i) {
   return intlist(i);
 }
 
-inline c10::OptionalArray<double> PythonArgs::doublelistOptional(int i) {
-  if (!args[i]) {
-    return {};
-  }
+inline std::vector<double> PythonArgs::doublelist(int i) {
   PyObject* arg = args[i];
   auto tuple = PyTuple_Check(arg);
   auto size = tuple ? PyTuple_GET_SIZE(arg) : PyList_GET_SIZE(arg);
@@ -389,6 +495,13 @@ inline c10::OptionalArray<double> PythonArgs::doublelistOptional(int i) {
   return res;
 }
 
+inline c10::OptionalArray<double> PythonArgs::doublelistOptional(int i) {
+  if (!args[i]) {
+    return {};
+  }
+  return doublelist(i);
+}
+
 inline at::ScalarType PythonArgs::scalartypeWithDefault(int i, at::ScalarType default_scalartype) {
   if (!args[i]) return default_scalartype;
   return scalartype(i);
@@ -712,6 +825,17 @@ static py::object PyTorch_LookupSpecial(PyObject *obj, char* name)
   return PyObject_FastGetAttrString((PyObject *)tp, name);
 }
 
+/*
+ * Checks if the type of obj has a __torch_function__ implementation, other
+ * than the disabled one
+ *
+ * The results are cached per type (see type_has_torch_function in
+ * python_arg_parser.cpp) since this is called for the arguments of every op
+ * that aren't exactly Tensors, e.g. Parameters.
+ *
+ */
+auto type_has_torch_function(PyObject* obj) -> bool;
+
 /*
  * Checks if obj has a __torch_function__ implementation
  *
@@ -720,14 +844,10 @@ static py::object PyTorch_LookupSpecial(PyObject *obj, char* name)
  */
 static auto check_has_torch_function(PyObject* obj) -> bool
 {
-  if (!torch_function_enabled()) {
+  if (!torch_function_enabled() || THPVariable_CheckExact(obj)) {
     return false;
   }
-  py::object method = PyTorch_LookupSpecial(obj, "__torch_function__");
-  if(method.ptr() != nullptr && method.ptr() != disabled_torch_function_impl()){
-    return true;
-  }
-  return false;
+  return type_has_torch_function(obj);
 }
 
 /*
@@ -776,6 +896,10 @@ auto handle_torch_function(PythonArgs &r, PyObject* self, PyObject* args, PyObje
 // Used fpr functions.
 auto handle_torch_function(PythonArgs &r, PyObject* args, PyObject* kwargs, PyObject* torch_api, const char* module_name) -> PyObject*;
 
+// Used for Tensor methods taking their arguments by vectorcall, see
+// PythonArgParser::parse.
+auto handle_torch_function(PythonArgs &r, PyObject* self, PyObject* const* args, Py_ssize_t nargs, PyObject* kwnames, PyObject* torch_api, const char* module_name) -> PyObject*;
+
 // Used for functions that accept no keyword arguments and have no argument parsing
 auto handle_torch_function(PyObject* self, const std::string& func_name, PyObject* args=nullptr, PyObject* torch_api=THPVariableClass, const std::string& module_name="torch.Tensor") -> PyObject*;
 
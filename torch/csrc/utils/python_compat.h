@@ -2,6 +2,15 @@
 
 #include <torch/csrc/python_headers.h>
 
+// The flags of the functions taking their arguments by vectorcall, i.e. as a C
+// array followed by the tuple of the names of the keyword arguments. Python
+// 3.6 had these under METH_FASTCALL alone.
+#if PY_VERSION_HEX >= 0x03070000
+#define THP_METH_FASTCALL_KEYWORDS (METH_FASTCALL | METH_KEYWORDS)
+#else
+#define THP_METH_FASTCALL_KEYWORDS METH_FASTCALL
+#endif
+
 // PyPy 3.6 does not yet have PySlice_Unpack
 #if PY_VERSION_HEX < 0x03060100 || defined(PYPY_VERSION)
 
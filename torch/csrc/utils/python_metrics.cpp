@@ -0,0 +1,174 @@
+#include <torch/csrc/utils/python_metrics.h>
+
+#include <ATen/OperatorMetrics.h>
+#include <c10/util/Metrics.h>
+#include <torch/csrc/utils/pybind.h>
+
+#include <chrono>
+#include <memory>
+
+namespace torch {
+namespace metrics {
+
+namespace {
+
+using c10::metrics::MetricType;
+using c10::metrics::MetricsRegistry;
+
+const char* typeName(MetricType type) {
+  switch (type) {
+    case MetricType::Counter:
+      return "counter";
+    case MetricType::Gauge:
+      return "gauge";
+    case MetricType::Histogram:
+      return "histogram";
+  }
+  return "untyped";
+}
+
+py::list toPython(const c10::metrics::MetricsSnapshot& snapshot) {
+  py::list samples;
+  for (const auto& sample : snapshot.samples) {
+    py::dict entry;
+    entry["name"] = sample.name;
+    entry["labels"] = sample.labels;
+    entry["help"] = sample.help;
+    entry["type"] = typeName(sample.type);
+    entry["value"] = sample.value;
+    if (sample.type == MetricType::Histogram) {
+      entry["buckets"] = sample.buckets;
+    }
+    samples.append(entry);
+  }
+  return samples;
+}
+
+} // namespace
+
+void initMetricsBindings(PyObject* module) {
+  auto m = py::handle(module).cast<py::module>();
+
+  py::class_<c10::metrics::MetricsSink, std::shared_ptr<c10::metrics::MetricsSink>>(
+      m, "_MetricsSink");
+
+  m.def("_metrics_enabled", &c10::metrics::enabled);
+  m.def("_set_metrics_enabled", &c10::metrics::setEnabled);
+  m.def("_operator_metrics_enabled", &at::operatorMetricsEnabled);
+  m.def("_set_operator_metrics_enabled", &at::enableOperatorMetrics);
+
+  m.def(
+      "_metrics_counter_add",
+      [](const std::string& name,
+         const std::string& help,
+         int64_t value,
+         const std::string& labels) {
+        if (c10::metrics::enabled()) {
+          MetricsRegistry::get().counter(name, help, labels).add(value);
+        }
+      },
+      py::arg("name"),
+      py::arg("help"),
+      py::arg("value") = 1,
+      py::arg("labels") = "");
+  m.def(
+      "_metrics_gauge_add",
+      [](const std::string& name,
+         const std::string& help,
+         int64_t value,
+         const std::string& labels) {
+        if (c10::metrics::enabled()) {
+          MetricsRegistry::get().gauge(name, help, labels).add(value);
+        }
+      },
+      py::arg("name"),
+      py::arg("help"),
+      py::arg("value"),
+      py::arg("labels") = "");
+  m.def(
+      "_metrics_histogram_record",
+      [](const std::string& name,
+         const std::string& help,
+         int64_t value,
+         const std::string& labels) {
+        if (c10::metrics::enabled()) {
+          MetricsRegistry::get().histogram(name, help, labels).record(value);
+        }
+      },
+      py::arg("name"),
+      py::arg("help"),
+      py::arg("value"),
+      py::arg("labels") = "");
+
+  m.def("_metrics_snapshot", []() {
+    c10::metrics::MetricsSnapshot snapshot;
+    {
+      pybind11::gil_scoped_release no_gil;
+      snapshot = MetricsRegistry::get().snapshot();
+    }
+    return toPython(snapshot);
+  });
+  m.def(
+      "_metrics_prometheus_text",
+      []() {
+        return c10::metrics::toPrometheusText(MetricsRegistry::get().snapshot());
+      },
+      py::call_guard<py::gil_scoped_release>());
+
+  m.def(
+      "_metrics_add_callback_sink",
+      [](py::object callback) {
+        // Called and destroyed from the reporting thread, without the GIL.
+        std::shared_ptr<py::object> function(
+            new py::object(std::move(callback)), [](py::object* function) {
+              pybind11::gil_scoped_acquire gil;
+              delete function;
+            });
+        std::shared_ptr<c10::metrics::MetricsSink> sink =
+            std::make_shared<c10::metrics::CallbackSink>(
+                [function](const c10::metrics::MetricsSnapshot& snapshot) {
+                  pybind11::gil_scoped_acquire gil;
+                  try {
+                    (*function)(toPython(snapshot));
+                  } catch (py::error_already_set& e) {
+                    // the error can't go to the reporting thread
+                    e.restore();
+                    PyErr_Print();
+                  }
+                });
+        MetricsRegistry::get().addSink(sink);
+        return sink;
+      });
+  m.def("_metrics_add_prometheus_file_sink", [](const std::string& path) {
+    std::shared_ptr<c10::metrics::MetricsSink> sink =
+        std::make_shared<c10::metrics::PrometheusTextFileSink>(path);
+    MetricsRegistry::get().addSink(sink);
+    return sink;
+  });
+  m.def(
+      "_metrics_remove_sink",
+      [](const std::shared_ptr<c10::metrics::MetricsSink>& sink) {
+        MetricsRegistry::get().removeSink(sink);
+      },
+      py::call_guard<py::gil_scoped_release>());
+
+  // The sinks may need the GIL, which the calling thread releases.
+  m.def(
+      "_metrics_report",
+      []() { MetricsRegistry::get().report(); },
+      py::call_guard<py::gil_scoped_release>());
+  m.def(
+      "_metrics_start_reporting",
+      [](double interval_s) {
+        MetricsRegistry::get().startReporting(std::chrono::milliseconds(
+            static_cast<int64_t>(interval_s * 1000)));
+      },
+      py::call_guard<py::gil_scoped_release>());
+  m.def(
+      "_metrics_stop_reporting",
+      []() { MetricsRegistry::get().stopReporting(); },
+      py::call_guard<py::gil_scoped_release>());
+}
+
+} // namespace metrics
+} // namespace torch
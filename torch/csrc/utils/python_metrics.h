@@ -0,0 +1,12 @@
+#pragma once
+
+#include <torch/csrc/python_headers.h>
+
+namespace torch {
+namespace metrics {
+
+// Binds the c10::metrics registry, see torch/utils/metrics.py.
+void initMetricsBindings(PyObject* module);
+
+} // namespace metrics
+} // namespace torch
@@ -7,7 +7,7 @@ namespace torch { namespace utils {
 PyObject* tensor_to_numpy(const at::Tensor& tensor) {
   throw std::runtime_error("PyTorch was compiled without NumPy support");
 }
-at::Tensor tensor_from_numpy(PyObject* obj) {
+at::Tensor tensor_from_numpy(PyObject* obj, bool* copied) {
   throw std::runtime_error("PyTorch was compiled without NumPy support");
 }
 bool is_numpy_int(PyObject* obj) {
@@ -98,6 +98,10 @@ PyObject* tensor_to_numpy(const at::Tensor& tensor) {
     stride *= element_size_in_bytes;
   }
 
+  int flags = NPY_ARRAY_ALIGNED;
+  if (!tensor.storage().unsafeGetStorageImpl()->read_only()) {
+    flags |= NPY_ARRAY_WRITEABLE;
+  }
   auto array = THPObjectPtr(PyArray_New(
       &PyArray_Type,
       tensor.dim(),
@@ -106,7 +110,7 @@ PyObject* tensor_to_numpy(const at::Tensor& tensor) {
       strides.data(),
       tensor.data_ptr(),
       0,
-      NPY_ARRAY_ALIGNED | NPY_ARRAY_WRITEABLE,
+      flags,
       nullptr));
   if (!array) return nullptr;
 
@@ -125,23 +129,12 @@ PyObject* tensor_to_numpy(const at::Tensor& tensor) {
   return array.release();
 }
 
-at::Tensor tensor_from_numpy(PyObject* obj) {
+at::Tensor tensor_from_numpy(PyObject* obj, bool* copied) {
   if (!PyArray_Check(obj)) {
     throw TypeError("expected np.ndarray (got %s)", Py_TYPE(obj)->tp_name);
   }
   auto array = (PyArrayObject*)obj;
 
-  if (!PyArray_ISWRITEABLE(array)) {
-    TORCH_WARN_ONCE(
-      "The given NumPy array is not writeable, and PyTorch does "
-      "not support non-writeable tensors. This means you can write to the "
-      "underlying (supposedly non-writeable) NumPy array using the tensor. "
-      "You may want to copy the array to protect its data or make it writeable "
-      "before converting it to a tensor. This type of warning will be "
-      "suppressed for the rest of this program.");
-
-  }
-
   int ndim = PyArray_NDIM(array);
   auto sizes = to_aten_shape(ndim, PyArray_DIMS(array));
   auto strides = to_aten_shape(ndim, PyArray_STRIDES(array));
@@ -156,27 +149,35 @@ at::Tensor tensor_from_numpy(PyObject* obj) {
     stride /= element_size_in_bytes;
   }
 
-  size_t storage_size = 1;
+  // Tensors can't have negative strides. When the caller accepts a copy, the
+  // array is viewed from its lowest address with these strides negated, and
+  // the dimensions they belong to are flipped back into a new tensor.
+  std::vector<int64_t> flipped_dims;
+  char* data_ptr = static_cast<char*>(PyArray_DATA(array));
   for (int i = 0; i < ndim; i++) {
     if (strides[i] < 0) {
-      throw ValueError(
-          "At least one stride in the given numpy array is negative, "
-          "and tensors with negative strides are not currently supported. "
-          "(You can probably work around this by making a copy of your array "
-          " with array.copy().) ");
+      if (!copied) {
+        throw ValueError(
+            "At least one stride in the given numpy array is negative, "
+            "and tensors with negative strides are not currently supported. "
+            "(You can probably work around this by making a copy of your array "
+            " with array.copy().) ");
+      }
+      if (sizes[i] > 0) {
+        data_ptr += (sizes[i] - 1) * strides[i] * element_size_in_bytes;
+      }
+      strides[i] = -strides[i];
+      flipped_dims.push_back(i);
     }
-    // XXX: this won't work for negative strides
-    storage_size += (sizes[i] - 1) * strides[i];
   }
 
-  void* data_ptr = PyArray_DATA(array);
   if (!PyArray_EquivByteorders(PyArray_DESCR(array)->byteorder, NPY_NATIVE)) {
     throw ValueError(
         "given numpy array has byte order different from the native byte order. "
         "Conversion between byte orders is currently not supported.");
   }
   Py_INCREF(obj);
-  return at::from_blob(
+  auto tensor = at::from_blob(
       data_ptr,
       sizes,
       strides,
@@ -186,6 +187,18 @@ at::Tensor tensor_from_numpy(PyObject* obj) {
       },
       at::device(kCPU).dtype(numpy_dtype_to_aten(PyArray_TYPE(array)))
   );
+  if (!PyArray_ISWRITEABLE(array)) {
+    // The tensor shares the memory of the array, so the autograd wrappers of
+    // the in-place and out= ops refuse to modify it.
+    tensor.storage().unsafeGetStorageImpl()->set_read_only(true);
+  }
+  if (copied) {
+    *copied = !flipped_dims.empty();
+    if (*copied) {
+      return tensor.flip(flipped_dims);
+    }
+  }
+  return tensor;
 }
 
 int aten_to_numpy_dtype(const ScalarType scalar_type) {
@@ -6,7 +6,9 @@
 namespace torch { namespace utils {
 
 PyObject* tensor_to_numpy(const at::Tensor& tensor);
-at::Tensor tensor_from_numpy(PyObject* obj);
+// When `copied` is given, arrays with negative strides are accepted and copied
+// into a new tensor, which *copied tells; otherwise they throw.
+at::Tensor tensor_from_numpy(PyObject* obj, bool* copied = nullptr);
 
 int aten_to_numpy_dtype(const at::ScalarType scalar_type);
 at::ScalarType numpy_dtype_to_aten(int dtype);
@@ -18,6 +18,7 @@ from typing import List, Optional, Tuple, Union
 from torch._six import raise_from
 from ._utils import _get_device_index, _dummy_type
 from .streams import Stream, Event
+from .graphs import CUDAGraph, graph_pool_handle
 from .. import device as _device
 import torch._C
 
@@ -428,6 +429,57 @@ def current_blas_handle():
     return torch._C._cuda_getCurrentBlasHandle()
 
 
+def copy_to_host_async(tensors):
+    r"""Copies CUDA tensors to pinned host memory, asynchronously on the
+    current stream of their device, and returns a
+    :class:`~torch.futures.Future` of their copies.
+
+    Neither the caller nor the stream waits for the copies: the future is
+    completed once the stream did them, and its callbacks run on a thread of
+    PyTorch, so that a callback may e.g. hand the copies to a queue.
+
+    Arguments:
+        tensors (Tensor or list of Tensor): the tensors to copy, all of them
+            on the same device.
+    """
+    _lazy_init()  # will define _copy_to_host_async
+    if isinstance(tensors, torch.Tensor):
+        return _copy_to_host_async(tensors)
+    return _copy_to_host_async(list(tensors))
+
+
+def to_coalesced(tensors, device, non_blocking=False, views=False):
+    r"""Copies tensors from the host to a CUDA device, or the other way round,
+    all at once.
+
+    The tensors are packed into a single buffer, copied in one transfer and
+    unpacked by a single kernel on the device, which is much faster than
+    copying many small tensors one by one, e.g., those of a batch. Tensors
+    larger than a MiB are copied on their own.
+
+    Arguments:
+        tensors (iterable of Tensor): the tensors to copy, all of them on the
+            host or all of them on the same CUDA device. They may have
+            different dtypes.
+        device (torch.device, str or int): the CUDA device to copy the tensors
+            to, or ``'cpu'`` to copy them to the host.
+        non_blocking (bool, optional): if ``True``, the copies are
+            asynchronous wrt the host, like those of :meth:`~Tensor.to`. The
+            copies to the host into separate tensors still wait for the
+            current stream.
+        views (bool, optional): if ``True``, the copies are views of the
+            buffer they were copied into instead of separate tensors, which
+            saves the unpacking. The buffer is freed once all of them are.
+
+    Returns:
+        A list of the copies of the tensors, in the order of :attr:`tensors`.
+    """
+    _lazy_init()  # will define _to_coalesced
+    if isinstance(device, int):
+        device = _device('cuda', device)
+    return _to_coalesced(list(tensors), str(_device(device)), non_blocking, views)
+
+
 from .memory import *
 
 
@@ -106,15 +106,25 @@ class autocast(object):
     :class:`torch.nn.parallel.DistributedDataParallel` when used with more than one GPU per process
     (see :ref:`Working with Multiple GPUs<amp-multigpu>`).
 
+    Within a region, the fp16 casts of the model's weights are cached and reused by the ops that share them.
+    By default the cache is dropped when the (outermost) region exits.  ``persistent_cache=True`` keeps the
+    casts for the next region instead, e.g. the next forward pass, which reuses the casts of the weights
+    that weren't modified in place since:  a weight updated by ``optimizer.step()`` is recast, a frozen
+    one (or every one, in inference) isn't.  The casts then occupy memory between regions;
+    ``torch.clear_autocast_cache()`` drops them.
+
     Arguments:
         enabled(bool, optional, default=True):  Whether autocasting should be enabled in the region.
+        persistent_cache(bool, optional, default=False):  Whether to keep the cached casts of the weights
+            when the region exits.
     """
-    def __init__(self, enabled=True):
+    def __init__(self, enabled=True, persistent_cache=False):
         if enabled and not torch.cuda.is_available():
             warnings.warn("torch.cuda.amp.autocast only affects CUDA ops, but CUDA is not available.  Disabling.")
             self._enabled = False
         else:
             self._enabled = enabled
+        self._persistent_cache = persistent_cache
 
     def __enter__(self):
         self.prev = torch.is_autocast_enabled()
@@ -123,7 +133,7 @@ class autocast(object):
 
     def __exit__(self, *args):
         # Drop the cache when we exit to a nesting level that's outside any instance of autocast.
-        if torch.autocast_decrement_nesting() == 0:
+        if torch.autocast_decrement_nesting() == 0 and not self._persistent_cache:
             torch.clear_autocast_cache()
         torch.set_autocast_enabled(self.prev)
         return False
@@ -0,0 +1,84 @@
+import torch
+
+from ._utils import _dummy_type
+
+
+if not hasattr(torch._C, '_CudaGraphBase'):
+    # Define dummy base classes
+    torch._C.__dict__['_CudaGraphBase'] = _dummy_type('_CudaGraphBase')
+    torch._C.__dict__['_graph_pool_handle'] = _dummy_type('_graph_pool_handle')
+
+
+def graph_pool_handle():
+    r"""Returns an opaque token representing the id of a graph memory pool.
+
+    Passing the same token to :meth:`CUDAGraph.capture_begin` of several
+    graphs makes them share one memory pool.
+
+    .. warning::
+        This API is in beta and may change in future releases.
+    """
+    return torch._C._graph_pool_handle()
+
+
+class CUDAGraph(torch._C._CudaGraphBase):
+    r"""Wrapper around a CUDA graph.
+
+    The work issued to the current stream between :meth:`capture_begin` and
+    :meth:`capture_end` is recorded instead of run, and :meth:`replay` runs
+    all of it again with a single launch, reading and writing the same
+    memory as during capture. Inputs of a replay are set by copying into the
+    tensors used during capture::
+
+        g = torch.cuda.CUDAGraph()
+        s = torch.cuda.Stream()
+        static_input = torch.zeros(8, device='cuda')
+        with torch.cuda.stream(s):
+            g.capture_begin()
+            static_output = torch.nn.functional.dropout(static_input * 2, 0.5)
+            g.capture_end()
+        static_input.copy_(new_input)
+        g.replay()  # static_output now holds the result for new_input
+
+    Captures must be made on a stream other than the default stream. The
+    memory allocated during capture comes from a private pool of the caching
+    allocator and stays reserved for the replays until the graph is reset or
+    deleted. Dropout and other ops built on the graph-safe RNG draw fresh
+    random numbers from the default generator on each replay; other random
+    ops raise an error during capture.
+
+    Requires CUDA 11.
+
+    .. warning::
+        This API is in beta and may change in future releases.
+    """
+    def capture_begin(self, pool=None):
+        r"""Begins capturing the work of the current stream.
+
+        Arguments:
+            pool (optional): token returned by :func:`graph_pool_handle` or
+                :meth:`CUDAGraph.pool` of another graph, to share its memory
+                pool. By default the graph gets a pool of its own.
+        """
+        if pool is None:
+            super(CUDAGraph, self).capture_begin()
+        else:
+            super(CUDAGraph, self).capture_begin(pool)
+
+    def capture_end(self):
+        r"""Ends the capture and instantiates the graph."""
+        super(CUDAGraph, self).capture_end()
+
+    def replay(self):
+        r"""Replays the captured work on the current stream."""
+        super(CUDAGraph, self).replay()
+
+    def reset(self):
+        r"""Deletes the graph. Its memory pool can be reused once all of its
+        tensors are freed."""
+        super(CUDAGraph, self).reset()
+
+    def pool(self):
+        r"""Returns a token for the memory pool of this graph, which other
+        captures can share by passing it to :meth:`capture_begin`."""
+        return super(CUDAGraph, self).pool()
@@ -87,6 +87,30 @@ def empty_cache() -> None:
         torch._C._cuda_emptyCache()
 
 
+def set_per_process_memory_fraction(fraction: float, device: Union[Device, int] = None) -> None:
+    r"""Caps the memory the caching allocator may reserve on a CUDA device.
+
+    The cap is :attr:`fraction` times the total memory of the device. An
+    allocation that would push the reserved memory over the cap first releases
+    the least recently used cached blocks, and raises an out-of-memory error
+    if that is not enough, just as if the device had run out of memory.
+
+    Arguments:
+        fraction (float): fraction of the device memory, in the range [0, 1].
+        device (torch.device or int, optional): selected device. Sets the cap
+            for the current device, given by :func:`~torch.cuda.current_device`,
+            if :attr:`device` is ``None`` (default).
+
+    .. note::
+        See :ref:`cuda-memory-management` for more details about GPU memory
+        management.
+    """
+    device = _get_device_index(device, optional=True)
+    if not isinstance(fraction, float):
+        raise TypeError('Invalid type for fraction argument, must be `float`')
+    torch._C._cuda_setMemoryFraction(fraction, device)
+
+
 def memory_stats(device: Union[Device, int] = None) -> Dict[str, Any]:
     r"""Returns a dictionary of CUDA memory allocator statistics for a
     given device.
@@ -146,6 +170,10 @@ def memory_stats(device: Union[Device, int] = None) -> Dict[str, Any]:
         See :ref:`cuda-memory-management` for more details about GPU memory
         management.
     """
+    return _flatten_stats(memory_stats_as_nested_dict(device=device))
+
+
+def _flatten_stats(stats: Dict[str, Any]) -> Dict[str, Any]:
     result = []
 
     def _recurse_add_to_result(prefix, obj):
@@ -157,7 +185,6 @@ def memory_stats(device: Union[Device, int] = None) -> Dict[str, Any]:
         else:
             result.append((prefix, obj))
 
-    stats = memory_stats_as_nested_dict(device=device)
     _recurse_add_to_result("", stats)
     result.sort()
 
@@ -170,6 +197,28 @@ def memory_stats_as_nested_dict(device: Union[Device, int] = None) -> Dict[str,
     return torch._C._cuda_memoryStats(device)
 
 
+def host_memory_stats() -> Dict[str, Any]:
+    r"""Returns a dictionary of statistics of the caching allocator for pinned
+    (page-locked) host memory, which is used by :meth:`~torch.Tensor.pin_memory`.
+
+    The keys are the same as those of :func:`~torch.cuda.memory_stats`;
+    ``"segment"`` and ``"reserved_bytes"`` count pinned memory, small pool
+    requests are those of at most 1MB.
+
+    .. note::
+        See :ref:`cuda-memory-management` for more details about GPU memory
+        management.
+    """
+    return _flatten_stats(torch._C._cuda_hostMemoryStats())
+
+
+def reset_host_memory_stats() -> None:
+    r"""Resets the "peak" and "accumulated" stats of the pinned host memory
+    allocator. See :func:`~torch.cuda.host_memory_stats` for details.
+    """
+    torch._C._cuda_resetHostMemoryStats()
+
+
 def reset_accumulated_memory_stats(device: Union[Device, int] = None) -> None:
     r"""Resets the "accumulated" (historical) stats tracked by the CUDA memory allocator.
 
@@ -368,6 +417,53 @@ def memory_snapshot():
     return torch._C._cuda_memorySnapshot()
 
 
+def record_memory_history(enabled: bool = True, context: str = "python",
+                          max_entries: int = 100000) -> None:
+    r"""Enables or disables recording of CUDA caching allocator events.
+
+    While enabled, every allocation, free, block split/merge, segment
+    allocation/release and out-of-memory event is appended to a per-device
+    ring buffer holding at most :attr:`max_entries` events. The history can be
+    exported with :func:`~torch.cuda.memory_history`.
+
+    Arguments:
+        enabled (bool, optional): whether to record events (default: True).
+            Enabling the recorder clears any previously recorded history.
+        context (str, optional): stack captured with each event. One of
+            ``None``, ``"python"``, ``"cpp"`` or ``"all"``
+            (default: ``"python"``). Capturing stacks makes allocations
+            noticeably slower.
+        max_entries (int, optional): number of events kept per device
+            (default: 100000).
+
+    .. note::
+        See :ref:`cuda-memory-management` for more details about GPU memory
+        management.
+    """
+    torch._C._cuda_recordMemoryHistory(enabled, context, max_entries)
+
+
+def memory_history(path: str = None) -> str:
+    r"""Returns the recorded CUDA caching allocator history as a Chrome trace.
+
+    The result is a JSON document in the Trace Event Format that can be
+    loaded in ``chrome://tracing`` or Perfetto. Each device is shown as a
+    process and each stream as a thread; allocated and reserved memory are
+    plotted as counters.
+
+    Arguments:
+        path (str, optional): if given, the trace is also written to this file.
+
+    .. note::
+        See :func:`~torch.cuda.record_memory_history` to enable recording.
+    """
+    trace = torch._C._cuda_memoryHistoryJson()
+    if path is not None:
+        with open(path, "w") as f:
+            f.write(trace)
+    return trace
+
+
 def memory_summary(device: Union[Device, int] = None, abbreviated: bool = False) -> str:
     r"""Returns a human-readable printout of the current memory allocator
     statistics for a given device.
@@ -0,0 +1,13 @@
+"""
+Distributed checkpoints: every rank of a process group writes the tensors
+and shards of tensors it holds to a file of its own, in parallel and
+optionally in the background, and the checkpoint can be loaded back by any
+number of ranks sharding the tensors in any way.
+"""
+
+from .checkpoint import (  # noqa: F401
+    CheckpointFuture,
+    Shard,
+    load_state_dict,
+    save_state_dict,
+)
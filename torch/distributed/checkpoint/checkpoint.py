@@ -0,0 +1,340 @@
+import os
+import pickle
+import threading
+
+import torch
+import torch.distributed as dist
+
+
+# Every rank writes its tensors as the records of one archive in the
+# checkpoint directory, and rank 0 writes the index of all records, which
+# marks the checkpoint complete, once every rank has published its part of
+# the index through the store of the process group.
+_METADATA_FILE = ".metadata"
+_SHARDS_FILE = "rank_{}.shards"
+
+# The number of checkpoints saved by this process, which prefixes the store
+# keys of each checkpoint. Every rank saves the same checkpoints in the same
+# order, so the prefixes agree across ranks.
+_save_count = 0
+
+
+class Shard(object):
+    r"""
+    The part ``tensor`` of a tensor of size ``size``, sharded across ranks,
+    that starts at ``offsets``. For instance, a rank holding the rows
+    ``[rank * n, (rank + 1) * n)`` of a ``(world_size * n, m)`` parameter,
+    or the flat slice of the parameters a ZeRO-style optimizer keeps the
+    state of, describes its part with a ``Shard``.
+
+    Arguments:
+        tensor (Tensor): The local part of the tensor.
+        offsets (list of int): The index of the first element of ``tensor``
+            in every dimension of the whole tensor.
+        size (torch.Size or list of int): The size of the whole tensor.
+    """
+
+    def __init__(self, tensor, offsets, size):
+        offsets = list(offsets)
+        size = list(size)
+        if not (len(offsets) == len(size) == tensor.dim()):
+            raise ValueError(
+                "a shard of a {}-d tensor needs {} offsets, got {} for a {}-d "
+                "tensor".format(len(size), len(size), len(offsets), tensor.dim()))
+        for offset, length, total in zip(offsets, tensor.size(), size):
+            if offset < 0 or offset + length > total:
+                raise ValueError(
+                    "a shard of size {} at offsets {} does not fit in a tensor "
+                    "of size {}".format(list(tensor.size()), offsets, size))
+        self.tensor = tensor
+        self.offsets = offsets
+        self.size = size
+
+
+class CheckpointFuture(object):
+    r"""
+    The handle of a checkpoint saved by :func:`save_state_dict` with
+    ``async_save=True``.
+    """
+
+    def __init__(self, thread, commit):
+        self._thread = thread
+        self._commit = commit
+        self._done = False
+
+    def wait(self):
+        r"""
+        Blocks until this rank has written its shards and rank 0 has written
+        the index of the checkpoint, and raises any error of any rank. All the
+        ranks of the group must call it, as the ranks exchange their indices
+        here rather than from the writer threads, which would otherwise share
+        the store with the training loop.
+        """
+        if not self._done:
+            self._done = True
+            if self._thread is not None:
+                self._thread.join()
+            self._commit()
+
+
+def _snapshot(tensor, copy):
+    # A contiguous host copy of the tensor, unless copy is False and the
+    # tensor is already one.
+    tensor = tensor.detach()
+    if tensor.device.type != "cpu":
+        host = torch.empty(tensor.size(), dtype=tensor.dtype, pin_memory=True)
+        host.copy_(tensor, non_blocking=True)
+        return host
+    if copy or not tensor.is_contiguous():
+        return tensor.clone(memory_format=torch.contiguous_format)
+    return tensor
+
+
+def _assign_writers(tensors, world_size):
+    # Every rank holds the same replicated tensors, so all ranks pick the same
+    # writer for each of them: the least loaded rank so far, which balances
+    # the bytes the ranks write.
+    writers = {}
+    load = [0] * world_size
+    by_size = sorted(tensors.items(),
+                     key=lambda item: (-item[1].numel() * item[1].element_size(), item[0]))
+    for key, tensor in by_size:
+        writer = min(range(world_size), key=lambda rank: (load[rank], rank))
+        writers[key] = writer
+        load[writer] += tensor.numel() * tensor.element_size()
+    return writers
+
+
+def _write_shards(file_name, records):
+    writer = torch._C.PyTorchFileWriter(file_name)
+    for name, tensor in records:
+        writer.write_record(name, tensor.data_ptr(), tensor.numel() * tensor.element_size())
+    writer.write_end_of_file()
+
+
+def save_state_dict(state_dict, path, process_group=None, async_save=False):
+    r"""
+    Saves a state dict held by all the ranks of ``process_group`` to the
+    directory ``path``, which all ranks must be able to reach, e.g. on a
+    shared file system, without gathering it on one rank. Every rank writes
+    its own file in parallel with the others:
+
+    * a :class:`Shard` value is written by the rank that holds it;
+    * a tensor value is taken to be replicated on all ranks, like the
+      parameters of a :class:`~torch.nn.parallel.DistributedDataParallel`
+      module, and is written by one rank, chosen so that every rank writes
+      about the same number of bytes;
+    * any other value is pickled into the index by rank 0.
+
+    All ranks must call this function with the same keys, sizes and order of
+    checkpoints. The checkpoint is complete once ``path`` holds the index
+    file, which rank 0 writes last, so ``path`` should not hold an older
+    checkpoint.
+
+    With ``async_save=True``, the tensors are copied to host memory, which
+    is the only part that stalls training, and written by a background
+    thread, and the function returns a :class:`CheckpointFuture` that all
+    ranks must wait on before the next checkpoint.
+
+    Arguments:
+        state_dict (dict): The local state of this rank.
+        path (str): The checkpoint directory, created if it does not exist.
+        process_group (ProcessGroup, optional): The group of ranks saving the
+            checkpoint, by default the default process group.
+        async_save (bool, optional): Whether to write the checkpoint in the
+            background (default: ``False``).
+
+    Returns:
+        A :class:`CheckpointFuture` if ``async_save`` is ``True``, else
+        ``None``.
+
+    Example::
+
+        >>> state = dict(ddp_model.state_dict(), step=step)
+        >>> future = save_state_dict(state, "/ckpt/step_1000", async_save=True)
+        >>> ...  # keep training
+        >>> future.wait()
+    """
+    global _save_count
+    process_group = process_group if process_group is not None \
+        else dist.distributed_c10d._get_default_group()
+    store = dist.distributed_c10d._pg_map[process_group][1]
+    if store is None:
+        raise RuntimeError("save_state_dict needs a process group with a store")
+    rank = process_group.rank()
+    world_size = process_group.size()
+    prefix = "checkpoint/{}/".format(_save_count)
+    _save_count += 1
+
+    replicated = {key: value for key, value in state_dict.items()
+                  if isinstance(value, torch.Tensor)}
+    writers = _assign_writers(replicated, world_size)
+
+    # Snapshot the tensors of this rank before returning, so that training
+    # may change them while they are written.
+    file_name = _SHARDS_FILE.format(rank)
+    records = []
+    devices = set()
+    index = {"tensors": {}, "objects": {}}
+    for key, value in state_dict.items():
+        if isinstance(value, Shard):
+            tensor, offsets, size = value.tensor, value.offsets, value.size
+        elif isinstance(value, torch.Tensor):
+            if writers[key] != rank:
+                continue
+            tensor, offsets, size = value, [0] * value.dim(), list(value.size())
+        else:
+            if rank == 0:
+                index["objects"][key] = value
+            continue
+        record = str(len(records))
+        records.append((record, _snapshot(tensor, copy=async_save)))
+        if tensor.device.type == "cuda":
+            devices.add(tensor.device)
+        index["tensors"][key] = {
+            "size": size,
+            "dtype": tensor.dtype,
+            "shards": [{
+                "file": file_name,
+                "record": record,
+                "offsets": offsets,
+                "sizes": list(tensor.size()),
+            }],
+        }
+    # Wait for the copies to the pinned host memory.
+    for device in devices:
+        torch.cuda.synchronize(device)
+
+    if not os.path.isdir(path):
+        os.makedirs(path, exist_ok=True)
+    errors = []
+
+    def write():
+        try:
+            _write_shards(os.path.join(path, file_name), records)
+        except Exception as e:
+            errors.append(e)
+
+    def commit():
+        store.set(prefix + str(rank), pickle.dumps(
+            {"error": repr(errors[0])} if errors else index))
+        if rank == 0:
+            _commit_index(store, prefix, path, world_size)
+        result = pickle.loads(store.get(prefix + "done"))
+        if errors:
+            raise errors[0]
+        if result is not None:
+            raise RuntimeError("failed to save the checkpoint to {}: {}".format(path, result))
+
+    if async_save:
+        thread = threading.Thread(target=write, name="checkpoint_writer", daemon=True)
+        thread.start()
+        return CheckpointFuture(thread, commit)
+    write()
+    commit()
+    return None
+
+
+def _commit_index(store, prefix, path, world_size):
+    error = None
+    metadata = {"tensors": {}, "objects": {}}
+    for rank in range(world_size):
+        index = pickle.loads(store.get(prefix + str(rank)))
+        if "error" in index:
+            error = error or "rank {}: {}".format(rank, index["error"])
+            continue
+        metadata["objects"].update(index["objects"])
+        for key, entry in index["tensors"].items():
+            if key not in metadata["tensors"]:
+                metadata["tensors"][key] = {
+                    "size": entry["size"], "dtype": entry["dtype"], "shards": []}
+            merged = metadata["tensors"][key]
+            if merged["size"] != entry["size"] or merged["dtype"] != entry["dtype"]:
+                error = error or "the shards of {} disagree on its size or dtype".format(key)
+            merged["shards"].extend(entry["shards"])
+    if error is None:
+        try:
+            # Write the index under a temporary name first, so that a
+            # complete checkpoint always has a complete index.
+            tmp_name = os.path.join(path, _METADATA_FILE + ".tmp")
+            torch.save(metadata, tmp_name)
+            os.replace(tmp_name, os.path.join(path, _METADATA_FILE))
+        except Exception as e:
+            error = repr(e)
+    store.set(prefix + "done", pickle.dumps(error))
+
+
+def _regions_overlap(offsets_a, sizes_a, offsets_b, sizes_b):
+    lows = [max(a, b) for a, b in zip(offsets_a, offsets_b)]
+    highs = [min(a + m, b + n) for a, m, b, n in zip(offsets_a, sizes_a, offsets_b, sizes_b)]
+    if any(low >= high for low, high in zip(lows, highs)):
+        return None
+    return lows, highs
+
+
+def load_state_dict(state_dict, path):
+    r"""
+    Loads a checkpoint saved by :func:`save_state_dict` into ``state_dict``
+    in place. The tensors and :class:`Shard` values of ``state_dict`` are
+    filled with the elements they cover, read from whichever files hold
+    them, so the checkpoint may be loaded by any number of ranks sharding the
+    tensors differently than those that saved it. Other values are replaced
+    by the saved ones. No communication happens between the ranks.
+
+    Arguments:
+        state_dict (dict): The state to load, with the keys, and tensors or
+            shards of the sizes and dtypes, to read from the checkpoint.
+        path (str): The checkpoint directory.
+
+    Example::
+
+        >>> # Saved by 4 ranks with 4 rows each, loaded by 2 with 8 rows each.
+        >>> shard = Shard(torch.empty(8, 16), [rank * 8, 0], [16, 16])
+        >>> load_state_dict({"weight": shard}, "/ckpt/step_1000")
+    """
+    metadata_file = os.path.join(path, _METADATA_FILE)
+    if not os.path.exists(metadata_file):
+        raise RuntimeError("{} does not hold a complete checkpoint".format(path))
+    metadata = torch.load(metadata_file)
+    readers = {}
+    for key, value in state_dict.items():
+        if not isinstance(value, (Shard, torch.Tensor)):
+            if key not in metadata["objects"]:
+                raise KeyError("{} is not in the checkpoint".format(key))
+            state_dict[key] = metadata["objects"][key]
+            continue
+        if key not in metadata["tensors"]:
+            raise KeyError("{} is not in the checkpoint".format(key))
+        entry = metadata["tensors"][key]
+        if isinstance(value, Shard):
+            target, offsets, size = value.tensor, value.offsets, value.size
+        else:
+            target, offsets, size = value, [0] * value.dim(), list(value.size())
+        if list(size) != entry["size"]:
+            raise ValueError("{} has size {} in the checkpoint, but {} was requested".format(
+                key, entry["size"], list(size)))
+
+        covered = 0
+        for shard in entry["shards"]:
+            overlap = _regions_overlap(
+                shard["offsets"], shard["sizes"], offsets, list(target.size()))
+            if overlap is None:
+                continue
+            if shard["file"] not in readers:
+                readers[shard["file"]] = torch._C.PyTorchFileReader(
+                    os.path.join(path, shard["file"]))
+            numel = 1
+            for length in shard["sizes"]:
+                numel *= length
+            saved = readers[shard["file"]].get_storage_from_record(
+                shard["record"], numel, entry["dtype"]).view(shard["sizes"])
+            src, dst = saved, target
+            for dim, (low, high) in enumerate(zip(*overlap)):
+                src = src.narrow(dim, low - shard["offsets"][dim], high - low)
+                dst = dst.narrow(dim, low - offsets[dim], high - low)
+            with torch.no_grad():
+                dst.copy_(src)
+            covered += dst.numel()
+        if covered != target.numel():
+            raise RuntimeError("the checkpoint holds {} of the {} elements requested for {}".format(
+                covered, target.numel(), key))
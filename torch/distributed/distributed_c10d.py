@@ -1,3 +1,4 @@
+import contextlib
 import pickle
 import torch
 import warnings
@@ -330,7 +331,8 @@ def init_process_group(backend,
                        world_size=-1,
                        rank=-1,
                        store=None,
-                       group_name=''):
+                       group_name='',
+                       pg_options=None):
     """
     Initializes the default distributed process group, and this will also
     initialize the distributed package.
@@ -368,8 +370,18 @@ def init_process_group(backend,
             the process group. Default value equals 30 minutes.
             This is applicable for the ``gloo`` backend. For ``nccl``, this is
             applicable only if the environment variable ``NCCL_BLOCKING_WAIT``
-            is set to 1.
+            or ``NCCL_ASYNC_ERROR_HANDLING`` is set to 1. With either, a
+            collective that times out makes its process ask the others for
+            the last collective they called, through the store, and log the
+            ranks that lag behind before aborting the communicators. With
+            ``NCCL_ASYNC_ERROR_HANDLING``, the process is then torn down,
+            without waiting for it to call ``wait()``, so that an elastic
+            launcher can restart the job.
         group_name (str, optional, deprecated): Group name.
+        pg_options (ProcessGroupNCCL.Options, optional): Options of the
+            ``nccl`` process group, e.g., to run its kernels on high priority
+            streams. Its ``timeout`` is overridden by the ``timeout``
+            argument. Only supported by the ``nccl`` backend.
 
     To enable ``backend == Backend.MPI``, PyTorch needs to be built from source
     on a system that supports MPI.
@@ -413,7 +425,8 @@ def init_process_group(backend,
             Backend.MPI,
             None,
             group_name=group_name,
-            timeout=timeout)
+            timeout=timeout,
+            pg_options=pg_options)
     else:
         # backward compatible API
         if store is None:
@@ -430,7 +443,8 @@ def init_process_group(backend,
             backend,
             store,
             group_name=group_name,
-            timeout=timeout)
+            timeout=timeout,
+            pg_options=pg_options)
 
     _pg_group_ranks[_default_pg] = {i: i for i in range(_default_pg.size())}
     _backend = _pg_map[_default_pg][0]
@@ -443,7 +457,8 @@ def _new_process_group_helper(world_size,
                               backend,
                               store,
                               group_name=None,
-                              timeout=default_pg_timeout):
+                              timeout=default_pg_timeout,
+                              pg_options=None):
     """
     Create a new distributed process group.
 
@@ -473,6 +488,8 @@ def _new_process_group_helper(world_size,
     is_default_group = (len(group_ranks) == 0)
 
     backend = Backend(backend)
+    if pg_options is not None and backend != Backend.NCCL:
+        raise RuntimeError("pg_options are only supported by the NCCL backend")
     if backend == Backend.MPI:
         if not is_mpi_available():
             raise RuntimeError(
@@ -508,11 +525,19 @@ def _new_process_group_helper(world_size,
             if not is_nccl_available():
                 raise RuntimeError("Distributed package doesn't have NCCL "
                                    "built in")
-            pg = ProcessGroupNCCL(
-                prefix_store,
-                rank,
-                world_size,
-                timeout)
+            if pg_options is not None:
+                pg_options.timeout = timeout
+                pg = ProcessGroupNCCL(
+                    prefix_store,
+                    rank,
+                    world_size,
+                    pg_options)
+            else:
+                pg = ProcessGroupNCCL(
+                    prefix_store,
+                    rank,
+                    world_size,
+                    timeout)
             _pg_map[pg] = (Backend.NCCL, store)
             _pg_names[pg] = group_name
         else:
@@ -1884,7 +1909,67 @@ def barrier(group=group.WORLD,
         work.wait()
 
 
-def new_group(ranks=None, timeout=default_pg_timeout, backend=None):
+class _CoalescedWork(object):
+    """
+    The handle :func:`coalesce_collectives` yields, tracking the collectives
+    of its block once it exited.
+    """
+    def __init__(self):
+        self.work = None
+
+    def is_completed(self):
+        return self.work is None or self.work.is_completed()
+
+    def wait(self):
+        if self.work is not None:
+            self.work.wait()
+
+
+@contextlib.contextmanager
+def coalesce_collectives(group=group.WORLD):
+    """
+    Context manager under which the collectives called on ``group`` from the
+    current thread are launched together as a single NCCL group when the block
+    exits, instead of one at a time. This saves the launch overhead of issuing
+    many small collectives. It yields a handle whose ``wait()`` waits for all
+    of them.
+
+    Only the ``NCCL`` backend supports it. The collectives of the block must
+    be called with ``async_op=True``, as their work handles can only be waited
+    for once the block exited, and must all operate on the same devices.
+    :func:`all_gather` can't be coalesced.
+
+    Arguments:
+        group (ProcessGroup, optional): The process group to work on
+
+    Example::
+        >>> with dist.coalesce_collectives() as coalesced:
+        >>>     for tensor in tensors:
+        >>>         dist.all_reduce(tensor, async_op=True)
+        >>>     dist.broadcast(other, src=0, async_op=True)
+        >>> coalesced.wait()
+    """
+    coalesced = _CoalescedWork()
+    if _rank_not_in_group(group):
+        yield coalesced
+        return
+
+    if group == GroupMember.WORLD:
+        _check_default_pg()
+        pg = _default_pg
+    else:
+        pg = group
+    if not hasattr(pg, "_start_coalescing"):
+        raise RuntimeError("coalesce_collectives is only supported with the NCCL backend")
+
+    pg._start_coalescing()
+    try:
+        yield coalesced
+    finally:
+        coalesced.work = pg._end_coalescing()
+
+
+def new_group(ranks=None, timeout=default_pg_timeout, backend=None, pg_options=None):
     """
     Creates a new distributed group.
 
@@ -1904,6 +1989,11 @@ def new_group(ranks=None, timeout=default_pg_timeout, backend=None):
             should be given as a lowercase string (e.g., ``"gloo"``), which can
             also be accessed via :class:`Backend` attributes (e.g.,
             ``Backend.GLOO``).
+        pg_options (ProcessGroupNCCL.Options, optional): Options of the
+            ``nccl`` process group, e.g., to give the group of the latency
+            critical collectives of pipeline parallelism high priority
+            streams. Its ``timeout`` is overridden by the ``timeout``
+            argument. Only supported by the ``nccl`` backend.
 
     Returns:
         A handle of distributed group that can be given to collective calls.
@@ -1950,7 +2040,8 @@ def new_group(ranks=None, timeout=default_pg_timeout, backend=None):
                                    ranks,
                                    backend,
                                    default_store,
-                                   timeout=timeout)
+                                   timeout=timeout,
+                                   pg_options=pg_options)
 
     # Create the global rank to group rank mapping
     _pg_group_ranks[pg] = {
@@ -0,0 +1,9 @@
+"""
+Pipeline parallelism over the point-to-point operations of the process
+groups: each rank of a group runs one stage of a model split into
+consecutive stages, and the micro-batches of a batch flow through the
+stages, the activations forward and the gradients backward, in the order of
+a GPipe or 1F1B schedule.
+"""
+
+from .pipe import Pipe, partition, schedule, GPIPE, ONE_F_ONE_B  # noqa: F401
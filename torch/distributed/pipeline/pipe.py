@@ -0,0 +1,398 @@
+from collections import namedtuple, OrderedDict
+import time
+
+import torch
+import torch.distributed as dist
+from torch import nn
+
+
+GPIPE = "gpipe"
+ONE_F_ONE_B = "1f1b"
+
+# The activations travel forward and the gradients backward on tags of their
+# own, which ProcessGroupNCCL runs on separate communicators and streams, so
+# that a stage sending a gradient never waits behind an activation.
+_ACTIVATION_TAG = 0
+_GRADIENT_TAG = 1
+
+# Ahead of every activation goes a metadata tensor of the index of its dtype
+# in _DTYPES, its number of dimensions and its sizes, padded to _MAX_DIMS.
+_MAX_DIMS = 8
+_DTYPES = [
+    torch.float32, torch.float64, torch.float16, torch.bfloat16, torch.uint8,
+    torch.int8, torch.int16, torch.int32, torch.int64, torch.bool,
+]
+
+Step = namedtuple("Step", ["kind", "micro_batch"])
+Step.__doc__ = """\
+A step of a pipeline schedule: the ``"forward"`` or ``"backward"`` pass of
+the stage over the micro-batch of index ``micro_batch``.
+"""
+
+
+def partition(module, balance):
+    r"""
+    Splits a :class:`~torch.nn.Sequential` into ``len(balance)`` consecutive
+    stages, the ``i``-th of which holds the next ``balance[i]`` children of
+    ``module`` under their original names.
+
+    Arguments:
+        module (nn.Sequential): The module to split.
+        balance (list of int): The number of children of every stage.
+
+    Returns:
+        A list of ``nn.Sequential``, one per stage.
+    """
+    if not isinstance(module, nn.Sequential):
+        raise TypeError("partition expects an nn.Sequential, got {}".format(
+            type(module).__name__))
+    children = list(module.named_children())
+    if any(size <= 0 for size in balance) or sum(balance) != len(children):
+        raise ValueError(
+            "balance {} does not split the {} children of the module into "
+            "non-empty stages".format(list(balance), len(children)))
+
+    stages = []
+    start = 0
+    for size in balance:
+        stages.append(nn.Sequential(OrderedDict(children[start:start + size])))
+        start += size
+    return stages
+
+
+def schedule(kind, stage, num_stages, chunks):
+    r"""
+    Returns the order in which ``stage`` of a pipeline of ``num_stages`` runs
+    the passes over ``chunks`` micro-batches, as a list of :class:`Step`.
+
+    GPipe runs the forward passes of all micro-batches, then their backward
+    passes, so that every stage holds the activations of all micro-batches.
+    1F1B runs ``num_stages - stage - 1`` forward passes to fill the pipeline,
+    then alternates one forward and one backward pass, so that a stage holds
+    the activations of at most ``num_stages - stage`` micro-batches. Both keep
+    the devices idle for the same ``(num_stages - 1) / (chunks + num_stages -
+    1)`` fraction of the step.
+    """
+    if not 0 <= stage < num_stages:
+        raise ValueError("stage {} is not in [0, {})".format(stage, num_stages))
+    if chunks <= 0:
+        raise ValueError("chunks must be positive, got {}".format(chunks))
+
+    if kind == GPIPE:
+        return ([Step("forward", i) for i in range(chunks)] +
+                [Step("backward", i) for i in range(chunks)])
+    if kind == ONE_F_ONE_B:
+        warmup = min(num_stages - stage - 1, chunks)
+        steps = [Step("forward", i) for i in range(warmup)]
+        for i in range(chunks - warmup):
+            steps.append(Step("forward", warmup + i))
+            steps.append(Step("backward", i))
+        steps.extend(Step("backward", i) for i in range(chunks - warmup, chunks))
+        return steps
+    raise ValueError("unknown pipeline schedule '{}', expected '{}' or '{}'".format(
+        kind, GPIPE, ONE_F_ONE_B))
+
+
+def _split(tensor, chunks):
+    if tensor.size(0) < chunks:
+        raise ValueError(
+            "a batch of {} cannot be split into {} micro-batches".format(
+                tensor.size(0), chunks))
+    # Unlike Tensor.chunk, which may return fewer than chunks pieces, this
+    # always returns chunks micro-batches whose sizes differ by at most 1.
+    base, rest = divmod(tensor.size(0), chunks)
+    return torch.split(tensor, [base + 1] * rest + [base] * (chunks - rest))
+
+
+class Pipe(object):
+    r"""
+    Runs one stage of a pipeline parallel model on every rank of a process
+    group, rank ``i`` running the ``i``-th stage, and trains it on batches
+    split into ``chunks`` micro-batches.
+
+    The stages send their activations to the next rank and their gradients to
+    the previous one with the point-to-point operations of the process group,
+    so the group has to be a Gloo group, which sends CPU copies of the
+    tensors, or an NCCL group, which sends them from the device of the stage.
+    Gradients are only sent back for floating point activations.
+
+    Arguments:
+        module (nn.Module): The stage of this rank, e.g. one of the modules
+            returned by :func:`partition`.
+        chunks (int): The number of micro-batches of a batch.
+        schedule (str, optional): ``"1f1b"`` (default) or ``"gpipe"``, see
+            :func:`schedule`.
+        checkpoint (bool, optional): Whether to drop the activations inside
+            the stage after every forward pass and to recompute them, with the
+            same random number generator state, in the backward pass
+            (default: ``False``).
+        process_group (ProcessGroup, optional): The group of the stages, by
+            default the default process group.
+        device (torch.device, optional): The device of the stage, by default
+            that of its first parameter.
+        profile (bool, optional): Whether :meth:`train_step` records in
+            :attr:`last_step_stats` the wall time of the step and the time the
+            stage spent computing, synchronizing the device around every pass
+            (default: ``False``).
+
+    Example::
+
+        >>> stages = partition(model, [2, 3])
+        >>> pipe = Pipe(stages[rank].cuda(rank), chunks=8)
+        >>> loss = pipe.train_step(inputs if rank == 0 else None,
+        >>>                        targets if rank == 1 else None,
+        >>>                        loss_fn=nn.CrossEntropyLoss())
+        >>> optimizer.step()
+    """
+
+    def __init__(self, module, chunks, schedule=ONE_F_ONE_B, checkpoint=False,
+                 process_group=None, device=None, profile=False):
+        if chunks <= 0:
+            raise ValueError("chunks must be positive, got {}".format(chunks))
+        if schedule not in (GPIPE, ONE_F_ONE_B):
+            raise ValueError("unknown pipeline schedule '{}'".format(schedule))
+
+        self.module = module
+        self.chunks = chunks
+        self.schedule = schedule
+        self.checkpoint = checkpoint
+        self.process_group = process_group if process_group is not None \
+            else dist.distributed_c10d._get_default_group()
+        self.stage = self.process_group.rank()
+        self.num_stages = self.process_group.size()
+        if device is None:
+            param = next(module.parameters(), None)
+            device = param.device if param is not None else torch.device("cpu")
+        self.device = torch.device(device)
+        # NCCL sends device memory, Gloo host memory.
+        self._comm_device = self.device \
+            if dist.get_backend(self.process_group) == dist.Backend.NCCL \
+            else torch.device("cpu")
+        self.profile = profile
+        self.last_step_stats = None
+
+        self._pending_sends = []
+
+    @property
+    def is_first_stage(self):
+        return self.stage == 0
+
+    @property
+    def is_last_stage(self):
+        return self.stage == self.num_stages - 1
+
+    def train_step(self, inputs=None, targets=None, loss_fn=None):
+        r"""
+        Runs the forward and backward passes of a batch through the pipeline
+        and accumulates the gradients into the parameters of the stage, as
+        ``loss_fn(model(inputs), targets).backward()`` would on the whole
+        model for a ``loss_fn`` averaging over the batch.
+
+        Arguments:
+            inputs (Tensor, optional): The batch, on the first stage only.
+            targets (Tensor, optional): The targets of the batch, on the last
+                stage only.
+            loss_fn (callable, optional): Computes the loss of a micro-batch
+                from the outputs and targets of the micro-batch, on the last
+                stage only.
+
+        Returns:
+            The detached loss of the batch on the last stage, ``None`` on the
+            other stages.
+        """
+        if self.is_first_stage and inputs is None:
+            raise ValueError("the first stage of the pipeline needs the inputs")
+        if self.is_last_stage and (targets is None or loss_fn is None):
+            raise ValueError("the last stage of the pipeline needs the targets and loss_fn")
+
+        self._inputs = _split(inputs.to(self.device), self.chunks) \
+            if self.is_first_stage else None
+        if self.is_last_stage:
+            self._targets = _split(targets.to(self.device), self.chunks)
+            self._loss_fn = loss_fn
+            self._batch_size = targets.size(0)
+        self._saved = [None] * self.chunks
+        self._sent = [None] * self.chunks
+        self._busy = 0.0
+        loss = torch.zeros((), device=self.device) if self.is_last_stage else None
+
+        start = time.time()
+        for step in schedule(self.schedule, self.stage, self.num_stages, self.chunks):
+            if step.kind == "forward":
+                output = self._forward(step.micro_batch)
+                if self.is_last_stage:
+                    loss += output
+            else:
+                self._backward(step.micro_batch)
+        self._wait_sends()
+        if self.profile:
+            self._synchronize()
+            self.last_step_stats = {"time": time.time() - start, "busy": self._busy}
+
+        self._inputs = self._targets = self._loss_fn = self._saved = self._sent = None
+        return loss
+
+    def forward(self, inputs=None):
+        r"""
+        Runs the forward pass of a batch through the pipeline without
+        recording it for autograd.
+
+        Arguments:
+            inputs (Tensor, optional): The batch, on the first stage only.
+
+        Returns:
+            The outputs of the model on the last stage, ``None`` on the other
+            stages.
+        """
+        if self.is_first_stage and inputs is None:
+            raise ValueError("the first stage of the pipeline needs the inputs")
+        micro_inputs = _split(inputs.to(self.device), self.chunks) \
+            if self.is_first_stage else None
+
+        outputs = []
+        with torch.no_grad():
+            for i in range(self.chunks):
+                x = micro_inputs[i] if self.is_first_stage else self._recv_activation()
+                y = self.module(x)
+                if self.is_last_stage:
+                    outputs.append(y)
+                else:
+                    self._send_activation(y)
+        self._wait_sends()
+        return torch.cat(outputs) if self.is_last_stage else None
+
+    def _run(self, i, x):
+        # The output of the stage over micro-batch i, or on the last stage its
+        # share of the loss of the batch.
+        y = self.module(x)
+        if self.is_last_stage:
+            target = self._targets[i]
+            y = self._loss_fn(y, target) * (float(target.size(0)) / self._batch_size)
+        return y
+
+    def _forward(self, i):
+        x = self._inputs[i] if self.is_first_stage else self._recv_activation()
+        compute_start = self._compute_start()
+        if self.checkpoint:
+            rng_state = self._get_rng_state()
+            with torch.no_grad():
+                y = self._run(i, x)
+            self._saved[i] = (x, rng_state)
+        else:
+            x = self._as_leaf(x)
+            with torch.enable_grad():
+                y = self._run(i, x)
+            self._saved[i] = (x, y)
+        self._compute_end(compute_start)
+
+        if self.is_last_stage:
+            return y.detach()
+        self._sent[i] = (y.size(), y.dtype)
+        self._send_activation(y.detach())
+        return None
+
+    def _backward(self, i):
+        # The gradient of the output is received before the recomputation, so
+        # that the recomputed activations are not kept alive while waiting.
+        saved = self._saved[i]
+        self._saved[i] = None
+        grad = None if self.is_last_stage else self._recv_gradient(i)
+
+        compute_start = self._compute_start()
+        if self.checkpoint:
+            x, rng_state = saved
+            x = self._as_leaf(x)
+            with torch.random.fork_rng(devices=self._rng_devices()):
+                self._set_rng_state(rng_state)
+                with torch.enable_grad():
+                    y = self._run(i, x)
+        else:
+            x, y = saved
+        if y.requires_grad and (grad is not None or self.is_last_stage):
+            torch.autograd.backward(y, grad)
+        self._compute_end(compute_start)
+
+        if not self.is_first_stage and x.is_floating_point():
+            self._send(x.grad if x.grad is not None else torch.zeros_like(x),
+                       self.stage - 1, _GRADIENT_TAG)
+
+    def _as_leaf(self, x):
+        x = x.detach()
+        if not self.is_first_stage and x.is_floating_point():
+            x.requires_grad_()
+        return x
+
+    # Communication
+
+    def _send_activation(self, y):
+        if y.dim() > _MAX_DIMS:
+            raise ValueError("activations of more than {} dimensions cannot be sent "
+                             "through the pipeline".format(_MAX_DIMS))
+        meta = [_DTYPES.index(y.dtype), y.dim()] + list(y.size()) + \
+            [0] * (_MAX_DIMS - y.dim())
+        self._send(torch.tensor(meta, dtype=torch.int64), self.stage + 1, _ACTIVATION_TAG)
+        self._send(y, self.stage + 1, _ACTIVATION_TAG)
+
+    def _recv_activation(self):
+        meta = self._recv(torch.Size([_MAX_DIMS + 2]), torch.int64,
+                          self.stage - 1, _ACTIVATION_TAG).tolist()
+        dtype, dim = _DTYPES[meta[0]], meta[1]
+        return self._recv(torch.Size(meta[2:2 + dim]), dtype,
+                          self.stage - 1, _ACTIVATION_TAG)
+
+    def _recv_gradient(self, i):
+        size, dtype = self._sent[i]
+        if not dtype.is_floating_point:
+            return None
+        return self._recv(size, dtype, self.stage + 1, _GRADIENT_TAG)
+
+    def _send(self, tensor, peer, tag):
+        tensor = tensor.to(self._comm_device).contiguous()
+        work = self.process_group.send([tensor], peer, tag)
+        # The tensor has to outlive the send, which is only waited for once
+        # the step is over, but completed sends are dropped as they go.
+        self._pending_sends = [(w, t) for w, t in self._pending_sends if not w.is_completed()]
+        self._pending_sends.append((work, tensor))
+
+    def _recv(self, size, dtype, peer, tag):
+        tensor = torch.empty(size, dtype=dtype, device=self._comm_device)
+        self.process_group.recv([tensor], peer, tag).wait()
+        return tensor.to(self.device)
+
+    def _wait_sends(self):
+        for work, _ in self._pending_sends:
+            work.wait()
+        self._pending_sends = []
+
+    # Random number generators, whose state checkpointing replays
+
+    def _rng_devices(self):
+        return [self.device] if self.device.type == "cuda" else []
+
+    def _get_rng_state(self):
+        cuda_state = torch.cuda.get_rng_state(self.device) \
+            if self.device.type == "cuda" else None
+        return torch.get_rng_state(), cuda_state
+
+    def _set_rng_state(self, state):
+        cpu_state, cuda_state = state
+        torch.set_rng_state(cpu_state)
+        if cuda_state is not None:
+            torch.cuda.set_rng_state(cuda_state, self.device)
+
+    # Profiling
+
+    def _synchronize(self):
+        if self.device.type == "cuda":
+            torch.cuda.synchronize(self.device)
+
+    def _compute_start(self):
+        if not self.profile:
+            return None
+        self._synchronize()
+        return time.time()
+
+    def _compute_end(self, start):
+        if start is not None:
+            self._synchronize()
+            self._busy += time.time() - start
@@ -145,6 +145,9 @@ def _process_group_init_backend_handler(
         group,
         rpc_backend_options.num_send_recv_threads,
         timedelta(seconds=rpc_backend_options.rpc_timeout),
+        rpc_backend_options.max_coalesced_bytes,
+        rpc_backend_options.coalescing_window,
+        rpc_backend_options.metrics_handler,
     )
 
 
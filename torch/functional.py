@@ -26,6 +26,7 @@ __all__ = [
     'lu_unpack',
     'norm',
     'meshgrid',
+    'multi_reduce',
     'pca_lowrank',
     'split',
     'stft',
@@ -928,6 +929,63 @@ def block_diag(*tensors):
     return torch._C._VariableFunctions.block_diag(tensors)
 
 
+_multi_reductions = ('sum', 'sumsq', 'min', 'max', 'count')
+
+
+def multi_reduce(input, reductions, dim=None, keepdim=False):
+    r"""multi_reduce(input, reductions, dim=None, keepdim=False) -> tuple of Tensors
+
+    Computes several reductions of :attr:`input` over :attr:`dim` in a single
+    pass over its memory, which is faster than calling the reductions one
+    after another when :attr:`input` is large.
+
+    The supported reductions are ``'sum'``, ``'sumsq'`` (sum of squares),
+    ``'min'``, ``'max'`` and ``'count'`` (the number of reduced elements, as
+    an int64 tensor). ``'min'`` and ``'max'`` propagate NaN like
+    :func:`torch.min` and :func:`torch.max`, and are not defined for
+    reductions over no elements.
+
+    Args:
+        input (Tensor): the input tensor, of floating point type
+        reductions (sequence of str): the reductions to compute
+        dim (int or tuple of ints, optional): the dimensions to reduce.
+            Default: all dimensions
+        keepdim (bool): whether the outputs have :attr:`dim` retained or not
+
+    Returns:
+        tuple of Tensors: one tensor per entry of :attr:`reductions`, in the
+        same order
+
+    Example::
+
+        >>> x = torch.tensor([[1., 2., 3.], [4., 5., 6.]])
+        >>> s, ss, n = torch.multi_reduce(x, ['sum', 'sumsq', 'count'], dim=1)
+        >>> mean = s / n
+        >>> var = ss / n - mean * mean
+        >>> mean, var
+        (tensor([2., 5.]), tensor([0.6667, 0.6667]))
+    """
+    if not torch.jit.is_scripting():
+        if type(input) is not Tensor and has_torch_function((input,)):
+            return handle_torch_function(
+                multi_reduce, (input,), input, reductions, dim=dim, keepdim=keepdim)
+    if isinstance(reductions, str):
+        reductions = [reductions]
+    for r in reductions:
+        if r not in _multi_reductions:
+            raise ValueError("multi_reduce(): unknown reduction '{}', expected one of {}".format(
+                r, ', '.join(_multi_reductions)))
+    if dim is None:
+        dim = []
+    elif isinstance(dim, int):
+        dim = [dim]
+    outputs = torch._C._VariableFunctions._multi_reduce(
+        input, dim, keepdim, *(r in reductions for r in _multi_reductions))
+    # The outputs come back in the order of _multi_reductions, once each
+    computed = dict(zip([r for r in _multi_reductions if r in reductions], outputs))
+    return tuple(computed[r] for r in reductions)
+
+
 def cdist(x1, x2, p=2., compute_mode='use_mm_for_euclid_dist_if_necessary'):
     # type: (Tensor, Tensor, float, str) -> (Tensor)
     r"""Computes batched the p-norm distance between each pair of the two collections of row vectors.
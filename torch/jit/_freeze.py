@@ -10,7 +10,7 @@ import torch
 from torch.jit._script import RecursiveScriptModule, ScriptModule
 
 
-def freeze(mod, preserved_attrs: Optional[List[str]] = None):
+def freeze(mod, preserved_attrs: Optional[List[str]] = None, optimize: bool = False):
     r"""
     Freezing a :class:`ScriptModule` will clone it and attempt to inline the cloned
     module's submodules, parameters, and attributes as constants in the TorchScript IR Graph.
@@ -26,6 +26,11 @@ def freeze(mod, preserved_attrs: Optional[List[str]] = None):
         preserved_attrs (Optional[List[str]]): a list of attributes to preserve in addition to the forward method.
         Attributes modified in preserved methods will also be preserved.
 
+        optimize (bool): whether to also optimize the frozen `forward` for inference on CPU, using that
+        its parameters are constants: BatchNorms are folded into the convolutions they follow, and
+        float convolutions and linear layers run on MKL-DNN with their weights converted to its layout
+        once. A module optimized this way can't be saved. Defaults to False.
+
     Returns:
         Frozen :class:`ScriptModule`.
 
@@ -97,5 +102,7 @@ def freeze(mod, preserved_attrs: Optional[List[str]] = None):
 
     out = RecursiveScriptModule(torch._C._freeze_module(mod._c, preserved_attrs))
     RecursiveScriptModule._finalize_scriptmodule(out)
+    if optimize:
+        torch._C._jit_pass_optimize_frozen_graph(out.graph)
 
     return out
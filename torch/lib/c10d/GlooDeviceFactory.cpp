@@ -12,6 +12,10 @@
 #include <gloo/transport/uv/device.h>
 #endif
 
+#if GLOO_HAVE_TRANSPORT_IBVERBS
+#include <gloo/transport/ibverbs/device.h>
+#endif
+
 // On Linux, check that the tcp transport is available.
 #ifdef __linux__
 #if !GLOO_HAVE_TRANSPORT_TCP
@@ -120,4 +124,19 @@ std::shared_ptr<::gloo::transport::Device> GlooDeviceFactory::
   throw std::runtime_error("makeDeviceForHostname(): unsupported gloo device");
 }
 
+std::shared_ptr<::gloo::transport::Device> GlooDeviceFactory::
+    makeIBVerbsDevice(const std::string& name) {
+#if GLOO_HAVE_TRANSPORT_IBVERBS
+  ::gloo::transport::ibverbs::attr attr;
+  attr.name = name;
+  attr.port = 1;
+  attr.index = 0;
+  return ::gloo::transport::ibverbs::CreateDevice(attr);
+#else
+  throw std::runtime_error(
+      "makeIBVerbsDevice(): Gloo was not compiled with ibverbs support, "
+      "please recompile with USE_IBVERBS=1");
+#endif
+}
+
 } // namespace c10d
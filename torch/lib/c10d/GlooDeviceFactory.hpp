@@ -17,6 +17,12 @@ class GlooDeviceFactory {
   // Create new device instance for specific hostname or address.
   static std::shared_ptr<::gloo::transport::Device> makeDeviceForHostname(
       const std::string& hostname);
+
+  // Create new ibverbs device instance for the named InfiniBand device.
+  // These support GPUDirect RDMA but not the unbound buffers that most
+  // collectives use, see ProcessGroupGloo::Options::gpuDirectDevices.
+  static std::shared_ptr<::gloo::transport::Device> makeIBVerbsDevice(
+      const std::string& name);
 };
 
 C10_DECLARE_SHARED_REGISTRY(
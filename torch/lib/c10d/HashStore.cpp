@@ -87,4 +87,19 @@ bool HashStore::check(const std::vector<std::string>& keys) {
   return true;
 }
 
+std::vector<uint8_t> HashStore::compareSet(
+    const std::string& key,
+    const std::vector<uint8_t>& expectedValue,
+    const std::vector<uint8_t>& desiredValue) {
+  std::unique_lock<std::mutex> lock(m_);
+  auto it = map_.find(key);
+  if ((it == map_.end() && expectedValue.empty()) ||
+      (it != map_.end() && it->second == expectedValue)) {
+    map_[key] = desiredValue;
+    cv_.notify_all();
+    return desiredValue;
+  }
+  return it == map_.end() ? std::vector<uint8_t>() : it->second;
+}
+
 } // namespace c10d
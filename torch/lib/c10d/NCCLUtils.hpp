@@ -29,6 +29,15 @@
 #endif
 #endif
 
+// Per communicator configuration is only supported by NCCL 2.17+, the first
+// version with ncclConfig_t::minCTAs and ncclConfig_t::maxCTAs.
+#if defined(NCCL_MAJOR) && (NCCL_MAJOR == 2) && defined(NCCL_MINOR) && \
+    (NCCL_MINOR >= 17)
+#define ENABLE_NCCL_COMM_CONFIG
+#elif defined(NCCL_MAJOR) && (NCCL_MAJOR >= 3)
+#define ENABLE_NCCL_COMM_CONFIG
+#endif
+
 // Macro to throw on a non-successful NCCL return value.
 #define C10D_NCCL_CHECK(cmd)                                                 \
   do {                                                                       \
@@ -85,11 +94,37 @@ class NCCLComm {
     }
   }
 
+  // minChannels and maxChannels bound the number of channels, i.e., of CUDA
+  // blocks, the kernels of the communicator use. -1 leaves it to NCCL.
   static std::shared_ptr<NCCLComm> create(
       int numRanks,
       int rank,
-      ncclUniqueId commId) {
+      ncclUniqueId commId,
+      int minChannels = -1,
+      int maxChannels = -1) {
     auto comm = std::make_shared<NCCLComm>();
+#ifdef ENABLE_NCCL_COMM_CONFIG
+    if (minChannels >= 0 || maxChannels >= 0) {
+      ncclConfig_t config = NCCL_CONFIG_INITIALIZER;
+      if (minChannels >= 0) {
+        config.minCTAs = minChannels;
+      }
+      if (maxChannels >= 0) {
+        config.maxCTAs = maxChannels;
+      }
+      C10D_NCCL_CHECK(ncclCommInitRankConfig(
+          &(comm->ncclComm_), numRanks, commId, rank, &config));
+      comm->ncclId_ = commId;
+      return comm;
+    }
+#else
+    if (minChannels >= 0 || maxChannels >= 0) {
+      throw std::runtime_error(
+          "Configuring the channels of NCCL communicators requires NCCL 2.17+, "
+          "got NCCL " +
+          getNcclVersion());
+    }
+#endif
     C10D_NCCL_CHECK(
         ncclCommInitRank(&(comm->ncclComm_), numRanks, commId, rank));
     comm->ncclId_ = commId;
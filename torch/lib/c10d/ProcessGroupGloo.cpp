@@ -7,6 +7,8 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <array>
 #include <type_traits>
 
 #include <gloo/allgather.h>
@@ -29,6 +31,8 @@
 #include <c10/cuda/CUDACachingAllocator.h>
 #include <c10/cuda/CUDAGuard.h>
 #include <c10/cuda/CUDAStream.h>
+#include <gloo/cuda_allreduce_ring_chunked.h>
+#include <gloo/cuda_workspace.h>
 #endif
 
 #include <c10/util/StringUtil.h>
@@ -405,7 +409,18 @@ void ProcessGroupGloo::RecvWork::abort() {
 }
 
 ProcessGroupGloo::Options::Options()
-    : timeout(std::chrono::milliseconds(10 * 1000)), threads(2) {}
+    : timeout(std::chrono::milliseconds(10 * 1000)),
+      threads(2),
+      hierarchical(false) {}
+
+#ifdef USE_CUDA
+struct ProcessGroupGloo::GPUDirectAllreduce {
+  // The tensors the algorithm reduces in place, one per device.
+  std::vector<at::Tensor> buffers;
+  std::unique_ptr<::gloo::Algorithm> algorithm;
+  bool inUse = false;
+};
+#endif
 
 namespace {
 
@@ -450,6 +465,11 @@ std::shared_ptr<::gloo::transport::Device> ProcessGroupGloo::
 }
 #endif
 
+std::shared_ptr<::gloo::transport::Device> ProcessGroupGloo::
+    createDeviceForIBVerbs(const std::string& name) {
+  return ::c10d::GlooDeviceFactory::makeIBVerbsDevice(name);
+}
+
 #if defined(__linux__) || defined(__APPLE__)
 std::shared_ptr<::gloo::transport::Device> ProcessGroupGloo::
     createDeviceForHostname(const std::string& hostname) {
@@ -550,6 +570,32 @@ ProcessGroupGloo::ProcessGroupGloo(
     contexts_.push_back(std::move(context));
   }
 
+  if (options.hierarchical) {
+    initTopology(options);
+  }
+
+  // The GPUDirect contexts only run old style algorithms, which pass their
+  // buffers to the device. Every process must agree on having them.
+  for (size_t i = 0; i < options.gpuDirectDevices.size(); i++) {
+#ifdef USE_CUDA
+    const auto& device = options.gpuDirectDevices[i];
+    TORCH_CHECK(
+        device->hasGPUDirect(),
+        "ProcessGroupGloo: device ",
+        device->str(),
+        " does not support GPUDirect");
+    auto context = std::make_shared<::gloo::rendezvous::Context>(rank_, size_);
+    auto store = ::gloo::rendezvous::PrefixStore(
+        "gpudirect/" + std::to_string(i), *store_);
+    context->setTimeout(options.timeout);
+    context->connectFullMesh(store, device);
+    gpuDirectContexts_.push_back(std::move(context));
+#else
+    throw std::runtime_error(
+        "ProcessGroupGloo: GPUDirect devices require a build with CUDA");
+#endif
+  }
+
   // Every worker thread stores the AsyncWork object it's currently
   // working on in the workInProgress_ vector. It must have size equal
   // to the number of workers such that they can simply index into it
@@ -580,6 +626,75 @@ ProcessGroupGloo::~ProcessGroupGloo() {
   }
 }
 
+void ProcessGroupGloo::initTopology(const Options& options) {
+  std::array<char, 256> hostname{};
+  if (gethostname(hostname.data(), hostname.size() - 1) != 0) {
+    throw std::system_error(errno, std::system_category());
+  }
+  auto store = ::gloo::rendezvous::PrefixStore("topology", *store_);
+  store.set(
+      std::to_string(rank_),
+      std::vector<char>(
+          hostname.data(), hostname.data() + strlen(hostname.data())));
+
+  auto topology = std::make_shared<Topology>();
+  std::unordered_map<std::string, int> nodeOfHost;
+  for (int rank = 0; rank < size_; rank++) {
+    store.wait({std::to_string(rank)}, options.timeout);
+    const auto value = store.get(std::to_string(rank));
+    const auto inserted = nodeOfHost.emplace(
+        std::string(value.begin(), value.end()),
+        topology->ranksOfNode.size());
+    if (inserted.second) {
+      topology->ranksOfNode.emplace_back();
+    }
+    topology->ranksOfNode[inserted.first->second].push_back(rank);
+    if (rank == rank_) {
+      topology->node = inserted.first->second;
+    }
+  }
+
+  // The flat algorithms are as good with a single node or a single process
+  // per node.
+  const int numNodes = topology->ranksOfNode.size();
+  if (numNodes == 1 || numNodes == size_) {
+    return;
+  }
+
+  const auto& localRanks = topology->ranksOfNode[topology->node];
+  const int localRank =
+      std::find(localRanks.begin(), localRanks.end(), rank_) -
+      localRanks.begin();
+  for (size_t i = 0; i < options.devices.size(); i++) {
+    auto localStore = ::gloo::rendezvous::PrefixStore(
+        "topology/node" + std::to_string(topology->node) + "/" +
+            std::to_string(i),
+        *store_);
+    auto local = std::make_shared<::gloo::rendezvous::Context>(
+        localRank, localRanks.size());
+    local->setTimeout(options.timeout);
+    local->connectFullMesh(localStore, options.devices[i]);
+    topology->local.push_back(std::move(local));
+
+    if (localRank == 0) {
+      auto leadersStore = ::gloo::rendezvous::PrefixStore(
+          "topology/leaders/" + std::to_string(i), *store_);
+      auto leaders = std::make_shared<::gloo::rendezvous::Context>(
+          topology->node, numNodes);
+      leaders->setTimeout(options.timeout);
+      leaders->connectFullMesh(leadersStore, options.devices[i]);
+      topology->leaders.push_back(std::move(leaders));
+    }
+  }
+
+  topology_ = std::move(topology);
+}
+
+bool ProcessGroupGloo::useHierarchical(
+    const std::vector<at::Tensor>& tensors) const {
+  return topology_ && tensors.size() == 1 && tensors[0].is_contiguous();
+}
+
 uint32_t ProcessGroupGloo::nextTag() {
   return collectiveCounter_++;
 }
@@ -588,6 +703,103 @@ std::shared_ptr<::gloo::Context> ProcessGroupGloo::getContext(uint32_t tag) {
   return contexts_[tag % contexts_.size()];
 }
 
+#ifdef USE_CUDA
+bool ProcessGroupGloo::useGPUDirect(
+    const std::vector<at::Tensor>& tensors,
+    ReduceOp reduceOp) const {
+  if (gpuDirectContexts_.empty() || reduceOp != ReduceOp::SUM) {
+    return false;
+  }
+  switch (tensors[0].scalar_type()) {
+    case at::kFloat:
+    case at::kDouble:
+    case at::kHalf:
+      return true;
+    default:
+      return false;
+  }
+}
+
+namespace {
+
+template <typename T>
+std::unique_ptr<::gloo::Algorithm> makeGPUDirectAllreduce(
+    const std::shared_ptr<::gloo::Context>& context,
+    std::vector<at::Tensor>& buffers) {
+  std::vector<T*> ptrs;
+  ptrs.reserve(buffers.size());
+  for (auto& buffer : buffers) {
+    ptrs.push_back(static_cast<T*>(buffer.data_ptr()));
+  }
+  return std::unique_ptr<::gloo::Algorithm>(
+      new ::gloo::CudaAllreduceRingChunked<T, ::gloo::CudaDeviceWorkspace<T>>(
+          context, ptrs, buffers[0].numel()));
+}
+
+} // namespace
+
+std::shared_ptr<ProcessGroupGloo::GPUDirectAllreduce> ProcessGroupGloo::
+    acquireGPUDirectAllreduce(
+        const std::vector<at::Tensor>& tensors,
+        uint32_t tag) {
+  const auto index = tag % gpuDirectContexts_.size();
+  std::vector<int64_t> devices;
+  devices.reserve(tensors.size());
+  for (const auto& tensor : tensors) {
+    devices.push_back(tensor.device().index());
+  }
+  GPUDirectKey key(
+      index, tensors[0].scalar_type(), tensors[0].numel(), std::move(devices));
+
+  std::unique_lock<std::mutex> lock(gpuDirectMutex_);
+  auto it = gpuDirectCache_.find(key);
+  if (it != gpuDirectCache_.end()) {
+    auto allreduce = it->second;
+    gpuDirectCV_.wait(lock, [&] { return !allreduce->inUse; });
+    allreduce->inUse = true;
+    return allreduce;
+  }
+
+  // Creating the algorithm takes the next slots of the context, in the
+  // order of the collectives, which is why it happens here and not on a
+  // worker thread.
+  auto allreduce = std::make_shared<GPUDirectAllreduce>();
+  allreduce->buffers.reserve(tensors.size());
+  for (const auto& tensor : tensors) {
+    allreduce->buffers.push_back(at::empty({tensor.numel()}, tensor.options()));
+  }
+  const auto& context = gpuDirectContexts_[index];
+  switch (tensors[0].scalar_type()) {
+    case at::kFloat:
+      allreduce->algorithm =
+          makeGPUDirectAllreduce<float>(context, allreduce->buffers);
+      break;
+    case at::kDouble:
+      allreduce->algorithm =
+          makeGPUDirectAllreduce<double>(context, allreduce->buffers);
+      break;
+    case at::kHalf:
+      allreduce->algorithm = makeGPUDirectAllreduce<::gloo::float16>(
+          context, allreduce->buffers);
+      break;
+    default:
+      TORCH_INTERNAL_ASSERT(false, "unsupported GPUDirect allreduce type");
+  }
+  allreduce->inUse = true;
+  gpuDirectCache_.emplace(std::move(key), allreduce);
+  return allreduce;
+}
+
+void ProcessGroupGloo::releaseGPUDirectAllreduce(
+    const std::shared_ptr<GPUDirectAllreduce>& allreduce) {
+  {
+    std::lock_guard<std::mutex> lock(gpuDirectMutex_);
+    allreduce->inUse = false;
+  }
+  gpuDirectCV_.notify_all();
+}
+#endif
+
 void ProcessGroupGloo::runLoop(int workerIndex) {
   std::unique_lock<std::mutex> lock(workMutex_);
 
@@ -725,6 +937,68 @@ class AsyncBroadcastCUDAWork : public AsyncBroadcastWork {
 
 #endif
 
+// Broadcast in three stages: within the node of the root, from the root to
+// the leader of the node, among the leaders, then within the other nodes,
+// from their leader.
+class AsyncHierarchicalBroadcastWork : public ProcessGroupGloo::AsyncWork {
+ public:
+  AsyncHierarchicalBroadcastWork(
+      const std::shared_ptr<const ProcessGroupGloo::Topology>& topology,
+      const std::shared_ptr<gloo::Context>& local,
+      const std::shared_ptr<gloo::Context>& leaders,
+      at::Tensor& tensor,
+      int rootRank,
+      uint32_t tag)
+      : topology(topology),
+        local(local),
+        leaders(leaders),
+        tensor(tensor),
+        rootRank(rootRank),
+        tag(tag) {}
+
+  std::shared_ptr<const ProcessGroupGloo::Topology> topology;
+  std::shared_ptr<gloo::Context> local;
+  std::shared_ptr<gloo::Context> leaders;
+  at::Tensor tensor;
+  const int rootRank;
+  const uint32_t tag;
+
+  void broadcast(
+      const std::shared_ptr<gloo::Context>& context,
+      int root) {
+    const auto& scalarType = tensor.scalar_type();
+    gloo::BroadcastOptions opts(context);
+    opts.setRoot(root);
+    opts.setTag(tag);
+    GENERATE_ALL_TYPES(scalarType, setOutput, opts, tensor);
+    gloo::broadcast(opts);
+  }
+
+  void run() override {
+    int rootNode = 0;
+    int rootLocalRank = 0;
+    for (size_t i = 0; i < topology->ranksOfNode.size(); i++) {
+      const auto& ranks = topology->ranksOfNode[i];
+      const auto it = std::find(ranks.begin(), ranks.end(), rootRank);
+      if (it != ranks.end()) {
+        rootNode = i;
+        rootLocalRank = it - ranks.begin();
+        break;
+      }
+    }
+
+    if (topology->node == rootNode && local->size > 1) {
+      broadcast(local, rootLocalRank);
+    }
+    if (leaders) {
+      broadcast(leaders, rootNode);
+    }
+    if (topology->node != rootNode && local->size > 1) {
+      broadcast(local, 0);
+    }
+  }
+};
+
 } // namespace
 
 std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::broadcast(
@@ -750,10 +1024,19 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::broadcast(
       invalidArgument(c10::str("unsupported device type ", device.type()));
   }
 
-  std::shared_ptr<AsyncBroadcastWork> work;
+  std::shared_ptr<AsyncWork> work;
   auto tag = nextTag();
   auto context = getContext(tag);
-  if (device.type() == at::kCPU) {
+  if (device.type() == at::kCPU && useHierarchical(inputs)) {
+    const auto index = tag % contexts_.size();
+    work = std::make_shared<AsyncHierarchicalBroadcastWork>(
+        topology_,
+        topology_->local[index],
+        topology_->leaders.empty() ? nullptr : topology_->leaders[index],
+        inputs[0],
+        opts.rootRank,
+        tag);
+  } else if (device.type() == at::kCPU) {
     work = std::make_shared<AsyncBroadcastWork>(
         std::move(context), inputs, opts.rootRank, opts.rootTensor, tag);
 #ifdef USE_CUDA
@@ -820,6 +1103,69 @@ class AsyncAllreduceWork : public ProcessGroupGloo::AsyncWork {
   }
 };
 
+// Allreduce in three stages: reduce within every node to its leader,
+// allreduce among the leaders, then broadcast within every node from its
+// leader. Only the leaders exchange data over the network, once per node
+// rather than once per process.
+class AsyncHierarchicalAllreduceWork : public ProcessGroupGloo::AsyncWork {
+ public:
+  AsyncHierarchicalAllreduceWork(
+      const std::shared_ptr<gloo::Context>& local,
+      const std::shared_ptr<gloo::Context>& leaders,
+      at::Tensor& tensor,
+      ReduceOp reduceOp,
+      uint32_t tag)
+      : local(local),
+        leaders(leaders),
+        tensor(tensor),
+        reduceOp(reduceOp),
+        tag(tag) {}
+
+  std::shared_ptr<gloo::Context> local;
+  std::shared_ptr<gloo::Context> leaders;
+  at::Tensor tensor;
+  const ReduceOp reduceOp;
+  const uint32_t tag;
+
+  void run() override {
+    const auto& scalarType = tensor.scalar_type();
+
+    if (local->size > 1) {
+      gloo::ReduceOptions opts(local);
+      opts.setRoot(0);
+      opts.setTag(tag);
+      gloo::ReduceOptions::Func fn;
+      GENERATE_ALL_TYPES(scalarType, getFunction, fn, reduceOp);
+      opts.setReduceFunction(fn);
+      GENERATE_ALL_TYPES(scalarType, setOutput, opts, tensor);
+      gloo::reduce(opts);
+    }
+
+    if (leaders) {
+      gloo::AllreduceOptions opts(leaders);
+      opts.setTag(tag);
+      gloo::AllreduceOptions::Func fn;
+      GENERATE_ALL_TYPES(scalarType, getFunction, fn, reduceOp);
+      opts.setReduceFunction(fn);
+      GENERATE_ALL_TYPES(scalarType, setOutput, opts, tensor);
+      gloo::allreduce(opts);
+    }
+
+    if (local->size > 1) {
+      gloo::BroadcastOptions opts(local);
+      opts.setRoot(0);
+      opts.setTag(tag);
+      GENERATE_ALL_TYPES(scalarType, setOutput, opts, tensor);
+      gloo::broadcast(opts);
+    }
+  }
+
+  template <typename T, typename F>
+  static void getFunction(F& fn, const ReduceOp op) {
+    fn = toFunction<T>(op);
+  }
+};
+
 class AsyncAllreduceCoalescedWork : public AsyncAllreduceWork {
  public:
   AsyncAllreduceCoalescedWork(
@@ -1186,6 +1532,85 @@ class AsyncAllreduceCUDAWork : public AsyncAllreduceWork {
   std::vector<at::cuda::CUDAEvent> events;
 };
 
+// Runs the allreduce sum over the buffers of a cached GPUDirect algorithm,
+// which exchanges them from device memory. The tensors are copied to and from
+// the buffers on the device.
+class AsyncAllreduceGPUDirectWork : public ProcessGroupGloo::AsyncWork {
+ public:
+  AsyncAllreduceGPUDirectWork(
+      std::vector<at::Tensor>& inputs,
+      std::shared_ptr<ProcessGroupGloo::GPUDirectAllreduce> allreduce,
+      std::function<void()> release)
+      : inputs(inputs),
+        allreduce(std::move(allreduce)),
+        release(std::move(release)) {
+    initializeStreamsEvents(inputs, streams, events);
+
+    // Kick off copy from the tensors to the buffers of the algorithm.
+    at::cuda::OptionalCUDAStreamGuard guard;
+    for (size_t i = 0; i < inputs.size(); i++) {
+      guard.reset_stream(streams[i]);
+      this->allreduce->buffers[i]
+          .view(inputs[i].sizes())
+          .copy_(inputs[i], /* non_blocking */ true);
+    }
+  }
+
+  void run() override {
+    // Hand the algorithm to the next collective with its key even if this
+    // one fails.
+    try {
+      runAllreduce();
+    } catch (...) {
+      release();
+      throw;
+    }
+    release();
+  }
+
+  void runAllreduce() {
+    // Synchronize with copy operations.
+    at::cuda::OptionalCUDAGuard device_guard;
+    for (size_t i = 0; i < inputs.size(); i++) {
+      device_guard.set_index(inputs[i].device().index());
+      AT_CUDA_CHECK(cudaStreamSynchronize(streams[i]));
+    }
+
+    allreduce->algorithm->run();
+
+    // Copy back to the tensors. Every buffer holds the result. The next
+    // collective with the same key overwrites the buffers, so the copies
+    // complete before the algorithm is released.
+    at::cuda::OptionalCUDAStreamGuard stream_guard;
+    for (size_t i = 0; i < inputs.size(); i++) {
+      stream_guard.reset_stream(streams[i]);
+      inputs[i].copy_(
+          allreduce->buffers[i].view(inputs[i].sizes()),
+          /* non_blocking */ true);
+      events[i].record(streams[i]);
+    }
+    for (size_t i = 0; i < inputs.size(); i++) {
+      device_guard.set_index(inputs[i].device().index());
+      AT_CUDA_CHECK(cudaStreamSynchronize(streams[i]));
+    }
+  }
+
+  void synchronize() override {
+    // Synchronize with the copy back to CUDA tensors.
+    at::cuda::OptionalCUDAGuard guard;
+    for (size_t i = 0; i < inputs.size(); i++) {
+      guard.set_index(inputs[i].device().index());
+      events[i].block(at::cuda::getCurrentCUDAStream());
+    }
+  }
+
+  std::vector<at::Tensor> inputs;
+  std::shared_ptr<ProcessGroupGloo::GPUDirectAllreduce> allreduce;
+  std::function<void()> release;
+  std::vector<at::cuda::CUDAStream> streams;
+  std::vector<at::cuda::CUDAEvent> events;
+};
+
 class AsyncSparseAllreduceCUDAWork : public AsyncSparseAllreduceWork {
  public:
   AsyncSparseAllreduceCUDAWork(
@@ -1284,7 +1709,15 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::allreduce(
   auto tag = nextTag();
   auto context = getContext(tag);
   if (device.type() == at::kCPU) {
-    if (layout == c10::kStrided) {
+    if (layout == c10::kStrided && useHierarchical(inputs)) {
+      const auto index = tag % contexts_.size();
+      work = std::make_shared<AsyncHierarchicalAllreduceWork>(
+          topology_->local[index],
+          topology_->leaders.empty() ? nullptr : topology_->leaders[index],
+          inputs[0],
+          opts.reduceOp,
+          tag);
+    } else if (layout == c10::kStrided) {
       work = std::make_shared<AsyncAllreduceWork>(
           std::move(context), inputs, opts.reduceOp, tag);
     } else if (layout == c10::kSparse) {
@@ -1295,7 +1728,13 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::allreduce(
     }
 #ifdef USE_CUDA
   } else if (device.type() == at::kCUDA) {
-    if (layout == c10::kStrided) {
+    if (layout == c10::kStrided && useGPUDirect(inputs, opts.reduceOp)) {
+      auto allreduce = acquireGPUDirectAllreduce(inputs, tag);
+      work = std::make_shared<AsyncAllreduceGPUDirectWork>(
+          inputs, allreduce, [this, allreduce]() {
+            releaseGPUDirectAllreduce(allreduce);
+          });
+    } else if (layout == c10::kStrided) {
       work = std::make_shared<AsyncAllreduceCUDAWork>(
           std::move(context), inputs, opts.reduceOp, tag);
     } else if (layout == c10::kSparse) {
@@ -1665,6 +2104,82 @@ class AsyncAllgatherCUDAWork : public AsyncAllgatherWork {
 
 #endif
 
+// Allgather in three stages: gather the inputs of every node on its leader,
+// allgather the inputs of the nodes among the leaders, then broadcast them
+// within every node from its leader.
+class AsyncHierarchicalAllgatherWork : public ProcessGroupGloo::AsyncWork {
+ public:
+  AsyncHierarchicalAllgatherWork(
+      const std::shared_ptr<const ProcessGroupGloo::Topology>& topology,
+      const std::shared_ptr<gloo::Context>& local,
+      const std::shared_ptr<gloo::Context>& leaders,
+      std::vector<at::Tensor>& outputs,
+      at::Tensor& input,
+      uint32_t tag)
+      : topology(topology),
+        local(local),
+        leaders(leaders),
+        outputs(outputs),
+        input(input),
+        tag(tag) {}
+
+  std::shared_ptr<const ProcessGroupGloo::Topology> topology;
+  std::shared_ptr<gloo::Context> local;
+  std::shared_ptr<gloo::Context> leaders;
+  std::vector<at::Tensor> outputs;
+  at::Tensor input;
+  const uint32_t tag;
+
+  void run() override {
+    const auto& scalarType = input.scalar_type();
+    at::Tensor flatInput = flattenDenseTensors(input);
+
+    // The inputs of the processes of this node, on its leader.
+    at::Tensor nodeInputs = flatInput;
+    if (local->size > 1) {
+      gloo::GatherOptions opts(local);
+      opts.setRoot(0);
+      opts.setTag(tag);
+      GENERATE_ALL_TYPES(scalarType, setInput, opts, flatInput);
+      if (local->rank == 0) {
+        nodeInputs = at::empty(
+            {local->size * flatInput.numel()}, flatInput.options());
+        GENERATE_ALL_TYPES(scalarType, setOutput, opts, nodeInputs);
+      }
+      gloo::gather(opts);
+    }
+
+    // The inputs of all the processes, ordered by node, then by rank.
+    at::Tensor flatOutput = newLikeFlat(outputs);
+    if (leaders) {
+      std::vector<size_t> counts;
+      for (const auto& ranks : topology->ranksOfNode) {
+        counts.push_back(ranks.size() * flatInput.numel());
+      }
+      gloo::AllgathervOptions opts(leaders);
+      opts.setTag(tag);
+      GENERATE_ALL_TYPES(scalarType, setInput, opts, nodeInputs);
+      GENERATE_ALL_TYPES(scalarType, setOutput, opts, flatOutput, counts);
+      gloo::allgatherv(opts);
+    }
+
+    if (local->size > 1) {
+      gloo::BroadcastOptions opts(local);
+      opts.setRoot(0);
+      opts.setTag(tag);
+      GENERATE_ALL_TYPES(scalarType, setOutput, opts, flatOutput);
+      gloo::broadcast(opts);
+    }
+
+    int64_t position = 0;
+    for (const auto& ranks : topology->ranksOfNode) {
+      for (const auto rank : ranks) {
+        outputs[rank].copy_(flatOutput[position++]);
+      }
+    }
+  }
+};
+
 } // namespace
 
 // Note: current CUDA implementation holds the assumption that the
@@ -1718,10 +2233,19 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::allgather(
       invalidArgument(c10::str("unsupported device type ", device.type()));
   }
 
-  std::shared_ptr<AsyncAllgatherWork> work;
+  std::shared_ptr<AsyncWork> work;
   auto tag = nextTag();
   auto context = getContext(tag);
-  if (device.type() == at::kCPU) {
+  if (device.type() == at::kCPU && useHierarchical(inputs)) {
+    const auto index = tag % contexts_.size();
+    work = std::make_shared<AsyncHierarchicalAllgatherWork>(
+        topology_,
+        topology_->local[index],
+        topology_->leaders.empty() ? nullptr : topology_->leaders[index],
+        outputs[0],
+        inputs[0],
+        tag);
+  } else if (device.type() == at::kCPU) {
     work = std::make_shared<AsyncAllgatherWork>(
         std::move(context), outputs, inputs, tag);
 #ifdef USE_CUDA
@@ -2,8 +2,10 @@
 
 #include <condition_variable>
 #include <deque>
+#include <map>
 #include <mutex>
 #include <thread>
+#include <tuple>
 #include <unordered_map>
 #include <vector>
 
@@ -129,8 +131,46 @@ class ProcessGroupGloo : public ProcessGroup {
     std::vector<std::shared_ptr<::gloo::transport::Device>> devices;
     std::chrono::milliseconds timeout;
     int threads;
+
+    // Whether allreduce, allgather and broadcast of a single CPU tensor run
+    // in two levels, first among the processes of every node (host), then
+    // among one process per node, so that only the data of the latter
+    // crosses the network. See Topology.
+    bool hierarchical;
+
+    // Devices with GPUDirect RDMA support (see createDeviceForIBVerbs).
+    // If set, the allreduce sum of dense CUDA tensors exchanges their data
+    // from device memory over one context per device instead of staging it
+    // in host memory. These devices only take part in that collective, as
+    // ibverbs devices do not support the other collectives.
+    std::vector<std::shared_ptr<::gloo::transport::Device>> gpuDirectDevices;
+  };
+
+  // The layout of the processes of the group on the nodes, which the
+  // hierarchical algorithms follow. The nodes are identified by the hostname
+  // of their processes and ordered by their lowest rank.
+  struct Topology {
+    // The contexts of the processes of the node of this process, their rank
+    // in them being their order of rank. There is one per context of the
+    // process group, used along with it.
+    std::vector<std::shared_ptr<::gloo::Context>> local;
+
+    // The contexts of the leaders of the nodes, i.e., of the process of
+    // lowest rank of every node, their rank being the index of their node.
+    // Only set on the leaders.
+    std::vector<std::shared_ptr<::gloo::Context>> leaders;
+
+    // The index of the node of this process.
+    int node;
+
+    // For every node, its ranks in increasing order.
+    std::vector<std::vector<int>> ranksOfNode;
   };
 
+  // A GPUDirect allreduce algorithm with the device buffers it reduces.
+  // Defined in ProcessGroupGloo.cpp.
+  struct GPUDirectAllreduce;
+
   // Helper functions to create a new device object.
   // They are static functions on this class to keep them logically
   // separate from the rest of the code base (e.g. torch/csrc/distributed).
@@ -149,6 +189,12 @@ class ProcessGroupGloo : public ProcessGroup {
   // falls back to binding to the loopback address.
   static std::shared_ptr<::gloo::transport::Device> createDefaultDevice();
 
+  // Create new ibverbs device instance for the named InfiniBand device
+  // (e.g. "mlx5_0"), or the first one if the name is empty. Only available
+  // if Gloo was built with ibverbs support (USE_IBVERBS=1).
+  static std::shared_ptr<::gloo::transport::Device> createDeviceForIBVerbs(
+      const std::string& name);
+
   explicit ProcessGroupGloo(
       const std::shared_ptr<Store>& store,
       int rank,
@@ -238,6 +284,53 @@ class ProcessGroupGloo : public ProcessGroup {
   std::vector<std::thread> threads_;
   bool stop_;
 
+  // Set if Options::hierarchical is, and there is more than one node and
+  // more than one process on some node.
+  std::shared_ptr<const Topology> topology_;
+
+  // Exchanges the hostnames of the processes and connects the contexts of
+  // the topology.
+  void initTopology(const Options& options);
+
+  // Whether a collective of these tensors, which the caller checked to be
+  // dense CPU tensors, runs the hierarchical algorithm.
+  bool useHierarchical(const std::vector<at::Tensor>& tensors) const;
+
+  // Contexts over Options::gpuDirectDevices, one per device.
+  std::vector<std::shared_ptr<::gloo::Context>> gpuDirectContexts_;
+
+  // Identifies the GPUDirect allreduce algorithms by the index of their
+  // context, the type and number of elements of the tensors, and their
+  // devices. It is the same on all processes for a collective, so that
+  // they create and reuse their algorithms in the same order.
+  using GPUDirectKey =
+      std::tuple<size_t, at::ScalarType, int64_t, std::vector<int64_t>>;
+
+  // Creating a GPUDirect algorithm registers its buffers with the device,
+  // which is expensive, so they are cached and reused for the collectives
+  // with the same key, e.g., the gradient buckets of every iteration. An
+  // algorithm is used by one collective at a time. If it is still in use,
+  // the next collective with its key waits for it to be released.
+  std::map<GPUDirectKey, std::shared_ptr<GPUDirectAllreduce>> gpuDirectCache_;
+  std::mutex gpuDirectMutex_;
+  std::condition_variable gpuDirectCV_;
+
+  // Whether an allreduce of these dense CUDA tensors runs the GPUDirect
+  // algorithm.
+  bool useGPUDirect(
+      const std::vector<at::Tensor>& tensors,
+      ReduceOp reduceOp) const;
+
+  // Returns the cached GPUDirect algorithm for these tensors and tag, or
+  // creates it, and marks it in use.
+  std::shared_ptr<GPUDirectAllreduce> acquireGPUDirectAllreduce(
+      const std::vector<at::Tensor>& tensors,
+      uint32_t tag);
+
+  // Marks the algorithm as no longer in use.
+  void releaseGPUDirectAllreduce(
+      const std::shared_ptr<GPUDirectAllreduce>& allreduce);
+
   // Incremented for every collective we kick off.
   // The value is used as tag for collective operations. Collectives are kicked
   // off in identical order across processes. Therefore the tag can be used
@@ -1,10 +1,17 @@
 #include <c10d/ProcessGroupMPI.hpp>
 
+#include <algorithm>
+#include <cstdlib>
 #include <limits>
 #include <map>
 
 #include <c10/core/DeviceGuard.h>
 
+#ifdef USE_CUDA
+#include <ATen/cuda/CUDAEvent.h>
+#include <c10/cuda/CUDAStream.h>
+#endif
+
 #if defined(OPEN_MPI) && OPEN_MPI
 #include <mpi-ext.h> // Needed for CUDA-aware check
 #endif
@@ -42,20 +49,39 @@ std::map<at::ScalarType, MPI_Datatype> mpiDatatype = {
     {at::kShort, MPI_SHORT},
 };
 
-// Checking CUDA-aware MPI support, currently we only support CUDA aware
-// MPI ops through Open MPI
+// Checking CUDA-aware MPI support at run time. Open MPI answers through
+// MPIX_Query_cuda_support. MVAPICH2 and Cray MPICH only move device memory
+// when it is enabled in the environment of the job, so we trust the variables
+// that enable it there. The answer does not change during the life of the
+// process and is computed once.
 bool cudaAwareMpiCheck() {
-// Run time check
+  static const bool cudaAware = []() {
 #if defined(MPIX_CUDA_AWARE_SUPPORT)
-  if (MPIX_Query_cuda_support() == 1) {
-    return true;
-  } else {
+    if (MPIX_Query_cuda_support() == 1) {
+      return true;
+    }
+#endif // MPIX_CUDA_AWARE_SUPPORT
+    for (const char* name : {"MV2_USE_CUDA", "MPICH_RDMA_ENABLED_CUDA"}) {
+      const char* value = std::getenv(name);
+      if (value != nullptr && std::string(value) == "1") {
+        return true;
+      }
+    }
     return false;
+  }();
+  return cudaAware;
+}
+
+#ifdef USE_CUDA
+// MPI knows nothing about CUDA streams. Before it touches the memory of a
+// CUDA tensor, the kernels that the caller queued on its current stream
+// must have completed, and for receives, the kernels still reading it too.
+void syncCurrentStream(const at::Tensor& tensor) {
+  if (tensor.is_cuda()) {
+    at::cuda::getCurrentCUDAStream(tensor.device().index()).synchronize();
   }
-#else // !defined(MPIX_CUDA_AWARE_SUPPORT)
-  return false;
-#endif // MPIX_CUDA_AWARE_SUPPORT
 }
+#endif
 
 // Checking the input tensor's validity
 void checkSingleTensorHelper(const at::Tensor& tensor) {
@@ -310,6 +336,30 @@ void ProcessGroupMPI::runLoop() {
 
 std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::enqueue(
     std::unique_ptr<WorkEntry> entry) {
+#ifdef USE_CUDA
+  // The worker thread runs the collectives of CUDA tensors once the work
+  // queued so far on the current stream of the caller is done. It waits for
+  // an event instead of the stream, so that the caller can keep queueing
+  // kernels. Copies the worker makes, e.g. of allgather outputs, go to the
+  // current stream of the worker, which it synchronizes before completing
+  // the work.
+  const auto cudaTensor = std::find_if(
+      entry->src.begin(), entry->src.end(), [](const at::Tensor& tensor) {
+        return tensor.is_cuda();
+      });
+  if (cudaTensor != entry->src.end()) {
+    const auto device = cudaTensor->device();
+    auto event = std::make_shared<at::cuda::CUDAEvent>();
+    event->record(at::cuda::getCurrentCUDAStream(device.index()));
+    auto run = std::move(entry->run);
+    entry->run = [event, device, run](std::unique_ptr<WorkEntry>& workEntry) {
+      event->synchronize();
+      run(workEntry);
+      at::cuda::getCurrentCUDAStream(device.index()).synchronize();
+    };
+  }
+#endif
+
   auto work = std::make_shared<WorkMPI>();
   std::unique_lock<std::mutex> lock(pgMutex_);
   queue_.push_back(std::make_tuple(std::move(entry), work));
@@ -730,6 +780,9 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::send(
 
   auto& tensor = tensors[0];
   MPI_Request request = MPI_REQUEST_NULL;
+#ifdef USE_CUDA
+  syncCurrentStream(tensor);
+#endif
 
   {
     c10::DeviceGuard guard(tensor.device());
@@ -755,6 +808,9 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::recv(
 
   auto& tensor = tensors[0];
   MPI_Request request = MPI_REQUEST_NULL;
+#ifdef USE_CUDA
+  syncCurrentStream(tensor);
+#endif
 
   {
     c10::DeviceGuard guard(tensor.device());
@@ -779,6 +835,9 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupMPI::recvAnysource(
 
   auto& tensor = tensors[0];
   MPI_Request request = MPI_REQUEST_NULL;
+#ifdef USE_CUDA
+  syncCurrentStream(tensor);
+#endif
 
   {
     c10::DeviceGuard guard(tensor.device());
@@ -69,7 +69,10 @@ struct WorkEntry {
 // other words, the size of the input Tensor vector should always be 1.
 //
 // CUDA tensor can be supported if the MPI used is CUDA-aware MPI, and
-// ProcessGroupMPI will automatically detect this support.
+// ProcessGroupMPI will automatically detect this support (Open MPI, and
+// MVAPICH2 or Cray MPICH with CUDA enabled in their environment). The tensors
+// are handed to MPI directly, after the work queued on the current stream of
+// the caller has completed.
 class ProcessGroupMPI : public ProcessGroup {
  public:
   class WorkMPI : public ProcessGroup::Work {
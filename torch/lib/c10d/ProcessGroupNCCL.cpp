@@ -1,19 +1,29 @@
 #include <c10d/ProcessGroupNCCL.hpp>
 
+#include <cstdlib>
 #include <map>
+#include <sstream>
 #include <tuple>
 #include <unordered_set>
 
 #include <THC/THC.h>
 
 #include <ATen/cuda/CUDAContext.h>
+#include <ATen/record_function.h>
 #include <c10/cuda/CUDAGuard.h>
+#include <c10/util/StringUtil.h>
 
 #include <c10d/Utils.hpp>
 namespace c10d {
 
 constexpr const char* const kNCCLAbortedCommStoreKey = "NCCLABORTEDCOMM";
 
+// Set by the process diagnosing a timeout, to ask the others for their
+// sequence numbers, which each writes to its kNCCLSequenceNumbersStoreKey.
+constexpr const char* const kNCCLDiagnoseTimeoutStoreKey =
+    "NCCLDIAGNOSETIMEOUT";
+constexpr const char* const kNCCLSequenceNumbersStoreKey = "NCCLSEQUENCE";
+
 namespace {
 
 // RAII helper class to manage NCCL group API and CUDA free mutex.
@@ -34,6 +44,42 @@ struct AutoNcclGroup {
   }
 };
 
+// Records the enqueue of a collective as a range of the profiler, whose name
+// is the title of the collective and whose inputs are the tensors it
+// communicates. The range is started and ended with the NCCL stream current,
+// so that the CUDA events the profiler records with use_cuda time the
+// collective on the stream it runs on, from the wait for its inputs.
+class CollectiveRecordFunction {
+ public:
+  CollectiveRecordFunction(
+      const char* profilingTitle,
+      const std::vector<at::Tensor>& inputs,
+      const at::cuda::CUDAStream& ncclStream)
+      : ncclStream_(ncclStream) {
+    if (recordFunction_.active) {
+      at::cuda::CUDAStreamGuard guard(ncclStream_);
+      if (recordFunction_.needs_inputs) {
+        recordFunction_.before(
+            profilingTitle,
+            std::vector<c10::IValue>(inputs.begin(), inputs.end()));
+      } else {
+        recordFunction_.before(profilingTitle);
+      }
+    }
+  }
+
+  ~CollectiveRecordFunction() {
+    if (recordFunction_.active) {
+      at::cuda::CUDAStreamGuard guard(ncclStream_);
+      recordFunction_.end();
+    }
+  }
+
+ private:
+  at::RecordFunction recordFunction_;
+  at::cuda::CUDAStream ncclStream_;
+};
+
 // NCCL op mapping
 const std::map<ReduceOp, ncclRedOp_t> ncclOp = {
     {ReduceOp::MIN, ncclMin},
@@ -157,6 +203,11 @@ std::string getNcclAbortedCommStoreKey(const std::string ncclIdStr) {
   return std::string(kNCCLAbortedCommStoreKey) + ":" + ncclIdStr;
 }
 
+std::string getNcclSequenceNumbersStoreKey(int rank) {
+  return std::string(kNCCLSequenceNumbersStoreKey) + ":" +
+      std::to_string(rank);
+}
+
 #ifdef ENABLE_NCCL_P2P_SUPPORT
 ncclResult_t ncclAlltoall(
     void* sendbuff,
@@ -230,6 +281,11 @@ ncclResult_t ncclAlltoallv(
 const int64_t ProcessGroupNCCL::kWatchdogThreadSleepMillis = 10000;
 constexpr int64_t kWaitForAbortCommStoreKey = 1000;
 constexpr int64_t kSynchronizeBusyWaitMillis = 10;
+// How often the watchdog checks the works in flight, when it monitors them.
+constexpr int64_t kWorkMonitorSleepMillis = 1000;
+// How long the watchdog waits for the other processes to answer with their
+// sequence numbers when a collective timed out.
+constexpr int64_t kDiagnoseTimeoutMillis = 5000;
 const int64_t ProcessGroupNCCL::kProcessGroupNCCLOpTimeoutMillis = 10 * 1000;
 
 ProcessGroupNCCL::WorkNCCL::WorkNCCL(const std::vector<at::Device>& devices)
@@ -274,6 +330,19 @@ bool ProcessGroupNCCL::WorkNCCL::finishedGPUExecution() {
   return finishedGPUExecutionInternal();
 }
 
+bool ProcessGroupNCCL::WorkNCCL::timedOut() const {
+  return std::chrono::steady_clock::now() - workStartTime_ > opTimeout_;
+}
+
+std::string ProcessGroupNCCL::WorkNCCL::describe() const {
+  return c10::str(
+      "collective #",
+      seq_,
+      " (",
+      profilingTitle_ ? profilingTitle_ : "unknown",
+      ")");
+}
+
 bool ProcessGroupNCCL::WorkNCCL::finishedGPUExecutionInternal() const {
   for (size_t i = 0; i < devices_.size(); ++i) {
     // Checking the work's corresponding CUDA events' status
@@ -315,6 +384,10 @@ void ProcessGroupNCCL::WorkNCCL::synchronizeStreams() {
 // Waiting on the work's corresponding CUDA events
 void ProcessGroupNCCL::WorkNCCL::synchronizeInternal(
     std::chrono::milliseconds timeout) {
+  TORCH_CHECK(
+      !coalescingPending_,
+      "A coalesced collective can only be waited for after the "
+      "endCoalescing() that launches it");
   synchronizeStreams();
 
   // In case of blocking, wait for the operation to complete.
@@ -344,7 +417,12 @@ void ProcessGroupNCCL::WorkNCCL::synchronizeInternal(
           store_->set(storeKey, {});
           LOG(INFO) << "Wrote aborted communicator id to store: " << storeKey;
         }
-        throw std::runtime_error("Operation timed out!");
+        throw std::runtime_error(c10::str(
+            "Operation timed out! ",
+            describe(),
+            " didn't complete within ",
+            workTimeout.count(),
+            " ms"));
       }
       // Check for errors and throw appropriate exception.
       checkAndThrowException();
@@ -390,16 +468,48 @@ void ProcessGroupNCCL::parseNcclBlockingWait() {
   }
 }
 
+void ProcessGroupNCCL::parseNcclAsyncErrorHandling() {
+  char* asyncErrorHandling = getenv(NCCL_ASYNC_ERROR_HANDLING);
+  if (asyncErrorHandling != nullptr) {
+    auto val = std::stoi(asyncErrorHandling);
+    if (val == 1) {
+      asyncErrorHandling_ = true;
+    } else if (val != 0) {
+      throw std::runtime_error(
+          "Invalid value for environment variable: " +
+          std::string(NCCL_ASYNC_ERROR_HANDLING));
+    }
+  }
+}
+
+ProcessGroupNCCL::Options::Options()
+    : opTimeout(kProcessGroupNCCLOpTimeoutMillis),
+      isHighPriorityStream(false),
+      minChannels(-1),
+      maxChannels(-1) {}
+
 ProcessGroupNCCL::ProcessGroupNCCL(
     const std::shared_ptr<Store>& store,
     int rank,
     int size,
     const std::chrono::milliseconds& opTimeout)
+    : ProcessGroupNCCL(store, rank, size, [&opTimeout] {
+        Options options;
+        options.opTimeout = opTimeout;
+        return options;
+      }()) {}
+
+ProcessGroupNCCL::ProcessGroupNCCL(
+    const std::shared_ptr<Store>& store,
+    int rank,
+    int size,
+    Options options)
     : ProcessGroup(rank, size),
       store_(store),
       ncclCommCounter_(0),
       terminateWatchdog_(false),
-      opTimeout_(opTimeout) {
+      opTimeout_(options.opTimeout),
+      options_(std::move(options)) {
   try {
     parseNcclBlockingWait();
   } catch (std::exception& e) {
@@ -407,6 +517,40 @@ ProcessGroupNCCL::ProcessGroupNCCL(
         "Invalid value for environment variable: " +
         std::string(NCCL_BLOCKING_WAIT));
   }
+  try {
+    parseNcclAsyncErrorHandling();
+  } catch (std::exception& e) {
+    throw std::runtime_error(
+        "Invalid value for environment variable: " +
+        std::string(NCCL_ASYNC_ERROR_HANDLING));
+  }
+  TORCH_CHECK(
+      options_.maxChannels < 0 ||
+          options_.minChannels <= options_.maxChannels,
+      "ProcessGroupNCCL::Options::minChannels (",
+      options_.minChannels,
+      ") must not exceed maxChannels (",
+      options_.maxChannels,
+      ")");
+#ifndef ENABLE_NCCL_COMM_CONFIG
+  TORCH_CHECK(
+      options_.minChannels < 0 && options_.maxChannels < 0,
+      "Configuring the channels of NCCL communicators requires NCCL 2.17+, "
+      "got NCCL ",
+      getNcclVersion());
+#endif
+  for (const auto& device : options_.eagerInitDevices) {
+    TORCH_CHECK(
+        device.is_cuda() && device.has_index(),
+        "ProcessGroupNCCL::Options::eagerInitDevices must be CUDA devices "
+        "with an index, got ",
+        device);
+  }
+  if (!options_.eagerInitDevices.empty()) {
+    getNCCLComm(
+        getKeyFromDevices(options_.eagerInitDevices),
+        options_.eagerInitDevices);
+  }
 
 #ifdef ENABLE_NCCL_ERROR_CHECKING
   ncclCommWatchdogThread_ =
@@ -446,7 +590,12 @@ void ProcessGroupNCCL::ncclCommWatchdog() {
 }
 
 void ProcessGroupNCCL::ncclCommWatchdogInternal() {
+  const bool monitoring = blockingWait_ || asyncErrorHandling_;
   while (!terminateWatchdog_.load()) {
+    if (monitoring) {
+      monitorWork();
+    }
+
     std::unordered_set<std::string> abortedCommIds;
     std::unordered_set<std::string> allCommIds;
 
@@ -464,7 +613,7 @@ void ProcessGroupNCCL::ncclCommWatchdogInternal() {
         if (checkForNCCLErrors(ncclComms)) {
           LOG(INFO) << "Received NCCL errors for communicators in the cache";
 
-          if (blockingWait_) {
+          if (monitoring) {
             LOG(INFO) << "Aborting communicators that received errors";
             // We should not abort the communicators if we are performing a
             // non-blocking wait(). The reason for this is that if we abort the
@@ -492,7 +641,7 @@ void ProcessGroupNCCL::ncclCommWatchdogInternal() {
       }
     }
 
-    if (blockingWait_) {
+    if (monitoring) {
       // When we abort a communicator on one rank, it is likely that might cause
       // other ranks to hang indefinitely. As a result, whenever we abort a
       // communicator, we write its ID to the store. The watchdog on other ranks
@@ -541,11 +690,139 @@ void ProcessGroupNCCL::ncclCommWatchdogInternal() {
     std::unique_lock<std::mutex> lock(watchdogCVMutex_);
     watchdogCV_.wait_for(
         lock,
-        std::chrono::milliseconds(kWatchdogThreadSleepMillis),
+        std::chrono::milliseconds(
+            monitoring ? kWorkMonitorSleepMillis : kWatchdogThreadSleepMillis),
         [&]() -> bool { return terminateWatchdog_.load(); });
   }
 }
 
+void ProcessGroupNCCL::monitorWork() {
+  std::shared_ptr<WorkNCCL> timedOutWork;
+  std::shared_ptr<WorkNCCL> failedWork;
+  {
+    std::lock_guard<std::mutex> lock(workListMutex_);
+    for (auto it = workList_.begin(); it != workList_.end();) {
+      const auto& work = *it;
+      if (work->isCompleted()) {
+        if (work->exception()) {
+          failedWork = failedWork ? failedWork : work;
+        } else if (work->seq_ > lastCompletedSeq_.load()) {
+          lastCompletedSeq_.store(work->seq_);
+        }
+        it = workList_.erase(it);
+      } else {
+        if (!timedOutWork && work->timedOut()) {
+          timedOutWork = work;
+        }
+        ++it;
+      }
+    }
+  }
+
+  if (!publishedSequenceNumbers_ &&
+      store_->check({kNCCLDiagnoseTimeoutStoreKey})) {
+    publishSequenceNumbers();
+  }
+
+  if (timedOutWork && !handledTimeout_) {
+    handledTimeout_ = true;
+    const auto message = diagnoseTimeout(*timedOutWork);
+    LOG(ERROR) << message;
+    // Abort the communicators right away rather than leaving it to wait(),
+    // which only notices the timeout when blocking, and let the other
+    // processes know, see ncclCommWatchdogInternal.
+    for (const auto& ncclComm : timedOutWork->ncclComms_) {
+      ncclComm->ncclCommAbort();
+      const auto commId = buildNcclUniqueIdStr(ncclComm->getNcclId());
+      abortedComms_.emplace(commId);
+      store_->set(getNcclAbortedCommStoreKey(commId), {});
+    }
+    timedOutWork->finish(std::make_exception_ptr(std::runtime_error(message)));
+    failedWork = failedWork ? failedWork : timedOutWork;
+  }
+
+  if (failedWork && asyncErrorHandling_) {
+    std::string what = "unknown error";
+    try {
+      std::rethrow_exception(failedWork->exception());
+    } catch (const std::exception& e) {
+      what = e.what();
+    } catch (...) {
+    }
+    LOG(ERROR) << "Rank " << rank_ << ": " << failedWork->describe()
+               << " failed: " << what << ". Tearing down the process, as "
+               << NCCL_ASYNC_ERROR_HANDLING << " is set.";
+    std::abort();
+  }
+}
+
+void ProcessGroupNCCL::publishSequenceNumbers() {
+  const auto value = c10::str(seq_.load(), " ", lastCompletedSeq_.load());
+  store_->set(
+      getNcclSequenceNumbersStoreKey(rank_),
+      std::vector<uint8_t>(value.begin(), value.end()));
+  publishedSequenceNumbers_ = true;
+}
+
+std::string ProcessGroupNCCL::diagnoseTimeout(const WorkNCCL& work) {
+  std::ostringstream message;
+  message << "Rank " << rank_ << ": " << work.describe()
+          << " timed out after " << opTimeout_.count() << " ms.";
+  try {
+    store_->set(kNCCLDiagnoseTimeoutStoreKey, {});
+    publishSequenceNumbers();
+
+    // The sequence numbers of the last collective each rank called and of
+    // the last one it completed.
+    std::vector<std::string> sequenceNumbers;
+    std::vector<int> laggingRanks;
+    std::vector<int> silentRanks;
+    const auto deadline = std::chrono::steady_clock::now() +
+        std::chrono::milliseconds(kDiagnoseTimeoutMillis);
+    for (int rank = 0; rank < size_; ++rank) {
+      const auto key = getNcclSequenceNumbersStoreKey(rank);
+      bool published = store_->check({key});
+      while (!published && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(
+            std::chrono::milliseconds(10 * kSynchronizeBusyWaitMillis));
+        published = store_->check({key});
+      }
+      if (!published) {
+        silentRanks.push_back(rank);
+        continue;
+      }
+      const auto value = store_->get(key);
+      uint64_t called = 0;
+      uint64_t completed = 0;
+      std::istringstream(std::string(value.begin(), value.end())) >> called >>
+          completed;
+      if (called < work.seq_) {
+        laggingRanks.push_back(rank);
+      }
+      sequenceNumbers.push_back(c10::str(rank, ": ", called, "/", completed));
+    }
+
+    message << " Last collective called/completed by rank: "
+            << c10::Join(", ", sequenceNumbers) << ".";
+    if (!laggingRanks.empty()) {
+      message << " Ranks [" << c10::Join(", ", laggingRanks)
+              << "] didn't call collective #" << work.seq_
+              << " yet, which the other ranks wait for.";
+    }
+    if (!silentRanks.empty()) {
+      message << " Ranks [" << c10::Join(", ", silentRanks)
+              << "] didn't answer within " << kDiagnoseTimeoutMillis
+              << " ms: they may have exited, or not set "
+              << NCCL_BLOCKING_WAIT << " or " << NCCL_ASYNC_ERROR_HANDLING
+              << ".";
+    }
+  } catch (const std::exception& e) {
+    message << " Couldn't get the sequence numbers of the other ranks: "
+            << e.what();
+  }
+  return message.str();
+}
+
 std::exception_ptr ProcessGroupNCCL::WorkNCCL::checkForNCCLErrors(
     const std::vector<std::shared_ptr<NCCLComm>>& ncclComms) const {
   return checkForNCCLErrorsInternal(ncclComms);
@@ -569,15 +846,22 @@ std::exception_ptr ProcessGroupNCCL::checkForNCCLErrorsInternal(
   return nullptr;
 }
 
-void ProcessGroupNCCL::broadcastUniqueNCCLID(ncclUniqueId* ncclID) {
+void ProcessGroupNCCL::broadcastUniqueNCCLID(
+    ncclUniqueId* ncclID,
+    int p2pPeer,
+    const std::string& p2pKey) {
   // For every NCCL communicator that we create we need to broadcast
   // a unique ID from rank 0 to all other ranks. This broadcast is
   // done by rank 0 setting a key in the store and all other ranks
   // retrieving the contents of that key. A single process group
   // may create multiple NCCL communicators, so we use a sequence
-  // number to differentiate between them.
-  std::string storeKey = std::to_string(ncclCommCounter_++);
-  if (rank_ == 0) {
+  // number to differentiate between them. The communicators of a pair of
+  // ranks are only created by the two of them, in an order the others don't
+  // know of: the lower rank broadcasts the ID under the key of the pair.
+  const bool isP2P = p2pPeer >= 0;
+  std::string storeKey =
+      isP2P ? "p2p:" + p2pKey : std::to_string(ncclCommCounter_++);
+  if (isP2P ? rank_ < p2pPeer : rank_ == 0) {
     auto vec = std::vector<uint8_t>(
         reinterpret_cast<uint8_t*>(ncclID),
         reinterpret_cast<uint8_t*>(ncclID) + NCCL_UNIQUE_ID_BYTES);
@@ -591,7 +875,8 @@ void ProcessGroupNCCL::broadcastUniqueNCCLID(ncclUniqueId* ncclID) {
 
 std::vector<std::shared_ptr<NCCLComm>>& ProcessGroupNCCL::getNCCLComm(
     const std::string& devicesKey,
-    const std::vector<at::Device>& devices) {
+    const std::vector<at::Device>& devices,
+    int p2pPeer) {
   // Sanity check
   if (devicesKey.empty()) {
     throw std::runtime_error(
@@ -615,15 +900,21 @@ std::vector<std::shared_ptr<NCCLComm>>& ProcessGroupNCCL::getNCCLComm(
   std::vector<std::shared_ptr<NCCLComm>> ncclComms;
   ncclComms.resize(devices.size());
 
+  // A point-to-point communicator only has this rank and its peer, as rank
+  // 0 and 1 in the order of their ranks in the group.
+  const bool isP2P = p2pPeer >= 0;
+  TORCH_INTERNAL_ASSERT(!isP2P || devices.size() == 1);
+  const int p2pRank = rank_ < p2pPeer ? 0 : 1;
+
   // Create the unique NCCL ID and broadcast it
   ncclUniqueId ncclID;
 
-  if (rank_ == 0) {
+  if (isP2P ? p2pRank == 0 : rank_ == 0) {
     C10D_NCCL_CHECK(ncclGetUniqueId(&ncclID));
   }
 
   // Broadcast so that each process can have a unique NCCL ID
-  broadcastUniqueNCCLID(&ncclID);
+  broadcastUniqueNCCLID(&ncclID, p2pPeer, devicesKey);
 
   at::cuda::OptionalCUDAGuard gpuGuard;
 
@@ -635,14 +926,16 @@ std::vector<std::shared_ptr<NCCLComm>>& ProcessGroupNCCL::getNCCLComm(
 
   for (size_t i = 0; i < devices.size(); ++i) {
     // GPU world size and GPU rank
-    int numRanks = getSize() * devices.size();
-    int rank = getRank() * devices.size() + i;
+    int numRanks = isP2P ? 2 : getSize() * devices.size();
+    int rank = isP2P ? p2pRank : getRank() * devices.size() + i;
 
     gpuGuard.set_index(devices[i].index());
-    ncclComms[i] = NCCLComm::create(numRanks, rank, ncclID);
+    ncclComms[i] = NCCLComm::create(
+        numRanks, rank, ncclID, options_.minChannels, options_.maxChannels);
 
     // Creates the NCCL streams
-    streamVal.push_back(at::cuda::getStreamFromPool());
+    streamVal.push_back(
+        at::cuda::getStreamFromPool(options_.isHighPriorityStream));
   }
 
   C10D_NCCL_CHECK(ncclGroupEnd());
@@ -784,16 +1077,41 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::collective(
     std::vector<at::Tensor>& outputs,
     Fn fn,
     PreProcess pre,
-    PostProcess post) {
+    PostProcess post,
+    const char* profilingTitle) {
   const auto devices = getDeviceList(inputs);
   const auto key = getKeyFromDevices(devices);
+  const bool coalescing = !coalescingStarts_.empty();
+  if (coalescing && !coalescedDevicesKey_.empty()) {
+    TORCH_CHECK(
+        key == coalescedDevicesKey_,
+        "All the collectives coalesced into one group must operate on the "
+        "same devices, got ",
+        key,
+        " after ",
+        coalescedDevicesKey_);
+  }
   auto& ncclComms = getNCCLComm(key, devices);
+  if (coalescing && coalescedDevicesKey_.empty()) {
+    // The NCCL group is only opened once the communicators exist, as they
+    // can't be created inside of it.
+    coalescedDevicesKey_ = key;
+    coalescedDevices_ = devices;
+    C10D_NCCL_CHECK(ncclGroupStart());
+  }
 
   // First let NCCL streams wait for input tensors allocation streams
   syncStreams(devices, ncclEvents_[key], ncclStreams_[key]);
 
+  // When coalescing, the collective only runs once the group is launched,
+  // which endCoalescing records as a range of its own.
+  CollectiveRecordFunction recordFunction(
+      profilingTitle, inputs, ncclStreams_[key][0]);
+
   // Work itself will create the CUDA events on all GPUs of tensors
   auto work = initWork(devices);
+  work->seq_ = ++seq_;
+  work->profilingTitle_ = profilingTitle;
 
   // Store a reference to outputs to be used by WorkNCCL::getFuture.
   work->outputs_ = std::make_shared<std::vector<at::Tensor>>(outputs);
@@ -830,30 +1148,169 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::collective(
 
   post(ncclStreams_[key]);
 
+  if (coalescing) {
+    // The collective is only launched by the ncclGroupEnd() of endCoalescing.
+    work->coalescingPending_ = true;
+    coalescedWorks_.push_back(work);
+    return work;
+  }
+
   // Event should only be recorded after the ncclGroupEnd()
-  for (size_t i = 0; i < inputs.size(); ++i) {
-    at::cuda::CUDAStream& ncclStream = ncclStreams_[key][i];
+  recordWork(work, key, ncclComms);
+
+  return work;
+}
+
+void ProcessGroupNCCL::recordWork(
+    const std::shared_ptr<WorkNCCL>& work,
+    const std::string& devicesKey,
+    const std::vector<std::shared_ptr<NCCLComm>>& ncclComms) {
+  for (size_t i = 0; i < work->devices_.size(); ++i) {
+    at::cuda::CUDAStream& ncclStream = ncclStreams_[devicesKey][i];
     work->cudaEvents_[i].record(ncclStream);
     work->ncclComms_[i] = ncclComms[i];
-    work->blockingWait_ = blockingWait_;
-    work->opTimeout_ = opTimeout_;
-    work->store_ = store_;
   }
+  work->blockingWait_ = blockingWait_;
+  work->opTimeout_ = opTimeout_;
+  work->store_ = store_;
+  work->coalescingPending_ = false;
 
-  return work;
+#ifdef ENABLE_NCCL_ERROR_CHECKING
+  if (blockingWait_ || asyncErrorHandling_) {
+    std::lock_guard<std::mutex> lock(workListMutex_);
+    workList_.push_back(work);
+  }
+#endif
+}
+
+void ProcessGroupNCCL::startCoalescing() {
+  coalescingStarts_.push_back(coalescedWorks_.size());
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::endCoalescing() {
+  TORCH_CHECK(
+      !coalescingStarts_.empty(),
+      "endCoalescing() called without a matching startCoalescing()");
+  const auto start = coalescingStarts_.back();
+  coalescingStarts_.pop_back();
+
+  auto groupWork = initWork(coalescedDevices_);
+  groupWork->seq_ = seq_.load();
+  groupWork->profilingTitle_ = "nccl:coalesced";
+  groupWork->outputs_ = std::make_shared<std::vector<at::Tensor>>();
+  for (auto i = start; i < coalescedWorks_.size(); ++i) {
+    const auto& outputs = *coalescedWorks_[i]->outputs_;
+    groupWork->outputs_->insert(
+        groupWork->outputs_->end(), outputs.begin(), outputs.end());
+  }
+
+  if (!coalescingStarts_.empty()) {
+    // Nested group, launched along with the outermost one.
+    groupWork->coalescingPending_ = true;
+    coalescedGroupWorks_.push_back(groupWork);
+    return groupWork;
+  }
+
+  if (!coalescedDevicesKey_.empty()) {
+    const auto key = std::move(coalescedDevicesKey_);
+    coalescedDevicesKey_.clear();
+    coalescedDevices_.clear();
+    {
+      CollectiveRecordFunction recordFunction(
+          "nccl:coalesced", *groupWork->outputs_, ncclStreams_[key][0]);
+      // See AutoNcclGroup, the kernels of the group are launched here.
+      std::lock_guard<std::mutex> freeLock(
+          *c10::cuda::CUDACachingAllocator::getFreeMutex());
+      C10D_NCCL_CHECK(ncclGroupEnd());
+    }
+    const auto& ncclComms = getNCCLComm(key, groupWork->devices_);
+    for (auto& work : coalescedWorks_) {
+      recordWork(work, key, ncclComms);
+    }
+    for (auto& work : coalescedGroupWorks_) {
+      recordWork(work, key, ncclComms);
+    }
+    recordWork(groupWork, key, ncclComms);
+  }
+  coalescedWorks_.clear();
+  coalescedGroupWorks_.clear();
+
+  return groupWork;
 }
 
 template <typename Fn>
 std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::collective(
     std::vector<at::Tensor>& inputs,
     std::vector<at::Tensor>& outputs,
-    Fn fn) {
+    Fn fn,
+    const char* profilingTitle) {
   return collective(
       inputs,
       outputs,
       fn,
       [](std::vector<at::cuda::CUDAStream>&) {},
-      [](std::vector<at::cuda::CUDAStream>&) {});
+      [](std::vector<at::cuda::CUDAStream>&) {},
+      profilingTitle);
+}
+
+template <typename Fn>
+std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::pointToPoint(
+    at::Tensor& tensor,
+    int peer,
+    int tag,
+    Fn fn,
+    const char* profilingTitle) {
+  TORCH_CHECK(
+      peer >= 0 && peer < size_ && peer != rank_,
+      "Invalid peer rank ",
+      peer,
+      " for rank ",
+      rank_,
+      " of a process group of size ",
+      size_);
+  TORCH_CHECK(
+      coalescingStarts_.empty(), "send and recv can't be coalesced");
+
+  // Every pair of ranks gets a communicator, and so a stream, per tag: the
+  // operations of a tag are ordered, those of different tags aren't, e.g.
+  // activations sent one way don't wait for gradients sent the other way.
+  const std::vector<at::Device> devices{tensor.device()};
+  const auto key = c10::str(
+      getKeyFromDevices(devices),
+      ":",
+      std::min(rank_, peer),
+      ":",
+      std::max(rank_, peer),
+      ":",
+      tag);
+  auto& ncclComms = getNCCLComm(key, devices, peer);
+
+  // See [Sync Streams].
+  syncStreams(devices, ncclEvents_[key], ncclStreams_[key]);
+
+  std::vector<at::Tensor> tensors{tensor};
+  at::cuda::CUDAStream& ncclStream = ncclStreams_[key][0];
+  CollectiveRecordFunction recordFunction(profilingTitle, tensors, ncclStream);
+
+  auto work = initWork(devices);
+  // Point-to-point operations don't take sequence numbers, which are only
+  // the same on all the processes for collectives.
+  work->seq_ = seq_.load();
+  work->profilingTitle_ = profilingTitle;
+  work->outputs_ = std::make_shared<std::vector<at::Tensor>>(tensors);
+
+  at::cuda::OptionalCUDAGuard gpuGuard(tensor.device());
+  c10::cuda::CUDACachingAllocator::recordStream(
+      tensor.storage().data_ptr(), ncclStream);
+  {
+    std::lock_guard<std::mutex> freeLock(
+        *c10::cuda::CUDACachingAllocator::getFreeMutex());
+    C10D_NCCL_CHECK(fn(
+        tensor, ncclComms[0]->getNcclComm(), ncclStream, rank_ < peer ? 1 : 0));
+  }
+
+  recordWork(work, key, ncclComms);
+  return work;
 }
 
 std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allreduce(
@@ -876,14 +1333,40 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allreduce(
             getNcclReduceOp(opts.reduceOp, input),
             comm,
             stream.stream());
-      });
+      },
+      "nccl:all_reduce");
 }
 
 std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allreduce_coalesced(
     std::vector<at::Tensor>& tensors,
     const AllreduceCoalescedOptions& opts) {
-  throw std::runtime_error(
-      "allreduce_coalesced is currently not supported with NCCL");
+  if (tensors.size() == 0) {
+    throw std::runtime_error("Tensor list must be nonempty");
+  }
+  for (const auto& tensor : tensors) {
+    check_gpu_single_tensor(tensor);
+    if (tensor.device() != tensors[0].device()) {
+      throw std::runtime_error(
+          "allreduce_coalesced requires all tensors to be on the same device");
+    }
+  }
+
+  // One ncclAllReduce per tensor, launched as a single group, rather than
+  // flattening the tensors, which would cost two copies and could mix types.
+  AllreduceOptions allreduceOpts;
+  allreduceOpts.reduceOp = opts.reduceOp;
+  allreduceOpts.timeout = opts.timeout;
+  startCoalescing();
+  try {
+    for (auto& tensor : tensors) {
+      std::vector<at::Tensor> single = {tensor};
+      allreduce(single, allreduceOpts);
+    }
+  } catch (...) {
+    endCoalescing();
+    throw;
+  }
+  return endCoalescing();
 }
 
 std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::broadcast(
@@ -906,7 +1389,8 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::broadcast(
             root,
             comm,
             stream.stream());
-      });
+      },
+      "nccl:broadcast");
 }
 
 std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::reduce(
@@ -931,7 +1415,8 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::reduce(
             root,
             comm,
             stream.stream());
-      });
+      },
+      "nccl:reduce");
 }
 
 std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allgather(
@@ -939,6 +1424,10 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allgather(
     std::vector<at::Tensor>& inputTensors,
     const AllgatherOptions& opts) {
   check_gpu_tensors(inputTensors);
+  TORCH_CHECK(
+      coalescingStarts_.empty(),
+      "ProcessGroupNCCL can't coalesce allgather, whose outputs are copied "
+      "after the NCCL call");
 
   auto outputFlattened =
       flatten_for_scatter_gather(outputTensors, inputTensors, size_);
@@ -974,7 +1463,8 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allgather(
             outputTensors[i][j].copy_(outputFlattened[i][j], true);
           }
         }
-      });
+      },
+      "nccl:all_gather");
 }
 
 std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::allgather_coalesced(
@@ -1026,7 +1516,8 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::reduce_scatter(
           }
         }
       },
-      [&](std::vector<at::cuda::CUDAStream>& ncclStreams) {});
+      [&](std::vector<at::cuda::CUDAStream>& ncclStreams) {},
+      "nccl:reduce_scatter");
 }
 
 std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::barrier(
@@ -1096,7 +1587,8 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::alltoall_base(
               getNcclDataType(input.scalar_type()),
               comm,
               stream.stream());
-        });
+        },
+        "nccl:all_to_all");
   } else {
     c10d::checkSplitSizes(inputSplitSizes, inputTensor, size_);
     c10d::checkSplitSizes(outputSplitSizes, outputTensor, size_);
@@ -1128,7 +1620,8 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::alltoall_base(
               getNcclDataType(input.scalar_type()),
               comm,
               stream.stream());
-        });
+        },
+        "nccl:all_to_all");
   }
 }
 #else
@@ -1164,19 +1657,75 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::scatter(
   throw std::runtime_error("ProcessGroupNCCL does not support scatter");
 }
 
+#ifdef ENABLE_NCCL_P2P_SUPPORT
+std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::send(
+    std::vector<at::Tensor>& tensors,
+    int dstRank,
+    int tag) {
+  TORCH_CHECK(
+      tensors.size() == 1, "ProcessGroupNCCL::send takes a single tensor");
+  check_gpu_single_tensor(tensors[0]);
+  return pointToPoint(
+      tensors[0],
+      dstRank,
+      tag,
+      [&](at::Tensor& tensor,
+          ncclComm_t comm,
+          at::cuda::CUDAStream& stream,
+          int peer) {
+        return ncclSend(
+            tensor.data_ptr(),
+            tensor.numel(),
+            getNcclDataType(tensor.scalar_type()),
+            peer,
+            comm,
+            stream.stream());
+      },
+      "nccl:send");
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::recv(
+    std::vector<at::Tensor>& tensors,
+    int srcRank,
+    int tag) {
+  TORCH_CHECK(
+      tensors.size() == 1, "ProcessGroupNCCL::recv takes a single tensor");
+  check_gpu_single_tensor(tensors[0]);
+  return pointToPoint(
+      tensors[0],
+      srcRank,
+      tag,
+      [&](at::Tensor& tensor,
+          ncclComm_t comm,
+          at::cuda::CUDAStream& stream,
+          int peer) {
+        return ncclRecv(
+            tensor.data_ptr(),
+            tensor.numel(),
+            getNcclDataType(tensor.scalar_type()),
+            peer,
+            comm,
+            stream.stream());
+      },
+      "nccl:recv");
+}
+#else
 std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::send(
     std::vector<at::Tensor>& /* unused */,
     int /* unused */,
     int /* unused */) {
-  throw std::runtime_error("ProcessGroupNCCL does not support send");
+  throw std::runtime_error(
+      "ProcessGroupNCCL only supports send for NCCL lib version >= 2.7.0");
 }
 
 std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::recv(
     std::vector<at::Tensor>& /* unused */,
     int /* unused */,
     int /* unused */) {
-  throw std::runtime_error("ProcessGroupNCCL does not support recv");
+  throw std::runtime_error(
+      "ProcessGroupNCCL only supports recv for NCCL lib version >= 2.7.0");
 }
+#endif
 
 std::shared_ptr<ProcessGroup::Work> ProcessGroupNCCL::recvAnysource(
     std::vector<at::Tensor>& /* unused */,
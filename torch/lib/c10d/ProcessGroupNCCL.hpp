@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <list>
 #include <mutex>
 #include <thread>
 #include <unordered_map>
@@ -17,6 +19,12 @@ namespace c10d {
 // non-blocking.
 constexpr const char* NCCL_BLOCKING_WAIT = "NCCL_BLOCKING_WAIT";
 
+// Environment variable which controls whether the watchdog tears down the
+// process when a collective times out or fails, rather than leaving it to
+// hang. When it is set, the watchdog monitors the collectives in flight,
+// which wait() doesn't need to be blocking for.
+constexpr const char* NCCL_ASYNC_ERROR_HANDLING = "NCCL_ASYNC_ERROR_HANDLING";
+
 // ProcessGroupNCCL implements NCCL bindings for c10d.
 //
 // All functions of the class are expected to be called in the same order
@@ -52,6 +60,23 @@ constexpr const char* NCCL_BLOCKING_WAIT = "NCCL_BLOCKING_WAIT";
 //   work->wait()
 //
 //   // Now continue on other work in the current stream.
+//
+// Several collectives can be launched as a single NCCL group, which saves
+// the launch overhead of many small ones:
+//
+//   pg.startCoalescing();
+//   pg.allreduce(tensors0);
+//   pg.broadcast(tensors1);
+//   std::shared_ptr<WorkNCCL> work = pg.endCoalescing();
+//   work->wait();
+//
+// Every collective gets the next sequence number of the process group, which
+// is the same on all the processes since they call the collectives in the
+// same order. With NCCL_BLOCKING_WAIT or NCCL_ASYNC_ERROR_HANDLING, when a
+// collective times out, the watchdog of the process asks the other processes
+// for the sequence numbers of the last collective they called and the last
+// one that completed, through the store, and logs which ranks lag behind
+// before aborting the communicators.
 class ProcessGroupNCCL : public ProcessGroup {
  public:
   class WorkNCCL : public ProcessGroup::Work,
@@ -89,6 +114,12 @@ class ProcessGroupNCCL : public ProcessGroup {
     // It actually returns a FutureNCCL object which is a sub class Future.
     c10::intrusive_ptr<c10::ivalue::Future> getFuture() override;
 
+    // The sequence number of the collective in its process group; that of
+    // the last of its collectives for the work of a coalesced group.
+    uint64_t getSequenceNumber() const {
+      return seq_;
+    }
+
    protected:
     // The cached list of CUDA devices to operate on
     std::vector<at::Device> devices_;
@@ -136,6 +167,23 @@ class ProcessGroupNCCL : public ProcessGroup {
     // Store a reference to NCCL collective's outputs to be used by getFuture.
     std::shared_ptr<std::vector<at::Tensor>> outputs_;
 
+    // Whether the work is part of a coalesced group that wasn't launched yet,
+    // in which case its events aren't recorded and it can't be waited for.
+    bool coalescingPending_ = false;
+
+    // See getSequenceNumber
+    uint64_t seq_ = 0;
+
+    // The name of the collective, e.g. "nccl:all_reduce"
+    const char* profilingTitle_ = nullptr;
+
+    // Whether the work has run for longer than opTimeout_.
+    bool timedOut() const;
+
+    // Describes the collective for the error messages, e.g.
+    // "collective #12 (nccl:all_reduce)".
+    std::string describe() const;
+
     friend class ProcessGroupNCCL;
   };
 
@@ -205,6 +253,31 @@ class ProcessGroupNCCL : public ProcessGroup {
     at::IValue outputs_;
   };
 
+  struct Options {
+    explicit Options();
+
+    // Timeout of the operations, when NCCL_BLOCKING_WAIT is set.
+    std::chrono::milliseconds opTimeout;
+
+    // Runs the NCCL kernels on high priority streams, so that the GPU
+    // schedules their blocks ahead of the ones of the kernels of the other
+    // streams, e.g., for latency critical collectives that would otherwise
+    // wait for bulk compute to drain.
+    bool isHighPriorityStream;
+
+    // Bounds on the number of channels, i.e., of CUDA blocks, of the NCCL
+    // kernels of the group. Fewer channels leave more of the GPU to compute.
+    // -1 leaves it to NCCL. Requires NCCL 2.17+.
+    int minChannels;
+    int maxChannels;
+
+    // If not empty, the constructor creates the communicator of these devices,
+    // which then doesn't delay the first collective on them. As creating a
+    // communicator is collective, all the processes must pass the same
+    // number of devices.
+    std::vector<at::Device> eagerInitDevices;
+  };
+
   // If you wish to create multiple process groups, each with a potentially
   // different rank and size, you can do so by passing a new store instance
   // to each one. If you have only a single store object, you can
@@ -213,7 +286,8 @@ class ProcessGroupNCCL : public ProcessGroup {
   //
   // The process group instance keeps a reference to the store because
   // it may be used long after the constructor runs. In fact, the constructor
-  // doesn't create any NCCL communicators. A single NCCL communicator can
+  // doesn't create any NCCL communicators, unless asked to by
+  // Options::eagerInitDevices. A single NCCL communicator can
   // only be used on a specific set of devices, and are therefore created
   // on-demand when a collective runs. If another collective is executed later,
   // against a different set of devices, the process group creates another NCCL
@@ -226,6 +300,12 @@ class ProcessGroupNCCL : public ProcessGroup {
       const std::chrono::milliseconds& opTimeout =
           std::chrono::milliseconds(kProcessGroupNCCLOpTimeoutMillis));
 
+  ProcessGroupNCCL(
+      const std::shared_ptr<Store>& store,
+      int rank,
+      int size,
+      Options options);
+
   // This constructor includes the deprecated `groupName` argument.
   // If you have existing code that uses the `groupName`, you can replace
   // it by specifying a `c10d::PrefixStore(groupName, store)` for store.
@@ -292,6 +372,23 @@ class ProcessGroupNCCL : public ProcessGroup {
       std::vector<at::Tensor>& inputTensors,
       const AllToAllOptions& opts = AllToAllOptions()) override;
 
+  // Point-to-point communication of a single CUDA tensor, on NCCL 2.7+.
+  // Each pair of ranks gets a communicator and a stream per tag, created by
+  // their first send / recv with the tag, so the operations of a tag are
+  // ordered and those of different tags aren't. A send doesn't complete
+  // before the matching recv starts, so two ranks exchanging tensors both
+  // ways must either order their sends and recvs to match, or use separate
+  // tags for the two directions.
+  std::shared_ptr<ProcessGroup::Work> send(
+      std::vector<at::Tensor>& tensors,
+      int dstRank,
+      int tag) override;
+
+  std::shared_ptr<ProcessGroup::Work> recv(
+      std::vector<at::Tensor>& tensors,
+      int srcRank,
+      int tag) override;
+
   // Unsupported Ops
   std::shared_ptr<ProcessGroup::Work> gather(
       std::vector<std::vector<at::Tensor>>& outputTensors,
@@ -303,31 +400,44 @@ class ProcessGroupNCCL : public ProcessGroup {
       std::vector<std::vector<at::Tensor>>& inputTensors,
       const ScatterOptions& opts = ScatterOptions()) override;
 
-  std::shared_ptr<ProcessGroup::Work> send(
+  std::shared_ptr<ProcessGroup::Work> recvAnysource(
       std::vector<at::Tensor>& tensors,
-      int dstRank,
       int tag) override;
 
-  std::shared_ptr<ProcessGroup::Work> recv(
-      std::vector<at::Tensor>& tensors,
-      int srcRank,
-      int tag) override;
+  // Starts coalescing the collectives called from this thread: instead of
+  // being launched as they're called, they are all launched as one NCCL group
+  // by the matching endCoalescing(), which returns a single work tracking all
+  // of them. The works the collectives return can only be waited for once the
+  // group is launched. All the collectives of a group must operate on the
+  // same devices, and allgather, which needs a copy after the NCCL call,
+  // can't be coalesced. Groups may be nested, in which case only the
+  // outermost one is launched.
+  void startCoalescing();
 
-  std::shared_ptr<ProcessGroup::Work> recvAnysource(
-      std::vector<at::Tensor>& tensors,
-      int tag) override;
+  std::shared_ptr<ProcessGroup::Work> endCoalescing();
+
+  // The sequence number of the last collective called.
+  uint64_t getSequenceNumber() const {
+    return seq_.load();
+  }
 
   static const int64_t kProcessGroupNCCLOpTimeoutMillis;
 
  protected:
-  // Helper that broadcasts nccl unique ID to all ranks through the store
-  void broadcastUniqueNCCLID(ncclUniqueId* ncclID);
+  // Helper that broadcasts nccl unique ID to all ranks through the store, or
+  // to the peer of a point-to-point communicator under its key.
+  void broadcastUniqueNCCLID(
+      ncclUniqueId* ncclID,
+      int p2pPeer = -1,
+      const std::string& p2pKey = "");
 
   // Helper that either looks up the cached NCCL communicators or creates
-  // a new set of NCCL communicators as a cache entry
+  // a new set of NCCL communicators as a cache entry. If p2pPeer isn't -1,
+  // the communicator is that of this rank and p2pPeer only, on one device.
   std::vector<std::shared_ptr<NCCLComm>>& getNCCLComm(
       const std::string& devicesKey,
-      const std::vector<at::Device>& devices);
+      const std::vector<at::Device>& devices,
+      int p2pPeer = -1);
 
   // Wrapper method which can be overridden for tests.
   virtual std::exception_ptr checkForNCCLErrors(
@@ -343,18 +453,36 @@ class ProcessGroupNCCL : public ProcessGroup {
   //    ncclResult_t fn(at::Tensor& input, at::Tensor& output,
   //                    ncclComm_t, at::cuda::CUDAStream&);
   //    void {pre,post}(std::vector<at::cuda::CUDAStream&>);
+  //
+  // `profilingTitle` names the range the profiler records for the
+  // collective, e.g. "nccl:all_reduce".
   template <typename Fn>
   std::shared_ptr<ProcessGroup::Work> collective(
       std::vector<at::Tensor>& input,
       std::vector<at::Tensor>& output,
-      Fn fn);
+      Fn fn,
+      const char* profilingTitle);
   template <typename Fn, typename PreProcess, typename PostProcess>
   std::shared_ptr<ProcessGroup::Work> collective(
       std::vector<at::Tensor>& input,
       std::vector<at::Tensor>& output,
       Fn fn,
       PreProcess pre,
-      PostProcess post);
+      PostProcess post,
+      const char* profilingTitle);
+
+  // Helper of send and recv, which run on the communicator of this rank and
+  // the peer for the tag. The callback has the following signature:
+  //
+  //    ncclResult_t fn(at::Tensor& tensor, ncclComm_t,
+  //                    at::cuda::CUDAStream&, int peerRankInComm);
+  template <typename Fn>
+  std::shared_ptr<ProcessGroup::Work> pointToPoint(
+      at::Tensor& tensor,
+      int peer,
+      int tag,
+      Fn fn,
+      const char* profilingTitle);
 
   // Checks for NCCL errors on each of the communicators and returns an
   // appropriate exception_ptr (nullptr if no errors).
@@ -378,6 +506,31 @@ class ProcessGroupNCCL : public ProcessGroup {
   // accordingly.
   void parseNcclBlockingWait();
 
+  // Reads the NCCL_ASYNC_ERROR_HANDLING environment variable and sets
+  // asyncErrorHandling_ accordingly.
+  void parseNcclAsyncErrorHandling();
+
+  // Called by the watchdog: retires the works in workList_ that completed,
+  // answers the other processes asking for the sequence numbers, and
+  // handles the first work that timed out or failed.
+  void monitorWork();
+
+  // Asks the other processes for their sequence numbers and returns a
+  // message describing the timeout of `work`, which names the ranks that
+  // lag behind.
+  std::string diagnoseTimeout(const WorkNCCL& work);
+
+  // Writes the sequence numbers of this process to the store, for the
+  // process diagnosing a timeout.
+  void publishSequenceNumbers();
+
+  // Records the events of the work on the NCCL streams of the devices and
+  // hands it the state it needs to check for errors and timeouts.
+  void recordWork(
+      const std::shared_ptr<WorkNCCL>& work,
+      const std::string& devicesKey,
+      const std::vector<std::shared_ptr<NCCLComm>>& ncclComms);
+
  protected:
   static const int64_t kWatchdogThreadSleepMillis;
 
@@ -464,14 +617,55 @@ class ProcessGroupNCCL : public ProcessGroup {
   // for the operation to complete.
   bool blockingWait_ = false;
 
-  // Timeout for operations. This is only used when blockingWait_ is enabled.
+  // Timeout for operations. This is only used when blockingWait_ or
+  // asyncErrorHandling_ is enabled.
   std::chrono::milliseconds opTimeout_;
 
+  // Whether the watchdog tears down the process when a collective times out
+  // or fails.
+  bool asyncErrorHandling_ = false;
+
+  // The sequence number of the last collective called, and of the last one
+  // the watchdog saw complete.
+  std::atomic<uint64_t> seq_{0};
+  std::atomic<uint64_t> lastCompletedSeq_{0};
+
+  // The works the watchdog monitors, in the order they were launched, when
+  // blockingWait_ or asyncErrorHandling_ is enabled.
+  std::list<std::shared_ptr<WorkNCCL>> workList_;
+  std::mutex workListMutex_;
+
+  // Only accessed by the watchdog: whether it published the sequence numbers
+  // of this process, and whether it handled a timeout, which it only does
+  // once as the communicators are aborted afterwards.
+  bool publishedSequenceNumbers_ = false;
+  bool handledTimeout_ = false;
+
+  // The options of the NCCL streams and communicators.
+  const Options options_;
+
   // Set of communicators that this process group has aborted and their
   // ncclUniqueId has been written to the store. We don't need a lock
   // for this map since only the watchdog thread accesses this set. The
   // set contains the string representation of ncclUniqueId.
   std::unordered_set<std::string> abortedComms_;
+
+  // The collectives called since the outermost startCoalescing(). Their
+  // events are only recorded once the NCCL group is launched.
+  std::vector<std::shared_ptr<WorkNCCL>> coalescedWorks_;
+
+  // The works returned by the endCoalescing() of nested groups, waiting for
+  // the outermost group to be launched too.
+  std::vector<std::shared_ptr<WorkNCCL>> coalescedGroupWorks_;
+
+  // For every open coalesced group, the index in coalescedWorks_ of its
+  // first collective.
+  std::vector<size_t> coalescingStarts_;
+
+  // The devices of the collectives of the open coalesced groups, empty
+  // until the first one is called, which opens the NCCL group.
+  std::string coalescedDevicesKey_;
+  std::vector<at::Device> coalescedDevices_;
 };
 
 } // namespace c10d
@@ -38,6 +38,26 @@ class Store {
       const std::vector<std::string>& keys,
       const std::chrono::milliseconds& timeout) = 0;
 
+  // Gets the values of several keys, waiting for all of them like `get`.
+  // Stores that can fetch them at once override it, the default gets them
+  // one by one.
+  virtual std::vector<std::vector<uint8_t>> multiGet(
+      const std::vector<std::string>& keys);
+
+  // Sets several keys. Same as above, the default sets them one by one.
+  virtual void multiSet(
+      const std::vector<std::string>& keys,
+      const std::vector<std::vector<uint8_t>>& values);
+
+  // Sets `key` to `desiredValue` if its value is `expectedValue`, a key that
+  // is not set matching an empty `expectedValue`, atomically. Returns the
+  // value of the key after the operation, empty if it is not set. Throws if
+  // the store doesn't support it.
+  virtual std::vector<uint8_t> compareSet(
+      const std::string& key,
+      const std::vector<uint8_t>& expectedValue,
+      const std::vector<uint8_t>& desiredValue);
+
   void setTimeout(const std::chrono::milliseconds& timeout);
 
  protected:
@@ -1,6 +1,9 @@
 #include <c10d/TCPStore.hpp>
 
 #include <poll.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
 
 #include <unistd.h>
 #include <algorithm>
@@ -10,7 +13,38 @@ namespace c10d {
 
 namespace {
 
-enum class QueryType : uint8_t { SET, GET, ADD, CHECK, WAIT };
+enum class QueryType : uint8_t {
+  SET,
+  GET,
+  ADD,
+  CHECK,
+  WAIT,
+  MULTI_GET,
+  MULTI_SET,
+  COMPARE_SET
+};
+
+const char* queryTypeName(QueryType qt) {
+  switch (qt) {
+    case QueryType::SET:
+      return "set";
+    case QueryType::GET:
+      return "get";
+    case QueryType::ADD:
+      return "add";
+    case QueryType::CHECK:
+      return "check";
+    case QueryType::WAIT:
+      return "wait";
+    case QueryType::MULTI_GET:
+      return "multi_get";
+    case QueryType::MULTI_SET:
+      return "multi_set";
+    case QueryType::COMPARE_SET:
+      return "compare_set";
+  }
+  return "unknown";
+}
 
 enum class CheckResponseType : uint8_t { READY, NOT_READY };
 
@@ -54,6 +88,62 @@ void TCPStoreDaemon::join() {
   daemonThread_.join();
 }
 
+#ifdef __linux__
+void TCPStoreDaemon::run() {
+  int epollFd;
+  SYSCHECK_ERR_RETURN_NEG1(epollFd = ::epoll_create1(EPOLL_CLOEXEC));
+  auto watch = [epollFd](int fd) {
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    SYSCHECK_ERR_RETURN_NEG1(::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event));
+  };
+  watch(storeListenSocket_);
+  // The read end of the pipe signals the stopping of the daemon run
+  watch(controlPipeFd_[0]);
+
+  std::vector<struct epoll_event> events(64);
+  bool finished = false;
+  try {
+    while (!finished) {
+      int numEvents;
+      SYSCHECK_ERR_RETURN_NEG1(
+          numEvents = ::epoll_wait(epollFd, events.data(), events.size(), -1));
+      // The sockets closed in this batch of events, whose numbers may already
+      // be reused by the connections accepted in it.
+      std::unordered_set<int> closed;
+      for (int i = 0; i < numEvents; ++i) {
+        const int fd = events[i].data.fd;
+        if (fd == storeListenSocket_) {
+          if (events[i].events ^ EPOLLIN) {
+            throw std::system_error(
+                ECONNABORTED,
+                std::system_category(),
+                "Unexpected epoll event on the master's listening socket: " +
+                    std::to_string(events[i].events));
+          }
+          watch(accept());
+        } else if (fd == controlPipeFd_[0]) {
+          // The pipe hangs up once its write end is closed
+          finished = true;
+          break;
+        } else if (closed.count(fd) == 0 && !handle(fd)) {
+          closed.insert(fd);
+        }
+      }
+      // Grow the batch when it was full, so that a burst of requests from
+      // many clients is drained in few calls.
+      if (numEvents == static_cast<int>(events.size())) {
+        events.resize(events.size() * 2);
+      }
+    }
+  } catch (...) {
+    ::close(epollFd);
+    throw;
+  }
+  ::close(epollFd);
+}
+#else
 void TCPStoreDaemon::run() {
   std::vector<struct pollfd> fds;
   fds.push_back({.fd = storeListenSocket_, .events = POLLIN});
@@ -63,8 +153,8 @@ void TCPStoreDaemon::run() {
   // receive the queries
   bool finished = false;
   while (!finished) {
-    for (size_t i = 0; i < sockets_.size(); i++) {
-      fds[i].revents = 0;
+    for (auto& fd : fds) {
+      fd.revents = 0;
     }
 
     SYSCHECK_ERR_RETURN_NEG1(::poll(fds.data(), fds.size(), -1));
@@ -79,9 +169,7 @@ void TCPStoreDaemon::run() {
             "Unexpected poll revent on the master's listening socket: " +
                 std::to_string(fds[0].revents));
       }
-      int sockFd = std::get<0>(tcputil::accept(storeListenSocket_));
-      sockets_.push_back(sockFd);
-      fds.push_back({.fd = sockFd, .events = POLLIN});
+      fds.push_back({.fd = accept(), .events = POLLIN});
     }
     // The pipe receives an event which tells us to shutdown the daemon
     if (fds[1].revents != 0) {
@@ -103,50 +191,62 @@ void TCPStoreDaemon::run() {
       if (fds[fdIdx].revents == 0) {
         continue;
       }
-
-      // Now query the socket that has the event
-      try {
-        query(fds[fdIdx].fd);
-      } catch (...) {
-        // There was an error when processing query. Probably an exception
-        // occurred in recv/send what would indicate that socket on the other
-        // side has been closed. If the closing was due to normal exit, then
-        // the store should continue executing. Otherwise, if it was different
-        // exception, other connections will get an exception once they try to
-        // use the store. We will go ahead and close this connection whenever
-        // we hit an exception here.
-        ::close(fds[fdIdx].fd);
-
-        // Remove all the tracking state of the close FD
-        for (auto it = waitingSockets_.begin(); it != waitingSockets_.end();) {
-          for (auto vecIt = it->second.begin(); vecIt != it->second.end();) {
-            if (*vecIt == fds[fdIdx].fd) {
-              vecIt = it->second.erase(vecIt);
-            } else {
-              ++vecIt;
-            }
-          }
-          if (it->second.size() == 0) {
-            it = waitingSockets_.erase(it);
-          } else {
-            ++it;
-          }
-        }
-        for (auto it = keysAwaited_.begin(); it != keysAwaited_.end();) {
-          if (it->first == fds[fdIdx].fd) {
-            it = keysAwaited_.erase(it);
-          } else {
-            ++it;
-          }
-        }
+      if (!handle(fds[fdIdx].fd)) {
         fds.erase(fds.begin() + fdIdx);
-        sockets_.erase(sockets_.begin() + fdIdx - 2);
         --fdIdx;
-        continue;
       }
     }
   }
 }
+#endif
+
+int TCPStoreDaemon::accept() {
+  int sockFd = std::get<0>(tcputil::accept(storeListenSocket_));
+  sockets_.insert(sockFd);
+  return sockFd;
+}
+
+bool TCPStoreDaemon::handle(int socket) {
+  try {
+    query(socket);
+    return true;
+  } catch (...) {
+    // There was an error when processing query. Probably an exception
+    // occurred in recv/send what would indicate that socket on the other
+    // side has been closed. If the closing was due to normal exit, then
+    // the store should continue executing. Otherwise, if it was different
+    // exception, other connections will get an exception once they try to
+    // use the store. We will go ahead and close this connection whenever
+    // we hit an exception here.
+    closeSocket(socket);
+    return false;
+  }
+}
+
+void TCPStoreDaemon::closeSocket(int socket) {
+  // Closing the socket also removes it from the epoll set.
+  ::close(socket);
+  sockets_.erase(socket);
+
+  // Remove all the tracking state of the close FD
+  for (auto it = waitingSockets_.begin(); it != waitingSockets_.end();) {
+    auto& waiting = it->second;
+    waiting.erase(
+        std::remove(waiting.begin(), waiting.end(), socket), waiting.end());
+    if (waiting.empty()) {
+      it = waitingSockets_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  keysAwaited_.erase(socket);
+}
+
+std::unordered_map<std::string, TCPStoreRequestStats> TCPStoreDaemon::
+    getStats() const {
+  std::lock_guard<std::mutex> lock(statsMutex_);
+  return stats_;
+}
 
 void TCPStoreDaemon::stop() {
   if (controlPipeFd_[1] != -1) {
@@ -159,11 +259,12 @@ void TCPStoreDaemon::stop() {
 // query communicates with the worker. The format
 // of the query is as follows:
 // type of query | size of arg1 | arg1 | size of arg2 | arg2 | ...
-// or, in the case of wait
-// type of query | number of args | size of arg1 | arg1 | ...
+// or, in the case of wait, check, multi get and multi set
+// type of query | number of keys | size of arg1 | arg1 | ...
 void TCPStoreDaemon::query(int socket) {
   QueryType qt;
   tcputil::recvBytes<QueryType>(socket, &qt, 1);
+  const auto start = std::chrono::steady_clock::now();
 
   if (qt == QueryType::SET) {
     setHandler(socket);
@@ -180,9 +281,27 @@ void TCPStoreDaemon::query(int socket) {
   } else if (qt == QueryType::WAIT) {
     waitHandler(socket);
 
+  } else if (qt == QueryType::MULTI_GET) {
+    multiGetHandler(socket);
+
+  } else if (qt == QueryType::MULTI_SET) {
+    multiSetHandler(socket);
+
+  } else if (qt == QueryType::COMPARE_SET) {
+    compareSetHandler(socket);
+
   } else {
     throw std::runtime_error("Unexpected query type");
   }
+
+  // The latency of a wait only covers its registration, not the wait itself.
+  const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start);
+  std::lock_guard<std::mutex> lock(statsMutex_);
+  auto& stats = stats_[queryTypeName(qt)];
+  ++stats.count;
+  stats.total += elapsed;
+  stats.max = std::max(stats.max, elapsed);
 }
 
 void TCPStoreDaemon::wakeupWaitingClients(const std::string& key) {
@@ -261,6 +380,50 @@ void TCPStoreDaemon::waitHandler(int socket) {
   }
 }
 
+void TCPStoreDaemon::multiGetHandler(int socket) const {
+  SizeType nargs;
+  tcputil::recvBytes<SizeType>(socket, &nargs, 1);
+  for (size_t i = 0; i < nargs; i++) {
+    std::string key = tcputil::recvString(socket);
+    tcputil::sendVector<uint8_t>(
+        socket, tcpStore_.at(key), (i != (nargs - 1)));
+  }
+}
+
+void TCPStoreDaemon::multiSetHandler(int socket) {
+  SizeType nargs;
+  tcputil::recvBytes<SizeType>(socket, &nargs, 1);
+  for (size_t i = 0; i < nargs; i++) {
+    std::string key = tcputil::recvString(socket);
+    tcpStore_[key] = tcputil::recvVector<uint8_t>(socket);
+    wakeupWaitingClients(key);
+  }
+}
+
+void TCPStoreDaemon::compareSetHandler(int socket) {
+  std::string key = tcputil::recvString(socket);
+  std::vector<uint8_t> expectedValue = tcputil::recvVector<uint8_t>(socket);
+  std::vector<uint8_t> desiredValue = tcputil::recvVector<uint8_t>(socket);
+
+  auto pos = tcpStore_.find(key);
+  if (pos == tcpStore_.end()) {
+    if (expectedValue.empty()) {
+      tcpStore_[key] = desiredValue;
+      tcputil::sendVector<uint8_t>(socket, desiredValue);
+      wakeupWaitingClients(key);
+    } else {
+      // The key doesn't exist, there is no current value to return
+      tcputil::sendVector<uint8_t>(socket, std::vector<uint8_t>());
+    }
+  } else if (pos->second == expectedValue) {
+    pos->second = std::move(desiredValue);
+    tcputil::sendVector<uint8_t>(socket, pos->second);
+    wakeupWaitingClients(key);
+  } else {
+    tcputil::sendVector<uint8_t>(socket, pos->second);
+  }
+}
+
 bool TCPStoreDaemon::checkKeys(const std::vector<std::string>& keys) const {
   return std::all_of(keys.begin(), keys.end(), [this](const std::string& s) {
     return tcpStore_.count(s) > 0;
@@ -423,8 +586,69 @@ void TCPStore::waitHelper_(
   }
 }
 
+std::vector<std::vector<uint8_t>> TCPStore::multiGet(
+    const std::vector<std::string>& keys) {
+  std::vector<std::string> regKeys;
+  regKeys.reserve(keys.size());
+  for (const auto& key : keys) {
+    regKeys.push_back(regularPrefix_ + key);
+  }
+  waitHelper_(regKeys, timeout_);
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::MULTI_GET);
+  SizeType nkeys = regKeys.size();
+  tcputil::sendBytes<SizeType>(storeSocket_, &nkeys, 1, (nkeys > 0));
+  for (size_t i = 0; i < nkeys; i++) {
+    tcputil::sendString(storeSocket_, regKeys[i], (i != (nkeys - 1)));
+  }
+  std::vector<std::vector<uint8_t>> values;
+  values.reserve(nkeys);
+  for (size_t i = 0; i < nkeys; i++) {
+    values.push_back(tcputil::recvVector<uint8_t>(storeSocket_));
+  }
+  return values;
+}
+
+void TCPStore::multiSet(
+    const std::vector<std::string>& keys,
+    const std::vector<std::vector<uint8_t>>& values) {
+  if (keys.size() != values.size()) {
+    throw std::invalid_argument(
+        "multiSet expects as many values as keys, got " +
+        std::to_string(values.size()) + " values for " +
+        std::to_string(keys.size()) + " keys");
+  }
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::MULTI_SET);
+  SizeType nkeys = keys.size();
+  tcputil::sendBytes<SizeType>(storeSocket_, &nkeys, 1, (nkeys > 0));
+  for (size_t i = 0; i < nkeys; i++) {
+    tcputil::sendString(storeSocket_, regularPrefix_ + keys[i], true);
+    tcputil::sendVector<uint8_t>(storeSocket_, values[i], (i != (nkeys - 1)));
+  }
+}
+
+std::vector<uint8_t> TCPStore::compareSet(
+    const std::string& key,
+    const std::vector<uint8_t>& expectedValue,
+    const std::vector<uint8_t>& desiredValue) {
+  std::string regKey = regularPrefix_ + key;
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::COMPARE_SET);
+  tcputil::sendString(storeSocket_, regKey, true);
+  tcputil::sendVector<uint8_t>(storeSocket_, expectedValue, true);
+  tcputil::sendVector<uint8_t>(storeSocket_, desiredValue);
+  return tcputil::recvVector<uint8_t>(storeSocket_);
+}
+
 PortType TCPStore::getPort() {
   return tcpStorePort_;
 }
 
+std::unordered_map<std::string, TCPStoreRequestStats> TCPStore::
+    getServerStats() const {
+  if (!isServer_) {
+    throw std::runtime_error(
+        "The request statistics are only available on the server");
+  }
+  return tcpStoreDaemon_->getStats();
+}
+
 } // namespace c10d
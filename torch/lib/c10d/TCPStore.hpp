@@ -1,14 +1,25 @@
 #pragma once
 
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <unordered_map>
+#include <unordered_set>
 
 #include <c10d/Store.hpp>
 #include <c10d/Utils.hpp>
 
 namespace c10d {
 
+// The latency of the requests of a type the daemon handled, from the
+// reception of their type to the sending of their response.
+struct TCPStoreRequestStats {
+  uint64_t count = 0;
+  std::chrono::nanoseconds total{0};
+  std::chrono::nanoseconds max{0};
+};
+
 class TCPStoreDaemon {
  public:
   explicit TCPStoreDaemon(int storeListenSocket);
@@ -16,10 +27,23 @@ class TCPStoreDaemon {
 
   void join();
 
+  // The latency of the requests handled so far, by type of request.
+  std::unordered_map<std::string, TCPStoreRequestStats> getStats() const;
+
  protected:
+  // Waits for the events of the sockets with epoll on Linux, which doesn't
+  // scan all the sockets on every event, and with poll elsewhere.
   void run();
   void stop();
 
+  // Accepts a connection on the listening socket.
+  int accept();
+  // Handles a request on `socket`, and closes it on error, in which case it
+  // returns false.
+  bool handle(int socket);
+  // Closes `socket` and drops the waits of its client.
+  void closeSocket(int socket);
+
   void query(int socket);
 
   void setHandler(int socket);
@@ -27,6 +51,9 @@ class TCPStoreDaemon {
   void getHandler(int socket) const;
   void checkHandler(int socket) const;
   void waitHandler(int socket);
+  void multiGetHandler(int socket) const;
+  void multiSetHandler(int socket);
+  void compareSetHandler(int socket);
 
   bool checkKeys(const std::vector<std::string>& keys) const;
   void wakeupWaitingClients(const std::string& key);
@@ -38,9 +65,12 @@ class TCPStoreDaemon {
   // From socket -> number of keys awaited
   std::unordered_map<int, size_t> keysAwaited_;
 
-  std::vector<int> sockets_;
+  std::unordered_set<int> sockets_;
   int storeListenSocket_;
   std::vector<int> controlPipeFd_{-1, -1};
+
+  mutable std::mutex statsMutex_;
+  std::unordered_map<std::string, TCPStoreRequestStats> stats_;
 };
 
 class TCPStore : public Store {
@@ -69,12 +99,30 @@ class TCPStore : public Store {
       const std::vector<std::string>& keys,
       const std::chrono::milliseconds& timeout) override;
 
+  // Fetches the values in a single request, after waiting for all the keys.
+  std::vector<std::vector<uint8_t>> multiGet(
+      const std::vector<std::string>& keys) override;
+
+  // Sets the keys in a single request.
+  void multiSet(
+      const std::vector<std::string>& keys,
+      const std::vector<std::vector<uint8_t>>& values) override;
+
+  std::vector<uint8_t> compareSet(
+      const std::string& key,
+      const std::vector<uint8_t>& expectedValue,
+      const std::vector<uint8_t>& desiredValue) override;
+
   // Waits for all workers to join.
   void waitForWorkers();
 
   // Returns the port used by the TCPStore.
   PortType getPort();
 
+  // Returns the latency of the requests the server handled, by type of
+  // request. Only available on the server.
+  std::unordered_map<std::string, TCPStoreRequestStats> getServerStats() const;
+
  protected:
   int64_t addHelper_(const std::string& key, int64_t value);
   std::vector<uint8_t> getHelper_(const std::string& key);
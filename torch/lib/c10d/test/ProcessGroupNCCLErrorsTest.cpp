@@ -1,4 +1,5 @@
 #include <chrono>
+#include <thread>
 
 #include <c10d/FileStore.hpp>
 #include <c10d/ProcessGroupNCCL.hpp>
@@ -208,6 +209,38 @@ TEST_F(ProcessGroupNCCLErrorsTest, testNCCLTimedoutErrorsBlocking) {
   // Communicators might be aborted here, further operations would fail.
 }
 
+TEST_F(ProcessGroupNCCLErrorsTest, testNCCLTimedoutErrorsDiagnostics) {
+  if (skipTest()) {
+    return;
+  }
+
+  ASSERT_TRUE(setenv(c10d::NCCL_BLOCKING_WAIT, "1", 1) == 0);
+  ProcessGroupNCCLTimedOutErrors pg(
+      store_, 0, 1, std::chrono::milliseconds(3000));
+
+  auto work = pg.allreduce(tensors_);
+  work->wait();
+  EXPECT_EQ(1, pg.getSequenceNumber());
+
+  pg.set_timedout_error();
+  work = pg.allreduce(tensors_);
+  EXPECT_EQ(2, pg.getSequenceNumber());
+  try {
+    work->wait();
+    FAIL() << "Expected the collective to time out";
+  } catch (const std::runtime_error& e) {
+    EXPECT_NE(
+        std::string(e.what()).find("collective #2 (nccl:all_reduce)"),
+        std::string::npos);
+  }
+
+  // The watchdog, which checks the works every second, asked for the
+  // sequence numbers of the ranks and wrote those of this one.
+  std::this_thread::sleep_for(std::chrono::seconds(5));
+  const auto value = store_->get("NCCLSEQUENCE:0");
+  EXPECT_EQ("2 1", std::string(value.begin(), value.end()));
+}
+
 TEST_F(ProcessGroupNCCLErrorsTest, testNCCLErrorsNonBlocking) {
   if (skipTest()) {
     return;
@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <TH/TH.h>
+#include <c10/util/Exception.h>
+#include <libshm/libshm.h>
+
+namespace {
+
+constexpr size_t kAlignment = 64;
+
+struct ArenaHeader {
+  pid_t creator;
+  char padding[kAlignment - sizeof(pid_t)];
+};
+
+size_t roundUp(size_t nbytes) {
+  return (nbytes + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+} // namespace
+
+// The header of a block, followed by its `size` bytes. The blocks of an arena
+// tile it, so that the next one starts right after the bytes of a block.
+struct THSharedArena::Block {
+  std::atomic<int64_t> refcount;
+  size_t size;
+  char padding[kAlignment - sizeof(std::atomic<int64_t>) - sizeof(size_t)];
+
+  size_t span() const {
+    return sizeof(Block) + size;
+  }
+  bool free() const {
+    return refcount.load(std::memory_order_acquire) == 0;
+  }
+};
+
+static_assert(sizeof(ArenaHeader) == kAlignment, "misaligned arena header");
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+    "the reference counts of the blocks are shared between processes");
+
+namespace {
+
+// The arenas of the current process. A forked child inherits the arenas of
+// its parent, but none of the references the parent counted, so it leaves
+// them alone (and never unmaps them) and starts again.
+struct Registry {
+  pid_t pid = getpid();
+  std::shared_ptr<THSharedArena> own;
+  std::unordered_map<std::string, std::shared_ptr<THSharedArena>> opened;
+};
+
+std::mutex registry_mutex;
+
+Registry& registry() {
+  static Registry* registry = new Registry();
+  if (registry->pid != getpid()) {
+    registry = new Registry();
+  }
+  return *registry;
+}
+
+bool processExists(pid_t pid) {
+  return kill(pid, 0) == 0 || errno != ESRCH;
+}
+
+std::string newArenaHandle() {
+  static std::random_device rd;
+  std::string handle = "/torch_";
+  handle += std::to_string(getpid());
+  handle += "_arena_";
+  handle += std::to_string(rd());
+  return handle;
+}
+
+void deleteTHSharedArenaBlock(void* ptr) {
+  delete static_cast<THSharedArenaBlock*>(ptr);
+}
+
+at::DataPtr makeBlockDataPtr(std::shared_ptr<THSharedArena> arena, size_t offset) {
+  auto* context = new THSharedArenaBlock(std::move(arena), offset);
+  return {context->data(), context, &deleteTHSharedArenaBlock, at::DeviceType::CPU};
+}
+
+} // namespace
+
+THSharedArena::THSharedArena(at::DataPtr mapping, size_t size)
+  : mapping_(std::move(mapping)), size_(size) {}
+
+std::shared_ptr<THSharedArena> THSharedArena::forCurrentProcess(size_t size) {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  auto& own = registry().own;
+  if (!own) {
+    size = roundUp(std::max(size, 2 * sizeof(Block)));
+    int flags = TH_ALLOCATOR_MAPPED_SHAREDMEM | TH_ALLOCATOR_MAPPED_EXCLUSIVE;
+    std::string handle = newArenaHandle();
+    auto mapping = THManagedMapAllocator::makeDataPtr(
+        "", handle.c_str(), flags, sizeof(ArenaHeader) + size);
+    static_cast<ArenaHeader*>(mapping.get())->creator = getpid();
+    own = std::make_shared<THSharedArena>(std::move(mapping), size);
+    // A single free block spans the whole arena.
+    Block* block = own->blockAt(0);
+    block->size = size - sizeof(Block);
+    block->refcount.store(0, std::memory_order_release);
+  }
+  return own;
+}
+
+std::shared_ptr<THSharedArena> THSharedArena::open(const char* manager_handle, const char* handle, size_t size) {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  auto& opened = registry().opened;
+  auto it = opened.find(handle);
+  if (it != opened.end()) {
+    return it->second;
+  }
+  // Free the arenas of the processes that exited, once all the storages they
+  // sent are gone. A process exiting does not close its own arena, which the
+  // torch_shm_manager would only free once all the processes are gone. It is
+  // only worth checking when a new arena gets mapped, e.g., when DataLoader
+  // workers are started again for a new epoch.
+  for (auto arena = opened.begin(); arena != opened.end();) {
+    if (arena->second.use_count() == 1 && !processExists(arena->second->creator())) {
+      shm_unlink(arena->first.c_str());
+      arena = opened.erase(arena);
+    } else {
+      ++arena;
+    }
+  }
+  int flags = TH_ALLOCATOR_MAPPED_SHAREDMEM | TH_ALLOCATOR_MAPPED_NOCREATE;
+  auto mapping = THManagedMapAllocator::makeDataPtr(
+      manager_handle, handle, flags, sizeof(ArenaHeader) + size);
+  auto arena = std::make_shared<THSharedArena>(std::move(mapping), size);
+  opened.emplace(handle, arena);
+  return arena;
+}
+
+at::DataPtr THSharedArena::allocate(size_t nbytes) {
+  const size_t needed = roundUp(std::max<size_t>(nbytes, 1));
+  std::lock_guard<std::mutex> lock(mutex_);
+  TORCH_CHECK(creator() == getpid(),
+      "Only the process that created a shared arena may allocate from it");
+  // Next fit: look for a free block from the one following the last
+  // allocation, merging every free block with the free ones following it, and
+  // give up after going once round the arena. The other processes only ever
+  // drop references, so a free block stays free until it is handed out here.
+  size_t offset = cursor_;
+  size_t walked = 0;
+  while (walked < size_) {
+    Block* block = blockAt(offset);
+    if (block->free()) {
+      size_t next = offset + block->span();
+      while (block->size < needed && next != size_ && blockAt(next)->free()) {
+        block->size += blockAt(next)->span();
+        next = offset + block->span();
+      }
+      if (block->size >= needed) {
+        if (block->size >= needed + 2 * sizeof(Block)) {
+          Block* rest = blockAt(offset + sizeof(Block) + needed);
+          rest->size = block->size - needed - sizeof(Block);
+          rest->refcount.store(0, std::memory_order_relaxed);
+          block->size = needed;
+        }
+        block->refcount.store(1, std::memory_order_release);
+        cursor_ = (offset + block->span()) % size_;
+        return makeBlockDataPtr(shared_from_this(), offset);
+      }
+    }
+    walked += block->span();
+    offset = (offset + block->span()) % size_;
+  }
+  // Merging may have swallowed the block the search started from.
+  cursor_ = offset;
+  return at::DataPtr();
+}
+
+at::DataPtr THSharedArena::block(size_t offset) {
+  TORCH_CHECK(offset % kAlignment == 0 && offset + sizeof(Block) <= size_,
+      "Invalid offset ", offset, " of a block of a shared arena of ", size_, " bytes");
+  TORCH_CHECK(!blockAt(offset)->free(),
+      "The block at offset ", offset, " of a shared arena was freed");
+  auto data_ptr = makeBlockDataPtr(shared_from_this(), offset);
+  static_cast<THSharedArenaBlock*>(data_ptr.get_context())->incref();
+  return data_ptr;
+}
+
+const char* THSharedArena::manager_handle() const {
+  return THManagedMapAllocator::fromDataPtr(mapping_)->manager_handle();
+}
+
+const char* THSharedArena::handle() const {
+  return THManagedMapAllocator::fromDataPtr(mapping_)->filename();
+}
+
+pid_t THSharedArena::creator() const {
+  return static_cast<const ArenaHeader*>(mapping_.get())->creator;
+}
+
+THSharedArena::Block* THSharedArena::blockAt(size_t offset) const {
+  static_assert(sizeof(Block) == kAlignment, "misaligned arena block");
+  return reinterpret_cast<Block*>(
+      static_cast<char*>(mapping_.get()) + sizeof(ArenaHeader) + offset);
+}
+
+THSharedArenaBlock::THSharedArenaBlock(std::shared_ptr<THSharedArena> arena, size_t offset)
+  : arena_(std::move(arena)), offset_(offset) {}
+
+THSharedArenaBlock::~THSharedArenaBlock() {
+  decref();
+}
+
+void THSharedArenaBlock::incref() {
+  arena_->blockAt(offset_)->refcount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void THSharedArenaBlock::decref() {
+  arena_->blockAt(offset_)->refcount.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void* THSharedArenaBlock::data() const {
+  return arena_->blockAt(offset_) + 1;
+}
+
+THSharedArenaBlock* THSharedArenaBlock::fromDataPtr(const at::DataPtr& dptr) {
+  return dptr.cast_context<THSharedArenaBlock>(&deleteTHSharedArenaBlock);
+}
@@ -4,6 +4,10 @@
 
 #ifdef __cplusplus
 
+#include <memory>
+#include <mutex>
+#include <sys/types.h>
+
 void libshm_init(const char *manager_exec_path);
 
 // Superclass to run a constructor before THRefcountedMapAllocator
@@ -30,4 +34,69 @@ public:
   const char* manager_handle() const { return manager_handle_.c_str(); }
 };
 
+// A large region of shared memory, mapped once in every process using it,
+// that a process allocates the storages it sends to other processes from.
+// Sending such a storage only sends its offset in the arena, so that it costs
+// neither a file descriptor nor a mapping of its own. Every block of the arena
+// counts, in shared memory, the storages of all the processes referring to
+// it, and the process that created the arena reuses the block once the count
+// drops to zero. Only the creating process allocates or splits blocks.
+class THSharedArena : public std::enable_shared_from_this<THSharedArena> {
+public:
+  // Returns the arena of the current process, creating one of `size` bytes if
+  // the process has none yet.
+  static std::shared_ptr<THSharedArena> forCurrentProcess(size_t size);
+  // Returns the arena `handle` of another process, mapping it if the current
+  // process has not yet.
+  static std::shared_ptr<THSharedArena> open(const char* manager_handle, const char* handle, size_t size);
+
+  // Returns a block of at least `nbytes` bytes of the arena, or a null DataPtr
+  // if there is no free block that large.
+  at::DataPtr allocate(size_t nbytes);
+  // Returns a new reference to the allocated block at `offset`.
+  at::DataPtr block(size_t offset);
+
+  const char* manager_handle() const;
+  const char* handle() const;
+  size_t size() const { return size_; }
+  pid_t creator() const;
+
+  THSharedArena(at::DataPtr mapping, size_t size);
+
+private:
+  friend class THSharedArenaBlock;
+  struct Block;
+
+  Block* blockAt(size_t offset) const;
+
+  at::DataPtr mapping_;
+  size_t size_;
+  // The offset of the block to look for a free one from, the one following the
+  // last allocation.
+  size_t cursor_ = 0;
+  std::mutex mutex_;
+};
+
+// The context of the DataPtr of a block of a THSharedArena, which holds one
+// reference to the block.
+class THSharedArenaBlock {
+public:
+  THSharedArenaBlock(std::shared_ptr<THSharedArena> arena, size_t offset);
+  ~THSharedArenaBlock();
+
+  // Adds or drops a reference to the block on behalf of another process.
+  void incref();
+  void decref();
+
+  const THSharedArena& arena() const { return *arena_; }
+  size_t offset() const { return offset_; }
+  void* data() const;
+
+  static THSharedArenaBlock* fromDataPtr(const at::DataPtr&);
+
+private:
+  std::shared_ptr<THSharedArena> arena_;
+  size_t offset_;
+};
+
 #endif
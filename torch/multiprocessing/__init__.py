@@ -19,7 +19,7 @@ from .reductions import init_reductions
 import multiprocessing
 
 __all__ = ['set_sharing_strategy', 'get_sharing_strategy',
-           'get_all_sharing_strategies']
+           'get_all_sharing_strategies', 'set_arena_size', 'get_arena_size']
 
 
 from multiprocessing import *
@@ -50,7 +50,9 @@ if sys.platform == 'darwin' or sys.platform == 'win32':
     _all_sharing_strategies = {'file_system'}
 else:
     _sharing_strategy = 'file_descriptor'
-    _all_sharing_strategies = {'file_descriptor', 'file_system'}
+    _all_sharing_strategies = {'file_descriptor', 'file_system', 'arena'}
+
+_arena_size = 128 * 1024 * 1024
 
 
 def set_sharing_strategy(new_strategy):
@@ -75,4 +77,21 @@ def get_all_sharing_strategies():
     return _all_sharing_strategies
 
 
+def set_arena_size(new_size):
+    """Sets the size of the shared memory arena of every process that is
+    created from now on, for the ``arena`` sharing strategy.
+
+    Arguments:
+        new_size (int): Size of the arena, in bytes.
+    """
+    global _arena_size
+    assert new_size > 0
+    _arena_size = int(new_size)
+
+
+def get_arena_size():
+    """Returns the size of the shared memory arena of a process, in bytes."""
+    return _arena_size
+
+
 init_reductions()
@@ -300,15 +300,33 @@ def rebuild_storage_filename(cls, manager, handle, size):
     return storage._shared_decref()
 
 
+def rebuild_storage_arena(cls, manager, handle, arena_size, offset, size):
+    storage = storage_from_cache(cls, (handle, offset))
+    if storage is not None:
+        return storage._shared_decref()
+    storage = cls._new_shared_arena(manager, handle, arena_size, offset, size)
+    shared_cache[(handle, offset)] = StorageWeakRef(storage)
+    return storage._shared_decref()
+
+
 def rebuild_storage_empty(cls):
     return cls()
 
 
 def reduce_storage(storage):
-    from . import get_sharing_strategy
+    from . import get_sharing_strategy, get_arena_size
     if storage.is_cuda:
         raise RuntimeError("Cannot pickle CUDA storage; try pickling a CUDA tensor instead")
-    elif get_sharing_strategy() == 'file_system':
+    elif get_sharing_strategy() == 'arena' and storage.size() > 0:
+        # Storages that are in shared memory already, or that do not fit in
+        # the arena, are shared through file descriptors instead
+        metadata = storage._share_arena_(get_arena_size())
+        if metadata is not None:
+            storage._shared_incref()
+            shared_cache[(metadata[1], metadata[3])] = StorageWeakRef(storage)
+            return (rebuild_storage_arena, (type(storage),) + metadata)
+
+    if get_sharing_strategy() == 'file_system':
         metadata = storage._share_filename_()
         cache_key = metadata[1]
         rebuild = rebuild_storage_filename
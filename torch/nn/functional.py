@@ -2406,11 +2406,36 @@ def kl_div(input, target, size_average=None, reduce=None, reduction='mean', log_
     return reduced
 
 
+def _cross_entropy_decomposed(input, target, weight, ignore_index, reduction, label_smoothing):
+    # type: (Tensor, Tensor, Optional[Tensor], int, str, float) -> Tensor
+    # cross_entropy written with log_softmax and nll_loss, which materializes
+    # the log-probabilities but is made of operators every exporter knows.
+    log_probs = log_softmax(input, 1)
+    loss = nll_loss(log_probs, target, weight, None, ignore_index, None, reduction)
+    if label_smoothing == 0.0:
+        return loss
+    n_classes = input.size(1)
+    if weight is None:
+        class_weight = torch.ones(n_classes, dtype=input.dtype, device=input.device)
+    else:
+        class_weight = weight
+    shape = [1, n_classes] + [1] * (input.dim() - 2)
+    mask = target != ignore_index
+    smooth_loss = -(log_probs * class_weight.view(shape)).sum(1).masked_fill(~mask, 0.0) / n_classes
+    if reduction == 'sum':
+        smooth_loss = smooth_loss.sum()
+    elif reduction == 'mean':
+        total_weight = class_weight[target.masked_fill(~mask, 0)].masked_fill(~mask, 0.0).sum()
+        smooth_loss = smooth_loss.sum() / total_weight
+    return (1 - label_smoothing) * loss + label_smoothing * smooth_loss
+
+
 def cross_entropy(input, target, weight=None, size_average=None, ignore_index=-100,
-                  reduce=None, reduction='mean'):
-    # type: (Tensor, Tensor, Optional[Tensor], Optional[bool], int, Optional[bool], str) -> Tensor
-    r"""This criterion combines `log_softmax` and `nll_loss` in a single
-    function.
+                  reduce=None, reduction='mean', label_smoothing=0.0):
+    # type: (Tensor, Tensor, Optional[Tensor], Optional[bool], int, Optional[bool], str, float) -> Tensor
+    r"""This criterion computes the cross entropy between the softmax of
+    `input` and `target`, like `log_softmax` followed by `nll_loss`, without
+    materializing the log-probabilities.
 
     See :class:`~torch.nn.CrossEntropyLoss` for details.
 
@@ -2441,6 +2466,11 @@ def cross_entropy(input, target, weight=None, size_average=None, ignore_index=-1
             elements in the output, ``'sum'``: the output will be summed. Note: :attr:`size_average`
             and :attr:`reduce` are in the process of being deprecated, and in the meantime,
             specifying either of those two args will override :attr:`reduction`. Default: ``'mean'``
+        label_smoothing (float, optional): A float in [0.0, 1.0]. Specifies the amount
+            of smoothing when computing the loss, where 0.0 means no smoothing. The targets
+            become a mixture of the original ground truth and a uniform distribution as
+            described in `Rethinking the Inception Architecture for Computer Vision
+            <https://arxiv.org/abs/1512.00567>`__. Default: :math:`0.0`.
 
     Examples::
 
@@ -2455,10 +2485,15 @@ def cross_entropy(input, target, weight=None, size_average=None, ignore_index=-1
             return handle_torch_function(
                 cross_entropy, tens_ops, input, target, weight=weight,
                 size_average=size_average, ignore_index=ignore_index, reduce=reduce,
-                reduction=reduction)
+                reduction=reduction, label_smoothing=label_smoothing)
     if size_average is not None or reduce is not None:
         reduction = _Reduction.legacy_get_string(size_average, reduce)
-    return nll_loss(log_softmax(input, 1), target, weight, None, ignore_index, None, reduction)
+    if not torch.jit.is_scripting() and torch._C._get_tracing_state():
+        # keep traced graphs, and the models exported from them, in terms of
+        # log_softmax and nll_loss
+        return _cross_entropy_decomposed(input, target, weight, ignore_index, reduction, label_smoothing)
+    return torch._C._nn.cross_entropy_loss(input, target, weight, _Reduction.get_enum(reduction),
+                                           ignore_index, label_smoothing)
 
 
 def binary_cross_entropy(input, target, weight=None, size_average=None,
@@ -4119,6 +4154,21 @@ def multi_head_attention_forward(query,                           # type: Tensor
         if key_padding_mask is not None:
             key_padding_mask = pad(key_padding_mask, (0, 1))
 
+    # Without the attention weights to return, nor an attention mask or dropout
+    # to apply to them, nor gradients to compute, the attention is computed head
+    # by head over blocks of keys, without the (tgt_len, src_len) weights.
+    if not need_weights and attn_mask is None and (dropout_p == 0. or not training) and \
+            not (q.requires_grad or k.requires_grad or v.requires_grad) and \
+            (not q.is_cuda or head_dim <= 128):
+        attn_output = torch._fused_attention(
+            q.reshape(bsz, num_heads, tgt_len, head_dim),
+            k.reshape(bsz, num_heads, src_len, head_dim),
+            v.reshape(bsz, num_heads, src_len, head_dim),
+            key_padding_mask, causal=False, scale=1.)
+        attn_output = attn_output.permute(2, 0, 1, 3).reshape(tgt_len, bsz, embed_dim)
+        attn_output = linear(attn_output, out_proj_weight, out_proj_bias)
+        return attn_output, None
+
     attn_output_weights = torch.bmm(q, k.transpose(1, 2))
     assert list(attn_output_weights.size()) == [bsz * num_heads, tgt_len, src_len]
 
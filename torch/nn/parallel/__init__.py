@@ -1,10 +1,11 @@
 from .parallel_apply import parallel_apply
+from .branches import parallel_branches
 from .replicate import replicate
 from .data_parallel import DataParallel, data_parallel
 from .scatter_gather import scatter, gather
 from .distributed import DistributedDataParallel
 
-__all__ = ['replicate', 'scatter', 'parallel_apply', 'gather', 'data_parallel',
+__all__ = ['replicate', 'scatter', 'parallel_apply', 'parallel_branches', 'gather', 'data_parallel',
            'DataParallel', 'DistributedDataParallel']
 
 def DistributedDataParallelCPU(*args, **kwargs):
@@ -0,0 +1,71 @@
+import torch
+
+
+def _tensors(obj):
+    if isinstance(obj, torch.Tensor):
+        yield obj
+    elif isinstance(obj, (list, tuple)):
+        for item in obj:
+            yield from _tensors(item)
+    elif isinstance(obj, dict):
+        for item in obj.values():
+            yield from _tensors(item)
+
+
+def parallel_branches(branches, *inputs):
+    r"""Runs independent branches on the same inputs concurrently on one
+    CUDA device, each on a stream from the pool of the device.
+
+    Every branch is called as ``branch(*inputs)`` and queues its kernels on a
+    stream of its own, which first waits for the work queued on the current
+    stream, e.g., the kernels producing :attr:`inputs`. Once all branches
+    are queued, the current stream waits for all of them, so the outputs can
+    be used on it like the outputs of any other op. The backward of each
+    branch runs on its stream as well (see :ref:`cuda-semantics`),
+    so the branches also overlap in backward.
+
+    This pays off when the kernels of each branch are too small to fill the
+    GPU, e.g., for the towers of a multi-task head. The branches must not
+    depend on each other, and they run on the calling thread, so their CPU
+    work is not overlapped. If no input is a CUDA tensor, the branches run
+    one after the other.
+
+    Args:
+        branches (iterable of callables): the branches, e.g., modules.
+        inputs: the arguments of every branch.
+
+    Returns:
+        The list of the outputs of the branches.
+
+    Example::
+
+        >>> heads = nn.ModuleList([nn.Linear(64, 8) for _ in range(8)]).cuda()
+        >>> x = torch.randn(32, 64, device='cuda')
+        >>> outputs = nn.parallel.parallel_branches(heads, x)
+    """
+    branches = list(branches)
+    device = next((t.device for t in _tensors(inputs) if t.is_cuda), None)
+    if device is None or len(branches) < 2:
+        return [branch(*inputs) for branch in branches]
+
+    with torch.cuda.device(device):
+        current_stream = torch.cuda.current_stream()
+        outputs = []
+        streams = []
+        for branch in branches:
+            stream = torch.cuda.Stream()
+            stream.wait_stream(current_stream)
+            with torch.cuda.stream(stream):
+                outputs.append(branch(*inputs))
+            streams.append(stream)
+
+        # The join: the outputs were allocated on the branch streams, so they
+        # are marked as used on the current stream, which keeps the caching
+        # allocator from handing out their memory to the branch streams while
+        # the current stream still uses it.
+        for stream, output in zip(streams, outputs):
+            current_stream.wait_stream(stream)
+            for t in _tensors(output):
+                if t.is_cuda and t.device == device:
+                    t.record_stream(current_stream)
+    return outputs
@@ -0,0 +1,4 @@
+from typing import Any, Callable, Iterable, List
+
+
+def parallel_branches(branches: Iterable[Callable[..., Any]], *inputs: Any) -> List[Any]: ...
@@ -43,6 +43,7 @@ def _dump_DDP_relevant_env_vars():
         "GLOO_DEVICE_TRANSPORT",
         "NCCL_SOCKET_IFNAME",
         "NCCL_BLOCKING_WAIT",
+        "NCCL_ASYNC_ERROR_HANDLING",
         "NCCL_DEBUG",
         "NCCL_DEBUG_SUBSYS",
         "NCCL_IB_DISABLE",
@@ -314,6 +315,30 @@ class DistributedDataParallel(Module):
                          are getting different gradients, which should not
                          happen if DistributedDataParallel is correctly used.
                          (default: ``False``)
+        gradient_as_bucket_view (bool): When set to ``True``, gradients will be views
+                      pointing to different offsets of the flat ``allreduce``
+                      communication buckets. ``AccumulateGrad`` then accumulates
+                      into the buckets directly, and the reduced gradients do not
+                      need to be copied back out of them, which saves the memory
+                      of the gradients and two copies per iteration. As the
+                      gradients are views, ``detach_()`` cannot be called on
+                      them; :meth:`torch.optim.Optimizer.zero_grad` and
+                      :meth:`torch.nn.Module.zero_grad` handle this. Replacing a
+                      gradient by another tensor is allowed, the next iteration
+                      copies it back into its bucket. (default: ``False``)
+        bucket_tuning_iterations (int): When positive, the buckets are chosen
+                      from a profile of that many first iterations, rather
+                      than from the order of the gradients of the first one:
+                      DDP measures when every gradient is ready, and the
+                      latency and bandwidth of an allreduce, and picks the
+                      buckets that let the reduction finish the earliest,
+                      each still at most ``bucket_cap_mb``. This usually
+                      yields a small first bucket and larger later ones. With
+                      ``find_unused_parameters=True``, the profile restarts
+                      whenever the set of used parameters changes. The
+                      chosen buckets are logged at info level on rank 0, and
+                      returned by ``reducer.get_bucket_layout()``.
+                      (default: ``0``)
 
     Attributes:
         module (Module): the module to be parallelized
@@ -328,7 +353,9 @@ class DistributedDataParallel(Module):
                  process_group=None,
                  bucket_cap_mb=25,
                  find_unused_parameters=False,
-                 check_reduction=False):
+                 check_reduction=False,
+                 gradient_as_bucket_view=False,
+                 bucket_tuning_iterations=0):
 
         super(DistributedDataParallel, self).__init__()
 
@@ -375,6 +402,8 @@ class DistributedDataParallel(Module):
         self.module = module
         self.broadcast_buffers = broadcast_buffers
         self.find_unused_parameters = find_unused_parameters
+        self.gradient_as_bucket_view = gradient_as_bucket_view
+        self.bucket_tuning_iterations = bucket_tuning_iterations
         self.require_backward_grad_sync = True
         self.require_forward_param_sync = True
 
@@ -395,7 +424,8 @@ class DistributedDataParallel(Module):
         if len(module_states) > 0:
             self._distributed_broadcast_coalesced(
                 module_states,
-                self.broadcast_bucket_size)
+                self.broadcast_bucket_size,
+                self._module_states_broadcast_algorithm(module_states))
 
         self._ddp_init_helper()
 
@@ -509,7 +539,9 @@ class DistributedDataParallel(Module):
             self.process_group,
             expect_sparse_gradient,
             self.bucket_bytes_cap,
-            self.find_unused_parameters)
+            self.find_unused_parameters,
+            self.gradient_as_bucket_view,
+            self.bucket_tuning_iterations)
 
         # passing a handle to torch.nn.SyncBatchNorm layer
         self._passing_sync_batchnorm_handle(self._module_copies)
@@ -527,6 +559,8 @@ class DistributedDataParallel(Module):
         super(DistributedDataParallel, self).__setstate__(state)
         self.__dict__.setdefault('require_forward_param_sync', True)
         self.__dict__.setdefault('require_backward_grad_sync', True)
+        self.__dict__.setdefault('gradient_as_bucket_view', False)
+        self.__dict__.setdefault('bucket_tuning_iterations', 0)
         self._ddp_init_helper()
 
     def _check_default_group(self):
@@ -699,8 +733,67 @@ class DistributedDataParallel(Module):
         self._check_comm_hook(hook)
         dist._register_comm_hook(self.reducer, state, hook)
 
-    def _distributed_broadcast_coalesced(self, tensors, buffer_size):
-        dist._broadcast_coalesced(self.process_group, tensors, buffer_size)
+    def _register_builtin_comm_hook(self, comm_hook_type, powersgd_rank=1, topk_ratio=0.01):
+        r"""
+        Register one of the communication hooks implemented in C++, which run
+        without the GIL and communicate over the process group of DDP.
+
+        Arguments:
+            comm_hook_type (dist.BuiltinCommHookType): the hook to register:
+
+                * ``ALLREDUCE``: the default allreduce, as a hook.
+                * ``FP16_COMPRESS``: allreduces the gradients cast to
+                  ``torch.float16``, halving the bytes sent.
+                * ``BF16_COMPRESS``: same in ``torch.bfloat16``, which keeps the
+                  range of ``torch.float32``. Requires the NCCL backend.
+                * ``POWER_SGD``: allreduces a low-rank approximation of every
+                  bucket seen as a square matrix, computed by one step of power
+                  iteration warm-started from the previous iteration, and keeps
+                  the approximation error to add it to the next gradients.
+                * ``TOP_K``: allgathers only the entries of largest magnitude of
+                  every bucket, with their indices, and keeps the others to add
+                  them to the next gradients.
+
+            powersgd_rank (int): the rank of the ``POWER_SGD`` approximation.
+                Default: ``1``.
+            topk_ratio (float): the fraction of the entries of every bucket
+                ``TOP_K`` sends, in (0, 1]. Default: ``0.01``.
+
+        .. warning ::
+            The same restrictions as :meth:`_register_comm_hook` apply: a hook
+            can only be registered once, before calling backward, and only in
+            single process single device mode. The compressing hooks don't
+            support sparse gradients.
+
+        .. warning ::
+            ``POWER_SGD`` and ``TOP_K`` change the gradients the optimizer sees
+            and may require tuning the learning rate. Their second round of
+            communication, if any, runs at the end of backward.
+
+        Example::
+            >>> ddp._register_builtin_comm_hook(dist.BuiltinCommHookType.POWER_SGD, powersgd_rank=4)
+        """
+        dist._register_builtin_comm_hook(self.reducer, comm_hook_type, powersgd_rank, topk_ratio)
+
+    def _module_states_broadcast_algorithm(self, module_states):
+        # The backends whose broadcast is a tree send the whole state over
+        # log(world_size) hops, while a scatter followed by an allgather sends
+        # it about twice, which is faster for large states on many processes.
+        # NCCL's broadcast is already pipelined along a ring.
+        scatter_backends = tuple(
+            getattr(dist, name) for name in ("ProcessGroupGloo", "ProcessGroupMPI")
+            if hasattr(dist, name))
+        state_bytes = sum(t.numel() * t.element_size() for t in module_states)
+        if (isinstance(self.process_group, scatter_backends)
+                and self.process_group.size() > 2
+                and state_bytes > self.broadcast_bucket_size):
+            return dist.BroadcastAlgorithm.SCATTER_ALLGATHER
+        return dist.BroadcastAlgorithm.BROADCAST
+
+    def _distributed_broadcast_coalesced(self, tensors, buffer_size, algorithm=None):
+        if algorithm is None:
+            algorithm = dist.BroadcastAlgorithm.BROADCAST
+        dist._broadcast_coalesced(self.process_group, tensors, buffer_size, algorithm)
 
     def _sync_params(self):
         with torch.no_grad():
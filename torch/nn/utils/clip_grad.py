@@ -1,6 +1,5 @@
 import warnings
 import torch
-from torch._six import inf
 from typing import Union, Iterable
 
 _tensor_or_tensors = Union[torch.Tensor, Iterable[torch.Tensor]]
@@ -29,15 +28,11 @@ def clip_grad_norm_(parameters: _tensor_or_tensors, max_norm: float, norm_type:
     norm_type = float(norm_type)
     if len(parameters) == 0:
         return torch.tensor(0.)
-    device = parameters[0].grad.device
-    if norm_type == inf:
-        total_norm = max(p.grad.detach().abs().max().to(device) for p in parameters)
-    else:
-        total_norm = torch.norm(torch.stack([torch.norm(p.grad.detach(), norm_type).to(device) for p in parameters]), norm_type)
-    clip_coef = max_norm / (total_norm + 1e-6)
-    if clip_coef < 1:
-        for p in parameters:
-            p.grad.detach().mul_(clip_coef.to(p.grad.device))
+    grads = [p.grad.detach() for p in parameters]
+    # Neither op waits for the norm on the host: the gradients are scaled by
+    # a clip coefficient computed on the device.
+    total_norm = torch._foreach_total_norm(grads, norm_type)
+    torch._foreach_clip_scale_(grads, total_norm, max_norm)
     return total_norm
 
 
@@ -56,19 +56,23 @@ def get_ignored_functions() -> Set[Callable]:
         torch.get_default_dtype,
         torch.get_num_interop_threads,
         torch.get_num_threads,
+        torch.get_thread_budget,
         torch.init_num_threads,
         torch.import_ir_module,
         torch.import_ir_module_from_buffer,
         torch.is_anomaly_enabled,
+        torch.is_anomaly_nan_check_enabled,
         torch.is_grad_enabled,
         torch.merge_type_from_type_comment,
         torch.parse_ir,
         torch.parse_schema,
         torch.parse_type_comment,
         torch.set_anomaly_enabled,
+        torch.set_anomaly_nan_check_enabled,
         torch.set_flush_denormal,
         torch.set_num_interop_threads,
         torch.set_num_threads,
+        torch.set_thread_budget,
         torch.wait,
         torch.as_tensor,
         torch.from_numpy,
@@ -102,6 +106,8 @@ def get_ignored_functions() -> Set[Callable]:
         torch.cudnn_batch_norm,
         torch.cudnn_convolution,
         torch.cudnn_convolution_transpose,
+        torch.cudnn_convolution_relu,
+        torch.cudnn_convolution_add_relu,
         torch.cudnn_grid_sampler,
         torch.cudnn_is_acceptable,
         torch.empty,
@@ -131,6 +137,7 @@ def get_ignored_functions() -> Set[Callable]:
         torch.result_type,
         torch.scalar_tensor,
         torch.sparse_coo_tensor,
+        torch.sparse_csr_tensor,
         torch.tril_indices,
         torch.triu_indices,
         torch.vander,
@@ -148,6 +155,8 @@ def get_ignored_functions() -> Set[Callable]:
         torch.nn.functional.tanh,
         torch.set_autocast_enabled,
         torch.is_autocast_enabled,
+        torch.set_autocast_cpu_enabled,
+        torch.is_autocast_cpu_enabled,
         torch.clear_autocast_cache,
         torch.autocast_increment_nesting,
         torch.autocast_decrement_nesting,
@@ -315,6 +324,8 @@ def get_testing_overrides() -> Dict[Callable, Callable]:
         torch.div: lambda input, other, out=None: -1,
         torch.dot: lambda mat1, mat2: -1,
         torch.dropout: lambda input, p, train, inplace=False: -1,
+        torch.dropout_add_layer_norm: (lambda input, residual, normalized_shape, weight=None, bias=None, p=0.5, train=True,
+                                       eps=1e-05: -1),
         torch.dsmm: lambda input, mat2: -1,
         torch.hsmm: lambda mat1, mat2: -1,
         torch.dstack: lambda tensors, out=None: -1,
@@ -448,6 +459,7 @@ def get_testing_overrides() -> Dict[Callable, Callable]:
         torch.mean: lambda input, dim=None: -1,
         torch.median: lambda input, dim=None: -1,
         torch.meshgrid: lambda *tensors, **kwargs: -1,
+        torch.multi_reduce: lambda input, reductions, dim=None, keepdim=False: -1,
         torch.min: lambda input, out=None: -1,
         torch.miopen_batch_norm: (lambda input, weight, bias, running_mean, running_var, training,
                                   exponential_average_factor, epsilon: -1),
@@ -468,6 +480,7 @@ def get_testing_overrides() -> Dict[Callable, Callable]:
         torch.narrow: lambda input, dim, start, length: -1,
         torch.native_batch_norm: lambda input, weight, bias, running_mean, running_var, training, momentum, eps: -1,
         torch.native_layer_norm: lambda input, weight, bias, M, N, eps: -1,
+        torch.native_dropout_add_layer_norm: lambda input, residual, weight, bias, M, N, p, eps, generator=None: -1,
         torch.native_group_norm: lambda input, weight, bias, N, C, HxW, group, eps: -1,
         torch.native_norm: lambda input, p=2: -1,
         torch.native_norm: lambda input, p=2: -1,
@@ -500,7 +513,7 @@ def get_testing_overrides() -> Dict[Callable, Callable]:
         torch.nn.functional.cosine_embedding_loss: (lambda input1, input2, target, margin=0, size_average=None,
                                                     reduce=None, reduction='mean': -1),
         torch.nn.functional.cross_entropy: (lambda input, target, weight=None, size_average=None, ignore_index=-100,
-                                            reduce=None, reduction="mean": -1),
+                                            reduce=None, reduction="mean", label_smoothing=0.0: -1),
         torch.nn.functional.ctc_loss: (lambda log_probs, targets, input_lengths, target_lengths, blank=0,
                                        reduction='mean', zero_infinity=False: -1),
         torch.nn.functional.dropout: lambda input, p=0.5, training=True, inplace=False: -1,
@@ -670,6 +683,9 @@ def get_testing_overrides() -> Dict[Callable, Callable]:
         torch.scatter: lambda input, dim, index, src: -1,
         torch.scatter_add: lambda input, dim, index, src: -1,
         torch.searchsorted: lambda sorted_sequence, input, out_int32=False, right=False, out=None: -1,
+        torch.segment_reduce: lambda data, offsets, reduce: -1,
+        torch.segment_softmax: lambda data, offsets: -1,
+        torch.segment_sort: lambda data, offsets, descending=False: -1,
         torch.select: lambda input, dim, index: -1,
         torch.selu: lambda input, inplace=False: -1,
         torch.sigmoid: lambda input, out=None: -1,
@@ -813,8 +829,10 @@ def get_testing_overrides() -> Dict[Callable, Callable]:
         Tensor.coalesce: lambda self: -1,
         Tensor._coalesced_: lambda self, coalesced: -1,
         Tensor.contiguous: lambda self, memory_format=torch.contiguous_format: -1,
+        Tensor.col_indices: lambda self: -1,
         Tensor.copy_: lambda self, src, non_blocking=False: -1,
         Tensor.cpu: lambda self, memory_format=torch.preserve_format: -1,
+        Tensor.crow_indices: lambda self: -1,
         Tensor.cuda: lambda self, memory_format=torch.preserve_format: -1,
         Tensor.data_ptr: lambda self: -1,
         Tensor.dense_dim: lambda self: -1,
@@ -882,6 +900,7 @@ def get_testing_overrides() -> Dict[Callable, Callable]:
         Tensor.to: lambda self, dtype, non_blocking=False, copy=False, memory_format=torch.preserve_format: -1,
         Tensor.to_dense: lambda self: -1,
         Tensor.to_sparse: lambda self: -1,
+        Tensor.to_sparse_csr: lambda self: -1,
         Tensor.tolist: lambda self: -1,
         Tensor.to_mkldnn: lambda self: -1,
         Tensor.type_as: lambda self, other: -1,
@@ -485,6 +485,9 @@ def _save(obj, zip_file, pickle_module, pickle_protocol):
             # If it's on the CPU we can directly copy it into the zip file
             num_bytes = storage.size() * storage.element_size()
             zip_file.write_record(name, storage.data_ptr(), num_bytes)
+        elif storage.device.type == 'cuda':
+            # Copied to the CPU chunk by chunk as it is written
+            zip_file.write_storage_record(name, storage)
         else:
             # Copy to a buffer, then serialize that
             buf = io.BytesIO()
@@ -129,11 +129,15 @@ class _StorageBase(object):
     @classmethod
     def _new_shared(cls, size):
         """Creates a new storage in shared memory with the same data type"""
-        from torch.multiprocessing import get_sharing_strategy
+        from torch.multiprocessing import get_sharing_strategy, get_arena_size
         if cls.is_cuda:
             return cls(size)
         elif get_sharing_strategy() == 'file_system':
             return cls._new_using_filename(size)
+        elif get_sharing_strategy() == 'arena':
+            storage = cls._new_using_arena(size, get_arena_size())
+            # Fall back to a storage of its own if the arena is full
+            return storage if storage is not None else cls._new_using_fd(size)
         else:
             return cls._new_using_fd(size)
 
@@ -2544,6 +2544,66 @@ class RpcTest(RpcAgentTestFixture):
         )
         self.assertEqual(ret_rref.to_here(), True)
 
+    @dist_init
+    def test_rref_control_messages_batched(self):
+        from datetime import timedelta
+
+        rpc._set_rref_control_message_batching(timedelta(milliseconds=500))
+        dst = worker_name((self.rank + 1) % self.world_size)
+        rrefs = [
+            rpc.remote(dst, torch.add, args=(torch.ones(2), i)) for i in range(10)
+        ]
+        self.assertEqual(
+            [rref.to_here() for rref in rrefs],
+            [torch.ones(2) + i for i in range(10)])
+        # The deletes of all the UserRRefs go to the owner in one message.
+        del rrefs
+        wait_until_pending_futures_and_users_flushed()
+        rpc._set_rref_control_message_batching(timedelta(0))
+
+        info = _rref_context_get_debug_info()
+        self.assertGreater(int(info["num_batched_control_writes"]), 0)
+        self.assertGreater(
+            int(info["num_batched_control_messages"]),
+            int(info["num_batched_control_writes"]))
+        self.assertEqual(int(info["num_pending_children"]), 0)
+
+    @dist_init
+    def test_rref_control_message_batching_forks(self):
+        from datetime import timedelta
+
+        # Forks to another user go through the batched fork requests and child
+        # accepts, and the user function still waits for the confirmation.
+        rpc._set_rref_control_message_batching(timedelta(milliseconds=10))
+        dst_rank = (self.rank + 1) % self.world_size
+        rrefs = [self._create_rref() for _ in range(10)]
+        futs = [
+            rpc.rpc_async(worker_name(dst_rank), check_rref_confirmed, args=(rref,))
+            for rref in rrefs
+        ]
+        self.assertEqual([fut.wait() for fut in futs], [True] * 10)
+        del rrefs
+        wait_until_pending_futures_and_users_flushed()
+        rpc._set_rref_control_message_batching(timedelta(0))
+
+    @dist_init
+    def test_to_here_fetches_immutable_values_once(self):
+        dst = worker_name((self.rank + 1) % self.world_size)
+        rref = rpc.remote(dst, torch.add, args=(1, 1))
+        self.assertEqual(rref.to_here(), 2)
+        with torch.autograd.profiler.profile() as prof:
+            self.assertEqual(rref.to_here(), 2)
+        self.assertFalse(
+            any("to_here" in event.name for event in prof.function_events))
+
+        # Tensors can be mutated on the owner, so they are fetched every time.
+        rref = rpc.remote(dst, torch.add, args=(torch.ones(2), 1))
+        self.assertEqual(rref.to_here(), torch.ones(2) + 1)
+        with torch.autograd.profiler.profile() as prof:
+            self.assertEqual(rref.to_here(), torch.ones(2) + 1)
+        self.assertTrue(
+            any("to_here" in event.name for event in prof.function_events))
+
     @dist_init
     def test_rref_py_pickle_not_supported(self):
         local_rref = RRef(35)
@@ -3400,6 +3460,42 @@ class ProcessGroupAgentRpcTest(RpcAgentTestFixture):
         self.assertEqual(default_timeout, timeout)
         rpc.shutdown()
 
+    @dist_init(setup_rpc=False)
+    def test_process_group_coalesced_sends(self):
+        from datetime import timedelta
+
+        rpc_backend_options = rpc.ProcessGroupRpcBackendOptions(
+            init_method=self.rpc_backend_options.init_method,
+            num_send_recv_threads=self.rpc_backend_options.num_send_recv_threads,
+        )
+        rpc_backend_options.max_coalesced_bytes = 64 * 1024
+        rpc_backend_options.coalescing_window = timedelta(milliseconds=1)
+        rpc.init_rpc(
+            name=worker_name(self.rank),
+            backend=self.rpc_backend,
+            rank=self.rank,
+            world_size=self.world_size,
+            rpc_backend_options=rpc_backend_options,
+        )
+
+        dst = worker_name((self.rank + 1) % self.world_size)
+        futs = [
+            rpc.rpc_async(dst, torch.add, args=(torch.ones(n), n))
+            for n in range(1, 200)
+        ]
+        for n, fut in zip(range(1, 200), futs):
+            self.assertEqual(fut.wait(), torch.ones(n) + n)
+        # A message larger than a coalesced write is sent on its own.
+        big = torch.ones(64 * 1024)
+        self.assertEqual(rpc.rpc_sync(dst, torch.add, args=(big, 1)), big + 1)
+
+        metrics = rpc.api._get_current_rpc_agent().get_metrics()
+        self.assertGreater(int(metrics["agent.coalesced_messages"]), 0)
+        self.assertLessEqual(
+            int(metrics["agent.coalesced_writes"]),
+            int(metrics["agent.coalesced_messages"]))
+        rpc.shutdown()
+
     @dist_init(setup_rpc=False)
     def test_process_group_options_throw_on_timedelta_timeout(self):
         from datetime import timedelta
@@ -3912,6 +4008,40 @@ class TensorPipeAgentRpcTest(RpcAgentTestFixture):
         dst = worker_name(self.rank)
         self._test_device_maps_multi_gpu(dst)
 
+    @staticmethod
+    def _gpu_sum_many(*tensors):
+        if all([t.is_cuda and t.device.index == 1 for t in tensors]):
+            return torch.stack([t.sum() for t in tensors]).to(0)
+        else:
+            raise ValueError("Wrong device affinity")
+
+    @skip_if_lt_x_gpu(2)
+    def test_device_maps_many_tensors(self):
+        options = self.rpc_backend_options
+        dst = worker_name((self.rank + 1) % self.world_size)
+        options.set_device_map(dst, {0: 1, 1: 0})
+
+        rpc.init_rpc(
+            name=worker_name(self.rank),
+            backend=self.rpc_backend,
+            rank=self.rank,
+            world_size=self.world_size,
+            rpc_backend_options=options,
+        )
+
+        # The tensors are produced right before the call, and some aren't
+        # contiguous, so the copies must follow the kernels of the stream.
+        tensors = [torch.ones(100, 100, device=0).mul_(i) for i in range(10)]
+        tensors += [t.t() for t in tensors[:3]]
+        ret = rpc.rpc_sync(
+            dst,
+            TensorPipeAgentRpcTest._gpu_sum_many,
+            args=tuple(tensors)
+        )
+        self.assertEqual(ret.device, torch.device(1))
+        self.assertEqual(ret, torch.stack([t.sum() for t in tensors]).to(1))
+        rpc.shutdown()
+
     @staticmethod
     def _gpu_add_return_to_gpu(x, y):
         if x.device.type == 'cpu' and y.device.type == 'cpu':
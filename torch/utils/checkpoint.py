@@ -103,6 +103,42 @@ class CheckpointFunction(torch.autograd.Function):
         return (None, None) + grads
 
 
+def _checkpoint_without_reentrant(function, preserve_rng_state, *args):
+    # Regions nested in another region, or run while it is recomputed, are
+    # part of the outer one.
+    if torch.autograd._is_checkpoint_active():
+        return function(*args)
+
+    fwd_cpu_state = None
+    had_cuda_in_fwd = False
+    fwd_gpu_devices, fwd_gpu_states = [], []
+    if preserve_rng_state:
+        fwd_cpu_state = torch.get_rng_state()
+        if torch.cuda._initialized:
+            had_cuda_in_fwd = True
+            fwd_gpu_devices, fwd_gpu_states = get_device_states(*args)
+
+    # The recomputation only needs the values of the inputs; holding on to
+    # their graph would keep it alive as long as the region's one.
+    detached_inputs = detach_variable(tuple(args))
+
+    def recompute():
+        rng_devices = fwd_gpu_devices if had_cuda_in_fwd else []
+        with torch.random.fork_rng(devices=rng_devices, enabled=preserve_rng_state):
+            if preserve_rng_state:
+                torch.set_rng_state(fwd_cpu_state)
+                if had_cuda_in_fwd:
+                    set_device_states(fwd_gpu_devices, fwd_gpu_states)
+            function(*detached_inputs)
+
+    torch.autograd._push_checkpoint_hooks(
+        recompute, [inp for inp in detached_inputs if isinstance(inp, torch.Tensor)])
+    try:
+        return function(*args)
+    finally:
+        torch.autograd._pop_checkpoint_hooks()
+
+
 def checkpoint(function, *args, **kwargs):
     r"""Checkpoint a model or part of the model
 
@@ -120,9 +156,23 @@ def checkpoint(function, *args, **kwargs):
     :attr:`function` again, now tracking the intermediate activations, and then
     the gradients are calculated using these activation values.
 
+    With ``use_reentrant=False``, the forward pass instead records the graph
+    of :attr:`function` as usual, but the tensors it saves for backward are
+    dropped, except for those sharing memory with the inputs. When backward
+    first needs one of them, the autograd engine runs :attr:`function` again,
+    right there on the same thread and stream, to get them back, and frees
+    them once their node has run. The gradients flow through the regular
+    graph, without a nested backward, so this works with
+    :func:`torch.autograd.grad`, with hooks on the inputs, and with
+    :class:`~torch.nn.parallel.DistributedDataParallel`, and regions may be
+    nested. Wrapping only cheap operations, e.g., activations, dropout and
+    normalizations, saves their activations while keeping the outputs of the
+    surrounding matrix multiplications, which are the regions' inputs.
+
     .. warning::
-        Checkpointing doesn't work with :func:`torch.autograd.grad`, but only
-        with :func:`torch.autograd.backward`.
+        With ``use_reentrant=True``, checkpointing doesn't work with
+        :func:`torch.autograd.grad`, but only with
+        :func:`torch.autograd.backward`.
 
     .. warning::
         If :attr:`function` invocation during backward does anything different
@@ -151,16 +201,29 @@ def checkpoint(function, *args, **kwargs):
             first input as ``activation`` and the second input as ``hidden``
         preserve_rng_state(bool, optional, default=True):  Omit stashing and restoring
             the RNG state during each checkpoint.
+        use_reentrant(bool, optional, default=True): Whether to recompute
+            :attr:`function` in a nested backward pass rather than in the
+            autograd engine.
         args: tuple containing inputs to the :attr:`function`
 
     Returns:
         Output of running :attr:`function` on :attr:`*args`
+
+    Example::
+
+        >>> def block(x):
+        ...     h = checkpoint(lambda h: F.gelu(F.layer_norm(h, h.shape[-1:])),
+        ...                    fc1(x), use_reentrant=False)
+        ...     return fc2(h)
     """
     # Hack to mix *args with **kwargs in a python 2.7-compliant way
     preserve = kwargs.pop('preserve_rng_state', True)
+    use_reentrant = kwargs.pop('use_reentrant', True)
     if kwargs:
         raise ValueError("Unexpected keyword arguments: " + ",".join(arg for arg in kwargs))
 
+    if not use_reentrant:
+        return _checkpoint_without_reentrant(function, preserve, *args)
     return CheckpointFunction.apply(function, preserve, *args)
 
 
@@ -196,6 +259,8 @@ def checkpoint_sequential(functions, segments, input, **kwargs):
         input: A Tensor that is input to :attr:`functions`
         preserve_rng_state(bool, optional, default=True):  Omit stashing and restoring
             the RNG state during each checkpoint.
+        use_reentrant(bool, optional, default=True): See
+            :func:`~torch.utils.checkpoint.checkpoint`.
 
     Returns:
         Output of running :attr:`functions` sequentially on :attr:`*inputs`
@@ -206,6 +271,7 @@ def checkpoint_sequential(functions, segments, input, **kwargs):
     """
     # Hack for keyword-only parameter in a python 2.7-compliant way
     preserve = kwargs.pop('preserve_rng_state', True)
+    use_reentrant = kwargs.pop('use_reentrant', True)
     if kwargs:
         raise ValueError("Unexpected keyword arguments: " + ",".join(arg for arg in kwargs))
 
@@ -225,5 +291,5 @@ def checkpoint_sequential(functions, segments, input, **kwargs):
     for start in range(0, segment_size * (segments - 1), segment_size):
         end = start + segment_size - 1
         input = checkpoint(run_function(start, end, functions), input,
-                           preserve_rng_state=preserve)
+                           preserve_rng_state=preserve, use_reentrant=use_reentrant)
     return run_function(end + 1, len(functions) - 1, functions)(input)
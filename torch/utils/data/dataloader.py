@@ -7,6 +7,7 @@ in `./_utils/worker.py`.
 
 import threading
 import itertools
+import time
 import warnings
 from typing import Any, Callable, TypeVar, Generic, Sequence, List, Optional
 
@@ -397,7 +398,15 @@ class _BaseDataLoaderIter(object):
         raise NotImplementedError
 
     def __next__(self) -> Any:
-        data = self._next_data()
+        if torch._C._metrics_enabled():
+            start = time.perf_counter()
+            data = self._next_data()
+            torch._C._metrics_histogram_record(
+                "torch_dataloader_batch_wait_us",
+                "Time spent waiting for a batch of a DataLoader, in microseconds",
+                int((time.perf_counter() - start) * 1e6))
+        else:
+            data = self._next_data()
         self._num_yielded += 1
         if self._dataset_kind == _DatasetKind.Iterable and \
                 self._IterableDataset_len_called is not None and \
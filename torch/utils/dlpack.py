@@ -1,28 +1,64 @@
 from __future__ import absolute_import, division, print_function, unicode_literals
 import torch
 
-from torch._C import _from_dlpack as from_dlpack
-from torch._C import _to_dlpack as to_dlpack
 
-torch._C._add_docstr(from_dlpack, r"""from_dlpack(dlpack) -> Tensor
+def _stream_handle(stream):
+    # Accepts a raw handle, a torch.cuda.Stream or any object exposing its
+    # handle as `cuda_stream` (e.g. Numba) or `ptr` (e.g. CuPy).
+    if isinstance(stream, int):
+        return stream
+    for attr in ('cuda_stream', 'ptr'):
+        handle = getattr(stream, attr, None)
+        if handle is not None:
+            return int(handle)
+    raise TypeError("expected a CUDA stream or its handle as an int, got {}"
+                    .format(type(stream).__name__))
 
-Decodes a DLPack to a tensor.
 
-Args:
-    dlpack: a PyCapsule object with the dltensor
+def _wait_stream(device, producer, consumer):
+    torch._C._cuda_streamWaitStream(device.index, producer, consumer)
 
-The tensor will share the memory with the object represented
-in the dlpack.
-Note that each dlpack can only be consumed once.
-""")
 
-torch._C._add_docstr(to_dlpack, r"""to_dlpack(tensor) -> PyCapsule
+def to_dlpack(tensor, stream=None):
+    r"""to_dlpack(tensor, stream=None) -> PyCapsule
 
-Returns a DLPack representing the tensor.
+    Returns a DLPack representing the tensor.
 
-Args:
-    tensor: a tensor to be exported
+    Args:
+        tensor: a tensor to be exported
+        stream (optional): the CUDA stream, or its handle, on which the
+            consumer will use the dlpack. The work queued on it waits for the
+            work queued so far on the current stream of the tensor's device,
+            instead of the whole device being synchronized. Ignored for CPU
+            tensors.
 
-The dlpack shares the tensors memory.
-Note that each dlpack can only be consumed once.
-""")
+    The dlpack shares the tensors memory.
+    Note that each dlpack can only be consumed once.
+    """
+    if stream is not None and tensor.is_cuda:
+        current = torch.cuda.current_stream(tensor.device).cuda_stream
+        _wait_stream(tensor.device, current, _stream_handle(stream))
+    return torch._C._to_dlpack(tensor)
+
+
+def from_dlpack(dlpack, stream=None):
+    r"""from_dlpack(dlpack, stream=None) -> Tensor
+
+    Decodes a DLPack to a tensor.
+
+    Args:
+        dlpack: a PyCapsule object with the dltensor
+        stream (optional): the CUDA stream, or its handle, on which the
+            producer wrote the memory. The work queued from now on on the
+            current stream of the tensor's device waits for the work queued
+            so far on it. Ignored for CPU tensors.
+
+    The tensor will share the memory with the object represented
+    in the dlpack.
+    Note that each dlpack can only be consumed once.
+    """
+    tensor = torch._C._from_dlpack(dlpack)
+    if stream is not None and tensor.is_cuda:
+        current = torch.cuda.current_stream(tensor.device).cuda_stream
+        _wait_stream(tensor.device, _stream_handle(stream), current)
+    return tensor
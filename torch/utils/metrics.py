@@ -0,0 +1,104 @@
+r"""Process-wide metrics, for the telemetry of long running jobs.
+
+PyTorch keeps counters and histograms of what it does (e.g. the allocations
+of the allocators, the hits and misses of the JIT, cuDNN and cuFFT caches, the
+time spent waiting for the DataLoader, the calls of each operator), which are
+only updated while the metrics are enabled, with :func:`enable` or by setting
+the ``PYTORCH_METRICS`` environment variable to ``1``. The updates are cheap:
+each thread adds to counters of its own, summed when a snapshot is taken.
+
+The snapshots are reported to sinks, when :func:`report` is called or
+periodically from a background thread started with :func:`start_reporting`::
+
+    torch.utils.metrics.enable()
+    torch.utils.metrics.add_prometheus_file_sink("/var/lib/node_exporter/torch.prom")
+    torch.utils.metrics.start_reporting(interval=10)
+"""
+
+import atexit
+
+import torch
+
+
+def enable(operators=False):
+    r"""Enables the metrics. If ``operators``, the calls of each operator are
+    counted as well, in ``aten_op_calls_total``, which costs a callback of the
+    RecordFunction of each operator call.
+    """
+    torch._C._set_metrics_enabled(True)
+    if operators:
+        torch._C._set_operator_metrics_enabled(True)
+
+
+def disable():
+    torch._C._set_operator_metrics_enabled(False)
+    torch._C._set_metrics_enabled(False)
+
+
+def is_enabled():
+    return torch._C._metrics_enabled()
+
+
+def snapshot():
+    r"""Returns the current value of the metrics, as a list of dicts with the
+    ``name``, ``labels``, ``help``, ``type`` and ``value`` of each metric, and
+    the number of values in each power of two bucket of the histograms in
+    ``buckets``: bucket 0 counts the values <= 0, bucket i those in
+    [2^(i-1), 2^i).
+    """
+    return torch._C._metrics_snapshot()
+
+
+def prometheus_text():
+    r"""Returns the current value of the metrics in the Prometheus text
+    exposition format."""
+    return torch._C._metrics_prometheus_text()
+
+
+def counter_add(name, help, value=1, labels=""):
+    r"""Adds to a counter, registering it on its first update. ``labels``
+    are in the Prometheus format, e.g. ``'model="resnet50"'``."""
+    torch._C._metrics_counter_add(name, help, value, labels)
+
+
+def gauge_add(name, help, value, labels=""):
+    torch._C._metrics_gauge_add(name, help, value, labels)
+
+
+def histogram_record(name, help, value, labels=""):
+    torch._C._metrics_histogram_record(name, help, int(value), labels)
+
+
+def add_sink(callback):
+    r"""Calls ``callback`` with the :func:`snapshot` of every report, and
+    returns a handle to pass to :func:`remove_sink`."""
+    return torch._C._metrics_add_callback_sink(callback)
+
+
+def add_prometheus_file_sink(path):
+    r"""Writes every report to ``path`` in the Prometheus text format,
+    replacing the file atomically, and returns a handle to pass to
+    :func:`remove_sink`."""
+    return torch._C._metrics_add_prometheus_file_sink(path)
+
+
+def remove_sink(sink):
+    torch._C._metrics_remove_sink(sink)
+
+
+def report():
+    torch._C._metrics_report()
+
+
+def start_reporting(interval):
+    r"""Reports to the sinks every ``interval`` seconds from a background
+    thread, until :func:`stop_reporting`."""
+    torch._C._metrics_start_reporting(interval)
+
+
+def stop_reporting():
+    torch._C._metrics_stop_reporting()
+
+
+# The reporting thread may call the Python sinks, which needs the interpreter.
+atexit.register(stop_reporting)